@@ -186,6 +186,21 @@ ALWAYS_INLINE void ShimCppDelete(void* address) {
   return chain_head->free_function(chain_head, address, context);
 }
 
+// For the sized operator delete. |size| is the size requested when allocating
+// |address|.
+ALWAYS_INLINE void ShimCppDeleteSized(void* address, size_t size) {
+#if BUILDFLAG(USE_PARTITION_ALLOC_AS_MALLOC) && !BUILDFLAG(IS_APPLE)
+  // PartitionAlloc uses the size to free faster. Elsewhere,
+  // free_definite_size() is either missing, or (on Apple OSes) expects the size
+  // of the allocation rather than the requested one.
+  const base::allocator::AllocatorDispatch* const chain_head = GetChainHead();
+  return chain_head->free_definite_size_function(chain_head, address, size,
+                                                 nullptr);
+#else
+  ShimCppDelete(address);
+#endif
+}
+
 ALWAYS_INLINE void* ShimMalloc(size_t size, void* context) {
   const base::allocator::AllocatorDispatch* const chain_head = GetChainHead();
   void* ptr;
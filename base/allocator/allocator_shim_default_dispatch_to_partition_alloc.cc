@@ -394,23 +394,38 @@ void PartitionFree(const AllocatorDispatch*, void* object, void* context) {
   base::ThreadSafePartitionRoot::FreeNoHooks(object);
 }
 
-#if BUILDFLAG(IS_APPLE)
 // Normal free() path on Apple OSes:
 // 1. size = GetSizeEstimate(ptr);
 // 2. if (size) FreeDefiniteSize(ptr, size)
 //
 // So we don't need to re-check that the pointer is owned in Free(), and we
 // can use the size.
+//
+// Elsewhere, this is called by the sized operator delete, with the requested
+// size.
 void PartitionFreeDefiniteSize(const AllocatorDispatch*,
                                void* address,
                                size_t size,
                                void* context) {
   ScopedDisallowAllocations guard{};
+#if BUILDFLAG(IS_APPLE)
   // TODO(lizeb): Optimize PartitionAlloc to use the size information. This is
   // still useful though, as we avoid double-checking that the address is owned.
+  // The size is the usable size here, which doesn't give the bucket.
   base::ThreadSafePartitionRoot::FreeNoHooks(address);
-}
+#else
+#if BUILDFLAG(IS_ANDROID) && BUILDFLAG(IS_CHROMECAST)
+  // See PartitionFree().
+  if (UNLIKELY(!base::IsManagedByPartitionAlloc(
+                   reinterpret_cast<uintptr_t>(address)) &&
+               address)) {
+    return __real_free(address);
+  }
+#endif
+  base::ThreadSafePartitionRoot::FreeNoHooksWithSize(address,
+                                                     MaybeAdjustSize(size));
 #endif  // BUILDFLAG(IS_APPLE)
+}
 
 size_t PartitionGetSizeEstimate(const AllocatorDispatch*,
                                 void* address,
@@ -460,11 +475,16 @@ void PartitionBatchFree(const AllocatorDispatch*,
                         void** to_be_freed,
                         unsigned num_to_be_freed,
                         void* context) {
-  // No real batching: we could only acquire the lock once for instance, keep it
-  // simple for now.
+#if BUILDFLAG(IS_APPLE) || (BUILDFLAG(IS_ANDROID) && BUILDFLAG(IS_CHROMECAST))
+  // The pointers may not all be owned, see PartitionFree().
   for (unsigned i = 0; i < num_to_be_freed; i++) {
     PartitionFree(nullptr, to_be_freed[i], nullptr);
   }
+#else
+  ScopedDisallowAllocations guard{};
+  base::ThreadSafePartitionRoot::FreeBatchNoHooks(to_be_freed,
+                                                  num_to_be_freed);
+#endif
 }
 
 // static
@@ -642,14 +662,11 @@ const AllocatorDispatch AllocatorDispatch::default_dispatch = {
     &base::internal::PartitionGetSizeEstimate,  // get_size_estimate_function
     &base::internal::PartitionBatchMalloc,      // batch_malloc_function
     &base::internal::PartitionBatchFree,        // batch_free_function
-#if BUILDFLAG(IS_APPLE)
     // On Apple OSes, free_definite_size() is always called from free(), since
     // get_size_estimate() is used to determine whether an allocation belongs to
-    // the current zone. It makes sense to optimize for it.
+    // the current zone. It makes sense to optimize for it. Elsewhere, it's
+    // called by the sized operator delete.
     &base::internal::PartitionFreeDefiniteSize,
-#else
-    nullptr,  // free_definite_size_function
-#endif
     &base::internal::PartitionAlignedAlloc,    // aligned_malloc_function
     &base::internal::PartitionAlignedRealloc,  // aligned_realloc_function
     &base::internal::PartitionFree,            // aligned_free_function
@@ -102,12 +102,12 @@ SHIM_CPP_SYMBOLS_EXPORT void operator delete[](void* p,
   ShimCppDelete(p);
 }
 
-SHIM_CPP_SYMBOLS_EXPORT void operator delete(void* p, size_t) __THROW {
-  ShimCppDelete(p);
+SHIM_CPP_SYMBOLS_EXPORT void operator delete(void* p, size_t size) __THROW {
+  ShimCppDeleteSized(p, size);
 }
 
-SHIM_CPP_SYMBOLS_EXPORT void operator delete[](void* p, size_t) __THROW {
-  ShimCppDelete(p);
+SHIM_CPP_SYMBOLS_EXPORT void operator delete[](void* p, size_t size) __THROW {
+  ShimCppDeleteSized(p, size);
 }
 
 ALIGN_LINKAGE SHIM_CPP_SYMBOLS_EXPORT void* ALIGN_NEW(std::size_t size,
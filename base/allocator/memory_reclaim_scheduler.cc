@@ -0,0 +1,225 @@
+// Copyright 2022 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "base/allocator/memory_reclaim_scheduler.h"
+
+#include <algorithm>
+#include <vector>
+
+#include "base/allocator/partition_allocator/memory_reclaimer.h"
+#include "base/allocator/partition_allocator/partition_alloc_config.h"
+#include "base/allocator/partition_allocator/thread_cache.h"
+#include "base/bind.h"
+#include "base/files/file_util.h"
+#include "base/metrics/histogram_functions.h"
+#include "base/metrics/histogram_macros.h"
+#include "base/strings/string_number_conversions.h"
+#include "base/strings/string_split.h"
+#include "base/strings/string_util.h"
+#include "base/trace_event/base_tracing.h"
+#include "build/build_config.h"
+
+#if BUILDFLAG(IS_LINUX) || BUILDFLAG(IS_CHROMEOS) || BUILDFLAG(IS_ANDROID)
+#define HAS_CGROUPS_AND_PSI
+#endif
+
+namespace base {
+namespace allocator {
+
+namespace {
+
+// Maps |value| from [start, full] to [0, 1].
+double PriceOf(double value, double start, double full) {
+  return std::clamp((value - start) / (full - start), 0.0, 1.0);
+}
+
+#if defined(HAS_CGROUPS_AND_PSI)
+constexpr char kProcSelfCgroup[] = "/proc/self/cgroup";
+constexpr char kCgroupRoot[] = "/sys/fs/cgroup";
+constexpr char kSystemPsiMemory[] = "/proc/pressure/memory";
+
+bool ReadCgroupMemoryValue(const FilePath& cgroup_dir,
+                           const char* name,
+                           uint64_t* value) {
+  std::string contents;
+  return ReadFileToStringNonBlocking(cgroup_dir.Append(name), &contents) &&
+         MemoryReclaimScheduler::ParseCgroupMemoryValue(contents, value);
+}
+#endif  // defined(HAS_CGROUPS_AND_PSI)
+
+}  // namespace
+
+MemoryReclaimScheduler::MemoryReclaimScheduler() {
+  DETACH_FROM_SEQUENCE(sequence_checker_);
+#if defined(HAS_CGROUPS_AND_PSI)
+  std::string contents;
+  std::string path;
+  if (ReadFileToStringNonBlocking(FilePath(kProcSelfCgroup), &contents) &&
+      ParseCgroupPath(contents, &path)) {
+    cgroup_dir_ = FilePath(kCgroupRoot + path);
+  }
+#endif
+}
+
+MemoryReclaimScheduler::~MemoryReclaimScheduler() = default;
+
+void MemoryReclaimScheduler::Start() {
+  DCHECK_CALLED_ON_VALID_SEQUENCE(sequence_checker_);
+  memory_pressure_listener_ = std::make_unique<MemoryPressureListener>(
+      FROM_HERE, BindRepeating(&MemoryReclaimScheduler::OnMemoryPressure,
+                               Unretained(this)));
+  timer_.Start(FROM_HERE, kMaxInterval, this, &MemoryReclaimScheduler::Reclaim);
+}
+
+// static
+MemoryReclaimDecision MemoryReclaimScheduler::Decide(
+    const MemoryPressureSignals& signals) {
+  double price = 0;
+  if (signals.cgroup_limit) {
+    const double usage = static_cast<double>(signals.cgroup_usage) /
+                         static_cast<double>(signals.cgroup_limit);
+    price = std::max(price, PriceOf(usage, kUsagePriceStart, kUsagePriceFull));
+  }
+  price = std::max(price, PriceOf(signals.psi_some_avg10, 0, kPsiPriceFull));
+  switch (signals.level) {
+    case MemoryPressureListener::MEMORY_PRESSURE_LEVEL_NONE:
+      break;
+    case MemoryPressureListener::MEMORY_PRESSURE_LEVEL_MODERATE:
+      price = std::max(price, 0.5);
+      break;
+    case MemoryPressureListener::MEMORY_PRESSURE_LEVEL_CRITICAL:
+      price = 1;
+      break;
+  }
+
+  using Action = MemoryReclaimDecision::Action;
+  MemoryReclaimDecision decision;
+  decision.price = price;
+  if (price >= kReclaimAllPrice)
+    decision.action = Action::kAll;
+  else if (price >= kPurgeThreadCachesPrice)
+    decision.action = Action::kNormalAndPurgeThreadCaches;
+  decision.next_interval = kMaxInterval - (kMaxInterval - kMinInterval) * price;
+  return decision;
+}
+
+// static
+bool MemoryReclaimScheduler::ParseCgroupPath(StringPiece contents,
+                                             std::string* path) {
+  // cgroup v2 has a single hierarchy, with ID 0 and no controller list:
+  //   0::/user.slice/user-1000.slice/session-1.scope
+  for (StringPiece line : SplitStringPiece(contents, "\n", TRIM_WHITESPACE,
+                                           SPLIT_WANT_NONEMPTY)) {
+    if (!StartsWith(line, "0::/"))
+      continue;
+    *path = std::string(line.substr(3));
+    return true;
+  }
+  return false;
+}
+
+// static
+bool MemoryReclaimScheduler::ParseCgroupMemoryValue(StringPiece contents,
+                                                    uint64_t* value) {
+  return StringToUint64(TrimWhitespaceASCII(contents, TRIM_ALL), value);
+}
+
+// static
+bool MemoryReclaimScheduler::ParsePsiSomeAvg10(StringPiece contents,
+                                               double* avg10) {
+  //   some avg10=0.12 avg60=0.05 avg300=0.01 total=123456
+  //   full avg10=0.00 avg60=0.00 avg300=0.00 total=4567
+  for (StringPiece line : SplitStringPiece(contents, "\n", TRIM_WHITESPACE,
+                                           SPLIT_WANT_NONEMPTY)) {
+    std::vector<StringPiece> fields =
+        SplitStringPiece(line, " ", TRIM_WHITESPACE, SPLIT_WANT_NONEMPTY);
+    if (fields.size() < 2 || fields[0] != "some" ||
+        !StartsWith(fields[1], "avg10=")) {
+      continue;
+    }
+    return StringToDouble(fields[1].substr(6), avg10);
+  }
+  return false;
+}
+
+MemoryPressureSignals MemoryReclaimScheduler::ReadSignals() const {
+  MemoryPressureSignals signals;
+  signals.level = level_;
+#if defined(HAS_CGROUPS_AND_PSI)
+  std::string contents;
+  if (!cgroup_dir_.empty()) {
+    uint64_t high = 0;
+    uint64_t max = 0;
+    const bool has_high = ReadCgroupMemoryValue(cgroup_dir_, "memory.high",
+                                                &high);
+    const bool has_max = ReadCgroupMemoryValue(cgroup_dir_, "memory.max", &max);
+    if (has_high || has_max) {
+      signals.cgroup_limit = has_high && has_max ? std::min(high, max)
+                             : has_high          ? high
+                                                 : max;
+      if (!ReadCgroupMemoryValue(cgroup_dir_, "memory.current",
+                                 &signals.cgroup_usage)) {
+        signals.cgroup_limit = 0;
+      }
+    }
+    // The stalls of the cgroup, rather than the whole system's.
+    if (ReadFileToStringNonBlocking(cgroup_dir_.Append("memory.pressure"),
+                                    &contents) &&
+        ParsePsiSomeAvg10(contents, &signals.psi_some_avg10)) {
+      return signals;
+    }
+  }
+  if (ReadFileToStringNonBlocking(FilePath(kSystemPsiMemory), &contents))
+    ParsePsiSomeAvg10(contents, &signals.psi_some_avg10);
+#endif  // defined(HAS_CGROUPS_AND_PSI)
+  return signals;
+}
+
+void MemoryReclaimScheduler::Reclaim() {
+  DCHECK_CALLED_ON_VALID_SEQUENCE(sequence_checker_);
+  TRACE_EVENT0("base", "MemoryReclaimScheduler::Reclaim()");
+  const MemoryReclaimDecision decision = Decide(ReadSignals());
+  // Notifications are repeated for as long as the pressure lasts.
+  level_ = MemoryPressureListener::MEMORY_PRESSURE_LEVEL_NONE;
+
+  {
+    // Micros, since memory reclaiming should typically take at most a few ms.
+    SCOPED_UMA_HISTOGRAM_TIMER_MICROS("Memory.PartitionAlloc.MemoryReclaim");
+    auto* reclaimer = PartitionAllocMemoryReclaimer::Instance();
+    switch (decision.action) {
+      case MemoryReclaimDecision::Action::kNormalAndPurgeThreadCaches:
+#if defined(PA_THREAD_CACHE_SUPPORTED)
+        internal::ThreadCacheRegistry::Instance().PurgeAll();
+#endif
+        [[fallthrough]];
+      case MemoryReclaimDecision::Action::kNormal:
+        reclaimer->ReclaimNormal();
+        break;
+      case MemoryReclaimDecision::Action::kAll:
+        reclaimer->ReclaimAll();
+        break;
+    }
+  }
+
+  UmaHistogramPercentage("Memory.PartitionAlloc.ReclaimScheduler.Price",
+                         static_cast<int>(decision.price * 100));
+  UmaHistogramEnumeration("Memory.PartitionAlloc.ReclaimScheduler.Action",
+                          decision.action);
+  UmaHistogramTimes("Memory.PartitionAlloc.ReclaimScheduler.Interval",
+                    decision.next_interval);
+
+  timer_.Start(FROM_HERE, decision.next_interval, this,
+               &MemoryReclaimScheduler::Reclaim);
+}
+
+void MemoryReclaimScheduler::OnMemoryPressure(
+    MemoryPressureListener::MemoryPressureLevel level) {
+  DCHECK_CALLED_ON_VALID_SEQUENCE(sequence_checker_);
+  level_ = level;
+  if (level == MemoryPressureListener::MEMORY_PRESSURE_LEVEL_CRITICAL)
+    Reclaim();
+}
+
+}  // namespace allocator
+}  // namespace base
@@ -0,0 +1,119 @@
+// Copyright 2022 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#ifndef BASE_ALLOCATOR_MEMORY_RECLAIM_SCHEDULER_H_
+#define BASE_ALLOCATOR_MEMORY_RECLAIM_SCHEDULER_H_
+
+#include <stdint.h>
+
+#include <memory>
+#include <string>
+
+#include "base/base_export.h"
+#include "base/files/file_path.h"
+#include "base/memory/memory_pressure_listener.h"
+#include "base/sequence_checker.h"
+#include "base/strings/string_piece.h"
+#include "base/time/time.h"
+#include "base/timer/timer.h"
+
+namespace base {
+namespace allocator {
+
+// What the process is told about memory pressure, from the cgroup v2
+// controller of the process, Pressure Stall Information (PSI) and
+// MemoryPressureListener.
+struct BASE_EXPORT MemoryPressureSignals {
+  // Bytes charged to the cgroup, and its limit, i.e. the lower of memory.high
+  // and memory.max. 0 if unknown or unlimited.
+  uint64_t cgroup_usage = 0;
+  uint64_t cgroup_limit = 0;
+  // The share of the last 10 seconds during which some tasks stalled on
+  // memory, in percent.
+  double psi_some_avg10 = 0;
+  MemoryPressureListener::MemoryPressureLevel level =
+      MemoryPressureListener::MEMORY_PRESSURE_LEVEL_NONE;
+};
+
+struct BASE_EXPORT MemoryReclaimDecision {
+  // Recorded in histograms, don't renumber.
+  enum class Action {
+    // PartitionAllocMemoryReclaimer::ReclaimNormal().
+    kNormal = 0,
+    // Same, and purges the thread caches of all threads.
+    kNormalAndPurgeThreadCaches = 1,
+    // PartitionAllocMemoryReclaimer::ReclaimAll().
+    kAll = 2,
+    kMaxValue = kAll,
+  };
+
+  // How much freeing memory is worth, from 0 (nothing to gain) to 1 (about to
+  // hit the limit).
+  double price = 0;
+  Action action = Action::kNormal;
+  TimeDelta next_interval;
+};
+
+// Runs PartitionAllocMemoryReclaimer, at a cadence and with an aggressiveness
+// which follow memory pressure, rather than every few seconds. Before each
+// reclaim, the signals are turned into a price of memory:
+// - the cgroup usage counts from kUsagePriceStart of the limit, and is worth
+//   the full price at kUsagePriceFull of it,
+// - stalls count from 0, and are worth the full price at kPsiPriceFull,
+// - moderate and critical pressure notifications are worth half and the full
+//   price,
+// and the highest of these is the price. The interval shrinks from
+// kMaxInterval to kMinInterval as the price goes up, thread caches are purged
+// from kPurgeThreadCachesPrice, and all free memory is reclaimed from
+// kReclaimAllPrice. Critical pressure notifications also trigger a reclaim
+// right away.
+//
+// The decisions are recorded as Memory.PartitionAlloc.ReclaimScheduler.*
+// histograms.
+class BASE_EXPORT MemoryReclaimScheduler {
+ public:
+  static constexpr TimeDelta kMaxInterval = Seconds(4);
+  static constexpr TimeDelta kMinInterval = Milliseconds(250);
+  static constexpr double kUsagePriceStart = 0.7;
+  static constexpr double kUsagePriceFull = 0.95;
+  static constexpr double kPsiPriceFull = 10;
+  static constexpr double kPurgeThreadCachesPrice = 0.5;
+  static constexpr double kReclaimAllPrice = 0.9;
+
+  MemoryReclaimScheduler();
+  MemoryReclaimScheduler(const MemoryReclaimScheduler&) = delete;
+  MemoryReclaimScheduler& operator=(const MemoryReclaimScheduler&) = delete;
+  ~MemoryReclaimScheduler();
+
+  // Schedules the first reclaim. Reclaims run on the current sequence.
+  void Start();
+
+  static MemoryReclaimDecision Decide(const MemoryPressureSignals& signals);
+
+  // Parsers for the contents of /proc/self/cgroup, cgroup memory files (e.g.
+  // memory.high) and PSI files (e.g. /proc/pressure/memory). Return false if
+  // |contents| isn't in the expected format, and for "max" limits.
+  static bool ParseCgroupPath(StringPiece contents, std::string* path);
+  static bool ParseCgroupMemoryValue(StringPiece contents, uint64_t* value);
+  static bool ParsePsiSomeAvg10(StringPiece contents, double* avg10);
+
+ private:
+  MemoryPressureSignals ReadSignals() const;
+  void Reclaim();
+  void OnMemoryPressure(MemoryPressureListener::MemoryPressureLevel level);
+
+  // The cgroup v2 directory of the process, empty if there is none.
+  FilePath cgroup_dir_;
+  MemoryPressureListener::MemoryPressureLevel level_ =
+      MemoryPressureListener::MEMORY_PRESSURE_LEVEL_NONE;
+  std::unique_ptr<MemoryPressureListener> memory_pressure_listener_;
+  OneShotTimer timer_;
+
+  SEQUENCE_CHECKER(sequence_checker_);
+};
+
+}  // namespace allocator
+}  // namespace base
+
+#endif  // BASE_ALLOCATOR_MEMORY_RECLAIM_SCHEDULER_H_
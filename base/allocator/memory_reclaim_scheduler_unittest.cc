@@ -0,0 +1,105 @@
+// Copyright 2022 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "base/allocator/memory_reclaim_scheduler.h"
+
+#include <string>
+
+#include "testing/gtest/include/gtest/gtest.h"
+
+namespace base {
+namespace allocator {
+
+namespace {
+
+using Action = MemoryReclaimDecision::Action;
+
+constexpr uint64_t kLimit = 1000 * 1024 * 1024;
+
+MemoryPressureSignals CgroupUsage(double fraction_of_limit) {
+  MemoryPressureSignals signals;
+  signals.cgroup_limit = kLimit;
+  signals.cgroup_usage = static_cast<uint64_t>(fraction_of_limit * kLimit);
+  return signals;
+}
+
+}  // namespace
+
+TEST(MemoryReclaimSchedulerTest, NoPressure) {
+  const MemoryReclaimDecision decision =
+      MemoryReclaimScheduler::Decide(MemoryPressureSignals());
+  EXPECT_EQ(0, decision.price);
+  EXPECT_EQ(Action::kNormal, decision.action);
+  EXPECT_EQ(MemoryReclaimScheduler::kMaxInterval, decision.next_interval);
+
+  // Below kUsagePriceStart.
+  EXPECT_EQ(0, MemoryReclaimScheduler::Decide(CgroupUsage(0.5)).price);
+}
+
+TEST(MemoryReclaimSchedulerTest, CgroupUsage) {
+  const MemoryReclaimDecision halfway = MemoryReclaimScheduler::Decide(
+      CgroupUsage((MemoryReclaimScheduler::kUsagePriceStart +
+                   MemoryReclaimScheduler::kUsagePriceFull) /
+                  2));
+  EXPECT_NEAR(0.5, halfway.price, 0.01);
+  EXPECT_EQ(Action::kNormalAndPurgeThreadCaches, halfway.action);
+  EXPECT_LT(halfway.next_interval, MemoryReclaimScheduler::kMaxInterval);
+  EXPECT_GT(halfway.next_interval, MemoryReclaimScheduler::kMinInterval);
+
+  const MemoryReclaimDecision over = MemoryReclaimScheduler::Decide(
+      CgroupUsage(1.2));
+  EXPECT_EQ(1, over.price);
+  EXPECT_EQ(Action::kAll, over.action);
+  EXPECT_EQ(MemoryReclaimScheduler::kMinInterval, over.next_interval);
+}
+
+TEST(MemoryReclaimSchedulerTest, HighestSignalWins) {
+  MemoryPressureSignals signals = CgroupUsage(0.5);
+  signals.psi_some_avg10 = MemoryReclaimScheduler::kPsiPriceFull / 4;
+  EXPECT_NEAR(0.25, MemoryReclaimScheduler::Decide(signals).price, 0.01);
+
+  signals.level = MemoryPressureListener::MEMORY_PRESSURE_LEVEL_MODERATE;
+  EXPECT_EQ(0.5, MemoryReclaimScheduler::Decide(signals).price);
+
+  signals.level = MemoryPressureListener::MEMORY_PRESSURE_LEVEL_CRITICAL;
+  EXPECT_EQ(Action::kAll, MemoryReclaimScheduler::Decide(signals).action);
+}
+
+TEST(MemoryReclaimSchedulerTest, ParseCgroupPath) {
+  std::string path;
+  EXPECT_TRUE(MemoryReclaimScheduler::ParseCgroupPath(
+      "0::/user.slice/session-1.scope\n", &path));
+  EXPECT_EQ("/user.slice/session-1.scope", path);
+
+  // Hybrid hierarchies list the v1 controllers first.
+  EXPECT_TRUE(MemoryReclaimScheduler::ParseCgroupPath(
+      "12:memory:/foo\n1:name=systemd:/bar\n0::/baz\n", &path));
+  EXPECT_EQ("/baz", path);
+
+  // cgroup v1 only.
+  EXPECT_FALSE(
+      MemoryReclaimScheduler::ParseCgroupPath("12:memory:/foo\n", &path));
+}
+
+TEST(MemoryReclaimSchedulerTest, ParseCgroupMemoryValue) {
+  uint64_t value = 0;
+  EXPECT_TRUE(
+      MemoryReclaimScheduler::ParseCgroupMemoryValue("123456789\n", &value));
+  EXPECT_EQ(123456789u, value);
+  EXPECT_FALSE(MemoryReclaimScheduler::ParseCgroupMemoryValue("max\n", &value));
+}
+
+TEST(MemoryReclaimSchedulerTest, ParsePsiSomeAvg10) {
+  double avg10 = 0;
+  EXPECT_TRUE(MemoryReclaimScheduler::ParsePsiSomeAvg10(
+      "some avg10=2.50 avg60=1.00 avg300=0.10 total=12345\n"
+      "full avg10=1.25 avg60=0.50 avg300=0.05 total=6789\n",
+      &avg10));
+  EXPECT_EQ(2.5, avg10);
+  EXPECT_FALSE(MemoryReclaimScheduler::ParsePsiSomeAvg10(
+      "full avg10=1.25 avg60=0.50 avg300=0.05 total=6789\n", &avg10));
+}
+
+}  // namespace allocator
+}  // namespace base
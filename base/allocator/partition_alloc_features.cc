@@ -84,6 +84,11 @@ const base::FeatureParam<BackupRefPtrMode> kBackupRefPtrModeParam{
 const Feature kPartitionAllocUseAlternateDistribution{
     "PartitionAllocUseAlternateDistribution", FEATURE_DISABLED_BY_DEFAULT};
 
+// If enabled, the memory reclaimer runs at a cadence and with an
+// aggressiveness which follow memory pressure, see MemoryReclaimScheduler.
+const Feature kPartitionAllocPressureDrivenReclaim{
+    "PartitionAllocPressureDrivenReclaim", FEATURE_DISABLED_BY_DEFAULT};
+
 // If enabled, switches PCScan scheduling to a mutator-aware scheduler. Does not
 // affect whether PCScan is enabled itself.
 const Feature kPartitionAllocPCScanMUAwareScheduler{
@@ -5,11 +5,13 @@
 #include "base/allocator/partition_alloc_support.h"
 
 #include <array>
+#include <atomic>
 #include <cstdint>
 #include <map>
 #include <string>
 
 #include "base/allocator/buildflags.h"
+#include "base/allocator/memory_reclaim_scheduler.h"
 #include "base/allocator/partition_alloc_features.h"
 #include "base/allocator/partition_allocator/allocation_guard.h"
 #include "base/allocator/partition_allocator/dangling_raw_ptr_checks.h"
@@ -17,6 +19,7 @@
 #include "base/allocator/partition_allocator/partition_alloc_check.h"
 #include "base/allocator/partition_allocator/partition_alloc_config.h"
 #include "base/allocator/partition_allocator/partition_lock.h"
+#include "base/allocator/partition_allocator/starscan/helper_job_runner.h"
 #include "base/allocator/partition_allocator/starscan/pcscan.h"
 #include "base/allocator/partition_allocator/starscan/stats_collector.h"
 #include "base/allocator/partition_allocator/starscan/stats_reporter.h"
@@ -27,10 +30,13 @@
 #include "base/debug/stack_trace.h"
 #include "base/feature_list.h"
 #include "base/immediate_crash.h"
+#include "base/memory/ref_counted.h"
 #include "base/metrics/histogram_functions.h"
 #include "base/metrics/histogram_macros.h"
 #include "base/no_destructor.h"
 #include "base/strings/stringprintf.h"
+#include "base/task/post_job.h"
+#include "base/task/task_traits.h"
 #include "base/thread_annotations.h"
 #include "base/threading/platform_thread.h"
 #include "base/threading/thread_task_runner_handle.h"
@@ -128,6 +134,50 @@ class StatsReporterImpl final : public StatsReporter {
   static constexpr char kTraceCategory[] = "partition_alloc";
 };
 
+// Runs the slices of the PCScan helpers as a best-effort job, so that they only
+// use otherwise idle workers.
+class HelperJobRunnerImpl final : public HelperJobRunner {
+ public:
+  void RunSlices(size_t max_concurrency,
+                 RepeatingCallback<bool()> run_slice) override {
+    auto state =
+        MakeRefCounted<JobState>(max_concurrency, std::move(run_slice));
+    PostJob(FROM_HERE, {TaskPriority::BEST_EFFORT},
+            BindRepeating(&HelperJobRunnerImpl::Work, state),
+            BindRepeating(&HelperJobRunnerImpl::GetMaxConcurrency, state))
+        .Detach();
+  }
+
+ private:
+  struct JobState : public RefCountedThreadSafe<JobState> {
+    JobState(size_t max_concurrency, RepeatingCallback<bool()> run_slice)
+        : max_concurrency(max_concurrency), run_slice(std::move(run_slice)) {}
+
+    const size_t max_concurrency;
+    const RepeatingCallback<bool()> run_slice;
+    std::atomic<bool> done{false};
+
+   private:
+    friend class RefCountedThreadSafe<JobState>;
+    ~JobState() = default;
+  };
+
+  static void Work(scoped_refptr<JobState> state, JobDelegate* delegate) {
+    while (!state->done.load(std::memory_order_relaxed) &&
+           !delegate->ShouldYield()) {
+      if (!state->run_slice.Run())
+        state->done.store(true, std::memory_order_relaxed);
+    }
+  }
+
+  static size_t GetMaxConcurrency(scoped_refptr<JobState> state,
+                                  size_t /*worker_count*/) {
+    return state->done.load(std::memory_order_relaxed)
+               ? 0
+               : state->max_concurrency;
+  }
+};
+
 #endif  // defined(PA_ALLOW_PCSCAN)
 
 }  // namespace
@@ -142,6 +192,16 @@ void RegisterPCScanStatsReporter() {
   internal::PCScan::RegisterStatsReporter(&s_reporter);
   registered = true;
 }
+
+void RegisterPCScanHelperJobRunner() {
+  static HelperJobRunnerImpl s_runner;
+  static bool registered = false;
+
+  DCHECK(!registered);
+
+  internal::PCScan::RegisterHelperJobRunner(&s_runner);
+  registered = true;
+}
 #endif  // defined(PA_ALLOW_PCSCAN)
 
 namespace {
@@ -206,6 +266,15 @@ void StartMemoryReclaimer(scoped_refptr<SequencedTaskRunner> task_runner) {
   // seconds is useful. Since this is meant to run during idle time only, it is
   // a reasonable starting point balancing effectivenes vs cost. See
   // crbug.com/942512 for details and experimental results.
+  if (FeatureList::IsEnabled(features::kPartitionAllocPressureDrivenReclaim)) {
+    // Lives as long as the process, like the reclaimer.
+    static NoDestructor<MemoryReclaimScheduler> scheduler;
+    task_runner->PostTask(FROM_HERE,
+                          BindOnce(&MemoryReclaimScheduler::Start,
+                                   Unretained(scheduler.get())));
+    return;
+  }
+
   auto* instance = PartitionAllocMemoryReclaimer::Instance();
   TimeDelta delay =
       Microseconds(instance->GetRecommendedReclaimIntervalInMicroseconds());
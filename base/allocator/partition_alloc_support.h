@@ -18,11 +18,18 @@ namespace allocator {
 
 #if defined(PA_ALLOW_PCSCAN)
 BASE_EXPORT void RegisterPCScanStatsReporter();
+
+// Lets PCScan share its work with the workers of the thread pool, which must
+// be started.
+BASE_EXPORT void RegisterPCScanHelperJobRunner();
 #endif
 
 // Starts a periodic timer on the current thread to purge all thread caches.
 BASE_EXPORT void StartThreadCachePeriodicPurge();
 
+// Runs the memory reclaimer periodically on |task_runner|. With
+// kPartitionAllocPressureDrivenReclaim, the period and the aggressiveness
+// follow memory pressure.
 BASE_EXPORT void StartMemoryReclaimer(
     scoped_refptr<SequencedTaskRunner> task_runner);
 
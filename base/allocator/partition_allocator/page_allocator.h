@@ -258,6 +258,13 @@ BASE_EXPORT void RecommitSystemPages(
 BASE_EXPORT void DiscardSystemPages(uintptr_t address, size_t length);
 BASE_EXPORT void DiscardSystemPages(void* address, size_t length);
 
+// Asks the system to back the committed pages in the given range with
+// transparent huge pages, which reduces TLB misses. Only huge-page-aligned
+// parts of the range whose pages all have the same accessibility can be
+// backed, and discarding a part of a huge page splits it. Returns false if the
+// system doesn't support it (only Linux, ChromeOS and Android do).
+BASE_EXPORT bool AdviseHugePages(uintptr_t address, size_t length);
+
 // Rounds up |address| to the next multiple of |SystemPageSize()|. Returns
 // 0 for an |address| of 0.
 PAGE_ALLOCATOR_CONSTANTS_DECLARE_CONSTEXPR ALWAYS_INLINE uintptr_t
@@ -318,6 +325,7 @@ namespace base {
 
 // TODO(https://crbug.com/1288247): Remove these 'using' declarations once
 // the migration to the new namespaces gets done.
+using ::partition_alloc::AdviseHugePages;
 using ::partition_alloc::AllocPages;
 using ::partition_alloc::AllocPagesWithAlignOffset;
 using ::partition_alloc::DecommitAndZeroSystemPages;
@@ -233,6 +233,10 @@ bool TryRecommitSystemPagesInternal(
   return true;
 }
 
+bool AdviseHugePagesInternal(uint64_t address, size_t length) {
+  return false;
+}
+
 }  // namespace partition_alloc::internal
 
 #endif  // BASE_ALLOCATOR_PARTITION_ALLOCATOR_PAGE_ALLOCATOR_INTERNALS_FUCHSIA_H_
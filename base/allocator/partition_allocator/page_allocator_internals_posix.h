@@ -370,6 +370,18 @@ void DiscardSystemPagesInternal(uintptr_t address, size_t length) {
 #endif
 }
 
+bool AdviseHugePagesInternal(uintptr_t address, size_t length) {
+#if (BUILDFLAG(IS_LINUX) || BUILDFLAG(IS_CHROMEOS) || \
+     BUILDFLAG(IS_ANDROID)) &&                        \
+    defined(MADV_HUGEPAGE)
+  // Fails with EINVAL if the kernel doesn't support transparent huge pages.
+  // Succeeds but has no effect if they are disabled.
+  return !madvise(reinterpret_cast<void*>(address), length, MADV_HUGEPAGE);
+#else
+  return false;
+#endif
+}
+
 }  // namespace partition_alloc::internal
 
 #endif  // BASE_ALLOCATOR_PARTITION_ALLOCATOR_PAGE_ALLOCATOR_INTERNALS_POSIX_H_
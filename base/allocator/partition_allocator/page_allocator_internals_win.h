@@ -194,6 +194,11 @@ void DiscardSystemPagesInternal(uintptr_t address, size_t length) {
   }
 }
 
+bool AdviseHugePagesInternal(uintptr_t address, size_t length) {
+  // Large pages must be allocated with MEM_LARGE_PAGES from the start.
+  return false;
+}
+
 }  // namespace partition_alloc::internal
 
 #endif  // BASE_ALLOCATOR_PARTITION_ALLOCATOR_PAGE_ALLOCATOR_INTERNALS_WIN_H_
@@ -95,6 +95,11 @@ static_assert(sizeof(void*) != 8, "");
 #define PA_THREAD_CACHE_SUPPORTED
 #endif
 
+// Per-CPU caches need a cheap way to know the current CPU.
+#if BUILDFLAG(IS_LINUX) || BUILDFLAG(IS_CHROMEOS)
+#define PA_PER_CPU_CACHE_SUPPORTED
+#endif
+
 // Too expensive for official builds, as it adds cache misses to all
 // allocations. On the other hand, we want wide metrics coverage to get
 // realistic profiles.
@@ -407,8 +407,11 @@ enum PartitionAllocFlags {
   // allocations return nullptr, such as direct-mapped ones, and even for
   // smaller ones, a nullptr value is common.
   PartitionAllocFastPathOrReturnNull = 1 << 3,  // Internal only.
+  // If the allocation is direct-mapped, reserve address space for it to grow
+  // in place, as it's likely to be reallocated to a larger size.
+  PartitionAllocReserveHeadroom = 1 << 4,  // Internal only.
 
-  PartitionAllocLastFlag = PartitionAllocFastPathOrReturnNull
+  PartitionAllocLastFlag = PartitionAllocReserveHeadroom
 };
 
 }  // namespace partition_alloc::internal
@@ -468,6 +471,7 @@ using ::partition_alloc::internal::PartitionAllocFastPathOrReturnNull;
 using ::partition_alloc::internal::PartitionAllocFlags;
 using ::partition_alloc::internal::PartitionAllocLastFlag;
 using ::partition_alloc::internal::PartitionAllocNoHooks;
+using ::partition_alloc::internal::PartitionAllocReserveHeadroom;
 using ::partition_alloc::internal::PartitionAllocReturnNull;
 using ::partition_alloc::internal::PartitionAllocZeroFill;
 using ::partition_alloc::internal::PartitionPageBaseMask;
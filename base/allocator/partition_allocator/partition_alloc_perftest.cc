@@ -6,10 +6,12 @@
 #include <atomic>
 #include <limits>
 #include <memory>
+#include <random>
 #include <vector>
 
 #include "base/allocator/partition_allocator/partition_alloc.h"
 #include "base/allocator/partition_allocator/partition_alloc_check.h"
+#include "base/allocator/partition_allocator/partition_alloc_config.h"
 #include "base/allocator/partition_allocator/thread_cache.h"
 #include "base/bind.h"
 #include "base/callback.h"
@@ -61,7 +63,10 @@ perf_test::PerfResultReporter SetUpReporter(const std::string& story_name) {
 enum class AllocatorType {
   kSystem,
   kPartitionAlloc,
-  kPartitionAllocWithThreadCache
+  kPartitionAllocWithThreadCache,
+#if defined(PA_PER_CPU_CACHE_SUPPORTED)
+  kPartitionAllocWithPerCpuCache,
+#endif
 };
 
 class Allocator {
@@ -131,6 +136,36 @@ class PartitionAllocatorWithThreadCache : public Allocator {
   void Free(void* data) override { ThreadSafePartitionRoot::FreeNoHooks(data); }
 };
 
+#if defined(PA_PER_CPU_CACHE_SUPPORTED)
+class PartitionAllocatorWithPerCpuCache : public Allocator {
+ public:
+  explicit PartitionAllocatorWithPerCpuCache(bool use_alternate_bucket_dist) {
+    if (!use_alternate_bucket_dist)
+      alloc_.SwitchToDenserBucketDistribution();
+  }
+  ~PartitionAllocatorWithPerCpuCache() override = default;
+
+  void* Alloc(size_t size) override {
+    return alloc_.AllocFlagsNoHooks(0, size, PartitionPageSize());
+  }
+  void Free(void* data) override { ThreadSafePartitionRoot::FreeNoHooks(data); }
+
+ private:
+  static PartitionOptions GetOptions() {
+    PartitionOptions opts(PartitionOptions::AlignedAlloc::kDisallowed,
+                          PartitionOptions::ThreadCache::kDisabled,
+                          PartitionOptions::Quarantine::kDisallowed,
+                          PartitionOptions::Cookie::kAllowed,
+                          PartitionOptions::BackupRefPtr::kDisabled,
+                          PartitionOptions::UseConfigurablePool::kNo);
+    opts.per_cpu_cache = PartitionOptions::PerCpuCache::kEnabled;
+    return opts;
+  }
+
+  ThreadSafePartitionRoot alloc_{GetOptions()};
+};
+#endif  // defined(PA_PER_CPU_CACHE_SUPPORTED)
+
 class TestLoopThread : public PlatformThread::Delegate {
  public:
   explicit TestLoopThread(OnceCallback<float()> test_fn)
@@ -307,6 +342,54 @@ float DirectMapped(Allocator* allocator) {
   return timer.LapsPerSecond();
 }
 
+#if !defined(MEMORY_CONSTRAINED)
+// Chases pointers through a working set much larger than what the TLB maps
+// with 4 KiB pages, to measure the effect of huge pages on the cost of
+// touching allocated memory, rather than on the allocator itself.
+float LargeWorkingSet(PartitionOptions::HugePages huge_pages) {
+  constexpr size_t kWorkingSetSize = 256 * 1024 * 1024;
+  constexpr size_t kObjectSize = 64;
+  constexpr size_t kObjectCount = kWorkingSetSize / kObjectSize;
+  constexpr int kHopsPerLap = 1000;
+
+  PartitionOptions opts(PartitionOptions::AlignedAlloc::kDisallowed,
+                        PartitionOptions::ThreadCache::kDisabled,
+                        PartitionOptions::Quarantine::kDisallowed,
+                        PartitionOptions::Cookie::kDisallowed,
+                        PartitionOptions::BackupRefPtr::kDisabled,
+                        PartitionOptions::UseConfigurablePool::kNo);
+  opts.huge_pages = huge_pages;
+  ThreadSafePartitionRoot root(opts);
+
+  std::vector<MemoryAllocationPerfNode*> nodes(kObjectCount);
+  for (auto*& node : nodes) {
+    node = static_cast<MemoryAllocationPerfNode*>(
+        root.AllocFlagsNoHooks(0, kObjectSize, PartitionPageSize()));
+    CHECK_NE(node, nullptr);
+  }
+  // Link the objects in a random cycle, so that consecutive hops land on
+  // unrelated pages.
+  std::vector<MemoryAllocationPerfNode*> order = nodes;
+  std::shuffle(order.begin(), order.end(), std::minstd_rand());
+  for (size_t i = 0; i < kObjectCount; ++i)
+    order[i]->SetNext(order[(i + 1) % kObjectCount]);
+
+  MemoryAllocationPerfNode* cur = order[0];
+  LapTimer timer(kWarmupRuns / kHopsPerLap, kTimeLimit,
+                 kTimeCheckInterval / kHopsPerLap);
+  do {
+    for (int i = 0; i < kHopsPerLap; ++i)
+      cur = cur->GetNext();
+    timer.NextLap();
+  } while (!timer.HasTimeLimitExpired());
+  CHECK_NE(cur, nullptr);
+
+  for (auto* node : nodes)
+    ThreadSafePartitionRoot::FreeNoHooks(node);
+  return timer.LapsPerSecond() * kHopsPerLap;
+}
+#endif  // !defined(MEMORY_CONSTRAINED)
+
 std::unique_ptr<Allocator> CreateAllocator(AllocatorType type,
                                            bool use_alternate_bucket_dist) {
   switch (type) {
@@ -317,6 +400,11 @@ std::unique_ptr<Allocator> CreateAllocator(AllocatorType type,
     case AllocatorType::kPartitionAllocWithThreadCache:
       return std::make_unique<PartitionAllocatorWithThreadCache>(
           use_alternate_bucket_dist);
+#if defined(PA_PER_CPU_CACHE_SUPPORTED)
+    case AllocatorType::kPartitionAllocWithPerCpuCache:
+      return std::make_unique<PartitionAllocatorWithPerCpuCache>(
+          use_alternate_bucket_dist);
+#endif
   }
 }
 
@@ -371,6 +459,11 @@ void RunTest(int thread_count,
     case AllocatorType::kPartitionAllocWithThreadCache:
       alloc_type_str = "PartitionAllocWithThreadCache";
       break;
+#if defined(PA_PER_CPU_CACHE_SUPPORTED)
+    case AllocatorType::kPartitionAllocWithPerCpuCache:
+      alloc_type_str = "PartitionAllocWithPerCpuCache";
+      break;
+#endif
   }
 
   std::string name =
@@ -383,6 +476,15 @@ void RunTest(int thread_count,
              min_laps_per_second);
 }
 
+constexpr AllocatorType kAllocatorTypes[] = {
+    AllocatorType::kSystem,
+    AllocatorType::kPartitionAlloc,
+    AllocatorType::kPartitionAllocWithThreadCache,
+#if defined(PA_PER_CPU_CACHE_SUPPORTED)
+    AllocatorType::kPartitionAllocWithPerCpuCache,
+#endif
+};
+
 class PartitionAllocMemoryAllocationPerfTest
     : public testing::TestWithParam<std::tuple<int, bool, AllocatorType>> {};
 
@@ -394,9 +496,7 @@ INSTANTIATE_TEST_SUITE_P(
     ::testing::Combine(
         ::testing::Values(1, 2, 3, 4),
         ::testing::Values(false, true),
-        ::testing::Values(AllocatorType::kSystem,
-                          AllocatorType::kPartitionAlloc,
-                          AllocatorType::kPartitionAllocWithThreadCache)));
+        ::testing::ValuesIn(kAllocatorTypes)));
 
 // This test (and the other one below) allocates a large amount of memory, which
 // can cause issues on Android.
@@ -448,6 +548,17 @@ TEST_P(PartitionAllocMemoryAllocationPerfTest,
 }
 #endif  // !defined(MEMORY_CONSTRAINED)
 
+#if !defined(MEMORY_CONSTRAINED)
+TEST(PartitionAllocLargeWorkingSetPerfTest, HugePages) {
+  DisplayResults(std::string(kMetricPrefixMemoryAllocation) +
+                     "LargeWorkingSet_HugePagesDisabled",
+                 LargeWorkingSet(PartitionOptions::HugePages::kDisabled));
+  DisplayResults(std::string(kMetricPrefixMemoryAllocation) +
+                     "LargeWorkingSet_HugePagesEnabled",
+                 LargeWorkingSet(PartitionOptions::HugePages::kEnabled));
+}
+#endif  // !defined(MEMORY_CONSTRAINED)
+
 }  // namespace
 
 }  // namespace base
@@ -1417,6 +1417,45 @@ TEST_P(PartitionAllocTest, ReallocDirectMapAlignedRelocate) {
 }
 
 // Tests the handing out of freelists for partial slot spans.
+#if defined(PA_HAS_64_BITS_POINTERS)
+TEST_P(PartitionAllocTest, ReallocDirectMapGrowsInPlace) {
+  size_t size = 2 * kMaxBucketed;
+  char* ptr = static_cast<char*>(allocator.root()->Alloc(size, type_name));
+  memset(ptr, 'A', size);
+
+  // The first growth can't be in place, but reserves room for the next ones.
+  size_t new_size = 2 * size;
+  char* new_ptr =
+      static_cast<char*>(allocator.root()->Realloc(ptr, new_size, type_name));
+  PA_EXPECT_PTR_NE(ptr, new_ptr);
+  auto* extent = PartitionDirectMapExtent<ThreadSafe>::FromSlotSpan(
+      SlotSpan::FromSlotStart(allocator.root()->ObjectToSlotStart(new_ptr)));
+  EXPECT_GE(extent->reservation_size, 2 * new_size);
+  memset(new_ptr + size, 'B', new_size - size);
+
+  ptr = new_ptr;
+  for (size_t grown_size : {3 * size, 4 * size}) {
+    new_ptr = static_cast<char*>(
+        allocator.root()->Realloc(ptr, grown_size, type_name));
+    PA_EXPECT_PTR_EQ(ptr, new_ptr);
+    EXPECT_EQ('A', new_ptr[0]);
+    EXPECT_EQ('A', new_ptr[size - 1]);
+    EXPECT_EQ('B', new_ptr[size]);
+    EXPECT_EQ('B', new_ptr[new_size - 1]);
+    memset(new_ptr + new_size, 'B', grown_size - new_size);
+    new_size = grown_size;
+  }
+
+  // Past the headroom.
+  new_ptr = static_cast<char*>(
+      allocator.root()->Realloc(ptr, 2 * new_size, type_name));
+  PA_EXPECT_PTR_NE(ptr, new_ptr);
+  EXPECT_EQ('A', new_ptr[0]);
+  EXPECT_EQ('B', new_ptr[new_size - 1]);
+  allocator.root()->Free(new_ptr);
+}
+#endif  // defined(PA_HAS_64_BITS_POINTERS)
+
 TEST_P(PartitionAllocTest, PartialPageFreelists) {
   size_t big_size = SystemPageSize() - kExtraAllocSize;
   size_t bucket_index = SizeToIndex(big_size + kExtraAllocSize);
@@ -2908,6 +2947,41 @@ TEST_P(PartitionAllocTest, ZeroFill) {
   }
 }
 
+#if BUILDFLAG(IS_LINUX) || BUILDFLAG(IS_CHROMEOS)
+// Huge-page roots keep the memory of decommitted slot spans, so reusing them
+// must not skip zeroing.
+TEST(PartitionAllocHugePagesTest, DecommittedSlotSpanIsZeroFilled) {
+  PartitionOptions opts(PartitionOptions::AlignedAlloc::kDisallowed,
+                        PartitionOptions::ThreadCache::kDisabled,
+                        PartitionOptions::Quarantine::kDisallowed,
+                        PartitionOptions::Cookie::kDisallowed,
+                        PartitionOptions::BackupRefPtr::kDisabled,
+                        PartitionOptions::UseConfigurablePool::kNo);
+  opts.huge_pages = PartitionOptions::HugePages::kEnabled;
+  PartitionAllocator<ThreadSafe> allocator;
+  allocator.init(opts);
+  ThreadSafePartitionRoot* root = allocator.root();
+  if (!root->use_huge_pages)
+    GTEST_SKIP() << "Huge pages aren't supported with this page size";
+
+  constexpr size_t kSize = 2048;
+  char* ptr = static_cast<char*>(root->Alloc(kSize, type_name));
+  memset(ptr, 0xcd, kSize);
+  root->Free(ptr);
+  root->PurgeMemory(PartitionPurgeDecommitEmptySlotSpans |
+                    PartitionPurgeDiscardUnusedSystemPages);
+  // The memory stays resident.
+  CHECK_PAGE_IN_CORE(ptr, true);
+
+  char* new_ptr = static_cast<char*>(
+      root->AllocFlags(PartitionAllocZeroFill, kSize, type_name));
+  EXPECT_EQ(ptr, new_ptr);
+  for (size_t i = 0; i < kSize; ++i)
+    ASSERT_EQ(0, new_ptr[i]) << i;
+  root->Free(new_ptr);
+}
+#endif  // BUILDFLAG(IS_LINUX) || BUILDFLAG(IS_CHROMEOS)
+
 TEST_P(PartitionAllocTest, Bug_897585) {
   // Need sizes big enough to be direct mapped and a delta small enough to
   // allow re-use of the slot span when cookied. These numbers fall out of the
@@ -3826,6 +3900,122 @@ TEST_P(PartitionAllocTest, GetIndex) {
   }
 }
 
+namespace {
+
+// The index of the first of |slot_sizes| which fits |size|.
+size_t ExpectedCustomBucketIndex(const size_t* slot_sizes,
+                                 size_t count,
+                                 size_t size) {
+  return std::lower_bound(slot_sizes, slot_sizes + count, size) - slot_sizes;
+}
+
+// The slot sizes of the denser distribution, plus |extra_sizes|.
+std::vector<size_t> DenserSlotSizesWith(std::vector<size_t> extra_sizes) {
+  BucketIndexLookup lookup{};
+  std::vector<size_t> slot_sizes = extra_sizes;
+  for (size_t i = 0;
+       i < kNumBuckets && lookup.bucket_sizes()[i] != kInvalidBucketSize; i++) {
+    slot_sizes.push_back(lookup.bucket_sizes()[i]);
+  }
+  std::sort(slot_sizes.begin(), slot_sizes.end());
+  return slot_sizes;
+}
+
+}  // namespace
+
+TEST(PartitionAllocCustomBucketDistributionTest, GetIndex) {
+  // Checks that the constraints hold at compile time.
+  static constexpr size_t kSlotSizes[] = {16, 48, 96, 208, kMaxBucketed};
+  static constexpr CustomBucketDistribution kDistribution{kSlotSizes};
+  static_assert(kDistribution.GetIndex(200) == 3, "");
+
+  for (size_t size = 0; size <= kMaxBucketed; size++) {
+    ASSERT_EQ(ExpectedCustomBucketIndex(kSlotSizes, base::size(kSlotSizes),
+                                        size),
+              kDistribution.GetIndex(size))
+        << size;
+  }
+  EXPECT_EQ(kNumBuckets, kDistribution.GetIndex(kMaxBucketed + 1));
+  EXPECT_EQ(kInvalidBucketSize,
+            kDistribution.slot_sizes()[base::size(kSlotSizes)]);
+}
+
+TEST(PartitionAllocCustomBucketDistributionTest, SweepDenserWithExtraSizes) {
+  // Extra sizes between the buckets of the denser distribution, up to the
+  // number of buckets it leaves unused.
+  std::vector<size_t> extra_sizes;
+  BucketIndexLookup lookup{};
+  size_t unused_buckets = 0;
+  while (lookup.bucket_sizes()[kNumBuckets - 1 - unused_buckets] ==
+         kInvalidBucketSize) {
+    unused_buckets++;
+  }
+  for (size_t size : {208, 272, 4352, 12800, 72 * 1024}) {
+    if (extra_sizes.size() < unused_buckets && size % kSmallestBucket == 0)
+      extra_sizes.push_back(size);
+  }
+  ASSERT_FALSE(extra_sizes.empty());
+
+  std::vector<size_t> slot_sizes = DenserSlotSizesWith(extra_sizes);
+  CustomBucketDistribution distribution(slot_sizes.data(), slot_sizes.size());
+  for (size_t size = 0; size <= kMaxBucketed; size++) {
+    ASSERT_EQ(
+        ExpectedCustomBucketIndex(slot_sizes.data(), slot_sizes.size(), size),
+        distribution.GetIndex(size))
+        << size;
+  }
+}
+
+TEST(PartitionAllocCustomBucketDistributionTest, Allocate) {
+  static constexpr size_t kSlotSizes[] = {16, 48, 96, 208, kMaxBucketed};
+  static constexpr CustomBucketDistribution kDistribution{kSlotSizes};
+  PartitionOptions opts(PartitionOptions::AlignedAlloc::kDisallowed,
+                        PartitionOptions::ThreadCache::kDisabled,
+                        PartitionOptions::Quarantine::kDisallowed,
+                        PartitionOptions::Cookie::kDisallowed,
+                        PartitionOptions::BackupRefPtr::kDisabled,
+                        PartitionOptions::UseConfigurablePool::kNo);
+  opts.custom_bucket_distribution = &kDistribution;
+  PartitionAllocator<ThreadSafe> allocator;
+  allocator.init(opts);
+  ThreadSafePartitionRoot* root = allocator.root();
+
+  for (size_t i = 0; i < kNumBuckets; i++) {
+    EXPECT_EQ(i < base::size(kSlotSizes) ? kSlotSizes[i] : kInvalidBucketSize,
+              root->buckets[i].slot_size);
+  }
+
+  for (size_t size :
+       {size_t{1}, size_t{48}, size_t{88}, size_t{200}, size_t{1000},
+        kMaxBucketed, kMaxBucketed + 1}) {
+    void* ptr = root->Alloc(size, type_name);
+    ASSERT_TRUE(ptr);
+    size_t usable_size = ThreadSafePartitionRoot::GetUsableSize(ptr);
+    EXPECT_GE(usable_size, size);
+    EXPECT_EQ(usable_size, root->AllocationCapacityFromRequestedSize(size));
+    if (size <= kMaxBucketed) {
+      EXPECT_EQ(kSlotSizes[ExpectedCustomBucketIndex(
+                    kSlotSizes, base::size(kSlotSizes), size)],
+                usable_size);
+    }
+    memset(ptr, 0xcd, size);
+    root->Free(ptr);
+  }
+}
+
+#if defined(GTEST_HAS_DEATH_TEST)
+TEST(PartitionAllocCustomBucketDistributionDeathTest, InvalidSlotSizes) {
+  // Not ending with the largest bucket.
+  std::vector<size_t> slot_sizes = {16, 32, 4096};
+  EXPECT_DEATH(CustomBucketDistribution(slot_sizes.data(), slot_sizes.size()),
+               "");
+  // Two slot sizes between 256 and 320.
+  slot_sizes = DenserSlotSizesWith({272, 288});
+  EXPECT_DEATH(CustomBucketDistribution(slot_sizes.data(), slot_sizes.size()),
+               "");
+}
+#endif  // defined(GTEST_HAS_DEATH_TEST)
+
 // Used to check alignment. If the compiler understands the annotations, the
 // zeroing in the constructor uses aligned SIMD instructions.
 TEST_P(PartitionAllocTest, MallocFunctionAnnotations) {
@@ -4084,6 +4274,60 @@ TEST_P(PartitionAllocTest, SortFreelist) {
   allocator.root()->Free(first_ptr);
 }
 
+TEST_P(PartitionAllocTest, FreeBatch) {
+  auto& root = *allocator.root();
+  const size_t allocated_bytes = root.get_total_size_of_allocated_bytes();
+
+  // Enough objects for several slot spans, with null pointers and objects from
+  // other buckets in between.
+  const size_t count = 1000;
+  std::vector<void*> objects;
+  for (size_t i = 0; i < count; ++i) {
+    objects.push_back(root.Alloc(kTestAllocSize, type_name));
+    if (i % 100 == 0) {
+      objects.push_back(nullptr);
+      objects.push_back(root.Alloc(10 * kTestAllocSize, type_name));
+      objects.push_back(root.Alloc(kMaxBucketed + 1, type_name));
+    }
+  }
+  root.FreeBatch(objects.data(), objects.size());
+  EXPECT_EQ(allocated_bytes, root.get_total_size_of_allocated_bytes());
+  // The slot spans are empty.
+  auto* bucket = &root.buckets[test_bucket_index_];
+  EXPECT_TRUE(bucket->empty_slot_spans_head);
+  EXPECT_EQ(SlotSpan::get_sentinel_slot_span(), bucket->active_slot_spans_head);
+
+  // A full slot span, freed with a single lock acquisition.
+  objects.clear();
+  for (size_t i = 0; i < bucket->get_slots_per_span(); ++i)
+    objects.push_back(root.Alloc(kTestAllocSize, type_name));
+  auto* slot_span =
+      SlotSpan::FromSlotStart(root.ObjectToSlotStart(objects.front()));
+  EXPECT_EQ(bucket->get_slots_per_span(), slot_span->num_allocated_slots);
+  root.FreeBatch(objects.data(), objects.size());
+  EXPECT_EQ(0u, slot_span->num_allocated_slots);
+  EXPECT_EQ(allocated_bytes, root.get_total_size_of_allocated_bytes());
+}
+
+TEST_P(PartitionAllocTest, FreeNoHooksWithSize) {
+  auto& root = *allocator.root();
+  const size_t allocated_bytes = root.get_total_size_of_allocated_bytes();
+  root.FreeNoHooksWithSize(nullptr, kTestAllocSize);
+
+  for (size_t size : {size_t{0}, size_t{1}, kTestAllocSize, size_t{1000},
+                      kMaxBucketed - kExtraAllocSize, kMaxBucketed + 1}) {
+    void* ptr = root.Alloc(size, type_name);
+    ASSERT_TRUE(ptr);
+    root.FreeNoHooksWithSize(ptr, size);
+    EXPECT_EQ(allocated_bytes, root.get_total_size_of_allocated_bytes());
+    // The slot went back to its slot span.
+    void* new_ptr = root.Alloc(size, type_name);
+    if (size <= kMaxBucketed - kExtraAllocSize)
+      EXPECT_EQ(ptr, new_ptr);
+    root.Free(new_ptr);
+  }
+}
+
 #if BUILDFLAG(USE_PARTITION_ALLOC_AS_MALLOC) && BUILDFLAG(IS_LINUX) && \
     defined(ARCH_CPU_64_BITS)
 TEST_P(PartitionAllocTest, CrashOnUnknownPointer) {
@@ -4,6 +4,7 @@
 
 #include "base/allocator/partition_allocator/partition_bucket.h"
 
+#include <algorithm>
 #include <cstdint>
 
 #include "base/allocator/buildflags.h"
@@ -236,7 +237,7 @@ SlotSpanMetadata<thread_safe>* PartitionDirectMap(
     // requests. Note, |slot_span_alignment| is at least 1 partition page.
     const size_t padding_for_alignment =
         slot_span_alignment - PartitionPageSize();
-    const size_t reservation_size =
+    size_t reservation_size =
         PartitionRoot<thread_safe>::GetDirectMapReservationSize(
             raw_size + padding_for_alignment);
 #if DCHECK_IS_ON()
@@ -249,8 +250,25 @@ SlotSpanMetadata<thread_safe>* PartitionDirectMap(
     // Allocate from GigaCage. Route to the appropriate GigaCage pool based on
     // BackupRefPtr support.
     pool_handle pool = root->ChoosePool();
-    uintptr_t reservation_start;
-    {
+    uintptr_t reservation_start = 0;
+#if defined(PA_HAS_64_BITS_POINTERS)
+    // Reserve enough to double in size, so that growing with Realloc() only
+    // changes page permissions (see TryReallocInPlaceForDirectMap()), instead
+    // of copying the whole allocation each time. The headroom is only address
+    // space, which 64 bit platforms have plenty of, and isn't committed.
+    if ((flags & PartitionAllocReserveHeadroom) && !padding_for_alignment) {
+      const size_t headroom = std::min(raw_size, MaxDirectMapped() - raw_size);
+      const size_t reservation_size_with_headroom =
+          PartitionRoot<thread_safe>::GetDirectMapReservationSize(raw_size +
+                                                                  headroom);
+      reservation_start =
+          ReserveMemoryFromGigaCage(pool, 0, reservation_size_with_headroom);
+      // Otherwise, try without headroom.
+      if (reservation_start)
+        reservation_size = reservation_size_with_headroom;
+    }
+#endif  // defined(PA_HAS_64_BITS_POINTERS)
+    if (!reservation_start) {
       // Reserving memory from the GigaCage is actually not a syscall on 64 bit
       // platforms.
 #if !defined(PA_HAS_64_BITS_POINTERS)
@@ -622,10 +640,21 @@ ALWAYS_INLINE uintptr_t PartitionBucket<thread_safe>::AllocNewSuperPage(
             SuperPagePayloadBegin(super_page, root->IsQuarantineAllowed()));
   PA_DCHECK(root->next_partition_page_end == SuperPagePayloadEnd(super_page));
 
-  // Keep the first partition page in the super page inaccessible to serve as a
-  // guard page, except an "island" in the middle where we put page metadata and
-  // also a tiny amount of extent metadata.
-  {
+  if (root->use_huge_pages) {
+    // A huge page can only back a range with uniform accessibility, so make
+    // the whole super page accessible, guard pages included, and let the
+    // kernel back it with a huge page as soon as it's touched. The slot spans
+    // are still committed as usual below, which doesn't change their
+    // accessibility anymore and only serves the accounting.
+    ScopedSyscallTimer timer{root};
+    RecommitSystemPages(super_page, kSuperPageSize,
+                        PageAccessibilityConfiguration::kReadWrite,
+                        PageAccessibilityDisposition::kRequireUpdate);
+    AdviseHugePages(super_page, kSuperPageSize);
+  } else {
+    // Keep the first partition page in the super page inaccessible to serve as
+    // a guard page, except an "island" in the middle where we put page
+    // metadata and also a tiny amount of extent metadata.
     ScopedSyscallTimer timer{root};
     RecommitSystemPages(
         super_page + SystemPageSize(),
@@ -1000,7 +1029,10 @@ uintptr_t PartitionBucket<thread_safe>::SlowPathAlloc(
       }
 
       new_slot_span->Reset();
-      *is_already_zeroed = DecommittedMemoryIsAlwaysZeroed();
+      // Huge-page roots don't release the memory of decommitted slot spans,
+      // see PartitionRoot::DecommitSystemPagesForData().
+      *is_already_zeroed =
+          DecommittedMemoryIsAlwaysZeroed() && !root->use_huge_pages;
     }
     PA_DCHECK(new_slot_span);
   } else {
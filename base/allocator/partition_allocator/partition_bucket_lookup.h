@@ -6,6 +6,7 @@
 #define BASE_ALLOCATOR_PARTITION_ALLOCATOR_PARTITION_BUCKET_LOOKUP_H_
 
 #include <cstdint>
+#include <limits>
 
 #include "base/allocator/partition_allocator/partition_alloc_check.h"
 #include "base/allocator/partition_allocator/partition_alloc_config.h"
@@ -267,6 +268,97 @@ ALWAYS_INLINE constexpr size_t BucketIndexLookup::GetIndexForDenserBuckets(
   return index;
 }
 
+// A bucket distribution with custom slot sizes, for partitions whose
+// allocations are dominated by a few sizes which the buckets above fit poorly,
+// e.g. 200 bytes, which goes to the 224 bytes bucket. Typically generated
+// from an allocation size histogram by
+// tools/gen_custom_bucket_distribution.py, and used as:
+//
+//   inline constexpr size_t kSlotSizes[] = {16, 32, 48, ...};
+//   inline constexpr CustomBucketDistribution kDistribution{kSlotSizes};
+//   PartitionOptions opts(...);
+//   opts.custom_bucket_distribution = &kDistribution;
+//
+// The slot sizes must be increasing multiples of kSmallestBucket, end with the
+// largest bucket size of the denser distribution, and there can be at most one
+// of them strictly between two consecutive bucket sizes of the denser
+// distribution. This makes the lookup the one of the denser distribution, plus
+// one comparison. The constructor checks the constraints, so that they fail
+// the compilation of a constexpr distribution.
+class CustomBucketDistribution final {
+ public:
+  template <size_t N>
+  constexpr explicit CustomBucketDistribution(const size_t (&slot_sizes)[N])
+      : CustomBucketDistribution(slot_sizes, N) {
+    static_assert(N <= kNumBuckets, "Too many buckets");
+  }
+
+  constexpr CustomBucketDistribution(const size_t* slot_sizes, size_t count) {
+    PA_CHECK(count && count <= kNumBuckets);
+    constexpr BucketIndexLookup lookup{};
+    const size_t* dense_sizes = lookup.bucket_sizes();
+    size_t dense_count = 0;
+    while (dense_count < kNumBuckets &&
+           dense_sizes[dense_count] != kInvalidBucketSize) {
+      dense_count++;
+    }
+
+    for (size_t i = 0; i < kNumBuckets; i++)
+      slot_sizes_[i] = i < count ? slot_sizes[i] : kInvalidBucketSize;
+    for (size_t i = 0; i < count; i++) {
+      PA_CHECK(slot_sizes[i] >= kSmallestBucket);
+      PA_CHECK(slot_sizes[i] % kSmallestBucket == 0);
+      PA_CHECK(i == 0 || slot_sizes[i - 1] < slot_sizes[i]);
+    }
+    PA_CHECK(slot_sizes[count - 1] == dense_sizes[dense_count - 1]);
+
+    // The sizes in (dense_sizes[i - 1], dense_sizes[i]] go to the first slot
+    // size which fits them, and to the next one if it's the only one in the
+    // range and they are larger.
+    size_t index = 0;
+    for (size_t i = 0; i < dense_count; i++) {
+      size_t smallest_size = i == 0 ? 0 : dense_sizes[i - 1] + 1;
+      while (slot_sizes[index] < smallest_size)
+        index++;
+      entries_[i].index = static_cast<uint16_t>(index);
+      if (slot_sizes[index] < dense_sizes[i]) {
+        entries_[i].split_size = slot_sizes[index];
+        PA_CHECK(slot_sizes[index + 1] >= dense_sizes[i]);
+      } else {
+        entries_[i].split_size = std::numeric_limits<size_t>::max();
+      }
+    }
+    // The invalid buckets of the denser distribution are never looked up, and
+    // the sentinel stays the sentinel.
+    for (size_t i = dense_count; i <= kNumBuckets; i++) {
+      entries_[i].index = kNumBuckets;
+      entries_[i].split_size = std::numeric_limits<size_t>::max();
+    }
+  }
+
+  // Same as BucketIndexLookup::GetIndex(), the index of the bucket of
+  // |slot_sizes()| for |size|, or kNumBuckets past the largest one.
+  ALWAYS_INLINE constexpr uint16_t GetIndex(size_t size) const {
+    const Entry& entry =
+        entries_[BucketIndexLookup::GetIndexForDenserBuckets(size)];
+    return entry.index + (size > entry.split_size);
+  }
+
+  // kNumBuckets slot sizes, the unused ones being kInvalidBucketSize.
+  constexpr const size_t* slot_sizes() const { return &slot_sizes_[0]; }
+
+ private:
+  struct Entry {
+    size_t split_size = 0;
+    uint16_t index = 0;
+  };
+
+  size_t slot_sizes_[kNumBuckets]{};
+  // Indexed by the bucket index in the denser distribution, including the
+  // sentinel.
+  Entry entries_[kNumBuckets + 1]{};
+};
+
 }  // namespace partition_alloc::internal
 
 namespace base::internal {
@@ -274,6 +366,7 @@ namespace base::internal {
 // TODO(https://crbug.com/1288247): Remove these 'using' declarations once
 // the migration to the new namespaces gets done.
 using ::partition_alloc::internal::BucketIndexLookup;
+using ::partition_alloc::internal::CustomBucketDistribution;
 
 }  // namespace base::internal
 
@@ -663,6 +663,14 @@ void PartitionRoot<thread_safe>::Init(PartitionOptions opts) {
         IsConfigurablePoolAvailable();
     PA_DCHECK(!use_configurable_pool || IsConfigurablePoolAvailable());
 
+#if BUILDFLAG(IS_LINUX) || BUILDFLAG(IS_CHROMEOS) || BUILDFLAG(IS_ANDROID)
+    // A super page can only be backed by a huge page if huge pages are as
+    // large as super pages, which is the case with 4 KiB system pages.
+    use_huge_pages =
+        opts.huge_pages == PartitionOptions::HugePages::kEnabled &&
+        SystemPageSize() == (size_t{1} << 12);
+#endif
+
     // brp_enabled_() is not supported in the configurable pool because
     // BRP requires objects to be in a different Pool.
     PA_CHECK(!(use_configurable_pool && brp_enabled()));
@@ -715,13 +723,16 @@ void PartitionRoot<thread_safe>::Init(PartitionOptions opts) {
 
     // Set up the actual usable buckets first.
     constexpr internal::BucketIndexLookup lookup{};
+    custom_bucket_distribution = opts.custom_bucket_distribution;
+    const size_t* bucket_sizes = custom_bucket_distribution
+                                     ? custom_bucket_distribution->slot_sizes()
+                                     : lookup.bucket_sizes();
     size_t bucket_index = 0;
-    while (lookup.bucket_sizes()[bucket_index] != kInvalidBucketSize) {
-      buckets[bucket_index].Init(lookup.bucket_sizes()[bucket_index]);
+    while (bucket_index < kNumBuckets &&
+           bucket_sizes[bucket_index] != kInvalidBucketSize) {
+      buckets[bucket_index].Init(bucket_sizes[bucket_index]);
       bucket_index++;
     }
-    PA_DCHECK(bucket_index < kNumBuckets);
-
     // Remaining buckets are not usable, and not real.
     for (size_t index = bucket_index; index < kNumBuckets; index++) {
       // Cannot init with size 0 since it computes 1 / size, but make sure the
@@ -743,6 +754,17 @@ void PartitionRoot<thread_safe>::Init(PartitionOptions opts) {
       internal::ThreadCache::Init(this);
 #endif  // !defined(PA_THREAD_CACHE_SUPPORTED)
 
+#if defined(PA_PER_CPU_CACHE_SUPPORTED)
+    if (opts.per_cpu_cache == PartitionOptions::PerCpuCache::kEnabled) {
+      PA_CHECK(!with_thread_cache)
+          << "A partition with a thread cache cannot have per-CPU caches";
+      per_cpu_cache = internal::PerCpuCache::Create(this);
+      with_per_cpu_cache = true;
+    } else {
+      per_cpu_cache = nullptr;
+    }
+#endif  // defined(PA_PER_CPU_CACHE_SUPPORTED)
+
 #if defined(PA_USE_PARTITION_ROOT_ENUMERATOR)
     internal::PartitionRootEnumerator::Instance().Register(this);
 #endif
@@ -767,6 +789,11 @@ PartitionRoot<thread_safe>::~PartitionRoot() {
   if (initialized)
     internal::PartitionRootEnumerator::Instance().Unregister(this);
 #endif  // defined(PA_USE_PARTITION_ALLOC_ENUMERATOR)
+
+#if defined(PA_PER_CPU_CACHE_SUPPORTED)
+  if (with_per_cpu_cache)
+    internal::PerCpuCache::Destroy(per_cpu_cache);
+#endif
 }
 
 template <bool thread_safe>
@@ -774,6 +801,7 @@ void PartitionRoot<thread_safe>::EnableThreadCacheIfSupported() {
 #if defined(PA_THREAD_CACHE_SUPPORTED)
   ::partition_alloc::internal::ScopedGuard guard{lock_};
   PA_CHECK(!with_thread_cache);
+  PA_CHECK(!with_per_cpu_cache);
   // By the time we get there, there may be multiple threads created in the
   // process. Since `with_thread_cache` is accessed without a lock, it can
   // become visible to another thread before the effects of
@@ -812,15 +840,6 @@ bool PartitionRoot<thread_safe>::TryReallocInPlaceForDirectMap(
   if (new_reservation_size > current_reservation_size)
     return false;
 
-  // Don't reallocate in-place if new reservation size would be less than 80 %
-  // of the current one, to avoid holding on to too much unused address space.
-  // Make this check before comparing slot sizes, as even with equal or similar
-  // slot sizes we can save a lot if the original allocation was heavily padded
-  // for alignment.
-  if ((new_reservation_size >> SystemPageShift()) * 5 <
-      (current_reservation_size >> SystemPageShift()) * 4)
-    return false;
-
   // Note that the new size isn't a bucketed size; this function is called
   // whenever we're reallocating a direct mapped allocation, so calculate it
   // the way PartitionDirectMap() would.
@@ -828,6 +847,20 @@ bool PartitionRoot<thread_safe>::TryReallocInPlaceForDirectMap(
   if (new_slot_size < kMinDirectMappedDownsize)
     return false;
 
+  // Don't reallocate in-place if new reservation size would be less than 80 %
+  // of the current one, to avoid holding on to too much unused address space.
+  // Make this check before comparing slot sizes, as even with equal or similar
+  // slot sizes we can save a lot if the original allocation was heavily padded
+  // for alignment. Growing into the headroom reserved by ReallocFlags() is
+  // fine though, as that's what it was reserved for.
+  const bool grows_into_headroom =
+      new_slot_size > slot_span->bucket->slot_size &&
+      !extent->padding_for_alignment;
+  if (!grows_into_headroom &&
+      (new_reservation_size >> SystemPageShift()) * 5 <
+          (current_reservation_size >> SystemPageShift()) * 4)
+    return false;
+
   // Past this point, we decided we'll attempt to reallocate without relocating,
   // so we have to honor the padding for alignment in front of the original
   // allocation, even though this function isn't requesting any alignment.
@@ -1018,6 +1051,12 @@ void* PartitionRoot<thread_safe>::ReallocFlags(int flags,
   }
 
   // This realloc cannot be resized in-place. Sadness.
+  //
+  // An allocation which grows is likely to grow again (e.g. a buffer which is
+  // appended to), let the next reallocations be in-place if it's large enough
+  // to be direct-mapped.
+  if (new_size > old_usable_size)
+    flags |= PartitionAllocReserveHeadroom;
   void* ret = no_hooks ? AllocFlagsNoHooks(flags, new_size, PartitionPageSize())
                        : AllocFlagsInternal(flags, new_size,
                                             PartitionPageSize(), type_name);
@@ -1035,6 +1074,12 @@ void* PartitionRoot<thread_safe>::ReallocFlags(int flags,
 
 template <bool thread_safe>
 void PartitionRoot<thread_safe>::PurgeMemory(int flags) {
+#if defined(PA_PER_CPU_CACHE_SUPPORTED)
+  // Returns the cached slots to the partition, so must come before decommitting
+  // the slot spans which become empty, and without the lock held.
+  if (with_per_cpu_cache && (flags & PartitionPurgeDecommitEmptySlotSpans))
+    per_cpu_cache->Purge();
+#endif
   {
     ::partition_alloc::internal::ScopedGuard guard{lock_};
     // Avoid purging if there is PCScan task currently scheduled. Since pcscan
@@ -1050,7 +1095,9 @@ void PartitionRoot<thread_safe>::PurgeMemory(int flags) {
         if (bucket.slot_size == kInvalidBucketSize)
           continue;
 
-        if (bucket.slot_size >= SystemPageSize())
+        // Discarding system pages would split the huge pages, see
+        // DecommitSystemPagesForData().
+        if (bucket.slot_size >= SystemPageSize() && !use_huge_pages)
           internal::PartitionPurgeBucket(&bucket);
         else
           bucket.SortSlotSpanFreelists();
@@ -56,6 +56,7 @@
 #include "base/allocator/partition_allocator/partition_oom.h"
 #include "base/allocator/partition_allocator/partition_page.h"
 #include "base/allocator/partition_allocator/partition_ref_count.h"
+#include "base/allocator/partition_allocator/per_cpu_cache.h"
 #include "base/allocator/partition_allocator/reservation_offset_table.h"
 #include "base/allocator/partition_allocator/starscan/pcscan.h"
 #include "base/allocator/partition_allocator/starscan/state_bitmap.h"
@@ -143,6 +144,14 @@ struct PartitionOptions {
     kEnabled,
   };
 
+  // Whether the partition caches free slots per CPU, see
+  // internal::PerCpuCache. Exclusive with the thread cache. Only supported on
+  // Linux and ChromeOS, ignored elsewhere.
+  enum class PerCpuCache : uint8_t {
+    kDisabled,
+    kEnabled,
+  };
+
   enum class Quarantine : uint8_t {
     kDisallowed,
     kAllowed,
@@ -163,6 +172,16 @@ struct PartitionOptions {
     kIfAvailable,
   };
 
+  // Whether super pages are backed by transparent huge pages where the system
+  // supports them, which saves TLB misses in partitions with a large, hot
+  // working set. Super pages are then committed as a whole and lose their
+  // guard pages, and the memory of freed slots stays resident. Only supported
+  // on Linux, ChromeOS and Android, ignored elsewhere.
+  enum class HugePages : uint8_t {
+    kDisabled,
+    kEnabled,
+  };
+
   // Constructor to suppress aggregate initialization.
   constexpr PartitionOptions(AlignedAlloc aligned_alloc,
                              ThreadCache thread_cache,
@@ -183,6 +202,13 @@ struct PartitionOptions {
   Cookie cookie;
   BackupRefPtr backup_ref_ptr;
   UseConfigurablePool use_configurable_pool;
+  // Not a constructor parameter, since few partitions enable it.
+  HugePages huge_pages = HugePages::kDisabled;
+  PerCpuCache per_cpu_cache = PerCpuCache::kDisabled;
+  // The slot sizes of the partition, instead of the default ones, see
+  // internal::CustomBucketDistribution. Must outlive the partition.
+  const internal::CustomBucketDistribution* custom_bucket_distribution =
+      nullptr;
 };
 
 // Never instantiate a PartitionRoot directly, instead use
@@ -231,7 +257,11 @@ struct alignas(64) BASE_EXPORT PartitionRoot {
       ScanMode scan_mode;
 
       bool with_thread_cache = false;
+      bool with_per_cpu_cache = false;
       bool with_denser_bucket_distribution = false;
+      // Whether the bucket distribution changed after allocations were made,
+      // in which case their size may no longer give their bucket.
+      bool bucket_distribution_switched = false;
 
       bool allow_aligned_alloc;
       bool allow_cookie;
@@ -240,6 +270,12 @@ struct alignas(64) BASE_EXPORT PartitionRoot {
 #endif
       bool use_configurable_pool;
 
+#if defined(PA_PER_CPU_CACHE_SUPPORTED)
+      internal::PerCpuCache* per_cpu_cache;
+#endif
+      // nullptr for the default distributions.
+      const internal::CustomBucketDistribution* custom_bucket_distribution;
+
 #if defined(PA_EXTRAS_REQUIRED)
       uint32_t extras_size;
       uint32_t extras_offset;
@@ -262,6 +298,9 @@ struct alignas(64) BASE_EXPORT PartitionRoot {
 
   // All fields below this comment are not accessed on the fast path.
   bool initialized = false;
+  // Whether super pages are backed by huge pages, see
+  // PartitionOptions::HugePages.
+  bool use_huge_pages = false;
 
   // Bookkeeping.
   // - total_size_of_super_pages - total virtual address space for normal bucket
@@ -453,6 +492,19 @@ struct alignas(64) BASE_EXPORT PartitionRoot {
   NOINLINE static void Free(void* object);
   // Same as |Free()|, bypasses the allocator hooks.
   ALWAYS_INLINE static void FreeNoHooks(void* object);
+  // Same as |FreeNoHooks()|, for an object allocated with |requested_size|
+  // bytes (e.g. by the sized operator delete). The bucket of the object is
+  // then found from the size, so that a free which goes to the thread cache
+  // doesn't read the slot span metadata.
+  ALWAYS_INLINE static void FreeNoHooksWithSize(void* object,
+                                                size_t requested_size);
+  // Frees the |count| pointers of |objects|, some of which may be null, as
+  // |Free()| would one by one. Objects freed in a row from the same slot span
+  // (e.g. the elements of a large container) go to its freelist at once, with
+  // a single lock acquisition, instead of through the thread cache.
+  NOINLINE static void FreeBatch(void* const* objects, size_t count);
+  // Same as |FreeBatch()|, bypasses the allocator hooks.
+  NOINLINE static void FreeBatchNoHooks(void* const* objects, size_t count);
   // Immediately frees the pointer bypassing the quarantine. |slot_start| is the
   // beginning of the slot that contains |object|.
   ALWAYS_INLINE void FreeNoHooksImmediate(void* object,
@@ -488,6 +540,8 @@ struct alignas(64) BASE_EXPORT PartitionRoot {
 
   static uint16_t SizeToBucketIndex(size_t size,
                                     bool with_denser_bucket_distribution);
+  // The bucket index of |size| in the current distribution of the partition.
+  ALWAYS_INLINE uint16_t SizeToBucketIndex(size_t size) const;
 
   ALWAYS_INLINE void FreeInSlotSpan(uintptr_t slot_start, SlotSpan* slot_span)
       EXCLUSIVE_LOCKS_REQUIRED(lock_);
@@ -504,12 +558,19 @@ struct alignas(64) BASE_EXPORT PartitionRoot {
 
   ALWAYS_INLINE void RawFreeWithThreadCache(uintptr_t slot_start,
                                             SlotSpan* slot_span);
+  // Same as above, with |bucket| the bucket of |slot_span|, when it's known
+  // without reading the slot span.
+  ALWAYS_INLINE void RawFreeWithThreadCache(uintptr_t slot_start,
+                                            SlotSpan* slot_span,
+                                            Bucket* bucket);
 
   // This is safe to do because we are switching to a bucket distribution with
   // more buckets, meaning any allocations we have done before the switch are
   // guaranteed to have a bucket under the new distribution when they are
   // eventually deallocated. We do not need synchronization here or below.
   void SwitchToDenserBucketDistribution() {
+    PA_DCHECK(!custom_bucket_distribution);
+    bucket_distribution_switched |= !with_denser_bucket_distribution;
     with_denser_bucket_distribution = true;
   }
   // Switching back to the less dense bucket distribution is ok during tests.
@@ -517,12 +578,18 @@ struct alignas(64) BASE_EXPORT PartitionRoot {
   // cannot allocate from, which will not cause problems besides wasting
   // memory.
   void ResetBucketDistributionForTesting() {
+    bucket_distribution_switched |= with_denser_bucket_distribution;
     with_denser_bucket_distribution = false;
   }
 
   internal::ThreadCache* thread_cache_for_testing() const {
     return with_thread_cache ? internal::ThreadCache::Get() : nullptr;
   }
+#if defined(PA_PER_CPU_CACHE_SUPPORTED)
+  internal::PerCpuCache* per_cpu_cache_for_testing() const {
+    return with_per_cpu_cache ? per_cpu_cache : nullptr;
+  }
+#endif
   size_t get_total_size_of_committed_pages() const {
     return total_size_of_committed_pages.load(std::memory_order_relaxed);
   }
@@ -775,8 +842,24 @@ struct alignas(64) BASE_EXPORT PartitionRoot {
   void DecommitEmptySlotSpans() EXCLUSIVE_LOCKS_REQUIRED(lock_);
   ALWAYS_INLINE void RawFreeLocked(uintptr_t slot_start)
       EXCLUSIVE_LOCKS_REQUIRED(lock_);
+  // Frees |object| from |slot_span|, whose bucket is |bucket|. Reads
+  // |*slot_span| only when |bucket| isn't enough (quarantine, cookies,
+  // BackupRefPtr, or a thread cache miss).
+  ALWAYS_INLINE void FreeNoHooksInBucket(void* object,
+                                         SlotSpan* slot_span,
+                                         Bucket* bucket);
+  // Performs the checks and bookkeeping which precede the release of the slot
+  // of |object| in FreeNoHooksImmediate(). Returns false if the slot must not
+  // be released yet, as BackupRefPtr still references it.
+  ALWAYS_INLINE bool PrepareSlotForFree(void* object,
+                                        SlotSpan* slot_span,
+                                        uintptr_t slot_start);
   uintptr_t MaybeInitThreadCacheAndAlloc(uint16_t bucket_index,
                                          size_t* slot_size);
+  // Allocates from the thread cache or the per-CPU caches, whichever the
+  // partition has. Returns 0 on a miss.
+  ALWAYS_INLINE uintptr_t GetFromCache(uint16_t bucket_index,
+                                       size_t* slot_size);
 
 #if defined(PA_USE_PARTITION_ROOT_ENUMERATOR)
   static internal::PartitionLock& GetEnumeratorLock();
@@ -788,6 +871,9 @@ struct alignas(64) BASE_EXPORT PartitionRoot {
 #endif  // defined(PA_USE_PARTITION_ROOT_ENUMERATOR)
 
   friend class internal::ThreadCache;
+#if defined(PA_PER_CPU_CACHE_SUPPORTED)
+  friend class internal::PerCpuCache;
+#endif
 };
 
 namespace internal {
@@ -1045,6 +1131,25 @@ NOINLINE void PartitionRoot<thread_safe>::Free(void* object) {
 #endif  // defined(MEMORY_TOOL_REPLACES_ALLOCATOR)
 }
 
+// static
+template <bool thread_safe>
+NOINLINE void PartitionRoot<thread_safe>::FreeBatch(void* const* objects,
+                                                    size_t count) {
+#if defined(MEMORY_TOOL_REPLACES_ALLOCATOR)
+  for (size_t i = 0; i < count; ++i)
+    free(objects[i]);
+#else
+  // The hooks observe the objects one by one.
+  if (PartitionAllocHooks::AreHooksEnabled()) {
+    for (size_t i = 0; i < count; ++i)
+      Free(objects[i]);
+    return;
+  }
+
+  FreeBatchNoHooks(objects, count);
+#endif  // defined(MEMORY_TOOL_REPLACES_ALLOCATOR)
+}
+
 // static
 template <bool thread_safe>
 ALWAYS_INLINE void PartitionRoot<thread_safe>::FreeNoHooks(void* object) {
@@ -1088,21 +1193,69 @@ ALWAYS_INLINE void PartitionRoot<thread_safe>::FreeNoHooks(void* object) {
   SlotSpan* slot_span = SlotSpan::FromObject(object);
   PA_DCHECK(FromSlotSpan(slot_span) == root);
 
-  uintptr_t slot_start = root->ObjectToSlotStart(object);
-  PA_DCHECK(slot_span = SlotSpan::FromSlotStart(slot_start));
-
   // We are going to read from |*slot_span| in all branches. Since
-  // |FromSlotSpan()| below doesn't touch *slot_span, there is some time for the
+  // |ObjectToSlotStart()| doesn't touch *slot_span, there is some time for the
   // prefetch to be useful.
   //
   // TODO(crbug.com/1207307): It would be much better to avoid touching
   // |*slot_span| at all on the fast path, or at least to separate its read-only
   // parts (i.e. bucket pointer) from the rest. Indeed, every thread cache miss
   // (or batch fill) will *write* to |slot_span->freelist_head|, leading to
-  // cacheline ping-pong.
+  // cacheline ping-pong. FreeNoHooksWithSize() does that when the size is
+  // known.
   PA_PREFETCH(slot_span);
 
-  const size_t slot_size = slot_span->bucket->slot_size;
+  root->FreeNoHooksInBucket(object, slot_span, slot_span->bucket);
+}
+
+// static
+template <bool thread_safe>
+ALWAYS_INLINE void PartitionRoot<thread_safe>::FreeNoHooksWithSize(
+    void* object,
+    size_t requested_size) {
+  if (UNLIKELY(!object))
+    return;
+  PA_PREFETCH(object);
+  uintptr_t object_addr = ObjectPtr2Addr(object);
+
+  // See FreeNoHooks().
+#if BUILDFLAG(USE_PARTITION_ALLOC_AS_MALLOC) &&              \
+    ((BUILDFLAG(IS_ANDROID) && !BUILDFLAG(IS_CHROMECAST)) || \
+     (BUILDFLAG(IS_LINUX) && defined(ARCH_CPU_64_BITS)))
+  PA_CHECK(IsManagedByPartitionAlloc(object_addr));
+#endif
+
+  auto* root = FromAddrInFirstSuperpage(object_addr);
+  // The size gives the bucket as it did for the allocation, unless the object
+  // is direct-mapped, or the bucket distribution changed since. Then the bucket
+  // has to come from the slot span.
+  const size_t raw_size = root->AdjustSizeForExtrasAdd(requested_size);
+  if (UNLIKELY(raw_size > kMaxBucketed || raw_size < requested_size ||
+               root->bucket_distribution_switched)) {
+    FreeNoHooks(object);
+    return;
+  }
+  Bucket* bucket = root->buckets + root->SizeToBucketIndex(raw_size);
+
+  // Not prefetched: in the common case, the object goes to the thread cache,
+  // and |*slot_span| isn't read.
+  SlotSpan* slot_span = SlotSpan::FromObject(object);
+  PA_DCHECK(FromSlotSpan(slot_span) == root);
+  // If this fires, the object was not allocated with |requested_size| bytes.
+  PA_DCHECK(slot_span->bucket == bucket);
+
+  root->FreeNoHooksInBucket(object, slot_span, bucket);
+}
+
+template <bool thread_safe>
+ALWAYS_INLINE void PartitionRoot<thread_safe>::FreeNoHooksInBucket(
+    void* object,
+    SlotSpan* slot_span,
+    Bucket* bucket) {
+  uintptr_t slot_start = ObjectToSlotStart(object);
+  PA_DCHECK(slot_span == SlotSpan::FromSlotStart(slot_start));
+
+  const size_t slot_size = bucket->slot_size;
   if (LIKELY(slot_size <= kMaxMemoryTaggingSize)) {
     // Incrementing the memory range returns the true underlying tag, so
     // RemaskPtr is not required here.
@@ -1114,17 +1267,97 @@ ALWAYS_INLINE void PartitionRoot<thread_safe>::FreeNoHooks(void* object) {
 
   // TODO(bikineev): Change the condition to LIKELY once PCScan is enabled by
   // default.
-  if (UNLIKELY(root->ShouldQuarantine(slot_start))) {
+  if (UNLIKELY(ShouldQuarantine(slot_start))) {
     // PCScan safepoint. Call before potentially scheduling scanning task.
     PCScan::JoinScanIfNeeded();
     if (LIKELY(internal::IsManagedByNormalBuckets(slot_start))) {
-      PCScan::MoveToQuarantine(object, slot_span->GetUsableSize(root),
-                               slot_start, slot_span->bucket->slot_size);
+      PCScan::MoveToQuarantine(object, slot_span->GetUsableSize(this),
+                               slot_start, slot_size);
       return;
     }
   }
 
-  root->FreeNoHooksImmediate(object, slot_span, slot_start);
+  if (LIKELY(PrepareSlotForFree(object, slot_span, slot_start)))
+    RawFreeWithThreadCache(slot_start, slot_span, bucket);
+}
+
+// static
+template <bool thread_safe>
+NOINLINE void PartitionRoot<thread_safe>::FreeBatchNoHooks(
+    void* const* objects,
+    size_t count) {
+  // The current run of consecutive objects from the same slot span, linked
+  // into a freelist.
+  PartitionRoot* run_root = nullptr;
+  SlotSpan* run_slot_span = nullptr;
+  uintptr_t run_slot_start = 0;
+  FreeListEntry* run_head = nullptr;
+  FreeListEntry* run_tail = nullptr;
+  size_t run_size = 0;
+
+  auto flush_run = [&]() {
+    if (run_size == 1) {
+      // Not worth the lock, the thread cache is likely to take it.
+      run_root->RawFreeWithThreadCache(run_slot_start, run_slot_span);
+    } else if (run_size) {
+      run_root->RawFreeBatch(run_head, run_tail, run_size, run_slot_span);
+    }
+    run_head = run_tail = nullptr;
+    run_size = 0;
+  };
+
+  for (size_t i = 0; i < count; ++i) {
+    void* object = objects[i];
+    if (UNLIKELY(!object))
+      continue;
+    uintptr_t object_addr = ObjectPtr2Addr(object);
+
+    // See FreeNoHooks().
+#if BUILDFLAG(USE_PARTITION_ALLOC_AS_MALLOC) &&              \
+    ((BUILDFLAG(IS_ANDROID) && !BUILDFLAG(IS_CHROMECAST)) || \
+     (BUILDFLAG(IS_LINUX) && defined(ARCH_CPU_64_BITS)))
+    PA_CHECK(IsManagedByPartitionAlloc(object_addr));
+#endif
+
+    auto* root = FromAddrInFirstSuperpage(object_addr);
+    SlotSpan* slot_span = SlotSpan::FromObject(object);
+    PA_DCHECK(FromSlotSpan(slot_span) == root);
+    // Quarantined objects are freed later, one by one, and direct-mapped ones
+    // are alone in their slot span.
+    if (UNLIKELY(root->IsQuarantineEnabled() ||
+                 root->IsDirectMappedBucket(slot_span->bucket))) {
+      FreeNoHooks(object);
+      continue;
+    }
+
+    uintptr_t slot_start = root->ObjectToSlotStart(object);
+    PA_DCHECK(slot_span == SlotSpan::FromSlotStart(slot_start));
+    const size_t slot_size = slot_span->bucket->slot_size;
+    if (LIKELY(slot_size <= kMaxMemoryTaggingSize)) {
+      slot_start = ::partition_alloc::internal::TagMemoryRangeIncrement(
+          slot_start, slot_size);
+      object = ::partition_alloc::internal::RemaskPtr(object);
+    }
+    if (UNLIKELY(!root->PrepareSlotForFree(object, slot_span, slot_start)))
+      continue;
+
+    if (slot_span != run_slot_span) {
+      flush_run();
+      run_root = root;
+      run_slot_span = slot_span;
+      run_slot_start = slot_start;
+    }
+    auto* entry = FreeListEntry::EmplaceAndInitNull(slot_start);
+    // Catches an immediate double free, as SlotSpanMetadata::Free() does.
+    PA_CHECK(entry != run_tail);
+    if (run_tail)
+      run_tail->SetNext(entry);
+    else
+      run_head = entry;
+    run_tail = entry;
+    ++run_size;
+  }
+  flush_run();
 }
 
 template <bool thread_safe>
@@ -1132,6 +1365,15 @@ ALWAYS_INLINE void PartitionRoot<thread_safe>::FreeNoHooksImmediate(
     void* object,
     SlotSpan* slot_span,
     uintptr_t slot_start) {
+  if (LIKELY(PrepareSlotForFree(object, slot_span, slot_start)))
+    RawFreeWithThreadCache(slot_start, slot_span);
+}
+
+template <bool thread_safe>
+ALWAYS_INLINE bool PartitionRoot<thread_safe>::PrepareSlotForFree(
+    void* object,
+    SlotSpan* slot_span,
+    uintptr_t slot_start) {
   // The thread cache is added "in the middle" of the main allocator, that is:
   // - After all the cookie/ref-count management
   // - Before the "raw" allocator.
@@ -1205,7 +1447,7 @@ ALWAYS_INLINE void PartitionRoot<thread_safe>::FreeNoHooksImmediate(
           slot_span->GetSlotSizeForBookkeeping(), std::memory_order_relaxed);
       total_count_of_brp_quarantined_slots.fetch_add(1,
                                                      std::memory_order_relaxed);
-      return;
+      return false;
     }
   }
 #endif  // BUILDFLAG(USE_BACKUP_REF_PTR)
@@ -1232,7 +1474,7 @@ ALWAYS_INLINE void PartitionRoot<thread_safe>::FreeNoHooksImmediate(
   }
 #endif  // defined(PA_ZERO_RANDOMLY_ON_FREE)
 
-  RawFreeWithThreadCache(slot_start, slot_span);
+  return true;
 }
 
 template <bool thread_safe>
@@ -1303,7 +1545,9 @@ ALWAYS_INLINE void PartitionRoot<thread_safe>::RawFreeBatch(
   // corresponding pages were faulted in (without acquiring the lock). So there
   // is no need to touch pages manually here before the lock.
   ::partition_alloc::internal::ScopedGuard guard{lock_};
-  DecreaseTotalSizeOfAllocatedBytes(slot_span);
+  DecreaseTotalSizeOfAllocatedBytes(
+      reinterpret_cast<uintptr_t>(slot_span),
+      size * slot_span->GetSlotSizeForBookkeeping());
   slot_span->AppendFreeList(head, tail, size);
 }
 
@@ -1311,18 +1555,34 @@ template <bool thread_safe>
 ALWAYS_INLINE void PartitionRoot<thread_safe>::RawFreeWithThreadCache(
     uintptr_t slot_start,
     SlotSpan* slot_span) {
+  RawFreeWithThreadCache(slot_start, slot_span, slot_span->bucket);
+}
+
+template <bool thread_safe>
+ALWAYS_INLINE void PartitionRoot<thread_safe>::RawFreeWithThreadCache(
+    uintptr_t slot_start,
+    SlotSpan* slot_span,
+    Bucket* bucket) {
+  PA_DCHECK(slot_span->bucket == bucket);
   // TLS access can be expensive, do a cheap local check first.
   //
   // LIKELY: performance-sensitive partitions have a thread cache, direct-mapped
   // allocations are uncommon.
-  if (LIKELY(with_thread_cache && !IsDirectMappedBucket(slot_span->bucket))) {
-    size_t bucket_index = slot_span->bucket - this->buckets;
+  if (LIKELY(with_thread_cache && !IsDirectMappedBucket(bucket))) {
+    size_t bucket_index = bucket - this->buckets;
     auto* thread_cache = internal::ThreadCache::Get();
     if (LIKELY(internal::ThreadCache::IsValid(thread_cache) &&
                thread_cache->MaybePutInCache(slot_start, bucket_index))) {
       return;
     }
   }
+#if defined(PA_PER_CPU_CACHE_SUPPORTED)
+  if (with_per_cpu_cache && !IsDirectMappedBucket(bucket)) {
+    size_t bucket_index = bucket - this->buckets;
+    if (LIKELY(per_cpu_cache->MaybePutInCache(slot_start, bucket_index)))
+      return;
+  }
+#endif
 
   RawFree(slot_start, slot_span);
 }
@@ -1447,8 +1707,16 @@ ALWAYS_INLINE void PartitionRoot<thread_safe>::DecommitSystemPagesForData(
     uintptr_t address,
     size_t length,
     PageAccessibilityDisposition accessibility_disposition) {
-  internal::ScopedSyscallTimer timer{this};
-  DecommitSystemPages(address, length, accessibility_disposition);
+  // Releasing a part of a huge page would split it, which costs more than the
+  // memory it saves in a partition hot enough to use huge pages. The memory is
+  // accounted as decommitted regardless, so that the slot span goes through
+  // the usual recommit path when it's reused.
+  if (!use_huge_pages ||
+      accessibility_disposition ==
+          PageAccessibilityDisposition::kRequireUpdate) {
+    internal::ScopedSyscallTimer timer{this};
+    DecommitSystemPages(address, length, accessibility_disposition);
+  }
   DecreaseCommittedPages(length);
 }
 
@@ -1544,6 +1812,14 @@ ALWAYS_INLINE uint16_t PartitionRoot<thread_safe>::SizeToBucketIndex(
     return internal::BucketIndexLookup::GetIndex(size);
 }
 
+template <bool thread_safe>
+ALWAYS_INLINE uint16_t
+PartitionRoot<thread_safe>::SizeToBucketIndex(size_t size) const {
+  if (UNLIKELY(custom_bucket_distribution))
+    return custom_bucket_distribution->GetIndex(size);
+  return SizeToBucketIndex(size, with_denser_bucket_distribution);
+}
+
 template <bool thread_safe>
 ALWAYS_INLINE void* PartitionRoot<thread_safe>::AllocFlags(
     int flags,
@@ -1596,6 +1872,22 @@ ALWAYS_INLINE void* PartitionRoot<thread_safe>::AllocFlagsInternal(
 #endif  // defined(MEMORY_TOOL_REPLACES_ALLOCATOR)
 }
 
+template <bool thread_safe>
+ALWAYS_INLINE uintptr_t
+PartitionRoot<thread_safe>::GetFromCache(uint16_t bucket_index,
+                                         size_t* slot_size) {
+#if defined(PA_PER_CPU_CACHE_SUPPORTED)
+  if (UNLIKELY(with_per_cpu_cache))
+    return per_cpu_cache->GetFromCache(bucket_index, slot_size);
+#endif
+  auto* tcache = internal::ThreadCache::Get();
+  // LIKELY: Typically always true, except for the very first allocation of
+  // this thread.
+  if (LIKELY(internal::ThreadCache::IsValid(tcache)))
+    return tcache->GetFromCache(bucket_index, slot_size);
+  return MaybeInitThreadCacheAndAlloc(bucket_index, slot_size);
+}
+
 template <bool thread_safe>
 ALWAYS_INLINE void* PartitionRoot<thread_safe>::AllocFlagsNoHooks(
     int flags,
@@ -1622,8 +1914,7 @@ ALWAYS_INLINE void* PartitionRoot<thread_safe>::AllocFlagsNoHooks(
   // Otherwise, we risk having |with_denser_bucket_distribution| changed
   // underneath us (between calls to |SizeToBucketIndex| during the same call),
   // which would result in an inconsistent state.
-  uint16_t bucket_index =
-      SizeToBucketIndex(raw_size, with_denser_bucket_distribution);
+  uint16_t bucket_index = SizeToBucketIndex(raw_size);
   size_t usable_size;
   bool is_already_zeroed = false;
   uintptr_t slot_start = 0;
@@ -1640,16 +1931,11 @@ ALWAYS_INLINE void* PartitionRoot<thread_safe>::AllocFlagsNoHooks(
   // Don't use thread cache if higher order alignment is requested, because the
   // thread cache will not be able to satisfy it.
   //
-  // LIKELY: performance-sensitive partitions use the thread cache.
-  if (LIKELY(with_thread_cache && slot_span_alignment <= PartitionPageSize())) {
-    auto* tcache = internal::ThreadCache::Get();
-    // LIKELY: Typically always true, except for the very first allocation of
-    // this thread.
-    if (LIKELY(internal::ThreadCache::IsValid(tcache))) {
-      slot_start = tcache->GetFromCache(bucket_index, &slot_size);
-    } else {
-      slot_start = MaybeInitThreadCacheAndAlloc(bucket_index, &slot_size);
-    }
+  // LIKELY: performance-sensitive partitions use the thread cache, or the
+  // per-CPU caches.
+  if (LIKELY((with_thread_cache || with_per_cpu_cache) &&
+             slot_span_alignment <= PartitionPageSize())) {
+    slot_start = GetFromCache(bucket_index, &slot_size);
 
     // LIKELY: median hit rate in the thread cache is 95%, from metrics.
     if (LIKELY(slot_start)) {
@@ -1910,8 +2196,7 @@ PartitionRoot<thread_safe>::AllocationCapacityFromRequestedSize(
 #else
   PA_DCHECK(PartitionRoot<thread_safe>::initialized);
   size = AdjustSizeForExtrasAdd(size);
-  auto& bucket =
-      bucket_at(SizeToBucketIndex(size, with_denser_bucket_distribution));
+  auto& bucket = bucket_at(SizeToBucketIndex(size));
   PA_DCHECK(!bucket.slot_size || bucket.slot_size >= size);
   PA_DCHECK(!(bucket.slot_size % kSmallestBucket));
 
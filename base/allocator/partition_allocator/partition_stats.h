@@ -30,7 +30,11 @@ struct ThreadCacheStats {
   uint64_t cache_fill_hits;
   uint64_t cache_fill_misses;  // Object too large.
 
-  uint64_t batch_fill_count;  // Number of central allocator requests.
+  uint64_t batch_fill_count;   // Number of central allocator requests.
+  uint64_t batch_clear_count;  // Number of central allocator releases.
+
+  // See ThreadCacheRegistry::SetAdaptiveLimits().
+  uint64_t limit_rebalance_count;
 
   // Memory cost:
   uint32_t bucket_total_memory;
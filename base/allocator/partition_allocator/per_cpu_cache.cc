@@ -0,0 +1,171 @@
+// Copyright 2022 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "base/allocator/partition_allocator/per_cpu_cache.h"
+
+#if defined(PA_PER_CPU_CACHE_SUPPORTED)
+
+#include <sys/sysinfo.h>
+
+#include <algorithm>
+#include <new>
+
+#include "base/allocator/partition_allocator/page_allocator.h"
+#include "base/allocator/partition_allocator/partition_alloc_check.h"
+#include "base/allocator/partition_allocator/partition_root.h"
+#include "base/bits.h"
+
+namespace base::internal {
+
+// static
+PerCpuCache* PerCpuCache::Create(PartitionRoot<>* root) {
+  // Includes the CPUs which are offline, which may come online later.
+  size_t cpu_count = std::max(get_nprocs_conf(), 1);
+  size_t size = bits::AlignUp(sizeof(PerCpuCache), alignof(CpuCache)) +
+                cpu_count * sizeof(CpuCache);
+  size_t reserved_size = bits::AlignUp(size, PageAllocationGranularity());
+  uintptr_t buffer =
+      AllocPages(reserved_size, PageAllocationGranularity(),
+                 PageAccessibilityConfiguration::kReadWrite,
+                 PageTag::kPartitionAlloc);
+  PA_CHECK(buffer);
+  return new (reinterpret_cast<void*>(buffer))
+      PerCpuCache(root, cpu_count, reserved_size);
+}
+
+// static
+void PerCpuCache::Destroy(PerCpuCache* cache) {
+  cache->Purge();
+  size_t reserved_size = cache->reserved_size_;
+  cache->~PerCpuCache();
+  FreePages(reinterpret_cast<uintptr_t>(cache), reserved_size);
+}
+
+PerCpuCache::PerCpuCache(PartitionRoot<>* root,
+                         size_t cpu_count,
+                         size_t reserved_size)
+    : root_(root),
+      cpu_count_(cpu_count),
+      reserved_size_(reserved_size),
+      caches_(reinterpret_cast<CpuCache*>(bits::AlignUp(
+          reinterpret_cast<uintptr_t>(this + 1), alignof(CpuCache)))) {
+  for (size_t cpu = 0; cpu < cpu_count_; cpu++) {
+    CpuCache* cache = new (&caches_[cpu]) CpuCache();
+    for (size_t index = 0; index < kBucketCount; index++) {
+      const auto& root_bucket = root_->buckets[index];
+      // Invalid bucket.
+      if (!root_bucket.active_slot_spans_head)
+        continue;
+      Bucket& bucket = cache->buckets[index];
+      bucket.slot_size = root_bucket.slot_size;
+      bucket.limit = ThreadCache::GetBucketLimit(
+          root_bucket.slot_size, ThreadCache::kDefaultMultiplier);
+    }
+  }
+}
+
+PerCpuCache::~PerCpuCache() {
+  for (size_t cpu = 0; cpu < cpu_count_; cpu++)
+    caches_[cpu].~CpuCache();
+}
+
+void PerCpuCache::Purge() {
+  for (size_t cpu = 0; cpu < cpu_count_; cpu++) {
+    CpuCache& cache = caches_[cpu];
+    if (!cache.TryAcquire())
+      continue;
+    for (auto& bucket : cache.buckets)
+      ClearBucket(cache, bucket, 0);
+    cache.Release();
+  }
+}
+
+size_t PerCpuCache::CachedMemory() {
+  size_t cached_memory = 0;
+  for (size_t cpu = 0; cpu < cpu_count_; cpu++) {
+    CpuCache& cache = caches_[cpu];
+    if (!cache.TryAcquire())
+      continue;
+    cached_memory += cache.cached_memory;
+    cache.Release();
+  }
+  return cached_memory;
+}
+
+void PerCpuCache::FillBucket(CpuCache& cache, size_t bucket_index) {
+  // Same policy as ThreadCache::FillBucket(), see the comments there. The lock
+  // of the root is taken while the cache of the CPU is in use, in which case
+  // the other threads running on it fall back to the central allocator.
+  Bucket& bucket = cache.buckets[bucket_index];
+  int count = std::max(1, bucket.limit / ThreadCache::kBatchFillRatio);
+
+  size_t usable_size;
+  bool is_already_zeroed;
+
+  PA_DCHECK(!root_->buckets[bucket_index].CanStoreRawSize());
+  PA_DCHECK(!root_->buckets[bucket_index].is_direct_mapped());
+
+  size_t allocated_slots = 0;
+  ::partition_alloc::internal::ScopedGuard guard(root_->lock_);
+  for (int i = 0; i < count; i++) {
+    uintptr_t slot_start = root_->AllocFromBucket(
+        &root_->buckets[bucket_index],
+        PartitionAllocFastPathOrReturnNull | PartitionAllocReturnNull,
+        root_->buckets[bucket_index].slot_size /* raw_size */,
+        PartitionPageSize(), &usable_size, &is_already_zeroed);
+    if (!slot_start)
+      break;
+
+    allocated_slots++;
+    auto* entry = PartitionFreelistEntry::EmplaceAndInitForThreadCache(
+        slot_start, bucket.freelist_head);
+    bucket.freelist_head = entry;
+    bucket.count++;
+  }
+
+  cache.cached_memory += allocated_slots * bucket.slot_size;
+}
+
+void PerCpuCache::ClearBucket(CpuCache& cache, Bucket& bucket, size_t limit) {
+  // Avoids acquiring the lock needlessly.
+  if (!bucket.count || bucket.count <= limit)
+    return;
+
+  // See ThreadCache::ClearBucket().
+  bucket.freelist_head->CheckFreeListForThreadCache(bucket.slot_size);
+
+  uint8_t count_before = bucket.count;
+  if (limit == 0) {
+    FreeAfter(bucket.freelist_head, bucket.slot_size);
+    bucket.freelist_head = nullptr;
+  } else {
+    // Free the *end* of the list, not the head, since the head contains the
+    // most recently touched memory.
+    auto* head = bucket.freelist_head;
+    size_t items = 1;  // Cannot free the freelist head.
+    while (items < limit) {
+      head = head->GetNextForThreadCache(bucket.slot_size);
+      items++;
+    }
+    FreeAfter(head->GetNextForThreadCache(bucket.slot_size), bucket.slot_size);
+    head->SetNext(nullptr);
+  }
+  bucket.count = limit;
+  size_t freed_memory = (count_before - bucket.count) * bucket.slot_size;
+  PA_DCHECK(cache.cached_memory >= freed_memory);
+  cache.cached_memory -= freed_memory;
+}
+
+void PerCpuCache::FreeAfter(PartitionFreelistEntry* head, size_t slot_size) {
+  ::partition_alloc::internal::ScopedGuard guard(root_->lock_);
+  while (head) {
+    uintptr_t slot_start = reinterpret_cast<uintptr_t>(head);
+    head = head->GetNextForThreadCache(slot_size);
+    root_->RawFreeLocked(slot_start);
+  }
+}
+
+}  // namespace base::internal
+
+#endif  // defined(PA_PER_CPU_CACHE_SUPPORTED)
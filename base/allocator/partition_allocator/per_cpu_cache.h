@@ -0,0 +1,219 @@
+// Copyright 2022 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#ifndef BASE_ALLOCATOR_PARTITION_ALLOCATOR_PER_CPU_CACHE_H_
+#define BASE_ALLOCATOR_PARTITION_ALLOCATOR_PER_CPU_CACHE_H_
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+
+#include "base/allocator/partition_allocator/partition_alloc_config.h"
+#include "base/allocator/partition_allocator/partition_alloc_constants.h"
+#include "base/allocator/partition_allocator/partition_alloc_forward.h"
+#include "base/allocator/partition_allocator/partition_bucket_lookup.h"
+#include "base/allocator/partition_allocator/partition_freelist_entry.h"
+#include "base/allocator/partition_allocator/thread_cache.h"
+#include "base/base_export.h"
+#include "base/compiler_specific.h"
+
+#if defined(PA_PER_CPU_CACHE_SUPPORTED)
+
+#include <sched.h>
+
+#if __has_include(<sys/rseq.h>) && HAS_BUILTIN(__builtin_thread_pointer)
+#include <sys/rseq.h>
+#define PA_HAS_RSEQ_CPU_ID
+#endif
+
+namespace base::internal {
+
+// Returns the CPU the current thread runs on. The thread may have moved to
+// another CPU by the time the caller uses the result.
+ALWAYS_INLINE uint32_t GetCurrentCpu() {
+#if defined(PA_HAS_RSEQ_CPU_ID)
+  // glibc registers a restartable sequence area for each thread, in which the
+  // kernel keeps the current CPU up to date, so reading it is a plain load.
+  // |__rseq_size| is 0 if the registration failed.
+  if (LIKELY(__rseq_size)) {
+    const auto* area = reinterpret_cast<const volatile struct rseq*>(
+        reinterpret_cast<uintptr_t>(__builtin_thread_pointer()) +
+        __rseq_offset);
+    return area->cpu_id;
+  }
+#endif
+  // Goes through the vDSO, not a system call.
+  int cpu = sched_getcpu();
+  return cpu < 0 ? 0 : static_cast<uint32_t>(cpu);
+}
+
+// Caches of free slots of a partition, one per CPU, shared by the threads which
+// run on it. An alternative to ThreadCache for processes with many threads,
+// since the cached memory scales with the number of CPUs rather than the number
+// of threads, idle threads don't strand memory in their caches, and purging
+// walks one cache per CPU. The buckets have the same limits as ThreadCache's.
+//
+// A thread marks the cache of its CPU as in use for the duration of an
+// allocation or a deallocation. Since threads are rarely preempted or migrated
+// in the middle of one, the marker is uncontended, and its cache line stays
+// with the CPU. When the cache is in use anyway, e.g. because the thread which
+// marked it was preempted, the caller falls back to the central allocator, so
+// that the fast path never waits.
+//
+// Unlike ThreadCache, any number of partitions can have per-CPU caches.
+class BASE_EXPORT PerCpuCache {
+ public:
+  // Only slots up to this size are cached.
+  static constexpr size_t kSizeThreshold =
+      ThreadCacheLimits::kDefaultSizeThreshold;
+
+  // Creates the caches for |root|, whose buckets must be initialized. Doesn't
+  // allocate from |root|, so can be called with its lock held.
+  static PerCpuCache* Create(PartitionRoot<>* root);
+  // Returns the cached slots to the root, which must not be locked, and
+  // deletes |cache|.
+  static void Destroy(PerCpuCache* cache);
+
+  PerCpuCache(const PerCpuCache&) = delete;
+  PerCpuCache& operator=(const PerCpuCache&) = delete;
+
+  // Same as ThreadCache::MaybePutInCache(), for the cache of the current CPU.
+  ALWAYS_INLINE bool MaybePutInCache(uintptr_t slot_start, size_t bucket_index);
+  // Same as ThreadCache::GetFromCache(), for the cache of the current CPU.
+  ALWAYS_INLINE uintptr_t GetFromCache(size_t bucket_index, size_t* slot_size);
+
+  // Empties the caches of all CPUs. Skips the caches which are in use rather
+  // than waiting for them. The partition lock must *not* be held.
+  void Purge();
+  // Amount of memory in the caches of all CPUs, in bytes, except the ones
+  // which are in use.
+  size_t CachedMemory();
+
+  size_t cpu_count() const { return cpu_count_; }
+
+  void SetInUseForTesting(uint32_t cpu, bool in_use) {
+    caches_[cpu].in_use.store(in_use, std::memory_order_relaxed);
+  }
+
+ private:
+  struct Bucket {
+    PartitionFreelistEntry* freelist_head = nullptr;
+    uint8_t count = 0;
+    // 0 for invalid buckets, so that they are never filled.
+    uint8_t limit = 0;
+    uint16_t slot_size = 0;
+  };
+  static_assert(sizeof(Bucket) <= 2 * sizeof(void*), "Keep Bucket small.");
+
+  static constexpr uint16_t kBucketCount =
+      BucketIndexLookup::GetIndex(kSizeThreshold) + 1;
+
+  struct alignas(kPartitionCachelineSize) CpuCache {
+    bool TryAcquire() {
+      return !in_use.exchange(true, std::memory_order_acquire);
+    }
+    void Release() { in_use.store(false, std::memory_order_release); }
+
+    std::atomic<bool> in_use{false};
+    uint32_t cached_memory = 0;
+    Bucket buckets[kBucketCount];
+  };
+
+  PerCpuCache(PartitionRoot<>* root, size_t cpu_count, size_t reserved_size);
+  ~PerCpuCache();
+
+  // Returns the cache of the current CPU, marked as in use, or nullptr if it's
+  // already in use.
+  ALWAYS_INLINE CpuCache* AcquireCurrentCpuCache();
+  // Fills a bucket from the central allocator.
+  void FillBucket(CpuCache& cache, size_t bucket_index);
+  // Empties |bucket| until there are at most |limit| slots in it.
+  void ClearBucket(CpuCache& cache, Bucket& bucket, size_t limit);
+  // Releases the entire freelist starting at |head| to the root.
+  void FreeAfter(PartitionFreelistEntry* head, size_t slot_size);
+
+  PartitionRoot<>* const root_;
+  const size_t cpu_count_;
+  // The size of the mapping which holds this object and |caches_|.
+  const size_t reserved_size_;
+  CpuCache* const caches_;
+};
+
+ALWAYS_INLINE PerCpuCache::CpuCache* PerCpuCache::AcquireCurrentCpuCache() {
+  uint32_t cpu = GetCurrentCpu();
+  // CPUs which were hot-plugged after the caches were created have none.
+  if (UNLIKELY(cpu >= cpu_count_))
+    return nullptr;
+  CpuCache& cache = caches_[cpu];
+  if (UNLIKELY(!cache.TryAcquire()))
+    return nullptr;
+  return &cache;
+}
+
+ALWAYS_INLINE bool PerCpuCache::MaybePutInCache(uintptr_t slot_start,
+                                                size_t bucket_index) {
+  if (UNLIKELY(bucket_index >= kBucketCount))
+    return false;
+  CpuCache* cache = AcquireCurrentCpuCache();
+  if (UNLIKELY(!cache))
+    return false;
+
+  Bucket& bucket = cache->buckets[bucket_index];
+  PA_DCHECK(bucket.limit);
+  PA_DCHECK(bucket.count != 0 || bucket.freelist_head == nullptr);
+  auto* entry = PartitionFreelistEntry::EmplaceAndInitForThreadCache(
+      slot_start, bucket.freelist_head);
+  bucket.freelist_head = entry;
+  bucket.count++;
+  cache->cached_memory += bucket.slot_size;
+
+  // Batched deallocation, amortizing lock acquisitions.
+  if (UNLIKELY(bucket.count > bucket.limit))
+    ClearBucket(*cache, bucket, bucket.limit / 2);
+
+  cache->Release();
+  return true;
+}
+
+ALWAYS_INLINE uintptr_t PerCpuCache::GetFromCache(size_t bucket_index,
+                                                  size_t* slot_size) {
+  if (UNLIKELY(bucket_index >= kBucketCount))
+    return 0;
+  CpuCache* cache = AcquireCurrentCpuCache();
+  if (UNLIKELY(!cache))
+    return 0;
+
+  Bucket& bucket = cache->buckets[bucket_index];
+  if (UNLIKELY(!bucket.freelist_head)) {
+    PA_DCHECK(bucket.count == 0);
+    if (bucket.limit)
+      FillBucket(*cache, bucket_index);
+    // Very unlikely, means that the central allocator is out of memory. Let it
+    // deal with it (may return 0, may crash).
+    if (UNLIKELY(!bucket.freelist_head)) {
+      cache->Release();
+      return 0;
+    }
+  }
+
+  PA_DCHECK(bucket.count != 0);
+  auto* result = bucket.freelist_head;
+  auto* next = result->GetNextForThreadCache(bucket.slot_size);
+  PA_DCHECK(result != next);
+  bucket.count--;
+  PA_DCHECK(bucket.count != 0 || !next);
+  bucket.freelist_head = next;
+  *slot_size = bucket.slot_size;
+
+  PA_DCHECK(cache->cached_memory >= bucket.slot_size);
+  cache->cached_memory -= bucket.slot_size;
+  cache->Release();
+  return reinterpret_cast<uintptr_t>(result);
+}
+
+}  // namespace base::internal
+
+#endif  // defined(PA_PER_CPU_CACHE_SUPPORTED)
+
+#endif  // BASE_ALLOCATOR_PARTITION_ALLOCATOR_PER_CPU_CACHE_H_
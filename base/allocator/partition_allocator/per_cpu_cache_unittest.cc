@@ -0,0 +1,178 @@
+// Copyright 2022 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "base/allocator/partition_allocator/per_cpu_cache.h"
+
+#include <sched.h>
+
+#include <memory>
+#include <vector>
+
+#include "base/allocator/partition_allocator/partition_alloc.h"
+#include "base/allocator/partition_allocator/partition_alloc_config.h"
+#include "base/threading/platform_thread.h"
+#include "testing/gtest/include/gtest/gtest.h"
+
+// With *SAN, PartitionAlloc is replaced in partition_alloc.h by ASAN, so we
+// cannot test the per-CPU caches.
+#if !defined(MEMORY_TOOL_REPLACES_ALLOCATOR) && \
+    defined(PA_PER_CPU_CACHE_SUPPORTED)
+
+namespace base {
+namespace internal {
+
+namespace {
+
+constexpr size_t kSmallSize = 12;
+constexpr size_t kLargeSize = PerCpuCache::kSizeThreshold + 1;
+
+class PartitionAllocPerCpuCacheTest : public ::testing::Test {
+ protected:
+  void SetUp() override {
+    // Pins the thread to the CPU it runs on, so that all the tests use the
+    // same cache.
+    ASSERT_EQ(0, sched_getaffinity(0, sizeof(old_affinity_), &old_affinity_));
+    cpu_set_t affinity;
+    CPU_ZERO(&affinity);
+    CPU_SET(GetCurrentCpu(), &affinity);
+    ASSERT_EQ(0, sched_setaffinity(0, sizeof(affinity), &affinity));
+
+    // Forbid extras, since they make finding out which bucket is used harder.
+    PartitionOptions opts(PartitionOptions::AlignedAlloc::kDisallowed,
+                          PartitionOptions::ThreadCache::kDisabled,
+                          PartitionOptions::Quarantine::kDisallowed,
+                          PartitionOptions::Cookie::kDisallowed,
+                          PartitionOptions::BackupRefPtr::kDisabled,
+                          PartitionOptions::UseConfigurablePool::kNo);
+    opts.per_cpu_cache = PartitionOptions::PerCpuCache::kEnabled;
+    root_ = std::make_unique<ThreadSafePartitionRoot>(opts);
+    cache_ = root_->per_cpu_cache_for_testing();
+    ASSERT_TRUE(cache_);
+  }
+
+  void TearDown() override {
+    root_.reset();
+    EXPECT_EQ(0, sched_setaffinity(0, sizeof(old_affinity_), &old_affinity_));
+  }
+
+  std::unique_ptr<ThreadSafePartitionRoot> root_;
+  PerCpuCache* cache_ = nullptr;
+  cpu_set_t old_affinity_;
+};
+
+}  // namespace
+
+TEST_F(PartitionAllocPerCpuCacheTest, Simple) {
+  EXPECT_EQ(0u, cache_->CachedMemory());
+  EXPECT_GE(cache_->cpu_count(), 1u);
+  EXPECT_LT(GetCurrentCpu(), cache_->cpu_count());
+
+  void* ptr = root_->Alloc(kSmallSize, "");
+  ASSERT_TRUE(ptr);
+  // The first allocation fills the bucket.
+  size_t cached_memory = cache_->CachedMemory();
+  EXPECT_GT(cached_memory, 0u);
+
+  size_t slot_size = ThreadSafePartitionRoot::GetUsableSize(ptr);
+  root_->Free(ptr);
+  EXPECT_EQ(cached_memory + slot_size, cache_->CachedMemory());
+
+  // The slot comes back from the cache.
+  void* ptr2 = root_->Alloc(kSmallSize, "");
+  EXPECT_EQ(ptr, ptr2);
+  EXPECT_EQ(cached_memory, cache_->CachedMemory());
+  root_->Free(ptr2);
+}
+
+TEST_F(PartitionAllocPerCpuCacheTest, LargeAllocationsAreNotCached) {
+  void* ptr = root_->Alloc(kLargeSize, "");
+  ASSERT_TRUE(ptr);
+  root_->Free(ptr);
+  EXPECT_EQ(0u, cache_->CachedMemory());
+}
+
+TEST_F(PartitionAllocPerCpuCacheTest, BucketLimit) {
+  void* ptr = root_->Alloc(kSmallSize, "");
+  size_t slot_size = ThreadSafePartitionRoot::GetUsableSize(ptr);
+  root_->Free(ptr);
+  size_t limit = ThreadCache::GetBucketLimit(slot_size,
+                                             ThreadCache::kDefaultMultiplier);
+
+  std::vector<void*> ptrs;
+  for (size_t i = 0; i < 4 * limit; i++)
+    ptrs.push_back(root_->Alloc(kSmallSize, ""));
+  for (void* p : ptrs)
+    root_->Free(p);
+
+  // A full bucket is halved, so it never holds more than its limit.
+  EXPECT_LE(cache_->CachedMemory(), limit * slot_size);
+  EXPECT_GE(cache_->CachedMemory(), (limit / 2) * slot_size);
+}
+
+TEST_F(PartitionAllocPerCpuCacheTest, Purge) {
+  void* ptr = root_->Alloc(kSmallSize, "");
+  root_->Free(ptr);
+  EXPECT_GT(cache_->CachedMemory(), 0u);
+
+  root_->PurgeMemory(PartitionPurgeDecommitEmptySlotSpans);
+  EXPECT_EQ(0u, cache_->CachedMemory());
+  EXPECT_EQ(0u, root_->get_total_size_of_allocated_bytes());
+}
+
+TEST_F(PartitionAllocPerCpuCacheTest, SkipsCacheInUse) {
+  void* ptr = root_->Alloc(kSmallSize, "");
+  root_->Free(ptr);
+  size_t cached_memory = cache_->CachedMemory();
+
+  // Simulates a thread which was preempted while using the cache of the
+  // current CPU: the allocation falls back to the central allocator.
+  cache_->SetInUseForTesting(GetCurrentCpu(), true);
+  void* ptr2 = root_->Alloc(kSmallSize, "");
+  EXPECT_NE(ptr, ptr2);
+  root_->Free(ptr2);
+  cache_->SetInUseForTesting(GetCurrentCpu(), false);
+
+  EXPECT_EQ(cached_memory, cache_->CachedMemory());
+}
+
+TEST_F(PartitionAllocPerCpuCacheTest, MultipleThreads) {
+  // The threads inherit the affinity of this one, so they all share the same
+  // cache, and often find it in use. All the slots are accounted for
+  // regardless.
+  class AllocatingDelegate : public PlatformThread::Delegate {
+   public:
+    explicit AllocatingDelegate(ThreadSafePartitionRoot* root) : root_(root) {}
+    void ThreadMain() override {
+      std::vector<void*> ptrs;
+      for (int round = 0; round < 100; round++) {
+        for (int i = 0; i < 100; i++)
+          ptrs.push_back(root_->Alloc(kSmallSize + i, ""));
+        for (void* ptr : ptrs)
+          root_->Free(ptr);
+        ptrs.clear();
+      }
+    }
+
+   private:
+    ThreadSafePartitionRoot* const root_;
+  };
+
+  constexpr int kThreadCount = 8;
+  AllocatingDelegate delegate(root_.get());
+  PlatformThreadHandle handles[kThreadCount];
+  for (auto& handle : handles)
+    ASSERT_TRUE(PlatformThread::Create(0, &delegate, &handle));
+  for (auto& handle : handles)
+    PlatformThread::Join(handle);
+
+  root_->PurgeMemory(PartitionPurgeDecommitEmptySlotSpans);
+  EXPECT_EQ(0u, cache_->CachedMemory());
+  EXPECT_EQ(0u, root_->get_total_size_of_allocated_bytes());
+}
+
+}  // namespace internal
+}  // namespace base
+
+#endif  // !defined(MEMORY_TOOL_REPLACES_ALLOCATOR) &&
+        // defined(PA_PER_CPU_CACHE_SUPPORTED)
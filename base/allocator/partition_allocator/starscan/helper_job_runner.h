@@ -0,0 +1,31 @@
+// Copyright 2022 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#ifndef BASE_ALLOCATOR_PARTITION_ALLOCATOR_STARSCAN_HELPER_JOB_RUNNER_H_
+#define BASE_ALLOCATOR_PARTITION_ALLOCATOR_STARSCAN_HELPER_JOB_RUNNER_H_
+
+#include <cstddef>
+
+#include "base/callback.h"
+
+namespace base {
+
+// HelperJobRunner lets the embedder run slices of the scanning and sweeping
+// work of PCScan on its worker threads, e.g. as a best-effort base::PostJob()
+// job. Like StatsReporter, it keeps the partition allocator independent of the
+// task scheduler.
+class HelperJobRunner {
+ public:
+  // Runs |run_slice| on up to |max_concurrency| threads at a time, repeatedly,
+  // until it returns false. Each call of |run_slice| is bounded in time, so
+  // workers can yield in between. Must not run |run_slice| synchronously.
+  // PCScan doesn't wait for the job: the scanner does the work which the
+  // helpers didn't get to.
+  virtual void RunSlices(size_t max_concurrency,
+                         RepeatingCallback<bool()> run_slice) = 0;
+};
+
+}  // namespace base
+
+#endif  // BASE_ALLOCATOR_PARTITION_ALLOCATOR_STARSCAN_HELPER_JOB_RUNNER_H_
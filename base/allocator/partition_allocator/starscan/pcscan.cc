@@ -108,6 +108,10 @@ void PCScan::RegisterStatsReporter(StatsReporter* reporter) {
   PCScanInternal::Instance().RegisterStatsReporter(reporter);
 }
 
+void PCScan::RegisterHelperJobRunner(HelperJobRunner* runner) {
+  PCScanInternal::Instance().RegisterHelperJobRunner(runner);
+}
+
 PCScan PCScan::instance_ CONSTINIT;
 
 }  // namespace internal
@@ -22,6 +22,7 @@
 
 namespace base {
 
+class HelperJobRunner;
 class StatsReporter;
 
 namespace internal {
@@ -143,6 +144,10 @@ class BASE_EXPORT PCScan final {
   // Registers reporting class.
   static void RegisterStatsReporter(StatsReporter* reporter);
 
+  // Registers the runner of the helpers which share the scanning and sweeping
+  // work with the scanner. Without one, the scanner does all the work.
+  static void RegisterHelperJobRunner(HelperJobRunner* runner);
+
  private:
   class PCScanThread;
   friend class PCScanTask;
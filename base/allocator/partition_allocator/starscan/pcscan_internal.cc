@@ -29,6 +29,7 @@
 #include "base/allocator/partition_allocator/partition_alloc_constants.h"
 #include "base/allocator/partition_allocator/partition_page.h"
 #include "base/allocator/partition_allocator/reservation_offset_table.h"
+#include "base/allocator/partition_allocator/starscan/helper_job_runner.h"
 #include "base/allocator/partition_allocator/starscan/metadata_allocator.h"
 #include "base/allocator/partition_allocator/starscan/pcscan_scheduling.h"
 #include "base/allocator/partition_allocator/starscan/raceful_worklist.h"
@@ -39,6 +40,7 @@
 #include "base/allocator/partition_allocator/starscan/stats_reporter.h"
 #include "base/allocator/partition_allocator/tagging.h"
 #include "base/allocator/partition_allocator/thread_cache.h"
+#include "base/bind.h"
 #include "base/bits.h"
 #include "base/compiler_specific.h"
 #include "base/cpu.h"
@@ -276,6 +278,8 @@ SimdSupport DetectSimdSupport() {
   return SimdSupport::kNEON;
 #else
   const base::CPU& cpu = base::CPU::GetInstanceNoAllocation();
+  if (cpu.has_avx512f())
+    return SimdSupport::kAVX512;
   if (cpu.has_avx2())
     return SimdSupport::kAVX2;
   if (cpu.has_sse41())
@@ -498,6 +502,10 @@ class PCScanTask final : public base::RefCountedThreadSafe<PCScanTask>,
   // scanner thread.
   void RunFromScanner();
 
+  // Execute a slice of the scanning or sweeping work from a helper thread, for
+  // about |budget|. Returns false if there's no more work for helpers.
+  bool RunSliceFromHelper(TimeDelta budget);
+
   PCScanScheduler& scheduler() const { return pcscan_.scheduler(); }
 
  private:
@@ -590,8 +598,17 @@ class PCScanTask final : public base::RefCountedThreadSafe<PCScanTask>,
                      uintptr_t* end,
                      size_t slot_size);
 
+  // Helper threads join the phase which the scanner opened, if any.
+  enum class HelperPhase { kNone, kScan, kSweep };
+
   // Scans all registered partitions and marks reachable quarantined slots.
   void ScanPartitions();
+  // Scans the super pages which no other thread scans or scanned, until
+  // |deadline|. Returns whether there may be super pages left.
+  bool ScanPartitionsUntil(TimeTicks deadline);
+  void ScanSuperPage(PCScanInternal& pcscan,
+                     PCScanScanLoop& scan_loop,
+                     uintptr_t super_page);
 
   // Clear quarantined slots and prepare card table for fast lookup
   void ClearQuarantinedSlotsAndPrepareCardTable();
@@ -601,6 +618,16 @@ class PCScanTask final : public base::RefCountedThreadSafe<PCScanTask>,
 
   // Sweeps (frees) unreachable quarantined entries.
   void SweepQuarantine();
+  // Sweeps the super pages which no other thread sweeps or swept, until
+  // |deadline|. Returns whether there may be super pages left.
+  bool SweepQuarantineUntil(TimeTicks deadline);
+
+  // Lets helper threads share the work of |phase|, if the scheduling backend
+  // asked for more than one slice and the embedder registered a runner.
+  void StartHelpers(HelperPhase phase);
+  // Waits for the helpers which are in the middle of a slice. The scanner is
+  // done with the phase by then, so they'll find no more work.
+  void StopHelpers();
 
   // Finishes the scanner (updates limits, UMA, etc).
   void FinishScanner();
@@ -614,6 +641,11 @@ class PCScanTask final : public base::RefCountedThreadSafe<PCScanTask>,
   std::mutex mutex_;
   std::condition_variable condvar_;
   std::atomic<size_t> number_of_scanning_threads_{0u};
+  // Helper threads, synchronized with the |mutex_| and |condvar_| as well.
+  HelperPhase helper_phase_ = HelperPhase::kNone;
+  size_t number_of_helper_threads_ = 0u;
+  // The number of slices of scanning and sweeping, one for the scanner.
+  size_t slice_count_ = 1u;
   // We can unprotect only once to reduce context-switches.
   std::once_flag unprotect_once_flag_;
   bool immediatelly_free_slots_{false};
@@ -884,6 +916,36 @@ void PCScanTask::ScanLargeArea(PCScanInternal& pcscan,
 }
 
 void PCScanTask::ScanPartitions() {
+  PCScanScanLoop scan_loop(*this);
+  auto& pcscan = PCScanInternal::Instance();
+
+  StarScanSnapshot::ScanningView snapshot_view(*snapshot_);
+  snapshot_view.VisitConcurrently(
+      [this, &pcscan, &scan_loop](uintptr_t super_page) {
+        ScanSuperPage(pcscan, scan_loop, super_page);
+      });
+
+  stats_.IncreaseSurvivedQuarantineSize(scan_loop.quarantine_size());
+}
+
+bool PCScanTask::ScanPartitionsUntil(TimeTicks deadline) {
+  PCScanScanLoop scan_loop(*this);
+  auto& pcscan = PCScanInternal::Instance();
+
+  StarScanSnapshot::ScanningView snapshot_view(*snapshot_);
+  const bool has_more = snapshot_view.VisitExclusively(
+      [this, &pcscan, &scan_loop](uintptr_t super_page) {
+        ScanSuperPage(pcscan, scan_loop, super_page);
+      },
+      [deadline] { return TimeTicks::Now() >= deadline; });
+
+  stats_.IncreaseSurvivedQuarantineSize(scan_loop.quarantine_size());
+  return has_more;
+}
+
+void PCScanTask::ScanSuperPage(PCScanInternal& pcscan,
+                               PCScanScanLoop& scan_loop,
+                               uintptr_t super_page) {
   // Threshold for which bucket size it is worthwhile in checking whether the
   // slot is allocated and needs to be scanned. PartitionPurgeSlotSpan()
   // purges only slots >= page-size, this helps us to avoid faulting in
@@ -893,31 +955,22 @@ void PCScanTask::ScanPartitions() {
   static constexpr size_t kLargeScanAreaThresholdInWords =
       1024 / sizeof(uintptr_t);
 
-  PCScanScanLoop scan_loop(*this);
-  auto& pcscan = PCScanInternal::Instance();
+  SuperPageSnapshot super_page_snapshot(super_page);
 
-  StarScanSnapshot::ScanningView snapshot_view(*snapshot_);
-  snapshot_view.VisitConcurrently(
-      [this, &pcscan, &scan_loop](uintptr_t super_page) {
-        SuperPageSnapshot super_page_snapshot(super_page);
-
-        for (const auto& scan_area : super_page_snapshot.scan_areas()) {
-          auto* const begin = reinterpret_cast<uintptr_t*>(
-              super_page |
-              (scan_area.offset_within_page_in_words * sizeof(uintptr_t)));
-          auto* const end = begin + scan_area.size_in_words;
-
-          if (UNLIKELY(scan_area.slot_size_in_words >=
-                       kLargeScanAreaThresholdInWords)) {
-            ScanLargeArea(pcscan, scan_loop, begin, end,
-                          scan_area.slot_size_in_words * sizeof(uintptr_t));
-          } else {
-            ScanNormalArea(pcscan, scan_loop, begin, end);
-          }
-        }
-      });
+  for (const auto& scan_area : super_page_snapshot.scan_areas()) {
+    auto* const begin = reinterpret_cast<uintptr_t*>(
+        super_page |
+        (scan_area.offset_within_page_in_words * sizeof(uintptr_t)));
+    auto* const end = begin + scan_area.size_in_words;
 
-  stats_.IncreaseSurvivedQuarantineSize(scan_loop.quarantine_size());
+    if (UNLIKELY(scan_area.slot_size_in_words >=
+                 kLargeScanAreaThresholdInWords)) {
+      ScanLargeArea(pcscan, scan_loop, begin, end,
+                    scan_area.slot_size_in_words * sizeof(uintptr_t));
+    } else {
+      ScanNormalArea(pcscan, scan_loop, begin, end);
+    }
+  }
 }
 
 namespace {
@@ -1051,6 +1104,12 @@ void UnmarkInCardTable(uintptr_t slot_start,
 }  // namespace
 
 void PCScanTask::SweepQuarantine() {
+  // The helpers may leave super pages behind, since they yield at their
+  // deadlines, but the scanner sweeps until there are none.
+  SweepQuarantineUntil(TimeTicks::Max());
+}
+
+bool PCScanTask::SweepQuarantineUntil(TimeTicks deadline) {
   // Check that scan is unjoinable by this time.
   PA_DCHECK(!pcscan_.IsJoinable());
   // Discard marked quarantine memory on every Nth scan.
@@ -1063,7 +1122,9 @@ void PCScanTask::SweepQuarantine() {
 
   SweepStat stat;
   StarScanSnapshot::SweepingView sweeping_view(*snapshot_);
-  sweeping_view.VisitNonConcurrently(
+  // Sweeping twice would free twice, so each super page is swept by exactly one
+  // thread.
+  const bool has_more = sweeping_view.VisitExclusively(
       [this, &stat, should_discard](uintptr_t super_page) {
         auto* root = ThreadSafePartitionRoot::FromFirstSuperPage(super_page);
 
@@ -1077,6 +1138,9 @@ void PCScanTask::SweepQuarantine() {
         else
           SweepSuperPage(root, super_page, pcscan_epoch_, stat);
 #endif
+      },
+      [deadline] {
+        return !deadline.is_max() && TimeTicks::Now() >= deadline;
       });
 
   stats_.IncreaseSweptSize(stat.swept_bytes);
@@ -1089,6 +1153,54 @@ void PCScanTask::SweepQuarantine() {
   if (ThreadCache::IsValid(current_thread_tcache))
     current_thread_tcache->Purge();
 #endif  // defined(PA_THREAD_CACHE_SUPPORTED)
+  return has_more;
+}
+
+void PCScanTask::StartHelpers(HelperPhase phase) {
+  if (slice_count_ <= 1)
+    return;
+  HelperJobRunner* runner = PCScanInternal::Instance().GetHelperJobRunner();
+  if (!runner)
+    return;
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    PA_DCHECK(helper_phase_ == HelperPhase::kNone);
+    helper_phase_ = phase;
+  }
+  runner->RunSlices(
+      slice_count_ - 1,
+      BindRepeating(&PCScanTask::RunSliceFromHelper, WrapRefCounted(this),
+                    PCScanSchedulingBackend::kSliceTimeBudget));
+}
+
+void PCScanTask::StopHelpers() {
+  std::unique_lock<std::mutex> lock(mutex_);
+  helper_phase_ = HelperPhase::kNone;
+  condvar_.wait(lock, [this] { return !number_of_helper_threads_; });
+}
+
+bool PCScanTask::RunSliceFromHelper(TimeDelta budget) {
+  HelperPhase phase;
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    phase = helper_phase_;
+    if (phase == HelperPhase::kNone)
+      return false;
+    ++number_of_helper_threads_;
+  }
+  bool has_more;
+  {
+    ReentrantScannerGuard reentrancy_guard;
+    const TimeTicks deadline = TimeTicks::Now() + budget;
+    has_more = phase == HelperPhase::kScan ? ScanPartitionsUntil(deadline)
+                                           : SweepQuarantineUntil(deadline);
+  }
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    --number_of_helper_threads_;
+  }
+  condvar_.notify_all();
+  return has_more;
 }
 
 void PCScanTask::FinishScanner() {
@@ -1142,6 +1254,10 @@ void PCScanTask::RunFromMutator() {
 
 void PCScanTask::RunFromScanner() {
   ReentrantScannerGuard reentrancy_guard;
+  if (PCScanInternal::Instance().GetHelperJobRunner()) {
+    slice_count_ = pcscan_.scheduler_.scheduling_backend().GetSliceCount(
+        PCScanInternal::Instance().CalculateTotalHeapSize());
+  }
   {
     StatsCollector::ScannerScope overall_scope(
         stats_, StatsCollector::ScannerId::kOverall);
@@ -1157,7 +1273,10 @@ void PCScanTask::RunFromScanner() {
         // Scan heap for dangling references.
         StatsCollector::ScannerScope scan_scope(
             stats_, StatsCollector::ScannerId::kScan);
+        StartHelpers(HelperPhase::kScan);
         ScanPartitions();
+        // The helpers must be done before |sync_scope| lets sweeping start.
+        StopHelpers();
       }
       {
         // Unprotect all scanned pages, if needed.
@@ -1168,7 +1287,9 @@ void PCScanTask::RunFromScanner() {
       // Sweep unreachable quarantined slots.
       StatsCollector::ScannerScope sweep_scope(
           stats_, StatsCollector::ScannerId::kSweep);
+      StartHelpers(HelperPhase::kSweep);
       SweepQuarantine();
+      StopHelpers();
     }
   }
   FinishScanner();
@@ -1618,5 +1739,10 @@ StatsReporter& PCScanInternal::GetReporter() {
   return *stats_reporter_;
 }
 
+void PCScanInternal::RegisterHelperJobRunner(HelperJobRunner* runner) {
+  PA_DCHECK(runner);
+  helper_job_runner_.store(runner, std::memory_order_release);
+}
+
 }  // namespace internal
 }  // namespace base
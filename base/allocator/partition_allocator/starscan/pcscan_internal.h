@@ -6,6 +6,7 @@
 #define BASE_ALLOCATOR_PARTITION_ALLOCATOR_STARSCAN_PCSCAN_INTERNAL_H_
 
 #include <array>
+#include <atomic>
 #include <functional>
 #include <memory>
 #include <mutex>
@@ -22,6 +23,7 @@
 
 namespace base {
 
+class HelperJobRunner;
 class StatsReporter;
 
 namespace internal {
@@ -110,6 +112,12 @@ class PCScanInternal final {
   void RegisterStatsReporter(StatsReporter* reporter);
   StatsReporter& GetReporter();
 
+  void RegisterHelperJobRunner(HelperJobRunner* runner);
+  // Returns nullptr if no runner is registered.
+  HelperJobRunner* GetHelperJobRunner() const {
+    return helper_job_runner_.load(std::memory_order_acquire);
+  }
+
  private:
   friend base::NoDestructor<PCScanInternal>;
   friend class StarScanSnapshot;
@@ -143,6 +151,7 @@ class PCScanInternal final {
 
   std::unique_ptr<WriteProtector> write_protector_;
   StatsReporter* stats_reporter_ = nullptr;
+  std::atomic<HelperJobRunner*> helper_job_runner_{nullptr};
 
   bool is_initialized_ = false;
 };
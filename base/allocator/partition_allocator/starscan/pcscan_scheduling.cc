@@ -47,6 +47,23 @@ TimeDelta PCScanSchedulingBackend::UpdateDelayedSchedule() {
   return TimeDelta();
 }
 
+size_t PCScanSchedulingBackend::GetSliceCount(size_t heap_size) {
+  const TimeTicks now = TimeTicks::Now();
+  size_t slice_count = 1;
+  if (!last_heap_size_time_.is_null() && heap_size > last_heap_size_) {
+    // Avoids dividing by (almost) zero for back to back scans.
+    const double elapsed_seconds =
+        std::max((now - last_heap_size_time_).InSecondsF(), 1e-3);
+    const double growth_rate = (heap_size - last_heap_size_) / elapsed_seconds;
+    slice_count += static_cast<size_t>(
+        std::min(growth_rate / kHeapGrowthRatePerSlice,
+                 static_cast<double>(kMaxSliceCount)));
+  }
+  last_heap_size_ = heap_size;
+  last_heap_size_time_ = now;
+  return std::min(slice_count, kMaxSliceCount);
+}
+
 // static
 constexpr double LimitBackend::kQuarantineSizeFraction;
 
@@ -36,6 +36,13 @@ struct QuarantineData final {
 
 class BASE_EXPORT PCScanSchedulingBackend {
  public:
+  // Upper bound of GetSliceCount().
+  static constexpr size_t kMaxSliceCount = 8;
+  // Heap growth rate, in bytes per second, which warrants one more slice.
+  static constexpr size_t kHeapGrowthRatePerSlice = 16 * 1024 * 1024;
+  // How long a helper thread works on a slice before yielding.
+  static constexpr TimeDelta kSliceTimeBudget = Milliseconds(2);
+
   explicit inline constexpr PCScanSchedulingBackend(PCScanScheduler&);
   // No virtual destructor to allow constant initialization of PCScan as
   // static global which directly embeds LimitBackend as default backend.
@@ -68,6 +75,12 @@ class BASE_EXPORT PCScanSchedulingBackend {
   // Only invoked if scheduler requests a delayed scan at some point.
   virtual TimeDelta UpdateDelayedSchedule();
 
+  // Invoked by the scanner, with the current heap size, to pick the number of
+  // slices in which scanning and sweeping are split, i.e. one for the scanner
+  // plus one per helper thread. The faster the heap grew since the previous
+  // call, the more work the next scans have, and the more slices.
+  virtual size_t GetSliceCount(size_t heap_size);
+
  protected:
   inline bool SchedulingDisabled() const;
 
@@ -75,6 +88,11 @@ class BASE_EXPORT PCScanSchedulingBackend {
 
   PCScanScheduler& scheduler_;
   std::atomic<bool> scheduling_enabled_{true};
+
+ private:
+  // Only accessed by the scanner.
+  size_t last_heap_size_ = 0;
+  TimeTicks last_heap_size_time_;
 };
 
 // Scheduling backend that just considers a single hard limit.
@@ -167,5 +167,27 @@ TEST_F(PartitionAllocPCScanMUAwareTaskBasedBackendTest,
   EXPECT_EQ(0u, delayed_scan_scheduled_count());
 }
 
+TEST(PartitionAllocPCScanSchedulingBackendTest, SliceCountFollowsHeapGrowth) {
+  ScopedTimeTicksOverride now_override;
+  PCScanScheduler scheduler;
+  LimitBackend limit_backend(scheduler);
+  // No previous scan to compare with.
+  EXPECT_EQ(1u, limit_backend.GetSliceCount(100 * kMB));
+  // The heap didn't grow.
+  now_override.AddTicksToNow(Seconds(1));
+  EXPECT_EQ(1u, limit_backend.GetSliceCount(100 * kMB));
+  now_override.AddTicksToNow(Seconds(1));
+  EXPECT_EQ(1u, limit_backend.GetSliceCount(50 * kMB));
+  // Three times the growth rate per slice.
+  now_override.AddTicksToNow(Seconds(1));
+  EXPECT_EQ(4u, limit_backend.GetSliceCount(
+                    50 * kMB +
+                    3 * PCScanSchedulingBackend::kHeapGrowthRatePerSlice));
+  // Fast growth is capped.
+  now_override.AddTicksToNow(Milliseconds(1));
+  EXPECT_EQ(PCScanSchedulingBackend::kMaxSliceCount,
+            limit_backend.GetSliceCount(1024 * kMB));
+}
+
 }  // namespace internal
 }  // namespace base
@@ -3,6 +3,8 @@
 // found in the LICENSE file.
 
 #include <cstdint>
+#include <thread>
+#include <vector>
 
 #if !defined(MEMORY_TOOL_REPLACES_ALLOCATOR)
 
@@ -11,10 +13,13 @@
 #include "base/allocator/partition_allocator/partition_alloc.h"
 #include "base/allocator/partition_allocator/partition_alloc_constants.h"
 #include "base/allocator/partition_allocator/partition_root.h"
+#include "base/allocator/partition_allocator/starscan/helper_job_runner.h"
+#include "base/allocator/partition_allocator/starscan/pcscan_scheduling.h"
 #include "base/allocator/partition_allocator/starscan/stack/stack.h"
 #include "base/allocator/partition_allocator/tagging.h"
 #include "base/cpu.h"
 #include "base/logging.h"
+#include "base/no_destructor.h"
 #include "build/build_config.h"
 #include "testing/gtest/include/gtest/gtest.h"
 
@@ -809,6 +814,90 @@ TEST_F(PartitionAllocPCScanTest, DanglingPointerOutsideUsablePart) {
   TestDanglingReference(*this, source, value);
 }
 
+namespace {
+
+// Always asks for the same number of slices.
+class FixedSliceCountBackend final : public PCScanSchedulingBackend {
+ public:
+  FixedSliceCountBackend(PCScanScheduler& scheduler, size_t slice_count)
+      : PCScanSchedulingBackend(scheduler), slice_count_(slice_count) {}
+
+  bool LimitReached() final { return false; }
+  void UpdateScheduleAfterScan(size_t, base::TimeDelta, size_t) final {}
+  size_t GetSliceCount(size_t) final { return slice_count_; }
+
+ private:
+  bool NeedsToImmediatelyScan() final { return false; }
+
+  const size_t slice_count_;
+};
+
+// Runs the slices on threads of its own, until they run out of work.
+class ThreadHelperJobRunner final : public HelperJobRunner {
+ public:
+  static ThreadHelperJobRunner& Get() {
+    // Outlives the test, since PCScan keeps pointing to it.
+    static base::NoDestructor<ThreadHelperJobRunner> instance;
+    return *instance;
+  }
+
+  void RunSlices(size_t max_concurrency,
+                 RepeatingCallback<bool()> run_slice) override {
+    ++job_count_;
+    for (size_t i = 0; i < max_concurrency; ++i) {
+      threads_.emplace_back([run_slice] {
+        while (run_slice.Run()) {
+        }
+      });
+    }
+  }
+
+  // Returns the number of jobs since the previous call.
+  size_t Join() {
+    for (auto& thread : threads_)
+      thread.join();
+    threads_.clear();
+    size_t job_count = job_count_;
+    job_count_ = 0;
+    return job_count;
+  }
+
+ private:
+  std::vector<std::thread> threads_;
+  size_t job_count_ = 0;
+};
+
+}  // namespace
+
+TEST_F(PartitionAllocPCScanTest, DanglingReferenceWithHelpers) {
+  using SourceList = List<64>;
+  using ValueList = SourceList;
+
+  static constexpr size_t kSliceCount = 4;
+  FixedSliceCountBackend backend(PCScan::scheduler(), kSliceCount);
+  PCScanSchedulingBackend& previous_backend =
+      PCScan::scheduler().scheduling_backend();
+  PCScan::scheduler().SetNewSchedulingBackend(backend);
+  ThreadHelperJobRunner& runner = ThreadHelperJobRunner::Get();
+  PCScan::RegisterHelperJobRunner(&runner);
+
+  // Spread the objects over several super pages, so that the helpers have
+  // something to share.
+  std::vector<SourceList*> sources;
+  std::vector<ValueList*> values;
+  for (size_t i = 0; i < 2 * kSuperPageSize / sizeof(SourceList); ++i) {
+    values.push_back(ValueList::Create(root()));
+    sources.push_back(SourceList::Create(root(), values.back()));
+  }
+  TestDanglingReference(*this, sources.front(), values.front());
+  TestDanglingReference(*this, sources.back(), values.back());
+
+  // Two scans for each dangling reference, for which both the scanning and
+  // the sweeping were shared.
+  EXPECT_EQ(8u, runner.Join());
+  PCScan::scheduler().SetNewSchedulingBackend(previous_backend);
+}
+
 #if defined(PA_HAS_MEMORY_TAGGING)
 TEST_F(PartitionAllocPCScanWithMTETest, QuarantineOnlyOnTagOverflow) {
   using ListType = List<64>;
@@ -70,6 +70,15 @@ class RacefulWorklist {
   template <typename Function>
   void VisitNonConcurrently(Function) const;
 
+  // Visits the items which no other thread is visiting or has visited, until
+  // |should_yield| returns true. Returns whether it yielded, in which case
+  // there may be items left. Unlike RandomizedView::Visit(), each item is
+  // visited exactly once across all threads, so the visitor doesn't need to be
+  // idempotent, but the items which other threads are visiting may not be
+  // visited yet when this returns.
+  template <typename Function, typename YieldFunction>
+  bool VisitExclusively(Function f, YieldFunction should_yield);
+
  private:
   Underlying data_;
   std::atomic<bool> fully_visited_{false};
@@ -82,6 +91,24 @@ void RacefulWorklist<T>::VisitNonConcurrently(Function f) const {
     f(t.value);
 }
 
+template <typename T>
+template <typename Function, typename YieldFunction>
+bool RacefulWorklist<T>::VisitExclusively(Function f,
+                                          YieldFunction should_yield) {
+  for (auto& node : data_) {
+    if (node.is_visited.load(std::memory_order_relaxed))
+      continue;
+    // Claims the item.
+    if (node.is_being_visited.exchange(true, std::memory_order_relaxed))
+      continue;
+    f(node.value);
+    node.is_visited.store(true, std::memory_order_relaxed);
+    if (should_yield())
+      return true;
+  }
+  return false;
+}
+
 template <typename T>
 template <typename Function>
 void RacefulWorklist<T>::RandomizedView::Visit(Function f) {
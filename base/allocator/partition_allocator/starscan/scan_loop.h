@@ -60,6 +60,7 @@ class ScanLoop {
   Derived& derived() { return static_cast<Derived&>(*this); }
 
 #if defined(ARCH_CPU_X86_64)
+  __attribute__((target("avx512f"))) void RunAVX512(uintptr_t*, uintptr_t*);
   __attribute__((target("avx2"))) void RunAVX2(uintptr_t*, uintptr_t*);
   __attribute__((target("sse4.1"))) void RunSSE4(uintptr_t*, uintptr_t*);
 #endif
@@ -77,6 +78,8 @@ void ScanLoop<Derived>::Run(uintptr_t* begin, uintptr_t* end) {
 // We allow vectorization only for 64bit since they require support of the
 // 64bit cage, and only for x86 because a special instruction set is required.
 #if defined(ARCH_CPU_X86_64)
+  if (simd_type_ == SimdSupport::kAVX512)
+    return RunAVX512(begin, end);
   if (simd_type_ == SimdSupport::kAVX2)
     return RunAVX2(begin, end);
   if (simd_type_ == SimdSupport::kSSE41)
@@ -109,6 +112,36 @@ void ScanLoop<Derived>::RunUnvectorized(uintptr_t* begin, uintptr_t* end) {
 }
 
 #if defined(ARCH_CPU_X86_64)
+template <typename Derived>
+__attribute__((target("avx512f"))) void ScanLoop<Derived>::RunAVX512(
+    uintptr_t* begin,
+    uintptr_t* end) {
+  static constexpr size_t kWordsInVector = 8;
+  // Scan areas are only guaranteed to be aligned to 32 bytes, on which
+  // unaligned loads are as fast as aligned ones anyway.
+  PA_SCAN_DCHECK(!(reinterpret_cast<uintptr_t>(begin) % sizeof(uintptr_t)));
+  const __m512i vbase = _mm512_set1_epi64(derived().CageBase());
+  const __m512i cage_mask = _mm512_set1_epi64(derived().CageMask());
+
+  uintptr_t* payload = begin;
+  for (; payload < (end - kWordsInVector); payload += kWordsInVector) {
+    const __m512i maybe_ptrs = _mm512_loadu_si512(payload);
+    const __m512i vand = _mm512_and_si512(maybe_ptrs, cage_mask);
+    const __mmask8 mask = _mm512_cmpeq_epi64_mask(vand, vbase);
+    if (LIKELY(!mask))
+      continue;
+    // It's important to extract pointers from the already loaded vector.
+    // Otherwise, new loads can break in-cage assumption checked above. The
+    // in-cage words are packed to the front of |in_cage|.
+    uintptr_t in_cage[kWordsInVector];
+    _mm512_mask_compressstoreu_epi64(in_cage, mask, maybe_ptrs);
+    const int count = __builtin_popcount(mask);
+    for (int i = 0; i < count; ++i)
+      derived().CheckPointer(in_cage[i]);
+  }
+  RunUnvectorized(payload, end);
+}
+
 template <typename Derived>
 __attribute__((target("avx2"))) void ScanLoop<Derived>::RunAVX2(
     uintptr_t* begin,
@@ -186,26 +219,37 @@ __attribute__((target("sse4.1"))) void ScanLoop<Derived>::RunSSE4(
 template <typename Derived>
 void ScanLoop<Derived>::RunNEON(uintptr_t* begin, uintptr_t* end) {
   static constexpr size_t kAlignmentRequirement = 16;
+  // Two vectors per iteration, which hides the latency of the reduction.
   static constexpr size_t kWordsInVector = 2;
+  static constexpr size_t kWordsInIteration = 2 * kWordsInVector;
   PA_SCAN_DCHECK(!(reinterpret_cast<uintptr_t>(begin) % kAlignmentRequirement));
   const uint64x2_t vbase = vdupq_n_u64(derived().CageBase());
   const uint64x2_t cage_mask = vdupq_n_u64(derived().CageMask());
 
   uintptr_t* payload = begin;
-  for (; payload < (end - kWordsInVector); payload += kWordsInVector) {
-    const uint64x2_t maybe_ptrs =
+  for (; payload < (end - kWordsInIteration); payload += kWordsInIteration) {
+    const uint64x2_t maybe_ptrs_lo =
         vld1q_u64(reinterpret_cast<uint64_t*>(payload));
-    const uint64x2_t vand = vandq_u64(maybe_ptrs, cage_mask);
-    const uint64x2_t vcmp = vceqq_u64(vand, vbase);
-    const uint32_t max = vmaxvq_u32(vreinterpretq_u32_u64(vcmp));
+    const uint64x2_t maybe_ptrs_hi =
+        vld1q_u64(reinterpret_cast<uint64_t*>(payload + kWordsInVector));
+    const uint64x2_t vcmp_lo =
+        vceqq_u64(vandq_u64(maybe_ptrs_lo, cage_mask), vbase);
+    const uint64x2_t vcmp_hi =
+        vceqq_u64(vandq_u64(maybe_ptrs_hi, cage_mask), vbase);
+    const uint32_t max =
+        vmaxvq_u32(vreinterpretq_u32_u64(vorrq_u64(vcmp_lo, vcmp_hi)));
     if (LIKELY(!max))
       continue;
     // It's important to extract pointers from the already loaded vector.
     // Otherwise, new loads can break in-cage assumption checked above.
-    if (vgetq_lane_u64(vcmp, 0))
-      derived().CheckPointer(vgetq_lane_u64(maybe_ptrs, 0));
-    if (vgetq_lane_u64(vcmp, 1))
-      derived().CheckPointer(vgetq_lane_u64(maybe_ptrs, 1));
+    if (vgetq_lane_u64(vcmp_lo, 0))
+      derived().CheckPointer(vgetq_lane_u64(maybe_ptrs_lo, 0));
+    if (vgetq_lane_u64(vcmp_lo, 1))
+      derived().CheckPointer(vgetq_lane_u64(maybe_ptrs_lo, 1));
+    if (vgetq_lane_u64(vcmp_hi, 0))
+      derived().CheckPointer(vgetq_lane_u64(maybe_ptrs_hi, 0));
+    if (vgetq_lane_u64(vcmp_hi, 1))
+      derived().CheckPointer(vgetq_lane_u64(maybe_ptrs_hi, 1));
   }
   RunUnvectorized(payload, end);
 }
@@ -0,0 +1,160 @@
+// Copyright 2022 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include <cstdint>
+#include <memory>
+#include <random>
+#include <string>
+#include <vector>
+
+#include "base/allocator/partition_allocator/partition_alloc_config.h"
+#include "base/allocator/partition_allocator/starscan/scan_loop.h"
+#include "base/cpu.h"
+#include "base/memory/aligned_memory.h"
+#include "base/time/time.h"
+#include "base/timer/lap_timer.h"
+#include "build/build_config.h"
+#include "testing/gtest/include/gtest/gtest.h"
+#include "testing/perf/perf_result_reporter.h"
+
+#if defined(PA_HAS_64_BITS_POINTERS)
+
+namespace base {
+namespace internal {
+
+namespace {
+
+constexpr TimeDelta kTimeLimit = Seconds(1);
+constexpr int kWarmupRuns = 5;
+constexpr int kTimeCheckInterval = 1;
+// Larger than the last level cache, like the heap which PCScan scans.
+constexpr size_t kRangeSizeInBytes = 64 * 1024 * 1024;
+
+constexpr char kMetricPrefixScanLoop[] = "ScanLoop.";
+constexpr char kMetricThroughput[] = "throughput";
+
+class BenchmarkScanLoop final : public ScanLoop<BenchmarkScanLoop> {
+  friend class ScanLoop<BenchmarkScanLoop>;
+
+ public:
+  explicit BenchmarkScanLoop(SimdSupport simd) : ScanLoop(simd) {}
+
+  static constexpr uintptr_t kCageMask = 0xffffff0000000000;
+  static constexpr uintptr_t kBasePtr = 0x1234560000000000;
+
+  size_t in_cage() const { return in_cage_; }
+
+ private:
+  uintptr_t CageBase() const { return kBasePtr; }
+  static constexpr uintptr_t CageMask() { return kCageMask; }
+
+  // Stands in for the lookup in the StateBitmap, which isn't measured.
+  void CheckPointer(uintptr_t maybe_ptr) { ++in_cage_; }
+
+  size_t in_cage_ = 0;
+};
+
+struct Isa {
+  SimdSupport simd;
+  const char* name;
+};
+
+constexpr Isa kIsas[] = {
+    {SimdSupport::kUnvectorized, "Unvectorized"},
+#if defined(ARCH_CPU_X86_64)
+    {SimdSupport::kSSE41, "SSE4"},
+    {SimdSupport::kAVX2, "AVX2"},
+    {SimdSupport::kAVX512, "AVX512"},
+#endif
+#if defined(PA_STARSCAN_NEON_SUPPORTED)
+    {SimdSupport::kNEON, "NEON"},
+#endif
+};
+
+bool IsSupported(SimdSupport simd) {
+  const CPU& cpu = CPU::GetInstanceNoAllocation();
+  switch (simd) {
+    case SimdSupport::kUnvectorized:
+      return true;
+    case SimdSupport::kSSE41:
+      return cpu.has_sse41();
+    case SimdSupport::kAVX2:
+      return cpu.has_avx2();
+    case SimdSupport::kAVX512:
+      return cpu.has_avx512f();
+    case SimdSupport::kNEON:
+#if defined(PA_STARSCAN_NEON_SUPPORTED)
+      return true;
+#else
+      return false;
+#endif
+  }
+}
+
+// Fills |range| with something resembling a heap: mostly zeroes and small
+// integers, some pointers outside of the cage and a few inside.
+void FillRange(uintptr_t* begin, uintptr_t* end) {
+  std::mt19937_64 generator;
+  for (uintptr_t* word = begin; word < end; ++word) {
+    const uint64_t random = generator();
+    switch (random % 16) {
+      case 0:
+        *word = BenchmarkScanLoop::kBasePtr |
+                (random >> 32 & ~BenchmarkScanLoop::kCageMask);
+        break;
+      case 1:
+      case 2:
+      case 3:
+        *word = random;
+        break;
+      case 4:
+      case 5:
+      case 6:
+      case 7:
+        *word = random >> 48;
+        break;
+      default:
+        *word = 0;
+    }
+  }
+}
+
+class PartitionAllocScanLoopPerfTest : public testing::TestWithParam<Isa> {};
+
+INSTANTIATE_TEST_SUITE_P(AllIsas,
+                         PartitionAllocScanLoopPerfTest,
+                         ::testing::ValuesIn(kIsas));
+
+}  // namespace
+
+TEST_P(PartitionAllocScanLoopPerfTest, Throughput) {
+  const Isa isa = GetParam();
+  if (!IsSupported(isa.simd))
+    return;
+
+  constexpr size_t kWords = kRangeSizeInBytes / sizeof(uintptr_t);
+  std::unique_ptr<uintptr_t, AlignedFreeDeleter> range(static_cast<uintptr_t*>(
+      AlignedAlloc(kRangeSizeInBytes, /*alignment=*/64)));
+  uintptr_t* const begin = range.get();
+  uintptr_t* const end = begin + kWords;
+  FillRange(begin, end);
+
+  BenchmarkScanLoop scan_loop(isa.simd);
+  LapTimer timer(kWarmupRuns, kTimeLimit, kTimeCheckInterval);
+  do {
+    scan_loop.Run(begin, end);
+    timer.NextLap();
+  } while (!timer.HasTimeLimitExpired());
+  EXPECT_NE(0u, scan_loop.in_cage());
+
+  perf_test::PerfResultReporter reporter(kMetricPrefixScanLoop, isa.name);
+  reporter.RegisterImportantMetric(kMetricThroughput, "GB/s");
+  reporter.AddResult(kMetricThroughput,
+                     timer.LapsPerSecond() * kRangeSizeInBytes / 1e9);
+}
+
+}  // namespace internal
+}  // namespace base
+
+#endif  // defined(PA_HAS_64_BITS_POINTERS)
@@ -138,6 +138,43 @@ TEST(PartitionAllocScanLoopTest, VectorizedAVX2) {
                                  kValidPtr, kValidPtr);
   }
 }
+
+TEST(PartitionAllocScanLoopTest, VectorizedAVX512) {
+  base::CPU cpu;
+  if (!cpu.has_avx512f())
+    return;
+  {
+    TestScanLoop sl(SimdSupport::kAVX512);
+    TestOnRangeWithAlignment<64>(sl, 0u, kInvalidPtr, kInvalidPtr, kInvalidPtr,
+                                 kInvalidPtr, kInvalidPtr, kInvalidPtr,
+                                 kInvalidPtr, kInvalidPtr, kInvalidPtr);
+  }
+  {
+    TestScanLoop sl(SimdSupport::kAVX512);
+    TestOnRangeWithAlignment<64>(sl, 1u, kValidPtr, kInvalidPtr, kInvalidPtr,
+                                 kInvalidPtr, kInvalidPtr, kInvalidPtr,
+                                 kInvalidPtr, kInvalidPtr, kInvalidPtr);
+  }
+  {
+    TestScanLoop sl(SimdSupport::kAVX512);
+    TestOnRangeWithAlignment<64>(sl, 3u, kValidPtr, kValidPtr, kValidPtr,
+                                 kInvalidPtr, kInvalidPtr, kInvalidPtr,
+                                 kInvalidPtr, kInvalidPtr, kZeroPtr);
+  }
+  {
+    TestScanLoop sl(SimdSupport::kAVX512);
+    TestOnRangeWithAlignment<64>(sl, 8u, kValidPtr, kValidPtr, kValidPtr,
+                                 kValidPtr, kValidPtr, kValidPtr, kValidPtr,
+                                 kValidPtr, kInvalidPtr);
+  }
+  {
+    // Check that the residual pointer is also visited.
+    TestScanLoop sl(SimdSupport::kAVX512);
+    TestOnRangeWithAlignment<64>(sl, 9u, kValidPtr, kValidPtr, kValidPtr,
+                                 kValidPtr, kValidPtr, kValidPtr, kValidPtr,
+                                 kValidPtr, kValidPtr);
+  }
+}
 #endif  // defined(ARCH_CPU_X86_64)
 
 #if defined(PA_STARSCAN_NEON_SUPPORTED)
@@ -163,6 +200,12 @@ TEST(PartitionAllocScanLoopTest, VectorizedNEON) {
     TestScanLoop sl(SimdSupport::kNEON);
     TestOnRangeWithAlignment<16>(sl, 1u, kInvalidPtr, kValidPtr, kZeroPtr);
   }
+  {
+    // Two vectors per iteration, and a residual pointer.
+    TestScanLoop sl(SimdSupport::kNEON);
+    TestOnRangeWithAlignment<16>(sl, 3u, kValidPtr, kInvalidPtr, kValidPtr,
+                                 kInvalidPtr, kValidPtr);
+  }
 }
 #endif  // defined(PA_STARSCAN_NEON_SUPPORTED)
 
@@ -29,6 +29,10 @@ class StarScanSnapshot final : public AllocatedOnPCScanMetadataPartition {
     template <typename Function>
     void VisitNonConcurrently(Function);
 
+    // See RacefulWorklist::VisitExclusively().
+    template <typename Function, typename YieldFunction>
+    bool VisitExclusively(Function, YieldFunction);
+
    protected:
     explicit ViewBase(SuperPagesWorklist& worklist) : worklist_(worklist) {}
 
@@ -80,6 +84,12 @@ void StarScanSnapshot::ViewBase::VisitNonConcurrently(Function f) {
   worklist_.VisitNonConcurrently(std::move(f));
 }
 
+template <typename Function, typename YieldFunction>
+bool StarScanSnapshot::ViewBase::VisitExclusively(Function f,
+                                                  YieldFunction should_yield) {
+  return worklist_.VisitExclusively(std::move(f), std::move(should_yield));
+}
+
 StarScanSnapshot::ClearingView::ClearingView(StarScanSnapshot& snapshot)
     : StarScanSnapshot::ViewBase(snapshot.clear_worklist_) {}
 
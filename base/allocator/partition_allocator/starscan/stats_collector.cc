@@ -4,6 +4,9 @@
 
 #include "base/allocator/partition_allocator/starscan/stats_collector.h"
 
+#include <algorithm>
+#include <vector>
+
 #include "base/allocator/partition_allocator/starscan/logging.h"
 #include "base/allocator/partition_allocator/starscan/stats_reporter.h"
 #include "base/time/time.h"
@@ -29,6 +32,29 @@ void StatsCollector::ReportTracesAndHists(StatsReporter& reporter) const {
   ReportTracesAndHistsImpl<Context::kMutator>(reporter, mutator_trace_events_);
   ReportTracesAndHistsImpl<Context::kScanner>(reporter, scanner_trace_events_);
   ReportSurvivalRate(reporter);
+  ReportMutatorPauses(reporter);
+}
+
+// static
+StatsCollector::PausePercentiles StatsCollector::ComputePausePercentiles(
+    base::TimeDelta* pauses,
+    size_t count) {
+  PausePercentiles percentiles;
+  if (!count)
+    return percentiles;
+  // The nearest-rank percentile p is the smallest pause which is larger than
+  // or equal to p% of the pauses.
+  const auto percentile = [pauses, count](size_t p) {
+    const size_t rank = std::max<size_t>((p * count + 99) / 100, 1);
+    base::TimeDelta* nth = pauses + rank - 1;
+    std::nth_element(pauses, nth, pauses + count);
+    return *nth;
+  };
+  percentiles.p50 = percentile(50);
+  percentiles.p90 = percentile(90);
+  percentiles.p99 = percentile(99);
+  percentiles.max = *std::max_element(pauses, pauses + count);
+  return percentiles;
 }
 
 template <Context context>
@@ -88,9 +114,33 @@ void StatsCollector::ReportSurvivalRate(StatsReporter& reporter) const {
                     << survived_quarantine_size()
                     << ", swept bytes: " << swept_size()
                     << ", survival rate: " << survived_rate;
-  if (discarded_quarantine_size_)
+  if (discarded_quarantine_size())
     PA_PCSCAN_VLOG(2) << "discarded quarantine size: "
-                      << discarded_quarantine_size_;
+                      << discarded_quarantine_size();
+}
+
+void StatsCollector::ReportMutatorPauses(StatsReporter& reporter) const {
+  if (!process_name_)
+    return;
+  std::vector<base::TimeDelta, MetadataAllocator<base::TimeDelta>> pauses;
+  for (const auto& tid_and_events :
+       mutator_trace_events_.get_underlying_map_unsafe()) {
+    const auto& event =
+        tid_and_events.second[static_cast<size_t>(MutatorId::kOverall)];
+    if (event.start_time.is_null())
+      continue;
+    pauses.push_back(event.end_time - event.start_time);
+  }
+  if (pauses.empty())
+    return;
+  const PausePercentiles percentiles =
+      ComputePausePercentiles(pauses.data(), pauses.size());
+  const MetadataString prefix =
+      "PA.PCScan." + MetadataString(process_name_) + ".Mutator.Pause.";
+  reporter.ReportStats((prefix + "P50").c_str(), percentiles.p50);
+  reporter.ReportStats((prefix + "P90").c_str(), percentiles.p90);
+  reporter.ReportStats((prefix + "P99").c_str(), percentiles.p99);
+  reporter.ReportStats((prefix + "Max").c_str(), percentiles.max);
 }
 
 template base::TimeDelta StatsCollector::GetTimeImpl(
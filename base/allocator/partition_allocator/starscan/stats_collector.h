@@ -111,6 +111,20 @@ class StatsCollector final {
   using ScannerScope = Scope<Context::kScanner>;
   using MutatorScope = Scope<Context::kMutator>;
 
+  // Percentiles of the pauses of the mutators which joined a scan, i.e. of the
+  // time they spent in the safepoint.
+  struct PausePercentiles {
+    base::TimeDelta p50;
+    base::TimeDelta p90;
+    base::TimeDelta p99;
+    base::TimeDelta max;
+  };
+
+  // Computes the nearest-rank percentiles of |count| pauses. Reorders
+  // |pauses|.
+  static PausePercentiles ComputePausePercentiles(base::TimeDelta* pauses,
+                                                  size_t count);
+
   StatsCollector(const char* process_name, size_t quarantine_last_size);
 
   StatsCollector(const StatsCollector&) = delete;
@@ -125,11 +139,19 @@ class StatsCollector final {
     return survived_quarantine_size_.load(std::memory_order_relaxed);
   }
 
-  void IncreaseSweptSize(size_t size) { swept_size_ += size; }
-  size_t swept_size() const { return swept_size_; }
+  // Sweeping may be shared with helper threads.
+  void IncreaseSweptSize(size_t size) {
+    swept_size_.fetch_add(size, std::memory_order_relaxed);
+  }
+  size_t swept_size() const {
+    return swept_size_.load(std::memory_order_relaxed);
+  }
 
   void IncreaseDiscardedQuarantineSize(size_t size) {
-    discarded_quarantine_size_ += size;
+    discarded_quarantine_size_.fetch_add(size, std::memory_order_relaxed);
+  }
+  size_t discarded_quarantine_size() const {
+    return discarded_quarantine_size_.load(std::memory_order_relaxed);
   }
 
   base::TimeDelta GetOverallTime() const;
@@ -165,13 +187,14 @@ class StatsCollector final {
       const DeferredTraceEventMap<context>& event_map) const;
 
   void ReportSurvivalRate(StatsReporter& reporter) const;
+  void ReportMutatorPauses(StatsReporter& reporter) const;
 
   DeferredTraceEventMap<Context::kMutator> mutator_trace_events_;
   DeferredTraceEventMap<Context::kScanner> scanner_trace_events_;
 
   std::atomic<size_t> survived_quarantine_size_{0u};
-  size_t swept_size_ = 0u;
-  size_t discarded_quarantine_size_ = 0u;
+  std::atomic<size_t> swept_size_{0u};
+  std::atomic<size_t> discarded_quarantine_size_{0u};
   const char* process_name_ = nullptr;
   const size_t quarantine_last_size_ = 0u;
 };
@@ -0,0 +1,48 @@
+// Copyright 2022 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "base/allocator/partition_allocator/starscan/stats_collector.h"
+
+#include <algorithm>
+#include <random>
+#include <vector>
+
+#include "base/time/time.h"
+#include "testing/gtest/include/gtest/gtest.h"
+
+namespace base {
+namespace internal {
+
+TEST(PartitionAllocPCScanStatsCollectorTest, PausePercentilesOfNoPauses) {
+  const auto percentiles = StatsCollector::ComputePausePercentiles(nullptr, 0);
+  EXPECT_TRUE(percentiles.p50.is_zero());
+  EXPECT_TRUE(percentiles.max.is_zero());
+}
+
+TEST(PartitionAllocPCScanStatsCollectorTest, PausePercentilesOfOnePause) {
+  TimeDelta pause = Milliseconds(3);
+  const auto percentiles = StatsCollector::ComputePausePercentiles(&pause, 1);
+  EXPECT_EQ(Milliseconds(3), percentiles.p50);
+  EXPECT_EQ(Milliseconds(3), percentiles.p90);
+  EXPECT_EQ(Milliseconds(3), percentiles.p99);
+  EXPECT_EQ(Milliseconds(3), percentiles.max);
+}
+
+TEST(PartitionAllocPCScanStatsCollectorTest, PausePercentiles) {
+  // 1ms to 200ms, shuffled.
+  std::vector<TimeDelta> pauses;
+  for (int i = 1; i <= 200; ++i)
+    pauses.push_back(Milliseconds(i));
+  std::shuffle(pauses.begin(), pauses.end(), std::mt19937());
+
+  const auto percentiles =
+      StatsCollector::ComputePausePercentiles(pauses.data(), pauses.size());
+  EXPECT_EQ(Milliseconds(100), percentiles.p50);
+  EXPECT_EQ(Milliseconds(180), percentiles.p90);
+  EXPECT_EQ(Milliseconds(198), percentiles.p99);
+  EXPECT_EQ(Milliseconds(200), percentiles.max);
+}
+
+}  // namespace internal
+}  // namespace base
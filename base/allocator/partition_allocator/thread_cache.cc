@@ -75,6 +75,7 @@ uint8_t ThreadCache::global_limits_[ThreadCache::kBucketCount];
 // Start with the normal size, not the maximum one.
 uint16_t ThreadCache::largest_active_bucket_index_ =
     BucketIndexLookup::GetIndex(ThreadCache::kDefaultSizeThreshold);
+bool ThreadCache::adaptive_limits_ = false;
 
 // static
 ThreadCacheRegistry& ThreadCacheRegistry::Instance() {
@@ -227,6 +228,26 @@ void ThreadCacheRegistry::SetThreadCacheMultiplier(float multiplier) {
   }
 }
 
+void ThreadCacheRegistry::SetAdaptiveLimits(bool enabled) {
+  PartitionAutoLock scoped_locker(GetLock());
+  ThreadCache::adaptive_limits_ = enabled;
+  if (enabled)
+    return;
+
+  // Racy, as in |SetThreadCacheMultiplier()|: a thread cache may be
+  // rebalancing its limits concurrently. It stops doing so at its next slow
+  // path event at the latest.
+  ThreadCache* tcache = list_head_;
+  while (tcache) {
+    PA_DCHECK(ThreadCache::IsValid(tcache));
+    for (int index = 0; index < ThreadCache::kBucketCount; index++) {
+      tcache->buckets_[index].limit.store(ThreadCache::global_limits_[index],
+                                          std::memory_order_relaxed);
+    }
+    tcache = tcache->next_;
+  }
+}
+
 void ThreadCacheRegistry::RunPeriodicPurge() {
   if (!periodic_purge_is_initialized_) {
     ThreadCache::EnsureThreadSpecificDataInitialized();
@@ -360,9 +381,6 @@ void ThreadCache::Init(PartitionRoot<>* root) {
 
 // static
 void ThreadCache::SetGlobalLimits(PartitionRoot<>* root, float multiplier) {
-  size_t initial_value =
-      static_cast<size_t>(kSmallBucketBaseCount) * multiplier;
-
   for (int index = 0; index < kBucketCount; index++) {
     const auto& root_bucket = root->buckets[index];
     // Invalid bucket.
@@ -371,30 +389,33 @@ void ThreadCache::SetGlobalLimits(PartitionRoot<>* root, float multiplier) {
       continue;
     }
 
-    // Smaller allocations are more frequent, and more performance-sensitive.
-    // Cache more small objects, and fewer larger ones, to save memory.
-    size_t slot_size = root_bucket.slot_size;
-    size_t value;
-    if (slot_size <= 128) {
-      value = initial_value;
-    } else if (slot_size <= 256) {
-      value = initial_value / 2;
-    } else if (slot_size <= 512) {
-      value = initial_value / 4;
-    } else {
-      value = initial_value / 8;
-    }
+    global_limits_[index] = GetBucketLimit(root_bucket.slot_size, multiplier);
+  }
+}
+
+// static
+uint8_t ThreadCache::GetBucketLimit(size_t slot_size, float multiplier) {
+  size_t initial_value =
+      static_cast<size_t>(kSmallBucketBaseCount) * multiplier;
 
-    // Bare minimum so that malloc() / free() in a loop will not hit the central
-    // allocator each time.
-    constexpr size_t kMinLimit = 1;
-    // |PutInBucket()| is called on a full bucket, which should not overflow.
-    constexpr size_t kMaxLimit = std::numeric_limits<uint8_t>::max() - 1;
-    global_limits_[index] =
-        static_cast<uint8_t>(base::clamp(value, kMinLimit, kMaxLimit));
-    PA_DCHECK(global_limits_[index] >= kMinLimit);
-    PA_DCHECK(global_limits_[index] <= kMaxLimit);
+  // Smaller allocations are more frequent, and more performance-sensitive.
+  // Cache more small objects, and fewer larger ones, to save memory.
+  size_t value;
+  if (slot_size <= 128) {
+    value = initial_value;
+  } else if (slot_size <= 256) {
+    value = initial_value / 2;
+  } else if (slot_size <= 512) {
+    value = initial_value / 4;
+  } else {
+    value = initial_value / 8;
   }
+
+  uint8_t limit = static_cast<uint8_t>(base::clamp(
+      value, size_t{kMinLimit}, size_t{kMaxLimit}));
+  PA_DCHECK(limit >= kMinLimit);
+  PA_DCHECK(limit <= kMaxLimit);
+  return limit;
 }
 
 // static
@@ -426,9 +447,7 @@ ThreadCache* ThreadCache::Create(PartitionRoot<internal::ThreadSafe>* root) {
   size_t usable_size;
   bool already_zeroed;
 
-  auto* bucket =
-      root->buckets + PartitionRoot<internal::ThreadSafe>::SizeToBucketIndex(
-                          raw_size, root->with_denser_bucket_distribution);
+  auto* bucket = root->buckets + root->SizeToBucketIndex(raw_size);
   uintptr_t buffer =
       root->RawAlloc(bucket, PartitionAllocZeroFill, raw_size,
                      PartitionPageSize(), &usable_size, &already_zeroed);
@@ -547,6 +566,8 @@ void ThreadCache::FillBucket(size_t bucket_index) {
   // tries to keep memory usage low. So clearing half of the bucket, and filling
   // a quarter of it are sensible defaults.
   INCREMENT_COUNTER(stats_.batch_fill_count);
+  if (adaptive_limits_)
+    RecordBucketEvent(activity_[bucket_index].fills);
 
   Bucket& bucket = buckets_[bucket_index];
   // Some buckets may have a limit lower than |kBatchFillRatio|, but we still
@@ -653,6 +674,67 @@ void ThreadCache::FreeAfter(PartitionFreelistEntry* head, size_t slot_size) {
   }
 }
 
+void ThreadCache::RecordBucketEvent(uint16_t& counter) {
+  counter++;
+  if (++events_since_rebalance_ >= kEventsPerRebalance)
+    RebalanceLimits();
+}
+
+void ThreadCache::RebalanceLimits() {
+  // The memory the buckets may hold with the global limits. Memory moves
+  // between buckets, the total is never higher.
+  size_t budget = 0;
+  size_t total = 0;
+  uint8_t limits[kBucketCount];
+  bool in_demand[kBucketCount];
+  for (int index = 0; index <= largest_active_bucket_index_; index++) {
+    const Bucket& bucket = buckets_[index];
+    const BucketActivity& activity = activity_[index];
+    uint8_t limit = bucket.limit.load(std::memory_order_relaxed);
+    in_demand[index] = activity.fills + activity.overflows >= kMinEventsToGrow;
+    limits[index] = limit;
+    // Invalid bucket.
+    if (!limit)
+      continue;
+
+    budget += global_limits_[index] * static_cast<size_t>(bucket.slot_size);
+    if (in_demand[index]) {
+      limits[index] = std::min(2 * limit, int{kMaxLimit});
+    } else if (!activity.fills && !activity.overflows) {
+      limits[index] = std::max(limit / 2, int{kMinLimit});
+    }
+    total += limits[index] * static_cast<size_t>(bucket.slot_size);
+  }
+
+  // Larger buckets hold more memory per slot, take it back from them first.
+  // Every valid bucket has a global limit of at least |kMinLimit|, so this
+  // always gets back within the budget.
+  for (bool demand : {false, true}) {
+    for (int index = largest_active_bucket_index_;
+         index >= 0 && total > budget; index--) {
+      if (in_demand[index] != demand)
+        continue;
+      const size_t slot_size = buckets_[index].slot_size;
+      while (limits[index] > kMinLimit && total > budget) {
+        uint8_t new_limit = limits[index] / 2;
+        total -= (limits[index] - new_limit) * slot_size;
+        limits[index] = new_limit;
+      }
+    }
+  }
+  PA_DCHECK(total <= budget);
+
+  for (int index = 0; index <= largest_active_bucket_index_; index++) {
+    buckets_[index].limit.store(limits[index], std::memory_order_relaxed);
+    // Lowered limits are enforced now, rather than at the next deallocation,
+    // which may not come for buckets that aren't in use.
+    ClearBucket(buckets_[index], limits[index]);
+    activity_[index] = BucketActivity();
+  }
+  events_since_rebalance_ = 0;
+  INCREMENT_COUNTER(stats_.limit_rebalance_count);
+}
+
 void ThreadCache::ResetForTesting() {
   stats_.alloc_count = 0;
   stats_.alloc_hits = 0;
@@ -666,10 +748,16 @@ void ThreadCache::ResetForTesting() {
   stats_.cache_fill_misses = 0;
 
   stats_.batch_fill_count = 0;
+  stats_.batch_clear_count = 0;
+  stats_.limit_rebalance_count = 0;
 
   stats_.bucket_total_memory = 0;
   stats_.metadata_overhead = 0;
 
+  for (BucketActivity& activity : activity_)
+    activity = BucketActivity();
+  events_since_rebalance_ = 0;
+
   Purge();
   PA_CHECK(cached_memory_ == 0u);
   should_purge_.store(false, std::memory_order_relaxed);
@@ -696,6 +784,8 @@ void ThreadCache::AccumulateStats(ThreadCacheStats* stats) const {
   stats->cache_fill_misses += stats_.cache_fill_misses;
 
   stats->batch_fill_count += stats_.batch_fill_count;
+  stats->batch_clear_count += stats_.batch_clear_count;
+  stats->limit_rebalance_count += stats_.limit_rebalance_count;
 
 #if defined(PA_THREAD_CACHE_ALLOC_STATS)
   for (size_t i = 0; i < kNumBuckets + 1; i++)
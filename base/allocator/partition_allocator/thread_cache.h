@@ -133,6 +133,11 @@ class BASE_EXPORT ThreadCacheRegistry {
   // or below |ThreadCache::kDefaultMultiplier|.
   void SetThreadCacheMultiplier(float multiplier);
   void SetLargestActiveBucketIndex(uint8_t largest_active_bucket_index);
+  // Lets each thread cache move memory from the buckets it doesn't use to the
+  // ones it does, without caching more than the limits set by
+  // |SetThreadCacheMultiplier()| allow overall. See
+  // |ThreadCache::RebalanceLimits()|. Disabling it restores these limits.
+  void SetAdaptiveLimits(bool enabled);
 
   static PartitionLock& GetLock() { return Instance().lock_; }
   // Purges all thread caches *now*. This is completely thread-unsafe, and
@@ -301,6 +306,11 @@ class BASE_EXPORT ThreadCache {
   // |kLargeSizeThreshold|.
   static void SetLargestCachedSize(size_t size);
 
+  // Returns how many slots of |slot_size| bytes a bucket of the cache holds
+  // at most, for a given |multiplier| (see SetThreadCacheMultiplier()). Also
+  // used by PerCpuCache.
+  static uint8_t GetBucketLimit(size_t slot_size, float multiplier);
+
   // Fill 1 / kBatchFillRatio * bucket.limit slots at a time.
   static constexpr uint16_t kBatchFillRatio = 8;
 
@@ -309,6 +319,19 @@ class BASE_EXPORT ThreadCache {
   static constexpr float kDefaultMultiplier = 2.;
   static constexpr uint8_t kSmallBucketBaseCount = 64;
 
+  // Bare minimum so that malloc() / free() in a loop will not hit the central
+  // allocator each time.
+  static constexpr uint8_t kMinLimit = 1;
+  // |PutInBucket()| is called on a full bucket, which should not overflow.
+  static constexpr uint8_t kMaxLimit = std::numeric_limits<uint8_t>::max() - 1;
+
+  // With adaptive limits, the limits are rebalanced every
+  // |kEventsPerRebalance| bucket fills or overflows, and a bucket with at least
+  // |kMinEventsToGrow| of them since the previous rebalancing gets a higher
+  // limit.
+  static constexpr uint16_t kEventsPerRebalance = 256;
+  static constexpr uint16_t kMinEventsToGrow = 8;
+
   static constexpr size_t kDefaultSizeThreshold =
       ThreadCacheLimits::kDefaultSizeThreshold;
   static constexpr size_t kLargeSizeThreshold =
@@ -328,6 +351,13 @@ class BASE_EXPORT ThreadCache {
   };
   static_assert(sizeof(Bucket) <= 2 * sizeof(void*), "Keep Bucket small.");
 
+  // Slow path events of a bucket since the last |RebalanceLimits()|. Only
+  // recorded with adaptive limits.
+  struct BucketActivity {
+    uint16_t fills = 0;
+    uint16_t overflows = 0;
+  };
+
   explicit ThreadCache(PartitionRoot<>* root);
   static void Delete(void* thread_cache_ptr);
   void PurgeInternal();
@@ -336,6 +366,15 @@ class BASE_EXPORT ThreadCache {
   // Empties the |bucket| until there are at most |limit| objects in it.
   void ClearBucket(Bucket& bucket, size_t limit);
   ALWAYS_INLINE void PutInBucket(Bucket& bucket, uintptr_t slot_start);
+  // Increments |counter|, one of the |activity_| ones, and rebalances the
+  // limits every |kEventsPerRebalance| calls.
+  void RecordBucketEvent(uint16_t& counter);
+  // Doubles the limits of the buckets with enough slow path events since the
+  // last call, and halves the ones of the buckets without any. Then, if the
+  // buckets may hold more memory than with the global limits, lowers the
+  // limits of the largest buckets, starting with the ones which aren't in
+  // demand.
+  void RebalanceLimits();
   void ResetForTesting();
   // Releases the entire freelist starting at |head| to the root.
   void FreeAfter(PartitionFreelistEntry* head, size_t slot_size);
@@ -374,6 +413,8 @@ class BASE_EXPORT ThreadCache {
   // TODO(lizeb): Investigate making this per-thread rather than static, to
   // improve locality, and open the door to per-thread settings.
   static uint16_t largest_active_bucket_index_;
+  // See |ThreadCacheRegistry::SetAdaptiveLimits()|.
+  static bool adaptive_limits_;
 
   // These are at the beginning as they're accessed for each allocation.
   uint32_t cached_memory_ = 0;
@@ -389,6 +430,8 @@ class BASE_EXPORT ThreadCache {
 #if DCHECK_IS_ON()
   bool is_in_thread_cache_ = false;
 #endif
+  BucketActivity activity_[kBucketCount];
+  uint16_t events_since_rebalance_ = 0;
 
   // Intrusive list since ThreadCacheRegistry::RegisterThreadCache() cannot
   // allocate.
@@ -418,6 +461,9 @@ class BASE_EXPORT ThreadCache {
   FRIEND_TEST_ALL_PREFIXES(PartitionAllocThreadCacheTest,
                            DynamicSizeThresholdPurge);
   FRIEND_TEST_ALL_PREFIXES(PartitionAllocThreadCacheTest, ClearFromTail);
+  FRIEND_TEST_ALL_PREFIXES(PartitionAllocThreadCacheTest, AdaptiveLimits);
+  FRIEND_TEST_ALL_PREFIXES(PartitionAllocThreadCacheTest,
+                           AdaptiveLimitsStayWithinBudget);
 };
 
 ALWAYS_INLINE bool ThreadCache::MaybePutInCache(uintptr_t slot_start,
@@ -445,7 +491,10 @@ ALWAYS_INLINE bool ThreadCache::MaybePutInCache(uintptr_t slot_start,
   uint8_t limit = bucket.limit.load(std::memory_order_relaxed);
   // Batched deallocation, amortizing lock acquisitions.
   if (UNLIKELY(bucket.count > limit)) {
+    INCREMENT_COUNTER(stats_.batch_clear_count);
     ClearBucket(bucket, limit / 2);
+    if (adaptive_limits_)
+      RecordBucketEvent(activity_[bucket_index].overflows);
   }
 
   if (UNLIKELY(should_purge_.load(std::memory_order_relaxed)))
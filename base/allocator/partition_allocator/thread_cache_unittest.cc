@@ -100,6 +100,7 @@ class PartitionAllocThreadCacheTest : public ::testing::TestWithParam<bool> {
   PartitionAllocThreadCacheTest() : root_(CreatePartitionRoot()) {}
 
   ~PartitionAllocThreadCacheTest() override {
+    ThreadCacheRegistry::Instance().SetAdaptiveLimits(false);
     ThreadCache::SetLargestCachedSize(ThreadCache::kDefaultSizeThreshold);
     SwapInProcessThreadCacheForTesting(root_);
 
@@ -902,6 +903,66 @@ TEST_P(PartitionAllocThreadCacheTest, ClearFromTail) {
   EXPECT_EQ(nullptr, static_cast<void*>(tcache->buckets_[index].freelist_head));
 }
 
+TEST_P(PartitionAllocThreadCacheTest, AdaptiveLimits) {
+  auto* tcache = root_->thread_cache_for_testing();
+  DeltaCounter rebalance_counter{tcache->stats_.limit_rebalance_count};
+  ThreadCacheRegistry::Instance().SetAdaptiveLimits(true);
+
+  size_t medium_index = FillThreadCacheAndReturnIndex(kMediumSize, 10);
+  size_t small_index = 0;
+  // The small bucket fills and overflows constantly, the medium one is idle.
+  for (int i = 0; i < 100 && rebalance_counter.Delta() < 2; i++)
+    small_index = FillThreadCacheAndReturnIndex(kSmallSize, 1000);
+  ASSERT_GE(rebalance_counter.Delta(), 2u);
+
+  EXPECT_GT(tcache->buckets_[small_index].limit.load(std::memory_order_relaxed),
+            kDefaultCountForSmallBucket);
+  uint8_t medium_limit =
+      tcache->buckets_[medium_index].limit.load(std::memory_order_relaxed);
+  EXPECT_LT(medium_limit, kDefaultCountForMediumBucket);
+  // Lowered limits are enforced right away.
+  EXPECT_LE(tcache->buckets_[medium_index].count, medium_limit);
+
+  // Back to the global limits.
+  ThreadCacheRegistry::Instance().SetAdaptiveLimits(false);
+  EXPECT_EQ(kDefaultCountForSmallBucket,
+            tcache->buckets_[small_index].limit.load(std::memory_order_relaxed));
+  EXPECT_EQ(
+      kDefaultCountForMediumBucket,
+      tcache->buckets_[medium_index].limit.load(std::memory_order_relaxed));
+}
+
+TEST_P(PartitionAllocThreadCacheTest, AdaptiveLimitsStayWithinBudget) {
+  auto* tcache = root_->thread_cache_for_testing();
+  size_t budget = 0;
+  for (size_t i = 0; i <= ThreadCache::largest_active_bucket_index_; i++) {
+    budget += ThreadCache::global_limits_[i] *
+              static_cast<size_t>(tcache->buckets_[i].slot_size);
+    // Every bucket asks for more.
+    tcache->activity_[i].fills = ThreadCache::kMinEventsToGrow;
+  }
+  tcache->RebalanceLimits();
+
+  size_t total = 0;
+  for (size_t i = 0; i <= ThreadCache::largest_active_bucket_index_; i++) {
+    uint8_t limit = tcache->buckets_[i].limit.load(std::memory_order_relaxed);
+    // Invalid bucket.
+    if (!ThreadCache::global_limits_[i]) {
+      EXPECT_EQ(0u, limit);
+      continue;
+    }
+    EXPECT_GE(limit, ThreadCache::kMinLimit);
+    total += limit * static_cast<size_t>(tcache->buckets_[i].slot_size);
+  }
+  EXPECT_LE(total, budget);
+
+  // The memory comes from the largest buckets.
+  size_t small_index =
+      PartitionRoot<ThreadSafe>::SizeToBucketIndex(kSmallSize, GetParam());
+  EXPECT_GT(tcache->buckets_[small_index].limit.load(std::memory_order_relaxed),
+            kDefaultCountForSmallBucket);
+}
+
 // TODO(https://crbug.com/1287799): Flaky on IOS.
 #if BUILDFLAG(IS_IOS)
 #define MAYBE_Bookkeeping DISABLED_Bookkeeping
@@ -0,0 +1,192 @@
+#!/usr/bin/env python3
+# Copyright 2022 The Chromium Authors. All rights reserved.
+# Use of this source code is governed by a BSD-style license that can be
+# found in the LICENSE file.
+
+"""Generates a PartitionAlloc CustomBucketDistribution from a histogram.
+
+The histogram has one "<size> <count>" line per allocation size, e.g. the
+"size_*" sample counts of the PartitionFragmentationProfiler dumps of a
+partition, or the output of any other allocation recorder. Empty lines and
+lines starting with '#' are ignored.
+
+The generated header defines the slot sizes of the denser bucket distribution,
+plus the slot sizes which save the most memory for the histogram, within the
+constraints of CustomBucketDistribution: at most one extra slot size between
+two consecutive buckets, and no more of them than the bucket array has room
+for. It's used as:
+
+  #include "path/to/generated.h"
+
+  PartitionOptions opts(...);
+  opts.custom_bucket_distribution = &kFooBucketDistribution;
+
+The constants below must match partition_alloc_constants.h.
+"""
+
+import argparse
+import collections
+import sys
+
+# kNumBucketsPerOrderBits, and kMaxBucketedOrder.
+NUM_BUCKETS_PER_ORDER_BITS = 2
+MAX_BUCKETED_ORDER = 20
+
+
+def DenserBucketSizes(alignment):
+  """Returns the slot sizes of BucketIndexLookup, and the size of its array."""
+  min_bucketed_order = 5 if alignment == 16 else 4
+  num_buckets_per_order = 1 << NUM_BUCKETS_PER_ORDER_BITS
+  num_bucketed_orders = MAX_BUCKETED_ORDER - min_bucketed_order + 1
+  smallest_bucket = 1 << (min_bucketed_order - 1)
+
+  sizes = []
+  size = smallest_bucket
+  increment = smallest_bucket >> NUM_BUCKETS_PER_ORDER_BITS
+  for _ in range(num_bucketed_orders):
+    for _ in range(num_buckets_per_order):
+      if size % alignment == 0:
+        sizes.append(size)
+      size += increment
+    increment <<= 1
+  return sizes, num_bucketed_orders * num_buckets_per_order
+
+
+def SlotFor(slot_sizes, size):
+  """Returns the smallest of |slot_sizes|, which is sorted, fitting |size|."""
+  for slot_size in slot_sizes:
+    if slot_size >= size:
+      return slot_size
+  return None
+
+
+def Waste(slot_sizes, histogram):
+  waste = 0
+  for size, count in histogram.items():
+    slot_size = SlotFor(slot_sizes, size)
+    if slot_size is not None:
+      waste += (slot_size - size) * count
+  return waste
+
+
+def ChooseExtraSizes(dense_sizes, histogram, alignment, max_extra_sizes):
+  """Greedily adds the slot size which saves the most, one range at a time."""
+  chosen = {}  # Index of the dense range -> extra slot size.
+  for _ in range(max_extra_sizes):
+    slot_sizes = sorted(dense_sizes + list(chosen.values()))
+    current_waste = Waste(slot_sizes, histogram)
+    best = None
+    for size in histogram:
+      candidate = (size + alignment - 1) // alignment * alignment
+      if candidate in slot_sizes or candidate > dense_sizes[-1]:
+        continue
+      dense_range = next(
+          i for i, dense_size in enumerate(dense_sizes)
+          if dense_size > candidate)
+      if dense_range in chosen:
+        continue
+      saved = current_waste - Waste(sorted(slot_sizes + [candidate]),
+                                    histogram)
+      if saved > 0 and (best is None or saved > best[0]):
+        best = (saved, dense_range, candidate)
+    if best is None:
+      break
+    chosen[best[1]] = best[2]
+  return sorted(chosen.values())
+
+
+def ReadHistogram(path, extras_size):
+  histogram = collections.Counter()
+  with open(path) as f:
+    for line_number, line in enumerate(f, 1):
+      line = line.strip()
+      if not line or line.startswith('#'):
+        continue
+      fields = line.replace(',', ' ').split()
+      if len(fields) != 2:
+        sys.exit('%s:%d: expected "<size> <count>"' % (path, line_number))
+      size, count = int(fields[0]), int(fields[1])
+      histogram[max(size, 1) + extras_size] += count
+  return histogram
+
+
+def WriteHeader(output, name, namespace, slot_sizes, extra_sizes, histogram,
+                dense_sizes, input_path):
+  guard = ''.join(c if c.isalnum() else '_' for c in output.upper()) + '_'
+  lines = [
+      '// Generated by gen_custom_bucket_distribution.py from %s.' % input_path,
+      '// Do not edit.',
+      '//',
+      '// Extra slot sizes: %s.' % ', '.join(str(s) for s in extra_sizes),
+      '// Rounding waste for the histogram: %d bytes, was %d bytes.' %
+      (Waste(slot_sizes, histogram), Waste(dense_sizes, histogram)),
+      '',
+      '#ifndef %s' % guard,
+      '#define %s' % guard,
+      '',
+      '#include <cstddef>',
+      '',
+      '#include "base/allocator/partition_allocator/partition_bucket_lookup.h"',
+      '',
+  ]
+  if namespace:
+    lines += ['namespace %s {' % namespace, '']
+  lines.append('inline constexpr size_t k%sSlotSizes[] = {' % name)
+  row = '   '
+  for slot_size in slot_sizes:
+    entry = ' %d,' % slot_size
+    if len(row) + len(entry) > 80:
+      lines.append(row)
+      row = '   '
+    row += entry
+  lines += [row, '};', '']
+  lines += [
+      'inline constexpr ::partition_alloc::internal::CustomBucketDistribution',
+      '    k%sBucketDistribution{k%sSlotSizes};' % (name, name),
+      '',
+  ]
+  if namespace:
+    lines += ['}  // namespace %s' % namespace, '']
+  lines += ['#endif  // %s' % guard]
+
+  with open(output, 'w') as f:
+    f.write('\n'.join(lines) + '\n')
+
+
+def main():
+  parser = argparse.ArgumentParser(description=__doc__.split('\n')[0])
+  parser.add_argument('--input', required=True, help='The histogram.')
+  parser.add_argument('--output', required=True, help='The header to write.')
+  parser.add_argument('--name', required=True,
+                      help='The constants are k<name>SlotSizes and '
+                      'k<name>BucketDistribution.')
+  parser.add_argument('--namespace', default='',
+                      help='The namespace of the constants.')
+  parser.add_argument('--alignment', type=int, default=16,
+                      help='base::kAlignment on the target.')
+  parser.add_argument('--extras-size', type=int, default=0,
+                      help='The size of the extras of the partition, e.g. '
+                      'the ref-count, which are added to the requested '
+                      'sizes.')
+  parser.add_argument('--max-extra-sizes', type=int, default=None,
+                      help='The number of extra slot sizes, at most and by '
+                      'default the number of unused entries of the bucket '
+                      'array.')
+  args = parser.parse_args()
+
+  dense_sizes, num_buckets = DenserBucketSizes(args.alignment)
+  max_extra_sizes = num_buckets - len(dense_sizes)
+  if args.max_extra_sizes is not None:
+    max_extra_sizes = min(max_extra_sizes, args.max_extra_sizes)
+
+  histogram = ReadHistogram(args.input, args.extras_size)
+  extra_sizes = ChooseExtraSizes(dense_sizes, histogram, args.alignment,
+                                 max_extra_sizes)
+  slot_sizes = sorted(dense_sizes + extra_sizes)
+  WriteHeader(args.output, args.name, args.namespace, slot_sizes, extra_sizes,
+              histogram, dense_sizes, args.input)
+  return 0
+
+
+if __name__ == '__main__':
+  sys.exit(main())
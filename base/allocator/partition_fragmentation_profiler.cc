@@ -0,0 +1,351 @@
+// Copyright 2022 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "base/allocator/partition_fragmentation_profiler.h"
+
+#include <algorithm>
+#include <map>
+#include <string>
+#include <utility>
+
+#include "base/allocator/partition_allocator/partition_address_space.h"
+#include "base/allocator/partition_allocator/partition_root.h"
+#include "base/check.h"
+#include "base/debug/stack_trace.h"
+#include "base/no_destructor.h"
+
+#if BUILDFLAG(ENABLE_BASE_TRACING)
+#include "base/strings/stringprintf.h"
+#include "base/trace_event/memory_allocator_dump.h"
+#include "base/trace_event/memory_dump_manager.h"
+#include "base/trace_event/memory_dump_provider.h"
+#include "base/trace_event/process_memory_dump.h"
+#endif
+
+namespace base {
+
+namespace {
+
+using SlotSpan = ThreadSafePartitionRoot::SlotSpan;
+
+// What a sample tells about its slot span, read with the lock of the root.
+struct SlotSpanInfo {
+  uintptr_t slot_span_start;
+  size_t slot_size;
+  bool is_direct_mapped;
+  size_t live_slots;
+  size_t slots;
+};
+
+}  // namespace
+
+#if BUILDFLAG(ENABLE_BASE_TRACING)
+class PartitionFragmentationProfiler::DumpProvider
+    : public trace_event::MemoryDumpProvider {
+ public:
+  explicit DumpProvider(PartitionFragmentationProfiler* profiler)
+      : profiler_(profiler) {}
+  ~DumpProvider() override = default;
+
+  // trace_event::MemoryDumpProvider:
+  bool OnMemoryDump(const trace_event::MemoryDumpArgs& args,
+                    trace_event::ProcessMemoryDump* pmd) override {
+    // The dump names depend on the slot sizes, and the stacks are strings,
+    // neither of which background dumps allow.
+    if (args.level_of_detail ==
+        trace_event::MemoryDumpLevelOfDetail::BACKGROUND) {
+      return true;
+    }
+
+    for (const Partition& partition : profiler_->GetPartitions()) {
+      for (const BucketStats& bucket :
+           profiler_->GetBucketStats(partition.root)) {
+        DumpBucket(pmd, partition.name, bucket);
+      }
+    }
+    return true;
+  }
+
+ private:
+  static void DumpBucket(trace_event::ProcessMemoryDump* pmd,
+                         const char* partition_name,
+                         const BucketStats& bucket) {
+    using trace_event::MemoryAllocatorDump;
+
+    // Normal buckets go up to ~1MiB, 7 digits.
+    std::string dump_name =
+        StringPrintf("partition_alloc/fragmentation/%s/%s_%07zu",
+                     partition_name,
+                     bucket.is_direct_mapped ? "directMap" : "bucket",
+                     bucket.slot_size);
+    MemoryAllocatorDump* dump = pmd->CreateAllocatorDump(dump_name);
+    // Not "size", which would be counted twice with the partition's dump.
+    dump->AddScalar("estimated_allocated_size",
+                    MemoryAllocatorDump::kUnitsBytes,
+                    bucket.estimated_allocated_size);
+    dump->AddScalar("estimated_rounding_waste",
+                    MemoryAllocatorDump::kUnitsBytes,
+                    bucket.estimated_rounding_waste);
+    dump->AddScalar("slot_size", MemoryAllocatorDump::kUnitsBytes,
+                    bucket.slot_size);
+    dump->AddScalar("sample_count", MemoryAllocatorDump::kUnitsObjects,
+                    bucket.sample_count);
+    dump->AddScalar("sampled_slot_spans", MemoryAllocatorDump::kUnitsObjects,
+                    bucket.sampled_slot_spans);
+    dump->AddScalar("live_slots", MemoryAllocatorDump::kUnitsObjects,
+                    bucket.live_slots);
+    dump->AddScalar("freed_slots", MemoryAllocatorDump::kUnitsObjects,
+                    bucket.slots - bucket.live_slots);
+    dump->AddScalar("pinned_slot_spans", MemoryAllocatorDump::kUnitsObjects,
+                    bucket.pinned_slot_spans);
+    dump->AddScalar("pinned_free_size", MemoryAllocatorDump::kUnitsBytes,
+                    bucket.pinned_free_size);
+
+    for (const RequestedSizeStats& requested_size : bucket.requested_sizes) {
+      MemoryAllocatorDump* size_dump = pmd->CreateAllocatorDump(
+          StringPrintf("%s/size_%07zu", dump_name.c_str(),
+                       requested_size.size));
+      size_dump->AddScalar("sample_count", MemoryAllocatorDump::kUnitsObjects,
+                           requested_size.sample_count);
+    }
+
+    for (size_t i = 0; i < bucket.pinned_slot_span_samples.size(); i++) {
+      const SlotSpanStats& slot_span = bucket.pinned_slot_span_samples[i];
+      MemoryAllocatorDump* span_dump = pmd->CreateAllocatorDump(
+          StringPrintf("%s/pinned_slot_span_%zu", dump_name.c_str(), i));
+      span_dump->AddScalar("live_slots", MemoryAllocatorDump::kUnitsObjects,
+                           slot_span.live_slots);
+      span_dump->AddScalar("freed_slots", MemoryAllocatorDump::kUnitsObjects,
+                           slot_span.slots - slot_span.live_slots);
+      // Symbolized offline.
+      std::string stack;
+      for (const void* frame : slot_span.pinning_stack) {
+        if (!stack.empty())
+          stack += ' ';
+        stack += StringPrintf("%p", frame);
+      }
+      span_dump->AddString("pinning_stack", "stack", stack);
+    }
+  }
+
+  PartitionFragmentationProfiler* const profiler_;
+};
+#endif  // BUILDFLAG(ENABLE_BASE_TRACING)
+
+// static
+PartitionFragmentationProfiler* PartitionFragmentationProfiler::Get() {
+  static NoDestructor<PartitionFragmentationProfiler> instance;
+  return instance.get();
+}
+
+PartitionFragmentationProfiler::PartitionFragmentationProfiler() = default;
+
+PartitionFragmentationProfiler::~PartitionFragmentationProfiler() {
+  Stop();
+#if BUILDFLAG(ENABLE_BASE_TRACING)
+  if (dump_provider_) {
+    trace_event::MemoryDumpManager::GetInstance()->UnregisterDumpProvider(
+        dump_provider_.get());
+  }
+#endif
+}
+
+void PartitionFragmentationProfiler::AddPartition(
+    ThreadSafePartitionRoot* root,
+    const char* name) {
+  PoissonAllocationSampler::ScopedMuteThreadSamples no_samples_scope;
+  AutoLock lock(lock_);
+  DCHECK(!FindPartition(root));
+  partitions_.push_back({root, name});
+}
+
+void PartitionFragmentationProfiler::Start() {
+  {
+    AutoLock lock(lock_);
+    if (running_)
+      return;
+    running_ = true;
+  }
+#if BUILDFLAG(ENABLE_BASE_TRACING)
+  if (!dump_provider_) {
+    dump_provider_ = std::make_unique<DumpProvider>(this);
+    trace_event::MemoryDumpManager::GetInstance()->RegisterDumpProvider(
+        dump_provider_.get(), "PartitionFragmentationProfiler", nullptr);
+  }
+#endif
+  PoissonAllocationSampler::Get()->AddSamplesObserver(this);
+}
+
+void PartitionFragmentationProfiler::Stop() {
+  {
+    AutoLock lock(lock_);
+    if (!running_)
+      return;
+    running_ = false;
+  }
+  PoissonAllocationSampler::Get()->RemoveSamplesObserver(this);
+  PoissonAllocationSampler::ScopedMuteThreadSamples no_samples_scope;
+  AutoLock lock(lock_);
+  samples_.clear();
+}
+
+void PartitionFragmentationProfiler::SampleAdded(
+    void* address,
+    size_t size,
+    size_t total,
+    PoissonAllocationSampler::AllocatorType type,
+    const char* context) {
+  DCHECK(PoissonAllocationSampler::ScopedMuteThreadSamples::IsMuted());
+  uintptr_t address_as_uintptr = reinterpret_cast<uintptr_t>(address);
+  // malloc() samples come from PartitionAlloc only when it's malloc().
+  if (!IsManagedByPartitionAlloc(address_as_uintptr))
+    return;
+  // The allocation is live, and so is its slot span.
+  ThreadSafePartitionRoot* root = ThreadSafePartitionRoot::FromSlotSpan(
+      SlotSpan::FromAddr(address_as_uintptr));
+
+  const void* frames[kMaxStackFrames];
+  size_t frame_count =
+      debug::CollectStackTrace(const_cast<void**>(frames), kMaxStackFrames);
+
+  AutoLock lock(lock_);
+  if (!FindPartition(root))
+    return;
+  samples_[address] = {root, size, total, ++last_sample_ordinal_,
+                       std::vector<const void*>(frames, frames + frame_count)};
+}
+
+void PartitionFragmentationProfiler::SampleRemoved(void* address) {
+  DCHECK(PoissonAllocationSampler::ScopedMuteThreadSamples::IsMuted());
+  AutoLock lock(lock_);
+  samples_.erase(address);
+}
+
+std::vector<PartitionFragmentationProfiler::BucketStats>
+PartitionFragmentationProfiler::GetBucketStats(ThreadSafePartitionRoot* root) {
+  PoissonAllocationSampler::ScopedMuteThreadSamples no_samples_scope;
+  // Holding |lock_| keeps the sampled allocations alive, since freeing them
+  // waits for SampleRemoved().
+  AutoLock lock(lock_);
+
+  std::vector<std::pair<uintptr_t, const Sample*>> samples;
+  for (const auto& it : samples_) {
+    if (it.second.root == root)
+      samples.emplace_back(reinterpret_cast<uintptr_t>(it.first), &it.second);
+  }
+  // Allocated before taking the lock of |root|, which can be the one of
+  // malloc().
+  std::vector<SlotSpanInfo> slot_spans(samples.size());
+  {
+    ::partition_alloc::internal::ScopedGuard guard(root->lock_);
+    for (size_t i = 0; i < samples.size(); i++) {
+      SlotSpan* slot_span = SlotSpan::FromAddr(samples[i].first);
+      // Slots in the thread cache count as live.
+      slot_spans[i] = {SlotSpan::ToSlotSpanStart(slot_span),
+                       slot_span->bucket->slot_size,
+                       slot_span->bucket->is_direct_mapped(),
+                       slot_span->num_allocated_slots,
+                       slot_span->bucket->get_slots_per_span()};
+    }
+  }
+
+  struct SampledSlotSpan {
+    const SlotSpanInfo* info;
+    const Sample* oldest_sample;
+    size_t sample_count;
+  };
+  struct SampledBucket {
+    BucketStats stats;
+    std::map<size_t, size_t> requested_sizes;
+    std::map<uintptr_t, SampledSlotSpan> slot_spans;
+  };
+  std::map<size_t, SampledBucket> buckets;
+  for (size_t i = 0; i < samples.size(); i++) {
+    const Sample& sample = *samples[i].second;
+    const SlotSpanInfo& info = slot_spans[i];
+    SampledBucket& bucket = buckets[info.slot_size];
+    bucket.stats.slot_size = info.slot_size;
+    bucket.stats.is_direct_mapped = info.is_direct_mapped;
+    bucket.stats.sample_count++;
+    bucket.stats.estimated_allocated_size += sample.total;
+    // The waste includes the extras of PartitionAlloc, e.g. the ref-count.
+    if (sample.size && sample.size < info.slot_size) {
+      bucket.stats.estimated_rounding_waste +=
+          sample.total / sample.size * (info.slot_size - sample.size);
+    }
+    bucket.requested_sizes[sample.size]++;
+
+    auto inserted =
+        bucket.slot_spans.insert({info.slot_span_start, {&info, &sample, 0}});
+    SampledSlotSpan& slot_span = inserted.first->second;
+    slot_span.sample_count++;
+    if (sample.ordinal < slot_span.oldest_sample->ordinal)
+      slot_span.oldest_sample = &sample;
+  }
+
+  std::vector<BucketStats> result;
+  for (auto& it : buckets) {
+    SampledBucket& bucket = it.second;
+    BucketStats& stats = bucket.stats;
+
+    for (const auto& size : bucket.requested_sizes)
+      stats.requested_sizes.push_back({size.first, size.second});
+    std::stable_sort(stats.requested_sizes.begin(),
+                     stats.requested_sizes.end(),
+                     [](const RequestedSizeStats& a,
+                        const RequestedSizeStats& b) {
+                       return a.sample_count > b.sample_count;
+                     });
+    if (stats.requested_sizes.size() > kMaxReportedRequestedSizes)
+      stats.requested_sizes.resize(kMaxReportedRequestedSizes);
+
+    std::vector<SlotSpanStats> pinned_slot_spans;
+    for (const auto& span : bucket.slot_spans) {
+      const SlotSpanInfo& info = *span.second.info;
+      stats.sampled_slot_spans++;
+      stats.live_slots += info.live_slots;
+      stats.slots += info.slots;
+
+      double live_ratio = static_cast<double>(info.live_slots) /
+                          std::max<size_t>(info.slots, 1);
+      if (live_ratio > kPinnedSpanLiveRatio)
+        continue;
+      stats.pinned_slot_spans++;
+      stats.pinned_free_size += (info.slots - info.live_slots) * info.slot_size;
+      pinned_slot_spans.push_back({info.slot_span_start, info.live_slots,
+                                   info.slots, span.second.sample_count,
+                                   live_ratio,
+                                   span.second.oldest_sample->stack});
+    }
+    std::stable_sort(pinned_slot_spans.begin(), pinned_slot_spans.end(),
+                     [](const SlotSpanStats& a, const SlotSpanStats& b) {
+                       return a.live_ratio < b.live_ratio;
+                     });
+    if (pinned_slot_spans.size() > kMaxReportedPinnedSlotSpans)
+      pinned_slot_spans.resize(kMaxReportedPinnedSlotSpans);
+    stats.pinned_slot_span_samples = std::move(pinned_slot_spans);
+
+    result.push_back(std::move(stats));
+  }
+  return result;
+}
+
+const PartitionFragmentationProfiler::Partition*
+PartitionFragmentationProfiler::FindPartition(
+    ThreadSafePartitionRoot* root) const {
+  for (const Partition& partition : partitions_) {
+    if (partition.root == root)
+      return &partition;
+  }
+  return nullptr;
+}
+
+std::vector<PartitionFragmentationProfiler::Partition>
+PartitionFragmentationProfiler::GetPartitions() {
+  PoissonAllocationSampler::ScopedMuteThreadSamples no_samples_scope;
+  AutoLock lock(lock_);
+  return partitions_;
+}
+
+}  // namespace base
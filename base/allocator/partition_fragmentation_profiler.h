@@ -0,0 +1,154 @@
+// Copyright 2022 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#ifndef BASE_ALLOCATOR_PARTITION_FRAGMENTATION_PROFILER_H_
+#define BASE_ALLOCATOR_PARTITION_FRAGMENTATION_PROFILER_H_
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include <memory>
+#include <unordered_map>
+#include <vector>
+
+#include "base/allocator/partition_allocator/partition_alloc_forward.h"
+#include "base/base_export.h"
+#include "base/sampling_heap_profiler/poisson_allocation_sampler.h"
+#include "base/synchronization/lock.h"
+#include "base/thread_annotations.h"
+#include "base/tracing_buildflags.h"
+
+namespace base {
+
+// Finds out which allocation sizes and call sites drive the fragmentation of
+// the slot spans of PartitionAlloc, which per-bucket totals in
+// partition_stats.h don't show. Observes the samples of
+// PoissonAllocationSampler which come from the partitions given to
+// AddPartition(), and groups them by bucket. When the stats are collected,
+// each slot span holding a sample reports its live and freed slots. A span
+// whose live ratio is at most kPinnedSpanLiveRatio is "pinned": it can be
+// neither freed nor decommitted, although most of its slots are free, because
+// of a long-lived allocation, whose stack is reported.
+//
+// With tracing, the stats show up in memory-infra as
+// "partition_alloc/fragmentation/<partition>/bucket_<slot size>", which helps
+// tuning the size classes of a partition.
+class BASE_EXPORT PartitionFragmentationProfiler
+    : public PoissonAllocationSampler::SamplesObserver {
+ public:
+  static constexpr size_t kMaxStackFrames = 32;
+  static constexpr double kPinnedSpanLiveRatio = 0.25;
+  // Per bucket, the pinned slot spans with the lowest live ratio, and the
+  // most frequent requested sizes, which are reported.
+  static constexpr size_t kMaxReportedPinnedSlotSpans = 4;
+  static constexpr size_t kMaxReportedRequestedSizes = 8;
+
+  struct RequestedSizeStats {
+    size_t size = 0;
+    size_t sample_count = 0;
+  };
+
+  struct SlotSpanStats {
+    uintptr_t slot_span_start = 0;
+    size_t live_slots = 0;
+    size_t slots = 0;
+    size_t sample_count = 0;
+    // |live_slots| / |slots|, in [0, 1].
+    double live_ratio = 0;
+    // The stack of the oldest sample in the span, if it's pinned, which is the
+    // likeliest to keep it alive.
+    std::vector<const void*> pinning_stack;
+  };
+
+  struct BucketStats {
+    size_t slot_size = 0;
+    bool is_direct_mapped = false;
+    size_t sample_count = 0;
+    // The estimated size of the live allocations of the bucket, from the
+    // sampling weights.
+    size_t estimated_allocated_size = 0;
+    // The part of |estimated_allocated_size| which is lost to rounding the
+    // requested sizes up to |slot_size|.
+    size_t estimated_rounding_waste = 0;
+    // Sorted by decreasing sample count, at most kMaxReportedRequestedSizes.
+    std::vector<RequestedSizeStats> requested_sizes;
+    // The slot spans holding a sample.
+    size_t sampled_slot_spans = 0;
+    size_t live_slots = 0;
+    size_t slots = 0;
+    size_t pinned_slot_spans = 0;
+    // The free slots of the pinned slot spans, in bytes.
+    size_t pinned_free_size = 0;
+    // Sorted by increasing live ratio, at most kMaxReportedPinnedSlotSpans.
+    std::vector<SlotSpanStats> pinned_slot_span_samples;
+  };
+
+  static PartitionFragmentationProfiler* Get();
+
+  // Public for testing, use Get() otherwise.
+  PartitionFragmentationProfiler();
+  PartitionFragmentationProfiler(const PartitionFragmentationProfiler&) =
+      delete;
+  PartitionFragmentationProfiler& operator=(
+      const PartitionFragmentationProfiler&) = delete;
+  ~PartitionFragmentationProfiler() override;
+
+  // Profiles the samples from |root|, which must outlive the profiler. |name|
+  // must be a string literal, e.g. "fast_malloc".
+  void AddPartition(ThreadSafePartitionRoot* root, const char* name);
+
+  // Starts and stops observing the samples of PoissonAllocationSampler. The
+  // sampling interval is PoissonAllocationSampler's. Stop() drops the samples.
+  void Start();
+  void Stop();
+
+  // Computes the stats of the buckets of |root| which hold samples, sorted by
+  // slot size.
+  std::vector<BucketStats> GetBucketStats(ThreadSafePartitionRoot* root);
+
+  // PoissonAllocationSampler::SamplesObserver:
+  void SampleAdded(void* address,
+                   size_t size,
+                   size_t total,
+                   PoissonAllocationSampler::AllocatorType type,
+                   const char* context) override;
+  void SampleRemoved(void* address) override;
+
+ private:
+#if BUILDFLAG(ENABLE_BASE_TRACING)
+  class DumpProvider;
+#endif
+
+  struct Partition {
+    ThreadSafePartitionRoot* root;
+    const char* name;
+  };
+
+  struct Sample {
+    ThreadSafePartitionRoot* root;
+    size_t size;
+    size_t total;
+    uint64_t ordinal;
+    std::vector<const void*> stack;
+  };
+
+  // Returns the partition of |root|, or nullptr if it's not profiled.
+  const Partition* FindPartition(ThreadSafePartitionRoot* root) const
+      EXCLUSIVE_LOCKS_REQUIRED(lock_);
+  std::vector<Partition> GetPartitions();
+
+  Lock lock_;
+  bool running_ GUARDED_BY(lock_) = false;
+  std::vector<Partition> partitions_ GUARDED_BY(lock_);
+  std::unordered_map<void*, Sample> samples_ GUARDED_BY(lock_);
+  uint64_t last_sample_ordinal_ GUARDED_BY(lock_) = 0;
+
+#if BUILDFLAG(ENABLE_BASE_TRACING)
+  std::unique_ptr<DumpProvider> dump_provider_;
+#endif
+};
+
+}  // namespace base
+
+#endif  // BASE_ALLOCATOR_PARTITION_FRAGMENTATION_PROFILER_H_
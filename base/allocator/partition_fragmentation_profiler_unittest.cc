@@ -0,0 +1,170 @@
+// Copyright 2022 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "base/allocator/partition_fragmentation_profiler.h"
+
+#include <memory>
+#include <vector>
+
+#include "base/allocator/partition_allocator/partition_alloc.h"
+#include "base/allocator/partition_allocator/partition_root.h"
+#include "testing/gtest/include/gtest/gtest.h"
+
+// With *SAN, PartitionAlloc is replaced in partition_alloc.h by ASAN, so the
+// samples don't come from a partition.
+#if !defined(MEMORY_TOOL_REPLACES_ALLOCATOR)
+
+namespace base {
+
+namespace {
+
+using SlotSpan = ThreadSafePartitionRoot::SlotSpan;
+
+constexpr size_t kSize = 100;
+
+class PartitionFragmentationProfilerTest : public ::testing::Test {
+ protected:
+  void SetUp() override {
+    // Forbid extras, since they make finding out which bucket is used harder.
+    PartitionOptions opts(PartitionOptions::AlignedAlloc::kDisallowed,
+                          PartitionOptions::ThreadCache::kDisabled,
+                          PartitionOptions::Quarantine::kDisallowed,
+                          PartitionOptions::Cookie::kDisallowed,
+                          PartitionOptions::BackupRefPtr::kDisabled,
+                          PartitionOptions::UseConfigurablePool::kNo);
+    root_ = std::make_unique<ThreadSafePartitionRoot>(opts);
+    profiler_ = std::make_unique<PartitionFragmentationProfiler>();
+    profiler_->AddPartition(root_.get(), "test");
+  }
+
+  void TearDown() override {
+    profiler_.reset();
+    root_.reset();
+  }
+
+  void AddSample(void* address, size_t size) {
+    PoissonAllocationSampler::ScopedMuteThreadSamples no_samples_scope;
+    profiler_->SampleAdded(address, size, /*total=*/1000,
+                           PoissonAllocationSampler::kPartitionAlloc, nullptr);
+  }
+
+  void RemoveSample(void* address) {
+    PoissonAllocationSampler::ScopedMuteThreadSamples no_samples_scope;
+    profiler_->SampleRemoved(address);
+  }
+
+  // Fills a slot span with allocations of |size|.
+  std::vector<void*> FillSlotSpan(size_t size) {
+    std::vector<void*> ptrs = {root_->Alloc(size, "")};
+    SlotSpan* slot_span =
+        SlotSpan::FromAddr(reinterpret_cast<uintptr_t>(ptrs[0]));
+    while (ptrs.size() < slot_span->bucket->get_slots_per_span())
+      ptrs.push_back(root_->Alloc(size, ""));
+    return ptrs;
+  }
+
+  std::unique_ptr<ThreadSafePartitionRoot> root_;
+  std::unique_ptr<PartitionFragmentationProfiler> profiler_;
+};
+
+}  // namespace
+
+TEST_F(PartitionFragmentationProfilerTest, IgnoresOtherPartitions) {
+  PartitionOptions opts(PartitionOptions::AlignedAlloc::kDisallowed,
+                        PartitionOptions::ThreadCache::kDisabled,
+                        PartitionOptions::Quarantine::kDisallowed,
+                        PartitionOptions::Cookie::kDisallowed,
+                        PartitionOptions::BackupRefPtr::kDisabled,
+                        PartitionOptions::UseConfigurablePool::kNo);
+  ThreadSafePartitionRoot other_root(opts);
+  void* ptr = other_root.Alloc(kSize, "");
+  AddSample(ptr, kSize);
+  EXPECT_TRUE(profiler_->GetBucketStats(&other_root).empty());
+  EXPECT_TRUE(profiler_->GetBucketStats(root_.get()).empty());
+  other_root.Free(ptr);
+}
+
+TEST_F(PartitionFragmentationProfilerTest, FullSlotSpanIsNotPinned) {
+  std::vector<void*> ptrs = FillSlotSpan(kSize);
+  AddSample(ptrs[0], kSize);
+  AddSample(ptrs[1], kSize - 1);
+  AddSample(ptrs[2], kSize);
+
+  auto stats = profiler_->GetBucketStats(root_.get());
+  ASSERT_EQ(1u, stats.size());
+  const auto& bucket = stats[0];
+  SlotSpan* slot_span =
+      SlotSpan::FromAddr(reinterpret_cast<uintptr_t>(ptrs[0]));
+  EXPECT_EQ(slot_span->bucket->slot_size, bucket.slot_size);
+  EXPECT_FALSE(bucket.is_direct_mapped);
+  EXPECT_EQ(3u, bucket.sample_count);
+  EXPECT_EQ(3000u, bucket.estimated_allocated_size);
+  EXPECT_EQ(1u, bucket.sampled_slot_spans);
+  EXPECT_EQ(ptrs.size(), bucket.live_slots);
+  EXPECT_EQ(ptrs.size(), bucket.slots);
+  EXPECT_EQ(0u, bucket.pinned_slot_spans);
+  EXPECT_TRUE(bucket.pinned_slot_span_samples.empty());
+
+  // Sorted by decreasing sample count.
+  ASSERT_EQ(2u, bucket.requested_sizes.size());
+  EXPECT_EQ(kSize, bucket.requested_sizes[0].size);
+  EXPECT_EQ(2u, bucket.requested_sizes[0].sample_count);
+  EXPECT_EQ(kSize - 1, bucket.requested_sizes[1].size);
+  EXPECT_EQ(1u, bucket.requested_sizes[1].sample_count);
+
+  for (void* ptr : ptrs) {
+    RemoveSample(ptr);
+    root_->Free(ptr);
+  }
+  EXPECT_TRUE(profiler_->GetBucketStats(root_.get()).empty());
+}
+
+TEST_F(PartitionFragmentationProfilerTest, ReportsPinnedSlotSpan) {
+  std::vector<void*> ptrs = FillSlotSpan(kSize);
+  ASSERT_GT(ptrs.size(), 4u);
+  // Only the sampled allocation is left, and keeps the span alive.
+  for (size_t i = 1; i < ptrs.size(); i++)
+    root_->Free(ptrs[i]);
+  AddSample(ptrs[0], kSize);
+
+  auto stats = profiler_->GetBucketStats(root_.get());
+  ASSERT_EQ(1u, stats.size());
+  const auto& bucket = stats[0];
+  EXPECT_EQ(1u, bucket.sampled_slot_spans);
+  EXPECT_EQ(1u, bucket.live_slots);
+  EXPECT_EQ(ptrs.size(), bucket.slots);
+  EXPECT_EQ(1u, bucket.pinned_slot_spans);
+  EXPECT_EQ((ptrs.size() - 1) * bucket.slot_size, bucket.pinned_free_size);
+
+  ASSERT_EQ(1u, bucket.pinned_slot_span_samples.size());
+  const auto& slot_span = bucket.pinned_slot_span_samples[0];
+  EXPECT_EQ(SlotSpan::ToSlotSpanStart(
+                SlotSpan::FromAddr(reinterpret_cast<uintptr_t>(ptrs[0]))),
+            slot_span.slot_span_start);
+  EXPECT_EQ(1u, slot_span.live_slots);
+  EXPECT_EQ(1u, slot_span.sample_count);
+  EXPECT_DOUBLE_EQ(1. / ptrs.size(), slot_span.live_ratio);
+  EXPECT_LE(slot_span.pinning_stack.size(),
+            PartitionFragmentationProfiler::kMaxStackFrames);
+
+  RemoveSample(ptrs[0]);
+  root_->Free(ptrs[0]);
+}
+
+TEST_F(PartitionFragmentationProfilerTest, RoundingWaste) {
+  void* ptr = root_->Alloc(kSize, "");
+  AddSample(ptr, kSize);
+
+  auto stats = profiler_->GetBucketStats(root_.get());
+  ASSERT_EQ(1u, stats.size());
+  EXPECT_EQ(1000 / kSize * (stats[0].slot_size - kSize),
+            stats[0].estimated_rounding_waste);
+
+  RemoveSample(ptr);
+  root_->Free(ptr);
+}
+
+}  // namespace base
+
+#endif  // !defined(MEMORY_TOOL_REPLACES_ALLOCATOR)
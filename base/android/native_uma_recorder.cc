@@ -42,6 +42,7 @@ class HistogramCache {
       }
       case SPARSE_HISTOGRAM:
       case DUMMY_HISTOGRAM:
+      case QUANTILE_HISTOGRAM:
         break;
     }
     return params_str;
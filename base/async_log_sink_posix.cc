@@ -0,0 +1,263 @@
+// Copyright 2022 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "base/async_log_sink_posix.h"
+
+#include <inttypes.h>
+#include <limits.h>
+#include <stdio.h>
+#include <string.h>
+
+#include <algorithm>
+#include <memory>
+
+#include "base/bits.h"
+#include "base/check_op.h"
+#include "base/memory/ref_counted.h"
+#include "base/posix/eintr_wrapper.h"
+
+namespace logging {
+
+namespace {
+
+#if defined(IOV_MAX)
+constexpr size_t kMaxIovecs = IOV_MAX;
+#else
+constexpr size_t kMaxIovecs = 1024;
+#endif
+
+// Fits a few messages, including a stack trace.
+constexpr size_t kMinBufferSize = 16 * 1024;
+constexpr size_t kMaxBufferSize = 64 * 1024 * 1024;
+
+std::atomic<uint64_t> g_next_sink_id{1};
+
+AsyncLogSink::Options NormalizeOptions(AsyncLogSink::Options options) {
+  const size_t buffer_size =
+      std::clamp(options.buffer_size, kMinBufferSize, kMaxBufferSize);
+  options.buffer_size = size_t{1}
+                        << base::bits::Log2Ceiling(
+                               static_cast<uint32_t>(buffer_size));
+  return options;
+}
+
+// Set once the thread-local state of the current thread is destroyed, after
+// which the messages of the thread are written directly. Trivially
+// destructible, so that it can be read after the state is destroyed.
+thread_local bool g_tls_thread_exiting = false;
+
+// Writes |iovecs| to |fd|, as far as it can.
+void WriteFully(int fd, iovec* iovecs, size_t num_iovecs) {
+  while (num_iovecs) {
+    const ssize_t rv = HANDLE_EINTR(
+        writev(fd, iovecs, static_cast<int>(std::min(num_iovecs, kMaxIovecs))));
+    if (rv < 0) {
+      // Give up, nothing we can do now.
+      return;
+    }
+    size_t written = static_cast<size_t>(rv);
+    while (num_iovecs && written >= iovecs->iov_len) {
+      written -= iovecs->iov_len;
+      ++iovecs;
+      --num_iovecs;
+    }
+    if (written) {
+      iovecs->iov_base = static_cast<char*>(iovecs->iov_base) + written;
+      iovecs->iov_len -= written;
+    }
+  }
+}
+
+}  // namespace
+
+// A single-producer single-consumer ring of bytes, written by its thread and
+// read under the lock of the sink.
+class AsyncLogSink::ThreadBuffer
+    : public base::RefCountedThreadSafe<ThreadBuffer> {
+ public:
+  explicit ThreadBuffer(size_t capacity)
+      : capacity_(capacity), data_(new char[capacity]) {
+    DCHECK(base::bits::IsPowerOfTwo(capacity_));
+  }
+  ThreadBuffer(const ThreadBuffer&) = delete;
+  ThreadBuffer& operator=(const ThreadBuffer&) = delete;
+
+  // Returns false if |message| doesn't fit. Sets |became_half_full| if the
+  // buffer got half full.
+  bool Write(base::StringPiece message, bool* became_half_full) {
+    const size_t write = write_position_.load(std::memory_order_relaxed);
+    const size_t used = write - read_position_.load(std::memory_order_acquire);
+    if (message.size() > capacity_ - used)
+      return false;
+    const size_t offset = write & (capacity_ - 1);
+    const size_t first = std::min(message.size(), capacity_ - offset);
+    memcpy(data_.get() + offset, message.data(), first);
+    memcpy(data_.get(), message.data() + first, message.size() - first);
+    write_position_.store(write + message.size(), std::memory_order_release);
+    *became_half_full =
+        used < capacity_ / 2 && used + message.size() >= capacity_ / 2;
+    return true;
+  }
+
+  // Appends the pending bytes to |iovecs|, and returns the position to pass
+  // to Consume() once they are written.
+  size_t Peek(std::vector<iovec>* iovecs) const {
+    const size_t read = read_position_.load(std::memory_order_relaxed);
+    const size_t write = write_position_.load(std::memory_order_acquire);
+    const size_t size = write - read;
+    if (!size)
+      return write;
+    const size_t offset = read & (capacity_ - 1);
+    const size_t first = std::min(size, capacity_ - offset);
+    iovecs->push_back({data_.get() + offset, first});
+    if (size > first)
+      iovecs->push_back({data_.get(), size - first});
+    return write;
+  }
+
+  void Consume(size_t position) {
+    read_position_.store(position, std::memory_order_release);
+  }
+
+  bool IsEmpty() const {
+    return read_position_.load(std::memory_order_relaxed) ==
+           write_position_.load(std::memory_order_acquire);
+  }
+
+ private:
+  friend class base::RefCountedThreadSafe<ThreadBuffer>;
+  ~ThreadBuffer() = default;
+
+  const size_t capacity_;
+  const std::unique_ptr<char[]> data_;
+  // Only increase. The bytes in [read, write) are pending.
+  std::atomic<size_t> write_position_{0};
+  std::atomic<size_t> read_position_{0};
+};
+
+struct AsyncLogSink::ThreadState {
+  ~ThreadState() { g_tls_thread_exiting = true; }
+
+  uint64_t sink_id = 0;
+  // Shared with the sink, which releases it once it holds the only reference
+  // and drained it.
+  scoped_refptr<ThreadBuffer> buffer;
+};
+
+AsyncLogSink::AsyncLogSink(base::ScopedFD fd)
+    : AsyncLogSink(std::move(fd), Options()) {}
+
+AsyncLogSink::AsyncLogSink(base::ScopedFD fd, const Options& options)
+    : fd_(std::move(fd)),
+      options_(NormalizeOptions(options)),
+      id_(g_next_sink_id.fetch_add(1, std::memory_order_relaxed)),
+      wake_up_event_(base::WaitableEvent::ResetPolicy::AUTOMATIC,
+                     base::WaitableEvent::InitialState::NOT_SIGNALED) {
+  DCHECK(fd_.is_valid());
+  // Without a writer thread, the messages are written directly.
+  if (!base::PlatformThread::Create(0, this, &writer_thread_))
+    writer_thread_ = base::PlatformThreadHandle();
+}
+
+AsyncLogSink::~AsyncLogSink() {
+  if (!writer_thread_.is_null()) {
+    should_exit_.store(true, std::memory_order_release);
+    wake_up_event_.Signal();
+    base::PlatformThread::Join(writer_thread_);
+  }
+  Flush();
+}
+
+bool AsyncLogSink::Append(base::StringPiece message) {
+  if (writer_thread_.is_null())
+    return false;
+  ThreadBuffer* buffer = GetThreadBuffer();
+  if (!buffer)
+    return false;
+  bool became_half_full = false;
+  if (!buffer->Write(message, &became_half_full)) {
+    // The writer thread was woken up when the buffer got half full.
+    num_dropped_messages_.fetch_add(1, std::memory_order_relaxed);
+    return true;
+  }
+  if (became_half_full)
+    wake_up_event_.Signal();
+  return true;
+}
+
+void AsyncLogSink::Flush() {
+  base::AutoLock lock(lock_);
+  Drain();
+}
+
+// static
+AsyncLogSink::ThreadState& AsyncLogSink::GetThreadState() {
+  thread_local ThreadState state;
+  return state;
+}
+
+AsyncLogSink::ThreadBuffer* AsyncLogSink::GetThreadBuffer() {
+  if (g_tls_thread_exiting)
+    return nullptr;
+  ThreadState& state = GetThreadState();
+  if (state.sink_id != id_) {
+    // The buffer of another sink, if any, is released to it.
+    state.buffer = base::MakeRefCounted<ThreadBuffer>(options_.buffer_size);
+    state.sink_id = id_;
+    base::AutoLock lock(lock_);
+    buffers_.push_back(state.buffer);
+  }
+  return state.buffer.get();
+}
+
+void AsyncLogSink::Drain() {
+  // Reported first, though the messages were dropped after some of those
+  // pending.
+  char dropped_message[64];
+  const uint64_t num_dropped_messages =
+      num_dropped_messages_.load(std::memory_order_relaxed);
+  if (num_dropped_messages != num_reported_dropped_messages_) {
+    const int size = snprintf(
+        dropped_message, sizeof(dropped_message),
+        "[%" PRIu64 " log messages dropped]\n",
+        num_dropped_messages - num_reported_dropped_messages_);
+    iovecs_.push_back(
+        {dropped_message, std::min(static_cast<size_t>(size),
+                                   sizeof(dropped_message) - 1)});
+    num_reported_dropped_messages_ = num_dropped_messages;
+  }
+
+  for (const scoped_refptr<ThreadBuffer>& buffer : buffers_) {
+    pending_.emplace_back(buffer.get(), buffer->Peek(&iovecs_));
+    if (iovecs_.size() + 2 > kMaxIovecs)
+      WritePending();
+  }
+  WritePending();
+
+  // A thread which exited released its buffer, after its last write.
+  buffers_.erase(std::remove_if(buffers_.begin(), buffers_.end(),
+                                [](const scoped_refptr<ThreadBuffer>& buffer) {
+                                  return buffer->HasOneRef() &&
+                                         buffer->IsEmpty();
+                                }),
+                 buffers_.end());
+}
+
+void AsyncLogSink::WritePending() {
+  WriteFully(fd_.get(), iovecs_.data(), iovecs_.size());
+  for (const auto& pending : pending_)
+    pending.first->Consume(pending.second);
+  iovecs_.clear();
+  pending_.clear();
+}
+
+void AsyncLogSink::ThreadMain() {
+  base::PlatformThread::SetName("AsyncLogWriter");
+  while (!should_exit_.load(std::memory_order_acquire)) {
+    wake_up_event_.TimedWait(options_.flush_interval);
+    Flush();
+  }
+}
+
+}  // namespace logging
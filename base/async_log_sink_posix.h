@@ -0,0 +1,119 @@
+// Copyright 2022 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#ifndef BASE_ASYNC_LOG_SINK_POSIX_H_
+#define BASE_ASYNC_LOG_SINK_POSIX_H_
+
+#include <stddef.h>
+#include <stdint.h>
+#include <sys/uio.h>
+
+#include <atomic>
+#include <utility>
+#include <vector>
+
+#include "base/base_export.h"
+#include "base/files/scoped_file.h"
+#include "base/memory/scoped_refptr.h"
+#include "base/strings/string_piece.h"
+#include "base/synchronization/lock.h"
+#include "base/synchronization/waitable_event.h"
+#include "base/thread_annotations.h"
+#include "base/threading/platform_thread.h"
+#include "base/time/time.h"
+
+namespace logging {
+
+// Writes the log messages to a file on a background thread, so that the
+// logging threads neither contend on a lock nor wait on the disk. Each thread
+// appends its messages to a ring buffer of its own, without a lock or a system
+// call, which the writer thread drains with a single writev() for all the
+// threads, every |flush_interval|, or once a buffer is half full.
+//
+// The memory is bounded: a message which doesn't fit in its buffer is dropped,
+// and the number of dropped messages is written in their stead. The messages
+// of a thread stay in order, but those of different threads written in the
+// same batch are grouped by thread. Flush() writes the messages appended so
+// far on the calling thread, e.g. before a LOG(FATAL) is written directly.
+//
+// LoggingSettings::async_file_writes enables one for the log file.
+class BASE_EXPORT AsyncLogSink : public base::PlatformThread::Delegate {
+ public:
+  struct Options {
+    // The size of the buffer of each thread, rounded up to a power of two,
+    // within [16 KiB, 64 MiB].
+    size_t buffer_size = 64 * 1024;
+    base::TimeDelta flush_interval = base::Milliseconds(100);
+  };
+
+  // Writes to |fd|, which it owns, and starts the writer thread.
+  explicit AsyncLogSink(base::ScopedFD fd);
+  AsyncLogSink(base::ScopedFD fd, const Options& options);
+  AsyncLogSink(const AsyncLogSink&) = delete;
+  AsyncLogSink& operator=(const AsyncLogSink&) = delete;
+  // Writes the pending messages and joins the writer thread. No thread may
+  // append meanwhile.
+  ~AsyncLogSink() override;
+
+  // Appends |message| to the buffer of the current thread. Returns false if
+  // the thread is exiting, in which case the caller should write |message|
+  // itself. A message which doesn't fit is dropped, and true returned.
+  bool Append(base::StringPiece message);
+
+  // Writes the messages appended so far, on the calling thread.
+  void Flush();
+
+  // The number of messages dropped so far.
+  uint64_t num_dropped_messages() const {
+    return num_dropped_messages_.load(std::memory_order_relaxed);
+  }
+
+ private:
+  class ThreadBuffer;
+  struct ThreadState;
+
+  // Returns the state of the current thread.
+  static ThreadState& GetThreadState();
+
+  // Returns the buffer of the current thread for this sink, registering it if
+  // needed, or nullptr if the thread is exiting.
+  ThreadBuffer* GetThreadBuffer();
+
+  // Writes the pending messages of all the threads, and releases the buffers
+  // of the threads which exited.
+  void Drain() EXCLUSIVE_LOCKS_REQUIRED(lock_);
+  void WritePending() EXCLUSIVE_LOCKS_REQUIRED(lock_);
+
+  // PlatformThread::Delegate:
+  void ThreadMain() override;
+
+  const base::ScopedFD fd_;
+  const Options options_;
+  // Distinguishes the sinks in the state of the threads, since a sink can be
+  // allocated where a destroyed one was.
+  const uint64_t id_;
+
+  std::atomic<uint64_t> num_dropped_messages_{0};
+
+  // Guards the list of buffers, and is held by the thread which drains them,
+  // their only reader. The logging threads only take it to register their
+  // buffer.
+  base::Lock lock_;
+  std::vector<scoped_refptr<ThreadBuffer>> buffers_ GUARDED_BY(lock_);
+  // The dropped messages already reported.
+  uint64_t num_reported_dropped_messages_ GUARDED_BY(lock_) = 0;
+  // The batch being written, and the position each of its buffers is drained
+  // up to once written.
+  std::vector<iovec> iovecs_ GUARDED_BY(lock_);
+  std::vector<std::pair<ThreadBuffer*, size_t>> pending_ GUARDED_BY(lock_);
+
+  // Signaled when a buffer gets half full, or the sink is destroyed.
+  base::WaitableEvent wake_up_event_;
+  std::atomic<bool> should_exit_{false};
+  base::PlatformThreadHandle writer_thread_;
+};
+
+}  // namespace logging
+
+#endif  // BASE_ASYNC_LOG_SINK_POSIX_H_
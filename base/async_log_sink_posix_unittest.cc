@@ -0,0 +1,121 @@
+// Copyright 2022 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "base/async_log_sink_posix.h"
+
+#include <fcntl.h>
+
+#include <string>
+#include <vector>
+
+#include "base/files/file_path.h"
+#include "base/files/file_util.h"
+#include "base/files/scoped_temp_dir.h"
+#include "base/strings/string_number_conversions.h"
+#include "base/strings/string_split.h"
+#include "base/threading/simple_thread.h"
+#include "testing/gtest/include/gtest/gtest.h"
+
+namespace logging {
+
+namespace {
+
+class AsyncLogSinkTest : public testing::Test {
+ protected:
+  void SetUp() override {
+    ASSERT_TRUE(temp_dir_.CreateUniqueTempDir());
+    path_ = temp_dir_.GetPath().Append("file.log");
+  }
+
+  std::unique_ptr<AsyncLogSink> CreateSink(
+      const AsyncLogSink::Options& options = AsyncLogSink::Options()) {
+    base::ScopedFD fd(open(path_.value().c_str(),
+                           O_WRONLY | O_CREAT | O_APPEND | O_CLOEXEC, 0600));
+    EXPECT_TRUE(fd.is_valid());
+    return std::make_unique<AsyncLogSink>(std::move(fd), options);
+  }
+
+  std::vector<std::string> ReadLines() {
+    std::string contents;
+    EXPECT_TRUE(base::ReadFileToString(path_, &contents));
+    return base::SplitString(contents, "\n", base::KEEP_WHITESPACE,
+                             base::SPLIT_WANT_NONEMPTY);
+  }
+
+  base::ScopedTempDir temp_dir_;
+  base::FilePath path_;
+};
+
+class AppendThread : public base::SimpleThread {
+ public:
+  AppendThread(AsyncLogSink* sink, const std::string& prefix, int count)
+      : SimpleThread(prefix), sink_(sink), prefix_(prefix), count_(count) {}
+
+  void Run() override {
+    for (int i = 0; i < count_; ++i)
+      EXPECT_TRUE(sink_->Append(prefix_ + base::NumberToString(i) + "\n"));
+  }
+
+ private:
+  AsyncLogSink* const sink_;
+  const std::string prefix_;
+  const int count_;
+};
+
+}  // namespace
+
+TEST_F(AsyncLogSinkTest, Flush) {
+  std::unique_ptr<AsyncLogSink> sink = CreateSink();
+  ASSERT_TRUE(sink->Append("a\n"));
+  ASSERT_TRUE(sink->Append("b\n"));
+  sink->Flush();
+  EXPECT_EQ(ReadLines(), std::vector<std::string>({"a", "b"}));
+}
+
+TEST_F(AsyncLogSinkTest, ThreadsStayInOrder) {
+  constexpr int kMessagesPerThread = 1000;
+  std::unique_ptr<AsyncLogSink> sink = CreateSink();
+  AppendThread thread_a(sink.get(), "a", kMessagesPerThread);
+  AppendThread thread_b(sink.get(), "b", kMessagesPerThread);
+  thread_a.Start();
+  thread_b.Start();
+  thread_a.Join();
+  thread_b.Join();
+
+  // The messages of the threads which exited are still written.
+  sink.reset();
+  std::vector<std::string> lines = ReadLines();
+  ASSERT_EQ(lines.size(), 2u * kMessagesPerThread);
+  int next_a = 0;
+  int next_b = 0;
+  for (const std::string& line : lines) {
+    int& next = line[0] == 'a' ? next_a : next_b;
+    EXPECT_EQ(line.substr(1), base::NumberToString(next));
+    ++next;
+  }
+}
+
+TEST_F(AsyncLogSinkTest, DropsWhatDoesNotFit) {
+  AsyncLogSink::Options options;
+  options.buffer_size = 16 * 1024;
+  std::unique_ptr<AsyncLogSink> sink = CreateSink(options);
+  ASSERT_TRUE(sink->Append(std::string(32 * 1024, 'x') + "\n"));
+  ASSERT_TRUE(sink->Append("a\n"));
+  EXPECT_EQ(sink->num_dropped_messages(), 1u);
+  sink->Flush();
+  EXPECT_EQ(ReadLines(),
+            std::vector<std::string>({"[1 log messages dropped]", "a"}));
+}
+
+TEST_F(AsyncLogSinkTest, WritesInTheBackground) {
+  AsyncLogSink::Options options;
+  options.flush_interval = base::Milliseconds(1);
+  std::unique_ptr<AsyncLogSink> sink = CreateSink(options);
+  ASSERT_TRUE(sink->Append("a\n"));
+  while (ReadLines().empty())
+    base::PlatformThread::Sleep(base::Milliseconds(1));
+  EXPECT_EQ(ReadLines(), std::vector<std::string>({"a"}));
+}
+
+}  // namespace logging
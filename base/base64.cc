@@ -6,19 +6,18 @@
 
 #include <stddef.h>
 
-#include "third_party/modp_b64/modp_b64.h"
+#include "base/base64_internal.h"
+#include "base/check_op.h"
 
 namespace base {
 
+using internal::Base64Alphabet;
+using internal::Base64Padding;
+
 std::string Base64Encode(span<const uint8_t> input) {
   std::string output;
-  output.resize(modp_b64_encode_len(input.size()));  // makes room for null byte
-
-  // modp_b64_encode_len() returns at least 1, so output[0] is safe to use.
-  const size_t output_size = modp_b64_encode(
-      &(output[0]), reinterpret_cast<const char*>(input.data()), input.size());
-
-  output.resize(output_size);
+  output.resize(Base64EncodedSize(input.size()));
+  Base64Encode(input, make_span(&output[0], output.size()));
   return output;
 }
 
@@ -26,32 +25,42 @@ void Base64Encode(StringPiece input, std::string* output) {
   *output = Base64Encode(base::as_bytes(base::make_span(input)));
 }
 
+size_t Base64Encode(span<const uint8_t> input, span<char> output) {
+  CHECK_GE(output.size(), Base64EncodedSize(input.size()));
+  return internal::Base64EncodeInternal(input, Base64Alphabet::kStandard,
+                                        /*pad=*/true, output.data());
+}
+
 bool Base64Decode(StringPiece input, std::string* output) {
+  // Decodes into a temporary, so that |output| is left alone on failure and
+  // may be |input|.
   std::string temp;
-  temp.resize(modp_b64_decode_len(input.size()));
-
-  // does not null terminate result since result is binary data!
-  size_t input_size = input.size();
-  size_t output_size = modp_b64_decode(&(temp[0]), input.data(), input_size);
-  if (output_size == MODP_B64_ERROR)
+  temp.resize(Base64DecodedMaxSize(input.size()));
+  const absl::optional<size_t> output_size = Base64Decode(
+      input, as_writable_bytes(make_span(&temp[0], temp.size())));
+  if (!output_size)
     return false;
 
-  temp.resize(output_size);
+  temp.resize(*output_size);
   output->swap(temp);
   return true;
 }
 
 absl::optional<std::vector<uint8_t>> Base64Decode(StringPiece input) {
-  std::vector<uint8_t> ret(modp_b64_decode_len(input.size()));
-
-  size_t input_size = input.size();
-  size_t output_size = modp_b64_decode(reinterpret_cast<char*>(ret.data()),
-                                       input.data(), input_size);
-  if (output_size == MODP_B64_ERROR)
+  std::vector<uint8_t> ret(Base64DecodedMaxSize(input.size()));
+  const absl::optional<size_t> output_size = Base64Decode(input, ret);
+  if (!output_size)
     return absl::nullopt;
 
-  ret.resize(output_size);
+  ret.resize(*output_size);
   return ret;
 }
 
+absl::optional<size_t> Base64Decode(StringPiece input, span<uint8_t> output) {
+  CHECK_GE(output.size(), Base64DecodedMaxSize(input.size()));
+  return internal::Base64DecodeInternal(input, Base64Alphabet::kStandard,
+                                        Base64Padding::kRequired,
+                                        output.data());
+}
+
 }  // namespace base
@@ -5,6 +5,7 @@
 #ifndef BASE_BASE64_H_
 #define BASE_BASE64_H_
 
+#include <stddef.h>
 #include <stdint.h>
 
 #include <string>
@@ -17,12 +18,28 @@
 
 namespace base {
 
+// The size of the base64 encoding of |input_size| bytes, padding included.
+constexpr size_t Base64EncodedSize(size_t input_size) {
+  return (input_size + 2) / 3 * 4;
+}
+
+// The most bytes |input_size| characters of base64 can decode to.
+constexpr size_t Base64DecodedMaxSize(size_t input_size) {
+  return (input_size + 3) / 4 * 3;
+}
+
 // Encodes the input binary data in base64.
 BASE_EXPORT std::string Base64Encode(span<const uint8_t> input);
 
 // Encodes the input string in base64.
 BASE_EXPORT void Base64Encode(StringPiece input, std::string* output);
 
+// Encodes the input binary data in base64 into |output|, which must have room
+// for Base64EncodedSize(input.size()) characters. Returns the count of
+// characters written, which is that size. |input| and |output| must not
+// overlap.
+BASE_EXPORT size_t Base64Encode(span<const uint8_t> input, span<char> output);
+
 // Decodes the base64 input string.  Returns true if successful and false
 // otherwise. The output string is only modified if successful. The decoding can
 // be done in-place.
@@ -32,6 +49,14 @@ BASE_EXPORT bool Base64Decode(StringPiece input, std::string* output);
 BASE_EXPORT absl::optional<std::vector<uint8_t>> Base64Decode(
     StringPiece input);
 
+// Decodes the base64 input string into |output|, which must have room for
+// Base64DecodedMaxSize(input.size()) bytes. Returns the count of bytes written,
+// or `absl::nullopt` if unsuccessful, in which case |output| may have been
+// written. |input| and |output| must not overlap.
+[[nodiscard]] BASE_EXPORT absl::optional<size_t> Base64Decode(
+    StringPiece input,
+    span<uint8_t> output);
+
 }  // namespace base
 
 #endif  // BASE_BASE64_H_
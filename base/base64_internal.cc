@@ -0,0 +1,610 @@
+// Copyright 2022 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "base/base64_internal.h"
+
+#include <array>
+
+#include "base/check_op.h"
+#include "base/compiler_specific.h"
+#include "build/build_config.h"
+
+#if defined(ARCH_CPU_X86_64)
+#include "base/cpu.h"
+// Including these headers directly should generally be avoided. The SSSE3
+// and AVX2 functions are only used if the CPU supports them at runtime, see
+// GetBase64Functions().
+// clang-format off
+#include <immintrin.h>
+// clang-format on
+#elif defined(ARCH_CPU_ARM64)
+#include <arm_neon.h>
+#endif
+
+namespace base {
+namespace internal {
+
+namespace {
+
+constexpr char kStandardAlphabet[] =
+    "ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789+/";
+constexpr char kUrlAlphabet[] =
+    "ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789-_";
+
+constexpr char kPaddingChar = '=';
+
+const char* GetAlphabet(Base64Alphabet alphabet) {
+  return alphabet == Base64Alphabet::kStandard ? kStandardAlphabet
+                                               : kUrlAlphabet;
+}
+
+// The bit which the decode tables set for the characters out of the alphabet,
+// above the 24 bits of a group.
+constexpr uint32_t kInvalidBit = 1u << 24;
+
+// The values of the characters of |alphabet| at each of the 4 positions of a
+// group, shifted to their bits of its 24, as modp_b64 has them, so that a
+// group is the OR of its characters' entries.
+using DecodeTables = std::array<std::array<uint32_t, 256>, 4>;
+
+constexpr DecodeTables MakeDecodeTables(const char* alphabet) {
+  DecodeTables tables = {};
+  for (size_t position = 0; position < 4; ++position) {
+    for (size_t c = 0; c < 256; ++c)
+      tables[position][c] = kInvalidBit;
+    for (uint32_t value = 0; value < 64; ++value) {
+      tables[position][static_cast<uint8_t>(alphabet[value])] =
+          value << (18 - 6 * position);
+    }
+  }
+  return tables;
+}
+
+constexpr DecodeTables kStandardDecodeTables =
+    MakeDecodeTables(kStandardAlphabet);
+constexpr DecodeTables kUrlDecodeTables = MakeDecodeTables(kUrlAlphabet);
+
+using EncodeFunction = size_t (*)(const uint8_t* input,
+                                  size_t size,
+                                  char* output,
+                                  Base64Alphabet alphabet);
+using DecodeFunction = size_t (*)(const char* input,
+                                  size_t size,
+                                  uint8_t* output,
+                                  Base64Alphabet alphabet);
+
+struct Base64Functions {
+  EncodeFunction encode;
+  DecodeFunction decode;
+};
+
+#if defined(ARCH_CPU_X86_64)
+
+// The kernels encode 12 bytes into 16 characters per 128-bit lane, and decode
+// them back, as Wojciech Muła describes in "Base64 encoding with SIMD
+// instructions" and "Base64 decoding with SIMD instructions".
+
+size_t EncodeBlocksUnvectorized(const uint8_t* input,
+                                size_t size,
+                                char* output,
+                                Base64Alphabet alphabet) {
+  return 0;
+}
+
+size_t DecodeBlocksUnvectorized(const char* input,
+                                size_t size,
+                                uint8_t* output,
+                                Base64Alphabet alphabet) {
+  return 0;
+}
+
+// The offsets from the 6-bit values to their characters, which
+// ValuesToChars*() index by the range of the values.
+constexpr int8_t kDigitOffset = '0' - 52;
+alignas(16) constexpr int8_t kStandardEncodeOffsets[16] = {
+    'a' - 26,     kDigitOffset, kDigitOffset, kDigitOffset,
+    kDigitOffset, kDigitOffset, kDigitOffset, kDigitOffset,
+    kDigitOffset, kDigitOffset, kDigitOffset, '+' - 62,
+    '/' - 63,     'A',          0,            0};
+alignas(16) constexpr int8_t kUrlEncodeOffsets[16] = {
+    'a' - 26,     kDigitOffset, kDigitOffset, kDigitOffset,
+    kDigitOffset, kDigitOffset, kDigitOffset, kDigitOffset,
+    kDigitOffset, kDigitOffset, kDigitOffset, '-' - 62,
+    '_' - 63,     'A',          0,            0};
+
+ALWAYS_INLINE __m128i GetEncodeOffsets(Base64Alphabet alphabet) {
+  return _mm_load_si128(reinterpret_cast<const __m128i*>(
+      alphabet == Base64Alphabet::kStandard ? kStandardEncodeOffsets
+                                            : kUrlEncodeOffsets));
+}
+
+// The helpers are always inlined into the kernels, so that they have their
+// targets, and the AVX2 kernels don't switch to SSE instructions.
+
+// Spreads the four 6-bit groups of each 3 bytes of |bytes| into 4 bytes.
+__attribute__((target("ssse3"))) ALWAYS_INLINE __m128i
+SplitSixBitsSSSE3(__m128i bytes) {
+  // Each 32-bit lane gets the bytes b, a, c, b of its 3 bytes a, b and c.
+  bytes = _mm_shuffle_epi8(bytes, _mm_setr_epi8(1, 0, 2, 1, 4, 3, 5, 4, 7, 6,
+                                                8, 7, 10, 9, 11, 10));
+  // Moves the first and third groups to the low bits of their 16-bit halves
+  // with high multiplications, and the second and fourth to the high byte.
+  const __m128i first_and_third =
+      _mm_mulhi_epu16(_mm_and_si128(bytes, _mm_set1_epi32(0x0FC0FC00)),
+                      _mm_set1_epi32(0x04000040));
+  const __m128i second_and_fourth =
+      _mm_mullo_epi16(_mm_and_si128(bytes, _mm_set1_epi32(0x003F03F0)),
+                      _mm_set1_epi32(0x01000010));
+  return _mm_or_si128(first_and_third, second_and_fourth);
+}
+
+__attribute__((target("ssse3"))) ALWAYS_INLINE __m128i
+ValuesToCharsSSSE3(__m128i values, __m128i offsets) {
+  // 0 for the values up to 51, 1 to 10 for the digits, 11 and 12 for the two
+  // last values, and 13 for the uppercase letters.
+  __m128i range = _mm_subs_epu8(values, _mm_set1_epi8(51));
+  range = _mm_or_si128(
+      range, _mm_and_si128(_mm_cmpgt_epi8(_mm_set1_epi8(26), values),
+                           _mm_set1_epi8(13)));
+  return _mm_add_epi8(values, _mm_shuffle_epi8(offsets, range));
+}
+
+ALWAYS_INLINE __m128i InRangeSSE2(__m128i chars, char first, char last) {
+  // The bytes from 0x80 are negative, out of all the ranges.
+  return _mm_and_si128(_mm_cmpgt_epi8(chars, _mm_set1_epi8(first - 1)),
+                       _mm_cmplt_epi8(chars, _mm_set1_epi8(last + 1)));
+}
+
+// Returns the 6-bit values of |chars|, and sets the bytes of |valid| for the
+// characters of the alphabet, whose last two characters are |char62| and
+// |char63|.
+ALWAYS_INLINE __m128i CharsToValuesSSE2(__m128i chars,
+                                        char char62,
+                                        char char63,
+                                        __m128i& valid) {
+  const __m128i upper = InRangeSSE2(chars, 'A', 'Z');
+  const __m128i lower = InRangeSSE2(chars, 'a', 'z');
+  const __m128i digit = InRangeSSE2(chars, '0', '9');
+  const __m128i is_char62 = _mm_cmpeq_epi8(chars, _mm_set1_epi8(char62));
+  const __m128i is_char63 = _mm_cmpeq_epi8(chars, _mm_set1_epi8(char63));
+  valid = _mm_or_si128(_mm_or_si128(_mm_or_si128(upper, lower), digit),
+                       _mm_or_si128(is_char62, is_char63));
+  __m128i offsets = _mm_and_si128(upper, _mm_set1_epi8(-'A'));
+  offsets = _mm_or_si128(offsets,
+                         _mm_and_si128(lower, _mm_set1_epi8(26 - 'a')));
+  offsets = _mm_or_si128(offsets,
+                         _mm_and_si128(digit, _mm_set1_epi8(52 - '0')));
+  offsets = _mm_or_si128(
+      offsets, _mm_and_si128(is_char62, _mm_set1_epi8(62 - char62)));
+  offsets = _mm_or_si128(
+      offsets, _mm_and_si128(is_char63, _mm_set1_epi8(63 - char63)));
+  return _mm_add_epi8(chars, offsets);
+}
+
+// Packs the 6-bit |values| of each 4 bytes into 3 bytes, in the 12 low bytes.
+__attribute__((target("ssse3"))) ALWAYS_INLINE __m128i
+PackSixBitsSSSE3(__m128i values) {
+  // The pairs of values into 12 bits, and their pairs into 24 bits.
+  const __m128i pairs =
+      _mm_maddubs_epi16(values, _mm_set1_epi32(0x01400140));
+  const __m128i triples = _mm_madd_epi16(pairs, _mm_set1_epi32(0x00011000));
+  return _mm_shuffle_epi8(triples, _mm_setr_epi8(2, 1, 0, 6, 5, 4, 10, 9, 8,
+                                                 14, 13, 12, -1, -1, -1, -1));
+}
+
+// The 128-bit loops, which the AVX2 kernels finish with.
+__attribute__((target("ssse3"))) ALWAYS_INLINE size_t
+EncodeBlocks128(const uint8_t* input,
+                size_t size,
+                size_t i,
+                char* output,
+                Base64Alphabet alphabet) {
+  const __m128i offsets = GetEncodeOffsets(alphabet);
+  // Reads 16 bytes to encode 12.
+  for (; i + 16 <= size; i += 12) {
+    const __m128i bytes =
+        _mm_loadu_si128(reinterpret_cast<const __m128i*>(input + i));
+    _mm_storeu_si128(reinterpret_cast<__m128i*>(output + i / 3 * 4),
+                     ValuesToCharsSSSE3(SplitSixBitsSSSE3(bytes), offsets));
+  }
+  return i;
+}
+
+__attribute__((target("ssse3"))) ALWAYS_INLINE size_t
+DecodeBlocks128(const char* input,
+                size_t size,
+                size_t i,
+                uint8_t* output,
+                Base64Alphabet alphabet) {
+  const char char62 = GetAlphabet(alphabet)[62];
+  const char char63 = GetAlphabet(alphabet)[63];
+  // Writes 16 bytes to decode 12, so stops 16 - 12 bytes early.
+  for (; i + 16 + 8 <= size; i += 16) {
+    __m128i valid;
+    const __m128i values = CharsToValuesSSE2(
+        _mm_loadu_si128(reinterpret_cast<const __m128i*>(input + i)), char62,
+        char63, valid);
+    if (_mm_movemask_epi8(valid) != 0xFFFF)
+      break;
+    _mm_storeu_si128(reinterpret_cast<__m128i*>(output + i / 4 * 3),
+                     PackSixBitsSSSE3(values));
+  }
+  return i;
+}
+
+__attribute__((target("ssse3"))) size_t EncodeBlocksSSSE3(
+    const uint8_t* input,
+    size_t size,
+    char* output,
+    Base64Alphabet alphabet) {
+  return EncodeBlocks128(input, size, 0, output, alphabet);
+}
+
+__attribute__((target("ssse3"))) size_t DecodeBlocksSSSE3(
+    const char* input,
+    size_t size,
+    uint8_t* output,
+    Base64Alphabet alphabet) {
+  return DecodeBlocks128(input, size, 0, output, alphabet);
+}
+
+__attribute__((target("avx2"))) ALWAYS_INLINE __m256i
+SplitSixBitsAVX2(__m256i bytes) {
+  const __m256i shuffle = _mm256_setr_epi8(
+      1, 0, 2, 1, 4, 3, 5, 4, 7, 6, 8, 7, 10, 9, 11, 10, 1, 0, 2, 1, 4, 3, 5, 4,
+      7, 6, 8, 7, 10, 9, 11, 10);
+  bytes = _mm256_shuffle_epi8(bytes, shuffle);
+  const __m256i first_and_third = _mm256_mulhi_epu16(
+      _mm256_and_si256(bytes, _mm256_set1_epi32(0x0FC0FC00)),
+      _mm256_set1_epi32(0x04000040));
+  const __m256i second_and_fourth = _mm256_mullo_epi16(
+      _mm256_and_si256(bytes, _mm256_set1_epi32(0x003F03F0)),
+      _mm256_set1_epi32(0x01000010));
+  return _mm256_or_si256(first_and_third, second_and_fourth);
+}
+
+__attribute__((target("avx2"))) ALWAYS_INLINE __m256i
+ValuesToCharsAVX2(__m256i values, __m256i offsets) {
+  __m256i range = _mm256_subs_epu8(values, _mm256_set1_epi8(51));
+  range = _mm256_or_si256(
+      range, _mm256_and_si256(_mm256_cmpgt_epi8(_mm256_set1_epi8(26), values),
+                              _mm256_set1_epi8(13)));
+  return _mm256_add_epi8(values, _mm256_shuffle_epi8(offsets, range));
+}
+
+__attribute__((target("avx2"))) ALWAYS_INLINE __m256i
+InRangeAVX2(__m256i chars, char first, char last) {
+  return _mm256_and_si256(
+      _mm256_cmpgt_epi8(chars, _mm256_set1_epi8(first - 1)),
+      _mm256_cmpgt_epi8(_mm256_set1_epi8(last + 1), chars));
+}
+
+__attribute__((target("avx2"))) ALWAYS_INLINE __m256i
+CharsToValuesAVX2(__m256i chars, char char62, char char63, __m256i& valid) {
+  const __m256i upper = InRangeAVX2(chars, 'A', 'Z');
+  const __m256i lower = InRangeAVX2(chars, 'a', 'z');
+  const __m256i digit = InRangeAVX2(chars, '0', '9');
+  const __m256i is_char62 = _mm256_cmpeq_epi8(chars, _mm256_set1_epi8(char62));
+  const __m256i is_char63 = _mm256_cmpeq_epi8(chars, _mm256_set1_epi8(char63));
+  valid =
+      _mm256_or_si256(_mm256_or_si256(_mm256_or_si256(upper, lower), digit),
+                      _mm256_or_si256(is_char62, is_char63));
+  __m256i offsets = _mm256_and_si256(upper, _mm256_set1_epi8(-'A'));
+  offsets = _mm256_or_si256(
+      offsets, _mm256_and_si256(lower, _mm256_set1_epi8(26 - 'a')));
+  offsets = _mm256_or_si256(
+      offsets, _mm256_and_si256(digit, _mm256_set1_epi8(52 - '0')));
+  offsets = _mm256_or_si256(
+      offsets, _mm256_and_si256(is_char62, _mm256_set1_epi8(62 - char62)));
+  offsets = _mm256_or_si256(
+      offsets, _mm256_and_si256(is_char63, _mm256_set1_epi8(63 - char63)));
+  return _mm256_add_epi8(chars, offsets);
+}
+
+__attribute__((target("avx2"))) ALWAYS_INLINE __m256i
+PackSixBitsAVX2(__m256i values) {
+  const __m256i pairs =
+      _mm256_maddubs_epi16(values, _mm256_set1_epi32(0x01400140));
+  const __m256i triples =
+      _mm256_madd_epi16(pairs, _mm256_set1_epi32(0x00011000));
+  return _mm256_shuffle_epi8(
+      triples, _mm256_setr_epi8(2, 1, 0, 6, 5, 4, 10, 9, 8, 14, 13, 12, -1, -1,
+                                -1, -1, 2, 1, 0, 6, 5, 4, 10, 9, 8, 14, 13, 12,
+                                -1, -1, -1, -1));
+}
+
+__attribute__((target("avx2"))) size_t EncodeBlocksAVX2(
+    const uint8_t* input,
+    size_t size,
+    char* output,
+    Base64Alphabet alphabet) {
+  const __m256i offsets =
+      _mm256_broadcastsi128_si256(GetEncodeOffsets(alphabet));
+  size_t i = 0;
+  // Each lane reads 16 bytes to encode 12.
+  for (; i + 12 + 16 <= size; i += 24) {
+    const __m256i bytes = _mm256_inserti128_si256(
+        _mm256_castsi128_si256(
+            _mm_loadu_si128(reinterpret_cast<const __m128i*>(input + i))),
+        _mm_loadu_si128(reinterpret_cast<const __m128i*>(input + i + 12)), 1);
+    _mm256_storeu_si256(reinterpret_cast<__m256i*>(output + i / 3 * 4),
+                        ValuesToCharsAVX2(SplitSixBitsAVX2(bytes), offsets));
+  }
+  return EncodeBlocks128(input, size, i, output, alphabet);
+}
+
+__attribute__((target("avx2"))) size_t DecodeBlocksAVX2(
+    const char* input,
+    size_t size,
+    uint8_t* output,
+    Base64Alphabet alphabet) {
+  const char char62 = GetAlphabet(alphabet)[62];
+  const char char63 = GetAlphabet(alphabet)[63];
+  size_t i = 0;
+  // The second lane writes 16 bytes from the 12th to decode 12.
+  for (; i + 32 + 8 <= size; i += 32) {
+    __m256i valid;
+    const __m256i values = CharsToValuesAVX2(
+        _mm256_loadu_si256(reinterpret_cast<const __m256i*>(input + i)),
+        char62, char63, valid);
+    if (_mm256_movemask_epi8(valid) != -1)
+      break;
+    const __m256i bytes = PackSixBitsAVX2(values);
+    uint8_t* out = output + i / 4 * 3;
+    _mm_storeu_si128(reinterpret_cast<__m128i*>(out),
+                     _mm256_castsi256_si128(bytes));
+    _mm_storeu_si128(reinterpret_cast<__m128i*>(out + 12),
+                     _mm256_extracti128_si256(bytes, 1));
+  }
+  return DecodeBlocks128(input, size, i, output, alphabet);
+}
+
+const Base64Functions& GetBase64Functions() {
+  static const Base64Functions functions = []() -> Base64Functions {
+    const CPU cpu;
+    if (cpu.has_avx2())
+      return {&EncodeBlocksAVX2, &DecodeBlocksAVX2};
+    if (cpu.has_ssse3())
+      return {&EncodeBlocksSSSE3, &DecodeBlocksSSSE3};
+    return {&EncodeBlocksUnvectorized, &DecodeBlocksUnvectorized};
+  }();
+  return functions;
+}
+
+#elif defined(ARCH_CPU_ARM64)
+
+// The kernels deinterleave 48 bytes or 64 characters into the 16-byte vectors
+// of their positions in the groups of 3 or 4.
+
+uint8x16x4_t LoadAlphabetNEON(Base64Alphabet alphabet) {
+  const uint8_t* chars =
+      reinterpret_cast<const uint8_t*>(GetAlphabet(alphabet));
+  return {{vld1q_u8(chars), vld1q_u8(chars + 16), vld1q_u8(chars + 32),
+           vld1q_u8(chars + 48)}};
+}
+
+size_t EncodeBlocksNEON(const uint8_t* input,
+                        size_t size,
+                        char* output,
+                        Base64Alphabet alphabet) {
+  const uint8x16x4_t table = LoadAlphabetNEON(alphabet);
+  const uint8x16_t mask = vdupq_n_u8(0x3F);
+  size_t i = 0;
+  for (; i + 48 <= size; i += 48) {
+    const uint8x16x3_t bytes = vld3q_u8(input + i);
+    uint8x16x4_t values;
+    values.val[0] = vshrq_n_u8(bytes.val[0], 2);
+    values.val[1] = vandq_u8(
+        vorrq_u8(vshlq_n_u8(bytes.val[0], 4), vshrq_n_u8(bytes.val[1], 4)),
+        mask);
+    values.val[2] = vandq_u8(
+        vorrq_u8(vshlq_n_u8(bytes.val[1], 2), vshrq_n_u8(bytes.val[2], 6)),
+        mask);
+    values.val[3] = vandq_u8(bytes.val[2], mask);
+    uint8x16x4_t chars;
+    for (int j = 0; j < 4; ++j)
+      chars.val[j] = vqtbl4q_u8(table, values.val[j]);
+    vst4q_u8(reinterpret_cast<uint8_t*>(output + i / 3 * 4), chars);
+  }
+  return i;
+}
+
+// Returns the 6-bit values of |chars|, and clears the bytes of |valid| for the
+// characters out of |alphabet|.
+uint8x16_t CharsToValuesNEON(uint8x16_t chars,
+                             Base64Alphabet alphabet,
+                             uint8x16_t& valid) {
+  auto in_range = [chars](uint8_t first, uint8_t last) {
+    return vcleq_u8(vsubq_u8(chars, vdupq_n_u8(first)),
+                    vdupq_n_u8(last - first));
+  };
+  const uint8_t* alphabet_chars =
+      reinterpret_cast<const uint8_t*>(GetAlphabet(alphabet));
+  const uint8x16_t upper = in_range('A', 'Z');
+  const uint8x16_t lower = in_range('a', 'z');
+  const uint8x16_t digit = in_range('0', '9');
+  const uint8x16_t char62 = vceqq_u8(chars, vdupq_n_u8(alphabet_chars[62]));
+  const uint8x16_t char63 = vceqq_u8(chars, vdupq_n_u8(alphabet_chars[63]));
+  valid = vandq_u8(valid, vorrq_u8(vorrq_u8(vorrq_u8(upper, lower), digit),
+                                   vorrq_u8(char62, char63)));
+  uint8x16_t offsets = vandq_u8(upper, vdupq_n_u8(static_cast<uint8_t>(-'A')));
+  offsets = vorrq_u8(
+      offsets, vandq_u8(lower, vdupq_n_u8(static_cast<uint8_t>(26 - 'a'))));
+  offsets = vorrq_u8(
+      offsets, vandq_u8(digit, vdupq_n_u8(static_cast<uint8_t>(52 - '0'))));
+  offsets = vorrq_u8(
+      offsets, vandq_u8(char62, vdupq_n_u8(static_cast<uint8_t>(
+                                    62 - alphabet_chars[62]))));
+  offsets = vorrq_u8(
+      offsets, vandq_u8(char63, vdupq_n_u8(static_cast<uint8_t>(
+                                    63 - alphabet_chars[63]))));
+  return vaddq_u8(chars, offsets);
+}
+
+size_t DecodeBlocksNEON(const char* input,
+                        size_t size,
+                        uint8_t* output,
+                        Base64Alphabet alphabet) {
+  size_t i = 0;
+  for (; i + 64 <= size; i += 64) {
+    const uint8x16x4_t chars =
+        vld4q_u8(reinterpret_cast<const uint8_t*>(input + i));
+    uint8x16_t valid = vdupq_n_u8(0xFF);
+    uint8x16_t values[4];
+    for (int j = 0; j < 4; ++j)
+      values[j] = CharsToValuesNEON(chars.val[j], alphabet, valid);
+    if (vminvq_u8(valid) != 0xFF)
+      break;
+    uint8x16x3_t bytes;
+    bytes.val[0] = vorrq_u8(vshlq_n_u8(values[0], 2), vshrq_n_u8(values[1], 4));
+    bytes.val[1] = vorrq_u8(vshlq_n_u8(values[1], 4), vshrq_n_u8(values[2], 2));
+    bytes.val[2] = vorrq_u8(vshlq_n_u8(values[2], 6), values[3]);
+    vst3q_u8(output + i / 4 * 3, bytes);
+  }
+  return i;
+}
+
+const Base64Functions& GetBase64Functions() {
+  static constexpr Base64Functions kFunctions = {&EncodeBlocksNEON,
+                                                 &DecodeBlocksNEON};
+  return kFunctions;
+}
+
+#else
+
+size_t EncodeBlocksUnvectorized(const uint8_t* input,
+                                size_t size,
+                                char* output,
+                                Base64Alphabet alphabet) {
+  return 0;
+}
+
+size_t DecodeBlocksUnvectorized(const char* input,
+                                size_t size,
+                                uint8_t* output,
+                                Base64Alphabet alphabet) {
+  return 0;
+}
+
+const Base64Functions& GetBase64Functions() {
+  static constexpr Base64Functions kFunctions = {&EncodeBlocksUnvectorized,
+                                                 &DecodeBlocksUnvectorized};
+  return kFunctions;
+}
+
+#endif
+
+}  // namespace
+
+size_t Base64EncodeBlocks(const uint8_t* input,
+                          size_t size,
+                          char* output,
+                          Base64Alphabet alphabet) {
+  return GetBase64Functions().encode(input, size, output, alphabet);
+}
+
+size_t Base64DecodeBlocks(const char* input,
+                          size_t size,
+                          uint8_t* output,
+                          Base64Alphabet alphabet) {
+  DCHECK_EQ(size % 4, 0u);
+  return GetBase64Functions().decode(input, size, output, alphabet);
+}
+
+size_t Base64EncodeInternal(span<const uint8_t> input,
+                            Base64Alphabet alphabet,
+                            bool pad,
+                            char* output) {
+  const char* chars = GetAlphabet(alphabet);
+  const uint8_t* in = input.data();
+  const size_t size = input.size();
+  // The kernels don't encode less than 16 bytes.
+  size_t i = size >= 16 ? Base64EncodeBlocks(in, size, output, alphabet) : 0;
+  char* out = output + i / 3 * 4;
+  for (; i + 3 <= size; i += 3) {
+    const uint32_t group = (in[i] << 16) | (in[i + 1] << 8) | in[i + 2];
+    out[0] = chars[group >> 18];
+    out[1] = chars[(group >> 12) & 0x3F];
+    out[2] = chars[(group >> 6) & 0x3F];
+    out[3] = chars[group & 0x3F];
+    out += 4;
+  }
+  if (i == size)
+    return static_cast<size_t>(out - output);
+
+  const bool two_bytes = i + 2 == size;
+  const uint32_t group = (in[i] << 16) | (two_bytes ? in[i + 1] << 8 : 0);
+  *out++ = chars[group >> 18];
+  *out++ = chars[(group >> 12) & 0x3F];
+  if (two_bytes)
+    *out++ = chars[(group >> 6) & 0x3F];
+  else if (pad)
+    *out++ = kPaddingChar;
+  if (pad)
+    *out++ = kPaddingChar;
+  return static_cast<size_t>(out - output);
+}
+
+absl::optional<size_t> Base64DecodeInternal(StringPiece input,
+                                            Base64Alphabet alphabet,
+                                            Base64Padding padding,
+                                            uint8_t* output) {
+  if (input.empty())
+    return 0;
+  if (padding == Base64Padding::kRequired && input.size() % 4)
+    return absl::nullopt;
+  if (padding == Base64Padding::kDisallowed && input.back() == kPaddingChar)
+    return absl::nullopt;
+
+  // Up to 2 padding characters end the input, once it's padded to a multiple
+  // of 4 characters.
+  size_t padding_size = (4 - input.size() % 4) % 4;
+  size_t size = input.size();
+  // Indexes the characters without the bounds checks of StringPiece.
+  const uint8_t* chars = reinterpret_cast<const uint8_t*>(input.data());
+  while (padding_size < 2 && chars[size - 1] == kPaddingChar) {
+    --size;
+    ++padding_size;
+  }
+  // The padding can't make up 3 of the characters of a group.
+  if (padding_size > 2)
+    return absl::nullopt;
+
+  const DecodeTables& tables = alphabet == Base64Alphabet::kStandard
+                                  ? kStandardDecodeTables
+                                  : kUrlDecodeTables;
+
+  const size_t groups_size = size / 4 * 4;
+  // The kernels don't decode less than 24 characters.
+  size_t i = groups_size >= 24 ? Base64DecodeBlocks(input.data(), groups_size,
+                                                    output, alphabet)
+                               : 0;
+  uint8_t* out = output + i / 4 * 3;
+  for (; i < groups_size; i += 4) {
+    const uint32_t group = tables[0][chars[i]] | tables[1][chars[i + 1]] |
+                           tables[2][chars[i + 2]] | tables[3][chars[i + 3]];
+    if (group & kInvalidBit)
+      return absl::nullopt;
+    out[0] = static_cast<uint8_t>(group >> 16);
+    out[1] = static_cast<uint8_t>(group >> 8);
+    out[2] = static_cast<uint8_t>(group);
+    out += 3;
+  }
+
+  if (i < size) {
+    // 2 or 3 characters, for 1 or 2 bytes.
+    const bool two_bytes = i + 3 == size;
+    const uint32_t group = tables[0][chars[i]] | tables[1][chars[i + 1]] |
+                           (two_bytes ? tables[2][chars[i + 2]] : 0);
+    if (group & kInvalidBit)
+      return absl::nullopt;
+    *out++ = static_cast<uint8_t>(group >> 16);
+    if (two_bytes)
+      *out++ = static_cast<uint8_t>(group >> 8);
+  }
+  return static_cast<size_t>(out - output);
+}
+
+}  // namespace internal
+}  // namespace base
@@ -0,0 +1,74 @@
+// Copyright 2022 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#ifndef BASE_BASE64_INTERNAL_H_
+#define BASE_BASE64_INTERNAL_H_
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include "base/base_export.h"
+#include "base/containers/span.h"
+#include "base/strings/string_piece.h"
+#include "third_party/abseil-cpp/absl/types/optional.h"
+
+namespace base {
+namespace internal {
+
+// The codecs of base/base64.h and base/base64url.h. They encode and decode
+// the bulk of their input with SSSE3 or AVX2 on x86-64 when the CPU supports
+// them at runtime, and with NEON on arm64, and the rest one group of
+// characters at a time.
+
+enum class Base64Alphabet {
+  // "+/" for the values 62 and 63.
+  kStandard,
+  // "-_" for the values 62 and 63, from RFC 4648 section 5.
+  kUrl,
+};
+
+enum class Base64Padding {
+  // The input must be padded with '=' to a multiple of 4 characters.
+  kRequired,
+  // The input may lack its padding, or part of it.
+  kOptional,
+  // The input must not be padded.
+  kDisallowed,
+};
+
+// Encodes |input| into |output|, which must have room for the padded
+// encoding, and returns the count of characters written.
+BASE_EXPORT size_t Base64EncodeInternal(span<const uint8_t> input,
+                                        Base64Alphabet alphabet,
+                                        bool pad,
+                                        char* output);
+
+// Decodes |input| into |output|, which must have room for
+// (input.size() + 3) / 4 * 3 bytes, and returns the count of bytes written,
+// or absl::nullopt if |input| isn't valid. As modp_b64 did, the bits which
+// the last character has beyond the decoded bytes are ignored.
+BASE_EXPORT absl::optional<size_t> Base64DecodeInternal(StringPiece input,
+                                                        Base64Alphabet alphabet,
+                                                        Base64Padding padding,
+                                                        uint8_t* output);
+
+// The vectorized kernels, exposed for the tests. They encode a prefix of
+// |input| which is a multiple of 3 bytes long into 4/3 as many characters of
+// |output|, or decode a prefix of |input|, whose size must be a multiple of
+// 4, into 3/4 as many bytes of |output|. The decoder stops before the first
+// block with a character out of |alphabet|. They return the size of the
+// prefix, which is shorter than |input| by less than a few blocks.
+BASE_EXPORT size_t Base64EncodeBlocks(const uint8_t* input,
+                                      size_t size,
+                                      char* output,
+                                      Base64Alphabet alphabet);
+BASE_EXPORT size_t Base64DecodeBlocks(const char* input,
+                                      size_t size,
+                                      uint8_t* output,
+                                      Base64Alphabet alphabet);
+
+}  // namespace internal
+}  // namespace base
+
+#endif  // BASE_BASE64_INTERNAL_H_
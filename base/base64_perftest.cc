@@ -0,0 +1,63 @@
+// Copyright 2022 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "base/base64.h"
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include <string>
+#include <vector>
+
+#include "base/base64url.h"
+#include "base/rand_util.h"
+#include "base/time/time.h"
+#include "testing/gtest/include/gtest/gtest.h"
+
+namespace base {
+
+namespace {
+
+constexpr size_t kBytesPerSize = 256 * 1024 * 1024;
+
+// Prints the throughput of |function| over |size| bytes, in MB/s of the
+// decoded data.
+template <typename Function>
+void Measure(const char* name, size_t size, Function function) {
+  const size_t iterations = kBytesPerSize / size;
+  const TimeTicks start = TimeTicks::Now();
+  for (size_t i = 0; i < iterations; ++i)
+    function();
+  const TimeDelta time = TimeTicks::Now() - start;
+  printf("%s\tsize:\t%zu\tMB/s:\t%.0f\n", name, size,
+         iterations * size / time.InSecondsF() / (1024 * 1024));
+}
+
+}  // namespace
+
+TEST(Base64PerfTest, DISABLED_Base64) {
+  for (size_t size = 16; size <= 65536; size *= 8) {
+    std::vector<uint8_t> input(size);
+    RandBytes(input.data(), input.size());
+    std::vector<char> encoded(Base64EncodedSize(size));
+    std::vector<uint8_t> decoded(Base64DecodedMaxSize(encoded.size()));
+    Measure("encode", size, [&] { Base64Encode(input, encoded); });
+    const StringPiece base64(encoded.data(), encoded.size());
+    Measure("decode", size,
+            [&] { EXPECT_EQ(size, Base64Decode(base64, decoded)); });
+    Measure("url-encode", size, [&] {
+      Base64UrlEncode(input, Base64UrlEncodePolicy::OMIT_PADDING, encoded);
+    });
+    const StringPiece base64url(
+        encoded.data(),
+        Base64UrlEncode(input, Base64UrlEncodePolicy::OMIT_PADDING, encoded));
+    Measure("url-decode", size, [&] {
+      EXPECT_EQ(size, Base64UrlDecode(base64url,
+                                      Base64UrlDecodePolicy::IGNORE_PADDING,
+                                      decoded));
+    });
+  }
+}
+
+}  // namespace base
@@ -4,11 +4,42 @@
 
 #include "base/base64.h"
 
+#include <stddef.h>
+#include <stdint.h>
+
+#include <string>
+#include <vector>
+
+#include "base/base64_internal.h"
+#include "base/rand_util.h"
 #include "testing/gmock/include/gmock/gmock.h"
 #include "testing/gtest/include/gtest/gtest.h"
+#include "third_party/modp_b64/modp_b64.h"
 
 namespace base {
 
+namespace {
+
+// The sizes which end in all the positions of the vectorized blocks.
+constexpr size_t kMaxSize = 200;
+
+std::string ModpEncode(const std::string& input) {
+  std::string output(modp_b64_encode_len(input.size()), '\0');
+  output.resize(modp_b64_encode(&output[0], input.data(), input.size()));
+  return output;
+}
+
+absl::optional<std::string> ModpDecode(const std::string& input) {
+  std::string output(modp_b64_decode_len(input.size()), '\0');
+  const size_t size = modp_b64_decode(&output[0], input.data(), input.size());
+  if (size == MODP_B64_ERROR)
+    return absl::nullopt;
+  output.resize(size);
+  return output;
+}
+
+}  // namespace
+
 TEST(Base64Test, Basic) {
   const std::string kText = "hello world";
   const std::string kBase64Text = "aGVsbG8gd29ybGQ=";
@@ -56,4 +87,97 @@ TEST(Base64Test, InPlace) {
   EXPECT_EQ(text, kText);
 }
 
+TEST(Base64Test, MatchesModp) {
+  for (size_t size = 0; size <= kMaxSize; ++size) {
+    const std::string input = RandBytesAsString(size);
+    std::string encoded;
+    Base64Encode(input, &encoded);
+    EXPECT_EQ(ModpEncode(input), encoded);
+    EXPECT_EQ(Base64EncodedSize(size), encoded.size());
+
+    std::string decoded;
+    ASSERT_TRUE(Base64Decode(encoded, &decoded)) << encoded;
+    EXPECT_EQ(input, decoded);
+  }
+}
+
+TEST(Base64Test, InvalidCharacters) {
+  const std::string input = RandBytesAsString(kMaxSize / 4 * 3);
+  std::string encoded;
+  Base64Encode(input, &encoded);
+  for (size_t i = 0; i < encoded.size(); ++i) {
+    for (char c : {'\0', '-', '_', '=', '.', ' ', '\x80', '\xFF'}) {
+      std::string invalid = encoded;
+      invalid[i] = c;
+      std::string decoded;
+      // A padding character before the last two isn't valid either.
+      const bool valid = c == '=' && i + 2 >= encoded.size() &&
+                         invalid.back() == '=';
+      EXPECT_EQ(valid, Base64Decode(invalid, &decoded)) << i << " " << c;
+      EXPECT_EQ(ModpDecode(invalid).has_value(), valid) << i << " " << c;
+    }
+  }
+}
+
+TEST(Base64Test, MatchesModpDecoding) {
+  // Includes the trailing bits which don't make up a byte, and the lengths
+  // which aren't multiples of 4.
+  const std::string kInputs[] = {"",     "=",    "==",   "A",    "AA",
+                                 "AAA",  "AAAA", "AA==", "AAA=", "A===",
+                                 "AB==", "AAB=", "/+/+", "QQ=Q", "QUJD",
+                                 "QUJDRA==", "QUJDRA=", "QUJDRA"};
+  for (const std::string& input : kInputs) {
+    std::string decoded;
+    const absl::optional<std::string> expected = ModpDecode(input);
+    ASSERT_EQ(expected.has_value(), Base64Decode(input, &decoded)) << input;
+    if (expected)
+      EXPECT_EQ(*expected, decoded) << input;
+  }
+}
+
+TEST(Base64Test, Spans) {
+  const uint8_t kData[] = {'h', 'e', 'l', 'l', 'o'};
+  static_assert(Base64EncodedSize(5) == 8, "");
+  static_assert(Base64DecodedMaxSize(8) == 6, "");
+
+  char encoded[Base64EncodedSize(sizeof(kData))];
+  ASSERT_EQ(8u, Base64Encode(kData, encoded));
+  EXPECT_EQ("aGVsbG8=", StringPiece(encoded, sizeof(encoded)));
+
+  uint8_t decoded[Base64DecodedMaxSize(sizeof(encoded))];
+  EXPECT_EQ(5u, Base64Decode(StringPiece(encoded, sizeof(encoded)), decoded));
+  EXPECT_THAT(make_span(decoded, 5u), testing::ElementsAreArray(kData));
+  EXPECT_EQ(absl::nullopt, Base64Decode("aGVsbG8", decoded));
+}
+
+TEST(Base64Test, Blocks) {
+  // The kernels encode and decode whole blocks, and stop at invalid ones.
+  std::vector<uint8_t> input(kMaxSize / 4 * 3);
+  for (size_t i = 0; i < input.size(); ++i)
+    input[i] = static_cast<uint8_t>(i * 37);
+  for (auto alphabet :
+       {internal::Base64Alphabet::kStandard, internal::Base64Alphabet::kUrl}) {
+    std::string encoded(kMaxSize, '\0');
+    const size_t encoded_size = internal::Base64EncodeBlocks(
+        input.data(), input.size(), &encoded[0], alphabet);
+    EXPECT_EQ(0u, encoded_size % 3);
+    const size_t size = internal::Base64EncodeInternal(
+        input, alphabet, /*pad=*/true, &encoded[0]);
+    ASSERT_EQ(kMaxSize, size);
+
+    std::vector<uint8_t> decoded(input.size());
+    const size_t decoded_size = internal::Base64DecodeBlocks(
+        encoded.data(), encoded.size(), decoded.data(), alphabet);
+    EXPECT_EQ(0u, decoded_size % 4);
+    decoded.resize(decoded_size / 4 * 3);
+    EXPECT_EQ(std::vector<uint8_t>(input.begin(),
+                                   input.begin() + decoded.size()),
+              decoded);
+
+    encoded[0] = '!';
+    EXPECT_EQ(0u, internal::Base64DecodeBlocks(encoded.data(), encoded.size(),
+                                               decoded.data(), alphabet));
+  }
+}
+
 }  // namespace base
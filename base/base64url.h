@@ -5,10 +5,16 @@
 #ifndef BASE_BASE64URL_H_
 #define BASE_BASE64URL_H_
 
+#include <stddef.h>
+#include <stdint.h>
+
 #include <string>
 
+#include "base/base64.h"
 #include "base/base_export.h"
+#include "base/containers/span.h"
 #include "base/strings/string_piece.h"
+#include "third_party/abseil-cpp/absl/types/optional.h"
 
 namespace base {
 
@@ -29,6 +35,13 @@ BASE_EXPORT void Base64UrlEncode(const StringPiece& input,
                                  Base64UrlEncodePolicy policy,
                                  std::string* output);
 
+// Encodes |input| in base64url into |output|, which must have room for
+// Base64EncodedSize(input.size()) characters, and returns the count of
+// characters written. |input| and |output| must not overlap.
+BASE_EXPORT size_t Base64UrlEncode(span<const uint8_t> input,
+                                   Base64UrlEncodePolicy policy,
+                                   span<char> output);
+
 enum class Base64UrlDecodePolicy {
   // Require inputs contain trailing padding if non-aligned.
   REQUIRE_PADDING,
@@ -49,6 +62,15 @@ enum class Base64UrlDecodePolicy {
                                                Base64UrlDecodePolicy policy,
                                                std::string* output);
 
+// Decodes the |input| string in base64url into |output|, which must have room
+// for Base64DecodedMaxSize(input.size()) bytes. Returns the count of bytes
+// written, or absl::nullopt if |input| isn't valid, in which case |output| may
+// have been written. |input| and |output| must not overlap.
+[[nodiscard]] BASE_EXPORT absl::optional<size_t> Base64UrlDecode(
+    StringPiece input,
+    Base64UrlDecodePolicy policy,
+    span<uint8_t> output);
+
 }  // namespace base
 
 #endif  // BASE_BASE64URL_H_
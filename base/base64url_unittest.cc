@@ -4,6 +4,13 @@
 
 #include "base/base64url.h"
 
+#include <stdint.h>
+
+#include <string>
+
+#include "base/base64.h"
+#include "base/rand_util.h"
+#include "base/strings/string_util.h"
 #include "testing/gtest/include/gtest/gtest.h"
 
 namespace base {
@@ -109,6 +116,79 @@ TEST(Base64UrlTest, DecodeDisallowsPaddingOnly) {
       "====", Base64UrlDecodePolicy::IGNORE_PADDING, &output));
 }
 
+TEST(Base64UrlTest, MatchesBase64) {
+  // Up to the sizes which end in all the positions of the vectorized blocks.
+  for (size_t size = 0; size <= 200; ++size) {
+    const std::string input = RandBytesAsString(size);
+    std::string base64;
+    Base64Encode(input, &base64);
+    ReplaceChars(base64, "+", "-", &base64);
+    ReplaceChars(base64, "/", "_", &base64);
+
+    std::string padded;
+    Base64UrlEncode(input, Base64UrlEncodePolicy::INCLUDE_PADDING, &padded);
+    EXPECT_EQ(base64, padded);
+    std::string unpadded;
+    Base64UrlEncode(input, Base64UrlEncodePolicy::OMIT_PADDING, &unpadded);
+    EXPECT_EQ(TrimString(base64, "=", TRIM_TRAILING), unpadded);
+
+    std::string decoded;
+    EXPECT_TRUE(Base64UrlDecode(padded, Base64UrlDecodePolicy::REQUIRE_PADDING,
+                                &decoded));
+    EXPECT_EQ(input, decoded);
+    EXPECT_TRUE(Base64UrlDecode(padded, Base64UrlDecodePolicy::IGNORE_PADDING,
+                                &decoded));
+    EXPECT_EQ(input, decoded);
+    EXPECT_TRUE(Base64UrlDecode(
+        unpadded, Base64UrlDecodePolicy::IGNORE_PADDING, &decoded));
+    EXPECT_EQ(input, decoded);
+    EXPECT_TRUE(Base64UrlDecode(
+        unpadded, Base64UrlDecodePolicy::DISALLOW_PADDING, &decoded));
+    EXPECT_EQ(input, decoded);
+    EXPECT_EQ(padded == unpadded,
+              Base64UrlDecode(padded, Base64UrlDecodePolicy::DISALLOW_PADDING,
+                              &decoded));
+    EXPECT_EQ(padded == unpadded,
+              Base64UrlDecode(unpadded, Base64UrlDecodePolicy::REQUIRE_PADDING,
+                              &decoded));
+  }
+}
+
+TEST(Base64UrlTest, DecodeDisallowsBase64AlphabetInBlocks) {
+  std::string input(100, 'A');
+  std::string output;
+  ASSERT_TRUE(
+      Base64UrlDecode(input, Base64UrlDecodePolicy::REQUIRE_PADDING, &output));
+  for (size_t i = 0; i < input.size(); ++i) {
+    for (char c : {'+', '/'}) {
+      std::string invalid = input;
+      invalid[i] = c;
+      EXPECT_FALSE(Base64UrlDecode(
+          invalid, Base64UrlDecodePolicy::REQUIRE_PADDING, &output))
+          << i;
+    }
+  }
+}
+
+TEST(Base64UrlTest, Spans) {
+  const uint8_t kData[] = {'?', '?'};
+  char encoded[Base64EncodedSize(sizeof(kData))];
+  EXPECT_EQ(3u, Base64UrlEncode(kData, Base64UrlEncodePolicy::OMIT_PADDING,
+                                encoded));
+  EXPECT_EQ("Pz8", StringPiece(encoded, 3));
+  EXPECT_EQ(4u, Base64UrlEncode(kData, Base64UrlEncodePolicy::INCLUDE_PADDING,
+                                encoded));
+  EXPECT_EQ("Pz8=", StringPiece(encoded, 4));
+
+  uint8_t decoded[Base64DecodedMaxSize(4)];
+  EXPECT_EQ(2u, Base64UrlDecode("Pz8", Base64UrlDecodePolicy::IGNORE_PADDING,
+                                decoded));
+  EXPECT_EQ('?', decoded[1]);
+  EXPECT_EQ(absl::nullopt,
+            Base64UrlDecode("Pz8", Base64UrlDecodePolicy::REQUIRE_PADDING,
+                            decoded));
+}
+
 }  // namespace
 
 }  // namespace base
@@ -8,9 +8,135 @@
 
 #include "base/numerics/checked_math.h"
 #include "base/strings/string_piece.h"
+#include "build/build_config.h"
+
+#if defined(ARCH_CPU_X86_64)
+// Including these headers directly should generally be avoided. SSE2 is
+// always available on x86-64.
+// clang-format off
+#include <emmintrin.h>
+// clang-format on
+#elif defined(ARCH_CPU_ARM64)
+#include <arm_neon.h>
+#endif
 
 namespace base {
 
+namespace {
+
+// The size of the blocks which the kernels below swap at once.
+constexpr size_t kBlockSize = 16;
+
+// SwapBlocks<T>() copies the whole blocks of the |size| bytes of |src| to
+// |dest|, reversing the bytes of each T, and returns their size.
+
+#if defined(ARCH_CPU_X86_64)
+
+// Reverses the bytes of each T of |block|. SSE2 has no byte shuffle, so the
+// bytes of each 16-bit word are swapped with shifts, and then the words of
+// each T with word shuffles.
+template <typename T>
+__m128i SwapBlock(__m128i block) {
+  block = _mm_or_si128(_mm_slli_epi16(block, 8), _mm_srli_epi16(block, 8));
+  if (sizeof(T) == 4) {
+    // Words 1, 0, 3, 2.
+    block = _mm_shufflehi_epi16(_mm_shufflelo_epi16(block, 0xB1), 0xB1);
+  } else if (sizeof(T) == 8) {
+    // Words 3, 2, 1, 0.
+    block = _mm_shufflehi_epi16(_mm_shufflelo_epi16(block, 0x1B), 0x1B);
+  }
+  return block;
+}
+
+template <typename T>
+size_t SwapBlocks(const uint8_t* src, size_t size, uint8_t* dest) {
+  size_t i = 0;
+  for (; i + kBlockSize <= size; i += kBlockSize) {
+    const __m128i block =
+        _mm_loadu_si128(reinterpret_cast<const __m128i*>(src + i));
+    _mm_storeu_si128(reinterpret_cast<__m128i*>(dest + i),
+                     SwapBlock<T>(block));
+  }
+  return i;
+}
+
+#elif defined(ARCH_CPU_ARM64)
+
+template <typename T>
+uint8x16_t SwapBlock(uint8x16_t block) {
+  if (sizeof(T) == 2)
+    return vrev16q_u8(block);
+  if (sizeof(T) == 4)
+    return vrev32q_u8(block);
+  return vrev64q_u8(block);
+}
+
+template <typename T>
+size_t SwapBlocks(const uint8_t* src, size_t size, uint8_t* dest) {
+  size_t i = 0;
+  for (; i + kBlockSize <= size; i += kBlockSize)
+    vst1q_u8(dest + i, SwapBlock<T>(vld1q_u8(src + i)));
+  return i;
+}
+
+#else
+
+template <typename T>
+size_t SwapBlocks(const uint8_t* src, size_t size, uint8_t* dest) {
+  return 0;
+}
+
+#endif
+
+// Copies |size| bytes of Ts from |src| to |dest|, reversing the bytes of each
+// T on little-endian CPUs.
+template <typename T>
+void CopySwappingBytes(const uint8_t* src, size_t size, uint8_t* dest) {
+#if defined(ARCH_CPU_LITTLE_ENDIAN)
+  for (size_t i = SwapBlocks<T>(src, size, dest); i < size; i += sizeof(T)) {
+    for (size_t j = 0; j < sizeof(T); ++j)
+      dest[i + j] = src[i + sizeof(T) - 1 - j];
+  }
+#else
+  memcpy(dest, src, size);
+#endif
+}
+
+}  // namespace
+
+void ReadBigEndianArray(const uint8_t buf[], base::span<uint16_t> out) {
+  CopySwappingBytes<uint16_t>(buf, out.size_bytes(),
+                              reinterpret_cast<uint8_t*>(out.data()));
+}
+
+void ReadBigEndianArray(const uint8_t buf[], base::span<uint32_t> out) {
+  CopySwappingBytes<uint32_t>(buf, out.size_bytes(),
+                              reinterpret_cast<uint8_t*>(out.data()));
+}
+
+void ReadBigEndianArray(const uint8_t buf[], base::span<uint64_t> out) {
+  CopySwappingBytes<uint64_t>(buf, out.size_bytes(),
+                              reinterpret_cast<uint8_t*>(out.data()));
+}
+
+void WriteBigEndianArray(char buf[], base::span<const uint16_t> values) {
+  CopySwappingBytes<uint16_t>(reinterpret_cast<const uint8_t*>(values.data()),
+                              values.size_bytes(),
+                              reinterpret_cast<uint8_t*>(buf));
+}
+
+void WriteBigEndianArray(char buf[], base::span<const uint32_t> values) {
+  CopySwappingBytes<uint32_t>(reinterpret_cast<const uint8_t*>(values.data()),
+                              values.size_bytes(),
+                              reinterpret_cast<uint8_t*>(buf));
+}
+
+void WriteBigEndianArray(char buf[], base::span<const uint64_t> values) {
+  CopySwappingBytes<uint64_t>(reinterpret_cast<const uint8_t*>(values.data()),
+                              values.size_bytes(),
+                              reinterpret_cast<uint8_t*>(buf));
+}
+
 BigEndianReader BigEndianReader::FromStringPiece(
     base::StringPiece string_piece) {
   return BigEndianReader(base::as_bytes(base::make_span(string_piece)));
@@ -78,6 +204,27 @@ bool BigEndianReader::ReadU64(uint64_t* value) {
   return Read(value);
 }
 
+template <typename T>
+bool BigEndianReader::ReadArray(base::span<T> values) {
+  if (values.size_bytes() > remaining())
+    return false;
+  ReadBigEndianArray(ptr_, values);
+  ptr_ += values.size_bytes();
+  return true;
+}
+
+bool BigEndianReader::ReadU16s(base::span<uint16_t> values) {
+  return ReadArray(values);
+}
+
+bool BigEndianReader::ReadU32s(base::span<uint32_t> values) {
+  return ReadArray(values);
+}
+
+bool BigEndianReader::ReadU64s(base::span<uint64_t> values) {
+  return ReadArray(values);
+}
+
 template <typename T>
 bool BigEndianReader::ReadLengthPrefixed(base::StringPiece* out) {
   T t_len;
@@ -144,4 +291,25 @@ bool BigEndianWriter::WriteU64(uint64_t value) {
   return Write(value);
 }
 
+template <typename T>
+bool BigEndianWriter::WriteArray(base::span<const T> values) {
+  if (values.size_bytes() > remaining())
+    return false;
+  WriteBigEndianArray(ptr_, values);
+  ptr_ += values.size_bytes();
+  return true;
+}
+
+bool BigEndianWriter::WriteU16s(base::span<const uint16_t> values) {
+  return WriteArray(values);
+}
+
+bool BigEndianWriter::WriteU32s(base::span<const uint32_t> values) {
+  return WriteArray(values);
+}
+
+bool BigEndianWriter::WriteU64s(base::span<const uint64_t> values) {
+  return WriteArray(values);
+}
+
 }  // namespace base
@@ -68,6 +68,25 @@ inline void WriteBigEndian<int8_t>(char buf[], int8_t val) {
   buf[0] = static_cast<char>(val);
 }
 
+// Read |out.size()| integers from |buf| in Big Endian order. |buf| must hold
+// |out.size_bytes()| bytes. The bytes are swapped 16 at a time with SSE2 or
+// NEON, which is much faster than reading the integers one by one.
+BASE_EXPORT void ReadBigEndianArray(const uint8_t buf[],
+                                    base::span<uint16_t> out);
+BASE_EXPORT void ReadBigEndianArray(const uint8_t buf[],
+                                    base::span<uint32_t> out);
+BASE_EXPORT void ReadBigEndianArray(const uint8_t buf[],
+                                    base::span<uint64_t> out);
+
+// Write |values| to |buf| in Big Endian order. |buf| must have room for
+// |values.size_bytes()| bytes.
+BASE_EXPORT void WriteBigEndianArray(char buf[],
+                                     base::span<const uint16_t> values);
+BASE_EXPORT void WriteBigEndianArray(char buf[],
+                                     base::span<const uint32_t> values);
+BASE_EXPORT void WriteBigEndianArray(char buf[],
+                                     base::span<const uint64_t> values);
+
 // Allows reading integers in network order (big endian) while iterating over
 // an underlying buffer. All the reading functions advance the internal pointer.
 class BASE_EXPORT BigEndianReader {
@@ -91,6 +110,12 @@ class BASE_EXPORT BigEndianReader {
   bool ReadU32(uint32_t* value);
   bool ReadU64(uint64_t* value);
 
+  // Read |values.size()| integers at once. Fail, without reading any, if the
+  // buffer doesn't hold them all.
+  bool ReadU16s(base::span<uint16_t> values);
+  bool ReadU32s(base::span<uint32_t> values);
+  bool ReadU64s(base::span<uint64_t> values);
+
   // Reads a length-prefixed region:
   // 1. reads a big-endian length L from the buffer;
   // 2. sets |*out| to a StringPiece over the next L many bytes
@@ -110,6 +135,8 @@ class BASE_EXPORT BigEndianReader {
   template<typename T>
   bool Read(T* v);
   template <typename T>
+  bool ReadArray(base::span<T> values);
+  template <typename T>
   bool ReadLengthPrefixed(base::StringPiece* out);
 
   const uint8_t* ptr_;
@@ -132,10 +159,18 @@ class BASE_EXPORT BigEndianWriter {
   bool WriteU32(uint32_t value);
   bool WriteU64(uint64_t value);
 
+  // Write all of |values| at once. Fail, without writing any, if the buffer
+  // has no room for them all.
+  bool WriteU16s(base::span<const uint16_t> values);
+  bool WriteU32s(base::span<const uint32_t> values);
+  bool WriteU64s(base::span<const uint64_t> values);
+
  private:
   // Hidden to promote type safety.
   template<typename T>
   bool Write(T v);
+  template <typename T>
+  bool WriteArray(base::span<const T> values);
 
   raw_ptr<char> ptr_;
   raw_ptr<char> end_;
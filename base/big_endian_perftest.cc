@@ -0,0 +1,112 @@
+// Copyright 2022 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "base/big_endian.h"
+
+#include <stdint.h>
+
+#include <string>
+#include <vector>
+
+#include "base/time/time.h"
+#include "base/timer/lap_timer.h"
+#include "testing/gtest/include/gtest/gtest.h"
+#include "testing/perf/perf_result_reporter.h"
+
+namespace base {
+namespace {
+
+constexpr TimeDelta kTimeLimit = Seconds(2);
+constexpr int kWarmupRuns = 100;
+constexpr int kTimeCheckInterval = 100;
+
+constexpr char kMetricPrefixBigEndian[] = "BigEndian.";
+constexpr char kMetricThroughput[] = "throughput";
+
+// The size of the arrays of a decoded message.
+constexpr size_t kArraySize = 4096;
+
+void ReportResults(const std::string& story_name,
+                   const LapTimer& timer,
+                   size_t bytes_per_lap) {
+  perf_test::PerfResultReporter reporter(kMetricPrefixBigEndian, story_name);
+  reporter.RegisterImportantMetric(kMetricThroughput, "MB/s");
+  reporter.AddResult(kMetricThroughput,
+                     timer.LapsPerSecond() * bytes_per_lap / (1024 * 1024));
+}
+
+std::vector<uint8_t> GenerateData(size_t size) {
+  std::vector<uint8_t> data(size);
+  for (size_t i = 0; i < size; ++i)
+    data[i] = static_cast<uint8_t>(i * 31 + 7);
+  return data;
+}
+
+// Reads an array of kArraySize Ts one at a time with |read_one|, or at once
+// with |read_array|.
+template <typename T>
+void RunReadTest(const std::string& story_name,
+                 bool (BigEndianReader::*read_one)(T*),
+                 bool (BigEndianReader::*read_array)(span<T>)) {
+  const std::vector<uint8_t> data = GenerateData(kArraySize * sizeof(T));
+  std::vector<T> values(kArraySize);
+
+  LapTimer one_timer(kWarmupRuns, kTimeLimit, kTimeCheckInterval);
+  do {
+    BigEndianReader reader(data);
+    for (T& value : values)
+      ASSERT_TRUE((reader.*read_one)(&value));
+    one_timer.NextLap();
+  } while (!one_timer.HasTimeLimitExpired());
+  ReportResults(story_name + "_One", one_timer, data.size());
+
+  LapTimer array_timer(kWarmupRuns, kTimeLimit, kTimeCheckInterval);
+  do {
+    BigEndianReader reader(data);
+    ASSERT_TRUE((reader.*read_array)(values));
+    array_timer.NextLap();
+  } while (!array_timer.HasTimeLimitExpired());
+  ReportResults(story_name + "_Array", array_timer, data.size());
+}
+
+}  // namespace
+
+TEST(BigEndianPerfTest, ReadU16) {
+  RunReadTest<uint16_t>("ReadU16", &BigEndianReader::ReadU16,
+                        &BigEndianReader::ReadU16s);
+}
+
+TEST(BigEndianPerfTest, ReadU32) {
+  RunReadTest<uint32_t>("ReadU32", &BigEndianReader::ReadU32,
+                        &BigEndianReader::ReadU32s);
+}
+
+TEST(BigEndianPerfTest, ReadU64) {
+  RunReadTest<uint64_t>("ReadU64", &BigEndianReader::ReadU64,
+                        &BigEndianReader::ReadU64s);
+}
+
+TEST(BigEndianPerfTest, WriteU32) {
+  const std::vector<uint32_t> values(kArraySize, 0x01020304);
+  std::vector<char> data(kArraySize * sizeof(uint32_t));
+
+  LapTimer one_timer(kWarmupRuns, kTimeLimit, kTimeCheckInterval);
+  do {
+    BigEndianWriter writer(data.data(), data.size());
+    for (uint32_t value : values)
+      ASSERT_TRUE(writer.WriteU32(value));
+    one_timer.NextLap();
+  } while (!one_timer.HasTimeLimitExpired());
+  ReportResults("WriteU32_One", one_timer, data.size());
+
+  LapTimer array_timer(kWarmupRuns, kTimeLimit, kTimeCheckInterval);
+  do {
+    BigEndianWriter writer(data.data(), data.size());
+    ASSERT_TRUE(writer.WriteU32s(values));
+    array_timer.NextLap();
+  } while (!array_timer.HasTimeLimitExpired());
+  ReportResults("WriteU32_Array", array_timer, data.size());
+}
+
+}  // namespace base
@@ -105,6 +105,44 @@ TEST(BigEndianReaderTest, ReadsValues) {
   EXPECT_EQ(expected.data(), piece.data());
 }
 
+// The arrays are long enough for the vectorized loops and their tails.
+TEST(BigEndianReaderTest, ReadsArrays) {
+  uint8_t data[8 * 37];
+  for (size_t i = 0; i < sizeof(data); ++i)
+    data[i] = static_cast<uint8_t>(i * 7 + 1);
+  uint16_t u16s[37];
+  uint32_t u32s[37];
+  uint64_t u64s[37];
+
+  BigEndianReader reader(data, sizeof(data));
+  EXPECT_TRUE(reader.ReadU16s(u16s));
+  EXPECT_TRUE(reader.ReadU32s(u32s));
+  EXPECT_FALSE(reader.ReadU64s(u64s));
+  EXPECT_EQ(2u * 37, reader.remaining());
+
+  BigEndianReader expected_reader(data, sizeof(data));
+  for (uint16_t u16 : u16s) {
+    uint16_t expected;
+    EXPECT_TRUE(expected_reader.ReadU16(&expected));
+    EXPECT_EQ(expected, u16);
+  }
+  for (uint32_t u32 : u32s) {
+    uint32_t expected;
+    EXPECT_TRUE(expected_reader.ReadU32(&expected));
+    EXPECT_EQ(expected, u32);
+  }
+
+  reader = BigEndianReader(data, sizeof(data));
+  EXPECT_TRUE(reader.ReadU64s(u64s));
+  EXPECT_EQ(0u, reader.remaining());
+  expected_reader = BigEndianReader(data, sizeof(data));
+  for (uint64_t u64 : u64s) {
+    uint64_t expected;
+    EXPECT_TRUE(expected_reader.ReadU64(&expected));
+    EXPECT_EQ(expected, u64);
+  }
+}
+
 TEST(BigEndianReaderTest, ReadsLengthPrefixedValues) {
   {
     uint8_t u8_prefixed_data[] = {8,   8,   9,    0xA,  0xB,  0xC,  0xD,
@@ -251,6 +289,42 @@ TEST(BigEndianWriterTest, RespectsLength) {
   EXPECT_EQ(0u, writer.remaining());
 }
 
+TEST(BigEndianWriterTest, WritesArrays) {
+  uint16_t u16s[19];
+  uint32_t u32s[19];
+  uint64_t u64s[19];
+  for (size_t i = 0; i < 19; ++i) {
+    u16s[i] = static_cast<uint16_t>(0x0102 * (i + 1));
+    u32s[i] = static_cast<uint32_t>(0x01020304 * (i + 1));
+    u64s[i] = 0x0102030405060708 * (i + 1);
+  }
+  char data[14 * 19];
+  BigEndianWriter writer(data, sizeof(data));
+  EXPECT_TRUE(writer.WriteU16s(u16s));
+  EXPECT_TRUE(writer.WriteU32s(u32s));
+  EXPECT_TRUE(writer.WriteU64s(u64s));
+  EXPECT_FALSE(writer.WriteU16s(u16s));
+  EXPECT_EQ(0u, writer.remaining());
+
+  BigEndianReader reader = BigEndianReader::FromStringPiece(
+      base::StringPiece(data, sizeof(data)));
+  for (uint16_t u16 : u16s) {
+    uint16_t value;
+    EXPECT_TRUE(reader.ReadU16(&value));
+    EXPECT_EQ(u16, value);
+  }
+  for (uint32_t u32 : u32s) {
+    uint32_t value;
+    EXPECT_TRUE(reader.ReadU32(&value));
+    EXPECT_EQ(u32, value);
+  }
+  for (uint64_t u64 : u64s) {
+    uint64_t value;
+    EXPECT_TRUE(reader.ReadU64(&value));
+    EXPECT_EQ(u64, value);
+  }
+}
+
 TEST(BigEndianWriterTest, SafePointerMath) {
   char data[3];
   BigEndianWriter writer(data, sizeof(data));
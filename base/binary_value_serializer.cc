@@ -0,0 +1,481 @@
+// Copyright 2022 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "base/binary_value_serializer.h"
+
+#include <string.h>
+
+#include <limits>
+#include <utility>
+
+#include "base/bit_cast.h"
+#include "base/check_op.h"
+#include "base/files/file_path.h"
+#include "base/json/json_common.h"
+#include "base/memory/ptr_util.h"
+#include "base/sys_byteorder.h"
+
+namespace base {
+
+namespace {
+
+constexpr char kMagic[] = {'B', 'V', 'A', 'L'};
+constexpr uint32_t kVersion = 1;
+constexpr size_t kHeaderSize = sizeof(kMagic) + sizeof(kVersion);
+
+// The sizes of the type, and of the count of the items of a container.
+constexpr size_t kTypeSize = 1;
+constexpr size_t kContainerHeaderSize = kTypeSize + sizeof(uint32_t);
+// The table entries of dictionaries are the offsets of a key and of a value,
+// and those of lists the offsets of an item.
+constexpr size_t kDictEntrySize = 2 * sizeof(uint32_t);
+constexpr size_t kListEntrySize = sizeof(uint32_t);
+
+constexpr char kInvalidEncoding[] = "Invalid binary Value encoding.";
+
+// Appends the encoding of the values to a string. The offsets in the tables
+// are patched in as the items are written.
+class Writer {
+ public:
+  explicit Writer(std::string* output) : output_(output) {}
+
+  Writer(const Writer&) = delete;
+  Writer& operator=(const Writer&) = delete;
+
+  // Returns false if |node| is nested too deeply.
+  bool Write(ValueView node, size_t depth) {
+    return node.Visit([this, depth](const auto& member) {
+      return WriteValue(member, depth);
+    });
+  }
+
+ private:
+  bool WriteValue(absl::monostate node, size_t depth) {
+    AppendType(Value::Type::NONE);
+    return true;
+  }
+
+  bool WriteValue(bool node, size_t depth) {
+    AppendType(Value::Type::BOOLEAN);
+    output_->push_back(node ? 1 : 0);
+    return true;
+  }
+
+  bool WriteValue(int node, size_t depth) {
+    AppendType(Value::Type::INTEGER);
+    AppendUint32(static_cast<uint32_t>(node));
+    return true;
+  }
+
+  bool WriteValue(double node, size_t depth) {
+    AppendType(Value::Type::DOUBLE);
+    const uint64_t bits = ByteSwapToLE64(bit_cast<uint64_t>(node));
+    output_->append(reinterpret_cast<const char*>(&bits), sizeof(bits));
+    return true;
+  }
+
+  bool WriteValue(const std::string& node, size_t depth) {
+    AppendType(Value::Type::STRING);
+    AppendBytes(node.data(), node.size());
+    return true;
+  }
+
+  bool WriteValue(const Value::BlobStorage& node, size_t depth) {
+    AppendType(Value::Type::BINARY);
+    AppendBytes(reinterpret_cast<const char*>(node.data()), node.size());
+    return true;
+  }
+
+  bool WriteValue(const Value::Dict& node, size_t depth) {
+    if (depth >= internal::kAbsoluteMaxDepth)
+      return false;
+    AppendType(Value::Type::DICTIONARY);
+    size_t table = AppendTable(node.size(), kDictEntrySize);
+    // The keys of a Dict are sorted.
+    for (const auto [key, value] : node) {
+      SetUint32(table, output_->size());
+      AppendBytes(key.data(), key.size());
+      SetUint32(table + sizeof(uint32_t), output_->size());
+      if (!Write(value, depth + 1))
+        return false;
+      table += kDictEntrySize;
+    }
+    return true;
+  }
+
+  bool WriteValue(const Value::List& node, size_t depth) {
+    if (depth >= internal::kAbsoluteMaxDepth)
+      return false;
+    AppendType(Value::Type::LIST);
+    size_t table = AppendTable(node.size(), kListEntrySize);
+    for (const Value& item : node) {
+      SetUint32(table, output_->size());
+      if (!Write(item, depth + 1))
+        return false;
+      table += kListEntrySize;
+    }
+    return true;
+  }
+
+  void AppendType(Value::Type type) {
+    output_->push_back(static_cast<char>(type));
+  }
+
+  void AppendUint32(uint32_t value) {
+    value = ByteSwapToLE32(value);
+    output_->append(reinterpret_cast<const char*>(&value), sizeof(value));
+  }
+
+  void AppendBytes(const char* data, size_t size) {
+    // Sizes over 4GB are truncated, but make the encoding too large anyway.
+    AppendUint32(static_cast<uint32_t>(size));
+    output_->append(data, size);
+  }
+
+  // Appends the count and the zeroed table of a container, and returns the
+  // offset of the table.
+  size_t AppendTable(size_t count, size_t entry_size) {
+    AppendUint32(static_cast<uint32_t>(count));
+    const size_t table = output_->size();
+    output_->append(count * entry_size, '\0');
+    return table;
+  }
+
+  void SetUint32(size_t offset, size_t value) {
+    // The offsets past 4GB are truncated, but make the encoding too large.
+    const uint32_t le_value = ByteSwapToLE32(static_cast<uint32_t>(value));
+    memcpy(&(*output_)[offset], &le_value, sizeof(le_value));
+  }
+
+  const raw_ptr<std::string> output_;
+};
+
+}  // namespace
+
+BinaryValueSerializer::BinaryValueSerializer(std::string* output)
+    : output_(output) {
+  DCHECK(output_);
+}
+
+BinaryValueSerializer::~BinaryValueSerializer() = default;
+
+bool BinaryValueSerializer::Serialize(ValueView root) {
+  output_->assign(kMagic, sizeof(kMagic));
+  const uint32_t version = ByteSwapToLE32(kVersion);
+  output_->append(reinterpret_cast<const char*>(&version), sizeof(version));
+  Writer writer(output_);
+  return writer.Write(root, 0) &&
+         output_->size() <= std::numeric_limits<uint32_t>::max();
+}
+
+BinaryValueDeserializer::BinaryValueDeserializer(span<const uint8_t> data)
+    : data_(data) {}
+
+BinaryValueDeserializer::~BinaryValueDeserializer() = default;
+
+std::unique_ptr<Value> BinaryValueDeserializer::Deserialize(
+    int* error_code,
+    std::string* error_message) {
+  std::unique_ptr<BinaryValueReader> reader = BinaryValueReader::Create(data_);
+  absl::optional<Value> value;
+  if (reader)
+    value = reader->root().ToValue();
+  if (!value) {
+    if (error_code)
+      *error_code = kErrorCodeInvalidFormat;
+    if (error_message)
+      *error_message = kInvalidEncoding;
+    return nullptr;
+  }
+  if (error_code)
+    *error_code = kErrorCodeNoError;
+  return std::make_unique<Value>(std::move(*value));
+}
+
+absl::optional<Value::Type> BinaryValueView::type() const {
+  if (offset_ >= data_.size() ||
+      data_[offset_] > static_cast<uint8_t>(Value::Type::LIST)) {
+    return absl::nullopt;
+  }
+  return static_cast<Value::Type>(data_[offset_]);
+}
+
+absl::optional<bool> BinaryValueView::GetIfBool() const {
+  if (type() != Value::Type::BOOLEAN || offset_ + kTypeSize >= data_.size())
+    return absl::nullopt;
+  return data_[offset_ + kTypeSize] != 0;
+}
+
+absl::optional<int> BinaryValueView::GetIfInt() const {
+  if (type() != Value::Type::INTEGER)
+    return absl::nullopt;
+  absl::optional<uint32_t> value = ReadUint32(offset_ + kTypeSize);
+  if (!value)
+    return absl::nullopt;
+  return static_cast<int32_t>(*value);
+}
+
+absl::optional<double> BinaryValueView::GetIfDouble() const {
+  if (type() == Value::Type::INTEGER)
+    return GetIfInt();
+  if (type() != Value::Type::DOUBLE)
+    return absl::nullopt;
+  absl::optional<uint64_t> bits = ReadUint64(offset_ + kTypeSize);
+  if (!bits)
+    return absl::nullopt;
+  return bit_cast<double>(*bits);
+}
+
+absl::optional<StringPiece> BinaryValueView::GetIfString() const {
+  if (type() != Value::Type::STRING)
+    return absl::nullopt;
+  absl::optional<span<const uint8_t>> bytes = ReadBytes(offset_ + kTypeSize);
+  if (!bytes)
+    return absl::nullopt;
+  return StringPiece(reinterpret_cast<const char*>(bytes->data()),
+                     bytes->size());
+}
+
+absl::optional<span<const uint8_t>> BinaryValueView::GetIfBlob() const {
+  if (type() != Value::Type::BINARY)
+    return absl::nullopt;
+  return ReadBytes(offset_ + kTypeSize);
+}
+
+size_t BinaryValueView::size() const {
+  size_t entry_size;
+  if (type() == Value::Type::DICTIONARY)
+    entry_size = kDictEntrySize;
+  else if (type() == Value::Type::LIST)
+    entry_size = kListEntrySize;
+  else
+    return 0;
+  absl::optional<uint32_t> count = ReadUint32(offset_ + kTypeSize);
+  // The table must be in bounds.
+  if (!count ||
+      *count > (data_.size() - offset_ - kContainerHeaderSize) / entry_size) {
+    return 0;
+  }
+  return *count;
+}
+
+absl::optional<BinaryValueView> BinaryValueView::FindKey(
+    StringPiece key) const {
+  if (type() != Value::Type::DICTIONARY)
+    return absl::nullopt;
+  size_t begin = 0;
+  size_t end = size();
+  while (begin < end) {
+    const size_t middle = begin + (end - begin) / 2;
+    absl::optional<StringPiece> middle_key = GetDictKey(middle);
+    if (!middle_key)
+      return absl::nullopt;
+    if (*middle_key == key)
+      return GetDictValue(middle);
+    if (*middle_key < key)
+      begin = middle + 1;
+    else
+      end = middle;
+  }
+  return absl::nullopt;
+}
+
+absl::optional<BinaryValueView> BinaryValueView::FindPath(
+    StringPiece path) const {
+  absl::optional<BinaryValueView> current = *this;
+  while (current) {
+    const size_t separator = path.find('.');
+    if (separator == StringPiece::npos)
+      return current->FindKey(path);
+    current = current->FindKey(path.substr(0, separator));
+    path = path.substr(separator + 1);
+  }
+  return absl::nullopt;
+}
+
+absl::optional<StringPiece> BinaryValueView::GetDictKey(size_t index) const {
+  if (type() != Value::Type::DICTIONARY)
+    return absl::nullopt;
+  absl::optional<size_t> entry = GetEntryOffset(index, kDictEntrySize);
+  if (!entry)
+    return absl::nullopt;
+  absl::optional<uint32_t> key_offset = ReadUint32(*entry);
+  if (!key_offset || *key_offset <= offset_)
+    return absl::nullopt;
+  absl::optional<span<const uint8_t>> bytes = ReadBytes(*key_offset);
+  if (!bytes)
+    return absl::nullopt;
+  return StringPiece(reinterpret_cast<const char*>(bytes->data()),
+                     bytes->size());
+}
+
+absl::optional<BinaryValueView> BinaryValueView::GetDictValue(
+    size_t index) const {
+  if (type() != Value::Type::DICTIONARY)
+    return absl::nullopt;
+  absl::optional<size_t> entry = GetEntryOffset(index, kDictEntrySize);
+  if (!entry)
+    return absl::nullopt;
+  return GetChild(*entry + sizeof(uint32_t));
+}
+
+absl::optional<BinaryValueView> BinaryValueView::GetListItem(
+    size_t index) const {
+  if (type() != Value::Type::LIST)
+    return absl::nullopt;
+  absl::optional<size_t> entry = GetEntryOffset(index, kListEntrySize);
+  if (!entry)
+    return absl::nullopt;
+  return GetChild(*entry);
+}
+
+absl::optional<Value> BinaryValueView::ToValue() const {
+  absl::optional<Value::Type> value_type = type();
+  if (!value_type)
+    return absl::nullopt;
+  switch (*value_type) {
+    case Value::Type::NONE:
+      return Value();
+    case Value::Type::BOOLEAN: {
+      absl::optional<bool> value = GetIfBool();
+      if (!value)
+        return absl::nullopt;
+      return Value(*value);
+    }
+    case Value::Type::INTEGER: {
+      absl::optional<int> value = GetIfInt();
+      if (!value)
+        return absl::nullopt;
+      return Value(*value);
+    }
+    case Value::Type::DOUBLE: {
+      absl::optional<double> value = GetIfDouble();
+      if (!value)
+        return absl::nullopt;
+      return Value(*value);
+    }
+    case Value::Type::STRING: {
+      absl::optional<StringPiece> value = GetIfString();
+      if (!value)
+        return absl::nullopt;
+      return Value(*value);
+    }
+    case Value::Type::BINARY: {
+      absl::optional<span<const uint8_t>> value = GetIfBlob();
+      if (!value)
+        return absl::nullopt;
+      return Value(*value);
+    }
+    case Value::Type::DICTIONARY: {
+      Value::Dict dict;
+      for (size_t i = 0; i < size(); ++i) {
+        absl::optional<StringPiece> key = GetDictKey(i);
+        absl::optional<BinaryValueView> view = GetDictValue(i);
+        absl::optional<Value> value = view ? view->ToValue() : absl::nullopt;
+        if (!key || !value)
+          return absl::nullopt;
+        dict.Set(*key, std::move(*value));
+      }
+      return Value(std::move(dict));
+    }
+    case Value::Type::LIST: {
+      Value::List list;
+      for (size_t i = 0; i < size(); ++i) {
+        absl::optional<BinaryValueView> view = GetListItem(i);
+        absl::optional<Value> value = view ? view->ToValue() : absl::nullopt;
+        if (!value)
+          return absl::nullopt;
+        list.Append(std::move(*value));
+      }
+      return Value(std::move(list));
+    }
+  }
+  return absl::nullopt;
+}
+
+absl::optional<size_t> BinaryValueView::GetEntryOffset(
+    size_t index,
+    size_t entry_size) const {
+  if (index >= size())
+    return absl::nullopt;
+  return offset_ + kContainerHeaderSize + index * entry_size;
+}
+
+absl::optional<BinaryValueView> BinaryValueView::GetChild(
+    size_t entry_offset) const {
+  absl::optional<uint32_t> offset = ReadUint32(entry_offset);
+  // The offsets pointing backward could make cycles.
+  if (!offset || *offset <= offset_ || *offset >= data_.size() ||
+      depth_ + 1 >= internal::kAbsoluteMaxDepth) {
+    return absl::nullopt;
+  }
+  return BinaryValueView(data_, *offset, depth_ + 1);
+}
+
+absl::optional<uint32_t> BinaryValueView::ReadUint32(size_t offset) const {
+  uint32_t value;
+  if (offset > data_.size() || data_.size() - offset < sizeof(value))
+    return absl::nullopt;
+  memcpy(&value, data_.data() + offset, sizeof(value));
+  return ByteSwapToLE32(value);
+}
+
+absl::optional<uint64_t> BinaryValueView::ReadUint64(size_t offset) const {
+  uint64_t value;
+  if (offset > data_.size() || data_.size() - offset < sizeof(value))
+    return absl::nullopt;
+  memcpy(&value, data_.data() + offset, sizeof(value));
+  return ByteSwapToLE64(value);
+}
+
+absl::optional<span<const uint8_t>> BinaryValueView::ReadBytes(
+    size_t offset) const {
+  absl::optional<uint32_t> size = ReadUint32(offset);
+  if (!size || data_.size() - offset - sizeof(uint32_t) < *size)
+    return absl::nullopt;
+  return data_.subspan(offset + sizeof(uint32_t), *size);
+}
+
+// static
+std::unique_ptr<BinaryValueReader> BinaryValueReader::Create(
+    span<const uint8_t> data) {
+  if (!HasHeader(data))
+    return nullptr;
+  return WrapUnique(new BinaryValueReader(data, nullptr));
+}
+
+// static
+std::unique_ptr<BinaryValueReader> BinaryValueReader::Open(
+    const FilePath& path) {
+  auto file = std::make_unique<MemoryMappedFile>();
+  if (!file->Initialize(path))
+    return nullptr;
+  const span<const uint8_t> data(file->data(), file->length());
+  if (!HasHeader(data))
+    return nullptr;
+  return WrapUnique(new BinaryValueReader(data, std::move(file)));
+}
+
+BinaryValueReader::BinaryValueReader(span<const uint8_t> data,
+                                     std::unique_ptr<MemoryMappedFile> file)
+    : data_(data), file_(std::move(file)) {}
+
+BinaryValueReader::~BinaryValueReader() = default;
+
+BinaryValueView BinaryValueReader::root() const {
+  return BinaryValueView(data_, kHeaderSize, 0);
+}
+
+// static
+bool BinaryValueReader::HasHeader(span<const uint8_t> data) {
+  uint32_t version;
+  if (data.size() < kHeaderSize ||
+      memcmp(data.data(), kMagic, sizeof(kMagic)) != 0) {
+    return false;
+  }
+  memcpy(&version, data.data() + sizeof(kMagic), sizeof(version));
+  return ByteSwapToLE32(version) == kVersion;
+}
+
+}  // namespace base
@@ -0,0 +1,175 @@
+// Copyright 2022 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#ifndef BASE_BINARY_VALUE_SERIALIZER_H_
+#define BASE_BINARY_VALUE_SERIALIZER_H_
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include <memory>
+#include <string>
+
+#include "base/base_export.h"
+#include "base/containers/span.h"
+#include "base/files/memory_mapped_file.h"
+#include "base/memory/raw_ptr.h"
+#include "base/strings/string_piece.h"
+#include "base/values.h"
+#include "third_party/abseil-cpp/absl/types/optional.h"
+
+namespace base {
+
+class FilePath;
+
+// A compact binary encoding of Values, which, unlike JSON, can be read lazily:
+// the items of dictionaries and lists are found through offset tables, so
+// that a lookup only touches the bytes on its path. Mapping a file with
+// BinaryValueReader thus only pages in what is read.
+//
+// The encoding starts with a header, the magic "BVAL" and a version as a
+// uint32_t, followed by the root value. Integers are little-endian. A value
+// is its Value::Type as a uint8_t, followed by:
+//   - NONE: nothing.
+//   - BOOLEAN: a uint8_t, 0 or 1.
+//   - INTEGER: an int32_t.
+//   - DOUBLE: the 8 bytes of the double.
+//   - STRING and BINARY: a uint32_t size, and the bytes.
+//   - DICTIONARY: a uint32_t count, and as many pairs of uint32_t offsets of
+//     the keys and the values, sorted by key. A key is a uint32_t size, and
+//     the bytes.
+//   - LIST: a uint32_t count, and as many uint32_t offsets of the items.
+// The offsets are from the start of the encoding, and always point forward
+// from the dictionary or the list, so that there can't be cycles.
+class BASE_EXPORT BinaryValueSerializer : public ValueSerializer {
+ public:
+  // |output| must outlive the serializer.
+  explicit BinaryValueSerializer(std::string* output);
+
+  BinaryValueSerializer(const BinaryValueSerializer&) = delete;
+  BinaryValueSerializer& operator=(const BinaryValueSerializer&) = delete;
+
+  ~BinaryValueSerializer() override;
+
+  // Overwrites the output with the encoding of |root|. Returns false if it
+  // would be larger than 4GB.
+  bool Serialize(ValueView root) override;
+
+ private:
+  const raw_ptr<std::string> output_;
+};
+
+// Decodes all of an encoding into a Value.
+class BASE_EXPORT BinaryValueDeserializer : public ValueDeserializer {
+ public:
+  // |data| must outlive the deserializer.
+  explicit BinaryValueDeserializer(span<const uint8_t> data);
+
+  BinaryValueDeserializer(const BinaryValueDeserializer&) = delete;
+  BinaryValueDeserializer& operator=(const BinaryValueDeserializer&) = delete;
+
+  ~BinaryValueDeserializer() override;
+
+  // Returns nullptr, with kErrorCodeInvalidFormat, if |data| is not a valid
+  // encoding.
+  std::unique_ptr<Value> Deserialize(int* error_code,
+                                     std::string* error_message) override;
+
+ private:
+  const span<const uint8_t> data_;
+};
+
+// A read-only view of a value of an encoding, valid as long as the encoding.
+// The encoding is validated as it's read: the accessors of a malformed value
+// return nullopt, or 0 for size().
+class BASE_EXPORT BinaryValueView {
+ public:
+  BinaryValueView(const BinaryValueView&) = default;
+  BinaryValueView& operator=(const BinaryValueView&) = default;
+
+  // Returns nullopt if the type of the value is invalid.
+  absl::optional<Value::Type> type() const;
+
+  absl::optional<bool> GetIfBool() const;
+  absl::optional<int> GetIfInt() const;
+  // As in Value, this also converts ints.
+  absl::optional<double> GetIfDouble() const;
+  absl::optional<StringPiece> GetIfString() const;
+  absl::optional<span<const uint8_t>> GetIfBlob() const;
+
+  // The number of items of a dictionary or a list, 0 otherwise.
+  size_t size() const;
+
+  // Returns the value of |key| if this is a dictionary, with a binary search.
+  absl::optional<BinaryValueView> FindKey(StringPiece key) const;
+
+  // Returns the value at the dotted |path| of keys, as Value::FindPath().
+  absl::optional<BinaryValueView> FindPath(StringPiece path) const;
+
+  // Returns the item of a dictionary, with its key, or of a list at |index|.
+  absl::optional<StringPiece> GetDictKey(size_t index) const;
+  absl::optional<BinaryValueView> GetDictValue(size_t index) const;
+  absl::optional<BinaryValueView> GetListItem(size_t index) const;
+
+  // Decodes the value and its items into a Value. Returns nullopt if they
+  // are malformed.
+  absl::optional<Value> ToValue() const;
+
+ private:
+  friend class BinaryValueReader;
+
+  BinaryValueView(span<const uint8_t> data, size_t offset, size_t depth)
+      : data_(data), offset_(offset), depth_(depth) {}
+
+  // Returns the offset of the |index|-th entry, of |entry_size| bytes, of the
+  // table of this dictionary or list, if it's in bounds.
+  absl::optional<size_t> GetEntryOffset(size_t index, size_t entry_size) const;
+  // Returns the view of the value whose offset is at |entry_offset|, if it's
+  // valid.
+  absl::optional<BinaryValueView> GetChild(size_t entry_offset) const;
+
+  absl::optional<uint32_t> ReadUint32(size_t offset) const;
+  absl::optional<uint64_t> ReadUint64(size_t offset) const;
+  // Reads the size, and the bytes, at |offset|.
+  absl::optional<span<const uint8_t>> ReadBytes(size_t offset) const;
+
+  span<const uint8_t> data_;
+  size_t offset_;
+  // The nesting depth of the value, which is bounded.
+  size_t depth_;
+};
+
+// Reads an encoding lazily, from memory or from a memory-mapped file.
+class BASE_EXPORT BinaryValueReader {
+ public:
+  // |data| must outlive the reader. Returns nullptr if |data| doesn't start
+  // with the header.
+  static std::unique_ptr<BinaryValueReader> Create(span<const uint8_t> data);
+
+  // Maps the file at |path|. Returns nullptr if it can't be mapped, or if it
+  // doesn't start with the header.
+  static std::unique_ptr<BinaryValueReader> Open(const FilePath& path);
+
+  BinaryValueReader(const BinaryValueReader&) = delete;
+  BinaryValueReader& operator=(const BinaryValueReader&) = delete;
+
+  ~BinaryValueReader();
+
+  BinaryValueView root() const;
+
+ private:
+  BinaryValueReader(span<const uint8_t> data,
+                    std::unique_ptr<MemoryMappedFile> file);
+
+  // Returns whether |data| starts with the header.
+  static bool HasHeader(span<const uint8_t> data);
+
+  const span<const uint8_t> data_;
+  // Set if the reader maps its file.
+  const std::unique_ptr<MemoryMappedFile> file_;
+};
+
+}  // namespace base
+
+#endif  // BASE_BINARY_VALUE_SERIALIZER_H_
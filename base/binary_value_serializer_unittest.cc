@@ -0,0 +1,222 @@
+// Copyright 2022 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "base/binary_value_serializer.h"
+
+#include <string>
+#include <vector>
+
+#include "base/files/file_path.h"
+#include "base/files/file_util.h"
+#include "base/files/scoped_temp_dir.h"
+#include "base/json/json_reader.h"
+#include "base/values.h"
+#include "testing/gtest/include/gtest/gtest.h"
+#include "third_party/abseil-cpp/absl/types/optional.h"
+
+namespace base {
+
+namespace {
+
+// The offset of the root value, after the header.
+constexpr size_t kRootOffset = 8;
+
+std::string Serialize(const Value& value) {
+  std::string output;
+  BinaryValueSerializer serializer(&output);
+  EXPECT_TRUE(serializer.Serialize(value));
+  return output;
+}
+
+span<const uint8_t> AsBytes(const std::string& string) {
+  return as_bytes(make_span(string));
+}
+
+std::unique_ptr<Value> Deserialize(const std::string& data) {
+  BinaryValueDeserializer deserializer(AsBytes(data));
+  return deserializer.Deserialize(nullptr, nullptr);
+}
+
+Value ParseJSON(StringPiece json) {
+  absl::optional<Value> value = JSONReader::Read(json);
+  EXPECT_TRUE(value);
+  return value ? std::move(*value) : Value();
+}
+
+}  // namespace
+
+TEST(BinaryValueSerializerTest, RoundTrip) {
+  Value::Dict dict;
+  dict.Set("none", Value());
+  dict.Set("bool", true);
+  dict.Set("int", -42);
+  dict.Set("double", 4.5);
+  dict.Set("string", "foo");
+  dict.Set("empty", "");
+  dict.Set("binary", Value(Value::BlobStorage({0, 1, 2, 255})));
+  dict.Set("dict", ParseJSON(R"({"a": {"b": [1, 2]}, "c": {}})"));
+  dict.Set("list", ParseJSON(R"([1, "two", [3.5, null], [], {"x": false}])"));
+  const Value value(std::move(dict));
+
+  int error_code = -1;
+  std::string error_message;
+  const std::string data = Serialize(value);
+  BinaryValueDeserializer deserializer(AsBytes(data));
+  std::unique_ptr<Value> result =
+      deserializer.Deserialize(&error_code, &error_message);
+  ASSERT_TRUE(result);
+  EXPECT_EQ(value, *result);
+  EXPECT_EQ(ValueDeserializer::kErrorCodeNoError, error_code);
+  EXPECT_TRUE(error_message.empty());
+
+  for (const Value& scalar :
+       {Value(), Value(false), Value(7), Value(-0.0), Value("bar")}) {
+    result = Deserialize(Serialize(scalar));
+    ASSERT_TRUE(result);
+    EXPECT_EQ(scalar, *result);
+  }
+}
+
+TEST(BinaryValueSerializerTest, Views) {
+  const std::string data = Serialize(ParseJSON(
+      R"({"b": true, "i": 42, "d": 2.5, "s": "str", "n": null,)"
+      R"( "list": [1, "two", [3]], "dict": {"a": {"b": 7}}})"));
+  std::unique_ptr<BinaryValueReader> reader =
+      BinaryValueReader::Create(AsBytes(data));
+  ASSERT_TRUE(reader);
+  BinaryValueView root = reader->root();
+  EXPECT_EQ(Value::Type::DICTIONARY, root.type());
+  EXPECT_EQ(7u, root.size());
+
+  EXPECT_EQ(true, root.FindKey("b")->GetIfBool());
+  EXPECT_EQ(42, root.FindKey("i")->GetIfInt());
+  EXPECT_EQ(42.0, root.FindKey("i")->GetIfDouble());
+  EXPECT_EQ(2.5, root.FindKey("d")->GetIfDouble());
+  EXPECT_FALSE(root.FindKey("d")->GetIfInt());
+  EXPECT_EQ("str", root.FindKey("s")->GetIfString());
+  EXPECT_EQ(Value::Type::NONE, root.FindKey("n")->type());
+  EXPECT_FALSE(root.FindKey("missing"));
+  EXPECT_FALSE(root.FindKey("s")->FindKey("s"));
+
+  // The keys are sorted.
+  EXPECT_EQ("b", root.GetDictKey(0));
+  EXPECT_EQ("s", root.GetDictKey(6));
+  EXPECT_FALSE(root.GetDictKey(7));
+  EXPECT_EQ(true, root.GetDictValue(0)->GetIfBool());
+
+  absl::optional<BinaryValueView> list = root.FindKey("list");
+  ASSERT_TRUE(list);
+  EXPECT_EQ(3u, list->size());
+  EXPECT_EQ(1, list->GetListItem(0)->GetIfInt());
+  EXPECT_EQ("two", list->GetListItem(1)->GetIfString());
+  EXPECT_EQ(3, list->GetListItem(2)->GetListItem(0)->GetIfInt());
+  EXPECT_FALSE(list->GetListItem(3));
+  EXPECT_FALSE(list->FindKey("a"));
+
+  EXPECT_EQ(7, root.FindPath("dict.a.b")->GetIfInt());
+  EXPECT_FALSE(root.FindPath("dict.a.c"));
+  EXPECT_FALSE(root.FindPath("dict.b.a"));
+
+  EXPECT_EQ(*Deserialize(data), root.ToValue());
+}
+
+TEST(BinaryValueSerializerTest, InvalidHeader) {
+  std::string data = Serialize(Value(1));
+  EXPECT_FALSE(BinaryValueReader::Create(AsBytes(data).first(7)));
+  data[0] = 'X';
+  EXPECT_FALSE(BinaryValueReader::Create(AsBytes(data)));
+
+  data = Serialize(Value(1));
+  data[4] = 2;
+  int error_code = -1;
+  std::string error_message;
+  BinaryValueDeserializer deserializer(AsBytes(data));
+  EXPECT_FALSE(deserializer.Deserialize(&error_code, &error_message));
+  EXPECT_EQ(ValueDeserializer::kErrorCodeInvalidFormat, error_code);
+  EXPECT_FALSE(error_message.empty());
+}
+
+TEST(BinaryValueSerializerTest, Truncated) {
+  const std::string data =
+      Serialize(ParseJSON(R"({"a": [1, 2.5, "three"], "b": {"c": true}})"));
+  // All the prefixes are invalid, and are read safely.
+  for (size_t size = 0; size < data.size(); ++size) {
+    const std::string prefix = data.substr(0, size);
+    EXPECT_FALSE(Deserialize(prefix)) << size;
+    std::unique_ptr<BinaryValueReader> reader =
+        BinaryValueReader::Create(AsBytes(prefix));
+    if (!reader)
+      continue;
+    absl::optional<BinaryValueView> c = reader->root().FindPath("b.c");
+    EXPECT_FALSE(c && c->GetIfBool()) << size;
+  }
+}
+
+TEST(BinaryValueSerializerTest, Corrupt) {
+  const std::string data = Serialize(ParseJSON(R"([[1], "two"])"));
+  ASSERT_TRUE(Deserialize(data));
+
+  // An invalid type.
+  std::string corrupt = data;
+  corrupt[kRootOffset] = 42;
+  EXPECT_FALSE(Deserialize(corrupt));
+
+  // A count larger than the table.
+  corrupt = data;
+  corrupt[kRootOffset + 1] = 100;
+  EXPECT_FALSE(Deserialize(corrupt));
+  std::unique_ptr<BinaryValueReader> reader =
+      BinaryValueReader::Create(AsBytes(corrupt));
+  ASSERT_TRUE(reader);
+  EXPECT_EQ(0u, reader->root().size());
+
+  // An offset pointing backward, to the list itself, which would be a cycle.
+  corrupt = data;
+  corrupt[kRootOffset + 5] = kRootOffset;
+  corrupt[kRootOffset + 6] = 0;
+  corrupt[kRootOffset + 7] = 0;
+  corrupt[kRootOffset + 8] = 0;
+  EXPECT_FALSE(Deserialize(corrupt));
+  reader = BinaryValueReader::Create(AsBytes(corrupt));
+  ASSERT_TRUE(reader);
+  EXPECT_FALSE(reader->root().GetListItem(0));
+  // The other item is still readable.
+  EXPECT_EQ("two", reader->root().GetListItem(1)->GetIfString());
+
+  // An offset past the end.
+  corrupt = data;
+  corrupt[kRootOffset + 8] = 1;
+  EXPECT_FALSE(Deserialize(corrupt));
+}
+
+TEST(BinaryValueSerializerTest, TooDeep) {
+  Value value;
+  for (int i = 0; i < 300; ++i) {
+    Value::List list;
+    list.Append(std::move(value));
+    value = Value(std::move(list));
+  }
+  std::string output;
+  BinaryValueSerializer serializer(&output);
+  EXPECT_FALSE(serializer.Serialize(value));
+}
+
+TEST(BinaryValueSerializerTest, Open) {
+  ScopedTempDir temp_dir;
+  ASSERT_TRUE(temp_dir.CreateUniqueTempDir());
+  const FilePath path = temp_dir.GetPath().AppendASCII("values.bin");
+  ASSERT_TRUE(
+      WriteFile(path, Serialize(ParseJSON(R"({"a": {"b": "value"}})"))));
+
+  std::unique_ptr<BinaryValueReader> reader = BinaryValueReader::Open(path);
+  ASSERT_TRUE(reader);
+  EXPECT_EQ("value", reader->root().FindPath("a.b")->GetIfString());
+
+  EXPECT_FALSE(BinaryValueReader::Open(temp_dir.GetPath().AppendASCII("x")));
+  const FilePath invalid = temp_dir.GetPath().AppendASCII("invalid.bin");
+  ASSERT_TRUE(WriteFile(invalid, "not an encoding"));
+  EXPECT_FALSE(BinaryValueReader::Open(invalid));
+}
+
+}  // namespace base
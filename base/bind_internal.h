@@ -9,6 +9,7 @@
 
 #include <functional>
 #include <memory>
+#include <new>
 #include <tuple>
 #include <type_traits>
 #include <utility>
@@ -977,6 +978,20 @@ struct BindState final : BindStateBase {
 
   ~BindState() = default;
 
+  // See AllocateBindState(). The over-aligned BindStates aren't pooled.
+  static void* operator new(size_t size) { return AllocateBindState(size); }
+  static void* operator new(size_t size, std::align_val_t alignment) {
+    return ::operator new(size, alignment);
+  }
+  static void operator delete(void* bind_state, size_t size) {
+    FreeBindState(bind_state, size);
+  }
+  static void operator delete(void* bind_state,
+                              size_t size,
+                              std::align_val_t alignment) {
+    ::operator delete(bind_state, alignment);
+  }
+
   static void Destroy(const BindStateBase* self) {
     delete static_cast<const BindState*>(self);
   }
@@ -4,8 +4,17 @@
 
 #include "base/callback_internal.h"
 
+#include <stdint.h>
+
+#include <iterator>
+#include <new>
+
 #include "base/check.h"
+#include "base/compiler_specific.h"
+#include "base/memory/object_pool.h"
+#include "base/no_destructor.h"
 #include "base/notreached.h"
+#include "base/threading/thread_local_storage.h"
 
 namespace base {
 namespace internal {
@@ -24,8 +33,116 @@ bool QueryCancellationTraitsForNonCancellables(
   NOTREACHED();
 }
 
+// The size classes of the pooled BindStates. A BindStateBase takes 32 bytes on
+// 64-bit platforms, so the first one fits a function and up to three pointers.
+constexpr size_t kSizeClasses[] = {64, 128};
+constexpr size_t kSizeClassCount = std::size(kSizeClasses);
+
+// The full magazines kept by each pool for the threads, beyond those which the
+// threads hold.
+constexpr size_t kMaxDepotMagazines = 32;
+
+// Returns the pool of the size class |size_class|. The pools are created on
+// first use, and never destroyed. They exchange the BindStates between the
+// threads which bind callbacks and those which run them.
+ObjectPoolBase* GetBindStatePool(size_t size_class) {
+  if (size_class == 0) {
+    static NoDestructor<ObjectPoolBase> pool("bind_state_64", kSizeClasses[0],
+                                             kMaxDepotMagazines);
+    return pool.get();
+  }
+  static NoDestructor<ObjectPoolBase> pool("bind_state_128", kSizeClasses[1],
+                                           kMaxDepotMagazines);
+  return pool.get();
+}
+
+// The last BindStates freed by a thread, which its next Bind()s reuse without
+// going to the pools, whose thread caches cost a ThreadLocalStorage lookup.
+// It's trivially destructible, as thread_local variables must be, so a
+// ThreadLocalStorage::Slot returns its BindStates to the pools when the thread
+// exits.
+struct ThreadBindStateCache {
+  static constexpr size_t kCapacity = 16;
+
+  enum State : uint8_t {
+    // The slot isn't set yet, so the freed BindStates go to the pools.
+    kUnregistered,
+    kRegistered,
+    // The slot was destroyed, and won't be set again by the thread.
+    kExited,
+  };
+
+  State state;
+  size_t counts[kSizeClassCount];
+  void* bind_states[kSizeClassCount][kCapacity];
+};
+
+thread_local ThreadBindStateCache g_thread_bind_state_cache;
+
+void OnThreadExit(void* value) {
+  auto* cache = static_cast<ThreadBindStateCache*>(value);
+  cache->state = ThreadBindStateCache::kExited;
+  for (size_t i = 0; i < kSizeClassCount; ++i) {
+    while (cache->counts[i])
+      GetBindStatePool(i)->FreeSlot(cache->bind_states[i][--cache->counts[i]]);
+  }
+}
+
+ThreadLocalStorage::Slot& GetThreadExitSlot() {
+  static NoDestructor<ThreadLocalStorage::Slot> slot(&OnThreadExit);
+  return *slot;
+}
+
+// Returns the size class of the BindStates of |size| bytes, or
+// kSizeClassCount if they're too large to pool.
+size_t GetSizeClass(size_t size) {
+  if (size <= kSizeClasses[0])
+    return 0;
+  return size <= kSizeClasses[1] ? 1 : kSizeClassCount;
+}
+
+NOINLINE void* AllocateBindStateFromPool(size_t size_class) {
+  ThreadBindStateCache& cache = g_thread_bind_state_cache;
+  if (cache.state == ThreadBindStateCache::kUnregistered) {
+    cache.state = ThreadBindStateCache::kRegistered;
+    GetThreadExitSlot().Set(&cache);
+  }
+  return GetBindStatePool(size_class)->AllocSlot();
+}
+
 }  // namespace
 
+void* AllocateBindState(size_t size) {
+  // ASan finds the uses of freed BindStates only if they're really freed.
+#if !defined(ADDRESS_SANITIZER)
+  const size_t size_class = GetSizeClass(size);
+  if (size_class < kSizeClassCount) {
+    ThreadBindStateCache& cache = g_thread_bind_state_cache;
+    if (LIKELY(cache.counts[size_class]))
+      return cache.bind_states[size_class][--cache.counts[size_class]];
+    return AllocateBindStateFromPool(size_class);
+  }
+#endif
+  return ::operator new(size);
+}
+
+void FreeBindState(void* bind_state, size_t size) {
+#if !defined(ADDRESS_SANITIZER)
+  const size_t size_class = GetSizeClass(size);
+  if (size_class < kSizeClassCount) {
+    ThreadBindStateCache& cache = g_thread_bind_state_cache;
+    if (LIKELY(cache.state == ThreadBindStateCache::kRegistered &&
+               cache.counts[size_class] < ThreadBindStateCache::kCapacity)) {
+      cache.bind_states[size_class][cache.counts[size_class]++] = bind_state;
+      return;
+    }
+    GetBindStatePool(size_class)->FreeSlot(bind_state);
+    return;
+  }
+#endif
+  ::operator delete(bind_state);
+}
+
 void BindStateBaseRefCountTraits::Destruct(const BindStateBase* bind_state) {
   bind_state->destructor_(bind_state);
 }
@@ -8,6 +8,8 @@
 #ifndef BASE_CALLBACK_INTERNAL_H_
 #define BASE_CALLBACK_INTERNAL_H_
 
+#include <stddef.h>
+
 #include <utility>
 
 #include "base/base_export.h"
@@ -37,6 +39,12 @@ struct BindStateBaseRefCountTraits {
   static void Destruct(const BindStateBase*);
 };
 
+// Allocate and free the memory of the BindStates. The small ones, of a
+// function or a method bound to a few pointers, are recycled by per-size-class
+// pools with per-thread caches, rather than malloc()ed at each Bind().
+BASE_EXPORT void* AllocateBindState(size_t size);
+BASE_EXPORT void FreeBindState(void* bind_state, size_t size);
+
 template <typename T>
 using PassingType = std::conditional_t<std::is_scalar_v<T>, T, T&&>;
 
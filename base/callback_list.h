@@ -80,6 +80,9 @@ class OnceCallbackList;
 template <typename Signature>
 class RepeatingCallbackList;
 
+template <typename Signature>
+class FlatRepeatingCallbackList;
+
 // A trimmed-down version of ScopedClosureRunner that can be used to guarantee a
 // closure is run on destruction. This is designed to be used by
 // CallbackListBase to run CancelCallback() when this subscription dies;
@@ -99,6 +102,8 @@ class [[nodiscard]] BASE_EXPORT CallbackListSubscription {
  private:
   template <typename T>
   friend class internal::CallbackListBase;
+  template <typename Signature>
+  friend class FlatRepeatingCallbackList;
 
   explicit CallbackListSubscription(base::OnceClosure closure);
 
@@ -726,6 +726,42 @@ TEST_F(CallbackTest, MaybeValidInvalidateWeakPtrsOnOtherSequence) {
   // run.
 }
 
+const int* AddressOf(const int& bound_arg) {
+  return &bound_arg;
+}
+
+#if !defined(ADDRESS_SANITIZER)
+TEST_F(CallbackTest, SmallBindStatesAreRecycled) {
+  // The bound argument lives in the BindState, whose memory goes back to the
+  // pool when the callback is run, and is reused by the next one.
+  const int* address = BindOnce(&AddressOf, 1).Run();
+  EXPECT_EQ(address, BindOnce(&AddressOf, 2).Run());
+}
+#endif
+
+TEST_F(CallbackTest, LargeAndOverAlignedBindStates) {
+  struct Large {
+    int values[100];
+  };
+  Large large = {};
+  large.values[99] = 42;
+  RepeatingCallback<int()> large_cb = BindRepeating(
+      [](const Large& large) { return large.values[99]; }, large);
+  RepeatingCallback<int()> copy = large_cb;
+  large_cb.Reset();
+  EXPECT_EQ(42, copy.Run());
+
+  struct alignas(128) OverAligned {
+    int value;
+  };
+  OnceCallback<uintptr_t()> aligned_cb = BindOnce(
+      [](const OverAligned& aligned) {
+        return reinterpret_cast<uintptr_t>(&aligned);
+      },
+      OverAligned{1});
+  EXPECT_EQ(0u, std::move(aligned_cb).Run() % 128);
+}
+
 class CallbackOwner : public base::RefCounted<CallbackOwner> {
  public:
   explicit CallbackOwner(bool* deleted) {
@@ -6,13 +6,15 @@
 
 #include <ostream>
 
-#include "base/containers/contains.h"
 #include "base/containers/span.h"
 #include "base/files/file_path.h"
+#include "base/hash/hash.h"
 #include "base/logging.h"
 #include "base/notreached.h"
+#include "base/numerics/safe_conversions.h"
 #include "base/ranges/algorithm.h"
 #include "base/strings/strcat.h"
+#include "base/strings/string_number_conversions.h"
 #include "base/strings/string_piece.h"
 #include "base/strings/string_split.h"
 #include "base/strings/string_tokenizer.h"
@@ -156,6 +158,18 @@ std::wstring QuoteForCommandLineToArgvW(const std::wstring& arg,
 }
 #endif  // BUILDFLAG(IS_WIN)
 
+absl::optional<int64_t> ParseSwitchValueAsInt64(
+    CommandLine::StringPieceType value) {
+  int64_t result;
+#if BUILDFLAG(IS_WIN)
+  if (!StringToInt64(AsStringPiece16(value), &result))
+#elif BUILDFLAG(IS_POSIX) || BUILDFLAG(IS_FUCHSIA)
+  if (!StringToInt64(value, &result))
+#endif
+    return absl::nullopt;
+  return result;
+}
+
 }  // namespace
 
 // static
@@ -184,9 +198,32 @@ CommandLine::CommandLine(const StringVector& argv)
   InitFromArgv(argv);
 }
 
-CommandLine::CommandLine(const CommandLine& other) = default;
+CommandLine::CommandLine(const CommandLine& other)
+    : argv_(other.argv_),
+      switches_(other.switches_),
+      begin_args_(other.begin_args_) {
+#if BUILDFLAG(IS_WIN)
+  raw_command_line_string_ = other.raw_command_line_string_;
+#endif
+  // |switch_index_| points into |switches_|, so isn't copied but rebuilt.
+  for (auto it = switches_.begin(); it != switches_.end(); ++it)
+    IndexSwitch(it);
+}
 
-CommandLine& CommandLine::operator=(const CommandLine& other) = default;
+CommandLine& CommandLine::operator=(const CommandLine& other) {
+  if (this == &other)
+    return *this;
+#if BUILDFLAG(IS_WIN)
+  raw_command_line_string_ = other.raw_command_line_string_;
+#endif
+  argv_ = other.argv_;
+  switch_index_.clear();
+  switches_ = other.switches_;
+  begin_args_ = other.begin_args_;
+  for (auto it = switches_.begin(); it != switches_.end(); ++it)
+    IndexSwitch(it);
+  return *this;
+}
 
 CommandLine::~CommandLine() = default;
 
@@ -269,6 +306,7 @@ void CommandLine::InitFromArgv(int argc,
 
 void CommandLine::InitFromArgv(const StringVector& argv) {
   argv_ = StringVector(1);
+  switch_index_.clear();
   switches_.clear();
   begin_args_ = 1;
   SetProgram(argv.empty() ? FilePath() : FilePath(argv[0]));
@@ -290,8 +328,7 @@ void CommandLine::SetProgram(const FilePath& program) {
 }
 
 bool CommandLine::HasSwitch(StringPiece switch_string) const {
-  DCHECK_EQ(ToLowerASCII(switch_string), switch_string);
-  return Contains(switches_, switch_string);
+  return FindSwitch(switch_string) != nullptr;
 }
 
 bool CommandLine::HasSwitch(const char switch_constant[]) const {
@@ -321,9 +358,22 @@ FilePath CommandLine::GetSwitchValuePath(StringPiece switch_string) const {
 
 CommandLine::StringType CommandLine::GetSwitchValueNative(
     StringPiece switch_string) const {
-  DCHECK_EQ(ToLowerASCII(switch_string), switch_string);
-  auto result = switches_.find(switch_string);
-  return result == switches_.end() ? StringType() : result->second;
+  const IndexedSwitch* indexed_switch = FindSwitch(switch_string);
+  return indexed_switch ? *indexed_switch->value : StringType();
+}
+
+absl::optional<int> CommandLine::GetSwitchValueInt(
+    StringPiece switch_string) const {
+  absl::optional<int64_t> value = GetSwitchValueInt64(switch_string);
+  if (!value || !IsValueInRangeForNumericType<int>(*value))
+    return absl::nullopt;
+  return static_cast<int>(*value);
+}
+
+absl::optional<int64_t> CommandLine::GetSwitchValueInt64(
+    StringPiece switch_string) const {
+  const IndexedSwitch* indexed_switch = FindSwitch(switch_string);
+  return indexed_switch ? indexed_switch->int_value : absl::nullopt;
 }
 
 void CommandLine::AppendSwitch(StringPiece switch_string) {
@@ -346,12 +396,13 @@ void CommandLine::AppendSwitchNative(StringPiece switch_string,
 #endif
   size_t prefix_length = GetSwitchPrefixLength(combined_switch_string);
   auto key = switch_key.substr(prefix_length);
+  auto it = switches_.try_emplace(std::string(key)).first;
   if (g_duplicate_switch_handler) {
-    g_duplicate_switch_handler->ResolveDuplicate(key, value,
-                                                 switches_[std::string(key)]);
+    g_duplicate_switch_handler->ResolveDuplicate(key, value, it->second);
   } else {
-    switches_[std::string(key)] = StringType(value);
+    it->second = StringType(value);
   }
+  IndexSwitch(it);
 
   // Preserve existing switch prefixes in |argv_|; only append one if necessary.
   if (prefix_length == 0) {
@@ -387,6 +438,7 @@ void CommandLine::RemoveSwitch(base::StringPiece switch_key_without_prefix) {
   auto it = switches_.find(switch_key_without_prefix);
   if (it == switches_.end())
     return;
+  switch_index_.erase(StringPiece(it->first));
   switches_.erase(it);
   // Also erase from the switches section of |argv_| and update |begin_args_|
   // accordingly.
@@ -545,6 +597,24 @@ void CommandLine::AppendSwitchesAndArguments(
   }
 }
 
+size_t CommandLine::SwitchNameHash::operator()(
+    StringPiece switch_string) const {
+  return FastHash(switch_string);
+}
+
+void CommandLine::IndexSwitch(SwitchMap::const_iterator it) {
+  switch_index_.insert_or_assign(
+      StringPiece(it->first),
+      IndexedSwitch{&it->second, ParseSwitchValueAsInt64(it->second)});
+}
+
+const CommandLine::IndexedSwitch* CommandLine::FindSwitch(
+    StringPiece switch_string) const {
+  DCHECK_EQ(ToLowerASCII(switch_string), switch_string);
+  auto it = switch_index_.find(switch_string);
+  return it == switch_index_.end() ? nullptr : &it->second;
+}
+
 CommandLine::StringType CommandLine::GetArgumentsStringInternal(
     bool allow_unsafe_insert_sequences) const {
   StringType params;
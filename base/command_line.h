@@ -17,6 +17,8 @@
 #define BASE_COMMAND_LINE_H_
 
 #include <stddef.h>
+#include <stdint.h>
+
 #include <functional>
 #include <map>
 #include <memory>
@@ -24,8 +26,11 @@
 #include <vector>
 
 #include "base/base_export.h"
+#include "base/containers/flat_hash_map.h"
+#include "base/memory/raw_ptr.h"
 #include "base/strings/string_piece.h"
 #include "build/build_config.h"
+#include "third_party/abseil-cpp/absl/types/optional.h"
 
 namespace base {
 
@@ -165,6 +170,13 @@ class BASE_EXPORT CommandLine {
   FilePath GetSwitchValuePath(StringPiece switch_string) const;
   StringType GetSwitchValueNative(StringPiece switch_string) const;
 
+  // Returns the value of the given switch as a decimal integer, or nullopt if
+  // the switch isn't present, or its value isn't such an integer or doesn't
+  // fit. The value is parsed once, when the switch is added.
+  // Switch names must be lowercase.
+  absl::optional<int> GetSwitchValueInt(StringPiece switch_string) const;
+  absl::optional<int64_t> GetSwitchValueInt64(StringPiece switch_string) const;
+
   // Get a copy of all switches, along with their values.
   const SwitchMap& GetSwitches() const { return switches_; }
 
@@ -222,9 +234,28 @@ class BASE_EXPORT CommandLine {
   //   CommandLine cl(*CommandLine::ForCurrentProcess());
   //   cl.AppendSwitch(...);
 
+  // An entry of |switch_index_|.
+  struct IndexedSwitch {
+    // The value in |switches_|, whose nodes don't move until erased.
+    raw_ptr<const StringType> value;
+    // The value as a decimal integer, if it is one.
+    absl::optional<int64_t> int_value;
+  };
+
+  struct SwitchNameHash {
+    size_t operator()(StringPiece switch_string) const;
+  };
+
   // Append switches and arguments, keeping switches before arguments.
   void AppendSwitchesAndArguments(const StringVector& argv);
 
+  // Adds the switch of |switches_| at |it| to |switch_index_|, or updates its
+  // entry.
+  void IndexSwitch(SwitchMap::const_iterator it);
+
+  // Returns the entry of the given switch in |switch_index_|, or null.
+  const IndexedSwitch* FindSwitch(StringPiece switch_string) const;
+
   // Internal version of GetArgumentsString to support allowing unsafe insert
   // sequences in rare cases (see
   // GetCommandLineStringWithUnsafeInsertSequences).
@@ -258,6 +289,11 @@ class BASE_EXPORT CommandLine {
   // Parsed-out switch keys and values.
   SwitchMap switches_;
 
+  // Indexes |switches_| by the keys it holds, so that finding a switch hashes
+  // its name once, rather than comparing it to those along a path of the
+  // tree. Updated along with |switches_|.
+  flat_hash_map<StringPiece, IndexedSwitch, SwitchNameHash> switch_index_;
+
   // The index after the program and switches, any arguments start here.
   size_t begin_args_;
 };
@@ -0,0 +1,74 @@
+// Copyright 2022 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include <stddef.h>
+
+#include <string>
+
+#include "base/command_line.h"
+#include "base/strings/stringprintf.h"
+#include "base/time/time.h"
+#include "testing/gtest/include/gtest/gtest.h"
+#include "testing/perf/perf_result_reporter.h"
+
+namespace base {
+
+namespace {
+
+// About as many as a browser process is started with.
+constexpr int kNumSwitches = 100;
+constexpr size_t kCount = 1000000;
+
+constexpr char kMetricPrefixCommandLine[] = "CommandLine.";
+constexpr char kMetricOperationTime[] = "operation_time";
+
+perf_test::PerfResultReporter SetUpReporter(const std::string& story_name) {
+  perf_test::PerfResultReporter reporter(kMetricPrefixCommandLine, story_name);
+  reporter.RegisterImportantMetric(kMetricOperationTime, "ns");
+  return reporter;
+}
+
+class CommandLinePerfTest : public testing::Test {
+ protected:
+  CommandLinePerfTest() : command_line_(CommandLine::NO_PROGRAM) {
+    for (int i = 0; i < kNumSwitches; ++i)
+      command_line_.AppendSwitchASCII(StringPrintf("enable-feature-%d", i),
+                                      StringPrintf("%d", i));
+  }
+
+  void Report(const std::string& story_name, TimeDelta elapsed) {
+    SetUpReporter(story_name)
+        .AddResult(kMetricOperationTime,
+                   static_cast<double>(elapsed.InNanoseconds()) / kCount);
+  }
+
+  CommandLine command_line_;
+};
+
+}  // namespace
+
+TEST_F(CommandLinePerfTest, HasSwitch) {
+  const std::string present = StringPrintf("enable-feature-%d", 42);
+  const std::string absent = "disable-feature";
+  size_t num_found = 0;
+  const TimeTicks start = TimeTicks::Now();
+  for (size_t i = 0; i < kCount; ++i) {
+    if (command_line_.HasSwitch(i % 2 ? present : absent))
+      ++num_found;
+  }
+  Report("has_switch", TimeTicks::Now() - start);
+  EXPECT_EQ(num_found, kCount / 2);
+}
+
+TEST_F(CommandLinePerfTest, GetSwitchValueInt) {
+  const std::string name = StringPrintf("enable-feature-%d", 42);
+  int sum = 0;
+  const TimeTicks start = TimeTicks::Now();
+  for (size_t i = 0; i < kCount; ++i)
+    sum += command_line_.GetSwitchValueInt(name).value_or(0);
+  Report("get_switch_value_int", TimeTicks::Now() - start);
+  EXPECT_EQ(sum, static_cast<int>(42 * kCount));
+}
+
+}  // namespace base
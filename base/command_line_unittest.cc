@@ -10,6 +10,7 @@
 
 #include "base/files/file_path.h"
 #include "base/strings/strcat.h"
+#include "base/strings/string_number_conversions.h"
 #include "base/strings/utf_string_conversions.h"
 #include "build/build_config.h"
 #include "testing/gmock/include/gmock/gmock.h"
@@ -405,6 +406,27 @@ TEST(CommandLineTest, Copy) {
     EXPECT_TRUE(assigned.HasSwitch(pair.first));
 }
 
+TEST(CommandLineTest, CopyThenModify) {
+  CommandLine initial(CommandLine::NO_PROGRAM);
+  initial.AppendSwitchASCII("a", "1");
+  initial.AppendSwitchASCII("b", "2");
+  CommandLine copy(initial);
+  CommandLine assigned(CommandLine::NO_PROGRAM);
+  assigned.AppendSwitch("c");
+  assigned = initial;
+
+  // The copies find the switches in their own maps.
+  initial.AppendSwitchASCII("a", "3");
+  initial.RemoveSwitch("b");
+  for (const CommandLine* cl : {&copy, &assigned}) {
+    EXPECT_EQ("1", cl->GetSwitchValueASCII("a"));
+    EXPECT_EQ(2, cl->GetSwitchValueInt("b"));
+    EXPECT_FALSE(cl->HasSwitch("c"));
+  }
+  EXPECT_EQ("3", initial.GetSwitchValueASCII("a"));
+  EXPECT_FALSE(initial.HasSwitch("b"));
+}
+
 TEST(CommandLineTest, PrependSimpleWrapper) {
   CommandLine cl(FilePath(FILE_PATH_LITERAL("Program")));
   cl.AppendSwitch("a");
@@ -572,6 +594,61 @@ TEST(CommandLineTest, MultipleSameSwitch) {
   EXPECT_EQ("two", cl.GetSwitchValueASCII("foo"));
 }
 
+TEST(CommandLineTest, GetSwitchValueInt) {
+  const CommandLine::CharType* argv[] = {
+      FILE_PATH_LITERAL("program"),
+      FILE_PATH_LITERAL("--count=42"),
+      FILE_PATH_LITERAL("--negative=-7"),
+      FILE_PATH_LITERAL("--large=4294967296"),
+      FILE_PATH_LITERAL("--name=foo"),
+      FILE_PATH_LITERAL("--trailing=3x"),
+      FILE_PATH_LITERAL("--empty"),
+  };
+  CommandLine cl(size(argv), argv);
+
+  EXPECT_EQ(42, cl.GetSwitchValueInt("count"));
+  EXPECT_EQ(-7, cl.GetSwitchValueInt("negative"));
+  EXPECT_EQ(absl::nullopt, cl.GetSwitchValueInt("large"));
+  EXPECT_EQ(int64_t{4294967296}, cl.GetSwitchValueInt64("large"));
+  EXPECT_EQ(absl::nullopt, cl.GetSwitchValueInt("name"));
+  EXPECT_EQ(absl::nullopt, cl.GetSwitchValueInt("trailing"));
+  EXPECT_EQ(absl::nullopt, cl.GetSwitchValueInt("empty"));
+  EXPECT_EQ(absl::nullopt, cl.GetSwitchValueInt("missing"));
+
+  // The parsed value follows the switch.
+  cl.AppendSwitchASCII("count", "43");
+  EXPECT_EQ(43, cl.GetSwitchValueInt("count"));
+  cl.AppendSwitchASCII("name", "5");
+  EXPECT_EQ(5, cl.GetSwitchValueInt64("name"));
+  cl.RemoveSwitch("count");
+  EXPECT_EQ(absl::nullopt, cl.GetSwitchValueInt("count"));
+}
+
+TEST(CommandLineTest, ManySwitches) {
+  CommandLine cl(CommandLine::NO_PROGRAM);
+  constexpr int kNumSwitches = 500;
+  for (int i = 0; i < kNumSwitches; ++i)
+    cl.AppendSwitchASCII(StrCat({"switch-", NumberToString(i)}),
+                         NumberToString(i));
+  for (int i = 0; i < kNumSwitches; i += 2)
+    cl.RemoveSwitch(StrCat({"switch-", NumberToString(i)}));
+
+  EXPECT_EQ(static_cast<size_t>(kNumSwitches / 2), cl.GetSwitches().size());
+  for (int i = 0; i < kNumSwitches; ++i) {
+    const std::string name = StrCat({"switch-", NumberToString(i)});
+    if (i % 2) {
+      EXPECT_TRUE(cl.HasSwitch(name));
+      EXPECT_EQ(NumberToString(i), cl.GetSwitchValueASCII(name));
+      EXPECT_EQ(i, cl.GetSwitchValueInt(name));
+    } else {
+      EXPECT_FALSE(cl.HasSwitch(name));
+    }
+  }
+
+  cl.InitFromArgv(CommandLine::StringVector{FILE_PATH_LITERAL("program")});
+  EXPECT_FALSE(cl.HasSwitch("switch-1"));
+}
+
 // Helper class for the next test case
 class MergeDuplicateFoosSemicolon : public DuplicateSwitchHandler {
  public:
@@ -7,6 +7,7 @@
 
 #include <type_traits>
 
+#include "base/big_endian.h"
 #include "base/bit_cast.h"
 #include "base/containers/span.h"
 #include "base/numerics/checked_math.h"
@@ -123,6 +124,33 @@ class BufferIterator {
     return MutableSpan<const T>(count);
   }
 
+  // Reads |out.size()| unsigned integers in big endian order from the buffer
+  // at the current position into |out|, in host order. On success, the
+  // iterator position is advanced by |out.size_bytes()|. If there are not
+  // enough bytes remaining in the buffer, returns false and reads nothing.
+  template <typename T, size_t N>
+  bool ReadBigEndianArray(span<T, N> out) {
+    span<const uint8_t> bytes = Span<uint8_t>(out.size_bytes());
+    if (bytes.size() != out.size_bytes())
+      return false;
+    base::ReadBigEndianArray(bytes.data(), out);
+    return true;
+  }
+
+  // Writes |values| in big endian order to the buffer at the current
+  // position. On success, the iterator position is advanced by
+  // |values.size_bytes()|. If there are not enough bytes remaining in the
+  // buffer, returns false and writes nothing.
+  template <typename T, size_t N>
+  bool WriteBigEndianArray(span<T, N> values) {
+    static_assert(!std::is_const<B>::value, "The buffer must be mutable.");
+    span<char> bytes = MutableSpan<char>(values.size_bytes());
+    if (bytes.size() != values.size_bytes())
+      return false;
+    base::WriteBigEndianArray(bytes.data(), values);
+    return true;
+  }
+
   // Resets the iterator position to the absolute offset |to|.
   void Seek(size_t to) { remaining_ = buffer_.subspan(to); }
 
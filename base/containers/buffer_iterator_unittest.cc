@@ -144,6 +144,35 @@ TEST(BufferIteratorTest, SpanOverflow) {
   }
 }
 
+TEST(BufferIteratorTest, BigEndianArrays) {
+  std::vector<uint8_t> buffer(2 + 4 * 9);
+  const uint32_t values[] = {0x01020304, 0x05060708, 0x090A0B0C,
+                             0x0D0E0F10, 0x11121314, 0x15161718,
+                             0x191A1B1C, 0x1D1E1F20, 0x21222324};
+  {
+    BufferIterator<uint8_t> iterator(buffer);
+    iterator.Seek(2);
+    EXPECT_TRUE(iterator.WriteBigEndianArray(make_span(values)));
+    EXPECT_EQ(iterator.total_size(), iterator.position());
+    EXPECT_FALSE(iterator.WriteBigEndianArray(make_span(values, 1u)));
+  }
+  EXPECT_EQ(0x01, buffer[2]);
+  EXPECT_EQ(0x04, buffer[5]);
+  EXPECT_EQ(0x24, buffer[37]);
+
+  BufferIterator<const uint8_t> iterator(buffer);
+  uint16_t prefix[1];
+  EXPECT_TRUE(iterator.ReadBigEndianArray(make_span(prefix)));
+  EXPECT_EQ(0u, prefix[0]);
+  uint32_t actual[10];
+  // Reads nothing if there aren't enough bytes.
+  EXPECT_FALSE(iterator.ReadBigEndianArray(make_span(actual)));
+  EXPECT_EQ(2u, iterator.position());
+  EXPECT_TRUE(iterator.ReadBigEndianArray(make_span(actual, 9u)));
+  for (size_t i = 0; i < 9; ++i)
+    EXPECT_EQ(values[i], actual[i]);
+}
+
 TEST(BufferIteratorTest, Position) {
   char buffer[64];
   BufferIterator<char> iterator(buffer, sizeof(buffer));
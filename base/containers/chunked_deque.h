@@ -0,0 +1,437 @@
+// Copyright 2022 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#ifndef BASE_CONTAINERS_CHUNKED_DEQUE_H_
+#define BASE_CONTAINERS_CHUNKED_DEQUE_H_
+
+#include <stddef.h>
+
+#include <algorithm>
+#include <iterator>
+#include <memory>
+#include <new>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+#include "base/check_op.h"
+#include "base/containers/circular_deque.h"
+#include "base/memory/raw_ptr.h"
+
+// base::chunked_deque
+//
+// A double-ended queue which stores its elements in fixed-size chunks, like
+// std::deque, but with a chunk size which is the same on all platforms and
+// can be chosen, and with chunks which can be recycled through a pool.
+//
+// Unlike circular_deque and std::vector, it never moves its elements when it
+// grows: push_back() and push_front() allocate at most one chunk, so that
+// their worst case is O(1) rather than a copy of the whole container, and the
+// memory use never doubles transiently. Pushing and popping at either end
+// keeps the addresses of the other elements stable, so it can serve as a
+// vector of elements with stable addresses too.
+//
+// The chunks are listed in a circular_deque of pointers, which is the only
+// part which ever gets reallocated, and is kChunkSize times smaller than the
+// elements.
+//
+// Chunk pooling
+// -------------
+//
+// A chunk which becomes empty is kept as a spare, so that a deque whose size
+// oscillates around a multiple of kChunkSize doesn't allocate and free a chunk
+// on each push and pop. Deques which grow and shrink in turns, like the queues
+// of tasks, can share a chunked_deque::Pool, which keeps up to a given number
+// of free chunks for all of them. The pool must outlive the deques, and isn't
+// thread-safe.
+//
+// Differences from std::deque
+// ---------------------------
+//
+// Only the ends can be inserted into or erased from. The iterators are
+// invalidated by any push or pop, like those of circular_deque, although the
+// references to the other elements are not.
+
+namespace base {
+
+template <typename T,
+          size_t kChunkSize = std::max<size_t>(16, 4096 / sizeof(T))>
+class chunked_deque {
+ private:
+  template <typename Deque, typename Value>
+  class Iterator;
+
+ public:
+  using value_type = T;
+  using size_type = size_t;
+  using difference_type = ptrdiff_t;
+  using reference = value_type&;
+  using const_reference = const value_type&;
+  using pointer = value_type*;
+  using const_pointer = const value_type*;
+
+  using iterator = Iterator<chunked_deque, T>;
+  using const_iterator = Iterator<const chunked_deque, const T>;
+  using reverse_iterator = std::reverse_iterator<iterator>;
+  using const_reverse_iterator = std::reverse_iterator<const_iterator>;
+
+  static_assert(kChunkSize > 0, "Chunks must hold elements.");
+
+  // A free list of chunks which deques of the same type can share.
+  class Pool {
+   public:
+    // Keeps up to |max_free_chunks| free chunks.
+    explicit Pool(size_t max_free_chunks) : max_free_chunks_(max_free_chunks) {}
+    Pool(const Pool&) = delete;
+    Pool& operator=(const Pool&) = delete;
+    ~Pool() {
+      for (T* chunk : free_chunks_)
+        DeallocateChunk(chunk);
+    }
+
+    size_t free_chunk_count() const { return free_chunks_.size(); }
+
+    T* Allocate() {
+      if (free_chunks_.empty())
+        return AllocateChunk();
+      T* chunk = free_chunks_.back();
+      free_chunks_.pop_back();
+      return chunk;
+    }
+
+    void Free(T* chunk) {
+      if (free_chunks_.size() < max_free_chunks_)
+        free_chunks_.push_back(chunk);
+      else
+        DeallocateChunk(chunk);
+    }
+
+   private:
+    const size_t max_free_chunks_;
+    std::vector<T*> free_chunks_;
+  };
+
+  // Constructors ------------------------------------------------------------
+
+  chunked_deque() = default;
+
+  // Allocates the chunks from |pool|, which must outlive this deque.
+  explicit chunked_deque(Pool* pool) : pool_(pool) {}
+
+  chunked_deque(const chunked_deque& other) : pool_(other.pool_) {
+    for (const T& value : other)
+      push_back(value);
+  }
+
+  chunked_deque(chunked_deque&& other) noexcept { swap(other); }
+
+  chunked_deque(std::initializer_list<value_type> init) {
+    for (const T& value : init)
+      push_back(value);
+  }
+
+  ~chunked_deque() {
+    clear();
+    if (spare_chunk_)
+      FreeChunk(spare_chunk_);
+  }
+
+  chunked_deque& operator=(const chunked_deque& other) {
+    if (&other == this)
+      return *this;
+    clear();
+    for (const T& value : other)
+      push_back(value);
+    return *this;
+  }
+
+  chunked_deque& operator=(chunked_deque&& other) noexcept {
+    chunked_deque(std::move(other)).swap(*this);
+    return *this;
+  }
+
+  // Accessors ---------------------------------------------------------------
+
+  const value_type& operator[](size_type i) const {
+    DCHECK_LT(i, size_);
+    const size_type index = begin_ + i;
+    return chunks_[index / kChunkSize][index % kChunkSize];
+  }
+  value_type& operator[](size_type i) {
+    return const_cast<value_type&>(std::as_const(*this)[i]);
+  }
+
+  const value_type& at(size_type i) const { return (*this)[i]; }
+  value_type& at(size_type i) { return (*this)[i]; }
+
+  value_type& front() {
+    DCHECK(!empty());
+    return chunks_.front()[begin_];
+  }
+  const value_type& front() const {
+    DCHECK(!empty());
+    return chunks_.front()[begin_];
+  }
+
+  value_type& back() { return (*this)[size_ - 1]; }
+  const value_type& back() const { return (*this)[size_ - 1]; }
+
+  // Iterators ---------------------------------------------------------------
+
+  iterator begin() { return iterator(this, 0); }
+  const_iterator begin() const { return const_iterator(this, 0); }
+  const_iterator cbegin() const { return begin(); }
+
+  iterator end() { return iterator(this, size_); }
+  const_iterator end() const { return const_iterator(this, size_); }
+  const_iterator cend() const { return end(); }
+
+  reverse_iterator rbegin() { return reverse_iterator(end()); }
+  const_reverse_iterator rbegin() const {
+    return const_reverse_iterator(end());
+  }
+  const_reverse_iterator crbegin() const { return rbegin(); }
+
+  reverse_iterator rend() { return reverse_iterator(begin()); }
+  const_reverse_iterator rend() const {
+    return const_reverse_iterator(begin());
+  }
+  const_reverse_iterator crend() const { return rend(); }
+
+  // Memory management -------------------------------------------------------
+
+  static constexpr size_type chunk_size() { return kChunkSize; }
+
+  // The number of elements which the allocated chunks hold, not counting the
+  // spare chunk.
+  size_type capacity() const { return chunks_.size() * kChunkSize; }
+
+  // Releases the spare chunk, and the chunk map's unused capacity.
+  void shrink_to_fit() {
+    if (spare_chunk_) {
+      FreeChunk(spare_chunk_);
+      spare_chunk_ = nullptr;
+    }
+    chunks_.shrink_to_fit();
+  }
+
+  // Size management ---------------------------------------------------------
+
+  // Destroys the elements, and frees the chunks but the spare chunk.
+  void clear() {
+    while (!empty())
+      pop_back();
+  }
+
+  bool empty() const { return size_ == 0; }
+  size_type size() const { return size_; }
+
+  // Insert and erase --------------------------------------------------------
+
+  void push_front(const T& value) { emplace_front(value); }
+  void push_front(T&& value) { emplace_front(std::move(value)); }
+
+  void push_back(const T& value) { emplace_back(value); }
+  void push_back(T&& value) { emplace_back(std::move(value)); }
+
+  template <class... Args>
+  reference emplace_front(Args&&... args) {
+    if (begin_ == 0) {
+      chunks_.push_front(NewChunk());
+      begin_ = kChunkSize;
+    }
+    T* value = new (&chunks_.front()[begin_ - 1])
+        T(std::forward<Args>(args)...);
+    --begin_;
+    ++size_;
+    return *value;
+  }
+
+  template <class... Args>
+  reference emplace_back(Args&&... args) {
+    const size_type index = begin_ + size_;
+    if (index == capacity())
+      chunks_.push_back(NewChunk());
+    T* value = new (&chunks_[index / kChunkSize][index % kChunkSize])
+        T(std::forward<Args>(args)...);
+    ++size_;
+    return *value;
+  }
+
+  void pop_front() {
+    DCHECK(!empty());
+    chunks_.front()[begin_].~T();
+    ++begin_;
+    --size_;
+    if (begin_ == kChunkSize || empty()) {
+      RecycleChunk(chunks_.front());
+      chunks_.pop_front();
+      begin_ = 0;
+    }
+  }
+
+  void pop_back() {
+    DCHECK(!empty());
+    back().~T();
+    --size_;
+    if ((begin_ + size_) % kChunkSize == 0 || empty()) {
+      RecycleChunk(chunks_.back());
+      chunks_.pop_back();
+      if (empty())
+        begin_ = 0;
+    }
+  }
+
+  void swap(chunked_deque& other) {
+    std::swap(chunks_, other.chunks_);
+    std::swap(begin_, other.begin_);
+    std::swap(size_, other.size_);
+    std::swap(spare_chunk_, other.spare_chunk_);
+    std::swap(pool_, other.pool_);
+  }
+
+  friend void swap(chunked_deque& lhs, chunked_deque& rhs) { lhs.swap(rhs); }
+
+ private:
+  template <typename Deque, typename Value>
+  class Iterator {
+   public:
+    using iterator_category = std::random_access_iterator_tag;
+    using value_type = std::remove_const_t<Value>;
+    using difference_type = ptrdiff_t;
+    using pointer = Value*;
+    using reference = Value&;
+
+    Iterator() = default;
+
+    // Converts an iterator to a const_iterator.
+    template <typename OtherDeque,
+              typename OtherValue,
+              typename = std::enable_if_t<
+                  std::is_convertible<OtherValue*, Value*>::value>>
+    // NOLINTNEXTLINE(google-explicit-constructor)
+    Iterator(const Iterator<OtherDeque, OtherValue>& other)
+        : deque_(other.deque_), index_(other.index_) {}
+
+    reference operator*() const { return (*deque_)[index_]; }
+    pointer operator->() const { return &(*deque_)[index_]; }
+    reference operator[](difference_type n) const { return *(*this + n); }
+
+    Iterator& operator++() {
+      ++index_;
+      return *this;
+    }
+    Iterator operator++(int) {
+      Iterator ret = *this;
+      ++index_;
+      return ret;
+    }
+    Iterator& operator--() {
+      --index_;
+      return *this;
+    }
+    Iterator operator--(int) {
+      Iterator ret = *this;
+      --index_;
+      return ret;
+    }
+
+    Iterator& operator+=(difference_type n) {
+      index_ += n;
+      return *this;
+    }
+    Iterator& operator-=(difference_type n) {
+      index_ -= n;
+      return *this;
+    }
+    friend Iterator operator+(Iterator it, difference_type n) {
+      return it += n;
+    }
+    friend Iterator operator+(difference_type n, Iterator it) {
+      return it += n;
+    }
+    friend Iterator operator-(Iterator it, difference_type n) {
+      return it -= n;
+    }
+    friend difference_type operator-(const Iterator& lhs,
+                                     const Iterator& rhs) {
+      return static_cast<difference_type>(lhs.index_) -
+             static_cast<difference_type>(rhs.index_);
+    }
+
+    friend bool operator==(const Iterator& lhs, const Iterator& rhs) {
+      DCHECK_EQ(lhs.deque_, rhs.deque_);
+      return lhs.index_ == rhs.index_;
+    }
+    friend bool operator!=(const Iterator& lhs, const Iterator& rhs) {
+      return !(lhs == rhs);
+    }
+    friend bool operator<(const Iterator& lhs, const Iterator& rhs) {
+      return lhs.index_ < rhs.index_;
+    }
+    friend bool operator>(const Iterator& lhs, const Iterator& rhs) {
+      return rhs < lhs;
+    }
+    friend bool operator<=(const Iterator& lhs, const Iterator& rhs) {
+      return !(rhs < lhs);
+    }
+    friend bool operator>=(const Iterator& lhs, const Iterator& rhs) {
+      return !(lhs < rhs);
+    }
+
+   private:
+    friend class chunked_deque;
+    template <typename, typename>
+    friend class Iterator;
+
+    Iterator(Deque* deque, size_t index) : deque_(deque), index_(index) {}
+
+    Deque* deque_ = nullptr;
+    size_t index_ = 0;
+  };
+
+  static T* AllocateChunk() { return std::allocator<T>().allocate(kChunkSize); }
+  static void DeallocateChunk(T* chunk) {
+    std::allocator<T>().deallocate(chunk, kChunkSize);
+  }
+
+  // Returns the spare chunk if any, or a chunk from the pool.
+  T* NewChunk() {
+    if (spare_chunk_)
+      return std::exchange(spare_chunk_, nullptr);
+    return pool_ ? pool_->Allocate() : AllocateChunk();
+  }
+
+  // Keeps |chunk| as the spare chunk if there's none, or frees it.
+  void RecycleChunk(T* chunk) {
+    if (!spare_chunk_)
+      spare_chunk_ = chunk;
+    else
+      FreeChunk(chunk);
+  }
+
+  void FreeChunk(T* chunk) {
+    if (pool_)
+      pool_->Free(chunk);
+    else
+      DeallocateChunk(chunk);
+  }
+
+  // The chunks, of which the first |begin_| elements of the first one, and the
+  // elements past |begin_| + |size_| are unused. The first and the last chunks
+  // hold at least one element, so an empty deque has no chunks.
+  circular_deque<T*> chunks_;
+  size_type begin_ = 0;
+  size_type size_ = 0;
+
+  // A chunk which was freed by a pop, and is reused by the next push which
+  // needs one.
+  T* spare_chunk_ = nullptr;
+
+  raw_ptr<Pool> pool_ = nullptr;
+};
+
+}  // namespace base
+
+#endif  // BASE_CONTAINERS_CHUNKED_DEQUE_H_
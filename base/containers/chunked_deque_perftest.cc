@@ -0,0 +1,75 @@
+// Copyright 2022 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "base/containers/chunked_deque.h"
+
+#include <stdint.h>
+
+#include <algorithm>
+#include <string>
+
+#include "base/containers/circular_deque.h"
+#include "base/time/time.h"
+#include "base/timer/lap_timer.h"
+#include "testing/gtest/include/gtest/gtest.h"
+#include "testing/perf/perf_result_reporter.h"
+
+namespace base {
+namespace {
+
+constexpr int kWarmupRuns = 1;
+constexpr TimeDelta kTimeLimit = Seconds(1);
+constexpr int kTimeCheckInterval = 1;
+constexpr size_t kSize = 1 << 20;
+constexpr size_t kBatchSize = 1024;
+
+constexpr char kMetricPrefixChunkedDeque[] = "ChunkedDeque.";
+constexpr char kMetricFillThroughput[] = "fill_throughput";
+constexpr char kMetricMaxBatchTime[] = "max_push_back_batch_time";
+
+perf_test::PerfResultReporter SetUpReporter(const std::string& story_name) {
+  perf_test::PerfResultReporter reporter(kMetricPrefixChunkedDeque,
+                                         story_name);
+  reporter.RegisterImportantMetric(kMetricFillThroughput, "runs/s");
+  reporter.RegisterImportantMetric(kMetricMaxBatchTime, "us");
+  return reporter;
+}
+
+// Pushes kSize items at the back of a queue, which is then drained from the
+// front, like the task queues. Reports the rate of the fills, and the longest
+// time which a batch of kBatchSize pushes took, which includes the copies of
+// the whole queue by the containers which reallocate.
+template <typename Deque>
+void RunFillTest(const std::string& story_name) {
+  LapTimer timer(kWarmupRuns, kTimeLimit, kTimeCheckInterval);
+  TimeDelta max_batch_time;
+  do {
+    Deque deque;
+    for (size_t i = 0; i < kSize; i += kBatchSize) {
+      const TimeTicks start = TimeTicks::Now();
+      for (size_t j = 0; j < kBatchSize; ++j)
+        deque.push_back(static_cast<uint64_t>(i + j));
+      max_batch_time = std::max(max_batch_time, TimeTicks::Now() - start);
+    }
+    while (!deque.empty())
+      deque.pop_front();
+    timer.NextLap();
+  } while (!timer.HasTimeLimitExpired());
+
+  auto reporter = SetUpReporter(story_name);
+  reporter.AddResult(kMetricFillThroughput, timer.LapsPerSecond());
+  reporter.AddResult(kMetricMaxBatchTime, max_batch_time);
+}
+
+}  // namespace
+
+TEST(ChunkedDequePerfTest, CircularDeque) {
+  RunFillTest<circular_deque<uint64_t>>("circular_deque");
+}
+
+TEST(ChunkedDequePerfTest, ChunkedDeque) {
+  RunFillTest<chunked_deque<uint64_t>>("chunked_deque");
+}
+
+}  // namespace base
@@ -0,0 +1,200 @@
+// Copyright 2022 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "base/containers/chunked_deque.h"
+
+#include <algorithm>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "base/rand_util.h"
+#include "testing/gmock/include/gmock/gmock.h"
+#include "testing/gtest/include/gtest/gtest.h"
+
+using ::testing::ElementsAre;
+
+namespace base {
+
+namespace {
+
+// A small chunk size, so that the tests cross chunk boundaries.
+using SmallDeque = chunked_deque<int, 4>;
+
+}  // namespace
+
+TEST(ChunkedDeque, PushPop) {
+  SmallDeque deque;
+  EXPECT_TRUE(deque.empty());
+  EXPECT_EQ(0u, deque.capacity());
+
+  for (int i = 0; i < 10; ++i)
+    deque.push_back(i);
+  for (int i = 1; i <= 5; ++i)
+    deque.push_front(-i);
+  EXPECT_EQ(15u, deque.size());
+  EXPECT_EQ(-5, deque.front());
+  EXPECT_EQ(9, deque.back());
+  for (size_t i = 0; i < deque.size(); ++i)
+    EXPECT_EQ(static_cast<int>(i) - 5, deque[i]);
+
+  deque.pop_front();
+  deque.pop_back();
+  EXPECT_EQ(-4, deque.front());
+  EXPECT_EQ(8, deque.back());
+
+  while (deque.size() > 1)
+    deque.pop_front();
+  EXPECT_EQ(8, deque.front());
+  EXPECT_EQ(4u, deque.capacity());
+  deque.pop_back();
+  EXPECT_TRUE(deque.empty());
+  EXPECT_EQ(0u, deque.capacity());
+}
+
+TEST(ChunkedDeque, StableAddresses) {
+  SmallDeque deque;
+  deque.push_back(0);
+  const int* first = &deque.front();
+  std::vector<const int*> addresses;
+  for (int i = 1; i < 100; ++i) {
+    deque.push_back(i);
+    deque.push_front(-i);
+    addresses.push_back(&deque.back());
+  }
+  EXPECT_EQ(first, &deque[99]);
+  for (int i = 1; i < 100; ++i)
+    EXPECT_EQ(addresses[i - 1], &deque[99 + i]);
+
+  // Popping from the other end doesn't move them either.
+  for (int i = 0; i < 99; ++i)
+    deque.pop_front();
+  EXPECT_EQ(first, &deque.front());
+}
+
+TEST(ChunkedDeque, Iterators) {
+  SmallDeque deque;
+  for (int i = 0; i < 10; ++i)
+    deque.push_back(i);
+  std::vector<int> values(deque.begin(), deque.end());
+  EXPECT_THAT(values, ElementsAre(0, 1, 2, 3, 4, 5, 6, 7, 8, 9));
+  values.assign(deque.rbegin(), deque.rend());
+  EXPECT_THAT(values, ElementsAre(9, 8, 7, 6, 5, 4, 3, 2, 1, 0));
+
+  SmallDeque::iterator it = deque.begin() + 3;
+  EXPECT_EQ(3, *it);
+  EXPECT_EQ(7, it[4]);
+  EXPECT_EQ(7, deque.end() - it);
+  SmallDeque::const_iterator const_it = it;
+  EXPECT_TRUE(const_it == deque.cbegin() + 3);
+  EXPECT_TRUE(deque.cbegin() < const_it);
+
+  std::sort(deque.begin(), deque.end(), std::greater<>());
+  EXPECT_EQ(9, deque.front());
+  EXPECT_EQ(0, deque.back());
+}
+
+TEST(ChunkedDeque, SpareChunk) {
+  SmallDeque deque;
+  for (int i = 0; i < 4; ++i)
+    deque.push_back(i);
+  // Pushing and popping across a chunk boundary reuses the same spare chunk.
+  int* chunk = nullptr;
+  for (int i = 0; i < 10; ++i) {
+    deque.push_back(4);
+    if (!chunk)
+      chunk = &deque.back();
+    EXPECT_EQ(chunk, &deque.back());
+    deque.pop_back();
+  }
+  EXPECT_EQ(4u, deque.capacity());
+  deque.shrink_to_fit();
+  EXPECT_EQ(4u, deque.size());
+}
+
+TEST(ChunkedDeque, Pool) {
+  SmallDeque::Pool pool(2);
+  {
+    SmallDeque deque(&pool);
+    for (int i = 0; i < 16; ++i)
+      deque.push_back(i);
+    // Keeps one chunk as a spare, and frees the others to the pool, which
+    // keeps two of them.
+    deque.clear();
+    EXPECT_EQ(2u, pool.free_chunk_count());
+    EXPECT_EQ(0u, deque.capacity());
+  }
+  // The spare chunk is freed to the pool too.
+  EXPECT_EQ(2u, pool.free_chunk_count());
+
+  SmallDeque other(&pool);
+  for (int i = 0; i < 8; ++i)
+    other.push_back(i);
+  EXPECT_EQ(0u, pool.free_chunk_count());
+}
+
+TEST(ChunkedDeque, CopyAndMove) {
+  chunked_deque<std::string, 2> deque = {"a", "b", "c"};
+  chunked_deque<std::string, 2> copy = deque;
+  EXPECT_THAT(copy, ElementsAre("a", "b", "c"));
+
+  chunked_deque<std::string, 2> moved = std::move(deque);
+  EXPECT_THAT(moved, ElementsAre("a", "b", "c"));
+  EXPECT_TRUE(deque.empty());
+
+  copy = moved;
+  moved.pop_front();
+  copy = std::move(moved);
+  EXPECT_THAT(copy, ElementsAre("b", "c"));
+
+  chunked_deque<std::string, 2> other = {"d"};
+  swap(copy, other);
+  EXPECT_THAT(copy, ElementsAre("d"));
+  EXPECT_THAT(other, ElementsAre("b", "c"));
+}
+
+TEST(ChunkedDeque, MoveOnly) {
+  chunked_deque<std::unique_ptr<int>, 3> deque;
+  for (int i = 0; i < 10; ++i)
+    deque.emplace_back(std::make_unique<int>(i));
+  deque.emplace_front(std::make_unique<int>(-1));
+  EXPECT_EQ(-1, *deque.front());
+  EXPECT_EQ(9, *deque.back());
+  EXPECT_EQ(11u, deque.size());
+}
+
+TEST(ChunkedDeque, SameAsCircularDeque) {
+  SmallDeque deque;
+  circular_deque<int> reference;
+  for (int i = 0; i < 10000; ++i) {
+    switch (RandInt(0, 3)) {
+      case 0:
+        deque.push_back(i);
+        reference.push_back(i);
+        break;
+      case 1:
+        deque.push_front(i);
+        reference.push_front(i);
+        break;
+      case 2:
+        if (!reference.empty()) {
+          deque.pop_back();
+          reference.pop_back();
+        }
+        break;
+      case 3:
+        if (!reference.empty()) {
+          deque.pop_front();
+          reference.pop_front();
+        }
+        break;
+    }
+    ASSERT_EQ(reference.size(), deque.size());
+    ASSERT_LE(deque.capacity(), deque.size() + 2 * deque.chunk_size());
+  }
+  EXPECT_TRUE(std::equal(deque.begin(), deque.end(), reference.begin(),
+                         reference.end()));
+}
+
+}  // namespace base
@@ -0,0 +1,252 @@
+// Copyright 2022 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "base/containers/concurrent_id_map.h"
+
+#include <limits>
+
+#include "base/bits.h"
+#include "base/check.h"
+#include "base/check_op.h"
+#include "base/containers/cxx20_erase_vector.h"
+
+namespace base {
+namespace internal {
+
+namespace {
+
+constexpr uint32_t GenerationOf(ConcurrentIDMapBase::Id id) {
+  return static_cast<uint32_t>(id >> 32);
+}
+
+constexpr uint32_t IndexOf(ConcurrentIDMapBase::Id id) {
+  return static_cast<uint32_t>(id);
+}
+
+constexpr ConcurrentIDMapBase::Id MakeId(uint32_t generation, uint32_t index) {
+  return (static_cast<uint64_t>(generation) << 32) | index;
+}
+
+}  // namespace
+
+ConcurrentIDMapBase::ConcurrentIDMapBase(void (*deleter)(void*))
+    : deleter_(deleter) {
+  // A map can be created on one sequence, and then used on another one.
+  DETACH_FROM_SEQUENCE(sequence_checker_);
+}
+
+ConcurrentIDMapBase::~ConcurrentIDMapBase() {
+  DCHECK_CALLED_ON_VALID_SEQUENCE(sequence_checker_);
+  for (size_t segment = 0; segment < kMaxSegments; ++segment) {
+    Slot* slots = segments_[segment].load(std::memory_order_relaxed);
+    if (!slots)
+      break;
+    const size_t slot_count = size_t{1} << (segment + kFirstSegmentBits);
+    for (size_t i = 0; i < slot_count; ++i) {
+      if (void* value = slots[i].value.load(std::memory_order_relaxed))
+        deleter_(value);
+    }
+    delete[] slots;
+  }
+  for (const RetiredValue& retired : retired_values_)
+    deleter_(retired.value);
+}
+
+void ConcurrentIDMapBase::EnterReadScope() const {
+  Reader* reader = GetOrCreateReader();
+  if (reader->depth++)
+    return;
+  // Pairs with the increment in Reclaim(), so that the lookups see the
+  // removals which happened before the epoch.
+  reader->epoch.store(epoch_.load(std::memory_order_acquire),
+                      std::memory_order_relaxed);
+  // Orders the announcement before the lookups. Reclaim() either sees it, or
+  // the lookups see the removals preceding Reclaim().
+  std::atomic_thread_fence(std::memory_order_seq_cst);
+}
+
+void ConcurrentIDMapBase::ExitReadScope() const {
+  Reader* reader = static_cast<Reader*>(reader_slot_.Get());
+  DCHECK(reader);
+  DCHECK_GT(reader->depth, 0);
+  if (!--reader->depth)
+    reader->epoch.store(0, std::memory_order_release);
+}
+
+void* ConcurrentIDMapBase::Lookup(Id id) const {
+  const uint32_t generation = GenerationOf(id);
+  Slot* slot = FindSlot(IndexOf(id));
+  if (!slot ||
+      slot->generation.load(std::memory_order_acquire) != generation) {
+    return nullptr;
+  }
+  // The value may have been removed, and the slot reused, since the
+  // generation was loaded. Loading the value with acquire orders the check
+  // below after it: if the value is the one of a later generation, then so is
+  // the generation.
+  void* value = slot->value.load(std::memory_order_acquire);
+  if (slot->generation.load(std::memory_order_relaxed) != generation)
+    return nullptr;
+  return value;
+}
+
+ConcurrentIDMapBase::Id ConcurrentIDMapBase::Add(void* value) {
+  DCHECK_CALLED_ON_VALID_SEQUENCE(sequence_checker_);
+  DCHECK(value);
+  uint32_t index;
+  if (!free_indices_.empty()) {
+    index = free_indices_.back();
+    free_indices_.pop_back();
+  } else {
+    // The last index whose segment offset fits in 32 bits.
+    CHECK_LT(slot_count_,
+             std::numeric_limits<uint32_t>::max() - (1u << kFirstSegmentBits));
+    index = slot_count_++;
+    const uint32_t offset_index = index + (1u << kFirstSegmentBits);
+    if (bits::IsPowerOfTwo(offset_index)) {
+      // |index| is the first slot of its segment.
+      const int segment = bits::Log2Floor(offset_index) - kFirstSegmentBits;
+      segments_[segment].store(new Slot[offset_index],
+                               std::memory_order_release);
+    }
+  }
+  ++size_;
+  Slot* slot = FindSlot(index);
+  slot->value.store(value, std::memory_order_release);
+  return MakeId(slot->generation.load(std::memory_order_relaxed), index);
+}
+
+void ConcurrentIDMapBase::Replace(Id id, void* value) {
+  DCHECK_CALLED_ON_VALID_SEQUENCE(sequence_checker_);
+  DCHECK(value);
+  Slot* slot = FindSlot(IndexOf(id));
+  DCHECK(slot);
+  DCHECK_EQ(slot->generation.load(std::memory_order_relaxed),
+            GenerationOf(id));
+  void* previous = slot->value.exchange(value, std::memory_order_acq_rel);
+  DCHECK(previous);
+  // Orders the replacement before the epoch load, like in Remove().
+  std::atomic_thread_fence(std::memory_order_seq_cst);
+  retired_values_.push_back(
+      {previous, epoch_.load(std::memory_order_relaxed)});
+  if (retired_values_.size() >= kReclaimThreshold)
+    Reclaim();
+}
+
+bool ConcurrentIDMapBase::Remove(Id id) {
+  DCHECK_CALLED_ON_VALID_SEQUENCE(sequence_checker_);
+  const uint32_t index = IndexOf(id);
+  Slot* slot = FindSlot(index);
+  if (!slot ||
+      slot->generation.load(std::memory_order_relaxed) != GenerationOf(id)) {
+    return false;
+  }
+  void* value = slot->value.load(std::memory_order_relaxed);
+  if (!value)
+    return false;
+
+  slot->value.store(nullptr, std::memory_order_relaxed);
+  --size_;
+  const uint32_t next_generation = GenerationOf(id) + 1;
+  if (next_generation) {
+    // Pairs with the loads in Lookup(), which then don't find the values
+    // added to the slot later with the IDs of the earlier ones.
+    slot->generation.store(next_generation, std::memory_order_release);
+    free_indices_.push_back(index);
+  }
+  // Otherwise, the generation would wrap around, so the slot is left empty
+  // for good rather than reused.
+
+  // Orders the removal before the epoch load, so that the readers which
+  // announce a later epoch can't find |value|.
+  std::atomic_thread_fence(std::memory_order_seq_cst);
+  retired_values_.push_back({value, epoch_.load(std::memory_order_relaxed)});
+  if (retired_values_.size() >= kReclaimThreshold)
+    Reclaim();
+  return true;
+}
+
+void ConcurrentIDMapBase::Reclaim() {
+  DCHECK_CALLED_ON_VALID_SEQUENCE(sequence_checker_);
+  if (retired_values_.empty())
+    return;
+  // The readers which announce the new epoch see all the removals so far.
+  epoch_.fetch_add(1, std::memory_order_acq_rel);
+  std::atomic_thread_fence(std::memory_order_seq_cst);
+
+  uint64_t min_epoch = std::numeric_limits<uint64_t>::max();
+  {
+    AutoLock lock(readers_lock_);
+    for (Reader* reader = readers_.get(); reader; reader = reader->next.get()) {
+      const uint64_t epoch = reader->epoch.load(std::memory_order_acquire);
+      if (epoch && epoch < min_epoch)
+        min_epoch = epoch;
+    }
+  }
+  // The values removed before the epoch of the oldest read scope can't be
+  // seen by any of them.
+  EraseIf(retired_values_, [this, min_epoch](const RetiredValue& retired) {
+    if (retired.epoch >= min_epoch)
+      return false;
+    deleter_(retired.value);
+    return true;
+  });
+}
+
+size_t ConcurrentIDMapBase::size() const {
+  DCHECK_CALLED_ON_VALID_SEQUENCE(sequence_checker_);
+  return size_;
+}
+
+size_t ConcurrentIDMapBase::pending_reclamation() const {
+  DCHECK_CALLED_ON_VALID_SEQUENCE(sequence_checker_);
+  return retired_values_.size();
+}
+
+// static
+void ConcurrentIDMapBase::OnThreadExit(void* reader) {
+  static_cast<Reader*>(reader)->in_use.store(false, std::memory_order_release);
+}
+
+ConcurrentIDMapBase::Slot* ConcurrentIDMapBase::FindSlot(
+    uint32_t index) const {
+  if (index >= std::numeric_limits<uint32_t>::max() -
+                   (1u << kFirstSegmentBits)) {
+    return nullptr;
+  }
+  const uint32_t offset_index = index + (1u << kFirstSegmentBits);
+  const int segment = bits::Log2Floor(offset_index) - kFirstSegmentBits;
+  // Pairs with the store in Add(), which initialised the slots.
+  Slot* slots = segments_[segment].load(std::memory_order_acquire);
+  if (!slots)
+    return nullptr;
+  return &slots[offset_index - (1u << (segment + kFirstSegmentBits))];
+}
+
+ConcurrentIDMapBase::Reader* ConcurrentIDMapBase::GetOrCreateReader() const {
+  if (void* reader = reader_slot_.Get())
+    return static_cast<Reader*>(reader);
+
+  AutoLock lock(readers_lock_);
+  Reader* reader = readers_.get();
+  for (; reader; reader = reader->next.get()) {
+    // Reuses the reader of an exited thread, which is outside of read scopes.
+    if (!reader->in_use.load(std::memory_order_acquire)) {
+      DCHECK_EQ(reader->depth, 0);
+      reader->in_use.store(true, std::memory_order_relaxed);
+      break;
+    }
+  }
+  if (!reader) {
+    auto new_reader = std::make_unique<Reader>();
+    new_reader->next = std::move(readers_);
+    readers_ = std::move(new_reader);
+    reader = readers_.get();
+  }
+  reader_slot_.Set(reader);
+  return reader;
+}
+
+}  // namespace internal
+}  // namespace base
@@ -0,0 +1,209 @@
+// Copyright 2022 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#ifndef BASE_CONTAINERS_CONCURRENT_ID_MAP_H_
+#define BASE_CONTAINERS_CONCURRENT_ID_MAP_H_
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include <atomic>
+#include <memory>
+#include <vector>
+
+#include "base/base_export.h"
+#include "base/memory/raw_ptr.h"
+#include "base/sequence_checker.h"
+#include "base/synchronization/lock.h"
+#include "base/thread_annotations.h"
+#include "base/threading/thread_local_storage.h"
+
+namespace base {
+
+namespace internal {
+
+// The untyped part of ConcurrentIDMap<T>, which maps the IDs to void*.
+class BASE_EXPORT ConcurrentIDMapBase {
+ public:
+  using Id = uint64_t;
+
+  explicit ConcurrentIDMapBase(void (*deleter)(void*));
+  ConcurrentIDMapBase(const ConcurrentIDMapBase&) = delete;
+  ConcurrentIDMapBase& operator=(const ConcurrentIDMapBase&) = delete;
+  ~ConcurrentIDMapBase();
+
+  void EnterReadScope() const;
+  void ExitReadScope() const;
+  // Wait-free. The value remains valid until the read scope is exited, or, on
+  // the writer sequence, until it's removed.
+  void* Lookup(Id id) const;
+
+  Id Add(void* value);
+  void Replace(Id id, void* value);
+  bool Remove(Id id);
+  void Reclaim();
+
+  size_t size() const;
+  size_t pending_reclamation() const;
+
+ private:
+  // The slots of the first segment. Each of the next ones is twice as large as
+  // the previous one, so that kMaxSegments cover all the 32-bit indices.
+  static constexpr uint32_t kFirstSegmentBits = 6;
+  static constexpr size_t kMaxSegments = 32 - kFirstSegmentBits;
+  // The number of removed values which makes Remove() call Reclaim().
+  static constexpr size_t kReclaimThreshold = 64;
+
+  struct Slot {
+    std::atomic<void*> value{nullptr};
+    // Incremented by each removal, so that the IDs of the previous values of
+    // the slot don't find the next ones. Never 0, which is the generation of
+    // no ID.
+    std::atomic<uint32_t> generation{1};
+  };
+
+  // A thread which entered read scopes. |epoch| is the epoch at which its
+  // outermost scope was entered, or 0 outside of scopes; the values removed
+  // at an epoch below the ones of all readers can't be seen anymore.
+  struct alignas(64) Reader {
+    std::atomic<uint64_t> epoch{0};
+    // The nesting depth of the scopes, only accessed by the thread.
+    int depth = 0;
+    // Whether a thread owns the reader. Cleared when the thread exits, so
+    // that another thread reuses it.
+    std::atomic<bool> in_use{true};
+    std::unique_ptr<Reader> next;
+  };
+
+  struct RetiredValue {
+    raw_ptr<void> value;
+    uint64_t epoch;
+  };
+
+  static void OnThreadExit(void* reader);
+
+  Slot* FindSlot(uint32_t index) const;
+  Reader* GetOrCreateReader() const;
+
+  void (*const deleter_)(void*);
+
+  std::atomic<Slot*> segments_[kMaxSegments] = {};
+  // Starts at 1, since an epoch of 0 means outside of read scopes.
+  std::atomic<uint64_t> epoch_{1};
+
+  mutable Lock readers_lock_;
+  mutable std::unique_ptr<Reader> readers_ GUARDED_BY(readers_lock_);
+  // Declared after |readers_|, so that exiting threads stop seeing their
+  // readers before they're destroyed.
+  mutable ThreadLocalStorage::Slot reader_slot_{&OnThreadExit};
+
+  // The state of the writer.
+  uint32_t slot_count_ = 0;
+  size_t size_ = 0;
+  std::vector<uint32_t> free_indices_;
+  std::vector<RetiredValue> retired_values_;
+
+  SEQUENCE_CHECKER(sequence_checker_);
+};
+
+}  // namespace internal
+
+// A map from IDs to owned values, for handle tables whose IDs are looked up by
+// many threads while one sequence adds and removes them. Lookups are
+// wait-free: they read the slot of the ID without locks, retries or atomic
+// read-modify-writes.
+//
+// IDs are 64-bit: the index of a slot, which is reused once its value is
+// removed, and the generation of the slot, which each removal increments. The
+// IDs of removed values thus never find the values which reuse their slots,
+// which rules out ABA problems and uses of the wrong value after a removal.
+// ID 0 is never valid.
+//
+// The removed values are destroyed with epoch-based reclamation: readers must
+// look up IDs in a ReadScope, which publishes the epoch at which it started,
+// and the values removed since then are kept until all the scopes which may
+// have seen them are over. A few values may thus outlive their removal.
+// ReadScopes are cheap, but long ones delay the reclamation.
+//
+//   ConcurrentIDMap<Handle> handles;
+//
+//   // On the writer sequence:
+//   ConcurrentIDMap<Handle>::Id id = handles.Add(std::make_unique<Handle>());
+//   ...
+//   handles.Remove(id);
+//
+//   // On any thread:
+//   ConcurrentIDMap<Handle>::ReadScope scope(handles);
+//   if (Handle* handle = scope.Lookup(id))
+//     handle->Use();
+//
+// Since values are looked up concurrently, T must be safe to use from many
+// threads at once. The map must outlive the ReadScopes, and be destroyed when
+// no thread is in one.
+template <typename T>
+class ConcurrentIDMap {
+ public:
+  using Id = internal::ConcurrentIDMapBase::Id;
+
+  class ReadScope {
+   public:
+    explicit ReadScope(const ConcurrentIDMap& map) : map_(map.base_) {
+      map_.EnterReadScope();
+    }
+    ReadScope(const ReadScope&) = delete;
+    ReadScope& operator=(const ReadScope&) = delete;
+    ~ReadScope() { map_.ExitReadScope(); }
+
+    // Returns the value of |id|, valid until the end of the scope, or nullptr
+    // if it was removed or never added.
+    T* Lookup(Id id) const { return static_cast<T*>(map_.Lookup(id)); }
+
+   private:
+    const internal::ConcurrentIDMapBase& map_;
+  };
+
+  ConcurrentIDMap() : base_(&Delete) {}
+  ConcurrentIDMap(const ConcurrentIDMap&) = delete;
+  ConcurrentIDMap& operator=(const ConcurrentIDMap&) = delete;
+  ~ConcurrentIDMap() = default;
+
+  // The methods below must be called on the writer sequence.
+
+  // Adds |value|, which must not be null, and returns its ID.
+  Id Add(std::unique_ptr<T> value) { return base_.Add(value.release()); }
+
+  // Replaces the value of |id|, which must be in the map, with |value|, under
+  // the same ID. Since readers may still use the previous value, it's
+  // destroyed like those of Remove().
+  void Replace(Id id, std::unique_ptr<T> value) {
+    base_.Replace(id, value.release());
+  }
+
+  // Removes the value of |id|, and returns whether it was in the map.
+  bool Remove(Id id) { return base_.Remove(id); }
+
+  // Returns the value of |id|, valid until it's removed, or nullptr.
+  T* Lookup(Id id) const { return static_cast<T*>(base_.Lookup(id)); }
+
+  // Destroys the removed values which no ReadScope can see anymore. Remove()
+  // calls it once a few values were removed.
+  void Reclaim() { base_.Reclaim(); }
+
+  size_t size() const { return base_.size(); }
+  bool IsEmpty() const { return size() == 0; }
+
+  // The number of removed values which aren't destroyed yet.
+  size_t pending_reclamation_for_testing() const {
+    return base_.pending_reclamation();
+  }
+
+ private:
+  static void Delete(void* value) { delete static_cast<T*>(value); }
+
+  internal::ConcurrentIDMapBase base_;
+};
+
+}  // namespace base
+
+#endif  // BASE_CONTAINERS_CONCURRENT_ID_MAP_H_
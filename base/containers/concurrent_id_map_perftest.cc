@@ -0,0 +1,136 @@
+// Copyright 2022 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "base/containers/concurrent_id_map.h"
+
+#include <atomic>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "base/containers/id_map.h"
+#include "base/memory/raw_ptr.h"
+#include "base/strings/stringprintf.h"
+#include "base/synchronization/lock.h"
+#include "base/threading/simple_thread.h"
+#include "base/time/time.h"
+#include "testing/gtest/include/gtest/gtest.h"
+#include "testing/perf/perf_result_reporter.h"
+
+namespace base {
+namespace {
+
+constexpr int kValueCount = 1024;
+constexpr int kLookupsPerThread = 4000000;
+
+constexpr char kMetricPrefixIDMap[] = "IDMap.";
+constexpr char kMetricLookupThroughput[] = "lookup_throughput";
+
+perf_test::PerfResultReporter SetUpReporter(const std::string& story_name) {
+  perf_test::PerfResultReporter reporter(kMetricPrefixIDMap, story_name);
+  reporter.RegisterImportantMetric(kMetricLookupThroughput, "lookups/s");
+  return reporter;
+}
+
+// An IDMap shared by the threads under a lock, as handle tables do without
+// ConcurrentIDMap.
+class LockedIDMap {
+ public:
+  using Id = IDMap<std::unique_ptr<int>>::KeyType;
+
+  Id Add(std::unique_ptr<int> value) {
+    AutoLock lock(lock_);
+    return map_.Add(std::move(value));
+  }
+  void Remove(Id id) {
+    AutoLock lock(lock_);
+    map_.Remove(id);
+  }
+  int LookupValue(Id id) const {
+    AutoLock lock(lock_);
+    int* value = map_.Lookup(id);
+    return value ? *value : 0;
+  }
+
+ private:
+  mutable Lock lock_;
+  IDMap<std::unique_ptr<int>> map_;
+};
+
+class ConcurrentMap {
+ public:
+  using Id = ConcurrentIDMap<int>::Id;
+
+  Id Add(std::unique_ptr<int> value) { return map_.Add(std::move(value)); }
+  void Remove(Id id) { map_.Remove(id); }
+  int LookupValue(Id id) const {
+    ConcurrentIDMap<int>::ReadScope scope(map_);
+    int* value = scope.Lookup(id);
+    return value ? *value : 0;
+  }
+
+ private:
+  ConcurrentIDMap<int> map_;
+};
+
+template <typename Map>
+class ReaderThread : public SimpleThread {
+ public:
+  ReaderThread(const Map* map, const std::vector<typename Map::Id>* ids)
+      : SimpleThread("IDMapReader"), map_(map), ids_(ids) {}
+
+  void Run() override {
+    int sum = 0;
+    for (int i = 0; i < kLookupsPerThread; ++i)
+      sum += map_->LookupValue((*ids_)[i % ids_->size()]);
+    EXPECT_GT(sum, 0);
+  }
+
+ private:
+  const raw_ptr<const Map> map_;
+  const raw_ptr<const std::vector<typename Map::Id>> ids_;
+};
+
+// Measures the lookups of |thread_count| readers, while the writer removes
+// and adds values.
+template <typename Map>
+void RunLookupTest(const char* name) {
+  for (int thread_count = 1; thread_count <= 8; thread_count *= 2) {
+    Map map;
+    std::vector<typename Map::Id> ids;
+    for (int i = 0; i < kValueCount; ++i)
+      ids.push_back(map.Add(std::make_unique<int>(1)));
+
+    std::vector<std::unique_ptr<ReaderThread<Map>>> readers;
+    for (int i = 0; i < thread_count; ++i)
+      readers.push_back(std::make_unique<ReaderThread<Map>>(&map, &ids));
+
+    const TimeTicks start = TimeTicks::Now();
+    for (auto& reader : readers)
+      reader->Start();
+    // Churns through values which the readers don't look up.
+    for (int i = 0; i < 10000; ++i)
+      map.Remove(map.Add(std::make_unique<int>(0)));
+    for (auto& reader : readers)
+      reader->Join();
+    const TimeDelta duration = TimeTicks::Now() - start;
+
+    auto reporter = SetUpReporter(StringPrintf("%s_%d", name, thread_count));
+    reporter.AddResult(
+        kMetricLookupThroughput,
+        thread_count * kLookupsPerThread / duration.InSecondsF());
+  }
+}
+
+}  // namespace
+
+TEST(ConcurrentIDMapPerfTest, LockedIDMap) {
+  RunLookupTest<LockedIDMap>("locked_id_map");
+}
+
+TEST(ConcurrentIDMapPerfTest, ConcurrentIDMap) {
+  RunLookupTest<ConcurrentMap>("concurrent_id_map");
+}
+
+}  // namespace base
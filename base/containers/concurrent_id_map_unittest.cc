@@ -0,0 +1,211 @@
+// Copyright 2022 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "base/containers/concurrent_id_map.h"
+
+#include <stdint.h>
+
+#include <atomic>
+#include <memory>
+#include <vector>
+
+#include "base/memory/raw_ptr.h"
+#include "base/threading/simple_thread.h"
+#include "testing/gtest/include/gtest/gtest.h"
+
+namespace base {
+
+namespace {
+
+// Counts the live instances, and checks that they're destroyed once. Readers
+// check |alive| to detect uses after the reclamation.
+class Value {
+ public:
+  Value(int id, std::atomic<int>* live_count)
+      : id_(id), live_count_(live_count) {
+    live_count_->fetch_add(1, std::memory_order_relaxed);
+  }
+  Value(const Value&) = delete;
+  Value& operator=(const Value&) = delete;
+  ~Value() {
+    EXPECT_TRUE(alive_.exchange(false, std::memory_order_relaxed));
+    live_count_->fetch_sub(1, std::memory_order_relaxed);
+  }
+
+  int id() const { return id_; }
+  bool alive() const { return alive_.load(std::memory_order_relaxed); }
+
+ private:
+  const int id_;
+  std::atomic<bool> alive_{true};
+  const raw_ptr<std::atomic<int>> live_count_;
+};
+
+using ValueMap = ConcurrentIDMap<Value>;
+
+}  // namespace
+
+TEST(ConcurrentIDMapTest, Basic) {
+  std::atomic<int> live_count{0};
+  ValueMap map;
+  EXPECT_TRUE(map.IsEmpty());
+  EXPECT_EQ(nullptr, map.Lookup(0));
+
+  const ValueMap::Id id1 = map.Add(std::make_unique<Value>(1, &live_count));
+  const ValueMap::Id id2 = map.Add(std::make_unique<Value>(2, &live_count));
+  EXPECT_NE(0u, id1);
+  EXPECT_NE(id1, id2);
+  EXPECT_EQ(2u, map.size());
+  EXPECT_EQ(1, map.Lookup(id1)->id());
+  {
+    ValueMap::ReadScope scope(map);
+    EXPECT_EQ(2, scope.Lookup(id2)->id());
+    EXPECT_EQ(nullptr, scope.Lookup(id2 + 1));
+  }
+
+  EXPECT_TRUE(map.Remove(id1));
+  EXPECT_FALSE(map.Remove(id1));
+  EXPECT_EQ(nullptr, map.Lookup(id1));
+  EXPECT_EQ(1u, map.size());
+
+  map.Replace(id2, std::make_unique<Value>(3, &live_count));
+  EXPECT_EQ(3, map.Lookup(id2)->id());
+
+  // No read scope is active, so the removed values are destroyed.
+  map.Reclaim();
+  EXPECT_EQ(0u, map.pending_reclamation_for_testing());
+  EXPECT_EQ(1, live_count.load());
+}
+
+TEST(ConcurrentIDMapTest, StaleIdsDontFindReusedSlots) {
+  std::atomic<int> live_count{0};
+  ValueMap map;
+  const ValueMap::Id id1 = map.Add(std::make_unique<Value>(1, &live_count));
+  EXPECT_TRUE(map.Remove(id1));
+
+  // The slot is reused, under a new generation.
+  const ValueMap::Id id2 = map.Add(std::make_unique<Value>(2, &live_count));
+  EXPECT_EQ(static_cast<uint32_t>(id1), static_cast<uint32_t>(id2));
+  EXPECT_NE(id1, id2);
+  EXPECT_EQ(nullptr, map.Lookup(id1));
+  EXPECT_FALSE(map.Remove(id1));
+  EXPECT_EQ(2, map.Lookup(id2)->id());
+}
+
+TEST(ConcurrentIDMapTest, ManyValues) {
+  std::atomic<int> live_count{0};
+  std::vector<ValueMap::Id> ids;
+  {
+    ValueMap map;
+    // Spans several segments.
+    for (int i = 0; i < 10000; ++i)
+      ids.push_back(map.Add(std::make_unique<Value>(i, &live_count)));
+    for (int i = 0; i < 10000; ++i)
+      EXPECT_EQ(i, map.Lookup(ids[i])->id());
+    for (int i = 0; i < 10000; i += 2)
+      EXPECT_TRUE(map.Remove(ids[i]));
+    EXPECT_EQ(5000u, map.size());
+    for (int i = 1; i < 10000; i += 2)
+      EXPECT_EQ(i, map.Lookup(ids[i])->id());
+  }
+  // The map destroys the remaining and the retired values.
+  EXPECT_EQ(0, live_count.load());
+}
+
+TEST(ConcurrentIDMapTest, ReadScopeDefersReclamation) {
+  std::atomic<int> live_count{0};
+  ValueMap map;
+  const ValueMap::Id id = map.Add(std::make_unique<Value>(1, &live_count));
+
+  Value* value;
+  {
+    ValueMap::ReadScope outer_scope(map);
+    value = outer_scope.Lookup(id);
+    ASSERT_TRUE(value);
+    EXPECT_TRUE(map.Remove(id));
+    {
+      // Nested scopes keep the epoch of the outermost one.
+      ValueMap::ReadScope inner_scope(map);
+      EXPECT_EQ(nullptr, inner_scope.Lookup(id));
+    }
+    map.Reclaim();
+    EXPECT_EQ(1u, map.pending_reclamation_for_testing());
+    EXPECT_TRUE(value->alive());
+  }
+  map.Reclaim();
+  EXPECT_EQ(0u, map.pending_reclamation_for_testing());
+  EXPECT_EQ(0, live_count.load());
+}
+
+namespace {
+
+constexpr int kSlots = 256;
+
+// Looks up the IDs published by the writer, which are often removed by the
+// time they're looked up.
+class ReaderThread : public SimpleThread {
+ public:
+  ReaderThread(const ValueMap* map,
+               const std::atomic<ValueMap::Id>* ids,
+               const std::atomic<bool>* done)
+      : SimpleThread("ConcurrentIDMapReader"),
+        map_(map),
+        ids_(ids),
+        done_(done) {}
+
+  void Run() override {
+    while (!done_->load(std::memory_order_acquire)) {
+      ValueMap::ReadScope scope(*map_);
+      for (int i = 0; i < kSlots; ++i) {
+        const ValueMap::Id id = ids_[i].load(std::memory_order_relaxed);
+        if (Value* value = scope.Lookup(id)) {
+          EXPECT_TRUE(value->alive());
+          // IDs never find the values of other slots.
+          EXPECT_EQ(i, value->id() % kSlots);
+        }
+      }
+    }
+  }
+
+ private:
+  const raw_ptr<const ValueMap> map_;
+  const raw_ptr<const std::atomic<ValueMap::Id>> ids_;
+  const raw_ptr<const std::atomic<bool>> done_;
+};
+
+}  // namespace
+
+// Readers look up IDs while the writer removes them and reuses their slots.
+TEST(ConcurrentIDMapTest, ConcurrentReaders) {
+  constexpr int kIterations = 20000;
+  std::atomic<int> live_count{0};
+  ValueMap map;
+  std::atomic<ValueMap::Id> ids[kSlots];
+  for (int i = 0; i < kSlots; ++i)
+    ids[i] = map.Add(std::make_unique<Value>(i, &live_count));
+
+  std::atomic<bool> done{false};
+  std::vector<std::unique_ptr<ReaderThread>> readers;
+  for (int i = 0; i < 4; ++i) {
+    readers.push_back(std::make_unique<ReaderThread>(&map, ids, &done));
+    readers.back()->Start();
+  }
+
+  for (int i = 0; i < kIterations; ++i) {
+    const int slot = i % kSlots;
+    ASSERT_TRUE(map.Remove(ids[slot].load(std::memory_order_relaxed)));
+    ids[slot].store(map.Add(std::make_unique<Value>(
+                        slot + kSlots * (i / kSlots + 1), &live_count)),
+                    std::memory_order_relaxed);
+  }
+  done.store(true, std::memory_order_release);
+  for (auto& reader : readers)
+    reader->Join();
+
+  map.Reclaim();
+  EXPECT_EQ(0u, map.pending_reclamation_for_testing());
+  EXPECT_EQ(kSlots, live_count.load());
+}
+
+}  // namespace base
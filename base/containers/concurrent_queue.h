@@ -0,0 +1,473 @@
+// Copyright 2022 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#ifndef BASE_CONTAINERS_CONCURRENT_QUEUE_H_
+#define BASE_CONTAINERS_CONCURRENT_QUEUE_H_
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include <algorithm>
+#include <atomic>
+#include <memory>
+#include <new>
+#include <utility>
+
+#include "base/check_op.h"
+#include "base/containers/span.h"
+#include "base/synchronization/condition_variable.h"
+#include "base/synchronization/lock.h"
+
+// Bounded FIFO queues for handing items between threads without a lock:
+//
+//   SPSCQueue: for exactly one producer thread and one consumer thread.
+//   MPMCQueue: for any number of producer and consumer threads.
+//
+// Both have a fixed capacity, rounded up to a power of two and allocated on
+// construction. TryPush() and TryPop() never block: they fail when the queue is
+// full or empty, respectively. Push() and Pop() block until they succeed, but
+// only take a lock when the queue is full or empty: the other side only takes
+// it to wake them up, when there is a waiting thread.
+//
+//   base::SPSCQueue<std::unique_ptr<Frame>> frames(64);
+//
+//   // Decoder thread.
+//   frames.Push(std::move(frame));
+//
+//   // Compositor thread.
+//   std::unique_ptr<Frame> frame;
+//   while (frames.TryPop(&frame))
+//     Draw(*frame);
+//
+// The batch variants TryPushBatch() and TryPopBatch() move as many items as
+// possible at once, and cost about as much as a single TryPush() or TryPop().
+
+namespace base {
+
+namespace internal {
+
+// The size of the cache lines which the indices of the queues are aligned to,
+// so that the producers and the consumers don't contend for them.
+constexpr size_t kQueueCacheLineSize = 64;
+
+// Returns the smallest power of two which is at least |capacity|.
+constexpr size_t QueueCapacity(size_t capacity) {
+  size_t power_of_two = 1;
+  while (power_of_two < capacity)
+    power_of_two <<= 1;
+  return power_of_two;
+}
+
+// Parks the threads which wait for a queue to become non-empty, or non-full.
+class QueueWaiter {
+ public:
+  QueueWaiter() : cv_(&lock_) {}
+  QueueWaiter(const QueueWaiter&) = delete;
+  QueueWaiter& operator=(const QueueWaiter&) = delete;
+  ~QueueWaiter() = default;
+
+  // Waits until |is_ready| returns true. A thread which makes it true must then
+  // call Notify().
+  template <typename Predicate>
+  void Wait(Predicate is_ready) {
+    waiters_.fetch_add(1, std::memory_order_relaxed);
+    // Orders the increment before the loads of |is_ready|, as Notify() orders
+    // the change which makes it true before its load of |waiters_|: either
+    // |is_ready| sees the change, or Notify() sees the waiter.
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+    {
+      AutoLock auto_lock(lock_);
+      while (!is_ready())
+        cv_.Wait();
+    }
+    waiters_.fetch_sub(1, std::memory_order_relaxed);
+  }
+
+  // Wakes up the waiting threads, if any.
+  void Notify() {
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+    if (!waiters_.load(std::memory_order_relaxed))
+      return;
+    AutoLock auto_lock(lock_);
+    cv_.Broadcast();
+  }
+
+ private:
+  std::atomic<int> waiters_{0};
+  Lock lock_;
+  ConditionVariable cv_;
+};
+
+}  // namespace internal
+
+// A bounded queue for a single producer thread and a single consumer thread.
+// The methods of each side must only be called from one thread at a time.
+template <typename T>
+class SPSCQueue {
+ public:
+  // Holds up to |capacity| items, rounded up to a power of two.
+  explicit SPSCQueue(size_t capacity)
+      : capacity_(internal::QueueCapacity(capacity)),
+        mask_(capacity_ - 1),
+        slots_(std::make_unique<Slot[]>(capacity_)) {
+    DCHECK_GT(capacity, 0u);
+  }
+
+  SPSCQueue(const SPSCQueue&) = delete;
+  SPSCQueue& operator=(const SPSCQueue&) = delete;
+
+  ~SPSCQueue() {
+    const size_t tail = tail_.load(std::memory_order_relaxed);
+    for (size_t i = head_.load(std::memory_order_relaxed); i != tail; ++i)
+      slots_[i & mask_].value.~T();
+  }
+
+  size_t capacity() const { return capacity_; }
+
+  // Producer side.
+
+  // Appends |value| and returns true, or returns false if the queue is full.
+  bool TryPush(const T& value) { return TryEmplace(value); }
+  bool TryPush(T&& value) { return TryEmplace(std::move(value)); }
+
+  // Constructs an item from |args| at the back of the queue and returns true,
+  // or returns false, without using |args|, if the queue is full.
+  template <typename... Args>
+  bool TryEmplace(Args&&... args) {
+    const size_t tail = tail_.load(std::memory_order_relaxed);
+    if (tail - cached_head_ == capacity_) {
+      cached_head_ = head_.load(std::memory_order_acquire);
+      if (tail - cached_head_ == capacity_)
+        return false;
+    }
+    new (&slots_[tail & mask_].value) T(std::forward<Args>(args)...);
+    tail_.store(tail + 1, std::memory_order_release);
+    not_empty_.Notify();
+    return true;
+  }
+
+  // Moves the longest prefix of |values| which fits into the queue, and
+  // returns its size.
+  size_t TryPushBatch(span<T> values) {
+    const size_t tail = tail_.load(std::memory_order_relaxed);
+    if (tail - cached_head_ + values.size() > capacity_)
+      cached_head_ = head_.load(std::memory_order_acquire);
+    const size_t count =
+        std::min(values.size(), capacity_ - (tail - cached_head_));
+    if (!count)
+      return 0;
+    for (size_t i = 0; i < count; ++i)
+      new (&slots_[(tail + i) & mask_].value) T(std::move(values[i]));
+    tail_.store(tail + count, std::memory_order_release);
+    not_empty_.Notify();
+    return count;
+  }
+
+  // Appends |value|, waiting for the consumer to make room if the queue is
+  // full.
+  void Push(T value) {
+    while (!TryEmplace(std::move(value))) {
+      not_full_.Wait([this]() {
+        return tail_.load(std::memory_order_relaxed) -
+                   head_.load(std::memory_order_acquire) <
+               capacity_;
+      });
+    }
+  }
+
+  // Consumer side.
+
+  // Moves the front item into |*value| and returns true, or returns false if
+  // the queue is empty.
+  bool TryPop(T* value) {
+    const size_t head = head_.load(std::memory_order_relaxed);
+    if (cached_tail_ == head) {
+      cached_tail_ = tail_.load(std::memory_order_acquire);
+      if (cached_tail_ == head)
+        return false;
+    }
+    T& item = slots_[head & mask_].value;
+    *value = std::move(item);
+    item.~T();
+    head_.store(head + 1, std::memory_order_release);
+    not_full_.Notify();
+    return true;
+  }
+
+  // Moves up to |values.size()| items from the front of the queue into
+  // |values|, and returns how many.
+  size_t TryPopBatch(span<T> values) {
+    const size_t head = head_.load(std::memory_order_relaxed);
+    if (cached_tail_ - head < values.size())
+      cached_tail_ = tail_.load(std::memory_order_acquire);
+    const size_t count = std::min(values.size(), cached_tail_ - head);
+    if (!count)
+      return 0;
+    for (size_t i = 0; i < count; ++i) {
+      T& item = slots_[(head + i) & mask_].value;
+      values[i] = std::move(item);
+      item.~T();
+    }
+    head_.store(head + count, std::memory_order_release);
+    not_full_.Notify();
+    return count;
+  }
+
+  // Removes the front item, waiting for the producer to push one if the queue
+  // is empty.
+  T Pop() {
+    const size_t head = head_.load(std::memory_order_relaxed);
+    if (cached_tail_ == head) {
+      cached_tail_ = tail_.load(std::memory_order_acquire);
+      if (cached_tail_ == head) {
+        not_empty_.Wait([this, head]() {
+          cached_tail_ = tail_.load(std::memory_order_acquire);
+          return cached_tail_ != head;
+        });
+      }
+    }
+    T& item = slots_[head & mask_].value;
+    T value = std::move(item);
+    item.~T();
+    head_.store(head + 1, std::memory_order_release);
+    not_full_.Notify();
+    return value;
+  }
+
+ private:
+  union Slot {
+    Slot() {}
+    ~Slot() {}
+    T value;
+  };
+
+  const size_t capacity_;
+  const size_t mask_;
+  const std::unique_ptr<Slot[]> slots_;
+
+  // The index of the front item, written by the consumer, and its copy of
+  // |tail_|, which it only reloads when the queue looks empty.
+  alignas(internal::kQueueCacheLineSize) std::atomic<size_t> head_{0};
+  size_t cached_tail_ = 0;
+
+  // The index past the back item, written by the producer, and its copy of
+  // |head_|, which it only reloads when the queue looks full.
+  alignas(internal::kQueueCacheLineSize) std::atomic<size_t> tail_{0};
+  size_t cached_head_ = 0;
+
+  alignas(internal::kQueueCacheLineSize) internal::QueueWaiter not_empty_;
+  internal::QueueWaiter not_full_;
+};
+
+// A bounded queue for any number of producer and consumer threads, after
+// Dmitry Vyukov's bounded MPMC queue: each slot has a sequence number, which
+// tells the producers and the consumers whose turn it is to use the slot, so
+// that a push or a pop takes a single compare-and-swap of the shared index of
+// its side. The items are popped in the order of the indices which they were
+// pushed to, which is the order of the pushes of each producer.
+template <typename T>
+class MPMCQueue {
+ public:
+  // Holds up to |capacity| items, rounded up to a power of two, and at least 2.
+  explicit MPMCQueue(size_t capacity)
+      : capacity_(internal::QueueCapacity(std::max<size_t>(capacity, 2))),
+        mask_(capacity_ - 1),
+        cells_(std::make_unique<Cell[]>(capacity_)) {
+    DCHECK_GT(capacity, 0u);
+    for (size_t i = 0; i < capacity_; ++i)
+      cells_[i].sequence.store(i, std::memory_order_relaxed);
+  }
+
+  MPMCQueue(const MPMCQueue&) = delete;
+  MPMCQueue& operator=(const MPMCQueue&) = delete;
+
+  // Must not race with any other method.
+  ~MPMCQueue() {
+    const size_t tail = enqueue_pos_.load(std::memory_order_relaxed);
+    for (size_t i = dequeue_pos_.load(std::memory_order_relaxed); i != tail;
+         ++i) {
+      cells_[i & mask_].value.~T();
+    }
+  }
+
+  size_t capacity() const { return capacity_; }
+
+  // Appends |value| and returns true, or returns false if the queue is full.
+  bool TryPush(const T& value) { return TryEmplace(value); }
+  bool TryPush(T&& value) { return TryEmplace(std::move(value)); }
+
+  // Constructs an item from |args| at the back of the queue and returns true,
+  // or returns false, without using |args|, if the queue is full.
+  template <typename... Args>
+  bool TryEmplace(Args&&... args) {
+    const size_t pos = ClaimPush(1);
+    if (pos == kNone)
+      return false;
+    Cell& cell = cells_[pos & mask_];
+    new (&cell.value) T(std::forward<Args>(args)...);
+    cell.sequence.store(pos + 1, std::memory_order_release);
+    not_empty_.Notify();
+    return true;
+  }
+
+  // Moves the longest prefix of |values| which fits into consecutive slots of
+  // the queue, and returns its size.
+  size_t TryPushBatch(span<T> values) {
+    if (values.empty())
+      return 0;
+    size_t count = values.size();
+    const size_t pos = ClaimPush(count, &count);
+    if (pos == kNone)
+      return 0;
+    for (size_t i = 0; i < count; ++i) {
+      Cell& cell = cells_[(pos + i) & mask_];
+      new (&cell.value) T(std::move(values[i]));
+      cell.sequence.store(pos + i + 1, std::memory_order_release);
+    }
+    not_empty_.Notify();
+    return count;
+  }
+
+  // Appends |value|, waiting for a consumer to make room if the queue is full.
+  void Push(T value) {
+    while (!TryEmplace(std::move(value))) {
+      not_full_.Wait([this]() {
+        const size_t pos = enqueue_pos_.load(std::memory_order_relaxed);
+        return static_cast<intptr_t>(
+                   cells_[pos & mask_].sequence.load(
+                       std::memory_order_acquire) -
+                   pos) >= 0;
+      });
+    }
+  }
+
+  // Moves the front item into |*value| and returns true, or returns false if
+  // the queue is empty.
+  bool TryPop(T* value) {
+    const size_t pos = ClaimPop(1);
+    if (pos == kNone)
+      return false;
+    ReleasePopped(pos, value);
+    not_full_.Notify();
+    return true;
+  }
+
+  // Moves up to |values.size()| items from the front of the queue into
+  // |values|, and returns how many.
+  size_t TryPopBatch(span<T> values) {
+    if (values.empty())
+      return 0;
+    size_t count = values.size();
+    const size_t pos = ClaimPop(count, &count);
+    if (pos == kNone)
+      return 0;
+    for (size_t i = 0; i < count; ++i)
+      ReleasePopped(pos + i, &values[i]);
+    not_full_.Notify();
+    return count;
+  }
+
+  // Removes the front item, waiting for a producer to push one if the queue is
+  // empty.
+  T Pop() {
+    for (;;) {
+      const size_t pos = ClaimPop(1);
+      if (pos != kNone) {
+        Cell& cell = cells_[pos & mask_];
+        T value = std::move(cell.value);
+        cell.value.~T();
+        cell.sequence.store(pos + capacity_, std::memory_order_release);
+        not_full_.Notify();
+        return value;
+      }
+      not_empty_.Wait([this]() {
+        const size_t pos = dequeue_pos_.load(std::memory_order_relaxed);
+        return static_cast<intptr_t>(
+                   cells_[pos & mask_].sequence.load(
+                       std::memory_order_acquire) -
+                   (pos + 1)) >= 0;
+      });
+    }
+  }
+
+ private:
+  static constexpr size_t kNone = ~size_t{0};
+
+  struct Cell {
+    Cell() {}
+    ~Cell() {}
+
+    std::atomic<size_t> sequence;
+    union {
+      T value;
+    };
+  };
+
+  // Claims up to |max_count| consecutive slots whose sequence is
+  // |offset| + their index, starting at |*index|, and returns the first one,
+  // or kNone if the first slot isn't ready. Stores the number of claimed slots
+  // in |*count|, if set.
+  size_t Claim(std::atomic<size_t>* index,
+               size_t offset,
+               size_t max_count,
+               size_t* count) {
+    size_t pos = index->load(std::memory_order_relaxed);
+    for (;;) {
+      const size_t sequence =
+          cells_[pos & mask_].sequence.load(std::memory_order_acquire);
+      const intptr_t diff = static_cast<intptr_t>(sequence - (pos + offset));
+      if (diff < 0)
+        return kNone;
+      if (diff > 0) {
+        // Another thread claimed the slot.
+        pos = index->load(std::memory_order_relaxed);
+        continue;
+      }
+      // The slots after the first one are ready as long as |*index| doesn't
+      // change, since only the thread which claims a slot changes its sequence.
+      size_t ready = 1;
+      while (ready < max_count &&
+             cells_[(pos + ready) & mask_].sequence.load(
+                 std::memory_order_acquire) == pos + ready + offset) {
+        ++ready;
+      }
+      if (index->compare_exchange_weak(pos, pos + ready,
+                                       std::memory_order_relaxed)) {
+        if (count)
+          *count = ready;
+        return pos;
+      }
+    }
+  }
+
+  size_t ClaimPush(size_t max_count, size_t* count = nullptr) {
+    return Claim(&enqueue_pos_, 0, max_count, count);
+  }
+  size_t ClaimPop(size_t max_count, size_t* count = nullptr) {
+    return Claim(&dequeue_pos_, 1, max_count, count);
+  }
+
+  // Moves the item of the claimed slot |pos| into |*value|, and hands the slot
+  // to the producer of the next round.
+  void ReleasePopped(size_t pos, T* value) {
+    Cell& cell = cells_[pos & mask_];
+    *value = std::move(cell.value);
+    cell.value.~T();
+    cell.sequence.store(pos + capacity_, std::memory_order_release);
+  }
+
+  const size_t capacity_;
+  const size_t mask_;
+  const std::unique_ptr<Cell[]> cells_;
+
+  alignas(internal::kQueueCacheLineSize) std::atomic<size_t> enqueue_pos_{0};
+  alignas(internal::kQueueCacheLineSize) std::atomic<size_t> dequeue_pos_{0};
+
+  alignas(internal::kQueueCacheLineSize) internal::QueueWaiter not_empty_;
+  internal::QueueWaiter not_full_;
+};
+
+}  // namespace base
+
+#endif  // BASE_CONTAINERS_CONCURRENT_QUEUE_H_
@@ -0,0 +1,188 @@
+// Copyright 2022 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "base/containers/concurrent_queue.h"
+
+#include <stdint.h>
+
+#include <atomic>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "base/containers/circular_deque.h"
+#include "base/memory/raw_ptr.h"
+#include "base/strings/string_number_conversions.h"
+#include "base/synchronization/lock.h"
+#include "base/thread_annotations.h"
+#include "base/threading/platform_thread.h"
+#include "base/time/time.h"
+#include "base/timer/lap_timer.h"
+#include "testing/gtest/include/gtest/gtest.h"
+#include "testing/perf/perf_result_reporter.h"
+
+namespace base {
+namespace {
+
+constexpr int kWarmupRuns = 1;
+constexpr TimeDelta kTimeLimit = Seconds(1);
+constexpr int kTimeCheckInterval = 10000;
+constexpr size_t kCapacity = 1024;
+
+constexpr char kMetricPrefixConcurrentQueue[] = "ConcurrentQueue.";
+constexpr char kMetricPopThroughput[] = "pop_throughput";
+
+perf_test::PerfResultReporter SetUpReporter(const std::string& story_name) {
+  perf_test::PerfResultReporter reporter(kMetricPrefixConcurrentQueue,
+                                         story_name);
+  reporter.RegisterImportantMetric(kMetricPopThroughput, "runs/s");
+  return reporter;
+}
+
+// A circular_deque guarded by a Lock, as the items are handed between threads
+// without the concurrent queues. It's unbounded, so TryPush() always succeeds.
+class LockedDeque {
+ public:
+  explicit LockedDeque(size_t capacity) {}
+
+  bool TryPush(uint64_t value) {
+    AutoLock auto_lock(lock_);
+    deque_.push_back(value);
+    return true;
+  }
+
+  bool TryPop(uint64_t* value) {
+    AutoLock auto_lock(lock_);
+    if (deque_.empty())
+      return false;
+    *value = deque_.front();
+    deque_.pop_front();
+    return true;
+  }
+
+ private:
+  Lock lock_;
+  circular_deque<uint64_t> deque_ GUARDED_BY(lock_);
+};
+
+template <typename Queue>
+class PushLoop : public PlatformThread::Delegate {
+ public:
+  explicit PushLoop(Queue* queue) : queue_(queue) {}
+  ~PushLoop() override = default;
+
+  void ThreadMain() override {
+    uint64_t value = 0;
+    while (!should_stop_.load(std::memory_order_relaxed)) {
+      if (!queue_->TryPush(value++))
+        PlatformThread::YieldCurrentThread();
+    }
+  }
+
+  // Called from another thread to stop the loop.
+  void Stop() { should_stop_ = true; }
+
+ private:
+  raw_ptr<Queue> queue_;
+  std::atomic<bool> should_stop_{false};
+};
+
+// Measures the rate at which this thread pops the items which
+// |num_producers| other threads push.
+template <typename Queue>
+void RunPopTest(const std::string& queue_name,
+                std::vector<int> num_producers_list) {
+  for (int num_producers : num_producers_list) {
+    Queue queue(kCapacity);
+    std::vector<std::unique_ptr<PushLoop<Queue>>> loops;
+    std::vector<PlatformThreadHandle> thread_handles(num_producers);
+    for (auto& thread_handle : thread_handles) {
+      loops.push_back(std::make_unique<PushLoop<Queue>>(&queue));
+      ASSERT_TRUE(
+          PlatformThread::Create(0, loops.back().get(), &thread_handle));
+    }
+
+    LapTimer timer(kWarmupRuns, kTimeLimit, kTimeCheckInterval);
+    uint64_t value;
+    do {
+      if (queue.TryPop(&value))
+        timer.NextLap();
+      else
+        PlatformThread::YieldCurrentThread();
+    } while (!timer.HasTimeLimitExpired());
+
+    for (auto& loop : loops)
+      loop->Stop();
+    for (auto& thread_handle : thread_handles)
+      PlatformThread::Join(thread_handle);
+
+    auto reporter = SetUpReporter(queue_name + "_with_" +
+                                  NumberToString(num_producers) + "_producers");
+    reporter.AddResult(kMetricPopThroughput, timer.LapsPerSecond());
+  }
+}
+
+// Measures the rate at which this thread pops the items which another thread
+// pushes, in batches.
+template <typename Queue>
+void RunBatchPopTest(const std::string& queue_name) {
+  Queue queue(kCapacity);
+  std::atomic<bool> should_stop{false};
+
+  class BatchPushLoop : public PlatformThread::Delegate {
+   public:
+    BatchPushLoop(Queue* queue, std::atomic<bool>* should_stop)
+        : queue_(queue), should_stop_(should_stop) {}
+    ~BatchPushLoop() override = default;
+
+    void ThreadMain() override {
+      uint64_t values[64] = {};
+      while (!should_stop_->load(std::memory_order_relaxed)) {
+        if (!queue_->TryPushBatch(values))
+          PlatformThread::YieldCurrentThread();
+      }
+    }
+
+   private:
+    raw_ptr<Queue> queue_;
+    raw_ptr<std::atomic<bool>> should_stop_;
+  } loop(&queue, &should_stop);
+  PlatformThreadHandle thread_handle;
+  ASSERT_TRUE(PlatformThread::Create(0, &loop, &thread_handle));
+
+  // Each lap pops up to 64 items, and counts as their number of laps.
+  LapTimer timer(kWarmupRuns, kTimeLimit, kTimeCheckInterval);
+  uint64_t values[64];
+  do {
+    const size_t popped = queue.TryPopBatch(values);
+    if (!popped)
+      PlatformThread::YieldCurrentThread();
+    for (size_t i = 0; i < popped; ++i)
+      timer.NextLap();
+  } while (!timer.HasTimeLimitExpired());
+
+  should_stop = true;
+  PlatformThread::Join(thread_handle);
+
+  auto reporter = SetUpReporter(queue_name + "_batch");
+  reporter.AddResult(kMetricPopThroughput, timer.LapsPerSecond());
+}
+
+}  // namespace
+
+TEST(ConcurrentQueuePerfTest, LockedCircularDeque) {
+  RunPopTest<LockedDeque>("locked_circular_deque", {1, 4});
+}
+
+TEST(ConcurrentQueuePerfTest, SPSCQueue) {
+  RunPopTest<SPSCQueue<uint64_t>>("spsc_queue", {1});
+  RunBatchPopTest<SPSCQueue<uint64_t>>("spsc_queue");
+}
+
+TEST(ConcurrentQueuePerfTest, MPMCQueue) {
+  RunPopTest<MPMCQueue<uint64_t>>("mpmc_queue", {1, 4});
+  RunBatchPopTest<MPMCQueue<uint64_t>>("mpmc_queue");
+}
+
+}  // namespace base
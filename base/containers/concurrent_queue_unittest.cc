@@ -0,0 +1,272 @@
+// Copyright 2022 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "base/containers/concurrent_queue.h"
+
+#include <stdint.h>
+
+#include <algorithm>
+#include <iterator>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "base/memory/raw_ptr.h"
+#include "base/threading/platform_thread.h"
+#include "testing/gtest/include/gtest/gtest.h"
+
+namespace base {
+
+namespace {
+
+// Counts the live instances, to check that the queues destroy their items.
+class Counted {
+ public:
+  explicit Counted(int* count) : count_(count) { ++*count_; }
+  Counted(const Counted& other) : count_(other.count_) { ++*count_; }
+  Counted& operator=(const Counted&) = default;
+  ~Counted() { --*count_; }
+
+ private:
+  raw_ptr<int> count_;
+};
+
+template <typename Queue>
+class Producer : public PlatformThread::Delegate {
+ public:
+  Producer(Queue* queue, uint64_t first, uint64_t count, bool batch)
+      : queue_(queue), first_(first), count_(count), batch_(batch) {}
+  ~Producer() override = default;
+
+  void ThreadMain() override {
+    uint64_t value = first_;
+    const uint64_t end = first_ + count_;
+    while (value < end) {
+      if (!batch_) {
+        queue_->Push(value++);
+        continue;
+      }
+      std::vector<uint64_t> values;
+      for (uint64_t i = value; i < end && values.size() < 7; ++i)
+        values.push_back(i);
+      const size_t pushed = queue_->TryPushBatch(values);
+      if (!pushed)
+        PlatformThread::YieldCurrentThread();
+      value += pushed;
+    }
+  }
+
+ private:
+  const raw_ptr<Queue> queue_;
+  const uint64_t first_;
+  const uint64_t count_;
+  const bool batch_;
+};
+
+template <typename Queue>
+class Consumer : public PlatformThread::Delegate {
+ public:
+  Consumer(Queue* queue, uint64_t count, bool batch)
+      : queue_(queue), count_(count), batch_(batch) {}
+  ~Consumer() override = default;
+
+  void ThreadMain() override {
+    while (values_.size() < count_) {
+      if (!batch_) {
+        values_.push_back(queue_->Pop());
+        continue;
+      }
+      uint64_t values[5];
+      const size_t max_count =
+          std::min<size_t>(std::size(values), count_ - values_.size());
+      const size_t popped =
+          queue_->TryPopBatch(make_span(values, max_count));
+      if (!popped)
+        PlatformThread::YieldCurrentThread();
+      values_.insert(values_.end(), values, values + popped);
+    }
+  }
+
+  const std::vector<uint64_t>& values() const { return values_; }
+
+ private:
+  const raw_ptr<Queue> queue_;
+  const uint64_t count_;
+  const bool batch_;
+  std::vector<uint64_t> values_;
+};
+
+}  // namespace
+
+TEST(SPSCQueueTest, Basic) {
+  SPSCQueue<std::string> queue(3);
+  EXPECT_EQ(4u, queue.capacity());
+  std::string value;
+  EXPECT_FALSE(queue.TryPop(&value));
+
+  EXPECT_TRUE(queue.TryPush("one"));
+  EXPECT_TRUE(queue.TryEmplace(3, 't'));
+  EXPECT_TRUE(queue.TryPush("three"));
+  EXPECT_TRUE(queue.TryPush("four"));
+  EXPECT_FALSE(queue.TryPush("five"));
+
+  EXPECT_TRUE(queue.TryPop(&value));
+  EXPECT_EQ("one", value);
+  EXPECT_EQ("ttt", queue.Pop());
+  EXPECT_TRUE(queue.TryPush("five"));
+  EXPECT_TRUE(queue.TryPush("six"));
+  EXPECT_FALSE(queue.TryPush("seven"));
+
+  std::string values[3];
+  EXPECT_EQ(3u, queue.TryPopBatch(values));
+  EXPECT_EQ("three", values[0]);
+  EXPECT_EQ("four", values[1]);
+  EXPECT_EQ("five", values[2]);
+  EXPECT_EQ(1u, queue.TryPopBatch(values));
+  EXPECT_EQ("six", values[0]);
+  EXPECT_EQ(0u, queue.TryPopBatch(values));
+}
+
+TEST(SPSCQueueTest, PushBatch) {
+  SPSCQueue<std::unique_ptr<int>> queue(4);
+  std::vector<std::unique_ptr<int>> values;
+  for (int i = 0; i < 6; ++i)
+    values.push_back(std::make_unique<int>(i));
+
+  // Only the prefix which fits is moved.
+  EXPECT_EQ(4u, queue.TryPushBatch(values));
+  EXPECT_FALSE(values[3]);
+  ASSERT_TRUE(values[4]);
+  EXPECT_EQ(0u, queue.TryPushBatch(make_span(values).subspan(4)));
+
+  std::unique_ptr<int> value;
+  EXPECT_TRUE(queue.TryPop(&value));
+  EXPECT_EQ(0, *value);
+  EXPECT_EQ(1u, queue.TryPushBatch(make_span(values).subspan(4)));
+  for (int i = 1; i < 5; ++i)
+    EXPECT_EQ(i, *queue.Pop());
+}
+
+TEST(SPSCQueueTest, DestroysItems) {
+  int count = 0;
+  {
+    SPSCQueue<Counted> queue(8);
+    for (int i = 0; i < 6; ++i)
+      EXPECT_TRUE(queue.TryEmplace(&count));
+    queue.Pop();
+    EXPECT_EQ(5, count);
+  }
+  EXPECT_EQ(0, count);
+}
+
+TEST(SPSCQueueTest, Threads) {
+  constexpr uint64_t kCount = 100000;
+  for (bool batch : {false, true}) {
+    SPSCQueue<uint64_t> queue(16);
+    Producer<SPSCQueue<uint64_t>> producer(&queue, 0, kCount, batch);
+    Consumer<SPSCQueue<uint64_t>> consumer(&queue, kCount, batch);
+    PlatformThreadHandle producer_handle;
+    PlatformThreadHandle consumer_handle;
+    ASSERT_TRUE(PlatformThread::Create(0, &producer, &producer_handle));
+    ASSERT_TRUE(PlatformThread::Create(0, &consumer, &consumer_handle));
+    PlatformThread::Join(producer_handle);
+    PlatformThread::Join(consumer_handle);
+
+    ASSERT_EQ(kCount, consumer.values().size());
+    for (uint64_t i = 0; i < kCount; ++i)
+      ASSERT_EQ(i, consumer.values()[i]);
+  }
+}
+
+TEST(MPMCQueueTest, Basic) {
+  MPMCQueue<std::string> queue(1);
+  EXPECT_EQ(2u, queue.capacity());
+  std::string value;
+  EXPECT_FALSE(queue.TryPop(&value));
+
+  EXPECT_TRUE(queue.TryPush("one"));
+  EXPECT_TRUE(queue.TryEmplace(3, 't'));
+  EXPECT_FALSE(queue.TryPush("three"));
+  EXPECT_TRUE(queue.TryPop(&value));
+  EXPECT_EQ("one", value);
+  EXPECT_TRUE(queue.TryPush("three"));
+  EXPECT_EQ("ttt", queue.Pop());
+  EXPECT_EQ("three", queue.Pop());
+  EXPECT_FALSE(queue.TryPop(&value));
+}
+
+TEST(MPMCQueueTest, Batch) {
+  MPMCQueue<std::unique_ptr<int>> queue(4);
+  std::vector<std::unique_ptr<int>> values;
+  for (int i = 0; i < 6; ++i)
+    values.push_back(std::make_unique<int>(i));
+
+  EXPECT_EQ(4u, queue.TryPushBatch(values));
+  EXPECT_EQ(0u, queue.TryPushBatch(make_span(values).subspan(4)));
+
+  std::unique_ptr<int> popped[3];
+  EXPECT_EQ(3u, queue.TryPopBatch(popped));
+  for (int i = 0; i < 3; ++i)
+    EXPECT_EQ(i, *popped[i]);
+  EXPECT_EQ(2u, queue.TryPushBatch(make_span(values).subspan(4)));
+  EXPECT_EQ(3u, queue.TryPopBatch(popped));
+  for (int i = 0; i < 3; ++i)
+    EXPECT_EQ(i + 3, *popped[i]);
+  EXPECT_EQ(0u, queue.TryPopBatch(popped));
+}
+
+TEST(MPMCQueueTest, DestroysItems) {
+  int count = 0;
+  {
+    MPMCQueue<Counted> queue(8);
+    for (int i = 0; i < 8; ++i)
+      EXPECT_TRUE(queue.TryEmplace(&count));
+    EXPECT_FALSE(queue.TryEmplace(&count));
+    queue.Pop();
+    queue.Pop();
+    EXPECT_EQ(6, count);
+  }
+  EXPECT_EQ(0, count);
+}
+
+TEST(MPMCQueueTest, Threads) {
+  constexpr uint64_t kCountPerProducer = 20000;
+  constexpr size_t kThreads = 4;
+  for (bool batch : {false, true}) {
+    using Queue = MPMCQueue<uint64_t>;
+    Queue queue(16);
+    std::vector<std::unique_ptr<Producer<Queue>>> producers;
+    std::vector<std::unique_ptr<Consumer<Queue>>> consumers;
+    std::vector<PlatformThreadHandle> thread_handles(2 * kThreads);
+    for (size_t i = 0; i < kThreads; ++i) {
+      producers.push_back(std::make_unique<Producer<Queue>>(
+          &queue, i * kCountPerProducer, kCountPerProducer, batch));
+      consumers.push_back(
+          std::make_unique<Consumer<Queue>>(&queue, kCountPerProducer, batch));
+      ASSERT_TRUE(PlatformThread::Create(0, producers.back().get(),
+                                         &thread_handles[2 * i]));
+      ASSERT_TRUE(PlatformThread::Create(0, consumers.back().get(),
+                                         &thread_handles[2 * i + 1]));
+    }
+    for (auto& thread_handle : thread_handles)
+      PlatformThread::Join(thread_handle);
+
+    // Every value is popped once, and the values of each producer are popped
+    // in order by each consumer.
+    std::vector<int> popped(kThreads * kCountPerProducer);
+    for (const auto& consumer : consumers) {
+      std::vector<uint64_t> last(kThreads, 0);
+      for (uint64_t value : consumer->values()) {
+        ++popped[value];
+        const size_t producer = value / kCountPerProducer;
+        EXPECT_LE(last[producer], value);
+        last[producer] = value;
+      }
+    }
+    for (int count : popped)
+      ASSERT_EQ(1, count);
+  }
+}
+
+}  // namespace base
@@ -0,0 +1,34 @@
+// Copyright 2022 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#ifndef BASE_CONTAINERS_FLAT_HASH_MAP_H_
+#define BASE_CONTAINERS_FLAT_HASH_MAP_H_
+
+#include "third_party/abseil-cpp/absl/container/flat_hash_map.h"
+
+namespace base {
+
+// An open-addressing hash map, which stores its entries by value in a single
+// array, probed in groups of 16 control bytes with SIMD instructions where
+// they're available. This is absl::flat_hash_map: see the "Map and set
+// selection" section of base/containers/README.md for when to prefer it.
+//
+// As with std::unordered_map, inserts may invalidate the iterators, but they
+// also move the entries: use a node-based map, or store the values by pointer,
+// if references to them must stay valid.
+//
+// The probing relies on all the bits of the hashes, so the hasher must mix
+// them: the default hasher, absl::Hash, does, and supports heterogeneous
+// lookups of strings, but std::hash of integers is the identity on most
+// platforms, which makes for long probe sequences with sequential keys.
+//
+//   base::flat_hash_map<std::string, int> map;
+//   map["one"] = 1;
+//   auto it = map.find(base::StringPiece("one"));  // No std::string copy.
+template <class Key, class Value, class... Args>
+using flat_hash_map = absl::flat_hash_map<Key, Value, Args...>;
+
+}  // namespace base
+
+#endif  // BASE_CONTAINERS_FLAT_HASH_MAP_H_
@@ -0,0 +1,160 @@
+// Copyright 2022 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "base/containers/flat_hash_map.h"
+
+#include <stdint.h>
+
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "base/rand_util.h"
+#include "base/strings/string_number_conversions.h"
+#include "base/time/time.h"
+#include "base/timer/lap_timer.h"
+#include "testing/gtest/include/gtest/gtest.h"
+#include "testing/perf/perf_result_reporter.h"
+
+namespace base {
+namespace {
+
+constexpr TimeDelta kTimeLimit = Seconds(2);
+constexpr int kWarmupRuns = 1;
+constexpr int kTimeCheckInterval = 1;
+
+constexpr char kMetricPrefixHashMap[] = "HashMap.";
+constexpr char kMetricThroughput[] = "throughput";
+constexpr char kMetricTimePerEntry[] = "time_per_entry";
+
+perf_test::PerfResultReporter SetUpReporter(const std::string& story_name) {
+  perf_test::PerfResultReporter reporter(kMetricPrefixHashMap, story_name);
+  reporter.RegisterImportantMetric(kMetricThroughput, "runs/s");
+  reporter.RegisterImportantMetric(kMetricTimePerEntry, "ns");
+  return reporter;
+}
+
+void ReportResults(const std::string& story_name,
+                   const LapTimer& timer,
+                   size_t entries_per_lap) {
+  auto reporter = SetUpReporter(story_name);
+  const float entries_per_second = timer.LapsPerSecond() * entries_per_lap;
+  reporter.AddResult(kMetricThroughput, entries_per_second);
+  reporter.AddResult(kMetricTimePerEntry, 1e9 / entries_per_second);
+}
+
+// Random keys, as the IDs of a routing or a session table would be.
+std::vector<uint64_t> GenerateKeys(size_t count) {
+  std::vector<uint64_t> keys;
+  for (size_t i = 0; i < count; ++i)
+    keys.push_back(RandUint64());
+  return keys;
+}
+
+template <class Map>
+Map BuildMap(const std::vector<uint64_t>& keys) {
+  Map map;
+  for (uint64_t key : keys)
+    map[key] = key;
+  return map;
+}
+
+template <class Map>
+void RunBuild(const std::vector<uint64_t>& keys,
+              const std::string& story_name) {
+  LapTimer timer(kWarmupRuns, kTimeLimit, kTimeCheckInterval);
+  do {
+    EXPECT_EQ(keys.size(), BuildMap<Map>(keys).size());
+    timer.NextLap();
+  } while (!timer.HasTimeLimitExpired());
+  ReportResults(story_name, timer, keys.size());
+}
+
+template <class Map>
+void RunLookup(const std::vector<uint64_t>& keys,
+               const std::vector<uint64_t>& lookups,
+               size_t expected_found,
+               const std::string& story_name) {
+  const Map map = BuildMap<Map>(keys);
+  size_t found;
+  LapTimer timer(kWarmupRuns, kTimeLimit, kTimeCheckInterval);
+  do {
+    found = 0;
+    for (uint64_t key : lookups)
+      found += map.find(key) != map.end();
+    timer.NextLap();
+  } while (!timer.HasTimeLimitExpired());
+  ReportResults(story_name, timer, lookups.size());
+  EXPECT_EQ(expected_found, found);
+}
+
+template <class Map>
+void RunEraseAndInsert(const std::vector<uint64_t>& keys,
+                       const std::string& story_name) {
+  Map map = BuildMap<Map>(keys);
+  LapTimer timer(kWarmupRuns, kTimeLimit, kTimeCheckInterval);
+  do {
+    // Keeps the size constant, as a table whose entries churn.
+    for (uint64_t key : keys) {
+      map.erase(key);
+      map[~key] = key;
+    }
+    for (uint64_t key : keys) {
+      map.erase(~key);
+      map[key] = key;
+    }
+    timer.NextLap();
+  } while (!timer.HasTimeLimitExpired());
+  ReportResults(story_name, timer, keys.size() * 2);
+  EXPECT_EQ(keys.size(), map.size());
+}
+
+class HashMapPerfTest : public testing::TestWithParam<size_t> {
+ public:
+  HashMapPerfTest() : keys_(GenerateKeys(GetParam())) {}
+
+  std::string StoryName(const std::string& name) const {
+    return name + "_" + NumberToString(GetParam());
+  }
+
+ protected:
+  const std::vector<uint64_t> keys_;
+};
+
+using StdMap = std::unordered_map<uint64_t, uint64_t>;
+using FlatMap = flat_hash_map<uint64_t, uint64_t>;
+
+}  // namespace
+
+TEST_P(HashMapPerfTest, Build) {
+  RunBuild<StdMap>(keys_, StoryName("build_unordered_map"));
+  RunBuild<FlatMap>(keys_, StoryName("build_flat_hash_map"));
+}
+
+TEST_P(HashMapPerfTest, LookupHit) {
+  std::vector<uint64_t> lookups = keys_;
+  RandomShuffle(lookups.begin(), lookups.end());
+  RunLookup<StdMap>(keys_, lookups, lookups.size(),
+                    StoryName("lookup_hit_unordered_map"));
+  RunLookup<FlatMap>(keys_, lookups, lookups.size(),
+                     StoryName("lookup_hit_flat_hash_map"));
+}
+
+TEST_P(HashMapPerfTest, LookupMiss) {
+  const std::vector<uint64_t> lookups = GenerateKeys(keys_.size());
+  RunLookup<StdMap>(keys_, lookups, 0, StoryName("lookup_miss_unordered_map"));
+  RunLookup<FlatMap>(keys_, lookups, 0,
+                     StoryName("lookup_miss_flat_hash_map"));
+}
+
+TEST_P(HashMapPerfTest, EraseAndInsert) {
+  RunEraseAndInsert<StdMap>(keys_, StoryName("churn_unordered_map"));
+  RunEraseAndInsert<FlatMap>(keys_, StoryName("churn_flat_hash_map"));
+}
+
+INSTANTIATE_TEST_SUITE_P(All,
+                         HashMapPerfTest,
+                         testing::Values(100, 10000, 1000000));
+
+}  // namespace base
@@ -0,0 +1,98 @@
+// Copyright 2022 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "base/containers/flat_hash_map.h"
+
+#include <memory>
+#include <string>
+#include <unordered_map>
+#include <utility>
+
+#include "base/containers/flat_hash_set.h"
+#include "base/rand_util.h"
+#include "base/strings/string_number_conversions.h"
+#include "base/strings/abseil_string_conversions.h"
+#include "base/strings/string_piece.h"
+#include "base/tracing_buildflags.h"
+#include "testing/gtest/include/gtest/gtest.h"
+
+#if BUILDFLAG(ENABLE_BASE_TRACING)
+#include "base/trace_event/memory_usage_estimator.h"  // no-presubmit-check
+#endif  // BUILDFLAG(ENABLE_BASE_TRACING)
+
+namespace base {
+
+TEST(FlatHashMapTest, SameAsUnorderedMap) {
+  flat_hash_map<int, int> map;
+  std::unordered_map<int, int> reference;
+  for (int i = 0; i < 10000; ++i) {
+    const int key = RandInt(0, 1000);
+    switch (RandInt(0, 2)) {
+      case 0:
+        map[key] = i;
+        reference[key] = i;
+        break;
+      case 1:
+        EXPECT_EQ(reference.erase(key), map.erase(key));
+        break;
+      case 2:
+        EXPECT_EQ(reference.count(key), map.count(key));
+        break;
+    }
+    ASSERT_EQ(reference.size(), map.size());
+  }
+  for (const auto& [key, value] : reference) {
+    auto it = map.find(key);
+    ASSERT_NE(map.end(), it);
+    EXPECT_EQ(value, it->second);
+  }
+}
+
+TEST(FlatHashMapTest, HeterogeneousLookup) {
+  flat_hash_map<std::string, int> map;
+  for (int i = 0; i < 100; ++i)
+    map.emplace("key_" + NumberToString(i), i);
+
+  // absl::Hash supports lookups of std::string keys by string views, without
+  // a copy of the key.
+  const StringPiece key = "key_42";
+  auto it = map.find(StringPieceToStringView(key));
+  ASSERT_NE(map.end(), it);
+  EXPECT_EQ(42, it->second);
+  EXPECT_TRUE(map.contains("key_99"));
+  EXPECT_FALSE(map.contains("key_100"));
+}
+
+TEST(FlatHashMapTest, MoveOnlyValues) {
+  flat_hash_map<int, std::unique_ptr<int>> map;
+  for (int i = 0; i < 100; ++i)
+    map.try_emplace(i, std::make_unique<int>(i));
+  flat_hash_map<int, std::unique_ptr<int>> moved = std::move(map);
+  ASSERT_EQ(100u, moved.size());
+  EXPECT_EQ(7, *moved[7]);
+}
+
+TEST(FlatHashSetTest, InsertAndErase) {
+  flat_hash_set<std::string> set;
+  EXPECT_TRUE(set.insert("a").second);
+  EXPECT_FALSE(set.insert("a").second);
+  EXPECT_TRUE(set.insert("b").second);
+  EXPECT_EQ(2u, set.size());
+  EXPECT_EQ(1u, set.erase("a"));
+  EXPECT_FALSE(set.contains("a"));
+  EXPECT_TRUE(set.contains("b"));
+}
+
+#if BUILDFLAG(ENABLE_BASE_TRACING)
+TEST(FlatHashMapTest, EstimateMemoryUsage) {
+  flat_hash_map<int, int> map;
+  EXPECT_EQ(0u, trace_event::EstimateMemoryUsage(map));
+  for (int i = 0; i < 100; ++i)
+    map[i] = i;
+  EXPECT_EQ((sizeof(std::pair<const int, int>) + 1) * map.capacity(),
+            trace_event::EstimateMemoryUsage(map));
+}
+#endif  // BUILDFLAG(ENABLE_BASE_TRACING)
+
+}  // namespace base
@@ -0,0 +1,19 @@
+// Copyright 2022 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#ifndef BASE_CONTAINERS_FLAT_HASH_SET_H_
+#define BASE_CONTAINERS_FLAT_HASH_SET_H_
+
+#include "third_party/abseil-cpp/absl/container/flat_hash_set.h"
+
+namespace base {
+
+// An open-addressing hash set, which is absl::flat_hash_set. The requirements
+// and the caveats are those of base::flat_hash_map (see flat_hash_map.h).
+template <class Key, class... Args>
+using flat_hash_set = absl::flat_hash_set<Key, Args...>;
+
+}  // namespace base
+
+#endif  // BASE_CONTAINERS_FLAT_HASH_SET_H_
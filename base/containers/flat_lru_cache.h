@@ -0,0 +1,457 @@
+// Copyright 2022 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#ifndef BASE_CONTAINERS_FLAT_LRU_CACHE_H_
+#define BASE_CONTAINERS_FLAT_LRU_CACHE_H_
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include <algorithm>
+#include <functional>
+#include <iterator>
+#include <limits>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+#include "base/check_op.h"
+
+namespace base {
+
+// A Least Recently Used cache with the interface of LRUCache (see
+// lru_cache.h), which doesn't allocate per entry. The entries are stored
+// contiguously in a vector, linked in recency order by the indices of their
+// neighbours, and indexed by an open-addressing hash table of entry indices,
+// so that a lookup touches the index and the entry, rather than the nodes of a
+// map and of a list.
+//
+// The cache either evicts beyond a number of entries, as LRUCache does, or
+// beyond a total cost: the cost of an entry is sizeof(value_type), plus what
+// the cost function returns for it, e.g. the size of the heap memory it owns.
+//
+//   // At most 64 MB of entries, counting the strings they own.
+//   base::FlatLRUCache<std::string, std::vector<IPAddress>> cache(
+//       64 * 1024 * 1024, [](const std::string& host,
+//                            const std::vector<IPAddress>& addresses) {
+//         return host.capacity() + addresses.capacity() * sizeof(IPAddress);
+//       });
+//
+// Unlike with LRUCache, all the iterators are invalidated by mutations, since
+// erasing an entry moves the last one into its place, except for the one
+// returned by the mutation.
+template <class KeyType,
+          class PayloadType,
+          class HashType = std::hash<KeyType>,
+          class KeyEqual = std::equal_to<KeyType>>
+class FlatLRUCache {
+ private:
+  template <bool kIsConst>
+  class Iterator;
+
+ public:
+  using value_type = std::pair<KeyType, PayloadType>;
+  using size_type = size_t;
+
+  using iterator = Iterator<false>;
+  using const_iterator = Iterator<true>;
+  using reverse_iterator = std::reverse_iterator<iterator>;
+  using const_reverse_iterator = std::reverse_iterator<const_iterator>;
+
+  // Returns the cost of an entry, beyond sizeof(value_type).
+  using CostFunction = size_t (*)(const KeyType& key,
+                                  const PayloadType& payload);
+
+  enum { NO_AUTO_EVICT = 0 };
+
+  // Evicts the least recently used entries when an entry is inserted beyond
+  // |max_size| of them, unless it's NO_AUTO_EVICT.
+  explicit FlatLRUCache(size_type max_size) : max_size_(max_size) {}
+
+  // Evicts the least recently used entries when the total cost of the entries
+  // exceeds |max_cost|, except for the one which was just inserted.
+  // |cost_function| may be null, to only count sizeof(value_type).
+  FlatLRUCache(size_t max_cost, CostFunction cost_function)
+      : max_size_(NO_AUTO_EVICT),
+        max_cost_(max_cost),
+        cost_function_(cost_function) {
+    DCHECK_GT(max_cost, 0u);
+  }
+
+  FlatLRUCache(const FlatLRUCache&) = delete;
+  FlatLRUCache& operator=(const FlatLRUCache&) = delete;
+
+  FlatLRUCache(FlatLRUCache&&) = default;
+  FlatLRUCache& operator=(FlatLRUCache&&) = default;
+
+  ~FlatLRUCache() = default;
+
+  size_type max_size() const { return max_size_; }
+  size_t max_cost() const { return max_cost_; }
+
+  // The sum of the costs of the entries, which are sizeof(value_type) each
+  // without a cost function.
+  size_t total_cost() const { return total_cost_; }
+
+  // Inserts a payload item with the given key, or replaces the payload of the
+  // existing item, which becomes the most recent one. Returns an iterator to
+  // the item, which is then the front of the recency list.
+  //
+  // The payload will be forwarded.
+  template <typename Payload>
+  iterator Put(const KeyType& key, Payload&& payload) {
+    const uint32_t hash = HashKey(key);
+    uint32_t node = FindNode(key, hash);
+    if (node != kNone) {
+      Node& existing = nodes_[node];
+      existing.value.second = std::forward<Payload>(payload);
+      SetCost(existing);
+      MoveToFront(node);
+    } else {
+      if (max_size_ != NO_AUTO_EVICT)
+        ShrinkToSize(max_size_ - 1);
+      DCHECK_LT(nodes_.size(), size_t{kNone});
+      node = static_cast<uint32_t>(nodes_.size());
+      nodes_.emplace_back(key, std::forward<Payload>(payload), hash);
+      SetCost(nodes_.back());
+      LinkFront(node);
+      // Keeps at most half of the slots used.
+      if (nodes_.size() * 2 > index_.size())
+        Rehash(std::max<size_t>(kMinSlots, index_.size() * 2));
+      InsertSlot({node, hash});
+    }
+    if (max_cost_ != NO_AUTO_EVICT) {
+      while (total_cost_ > max_cost_ && tail_ != node)
+        node = EraseNode(tail_, node);
+    }
+    return iterator(this, node);
+  }
+
+  // Retrieves the contents of the given key, or end() if not found. This method
+  // has the side effect of moving the requested item to the front of the
+  // recency list.
+  iterator Get(const KeyType& key) {
+    const uint32_t node = FindNode(key, HashKey(key));
+    if (node == kNone)
+      return end();
+    MoveToFront(node);
+    return iterator(this, node);
+  }
+
+  // Retrieves the payload associated with a given key and returns it via
+  // result without affecting the ordering (unlike Get()).
+  iterator Peek(const KeyType& key) {
+    return iterator(this, FindNode(key, HashKey(key)));
+  }
+
+  const_iterator Peek(const KeyType& key) const {
+    return const_iterator(this, FindNode(key, HashKey(key)));
+  }
+
+  // Exchanges the contents of |this| by the contents of the |other|.
+  void Swap(FlatLRUCache& other) { std::swap(*this, other); }
+
+  // Erases the item referenced by the given iterator. An iterator to the item
+  // following it will be returned. The iterator must be valid.
+  iterator Erase(iterator pos) {
+    DCHECK_EQ(pos.cache_, this);
+    DCHECK_NE(pos.node_, kNone);
+    const uint32_t next = nodes_[pos.node_].next;
+    return iterator(this, EraseNode(pos.node_, next));
+  }
+
+  // LRUCache entries are often processed in reverse order, so we add this
+  // convenience function (not typically defined by STL containers).
+  reverse_iterator Erase(reverse_iterator pos) {
+    // We have to actually give it the incremented iterator to delete, since
+    // the forward iterator that base() returns is actually one past the item
+    // being iterated over.
+    return reverse_iterator(Erase((++pos).base()));
+  }
+
+  // Shrinks the cache so it only holds |new_size| items. If |new_size| is
+  // bigger or equal to the current number of items, this will do nothing.
+  void ShrinkToSize(size_type new_size) {
+    while (size() > new_size)
+      EraseNode(tail_, kNone);
+  }
+
+  // Allocates the storage of |size| items, so that inserts don't rehash the
+  // index until the cache grows beyond it.
+  void Reserve(size_type size) {
+    DCHECK_LT(size, size_t{kNone});
+    nodes_.reserve(size);
+    size_t slots = kMinSlots;
+    while (slots < size * 2)
+      slots *= 2;
+    if (slots > index_.size())
+      Rehash(slots);
+  }
+
+  // Deletes everything from the cache.
+  void Clear() {
+    nodes_.clear();
+    index_.clear();
+    head_ = kNone;
+    tail_ = kNone;
+    total_cost_ = 0;
+  }
+
+  // Returns the number of elements in the cache.
+  size_type size() const { return nodes_.size(); }
+
+  // Allows iteration over the list. Forward iteration starts with the most
+  // recent item and works backwards.
+  iterator begin() { return iterator(this, head_); }
+  const_iterator begin() const { return const_iterator(this, head_); }
+  iterator end() { return iterator(this, kNone); }
+  const_iterator end() const { return const_iterator(this, kNone); }
+
+  reverse_iterator rbegin() { return reverse_iterator(end()); }
+  const_reverse_iterator rbegin() const {
+    return const_reverse_iterator(end());
+  }
+  reverse_iterator rend() { return reverse_iterator(begin()); }
+  const_reverse_iterator rend() const {
+    return const_reverse_iterator(begin());
+  }
+
+  bool empty() const { return nodes_.empty(); }
+
+ private:
+  static constexpr uint32_t kNone = std::numeric_limits<uint32_t>::max();
+  static constexpr size_t kMinSlots = 16;
+
+  // An entry, and its links in the recency list, which is ordered from the
+  // most recent entry, |head_|, to the least recent one, |tail_|.
+  struct Node {
+    template <typename Payload>
+    Node(const KeyType& key, Payload&& payload, uint32_t hash)
+        : value(key, std::forward<Payload>(payload)), hash(hash) {}
+
+    value_type value;
+    size_t cost = 0;
+    uint32_t hash;
+    uint32_t prev = kNone;
+    uint32_t next = kNone;
+  };
+
+  // A slot of the index: the index of a node, and the hash of its key.
+  struct Slot {
+    uint32_t node;
+    uint32_t hash;
+  };
+
+  template <bool kIsConst>
+  class Iterator {
+   public:
+    using iterator_category = std::bidirectional_iterator_tag;
+    using value_type = typename FlatLRUCache::value_type;
+    using difference_type = ptrdiff_t;
+    using pointer =
+        std::conditional_t<kIsConst, const value_type*, value_type*>;
+    using reference =
+        std::conditional_t<kIsConst, const value_type&, value_type&>;
+
+    Iterator() = default;
+
+    // Converts an iterator to a const_iterator.
+    template <bool kOtherIsConst,
+              typename = std::enable_if_t<kIsConst && !kOtherIsConst>>
+    Iterator(const Iterator<kOtherIsConst>& other)  // NOLINT
+        : cache_(other.cache_), node_(other.node_) {}
+
+    reference operator*() const {
+      DCHECK_NE(node_, kNone);
+      return cache_->nodes_[node_].value;
+    }
+    pointer operator->() const { return &**this; }
+
+    Iterator& operator++() {
+      DCHECK_NE(node_, kNone);
+      node_ = cache_->nodes_[node_].next;
+      return *this;
+    }
+    Iterator operator++(int) {
+      Iterator result = *this;
+      ++*this;
+      return result;
+    }
+
+    // The end() iterator is decremented to the least recent item.
+    Iterator& operator--() {
+      node_ = node_ == kNone ? cache_->tail_ : cache_->nodes_[node_].prev;
+      DCHECK_NE(node_, kNone);
+      return *this;
+    }
+    Iterator operator--(int) {
+      Iterator result = *this;
+      --*this;
+      return result;
+    }
+
+    friend bool operator==(const Iterator& a, const Iterator& b) {
+      return a.node_ == b.node_;
+    }
+    friend bool operator!=(const Iterator& a, const Iterator& b) {
+      return !(a == b);
+    }
+
+   private:
+    friend class FlatLRUCache;
+    template <bool>
+    friend class Iterator;
+
+    using Cache =
+        std::conditional_t<kIsConst, const FlatLRUCache, FlatLRUCache>;
+
+    Iterator(Cache* cache, uint32_t node) : cache_(cache), node_(node) {}
+
+    Cache* cache_ = nullptr;
+    uint32_t node_ = kNone;
+  };
+
+  size_t mask() const { return index_.size() - 1; }
+
+  static uint32_t HashKey(const KeyType& key) {
+    // Mixes the hash, since std::hash is often the identity for integers, and
+    // keeps its high bits, which depend on all of its bits.
+    const uint64_t hash = static_cast<uint64_t>(HashType()(key));
+    return static_cast<uint32_t>((hash * 0x9e3779b97f4a7c15) >> 32);
+  }
+
+  void SetCost(Node& node) {
+    total_cost_ -= node.cost;
+    node.cost = sizeof(value_type);
+    if (cost_function_)
+      node.cost += cost_function_(node.value.first, node.value.second);
+    total_cost_ += node.cost;
+  }
+
+  // Returns the index of the node of |key|, or kNone.
+  uint32_t FindNode(const KeyType& key, uint32_t hash) const {
+    if (index_.empty())
+      return kNone;
+    for (size_t position = hash & mask();; position = (position + 1) & mask()) {
+      const Slot& slot = index_[position];
+      if (slot.node == kNone)
+        return kNone;
+      if (slot.hash == hash && KeyEqual()(nodes_[slot.node].value.first, key))
+        return slot.node;
+    }
+  }
+
+  void LinkFront(uint32_t node) {
+    nodes_[node].prev = kNone;
+    nodes_[node].next = head_;
+    if (head_ != kNone)
+      nodes_[head_].prev = node;
+    else
+      tail_ = node;
+    head_ = node;
+  }
+
+  void Unlink(uint32_t node) {
+    const Node& unlinked = nodes_[node];
+    if (unlinked.prev != kNone)
+      nodes_[unlinked.prev].next = unlinked.next;
+    else
+      head_ = unlinked.next;
+    if (unlinked.next != kNone)
+      nodes_[unlinked.next].prev = unlinked.prev;
+    else
+      tail_ = unlinked.prev;
+  }
+
+  void MoveToFront(uint32_t node) {
+    if (head_ == node)
+      return;
+    Unlink(node);
+    LinkFront(node);
+  }
+
+  // Erases the |erased| node, moving the last node into its place. Returns the
+  // index of the |tracked| node after the move, which may be kNone.
+  uint32_t EraseNode(uint32_t erased, uint32_t tracked) {
+    DCHECK_NE(erased, tracked);
+    Unlink(erased);
+    RemoveSlot(FindSlot(erased));
+    total_cost_ -= nodes_[erased].cost;
+    const uint32_t last = static_cast<uint32_t>(nodes_.size() - 1);
+    if (erased != last) {
+      index_[FindSlot(last)].node = erased;
+      nodes_[erased] = std::move(nodes_[last]);
+      const Node& moved = nodes_[erased];
+      if (moved.prev != kNone)
+        nodes_[moved.prev].next = erased;
+      else
+        head_ = erased;
+      if (moved.next != kNone)
+        nodes_[moved.next].prev = erased;
+      else
+        tail_ = erased;
+      if (tracked == last)
+        tracked = erased;
+    }
+    nodes_.pop_back();
+    return tracked;
+  }
+
+  void Rehash(size_t slots) {
+    std::vector<Slot> index(slots, Slot{kNone, 0});
+    std::swap(index, index_);
+    for (const Slot& slot : index) {
+      if (slot.node != kNone)
+        InsertSlot(slot);
+    }
+  }
+
+  // Inserts |slot| in the first empty slot after its ideal position.
+  void InsertSlot(Slot slot) {
+    size_t position = slot.hash & mask();
+    while (index_[position].node != kNone)
+      position = (position + 1) & mask();
+    index_[position] = slot;
+  }
+
+  // Returns the position of the slot of |node|.
+  size_t FindSlot(uint32_t node) const {
+    size_t position = nodes_[node].hash & mask();
+    while (index_[position].node != node) {
+      DCHECK_NE(index_[position].node, kNone);
+      position = (position + 1) & mask();
+    }
+    return position;
+  }
+
+  // Empties the slot at |position|, shifting back the following slots of the
+  // probe sequence so that no lookup stops early at the hole.
+  void RemoveSlot(size_t position) {
+    for (size_t next = (position + 1) & mask(); index_[next].node != kNone;
+         next = (next + 1) & mask()) {
+      const size_t ideal = index_[next].hash & mask();
+      // The slot at |next| can fill the hole if the hole isn't before its
+      // ideal position, cyclically.
+      if (((next - ideal) & mask()) >= ((next - position) & mask())) {
+        index_[position] = index_[next];
+        position = next;
+      }
+    }
+    index_[position].node = kNone;
+  }
+
+  std::vector<Node> nodes_;
+  std::vector<Slot> index_;
+  uint32_t head_ = kNone;
+  uint32_t tail_ = kNone;
+
+  size_type max_size_;
+  size_t max_cost_ = NO_AUTO_EVICT;
+  CostFunction cost_function_ = nullptr;
+  size_t total_cost_ = 0;
+};
+
+}  // namespace base
+
+#endif  // BASE_CONTAINERS_FLAT_LRU_CACHE_H_
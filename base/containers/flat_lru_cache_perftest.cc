@@ -0,0 +1,116 @@
+// Copyright 2022 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "base/containers/flat_lru_cache.h"
+
+#include <stdint.h>
+
+#include <string>
+#include <vector>
+
+#include "base/containers/lru_cache.h"
+#include "base/rand_util.h"
+#include "base/strings/string_number_conversions.h"
+#include "base/time/time.h"
+#include "base/timer/lap_timer.h"
+#include "testing/gtest/include/gtest/gtest.h"
+#include "testing/perf/perf_result_reporter.h"
+
+namespace base {
+namespace {
+
+constexpr TimeDelta kTimeLimit = Seconds(2);
+constexpr int kWarmupRuns = 1;
+constexpr int kTimeCheckInterval = 1;
+
+constexpr char kMetricPrefixLRUCache[] = "LRUCache.";
+constexpr char kMetricThroughput[] = "throughput";
+constexpr char kMetricTimePerEntry[] = "time_per_entry";
+
+perf_test::PerfResultReporter SetUpReporter(const std::string& story_name) {
+  perf_test::PerfResultReporter reporter(kMetricPrefixLRUCache, story_name);
+  reporter.RegisterImportantMetric(kMetricThroughput, "runs/s");
+  reporter.RegisterImportantMetric(kMetricTimePerEntry, "ns");
+  return reporter;
+}
+
+void ReportResults(const std::string& story_name,
+                   const LapTimer& timer,
+                   size_t entries_per_lap) {
+  auto reporter = SetUpReporter(story_name);
+  const float entries_per_second = timer.LapsPerSecond() * entries_per_lap;
+  reporter.AddResult(kMetricThroughput, entries_per_second);
+  reporter.AddResult(kMetricTimePerEntry, 1e9 / entries_per_second);
+}
+
+std::vector<uint64_t> GenerateKeys(size_t count) {
+  std::vector<uint64_t> keys;
+  for (size_t i = 0; i < count; ++i)
+    keys.push_back(RandUint64());
+  return keys;
+}
+
+// Inserts twice as many keys as fit in the cache, so that half of the puts
+// evict an entry.
+template <class Cache>
+void RunPut(const std::vector<uint64_t>& keys, const std::string& story_name) {
+  LapTimer timer(kWarmupRuns, kTimeLimit, kTimeCheckInterval);
+  do {
+    Cache cache(keys.size() / 2);
+    for (uint64_t key : keys)
+      cache.Put(key, key);
+    EXPECT_EQ(keys.size() / 2, cache.size());
+    timer.NextLap();
+  } while (!timer.HasTimeLimitExpired());
+  ReportResults(story_name, timer, keys.size());
+}
+
+template <class Cache>
+void RunGet(const std::vector<uint64_t>& keys, const std::string& story_name) {
+  Cache cache(keys.size());
+  for (uint64_t key : keys)
+    cache.Put(key, key);
+  std::vector<uint64_t> lookups = keys;
+  RandomShuffle(lookups.begin(), lookups.end());
+  LapTimer timer(kWarmupRuns, kTimeLimit, kTimeCheckInterval);
+  do {
+    for (uint64_t key : lookups)
+      ASSERT_EQ(key, cache.Get(key)->second);
+    timer.NextLap();
+  } while (!timer.HasTimeLimitExpired());
+  ReportResults(story_name, timer, lookups.size());
+}
+
+class LRUCachePerfTest : public testing::TestWithParam<size_t> {
+ public:
+  LRUCachePerfTest() : keys_(GenerateKeys(GetParam())) {}
+
+  std::string StoryName(const std::string& name) const {
+    return name + "_" + NumberToString(GetParam());
+  }
+
+ protected:
+  const std::vector<uint64_t> keys_;
+};
+
+using HashingCache = HashingLRUCache<uint64_t, uint64_t>;
+using FlatCache = FlatLRUCache<uint64_t, uint64_t>;
+
+}  // namespace
+
+TEST_P(LRUCachePerfTest, Put) {
+  RunPut<HashingCache>(keys_, StoryName("put_hashing"));
+  RunPut<FlatCache>(keys_, StoryName("put_flat"));
+}
+
+TEST_P(LRUCachePerfTest, Get) {
+  RunGet<HashingCache>(keys_, StoryName("get_hashing"));
+  RunGet<FlatCache>(keys_, StoryName("get_flat"));
+}
+
+INSTANTIATE_TEST_SUITE_P(All,
+                         LRUCachePerfTest,
+                         testing::Values(1000, 100000, 1000000));
+
+}  // namespace base
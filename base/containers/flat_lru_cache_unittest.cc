@@ -0,0 +1,195 @@
+// Copyright 2022 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "base/containers/flat_lru_cache.h"
+
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "base/containers/lru_cache.h"
+#include "base/rand_util.h"
+#include "testing/gtest/include/gtest/gtest.h"
+
+namespace base {
+
+namespace {
+
+using Cache = FlatLRUCache<int, std::string>;
+
+std::vector<int> Keys(const Cache& cache) {
+  std::vector<int> keys;
+  for (const auto& [key, payload] : cache)
+    keys.push_back(key);
+  return keys;
+}
+
+size_t StringCost(const int& key, const std::string& payload) {
+  return payload.size();
+}
+
+}  // namespace
+
+TEST(FlatLRUCacheTest, Basic) {
+  Cache cache(Cache::NO_AUTO_EVICT);
+  EXPECT_TRUE(cache.empty());
+  EXPECT_TRUE(cache.Get(1) == cache.end());
+  EXPECT_TRUE(cache.Peek(1) == cache.end());
+
+  auto inserted = cache.Put(1, "one");
+  EXPECT_TRUE(inserted == cache.begin());
+  EXPECT_EQ("one", inserted->second);
+  cache.Put(2, "two");
+  cache.Put(3, "three");
+  EXPECT_EQ(3u, cache.size());
+  EXPECT_EQ(std::vector<int>({3, 2, 1}), Keys(cache));
+
+  // Get() moves the item to the front, and Peek() doesn't.
+  EXPECT_EQ("one", cache.Get(1)->second);
+  EXPECT_EQ(std::vector<int>({1, 3, 2}), Keys(cache));
+  EXPECT_EQ("two", cache.Peek(2)->second);
+  EXPECT_EQ(std::vector<int>({1, 3, 2}), Keys(cache));
+
+  // Put() replaces the payload of an existing item.
+  cache.Put(2, "deux");
+  EXPECT_EQ(3u, cache.size());
+  EXPECT_EQ("deux", cache.begin()->second);
+  EXPECT_EQ(std::vector<int>({2, 1, 3}), Keys(cache));
+
+  // Reverse iteration starts with the least recent item.
+  EXPECT_EQ(3, cache.rbegin()->first);
+  auto it = cache.end();
+  --it;
+  EXPECT_EQ(3, it->first);
+
+  cache.Clear();
+  EXPECT_TRUE(cache.empty());
+  EXPECT_TRUE(cache.begin() == cache.end());
+  cache.Put(4, "four");
+  EXPECT_EQ(std::vector<int>({4}), Keys(cache));
+}
+
+TEST(FlatLRUCacheTest, Erase) {
+  Cache cache(Cache::NO_AUTO_EVICT);
+  for (int i = 0; i < 10; ++i)
+    cache.Put(i, std::string(i, 'x'));
+
+  // Erases the odd keys while iterating, including the last stored item,
+  // which moves into the place of each erased one.
+  for (auto it = cache.begin(); it != cache.end();) {
+    if (it->first % 2)
+      it = cache.Erase(it);
+    else
+      ++it;
+  }
+  EXPECT_EQ(std::vector<int>({8, 6, 4, 2, 0}), Keys(cache));
+  for (int i = 0; i < 10; ++i)
+    EXPECT_EQ(i % 2 == 0, cache.Peek(i) != cache.end());
+
+  auto reverse_it = cache.Erase(cache.rbegin());
+  EXPECT_EQ(2, reverse_it->first);
+  EXPECT_EQ(std::vector<int>({8, 6, 4, 2}), Keys(cache));
+
+  cache.ShrinkToSize(1);
+  EXPECT_EQ(std::vector<int>({8}), Keys(cache));
+}
+
+TEST(FlatLRUCacheTest, AutoEvict) {
+  Cache cache(3);
+  for (int i = 0; i < 10; ++i)
+    cache.Put(i, "value");
+  EXPECT_EQ(3u, cache.size());
+  EXPECT_EQ(std::vector<int>({9, 8, 7}), Keys(cache));
+
+  // Replacing an item doesn't evict.
+  cache.Put(7, "seven");
+  EXPECT_EQ(std::vector<int>({7, 9, 8}), Keys(cache));
+}
+
+TEST(FlatLRUCacheTest, CostEvict) {
+  constexpr size_t kEntrySize = sizeof(Cache::value_type);
+  Cache cache(3 * kEntrySize + 10, &StringCost);
+  EXPECT_EQ(0u, cache.total_cost());
+
+  cache.Put(1, "12345");
+  cache.Put(2, "12345");
+  EXPECT_EQ(2 * kEntrySize + 10, cache.total_cost());
+  cache.Put(3, "1");
+  EXPECT_EQ(std::vector<int>({3, 2}), Keys(cache));
+  EXPECT_EQ(2 * kEntrySize + 6, cache.total_cost());
+
+  // Growing an item evicts the others, but never the item itself.
+  cache.Put(3, std::string(100, 'x'));
+  EXPECT_EQ(std::vector<int>({3}), Keys(cache));
+  EXPECT_EQ(kEntrySize + 100, cache.total_cost());
+
+  cache.Put(4, "");
+  EXPECT_EQ(std::vector<int>({4}), Keys(cache));
+  EXPECT_EQ(kEntrySize, cache.total_cost());
+
+  // Without a cost function, the items cost their size.
+  Cache size_cache(2 * kEntrySize, nullptr);
+  for (int i = 0; i < 10; ++i)
+    size_cache.Put(i, std::string(100, 'x'));
+  EXPECT_EQ(std::vector<int>({9, 8}), Keys(size_cache));
+}
+
+TEST(FlatLRUCacheTest, MoveOnlyPayload) {
+  FlatLRUCache<std::string, std::unique_ptr<int>> cache(2);
+  cache.Put("a", std::make_unique<int>(1));
+  cache.Put("b", std::make_unique<int>(2));
+  cache.Put("c", std::make_unique<int>(3));
+  EXPECT_TRUE(cache.Peek("a") == cache.end());
+  EXPECT_EQ(2, *cache.Get("b")->second);
+
+  FlatLRUCache<std::string, std::unique_ptr<int>> other(1);
+  other.Swap(cache);
+  EXPECT_EQ(2u, other.size());
+  EXPECT_EQ(2u, other.max_size());
+  EXPECT_TRUE(cache.empty());
+}
+
+TEST(FlatLRUCacheTest, SameAsHashingLRUCache) {
+  FlatLRUCache<int, int> cache(100);
+  HashingLRUCache<int, int> reference(100);
+  cache.Reserve(100);
+  for (int i = 0; i < 100000; ++i) {
+    const int key = RandInt(0, 300);
+    switch (RandInt(0, 3)) {
+      case 0:
+        cache.Put(key, i);
+        reference.Put(key, i);
+        break;
+      case 1:
+        ASSERT_EQ(reference.Get(key) == reference.end(),
+                  cache.Get(key) == cache.end());
+        break;
+      case 2: {
+        auto it = reference.Peek(key);
+        if (it != reference.end()) {
+          reference.Erase(it);
+          cache.Erase(cache.Peek(key));
+        }
+        break;
+      }
+      case 3:
+        if (!reference.empty()) {
+          reference.Erase(reference.rbegin());
+          cache.Erase(cache.rbegin());
+        }
+        break;
+    }
+    ASSERT_EQ(reference.size(), cache.size());
+  }
+  auto it = cache.begin();
+  for (const auto& [key, payload] : reference) {
+    ASSERT_TRUE(it != cache.end());
+    EXPECT_EQ(key, it->first);
+    EXPECT_EQ(payload, it->second);
+    ++it;
+  }
+  EXPECT_TRUE(it == cache.end());
+}
+
+}  // namespace base
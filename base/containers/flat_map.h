@@ -132,6 +132,8 @@ struct GetFirst {
 //   iterator             insert(const_iterator hint, const value_type&);
 //   iterator             insert(const_iterator hint, value_type&&);
 //   void                 insert(InputIterator first, InputIterator last);
+//   void                 insert(sorted_unique_t,
+//                               InputIterator first, InputIterator last);
 //   pair<iterator, bool> insert_or_assign(K&&, M&&);
 //   iterator             insert_or_assign(const_iterator hint, K&&, M&&);
 //   pair<iterator, bool> emplace(Args&&...);
@@ -142,6 +144,7 @@ struct GetFirst {
 // Underlying type functions:
 //   container_type       extract() &&;
 //   void                 replace(container_type&&);
+//   batch_update         begin_batch_update();
 //
 // Erase functions:
 //   iterator erase(iterator);
@@ -110,6 +110,8 @@ namespace base {
 //   pair<iterator, bool> insert(const key_type&);
 //   pair<iterator, bool> insert(key_type&&);
 //   void                 insert(InputIterator first, InputIterator last);
+//   void                 insert(sorted_unique_t,
+//                               InputIterator first, InputIterator last);
 //   iterator             insert(const_iterator hint, const key_type&);
 //   iterator             insert(const_iterator hint, key_type&&);
 //   pair<iterator, bool> emplace(Args&&...);
@@ -118,6 +120,7 @@ namespace base {
 // Underlying type functions:
 //   container_type       extract() &&;
 //   void                 replace(container_type&&);
+//   batch_update         begin_batch_update();
 //
 // Erase functions:
 //   iterator erase(iterator);
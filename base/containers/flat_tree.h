@@ -311,6 +311,13 @@ class flat_tree {
   template <class InputIterator>
   void insert(InputIterator first, InputIterator last);
 
+  // As above, for a range which is sorted and has no repeated elements, which
+  // is merged with the tree in O(size() + distance(first, last)), and in
+  // O(distance(first, last)) if its elements are all after the tree's. The
+  // elements which are equivalent to elements of the tree aren't inserted.
+  template <class InputIterator>
+  void insert(sorted_unique_t, InputIterator first, InputIterator last);
+
   template <class... Args>
   std::pair<iterator, bool> emplace(Args&&... args);
 
@@ -330,6 +337,36 @@ class flat_tree {
   // and has no repeated elements with regard to value_comp().
   void replace(container_type&& body);
 
+  // A scope in which the container_type of the tree may be modified in any
+  // way, e.g. to append many elements, in any order, or to erase some. When
+  // the scope ends, the container is sorted and its repeated elements are
+  // erased, keeping the first of them, as the constructors do: appending M
+  // elements to a tree of N elements then costs O(M * log(M) + N), rather
+  // than an insert() of each. The tree must not be used during the scope.
+  //
+  //   {
+  //     auto batch = map.begin_batch_update();
+  //     for (const auto& [key, value] : delta)
+  //       batch.container().emplace_back(key, value);
+  //   }
+  class batch_update {
+   public:
+    batch_update(const batch_update&) = delete;
+    batch_update& operator=(const batch_update&) = delete;
+    ~batch_update() { tree_->sort_and_unique(); }
+
+    container_type& container() { return tree_->body_; }
+
+   private:
+    friend class flat_tree;
+
+    explicit batch_update(flat_tree* tree) : tree_(tree) {}
+
+    flat_tree* const tree_;
+  };
+
+  batch_update begin_batch_update() { return batch_update(this); }
+
   // --------------------------------------------------------------------------
   // Erase operations.
   //
@@ -543,8 +580,19 @@ class flat_tree {
   }
 
   void sort_and_unique(iterator first, iterator last) {
-    // Preserve stability for the unique code below.
-    std::stable_sort(first, last, value_comp());
+    // Preserve stability for the unique code below. If more than half of the
+    // range is sorted already, e.g. a tree to which elements were appended,
+    // only the rest of it is sorted, and then merged, which takes O(N) for
+    // sorted input.
+    iterator sorted_end = std::is_sorted_until(first, last, value_comp());
+    if (sorted_end != last) {
+      if (std::distance(first, sorted_end) >= std::distance(sorted_end, last)) {
+        std::stable_sort(sorted_end, last, value_comp());
+        std::inplace_merge(first, sorted_end, last, value_comp());
+      } else {
+        std::stable_sort(first, last, value_comp());
+      }
+    }
 
     // lhs is already <= rhs due to sort, therefore !(lhs < rhs) <=> lhs == rhs.
     auto equal_comp = base::not_fn(value_comp());
@@ -850,6 +898,29 @@ void flat_tree<Key, GetKeyFromValue, KeyCompare, Container>::insert(
                      value_comp());
 }
 
+template <class Key, class GetKeyFromValue, class KeyCompare, class Container>
+template <class InputIterator>
+void flat_tree<Key, GetKeyFromValue, KeyCompare, Container>::insert(
+    sorted_unique_t,
+    InputIterator first,
+    InputIterator last) {
+  const difference_type old_size = size();
+  body_.insert(body_.end(), first, last);
+  auto middle = std::next(begin(), old_size);
+  DCHECK(std::adjacent_find(middle, end(), base::not_fn(value_comp())) ==
+         end());
+  if (middle == end())
+    return;
+
+  // Only the old elements after the first new one need to be merged. The
+  // merge is stable, so that the new elements which are equivalent to old
+  // ones are after them, and erased.
+  auto merge_first = std::lower_bound(begin(), middle, *middle, value_comp());
+  std::inplace_merge(merge_first, middle, end(), value_comp());
+  auto equal_comp = base::not_fn(value_comp());
+  erase(std::unique(merge_first, end(), equal_comp), end());
+}
+
 template <class Key, class GetKeyFromValue, class KeyCompare, class Container>
 template <class... Args>
 auto flat_tree<Key, GetKeyFromValue, KeyCompare, Container>::emplace(
@@ -864,6 +864,76 @@ TEST(FlatTree, InsertIterIter) {
   }
 }
 
+// template <class InputIterator>
+//   void insert(sorted_unique_t, InputIterator first, InputIterator last);
+
+TEST(FlatTree, InsertSortedUniqueIterIter) {
+  struct GetKeyFromIntIntPair {
+    const int& operator()(const std::pair<int, int>& p) const {
+      return p.first;
+    }
+  };
+
+  using IntIntMap = flat_tree<int, GetKeyFromIntIntPair, std::less<int>,
+                              std::vector<IntPair>>;
+
+  {
+    IntIntMap cont({{1, 1}, {3, 1}});
+    std::vector<IntPair> int_pairs;
+    cont.insert(sorted_unique, std::begin(int_pairs), std::end(int_pairs));
+    EXPECT_THAT(cont, ElementsAre(IntPair(1, 1), IntPair(3, 1)));
+  }
+
+  {
+    IntIntMap cont({{1, 1}, {3, 1}});
+    IntPair int_pairs[] = {{4, 2}, {5, 2}};
+    cont.insert(sorted_unique, std::begin(int_pairs), std::end(int_pairs));
+    EXPECT_THAT(cont, ElementsAre(IntPair(1, 1), IntPair(3, 1), IntPair(4, 2),
+                                  IntPair(5, 2)));
+  }
+
+  {
+    IntIntMap cont({{1, 1}, {3, 1}, {5, 1}});
+    IntPair int_pairs[] = {{0, 2}, {1, 2}, {2, 2}, {5, 2}, {6, 2}};
+    cont.insert(sorted_unique, std::begin(int_pairs), std::end(int_pairs));
+    EXPECT_THAT(cont, ElementsAre(IntPair(0, 2), IntPair(1, 1), IntPair(2, 2),
+                                  IntPair(3, 1), IntPair(5, 1), IntPair(6, 2)));
+  }
+}
+
+// batch_update begin_batch_update();
+
+TEST(FlatTree, BatchUpdate) {
+  struct GetKeyFromIntIntPair {
+    const int& operator()(const std::pair<int, int>& p) const {
+      return p.first;
+    }
+  };
+
+  using IntIntMap = flat_tree<int, GetKeyFromIntIntPair, std::less<int>,
+                              std::vector<IntPair>>;
+
+  IntIntMap cont({{2, 1}, {4, 1}});
+  {
+    IntIntMap::batch_update update = cont.begin_batch_update();
+    update.container().emplace_back(3, 2);
+    update.container().emplace_back(1, 2);
+    update.container().emplace_back(4, 2);
+    update.container().emplace_back(1, 3);
+  }
+  EXPECT_THAT(cont, ElementsAre(IntPair(1, 2), IntPair(2, 1), IntPair(3, 2),
+                                IntPair(4, 1)));
+
+  // A sorted prefix followed by unsorted elements.
+  {
+    IntIntMap::batch_update update = cont.begin_batch_update();
+    update.container().emplace_back(0, 4);
+    update.container().emplace_back(3, 4);
+  }
+  EXPECT_THAT(cont, ElementsAre(IntPair(0, 4), IntPair(1, 2), IntPair(2, 1),
+                                IntPair(3, 2), IntPair(4, 1)));
+}
+
 // template <class... Args>
 // pair<iterator, bool> emplace(Args&&... args)
 
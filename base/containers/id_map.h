@@ -34,7 +34,13 @@ namespace base {
 
 // The map's value type (the V param) can be any dereferenceable type, such as a
 // raw pointer or smart pointer
-template <typename V, typename K = int32_t>
+//
+// The hash table is a std::unordered_map by default, and may be any map of the
+// same interface (the MapType param), such as base::flat_hash_map for large
+// maps.
+template <typename V,
+          typename K = int32_t,
+          template <typename...> class MapType = std::unordered_map>
 class IDMap final {
  public:
   using KeyType = K;
@@ -42,7 +48,7 @@ class IDMap final {
  private:
   using T = typename std::remove_reference<decltype(*V())>::type;
 
-  using HashTable = std::unordered_map<KeyType, V>;
+  using HashTable = MapType<KeyType, V>;
 
  public:
   IDMap() : iteration_depth_(0), next_id_(1), check_on_null_data_(false) {
@@ -144,7 +150,7 @@ class IDMap final {
   template<class ReturnType>
   class Iterator {
    public:
-    Iterator(IDMap<V, K>* map) : map_(map), iter_(map_->data_.begin()) {
+    Iterator(IDMap* map) : map_(map), iter_(map_->data_.begin()) {
       Init();
     }
 
@@ -207,7 +213,7 @@ class IDMap final {
         ++iter_;
     }
 
-    raw_ptr<IDMap<V, K>> map_;
+    raw_ptr<IDMap> map_;
     typename HashTable::const_iterator iter_;
   };
 
@@ -7,7 +7,10 @@
 #include <stdint.h>
 
 #include <memory>
+#include <vector>
 
+#include "base/containers/flat_hash_map.h"
+#include "base/memory/ptr_util.h"
 #include "base/test/gtest_util.h"
 #include "testing/gtest/include/gtest/gtest.h"
 
@@ -394,4 +397,24 @@ TEST(IDMapTest, RemovedValueHandling) {
   EXPECT_EQ(1u, map.size());
 }
 
+TEST(IDMapTest, FlatHashMap) {
+  using Map = IDMap<std::unique_ptr<TestObject>, int32_t, flat_hash_map>;
+  Map map;
+  std::vector<TestObject*> objects;
+  for (int i = 0; i < 100; ++i) {
+    objects.push_back(new TestObject);
+    EXPECT_EQ(i + 1, map.Add(WrapUnique(objects.back())));
+  }
+  EXPECT_EQ(objects[41], map.Lookup(42));
+
+  // Removals during an iteration are deferred, as with std::unordered_map.
+  int count = 0;
+  for (Map::iterator iter(&map); !iter.IsAtEnd(); iter.Advance()) {
+    map.Remove(iter.GetCurrentKey());
+    ++count;
+  }
+  EXPECT_EQ(100, count);
+  EXPECT_TRUE(map.IsEmpty());
+}
+
 }  // namespace base
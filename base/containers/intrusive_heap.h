@@ -11,7 +11,8 @@
 // by the heap as elements move within it.
 //
 // An IntrusiveHeap is implemented as a standard max-heap over a std::vector<T>,
-// like std::make_heap. Insertion, removal and updating are amortized O(lg size)
+// like std::make_heap, binary by default or d-ary with the |kArity| template
+// parameter. Insertion, removal and updating are amortized O(lg size)
 // (occasional O(size) cost if a new vector allocation is required). Retrieving
 // an element by handle is O(1). Looking up the top element is O(1). Insertions,
 // removals and updates invalidate all iterators, but handles remain valid.
@@ -196,7 +197,10 @@ class BASE_EXPORT HeapHandle {
   }
 
  private:
-  template <typename T, typename Compare, typename HeapHandleAccessor>
+  template <typename T,
+            typename Compare,
+            typename HeapHandleAccessor,
+            size_t kArity>
   friend class IntrusiveHeap;
 
   // Only IntrusiveHeaps can create valid HeapHandles.
@@ -224,12 +228,20 @@ struct DefaultHeapHandleAccessor {
 // removal are similar, objects don't have a fixed address in memory) crossed
 // with a std::set (elements are considered immutable once they're in the
 // container).
+//
+// |kArity| is the number of children of each node. The default binary heap
+// does the fewest comparisons; a 4-ary heap is half as deep, so that the
+// siblings compared at each level share a cache line or two, which makes it
+// faster for heaps of thousands of elements or more. See
+// intrusive_heap_perftest.cc.
 template <typename T,
           typename Compare = std::less<T>,
-          typename HeapHandleAccessor = DefaultHeapHandleAccessor<T>>
+          typename HeapHandleAccessor = DefaultHeapHandleAccessor<T>,
+          size_t kArity = 2>
 class IntrusiveHeap {
  private:
   using UnderlyingType = std::vector<T>;
+  static_assert(kArity >= 2, "A heap node needs at least two children");
 
  public:
   //////////////////////////////////////////////////////////////////////////////
@@ -241,6 +253,8 @@ class IntrusiveHeap {
   using value_compare = Compare;
   using heap_handle_accessor = HeapHandleAccessor;
 
+  static constexpr size_type arity() { return kArity; }
+
   using reference = typename UnderlyingType::reference;
   using const_reference = typename UnderlyingType::const_reference;
   using pointer = typename UnderlyingType::pointer;
@@ -441,9 +455,21 @@ class IntrusiveHeap {
       return;
 
     // Repair the heap and ensure handles are pointing to the right index.
-    ranges::make_heap(impl_.heap_, value_comp());
-    for (size_t i = 0; i < size(); ++i)
-      SetHeapHandle(i);
+    if constexpr (kArity == 2) {
+      ranges::make_heap(impl_.heap_, value_comp());
+      for (size_t i = 0; i < size(); ++i)
+        SetHeapHandle(i);
+    } else {
+      // std::make_heap only builds binary heaps, so sift every parent down,
+      // starting from the parent of the last element.
+      for (size_t i = 0; i < size(); ++i)
+        SetHeapHandle(i);
+      for (size_t i = size() < 2 ? 0 : (size() - 2) / kArity + 1; i-- > 0;) {
+        MakeHole(i);
+        MoveHoleDownAndFill<WithElement>(i,
+                                         std::move_if_noexcept(impl_.heap_[i]));
+      }
+    }
 
     // Explicitly delete elements last.
     elements_to_delete->clear();
@@ -730,13 +756,14 @@ class WithHeapHandle : public InternalHeapHandleStorage {
 
 namespace intrusive_heap {
 
-BASE_EXPORT inline size_t ParentIndex(size_t i) {
+BASE_EXPORT inline size_t ParentIndex(size_t i, size_t arity = 2) {
   DCHECK_NE(0u, i);
-  return (i - 1) / 2;
+  return (i - 1) / arity;
 }
 
-BASE_EXPORT inline size_t LeftIndex(size_t i) {
-  return 2 * i + 1;
+// Returns the index of the first child of node |i|.
+BASE_EXPORT inline size_t LeftIndex(size_t i, size_t arity = 2) {
+  return arity * i + 1;
 }
 
 template <typename HandleType>
@@ -754,8 +781,11 @@ BASE_EXPORT inline void CheckInvalidOrEqualTo(HeapHandle handle, size_t index) {
 ////////////////////////////////////////////////////////////////////////////////
 // IntrusiveHeap
 
-template <typename T, typename Compare, typename HeapHandleAccessor>
-IntrusiveHeap<T, Compare, HeapHandleAccessor>::IntrusiveHeap(
+template <typename T,
+          typename Compare,
+          typename HeapHandleAccessor,
+          size_t kArity>
+IntrusiveHeap<T, Compare, HeapHandleAccessor, kArity>::IntrusiveHeap(
     const IntrusiveHeap& other)
     : impl_(other.impl_) {
   for (size_t i = 0; i < size(); ++i) {
@@ -763,23 +793,32 @@ IntrusiveHeap<T, Compare, HeapHandleAccessor>::IntrusiveHeap(
   }
 }
 
-template <typename T, typename Compare, typename HeapHandleAccessor>
-IntrusiveHeap<T, Compare, HeapHandleAccessor>::~IntrusiveHeap() {
+template <typename T,
+          typename Compare,
+          typename HeapHandleAccessor,
+          size_t kArity>
+IntrusiveHeap<T, Compare, HeapHandleAccessor, kArity>::~IntrusiveHeap() {
   clear();
 }
 
-template <typename T, typename Compare, typename HeapHandleAccessor>
-IntrusiveHeap<T, Compare, HeapHandleAccessor>&
-IntrusiveHeap<T, Compare, HeapHandleAccessor>::operator=(
+template <typename T,
+          typename Compare,
+          typename HeapHandleAccessor,
+          size_t kArity>
+IntrusiveHeap<T, Compare, HeapHandleAccessor, kArity>&
+IntrusiveHeap<T, Compare, HeapHandleAccessor, kArity>::operator=(
     IntrusiveHeap&& other) noexcept {
   clear();
   impl_ = std::move(other.impl_);
   return *this;
 }
 
-template <typename T, typename Compare, typename HeapHandleAccessor>
-IntrusiveHeap<T, Compare, HeapHandleAccessor>&
-IntrusiveHeap<T, Compare, HeapHandleAccessor>::operator=(
+template <typename T,
+          typename Compare,
+          typename HeapHandleAccessor,
+          size_t kArity>
+IntrusiveHeap<T, Compare, HeapHandleAccessor, kArity>&
+IntrusiveHeap<T, Compare, HeapHandleAccessor, kArity>::operator=(
     const IntrusiveHeap& other) {
   clear();
   impl_ = other.impl_;
@@ -789,16 +828,22 @@ IntrusiveHeap<T, Compare, HeapHandleAccessor>::operator=(
   return *this;
 }
 
-template <typename T, typename Compare, typename HeapHandleAccessor>
-IntrusiveHeap<T, Compare, HeapHandleAccessor>&
-IntrusiveHeap<T, Compare, HeapHandleAccessor>::operator=(
+template <typename T,
+          typename Compare,
+          typename HeapHandleAccessor,
+          size_t kArity>
+IntrusiveHeap<T, Compare, HeapHandleAccessor, kArity>&
+IntrusiveHeap<T, Compare, HeapHandleAccessor, kArity>::operator=(
     std::initializer_list<value_type> ilist) {
   clear();
   insert(std::begin(ilist), std::end(ilist));
 }
 
-template <typename T, typename Compare, typename HeapHandleAccessor>
-void IntrusiveHeap<T, Compare, HeapHandleAccessor>::clear() {
+template <typename T,
+          typename Compare,
+          typename HeapHandleAccessor,
+          size_t kArity>
+void IntrusiveHeap<T, Compare, HeapHandleAccessor, kArity>::clear() {
   // Make all of the handles invalid before cleaning up the heap.
   for (size_type i = 0; i < size(); ++i) {
     ClearHeapHandle(i);
@@ -808,26 +853,36 @@ void IntrusiveHeap<T, Compare, HeapHandleAccessor>::clear() {
   impl_.heap_.clear();
 }
 
-template <typename T, typename Compare, typename HeapHandleAccessor>
+template <typename T,
+          typename Compare,
+          typename HeapHandleAccessor,
+          size_t kArity>
 template <class InputIterator>
-void IntrusiveHeap<T, Compare, HeapHandleAccessor>::insert(InputIterator first,
-                                                           InputIterator last) {
+void IntrusiveHeap<T, Compare, HeapHandleAccessor, kArity>::insert(
+    InputIterator first,
+    InputIterator last) {
   for (auto it = first; it != last; ++it) {
     insert(value_type(*it));
   }
 }
 
-template <typename T, typename Compare, typename HeapHandleAccessor>
+template <typename T,
+          typename Compare,
+          typename HeapHandleAccessor,
+          size_t kArity>
 template <typename... Args>
-typename IntrusiveHeap<T, Compare, HeapHandleAccessor>::const_iterator
-IntrusiveHeap<T, Compare, HeapHandleAccessor>::emplace(Args&&... args) {
+typename IntrusiveHeap<T, Compare, HeapHandleAccessor, kArity>::const_iterator
+IntrusiveHeap<T, Compare, HeapHandleAccessor, kArity>::emplace(Args&&... args) {
   value_type value(std::forward<Args>(args)...);
   return InsertImpl(std::move_if_noexcept(value));
 }
 
-template <typename T, typename Compare, typename HeapHandleAccessor>
-typename IntrusiveHeap<T, Compare, HeapHandleAccessor>::value_type
-IntrusiveHeap<T, Compare, HeapHandleAccessor>::take(size_type pos) {
+template <typename T,
+          typename Compare,
+          typename HeapHandleAccessor,
+          size_t kArity>
+typename IntrusiveHeap<T, Compare, HeapHandleAccessor, kArity>::value_type
+IntrusiveHeap<T, Compare, HeapHandleAccessor, kArity>::take(size_type pos) {
   // Make a hole by taking the element out of the heap.
   MakeHole(pos);
   value_type val = std::move(impl_.heap_[pos]);
@@ -849,8 +904,12 @@ IntrusiveHeap<T, Compare, HeapHandleAccessor>::take(size_type pos) {
 }
 
 // This is effectively identical to "take", but it avoids an unnecessary move.
-template <typename T, typename Compare, typename HeapHandleAccessor>
-void IntrusiveHeap<T, Compare, HeapHandleAccessor>::erase(size_type pos) {
+template <typename T,
+          typename Compare,
+          typename HeapHandleAccessor,
+          size_t kArity>
+void IntrusiveHeap<T, Compare, HeapHandleAccessor, kArity>::erase(
+    size_type pos) {
   DCHECK_LT(pos, size());
   // Make a hole by taking the element out of the heap.
   MakeHole(pos);
@@ -869,9 +928,12 @@ void IntrusiveHeap<T, Compare, HeapHandleAccessor>::erase(size_type pos) {
   impl_.heap_.pop_back();
 }
 
-template <typename T, typename Compare, typename HeapHandleAccessor>
-typename IntrusiveHeap<T, Compare, HeapHandleAccessor>::const_iterator
-IntrusiveHeap<T, Compare, HeapHandleAccessor>::Update(size_type pos) {
+template <typename T,
+          typename Compare,
+          typename HeapHandleAccessor,
+          size_t kArity>
+typename IntrusiveHeap<T, Compare, HeapHandleAccessor, kArity>::const_iterator
+IntrusiveHeap<T, Compare, HeapHandleAccessor, kArity>::Update(size_type pos) {
   DCHECK_LT(pos, size());
   MakeHole(pos);
 
@@ -879,7 +941,7 @@ IntrusiveHeap<T, Compare, HeapHandleAccessor>::Update(size_type pos) {
   bool child_greater_eq_parent = false;
   size_type i = 0;
   if (pos > 0) {
-    i = intrusive_heap::ParentIndex(pos);
+    i = intrusive_heap::ParentIndex(pos, kArity);
     child_greater_eq_parent = !Less(pos, i);
   }
 
@@ -893,8 +955,11 @@ IntrusiveHeap<T, Compare, HeapHandleAccessor>::Update(size_type pos) {
   return cbegin() + i;
 }
 
-template <typename T, typename Compare, typename HeapHandleAccessor>
-void IntrusiveHeap<T, Compare, HeapHandleAccessor>::swap(
+template <typename T,
+          typename Compare,
+          typename HeapHandleAccessor,
+          size_t kArity>
+void IntrusiveHeap<T, Compare, HeapHandleAccessor, kArity>::swap(
     IntrusiveHeap& other) noexcept {
   std::swap(impl_.get_value_compare(), other.impl_.get_value_compare());
   std::swap(impl_.get_heap_handle_access(),
@@ -902,9 +967,13 @@ void IntrusiveHeap<T, Compare, HeapHandleAccessor>::swap(
   std::swap(impl_.heap_, other.impl_.heap_);
 }
 
-template <typename T, typename Compare, typename HeapHandleAccessor>
-typename IntrusiveHeap<T, Compare, HeapHandleAccessor>::size_type
-IntrusiveHeap<T, Compare, HeapHandleAccessor>::ToIndex(const_iterator pos) {
+template <typename T,
+          typename Compare,
+          typename HeapHandleAccessor,
+          size_t kArity>
+typename IntrusiveHeap<T, Compare, HeapHandleAccessor, kArity>::size_type
+IntrusiveHeap<T, Compare, HeapHandleAccessor, kArity>::ToIndex(
+    const_iterator pos) {
   DCHECK(cbegin() <= pos);
   DCHECK(pos <= cend());
   if (pos == cend())
@@ -912,9 +981,12 @@ IntrusiveHeap<T, Compare, HeapHandleAccessor>::ToIndex(const_iterator pos) {
   return pos - cbegin();
 }
 
-template <typename T, typename Compare, typename HeapHandleAccessor>
-typename IntrusiveHeap<T, Compare, HeapHandleAccessor>::size_type
-IntrusiveHeap<T, Compare, HeapHandleAccessor>::ToIndex(
+template <typename T,
+          typename Compare,
+          typename HeapHandleAccessor,
+          size_t kArity>
+typename IntrusiveHeap<T, Compare, HeapHandleAccessor, kArity>::size_type
+IntrusiveHeap<T, Compare, HeapHandleAccessor, kArity>::ToIndex(
     const_reverse_iterator pos) {
   DCHECK(crbegin() <= pos);
   DCHECK(pos <= crend());
@@ -923,57 +995,87 @@ IntrusiveHeap<T, Compare, HeapHandleAccessor>::ToIndex(
   return (pos.base() - cbegin()) - 1;
 }
 
-template <typename T, typename Compare, typename HeapHandleAccessor>
-void IntrusiveHeap<T, Compare, HeapHandleAccessor>::SetHeapHandle(size_type i) {
+template <typename T,
+          typename Compare,
+          typename HeapHandleAccessor,
+          size_t kArity>
+void IntrusiveHeap<T, Compare, HeapHandleAccessor, kArity>::SetHeapHandle(
+    size_type i) {
   impl_.get_heap_handle_access().SetHeapHandle(&impl_.heap_[i], HeapHandle(i));
   intrusive_heap::CheckInvalidOrEqualTo(GetHeapHandle(i), i);
 }
 
-template <typename T, typename Compare, typename HeapHandleAccessor>
-void IntrusiveHeap<T, Compare, HeapHandleAccessor>::ClearHeapHandle(
+template <typename T,
+          typename Compare,
+          typename HeapHandleAccessor,
+          size_t kArity>
+void IntrusiveHeap<T, Compare, HeapHandleAccessor, kArity>::ClearHeapHandle(
     size_type i) {
   impl_.get_heap_handle_access().ClearHeapHandle(&impl_.heap_[i]);
   DCHECK(!GetHeapHandle(i).IsValid());
 }
 
-template <typename T, typename Compare, typename HeapHandleAccessor>
-HeapHandle IntrusiveHeap<T, Compare, HeapHandleAccessor>::GetHeapHandle(
+template <typename T,
+          typename Compare,
+          typename HeapHandleAccessor,
+          size_t kArity>
+HeapHandle IntrusiveHeap<T, Compare, HeapHandleAccessor, kArity>::GetHeapHandle(
     size_type i) {
   return impl_.get_heap_handle_access().GetHeapHandle(&impl_.heap_[i]);
 }
 
-template <typename T, typename Compare, typename HeapHandleAccessor>
-bool IntrusiveHeap<T, Compare, HeapHandleAccessor>::Less(size_type i,
-                                                         size_type j) {
+template <typename T,
+          typename Compare,
+          typename HeapHandleAccessor,
+          size_t kArity>
+bool IntrusiveHeap<T, Compare, HeapHandleAccessor, kArity>::Less(
+    size_type i,
+    size_type j) {
   DCHECK_LT(i, size());
   DCHECK_LT(j, size());
   return impl_.get_value_compare()(impl_.heap_[i], impl_.heap_[j]);
 }
 
-template <typename T, typename Compare, typename HeapHandleAccessor>
-bool IntrusiveHeap<T, Compare, HeapHandleAccessor>::Less(const T& element,
-                                                         size_type i) {
+template <typename T,
+          typename Compare,
+          typename HeapHandleAccessor,
+          size_t kArity>
+bool IntrusiveHeap<T, Compare, HeapHandleAccessor, kArity>::Less(
+    const T& element,
+    size_type i) {
   DCHECK_LT(i, size());
   return impl_.get_value_compare()(element, impl_.heap_[i]);
 }
 
-template <typename T, typename Compare, typename HeapHandleAccessor>
-bool IntrusiveHeap<T, Compare, HeapHandleAccessor>::Less(size_type i,
-                                                         const T& element) {
+template <typename T,
+          typename Compare,
+          typename HeapHandleAccessor,
+          size_t kArity>
+bool IntrusiveHeap<T, Compare, HeapHandleAccessor, kArity>::Less(
+    size_type i,
+    const T& element) {
   DCHECK_LT(i, size());
   return impl_.get_value_compare()(impl_.heap_[i], element);
 }
 
-template <typename T, typename Compare, typename HeapHandleAccessor>
-void IntrusiveHeap<T, Compare, HeapHandleAccessor>::MakeHole(size_type pos) {
+template <typename T,
+          typename Compare,
+          typename HeapHandleAccessor,
+          size_t kArity>
+void IntrusiveHeap<T, Compare, HeapHandleAccessor, kArity>::MakeHole(
+    size_type pos) {
   DCHECK_LT(pos, size());
   ClearHeapHandle(pos);
 }
 
-template <typename T, typename Compare, typename HeapHandleAccessor>
+template <typename T,
+          typename Compare,
+          typename HeapHandleAccessor,
+          size_t kArity>
 template <typename U>
-void IntrusiveHeap<T, Compare, HeapHandleAccessor>::FillHole(size_type hole_pos,
-                                                             U element) {
+void IntrusiveHeap<T, Compare, HeapHandleAccessor, kArity>::FillHole(
+    size_type hole_pos,
+    U element) {
   // The hole that we're filling may not yet exist. This can occur when
   // inserting a new element into the heap.
   DCHECK_LE(hole_pos, size());
@@ -985,8 +1087,11 @@ void IntrusiveHeap<T, Compare, HeapHandleAccessor>::FillHole(size_type hole_pos,
   SetHeapHandle(hole_pos);
 }
 
-template <typename T, typename Compare, typename HeapHandleAccessor>
-void IntrusiveHeap<T, Compare, HeapHandleAccessor>::MoveHole(
+template <typename T,
+          typename Compare,
+          typename HeapHandleAccessor,
+          size_t kArity>
+void IntrusiveHeap<T, Compare, HeapHandleAccessor, kArity>::MoveHole(
     size_type new_hole_pos,
     size_type old_hole_pos) {
   // The old hole position may be one past the end. This occurs when a new
@@ -1004,10 +1109,13 @@ void IntrusiveHeap<T, Compare, HeapHandleAccessor>::MoveHole(
   SetHeapHandle(old_hole_pos);
 }
 
-template <typename T, typename Compare, typename HeapHandleAccessor>
+template <typename T,
+          typename Compare,
+          typename HeapHandleAccessor,
+          size_t kArity>
 template <typename U>
-typename IntrusiveHeap<T, Compare, HeapHandleAccessor>::size_type
-IntrusiveHeap<T, Compare, HeapHandleAccessor>::MoveHoleUpAndFill(
+typename IntrusiveHeap<T, Compare, HeapHandleAccessor, kArity>::size_type
+IntrusiveHeap<T, Compare, HeapHandleAccessor, kArity>::MoveHoleUpAndFill(
     size_type hole_pos,
     U element) {
   // Moving 1 spot beyond the end is fine. This happens when we insert a new
@@ -1017,7 +1125,7 @@ IntrusiveHeap<T, Compare, HeapHandleAccessor>::MoveHoleUpAndFill(
   // Stop when the element is as far up as it can go.
   while (hole_pos != 0) {
     // If our parent is >= to us, we can stop.
-    size_type parent = intrusive_heap::ParentIndex(hole_pos);
+    size_type parent = intrusive_heap::ParentIndex(hole_pos, kArity);
     if (!Less(parent, element))
       break;
 
@@ -1029,10 +1137,13 @@ IntrusiveHeap<T, Compare, HeapHandleAccessor>::MoveHoleUpAndFill(
   return hole_pos;
 }
 
-template <typename T, typename Compare, typename HeapHandleAccessor>
+template <typename T,
+          typename Compare,
+          typename HeapHandleAccessor,
+          size_t kArity>
 template <typename FillElementType, typename U>
-typename IntrusiveHeap<T, Compare, HeapHandleAccessor>::size_type
-IntrusiveHeap<T, Compare, HeapHandleAccessor>::MoveHoleDownAndFill(
+typename IntrusiveHeap<T, Compare, HeapHandleAccessor, kArity>::size_type
+IntrusiveHeap<T, Compare, HeapHandleAccessor, kArity>::MoveHoleDownAndFill(
     size_type hole_pos,
     U element) {
   DCHECK_LT(hole_pos, size());
@@ -1046,15 +1157,17 @@ IntrusiveHeap<T, Compare, HeapHandleAccessor>::MoveHoleDownAndFill(
 
   while (true) {
     // If this spot has no children, then we've gone down as far as we can go.
-    size_type left = intrusive_heap::LeftIndex(hole_pos);
+    size_type left = intrusive_heap::LeftIndex(hole_pos, kArity);
     if (left >= n)
       break;
-    size_type right = left + 1;
 
-    // Get the larger of the potentially two child nodes.
+    // Get the largest of the up to |kArity| child nodes.
     size_type largest = left;
-    if (right < n && Less(left, right))
-      largest = right;
+    const size_type end = std::min(left + kArity, n);
+    for (size_type child = left + 1; child < end; ++child) {
+      if (Less(largest, child))
+        largest = child;
+    }
 
     // If we're not deterministically moving the element all the way down to
     // become a leaf, then stop when it is >= the largest of the children.
@@ -1075,10 +1188,13 @@ IntrusiveHeap<T, Compare, HeapHandleAccessor>::MoveHoleDownAndFill(
   return hole_pos;
 }
 
-template <typename T, typename Compare, typename HeapHandleAccessor>
+template <typename T,
+          typename Compare,
+          typename HeapHandleAccessor,
+          size_t kArity>
 template <typename U>
-typename IntrusiveHeap<T, Compare, HeapHandleAccessor>::const_iterator
-IntrusiveHeap<T, Compare, HeapHandleAccessor>::InsertImpl(U element) {
+typename IntrusiveHeap<T, Compare, HeapHandleAccessor, kArity>::const_iterator
+IntrusiveHeap<T, Compare, HeapHandleAccessor, kArity>::InsertImpl(U element) {
   // MoveHoleUpAndFill can tolerate the initial hole being in a slot that
   // doesn't yet exist. It will be created by MoveHole by copy/move, thus
   // removing the need for a default constructor.
@@ -1086,11 +1202,15 @@ IntrusiveHeap<T, Compare, HeapHandleAccessor>::InsertImpl(U element) {
   return cbegin() + i;
 }
 
-template <typename T, typename Compare, typename HeapHandleAccessor>
+template <typename T,
+          typename Compare,
+          typename HeapHandleAccessor,
+          size_t kArity>
 template <typename U>
-typename IntrusiveHeap<T, Compare, HeapHandleAccessor>::const_iterator
-IntrusiveHeap<T, Compare, HeapHandleAccessor>::ReplaceImpl(size_type pos,
-                                                           U element) {
+typename IntrusiveHeap<T, Compare, HeapHandleAccessor, kArity>::const_iterator
+IntrusiveHeap<T, Compare, HeapHandleAccessor, kArity>::ReplaceImpl(
+    size_type pos,
+    U element) {
   // If we're greater than our parent we need to go up, otherwise we may need
   // to go down.
   MakeHole(pos);
@@ -1103,10 +1223,14 @@ IntrusiveHeap<T, Compare, HeapHandleAccessor>::ReplaceImpl(size_type pos,
   return cbegin() + i;
 }
 
-template <typename T, typename Compare, typename HeapHandleAccessor>
+template <typename T,
+          typename Compare,
+          typename HeapHandleAccessor,
+          size_t kArity>
 template <typename U>
-typename IntrusiveHeap<T, Compare, HeapHandleAccessor>::const_iterator
-IntrusiveHeap<T, Compare, HeapHandleAccessor>::ReplaceTopImpl(U element) {
+typename IntrusiveHeap<T, Compare, HeapHandleAccessor, kArity>::const_iterator
+IntrusiveHeap<T, Compare, HeapHandleAccessor, kArity>::ReplaceTopImpl(
+    U element) {
   MakeHole(0u);
   size_type i =
       MoveHoleDownAndFill<WithElement>(0u, std::move_if_noexcept(element));
@@ -0,0 +1,196 @@
+// Copyright 2022 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "base/containers/intrusive_heap.h"
+
+#include <stdint.h>
+
+#include <string>
+#include <vector>
+
+#include "base/rand_util.h"
+#include "base/strings/string_number_conversions.h"
+#include "base/time/time.h"
+#include "base/timer/lap_timer.h"
+#include "testing/gtest/include/gtest/gtest.h"
+#include "testing/perf/perf_result_reporter.h"
+
+namespace base {
+namespace {
+
+constexpr TimeDelta kTimeLimit = Seconds(2);
+constexpr int kWarmupRuns = 1;
+constexpr int kTimeCheckInterval = 1;
+constexpr size_t kOperationsPerLap = 10000;
+
+constexpr char kMetricPrefixIntrusiveHeap[] = "IntrusiveHeap.";
+constexpr char kMetricTimePerOperation[] = "time_per_operation";
+
+// Like the elements of the heaps of the users of IntrusiveHeap (e.g. a
+// TaskSourceAndSortKey, or a DelayedTask), an element has a sort key, a
+// payload, and its HeapHandle lives out of the heap.
+struct Element {
+  uint64_t key;
+  HeapHandle* handle;
+  char payload[48];
+
+  void SetHeapHandle(HeapHandle heap_handle) { *handle = heap_handle; }
+  void ClearHeapHandle() { handle->reset(); }
+  HeapHandle GetHeapHandle() const { return *handle; }
+};
+
+// A min-heap, like the users'.
+struct ElementGreater {
+  bool operator()(const Element& a, const Element& b) const {
+    return a.key > b.key;
+  }
+};
+
+template <size_t kArity>
+using Heap = IntrusiveHeap<Element,
+                           ElementGreater,
+                           DefaultHeapHandleAccessor<Element>,
+                           kArity>;
+
+// Fills a heap of |size| elements with random keys, whose handles are in
+// |handles|.
+template <size_t kArity>
+Heap<kArity> MakeHeap(std::vector<HeapHandle>& handles) {
+  Heap<kArity> heap;
+  for (HeapHandle& handle : handles)
+    heap.insert(Element{RandUint64() % handles.size(), &handle, {}});
+  return heap;
+}
+
+// Random numbers, generated ahead of time so that they don't dominate the
+// timings.
+class RandomNumbers {
+ public:
+  RandomNumbers() : numbers_(1 << 16) {
+    for (uint64_t& number : numbers_)
+      number = RandUint64();
+  }
+
+  uint64_t Next() { return numbers_[next_++ & (numbers_.size() - 1)]; }
+
+ private:
+  std::vector<uint64_t> numbers_;
+  size_t next_ = 0;
+};
+
+template <size_t kArity, class Operation>
+void RunOperations(size_t size,
+                   const std::string& story_name,
+                   Operation operation) {
+  std::vector<HeapHandle> handles(size);
+  Heap<kArity> heap = MakeHeap<kArity>(handles);
+  RandomNumbers random_numbers;
+
+  LapTimer timer(kWarmupRuns, kTimeLimit, kTimeCheckInterval);
+  do {
+    for (size_t i = 0; i < kOperationsPerLap; ++i)
+      operation(heap, handles, random_numbers);
+    timer.NextLap();
+  } while (!timer.HasTimeLimitExpired());
+  EXPECT_EQ(size, heap.size());
+
+  perf_test::PerfResultReporter reporter(
+      kMetricPrefixIntrusiveHeap,
+      story_name + "_" + NumberToString(kArity) + "ary_" +
+          NumberToString(size));
+  reporter.RegisterImportantMetric(kMetricTimePerOperation, "ns");
+  reporter.AddResult(kMetricTimePerOperation,
+                     1e9 / (timer.LapsPerSecond() * kOperationsPerLap));
+}
+
+// DelayedTaskManager and DelayedIncomingQueue: the earliest delayed task runs,
+// and a task is posted with a later delay. Every 16th operation also cancels a
+// task, and posts another one.
+template <size_t kArity>
+void RunDelayedTasks(size_t size) {
+  RunOperations<kArity>(
+      size, "delayed_tasks",
+      [](Heap<kArity>& heap, std::vector<HeapHandle>& handles,
+         RandomNumbers& random_numbers) {
+        const uint64_t now = heap.top().key;
+        HeapHandle* handle = heap.top().handle;
+        heap.pop();
+        heap.insert(
+            Element{now + random_numbers.Next() % handles.size(), handle, {}});
+
+        const uint64_t random_number = random_numbers.Next();
+        if (random_number % 16 == 0) {
+          handle = &handles[random_number / 16 % handles.size()];
+          heap.erase(*handle);
+          heap.insert(Element{
+              now + random_numbers.Next() % handles.size(), handle, {}});
+        }
+      });
+}
+
+// PriorityQueue: a worker takes the task source at the top, and queues it back
+// with the sort key of its next task, and a random task source has its priority
+// updated.
+template <size_t kArity>
+void RunPriorityQueue(size_t size) {
+  RunOperations<kArity>(
+      size, "priority_queue",
+      [](Heap<kArity>& heap, std::vector<HeapHandle>& handles,
+         RandomNumbers& random_numbers) {
+        const uint64_t now = heap.top().key;
+        heap.ReplaceTop(Element{now + random_numbers.Next() % handles.size(),
+                                heap.top().handle,
+                                {}});
+
+        HeapHandle& handle =
+            handles[random_numbers.Next() % handles.size()];
+        heap.Modify(handle, [&](Element& element) {
+          element.key = now + random_numbers.Next() % handles.size();
+        });
+      });
+}
+
+// WakeUpQueue: a random queue changes its next wake-up.
+template <size_t kArity>
+void RunWakeUpQueue(size_t size) {
+  RunOperations<kArity>(
+      size, "wake_up_queue",
+      [](Heap<kArity>& heap, std::vector<HeapHandle>& handles,
+         RandomNumbers& random_numbers) {
+        const uint64_t now = heap.top().key;
+        HeapHandle& handle =
+            handles[random_numbers.Next() % handles.size()];
+        heap.Modify(handle, [&](Element& element) {
+          element.key = now + random_numbers.Next() % handles.size();
+        });
+      });
+}
+
+class IntrusiveHeapPerfTest : public testing::TestWithParam<size_t> {};
+
+}  // namespace
+
+TEST_P(IntrusiveHeapPerfTest, DelayedTasks) {
+  RunDelayedTasks<2>(GetParam());
+  RunDelayedTasks<4>(GetParam());
+  RunDelayedTasks<8>(GetParam());
+}
+
+TEST_P(IntrusiveHeapPerfTest, PriorityQueue) {
+  RunPriorityQueue<2>(GetParam());
+  RunPriorityQueue<4>(GetParam());
+  RunPriorityQueue<8>(GetParam());
+}
+
+TEST_P(IntrusiveHeapPerfTest, WakeUpQueue) {
+  RunWakeUpQueue<2>(GetParam());
+  RunWakeUpQueue<4>(GetParam());
+  RunWakeUpQueue<8>(GetParam());
+}
+
+INSTANTIATE_TEST_SUITE_P(All,
+                         IntrusiveHeapPerfTest,
+                         testing::Values(1000, 10000, 100000));
+
+}  // namespace base
@@ -4,6 +4,9 @@
 
 #include "base/containers/intrusive_heap.h"
 
+#include <algorithm>
+#include <limits>
+
 #include "base/callback_helpers.h"
 #include "base/check_op.h"
 #include "base/cxx17_backports.h"
@@ -27,13 +30,10 @@ void ExpectHeap(const H& heap) {
   const auto& handle_access = heap.heap_handle_access();
 
   for (size_t i = 0; i < heap.size(); ++i) {
-    size_t left = intrusive_heap::LeftIndex(i);
-    size_t right = left + 1;
-
-    if (left < heap.size())
-      EXPECT_FALSE(less(heap[i], heap[left]));
-    if (right < heap.size())
-      EXPECT_FALSE(less(heap[i], heap[right]));
+    const size_t left = intrusive_heap::LeftIndex(i, heap.arity());
+    const size_t end = std::min(left + heap.arity(), heap.size());
+    for (size_t child = left; child < end; ++child)
+      EXPECT_FALSE(less(heap[i], heap[child]));
 
     intrusive_heap::CheckInvalidOrEqualTo(handle_access.GetHeapHandle(&heap[i]),
                                           i);
@@ -1108,6 +1108,81 @@ TEST(IntrusiveHeapTest, EraseIf) {
   EXPECT_THAT(results, testing::ElementsAre(1, 3, 5, 7, 9));
 }
 
+template <size_t kArity>
+using DAryIntrusiveHeapInt =
+    IntrusiveHeap<WithHeapHandle<int>,
+                  std::less<WithHeapHandle<int>>,
+                  DefaultHeapHandleAccessor<WithHeapHandle<int>>,
+                  kArity>;
+
+// Checks the heap property and the handles of a d-ary heap across all the
+// operations which move elements.
+template <size_t kArity>
+void DAryStressTest() {
+  DAryIntrusiveHeapInt<kArity> heap;
+  for (int i = 0; i < 1000; ++i)
+    heap.insert(RandInt(0, 10000));
+  ExpectHeap(heap);
+
+  for (int i = 0; i < 500; ++i) {
+    const int new_value = RandInt(0, 10000);
+    const size_t index = static_cast<size_t>(RandInt(0, heap.size() - 1));
+    HeapHandle* handle = heap[index].handle();
+    auto it = heap.Modify(
+        index, [new_value](auto& element) { element.value() = new_value; });
+    EXPECT_EQ(new_value, it->value());
+    EXPECT_EQ(handle->index(), heap.ToIndex(it));
+    ExpectHeap(heap);
+  }
+
+  for (int i = 0; i < 200; ++i) {
+    heap.erase(static_cast<size_t>(RandInt(0, heap.size() - 1)));
+    ExpectHeap(heap);
+  }
+
+  heap.EraseIf([](const auto& element) { return element.value() % 2; });
+  ExpectHeap(heap);
+
+  int previous = std::numeric_limits<int>::max();
+  while (!heap.empty()) {
+    EXPECT_EQ(0, heap.top().value() % 2);
+    EXPECT_LE(heap.top().value(), previous);
+    previous = heap.top().value();
+    heap.pop();
+    ExpectHeap(heap);
+  }
+}
+
+TEST(IntrusiveHeapTest, DAry) {
+  DAryStressTest<3>();
+  DAryStressTest<4>();
+  DAryStressTest<8>();
+}
+
+TEST(IntrusiveHeapTest, DAryLayout) {
+  // 0 is the root, 1-4 its children and 5-8 the children of 1.
+  EXPECT_EQ(1u, intrusive_heap::LeftIndex(0, 4));
+  EXPECT_EQ(5u, intrusive_heap::LeftIndex(1, 4));
+  EXPECT_EQ(0u, intrusive_heap::ParentIndex(4, 4));
+  EXPECT_EQ(1u, intrusive_heap::ParentIndex(8, 4));
+  EXPECT_EQ(2u, intrusive_heap::ParentIndex(9, 4));
+
+  DAryIntrusiveHeapInt<4> heap({CANONICAL_ELEMENTS});
+  ExpectHeap(heap);
+  // 3
+  // 3 1
+  // 3 1 2
+  // 3 1 2 4 -> 4 1 2 3
+  // 4 1 2 3 5 -> 5 1 2 3 4
+  // 5 1 2 3 4 6 -> 5 6 2 3 4 1 -> 6 5 2 3 4 1
+  // 6 5 2 3 4 1 7 -> 6 7 2 3 4 1 5 -> 7 6 2 3 4 1 5
+  // 7 6 2 3 4 1 5 0
+  std::vector<int> actual;
+  for (const auto& element : heap)
+    actual.push_back(element.value());
+  EXPECT_THAT(actual, testing::ElementsAre(7, 6, 2, 3, 4, 1, 5, 0));
+}
+
 // A comparator class whose sole purpose is to allow the insertion of a
 // ScopedClosureRunner inside the heap. The ordering does not matter.
 class Comparator {
@@ -26,6 +26,7 @@
 #include <utility>
 
 #include "base/check.h"
+#include "base/containers/flat_hash_map.h"
 
 namespace base {
 namespace trace_event {
@@ -242,15 +243,25 @@ struct LRUCacheHashMap {
   using Type = std::unordered_map<KeyType, ValueType, HashType>;
 };
 
+template <class KeyType, class ValueType, class HashType>
+struct LRUCacheFlatHashMap {
+  using Type = flat_hash_map<KeyType, ValueType, HashType>;
+};
+
 // This class is similar to LRUCache, except that it uses std::unordered_map as
 // the map type instead of std::map. Note that your KeyType must be hashable to
 // use this cache or you need to provide a hashing class.
-template <class KeyType, class PayloadType, class HashType = std::hash<KeyType>>
+//
+// The map type may also be LRUCacheFlatHashMap, see FlatHashingLRUCache below.
+template <class KeyType,
+          class PayloadType,
+          class HashType = std::hash<KeyType>,
+          template <typename, typename, typename> class MapType =
+              LRUCacheHashMap>
 class HashingLRUCache
-    : public LRUCacheBase<KeyType, PayloadType, HashType, LRUCacheHashMap> {
+    : public LRUCacheBase<KeyType, PayloadType, HashType, MapType> {
  private:
-  using ParentType =
-      LRUCacheBase<KeyType, PayloadType, HashType, LRUCacheHashMap>;
+  using ParentType = LRUCacheBase<KeyType, PayloadType, HashType, MapType>;
 
  public:
   // See LRUCacheBase, noting the possibility of using NO_AUTO_EVICT.
@@ -261,6 +272,15 @@ class HashingLRUCache
   ~HashingLRUCache() override = default;
 };
 
+// A HashingLRUCache indexed by a base::flat_hash_map, which avoids a node
+// allocation per entry. Its default hasher is absl::Hash, since the probing of
+// a flat_hash_map needs hashes whose bits are mixed (see flat_hash_map.h).
+template <class KeyType,
+          class PayloadType,
+          class HashType = absl::Hash<KeyType>>
+using FlatHashingLRUCache =
+    HashingLRUCache<KeyType, PayloadType, HashType, LRUCacheFlatHashMap>;
+
 }  // namespace base
 
 #endif  // BASE_CONTAINERS_LRU_CACHE_H_
@@ -276,6 +276,22 @@ TEST(LRUCacheTest, HashingLRUCache) {
   EXPECT_TRUE(cache.Get("First") == cache.end());
 }
 
+TEST(LRUCacheTest, FlatHashingLRUCache) {
+  typedef base::FlatHashingLRUCache<int, CachedItem> Cache;
+  Cache cache(10);
+
+  for (int i = 0; i < 100; ++i)
+    cache.Put(i, CachedItem(i));
+  EXPECT_EQ(10U, cache.size());
+  EXPECT_TRUE(cache.Get(89) == cache.end());
+  EXPECT_EQ(90, cache.Get(90)->second.value);
+
+  // The most recently used item is the one which was just looked up.
+  cache.ShrinkToSize(1);
+  EXPECT_EQ(90, cache.begin()->second.value);
+  EXPECT_TRUE(cache.Peek(99) == cache.end());
+}
+
 TEST(LRUCacheTest, Swap) {
   typedef base::LRUCache<int, CachedItem> Cache;
   Cache cache1(Cache::NO_AUTO_EVICT);
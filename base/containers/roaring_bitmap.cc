@@ -0,0 +1,942 @@
+// Copyright 2022 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "base/containers/roaring_bitmap.h"
+
+#include <string.h>
+
+#include <algorithm>
+#include <iterator>
+#include <utility>
+
+#include "base/bits.h"
+#include "base/check_op.h"
+#include "base/notreached.h"
+#include "third_party/abseil-cpp/absl/numeric/bits.h"
+
+namespace base {
+
+namespace {
+
+// The number of values in a container, and the words of a bitmap container.
+constexpr uint32_t kContainerBits = 1 << 16;
+constexpr size_t kBitmapWords = kContainerBits / 64;
+
+// The largest array container. A larger one would take more memory than a
+// bitmap.
+constexpr uint32_t kMaxArraySize = 4096;
+
+// The serialization:
+//
+//   Header
+//   Descriptor[container_count], in increasing order of keys.
+//   The payloads of the containers, each aligned to 8 bytes: the uint16_t
+//   values of an array, the kBitmapWords uint64_t words of a bitmap, or the
+//   {uint16_t start, uint16_t length} runs of runs.
+constexpr uint32_t kMagic = 0x314d4252;  // "RBM1"
+constexpr size_t kPayloadAlignment = 8;
+
+struct Header {
+  uint32_t magic;
+  uint32_t container_count;
+};
+
+struct Descriptor {
+  uint16_t key;
+  uint8_t type;
+  uint8_t reserved;
+  uint32_t cardinality;
+  // The offset of the payload from the start of the serialization.
+  uint32_t offset;
+  // The number of values of an array, words of a bitmap, or runs.
+  uint32_t size;
+};
+
+static_assert(sizeof(Header) == 8, "Header must have no padding.");
+static_assert(sizeof(Descriptor) == 16, "Descriptor must have no padding.");
+
+// Returns the first set bit of |words| at or after |from|, or kContainerBits.
+uint32_t NextSetBit(const uint64_t* words, uint32_t from) {
+  if (from >= kContainerBits)
+    return kContainerBits;
+  size_t index = from / 64;
+  uint64_t word = words[index] & (~uint64_t{0} << (from % 64));
+  while (!word) {
+    if (++index == kBitmapWords)
+      return kContainerBits;
+    word = words[index];
+  }
+  return static_cast<uint32_t>(index * 64 + bits::CountTrailingZeroBits(word));
+}
+
+// Returns the first clear bit of |words| at or after |from|, or
+// kContainerBits.
+uint32_t NextClearBit(const uint64_t* words, uint32_t from) {
+  if (from >= kContainerBits)
+    return kContainerBits;
+  size_t index = from / 64;
+  uint64_t word = ~words[index] & (~uint64_t{0} << (from % 64));
+  while (!word) {
+    if (++index == kBitmapWords)
+      return kContainerBits;
+    word = ~words[index];
+  }
+  return static_cast<uint32_t>(index * 64 + bits::CountTrailingZeroBits(word));
+}
+
+// Sets the bits |first| to |last| of |words|, both included.
+void SetRange(uint64_t* words, uint32_t first, uint32_t last) {
+  const size_t first_word = first / 64;
+  const size_t last_word = last / 64;
+  const uint64_t first_mask = ~uint64_t{0} << (first % 64);
+  const uint64_t last_mask = ~uint64_t{0} >> (63 - last % 64);
+  if (first_word == last_word) {
+    words[first_word] |= first_mask & last_mask;
+    return;
+  }
+  words[first_word] |= first_mask;
+  for (size_t i = first_word + 1; i < last_word; ++i)
+    words[i] = ~uint64_t{0};
+  words[last_word] |= last_mask;
+}
+
+uint32_t CountBits(const uint64_t* words) {
+  uint32_t count = 0;
+  for (size_t i = 0; i < kBitmapWords; ++i)
+    count += static_cast<uint32_t>(absl::popcount(words[i]));
+  return count;
+}
+
+// Returns the number of runs of consecutive set bits in |words|, which start
+// at the set bits whose previous bit is clear.
+size_t CountBitmapRuns(const uint64_t* words) {
+  size_t runs = 0;
+  uint64_t carry = 0;
+  for (size_t i = 0; i < kBitmapWords; ++i) {
+    runs += static_cast<size_t>(
+        absl::popcount(words[i] & ~((words[i] << 1) | carry)));
+    carry = words[i] >> 63;
+  }
+  return runs;
+}
+
+bool BitmapContains(const uint64_t* words, uint16_t low) {
+  return (words[low / 64] >> (low % 64)) & 1;
+}
+
+template <typename Run>
+bool RunsContain(const Run* runs, size_t size, uint16_t low) {
+  const Run* it = std::upper_bound(
+      runs, runs + size, low,
+      [](uint16_t low, const Run& run) { return low < run.start; });
+  if (it == runs)
+    return false;
+  --it;
+  return low - it->start <= it->length;
+}
+
+// Returns the values of |container|, in increasing order.
+template <typename Container>
+std::vector<uint16_t> ValuesOf(const Container& container) {
+  if (!container.array.empty())
+    return container.array;
+  std::vector<uint16_t> values;
+  values.reserve(container.cardinality);
+  if (!container.words.empty()) {
+    for (uint32_t i = NextSetBit(container.words.data(), 0);
+         i < kContainerBits; i = NextSetBit(container.words.data(), i + 1)) {
+      values.push_back(static_cast<uint16_t>(i));
+    }
+    return values;
+  }
+  for (const auto& run : container.runs) {
+    for (uint32_t i = 0; i <= run.length; ++i)
+      values.push_back(static_cast<uint16_t>(run.start + i));
+  }
+  return values;
+}
+
+}  // namespace
+
+// RoaringBitmap::const_iterator -----------------------------------------------
+
+RoaringBitmap::const_iterator::const_iterator() = default;
+
+RoaringBitmap::const_iterator::const_iterator(const const_iterator&) = default;
+
+RoaringBitmap::const_iterator& RoaringBitmap::const_iterator::operator=(
+    const const_iterator&) = default;
+
+RoaringBitmap::const_iterator::~const_iterator() = default;
+
+RoaringBitmap::const_iterator::const_iterator(const RoaringBitmap* bitmap,
+                                              size_t container)
+    : bitmap_(bitmap), container_(container) {
+  if (container_ < bitmap_->containers_.size() &&
+      bitmap_->containers_[container_].type == ContainerType::kBitmap) {
+    index_ = NextSetBit(bitmap_->containers_[container_].words.data(), 0);
+  }
+  UpdateValue();
+}
+
+RoaringBitmap::const_iterator& RoaringBitmap::const_iterator::operator++() {
+  DCHECK_LT(container_, bitmap_->containers_.size());
+  const Container& container = bitmap_->containers_[container_];
+  switch (container.type) {
+    case ContainerType::kArray:
+      if (++index_ == container.array.size())
+        NextContainer();
+      break;
+    case ContainerType::kBitmap:
+      index_ = NextSetBit(container.words.data(), index_ + 1);
+      if (index_ == kContainerBits)
+        NextContainer();
+      break;
+    case ContainerType::kRun:
+      if (++offset_ > container.runs[index_].length) {
+        offset_ = 0;
+        if (++index_ == container.runs.size())
+          NextContainer();
+      }
+      break;
+  }
+  UpdateValue();
+  return *this;
+}
+
+RoaringBitmap::const_iterator RoaringBitmap::const_iterator::operator++(int) {
+  const_iterator ret = *this;
+  ++*this;
+  return ret;
+}
+
+void RoaringBitmap::const_iterator::NextContainer() {
+  ++container_;
+  index_ = 0;
+  offset_ = 0;
+  if (container_ < bitmap_->containers_.size() &&
+      bitmap_->containers_[container_].type == ContainerType::kBitmap) {
+    index_ = NextSetBit(bitmap_->containers_[container_].words.data(), 0);
+  }
+}
+
+void RoaringBitmap::const_iterator::UpdateValue() {
+  if (container_ == bitmap_->containers_.size()) {
+    value_ = 0;
+    return;
+  }
+  const Container& container = bitmap_->containers_[container_];
+  uint32_t low = 0;
+  switch (container.type) {
+    case ContainerType::kArray:
+      low = container.array[index_];
+      break;
+    case ContainerType::kBitmap:
+      low = index_;
+      break;
+    case ContainerType::kRun:
+      low = container.runs[index_].start + offset_;
+      break;
+  }
+  value_ = (uint32_t{bitmap_->keys_[container_]} << 16) | low;
+}
+
+// RoaringBitmap::Container ----------------------------------------------------
+
+RoaringBitmap::Container::Container() = default;
+
+RoaringBitmap::Container::Container(const Container&) = default;
+
+RoaringBitmap::Container::Container(Container&&) noexcept = default;
+
+RoaringBitmap::Container& RoaringBitmap::Container::operator=(
+    const Container&) = default;
+
+RoaringBitmap::Container& RoaringBitmap::Container::operator=(
+    Container&&) noexcept = default;
+
+RoaringBitmap::Container::~Container() = default;
+
+bool RoaringBitmap::Container::Contains(uint16_t low) const {
+  switch (type) {
+    case ContainerType::kArray:
+      return std::binary_search(array.begin(), array.end(), low);
+    case ContainerType::kBitmap:
+      return BitmapContains(words.data(), low);
+    case ContainerType::kRun:
+      return RunsContain(runs.data(), runs.size(), low);
+  }
+}
+
+bool RoaringBitmap::Container::Add(uint16_t low) {
+  switch (type) {
+    case ContainerType::kArray: {
+      auto it = std::lower_bound(array.begin(), array.end(), low);
+      if (it != array.end() && *it == low)
+        return false;
+      array.insert(it, low);
+      ++cardinality;
+      Normalize();
+      return true;
+    }
+    case ContainerType::kBitmap: {
+      uint64_t& word = words[low / 64];
+      const uint64_t mask = uint64_t{1} << (low % 64);
+      if (word & mask)
+        return false;
+      word |= mask;
+      ++cardinality;
+      return true;
+    }
+    case ContainerType::kRun:
+      if (Contains(low))
+        return false;
+      Decompress();
+      return Add(low);
+  }
+}
+
+bool RoaringBitmap::Container::Remove(uint16_t low) {
+  switch (type) {
+    case ContainerType::kArray: {
+      auto it = std::lower_bound(array.begin(), array.end(), low);
+      if (it == array.end() || *it != low)
+        return false;
+      array.erase(it);
+      --cardinality;
+      return true;
+    }
+    case ContainerType::kBitmap: {
+      uint64_t& word = words[low / 64];
+      const uint64_t mask = uint64_t{1} << (low % 64);
+      if (!(word & mask))
+        return false;
+      word &= ~mask;
+      --cardinality;
+      Normalize();
+      return true;
+    }
+    case ContainerType::kRun:
+      if (!Contains(low))
+        return false;
+      Decompress();
+      return Remove(low);
+  }
+}
+
+void RoaringBitmap::Container::FillWords(uint64_t* bitmap_words) const {
+  switch (type) {
+    case ContainerType::kArray:
+      for (uint16_t low : array)
+        bitmap_words[low / 64] |= uint64_t{1} << (low % 64);
+      break;
+    case ContainerType::kBitmap:
+      for (size_t i = 0; i < kBitmapWords; ++i)
+        bitmap_words[i] |= words[i];
+      break;
+    case ContainerType::kRun:
+      for (const Run& run : runs)
+        SetRange(bitmap_words, run.start, uint32_t{run.start} + run.length);
+      break;
+  }
+}
+
+void RoaringBitmap::Container::Decompress() {
+  if (type != ContainerType::kRun)
+    return;
+  if (cardinality <= kMaxArraySize) {
+    array = ValuesOf(*this);
+    type = ContainerType::kArray;
+  } else {
+    words.assign(kBitmapWords, 0);
+    FillWords(words.data());
+    type = ContainerType::kBitmap;
+  }
+  runs.clear();
+  runs.shrink_to_fit();
+}
+
+void RoaringBitmap::Container::Normalize() {
+  if (type == ContainerType::kArray && cardinality > kMaxArraySize) {
+    words.assign(kBitmapWords, 0);
+    FillWords(words.data());
+    array.clear();
+    array.shrink_to_fit();
+    type = ContainerType::kBitmap;
+  } else if (type == ContainerType::kBitmap && cardinality <= kMaxArraySize) {
+    array = ValuesOf(*this);
+    words.clear();
+    words.shrink_to_fit();
+    type = ContainerType::kArray;
+  }
+}
+
+void RoaringBitmap::Container::RunOptimize() {
+  size_t run_count = 0;
+  switch (type) {
+    case ContainerType::kArray:
+      for (size_t i = 0; i < array.size(); ++i) {
+        if (i == 0 || array[i] != array[i - 1] + 1)
+          ++run_count;
+      }
+      break;
+    case ContainerType::kBitmap:
+      run_count = CountBitmapRuns(words.data());
+      break;
+    case ContainerType::kRun:
+      run_count = runs.size();
+      break;
+  }
+  const size_t uncompressed_size = cardinality <= kMaxArraySize
+                                       ? cardinality * sizeof(uint16_t)
+                                       : kBitmapWords * sizeof(uint64_t);
+  if (run_count * sizeof(Run) >= uncompressed_size) {
+    Decompress();
+    return;
+  }
+  if (type == ContainerType::kRun)
+    return;
+
+  std::vector<Run> new_runs;
+  new_runs.reserve(run_count);
+  if (type == ContainerType::kArray) {
+    for (uint16_t low : array) {
+      if (!new_runs.empty() &&
+          new_runs.back().start + new_runs.back().length + 1 == low) {
+        ++new_runs.back().length;
+      } else {
+        new_runs.push_back({low, 0});
+      }
+    }
+  } else {
+    uint32_t start = NextSetBit(words.data(), 0);
+    while (start < kContainerBits) {
+      const uint32_t end = NextClearBit(words.data(), start);
+      new_runs.push_back({static_cast<uint16_t>(start),
+                          static_cast<uint16_t>(end - 1 - start)});
+      start = NextSetBit(words.data(), end);
+    }
+  }
+  DCHECK_EQ(run_count, new_runs.size());
+  runs = std::move(new_runs);
+  array.clear();
+  array.shrink_to_fit();
+  words.clear();
+  words.shrink_to_fit();
+  type = ContainerType::kRun;
+}
+
+size_t RoaringBitmap::Container::EstimateMemoryUsage() const {
+  return array.capacity() * sizeof(uint16_t) +
+         words.capacity() * sizeof(uint64_t) + runs.capacity() * sizeof(Run);
+}
+
+// RoaringBitmap ---------------------------------------------------------------
+
+RoaringBitmap::RoaringBitmap() = default;
+
+RoaringBitmap::RoaringBitmap(std::initializer_list<uint32_t> values) {
+  for (uint32_t value : values)
+    Add(value);
+}
+
+RoaringBitmap::RoaringBitmap(const RoaringBitmap&) = default;
+
+RoaringBitmap::RoaringBitmap(RoaringBitmap&&) noexcept = default;
+
+RoaringBitmap& RoaringBitmap::operator=(const RoaringBitmap&) = default;
+
+RoaringBitmap& RoaringBitmap::operator=(RoaringBitmap&&) noexcept = default;
+
+RoaringBitmap::~RoaringBitmap() = default;
+
+// static
+absl::optional<RoaringBitmap> RoaringBitmap::Deserialize(
+    span<const uint8_t> data) {
+  // Copies misaligned data, like the contents of a std::string, to aligned
+  // memory.
+  std::vector<uint64_t> aligned_copy;
+  if (reinterpret_cast<uintptr_t>(data.data()) % kPayloadAlignment) {
+    aligned_copy.resize(bits::AlignUp(data.size(), sizeof(uint64_t)) /
+                        sizeof(uint64_t));
+    memcpy(aligned_copy.data(), data.data(), data.size());
+    data = as_bytes(make_span(aligned_copy)).first(data.size());
+  }
+  absl::optional<RoaringBitmapView> view = RoaringBitmapView::Create(data);
+  if (!view)
+    return absl::nullopt;
+  return view->ToBitmap();
+}
+
+size_t RoaringBitmap::Cardinality() const {
+  size_t cardinality = 0;
+  for (const Container& container : containers_)
+    cardinality += container.cardinality;
+  return cardinality;
+}
+
+bool RoaringBitmap::Contains(uint32_t value) const {
+  const size_t index = FindContainer(static_cast<uint16_t>(value >> 16));
+  return index < keys_.size() &&
+         containers_[index].Contains(static_cast<uint16_t>(value));
+}
+
+bool RoaringBitmap::Add(uint32_t value) {
+  const uint16_t key = static_cast<uint16_t>(value >> 16);
+  auto it = std::lower_bound(keys_.begin(), keys_.end(), key);
+  const size_t index = static_cast<size_t>(it - keys_.begin());
+  if (it == keys_.end() || *it != key) {
+    keys_.insert(it, key);
+    containers_.emplace(containers_.begin() + index);
+  }
+  return containers_[index].Add(static_cast<uint16_t>(value));
+}
+
+bool RoaringBitmap::Remove(uint32_t value) {
+  const size_t index = FindContainer(static_cast<uint16_t>(value >> 16));
+  if (index == keys_.size() ||
+      !containers_[index].Remove(static_cast<uint16_t>(value))) {
+    return false;
+  }
+  if (!containers_[index].cardinality) {
+    keys_.erase(keys_.begin() + index);
+    containers_.erase(containers_.begin() + index);
+  }
+  return true;
+}
+
+void RoaringBitmap::Clear() {
+  keys_.clear();
+  containers_.clear();
+}
+
+void RoaringBitmap::RunOptimize() {
+  for (Container& container : containers_)
+    container.RunOptimize();
+}
+
+size_t RoaringBitmap::EstimateMemoryUsage() const {
+  size_t usage = keys_.capacity() * sizeof(uint16_t) +
+                 containers_.capacity() * sizeof(Container);
+  for (const Container& container : containers_)
+    usage += container.EstimateMemoryUsage();
+  return usage;
+}
+
+RoaringBitmap& RoaringBitmap::operator|=(const RoaringBitmap& other) {
+  if (&other == this)
+    return *this;
+  std::vector<uint16_t> keys;
+  std::vector<Container> containers;
+  keys.reserve(keys_.size() + other.keys_.size());
+  containers.reserve(keys_.size() + other.keys_.size());
+  size_t i = 0;
+  size_t j = 0;
+  while (i < keys_.size() || j < other.keys_.size()) {
+    if (j == other.keys_.size() ||
+        (i < keys_.size() && keys_[i] < other.keys_[j])) {
+      keys.push_back(keys_[i]);
+      containers.push_back(std::move(containers_[i++]));
+    } else if (i == keys_.size() || other.keys_[j] < keys_[i]) {
+      keys.push_back(other.keys_[j]);
+      containers.push_back(other.containers_[j++]);
+    } else {
+      keys.push_back(keys_[i]);
+      containers.push_back(Combine(containers_[i++], other.containers_[j++],
+                                   SetOperation::kUnion));
+    }
+  }
+  keys_ = std::move(keys);
+  containers_ = std::move(containers);
+  return *this;
+}
+
+RoaringBitmap& RoaringBitmap::operator&=(const RoaringBitmap& other) {
+  if (&other == this)
+    return *this;
+  std::vector<uint16_t> keys;
+  std::vector<Container> containers;
+  size_t i = 0;
+  size_t j = 0;
+  while (i < keys_.size() && j < other.keys_.size()) {
+    if (keys_[i] < other.keys_[j]) {
+      ++i;
+    } else if (other.keys_[j] < keys_[i]) {
+      ++j;
+    } else {
+      Container container = Combine(containers_[i], other.containers_[j],
+                                    SetOperation::kIntersection);
+      if (container.cardinality) {
+        keys.push_back(keys_[i]);
+        containers.push_back(std::move(container));
+      }
+      ++i;
+      ++j;
+    }
+  }
+  keys_ = std::move(keys);
+  containers_ = std::move(containers);
+  return *this;
+}
+
+RoaringBitmap& RoaringBitmap::operator-=(const RoaringBitmap& other) {
+  if (&other == this) {
+    Clear();
+    return *this;
+  }
+  std::vector<uint16_t> keys;
+  std::vector<Container> containers;
+  keys.reserve(keys_.size());
+  containers.reserve(keys_.size());
+  size_t j = 0;
+  for (size_t i = 0; i < keys_.size(); ++i) {
+    while (j < other.keys_.size() && other.keys_[j] < keys_[i])
+      ++j;
+    if (j == other.keys_.size() || other.keys_[j] != keys_[i]) {
+      keys.push_back(keys_[i]);
+      containers.push_back(std::move(containers_[i]));
+      continue;
+    }
+    Container container = Combine(containers_[i], other.containers_[j],
+                                  SetOperation::kDifference);
+    if (container.cardinality) {
+      keys.push_back(keys_[i]);
+      containers.push_back(std::move(container));
+    }
+  }
+  keys_ = std::move(keys);
+  containers_ = std::move(containers);
+  return *this;
+}
+
+bool operator==(const RoaringBitmap& lhs, const RoaringBitmap& rhs) {
+  if (lhs.keys_ != rhs.keys_)
+    return false;
+  for (size_t i = 0; i < lhs.containers_.size(); ++i) {
+    const RoaringBitmap::Container& lhs_container = lhs.containers_[i];
+    const RoaringBitmap::Container& rhs_container = rhs.containers_[i];
+    if (lhs_container.cardinality != rhs_container.cardinality)
+      return false;
+    // The arrays and bitmaps are chosen by cardinality, so only the runs can
+    // differ in type.
+    if (lhs_container.type == rhs_container.type) {
+      if (lhs_container.array != rhs_container.array ||
+          lhs_container.words != rhs_container.words ||
+          !std::equal(lhs_container.runs.begin(), lhs_container.runs.end(),
+                      rhs_container.runs.begin(), rhs_container.runs.end(),
+                      [](const RoaringBitmap::Run& lhs_run,
+                         const RoaringBitmap::Run& rhs_run) {
+                        return lhs_run.start == rhs_run.start &&
+                               lhs_run.length == rhs_run.length;
+                      })) {
+        return false;
+      }
+    } else if (ValuesOf(lhs_container) != ValuesOf(rhs_container)) {
+      return false;
+    }
+  }
+  return true;
+}
+
+std::vector<uint8_t> RoaringBitmap::Serialize() const {
+  std::vector<uint8_t> data(sizeof(Header) +
+                            containers_.size() * sizeof(Descriptor));
+  const Header header = {kMagic, static_cast<uint32_t>(containers_.size())};
+  memcpy(data.data(), &header, sizeof(header));
+  for (size_t i = 0; i < containers_.size(); ++i) {
+    const Container& container = containers_[i];
+    const void* payload = nullptr;
+    size_t size = 0;
+    size_t payload_size = 0;
+    switch (container.type) {
+      case ContainerType::kArray:
+        payload = container.array.data();
+        size = container.array.size();
+        payload_size = size * sizeof(uint16_t);
+        break;
+      case ContainerType::kBitmap:
+        payload = container.words.data();
+        size = container.words.size();
+        payload_size = size * sizeof(uint64_t);
+        break;
+      case ContainerType::kRun:
+        payload = container.runs.data();
+        size = container.runs.size();
+        payload_size = size * sizeof(Run);
+        break;
+    }
+    const size_t offset = bits::AlignUp(data.size(), kPayloadAlignment);
+    const Descriptor descriptor = {
+        keys_[i], static_cast<uint8_t>(container.type), 0,
+        container.cardinality, static_cast<uint32_t>(offset),
+        static_cast<uint32_t>(size)};
+    memcpy(data.data() + sizeof(Header) + i * sizeof(Descriptor), &descriptor,
+           sizeof(descriptor));
+    data.resize(offset + payload_size);
+    memcpy(data.data() + offset, payload, payload_size);
+  }
+  return data;
+}
+
+// static
+RoaringBitmap::Container RoaringBitmap::Combine(const Container& lhs,
+                                                const Container& rhs,
+                                                SetOperation operation) {
+  Container result;
+  if (lhs.type == ContainerType::kArray && rhs.type == ContainerType::kArray) {
+    auto out = std::back_inserter(result.array);
+    switch (operation) {
+      case SetOperation::kUnion:
+        result.array.reserve(lhs.array.size() + rhs.array.size());
+        std::set_union(lhs.array.begin(), lhs.array.end(), rhs.array.begin(),
+                       rhs.array.end(), out);
+        break;
+      case SetOperation::kIntersection:
+        std::set_intersection(lhs.array.begin(), lhs.array.end(),
+                              rhs.array.begin(), rhs.array.end(), out);
+        break;
+      case SetOperation::kDifference:
+        std::set_difference(lhs.array.begin(), lhs.array.end(),
+                            rhs.array.begin(), rhs.array.end(), out);
+        break;
+    }
+    result.cardinality = static_cast<uint32_t>(result.array.size());
+    result.Normalize();
+    return result;
+  }
+
+  // Filters an array by the other container.
+  if (rhs.type == ContainerType::kArray &&
+      operation == SetOperation::kIntersection) {
+    return Combine(rhs, lhs, operation);
+  }
+  if (lhs.type == ContainerType::kArray && operation != SetOperation::kUnion) {
+    const bool keep_contained = operation == SetOperation::kIntersection;
+    for (uint16_t low : lhs.array) {
+      if (rhs.Contains(low) == keep_contained)
+        result.array.push_back(low);
+    }
+    result.cardinality = static_cast<uint32_t>(result.array.size());
+    return result;
+  }
+
+  // Otherwise, combines bitmaps.
+  result.type = ContainerType::kBitmap;
+  result.words.assign(kBitmapWords, 0);
+  uint64_t* words = result.words.data();
+  lhs.FillWords(words);
+  if (operation == SetOperation::kUnion) {
+    rhs.FillWords(words);
+  } else {
+    std::vector<uint64_t> filled_rhs_words;
+    const uint64_t* rhs_words = rhs.words.data();
+    if (rhs.type != ContainerType::kBitmap) {
+      filled_rhs_words.assign(kBitmapWords, 0);
+      rhs.FillWords(filled_rhs_words.data());
+      rhs_words = filled_rhs_words.data();
+    }
+    if (operation == SetOperation::kIntersection) {
+      for (size_t i = 0; i < kBitmapWords; ++i)
+        words[i] &= rhs_words[i];
+    } else {
+      for (size_t i = 0; i < kBitmapWords; ++i)
+        words[i] &= ~rhs_words[i];
+    }
+  }
+  result.cardinality = CountBits(words);
+  result.Normalize();
+  return result;
+}
+
+size_t RoaringBitmap::FindContainer(uint16_t key) const {
+  auto it = std::lower_bound(keys_.begin(), keys_.end(), key);
+  if (it == keys_.end() || *it != key)
+    return keys_.size();
+  return static_cast<size_t>(it - keys_.begin());
+}
+
+// RoaringBitmapView -----------------------------------------------------------
+
+// static
+absl::optional<RoaringBitmapView> RoaringBitmapView::Create(
+    span<const uint8_t> data) {
+  if (reinterpret_cast<uintptr_t>(data.data()) % kPayloadAlignment ||
+      data.size() < sizeof(Header)) {
+    return absl::nullopt;
+  }
+  const auto* header = reinterpret_cast<const Header*>(data.data());
+  if (header->magic != kMagic ||
+      header->container_count > kContainerBits ||
+      (data.size() - sizeof(Header)) / sizeof(Descriptor) <
+          header->container_count) {
+    return absl::nullopt;
+  }
+
+  const auto* descriptors =
+      reinterpret_cast<const Descriptor*>(data.data() + sizeof(Header));
+  for (uint32_t i = 0; i < header->container_count; ++i) {
+    const Descriptor& descriptor = descriptors[i];
+    if (i > 0 && descriptor.key <= descriptors[i - 1].key)
+      return absl::nullopt;
+    if (descriptor.reserved || !descriptor.cardinality ||
+        descriptor.cardinality > kContainerBits ||
+        descriptor.offset % kPayloadAlignment) {
+      return absl::nullopt;
+    }
+
+    size_t element_size = 0;
+    switch (static_cast<RoaringBitmap::ContainerType>(descriptor.type)) {
+      case RoaringBitmap::ContainerType::kArray:
+        element_size = sizeof(uint16_t);
+        break;
+      case RoaringBitmap::ContainerType::kBitmap:
+        element_size = sizeof(uint64_t);
+        break;
+      case RoaringBitmap::ContainerType::kRun:
+        element_size = sizeof(RoaringBitmap::Run);
+        break;
+      default:
+        return absl::nullopt;
+    }
+    if (descriptor.offset > data.size() ||
+        (data.size() - descriptor.offset) / element_size < descriptor.size) {
+      return absl::nullopt;
+    }
+    const uint8_t* payload = data.data() + descriptor.offset;
+
+    // Checks that the containers are in the form which RoaringBitmap keeps
+    // them in, so that the bitmaps compare equal.
+    switch (static_cast<RoaringBitmap::ContainerType>(descriptor.type)) {
+      case RoaringBitmap::ContainerType::kArray: {
+        const auto* values = reinterpret_cast<const uint16_t*>(payload);
+        if (descriptor.size != descriptor.cardinality ||
+            descriptor.cardinality > kMaxArraySize) {
+          return absl::nullopt;
+        }
+        for (uint32_t j = 1; j < descriptor.size; ++j) {
+          if (values[j] <= values[j - 1])
+            return absl::nullopt;
+        }
+        break;
+      }
+      case RoaringBitmap::ContainerType::kBitmap: {
+        const auto* words = reinterpret_cast<const uint64_t*>(payload);
+        if (descriptor.size != kBitmapWords ||
+            descriptor.cardinality <= kMaxArraySize ||
+            CountBits(words) != descriptor.cardinality) {
+          return absl::nullopt;
+        }
+        break;
+      }
+      case RoaringBitmap::ContainerType::kRun: {
+        const auto* runs =
+            reinterpret_cast<const RoaringBitmap::Run*>(payload);
+        uint32_t cardinality = 0;
+        for (uint32_t j = 0; j < descriptor.size; ++j) {
+          const uint32_t end = uint32_t{runs[j].start} + runs[j].length;
+          // The runs are sorted, and separated by at least one value.
+          if (end >= kContainerBits ||
+              (j > 0 && runs[j].start <=
+                            uint32_t{runs[j - 1].start} + runs[j - 1].length +
+                                1)) {
+            return absl::nullopt;
+          }
+          cardinality += uint32_t{runs[j].length} + 1;
+        }
+        if (cardinality != descriptor.cardinality)
+          return absl::nullopt;
+        break;
+      }
+    }
+  }
+  return RoaringBitmapView(data);
+}
+
+RoaringBitmapView::RoaringBitmapView(span<const uint8_t> data) : data_(data) {}
+
+RoaringBitmapView::RoaringBitmapView(const RoaringBitmapView&) = default;
+
+RoaringBitmapView& RoaringBitmapView::operator=(const RoaringBitmapView&) =
+    default;
+
+RoaringBitmapView::~RoaringBitmapView() = default;
+
+size_t RoaringBitmapView::Cardinality() const {
+  const auto* header = reinterpret_cast<const Header*>(data_.data());
+  const auto* descriptors =
+      reinterpret_cast<const Descriptor*>(data_.data() + sizeof(Header));
+  size_t cardinality = 0;
+  for (uint32_t i = 0; i < header->container_count; ++i)
+    cardinality += descriptors[i].cardinality;
+  return cardinality;
+}
+
+bool RoaringBitmapView::Contains(uint32_t value) const {
+  const auto* header = reinterpret_cast<const Header*>(data_.data());
+  const auto* descriptors =
+      reinterpret_cast<const Descriptor*>(data_.data() + sizeof(Header));
+  const uint16_t key = static_cast<uint16_t>(value >> 16);
+  const uint16_t low = static_cast<uint16_t>(value);
+  const Descriptor* end = descriptors + header->container_count;
+  const Descriptor* descriptor = std::lower_bound(
+      descriptors, end, key, [](const Descriptor& descriptor, uint16_t key) {
+        return descriptor.key < key;
+      });
+  if (descriptor == end || descriptor->key != key)
+    return false;
+
+  const uint8_t* payload = data_.data() + descriptor->offset;
+  switch (static_cast<RoaringBitmap::ContainerType>(descriptor->type)) {
+    case RoaringBitmap::ContainerType::kArray: {
+      const auto* values = reinterpret_cast<const uint16_t*>(payload);
+      return std::binary_search(values, values + descriptor->size, low);
+    }
+    case RoaringBitmap::ContainerType::kBitmap:
+      return BitmapContains(reinterpret_cast<const uint64_t*>(payload), low);
+    case RoaringBitmap::ContainerType::kRun:
+      return RunsContain(reinterpret_cast<const RoaringBitmap::Run*>(payload),
+                         descriptor->size, low);
+  }
+  NOTREACHED();
+  return false;
+}
+
+RoaringBitmap RoaringBitmapView::ToBitmap() const {
+  const auto* header = reinterpret_cast<const Header*>(data_.data());
+  const auto* descriptors =
+      reinterpret_cast<const Descriptor*>(data_.data() + sizeof(Header));
+  RoaringBitmap bitmap;
+  bitmap.keys_.reserve(header->container_count);
+  bitmap.containers_.resize(header->container_count);
+  for (uint32_t i = 0; i < header->container_count; ++i) {
+    const Descriptor& descriptor = descriptors[i];
+    RoaringBitmap::Container& container = bitmap.containers_[i];
+    bitmap.keys_.push_back(descriptor.key);
+    container.type =
+        static_cast<RoaringBitmap::ContainerType>(descriptor.type);
+    container.cardinality = descriptor.cardinality;
+    const uint8_t* payload = data_.data() + descriptor.offset;
+    switch (container.type) {
+      case RoaringBitmap::ContainerType::kArray: {
+        const auto* values = reinterpret_cast<const uint16_t*>(payload);
+        container.array.assign(values, values + descriptor.size);
+        break;
+      }
+      case RoaringBitmap::ContainerType::kBitmap: {
+        const auto* words = reinterpret_cast<const uint64_t*>(payload);
+        container.words.assign(words, words + descriptor.size);
+        break;
+      }
+      case RoaringBitmap::ContainerType::kRun: {
+        const auto* runs =
+            reinterpret_cast<const RoaringBitmap::Run*>(payload);
+        container.runs.assign(runs, runs + descriptor.size);
+        break;
+      }
+    }
+  }
+  return bitmap;
+}
+
+}  // namespace base
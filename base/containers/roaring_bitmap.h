@@ -0,0 +1,256 @@
+// Copyright 2022 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#ifndef BASE_CONTAINERS_ROARING_BITMAP_H_
+#define BASE_CONTAINERS_ROARING_BITMAP_H_
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include <initializer_list>
+#include <iterator>
+#include <vector>
+
+#include "base/base_export.h"
+#include "base/containers/span.h"
+#include "third_party/abseil-cpp/absl/types/optional.h"
+
+namespace base {
+
+class RoaringBitmapView;
+
+// A compressed set of uint32_t values, after the Roaring bitmaps of Chambi,
+// Lemire et al., for large sets of IDs which would waste memory as a
+// flat_set<uint32_t>, or a std::vector<bool> over the whole universe.
+//
+// The values are split into chunks of 2^16 values by their 16 high bits, and
+// each non-empty chunk is stored in the smallest of three containers:
+//
+//   - An array: the sorted 16 low bits of up to 4096 values.
+//   - A bitmap: 2^16 bits, for the chunks of more than 4096 values.
+//   - Runs: the sorted ranges of consecutive values, which RunOptimize()
+//     converts the containers to when it's smaller than the above.
+//
+// The set operations work a container at a time, and on bitmaps a 64-bit word
+// at a time, in loops which the compilers vectorize.
+//
+//   base::RoaringBitmap active_users;
+//   for (uint32_t id : ids)
+//     active_users.Add(id);
+//   active_users &= paying_users;
+//   size_t count = active_users.Cardinality();
+//   for (uint32_t id : active_users)
+//     ...
+//
+// Serialize() writes an aligned format which RoaringBitmapView reads in place,
+// for instance from a MemoryMappedFile, without copying it.
+class BASE_EXPORT RoaringBitmap {
+ public:
+  class BASE_EXPORT const_iterator {
+   public:
+    using iterator_category = std::forward_iterator_tag;
+    using value_type = uint32_t;
+    using difference_type = ptrdiff_t;
+    using pointer = const uint32_t*;
+    using reference = const uint32_t&;
+
+    const_iterator();
+    const_iterator(const const_iterator&);
+    const_iterator& operator=(const const_iterator&);
+    ~const_iterator();
+
+    reference operator*() const { return value_; }
+    pointer operator->() const { return &value_; }
+
+    const_iterator& operator++();
+    const_iterator operator++(int);
+
+    friend bool operator==(const const_iterator& lhs,
+                           const const_iterator& rhs) {
+      return lhs.container_ == rhs.container_ && lhs.index_ == rhs.index_ &&
+             lhs.offset_ == rhs.offset_;
+    }
+    friend bool operator!=(const const_iterator& lhs,
+                           const const_iterator& rhs) {
+      return !(lhs == rhs);
+    }
+
+   private:
+    friend class RoaringBitmap;
+
+    // Points at the first value of the container |container|, or at the end.
+    const_iterator(const RoaringBitmap* bitmap, size_t container);
+
+    // Moves to the first value of the next container, or to the end.
+    void NextContainer();
+    void UpdateValue();
+
+    const RoaringBitmap* bitmap_ = nullptr;
+    size_t container_ = 0;
+    // The position in the container: the index of the value in an array, of
+    // the bit in a bitmap, or of the run in runs, with the offset in the run.
+    uint32_t index_ = 0;
+    uint32_t offset_ = 0;
+    uint32_t value_ = 0;
+  };
+
+  using value_type = uint32_t;
+  using iterator = const_iterator;
+
+  RoaringBitmap();
+  RoaringBitmap(std::initializer_list<uint32_t> values);
+  RoaringBitmap(const RoaringBitmap&);
+  RoaringBitmap(RoaringBitmap&&) noexcept;
+  RoaringBitmap& operator=(const RoaringBitmap&);
+  RoaringBitmap& operator=(RoaringBitmap&&) noexcept;
+  ~RoaringBitmap();
+
+  // Returns the bitmap which Serialize() wrote to |data|, or nullopt if |data|
+  // isn't a valid serialized bitmap.
+  static absl::optional<RoaringBitmap> Deserialize(span<const uint8_t> data);
+
+  bool empty() const { return keys_.empty(); }
+
+  // Returns the number of values, in O(number of chunks).
+  size_t Cardinality() const;
+
+  bool Contains(uint32_t value) const;
+
+  // Adds or removes |value|, and returns whether the set changed. Converts
+  // the runs of the chunk of |value| back to an array or a bitmap.
+  bool Add(uint32_t value);
+  bool Remove(uint32_t value);
+
+  void Clear();
+
+  // Converts the containers which are smaller as runs to runs, and the run
+  // containers which are no longer smaller as runs back. Call it after the
+  // bulk insertions of ranges of values.
+  void RunOptimize();
+
+  // Returns the approximate number of bytes of memory which the bitmap uses.
+  size_t EstimateMemoryUsage() const;
+
+  RoaringBitmap& operator|=(const RoaringBitmap& other);
+  RoaringBitmap& operator&=(const RoaringBitmap& other);
+  RoaringBitmap& operator-=(const RoaringBitmap& other);
+
+  friend RoaringBitmap operator|(RoaringBitmap lhs, const RoaringBitmap& rhs) {
+    return lhs |= rhs;
+  }
+  friend RoaringBitmap operator&(RoaringBitmap lhs, const RoaringBitmap& rhs) {
+    return lhs &= rhs;
+  }
+  friend RoaringBitmap operator-(RoaringBitmap lhs, const RoaringBitmap& rhs) {
+    return lhs -= rhs;
+  }
+
+  // Whether the sets are equal, whatever their containers.
+  friend BASE_EXPORT bool operator==(const RoaringBitmap& lhs,
+                                     const RoaringBitmap& rhs);
+  friend bool operator!=(const RoaringBitmap& lhs, const RoaringBitmap& rhs) {
+    return !(lhs == rhs);
+  }
+
+  // Returns the serialization of the bitmap, which Deserialize() and
+  // RoaringBitmapView read, in the byte order of the host.
+  std::vector<uint8_t> Serialize() const;
+
+  const_iterator begin() const { return const_iterator(this, 0); }
+  const_iterator end() const { return const_iterator(this, keys_.size()); }
+
+ private:
+  friend class RoaringBitmapView;
+
+  enum class ContainerType : uint8_t {
+    kArray = 1,
+    kBitmap = 2,
+    kRun = 3,
+  };
+
+  // The values start to start + length, both included.
+  struct Run {
+    uint16_t start;
+    uint16_t length;
+  };
+
+  struct Container {
+    Container();
+    Container(const Container&);
+    Container(Container&&) noexcept;
+    Container& operator=(const Container&);
+    Container& operator=(Container&&) noexcept;
+    ~Container();
+
+    bool Contains(uint16_t low) const;
+    bool Add(uint16_t low);
+    bool Remove(uint16_t low);
+
+    // Sets the bits of the values in |words|, of kBitmapWords words.
+    void FillWords(uint64_t* words) const;
+    // Converts runs to an array or a bitmap, whichever is smaller.
+    void Decompress();
+    // Converts an array or a bitmap to the other one if it's smaller.
+    void Normalize();
+    void RunOptimize();
+
+    size_t EstimateMemoryUsage() const;
+
+    ContainerType type = ContainerType::kArray;
+    uint32_t cardinality = 0;
+    std::vector<uint16_t> array;
+    std::vector<uint64_t> words;
+    std::vector<Run> runs;
+  };
+
+  enum class SetOperation { kUnion, kIntersection, kDifference };
+
+  static Container Combine(const Container& lhs,
+                           const Container& rhs,
+                           SetOperation operation);
+
+  // Returns the index of the container of |key|, or keys_.size().
+  size_t FindContainer(uint16_t key) const;
+
+  // The 16 high bits of the values of each container, in increasing order.
+  std::vector<uint16_t> keys_;
+  std::vector<Container> containers_;
+};
+
+// A read-only view of a bitmap serialized by RoaringBitmap::Serialize(),
+// which reads the containers in place. The data must be aligned to 8 bytes,
+// as the data of a MemoryMappedFile are, and outlive the view.
+//
+//   base::MemoryMappedFile file;
+//   CHECK(file.Initialize(path));
+//   absl::optional<base::RoaringBitmapView> ids =
+//       base::RoaringBitmapView::Create(
+//           base::make_span(file.data(), file.length()));
+//   if (ids && ids->Contains(id))
+//     ...
+class BASE_EXPORT RoaringBitmapView {
+ public:
+  // Returns a view of |data|, or nullopt if |data| is misaligned or isn't a
+  // valid serialized bitmap. Validates all of |data|, in O(size of |data|).
+  static absl::optional<RoaringBitmapView> Create(span<const uint8_t> data);
+
+  RoaringBitmapView(const RoaringBitmapView&);
+  RoaringBitmapView& operator=(const RoaringBitmapView&);
+  ~RoaringBitmapView();
+
+  size_t Cardinality() const;
+  bool Contains(uint32_t value) const;
+
+  // Returns a copy of the bitmap.
+  RoaringBitmap ToBitmap() const;
+
+ private:
+  explicit RoaringBitmapView(span<const uint8_t> data);
+
+  span<const uint8_t> data_;
+};
+
+}  // namespace base
+
+#endif  // BASE_CONTAINERS_ROARING_BITMAP_H_
@@ -0,0 +1,113 @@
+// Copyright 2022 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "base/containers/roaring_bitmap.h"
+
+#include <stdint.h>
+
+#include <algorithm>
+#include <iterator>
+#include <string>
+#include <vector>
+
+#include "base/containers/flat_set.h"
+#include "base/rand_util.h"
+#include "base/time/time.h"
+#include "base/timer/lap_timer.h"
+#include "testing/gtest/include/gtest/gtest.h"
+#include "testing/perf/perf_result_reporter.h"
+
+namespace base {
+namespace {
+
+constexpr int kWarmupRuns = 1;
+constexpr TimeDelta kTimeLimit = Seconds(1);
+constexpr int kTimeCheckInterval = 1;
+constexpr size_t kSize = 1 << 18;
+// The values are spread over this many times kSize, so that the chunks are
+// dense enough for bitmaps.
+constexpr uint32_t kSpread = 4;
+
+constexpr char kMetricPrefixRoaringBitmap[] = "RoaringBitmap.";
+constexpr char kMetricIntersectThroughput[] = "intersect_throughput";
+constexpr char kMetricUnionThroughput[] = "union_throughput";
+constexpr char kMetricMemoryUsage[] = "memory_usage";
+
+perf_test::PerfResultReporter SetUpReporter(const std::string& story_name) {
+  perf_test::PerfResultReporter reporter(kMetricPrefixRoaringBitmap,
+                                         story_name);
+  reporter.RegisterImportantMetric(kMetricIntersectThroughput, "runs/s");
+  reporter.RegisterImportantMetric(kMetricUnionThroughput, "runs/s");
+  reporter.RegisterImportantMetric(kMetricMemoryUsage, "bytes");
+  return reporter;
+}
+
+std::vector<uint32_t> RandomValues() {
+  std::vector<uint32_t> values;
+  values.reserve(kSize);
+  for (size_t i = 0; i < kSize; ++i)
+    values.push_back(static_cast<uint32_t>(RandInt(0, kSize * kSpread - 1)));
+  return values;
+}
+
+template <typename Set, typename Operation>
+double MeasureThroughput(const Set& lhs, const Set& rhs, Operation operation) {
+  LapTimer timer(kWarmupRuns, kTimeLimit, kTimeCheckInterval);
+  do {
+    Set result = operation(lhs, rhs);
+    EXPECT_FALSE(result.empty());
+    timer.NextLap();
+  } while (!timer.HasTimeLimitExpired());
+  return timer.LapsPerSecond();
+}
+
+}  // namespace
+
+TEST(RoaringBitmapPerfTest, FlatSet) {
+  const flat_set<uint32_t> lhs(RandomValues());
+  const flat_set<uint32_t> rhs(RandomValues());
+  auto reporter = SetUpReporter("flat_set");
+  reporter.AddResult(
+      kMetricIntersectThroughput,
+      MeasureThroughput(lhs, rhs, [](const auto& lhs, const auto& rhs) {
+        flat_set<uint32_t> result;
+        std::set_intersection(lhs.begin(), lhs.end(), rhs.begin(), rhs.end(),
+                              std::inserter(result, result.end()));
+        return result;
+      }));
+  reporter.AddResult(
+      kMetricUnionThroughput,
+      MeasureThroughput(lhs, rhs, [](const auto& lhs, const auto& rhs) {
+        std::vector<uint32_t> values;
+        values.reserve(lhs.size() + rhs.size());
+        std::set_union(lhs.begin(), lhs.end(), rhs.begin(), rhs.end(),
+                       std::back_inserter(values));
+        return flat_set<uint32_t>(sorted_unique, std::move(values));
+      }));
+  reporter.AddResult(kMetricMemoryUsage,
+                     static_cast<size_t>(lhs.capacity() * sizeof(uint32_t)));
+}
+
+TEST(RoaringBitmapPerfTest, RoaringBitmap) {
+  RoaringBitmap lhs;
+  RoaringBitmap rhs;
+  for (uint32_t value : RandomValues())
+    lhs.Add(value);
+  for (uint32_t value : RandomValues())
+    rhs.Add(value);
+  auto reporter = SetUpReporter("roaring_bitmap");
+  reporter.AddResult(
+      kMetricIntersectThroughput,
+      MeasureThroughput(lhs, rhs, [](const auto& lhs, const auto& rhs) {
+        return lhs & rhs;
+      }));
+  reporter.AddResult(
+      kMetricUnionThroughput,
+      MeasureThroughput(lhs, rhs, [](const auto& lhs, const auto& rhs) {
+        return lhs | rhs;
+      }));
+  reporter.AddResult(kMetricMemoryUsage, lhs.EstimateMemoryUsage());
+}
+
+}  // namespace base
@@ -0,0 +1,274 @@
+// Copyright 2022 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "base/containers/roaring_bitmap.h"
+
+#include <stdint.h>
+#include <string.h>
+
+#include <algorithm>
+#include <iterator>
+#include <set>
+#include <vector>
+
+#include "base/rand_util.h"
+#include "testing/gmock/include/gmock/gmock.h"
+#include "testing/gtest/include/gtest/gtest.h"
+
+using ::testing::ElementsAre;
+
+namespace base {
+
+namespace {
+
+std::vector<uint32_t> ToVector(const RoaringBitmap& bitmap) {
+  return std::vector<uint32_t>(bitmap.begin(), bitmap.end());
+}
+
+std::vector<uint32_t> ToVector(const std::set<uint32_t>& set) {
+  return std::vector<uint32_t>(set.begin(), set.end());
+}
+
+// Returns random values in a few chunks, with the density of the chunks
+// varying from arrays to bitmaps.
+std::set<uint32_t> RandomValues(size_t count) {
+  std::set<uint32_t> values;
+  while (values.size() < count) {
+    const uint32_t key = static_cast<uint32_t>(RandInt(0, 3));
+    const int max_low = (1 << 16) >> RandInt(0, 4);
+    values.insert(key << 16 | static_cast<uint32_t>(RandInt(0, max_low - 1)));
+  }
+  return values;
+}
+
+RoaringBitmap ToBitmap(const std::set<uint32_t>& values) {
+  RoaringBitmap bitmap;
+  for (uint32_t value : values)
+    bitmap.Add(value);
+  return bitmap;
+}
+
+}  // namespace
+
+TEST(RoaringBitmap, AddRemoveContains) {
+  RoaringBitmap bitmap;
+  EXPECT_TRUE(bitmap.empty());
+  EXPECT_FALSE(bitmap.Contains(0));
+
+  EXPECT_TRUE(bitmap.Add(3));
+  EXPECT_TRUE(bitmap.Add(0xffffffff));
+  EXPECT_TRUE(bitmap.Add(1 << 16));
+  EXPECT_FALSE(bitmap.Add(3));
+  EXPECT_EQ(3u, bitmap.Cardinality());
+  EXPECT_TRUE(bitmap.Contains(3));
+  EXPECT_TRUE(bitmap.Contains(0xffffffff));
+  EXPECT_TRUE(bitmap.Contains(1 << 16));
+  EXPECT_FALSE(bitmap.Contains(4));
+  EXPECT_FALSE(bitmap.Contains(3 + (1 << 16)));
+  EXPECT_THAT(ToVector(bitmap), ElementsAre(3, 1 << 16, 0xffffffff));
+
+  EXPECT_TRUE(bitmap.Remove(3));
+  EXPECT_FALSE(bitmap.Remove(3));
+  EXPECT_FALSE(bitmap.Remove(4));
+  EXPECT_THAT(ToVector(bitmap), ElementsAre(1 << 16, 0xffffffff));
+
+  bitmap.Clear();
+  EXPECT_TRUE(bitmap.empty());
+  EXPECT_EQ(bitmap.begin(), bitmap.end());
+}
+
+TEST(RoaringBitmap, ArrayToBitmap) {
+  RoaringBitmap bitmap;
+  // Every other value, so that a chunk needs a bitmap past 4096 values.
+  for (uint32_t i = 0; i < 2 * 5000; i += 2)
+    EXPECT_TRUE(bitmap.Add(i));
+  EXPECT_EQ(5000u, bitmap.Cardinality());
+  const size_t bitmap_usage = bitmap.EstimateMemoryUsage();
+  EXPECT_GE(bitmap_usage, 8192u);
+  EXPECT_LT(bitmap_usage, 2 * 8192u);
+  for (uint32_t i = 0; i < 2 * 5000; ++i)
+    EXPECT_EQ(i % 2 == 0, bitmap.Contains(i));
+
+  // Back to an array.
+  for (uint32_t i = 0; i < 2 * 2000; i += 2)
+    EXPECT_TRUE(bitmap.Remove(i));
+  EXPECT_EQ(3000u, bitmap.Cardinality());
+  std::vector<uint32_t> values = ToVector(bitmap);
+  ASSERT_EQ(3000u, values.size());
+  EXPECT_EQ(4000u, values.front());
+  EXPECT_EQ(9998u, values.back());
+}
+
+TEST(RoaringBitmap, RunOptimize) {
+  RoaringBitmap bitmap;
+  for (uint32_t i = 100; i < 60000; ++i)
+    bitmap.Add(i);
+  bitmap.Add(70000);
+  const RoaringBitmap copy = bitmap;
+  const size_t usage = bitmap.EstimateMemoryUsage();
+
+  bitmap.RunOptimize();
+  EXPECT_LT(bitmap.EstimateMemoryUsage(), usage / 10);
+  EXPECT_EQ(copy, bitmap);
+  EXPECT_EQ(ToVector(copy), ToVector(bitmap));
+  EXPECT_TRUE(bitmap.Contains(100));
+  EXPECT_TRUE(bitmap.Contains(59999));
+  EXPECT_FALSE(bitmap.Contains(99));
+  EXPECT_FALSE(bitmap.Contains(60000));
+
+  // Changes convert the runs back.
+  EXPECT_TRUE(bitmap.Remove(1000));
+  EXPECT_FALSE(bitmap.Contains(1000));
+  EXPECT_TRUE(bitmap.Contains(1001));
+  EXPECT_EQ(copy.Cardinality() - 1, bitmap.Cardinality());
+  EXPECT_GT(bitmap.EstimateMemoryUsage(), usage / 10);
+  EXPECT_TRUE(bitmap.Add(1000));
+  EXPECT_EQ(copy, bitmap);
+
+  // Scattered values stay uncompressed.
+  RoaringBitmap sparse = {1, 3, 5, 7};
+  const size_t sparse_usage = sparse.EstimateMemoryUsage();
+  sparse.RunOptimize();
+  EXPECT_EQ(sparse_usage, sparse.EstimateMemoryUsage());
+}
+
+TEST(RoaringBitmap, SetOperations) {
+  RoaringBitmap a = {1, 2, 3, 1 << 16};
+  RoaringBitmap b = {2, 3, 4, 2 << 16};
+  EXPECT_THAT(ToVector(a | b), ElementsAre(1, 2, 3, 4, 1 << 16, 2 << 16));
+  EXPECT_THAT(ToVector(a & b), ElementsAre(2, 3));
+  EXPECT_THAT(ToVector(a - b), ElementsAre(1, 1 << 16));
+  EXPECT_THAT(ToVector(b - a), ElementsAre(4, 2 << 16));
+
+  RoaringBitmap c = a;
+  c |= c;
+  EXPECT_EQ(a, c);
+  c &= c;
+  EXPECT_EQ(a, c);
+  c -= c;
+  EXPECT_TRUE(c.empty());
+}
+
+TEST(RoaringBitmap, SameAsSet) {
+  for (int i = 0; i < 20; ++i) {
+    const std::set<uint32_t> lhs = RandomValues(RandInt(0, 20000));
+    const std::set<uint32_t> rhs = RandomValues(RandInt(0, 20000));
+    RoaringBitmap lhs_bitmap = ToBitmap(lhs);
+    RoaringBitmap rhs_bitmap = ToBitmap(rhs);
+    ASSERT_EQ(lhs.size(), lhs_bitmap.Cardinality());
+    ASSERT_EQ(ToVector(lhs), ToVector(lhs_bitmap));
+    // Mixes run containers in.
+    if (i % 2)
+      lhs_bitmap.RunOptimize();
+
+    std::set<uint32_t> expected;
+    std::set_union(lhs.begin(), lhs.end(), rhs.begin(), rhs.end(),
+                   std::inserter(expected, expected.end()));
+    EXPECT_EQ(ToVector(expected), ToVector(lhs_bitmap | rhs_bitmap));
+    EXPECT_EQ(ToBitmap(expected), lhs_bitmap | rhs_bitmap);
+    EXPECT_EQ(ToVector(expected), ToVector(rhs_bitmap | lhs_bitmap));
+
+    expected.clear();
+    std::set_intersection(lhs.begin(), lhs.end(), rhs.begin(), rhs.end(),
+                          std::inserter(expected, expected.end()));
+    EXPECT_EQ(ToVector(expected), ToVector(lhs_bitmap & rhs_bitmap));
+    EXPECT_EQ(ToVector(expected), ToVector(rhs_bitmap & lhs_bitmap));
+
+    expected.clear();
+    std::set_difference(lhs.begin(), lhs.end(), rhs.begin(), rhs.end(),
+                        std::inserter(expected, expected.end()));
+    EXPECT_EQ(ToVector(expected), ToVector(lhs_bitmap - rhs_bitmap));
+    EXPECT_EQ(expected.size(), (lhs_bitmap - rhs_bitmap).Cardinality());
+  }
+}
+
+TEST(RoaringBitmap, RangesCompatible) {
+  const RoaringBitmap bitmap = {5, 1, 1 << 20};
+  std::vector<uint32_t> values;
+  std::copy(bitmap.begin(), bitmap.end(), std::back_inserter(values));
+  EXPECT_THAT(values, ElementsAre(1, 5, 1 << 20));
+  EXPECT_EQ(3, std::distance(bitmap.begin(), bitmap.end()));
+  EXPECT_NE(bitmap.end(), std::find(bitmap.begin(), bitmap.end(), 5u));
+}
+
+TEST(RoaringBitmap, Serialize) {
+  std::set<uint32_t> values = RandomValues(30000);
+  for (uint32_t i = 0; i < 10000; ++i)
+    values.insert((7 << 16) + i);
+  RoaringBitmap bitmap = ToBitmap(values);
+  bitmap.RunOptimize();
+
+  const std::vector<uint8_t> data = bitmap.Serialize();
+  absl::optional<RoaringBitmap> deserialized = RoaringBitmap::Deserialize(data);
+  ASSERT_TRUE(deserialized);
+  EXPECT_EQ(bitmap, *deserialized);
+
+  absl::optional<RoaringBitmapView> view = RoaringBitmapView::Create(data);
+  ASSERT_TRUE(view);
+  EXPECT_EQ(values.size(), view->Cardinality());
+  for (uint32_t value : values)
+    ASSERT_TRUE(view->Contains(value));
+  for (int i = 0; i < 1000; ++i) {
+    const uint32_t value = static_cast<uint32_t>(RandInt(0, 1 << 20));
+    EXPECT_EQ(values.count(value) == 1, view->Contains(value));
+  }
+  EXPECT_EQ(bitmap, view->ToBitmap());
+
+  const std::vector<uint8_t> empty_data = RoaringBitmap().Serialize();
+  deserialized = RoaringBitmap::Deserialize(empty_data);
+  ASSERT_TRUE(deserialized);
+  EXPECT_TRUE(deserialized->empty());
+}
+
+TEST(RoaringBitmap, DeserializeMisaligned) {
+  const RoaringBitmap bitmap = {1, 2, 3, 100000};
+  const std::vector<uint8_t> data = bitmap.Serialize();
+  std::vector<uint64_t> buffer(data.size() / sizeof(uint64_t) + 2);
+  uint8_t* misaligned = reinterpret_cast<uint8_t*>(buffer.data()) + 1;
+  memcpy(misaligned, data.data(), data.size());
+  const span<const uint8_t> misaligned_data(misaligned, data.size());
+
+  // The view needs aligned data, but Deserialize() copies it.
+  EXPECT_FALSE(RoaringBitmapView::Create(misaligned_data));
+  absl::optional<RoaringBitmap> deserialized =
+      RoaringBitmap::Deserialize(misaligned_data);
+  ASSERT_TRUE(deserialized);
+  EXPECT_EQ(bitmap, *deserialized);
+}
+
+TEST(RoaringBitmap, DeserializeInvalid) {
+  RoaringBitmap bitmap;
+  for (uint32_t i = 0; i < 5000; ++i)
+    bitmap.Add(i * 3);
+  bitmap.Add(1 << 16);
+  bitmap.Add((1 << 16) + 5);
+  const std::vector<uint8_t> data = bitmap.Serialize();
+  ASSERT_TRUE(RoaringBitmap::Deserialize(data));
+
+  // Truncations.
+  for (size_t size = 0; size < data.size(); size += 97) {
+    EXPECT_FALSE(
+        RoaringBitmap::Deserialize(make_span(data.data(), size)).has_value());
+  }
+
+  // Bytes flipped in the header, and in the key, type, reserved byte,
+  // cardinality, offset and size of the descriptors.
+  for (size_t offset : {0, 4, 8, 10, 11, 12, 16, 20, 26, 28, 32, 36}) {
+    std::vector<uint8_t> corrupted = data;
+    corrupted[offset] ^= 0x5a;
+    EXPECT_FALSE(RoaringBitmap::Deserialize(corrupted).has_value()) << offset;
+  }
+
+  // A bit flipped in the bitmap, which no longer matches its cardinality.
+  std::vector<uint8_t> corrupted = data;
+  corrupted[40] ^= 1;
+  EXPECT_FALSE(RoaringBitmap::Deserialize(corrupted).has_value());
+
+  // An array which is no longer sorted.
+  corrupted = data;
+  corrupted[corrupted.size() - 2] = 0;
+  EXPECT_FALSE(RoaringBitmap::Deserialize(corrupted).has_value());
+}
+
+}  // namespace base
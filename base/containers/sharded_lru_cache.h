@@ -0,0 +1,262 @@
+// Copyright 2022 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#ifndef BASE_CONTAINERS_SHARDED_LRU_CACHE_H_
+#define BASE_CONTAINERS_SHARDED_LRU_CACHE_H_
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include <atomic>
+#include <memory>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "base/check_op.h"
+#include "base/containers/flat_hash_map.h"
+#include "base/containers/span.h"
+#include "base/hash/hash.h"
+#include "base/metrics/histogram_functions.h"
+#include "base/synchronization/shared_lock.h"
+#include "base/thread_annotations.h"
+#include "third_party/abseil-cpp/absl/types/optional.h"
+
+namespace base {
+
+// A thread-safe cache of bounded size, for caches which are shared by many
+// threads. Where LRUCache (see lru_cache.h) must be guarded by a single lock,
+// and moves each item it finds to the front of its recency list, this cache is
+// split into shards, each guarded by its own SharedLock, and approximates LRU
+// with the CLOCK policy: a hit only sets the "referenced" bit of its item, if
+// it isn't set already, so that lookups take their shard's lock in shared mode
+// and don't write to the item. An insert into a full shard evicts the first
+// unreferenced item after the clock hand, clearing the bits of the referenced
+// items it passes, which thus get a second chance.
+//
+// The shard of a key is chosen by FastHash() of its hash, so that it's
+// independent of the bits which the hash table of the shard probes on.
+//
+// If |histogram_name| is set, the cache counts the hits and the misses, and
+// ReportHitRate() records the hit rate since the previous report to the
+// "<histogram_name>.HitRate" percentage histogram. The counters of a shard
+// are written on each lookup, so leave it unset when the hit rate isn't
+// needed.
+//
+//   base::ShardedLRUCache<std::string, Metadata> cache(100000);
+//   cache.Put(path, metadata);
+//   absl::optional<Metadata> cached = cache.Get(path);  // A copy.
+//
+// Get() returns a copy of the payload, since the item may be evicted by
+// another thread once the shard is unlocked: store large payloads by
+// scoped_refptr, or std::shared_ptr.
+template <class KeyType,
+          class PayloadType,
+          class HashType = absl::Hash<KeyType>>
+class ShardedLRUCache {
+ public:
+  using value_type = std::pair<KeyType, PayloadType>;
+  using size_type = size_t;
+
+  static constexpr size_t kDefaultShardCount = 32;
+
+  // Holds up to |max_size| items, divided between |shard_count| shards, each
+  // holding up to |max_size| / |shard_count| items, rounded up.
+  explicit ShardedLRUCache(size_type max_size,
+                           size_t shard_count = kDefaultShardCount,
+                           std::string histogram_name = std::string())
+      : shard_capacity_((max_size + shard_count - 1) / shard_count),
+        shards_(shard_count),
+        histogram_name_(std::move(histogram_name)) {
+    DCHECK_GT(max_size, 0u);
+    DCHECK_GT(shard_count, 0u);
+    for (Shard& shard : shards_)
+      shard.Init(shard_capacity_);
+  }
+
+  ShardedLRUCache(const ShardedLRUCache&) = delete;
+  ShardedLRUCache& operator=(const ShardedLRUCache&) = delete;
+
+  ~ShardedLRUCache() = default;
+
+  size_type max_size() const { return shard_capacity_ * shards_.size(); }
+  size_t shard_count() const { return shards_.size(); }
+
+  // Inserts a payload item with the given key, replacing the payload of the
+  // existing item, if any. Evicts an item of the shard if it's full.
+  void Put(const KeyType& key, PayloadType payload) {
+    const size_t hash = HashType()(key);
+    Shard& shard = GetShard(hash);
+    AutoExclusiveLock auto_lock(shard.lock);
+    shard.Put(key, std::move(payload), shard_capacity_);
+  }
+
+  // Returns a copy of the payload of the given key, or nullopt if it's not in
+  // the cache, marking the item as referenced.
+  absl::optional<PayloadType> Get(const KeyType& key) {
+    const size_t hash = HashType()(key);
+    Shard& shard = GetShard(hash);
+    absl::optional<PayloadType> payload;
+    {
+      AutoSharedLock auto_lock(shard.lock);
+      payload = shard.Get(key);
+    }
+    if (!histogram_name_.empty()) {
+      (payload ? shard.hits : shard.misses)
+          .fetch_add(1, std::memory_order_relaxed);
+    }
+    return payload;
+  }
+
+  // Returns whether the given key is in the cache, without marking its item as
+  // referenced.
+  bool Contains(const KeyType& key) const {
+    const Shard& shard = GetShard(HashType()(key));
+    AutoSharedLock auto_lock(shard.lock);
+    return shard.index.contains(key);
+  }
+
+  // Erases the item of the given key, if any. Returns whether there was one.
+  bool Erase(const KeyType& key) {
+    Shard& shard = GetShard(HashType()(key));
+    AutoExclusiveLock auto_lock(shard.lock);
+    return shard.Erase(key);
+  }
+
+  // Deletes everything from the cache.
+  void Clear() {
+    for (Shard& shard : shards_) {
+      AutoExclusiveLock auto_lock(shard.lock);
+      shard.index.clear();
+      shard.items.clear();
+      shard.hand = 0;
+    }
+  }
+
+  // Returns the number of items in the cache, which other threads may be
+  // changing.
+  size_type size() const {
+    size_type size = 0;
+    for (const Shard& shard : shards_) {
+      AutoSharedLock auto_lock(shard.lock);
+      size += shard.items.size();
+    }
+    return size;
+  }
+
+  // Records the hit rate of the lookups since the previous report, if there
+  // were any, to the "<histogram_name>.HitRate" histogram.
+  void ReportHitRate() {
+    DCHECK(!histogram_name_.empty());
+    uint64_t hits = 0;
+    uint64_t lookups = 0;
+    for (Shard& shard : shards_) {
+      const uint64_t shard_hits =
+          shard.hits.exchange(0, std::memory_order_relaxed);
+      hits += shard_hits;
+      lookups +=
+          shard_hits + shard.misses.exchange(0, std::memory_order_relaxed);
+    }
+    if (lookups) {
+      UmaHistogramPercentage(histogram_name_ + ".HitRate",
+                             static_cast<int>(hits * 100 / lookups));
+    }
+  }
+
+ private:
+  // The shards are aligned to cache lines, so that the threads using different
+  // shards don't contend for the lines of their locks and counters.
+  struct alignas(64) Shard {
+    void Init(size_t capacity) {
+      referenced = std::make_unique<std::atomic<bool>[]>(capacity);
+    }
+
+    void Put(const KeyType& key, PayloadType payload, size_t capacity)
+        EXCLUSIVE_LOCKS_REQUIRED(lock) {
+      auto it = index.find(key);
+      if (it != index.end()) {
+        items[it->second].second = std::move(payload);
+        referenced[it->second].store(true, std::memory_order_relaxed);
+        return;
+      }
+      if (items.size() < capacity) {
+        index.emplace(key, items.size());
+        referenced[items.size()].store(false, std::memory_order_relaxed);
+        items.emplace_back(key, std::move(payload));
+        return;
+      }
+      // Advances the hand to an unreferenced item, which terminates since the
+      // bits it passes are cleared, and replaces it.
+      while (referenced[hand].load(std::memory_order_relaxed)) {
+        referenced[hand].store(false, std::memory_order_relaxed);
+        hand = (hand + 1) % capacity;
+      }
+      index.erase(items[hand].first);
+      index.emplace(key, hand);
+      items[hand] = value_type(key, std::move(payload));
+      hand = (hand + 1) % capacity;
+    }
+
+    absl::optional<PayloadType> Get(const KeyType& key)
+        SHARED_LOCKS_REQUIRED(lock) {
+      auto it = index.find(key);
+      if (it == index.end())
+        return absl::nullopt;
+      // Avoids writing to the cache line of the bit when it's already set,
+      // which is the common case for a hot item.
+      std::atomic<bool>& bit = referenced[it->second];
+      if (!bit.load(std::memory_order_relaxed))
+        bit.store(true, std::memory_order_relaxed);
+      return items[it->second].second;
+    }
+
+    bool Erase(const KeyType& key) EXCLUSIVE_LOCKS_REQUIRED(lock) {
+      auto it = index.find(key);
+      if (it == index.end())
+        return false;
+      // Moves the last item into the place of the erased one.
+      const size_t erased = it->second;
+      const size_t last = items.size() - 1;
+      index.erase(it);
+      if (erased != last) {
+        index[items[last].first] = erased;
+        items[erased] = std::move(items[last]);
+        referenced[erased].store(
+            referenced[last].load(std::memory_order_relaxed),
+            std::memory_order_relaxed);
+      }
+      items.pop_back();
+      if (hand >= items.size())
+        hand = 0;
+      return true;
+    }
+
+    mutable SharedLock lock;
+    flat_hash_map<KeyType, size_t, HashType> index GUARDED_BY(lock);
+    std::vector<value_type> items GUARDED_BY(lock);
+    // The referenced bits of |items|, which are set under the lock in shared
+    // mode, and cleared under the lock in exclusive mode.
+    std::unique_ptr<std::atomic<bool>[]> referenced;
+    // The position of the CLOCK hand in |items|.
+    size_t hand GUARDED_BY(lock) = 0;
+
+    std::atomic<uint64_t> hits{0};
+    std::atomic<uint64_t> misses{0};
+  };
+
+  Shard& GetShard(size_t hash) {
+    return shards_[FastHash(as_bytes(make_span(&hash, 1u))) % shards_.size()];
+  }
+  const Shard& GetShard(size_t hash) const {
+    return shards_[FastHash(as_bytes(make_span(&hash, 1u))) % shards_.size()];
+  }
+
+  const size_t shard_capacity_;
+  std::vector<Shard> shards_;
+  const std::string histogram_name_;
+};
+
+}  // namespace base
+
+#endif  // BASE_CONTAINERS_SHARDED_LRU_CACHE_H_
@@ -0,0 +1,142 @@
+// Copyright 2022 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "base/containers/sharded_lru_cache.h"
+
+#include <atomic>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "base/containers/lru_cache.h"
+#include "base/memory/raw_ptr.h"
+#include "base/strings/string_number_conversions.h"
+#include "base/synchronization/lock.h"
+#include "base/thread_annotations.h"
+#include "base/threading/platform_thread.h"
+#include "base/time/time.h"
+#include "base/timer/lap_timer.h"
+#include "testing/gtest/include/gtest/gtest.h"
+#include "testing/perf/perf_result_reporter.h"
+
+namespace base {
+namespace {
+
+constexpr int kWarmupRuns = 1;
+constexpr TimeDelta kTimeLimit = Seconds(1);
+constexpr int kTimeCheckInterval = 10000;
+constexpr int kCacheSize = 100000;
+
+constexpr char kMetricPrefixShardedLRUCache[] = "ShardedLRUCache.";
+constexpr char kMetricLookupThroughput[] = "lookup_throughput";
+
+perf_test::PerfResultReporter SetUpReporter(const std::string& story_name) {
+  perf_test::PerfResultReporter reporter(kMetricPrefixShardedLRUCache,
+                                         story_name);
+  reporter.RegisterImportantMetric(kMetricLookupThroughput, "runs/s");
+  return reporter;
+}
+
+// A HashingLRUCache guarded by a Lock, as the shared caches are without
+// ShardedLRUCache.
+class LockedCache {
+ public:
+  explicit LockedCache(size_t max_size) : cache_(max_size) {}
+
+  void Put(int key, int payload) {
+    AutoLock auto_lock(lock_);
+    cache_.Put(key, payload);
+  }
+
+  bool Get(int key) {
+    AutoLock auto_lock(lock_);
+    return cache_.Get(key) != cache_.end();
+  }
+
+ private:
+  Lock lock_;
+  HashingLRUCache<int, int> cache_ GUARDED_BY(lock_);
+};
+
+class ShardedCache {
+ public:
+  explicit ShardedCache(size_t max_size) : cache_(max_size) {}
+
+  void Put(int key, int payload) { cache_.Put(key, payload); }
+  bool Get(int key) { return cache_.Get(key).has_value(); }
+
+ private:
+  ShardedLRUCache<int, int> cache_;
+};
+
+template <typename Cache>
+class LookupLoop : public PlatformThread::Delegate {
+ public:
+  LookupLoop(Cache* cache, int seed) : cache_(cache), key_(seed) {}
+  ~LookupLoop() override = default;
+
+  void ThreadMain() override {
+    while (!should_stop_.load(std::memory_order_relaxed)) {
+      cache_->Get(key_);
+      key_ = (key_ + 7919) % kCacheSize;
+    }
+  }
+
+  // Called from another thread to stop the loop.
+  void Stop() { should_stop_ = true; }
+
+ private:
+  raw_ptr<Cache> cache_;
+  int key_;
+  std::atomic<bool> should_stop_{false};
+};
+
+// Measures the lookup throughput of this thread while |num_threads| - 1 other
+// threads look up other items of the same cache.
+template <typename Cache>
+void RunLookupTest(const std::string& cache_name) {
+  for (int num_threads : {1, 2, 4, 8, 16, 32}) {
+    Cache cache(kCacheSize);
+    for (int i = 0; i < kCacheSize; ++i)
+      cache.Put(i, i);
+
+    std::vector<std::unique_ptr<LookupLoop<Cache>>> loops;
+    std::vector<PlatformThreadHandle> thread_handles(num_threads - 1);
+    for (size_t i = 0; i < thread_handles.size(); ++i) {
+      loops.push_back(std::make_unique<LookupLoop<Cache>>(
+          &cache, static_cast<int>(i + 1) * 1000));
+      ASSERT_TRUE(
+          PlatformThread::Create(0, loops.back().get(), &thread_handles[i]));
+    }
+
+    LapTimer timer(kWarmupRuns, kTimeLimit, kTimeCheckInterval);
+    int key = 0;
+    do {
+      EXPECT_TRUE(cache.Get(key));
+      key = (key + 7919) % kCacheSize;
+      timer.NextLap();
+    } while (!timer.HasTimeLimitExpired());
+
+    for (auto& loop : loops)
+      loop->Stop();
+    for (auto& thread_handle : thread_handles)
+      PlatformThread::Join(thread_handle);
+
+    auto reporter = SetUpReporter(cache_name + "_with_" +
+                                  NumberToString(num_threads) + "_threads");
+    reporter.AddResult(kMetricLookupThroughput, timer.LapsPerSecond());
+  }
+}
+
+}  // namespace
+
+TEST(ShardedLRUCachePerfTest, LockedHashingLRUCache) {
+  RunLookupTest<LockedCache>("locked_hashing_lru_cache");
+}
+
+TEST(ShardedLRUCachePerfTest, ShardedLRUCache) {
+  RunLookupTest<ShardedCache>("sharded_lru_cache");
+}
+
+}  // namespace base
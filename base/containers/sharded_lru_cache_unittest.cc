@@ -0,0 +1,159 @@
+// Copyright 2022 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "base/containers/sharded_lru_cache.h"
+
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "base/memory/raw_ptr.h"
+#include "base/strings/string_number_conversions.h"
+#include "base/test/metrics/histogram_tester.h"
+#include "base/threading/platform_thread.h"
+#include "testing/gtest/include/gtest/gtest.h"
+
+namespace base {
+
+TEST(ShardedLRUCacheTest, Basic) {
+  ShardedLRUCache<std::string, int> cache(100);
+  EXPECT_EQ(0u, cache.size());
+  EXPECT_FALSE(cache.Get("one"));
+
+  cache.Put("one", 1);
+  cache.Put("two", 2);
+  EXPECT_EQ(2u, cache.size());
+  EXPECT_EQ(1, cache.Get("one"));
+  EXPECT_TRUE(cache.Contains("two"));
+
+  cache.Put("one", 10);
+  EXPECT_EQ(2u, cache.size());
+  EXPECT_EQ(10, cache.Get("one"));
+
+  EXPECT_TRUE(cache.Erase("one"));
+  EXPECT_FALSE(cache.Erase("one"));
+  EXPECT_FALSE(cache.Get("one"));
+  EXPECT_EQ(2, cache.Get("two"));
+
+  cache.Clear();
+  EXPECT_EQ(0u, cache.size());
+  EXPECT_FALSE(cache.Contains("two"));
+}
+
+TEST(ShardedLRUCacheTest, ClockEviction) {
+  // A single shard, to control which items share it.
+  ShardedLRUCache<int, int> cache(4, 1);
+  EXPECT_EQ(4u, cache.max_size());
+  for (int i = 0; i < 4; ++i)
+    cache.Put(i, i);
+
+  // The referenced items get a second chance, and the unreferenced ones are
+  // evicted in the order of the clock.
+  EXPECT_TRUE(cache.Get(0));
+  EXPECT_TRUE(cache.Get(2));
+  cache.Put(4, 4);
+  EXPECT_FALSE(cache.Contains(1));
+  cache.Put(5, 5);
+  EXPECT_FALSE(cache.Contains(3));
+  EXPECT_TRUE(cache.Contains(0));
+  EXPECT_TRUE(cache.Contains(2));
+  EXPECT_EQ(4u, cache.size());
+
+  // The bits of 0 and 2 were cleared by the first pass of the hand.
+  cache.Put(6, 6);
+  EXPECT_FALSE(cache.Contains(0));
+  EXPECT_TRUE(cache.Contains(2));
+}
+
+TEST(ShardedLRUCacheTest, EraseKeepsOtherItems) {
+  ShardedLRUCache<int, int> cache(10, 1);
+  for (int i = 0; i < 10; ++i)
+    cache.Put(i, i);
+  for (int i = 0; i < 10; i += 2)
+    EXPECT_TRUE(cache.Erase(i));
+  for (int i = 0; i < 10; ++i)
+    EXPECT_EQ(i % 2 == 1, cache.Contains(i));
+  for (int i = 10; i < 15; ++i)
+    cache.Put(i, i);
+  EXPECT_EQ(10u, cache.size());
+  for (int i = 1; i < 15; i += 2)
+    EXPECT_TRUE(cache.Contains(i));
+}
+
+TEST(ShardedLRUCacheTest, BoundedSize) {
+  ShardedLRUCache<int, std::string> cache(100, 8);
+  EXPECT_EQ(104u, cache.max_size());
+  for (int i = 0; i < 1000; ++i)
+    cache.Put(i, NumberToString(i));
+  EXPECT_LE(cache.size(), cache.max_size());
+  // The last item of each shard was just inserted.
+  EXPECT_EQ("999", cache.Get(999));
+}
+
+TEST(ShardedLRUCacheTest, HitRate) {
+  HistogramTester histogram_tester;
+  ShardedLRUCache<int, int> cache(100, 4, "Test.Cache");
+  cache.Put(1, 1);
+  cache.Get(1);
+  cache.Get(1);
+  cache.Get(1);
+  cache.Get(2);
+  cache.ReportHitRate();
+  histogram_tester.ExpectUniqueSample("Test.Cache.HitRate", 75, 1);
+
+  // Only the lookups since the previous report count.
+  cache.Get(2);
+  cache.ReportHitRate();
+  histogram_tester.ExpectBucketCount("Test.Cache.HitRate", 0, 1);
+  cache.ReportHitRate();
+  histogram_tester.ExpectTotalCount("Test.Cache.HitRate", 2);
+}
+
+namespace {
+
+class CacheUser : public PlatformThread::Delegate {
+ public:
+  CacheUser(ShardedLRUCache<int, std::string>* cache, int seed)
+      : cache_(cache), seed_(seed) {}
+  ~CacheUser() override = default;
+
+  void ThreadMain() override {
+    for (int i = 0; i < 10000; ++i) {
+      const int key = (i * 7 + seed_) % 500;
+      if (i % 4 == 0) {
+        cache_->Put(key, NumberToString(key));
+      } else if (i % 97 == 0) {
+        cache_->Erase(key);
+      } else {
+        absl::optional<std::string> value = cache_->Get(key);
+        if (value) {
+          EXPECT_EQ(NumberToString(key), *value);
+        }
+      }
+    }
+  }
+
+ private:
+  const raw_ptr<ShardedLRUCache<int, std::string>> cache_;
+  const int seed_;
+};
+
+}  // namespace
+
+TEST(ShardedLRUCacheTest, Threads) {
+  ShardedLRUCache<int, std::string> cache(200, 4);
+  std::vector<std::unique_ptr<CacheUser>> users;
+  std::vector<PlatformThreadHandle> thread_handles(8);
+  for (size_t i = 0; i < thread_handles.size(); ++i) {
+    users.push_back(
+        std::make_unique<CacheUser>(&cache, static_cast<int>(i)));
+    ASSERT_TRUE(PlatformThread::Create(0, users.back().get(),
+                                       &thread_handles[i]));
+  }
+  for (auto& thread_handle : thread_handles)
+    PlatformThread::Join(thread_handle);
+  EXPECT_LE(cache.size(), cache.max_size());
+}
+
+}  // namespace base
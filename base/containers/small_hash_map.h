@@ -0,0 +1,337 @@
+// Copyright 2022 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#ifndef BASE_CONTAINERS_SMALL_HASH_MAP_H_
+#define BASE_CONTAINERS_SMALL_HASH_MAP_H_
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include <functional>
+#include <limits>
+#include <new>
+#include <tuple>
+#include <utility>
+#include <vector>
+
+#include "base/check_op.h"
+
+namespace base {
+
+// small_hash_map is a map which stores its entries by value, contiguously and
+// in insertion order. Up to |kInlineSize| entries are stored inline in the
+// map, and found by a linear search. Beyond that, the entries move to the heap
+// and are indexed by an open-addressing hash table of entry indices, so that
+// lookups and inserts take constant time.
+//
+// Please see //base/containers/README.md for an overview of which container
+// to select.
+//
+// PROS
+//
+//  - No allocation for small maps, and one array of entries (plus the index)
+//    for large ones, rather than one per entry.
+//  - Constant time inserts, unlike base::flat_map.
+//  - Iteration is a walk over contiguous entries.
+//
+// CONS
+//
+//  - Iteration is in insertion order, not sorted, and erase() moves the last
+//    entry into the hole.
+//  - The index costs 8 bytes per slot, with at most half of the slots used.
+//
+// IMPORTANT NOTES
+//
+//  - Iterators and pointers to the entries are invalidated across mutations.
+//  - The keys of the entries must not be modified through iterators.
+//  - Lookups are heterogeneous if |Hash| and |KeyEqual| are: with
+//    base::StringPieceHash and the default std::equal_to<>, a map keyed by
+//    std::string can be searched with a StringPiece. |Hash| must give the same
+//    value for equal keys of either type.
+template <class Key,
+          class Mapped,
+          size_t kInlineSize = 8,
+          class Hash = std::hash<Key>,
+          class KeyEqual = std::equal_to<>>
+class small_hash_map {
+ public:
+  static_assert(kInlineSize > 0, "kInlineSize must be positive");
+
+  using key_type = Key;
+  using mapped_type = Mapped;
+  using value_type = std::pair<Key, Mapped>;
+  using size_type = size_t;
+  using iterator = value_type*;
+  using const_iterator = const value_type*;
+
+  small_hash_map() = default;
+
+  small_hash_map(const small_hash_map& other) { *this = other; }
+
+  small_hash_map(small_hash_map&& other) noexcept { *this = std::move(other); }
+
+  small_hash_map& operator=(const small_hash_map& other) {
+    if (this == &other)
+      return *this;
+    clear();
+    if (other.is_inline()) {
+      for (const value_type& entry : other)
+        new (inline_entries() + inline_size_++) value_type(entry);
+    } else {
+      entries_ = other.entries_;
+      index_ = other.index_;
+    }
+    return *this;
+  }
+
+  small_hash_map& operator=(small_hash_map&& other) noexcept {
+    if (this == &other)
+      return *this;
+    clear();
+    if (other.is_inline()) {
+      for (value_type& entry : other)
+        new (inline_entries() + inline_size_++) value_type(std::move(entry));
+    } else {
+      entries_ = std::move(other.entries_);
+      index_ = std::move(other.index_);
+    }
+    other.clear();
+    return *this;
+  }
+
+  ~small_hash_map() { clear(); }
+
+  iterator begin() { return data(); }
+  const_iterator begin() const { return data(); }
+  const_iterator cbegin() const { return data(); }
+  iterator end() { return data() + size(); }
+  const_iterator end() const { return data() + size(); }
+  const_iterator cend() const { return data() + size(); }
+
+  size_t size() const { return is_inline() ? inline_size_ : entries_.size(); }
+  bool empty() const { return size() == 0; }
+
+  // Destroys the entries, and frees the heap storage.
+  void clear() {
+    if (is_inline()) {
+      for (value_type& entry : *this)
+        entry.~value_type();
+      inline_size_ = 0;
+    } else {
+      entries_ = std::vector<value_type>();
+      index_ = std::vector<Slot>();
+    }
+  }
+
+  template <class K>
+  iterator find(const K& key) {
+    return const_cast<iterator>(std::as_const(*this).find(key));
+  }
+
+  template <class K>
+  const_iterator find(const K& key) const {
+    if (is_inline()) {
+      for (const value_type& entry : *this) {
+        if (KeyEqual()(entry.first, key))
+          return &entry;
+      }
+      return end();
+    }
+    const uint32_t hash = HashKey(key);
+    for (size_t slot = hash & mask();; slot = (slot + 1) & mask()) {
+      if (index_[slot].entry == kEmptySlot)
+        return end();
+      if (index_[slot].hash == hash &&
+          KeyEqual()(entries_[index_[slot].entry].first, key)) {
+        return &entries_[index_[slot].entry];
+      }
+    }
+  }
+
+  template <class K>
+  bool contains(const K& key) const {
+    return find(key) != end();
+  }
+
+  // Inserts an entry for |key|, with a mapped value constructed from |args|,
+  // unless there is one already. Returns the entry of |key|, and whether it
+  // was inserted.
+  template <class K, class... Args>
+  std::pair<iterator, bool> try_emplace(K&& key, Args&&... args) {
+    iterator it = find(key);
+    if (it != end())
+      return {it, false};
+    return {Append(std::forward<K>(key), std::forward<Args>(args)...), true};
+  }
+
+  // Inserts or replaces the entry of |key|.
+  template <class K, class M>
+  std::pair<iterator, bool> insert_or_assign(K&& key, M&& mapped) {
+    iterator it = find(key);
+    if (it != end()) {
+      it->second = std::forward<M>(mapped);
+      return {it, false};
+    }
+    return {Append(std::forward<K>(key), std::forward<M>(mapped)), true};
+  }
+
+  template <class K>
+  Mapped& operator[](K&& key) {
+    return try_emplace(std::forward<K>(key)).first->second;
+  }
+
+  // Erases the entry of |key|, if any, moving the last entry into its place.
+  // Returns the number of erased entries.
+  template <class K>
+  size_t erase(const K& key) {
+    iterator it = find(key);
+    if (it == end())
+      return 0;
+    const size_t erased = static_cast<size_t>(it - begin());
+    const size_t last = size() - 1;
+    if (!is_inline()) {
+      RemoveSlot(FindSlot(erased));
+      if (erased != last)
+        index_[FindSlot(last)].entry = static_cast<uint32_t>(erased);
+    }
+    if (erased != last)
+      *it = std::move(*(begin() + last));
+    if (is_inline()) {
+      inline_entries()[last].~value_type();
+      inline_size_--;
+    } else {
+      entries_.pop_back();
+    }
+    return 1;
+  }
+
+ private:
+  // A slot of the index: the index of an entry, and the hash of its key.
+  struct Slot {
+    uint32_t entry;
+    uint32_t hash;
+  };
+
+  static constexpr uint32_t kEmptySlot = std::numeric_limits<uint32_t>::max();
+
+  // The index is created, and the entries moved to |entries_|, when the map
+  // grows beyond its inline capacity. It's then kept until clear().
+  bool is_inline() const { return index_.empty(); }
+
+  value_type* inline_entries() {
+    return std::launder(reinterpret_cast<value_type*>(inline_storage_));
+  }
+  const value_type* inline_entries() const {
+    return std::launder(reinterpret_cast<const value_type*>(inline_storage_));
+  }
+
+  value_type* data() {
+    return is_inline() ? inline_entries() : entries_.data();
+  }
+  const value_type* data() const {
+    return is_inline() ? inline_entries() : entries_.data();
+  }
+
+  size_t mask() const { return index_.size() - 1; }
+
+  template <class K>
+  static uint32_t HashKey(const K& key) {
+    // Mixes the hash, since std::hash is often the identity for integers, and
+    // keeps its high bits, which depend on all of its bits.
+    const uint64_t hash = static_cast<uint64_t>(Hash()(key));
+    return static_cast<uint32_t>((hash * 0x9e3779b97f4a7c15) >> 32);
+  }
+
+  template <class K, class... Args>
+  iterator Append(K&& key, Args&&... args) {
+    if (is_inline() && inline_size_ < kInlineSize) {
+      return new (inline_entries() + inline_size_++)
+          value_type(std::piecewise_construct,
+                     std::forward_as_tuple(std::forward<K>(key)),
+                     std::forward_as_tuple(std::forward<Args>(args)...));
+    }
+    if (is_inline())
+      MoveToHeap();
+    DCHECK_LT(entries_.size(), size_t{kEmptySlot});
+    entries_.emplace_back(std::piecewise_construct,
+                          std::forward_as_tuple(std::forward<K>(key)),
+                          std::forward_as_tuple(std::forward<Args>(args)...));
+    // Keeps at most half of the slots used.
+    if (entries_.size() * 2 > index_.size())
+      Rehash(index_.size() * 2);
+    const uint32_t entry = static_cast<uint32_t>(entries_.size() - 1);
+    InsertSlot({entry, HashKey(entries_.back().first)});
+    return &entries_.back();
+  }
+
+  void MoveToHeap() {
+    std::vector<value_type> entries;
+    entries.reserve(kInlineSize * 2);
+    for (value_type& entry : *this)
+      entries.push_back(std::move(entry));
+    clear();
+    entries_ = std::move(entries);
+    size_t slots = 4;
+    while (slots < kInlineSize * 4)
+      slots *= 2;
+    index_.assign(slots, Slot{kEmptySlot, 0});
+    for (size_t i = 0; i < entries_.size(); ++i)
+      InsertSlot({static_cast<uint32_t>(i), HashKey(entries_[i].first)});
+  }
+
+  void Rehash(size_t slots) {
+    std::vector<Slot> index(slots, Slot{kEmptySlot, 0});
+    std::swap(index, index_);
+    for (const Slot& slot : index) {
+      if (slot.entry != kEmptySlot)
+        InsertSlot(slot);
+    }
+  }
+
+  // Inserts |slot| in the first empty slot after its ideal position.
+  void InsertSlot(Slot slot) {
+    size_t position = slot.hash & mask();
+    while (index_[position].entry != kEmptySlot)
+      position = (position + 1) & mask();
+    index_[position] = slot;
+  }
+
+  // Returns the position of the slot of the |entry|-th entry.
+  size_t FindSlot(size_t entry) const {
+    size_t position = HashKey(entries_[entry].first) & mask();
+    while (index_[position].entry != entry) {
+      DCHECK_NE(index_[position].entry, kEmptySlot);
+      position = (position + 1) & mask();
+    }
+    return position;
+  }
+
+  // Empties the slot at |position|, shifting back the following slots of the
+  // probe sequence so that no lookup stops early at the hole.
+  void RemoveSlot(size_t position) {
+    for (size_t next = (position + 1) & mask();
+         index_[next].entry != kEmptySlot; next = (next + 1) & mask()) {
+      const size_t ideal = index_[next].hash & mask();
+      // The slot at |next| can fill the hole if the hole isn't before its
+      // ideal position, cyclically.
+      if (((next - ideal) & mask()) >= ((next - position) & mask())) {
+        index_[position] = index_[next];
+        position = next;
+      }
+    }
+    index_[position].entry = kEmptySlot;
+  }
+
+  // Used while the map is inline.
+  size_t inline_size_ = 0;
+  alignas(value_type) unsigned char inline_storage_[sizeof(value_type) *
+                                                    kInlineSize];
+  // Used once the map isn't inline.
+  std::vector<value_type> entries_;
+  std::vector<Slot> index_;
+};
+
+}  // namespace base
+
+#endif  // BASE_CONTAINERS_SMALL_HASH_MAP_H_
@@ -0,0 +1,152 @@
+// Copyright 2022 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "base/containers/small_hash_map.h"
+
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "base/rand_util.h"
+#include "base/strings/string_number_conversions.h"
+#include "base/strings/string_piece.h"
+#include "base/time/time.h"
+#include "base/timer/lap_timer.h"
+#include "base/values.h"
+#include "testing/gtest/include/gtest/gtest.h"
+#include "testing/perf/perf_result_reporter.h"
+
+namespace base {
+namespace {
+
+constexpr TimeDelta kTimeLimit = Seconds(2);
+constexpr int kWarmupRuns = 3;
+constexpr int kTimeCheckInterval = 1;
+
+constexpr char kMetricPrefixValueDict[] = "ValueDict.";
+constexpr char kMetricThroughput[] = "throughput";
+constexpr char kMetricTimePerEntry[] = "time_per_entry";
+
+// A small_hash_map storing the children of a dictionary by value, as an
+// alternative to the storage of Value::Dict.
+using HashedDict = small_hash_map<std::string, Value, 8, StringPieceHash>;
+
+perf_test::PerfResultReporter SetUpReporter(const std::string& story_name) {
+  perf_test::PerfResultReporter reporter(kMetricPrefixValueDict, story_name);
+  reporter.RegisterImportantMetric(kMetricThroughput, "runs/s");
+  reporter.RegisterImportantMetric(kMetricTimePerEntry, "ns");
+  return reporter;
+}
+
+void ReportResults(const std::string& story_name,
+                   const LapTimer& timer,
+                   size_t entries_per_lap) {
+  auto reporter = SetUpReporter(story_name);
+  const float entries_per_second = timer.LapsPerSecond() * entries_per_lap;
+  reporter.AddResult(kMetricThroughput, entries_per_second);
+  reporter.AddResult(kMetricTimePerEntry, 1e9 / entries_per_second);
+}
+
+// Keys in a random order, as they would come from parsed input.
+std::vector<std::string> GenerateKeys(size_t count) {
+  std::vector<std::string> keys;
+  for (size_t i = 0; i < count; ++i)
+    keys.push_back("key_" + NumberToString(i));
+  RandomShuffle(keys.begin(), keys.end());
+  return keys;
+}
+
+Value::Dict BuildDict(const std::vector<std::string>& keys) {
+  Value::Dict dict;
+  for (size_t i = 0; i < keys.size(); ++i)
+    dict.Set(keys[i], static_cast<int>(i));
+  return dict;
+}
+
+HashedDict BuildHashedDict(const std::vector<std::string>& keys) {
+  HashedDict dict;
+  for (size_t i = 0; i < keys.size(); ++i)
+    dict.insert_or_assign(keys[i], Value(static_cast<int>(i)));
+  return dict;
+}
+
+class ValueDictPerfTest : public testing::TestWithParam<size_t> {
+ public:
+  ValueDictPerfTest() : keys_(GenerateKeys(GetParam())) {}
+
+  std::string StoryName(const std::string& name) const {
+    return name + "_" + NumberToString(GetParam());
+  }
+
+ protected:
+  const std::vector<std::string> keys_;
+};
+
+}  // namespace
+
+TEST_P(ValueDictPerfTest, Build) {
+  LapTimer timer(kWarmupRuns, kTimeLimit, kTimeCheckInterval);
+  do {
+    EXPECT_EQ(keys_.size(), BuildDict(keys_).size());
+    timer.NextLap();
+  } while (!timer.HasTimeLimitExpired());
+  ReportResults(StoryName("build_dict"), timer, keys_.size());
+
+  timer.Reset();
+  do {
+    EXPECT_EQ(keys_.size(), BuildHashedDict(keys_).size());
+    timer.NextLap();
+  } while (!timer.HasTimeLimitExpired());
+  ReportResults(StoryName("build_hashed"), timer, keys_.size());
+}
+
+TEST_P(ValueDictPerfTest, Lookup) {
+  const Value::Dict dict = BuildDict(keys_);
+  LapTimer timer(kWarmupRuns, kTimeLimit, kTimeCheckInterval);
+  do {
+    for (const std::string& key : keys_)
+      ASSERT_TRUE(dict.FindInt(key));
+    timer.NextLap();
+  } while (!timer.HasTimeLimitExpired());
+  ReportResults(StoryName("lookup_dict"), timer, keys_.size());
+
+  const HashedDict hashed_dict = BuildHashedDict(keys_);
+  timer.Reset();
+  do {
+    for (const std::string& key : keys_)
+      ASSERT_TRUE(hashed_dict.find(StringPiece(key))->second.GetIfInt());
+    timer.NextLap();
+  } while (!timer.HasTimeLimitExpired());
+  ReportResults(StoryName("lookup_hashed"), timer, keys_.size());
+}
+
+TEST_P(ValueDictPerfTest, Iterate) {
+  const Value::Dict dict = BuildDict(keys_);
+  int64_t dict_sum = 0;
+  LapTimer timer(kWarmupRuns, kTimeLimit, kTimeCheckInterval);
+  do {
+    for (const auto [key, value] : dict)
+      dict_sum += value.GetInt();
+    timer.NextLap();
+  } while (!timer.HasTimeLimitExpired());
+  ReportResults(StoryName("iterate_dict"), timer, keys_.size());
+
+  const HashedDict hashed_dict = BuildHashedDict(keys_);
+  int64_t hashed_sum = 0;
+  timer.Reset();
+  do {
+    for (const auto& [key, value] : hashed_dict)
+      hashed_sum += value.GetInt();
+    timer.NextLap();
+  } while (!timer.HasTimeLimitExpired());
+  ReportResults(StoryName("iterate_hashed"), timer, keys_.size());
+  EXPECT_GT(dict_sum, 0);
+  EXPECT_GT(hashed_sum, 0);
+}
+
+INSTANTIATE_TEST_SUITE_P(All,
+                         ValueDictPerfTest,
+                         testing::Values(4, 32, 10000));
+
+}  // namespace base
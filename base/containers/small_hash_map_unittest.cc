@@ -0,0 +1,164 @@
+// Copyright 2022 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "base/containers/small_hash_map.h"
+
+#include <map>
+#include <memory>
+#include <string>
+#include <utility>
+
+#include "base/rand_util.h"
+#include "base/strings/string_number_conversions.h"
+#include "base/strings/string_piece.h"
+#include "testing/gtest/include/gtest/gtest.h"
+
+namespace base {
+
+namespace {
+
+using StringMap = small_hash_map<std::string, int, 4, StringPieceHash>;
+
+// Returns the entries of |map|, sorted.
+template <class Map>
+std::map<typename Map::key_type, typename Map::mapped_type> Sorted(
+    const Map& map) {
+  return {map.begin(), map.end()};
+}
+
+}  // namespace
+
+TEST(SmallHashMapTest, InsertAndFind) {
+  StringMap map;
+  EXPECT_TRUE(map.empty());
+  EXPECT_EQ(map.end(), map.find("a"));
+
+  // Inserts past the inline capacity, and checks the entries stay in
+  // insertion order.
+  for (int i = 0; i < 100; ++i) {
+    auto result = map.try_emplace(NumberToString(i), i);
+    EXPECT_TRUE(result.second);
+    EXPECT_EQ(i, result.first->second);
+    EXPECT_EQ(static_cast<size_t>(i + 1), map.size());
+    for (int j = 0; j <= i; ++j) {
+      auto it = map.find(NumberToString(j));
+      ASSERT_NE(map.end(), it);
+      EXPECT_EQ(j, it->second);
+      EXPECT_EQ(j, it - map.begin());
+    }
+    EXPECT_FALSE(map.contains(NumberToString(i + 1)));
+  }
+
+  auto result = map.try_emplace("5", 42);
+  EXPECT_FALSE(result.second);
+  EXPECT_EQ(5, result.first->second);
+
+  result = map.insert_or_assign("5", 42);
+  EXPECT_FALSE(result.second);
+  EXPECT_EQ(42, map.find("5")->second);
+  EXPECT_EQ(100u, map.size());
+
+  map["new"] = 7;
+  EXPECT_EQ(7, map.find("new")->second);
+  EXPECT_EQ(0, map["default"]);
+}
+
+TEST(SmallHashMapTest, HeterogeneousLookup) {
+  StringMap map;
+  map.insert_or_assign("key", 1);
+  const std::string key = "key";
+  EXPECT_TRUE(map.contains(StringPiece(key)));
+  EXPECT_TRUE(map.contains(key));
+  EXPECT_TRUE(map.contains("key"));
+  EXPECT_FALSE(map.contains(StringPiece(key).substr(1)));
+
+  for (int i = 0; i < 10; ++i)
+    map.insert_or_assign(NumberToString(i), i);
+  EXPECT_EQ(1, map.find(StringPiece(key))->second);
+}
+
+TEST(SmallHashMapTest, Erase) {
+  StringMap map;
+  for (int i = 0; i < 4; ++i)
+    map.insert_or_assign(NumberToString(i), i);
+  EXPECT_EQ(0u, map.erase("missing"));
+  // The last entry moves into the hole.
+  EXPECT_EQ(1u, map.erase("1"));
+  EXPECT_EQ(3u, map.size());
+  EXPECT_EQ("3", (map.begin() + 1)->first);
+  EXPECT_FALSE(map.contains("1"));
+  EXPECT_EQ(1u, map.erase("3"));
+  EXPECT_EQ(1u, map.erase("0"));
+  EXPECT_EQ(1u, map.erase("2"));
+  EXPECT_TRUE(map.empty());
+}
+
+TEST(SmallHashMapTest, RandomOperations) {
+  // Few keys, for many collisions of inserts and erasures.
+  small_hash_map<int, int, 8> map;
+  std::map<int, int> expected;
+  for (int i = 0; i < 100000; ++i) {
+    const int key = RandInt(0, 300);
+    switch (RandInt(0, 2)) {
+      case 0:
+        map.insert_or_assign(key, i);
+        expected[key] = i;
+        break;
+      case 1:
+        EXPECT_EQ(expected.erase(key), map.erase(key));
+        break;
+      default: {
+        auto it = map.find(key);
+        auto expected_it = expected.find(key);
+        ASSERT_EQ(expected_it == expected.end(), it == map.end());
+        if (it != map.end())
+          EXPECT_EQ(expected_it->second, it->second);
+        break;
+      }
+    }
+    ASSERT_EQ(expected.size(), map.size());
+  }
+  EXPECT_EQ(expected, Sorted(map));
+}
+
+TEST(SmallHashMapTest, CopyAndMove) {
+  for (int size : {2, 20}) {
+    StringMap map;
+    for (int i = 0; i < size; ++i)
+      map.insert_or_assign(NumberToString(i), i);
+
+    StringMap copy(map);
+    EXPECT_EQ(Sorted(map), Sorted(copy));
+    copy.insert_or_assign("copy", 1);
+    EXPECT_FALSE(map.contains("copy"));
+
+    StringMap moved(std::move(copy));
+    EXPECT_TRUE(copy.empty());
+    EXPECT_TRUE(moved.contains("copy"));
+    EXPECT_EQ(static_cast<size_t>(size + 1), moved.size());
+
+    map = std::move(moved);
+    EXPECT_TRUE(map.contains("copy"));
+    EXPECT_EQ(1, map.find("copy")->second);
+    EXPECT_EQ(static_cast<size_t>(size + 1), map.size());
+    map.clear();
+    EXPECT_TRUE(map.empty());
+    EXPECT_FALSE(map.contains("0"));
+  }
+}
+
+TEST(SmallHashMapTest, MoveOnly) {
+  small_hash_map<int, std::unique_ptr<int>, 2> map;
+  for (int i = 0; i < 10; ++i)
+    map.try_emplace(i, std::make_unique<int>(i));
+  EXPECT_EQ(1u, map.erase(3));
+  for (int i = 0; i < 10; ++i) {
+    if (i != 3)
+      EXPECT_EQ(i, *map.find(i)->second);
+  }
+  small_hash_map<int, std::unique_ptr<int>, 2> moved(std::move(map));
+  EXPECT_EQ(9u, moved.size());
+}
+
+}  // namespace base
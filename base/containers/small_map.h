@@ -178,6 +178,18 @@ class small_map {
     InitFrom(src);
   }
 
+  // Moves the elements of |src|, which is left empty. Unlike copying, this
+  // works with move-only values.
+  small_map(small_map&& src) { InitFrom(std::move(src)); }
+
+  small_map& operator=(small_map&& src) {
+    if (&src != this) {
+      Destroy();
+      InitFrom(std::move(src));
+    }
+    return *this;
+  }
+
   ~small_map() { Destroy(); }
 
   class const_iterator;
@@ -591,6 +603,20 @@ class small_map {
     }
   }
 
+  void InitFrom(small_map&& src) {
+    functor_ = src.functor_;
+    size_ = src.size_;
+    if (src.UsingFullMap()) {
+      functor_(&map_);
+      map_ = std::move(src.map_);
+    } else {
+      for (size_t i = 0; i < size_; ++i) {
+        new (&array_[i]) value_type(std::move(src.array_[i]));
+      }
+    }
+    src.clear();
+  }
+
   void Destroy() {
     if (UsingFullMap()) {
       map_.~NormalMap();
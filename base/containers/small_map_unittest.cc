@@ -568,6 +568,43 @@ TEST(SmallMap, MoveOnlyValueType) {
   EXPECT_EQ(m[2].value(), 3);
 }
 
+TEST(SmallMap, MoveConstructorAndAssignment) {
+  small_map<std::map<int, MoveOnlyType<int>>, 2> small;
+  small[0] = MoveOnlyType<int>(1);
+  small[1] = MoveOnlyType<int>(2);
+  EXPECT_FALSE(small.UsingFullMap());
+
+  small_map<std::map<int, MoveOnlyType<int>>, 2> moved(std::move(small));
+  EXPECT_TRUE(small.empty());
+  EXPECT_EQ(moved.size(), 2u);
+  EXPECT_EQ(moved[0].value(), 1);
+  EXPECT_EQ(moved[1].value(), 2);
+
+  small_map<std::map<int, MoveOnlyType<int>>, 2> large;
+  large[5] = MoveOnlyType<int>(5);
+  large[6] = MoveOnlyType<int>(6);
+  large[7] = MoveOnlyType<int>(7);
+  EXPECT_TRUE(large.UsingFullMap());
+
+  // Assignments which move from full to small, and vice versa.
+  moved = std::move(large);
+  EXPECT_TRUE(large.empty());
+  EXPECT_FALSE(large.UsingFullMap());
+  EXPECT_TRUE(moved.UsingFullMap());
+  EXPECT_EQ(moved.size(), 3u);
+  EXPECT_EQ(moved[7].value(), 7);
+
+  small[3] = MoveOnlyType<int>(3);
+  moved = std::move(small);
+  EXPECT_FALSE(moved.UsingFullMap());
+  EXPECT_EQ(moved.size(), 1u);
+  EXPECT_EQ(moved[3].value(), 3);
+
+  // The emptied maps can be used again.
+  large[8] = MoveOnlyType<int>(8);
+  EXPECT_EQ(large.size(), 1u);
+}
+
 TEST(SmallMap, Emplace) {
   small_map<std::map<size_t, MoveOnlyType<size_t>>> sm;
 
@@ -298,8 +298,14 @@ void CPU::Initialize(bool require_branding) {
         (cpu_info[2] & 0x08000000) != 0 /* OSXSAVE */ &&
         (xgetbv(0) & 6) == 6 /* XSAVE enabled by kernel */;
     has_aesni_ = (cpu_info[2] & 0x02000000) != 0;
+    has_pclmul_ = (cpu_info[2] & 0x00000002) != 0;
+    has_sha1_ = (cpu_info7[1] & 0x20000000) != 0;
     has_fma3_ = (cpu_info[2] & 0x00001000) != 0;
     has_avx2_ = has_avx_ && (cpu_info7[1] & 0x00000020) != 0;
+    // AVX-512 also needs the kernel to save the opmask and the upper halves of
+    // the ZMM registers.
+    has_avx512f_ = has_avx_ && (cpu_info7[1] & 0x00010000) != 0 &&
+                   (xgetbv(0) & 0xe0) == 0xe0;
   }
 
   // Get the brand string of the cpu.
@@ -360,6 +366,10 @@ void CPU::Initialize(bool require_branding) {
   unsigned long hwcap2 = getauxval(AT_HWCAP2);
   has_mte_ = hwcap2 & HWCAP2_MTE;
   has_bti_ = hwcap2 & HWCAP2_BTI;
+  // And for the optional Armv8.0 CRC32 and SHA1 instructions, exposed via
+  // HWCAP.
+  has_crc32_ = getauxval(AT_HWCAP) & HWCAP_CRC32;
+  has_sha1_ = getauxval(AT_HWCAP) & HWCAP_SHA1;
 #endif
 
 #elif BUILDFLAG(IS_WIN)
@@ -367,6 +377,13 @@ void CPU::Initialize(bool require_branding) {
   // user-space.
   has_non_stop_time_stamp_counter_ = true;
 #endif
+#if defined(__ARM_FEATURE_CRC32)
+  // The build targets cores which all have them, e.g. on Apple silicon.
+  has_crc32_ = true;
+#endif
+#if defined(__ARM_FEATURE_CRYPTO) || defined(__ARM_FEATURE_SHA2)
+  has_sha1_ = true;
+#endif
 #endif
 }
 
@@ -78,7 +78,9 @@ class BASE_EXPORT CPU final {
   bool has_avx() const { return has_avx_; }
   bool has_fma3() const { return has_fma3_; }
   bool has_avx2() const { return has_avx2_; }
+  bool has_avx512f() const { return has_avx512f_; }
   bool has_aesni() const { return has_aesni_; }
+  bool has_pclmul() const { return has_pclmul_; }
   bool has_non_stop_time_stamp_counter() const {
     return has_non_stop_time_stamp_counter_;
   }
@@ -102,6 +104,21 @@ class BASE_EXPORT CPU final {
   constexpr bool has_bti() const { return false; }
 #endif
 
+  // The Armv8 CRC32 instructions, of both the CRC-32 and CRC-32C polynomials.
+#if defined(ARCH_CPU_ARM_FAMILY)
+  bool has_crc32() const { return has_crc32_; }
+#else
+  constexpr bool has_crc32() const { return false; }
+#endif
+
+  // The SHA-1 instructions: the SHA extensions on x86, which also have
+  // SHA-256, or the Armv8 SHA1 ones.
+#if defined(ARCH_CPU_X86_FAMILY) || defined(ARCH_CPU_ARM_FAMILY)
+  bool has_sha1() const { return has_sha1_; }
+#else
+  constexpr bool has_sha1() const { return false; }
+#endif
+
 #if defined(ARCH_CPU_X86_FAMILY)
   IntelMicroArchitecture GetIntelMicroArchitecture() const;
 #endif
@@ -188,10 +205,14 @@ class BASE_EXPORT CPU final {
   bool has_avx_ = false;
   bool has_fma3_ = false;
   bool has_avx2_ = false;
+  bool has_avx512f_ = false;
   bool has_aesni_ = false;
+  bool has_pclmul_ = false;
+  bool has_sha1_ = false;  // SHA extensions or Armv8 SHA1 instructions
 #if defined(ARCH_CPU_ARM_FAMILY)
-  bool has_mte_ = false;  // Armv8.5-A MTE (Memory Taggging Extension)
-  bool has_bti_ = false;  // Armv8.5-A BTI (Branch Target Identification)
+  bool has_mte_ = false;    // Armv8.5-A MTE (Memory Taggging Extension)
+  bool has_bti_ = false;    // Armv8.5-A BTI (Branch Target Identification)
+  bool has_crc32_ = false;  // Armv8 CRC32 instructions
 #endif
   bool has_non_stop_time_stamp_counter_ = false;
   bool is_running_in_vm_ = false;
@@ -204,6 +204,20 @@ bool SetThreadCpuAffinityMode(PlatformThreadId thread_id,
   return result == 0;
 }
 
+bool SetThreadCpuAffinity(PlatformThreadId thread_id,
+                          const std::vector<int>& cpus) {
+  cpu_set_t set;
+  CPU_ZERO(&set);
+  for (int cpu : cpus) {
+    if (cpu < 0 || cpu >= CPU_SETSIZE)
+      return false;
+    CPU_SET(cpu, &set);
+  }
+  if (CPU_COUNT(&set) == 0)
+    return false;
+  return sched_setaffinity(thread_id, sizeof(set), &set) == 0;
+}
+
 bool SetProcessCpuAffinityMode(ProcessHandle process_handle,
                                CpuAffinityMode affinity) {
   bool any_threads = false;
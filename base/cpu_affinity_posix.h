@@ -5,6 +5,8 @@
 #ifndef BASE_CPU_AFFINITY_POSIX_H_
 #define BASE_CPU_AFFINITY_POSIX_H_
 
+#include <vector>
+
 #include "base/process/process_handle.h"
 #include "base/threading/platform_thread.h"
 #include "third_party/abseil-cpp/absl/types/optional.h"
@@ -30,6 +32,11 @@ enum class CpuAffinityMode {
 // Returns false if updating the affinity failed.
 BASE_EXPORT bool SetThreadCpuAffinityMode(PlatformThreadId thread_id,
                                           CpuAffinityMode affinity);
+// Restricts execution of the specified thread to the logical CPUs in |cpus|.
+// Returns false if |cpus| is empty or if updating the affinity failed.
+BASE_EXPORT bool SetThreadCpuAffinity(PlatformThreadId thread_id,
+                                      const std::vector<int>& cpus);
+
 // Like SetThreadAffinityMode, but affects all current and future threads of
 // the given process. Note that this may not apply to threads that are created
 // in parallel to the execution of this function.
@@ -133,4 +133,32 @@ TEST(CpuAffinityTest, MAYBE_SetThreadCpuAffinityMode) {
   ASSERT_FALSE(thread.IsRunning());
 }
 
+TEST(CpuAffinityTest, SetThreadCpuAffinity) {
+  PlatformThreadId thread_id = PlatformThread::CurrentId();
+  cpu_set_t original_set;
+  ASSERT_EQ(sched_getaffinity(thread_id, sizeof(original_set), &original_set),
+            0);
+
+  int allowed_cpu = -1;
+  for (int cpu = 0; cpu < CPU_SETSIZE; ++cpu) {
+    if (CPU_ISSET(cpu, &original_set)) {
+      allowed_cpu = cpu;
+      break;
+    }
+  }
+  ASSERT_GE(allowed_cpu, 0);
+
+  EXPECT_FALSE(SetThreadCpuAffinity(thread_id, {}));
+  EXPECT_FALSE(SetThreadCpuAffinity(thread_id, {-1}));
+
+  EXPECT_TRUE(SetThreadCpuAffinity(thread_id, {allowed_cpu}));
+  cpu_set_t set;
+  EXPECT_EQ(sched_getaffinity(thread_id, sizeof(set), &set), 0);
+  EXPECT_EQ(CPU_COUNT(&set), 1);
+  EXPECT_TRUE(CPU_ISSET(allowed_cpu, &set));
+
+  EXPECT_EQ(sched_setaffinity(thread_id, sizeof(original_set), &original_set),
+            0);
+}
+
 }  // namespace base
@@ -53,6 +53,16 @@ TEST(CPU, RunExtendedInstructions) {
     __asm__ __volatile__("crc32 %%eax, %%eax\n" : : : "eax");
   }
 
+  if (cpu.has_pclmul()) {
+    // Execute a PCLMULQDQ instruction.
+    __asm__ __volatile__("pclmulqdq $0, %%xmm0, %%xmm0\n" : : : "xmm0");
+  }
+
+  if (cpu.has_sha1()) {
+    // Execute a SHA-1 instruction.
+    __asm__ __volatile__("sha1msg1 %%xmm0, %%xmm0\n" : : : "xmm0");
+  }
+
   if (cpu.has_popcnt()) {
     // Execute a POPCNT instruction.
     __asm__ __volatile__("popcnt %%eax, %%eax\n" : : : "eax");
@@ -72,6 +82,11 @@ TEST(CPU, RunExtendedInstructions) {
     // Execute an AVX 2 instruction.
     __asm__ __volatile__("vpunpcklbw %%ymm0, %%ymm0, %%ymm0\n" : : : "xmm0");
   }
+
+  if (cpu.has_avx512f()) {
+    // Execute an AVX-512 instruction.
+    __asm__ __volatile__("vpandq %%zmm0, %%zmm0, %%zmm0\n" : : : "xmm0");
+  }
 // Visual C 32 bit and ClangCL 32/64 bit test.
 #elif defined(COMPILER_MSVC) && (defined(ARCH_CPU_32_BITS) || \
       (defined(ARCH_CPU_64_BITS) && defined(__clang__)))
@@ -48,6 +48,14 @@ const size_t kProcessDataSize = 4 << 10;  // 4 KiB
 const size_t kMaxUserDataNameLength =
     static_cast<size_t>(std::numeric_limits<uint8_t>::max());
 
+// Set by GlobalActivityTracker::SetLowOverheadMode().
+std::atomic<bool> g_low_overhead_mode{false};
+std::atomic<uint32_t> g_lock_sampling_interval{1};
+
+// The number of contended lock acquisitions before the next tracked one on the
+// current thread.
+thread_local uint32_t g_tls_lock_acquisitions_until_sample = 0;
+
 // A constant used to indicate that module information is changing.
 const uint32_t kModuleInformationChanging = 0x80000000;
 
@@ -251,13 +259,20 @@ void Activity::FillFrom(Activity* activity,
                         const void* origin,
                         Type type,
                         const ActivityData& data) {
-  activity->time_internal = base::TimeTicks::Now().ToInternalValue();
+  const bool low_overhead = g_low_overhead_mode.load(std::memory_order_relaxed);
+  activity->time_internal = (low_overhead ? base::TimeTicks::NowCoarse()
+                                          : base::TimeTicks::Now())
+                                .ToInternalValue();
   activity->calling_address = reinterpret_cast<uintptr_t>(program_counter);
   activity->origin_address = reinterpret_cast<uintptr_t>(origin);
   activity->activity_type = type;
   activity->data = data;
 
 #if (!BUILDFLAG(IS_NACL) && DCHECK_IS_ON()) || defined(ADDRESS_SANITIZER)
+  if (low_overhead) {
+    activity->call_stack[0] = 0;
+    return;
+  }
   // Create a stacktrace from the current location and get the addresses for
   // improved debuggability.
   StackTrace stack_trace;
@@ -1210,6 +1225,18 @@ GlobalActivityTracker::ScopedThreadActivity::ScopedThreadActivity(
                                             type,
                                             data) {}
 
+GlobalActivityTracker::ScopedThreadActivity::ScopedThreadActivity(
+    ThreadActivityTracker* tracker,
+    const void* program_counter,
+    const void* origin,
+    Activity::Type type,
+    const ActivityData& data)
+    : ThreadActivityTracker::ScopedActivity(tracker,
+                                            program_counter,
+                                            origin,
+                                            type,
+                                            data) {}
+
 GlobalActivityTracker::ScopedThreadActivity::~ScopedThreadActivity() {
   if (tracker_ && tracker_->HasUserData(activity_id_)) {
     GlobalActivityTracker* global = GlobalActivityTracker::Get();
@@ -1337,6 +1364,16 @@ void GlobalActivityTracker::SetForTesting(
   g_tracker_.store(tracker.release(), std::memory_order_release);
 }
 
+// static
+void GlobalActivityTracker::SetLowOverheadMode(
+    bool enabled,
+    uint32_t lock_sampling_interval) {
+  g_low_overhead_mode.store(enabled, std::memory_order_relaxed);
+  g_lock_sampling_interval.store(
+      enabled ? std::max(lock_sampling_interval, 1u) : 1u,
+      std::memory_order_relaxed);
+}
+
 // static
 std::unique_ptr<GlobalActivityTracker>
 GlobalActivityTracker::ReleaseForTesting() {
@@ -1625,6 +1662,10 @@ void GlobalActivityTracker::MarkDeleted() {
   allocator_->SetMemoryState(PersistentMemoryAllocator::MEMORY_DELETED);
 }
 
+void GlobalActivityTracker::Flush(bool sync) {
+  allocator_->Flush(sync);
+}
+
 GlobalActivityTracker::GlobalActivityTracker(
     std::unique_ptr<PersistentMemoryAllocator> allocator,
     int stack_depth,
@@ -1751,12 +1792,30 @@ ScopedTaskRunActivity::ScopedTaskRunActivity(
 ScopedLockAcquireActivity::ScopedLockAcquireActivity(
     const void* program_counter,
     const base::internal::LockImpl* lock)
-    : GlobalActivityTracker::ScopedThreadActivity(
-          program_counter,
-          nullptr,
-          Activity::ACT_LOCK_ACQUIRE,
-          ActivityData::ForLock(lock),
-          /*lock_allowed=*/false) {}
+    : GlobalActivityTracker::ScopedThreadActivity(GetSampledTracker(),
+                                                  program_counter,
+                                                  nullptr,
+                                                  Activity::ACT_LOCK_ACQUIRE,
+                                                  ActivityData::ForLock(lock)) {
+}
+
+// static
+ThreadActivityTracker* ScopedLockAcquireActivity::GetSampledTracker() {
+  GlobalActivityTracker* global_tracker = GlobalActivityTracker::Get();
+  if (!global_tracker)
+    return nullptr;
+  const uint32_t interval =
+      g_lock_sampling_interval.load(std::memory_order_relaxed);
+  if (interval > 1) {
+    if (g_tls_lock_acquisitions_until_sample > 0) {
+      --g_tls_lock_acquisitions_until_sample;
+      return nullptr;
+    }
+    g_tls_lock_acquisitions_until_sample = interval - 1;
+  }
+  // Creating the tracker would acquire locks, which would be tracked.
+  return global_tracker->GetTrackerForCurrentThread();
+}
 
 ScopedEventWaitActivity::ScopedEventWaitActivity(
     const void* program_counter,
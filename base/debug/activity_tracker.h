@@ -884,6 +884,15 @@ class BASE_EXPORT GlobalActivityTracker {
     // Returns an object for manipulating user data.
     ActivityUserData& user_data();
 
+   protected:
+    // For activities which decide themselves whether to be tracked, by
+    // |tracker| which may be null.
+    ScopedThreadActivity(ThreadActivityTracker* tracker,
+                         const void* program_counter,
+                         const void* origin,
+                         Activity::Type type,
+                         const ActivityData& data);
+
    private:
     // Gets (or creates) a tracker for the current thread. If locking is not
     // allowed (because a lock is being tracked which would cause recursion)
@@ -965,6 +974,15 @@ class BASE_EXPORT GlobalActivityTracker {
   // Convenience method for determining if a global tracker is active.
   static bool IsEnabled() { return Get() != nullptr; }
 
+  // Makes tracking cheap enough to stay enabled in every production process,
+  // e.g. to diagnose hangs from the tracker's memory in crash reports, at the
+  // cost of detail: the activities get their times from TimeTicks::NowCoarse()
+  // and don't collect call stacks (which only debug and ASan builds do), and
+  // only one in |lock_sampling_interval| contended lock acquisitions on each
+  // thread is tracked. Can be called at any time, on any thread.
+  static void SetLowOverheadMode(bool enabled,
+                                 uint32_t lock_sampling_interval = 16);
+
   // Gets the persistent-memory-allocator in which data is stored. Callers
   // can store additional records here to pass more information to the
   // analysis process.
@@ -1071,6 +1089,13 @@ class BASE_EXPORT GlobalActivityTracker {
   // Marks the tracked data as deleted.
   void MarkDeleted();
 
+  // Writes everything tracked so far to the file of a tracker created with
+  // CreateWithFile(), for it to survive a crash of the system rather than only
+  // of the process; the activities themselves are written to memory without
+  // any system call. Does nothing for other trackers. See
+  // PersistentMemoryAllocator::Flush() for |sync|.
+  void Flush(bool sync);
+
   // Gets the process ID used for tracking. This is typically the same as what
   // the OS thinks is the current process but can be overridden for testing.
   int64_t process_id() { return process_id_; }
@@ -1344,6 +1369,10 @@ class BASE_EXPORT ScopedLockAcquireActivity
  private:
   ScopedLockAcquireActivity(const void* program_counter,
                             const base::internal::LockImpl* lock);
+
+  // Returns the tracker of the current thread if it exists and this
+  // acquisition is sampled.
+  static ThreadActivityTracker* GetSampledTracker();
 };
 
 class BASE_EXPORT ScopedEventWaitActivity
@@ -330,6 +330,42 @@ TEST_F(ActivityTrackerTest, LockTest) {
   EXPECT_TRUE(t2.WasDataChanged());
 }
 
+TEST_F(ActivityTrackerTest, LowOverheadModeTest) {
+  GlobalActivityTracker::CreateWithLocalMemory(kMemorySize, 0, "", 3, 0);
+  ThreadActivityTracker* tracker =
+      GlobalActivityTracker::Get()->GetOrCreateTrackerForCurrentThread();
+  GlobalActivityTracker::SetLowOverheadMode(true, 4);
+
+  // Only one in 4 contended acquisitions is tracked. The activity only
+  // records the address of the lock.
+  const base::internal::LockImpl* const lock = nullptr;
+  int tracked = 0;
+  for (int i = 0; i < 16; ++i) {
+    ScopedLockAcquireActivity activity(lock);
+    if (activity.IsRecorded())
+      ++tracked;
+  }
+  EXPECT_EQ(4, tracked);
+
+  // Activities don't collect their call stack.
+  {
+    ScopedActivity activity(0, 0x1234, 5);
+    ThreadActivityTracker::Snapshot snapshot;
+    ASSERT_TRUE(tracker->CreateSnapshot(&snapshot));
+    ASSERT_EQ(1U, snapshot.activity_stack.size());
+    EXPECT_EQ(0U, snapshot.activity_stack[0].call_stack[0]);
+  }
+
+  GlobalActivityTracker::SetLowOverheadMode(false);
+  tracked = 0;
+  for (int i = 0; i < 4; ++i) {
+    ScopedLockAcquireActivity activity(lock);
+    if (activity.IsRecorded())
+      ++tracked;
+  }
+  EXPECT_EQ(4, tracked);
+}
+
 TEST_F(ActivityTrackerTest, ExceptionTest) {
   GlobalActivityTracker::CreateWithLocalMemory(kMemorySize, 0, "", 3, 0);
   GlobalActivityTracker* global = GlobalActivityTracker::Get();
@@ -0,0 +1,141 @@
+// Copyright 2022 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "base/debug/crash_key_arena.h"
+
+#include <string.h>
+
+#include <algorithm>
+#include <new>
+#include <ostream>
+
+#include "base/check_op.h"
+#include "base/threading/platform_thread.h"
+
+namespace base {
+namespace debug {
+
+namespace {
+
+// How many times VisitCrashKeys() tries to read a value which is being
+// written.
+constexpr int kMaxReadAttempts = 100;
+
+}  // namespace
+
+CrashKeyArena::CrashKeyArena() = default;
+
+CrashKeyArena::~CrashKeyArena() {
+  const size_t count = constructed_count_.load(std::memory_order_acquire);
+  for (size_t i = 0; i < count; ++i)
+    reinterpret_cast<Slot*>(&slots_[i])->~Slot();
+}
+
+CrashKeyString* CrashKeyArena::Allocate(const char name[], CrashKeySize size) {
+  DCHECK_LE(static_cast<size_t>(size), kMaxValueSize);
+  const size_t index = allocated_count_.fetch_add(1, std::memory_order_relaxed);
+  if (index >= kMaxCrashKeys)
+    return nullptr;
+  Slot* slot = new (&slots_[index]) Slot(name, size);
+  // Readers see the slots up to |constructed_count_|, so the slots allocated
+  // concurrently are published in order.
+  size_t expected = index;
+  while (!constructed_count_.compare_exchange_weak(expected, index + 1,
+                                                   std::memory_order_release,
+                                                   std::memory_order_relaxed)) {
+    expected = index;
+    PlatformThread::YieldCurrentThread();
+  }
+  return slot;
+}
+
+void CrashKeyArena::Set(CrashKeyString* crash_key, StringPiece value) {
+  Write(crash_key, value);
+}
+
+void CrashKeyArena::Clear(CrashKeyString* crash_key) {
+  Write(crash_key, StringPiece());
+}
+
+void CrashKeyArena::OutputCrashKeysToStream(std::ostream& out) {
+  VisitCrashKeys(
+      [](const char* name, StringPiece value, void* context) {
+        *static_cast<std::ostream*>(context)
+            << "crash key " << name << ": " << value << std::endl;
+      },
+      &out);
+}
+
+void CrashKeyArena::VisitCrashKeys(Visitor visitor, void* context) const {
+  const size_t count = constructed_count_.load(std::memory_order_acquire);
+  char buffer[kMaxValueSize];
+  for (size_t i = 0; i < count; ++i) {
+    const Slot& slot = *reinterpret_cast<const Slot*>(&slots_[i]);
+    const int length = Read(slot, buffer);
+    if (length > 0)
+      visitor(slot.name, StringPiece(buffer, static_cast<size_t>(length)),
+              context);
+  }
+}
+
+void CrashKeyArena::Write(CrashKeyString* crash_key, StringPiece value) {
+  Slot* slot = static_cast<Slot*>(crash_key);
+  const size_t length =
+      std::min(value.size(), static_cast<size_t>(slot->size));
+
+  // Writers to the same key take turns making the sequence number odd.
+  uint32_t sequence = slot->sequence.load(std::memory_order_relaxed);
+  for (;;) {
+    if (sequence & 1) {
+      PlatformThread::YieldCurrentThread();
+      sequence = slot->sequence.load(std::memory_order_relaxed);
+      continue;
+    }
+    if (slot->sequence.compare_exchange_weak(sequence, sequence + 1,
+                                             std::memory_order_relaxed)) {
+      break;
+    }
+  }
+  // Orders the store of the odd sequence number above before the stores of
+  // the words below.
+  std::atomic_thread_fence(std::memory_order_release);
+
+  Word words[kNumWords];
+  const size_t num_words = (length + sizeof(Word) - 1) / sizeof(Word);
+  if (num_words) {
+    words[num_words - 1] = 0;
+    memcpy(words, value.data(), length);
+  }
+  for (size_t i = 0; i < num_words; ++i)
+    slot->words[i].store(words[i], std::memory_order_relaxed);
+  slot->length.store(static_cast<uint32_t>(length), std::memory_order_relaxed);
+
+  slot->sequence.store(sequence + 2, std::memory_order_release);
+}
+
+// static
+int CrashKeyArena::Read(const Slot& slot, char* buffer) {
+  for (int attempt = 0; attempt < kMaxReadAttempts; ++attempt) {
+    const uint32_t sequence = slot.sequence.load(std::memory_order_acquire);
+    if (sequence & 1)
+      continue;
+    const size_t length = std::min<size_t>(
+        slot.length.load(std::memory_order_relaxed), kMaxValueSize);
+    Word words[kNumWords];
+    const size_t num_words = (length + sizeof(Word) - 1) / sizeof(Word);
+    for (size_t i = 0; i < num_words; ++i)
+      words[i] = slot.words[i].load(std::memory_order_relaxed);
+    // Orders the loads of the words above before the load of the sequence
+    // number below.
+    std::atomic_thread_fence(std::memory_order_acquire);
+    if (slot.sequence.load(std::memory_order_relaxed) == sequence) {
+      memcpy(buffer, words, length);
+      return static_cast<int>(length);
+    }
+  }
+  return -1;
+}
+
+}  // namespace debug
+}  // namespace base
@@ -0,0 +1,101 @@
+// Copyright 2022 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#ifndef BASE_DEBUG_CRASH_KEY_ARENA_H_
+#define BASE_DEBUG_CRASH_KEY_ARENA_H_
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include <atomic>
+#include <iosfwd>
+#include <type_traits>
+
+#include "base/base_export.h"
+#include "base/debug/crash_logging.h"
+#include "base/strings/string_piece.h"
+
+namespace base {
+namespace debug {
+
+// A CrashKeyImplementation which stores the crash keys in a fixed arena of
+// kMaxCrashKeys slots, for the processes which set crash keys on their hot
+// paths, e.g. for each request. Setting or clearing a key doesn't allocate nor
+// take a lock: each slot is a sequence lock, whose writers copy the value into
+// its words while its sequence number is odd. Writers to the same key wait for
+// each other, but only for the copy of a value. The keys can be read from a
+// signal handler, with VisitCrashKeys().
+//
+//   auto arena = std::make_unique<CrashKeyArena>();
+//   CrashKeyArena* crash_keys = arena.get();
+//   SetCrashKeyImplementation(std::move(arena));
+//
+//   // In the crash handler.
+//   crash_keys->VisitCrashKeys(&WriteCrashKey, &minidump);
+//
+// The arena never frees a slot, as AllocateCrashKeyString() is meant to be
+// called once per key. It returns null once all the slots are taken.
+class BASE_EXPORT CrashKeyArena : public CrashKeyImplementation {
+ public:
+  static constexpr size_t kMaxCrashKeys = 128;
+
+  // Called by VisitCrashKeys() with the name and value of a key. |value| is
+  // only valid during the call.
+  using Visitor = void (*)(const char* name, StringPiece value, void* context);
+
+  CrashKeyArena();
+  CrashKeyArena(const CrashKeyArena&) = delete;
+  CrashKeyArena& operator=(const CrashKeyArena&) = delete;
+  ~CrashKeyArena() override;
+
+  // CrashKeyImplementation:
+  CrashKeyString* Allocate(const char name[], CrashKeySize size) override;
+  void Set(CrashKeyString* crash_key, StringPiece value) override;
+  void Clear(CrashKeyString* crash_key) override;
+  void OutputCrashKeysToStream(std::ostream& out) override;
+
+  // Calls |visitor| with each key which has a value, in the order they were
+  // allocated. Async-signal-safe: it doesn't allocate, lock nor wait. A value
+  // which is being written, e.g. by the thread the signal interrupted, is
+  // skipped if it doesn't settle after a few attempts.
+  void VisitCrashKeys(Visitor visitor, void* context) const;
+
+ private:
+  using Word = uintptr_t;
+  static constexpr size_t kMaxValueSize =
+      static_cast<size_t>(CrashKeySize::Size256);
+  static constexpr size_t kNumWords = kMaxValueSize / sizeof(Word);
+
+  struct Slot : public CrashKeyString {
+    Slot(const char name[], CrashKeySize size) : CrashKeyString(name, size) {}
+
+    // Odd while a writer writes.
+    std::atomic<uint32_t> sequence{0};
+    // The value, as relaxed atomic words, so that a reader racing with a
+    // writer copies garbage (which it then discards) rather than causing
+    // undefined behavior.
+    std::atomic<uint32_t> length{0};
+    std::atomic<Word> words[kNumWords];
+  };
+
+  // Replaces the value of |crash_key| by |value|, truncated to its size.
+  void Write(CrashKeyString* crash_key, StringPiece value);
+
+  // Copies the value of |slot| into |buffer|, which holds kMaxValueSize bytes,
+  // and returns its length, or -1 if a writer kept modifying it.
+  static int Read(const Slot& slot, char* buffer);
+
+  // The number of slots handed out, which may exceed kMaxCrashKeys when the
+  // arena is full, and the number of those constructed. Allocate() constructs
+  // the slots in order.
+  std::atomic<size_t> allocated_count_{0};
+  std::atomic<size_t> constructed_count_{0};
+
+  std::aligned_storage_t<sizeof(Slot), alignof(Slot)> slots_[kMaxCrashKeys];
+};
+
+}  // namespace debug
+}  // namespace base
+
+#endif  // BASE_DEBUG_CRASH_KEY_ARENA_H_
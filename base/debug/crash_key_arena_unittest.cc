@@ -0,0 +1,143 @@
+// Copyright 2022 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "base/debug/crash_key_arena.h"
+
+#include <atomic>
+#include <map>
+#include <memory>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include "base/strings/string_piece.h"
+#include "base/threading/simple_thread.h"
+#include "testing/gmock/include/gmock/gmock.h"
+#include "testing/gtest/include/gtest/gtest.h"
+
+using ::testing::ElementsAre;
+using ::testing::IsEmpty;
+using ::testing::Pair;
+
+namespace base {
+namespace debug {
+
+namespace {
+
+std::vector<std::pair<std::string, std::string>> GetCrashKeys(
+    const CrashKeyArena& arena) {
+  std::vector<std::pair<std::string, std::string>> crash_keys;
+  arena.VisitCrashKeys(
+      [](const char* name, StringPiece value, void* context) {
+        static_cast<std::vector<std::pair<std::string, std::string>>*>(context)
+            ->emplace_back(name, std::string(value));
+      },
+      &crash_keys);
+  return crash_keys;
+}
+
+// Sets a key to values made of a single repeated character, so that readers
+// can tell a torn value from a consistent one.
+class CrashKeyWriter : public SimpleThread {
+ public:
+  CrashKeyWriter(CrashKeyArena* arena,
+                 CrashKeyString* crash_key,
+                 char c,
+                 std::atomic<bool>* stop)
+      : SimpleThread("CrashKeyWriter"),
+        arena_(arena),
+        crash_key_(crash_key),
+        c_(c),
+        stop_(stop) {}
+
+  void Run() override {
+    for (size_t i = 0; !stop_->load(std::memory_order_relaxed); ++i)
+      arena_->Set(crash_key_, std::string(1 + i % 200, c_));
+  }
+
+ private:
+  CrashKeyArena* const arena_;
+  CrashKeyString* const crash_key_;
+  const char c_;
+  std::atomic<bool>* const stop_;
+};
+
+}  // namespace
+
+TEST(CrashKeyArenaTest, SetAndClear) {
+  CrashKeyArena arena;
+  CrashKeyString* first = arena.Allocate("first", CrashKeySize::Size32);
+  CrashKeyString* second = arena.Allocate("second", CrashKeySize::Size256);
+  ASSERT_TRUE(first);
+  ASSERT_TRUE(second);
+  EXPECT_STREQ("first", first->name);
+  EXPECT_EQ(CrashKeySize::Size256, second->size);
+  EXPECT_THAT(GetCrashKeys(arena), IsEmpty());
+
+  arena.Set(second, "value");
+  arena.Set(first, "other value");
+  EXPECT_THAT(GetCrashKeys(arena), ElementsAre(Pair("first", "other value"),
+                                               Pair("second", "value")));
+
+  arena.Set(second, "new value");
+  arena.Clear(first);
+  EXPECT_THAT(GetCrashKeys(arena), ElementsAre(Pair("second", "new value")));
+
+  std::ostringstream stream;
+  arena.OutputCrashKeysToStream(stream);
+  EXPECT_EQ("crash key second: new value\n", stream.str());
+}
+
+TEST(CrashKeyArenaTest, Truncate) {
+  CrashKeyArena arena;
+  CrashKeyString* crash_key = arena.Allocate("key", CrashKeySize::Size32);
+  arena.Set(crash_key, std::string(40, 'a'));
+  EXPECT_THAT(GetCrashKeys(arena),
+              ElementsAre(Pair("key", std::string(32, 'a'))));
+}
+
+TEST(CrashKeyArenaTest, Full) {
+  CrashKeyArena arena;
+  for (size_t i = 0; i < CrashKeyArena::kMaxCrashKeys; ++i)
+    ASSERT_TRUE(arena.Allocate("key", CrashKeySize::Size32));
+  EXPECT_FALSE(arena.Allocate("key", CrashKeySize::Size32));
+}
+
+TEST(CrashKeyArenaTest, CrashLogging) {
+  auto arena = std::make_unique<CrashKeyArena>();
+  CrashKeyArena* crash_keys = arena.get();
+  SetCrashKeyImplementation(std::move(arena));
+  {
+    SCOPED_CRASH_KEY_NUMBER("category", "int-value", 1);
+    EXPECT_THAT(GetCrashKeys(*crash_keys),
+                ElementsAre(Pair("category-int-value", "1")));
+  }
+  EXPECT_THAT(GetCrashKeys(*crash_keys), IsEmpty());
+  SetCrashKeyImplementation(nullptr);
+}
+
+// Readers never see a value torn by concurrent writers.
+TEST(CrashKeyArenaTest, ConcurrentWrites) {
+  CrashKeyArena arena;
+  CrashKeyString* crash_key = arena.Allocate("key", CrashKeySize::Size256);
+  std::atomic<bool> stop{false};
+  CrashKeyWriter writer_a(&arena, crash_key, 'a', &stop);
+  CrashKeyWriter writer_b(&arena, crash_key, 'b', &stop);
+  writer_a.Start();
+  writer_b.Start();
+
+  for (int i = 0; i < 10000; ++i) {
+    for (const auto& entry : GetCrashKeys(arena)) {
+      const std::string& value = entry.second;
+      ASSERT_EQ(std::string(value.size(), value[0]), value);
+    }
+  }
+
+  stop.store(true, std::memory_order_relaxed);
+  writer_a.Join();
+  writer_b.Join();
+}
+
+}  // namespace debug
+}  // namespace base
@@ -7,19 +7,141 @@
 #include <fcntl.h>
 #include <stddef.h>
 
+#include <algorithm>
+#include <limits>
+
 #include "base/files/file_util.h"
 #include "base/files/scoped_file.h"
 #include "base/logging.h"
-#include "base/strings/string_split.h"
+#include "base/strings/string_util.h"
 #include "build/build_config.h"
 
-#if BUILDFLAG(IS_LINUX) || BUILDFLAG(IS_CHROMEOS) || BUILDFLAG(IS_ANDROID)
-#include <inttypes.h>
-#endif
-
 namespace base {
 namespace debug {
 
+namespace {
+
+// Removes the number in base |base| at the start of |*input|, and stores it in
+// |*value|. Returns false if there is none, or if it doesn't fit.
+bool ConsumeNumber(StringPiece* input, int base, uint64_t* value) {
+  uint64_t result = 0;
+  size_t i = 0;
+  for (; i < input->size(); ++i) {
+    const char c = (*input)[i];
+    if (base == 16 ? !IsHexDigit(c) : !IsAsciiDigit(c))
+      break;
+    const int digit = HexDigitToInt(c);
+    if (result > (std::numeric_limits<uint64_t>::max() - digit) / base)
+      return false;
+    result = result * base + digit;
+  }
+  if (i == 0)
+    return false;
+  input->remove_prefix(i);
+  *value = result;
+  return true;
+}
+
+// Removes |delimiter| from the start of |*input|, and if it's a space, the
+// spaces following it. Returns false if |*input| doesn't start with it.
+bool ConsumeDelimiter(StringPiece* input, char delimiter) {
+  if (input->empty() || input->front() != delimiter)
+    return false;
+  input->remove_prefix(
+      delimiter == ' ' ? std::min(input->find_first_not_of(' '), input->size())
+                       : 1);
+  return true;
+}
+
+// Parses a line of /proc/<pid>/maps, without its newline, into |*region|,
+// whose path points into |line|.
+//
+// Sample format from man 5 proc:
+//
+// address           perms offset  dev   inode   pathname
+// 08048000-08056000 r-xp 00000000 03:0c 64593   /usr/sbin/gpm
+bool ParseProcMapsLine(StringPiece line, ProcMapsTable::Region* region) {
+  uint64_t start, end, offset, dev_major, dev_minor, inode;
+  if (!ConsumeNumber(&line, 16, &start) || !ConsumeDelimiter(&line, '-') ||
+      !ConsumeNumber(&line, 16, &end) || !ConsumeDelimiter(&line, ' ') ||
+      line.size() < 4) {
+    return false;
+  }
+  const StringPiece permissions = line.substr(0, 4);
+  line.remove_prefix(4);
+  if (!ConsumeDelimiter(&line, ' ') || !ConsumeNumber(&line, 16, &offset) ||
+      !ConsumeDelimiter(&line, ' ') || !ConsumeNumber(&line, 16, &dev_major) ||
+      !ConsumeDelimiter(&line, ':') || !ConsumeNumber(&line, 16, &dev_minor) ||
+      !ConsumeDelimiter(&line, ' ') || !ConsumeNumber(&line, 10, &inode)) {
+    return false;
+  }
+  // The path is optional.
+  if (!line.empty() && !ConsumeDelimiter(&line, ' '))
+    return false;
+  if (start > std::numeric_limits<uintptr_t>::max() ||
+      end > std::numeric_limits<uintptr_t>::max()) {
+    return false;
+  }
+
+  region->start = static_cast<uintptr_t>(start);
+  region->end = static_cast<uintptr_t>(end);
+  region->offset = offset;
+  region->inode = inode;
+  region->permissions = 0;
+  region->path = line;
+
+  if (permissions[0] == 'r')
+    region->permissions |= MappedMemoryRegion::READ;
+  else if (permissions[0] != '-')
+    return false;
+
+  if (permissions[1] == 'w')
+    region->permissions |= MappedMemoryRegion::WRITE;
+  else if (permissions[1] != '-')
+    return false;
+
+  if (permissions[2] == 'x')
+    region->permissions |= MappedMemoryRegion::EXECUTE;
+  else if (permissions[2] != '-')
+    return false;
+
+  if (permissions[3] == 'p')
+    region->permissions |= MappedMemoryRegion::PRIVATE;
+  else if (permissions[3] != 's' && permissions[3] != 'S')  // Shared memory.
+    return false;
+
+  return true;
+}
+
+// Parses the lines of |input|, and calls |on_region| with the region of each.
+// Returns false if one of them can't be parsed. The lines are trimmed of their
+// whitespace, and the input must end with a newline.
+template <typename OnRegion>
+bool ParseProcMapsLines(StringPiece input, OnRegion on_region) {
+  while (true) {
+    const size_t newline = input.find('\n');
+    const StringPiece line =
+        TrimWhitespaceASCII(input.substr(0, newline), TRIM_ALL);
+    if (newline == StringPiece::npos) {
+      if (!line.empty()) {
+        DLOG(WARNING) << "Last line not empty";
+        return false;
+      }
+      return true;
+    }
+    input.remove_prefix(newline + 1);
+
+    ProcMapsTable::Region region;
+    if (!ParseProcMapsLine(line, &region)) {
+      DLOG(WARNING) << "Couldn't parse line: " << line;
+      return false;
+    }
+    on_region(region);
+  }
+}
+
+}  // namespace
+
 // Scans |proc_maps| starting from |pos| returning true if the gate VMA was
 // found, otherwise returns false.
 static bool ContainsGateVMA(std::string* proc_maps, size_t pos) {
@@ -87,75 +209,70 @@ bool ParseProcMaps(const std::string& input,
                    std::vector<MappedMemoryRegion>* regions_out) {
   CHECK(regions_out);
   std::vector<MappedMemoryRegion> regions;
+  if (!ParseProcMapsLines(input, [&regions](
+                                     const ProcMapsTable::Region& parsed) {
+        MappedMemoryRegion region;
+        region.start = parsed.start;
+        region.end = parsed.end;
+        region.offset = parsed.offset;
+        region.permissions = parsed.permissions;
+        // Pushing then assigning saves us a string copy.
+        regions.push_back(region);
+        regions.back().path.assign(parsed.path.data(), parsed.path.size());
+      })) {
+    return false;
+  }
+  regions_out->swap(regions);
+  return true;
+}
 
-  // This isn't async safe nor terribly efficient, but it doesn't need to be at
-  // this point in time.
-  std::vector<std::string> lines = SplitString(
-      input, "\n", base::TRIM_WHITESPACE, base::SPLIT_WANT_ALL);
-
-  for (size_t i = 0; i < lines.size(); ++i) {
-    // Due to splitting on '\n' the last line should be empty.
-    if (i == lines.size() - 1) {
-      if (!lines[i].empty()) {
-        DLOG(WARNING) << "Last line not empty";
-        return false;
-      }
-      break;
-    }
-
-    MappedMemoryRegion region;
-    const char* line = lines[i].c_str();
-    char permissions[5] = {'\0'};  // Ensure NUL-terminated string.
-    uint8_t dev_major = 0;
-    uint8_t dev_minor = 0;
-    long inode = 0;
-    int path_index = 0;
-
-    // Sample format from man 5 proc:
-    //
-    // address           perms offset  dev   inode   pathname
-    // 08048000-08056000 r-xp 00000000 03:0c 64593   /usr/sbin/gpm
-    //
-    // The final %n term captures the offset in the input string, which is used
-    // to determine the path name. It *does not* increment the return value.
-    // Refer to man 3 sscanf for details.
-    if (sscanf(line, "%" SCNxPTR "-%" SCNxPTR " %4c %llx %hhx:%hhx %ld %n",
-               &region.start, &region.end, permissions, &region.offset,
-               &dev_major, &dev_minor, &inode, &path_index) < 7) {
-      DPLOG(WARNING) << "sscanf failed for line: " << line;
-      return false;
-    }
-
-    region.permissions = 0;
-
-    if (permissions[0] == 'r')
-      region.permissions |= MappedMemoryRegion::READ;
-    else if (permissions[0] != '-')
-      return false;
+ProcMapsTable::ProcMapsTable() = default;
 
-    if (permissions[1] == 'w')
-      region.permissions |= MappedMemoryRegion::WRITE;
-    else if (permissions[1] != '-')
-      return false;
+ProcMapsTable::~ProcMapsTable() = default;
 
-    if (permissions[2] == 'x')
-      region.permissions |= MappedMemoryRegion::EXECUTE;
-    else if (permissions[2] != '-')
-      return false;
+bool ProcMapsTable::Update() {
+  // |next_proc_maps_| keeps its capacity, so that reading doesn't allocate
+  // once the table has been updated a few times.
+  return ReadProcMaps(&next_proc_maps_) && Update(next_proc_maps_);
+}
 
-    if (permissions[3] == 'p')
-      region.permissions |= MappedMemoryRegion::PRIVATE;
-    else if (permissions[3] != 's' && permissions[3] != 'S')  // Shared memory.
-      return false;
+bool ProcMapsTable::Update(StringPiece proc_maps) {
+  if (proc_maps == proc_maps_)
+    return true;
 
-    // Pushing then assigning saves us a string copy.
-    regions.push_back(region);
-    regions.back().path.assign(line + path_index);
+  next_regions_.clear();
+  if (!ParseProcMapsLines(proc_maps, [this](Region region) {
+        auto it = paths_.find(region.path);
+        if (it == paths_.end())
+          it = paths_.emplace(region.path.data(), region.path.size()).first;
+        region.path = *it;
+        next_regions_.push_back(region);
+      })) {
+    return false;
   }
+  // /proc/self/maps is sorted by address, unless it changed while it was read.
+  auto by_start = [](const Region& a, const Region& b) {
+    return a.start < b.start;
+  };
+  if (!std::is_sorted(next_regions_.begin(), next_regions_.end(), by_start))
+    std::sort(next_regions_.begin(), next_regions_.end(), by_start);
 
-  regions_out->swap(regions);
+  regions_.swap(next_regions_);
+  proc_maps_.assign(proc_maps.data(), proc_maps.size());
+  ++generation_;
   return true;
 }
 
+const ProcMapsTable::Region* ProcMapsTable::FindRegion(
+    uintptr_t address) const {
+  auto it = std::upper_bound(regions_.begin(), regions_.end(), address,
+                             [](uintptr_t address, const Region& region) {
+                               return address < region.start;
+                             });
+  if (it == regions_.begin() || address >= std::prev(it)->end)
+    return nullptr;
+  return &*std::prev(it);
+}
+
 }  // namespace debug
 }  // namespace base
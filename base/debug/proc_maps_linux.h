@@ -7,10 +7,13 @@
 
 #include <stdint.h>
 
+#include <functional>
+#include <set>
 #include <string>
 #include <vector>
 
 #include "base/base_export.h"
+#include "base/strings/string_piece.h"
 
 namespace base {
 namespace debug {
@@ -88,6 +91,72 @@ BASE_EXPORT bool ReadProcMaps(std::string* proc_maps);
 BASE_EXPORT bool ParseProcMaps(const std::string& input,
                                std::vector<MappedMemoryRegion>* regions);
 
+// A table of the regions of /proc/self/maps, for the callers which look up
+// addresses in it again and again. Update() reads the file again, but only
+// parses it if it changed since the last time, and the paths are interned:
+// looking up an address doesn't allocate, and updating the table only
+// allocates for the regions which are new.
+//
+// Not thread-safe.
+class BASE_EXPORT ProcMapsTable {
+ public:
+  struct Region {
+    // The address range [start,end) of mapped memory.
+    uintptr_t start;
+    uintptr_t end;
+
+    // Byte offset into |path| of the range mapped into memory.
+    unsigned long long offset;
+
+    // The inode of |path| on its device, or 0 for anonymous memory.
+    uint64_t inode;
+
+    // Bitmask of MappedMemoryRegion::Permission.
+    uint8_t permissions;
+
+    // Name of the file mapped into memory, with the same caveats as
+    // MappedMemoryRegion::path. Valid for the lifetime of the table.
+    StringPiece path;
+  };
+
+  ProcMapsTable();
+  ProcMapsTable(const ProcMapsTable&) = delete;
+  ProcMapsTable& operator=(const ProcMapsTable&) = delete;
+  ~ProcMapsTable();
+
+  // Reads /proc/self/maps, and parses it if it changed since the last update.
+  // Returns false, and leaves the table as it was, if it can't be read or
+  // parsed. See ReadProcMaps() for why the table may not be exact.
+  bool Update();
+
+  // Same as Update(), from |proc_maps|, the contents of a maps file.
+  bool Update(StringPiece proc_maps);
+
+  // Returns the region holding |address|, or null.
+  const Region* FindRegion(uintptr_t address) const;
+
+  // The regions, sorted by address.
+  const std::vector<Region>& regions() const { return regions_; }
+
+  // Incremented each time an update changes the table, for the callers which
+  // cache what they found in it.
+  uint64_t generation() const { return generation_; }
+
+ private:
+  // The contents the table was parsed from, and a buffer for the next read.
+  std::string proc_maps_;
+  std::string next_proc_maps_;
+
+  std::vector<Region> regions_;
+  std::vector<Region> next_regions_;
+
+  // The paths of all the regions seen so far. The nodes of a set don't move,
+  // so the Regions can point to them.
+  std::set<std::string, std::less<>> paths_;
+
+  uint64_t generation_ = 0;
+};
+
 }  // namespace debug
 }  // namespace base
 
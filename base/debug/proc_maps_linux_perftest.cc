@@ -0,0 +1,102 @@
+// Copyright 2022 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include <string>
+#include <vector>
+
+#include "base/debug/proc_maps_linux.h"
+#include "base/time/time.h"
+#include "testing/gtest/include/gtest/gtest.h"
+#include "testing/perf/perf_result_reporter.h"
+
+namespace base {
+namespace debug {
+
+namespace {
+
+constexpr int kUpdateCount = 1000;
+constexpr int kLookupCount = 1000000;
+
+constexpr char kMetricPrefixProcMaps[] = "ProcMaps.";
+constexpr char kMetricTimePerUpdate[] = "time_per_update";
+constexpr char kMetricTimePerLookup[] = "time_per_lookup";
+
+perf_test::PerfResultReporter SetUpReporter(const std::string& story_name) {
+  perf_test::PerfResultReporter reporter(kMetricPrefixProcMaps, story_name);
+  reporter.RegisterImportantMetric(kMetricTimePerUpdate, "us");
+  reporter.RegisterImportantMetric(kMetricTimePerLookup, "ns");
+  return reporter;
+}
+
+}  // namespace
+
+// Reading and parsing /proc/self/maps each time, against updating a table
+// from it, which is only parsed again when it changed.
+TEST(ProcMapsPerfTest, Update) {
+  TimeTicks start = TimeTicks::Now();
+  for (int i = 0; i < kUpdateCount; ++i) {
+    std::string proc_maps;
+    std::vector<MappedMemoryRegion> regions;
+    ASSERT_TRUE(ReadProcMaps(&proc_maps));
+    ASSERT_TRUE(ParseProcMaps(proc_maps, &regions));
+  }
+  SetUpReporter("read_and_parse")
+      .AddResult(kMetricTimePerUpdate,
+                 (TimeTicks::Now() - start).InMicrosecondsF() / kUpdateCount);
+
+  ProcMapsTable table;
+  start = TimeTicks::Now();
+  for (int i = 0; i < kUpdateCount; ++i)
+    ASSERT_TRUE(table.Update());
+  SetUpReporter("table_update")
+      .AddResult(kMetricTimePerUpdate,
+                 (TimeTicks::Now() - start).InMicrosecondsF() / kUpdateCount);
+}
+
+// Looking up the addresses of the regions in the vector ParseProcMaps()
+// returns, against in the table.
+TEST(ProcMapsPerfTest, Lookup) {
+  ProcMapsTable table;
+  ASSERT_TRUE(table.Update());
+  std::string proc_maps;
+  std::vector<MappedMemoryRegion> regions;
+  ASSERT_TRUE(ReadProcMaps(&proc_maps));
+  ASSERT_TRUE(ParseProcMaps(proc_maps, &regions));
+  ASSERT_FALSE(regions.empty());
+
+  size_t found = 0;
+  TimeTicks start = TimeTicks::Now();
+  for (int i = 0; i < kLookupCount; ++i) {
+    const uintptr_t address = regions[i % regions.size()].start;
+    for (const MappedMemoryRegion& region : regions) {
+      if (address >= region.start && address < region.end) {
+        ++found;
+        break;
+      }
+    }
+  }
+  SetUpReporter("linear_search")
+      .AddResult(kMetricTimePerLookup,
+                 static_cast<double>(
+                     (TimeTicks::Now() - start).InNanoseconds()) /
+                     kLookupCount);
+
+  start = TimeTicks::Now();
+  for (int i = 0; i < kLookupCount; ++i) {
+    if (table.FindRegion(regions[i % regions.size()].start))
+      ++found;
+  }
+  SetUpReporter("table_lookup")
+      .AddResult(kMetricTimePerLookup,
+                 static_cast<double>(
+                     (TimeTicks::Now() - start).InNanoseconds()) /
+                     kLookupCount);
+  EXPECT_EQ(2u * kLookupCount, found);
+}
+
+}  // namespace debug
+}  // namespace base
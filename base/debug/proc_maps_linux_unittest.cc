@@ -325,5 +325,97 @@ TEST(ProcMapsTest, ParseProcMapsWeirdCorrectInput) {
   EXPECT_EQ("[vsys call]", regions[4].path);
 }
 
+TEST(ProcMapsTableTest, FindRegion) {
+  static const char kContents[] =
+      "00400000-0040b000 r-xp 00000000 fc:00 794418 /bin/cat\n"
+      "0060a000-0060b000 rw-p 0000a000 fc:00 794418 /bin/cat\n"
+      "0060b000-0062c000 rw-p 00000000 00:00 0 [heap]\n"
+      "7fff9c7ff000-7fff9c800000 r-xp 00000000 00:00 0 [vdso]\n";
+
+  ProcMapsTable table;
+  ASSERT_TRUE(table.Update(kContents));
+  ASSERT_EQ(4u, table.regions().size());
+
+  EXPECT_EQ(nullptr, table.FindRegion(0x003fffff));
+  EXPECT_EQ(nullptr, table.FindRegion(0x0040b000));
+  EXPECT_EQ(nullptr, table.FindRegion(0x7fff9c800000));
+
+  const ProcMapsTable::Region* region = table.FindRegion(0x00400000);
+  ASSERT_TRUE(region);
+  EXPECT_EQ(0x00400000u, region->start);
+  EXPECT_EQ(0x0040b000u, region->end);
+  EXPECT_EQ(794418u, region->inode);
+  EXPECT_EQ("/bin/cat", region->path);
+
+  region = table.FindRegion(0x0060afff);
+  ASSERT_TRUE(region);
+  EXPECT_EQ(0x0000a000u, region->offset);
+  EXPECT_EQ(MappedMemoryRegion::READ | MappedMemoryRegion::WRITE |
+                MappedMemoryRegion::PRIVATE,
+            region->permissions);
+
+  region = table.FindRegion(0x0060b000);
+  ASSERT_TRUE(region);
+  EXPECT_EQ(0u, region->inode);
+  EXPECT_EQ("[heap]", region->path);
+
+  // The regions of the same file share its path.
+  EXPECT_EQ(table.regions()[0].path.data(), table.regions()[1].path.data());
+}
+
+TEST(ProcMapsTableTest, Update) {
+  static const char kContents[] =
+      "00400000-0040b000 r-xp 00000000 fc:00 794418 /bin/cat\n";
+  static const char kNewContents[] =
+      "00400000-0040b000 r-xp 00000000 fc:00 794418 /bin/cat\n"
+      "7f53b7dad000-7f53b7f62000 r-xp 00000000 fc:00 263011 /lib/libc.so\n";
+
+  ProcMapsTable table;
+  EXPECT_EQ(0u, table.generation());
+  ASSERT_TRUE(table.Update(kContents));
+  EXPECT_EQ(1u, table.generation());
+  const char* const path = table.regions()[0].path.data();
+
+  // The table is only parsed again if the contents changed.
+  ASSERT_TRUE(table.Update(kContents));
+  EXPECT_EQ(1u, table.generation());
+
+  ASSERT_TRUE(table.Update(kNewContents));
+  EXPECT_EQ(2u, table.generation());
+  ASSERT_EQ(2u, table.regions().size());
+  EXPECT_EQ(path, table.regions()[0].path.data());
+  EXPECT_EQ("/lib/libc.so", table.FindRegion(0x7f53b7dad000)->path);
+
+  // The table is left as it was if the contents can't be parsed.
+  EXPECT_FALSE(table.Update("00400000-0040b000 r-xp\n"));
+  EXPECT_EQ(2u, table.generation());
+  EXPECT_EQ(2u, table.regions().size());
+}
+
+TEST(ProcMapsTableTest, UpdateUnsorted) {
+  static const char kContents[] =
+      "7f53b7dad000-7f53b7f62000 r-xp 00000000 fc:00 263011 /lib/libc.so\n"
+      "00400000-0040b000 r-xp 00000000 fc:00 794418 /bin/cat\n";
+
+  ProcMapsTable table;
+  ASSERT_TRUE(table.Update(kContents));
+  ASSERT_EQ(2u, table.regions().size());
+  EXPECT_EQ("/bin/cat", table.regions()[0].path);
+  EXPECT_EQ("/bin/cat", table.FindRegion(0x00400000)->path);
+  EXPECT_EQ("/lib/libc.so", table.FindRegion(0x7f53b7dad000)->path);
+}
+
+TEST(ProcMapsTableTest, UpdateFromProcSelfMaps) {
+  ProcMapsTable table;
+  ASSERT_TRUE(table.Update());
+  ASSERT_FALSE(table.regions().empty());
+
+  const ProcMapsTable::Region* region =
+      table.FindRegion(reinterpret_cast<uintptr_t>(&ParseProcMaps));
+  ASSERT_TRUE(region);
+  EXPECT_TRUE(region->permissions & MappedMemoryRegion::EXECUTE);
+  EXPECT_NE(0u, region->inode);
+}
+
 }  // namespace debug
 }  // namespace base
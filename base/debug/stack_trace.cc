@@ -204,15 +204,41 @@ uintptr_t GetStackEnd() {
 #else
 
 #if (BUILDFLAG(IS_LINUX) || BUILDFLAG(IS_CHROMEOS)) && defined(__GLIBC__)
+  // CollectStackTrace() gets the end of the stack for every trace, so it's
+  // cached for the thread.
+  thread_local uintptr_t stack_end = 0;
+  thread_local bool is_getting_stack_end = false;
+  if (stack_end || is_getting_stack_end)
+    return stack_end;
+
   if (GetCurrentProcId() == PlatformThread::CurrentId()) {
     // For the main thread we have a shortcut.
-    return reinterpret_cast<uintptr_t>(__libc_stack_end);
+    stack_end = reinterpret_cast<uintptr_t>(__libc_stack_end);
+    return stack_end;
   }
-#endif
 
+  // glibc's pthread_getattr_np() allocates, and the allocator hooks may trace
+  // the stack: they don't get the end of the stack meanwhile.
+  is_getting_stack_end = true;
+  uintptr_t stack_begin = 0;
+  size_t stack_size = 0;
+  pthread_attr_t attributes;
+  if (!pthread_getattr_np(pthread_self(), &attributes)) {
+    if (!pthread_attr_getstack(&attributes,
+                               reinterpret_cast<void**>(&stack_begin),
+                               &stack_size)) {
+      stack_end = stack_begin + stack_size;
+    }
+    pthread_attr_destroy(&attributes);
+  }
+  is_getting_stack_end = false;
+  return stack_end;
+#else
   // Don't know how to get end of the stack.
   return 0;
 #endif
+
+#endif
 }
 #endif  // BUILDFLAG(CAN_UNWIND_WITH_FRAME_POINTERS)
 
@@ -0,0 +1,362 @@
+// Copyright 2022 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "base/debug/stack_trace_symbolizer_linux.h"
+
+#include <cxxabi.h>
+#include <elf.h>
+#include <inttypes.h>
+#include <link.h>
+#include <string.h>
+
+#include <algorithm>
+#include <utility>
+
+#include "base/check.h"
+#include "base/debug/stack_trace.h"
+#include "base/files/file_path.h"
+#include "base/files/memory_mapped_file.h"
+#include "base/memory/free_deleter.h"
+#include "base/memory/ptr_util.h"
+#include "base/strings/string_util.h"
+#include "base/strings/stringprintf.h"
+#include "build/build_config.h"
+
+#if defined(USE_SYMBOLIZE) && BUILDFLAG(ENABLE_STACK_TRACE_LINE_NUMBERS)
+#include "base/debug/dwarf_line_no.h"
+#endif
+
+namespace base {
+namespace debug {
+
+namespace {
+
+#if __SIZEOF_POINTER__ == 4
+constexpr unsigned char kElfClass = ELFCLASS32;
+#else
+constexpr unsigned char kElfClass = ELFCLASS64;
+#endif
+
+// The ELF symbol types of functions.
+constexpr unsigned char kFunctionSymbolTypes[] = {STT_FUNC, STT_GNU_IFUNC};
+
+// Returns the object of type T at |offset| in |data|, or null if it doesn't fit
+// in |data| or isn't aligned.
+template <typename T>
+const T* GetObjectAt(span<const uint8_t> data, uint64_t offset) {
+  if (offset > data.size() || data.size() - offset < sizeof(T) ||
+      (reinterpret_cast<uintptr_t>(data.data()) + offset) % alignof(T) != 0) {
+    return nullptr;
+  }
+  return reinterpret_cast<const T*>(data.data() + offset);
+}
+
+// Returns the |count| objects of type T at |offset| in |data|, or an empty
+// span if they don't fit in |data| or aren't aligned.
+template <typename T>
+span<const T> GetObjectsAt(span<const uint8_t> data,
+                           uint64_t offset,
+                           uint64_t count) {
+  if (count == 0 || offset > data.size() ||
+      (data.size() - offset) / sizeof(T) < count ||
+      (reinterpret_cast<uintptr_t>(data.data()) + offset) % alignof(T) != 0) {
+    return span<const T>();
+  }
+  return make_span(reinterpret_cast<const T*>(data.data() + offset),
+                   static_cast<size_t>(count));
+}
+
+std::string Demangle(const char* name) {
+  int status = 0;
+  std::unique_ptr<char, FreeDeleter> demangled(
+      abi::__cxa_demangle(name, nullptr, nullptr, &status));
+  return status == 0 && demangled ? std::string(demangled.get())
+                                  : std::string(name);
+}
+
+}  // namespace
+
+// The function symbols of an ELF file, memory-mapped once.
+class StackTraceSymbolizer::Module {
+ public:
+  // Returns the module of the ELF file at |path|, or null if it can't be read
+  // or has no function symbols.
+  static std::unique_ptr<Module> Open(const std::string& path) {
+    auto module = WrapUnique(new Module);
+    if (!module->file_.Initialize(FilePath(path)) || !module->ReadSymbols())
+      return nullptr;
+    return module;
+  }
+
+  Module(const Module&) = delete;
+  Module& operator=(const Module&) = delete;
+  ~Module() = default;
+
+  // Returns the difference between the addresses of |region|, which maps this
+  // file, and the virtual addresses of the file. Returns false if the mapped
+  // range isn't in a loadable segment.
+  bool GetLoadBias(const MappedMemoryRegion& region, uintptr_t* bias) const {
+    for (const ElfW(Phdr)& phdr : program_headers_) {
+      if (phdr.p_type == PT_LOAD && phdr.p_offset <= region.offset &&
+          region.offset - phdr.p_offset < phdr.p_filesz) {
+        *bias = region.start -
+                static_cast<uintptr_t>(phdr.p_vaddr +
+                                       (region.offset - phdr.p_offset));
+        return true;
+      }
+    }
+    return false;
+  }
+
+  // Returns the name of the function holding the virtual address |address|
+  // and sets |*start| to its address, or returns null.
+  const char* FindFunction(uintptr_t address, uintptr_t* start) const {
+    auto it = std::upper_bound(symbols_.begin(), symbols_.end(), address,
+                               [](uintptr_t address, const Symbol& symbol) {
+                                 return address < symbol.address;
+                               });
+    if (it == symbols_.begin())
+      return nullptr;
+    --it;
+    if (address - it->address >= it->size)
+      return nullptr;
+    *start = it->address;
+    return it->name;
+  }
+
+ private:
+  struct Symbol {
+    uintptr_t address;
+    uintptr_t size;
+    const char* name;
+  };
+
+  Module() = default;
+
+  // Reads the program headers, and the function symbols of the .symtab
+  // section, or else of the .dynsym section.
+  bool ReadSymbols() {
+    const span<const uint8_t> data(file_.data(), file_.length());
+    const ElfW(Ehdr)* ehdr = GetObjectAt<ElfW(Ehdr)>(data, 0);
+    if (!ehdr || memcmp(ehdr->e_ident, ELFMAG, SELFMAG) != 0 ||
+        ehdr->e_ident[EI_CLASS] != kElfClass ||
+        ehdr->e_phentsize != sizeof(ElfW(Phdr)) ||
+        ehdr->e_shentsize != sizeof(ElfW(Shdr))) {
+      return false;
+    }
+    program_headers_ =
+        GetObjectsAt<ElfW(Phdr)>(data, ehdr->e_phoff, ehdr->e_phnum);
+    const span<const ElfW(Shdr)> section_headers =
+        GetObjectsAt<ElfW(Shdr)>(data, ehdr->e_shoff, ehdr->e_shnum);
+
+    const ElfW(Shdr)* symbol_table = nullptr;
+    for (const ElfW(Shdr)& shdr : section_headers) {
+      if (shdr.sh_type == SHT_SYMTAB ||
+          (shdr.sh_type == SHT_DYNSYM && !symbol_table)) {
+        symbol_table = &shdr;
+      }
+    }
+    if (!symbol_table || symbol_table->sh_link >= section_headers.size())
+      return false;
+    const ElfW(Shdr)& string_table = section_headers[symbol_table->sh_link];
+    if (string_table.sh_offset > data.size() ||
+        data.size() - string_table.sh_offset < string_table.sh_size) {
+      return false;
+    }
+    const char* strings =
+        reinterpret_cast<const char*>(data.data() + string_table.sh_offset);
+
+    for (const ElfW(Sym)& sym : GetObjectsAt<ElfW(Sym)>(
+             data, symbol_table->sh_offset,
+             symbol_table->sh_size / sizeof(ElfW(Sym)))) {
+      if (!std::count(std::begin(kFunctionSymbolTypes),
+                      std::end(kFunctionSymbolTypes),
+                      ELF64_ST_TYPE(sym.st_info)) ||
+          sym.st_shndx == SHN_UNDEF || sym.st_size == 0 ||
+          sym.st_name >= string_table.sh_size ||
+          !memchr(strings + sym.st_name, '\0',
+                  string_table.sh_size - sym.st_name)) {
+        continue;
+      }
+      symbols_.push_back({static_cast<uintptr_t>(sym.st_value),
+                          static_cast<uintptr_t>(sym.st_size),
+                          strings + sym.st_name});
+    }
+    std::sort(symbols_.begin(), symbols_.end(),
+              [](const Symbol& a, const Symbol& b) {
+                return a.address < b.address;
+              });
+    return !symbols_.empty();
+  }
+
+  MemoryMappedFile file_;
+
+  // Point into |file_|.
+  span<const ElfW(Phdr)> program_headers_;
+  std::vector<Symbol> symbols_;
+};
+
+StackTraceSymbolizer::Frame::Frame() = default;
+StackTraceSymbolizer::Frame::Frame(const Frame&) = default;
+StackTraceSymbolizer::Frame::Frame(Frame&&) = default;
+StackTraceSymbolizer::Frame& StackTraceSymbolizer::Frame::operator=(
+    const Frame&) = default;
+StackTraceSymbolizer::Frame& StackTraceSymbolizer::Frame::operator=(Frame&&) =
+    default;
+StackTraceSymbolizer::Frame::~Frame() = default;
+
+StackTraceSymbolizer::StackTraceSymbolizer(size_t cache_size)
+    : cache_(cache_size) {}
+
+StackTraceSymbolizer::~StackTraceSymbolizer() = default;
+
+std::vector<StackTraceSymbolizer::Frame> StackTraceSymbolizer::Symbolize(
+    span<const void* const> addresses) {
+  std::vector<Frame> frames;
+  frames.reserve(addresses.size());
+  std::vector<size_t> missed_indices;
+
+  AutoLock auto_lock(lock_);
+  bool has_read_memory_regions = false;
+  for (size_t i = 0; i < addresses.size(); ++i) {
+    const uintptr_t address = reinterpret_cast<uintptr_t>(addresses[i]);
+    auto it = cache_.Get(address);
+    if (it != cache_.end()) {
+      ++cache_hit_count_;
+      frames.push_back(it->second);
+      continue;
+    }
+    ++cache_miss_count_;
+    frames.push_back(SymbolizeAddress(address, &has_read_memory_regions));
+    missed_indices.push_back(i);
+  }
+
+#if defined(USE_SYMBOLIZE) && BUILDFLAG(ENABLE_STACK_TRACE_LINE_NUMBERS)
+  // The compile units of the missed addresses are found in one pass over the
+  // debug info of each module.
+  if (!missed_indices.empty()) {
+    std::vector<void*> missed_addresses;
+    for (size_t i : missed_indices)
+      missed_addresses.push_back(const_cast<void*>(addresses[i]));
+    std::vector<uint64_t> cu_offsets(missed_addresses.size());
+    GetDwarfCompileUnitOffsets(missed_addresses.data(), cu_offsets.data(),
+                               missed_addresses.size());
+    char buf[1024];
+    for (size_t j = 0; j < missed_indices.size(); ++j) {
+      if (!cu_offsets[j])
+        continue;
+      void* pc = static_cast<char*>(missed_addresses[j]) - 1;
+      if (GetDwarfSourceLineNumber(pc, cu_offsets[j], buf, sizeof(buf)))
+        frames[missed_indices[j]].source_location = buf;
+    }
+  }
+#endif
+
+  for (size_t i : missed_indices)
+    cache_.Put(reinterpret_cast<uintptr_t>(addresses[i]), frames[i]);
+  return frames;
+}
+
+std::string StackTraceSymbolizer::StackTraceToString(const StackTrace& trace) {
+  size_t count = 0;
+  const void* const* addresses = trace.Addresses(&count);
+  const std::vector<Frame> frames = Symbolize(make_span(addresses, count));
+  std::string output;
+  for (size_t i = 0; i < count; ++i) {
+    StringAppendF(&output, "#%zu 0x%012" PRIxPTR " ", i,
+                  reinterpret_cast<uintptr_t>(addresses[i]));
+    const Frame& frame = frames[i];
+    output.append(frame.function_name.empty() ? "<unknown>"
+                                              : frame.function_name);
+    if (!frame.source_location.empty())
+      StringAppendF(&output, " [%s]", frame.source_location.c_str());
+    output.push_back('\n');
+  }
+  return output;
+}
+
+size_t StackTraceSymbolizer::cache_hit_count() const {
+  AutoLock auto_lock(lock_);
+  return cache_hit_count_;
+}
+
+size_t StackTraceSymbolizer::cache_miss_count() const {
+  AutoLock auto_lock(lock_);
+  return cache_miss_count_;
+}
+
+void StackTraceSymbolizer::ReadMemoryRegions() {
+  std::string proc_maps;
+  std::vector<MappedMemoryRegion> regions;
+  if (!ReadProcMaps(&proc_maps) || !ParseProcMaps(proc_maps, &regions))
+    return;
+  regions_.clear();
+  for (MappedMemoryRegion& region : regions) {
+    // Only the executable regions of files hold functions. The pseudo-paths,
+    // like [vdso], and the deleted files are skipped.
+    if (!(region.permissions & MappedMemoryRegion::EXECUTE) ||
+        region.path.empty() || region.path[0] == '[' ||
+        EndsWith(region.path, " (deleted)", CompareCase::SENSITIVE)) {
+      continue;
+    }
+    regions_.push_back(std::move(region));
+  }
+  // /proc/self/maps is sorted by address.
+  DCHECK(std::is_sorted(regions_.begin(), regions_.end(),
+                        [](const MappedMemoryRegion& a,
+                           const MappedMemoryRegion& b) {
+                          return a.start < b.start;
+                        }));
+}
+
+const MappedMemoryRegion* StackTraceSymbolizer::GetRegionForAddress(
+    uintptr_t address,
+    bool* has_read_memory_regions) {
+  while (true) {
+    auto it = std::upper_bound(
+        regions_.begin(), regions_.end(), address,
+        [](uintptr_t address, const MappedMemoryRegion& region) {
+          return address < region.start;
+        });
+    if (it != regions_.begin() && address < std::prev(it)->end)
+      return &*std::prev(it);
+    if (*has_read_memory_regions)
+      return nullptr;
+    *has_read_memory_regions = true;
+    ReadMemoryRegions();
+  }
+}
+
+StackTraceSymbolizer::Frame StackTraceSymbolizer::SymbolizeAddress(
+    uintptr_t address,
+    bool* has_read_memory_regions) {
+  Frame frame;
+  // The return address may be the first one after the function, when it ends
+  // with a call to a noreturn function.
+  const uintptr_t pc = address - 1;
+  const MappedMemoryRegion* region =
+      GetRegionForAddress(pc, has_read_memory_regions);
+  if (!region)
+    return frame;
+  frame.module_path = region->path;
+
+  auto it = modules_.find(region->path);
+  if (it == modules_.end())
+    it = modules_.emplace(region->path, Module::Open(region->path)).first;
+  const Module* module = it->second.get();
+  uintptr_t bias = 0;
+  if (!module || !module->GetLoadBias(*region, &bias))
+    return frame;
+
+  uintptr_t function_start = 0;
+  const char* function_name = module->FindFunction(pc - bias, &function_start);
+  if (!function_name)
+    return frame;
+  frame.function_name = Demangle(function_name);
+  frame.function_offset = address - (bias + function_start);
+  return frame;
+}
+
+}  // namespace debug
+}  // namespace base
@@ -0,0 +1,127 @@
+// Copyright 2022 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#ifndef BASE_DEBUG_STACK_TRACE_SYMBOLIZER_LINUX_H_
+#define BASE_DEBUG_STACK_TRACE_SYMBOLIZER_LINUX_H_
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include <map>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "base/base_export.h"
+#include "base/containers/lru_cache.h"
+#include "base/containers/span.h"
+#include "base/debug/proc_maps_linux.h"
+#include "base/synchronization/lock.h"
+#include "base/thread_annotations.h"
+
+namespace base {
+namespace debug {
+
+class StackTrace;
+
+// Symbolizes the stack traces of the current process, for the crash and hang
+// reporters which symbolize many similar traces. Where StackTrace::ToString()
+// reads the symbol table of a module from its file for each frame, this
+// memory-maps the file of each module once, indexes its function symbols, and
+// keeps the frames it symbolized in an LRU cache: the frames shared by the
+// traces are only symbolized once.
+//
+// The symbol table is the .symtab section of the module, or its .dynsym
+// section if it was stripped. The separate debug files aren't read. The
+// source locations are only found when the line numbers of StackTrace are, see
+// ENABLE_STACK_TRACE_LINE_NUMBERS.
+//
+// Thread-safe. Unlike StackTrace::Print(), it allocates, so it can't be used
+// in a signal handler.
+//
+// Example:
+//   StackTraceSymbolizer symbolizer;
+//   for (const StackTrace& trace : traces)
+//     Report(symbolizer.StackTraceToString(trace));
+class BASE_EXPORT StackTraceSymbolizer {
+ public:
+  struct BASE_EXPORT Frame {
+    Frame();
+    Frame(const Frame&);
+    Frame(Frame&&);
+    Frame& operator=(const Frame&);
+    Frame& operator=(Frame&&);
+    ~Frame();
+
+    // The demangled name of the function, or empty if it wasn't found.
+    std::string function_name;
+
+    // The offset of the address from the start of the function.
+    uintptr_t function_offset = 0;
+
+    // The path of the module, or empty if the address isn't in a file mapped
+    // into memory.
+    std::string module_path;
+
+    // The source file, line and column, e.g.
+    // "../../base/debug/stack_trace_unittest.cc:120,16", or empty.
+    std::string source_location;
+  };
+
+  // The number of frames which are cached by default.
+  static constexpr size_t kDefaultCacheSize = 16 * 1024;
+
+  explicit StackTraceSymbolizer(size_t cache_size = kDefaultCacheSize);
+  StackTraceSymbolizer(const StackTraceSymbolizer&) = delete;
+  StackTraceSymbolizer& operator=(const StackTraceSymbolizer&) = delete;
+  ~StackTraceSymbolizer();
+
+  // Returns the frame of each of |addresses|, in order. The addresses are the
+  // return addresses of the frames, as StackTrace collects them: each is
+  // looked up one byte before, in its call instruction.
+  std::vector<Frame> Symbolize(span<const void* const> addresses);
+
+  // Returns |trace| in the format of StackTrace::ToString(), one frame per
+  // line.
+  std::string StackTraceToString(const StackTrace& trace);
+
+  // Returns how many of the addresses passed to Symbolize() were found in, and
+  // weren't found in, the cache.
+  size_t cache_hit_count() const;
+  size_t cache_miss_count() const;
+
+ private:
+  class Module;
+
+  // Reads the executable regions of /proc/self/maps into |regions_|.
+  void ReadMemoryRegions() EXCLUSIVE_LOCKS_REQUIRED(lock_);
+
+  // Returns the executable region holding |address|, or null. Reads
+  // /proc/self/maps again if it isn't found and |*has_read_memory_regions| is
+  // false, for the modules loaded since the last read, and sets it.
+  const MappedMemoryRegion* GetRegionForAddress(uintptr_t address,
+                                                bool* has_read_memory_regions)
+      EXCLUSIVE_LOCKS_REQUIRED(lock_);
+
+  // Returns the frame of |address|, without its source location.
+  Frame SymbolizeAddress(uintptr_t address, bool* has_read_memory_regions)
+      EXCLUSIVE_LOCKS_REQUIRED(lock_);
+
+  mutable Lock lock_;
+
+  // The executable regions of /proc/self/maps, sorted by address.
+  std::vector<MappedMemoryRegion> regions_ GUARDED_BY(lock_);
+
+  // The modules by path, or null for the files which couldn't be read.
+  std::map<std::string, std::unique_ptr<Module>> modules_ GUARDED_BY(lock_);
+
+  HashingLRUCache<uintptr_t, Frame> cache_ GUARDED_BY(lock_);
+  size_t cache_hit_count_ GUARDED_BY(lock_) = 0;
+  size_t cache_miss_count_ GUARDED_BY(lock_) = 0;
+};
+
+}  // namespace debug
+}  // namespace base
+
+#endif  // BASE_DEBUG_STACK_TRACE_SYMBOLIZER_LINUX_H_
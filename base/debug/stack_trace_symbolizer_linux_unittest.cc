@@ -0,0 +1,104 @@
+// Copyright 2022 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "base/debug/stack_trace_symbolizer_linux.h"
+
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "base/compiler_specific.h"
+#include "base/debug/stack_trace.h"
+#include "testing/gtest/include/gtest/gtest.h"
+
+namespace base {
+namespace debug {
+
+namespace {
+
+NOINLINE int SymbolizedFunction(int value) {
+  // Keeps the function from being folded into another one.
+  return value * 7 + 3;
+}
+
+NOINLINE std::string SymbolizeCurrentStack(StackTraceSymbolizer* symbolizer) {
+  return symbolizer->StackTraceToString(StackTrace());
+}
+
+// Returns the return address of a call to SymbolizedFunction(), as StackTrace
+// would collect it.
+const void* GetSymbolizedFunctionAddress() {
+  return reinterpret_cast<const char*>(&SymbolizedFunction) + 1;
+}
+
+}  // namespace
+
+TEST(StackTraceSymbolizerTest, SymbolizesFunction) {
+  StackTraceSymbolizer symbolizer;
+  const void* const addresses[] = {GetSymbolizedFunctionAddress()};
+  std::vector<StackTraceSymbolizer::Frame> frames =
+      symbolizer.Symbolize(addresses);
+  ASSERT_EQ(1u, frames.size());
+#if defined(OFFICIAL_BUILD)
+  // The symbols may be stripped from official builds.
+  return;
+#endif
+  EXPECT_NE(std::string::npos, frames[0].function_name.find(
+                                   "SymbolizedFunction(int)"))
+      << frames[0].function_name;
+  EXPECT_EQ(1u, frames[0].function_offset);
+  EXPECT_FALSE(frames[0].module_path.empty());
+}
+
+TEST(StackTraceSymbolizerTest, CachesFrames) {
+  StackTraceSymbolizer symbolizer;
+  const void* const addresses[] = {GetSymbolizedFunctionAddress(),
+                                   GetSymbolizedFunctionAddress()};
+  std::vector<StackTraceSymbolizer::Frame> frames =
+      symbolizer.Symbolize(make_span(addresses, 1u));
+  EXPECT_EQ(0u, symbolizer.cache_hit_count());
+  EXPECT_EQ(1u, symbolizer.cache_miss_count());
+
+  std::vector<StackTraceSymbolizer::Frame> cached_frames =
+      symbolizer.Symbolize(addresses);
+  EXPECT_EQ(2u, symbolizer.cache_hit_count());
+  EXPECT_EQ(1u, symbolizer.cache_miss_count());
+  ASSERT_EQ(2u, cached_frames.size());
+  EXPECT_EQ(frames[0].function_name, cached_frames[0].function_name);
+  EXPECT_EQ(frames[0].function_name, cached_frames[1].function_name);
+}
+
+TEST(StackTraceSymbolizerTest, UnknownAddress) {
+  StackTraceSymbolizer symbolizer;
+  auto heap_object = std::make_unique<int>(0);
+  const void* const addresses[] = {heap_object.get()};
+  std::vector<StackTraceSymbolizer::Frame> frames =
+      symbolizer.Symbolize(addresses);
+  ASSERT_EQ(1u, frames.size());
+  EXPECT_TRUE(frames[0].function_name.empty());
+  EXPECT_TRUE(frames[0].module_path.empty());
+}
+
+TEST(StackTraceSymbolizerTest, StackTraceToString) {
+  StackTraceSymbolizer symbolizer;
+  std::string traces[2];
+  size_t cache_miss_counts[2];
+  // The two traces are taken from the same call site, so they have the same
+  // frames.
+  for (int i = 0; i < 2; ++i) {
+    traces[i] = SymbolizeCurrentStack(&symbolizer);
+    cache_miss_counts[i] = symbolizer.cache_miss_count();
+  }
+  EXPECT_EQ(0u, traces[0].find("#0 0x")) << traces[0];
+  EXPECT_EQ(traces[0], traces[1]);
+  EXPECT_EQ(cache_miss_counts[0], cache_miss_counts[1]);
+#if defined(OFFICIAL_BUILD)
+  return;
+#endif
+  EXPECT_NE(std::string::npos, traces[0].find("SymbolizeCurrentStack"))
+      << traces[0];
+}
+
+}  // namespace debug
+}  // namespace base
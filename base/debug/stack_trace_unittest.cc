@@ -358,7 +358,8 @@ TEST_F(StackTraceTest, MAYBE_TraceStackFramePointersFromBuffer) {
   ExpectStackFramePointers<kDepth>(frames, kDepth, /*copy_stack=*/true);
 }
 
-#if BUILDFLAG(IS_ANDROID) || BUILDFLAG(IS_APPLE)
+#if BUILDFLAG(IS_ANDROID) || BUILDFLAG(IS_APPLE) || \
+    ((BUILDFLAG(IS_LINUX) || BUILDFLAG(IS_CHROMEOS)) && defined(__GLIBC__))
 #define MAYBE_StackEnd StackEnd
 #else
 #define MAYBE_StackEnd DISABLED_StackEnd
@@ -11,10 +11,12 @@
 #pragma clang max_tokens_here 545000
 #endif
 
+#include <atomic>
 #include <string>
 #include <tuple>
 
 #include <stddef.h>
+#include <stdint.h>
 
 #include "base/base_paths.h"
 #include "base/base_switches.h"
@@ -44,6 +46,15 @@ namespace {
 // have more control over initialization timing. Leaky.
 FeatureList* g_feature_list_instance = nullptr;
 
+// The caching context of the next FeatureList instance. Never 0, which marks
+// the features whose state isn't cached.
+std::atomic<uint32_t> g_next_caching_context{1};
+
+// The override state takes the 2 lower bits of Feature::cached_value.
+constexpr int kCachingContextShift = 2;
+constexpr uint32_t kOverrideStateMask = (1 << kCachingContextShift) - 1;
+constexpr uint32_t kMaxCachingContext = UINT32_MAX >> kCachingContextShift;
+
 // Tracks whether the FeatureList instance was initialized via an accessor, and
 // which Feature that accessor was for, if so.
 const Feature* g_initialized_from_accessor = nullptr;
@@ -520,6 +531,13 @@ void FeatureList::FinalizeInitialization() {
   DCHECK(!initialized_);
   // Store the field trial list pointer for DCHECKing.
   field_trial_list_ = FieldTrialList::GetInstance();
+  uint32_t caching_context;
+  do {
+    caching_context =
+        g_next_caching_context.fetch_add(1, std::memory_order_relaxed) &
+        kMaxCachingContext;
+  } while (!caching_context);
+  caching_context_ = caching_context;
   initialized_ = true;
 }
 
@@ -550,7 +568,20 @@ FeatureList::OverrideState FeatureList::GetOverrideState(
   DCHECK(IsValidFeatureOrFieldTrialName(feature.name)) << feature.name;
   DCHECK(CheckFeatureIdentity(feature)) << feature.name;
 
-  return GetOverrideStateByFeatureName(feature.name);
+  // The field trial, if any, was activated when the state was cached, and the
+  // overrides don't change once initialized.
+  const uint32_t cached_value =
+      feature.cached_value.load(std::memory_order_relaxed);
+  if (cached_value >> kCachingContextShift == caching_context_)
+    return static_cast<OverrideState>(cached_value & kOverrideStateMask);
+
+  const OverrideState state = GetOverrideStateByFeatureName(feature.name);
+  static_assert(OVERRIDE_ENABLE_FEATURE <= kOverrideStateMask,
+                "OverrideState doesn't fit in Feature::cached_value");
+  feature.cached_value.store(
+      caching_context_ << kCachingContextShift | static_cast<uint32_t>(state),
+      std::memory_order_relaxed);
+  return state;
 }
 
 FeatureList::OverrideState FeatureList::GetOverrideStateByFeatureName(
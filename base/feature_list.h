@@ -5,6 +5,9 @@
 #ifndef BASE_FEATURE_LIST_H_
 #define BASE_FEATURE_LIST_H_
 
+#include <stdint.h>
+
+#include <atomic>
 #include <functional>
 #include <map>
 #include <memory>
@@ -52,6 +55,11 @@ struct BASE_EXPORT Feature {
     }
 #endif  // BUILDFLAG(ENABLE_BANNED_BASE_FEATURE_PREFIX)
   }
+  // A copy doesn't share the cached state of |other|.
+  constexpr Feature(const Feature& other)
+      : name(other.name), default_state(other.default_state) {}
+  Feature& operator=(const Feature&) = delete;
+
   // The name of the feature. This should be unique to each feature and is used
   // for enabling/disabling features via command line flags and experiments.
   // It is strongly recommended to use CamelCase style for feature names, e.g.
@@ -62,6 +70,14 @@ struct BASE_EXPORT Feature {
   // NOTE: The actual runtime state may be different, due to a field trial or a
   // command line switch.
   const FeatureState default_state;
+
+ private:
+  friend class FeatureList;
+
+  // The override state resolved by the FeatureList whose caching context is
+  // in the upper bits, or 0, so that querying the feature again costs a single
+  // relaxed load.
+  mutable std::atomic<uint32_t> cached_value{0};
 };
 
 #if defined(DCHECK_IS_CONFIGURABLE)
@@ -469,6 +485,10 @@ class BASE_EXPORT FeatureList {
 
   // Whether this object has been initialized from command line.
   bool initialized_from_command_line_ = false;
+
+  // Distinguishes the states cached in the features by this object from those
+  // cached by the previous instances. Set by FinalizeInitialization().
+  uint32_t caching_context_ = 0;
 };
 
 }  // namespace base
@@ -103,6 +103,31 @@ TEST_F(FeatureListTest, InitializeFromCommandLine) {
   }
 }
 
+TEST_F(FeatureListTest, CachedStateFollowsInstance) {
+  auto enabling_feature_list = std::make_unique<FeatureList>();
+  enabling_feature_list->InitializeFromCommandLine(kFeatureOffByDefaultName,
+                                                   "");
+  auto disabling_feature_list = std::make_unique<FeatureList>();
+  disabling_feature_list->InitializeFromCommandLine("",
+                                                    kFeatureOffByDefaultName);
+
+  test::ScopedFeatureList scoped_feature_list;
+  scoped_feature_list.InitWithFeatureList(std::move(enabling_feature_list));
+  EXPECT_TRUE(FeatureList::IsEnabled(kFeatureOffByDefault));
+  EXPECT_TRUE(FeatureList::IsEnabled(kFeatureOffByDefault));
+
+  // The state cached with another instance isn't used.
+  std::unique_ptr<FeatureList> original_feature_list =
+      FeatureList::ClearInstanceForTesting();
+  FeatureList::SetInstance(std::move(disabling_feature_list));
+  EXPECT_FALSE(FeatureList::IsEnabled(kFeatureOffByDefault));
+  EXPECT_FALSE(FeatureList::IsEnabled(kFeatureOffByDefault));
+
+  FeatureList::ClearInstanceForTesting();
+  FeatureList::RestoreInstanceForTesting(std::move(original_feature_list));
+  EXPECT_TRUE(FeatureList::IsEnabled(kFeatureOffByDefault));
+}
+
 TEST_F(FeatureListTest, InitializeFromCommandLineWithFeatureParams) {
   struct {
     const std::string enable_features;
@@ -0,0 +1,757 @@
+// Copyright 2022 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "base/files/async_file_io_posix.h"
+
+#include <errno.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <sys/types.h>
+#include <sys/uio.h>
+#include <unistd.h>
+
+#include <atomic>
+#include <utility>
+#include <vector>
+
+#include "base/bind.h"
+#include "base/callback.h"
+#include "base/check_op.h"
+#include "base/containers/span.h"
+#include "base/location.h"
+#include "base/memory/ptr_util.h"
+#include "base/memory/ref_counted.h"
+#include "base/notreached.h"
+#include "base/numerics/safe_conversions.h"
+#include "base/posix/eintr_wrapper.h"
+#include "base/synchronization/lock.h"
+#include "base/task/single_thread_task_runner.h"
+#include "base/task/thread_pool.h"
+#include "base/thread_annotations.h"
+#include "base/threading/scoped_blocking_call.h"
+#include "base/threading/sequenced_task_runner_handle.h"
+#include "build/build_config.h"
+#include "build/chromeos_buildflags.h"
+
+#if BUILDFLAG(IS_LINUX) || BUILDFLAG(IS_CHROMEOS) || BUILDFLAG(IS_ANDROID)
+#include <sys/syscall.h>
+#endif
+
+#if BUILDFLAG(IS_LINUX) || BUILDFLAG(IS_CHROMEOS)
+#include <sys/eventfd.h>
+
+#include "base/containers/circular_deque.h"
+#include "base/files/io_uring_linux.h"
+#include "base/files/scoped_file.h"
+#include "base/memory/weak_ptr.h"
+#include "base/message_loop/message_pump_for_io.h"
+#include "base/task/current_thread.h"
+#include "base/threading/thread_checker.h"
+#include "base/time/time.h"
+#endif
+
+namespace base {
+
+namespace {
+
+AsyncFileIO* g_async_file_io = nullptr;
+
+constexpr int kNumFixedBuffers = 16;
+constexpr size_t kPoolSize = kNumFixedBuffers * AsyncFileIO::kFixedBufferSize;
+
+// Buffers which are registered with an io_uring, so that the kernel doesn't
+// map their pages for each operation. They are acquired when operations are
+// created, on any thread.
+class FixedBufferPool : public RefCountedThreadSafe<FixedBufferPool> {
+ public:
+  // Returns null on failure.
+  static scoped_refptr<FixedBufferPool> Create() {
+    void* memory = mmap(nullptr, kPoolSize, PROT_READ | PROT_WRITE,
+                        MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+    if (memory == MAP_FAILED)
+      return nullptr;
+    return WrapRefCounted(new FixedBufferPool(static_cast<char*>(memory)));
+  }
+
+  FixedBufferPool(const FixedBufferPool&) = delete;
+  FixedBufferPool& operator=(const FixedBufferPool&) = delete;
+
+  span<const iovec> iovecs() const { return iovecs_; }
+
+  char* buffer(int index) const {
+    DCHECK_GE(index, 0);
+    DCHECK_LT(index, kNumFixedBuffers);
+    return memory_ + index * AsyncFileIO::kFixedBufferSize;
+  }
+
+  // Returns the index of a free buffer, or -1 if all of them are in use.
+  int AcquireBuffer() {
+    AutoLock lock(lock_);
+    if (free_indices_.empty())
+      return -1;
+    int index = free_indices_.back();
+    free_indices_.pop_back();
+    return index;
+  }
+
+  void ReleaseBuffer(int index) {
+    DCHECK_GE(index, 0);
+    DCHECK_LT(index, kNumFixedBuffers);
+    AutoLock lock(lock_);
+    free_indices_.push_back(index);
+  }
+
+ private:
+  friend class RefCountedThreadSafe<FixedBufferPool>;
+
+  explicit FixedBufferPool(char* memory) : memory_(memory) {
+    for (int i = 0; i < kNumFixedBuffers; ++i) {
+      iovecs_[i].iov_base = buffer(i);
+      iovecs_[i].iov_len = AsyncFileIO::kFixedBufferSize;
+      free_indices_.push_back(i);
+    }
+  }
+
+  ~FixedBufferPool() {
+    munmap(memory_, kPoolSize);
+  }
+
+  // Not a raw_ptr<> since it isn't allocated by PartitionAlloc.
+  char* const memory_;
+  iovec iovecs_[kNumFixedBuffers];
+
+  Lock lock_;
+  std::vector<int> free_indices_ GUARDED_BY(lock_);
+};
+
+#if BUILDFLAG(IS_LINUX) || BUILDFLAG(IS_CHROMEOS) || BUILDFLAG(IS_ANDROID)
+
+#ifndef RWF_NOWAIT
+#define RWF_NOWAIT 0x00000008
+#endif
+
+// Whether the kernel lacks preadv2() or RWF_NOWAIT, which came with Linux 4.6
+// and 4.14.
+std::atomic<bool> g_read_without_waiting_unsupported{false};
+
+// Reads the |size| bytes at |offset| of |file| into |data| if they are all in
+// the page cache. Returns false if they aren't, on error, or at the end of the
+// file, which the blocking read then reports.
+bool ReadWithoutWaiting(PlatformFile file,
+                        int64_t offset,
+                        char* data,
+                        int size) {
+  if (g_read_without_waiting_unsupported.load(std::memory_order_relaxed))
+    return false;
+  iovec iov = {data, static_cast<size_t>(size)};
+  // The offset is split in two longs, the high one of which is ignored by
+  // 64-bit kernels.
+  const uint64_t pos = static_cast<uint64_t>(offset);
+  const long rv = HANDLE_EINTR(
+      syscall(__NR_preadv2, file, &iov, 1, static_cast<unsigned long>(pos),
+              static_cast<unsigned long>(pos >> 32), RWF_NOWAIT));
+  if (rv < 0 && (errno == ENOSYS || errno == EINVAL))
+    g_read_without_waiting_unsupported.store(true, std::memory_order_relaxed);
+  return rv == size;
+}
+
+#else
+
+bool ReadWithoutWaiting(PlatformFile file,
+                        int64_t offset,
+                        char* data,
+                        int size) {
+  return false;
+}
+
+#endif
+
+}  // namespace
+
+// The reads of an AsyncFileIO::ReadVectored() call, which replies once all of
+// them are done.
+class AsyncFileIO::ReadBatch : public RefCountedThreadSafe<ReadBatch> {
+ public:
+  ReadBatch(size_t size, ReadVectoredCallback callback)
+      : buffers_(size),
+        bytes_read_(size),
+        errors_(size, File::FILE_OK),
+        num_pending_(size),
+        callback_(std::move(callback)),
+        reply_task_runner_(SequencedTaskRunnerHandle::Get()) {
+    DCHECK_GT(size, 0u);
+  }
+
+  ReadBatch(const ReadBatch&) = delete;
+  ReadBatch& operator=(const ReadBatch&) = delete;
+
+  // Records the result of the read of range |index|, once per range. Can be
+  // called on any thread. Replies after the last one.
+  void OnReadDone(size_t index,
+                  File::Error error,
+                  std::unique_ptr<char[]> buffer,
+                  int bytes_read) {
+    buffers_[index] = std::move(buffer);
+    bytes_read_[index] = bytes_read;
+    errors_[index] = error;
+    // memory_order_acq_rel orders the results of all the reads before the
+    // reply.
+    if (num_pending_.fetch_sub(1, std::memory_order_acq_rel) != 1)
+      return;
+    reply_task_runner_->PostTask(
+        FROM_HERE, BindOnce(&ReadBatch::Reply, WrapRefCounted(this)));
+  }
+
+ private:
+  friend class RefCountedThreadSafe<ReadBatch>;
+
+  ~ReadBatch() = default;
+
+  void Reply() {
+    for (File::Error error : errors_) {
+      if (error != File::FILE_OK) {
+        std::move(callback_).Run(error, {});
+        return;
+      }
+    }
+    std::vector<span<const uint8_t>> data;
+    data.reserve(buffers_.size());
+    for (size_t i = 0; i < buffers_.size(); ++i) {
+      data.emplace_back(reinterpret_cast<const uint8_t*>(buffers_[i].get()),
+                        static_cast<size_t>(bytes_read_[i]));
+    }
+    std::move(callback_).Run(File::FILE_OK, data);
+  }
+
+  std::vector<std::unique_ptr<char[]>> buffers_;
+  std::vector<int> bytes_read_;
+  std::vector<File::Error> errors_;
+  std::atomic<size_t> num_pending_;
+  ReadVectoredCallback callback_;
+  const scoped_refptr<SequencedTaskRunner> reply_task_runner_;
+};
+
+// A read or a write, with its buffer and its callback. It may take several
+// transfers, if some of them are partial.
+class AsyncFileIO::Operation {
+ public:
+  // Use a buffer of |pool|, if it isn't null and if one is free, for
+  // operations of up to kFixedBufferSize bytes.
+  static std::unique_ptr<Operation> CreateRead(PlatformFile file,
+                                               int64_t offset,
+                                               int size,
+                                               FixedBufferPool* pool,
+                                               ReadCallback callback) {
+    auto operation = WrapUnique(
+        new Operation(/*is_read=*/true, file, offset, size, pool));
+    operation->read_callback_ = std::move(callback);
+    return operation;
+  }
+
+  static std::unique_ptr<Operation> CreateWrite(PlatformFile file,
+                                                int64_t offset,
+                                                const char* data,
+                                                int size,
+                                                FixedBufferPool* pool,
+                                                WriteCallback callback) {
+    auto operation = WrapUnique(
+        new Operation(/*is_read=*/false, file, offset, size, pool));
+    if (size)
+      memcpy(operation->data_, data, static_cast<size_t>(size));
+    operation->write_callback_ = std::move(callback);
+    return operation;
+  }
+
+  // A read of range |index| of |batch|, into a heap buffer which is handed to
+  // |batch| once done.
+  static std::unique_ptr<Operation> CreateBatchRead(
+      PlatformFile file,
+      int64_t offset,
+      int size,
+      scoped_refptr<ReadBatch> batch,
+      size_t index) {
+    auto operation = WrapUnique(
+        new Operation(/*is_read=*/true, file, offset, size, nullptr));
+    operation->batch_ = std::move(batch);
+    operation->batch_index_ = index;
+    return operation;
+  }
+
+  Operation(const Operation&) = delete;
+  Operation& operator=(const Operation&) = delete;
+
+  ~Operation() {
+    if (buffer_index_ >= 0)
+      pool_->ReleaseBuffer(buffer_index_);
+  }
+
+  SequencedTaskRunner* reply_task_runner() const {
+    return reply_task_runner_.get();
+  }
+
+#if BUILDFLAG(IS_LINUX) || BUILDFLAG(IS_CHROMEOS)
+  // Prepares the transfer of the remaining bytes. Returns false if the
+  // submission queue of |ring| is full.
+  bool Prepare(IoUring* ring) {
+    char* data = data_ + done_;
+    const uint32_t size = checked_cast<uint32_t>(size_ - done_);
+    const uint64_t offset = static_cast<uint64_t>(offset_ + done_);
+    const uint64_t user_data = reinterpret_cast<uintptr_t>(this);
+    if (buffer_index_ >= 0) {
+      const uint16_t index = checked_cast<uint16_t>(buffer_index_);
+      return is_read()
+                 ? ring->PrepareReadFixed(file_, data, size, offset, index,
+                                          user_data)
+                 : ring->PrepareWriteFixed(file_, data, size, offset, index,
+                                           user_data);
+    }
+    return is_read() ? ring->PrepareRead(file_, data, size, offset, user_data)
+                     : ring->PrepareWrite(file_, data, size, offset, user_data);
+  }
+#endif
+
+  // Records the |result| of a transfer: a number of bytes or a negated errno.
+  // Returns true if the operation is done, i.e. if it failed, reached the end
+  // of the file or transferred all the bytes.
+  bool OnTransferred(int32_t result) {
+    if (result < 0) {
+      // Report the bytes transferred before the error, like File::Read().
+      if (!done_)
+        error_ = File::OSErrorToFileError(-result);
+      return true;
+    }
+    done_ += result;
+    DCHECK_LE(done_, size_);
+    return result == 0 || done_ == size_;
+  }
+
+  // Transfers the bytes with blocking calls.
+  void RunBlocking() {
+    ScopedBlockingCall scoped_blocking_call(FROM_HERE,
+                                            BlockingType::MAY_BLOCK);
+    for (;;) {
+      const size_t size = static_cast<size_t>(size_ - done_);
+      const int64_t offset = offset_ + done_;
+      ssize_t rv;
+      if (is_read()) {
+        rv = HANDLE_EINTR(pread(file_, data_ + done_, size, offset));
+      } else {
+#if BUILDFLAG(IS_ANDROID)
+        // See File::Write().
+        rv = HANDLE_EINTR(pwrite64(file_, data_ + done_, size, offset));
+#else
+        rv = HANDLE_EINTR(pwrite(file_, data_ + done_, size, offset));
+#endif
+      }
+      if (OnTransferred(rv < 0 ? -errno : static_cast<int32_t>(rv)))
+        return;
+    }
+  }
+
+  // Transfers the bytes of each of |operations| with blocking calls, and
+  // completes them.
+  static void RunBlockingAndComplete(
+      std::vector<std::unique_ptr<Operation>> operations) {
+    for (auto& operation : operations) {
+      operation->RunBlocking();
+      Complete(std::move(operation));
+    }
+  }
+
+  // Hands the result of |operation| to its batch, or posts its reply to the
+  // sequence which started it.
+  static void Complete(std::unique_ptr<Operation> operation) {
+    if (operation->batch_) {
+      const scoped_refptr<ReadBatch> batch = std::move(operation->batch_);
+      batch->OnReadDone(operation->batch_index_, operation->error_,
+                        std::move(operation->heap_buffer_), operation->done_);
+      return;
+    }
+    SequencedTaskRunner* reply_task_runner = operation->reply_task_runner();
+    reply_task_runner->PostTask(
+        FROM_HERE, BindOnce(&Operation::Reply, std::move(operation)));
+  }
+
+  // Runs the callback of |operation|.
+  static void Reply(std::unique_ptr<Operation> operation) {
+    const bool ok = operation->error_ == File::FILE_OK;
+    const int bytes = ok ? operation->done_ : -1;
+    if (operation->is_read()) {
+      std::move(operation->read_callback_)
+          .Run(operation->error_, ok ? operation->data_ : nullptr, bytes);
+    } else {
+      std::move(operation->write_callback_).Run(operation->error_, bytes);
+    }
+  }
+
+ private:
+  Operation(bool is_read,
+            PlatformFile file,
+            int64_t offset,
+            int size,
+            FixedBufferPool* pool)
+      : is_read_(is_read),
+        file_(file),
+        offset_(offset),
+        size_(size),
+        reply_task_runner_(SequencedTaskRunnerHandle::Get()) {
+    DCHECK_GE(offset, 0);
+    DCHECK_GE(size, 0);
+    if (pool && size <= kFixedBufferSize)
+      buffer_index_ = pool->AcquireBuffer();
+    if (buffer_index_ >= 0) {
+      pool_ = pool;
+      data_ = pool->buffer(buffer_index_);
+    } else {
+      heap_buffer_.reset(new char[static_cast<size_t>(size)]);
+      data_ = heap_buffer_.get();
+    }
+  }
+
+  bool is_read() const { return is_read_; }
+
+  const bool is_read_;
+  const PlatformFile file_;
+  const int64_t offset_;
+  const int size_;
+
+  // The number of bytes transferred so far.
+  int done_ = 0;
+  File::Error error_ = File::FILE_OK;
+
+  // The index of the buffer of |pool_| which holds the data, or -1 if
+  // |heap_buffer_| does.
+  int buffer_index_ = -1;
+  scoped_refptr<FixedBufferPool> pool_;
+  std::unique_ptr<char[]> heap_buffer_;
+  // Not a raw_ptr<> since it can point into a buffer of |pool_|, which isn't
+  // allocated by PartitionAlloc.
+  char* data_ = nullptr;
+
+  ReadCallback read_callback_;
+  WriteCallback write_callback_;
+  const scoped_refptr<SequencedTaskRunner> reply_task_runner_;
+
+  // Set for the reads of a ReadVectored() batch, instead of |read_callback_|.
+  scoped_refptr<ReadBatch> batch_;
+  size_t batch_index_ = 0;
+};
+
+#if BUILDFLAG(IS_LINUX) || BUILDFLAG(IS_CHROMEOS)
+
+// Submits the operations to an io_uring, and reaps their completions, on the IO
+// thread. Operations can be started on any thread.
+class AsyncFileIO::Context : public MessagePumpForIO::FdWatcher {
+ public:
+  // Returns null if io_uring isn't available.
+  static std::unique_ptr<Context> Create(
+      scoped_refptr<SingleThreadTaskRunner> io_thread_task_runner) {
+    std::unique_ptr<IoUring> ring = IoUring::Create(kNumEntries);
+    if (!ring)
+      return nullptr;
+    ScopedFD event_fd(eventfd(0, EFD_CLOEXEC | EFD_NONBLOCK));
+    if (!event_fd.is_valid() || !ring->RegisterEventFd(event_fd.get()))
+      return nullptr;
+    // Operations use heap buffers if the registered ones aren't available,
+    // e.g. because they would exceed RLIMIT_MEMLOCK.
+    scoped_refptr<FixedBufferPool> pool = FixedBufferPool::Create();
+    if (pool && !ring->RegisterBuffers(pool->iovecs()))
+      pool = nullptr;
+    return WrapUnique(new Context(std::move(io_thread_task_runner),
+                                  std::move(ring), std::move(event_fd),
+                                  std::move(pool)));
+  }
+
+  Context(const Context&) = delete;
+  Context& operator=(const Context&) = delete;
+
+  ~Context() override {
+    DCHECK_CALLED_ON_VALID_THREAD(thread_checker_);
+    controller_.StopWatchingFileDescriptor();
+
+    // The kernel may still write to the buffers of the operations in flight,
+    // which can't be cancelled before Linux 5.19. Wait for them.
+    while (num_in_flight_) {
+      if (!ring_->WaitForCompletion()) {
+        // Leak the operations rather than free memory which the kernel may
+        // still write to.
+        return;
+      }
+      uint64_t user_data;
+      int32_t result;
+      while (ring_->PopCompletion(&user_data, &result)) {
+        --num_in_flight_;
+        delete reinterpret_cast<Operation*>(user_data);
+      }
+    }
+  }
+
+  FixedBufferPool* pool() const { return pool_.get(); }
+
+  // Watches the completions of the ring.
+  void StartWatching() {
+    DCHECK_CALLED_ON_VALID_THREAD(thread_checker_);
+    CHECK(CurrentIOThread::Get()->WatchFileDescriptor(
+        event_fd_.get(), /*persistent=*/true, MessagePumpForIO::WATCH_READ,
+        &controller_, this));
+  }
+
+  // Queues |operation| for the next batch. Can be called on any thread.
+  void Start(std::unique_ptr<Operation> operation) {
+    {
+      AutoLock lock(lock_);
+      pending_.push_back(std::move(operation));
+      if (flush_posted_)
+        return;
+      flush_posted_ = true;
+    }
+    // Unretained() is safe since |this| is deleted by a task posted to the IO
+    // thread when no operation can be started anymore.
+    io_thread_task_runner_->PostTask(
+        FROM_HERE, BindOnce(&Context::Flush, Unretained(this)));
+  }
+
+ private:
+  // The size of the submission queue. More operations wait in |backlog_|.
+  static constexpr uint32_t kNumEntries = 256;
+
+  Context(scoped_refptr<SingleThreadTaskRunner> io_thread_task_runner,
+          std::unique_ptr<IoUring> ring,
+          ScopedFD event_fd,
+          scoped_refptr<FixedBufferPool> pool)
+      : io_thread_task_runner_(std::move(io_thread_task_runner)),
+        ring_(std::move(ring)),
+        event_fd_(std::move(event_fd)),
+        pool_(std::move(pool)) {
+    DETACH_FROM_THREAD(thread_checker_);
+  }
+
+  // Submits the operations queued by Start() since the last call, in a single
+  // batch.
+  void Flush() {
+    DCHECK_CALLED_ON_VALID_THREAD(thread_checker_);
+    std::vector<std::unique_ptr<Operation>> operations;
+    {
+      AutoLock lock(lock_);
+      operations.swap(pending_);
+      flush_posted_ = false;
+    }
+    for (auto& operation : operations)
+      backlog_.push_back(std::move(operation));
+    SubmitBacklog();
+  }
+
+  // Submits as many operations of |backlog_| as the ring can take.
+  void SubmitBacklog() {
+    DCHECK_CALLED_ON_VALID_THREAD(thread_checker_);
+    while (!backlog_.empty() && num_in_flight_ < ring_->num_entries()) {
+      if (!backlog_.front()->Prepare(ring_.get()))
+        break;
+      // Owned by the ring until its completion.
+      backlog_.front().release();
+      backlog_.pop_front();
+      ++num_in_flight_;
+    }
+    if (ring_->Submit() || retry_posted_)
+      return;
+    // The kernel is out of resources. Retry shortly, unless completions
+    // arrive first.
+    retry_posted_ = true;
+    io_thread_task_runner_->PostDelayedTask(
+        FROM_HERE,
+        BindOnce(&Context::RetrySubmit, weak_ptr_factory_.GetWeakPtr()),
+        Milliseconds(1));
+  }
+
+  void RetrySubmit() {
+    retry_posted_ = false;
+    SubmitBacklog();
+  }
+
+  // MessagePumpForIO::FdWatcher:
+  void OnFileCanReadWithoutBlocking(int fd) override {
+    DCHECK_CALLED_ON_VALID_THREAD(thread_checker_);
+    // Reset the eventfd before popping the completions, so that none of them
+    // is missed.
+    uint64_t value;
+    HANDLE_EINTR(read(event_fd_.get(), &value, sizeof(value)));
+
+    uint64_t user_data;
+    int32_t result;
+    while (ring_->PopCompletion(&user_data, &result)) {
+      DCHECK_GT(num_in_flight_, 0u);
+      --num_in_flight_;
+      std::unique_ptr<Operation> operation(
+          reinterpret_cast<Operation*>(user_data));
+      // Resubmit interrupted and partial transfers first.
+      if (result == -EAGAIN || result == -EINTR ||
+          !operation->OnTransferred(result)) {
+        backlog_.push_front(std::move(operation));
+        continue;
+      }
+      Operation::Complete(std::move(operation));
+    }
+    SubmitBacklog();
+  }
+
+  void OnFileCanWriteWithoutBlocking(int fd) override { NOTREACHED(); }
+
+  const scoped_refptr<SingleThreadTaskRunner> io_thread_task_runner_;
+  const std::unique_ptr<IoUring> ring_;
+  const ScopedFD event_fd_;
+  const scoped_refptr<FixedBufferPool> pool_;
+
+  Lock lock_;
+  std::vector<std::unique_ptr<Operation>> pending_ GUARDED_BY(lock_);
+  bool flush_posted_ GUARDED_BY(lock_) = false;
+
+  // The members below are accessed on the IO thread.
+  THREAD_CHECKER(thread_checker_);
+  MessagePumpForIO::FdWatchController controller_{FROM_HERE};
+  circular_deque<std::unique_ptr<Operation>> backlog_;
+  // The number of operations prepared or submitted, which are owned by the
+  // ring until their completion.
+  uint32_t num_in_flight_ = 0;
+  bool retry_posted_ = false;
+
+  WeakPtrFactory<Context> weak_ptr_factory_{this};
+};
+
+#else
+
+// io_uring is specific to Linux.
+class AsyncFileIO::Context {
+ public:
+  FixedBufferPool* pool() const { return nullptr; }
+  void Start(std::unique_ptr<Operation> operation) {}
+};
+
+#endif  // BUILDFLAG(IS_LINUX) || BUILDFLAG(IS_CHROMEOS)
+
+AsyncFileIO::AsyncFileIO(
+    scoped_refptr<SingleThreadTaskRunner> io_thread_task_runner)
+    : context_(nullptr, OnTaskRunnerDeleter(io_thread_task_runner)) {
+  DCHECK(!g_async_file_io);
+#if BUILDFLAG(IS_LINUX) || BUILDFLAG(IS_CHROMEOS)
+  context_.reset(Context::Create(io_thread_task_runner).release());
+  if (context_) {
+    io_thread_task_runner->PostTask(
+        FROM_HERE,
+        BindOnce(&Context::StartWatching, Unretained(context_.get())));
+  }
+#endif
+  g_async_file_io = this;
+}
+
+AsyncFileIO::~AsyncFileIO() {
+  DCHECK_EQ(g_async_file_io, this);
+  g_async_file_io = nullptr;
+}
+
+// static
+void AsyncFileIO::Read(PlatformFile file,
+                       int64_t offset,
+                       int size,
+                       ReadCallback callback) {
+  if (offset < 0 || size < 0) {
+    SequencedTaskRunnerHandle::Get()->PostTask(
+        FROM_HERE, BindOnce(std::move(callback),
+                            File::FILE_ERROR_INVALID_OPERATION, nullptr, -1));
+    return;
+  }
+  FixedBufferPool* pool =
+      IsUsingIoUring() ? g_async_file_io->context_->pool() : nullptr;
+  Start(Operation::CreateRead(file, offset, size, pool, std::move(callback)));
+}
+
+// static
+void AsyncFileIO::Write(PlatformFile file,
+                        int64_t offset,
+                        const char* data,
+                        int size,
+                        WriteCallback callback) {
+  if (offset < 0 || size < 0) {
+    SequencedTaskRunnerHandle::Get()->PostTask(
+        FROM_HERE,
+        BindOnce(std::move(callback), File::FILE_ERROR_INVALID_OPERATION, -1));
+    return;
+  }
+  FixedBufferPool* pool =
+      IsUsingIoUring() ? g_async_file_io->context_->pool() : nullptr;
+  Start(Operation::CreateWrite(file, offset, data, size, pool,
+                               std::move(callback)));
+}
+
+// static
+void AsyncFileIO::ReadVectored(PlatformFile file,
+                               std::vector<File::ReadRange> ranges,
+                               ReadVectoredCallback callback) {
+  for (const File::ReadRange& range : ranges) {
+    if (range.offset < 0 || range.size < 0) {
+      SequencedTaskRunnerHandle::Get()->PostTask(
+          FROM_HERE, BindOnce(std::move(callback),
+                              File::FILE_ERROR_INVALID_OPERATION,
+                              span<const span<const uint8_t>>()));
+      return;
+    }
+  }
+  if (ranges.empty()) {
+    SequencedTaskRunnerHandle::Get()->PostTask(
+        FROM_HERE, BindOnce(std::move(callback), File::FILE_OK,
+                            span<const span<const uint8_t>>()));
+    return;
+  }
+
+  auto batch = MakeRefCounted<ReadBatch>(ranges.size(), std::move(callback));
+  const bool using_io_uring = IsUsingIoUring();
+  std::vector<std::unique_ptr<Operation>> operations;
+  for (size_t i = 0; i < ranges.size(); ++i) {
+    const File::ReadRange& range = ranges[i];
+    // io_uring reads the cached bytes without blocking by itself, and the
+    // batch takes a single system call, so this only spares the thread hop
+    // to the ThreadPool.
+    if (!using_io_uring) {
+      std::unique_ptr<char[]> buffer(
+          new char[static_cast<size_t>(range.size)]);
+      if (range.size == 0 ||
+          ReadWithoutWaiting(file, range.offset, buffer.get(), range.size)) {
+        batch->OnReadDone(i, File::FILE_OK, std::move(buffer), range.size);
+        continue;
+      }
+    }
+    operations.push_back(
+        Operation::CreateBatchRead(file, range.offset, range.size, batch, i));
+  }
+  if (operations.empty())
+    return;
+
+  if (using_io_uring) {
+    for (auto& operation : operations)
+      g_async_file_io->context_->Start(std::move(operation));
+    return;
+  }
+  ThreadPool::PostTask(FROM_HERE, {MayBlock()},
+                       BindOnce(&Operation::RunBlockingAndComplete,
+                                std::move(operations)));
+}
+
+// static
+bool AsyncFileIO::IsUsingIoUring() {
+  return g_async_file_io && g_async_file_io->context_;
+}
+
+// static
+void AsyncFileIO::Start(std::unique_ptr<Operation> operation) {
+  if (IsUsingIoUring()) {
+    g_async_file_io->context_->Start(std::move(operation));
+    return;
+  }
+  Operation* raw_operation = operation.get();
+  ThreadPool::PostTaskAndReply(
+      FROM_HERE, {MayBlock()},
+      BindOnce(&Operation::RunBlocking, Unretained(raw_operation)),
+      BindOnce(&Operation::Reply, std::move(operation)));
+}
+
+}  // namespace base
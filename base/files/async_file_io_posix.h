@@ -0,0 +1,103 @@
+// Copyright 2022 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#ifndef BASE_FILES_ASYNC_FILE_IO_POSIX_H_
+#define BASE_FILES_ASYNC_FILE_IO_POSIX_H_
+
+#include <stdint.h>
+
+#include <memory>
+#include <vector>
+
+#include "base/base_export.h"
+#include "base/files/file.h"
+#include "base/files/platform_file.h"
+#include "base/memory/scoped_refptr.h"
+#include "base/task/sequenced_task_runner.h"
+
+namespace base {
+
+class SingleThreadTaskRunner;
+
+// Reads and writes files without blocking a thread for each operation in
+// flight. Operations can be started from any sequence with a
+// SequencedTaskRunnerHandle, and their callbacks run on that sequence.
+// File::ReadAsync() and File::WriteAsync() use this API.
+//
+// On Linux, while an AsyncFileIO instance exists, operations go through an
+// io_uring (see IoUring). Operations started from all sequences are queued and
+// submitted as a batch by a task posted to an IO thread, which watches the
+// completions of the ring through an eventfd with its MessagePumpForIO.
+// Operations of up to kFixedBufferSize bytes use buffers registered with the
+// ring, when available.
+//
+// Otherwise, i.e. without an instance, on other platforms, or if the kernel
+// doesn't support io_uring, operations run on the ThreadPool with blocking
+// calls, like FileProxy.
+//
+// Operations are meant for regular files. Their callbacks aren't run if the
+// AsyncFileIO instance is destroyed, or if the ThreadPool is shut down, first.
+class BASE_EXPORT AsyncFileIO {
+ public:
+  using ReadCallback = File::ReadAsyncCallback;
+  using WriteCallback = File::WriteAsyncCallback;
+  using ReadVectoredCallback = File::ReadAtVectoredAsyncCallback;
+
+  // The maximum size of the operations which can use registered buffers.
+  static constexpr int kFixedBufferSize = 64 * 1024;
+
+  // Routes the operations started while this exists through io_uring, if
+  // available, with the thread of |io_thread_task_runner| as the IO thread. It
+  // must run a MessagePumpForIO. There can be only one instance at a time, and
+  // it must not be created or destroyed while operations are being started.
+  explicit AsyncFileIO(
+      scoped_refptr<SingleThreadTaskRunner> io_thread_task_runner);
+  AsyncFileIO(const AsyncFileIO&) = delete;
+  AsyncFileIO& operator=(const AsyncFileIO&) = delete;
+  ~AsyncFileIO();
+
+  // Reads up to |size| bytes at |offset| of |file|, which must stay open until
+  // |callback| runs. See File::ReadAsync().
+  static void Read(PlatformFile file,
+                   int64_t offset,
+                   int size,
+                   ReadCallback callback);
+
+  // Writes the |size| bytes at |data|, which are copied, at |offset| of |file|,
+  // which must stay open until |callback| runs. See File::WriteAsync().
+  static void Write(PlatformFile file,
+                    int64_t offset,
+                    const char* data,
+                    int size,
+                    WriteCallback callback);
+
+  // Reads each of |ranges| of |file|, which must stay open until |callback|
+  // runs, as one batch: through io_uring, the reads are submitted together and
+  // replied to together. Otherwise, the ranges already in the page cache are
+  // read right away without blocking, with preadv2(RWF_NOWAIT) where
+  // available, and the others in a single ThreadPool task. See
+  // File::ReadAtVectoredAsync().
+  static void ReadVectored(PlatformFile file,
+                           std::vector<File::ReadRange> ranges,
+                           ReadVectoredCallback callback);
+
+  // Returns true if operations currently go through io_uring.
+  static bool IsUsingIoUring();
+
+ private:
+  class Context;
+  class Operation;
+  class ReadBatch;
+
+  // Starts |operation|, through |context_| if there is an instance using
+  // io_uring.
+  static void Start(std::unique_ptr<Operation> operation);
+
+  // Null if io_uring isn't available. Deleted on the IO thread.
+  std::unique_ptr<Context, OnTaskRunnerDeleter> context_;
+};
+
+}  // namespace base
+
+#endif  // BASE_FILES_ASYNC_FILE_IO_POSIX_H_
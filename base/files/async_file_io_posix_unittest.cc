@@ -0,0 +1,228 @@
+// Copyright 2022 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "base/files/async_file_io_posix.h"
+
+#include <memory>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "base/bind.h"
+#include "base/callback.h"
+#include "base/containers/span.h"
+#include "base/files/file.h"
+#include "base/files/scoped_temp_dir.h"
+#include "base/run_loop.h"
+#include "base/test/bind.h"
+#include "base/test/task_environment.h"
+#include "base/threading/thread_task_runner_handle.h"
+#include "testing/gtest/include/gtest/gtest.h"
+
+namespace base {
+
+namespace {
+
+// Runs the tests with and without an AsyncFileIO instance, i.e. through
+// io_uring when available and on the ThreadPool.
+class AsyncFileIOTest : public testing::TestWithParam<bool> {
+ protected:
+  AsyncFileIOTest()
+      : task_environment_(test::TaskEnvironment::MainThreadType::IO) {}
+
+  void SetUp() override {
+    ASSERT_TRUE(dir_.CreateUniqueTempDir());
+    file_ = File(dir_.GetPath().AppendASCII("test"),
+                 File::FLAG_CREATE | File::FLAG_READ | File::FLAG_WRITE);
+    ASSERT_TRUE(file_.IsValid());
+    if (GetParam()) {
+      async_file_io_ =
+          std::make_unique<AsyncFileIO>(ThreadTaskRunnerHandle::Get());
+    }
+  }
+
+  void TearDown() override {
+    async_file_io_.reset();
+    task_environment_.RunUntilIdle();
+  }
+
+  int Write(int64_t offset, const std::string& data) {
+    RunLoop run_loop;
+    int result = 0;
+    file_.WriteAsync(
+        offset, data.data(), static_cast<int>(data.size()),
+        BindLambdaForTesting([&](File::Error error, int bytes_written) {
+          EXPECT_EQ(error == File::FILE_OK, bytes_written >= 0);
+          result = bytes_written;
+          run_loop.Quit();
+        }));
+    run_loop.Run();
+    return result;
+  }
+
+  std::string Read(int64_t offset, int size) {
+    RunLoop run_loop;
+    std::string result;
+    file_.ReadAsync(offset, size,
+                    BindLambdaForTesting([&](File::Error error,
+                                             const char* data, int bytes_read) {
+                      EXPECT_EQ(File::FILE_OK, error);
+                      result.assign(data, static_cast<size_t>(bytes_read));
+                      run_loop.Quit();
+                    }));
+    run_loop.Run();
+    return result;
+  }
+
+  // Returns the data read for each of |ranges|, or nothing on error.
+  std::vector<std::string> ReadVectored(std::vector<File::ReadRange> ranges,
+                                        File::Error expected_error) {
+    RunLoop run_loop;
+    std::vector<std::string> result;
+    file_.ReadAtVectoredAsync(
+        std::move(ranges),
+        BindLambdaForTesting(
+            [&](File::Error error, span<const span<const uint8_t>> data) {
+              EXPECT_EQ(expected_error, error);
+              for (span<const uint8_t> range_data : data)
+                result.emplace_back(range_data.begin(), range_data.end());
+              run_loop.Quit();
+            }));
+    run_loop.Run();
+    return result;
+  }
+
+  test::TaskEnvironment task_environment_;
+  ScopedTempDir dir_;
+  File file_;
+  std::unique_ptr<AsyncFileIO> async_file_io_;
+};
+
+}  // namespace
+
+INSTANTIATE_TEST_SUITE_P(All, AsyncFileIOTest, testing::Bool());
+
+TEST_P(AsyncFileIOTest, WriteThenRead) {
+  EXPECT_EQ(5, Write(0, "hello"));
+  EXPECT_EQ(5, Write(5, "world"));
+  EXPECT_EQ("helloworld", Read(0, 10));
+  EXPECT_EQ("owo", Read(4, 3));
+}
+
+TEST_P(AsyncFileIOTest, ReadStopsAtEndOfFile) {
+  EXPECT_EQ(5, Write(0, "hello"));
+  EXPECT_EQ("llo", Read(2, 100));
+  EXPECT_EQ("", Read(10, 100));
+}
+
+// Operations larger than the registered buffers use heap buffers.
+TEST_P(AsyncFileIOTest, LargeOperation) {
+  std::string data(3 * AsyncFileIO::kFixedBufferSize + 1, 'x');
+  for (size_t i = 0; i < data.size(); ++i)
+    data[i] = static_cast<char>('a' + i % 26);
+  EXPECT_EQ(static_cast<int>(data.size()), Write(0, data));
+  EXPECT_EQ(data, Read(0, static_cast<int>(data.size())));
+}
+
+// More operations than registered buffers and ring entries can be in flight,
+// and their callbacks run on the current sequence.
+TEST_P(AsyncFileIOTest, ManyConcurrentOperations) {
+  constexpr int kNumOperations = 1000;
+  constexpr int kSize = 8;
+  RunLoop write_loop;
+  int num_writes = 0;
+  for (int i = 0; i < kNumOperations; ++i) {
+    std::string data(kSize, static_cast<char>('a' + i % 26));
+    file_.WriteAsync(
+        i * kSize, data.data(), kSize,
+        BindLambdaForTesting([&](File::Error error, int bytes_written) {
+          EXPECT_TRUE(ThreadTaskRunnerHandle::Get()->BelongsToCurrentThread());
+          EXPECT_EQ(File::FILE_OK, error);
+          EXPECT_EQ(kSize, bytes_written);
+          if (++num_writes == kNumOperations)
+            write_loop.Quit();
+        }));
+  }
+  write_loop.Run();
+
+  RunLoop read_loop;
+  int num_reads = 0;
+  for (int i = 0; i < kNumOperations; ++i) {
+    file_.ReadAsync(
+        i * kSize, kSize,
+        BindLambdaForTesting(
+            [&, i](File::Error error, const char* data, int bytes_read) {
+              EXPECT_EQ(File::FILE_OK, error);
+              EXPECT_EQ(std::string(kSize, static_cast<char>('a' + i % 26)),
+                        std::string(data, static_cast<size_t>(bytes_read)));
+              if (++num_reads == kNumOperations)
+                read_loop.Quit();
+            }));
+  }
+  read_loop.Run();
+}
+
+TEST_P(AsyncFileIOTest, ReadVectored) {
+  EXPECT_EQ(10, Write(0, "helloworld"));
+  EXPECT_EQ(std::vector<std::string>({"world", "", "hello", "ld", ""}),
+            ReadVectored({{5, 5}, {3, 0}, {0, 5}, {8, 100}, {20, 10}},
+                         File::FILE_OK));
+  EXPECT_TRUE(ReadVectored({}, File::FILE_OK).empty());
+
+  // More ranges than ring entries.
+  std::vector<File::ReadRange> ranges(1000, {2, 3});
+  std::vector<std::string> data = ReadVectored(ranges, File::FILE_OK);
+  EXPECT_EQ(std::vector<std::string>(1000, "llo"), data);
+}
+
+TEST_P(AsyncFileIOTest, ReadVectoredErrors) {
+  EXPECT_TRUE(ReadVectored({{0, 5}, {-1, 5}},
+                           File::FILE_ERROR_INVALID_OPERATION)
+                  .empty());
+  EXPECT_TRUE(
+      ReadVectored({{0, -1}}, File::FILE_ERROR_INVALID_OPERATION).empty());
+
+  File write_only(dir_.GetPath().AppendASCII("write_only"),
+                  File::FLAG_CREATE | File::FLAG_WRITE);
+  ASSERT_TRUE(write_only.IsValid());
+  RunLoop run_loop;
+  write_only.ReadAtVectoredAsync(
+      {{0, 10}, {10, 10}},
+      BindLambdaForTesting(
+          [&](File::Error error, span<const span<const uint8_t>> data) {
+            EXPECT_NE(File::FILE_OK, error);
+            EXPECT_TRUE(data.empty());
+            run_loop.Quit();
+          }));
+  run_loop.Run();
+}
+
+TEST_P(AsyncFileIOTest, InvalidArguments) {
+  RunLoop run_loop;
+  file_.ReadAsync(
+      -1, 10,
+      BindLambdaForTesting([&](File::Error error, const char*, int bytes_read) {
+        EXPECT_EQ(File::FILE_ERROR_INVALID_OPERATION, error);
+        EXPECT_EQ(-1, bytes_read);
+        run_loop.Quit();
+      }));
+  run_loop.Run();
+}
+
+TEST_P(AsyncFileIOTest, ReadFromWriteOnlyFile) {
+  File write_only(dir_.GetPath().AppendASCII("write_only"),
+                  File::FLAG_CREATE | File::FLAG_WRITE);
+  ASSERT_TRUE(write_only.IsValid());
+  RunLoop run_loop;
+  write_only.ReadAsync(
+      0, 10,
+      BindLambdaForTesting([&](File::Error error, const char*, int bytes_read) {
+        EXPECT_NE(File::FILE_OK, error);
+        EXPECT_EQ(-1, bytes_read);
+        run_loop.Quit();
+      }));
+  run_loop.Run();
+}
+
+}  // namespace base
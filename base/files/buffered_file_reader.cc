@@ -0,0 +1,139 @@
+// Copyright 2022 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "base/files/buffered_file_reader.h"
+
+#include <string.h>
+
+#include <algorithm>
+#include <limits>
+#include <utility>
+
+#include "base/check_op.h"
+#include "base/threading/scoped_blocking_call.h"
+#include "build/build_config.h"
+
+#if BUILDFLAG(IS_POSIX)
+#include <fcntl.h>
+#endif
+
+namespace base {
+
+BufferedFileReader::BufferedFileReader(File file)
+    : BufferedFileReader(std::move(file), Options()) {}
+
+BufferedFileReader::BufferedFileReader(File file, const Options& options)
+    : options_(options), file_(std::move(file)) {
+  DCHECK(file_.IsValid());
+  DCHECK_GT(options_.chunk_size, 0u);
+  DCHECK_GT(options_.max_record_size, 0u);
+
+  if (options_.map_file) {
+    // Empty files can't be mapped, and have nothing to read anyway.
+    if (file_.GetLength() != 0 && !mapped_file_.Initialize(std::move(file_))) {
+      error_ = File::FILE_ERROR_FAILED;
+      return;
+    }
+    data_ = reinterpret_cast<const char*>(mapped_file_.data());
+    end_ = mapped_file_.length();
+    return;
+  }
+
+  // posix_fadvise() is only available in the Android NDK in API 21+.
+#if BUILDFLAG(IS_LINUX) || BUILDFLAG(IS_CHROMEOS) || \
+    (BUILDFLAG(IS_ANDROID) && __ANDROID_API__ >= 21)
+  // The doubled read-ahead keeps the disk busy while the chunks read are
+  // processed. This fails harmlessly for pipes.
+  posix_fadvise(file_.GetPlatformFile(), /*offset=*/0, /*len=*/0,
+                POSIX_FADV_SEQUENTIAL);
+#endif
+
+  capacity_ = options_.chunk_size;
+  buffer_ = std::make_unique<char[]>(capacity_);
+  data_ = buffer_.get();
+}
+
+BufferedFileReader::~BufferedFileReader() = default;
+
+bool BufferedFileReader::ReadRecord(char delimiter, StringPiece* record) {
+  if (error_ != File::FILE_OK)
+    return false;
+
+  do {
+    // Only the data read since the last search is searched.
+    const char* found =
+        scan_ < end_ ? static_cast<const char*>(
+                           memchr(data_ + scan_, delimiter, end_ - scan_))
+                     : nullptr;
+    if (found) {
+      const size_t delimiter_offset = static_cast<size_t>(found - data_);
+      *record = StringPiece(data_ + begin_, delimiter_offset - begin_);
+      begin_ = scan_ = delimiter_offset + 1;
+      return true;
+    }
+    scan_ = end_;
+  } while (Fill());
+
+  if (error_ != File::FILE_OK || begin_ == end_ ||
+      !options_.read_unterminated_record) {
+    return false;
+  }
+  *record = StringPiece(data_ + begin_, end_ - begin_);
+  begin_ = scan_ = end_;
+  return true;
+}
+
+bool BufferedFileReader::ReadLine(StringPiece* line) {
+  if (!ReadRecord('\n', line))
+    return false;
+  if (!line->empty() && line->back() == '\r')
+    line->remove_suffix(1);
+  return true;
+}
+
+bool BufferedFileReader::Fill() {
+  if (options_.map_file)
+    return false;
+
+  // The partial record moves to the start of the buffer, so that the next
+  // chunk follows it.
+  if (begin_ > 0) {
+    memmove(buffer_.get(), buffer_.get() + begin_, end_ - begin_);
+    end_ -= begin_;
+    scan_ -= begin_;
+    begin_ = 0;
+  }
+
+  if (end_ == capacity_) {
+    // The buffer holds a single partial record.
+    if (end_ > options_.max_record_size) {
+      error_ = File::FILE_ERROR_NO_MEMORY;
+      return false;
+    }
+    capacity_ = std::min(capacity_ * 2,
+                         options_.max_record_size + options_.chunk_size);
+    std::unique_ptr<char[]> buffer = std::make_unique<char[]>(capacity_);
+    memcpy(buffer.get(), buffer_.get(), end_);
+    buffer_ = std::move(buffer);
+    data_ = buffer_.get();
+  }
+
+  ScopedBlockingCall scoped_blocking_call(FROM_HERE, BlockingType::MAY_BLOCK);
+  const size_t size = std::min<size_t>(capacity_ - end_,
+                                       std::numeric_limits<int>::max());
+  // Unlike ReadAtCurrentPos(), this returns the data available in a pipe
+  // rather than waiting for a whole chunk.
+  const int bytes_read = file_.ReadAtCurrentPosNoBestEffort(
+      buffer_.get() + end_, static_cast<int>(size));
+  if (bytes_read < 0) {
+    error_ = File::GetLastFileError();
+    if (error_ == File::FILE_OK)
+      error_ = File::FILE_ERROR_FAILED;
+    return false;
+  }
+  end_ += static_cast<size_t>(bytes_read);
+  return bytes_read > 0;
+}
+
+}  // namespace base
@@ -0,0 +1,109 @@
+// Copyright 2022 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#ifndef BASE_FILES_BUFFERED_FILE_READER_H_
+#define BASE_FILES_BUFFERED_FILE_READER_H_
+
+#include <stddef.h>
+
+#include <memory>
+
+#include "base/base_export.h"
+#include "base/files/file.h"
+#include "base/files/memory_mapped_file.h"
+#include "base/strings/string_piece.h"
+
+namespace base {
+
+// Reads a file sequentially in large chunks, and splits it into lines or into
+// records ending with a delimiter, without loading it whole. The records are
+// StringPieces into the buffer of the reader, so that they are not copied;
+// they stay valid until the next read. A record which spans two chunks is
+// moved to the start of the buffer before the next chunk is read after it,
+// and the buffer grows only for records longer than a chunk, up to a limit.
+//
+// The reads begin at the current position of the file, which may also be a
+// pipe. The end of the file is not final: once a read returned false for it,
+// the next one reads the data appended since, if any, which suits tailers of
+// files being written.
+//
+// Example:
+//   BufferedFileReader reader(File(path, File::FLAG_OPEN | File::FLAG_READ));
+//   StringPiece line;
+//   while (reader.ReadLine(&line))
+//     ProcessLine(line);
+//   if (reader.error() != File::FILE_OK)
+//     ...
+//
+// All the reads may block.
+class BASE_EXPORT BufferedFileReader {
+ public:
+  static constexpr size_t kDefaultChunkSize = 1024 * 1024;
+  static constexpr size_t kDefaultMaxRecordSize = 64 * 1024 * 1024;
+
+  struct BASE_EXPORT Options {
+    // The size of the reads, which is also the initial size of the buffer.
+    size_t chunk_size = kDefaultChunkSize;
+
+    // The size of the longest record. Reading a longer one fails with
+    // FILE_ERROR_NO_MEMORY. The buffer takes up to about |chunk_size| more.
+    size_t max_record_size = kDefaultMaxRecordSize;
+
+    // Whether the data after the last delimiter of the file is returned as a
+    // record at its end. Tailers may rather wait for the rest of the record.
+    bool read_unterminated_record = true;
+
+    // Whether to map the file into memory rather than reading it. The records
+    // then point into the mapping, which spares copying them into a buffer
+    // and bounds neither their size nor the memory taken. The file must not
+    // change while it is read, and is read from its start whole.
+    bool map_file = false;
+  };
+
+  // Reads |file|, which must be valid and readable.
+  explicit BufferedFileReader(File file);
+  BufferedFileReader(File file, const Options& options);
+  BufferedFileReader(const BufferedFileReader&) = delete;
+  BufferedFileReader& operator=(const BufferedFileReader&) = delete;
+  ~BufferedFileReader();
+
+  // Sets |record| to the next record ending with |delimiter|, without the
+  // delimiter. Returns false at the end of the file or on error.
+  bool ReadRecord(char delimiter, StringPiece* record);
+
+  // Sets |line| to the next line, without its "\n" or "\r\n". Returns false
+  // at the end of the file or on error.
+  bool ReadLine(StringPiece* line);
+
+  // Returns the error which failed the reads, which will keep failing, or
+  // FILE_OK.
+  File::Error error() const { return error_; }
+
+ private:
+  // Reads more data after the buffered one, moving the partial record at the
+  // start of the buffer first. Returns false if there is none or on error.
+  bool Fill();
+
+  const Options options_;
+  File file_;
+  MemoryMappedFile mapped_file_;
+
+  // The buffer with the data read, unless it is mapped.
+  std::unique_ptr<char[]> buffer_;
+  size_t capacity_ = 0;
+
+  // The data, from the buffer or the mapping, and the offsets in it of the
+  // next record, of the data not searched for its delimiter yet, and of its
+  // end.
+  const char* data_ = nullptr;
+  size_t begin_ = 0;
+  size_t scan_ = 0;
+  size_t end_ = 0;
+
+  File::Error error_ = File::FILE_OK;
+};
+
+}  // namespace base
+
+#endif  // BASE_FILES_BUFFERED_FILE_READER_H_
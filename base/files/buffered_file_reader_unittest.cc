@@ -0,0 +1,137 @@
+// Copyright 2022 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "base/files/buffered_file_reader.h"
+
+#include <string>
+#include <vector>
+
+#include "base/files/file_path.h"
+#include "base/files/file_util.h"
+#include "base/files/scoped_temp_dir.h"
+#include "testing/gtest/include/gtest/gtest.h"
+
+namespace base {
+
+namespace {
+
+class BufferedFileReaderTest : public testing::Test {
+ protected:
+  void SetUp() override {
+    ASSERT_TRUE(temp_dir_.CreateUniqueTempDir());
+    path_ = temp_dir_.GetPath().AppendASCII("file");
+  }
+
+  File OpenFile(const std::string& contents) {
+    EXPECT_TRUE(WriteFile(path_, contents));
+    return File(path_, File::FLAG_OPEN | File::FLAG_READ);
+  }
+
+  // Returns the lines read by |reader| until it returns false.
+  static std::vector<std::string> ReadLines(BufferedFileReader* reader) {
+    std::vector<std::string> lines;
+    StringPiece line;
+    while (reader->ReadLine(&line))
+      lines.emplace_back(line);
+    return lines;
+  }
+
+  ScopedTempDir temp_dir_;
+  FilePath path_;
+};
+
+}  // namespace
+
+TEST_F(BufferedFileReaderTest, ReadLine) {
+  BufferedFileReader reader(OpenFile("one\ntwo\r\n\nthree"));
+  EXPECT_EQ(ReadLines(&reader),
+            (std::vector<std::string>{"one", "two", "", "three"}));
+  EXPECT_EQ(reader.error(), File::FILE_OK);
+}
+
+TEST_F(BufferedFileReaderTest, EmptyFile) {
+  BufferedFileReader reader(OpenFile(""));
+  StringPiece line;
+  EXPECT_FALSE(reader.ReadLine(&line));
+  EXPECT_EQ(reader.error(), File::FILE_OK);
+}
+
+TEST_F(BufferedFileReaderTest, ReadRecord) {
+  BufferedFileReader reader(OpenFile(std::string("a\0bc\0\0d", 7)));
+  std::vector<std::string> records;
+  StringPiece record;
+  while (reader.ReadRecord('\0', &record))
+    records.emplace_back(record);
+  EXPECT_EQ(records, (std::vector<std::string>{"a", "bc", "", "d"}));
+}
+
+TEST_F(BufferedFileReaderTest, RecordsAcrossChunks) {
+  std::string contents;
+  std::vector<std::string> expected_lines;
+  for (int i = 0; i < 100; ++i) {
+    // Some lines are longer than a chunk.
+    expected_lines.push_back(std::string(i % 13, 'a' + i % 26));
+    contents += expected_lines.back() + "\n";
+  }
+
+  BufferedFileReader::Options options;
+  options.chunk_size = 4;
+  BufferedFileReader reader(OpenFile(contents), options);
+  EXPECT_EQ(ReadLines(&reader), expected_lines);
+  EXPECT_EQ(reader.error(), File::FILE_OK);
+}
+
+TEST_F(BufferedFileReaderTest, RecordTooLong) {
+  BufferedFileReader::Options options;
+  options.chunk_size = 4;
+  options.max_record_size = 8;
+  BufferedFileReader reader(
+      OpenFile("12345678\n" + std::string(20, 'x') + "\nend\n"), options);
+  StringPiece line;
+  ASSERT_TRUE(reader.ReadLine(&line));
+  EXPECT_EQ(line, "12345678");
+  EXPECT_FALSE(reader.ReadLine(&line));
+  EXPECT_EQ(reader.error(), File::FILE_ERROR_NO_MEMORY);
+  EXPECT_FALSE(reader.ReadLine(&line));
+}
+
+TEST_F(BufferedFileReaderTest, UnterminatedRecord) {
+  BufferedFileReader::Options options;
+  options.read_unterminated_record = false;
+  BufferedFileReader reader(OpenFile("one\ntwo"), options);
+  EXPECT_EQ(ReadLines(&reader), std::vector<std::string>{"one"});
+  EXPECT_EQ(reader.error(), File::FILE_OK);
+}
+
+TEST_F(BufferedFileReaderTest, Tail) {
+  BufferedFileReader::Options options;
+  options.read_unterminated_record = false;
+  BufferedFileReader reader(OpenFile("one\ntw"), options);
+  EXPECT_EQ(ReadLines(&reader), std::vector<std::string>{"one"});
+
+  ASSERT_TRUE(AppendToFile(path_, "o\nthree\n"));
+  EXPECT_EQ(ReadLines(&reader),
+            (std::vector<std::string>{"two", "three"}));
+  EXPECT_TRUE(ReadLines(&reader).empty());
+}
+
+TEST_F(BufferedFileReaderTest, MapFile) {
+  BufferedFileReader::Options options;
+  options.map_file = true;
+  BufferedFileReader reader(OpenFile("one\r\ntwo\n\nthree"), options);
+  EXPECT_EQ(ReadLines(&reader),
+            (std::vector<std::string>{"one", "two", "", "three"}));
+  EXPECT_EQ(reader.error(), File::FILE_OK);
+}
+
+TEST_F(BufferedFileReaderTest, MapEmptyFile) {
+  BufferedFileReader::Options options;
+  options.map_file = true;
+  BufferedFileReader reader(OpenFile(""), options);
+  StringPiece line;
+  EXPECT_FALSE(reader.ReadLine(&line));
+  EXPECT_EQ(reader.error(), File::FILE_OK);
+}
+
+}  // namespace base
@@ -60,6 +60,7 @@ File::File(Error error_details) : error_details_(error_details) {}
 File::File(File&& other)
     : file_(other.TakePlatformFile()),
       tracing_path_(other.tracing_path_),
+      io_metrics_path_class_(other.io_metrics_path_class_),
       error_details_(other.error_details()),
       created_(other.created()),
       async_(other.async_) {}
@@ -73,6 +74,7 @@ File& File::operator=(File&& other) {
   Close();
   SetPlatformFile(other.TakePlatformFile());
   tracing_path_ = other.tracing_path_;
+  io_metrics_path_class_ = other.io_metrics_path_class_;
   error_details_ = other.error_details();
   created_ = other.created();
   async_ = other.async_;
@@ -94,6 +96,7 @@ void File::Initialize(const FilePath& path, uint32_t flags) {
   }
   if (FileTracing::IsCategoryEnabled())
     tracing_path_ = path;
+  io_metrics_path_class_ = FileIOMetrics::GetPathClass(path);
   SCOPED_FILE_TRACE("Initialize");
   DoInitialize(path, flags);
 }
@@ -8,9 +8,12 @@
 #include <stdint.h>
 
 #include <string>
+#include <vector>
 
 #include "base/base_export.h"
+#include "base/callback_forward.h"
 #include "base/containers/span.h"
+#include "base/files/file_io_metrics.h"
 #include "base/files/file_path.h"
 #include "base/files/file_tracing.h"
 #include "base/files/platform_file.h"
@@ -34,8 +37,9 @@ typedef struct stat64 stat_wrapper_t;
 namespace base {
 
 // Thin wrapper around an OS-level file.
-// Note that this class does not provide any support for asynchronous IO, other
-// than the ability to create asynchronous handles on Windows.
+// Note that this class provides little support for asynchronous IO: the
+// ability to create asynchronous handles on Windows, and ReadAsync() and
+// WriteAsync() on POSIX.
 //
 // Note about const: this class does not attempt to determine if the underlying
 // file system object is affected by a particular method in order to consider
@@ -249,6 +253,58 @@ class BASE_EXPORT File {
   // platforms. Returns the number of bytes written, or -1 on error.
   int WriteAtCurrentPosNoBestEffort(const char* data, int size);
 
+#if BUILDFLAG(IS_POSIX) || BUILDFLAG(IS_FUCHSIA)
+  // A buffer and the offset of the file to read it from or write it to.
+  struct ReadAtRange {
+    int64_t offset;
+    span<uint8_t> data;
+  };
+  struct WriteAtRange {
+    int64_t offset;
+    span<const uint8_t> data;
+  };
+
+  // Reads or writes each of |ranges|, and returns true if and only if all the
+  // bytes were transferred, like ReadAndCheck() and WriteAndCheck() would for
+  // each range, but with a single preadv() or pwritev() call for the ranges
+  // which follow each other in the file. Record stores, for instance, can read
+  // many records at once this way. WriteAtVectored() doesn't support files
+  // opened with FLAG_APPEND.
+  bool ReadAtVectored(span<const ReadAtRange> ranges);
+  bool WriteAtVectored(span<const WriteAtRange> ranges);
+
+  using ReadAsyncCallback =
+      OnceCallback<void(Error error, const char* data, int bytes_read)>;
+  using WriteAsyncCallback = OnceCallback<void(Error error, int bytes_written)>;
+
+  // A range of the file to read with ReadAtVectoredAsync().
+  struct ReadRange {
+    int64_t offset;
+    int size;
+  };
+  // |data| holds the bytes read for each range, and is valid until the
+  // callback returns. Ranges which reach the end of the file are shorter.
+  using ReadAtVectoredAsyncCallback =
+      OnceCallback<void(Error error, span<const span<const uint8_t>> data)>;
+
+  // Asynchronous versions of Read() and Write(), which run |callback| on the
+  // current sequence with FILE_OK and the data read or the number of bytes
+  // written, or with an error and -1. The file must stay open until |callback|
+  // runs. |data| is copied by WriteAsync(), which doesn't support files opened
+  // with FLAG_APPEND. See AsyncFileIO for the implementation.
+  void ReadAsync(int64_t offset, int size, ReadAsyncCallback callback);
+  void WriteAsync(int64_t offset,
+                  const char* data,
+                  int size,
+                  WriteAsyncCallback callback);
+
+  // Asynchronous version of ReadAtVectored(), which reads all of |ranges| as
+  // one batch and runs |callback| once, with FILE_OK and the data read, or
+  // with the first error and no data.
+  void ReadAtVectoredAsync(std::vector<ReadRange> ranges,
+                           ReadAtVectoredAsyncCallback callback);
+#endif
+
   // Returns the current size of this file, or a negative number on failure.
   int64_t GetLength();
 
@@ -398,6 +454,10 @@ class BASE_EXPORT File {
   // Object tied to the lifetime of |this| that enables/disables tracing.
   FileTracing::ScopedEnabler trace_enabler_;
 
+  // The path class which the operations are recorded for, if any. Set
+  // during |Initialize()|.
+  raw_ptr<FileIOMetrics::PathClass> io_metrics_path_class_ = nullptr;
+
   Error error_details_ = FILE_ERROR_FAILED;
   bool created_ = false;
   bool async_ = false;
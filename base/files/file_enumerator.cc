@@ -11,7 +11,8 @@ namespace base {
 FileEnumerator::FileInfo::~FileInfo() = default;
 
 bool FileEnumerator::ShouldSkip(const FilePath& path) {
-  FilePath::StringType basename = path.BaseName().value();
+  const FilePath::StringPieceType basename =
+      FilePathView(path).BaseName().value();
   return basename == FILE_PATH_LITERAL(".") ||
          (basename == FILE_PATH_LITERAL("..") &&
           !(INCLUDE_DOT_DOT & file_type_));
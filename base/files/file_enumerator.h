@@ -8,12 +8,14 @@
 #include <stddef.h>
 #include <stdint.h>
 
+#include <memory>
 #include <vector>
 
 #include "base/base_export.h"
 #include "base/containers/stack.h"
 #include "base/files/file.h"
 #include "base/files/file_path.h"
+#include "base/files/file_path_view.h"
 #include "base/time/time.h"
 #include "build/build_config.h"
 
@@ -87,6 +89,13 @@ class BASE_EXPORT FileEnumerator {
 #if BUILDFLAG(IS_POSIX) || BUILDFLAG(IS_FUCHSIA)
     SHOW_SYM_LINKS = 1 << 4,
 #endif
+    // Only the names and the file types of the entries are needed. On POSIX
+    // systems, this spares a stat() call per entry whose type is known from
+    // the directory listing, which is most of the time. Only st_mode and
+    // st_ino of FileInfo::stat() are set then, so GetSize() returns 0 and
+    // GetLastModifiedTime() the Unix epoch. Has no effect on Windows, where
+    // the sizes and the times come with the names.
+    NAMES_AND_TYPES_ONLY = 1 << 5,
   };
 
   // Search policy for intermediate folders.
@@ -158,6 +167,11 @@ class BASE_EXPORT FileEnumerator {
   // then so will be the result of Next().
   FilePath Next();
 
+  // Same as Next(), but returns a view of the path, which is valid until the
+  // next call to Next() or NextView(). On POSIX systems, the path is written
+  // into a buffer reused from one call to the next rather than allocated.
+  FilePathView NextView();
+
   // Returns info about the file last returned by Next(). Note that on Windows
   // and Fuchsia, GetInfo() does not play well with INCLUDE_DOT_DOT. In
   // particular, the GetLastModifiedTime() for the .. directory is 1601-01-01
@@ -179,6 +193,11 @@ class BASE_EXPORT FileEnumerator {
 
   bool IsPatternMatched(const FilePath& src) const;
 
+#if BUILDFLAG(IS_POSIX) || BUILDFLAG(IS_FUCHSIA)
+  // Moves to the next entry to return, if any.
+  bool MoveToNextEntry();
+#endif
+
 #if BUILDFLAG(IS_WIN)
   const WIN32_FIND_DATA& find_data() const {
     return *ChromeToWindowsType(&find_data_);
@@ -198,6 +217,12 @@ class BASE_EXPORT FileEnumerator {
 
   // The next entry to use from the directory_entries_ vector
   size_t current_directory_entry_;
+
+#if BUILDFLAG(IS_LINUX) || BUILDFLAG(IS_CHROMEOS) || BUILDFLAG(IS_ANDROID)
+  // The buffer for getdents64(), allocated on first use and reused for each
+  // directory.
+  std::unique_ptr<char[]> dirent_buffer_;
+#endif
 #endif
   FilePath root_path_;
   const bool recursive_;
@@ -210,6 +235,9 @@ class BASE_EXPORT FileEnumerator {
   // A stack that keeps track of which subdirectories we still need to
   // enumerate in the breadth-first search.
   base::stack<FilePath> pending_paths_;
+
+  // The path last returned by NextView().
+  FilePath::StringType next_view_buffer_;
 };
 
 }  // namespace base
@@ -6,17 +6,31 @@
 
 #include <dirent.h>
 #include <errno.h>
+#include <fcntl.h>
 #include <fnmatch.h>
 #include <stdint.h>
 #include <string.h>
 
 #include "base/logging.h"
+#include "base/memory/raw_ptr.h"
+#include "base/posix/eintr_wrapper.h"
 #include "base/threading/scoped_blocking_call.h"
 #include "build/build_config.h"
 
+#if BUILDFLAG(IS_LINUX) || BUILDFLAG(IS_CHROMEOS) || BUILDFLAG(IS_ANDROID)
+#include <sys/syscall.h>
+
+#include "base/files/dir_reader_linux.h"
+#endif
+
 namespace base {
 namespace {
 
+#if BUILDFLAG(IS_LINUX) || BUILDFLAG(IS_CHROMEOS) || BUILDFLAG(IS_ANDROID)
+// Large enough for a few hundred entries per getdents64() call.
+constexpr size_t kDirentBufferSize = 64 * 1024;
+#endif
+
 void GetStat(const FilePath& path, bool show_links, stat_wrapper_t* st) {
   DCHECK(st);
   const int res = show_links ? File::Lstat(path.value().c_str(), st)
@@ -30,6 +44,124 @@ void GetStat(const FilePath& path, bool show_links, stat_wrapper_t* st) {
   }
 }
 
+// Same as GetStat() for the entry |name| of the directory |dir_fd|, which
+// spares the lookup of the directory path.
+void GetStatAt(int dir_fd,
+               const FilePath& dir_path,
+               const char* name,
+               bool show_links,
+               stat_wrapper_t* st) {
+  DCHECK(st);
+  const int flags = show_links ? AT_SYMLINK_NOFOLLOW : 0;
+#if BUILDFLAG(IS_BSD) || BUILDFLAG(IS_APPLE) || BUILDFLAG(IS_NACL) || \
+    BUILDFLAG(IS_FUCHSIA) || (BUILDFLAG(IS_ANDROID) && __ANDROID_API__ < 21)
+  const int res = fstatat(dir_fd, name, st, flags);
+#else
+  const int res = fstatat64(dir_fd, name, st, flags);
+#endif
+  if (res < 0) {
+    DPLOG_IF(ERROR, errno != ENOENT || show_links)
+        << "Cannot stat '" << dir_path.Append(name) << "'";
+    memset(st, 0, sizeof(*st));
+  }
+}
+
+// Reads the entries of a directory. On Linux, this calls getdents64() with a
+// large buffer, which makes fewer system calls than readdir().
+class DirectoryReader {
+ public:
+#if BUILDFLAG(IS_LINUX) || BUILDFLAG(IS_CHROMEOS) || BUILDFLAG(IS_ANDROID)
+  DirectoryReader(const FilePath& path, std::unique_ptr<char[]>* buffer)
+      : fd_(HANDLE_EINTR(
+            open(path.value().c_str(), O_RDONLY | O_DIRECTORY | O_CLOEXEC))) {
+    if (!*buffer)
+      *buffer = std::make_unique<char[]>(kDirentBufferSize);
+    buffer_ = buffer->get();
+  }
+#else
+  explicit DirectoryReader(const FilePath& path)
+      : dir_(opendir(path.value().c_str())) {}
+#endif
+  DirectoryReader(const DirectoryReader&) = delete;
+  DirectoryReader& operator=(const DirectoryReader&) = delete;
+
+  ~DirectoryReader() {
+#if BUILDFLAG(IS_LINUX) || BUILDFLAG(IS_CHROMEOS) || BUILDFLAG(IS_ANDROID)
+    if (fd_ >= 0)
+      IGNORE_EINTR(close(fd_));
+#else
+    if (dir_)
+      closedir(dir_);
+#endif
+  }
+
+#if BUILDFLAG(IS_LINUX) || BUILDFLAG(IS_CHROMEOS) || BUILDFLAG(IS_ANDROID)
+  bool IsValid() const { return fd_ >= 0; }
+  int fd() const { return fd_; }
+
+  // Moves to the next entry. Returns false at the end of the directory, with
+  // errno set to zero, or on error.
+  bool Next() {
+    if (offset_ < size_)
+      offset_ += entry()->d_reclen;
+    if (offset_ >= size_) {
+      const long size = syscall(SYS_getdents64, fd_, buffer_.get(),
+                                kDirentBufferSize);
+      if (size <= 0) {
+        if (size == 0)
+          errno = 0;
+        return false;
+      }
+      size_ = static_cast<size_t>(size);
+      offset_ = 0;
+    }
+    return true;
+  }
+
+  const char* name() const { return entry()->d_name; }
+  unsigned char type() const { return entry()->d_type; }
+  ino_t inode() const { return static_cast<ino_t>(entry()->d_ino); }
+#else
+  bool IsValid() const { return dir_; }
+  int fd() const { return dirfd(dir_); }
+
+  bool Next() {
+    // NOTE: Per the readdir() documentation, when the end of the directory is
+    // reached with no errors, null is returned and errno is not changed.
+    // Therefore we must reset errno to zero before calling readdir() if we
+    // wish to know whether a null result indicates an error condition.
+    errno = 0;
+    dent_ = readdir(dir_);
+    return dent_;
+  }
+
+  const char* name() const { return dent_->d_name; }
+  unsigned char type() const { return dent_->d_type; }
+  ino_t inode() const { return dent_->d_ino; }
+#endif
+
+ private:
+#if BUILDFLAG(IS_LINUX) || BUILDFLAG(IS_CHROMEOS) || BUILDFLAG(IS_ANDROID)
+  const linux_dirent* entry() const {
+    return reinterpret_cast<const linux_dirent*>(buffer_.get() + offset_);
+  }
+
+  const int fd_;
+  raw_ptr<char> buffer_;
+  size_t offset_ = 0;
+  size_t size_ = 0;
+#else
+  const raw_ptr<DIR> dir_;
+  raw_ptr<struct dirent> dent_ = nullptr;
+#endif
+};
+
+// Returns the st_mode file type bits for the d_type of a directory entry. The
+// DT_* values are these bits shifted, as with DTTOIF() of glibc and BSDs.
+mode_t GetModeForDirentType(unsigned char type) {
+  return static_cast<mode_t>(type) << 12;
+}
+
 #if BUILDFLAG(IS_FUCHSIA)
 bool ShouldShowSymLinks(int file_type) {
   return false;
@@ -135,6 +267,21 @@ FileEnumerator::FileEnumerator(const FilePath& root_path,
 FileEnumerator::~FileEnumerator() = default;
 
 FilePath FileEnumerator::Next() {
+  if (!MoveToNextEntry())
+    return FilePath();
+  return root_path_.Append(
+      directory_entries_[current_directory_entry_].filename_);
+}
+
+FilePathView FileEnumerator::NextView() {
+  if (!MoveToNextEntry())
+    return FilePathView();
+  return FilePathView(root_path_).AppendTo(
+      directory_entries_[current_directory_entry_].filename_.value(),
+      &next_view_buffer_);
+}
+
+bool FileEnumerator::MoveToNextEntry() {
   ScopedBlockingCall scoped_blocking_call(FROM_HERE, BlockingType::MAY_BLOCK);
 
   ++current_directory_entry_;
@@ -142,18 +289,22 @@ FilePath FileEnumerator::Next() {
   // While we've exhausted the entries in the current directory, do the next
   while (current_directory_entry_ >= directory_entries_.size()) {
     if (pending_paths_.empty())
-      return FilePath();
+      return false;
 
     root_path_ = pending_paths_.top();
     root_path_ = root_path_.StripTrailingSeparators();
     pending_paths_.pop();
 
-    DIR* dir = opendir(root_path_.value().c_str());
-    if (!dir) {
+#if BUILDFLAG(IS_LINUX) || BUILDFLAG(IS_CHROMEOS) || BUILDFLAG(IS_ANDROID)
+    DirectoryReader reader(root_path_, &dirent_buffer_);
+#else
+    DirectoryReader reader(root_path_);
+#endif
+    if (!reader.IsValid()) {
       if (errno == 0 || error_policy_ == ErrorPolicy::IGNORE_ERRORS)
         continue;
       error_ = File::OSErrorToFileError(errno);
-      return FilePath();
+      return false;
     }
 
     directory_entries_.clear();
@@ -174,14 +325,12 @@ FilePath FileEnumerator::Next() {
 #endif  // BUILDFLAG(IS_FUCHSIA)
 
     current_directory_entry_ = 0;
-    struct dirent* dent;
-    // NOTE: Per the readdir() documentation, when the end of the directory is
-    // reached with no errors, null is returned and errno is not changed.
-    // Therefore we must reset errno to zero before calling readdir() if we
-    // wish to know whether a null result indicates an error condition.
-    while (errno = 0, dent = readdir(dir)) {
+    const bool show_links = ShouldShowSymLinks(file_type_);
+    const bool track_visited_directories =
+        recursive_ && ShouldTrackVisitedDirectories(file_type_);
+    while (reader.Next()) {
       FileInfo info;
-      info.filename_ = FilePath(dent->d_name);
+      info.filename_ = FilePath(reader.name());
 
       if (ShouldSkip(info.filename_))
         continue;
@@ -201,27 +350,42 @@ FilePath FileEnumerator::Next() {
       if (!recursive_ && !is_pattern_matched)
         continue;
 
-      const FilePath full_path = root_path_.Append(info.filename_);
-      GetStat(full_path, ShouldShowSymLinks(file_type_), &info.stat_);
-
-      const bool is_dir = info.IsDirectory();
+      // The type of the entry is known without stat/lstat, unless the file
+      // system does not report it or it is a symbolic link to follow.
+      const unsigned char type = reader.type();
+      const bool is_type_known =
+          type != DT_UNKNOWN && (type != DT_LNK || show_links);
+      bool is_dir = is_type_known && type == DT_DIR;
+      // The stat is still needed for the results, unless only their names
+      // and types are, and for the inodes of the directories to visit.
+      const bool needs_stat =
+          !is_type_known ||
+          (is_pattern_matched && IsTypeMatched(is_dir) &&
+           !(file_type_ & NAMES_AND_TYPES_ONLY)) ||
+          (is_dir && track_visited_directories);
+      if (needs_stat) {
+        GetStatAt(reader.fd(), root_path_, reader.name(), show_links,
+                  &info.stat_);
+        is_dir = info.IsDirectory();
+      } else {
+        info.stat_.st_mode = GetModeForDirentType(type);
+        info.stat_.st_ino = reader.inode();
+      }
 
       // Recursive mode: schedule traversal of a directory if either
       // SHOW_SYM_LINKS is on or we haven't visited the directory yet.
       if (recursive_ && is_dir &&
-          (!ShouldTrackVisitedDirectories(file_type_) ||
+          (!track_visited_directories ||
            visited_directories_.insert(info.stat_.st_ino).second)) {
-        pending_paths_.push(full_path);
+        pending_paths_.push(root_path_.Append(info.filename_));
       }
 
       if (is_pattern_matched && IsTypeMatched(is_dir))
         directory_entries_.push_back(std::move(info));
     }
-    int readdir_errno = errno;
-    closedir(dir);
-    if (readdir_errno != 0 && error_policy_ != ErrorPolicy::IGNORE_ERRORS) {
-      error_ = File::OSErrorToFileError(readdir_errno);
-      return FilePath();
+    if (errno != 0 && error_policy_ != ErrorPolicy::IGNORE_ERRORS) {
+      error_ = File::OSErrorToFileError(errno);
+      return false;
     }
 
     // MATCH_ONLY policy enumerates files in matched subfolders by "*" pattern.
@@ -230,8 +394,7 @@ FilePath FileEnumerator::Next() {
       pattern_.clear();
   }
 
-  return root_path_.Append(
-      directory_entries_[current_directory_entry_].filename_);
+  return true;
 }
 
 FileEnumerator::FileInfo FileEnumerator::GetInfo() const {
@@ -10,6 +10,7 @@
 
 #include "base/containers/circular_deque.h"
 #include "base/files/file_path.h"
+#include "base/files/file_path_view.h"
 #include "base/files/file_util.h"
 #include "base/files/scoped_temp_dir.h"
 #include "base/logging.h"
@@ -354,6 +355,29 @@ TEST(FileEnumerator, FileInSubfolder) {
   }
 }
 
+TEST(FileEnumerator, NextView) {
+  ScopedTempDir temp_dir;
+  ASSERT_TRUE(temp_dir.CreateUniqueTempDir());
+
+  const FilePath subdir = temp_dir.GetPath().AppendASCII("subdir");
+  ASSERT_TRUE(CreateDirectory(subdir));
+
+  const FilePath file1 = temp_dir.GetPath().AppendASCII("test1.txt");
+  const FilePath file2 = subdir.AppendASCII("test2.txt");
+  ASSERT_TRUE(CreateDummyFile(file1));
+  ASSERT_TRUE(CreateDummyFile(file2));
+
+  FileEnumerator enumerator(
+      temp_dir.GetPath(), true,
+      FileEnumerator::FILES | FileEnumerator::DIRECTORIES);
+  std::vector<FilePath> paths;
+  for (FilePathView path = enumerator.NextView(); !path.empty();
+       path = enumerator.NextView()) {
+    paths.push_back(path.ToFilePath());
+  }
+  EXPECT_THAT(paths, UnorderedElementsAre(subdir, file1, file2));
+}
+
 TEST(FileEnumerator, FilesInSubfoldersWithFiltering) {
   ScopedTempDir temp_dir;
   ASSERT_TRUE(temp_dir.CreateUniqueTempDir());
@@ -446,6 +470,64 @@ TEST(FileEnumerator, SymLinkLoops) {
 }
 #endif
 
+TEST(FileEnumerator, NamesAndTypesOnly) {
+  ScopedTempDir temp_dir;
+  ASSERT_TRUE(temp_dir.CreateUniqueTempDir());
+
+  const FilePath subdir = temp_dir.GetPath().AppendASCII("subdir");
+  ASSERT_TRUE(CreateDirectory(subdir));
+  const FilePath file = temp_dir.GetPath().AppendASCII("test.txt");
+  ASSERT_TRUE(CreateDummyFile(file));
+  const FilePath subdir_file = subdir.AppendASCII("test.txt");
+  ASSERT_TRUE(CreateDummyFile(subdir_file));
+
+  auto files = RunEnumerator(
+      temp_dir.GetPath(), true,
+      FileEnumerator::FILES | FileEnumerator::NAMES_AND_TYPES_ONLY,
+      kEmptyPattern, FileEnumerator::FolderSearchPolicy::MATCH_ONLY);
+  EXPECT_THAT(files, UnorderedElementsAre(file, subdir_file));
+
+  FileEnumerator enumerator(temp_dir.GetPath(), false,
+                            FileEnumerator::FILES |
+                                FileEnumerator::DIRECTORIES |
+                                FileEnumerator::NAMES_AND_TYPES_ONLY);
+  size_t count = 0;
+  for (FilePath path = enumerator.Next(); !path.empty();
+       path = enumerator.Next()) {
+    ++count;
+    EXPECT_EQ(path == subdir, enumerator.GetInfo().IsDirectory());
+  }
+  EXPECT_EQ(2u, count);
+}
+
+#if BUILDFLAG(IS_POSIX)
+TEST(FileEnumerator, NamesAndTypesOnlyFollowsSymLinks) {
+  ScopedTempDir temp_dir;
+  ASSERT_TRUE(temp_dir.CreateUniqueTempDir());
+
+  const FilePath subdir = temp_dir.GetPath().AppendASCII("subdir");
+  ASSERT_TRUE(CreateDirectory(subdir));
+  const FilePath file = subdir.AppendASCII("test.txt");
+  ASSERT_TRUE(CreateDummyFile(file));
+  const FilePath link = temp_dir.GetPath().AppendASCII("link");
+  ASSERT_TRUE(CreateSymbolicLink(subdir, link));
+
+  // The symbolic links still get a stat() to know what they point to.
+  auto files = RunEnumerator(
+      temp_dir.GetPath(), false,
+      FileEnumerator::DIRECTORIES | FileEnumerator::NAMES_AND_TYPES_ONLY,
+      kEmptyPattern, FileEnumerator::FolderSearchPolicy::MATCH_ONLY);
+  EXPECT_THAT(files, UnorderedElementsAre(subdir, link));
+
+  files = RunEnumerator(
+      temp_dir.GetPath(), false,
+      FileEnumerator::FILES | FileEnumerator::SHOW_SYM_LINKS |
+          FileEnumerator::NAMES_AND_TYPES_ONLY,
+      kEmptyPattern, FileEnumerator::FolderSearchPolicy::MATCH_ONLY);
+  EXPECT_THAT(files, ElementsAre(link));
+}
+#endif
+
 // Test FileEnumerator::GetInfo() on some files and ensure all the returned
 // information is correct.
 TEST(FileEnumerator, GetInfo) {
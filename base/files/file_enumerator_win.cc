@@ -201,6 +201,11 @@ FilePath FileEnumerator::Next() {
   return FilePath();
 }
 
+FilePathView FileEnumerator::NextView() {
+  next_view_buffer_ = Next().value();
+  return FilePathView(next_view_buffer_);
+}
+
 bool FileEnumerator::IsPatternMatched(const FilePath& src) const {
   switch (folder_search_policy_) {
     case FolderSearchPolicy::MATCH_ONLY:
@@ -0,0 +1,154 @@
+// Copyright 2022 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "base/files/file_io_metrics.h"
+
+#include <atomic>
+#include <map>
+#include <memory>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "base/containers/flat_map.h"
+#include "base/files/file_path.h"
+#include "base/files/file_tracing.h"
+#include "base/metrics/histogram_functions.h"
+#include "base/no_destructor.h"
+#include "base/numerics/safe_conversions.h"
+#include "base/strings/strcat.h"
+#include "base/strings/string_util.h"
+#include "base/synchronization/lock.h"
+#include "base/thread_annotations.h"
+
+namespace base {
+
+class FileIOMetrics::PathClass {
+ public:
+  explicit PathClass(StringPiece tag) : tag_(tag) {}
+  PathClass(const PathClass&) = delete;
+  PathClass& operator=(const PathClass&) = delete;
+  ~PathClass() = delete;
+
+  void Record(const char* name, TimeDelta latency, int64_t size) {
+    Histograms* histograms = GetHistograms(name);
+    UmaHistogramMicrosecondsTimes(histograms->latency, latency);
+    if (histograms->bytes && size > 0) {
+      UmaHistogramCustomCounts(*histograms->bytes, saturated_cast<int>(size),
+                               1, 64 * 1024 * 1024, 50);
+    }
+  }
+
+ private:
+  struct Histograms {
+    Histograms(const std::string& tag, StringPiece operation)
+        : latency(StrCat({"File.IO.Latency.", tag, ".", operation})) {
+      if (StartsWith(operation, "Read") || StartsWith(operation, "Write")) {
+        bytes = std::make_unique<HistogramHandle>(
+            StrCat({"File.IO.Bytes.", tag, ".", operation}));
+      }
+    }
+
+    HistogramHandle latency;
+    std::unique_ptr<HistogramHandle> bytes;
+  };
+
+  // Returns the histograms of the operation |name|. The names are literals,
+  // so that they are looked up by address.
+  Histograms* GetHistograms(const char* name) {
+    AutoLock lock(lock_);
+    std::unique_ptr<Histograms>& histograms = histograms_[name];
+    if (!histograms) {
+      // Strips the "File::" of the traced name.
+      StringPiece operation(name);
+      operation.remove_prefix(sizeof(FILE_TRACING_PREFIX "::") - 1);
+      histograms = std::make_unique<Histograms>(tag_, operation);
+    }
+    return histograms.get();
+  }
+
+  const std::string tag_;
+
+  Lock lock_;
+  flat_map<const char*, std::unique_ptr<Histograms>> histograms_
+      GUARDED_BY(lock_);
+};
+
+namespace {
+
+struct Registry {
+  Lock lock;
+
+  // The registered directories, and the path class of each.
+  std::vector<std::pair<FilePath, FileIOMetrics::PathClass*>> directories
+      GUARDED_BY(lock);
+
+  // The path classes by tag, which the directories share.
+  std::map<std::string, FileIOMetrics::PathClass*, std::less<>> path_classes
+      GUARDED_BY(lock);
+};
+
+Registry& GetRegistry() {
+  static NoDestructor<Registry> registry;
+  return *registry;
+}
+
+// Whether a directory is registered, which spares the Files the lock of the
+// registry when none is.
+std::atomic_bool g_has_directories{false};
+
+}  // namespace
+
+// static
+void FileIOMetrics::RegisterPathClass(const FilePath& directory,
+                                      StringPiece tag) {
+  DCHECK(!directory.empty());
+  DCHECK(!tag.empty());
+
+  Registry& registry = GetRegistry();
+  AutoLock lock(registry.lock);
+  auto it = registry.path_classes.find(tag);
+  if (it == registry.path_classes.end()) {
+    it = registry.path_classes
+             .emplace(std::string(tag), new PathClass(tag))
+             .first;
+  }
+  registry.directories.emplace_back(directory.StripTrailingSeparators(),
+                                    it->second);
+  g_has_directories.store(true, std::memory_order_relaxed);
+}
+
+// static
+FileIOMetrics::PathClass* FileIOMetrics::GetPathClass(const FilePath& path) {
+  if (!g_has_directories.load(std::memory_order_relaxed))
+    return nullptr;
+
+  Registry& registry = GetRegistry();
+  AutoLock lock(registry.lock);
+  PathClass* path_class = nullptr;
+  size_t closest_length = 0;
+  for (const auto& directory : registry.directories) {
+    const size_t length = directory.first.value().size();
+    if (length >= closest_length &&
+        (directory.first == path || directory.first.IsParent(path))) {
+      path_class = directory.second;
+      closest_length = length;
+    }
+  }
+  return path_class;
+}
+
+// static
+void FileIOMetrics::ResetForTesting() {
+  Registry& registry = GetRegistry();
+  AutoLock lock(registry.lock);
+  registry.directories.clear();
+  g_has_directories.store(false, std::memory_order_relaxed);
+}
+
+void FileIOMetrics::ScopedOperation::Record() {
+  path_class_->Record(name_, TimeTicks::Now() - start_, size_);
+}
+
+}  // namespace base
@@ -0,0 +1,83 @@
+// Copyright 2022 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#ifndef BASE_FILES_FILE_IO_METRICS_H_
+#define BASE_FILES_FILE_IO_METRICS_H_
+
+#include <stdint.h>
+
+#include "base/base_export.h"
+#include "base/memory/raw_ptr.h"
+#include "base/strings/string_piece.h"
+#include "base/time/time.h"
+
+namespace base {
+
+class FilePath;
+
+// Records the latency of the operations of Files, and the number of bytes
+// they read or write, into histograms. Unlike FileTracing, this is meant to
+// stay on in production, and is opt-in per directory: the Files opened by
+// path under a directory registered with a path class tag, e.g.
+// "NetworkHome" or "LocalCache", record their operations into
+//
+//   File.IO.Latency.<tag>.<operation>  From 1 us to 10 s.
+//   File.IO.Bytes.<tag>.<operation>    The bytes asked for, by reads and
+//                                      writes.
+//
+// where <operation> is the name File traces the operation with, e.g. "Read",
+// "WriteAtCurrentPos" or "Flush". Files without a path class pay a null check
+// per operation.
+class BASE_EXPORT FileIOMetrics {
+ public:
+  // The histograms of a tag. Leaked, so that Files can keep a pointer.
+  class PathClass;
+
+  // Records the operations of the Files opened afterwards at or under
+  // |directory| into the histograms of |tag|, which must be a valid
+  // histogram name part. A file under several registered directories takes
+  // the tag of the closest one. The paths are compared as given, so they
+  // should be absolute and normalized alike.
+  static void RegisterPathClass(const FilePath& directory, StringPiece tag);
+
+  // Returns the path class of a file opened at |path|, or null if none.
+  static PathClass* GetPathClass(const FilePath& path);
+
+  // Unregisters all the directories.
+  static void ResetForTesting();
+
+  // Records an operation of a File while in scope, if |path_class| is not
+  // null. |name| is the name File traces it with, which must have an
+  // application lifetime, and |size| its size in bytes.
+  class BASE_EXPORT ScopedOperation {
+   public:
+    ScopedOperation(const char* name, PathClass* path_class, int64_t size)
+        : path_class_(path_class), name_(name), size_(size) {
+      if (path_class_)
+        start_ = TimeTicks::Now();
+    }
+    ScopedOperation(const ScopedOperation&) = delete;
+    ScopedOperation& operator=(const ScopedOperation&) = delete;
+    ~ScopedOperation() {
+      if (path_class_)
+        Record();
+    }
+
+   private:
+    void Record();
+
+    const raw_ptr<PathClass> path_class_;
+    const char* const name_;
+    const int64_t size_;
+    TimeTicks start_;
+  };
+
+  FileIOMetrics() = delete;
+  FileIOMetrics(const FileIOMetrics&) = delete;
+  FileIOMetrics& operator=(const FileIOMetrics&) = delete;
+};
+
+}  // namespace base
+
+#endif  // BASE_FILES_FILE_IO_METRICS_H_
@@ -0,0 +1,96 @@
+// Copyright 2022 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "base/files/file_io_metrics.h"
+
+#include <utility>
+
+#include "base/files/file.h"
+#include "base/files/file_path.h"
+#include "base/files/file_util.h"
+#include "base/files/scoped_temp_dir.h"
+#include "base/test/metrics/histogram_tester.h"
+#include "testing/gtest/include/gtest/gtest.h"
+
+namespace base {
+
+namespace {
+
+class FileIOMetricsTest : public testing::Test {
+ protected:
+  void SetUp() override {
+    ASSERT_TRUE(temp_dir_.CreateUniqueTempDir());
+    local_dir_ = temp_dir_.GetPath().AppendASCII("local");
+    remote_dir_ = local_dir_.AppendASCII("remote");
+    ASSERT_TRUE(CreateDirectory(remote_dir_));
+  }
+
+  void TearDown() override { FileIOMetrics::ResetForTesting(); }
+
+  // Writes and reads back 3 bytes at |path|.
+  static void WriteAndRead(const FilePath& path) {
+    File file(path, File::FLAG_CREATE_ALWAYS | File::FLAG_READ |
+                        File::FLAG_WRITE);
+    ASSERT_TRUE(file.IsValid());
+    EXPECT_EQ(file.Write(0, "abc", 3), 3);
+    char buffer[3];
+    EXPECT_EQ(file.Read(0, buffer, 3), 3);
+  }
+
+  ScopedTempDir temp_dir_;
+  FilePath local_dir_;
+  FilePath remote_dir_;
+};
+
+}  // namespace
+
+TEST_F(FileIOMetricsTest, NoPathClass) {
+  HistogramTester histogram_tester;
+  WriteAndRead(local_dir_.AppendASCII("file"));
+  EXPECT_TRUE(histogram_tester.GetTotalCountsForPrefix("File.IO.").empty());
+}
+
+TEST_F(FileIOMetricsTest, RecordsOperations) {
+  FileIOMetrics::RegisterPathClass(local_dir_, "Local");
+  HistogramTester histogram_tester;
+  WriteAndRead(local_dir_.AppendASCII("file"));
+
+  histogram_tester.ExpectTotalCount("File.IO.Latency.Local.Initialize", 1);
+  histogram_tester.ExpectTotalCount("File.IO.Latency.Local.Write", 1);
+  histogram_tester.ExpectTotalCount("File.IO.Latency.Local.Read", 1);
+  histogram_tester.ExpectTotalCount("File.IO.Latency.Local.Close", 1);
+  histogram_tester.ExpectUniqueSample("File.IO.Bytes.Local.Write", 3, 1);
+  histogram_tester.ExpectUniqueSample("File.IO.Bytes.Local.Read", 3, 1);
+  histogram_tester.ExpectTotalCount("File.IO.Bytes.Local.Close", 0);
+}
+
+TEST_F(FileIOMetricsTest, ClosestDirectory) {
+  FileIOMetrics::RegisterPathClass(remote_dir_, "Remote");
+  FileIOMetrics::RegisterPathClass(local_dir_, "Local");
+  HistogramTester histogram_tester;
+  WriteAndRead(remote_dir_.AppendASCII("file"));
+  WriteAndRead(local_dir_.AppendASCII("file"));
+
+  histogram_tester.ExpectTotalCount("File.IO.Latency.Remote.Write", 1);
+  histogram_tester.ExpectTotalCount("File.IO.Latency.Local.Write", 1);
+}
+
+TEST_F(FileIOMetricsTest, PathClassFollowsFile) {
+  FileIOMetrics::RegisterPathClass(local_dir_, "Local");
+  HistogramTester histogram_tester;
+  File file(local_dir_.AppendASCII("file"),
+            File::FLAG_CREATE_ALWAYS | File::FLAG_WRITE);
+  ASSERT_TRUE(file.IsValid());
+
+  File moved = std::move(file);
+  EXPECT_TRUE(moved.Flush());
+  File duplicate = moved.Duplicate();
+  ASSERT_TRUE(duplicate.IsValid());
+  EXPECT_TRUE(duplicate.Flush());
+
+  histogram_tester.ExpectTotalCount("File.IO.Latency.Local.Flush", 2);
+  histogram_tester.ExpectTotalCount("File.IO.Latency.Local.Duplicate", 1);
+}
+
+}  // namespace base
@@ -17,6 +17,7 @@
 #include <algorithm>
 
 #include "base/check_op.h"
+#include "base/files/file_path_view.h"
 #include "base/files/safe_base_name.h"
 #include "base/pickle.h"
 #include "base/ranges/algorithm.h"
@@ -107,7 +108,7 @@ bool IsPathAbsolute(StringPieceType path) {
 #endif  // FILE_PATH_USES_DRIVE_LETTERS
 }
 
-bool AreAllSeparators(const StringType& input) {
+bool AreAllSeparators(StringPieceType input) {
   for (auto it : input) {
     if (!FilePath::IsSeparator(it))
       return false;
@@ -119,10 +120,11 @@ bool AreAllSeparators(const StringType& input) {
 // Find the position of the '.' that separates the extension from the rest
 // of the file name. The position is relative to BaseName(), not value().
 // Returns npos if it can't find an extension.
-StringType::size_type FinalExtensionSeparatorPosition(const StringType& path) {
+StringPieceType::size_type FinalExtensionSeparatorPosition(
+    StringPieceType path) {
   // Special case "." and ".."
   if (path == FilePath::kCurrentDirectory || path == FilePath::kParentDirectory)
-    return StringType::npos;
+    return StringPieceType::npos;
 
   return path.rfind(FilePath::kExtensionSeparator);
 }
@@ -131,32 +133,33 @@ StringType::size_type FinalExtensionSeparatorPosition(const StringType& path) {
 // characters when the rightmost extension component is a common double
 // extension (gz, bz2, Z).  For example, foo.tar.gz or foo.tar.Z would have
 // extension components of '.tar.gz' and '.tar.Z' respectively.
-StringType::size_type ExtensionSeparatorPosition(const StringType& path) {
-  const StringType::size_type last_dot = FinalExtensionSeparatorPosition(path);
+StringPieceType::size_type ExtensionSeparatorPosition(StringPieceType path) {
+  const StringPieceType::size_type last_dot =
+      FinalExtensionSeparatorPosition(path);
 
   // No extension, or the extension is the whole filename.
-  if (last_dot == StringType::npos || last_dot == 0U)
+  if (last_dot == StringPieceType::npos || last_dot == 0U)
     return last_dot;
 
-  const StringType::size_type penultimate_dot =
+  const StringPieceType::size_type penultimate_dot =
       path.rfind(FilePath::kExtensionSeparator, last_dot - 1);
-  const StringType::size_type last_separator =
+  const StringPieceType::size_type last_separator =
       path.find_last_of(FilePath::kSeparators, last_dot - 1,
                         FilePath::kSeparatorsLength - 1);
 
-  if (penultimate_dot == StringType::npos ||
-      (last_separator != StringType::npos &&
+  if (penultimate_dot == StringPieceType::npos ||
+      (last_separator != StringPieceType::npos &&
        penultimate_dot < last_separator)) {
     return last_dot;
   }
 
   for (auto* i : kCommonDoubleExtensions) {
-    StringType extension(path, penultimate_dot + 1);
+    StringPieceType extension = path.substr(penultimate_dot + 1);
     if (LowerCaseEqualsASCII(extension, i))
       return penultimate_dot;
   }
 
-  StringType extension(path, last_dot + 1);
+  StringPieceType extension = path.substr(last_dot + 1);
   for (auto* i : kCommonDoubleExtensionSuffixes) {
     if (LowerCaseEqualsASCII(extension, i)) {
       if ((last_dot - penultimate_dot) <= 5U &&
@@ -170,7 +173,7 @@ StringType::size_type ExtensionSeparatorPosition(const StringType& path) {
 }
 
 // Returns true if path is "", ".", or "..".
-bool IsEmptyOrSpecialCase(const StringType& path) {
+bool IsEmptyOrSpecialCase(StringPieceType path) {
   // Special cases "", ".", and ".."
   if (path.empty() || path == FilePath::kCurrentDirectory ||
       path == FilePath::kParentDirectory) {
@@ -180,6 +183,35 @@ bool IsEmptyOrSpecialCase(const StringType& path) {
   return false;
 }
 
+// Returns the length of |path| without its trailing separators. If the path
+// is absolute, it is never stripped any more than to refer to the absolute
+// root directory, so "////" becomes "/", not "". A leading pair of separators
+// is never stripped, to support alternate roots. This is used to support UNC
+// paths on Windows.
+StringPieceType::size_type LengthWithoutTrailingSeparators(
+    StringPieceType path) {
+  // If there is no drive letter, start will be 1, which will prevent stripping
+  // the leading separator if there is only one separator.  If there is a drive
+  // letter, start will be set appropriately to prevent stripping the first
+  // separator following the drive letter, if a separator immediately follows
+  // the drive letter.
+  StringPieceType::size_type start = FindDriveLetter(path) + 2;
+
+  StringPieceType::size_type length = path.length();
+  StringPieceType::size_type last_stripped = StringPieceType::npos;
+  for (StringPieceType::size_type pos = path.length();
+       pos > start && FilePath::IsSeparator(path[pos - 1]); --pos) {
+    // If the string only has two separators and they're at the beginning,
+    // don't strip them, unless the string began with more than two separators.
+    if (pos != start + 1 || last_stripped == start + 2 ||
+        !FilePath::IsSeparator(path[start - 1])) {
+      length = pos - 1;
+      last_stripped = pos;
+    }
+  }
+  return length;
+}
+
 }  // namespace
 
 FilePath::FilePath() = default;
@@ -317,107 +349,28 @@ bool FilePath::AppendRelativePath(const FilePath& child,
   return true;
 }
 
-// libgen's dirname and basename aren't guaranteed to be thread-safe and aren't
-// guaranteed to not modify their input strings, and in fact are implemented
-// differently in this regard on different platforms.  Don't use them, but
-// adhere to their behavior.
 FilePath FilePath::DirName() const {
-  FilePath new_path(path_);
-  new_path.StripTrailingSeparatorsInternal();
-
-  // The drive letter, if any, always needs to remain in the output.  If there
-  // is no drive letter, as will always be the case on platforms which do not
-  // support drive letters, letter will be npos, or -1, so the comparisons and
-  // resizes below using letter will still be valid.
-  StringType::size_type letter = FindDriveLetter(new_path.path_);
-
-  StringType::size_type last_separator =
-      new_path.path_.find_last_of(kSeparators, StringType::npos,
-                                  kSeparatorsLength - 1);
-  if (last_separator == StringType::npos) {
-    // path_ is in the current directory.
-    new_path.path_.resize(letter + 1);
-  } else if (last_separator == letter + 1) {
-    // path_ is in the root directory.
-    new_path.path_.resize(letter + 2);
-  } else if (last_separator == letter + 2 &&
-             IsSeparator(new_path.path_[letter + 1])) {
-    // path_ is in "//" (possibly with a drive letter); leave the double
-    // separator intact indicating alternate root.
-    new_path.path_.resize(letter + 3);
-  } else if (last_separator != 0) {
-    // path_ is somewhere else, trim the basename.
-    new_path.path_.resize(last_separator);
-  }
-
-  new_path.StripTrailingSeparatorsInternal();
-  if (!new_path.path_.length())
-    new_path.path_ = kCurrentDirectory;
-
-  return new_path;
+  return FilePath(FilePathView(*this).DirName().value());
 }
 
 FilePath FilePath::BaseName() const {
-  FilePath new_path(path_);
-  new_path.StripTrailingSeparatorsInternal();
-
-  // The drive letter, if any, is always stripped.
-  StringType::size_type letter = FindDriveLetter(new_path.path_);
-  if (letter != StringType::npos) {
-    new_path.path_.erase(0, letter + 1);
-  }
-
-  // Keep everything after the final separator, but if the pathname is only
-  // one character and it's a separator, leave it alone.
-  StringType::size_type last_separator =
-      new_path.path_.find_last_of(kSeparators, StringType::npos,
-                                  kSeparatorsLength - 1);
-  if (last_separator != StringType::npos &&
-      last_separator < new_path.path_.length() - 1) {
-    new_path.path_.erase(0, last_separator + 1);
-  }
-
-  return new_path;
+  return FilePath(FilePathView(*this).BaseName().value());
 }
 
 StringType FilePath::Extension() const {
-  FilePath base(BaseName());
-  const StringType::size_type dot = ExtensionSeparatorPosition(base.path_);
-  if (dot == StringType::npos)
-    return StringType();
-
-  return base.path_.substr(dot, StringType::npos);
+  return StringType(FilePathView(*this).Extension());
 }
 
 StringType FilePath::FinalExtension() const {
-  FilePath base(BaseName());
-  const StringType::size_type dot = FinalExtensionSeparatorPosition(base.path_);
-  if (dot == StringType::npos)
-    return StringType();
-
-  return base.path_.substr(dot, StringType::npos);
+  return StringType(FilePathView(*this).FinalExtension());
 }
 
 FilePath FilePath::RemoveExtension() const {
-  if (Extension().empty())
-    return *this;
-
-  const StringType::size_type dot = ExtensionSeparatorPosition(path_);
-  if (dot == StringType::npos)
-    return *this;
-
-  return FilePath(path_.substr(0, dot));
+  return FilePath(FilePathView(*this).RemoveExtension().value());
 }
 
 FilePath FilePath::RemoveFinalExtension() const {
-  if (FinalExtension().empty())
-    return *this;
-
-  const StringType::size_type dot = FinalExtensionSeparatorPosition(path_);
-  if (dot == StringType::npos)
-    return *this;
-
-  return FilePath(path_.substr(0, dot));
+  return FilePath(FilePathView(*this).RemoveFinalExtension().value());
 }
 
 FilePath FilePath::InsertBeforeExtension(StringPieceType suffix) const {
@@ -442,21 +395,9 @@ FilePath FilePath::InsertBeforeExtensionASCII(StringPiece suffix)
 }
 
 FilePath FilePath::AddExtension(StringPieceType extension) const {
-  if (IsEmptyOrSpecialCase(BaseName().value()))
-    return FilePath();
-
-  // If the new extension is "" or ".", then just return the current FilePath.
-  if (extension.empty() ||
-      (extension.size() == 1 && extension[0] == kExtensionSeparator))
-    return *this;
-
-  StringType str = path_;
-  if (extension[0] != kExtensionSeparator &&
-      *(str.end() - 1) != kExtensionSeparator) {
-    str.append(1, kExtensionSeparator);
-  }
-  str.append(extension.data(), extension.size());
-  return FilePath(str);
+  FilePath new_path;
+  FilePathView(*this).AddExtensionTo(extension, &new_path.path_);
+  return new_path;
 }
 
 FilePath FilePath::AddExtensionASCII(StringPiece extension) const {
@@ -486,68 +427,16 @@ FilePath FilePath::ReplaceExtension(StringPieceType extension) const {
 }
 
 bool FilePath::MatchesExtension(StringPieceType extension) const {
-  DCHECK(extension.empty() || extension[0] == kExtensionSeparator);
-
-  StringType current_extension = Extension();
-
-  if (current_extension.length() != extension.length())
-    return false;
-
-  return FilePath::CompareEqualIgnoreCase(extension, current_extension);
+  return FilePathView(*this).MatchesExtension(extension);
 }
 
 bool FilePath::MatchesFinalExtension(StringPieceType extension) const {
-  DCHECK(extension.empty() || extension[0] == kExtensionSeparator);
-
-  StringType current_final_extension = FinalExtension();
-
-  if (current_final_extension.length() != extension.length())
-    return false;
-
-  return FilePath::CompareEqualIgnoreCase(extension, current_final_extension);
+  return FilePathView(*this).MatchesFinalExtension(extension);
 }
 
 FilePath FilePath::Append(StringPieceType component) const {
-  StringPieceType appended = component;
-  StringType without_nuls;
-
-  StringType::size_type nul_pos = component.find(kStringTerminator);
-  if (nul_pos != StringPieceType::npos) {
-    without_nuls = StringType(component.substr(0, nul_pos));
-    appended = StringPieceType(without_nuls);
-  }
-
-  DCHECK(!IsPathAbsolute(appended));
-
-  if (path_.compare(kCurrentDirectory) == 0 && !appended.empty()) {
-    // Append normally doesn't do any normalization, but as a special case,
-    // when appending to kCurrentDirectory, just return a new path for the
-    // component argument.  Appending component to kCurrentDirectory would
-    // serve no purpose other than needlessly lengthening the path, and
-    // it's likely in practice to wind up with FilePath objects containing
-    // only kCurrentDirectory when calling DirName on a single relative path
-    // component.
-    return FilePath(appended);
-  }
-
-  FilePath new_path(path_);
-  new_path.StripTrailingSeparatorsInternal();
-
-  // Don't append a separator if the path is empty (indicating the current
-  // directory) or if the path component is empty (indicating nothing to
-  // append).
-  if (!appended.empty() && !new_path.path_.empty()) {
-    // Don't append a separator if the path still ends with a trailing
-    // separator after stripping (indicating the root directory).
-    if (!IsSeparator(new_path.path_.back())) {
-      // Don't append a separator if the path is just a drive letter.
-      if (FindDriveLetter(new_path.path_) + 1 != new_path.path_.length()) {
-        new_path.path_.append(1, kSeparators[0]);
-      }
-    }
-  }
-
-  new_path.path_.append(appended.data(), appended.size());
+  FilePath new_path;
+  FilePathView(*this).AppendTo(component, &new_path.path_);
   return new_path;
 }
 
@@ -1358,25 +1247,7 @@ int FilePath::CompareIgnoreCase(StringPieceType string1,
 
 
 void FilePath::StripTrailingSeparatorsInternal() {
-  // If there is no drive letter, start will be 1, which will prevent stripping
-  // the leading separator if there is only one separator.  If there is a drive
-  // letter, start will be set appropriately to prevent stripping the first
-  // separator following the drive letter, if a separator immediately follows
-  // the drive letter.
-  StringType::size_type start = FindDriveLetter(path_) + 2;
-
-  StringType::size_type last_stripped = StringType::npos;
-  for (StringType::size_type pos = path_.length();
-       pos > start && IsSeparator(path_[pos - 1]);
-       --pos) {
-    // If the string only has two separators and they're at the beginning,
-    // don't strip them, unless the string began with more than two separators.
-    if (pos != start + 1 || last_stripped == start + 2 ||
-        !IsSeparator(path_[start - 1])) {
-      path_.resize(pos - 1);
-      last_stripped = pos;
-    }
-  }
+  path_.resize(LengthWithoutTrailingSeparators(path_));
 }
 
 FilePath FilePath::NormalizePathSeparators() const {
@@ -1407,4 +1278,230 @@ bool FilePath::IsContentUri() const {
 }
 #endif
 
+// FilePathView ----------------------------------------------------------------
+
+FilePathView::FilePathView(StringPieceType path)
+    : path_(path.substr(0, path.find(kStringTerminator))) {}
+
+// libgen's dirname and basename aren't guaranteed to be thread-safe and aren't
+// guaranteed to not modify their input strings, and in fact are implemented
+// differently in this regard on different platforms.  Don't use them, but
+// adhere to their behavior.
+FilePathView FilePathView::DirName() const {
+  StringPieceType path =
+      path_.substr(0, LengthWithoutTrailingSeparators(path_));
+
+  // The drive letter, if any, always needs to remain in the output.  If there
+  // is no drive letter, as will always be the case on platforms which do not
+  // support drive letters, letter will be npos, or -1, so the comparisons and
+  // substrings below using letter will still be valid.
+  StringPieceType::size_type letter = FindDriveLetter(path);
+
+  StringPieceType::size_type last_separator = path.find_last_of(
+      FilePath::kSeparators, StringPieceType::npos,
+      FilePath::kSeparatorsLength - 1);
+  if (last_separator == StringPieceType::npos) {
+    // path is in the current directory.
+    path = path.substr(0, letter + 1);
+  } else if (last_separator == letter + 1) {
+    // path is in the root directory.
+    path = path.substr(0, letter + 2);
+  } else if (last_separator == letter + 2 &&
+             FilePath::IsSeparator(path[letter + 1])) {
+    // path is in "//" (possibly with a drive letter); leave the double
+    // separator intact indicating alternate root.
+    path = path.substr(0, letter + 3);
+  } else if (last_separator != 0) {
+    // path is somewhere else, trim the basename.
+    path = path.substr(0, last_separator);
+  }
+
+  path = path.substr(0, LengthWithoutTrailingSeparators(path));
+  if (path.empty())
+    path = FilePath::kCurrentDirectory;
+
+  return FilePathView(path, NoNulsTag());
+}
+
+FilePathView FilePathView::BaseName() const {
+  StringPieceType path =
+      path_.substr(0, LengthWithoutTrailingSeparators(path_));
+
+  // The drive letter, if any, is always stripped.
+  StringPieceType::size_type letter = FindDriveLetter(path);
+  if (letter != StringPieceType::npos)
+    path = path.substr(letter + 1);
+
+  // Keep everything after the final separator, but if the pathname is only
+  // one character and it's a separator, leave it alone.
+  StringPieceType::size_type last_separator = path.find_last_of(
+      FilePath::kSeparators, StringPieceType::npos,
+      FilePath::kSeparatorsLength - 1);
+  if (last_separator != StringPieceType::npos &&
+      last_separator < path.length() - 1) {
+    path = path.substr(last_separator + 1);
+  }
+
+  return FilePathView(path, NoNulsTag());
+}
+
+StringPieceType FilePathView::Extension() const {
+  StringPieceType base = BaseName().path_;
+  const StringPieceType::size_type dot = ExtensionSeparatorPosition(base);
+  if (dot == StringPieceType::npos)
+    return StringPieceType();
+
+  return base.substr(dot);
+}
+
+StringPieceType FilePathView::FinalExtension() const {
+  StringPieceType base = BaseName().path_;
+  const StringPieceType::size_type dot = FinalExtensionSeparatorPosition(base);
+  if (dot == StringPieceType::npos)
+    return StringPieceType();
+
+  return base.substr(dot);
+}
+
+FilePathView FilePathView::RemoveExtension() const {
+  if (Extension().empty())
+    return *this;
+
+  const StringPieceType::size_type dot = ExtensionSeparatorPosition(path_);
+  if (dot == StringPieceType::npos)
+    return *this;
+
+  return FilePathView(path_.substr(0, dot), NoNulsTag());
+}
+
+FilePathView FilePathView::RemoveFinalExtension() const {
+  if (FinalExtension().empty())
+    return *this;
+
+  const StringPieceType::size_type dot = FinalExtensionSeparatorPosition(path_);
+  if (dot == StringPieceType::npos)
+    return *this;
+
+  return FilePathView(path_.substr(0, dot), NoNulsTag());
+}
+
+FilePathView FilePathView::StripTrailingSeparators() const {
+  return FilePathView(path_.substr(0, LengthWithoutTrailingSeparators(path_)),
+                      NoNulsTag());
+}
+
+bool FilePathView::MatchesExtension(StringPieceType extension) const {
+  DCHECK(extension.empty() || extension[0] == FilePath::kExtensionSeparator);
+
+  StringPieceType current_extension = Extension();
+
+  if (current_extension.length() != extension.length())
+    return false;
+
+  return FilePath::CompareEqualIgnoreCase(extension, current_extension);
+}
+
+bool FilePathView::MatchesFinalExtension(StringPieceType extension) const {
+  DCHECK(extension.empty() || extension[0] == FilePath::kExtensionSeparator);
+
+  StringPieceType current_final_extension = FinalExtension();
+
+  if (current_final_extension.length() != extension.length())
+    return false;
+
+  return FilePath::CompareEqualIgnoreCase(extension, current_final_extension);
+}
+
+bool FilePathView::IsAbsolute() const {
+  return IsPathAbsolute(path_);
+}
+
+bool FilePathView::EndsWithSeparator() const {
+  return !path_.empty() && FilePath::IsSeparator(path_.back());
+}
+
+FilePathView FilePathView::AppendTo(StringPieceType component,
+                                    StringType* buffer) const {
+  const StringPieceType appended =
+      component.substr(0, component.find(kStringTerminator));
+
+  DCHECK(!IsPathAbsolute(appended));
+
+  if (path_ == FilePath::kCurrentDirectory && !appended.empty()) {
+    // Append normally doesn't do any normalization, but as a special case,
+    // when appending to kCurrentDirectory, just return a new path for the
+    // component argument.  Appending component to kCurrentDirectory would
+    // serve no purpose other than needlessly lengthening the path, and
+    // it's likely in practice to wind up with FilePath objects containing
+    // only kCurrentDirectory when calling DirName on a single relative path
+    // component.
+    buffer->assign(appended.data(), appended.size());
+    return FilePathView(*buffer, NoNulsTag());
+  }
+
+  const StringPieceType::size_type length =
+      LengthWithoutTrailingSeparators(path_);
+  // Appending to |buffer| itself keeps it, without copying it.
+  if (path_.data() == buffer->data() && length <= buffer->size())
+    buffer->resize(length);
+  else
+    buffer->assign(path_.data(), length);
+  buffer->reserve(length + 1 + appended.size());
+
+  // Don't append a separator if the path is empty (indicating the current
+  // directory) or if the path component is empty (indicating nothing to
+  // append).
+  if (!appended.empty() && !buffer->empty()) {
+    // Don't append a separator if the path still ends with a trailing
+    // separator after stripping (indicating the root directory).
+    if (!FilePath::IsSeparator(buffer->back())) {
+      // Don't append a separator if the path is just a drive letter.
+      if (FindDriveLetter(*buffer) + 1 != buffer->length())
+        buffer->append(1, FilePath::kSeparators[0]);
+    }
+  }
+
+  buffer->append(appended.data(), appended.size());
+  return FilePathView(*buffer, NoNulsTag());
+}
+
+FilePathView FilePathView::AddExtensionTo(StringPieceType extension,
+                                          StringType* buffer) const {
+  if (IsEmptyOrSpecialCase(BaseName().path_)) {
+    buffer->clear();
+    return FilePathView(*buffer, NoNulsTag());
+  }
+
+  if (path_.data() != buffer->data() || path_.size() > buffer->size())
+    buffer->assign(path_.data(), path_.size());
+  else
+    buffer->resize(path_.size());
+
+  // If the new extension is "" or ".", then just return the current path.
+  if (extension.empty() ||
+      (extension.size() == 1 && extension[0] == FilePath::kExtensionSeparator))
+    return FilePathView(*buffer, NoNulsTag());
+
+  buffer->reserve(buffer->size() + 1 + extension.size());
+  if (extension[0] != FilePath::kExtensionSeparator &&
+      buffer->back() != FilePath::kExtensionSeparator) {
+    buffer->append(1, FilePath::kExtensionSeparator);
+  }
+  extension = extension.substr(0, extension.find(kStringTerminator));
+  buffer->append(extension.data(), extension.size());
+  return FilePathView(*buffer, NoNulsTag());
+}
+
+bool operator==(FilePathView lhs, FilePathView rhs) {
+#if defined(FILE_PATH_USES_DRIVE_LETTERS)
+  return EqualDriveLetterCaseInsensitive(lhs.path_, rhs.path_);
+#else   // defined(FILE_PATH_USES_DRIVE_LETTERS)
+  return lhs.path_ == rhs.path_;
+#endif  // defined(FILE_PATH_USES_DRIVE_LETTERS)
+}
+
+std::ostream& operator<<(std::ostream& out, FilePathView path) {
+  return out << path.value();
+}
+
 }  // namespace base
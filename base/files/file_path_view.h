@@ -0,0 +1,84 @@
+// Copyright 2022 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#ifndef BASE_FILES_FILE_PATH_VIEW_H_
+#define BASE_FILES_FILE_PATH_VIEW_H_
+
+#include "base/base_export.h"
+#include "base/files/file_path.h"
+
+namespace base {
+
+// A non-owning FilePath: a path held by a FilePath, a string or a buffer,
+// with the component queries of FilePath. DirName(), BaseName(), Extension()
+// and the like return parts of the viewed path, so they don't allocate, and
+// AppendTo() and AddExtensionTo() write into a buffer that the caller reuses
+// from one path to the next:
+//
+//   FilePath::StringType buffer;
+//   for (const auto& name : names) {
+//     FilePathView path = FilePathView(dir).AppendTo(name, &buffer);
+//     if (path.MatchesExtension(FILE_PATH_LITERAL(".txt")))
+//       ...
+//   }
+//
+// As with StringPiece, the viewed path must outlive the view, and modifying
+// a buffer invalidates the views of it.
+class BASE_EXPORT FilePathView {
+ public:
+  using CharType = FilePath::CharType;
+  using StringType = FilePath::StringType;
+  using StringPieceType = FilePath::StringPieceType;
+
+  constexpr FilePathView() = default;
+  // Views |path| up to its first NUL, as FilePath keeps it.
+  explicit FilePathView(StringPieceType path);
+  // NOLINTNEXTLINE(google-explicit-constructor)
+  FilePathView(const FilePath& path) : path_(path.value()) {}
+
+  StringPieceType value() const { return path_; }
+  bool empty() const { return path_.empty(); }
+
+  // Returns a FilePath holding a copy of the viewed path.
+  FilePath ToFilePath() const { return FilePath(path_); }
+
+  // Same as the FilePath methods of the same names.
+  FilePathView DirName() const;
+  FilePathView BaseName() const;
+  StringPieceType Extension() const;
+  StringPieceType FinalExtension() const;
+  FilePathView RemoveExtension() const;
+  FilePathView RemoveFinalExtension() const;
+  FilePathView StripTrailingSeparators() const;
+  bool MatchesExtension(StringPieceType extension) const;
+  bool MatchesFinalExtension(StringPieceType extension) const;
+  bool IsAbsolute() const;
+  bool EndsWithSeparator() const;
+
+  // Writes into |buffer| the path that FilePath::Append() and
+  // FilePath::AddExtension() would return, and returns a view of it. The
+  // viewed path may be |buffer| itself, e.g. to append several components,
+  // but |component| and |extension| must not point into |buffer|.
+  FilePathView AppendTo(StringPieceType component, StringType* buffer) const;
+  FilePathView AddExtensionTo(StringPieceType extension,
+                              StringType* buffer) const;
+
+  // Compares the paths as FilePath does.
+  friend BASE_EXPORT bool operator==(FilePathView lhs, FilePathView rhs);
+  friend bool operator!=(FilePathView lhs, FilePathView rhs) {
+    return !(lhs == rhs);
+  }
+
+ private:
+  struct NoNulsTag {};
+  constexpr FilePathView(StringPieceType path, NoNulsTag) : path_(path) {}
+
+  StringPieceType path_;
+};
+
+BASE_EXPORT std::ostream& operator<<(std::ostream& out, FilePathView path);
+
+}  // namespace base
+
+#endif  // BASE_FILES_FILE_PATH_VIEW_H_
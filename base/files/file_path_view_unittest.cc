@@ -0,0 +1,140 @@
+// Copyright 2022 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "base/files/file_path_view.h"
+
+#include "base/files/file_path.h"
+#include "build/build_config.h"
+#include "testing/gtest/include/gtest/gtest.h"
+
+// This macro helps avoid wrapped lines in the test structs.
+#define FPL(x) FILE_PATH_LITERAL(x)
+
+namespace base {
+
+namespace {
+
+// Paths covering the special cases of the FilePath component queries.
+const FilePath::CharType* const kPaths[] = {
+    FPL(""),
+    FPL("."),
+    FPL(".."),
+    FPL("aa"),
+    FPL("aa/"),
+    FPL("/"),
+    FPL("//"),
+    FPL("///"),
+    FPL("//aa"),
+    FPL("/aa/bb//"),
+    FPL("/aa/bb/ccc"),
+    FPL("aa/bb.txt"),
+    FPL("aa/bb.tar.gz"),
+    FPL("aa/bb.user.js"),
+    FPL("aa.bb/cc"),
+    FPL("aa/.bb"),
+    FPL("aa/bb."),
+    FPL("aa/bb.txt/"),
+#if defined(FILE_PATH_USES_DRIVE_LETTERS)
+    FPL("c:"),
+    FPL("c:aa"),
+    FPL("c:/"),
+    FPL("c://aa"),
+    FPL("C:\\aa\\bb.txt"),
+#endif  // FILE_PATH_USES_DRIVE_LETTERS
+#if defined(FILE_PATH_USES_WIN_SEPARATORS)
+    FPL("\\\\aa\\bb"),
+    FPL("aa\\bb.tar.gz\\"),
+#endif  // FILE_PATH_USES_WIN_SEPARATORS
+};
+
+}  // namespace
+
+TEST(FilePathViewTest, SameAsFilePath) {
+  for (const FilePath::CharType* input : kPaths) {
+    const FilePath path(input);
+    const FilePathView view(path);
+    EXPECT_EQ(path.value(), view.value()) << path;
+    EXPECT_EQ(path.DirName().value(), view.DirName().value()) << path;
+    EXPECT_EQ(path.BaseName().value(), view.BaseName().value()) << path;
+    EXPECT_EQ(path.Extension(), view.Extension()) << path;
+    EXPECT_EQ(path.FinalExtension(), view.FinalExtension()) << path;
+    EXPECT_EQ(path.RemoveExtension().value(), view.RemoveExtension().value())
+        << path;
+    EXPECT_EQ(path.RemoveFinalExtension().value(),
+              view.RemoveFinalExtension().value())
+        << path;
+    EXPECT_EQ(path.StripTrailingSeparators().value(),
+              view.StripTrailingSeparators().value())
+        << path;
+    EXPECT_EQ(path.IsAbsolute(), view.IsAbsolute()) << path;
+    EXPECT_EQ(path.EndsWithSeparator(), view.EndsWithSeparator()) << path;
+    EXPECT_EQ(path.MatchesExtension(FPL(".TXT")),
+              view.MatchesExtension(FPL(".TXT")))
+        << path;
+    EXPECT_EQ(path.MatchesFinalExtension(FPL(".gz")),
+              view.MatchesFinalExtension(FPL(".gz")))
+        << path;
+
+    FilePath::StringType buffer;
+    EXPECT_EQ(path.Append(FPL("cc")).value(),
+              view.AppendTo(FPL("cc"), &buffer).value())
+        << path;
+    EXPECT_EQ(path.AddExtension(FPL("ext")).value(),
+              view.AddExtensionTo(FPL("ext"), &buffer).value())
+        << path;
+  }
+}
+
+TEST(FilePathViewTest, ViewsParts) {
+  const FilePath::StringType path = FPL("/aa/bb.tar.gz");
+  const FilePathView view(path);
+  EXPECT_EQ(path.data(), view.DirName().value().data());
+  EXPECT_EQ(path.data() + 4, view.BaseName().value().data());
+  EXPECT_EQ(path.data() + 6, view.Extension().data());
+  EXPECT_EQ(path.data() + 10, view.FinalExtension().data());
+  EXPECT_EQ(path.data(), view.RemoveExtension().value().data());
+}
+
+TEST(FilePathViewTest, StopsAtNul) {
+  const FilePath::StringType path(FPL("aa/bb\0cc"), 8);
+  EXPECT_EQ(FPL("aa/bb"), FilePathView(path).value());
+  EXPECT_EQ(FilePath(path).value(), FilePathView(path).value());
+}
+
+TEST(FilePathViewTest, AppendToReusesBuffer) {
+  const FilePath dir(FPL("aa/"));
+  FilePath::StringType buffer;
+  FilePathView path = FilePathView(dir).AppendTo(FPL("bb"), &buffer);
+  EXPECT_EQ(dir.Append(FPL("bb")).value(), path.value());
+
+  // Appending to the buffer itself, as for joining several components.
+  path = path.AppendTo(FPL("cc"), &buffer);
+  path = path.AppendTo(FPL("dd.txt"), &buffer);
+  EXPECT_EQ(dir.Append(FPL("bb")).Append(FPL("cc")).Append(FPL("dd.txt")),
+            path.ToFilePath());
+  EXPECT_EQ(buffer.data(), path.value().data());
+  path = path.DirName().AppendTo(FPL("ee"), &buffer);
+  EXPECT_EQ(dir.Append(FPL("bb")).Append(FPL("cc")).Append(FPL("ee")),
+            path.ToFilePath());
+
+  // The buffer keeps its capacity from one path to the next.
+  const FilePath::CharType* const data = buffer.data();
+  path = FilePathView(dir).AppendTo(FPL("ff"), &buffer);
+  EXPECT_EQ(dir.Append(FPL("ff")), path.ToFilePath());
+  EXPECT_EQ(data, buffer.data());
+
+  path = path.AddExtensionTo(FPL("txt"), &buffer);
+  EXPECT_EQ(dir.Append(FPL("ff.txt")), path.ToFilePath());
+  EXPECT_EQ(data, buffer.data());
+}
+
+TEST(FilePathViewTest, Equality) {
+  EXPECT_EQ(FilePathView(FilePath(FPL("aa/bb"))), FilePathView(FPL("aa/bb")));
+  EXPECT_NE(FilePathView(FPL("aa/bb")), FilePathView(FPL("aa/cc")));
+#if defined(FILE_PATH_USES_DRIVE_LETTERS)
+  EXPECT_EQ(FilePathView(FPL("c:/aa")), FilePathView(FPL("C:/aa")));
+#endif  // FILE_PATH_USES_DRIVE_LETTERS
+}
+
+}  // namespace base
@@ -7,8 +7,10 @@
 
 #include "base/files/file_path_watcher.h"
 
+#include "base/bind.h"
 #include "base/check.h"
 #include "base/files/file_path.h"
+#include "base/location.h"
 #include "build/build_config.h"
 
 namespace base {
@@ -35,6 +37,13 @@ FilePathWatcher::PlatformDelegate::~PlatformDelegate() {
   DCHECK(is_cancelled());
 }
 
+bool FilePathWatcher::PlatformDelegate::WatchWithChangedPath(
+    const FilePath& path,
+    Type type,
+    const Callback& callback) {
+  return Watch(path, type, callback);
+}
+
 bool FilePathWatcher::Watch(const FilePath& path,
                             Type type,
                             const Callback& callback) {
@@ -43,4 +52,46 @@ bool FilePathWatcher::Watch(const FilePath& path,
   return impl_->Watch(path, type, callback);
 }
 
+FilePathWatcher::ChangeBatcher::ChangeBatcher(TimeDelta window,
+                                              const ChangesCallback& callback)
+    : window_(window), callback_(callback) {}
+
+FilePathWatcher::ChangeBatcher::~ChangeBatcher() = default;
+
+void FilePathWatcher::ChangeBatcher::OnChange(const FilePath& path,
+                                              bool error) {
+  if (!error) {
+    changes_.insert(path);
+    if (!timer_.IsRunning()) {
+      timer_.Start(FROM_HERE, window_,
+                   BindOnce(&ChangeBatcher::RunCallback, Unretained(this)));
+    }
+    return;
+  }
+  timer_.Stop();
+  std::vector<FilePath> changes(changes_.begin(), changes_.end());
+  changes_.clear();
+  callback_.Run(changes, /*error=*/true);  // `this` may be deleted.
+}
+
+void FilePathWatcher::ChangeBatcher::RunCallback() {
+  std::vector<FilePath> changes(changes_.begin(), changes_.end());
+  changes_.clear();
+  callback_.Run(changes, /*error=*/false);  // `this` may be deleted.
+}
+
+bool FilePathWatcher::WatchWithBatchedChanges(const FilePath& path,
+                                              Type type,
+                                              TimeDelta window,
+                                              const ChangesCallback& callback) {
+  DCHECK(sequence_checker_.CalledOnValidSequence());
+  DCHECK(path.IsAbsolute());
+  DCHECK(!batcher_);
+  batcher_ = std::make_unique<ChangeBatcher>(window, callback);
+  // Unretained() is safe: |batcher_| outlives |impl_|.
+  return impl_->WatchWithChangedPath(
+      path, type,
+      BindRepeating(&ChangeBatcher::OnChange, Unretained(batcher_.get())));
+}
+
 }  // namespace base
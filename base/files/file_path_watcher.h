@@ -8,19 +8,22 @@
 #define BASE_FILES_FILE_PATH_WATCHER_H_
 
 #include <memory>
+#include <set>
 #include <utility>
+#include <vector>
 
 #include "base/base_export.h"
-#include "base/callback_forward.h"
+#include "base/callback.h"
+#include "base/files/file_path.h"
 #include "base/memory/scoped_refptr.h"
 #include "base/sequence_checker.h"
 #include "base/task/sequenced_task_runner.h"
+#include "base/time/time.h"
+#include "base/timer/timer.h"
 #include "build/build_config.h"
 
 namespace base {
 
-class FilePath;
-
 // This class lets you register interest in changes on a FilePath.
 // The callback will get called whenever the file or directory referenced by the
 // FilePath is changed, including created or deleted. Due to limitations in the
@@ -59,6 +62,14 @@ class BASE_EXPORT FilePathWatcher {
   using Callback =
       base::RepeatingCallback<void(const FilePath& path, bool error)>;
 
+  // Callback type for WatchWithBatchedChanges(). |paths| are the files that
+  // changed since the previous run, each once and in no particular order, and
+  // |error| is true if the platform specific code detected an error. In that
+  // case, the callback won't be invoked again.
+  using ChangesCallback =
+      base::RepeatingCallback<void(const std::vector<FilePath>& paths,
+                                   bool error)>;
+
   // Used internally to encapsulate different members on different platforms.
   class PlatformDelegate {
    public:
@@ -74,6 +85,13 @@ class BASE_EXPORT FilePathWatcher {
                                      Type type,
                                      const Callback& callback) = 0;
 
+    // Like Watch(), but |callback| gets the path of the file that changed
+    // where the platform knows it, e.g. a file in a watched directory, rather
+    // than |path|. Defaults to Watch().
+    [[nodiscard]] virtual bool WatchWithChangedPath(const FilePath& path,
+                                                    Type type,
+                                                    const Callback& callback);
+
     // Stop watching. This is called from FilePathWatcher's dtor in order to
     // allow to shut down properly while the object is still alive.
     virtual void Cancel() = 0;
@@ -126,7 +144,44 @@ class BASE_EXPORT FilePathWatcher {
   // FileDescriptorWatcher.
   bool Watch(const FilePath& path, Type type, const Callback& callback);
 
+  // Like Watch(), but the changes are delivered in batches: the ones that
+  // happen within |window| of the first one are reported together once it
+  // elapses, which spares the callback for each step of an update touching
+  // many files. On Linux, |paths| are the files that changed under |path|;
+  // elsewhere, they are |path| itself. An error is reported at once, along
+  // with the changes still pending.
+  bool WatchWithBatchedChanges(const FilePath& path,
+                               Type type,
+                               TimeDelta window,
+                               const ChangesCallback& callback);
+
  private:
+  // Collects the changes reported within a window of the first one, to run
+  // the callback of WatchWithBatchedChanges() with them together.
+  class ChangeBatcher {
+   public:
+    ChangeBatcher(TimeDelta window, const ChangesCallback& callback);
+    ChangeBatcher(const ChangeBatcher&) = delete;
+    ChangeBatcher& operator=(const ChangeBatcher&) = delete;
+    ~ChangeBatcher();
+
+    void OnChange(const FilePath& path, bool error);
+
+   private:
+    void RunCallback();
+
+    const TimeDelta window_;
+    const ChangesCallback callback_;
+
+    // The paths changed since the callback last ran.
+    std::set<FilePath> changes_;
+
+    OneShotTimer timer_;
+  };
+
+  // Set by WatchWithBatchedChanges(). Outlives |impl_|, which reports to it.
+  std::unique_ptr<ChangeBatcher> batcher_;
+
   std::unique_ptr<PlatformDelegate> impl_;
 
   SequenceChecker sequence_checker_;
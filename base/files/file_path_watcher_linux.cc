@@ -5,6 +5,7 @@
 #include "base/files/file_path_watcher.h"
 
 #include <errno.h>
+#include <fcntl.h>
 #include <poll.h>
 #include <stddef.h>
 #include <string.h>
@@ -13,6 +14,11 @@
 #include <sys/select.h>
 #include <unistd.h>
 
+#if BUILDFLAG(IS_LINUX) || BUILDFLAG(IS_CHROMEOS)
+#include <sys/fanotify.h>
+#include <sys/statfs.h>
+#endif
+
 #include <algorithm>
 #include <array>
 #include <fstream>
@@ -29,6 +35,7 @@
 #include "base/files/file_path.h"
 #include "base/files/file_path_watcher_linux.h"
 #include "base/files/file_util.h"
+#include "base/files/scoped_file.h"
 #include "base/lazy_instance.h"
 #include "base/location.h"
 #include "base/logging.h"
@@ -36,6 +43,7 @@
 #include "base/memory/scoped_refptr.h"
 #include "base/memory/weak_ptr.h"
 #include "base/posix/eintr_wrapper.h"
+#include "base/strings/string_number_conversions.h"
 #include "base/synchronization/lock.h"
 #include "base/task/single_thread_task_runner.h"
 #include "base/threading/platform_thread.h"
@@ -118,8 +126,10 @@ class InotifyReader {
   // Remove |watch| if it's valid.
   void RemoveWatch(Watch watch, FilePathWatcherImpl* watcher);
 
-  // Invoked on "inotify_reader" thread to notify relevant watchers.
-  void OnInotifyEvent(const inotify_event* event);
+  // Invoked on "inotify_reader" thread with the |size| bytes of events read
+  // into |buffer|, to notify relevant watchers. Each watcher gets one task
+  // for all its events.
+  void OnInotifyEvents(const char* buffer, size_t size);
 
   // Returns true if any paths are actively being watched.
   bool HasWatches();
@@ -127,10 +137,11 @@ class InotifyReader {
  private:
   friend struct LazyInstanceTraitsBase<InotifyReader>;
 
-  // Record of watchers tracked for watch descriptors.
+  // Record of a watcher with watches.
   struct WatcherEntry {
     scoped_refptr<SequencedTaskRunner> task_runner;
     WeakPtr<FilePathWatcherImpl> watcher;
+    size_t watch_count = 0;
   };
 
   InotifyReader();
@@ -143,11 +154,17 @@ class InotifyReader {
 
   Lock lock_;
 
-  // Tracks which FilePathWatcherImpls to be notified on which watches.
-  // The tracked FilePathWatcherImpl is keyed by raw pointers for fast look up
-  // and mapped to a WatchEntry that is used to safely post a notification.
-  std::unordered_map<Watch, std::map<FilePathWatcherImpl*, WatcherEntry>>
-      watchers_ GUARDED_BY(lock_);
+  // Tracks which FilePathWatcherImpls to be notified on which watches. Most
+  // watches have a single watcher, which takes a single node this way, and a
+  // recursive watch of a large tree has many of them.
+  std::unordered_multimap<Watch, FilePathWatcherImpl*> watchers_
+      GUARDED_BY(lock_);
+
+  // The FilePathWatcherImpls in |watchers_|, keyed by raw pointers for fast
+  // look up and mapped to a WatcherEntry that is used to safely post a
+  // notification.
+  std::unordered_map<FilePathWatcherImpl*, WatcherEntry> watcher_entries_
+      GUARDED_BY(lock_);
 
   // File descriptor returned by inotify_init.
   const int inotify_fd_;
@@ -159,6 +176,123 @@ class InotifyReader {
   bool valid_ = false;
 };
 
+#if BUILDFLAG(IS_LINUX) || BUILDFLAG(IS_CHROMEOS)
+
+// The events of the fanotify marks, like the ones of the inotify watches.
+constexpr uint64_t kFanotifyEventMask = FAN_ATTRIB | FAN_CREATE | FAN_DELETE |
+                                        FAN_CLOSE_WRITE | FAN_MOVE | FAN_ONDIR;
+
+// The most directory paths cached per mount by FanotifyReader.
+constexpr size_t kMaxCachedFanotifyDirectories = 16384u;
+
+// Room for the file handles of name_to_handle_at() and the fanotify events.
+union FileHandleStorage {
+  file_handle handle;
+  char bytes[sizeof(file_handle) + MAX_HANDLE_SZ];
+};
+
+class FanotifyReaderThreadDelegate final : public PlatformThread::Delegate {
+ public:
+  explicit FanotifyReaderThreadDelegate(int fanotify_fd)
+      : fanotify_fd_(fanotify_fd) {}
+  FanotifyReaderThreadDelegate(const FanotifyReaderThreadDelegate&) = delete;
+  FanotifyReaderThreadDelegate& operator=(
+      const FanotifyReaderThreadDelegate&) = delete;
+  ~FanotifyReaderThreadDelegate() override = default;
+
+ private:
+  void ThreadMain() override;
+
+  const int fanotify_fd_;
+};
+
+// Singleton to watch whole file systems with fanotify, for the recursive
+// watches. Inotify takes a watch per directory, and the watches of a large
+// tree run out; a fanotify mark covers a file system at once. The marks take
+// CAP_SYS_ADMIN, and the paths of the events take CAP_DAC_READ_SEARCH to find
+// from the directory handles that they come with. Without these, recursive
+// watches use inotify only.
+class FanotifyReader {
+ public:
+  FanotifyReader(const FanotifyReader&) = delete;
+  FanotifyReader& operator=(const FanotifyReader&) = delete;
+
+  // Reports the changes in the subdirectories of directory |path| to
+  // |watcher| until RemoveWatch(), replacing the previous watch of |watcher|.
+  // Changes in |path| itself are left to inotify. Returns false if fanotify
+  // is unavailable or the file system of |path| can't be watched.
+  bool AddWatch(const FilePath& path, FilePathWatcherImpl* watcher);
+
+  // Removes the watch of |watcher| if any.
+  void RemoveWatch(FilePathWatcherImpl* watcher);
+
+  // Invoked on "fanotify_reader" thread with the |size| bytes of events read
+  // into |buffer|, to notify relevant watchers. Each watcher gets one task
+  // for all its changes.
+  void OnFanotifyEvents(const char* buffer, size_t size);
+
+  // Returns true if any paths are actively being watched.
+  bool HasWatches();
+
+ private:
+  friend struct LazyInstanceTraitsBase<FanotifyReader>;
+
+  // A mount of the watched directories. The mark is on its file system, which
+  // may have other mounts, and the events are resolved to paths under it. The
+  // open directory keeps the mount from going away while watched.
+  struct Mount {
+    __kernel_fsid_t fsid;
+    ScopedFD fd;
+    size_t watcher_count = 0;
+    // The paths of the directories by their handles.
+    std::unordered_map<std::string, FilePath> directories;
+  };
+
+  // Record of a watcher with a watch.
+  struct WatcherEntry {
+    int mount_id;
+    // The watched directory, and its real path, which the events report.
+    FilePath path;
+    FilePath real_path;
+    scoped_refptr<SequencedTaskRunner> task_runner;
+    WeakPtr<FilePathWatcherImpl> watcher;
+  };
+
+  FanotifyReader();
+  // There is no destructor because |g_fanotify_reader| is a
+  // base::LazyInstace::Leaky object.
+
+  void RemoveWatchLocked(FilePathWatcherImpl* watcher)
+      EXCLUSIVE_LOCKS_REQUIRED(lock_);
+
+  // Returns whether a mount of the file system |fsid| is watched.
+  bool IsFileSystemWatched(const __kernel_fsid_t& fsid) const
+      EXCLUSIVE_LOCKS_REQUIRED(lock_);
+
+  // Returns the path of the directory |handle| under |mount|, or null if it
+  // is gone.
+  const FilePath* GetDirectory(Mount* mount, const file_handle* handle)
+      EXCLUSIVE_LOCKS_REQUIRED(lock_);
+
+  Lock lock_;
+
+  // The mounts with watchers, by mount ID.
+  std::map<int, Mount> mounts_ GUARDED_BY(lock_);
+
+  std::map<FilePathWatcherImpl*, WatcherEntry> watchers_ GUARDED_BY(lock_);
+
+  // File descriptor returned by fanotify_init.
+  const ScopedFD fanotify_fd_;
+
+  // Thread delegate for the fanotify thread.
+  FanotifyReaderThreadDelegate thread_delegate_;
+
+  // Flag set to true when startup was successful.
+  bool valid_ = false;
+};
+
+#endif  // BUILDFLAG(IS_LINUX) || BUILDFLAG(IS_CHROMEOS)
+
 class FilePathWatcherImpl : public FilePathWatcher::PlatformDelegate {
  public:
   FilePathWatcherImpl();
@@ -166,6 +300,26 @@ class FilePathWatcherImpl : public FilePathWatcher::PlatformDelegate {
   FilePathWatcherImpl& operator=(const FilePathWatcherImpl&) = delete;
   ~FilePathWatcherImpl() override;
 
+  // An event of an inotify watch of this.
+  struct InotifyEvent {
+    InotifyReader::Watch watch;
+    FilePath::StringType child;
+    bool created;
+    bool deleted;
+    bool is_dir;
+  };
+
+  // Called with the events read at once from the watches, on the original
+  // thread.
+  void OnInotifyEvents(std::vector<InotifyEvent> events);
+
+#if BUILDFLAG(IS_LINUX) || BUILDFLAG(IS_CHROMEOS)
+  // Called with the |paths| that changed under the subdirectories of
+  // |target_|, from the events read at once from the fanotify watch, on the
+  // original thread.
+  void OnFanotifyChanges(std::vector<FilePath> paths);
+#endif
+
   // Called for each event coming from the watch on the original thread.
   // |fired_watch| identifies the watch that fired, |child| indicates what has
   // changed, and is relative to the currently watched path for |fired_watch|.
@@ -196,6 +350,12 @@ class FilePathWatcherImpl : public FilePathWatcher::PlatformDelegate {
              Type type,
              const FilePathWatcher::Callback& callback) override;
 
+  // Like Watch(), reporting the files that changed in |path| and under it if
+  // it is a directory.
+  bool WatchWithChangedPath(const FilePath& path,
+                            Type type,
+                            const FilePathWatcher::Callback& callback) override;
+
   // Cancel the watch. This unregisters the instance with InotifyReader.
   void Cancel() override;
 
@@ -251,9 +411,23 @@ class FilePathWatcherImpl : public FilePathWatcher::PlatformDelegate {
 
   bool HasValidWatchVector() const;
 
+  // Returns the path to report for a change to |child| of directory |dir|,
+  // or to |dir| itself if |child| is empty.
+  FilePath GetChangedPath(const FilePath& dir,
+                          const FilePath::StringType& child) const;
+
   // Callback to notify upon changes.
   FilePathWatcher::Callback callback_;
 
+  // Whether |callback_| gets the paths that changed rather than |target_|.
+  bool report_changed_path_ = false;
+
+#if BUILDFLAG(IS_LINUX) || BUILDFLAG(IS_CHROMEOS)
+  // Whether the descendants of |target_| are watched with FanotifyReader
+  // rather than with inotify watches of their own.
+  bool use_fanotify_ = false;
+#endif
+
   // The file or directory we're supposed to watch.
   FilePath target_;
 
@@ -264,14 +438,23 @@ class FilePathWatcherImpl : public FilePathWatcher::PlatformDelegate {
   // |target_| and always stores an empty next component name in |subdir|.
   std::vector<WatchEntry> watches_;
 
-  std::unordered_map<InotifyReader::Watch, FilePath> recursive_paths_by_watch_;
-  std::map<FilePath, InotifyReader::Watch> recursive_watches_by_path_;
+  // The watches of the sub-directories of a recursive |target_| by path, and
+  // the other way around. The paths are held in the former only.
+  using RecursiveWatchMap = std::map<FilePath, InotifyReader::Watch>;
+  RecursiveWatchMap recursive_watches_by_path_;
+  std::unordered_map<InotifyReader::Watch, RecursiveWatchMap::const_iterator>
+      recursive_paths_by_watch_;
 
   WeakPtrFactory<FilePathWatcherImpl> weak_factory_{this};
 };
 
 LazyInstance<InotifyReader>::Leaky g_inotify_reader = LAZY_INSTANCE_INITIALIZER;
 
+#if BUILDFLAG(IS_LINUX) || BUILDFLAG(IS_CHROMEOS)
+LazyInstance<FanotifyReader>::Leaky g_fanotify_reader =
+    LAZY_INSTANCE_INITIALIZER;
+#endif
+
 void InotifyReaderThreadDelegate::ThreadMain() {
   PlatformThread::SetName("inotify_reader");
 
@@ -304,14 +487,8 @@ void InotifyReaderThreadDelegate::ThreadMain() {
       return;
     }
 
-    ssize_t i = 0;
-    while (i < bytes_read) {
-      inotify_event* event = reinterpret_cast<inotify_event*>(&buffer[i]);
-      size_t event_size = sizeof(inotify_event) + event->len;
-      DCHECK(i + event_size <= static_cast<size_t>(bytes_read));
-      g_inotify_reader.Get().OnInotifyEvent(event);
-      i += event_size;
-    }
+    g_inotify_reader.Get().OnInotifyEvents(buffer.data(),
+                                           static_cast<size_t>(bytes_read));
   }
 }
 
@@ -353,8 +530,17 @@ InotifyReader::Watch InotifyReader::AddWatch(
   if (watch == kInvalidWatch)
     return kInvalidWatch;
 
-  watchers_[watch].emplace(std::make_pair(
-      watcher, WatcherEntry{watcher->GetTaskRunner(), watcher->GetWeakPtr()}));
+  auto range = watchers_.equal_range(watch);
+  if (std::none_of(range.first, range.second, [watcher](const auto& entry) {
+        return entry.second == watcher;
+      })) {
+    watchers_.emplace(watch, watcher);
+    WatcherEntry& watcher_entry = watcher_entries_[watcher];
+    if (watcher_entry.watch_count++ == 0) {
+      watcher_entry.task_runner = watcher->GetTaskRunner();
+      watcher_entry.watcher = watcher->GetWeakPtr();
+    }
+  }
 
   return watch;
 }
@@ -365,59 +551,357 @@ void InotifyReader::RemoveWatch(Watch watch, FilePathWatcherImpl* watcher) {
 
   AutoLock auto_lock(lock_);
 
-  auto watchers_it = watchers_.find(watch);
-  if (watchers_it == watchers_.end())
+  auto range = watchers_.equal_range(watch);
+  auto watchers_it =
+      std::find_if(range.first, range.second, [watcher](const auto& entry) {
+        return entry.second == watcher;
+      });
+  if (watchers_it == range.second)
     return;
 
-  auto& watcher_map = watchers_it->second;
-  watcher_map.erase(watcher);
-
-  if (watcher_map.empty()) {
-    watchers_.erase(watchers_it);
+  watchers_.erase(watchers_it);
+  auto watcher_entry_it = watcher_entries_.find(watcher);
+  DCHECK(watcher_entry_it != watcher_entries_.end());
+  if (--watcher_entry_it->second.watch_count == 0)
+    watcher_entries_.erase(watcher_entry_it);
 
+  if (!Contains(watchers_, watch)) {
     ScopedBlockingCall scoped_blocking_call(FROM_HERE,
                                             BlockingType::WILL_BLOCK);
     inotify_rm_watch(inotify_fd_, watch);
   }
 }
 
-void InotifyReader::OnInotifyEvent(const inotify_event* event) {
-  if (event->mask & IN_IGNORED)
+void InotifyReader::OnInotifyEvents(const char* buffer, size_t size) {
+  std::unordered_map<FilePathWatcherImpl*,
+                     std::vector<FilePathWatcherImpl::InotifyEvent>>
+      events_by_watcher;
+  AutoLock auto_lock(lock_);
+
+  size_t i = 0;
+  while (i < size) {
+    const inotify_event* event =
+        reinterpret_cast<const inotify_event*>(&buffer[i]);
+    size_t event_size = sizeof(inotify_event) + event->len;
+    DCHECK(i + event_size <= size);
+    i += event_size;
+    if (event->mask & IN_IGNORED)
+      continue;
+
+    // In racing conditions, RemoveWatch() could grab `lock_` first and remove
+    // the entries for `event->wd`.
+    auto range = watchers_.equal_range(event->wd);
+    if (range.first == range.second)
+      continue;
+
+    FilePath::StringType child(event->len ? event->name
+                                          : FILE_PATH_LITERAL(""));
+    for (auto it = range.first; it != range.second; ++it) {
+      events_by_watcher[it->second].push_back(
+          {event->wd, child, !!(event->mask & (IN_CREATE | IN_MOVED_TO)),
+           !!(event->mask & (IN_DELETE | IN_MOVED_FROM)),
+           !!(event->mask & IN_ISDIR)});
+    }
+  }
+
+  for (auto& it : events_by_watcher) {
+    const WatcherEntry& watcher_entry = watcher_entries_.find(it.first)->second;
+    watcher_entry.task_runner->PostTask(
+        FROM_HERE,
+        BindOnce(&FilePathWatcherImpl::OnInotifyEvents, watcher_entry.watcher,
+                 std::move(it.second)));
+  }
+}
+
+bool InotifyReader::HasWatches() {
+  AutoLock auto_lock(lock_);
+
+  return !watchers_.empty();
+}
+
+#if BUILDFLAG(IS_LINUX) || BUILDFLAG(IS_CHROMEOS)
+
+void FanotifyReaderThreadDelegate::ThreadMain() {
+  PlatformThread::SetName("fanotify_reader");
+
+  alignas(fanotify_event_metadata) char buffer[32 * 1024];
+  while (true) {
+    // Wait until some fanotify events are available.
+    ssize_t bytes_read =
+        HANDLE_EINTR(read(fanotify_fd_, buffer, sizeof(buffer)));
+    if (bytes_read < 0) {
+      DPLOG(WARNING) << "read from fanotify fd failed";
+      return;
+    }
+    g_fanotify_reader.Get().OnFanotifyEvents(buffer,
+                                             static_cast<size_t>(bytes_read));
+  }
+}
+
+FanotifyReader::FanotifyReader()
+    : fanotify_fd_(fanotify_init(FAN_CLASS_NOTIF | FAN_CLOEXEC |
+                                     FAN_REPORT_DFID_NAME,
+                                 O_RDONLY | O_CLOEXEC)),
+      thread_delegate_(fanotify_fd_.get()) {
+  if (!fanotify_fd_.is_valid()) {
+    // Unprivileged processes are expected to get EPERM.
+    DPLOG_IF(WARNING, errno != EPERM) << "fanotify_init() failed";
     return;
+  }
+
+  // This object is LazyInstance::Leaky, so thread_delegate_ will outlive the
+  // thread.
+  if (!PlatformThread::CreateNonJoinable(0, &thread_delegate_))
+    return;
+
+  valid_ = true;
+}
+
+bool FanotifyReader::AddWatch(const FilePath& path,
+                              FilePathWatcherImpl* watcher) {
+  if (!valid_)
+    return false;
+
+  ScopedBlockingCall scoped_blocking_call(FROM_HERE, BlockingType::WILL_BLOCK);
+  FilePath real_path = MakeAbsoluteFilePath(path);
+  if (real_path.empty())
+    return false;
+  FileHandleStorage handle;
+  handle.handle.handle_bytes = MAX_HANDLE_SZ;
+  int mount_id;
+  if (name_to_handle_at(AT_FDCWD, real_path.value().c_str(), &handle.handle,
+                        &mount_id, 0) != 0) {
+    return false;
+  }
+  ScopedFD fd(HANDLE_EINTR(
+      open(real_path.value().c_str(), O_RDONLY | O_DIRECTORY | O_CLOEXEC)));
+  if (!fd.is_valid())
+    return false;
+  // Check that the file system supports directory handles, and that this
+  // process may open them.
+  if (!ScopedFD(HANDLE_EINTR(open_by_handle_at(fd.get(), &handle.handle,
+                                               O_PATH | O_CLOEXEC)))
+           .is_valid()) {
+    return false;
+  }
+  struct statfs stats;
+  if (HANDLE_EINTR(fstatfs(fd.get(), &stats)) != 0)
+    return false;
+  __kernel_fsid_t fsid;
+  static_assert(sizeof(fsid) == sizeof(stats.f_fsid), "");
+  memcpy(&fsid, &stats.f_fsid, sizeof(fsid));
 
-  FilePath::StringType child(event->len ? event->name : FILE_PATH_LITERAL(""));
   AutoLock auto_lock(lock_);
+  auto watchers_it = watchers_.find(watcher);
+  if (watchers_it != watchers_.end()) {
+    if (watchers_it->second.mount_id == mount_id) {
+      watchers_it->second.path = path;
+      watchers_it->second.real_path = std::move(real_path);
+      return true;
+    }
+    RemoveWatchLocked(watcher);
+  }
 
-  // In racing conditions, RemoveWatch() could grab `lock_` first and remove
-  // the entry for `event->wd`.
-  auto watchers_it = watchers_.find(event->wd);
+  auto mounts_it = mounts_.find(mount_id);
+  if (mounts_it == mounts_.end()) {
+    if (!IsFileSystemWatched(fsid) &&
+        fanotify_mark(fanotify_fd_.get(), FAN_MARK_ADD | FAN_MARK_FILESYSTEM,
+                      kFanotifyEventMask, fd.get(), nullptr) != 0) {
+      // E.g. EXDEV for a btrfs subvolume.
+      DPLOG(WARNING) << "fanotify_mark failed for " << real_path;
+      return false;
+    }
+    mounts_it = mounts_.emplace(mount_id, Mount()).first;
+    mounts_it->second.fsid = fsid;
+    mounts_it->second.fd = std::move(fd);
+  }
+  ++mounts_it->second.watcher_count;
+  watchers_.emplace(watcher, WatcherEntry{mount_id, path, std::move(real_path),
+                                          watcher->GetTaskRunner(),
+                                          watcher->GetWeakPtr()});
+  return true;
+}
+
+void FanotifyReader::RemoveWatch(FilePathWatcherImpl* watcher) {
+  if (!valid_)
+    return;
+
+  AutoLock auto_lock(lock_);
+  RemoveWatchLocked(watcher);
+}
+
+void FanotifyReader::RemoveWatchLocked(FilePathWatcherImpl* watcher) {
+  auto watchers_it = watchers_.find(watcher);
   if (watchers_it == watchers_.end())
     return;
 
-  auto& watcher_map = watchers_it->second;
-  for (const auto& entry : watcher_map) {
-    auto& watcher_entry = entry.second;
-    watcher_entry.task_runner->PostTask(
-        FROM_HERE,
-        BindOnce(&FilePathWatcherImpl::OnFilePathChanged, watcher_entry.watcher,
-                 event->wd, child, event->mask & (IN_CREATE | IN_MOVED_TO),
-                 event->mask & (IN_DELETE | IN_MOVED_FROM),
-                 event->mask & IN_ISDIR));
+  auto mounts_it = mounts_.find(watchers_it->second.mount_id);
+  DCHECK(mounts_it != mounts_.end());
+  watchers_.erase(watchers_it);
+  if (--mounts_it->second.watcher_count > 0)
+    return;
+
+  ScopedFD fd = std::move(mounts_it->second.fd);
+  const __kernel_fsid_t fsid = mounts_it->second.fsid;
+  mounts_.erase(mounts_it);
+  if (!IsFileSystemWatched(fsid)) {
+    ScopedBlockingCall scoped_blocking_call(FROM_HERE,
+                                            BlockingType::WILL_BLOCK);
+    fanotify_mark(fanotify_fd_.get(), FAN_MARK_REMOVE | FAN_MARK_FILESYSTEM,
+                  kFanotifyEventMask, fd.get(), nullptr);
   }
 }
 
-bool InotifyReader::HasWatches() {
+void FanotifyReader::OnFanotifyEvents(const char* buffer, size_t size) {
+  std::map<FilePathWatcherImpl*, std::vector<FilePath>> changes_by_watcher;
+  AutoLock auto_lock(lock_);
+
+  auto length = static_cast<ssize_t>(size);
+  for (auto* event = reinterpret_cast<const fanotify_event_metadata*>(buffer);
+       FAN_EVENT_OK(event, length); event = FAN_EVENT_NEXT(event, length)) {
+    if (event->vers != FANOTIFY_METADATA_VERSION) {
+      LOG(ERROR) << "Unexpected fanotify metadata version " << event->vers;
+      return;
+    }
+
+    if (event->mask & FAN_Q_OVERFLOW) {
+      // Events were lost, so anything may have changed.
+      for (const auto& it : watchers_)
+        changes_by_watcher[it.first].push_back(it.second.path);
+      continue;
+    }
+
+    if (event->event_len <
+        event->metadata_len + sizeof(fanotify_event_info_fid)) {
+      continue;
+    }
+    const auto* info = reinterpret_cast<const fanotify_event_info_fid*>(
+        reinterpret_cast<const char*>(event) + event->metadata_len);
+    if (info->hdr.info_type != FAN_EVENT_INFO_TYPE_DFID_NAME &&
+        info->hdr.info_type != FAN_EVENT_INFO_TYPE_DFID) {
+      continue;
+    }
+    const auto* handle = reinterpret_cast<const file_handle*>(info->handle);
+    const char* name =
+        info->hdr.info_type == FAN_EVENT_INFO_TYPE_DFID_NAME
+            ? reinterpret_cast<const char*>(handle->f_handle +
+                                            handle->handle_bytes)
+            : "";
+    // Directories moved away or deleted take the paths cached for them and
+    // their descendants with them.
+    const bool directories_moved =
+        (event->mask & FAN_ONDIR) &&
+        (event->mask & (FAN_MOVED_FROM | FAN_DELETE));
+
+    for (auto& mounts_it : mounts_) {
+      Mount& mount = mounts_it.second;
+      if (memcmp(&mount.fsid, &info->fsid, sizeof(mount.fsid)) != 0)
+        continue;
+      // Events in directories gone since can't be resolved, but the events of
+      // their parents report them gone.
+      const FilePath* dir = GetDirectory(&mount, handle);
+      for (const auto& watchers_it : watchers_) {
+        const WatcherEntry& entry = watchers_it.second;
+        FilePath changed_path = entry.path;
+        if (!dir || entry.mount_id != mounts_it.first ||
+            !entry.real_path.AppendRelativePath(*dir, &changed_path)) {
+          continue;
+        }
+        if (*name)
+          changed_path = changed_path.Append(name);
+        changes_by_watcher[watchers_it.first].push_back(
+            std::move(changed_path));
+      }
+      if (directories_moved)
+        mount.directories.clear();
+    }
+  }
+
+  for (auto& it : changes_by_watcher) {
+    const WatcherEntry& entry = watchers_.find(it.first)->second;
+    entry.task_runner->PostTask(
+        FROM_HERE, BindOnce(&FilePathWatcherImpl::OnFanotifyChanges,
+                            entry.watcher, std::move(it.second)));
+  }
+}
+
+bool FanotifyReader::HasWatches() {
   AutoLock auto_lock(lock_);
 
   return !watchers_.empty();
 }
 
+bool FanotifyReader::IsFileSystemWatched(const __kernel_fsid_t& fsid) const {
+  return std::any_of(mounts_.begin(), mounts_.end(), [&fsid](const auto& it) {
+    return memcmp(&it.second.fsid, &fsid, sizeof(fsid)) == 0;
+  });
+}
+
+const FilePath* FanotifyReader::GetDirectory(Mount* mount,
+                                             const file_handle* handle) {
+  std::string key(reinterpret_cast<const char*>(handle),
+                  sizeof(file_handle) + handle->handle_bytes);
+  auto it = mount->directories.find(key);
+  if (it != mount->directories.end())
+    return &it->second;
+
+  if (handle->handle_bytes > MAX_HANDLE_SZ)
+    return nullptr;
+  FileHandleStorage storage;
+  memcpy(storage.bytes, key.data(), key.size());
+  ScopedFD fd(HANDLE_EINTR(open_by_handle_at(
+      mount->fd.get(), &storage.handle, O_PATH | O_CLOEXEC)));
+  FilePath path;
+  if (!fd.is_valid() ||
+      !ReadSymbolicLink(
+          FilePath("/proc/self/fd").Append(NumberToString(fd.get())),
+          &path)) {
+    return nullptr;
+  }
+  if (mount->directories.size() >= kMaxCachedFanotifyDirectories)
+    mount->directories.clear();
+  return &mount->directories.emplace(std::move(key), std::move(path))
+              .first->second;
+}
+
+#endif  // BUILDFLAG(IS_LINUX) || BUILDFLAG(IS_CHROMEOS)
+
 FilePathWatcherImpl::FilePathWatcherImpl() = default;
 
 FilePathWatcherImpl::~FilePathWatcherImpl() {
   DCHECK(!task_runner() || task_runner()->RunsTasksInCurrentSequence());
 }
 
+void FilePathWatcherImpl::OnInotifyEvents(std::vector<InotifyEvent> events) {
+  DCHECK(task_runner()->RunsTasksInCurrentSequence());
+
+  WeakPtr<FilePathWatcherImpl> self = weak_factory_.GetWeakPtr();
+  for (const InotifyEvent& event : events) {
+    OnFilePathChanged(event.watch, event.child, event.created, event.deleted,
+                      event.is_dir);
+    // `this` may be deleted, or cancelled after an error.
+    if (!self)
+      return;
+  }
+}
+
+#if BUILDFLAG(IS_LINUX) || BUILDFLAG(IS_CHROMEOS)
+void FilePathWatcherImpl::OnFanotifyChanges(std::vector<FilePath> paths) {
+  DCHECK(task_runner()->RunsTasksInCurrentSequence());
+
+  if (!report_changed_path_) {
+    callback_.Run(target_, /*error=*/false);  // `this` may be deleted.
+    return;
+  }
+  WeakPtr<FilePathWatcherImpl> self = weak_factory_.GetWeakPtr();
+  for (const FilePath& path : paths) {
+    callback_.Run(path, /*error=*/false);  // `this` may be deleted.
+    if (!self)
+      return;
+  }
+}
+#endif
+
 void FilePathWatcherImpl::OnFilePathChanged(InotifyReader::Watch fired_watch,
                                             const FilePath::StringType& child,
                                             bool created,
@@ -502,18 +986,26 @@ void FilePathWatcherImpl::OnFilePathChanged(InotifyReader::Watch fired_watch,
         }
         did_update = true;
       }
-      callback_.Run(target_, /*error=*/false);  // `this` may be deleted.
+      // The children of the target are the ones of its own watch.
+      const bool is_target_watch =
+          watch_entry.subdir.empty() && watch_entry.linkname.empty();
+      callback_.Run(is_target_watch ? GetChangedPath(target_, child) : target_,
+                    /*error=*/false);  // `this` may be deleted.
       return;
     }
   }
 
-  if (!exceeded_limit && Contains(recursive_paths_by_watch_, fired_watch)) {
+  auto recursive_it = recursive_paths_by_watch_.find(fired_watch);
+  if (!exceeded_limit && recursive_it != recursive_paths_by_watch_.end()) {
+    // Copied since the update may remove the watch.
+    const FilePath changed_path =
+        GetChangedPath(recursive_it->second->first, child);
     if (!did_update) {
       if (!UpdateRecursiveWatches(fired_watch, is_dir))
         exceeded_limit = true;
     }
     if (!exceeded_limit) {
-      callback_.Run(target_, /*error=*/false);  // `this` may be deleted.
+      callback_.Run(changed_path, /*error=*/false);  // `this` may be deleted.
       return;
     }
   }
@@ -572,6 +1064,10 @@ bool FilePathWatcherImpl::Watch(const FilePath& path,
     watches_.emplace_back(comps[i]);
   watches_.emplace_back(FilePath::StringType());
 
+#if BUILDFLAG(IS_LINUX) || BUILDFLAG(IS_CHROMEOS)
+  use_fanotify_ = type_ == Type::kRecursive;
+#endif
+
   if (!UpdateWatches()) {
     Cancel();
     // Note `callback` is not invoked since false is returned.
@@ -581,6 +1077,14 @@ bool FilePathWatcherImpl::Watch(const FilePath& path,
   return true;
 }
 
+bool FilePathWatcherImpl::WatchWithChangedPath(
+    const FilePath& path,
+    Type type,
+    const FilePathWatcher::Callback& callback) {
+  report_changed_path_ = true;
+  return Watch(path, type, callback);
+}
+
 void FilePathWatcherImpl::Cancel() {
   if (!callback_) {
     // Watch() was never called.
@@ -647,9 +1151,31 @@ bool FilePathWatcherImpl::UpdateRecursiveWatches(
     return true;
   }
 
+#if BUILDFLAG(IS_LINUX) || BUILDFLAG(IS_CHROMEOS)
+  if (use_fanotify_) {
+    // Tests overriding the inotify limits test the inotify watches.
+    if (g_override_max_inotify_watches == 0u) {
+      // The descendants are covered already, unless this is a forced update
+      // or some component of |target_| has changed, which may have replaced
+      // it.
+      if (fired_watch != InotifyReader::kInvalidWatch &&
+          fired_watch == watches_.back().watch) {
+        return true;
+      }
+      if (g_fanotify_reader.Get().AddWatch(target_, this))
+        return true;
+    }
+    // Fall back to inotify, e.g. on a file system without directory handles.
+    g_fanotify_reader.Get().RemoveWatch(this);
+    use_fanotify_ = false;
+    return UpdateRecursiveWatchesForPath(target_);
+  }
+#endif
+
   // Check to see if this is a forced update or if some component of |target_|
   // has changed. For these cases, redo the watches for |target_| and below.
-  if (!Contains(recursive_paths_by_watch_, fired_watch) &&
+  auto recursive_it = recursive_paths_by_watch_.find(fired_watch);
+  if (recursive_it == recursive_paths_by_watch_.end() &&
       fired_watch != watches_.back().watch) {
     return UpdateRecursiveWatchesForPath(target_);
   }
@@ -658,9 +1184,10 @@ bool FilePathWatcherImpl::UpdateRecursiveWatches(
   if (!is_dir)
     return true;
 
-  const FilePath& changed_dir = Contains(recursive_paths_by_watch_, fired_watch)
-                                    ? recursive_paths_by_watch_[fired_watch]
-                                    : target_;
+  // Copied since the watches under it are removed below.
+  const FilePath changed_dir = recursive_it != recursive_paths_by_watch_.end()
+                                   ? recursive_it->second->first
+                                   : target_;
 
   auto start_it = recursive_watches_by_path_.lower_bound(changed_dir);
   auto end_it = start_it;
@@ -698,17 +1225,21 @@ bool FilePathWatcherImpl::UpdateRecursiveWatchesForPath(const FilePath& path) {
 
   // Note: SHOW_SYM_LINKS exposes symlinks as symlinks, so they are ignored
   // rather than followed. Following symlinks can easily lead to the undesirable
-  // situation where the entire file system is being watched.
+  // situation where the entire file system is being watched. The directories
+  // are told apart by the types of the directory entries, mostly without a
+  // stat() each.
   FileEnumerator enumerator(
       path,
       true /* recursive enumeration */,
-      FileEnumerator::DIRECTORIES | FileEnumerator::SHOW_SYM_LINKS);
+      FileEnumerator::DIRECTORIES | FileEnumerator::SHOW_SYM_LINKS |
+          FileEnumerator::NAMES_AND_TYPES_ONLY);
   for (FilePath current = enumerator.Next();
        !current.empty();
        current = enumerator.Next()) {
     DCHECK(enumerator.GetInfo().IsDirectory());
 
-    if (!Contains(recursive_watches_by_path_, current)) {
+    auto it = recursive_watches_by_path_.find(current);
+    if (it == recursive_watches_by_path_.end()) {
       // Add new watches.
       InotifyReader::Watch watch =
           g_inotify_reader.Get().AddWatch(current, this);
@@ -717,7 +1248,7 @@ bool FilePathWatcherImpl::UpdateRecursiveWatchesForPath(const FilePath& path) {
       TrackWatchForRecursion(watch, current);
     } else {
       // Update existing watches.
-      InotifyReader::Watch old_watch = recursive_watches_by_path_[current];
+      InotifyReader::Watch old_watch = it->second;
       DCHECK_NE(InotifyReader::kInvalidWatch, old_watch);
       InotifyReader::Watch watch =
           g_inotify_reader.Get().AddWatch(current, this);
@@ -726,7 +1257,7 @@ bool FilePathWatcherImpl::UpdateRecursiveWatchesForPath(const FilePath& path) {
       if (watch != old_watch) {
         g_inotify_reader.Get().RemoveWatch(old_watch, this);
         recursive_paths_by_watch_.erase(old_watch);
-        recursive_watches_by_path_.erase(current);
+        recursive_watches_by_path_.erase(it);
         TrackWatchForRecursion(watch, current);
       }
     }
@@ -745,14 +1276,19 @@ void FilePathWatcherImpl::TrackWatchForRecursion(InotifyReader::Watch watch,
 
   DCHECK(!Contains(recursive_paths_by_watch_, watch));
   DCHECK(!Contains(recursive_watches_by_path_, path));
-  recursive_paths_by_watch_[watch] = path;
-  recursive_watches_by_path_[path] = watch;
+  recursive_paths_by_watch_.emplace(
+      watch, recursive_watches_by_path_.emplace(path, watch).first);
 }
 
 void FilePathWatcherImpl::RemoveRecursiveWatches() {
   if (type_ != Type::kRecursive)
     return;
 
+#if BUILDFLAG(IS_LINUX) || BUILDFLAG(IS_CHROMEOS)
+  if (use_fanotify_)
+    g_fanotify_reader.Get().RemoveWatch(this);
+#endif
+
   for (const auto& it : recursive_paths_by_watch_)
     g_inotify_reader.Get().RemoveWatch(it.first, this);
 
@@ -800,6 +1336,14 @@ bool FilePathWatcherImpl::HasValidWatchVector() const {
   return watches_.back().subdir.empty();
 }
 
+FilePath FilePathWatcherImpl::GetChangedPath(
+    const FilePath& dir,
+    const FilePath::StringType& child) const {
+  if (!report_changed_path_)
+    return target_;
+  return child.empty() ? dir : dir.Append(child);
+}
+
 }  // namespace
 
 ScopedMaxNumberOfInotifyWatchesOverrideForTest::
@@ -824,7 +1368,9 @@ FilePathWatcher::FilePathWatcher() {
 
 // static
 bool FilePathWatcher::HasWatchesForTest() {
-  return g_inotify_reader.Get().HasWatches();
+  return g_inotify_reader.Get().HasWatches() ||
+         (g_fanotify_reader.IsCreated() &&
+          g_fanotify_reader.Get().HasWatches());
 }
 #endif  // BUILDFLAG(IS_LINUX) || BUILDFLAG(IS_CHROMEOS)
 
@@ -11,7 +11,8 @@
 
 namespace base {
 
-// Overrides max inotify watcher counter for test.
+// Overrides max inotify watcher counter for test. Recursive watches updated
+// meanwhile switch to inotify watches, from fanotify when privileged.
 class BASE_EXPORT ScopedMaxNumberOfInotifyWatchesOverrideForTest {
  public:
   explicit ScopedMaxNumberOfInotifyWatchesOverrideForTest(size_t override_max);
@@ -11,6 +11,7 @@
 
 #include "base/bind.h"
 #include "base/callback_helpers.h"
+#include "base/containers/contains.h"
 #include "base/files/file_path.h"
 #include "base/files/file_util.h"
 #include "base/files/scoped_temp_dir.h"
@@ -466,6 +467,44 @@ TEST_F(FilePathWatcherTest, WatchDirectory) {
   ASSERT_TRUE(WaitForEvents());
 }
 
+// Verify that the changes made within the window of the first one come in one
+// batch.
+TEST_F(FilePathWatcherTest, BatchedChanges) {
+  FilePathWatcher watcher;
+  FilePath dir(temp_dir_.GetPath().AppendASCII("dir"));
+  FilePath file1(dir.AppendASCII("file1"));
+  FilePath file2(dir.AppendASCII("file2"));
+  ASSERT_TRUE(base::CreateDirectory(dir));
+
+  std::vector<std::vector<FilePath>> batches;
+  RunLoop run_loop;
+  ASSERT_TRUE(watcher.WatchWithBatchedChanges(
+      dir, FilePathWatcher::Type::kNonRecursive, TestTimeouts::tiny_timeout(),
+      base::BindLambdaForTesting(
+          [&](const std::vector<FilePath>& paths, bool error) {
+            EXPECT_FALSE(error);
+            batches.push_back(paths);
+            run_loop.Quit();
+          })));
+
+  ASSERT_TRUE(WriteFile(file1, "content"));
+  ASSERT_TRUE(WriteFile(file1, "content v2"));
+  ASSERT_TRUE(WriteFile(file2, "content"));
+  ThreadTaskRunnerHandle::Get()->PostDelayedTask(
+      FROM_HERE, run_loop.QuitClosure(), TestTimeouts::action_timeout());
+  run_loop.Run();
+
+  ASSERT_EQ(1u, batches.size());
+#if BUILDFLAG(IS_LINUX) || BUILDFLAG(IS_CHROMEOS) || BUILDFLAG(IS_ANDROID)
+  // Each file is reported once, however many times it changed.
+  EXPECT_EQ((std::set<FilePath>{file1, file2}),
+            std::set<FilePath>(batches[0].begin(), batches[0].end()));
+  EXPECT_EQ(2u, batches[0].size());
+#else
+  EXPECT_EQ(std::vector<FilePath>{dir}, batches[0]);
+#endif
+}
+
 TEST_F(FilePathWatcherTest, MoveParent) {
   FilePathWatcher file_watcher;
   FilePathWatcher subdir_watcher;
@@ -899,6 +938,61 @@ TEST_F(FilePathWatcherTest, RacyRecursiveWatch) {
   }
 }
 
+// Verify that the files changed in the sub-directories of a recursive watch
+// are reported.
+TEST_F(FilePathWatcherTest, BatchedChangesRecursive) {
+  FilePathWatcher watcher;
+  FilePath dir(temp_dir_.GetPath().AppendASCII("dir"));
+  FilePath subdir(dir.AppendASCII("subdir"));
+  FilePath file(subdir.AppendASCII("file"));
+  ASSERT_TRUE(base::CreateDirectory(subdir));
+
+  std::set<FilePath> changed;
+  RunLoop run_loop;
+  ASSERT_TRUE(watcher.WatchWithBatchedChanges(
+      dir, FilePathWatcher::Type::kRecursive, TestTimeouts::tiny_timeout(),
+      base::BindLambdaForTesting(
+          [&](const std::vector<FilePath>& paths, bool error) {
+            EXPECT_FALSE(error);
+            changed.insert(paths.begin(), paths.end());
+            if (Contains(changed, file))
+              run_loop.Quit();
+          })));
+
+  ASSERT_TRUE(WriteFile(file, "content"));
+  ThreadTaskRunnerHandle::Get()->PostDelayedTask(
+      FROM_HERE, run_loop.QuitClosure(), TestTimeouts::action_timeout());
+  run_loop.Run();
+  EXPECT_EQ(std::set<FilePath>{file}, changed);
+}
+
+// Verify that an error is reported at once, without waiting for the window to
+// elapse.
+TEST_F(FilePathWatcherTest, BatchedChangesError) {
+  FilePath dir(temp_dir_.GetPath().AppendASCII("dir"));
+  auto watcher = std::make_unique<FilePathWatcher>();
+  RunLoop run_loop;
+  ASSERT_TRUE(watcher->WatchWithBatchedChanges(
+      dir, FilePathWatcher::Type::kRecursive,
+      TestTimeouts::action_max_timeout(),
+      base::BindLambdaForTesting(
+          [&](const std::vector<FilePath>& paths, bool error) {
+            EXPECT_TRUE(error);
+            watcher.reset();
+            run_loop.Quit();
+          })));
+
+  constexpr size_t kMaxLimit = 10u;
+  ScopedMaxNumberOfInotifyWatchesOverrideForTest max_inotify_watches(
+      kMaxLimit);
+  ASSERT_TRUE(CreateDirectory(dir));
+  for (size_t i = 0; i < kMaxLimit; ++i) {
+    ASSERT_TRUE(
+        CreateDirectory(dir.AppendASCII(StringPrintf("subdir_%" PRIuS, i))));
+  }
+  run_loop.Run();
+}
+
 // Verify that "Watch()" returns false and callback is not invoked when limit is
 // hit during setup.
 TEST_F(FilePathWatcherTest, InotifyLimitInWatch) {
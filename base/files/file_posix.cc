@@ -6,13 +6,21 @@
 
 #include <errno.h>
 #include <fcntl.h>
+#include <limits.h>
 #include <stdint.h>
 #include <sys/stat.h>
+#include <sys/uio.h>
 #include <unistd.h>
 
+#include <algorithm>
+#include <limits>
+#include <vector>
+
 #include "base/check_op.h"
+#include "base/files/async_file_io_posix.h"
 #include "base/metrics/histogram_functions.h"
 #include "base/notreached.h"
+#include "base/numerics/safe_conversions.h"
 #include "base/posix/eintr_wrapper.h"
 #include "base/strings/utf_string_conversions.h"
 #include "base/threading/scoped_blocking_call.h"
@@ -119,6 +127,84 @@ File::Error CallFcntlFlock(PlatformFile file,
 }
 #endif  // BUILDFLAG(IS_NACL)
 
+// Transfers all the bytes of |iovecs| at |offset| of |file|. Returns false on
+// error, or if the end of the file is reached first. Modifies |iovecs|.
+bool TransferVectored(PlatformFile file,
+                      bool is_read,
+                      int64_t offset,
+                      std::vector<iovec>& iovecs) {
+  size_t first = 0;
+  while (first < iovecs.size()) {
+    iovec* const iov = &iovecs[first];
+    ssize_t rv;
+#if BUILDFLAG(IS_LINUX) || BUILDFLAG(IS_CHROMEOS) || \
+    (BUILDFLAG(IS_ANDROID) && __ANDROID_API__ >= 24)
+    const int count =
+        static_cast<int>(std::min<size_t>(iovecs.size() - first, IOV_MAX));
+#if BUILDFLAG(IS_ANDROID)
+    // See File::Write().
+    rv = is_read ? HANDLE_EINTR(preadv64(file, iov, count, offset))
+                 : HANDLE_EINTR(pwritev64(file, iov, count, offset));
+#else
+    rv = is_read ? HANDLE_EINTR(preadv(file, iov, count, offset))
+                 : HANDLE_EINTR(pwritev(file, iov, count, offset));
+#endif
+#else
+    // preadv() and pwritev() are missing or too recent elsewhere.
+    rv = is_read ? HANDLE_EINTR(pread(file, iov->iov_base, iov->iov_len,
+                                      static_cast<off_t>(offset)))
+                 : HANDLE_EINTR(pwrite(file, iov->iov_base, iov->iov_len,
+                                       static_cast<off_t>(offset)));
+#endif
+    if (rv <= 0)
+      return false;
+    offset += rv;
+    // Skips the buffers transferred, and the part of the next one which is.
+    size_t transferred = static_cast<size_t>(rv);
+    while (first < iovecs.size() && transferred >= iovecs[first].iov_len) {
+      transferred -= iovecs[first].iov_len;
+      ++first;
+    }
+    if (transferred) {
+      iovecs[first].iov_base =
+          static_cast<char*>(iovecs[first].iov_base) + transferred;
+      iovecs[first].iov_len -= transferred;
+    }
+  }
+  return true;
+}
+
+// Transfers each of |ranges|, those which follow each other in the file
+// together.
+template <typename Range>
+bool TransferRanges(PlatformFile file, bool is_read, span<const Range> ranges) {
+  std::vector<iovec> iovecs;
+  size_t i = 0;
+  while (i < ranges.size()) {
+    const int64_t offset = ranges[i].offset;
+    if (offset < 0)
+      return false;
+    int64_t end = offset;
+    iovecs.clear();
+    for (; i < ranges.size() && ranges[i].offset == end; ++i) {
+      const auto& data = ranges[i].data;
+      // Empty buffers would make the end of the file look like an error.
+      if (data.empty())
+        continue;
+      if (!IsValueInRangeForNumericType<int64_t>(data.size()) ||
+          static_cast<int64_t>(data.size()) >
+              std::numeric_limits<int64_t>::max() - end) {
+        return false;
+      }
+      iovecs.push_back({const_cast<uint8_t*>(data.data()), data.size()});
+      end += static_cast<int64_t>(data.size());
+    }
+    if (!iovecs.empty() && !TransferVectored(file, is_read, offset, iovecs))
+      return false;
+  }
+  return true;
+}
+
 }  // namespace
 
 void File::Info::FromStat(const stat_wrapper_t& stat_info) {
@@ -348,6 +434,42 @@ int File::WriteAtCurrentPosNoBestEffort(const char* data, int size) {
   return HANDLE_EINTR(write(file_.get(), data, size));
 }
 
+bool File::ReadAtVectored(span<const ReadAtRange> ranges) {
+  ScopedBlockingCall scoped_blocking_call(FROM_HERE, BlockingType::MAY_BLOCK);
+  DCHECK(IsValid());
+  SCOPED_FILE_TRACE("ReadAtVectored");
+  return TransferRanges(file_.get(), /*is_read=*/true, ranges);
+}
+
+bool File::WriteAtVectored(span<const WriteAtRange> ranges) {
+  ScopedBlockingCall scoped_blocking_call(FROM_HERE, BlockingType::MAY_BLOCK);
+  DCHECK(IsValid());
+  DCHECK(!IsOpenAppend(file_.get()));
+  SCOPED_FILE_TRACE("WriteAtVectored");
+  return TransferRanges(file_.get(), /*is_read=*/false, ranges);
+}
+
+void File::ReadAsync(int64_t offset, int size, ReadAsyncCallback callback) {
+  DCHECK(IsValid());
+  AsyncFileIO::Read(file_.get(), offset, size, std::move(callback));
+}
+
+void File::WriteAsync(int64_t offset,
+                      const char* data,
+                      int size,
+                      WriteAsyncCallback callback) {
+  DCHECK(IsValid());
+  DCHECK(!IsOpenAppend(file_.get()));
+  AsyncFileIO::Write(file_.get(), offset, data, size, std::move(callback));
+}
+
+void File::ReadAtVectoredAsync(std::vector<ReadRange> ranges,
+                               ReadAtVectoredAsyncCallback callback) {
+  DCHECK(IsValid());
+  AsyncFileIO::ReadVectored(file_.get(), std::move(ranges),
+                            std::move(callback));
+}
+
 int64_t File::GetLength() {
   DCHECK(IsValid());
 
@@ -416,7 +538,9 @@ File File::Duplicate() const {
   if (!other_fd.is_valid())
     return File(File::GetLastFileError());
 
-  return File(std::move(other_fd), async());
+  File other(std::move(other_fd), async());
+  other.io_metrics_path_class_ = io_metrics_path_class_;
+  return other;
 }
 
 // Static.
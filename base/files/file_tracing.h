@@ -8,11 +8,14 @@
 #include <stdint.h>
 
 #include "base/base_export.h"
+#include "base/files/file_io_metrics.h"
 #include "base/memory/raw_ptr.h"
 
 #define FILE_TRACING_PREFIX "File"
 
 #define SCOPED_FILE_TRACE_WITH_SIZE(name, size) \
+    FileIOMetrics::ScopedOperation scoped_file_io_metrics( \
+        FILE_TRACING_PREFIX "::" name, io_metrics_path_class_, size); \
     FileTracing::ScopedTrace scoped_file_trace; \
     if (FileTracing::IsCategoryEnabled()) \
       scoped_file_trace.Initialize(FILE_TRACING_PREFIX "::" name, this, size)
@@ -7,6 +7,7 @@
 #include <stdint.h>
 
 #include <utility>
+#include <vector>
 
 #include "base/files/file_util.h"
 #include "base/files/memory_mapped_file.h"
@@ -519,6 +520,63 @@ TEST(FileTest, WriteAtCurrentPosition) {
   EXPECT_EQ(std::string(buffer, buffer + kDataSize), std::string(kData));
 }
 
+#if BUILDFLAG(IS_POSIX) || BUILDFLAG(IS_FUCHSIA)
+TEST(FileTest, ReadWriteAtVectored) {
+  base::ScopedTempDir temp_dir;
+  ASSERT_TRUE(temp_dir.CreateUniqueTempDir());
+  FilePath file_path = temp_dir.GetPath().AppendASCII("vectored");
+  File file(file_path, base::File::FLAG_CREATE | base::File::FLAG_READ |
+                           base::File::FLAG_WRITE);
+  ASSERT_TRUE(file.IsValid());
+
+  // Adjacent and scattered ranges, out of order, and an empty one.
+  const uint8_t kHello[] = {'h', 'e', 'l', 'l', 'o'};
+  const uint8_t kWorld[] = {'w', 'o', 'r', 'l', 'd'};
+  const uint8_t kBang[] = {'!'};
+  const File::WriteAtRange kWrites[] = {
+      {10, kHello}, {15, kWorld}, {15, {}}, {0, kBang}};
+  EXPECT_TRUE(file.WriteAtVectored(kWrites));
+  EXPECT_EQ(20, file.GetLength());
+
+  uint8_t hello_world[10];
+  uint8_t world[5];
+  uint8_t bang[1];
+  const File::ReadAtRange kReads[] = {
+      {10, base::make_span(hello_world, 5u)},
+      {15, base::make_span(hello_world + 5, 5u)},
+      {15, world},
+      {0, bang}};
+  EXPECT_TRUE(file.ReadAtVectored(kReads));
+  EXPECT_EQ("helloworld", std::string(hello_world, hello_world + 10));
+  EXPECT_EQ("world", std::string(world, world + 5));
+  EXPECT_EQ('!', bang[0]);
+
+  // More adjacent ranges than a single call takes.
+  constexpr size_t kNumRanges = 2000;
+  std::vector<uint8_t> bytes(kNumRanges);
+  for (size_t i = 0; i < kNumRanges; ++i)
+    bytes[i] = static_cast<uint8_t>(i);
+  std::vector<File::WriteAtRange> many_writes;
+  std::vector<uint8_t> read_bytes(kNumRanges);
+  std::vector<File::ReadAtRange> many_reads;
+  for (size_t i = 0; i < kNumRanges; ++i) {
+    const int64_t offset = 20 + static_cast<int64_t>(i);
+    many_writes.push_back({offset, base::make_span(&bytes[i], 1u)});
+    many_reads.push_back({offset, base::make_span(&read_bytes[i], 1u)});
+  }
+  EXPECT_TRUE(file.WriteAtVectored(many_writes));
+  EXPECT_TRUE(file.ReadAtVectored(many_reads));
+  EXPECT_EQ(bytes, read_bytes);
+
+  // The end of the file, and negative offsets, fail.
+  const File::ReadAtRange kPastEnd[] = {{2018, world}};
+  EXPECT_FALSE(file.ReadAtVectored(kPastEnd));
+  const File::ReadAtRange kNegative[] = {{-1, world}};
+  EXPECT_FALSE(file.ReadAtVectored(kNegative));
+  EXPECT_TRUE(file.ReadAtVectored({}));
+}
+#endif  // BUILDFLAG(IS_POSIX) || BUILDFLAG(IS_FUCHSIA)
+
 TEST(FileTest, Seek) {
   base::ScopedTempDir temp_dir;
   ASSERT_TRUE(temp_dir.CreateUniqueTempDir());
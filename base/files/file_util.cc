@@ -11,14 +11,18 @@
 #endif
 #include <stdio.h>
 
+#include <atomic>
 #include <fstream>
 #include <limits>
 #include <memory>
 #include <vector>
 
+#include "base/bind.h"
 #include "base/check_op.h"
 #include "base/files/file_enumerator.h"
 #include "base/files/file_path.h"
+#include "base/files/parallel_file_enumerator.h"
+#include "base/metrics/histogram_functions.h"
 #include "base/posix/eintr_wrapper.h"
 #include "base/strings/string_piece.h"
 #include "base/strings/string_util.h"
@@ -44,11 +48,15 @@ OnceCallback<void(const FilePath&)> GetDeletePathRecursivelyCallback() {
 }
 
 int64_t ComputeDirectorySize(const FilePath& root_path) {
-  int64_t running_size = 0;
-  FileEnumerator file_iter(root_path, true, FileEnumerator::FILES);
-  while (!file_iter.Next().empty())
-    running_size += file_iter.GetInfo().GetSize();
-  return running_size;
+  std::atomic<int64_t> running_size(0);
+  ParallelFileEnumerator(root_path, FileEnumerator::FILES)
+      .Run(BindRepeating(
+          [](std::atomic<int64_t>* running_size, const FilePath& path,
+             const FileEnumerator::FileInfo& info) {
+            running_size->fetch_add(info.GetSize(), std::memory_order_relaxed);
+          },
+          &running_size));
+  return running_size.load(std::memory_order_relaxed);
 }
 
 bool Move(const FilePath& from_path, const FilePath& to_path) {
@@ -57,18 +65,53 @@ bool Move(const FilePath& from_path, const FilePath& to_path) {
   return internal::MoveUnsafe(from_path, to_path);
 }
 
+namespace {
+
+// The ways CopyFileContents() copies, the first that applies being used. These
+// values are persisted to logs. Entries should not be renumbered and numeric
+// values should never be reused.
+enum class CopyFileContentsMethod {
+  kReflink = 0,
+  kCopyFileRange = 1,
+  kSendfile = 2,
+  kReadWrite = 3,
+  kMaxValue = kReadWrite,
+};
+
+void RecordCopyFileContentsMethod(CopyFileContentsMethod method) {
+  UmaHistogramEnumeration("File.CopyFileContents.Method", method);
+}
+
+}  // namespace
+
 bool CopyFileContents(File& infile, File& outfile) {
 #if BUILDFLAG(IS_LINUX) || BUILDFLAG(IS_CHROMEOS) || BUILDFLAG(IS_ANDROID)
-  bool retry_slow = false;
-  bool res =
-      internal::CopyFileContentsWithSendfile(infile, outfile, retry_slow);
-  if (res || !retry_slow) {
-    return res;
+  // The copies in the kernel, from the cheapest. Each leaves the files
+  // unchanged when it asks to retry with the next one.
+  static constexpr struct {
+    bool (*copy)(File& infile, File& outfile, bool& retry_slow);
+    CopyFileContentsMethod method;
+  } kKernelCopies[] = {
+      {&internal::CopyFileContentsWithReflink,
+       CopyFileContentsMethod::kReflink},
+      {&internal::CopyFileContentsWithCopyFileRange,
+       CopyFileContentsMethod::kCopyFileRange},
+      {&internal::CopyFileContentsWithSendfile,
+       CopyFileContentsMethod::kSendfile},
+  };
+  for (const auto& kernel_copy : kKernelCopies) {
+    bool retry_slow = false;
+    bool res = kernel_copy.copy(infile, outfile, retry_slow);
+    if (res || !retry_slow) {
+      RecordCopyFileContentsMethod(kernel_copy.method);
+      return res;
+    }
   }
   // Any failures which allow retrying using read/write will not have modified
   // either file offset or size.
 #endif
 
+  RecordCopyFileContentsMethod(CopyFileContentsMethod::kReadWrite);
   static constexpr size_t kBufferSize = 32768;
   std::vector<char> buffer(kBufferSize);
 
@@ -48,8 +48,8 @@ BASE_EXPORT FilePath MakeAbsoluteFilePath(const FilePath& input);
 // Returns the total number of bytes used by all the files under |root_path|.
 // If the path does not exist the function returns 0.
 //
-// This function is implemented using the FileEnumerator class so it is not
-// particularly speedy in any platform.
+// This function is implemented using the ParallelFileEnumerator class, which
+// lists the subdirectories concurrently on the ThreadPool if there is one.
 BASE_EXPORT int64_t ComputeDirectorySize(const FilePath& root_path);
 
 // Deletes the given path, whether it's a file or a directory.
@@ -659,6 +659,24 @@ BASE_EXPORT bool CopyAndDeleteDirectory(const FilePath& from_path,
 #endif  // BUILDFLAG(IS_WIN)
 
 #if BUILDFLAG(IS_LINUX) || BUILDFLAG(IS_CHROMEOS) || BUILDFLAG(IS_ANDROID)
+// CopyFileContentsWithReflink will use the FICLONE ioctl(2) to make |outfile|
+// share the data of |infile| on file systems with copy-on-write extents, such
+// as btrfs and xfs, which copies no data at all. It only applies when both
+// files are at offset 0 and |outfile| is empty, and sets |retry_slow|
+// otherwise or when the file system does not support it.
+BASE_EXPORT bool CopyFileContentsWithReflink(File& infile,
+                                             File& outfile,
+                                             bool& retry_slow);
+
+// CopyFileContentsWithCopyFileRange will use the copy_file_range(2) syscall,
+// which copies within the kernel like sendfile(2) does, but lets the file
+// system copy on the storage side or share extents. |retry_slow| is set when
+// the kernel or the file systems do not support it, e.g. for copies across
+// file systems before Linux 5.3.
+BASE_EXPORT bool CopyFileContentsWithCopyFileRange(File& infile,
+                                                   File& outfile,
+                                                   bool& retry_slow);
+
 // CopyFileContentsWithSendfile will use the sendfile(2) syscall to perform a
 // file copy without moving the data between kernel and userspace. This is much
 // more efficient than sequences of read(2)/write(2) calls. The |retry_slow|
@@ -20,15 +20,20 @@
 #include <time.h>
 #include <unistd.h>
 
+#include <atomic>
+#include <utility>
+#include <vector>
+
 #include "base/base_switches.h"
+#include "base/bind.h"
 #include "base/bits.h"
 #include "base/command_line.h"
 #include "base/containers/contains.h"
-#include "base/containers/stack.h"
 #include "base/cxx17_backports.h"
 #include "base/environment.h"
 #include "base/files/file_enumerator.h"
 #include "base/files/file_path.h"
+#include "base/files/parallel_file_enumerator.h"
 #include "base/files/scoped_file.h"
 #include "base/logging.h"
 #include "base/memory/singleton.h"
@@ -42,6 +47,10 @@
 #include "base/strings/sys_string_conversions.h"
 #include "base/strings/utf_string_conversions.h"
 #include "base/system/sys_info.h"
+#include "base/task/parallel_for.h"
+#include "base/task/scoped_set_task_priority_for_current_thread.h"
+#include "base/task/task_traits.h"
+#include "base/task/thread_pool/thread_pool_instance.h"
 #include "base/threading/scoped_blocking_call.h"
 #include "base/time/time.h"
 #include "build/build_config.h"
@@ -53,7 +62,10 @@
 #endif
 
 #if BUILDFLAG(IS_LINUX) || BUILDFLAG(IS_CHROMEOS) || BUILDFLAG(IS_ANDROID)
+#include <linux/fs.h>
+#include <sys/ioctl.h>
 #include <sys/sendfile.h>
+#include <sys/syscall.h>
 #endif
 
 #if BUILDFLAG(IS_ANDROID)
@@ -127,6 +139,71 @@ bool AdvanceEnumeratorWithStat(FileEnumerator* traversal,
   return true;
 }
 
+// DoCopyDirectory() copies fewer files on the calling thread, as they are not
+// worth a job.
+constexpr size_t kMinFilesForParallelCopy = 16;
+
+// Copies the regular file |from_path| found by DoCopyDirectory() to
+// |to_path|. Returns true without copying if it is not a regular file when
+// opened.
+bool CopyDirectoryFile(const FilePath& from_path,
+                       const FilePath& to_path,
+                       bool open_exclusive) {
+  // Add O_NONBLOCK so we can't block opening a pipe.
+  File infile(open(from_path.value().c_str(), O_RDONLY | O_NONBLOCK));
+  if (!infile.IsValid()) {
+    DPLOG(ERROR) << "CopyDirectory() couldn't open file: " << from_path.value();
+    return false;
+  }
+
+  stat_wrapper_t stat_at_use;
+  if (File::Fstat(infile.GetPlatformFile(), &stat_at_use) < 0) {
+    DPLOG(ERROR) << "CopyDirectory() couldn't stat file: " << from_path.value();
+    return false;
+  }
+
+  if (!S_ISREG(stat_at_use.st_mode)) {
+    DLOG(WARNING) << "CopyDirectory() skipping non-regular file: "
+                  << from_path.value();
+    return true;
+  }
+
+  int open_flags = O_WRONLY | O_CREAT;
+  // If |open_exclusive| is set then we should always create the destination
+  // file, so O_NONBLOCK is not necessary to ensure we don't block on the
+  // open call for the target file below, and since the destination will
+  // always be a regular file it wouldn't affect the behavior of the
+  // subsequent write calls anyway.
+  if (open_exclusive)
+    open_flags |= O_EXCL;
+  else
+    open_flags |= O_TRUNC | O_NONBLOCK;
+  // Each platform has different default file opening modes for CopyFile
+  // which we want to replicate here. On OS X, we use copyfile(3) which
+  // takes the source file's permissions into account. On the other
+  // platforms, we just use the base::File constructor. On Chrome OS,
+  // base::File uses a different set of permissions than it does on other
+  // POSIX platforms.
+#if BUILDFLAG(IS_APPLE)
+  int mode = 0600 | (stat_at_use.st_mode & 0177);
+#elif BUILDFLAG(IS_CHROMEOS_ASH) || BUILDFLAG(IS_CHROMEOS_LACROS)
+  int mode = 0644;
+#else
+  int mode = 0600;
+#endif
+  File outfile(open(to_path.value().c_str(), open_flags, mode));
+  if (!outfile.IsValid()) {
+    DPLOG(ERROR) << "CopyDirectory() couldn't create file: " << to_path.value();
+    return false;
+  }
+
+  if (!CopyFileContents(infile, outfile)) {
+    DLOG(ERROR) << "CopyDirectory() couldn't copy file: " << from_path.value();
+    return false;
+  }
+  return true;
+}
+
 bool DoCopyDirectory(const FilePath& from_path,
                      const FilePath& to_path,
                      bool recursive,
@@ -183,6 +260,9 @@ bool DoCopyDirectory(const FilePath& from_path,
   // TODO(maruel): This is not necessary anymore.
   DCHECK(recursive || S_ISDIR(from_stat.st_mode));
 
+  // The source and target paths of the regular files to copy.
+  std::vector<std::pair<FilePath, FilePath>> files_to_copy;
+
   do {
     // current is the source path, including from_path, so append
     // the suffix after from_path to to_path to create the target_path.
@@ -210,62 +290,38 @@ bool DoCopyDirectory(const FilePath& from_path,
       continue;
     }
 
-    // Add O_NONBLOCK so we can't block opening a pipe.
-    File infile(open(current.value().c_str(), O_RDONLY | O_NONBLOCK));
-    if (!infile.IsValid()) {
-      DPLOG(ERROR) << "CopyDirectory() couldn't open file: " << current.value();
-      return false;
-    }
-
-    stat_wrapper_t stat_at_use;
-    if (File::Fstat(infile.GetPlatformFile(), &stat_at_use) < 0) {
-      DPLOG(ERROR) << "CopyDirectory() couldn't stat file: " << current.value();
-      return false;
-    }
-
-    if (!S_ISREG(stat_at_use.st_mode)) {
-      DLOG(WARNING) << "CopyDirectory() skipping non-regular file: "
-                    << current.value();
-      continue;
-    }
-
-    int open_flags = O_WRONLY | O_CREAT;
-    // If |open_exclusive| is set then we should always create the destination
-    // file, so O_NONBLOCK is not necessary to ensure we don't block on the
-    // open call for the target file below, and since the destination will
-    // always be a regular file it wouldn't affect the behavior of the
-    // subsequent write calls anyway.
-    if (open_exclusive)
-      open_flags |= O_EXCL;
-    else
-      open_flags |= O_TRUNC | O_NONBLOCK;
-      // Each platform has different default file opening modes for CopyFile
-      // which we want to replicate here. On OS X, we use copyfile(3) which
-      // takes the source file's permissions into account. On the other
-      // platforms, we just use the base::File constructor. On Chrome OS,
-      // base::File uses a different set of permissions than it does on other
-      // POSIX platforms.
-#if BUILDFLAG(IS_APPLE)
-    int mode = 0600 | (stat_at_use.st_mode & 0177);
-#elif BUILDFLAG(IS_CHROMEOS_ASH) || BUILDFLAG(IS_CHROMEOS_LACROS)
-    int mode = 0644;
-#else
-    int mode = 0600;
-#endif
-    File outfile(open(target_path.value().c_str(), open_flags, mode));
-    if (!outfile.IsValid()) {
-      DPLOG(ERROR) << "CopyDirectory() couldn't create file: "
-                   << target_path.value();
-      return false;
-    }
+    files_to_copy.emplace_back(current, std::move(target_path));
+  } while (AdvanceEnumeratorWithStat(&traversal, &current, &from_stat));
 
-    if (!CopyFileContents(infile, outfile)) {
-      DLOG(ERROR) << "CopyDirectory() couldn't copy file: " << current.value();
-      return false;
+  // The files are copied once all the directories exist, concurrently on the
+  // ThreadPool if there are enough of them.
+  if (files_to_copy.size() < kMinFilesForParallelCopy ||
+      !ThreadPoolInstance::Get()) {
+    for (const auto& file : files_to_copy) {
+      if (!CopyDirectoryFile(file.first, file.second, open_exclusive))
+        return false;
     }
-  } while (AdvanceEnumeratorWithStat(&traversal, &current, &from_stat));
+    return true;
+  }
 
-  return true;
+  std::atomic_bool success(true);
+  ParallelFor(
+      FROM_HERE, {MayBlock(), internal::GetTaskPriorityForCurrentThread()}, 0,
+      files_to_copy.size(), 1,
+      BindRepeating(
+          [](const std::vector<std::pair<FilePath, FilePath>>* files_to_copy,
+             bool open_exclusive, std::atomic_bool* success, size_t begin,
+             size_t end) {
+            // Like the sequential copy, stops at the first failure.
+            for (size_t i = begin;
+                 i < end && success->load(std::memory_order_relaxed); ++i) {
+              const auto& file = (*files_to_copy)[i];
+              if (!CopyDirectoryFile(file.first, file.second, open_exclusive))
+                success->store(false, std::memory_order_relaxed);
+            }
+          },
+          Unretained(&files_to_copy), open_exclusive, Unretained(&success)));
+  return success.load(std::memory_order_relaxed);
 }
 
 // TODO(erikkay): The Windows version of this accepts paths like "foo/bar/*"
@@ -291,26 +347,26 @@ bool DoDeleteFile(const FilePath& path, bool recursive) {
   if (!recursive)
     return (rmdir(path_str) == 0) || (errno == ENOENT);
 
-  bool success = true;
-  stack<std::string> directories;
-  directories.push(path.value());
-  FileEnumerator traversal(path, true,
-                           FileEnumerator::FILES | FileEnumerator::DIRECTORIES |
-                               FileEnumerator::SHOW_SYM_LINKS);
-  for (FilePath current = traversal.Next(); !current.empty();
-       current = traversal.Next()) {
-    if (traversal.GetInfo().IsDirectory())
-      directories.push(current.value());
-    else
-      success &= (unlink(current.value().c_str()) == 0) || (errno == ENOENT);
-  }
-
-  while (!directories.empty()) {
-    FilePath dir = FilePath(directories.top());
-    directories.pop();
-    success &= (rmdir(dir.value().c_str()) == 0) || (errno == ENOENT);
-  }
-  return success;
+  // The directories are deleted once everything under them is, and the
+  // subdirectories are deleted concurrently on the ThreadPool.
+  std::atomic_bool success(true);
+  ParallelFileEnumerator(path,
+                         FileEnumerator::FILES | FileEnumerator::SHOW_SYM_LINKS |
+                             FileEnumerator::NAMES_AND_TYPES_ONLY)
+      .Run(BindRepeating(
+               [](std::atomic_bool* success, const FilePath& current,
+                  const FileEnumerator::FileInfo& info) {
+                 if (unlink(current.value().c_str()) != 0 && errno != ENOENT)
+                   success->store(false, std::memory_order_relaxed);
+               },
+               &success),
+           BindRepeating(
+               [](std::atomic_bool* success, const FilePath& current) {
+                 if (rmdir(current.value().c_str()) != 0 && errno != ENOENT)
+                   success->store(false, std::memory_order_relaxed);
+               },
+               &success));
+  return success.load(std::memory_order_relaxed);
 }
 
 #if !BUILDFLAG(IS_APPLE)
@@ -1210,6 +1266,90 @@ bool MoveUnsafe(const FilePath& from_path, const FilePath& to_path) {
 }
 
 #if BUILDFLAG(IS_LINUX) || BUILDFLAG(IS_CHROMEOS) || BUILDFLAG(IS_ANDROID)
+bool CopyFileContentsWithReflink(File& infile,
+                                 File& outfile,
+                                 bool& retry_slow) {
+  DCHECK(infile.IsValid());
+  // The clone replaces all of |outfile| with all of |infile|, which is only a
+  // copy from the current offsets if they are both at the start.
+  retry_slow = true;
+  const int in_fd = infile.GetPlatformFile();
+  const int out_fd = outfile.GetPlatformFile();
+  if (lseek(in_fd, 0, SEEK_CUR) != 0 || lseek(out_fd, 0, SEEK_CUR) != 0)
+    return false;
+
+  stat_wrapper_t in_file_info;
+  stat_wrapper_t out_file_info;
+  if (File::Fstat(in_fd, &in_file_info) || File::Fstat(out_fd, &out_file_info))
+    return false;
+  // Like for sendfile(2), files which report a size of 0 may still have
+  // contents.
+  if (!S_ISREG(in_file_info.st_mode) || in_file_info.st_size == 0 ||
+      out_file_info.st_size != 0) {
+    return false;
+  }
+
+  // The ioctl either clones everything or fails without changing |outfile|,
+  // which is then copied another way: most file systems do not support it, and
+  // the others not across file systems.
+  if (HANDLE_EINTR(ioctl(out_fd, FICLONE, in_fd)) != 0)
+    return false;
+
+  // The offsets end up where a copy would have left them.
+  retry_slow = false;
+  return lseek(in_fd, in_file_info.st_size, SEEK_SET) >= 0 &&
+         lseek(out_fd, in_file_info.st_size, SEEK_SET) >= 0;
+}
+
+bool CopyFileContentsWithCopyFileRange(File& infile,
+                                       File& outfile,
+                                       bool& retry_slow) {
+  DCHECK(infile.IsValid());
+  stat_wrapper_t in_file_info;
+  retry_slow = false;
+
+  if (base::File::Fstat(infile.GetPlatformFile(), &in_file_info)) {
+    return false;
+  }
+
+  // See CopyFileContentsWithSendfile() about the files of size 0.
+  int64_t file_size = in_file_info.st_size;
+  if (file_size == 0) {
+    retry_slow = true;
+    return false;
+  }
+
+  size_t copied = 0;
+  ssize_t res = 0;
+  while (file_size - copied > 0) {
+    // Without offsets, the kernel reads and writes at the current file
+    // offsets, and advances them.
+    res = HANDLE_EINTR(syscall(__NR_copy_file_range, infile.GetPlatformFile(),
+                               /*off_in=*/nullptr, outfile.GetPlatformFile(),
+                               /*off_out=*/nullptr,
+                               /*len=*/file_size - copied, /*flags=*/0u));
+    if (res <= 0) {
+      break;
+    }
+
+    copied += res;
+  }
+
+  // Fallback on the errors meaning that the copy is not supported, which
+  // happen before any data is copied. EBADF is also returned for an |outfile|
+  // opened with O_APPEND. Some kernels also copy nothing from the files of
+  // pseudo file systems which report a size without being regular files.
+  retry_slow =
+      copied == 0 && (res == 0 || (res < 0 && (errno == EXDEV ||
+                                               errno == EINVAL ||
+                                               errno == ENOSYS ||
+                                               errno == EOPNOTSUPP ||
+                                               errno == EPERM ||
+                                               errno == EBADF)));
+
+  return !retry_slow && res >= 0;
+}
+
 bool CopyFileContentsWithSendfile(File& infile,
                                   File& outfile,
                                   bool& retry_slow) {
@@ -37,6 +37,7 @@
 #include "base/strings/stringprintf.h"
 #include "base/strings/utf_string_conversions.h"
 #include "base/test/bind.h"
+#include "base/test/metrics/histogram_tester.h"
 #include "base/test/multiprocess_test.h"
 #include "base/test/task_environment.h"
 #include "base/test/test_file_util.h"
@@ -4469,6 +4470,135 @@ TEST_F(FileUtilTest, CopyFileContentsWithSendfileSeqFile) {
   }
 }
 
+TEST_F(FileUtilTest, CopyFileContentsWithCopyFileRange) {
+  // This test validates that copy_file_range(2) honors the file offsets as
+  // CopyFileContents does.
+  FilePath file_name_from = temp_dir_.GetPath().Append(
+      FILE_PATH_LITERAL("copy_contents_file_in.txt"));
+  FilePath file_name_to = temp_dir_.GetPath().Append(
+      FILE_PATH_LITERAL("copy_contents_file_out.txt"));
+  CreateTextFile(file_name_from, L"0123456789ABCDEF");
+  CreateTextFile(file_name_to, L"GHIJKL");
+
+  File from(file_name_from, File::FLAG_OPEN | File::FLAG_READ);
+  ASSERT_TRUE(from.IsValid());
+  File to(file_name_to, File::FLAG_OPEN | File::FLAG_WRITE);
+  ASSERT_TRUE(to.IsValid());
+  ASSERT_EQ(from.Seek(File::Whence::FROM_BEGIN, 1), 1);
+  ASSERT_EQ(to.Seek(File::Whence::FROM_BEGIN, 1), 1);
+
+  bool retry_slow = false;
+  if (!internal::CopyFileContentsWithCopyFileRange(from, to, retry_slow)) {
+    // The kernel or the file system may not support it.
+    ASSERT_TRUE(retry_slow);
+    ASSERT_EQ(from.Seek(File::Whence::FROM_CURRENT, 0), 1);
+    return;
+  }
+  EXPECT_EQ(from.Seek(File::Whence::FROM_CURRENT, 0), 16);
+  from.Close();
+  to.Close();
+
+  EXPECT_EQ(L"G123456789ABCDEF", ReadTextFile(file_name_to));
+}
+
+TEST_F(FileUtilTest, CopyFileContentsWithCopyFileRangeSeqFile) {
+  FilePath file_name_to = temp_dir_.GetPath().Append(
+      FILE_PATH_LITERAL("copy_contents_file_out.txt"));
+  File from(FilePath("/proc/meminfo"), File::FLAG_OPEN | File::FLAG_READ);
+  ASSERT_TRUE(from.IsValid());
+  File to(file_name_to,
+          File::FLAG_OPEN | File::FLAG_WRITE | File::FLAG_CREATE_ALWAYS);
+  ASSERT_TRUE(to.IsValid());
+
+  bool retry_slow = false;
+  ASSERT_FALSE(
+      internal::CopyFileContentsWithCopyFileRange(from, to, retry_slow));
+  ASSERT_TRUE(retry_slow);
+  EXPECT_EQ(to.GetLength(), 0);
+}
+
+TEST_F(FileUtilTest, CopyFileContentsWithReflinkOnlyFromTheStart) {
+  FilePath file_name_from = temp_dir_.GetPath().Append(
+      FILE_PATH_LITERAL("copy_contents_file_in.txt"));
+  FilePath file_name_to = temp_dir_.GetPath().Append(
+      FILE_PATH_LITERAL("copy_contents_file_out.txt"));
+  CreateTextFile(file_name_from, L"0123456789ABCDEF");
+
+  File from(file_name_from, File::FLAG_OPEN | File::FLAG_READ);
+  ASSERT_TRUE(from.IsValid());
+  File to(file_name_to,
+          File::FLAG_OPEN | File::FLAG_WRITE | File::FLAG_CREATE_ALWAYS);
+  ASSERT_TRUE(to.IsValid());
+  ASSERT_EQ(from.Seek(File::Whence::FROM_BEGIN, 1), 1);
+
+  // A clone would copy the first byte too.
+  bool retry_slow = false;
+  ASSERT_FALSE(internal::CopyFileContentsWithReflink(from, to, retry_slow));
+  ASSERT_TRUE(retry_slow);
+  EXPECT_EQ(from.Seek(File::Whence::FROM_CURRENT, 0), 1);
+  EXPECT_EQ(to.GetLength(), 0);
+
+  // Most file systems do not support it, but CopyFileContents() falls back.
+  ASSERT_EQ(from.Seek(File::Whence::FROM_BEGIN, 0), 0);
+  retry_slow = false;
+  if (internal::CopyFileContentsWithReflink(from, to, retry_slow))
+    EXPECT_EQ(from.Seek(File::Whence::FROM_CURRENT, 0), 16);
+  else
+    ASSERT_TRUE(retry_slow);
+  from.Close();
+  to.Close();
+}
+
+TEST_F(FileUtilTest, CopyFileContentsRecordsMethod) {
+  FilePath file_name_from = temp_dir_.GetPath().Append(
+      FILE_PATH_LITERAL("copy_contents_file_in.txt"));
+  FilePath file_name_to = temp_dir_.GetPath().Append(
+      FILE_PATH_LITERAL("copy_contents_file_out.txt"));
+  CreateTextFile(file_name_from, L"0123456789ABCDEF");
+
+  HistogramTester histogram_tester;
+  ASSERT_TRUE(CopyFile(file_name_from, file_name_to));
+  EXPECT_EQ(L"0123456789ABCDEF", ReadTextFile(file_name_to));
+  histogram_tester.ExpectTotalCount("File.CopyFileContents.Method", 1);
+
+  // Files which report a size of 0 are copied with read(2) and write(2).
+  File from(FilePath("/proc/meminfo"), File::FLAG_OPEN | File::FLAG_READ);
+  ASSERT_TRUE(from.IsValid());
+  File to(file_name_to,
+          File::FLAG_OPEN | File::FLAG_WRITE | File::FLAG_CREATE_ALWAYS);
+  ASSERT_TRUE(to.IsValid());
+  ASSERT_TRUE(CopyFileContents(from, to));
+  histogram_tester.ExpectBucketCount("File.CopyFileContents.Method",
+                                     /*kReadWrite=*/3, 1);
+}
+
+TEST_F(FileUtilTest, CopyDirectoryFilesInParallel) {
+  test::TaskEnvironment task_environment;
+  FilePath dir_name_from =
+      temp_dir_.GetPath().Append(FILE_PATH_LITERAL("Copy_From_Subdir"));
+  FilePath subdir_name_from = dir_name_from.Append(FILE_PATH_LITERAL("Subdir"));
+  ASSERT_TRUE(CreateDirectory(subdir_name_from));
+  std::vector<FilePath> relative_paths;
+  for (int i = 0; i < 50; ++i) {
+    const FilePath file_name =
+        FilePath::FromUTF8Unsafe(StringPrintf("file%d.txt", i));
+    const FilePath relative_path =
+        i % 2 ? FilePath(FILE_PATH_LITERAL("Subdir")).Append(file_name)
+              : file_name;
+    CreateTextFile(dir_name_from.Append(relative_path),
+                   UTF8ToWide(StringPrintf("contents %d", i)));
+    relative_paths.push_back(relative_path);
+  }
+
+  FilePath dir_name_to =
+      temp_dir_.GetPath().Append(FILE_PATH_LITERAL("Copy_To_Subdir"));
+  EXPECT_TRUE(CopyDirectory(dir_name_from, dir_name_to, true));
+  for (size_t i = 0; i < relative_paths.size(); ++i) {
+    EXPECT_EQ(UTF8ToWide(StringPrintf("contents %zu", i)),
+              ReadTextFile(dir_name_to.Append(relative_paths[i])));
+  }
+}
+
 #endif  // BUILDFLAG(IS_LINUX) || BUILDFLAG(IS_CHROMEOS) ||
         // BUILDFLAG(IS_ANDROID)
 
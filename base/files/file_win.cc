@@ -294,7 +294,9 @@ File File::Duplicate() const {
     return File(GetLastFileError());
   }
 
-  return File(ScopedPlatformFile(other_handle), async());
+  File other(ScopedPlatformFile(other_handle), async());
+  other.io_metrics_path_class_ = io_metrics_path_class_;
+  return other;
 }
 
 bool File::DeleteOnClose(bool delete_on_close) {
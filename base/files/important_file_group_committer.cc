@@ -0,0 +1,66 @@
+// Copyright 2022 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "base/files/important_file_group_committer.h"
+
+#include <utility>
+
+#include "base/bind.h"
+#include "base/check.h"
+#include "base/critical_closure.h"
+#include "base/location.h"
+#include "base/task/sequenced_task_runner.h"
+
+namespace base {
+
+ImportantFileGroupCommitter::ImportantFileGroupCommitter(
+    scoped_refptr<SequencedTaskRunner> task_runner,
+    TimeDelta window)
+    : task_runner_(std::move(task_runner)), window_(window) {
+  DCHECK(task_runner_);
+  // Created on the sequence of the writers, but used on |task_runner_|.
+  DETACH_FROM_SEQUENCE(sequence_checker_);
+}
+
+ImportantFileGroupCommitter::~ImportantFileGroupCommitter() {
+  // The task committing the pending writes holds a reference.
+  DCHECK(pending_writes_.empty());
+}
+
+void ImportantFileGroupCommitter::AddWrite(
+    ImportantFileWriter::GroupWrite write) {
+  DCHECK_CALLED_ON_VALID_SEQUENCE(sequence_checker_);
+  pending_writes_.push_back(std::move(write));
+  if (pending_writes_.size() >= kMaxPendingWrites) {
+    CommitPendingWrites();
+    return;
+  }
+  if (pending_writes_.size() == 1) {
+    task_runner_->PostDelayedTask(
+        FROM_HERE,
+        MakeCriticalClosure(
+            "ImportantFileGroupCommitter::CommitPendingWrites",
+            BindOnce(&ImportantFileGroupCommitter::OnWindowEnd, this,
+                     batch_id_)),
+        window_);
+  }
+}
+
+void ImportantFileGroupCommitter::CommitPendingWrites() {
+  DCHECK_CALLED_ON_VALID_SEQUENCE(sequence_checker_);
+  if (pending_writes_.empty())
+    return;
+  ++batch_id_;
+  std::vector<ImportantFileWriter::GroupWrite> writes;
+  writes.swap(pending_writes_);
+  ImportantFileWriter::WriteFilesAtomicallyImpl(std::move(writes));
+}
+
+void ImportantFileGroupCommitter::OnWindowEnd(uint64_t batch_id) {
+  DCHECK_CALLED_ON_VALID_SEQUENCE(sequence_checker_);
+  if (batch_id == batch_id_)
+    CommitPendingWrites();
+}
+
+}  // namespace base
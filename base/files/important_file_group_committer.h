@@ -0,0 +1,90 @@
+// Copyright 2022 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#ifndef BASE_FILES_IMPORTANT_FILE_GROUP_COMMITTER_H_
+#define BASE_FILES_IMPORTANT_FILE_GROUP_COMMITTER_H_
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include <vector>
+
+#include "base/base_export.h"
+#include "base/files/important_file_writer.h"
+#include "base/memory/ref_counted.h"
+#include "base/sequence_checker.h"
+#include "base/time/time.h"
+
+namespace base {
+
+class SequencedTaskRunner;
+
+// Commits the writes of several ImportantFileWriters together, so that the
+// disk is flushed once for all of them rather than once per file. The writes
+// due within |window| of the first pending one are committed at once on
+// |task_runner|: their temporary files are written, then flushed together
+// (with one syncfs() per file system on Linux, ChromeOS and Android, or one
+// File::Flush() per file elsewhere), and then renamed over their target
+// files. Each target file keeps either its previous or its new contents, like
+// with ImportantFileWriter::WriteFileAtomically().
+//
+// The window delays the writes scheduled by ImportantFileWriter::
+// ScheduleWrite() by up to |window|, on top of the commit interval, so the
+// writers whose data must not wait should call WriteNow(), which commits the
+// pending writes of the group right away.
+//
+// Example:
+//
+//   auto committer = base::MakeRefCounted<base::ImportantFileGroupCommitter>(
+//       file_task_runner);
+//   base::ImportantFileWriter writer(path, committer, base::Seconds(10));
+class BASE_EXPORT ImportantFileGroupCommitter
+    : public RefCountedThreadSafe<ImportantFileGroupCommitter> {
+ public:
+  static constexpr TimeDelta kDefaultWindow = Seconds(1);
+  // Pending writes are committed right away once there are this many, which
+  // bounds the temporary files open at once.
+  static constexpr size_t kMaxPendingWrites = 128;
+
+  explicit ImportantFileGroupCommitter(
+      scoped_refptr<SequencedTaskRunner> task_runner,
+      TimeDelta window = kDefaultWindow);
+  ImportantFileGroupCommitter(const ImportantFileGroupCommitter&) = delete;
+  ImportantFileGroupCommitter& operator=(const ImportantFileGroupCommitter&) =
+      delete;
+
+  // The sequence on which the file I/O of the writers is done.
+  const scoped_refptr<SequencedTaskRunner>& task_runner() const {
+    return task_runner_;
+  }
+
+ private:
+  friend class ImportantFileWriter;
+  friend class RefCountedThreadSafe<ImportantFileGroupCommitter>;
+
+  ~ImportantFileGroupCommitter();
+
+  // Adds |write| to the pending writes. Called on |task_runner_|.
+  void AddWrite(ImportantFileWriter::GroupWrite write);
+
+  // Commits the pending writes. Called on |task_runner_|.
+  void CommitPendingWrites();
+
+  // Commits the pending writes if they are still those of |batch_id|.
+  void OnWindowEnd(uint64_t batch_id);
+
+  const scoped_refptr<SequencedTaskRunner> task_runner_;
+  const TimeDelta window_;
+
+  std::vector<ImportantFileWriter::GroupWrite> pending_writes_;
+  // Incremented whenever the pending writes are committed, so that the end of
+  // their window is ignored if it was earlier.
+  uint64_t batch_id_ = 0;
+
+  SEQUENCE_CHECKER(sequence_checker_);
+};
+
+}  // namespace base
+
+#endif  // BASE_FILES_IMPORTANT_FILE_GROUP_COMMITTER_H_
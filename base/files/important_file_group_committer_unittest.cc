@@ -0,0 +1,156 @@
+// Copyright 2022 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "base/files/important_file_group_committer.h"
+
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "base/bind.h"
+#include "base/files/file_path.h"
+#include "base/files/file_util.h"
+#include "base/files/important_file_writer.h"
+#include "base/files/scoped_temp_dir.h"
+#include "base/strings/string_number_conversions.h"
+#include "base/test/task_environment.h"
+#include "base/threading/thread_task_runner_handle.h"
+#include "base/time/time.h"
+#include "testing/gtest/include/gtest/gtest.h"
+
+namespace base {
+
+namespace {
+
+constexpr TimeDelta kCommitInterval = Seconds(1);
+constexpr TimeDelta kWindow = Seconds(2);
+
+class DataSerializer : public ImportantFileWriter::DataSerializer {
+ public:
+  explicit DataSerializer(const std::string& data) : data_(data) {}
+
+  bool SerializeData(std::string* output) override {
+    output->assign(data_);
+    return true;
+  }
+
+ private:
+  const std::string data_;
+};
+
+std::string GetFileContent(const FilePath& path) {
+  std::string content;
+  if (!ReadFileToString(path, &content))
+    return "<missing>";
+  return content;
+}
+
+class ImportantFileGroupCommitterTest : public testing::Test {
+ public:
+  void SetUp() override {
+    ASSERT_TRUE(temp_dir_.CreateUniqueTempDir());
+    committer_ = MakeRefCounted<ImportantFileGroupCommitter>(
+        ThreadTaskRunnerHandle::Get(), kWindow);
+  }
+
+ protected:
+  FilePath GetPath(size_t i) const {
+    return temp_dir_.GetPath().AppendASCII("file" + NumberToString(i));
+  }
+
+  test::TaskEnvironment task_environment_{
+      test::TaskEnvironment::TimeSource::MOCK_TIME};
+  ScopedTempDir temp_dir_;
+  scoped_refptr<ImportantFileGroupCommitter> committer_;
+};
+
+}  // namespace
+
+TEST_F(ImportantFileGroupCommitterTest, CommitsScheduledWritesTogether) {
+  DataSerializer foo("foo"), bar("bar");
+  ImportantFileWriter first(GetPath(0), committer_, kCommitInterval);
+  ImportantFileWriter second(GetPath(1), committer_, 2 * kCommitInterval);
+  first.ScheduleWrite(&foo);
+  second.ScheduleWrite(&bar);
+
+  // The first write waits for the window to end, which the second write joins.
+  task_environment_.FastForwardBy(2 * kCommitInterval);
+  EXPECT_FALSE(PathExists(GetPath(0)));
+  EXPECT_FALSE(PathExists(GetPath(1)));
+
+  task_environment_.FastForwardBy(kWindow - kCommitInterval);
+  EXPECT_EQ("foo", GetFileContent(GetPath(0)));
+  EXPECT_EQ("bar", GetFileContent(GetPath(1)));
+}
+
+TEST_F(ImportantFileGroupCommitterTest, WriteNowCommitsPendingWrites) {
+  DataSerializer foo("foo");
+  ImportantFileWriter first(GetPath(0), committer_, kCommitInterval);
+  ImportantFileWriter second(GetPath(1), committer_, kCommitInterval);
+  first.ScheduleWrite(&foo);
+  task_environment_.FastForwardBy(kCommitInterval);
+  EXPECT_FALSE(PathExists(GetPath(0)));
+
+  second.WriteNow(std::make_unique<std::string>("bar"));
+  task_environment_.RunUntilIdle();
+  EXPECT_EQ("foo", GetFileContent(GetPath(0)));
+  EXPECT_EQ("bar", GetFileContent(GetPath(1)));
+
+  // The end of the window of the committed writes does not commit the next
+  // ones early.
+  DataSerializer baz("baz");
+  first.ScheduleWrite(&baz);
+  task_environment_.FastForwardBy(kWindow);
+  EXPECT_EQ("foo", GetFileContent(GetPath(0)));
+  task_environment_.FastForwardBy(kCommitInterval);
+  EXPECT_EQ("baz", GetFileContent(GetPath(0)));
+}
+
+TEST_F(ImportantFileGroupCommitterTest, LatestWriteOfAFileWins) {
+  ImportantFileWriter writer(GetPath(0), committer_, kCommitInterval);
+  DataSerializer foo("foo"), bar("bar");
+  writer.ScheduleWrite(&foo);
+  task_environment_.FastForwardBy(kCommitInterval);
+  writer.ScheduleWrite(&bar);
+  task_environment_.FastForwardBy(kWindow);
+  EXPECT_EQ("bar", GetFileContent(GetPath(0)));
+}
+
+TEST_F(ImportantFileGroupCommitterTest, ReportsEachWrite) {
+  ImportantFileWriter writer(GetPath(0), committer_, kCommitInterval);
+  ImportantFileWriter failing_writer(
+      temp_dir_.GetPath().AppendASCII("missing").AppendASCII("file"),
+      committer_, kCommitInterval);
+  bool success = false;
+  bool failing_success = true;
+  writer.RegisterOnNextWriteCallbacks(
+      OnceClosure(),
+      BindOnce([](bool* out, bool success) { *out = success; }, &success));
+  failing_writer.RegisterOnNextWriteCallbacks(
+      OnceClosure(), BindOnce([](bool* out, bool success) { *out = success; },
+                              &failing_success));
+
+  DataSerializer foo("foo");
+  writer.ScheduleWrite(&foo);
+  failing_writer.ScheduleWrite(&foo);
+  task_environment_.FastForwardBy(kCommitInterval + kWindow);
+  EXPECT_TRUE(success);
+  EXPECT_FALSE(failing_success);
+  EXPECT_EQ("foo", GetFileContent(GetPath(0)));
+}
+
+TEST_F(ImportantFileGroupCommitterTest, CommitsFullGroupRightAway) {
+  DataSerializer foo("foo");
+  std::vector<std::unique_ptr<ImportantFileWriter>> writers;
+  for (size_t i = 0; i < ImportantFileGroupCommitter::kMaxPendingWrites; ++i) {
+    writers.push_back(std::make_unique<ImportantFileWriter>(
+        GetPath(i), committer_, kCommitInterval));
+    writers.back()->ScheduleWrite(&foo);
+  }
+  task_environment_.FastForwardBy(kCommitInterval);
+  for (size_t i = 0; i < writers.size(); ++i)
+    EXPECT_EQ("foo", GetFileContent(GetPath(i)));
+}
+
+}  // namespace base
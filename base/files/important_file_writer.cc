@@ -17,10 +17,12 @@
 #include "base/check.h"
 #include "base/critical_closure.h"
 #include "base/cxx17_backports.h"
+#include "base/containers/flat_map.h"
 #include "base/debug/alias.h"
 #include "base/files/file.h"
 #include "base/files/file_path.h"
 #include "base/files/file_util.h"
+#include "base/files/important_file_group_committer.h"
 #include "base/files/important_file_writer_cleaner.h"
 #include "base/logging.h"
 #include "base/metrics/histogram_functions.h"
@@ -31,12 +33,19 @@
 #include "base/task/task_runner.h"
 #include "base/task/task_runner_util.h"
 #include "base/threading/platform_thread.h"
+#include "base/threading/scoped_blocking_call.h"
 #include "base/threading/sequenced_task_runner_handle.h"
 #include "base/threading/thread.h"
 #include "base/time/time.h"
 #include "build/build_config.h"
 #include "build/chromeos_buildflags.h"
 
+#if BUILDFLAG(IS_LINUX) || BUILDFLAG(IS_CHROMEOS) || BUILDFLAG(IS_ANDROID)
+#include <sys/syscall.h>
+#include <sys/utsname.h>
+#include <unistd.h>
+#endif
+
 namespace base {
 
 namespace {
@@ -103,6 +112,161 @@ void DeleteTmpFileWithRetry(File tmp_file,
   }
 }
 
+// Creates a temporary file next to |path| and writes |data| to it, without
+// flushing it. Returns an invalid File on failure.
+File CreateTmpFileWithData(const FilePath& path,
+                           StringPiece data,
+                           FilePath* tmp_file_path) {
+  // Write the data to a temp file then rename to avoid data loss if we crash
+  // while writing the file. Ensure that the temp file is on the same volume
+  // as target file, so it can be moved in one step, and that the temp file
+  // is securely created.
+  File tmp_file =
+      CreateAndOpenTemporaryFileInDir(path.DirName(), tmp_file_path);
+  if (!tmp_file.IsValid()) {
+    DPLOG(WARNING) << "Failed to create temporary file to update " << path;
+    return File();
+  }
+
+  // Don't write all of the data at once because this can lead to kernel
+  // address-space exhaustion on 32-bit Windows (see https://crbug.com/1001022
+  // for details).
+  constexpr ptrdiff_t kMaxWriteAmount = 8 * 1024 * 1024;
+  int bytes_written = 0;
+  for (const char *scan = data.data(), *const end = scan + data.length();
+       scan < end; scan += bytes_written) {
+    const int write_amount = std::min(kMaxWriteAmount, end - scan);
+    bytes_written = tmp_file.WriteAtCurrentPos(scan, write_amount);
+    if (bytes_written != write_amount) {
+      DPLOG(WARNING) << "Failed to write " << write_amount << " bytes to temp "
+                     << "file to update " << path
+                     << " (bytes_written=" << bytes_written << ")";
+      DeleteTmpFileWithRetry(std::move(tmp_file), *tmp_file_path);
+      return File();
+    }
+  }
+
+  return tmp_file;
+}
+
+// Closes |tmp_file|, which is flushed, and renames it to |path|. Deletes
+// |tmp_file_path| on failure.
+bool ReplaceWithTmpFile(File tmp_file,
+                        const FilePath& tmp_file_path,
+                        const FilePath& path) {
+  File::Error replace_file_error = File::FILE_OK;
+
+  // The file must be closed for ReplaceFile to do its job, which opens up a
+  // race with other software that may open the temp file (e.g., an A/V scanner
+  // doing its job without oplocks). Boost a background thread's priority on
+  // Windows and close as late as possible to improve the chances that the other
+  // software will lose the race.
+#if BUILDFLAG(IS_WIN)
+  const auto previous_priority = PlatformThread::GetCurrentThreadPriority();
+  const bool reset_priority = previous_priority <= ThreadPriority::NORMAL;
+  if (reset_priority)
+    PlatformThread::SetCurrentThreadPriority(ThreadPriority::DISPLAY);
+#endif  // BUILDFLAG(IS_WIN)
+  tmp_file.Close();
+  bool result = ReplaceFile(tmp_file_path, path, &replace_file_error);
+#if BUILDFLAG(IS_WIN)
+  // Save and restore the last error code so that it's not polluted by the
+  // thread priority change.
+  auto last_error = ::GetLastError();
+  int retry_count = 0;
+  for (/**/; !result && retry_count < kReplaceRetries; ++retry_count) {
+    // The race condition between closing the temporary file and moving it gets
+    // hit on a regular basis on some systems (https://crbug.com/1099284), so
+    // we retry a few times before giving up.
+    PlatformThread::Sleep(kReplacePauseInterval);
+    result = ReplaceFile(tmp_file_path, path, &replace_file_error);
+    last_error = ::GetLastError();
+  }
+  if (reset_priority)
+    PlatformThread::SetCurrentThreadPriority(previous_priority);
+
+  // Log how many times we had to retry the ReplaceFile operation before it
+  // succeeded. If we never succeeded then return a special value.
+  if (!result)
+    retry_count = kReplaceRetryFailure;
+  UmaHistogramExactLinear("ImportantFile.FileReplaceRetryCount", retry_count,
+                          kReplaceRetryFailure);
+#endif  // BUILDFLAG(IS_WIN)
+
+  if (!result) {
+#if BUILDFLAG(IS_WIN)
+    // Restore the error code from ReplaceFile so that it will be available for
+    // the log message, otherwise failures in SetCurrentThreadPriority may be
+    // reported instead.
+    ::SetLastError(last_error);
+#endif
+    DPLOG(WARNING) << "Failed to replace " << path << " with " << tmp_file_path;
+    DeleteTmpFileWithRetry(File(), tmp_file_path);
+  }
+
+  return result;
+}
+
+#if BUILDFLAG(IS_LINUX) || BUILDFLAG(IS_CHROMEOS) || BUILDFLAG(IS_ANDROID)
+// Returns true if syncfs() reports the writeback errors of the file system,
+// which it does since Linux 5.8. Before that, only fdatasync() tells whether
+// the data of a file made it to the disk.
+bool SyncFsReportsErrors() {
+  static const bool reports_errors = [] {
+    struct utsname info;
+    int major_version = 0;
+    int minor_version = 0;
+    if (uname(&info) < 0 ||
+        sscanf(info.release, "%d.%d", &major_version, &minor_version) != 2) {
+      return false;
+    }
+    return major_version > 5 || (major_version == 5 && minor_version >= 8);
+  }();
+  return reports_errors;
+}
+#endif
+
+// Flushes the valid files of |tmp_files|, and returns whether each one was.
+std::vector<bool> FlushTmpFiles(std::vector<File>* tmp_files) {
+  std::vector<bool> flushed(tmp_files->size(), false);
+#if BUILDFLAG(IS_LINUX) || BUILDFLAG(IS_CHROMEOS) || BUILDFLAG(IS_ANDROID)
+  // One syncfs() writes back the files of a file system and flushes the device
+  // once, rather than once per fdatasync(). It also writes back the other
+  // dirty data of the file system, so it is only worth it for several files.
+  if (SyncFsReportsErrors()) {
+    flat_map<dev_t, std::vector<size_t>> file_systems;
+    for (size_t i = 0; i < tmp_files->size(); ++i) {
+      stat_wrapper_t file_info;
+      if ((*tmp_files)[i].IsValid() &&
+          File::Fstat((*tmp_files)[i].GetPlatformFile(), &file_info) == 0) {
+        file_systems[file_info.st_dev].push_back(i);
+      }
+    }
+    for (const auto& file_system : file_systems) {
+      const std::vector<size_t>& indices = file_system.second;
+      if (indices.size() < 2)
+        continue;
+      ScopedBlockingCall scoped_blocking_call(FROM_HERE,
+                                              BlockingType::MAY_BLOCK);
+      // On failure, which may come from any file of the file system,
+      // fdatasync() tells which of |indices| are not on disk.
+      if (syscall(__NR_syncfs, (*tmp_files)[indices[0]].GetPlatformFile())) {
+        DPLOG(WARNING) << "Failed to sync the file system of "
+                       << indices.size() << " temp files";
+        continue;
+      }
+      for (size_t index : indices)
+        flushed[index] = true;
+    }
+  }
+#endif
+  for (size_t i = 0; i < tmp_files->size(); ++i) {
+    if ((*tmp_files)[i].IsValid() && !flushed[i])
+      flushed[i] = (*tmp_files)[i].Flush();
+  }
+  return flushed;
+}
+
 }  // namespace
 
 // static
@@ -121,7 +285,9 @@ void ImportantFileWriter::ProduceAndWriteStringToFileAtomically(
     BackgroundDataProducerCallback data_producer_for_background_sequence,
     OnceClosure before_write_callback,
     OnceCallback<void(bool success)> after_write_callback,
-    const std::string& histogram_suffix) {
+    const std::string& histogram_suffix,
+    scoped_refptr<ImportantFileGroupCommitter> group_committer,
+    bool scheduled) {
   // Produce the actual data string on the background sequence.
   std::string data;
   if (!std::move(data_producer_for_background_sequence).Run(&data)) {
@@ -132,6 +298,14 @@ void ImportantFileWriter::ProduceAndWriteStringToFileAtomically(
   if (!before_write_callback.is_null())
     std::move(before_write_callback).Run();
 
+  if (group_committer) {
+    group_committer->AddWrite(
+        GroupWrite(path, std::move(data), std::move(after_write_callback)));
+    if (!scheduled)
+      group_committer->CommitPendingWrites();
+    return;
+  }
+
   // Calling the impl by way of the private
   // ProduceAndWriteStringToFileAtomically, which originated from an
   // ImportantFileWriter instance, so |from_instance| is true.
@@ -173,35 +347,10 @@ bool ImportantFileWriter::WriteFileAtomicallyImpl(const FilePath& path,
   debug::Alias(&file_info);
 #endif
 
-  // Write the data to a temp file then rename to avoid data loss if we crash
-  // while writing the file. Ensure that the temp file is on the same volume
-  // as target file, so it can be moved in one step, and that the temp file
-  // is securely created.
   FilePath tmp_file_path;
-  File tmp_file =
-      CreateAndOpenTemporaryFileInDir(path.DirName(), &tmp_file_path);
-  if (!tmp_file.IsValid()) {
-    DPLOG(WARNING) << "Failed to create temporary file to update " << path;
+  File tmp_file = CreateTmpFileWithData(path, data, &tmp_file_path);
+  if (!tmp_file.IsValid())
     return false;
-  }
-
-  // Don't write all of the data at once because this can lead to kernel
-  // address-space exhaustion on 32-bit Windows (see https://crbug.com/1001022
-  // for details).
-  constexpr ptrdiff_t kMaxWriteAmount = 8 * 1024 * 1024;
-  int bytes_written = 0;
-  for (const char *scan = data.data(), *const end = scan + data.length();
-       scan < end; scan += bytes_written) {
-    const int write_amount = std::min(kMaxWriteAmount, end - scan);
-    bytes_written = tmp_file.WriteAtCurrentPos(scan, write_amount);
-    if (bytes_written != write_amount) {
-      DPLOG(WARNING) << "Failed to write " << write_amount << " bytes to temp "
-                     << "file to update " << path
-                     << " (bytes_written=" << bytes_written << ")";
-      DeleteTmpFileWithRetry(std::move(tmp_file), tmp_file_path);
-      return false;
-    }
-  }
 
   if (!tmp_file.Flush()) {
     DPLOG(WARNING) << "Failed to flush temp file to update " << path;
@@ -209,57 +358,37 @@ bool ImportantFileWriter::WriteFileAtomicallyImpl(const FilePath& path,
     return false;
   }
 
-  File::Error replace_file_error = File::FILE_OK;
+  return ReplaceWithTmpFile(std::move(tmp_file), tmp_file_path, path);
+}
 
-  // The file must be closed for ReplaceFile to do its job, which opens up a
-  // race with other software that may open the temp file (e.g., an A/V scanner
-  // doing its job without oplocks). Boost a background thread's priority on
-  // Windows and close as late as possible to improve the chances that the other
-  // software will lose the race.
-#if BUILDFLAG(IS_WIN)
-  const auto previous_priority = PlatformThread::GetCurrentThreadPriority();
-  const bool reset_priority = previous_priority <= ThreadPriority::NORMAL;
-  if (reset_priority)
-    PlatformThread::SetCurrentThreadPriority(ThreadPriority::DISPLAY);
-#endif  // BUILDFLAG(IS_WIN)
-  tmp_file.Close();
-  bool result = ReplaceFile(tmp_file_path, path, &replace_file_error);
-#if BUILDFLAG(IS_WIN)
-  // Save and restore the last error code so that it's not polluted by the
-  // thread priority change.
-  auto last_error = ::GetLastError();
-  int retry_count = 0;
-  for (/**/; !result && retry_count < kReplaceRetries; ++retry_count) {
-    // The race condition between closing the temporary file and moving it gets
-    // hit on a regular basis on some systems (https://crbug.com/1099284), so
-    // we retry a few times before giving up.
-    PlatformThread::Sleep(kReplacePauseInterval);
-    result = ReplaceFile(tmp_file_path, path, &replace_file_error);
-    last_error = ::GetLastError();
+// static
+void ImportantFileWriter::WriteFilesAtomicallyImpl(
+    std::vector<GroupWrite> writes) {
+  std::vector<File> tmp_files;
+  std::vector<FilePath> tmp_file_paths(writes.size());
+  tmp_files.reserve(writes.size());
+  for (size_t i = 0; i < writes.size(); ++i) {
+    tmp_files.push_back(CreateTmpFileWithData(writes[i].path, writes[i].data,
+                                              &tmp_file_paths[i]));
+    std::string().swap(writes[i].data);
   }
-  if (reset_priority)
-    PlatformThread::SetCurrentThreadPriority(previous_priority);
 
-  // Log how many times we had to retry the ReplaceFile operation before it
-  // succeeded. If we never succeeded then return a special value.
-  if (!result)
-    retry_count = kReplaceRetryFailure;
-  UmaHistogramExactLinear("ImportantFile.FileReplaceRetryCount", retry_count,
-                          kReplaceRetryFailure);
-#endif  // BUILDFLAG(IS_WIN)
-
-  if (!result) {
-#if BUILDFLAG(IS_WIN)
-    // Restore the error code from ReplaceFile so that it will be available for
-    // the log message, otherwise failures in SetCurrentThreadPriority may be
-    // reported instead.
-    ::SetLastError(last_error);
-#endif
-    DPLOG(WARNING) << "Failed to replace " << path << " with " << tmp_file_path;
-    DeleteTmpFileWithRetry(File(), tmp_file_path);
+  // Like in WriteFileAtomicallyImpl(), a file is only replaced once its new
+  // contents are flushed.
+  const std::vector<bool> flushed = FlushTmpFiles(&tmp_files);
+  for (size_t i = 0; i < writes.size(); ++i) {
+    bool result = false;
+    if (flushed[i]) {
+      result = ReplaceWithTmpFile(std::move(tmp_files[i]), tmp_file_paths[i],
+                                  writes[i].path);
+    } else if (tmp_files[i].IsValid()) {
+      DPLOG(WARNING) << "Failed to flush temp file to update "
+                     << writes[i].path;
+      DeleteTmpFileWithRetry(std::move(tmp_files[i]), tmp_file_paths[i]);
+    }
+    if (!writes[i].after_write_callback.is_null())
+      std::move(writes[i].after_write_callback).Run(result);
   }
-
-  return result;
 }
 
 ImportantFileWriter::ImportantFileWriter(
@@ -284,6 +413,19 @@ ImportantFileWriter::ImportantFileWriter(
   ImportantFileWriterCleaner::AddDirectory(path.DirName());
 }
 
+ImportantFileWriter::ImportantFileWriter(
+    const FilePath& path,
+    scoped_refptr<ImportantFileGroupCommitter> group_committer,
+    TimeDelta interval,
+    StringPiece histogram_suffix)
+    : path_(path),
+      task_runner_(group_committer->task_runner()),
+      group_committer_(std::move(group_committer)),
+      commit_interval_(interval),
+      histogram_suffix_(histogram_suffix) {
+  ImportantFileWriterCleaner::AddDirectory(path.DirName());
+}
+
 ImportantFileWriter::~ImportantFileWriter() {
   DCHECK_CALLED_ON_VALID_SEQUENCE(sequence_checker_);
   // We're usually a member variable of some other object, which also tends
@@ -313,14 +455,16 @@ void ImportantFileWriter::WriteNow(std::unique_ptr<std::string> data) {
 }
 
 void ImportantFileWriter::WriteNowWithBackgroundDataProducer(
-    BackgroundDataProducerCallback background_data_producer) {
+    BackgroundDataProducerCallback background_data_producer,
+    bool scheduled) {
   DCHECK_CALLED_ON_VALID_SEQUENCE(sequence_checker_);
 
-  auto split_task = SplitOnceCallback(
-      BindOnce(&ProduceAndWriteStringToFileAtomically, path_,
-               std::move(background_data_producer),
-               std::move(before_next_write_callback_),
-               std::move(after_next_write_callback_), histogram_suffix_));
+  auto split_task = SplitOnceCallback(BindOnce(
+      &ProduceAndWriteStringToFileAtomically, path_,
+      std::move(background_data_producer),
+      std::move(before_next_write_callback_),
+      std::move(after_next_write_callback_), histogram_suffix_,
+      group_committer_, scheduled));
 
   if (!task_runner_->PostTask(
           FROM_HERE, MakeCriticalClosure("ImportantFileWriter::WriteNow",
@@ -406,10 +550,25 @@ void ImportantFileWriter::DoScheduledWrite() {
                               histogram_suffix_, serialization_duration);
 
   WriteNowWithBackgroundDataProducer(
-      std::move(data_producer_for_background_sequence));
+      std::move(data_producer_for_background_sequence), /*scheduled=*/true);
   DCHECK(!HasPendingWrite());
 }
 
+ImportantFileWriter::GroupWrite::GroupWrite(
+    const FilePath& path,
+    std::string data,
+    OnceCallback<void(bool success)> after_write_callback)
+    : path(path),
+      data(std::move(data)),
+      after_write_callback(std::move(after_write_callback)) {}
+
+ImportantFileWriter::GroupWrite::GroupWrite(GroupWrite&&) = default;
+
+ImportantFileWriter::GroupWrite& ImportantFileWriter::GroupWrite::operator=(
+    GroupWrite&&) = default;
+
+ImportantFileWriter::GroupWrite::~GroupWrite() = default;
+
 void ImportantFileWriter::RegisterOnNextWriteCallbacks(
     OnceClosure before_next_write_callback,
     OnceCallback<void(bool success)> after_next_write_callback) {
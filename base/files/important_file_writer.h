@@ -7,6 +7,7 @@
 
 #include <memory>
 #include <string>
+#include <vector>
 
 #include "base/base_export.h"
 #include "base/callback.h"
@@ -21,6 +22,7 @@
 
 namespace base {
 
+class ImportantFileGroupCommitter;
 class SequencedTaskRunner;
 
 // Helper for atomically writing a file to ensure that it won't be corrupted by
@@ -94,6 +96,16 @@ class BASE_EXPORT ImportantFileWriter {
                       TimeDelta interval,
                       StringPiece histogram_suffix = StringPiece());
 
+  // Same as above, but the writes are committed along with those of the other
+  // writers of |group_committer|, on its task runner. Scheduled writes wait
+  // for the window of the group committer after the commit interval, while
+  // WriteNow() commits the pending writes of the group right away.
+  ImportantFileWriter(
+      const FilePath& path,
+      scoped_refptr<ImportantFileGroupCommitter> group_committer,
+      TimeDelta interval,
+      StringPiece histogram_suffix = StringPiece());
+
   ImportantFileWriter(const ImportantFileWriter&) = delete;
   ImportantFileWriter& operator=(const ImportantFileWriter&) = delete;
 
@@ -153,6 +165,22 @@ class BASE_EXPORT ImportantFileWriter {
   }
 
  private:
+  friend class ImportantFileGroupCommitter;
+
+  // A write committed by an ImportantFileGroupCommitter.
+  struct GroupWrite {
+    GroupWrite(const FilePath& path,
+               std::string data,
+               OnceCallback<void(bool success)> after_write_callback);
+    GroupWrite(GroupWrite&&);
+    GroupWrite& operator=(GroupWrite&&);
+    ~GroupWrite();
+
+    FilePath path;
+    std::string data;
+    OnceCallback<void(bool success)> after_write_callback;
+  };
+
   const OneShotTimer& timer() const {
     return timer_override_ ? *timer_override_ : timer_;
   }
@@ -160,17 +188,24 @@ class BASE_EXPORT ImportantFileWriter {
 
   // Same as WriteNow() but it uses a promise-like signature that allows running
   // custom logic in the background sequence.
+  // |scheduled| is true for the writes of DoScheduledWrite(), which wait for
+  // the window of |group_committer_|.
   void WriteNowWithBackgroundDataProducer(
-      BackgroundDataProducerCallback background_producer);
+      BackgroundDataProducerCallback background_producer,
+      bool scheduled = false);
 
   // Helper function to call WriteFileAtomically() with a promise-like callback
-  // producing a std::string.
+  // producing a std::string. If |group_committer| is not null, the data is
+  // added to its pending writes instead, which are committed right away unless
+  // |scheduled|.
   static void ProduceAndWriteStringToFileAtomically(
       const FilePath& path,
       BackgroundDataProducerCallback data_producer_for_background_sequence,
       OnceClosure before_write_callback,
       OnceCallback<void(bool success)> after_write_callback,
-      const std::string& histogram_suffix);
+      const std::string& histogram_suffix,
+      scoped_refptr<ImportantFileGroupCommitter> group_committer,
+      bool scheduled);
 
   // Writes |data| to |path|, recording histograms with an optional
   // |histogram_suffix|. |from_instance| indicates whether the call originates
@@ -182,6 +217,11 @@ class BASE_EXPORT ImportantFileWriter {
                                       StringPiece histogram_suffix,
                                       bool from_instance);
 
+  // Writes each of |writes| like WriteFileAtomicallyImpl(), but flushes the
+  // temporary files together before replacing the target files, and then runs
+  // the |after_write_callback| of each write.
+  static void WriteFilesAtomicallyImpl(std::vector<GroupWrite> writes);
+
   void ClearPendingWrite();
 
   // Invoked synchronously on the next write event.
@@ -194,6 +234,9 @@ class BASE_EXPORT ImportantFileWriter {
   // TaskRunner for the thread on which file I/O can be done.
   const scoped_refptr<SequencedTaskRunner> task_runner_;
 
+  // Commits the writes of this writer with others, if not null.
+  const scoped_refptr<ImportantFileGroupCommitter> group_committer_;
+
   // Timer used to schedule commit after ScheduleWrite.
   OneShotTimer timer_;
 
@@ -0,0 +1,287 @@
+// Copyright 2022 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "base/files/io_uring_linux.h"
+
+#include <errno.h>
+#include <linux/io_uring.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+
+#include <algorithm>
+
+#include "base/check_op.h"
+#include "base/logging.h"
+#include "base/memory/ptr_util.h"
+#include "base/numerics/safe_conversions.h"
+#include "base/posix/eintr_wrapper.h"
+
+namespace base {
+
+namespace {
+
+#if defined(__NR_io_uring_setup)
+
+int IoUringSetup(uint32_t num_entries, io_uring_params* params) {
+  return static_cast<int>(syscall(__NR_io_uring_setup, num_entries, params));
+}
+
+int IoUringEnter(int ring_fd,
+                 uint32_t to_submit,
+                 uint32_t min_complete,
+                 uint32_t flags) {
+  return static_cast<int>(syscall(__NR_io_uring_enter, ring_fd, to_submit,
+                                  min_complete, flags, nullptr, 0));
+}
+
+int IoUringRegister(int ring_fd,
+                    uint32_t opcode,
+                    const void* arg,
+                    uint32_t num_args) {
+  return static_cast<int>(
+      syscall(__NR_io_uring_register, ring_fd, opcode, arg, num_args));
+}
+
+#else
+
+// The C library predates io_uring.
+int IoUringSetup(uint32_t num_entries, io_uring_params* params) {
+  errno = ENOSYS;
+  return -1;
+}
+
+int IoUringEnter(int ring_fd,
+                 uint32_t to_submit,
+                 uint32_t min_complete,
+                 uint32_t flags) {
+  errno = ENOSYS;
+  return -1;
+}
+
+int IoUringRegister(int ring_fd,
+                    uint32_t opcode,
+                    const void* arg,
+                    uint32_t num_args) {
+  errno = ENOSYS;
+  return -1;
+}
+
+#endif  // defined(__NR_io_uring_setup)
+
+// The rings are shared with the kernel, which reads what the process writes
+// (and vice versa) with acquire/release semantics.
+uint32_t LoadAcquire(const uint32_t* address) {
+  return __atomic_load_n(address, __ATOMIC_ACQUIRE);
+}
+
+void StoreRelease(uint32_t* address, uint32_t value) {
+  __atomic_store_n(address, value, __ATOMIC_RELEASE);
+}
+
+template <typename T>
+T* AtOffset(void* mapping, uint32_t offset) {
+  return reinterpret_cast<T*>(static_cast<char*>(mapping) + offset);
+}
+
+}  // namespace
+
+// static
+std::unique_ptr<IoUring> IoUring::Create(uint32_t num_entries) {
+  auto ring = WrapUnique(new IoUring());
+  if (!ring->Init(num_entries))
+    return nullptr;
+  return ring;
+}
+
+IoUring::IoUring() = default;
+
+IoUring::~IoUring() {
+  if (sqes_)
+    munmap(sqes_, sqes_size_);
+  if (rings_)
+    munmap(rings_, rings_size_);
+}
+
+bool IoUring::Init(uint32_t num_entries) {
+  io_uring_params params{};
+  ring_fd_.reset(IoUringSetup(num_entries, &params));
+  if (!ring_fd_.is_valid()) {
+    DPLOG_IF(ERROR, errno != ENOSYS && errno != EPERM) << "io_uring_setup";
+    return false;
+  }
+  // IORING_OP_READ and IORING_OP_WRITE were added in Linux 5.6, like
+  // IORING_FEAT_RW_CUR_POS. Without IORING_FEAT_NODROP, completions can be
+  // lost when the completion queue overflows.
+  constexpr uint32_t kRequiredFeatures =
+      IORING_FEAT_SINGLE_MMAP | IORING_FEAT_NODROP | IORING_FEAT_RW_CUR_POS;
+  if ((params.features & kRequiredFeatures) != kRequiredFeatures)
+    return false;
+
+  // With IORING_FEAT_SINGLE_MMAP, both rings share a mapping.
+  rings_size_ = std::max(
+      params.sq_off.array + params.sq_entries * sizeof(uint32_t),
+      params.cq_off.cqes + params.cq_entries * sizeof(io_uring_cqe));
+  void* rings =
+      mmap(nullptr, rings_size_, PROT_READ | PROT_WRITE,
+           MAP_SHARED | MAP_POPULATE, ring_fd_.get(), IORING_OFF_SQ_RING);
+  if (rings == MAP_FAILED) {
+    DPLOG(ERROR) << "mmap";
+    return false;
+  }
+  rings_ = rings;
+
+  sqes_size_ = params.sq_entries * sizeof(io_uring_sqe);
+  void* sqes = mmap(nullptr, sqes_size_, PROT_READ | PROT_WRITE,
+                    MAP_SHARED | MAP_POPULATE, ring_fd_.get(), IORING_OFF_SQES);
+  if (sqes == MAP_FAILED) {
+    DPLOG(ERROR) << "mmap";
+    return false;
+  }
+  sqes_ = static_cast<io_uring_sqe*>(sqes);
+
+  sq_head_ = AtOffset<uint32_t>(rings_, params.sq_off.head);
+  sq_tail_ = AtOffset<uint32_t>(rings_, params.sq_off.tail);
+  sq_mask_ = *AtOffset<uint32_t>(rings_, params.sq_off.ring_mask);
+  sq_entries_ = *AtOffset<uint32_t>(rings_, params.sq_off.ring_entries);
+  cq_head_ = AtOffset<uint32_t>(rings_, params.cq_off.head);
+  cq_tail_ = AtOffset<uint32_t>(rings_, params.cq_off.tail);
+  cq_mask_ = *AtOffset<uint32_t>(rings_, params.cq_off.ring_mask);
+  cqes_ = AtOffset<io_uring_cqe>(rings_, params.cq_off.cqes);
+
+  // Submission queue slots map to entries of the same index.
+  uint32_t* sq_array = AtOffset<uint32_t>(rings_, params.sq_off.array);
+  for (uint32_t i = 0; i < sq_entries_; ++i)
+    sq_array[i] = i;
+  prepared_tail_ = *sq_tail_;
+  return true;
+}
+
+bool IoUring::RegisterBuffers(span<const iovec> buffers) {
+  int rv =
+      IoUringRegister(ring_fd_.get(), IORING_REGISTER_BUFFERS, buffers.data(),
+                      checked_cast<uint32_t>(buffers.size()));
+  DPLOG_IF(ERROR, rv < 0 && errno != ENOMEM) << "IORING_REGISTER_BUFFERS";
+  return rv == 0;
+}
+
+bool IoUring::RegisterEventFd(int event_fd) {
+  int rv =
+      IoUringRegister(ring_fd_.get(), IORING_REGISTER_EVENTFD, &event_fd, 1);
+  DPLOG_IF(ERROR, rv < 0) << "IORING_REGISTER_EVENTFD";
+  return rv == 0;
+}
+
+bool IoUring::PrepareRead(int fd,
+                          void* buffer,
+                          uint32_t size,
+                          uint64_t offset,
+                          uint64_t user_data) {
+  return PrepareReadWrite(IORING_OP_READ, fd, buffer, size, offset, 0,
+                          user_data);
+}
+
+bool IoUring::PrepareWrite(int fd,
+                           const void* buffer,
+                           uint32_t size,
+                           uint64_t offset,
+                           uint64_t user_data) {
+  return PrepareReadWrite(IORING_OP_WRITE, fd, buffer, size, offset, 0,
+                          user_data);
+}
+
+bool IoUring::PrepareReadFixed(int fd,
+                               void* buffer,
+                               uint32_t size,
+                               uint64_t offset,
+                               uint16_t buffer_index,
+                               uint64_t user_data) {
+  return PrepareReadWrite(IORING_OP_READ_FIXED, fd, buffer, size, offset,
+                          buffer_index, user_data);
+}
+
+bool IoUring::PrepareWriteFixed(int fd,
+                                const void* buffer,
+                                uint32_t size,
+                                uint64_t offset,
+                                uint16_t buffer_index,
+                                uint64_t user_data) {
+  return PrepareReadWrite(IORING_OP_WRITE_FIXED, fd, buffer, size, offset,
+                          buffer_index, user_data);
+}
+
+bool IoUring::Submit() {
+  // Publish the prepared entries.
+  num_unsubmitted_ += prepared_tail_ - *sq_tail_;
+  StoreRelease(sq_tail_, prepared_tail_);
+  if (!num_unsubmitted_)
+    return true;
+
+  int rv = HANDLE_EINTR(IoUringEnter(ring_fd_.get(), num_unsubmitted_, 0, 0));
+  if (rv < 0) {
+    // EAGAIN and EBUSY mean that the kernel is out of resources until some
+    // completions are reaped.
+    DPLOG_IF(ERROR, errno != EAGAIN && errno != EBUSY) << "io_uring_enter";
+    return false;
+  }
+  DCHECK_LE(static_cast<uint32_t>(rv), num_unsubmitted_);
+  num_unsubmitted_ -= static_cast<uint32_t>(rv);
+  return true;
+}
+
+bool IoUring::WaitForCompletion() {
+  int rv = HANDLE_EINTR(IoUringEnter(ring_fd_.get(), num_unsubmitted_, 1,
+                                     IORING_ENTER_GETEVENTS));
+  if (rv < 0) {
+    DPLOG(ERROR) << "io_uring_enter";
+    return false;
+  }
+  DCHECK_LE(static_cast<uint32_t>(rv), num_unsubmitted_);
+  num_unsubmitted_ -= static_cast<uint32_t>(rv);
+  return true;
+}
+
+bool IoUring::PopCompletion(uint64_t* user_data, int32_t* result) {
+  // Only this process advances the head.
+  const uint32_t head = *cq_head_;
+  if (head == LoadAcquire(cq_tail_))
+    return false;
+  const io_uring_cqe& cqe = cqes_[head & cq_mask_];
+  *user_data = cqe.user_data;
+  *result = cqe.res;
+  StoreRelease(cq_head_, head + 1);
+  return true;
+}
+
+io_uring_sqe* IoUring::GetSubmissionEntry() {
+  if (prepared_tail_ - LoadAcquire(sq_head_) >= sq_entries_)
+    return nullptr;
+  io_uring_sqe* sqe = &sqes_[prepared_tail_ & sq_mask_];
+  memset(sqe, 0, sizeof(*sqe));
+  ++prepared_tail_;
+  return sqe;
+}
+
+bool IoUring::PrepareReadWrite(uint8_t opcode,
+                               int fd,
+                               const void* buffer,
+                               uint32_t size,
+                               uint64_t offset,
+                               uint16_t buffer_index,
+                               uint64_t user_data) {
+  io_uring_sqe* sqe = GetSubmissionEntry();
+  if (!sqe)
+    return false;
+  sqe->opcode = opcode;
+  sqe->fd = fd;
+  sqe->addr = reinterpret_cast<uintptr_t>(buffer);
+  sqe->len = size;
+  sqe->off = offset;
+  sqe->buf_index = buffer_index;
+  sqe->user_data = user_data;
+  return true;
+}
+
+}  // namespace base
@@ -0,0 +1,141 @@
+// Copyright 2022 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#ifndef BASE_FILES_IO_URING_LINUX_H_
+#define BASE_FILES_IO_URING_LINUX_H_
+
+#include <stddef.h>
+#include <stdint.h>
+#include <sys/uio.h>
+
+#include <memory>
+
+#include "base/base_export.h"
+#include "base/containers/span.h"
+#include "base/files/scoped_file.h"
+
+struct io_uring_sqe;
+struct io_uring_cqe;
+
+namespace base {
+
+// A thin wrapper around a Linux io_uring: a submission queue of operations and
+// a completion queue of their results, both shared with the kernel. This class
+// isn't thread-safe. Operations are prepared, then submitted as a batch with a
+// single system call. See AsyncFileIO for a higher-level API.
+class BASE_EXPORT IoUring {
+ public:
+  // Returns null if io_uring isn't available, e.g. because the kernel is older
+  // than 5.6 or because a sandbox forbids it. |num_entries| is rounded up to a
+  // power of two by the kernel.
+  static std::unique_ptr<IoUring> Create(uint32_t num_entries);
+
+  IoUring(const IoUring&) = delete;
+  IoUring& operator=(const IoUring&) = delete;
+  ~IoUring();
+
+  // Returns the size of the submission queue.
+  uint32_t num_entries() const { return sq_entries_; }
+
+  // Registers |buffers| for PrepareReadFixed() and PrepareWriteFixed(), which
+  // don't need to map their pages for each operation. Returns false on
+  // failure, e.g. if the buffers exceed RLIMIT_MEMLOCK.
+  bool RegisterBuffers(span<const iovec> buffers);
+
+  // Makes the kernel signal |event_fd|, an eventfd, when it posts completions.
+  bool RegisterEventFd(int event_fd);
+
+  // Prepare an operation for the next Submit(). |user_data| is returned with
+  // its completion. Return false if the submission queue is full.
+  bool PrepareRead(int fd,
+                   void* buffer,
+                   uint32_t size,
+                   uint64_t offset,
+                   uint64_t user_data);
+  bool PrepareWrite(int fd,
+                    const void* buffer,
+                    uint32_t size,
+                    uint64_t offset,
+                    uint64_t user_data);
+
+  // Same as above, for a |buffer| which lies within the registered buffer at
+  // |buffer_index|.
+  bool PrepareReadFixed(int fd,
+                        void* buffer,
+                        uint32_t size,
+                        uint64_t offset,
+                        uint16_t buffer_index,
+                        uint64_t user_data);
+  bool PrepareWriteFixed(int fd,
+                         const void* buffer,
+                         uint32_t size,
+                         uint64_t offset,
+                         uint16_t buffer_index,
+                         uint64_t user_data);
+
+  // Submits the operations prepared since the last call with a single system
+  // call. Returns false on failure, in which case the operations which the
+  // kernel didn't take are submitted by the next call.
+  bool Submit();
+
+  // Blocks until a completion is available, after submitting the operations
+  // which the last Submit() failed to submit. Returns false on failure.
+  bool WaitForCompletion();
+
+  // Pops the oldest completion: the |user_data| of its operation and its
+  // |result|, a number of bytes or a negated errno. Returns false if there is
+  // no completion.
+  bool PopCompletion(uint64_t* user_data, int32_t* result);
+
+ private:
+  IoUring();
+
+  // Risky part of Create(). Returns true on success.
+  bool Init(uint32_t num_entries);
+
+  // Returns the next free submission queue entry, cleared, or null if the
+  // queue is full.
+  io_uring_sqe* GetSubmissionEntry();
+
+  bool PrepareReadWrite(uint8_t opcode,
+                        int fd,
+                        const void* buffer,
+                        uint32_t size,
+                        uint64_t offset,
+                        uint16_t buffer_index,
+                        uint64_t user_data);
+
+  ScopedFD ring_fd_;
+
+  // The mappings of the rings, which share one with IORING_FEAT_SINGLE_MMAP,
+  // and of the submission queue entries. Pointers into them aren't raw_ptr<>
+  // since they aren't allocated by PartitionAlloc.
+  void* rings_ = nullptr;
+  size_t rings_size_ = 0;
+  io_uring_sqe* sqes_ = nullptr;
+  size_t sqes_size_ = 0;
+
+  // The submission queue. The kernel advances |sq_head_|.
+  uint32_t* sq_head_ = nullptr;
+  uint32_t* sq_tail_ = nullptr;
+  uint32_t sq_mask_ = 0;
+  uint32_t sq_entries_ = 0;
+
+  // The completion queue. The kernel advances |cq_tail_|.
+  uint32_t* cq_head_ = nullptr;
+  uint32_t* cq_tail_ = nullptr;
+  uint32_t cq_mask_ = 0;
+  io_uring_cqe* cqes_ = nullptr;
+
+  // The tail of the submission queue including the prepared entries, which
+  // are published to the kernel by Submit().
+  uint32_t prepared_tail_ = 0;
+
+  // The number of published entries which the kernel hasn't taken yet.
+  uint32_t num_unsubmitted_ = 0;
+};
+
+}  // namespace base
+
+#endif  // BASE_FILES_IO_URING_LINUX_H_
@@ -0,0 +1,108 @@
+// Copyright 2022 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "base/files/io_uring_linux.h"
+
+#include <string.h>
+#include <sys/uio.h>
+
+#include <memory>
+#include <string>
+
+#include "base/files/file.h"
+#include "base/files/scoped_temp_dir.h"
+#include "testing/gtest/include/gtest/gtest.h"
+
+namespace base {
+
+namespace {
+
+class IoUringTest : public testing::Test {
+ protected:
+  void SetUp() override {
+    ring_ = IoUring::Create(8);
+    if (!ring_)
+      GTEST_SKIP() << "io_uring isn't available";
+    ASSERT_TRUE(dir_.CreateUniqueTempDir());
+    file_ = File(dir_.GetPath().AppendASCII("test"),
+                 File::FLAG_CREATE | File::FLAG_READ | File::FLAG_WRITE);
+    ASSERT_TRUE(file_.IsValid());
+  }
+
+  // Waits for the next completion and returns its result.
+  int32_t WaitForResult(uint64_t expected_user_data) {
+    uint64_t user_data;
+    int32_t result;
+    while (!ring_->PopCompletion(&user_data, &result))
+      EXPECT_TRUE(ring_->WaitForCompletion());
+    EXPECT_EQ(expected_user_data, user_data);
+    return result;
+  }
+
+  std::unique_ptr<IoUring> ring_;
+  ScopedTempDir dir_;
+  File file_;
+};
+
+}  // namespace
+
+TEST_F(IoUringTest, WriteThenRead) {
+  EXPECT_GE(ring_->num_entries(), 8u);
+  const std::string data = "hello";
+  ASSERT_TRUE(ring_->PrepareWrite(file_.GetPlatformFile(), data.data(),
+                                  data.size(), 0, 1));
+  ASSERT_TRUE(ring_->Submit());
+  EXPECT_EQ(5, WaitForResult(1));
+
+  char buffer[16] = {};
+  ASSERT_TRUE(ring_->PrepareRead(file_.GetPlatformFile(), buffer,
+                                 sizeof(buffer), 1, 2));
+  ASSERT_TRUE(ring_->Submit());
+  EXPECT_EQ(4, WaitForResult(2));
+  EXPECT_EQ("ello", std::string(buffer, 4));
+
+  uint64_t user_data;
+  int32_t result;
+  EXPECT_FALSE(ring_->PopCompletion(&user_data, &result));
+}
+
+TEST_F(IoUringTest, FixedBuffers) {
+  char buffers[2][16] = {};
+  const iovec iovecs[] = {{buffers[0], sizeof(buffers[0])},
+                          {buffers[1], sizeof(buffers[1])}};
+  if (!ring_->RegisterBuffers(iovecs))
+    GTEST_SKIP() << "Can't register buffers";
+
+  memcpy(buffers[1], "world", 5);
+  ASSERT_TRUE(ring_->PrepareWriteFixed(file_.GetPlatformFile(), buffers[1], 5,
+                                       0, 1, 3));
+  ASSERT_TRUE(ring_->Submit());
+  EXPECT_EQ(5, WaitForResult(3));
+
+  ASSERT_TRUE(ring_->PrepareReadFixed(file_.GetPlatformFile(), buffers[0],
+                                      sizeof(buffers[0]), 0, 0, 4));
+  ASSERT_TRUE(ring_->Submit());
+  EXPECT_EQ(5, WaitForResult(4));
+  EXPECT_EQ("world", std::string(buffers[0], 5));
+}
+
+TEST_F(IoUringTest, SubmissionQueueFull) {
+  char buffer[1];
+  uint32_t num_prepared = 0;
+  while (ring_->PrepareRead(file_.GetPlatformFile(), buffer, sizeof(buffer), 0,
+                            num_prepared)) {
+    ++num_prepared;
+  }
+  EXPECT_EQ(ring_->num_entries(), num_prepared);
+  ASSERT_TRUE(ring_->Submit());
+  for (uint32_t i = 0; i < num_prepared; ++i) {
+    uint64_t user_data;
+    int32_t result;
+    while (!ring_->PopCompletion(&user_data, &result))
+      ASSERT_TRUE(ring_->WaitForCompletion());
+    EXPECT_EQ(0, result);
+  }
+}
+
+}  // namespace base
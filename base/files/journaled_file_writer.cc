@@ -0,0 +1,373 @@
+// Copyright 2022 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "base/files/journaled_file_writer.h"
+
+#include <string.h>
+
+#include <algorithm>
+#include <utility>
+
+#include "base/bind.h"
+#include "base/check.h"
+#include "base/files/file.h"
+#include "base/files/file_util.h"
+#include "base/files/important_file_writer.h"
+#include "base/logging.h"
+#include "base/metrics/crc32.h"
+#include "base/numerics/safe_conversions.h"
+#include "base/strings/string_piece.h"
+#include "base/task/sequenced_task_runner.h"
+
+namespace base {
+
+namespace {
+
+constexpr uint32_t kSnapshotMagic = 0x504E534A;  // "JSNP"
+constexpr uint32_t kJournalMagic = 0x4C4E524A;   // "JRNL"
+
+// The snapshot file is this header followed by the data.
+struct SnapshotHeader {
+  uint32_t magic;
+  uint32_t data_crc;
+  // Incremented by each compaction.
+  uint64_t generation;
+  uint64_t data_size;
+};
+
+// The journal file is this header followed by the records.
+struct JournalHeader {
+  uint32_t magic;
+  uint32_t padding;
+  // The generation of the snapshot which the records apply to.
+  uint64_t generation;
+};
+
+// Each record is this header followed by the data of a Pickle.
+struct RecordHeader {
+  uint32_t size;
+  // Covers |size| too, so that zeroes left by a crash are not a record.
+  uint32_t crc;
+};
+
+uint32_t GetRecordCrc(uint32_t size, const void* data) {
+  return Crc32C(Crc32C(0, &size, sizeof(size)), data, size);
+}
+
+// Returns the valid prefix of the |journal| of the snapshot of |generation|,
+// and adds its records to |records| if not null. Returns 0 if the journal is
+// not of |generation|.
+size_t ParseJournal(StringPiece journal,
+                    uint64_t generation,
+                    std::vector<Pickle>* records) {
+  JournalHeader journal_header;
+  if (journal.size() < sizeof(journal_header))
+    return 0;
+  memcpy(&journal_header, journal.data(), sizeof(journal_header));
+  if (journal_header.magic != kJournalMagic ||
+      journal_header.generation != generation) {
+    return 0;
+  }
+
+  size_t offset = sizeof(journal_header);
+  while (journal.size() - offset >= sizeof(RecordHeader)) {
+    RecordHeader record_header;
+    memcpy(&record_header, journal.data() + offset, sizeof(record_header));
+    const char* const data = journal.data() + offset + sizeof(record_header);
+    if (journal.size() - offset - sizeof(record_header) < record_header.size ||
+        GetRecordCrc(record_header.size, data) != record_header.crc) {
+      break;
+    }
+    if (records) {
+      Pickle record(data, record_header.size);
+      if (!record.data())
+        break;
+      records->push_back(record);
+    }
+    offset += sizeof(record_header) + record_header.size;
+  }
+  return offset;
+}
+
+}  // namespace
+
+// Owns the journal on the task runner of the writer.
+class JournaledFileWriter::Backend {
+ public:
+  explicit Backend(const FilePath& path)
+      : path_(path), journal_path_(GetJournalPath(path)) {}
+  Backend(const Backend&) = delete;
+  Backend& operator=(const Backend&) = delete;
+  ~Backend() = default;
+
+  // Opens the journal, and drops its torn or stale records. Returns the sizes
+  // of the snapshot and of the journal.
+  std::pair<int64_t, int64_t> Open() {
+    int64_t snapshot_size = 0;
+    File snapshot(path_, File::FLAG_OPEN | File::FLAG_READ);
+    SnapshotHeader snapshot_header;
+    if (snapshot.IsValid() &&
+        snapshot.ReadAtCurrentPos(reinterpret_cast<char*>(&snapshot_header),
+                                  sizeof(snapshot_header)) ==
+            static_cast<int>(sizeof(snapshot_header)) &&
+        snapshot_header.magic == kSnapshotMagic) {
+      generation_ = snapshot_header.generation;
+      snapshot_size = saturated_cast<int64_t>(snapshot_header.data_size);
+    }
+
+    std::string journal;
+    size_t journal_length = 0;
+    if (ReadFileToString(journal_path_, &journal))
+      journal_length = ParseJournal(journal, generation_, nullptr);
+    if (!journal_length) {
+      ResetJournal();
+      return {snapshot_size, 0};
+    }
+
+    journal_ = File(journal_path_, File::FLAG_OPEN | File::FLAG_WRITE);
+    if (!journal_.IsValid() || !journal_.SetLength(journal_length)) {
+      ResetJournal();
+      return {snapshot_size, 0};
+    }
+    journal_length_ = journal_length;
+    return {snapshot_size, journal_length_};
+  }
+
+  // Appends |records| to the journal and flushes it. On failure, the journal
+  // is left as it was if possible.
+  bool AppendRecords(const std::string& records) {
+    if (!journal_.IsValid())
+      return false;
+    const int size = checked_cast<int>(records.size());
+    if (journal_.Write(journal_length_, records.data(), size) != size) {
+      DPLOG(WARNING) << "Failed to append to " << journal_path_;
+      if (!journal_.SetLength(journal_length_))
+        journal_.Close();
+      return false;
+    }
+    if (!journal_.Flush()) {
+      DPLOG(WARNING) << "Failed to flush " << journal_path_;
+      journal_.Close();
+      return false;
+    }
+    journal_length_ += size;
+    return true;
+  }
+
+  // Replaces the snapshot with |data| and starts a new journal.
+  bool WriteSnapshot(const std::string& data) {
+    SnapshotHeader snapshot_header;
+    snapshot_header.magic = kSnapshotMagic;
+    snapshot_header.data_crc = Crc32C(0, data.data(), data.size());
+    snapshot_header.generation = generation_ + 1;
+    snapshot_header.data_size = data.size();
+
+    std::string snapshot;
+    snapshot.reserve(sizeof(snapshot_header) + data.size());
+    snapshot.append(reinterpret_cast<const char*>(&snapshot_header),
+                    sizeof(snapshot_header));
+    snapshot.append(data);
+    if (!ImportantFileWriter::WriteFileAtomically(path_, snapshot))
+      return false;
+
+    // The records of the previous journal are in the snapshot, and are ignored
+    // by Load() from now on even if the journal can't be reset.
+    ++generation_;
+    ResetJournal();
+    return true;
+  }
+
+ private:
+  // Replaces the journal with an empty one for |generation_|. Like the
+  // snapshot, it is replaced by a rename, which journaling file systems such
+  // as ext4 commit after that of the snapshot, so that the records of the
+  // previous journal are not dropped before the snapshot holding them.
+  void ResetJournal() {
+    journal_.Close();
+    journal_length_ = 0;
+    JournalHeader journal_header;
+    journal_header.magic = kJournalMagic;
+    journal_header.padding = 0;
+    journal_header.generation = generation_;
+    if (!ImportantFileWriter::WriteFileAtomically(
+            journal_path_,
+            StringPiece(reinterpret_cast<const char*>(&journal_header),
+                        sizeof(journal_header)))) {
+      return;
+    }
+    journal_ = File(journal_path_, File::FLAG_OPEN | File::FLAG_WRITE);
+    if (journal_.IsValid())
+      journal_length_ = sizeof(journal_header);
+  }
+
+  const FilePath path_;
+  const FilePath journal_path_;
+  uint64_t generation_ = 0;
+  File journal_;
+  int64_t journal_length_ = 0;
+};
+
+// static
+bool JournaledFileWriter::Load(const FilePath& path,
+                               std::string* snapshot,
+                               std::vector<Pickle>* records) {
+  snapshot->clear();
+  records->clear();
+
+  uint64_t generation = 0;
+  if (PathExists(path)) {
+    SnapshotHeader snapshot_header;
+    if (!ReadFileToString(path, snapshot) ||
+        snapshot->size() < sizeof(snapshot_header)) {
+      snapshot->clear();
+      return false;
+    }
+    memcpy(&snapshot_header, snapshot->data(), sizeof(snapshot_header));
+    snapshot->erase(0, sizeof(snapshot_header));
+    if (snapshot_header.magic != kSnapshotMagic ||
+        snapshot_header.data_size != snapshot->size() ||
+        snapshot_header.data_crc !=
+            Crc32C(0, snapshot->data(), snapshot->size())) {
+      snapshot->clear();
+      return false;
+    }
+    generation = snapshot_header.generation;
+  }
+
+  std::string journal;
+  if (ReadFileToString(GetJournalPath(path), &journal))
+    ParseJournal(journal, generation, records);
+  return true;
+}
+
+// static
+FilePath JournaledFileWriter::GetJournalPath(const FilePath& path) {
+  return path.AddExtension(FILE_PATH_LITERAL("journal"));
+}
+
+JournaledFileWriter::JournaledFileWriter(
+    const FilePath& path,
+    scoped_refptr<SequencedTaskRunner> task_runner,
+    SnapshotSerializer* serializer,
+    TimeDelta commit_interval)
+    : path_(path),
+      serializer_(serializer),
+      commit_interval_(commit_interval),
+      backend_(std::move(task_runner), path) {
+  DCHECK(serializer_);
+  backend_.AsyncCall(&Backend::Open)
+      .Then(BindOnce(
+          [](WeakPtr<JournaledFileWriter> writer,
+             std::pair<int64_t, int64_t> sizes) {
+            if (writer)
+              writer->OnOpened(sizes.first, sizes.second);
+          },
+          weak_factory_.GetWeakPtr()));
+}
+
+JournaledFileWriter::~JournaledFileWriter() {
+  DCHECK_CALLED_ON_VALID_SEQUENCE(sequence_checker_);
+  DCHECK(!HasPendingWrite());
+}
+
+bool JournaledFileWriter::HasPendingWrite() const {
+  DCHECK_CALLED_ON_VALID_SEQUENCE(sequence_checker_);
+  return timer().IsRunning();
+}
+
+void JournaledFileWriter::AppendRecord(const Pickle& record) {
+  DCHECK_CALLED_ON_VALID_SEQUENCE(sequence_checker_);
+  RecordHeader record_header;
+  record_header.size = checked_cast<uint32_t>(record.size());
+  record_header.crc = GetRecordCrc(record_header.size, record.data());
+  pending_records_.append(reinterpret_cast<const char*>(&record_header),
+                          sizeof(record_header));
+  pending_records_.append(static_cast<const char*>(record.data()),
+                          record.size());
+  StartTimer();
+}
+
+void JournaledFileWriter::CommitPendingRecords() {
+  DCHECK_CALLED_ON_VALID_SEQUENCE(sequence_checker_);
+  timer().Stop();
+  const int64_t journal_size =
+      journal_size_ + static_cast<int64_t>(pending_records_.size());
+  if ((needs_compaction_ ||
+       journal_size >= std::max(kMinCompactionSize, snapshot_size_)) &&
+      Compact()) {
+    return;
+  }
+  if (pending_records_.empty())
+    return;
+
+  journal_size_ = journal_size;
+  backend_.AsyncCall(&Backend::AppendRecords)
+      .WithArgs(std::move(pending_records_))
+      .Then(BindOnce(&JournaledFileWriter::OnRecordsAppended,
+                     weak_factory_.GetWeakPtr()));
+  pending_records_.clear();
+}
+
+bool JournaledFileWriter::Compact() {
+  DCHECK_CALLED_ON_VALID_SEQUENCE(sequence_checker_);
+  std::string snapshot;
+  if (!serializer_->SerializeSnapshot(&snapshot)) {
+    DLOG(WARNING) << "Failed to serialize data to be saved in " << path_;
+    return false;
+  }
+
+  timer().Stop();
+  pending_records_.clear();
+  needs_compaction_ = false;
+  compacted_ = true;
+  snapshot_size_ = static_cast<int64_t>(snapshot.size());
+  journal_size_ = 0;
+  backend_.AsyncCall(&Backend::WriteSnapshot)
+      .WithArgs(std::move(snapshot))
+      .Then(BindOnce(&JournaledFileWriter::OnSnapshotWritten,
+                     weak_factory_.GetWeakPtr()));
+  return true;
+}
+
+void JournaledFileWriter::SetTimerForTesting(OneShotTimer* timer_override) {
+  timer_override_ = timer_override;
+}
+
+void JournaledFileWriter::StartTimer() {
+  if (!timer().IsRunning()) {
+    timer().Start(FROM_HERE, commit_interval_,
+                  BindOnce(&JournaledFileWriter::CommitPendingRecords,
+                           Unretained(this)));
+  }
+}
+
+void JournaledFileWriter::OnOpened(int64_t snapshot_size,
+                                   int64_t journal_size) {
+  DCHECK_CALLED_ON_VALID_SEQUENCE(sequence_checker_);
+  // A compaction already replaced the files which were opened.
+  if (compacted_)
+    return;
+  snapshot_size_ = snapshot_size;
+  // The records committed in the meantime are appended after |journal_size|.
+  journal_size_ += journal_size;
+}
+
+void JournaledFileWriter::OnRecordsAppended(bool success) {
+  DCHECK_CALLED_ON_VALID_SEQUENCE(sequence_checker_);
+  // The records which failed to be appended are in the next snapshot.
+  if (!success && !Compact()) {
+    needs_compaction_ = true;
+    StartTimer();
+  }
+}
+
+void JournaledFileWriter::OnSnapshotWritten(bool success) {
+  DCHECK_CALLED_ON_VALID_SEQUENCE(sequence_checker_);
+  if (!success) {
+    needs_compaction_ = true;
+    StartTimer();
+  }
+}
+
+}  // namespace base
@@ -0,0 +1,147 @@
+// Copyright 2022 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#ifndef BASE_FILES_JOURNALED_FILE_WRITER_H_
+#define BASE_FILES_JOURNALED_FILE_WRITER_H_
+
+#include <stdint.h>
+
+#include <string>
+#include <vector>
+
+#include "base/base_export.h"
+#include "base/files/file_path.h"
+#include "base/memory/raw_ptr.h"
+#include "base/memory/weak_ptr.h"
+#include "base/pickle.h"
+#include "base/sequence_checker.h"
+#include "base/threading/sequence_bound.h"
+#include "base/time/time.h"
+#include "base/timer/timer.h"
+
+namespace base {
+
+class SequencedTaskRunner;
+
+// Alternative to ImportantFileWriter for large files which change a little at
+// a time. Rather than rewriting the whole file for each change, the changes
+// are appended as checksummed Pickle records to a journal next to the file,
+// which holds a snapshot of the whole state. Once the journal grows as large
+// as the snapshot, the state is compacted into a new snapshot, written with
+// ImportantFileWriter::WriteFileAtomically(), and the journal starts over. The
+// disk writes thus track the size of the changes rather than the size of the
+// file.
+//
+// The records appended within the commit interval are written and flushed
+// together. After a crash, Load() returns the last snapshot and the records
+// flushed to the journal since, up to the first torn or corrupted one.
+//
+// All the methods, the constructor and the destructor must be called on the
+// same sequence. File I/O happens on |task_runner|.
+class BASE_EXPORT JournaledFileWriter {
+ public:
+  // Provides the whole state to compact the journal into.
+  class BASE_EXPORT SnapshotSerializer {
+   public:
+    // Should put the serialized state in |data|, including the changes of all
+    // the records appended so far, and return true on success. Called on the
+    // sequence of the JournaledFileWriter.
+    virtual bool SerializeSnapshot(std::string* data) = 0;
+
+   protected:
+    virtual ~SnapshotSerializer() = default;
+  };
+
+  static constexpr TimeDelta kDefaultCommitInterval = Seconds(10);
+
+  // Journals smaller than this are not compacted, whatever the size of the
+  // snapshot.
+  static constexpr int64_t kMinCompactionSize = 1024 * 1024;
+
+  // Reads the snapshot at |path| into |snapshot|, and the records journaled
+  // since into |records|, in order. Returns false if the snapshot is
+  // corrupted. Both are empty, and true is returned, if nothing was written
+  // yet. Blocks.
+  static bool Load(const FilePath& path,
+                   std::string* snapshot,
+                   std::vector<Pickle>* records);
+
+  // Returns the path of the journal of the snapshot at |path|.
+  static FilePath GetJournalPath(const FilePath& path);
+
+  // |serializer| must outlive the writer.
+  JournaledFileWriter(const FilePath& path,
+                      scoped_refptr<SequencedTaskRunner> task_runner,
+                      SnapshotSerializer* serializer,
+                      TimeDelta commit_interval = kDefaultCommitInterval);
+  JournaledFileWriter(const JournaledFileWriter&) = delete;
+  JournaledFileWriter& operator=(const JournaledFileWriter&) = delete;
+
+  // There must not be a pending write at the moment of destruction.
+  ~JournaledFileWriter();
+
+  const FilePath& path() const { return path_; }
+
+  // Returns true if there are records or a compaction waiting for the commit
+  // interval.
+  bool HasPendingWrite() const;
+
+  // Appends |record| to the journal after the commit interval, with the other
+  // records appended in the meantime. Does not block.
+  void AppendRecord(const Pickle& record);
+
+  // Writes the pending records now, or a new snapshot if the journal is large
+  // enough. Does not block.
+  void CommitPendingRecords();
+
+  // Writes a new snapshot now, which replaces the pending records and the
+  // journal. Returns false if |serializer| failed, in which case the pending
+  // records are kept. Does not block.
+  bool Compact();
+
+  // Overrides the timer to use for committing the records with
+  // |timer_override|.
+  void SetTimerForTesting(OneShotTimer* timer_override);
+
+ private:
+  class Backend;
+
+  OneShotTimer& timer() { return timer_override_ ? *timer_override_ : timer_; }
+  const OneShotTimer& timer() const {
+    return timer_override_ ? *timer_override_ : timer_;
+  }
+
+  void StartTimer();
+  void OnOpened(int64_t snapshot_size, int64_t journal_size);
+  void OnRecordsAppended(bool success);
+  void OnSnapshotWritten(bool success);
+
+  const FilePath path_;
+  const raw_ptr<SnapshotSerializer> serializer_;
+  const TimeDelta commit_interval_;
+
+  // The records to append, each one after its header.
+  std::string pending_records_;
+  // Whether the last compaction failed and must be retried.
+  bool needs_compaction_ = false;
+  // Whether a compaction was posted.
+  bool compacted_ = false;
+
+  // The sizes of the last snapshot and of the records journaled since.
+  int64_t snapshot_size_ = 0;
+  int64_t journal_size_ = 0;
+
+  OneShotTimer timer_;
+  raw_ptr<OneShotTimer> timer_override_ = nullptr;
+
+  SequenceBound<Backend> backend_;
+
+  SEQUENCE_CHECKER(sequence_checker_);
+
+  WeakPtrFactory<JournaledFileWriter> weak_factory_{this};
+};
+
+}  // namespace base
+
+#endif  // BASE_FILES_JOURNALED_FILE_WRITER_H_
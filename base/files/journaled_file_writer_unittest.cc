@@ -0,0 +1,203 @@
+// Copyright 2022 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "base/files/journaled_file_writer.h"
+
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "base/files/file_path.h"
+#include "base/files/file_util.h"
+#include "base/files/scoped_temp_dir.h"
+#include "base/pickle.h"
+#include "base/test/task_environment.h"
+#include "base/threading/thread_task_runner_handle.h"
+#include "base/time/time.h"
+#include "testing/gtest/include/gtest/gtest.h"
+
+namespace base {
+
+namespace {
+
+constexpr TimeDelta kCommitInterval = Seconds(1);
+
+class SnapshotSerializer : public JournaledFileWriter::SnapshotSerializer {
+ public:
+  bool SerializeSnapshot(std::string* data) override {
+    *data = snapshot_;
+    return succeeds_;
+  }
+
+  void set_snapshot(const std::string& snapshot) { snapshot_ = snapshot; }
+  void set_succeeds(bool succeeds) { succeeds_ = succeeds; }
+
+ private:
+  std::string snapshot_;
+  bool succeeds_ = true;
+};
+
+Pickle MakeRecord(const std::string& value) {
+  Pickle record;
+  record.WriteString(value);
+  return record;
+}
+
+// Returns the string of each record loaded from |path|.
+std::vector<std::string> LoadRecords(const FilePath& path,
+                                     std::string* snapshot) {
+  std::vector<Pickle> records;
+  EXPECT_TRUE(JournaledFileWriter::Load(path, snapshot, &records));
+  std::vector<std::string> values;
+  for (const Pickle& record : records) {
+    PickleIterator iterator(record);
+    std::string value;
+    EXPECT_TRUE(iterator.ReadString(&value));
+    values.push_back(value);
+  }
+  return values;
+}
+
+class JournaledFileWriterTest : public testing::Test {
+ public:
+  void SetUp() override {
+    ASSERT_TRUE(temp_dir_.CreateUniqueTempDir());
+    path_ = temp_dir_.GetPath().AppendASCII("state");
+  }
+
+ protected:
+  std::unique_ptr<JournaledFileWriter> CreateWriter() {
+    return std::make_unique<JournaledFileWriter>(
+        path_, ThreadTaskRunnerHandle::Get(), &serializer_, kCommitInterval);
+  }
+
+  test::TaskEnvironment task_environment_{
+      test::TaskEnvironment::TimeSource::MOCK_TIME};
+  ScopedTempDir temp_dir_;
+  FilePath path_;
+  SnapshotSerializer serializer_;
+};
+
+}  // namespace
+
+TEST_F(JournaledFileWriterTest, LoadNothing) {
+  std::string snapshot;
+  EXPECT_TRUE(LoadRecords(path_, &snapshot).empty());
+  EXPECT_TRUE(snapshot.empty());
+}
+
+TEST_F(JournaledFileWriterTest, AppendRecords) {
+  auto writer = CreateWriter();
+  writer->AppendRecord(MakeRecord("foo"));
+  writer->AppendRecord(MakeRecord("bar"));
+  EXPECT_TRUE(writer->HasPendingWrite());
+  task_environment_.RunUntilIdle();
+  std::string snapshot;
+  EXPECT_TRUE(LoadRecords(path_, &snapshot).empty());
+
+  task_environment_.FastForwardBy(kCommitInterval);
+  EXPECT_FALSE(writer->HasPendingWrite());
+  EXPECT_EQ(std::vector<std::string>({"foo", "bar"}),
+            LoadRecords(path_, &snapshot));
+  EXPECT_TRUE(snapshot.empty());
+
+  // A new writer appends after the records of the previous one.
+  writer = CreateWriter();
+  writer->AppendRecord(MakeRecord("baz"));
+  writer->CommitPendingRecords();
+  task_environment_.RunUntilIdle();
+  EXPECT_EQ(std::vector<std::string>({"foo", "bar", "baz"}),
+            LoadRecords(path_, &snapshot));
+}
+
+TEST_F(JournaledFileWriterTest, Compact) {
+  auto writer = CreateWriter();
+  writer->AppendRecord(MakeRecord("foo"));
+  writer->CommitPendingRecords();
+  writer->AppendRecord(MakeRecord("bar"));
+  serializer_.set_snapshot("foobar");
+  EXPECT_TRUE(writer->Compact());
+  EXPECT_FALSE(writer->HasPendingWrite());
+  task_environment_.RunUntilIdle();
+
+  std::string snapshot;
+  EXPECT_TRUE(LoadRecords(path_, &snapshot).empty());
+  EXPECT_EQ("foobar", snapshot);
+
+  writer->AppendRecord(MakeRecord("baz"));
+  writer->CommitPendingRecords();
+  task_environment_.RunUntilIdle();
+  EXPECT_EQ(std::vector<std::string>({"baz"}), LoadRecords(path_, &snapshot));
+  EXPECT_EQ("foobar", snapshot);
+}
+
+TEST_F(JournaledFileWriterTest, FailedCompactionKeepsRecords) {
+  auto writer = CreateWriter();
+  writer->AppendRecord(MakeRecord("foo"));
+  serializer_.set_succeeds(false);
+  EXPECT_FALSE(writer->Compact());
+  EXPECT_TRUE(writer->HasPendingWrite());
+  task_environment_.FastForwardBy(kCommitInterval);
+
+  std::string snapshot;
+  EXPECT_EQ(std::vector<std::string>({"foo"}), LoadRecords(path_, &snapshot));
+}
+
+TEST_F(JournaledFileWriterTest, CompactLargeJournal) {
+  auto writer = CreateWriter();
+  serializer_.set_snapshot("snapshot");
+  writer->AppendRecord(
+      MakeRecord(std::string(JournaledFileWriter::kMinCompactionSize, 'x')));
+  writer->CommitPendingRecords();
+  task_environment_.RunUntilIdle();
+
+  std::string snapshot;
+  EXPECT_TRUE(LoadRecords(path_, &snapshot).empty());
+  EXPECT_EQ("snapshot", snapshot);
+}
+
+TEST_F(JournaledFileWriterTest, DropTornRecords) {
+  auto writer = CreateWriter();
+  writer->AppendRecord(MakeRecord("foo"));
+  writer->CommitPendingRecords();
+  task_environment_.RunUntilIdle();
+  writer.reset();
+
+  // A record cut short by a crash, and zeroes.
+  const FilePath journal_path = JournaledFileWriter::GetJournalPath(path_);
+  Pickle torn_record = MakeRecord("bar");
+  ASSERT_TRUE(AppendToFile(
+      journal_path, StringPiece(static_cast<const char*>(torn_record.data()),
+                                torn_record.size() - 1)));
+  std::string snapshot;
+  EXPECT_EQ(std::vector<std::string>({"foo"}), LoadRecords(path_, &snapshot));
+  ASSERT_TRUE(AppendToFile(journal_path, std::string(64, '\0')));
+  EXPECT_EQ(std::vector<std::string>({"foo"}), LoadRecords(path_, &snapshot));
+
+  // The next records are appended after the last valid one.
+  writer = CreateWriter();
+  writer->AppendRecord(MakeRecord("baz"));
+  writer->CommitPendingRecords();
+  task_environment_.RunUntilIdle();
+  EXPECT_EQ(std::vector<std::string>({"foo", "baz"}),
+            LoadRecords(path_, &snapshot));
+}
+
+TEST_F(JournaledFileWriterTest, CorruptedSnapshot) {
+  auto writer = CreateWriter();
+  serializer_.set_snapshot("snapshot");
+  EXPECT_TRUE(writer->Compact());
+  task_environment_.RunUntilIdle();
+
+  std::string contents;
+  ASSERT_TRUE(ReadFileToString(path_, &contents));
+  contents.back() ^= 1;
+  ASSERT_TRUE(WriteFile(path_, contents));
+  std::string snapshot;
+  std::vector<Pickle> records;
+  EXPECT_FALSE(JournaledFileWriter::Load(path_, &snapshot, &records));
+  EXPECT_TRUE(snapshot.empty());
+}
+
+}  // namespace base
@@ -33,6 +33,12 @@ MemoryMappedFile::~MemoryMappedFile() {
 
 #if !BUILDFLAG(IS_NACL)
 bool MemoryMappedFile::Initialize(const FilePath& file_name, Access access) {
+  return Initialize(file_name, access, Options());
+}
+
+bool MemoryMappedFile::Initialize(const FilePath& file_name,
+                                  Access access,
+                                  const Options& options) {
   if (IsValid())
     return false;
 
@@ -62,7 +68,7 @@ bool MemoryMappedFile::Initialize(const FilePath& file_name, Access access) {
     return false;
   }
 
-  if (!MapFileRegionToMemory(Region::kWholeFile, access)) {
+  if (!MapFileRegionToMemory(Region::kWholeFile, access, options)) {
     CloseHandles();
     return false;
   }
@@ -78,6 +84,13 @@ bool MemoryMappedFile::Initialize(File file, Access access) {
 bool MemoryMappedFile::Initialize(File file,
                                   const Region& region,
                                   Access access) {
+  return Initialize(std::move(file), region, access, Options());
+}
+
+bool MemoryMappedFile::Initialize(File file,
+                                  const Region& region,
+                                  Access access,
+                                  const Options& options) {
   switch (access) {
     case READ_WRITE_EXTEND:
       DCHECK(Region::kWholeFile != region);
@@ -115,7 +128,7 @@ bool MemoryMappedFile::Initialize(File file,
 
   file_ = std::move(file);
 
-  if (!MapFileRegionToMemory(region, access)) {
+  if (!MapFileRegionToMemory(region, access, options)) {
     CloseHandles();
     return false;
   }
@@ -9,10 +9,13 @@
 #include <stdint.h>
 
 #include <utility>
+#include <vector>
 
 #include "base/base_export.h"
+#include "base/callback.h"
 #include "base/files/file.h"
 #include "build/build_config.h"
+#include "third_party/abseil-cpp/absl/types/optional.h"
 
 #if BUILDFLAG(IS_WIN)
 #include "base/win/scoped_handle.h"
@@ -55,6 +58,35 @@ class BASE_EXPORT MemoryMappedFile {
 #endif
   };
 
+  // How the mapped memory is expected to be accessed, which tunes the
+  // readahead of the pages faulted in (madvise() on POSIX).
+  enum class Advice {
+    kNormal,
+    // The pages are read in order, so more of them can be read ahead, and
+    // freed soon after they are read.
+    kSequential,
+    // The pages are read in no particular order, so no more than the faulted
+    // ones need to be read.
+    kRandom,
+    // The pages are read soon, so they can be read ahead now.
+    kWillNeed,
+  };
+
+  // Options for mapping the files whose page faults dominate the time to read
+  // them first, like large data files read at startup. The options are hints,
+  // which are ignored where unsupported (e.g. on Windows).
+  struct BASE_EXPORT Options {
+    // Reads the whole mapping in memory before Initialize() returns, which then
+    // blocks for as long (MAP_POPULATE on Linux, ChromeOS and Android).
+    // Elsewhere, the pages are read ahead as with Advice::kWillNeed.
+    bool populate = false;
+    Advice advice = Advice::kNormal;
+    // Backs the mapping with transparent huge pages, where the kernel and the
+    // file system support it for files (MADV_HUGEPAGE on Linux, ChromeOS and
+    // Android).
+    bool huge_pages = false;
+  };
+
   // The default constructor sets all members to invalid/null values.
   MemoryMappedFile();
   MemoryMappedFile(const MemoryMappedFile&) = delete;
@@ -84,6 +116,9 @@ class BASE_EXPORT MemoryMappedFile {
   [[nodiscard]] bool Initialize(const FilePath& file_name) {
     return Initialize(file_name, READ_ONLY);
   }
+  [[nodiscard]] bool Initialize(const FilePath& file_name,
+                                Access access,
+                                const Options& options);
 
   // As above, but works with an already-opened file. |access| can be read-only
   // or read/write but not read/write+extend. MemoryMappedFile takes ownership
@@ -103,6 +138,10 @@ class BASE_EXPORT MemoryMappedFile {
   [[nodiscard]] bool Initialize(File file, const Region& region) {
     return Initialize(std::move(file), region, READ_ONLY);
   }
+  [[nodiscard]] bool Initialize(File file,
+                                const Region& region,
+                                Access access,
+                                const Options& options);
 
   const uint8_t* data() const { return data_; }
   uint8_t* data() { return data_; }
@@ -111,6 +150,35 @@ class BASE_EXPORT MemoryMappedFile {
   // Is file_ a valid file handle that points to an open, memory mapped file?
   bool IsValid() const;
 
+#if BUILDFLAG(IS_POSIX) && !BUILDFLAG(IS_NACL)
+  // Applies |advice| to the whole mapping, e.g. kRandom once the sequential
+  // reads of startup are done. Returns false on failure.
+  bool Advise(Advice advice);
+
+  // As above, but only to the pages that hold [|offset|, |offset| + |size|)
+  // of the mapping.
+  bool Advise(Advice advice, size_t offset, size_t size);
+
+  // Reads [|offset|, |offset| + |size|) of the mapping ahead into the page
+  // cache on a ThreadPool sequence, at the priority of the calling thread, so
+  // that the page faults there need no disk reads. Runs |on_done| on the
+  // calling sequence once done, if it is not null. Only supported on Linux,
+  // ChromeOS, Android and Apple platforms; |on_done| still runs elsewhere. The
+  // readahead outlives this object if it is deleted in the meantime.
+  void Prefetch(size_t offset,
+                size_t size,
+                OnceClosure on_done = OnceClosure());
+
+  // Returns how many bytes of [|offset|, |offset| + |size|) of the mapping are
+  // in resident pages (mincore()), or nullopt on failure.
+  absl::optional<size_t> GetResidentSize(size_t offset, size_t size) const;
+
+  // Returns whether each page of the mapping is resident (mincore()), or
+  // nullopt on failure. Page 0 is the page that holds data(), which isn't
+  // page-aligned if the mapping starts in the middle of a page of the file.
+  absl::optional<std::vector<bool>> GetResidentPages() const;
+#endif
+
  private:
   // Given the arbitrarily aligned memory region [start, size], returns the
   // boundaries of the region aligned to the granularity specified by the OS,
@@ -132,7 +200,9 @@ class BASE_EXPORT MemoryMappedFile {
 
   // Map the file to memory, set data_ to that memory address. Return true on
   // success, false on any kind of failure. This is a helper for Initialize().
-  bool MapFileRegionToMemory(const Region& region, Access access);
+  bool MapFileRegionToMemory(const Region& region,
+                             Access access,
+                             const Options& options);
 
   // Closes all open handles.
   void CloseHandles();
@@ -141,6 +211,11 @@ class BASE_EXPORT MemoryMappedFile {
   uint8_t* data_;
   size_t length_;
 
+#if BUILDFLAG(IS_POSIX) && !BUILDFLAG(IS_NACL)
+  // The offset of |data_| in |file_|.
+  int64_t data_file_offset_ = 0;
+#endif
+
 #if BUILDFLAG(IS_WIN)
   win::ScopedHandle file_mapping_;
 #endif
@@ -11,20 +11,84 @@
 #include <sys/stat.h>
 #include <unistd.h>
 
+#include <algorithm>
+#include <utility>
+#include <vector>
+
+#include "base/bind.h"
 #include "base/files/file_util.h"
 #include "base/logging.h"
+#include "base/memory/page_size.h"
 #include "base/numerics/safe_conversions.h"
+#include "base/posix/eintr_wrapper.h"
+#include "base/task/scoped_set_task_priority_for_current_thread.h"
+#include "base/task/task_traits.h"
+#include "base/task/thread_pool.h"
 #include "base/threading/scoped_blocking_call.h"
 #include "build/build_config.h"
 
 namespace base {
 
+#if !BUILDFLAG(IS_NACL)
+namespace {
+
+int GetMadviseAdvice(MemoryMappedFile::Advice advice) {
+  switch (advice) {
+    case MemoryMappedFile::Advice::kNormal:
+      return MADV_NORMAL;
+    case MemoryMappedFile::Advice::kSequential:
+      return MADV_SEQUENTIAL;
+    case MemoryMappedFile::Advice::kRandom:
+      return MADV_RANDOM;
+    case MemoryMappedFile::Advice::kWillNeed:
+      return MADV_WILLNEED;
+  }
+}
+
+// Reads [|offset|, |offset| + |size|) of |file| ahead into the page cache.
+void ReadAhead(File file, int64_t offset, size_t size) {
+  ScopedBlockingCall scoped_blocking_call(FROM_HERE, BlockingType::MAY_BLOCK);
+#if BUILDFLAG(IS_LINUX) || BUILDFLAG(IS_CHROMEOS) || BUILDFLAG(IS_ANDROID)
+  // Unlike madvise(), the file descriptor keeps the file alive, even if the
+  // mapping is gone. Each readahead() reads no more than the readahead window
+  // of the device, which can be as small as 128 KiB, so the range is read
+  // ahead a window at a time.
+  constexpr size_t kMaxReadAheadSize = 128 * 1024;
+  while (size > 0) {
+    const size_t chunk_size = std::min(size, kMaxReadAheadSize);
+    if (readahead(file.GetPlatformFile(), offset, chunk_size) != 0) {
+      DPLOG(WARNING) << "readahead " << file.GetPlatformFile();
+      return;
+    }
+    offset += chunk_size;
+    size -= chunk_size;
+  }
+#elif BUILDFLAG(IS_APPLE)
+  constexpr size_t kMaxReadAheadSize = 1024 * 1024 * 1024;
+  while (size > 0) {
+    const int chunk_size = static_cast<int>(std::min(size, kMaxReadAheadSize));
+    radvisory advisory = {static_cast<off_t>(offset), chunk_size};
+    if (HANDLE_EINTR(fcntl(file.GetPlatformFile(), F_RDADVISE, &advisory)) ==
+        -1) {
+      DPLOG(WARNING) << "fcntl(F_RDADVISE) " << file.GetPlatformFile();
+      return;
+    }
+    offset += chunk_size;
+    size -= static_cast<size_t>(chunk_size);
+  }
+#endif
+}
+
+}  // namespace
+#endif  // !BUILDFLAG(IS_NACL)
+
 MemoryMappedFile::MemoryMappedFile() : data_(nullptr), length_(0) {}
 
 #if !BUILDFLAG(IS_NACL)
 bool MemoryMappedFile::MapFileRegionToMemory(
     const MemoryMappedFile::Region& region,
-    Access access) {
+    Access access,
+    const Options& options) {
   ScopedBlockingCall scoped_blocking_call(FROM_HERE, BlockingType::MAY_BLOCK);
 
   off_t map_start = 0;
@@ -65,6 +129,7 @@ bool MemoryMappedFile::MapFileRegionToMemory(
     map_size = aligned_size;
     length_ = region.size;
   }
+  data_file_offset_ = map_start + data_offset;
 
   int flags = 0;
   switch (access) {
@@ -85,16 +150,136 @@ bool MemoryMappedFile::MapFileRegionToMemory(
       break;
   }
 
-  data_ = static_cast<uint8_t*>(mmap(nullptr, map_size, flags, MAP_SHARED,
+  int map_flags = MAP_SHARED;
+  Advice advice = options.advice;
+#if BUILDFLAG(IS_LINUX) || BUILDFLAG(IS_CHROMEOS) || BUILDFLAG(IS_ANDROID)
+  if (options.populate)
+    map_flags |= MAP_POPULATE;
+#else
+  if (options.populate)
+    advice = Advice::kWillNeed;
+#endif
+
+  data_ = static_cast<uint8_t*>(mmap(nullptr, map_size, flags, map_flags,
                                      file_.GetPlatformFile(), map_start));
   if (data_ == MAP_FAILED) {
     DPLOG(ERROR) << "mmap " << file_.GetPlatformFile();
     return false;
   }
 
+  // The hints are applied to the whole pages mapped, and their failures
+  // don't fail the mapping.
+#if defined(MADV_HUGEPAGE)
+  if (options.huge_pages && madvise(data_, map_size, MADV_HUGEPAGE) != 0)
+    DPLOG(WARNING) << "madvise(MADV_HUGEPAGE)";
+#endif
+  if (advice != Advice::kNormal &&
+      madvise(data_, map_size, GetMadviseAdvice(advice)) != 0) {
+    DPLOG(WARNING) << "madvise";
+  }
+
   data_ += data_offset;
   return true;
 }
+
+bool MemoryMappedFile::Advise(Advice advice) {
+  return Advise(advice, 0, length_);
+}
+
+bool MemoryMappedFile::Advise(Advice advice, size_t offset, size_t size) {
+  DCHECK(IsValid());
+  DCHECK_LE(offset, length_);
+  DCHECK_LE(size, length_ - offset);
+  // madvise() needs a page-aligned address.
+  uint8_t* const begin = data_ + offset;
+  uint8_t* const start = reinterpret_cast<uint8_t*>(
+      reinterpret_cast<uintptr_t>(begin) & ~(GetPageSize() - 1));
+  if (madvise(start, size + static_cast<size_t>(begin - start),
+              GetMadviseAdvice(advice)) != 0) {
+    DPLOG(WARNING) << "madvise";
+    return false;
+  }
+  return true;
+}
+
+void MemoryMappedFile::Prefetch(size_t offset,
+                                size_t size,
+                                OnceClosure on_done) {
+  DCHECK(IsValid());
+  DCHECK_LE(offset, length_);
+  DCHECK_LE(size, length_ - offset);
+  const TaskTraits traits = {MayBlock(),
+                             internal::GetTaskPriorityForCurrentThread(),
+                             TaskShutdownBehavior::CONTINUE_ON_SHUTDOWN};
+  auto read_ahead =
+      BindOnce(&ReadAhead, file_.Duplicate(),
+               data_file_offset_ + static_cast<int64_t>(offset), size);
+  if (on_done) {
+    ThreadPool::PostTaskAndReply(FROM_HERE, traits, std::move(read_ahead),
+                                 std::move(on_done));
+  } else {
+    ThreadPool::PostTask(FROM_HERE, traits, std::move(read_ahead));
+  }
+}
+
+absl::optional<size_t> MemoryMappedFile::GetResidentSize(size_t offset,
+                                                         size_t size) const {
+  DCHECK(IsValid());
+  DCHECK_LE(offset, length_);
+  DCHECK_LE(size, length_ - offset);
+  if (!size)
+    return 0;
+
+  const uintptr_t page_size = GetPageSize();
+  const uintptr_t begin = reinterpret_cast<uintptr_t>(data_) + offset;
+  const uintptr_t end = begin + size;
+  const uintptr_t aligned_begin = begin & ~(page_size - 1);
+  const size_t page_count = (end - aligned_begin + page_size - 1) / page_size;
+#if BUILDFLAG(IS_APPLE)
+  std::vector<char> residency(page_count);
+#else
+  std::vector<unsigned char> residency(page_count);
+#endif
+  if (mincore(reinterpret_cast<void*>(aligned_begin), end - aligned_begin,
+              residency.data()) != 0) {
+    DPLOG(WARNING) << "mincore";
+    return absl::nullopt;
+  }
+
+  size_t resident_size = 0;
+  for (size_t i = 0; i < page_count; ++i) {
+    if (!(residency[i] & 1))
+      continue;
+    const uintptr_t page_begin = aligned_begin + i * page_size;
+    resident_size += std::min(end, page_begin + page_size) -
+                     std::max(begin, page_begin);
+  }
+  return resident_size;
+}
+
+absl::optional<std::vector<bool>> MemoryMappedFile::GetResidentPages() const {
+  DCHECK(IsValid());
+  const uintptr_t page_size = GetPageSize();
+  const uintptr_t begin = reinterpret_cast<uintptr_t>(data_);
+  const uintptr_t aligned_begin = begin & ~(page_size - 1);
+  const uintptr_t end = begin + length_;
+  const size_t page_count = (end - aligned_begin + page_size - 1) / page_size;
+#if BUILDFLAG(IS_APPLE)
+  std::vector<char> residency(page_count);
+#else
+  std::vector<unsigned char> residency(page_count);
+#endif
+  if (page_count && mincore(reinterpret_cast<void*>(aligned_begin),
+                            end - aligned_begin, residency.data()) != 0) {
+    DPLOG(WARNING) << "mincore";
+    return absl::nullopt;
+  }
+
+  std::vector<bool> resident_pages(page_count);
+  for (size_t i = 0; i < page_count; ++i)
+    resident_pages[i] = residency[i] & 1;
+  return resident_pages;
+}
 #endif
 
 void MemoryMappedFile::CloseHandles() {
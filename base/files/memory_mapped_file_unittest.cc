@@ -7,10 +7,16 @@
 #include <stddef.h>
 #include <stdint.h>
 
+#include <memory>
 #include <utility>
+#include <vector>
 
 #include "base/files/file_path.h"
 #include "base/files/file_util.h"
+#include "base/memory/page_size.h"
+#include "base/run_loop.h"
+#include "base/test/task_environment.h"
+#include "build/build_config.h"
 #include "testing/gtest/include/gtest/gtest.h"
 #include "testing/platform_test.h"
 
@@ -240,6 +246,97 @@ TEST_F(MemoryMappedFileTest, ExtendableFile) {
   EXPECT_EQ("BAZ", contents.substr(kFileSize, 3));
 }
 
+#if BUILDFLAG(IS_POSIX)
+TEST_F(MemoryMappedFileTest, MapWithOptions) {
+  const size_t kFileSize = 256 * 1024;
+  CreateTemporaryTestFile(kFileSize);
+
+  for (MemoryMappedFile::Advice advice :
+       {MemoryMappedFile::Advice::kNormal,
+        MemoryMappedFile::Advice::kSequential,
+        MemoryMappedFile::Advice::kRandom,
+        MemoryMappedFile::Advice::kWillNeed}) {
+    MemoryMappedFile::Options options;
+    options.populate = true;
+    options.advice = advice;
+    options.huge_pages = true;
+    MemoryMappedFile map;
+    ASSERT_TRUE(map.Initialize(temp_file_path(), MemoryMappedFile::READ_ONLY,
+                               options));
+    ASSERT_EQ(kFileSize, map.length());
+#if BUILDFLAG(IS_LINUX) || BUILDFLAG(IS_CHROMEOS) || BUILDFLAG(IS_ANDROID)
+    // MAP_POPULATE reads the whole file in the mapping.
+    EXPECT_EQ(kFileSize, map.GetResidentSize(0, kFileSize));
+#endif
+    EXPECT_TRUE(CheckBufferContents(map.data(), kFileSize, 0));
+    EXPECT_TRUE(map.Advise(MemoryMappedFile::Advice::kNormal));
+  }
+}
+
+TEST_F(MemoryMappedFileTest, GetResidentSize) {
+  const size_t kFileSize = 256 * 1024;
+  const size_t kOffset = 65 * 1024;
+  CreateTemporaryTestFile(kFileSize);
+
+  File file(temp_file_path(), File::FLAG_OPEN | File::FLAG_READ);
+  MemoryMappedFile map;
+  ASSERT_TRUE(map.Initialize(std::move(file), {kOffset, kFileSize - kOffset}));
+  // Touches the whole mapping.
+  ASSERT_TRUE(CheckBufferContents(map.data(), map.length(), kOffset));
+  EXPECT_EQ(map.length(), map.GetResidentSize(0, map.length()));
+  EXPECT_EQ(100u, map.GetResidentSize(10, 100));
+  EXPECT_EQ(0u, map.GetResidentSize(map.length(), 0));
+}
+
+TEST_F(MemoryMappedFileTest, GetResidentPages) {
+  const size_t kPageSize = GetPageSize();
+  const size_t kFileSize = 8 * kPageSize;
+  const size_t kOffset = kPageSize + 100;
+  CreateTemporaryTestFile(kFileSize);
+
+  File file(temp_file_path(), File::FLAG_OPEN | File::FLAG_READ);
+  MemoryMappedFile map;
+  ASSERT_TRUE(map.Initialize(std::move(file), {kOffset, kFileSize - kOffset}));
+  // The mapping starts 100 bytes into the second page of the file, so it
+  // spans the last 7 pages.
+  ASSERT_TRUE(CheckBufferContents(map.data(), map.length(), kOffset));
+  absl::optional<std::vector<bool>> resident_pages = map.GetResidentPages();
+  ASSERT_TRUE(resident_pages);
+  EXPECT_EQ(std::vector<bool>(7, true), *resident_pages);
+}
+
+TEST_F(MemoryMappedFileTest, AdviseRange) {
+  const size_t kFileSize = 256 * 1024;
+  CreateTemporaryTestFile(kFileSize);
+
+  MemoryMappedFile map;
+  ASSERT_TRUE(map.Initialize(temp_file_path()));
+  EXPECT_TRUE(map.Advise(MemoryMappedFile::Advice::kWillNeed, 1000, 5000));
+  EXPECT_TRUE(map.Advise(MemoryMappedFile::Advice::kRandom, kFileSize, 0));
+  EXPECT_TRUE(CheckBufferContents(map.data(), kFileSize, 0));
+}
+
+TEST_F(MemoryMappedFileTest, Prefetch) {
+  test::TaskEnvironment task_environment;
+  const size_t kFileSize = 256 * 1024;
+  CreateTemporaryTestFile(kFileSize);
+
+  MemoryMappedFile map;
+  ASSERT_TRUE(map.Initialize(temp_file_path()));
+  RunLoop run_loop;
+  map.Prefetch(1000, kFileSize - 2000, run_loop.QuitClosure());
+  run_loop.Run();
+  EXPECT_TRUE(CheckBufferContents(map.data(), kFileSize, 0));
+
+  // The prefetch outlives the mapping.
+  auto other_map = std::make_unique<MemoryMappedFile>();
+  ASSERT_TRUE(other_map->Initialize(temp_file_path()));
+  other_map->Prefetch(0, kFileSize);
+  other_map.reset();
+  task_environment.RunUntilIdle();
+}
+#endif  // BUILDFLAG(IS_POSIX)
+
 }  // namespace
 
 }  // namespace base
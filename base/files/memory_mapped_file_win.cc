@@ -53,7 +53,8 @@ bool MemoryMappedFile::MapImageToMemory(Access access) {
 
 bool MemoryMappedFile::MapFileRegionToMemory(
     const MemoryMappedFile::Region& region,
-    Access access) {
+    Access access,
+    const Options& options) {
   ScopedBlockingCall scoped_blocking_call(FROM_HERE, BlockingType::MAY_BLOCK);
 
   DCHECK(access != READ_CODE_IMAGE || region == Region::kWholeFile);
@@ -0,0 +1,301 @@
+// Copyright 2022 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "base/files/parallel_file_enumerator.h"
+
+#include <algorithm>
+#include <atomic>
+#include <memory>
+#include <utility>
+#include <vector>
+
+#include "base/bind.h"
+#include "base/check.h"
+#include "base/memory/raw_ptr.h"
+#include "base/synchronization/lock.h"
+#include "base/task/post_job.h"
+#include "base/task/scoped_set_task_priority_for_current_thread.h"
+#include "base/task/task_traits.h"
+#include "base/task/thread_pool/thread_pool_instance.h"
+#include "base/thread_annotations.h"
+#include "build/build_config.h"
+
+#if BUILDFLAG(IS_POSIX)
+#include <unordered_set>
+#endif
+
+namespace base {
+
+namespace {
+
+// Returns the FileEnumerator::FileType to list each directory with, which
+// returns the subdirectories too.
+int GetListFileType(int file_type) {
+  int list_file_type = FileEnumerator::FILES | FileEnumerator::DIRECTORIES |
+                       (file_type & FileEnumerator::NAMES_AND_TYPES_ONLY);
+#if BUILDFLAG(IS_POSIX) || BUILDFLAG(IS_FUCHSIA)
+  list_file_type |= file_type & FileEnumerator::SHOW_SYM_LINKS;
+#endif
+  return list_file_type;
+}
+
+}  // namespace
+
+class ParallelFileEnumerator::State {
+ public:
+  State(const ParallelFileEnumerator& enumerator,
+        const EntryCallback& on_entry,
+        const DirectoryCallback& on_directory_done)
+      : root_path_(enumerator.root_path_),
+        file_type_(enumerator.file_type_),
+        list_file_type_(GetListFileType(file_type_)),
+        max_pending_directories_(enumerator.max_pending_directories_),
+        on_entry_(on_entry),
+        on_directory_done_(on_directory_done) {
+#if BUILDFLAG(IS_POSIX)
+    // Like FileEnumerator, follows the symbolic links unless they are shown,
+    // and then visits each directory once to avoid looping along circular
+    // links.
+    track_visited_directories_ =
+        !(file_type_ & FileEnumerator::SHOW_SYM_LINKS);
+    if (track_visited_directories_) {
+      stat_wrapper_t st;
+      if (File::Stat(root_path_.value().c_str(), &st) == 0) {
+        AutoLock auto_lock(visited_directories_lock_);
+        visited_directories_.insert(st.st_ino);
+      }
+    }
+#endif
+  }
+  State(const State&) = delete;
+  State& operator=(const State&) = delete;
+  ~State() { DCHECK(pending_directories_.empty()); }
+
+  // Lists the root directory on the calling thread. Returns true if
+  // subdirectories are left to list.
+  bool ListRoot() {
+    std::vector<std::unique_ptr<Directory>> local_directories;
+    ListDirectory(std::make_unique<Directory>(root_path_, nullptr),
+                  &local_directories);
+    AutoLock auto_lock(pending_directories_lock_);
+    AddPendingDirectoriesLockRequired(&local_directories);
+    return !pending_directories_.empty();
+  }
+
+  // Lists directories until none is left or |delegate| asks to yield. A null
+  // |delegate| never does.
+  void Run(JobDelegate* delegate) {
+    // The directories found by this worker while the queue was full.
+    std::vector<std::unique_ptr<Directory>> local_directories;
+    while (true) {
+      std::unique_ptr<Directory> directory;
+      if (!local_directories.empty()) {
+        // Shares half of them with the idle workers once the queue is empty.
+        if (delegate && local_directories.size() > 1 &&
+            num_pending_directories_.load(std::memory_order_relaxed) == 0) {
+          ShareLocalDirectories(&local_directories);
+          delegate->NotifyConcurrencyIncrease();
+        }
+        directory = std::move(local_directories.back());
+        local_directories.pop_back();
+      } else {
+        directory = TakePendingDirectory();
+        if (!directory)
+          return;
+      }
+
+      if (ListDirectory(std::move(directory), &local_directories) &&
+          delegate) {
+        delegate->NotifyConcurrencyIncrease();
+      }
+
+      if (delegate && delegate->ShouldYield()) {
+        AutoLock auto_lock(pending_directories_lock_);
+        AddPendingDirectoriesLockRequired(&local_directories);
+        return;
+      }
+    }
+  }
+
+  size_t GetMaxConcurrency(size_t worker_count) const {
+    // memory_order_relaxed is sufficient since the queue itself is
+    // synchronized by |pending_directories_lock_|. The active workers may
+    // find more directories.
+    return num_pending_directories_.load(std::memory_order_relaxed) +
+           worker_count;
+  }
+
+ private:
+  struct Directory {
+    Directory(FilePath path, Directory* parent)
+        : path(std::move(path)), parent(parent) {}
+
+    const FilePath path;
+    // Null for the root.
+    const raw_ptr<Directory> parent;
+    // The listing of this directory, and the subdirectories not done yet.
+    std::atomic<size_t> pending_count{1};
+  };
+
+  // Lists |directory|, calls |on_entry_| for its matches and adds its
+  // subdirectories to the queue, or to |local_directories| once the queue is
+  // full. Returns true if the queue got directories.
+  bool ListDirectory(
+      std::unique_ptr<Directory> directory,
+      std::vector<std::unique_ptr<Directory>>* local_directories) {
+    std::vector<std::unique_ptr<Directory>> subdirectories;
+    FileEnumerator enumerator(directory->path, /*recursive=*/false,
+                              list_file_type_);
+    for (FilePath path = enumerator.Next(); !path.empty();
+         path = enumerator.Next()) {
+      const FileEnumerator::FileInfo info = enumerator.GetInfo();
+      const bool is_dir = info.IsDirectory();
+      if (file_type_ &
+          (is_dir ? FileEnumerator::DIRECTORIES : FileEnumerator::FILES)) {
+        on_entry_.Run(path, info);
+      }
+      if (is_dir && Visit(info)) {
+        directory->pending_count.fetch_add(1, std::memory_order_relaxed);
+        subdirectories.push_back(
+            std::make_unique<Directory>(std::move(path), directory.get()));
+      }
+    }
+
+    bool added_pending_directories = false;
+    if (!subdirectories.empty()) {
+      AutoLock auto_lock(pending_directories_lock_);
+      while (!subdirectories.empty() &&
+             pending_directories_.size() < max_pending_directories_) {
+        pending_directories_.push_back(std::move(subdirectories.back()));
+        subdirectories.pop_back();
+        added_pending_directories = true;
+      }
+      num_pending_directories_.store(pending_directories_.size(),
+                                     std::memory_order_relaxed);
+    }
+    for (auto& subdirectory : subdirectories)
+      local_directories->push_back(std::move(subdirectory));
+
+    CompleteDirectory(directory.release());
+    return added_pending_directories;
+  }
+
+  // Releases a pending count of |directory|, which is deleted with the last
+  // one, and then releases one of its parent.
+  void CompleteDirectory(Directory* directory) {
+    while (directory) {
+      // memory_order_acq_rel orders the calls for everything under the
+      // directory before |on_directory_done_|.
+      if (directory->pending_count.fetch_sub(1, std::memory_order_acq_rel) !=
+          1) {
+        return;
+      }
+      if (on_directory_done_)
+        on_directory_done_.Run(directory->path);
+      Directory* const parent = directory->parent;
+      delete directory;
+      directory = parent;
+    }
+  }
+
+  std::unique_ptr<Directory> TakePendingDirectory() {
+    AutoLock auto_lock(pending_directories_lock_);
+    if (pending_directories_.empty())
+      return nullptr;
+    std::unique_ptr<Directory> directory =
+        std::move(pending_directories_.back());
+    pending_directories_.pop_back();
+    num_pending_directories_.store(pending_directories_.size(),
+                                   std::memory_order_relaxed);
+    return directory;
+  }
+
+  void ShareLocalDirectories(
+      std::vector<std::unique_ptr<Directory>>* local_directories) {
+    const size_t num_shared = local_directories->size() / 2;
+    AutoLock auto_lock(pending_directories_lock_);
+    for (size_t i = 0; i < num_shared; ++i)
+      pending_directories_.push_back(std::move((*local_directories)[i]));
+    local_directories->erase(local_directories->begin(),
+                             local_directories->begin() + num_shared);
+    num_pending_directories_.store(pending_directories_.size(),
+                                   std::memory_order_relaxed);
+  }
+
+  // Adds |directories| to the queue, regardless of its bound.
+  void AddPendingDirectoriesLockRequired(
+      std::vector<std::unique_ptr<Directory>>* directories)
+      EXCLUSIVE_LOCKS_REQUIRED(pending_directories_lock_) {
+    for (auto& directory : *directories)
+      pending_directories_.push_back(std::move(directory));
+    directories->clear();
+    num_pending_directories_.store(pending_directories_.size(),
+                                   std::memory_order_relaxed);
+  }
+
+  // Returns true if the directory of |info| is to be listed.
+  bool Visit(const FileEnumerator::FileInfo& info) {
+#if BUILDFLAG(IS_POSIX)
+    if (track_visited_directories_) {
+      AutoLock auto_lock(visited_directories_lock_);
+      return visited_directories_.insert(info.stat().st_ino).second;
+    }
+#endif
+    return true;
+  }
+
+  const FilePath root_path_;
+  const int file_type_;
+  const int list_file_type_;
+  const size_t max_pending_directories_;
+  const EntryCallback& on_entry_;
+  const DirectoryCallback& on_directory_done_;
+
+  Lock pending_directories_lock_;
+  // The directories left to list, the last one first.
+  std::vector<std::unique_ptr<Directory>> pending_directories_
+      GUARDED_BY(pending_directories_lock_);
+  // The size of |pending_directories_|, for GetMaxConcurrency().
+  std::atomic<size_t> num_pending_directories_{0};
+
+#if BUILDFLAG(IS_POSIX)
+  bool track_visited_directories_ = false;
+  Lock visited_directories_lock_;
+  std::unordered_set<ino_t> visited_directories_
+      GUARDED_BY(visited_directories_lock_);
+#endif
+};
+
+ParallelFileEnumerator::ParallelFileEnumerator(const FilePath& root_path,
+                                               int file_type,
+                                               size_t max_pending_directories)
+    : root_path_(root_path),
+      file_type_(file_type),
+      max_pending_directories_(max_pending_directories) {
+  DCHECK(!(file_type_ & FileEnumerator::INCLUDE_DOT_DOT));
+}
+
+ParallelFileEnumerator::~ParallelFileEnumerator() = default;
+
+void ParallelFileEnumerator::Run(const EntryCallback& on_entry,
+                                 const DirectoryCallback& on_directory_done) {
+  DCHECK(on_entry);
+  State state(*this, on_entry, on_directory_done);
+  // Small trees are not worth a job.
+  if (!state.ListRoot())
+    return;
+
+  if (!ThreadPoolInstance::Get()) {
+    state.Run(nullptr);
+    return;
+  }
+  JobHandle handle =
+      PostJob(FROM_HERE,
+              {MayBlock(), internal::GetTaskPriorityForCurrentThread()},
+              BindRepeating(&State::Run, Unretained(&state)),
+              BindRepeating(&State::GetMaxConcurrency, Unretained(&state)));
+  handle.Join();
+}
+
+}  // namespace base
@@ -0,0 +1,81 @@
+// Copyright 2022 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#ifndef BASE_FILES_PARALLEL_FILE_ENUMERATOR_H_
+#define BASE_FILES_PARALLEL_FILE_ENUMERATOR_H_
+
+#include <stddef.h>
+
+#include "base/base_export.h"
+#include "base/callback.h"
+#include "base/files/file_enumerator.h"
+#include "base/files/file_path.h"
+
+namespace base {
+
+// Enumerates the files under a directory like a recursive FileEnumerator, but
+// lists several directories at once on the ThreadPool, for the large trees
+// where the enumeration is bound by the latency of the file system. The
+// directories left to list wait in a bounded queue: once it is full, a worker
+// lists the subdirectories it finds by itself, depth-first.
+//
+// The results come in no particular order, from concurrent calls on the
+// calling thread and on ThreadPool workers, at the priority of the calling
+// thread. Errors are ignored, like with FileEnumerator::ErrorPolicy::
+// IGNORE_ERRORS. Without a ThreadPoolInstance, the enumeration happens on the
+// calling thread only.
+//
+// This is blocking. Do not use on critical threads. Like JobHandle::Join(),
+// Run() must not be called while holding a lock that the callbacks could
+// acquire.
+//
+// Example:
+//
+//   std::atomic<int64_t> size(0);
+//   base::ParallelFileEnumerator(my_dir, base::FileEnumerator::FILES)
+//       .Run(base::BindRepeating(
+//           [](std::atomic<int64_t>* size, const base::FilePath& path,
+//              const base::FileEnumerator::FileInfo& info) {
+//             size->fetch_add(info.GetSize(), std::memory_order_relaxed);
+//           },
+//           &size));
+class BASE_EXPORT ParallelFileEnumerator {
+ public:
+  using EntryCallback =
+      RepeatingCallback<void(const FilePath& path,
+                             const FileEnumerator::FileInfo& info)>;
+  using DirectoryCallback = RepeatingCallback<void(const FilePath& path)>;
+
+  static constexpr size_t kDefaultMaxPendingDirectories = 1024;
+
+  // |file_type|, a bit mask of FileEnumerator::FileType, specifies whether the
+  // enumerator should match files, directories, or both, and whether to
+  // follow symbolic links. INCLUDE_DOT_DOT is not supported.
+  ParallelFileEnumerator(
+      const FilePath& root_path,
+      int file_type,
+      size_t max_pending_directories = kDefaultMaxPendingDirectories);
+  ParallelFileEnumerator(const ParallelFileEnumerator&) = delete;
+  ParallelFileEnumerator& operator=(const ParallelFileEnumerator&) = delete;
+  ~ParallelFileEnumerator();
+
+  // Calls |on_entry| for each match under the root path. If
+  // |on_directory_done| is not null, it is called for each directory
+  // enumerated, the root path included, once the calls for everything under
+  // the directory have returned, so that the tree can be deleted bottom-up.
+  // Returns once all calls have returned.
+  void Run(const EntryCallback& on_entry,
+           const DirectoryCallback& on_directory_done = DirectoryCallback());
+
+ private:
+  class State;
+
+  const FilePath root_path_;
+  const int file_type_;
+  const size_t max_pending_directories_;
+};
+
+}  // namespace base
+
+#endif  // BASE_FILES_PARALLEL_FILE_ENUMERATOR_H_
@@ -0,0 +1,189 @@
+// Copyright 2022 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "base/files/parallel_file_enumerator.h"
+
+#include <string>
+#include <vector>
+
+#include "base/bind.h"
+#include "base/files/file_path.h"
+#include "base/files/file_util.h"
+#include "base/files/scoped_temp_dir.h"
+#include "base/strings/string_number_conversions.h"
+#include "base/synchronization/lock.h"
+#include "base/test/task_environment.h"
+#include "build/build_config.h"
+#include "testing/gmock/include/gmock/gmock.h"
+#include "testing/gtest/include/gtest/gtest.h"
+
+using testing::UnorderedElementsAreArray;
+
+namespace base {
+
+namespace {
+
+// Creates |depth| levels of |fan_out| subdirectories with 2 files each, and
+// returns the files and the directories created.
+void CreateTree(const FilePath& path,
+                int depth,
+                int fan_out,
+                std::vector<FilePath>* files,
+                std::vector<FilePath>* directories) {
+  for (int i = 0; i < 2; ++i) {
+    const FilePath file = path.AppendASCII("file" + NumberToString(i));
+    ASSERT_TRUE(WriteFile(file, "42"));
+    files->push_back(file);
+  }
+  if (depth == 0)
+    return;
+  for (int i = 0; i < fan_out; ++i) {
+    const FilePath directory = path.AppendASCII("dir" + NumberToString(i));
+    ASSERT_TRUE(CreateDirectory(directory));
+    directories->push_back(directory);
+    CreateTree(directory, depth - 1, fan_out, files, directories);
+  }
+}
+
+class Recorder {
+ public:
+  ParallelFileEnumerator::EntryCallback GetEntryCallback() {
+    return BindRepeating(&Recorder::OnEntry, Unretained(this));
+  }
+  ParallelFileEnumerator::DirectoryCallback GetDirectoryCallback() {
+    return BindRepeating(&Recorder::OnDirectoryDone, Unretained(this));
+  }
+
+  std::vector<FilePath> entries() const {
+    AutoLock auto_lock(lock_);
+    return entries_;
+  }
+  std::vector<FilePath> done_directories() const {
+    AutoLock auto_lock(lock_);
+    return done_directories_;
+  }
+
+ private:
+  void OnEntry(const FilePath& path, const FileEnumerator::FileInfo& info) {
+    AutoLock auto_lock(lock_);
+    EXPECT_EQ(path.BaseName(), info.GetName());
+    // Nothing is found under a directory once it is done.
+    for (const FilePath& directory : done_directories_)
+      EXPECT_FALSE(directory.IsParent(path)) << path;
+    entries_.push_back(path);
+  }
+
+  void OnDirectoryDone(const FilePath& path) {
+    AutoLock auto_lock(lock_);
+    for (const FilePath& directory : done_directories_)
+      EXPECT_FALSE(path.IsParent(directory)) << path;
+    done_directories_.push_back(path);
+  }
+
+  mutable Lock lock_;
+  std::vector<FilePath> entries_;
+  std::vector<FilePath> done_directories_;
+};
+
+class ParallelFileEnumeratorTest : public testing::Test {
+ protected:
+  void SetUp() override {
+    ASSERT_TRUE(temp_dir_.CreateUniqueTempDir());
+    CreateTree(temp_dir_.GetPath(), 3, 4, &files_, &directories_);
+  }
+
+  test::TaskEnvironment task_environment_;
+  ScopedTempDir temp_dir_;
+  std::vector<FilePath> files_;
+  std::vector<FilePath> directories_;
+};
+
+}  // namespace
+
+TEST_F(ParallelFileEnumeratorTest, Files) {
+  Recorder recorder;
+  ParallelFileEnumerator(temp_dir_.GetPath(), FileEnumerator::FILES)
+      .Run(recorder.GetEntryCallback());
+  EXPECT_THAT(recorder.entries(), UnorderedElementsAreArray(files_));
+}
+
+TEST_F(ParallelFileEnumeratorTest, Directories) {
+  Recorder recorder;
+  ParallelFileEnumerator(temp_dir_.GetPath(), FileEnumerator::DIRECTORIES)
+      .Run(recorder.GetEntryCallback());
+  EXPECT_THAT(recorder.entries(), UnorderedElementsAreArray(directories_));
+}
+
+TEST_F(ParallelFileEnumeratorTest, DirectoriesDoneBottomUp) {
+  // A queue of 2 directories makes the workers list most directories
+  // depth-first by themselves.
+  for (size_t max_pending_directories : {2u, 1024u}) {
+    Recorder recorder;
+    ParallelFileEnumerator(temp_dir_.GetPath(),
+                           FileEnumerator::FILES |
+                               FileEnumerator::DIRECTORIES |
+                               FileEnumerator::NAMES_AND_TYPES_ONLY,
+                           max_pending_directories)
+        .Run(recorder.GetEntryCallback(), recorder.GetDirectoryCallback());
+
+    std::vector<FilePath> entries = files_;
+    entries.insert(entries.end(), directories_.begin(), directories_.end());
+    EXPECT_THAT(recorder.entries(), UnorderedElementsAreArray(entries));
+
+    std::vector<FilePath> done_directories = directories_;
+    done_directories.push_back(temp_dir_.GetPath());
+    EXPECT_THAT(recorder.done_directories(),
+                UnorderedElementsAreArray(done_directories));
+    EXPECT_EQ(temp_dir_.GetPath(), recorder.done_directories().back());
+  }
+}
+
+TEST(ParallelFileEnumeratorWithoutThreadPoolTest, Files) {
+  ScopedTempDir temp_dir;
+  ASSERT_TRUE(temp_dir.CreateUniqueTempDir());
+  std::vector<FilePath> files;
+  std::vector<FilePath> directories;
+  CreateTree(temp_dir.GetPath(), 2, 3, &files, &directories);
+
+  Recorder recorder;
+  ParallelFileEnumerator(temp_dir.GetPath(), FileEnumerator::FILES, 2)
+      .Run(recorder.GetEntryCallback(), recorder.GetDirectoryCallback());
+  EXPECT_THAT(recorder.entries(), UnorderedElementsAreArray(files));
+  EXPECT_EQ(directories.size() + 1, recorder.done_directories().size());
+}
+
+TEST(ParallelFileEnumeratorWithoutThreadPoolTest, EmptyDirectory) {
+  ScopedTempDir temp_dir;
+  ASSERT_TRUE(temp_dir.CreateUniqueTempDir());
+
+  Recorder recorder;
+  ParallelFileEnumerator(temp_dir.GetPath(), FileEnumerator::FILES)
+      .Run(recorder.GetEntryCallback(), recorder.GetDirectoryCallback());
+  EXPECT_TRUE(recorder.entries().empty());
+  EXPECT_THAT(recorder.done_directories(),
+              UnorderedElementsAreArray({temp_dir.GetPath()}));
+}
+
+#if BUILDFLAG(IS_POSIX)
+TEST_F(ParallelFileEnumeratorTest, SymLinkLoops) {
+  const FilePath link = directories_.back().AppendASCII("link");
+  ASSERT_TRUE(CreateSymbolicLink(temp_dir_.GetPath(), link));
+
+  // The link is followed, but the directories are listed once.
+  Recorder recorder;
+  ParallelFileEnumerator(temp_dir_.GetPath(), FileEnumerator::FILES)
+      .Run(recorder.GetEntryCallback());
+  EXPECT_THAT(recorder.entries(), UnorderedElementsAreArray(files_));
+
+  Recorder links_recorder;
+  ParallelFileEnumerator(temp_dir_.GetPath(),
+                         FileEnumerator::FILES | FileEnumerator::SHOW_SYM_LINKS)
+      .Run(links_recorder.GetEntryCallback());
+  std::vector<FilePath> entries = files_;
+  entries.push_back(link);
+  EXPECT_THAT(links_recorder.entries(), UnorderedElementsAreArray(entries));
+}
+#endif
+
+}  // namespace base
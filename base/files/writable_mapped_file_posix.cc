@@ -0,0 +1,244 @@
+// Copyright 2022 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "base/files/writable_mapped_file_posix.h"
+
+#include <fcntl.h>
+#include <string.h>
+#include <sys/mman.h>
+
+#include <algorithm>
+#include <utility>
+
+#include "base/bits.h"
+#include "base/check_op.h"
+#include "base/files/file_util.h"
+#include "base/files/important_file_writer_cleaner.h"
+#include "base/logging.h"
+#include "base/memory/page_size.h"
+#include "base/numerics/safe_conversions.h"
+#include "base/posix/eintr_wrapper.h"
+#include "base/threading/scoped_blocking_call.h"
+
+namespace base {
+
+namespace {
+
+// The least the mapping grows by, to amortize the allocations of small
+// appends. It doubles past that.
+constexpr size_t kMinGrowth = 1024 * 1024;
+
+}  // namespace
+
+WritableMappedFile::WritableMappedFile() = default;
+
+WritableMappedFile::~WritableMappedFile() {
+  if (!IsValid())
+    return;
+  CloseHandles();
+  DeleteFile(temp_path_);
+}
+
+bool WritableMappedFile::Initialize(const FilePath& path,
+                                    size_t capacity,
+                                    Mode mode) {
+  DCHECK(!IsValid());
+  DCHECK_GT(capacity, 0u);
+  ScopedBlockingCall scoped_blocking_call(FROM_HERE, BlockingType::MAY_BLOCK);
+
+  // Leftovers of a crash are deleted like the ones of ImportantFileWriter.
+  ImportantFileWriterCleaner::AddDirectory(path.DirName());
+  FilePath temp_path;
+  File file = CreateAndOpenTemporaryFileInDir(path.DirName(), &temp_path);
+  if (!file.IsValid()) {
+    DPLOG(ERROR) << "Failed to create a temporary file for " << path;
+    return false;
+  }
+
+  int64_t initial_length = 0;
+  if (mode == Mode::kAppend && PathExists(path)) {
+    File existing(path, File::FLAG_OPEN | File::FLAG_READ);
+    if (!existing.IsValid() || !CopyFileContents(existing, file) ||
+        (initial_length = file.GetLength()) < 0 ||
+        !IsValueInRangeForNumericType<size_t>(initial_length) ||
+        static_cast<size_t>(initial_length) > capacity) {
+      DPLOG(ERROR) << "Failed to copy " << path;
+      file.Close();
+      DeleteFile(temp_path);
+      return false;
+    }
+  }
+
+  // The address space is reserved without access, and backed by nothing until
+  // the file is mapped over it.
+  capacity = bits::AlignUp(capacity, GetPageSize());
+  void* data = mmap(nullptr, capacity, PROT_NONE,
+                    MAP_PRIVATE | MAP_ANONYMOUS | MAP_NORESERVE, -1, 0);
+  if (data == MAP_FAILED) {
+    DPLOG(ERROR) << "mmap " << capacity;
+    file.Close();
+    DeleteFile(temp_path);
+    return false;
+  }
+
+  path_ = path;
+  temp_path_ = std::move(temp_path);
+  file_ = std::move(file);
+  data_ = static_cast<uint8_t*>(data);
+  capacity_ = capacity;
+  if (!GrowMapping(static_cast<size_t>(initial_length))) {
+    CloseHandles();
+    DeleteFile(temp_path_);
+    return false;
+  }
+  length_ = static_cast<size_t>(initial_length);
+  return true;
+}
+
+bool WritableMappedFile::SetLength(size_t length) {
+  DCHECK(IsValid());
+  if (length > capacity_)
+    return false;
+  if (length > mapped_length_) {
+    ScopedBlockingCall scoped_blocking_call(FROM_HERE, BlockingType::MAY_BLOCK);
+    if (!GrowMapping(length))
+      return false;
+  }
+  if (length < length_) {
+    // Bytes past |length_| are zeroes, so that growing again needs not clear
+    // them.
+    memset(data_ + length, 0, length_ - length);
+    length_ = length;
+    return true;
+  }
+  const size_t old_length = length_;
+  length_ = length;
+  MarkDirty(old_length, length - old_length);
+  return true;
+}
+
+bool WritableMappedFile::Append(span<const uint8_t> data) {
+  DCHECK(IsValid());
+  if (data.size() > capacity_ - length_)
+    return false;
+  const size_t offset = length_;
+  if (!SetLength(length_ + data.size()))
+    return false;
+  if (!data.empty())
+    memcpy(data_ + offset, data.data(), data.size());
+  return true;
+}
+
+void WritableMappedFile::MarkDirty(size_t offset, size_t size) {
+  DCHECK(IsValid());
+  DCHECK_LE(offset, length_);
+  DCHECK_LE(size, length_ - offset);
+  if (size == 0)
+    return;
+  if (dirty_begin_ == dirty_end_) {
+    dirty_begin_ = offset;
+    dirty_end_ = offset + size;
+    return;
+  }
+  dirty_begin_ = std::min(dirty_begin_, offset);
+  dirty_end_ = std::max(dirty_end_, offset + size);
+}
+
+void WritableMappedFile::FlushAsync() {
+  DCHECK(IsValid());
+  dirty_end_ = std::min(dirty_end_, length_);
+  if (dirty_begin_ >= dirty_end_) {
+    dirty_begin_ = dirty_end_ = 0;
+    return;
+  }
+  ScopedBlockingCall scoped_blocking_call(FROM_HERE, BlockingType::MAY_BLOCK);
+#if BUILDFLAG(IS_LINUX) || BUILDFLAG(IS_CHROMEOS) || BUILDFLAG(IS_ANDROID)
+  // msync(MS_ASYNC) does nothing on Linux, where the pages written through
+  // the mapping are dirty in the page cache already. sync_file_range() starts
+  // writing them back.
+  if (HANDLE_EINTR(sync_file_range(file_.GetPlatformFile(), dirty_begin_,
+                                   dirty_end_ - dirty_begin_,
+                                   SYNC_FILE_RANGE_WRITE)) != 0) {
+    DPLOG(WARNING) << "sync_file_range " << file_.GetPlatformFile();
+  }
+#else
+  const size_t begin = bits::AlignDown(dirty_begin_, GetPageSize());
+  if (msync(data_ + begin, dirty_end_ - begin, MS_ASYNC) != 0)
+    DPLOG(WARNING) << "msync " << file_.GetPlatformFile();
+#endif
+  dirty_begin_ = dirty_end_ = 0;
+}
+
+bool WritableMappedFile::Commit() {
+  DCHECK(IsValid());
+  ScopedBlockingCall scoped_blocking_call(FROM_HERE, BlockingType::MAY_BLOCK);
+
+  bool result = true;
+  if (length_ > 0 && msync(data_, length_, MS_SYNC) != 0) {
+    DPLOG(ERROR) << "msync " << file_.GetPlatformFile();
+    result = false;
+  }
+  // The file is trimmed of the bytes allocated ahead once it is unmapped, so
+  // that no page maps past its end.
+  const int64_t length = static_cast<int64_t>(length_);
+  File file = std::move(file_);
+  CloseHandles();
+  if (result && !file.SetLength(length)) {
+    DPLOG(ERROR) << "ftruncate " << file.GetPlatformFile();
+    result = false;
+  }
+  if (result && !file.Flush()) {
+    DPLOG(ERROR) << "fsync " << file.GetPlatformFile();
+    result = false;
+  }
+  file.Close();
+  if (result && !ReplaceFile(temp_path_, path_, nullptr)) {
+    DPLOG(ERROR) << "Failed to rename " << temp_path_ << " to " << path_;
+    result = false;
+  }
+  if (!result)
+    DeleteFile(temp_path_);
+  return result;
+}
+
+bool WritableMappedFile::GrowMapping(size_t length) {
+  DCHECK_LE(length, capacity_);
+  if (length <= mapped_length_)
+    return true;
+  size_t new_mapped_length =
+      std::max({length, mapped_length_ * 2, kMinGrowth});
+  new_mapped_length =
+      std::min(bits::AlignUp(new_mapped_length, GetPageSize()), capacity_);
+
+  const size_t growth = new_mapped_length - mapped_length_;
+  if (!AllocateFileRegion(&file_, static_cast<int64_t>(mapped_length_),
+                          growth)) {
+    return false;
+  }
+  // The new pages replace the reserved ones, right after the pages mapped
+  // already, so the kernel merges them into one mapping.
+  void* data = mmap(data_ + mapped_length_, growth, PROT_READ | PROT_WRITE,
+                    MAP_SHARED | MAP_FIXED, file_.GetPlatformFile(),
+                    static_cast<off_t>(mapped_length_));
+  if (data == MAP_FAILED) {
+    DPLOG(ERROR) << "mmap " << file_.GetPlatformFile();
+    return false;
+  }
+  DCHECK_EQ(data, data_ + mapped_length_);
+  mapped_length_ = new_mapped_length;
+  return true;
+}
+
+void WritableMappedFile::CloseHandles() {
+  if (data_)
+    munmap(data_, capacity_);
+  file_.Close();
+  data_ = nullptr;
+  capacity_ = 0;
+  mapped_length_ = 0;
+  length_ = 0;
+  dirty_begin_ = dirty_end_ = 0;
+}
+
+}  // namespace base
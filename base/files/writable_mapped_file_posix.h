@@ -0,0 +1,123 @@
+// Copyright 2022 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#ifndef BASE_FILES_WRITABLE_MAPPED_FILE_POSIX_H_
+#define BASE_FILES_WRITABLE_MAPPED_FILE_POSIX_H_
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include "base/base_export.h"
+#include "base/containers/span.h"
+#include "base/files/file.h"
+#include "base/files/file_path.h"
+#include "build/build_config.h"
+
+#if BUILDFLAG(IS_NACL)
+#error "WritableMappedFile is not supported on NaCl."
+#endif
+
+namespace base {
+
+// A file written in place through a memory mapping which can grow, for files
+// built by appending, such as indexes, which would otherwise go through a
+// buffer, a write() and a read back.
+//
+// The file is written to a temporary file next to its path, in a reserved
+// range of address space in which the mapping grows, so the pointers into the
+// mapping stay valid as it does. The file is extended with AllocateFileRegion()
+// ahead of the mapping, so that writing to the mapping does not fault when the
+// disk is full. Commit() flushes the contents and renames them over the path,
+// so that a reader finds either the old file or the whole new one, like with
+// ImportantFileWriter.
+//
+// This is blocking. Do not use on critical threads.
+//
+// Example:
+//
+//   base::WritableMappedFile file;
+//   if (!file.Initialize(path, 1024 * 1024 * 1024,
+//                        base::WritableMappedFile::Mode::kAppend)) {
+//     return false;
+//   }
+//   for (const Entry& entry : entries) {
+//     if (!file.Append(base::as_bytes(base::make_span(&entry, 1u))))
+//       return false;
+//   }
+//   return file.Commit();
+class BASE_EXPORT WritableMappedFile {
+ public:
+  enum class Mode {
+    // Starts empty.
+    kCreate,
+    // Starts with a copy of the file at the path, if there is one.
+    kAppend,
+  };
+
+  WritableMappedFile();
+  WritableMappedFile(const WritableMappedFile&) = delete;
+  WritableMappedFile& operator=(const WritableMappedFile&) = delete;
+
+  // Discards the contents written since Initialize() unless they were
+  // committed.
+  ~WritableMappedFile();
+
+  // Creates the temporary file for |path| and reserves |capacity| bytes of
+  // address space, the most the file can grow to. Returns false on error.
+  bool Initialize(const FilePath& path, size_t capacity, Mode mode);
+
+  bool IsValid() const { return data_ != nullptr; }
+
+  uint8_t* data() { return data_; }
+  const uint8_t* data() const { return data_; }
+  size_t length() const { return length_; }
+  size_t capacity() const { return capacity_; }
+
+  // Resizes the file to |length| bytes, no more than capacity(). The bytes
+  // added are zeroes. Returns false if the disk is full, in which case the
+  // file is unchanged.
+  bool SetLength(size_t length);
+
+  // Copies |data| at the end of the file. Returns false like SetLength().
+  bool Append(span<const uint8_t> data);
+
+  // Marks the |size| bytes at |offset| as written through data(), for
+  // FlushAsync(). The bytes added by SetLength() and Append() are already.
+  void MarkDirty(size_t offset, size_t size);
+
+  // Starts writing back the bytes marked as written since the last call,
+  // without waiting for it to finish, so that Commit() has little left to
+  // flush.
+  void FlushAsync();
+
+  // Flushes the contents to the disk and renames them over the path. The
+  // mapping is closed, whether it succeeded or not, and data() becomes null.
+  // Returns false on error, in which case the file at the path is unchanged.
+  bool Commit();
+
+ private:
+  // Maps the file to at least |length| bytes, extending the file first.
+  bool GrowMapping(size_t length);
+
+  void CloseHandles();
+
+  FilePath path_;
+  FilePath temp_path_;
+  File file_;
+
+  // The reserved address space, the first |mapped_length_| bytes of which map
+  // the file.
+  uint8_t* data_ = nullptr;
+  size_t capacity_ = 0;
+  size_t mapped_length_ = 0;
+  size_t length_ = 0;
+
+  // The range of bytes written since the last FlushAsync().
+  size_t dirty_begin_ = 0;
+  size_t dirty_end_ = 0;
+};
+
+}  // namespace base
+
+#endif  // BASE_FILES_WRITABLE_MAPPED_FILE_POSIX_H_
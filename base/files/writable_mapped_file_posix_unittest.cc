@@ -0,0 +1,172 @@
+// Copyright 2022 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "base/files/writable_mapped_file_posix.h"
+
+#include <stdint.h>
+
+#include <string>
+
+#include "base/files/file_enumerator.h"
+#include "base/files/file_path.h"
+#include "base/files/file_util.h"
+#include "base/files/scoped_temp_dir.h"
+#include "base/strings/string_piece.h"
+#include "testing/gtest/include/gtest/gtest.h"
+
+namespace base {
+
+namespace {
+
+constexpr size_t kCapacity = 64 * 1024 * 1024;
+
+span<const uint8_t> AsBytes(StringPiece data) {
+  return as_bytes(make_span(data));
+}
+
+class WritableMappedFileTest : public testing::Test {
+ protected:
+  void SetUp() override {
+    ASSERT_TRUE(temp_dir_.CreateUniqueTempDir());
+    path_ = temp_dir_.GetPath().AppendASCII("file");
+  }
+
+  // Returns the number of files in the temporary directory.
+  int CountFiles() const {
+    int count = 0;
+    FileEnumerator enumerator(temp_dir_.GetPath(), false,
+                              FileEnumerator::FILES);
+    for (FilePath path = enumerator.Next(); !path.empty();
+         path = enumerator.Next()) {
+      ++count;
+    }
+    return count;
+  }
+
+  std::string ReadFile() const {
+    std::string contents;
+    EXPECT_TRUE(ReadFileToString(path_, &contents));
+    return contents;
+  }
+
+  ScopedTempDir temp_dir_;
+  FilePath path_;
+};
+
+}  // namespace
+
+TEST_F(WritableMappedFileTest, AppendAndCommit) {
+  WritableMappedFile file;
+  ASSERT_TRUE(
+      file.Initialize(path_, kCapacity, WritableMappedFile::Mode::kCreate));
+  EXPECT_TRUE(file.IsValid());
+  EXPECT_EQ(0u, file.length());
+  EXPECT_EQ(kCapacity, file.capacity());
+
+  ASSERT_TRUE(file.Append(AsBytes("foo")));
+  uint8_t* const data = file.data();
+  // Growing past the first mappings keeps the data in place.
+  const std::string large(3 * 1024 * 1024, 'x');
+  ASSERT_TRUE(file.Append(AsBytes(large)));
+  EXPECT_EQ(data, file.data());
+  EXPECT_EQ(3u + large.size(), file.length());
+  EXPECT_EQ('f', data[0]);
+  data[1] = 'i';
+  file.MarkDirty(1, 1);
+  file.FlushAsync();
+
+  // Nothing is visible until the commit.
+  EXPECT_FALSE(PathExists(path_));
+  EXPECT_TRUE(file.Commit());
+  EXPECT_FALSE(file.IsValid());
+  EXPECT_EQ(nullptr, file.data());
+  EXPECT_EQ("fio" + large, ReadFile());
+  EXPECT_EQ(1, CountFiles());
+}
+
+TEST_F(WritableMappedFileTest, CreateReplacesFile) {
+  ASSERT_TRUE(WriteFile(path_, "old"));
+  WritableMappedFile file;
+  ASSERT_TRUE(
+      file.Initialize(path_, kCapacity, WritableMappedFile::Mode::kCreate));
+  EXPECT_EQ(0u, file.length());
+  ASSERT_TRUE(file.Append(AsBytes("new")));
+  EXPECT_EQ("old", ReadFile());
+  EXPECT_TRUE(file.Commit());
+  EXPECT_EQ("new", ReadFile());
+}
+
+TEST_F(WritableMappedFileTest, AppendToFile) {
+  ASSERT_TRUE(WriteFile(path_, "old"));
+  WritableMappedFile file;
+  ASSERT_TRUE(
+      file.Initialize(path_, kCapacity, WritableMappedFile::Mode::kAppend));
+  ASSERT_EQ(3u, file.length());
+  EXPECT_EQ("old", StringPiece(reinterpret_cast<const char*>(file.data()),
+                               file.length()));
+  ASSERT_TRUE(file.Append(AsBytes("new")));
+  EXPECT_TRUE(file.Commit());
+  EXPECT_EQ("oldnew", ReadFile());
+}
+
+TEST_F(WritableMappedFileTest, AppendToMissingFile) {
+  WritableMappedFile file;
+  ASSERT_TRUE(
+      file.Initialize(path_, kCapacity, WritableMappedFile::Mode::kAppend));
+  EXPECT_EQ(0u, file.length());
+  EXPECT_TRUE(file.Commit());
+  EXPECT_EQ("", ReadFile());
+}
+
+TEST_F(WritableMappedFileTest, SetLength) {
+  WritableMappedFile file;
+  ASSERT_TRUE(
+      file.Initialize(path_, kCapacity, WritableMappedFile::Mode::kCreate));
+  ASSERT_TRUE(file.Append(AsBytes("foobar")));
+  ASSERT_TRUE(file.SetLength(2));
+  // The bytes dropped and added back are zeroes.
+  ASSERT_TRUE(file.SetLength(4));
+  EXPECT_EQ(std::string("fo\0\0", 4),
+            std::string(reinterpret_cast<const char*>(file.data()),
+                        file.length()));
+  EXPECT_TRUE(file.Commit());
+  EXPECT_EQ(std::string("fo\0\0", 4), ReadFile());
+}
+
+TEST_F(WritableMappedFileTest, Capacity) {
+  WritableMappedFile file;
+  ASSERT_TRUE(file.Initialize(path_, 1, WritableMappedFile::Mode::kCreate));
+  const size_t capacity = file.capacity();
+  EXPECT_GE(capacity, 1u);
+  EXPECT_TRUE(file.SetLength(capacity));
+  EXPECT_FALSE(file.SetLength(capacity + 1));
+  EXPECT_FALSE(file.Append(AsBytes("x")));
+  EXPECT_EQ(capacity, file.length());
+  EXPECT_TRUE(file.Commit());
+  EXPECT_EQ(std::string(capacity, '\0'), ReadFile());
+}
+
+TEST_F(WritableMappedFileTest, AppendTooLargeFile) {
+  ASSERT_TRUE(WriteFile(path_, std::string(2 * kCapacity, 'x')));
+  WritableMappedFile file;
+  EXPECT_FALSE(
+      file.Initialize(path_, kCapacity, WritableMappedFile::Mode::kAppend));
+  EXPECT_FALSE(file.IsValid());
+  EXPECT_EQ(1, CountFiles());
+}
+
+TEST_F(WritableMappedFileTest, DiscardWithoutCommit) {
+  ASSERT_TRUE(WriteFile(path_, "old"));
+  {
+    WritableMappedFile file;
+    ASSERT_TRUE(
+        file.Initialize(path_, kCapacity, WritableMappedFile::Mode::kCreate));
+    ASSERT_TRUE(file.Append(AsBytes("new")));
+    EXPECT_EQ(2, CountFiles());
+  }
+  EXPECT_EQ("old", ReadFile());
+  EXPECT_EQ(1, CountFiles());
+}
+
+}  // namespace base
@@ -0,0 +1,250 @@
+// Copyright 2022 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#ifndef BASE_FLAT_CALLBACK_LIST_H_
+#define BASE_FLAT_CALLBACK_LIST_H_
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include <algorithm>
+#include <tuple>
+#include <utility>
+#include <vector>
+
+#include "base/auto_reset.h"
+#include "base/bind.h"
+#include "base/callback.h"
+#include "base/callback_list.h"
+#include "base/check.h"
+#include "base/containers/cxx20_erase_vector.h"
+#include "base/location.h"
+#include "base/memory/weak_ptr.h"
+#include "base/task/parallel_for.h"
+#include "base/task/task_traits.h"
+
+namespace base {
+
+// A RepeatingCallbackList which stores its callbacks contiguously, for the
+// lists of thousands of callbacks which are notified often, e.g. event buses,
+// where iterating over the nodes of a std::list dominates Notify().
+//
+//   using FooCallbackList = base::FlatRepeatingCallbackList<void(const Foo&)>;
+//
+//   CallbackListSubscription subscription = foo_callback_list.Add(
+//       base::BindRepeating(&OnFoo, base::Unretained(this)));
+//   ...
+//   foo_callback_list.Notify(foo);
+//
+// Subscriptions work like those of RepeatingCallbackList. A callback canceled
+// during Notify() is reset in place, as a tombstone, and the tombstones are
+// compacted away once the outermost Notify() returns. Outside of Notify(), the
+// tombstones are compacted once they're half of the list, so that canceling
+// costs an amortized O(log n).
+//
+// Unlike RepeatingCallbackList, Notify() only runs the callbacks which were
+// added before it started: the callbacks which are added during Notify() are
+// first notified by the next Notify().
+//
+// Callbacks added with ThreadSafety::kThreadSafe can be notified concurrently
+// with NotifyParallel(). They must then not add callbacks to, or cancel them
+// from, the list.
+//
+// Like RepeatingCallbackList, the list is sequence-affine, and must not be
+// destroyed during Notify().
+template <typename Signature>
+class FlatRepeatingCallbackList {
+ public:
+  using CallbackType = RepeatingCallback<Signature>;
+
+  enum class ThreadSafety {
+    // The callback runs on the sequence of the list.
+    kSequenceBound,
+    // The callback may run on the ThreadPool, concurrently with the other
+    // thread-safe callbacks, in NotifyParallel().
+    kThreadSafe,
+  };
+
+  FlatRepeatingCallbackList() = default;
+  FlatRepeatingCallbackList(const FlatRepeatingCallbackList&) = delete;
+  FlatRepeatingCallbackList& operator=(const FlatRepeatingCallbackList&) =
+      delete;
+  ~FlatRepeatingCallbackList() {
+    // Destroying the list during iteration is unsupported and will cause a UAF.
+    CHECK(!iterating_);
+  }
+
+  // Registers |cb| for future notifications. Returns a CallbackListSubscription
+  // whose destruction will cancel |cb|.
+  [[nodiscard]] CallbackListSubscription Add(
+      CallbackType cb,
+      ThreadSafety thread_safety = ThreadSafety::kSequenceBound) {
+    DCHECK(!cb.is_null());
+    DCHECK(!notifying_in_parallel_);
+    const uint64_t id = next_id_++;
+    entries_.push_back(
+        {std::move(cb), id, thread_safety == ThreadSafety::kThreadSafe});
+    ++live_count_;
+    return CallbackListSubscription(
+        BindOnce(&FlatRepeatingCallbackList::CancelCallback,
+                 weak_ptr_factory_.GetWeakPtr(), id));
+  }
+
+  // Registers |removal_callback| to be run after elements are removed from the
+  // list of registered callbacks.
+  void set_removal_callback(const RepeatingClosure& removal_callback) {
+    removal_callback_ = removal_callback;
+  }
+
+  // Returns whether no callbacks remain live, in O(1).
+  bool empty() const { return live_count_ == 0; }
+
+  // Calls all registered callbacks that are not canceled beforehand, in the
+  // order of their registration. If any callbacks are canceled during the
+  // notification, runs the removal callback at the end.
+  //
+  // Arguments must be copyable, since they're passed to all callbacks. Like
+  // RepeatingCallbackList::Notify(), Notify() may be called re-entrantly.
+  template <typename... RunArgs>
+  void Notify(RunArgs&&... args) {
+    DCHECK(!notifying_in_parallel_);
+    if (empty())
+      return;
+
+    {
+      AutoReset<bool> iterating(&iterating_, true);
+      // Indices stay valid across the callbacks: they only append to the
+      // list, or reset callbacks.
+      const size_t size = entries_.size();
+      for (size_t i = 0; i < size; ++i) {
+        if (entries_[i].callback) {
+          // NOTE: Intentionally does not call std::forward<RunArgs>(args)...,
+          // since that would allow move-only arguments.
+          entries_[i].callback.Run(args...);
+        }
+      }
+    }
+    FinishNotify();
+  }
+
+  // Like Notify(), but runs the thread-safe callbacks concurrently with
+  // ParallelFor(), in chunks of at least |grain_size| callbacks, once the
+  // sequence-bound callbacks were run on the calling sequence. Returns when
+  // all callbacks have returned. The arguments are shared by the threads, so
+  // they must be safe to read concurrently.
+  template <typename... RunArgs>
+  void NotifyParallel(const Location& from_here,
+                      const TaskTraits& traits,
+                      size_t grain_size,
+                      RunArgs&&... args) {
+    DCHECK(!notifying_in_parallel_);
+    if (empty())
+      return;
+
+    {
+      AutoReset<bool> iterating(&iterating_, true);
+      const size_t size = entries_.size();
+      for (size_t i = 0; i < size; ++i) {
+        if (entries_[i].callback && !entries_[i].thread_safe)
+          entries_[i].callback.Run(args...);
+      }
+
+      // The thread-safe callbacks neither add entries nor cancel them, so
+      // |entries_| is read-only while they run.
+      AutoReset<bool> notifying_in_parallel(&notifying_in_parallel_, true);
+      const std::tuple<RunArgs&...> run_args(args...);
+      ParallelFor(
+          from_here, traits, 0, size, grain_size,
+          BindRepeating(
+              [](const std::vector<Entry>* entries,
+                 const std::tuple<RunArgs&...>* run_args, size_t chunk_begin,
+                 size_t chunk_end) {
+                for (size_t i = chunk_begin; i < chunk_end; ++i) {
+                  const Entry& entry = (*entries)[i];
+                  if (!entry.callback || !entry.thread_safe)
+                    continue;
+                  std::apply(
+                      [&entry](RunArgs&... args) {
+                        entry.callback.Run(args...);
+                      },
+                      *run_args);
+                }
+              },
+              Unretained(&entries_), Unretained(&run_args)));
+    }
+    FinishNotify();
+  }
+
+ private:
+  struct Entry {
+    CallbackType callback;
+    // Increases along |entries_|, so that CancelCallback() finds the entry of
+    // a subscription with a binary search.
+    uint64_t id;
+    bool thread_safe;
+  };
+
+  // Compacts the tombstones once the outermost Notify() is done, and runs the
+  // removal callback if callbacks were canceled during the notification.
+  void FinishNotify() {
+    // Re-entrant invocations leave the tombstones to the outermost one, since
+    // compacting would move the entries from under it.
+    if (iterating_)
+      return;
+    if (tombstone_count_)
+      Compact();
+    if (canceled_during_iteration_) {
+      canceled_during_iteration_ = false;
+      if (removal_callback_)
+        removal_callback_.Run();  // May delete |this|!
+    }
+  }
+
+  void CancelCallback(uint64_t id) {
+    DCHECK(!notifying_in_parallel_);
+    auto it = std::lower_bound(
+        entries_.begin(), entries_.end(), id,
+        [](const Entry& entry, uint64_t id) { return entry.id < id; });
+    DCHECK(it != entries_.end() && it->id == id);
+    DCHECK(it->callback);
+    it->callback.Reset();
+    --live_count_;
+    ++tombstone_count_;
+
+    if (iterating_) {
+      canceled_during_iteration_ = true;
+      return;
+    }
+    if (tombstone_count_ > entries_.size() / 2)
+      Compact();
+    if (removal_callback_)
+      removal_callback_.Run();  // May delete |this|!
+  }
+
+  void Compact() {
+    DCHECK(!iterating_);
+    EraseIf(entries_, [](const Entry& entry) { return !entry.callback; });
+    tombstone_count_ = 0;
+  }
+
+  std::vector<Entry> entries_;
+  uint64_t next_id_ = 0;
+  size_t live_count_ = 0;
+  size_t tombstone_count_ = 0;
+
+  // Set while Notify() is traversing |entries_|, so that it's not compacted.
+  bool iterating_ = false;
+  // Set while the thread-safe callbacks run, which must not modify the list.
+  bool notifying_in_parallel_ = false;
+  bool canceled_during_iteration_ = false;
+
+  // Called after elements are removed from |entries_|.
+  RepeatingClosure removal_callback_;
+
+  WeakPtrFactory<FlatRepeatingCallbackList> weak_ptr_factory_{this};
+};
+
+}  // namespace base
+
+#endif  // BASE_FLAT_CALLBACK_LIST_H_
@@ -0,0 +1,79 @@
+// Copyright 2022 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "base/flat_callback_list.h"
+
+#include <string>
+#include <vector>
+
+#include "base/bind.h"
+#include "base/callback_list.h"
+#include "base/strings/stringprintf.h"
+#include "base/time/time.h"
+#include "testing/gtest/include/gtest/gtest.h"
+#include "testing/perf/perf_result_reporter.h"
+
+namespace base {
+
+namespace {
+
+constexpr char kMetricPrefixCallbackList[] = "CallbackList.";
+constexpr char kMetricNotifyTimePerCallback[] = "notify_time_per_callback";
+
+perf_test::PerfResultReporter SetUpReporter(const std::string& story_name) {
+  perf_test::PerfResultReporter reporter(kMetricPrefixCallbackList,
+                                         story_name);
+  reporter.RegisterImportantMetric(kMetricNotifyTimePerCallback, "ns");
+  return reporter;
+}
+
+void Increment(int* counter) {
+  ++*counter;
+}
+
+// Measures Notify() on lists of up to kMaxCallbacks callbacks, with the
+// subscriptions of every other callback destroyed, as they are over time in
+// the event buses.
+template <typename CallbackListType>
+void RunNotifyTest(const char* name) {
+  constexpr int kMaxCallbacks = 16384;
+  constexpr int kCalls = 10000000;
+  for (int callback_count = 16; callback_count <= kMaxCallbacks;
+       callback_count *= 4) {
+    CallbackListType list;
+    int counter = 0;
+    std::vector<CallbackListSubscription> subscriptions;
+    for (int i = 0; i < 2 * callback_count; ++i) {
+      subscriptions.push_back(
+          list.Add(BindRepeating(&Increment, Unretained(&counter))));
+    }
+    for (int i = 0; i < 2 * callback_count; i += 2)
+      subscriptions[i] = {};
+
+    const int laps = kCalls / callback_count;
+    const TimeTicks start = TimeTicks::Now();
+    for (int i = 0; i < laps; ++i)
+      list.Notify();
+    const TimeDelta duration = TimeTicks::Now() - start;
+    EXPECT_EQ(laps * callback_count, counter);
+
+    auto reporter =
+        SetUpReporter(StringPrintf("%s_%d", name, callback_count));
+    reporter.AddResult(kMetricNotifyTimePerCallback,
+                       duration.InNanoseconds() / static_cast<double>(counter));
+  }
+}
+
+}  // namespace
+
+TEST(CallbackListPerfTest, RepeatingCallbackList) {
+  RunNotifyTest<RepeatingClosureList>("RepeatingCallbackList");
+}
+
+TEST(CallbackListPerfTest, FlatRepeatingCallbackList) {
+  RunNotifyTest<FlatRepeatingCallbackList<void()>>(
+      "FlatRepeatingCallbackList");
+}
+
+}  // namespace base
@@ -0,0 +1,185 @@
+// Copyright 2022 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "base/flat_callback_list.h"
+
+#include <algorithm>
+#include <atomic>
+#include <utility>
+#include <vector>
+
+#include "base/bind.h"
+#include "base/test/bind.h"
+#include "base/test/task_environment.h"
+#include "base/threading/platform_thread.h"
+#include "testing/gmock/include/gmock/gmock.h"
+#include "testing/gtest/include/gtest/gtest.h"
+
+using ::testing::ElementsAre;
+
+namespace base {
+namespace {
+
+using IntCallbackList = FlatRepeatingCallbackList<void(int)>;
+
+void Append(std::vector<int>* values, int offset, int value) {
+  values->push_back(offset + value);
+}
+
+}  // namespace
+
+TEST(FlatCallbackListTest, Basic) {
+  IntCallbackList list;
+  EXPECT_TRUE(list.empty());
+  std::vector<int> values;
+  CallbackListSubscription a =
+      list.Add(BindRepeating(&Append, Unretained(&values), 0));
+  CallbackListSubscription b =
+      list.Add(BindRepeating(&Append, Unretained(&values), 10));
+  EXPECT_FALSE(list.empty());
+
+  list.Notify(1);
+  EXPECT_THAT(values, ElementsAre(1, 11));
+
+  a = {};
+  values.clear();
+  list.Notify(2);
+  EXPECT_THAT(values, ElementsAre(12));
+
+  b = {};
+  EXPECT_TRUE(list.empty());
+  values.clear();
+  list.Notify(3);
+  EXPECT_TRUE(values.empty());
+}
+
+TEST(FlatCallbackListTest, CompactionKeepsOrder) {
+  IntCallbackList list;
+  int removals = 0;
+  list.set_removal_callback(
+      BindLambdaForTesting([&removals] { ++removals; }));
+  std::vector<int> values;
+  std::vector<CallbackListSubscription> subscriptions;
+  for (int i = 0; i < 100; ++i) {
+    subscriptions.push_back(
+        list.Add(BindRepeating(&Append, Unretained(&values), i * 100)));
+  }
+  // Cancels the odd ones, which compacts the list on the way.
+  for (int i = 1; i < 100; i += 2)
+    subscriptions[i] = {};
+  EXPECT_EQ(50, removals);
+
+  list.Notify(0);
+  ASSERT_EQ(50u, values.size());
+  for (int i = 0; i < 50; ++i)
+    EXPECT_EQ(i * 200, values[i]);
+
+  // The remaining subscriptions still cancel their own callbacks.
+  subscriptions[50] = {};
+  values.clear();
+  list.Notify(0);
+  EXPECT_EQ(49u, values.size());
+  EXPECT_EQ(values.end(), std::find(values.begin(), values.end(), 5000));
+}
+
+TEST(FlatCallbackListTest, RemoveCallbacksDuringIteration) {
+  FlatRepeatingCallbackList<void()> list;
+  int removals = 0;
+  list.set_removal_callback(
+      BindLambdaForTesting([&removals] { ++removals; }));
+
+  int runs = 0;
+  CallbackListSubscription second;
+  // The first callback cancels itself and the second one.
+  CallbackListSubscription first;
+  first = list.Add(BindLambdaForTesting([&] {
+    ++runs;
+    first = {};
+    second = {};
+  }));
+  second = list.Add(BindLambdaForTesting([&] { ADD_FAILURE(); }));
+  CallbackListSubscription third =
+      list.Add(BindLambdaForTesting([&] { ++runs; }));
+
+  list.Notify();
+  EXPECT_EQ(2, runs);
+  // The removal callback runs once, after the notification.
+  EXPECT_EQ(1, removals);
+
+  list.Notify();
+  EXPECT_EQ(3, runs);
+}
+
+TEST(FlatCallbackListTest, AddCallbacksDuringIteration) {
+  FlatRepeatingCallbackList<void()> list;
+  int added_runs = 0;
+  std::vector<CallbackListSubscription> added;
+  CallbackListSubscription adder = list.Add(BindLambdaForTesting([&] {
+    added.push_back(list.Add(BindLambdaForTesting([&] { ++added_runs; })));
+  }));
+
+  // The callbacks added during a notification are notified by the next one.
+  list.Notify();
+  EXPECT_EQ(0, added_runs);
+  list.Notify();
+  EXPECT_EQ(1, added_runs);
+  EXPECT_EQ(2u, added.size());
+}
+
+TEST(FlatCallbackListTest, ReentrantNotify) {
+  IntCallbackList list;
+  std::vector<int> values;
+  CallbackListSubscription a = list.Add(BindLambdaForTesting([&](int value) {
+    values.push_back(value);
+    if (value == 0)
+      list.Notify(1);
+  }));
+  CallbackListSubscription b = list.Add(BindLambdaForTesting([&](int value) {
+    values.push_back(10 + value);
+    // Cancels |a| in the nested notification, which leaves the tombstone to
+    // the outer one.
+    if (value == 1)
+      a = {};
+  }));
+
+  list.Notify(0);
+  EXPECT_THAT(values, ElementsAre(0, 1, 11, 10));
+  values.clear();
+  list.Notify(2);
+  EXPECT_THAT(values, ElementsAre(12));
+}
+
+TEST(FlatCallbackListTest, NotifyParallel) {
+  test::TaskEnvironment task_environment;
+  IntCallbackList list;
+  const PlatformThreadRef main_thread = PlatformThread::CurrentRef();
+  std::atomic<int> thread_safe_sum{0};
+  int sequence_bound_sum = 0;
+  std::vector<CallbackListSubscription> subscriptions;
+  for (int i = 0; i < 1000; ++i) {
+    if (i % 10) {
+      subscriptions.push_back(list.Add(
+          BindLambdaForTesting([&thread_safe_sum](int value) {
+            thread_safe_sum.fetch_add(value, std::memory_order_relaxed);
+          }),
+          IntCallbackList::ThreadSafety::kThreadSafe));
+    } else {
+      subscriptions.push_back(list.Add(BindLambdaForTesting([&](int value) {
+        EXPECT_EQ(main_thread, PlatformThread::CurrentRef());
+        sequence_bound_sum += value;
+      })));
+    }
+  }
+
+  list.NotifyParallel(FROM_HERE, {}, 16, 2);
+  EXPECT_EQ(900 * 2, thread_safe_sum.load());
+  EXPECT_EQ(100 * 2, sequence_bound_sum);
+
+  // Notify() runs all of them on the calling sequence.
+  list.Notify(1);
+  EXPECT_EQ(900 * 3, thread_safe_sum.load());
+  EXPECT_EQ(100 * 3, sequence_bound_sum);
+}
+
+}  // namespace base
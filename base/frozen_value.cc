@@ -0,0 +1,282 @@
+// Copyright 2022 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "base/frozen_value.h"
+
+#include <atomic>
+#include <functional>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "base/check.h"
+#include "base/check_op.h"
+#include "base/containers/flat_map.h"
+#include "base/memory/ref_counted.h"
+
+namespace base {
+
+// A node of the tree. Dictionaries and lists hold their entries as
+// `FrozenValue`s, which share the nodes below them. Other types hold their
+// `Value`.
+class FrozenValue::Node : public RefCountedThreadSafe<Node> {
+ public:
+  explicit Node(Value value) : type(value.type()) {
+    switch (type) {
+      case Value::Type::DICT: {
+        std::vector<std::pair<std::string, FrozenValue>> entries;
+        entries.reserve(value.GetDict().size());
+        // `Value::Dict` iterates in key order.
+        for (auto [key, entry] : value.GetDict())
+          entries.emplace_back(key, FrozenValue(std::move(entry)));
+        dict = Dict(sorted_unique, std::move(entries));
+        break;
+      }
+      case Value::Type::LIST:
+        list.reserve(value.GetList().size());
+        for (Value& entry : value.GetList())
+          list.emplace_back(std::move(entry));
+        break;
+      default:
+        scalar = std::move(value);
+        break;
+    }
+  }
+
+  // Copies the node alone: the copy shares the nodes below it.
+  Node(const Node& other)
+      : type(other.type),
+        scalar(other.scalar.Clone()),
+        dict(other.dict),
+        list(other.list) {}
+
+  Node& operator=(const Node&) = delete;
+
+  const Value& GetValue() const {
+    if (type != Value::Type::DICT && type != Value::Type::LIST)
+      return scalar;
+    const Value* value = value_.load(std::memory_order_acquire);
+    if (value)
+      return *value;
+    // Nodes are shared across sequences: the first one to finish building the
+    // value keeps it.
+    auto new_value = std::make_unique<Value>(ToValue());
+    if (value_.compare_exchange_strong(value, new_value.get(),
+                                       std::memory_order_acq_rel,
+                                       std::memory_order_acquire)) {
+      return *new_value.release();
+    }
+    return *value;
+  }
+
+  Value ToValue() const {
+    if (const Value* value = value_.load(std::memory_order_acquire))
+      return value->Clone();
+    switch (type) {
+      case Value::Type::DICT: {
+        Value::Dict value;
+        for (const auto& [key, entry] : dict)
+          value.Set(key, entry.ToValue());
+        return Value(std::move(value));
+      }
+      case Value::Type::LIST: {
+        Value::List value;
+        for (const FrozenValue& entry : list)
+          value.Append(entry.ToValue());
+        return Value(std::move(value));
+      }
+      default:
+        return scalar.Clone();
+    }
+  }
+
+  // Must be called before modifying a node, which only its owner can do.
+  void ResetValue() {
+    DCHECK(HasOneRef());
+    delete value_.exchange(nullptr, std::memory_order_relaxed);
+  }
+
+  using Dict = flat_map<std::string, FrozenValue, std::less<>>;
+
+  const Value::Type type;
+  Value scalar;
+  Dict dict;
+  std::vector<FrozenValue> list;
+
+ private:
+  friend class RefCountedThreadSafe<Node>;
+  ~Node() { delete value_.load(std::memory_order_relaxed); }
+
+  // The `Value` of a dictionary or a list, once built.
+  mutable std::atomic<const Value*> value_{nullptr};
+};
+
+FrozenValue::FrozenValue() : FrozenValue(Value()) {}
+
+FrozenValue::FrozenValue(Value value)
+    : node_(MakeRefCounted<Node>(std::move(value))) {}
+
+FrozenValue::FrozenValue(const FrozenValue& other) = default;
+
+FrozenValue::FrozenValue(FrozenValue&& other) noexcept = default;
+
+FrozenValue& FrozenValue::operator=(const FrozenValue& other) = default;
+
+FrozenValue& FrozenValue::operator=(FrozenValue&& other) noexcept = default;
+
+FrozenValue::~FrozenValue() = default;
+
+Value::Type FrozenValue::type() const {
+  return node_->type;
+}
+
+const Value& FrozenValue::value() const {
+  return node_->GetValue();
+}
+
+Value FrozenValue::ToValue() const {
+  return node_->ToValue();
+}
+
+size_t FrozenValue::size() const {
+  switch (type()) {
+    case Value::Type::DICT:
+      return node_->dict.size();
+    case Value::Type::LIST:
+      return node_->list.size();
+    default:
+      return 0;
+  }
+}
+
+const FrozenValue* FrozenValue::Find(StringPiece key) const {
+  if (!is_dict())
+    return nullptr;
+  auto it = node_->dict.find(key);
+  return it != node_->dict.end() ? &it->second : nullptr;
+}
+
+const FrozenValue* FrozenValue::FindByDottedPath(StringPiece path) const {
+  DCHECK(!path.empty());
+  const FrozenValue* current = this;
+  while (true) {
+    const size_t dot_index = path.find('.');
+    current = current->Find(path.substr(0, dot_index));
+    if (!current || dot_index == StringPiece::npos)
+      return current;
+    path = path.substr(dot_index + 1);
+  }
+}
+
+const FrozenValue& FrozenValue::operator[](size_t index) const {
+  CHECK(is_list());
+  CHECK_LT(index, node_->list.size());
+  return node_->list[index];
+}
+
+void FrozenValue::Set(StringPiece key, Value value) {
+  Set(key, FrozenValue(std::move(value)));
+}
+
+void FrozenValue::Set(StringPiece key, FrozenValue value) {
+  CHECK(is_dict());
+  GetMutableNode()->dict.insert_or_assign(key, std::move(value));
+}
+
+bool FrozenValue::SetByDottedPath(StringPiece path, Value value) {
+  return SetByDottedPath(path, FrozenValue(std::move(value)));
+}
+
+bool FrozenValue::SetByDottedPath(StringPiece path, FrozenValue value) {
+  DCHECK(!path.empty());
+  if (!is_dict())
+    return false;
+  const size_t dot_index = path.find('.');
+  if (dot_index == StringPiece::npos) {
+    Set(path, std::move(value));
+    return true;
+  }
+
+  // Like `Value::Dict::SetByDottedPath()`, fail on an intermediate entry that
+  // isn't a dictionary, and create the missing ones.
+  const StringPiece key = path.substr(0, dot_index);
+  const FrozenValue* entry = Find(key);
+  if (entry && !entry->is_dict())
+    return false;
+  Node* const node = GetMutableNode();
+  auto it = node->dict.find(key);
+  if (it == node->dict.end()) {
+    it = node->dict
+             .emplace(std::string(key), FrozenValue(Value(Value::Type::DICT)))
+             .first;
+  }
+  return it->second.SetByDottedPath(path.substr(dot_index + 1),
+                                    std::move(value));
+}
+
+bool FrozenValue::Remove(StringPiece key) {
+  if (!Find(key))
+    return false;
+  Node* const node = GetMutableNode();
+  node->dict.erase(node->dict.find(key));
+  return true;
+}
+
+bool FrozenValue::RemoveByDottedPath(StringPiece path) {
+  DCHECK(!path.empty());
+  const size_t dot_index = path.find('.');
+  if (dot_index == StringPiece::npos)
+    return Remove(path);
+
+  // Don't copy the path to an entry that isn't there.
+  if (!FindByDottedPath(path))
+    return false;
+
+  // Like `Value::Dict::RemoveByDottedPath()`, remove the dictionaries that
+  // become empty.
+  Node* const node = GetMutableNode();
+  auto it = node->dict.find(path.substr(0, dot_index));
+  const bool removed =
+      it->second.RemoveByDottedPath(path.substr(dot_index + 1));
+  DCHECK(removed);
+  if (it->second.size() == 0)
+    node->dict.erase(it);
+  return true;
+}
+
+void FrozenValue::Append(Value value) {
+  Append(FrozenValue(std::move(value)));
+}
+
+void FrozenValue::Append(FrozenValue value) {
+  CHECK(is_list());
+  GetMutableNode()->list.push_back(std::move(value));
+}
+
+bool operator==(const FrozenValue& lhs, const FrozenValue& rhs) {
+  if (lhs.node_ == rhs.node_)
+    return true;
+  const FrozenValue::Node& lhs_node = *lhs.node_;
+  const FrozenValue::Node& rhs_node = *rhs.node_;
+  if (lhs_node.type != rhs_node.type)
+    return false;
+  switch (lhs_node.type) {
+    case Value::Type::DICT:
+      return lhs_node.dict == rhs_node.dict;
+    case Value::Type::LIST:
+      return lhs_node.list == rhs_node.list;
+    default:
+      return lhs_node.scalar == rhs_node.scalar;
+  }
+}
+
+FrozenValue::Node* FrozenValue::GetMutableNode() {
+  if (node_->HasOneRef())
+    node_->ResetValue();
+  else
+    node_ = MakeRefCounted<Node>(*node_);
+  return node_.get();
+}
+
+}  // namespace base
@@ -0,0 +1,109 @@
+// Copyright 2022 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#ifndef BASE_FROZEN_VALUE_H_
+#define BASE_FROZEN_VALUE_H_
+
+#include <stddef.h>
+
+#include "base/base_export.h"
+#include "base/memory/scoped_refptr.h"
+#include "base/strings/string_piece.h"
+#include "base/values.h"
+
+namespace base {
+
+// A `Value` tree whose copies share their subtrees. Copying (or `Clone()`-ing)
+// a `FrozenValue` is O(1), and modifying it copies only the dictionaries and
+// lists on the path to the modification, leaving the other copies unchanged.
+// This suits large trees of which many snapshots are taken, e.g. the state of
+// a configuration system handed to each of its consumers:
+//
+//   FrozenValue config(Value(std::move(dict)));  // O(size of `dict`), once.
+//   FrozenValue snapshot = config;                // O(1).
+//   config.SetByDottedPath("a.b", Value(1));      // Copies the root and "a".
+//
+// `value()` returns the equivalent `Value`, so that a `FrozenValue` can be
+// passed as a `ValueView` to JSONWriter and the other `ValueView` consumers.
+// It is built the first time it's needed for a dictionary or a list, and kept
+// until the `FrozenValue` is modified: avoid it on hot paths, and prefer
+// `Find()` and `operator[]` to read parts of the tree.
+//
+// Copies of a `FrozenValue` can be used on different sequences, but a given
+// instance isn't thread-safe. As with `Value`, modifying a `FrozenValue`
+// invalidates the pointers and references previously returned by its methods.
+class BASE_EXPORT FrozenValue {
+ public:
+  // A NONE value.
+  FrozenValue();
+  // Freezes `value`, in O(size of `value`).
+  explicit FrozenValue(Value value);
+  FrozenValue(const FrozenValue& other);
+  FrozenValue(FrozenValue&& other) noexcept;
+  FrozenValue& operator=(const FrozenValue& other);
+  FrozenValue& operator=(FrozenValue&& other) noexcept;
+  ~FrozenValue();
+
+  // Same as a copy. O(1).
+  FrozenValue Clone() const { return *this; }
+
+  Value::Type type() const;
+  bool is_dict() const { return type() == Value::Type::DICT; }
+  bool is_list() const { return type() == Value::Type::LIST; }
+
+  // The equivalent `Value`. See the class comment for its cost.
+  const Value& value() const;
+
+  // Returns a new `Value` equivalent to this one, in O(size).
+  Value ToValue() const;
+
+  // Allows passing a `FrozenValue` wherever a `ValueView` is expected.
+  operator ValueView() const { return value(); }  // NOLINT(runtime/explicit)
+
+  // The number of entries of a dictionary or a list, 0 otherwise.
+  size_t size() const;
+
+  // Returns the entry `key` of a dictionary, or null if there is none or if
+  // this isn't a dictionary. `FindByDottedPath()` looks `path` up through
+  // intermediate dictionaries, like `Value::Dict::FindByDottedPath()`.
+  const FrozenValue* Find(StringPiece key) const;
+  const FrozenValue* FindByDottedPath(StringPiece path) const;
+
+  // Returns the element `index` of a list. CHECKs that this is a list and that
+  // `index` is in range.
+  const FrozenValue& operator[](size_t index) const;
+
+  // Modifiers of a dictionary, like the `Value::Dict` methods of the same
+  // names. `Set()` CHECKs that this is a dictionary. `SetByDottedPath()`
+  // returns false if this or an intermediate entry isn't a dictionary.
+  void Set(StringPiece key, Value value);
+  void Set(StringPiece key, FrozenValue value);
+  bool SetByDottedPath(StringPiece path, Value value);
+  bool SetByDottedPath(StringPiece path, FrozenValue value);
+  bool Remove(StringPiece key);
+  bool RemoveByDottedPath(StringPiece path);
+
+  // Appends `value` to a list. CHECKs that this is a list.
+  void Append(Value value);
+  void Append(FrozenValue value);
+
+  // Compares the trees, skipping the subtrees they share.
+  friend BASE_EXPORT bool operator==(const FrozenValue& lhs,
+                                     const FrozenValue& rhs);
+  friend bool operator!=(const FrozenValue& lhs, const FrozenValue& rhs) {
+    return !(lhs == rhs);
+  }
+
+ private:
+  class Node;
+
+  // Returns the root node, after copying it unless this is its only owner.
+  Node* GetMutableNode();
+
+  scoped_refptr<Node> node_;
+};
+
+}  // namespace base
+
+#endif  // BASE_FROZEN_VALUE_H_
@@ -0,0 +1,141 @@
+// Copyright 2022 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "base/frozen_value.h"
+
+#include <string>
+#include <utility>
+
+#include "base/json/json_reader.h"
+#include "base/json/json_writer.h"
+#include "testing/gtest/include/gtest/gtest.h"
+
+namespace base {
+
+namespace {
+
+Value ParseJson(StringPiece json) {
+  absl::optional<Value> value = JSONReader::Read(json);
+  CHECK(value);
+  return std::move(*value);
+}
+
+constexpr char kJson[] =
+    R"({"a":{"b":1,"c":[true,"x"]},"d":{"e":2.5},"f":"g"})";
+
+}  // namespace
+
+TEST(FrozenValueTest, Default) {
+  FrozenValue value;
+  EXPECT_EQ(Value::Type::NONE, value.type());
+  EXPECT_EQ(Value(), value.value());
+  EXPECT_EQ(0u, value.size());
+  EXPECT_EQ(nullptr, value.Find("a"));
+}
+
+TEST(FrozenValueTest, FreezeAndThaw) {
+  FrozenValue value(ParseJson(kJson));
+  EXPECT_TRUE(value.is_dict());
+  EXPECT_EQ(3u, value.size());
+  EXPECT_EQ(ParseJson(kJson), value.value());
+  EXPECT_EQ(ParseJson(kJson), value.ToValue());
+
+  ASSERT_TRUE(value.FindByDottedPath("a.c"));
+  const FrozenValue& list = *value.FindByDottedPath("a.c");
+  EXPECT_TRUE(list.is_list());
+  ASSERT_EQ(2u, list.size());
+  EXPECT_EQ(Value(true), list[0].value());
+  EXPECT_EQ(Value("x"), list[1].value());
+  EXPECT_EQ(Value(2.5), value.FindByDottedPath("d.e")->value());
+  EXPECT_EQ(nullptr, value.FindByDottedPath("a.b.c"));
+  EXPECT_EQ(nullptr, value.FindByDottedPath("a.z"));
+}
+
+TEST(FrozenValueTest, ValueView) {
+  FrozenValue value(ParseJson(kJson));
+  std::string json;
+  EXPECT_TRUE(JSONWriter::Write(value, &json));
+  EXPECT_EQ(kJson, json);
+}
+
+TEST(FrozenValueTest, CopiesAreIndependent) {
+  FrozenValue value(ParseJson(kJson));
+  FrozenValue snapshot = value.Clone();
+  EXPECT_EQ(snapshot, value);
+
+  EXPECT_TRUE(value.SetByDottedPath("h.i", Value("j")));
+  EXPECT_TRUE(value.RemoveByDottedPath("d.e"));
+  EXPECT_TRUE(snapshot.SetByDottedPath("a.c", Value()));
+
+  EXPECT_EQ(ParseJson(R"({"a":{"b":1,"c":[true,"x"]},"f":"g","h":{"i":"j"}})"),
+            value.value());
+  EXPECT_EQ(ParseJson(R"({"a":{"b":1,"c":null},"d":{"e":2.5},"f":"g"})"),
+            snapshot.value());
+}
+
+TEST(FrozenValueTest, CopiesShareUnmodifiedSubtrees) {
+  FrozenValue value(ParseJson(kJson));
+  const FrozenValue snapshot = value;
+
+  EXPECT_TRUE(value.SetByDottedPath("a.b", Value(2)));
+
+  // The path to the modification was copied...
+  EXPECT_NE(snapshot.Find("a"), value.Find("a"));
+  EXPECT_EQ(Value(1), snapshot.FindByDottedPath("a.b")->value());
+  EXPECT_EQ(Value(2), value.FindByDottedPath("a.b")->value());
+  // ... but not the rest of the tree.
+  EXPECT_EQ(&snapshot.FindByDottedPath("d.e")->value(),
+            &value.FindByDottedPath("d.e")->value());
+  EXPECT_EQ(&snapshot.FindByDottedPath("a.c")->value(),
+            &value.FindByDottedPath("a.c")->value());
+
+  EXPECT_EQ(ParseJson(kJson), snapshot.value());
+  EXPECT_EQ(ParseJson(R"({"a":{"b":2,"c":[true,"x"]},"d":{"e":2.5},"f":"g"})"),
+            value.value());
+  EXPECT_NE(snapshot, value);
+}
+
+TEST(FrozenValueTest, ModifyUniquelyOwned) {
+  FrozenValue value(ParseJson(kJson));
+  // Builds the value of the root, which the modifications must reset.
+  EXPECT_EQ(ParseJson(kJson), value.value());
+
+  value.Set("f", Value("h"));
+  EXPECT_TRUE(value.SetByDottedPath("d.x.y", Value(3)));
+  EXPECT_FALSE(value.SetByDottedPath("f.x", Value(4)));
+  EXPECT_EQ(ParseJson(R"({"a":{"b":1,"c":[true,"x"]},"d":{"e":2.5,"x":{"y":3}},
+                          "f":"h"})"),
+            value.value());
+
+  EXPECT_TRUE(value.Remove("f"));
+  EXPECT_FALSE(value.Remove("f"));
+  EXPECT_TRUE(value.RemoveByDottedPath("d.x.y"));
+  EXPECT_FALSE(value.RemoveByDottedPath("d.x.y"));
+  EXPECT_TRUE(value.RemoveByDottedPath("a.b"));
+  EXPECT_EQ(ParseJson(R"({"a":{"c":[true,"x"]},"d":{"e":2.5}})"),
+            value.value());
+
+  // Empty intermediate dictionaries are removed.
+  EXPECT_TRUE(value.RemoveByDottedPath("d.e"));
+  EXPECT_EQ(nullptr, value.Find("d"));
+}
+
+TEST(FrozenValueTest, List) {
+  FrozenValue list(Value(Value::Type::LIST));
+  list.Append(Value(1));
+  const FrozenValue snapshot = list;
+  list.Append(FrozenValue(ParseJson(kJson)));
+
+  EXPECT_EQ(1u, snapshot.size());
+  ASSERT_EQ(2u, list.size());
+  EXPECT_EQ(Value(1), list[0].value());
+  EXPECT_EQ(ParseJson(kJson), list[1].value());
+
+  FrozenValue dict(Value(Value::Type::DICT));
+  dict.Set("list", list);
+  EXPECT_EQ(ParseJson(std::string(R"({"list":[1,)") + kJson + "]}"),
+            dict.value());
+}
+
+}  // namespace base
@@ -9,9 +9,9 @@
 
 #include <ostream>
 
+#include "base/check_op.h"
 #include "base/rand_util.h"
 #include "base/strings/string_util.h"
-#include "base/strings/stringprintf.h"
 
 namespace base {
 
@@ -33,12 +33,11 @@ template <typename StringPieceType>
 std::string GetCanonicalGUIDInternal(StringPieceType input, bool strict) {
   using CharType = typename StringPieceType::value_type;
 
-  constexpr size_t kGUIDLength = 36;
-  if (input.length() != kGUIDLength)
+  if (input.length() != GUID::kStringLength)
     return std::string();
 
   std::string lowercase_;
-  lowercase_.resize(kGUIDLength);
+  lowercase_.resize(GUID::kStringLength);
   for (size_t i = 0; i < input.length(); ++i) {
     CharType current = input[i];
     if (IsHyphenPosition(i)) {
@@ -55,6 +54,32 @@ std::string GetCanonicalGUIDInternal(StringPieceType input, bool strict) {
   return lowercase_;
 }
 
+// Writes the string form of the GUID of |bytes| into |output|, in place of the
+// slower StringPrintf().
+void RandomDataToGUIDChars(const uint64_t bytes[2],
+                           char (&output)[GUID::kStringLength]) {
+  static constexpr char kHexDigits[] = "0123456789abcdef";
+  char* out = output;
+  // Writes the last |num_digits| hexadecimal digits of |value|.
+  auto write_hex = [&out](uint64_t value, int num_digits) {
+    for (int i = num_digits - 1; i >= 0; --i) {
+      out[i] = kHexDigits[value & 0xf];
+      value >>= 4;
+    }
+    out += num_digits;
+  };
+  write_hex(bytes[0] >> 32, 8);
+  *out++ = '-';
+  write_hex(bytes[0] >> 16, 4);
+  *out++ = '-';
+  write_hex(bytes[0], 4);
+  *out++ = '-';
+  write_hex(bytes[1] >> 48, 4);
+  *out++ = '-';
+  write_hex(bytes[1], 12);
+  DCHECK_EQ(out, output + GUID::kStringLength);
+}
+
 }  // namespace
 
 std::string GenerateGUID() {
@@ -75,15 +100,22 @@ bool IsValidGUIDOutputString(StringPiece input) {
 }
 
 std::string RandomDataToGUIDString(const uint64_t bytes[2]) {
-  return StringPrintf(
-      "%08x-%04x-%04x-%04x-%012llx", static_cast<uint32_t>(bytes[0] >> 32),
-      static_cast<uint32_t>((bytes[0] >> 16) & 0x0000ffff),
-      static_cast<uint32_t>(bytes[0] & 0x0000ffff),
-      static_cast<uint32_t>(bytes[1] >> 48), bytes[1] & 0x0000ffff'ffffffffULL);
+  char output[GUID::kStringLength];
+  RandomDataToGUIDChars(bytes, output);
+  return std::string(output, sizeof(output));
 }
 
 // static
 GUID GUID::GenerateRandomV4() {
+  char output[kStringLength];
+  GenerateRandomV4Into(output);
+  GUID guid;
+  guid.lowercase_.assign(output, sizeof(output));
+  return guid;
+}
+
+// static
+void GUID::GenerateRandomV4Into(char (&output)[kStringLength]) {
   uint64_t sixteen_bytes[2];
   // Use base::RandBytes instead of crypto::RandBytes, because crypto calls the
   // base version directly, and to prevent the dependency from base/ to crypto/.
@@ -102,9 +134,7 @@ GUID GUID::GenerateRandomV4() {
   sixteen_bytes[1] &= 0x3fffffff'ffffffffULL;
   sixteen_bytes[1] |= 0x80000000'00000000ULL;
 
-  GUID guid;
-  guid.lowercase_ = RandomDataToGUIDString(sixteen_bytes);
-  return guid;
+  RandomDataToGUIDChars(sixteen_bytes, output);
 }
 
 // static
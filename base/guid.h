@@ -5,6 +5,7 @@
 #ifndef BASE_GUID_H_
 #define BASE_GUID_H_
 
+#include <stddef.h>
 #include <stdint.h>
 
 #include <iosfwd>
@@ -32,6 +33,9 @@ BASE_EXPORT std::string RandomDataToGUIDString(const uint64_t bytes[2]);
 
 class BASE_EXPORT GUID {
  public:
+  // The length of the string form of a GUID.
+  static constexpr size_t kStringLength = 36;
+
   // Generate a 128-bit random GUID in the form of version 4. see RFC 4122,
   // section 4.4. The format of GUID version 4 must be
   // xxxxxxxx-xxxx-4xxx-yxxx-xxxxxxxxxxxx, where y is one of [8, 9, a, b]. The
@@ -40,6 +44,12 @@ class BASE_EXPORT GUID {
   // UnguessableToken for greater type-safety if GUID format is unnecessary.
   static GUID GenerateRandomV4();
 
+  // Writes the string form of a new random version 4 GUID into |output|, as
+  // GenerateRandomV4().AsLowercaseString() would return it but without
+  // allocating, e.g. for request IDs generated at a high rate. The output isn't
+  // NUL-terminated.
+  static void GenerateRandomV4Into(char (&output)[kStringLength]);
+
   // Returns a valid GUID if the input string conforms to the GUID format, and
   // an invalid GUID otherwise. Note that this does NOT check if the hexadecimal
   // values "a" through "f" are in lower case characters.
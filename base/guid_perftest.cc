@@ -0,0 +1,59 @@
+// Copyright 2022 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "base/guid.h"
+
+#include "base/time/time.h"
+#include "base/unguessable_token.h"
+#include "testing/gtest/include/gtest/gtest.h"
+#include "testing/perf/perf_result_reporter.h"
+
+namespace base {
+
+namespace {
+
+constexpr char kMetricPrefix[] = "GUID.";
+constexpr char kThroughput[] = "throughput";
+constexpr int kIterations = 1e6;
+
+void ReportThroughput(const std::string& story, TimeDelta elapsed) {
+  perf_test::PerfResultReporter reporter(kMetricPrefix, story);
+  reporter.RegisterImportantMetric(kThroughput, "ns / iteration");
+  reporter.AddResult(
+      kThroughput, static_cast<size_t>(elapsed.InNanoseconds() / kIterations));
+}
+
+}  // namespace
+
+TEST(GUIDPerfTest, GenerateRandomV4) {
+  size_t total_length = 0;
+  const TimeTicks before = TimeTicks::Now();
+  for (int iter = 0; iter < kIterations; iter++)
+    total_length += GUID::GenerateRandomV4().AsLowercaseString().length();
+  ReportThroughput("GenerateRandomV4", TimeTicks::Now() - before);
+  ASSERT_EQ(total_length, GUID::kStringLength * kIterations);
+}
+
+TEST(GUIDPerfTest, GenerateRandomV4Into) {
+  char inclusive_or = 0;
+  const TimeTicks before = TimeTicks::Now();
+  for (int iter = 0; iter < kIterations; iter++) {
+    char output[GUID::kStringLength];
+    GUID::GenerateRandomV4Into(output);
+    inclusive_or |= output[0];
+  }
+  ReportThroughput("GenerateRandomV4Into", TimeTicks::Now() - before);
+  ASSERT_NE(inclusive_or, 0);
+}
+
+TEST(GUIDPerfTest, UnguessableTokenCreate) {
+  uint64_t inclusive_or = 0;
+  const TimeTicks before = TimeTicks::Now();
+  for (int iter = 0; iter < kIterations; iter++)
+    inclusive_or |= UnguessableToken::Create().GetHighForSerialization();
+  ReportThroughput("UnguessableTokenCreate", TimeTicks::Now() - before);
+  ASSERT_NE(inclusive_or, 0u);
+}
+
+}  // namespace base
@@ -82,6 +82,23 @@ TEST(GUIDTest, GUIDBasicUniqueness) {
   }
 }
 
+TEST(GUIDTest, GenerateRandomV4Into) {
+  constexpr int kIterations = 10;
+  for (int i = 0; i < kIterations; ++i) {
+    char output1[GUID::kStringLength];
+    char output2[GUID::kStringLength];
+    GUID::GenerateRandomV4Into(output1);
+    GUID::GenerateRandomV4Into(output2);
+    const GUID guid1 =
+        GUID::ParseLowercase(StringPiece(output1, sizeof(output1)));
+    const GUID guid2 =
+        GUID::ParseLowercase(StringPiece(output2, sizeof(output2)));
+    EXPECT_TRUE(IsValidV4(guid1));
+    EXPECT_TRUE(IsValidV4(guid2));
+    EXPECT_NE(guid1, guid2);
+  }
+}
+
 namespace {
 
 void TestGUIDValidity(StringPiece input, bool case_insensitive, bool strict) {
@@ -0,0 +1,355 @@
+// Copyright 2022 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "base/hash/fast_hash_internal.h"
+
+#include <string.h>
+
+#include <array>
+
+#include "base/compiler_specific.h"
+#include "build/build_config.h"
+
+#if defined(ARCH_CPU_X86_64)
+#include "base/cpu.h"
+// Including these headers directly should generally be avoided. The AES-NI
+// functions are only used if the CPU supports them at runtime, see
+// HasHardwareAesHash().
+// clang-format off
+#include <immintrin.h>
+// clang-format on
+#endif
+
+namespace base {
+namespace internal {
+
+namespace {
+
+ALWAYS_INLINE uint64_t Read64(const uint8_t* p) {
+  uint64_t value;
+  memcpy(&value, p, sizeof(value));
+  return value;
+}
+
+ALWAYS_INLINE uint64_t Read32(const uint8_t* p) {
+  uint32_t value;
+  memcpy(&value, p, sizeof(value));
+  return value;
+}
+
+// Reads the |size| <= 16 bytes at |p| into two words, with overlapping reads
+// as wyhash does. Given |size|, the words determine the bytes.
+ALWAYS_INLINE void ReadShort(const uint8_t* p,
+                             size_t size,
+                             uint64_t& a,
+                             uint64_t& b) {
+  if (LIKELY(size >= 4)) {
+    const size_t offset = (size >> 3) << 2;
+    a = (Read32(p) << 32) | Read32(p + offset);
+    b = (Read32(p + size - 4) << 32) | Read32(p + size - 4 - offset);
+  } else if (LIKELY(size > 0)) {
+    a = (uint64_t{p[0]} << 16) | (uint64_t{p[size >> 1]} << 8) | p[size - 1];
+    b = 0;
+  } else {
+    a = b = 0;
+  }
+}
+
+// wyhash ----------------------------------------------------------------------
+
+constexpr uint64_t kWySecret[4] = {
+    0xa0761d6478bd642full, 0xe7037ed1a0b428dbull, 0x8ebc6af09c88c6e3ull,
+    0x589965cc75374cc3ull};
+
+ALWAYS_INLINE void WyMultiply(uint64_t& a, uint64_t& b) {
+#if defined(__SIZEOF_INT128__)
+  const unsigned __int128 product = static_cast<unsigned __int128>(a) * b;
+  a = static_cast<uint64_t>(product);
+  b = static_cast<uint64_t>(product >> 64);
+#else
+  const uint64_t a_high = a >> 32, a_low = static_cast<uint32_t>(a);
+  const uint64_t b_high = b >> 32, b_low = static_cast<uint32_t>(b);
+  const uint64_t high = a_high * b_high, middle0 = a_high * b_low;
+  const uint64_t middle1 = a_low * b_high, low = a_low * b_low;
+  const uint64_t t = low + (middle0 << 32);
+  uint64_t carry = t < low;
+  const uint64_t product_low = t + (middle1 << 32);
+  carry += product_low < t;
+  a = product_low;
+  b = high + (middle0 >> 32) + (middle1 >> 32) + carry;
+#endif
+}
+
+ALWAYS_INLINE uint64_t WyMix(uint64_t a, uint64_t b) {
+  WyMultiply(a, b);
+  return a ^ b;
+}
+
+// AES hash --------------------------------------------------------------------
+//
+// The state is mixed by AES encryption rounds (SubBytes, ShiftRows,
+// MixColumns, AddRoundKey), each of which leaves every byte depending on 4
+// bytes of its input, so 2 rounds depend on all of them. Blocks of input:
+// - of at most 16 bytes, are read as wyhash reads them and go through 3 rounds;
+// - of at most 64 bytes, are read as 2 or 4 overlapping blocks, mixed into the
+//   state one after the other, which then goes through 2 more rounds. Blocks
+//   mixed into separate states after 1 round each and combined could cancel
+//   out each other's differences;
+// - longer, are 4 lanes of 16 bytes a round, and last the 64 bytes at the end,
+//   whose states are combined after 2 and 3 rounds.
+// The size and seed are in the initial state, so the overlapping reads don't
+// collide.
+
+constexpr uint64_t kAesKeys[4][2] = {
+    // The hexadecimal digits of pi.
+    {0x243f6a8885a308d3ull, 0x13198a2e03707344ull},
+    {0xa4093822299f31d0ull, 0x082efa98ec4e6c89ull},
+    {0x452821e638d01377ull, 0xbe5466cf34e90c6cull},
+    {0xc0ac29b7c97c50ddull, 0x3f84d5b5b5470917ull},
+};
+
+constexpr uint8_t MultiplyInAesField(uint8_t a, uint8_t b) {
+  uint8_t product = 0;
+  while (b) {
+    if (b & 1)
+      product ^= a;
+    a = static_cast<uint8_t>((a << 1) ^ (a & 0x80 ? 0x1b : 0));
+    b >>= 1;
+  }
+  return product;
+}
+
+constexpr uint8_t RotateLeft(uint8_t value, int bits) {
+  return static_cast<uint8_t>((value << bits) | (value >> (8 - bits)));
+}
+
+// The AES S-box: the multiplicative inverse, x^254, and an affine transform.
+constexpr std::array<uint8_t, 256> MakeAesSBox() {
+  std::array<uint8_t, 256> sbox = {};
+  for (int x = 0; x < 256; ++x) {
+    uint8_t inverse = 1;
+    uint8_t power = static_cast<uint8_t>(x);
+    for (int exponent = 254; exponent; exponent >>= 1) {
+      if (exponent & 1)
+        inverse = MultiplyInAesField(inverse, power);
+      power = MultiplyInAesField(power, power);
+    }
+    sbox[x] = inverse ^ RotateLeft(inverse, 1) ^ RotateLeft(inverse, 2) ^
+              RotateLeft(inverse, 3) ^ RotateLeft(inverse, 4) ^ 0x63;
+  }
+  return sbox;
+}
+
+constexpr std::array<uint8_t, 256> kAesSBox = MakeAesSBox();
+static_assert(kAesSBox[0x00] == 0x63 && kAesSBox[0x01] == 0x7c &&
+                  kAesSBox[0x53] == 0xed && kAesSBox[0xff] == 0x16,
+              "Wrong AES S-box");
+
+// The operations of AesHash() on the state, computed byte by byte.
+struct SoftwareAes {
+  struct Block {
+    uint8_t bytes[16];
+  };
+
+  static Block Make(uint64_t low, uint64_t high) {
+    Block block;
+    memcpy(block.bytes, &low, 8);
+    memcpy(block.bytes + 8, &high, 8);
+    return block;
+  }
+
+  static Block Load(const uint8_t* p) {
+    Block block;
+    memcpy(block.bytes, p, sizeof(block.bytes));
+    return block;
+  }
+
+  static Block Xor(const Block& a, const Block& b) {
+    Block block;
+    for (int i = 0; i < 16; ++i)
+      block.bytes[i] = a.bytes[i] ^ b.bytes[i];
+    return block;
+  }
+
+  // An AES encryption round, as AESENC computes it. The bytes are in columns
+  // of 4.
+  static Block Round(const Block& state, const Block& key) {
+    uint8_t shifted[16];
+    for (int column = 0; column < 4; ++column) {
+      for (int row = 0; row < 4; ++row) {
+        shifted[row + 4 * column] =
+            kAesSBox[state.bytes[row + 4 * ((column + row) & 3)]];
+      }
+    }
+    Block block;
+    for (int column = 0; column < 4; ++column) {
+      const uint8_t* in = shifted + 4 * column;
+      uint8_t* out = block.bytes + 4 * column;
+      for (int row = 0; row < 4; ++row) {
+        const uint8_t a = in[row], b = in[(row + 1) & 3];
+        out[row] = MultiplyInAesField(a, 2) ^ MultiplyInAesField(b, 3) ^
+                   in[(row + 2) & 3] ^ in[(row + 3) & 3];
+      }
+    }
+    return Xor(block, key);
+  }
+
+  static uint64_t Fold(const Block& block) {
+    return Read64(block.bytes) ^ Read64(block.bytes + 8);
+  }
+};
+
+#if defined(ARCH_CPU_X86_64)
+#define TARGET_AES __attribute__((target("aes")))
+
+struct AesNi {
+  using Block = __m128i;
+
+  TARGET_AES ALWAYS_INLINE static Block Make(uint64_t low, uint64_t high) {
+    return _mm_set_epi64x(static_cast<int64_t>(high),
+                          static_cast<int64_t>(low));
+  }
+
+  TARGET_AES ALWAYS_INLINE static Block Load(const uint8_t* p) {
+    return _mm_loadu_si128(reinterpret_cast<const __m128i*>(p));
+  }
+
+  TARGET_AES ALWAYS_INLINE static Block Xor(Block a, Block b) {
+    return _mm_xor_si128(a, b);
+  }
+
+  TARGET_AES ALWAYS_INLINE static Block Round(Block state, Block key) {
+    return _mm_aesenc_si128(state, key);
+  }
+
+  TARGET_AES ALWAYS_INLINE static uint64_t Fold(Block block) {
+    return static_cast<uint64_t>(_mm_cvtsi128_si64(block)) ^
+           static_cast<uint64_t>(
+               _mm_cvtsi128_si64(_mm_unpackhi_epi64(block, block)));
+  }
+};
+#else
+#define TARGET_AES
+#endif
+
+// Mixes |block| into |state|.
+template <typename Aes>
+TARGET_AES ALWAYS_INLINE typename Aes::Block Absorb(
+    const typename Aes::Block& state,
+    const typename Aes::Block& block,
+    const typename Aes::Block& key) {
+  return Aes::Round(Aes::Xor(state, block), key);
+}
+
+template <typename Aes>
+TARGET_AES uint64_t AesHash(const uint8_t* p, size_t size, uint64_t seed) {
+  using Block = typename Aes::Block;
+  const Block key0 = Aes::Make(kAesKeys[0][0], kAesKeys[0][1]);
+  const Block key1 = Aes::Make(kAesKeys[1][0], kAesKeys[1][1]);
+  const Block key2 = Aes::Make(kAesKeys[2][0], kAesKeys[2][1]);
+  const Block key3 = Aes::Make(kAesKeys[3][0], kAesKeys[3][1]);
+  const Block seed_block = Aes::Xor(Aes::Make(seed, seed ^ size), key0);
+
+  if (LIKELY(size <= 16)) {
+    uint64_t a, b;
+    ReadShort(p, size, a, b);
+    Block state = Absorb<Aes>(seed_block, Aes::Make(a, b), key1);
+    state = Aes::Round(state, key2);
+    return Aes::Fold(Aes::Round(state, key3));
+  }
+
+  Block state;
+  if (size <= 32) {
+    state = Absorb<Aes>(seed_block, Aes::Load(p), key1);
+    state = Absorb<Aes>(state, Aes::Load(p + size - 16), key2);
+  } else if (size <= 64) {
+    state = Absorb<Aes>(seed_block, Aes::Load(p), key1);
+    state = Absorb<Aes>(state, Aes::Load(p + 16), key2);
+    state = Absorb<Aes>(state, Aes::Load(p + size - 32), key3);
+    state = Absorb<Aes>(state, Aes::Load(p + size - 16), key1);
+  } else {
+    // Not an array, which the compilers keep in memory.
+    Block lane0 = Aes::Xor(seed_block, key0);
+    Block lane1 = Aes::Xor(seed_block, key1);
+    Block lane2 = Aes::Xor(seed_block, key2);
+    Block lane3 = Aes::Xor(seed_block, key3);
+    const uint8_t* const end = p + size - 64;
+    for (; p < end; p += 64) {
+      lane0 = Absorb<Aes>(lane0, Aes::Load(p), key1);
+      lane1 = Absorb<Aes>(lane1, Aes::Load(p + 16), key1);
+      lane2 = Absorb<Aes>(lane2, Aes::Load(p + 32), key1);
+      lane3 = Absorb<Aes>(lane3, Aes::Load(p + 48), key1);
+    }
+    lane0 = Absorb<Aes>(lane0, Aes::Load(end), key2);
+    lane1 = Absorb<Aes>(lane1, Aes::Load(end + 16), key2);
+    lane2 = Absorb<Aes>(lane2, Aes::Load(end + 32), key2);
+    lane3 = Absorb<Aes>(lane3, Aes::Load(end + 48), key2);
+    const Block first = Absorb<Aes>(Aes::Round(lane0, key3), lane1, key1);
+    const Block last = Absorb<Aes>(Aes::Round(lane2, key1), lane3, key3);
+    state = Aes::Xor(first, last);
+  }
+  state = Aes::Round(state, key2);
+  return Aes::Fold(Aes::Round(state, key3));
+}
+
+#undef TARGET_AES
+
+}  // namespace
+
+uint64_t WyHash64(const uint8_t* p, size_t size, uint64_t seed) {
+  seed ^= WyMix(seed ^ kWySecret[0], kWySecret[1]);
+  uint64_t a, b;
+  if (LIKELY(size <= 16)) {
+    ReadShort(p, size, a, b);
+  } else {
+    size_t remaining = size;
+    if (UNLIKELY(remaining > 48)) {
+      uint64_t seed1 = seed, seed2 = seed;
+      do {
+        seed = WyMix(Read64(p) ^ kWySecret[1], Read64(p + 8) ^ seed);
+        seed1 = WyMix(Read64(p + 16) ^ kWySecret[2], Read64(p + 24) ^ seed1);
+        seed2 = WyMix(Read64(p + 32) ^ kWySecret[3], Read64(p + 40) ^ seed2);
+        p += 48;
+        remaining -= 48;
+      } while (LIKELY(remaining > 48));
+      seed ^= seed1 ^ seed2;
+    }
+    while (UNLIKELY(remaining > 16)) {
+      seed = WyMix(Read64(p) ^ kWySecret[1], Read64(p + 8) ^ seed);
+      p += 16;
+      remaining -= 16;
+    }
+    a = Read64(p + remaining - 16);
+    b = Read64(p + remaining - 8);
+  }
+  a ^= kWySecret[1];
+  b ^= seed;
+  WyMultiply(a, b);
+  return WyMix(a ^ kWySecret[0] ^ size, b ^ kWySecret[1]);
+}
+
+uint64_t AesHash64(const uint8_t* data, size_t size, uint64_t seed) {
+#if defined(ARCH_CPU_X86_64)
+  static const bool has_aesni = CPU().has_aesni();
+  if (has_aesni)
+    return AesHash<AesNi>(data, size, seed);
+#endif
+  return AesHash64Software(data, size, seed);
+}
+
+uint64_t AesHash64Software(const uint8_t* data, size_t size, uint64_t seed) {
+  return AesHash<SoftwareAes>(data, size, seed);
+}
+
+bool HasHardwareAesHash() {
+#if defined(ARCH_CPU_X86_64)
+  static const bool has_aesni = CPU().has_aesni();
+  return has_aesni;
+#else
+  return false;
+#endif
+}
+
+}  // namespace internal
+}  // namespace base
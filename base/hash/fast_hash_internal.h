@@ -0,0 +1,36 @@
+// Copyright 2022 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#ifndef BASE_HASH_FAST_HASH_INTERNAL_H_
+#define BASE_HASH_FAST_HASH_INTERNAL_H_
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include "base/base_export.h"
+
+namespace base {
+namespace internal {
+
+// The hash functions behind base::FastHash() and base::VersionedFastHash(),
+// exposed for the tests.
+
+// wyhash, final version 4, with its default secret. Its 64x64->128 bit
+// multiplications make it the fastest portable hash of short keys.
+BASE_EXPORT uint64_t WyHash64(const uint8_t* data, size_t size, uint64_t seed);
+
+// A hash of AES rounds. It uses AES-NI on x86-64 when the CPU supports it at
+// runtime, and else AesHash64Software(), which computes the same values.
+BASE_EXPORT uint64_t AesHash64(const uint8_t* data, size_t size, uint64_t seed);
+BASE_EXPORT uint64_t AesHash64Software(const uint8_t* data,
+                                       size_t size,
+                                       uint64_t seed);
+
+// Whether AesHash64() runs on AES instructions.
+BASE_EXPORT bool HasHardwareAesHash();
+
+}  // namespace internal
+}  // namespace base
+
+#endif  // BASE_HASH_FAST_HASH_INTERNAL_H_
@@ -0,0 +1,44 @@
+// Copyright 2022 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "base/hash/file_hash.h"
+
+#include <memory>
+
+#include "base/files/file.h"
+#include "base/strings/string_piece.h"
+
+namespace base {
+
+namespace {
+
+// Large enough to amortize the reads, small enough to stay in the L2 cache.
+constexpr int kChunkSize = 64 * 1024;
+
+template <typename Update>
+bool ReadChunks(File& file, Update update) {
+  std::unique_ptr<char[]> buffer(new char[kChunkSize]);
+  while (true) {
+    const int bytes_read = file.ReadAtCurrentPos(buffer.get(), kChunkSize);
+    if (bytes_read < 0)
+      return false;
+    if (bytes_read == 0)
+      return true;
+    update(StringPiece(buffer.get(), static_cast<size_t>(bytes_read)));
+  }
+}
+
+}  // namespace
+
+bool SHA1UpdateFromFile(File& file, SHA1Context& context) {
+  return ReadChunks(
+      file, [&context](StringPiece data) { SHA1Update(data, context); });
+}
+
+bool MD5UpdateFromFile(File& file, MD5Context* context) {
+  return ReadChunks(file,
+                    [context](StringPiece data) { MD5Update(context, data); });
+}
+
+}  // namespace base
@@ -0,0 +1,26 @@
+// Copyright 2022 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#ifndef BASE_HASH_FILE_HASH_H_
+#define BASE_HASH_FILE_HASH_H_
+
+#include "base/base_export.h"
+#include "base/hash/md5.h"
+#include "base/hash/sha1.h"
+
+namespace base {
+
+class File;
+
+// Streams the contents of |file|, from its current position to its end, into
+// a SHA-1 or MD5 computation that SHA1Init() or MD5Init() started. The
+// contents are read in chunks into one buffer, and hashed where they were
+// read. Returns false if a read fails, which leaves |context| with the
+// contents read so far.
+BASE_EXPORT bool SHA1UpdateFromFile(File& file, SHA1Context& context);
+BASE_EXPORT bool MD5UpdateFromFile(File& file, MD5Context* context);
+
+}  // namespace base
+
+#endif  // BASE_HASH_FILE_HASH_H_
@@ -0,0 +1,87 @@
+// Copyright 2022 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "base/hash/file_hash.h"
+
+#include <stdint.h>
+#include <string.h>
+
+#include <vector>
+
+#include "base/files/file.h"
+#include "base/files/file_path.h"
+#include "base/files/file_util.h"
+#include "base/files/scoped_temp_dir.h"
+#include "testing/gtest/include/gtest/gtest.h"
+
+namespace base {
+
+TEST(FileHashTest, MatchesHashOfContents) {
+  ScopedTempDir temp_dir;
+  ASSERT_TRUE(temp_dir.CreateUniqueTempDir());
+  const FilePath path = temp_dir.GetPath().AppendASCII("file");
+
+  // Several chunks, and a partial one.
+  std::vector<uint8_t> contents(200 * 1024 + 123);
+  for (size_t i = 0; i < contents.size(); ++i)
+    contents[i] = static_cast<uint8_t>(i * 31 + (i >> 10));
+  ASSERT_TRUE(WriteFile(path, contents));
+
+  // From a position within the file.
+  for (size_t offset : {size_t{0}, size_t{1000}}) {
+    File file(path, File::FLAG_OPEN | File::FLAG_READ);
+    ASSERT_TRUE(file.IsValid());
+    ASSERT_EQ(static_cast<int64_t>(offset),
+              file.Seek(File::FROM_BEGIN, static_cast<int64_t>(offset)));
+    SHA1Context sha1_context;
+    SHA1Init(sha1_context);
+    EXPECT_TRUE(SHA1UpdateFromFile(file, sha1_context));
+    SHA1Digest sha1_digest;
+    SHA1Final(sha1_context, sha1_digest);
+    EXPECT_EQ(SHA1HashSpan(make_span(contents).subspan(offset)), sha1_digest);
+
+    ASSERT_EQ(static_cast<int64_t>(offset),
+              file.Seek(File::FROM_BEGIN, static_cast<int64_t>(offset)));
+    MD5Context md5_context;
+    MD5Init(&md5_context);
+    EXPECT_TRUE(MD5UpdateFromFile(file, &md5_context));
+    MD5Digest md5_digest;
+    MD5Final(&md5_digest, &md5_context);
+    MD5Digest expected;
+    MD5Sum(contents.data() + offset, contents.size() - offset, &expected);
+    EXPECT_EQ(0, memcmp(expected.a, md5_digest.a, sizeof(expected.a)));
+  }
+}
+
+TEST(FileHashTest, EmptyFile) {
+  ScopedTempDir temp_dir;
+  ASSERT_TRUE(temp_dir.CreateUniqueTempDir());
+  const FilePath path = temp_dir.GetPath().AppendASCII("empty");
+  ASSERT_TRUE(WriteFile(path, ""));
+
+  File file(path, File::FLAG_OPEN | File::FLAG_READ);
+  ASSERT_TRUE(file.IsValid());
+  SHA1Context context;
+  SHA1Init(context);
+  EXPECT_TRUE(SHA1UpdateFromFile(file, context));
+  SHA1Digest digest;
+  SHA1Final(context, digest);
+  EXPECT_EQ(SHA1HashSpan({}), digest);
+}
+
+TEST(FileHashTest, ReadFailure) {
+  ScopedTempDir temp_dir;
+  ASSERT_TRUE(temp_dir.CreateUniqueTempDir());
+  const FilePath path = temp_dir.GetPath().AppendASCII("file");
+  ASSERT_TRUE(WriteFile(path, "contents"));
+
+  // Reading a file opened for writing only fails.
+  File file(path, File::FLAG_OPEN | File::FLAG_WRITE);
+  ASSERT_TRUE(file.IsValid());
+  SHA1Context context;
+  SHA1Init(context);
+  EXPECT_FALSE(SHA1UpdateFromFile(file, context));
+}
+
+}  // namespace base
@@ -5,6 +5,7 @@
 #include "base/hash/hash.h"
 
 #include "base/check_op.h"
+#include "base/hash/fast_hash_internal.h"
 #include "base/notreached.h"
 #include "base/rand_util.h"
 #include "base/third_party/cityhash/city.h"
@@ -19,13 +20,19 @@ namespace base {
 
 namespace {
 
+// The size above which the AES hash, on AES-NI, hashes more bytes per second
+// than wyhash.
+constexpr size_t kMaxWyhashSize = 64;
+
 size_t FastHashImpl(base::span<const uint8_t> data) {
-  // We use the updated CityHash within our namespace (not the deprecated
-  // version from third_party/smhasher).
 #if defined(ARCH_CPU_64_BITS)
-  return base::internal::cityhash_v111::CityHash64(
-      reinterpret_cast<const char*>(data.data()), data.size());
+  if (data.size() > kMaxWyhashSize && internal::HasHardwareAesHash())
+    return internal::AesHash64(data.data(), data.size(), 0);
+  return internal::WyHash64(data.data(), data.size(), 0);
 #else
+  // We use the updated CityHash within our namespace (not the deprecated
+  // version from third_party/smhasher). wyhash's 64-bit multiplications are
+  // slow on 32-bit CPUs.
   return base::internal::cityhash_v111::CityHash32(
       reinterpret_cast<const char*>(data.data()), data.size());
 #endif
@@ -119,6 +126,22 @@ size_t FastHash(base::span<const uint8_t> data) {
   return Scramble(FastHashImpl(data));
 }
 
+uint64_t VersionedFastHash(FastHashVersion version,
+                           base::span<const uint8_t> data,
+                           uint64_t seed) {
+  switch (version) {
+    case FastHashVersion::kCityHash64V111:
+      return internal::cityhash_v111::CityHash64WithSeed(
+          reinterpret_cast<const char*>(data.data()), data.size(), seed);
+    case FastHashVersion::kWyhashV4:
+      return internal::WyHash64(data.data(), data.size(), seed);
+    case FastHashVersion::kAesHashV1:
+      return internal::AesHash64(data.data(), data.size(), seed);
+  }
+  NOTREACHED();
+  return 0;
+}
+
 uint32_t Hash(const void* data, size_t length) {
   // Currently our in-memory hash is the same as the persistent hash. The
   // split between in-memory and persistent hash functions is maintained to
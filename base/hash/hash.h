@@ -40,6 +40,33 @@ inline size_t FastHash(StringPiece str) {
   return FastHash(as_bytes(make_span(str)));
 }
 
+// The hash functions FastHash() picks from. Unlike FastHash(), whose outputs
+// are scrambled per process in DCHECK builds, each version computes the same
+// values on every platform, so the values may be shared between processes.
+// A version is never changed; a new hash function gets a new version.
+enum class FastHashVersion {
+  // CityHash64 v1.1.1, which FastHash() used on 64-bit platforms before
+  // kWyhashV4. It still uses CityHash32 v1.1.1 on 32-bit ones.
+  kCityHash64V111,
+  // wyhash, final version 4. FastHash() uses it on 64-bit platforms for keys
+  // of up to 64 bytes, and for all keys without AES instructions.
+  kWyhashV4,
+  // A hash of AES rounds. FastHash() uses it for longer keys when the CPU has
+  // AES instructions. Elsewhere it's computed in software, which is over 20
+  // times slower than kWyhashV4.
+  kAesHashV1,
+};
+
+// Hashes |data| with the hash function of |version|, keyed by |seed|.
+BASE_EXPORT uint64_t VersionedFastHash(FastHashVersion version,
+                                       base::span<const uint8_t> data,
+                                       uint64_t seed = 0);
+inline uint64_t VersionedFastHash(FastHashVersion version,
+                                  StringPiece str,
+                                  uint64_t seed = 0) {
+  return VersionedFastHash(version, as_bytes(make_span(str)), seed);
+}
+
 // Computes a hash of a memory buffer. This hash function must not change so
 // that code can use the hashed values for persistent storage purposes or
 // sending across the network. If a new persistent hash function is desired, a
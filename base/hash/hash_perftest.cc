@@ -10,6 +10,7 @@
 #include <vector>
 
 #include "base/hash/hash.h"
+#include "base/hash/md5.h"
 #include "base/rand_util.h"
 #include "base/ranges/algorithm.h"
 #include "base/strings/string_number_conversions.h"
@@ -28,7 +29,7 @@ void Sha1Hash(void* data, size_t size) {
 }
 
 void FastHash(void* data, size_t size) {
-  base::Hash(reinterpret_cast<uint8_t*>(data), size);
+  base::FastHash(make_span(reinterpret_cast<uint8_t*>(data), size));
 }
 
 void RunTest(const char* hash_name,
@@ -83,6 +84,67 @@ void RunTest(const char* hash_name,
   reporter.AddResultList(kMetricThroughput, JoinString(rate_strings, ","));
 }
 
+// Reports the time and throughput of |hash| over many keys of |size| bytes,
+// which is what hash tables of short keys do, unlike RunTest().
+void RunSizeClassTest(const char* hash_name,
+                      uint64_t (*hash)(span<const uint8_t>),
+                      size_t size) {
+  constexpr char kMetricTimePerHash[] = "time_per_hash";
+  constexpr char kMetricThroughput[] = "throughput";
+  perf_test::PerfResultReporter reporter(hash_name,
+                                         NumberToString(size) + "_bytes");
+  reporter.RegisterImportantMetric(kMetricTimePerHash, "ns");
+  reporter.RegisterImportantMetric(kMetricThroughput, "bytesPerSecond");
+
+  // Keys at different offsets, as a table's keys would be.
+  constexpr size_t kNumKeys = 64;
+  std::vector<uint8_t> buf(size + kNumKeys);
+  RandBytes(buf.data(), buf.size());
+
+  const size_t iterations = 64 * 1024 * 1024 / (size + 16);
+  uint64_t sum = 0;
+  const auto start = TimeTicks::Now();
+  for (size_t i = 0; i < iterations; ++i)
+    sum += hash(make_span(buf.data() + i % kNumKeys, size));
+  const TimeDelta time = TimeTicks::Now() - start;
+  // Keeps the hashing from being optimized away.
+  EXPECT_NE(0u, sum);
+
+  reporter.AddResult(kMetricTimePerHash,
+                     time.InMicrosecondsF() * 1000 / iterations);
+  reporter.AddResult(kMetricThroughput, iterations * size / time.InSecondsF());
+}
+
+constexpr size_t kSizeClasses[] = {4, 8, 16, 32, 64, 256, 1024, 16384};
+
+// Reports the throughput of |hash| over a batch of 4 MB of inputs of |size|
+// bytes, each.
+void RunBatchTest(const char* hash_name,
+                  void (*hash)(span<const span<const uint8_t>>),
+                  size_t size) {
+  constexpr char kMetricThroughput[] = "throughput";
+  perf_test::PerfResultReporter reporter(hash_name,
+                                         NumberToString(size) + "_bytes");
+  reporter.RegisterImportantMetric(kMetricThroughput, "bytesPerSecond");
+
+  constexpr size_t kBatchSize = 4 * 1024 * 1024;
+  std::vector<uint8_t> buf(kBatchSize);
+  RandBytes(buf.data(), buf.size());
+  std::vector<span<const uint8_t>> inputs;
+  for (size_t offset = 0; offset < kBatchSize; offset += size)
+    inputs.push_back(make_span(buf).subspan(offset, size));
+
+  constexpr int kNumRuns = 16;
+  const auto start = TimeTicks::Now();
+  for (int i = 0; i < kNumRuns; ++i)
+    hash(inputs);
+  const TimeDelta time = TimeTicks::Now() - start;
+  reporter.AddResult(kMetricThroughput,
+                     kNumRuns * kBatchSize / time.InSecondsF());
+}
+
+constexpr size_t kBatchInputSizes[] = {64, 256, 1024, 4096, 65536, 1048576};
+
 }  // namespace
 
 TEST(SHA1PerfTest, Speed) {
@@ -97,4 +159,69 @@ TEST(HashPerfTest, Speed) {
   }
 }
 
+TEST(HashPerfTest, SizeClasses) {
+  for (size_t size : kSizeClasses) {
+    RunSizeClassTest(
+        "FastHash.", [](span<const uint8_t> data) -> uint64_t {
+          return base::FastHash(data);
+        },
+        size);
+    RunSizeClassTest(
+        "CityHash64V111.", [](span<const uint8_t> data) {
+          return VersionedFastHash(FastHashVersion::kCityHash64V111, data);
+        },
+        size);
+    RunSizeClassTest(
+        "WyhashV4.", [](span<const uint8_t> data) {
+          return VersionedFastHash(FastHashVersion::kWyhashV4, data);
+        },
+        size);
+    RunSizeClassTest(
+        "AesHashV1.", [](span<const uint8_t> data) {
+          return VersionedFastHash(FastHashVersion::kAesHashV1, data);
+        },
+        size);
+    RunSizeClassTest(
+        "PersistentHash.", [](span<const uint8_t> data) -> uint64_t {
+          return PersistentHash(data);
+        },
+        size);
+  }
+}
+
+TEST(SHA1PerfTest, Batches) {
+  for (size_t size : kBatchInputSizes) {
+    RunBatchTest(
+        "SHA1HashSpan.", [](span<const span<const uint8_t>> inputs) {
+          for (span<const uint8_t> input : inputs)
+            SHA1HashSpan(input);
+        },
+        size);
+    RunBatchTest(
+        "SHA1HashSpans.", [](span<const span<const uint8_t>> inputs) {
+          std::vector<SHA1Digest> digests(inputs.size());
+          SHA1HashSpans(inputs, digests);
+        },
+        size);
+  }
+}
+
+TEST(MD5PerfTest, Batches) {
+  for (size_t size : kBatchInputSizes) {
+    RunBatchTest(
+        "MD5Sum.", [](span<const span<const uint8_t>> inputs) {
+          MD5Digest digest;
+          for (span<const uint8_t> input : inputs)
+            MD5Sum(input.data(), input.size(), &digest);
+        },
+        size);
+    RunBatchTest(
+        "MD5SumSpans.", [](span<const span<const uint8_t>> inputs) {
+          std::vector<MD5Digest> digests(inputs.size());
+          MD5SumSpans(inputs, digests);
+        },
+        size);
+  }
+}
+
 }  // namespace base
@@ -4,9 +4,11 @@
 
 #include "base/hash/hash.h"
 
+#include <set>
 #include <string>
 #include <vector>
 
+#include "base/hash/fast_hash_internal.h"
 #include "testing/gtest/include/gtest/gtest.h"
 
 namespace base {
@@ -85,4 +87,134 @@ TEST(HashTest, FastHash) {
   EXPECT_EQ(FastHash(s), FastHash(kEmptyString));
 }
 
+namespace {
+
+constexpr FastHashVersion kFastHashVersions[] = {
+    FastHashVersion::kCityHash64V111,
+    FastHashVersion::kWyhashV4,
+    FastHashVersion::kAesHashV1,
+};
+
+// Bytes which aren't all the same, of the sizes every code path reads.
+std::vector<uint8_t> MakeHashInput(size_t size) {
+  std::vector<uint8_t> input(size);
+  for (size_t i = 0; i < size; ++i)
+    input[i] = static_cast<uint8_t>(i * 37 + 11);
+  return input;
+}
+
+}  // namespace
+
+TEST(HashTest, FastHashOfDifferentInputs) {
+  std::set<size_t> hashes;
+  const std::vector<uint8_t> input = MakeHashInput(1000);
+  for (size_t size = 0; size <= input.size(); ++size)
+    hashes.insert(FastHash(make_span(input.data(), size)));
+  EXPECT_EQ(input.size() + 1, hashes.size());
+}
+
+TEST(HashTest, VersionedFastHashKnownValues) {
+  // These values must never change.
+  const std::vector<uint8_t> input = MakeHashInput(300);
+  struct {
+    FastHashVersion version;
+    size_t size;
+    uint64_t seed;
+    uint64_t hash;
+  } kCases[] = {
+      {FastHashVersion::kCityHash64V111, 0, 0, 0x0000000000000000ull},
+      {FastHashVersion::kCityHash64V111, 0, 42, 0xa96ac8f555bccc29ull},
+      {FastHashVersion::kCityHash64V111, 3, 0, 0xd078764fa2e77ecaull},
+      {FastHashVersion::kCityHash64V111, 16, 0, 0xc0e94867f58d762eull},
+      {FastHashVersion::kCityHash64V111, 24, 0, 0x872e75beab57b778ull},
+      {FastHashVersion::kCityHash64V111, 40, 0, 0x5be40b15121bab4cull},
+      {FastHashVersion::kCityHash64V111, 40, 42, 0x0f9af8fe70846c7bull},
+      {FastHashVersion::kCityHash64V111, 300, 0, 0x3b02de2b7951d8d0ull},
+      {FastHashVersion::kCityHash64V111, 300, 42, 0x0a988a70b3d482b5ull},
+      {FastHashVersion::kWyhashV4, 0, 0, 0x0409638ee2bde459ull},
+      {FastHashVersion::kWyhashV4, 0, 42, 0x72014e4eed7eeb7dull},
+      {FastHashVersion::kWyhashV4, 3, 0, 0x0287a48713586a29ull},
+      {FastHashVersion::kWyhashV4, 16, 0, 0x411ffa3c1331fbafull},
+      {FastHashVersion::kWyhashV4, 24, 0, 0x0d629db92d15a02aull},
+      {FastHashVersion::kWyhashV4, 40, 0, 0xb85ef30ef944820aull},
+      {FastHashVersion::kWyhashV4, 40, 42, 0x9ddd5dec0c396144ull},
+      {FastHashVersion::kWyhashV4, 300, 0, 0x9a5c7ff408e4101aull},
+      {FastHashVersion::kWyhashV4, 300, 42, 0xc7a1ddc8d8e13e42ull},
+      {FastHashVersion::kAesHashV1, 0, 0, 0x56f3ce26d1ffefd8ull},
+      {FastHashVersion::kAesHashV1, 0, 42, 0xe1d45dc042f6a040ull},
+      {FastHashVersion::kAesHashV1, 3, 0, 0xc5681adb3eb7847eull},
+      {FastHashVersion::kAesHashV1, 16, 0, 0x93bf587e46f42fb6ull},
+      {FastHashVersion::kAesHashV1, 24, 0, 0xf7ff79a547338511ull},
+      {FastHashVersion::kAesHashV1, 40, 0, 0xe4cff8a646a8f8e2ull},
+      {FastHashVersion::kAesHashV1, 40, 42, 0x7f0aa5c2abb836ccull},
+      {FastHashVersion::kAesHashV1, 300, 0, 0xbb63bbc0b11a157cull},
+      {FastHashVersion::kAesHashV1, 300, 42, 0xaaa680d20c6af988ull},
+  };
+  for (const auto& c : kCases) {
+    EXPECT_EQ(c.hash,
+              VersionedFastHash(c.version, make_span(input.data(), c.size),
+                                c.seed))
+        << static_cast<int>(c.version) << " " << c.size << " " << c.seed;
+  }
+}
+
+// The test vectors of wyhash, hashed with the seeds 0 to 4.
+TEST(HashTest, WyhashMatchesReference) {
+  const struct {
+    const char* input;
+    uint64_t hash;
+  } kCases[] = {
+      {"", 0x0409638ee2bde459ull},
+      {"a", 0xa8412d091b5fe0a9ull},
+      {"abc", 0x32dd92e4b2915153ull},
+      {"message digest", 0x8619124089a3a16bull},
+      {"abcdefghijklmnopqrstuvwxyz", 0x7a43afb61d7f5f40ull},
+  };
+  uint64_t seed = 0;
+  for (const auto& c : kCases) {
+    EXPECT_EQ(c.hash,
+              VersionedFastHash(FastHashVersion::kWyhashV4, c.input, seed++))
+        << c.input;
+  }
+}
+
+// Every size and every bit of the seed and of the input matter.
+TEST(HashTest, VersionedFastHashOfDifferentInputs) {
+  for (FastHashVersion version : kFastHashVersions) {
+    for (size_t size : {0, 1, 3, 4, 8, 15, 16, 17, 31, 32, 33, 63, 64, 65, 127,
+                        128, 129, 200}) {
+      std::vector<uint8_t> input = MakeHashInput(size);
+      std::set<uint64_t> hashes = {VersionedFastHash(version, input)};
+      for (int bit = 0; bit < 64; ++bit)
+        hashes.insert(VersionedFastHash(version, input, uint64_t{1} << bit));
+      for (size_t bit = 0; bit < size * 8; ++bit) {
+        input[bit / 8] ^= 1 << (bit % 8);
+        hashes.insert(VersionedFastHash(version, input));
+        input[bit / 8] ^= 1 << (bit % 8);
+      }
+      EXPECT_EQ(1 + 64 + size * 8, hashes.size())
+          << static_cast<int>(version) << " " << size;
+    }
+
+    // All the sizes of the same bytes, which the short sizes read twice.
+    const std::vector<uint8_t> zeros(300);
+    std::set<uint64_t> hashes;
+    for (size_t size = 0; size <= zeros.size(); ++size)
+      hashes.insert(VersionedFastHash(version, make_span(zeros.data(), size)));
+    EXPECT_EQ(zeros.size() + 1, hashes.size()) << static_cast<int>(version);
+  }
+}
+
+TEST(HashTest, AesHashMatchesSoftware) {
+  const std::vector<uint8_t> input = MakeHashInput(600);
+  for (size_t size = 0; size <= input.size(); ++size) {
+    for (uint64_t seed : {uint64_t{0}, uint64_t{0x0123456789abcdef}}) {
+      EXPECT_EQ(
+          internal::AesHash64Software(input.data(), size, seed),
+          internal::AesHash64(input.data(), size, seed))
+          << size;
+    }
+  }
+}
+
 }  // namespace base
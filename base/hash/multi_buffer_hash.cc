@@ -0,0 +1,597 @@
+// Copyright 2022 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "base/hash/multi_buffer_hash_internal.h"
+
+#include <string.h>
+
+#include <algorithm>
+#include <utility>
+
+#include "base/check_op.h"
+#include "base/compiler_specific.h"
+#include "base/cpu.h"
+#include "base/notreached.h"
+#include "base/sys_byteorder.h"
+#include "build/build_config.h"
+
+#if defined(ARCH_CPU_X86_64) && !BUILDFLAG(IS_NACL)
+#include <immintrin.h>
+#elif defined(ARCH_CPU_ARM64) && !BUILDFLAG(IS_NACL)
+#include <arm_neon.h>
+#endif
+
+namespace base {
+namespace internal {
+
+namespace {
+
+// The lanes are GCC and Clang vector types, whose arithmetic is compiled to
+// the SIMD instructions of the function it's inlined into: SSE2 or NEON for
+// 4 lanes, and AVX2 for 8 lanes in the functions which target it.
+typedef uint32_t Vector1 __attribute__((vector_size(4)));
+typedef uint32_t Vector4 __attribute__((vector_size(16)));
+typedef uint32_t Vector8 __attribute__((vector_size(32)));
+
+#if defined(ARCH_CPU_X86_64) && !BUILDFLAG(IS_NACL)
+#define HAS_VECTOR4_LANES 1
+#define HAS_VECTOR8_LANES 1
+#define HAS_SHA1_INSTRUCTIONS 1
+#elif defined(ARCH_CPU_ARM64) && !BUILDFLAG(IS_NACL)
+#define HAS_VECTOR4_LANES 1
+#define HAS_SHA1_INSTRUCTIONS 1
+#endif
+
+constexpr size_t kBlockSize = 64;
+
+// In place, because returning an AVX vector changes the ABI of the function
+// without AVX.
+template <typename Vector>
+ALWAYS_INLINE void RotateLeft(Vector& value, int bits) {
+  value = (value << bits) | (value >> (32 - bits));
+}
+
+// Loads the 16 words of each lane's block into |words|.
+template <typename Vector, size_t kLanes, bool kBigEndian>
+ALWAYS_INLINE void LoadWords(const uint8_t* const* blocks, Vector* words) {
+  for (size_t t = 0; t < 16; ++t) {
+    for (size_t lane = 0; lane < kLanes; ++lane) {
+      uint32_t word;
+      memcpy(&word, blocks[lane] + 4 * t, sizeof(word));
+      words[t][lane] = kBigEndian ? ByteSwap(word) : word;
+    }
+  }
+}
+
+// SHA-1, as FIPS 180-4 describes it.
+struct SHA1Algorithm {
+  using Digest = SHA1Digest;
+  static constexpr size_t kStateWords = 5;
+  static constexpr bool kBigEndian = true;
+  static constexpr uint32_t kInitialState[kStateWords] = {
+      0x67452301, 0xefcdab89, 0x98badcfe, 0x10325476, 0xc3d2e1f0};
+
+  static uint8_t* Bytes(Digest& digest) { return digest.data(); }
+
+  // Round |t|, with the message schedule in place: |w[t & 15]| is W[t].
+  template <typename Vector>
+  ALWAYS_INLINE static void Round(size_t t,
+                                  const Vector& f,
+                                  uint32_t k,
+                                  Vector* w,
+                                  Vector& a,
+                                  Vector& b,
+                                  Vector& c,
+                                  Vector& d,
+                                  Vector& e) {
+    if (t >= 16) {
+      w[t & 15] ^= w[(t + 13) & 15] ^ w[(t + 8) & 15] ^ w[(t + 2) & 15];
+      RotateLeft(w[t & 15], 1);
+    }
+    Vector temp = a;
+    RotateLeft(temp, 5);
+    temp += f + e + w[t & 15] + k;
+    e = d;
+    d = c;
+    c = b;
+    RotateLeft(c, 30);
+    b = a;
+    a = temp;
+  }
+
+  template <typename Vector, size_t kLanes>
+  ALWAYS_INLINE static void Compress(Vector* state,
+                                     const uint8_t* const* blocks) {
+    Vector w[16];
+    LoadWords<Vector, kLanes, kBigEndian>(blocks, w);
+    Vector a = state[0], b = state[1], c = state[2], d = state[3],
+           e = state[4];
+    for (size_t t = 0; t < 20; ++t)
+      Round(t, (b & c) | (~b & d), 0x5a827999, w, a, b, c, d, e);
+    for (size_t t = 20; t < 40; ++t)
+      Round(t, b ^ c ^ d, 0x6ed9eba1, w, a, b, c, d, e);
+    for (size_t t = 40; t < 60; ++t)
+      Round(t, (b & c) | (b & d) | (c & d), 0x8f1bbcdc, w, a, b, c, d, e);
+    for (size_t t = 60; t < 80; ++t)
+      Round(t, b ^ c ^ d, 0xca62c1d6, w, a, b, c, d, e);
+    state[0] += a;
+    state[1] += b;
+    state[2] += c;
+    state[3] += d;
+    state[4] += e;
+  }
+};
+
+// MD5, as RFC 1321 describes it.
+struct MD5Algorithm {
+  using Digest = MD5Digest;
+  static constexpr size_t kStateWords = 4;
+  static constexpr bool kBigEndian = false;
+  static constexpr uint32_t kInitialState[kStateWords] = {
+      0x67452301, 0xefcdab89, 0x98badcfe, 0x10325476};
+
+  static uint8_t* Bytes(Digest& digest) { return digest.a; }
+
+  // Step |t| of the 4 rounds.
+  template <typename Vector>
+  ALWAYS_INLINE static void Step(size_t t,
+                                 const Vector& f,
+                                 const Vector& w,
+                                 Vector& a,
+                                 Vector& b,
+                                 Vector& c,
+                                 Vector& d) {
+    // The integer parts of |sin(i + 1)| * 2^32.
+    static constexpr uint32_t kK[64] = {
+        0xd76aa478, 0xe8c7b756, 0x242070db, 0xc1bdceee, 0xf57c0faf, 0x4787c62a,
+        0xa8304613, 0xfd469501, 0x698098d8, 0x8b44f7af, 0xffff5bb1, 0x895cd7be,
+        0x6b901122, 0xfd987193, 0xa679438e, 0x49b40821, 0xf61e2562, 0xc040b340,
+        0x265e5a51, 0xe9b6c7aa, 0xd62f105d, 0x02441453, 0xd8a1e681, 0xe7d3fbc8,
+        0x21e1cde6, 0xc33707d6, 0xf4d50d87, 0x455a14ed, 0xa9e3e905, 0xfcefa3f8,
+        0x676f02d9, 0x8d2a4c8a, 0xfffa3942, 0x8771f681, 0x6d9d6122, 0xfde5380c,
+        0xa4beea44, 0x4bdecfa9, 0xf6bb4b60, 0xbebfbc70, 0x289b7ec6, 0xeaa127fa,
+        0xd4ef3085, 0x04881d05, 0xd9d4d039, 0xe6db99e5, 0x1fa27cf8, 0xc4ac5665,
+        0xf4292244, 0x432aff97, 0xab9423a7, 0xfc93a039, 0x655b59c3, 0x8f0ccc92,
+        0xffeff47d, 0x85845dd1, 0x6fa87e4f, 0xfe2ce6e0, 0xa3014314, 0x4e0811a1,
+        0xf7537e82, 0xbd3af235, 0x2ad7d2bb, 0xeb86d391,
+    };
+    static constexpr int kShifts[4][4] = {
+        {7, 12, 17, 22}, {5, 9, 14, 20}, {4, 11, 16, 23}, {6, 10, 15, 21}};
+    Vector sum = a + f + kK[t] + w;
+    RotateLeft(sum, kShifts[t / 16][t & 3]);
+    a = d;
+    d = c;
+    c = b;
+    b += sum;
+  }
+
+  template <typename Vector, size_t kLanes>
+  ALWAYS_INLINE static void Compress(Vector* state,
+                                     const uint8_t* const* blocks) {
+    Vector w[16];
+    LoadWords<Vector, kLanes, kBigEndian>(blocks, w);
+    Vector a = state[0], b = state[1], c = state[2], d = state[3];
+    for (size_t t = 0; t < 16; ++t)
+      Step(t, (b & c) | (~b & d), w[t], a, b, c, d);
+    for (size_t t = 16; t < 32; ++t)
+      Step(t, (d & b) | (~d & c), w[(5 * t + 1) & 15], a, b, c, d);
+    for (size_t t = 32; t < 48; ++t)
+      Step(t, b ^ c ^ d, w[(3 * t + 5) & 15], a, b, c, d);
+    for (size_t t = 48; t < 64; ++t)
+      Step(t, c ^ (b | ~d), w[(7 * t) & 15], a, b, c, d);
+    state[0] += a;
+    state[1] += b;
+    state[2] += c;
+    state[3] += d;
+  }
+};
+
+// Copies the rest of |input| after its full blocks to |blocks|, padded, and
+// returns how many blocks it takes: 1 or 2.
+template <typename Algorithm>
+ALWAYS_INLINE size_t PadLastBlocks(span<const uint8_t> input,
+                                   uint8_t* blocks) {
+  const size_t rest = input.size() % kBlockSize;
+  if (rest)
+    memcpy(blocks, input.data() + input.size() - rest, rest);
+  blocks[rest] = 0x80;
+  // The size in bits takes the last 8 bytes.
+  const size_t block_count = rest + 1 + 8 <= kBlockSize ? 1 : 2;
+  const size_t padded_size = block_count * kBlockSize;
+  memset(blocks + rest + 1, 0, padded_size - 8 - rest - 1);
+  uint64_t bits = static_cast<uint64_t>(input.size()) * 8;
+  if (Algorithm::kBigEndian)
+    bits = ByteSwap(bits);
+  memcpy(blocks + padded_size - 8, &bits, sizeof(bits));
+  return block_count;
+}
+
+template <typename Algorithm>
+ALWAYS_INLINE void StoreDigest(const uint32_t* state,
+                               typename Algorithm::Digest& digest) {
+  uint8_t* bytes = Algorithm::Bytes(digest);
+  for (size_t word = 0; word < Algorithm::kStateWords; ++word) {
+    uint32_t value = state[word];
+    if (Algorithm::kBigEndian)
+      value = ByteSwap(value);
+    memcpy(bytes + 4 * word, &value, sizeof(value));
+  }
+}
+
+// What is left to hash of the input in a lane.
+struct Lane {
+  // The index of the input, or |kIdle|.
+  size_t input;
+  // The full blocks of the input.
+  const uint8_t* data;
+  size_t full_blocks;
+  // Then the rest of the input, padded, in 1 or 2 blocks.
+  uint8_t last_blocks[2 * kBlockSize];
+  size_t last_block_count;
+  size_t next_last_block;
+};
+
+constexpr size_t kIdle = static_cast<size_t>(-1);
+
+// Moves |lane| to the next input, if any is left.
+template <typename Algorithm, typename Vector>
+ALWAYS_INLINE void StartNextInput(span<const span<const uint8_t>> inputs,
+                                  size_t& next_input,
+                                  Vector* state,
+                                  size_t lane_index,
+                                  Lane& lane) {
+  if (next_input == inputs.size()) {
+    lane.input = kIdle;
+    return;
+  }
+  lane.input = next_input++;
+  const span<const uint8_t> input = inputs[lane.input];
+  lane.data = input.data();
+  lane.full_blocks = input.size() / kBlockSize;
+  lane.last_block_count =
+      PadLastBlocks<Algorithm>(input, lane.last_blocks);
+  lane.next_last_block = 0;
+  for (size_t i = 0; i < Algorithm::kStateWords; ++i)
+    state[i][lane_index] = Algorithm::kInitialState[i];
+}
+
+template <typename Algorithm, typename Vector, size_t kLanes>
+ALWAYS_INLINE void HashInLanes(span<const span<const uint8_t>> inputs,
+                               span<typename Algorithm::Digest> digests) {
+  static constexpr uint8_t kIdleBlock[kBlockSize] = {};
+  Vector state[Algorithm::kStateWords] = {};
+  Lane lanes[kLanes];
+  size_t next_input = 0;
+  for (size_t i = 0; i < kLanes; ++i) {
+    StartNextInput<Algorithm>(inputs, next_input, state, i, lanes[i]);
+  }
+
+  size_t active_lanes = std::min(kLanes, inputs.size());
+  while (active_lanes) {
+    const uint8_t* blocks[kLanes];
+    for (size_t i = 0; i < kLanes; ++i) {
+      Lane& lane = lanes[i];
+      if (lane.input == kIdle) {
+        blocks[i] = kIdleBlock;
+      } else if (lane.full_blocks) {
+        blocks[i] = lane.data;
+        lane.data += kBlockSize;
+        --lane.full_blocks;
+      } else {
+        blocks[i] = lane.last_blocks + kBlockSize * lane.next_last_block++;
+      }
+    }
+
+    Algorithm::template Compress<Vector, kLanes>(state, blocks);
+
+    for (size_t i = 0; i < kLanes; ++i) {
+      Lane& lane = lanes[i];
+      if (lane.input == kIdle || lane.full_blocks ||
+          lane.next_last_block < lane.last_block_count) {
+        continue;
+      }
+      uint32_t lane_state[Algorithm::kStateWords];
+      for (size_t word = 0; word < Algorithm::kStateWords; ++word)
+        lane_state[word] = state[word][i];
+      StoreDigest<Algorithm>(lane_state, digests[lane.input]);
+      StartNextInput<Algorithm>(inputs, next_input, state, i, lane);
+      if (lane.input == kIdle)
+        --active_lanes;
+    }
+  }
+}
+
+#if defined(HAS_VECTOR8_LANES)
+template <typename Algorithm>
+__attribute__((target("avx2"))) void HashIn8LanesAVX2(
+    span<const span<const uint8_t>> inputs,
+    span<typename Algorithm::Digest> digests) {
+  HashInLanes<Algorithm, Vector8, 8>(inputs, digests);
+}
+#endif
+
+#if defined(HAS_SHA1_INSTRUCTIONS) && defined(ARCH_CPU_X86_64)
+
+#define TARGET_SHA __attribute__((target("sha,ssse3,sse4.1")))
+
+// Four rounds of SHA-1, and the message schedule of later rounds: group |g|
+// loads or computes the words of group |g| + 4. |e0| and |e1| take turns
+// holding E ahead of the rounds and A behind them.
+template <int g>
+TARGET_SHA ALWAYS_INLINE void SHA1RoundsSHANI(const uint8_t* block,
+                                              const __m128i& shuffle_mask,
+                                              __m128i& abcd,
+                                              __m128i& e0,
+                                              __m128i& e1,
+                                              __m128i* msg) {
+  __m128i& e = g % 2 ? e1 : e0;
+  __m128i& next_e = g % 2 ? e0 : e1;
+  if constexpr (g < 4) {
+    msg[g] = _mm_shuffle_epi8(
+        _mm_loadu_si128(reinterpret_cast<const __m128i*>(block + 16 * g)),
+        shuffle_mask);
+  }
+  if constexpr (g == 0)
+    e = _mm_add_epi32(e, msg[0]);
+  else
+    e = _mm_sha1nexte_epu32(e, msg[g % 4]);
+  next_e = abcd;
+  if constexpr (g >= 3 && g <= 18)
+    msg[(g + 1) % 4] = _mm_sha1msg2_epu32(msg[(g + 1) % 4], msg[g % 4]);
+  abcd = _mm_sha1rnds4_epu32(abcd, e, g / 5);
+  if constexpr (g >= 1 && g <= 16)
+    msg[(g + 3) % 4] = _mm_sha1msg1_epu32(msg[(g + 3) % 4], msg[g % 4]);
+  if constexpr (g >= 2 && g <= 17)
+    msg[(g + 2) % 4] = _mm_xor_si128(msg[(g + 2) % 4], msg[g % 4]);
+}
+
+template <int... g>
+TARGET_SHA ALWAYS_INLINE void SHA1BlockSHANI(
+    const uint8_t* block,
+    const __m128i& shuffle_mask,
+    __m128i& abcd,
+    __m128i& e0,
+    std::integer_sequence<int, g...>) {
+  __m128i e1, msg[4];
+  (SHA1RoundsSHANI<g>(block, shuffle_mask, abcd, e0, e1, msg), ...);
+}
+
+TARGET_SHA void SHA1Compress(uint32_t* state,
+                             const uint8_t* blocks,
+                             size_t block_count) {
+  // Reverses the bytes of the 16 byte words, which also makes W[0] the high
+  // lane as the instructions take it.
+  const __m128i shuffle_mask =
+      _mm_set_epi64x(0x0001020304050607, 0x08090a0b0c0d0e0f);
+  __m128i abcd = _mm_shuffle_epi32(
+      _mm_loadu_si128(reinterpret_cast<const __m128i*>(state)), 0x1b);
+  __m128i e0 = _mm_set_epi32(static_cast<int>(state[4]), 0, 0, 0);
+  for (; block_count; --block_count, blocks += kBlockSize) {
+    const __m128i saved_abcd = abcd;
+    const __m128i saved_e0 = e0;
+    SHA1BlockSHANI(blocks, shuffle_mask, abcd, e0,
+                   std::make_integer_sequence<int, 20>());
+    e0 = _mm_sha1nexte_epu32(e0, saved_e0);
+    abcd = _mm_add_epi32(abcd, saved_abcd);
+  }
+  _mm_storeu_si128(reinterpret_cast<__m128i*>(state),
+                   _mm_shuffle_epi32(abcd, 0x1b));
+  state[4] = static_cast<uint32_t>(_mm_extract_epi32(e0, 3));
+}
+
+#elif defined(HAS_SHA1_INSTRUCTIONS) && defined(ARCH_CPU_ARM64)
+
+#if defined(__clang__)
+#define TARGET_SHA __attribute__((target("crypto")))
+#else
+#define TARGET_SHA __attribute__((target("+crypto")))
+#endif
+
+// Four rounds of SHA-1, and the message schedule of later rounds: group |g|
+// adds the constant to the words of group |g| + 2 and extends the words of
+// group |g| + 4. |e0| and |e1| take turns holding E.
+template <int g>
+TARGET_SHA ALWAYS_INLINE void SHA1RoundsArmv8(uint32x4_t& abcd,
+                                              uint32_t& e0,
+                                              uint32_t& e1,
+                                              uint32x4_t* msg,
+                                              uint32x4_t* words_plus_k) {
+  static constexpr uint32_t kK[4] = {0x5a827999, 0x6ed9eba1, 0x8f1bbcdc,
+                                     0xca62c1d6};
+  const uint32_t e = g % 2 ? e1 : e0;
+  uint32_t& next_e = g % 2 ? e0 : e1;
+  next_e = vsha1h_u32(vgetq_lane_u32(abcd, 0));
+  if constexpr (g < 5)
+    abcd = vsha1cq_u32(abcd, e, words_plus_k[g % 2]);
+  else if constexpr (g >= 10 && g < 15)
+    abcd = vsha1mq_u32(abcd, e, words_plus_k[g % 2]);
+  else
+    abcd = vsha1pq_u32(abcd, e, words_plus_k[g % 2]);
+  if constexpr (g + 2 < 20) {
+    words_plus_k[g % 2] =
+        vaddq_u32(msg[(g + 2) % 4], vdupq_n_u32(kK[(g + 2) / 5]));
+  }
+  if constexpr (g <= 15) {
+    msg[g % 4] =
+        vsha1su0q_u32(msg[g % 4], msg[(g + 1) % 4], msg[(g + 2) % 4]);
+  }
+  if constexpr (g >= 1 && g <= 16)
+    msg[(g + 3) % 4] = vsha1su1q_u32(msg[(g + 3) % 4], msg[(g + 2) % 4]);
+}
+
+template <int... g>
+TARGET_SHA ALWAYS_INLINE void SHA1BlockArmv8(
+    const uint8_t* block,
+    uint32x4_t& abcd,
+    uint32_t& e0,
+    std::integer_sequence<int, g...>) {
+  uint32x4_t msg[4];
+  for (size_t i = 0; i < 4; ++i) {
+    msg[i] = vreinterpretq_u32_u8(vrev32q_u8(vld1q_u8(block + 16 * i)));
+  }
+  uint32x4_t words_plus_k[2] = {vaddq_u32(msg[0], vdupq_n_u32(0x5a827999)),
+                                vaddq_u32(msg[1], vdupq_n_u32(0x5a827999))};
+  uint32_t e1;
+  (SHA1RoundsArmv8<g>(abcd, e0, e1, msg, words_plus_k), ...);
+}
+
+TARGET_SHA void SHA1Compress(uint32_t* state,
+                             const uint8_t* blocks,
+                             size_t block_count) {
+  uint32x4_t abcd = vld1q_u32(state);
+  uint32_t e0 = state[4];
+  for (; block_count; --block_count, blocks += kBlockSize) {
+    const uint32x4_t saved_abcd = abcd;
+    const uint32_t saved_e0 = e0;
+    SHA1BlockArmv8(blocks, abcd, e0, std::make_integer_sequence<int, 20>());
+    abcd = vaddq_u32(abcd, saved_abcd);
+    e0 += saved_e0;
+  }
+  vst1q_u32(state, abcd);
+  state[4] = e0;
+}
+
+#endif
+
+#if defined(HAS_SHA1_INSTRUCTIONS)
+// One input at a time, each block in the SHA-1 instructions.
+void SHA1HashWithInstructions(span<const span<const uint8_t>> inputs,
+                              span<SHA1Digest> digests) {
+  for (size_t i = 0; i < inputs.size(); ++i) {
+    uint32_t state[SHA1Algorithm::kStateWords];
+    memcpy(state, SHA1Algorithm::kInitialState, sizeof(state));
+    SHA1Compress(state, inputs[i].data(), inputs[i].size() / kBlockSize);
+    uint8_t last_blocks[2 * kBlockSize];
+    SHA1Compress(state, last_blocks,
+                 PadLastBlocks<SHA1Algorithm>(inputs[i], last_blocks));
+    StoreDigest<SHA1Algorithm>(state, digests[i]);
+  }
+}
+#endif
+
+template <typename Algorithm>
+void HashSpansWithPath(MultiBufferHashPath path,
+                       span<const span<const uint8_t>> inputs,
+                       span<typename Algorithm::Digest> digests) {
+  CHECK_EQ(inputs.size(), digests.size());
+  DCHECK(IsMultiBufferHashPathSupported(path));
+  switch (path) {
+    case MultiBufferHashPath::kPortable:
+      HashInLanes<Algorithm, Vector1, 1>(inputs, digests);
+      return;
+    case MultiBufferHashPath::k4Lanes:
+#if defined(HAS_VECTOR4_LANES)
+      HashInLanes<Algorithm, Vector4, 4>(inputs, digests);
+#endif
+      return;
+    case MultiBufferHashPath::k8Lanes:
+#if defined(HAS_VECTOR8_LANES)
+      HashIn8LanesAVX2<Algorithm>(inputs, digests);
+#endif
+      return;
+    case MultiBufferHashPath::kSHA1Instructions:
+      // Only SHA1HashSpansWithPath() takes it.
+      NOTREACHED();
+      return;
+  }
+}
+
+}  // namespace
+
+bool IsMultiBufferHashPathSupported(MultiBufferHashPath path) {
+  switch (path) {
+    case MultiBufferHashPath::kPortable:
+      return true;
+    case MultiBufferHashPath::k4Lanes:
+#if defined(HAS_VECTOR4_LANES)
+      return true;
+#else
+      return false;
+#endif
+    case MultiBufferHashPath::k8Lanes: {
+#if defined(HAS_VECTOR8_LANES)
+      static const bool has_avx2 = CPU().has_avx2();
+      return has_avx2;
+#else
+      return false;
+#endif
+    }
+    case MultiBufferHashPath::kSHA1Instructions: {
+#if defined(HAS_SHA1_INSTRUCTIONS)
+      static const bool has_sha1 = CPU().has_sha1();
+      return has_sha1;
+#else
+      return false;
+#endif
+    }
+  }
+  NOTREACHED();
+  return false;
+}
+
+void SHA1HashSpansWithPath(MultiBufferHashPath path,
+                           span<const span<const uint8_t>> inputs,
+                           span<SHA1Digest> digests) {
+  if (path != MultiBufferHashPath::kSHA1Instructions) {
+    HashSpansWithPath<SHA1Algorithm>(path, inputs, digests);
+    return;
+  }
+  CHECK_EQ(inputs.size(), digests.size());
+  DCHECK(IsMultiBufferHashPathSupported(path));
+#if defined(HAS_SHA1_INSTRUCTIONS)
+  SHA1HashWithInstructions(inputs, digests);
+#endif
+}
+
+void MD5SumSpansWithPath(MultiBufferHashPath path,
+                         span<const span<const uint8_t>> inputs,
+                         span<MD5Digest> digests) {
+  DCHECK_NE(path, MultiBufferHashPath::kSHA1Instructions);
+  HashSpansWithPath<MD5Algorithm>(path, inputs, digests);
+}
+
+}  // namespace internal
+
+namespace {
+
+using internal::IsMultiBufferHashPathSupported;
+using internal::MultiBufferHashPath;
+
+MultiBufferHashPath FastestLanes() {
+  if (IsMultiBufferHashPathSupported(MultiBufferHashPath::k8Lanes))
+    return MultiBufferHashPath::k8Lanes;
+  if (IsMultiBufferHashPathSupported(MultiBufferHashPath::k4Lanes))
+    return MultiBufferHashPath::k4Lanes;
+  return MultiBufferHashPath::kPortable;
+}
+
+MultiBufferHashPath FastestSHA1Path() {
+  if (IsMultiBufferHashPathSupported(MultiBufferHashPath::kSHA1Instructions))
+    return MultiBufferHashPath::kSHA1Instructions;
+  return FastestLanes();
+}
+
+}  // namespace
+
+void SHA1HashSpans(span<const span<const uint8_t>> inputs,
+                   span<SHA1Digest> digests) {
+  CHECK_EQ(inputs.size(), digests.size());
+  if (inputs.size() == 1) {
+    digests[0] = SHA1HashSpan(inputs[0]);
+    return;
+  }
+  internal::SHA1HashSpansWithPath(FastestSHA1Path(), inputs, digests);
+}
+
+void MD5SumSpans(span<const span<const uint8_t>> inputs,
+                 span<MD5Digest> digests) {
+  CHECK_EQ(inputs.size(), digests.size());
+  if (inputs.size() == 1) {
+    MD5Sum(inputs[0].data(), inputs[0].size(), &digests[0]);
+    return;
+  }
+  internal::MD5SumSpansWithPath(FastestLanes(), inputs, digests);
+}
+
+}  // namespace base
@@ -0,0 +1,46 @@
+// Copyright 2022 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#ifndef BASE_HASH_MULTI_BUFFER_HASH_INTERNAL_H_
+#define BASE_HASH_MULTI_BUFFER_HASH_INTERNAL_H_
+
+#include <stdint.h>
+
+#include "base/base_export.h"
+#include "base/containers/span.h"
+#include "base/hash/md5.h"
+#include "base/hash/sha1.h"
+
+namespace base {
+namespace internal {
+
+// The implementations of SHA1HashSpans() and MD5SumSpans(), exposed for the
+// tests. The lanes hash as many inputs at a time as they are: one block of
+// each, with 32-bit integer SIMD instructions.
+enum class MultiBufferHashPath {
+  // Portable code, one input at a time.
+  kPortable,
+  // SSE2 on x86-64, NEON on arm64.
+  k4Lanes,
+  // AVX2 on x86-64.
+  k8Lanes,
+  // The SHA extensions on x86-64, the Armv8 SHA1 instructions on arm64: one
+  // input at a time. SHA-1 only.
+  kSHA1Instructions,
+};
+
+// Whether the build and the CPU have the instructions of |path|.
+BASE_EXPORT bool IsMultiBufferHashPathSupported(MultiBufferHashPath path);
+
+BASE_EXPORT void SHA1HashSpansWithPath(MultiBufferHashPath path,
+                                       span<const span<const uint8_t>> inputs,
+                                       span<SHA1Digest> digests);
+BASE_EXPORT void MD5SumSpansWithPath(MultiBufferHashPath path,
+                                     span<const span<const uint8_t>> inputs,
+                                     span<MD5Digest> digests);
+
+}  // namespace internal
+}  // namespace base
+
+#endif  // BASE_HASH_MULTI_BUFFER_HASH_INTERNAL_H_
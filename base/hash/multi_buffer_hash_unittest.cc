@@ -0,0 +1,130 @@
+// Copyright 2022 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "base/hash/multi_buffer_hash_internal.h"
+
+#include <stddef.h>
+#include <stdint.h>
+#include <string.h>
+
+#include <vector>
+
+#include "base/hash/md5.h"
+#include "base/hash/sha1.h"
+#include "testing/gtest/include/gtest/gtest.h"
+
+namespace base {
+namespace internal {
+
+namespace {
+
+constexpr MultiBufferHashPath kPaths[] = {
+    MultiBufferHashPath::kPortable,
+    MultiBufferHashPath::k4Lanes,
+    MultiBufferHashPath::k8Lanes,
+    MultiBufferHashPath::kSHA1Instructions,
+};
+
+// Inputs of all the sizes up to |max_size|, in order if |interleave| is
+// false, and else with long and short ones mixed, so that the lanes finish
+// at different times.
+struct Inputs {
+  Inputs(size_t max_size, bool interleave) : data(max_size + 1) {
+    for (size_t i = 0; i < data.size(); ++i)
+      data[i] = static_cast<uint8_t>(i * 7 + 3);
+    for (size_t i = 0; i <= max_size; ++i) {
+      const size_t size = interleave && i % 2 ? max_size - i : i;
+      spans.push_back(make_span(data.data() + max_size - size, size));
+    }
+  }
+
+  std::vector<uint8_t> data;
+  std::vector<span<const uint8_t>> spans;
+};
+
+bool operator==(const MD5Digest& a, const MD5Digest& b) {
+  return memcmp(a.a, b.a, sizeof(a.a)) == 0;
+}
+
+}  // namespace
+
+TEST(MultiBufferHashTest, SHA1MatchesOneAtATime) {
+  for (bool interleave : {false, true}) {
+    Inputs inputs(300, interleave);
+    std::vector<SHA1Digest> expected;
+    for (span<const uint8_t> input : inputs.spans)
+      expected.push_back(SHA1HashSpan(input));
+
+    for (MultiBufferHashPath path : kPaths) {
+      if (!IsMultiBufferHashPathSupported(path))
+        continue;
+      std::vector<SHA1Digest> digests(inputs.spans.size());
+      SHA1HashSpansWithPath(path, inputs.spans, digests);
+      for (size_t i = 0; i < digests.size(); ++i) {
+        EXPECT_EQ(expected[i], digests[i])
+            << "path " << static_cast<int>(path) << ", size "
+            << inputs.spans[i].size();
+      }
+    }
+
+    std::vector<SHA1Digest> digests(inputs.spans.size());
+    SHA1HashSpans(inputs.spans, digests);
+    EXPECT_EQ(expected, digests);
+  }
+}
+
+TEST(MultiBufferHashTest, MD5MatchesOneAtATime) {
+  for (bool interleave : {false, true}) {
+    Inputs inputs(300, interleave);
+    std::vector<MD5Digest> expected(inputs.spans.size());
+    for (size_t i = 0; i < inputs.spans.size(); ++i)
+      MD5Sum(inputs.spans[i].data(), inputs.spans[i].size(), &expected[i]);
+
+    for (MultiBufferHashPath path : kPaths) {
+      if (path == MultiBufferHashPath::kSHA1Instructions ||
+          !IsMultiBufferHashPathSupported(path)) {
+        continue;
+      }
+      std::vector<MD5Digest> digests(inputs.spans.size());
+      MD5SumSpansWithPath(path, inputs.spans, digests);
+      for (size_t i = 0; i < digests.size(); ++i) {
+        EXPECT_TRUE(expected[i] == digests[i])
+            << "path " << static_cast<int>(path) << ", size "
+            << inputs.spans[i].size();
+      }
+    }
+
+    std::vector<MD5Digest> digests(inputs.spans.size());
+    MD5SumSpans(inputs.spans, digests);
+    for (size_t i = 0; i < digests.size(); ++i)
+      EXPECT_TRUE(expected[i] == digests[i]);
+  }
+}
+
+TEST(MultiBufferHashTest, LongInputs) {
+  std::vector<uint8_t> data(100000);
+  for (size_t i = 0; i < data.size(); ++i)
+    data[i] = static_cast<uint8_t>(i ^ (i >> 8));
+  const span<const uint8_t> inputs[] = {
+      make_span(data), make_span(data).first(3), make_span(data).last(65537)};
+
+  SHA1Digest sha1_digests[3];
+  SHA1HashSpans(inputs, sha1_digests);
+  MD5Digest md5_digests[3];
+  MD5SumSpans(inputs, md5_digests);
+  for (size_t i = 0; i < 3; ++i) {
+    EXPECT_EQ(SHA1HashSpan(inputs[i]), sha1_digests[i]);
+    MD5Digest expected;
+    MD5Sum(inputs[i].data(), inputs[i].size(), &expected);
+    EXPECT_TRUE(expected == md5_digests[i]);
+  }
+}
+
+TEST(MultiBufferHashTest, NoInputs) {
+  SHA1HashSpans({}, {});
+  MD5SumSpans({}, {});
+}
+
+}  // namespace internal
+}  // namespace base
@@ -38,6 +38,11 @@ BASE_EXPORT std::string SHA1HashString(StringPiece str);
 BASE_EXPORT void SHA1HashBytes(const unsigned char* data,
                                size_t len,
                                unsigned char* hash);
+// Computes the SHA-1 hashes of all of |inputs| into |digests|, which must be
+// as many. Several inputs hash faster at once than one after the other: they
+// share the SIMD instructions of the CPU, or its SHA instructions.
+BASE_EXPORT void SHA1HashSpans(span<const span<const uint8_t>> inputs,
+                               span<SHA1Digest> digests);
 
 // These functions allow streaming SHA-1 operations.
 BASE_EXPORT void SHA1Init(SHA1Context& context);
@@ -11,6 +11,7 @@
 #include "base/lazy_instance.h"
 #include "base/memory/raw_ptr.h"
 #include "base/notreached.h"
+#include "base/strings/ascii_simd.h"
 #include "base/synchronization/lock.h"
 #include "third_party/icu/source/common/unicode/ubrk.h"
 #include "third_party/icu/source/common/unicode/uchar.h"
@@ -58,11 +59,22 @@ class DefaultLocaleBreakIteratorCache {
     if (U_FAILURE(main_status_)) {
       NOTREACHED() << "ubrk_open failed for type " << break_type
                    << " with error " << main_status_;
+      return;
     }
+    UErrorCode status = U_ZERO_ERROR;
+    const char* locale =
+        ubrk_getLocaleByType(main_, ULOC_ACTUAL_LOCALE, &status);
+    uses_root_rules_ = U_SUCCESS(status) && locale &&
+                       (!*locale || StringPiece(locale) == "root");
   }
 
   virtual ~DefaultLocaleBreakIteratorCache() { ubrk_close(main_); }
 
+  // Whether the iterators use the rules of the root locale, rather than rules
+  // tailored for the default locale, e.g. the Swedish word rules, under which
+  // colons don't break words.
+  bool uses_root_rules() const { return uses_root_rules_; }
+
   UBreakIterator* Lease(UErrorCode& status) {
     if (U_FAILURE(status)) {
       return nullptr;
@@ -105,6 +117,7 @@ class DefaultLocaleBreakIteratorCache {
  private:
   UErrorCode main_status_;
   raw_ptr<UBreakIterator> main_;
+  bool uses_root_rules_ = false;
   bool main_could_be_leased_ GUARDED_BY(lock_);
   Lock lock_;
 };
@@ -118,6 +131,271 @@ static LazyInstance<DefaultLocaleBreakIteratorCache<UBRK_SENTENCE>>::Leaky
 static LazyInstance<DefaultLocaleBreakIteratorCache<UBRK_LINE>>::Leaky
     line_break_cache = LAZY_INSTANCE_INITIALIZER;
 
+// The classes of the ASCII characters in the word break rules of UAX #29, as
+// ICU's root rules define them. They count the at sign as a letter, and the
+// colon isn't a MidLetter there, so no ASCII character is. The apostrophe
+// (Single_Quote) only differs from the period (MidNumLet) next to Hebrew
+// letters, so both are kMidNumLetQ.
+enum class AsciiWordBreak : uint8_t {
+  kOther,
+  kCR,
+  kLF,
+  kNewline,
+  kALetter,
+  kNumeric,
+  kMidNum,
+  kMidNumLetQ,
+  kExtendNumLet,
+  kWSegSpace,
+};
+
+// The classes of the ASCII characters in the line break rules of UAX #14.
+// The fast path only handles the classes below, whose rules only look at the
+// characters on each side of a break, and at the next one. ICU breaks the
+// text from the first kUnsupported character on.
+enum class AsciiLineBreak : uint8_t {
+  kUnsupported,
+  kCR,
+  kLF,
+  kSP,
+  kAL,
+  kNU,
+  kIS,
+  kEX,
+};
+
+constexpr AsciiWordBreak GetAsciiWordBreak(char c) {
+  if ((c >= 'A' && c <= 'Z') || (c >= 'a' && c <= 'z') || c == '@')
+    return AsciiWordBreak::kALetter;
+  if (c >= '0' && c <= '9')
+    return AsciiWordBreak::kNumeric;
+  switch (c) {
+    case '\r':
+      return AsciiWordBreak::kCR;
+    case '\n':
+      return AsciiWordBreak::kLF;
+    case '\v':
+    case '\f':
+      return AsciiWordBreak::kNewline;
+    case ',':
+    case ';':
+      return AsciiWordBreak::kMidNum;
+    case '.':
+    case '\'':
+      return AsciiWordBreak::kMidNumLetQ;
+    case '_':
+      return AsciiWordBreak::kExtendNumLet;
+    case ' ':
+      return AsciiWordBreak::kWSegSpace;
+    default:
+      return AsciiWordBreak::kOther;
+  }
+}
+
+constexpr AsciiLineBreak GetAsciiLineBreak(char c) {
+  if ((c >= 'A' && c <= 'Z') || (c >= 'a' && c <= 'z'))
+    return AsciiLineBreak::kAL;
+  if (c >= '0' && c <= '9')
+    return AsciiLineBreak::kNU;
+  switch (c) {
+    case '\r':
+      return AsciiLineBreak::kCR;
+    case '\n':
+      return AsciiLineBreak::kLF;
+    case ' ':
+      return AsciiLineBreak::kSP;
+    case '#':
+    case '&':
+    case '*':
+    case '<':
+    case '=':
+    case '>':
+    case '@':
+    case '^':
+    case '_':
+    case '`':
+    case '~':
+      return AsciiLineBreak::kAL;
+    case ',':
+    case '.':
+    case ':':
+    case ';':
+      return AsciiLineBreak::kIS;
+    case '!':
+    case '?':
+      return AsciiLineBreak::kEX;
+    default:
+      return AsciiLineBreak::kUnsupported;
+  }
+}
+
+struct AsciiBreakTables {
+  constexpr AsciiBreakTables() {
+    for (int c = 0; c < 0x80; ++c) {
+      word[c] = GetAsciiWordBreak(static_cast<char>(c));
+      line[c] = GetAsciiLineBreak(static_cast<char>(c));
+    }
+  }
+
+  AsciiWordBreak word[0x80] = {};
+  AsciiLineBreak line[0x80] = {};
+};
+
+constexpr AsciiBreakTables kAsciiBreakTables;
+
+// The callers check |i|, and that text[i] is ASCII.
+AsciiWordBreak GetWordBreakAt(StringPiece16 text, size_t i) {
+  return kAsciiBreakTables.word[text.data()[i]];
+}
+
+AsciiLineBreak GetLineBreakAt(StringPiece16 text, size_t i) {
+  return kAsciiBreakTables.line[text.data()[i]];
+}
+
+bool IsAlphanumeric(AsciiWordBreak word_break) {
+  return word_break == AsciiWordBreak::kALetter ||
+         word_break == AsciiWordBreak::kNumeric;
+}
+
+bool IsMidNum(AsciiWordBreak word_break) {
+  return word_break == AsciiWordBreak::kMidNum ||
+         word_break == AsciiWordBreak::kMidNumLetQ;
+}
+
+// Returns whether there is a word break between text[i - 1] and text[i], for
+// 0 < i < text.size(). The characters from text[i - 2] to text[i + 1] must be
+// ASCII.
+bool IsAsciiWordBreak(StringPiece16 text, size_t i) {
+  const AsciiWordBreak before = GetWordBreakAt(text, i - 1);
+  const AsciiWordBreak after = GetWordBreakAt(text, i);
+  const bool has_next = i + 1 < text.size();
+  // WB3, WB3a, WB3b: around newlines, but not within CR LF.
+  if (before == AsciiWordBreak::kCR && after == AsciiWordBreak::kLF)
+    return false;
+  if (before == AsciiWordBreak::kCR || before == AsciiWordBreak::kLF ||
+      before == AsciiWordBreak::kNewline || after == AsciiWordBreak::kCR ||
+      after == AsciiWordBreak::kLF || after == AsciiWordBreak::kNewline) {
+    return true;
+  }
+  // WB3d: not within spaces.
+  if (before == AsciiWordBreak::kWSegSpace &&
+      after == AsciiWordBreak::kWSegSpace) {
+    return false;
+  }
+  // WB5, WB8, WB9, WB10: not within letters and digits.
+  if (IsAlphanumeric(before) && IsAlphanumeric(after))
+    return false;
+  // WB6, WB7: not around a period or an apostrophe between letters.
+  if (before == AsciiWordBreak::kALetter &&
+      after == AsciiWordBreak::kMidNumLetQ) {
+    return !has_next ||
+           GetWordBreakAt(text, i + 1) != AsciiWordBreak::kALetter;
+  }
+  if (before == AsciiWordBreak::kMidNumLetQ &&
+      after == AsciiWordBreak::kALetter) {
+    return i < 2 || GetWordBreakAt(text, i - 2) != AsciiWordBreak::kALetter;
+  }
+  // WB11, WB12: nor around a comma, a semicolon, a period or an apostrophe
+  // between digits.
+  if (before == AsciiWordBreak::kNumeric && IsMidNum(after))
+    return !has_next || GetWordBreakAt(text, i + 1) != AsciiWordBreak::kNumeric;
+  if (IsMidNum(before) && after == AsciiWordBreak::kNumeric)
+    return i < 2 || GetWordBreakAt(text, i - 2) != AsciiWordBreak::kNumeric;
+  // WB13a, WB13b: nor around underscores next to letters and digits.
+  if (after == AsciiWordBreak::kExtendNumLet)
+    return !IsAlphanumeric(before) && before != AsciiWordBreak::kExtendNumLet;
+  if (before == AsciiWordBreak::kExtendNumLet)
+    return !IsAlphanumeric(after);
+  // WB999.
+  return true;
+}
+
+// Returns whether the segment of |text| which starts at |begin| and ends at
+// the word break |end| is a word: ICU gives a word status to the segments
+// which start with a letter or a digit, and to runs of 2 underscores or more,
+// which the rules only join when there are letters or digits in them.
+bool IsAsciiWord(StringPiece16 text, size_t begin, size_t end) {
+  const AsciiWordBreak first = GetWordBreakAt(text, begin);
+  return IsAlphanumeric(first) ||
+         (first == AsciiWordBreak::kExtendNumLet && end - begin > 1);
+}
+
+// Returns whether |position| is a word break of |text|, whose characters must
+// all be ASCII, including at its start and end.
+bool IsAsciiWordBoundary(StringPiece16 text, size_t position) {
+  return position == 0 || position == text.size() ||
+         (position < text.size() && IsAsciiWordBreak(text, position));
+}
+
+// Returns whether the segment of |text| which ends at the word break |end| is
+// a word. The characters of |text| must all be ASCII.
+bool EndsAsciiWord(StringPiece16 text, size_t end) {
+  if (end == 0)
+    return false;
+  const AsciiWordBreak last = GetWordBreakAt(text, end - 1);
+  return IsAlphanumeric(last) ||
+         (last == AsciiWordBreak::kExtendNumLet && end > 1 &&
+          !IsAsciiWordBreak(text, end - 1));
+}
+
+// Returns whether there is a line break between text[i - 1] and text[i], for
+// 0 < i < text.size(). The characters from text[i - 1] to text[i + 1] must be
+// ASCII, and not AsciiLineBreak::kUnsupported.
+bool IsAsciiLineBreak(StringPiece16 text, size_t i) {
+  const AsciiLineBreak before = GetLineBreakAt(text, i - 1);
+  const AsciiLineBreak after = GetLineBreakAt(text, i);
+  // LB4, LB5: after newlines, but not within CR LF.
+  if (before == AsciiLineBreak::kCR)
+    return after != AsciiLineBreak::kLF;
+  if (before == AsciiLineBreak::kLF)
+    return true;
+  // LB6, LB7: not before newlines and spaces.
+  if (after == AsciiLineBreak::kCR || after == AsciiLineBreak::kLF ||
+      after == AsciiLineBreak::kSP) {
+    return false;
+  }
+  // LB13: nor before exclamation or question marks and infix separators,
+  // even after spaces, unless a digit follows the separator: ICU's rules
+  // break before the period of " .5".
+  if (after == AsciiLineBreak::kEX)
+    return false;
+  if (after == AsciiLineBreak::kIS) {
+    return before == AsciiLineBreak::kSP && i + 1 < text.size() &&
+           GetLineBreakAt(text, i + 1) == AsciiLineBreak::kNU;
+  }
+  // LB18: after spaces.
+  if (before == AsciiLineBreak::kSP)
+    return true;
+  // LB23, LB25, LB28, LB29: not within letters, digits and infix separators.
+  // LB31: after exclamation or question marks.
+  return before == AsciiLineBreak::kEX;
+}
+
+// Returns the first break of |text| after |pos| under |break_type|, or
+// npos if it depends on the characters from |ascii_end| on.
+template <BreakIterator::BreakType break_type>
+size_t FindNextAsciiBreak(StringPiece16 text, size_t ascii_end, size_t pos) {
+  size_t i = pos + 1;
+  for (; i < text.size(); ++i) {
+    // Neither words nor lines break between letters and digits, so their runs
+    // are skipped a block at a time.
+    if (i < ascii_end && IsAlphanumeric(GetWordBreakAt(text, i - 1))) {
+      i += internal::CountLeadingASCIIAlphanumerics(text.data() + i,
+                                                    ascii_end - i);
+      if (i == text.size())
+        break;
+    }
+    // Breaks may depend on the character after them.
+    if (ascii_end < text.size() && i + 1 >= ascii_end)
+      return npos;
+    if (break_type == BreakIterator::BREAK_WORD ? IsAsciiWordBreak(text, i)
+                                                : IsAsciiLineBreak(text, i)) {
+      return i;
+    }
+  }
+  return ascii_end == text.size() ? text.size() : npos;
+}
+
 }  // namespace
 
 BreakIterator::~BreakIterator() {
@@ -150,6 +428,13 @@ BreakIterator::~BreakIterator() {
 }
 
 bool BreakIterator::Init() {
+  InitAsciiPath();
+  if (IsAsciiPathForWholeString())
+    return true;
+  return InitIcuIterator();
+}
+
+bool BreakIterator::InitIcuIterator() {
   UErrorCode status = U_ZERO_ERROR;
   UParseError parse_error;
   switch (break_type_) {
@@ -197,10 +482,61 @@ bool BreakIterator::Init() {
   return true;
 }
 
+void BreakIterator::InitAsciiPath() {
+  switch (break_type_) {
+    case BREAK_WORD:
+      use_ascii_path_ = word_break_cache.Pointer()->uses_root_rules();
+      break;
+    case BREAK_LINE:
+      use_ascii_path_ = line_break_cache.Pointer()->uses_root_rules();
+      break;
+    default:
+      use_ascii_path_ = false;
+      break;
+  }
+  ascii_is_word_ = false;
+  if (!use_ascii_path_) {
+    ascii_end_ = 0;
+    return;
+  }
+  ascii_end_ = internal::FindFirstNonASCII(string_.data(), string_.size());
+  if (break_type_ == BREAK_LINE) {
+    for (size_t i = 0; i < ascii_end_; ++i) {
+      if (GetLineBreakAt(string_, i) == AsciiLineBreak::kUnsupported) {
+        ascii_end_ = i;
+        break;
+      }
+    }
+  }
+}
+
 bool BreakIterator::Advance() {
   int32_t pos;
   int32_t status;
   prev_ = pos_;
+  if (use_ascii_path_) {
+    if (pos_ == npos || pos_ == string_.size()) {
+      pos_ = npos;
+      ascii_is_word_ = false;
+      return false;
+    }
+    pos_ = break_type_ == BREAK_WORD
+               ? FindNextAsciiBreak<BREAK_WORD>(string_, ascii_end_, prev_)
+               : FindNextAsciiBreak<BREAK_LINE>(string_, ascii_end_, prev_);
+    if (pos_ != npos) {
+      ascii_is_word_ =
+          break_type_ == BREAK_WORD && IsAsciiWord(string_, prev_, pos_);
+      return true;
+    }
+    // ICU breaks the rest of the string, from the last break on.
+    use_ascii_path_ = false;
+    pos = ubrk_following(static_cast<UBreakIterator*>(iter_),
+                         static_cast<int32_t>(prev_));
+    if (pos == UBRK_DONE)
+      return false;
+    pos_ = static_cast<size_t>(pos);
+    return true;
+  }
   switch (break_type_) {
     case BREAK_CHARACTER:
     case BREAK_WORD:
@@ -234,15 +570,22 @@ bool BreakIterator::Advance() {
 }
 
 bool BreakIterator::SetText(const char16_t* text, const size_t length) {
-  UErrorCode status = U_ZERO_ERROR;
-  ubrk_setText(static_cast<UBreakIterator*>(iter_), text, length, &status);
   pos_ = 0;  // implicit when ubrk_setText is done
   prev_ = npos;
+  string_ = StringPiece16(text, length);
+  InitAsciiPath();
+  if (IsAsciiPathForWholeString())
+    return true;
+  // The iterator isn't leased yet if the previous text was all handled by the
+  // fast path.
+  if (!iter_)
+    return InitIcuIterator();
+  UErrorCode status = U_ZERO_ERROR;
+  ubrk_setText(static_cast<UBreakIterator*>(iter_), text, length, &status);
   if (U_FAILURE(status)) {
     NOTREACHED() << "ubrk_setText failed";
     return false;
   }
-  string_ = StringPiece16(text, length);
   return true;
 }
 
@@ -251,9 +594,11 @@ bool BreakIterator::IsWord() const {
 }
 
 BreakIterator::WordBreakStatus BreakIterator::GetWordBreakStatus() const {
-  int32_t status = ubrk_getRuleStatus(static_cast<UBreakIterator*>(iter_));
   if (break_type_ != BREAK_WORD && break_type_ != RULE_BASED)
     return IS_LINE_OR_CHAR_BREAK;
+  if (use_ascii_path_)
+    return ascii_is_word_ ? IS_WORD_BREAK : IS_SKIPPABLE_WORD;
+  int32_t status = ubrk_getRuleStatus(static_cast<UBreakIterator*>(iter_));
   // In ICU 60, trying to advance past the end of the text does not change
   // |status| so that |pos_| has to be checked as well as |status|.
   // See http://bugs.icu-project.org/trac/ticket/13447 .
@@ -264,6 +609,10 @@ BreakIterator::WordBreakStatus BreakIterator::GetWordBreakStatus() const {
 bool BreakIterator::IsEndOfWord(size_t position) const {
   if (break_type_ != BREAK_WORD && break_type_ != RULE_BASED)
     return false;
+  if (IsAsciiPathForWholeString()) {
+    return IsAsciiWordBoundary(string_, position) &&
+           EndsAsciiWord(string_, position);
+  }
 
   UBreakIterator* iter = static_cast<UBreakIterator*>(iter_);
   UBool boundary = ubrk_isBoundary(iter, static_cast<int32_t>(position));
@@ -274,6 +623,17 @@ bool BreakIterator::IsEndOfWord(size_t position) const {
 bool BreakIterator::IsStartOfWord(size_t position) const {
   if (break_type_ != BREAK_WORD && break_type_ != RULE_BASED)
     return false;
+  if (IsAsciiPathForWholeString()) {
+    if (!IsAsciiWordBoundary(string_, position))
+      return false;
+    // There is no segment after the end of the string, and ICU gives the
+    // status of the last one instead.
+    if (position == string_.size())
+      return EndsAsciiWord(string_, position);
+    return IsAsciiWord(string_, position,
+                       FindNextAsciiBreak<BREAK_WORD>(string_, ascii_end_,
+                                                      position));
+  }
 
   UBreakIterator* iter = static_cast<UBreakIterator*>(iter_);
   UBool boundary = ubrk_isBoundary(iter, static_cast<int32_t>(position));
@@ -62,6 +62,12 @@
 //       VLOG(1) << "word: " << iter.GetString();
 //     }
 //   }
+//
+// Under BREAK_WORD and BREAK_LINE modes, the breaks in the ASCII prefix of the
+// string are found without ICU, as ICU's default rules would find them, unless
+// the default locale tailors those rules. ICU only breaks the rest of the
+// string. Under BREAK_LINE mode, the prefix also ends at the first character
+// whose rules need more context, e.g. a quote, a bracket, a hyphen or a tab.
 
 namespace base {
 namespace i18n {
@@ -173,6 +179,17 @@ class BASE_I18N_EXPORT BreakIterator {
   size_t pos() const { return pos_; }
 
  private:
+  // Leases or opens |iter_|, and sets its text.
+  bool InitIcuIterator();
+
+  // Sets up the ASCII fast path for |string_|, see the comment at the top.
+  void InitAsciiPath();
+
+  // Whether all the breaks of |string_| are found without ICU.
+  bool IsAsciiPathForWholeString() const {
+    return use_ascii_path_ && ascii_end_ == string_.size();
+  }
+
   // ICU iterator, avoiding ICU ubrk.h dependence.
   // This is actually an ICU UBreakiterator* type, which turns out to be
   // a typedef for a void* in the ICU headers. Using void* directly prevents
@@ -190,6 +207,17 @@ class BASE_I18N_EXPORT BreakIterator {
 
   // Previous and current iterator positions.
   size_t prev_, pos_;
+
+  // Whether Advance() finds the next break without ICU. It is cleared once
+  // Advance() reaches a break that depends on |string_| from |ascii_end_| on.
+  bool use_ascii_path_ = false;
+
+  // The end of the prefix of |string_| that the fast path handles. If it is
+  // the whole string, |iter_| isn't even leased.
+  size_t ascii_end_ = 0;
+
+  // Whether [prev_, pos_) is a word, if the fast path found |pos_|.
+  bool ascii_is_word_ = false;
 };
 
 }  // namespace i18n
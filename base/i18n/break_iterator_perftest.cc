@@ -0,0 +1,88 @@
+// Copyright 2022 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include <stddef.h>
+
+#include <string>
+
+#include "base/i18n/break_iterator.h"
+#include "base/time/time.h"
+#include "testing/gtest/include/gtest/gtest.h"
+#include "testing/perf/perf_result_reporter.h"
+
+namespace base {
+namespace i18n {
+
+namespace {
+
+constexpr int kCount = 2000;
+
+constexpr char kMetricPrefixBreakIterator[] = "BreakIterator.";
+constexpr char kMetricTimePerCharacter[] = "time_per_character";
+
+perf_test::PerfResultReporter SetUpReporter(const std::string& story_name) {
+  perf_test::PerfResultReporter reporter(kMetricPrefixBreakIterator,
+                                         story_name);
+  reporter.RegisterImportantMetric(kMetricTimePerCharacter, "ns");
+  return reporter;
+}
+
+constexpr char16_t kText[] =
+    u"The quick brown fox jumps over the lazy dog, doesn't it? It took "
+    u"3.14 seconds at 12:30; the dog_owner (who wasn't there) said "
+    u"\"hello\" twice!\n";
+
+// Breaks |text| kCount times.
+void RunTest(const std::string& story_name,
+             const std::u16string& text,
+             BreakIterator::BreakType break_type) {
+  size_t word_count = 0;
+  const TimeTicks start = TimeTicks::Now();
+  for (int i = 0; i < kCount; ++i) {
+    BreakIterator iter(text, break_type);
+    ASSERT_TRUE(iter.Init());
+    while (iter.Advance())
+      word_count += iter.IsWord();
+  }
+  const TimeDelta elapsed = TimeTicks::Now() - start;
+  SetUpReporter(story_name)
+      .AddResult(kMetricTimePerCharacter,
+                 static_cast<double>(elapsed.InNanoseconds()) /
+                     (kCount * text.size()));
+  if (break_type == BreakIterator::BREAK_WORD)
+    EXPECT_GT(word_count, 0u);
+}
+
+std::u16string MakeText(const std::u16string& prefix) {
+  std::u16string text = prefix;
+  for (int i = 0; i < 16; ++i)
+    text += kText;
+  return text;
+}
+
+}  // namespace
+
+// ASCII text is broken without ICU. A leading non-ASCII character makes ICU
+// break the same text.
+TEST(BreakIteratorPerfTest, BreakWord) {
+  RunTest("word_ascii", MakeText(u""), BreakIterator::BREAK_WORD);
+  RunTest("word_icu", MakeText(u"\xE9 "), BreakIterator::BREAK_WORD);
+}
+
+TEST(BreakIteratorPerfTest, BreakLine) {
+  RunTest("line_ascii", MakeText(u""), BreakIterator::BREAK_LINE);
+  RunTest("line_icu", MakeText(u"\xE9 "), BreakIterator::BREAK_LINE);
+}
+
+// Under BREAK_LINE, ICU breaks the text from the first quote or bracket on.
+TEST(BreakIteratorPerfTest, BreakLinePlainASCII) {
+  std::u16string text;
+  for (int i = 0; i < 16; ++i)
+    text += u"The quick brown fox jumps over the lazy dog, 42 times. ";
+  RunTest("line_plain_ascii", text, BreakIterator::BREAK_LINE);
+  RunTest("line_plain_icu", u"\xE9 " + text, BreakIterator::BREAK_LINE);
+}
+
+}  // namespace i18n
+}  // namespace base
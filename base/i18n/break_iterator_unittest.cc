@@ -5,6 +5,9 @@
 #include "base/i18n/break_iterator.h"
 
 #include <stddef.h>
+
+#include <random>
+#include <utility>
 #include <vector>
 
 #include "base/cxx17_backports.h"
@@ -15,10 +18,44 @@
 #include "base/strings/utf_string_conversions.h"
 #include "build/build_config.h"
 #include "testing/gtest/include/gtest/gtest.h"
+#include "third_party/icu/source/common/unicode/ubrk.h"
 
 namespace base {
 namespace i18n {
 
+namespace {
+
+// Returns the breaks of |text|, and whether the segments they end are words,
+// as found by a BreakIterator.
+std::vector<std::pair<size_t, bool>> GetBreaks(const std::u16string& text,
+                                               BreakIterator::BreakType type) {
+  BreakIterator iter(text, type);
+  EXPECT_TRUE(iter.Init());
+  std::vector<std::pair<size_t, bool>> breaks;
+  while (iter.Advance())
+    breaks.emplace_back(iter.pos(), iter.IsWord());
+  EXPECT_FALSE(iter.IsWord());
+  return breaks;
+}
+
+// Returns the same as GetBreaks(), as found by an ICU iterator.
+std::vector<std::pair<size_t, bool>> GetIcuBreaks(const std::u16string& text,
+                                                  UBreakIteratorType type) {
+  UErrorCode status = U_ZERO_ERROR;
+  UBreakIterator* iter = ubrk_open(type, nullptr, text.data(),
+                                   static_cast<int32_t>(text.size()), &status);
+  EXPECT_TRUE(U_SUCCESS(status));
+  std::vector<std::pair<size_t, bool>> breaks;
+  for (int32_t pos = ubrk_next(iter); pos != UBRK_DONE; pos = ubrk_next(iter)) {
+    breaks.emplace_back(pos, type == UBRK_WORD &&
+                                 ubrk_getRuleStatus(iter) != UBRK_WORD_NONE);
+  }
+  ubrk_close(iter);
+  return breaks;
+}
+
+}  // namespace
+
 TEST(BreakIteratorTest, BreakWordEmpty) {
   std::u16string empty;
   BreakIterator iter(empty, BreakIterator::BREAK_WORD);
@@ -630,5 +667,81 @@ TEST(BreakIteratorTest, GetWordBreakStatusBreakWord) {
   EXPECT_FALSE(iter.Advance());
 }
 
+// The breaks of ASCII text are found without ICU under BREAK_WORD and
+// BREAK_LINE, and ICU finds the breaks from the first non-ASCII character on.
+// Compares both with the breaks ICU finds on its own.
+TEST(BreakIteratorTest, ASCIIPathMatchesICU) {
+  const std::u16string kCharacters =
+      u"aZ09@ \t\r\n\v.,:;'\"_!?-#()[]{}/$%&*+<=>^`|~\x01\x7F";
+  // Letters, a combining mark, a right single quote, a full-width colon, a
+  // no-break space, an ideograph, a Hebrew letter, and a surrogate pair.
+  const std::u16string kNonASCII =
+      u"\xE9\x301\x2019\xFF1A\xA0\x4E00\x5D0\xD83D\xDE00";
+  std::minstd_rand generator(42);
+  for (int i = 0; i < 20000; ++i) {
+    std::u16string text;
+    for (size_t j = generator() % 32; j > 0; --j) {
+      if (i % 2 && generator() % 16 == 0)
+        text.push_back(kNonASCII[generator() % kNonASCII.size()]);
+      else
+        text.push_back(kCharacters[generator() % kCharacters.size()]);
+    }
+    EXPECT_EQ(GetIcuBreaks(text, UBRK_WORD),
+              GetBreaks(text, BreakIterator::BREAK_WORD))
+        << UTF16ToUTF8(text);
+    EXPECT_EQ(GetIcuBreaks(text, UBRK_LINE),
+              GetBreaks(text, BreakIterator::BREAK_LINE))
+        << UTF16ToUTF8(text);
+  }
+}
+
+TEST(BreakIteratorTest, ASCIIPathWordBoundaries) {
+  const std::u16string text(u"can't stop_ at 3.14, x__y __ _");
+  BreakIterator iter(text, BreakIterator::BREAK_WORD);
+  ASSERT_TRUE(iter.Init());
+  std::vector<std::u16string> words;
+  while (iter.Advance()) {
+    if (iter.IsWord())
+      words.push_back(iter.GetString());
+  }
+  EXPECT_EQ(std::vector<std::u16string>(
+                {u"can't", u"stop_", u"at", u"3.14", u"x__y", u"__"}),
+            words);
+
+  EXPECT_TRUE(iter.IsStartOfWord(0));
+  EXPECT_FALSE(iter.IsStartOfWord(1));
+  EXPECT_TRUE(iter.IsEndOfWord(5));
+  EXPECT_FALSE(iter.IsEndOfWord(6));
+  EXPECT_TRUE(iter.IsStartOfWord(15));
+  EXPECT_TRUE(iter.IsEndOfWord(19));
+  EXPECT_FALSE(iter.IsStartOfWord(19));
+  EXPECT_FALSE(iter.IsStartOfWord(29));
+  EXPECT_FALSE(iter.IsEndOfWord(30));
+  EXPECT_FALSE(iter.IsEndOfWord(31));
+}
+
+// The fast path is set up again for each text.
+TEST(BreakIteratorTest, ASCIIPathSetText) {
+  const std::u16string ascii(u"one two");
+  const std::u16string non_ascii(u"caf\xE9 au lait");
+  BreakIterator iter(ascii, BreakIterator::BREAK_WORD);
+  ASSERT_TRUE(iter.Init());
+  for (const std::u16string* text : {&non_ascii, &ascii, &non_ascii}) {
+    ASSERT_TRUE(iter.SetText(text->data(), text->size()));
+    std::vector<std::u16string> words;
+    while (iter.Advance()) {
+      if (iter.IsWord())
+        words.push_back(iter.GetString());
+    }
+    EXPECT_EQ(text == &ascii ? std::vector<std::u16string>({u"one", u"two"})
+                             : std::vector<std::u16string>(
+                                   {u"caf\xE9", u"au", u"lait"}),
+              words);
+    EXPECT_TRUE(iter.IsStartOfWord(0));
+    EXPECT_TRUE(iter.IsEndOfWord(text->find(u' ')));
+    EXPECT_FALSE(iter.IsStartOfWord(text->find(u' ')));
+  }
+}
+
 }  // namespace i18n
 }  // namespace base
@@ -11,6 +11,7 @@
 #include "base/numerics/safe_conversions.h"
 #include "base/strings/string_util.h"
 #include "third_party/icu/source/common/unicode/uchar.h"
+#include "third_party/icu/source/common/unicode/uloc.h"
 #include "third_party/icu/source/common/unicode/unistr.h"
 #include "third_party/icu/source/common/unicode/ustring.h"
 
@@ -46,13 +47,11 @@ int32_t FoldCaseMapper(UChar* dest, int32_t dest_capacity,
                        U_FOLD_CASE_DEFAULT, error);
 }
 
-// Provides similar functionality as UnicodeString::caseMap but on
-// std::u16string.
-std::u16string CaseMap(StringPiece16 string, CaseMapperFunction case_mapper) {
-  std::u16string dest;
-  if (string.empty())
-    return dest;
-
+// Maps |string| into |dest|, which is resized to fit the result. Provides
+// similar functionality as UnicodeString::caseMap but on std::u16string.
+void CaseMapInto(StringPiece16 string,
+                 CaseMapperFunction case_mapper,
+                 std::u16string& dest) {
   // Provide an initial guess that the string length won't change. The typical
   // strings we use will very rarely change length in this process, so don't
   // optimize for that case.
@@ -70,22 +69,69 @@ std::u16string CaseMap(StringPiece16 string, CaseMapperFunction case_mapper) {
         saturated_cast<int32_t>(string.size()), &error);
     dest.resize(new_length);
   } while (error == U_BUFFER_OVERFLOW_ERROR);
+}
+
+std::u16string CaseMap(StringPiece16 string, CaseMapperFunction case_mapper) {
+  std::u16string dest;
+  if (string.empty())
+    return dest;
+  CaseMapInto(string, case_mapper, dest);
   return dest;
 }
 
+// Returns true if the case mappings of the current locale differ from the
+// root locale's for ASCII letters. Only the Turkic languages do: they map I
+// to dotless i (U+0131), and i to I with dot above (U+0130).
+bool DefaultLocaleHasTurkicCaseMapping() {
+  const StringPiece locale(uloc_getDefault());
+  const StringPiece language = locale.substr(0, locale.find_first_of("_-@"));
+  return language == "tr" || language == "az" || language == "tur" ||
+         language == "aze";
+}
+
 }  // namespace
 
 std::u16string ToLower(StringPiece16 string) {
+  if (IsStringASCII(string) &&
+      (string.find(u'I') == StringPiece16::npos ||
+       !DefaultLocaleHasTurkicCaseMapping())) {
+    return ToLowerASCII(string);
+  }
   return CaseMap(string, &ToLowerMapper);
 }
 
 std::u16string ToUpper(StringPiece16 string) {
+  if (IsStringASCII(string) &&
+      (string.find(u'i') == StringPiece16::npos ||
+       !DefaultLocaleHasTurkicCaseMapping())) {
+    return ToUpperASCII(string);
+  }
   return CaseMap(string, &ToUpperMapper);
 }
 
 std::u16string FoldCase(StringPiece16 string) {
+  // Default case folding doesn't depend on the locale, and folds ASCII to
+  // lower case.
+  if (IsStringASCII(string))
+    return ToLowerASCII(string);
   return CaseMap(string, &FoldCaseMapper);
 }
 
+std::vector<std::u16string> FoldCaseBatch(span<const std::u16string> strings) {
+  std::vector<std::u16string> folded(strings.size());
+  std::u16string buffer;
+  for (size_t i = 0; i < strings.size(); ++i) {
+    const std::u16string& string = strings[i];
+    if (IsStringASCII(string)) {
+      folded[i] = ToLowerASCII(string);
+      continue;
+    }
+    // |buffer| keeps the capacity of the largest string folded so far.
+    CaseMapInto(string, &FoldCaseMapper, buffer);
+    folded[i].assign(buffer);
+  }
+  return folded;
+}
+
 }  // namespace i18n
 }  // namespace base
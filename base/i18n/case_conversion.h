@@ -6,7 +6,9 @@
 #define BASE_I18N_CASE_CONVERSION_H_
 
 #include <string>
+#include <vector>
 
+#include "base/containers/span.h"
 #include "base/i18n/base_i18n_export.h"
 #include "base/strings/string_piece.h"
 
@@ -31,6 +33,10 @@ namespace i18n {
 // Note that case conversions will change the length of the string in some
 // not-uncommon cases. Never assume that the output is the same length as
 // the input.
+//
+// ASCII strings are converted without calling into ICU, unless the current
+// locale maps ASCII letters outside of ASCII (the Turkish I) and the string
+// has one of them.
 
 // Returns the lower case equivalent of string. Uses ICU's current locale.
 BASE_I18N_EXPORT std::u16string ToLower(StringPiece16 string);
@@ -43,6 +49,12 @@ BASE_I18N_EXPORT std::u16string ToUpper(StringPiece16 string);
 // See http://unicode.org/faq/casemap_charprop.html#2
 BASE_I18N_EXPORT std::u16string FoldCase(StringPiece16 string);
 
+// Returns FoldCase() of each of |strings|. Use this to fold many strings at
+// once, e.g. to index them: the strings that aren't ASCII share one ICU
+// output buffer, rather than each growing its own.
+BASE_I18N_EXPORT std::vector<std::u16string> FoldCaseBatch(
+    span<const std::u16string> strings);
+
 }  // namespace i18n
 }  // namespace base
 
@@ -0,0 +1,88 @@
+// Copyright 2022 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include <stddef.h>
+
+#include <string>
+#include <vector>
+
+#include "base/i18n/case_conversion.h"
+#include "base/i18n/string_search.h"
+#include "base/time/time.h"
+#include "testing/gtest/include/gtest/gtest.h"
+#include "testing/perf/perf_result_reporter.h"
+
+namespace base {
+namespace i18n {
+
+namespace {
+
+constexpr size_t kCount = 100000;
+
+constexpr char kMetricPrefixCaseConversion[] = "CaseConversion.";
+constexpr char kMetricTimePerString[] = "time_per_string";
+
+perf_test::PerfResultReporter SetUpReporter(const std::string& story_name) {
+  perf_test::PerfResultReporter reporter(kMetricPrefixCaseConversion,
+                                         story_name);
+  reporter.RegisterImportantMetric(kMetricTimePerString, "ns");
+  return reporter;
+}
+
+// Runs |function| kCount times. It processes |strings_per_call| strings per
+// call, and returns a length which depends on its result.
+template <typename Function>
+void RunTest(const std::string& story_name,
+             Function function,
+             size_t strings_per_call = 1) {
+  size_t total_length = 0;
+  const TimeTicks start = TimeTicks::Now();
+  for (size_t i = 0; i < kCount; ++i)
+    total_length += function();
+  const TimeDelta elapsed = TimeTicks::Now() - start;
+  SetUpReporter(story_name)
+      .AddResult(kMetricTimePerString,
+                 static_cast<double>(elapsed.InNanoseconds()) /
+                     (kCount * strings_per_call));
+  EXPECT_GT(total_length, 0U);
+}
+
+constexpr char16_t kASCII[] = u"Search Indexing Spends Its Time Folding Case";
+constexpr char16_t kNonASCII[] = u"Recherche d\u00e9j\u00e0 index\u00e9e";
+
+}  // namespace
+
+TEST(CaseConversionPerfTest, FoldCaseASCII) {
+  RunTest("fold_case_ascii", [] { return FoldCase(kASCII).size(); });
+}
+
+TEST(CaseConversionPerfTest, FoldCaseNonASCII) {
+  RunTest("fold_case_non_ascii", [] { return FoldCase(kNonASCII).size(); });
+}
+
+TEST(CaseConversionPerfTest, FoldCaseBatch) {
+  const std::vector<std::u16string> strings(10, kNonASCII);
+  RunTest(
+      "fold_case_batch_non_ascii",
+      [&strings] { return FoldCaseBatch(strings).back().size(); },
+      strings.size());
+}
+
+TEST(CaseConversionPerfTest, ToLowerASCII) {
+  RunTest("to_lower_ascii", [] { return ToLower(kASCII).size(); });
+}
+
+TEST(CaseConversionPerfTest, FixedPatternStringSearchIgnoringCaseAndAccents) {
+  const std::u16string text(kNonASCII);
+  RunTest("fixed_pattern_string_search", [&text] {
+    size_t index = 0;
+    return FixedPatternStringSearchIgnoringCaseAndAccents(u"index")
+                   .Search(text, &index, nullptr)
+               ? index
+               : 0;
+  });
+}
+
+}  // namespace i18n
+}  // namespace base
@@ -80,6 +80,26 @@ TEST(CaseConversionTest, TurkishLocaleConversion) {
   EXPECT_EQ(expected_upper_turkish, result);
 }
 
+// ASCII strings skip ICU, except for the letters which the Turkic languages
+// map outside of ASCII.
+TEST(CaseConversionTest, TurkicLocaleASCII) {
+  test::ScopedRestoreICUDefaultLocale restore_locale;
+  for (const char* locale : {"tr", "tr_TR", "az", "az_Latn_AZ"}) {
+    i18n::SetICUDefaultLocale(locale);
+    EXPECT_EQ(u"t\x131tle", ToLower(u"TITLE")) << locale;
+    EXPECT_EQ(u"T\x130TLE", ToUpper(u"title")) << locale;
+    EXPECT_EQ(u"abc", ToLower(u"ABC")) << locale;
+    EXPECT_EQ(u"ABC", ToUpper(u"abc")) << locale;
+    EXPECT_EQ(u"title", FoldCase(u"TITLE")) << locale;
+  }
+
+  for (const char* locale : {"en_US", "fr", "lt", "tt"}) {
+    i18n::SetICUDefaultLocale(locale);
+    EXPECT_EQ(u"title", ToLower(u"TITLE")) << locale;
+    EXPECT_EQ(u"TITLE", ToUpper(u"title")) << locale;
+  }
+}
+
 TEST(CaseConversionTest, FoldCase) {
   // Simple ASCII, should lower-case.
   EXPECT_EQ(u"hello, world", FoldCase(u"Hello, World"));
@@ -109,6 +129,18 @@ TEST(CaseConversionTest, FoldCase) {
   EXPECT_EQ(u"ssss", FoldCase(u"\u00DF\u1E9E"));
 }
 
+TEST(CaseConversionTest, FoldCaseBatch) {
+  EXPECT_TRUE(FoldCaseBatch({}).empty());
+
+  const std::vector<std::u16string> strings = {
+      u"Hello, World", kNonASCIIMixed,   u"",
+      u"\u0130j",      u"\u00DF\u1E9E", std::u16string(100, u'\u00C4')};
+  const std::vector<std::u16string> folded = FoldCaseBatch(strings);
+  ASSERT_EQ(strings.size(), folded.size());
+  for (size_t i = 0; i < strings.size(); ++i)
+    EXPECT_EQ(FoldCase(strings[i]), folded[i]) << i;
+}
+
 }  // namespace i18n
 }  // namespace base
 
@@ -0,0 +1,135 @@
+// Copyright 2022 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "base/i18n/icu_data_page_list.h"
+
+#include <algorithm>
+#include <utility>
+
+#include "base/check_op.h"
+#include "base/memory/page_size.h"
+#include "base/strings/string_number_conversions.h"
+#include "base/strings/string_split.h"
+#include "base/strings/stringprintf.h"
+
+namespace base {
+namespace i18n {
+
+namespace {
+
+constexpr char kHeaderPrefix[] = "icu-data-pages";
+
+}  // namespace
+
+IcuDataPageList::IcuDataPageList() = default;
+IcuDataPageList::IcuDataPageList(const IcuDataPageList& other) = default;
+IcuDataPageList::IcuDataPageList(IcuDataPageList&& other) = default;
+IcuDataPageList& IcuDataPageList::operator=(const IcuDataPageList& other) =
+    default;
+IcuDataPageList& IcuDataPageList::operator=(IcuDataPageList&& other) = default;
+IcuDataPageList::~IcuDataPageList() = default;
+
+std::string IcuDataPageList::Serialize() const {
+  std::string serialized =
+      StringPrintf("%s %zu %zu\n", kHeaderPrefix, page_size, data_size);
+  for (uint32_t page : pages) {
+    serialized += NumberToString(page);
+    serialized += '\n';
+  }
+  return serialized;
+}
+
+// static
+absl::optional<IcuDataPageList> IcuDataPageList::Deserialize(
+    StringPiece serialized) {
+  std::vector<StringPiece> lines = SplitStringPiece(
+      serialized, "\n", TRIM_WHITESPACE, SPLIT_WANT_NONEMPTY);
+  if (lines.empty())
+    return absl::nullopt;
+
+  std::vector<StringPiece> header =
+      SplitStringPiece(lines[0], " ", TRIM_WHITESPACE, SPLIT_WANT_NONEMPTY);
+  IcuDataPageList page_list;
+  if (header.size() != 3 || header[0] != kHeaderPrefix ||
+      !StringToSizeT(header[1], &page_list.page_size) ||
+      !StringToSizeT(header[2], &page_list.data_size) ||
+      !page_list.page_size) {
+    return absl::nullopt;
+  }
+
+  const size_t page_count =
+      (page_list.data_size + page_list.page_size - 1) / page_list.page_size;
+  page_list.pages.reserve(lines.size() - 1);
+  for (size_t i = 1; i < lines.size(); ++i) {
+    unsigned page;
+    // The data may not start at a page boundary, so it can span one more page
+    // than its size needs.
+    if (!StringToUint(lines[i], &page) || page > page_count)
+      return absl::nullopt;
+    page_list.pages.push_back(page);
+  }
+  return page_list;
+}
+
+#if BUILDFLAG(IS_POSIX) && !BUILDFLAG(IS_NACL)
+IcuDataPageRecorder::IcuDataPageRecorder(const MemoryMappedFile* mapped_file)
+    : mapped_file_(mapped_file) {
+  DCHECK(mapped_file_->IsValid());
+  page_list_.page_size = GetPageSize();
+  page_list_.data_size = mapped_file_->length();
+}
+
+IcuDataPageRecorder::~IcuDataPageRecorder() = default;
+
+void IcuDataPageRecorder::Update() {
+  absl::optional<std::vector<bool>> resident_pages =
+      mapped_file_->GetResidentPages();
+  if (!resident_pages)
+    return;
+  recorded_pages_.resize(resident_pages->size());
+  for (size_t i = 0; i < resident_pages->size(); ++i) {
+    if (!(*resident_pages)[i] || recorded_pages_[i])
+      continue;
+    recorded_pages_[i] = true;
+    page_list_.pages.push_back(static_cast<uint32_t>(i));
+  }
+}
+
+bool PrefetchIcuDataPages(MemoryMappedFile* mapped_file,
+                          const IcuDataPageList& page_list) {
+  DCHECK(mapped_file->IsValid());
+  const size_t page_size = GetPageSize();
+  const size_t length = mapped_file->length();
+  if (page_list.page_size != page_size || page_list.data_size != length)
+    return false;
+
+  // Page 0 holds the start of the data, |head| bytes into the page.
+  const size_t head =
+      reinterpret_cast<uintptr_t>(mapped_file->data()) & (page_size - 1);
+  auto page_begin = [&](size_t page) {
+    return std::min(length, std::max(page * page_size, head) - head);
+  };
+
+  // Advises each run of consecutive pages with one call.
+  size_t i = 0;
+  while (i < page_list.pages.size()) {
+    size_t run_end = i + 1;
+    while (run_end < page_list.pages.size() &&
+           page_list.pages[run_end] == page_list.pages[run_end - 1] + 1) {
+      ++run_end;
+    }
+    const size_t begin = page_begin(page_list.pages[i]);
+    const size_t end = page_begin(page_list.pages[run_end - 1] + size_t{1});
+    if (begin < end) {
+      mapped_file->Advise(MemoryMappedFile::Advice::kWillNeed, begin,
+                          end - begin);
+    }
+    i = run_end;
+  }
+  return true;
+}
+#endif  // BUILDFLAG(IS_POSIX) && !BUILDFLAG(IS_NACL)
+
+}  // namespace i18n
+}  // namespace base
@@ -0,0 +1,89 @@
+// Copyright 2022 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#ifndef BASE_I18N_ICU_DATA_PAGE_LIST_H_
+#define BASE_I18N_ICU_DATA_PAGE_LIST_H_
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include <string>
+#include <vector>
+
+#include "base/files/memory_mapped_file.h"
+#include "base/i18n/base_i18n_export.h"
+#include "base/memory/raw_ptr.h"
+#include "base/strings/string_piece.h"
+#include "build/build_config.h"
+#include "third_party/abseil-cpp/absl/types/optional.h"
+
+namespace base {
+namespace i18n {
+
+// The pages of a mapped ICU data file that a run read, in the order it first
+// read them. Pages are counted from the page that holds the start of the
+// data, as in MemoryMappedFile::GetResidentPages().
+struct BASE_I18N_EXPORT IcuDataPageList {
+  IcuDataPageList();
+  IcuDataPageList(const IcuDataPageList& other);
+  IcuDataPageList(IcuDataPageList&& other);
+  IcuDataPageList& operator=(const IcuDataPageList& other);
+  IcuDataPageList& operator=(IcuDataPageList&& other);
+  ~IcuDataPageList();
+
+  // Returns the list as text: a header line with the page size and the data
+  // size, then one page index per line.
+  std::string Serialize() const;
+
+  // Parses the output of Serialize(). Returns nullopt if |serialized| is
+  // malformed.
+  static absl::optional<IcuDataPageList> Deserialize(StringPiece serialized);
+
+  // The page size and the size of the data when the list was recorded. A list
+  // doesn't apply to other data, e.g. after an ICU update.
+  size_t page_size = 0;
+  size_t data_size = 0;
+  std::vector<uint32_t> pages;
+};
+
+#if BUILDFLAG(IS_POSIX) && !BUILDFLAG(IS_NACL)
+// Records the order in which the pages of a mapped ICU data file become
+// resident. Since residency is only sampled when Update() is called, pages read
+// between two calls are listed in index order. The data file must have been
+// evicted from the page cache, and mapped with
+// MemoryMappedFile::Advice::kRandom so that no more than the pages read are
+// read ahead; otherwise, the list also has the pages read by other processes or
+// read ahead.
+class BASE_I18N_EXPORT IcuDataPageRecorder {
+ public:
+  // |mapped_file| must outlive this.
+  explicit IcuDataPageRecorder(const MemoryMappedFile* mapped_file);
+  IcuDataPageRecorder(const IcuDataPageRecorder&) = delete;
+  IcuDataPageRecorder& operator=(const IcuDataPageRecorder&) = delete;
+  ~IcuDataPageRecorder();
+
+  // Appends the pages that became resident since the last call to the list.
+  void Update();
+
+  const IcuDataPageList& page_list() const { return page_list_; }
+
+ private:
+  const raw_ptr<const MemoryMappedFile> mapped_file_;
+  std::vector<bool> recorded_pages_;
+  IcuDataPageList page_list_;
+};
+
+// Advises the kernel that the pages in |page_list| of |mapped_file| are needed
+// soon (MADV_WILLNEED), in their recorded order, one call per run of
+// consecutive pages. The pages are read in the background, and this doesn't
+// wait for them. Returns false if |page_list| wasn't recorded with the current
+// page size or for data of the size of |mapped_file|.
+BASE_I18N_EXPORT bool PrefetchIcuDataPages(MemoryMappedFile* mapped_file,
+                                           const IcuDataPageList& page_list);
+#endif  // BUILDFLAG(IS_POSIX) && !BUILDFLAG(IS_NACL)
+
+}  // namespace i18n
+}  // namespace base
+
+#endif  // BASE_I18N_ICU_DATA_PAGE_LIST_H_
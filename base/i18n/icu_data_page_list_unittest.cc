@@ -0,0 +1,140 @@
+// Copyright 2022 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "base/i18n/icu_data_page_list.h"
+
+#include <algorithm>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "base/files/file.h"
+#include "base/files/file_path.h"
+#include "base/files/file_util.h"
+#include "base/files/scoped_temp_dir.h"
+#include "base/memory/page_size.h"
+#include "build/build_config.h"
+#include "testing/gtest/include/gtest/gtest.h"
+
+namespace base {
+namespace i18n {
+
+TEST(IcuDataPageListTest, SerializeAndDeserialize) {
+  IcuDataPageList page_list;
+  page_list.page_size = 4096;
+  page_list.data_size = 10 * 4096 + 1;
+  page_list.pages = {0, 7, 8, 9, 3, 11};
+
+  const std::string serialized = page_list.Serialize();
+  EXPECT_EQ("icu-data-pages 4096 40961\n0\n7\n8\n9\n3\n11\n", serialized);
+  absl::optional<IcuDataPageList> deserialized =
+      IcuDataPageList::Deserialize(serialized);
+  ASSERT_TRUE(deserialized);
+  EXPECT_EQ(page_list.page_size, deserialized->page_size);
+  EXPECT_EQ(page_list.data_size, deserialized->data_size);
+  EXPECT_EQ(page_list.pages, deserialized->pages);
+}
+
+TEST(IcuDataPageListTest, DeserializeEmptyList) {
+  absl::optional<IcuDataPageList> page_list =
+      IcuDataPageList::Deserialize("icu-data-pages 16384 100\n");
+  ASSERT_TRUE(page_list);
+  EXPECT_EQ(16384u, page_list->page_size);
+  EXPECT_EQ(100u, page_list->data_size);
+  EXPECT_TRUE(page_list->pages.empty());
+}
+
+TEST(IcuDataPageListTest, DeserializeMalformed) {
+  for (const char* serialized : {
+           "",
+           "0\n1\n",
+           "icu-data-pages 4096\n0\n",
+           "icu-data-pages 0 4096\n0\n",
+           "pages 4096 4096\n0\n",
+           "icu-data-pages 4096 4096\n-1\n",
+           "icu-data-pages 4096 4096\nzero\n",
+           // 4096 bytes span at most 2 pages.
+           "icu-data-pages 4096 4096\n2\n",
+       }) {
+    EXPECT_FALSE(IcuDataPageList::Deserialize(serialized)) << serialized;
+  }
+}
+
+#if BUILDFLAG(IS_POSIX) && !BUILDFLAG(IS_NACL)
+class IcuDataPageRecorderTest : public testing::Test {
+ protected:
+  void SetUp() override {
+    ASSERT_TRUE(temp_dir_.CreateUniqueTempDir());
+    path_ = temp_dir_.GetPath().AppendASCII("icudtl.dat");
+    ASSERT_TRUE(
+        WriteFile(path_, std::string(kPageCount * GetPageSize(), 'x')));
+    ASSERT_TRUE(mapped_file_.Initialize(path_));
+  }
+
+  static constexpr size_t kPageCount = 16;
+
+  ScopedTempDir temp_dir_;
+  FilePath path_;
+  MemoryMappedFile mapped_file_;
+};
+
+// Pages are listed once, when they are first found resident.
+TEST_F(IcuDataPageRecorderTest, RecordsEachPageOnce) {
+  IcuDataPageRecorder recorder(&mapped_file_);
+  EXPECT_EQ(GetPageSize(), recorder.page_list().page_size);
+  EXPECT_EQ(mapped_file_.length(), recorder.page_list().data_size);
+
+  volatile uint8_t sum = 0;
+  for (size_t i = 0; i < mapped_file_.length(); i += GetPageSize())
+    sum += mapped_file_.data()[i];
+  recorder.Update();
+  recorder.Update();
+
+  std::vector<uint32_t> pages = recorder.page_list().pages;
+  ASSERT_EQ(kPageCount, pages.size());
+  std::sort(pages.begin(), pages.end());
+  for (size_t i = 0; i < kPageCount; ++i)
+    EXPECT_EQ(i, pages[i]);
+}
+
+TEST_F(IcuDataPageRecorderTest, Prefetch) {
+  IcuDataPageList page_list;
+  page_list.page_size = GetPageSize();
+  page_list.data_size = mapped_file_.length();
+  page_list.pages = {3, 4, 5, 0, 15, 8};
+  EXPECT_TRUE(PrefetchIcuDataPages(&mapped_file_, page_list));
+
+  // Lists recorded for other data are ignored.
+  page_list.data_size += 1;
+  EXPECT_FALSE(PrefetchIcuDataPages(&mapped_file_, page_list));
+  page_list.data_size = mapped_file_.length();
+  page_list.page_size *= 2;
+  EXPECT_FALSE(PrefetchIcuDataPages(&mapped_file_, page_list));
+}
+
+TEST_F(IcuDataPageRecorderTest, PrefetchUnalignedData) {
+  const size_t kOffset = GetPageSize() + 100;
+  MemoryMappedFile mapped_file;
+  ASSERT_TRUE(mapped_file.Initialize(
+      File(path_, File::FLAG_OPEN | File::FLAG_READ),
+      {static_cast<int64_t>(kOffset), mapped_file_.length() - kOffset}));
+
+  // The data spans the last 15 pages of the file, so page 14 is the last.
+  IcuDataPageList page_list;
+  page_list.page_size = GetPageSize();
+  page_list.data_size = mapped_file.length();
+  page_list.pages = {0, 1, 14};
+  EXPECT_TRUE(PrefetchIcuDataPages(&mapped_file, page_list));
+
+  IcuDataPageRecorder recorder(&mapped_file);
+  volatile uint8_t sum = 0;
+  for (size_t i = 0; i < mapped_file.length(); ++i)
+    sum += mapped_file.data()[i];
+  recorder.Update();
+  EXPECT_EQ(15u, recorder.page_list().pages.size());
+}
+#endif  // BUILDFLAG(IS_POSIX) && !BUILDFLAG(IS_NACL)
+
+}  // namespace i18n
+}  // namespace base
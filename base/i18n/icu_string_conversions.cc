@@ -7,12 +7,19 @@
 #include <stddef.h>
 #include <stdint.h>
 
+#include <algorithm>
 #include <memory>
+#include <string>
+#include <utility>
+#include <vector>
 
 #include "base/check.h"
+#include "base/memory/ptr_util.h"
+#include "base/no_destructor.h"
 #include "base/notreached.h"
 #include "base/strings/string_util.h"
 #include "base/strings/utf_string_conversions.h"
+#include "base/threading/thread_local.h"
 #include "third_party/icu/source/common/unicode/normalizer2.h"
 #include "third_party/icu/source/common/unicode/ucnv.h"
 #include "third_party/icu/source/common/unicode/ucnv_cb.h"
@@ -80,37 +87,41 @@ void ToUnicodeCallbackSubstitute(const void* context,
   // else ignore the reset, close and clone calls.
 }
 
-bool ConvertFromUTF16(UConverter* converter,
-                      base::StringPiece16 src,
-                      OnStringConversionError::Type on_error,
-                      std::string* encoded) {
-  int encoded_max_length = UCNV_GET_MAX_BYTES_FOR_STRING(
-      src.length(), ucnv_getMaxCharSize(converter));
-  encoded->resize(encoded_max_length);
-
-  UErrorCode status = U_ZERO_ERROR;
-
-  // Setup our error handler.
+// Set up our error handler for FromUTF-16 converters
+void SetUpErrorHandlerForFromUChars(OnStringConversionError::Type on_error,
+                                    UConverter* converter,
+                                    UErrorCode* status) {
   switch (on_error) {
     case OnStringConversionError::FAIL:
       ucnv_setFromUCallBack(converter, UCNV_FROM_U_CALLBACK_STOP, nullptr,
-                            nullptr, nullptr, &status);
+                            nullptr, nullptr, status);
       break;
     case OnStringConversionError::SKIP:
     case OnStringConversionError::SUBSTITUTE:
       ucnv_setFromUCallBack(converter, UCNV_FROM_U_CALLBACK_SKIP, nullptr,
-                            nullptr, nullptr, &status);
+                            nullptr, nullptr, status);
       break;
     default:
       NOTREACHED();
   }
+}
+
+bool ConvertFromUTF16(UConverter* converter,
+                      base::StringPiece16 src,
+                      OnStringConversionError::Type on_error,
+                      std::string* encoded) {
+  int encoded_max_length = UCNV_GET_MAX_BYTES_FOR_STRING(
+      src.length(), ucnv_getMaxCharSize(converter));
+  encoded->resize(encoded_max_length);
+
+  UErrorCode status = U_ZERO_ERROR;
+  SetUpErrorHandlerForFromUChars(on_error, converter, &status);
 
   // ucnv_fromUChars returns size not including terminating null
   int actual_size =
       ucnv_fromUChars(converter, &(*encoded)[0], encoded_max_length, src.data(),
                       src.length(), &status);
   encoded->resize(actual_size);
-  ucnv_close(converter);
   if (U_SUCCESS(status))
     return true;
   encoded->clear();  // Make sure the output is empty on error.
@@ -138,6 +149,126 @@ void SetUpErrorHandlerForToUChars(OnStringConversionError::Type on_error,
   }
 }
 
+// The UConverters of a thread which aren't in use, keyed by the codepage name
+// they were opened with. Opening a converter looks its name up in the alias
+// table and loads its mapping data, which costs more than converting a short
+// string. Converters are reset when they are given back, but keep their
+// callbacks, so users must set those.
+class UConverterPool {
+ public:
+  UConverterPool() = default;
+  UConverterPool(const UConverterPool&) = delete;
+  UConverterPool& operator=(const UConverterPool&) = delete;
+
+  ~UConverterPool() {
+    for (const Entry& entry : entries_)
+      ucnv_close(entry.converter);
+  }
+
+  static UConverterPool& GetForCurrentThread() {
+    static NoDestructor<ThreadLocalOwnedPointer<UConverterPool>> pools;
+    UConverterPool* pool = pools->Get();
+    if (!pool) {
+      pool = new UConverterPool();
+      pools->Set(WrapUnique(pool));
+    }
+    return *pool;
+  }
+
+  // Returns a converter for |codepage_name|, or null if ICU doesn't know the
+  // codepage.
+  UConverter* Acquire(const char* codepage_name) {
+    auto it = std::find_if(entries_.rbegin(), entries_.rend(),
+                           [codepage_name](const Entry& entry) {
+                             return entry.codepage_name == codepage_name;
+                           });
+    if (it != entries_.rend()) {
+      UConverter* converter = it->converter;
+      entries_.erase(std::next(it).base());
+      return converter;
+    }
+
+    UErrorCode status = U_ZERO_ERROR;
+    UConverter* converter = ucnv_open(codepage_name, &status);
+    return U_SUCCESS(status) ? converter : nullptr;
+  }
+
+  // Takes back |converter|, which was acquired for |codepage_name| on any
+  // thread, and drops the least recently used one past kMaxEntries.
+  void Release(UConverter* converter, std::string codepage_name) {
+    ucnv_reset(converter);
+    if (entries_.size() == kMaxEntries) {
+      ucnv_close(entries_.front().converter);
+      entries_.erase(entries_.begin());
+    }
+    entries_.push_back({std::move(codepage_name), converter});
+  }
+
+ private:
+  static constexpr size_t kMaxEntries = 8;
+
+  struct Entry {
+    std::string codepage_name;
+    UConverter* converter;
+  };
+
+  std::vector<Entry> entries_;
+};
+
+// A converter from the pool of the current thread, given back to the pool of
+// the thread it is destroyed on.
+class ScopedUConverter {
+ public:
+  explicit ScopedUConverter(const char* codepage_name)
+      : codepage_name_(codepage_name),
+        converter_(
+            UConverterPool::GetForCurrentThread().Acquire(codepage_name)) {}
+  ScopedUConverter(const ScopedUConverter&) = delete;
+  ScopedUConverter& operator=(const ScopedUConverter&) = delete;
+
+  ~ScopedUConverter() {
+    if (converter_) {
+      UConverterPool::GetForCurrentThread().Release(converter_,
+                                                    std::move(codepage_name_));
+    }
+  }
+
+  // Null if ICU doesn't know the codepage.
+  UConverter* get() const { return converter_; }
+
+ private:
+  std::string codepage_name_;
+  const raw_ptr<UConverter> converter_;
+};
+
+// Returns the length of the UTF-8 sequence that starts with |lead|, or 0 if
+// |lead| can't start one.
+size_t UTF8SequenceLength(uint8_t lead) {
+  if (lead < 0x80)
+    return 1;
+  if (lead < 0xC2)
+    return 0;
+  if (lead < 0xE0)
+    return 2;
+  if (lead < 0xF0)
+    return 3;
+  if (lead < 0xF5)
+    return 4;
+  return 0;
+}
+
+// Returns the number of bytes at the end of |text| that start a UTF-8
+// sequence without ending it.
+size_t IncompleteUTF8SuffixLength(StringPiece text) {
+  const size_t max_length = std::min<size_t>(text.size(), 3);
+  for (size_t i = 1; i <= max_length; ++i) {
+    const uint8_t byte = static_cast<uint8_t>(text.data()[text.size() - i]);
+    if ((byte & 0xC0) != 0x80)
+      return UTF8SequenceLength(byte) > i ? i : 0;
+  }
+  return 0;
+}
+
 }  // namespace
 
 // Codepage <-> Wide/UTF-16  ---------------------------------------------------
@@ -148,12 +279,11 @@ bool UTF16ToCodepage(base::StringPiece16 utf16,
                      std::string* encoded) {
   encoded->clear();
 
-  UErrorCode status = U_ZERO_ERROR;
-  UConverter* converter = ucnv_open(codepage_name, &status);
-  if (!U_SUCCESS(status))
+  ScopedUConverter converter(codepage_name);
+  if (!converter.get())
     return false;
 
-  return ConvertFromUTF16(converter, utf16, on_error, encoded);
+  return ConvertFromUTF16(converter.get(), utf16, on_error, encoded);
 }
 
 bool CodepageToUTF16(base::StringPiece encoded,
@@ -162,9 +292,8 @@ bool CodepageToUTF16(base::StringPiece encoded,
                      std::u16string* utf16) {
   utf16->clear();
 
-  UErrorCode status = U_ZERO_ERROR;
-  UConverter* converter = ucnv_open(codepage_name, &status);
-  if (!U_SUCCESS(status))
+  ScopedUConverter converter(codepage_name);
+  if (!converter.get())
     return false;
 
   // Even in the worst case, the maximum length in 2-byte units of UTF-16
@@ -177,12 +306,12 @@ bool CodepageToUTF16(base::StringPiece encoded,
   // BOCU and SCSU, but we don't care about them.
   size_t uchar_max_length = encoded.length() + 1;
 
-  SetUpErrorHandlerForToUChars(on_error, converter, &status);
+  UErrorCode status = U_ZERO_ERROR;
+  SetUpErrorHandlerForToUChars(on_error, converter.get(), &status);
   std::unique_ptr<char16_t[]> buffer(new char16_t[uchar_max_length]);
   int actual_size = ucnv_toUChars(
-      converter, buffer.get(), static_cast<int>(uchar_max_length),
+      converter.get(), buffer.get(), static_cast<int>(uchar_max_length),
       encoded.data(), static_cast<int>(encoded.length()), &status);
-  ucnv_close(converter);
   if (!U_SUCCESS(status)) {
     utf16->clear();  // Make sure the output is empty on error.
     return false;
@@ -196,16 +325,34 @@ bool ConvertToUtf8AndNormalize(base::StringPiece text,
                                const std::string& charset,
                                std::string* result) {
   result->clear();
-  std::u16string utf16;
-  if (!CodepageToUTF16(text, charset.c_str(), OnStringConversionError::FAIL,
-                       &utf16))
-    return false;
-
   UErrorCode status = U_ZERO_ERROR;
   const icu::Normalizer2* normalizer = icu::Normalizer2::getNFCInstance(status);
   DCHECK(U_SUCCESS(status));
   if (U_FAILURE(status))
     return false;
+
+  // Text that is already normalized UTF-8 is returned as is, without a
+  // round trip through UTF-16.
+  {
+    ScopedUConverter converter(charset.c_str());
+    if (!converter.get())
+      return false;
+    if (ucnv_getType(converter.get()) == UCNV_UTF8 &&
+        IsStringUTF8AllowingNoncharacters(text) &&
+        normalizer->isNormalizedUTF8(
+            icu::StringPiece(text.data(), static_cast<int32_t>(text.size())),
+            status) &&
+        U_SUCCESS(status)) {
+      result->assign(text.data(), text.size());
+      return true;
+    }
+    status = U_ZERO_ERROR;
+  }
+
+  std::u16string utf16;
+  if (!CodepageToUTF16(text, charset.c_str(), OnStringConversionError::FAIL,
+                       &utf16))
+    return false;
   int32_t utf16_length = static_cast<int32_t>(utf16.length());
   icu::UnicodeString normalized(utf16.data(), utf16_length);
   int32_t normalized_prefix_length =
@@ -221,4 +368,127 @@ bool ConvertToUtf8AndNormalize(base::StringPiece text,
   return true;
 }
 
+// CodepageToUTF8Converter -----------------------------------------------------
+
+// static
+std::unique_ptr<CodepageToUTF8Converter> CodepageToUTF8Converter::Create(
+    const char* codepage_name,
+    OnStringConversionError::Type on_error) {
+  UConverterPool& pool = UConverterPool::GetForCurrentThread();
+  UConverter* converter = pool.Acquire(codepage_name);
+  if (!converter)
+    return nullptr;
+  UConverter* utf8_converter = pool.Acquire(kCodepageUTF8);
+  if (!utf8_converter) {
+    pool.Release(converter, codepage_name);
+    return nullptr;
+  }
+
+  UErrorCode status = U_ZERO_ERROR;
+  SetUpErrorHandlerForToUChars(on_error, converter, &status);
+  SetUpErrorHandlerForFromUChars(on_error, utf8_converter, &status);
+  DCHECK(U_SUCCESS(status));
+  return WrapUnique(
+      new CodepageToUTF8Converter(codepage_name, converter, utf8_converter));
+}
+
+CodepageToUTF8Converter::CodepageToUTF8Converter(std::string codepage_name,
+                                                 UConverter* converter,
+                                                 UConverter* utf8_converter)
+    : codepage_name_(std::move(codepage_name)),
+      converter_(converter),
+      utf8_converter_(utf8_converter),
+      copy_utf8_(ucnv_getType(converter) == UCNV_UTF8),
+      pivot_(new char16_t[kPivotSize]) {}
+
+CodepageToUTF8Converter::~CodepageToUTF8Converter() {
+  UConverterPool& pool = UConverterPool::GetForCurrentThread();
+  pool.Release(converter_.get(), codepage_name_);
+  pool.Release(utf8_converter_.get(), kCodepageUTF8);
+}
+
+bool CodepageToUTF8Converter::Convert(StringPiece chunk,
+                                      bool flush,
+                                      std::string* output) {
+  if (failed_)
+    return false;
+  if (copy_utf8_) {
+    if (CopyValidUTF8(&chunk, flush, output))
+      return true;
+    // ICU takes over from the first character that isn't valid UTF-8, and
+    // converts it according to the error handling mode.
+    copy_utf8_ = false;
+    if (!pending_utf8_.empty()) {
+      const std::string pending = std::move(pending_utf8_);
+      pending_utf8_.clear();
+      if (!ConvertWithICU(pending, /*flush=*/false, output)) {
+        failed_ = true;
+        return false;
+      }
+    }
+  }
+  failed_ = !ConvertWithICU(chunk, flush, output);
+  return !failed_;
+}
+
+bool CodepageToUTF8Converter::CopyValidUTF8(StringPiece* chunk,
+                                            bool flush,
+                                            std::string* output) {
+  if (!pending_utf8_.empty()) {
+    const size_t length =
+        UTF8SequenceLength(static_cast<uint8_t>(pending_utf8_[0]));
+    const size_t count =
+        std::min(length - pending_utf8_.size(), chunk->size());
+    pending_utf8_.append(chunk->data(), count);
+    chunk->remove_prefix(count);
+    if (pending_utf8_.size() < length)
+      return !flush;
+    if (!IsStringUTF8AllowingNoncharacters(pending_utf8_))
+      return false;
+    output->append(pending_utf8_);
+    pending_utf8_.clear();
+  }
+
+  size_t length = chunk->size();
+  if (!flush)
+    length -= IncompleteUTF8SuffixLength(*chunk);
+  const StringPiece complete = chunk->substr(0, length);
+  if (!IsStringUTF8AllowingNoncharacters(complete))
+    return false;
+  output->append(complete.data(), complete.size());
+  pending_utf8_.assign(chunk->data() + length, chunk->size() - length);
+  *chunk = StringPiece();
+  return true;
+}
+
+bool CodepageToUTF8Converter::ConvertWithICU(StringPiece chunk,
+                                             bool flush,
+                                             std::string* output) {
+  const char* source = chunk.empty() ? "" : chunk.data();
+  const char* const source_limit = source + chunk.size();
+  char16_t* pivot_source = pivot_.get() + pivot_begin_;
+  char16_t* pivot_target = pivot_.get() + pivot_end_;
+  size_t written = output->size();
+  UErrorCode status;
+  do {
+    // Most codepages take at least a byte for each UTF-16 code unit, which
+    // converts to at most 3 bytes of UTF-8. Larger outputs take more rounds.
+    const size_t input_length = static_cast<size_t>(source_limit - source) +
+                                static_cast<size_t>(pivot_target - pivot_source);
+    output->resize(written + 3 * input_length + 16);
+    char* const output_begin = &(*output)[0];
+    char* target = output_begin + written;
+    status = U_ZERO_ERROR;
+    ucnv_convertEx(utf8_converter_, converter_, &target,
+                   output_begin + output->size(), &source, source_limit,
+                   pivot_.get(), &pivot_source, &pivot_target,
+                   pivot_.get() + kPivotSize, /*reset=*/false, flush, &status);
+    written = static_cast<size_t>(target - output_begin);
+  } while (status == U_BUFFER_OVERFLOW_ERROR);
+  output->resize(written);
+  pivot_begin_ = static_cast<size_t>(pivot_source - pivot_.get());
+  pivot_end_ = static_cast<size_t>(pivot_target - pivot_.get());
+  return U_SUCCESS(status);
+}
+
 }  // namespace base
@@ -5,12 +5,18 @@
 #ifndef BASE_I18N_ICU_STRING_CONVERSIONS_H_
 #define BASE_I18N_ICU_STRING_CONVERSIONS_H_
 
+#include <stddef.h>
+
+#include <memory>
 #include <string>
 
 #include "base/i18n/base_i18n_export.h"
 #include "base/i18n/i18n_constants.h"
+#include "base/memory/raw_ptr.h"
 #include "base/strings/string_piece.h"
 
+struct UConverter;
+
 namespace base {
 
 // Defines the error handling modes of UTF16ToCodepage and CodepageToUTF16.
@@ -37,6 +43,10 @@ class OnStringConversionError {
 // Converts between UTF-16 strings and the encoding specified.  If the
 // encoding doesn't exist or the encoding fails (when on_error is FAIL),
 // returns false.
+//
+// The ICU converters behind these functions and CodepageToUTF8Converter are
+// pooled per thread, so only the first conversion of a thread from or to a
+// codepage opens a converter for it.
 BASE_I18N_EXPORT bool UTF16ToCodepage(base::StringPiece16 utf16,
                                       const char* codepage_name,
                                       OnStringConversionError::Type on_error,
@@ -52,6 +62,80 @@ BASE_I18N_EXPORT bool ConvertToUtf8AndNormalize(base::StringPiece text,
                                                 const std::string& charset,
                                                 std::string* result);
 
+// Converts text in a codepage to UTF-8 one chunk at a time, e.g. as a document
+// is read, without holding the whole text in memory. A character split across
+// chunks is converted with the chunk that ends it. Valid UTF-8 input, e.g. text
+// that DetectEncoding() found to be "UTF-8", is copied to the output without
+// going through ICU.
+//
+// Usage:
+//   std::unique_ptr<CodepageToUTF8Converter> converter =
+//       CodepageToUTF8Converter::Create(charset,
+//                                       OnStringConversionError::FAIL);
+//   std::string utf8;
+//   while (ReadChunk(&chunk)) {
+//     utf8.clear();
+//     if (!converter->Convert(chunk, /*flush=*/false, &utf8))
+//       return false;
+//     Consume(utf8);
+//   }
+//   utf8.clear();
+//   if (!converter->Convert(StringPiece(), /*flush=*/true, &utf8))
+//     return false;
+//   Consume(utf8);
+class BASE_I18N_EXPORT CodepageToUTF8Converter {
+ public:
+  // Returns null if |codepage_name| isn't a codepage ICU can convert from.
+  static std::unique_ptr<CodepageToUTF8Converter> Create(
+      const char* codepage_name,
+      OnStringConversionError::Type on_error);
+
+  CodepageToUTF8Converter(const CodepageToUTF8Converter&) = delete;
+  CodepageToUTF8Converter& operator=(const CodepageToUTF8Converter&) = delete;
+  ~CodepageToUTF8Converter();
+
+  // Converts |chunk| and appends the UTF-8 to |output|. The bytes at the end
+  // of |chunk| that don't make up a whole character are kept for the next
+  // call, unless |flush| is true, which ends the text. Returns false if the
+  // text can't be converted and |on_error| is FAIL; |output| then holds what
+  // was converted before the error, and the converter can't be used again.
+  // Appending lets callers reuse the capacity of |output| across chunks.
+  bool Convert(StringPiece chunk, bool flush, std::string* output);
+
+ private:
+  CodepageToUTF8Converter(std::string codepage_name,
+                          UConverter* converter,
+                          UConverter* utf8_converter);
+
+  // Copies the valid UTF-8 at the start of |*chunk| to |output| and removes
+  // it from |*chunk|. Returns false if the rest of the text has to go
+  // through ICU.
+  bool CopyValidUTF8(StringPiece* chunk, bool flush, std::string* output);
+
+  bool ConvertWithICU(StringPiece chunk, bool flush, std::string* output);
+
+  // The size of |pivot_| in UTF-16 code units.
+  static constexpr size_t kPivotSize = 1024;
+
+  const std::string codepage_name_;
+  raw_ptr<UConverter> converter_;
+  raw_ptr<UConverter> utf8_converter_;
+
+  // Whether the input is still copied without going through ICU. True for
+  // UTF-8 until invalid input is found.
+  bool copy_utf8_;
+  // The start of a UTF-8 character that ended a chunk while |copy_utf8_|.
+  std::string pending_utf8_;
+
+  // The UTF-16 that |converter_| produced and |utf8_converter_| hasn't
+  // consumed yet is in [pivot_begin_, pivot_end_) of |pivot_|.
+  std::unique_ptr<char16_t[]> pivot_;
+  size_t pivot_begin_ = 0;
+  size_t pivot_end_ = 0;
+
+  bool failed_ = false;
+};
+
 }  // namespace base
 
 #endif  // BASE_I18N_ICU_STRING_CONVERSIONS_H_
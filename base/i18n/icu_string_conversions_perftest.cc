@@ -0,0 +1,115 @@
+// Copyright 2022 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "base/i18n/icu_string_conversions.h"
+
+#include <stddef.h>
+
+#include <algorithm>
+#include <memory>
+#include <string>
+
+#include "base/strings/utf_string_conversions.h"
+#include "base/time/time.h"
+#include "testing/gtest/include/gtest/gtest.h"
+#include "testing/perf/perf_result_reporter.h"
+
+namespace base {
+
+namespace {
+
+constexpr int kCount = 10;
+constexpr size_t kChunkSize = 64 * 1024;
+
+constexpr char kMetricPrefixCodepage[] = "CodepageToUTF8.";
+constexpr char kMetricThroughput[] = "throughput";
+
+perf_test::PerfResultReporter SetUpReporter(const std::string& story_name) {
+  perf_test::PerfResultReporter reporter(kMetricPrefixCodepage, story_name);
+  reporter.RegisterImportantMetric(kMetricThroughput, "bytesPerSecond");
+  return reporter;
+}
+
+// Returns about 4 MB of |line|.
+std::string MakeDocument(const std::string& line) {
+  std::string document;
+  while (document.size() < 4 * 1024 * 1024)
+    document += line;
+  return document;
+}
+
+void ReportThroughput(const std::string& story_name,
+                      size_t size,
+                      TimeDelta elapsed) {
+  SetUpReporter(story_name)
+      .AddResult(kMetricThroughput, kCount * size / elapsed.InSecondsF());
+}
+
+// Converts |document| as a whole, through UTF-16, as callers had to before
+// CodepageToUTF8Converter.
+void RunWholeDocument(const std::string& story_name,
+                      const std::string& document,
+                      const char* codepage_name) {
+  const TimeTicks start = TimeTicks::Now();
+  for (int i = 0; i < kCount; ++i) {
+    std::u16string utf16;
+    ASSERT_TRUE(CodepageToUTF16(document, codepage_name,
+                                OnStringConversionError::SUBSTITUTE, &utf16));
+    EXPECT_FALSE(UTF16ToUTF8(utf16).empty());
+  }
+  ReportThroughput(story_name, document.size(), TimeTicks::Now() - start);
+}
+
+// Converts |document| kChunkSize bytes at a time into one reused buffer.
+void RunChunks(const std::string& story_name,
+               const std::string& document,
+               const char* codepage_name) {
+  std::string utf8;
+  const TimeTicks start = TimeTicks::Now();
+  for (int i = 0; i < kCount; ++i) {
+    std::unique_ptr<CodepageToUTF8Converter> converter =
+        CodepageToUTF8Converter::Create(codepage_name,
+                                        OnStringConversionError::SUBSTITUTE);
+    ASSERT_TRUE(converter);
+    for (size_t pos = 0; pos < document.size(); pos += kChunkSize) {
+      utf8.clear();
+      ASSERT_TRUE(converter->Convert(
+          StringPiece(document).substr(pos, kChunkSize), /*flush=*/false,
+          &utf8));
+    }
+    utf8.clear();
+    ASSERT_TRUE(converter->Convert(StringPiece(), /*flush=*/true, &utf8));
+  }
+  ReportThroughput(story_name, document.size(), TimeTicks::Now() - start);
+}
+
+}  // namespace
+
+TEST(CodepageToUTF8ConverterPerfTest, Latin1) {
+  const std::string document = MakeDocument(
+      "<p>Die B\xFC" "cher \xFC" "ber Stra\xDF" "en und Caf\xE9s.</p>\n");
+  RunWholeDocument("latin1_whole", document, "windows-1252");
+  RunChunks("latin1_chunks", document, "windows-1252");
+}
+
+TEST(CodepageToUTF8ConverterPerfTest, ShiftJIS) {
+  // "Nihongo no tekisuto" in Shift_JIS, with some ASCII markup.
+  const std::string document = MakeDocument(
+      "<p>\x93\xFA\x96\x7B\x8C\xEA\x82\xCC\x83\x65\x83\x4C\x83\x58\x83\x67"
+      "</p>\n");
+  RunWholeDocument("shift_jis_whole", document, "shift_jis");
+  RunChunks("shift_jis_chunks", document, "shift_jis");
+}
+
+// DetectEncoding() finds most documents to be UTF-8, which is copied without
+// ICU.
+TEST(CodepageToUTF8ConverterPerfTest, UTF8) {
+  const std::string document = MakeDocument(
+      "<p>Die B\xC3\xBC" "cher \xC3\xBC" "ber Stra\xC3\x9F" "en, "
+      "\xE6\x97\xA5\xE6\x9C\xAC.</p>\n");
+  RunWholeDocument("utf8_whole", document, "UTF-8");
+  RunChunks("utf8_chunks", document, "UTF-8");
+}
+
+}  // namespace base
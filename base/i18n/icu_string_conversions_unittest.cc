@@ -7,7 +7,9 @@
 #include <stddef.h>
 
 #include <limits>
+#include <memory>
 #include <sstream>
+#include <string>
 
 #include "base/check_op.h"
 #include "base/cxx17_backports.h"
@@ -196,6 +198,86 @@ TEST(ICUStringConversionsTest, ConvertBetweenCodepageAndUTF16) {
   }
 }
 
+// Converts |encoded| with a CodepageToUTF8Converter, |chunk_size| bytes at a
+// time.
+bool ConvertInChunks(base::StringPiece encoded,
+                     const char* codepage_name,
+                     OnStringConversionError::Type on_error,
+                     size_t chunk_size,
+                     std::string* utf8) {
+  std::unique_ptr<CodepageToUTF8Converter> converter =
+      CodepageToUTF8Converter::Create(codepage_name, on_error);
+  if (!converter)
+    return false;
+  utf8->clear();
+  while (encoded.size() > chunk_size) {
+    if (!converter->Convert(encoded.substr(0, chunk_size), /*flush=*/false,
+                            utf8)) {
+      return false;
+    }
+    encoded.remove_prefix(chunk_size);
+  }
+  return converter->Convert(encoded, /*flush=*/true, utf8);
+}
+
+TEST(ICUStringConversionsTest, CodepageToUTF8Converter) {
+  for (size_t i = 0; i < base::size(kConvertCodepageCases); ++i) {
+    const std::u16string utf16_expected =
+        BuildString16(kConvertCodepageCases[i].u16_wide
+                          ? kConvertCodepageCases[i].u16_wide
+                          : kConvertCodepageCases[i].wide);
+    for (size_t chunk_size : {1, 2, 3, 1000}) {
+      SCOPED_TRACE(base::StringPrintf(
+          "Test[%" PRIuS "]: <encoded: %s> <codepage: %s> <chunk: %" PRIuS
+          ">",
+          i, kConvertCodepageCases[i].encoded,
+          kConvertCodepageCases[i].codepage_name, chunk_size));
+      std::string utf8;
+      bool success = ConvertInChunks(kConvertCodepageCases[i].encoded,
+                                     kConvertCodepageCases[i].codepage_name,
+                                     kConvertCodepageCases[i].on_error,
+                                     chunk_size, &utf8);
+      EXPECT_EQ(kConvertCodepageCases[i].success, success);
+      if (success)
+        EXPECT_EQ(UTF16ToUTF8(utf16_expected), utf8);
+    }
+  }
+}
+
+TEST(ICUStringConversionsTest, CodepageToUTF8ConverterUnknownCodepage) {
+  EXPECT_FALSE(CodepageToUTF8Converter::Create(
+      "foo-bar", OnStringConversionError::SUBSTITUTE));
+}
+
+// UTF-8 is copied as is until it is invalid, and ICU converts the rest.
+TEST(ICUStringConversionsTest, CodepageToUTF8ConverterUTF8) {
+  // "a", U+00E9, U+4F60, U+1F600, "z", split at every byte.
+  const std::string valid = "a\xC3\xA9\xE4\xBD\xA0\xF0\x9F\x98\x80z";
+  for (size_t chunk_size = 1; chunk_size <= valid.size(); ++chunk_size) {
+    SCOPED_TRACE(chunk_size);
+    std::string utf8;
+    EXPECT_TRUE(ConvertInChunks(valid, "UTF-8", OnStringConversionError::FAIL,
+                                chunk_size, &utf8));
+    EXPECT_EQ(valid, utf8);
+
+    // An invalid byte, a lone trail byte and a sequence that the text ends
+    // in the middle of.
+    const std::string invalid = valid + "\xFF" + valid + "\x80" + "\xE4\xBD";
+    EXPECT_FALSE(ConvertInChunks(invalid, "utf-8",
+                                 OnStringConversionError::FAIL, chunk_size,
+                                 &utf8));
+    EXPECT_TRUE(ConvertInChunks(invalid, "utf-8",
+                                OnStringConversionError::SUBSTITUTE,
+                                chunk_size, &utf8));
+    const std::string kReplacement = "\xEF\xBF\xBD";
+    EXPECT_EQ(valid + kReplacement + valid + kReplacement + kReplacement,
+              utf8);
+    EXPECT_TRUE(ConvertInChunks(invalid, "utf-8", OnStringConversionError::SKIP,
+                                chunk_size, &utf8));
+    EXPECT_EQ(valid + valid, utf8);
+  }
+}
+
 static const struct {
   const char* encoded;
   const char* codepage_name;
@@ -209,6 +291,8 @@ static const struct {
   {"foo-\xff.html", "ascii", true, "foo-\xc3\xbf.html"},
   {"foo.html", "ascii", true, "foo.html"},
   {"foo-a\xcc\x88.html", "utf-8", true, "foo-\xc3\xa4.html"},
+  {"foo-\xc3\xa4.html", "utf-8", true, "foo-\xc3\xa4.html"},
+  {"foo-\xe4.html", "utf-8", false, ""},
   {"\x95\x32\x82\x36\xD2\xBB", "gb18030", true, "\xF0\xA0\x80\x80\xE4\xB8\x80"},
   {"\xA7\x41\xA6\x6E", "big5", true, "\xE4\xBD\xA0\xE5\xA5\xBD"},
   // Windows-1258 does have a combining character at xD2 (which is U+0309).
@@ -10,6 +10,10 @@
 #include <windows.h>
 #endif
 
+#if BUILDFLAG(IS_POSIX)
+#include <fcntl.h>
+#endif
+
 #include <memory>
 #include <string>
 
@@ -18,12 +22,16 @@
 #include "base/files/file_path.h"
 #include "base/files/file_util.h"
 #include "base/files/memory_mapped_file.h"
+#include "base/i18n/icu_data_page_list.h"
 #include "base/logging.h"
 #include "base/metrics/histogram_functions.h"
 #include "base/metrics/metrics_hashes.h"
+#include "base/no_destructor.h"
 #include "base/path_service.h"
 #include "base/strings/string_util.h"
 #include "base/strings/sys_string_conversions.h"
+#include "base/synchronization/lock.h"
+#include "base/thread_annotations.h"
 #include "build/build_config.h"
 #include "build/chromecast_buildflags.h"
 #include "third_party/icu/source/common/unicode/putil.h"
@@ -124,6 +132,24 @@ PlatformFile g_icudtl_extra_pf = kInvalidPlatformFile;
 MemoryMappedFile* g_icudtl_extra_mapped_file = nullptr;
 MemoryMappedFile::Region g_icudtl_extra_region;
 
+// Set by SetIcuDataStartupMode() before ICU is initialized.
+IcuDataStartupMode g_icu_data_startup_mode = IcuDataStartupMode::kDefault;
+FilePath* g_icu_data_page_list_path = nullptr;
+
+#if BUILDFLAG(IS_POSIX)
+// The recorder of the pages ICU reads in IcuDataStartupMode::kRecordPages. It
+// is updated from the ICU trace callbacks, which run on any thread.
+struct IcuDataPageRecording {
+  Lock lock;
+  std::unique_ptr<IcuDataPageRecorder> recorder GUARDED_BY(lock);
+};
+
+IcuDataPageRecording& GetIcuDataPageRecording() {
+  static NoDestructor<IcuDataPageRecording> recording;
+  return *recording;
+}
+#endif  // BUILDFLAG(IS_POSIX)
+
 #if BUILDFLAG(IS_FUCHSIA)
 // The directory from which the ICU data loader will be configured to load time
 // zone data. It is only changed by SetIcuTimeZoneDataDirForTesting().
@@ -236,8 +262,60 @@ void InitializeExternalTimeZoneData() {
 #endif  // BUILDFLAG(IS_FUCHSIA)
 }
 
+// Returns the options to map the main data file with in the current
+// IcuDataStartupMode. In kRecordPages, the file is also evicted from the page
+// cache first, where supported, so that the pages it lists are read by ICU
+// rather than by other processes.
+MemoryMappedFile::Options GetIcuDataMappingOptions(
+    PlatformFile data_fd,
+    const MemoryMappedFile::Region& data_region) {
+  MemoryMappedFile::Options options;
+  if (g_icu_data_startup_mode != IcuDataStartupMode::kRecordPages)
+    return options;
+#if BUILDFLAG(IS_LINUX) || BUILDFLAG(IS_CHROMEOS) || BUILDFLAG(IS_ANDROID)
+  const bool whole_file = data_region == MemoryMappedFile::Region::kWholeFile;
+  const off_t offset = whole_file ? 0 : static_cast<off_t>(data_region.offset);
+  const off_t size = whole_file ? 0 : static_cast<off_t>(data_region.size);
+  if (posix_fadvise(data_fd, offset, size, POSIX_FADV_DONTNEED) != 0)
+    DLOG(WARNING) << "Couldn't evict the icu data file from the page cache";
+#endif
+  options.advice = MemoryMappedFile::Advice::kRandom;
+  return options;
+}
+
+// Starts recording or prefetching the pages of the mapped main data file, in
+// the current IcuDataStartupMode, before ICU reads it.
+void StartIcuDataStartupMode(MemoryMappedFile* mapped_file) {
+#if BUILDFLAG(IS_POSIX)
+  switch (g_icu_data_startup_mode) {
+    case IcuDataStartupMode::kDefault:
+      return;
+    case IcuDataStartupMode::kRecordPages: {
+      IcuDataPageRecording& recording = GetIcuDataPageRecording();
+      AutoLock auto_lock(recording.lock);
+      recording.recorder = std::make_unique<IcuDataPageRecorder>(mapped_file);
+      return;
+    }
+    case IcuDataStartupMode::kPrefetchPages: {
+      std::string serialized;
+      absl::optional<IcuDataPageList> page_list;
+      if (ReadFileToString(*g_icu_data_page_list_path, &serialized))
+        page_list = IcuDataPageList::Deserialize(serialized);
+      if (!page_list || !PrefetchIcuDataPages(mapped_file, *page_list)) {
+        DLOG(WARNING) << "No icu data page list for this data at "
+                      << *g_icu_data_page_list_path;
+      }
+      return;
+    }
+  }
+#endif  // BUILDFLAG(IS_POSIX)
+}
+
+// |apply_startup_mode| is true for the main data file, which is read in the
+// IcuDataStartupMode.
 int LoadIcuData(PlatformFile data_fd,
                 const MemoryMappedFile::Region& data_region,
+                bool apply_startup_mode,
                 std::unique_ptr<MemoryMappedFile>* out_mapped_data_file,
                 UErrorCode* out_error_code) {
   InitializeExternalTimeZoneData();
@@ -247,11 +325,18 @@ int LoadIcuData(PlatformFile data_fd,
     return 1;  // To debug http://crbug.com/445616.
   }
 
+  MemoryMappedFile::Options options;
+  if (apply_startup_mode)
+    options = GetIcuDataMappingOptions(data_fd, data_region);
   *out_mapped_data_file = std::make_unique<MemoryMappedFile>();
-  if (!(*out_mapped_data_file)->Initialize(File(data_fd), data_region)) {
+  if (!(*out_mapped_data_file)
+           ->Initialize(File(data_fd), data_region, MemoryMappedFile::READ_ONLY,
+                        options)) {
     LOG(ERROR) << "Couldn't mmap icu data file";
     return 2;  // To debug http://crbug.com/445616.
   }
+  if (apply_startup_mode)
+    StartIcuDataStartupMode(out_mapped_data_file->get());
 
   (*out_error_code) = U_ZERO_ERROR;
   udata_setCommonData(const_cast<uint8_t*>((*out_mapped_data_file)->data()),
@@ -276,7 +361,9 @@ bool InitializeICUWithFileDescriptorInternal(
 
   std::unique_ptr<MemoryMappedFile> mapped_file;
   UErrorCode err;
-  g_debug_icu_load = LoadIcuData(data_fd, data_region, &mapped_file, &err);
+  g_debug_icu_load = LoadIcuData(data_fd, data_region,
+                                 /*apply_startup_mode=*/true, &mapped_file,
+                                 &err);
   if (g_debug_icu_load == 1 || g_debug_icu_load == 2) {
     return false;
   }
@@ -319,6 +406,19 @@ bool InitializeICUFromDataFile() {
 }
 #endif  // (ICU_UTIL_DATA_IMPL == ICU_UTIL_DATA_FILE)
 
+// In IcuDataStartupMode::kRecordPages, records the pages of the data file read
+// since the last call. Called whenever ICU traces that it loads data.
+void RecordIcuDataPages() {
+#if (ICU_UTIL_DATA_IMPL == ICU_UTIL_DATA_FILE) && BUILDFLAG(IS_POSIX)
+  if (g_icu_data_startup_mode != IcuDataStartupMode::kRecordPages)
+    return;
+  IcuDataPageRecording& recording = GetIcuDataPageRecording();
+  AutoLock auto_lock(recording.lock);
+  if (recording.recorder)
+    recording.recorder->Update();
+#endif
+}
+
 // Explicitly initialize ICU's time zone if necessary.
 // On some platforms, the time zone must be explicitly initialized zone rather
 // than relying on ICU's internal initialization.
@@ -380,6 +480,7 @@ enum class ICUCreateInstance {
 // key objects to UMA. This help us to understand what built-in ICU data files
 // are rarely used in the user's machines and the distribution of ICU usage.
 static void U_CALLCONV TraceICUEntry(const void*, int32_t fn_number) {
+  RecordIcuDataPages();
   switch (fn_number) {
     case UTRACE_UBRK_CREATE_CHARACTER:
       base::UmaHistogramEnumeration(kICUCreateInstance,
@@ -407,6 +508,7 @@ static void U_CALLCONV TraceICUData(const void* context,
                                     int32_t level,
                                     const char* fmt,
                                     va_list args) {
+  RecordIcuDataPages();
   switch (fn_number) {
     case UTRACE_UDATA_DATA_FILE: {
       std::string icu_data_file_name(va_arg(args, const char*));
@@ -515,7 +617,8 @@ bool InitializeExtraICUWithFileDescriptor(
   }
   std::unique_ptr<MemoryMappedFile> mapped_file;
   UErrorCode err;
-  if (LoadIcuData(data_fd, data_region, &mapped_file, &err) != 0) {
+  if (LoadIcuData(data_fd, data_region, /*apply_startup_mode=*/false,
+                  &mapped_file, &err) != 0) {
     return false;
   }
   g_icudtl_extra_mapped_file = mapped_file.release();
@@ -562,19 +665,55 @@ bool InitializeExtraICU(const std::string& split_name) {
   g_icudtl_extra_region = pf_region->region;
   std::unique_ptr<MemoryMappedFile> mapped_file;
   UErrorCode err;
-  if (LoadIcuData(g_icudtl_extra_pf, g_icudtl_extra_region, &mapped_file,
-                  &err) != 0) {
+  if (LoadIcuData(g_icudtl_extra_pf, g_icudtl_extra_region,
+                  /*apply_startup_mode=*/false, &mapped_file, &err) != 0) {
     return false;
   }
   g_icudtl_extra_mapped_file = mapped_file.release();
   return true;
 }
 
+void SetIcuDataStartupMode(IcuDataStartupMode mode,
+                           const FilePath& page_list_path) {
+  DCHECK(!g_icudtl_mapped_file);
+  g_icu_data_startup_mode = mode;
+  delete g_icu_data_page_list_path;
+  g_icu_data_page_list_path = new FilePath(page_list_path);
+}
+
+bool WriteIcuDataPageList() {
+#if BUILDFLAG(IS_POSIX)
+  if (g_icu_data_startup_mode != IcuDataStartupMode::kRecordPages)
+    return false;
+  std::unique_ptr<IcuDataPageRecorder> recorder;
+  {
+    IcuDataPageRecording& recording = GetIcuDataPageRecording();
+    AutoLock auto_lock(recording.lock);
+    recorder = std::move(recording.recorder);
+  }
+  if (!recorder)
+    return false;
+  recorder->Update();
+  return WriteFile(*g_icu_data_page_list_path,
+                   recorder->page_list().Serialize());
+#else
+  return false;
+#endif  // BUILDFLAG(IS_POSIX)
+}
+
 void ResetGlobalsForTesting() {
   g_icudtl_pf = kInvalidPlatformFile;
   g_icudtl_mapped_file = nullptr;
   g_icudtl_extra_pf = kInvalidPlatformFile;
   g_icudtl_extra_mapped_file = nullptr;
+  g_icu_data_startup_mode = IcuDataStartupMode::kDefault;
+#if BUILDFLAG(IS_POSIX)
+  {
+    IcuDataPageRecording& recording = GetIcuDataPageRecording();
+    AutoLock auto_lock(recording.lock);
+    recording.recorder.reset();
+  }
+#endif  // BUILDFLAG(IS_POSIX)
 #if BUILDFLAG(IS_FUCHSIA)
   g_icu_time_zone_data_dir = kIcuTimeZoneDataDir;
 #endif  // BUILDFLAG(IS_FUCHSIA)
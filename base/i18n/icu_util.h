@@ -8,6 +8,7 @@
 #include <stdint.h>
 #include <string>
 
+#include "base/files/file_path.h"
 #include "base/files/memory_mapped_file.h"
 #include "base/i18n/base_i18n_export.h"
 #include "build/build_config.h"
@@ -50,6 +51,33 @@ BASE_I18N_EXPORT bool InitializeExtraICUWithFileDescriptor(
     PlatformFile data_fd,
     const MemoryMappedFile::Region& data_region);
 
+// How the ICU data file is read at startup, to cut the time the first ICU
+// calls spend in page faults when the file isn't in the page cache.
+enum class IcuDataStartupMode {
+  // Pages are read as ICU faults them in.
+  kDefault,
+  // Training run: records the order in which ICU first reads the pages of the
+  // data file, for WriteIcuDataPageList(). The data file is evicted from the
+  // page cache and read without readahead, so startup is slower.
+  kRecordPages,
+  // Reads the pages listed in the page list file ahead in the background, in
+  // their recorded order, as soon as the data file is mapped. Behaves as
+  // kDefault if the list can't be read or was recorded for other data.
+  kPrefetchPages,
+};
+
+// Sets how InitializeICU() and InitializeICUWithFileDescriptor() read the ICU
+// data file in, and the page list file that kRecordPages writes and
+// kPrefetchPages reads. Must be called before either. Only the main data file
+// is affected, and only on POSIX; elsewhere, all modes behave as kDefault.
+BASE_I18N_EXPORT void SetIcuDataStartupMode(IcuDataStartupMode mode,
+                                            const FilePath& page_list_path);
+
+// In IcuDataStartupMode::kRecordPages, writes the pages of the ICU data file
+// read so far to the page list file, and stops recording. Call it once startup
+// is done. Returns false on failure or in other modes.
+BASE_I18N_EXPORT bool WriteIcuDataPageList();
+
 BASE_I18N_EXPORT void ResetGlobalsForTesting();
 
 #if BUILDFLAG(IS_FUCHSIA)
@@ -0,0 +1,193 @@
+// Copyright 2022 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "base/i18n/icu_util.h"
+
+#include <stdint.h>
+
+#include <string>
+
+#include "base/base_paths.h"
+#include "base/command_line.h"
+#include "base/files/file.h"
+#include "base/files/file_path.h"
+#include "base/files/file_util.h"
+#include "base/files/scoped_temp_dir.h"
+#include "base/i18n/break_iterator.h"
+#include "base/i18n/case_conversion.h"
+#include "base/i18n/icu_data_page_list.h"
+#include "base/i18n/number_formatting.h"
+#include "base/i18n/rtl.h"
+#include "base/i18n/string_search.h"
+#include "base/i18n/time_formatting.h"
+#include "base/path_service.h"
+#include "base/process/process.h"
+#include "base/strings/string_number_conversions.h"
+#include "base/test/multiprocess_test.h"
+#include "base/test/test_file_util.h"
+#include "base/test/test_timeouts.h"
+#include "base/time/time.h"
+#include "build/build_config.h"
+#include "testing/gtest/include/gtest/gtest.h"
+#include "testing/multiprocess_func_list.h"
+#include "testing/perf/perf_result_reporter.h"
+#include "third_party/icu/source/common/unicode/uclean.h"
+
+#if ICU_UTIL_DATA_IMPL == ICU_UTIL_DATA_FILE && \
+    (BUILDFLAG(IS_LINUX) || BUILDFLAG(IS_CHROMEOS))
+
+namespace base {
+namespace i18n {
+
+namespace {
+
+constexpr int kNumRuns = 5;
+
+constexpr char kDataFileSwitch[] = "icu-data-file";
+constexpr char kModeSwitch[] = "icu-data-startup-mode";
+constexpr char kPageListSwitch[] = "icu-data-page-list";
+constexpr char kResultSwitch[] = "result";
+
+constexpr char kRecordMode[] = "record";
+constexpr char kPrefetchMode[] = "prefetch";
+
+constexpr char kMetricPrefixIcuStartup[] = "IcuStartup.";
+constexpr char kMetricStartupTime[] = "startup_time";
+constexpr char kMetricPageCount[] = "page_count";
+
+perf_test::PerfResultReporter SetUpReporter(const std::string& story_name) {
+  perf_test::PerfResultReporter reporter(kMetricPrefixIcuStartup, story_name);
+  reporter.RegisterImportantMetric(kMetricStartupTime, "ms");
+  reporter.RegisterImportantMetric(kMetricPageCount, "count");
+  return reporter;
+}
+
+// The ICU calls a browser typically makes early on.
+void RunStartupWorkload() {
+  SetICUDefaultLocale("en_US");
+  const std::u16string text = u"Straße, café et résumé";
+  BreakIterator iter(text, BreakIterator::BREAK_WORD);
+  CHECK(iter.Init());
+  while (iter.Advance()) {
+  }
+  FormatNumber(1234567);
+  TimeFormatFriendlyDateAndTime(Time::Now());
+  FoldCase(text);
+  size_t index = 0;
+  FixedPatternStringSearchIgnoringCaseAndAccents(u"resume").Search(
+      text, &index, nullptr);
+}
+
+// Runs the startup of a process that initializes ICU from the data file in
+// the given mode, and returns the time it took, or a zero TimeDelta on failure.
+TimeDelta RunStartup(const FilePath& temp_dir,
+                     const FilePath& data_path,
+                     const std::string& mode) {
+  const FilePath result_path = temp_dir.AppendASCII("result");
+  CommandLine command_line = GetMultiProcessTestChildBaseCommandLine();
+  command_line.AppendSwitchPath(kDataFileSwitch, data_path);
+  command_line.AppendSwitchASCII(kModeSwitch, mode);
+  command_line.AppendSwitchPath(kPageListSwitch,
+                                temp_dir.AppendASCII("icudtl.pages"));
+  command_line.AppendSwitchPath(kResultSwitch, result_path);
+  Process process = SpawnMultiProcessTestChild("IcuStartupPerfTestChild",
+                                               command_line, LaunchOptions());
+  int exit_code = -1;
+  if (!WaitForMultiprocessTestChildExit(
+          process, TestTimeouts::action_max_timeout(), &exit_code) ||
+      exit_code != 0) {
+    return TimeDelta();
+  }
+  std::string result;
+  int64_t us = 0;
+  if (!ReadFileToString(result_path, &result) || !StringToInt64(result, &us))
+    return TimeDelta();
+  return Microseconds(us);
+}
+
+}  // namespace
+
+// Initializes ICU from the data file passed on the command line, in the given
+// IcuDataStartupMode, runs a typical startup workload, and writes the time it
+// took in microseconds to the result file.
+MULTIPROCESS_TEST_MAIN(IcuStartupPerfTestChild) {
+  const CommandLine& command_line = *CommandLine::ForCurrentProcess();
+  const std::string mode = command_line.GetSwitchValueASCII(kModeSwitch);
+
+  // The test suite already initialized ICU from its own data file.
+  u_cleanup();
+  ResetGlobalsForTesting();
+  AllowMultipleInitializeCallsForTesting();
+  IcuDataStartupMode startup_mode = IcuDataStartupMode::kDefault;
+  if (mode == kRecordMode)
+    startup_mode = IcuDataStartupMode::kRecordPages;
+  else if (mode == kPrefetchMode)
+    startup_mode = IcuDataStartupMode::kPrefetchPages;
+  SetIcuDataStartupMode(startup_mode,
+                        command_line.GetSwitchValuePath(kPageListSwitch));
+
+  const TimeTicks start = TimeTicks::Now();
+  File data_file(command_line.GetSwitchValuePath(kDataFileSwitch),
+                 File::FLAG_OPEN | File::FLAG_READ);
+  if (!InitializeICUWithFileDescriptor(data_file.TakePlatformFile(),
+                                       MemoryMappedFile::Region::kWholeFile)) {
+    return 1;
+  }
+  RunStartupWorkload();
+  const TimeDelta elapsed = TimeTicks::Now() - start;
+
+  if (mode == kRecordMode && !WriteIcuDataPageList())
+    return 1;
+  return WriteFile(command_line.GetSwitchValuePath(kResultSwitch),
+                   NumberToString(elapsed.InMicroseconds()))
+             ? 0
+             : 1;
+}
+
+// Measures the startup of processes whose ICU data file isn't in the page
+// cache, with and without a page list recorded by a training run. The data
+// file is copied to a temporary directory, which must not be on tmpfs, since
+// files there can't be evicted from the page cache.
+TEST(IcuUtilPerfTest, ColdStartup) {
+  ScopedTempDir temp_dir;
+  ASSERT_TRUE(temp_dir.CreateUniqueTempDir());
+  FilePath assets_path;
+  ASSERT_TRUE(PathService::Get(DIR_ASSETS, &assets_path));
+  const FilePath data_path = temp_dir.GetPath().AppendASCII("icudtl.dat");
+  ASSERT_TRUE(CopyFile(assets_path.AppendASCII("icudtl.dat"), data_path));
+
+  ASSERT_TRUE(EvictFileFromSystemCacheWithRetry(data_path));
+  ASSERT_FALSE(
+      RunStartup(temp_dir.GetPath(), data_path, kRecordMode).is_zero());
+  std::string serialized;
+  ASSERT_TRUE(ReadFileToString(temp_dir.GetPath().AppendASCII("icudtl.pages"),
+                               &serialized));
+  absl::optional<IcuDataPageList> page_list =
+      IcuDataPageList::Deserialize(serialized);
+  ASSERT_TRUE(page_list);
+
+  // Alternates the modes, so that both see the same disk conditions.
+  TimeDelta default_time;
+  TimeDelta prefetch_time;
+  for (int i = 0; i < kNumRuns; ++i) {
+    for (const std::string mode : {"default", kPrefetchMode}) {
+      ASSERT_TRUE(EvictFileFromSystemCacheWithRetry(data_path));
+      const TimeDelta time = RunStartup(temp_dir.GetPath(), data_path, mode);
+      ASSERT_FALSE(time.is_zero());
+      (mode == kPrefetchMode ? prefetch_time : default_time) += time;
+    }
+  }
+
+  SetUpReporter("cold_default")
+      .AddResult(kMetricStartupTime, default_time / kNumRuns);
+  perf_test::PerfResultReporter reporter = SetUpReporter("cold_prefetch");
+  reporter.AddResult(kMetricStartupTime, prefetch_time / kNumRuns);
+  reporter.AddResult(kMetricPageCount, page_list->pages.size());
+}
+
+}  // namespace i18n
+}  // namespace base
+
+#endif  // ICU_UTIL_DATA_IMPL == ICU_UTIL_DATA_FILE && (BUILDFLAG(IS_LINUX) ||
+        // BUILDFLAG(IS_CHROMEOS))
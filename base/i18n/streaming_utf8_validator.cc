@@ -10,15 +10,31 @@
 
 #include "base/check_op.h"
 #include "base/i18n/utf8_validator_tables.h"
+#include "base/strings/utf_simd.h"
 
 namespace base {
 namespace {
 
+// Shorter data is faster to validate with the state machine alone.
+constexpr size_t kVectorizedValidationMinSize = 64;
+
 uint8_t StateTableLookup(uint8_t offset) {
   DCHECK_LT(offset, internal::kUtf8ValidatorTablesSize);
   return internal::kUtf8ValidatorTables[offset];
 }
 
+// Returns the length of the prefix of |data| which ends before its last lead
+// byte, so that it ends with complete sequences if it's valid, or 0 if the last
+// bytes can't be split that way.
+size_t CompleteSequencesPrefix(const char* data, size_t size) {
+  // A sequence has at most 3 continuation bytes.
+  for (size_t i = size; i > 0 && size - i < 4; --i) {
+    if ((data[i - 1] & 0xC0) != 0x80)
+      return i - 1;
+  }
+  return 0;
+}
+
 }  // namespace
 
 StreamingUtf8Validator::State StreamingUtf8Validator::AddBytes(const char* data,
@@ -26,7 +42,19 @@ StreamingUtf8Validator::State StreamingUtf8Validator::AddBytes(const char* data,
   // Copy |state_| into a local variable so that the compiler doesn't have to be
   // careful of aliasing.
   uint8_t state = state_;
-  for (const char* p = data; p != data + size; ++p) {
+  const char* p = data;
+  // Between sequences, the vectorized validator checks all the sequences
+  // which the data completes, and the state machine the rest.
+  if (state == 0 && size >= kVectorizedValidationMinSize) {
+    const size_t prefix_size = CompleteSequencesPrefix(data, size);
+    if (internal::ValidateUTF8(data, prefix_size) ==
+        internal::UTF8Validity::kInvalid) {
+      state_ = internal::I18N_UTF8_VALIDATOR_INVALID_INDEX;
+      return INVALID;
+    }
+    p += prefix_size;
+  }
+  for (; p != data + size; ++p) {
     if ((*p & 0x80) == 0) {
       if (state == 0)
         continue;
@@ -318,6 +318,25 @@ TEST(StreamingUtf8ValidatorTest, ResetWorks) {
   EXPECT_EQ(VALID_ENDPOINT, validator.AddBytes("a", 1));
 }
 
+// Long inputs are validated in blocks, except for the sequences they cut off
+// at the end.
+TEST(StreamingUtf8ValidatorTest, LongInputsSplitAnywhere) {
+  std::string text;
+  for (int i = 0; i < 10; ++i)
+    text += "caf\xC3\xA9 \xE6\x97\xA5 \xF0\x9F\x98\x80 ";
+  for (size_t split = 0; split <= text.size(); ++split) {
+    StreamingUtf8Validator validator;
+    EXPECT_NE(INVALID, validator.AddBytes(text.data(), split));
+    EXPECT_EQ(VALID_ENDPOINT,
+              validator.AddBytes(text.data() + split, text.size() - split));
+  }
+  for (size_t i = 0; i < text.size(); ++i) {
+    std::string invalid = text;
+    invalid[i] = '\xFF';
+    EXPECT_FALSE(StreamingUtf8Validator::Validate(invalid));
+  }
+}
+
 TEST_F(StreamingUtf8ValidatorSingleSequenceTest, Valid) {
   CheckRange(valid, valid_end, VALID_ENDPOINT);
 }
@@ -6,27 +6,77 @@
 
 #include "base/i18n/string_search.h"
 
+#include <memory>
+#include <string>
+#include <vector>
+
 #include "base/check.h"
 #include "base/check_op.h"
+#include "base/memory/ptr_util.h"
+#include "base/no_destructor.h"
+#include "base/threading/thread_local.h"
 #include "third_party/icu/source/i18n/unicode/usearch.h"
 
 namespace base {
 namespace i18n {
 
-FixedPatternStringSearch::FixedPatternStringSearch(
-    const std::u16string& find_this,
-    bool case_sensitive)
-    : find_this_(find_this) {
-  // usearch_open requires a valid string argument to be searched, even if we
-  // want to set it by usearch_setText afterwards. So, supplying a dummy text.
-  const std::u16string& dummy = find_this_;
+namespace {
 
-  UErrorCode status = U_ZERO_ERROR;
-  search_ = usearch_open(find_this_.data(), find_this_.size(), dummy.data(),
-                         dummy.size(), uloc_getDefault(),
-                         nullptr,  // breakiter
-                         &status);
-  if (U_SUCCESS(status)) {
+// The UStringSearches of a thread which aren't used by a search. Each owns the
+// collator it was opened from, for the locale and strength it is kept with;
+// the collator is never changed, so a search can be reused by setting its
+// pattern. Searches are owned by one FixedPatternStringSearch or
+// RepeatingStringSearch at a time, which gives them back to the pool of the
+// thread it is destroyed on.
+class UStringSearchPool {
+ public:
+  UStringSearchPool() = default;
+  UStringSearchPool(const UStringSearchPool&) = delete;
+  UStringSearchPool& operator=(const UStringSearchPool&) = delete;
+
+  ~UStringSearchPool() {
+    for (const Entry& entry : entries_)
+      Close(entry.search);
+  }
+
+  static UStringSearchPool& GetForCurrentThread() {
+    static NoDestructor<ThreadLocalOwnedPointer<UStringSearchPool>> pools;
+    UStringSearchPool* pool = pools->Get();
+    if (!pool) {
+      pool = new UStringSearchPool();
+      pools->Set(WrapUnique(pool));
+    }
+    return *pool;
+  }
+
+  // Returns a search for |pattern| in |locale|, with a dummy text, or null if
+  // ICU can't search for |pattern| (e.g. if it is empty). |pattern| must
+  // outlive the search's use.
+  UStringSearch* Acquire(const std::u16string& pattern,
+                         const std::string& locale,
+                         bool case_sensitive) {
+    if (pattern.empty())
+      return nullptr;
+
+    UErrorCode status = U_ZERO_ERROR;
+    for (auto it = entries_.begin(); it != entries_.end(); ++it) {
+      if (it->case_sensitive != case_sensitive || it->locale != locale)
+        continue;
+      UStringSearch* search = it->search;
+      entries_.erase(it);
+      usearch_setPattern(search, pattern.data(), pattern.size(), &status);
+      // usearch_setText() resets the search, and drops the pointer to the
+      // text of its previous owner.
+      usearch_setText(search, pattern.data(), pattern.size(), &status);
+      if (U_SUCCESS(status))
+        return search;
+      Close(search);
+      return nullptr;
+    }
+
+    UCollator* collator = ucol_open(locale.c_str(), &status);
+    if (U_FAILURE(status))
+      return nullptr;
     // http://icu-project.org/apiref/icu4c40/ucol_8h.html#6a967f36248b0a1bc7654f538ee8ba96
     // Set comparison level to UCOL_PRIMARY to ignore secondary and tertiary
     // differences. Set comparison level to UCOL_TERTIARY to include all
@@ -35,15 +85,85 @@ FixedPatternStringSearch::FixedPatternStringSearch(
     // secondary difference.
     // Uppercase and lowercase versions of the same character represents a
     // tertiary difference.
-    UCollator* collator = usearch_getCollator(search_);
     ucol_setStrength(collator, case_sensitive ? UCOL_TERTIARY : UCOL_PRIMARY);
-    usearch_reset(search_);
+    // usearch_openFromCollator() requires a valid string argument to be
+    // searched, even if we want to set it by usearch_setText afterwards. So,
+    // supplying a dummy text.
+    UStringSearch* search = usearch_openFromCollator(
+        pattern.data(), pattern.size(), pattern.data(), pattern.size(),
+        collator,
+        nullptr,  // breakiter
+        &status);
+    if (U_FAILURE(status)) {
+      ucol_close(collator);
+      return nullptr;
+    }
+    return search;
   }
-}
+
+  // Takes back |search|, which was acquired with |locale| and
+  // |case_sensitive| on any thread.
+  void Release(UStringSearch* search,
+               const std::string& locale,
+               bool case_sensitive) {
+    // Only keep the searches of the current locale, and drop the oldest one
+    // past kMaxEntries.
+    const char* default_locale = uloc_getDefault();
+    if (locale != default_locale) {
+      Close(search);
+      return;
+    }
+    for (auto it = entries_.begin(); it != entries_.end();) {
+      if (it->locale != default_locale) {
+        Close(it->search);
+        it = entries_.erase(it);
+      } else {
+        ++it;
+      }
+    }
+    if (entries_.size() == kMaxEntries) {
+      Close(entries_.front().search);
+      entries_.erase(entries_.begin());
+    }
+    entries_.push_back({locale, case_sensitive, search});
+  }
+
+ private:
+  static constexpr size_t kMaxEntries = 4;
+
+  struct Entry {
+    std::string locale;
+    bool case_sensitive;
+    UStringSearch* search;
+  };
+
+  static void Close(UStringSearch* search) {
+    UCollator* collator = usearch_getCollator(search);
+    usearch_close(search);
+    ucol_close(collator);
+  }
+
+  std::vector<Entry> entries_;
+};
+
+}  // namespace
+
+FixedPatternStringSearch::FixedPatternStringSearch(
+    const std::u16string& find_this,
+    bool case_sensitive)
+    : find_this_(find_this),
+      locale_(uloc_getDefault()),
+      case_sensitive_(case_sensitive),
+      search_(UStringSearchPool::GetForCurrentThread().Acquire(
+          find_this_,
+          locale_,
+          case_sensitive)) {}
 
 FixedPatternStringSearch::~FixedPatternStringSearch() {
-  if (search_)
-    usearch_close(search_);
+  if (search_) {
+    UStringSearchPool::GetForCurrentThread().Release(search_.get(), locale_,
+                                                     case_sensitive_);
+  }
 }
 
 bool FixedPatternStringSearch::Search(const std::u16string& in_this,
@@ -51,11 +171,15 @@ bool FixedPatternStringSearch::Search(const std::u16string& in_this,
                                       size_t* match_length,
                                       bool forward_search) {
   UErrorCode status = U_ZERO_ERROR;
-  usearch_setText(search_, in_this.data(), in_this.size(), &status);
+  if (search_)
+    usearch_setText(search_, in_this.data(), in_this.size(), &status);
+  else
+    status = U_ILLEGAL_ARGUMENT_ERROR;
 
   // Default to basic substring search if usearch fails. According to
   // http://icu-project.org/apiref/icu4c/usearch_8h.html, usearch_open will fail
-  // if either |find_this| or |in_this| are empty. In either case basic
+  // if either |find_this| or |in_this| are empty, and |search_| is null in the
+  // first case. In either case basic
   // substring search will give the correct return value.
   if (!U_SUCCESS(status)) {
     size_t index = in_this.find(find_this_);
@@ -113,35 +237,39 @@ bool StringSearch(const std::u16string& find_this,
 RepeatingStringSearch::RepeatingStringSearch(const std::u16string& find_this,
                                              const std::u16string& in_this,
                                              bool case_sensitive)
-    : find_this_(find_this), in_this_(in_this) {
-  std::string locale = uloc_getDefault();
+    : find_this_(find_this),
+      in_this_(in_this),
+      locale_(uloc_getDefault()),
+      case_sensitive_(case_sensitive),
+      search_(UStringSearchPool::GetForCurrentThread().Acquire(
+          find_this_,
+          locale_,
+          case_sensitive)) {
   UErrorCode status = U_ZERO_ERROR;
-  search_ = usearch_open(find_this_.data(), find_this_.size(), in_this_.data(),
-                         in_this_.size(), locale.data(), /*breakiter=*/nullptr,
-                         &status);
+  if (search_)
+    usearch_setText(search_, in_this_.data(), in_this_.size(), &status);
+  else
+    status = U_ILLEGAL_ARGUMENT_ERROR;
   DCHECK(U_SUCCESS(status));
-  if (U_SUCCESS(status)) {
-    // http://icu-project.org/apiref/icu4c40/ucol_8h.html#6a967f36248b0a1bc7654f538ee8ba96
-    // Set comparison level to UCOL_PRIMARY to ignore secondary and tertiary
-    // differences. Set comparison level to UCOL_TERTIARY to include all
-    // comparison differences.
-    // Diacritical differences on the same base letter represent a
-    // secondary difference.
-    // Uppercase and lowercase versions of the same character represents a
-    // tertiary difference.
-    UCollator* collator = usearch_getCollator(search_);
-    ucol_setStrength(collator, case_sensitive ? UCOL_TERTIARY : UCOL_PRIMARY);
-    usearch_reset(search_);
+  if (U_FAILURE(status) && search_) {
+    // Don't search the dummy text.
+    UStringSearchPool::GetForCurrentThread().Release(search_.get(), locale_,
+                                                     case_sensitive_);
+    search_ = nullptr;
   }
 }
 
 RepeatingStringSearch::~RepeatingStringSearch() {
-  if (search_)
-    usearch_close(search_);
+  if (search_) {
+    UStringSearchPool::GetForCurrentThread().Release(search_.get(), locale_,
+                                                     case_sensitive_);
+  }
 }
 
 bool RepeatingStringSearch::NextMatchResult(int& match_index,
                                             int& match_length) {
+  if (!search_)
+    return false;
   UErrorCode status = U_ZERO_ERROR;
   const int match_start = usearch_next(search_, &status);
   if (U_FAILURE(status) || match_start == USEARCH_DONE)
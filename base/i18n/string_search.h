@@ -51,6 +51,11 @@ bool StringSearch(const std::u16string& find_this,
 // This class is for speeding up multiple StringSearch()
 // with the same |find_this| argument. |find_this| is passed as the constructor
 // argument, and precomputation for searching is done only at that time.
+//
+// The ICU searches and collators behind this class and RepeatingStringSearch
+// are pooled per thread: one is reused for the next search created on the
+// thread once it is destroyed, so only the first search of a thread opens a
+// collator for the current locale.
 class BASE_I18N_EXPORT FixedPatternStringSearch {
  public:
   explicit FixedPatternStringSearch(const std::u16string& find_this,
@@ -67,6 +72,8 @@ class BASE_I18N_EXPORT FixedPatternStringSearch {
 
  private:
   std::u16string find_this_;
+  const std::string locale_;
+  const bool case_sensitive_;
   raw_ptr<UStringSearch> search_;
 };
 
@@ -105,6 +112,8 @@ class BASE_I18N_EXPORT RepeatingStringSearch {
  private:
   std::u16string find_this_;
   std::u16string in_this_;
+  const std::string locale_;
+  const bool case_sensitive_;
   raw_ptr<UStringSearch> search_;
 };
 
@@ -392,5 +392,50 @@ TEST(StringSearchTest, RepeatingStringSearch) {
     SetICUDefaultLocale(default_locale.data());
 }
 
+// Searches reuse the ICU searches of the searches destroyed before them on the
+// same thread. Check that a reused search doesn't keep the pattern, strength
+// or locale it was opened with.
+TEST(StringSearchTest, ReusesSearches) {
+  std::string default_locale(uloc_getDefault());
+  SetICUDefaultLocale("en_US");
+
+  for (int i = 0; i < 3; ++i) {
+    EXPECT_MATCH_SENSITIVE(u"foo", u"a foo", 2U, 3U);
+    EXPECT_MISS_SENSITIVE(u"foo", u"a FOO");
+    EXPECT_MATCH_IGNORE_CASE(u"bar", u"a BAR", 2U, 3U);
+    EXPECT_MISS_IGNORE_CASE(u"foo", u"a BAR");
+  }
+
+  // Nested searches can't share an ICU search.
+  {
+    FixedPatternStringSearch outer(u"foo", /*case_sensitive=*/false);
+    {
+      FixedPatternStringSearch inner(u"bar", /*case_sensitive=*/false);
+      EXPECT_TRUE(inner.Search(u"BAR", nullptr, nullptr, true));
+    }
+    FixedPatternStringSearch next(u"baz", /*case_sensitive=*/false);
+    EXPECT_TRUE(outer.Search(u"FOO", nullptr, nullptr, true));
+    EXPECT_FALSE(outer.Search(u"BAR", nullptr, nullptr, true));
+    EXPECT_TRUE(next.Search(u"BAZ", nullptr, nullptr, true));
+  }
+
+  // The searches kept for en_US aren't reused in Danish, where "a" and "\u00e5"
+  // are different base letters.
+  EXPECT_TRUE(StringSearchIgnoringCaseAndAccents(u"a", u"\u00e5", nullptr,
+                                                 nullptr));
+  SetICUDefaultLocale("da");
+  EXPECT_FALSE(StringSearchIgnoringCaseAndAccents(u"a", u"\u00e5", nullptr,
+                                                  nullptr));
+
+  // An empty pattern matches without ICU.
+  size_t index = 1;
+  size_t length = 1;
+  EXPECT_TRUE(StringSearch(u"", u"abc", &index, &length, false, true));
+  EXPECT_EQ(0U, index);
+  EXPECT_EQ(0U, length);
+
+  SetICUDefaultLocale(default_locale.data());
+}
+
 }  // namespace i18n
 }  // namespace base
@@ -0,0 +1,303 @@
+// Copyright 2022 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "base/json/json_document.h"
+
+#include <string.h>
+
+#include <functional>
+#include <utility>
+
+#include "base/check_op.h"
+#include "base/json/json_parser.h"
+#include "base/memory/ptr_util.h"
+#include "base/notreached.h"
+
+namespace base {
+
+// Appends the values reported by the parser to the nodes of a document, in
+// the order of the input.
+class JSONDocument::Builder : public JSONStreamingHandler {
+ public:
+  explicit Builder(JSONDocument* document) : document_(document) {}
+
+  Builder(const Builder&) = delete;
+  Builder& operator=(const Builder&) = delete;
+
+  ~Builder() override = default;
+
+  bool OnStartDict() override {
+    open_containers_.push_back(AddNode(Value::Type::DICTIONARY));
+    return true;
+  }
+
+  bool OnKey(StringPiece key) override {
+    key_ = document_->Borrow(key);
+    return true;
+  }
+
+  bool OnEndDict() override {
+    CloseContainer();
+    return true;
+  }
+
+  bool OnStartList() override {
+    open_containers_.push_back(AddNode(Value::Type::LIST));
+    return true;
+  }
+
+  bool OnEndList() override {
+    CloseContainer();
+    return true;
+  }
+
+  bool OnString(StringPiece value) override {
+    document_->nodes_[AddNode(Value::Type::STRING)].string_value =
+        document_->Borrow(value);
+    return true;
+  }
+
+  bool OnInt(int value) override {
+    document_->nodes_[AddNode(Value::Type::INTEGER)].int_value = value;
+    return true;
+  }
+
+  bool OnDouble(double value) override {
+    document_->nodes_[AddNode(Value::Type::DOUBLE)].double_value = value;
+    return true;
+  }
+
+  bool OnBool(bool value) override {
+    document_->nodes_[AddNode(Value::Type::BOOLEAN)].bool_value = value;
+    return true;
+  }
+
+  bool OnNull() override {
+    AddNode(Value::Type::NONE);
+    return true;
+  }
+
+ private:
+  // Appends a node of |type|, with the pending key, and returns its index.
+  size_t AddNode(Value::Type type) {
+    auto& nodes = document_->nodes_;
+    if (!open_containers_.empty())
+      nodes[open_containers_.back()].size++;
+    const size_t index = nodes.size();
+    Node& node = nodes.emplace_back();
+    node.type = type;
+    node.key = std::exchange(key_, StringPiece());
+    node.size = 0;
+    node.end = index + 1;
+    return index;
+  }
+
+  void CloseContainer() {
+    DCHECK(!open_containers_.empty());
+    auto& nodes = document_->nodes_;
+    nodes[open_containers_.back()].end = nodes.size();
+    open_containers_.pop_back();
+  }
+
+  JSONDocument* const document_;
+  // The indices of the dictionaries and lists being parsed.
+  std::vector<size_t> open_containers_;
+  // The key of the next value, if it's an item of a dictionary.
+  StringPiece key_;
+};
+
+StringPiece JSONValueView::Iterator::key() const {
+  return document_->nodes_[node_].key;
+}
+
+JSONValueView::Iterator& JSONValueView::Iterator::operator++() {
+  node_ = document_->nodes_[node_].end;
+  return *this;
+}
+
+Value::Type JSONValueView::type() const {
+  return document_->nodes_[node_].type;
+}
+
+absl::optional<bool> JSONValueView::GetIfBool() const {
+  if (!is_bool())
+    return absl::nullopt;
+  return document_->nodes_[node_].bool_value;
+}
+
+absl::optional<int> JSONValueView::GetIfInt() const {
+  if (!is_int())
+    return absl::nullopt;
+  return document_->nodes_[node_].int_value;
+}
+
+absl::optional<double> JSONValueView::GetIfDouble() const {
+  if (is_int())
+    return document_->nodes_[node_].int_value;
+  if (!is_double())
+    return absl::nullopt;
+  return document_->nodes_[node_].double_value;
+}
+
+absl::optional<StringPiece> JSONValueView::GetIfString() const {
+  if (!is_string())
+    return absl::nullopt;
+  return document_->nodes_[node_].string_value;
+}
+
+size_t JSONValueView::size() const {
+  if (!is_dict() && !is_list())
+    return 0;
+  return document_->nodes_[node_].size;
+}
+
+JSONValueView::Iterator JSONValueView::begin() const {
+  if (!is_dict() && !is_list())
+    return end();
+  return Iterator(document_, node_ + 1);
+}
+
+JSONValueView::Iterator JSONValueView::end() const {
+  return Iterator(document_, document_->nodes_[node_].end);
+}
+
+absl::optional<JSONValueView> JSONValueView::FindKey(StringPiece key) const {
+  if (!is_dict())
+    return absl::nullopt;
+  absl::optional<JSONValueView> result;
+  for (Iterator it = begin(); it != end(); ++it) {
+    if (it.key() == key)
+      result = *it;
+  }
+  return result;
+}
+
+absl::optional<JSONValueView> JSONValueView::FindPath(StringPiece path) const {
+  absl::optional<JSONValueView> current = *this;
+  while (current) {
+    const size_t separator = path.find('.');
+    if (separator == StringPiece::npos)
+      return current->FindKey(path);
+    current = current->FindKey(path.substr(0, separator));
+    path = path.substr(separator + 1);
+  }
+  return absl::nullopt;
+}
+
+absl::optional<JSONValueView> JSONValueView::GetListItem(size_t index) const {
+  if (!is_list() || index >= size())
+    return absl::nullopt;
+  Iterator it = begin();
+  while (index--)
+    ++it;
+  return *it;
+}
+
+Value JSONValueView::ToValue() const {
+  const JSONDocument::Node& node = document_->nodes_[node_];
+  switch (node.type) {
+    case Value::Type::NONE:
+      return Value();
+    case Value::Type::BOOLEAN:
+      return Value(node.bool_value);
+    case Value::Type::INTEGER:
+      return Value(node.int_value);
+    case Value::Type::DOUBLE:
+      return Value(node.double_value);
+    case Value::Type::STRING:
+      return Value(node.string_value);
+    case Value::Type::DICTIONARY: {
+      Value::Dict dict;
+      // Set() replaces the value of a duplicate key, keeping the last one.
+      for (Iterator it = begin(); it != end(); ++it)
+        dict.Set(it.key(), (*it).ToValue());
+      return Value(std::move(dict));
+    }
+    case Value::Type::LIST: {
+      Value::List list;
+      for (Iterator it = begin(); it != end(); ++it)
+        list.Append((*it).ToValue());
+      return Value(std::move(list));
+    }
+    case Value::Type::BINARY:
+      break;
+  }
+  NOTREACHED();
+  return Value();
+}
+
+// static
+std::unique_ptr<JSONDocument> JSONDocument::Parse(StringPiece json,
+                                                  int options,
+                                                  std::string* error_message) {
+  return Build(WrapUnique(new JSONDocument(json, nullptr, nullptr)), options,
+               error_message);
+}
+
+// static
+std::unique_ptr<JSONDocument> JSONDocument::Parse(
+    scoped_refptr<RefCountedMemory> json,
+    int options,
+    std::string* error_message) {
+  DCHECK(json);
+  const StringPiece input(json->front_as<char>(), json->size());
+  return Build(WrapUnique(new JSONDocument(input, std::move(json), nullptr)),
+               options, error_message);
+}
+
+// static
+std::unique_ptr<JSONDocument> JSONDocument::ParseInArena(
+    StringPiece json,
+    Arena* arena,
+    int options,
+    std::string* error_message) {
+  DCHECK(arena);
+  return Build(WrapUnique(new JSONDocument(json, nullptr, arena)), options,
+               error_message);
+}
+
+// static
+std::unique_ptr<JSONDocument> JSONDocument::Build(
+    std::unique_ptr<JSONDocument> document,
+    int options,
+    std::string* error_message) {
+  internal::JSONParser parser(options);
+  Builder builder(document.get());
+  if (!parser.ParseStreaming(document->input_, &builder)) {
+    if (error_message)
+      *error_message = parser.GetErrorMessage();
+    return nullptr;
+  }
+  return document;
+}
+
+JSONDocument::JSONDocument(StringPiece input,
+                           scoped_refptr<RefCountedMemory> owner,
+                           Arena* arena)
+    : input_(input),
+      owner_(std::move(owner)),
+      arena_(arena),
+      nodes_(NodeAllocator<Node>(arena)) {}
+
+JSONDocument::~JSONDocument() = default;
+
+StringPiece JSONDocument::Borrow(StringPiece string) {
+  // std::less gives a total order of the pointers, even if |string| is not
+  // in |input_|.
+  std::less<const char*> less;
+  if (!less(string.data(), input_.data()) &&
+      !less(input_.data() + input_.size(), string.data() + string.size())) {
+    return string;
+  }
+  decoded_string_count_++;
+  if (arena_) {
+    char* copy = static_cast<char*>(arena_->Allocate(string.size(), 1));
+    memcpy(copy, string.data(), string.size());
+    return StringPiece(copy, string.size());
+  }
+  decoded_strings_.push_back(std::make_unique<std::string>(string));
+  return *decoded_strings_.back();
+}
+
+}  // namespace base
@@ -0,0 +1,248 @@
+// Copyright 2022 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#ifndef BASE_JSON_JSON_DOCUMENT_H_
+#define BASE_JSON_JSON_DOCUMENT_H_
+
+#include <stddef.h>
+
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "base/base_export.h"
+#include "base/json/json_reader.h"
+#include "base/memory/arena.h"
+#include "base/memory/ref_counted_memory.h"
+#include "base/memory/scoped_refptr.h"
+#include "base/strings/string_piece.h"
+#include "base/values.h"
+#include "third_party/abseil-cpp/absl/types/optional.h"
+
+namespace base {
+
+class JSONDocument;
+
+// A read-only view of a value of a JSONDocument, valid as long as the
+// document. Its strings and keys are StringPieces, into the input of the
+// document if they needed no decoding. Like Value, the lookups of a key
+// return its last value if the key is duplicated.
+class BASE_EXPORT JSONValueView {
+ public:
+  class BASE_EXPORT Iterator {
+   public:
+    Iterator(const Iterator&) = default;
+    Iterator& operator=(const Iterator&) = default;
+
+    // The key of the current value, if the view is a dictionary.
+    StringPiece key() const;
+    JSONValueView operator*() const { return JSONValueView(document_, node_); }
+    Iterator& operator++();
+
+    bool operator==(const Iterator& other) const {
+      return node_ == other.node_;
+    }
+    bool operator!=(const Iterator& other) const { return !(*this == other); }
+
+   private:
+    friend class JSONValueView;
+
+    Iterator(const JSONDocument* document, size_t node)
+        : document_(document), node_(node) {}
+
+    const JSONDocument* document_;
+    size_t node_;
+  };
+
+  JSONValueView(const JSONValueView&) = default;
+  JSONValueView& operator=(const JSONValueView&) = default;
+
+  Value::Type type() const;
+  bool is_none() const { return type() == Value::Type::NONE; }
+  bool is_bool() const { return type() == Value::Type::BOOLEAN; }
+  bool is_int() const { return type() == Value::Type::INTEGER; }
+  bool is_double() const { return type() == Value::Type::DOUBLE; }
+  bool is_string() const { return type() == Value::Type::STRING; }
+  bool is_dict() const { return type() == Value::Type::DICTIONARY; }
+  bool is_list() const { return type() == Value::Type::LIST; }
+
+  // As in Value, GetIfDouble() also converts ints.
+  absl::optional<bool> GetIfBool() const;
+  absl::optional<int> GetIfInt() const;
+  absl::optional<double> GetIfDouble() const;
+  absl::optional<StringPiece> GetIfString() const;
+
+  // The number of items of a dictionary or a list, 0 otherwise.
+  size_t size() const;
+
+  // Iterates over the items of a dictionary or a list, in the order of the
+  // input, including the duplicate keys of a dictionary.
+  Iterator begin() const;
+  Iterator end() const;
+
+  // Returns the value of |key| if this is a dictionary. The lookup is a
+  // linear search: it's meant for the reading of a few keys, not as an index.
+  absl::optional<JSONValueView> FindKey(StringPiece key) const;
+
+  // Returns the value at the dotted |path| of keys, as Value::FindPath().
+  absl::optional<JSONValueView> FindPath(StringPiece path) const;
+
+  // Returns the item at |index| if this is a list.
+  absl::optional<JSONValueView> GetListItem(size_t index) const;
+
+  // Returns a Value copy of the view.
+  Value ToValue() const;
+
+ private:
+  friend class JSONDocument;
+
+  JSONValueView(const JSONDocument* document, size_t node)
+      : document_(document), node_(node) {}
+
+  const JSONDocument* document_;
+  // The index of the value in the nodes of |document_|.
+  size_t node_;
+};
+
+// A parsed JSON document which, unlike the Value returned by JSONReader,
+// doesn't copy the strings of its input: it holds StringPieces into it, and
+// only owns the strings which had to be decoded, e.g. for their escapes. The
+// values are read with JSONValueViews, so that reading a large document
+// allocates nothing per string.
+//
+// The values are stored in a single array, in the order of the input, each
+// container followed by its items.
+//
+// For parse-and-discard workloads, ParseInArena() allocates the array and the
+// decoded strings from an Arena, so that a document is freed at once with the
+// other objects of a request. Views can be copied out of the arena with
+// JSONValueView::ToValue().
+class BASE_EXPORT JSONDocument {
+ public:
+  // Parses |json|, which must outlive the document. Returns nullptr and sets
+  // |error_message|, if non-null, on error.
+  static std::unique_ptr<JSONDocument> Parse(
+      StringPiece json,
+      int options = JSON_PARSE_CHROMIUM_EXTENSIONS,
+      std::string* error_message = nullptr);
+
+  // Parses |json| as above, and keeps a reference to it.
+  static std::unique_ptr<JSONDocument> Parse(
+      scoped_refptr<RefCountedMemory> json,
+      int options = JSON_PARSE_CHROMIUM_EXTENSIONS,
+      std::string* error_message = nullptr);
+
+  // Parses |json| as Parse(StringPiece) does, but allocates the nodes and the
+  // decoded strings from |arena|. As for the containers with an
+  // ArenaAllocator, the document must be destroyed before |arena| is reset.
+  static std::unique_ptr<JSONDocument> ParseInArena(
+      StringPiece json,
+      Arena* arena,
+      int options = JSON_PARSE_CHROMIUM_EXTENSIONS,
+      std::string* error_message = nullptr);
+
+  JSONDocument(const JSONDocument&) = delete;
+  JSONDocument& operator=(const JSONDocument&) = delete;
+
+  ~JSONDocument();
+
+  JSONValueView root() const { return JSONValueView(this, 0); }
+
+  // The number of strings which needed decoding, and are owned by the
+  // document.
+  size_t decoded_string_count_for_testing() const {
+    return decoded_string_count_;
+  }
+
+ private:
+  friend class JSONValueView;
+
+  // The JSONStreamingHandler which fills |nodes_|, in the .cc file.
+  class Builder;
+
+  struct Node {
+    Value::Type type = Value::Type::NONE;
+    // The key of the node, if it's an item of a dictionary.
+    StringPiece key;
+    // The value of a string.
+    StringPiece string_value;
+    union {
+      bool bool_value;
+      int int_value;
+      double double_value;
+      // The number of items of a dictionary or a list.
+      size_t size;
+    };
+    // The index of the node following this one and its items.
+    size_t end = 0;
+  };
+
+  // Allocates from the arena of the document, if any, and from the heap
+  // otherwise.
+  template <typename T>
+  class NodeAllocator {
+   public:
+    using value_type = T;
+
+    explicit NodeAllocator(Arena* arena) : arena_(arena) {}
+    template <typename U>
+    NodeAllocator(const NodeAllocator<U>& other)  // NOLINT
+        : arena_(other.arena()) {}
+
+    T* allocate(size_t n) {
+      return arena_ ? ArenaAllocator<T>(arena_).allocate(n)
+                    : std::allocator<T>().allocate(n);
+    }
+    void deallocate(T* ptr, size_t n) {
+      if (arena_)
+        ArenaAllocator<T>(arena_).deallocate(ptr, n);
+      else
+        std::allocator<T>().deallocate(ptr, n);
+    }
+
+    Arena* arena() const { return arena_; }
+
+    template <typename U>
+    bool operator==(const NodeAllocator<U>& other) const {
+      return arena_ == other.arena();
+    }
+    template <typename U>
+    bool operator!=(const NodeAllocator<U>& other) const {
+      return arena_ != other.arena();
+    }
+
+   private:
+    Arena* arena_;
+  };
+
+  JSONDocument(StringPiece input,
+               scoped_refptr<RefCountedMemory> owner,
+               Arena* arena);
+
+  // Parses the input of |document| into its nodes.
+  static std::unique_ptr<JSONDocument> Build(
+      std::unique_ptr<JSONDocument> document,
+      int options,
+      std::string* error_message);
+
+  // Returns |string|, if it's in |input_|, or a copy owned by the document, or
+  // allocated from its arena, otherwise.
+  StringPiece Borrow(StringPiece string);
+
+  const StringPiece input_;
+  // Keeps |input_| alive, if the document owns a reference to it.
+  const scoped_refptr<RefCountedMemory> owner_;
+  // The arena which the nodes and the decoded strings are allocated from, if
+  // any.
+  Arena* const arena_;
+  std::vector<Node, NodeAllocator<Node>> nodes_;
+  // The strings aren't stored by value, so that their StringPieces stay
+  // valid as the vector grows. Unused with an arena.
+  std::vector<std::unique_ptr<std::string>> decoded_strings_;
+  size_t decoded_string_count_ = 0;
+};
+
+}  // namespace base
+
+#endif  // BASE_JSON_JSON_DOCUMENT_H_
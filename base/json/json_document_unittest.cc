@@ -0,0 +1,167 @@
+// Copyright 2022 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "base/json/json_document.h"
+
+#include <string>
+#include <vector>
+
+#include "base/json/json_reader.h"
+#include "base/memory/arena.h"
+#include "base/memory/ref_counted_memory.h"
+#include "base/strings/string_piece.h"
+#include "base/values.h"
+#include "testing/gtest/include/gtest/gtest.h"
+#include "third_party/abseil-cpp/absl/types/optional.h"
+
+namespace base {
+
+namespace {
+
+// Returns whether |string| points into |input|.
+bool IsInInput(StringPiece string, StringPiece input) {
+  return string.data() >= input.data() &&
+         string.data() + string.size() <= input.data() + input.size();
+}
+
+}  // namespace
+
+TEST(JSONDocumentTest, Values) {
+  const StringPiece json =
+      R"({"bool": true, "int": 42, "double": 4.5, "null": null,)"
+      R"( "string": "foo", "list": [1, "two", [3]], "dict": {"a": {"b": 7}}})";
+  std::unique_ptr<JSONDocument> document = JSONDocument::Parse(json);
+  ASSERT_TRUE(document);
+  JSONValueView root = document->root();
+  ASSERT_TRUE(root.is_dict());
+  EXPECT_EQ(7u, root.size());
+
+  EXPECT_EQ(true, root.FindKey("bool")->GetIfBool());
+  EXPECT_EQ(42, root.FindKey("int")->GetIfInt());
+  EXPECT_EQ(42.0, root.FindKey("int")->GetIfDouble());
+  EXPECT_EQ(4.5, root.FindKey("double")->GetIfDouble());
+  EXPECT_FALSE(root.FindKey("double")->GetIfInt());
+  EXPECT_TRUE(root.FindKey("null")->is_none());
+  EXPECT_EQ("foo", root.FindKey("string")->GetIfString());
+  EXPECT_FALSE(root.FindKey("missing"));
+  EXPECT_FALSE(root.FindKey("string")->FindKey("foo"));
+
+  absl::optional<JSONValueView> list = root.FindKey("list");
+  ASSERT_TRUE(list && list->is_list());
+  EXPECT_EQ(3u, list->size());
+  EXPECT_EQ(1, list->GetListItem(0)->GetIfInt());
+  EXPECT_EQ("two", list->GetListItem(1)->GetIfString());
+  EXPECT_EQ(3, list->GetListItem(2)->GetListItem(0)->GetIfInt());
+  EXPECT_FALSE(list->GetListItem(3));
+
+  EXPECT_EQ(7, root.FindPath("dict.a.b")->GetIfInt());
+  EXPECT_FALSE(root.FindPath("dict.a.c"));
+  EXPECT_FALSE(root.FindPath("dict.b.a"));
+
+  std::vector<std::string> keys;
+  for (JSONValueView::Iterator it = root.begin(); it != root.end(); ++it)
+    keys.emplace_back(it.key());
+  EXPECT_EQ((std::vector<std::string>{"bool", "int", "double", "null",
+                                      "string", "list", "dict"}),
+            keys);
+
+  EXPECT_EQ(JSONReader::Read(json), root.ToValue());
+}
+
+TEST(JSONDocumentTest, BorrowsStrings) {
+  const StringPiece json =
+      R"({"plain": "value", "escaped\n": "a\"b", "list": ["x", "é"]})";
+  std::unique_ptr<JSONDocument> document = JSONDocument::Parse(json);
+  ASSERT_TRUE(document);
+  JSONValueView root = document->root();
+
+  // Only the escaped key and string, and the non-ASCII string, which the
+  // parser decodes, are copied.
+  EXPECT_EQ(3u, document->decoded_string_count_for_testing());
+  EXPECT_TRUE(IsInInput(*root.FindKey("plain")->GetIfString(), json));
+  EXPECT_TRUE(IsInInput(root.begin().key(), json));
+  StringPiece escaped = *root.FindKey("escaped\n")->GetIfString();
+  EXPECT_EQ("a\"b", escaped);
+  EXPECT_FALSE(IsInInput(escaped, json));
+  absl::optional<JSONValueView> list = root.FindKey("list");
+  EXPECT_TRUE(IsInInput(*list->GetListItem(0)->GetIfString(), json));
+  EXPECT_EQ("\xc3\xa9", list->GetListItem(1)->GetIfString());
+}
+
+TEST(JSONDocumentTest, DuplicateKeys) {
+  const StringPiece json = R"({"a": 1, "b": 2, "a": 3})";
+  std::unique_ptr<JSONDocument> document = JSONDocument::Parse(json);
+  ASSERT_TRUE(document);
+  JSONValueView root = document->root();
+  // As in Value, the last value of a key is found.
+  EXPECT_EQ(3, root.FindKey("a")->GetIfInt());
+  EXPECT_EQ(3u, root.size());
+  EXPECT_EQ(JSONReader::Read(json), root.ToValue());
+}
+
+TEST(JSONDocumentTest, Scalars) {
+  std::unique_ptr<JSONDocument> document = JSONDocument::Parse("\"foo\"");
+  ASSERT_TRUE(document);
+  EXPECT_EQ("foo", document->root().GetIfString());
+  EXPECT_EQ(0u, document->root().size());
+  EXPECT_TRUE(document->root().begin() == document->root().end());
+
+  document = JSONDocument::Parse("[]");
+  ASSERT_TRUE(document);
+  EXPECT_EQ(0u, document->root().size());
+  EXPECT_TRUE(document->root().begin() == document->root().end());
+}
+
+TEST(JSONDocumentTest, RefCountedInput) {
+  std::string json = R"({"key": "value"})";
+  std::unique_ptr<JSONDocument> document =
+      JSONDocument::Parse(RefCountedString::TakeString(&json));
+  ASSERT_TRUE(document);
+  // The document keeps the input alive.
+  EXPECT_EQ("value", document->root().FindKey("key")->GetIfString());
+  EXPECT_EQ(0u, document->decoded_string_count_for_testing());
+}
+
+TEST(JSONDocumentTest, Arena) {
+  const StringPiece json =
+      R"({"plain": "value", "escaped\n": "a\"b", "list": [1, 2.5, null]})";
+  Arena arena;
+  std::unique_ptr<JSONDocument> document =
+      JSONDocument::ParseInArena(json, &arena);
+  ASSERT_TRUE(document);
+  EXPECT_GT(arena.reserved_bytes(), 0u);
+  JSONValueView root = document->root();
+  EXPECT_TRUE(IsInInput(*root.FindKey("plain")->GetIfString(), json));
+  EXPECT_EQ(2u, document->decoded_string_count_for_testing());
+  EXPECT_EQ("a\"b", root.FindKey("escaped\n")->GetIfString());
+  EXPECT_EQ(2.5, root.FindPath("list")->GetListItem(1)->GetIfDouble());
+
+  // The Value copy outlives the arena.
+  Value value = root.ToValue();
+  document.reset();
+  arena.Reset();
+  EXPECT_EQ(JSONReader::Read(json), value);
+
+  // The arena is reused.
+  document = JSONDocument::ParseInArena("[1, 2", &arena);
+  EXPECT_FALSE(document);
+  document = JSONDocument::ParseInArena(json, &arena);
+  ASSERT_TRUE(document);
+  EXPECT_EQ(value, document->root().ToValue());
+}
+
+TEST(JSONDocumentTest, Errors) {
+  std::string error_message;
+  EXPECT_FALSE(JSONDocument::Parse("[1, 2", JSON_PARSE_RFC, &error_message));
+  EXPECT_FALSE(error_message.empty());
+  EXPECT_EQ(
+      JSONReader::ReadAndReturnValueWithError("[1, 2", JSON_PARSE_RFC)
+          .error_message,
+      error_message);
+
+  EXPECT_FALSE(JSONDocument::Parse("[1, 2,]", JSON_PARSE_RFC));
+  EXPECT_TRUE(JSONDocument::Parse("[1, 2,]", JSON_ALLOW_TRAILING_COMMAS));
+}
+
+}  // namespace base
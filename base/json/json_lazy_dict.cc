@@ -0,0 +1,379 @@
+// Copyright 2022 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "base/json/json_lazy_dict.h"
+
+#include <algorithm>
+#include <utility>
+
+#include "base/containers/cxx20_erase_vector.h"
+#include "base/json/json_common.h"
+#include "base/json/json_writer.h"
+#include "base/json/string_escape.h"
+#include "base/memory/ptr_util.h"
+#include "base/ranges/algorithm.h"
+
+namespace base {
+
+namespace {
+
+constexpr char kInvalidDict[] = "Expected a dictionary.";
+
+// Finds the extent of the values of a JSON input, without parsing them. Only
+// the nesting of the dictionaries and lists, and the ends of the strings and
+// comments, are checked.
+class Scanner {
+ public:
+  Scanner(StringPiece input, int options) : input_(input), options_(options) {}
+
+  Scanner(const Scanner&) = delete;
+  Scanner& operator=(const Scanner&) = delete;
+
+  bool at_end() const { return position_ == input_.size(); }
+  char current() const { return input_[position_]; }
+
+  void SkipBOM() {
+    constexpr StringPiece kBOM = "\xEF\xBB\xBF";
+    if (input_.substr(0, kBOM.size()) == kBOM)
+      position_ = kBOM.size();
+  }
+
+  // Skips the whitespace and the comments, if they're allowed. Returns false
+  // if a comment isn't terminated.
+  bool SkipWhitespace() {
+    while (!at_end()) {
+      switch (current()) {
+        case ' ':
+        case '\t':
+        case '\r':
+        case '\n':
+          position_++;
+          break;
+        case '/':
+          if (!SkipComment())
+            return false;
+          break;
+        default:
+          return true;
+      }
+    }
+    return true;
+  }
+
+  // Consumes |c|, if it's the current character.
+  bool ConsumeIf(char c) {
+    if (at_end() || current() != c)
+      return false;
+    position_++;
+    return true;
+  }
+
+  // Returns the text of the string at the current position, with its quotes.
+  absl::optional<StringPiece> ScanString() {
+    const size_t start = position_;
+    if (!ConsumeIf('"'))
+      return absl::nullopt;
+    while (true) {
+      position_ = input_.find_first_of("\"\\", position_);
+      if (position_ == StringPiece::npos) {
+        position_ = input_.size();
+        return absl::nullopt;
+      }
+      if (current() == '"')
+        break;
+      // Skips the escaped character, which may be a quote.
+      position_ += 2;
+      if (position_ > input_.size()) {
+        position_ = input_.size();
+        return absl::nullopt;
+      }
+    }
+    position_++;
+    return input_.substr(start, position_ - start);
+  }
+
+  // Returns the text of the value at the current position.
+  absl::optional<StringPiece> ScanValue() {
+    if (at_end())
+      return absl::nullopt;
+    const size_t start = position_;
+    switch (current()) {
+      case '"':
+        return ScanString();
+      case '{':
+      case '[':
+        if (!SkipContainer())
+          return absl::nullopt;
+        break;
+      default:
+        // A number or a literal, which ends at a delimiter.
+        position_ = std::min(input_.find_first_of(",:{}[]\" \t\r\n/", start),
+                             input_.size());
+        if (position_ == start)
+          return absl::nullopt;
+        break;
+    }
+    return input_.substr(start, position_ - start);
+  }
+
+ private:
+  // Skips the comment at the current position, if comments are allowed.
+  bool SkipComment() {
+    if (!(options_ & JSON_ALLOW_COMMENTS) || position_ + 1 >= input_.size())
+      return false;
+    size_t end;
+    if (input_[position_ + 1] == '/') {
+      end = input_.find('\n', position_ + 2);
+      position_ = end == StringPiece::npos ? input_.size() : end + 1;
+      return true;
+    }
+    if (input_[position_ + 1] != '*')
+      return false;
+    end = input_.find("*/", position_ + 2);
+    if (end == StringPiece::npos)
+      return false;
+    position_ = end + 2;
+    return true;
+  }
+
+  // Skips the dictionary or the list at the current position, and all of its
+  // items, checking that the brackets match.
+  bool SkipContainer() {
+    std::vector<char> closing_brackets;
+    do {
+      if (at_end())
+        return false;
+      switch (current()) {
+        case '{':
+          closing_brackets.push_back('}');
+          position_++;
+          break;
+        case '[':
+          closing_brackets.push_back(']');
+          position_++;
+          break;
+        case '}':
+        case ']':
+          if (current() != closing_brackets.back())
+            return false;
+          closing_brackets.pop_back();
+          position_++;
+          break;
+        case '"':
+          if (!ScanString())
+            return false;
+          break;
+        case '/':
+          if (!SkipComment())
+            return false;
+          break;
+        default:
+          position_++;
+          break;
+      }
+      if (closing_brackets.size() > internal::kAbsoluteMaxDepth)
+        return false;
+    } while (!closing_brackets.empty());
+    return true;
+  }
+
+  const StringPiece input_;
+  const int options_;
+  size_t position_ = 0;
+};
+
+// Returns whether the quoted |raw_key| is its own decoding.
+bool NeedsNoDecoding(StringPiece raw_key) {
+  return ranges::all_of(raw_key.substr(1, raw_key.size() - 2), [](char c) {
+    return c >= 0x20 && c < 0x7f && c != '\\';
+  });
+}
+
+}  // namespace
+
+JSONLazyDict::Field::Field() = default;
+JSONLazyDict::Field::Field(Field&&) = default;
+JSONLazyDict::Field& JSONLazyDict::Field::operator=(Field&&) = default;
+JSONLazyDict::Field::~Field() = default;
+
+// static
+std::unique_ptr<JSONLazyDict> JSONLazyDict::Parse(StringPiece json,
+                                                  int options,
+                                                  std::string* error_message) {
+  auto dict = WrapUnique(new JSONLazyDict(options));
+  if (!dict->Index(json)) {
+    if (error_message) {
+      // The values which were skipped are not well-formed either, so the
+      // parser reports the error, as for a Value.
+      auto result = JSONReader::ReadAndReturnValueWithError(json, options);
+      *error_message =
+          result.value ? std::string(kInvalidDict) : result.error_message;
+    }
+    return nullptr;
+  }
+  return dict;
+}
+
+JSONLazyDict::JSONLazyDict(int options) : options_(options) {}
+
+JSONLazyDict::~JSONLazyDict() = default;
+
+bool JSONLazyDict::contains(StringPiece key) const {
+  return FindField(key) != nullptr;
+}
+
+const Value* JSONLazyDict::Find(StringPiece key) {
+  Field* field = FindField(key);
+  return field ? GetValue(field) : nullptr;
+}
+
+Value* JSONLazyDict::FindMutable(StringPiece key) {
+  Field* field = FindField(key);
+  Value* value = field ? GetValue(field) : nullptr;
+  if (value)
+    field->modified = true;
+  return value;
+}
+
+absl::optional<StringPiece> JSONLazyDict::FindRaw(StringPiece key) const {
+  const Field* field = FindField(key);
+  if (!field || field->modified)
+    return absl::nullopt;
+  return field->raw_value;
+}
+
+void JSONLazyDict::Set(StringPiece key, Value value) {
+  Field* field = FindField(key);
+  if (!field) {
+    Field& new_field = fields_.emplace_back();
+    new_field.key = std::string(key);
+    new_field.value = std::move(value);
+    new_field.modified = true;
+    return;
+  }
+  field->value = std::move(value);
+  field->modified = true;
+  // Erases the previous duplicates of |key|.
+  for (size_t i = static_cast<size_t>(field - fields_.data()); i-- > 0;) {
+    if (fields_[i].key == key)
+      fields_.erase(fields_.begin() + i);
+  }
+}
+
+bool JSONLazyDict::Remove(StringPiece key) {
+  return EraseIf(fields_, [key](const Field& field) {
+           return field.key == key;
+         }) > 0;
+}
+
+bool JSONLazyDict::Write(std::string* json) const {
+  json->clear();
+  json->push_back('{');
+  std::string value_json;
+  for (const Field& field : fields_) {
+    if (json->size() > 1)
+      json->push_back(',');
+    if (field.raw_key.empty())
+      EscapeJSONString(field.key, /*put_in_quotes=*/true, json);
+    else
+      json->append(field.raw_key.data(), field.raw_key.size());
+    json->push_back(':');
+    if (!field.modified) {
+      json->append(field.raw_value.data(), field.raw_value.size());
+      continue;
+    }
+    // The fields are at depth 1.
+    if (!JSONWriter::Write(*field.value, &value_json,
+                           internal::kAbsoluteMaxDepth - 1)) {
+      return false;
+    }
+    json->append(value_json);
+  }
+  json->push_back('}');
+  return true;
+}
+
+absl::optional<Value::Dict> JSONLazyDict::ToDict() {
+  Value::Dict dict;
+  for (Field& field : fields_) {
+    Value* value = GetValue(&field);
+    if (!value)
+      return absl::nullopt;
+    dict.Set(field.key, value->Clone());
+  }
+  return dict;
+}
+
+bool JSONLazyDict::Index(StringPiece json) {
+  Scanner scanner(json, options_);
+  scanner.SkipBOM();
+  if (!scanner.SkipWhitespace() || !scanner.ConsumeIf('{') ||
+      !scanner.SkipWhitespace()) {
+    return false;
+  }
+  bool closed = scanner.ConsumeIf('}');
+  while (!closed) {
+    Field field;
+    absl::optional<StringPiece> raw_key = scanner.ScanString();
+    if (!raw_key)
+      return false;
+    field.raw_key = *raw_key;
+    if (NeedsNoDecoding(*raw_key)) {
+      field.key = std::string(raw_key->substr(1, raw_key->size() - 2));
+    } else {
+      absl::optional<Value> key = JSONReader::Read(*raw_key, options_);
+      if (!key || !key->is_string())
+        return false;
+      field.key = std::move(key->GetString());
+    }
+
+    if (!scanner.SkipWhitespace() || !scanner.ConsumeIf(':') ||
+        !scanner.SkipWhitespace()) {
+      return false;
+    }
+    absl::optional<StringPiece> raw_value = scanner.ScanValue();
+    if (!raw_value)
+      return false;
+    field.raw_value = *raw_value;
+    fields_.push_back(std::move(field));
+
+    if (!scanner.SkipWhitespace())
+      return false;
+    closed = scanner.ConsumeIf('}');
+    if (!closed) {
+      if (!scanner.ConsumeIf(',') || !scanner.SkipWhitespace())
+        return false;
+      if (options_ & JSON_ALLOW_TRAILING_COMMAS)
+        closed = scanner.ConsumeIf('}');
+    }
+  }
+  return scanner.SkipWhitespace() && scanner.at_end();
+}
+
+JSONLazyDict::Field* JSONLazyDict::FindField(StringPiece key) {
+  return const_cast<Field*>(std::as_const(*this).FindField(key));
+}
+
+const JSONLazyDict::Field* JSONLazyDict::FindField(StringPiece key) const {
+  for (auto it = fields_.rbegin(); it != fields_.rend(); ++it) {
+    if (it->key == key)
+      return &*it;
+  }
+  return nullptr;
+}
+
+Value* JSONLazyDict::GetValue(Field* field) {
+  if (!field->value) {
+    // The values are at depth 1, and invalid ones are parsed again on each
+    // lookup.
+    field->value = JSONReader::Read(field->raw_value, options_,
+                                    internal::kAbsoluteMaxDepth - 1);
+    if (!field->value)
+      return nullptr;
+    parsed_value_count_++;
+  }
+  return &*field->value;
+}
+
+}  // namespace base
@@ -0,0 +1,122 @@
+// Copyright 2022 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#ifndef BASE_JSON_JSON_LAZY_DICT_H_
+#define BASE_JSON_JSON_LAZY_DICT_H_
+
+#include <stddef.h>
+
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "base/base_export.h"
+#include "base/json/json_reader.h"
+#include "base/strings/string_piece.h"
+#include "base/values.h"
+#include "third_party/abseil-cpp/absl/types/optional.h"
+
+namespace base {
+
+// A JSON dictionary which is parsed on demand, for messages of which only a
+// few fields are read, and which are forwarded otherwise unmodified. Parse()
+// only indexes the top-level fields: each value is kept as its text in the
+// input, and is parsed into a Value on its first lookup. Write() copies the
+// text of the fields which weren't modified, so that forwarding a message
+// costs what is read of it, rather than the parsing and the writing of all
+// of it.
+//
+// The text of a value is only checked for a balanced structure by Parse(),
+// and fully when it's parsed: a lookup of an invalid value fails, and Write()
+// copies the text of the invalid values which weren't looked up.
+//
+// Like Value, the lookups of a duplicated key return its last value.
+class BASE_EXPORT JSONLazyDict {
+ public:
+  // Indexes |json|, which must be a dictionary and outlive the JSONLazyDict.
+  // Returns nullptr and sets |error_message|, if non-null, on error.
+  static std::unique_ptr<JSONLazyDict> Parse(
+      StringPiece json,
+      int options = JSON_PARSE_CHROMIUM_EXTENSIONS,
+      std::string* error_message = nullptr);
+
+  JSONLazyDict(const JSONLazyDict&) = delete;
+  JSONLazyDict& operator=(const JSONLazyDict&) = delete;
+
+  ~JSONLazyDict();
+
+  // The number of fields, including the duplicate keys.
+  size_t size() const { return fields_.size(); }
+
+  bool contains(StringPiece key) const;
+
+  // Returns the value of |key|, which is parsed on the first lookup. Returns
+  // nullptr if there's none, or if it's invalid.
+  const Value* Find(StringPiece key);
+
+  // As Find(), but the value is then written by Write() from the Value, rather
+  // than copied.
+  Value* FindMutable(StringPiece key);
+
+  // Returns the text of the value of |key| in the input, unless it was
+  // modified.
+  absl::optional<StringPiece> FindRaw(StringPiece key) const;
+
+  // Sets the value of |key|, replacing all its previous ones, if any.
+  void Set(StringPiece key, Value value);
+
+  // Removes all the values of |key|. Returns whether there were any.
+  bool Remove(StringPiece key);
+
+  // Writes the dictionary to |json|, in the order of the input, followed by
+  // the new keys. Returns false if a modified value can't be written, as with
+  // JSONWriter.
+  bool Write(std::string* json) const;
+
+  // Parses all the values into a Value::Dict. Returns nullopt if a value is
+  // invalid.
+  absl::optional<Value::Dict> ToDict();
+
+  size_t parsed_value_count_for_testing() const { return parsed_value_count_; }
+
+ private:
+  struct Field {
+    Field();
+    Field(Field&&);
+    Field& operator=(Field&&);
+    ~Field();
+
+    // The decoded key.
+    std::string key;
+    // The text of the key and of the value in the input, if any, which are
+    // empty for new fields.
+    StringPiece raw_key;
+    StringPiece raw_value;
+    // Set once the value is parsed, or set.
+    absl::optional<Value> value;
+    // Whether |value| must be written, rather than |raw_value|.
+    bool modified = false;
+  };
+
+  explicit JSONLazyDict(int options);
+
+  // Indexes the fields of |json|. Returns false if it's not a dictionary, or
+  // not well-formed.
+  bool Index(StringPiece json);
+
+  // Returns the last field of |key|, if any.
+  Field* FindField(StringPiece key);
+  const Field* FindField(StringPiece key) const;
+
+  // Parses the value of |field| if needed. Returns nullptr if it's invalid.
+  Value* GetValue(Field* field);
+
+  const int options_;
+  std::vector<Field> fields_;
+  size_t parsed_value_count_ = 0;
+};
+
+}  // namespace base
+
+#endif  // BASE_JSON_JSON_LAZY_DICT_H_
@@ -0,0 +1,130 @@
+// Copyright 2022 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "base/json/json_lazy_dict.h"
+
+#include <string>
+
+#include "base/json/json_reader.h"
+#include "base/strings/string_piece.h"
+#include "base/values.h"
+#include "testing/gtest/include/gtest/gtest.h"
+
+namespace base {
+
+TEST(JSONLazyDictTest, ParsesOnLookup) {
+  const StringPiece json =
+      R"({"id": 42, "route": "users", "body": {"a": [1, {"b": "}"}], "c": 2},)"
+      R"( "list": [ 1,2 ] })";
+  std::unique_ptr<JSONLazyDict> dict = JSONLazyDict::Parse(json);
+  ASSERT_TRUE(dict);
+  EXPECT_EQ(4u, dict->size());
+  EXPECT_EQ(0u, dict->parsed_value_count_for_testing());
+
+  EXPECT_TRUE(dict->contains("body"));
+  EXPECT_FALSE(dict->contains("missing"));
+  EXPECT_EQ(R"({"a": [1, {"b": "}"}], "c": 2})", dict->FindRaw("body"));
+  EXPECT_EQ("[ 1,2 ]", dict->FindRaw("list"));
+  EXPECT_EQ(0u, dict->parsed_value_count_for_testing());
+
+  const Value* id = dict->Find("id");
+  ASSERT_TRUE(id);
+  EXPECT_EQ(42, id->GetIfInt());
+  EXPECT_EQ("users", dict->Find("route")->GetString());
+  EXPECT_EQ(2u, dict->parsed_value_count_for_testing());
+  // The values are parsed once.
+  EXPECT_EQ(id, dict->Find("id"));
+  EXPECT_EQ(2u, dict->parsed_value_count_for_testing());
+  EXPECT_FALSE(dict->Find("missing"));
+
+  EXPECT_EQ(JSONReader::Read(json)->GetDict(), dict->ToDict());
+}
+
+TEST(JSONLazyDictTest, WritesUnmodifiedValuesVerbatim) {
+  const StringPiece json =
+      R"({ "id" : 1, "body": {"nested":  [1, 2.50, "A"]} })";
+  std::unique_ptr<JSONLazyDict> dict = JSONLazyDict::Parse(json);
+  ASSERT_TRUE(dict);
+  std::string output;
+  ASSERT_TRUE(dict->Write(&output));
+  EXPECT_EQ(R"({"id":1,"body":{"nested":  [1, 2.50, "A"]}})", output);
+
+  // Looking up doesn't modify.
+  ASSERT_TRUE(dict->Find("body"));
+  ASSERT_TRUE(dict->Write(&output));
+  EXPECT_EQ(R"({"id":1,"body":{"nested":  [1, 2.50, "A"]}})", output);
+
+  *dict->FindMutable("id") = Value(2);
+  dict->Set("new", Value("value"));
+  EXPECT_FALSE(dict->FindRaw("id"));
+  ASSERT_TRUE(dict->Write(&output));
+  EXPECT_EQ(
+      R"({"id":2,"body":{"nested":  [1, 2.50, "A"]},"new":"value"})",
+      output);
+
+  EXPECT_TRUE(dict->Remove("body"));
+  EXPECT_FALSE(dict->Remove("body"));
+  ASSERT_TRUE(dict->Write(&output));
+  EXPECT_EQ(R"({"id":2,"new":"value"})", output);
+}
+
+TEST(JSONLazyDictTest, Keys) {
+  const StringPiece json = R"({"a\n": 1, "é": 2, "a": 3, "a": 4})";
+  std::unique_ptr<JSONLazyDict> dict = JSONLazyDict::Parse(json);
+  ASSERT_TRUE(dict);
+  EXPECT_EQ(1, dict->Find("a\n")->GetIfInt());
+  EXPECT_EQ(2, dict->Find("\xc3\xa9")->GetIfInt());
+  // The last value of a duplicate key is found.
+  EXPECT_EQ(4, dict->Find("a")->GetIfInt());
+  std::string output;
+  ASSERT_TRUE(dict->Write(&output));
+  EXPECT_EQ(R"({"a\n":1,"é":2,"a":3,"a":4})", output);
+
+  // Setting a duplicate key replaces all its values.
+  dict->Set("a", Value(5));
+  EXPECT_EQ(3u, dict->size());
+  ASSERT_TRUE(dict->Write(&output));
+  EXPECT_EQ(R"({"a\n":1,"é":2,"a":5})", output);
+}
+
+TEST(JSONLazyDictTest, Options) {
+  const StringPiece json = R"({"a": [1, /* ] */ 2], // "b": 1
+                              "c": 3,})";
+  EXPECT_FALSE(JSONLazyDict::Parse(json, JSON_PARSE_RFC));
+  EXPECT_FALSE(JSONLazyDict::Parse(json, JSON_ALLOW_COMMENTS));
+  std::unique_ptr<JSONLazyDict> dict = JSONLazyDict::Parse(
+      json, JSON_ALLOW_COMMENTS | JSON_ALLOW_TRAILING_COMMAS);
+  ASSERT_TRUE(dict);
+  EXPECT_EQ(2u, dict->size());
+  EXPECT_FALSE(dict->contains("b"));
+  EXPECT_EQ(3, dict->Find("c")->GetIfInt());
+  EXPECT_EQ(2u, dict->Find("a")->GetList().size());
+
+  EXPECT_TRUE(JSONLazyDict::Parse("\xEF\xBB\xBF{}", JSON_PARSE_RFC));
+}
+
+TEST(JSONLazyDictTest, Errors) {
+  for (const char* json :
+       {"", "[]", "1", "{", R"({"a"})", R"({"a": })", R"({"a": [})",
+        R"({"a": [}]})", R"({"a": "})", R"({"a": 1 "b": 2})", "{} x",
+        R"({"a": 1,})"}) {
+    std::string error_message;
+    EXPECT_FALSE(JSONLazyDict::Parse(json, JSON_PARSE_RFC, &error_message))
+        << json;
+    EXPECT_FALSE(error_message.empty()) << json;
+  }
+
+  // The values are only fully checked when parsed.
+  std::unique_ptr<JSONLazyDict> dict =
+      JSONLazyDict::Parse(R"({"a": [tru], "b": 1})");
+  ASSERT_TRUE(dict);
+  EXPECT_FALSE(dict->Find("a"));
+  EXPECT_EQ(1, dict->Find("b")->GetIfInt());
+  EXPECT_FALSE(dict->ToDict());
+  std::string output;
+  ASSERT_TRUE(dict->Write(&output));
+  EXPECT_EQ(R"({"a":[tru],"b":1})", output);
+}
+
+}  // namespace base
@@ -92,6 +92,10 @@ enum class ChromiumJsonExtension {
 const char kExtensionHistogramName[] =
     "Security.JSONParser.ChromiumExtensionUsage";
 
+// Indexing the input costs a pass over it, which pays off for the inputs with
+// long strings or runs of blanks, and these are likelier in large inputs.
+constexpr size_t kStructuralIndexMinInputSize = 4096;
+
 }  // namespace
 
 // This is U+FFFD.
@@ -121,13 +125,48 @@ JSONParser::JSONParser(int options, size_t max_depth)
       index_last_line_(0),
       error_code_(JSON_NO_ERROR),
       error_line_(0),
-      error_column_(0) {
+      error_column_(0),
+      structural_index_min_input_size_(kStructuralIndexMinInputSize) {
   CHECK_LE(max_depth, kAbsoluteMaxDepth);
 }
 
 JSONParser::~JSONParser() = default;
 
 absl::optional<Value> JSONParser::Parse(StringPiece input) {
+  if (!StartParsing(input, /*first_line=*/1))
+    return absl::nullopt;
+
+  // Parse the first and any nested tokens.
+  absl::optional<Value> root(ParseNextToken());
+
+  // Make sure the input stream is at an end.
+  if (root && GetNextToken() != T_END_OF_INPUT) {
+    ReportError(JSON_UNEXPECTED_DATA_AFTER_ROOT, 0);
+    root.reset();
+  }
+
+  // The index refers to |input|, which the caller owns.
+  structural_index_.reset();
+  return root;
+}
+
+bool JSONParser::ParseStreaming(StringPiece input,
+                                JSONStreamingHandler* handler,
+                                int first_line) {
+  if (!StartParsing(input, first_line))
+    return false;
+
+  bool result = StreamNextToken(handler);
+  if (result && GetNextToken() != T_END_OF_INPUT) {
+    ReportError(JSON_UNEXPECTED_DATA_AFTER_ROOT, 0);
+    result = false;
+  }
+
+  structural_index_.reset();
+  return result;
+}
+
+bool JSONParser::StartParsing(StringPiece input, int first_line) {
   input_ = input;
   index_ = 0;
   // Line and column counting is 1-based, but |index_| is 0-based. For example,
@@ -141,7 +180,7 @@ absl::optional<Value> JSONParser::Parse(StringPiece input) {
   // initialize |index_last_line_| to -1, not 0, since -1 is the (out of range)
   // index of the imaginary '\n' immediately before the start of the string:
   // 'A' is in column (0 - -1) = 1.
-  line_number_ = 1;
+  line_number_ = first_line;
   index_last_line_ = -1;
 
   error_code_ = JSON_NO_ERROR;
@@ -152,26 +191,18 @@ absl::optional<Value> JSONParser::Parse(StringPiece input) {
   // that the index_ will not overflow when parsing.
   if (!base::IsValueInRangeForNumericType<int32_t>(input.length())) {
     ReportError(JSON_TOO_LARGE, -1);
-    return absl::nullopt;
+    return false;
   }
 
+  structural_index_.reset();
+  if (input.length() >= structural_index_min_input_size_)
+    structural_index_.emplace(input);
+
   // When the input JSON string starts with a UTF-8 Byte-Order-Mark,
   // advance the start position to avoid the ParseNextToken function mis-
   // treating a Unicode BOM as an invalid character and returning NULL.
   ConsumeIfMatch("\xEF\xBB\xBF");
-
-  // Parse the first and any nested tokens.
-  absl::optional<Value> root(ParseNextToken());
-  if (!root)
-    return absl::nullopt;
-
-  // Make sure the input stream is at an end.
-  if (GetNextToken() != T_END_OF_INPUT) {
-    ReportError(JSON_UNEXPECTED_DATA_AFTER_ROOT, 0);
-    return absl::nullopt;
-  }
-
-  return root;
+  return true;
 }
 
 JSONParser::JsonParseError JSONParser::error_code() const {
@@ -225,6 +256,21 @@ void JSONParser::StringBuilder::Convert() {
   string_.emplace(pos_, length_);
 }
 
+void JSONParser::StringBuilder::AppendASCII(const char* chars, size_t length) {
+  if (string_) {
+    string_->append(chars, length);
+  } else {
+    DCHECK_EQ(pos_ + length_, chars);
+    length_ += length;
+  }
+}
+
+StringPiece JSONParser::StringBuilder::AsStringPiece() const {
+  if (string_)
+    return *string_;
+  return StringPiece(pos_, length_);
+}
+
 std::string JSONParser::StringBuilder::DestructiveAsString() {
   if (string_)
     return std::move(*string_);
@@ -322,10 +368,16 @@ void JSONParser::EatWhitespaceAndComments() {
         if (!(c == '\n' && index_ > 0 && input_[index_ - 1] == '\r')) {
           ++line_number_;
         }
-        [[fallthrough]];
+        ConsumeChar();
+        break;
       case ' ':
       case '\t':
-        ConsumeChar();
+        if (structural_index_) {
+          index_ = static_cast<int>(
+              structural_index_->NextNonBlank(static_cast<size_t>(index_)));
+        } else {
+          ConsumeChar();
+        }
         break;
       case '/':
         if (!EatComment())
@@ -519,6 +571,135 @@ absl::optional<Value> JSONParser::ConsumeList() {
   return Value(std::move(list_storage));
 }
 
+bool JSONParser::StreamNextToken(JSONStreamingHandler* handler) {
+  return StreamToken(GetNextToken(), handler);
+}
+
+bool JSONParser::StreamToken(Token token, JSONStreamingHandler* handler) {
+  switch (token) {
+    case T_OBJECT_BEGIN:
+      return StreamDictionary(handler);
+    case T_ARRAY_BEGIN:
+      return StreamList(handler);
+    case T_STRING: {
+      StringBuilder string;
+      return ConsumeStringRaw(&string) &&
+             handler->OnString(string.AsStringPiece());
+    }
+    case T_NUMBER: {
+      absl::optional<Value> number = ConsumeNumber();
+      if (!number)
+        return false;
+      return number->is_int() ? handler->OnInt(number->GetInt())
+                              : handler->OnDouble(number->GetDouble());
+    }
+    case T_BOOL_TRUE:
+    case T_BOOL_FALSE:
+    case T_NULL: {
+      absl::optional<Value> literal = ConsumeLiteral();
+      if (!literal)
+        return false;
+      return literal->is_bool() ? handler->OnBool(literal->GetBool())
+                                : handler->OnNull();
+    }
+    default:
+      ReportError(JSON_UNEXPECTED_TOKEN, 0);
+      return false;
+  }
+}
+
+bool JSONParser::StreamDictionary(JSONStreamingHandler* handler) {
+  if (ConsumeChar() != '{') {
+    ReportError(JSON_UNEXPECTED_TOKEN, 0);
+    return false;
+  }
+
+  StackMarker depth_check(max_depth_, &stack_depth_);
+  if (depth_check.IsTooDeep()) {
+    ReportError(JSON_TOO_MUCH_NESTING, -1);
+    return false;
+  }
+
+  if (!handler->OnStartDict())
+    return false;
+
+  Token token = GetNextToken();
+  while (token != T_OBJECT_END) {
+    if (token != T_STRING) {
+      ReportError(JSON_UNQUOTED_DICTIONARY_KEY, 0);
+      return false;
+    }
+
+    StringBuilder key;
+    if (!ConsumeStringRaw(&key) || !handler->OnKey(key.AsStringPiece()))
+      return false;
+
+    token = GetNextToken();
+    if (token != T_OBJECT_PAIR_SEPARATOR) {
+      ReportError(JSON_SYNTAX_ERROR, 0);
+      return false;
+    }
+
+    ConsumeChar();
+    if (!StreamNextToken(handler))
+      return false;
+
+    token = GetNextToken();
+    if (token == T_LIST_SEPARATOR) {
+      ConsumeChar();
+      token = GetNextToken();
+      if (token == T_OBJECT_END && !(options_ & JSON_ALLOW_TRAILING_COMMAS)) {
+        ReportError(JSON_TRAILING_COMMA, 0);
+        return false;
+      }
+    } else if (token != T_OBJECT_END) {
+      ReportError(JSON_SYNTAX_ERROR, 0);
+      return false;
+    }
+  }
+
+  ConsumeChar();  // Closing '}'.
+  return handler->OnEndDict();
+}
+
+bool JSONParser::StreamList(JSONStreamingHandler* handler) {
+  if (ConsumeChar() != '[') {
+    ReportError(JSON_UNEXPECTED_TOKEN, 0);
+    return false;
+  }
+
+  StackMarker depth_check(max_depth_, &stack_depth_);
+  if (depth_check.IsTooDeep()) {
+    ReportError(JSON_TOO_MUCH_NESTING, -1);
+    return false;
+  }
+
+  if (!handler->OnStartList())
+    return false;
+
+  Token token = GetNextToken();
+  while (token != T_ARRAY_END) {
+    if (!StreamToken(token, handler))
+      return false;
+
+    token = GetNextToken();
+    if (token == T_LIST_SEPARATOR) {
+      ConsumeChar();
+      token = GetNextToken();
+      if (token == T_ARRAY_END && !(options_ & JSON_ALLOW_TRAILING_COMMAS)) {
+        ReportError(JSON_TRAILING_COMMA, 0);
+        return false;
+      }
+    } else if (token != T_ARRAY_END) {
+      ReportError(JSON_SYNTAX_ERROR, 0);
+      return false;
+    }
+  }
+
+  ConsumeChar();  // Closing ']'.
+  return handler->OnEndList();
+}
+
 absl::optional<Value> JSONParser::ConsumeString() {
   StringBuilder string;
   if (!ConsumeStringRaw(&string))
@@ -538,6 +719,18 @@ bool JSONParser::ConsumeStringRaw(StringBuilder* out) {
   StringBuilder string(pos());
 
   while (PeekChar()) {
+    if (structural_index_) {
+      // Copy the run of characters up to the next one to decode, or to the
+      // closing quote, at once.
+      const size_t run_end =
+          structural_index_->NextStringSpecial(static_cast<size_t>(index_));
+      if (run_end > static_cast<size_t>(index_)) {
+        string.AppendASCII(pos(), run_end - static_cast<size_t>(index_));
+        index_ = static_cast<int>(run_end);
+        continue;
+      }
+    }
+
     uint32_t next_char = 0;
     if (!ReadUnicodeCharacter(input_.data(),
                               static_cast<int32_t>(input_.length()), &index_,
@@ -747,6 +940,7 @@ absl::optional<Value> JSONParser::ConsumeNumber() {
   const char* num_start = pos();
   const int start_index = index_;
   int end_index = start_index;
+  bool is_integer = true;
 
   if (PeekChar() == '-')
     ConsumeChar();
@@ -760,6 +954,7 @@ absl::optional<Value> JSONParser::ConsumeNumber() {
   // The optional fraction part.
   if (PeekChar() == '.') {
     ConsumeChar();
+    is_integer = false;
     if (!ReadInt(true)) {
       ReportError(JSON_SYNTAX_ERROR, 0);
       return absl::nullopt;
@@ -771,6 +966,7 @@ absl::optional<Value> JSONParser::ConsumeNumber() {
   absl::optional<char> c = PeekChar();
   if (c == 'e' || c == 'E') {
     ConsumeChar();
+    is_integer = false;
     if (PeekChar() == '-' || PeekChar() == '+') {
       ConsumeChar();
     }
@@ -802,8 +998,9 @@ absl::optional<Value> JSONParser::ConsumeNumber() {
 
   StringPiece num_string(num_start, end_index - start_index);
 
+  // The numbers with a fraction or an exponent are never ints.
   int num_int;
-  if (StringToInt(num_string, &num_int))
+  if (is_integer && StringToInt(num_string, &num_int))
     return Value(num_int);
 
   double num_double;
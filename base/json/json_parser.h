@@ -15,12 +15,14 @@
 #include "base/compiler_specific.h"
 #include "base/gtest_prod_util.h"
 #include "base/json/json_common.h"
+#include "base/json/json_structural_index.h"
 #include "base/strings/string_piece.h"
 #include "base/values.h"
 #include "third_party/abseil-cpp/absl/types/optional.h"
 
 namespace base {
 
+class JSONStreamingHandler;
 class Value;
 
 namespace internal {
@@ -41,6 +43,10 @@ class JSONParserTest;
 // to the first byte of a valid JSON token. On exit, it is on the first byte
 // after the token that was just consumed, which would likely be the first byte
 // of the next token.
+//
+// Large inputs are parsed in two stages: a JSONStructuralIndex of the input is
+// built first, with which the parser skips over blanks and the bytes of
+// strings which need no decoding in bulk.
 class BASE_EXPORT JSONParser {
  public:
   // Error codes during parsing.
@@ -84,6 +90,15 @@ class BASE_EXPORT JSONParser {
   // convert to a FooValue at the same time.
   absl::optional<Value> Parse(StringPiece input);
 
+  // Parses the input string like Parse(), but reports the values to |handler|
+  // as they're parsed, instead of building them. Returns true on success, and
+  // false on error or if |handler| stopped parsing, in which case error_code()
+  // is JSON_NO_ERROR. The error lines are counted from |first_line|, e.g. for
+  // parsing one line of a file.
+  bool ParseStreaming(StringPiece input,
+                      JSONStreamingHandler* handler,
+                      int first_line = 1);
+
   // Returns the error code.
   JsonParseError error_code() const;
 
@@ -137,11 +152,18 @@ class BASE_EXPORT JSONParser {
     // converted, or by appending the UTF8 bytes for the code point.
     void Append(uint32_t point);
 
+    // Appends the |length| ASCII characters at |chars|, the next ones of the
+    // input, which need no decoding.
+    void AppendASCII(const char* chars, size_t length);
+
     // Converts the builder from its default StringPiece to a full std::string,
     // performing a copy. Once a builder is converted, it cannot be made a
     // StringPiece again.
     void Convert();
 
+    // Returns the string built so far, valid until the builder is modified.
+    StringPiece AsStringPiece() const;
+
     // Returns the builder as a string, invalidating all state. This allows
     // the internal string buffer representation to be destructively moved
     // in cases where the builder will not be needed any more.
@@ -176,6 +198,10 @@ class BASE_EXPORT JSONParser {
   // Returns a pointer to the current character position.
   const char* pos();
 
+  // Resets the state of the parser to parse |input|, from its |first_line|.
+  // Returns false and reports an error if |input| can't be parsed.
+  bool StartParsing(StringPiece input, int first_line);
+
   // Skips over whitespace and comments to find the next token in the stream.
   // This does not advance the parser for non-whitespace or comment chars.
   Token GetNextToken();
@@ -202,6 +228,15 @@ class BASE_EXPORT JSONParser {
   // Value.
   absl::optional<Value> ConsumeList();
 
+  // The streaming counterparts of ParseNextToken(), ParseToken(),
+  // ConsumeDictionary() and ConsumeList(), which report the values to
+  // |handler| instead of returning them. They return false on error, or if
+  // |handler| stopped parsing.
+  bool StreamNextToken(JSONStreamingHandler* handler);
+  bool StreamToken(Token token, JSONStreamingHandler* handler);
+  bool StreamDictionary(JSONStreamingHandler* handler);
+  bool StreamList(JSONStreamingHandler* handler);
+
   // Calls through ConsumeStringRaw and wraps it in a value.
   absl::optional<Value> ConsumeString();
 
@@ -269,6 +304,12 @@ class BASE_EXPORT JSONParser {
   int error_line_;
   int error_column_;
 
+  // The inputs of at least this size are indexed. Lowered by tests.
+  size_t structural_index_min_input_size_;
+
+  // The index of |input_|, if it's large enough.
+  absl::optional<JSONStructuralIndex> structural_index_;
+
   friend class JSONParserTest;
   FRIEND_TEST_ALL_PREFIXES(JSONParserTest, NextChar);
   FRIEND_TEST_ALL_PREFIXES(JSONParserTest, ConsumeDictionary);
@@ -277,6 +318,7 @@ class BASE_EXPORT JSONParser {
   FRIEND_TEST_ALL_PREFIXES(JSONParserTest, ConsumeLiterals);
   FRIEND_TEST_ALL_PREFIXES(JSONParserTest, ConsumeNumbers);
   FRIEND_TEST_ALL_PREFIXES(JSONParserTest, ErrorMessages);
+  FRIEND_TEST_ALL_PREFIXES(JSONParserTest, StructuralIndex);
 };
 
 // Used when decoding and an invalid utf-8 sequence is encountered.
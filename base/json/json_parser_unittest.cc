@@ -303,5 +303,56 @@ TEST_F(JSONParserTest, ErrorMessages) {
   }
 }
 
+// The structural index must not change the results, nor the errors and their
+// location.
+TEST_F(JSONParserTest, StructuralIndex) {
+  struct {
+    const char* input;
+    int options;
+  } kCases[] = {
+      {"{\"a\": \"bcd\", \"e\": [1, 2.5, true, null]}", JSON_PARSE_RFC},
+      {"  \t [ \"long string without anything to decode in it\" ]  ",
+       JSON_PARSE_RFC},
+      {"[\"esc\\\"aped\\n\\u00e9\", \"\xC3\xA9t\xC3\xA9\"]",
+       JSON_PARSE_RFC},
+      {"[\"invalid \xFF utf-8\"]", JSON_REPLACE_INVALID_CHARACTERS},
+      {"[\"invalid \xFF utf-8\"]", JSON_PARSE_RFC},
+      {"{\n  \"a\": 1,\r\n  \"b\": [\n    \"c\"\n  ],\n}",
+       JSON_ALLOW_TRAILING_COMMAS},
+      {"{\n  \"a\": 1,\r\n  \"b\": [\n    \"c\"\n  ],\n}",
+       JSON_PARSE_RFC},
+      {"[\n  1, // comment\n  /* block\n  comment */ 2\n]",
+       JSON_ALLOW_COMMENTS},
+      {"[\n  1, // comment\n  2\n]", JSON_PARSE_RFC},
+      {"[\"multi\nline\nstring\"]  x", JSON_ALLOW_CONTROL_CHARS},
+      {"[\"control\tcharacter\"]", JSON_PARSE_RFC},
+      {"[\"unterminated string   ", JSON_PARSE_RFC},
+      {"\xEF\xBB\xBF  [\"bom\"]", JSON_PARSE_RFC},
+  };
+
+  for (const auto& test_case : kCases) {
+    SCOPED_TRACE(test_case.input);
+    JSONParser parser(test_case.options);
+    absl::optional<Value> expected = parser.Parse(test_case.input);
+
+    JSONParser indexed_parser(test_case.options);
+    indexed_parser.structural_index_min_input_size_ = 0;
+    absl::optional<Value> value = indexed_parser.Parse(test_case.input);
+
+    EXPECT_EQ(expected, value);
+    EXPECT_EQ(parser.error_code(), indexed_parser.error_code());
+    EXPECT_EQ(parser.error_line(), indexed_parser.error_line());
+    EXPECT_EQ(parser.error_column(), indexed_parser.error_column());
+  }
+
+  // Large inputs are indexed by default.
+  std::string long_string(64 * 1024, 'x');
+  JSONParser parser(JSON_PARSE_RFC);
+  ASSERT_LT(parser.structural_index_min_input_size_, long_string.size());
+  absl::optional<Value> value = parser.Parse("[\"" + long_string + "\"]");
+  ASSERT_TRUE(value);
+  EXPECT_EQ(long_string, value->GetList()[0].GetString());
+}
+
 }  // namespace internal
 }  // namespace base
@@ -2,8 +2,12 @@
 // Use of this source code is governed by a BSD-style license that can be
 // found in the LICENSE file.
 
+#include "base/json/json_document.h"
+#include "base/json/json_lazy_dict.h"
 #include "base/json/json_reader.h"
+#include "base/json/json_value_converter.h"
 #include "base/json/json_writer.h"
+#include "base/memory/arena.h"
 #include "base/memory/ptr_util.h"
 #include "base/strings/string_number_conversions.h"
 #include "base/time/time.h"
@@ -19,11 +23,13 @@ namespace {
 constexpr char kMetricPrefixJSON[] = "JSON.";
 constexpr char kMetricReadTime[] = "read_time";
 constexpr char kMetricWriteTime[] = "write_time";
+constexpr char kMetricReadThroughput[] = "read_throughput";
 
 perf_test::PerfResultReporter SetUpReporter(const std::string& story_name) {
   perf_test::PerfResultReporter reporter(kMetricPrefixJSON, story_name);
   reporter.RegisterImportantMetric(kMetricReadTime, "ms");
   reporter.RegisterImportantMetric(kMetricWriteTime, "ms");
+  reporter.RegisterImportantMetric(kMetricReadThroughput, "GB/s");
   return reporter;
 }
 
@@ -61,6 +67,37 @@ Value GenerateLayeredDict(int breadth, int depth) {
   return root;
 }
 
+// Generates a list of |count| records mixing short and long strings, such as
+// config and telemetry payloads.
+Value GenerateRecords(int count) {
+  Value::ListStorage records;
+  for (int i = 0; i < count; ++i) {
+    Value record(Value::Type::DICTIONARY);
+    record.SetIntKey("id", i);
+    record.SetStringKey("name", "record_" + NumberToString(i));
+    record.SetStringKey("description", std::string(200, 'a' + i % 26));
+    record.SetStringKey("escaped", "line\n\"quoted\"\ttab");
+    record.SetDoubleKey("value", i * 0.25);
+    record.SetBoolKey("enabled", i % 2);
+    records.push_back(std::move(record));
+  }
+  return Value(std::move(records));
+}
+
+// Generates a list of |count| metrics, with doubles or ints.
+Value GenerateMetrics(int count) {
+  Value::List metrics;
+  for (int i = 0; i < count; ++i) {
+    Value::List sample;
+    sample.Append(i);
+    sample.Append(i * 0.125);
+    sample.Append(i / 7.0);
+    sample.Append(i * 1000.0);
+    metrics.Append(std::move(sample));
+  }
+  return Value(std::move(metrics));
+}
+
 }  // namespace
 
 class JSONPerfTest : public testing::Test {
@@ -85,6 +122,206 @@ class JSONPerfTest : public testing::Test {
   }
 };
 
+TEST_F(JSONPerfTest, ReadThroughput) {
+  constexpr int kIterations = 10;
+  Value records = GenerateRecords(16 * 1024);
+  for (bool pretty_print : {false, true}) {
+    std::string json;
+    ASSERT_TRUE(JSONWriter::WriteWithOptions(
+        records, pretty_print ? JSONWriter::OPTIONS_PRETTY_PRINT : 0, &json));
+
+    TimeTicks start_read = TimeTicks::Now();
+    for (int i = 0; i < kIterations; ++i)
+      ASSERT_TRUE(JSONReader::Read(json));
+    TimeDelta read_time = TimeTicks::Now() - start_read;
+
+    auto reporter = SetUpReporter(pretty_print ? "records_pretty_printed"
+                                               : "records_compact");
+    reporter.AddResult(kMetricReadThroughput,
+                       kIterations * json.size() / read_time.InSecondsF() /
+                           (1024. * 1024 * 1024));
+  }
+}
+
+// Reads a field of every record, as with the Values of JSONReader and as with
+// a JSONDocument, which doesn't copy the strings.
+TEST_F(JSONPerfTest, ReadDocumentThroughput) {
+  constexpr int kIterations = 10;
+  std::string json;
+  ASSERT_TRUE(JSONWriter::Write(GenerateRecords(16 * 1024), &json));
+
+  TimeTicks start_read = TimeTicks::Now();
+  for (int i = 0; i < kIterations; ++i) {
+    absl::optional<Value> records = JSONReader::Read(json);
+    ASSERT_TRUE(records);
+    for (const Value& record : records->GetList())
+      ASSERT_TRUE(record.FindStringKey("name"));
+  }
+  TimeDelta read_time = TimeTicks::Now() - start_read;
+  auto values_reporter = SetUpReporter("records_values");
+  values_reporter.AddResult(
+      kMetricReadThroughput, kIterations * json.size() /
+                                 read_time.InSecondsF() /
+                                 (1024. * 1024 * 1024));
+
+  start_read = TimeTicks::Now();
+  for (int i = 0; i < kIterations; ++i) {
+    std::unique_ptr<JSONDocument> document = JSONDocument::Parse(json);
+    ASSERT_TRUE(document);
+    for (JSONValueView record : document->root())
+      ASSERT_TRUE(record.FindKey("name"));
+  }
+  read_time = TimeTicks::Now() - start_read;
+  auto document_reporter = SetUpReporter("records_document");
+  document_reporter.AddResult(
+      kMetricReadThroughput, kIterations * json.size() /
+                                 read_time.InSecondsF() /
+                                 (1024. * 1024 * 1024));
+
+  // As a request handler would, with an arena reset after each document.
+  Arena arena;
+  start_read = TimeTicks::Now();
+  for (int i = 0; i < kIterations; ++i) {
+    std::unique_ptr<JSONDocument> document =
+        JSONDocument::ParseInArena(json, &arena);
+    ASSERT_TRUE(document);
+    for (JSONValueView record : document->root())
+      ASSERT_TRUE(record.FindKey("name"));
+    document.reset();
+    arena.Reset();
+  }
+  read_time = TimeTicks::Now() - start_read;
+  auto arena_reporter = SetUpReporter("records_document_arena");
+  arena_reporter.AddResult(
+      kMetricReadThroughput, kIterations * json.size() /
+                                 read_time.InSecondsF() /
+                                 (1024. * 1024 * 1024));
+}
+
+// A record of GenerateRecords().
+struct Record {
+  int id = 0;
+  std::string name;
+  std::string description;
+  std::string escaped;
+  double value = 0;
+  bool enabled = false;
+
+  static void RegisterJSONConverter(JSONValueConverter<Record>* converter) {
+    converter->RegisterIntField("id", &Record::id);
+    converter->RegisterStringField("name", &Record::name);
+    converter->RegisterStringField("description", &Record::description);
+    converter->RegisterStringField("escaped", &Record::escaped);
+    converter->RegisterDoubleField("value", &Record::value);
+    converter->RegisterBoolField("enabled", &Record::enabled);
+  }
+};
+
+struct Records {
+  std::vector<std::unique_ptr<Record>> records;
+
+  static void RegisterJSONConverter(JSONValueConverter<Records>* converter) {
+    converter->RegisterRepeatedMessage("records", &Records::records);
+  }
+};
+
+// Converts records into structs, through the Values of JSONReader and
+// directly from the JSON.
+TEST_F(JSONPerfTest, ConvertThroughput) {
+  constexpr int kIterations = 10;
+  Value::Dict dict;
+  dict.Set("records", GenerateRecords(16 * 1024));
+  std::string json;
+  ASSERT_TRUE(JSONWriter::Write(dict, &json));
+  const JSONValueConverter<Records> converter;
+
+  TimeTicks start_read = TimeTicks::Now();
+  for (int i = 0; i < kIterations; ++i) {
+    absl::optional<Value> value = JSONReader::Read(json);
+    ASSERT_TRUE(value);
+    Records records;
+    ASSERT_TRUE(converter.Convert(*value, &records));
+  }
+  TimeDelta read_time = TimeTicks::Now() - start_read;
+  auto values_reporter = SetUpReporter("convert_values");
+  values_reporter.AddResult(
+      kMetricReadThroughput, kIterations * json.size() /
+                                 read_time.InSecondsF() /
+                                 (1024. * 1024 * 1024));
+
+  start_read = TimeTicks::Now();
+  for (int i = 0; i < kIterations; ++i) {
+    Records records;
+    ASSERT_TRUE(converter.ConvertJSON(json, &records));
+  }
+  read_time = TimeTicks::Now() - start_read;
+  auto direct_reporter = SetUpReporter("convert_json");
+  direct_reporter.AddResult(
+      kMetricReadThroughput, kIterations * json.size() /
+                                 read_time.InSecondsF() /
+                                 (1024. * 1024 * 1024));
+}
+
+// Reads a top-level field of a message and forwards it with a new field, as
+// with a Value and as with a JSONLazyDict, which copies the rest verbatim.
+TEST_F(JSONPerfTest, PassThrough) {
+  constexpr int kIterations = 10;
+  Value::Dict message;
+  message.Set("route", "records");
+  message.Set("body", GenerateRecords(16 * 1024));
+  std::string json;
+  ASSERT_TRUE(JSONWriter::Write(message, &json));
+
+  std::string output;
+  TimeTicks start = TimeTicks::Now();
+  for (int i = 0; i < kIterations; ++i) {
+    absl::optional<Value> value = JSONReader::Read(json);
+    ASSERT_TRUE(value);
+    ASSERT_TRUE(value->FindStringKey("route"));
+    value->SetBoolKey("forwarded", true);
+    ASSERT_TRUE(JSONWriter::Write(*value, &output));
+  }
+  TimeDelta time = TimeTicks::Now() - start;
+  auto values_reporter = SetUpReporter("pass_through_values");
+  values_reporter.AddResult(
+      kMetricReadThroughput,
+      kIterations * json.size() / time.InSecondsF() / (1024. * 1024 * 1024));
+
+  start = TimeTicks::Now();
+  for (int i = 0; i < kIterations; ++i) {
+    std::unique_ptr<JSONLazyDict> dict = JSONLazyDict::Parse(json);
+    ASSERT_TRUE(dict);
+    ASSERT_TRUE(dict->Find("route"));
+    dict->Set("forwarded", Value(true));
+    ASSERT_TRUE(dict->Write(&output));
+  }
+  time = TimeTicks::Now() - start;
+  auto lazy_reporter = SetUpReporter("pass_through_lazy");
+  lazy_reporter.AddResult(
+      kMetricReadThroughput,
+      kIterations * json.size() / time.InSecondsF() / (1024. * 1024 * 1024));
+}
+
+TEST_F(JSONPerfTest, Numbers) {
+  constexpr int kIterations = 10;
+  Value metrics = GenerateMetrics(64 * 1024);
+  std::string json;
+
+  TimeTicks start_write = TimeTicks::Now();
+  for (int i = 0; i < kIterations; ++i)
+    ASSERT_TRUE(JSONWriter::Write(metrics, &json));
+  TimeDelta write_time = TimeTicks::Now() - start_write;
+
+  TimeTicks start_read = TimeTicks::Now();
+  for (int i = 0; i < kIterations; ++i)
+    ASSERT_TRUE(JSONReader::Read(json));
+  TimeDelta read_time = TimeTicks::Now() - start_read;
+
+  auto reporter = SetUpReporter("metrics");
+  reporter.AddResult(kMetricWriteTime, write_time / kIterations);
+  reporter.AddResult(kMetricReadTime, read_time / kIterations);
+}
+
 TEST_F(JSONPerfTest, StressTest) {
   // These loop ranges are chosen such that this test will complete in a
   // reasonable amount of time and will work on a 32-bit build without hitting
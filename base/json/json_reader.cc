@@ -5,16 +5,18 @@
 #include "base/json/json_reader.h"
 
 #include <utility>
+#include <vector>
 
+#include "base/files/file.h"
+#include "base/json/json_parser.h"
 #include "base/logging.h"
 #include "base/parsing_buildflags.h"
+#include "base/strings/string_util.h"
 #include "third_party/abseil-cpp/absl/types/optional.h"
 
 #if BUILDFLAG(BUILD_RUST_JSON_PARSER)
 #include "base/json/json_parser.rs.h"
 #include "base/strings/string_piece_rust.h"
-#else
-#include "base/json/json_parser.h"
 #endif
 
 namespace base {
@@ -54,6 +56,34 @@ base::JSONReader::ValueWithError DecodeJSONInRust(const base::StringPiece& json,
 
 #endif  // BUILDFLAG(BUILD_RUST_JSON_PARSER)
 
+namespace {
+
+// The size of the chunks read by ReadStreamingLines().
+constexpr int kStreamingChunkSize = 64 * 1024;
+
+bool ReadStreamingLine(StringPiece line,
+                       int line_number,
+                       JSONStreamingHandler* handler,
+                       int options,
+                       std::string* error_message) {
+  // Handle "\r\n" line endings, and skip blank lines.
+  if (!line.empty() && line.back() == '\r')
+    line.remove_suffix(1);
+  if (TrimWhitespaceASCII(line, TRIM_ALL).empty())
+    return true;
+
+  internal::JSONParser parser(options);
+  if (parser.ParseStreaming(line, handler, line_number))
+    return true;
+  if (error_message &&
+      parser.error_code() != internal::JSONParser::JSON_NO_ERROR) {
+    *error_message = parser.GetErrorMessage();
+  }
+  return false;
+}
+
+}  // namespace
+
 JSONReader::ValueWithError::ValueWithError() = default;
 
 JSONReader::ValueWithError::ValueWithError(ValueWithError&& other) = default;
@@ -103,4 +133,68 @@ JSONReader::ValueWithError JSONReader::ReadAndReturnValueWithError(
 #endif  // BUILDFLAG(BUILD_RUST_JSON_PARSER)
 }
 
+// static
+bool JSONReader::ReadStreaming(StringPiece json,
+                               JSONStreamingHandler* handler,
+                               int options,
+                               std::string* error_message) {
+  internal::JSONParser parser(options);
+  if (parser.ParseStreaming(json, handler))
+    return true;
+  if (error_message &&
+      parser.error_code() != internal::JSONParser::JSON_NO_ERROR) {
+    *error_message = parser.GetErrorMessage();
+  }
+  return false;
+}
+
+// static
+bool JSONReader::ReadStreamingLines(File* file,
+                                    JSONStreamingHandler* handler,
+                                    int options,
+                                    std::string* error_message) {
+  DCHECK(file->IsValid());
+
+  // Holds the start of the line being read, if it spans several chunks.
+  std::string pending;
+  std::vector<char> chunk(kStreamingChunkSize);
+  int line_number = 1;
+  while (true) {
+    int read = file->ReadAtCurrentPos(chunk.data(), kStreamingChunkSize);
+    if (read < 0) {
+      if (error_message)
+        *error_message = File::ErrorToString(File::GetLastFileError());
+      return false;
+    }
+    if (read == 0)
+      break;
+
+    StringPiece data(chunk.data(), static_cast<size_t>(read));
+    while (!data.empty()) {
+      const size_t end = data.find('\n');
+      if (end == StringPiece::npos) {
+        pending.append(data.data(), data.size());
+        break;
+      }
+
+      StringPiece line = data.substr(0, end);
+      if (!pending.empty()) {
+        pending.append(line.data(), line.size());
+        line = pending;
+      }
+      if (!ReadStreamingLine(line, line_number, handler, options,
+                             error_message)) {
+        return false;
+      }
+      ++line_number;
+      pending.clear();
+      data.remove_prefix(end + 1);
+    }
+  }
+
+  // The last line may not be terminated.
+  return ReadStreamingLine(pending, line_number, handler, options,
+                           error_message);
+}
+
 }  // namespace base
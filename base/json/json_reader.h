@@ -32,6 +32,10 @@
 //   JSON source decodes to a base::Value whose string contains "\xC3\xBF", the
 //   UTF-8 encoding of U+00FF LATIN SMALL LETTER Y WITH DIAERESIS. Converting
 //   from UTF-8 to UTF-16, e.g. via UTF8ToWide, will recover a 16-bit 0x00FF.
+//
+// A Value tree allocates each of its strings and containers. To read a large
+// input and discard it, see JSONDocument, which can also allocate from an
+// Arena.
 
 #ifndef BASE_JSON_JSON_READER_H_
 #define BASE_JSON_JSON_READER_H_
@@ -47,6 +51,8 @@
 
 namespace base {
 
+class File;
+
 enum JSONParserOptions {
   // Parses the input strictly according to RFC 8259.
   JSON_PARSE_RFC = 0,
@@ -81,6 +87,27 @@ enum JSONParserOptions {
                                    JSON_ALLOW_VERT_TAB | JSON_ALLOW_X_ESCAPES,
 };
 
+// Receives the values parsed by JSONReader::ReadStreaming() as events, in the
+// order of the input, instead of a Value tree. The StringPieces are only
+// valid during the call. Returning false from any method stops parsing. All
+// the keys of a dictionary are reported, including the duplicates.
+class BASE_EXPORT JSONStreamingHandler {
+ public:
+  virtual ~JSONStreamingHandler() = default;
+
+  virtual bool OnStartDict() { return true; }
+  virtual bool OnKey(StringPiece key) { return true; }
+  virtual bool OnEndDict() { return true; }
+  virtual bool OnStartList() { return true; }
+  virtual bool OnEndList() { return true; }
+  virtual bool OnString(StringPiece value) { return true; }
+  // Numbers are reported as ints if they are representable, as in Read().
+  virtual bool OnInt(int value) { return true; }
+  virtual bool OnDouble(double value) { return true; }
+  virtual bool OnBool(bool value) { return true; }
+  virtual bool OnNull() { return true; }
+};
+
 class BASE_EXPORT JSONReader {
  public:
   struct BASE_EXPORT ValueWithError {
@@ -130,6 +157,26 @@ class BASE_EXPORT JSONReader {
   static ValueWithError ReadAndReturnValueWithError(
       StringPiece json,
       int options = JSON_PARSE_CHROMIUM_EXTENSIONS);
+
+  // Parses |json| like Read(), but reports the values to |handler| as they
+  // are parsed, which allocates nothing per value. The events of the values
+  // before an error are reported. Returns true if all of |json| was parsed.
+  // Otherwise, sets |error_message|, if non-null, to the error, or leaves it
+  // empty if |handler| stopped parsing.
+  static bool ReadStreaming(StringPiece json,
+                            JSONStreamingHandler* handler,
+                            int options = JSON_PARSE_CHROMIUM_EXTENSIONS,
+                            std::string* error_message = nullptr);
+
+  // Parses the newline-delimited JSON values of |file|, from its current
+  // position, with ReadStreaming(). The file is read by chunks, so that the
+  // memory used is bounded by the size of the longest line, not of the
+  // file. Empty lines are skipped. The error message reports the line of
+  // the file. Reading errors fail parsing.
+  static bool ReadStreamingLines(File* file,
+                                 JSONStreamingHandler* handler,
+                                 int options = JSON_PARSE_CHROMIUM_EXTENSIONS,
+                                 std::string* error_message = nullptr);
 };
 
 }  // namespace base
@@ -7,13 +7,18 @@
 #include <stddef.h>
 
 #include <utility>
+#include <vector>
 
 #include "base/base_paths.h"
 #include "base/cxx17_backports.h"
+#include "base/files/file.h"
 #include "base/files/file_util.h"
+#include "base/files/scoped_temp_dir.h"
 #include "base/logging.h"
 #include "base/path_service.h"
+#include "base/strings/string_number_conversions.h"
 #include "base/strings/string_piece.h"
+#include "base/strings/string_util.h"
 #include "base/strings/stringprintf.h"
 #include "base/strings/utf_string_conversions.h"
 #include "base/values.h"
@@ -34,6 +39,46 @@ base::StringPiece MakeNotNullTerminatedInput(const char* input,
   return base::StringPiece(owner->get(), str_len);
 }
 
+// Records the events of JSONReader::ReadStreaming(), and stops after
+// |max_events| of them.
+class RecordingHandler : public base::JSONStreamingHandler {
+ public:
+  explicit RecordingHandler(size_t max_events = SIZE_MAX)
+      : max_events_(max_events) {}
+
+  bool OnStartDict() override { return Record("{"); }
+  bool OnKey(base::StringPiece key) override {
+    return Record("key:" + std::string(key));
+  }
+  bool OnEndDict() override { return Record("}"); }
+  bool OnStartList() override { return Record("["); }
+  bool OnEndList() override { return Record("]"); }
+  bool OnString(base::StringPiece value) override {
+    return Record("string:" + std::string(value));
+  }
+  bool OnInt(int value) override {
+    return Record("int:" + base::NumberToString(value));
+  }
+  bool OnDouble(double value) override {
+    return Record("double:" + base::NumberToString(value));
+  }
+  bool OnBool(bool value) override {
+    return Record(value ? "true" : "false");
+  }
+  bool OnNull() override { return Record("null"); }
+
+  std::string events() const { return base::JoinString(events_, " "); }
+
+ private:
+  bool Record(std::string event) {
+    events_.push_back(std::move(event));
+    return events_.size() < max_events_;
+  }
+
+  const size_t max_events_;
+  std::vector<std::string> events_;
+};
+
 }  // namespace
 
 namespace base {
@@ -1090,4 +1135,68 @@ TEST(JSONReaderTest, ChromiumExtensions) {
   }
 }
 
+TEST(JSONReaderTest, ReadStreaming) {
+  RecordingHandler handler;
+  EXPECT_TRUE(JSONReader::ReadStreaming(
+      R"({"a": [1, 2.5, "s\"t", true, null], "b": {}, "a": false})",
+      &handler));
+  EXPECT_EQ(
+      "{ key:a [ int:1 double:2.5 string:s\"t true null ] key:b { } key:a "
+      "false }",
+      handler.events());
+}
+
+TEST(JSONReaderTest, ReadStreamingOptions) {
+  RecordingHandler handler;
+  std::string error_message;
+  EXPECT_FALSE(JSONReader::ReadStreaming("[1, /* comment */ 2,]", &handler,
+                                         JSON_PARSE_RFC, &error_message));
+  EXPECT_EQ("Line: 1, column: 5, Unexpected token.", error_message);
+  // The events before the error are reported.
+  EXPECT_EQ("[ int:1", handler.events());
+
+  RecordingHandler extensions_handler;
+  EXPECT_TRUE(JSONReader::ReadStreaming(
+      "[1, /* comment */ 2,]", &extensions_handler,
+      JSON_ALLOW_COMMENTS | JSON_ALLOW_TRAILING_COMMAS, &error_message));
+  EXPECT_EQ("[ int:1 int:2 ]", extensions_handler.events());
+}
+
+TEST(JSONReaderTest, ReadStreamingStoppedByHandler) {
+  RecordingHandler handler(/*max_events=*/3);
+  std::string error_message;
+  EXPECT_FALSE(JSONReader::ReadStreaming(R"({"a": 1, "b": 2})", &handler,
+                                         JSON_PARSE_RFC, &error_message));
+  EXPECT_EQ("{ key:a int:1", handler.events());
+  EXPECT_TRUE(error_message.empty());
+}
+
+TEST(JSONReaderTest, ReadStreamingLines) {
+  ScopedTempDir temp_dir;
+  ASSERT_TRUE(temp_dir.CreateUniqueTempDir());
+  FilePath path = temp_dir.GetPath().AppendASCII("lines.json");
+
+  // Lines longer than a chunk, blank lines, "\r\n", and no final newline.
+  const std::string long_string(100 * 1024, 'x');
+  const std::string contents = "{\"a\": 1}\n\n[\"" + long_string +
+                               "\"]\r\n  \ntrue\nnull";
+  ASSERT_TRUE(WriteFile(path, contents));
+
+  File file(path, File::FLAG_OPEN | File::FLAG_READ);
+  RecordingHandler handler;
+  EXPECT_TRUE(JSONReader::ReadStreamingLines(&file, &handler));
+  EXPECT_EQ("{ key:a int:1 } [ string:" + long_string + " ] true null",
+            handler.events());
+
+  // Errors report the line of the file.
+  ASSERT_TRUE(WriteFile(path, "1\n2\n[3,\n4"));
+  File bad_file(path, File::FLAG_OPEN | File::FLAG_READ);
+  RecordingHandler bad_handler;
+  std::string error_message;
+  EXPECT_FALSE(JSONReader::ReadStreamingLines(&bad_file, &bad_handler,
+                                              JSON_PARSE_RFC, &error_message));
+  EXPECT_EQ("int:1 int:2 [ int:3", bad_handler.events());
+  EXPECT_EQ("Line: 3, column: 4, Unexpected token.", error_message);
+}
+
 }  // namespace base
@@ -0,0 +1,220 @@
+// Copyright 2022 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "base/json/json_structural_index.h"
+
+#include <string.h>
+
+#include <algorithm>
+
+#include "base/bits.h"
+#include "base/check_op.h"
+#include "build/build_config.h"
+
+#if defined(ARCH_CPU_X86_64)
+#include "base/cpu.h"
+// Including these headers directly should generally be avoided. The AVX2 loop
+// is only used if the CPU supports it at runtime, see scan_loop.h.
+// clang-format off
+#include <immintrin.h>
+// clang-format on
+#elif defined(ARCH_CPU_ARM64)
+#include <arm_neon.h>
+#endif
+
+namespace base {
+namespace internal {
+
+namespace {
+
+constexpr size_t kBlockSize = JSONStructuralIndex::kBlockSize;
+
+// Classifies the bytes of |block_count| blocks of |data|, and writes one word
+// per block to |string_specials| and |non_blanks|.
+using ClassifyBlocksFunction = void (*)(const char* data,
+                                        size_t block_count,
+                                        uint64_t* string_specials,
+                                        uint64_t* non_blanks);
+
+void ClassifyBlocksUnvectorized(const char* data,
+                                size_t block_count,
+                                uint64_t* string_specials,
+                                uint64_t* non_blanks) {
+  for (size_t block = 0; block < block_count; ++block) {
+    uint64_t specials = 0;
+    uint64_t blanks = 0;
+    for (size_t i = 0; i < kBlockSize; ++i) {
+      const uint8_t c = static_cast<uint8_t>(data[block * kBlockSize + i]);
+      if (c == '"' || c == '\\' || c < 0x20 || c >= 0x80)
+        specials |= uint64_t{1} << i;
+      if (c == ' ' || c == '\t')
+        blanks |= uint64_t{1} << i;
+    }
+    string_specials[block] = specials;
+    non_blanks[block] = ~blanks;
+  }
+}
+
+#if defined(ARCH_CPU_X86_64)
+
+// SSE2 is part of x86-64.
+void ClassifyBlocksSSE2(const char* data,
+                        size_t block_count,
+                        uint64_t* string_specials,
+                        uint64_t* non_blanks) {
+  const __m128i quote = _mm_set1_epi8('"');
+  const __m128i backslash = _mm_set1_epi8('\\');
+  const __m128i space = _mm_set1_epi8(' ');
+  const __m128i tab = _mm_set1_epi8('\t');
+  for (size_t block = 0; block < block_count; ++block) {
+    uint64_t specials = 0;
+    uint64_t blanks = 0;
+    for (size_t i = 0; i < kBlockSize; i += sizeof(__m128i)) {
+      const __m128i chars = _mm_loadu_si128(
+          reinterpret_cast<const __m128i*>(data + block * kBlockSize + i));
+      // The comparison is signed: the control characters and the non-ASCII
+      // bytes are the ones less than ' '.
+      const __m128i special = _mm_or_si128(
+          _mm_or_si128(_mm_cmpeq_epi8(chars, quote),
+                       _mm_cmpeq_epi8(chars, backslash)),
+          _mm_cmplt_epi8(chars, space));
+      const __m128i blank = _mm_or_si128(_mm_cmpeq_epi8(chars, space),
+                                         _mm_cmpeq_epi8(chars, tab));
+      specials |= static_cast<uint64_t>(static_cast<uint16_t>(
+                      _mm_movemask_epi8(special)))
+                  << i;
+      blanks |= static_cast<uint64_t>(
+                    static_cast<uint16_t>(_mm_movemask_epi8(blank)))
+                << i;
+    }
+    string_specials[block] = specials;
+    non_blanks[block] = ~blanks;
+  }
+}
+
+__attribute__((target("avx2"))) void ClassifyBlocksAVX2(
+    const char* data,
+    size_t block_count,
+    uint64_t* string_specials,
+    uint64_t* non_blanks) {
+  const __m256i quote = _mm256_set1_epi8('"');
+  const __m256i backslash = _mm256_set1_epi8('\\');
+  const __m256i space = _mm256_set1_epi8(' ');
+  const __m256i tab = _mm256_set1_epi8('\t');
+  for (size_t block = 0; block < block_count; ++block) {
+    uint64_t specials = 0;
+    uint64_t blanks = 0;
+    for (size_t i = 0; i < kBlockSize; i += sizeof(__m256i)) {
+      const __m256i chars = _mm256_loadu_si256(
+          reinterpret_cast<const __m256i*>(data + block * kBlockSize + i));
+      const __m256i special = _mm256_or_si256(
+          _mm256_or_si256(_mm256_cmpeq_epi8(chars, quote),
+                          _mm256_cmpeq_epi8(chars, backslash)),
+          _mm256_cmpgt_epi8(space, chars));
+      const __m256i blank = _mm256_or_si256(_mm256_cmpeq_epi8(chars, space),
+                                            _mm256_cmpeq_epi8(chars, tab));
+      specials |= static_cast<uint64_t>(static_cast<uint32_t>(
+                      _mm256_movemask_epi8(special)))
+                  << i;
+      blanks |= static_cast<uint64_t>(
+                    static_cast<uint32_t>(_mm256_movemask_epi8(blank)))
+                << i;
+    }
+    string_specials[block] = specials;
+    non_blanks[block] = ~blanks;
+  }
+}
+
+#elif defined(ARCH_CPU_ARM64)
+
+// Returns the bitmask of the 64 bytes of |v0| to |v3|, whose bytes are 0x00
+// or 0xff, as _mm_movemask_epi8() would.
+uint64_t ToBitmask(uint8x16_t v0,
+                   uint8x16_t v1,
+                   uint8x16_t v2,
+                   uint8x16_t v3) {
+  const uint8x16_t bits = {0x01, 0x02, 0x04, 0x08, 0x10, 0x20, 0x40, 0x80,
+                           0x01, 0x02, 0x04, 0x08, 0x10, 0x20, 0x40, 0x80};
+  uint8x16_t sum0 = vpaddq_u8(vandq_u8(v0, bits), vandq_u8(v1, bits));
+  uint8x16_t sum1 = vpaddq_u8(vandq_u8(v2, bits), vandq_u8(v3, bits));
+  sum0 = vpaddq_u8(sum0, sum1);
+  sum0 = vpaddq_u8(sum0, sum0);
+  return vgetq_lane_u64(vreinterpretq_u64_u8(sum0), 0);
+}
+
+void ClassifyBlocksNEON(const char* data,
+                        size_t block_count,
+                        uint64_t* string_specials,
+                        uint64_t* non_blanks) {
+  const uint8x16_t quote = vdupq_n_u8('"');
+  const uint8x16_t backslash = vdupq_n_u8('\\');
+  const uint8x16_t space = vdupq_n_u8(' ');
+  const uint8x16_t tab = vdupq_n_u8('\t');
+  const uint8x16_t non_ascii = vdupq_n_u8(0x80);
+  uint8x16_t specials[4];
+  uint8x16_t blanks[4];
+  for (size_t block = 0; block < block_count; ++block) {
+    for (size_t i = 0; i < 4; ++i) {
+      const uint8x16_t chars = vld1q_u8(reinterpret_cast<const uint8_t*>(
+          data + block * kBlockSize + i * sizeof(uint8x16_t)));
+      specials[i] = vorrq_u8(
+          vorrq_u8(vceqq_u8(chars, quote), vceqq_u8(chars, backslash)),
+          vorrq_u8(vcltq_u8(chars, space), vcgeq_u8(chars, non_ascii)));
+      blanks[i] = vorrq_u8(vceqq_u8(chars, space), vceqq_u8(chars, tab));
+    }
+    string_specials[block] =
+        ToBitmask(specials[0], specials[1], specials[2], specials[3]);
+    non_blanks[block] =
+        ~ToBitmask(blanks[0], blanks[1], blanks[2], blanks[3]);
+  }
+}
+
+#endif
+
+ClassifyBlocksFunction GetClassifyBlocksFunction() {
+#if defined(ARCH_CPU_X86_64)
+  static const bool has_avx2 = CPU().has_avx2();
+  return has_avx2 ? &ClassifyBlocksAVX2 : &ClassifyBlocksSSE2;
+#elif defined(ARCH_CPU_ARM64)
+  return &ClassifyBlocksNEON;
+#else
+  return &ClassifyBlocksUnvectorized;
+#endif
+}
+
+}  // namespace
+
+JSONStructuralIndex::JSONStructuralIndex(StringPiece input)
+    : size_(input.size()),
+      string_specials_(input.size() / kBlockSize + 1),
+      non_blanks_(input.size() / kBlockSize + 1) {
+  const size_t full_blocks = input.size() / kBlockSize;
+  GetClassifyBlocksFunction()(input.data(), full_blocks,
+                              string_specials_.data(), non_blanks_.data());
+
+  // The last, partial block is padded with quotes, which are both string
+  // specials and non-blanks.
+  char last_block[kBlockSize];
+  memset(last_block, '"', kBlockSize);
+  memcpy(last_block, input.data() + full_blocks * kBlockSize,
+         input.size() - full_blocks * kBlockSize);
+  ClassifyBlocksUnvectorized(last_block, 1, &string_specials_[full_blocks],
+                             &non_blanks_[full_blocks]);
+}
+
+JSONStructuralIndex::~JSONStructuralIndex() = default;
+
+size_t JSONStructuralIndex::NextSetBit(const std::vector<uint64_t>& bitmap,
+                                       size_t index) const {
+  DCHECK_LE(index, size_);
+  size_t word = index / kBlockSize;
+  uint64_t bits = bitmap[word] & (~uint64_t{0} << (index % kBlockSize));
+  while (!bits)
+    bits = bitmap[++word];
+  return std::min(word * kBlockSize + bits::CountTrailingZeroBits(bits),
+                  size_);
+}
+
+}  // namespace internal
+}  // namespace base
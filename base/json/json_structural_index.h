@@ -0,0 +1,66 @@
+// Copyright 2022 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#ifndef BASE_JSON_JSON_STRUCTURAL_INDEX_H_
+#define BASE_JSON_JSON_STRUCTURAL_INDEX_H_
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include <vector>
+
+#include "base/base_export.h"
+#include "base/strings/string_piece.h"
+
+namespace base {
+namespace internal {
+
+// The first stage of parsing large inputs, in the style of simdjson: a SIMD
+// pass over the input classifies each byte, and records the classes in
+// bitmaps, one bit per byte. The second stage, JSONParser, which still owns
+// the grammar, the options and the error reporting, consults them to skip
+// over runs of bytes which need no decoding, instead of going through them
+// one at a time.
+//
+// Escapes need no carry from one block to the next, unlike in simdjson: any
+// backslash stops a run, so the parser decodes the escape sequence itself.
+class BASE_EXPORT JSONStructuralIndex {
+ public:
+  // The bytes are classified by blocks of kBlockSize, one word per block.
+  static constexpr size_t kBlockSize = 64;
+
+  // |input| must outlive the index.
+  explicit JSONStructuralIndex(StringPiece input);
+
+  JSONStructuralIndex(const JSONStructuralIndex&) = delete;
+  JSONStructuralIndex& operator=(const JSONStructuralIndex&) = delete;
+
+  ~JSONStructuralIndex();
+
+  // Returns the index of the first byte at or after |index| which can't be
+  // copied as is into a string: a quote, a backslash, a control character or
+  // a non-ASCII byte, or the size of the input if there is none.
+  size_t NextStringSpecial(size_t index) const {
+    return NextSetBit(string_specials_, index);
+  }
+
+  // Returns the index of the first byte at or after |index| which is not a
+  // space or a tab, or the size of the input if there is none.
+  size_t NextNonBlank(size_t index) const {
+    return NextSetBit(non_blanks_, index);
+  }
+
+ private:
+  size_t NextSetBit(const std::vector<uint64_t>& bitmap, size_t index) const;
+
+  const size_t size_;
+  // The bits past the end of the input are set, so that searches stop there.
+  std::vector<uint64_t> string_specials_;
+  std::vector<uint64_t> non_blanks_;
+};
+
+}  // namespace internal
+}  // namespace base
+
+#endif  // BASE_JSON_JSON_STRUCTURAL_INDEX_H_
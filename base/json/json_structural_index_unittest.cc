@@ -0,0 +1,80 @@
+// Copyright 2022 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "base/json/json_structural_index.h"
+
+#include <string>
+
+#include "base/rand_util.h"
+#include "testing/gtest/include/gtest/gtest.h"
+
+namespace base {
+namespace internal {
+
+namespace {
+
+size_t NextStringSpecial(const std::string& input, size_t index) {
+  for (; index < input.size(); ++index) {
+    const uint8_t c = static_cast<uint8_t>(input[index]);
+    if (c == '"' || c == '\\' || c < 0x20 || c >= 0x80)
+      break;
+  }
+  return index;
+}
+
+size_t NextNonBlank(const std::string& input, size_t index) {
+  while (index < input.size() && (input[index] == ' ' || input[index] == '\t'))
+    ++index;
+  return index;
+}
+
+}  // namespace
+
+TEST(JSONStructuralIndexTest, Empty) {
+  JSONStructuralIndex index("");
+  EXPECT_EQ(0u, index.NextStringSpecial(0));
+  EXPECT_EQ(0u, index.NextNonBlank(0));
+}
+
+TEST(JSONStructuralIndexTest, Simple) {
+  const std::string input = "{ \"key\":\t\t\"va\\\"lue\xC3\xA9\" }";
+  JSONStructuralIndex index(input);
+  EXPECT_EQ(2u, index.NextStringSpecial(0));
+  EXPECT_EQ(6u, index.NextStringSpecial(3));
+  // Tabs are control characters.
+  EXPECT_EQ(8u, index.NextStringSpecial(7));
+  EXPECT_EQ(13u, index.NextStringSpecial(11));
+  EXPECT_EQ(18u, index.NextStringSpecial(15));
+  EXPECT_EQ(input.size(), index.NextStringSpecial(input.size() - 1));
+  EXPECT_EQ(2u, index.NextNonBlank(1));
+  EXPECT_EQ(10u, index.NextNonBlank(8));
+  EXPECT_EQ(input.size() - 1, index.NextNonBlank(input.size() - 2));
+  EXPECT_EQ(input.size(), index.NextNonBlank(input.size()));
+}
+
+// Crosses block boundaries, and checks the partial last block.
+TEST(JSONStructuralIndexTest, MatchesByteByByteScan) {
+  const char kAlphabet[] = "ab \t\"\\\n\x01\x7f\x80\xff{}:,";
+  for (size_t size : {1u, 63u, 64u, 65u, 200u, 1000u}) {
+    std::string input;
+    for (size_t i = 0; i < size; ++i)
+      input += kAlphabet[RandGenerator(sizeof(kAlphabet) - 1)];
+    JSONStructuralIndex index(input);
+    for (size_t i = 0; i <= size; ++i) {
+      EXPECT_EQ(NextStringSpecial(input, i), index.NextStringSpecial(i));
+      EXPECT_EQ(NextNonBlank(input, i), index.NextNonBlank(i));
+    }
+  }
+}
+
+TEST(JSONStructuralIndexTest, LongRuns) {
+  std::string input = std::string(1000, ' ') + std::string(1000, 'x') + "\"";
+  JSONStructuralIndex index(input);
+  EXPECT_EQ(1000u, index.NextNonBlank(0));
+  EXPECT_EQ(2000u, index.NextStringSpecial(0));
+  EXPECT_EQ(2000u, index.NextStringSpecial(1500));
+}
+
+}  // namespace internal
+}  // namespace base
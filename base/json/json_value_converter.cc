@@ -4,11 +4,296 @@
 
 #include "base/json/json_value_converter.h"
 
+#include "base/bits.h"
+#include "base/check_op.h"
+#include "base/json/json_reader.h"
+#include "base/notreached.h"
 #include "base/strings/utf_string_conversions.h"
 
 namespace base {
 namespace internal {
 
+namespace {
+
+// Seeded FNV-1a.
+uint32_t HashKey(StringPiece key, uint32_t seed) {
+  uint32_t hash = 2166136261u ^ seed;
+  for (char c : key) {
+    hash ^= static_cast<uint8_t>(c);
+    hash *= 16777619u;
+  }
+  return hash ^ (hash >> 16);
+}
+
+// Routes the events of JSONReader::ReadStreaming() to the converters of the
+// fields they're for.
+class ConvertingHandler : public JSONStreamingHandler {
+ public:
+  explicit ConvertingHandler(JSONEventConverter::Target root) : next_(root) {}
+
+  ConvertingHandler(const ConvertingHandler&) = delete;
+  ConvertingHandler& operator=(const ConvertingHandler&) = delete;
+
+  ~ConvertingHandler() override = default;
+
+  bool OnStartDict() override {
+    if (skipped_depth_ > 0) {
+      ++skipped_depth_;
+      return true;
+    }
+    if (!built_values_.empty()) {
+      built_values_.emplace_back(Value::Type::DICT);
+      return true;
+    }
+    const JSONEventConverter::Target target = TakeTarget();
+    if (!target.converter) {
+      skipped_depth_ = 1;
+      return true;
+    }
+    if (!target.converter->ConvertsDictItems())
+      return StartBuilding(target, Value::Type::DICT);
+    containers_.push_back({target, /*is_list=*/false});
+    return true;
+  }
+
+  bool OnKey(StringPiece key) override {
+    if (skipped_depth_ > 0)
+      return true;
+    if (!built_values_.empty()) {
+      built_keys_.emplace_back(key);
+      return true;
+    }
+    const Container& dict = containers_.back();
+    next_ = dict.target.converter->GetKeyTarget(key, dict.target.field);
+    return true;
+  }
+
+  bool OnEndDict() override { return OnEndContainer(); }
+
+  bool OnStartList() override {
+    if (skipped_depth_ > 0) {
+      ++skipped_depth_;
+      return true;
+    }
+    if (!built_values_.empty()) {
+      built_values_.emplace_back(Value::Type::LIST);
+      return true;
+    }
+    const JSONEventConverter::Target target = TakeTarget();
+    if (!target.converter) {
+      skipped_depth_ = 1;
+      return true;
+    }
+    if (!target.converter->ConvertsListItems())
+      return StartBuilding(target, Value::Type::LIST);
+    containers_.push_back({target, /*is_list=*/true});
+    return true;
+  }
+
+  bool OnEndList() override { return OnEndContainer(); }
+
+  bool OnString(StringPiece value) override {
+    if (skipped_depth_ > 0)
+      return true;
+    if (!built_values_.empty())
+      return AddBuiltValue(Value(value));
+    const JSONEventConverter::Target target = TakeTarget();
+    return !target.converter ||
+           target.converter->ConvertString(value, target.field);
+  }
+
+  bool OnInt(int value) override {
+    if (skipped_depth_ > 0)
+      return true;
+    if (!built_values_.empty())
+      return AddBuiltValue(Value(value));
+    const JSONEventConverter::Target target = TakeTarget();
+    return !target.converter ||
+           target.converter->ConvertInt(value, target.field);
+  }
+
+  bool OnDouble(double value) override {
+    if (skipped_depth_ > 0)
+      return true;
+    if (!built_values_.empty())
+      return AddBuiltValue(Value(value));
+    const JSONEventConverter::Target target = TakeTarget();
+    return !target.converter ||
+           target.converter->ConvertDouble(value, target.field);
+  }
+
+  bool OnBool(bool value) override {
+    if (skipped_depth_ > 0)
+      return true;
+    if (!built_values_.empty())
+      return AddBuiltValue(Value(value));
+    const JSONEventConverter::Target target = TakeTarget();
+    return !target.converter ||
+           target.converter->ConvertBool(value, target.field);
+  }
+
+  bool OnNull() override {
+    if (skipped_depth_ > 0)
+      return true;
+    if (!built_values_.empty())
+      return AddBuiltValue(Value());
+    const JSONEventConverter::Target target = TakeTarget();
+    return !target.converter || target.converter->ConvertNull(target.field);
+  }
+
+ private:
+  // A dictionary or a list whose items are being converted.
+  struct Container {
+    JSONEventConverter::Target target;
+    bool is_list;
+  };
+
+  // Returns the target of the value that starts: the next item of the list
+  // being converted, or the value of the last key.
+  JSONEventConverter::Target TakeTarget() {
+    if (!containers_.empty() && containers_.back().is_list) {
+      const JSONEventConverter::Target& list = containers_.back().target;
+      return list.converter->GetItemTarget(list.field);
+    }
+    JSONEventConverter::Target target = next_;
+    next_ = {};
+    return target;
+  }
+
+  // Builds the Value of a dictionary or a list for |target|.
+  bool StartBuilding(JSONEventConverter::Target target, Value::Type type) {
+    built_target_ = target;
+    built_values_.emplace_back(type);
+    return true;
+  }
+
+  // Adds |value| to the Value being built, and converts it if it's complete.
+  bool AddBuiltValue(Value value) {
+    if (built_values_.empty())
+      return built_target_.converter->ConvertValue(std::move(value),
+                                                   built_target_.field);
+    Value& container = built_values_.back();
+    if (container.is_list()) {
+      container.GetList().Append(std::move(value));
+    } else {
+      container.GetDict().Set(built_keys_.back(), std::move(value));
+      built_keys_.pop_back();
+    }
+    return true;
+  }
+
+  bool OnEndContainer() {
+    if (skipped_depth_ > 0) {
+      --skipped_depth_;
+      return true;
+    }
+    if (!built_values_.empty()) {
+      Value value = std::move(built_values_.back());
+      built_values_.pop_back();
+      return AddBuiltValue(std::move(value));
+    }
+    containers_.pop_back();
+    return true;
+  }
+
+  // The target of the next value, unless it's an item of a list.
+  JSONEventConverter::Target next_;
+  std::vector<Container> containers_;
+
+  // The depth of the value being skipped, if any.
+  size_t skipped_depth_ = 0;
+
+  // The containers of the Value being built for |built_target_|, if any, and
+  // the keys of the dictionaries among them.
+  JSONEventConverter::Target built_target_;
+  std::vector<Value> built_values_;
+  std::vector<std::string> built_keys_;
+};
+
+}  // namespace
+
+bool JSONEventConverter::ConvertInt(int value, void* field) const {
+  return ConvertValue(Value(value), field);
+}
+
+bool JSONEventConverter::ConvertDouble(double value, void* field) const {
+  return ConvertValue(Value(value), field);
+}
+
+bool JSONEventConverter::ConvertBool(bool value, void* field) const {
+  return ConvertValue(Value(value), field);
+}
+
+bool JSONEventConverter::ConvertString(StringPiece value, void* field) const {
+  return ConvertValue(Value(value), field);
+}
+
+bool JSONEventConverter::ConvertNull(void* field) const {
+  return ConvertValue(Value(), field);
+}
+
+bool JSONEventConverter::ConvertsDictItems() const {
+  return false;
+}
+
+bool JSONEventConverter::ConvertsListItems() const {
+  return false;
+}
+
+JSONEventConverter::Target JSONEventConverter::GetKeyTarget(StringPiece key,
+                                                            void* field) const {
+  NOTREACHED();
+  return {};
+}
+
+JSONEventConverter::Target JSONEventConverter::GetItemTarget(
+    void* field) const {
+  NOTREACHED();
+  return {};
+}
+
+bool ConvertJSON(StringPiece json, JSONEventConverter::Target root) {
+  ConvertingHandler handler(root);
+  return JSONReader::ReadStreaming(json, &handler);
+}
+
+PerfectHashIndex::PerfectHashIndex() = default;
+
+PerfectHashIndex::~PerfectHashIndex() = default;
+
+void PerfectHashIndex::Init(std::vector<std::string> keys) {
+  DCHECK_LT(keys.size(), 0xffffu);
+  keys_ = std::move(keys);
+  if (keys_.empty())
+    return;
+  // With twice as many slots as keys, a few seeds usually suffice. Grow the
+  // table if none does.
+  constexpr uint32_t kMaxSeeds = 64;
+  for (int log_size = bits::Log2Ceiling(static_cast<uint32_t>(keys_.size() * 2));; ++log_size) {
+    const uint32_t mask = (1u << log_size) - 1;
+    for (seed_ = 0; seed_ < kMaxSeeds; ++seed_) {
+      slots_.assign(mask + 1, 0);
+      bool collided = false;
+      for (size_t i = 0; i < keys_.size() && !collided; ++i) {
+        uint16_t& slot = slots_[HashKey(keys_[i], seed_) & mask];
+        collided = slot != 0;
+        slot = static_cast<uint16_t>(i + 1);
+      }
+      if (!collided)
+        return;
+    }
+  }
+}
+
+int PerfectHashIndex::Find(StringPiece key) const {
+  if (slots_.empty())
+    return -1;
+  const uint16_t slot = slots_[HashKey(key, seed_) & (slots_.size() - 1)];
+  if (slot == 0 || keys_[slot - 1] != key)
+    return -1;
+  return slot - 1;
+}
+
 bool BasicValueConverter<int>::Convert(
     const base::Value& value, int* field) const {
   if (!value.is_int())
@@ -18,6 +303,11 @@ bool BasicValueConverter<int>::Convert(
   return true;
 }
 
+bool BasicValueConverter<int>::ConvertInt(int value, void* field) const {
+  *static_cast<int*>(field) = value;
+  return true;
+}
+
 bool BasicValueConverter<std::string>::Convert(
     const base::Value& value, std::string* field) const {
   if (!value.is_string())
@@ -27,6 +317,12 @@ bool BasicValueConverter<std::string>::Convert(
   return true;
 }
 
+bool BasicValueConverter<std::string>::ConvertString(StringPiece value,
+                                                     void* field) const {
+  static_cast<std::string*>(field)->assign(value.data(), value.size());
+  return true;
+}
+
 bool BasicValueConverter<std::u16string>::Convert(const base::Value& value,
                                                   std::u16string* field) const {
   if (!value.is_string())
@@ -36,6 +332,12 @@ bool BasicValueConverter<std::u16string>::Convert(const base::Value& value,
   return true;
 }
 
+bool BasicValueConverter<std::u16string>::ConvertString(StringPiece value,
+                                                        void* field) const {
+  *static_cast<std::u16string*>(field) = base::UTF8ToUTF16(value);
+  return true;
+}
+
 bool BasicValueConverter<double>::Convert(
     const base::Value& value, double* field) const {
   if (!value.is_double() && !value.is_int())
@@ -45,6 +347,17 @@ bool BasicValueConverter<double>::Convert(
   return true;
 }
 
+bool BasicValueConverter<double>::ConvertInt(int value, void* field) const {
+  *static_cast<double*>(field) = value;
+  return true;
+}
+
+bool BasicValueConverter<double>::ConvertDouble(double value,
+                                                void* field) const {
+  *static_cast<double*>(field) = value;
+  return true;
+}
+
 bool BasicValueConverter<bool>::Convert(
     const base::Value& value, bool* field) const {
   if (!value.is_bool())
@@ -54,6 +367,11 @@ bool BasicValueConverter<bool>::Convert(
   return true;
 }
 
+bool BasicValueConverter<bool>::ConvertBool(bool value, void* field) const {
+  *static_cast<bool*>(field) = value;
+  return true;
+}
+
 }  // namespace internal
 }  // namespace base
 
@@ -6,6 +6,7 @@
 #define BASE_JSON_JSON_VALUE_CONVERTER_H_
 
 #include <stddef.h>
+#include <stdint.h>
 
 #include <memory>
 #include <string>
@@ -13,9 +14,11 @@
 #include <vector>
 
 #include "base/base_export.h"
+#include "base/containers/contains.h"
 #include "base/logging.h"
 #include "base/memory/ptr_util.h"
 #include "base/strings/string_piece.h"
+#include "base/strings/string_util.h"
 #include "base/values.h"
 
 // JSONValueConverter converts a JSON value into a C++ struct in a
@@ -83,6 +86,16 @@
 //           "your_enum", &Message::ye, &ConvertFunc);
 //     }
 //   };
+//
+// ConvertJSON() parses a JSON string directly into the struct, instead of
+// parsing it into a Value first:
+//   converter.ConvertJSON(json_string, &message);
+// Each field is converted as it's parsed, and the fields are found by a
+// perfect hash of their names built when the converter is constructed, so
+// keep the converter around when converting many messages. Only the values
+// of the fields registered with RegisterCustomValueField() or
+// RegisterRepeatedCustomValue() are built as Values, for their conversion
+// functions.
 
 namespace base {
 
@@ -91,6 +104,65 @@ class JSONValueConverter;
 
 namespace internal {
 
+// Converts the parsed values of JSONValueConverter::ConvertJSON() into
+// fields. |field| points to the field type of the implementation, as
+// JSONValueConverter::ConvertJSON() doesn't know the types of the fields.
+class BASE_EXPORT JSONEventConverter {
+ public:
+  // Where a value goes. A null |converter| skips the value.
+  struct Target {
+    const JSONEventConverter* converter = nullptr;
+    void* field = nullptr;
+  };
+
+  virtual ~JSONEventConverter() = default;
+
+  // Convert a value. Return false if it doesn't match the field. The scalar
+  // ones default to ConvertValue().
+  virtual bool ConvertValue(Value value, void* field) const = 0;
+  virtual bool ConvertInt(int value, void* field) const;
+  virtual bool ConvertDouble(double value, void* field) const;
+  virtual bool ConvertBool(bool value, void* field) const;
+  virtual bool ConvertString(StringPiece value, void* field) const;
+  virtual bool ConvertNull(void* field) const;
+
+  // Whether the items of a dictionary or of a list are converted as they're
+  // parsed, into the targets returned by GetKeyTarget() or GetItemTarget().
+  // Otherwise, the dictionary or the list is built as a Value and passed to
+  // ConvertValue().
+  virtual bool ConvertsDictItems() const;
+  virtual bool ConvertsListItems() const;
+  virtual Target GetKeyTarget(StringPiece key, void* field) const;
+  virtual Target GetItemTarget(void* field) const;
+};
+
+// Parses |json| into |root|. Returns false if |json| isn't valid JSON, or if
+// a converter fails.
+BASE_EXPORT bool ConvertJSON(StringPiece json,
+                             JSONEventConverter::Target root);
+
+// The indices of a set of distinct keys, found by a perfect hash of the keys:
+// Find() hashes the key once, and compares it with a single candidate.
+class BASE_EXPORT PerfectHashIndex {
+ public:
+  PerfectHashIndex();
+  PerfectHashIndex(const PerfectHashIndex&) = delete;
+  PerfectHashIndex& operator=(const PerfectHashIndex&) = delete;
+  ~PerfectHashIndex();
+
+  // Picks a seed and a table size for which |keys| don't collide.
+  void Init(std::vector<std::string> keys);
+
+  // Returns the index of |key| in the keys passed to Init(), or -1.
+  int Find(StringPiece key) const;
+
+ private:
+  std::vector<std::string> keys_;
+  // The index of the key of each slot plus one, or 0 for an empty slot.
+  std::vector<uint16_t> slots_;
+  uint32_t seed_ = 0;
+};
+
 template<typename StructType>
 class FieldConverterBase {
  public:
@@ -102,6 +174,8 @@ class FieldConverterBase {
   virtual ~FieldConverterBase() = default;
   virtual bool ConvertField(const base::Value& value, StructType* obj)
       const = 0;
+  // The target of the value of the field of |obj|, for ConvertJSON().
+  virtual JSONEventConverter::Target GetTarget(StructType* obj) const = 0;
   const std::string& field_path() const { return field_path_; }
 
  private:
@@ -109,10 +183,14 @@ class FieldConverterBase {
 };
 
 template <typename FieldType>
-class ValueConverter {
+class ValueConverter : public JSONEventConverter {
  public:
-  virtual ~ValueConverter() = default;
+  ~ValueConverter() override = default;
   virtual bool Convert(const base::Value& value, FieldType* field) const = 0;
+
+  bool ConvertValue(Value value, void* field) const override {
+    return Convert(value, static_cast<FieldType*>(field));
+  }
 };
 
 template <typename StructType, typename FieldType>
@@ -133,6 +211,10 @@ class FieldConverter : public FieldConverterBase<StructType> {
     return value_converter_->Convert(value, &(dst->*field_pointer_));
   }
 
+  JSONEventConverter::Target GetTarget(StructType* obj) const override {
+    return {value_converter_.get(), &(obj->*field_pointer_)};
+  }
+
  private:
   FieldType StructType::* field_pointer_;
   std::unique_ptr<ValueConverter<FieldType>> value_converter_;
@@ -150,6 +232,7 @@ class BASE_EXPORT BasicValueConverter<int> : public ValueConverter<int> {
   BasicValueConverter& operator=(const BasicValueConverter&) = delete;
 
   bool Convert(const base::Value& value, int* field) const override;
+  bool ConvertInt(int value, void* field) const override;
 };
 
 template <>
@@ -162,6 +245,7 @@ class BASE_EXPORT BasicValueConverter<std::string>
   BasicValueConverter& operator=(const BasicValueConverter&) = delete;
 
   bool Convert(const base::Value& value, std::string* field) const override;
+  bool ConvertString(StringPiece value, void* field) const override;
 };
 
 template <>
@@ -174,6 +258,7 @@ class BASE_EXPORT BasicValueConverter<std::u16string>
   BasicValueConverter& operator=(const BasicValueConverter&) = delete;
 
   bool Convert(const base::Value& value, std::u16string* field) const override;
+  bool ConvertString(StringPiece value, void* field) const override;
 };
 
 template <>
@@ -185,6 +270,8 @@ class BASE_EXPORT BasicValueConverter<double> : public ValueConverter<double> {
   BasicValueConverter& operator=(const BasicValueConverter&) = delete;
 
   bool Convert(const base::Value& value, double* field) const override;
+  bool ConvertInt(int value, void* field) const override;
+  bool ConvertDouble(double value, void* field) const override;
 };
 
 template <>
@@ -196,6 +283,7 @@ class BASE_EXPORT BasicValueConverter<bool> : public ValueConverter<bool> {
   BasicValueConverter& operator=(const BasicValueConverter&) = delete;
 
   bool Convert(const base::Value& value, bool* field) const override;
+  bool ConvertBool(bool value, void* field) const override;
 };
 
 template <typename FieldType>
@@ -232,6 +320,10 @@ class CustomFieldConverter : public ValueConverter<FieldType> {
     return value.is_string() && convert_func_(value.GetString(), field);
   }
 
+  bool ConvertString(StringPiece value, void* field) const override {
+    return convert_func_(value, static_cast<FieldType*>(field));
+  }
+
  private:
   ConvertFunc convert_func_;
 };
@@ -248,6 +340,15 @@ class NestedValueConverter : public ValueConverter<NestedType> {
     return converter_.Convert(value, field);
   }
 
+  bool ConvertsDictItems() const override {
+    return converter_.fields_table_.ConvertsDictItems();
+  }
+
+  JSONEventConverter::Target GetKeyTarget(StringPiece key,
+                                          void* field) const override {
+    return converter_.fields_table_.GetKeyTarget(key, field);
+  }
+
  private:
   JSONValueConverter<NestedType> converter_;
 };
@@ -283,6 +384,15 @@ class RepeatedValueConverter
     return true;
   }
 
+  bool ConvertsListItems() const override { return true; }
+
+  JSONEventConverter::Target GetItemTarget(void* field) const override {
+    auto* elements =
+        static_cast<std::vector<std::unique_ptr<Element>>*>(field);
+    elements->push_back(std::make_unique<Element>());
+    return {&basic_converter_, elements->back().get()};
+  }
+
  private:
   BasicValueConverter<Element> basic_converter_;
 };
@@ -316,8 +426,17 @@ class RepeatedMessageConverter
     return true;
   }
 
+  bool ConvertsListItems() const override { return true; }
+
+  JSONEventConverter::Target GetItemTarget(void* field) const override {
+    auto* elements =
+        static_cast<std::vector<std::unique_ptr<NestedType>>*>(field);
+    elements->push_back(std::make_unique<NestedType>());
+    return {&converter_, elements->back().get()};
+  }
+
  private:
-  JSONValueConverter<NestedType> converter_;
+  NestedValueConverter<NestedType> converter_;
 };
 
 template <typename NestedType>
@@ -357,14 +476,116 @@ class RepeatedCustomValueConverter
   ConvertFunc convert_func_;
 };
 
+// The fields of a StructType whose paths start with the same components, by
+// the next component of their paths, for ConvertJSON(). The table of the
+// struct itself, whose fields have no common component, is the root.
+template <typename StructType>
+class FieldsTable : public JSONEventConverter {
+ public:
+  // |converter| is the converter of the struct for the root, or null.
+  explicit FieldsTable(const JSONValueConverter<StructType>* converter)
+      : converter_(converter) {}
+
+  FieldsTable(const FieldsTable&) = delete;
+  FieldsTable& operator=(const FieldsTable&) = delete;
+
+  // Builds the table of |fields|, with paths stripped of the components
+  // before this table. Returns false if two fields have the same path, or if
+  // the path of one is a prefix of the path of another, which ConvertJSON()
+  // can't convert while parsing.
+  bool Init(const std::vector<std::pair<StringPiece,
+                                        const FieldConverterBase<StructType>*>>&
+                fields) {
+    std::vector<std::string> keys;
+    for (size_t i = 0; i < fields.size(); ++i) {
+      const StringPiece path = fields[i].first;
+      const size_t dot_index = path.find('.');
+      const StringPiece key = path.substr(0, dot_index);
+      if (Contains(keys, key))
+        continue;
+
+      // Gather the fields below |key|.
+      std::vector<
+          std::pair<StringPiece, const FieldConverterBase<StructType>*>>
+          subfields;
+      Entry entry;
+      for (size_t j = i; j < fields.size(); ++j) {
+        const StringPiece other_path = fields[j].first;
+        if (other_path == key) {
+          if (entry.field)
+            return false;
+          entry.field = fields[j].second;
+        } else if (StartsWith(other_path, key) &&
+                   other_path[key.size()] == '.') {
+          subfields.emplace_back(other_path.substr(key.size() + 1),
+                                 fields[j].second);
+        }
+      }
+      if (!subfields.empty()) {
+        if (entry.field)
+          return false;
+        entry.table = std::make_unique<FieldsTable>(nullptr);
+        if (!entry.table->Init(subfields))
+          return false;
+      }
+      keys.emplace_back(key);
+      entries_.push_back(std::move(entry));
+    }
+    index_.Init(std::move(keys));
+    return true;
+  }
+
+  // JSONEventConverter:
+  bool ConvertValue(Value value, void* field) const override {
+    // Like FindPath(), skip the fields below an entry that isn't a
+    // dictionary. The struct gets here if it isn't a dictionary, or if its
+    // converter can't convert while parsing.
+    if (!converter_)
+      return true;
+    return converter_->Convert(value, static_cast<StructType*>(field));
+  }
+
+  bool ConvertsDictItems() const override {
+    return !converter_ || converter_->converts_dict_items_;
+  }
+
+  JSONEventConverter::Target GetKeyTarget(StringPiece key,
+                                          void* field) const override {
+    const int index = index_.Find(key);
+    if (index < 0)
+      return {};
+    const Entry& entry = entries_[index];
+    if (entry.field)
+      return entry.field->GetTarget(static_cast<StructType*>(field));
+    return {entry.table.get(), field};
+  }
+
+ private:
+  // Either a field, or the table of the fields below a key.
+  struct Entry {
+    const FieldConverterBase<StructType>* field = nullptr;
+    std::unique_ptr<FieldsTable> table;
+  };
+
+  const JSONValueConverter<StructType>* const converter_;
+  std::vector<Entry> entries_;
+  PerfectHashIndex index_;
+};
 
 }  // namespace internal
 
 template <class StructType>
 class JSONValueConverter {
  public:
-  JSONValueConverter() {
+  JSONValueConverter() : fields_table_(this) {
     StructType::RegisterJSONConverter(this);
+
+    std::vector<
+        std::pair<StringPiece, const internal::FieldConverterBase<StructType>*>>
+        fields;
+    for (const auto& field : fields_)
+      fields.emplace_back(field->field_path(), field.get());
+    converts_dict_items_ = fields_table_.Init(fields);
   }
 
   JSONValueConverter(const JSONValueConverter&) = delete;
@@ -521,9 +742,28 @@ class JSONValueConverter {
     return true;
   }
 
+  // Like Convert(), but parses |json| directly into |output|, without a
+  // Value tree. Returns false if |json| isn't valid JSON as well. The fields
+  // are converted in the order of |json|, and a key that appears several
+  // times is converted each time.
+  bool ConvertJSON(StringPiece json, StructType* output) const {
+    return internal::ConvertJSON(json, {&fields_table_, output});
+  }
+
  private:
+  friend class internal::FieldsTable<StructType>;
+  template <typename NestedType>
+  friend class internal::NestedValueConverter;
+
   std::vector<std::unique_ptr<internal::FieldConverterBase<StructType>>>
       fields_;
+
+  // The fields by path, for ConvertJSON(). Only RegisterJSONConverter()
+  // registers fields, so it's built once they are.
+  internal::FieldsTable<StructType> fields_table_;
+  // False if some paths overlap, in which case ConvertJSON() parses |json|
+  // into a Value, and calls Convert().
+  bool converts_dict_items_ = false;
 };
 
 }  // namespace base
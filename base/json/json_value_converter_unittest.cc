@@ -9,6 +9,7 @@
 #include <vector>
 
 #include "base/json/json_reader.h"
+#include "base/strings/string_number_conversions.h"
 #include "base/strings/string_piece.h"
 #include "base/values.h"
 #include "testing/gtest/include/gtest/gtest.h"
@@ -91,6 +92,32 @@ struct NestedMessage {
   }
 };
 
+// Fields below intermediate dictionaries.
+struct DottedMessage {
+  int a_b = 0;
+  std::string a_c;
+  int d_e_f = 0;
+
+  static void RegisterJSONConverter(
+      base::JSONValueConverter<DottedMessage>* converter) {
+    converter->RegisterIntField("a.b", &DottedMessage::a_b);
+    converter->RegisterStringField("a.c", &DottedMessage::a_c);
+    converter->RegisterIntField("d.e.f", &DottedMessage::d_e_f);
+  }
+};
+
+// A field whose path is a prefix of the path of another.
+struct OverlappingMessage {
+  SimpleMessage a;
+  int a_foo = 0;
+
+  static void RegisterJSONConverter(
+      base::JSONValueConverter<OverlappingMessage>* converter) {
+    converter->RegisterNestedField("a", &OverlappingMessage::a);
+    converter->RegisterIntField("a.foo", &OverlappingMessage::a_foo);
+  }
+};
+
 }  // namespace
 
 TEST(JSONValueConverterTest, ParseSimpleMessage) {
@@ -258,4 +285,109 @@ TEST(JSONValueConverterTest, RepeatedValueErrorInTheMiddle) {
   // No check the values as mentioned above.
 }
 
+TEST(JSONValueConverterTest, ConvertJSON) {
+  const char normal_data[] =
+      "{\n"
+      "  \"foo\": 1.5,\n"
+      "  \"unknown\": {\"foo\": [1, {\"bar\": 2}], \"baz\": null},\n"
+      "  \"child\": {\n"
+      "    \"foo\": 1,\n"
+      "    \"bar\": \"b\\u0061r\",\n"
+      "    \"bstruct\": {},\n"
+      "    \"string_values\": [{\"val\": \"value_1\"}, {\"val\": \"value_2\"}],"
+      "    \"simple_enum\": \"bar\","
+      "    \"ints\": [1, 2],"
+      "    \"baz\": true\n"
+      "  },\n"
+      "  \"children\": [{\"foo\": 2}, {\"foo\": 3, \"baz\": true}]\n"
+      "}\n";
+
+  NestedMessage message;
+  base::JSONValueConverter<NestedMessage> converter;
+  EXPECT_TRUE(converter.ConvertJSON(normal_data, &message));
+
+  EXPECT_EQ(1.5, message.foo);
+  EXPECT_EQ(1, message.child.foo);
+  EXPECT_EQ("bar", message.child.bar);
+  EXPECT_TRUE(message.child.baz);
+  EXPECT_TRUE(message.child.bstruct);
+  EXPECT_EQ(SimpleMessage::BAR, message.child.simple_enum);
+  ASSERT_EQ(2U, message.child.ints.size());
+  EXPECT_EQ(1, *message.child.ints[0]);
+  EXPECT_EQ(2, *message.child.ints[1]);
+  ASSERT_EQ(2U, message.child.string_values.size());
+  EXPECT_EQ("value_1", *message.child.string_values[0]);
+  EXPECT_EQ("value_2", *message.child.string_values[1]);
+
+  ASSERT_EQ(2U, message.children.size());
+  EXPECT_EQ(2, message.children[0]->foo);
+  EXPECT_FALSE(message.children[0]->baz);
+  EXPECT_EQ(3, message.children[1]->foo);
+  EXPECT_TRUE(message.children[1]->baz);
+
+  // Same as Convert().
+  absl::optional<Value> value = base::JSONReader::Read(normal_data);
+  ASSERT_TRUE(value);
+  NestedMessage converted_message;
+  EXPECT_TRUE(converter.Convert(*value, &converted_message));
+  EXPECT_EQ(converted_message.child.bar, message.child.bar);
+}
+
+TEST(JSONValueConverterTest, ConvertJSONFailures) {
+  SimpleMessage message;
+  base::JSONValueConverter<SimpleMessage> converter;
+  EXPECT_FALSE(converter.ConvertJSON("{\"bar\": 2}", &message));
+  EXPECT_FALSE(converter.ConvertJSON("{\"foo\": {}}", &message));
+  EXPECT_FALSE(converter.ConvertJSON("{\"ints\": [1, false]}", &message));
+  EXPECT_FALSE(converter.ConvertJSON("{\"simple_enum\": \"baz\"}", &message));
+  EXPECT_FALSE(converter.ConvertJSON("{\"foo\": 1", &message));
+  EXPECT_FALSE(converter.ConvertJSON("[]", &message));
+  EXPECT_FALSE(converter.ConvertJSON("1", &message));
+  EXPECT_TRUE(converter.ConvertJSON("{}", &message));
+}
+
+TEST(JSONValueConverterTest, ConvertJSONDottedPaths) {
+  DottedMessage message;
+  base::JSONValueConverter<DottedMessage> converter;
+  EXPECT_TRUE(converter.ConvertJSON(
+      R"({"a": {"b": 1, "c": "x", "z": 2}, "d": {"e": {"f": 3}}})", &message));
+  EXPECT_EQ(1, message.a_b);
+  EXPECT_EQ("x", message.a_c);
+  EXPECT_EQ(3, message.d_e_f);
+
+  // As with FindPath(), an intermediate value that isn't a dictionary has no
+  // fields.
+  DottedMessage other_message;
+  EXPECT_TRUE(
+      converter.ConvertJSON(R"({"a": [1], "d": {"e": 2}})", &other_message));
+  EXPECT_EQ(0, other_message.a_b);
+  EXPECT_EQ(0, other_message.d_e_f);
+}
+
+TEST(JSONValueConverterTest, ConvertJSONOverlappingPaths) {
+  OverlappingMessage message;
+  base::JSONValueConverter<OverlappingMessage> converter;
+  EXPECT_TRUE(converter.ConvertJSON(R"({"a": {"foo": 2, "bar": "x"}})",
+                                    &message));
+  EXPECT_EQ(2, message.a.foo);
+  EXPECT_EQ("x", message.a.bar);
+  EXPECT_EQ(2, message.a_foo);
+}
+
+TEST(JSONValueConverterTest, PerfectHashIndex) {
+  std::vector<std::string> keys;
+  for (int i = 0; i < 100; ++i)
+    keys.push_back("key_" + std::string(i % 7, 'x') + NumberToString(i));
+  internal::PerfectHashIndex index;
+  index.Init(keys);
+  for (int i = 0; i < 100; ++i)
+    EXPECT_EQ(i, index.Find(keys[i]));
+  EXPECT_EQ(-1, index.Find("key_"));
+  EXPECT_EQ(-1, index.Find(""));
+
+  internal::PerfectHashIndex empty_index;
+  empty_index.Init({});
+  EXPECT_EQ(-1, empty_index.Find("key"));
+}
+
 }  // namespace base
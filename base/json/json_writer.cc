@@ -9,11 +9,14 @@
 #include <cmath>
 #include <limits>
 
+#include "base/containers/span.h"
+#include "base/files/file.h"
 #include "base/json/string_escape.h"
 #include "base/logging.h"
 #include "base/notreached.h"
 #include "base/numerics/safe_conversions.h"
 #include "base/strings/string_number_conversions.h"
+#include "base/strings/string_number_conversions_internal.h"
 #include "base/strings/utf_string_conversions.h"
 #include "base/values.h"
 #include "build/build_config.h"
@@ -52,12 +55,61 @@ bool JSONWriter::WriteWithOptions(ValueView node,
   return result;
 }
 
-JSONWriter::JSONWriter(int options, std::string* json, size_t max_depth)
+// static
+bool JSONWriter::WriteToSink(ValueView node,
+                             int options,
+                             Sink* sink,
+                             size_t max_depth) {
+  DCHECK(sink);
+  std::string buffer;
+  buffer.reserve(kSinkBufferSize);
+
+  JSONWriter writer(options, &buffer, max_depth, sink);
+  bool result = node.Visit([&writer](const auto& member) {
+    return writer.BuildJSONString(member, 0);
+  });
+
+  if (options & OPTIONS_PRETTY_PRINT)
+    buffer.append(kPrettyPrintLineEnding);
+
+  return result && writer.Flush();
+}
+
+JSONWriter::FileSink::FileSink(File* file) : file_(file) {
+  DCHECK(file_->IsValid());
+}
+
+JSONWriter::FileSink::~FileSink() = default;
+
+bool JSONWriter::FileSink::Write(StringPiece data) {
+  return file_->WriteAtCurrentPosAndCheck(as_bytes(make_span(data)));
+}
+
+JSONWriter::ChunkedMemorySink::ChunkedMemorySink() = default;
+
+JSONWriter::ChunkedMemorySink::~ChunkedMemorySink() = default;
+
+bool JSONWriter::ChunkedMemorySink::Write(StringPiece data) {
+  chunks_.push_back(MakeRefCounted<RefCountedBytes>(
+      reinterpret_cast<const unsigned char*>(data.data()), data.size()));
+  return true;
+}
+
+std::vector<scoped_refptr<RefCountedMemory>>
+JSONWriter::ChunkedMemorySink::TakeChunks() {
+  return std::move(chunks_);
+}
+
+JSONWriter::JSONWriter(int options,
+                       std::string* json,
+                       size_t max_depth,
+                       Sink* sink)
     : omit_binary_values_((options & OPTIONS_OMIT_BINARY_VALUES) != 0),
       omit_double_type_preservation_(
           (options & OPTIONS_OMIT_DOUBLE_TYPE_PRESERVATION) != 0),
       pretty_print_((options & OPTIONS_PRETTY_PRINT) != 0),
       json_string_(json),
+      sink_(sink),
       max_depth_(max_depth),
       stack_depth_(0) {
   DCHECK(json);
@@ -86,22 +138,27 @@ bool JSONWriter::BuildJSONString(double node, size_t depth) {
     return true;
   }
 
-  std::string real = NumberToString(node);
+  // The number is formatted as NumberToString() does, in place.
+  const size_t start = json_string_->size();
+  char buffer[internal::kDoubleToBufferSize];
+  json_string_->append(buffer, internal::DoubleToBuffer(node, buffer));
+
   // Ensure that the number has a .0 if there's no decimal or 'e'.  This
   // makes sure that when we read the JSON back, it's interpreted as a
   // real rather than an int.
-  if (real.find_first_of(".eE") == std::string::npos)
-    real.append(".0");
+  if (json_string_->find_first_of(".eE", start) == std::string::npos)
+    json_string_->append(".0");
 
   // The JSON spec requires that non-integer values in the range (-1,1)
   // have a zero before the decimal point - ".52" is not valid, "0.52" is.
-  if (real[0] == '.') {
-    real.insert(0, 1, '0');
-  } else if (real.length() > 1 && real[0] == '-' && real[1] == '.') {
+  std::string& real = *json_string_;
+  if (real[start] == '.') {
+    real.insert(start, 1, '0');
+  } else if (real.length() > start + 1 && real[start] == '-' &&
+             real[start + 1] == '.') {
     // "-.1" bad "-0.1" good
-    real.insert(1, 1, '0');
+    real.insert(start + 1, 1, '0');
   }
-  json_string_->append(real);
   return true;
 }
 
@@ -149,6 +206,8 @@ bool JSONWriter::BuildJSONString(const Value::Dict& node, size_t depth) {
     result &= value.Visit([this, depth = depth + 1](const auto& member) {
       return BuildJSONString(member, depth);
     });
+    if (!FlushIfFull())
+      return false;
 
     first_value_has_been_output = true;
   }
@@ -187,6 +246,8 @@ bool JSONWriter::BuildJSONString(const Value::List& node, size_t depth) {
     result &= value.Visit([this, depth](const auto& member) {
       return BuildJSONString(member, depth);
     });
+    if (!FlushIfFull())
+      return false;
 
     first_value_has_been_output = true;
   }
@@ -201,4 +262,17 @@ void JSONWriter::IndentLine(size_t depth) {
   json_string_->append(depth * 3U, ' ');
 }
 
+bool JSONWriter::FlushIfFull() {
+  if (!sink_ || json_string_->size() < kSinkBufferSize)
+    return true;
+  return Flush();
+}
+
+bool JSONWriter::Flush() {
+  DCHECK(sink_);
+  bool result = sink_->Write(*json_string_);
+  json_string_->clear();
+  return result;
+}
+
 }  // namespace base
@@ -8,14 +8,20 @@
 #include <stddef.h>
 
 #include <string>
+#include <vector>
 
 #include "base/base_export.h"
 #include "base/json/json_common.h"
 #include "base/memory/raw_ptr.h"
+#include "base/memory/ref_counted_memory.h"
+#include "base/memory/scoped_refptr.h"
+#include "base/strings/string_piece.h"
 #include "base/values.h"
 
 namespace base {
 
+class File;
+
 class BASE_EXPORT JSONWriter {
  public:
   enum Options {
@@ -36,6 +42,52 @@ class BASE_EXPORT JSONWriter {
     OPTIONS_PRETTY_PRINT = 1 << 2,
   };
 
+  // Receives the output of WriteToSink(), by chunks.
+  class BASE_EXPORT Sink {
+   public:
+    virtual ~Sink() = default;
+
+    // Returns false on error, which stops writing.
+    virtual bool Write(StringPiece data) = 0;
+  };
+
+  // Writes to |file|, which may also be a pipe, from its current position.
+  class BASE_EXPORT FileSink : public Sink {
+   public:
+    explicit FileSink(File* file);
+
+    FileSink(const FileSink&) = delete;
+    FileSink& operator=(const FileSink&) = delete;
+
+    ~FileSink() override;
+
+    bool Write(StringPiece data) override;
+
+   private:
+    const raw_ptr<File> file_;
+  };
+
+  // Keeps the output as a list of chunks, instead of a single string.
+  class BASE_EXPORT ChunkedMemorySink : public Sink {
+   public:
+    ChunkedMemorySink();
+
+    ChunkedMemorySink(const ChunkedMemorySink&) = delete;
+    ChunkedMemorySink& operator=(const ChunkedMemorySink&) = delete;
+
+    ~ChunkedMemorySink() override;
+
+    bool Write(StringPiece data) override;
+
+    std::vector<scoped_refptr<RefCountedMemory>> TakeChunks();
+
+   private:
+    std::vector<scoped_refptr<RefCountedMemory>> chunks_;
+  };
+
+  // The size of the buffer of WriteToSink(), from which the sink is written.
+  static constexpr size_t kSinkBufferSize = 64 * 1024;
+
   JSONWriter(const JSONWriter&) = delete;
   JSONWriter& operator=(const JSONWriter&) = delete;
 
@@ -56,10 +108,21 @@ class BASE_EXPORT JSONWriter {
                                std::string* json,
                                size_t max_depth = internal::kAbsoluteMaxDepth);
 
+  // Same as WriteWithOptions(), but writes the JSON to |sink| through a
+  // buffer of about kSinkBufferSize bytes, instead of into a single string,
+  // so that the memory used doesn't grow with the output. The buffer only
+  // grows past that for the strings larger than it. Returns false on failure,
+  // including if |sink| failed.
+  static bool WriteToSink(ValueView node,
+                          int options,
+                          Sink* sink,
+                          size_t max_depth = internal::kAbsoluteMaxDepth);
+
  private:
   JSONWriter(int options,
              std::string* json,
-             size_t max_depth = internal::kAbsoluteMaxDepth);
+             size_t max_depth = internal::kAbsoluteMaxDepth,
+             Sink* sink = nullptr);
 
   // Called recursively to build the JSON string. When completed,
   // |json_string_| will contain the JSON.
@@ -75,6 +138,11 @@ class BASE_EXPORT JSONWriter {
   // Adds space to json_string_ for the indent level.
   void IndentLine(size_t depth);
 
+  // Writes json_string_ to |sink_| and clears it, if it's full. Returns false
+  // if |sink_| failed.
+  bool FlushIfFull();
+  bool Flush();
+
   bool omit_binary_values_;
   bool omit_double_type_preservation_;
   bool pretty_print_;
@@ -82,6 +150,9 @@ class BASE_EXPORT JSONWriter {
   // Where we write JSON data as we generate it.
   raw_ptr<std::string> json_string_;
 
+  // Where json_string_ is flushed to, for WriteToSink().
+  const raw_ptr<Sink> sink_;
+
   // Maximum depth to write.
   const size_t max_depth_;
 
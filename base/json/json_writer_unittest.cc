@@ -6,7 +6,11 @@
 #include "base/json/json_reader.h"
 
 #include "base/containers/span.h"
+#include "base/files/file.h"
+#include "base/files/file_util.h"
+#include "base/files/scoped_temp_dir.h"
 #include "base/memory/ptr_util.h"
+#include "base/strings/string_number_conversions.h"
 #include "base/strings/stringprintf.h"
 #include "base/values.h"
 #include "build/build_config.h"
@@ -14,6 +18,36 @@
 
 namespace base {
 
+namespace {
+
+// Generates a list of dictionaries larger than JSONWriter::kSinkBufferSize.
+Value GenerateLargeList() {
+  Value::List list;
+  for (int i = 0; i < 10000; ++i) {
+    Value::Dict dict;
+    dict.Set("index", i);
+    dict.Set("name", "item <" + NumberToString(i) + ">\n");
+    list.Append(std::move(dict));
+  }
+  return Value(std::move(list));
+}
+
+// Fails after |max_writes| writes.
+class FailingSink : public JSONWriter::Sink {
+ public:
+  explicit FailingSink(size_t max_writes) : max_writes_(max_writes) {}
+
+  bool Write(StringPiece data) override { return writes_++ < max_writes_; }
+
+  size_t writes() const { return writes_; }
+
+ private:
+  const size_t max_writes_;
+  size_t writes_ = 0;
+};
+
+}  // namespace
+
 TEST(JSONWriterTest, BasicTypes) {
   std::string output_js;
 
@@ -185,6 +219,59 @@ TEST(JSONWriterTest, StackOverflow) {
   }
 }
 
+TEST(JSONWriterTest, WriteToSink) {
+  const Value value = GenerateLargeList();
+  for (int options : {0, int{JSONWriter::OPTIONS_PRETTY_PRINT}}) {
+    std::string expected;
+    ASSERT_TRUE(JSONWriter::WriteWithOptions(value, options, &expected));
+
+    JSONWriter::ChunkedMemorySink sink;
+    ASSERT_TRUE(JSONWriter::WriteToSink(value, options, &sink));
+    std::vector<scoped_refptr<RefCountedMemory>> chunks = sink.TakeChunks();
+    EXPECT_GT(chunks.size(), 1u);
+    std::string output;
+    for (const auto& chunk : chunks) {
+      // The chunks are flushed between values, once the buffer is full.
+      EXPECT_LT(chunk->size(), 2 * JSONWriter::kSinkBufferSize);
+      output.append(chunk->front_as<char>(), chunk->size());
+    }
+    EXPECT_EQ(expected, output);
+  }
+
+  // Small values are written at once.
+  JSONWriter::ChunkedMemorySink sink;
+  ASSERT_TRUE(JSONWriter::WriteToSink(Value(42), 0, &sink));
+  std::vector<scoped_refptr<RefCountedMemory>> chunks = sink.TakeChunks();
+  ASSERT_EQ(1u, chunks.size());
+  EXPECT_EQ("42", std::string(chunks[0]->front_as<char>(), chunks[0]->size()));
+}
+
+TEST(JSONWriterTest, WriteToFileSink) {
+  ScopedTempDir temp_dir;
+  ASSERT_TRUE(temp_dir.CreateUniqueTempDir());
+  const FilePath path = temp_dir.GetPath().AppendASCII("test.json");
+  const Value value = GenerateLargeList();
+  {
+    File file(path, File::FLAG_CREATE_ALWAYS | File::FLAG_WRITE);
+    JSONWriter::FileSink sink(&file);
+    ASSERT_TRUE(JSONWriter::WriteToSink(value, 0, &sink));
+  }
+
+  std::string expected;
+  ASSERT_TRUE(JSONWriter::Write(value, &expected));
+  std::string output;
+  ASSERT_TRUE(ReadFileToString(path, &output));
+  EXPECT_EQ(expected, output);
+}
+
+TEST(JSONWriterTest, WriteToFailingSink) {
+  const Value value = GenerateLargeList();
+  FailingSink sink(1);
+  EXPECT_FALSE(JSONWriter::WriteToSink(value, 0, &sink));
+  // Writing stops at the first failure.
+  EXPECT_EQ(2u, sink.writes());
+}
+
 TEST(JSONWriterTest, TestMaxDepthWithValidNodes) {
   // Create JSON to the max depth - 1.  Nodes at that depth are still valid
   // for writing which matches the JSONParser logic.
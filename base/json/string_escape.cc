@@ -10,11 +10,24 @@
 #include <limits>
 #include <string>
 
+#include "base/bits.h"
 #include "base/strings/string_util.h"
 #include "base/strings/stringprintf.h"
 #include "base/strings/utf_string_conversion_utils.h"
 #include "base/strings/utf_string_conversions.h"
 #include "base/third_party/icu/icu_utf.h"
+#include "build/build_config.h"
+
+#if defined(ARCH_CPU_X86_64)
+#include "base/cpu.h"
+// Including these headers directly should generally be avoided. The AVX2 loop
+// is only used if the CPU supports it at runtime, see scan_loop.h.
+// clang-format off
+#include <immintrin.h>
+// clang-format on
+#elif defined(ARCH_CPU_ARM64)
+#include <arm_neon.h>
+#endif
 
 namespace base {
 
@@ -77,6 +90,110 @@ bool EscapeSpecialCodePoint(uint32_t code_point, std::string* dest) {
   return true;
 }
 
+// Returns whether the byte |c| is copied as is by EscapeJSONString(), without
+// decoding: the printable ASCII characters but the special ones.
+bool IsUnescapedChar(uint8_t c) {
+  return c >= 0x20 && c < 0x80 && c != '"' && c != '\\' && c != '<';
+}
+
+// Returns the number of bytes at the start of |data| which are copied as is.
+using CountUnescapedCharsFunction = size_t (*)(const char* data,
+                                               size_t length);
+
+size_t CountUnescapedCharsUnvectorized(const char* data, size_t length) {
+  size_t i = 0;
+  while (i < length && IsUnescapedChar(static_cast<uint8_t>(data[i])))
+    ++i;
+  return i;
+}
+
+#if defined(ARCH_CPU_X86_64)
+
+// SSE2 is part of x86-64.
+size_t CountUnescapedCharsSSE2(const char* data, size_t length) {
+  const __m128i quote = _mm_set1_epi8('"');
+  const __m128i backslash = _mm_set1_epi8('\\');
+  const __m128i less_than = _mm_set1_epi8('<');
+  const __m128i space = _mm_set1_epi8(' ');
+  size_t i = 0;
+  for (; i + sizeof(__m128i) <= length; i += sizeof(__m128i)) {
+    const __m128i chars =
+        _mm_loadu_si128(reinterpret_cast<const __m128i*>(data + i));
+    // The comparison is signed: the control characters and the non-ASCII
+    // bytes are the ones less than ' '.
+    const __m128i escaped = _mm_or_si128(
+        _mm_or_si128(_mm_cmpeq_epi8(chars, quote),
+                     _mm_cmpeq_epi8(chars, backslash)),
+        _mm_or_si128(_mm_cmpeq_epi8(chars, less_than),
+                     _mm_cmplt_epi8(chars, space)));
+    const uint32_t mask = static_cast<uint16_t>(_mm_movemask_epi8(escaped));
+    if (mask)
+      return i + bits::CountTrailingZeroBits(mask);
+  }
+  return i + CountUnescapedCharsUnvectorized(data + i, length - i);
+}
+
+__attribute__((target("avx2"))) size_t CountUnescapedCharsAVX2(
+    const char* data,
+    size_t length) {
+  const __m256i quote = _mm256_set1_epi8('"');
+  const __m256i backslash = _mm256_set1_epi8('\\');
+  const __m256i less_than = _mm256_set1_epi8('<');
+  const __m256i space = _mm256_set1_epi8(' ');
+  size_t i = 0;
+  for (; i + sizeof(__m256i) <= length; i += sizeof(__m256i)) {
+    const __m256i chars =
+        _mm256_loadu_si256(reinterpret_cast<const __m256i*>(data + i));
+    const __m256i escaped = _mm256_or_si256(
+        _mm256_or_si256(_mm256_cmpeq_epi8(chars, quote),
+                        _mm256_cmpeq_epi8(chars, backslash)),
+        _mm256_or_si256(_mm256_cmpeq_epi8(chars, less_than),
+                        _mm256_cmpgt_epi8(space, chars)));
+    const uint32_t mask =
+        static_cast<uint32_t>(_mm256_movemask_epi8(escaped));
+    if (mask)
+      return i + bits::CountTrailingZeroBits(mask);
+  }
+  return i + CountUnescapedCharsSSE2(data + i, length - i);
+}
+
+#elif defined(ARCH_CPU_ARM64)
+
+size_t CountUnescapedCharsNEON(const char* data, size_t length) {
+  const uint8x16_t quote = vdupq_n_u8('"');
+  const uint8x16_t backslash = vdupq_n_u8('\\');
+  const uint8x16_t less_than = vdupq_n_u8('<');
+  const uint8x16_t space = vdupq_n_u8(' ');
+  const uint8x16_t non_ascii = vdupq_n_u8(0x80);
+  size_t i = 0;
+  for (; i + sizeof(uint8x16_t) <= length; i += sizeof(uint8x16_t)) {
+    const uint8x16_t chars =
+        vld1q_u8(reinterpret_cast<const uint8_t*>(data + i));
+    const uint8x16_t escaped = vorrq_u8(
+        vorrq_u8(vceqq_u8(chars, quote), vceqq_u8(chars, backslash)),
+        vorrq_u8(vceqq_u8(chars, less_than),
+                 vorrq_u8(vcltq_u8(chars, space), vcgeq_u8(chars, non_ascii))));
+    // Any escaped byte stops the vectorized loop, which finds it.
+    if (vmaxvq_u8(escaped))
+      break;
+  }
+  return i + CountUnescapedCharsUnvectorized(data + i, length - i);
+}
+
+#endif
+
+size_t CountUnescapedChars(const char* data, size_t length) {
+#if defined(ARCH_CPU_X86_64)
+  static const CountUnescapedCharsFunction count_unescaped_chars =
+      CPU().has_avx2() ? &CountUnescapedCharsAVX2 : &CountUnescapedCharsSSE2;
+  return count_unescaped_chars(data, length);
+#elif defined(ARCH_CPU_ARM64)
+  return CountUnescapedCharsNEON(data, length);
+#else
+  return CountUnescapedCharsUnvectorized(data, length);
+#endif
+}
+
 template <typename S>
 bool EscapeJSONStringImpl(const S& str, bool put_in_quotes, std::string* dest) {
   bool did_replacement = false;
@@ -90,6 +207,15 @@ bool EscapeJSONStringImpl(const S& str, bool put_in_quotes, std::string* dest) {
   const int32_t length = static_cast<int32_t>(str.length());
 
   for (int32_t i = 0; i < length; ++i) {
+    if constexpr (sizeof(typename S::value_type) == 1) {
+      // Copy the run of characters which need no escaping at once.
+      const size_t unescaped = CountUnescapedChars(str.data() + i, length - i);
+      dest->append(str.data() + i, unescaped);
+      i += static_cast<int32_t>(unescaped);
+      if (i == length)
+        break;
+    }
+
     uint32_t code_point;
     if (!ReadUnicodeCharacter(str.data(), length, &i, &code_point) ||
         code_point == static_cast<decltype(code_point)>(CBU_SENTINEL) ||
@@ -108,6 +108,31 @@ TEST(JSONStringEscapeTest, EscapeUTF8) {
   EXPECT_TRUE(IsStringUTF8AllowingNoncharacters(out));
 }
 
+TEST(JSONStringEscapeTest, EscapeLongUTF8) {
+  // The runs of characters which need no escaping are copied by blocks, so
+  // check the special characters at every position of a long string.
+  const struct {
+    const char* to_escape;
+    const char* escaped;
+  } cases[] = {
+      {"\"", "\\\""},
+      {"\\", "\\\\"},
+      {"<", "\\u003C"},
+      {"\x1f", "\\u001F"},
+      {"\xc3\xa9", "\xc3\xa9"},
+      {"\xff", "\xEF\xBF\xBD"},  // Not a valid UTF-8 unit.
+  };
+  for (const auto& i : cases) {
+    for (size_t position = 0; position < 80; ++position) {
+      const std::string prefix(position, 'a');
+      const std::string suffix(80 - position, 'z');
+      std::string out;
+      EscapeJSONString(prefix + i.to_escape + suffix, false, &out);
+      EXPECT_EQ(prefix + i.escaped + suffix, out);
+    }
+  }
+}
+
 TEST(JSONStringEscapeTest, EscapeUTF16) {
   const struct {
     const wchar_t* to_escape;
@@ -0,0 +1,83 @@
+// Copyright 2022 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#ifndef BASE_LAZY_H_
+#define BASE_LAZY_H_
+
+#include <new>
+
+#include "base/atomicops.h"
+#include "base/compiler_specific.h"
+#include "base/lazy_instance_helpers.h"
+
+namespace base {
+
+// A lazily constructed object which is never destroyed, like a function-local
+// static base::NoDestructor<T>, for the global accessors which are hot enough
+// that the out-of-line call to a function-local static, and the check of its
+// guard, show. A Lazy<T> is declared with constant initialization, e.g. as a
+// static member, so that it needs no static initializer, and read by an
+// accessor which can be inlined:
+//
+//   // foo.h
+//   class Foo {
+//    public:
+//     static Foo* GetInstance() { return instance_.get(); }
+//
+//    private:
+//     friend class base::Lazy<Foo>;
+//     Foo();
+//
+//     static base::Lazy<Foo> instance_;
+//   };
+//
+//   // foo.cc
+//   CONSTINIT base::Lazy<Foo> Foo::instance_;
+//
+// Once the object is constructed, get() is one load of a pointer, which is a
+// plain load on x86, and a well predicted branch. The first calls construct
+// the object with T(), out of line, once even if threads race to do so.
+//
+// Prefer a function-local static base::NoDestructor<T> elsewhere: unlike it,
+// a Lazy<T> has to be declared outside of the function which uses it.
+template <typename T>
+class Lazy {
+ public:
+  constexpr Lazy() = default;
+
+  Lazy(const Lazy&) = delete;
+  Lazy& operator=(const Lazy&) = delete;
+
+  // Trivially destructible, so that it has no exit-time destructor.
+  ~Lazy() = default;
+
+  T& operator*() { return *get(); }
+  T* operator->() { return get(); }
+
+  T* get() {
+    // Any bit other than kLazyInstanceStateCreating means that the object is
+    // constructed, at that address. Acquires the stores of its construction,
+    // released in Create().
+    const subtle::AtomicWord state = subtle::Acquire_Load(&state_);
+    if (LIKELY(state & ~internal::kLazyInstanceStateCreating))
+      return reinterpret_cast<T*>(state);
+    return Create();
+  }
+
+ private:
+  NOINLINE T* Create() {
+    return subtle::GetOrCreateLazyPointer<T>(
+        &state_, [](void* storage) { return new (storage) T(); }, storage_,
+        /*destructor=*/nullptr, /*destructor_arg=*/nullptr);
+  }
+
+  // 0 until the object is constructed, kLazyInstanceStateCreating while it
+  // is, then its address.
+  subtle::AtomicWord state_ = 0;
+  alignas(T) char storage_[sizeof(T)] = {};
+};
+
+}  // namespace base
+
+#endif  // BASE_LAZY_H_
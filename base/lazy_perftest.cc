@@ -0,0 +1,78 @@
+// Copyright 2022 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include <stddef.h>
+
+#include <string>
+
+#include "base/compiler_specific.h"
+#include "base/lazy.h"
+#include "base/lazy_instance.h"
+#include "base/no_destructor.h"
+#include "base/time/time.h"
+#include "testing/gtest/include/gtest/gtest.h"
+#include "testing/perf/perf_result_reporter.h"
+
+namespace base {
+
+namespace {
+
+constexpr size_t kCount = 100000000;
+
+constexpr char kMetricPrefixLazy[] = "Lazy.";
+constexpr char kMetricAccessTime[] = "access_time";
+
+perf_test::PerfResultReporter SetUpReporter(const std::string& story_name) {
+  perf_test::PerfResultReporter reporter(kMetricPrefixLazy, story_name);
+  reporter.RegisterImportantMetric(kMetricAccessTime, "ns");
+  return reporter;
+}
+
+struct Instance {
+  Instance() = default;
+  ~Instance() {}
+
+  size_t value = 1;
+};
+
+// As for an accessor defined in another translation unit, e.g. the former
+// TraceLog::GetInstance().
+NOINLINE Instance* GetNoDestructorInstance() {
+  static NoDestructor<Instance> instance;
+  return instance.get();
+}
+
+LazyInstance<Instance>::Leaky g_lazy_instance = LAZY_INSTANCE_INITIALIZER;
+
+CONSTINIT Lazy<Instance> g_lazy;
+
+template <typename Accessor>
+void RunAccessTest(const std::string& story_name, Accessor accessor) {
+  size_t sum = 0;
+  const TimeTicks start = TimeTicks::Now();
+  for (size_t i = 0; i < kCount; ++i)
+    sum += accessor()->value;
+  const TimeDelta elapsed = TimeTicks::Now() - start;
+  SetUpReporter(story_name)
+      .AddResult(kMetricAccessTime,
+                 static_cast<double>(elapsed.InNanoseconds()) / kCount);
+  EXPECT_EQ(sum, kCount);
+}
+
+}  // namespace
+
+TEST(LazyPerfTest, FunctionLocalNoDestructor) {
+  RunAccessTest("function_local_no_destructor", &GetNoDestructorInstance);
+}
+
+TEST(LazyPerfTest, LeakyLazyInstance) {
+  RunAccessTest("leaky_lazy_instance",
+                [] { return g_lazy_instance.Pointer(); });
+}
+
+TEST(LazyPerfTest, Lazy) {
+  RunAccessTest("lazy", [] { return g_lazy.get(); });
+}
+
+}  // namespace base
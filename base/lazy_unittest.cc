@@ -0,0 +1,103 @@
+// Copyright 2022 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "base/lazy.h"
+
+#include <atomic>
+
+#include "base/compiler_specific.h"
+#include "base/memory/aligned_memory.h"
+#include "base/threading/platform_thread.h"
+#include "base/threading/simple_thread.h"
+#include "base/time/time.h"
+#include "testing/gtest/include/gtest/gtest.h"
+
+namespace base {
+
+namespace {
+
+std::atomic<int> g_num_constructed{0};
+
+class Counted {
+ public:
+  int value() const { return value_; }
+
+ private:
+  friend class Lazy<Counted>;
+
+  Counted() : value_(g_num_constructed.fetch_add(1) + 1) {}
+
+  const int value_;
+};
+
+CONSTINIT Lazy<Counted> g_counted;
+
+class SlowConstructor {
+ public:
+  SlowConstructor() {
+    // Gives the other threads time to race to construct the object.
+    PlatformThread::Sleep(Milliseconds(100));
+    ++constructed;
+    some_int_ = 12;
+  }
+
+  int some_int() const { return some_int_; }
+
+  static std::atomic<int> constructed;
+
+ private:
+  int some_int_ = 0;
+};
+
+// static
+std::atomic<int> SlowConstructor::constructed{0};
+
+CONSTINIT Lazy<SlowConstructor> g_slow;
+
+class SlowDelegate : public DelegateSimpleThread::Delegate {
+ public:
+  void Run() override { EXPECT_EQ(12, g_slow->some_int()); }
+};
+
+template <size_t alignment>
+struct AlignedData {
+  alignas(alignment) char data[alignment];
+};
+
+}  // namespace
+
+TEST(LazyTest, ConstructedOnFirstUse) {
+  EXPECT_EQ(0, g_num_constructed.load());
+  Counted* const counted = g_counted.get();
+  EXPECT_EQ(1, g_num_constructed.load());
+  EXPECT_EQ(1, counted->value());
+
+  EXPECT_EQ(counted, g_counted.get());
+  EXPECT_EQ(counted, &*g_counted);
+  EXPECT_EQ(1, g_counted->value());
+  EXPECT_EQ(1, g_num_constructed.load());
+}
+
+TEST(LazyTest, ConstructorThreadSafety) {
+  SlowDelegate delegate;
+  DelegateSimpleThreadPool pool("lazy_cons", 5);
+  pool.AddWork(&delegate, 20);
+  EXPECT_EQ(0, SlowConstructor::constructed.load());
+
+  pool.Start();
+  pool.JoinAll();
+  EXPECT_EQ(1, SlowConstructor::constructed.load());
+}
+
+TEST(LazyTest, Alignment) {
+  static CONSTINIT Lazy<AlignedData<4>> align4;
+  static CONSTINIT Lazy<AlignedData<32>> align32;
+  static CONSTINIT Lazy<AlignedData<4096>> align4096;
+
+  EXPECT_TRUE(IsAligned(align4.get(), 4));
+  EXPECT_TRUE(IsAligned(align32.get(), 32));
+  EXPECT_TRUE(IsAligned(align4096.get(), 4096));
+}
+
+}  // namespace base
@@ -94,7 +94,6 @@ typedef FILE* FileHandle;
 #include <algorithm>
 #include <cstring>
 #include <ctime>
-#include <iomanip>
 #include <ostream>
 #include <string>
 #include <utility>
@@ -131,6 +130,16 @@ typedef FILE* FileHandle;
 #include "base/posix/safe_strerror.h"
 #endif
 
+#if BUILDFLAG(IS_POSIX) && !BUILDFLAG(IS_NACL)
+#include <pthread.h>
+#include <unistd.h>
+
+#include <atomic>
+
+#include "base/async_log_sink_posix.h"
+#include "base/files/scoped_file.h"
+#endif
+
 #if BUILDFLAG(IS_CHROMEOS_ASH)
 #include "base/files/scoped_file.h"
 #endif
@@ -183,6 +192,13 @@ PathString* g_log_file_name = nullptr;
 // This file is lazily opened and the handle may be nullptr
 FileHandle g_log_file = nullptr;
 
+#if BUILDFLAG(IS_POSIX) && !BUILDFLAG(IS_NACL)
+// Writes to |g_log_file| if LoggingSettings::async_file_writes, through a
+// duplicate of its descriptor. Never deleted, since the logging threads may
+// be using it.
+std::atomic<AsyncLogSink*> g_async_log_sink{nullptr};
+#endif
+
 // What should be prepended to each message?
 bool g_log_process_id = false;
 bool g_log_thread_id = false;
@@ -376,6 +392,61 @@ inline FuchsiaLogSeverity LogSeverityToFuchsiaLogSeverity(
 }
 #endif  // defined (OS_FUCHSIA)
 
+#if BUILDFLAG(IS_POSIX) && !BUILDFLAG(IS_NACL)
+void FlushAsyncLogSink() {
+  AsyncLogSink* async_log_sink =
+      g_async_log_sink.load(std::memory_order_acquire);
+  if (async_log_sink)
+    async_log_sink->Flush();
+}
+
+// The writer thread doesn't exist in the forked children.
+void DetachAsyncLogSinkInChild() {
+  g_async_log_sink.store(nullptr, std::memory_order_relaxed);
+}
+
+// Replaces the sink of |g_log_file| with one which writes asynchronously if
+// |async_file_writes|. The previous sink is flushed, and leaked.
+void ResetAsyncLogSinkUnlocked(bool async_file_writes) {
+  AsyncLogSink* previous_sink =
+      g_async_log_sink.exchange(nullptr, std::memory_order_acq_rel);
+  if (previous_sink)
+    previous_sink->Flush();
+  if (!async_file_writes || !g_log_file)
+    return;
+
+  base::ScopedFD fd(dup(fileno(g_log_file)));
+  if (!fd.is_valid())
+    return;
+  [[maybe_unused]] static const bool registered = [] {
+    pthread_atfork(nullptr, nullptr, &DetachAsyncLogSinkInChild);
+    atexit(&FlushAsyncLogSink);
+    return true;
+  }();
+  g_async_log_sink.store(new AsyncLogSink(std::move(fd)),
+                         std::memory_order_release);
+}
+#endif  // BUILDFLAG(IS_POSIX) && !BUILDFLAG(IS_NACL)
+
+// Returns true if the asynchronous sink took |message|, which the caller
+// should otherwise write itself.
+bool AppendToAsyncLogSink(LogSeverity severity, base::StringPiece message) {
+#if BUILDFLAG(IS_POSIX) && !BUILDFLAG(IS_NACL)
+  AsyncLogSink* async_log_sink =
+      g_async_log_sink.load(std::memory_order_acquire);
+  if (!async_log_sink)
+    return false;
+  // The process is about to crash, so the message must not wait.
+  if (severity == LOGGING_FATAL) {
+    async_log_sink->Flush();
+    return false;
+  }
+  return async_log_sink->Append(message);
+#else
+  return false;
+#endif
+}
+
 void WriteToFd(int fd, const char* data, size_t length) {
   size_t bytes_written = 0;
   int rv;
@@ -457,6 +528,7 @@ bool BaseInitLoggingImpl(const LoggingSettings& settings) {
   if (settings.log_file) {
     DCHECK(!settings.log_file_path);
     g_log_file = settings.log_file;
+    ResetAsyncLogSinkUnlocked(settings.async_file_writes);
     return true;
   }
 #endif
@@ -469,7 +541,11 @@ bool BaseInitLoggingImpl(const LoggingSettings& settings) {
   if (settings.delete_old == DELETE_OLD_LOG_FILE)
     DeleteFilePath(*g_log_file_name);
 
-  return InitializeLogFileHandle();
+  const bool initialized = InitializeLogFileHandle();
+#if BUILDFLAG(IS_POSIX) && !BUILDFLAG(IS_NACL)
+  ResetAsyncLogSinkUnlocked(settings.async_file_writes);
+#endif
+  return initialized;
 }
 
 void SetMinLogLevel(int level) {
@@ -840,7 +916,8 @@ LogMessage::~LogMessage() {
     WriteToFd(STDERR_FILENO, str_newline.data(), str_newline.size());
   }
 
-  if ((g_logging_destination & LOG_TO_FILE) != 0) {
+  if ((g_logging_destination & LOG_TO_FILE) != 0 &&
+      !AppendToAsyncLogSink(severity_, str_newline)) {
     // We can have multiple threads and/or processes, so try to prevent them
     // from clobbering each other's writes.
     // If the client app did not call InitLogging, and the lock has not
@@ -938,19 +1015,16 @@ void LogMessage::Init(const char* file, int line) {
     if (g_log_thread_id)
       stream_ << base::PlatformThread::CurrentId() << ':';
     if (g_log_timestamp) {
+      // Formatted on the stack rather than through the manipulators of
+      // |stream_|, whose fill would also apply to the message.
+      char timestamp[32];
 #if BUILDFLAG(IS_WIN)
       SYSTEMTIME local_time;
       GetLocalTime(&local_time);
-      stream_ << std::setfill('0')
-              << std::setw(2) << local_time.wMonth
-              << std::setw(2) << local_time.wDay
-              << '/'
-              << std::setw(2) << local_time.wHour
-              << std::setw(2) << local_time.wMinute
-              << std::setw(2) << local_time.wSecond
-              << '.'
-              << std::setw(3) << local_time.wMilliseconds
-              << ':';
+      snprintf(timestamp, sizeof(timestamp), "%02d%02d/%02d%02d%02d.%03d:",
+               local_time.wMonth, local_time.wDay, local_time.wHour,
+               local_time.wMinute, local_time.wSecond,
+               local_time.wMilliseconds);
 #elif BUILDFLAG(IS_POSIX) || BUILDFLAG(IS_FUCHSIA)
       timeval tv;
       gettimeofday(&tv, nullptr);
@@ -958,19 +1032,14 @@ void LogMessage::Init(const char* file, int line) {
       struct tm local_time;
       localtime_r(&t, &local_time);
       struct tm* tm_time = &local_time;
-      stream_ << std::setfill('0')
-              << std::setw(2) << 1 + tm_time->tm_mon
-              << std::setw(2) << tm_time->tm_mday
-              << '/'
-              << std::setw(2) << tm_time->tm_hour
-              << std::setw(2) << tm_time->tm_min
-              << std::setw(2) << tm_time->tm_sec
-              << '.'
-              << std::setw(6) << tv.tv_usec
-              << ':';
+      snprintf(timestamp, sizeof(timestamp), "%02d%02d/%02d%02d%02d.%06ld:",
+               1 + tm_time->tm_mon, tm_time->tm_mday, tm_time->tm_hour,
+               tm_time->tm_min, tm_time->tm_sec,
+               static_cast<long>(tv.tv_usec));
 #else
 #error Unsupported platform
 #endif
+      stream_ << timestamp;
     }
     if (g_log_tickcount)
       stream_ << TickCount() << ':';
@@ -981,7 +1050,8 @@ void LogMessage::Init(const char* file, int line) {
     }
     stream_ << ":" << filename << "(" << line << ")] ";
   }
-  message_start_ = stream_.str().length();
+  // Unlike str(), doesn't copy the prefix.
+  message_start_ = static_cast<size_t>(stream_.tellp());
 }
 
 #if BUILDFLAG(IS_WIN)
@@ -1052,6 +1122,9 @@ ErrnoLogMessage::~ErrnoLogMessage() {
 void CloseLogFile() {
 #if BUILDFLAG(IS_POSIX) || BUILDFLAG(IS_FUCHSIA)
   base::AutoLock guard(GetLoggingLock());
+#endif
+#if BUILDFLAG(IS_POSIX) && !BUILDFLAG(IS_NACL)
+  ResetAsyncLogSinkUnlocked(false);
 #endif
   CloseLogFileUnlocked();
 }
@@ -1082,6 +1155,10 @@ ScopedLoggingSettings::ScopedLoggingSettings()
 #if BUILDFLAG(IS_CHROMEOS)
       log_format_(g_log_format),
 #endif  // BUILDFLAG(IS_CHROMEOS_ASH)
+#if BUILDFLAG(IS_POSIX) && !BUILDFLAG(IS_NACL)
+      async_file_writes_(g_async_log_sink.load(std::memory_order_acquire) !=
+                         nullptr),
+#endif
       enable_process_id_(g_log_process_id),
       enable_thread_id_(g_log_thread_id),
       enable_timestamp_(g_log_timestamp),
@@ -1106,7 +1183,10 @@ ScopedLoggingSettings::~ScopedLoggingSettings() {
     .logging_dest = logging_destination_,
     .log_file_path = log_file_name_ ? log_file_name_->data() : nullptr,
 #if BUILDFLAG(IS_CHROMEOS)
-    .log_format = log_format_
+    .log_format = log_format_,
+#endif
+#if BUILDFLAG(IS_POSIX) && !BUILDFLAG(IS_NACL)
+    .async_file_writes = async_file_writes_,
 #endif
   })) << "~ScopedLoggingSettings() failed to restore settings.";
 
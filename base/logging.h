@@ -244,6 +244,13 @@ struct BASE_EXPORT LoggingSettings {
   // ChromeOS uses the syslog log format by default.
   LogFormat log_format = LogFormat::LOG_FORMAT_SYSLOG;
 #endif
+#if BUILDFLAG(IS_POSIX) && !BUILDFLAG(IS_NACL)
+  // Writes the log file on a background thread, through an AsyncLogSink,
+  // rather than on the logging threads under a lock. The messages which don't
+  // fit in the buffer of their thread are dropped. A LOG(FATAL) is written
+  // directly, after the pending messages.
+  bool async_file_writes = false;
+#endif
 };
 
 // Define different names for the BaseInitLoggingImpl() function depending on
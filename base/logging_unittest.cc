@@ -15,6 +15,7 @@
 #include "base/process/process.h"
 #include "base/run_loop.h"
 #include "base/sanitizer_buildflags.h"
+#include "base/strings/string_number_conversions.h"
 #include "base/strings/string_piece.h"
 #include "base/strings/utf_string_conversions.h"
 #include "base/test/bind.h"
@@ -288,6 +289,36 @@ TEST_F(LoggingTest, AlwaysLogErrorsToStderr) {
 }
 #endif  // BUILDFLAG(IS_POSIX) || BUILDFLAG(IS_FUCHSIA)
 
+#if BUILDFLAG(IS_POSIX) && !BUILDFLAG(IS_NACL)
+TEST_F(LoggingTest, AsyncFileWrites) {
+  const char kInfoLogMessage[] = "something happened";
+
+  base::ScopedTempDir temp_dir;
+  ASSERT_TRUE(temp_dir.CreateUniqueTempDir());
+  base::FilePath file_log_path = temp_dir.GetPath().Append("file.log");
+
+  LoggingSettings settings;
+  settings.logging_dest = LOG_TO_FILE;
+  settings.log_file_path = file_log_path.value().c_str();
+  settings.async_file_writes = true;
+  InitLogging(settings);
+
+  for (int i = 0; i < 10; ++i)
+    LOG(INFO) << kInfoLogMessage << " " << i;
+
+  // Closing the log file writes the pending messages, in order.
+  CloseLogFile();
+  std::string written_logs;
+  ASSERT_TRUE(base::ReadFileToString(file_log_path, &written_logs));
+  size_t position = 0;
+  for (int i = 0; i < 10; ++i) {
+    position = written_logs.find(
+        kInfoLogMessage + std::string(" ") + base::NumberToString(i), position);
+    ASSERT_NE(position, std::string::npos) << i;
+  }
+}
+#endif  // BUILDFLAG(IS_POSIX) && !BUILDFLAG(IS_NACL)
+
 #if BUILDFLAG(IS_CHROMEOS_ASH)
 TEST_F(LoggingTest, InitWithFileDescriptor) {
   const char kErrorLogMessage[] = "something bad happened";
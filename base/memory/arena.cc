@@ -0,0 +1,171 @@
+// Copyright 2022 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "base/memory/arena.h"
+
+#include <stdlib.h>
+
+#include <algorithm>
+
+#include "base/process/memory.h"
+
+namespace base {
+
+struct Arena::Chunk {
+  Chunk* next;
+  size_t size;
+};
+
+struct Arena::Destructor {
+  void* object;
+  void (*destroy)(void*);
+  Destructor* next;
+};
+
+namespace {
+
+// The offset of the usable memory in a chunk, after its Arena::Chunk, which
+// keeps it aligned like malloc()'s.
+constexpr size_t kChunkHeaderSize =
+    bits::AlignUp(2 * sizeof(void*), alignof(std::max_align_t));
+
+}  // namespace
+
+Arena::Arena(size_t chunk_size) : chunk_size_(chunk_size) {
+  CHECK_GT(chunk_size_, kChunkHeaderSize);
+}
+
+Arena::~Arena() {
+  Reset();
+  ReleaseFreeChunks();
+  DCHECK_EQ(0u, reserved_bytes_);
+}
+
+void Arena::Reset() {
+#if DCHECK_IS_ON()
+  DCHECK(!resetting_);
+  resetting_ = true;
+#endif
+  // Destructors may allocate, e.g. push to an arena container, which is
+  // pointless but harmless since the memory is still valid until the chunks
+  // are recycled below.
+  while (destructors_) {
+    Destructor* destructor = destructors_;
+    destructors_ = destructor->next;
+    destructor->destroy(destructor->object);
+  }
+#if DCHECK_IS_ON()
+  resetting_ = false;
+#endif
+
+  while (chunks_) {
+    Chunk* chunk = chunks_;
+    chunks_ = chunk->next;
+    if (chunk->size == chunk_size_) {
+      chunk->next = free_chunks_;
+      free_chunks_ = chunk;
+    } else {
+      FreeChunk(chunk);
+    }
+  }
+  cursor_ = 0;
+  limit_ = 0;
+}
+
+void Arena::ReleaseFreeChunks() {
+  while (free_chunks_) {
+    Chunk* chunk = free_chunks_;
+    free_chunks_ = chunk->next;
+    FreeChunk(chunk);
+  }
+}
+
+void* Arena::AllocateSlow(size_t size, size_t alignment) {
+  // Leaves room for aligning the start of the allocation. Alignments up to
+  // malloc()'s don't need any.
+  size_t padding =
+      alignment > alignof(std::max_align_t) ? alignment - 1 : size_t{0};
+  CHECK_LE(size, std::numeric_limits<size_t>::max() - kChunkHeaderSize -
+                     padding - 1);
+  size_t needed = kChunkHeaderSize + padding + std::max(size, size_t{1});
+
+  Chunk* chunk;
+  if (needed > chunk_size_ / 4 + kChunkHeaderSize) {
+    // Large allocations get a chunk of their own, which doesn't replace the
+    // current one since it's full already.
+    chunk = NewChunk(needed);
+    chunk->next = chunks_;
+    chunks_ = chunk;
+    uintptr_t start = bits::AlignUp(
+        reinterpret_cast<uintptr_t>(chunk) + kChunkHeaderSize, alignment);
+    return reinterpret_cast<void*>(start);
+  }
+
+  if (free_chunks_) {
+    chunk = free_chunks_;
+    free_chunks_ = chunk->next;
+  } else {
+    chunk = NewChunk(chunk_size_);
+  }
+  chunk->next = chunks_;
+  chunks_ = chunk;
+  cursor_ = reinterpret_cast<uintptr_t>(chunk) + kChunkHeaderSize;
+  limit_ = reinterpret_cast<uintptr_t>(chunk) + chunk_size_;
+
+  void* result = Allocate(size, alignment);
+  DCHECK(result);
+  return result;
+}
+
+void Arena::AddDestructor(void* object, void (*destroy)(void*)) {
+#if DCHECK_IS_ON()
+  // Objects can't be created while the arena destroys its objects.
+  DCHECK(!resetting_);
+#endif
+  Destructor* destructor = static_cast<Destructor*>(
+      Allocate(sizeof(Destructor), alignof(Destructor)));
+  destructor->object = object;
+  destructor->destroy = destroy;
+  destructor->next = destructors_;
+  destructors_ = destructor;
+}
+
+Arena::Chunk* Arena::NewChunk(size_t size) {
+  static_assert(sizeof(Chunk) <= kChunkHeaderSize, "");
+  void* memory = malloc(size);
+  if (!memory)
+    TerminateBecauseOutOfMemory(size);
+  reserved_bytes_ += size;
+  Chunk* chunk = static_cast<Chunk*>(memory);
+  chunk->size = size;
+  return chunk;
+}
+
+void Arena::FreeChunk(Chunk* chunk) {
+  DCHECK_GE(reserved_bytes_, chunk->size);
+  reserved_bytes_ -= chunk->size;
+  free(chunk);
+}
+
+#if defined(__cpp_lib_memory_resource)
+ArenaMemoryResource::~ArenaMemoryResource() = default;
+
+void* ArenaMemoryResource::do_allocate(size_t bytes, size_t alignment) {
+  return arena_->Allocate(bytes, alignment);
+}
+
+void ArenaMemoryResource::do_deallocate(void* ptr,
+                                        size_t bytes,
+                                        size_t alignment) {
+  arena_->Deallocate(ptr, bytes);
+}
+
+bool ArenaMemoryResource::do_is_equal(
+    const std::pmr::memory_resource& other) const noexcept {
+  const auto* other_resource = dynamic_cast<const ArenaMemoryResource*>(&other);
+  return other_resource && other_resource->arena_ == arena_;
+}
+#endif  // defined(__cpp_lib_memory_resource)
+
+}  // namespace base
@@ -0,0 +1,196 @@
+// Copyright 2022 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#ifndef BASE_MEMORY_ARENA_H_
+#define BASE_MEMORY_ARENA_H_
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include <cstddef>
+#include <limits>
+#include <new>
+#include <string>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+#include "base/base_export.h"
+#include "base/bits.h"
+#include "base/check.h"
+#include "base/check_op.h"
+#include "base/compiler_specific.h"
+#include "base/dcheck_is_on.h"
+
+#if __has_include(<memory_resource>)
+#include <memory_resource>
+#endif
+
+namespace base {
+
+// An arena, a.k.a. monotonic or bump allocator, for objects which die
+// together, e.g. the objects built while handling a request. Allocating moves a
+// cursor forward in the current chunk of memory, and nothing is freed until
+// Reset(), which destroys the objects created with New() and makes all the
+// memory reusable at once. The chunks are recycled across Reset()s, so an arena
+// which is reset at the end of each request stops allocating once it has
+// grown to the size of the largest request.
+//
+// The chunks come from malloc(), i.e. from PartitionAlloc when it's malloc().
+//
+//   Arena arena;
+//   Node* node = arena.New<Node>(args);
+//   auto* numbers = arena.New<ArenaVector<int>>(ArenaAllocator<int>(&arena));
+//   using Map = flat_map<int, int, std::less<>,
+//                        ArenaVector<std::pair<int, int>>>;
+//   auto* map = arena.New<Map>(
+//       Map::container_type(ArenaAllocator<int>(&arena)));
+//   ...
+//   arena.Reset();  // Destroys |node|, |numbers| and |map|, frees everything.
+//
+// Containers which allocate from the arena must be destroyed before it's
+// reset, which creating them with New() ensures. An arena must only be used on
+// one sequence at a time.
+class BASE_EXPORT Arena {
+ public:
+  static constexpr size_t kDefaultChunkSize = 16 * 1024;
+
+  // |chunk_size| is the size of the chunks which the arena allocates, and
+  // recycles. Allocations larger than a quarter of it get a chunk of their
+  // own, which Reset() frees.
+  explicit Arena(size_t chunk_size = kDefaultChunkSize);
+  Arena(const Arena&) = delete;
+  Arena& operator=(const Arena&) = delete;
+  ~Arena();
+
+  // Returns |size| bytes aligned to |alignment|, a power of two, which stay
+  // valid until Reset(). Never returns nullptr.
+  ALWAYS_INLINE void* Allocate(size_t size,
+                               size_t alignment = alignof(std::max_align_t)) {
+    DCHECK(bits::IsPowerOfTwo(alignment));
+    uintptr_t start = bits::AlignUp(cursor_, alignment);
+    // |limit_| - |start| wraps around if aligning crossed |limit_|.
+    if (LIKELY(start <= limit_ && size < limit_ - start)) {
+      cursor_ = start + size;
+      return reinterpret_cast<void*>(start);
+    }
+    return AllocateSlow(size, alignment);
+  }
+
+  // Gives back the memory of the last allocation, if |ptr| and |size| match it.
+  // Otherwise does nothing, since the memory is freed by Reset() anyway.
+  void Deallocate(void* ptr, size_t size) {
+    if (reinterpret_cast<uintptr_t>(ptr) + size == cursor_)
+      cursor_ = reinterpret_cast<uintptr_t>(ptr);
+  }
+
+  // Creates a T in the arena. Reset() runs its destructor, unless it's
+  // trivial.
+  template <typename T, typename... Args>
+  T* New(Args&&... args) {
+    void* memory = Allocate(sizeof(T), alignof(T));
+    T* object = new (memory) T(std::forward<Args>(args)...);
+    if (!std::is_trivially_destructible<T>::value) {
+      AddDestructor(object,
+                    [](void* object) { static_cast<T*>(object)->~T(); });
+    }
+    return object;
+  }
+
+  // Destroys the objects created with New(), in the reverse order of their
+  // creation, and makes all the memory of the arena available again.
+  void Reset();
+
+  // Frees the chunks which Reset() kept for recycling.
+  void ReleaseFreeChunks();
+
+  // The size of the chunks which the arena holds, in use or not.
+  size_t reserved_bytes() const { return reserved_bytes_; }
+
+ private:
+  struct Chunk;
+  struct Destructor;
+
+  NOINLINE void* AllocateSlow(size_t size, size_t alignment);
+  void AddDestructor(void* object, void (*destroy)(void*));
+  Chunk* NewChunk(size_t size);
+  void FreeChunk(Chunk* chunk);
+
+  const size_t chunk_size_;
+
+  // The free part of the current chunk.
+  uintptr_t cursor_ = 0;
+  uintptr_t limit_ = 0;
+
+  // The chunks which hold allocations, and the ones kept by Reset().
+  Chunk* chunks_ = nullptr;
+  Chunk* free_chunks_ = nullptr;
+  size_t reserved_bytes_ = 0;
+
+  // The objects to destroy on Reset(), most recent first.
+  Destructor* destructors_ = nullptr;
+#if DCHECK_IS_ON()
+  bool resetting_ = false;
+#endif
+};
+
+// An allocator for standard containers which allocates from an Arena. Since
+// the memory is only freed by Arena::Reset(), containers which grow leave their
+// previous buffers behind, so reserve() them when their size is known.
+template <typename T>
+class ArenaAllocator {
+ public:
+  using value_type = T;
+
+  explicit ArenaAllocator(Arena* arena) : arena_(arena) { DCHECK(arena_); }
+  template <typename U>
+  ArenaAllocator(const ArenaAllocator<U>& other)  // NOLINT
+      : arena_(other.arena()) {}
+
+  T* allocate(size_t n) {
+    CHECK_LE(n, std::numeric_limits<size_t>::max() / sizeof(T));
+    return static_cast<T*>(arena_->Allocate(n * sizeof(T), alignof(T)));
+  }
+  void deallocate(T* ptr, size_t n) { arena_->Deallocate(ptr, n * sizeof(T)); }
+
+  Arena* arena() const { return arena_; }
+
+  template <typename U>
+  bool operator==(const ArenaAllocator<U>& other) const {
+    return arena_ == other.arena();
+  }
+  template <typename U>
+  bool operator!=(const ArenaAllocator<U>& other) const {
+    return arena_ != other.arena();
+  }
+
+ private:
+  Arena* arena_;
+};
+
+template <typename T>
+using ArenaVector = std::vector<T, ArenaAllocator<T>>;
+using ArenaString =
+    std::basic_string<char, std::char_traits<char>, ArenaAllocator<char>>;
+
+#if defined(__cpp_lib_memory_resource)
+// Exposes an Arena as a std::pmr::memory_resource, for std::pmr containers.
+class BASE_EXPORT ArenaMemoryResource : public std::pmr::memory_resource {
+ public:
+  explicit ArenaMemoryResource(Arena* arena) : arena_(arena) {}
+  ~ArenaMemoryResource() override;
+
+ private:
+  void* do_allocate(size_t bytes, size_t alignment) override;
+  void do_deallocate(void* ptr, size_t bytes, size_t alignment) override;
+  bool do_is_equal(const std::pmr::memory_resource& other) const
+      noexcept override;
+
+  Arena* const arena_;
+};
+#endif  // defined(__cpp_lib_memory_resource)
+
+}  // namespace base
+
+#endif  // BASE_MEMORY_ARENA_H_
@@ -0,0 +1,187 @@
+// Copyright 2022 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "base/memory/arena.h"
+
+#include <functional>
+#include <string>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+#include "base/containers/flat_map.h"
+#include "base/memory/aligned_memory.h"
+#include "testing/gtest/include/gtest/gtest.h"
+
+namespace base {
+
+namespace {
+
+class DestructionRecorder {
+ public:
+  DestructionRecorder(int id, std::vector<int>* destroyed)
+      : id_(id), destroyed_(destroyed) {}
+  ~DestructionRecorder() { destroyed_->push_back(id_); }
+
+ private:
+  const int id_;
+  std::vector<int>* const destroyed_;
+};
+
+}  // namespace
+
+TEST(ArenaTest, Alignment) {
+  Arena arena;
+  for (size_t alignment = 1; alignment <= 4096; alignment *= 2) {
+    void* ptr = arena.Allocate(3, alignment);
+    EXPECT_TRUE(ptr);
+    EXPECT_TRUE(IsAligned(ptr, alignment));
+  }
+  EXPECT_TRUE(IsAligned(arena.Allocate(1), alignof(std::max_align_t)));
+}
+
+TEST(ArenaTest, AllocationsDontOverlap) {
+  Arena arena(1024);
+  std::vector<uint8_t*> ptrs;
+  for (int i = 0; i < 1000; i++) {
+    uint8_t* ptr = static_cast<uint8_t*>(arena.Allocate(17, 1));
+    memset(ptr, i & 0xff, 17);
+    ptrs.push_back(ptr);
+  }
+  for (int i = 0; i < 1000; i++) {
+    for (int j = 0; j < 17; j++)
+      EXPECT_EQ(i & 0xff, ptrs[i][j]);
+  }
+}
+
+TEST(ArenaTest, ZeroSize) {
+  Arena arena;
+  EXPECT_TRUE(arena.Allocate(0));
+}
+
+TEST(ArenaTest, Deallocate) {
+  Arena arena;
+  void* ptr = arena.Allocate(64, 8);
+  arena.Deallocate(ptr, 64);
+  EXPECT_EQ(ptr, arena.Allocate(64, 8));
+
+  // Only the last allocation can be given back.
+  void* ptr2 = arena.Allocate(64, 8);
+  arena.Deallocate(ptr, 64);
+  EXPECT_NE(ptr, arena.Allocate(64, 8));
+  EXPECT_NE(ptr2, ptr);
+}
+
+TEST(ArenaTest, DestructorsRunInReverseOrder) {
+  std::vector<int> destroyed;
+  Arena arena;
+  for (int i = 0; i < 3; i++)
+    arena.New<DestructionRecorder>(i, &destroyed);
+  EXPECT_TRUE(destroyed.empty());
+
+  arena.Reset();
+  EXPECT_EQ(std::vector<int>({2, 1, 0}), destroyed);
+
+  // The objects are destroyed once.
+  arena.Reset();
+  EXPECT_EQ(3u, destroyed.size());
+}
+
+TEST(ArenaTest, DestructorsRunWhenDestroyed) {
+  std::vector<int> destroyed;
+  {
+    Arena arena;
+    arena.New<DestructionRecorder>(0, &destroyed);
+  }
+  EXPECT_EQ(std::vector<int>({0}), destroyed);
+}
+
+TEST(ArenaTest, ResetRecyclesChunks) {
+  Arena arena(4096);
+  for (int i = 0; i < 100; i++)
+    arena.Allocate(100);
+  size_t reserved_bytes = arena.reserved_bytes();
+  EXPECT_GE(reserved_bytes, 100u * 100u);
+
+  for (int round = 0; round < 10; round++) {
+    arena.Reset();
+    EXPECT_EQ(reserved_bytes, arena.reserved_bytes());
+    for (int i = 0; i < 100; i++)
+      arena.Allocate(100);
+    EXPECT_EQ(reserved_bytes, arena.reserved_bytes());
+  }
+
+  arena.Reset();
+  arena.ReleaseFreeChunks();
+  EXPECT_EQ(0u, arena.reserved_bytes());
+}
+
+TEST(ArenaTest, LargeAllocations) {
+  Arena arena(4096);
+  void* small = arena.Allocate(16);
+  size_t reserved_bytes = arena.reserved_bytes();
+
+  // Doesn't fit in a chunk.
+  uint8_t* large = static_cast<uint8_t*>(arena.Allocate(64 * 1024, 64));
+  EXPECT_TRUE(IsAligned(large, 64));
+  memset(large, 0xab, 64 * 1024);
+  EXPECT_GT(arena.reserved_bytes(), reserved_bytes + 64 * 1024);
+
+  // The current chunk is still used.
+  void* small2 = arena.Allocate(16);
+  EXPECT_EQ(static_cast<uint8_t*>(small) + 16, small2);
+
+  // Large allocations are not recycled.
+  arena.Reset();
+  EXPECT_EQ(reserved_bytes, arena.reserved_bytes());
+}
+
+TEST(ArenaTest, Vector) {
+  Arena arena;
+  auto* numbers = arena.New<ArenaVector<int>>(ArenaAllocator<int>(&arena));
+  for (int i = 0; i < 10000; i++)
+    numbers->push_back(i);
+  for (int i = 0; i < 10000; i++)
+    EXPECT_EQ(i, (*numbers)[i]);
+  arena.Reset();
+}
+
+TEST(ArenaTest, String) {
+  Arena arena;
+  ArenaAllocator<char> allocator(&arena);
+  auto* str = arena.New<ArenaString>("a string which is too long for SSO",
+                                     allocator);
+  str->append(1000, 'x');
+  EXPECT_EQ(34u + 1000u, str->size());
+  EXPECT_EQ(allocator, str->get_allocator());
+}
+
+TEST(ArenaTest, FlatMap) {
+  using Map =
+      flat_map<int, int, std::less<>, ArenaVector<std::pair<int, int>>>;
+  Arena arena;
+  auto* map = arena.New<Map>(Map::container_type(ArenaAllocator<int>(&arena)));
+  for (int i = 100; i > 0; i--)
+    (*map)[i] = 2 * i;
+  EXPECT_EQ(100u, map->size());
+  EXPECT_EQ(1, map->begin()->first);
+  EXPECT_EQ(84, map->at(42));
+}
+
+#if defined(__cpp_lib_memory_resource)
+TEST(ArenaTest, MemoryResource) {
+  Arena arena;
+  ArenaMemoryResource resource(&arena);
+  ArenaMemoryResource other_resource(&arena);
+  EXPECT_TRUE(resource.is_equal(other_resource));
+
+  std::pmr::vector<std::pmr::string> strings(&resource);
+  for (int i = 0; i < 100; i++)
+    strings.emplace_back(100, 'a' + i % 26);
+  EXPECT_EQ(std::string(100, 'c'), std::string_view(strings[2]));
+  EXPECT_GT(arena.reserved_bytes(), 100u * 100u);
+}
+#endif  // defined(__cpp_lib_memory_resource)
+
+}  // namespace base
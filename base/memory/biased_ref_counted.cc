@@ -0,0 +1,291 @@
+// Copyright 2022 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "base/memory/biased_ref_counted.h"
+
+#include <stdint.h>
+
+#include "base/check_op.h"
+
+namespace base {
+namespace subtle {
+
+namespace {
+
+// The flags in the lower bits of |shared_|. Merged into the shared count,
+// which all the threads use from then on.
+constexpr int64_t kMerged = 1 << 0;
+// Queued to the owner, which merges the object.
+constexpr int64_t kQueued = 1 << 1;
+constexpr int64_t kFlagsMask = kMerged | kQueued;
+constexpr int64_t kOneRef = 1 << 2;
+
+int64_t GetSharedCount(int64_t shared) {
+  return (shared & ~kFlagsMask) / kOneRef;
+}
+
+// The head of the queue of an owner which exited, to which the objects are no
+// longer queued, but merged by the thread which would have queued them.
+const BiasedRefCountedThreadSafeBase* const kOwnerExited =
+    reinterpret_cast<const BiasedRefCountedThreadSafeBase*>(uintptr_t{1});
+
+// Trivially destructible, so that it can be read until the thread exits.
+thread_local BiasedRefCountOwner* g_tls_owner = nullptr;
+thread_local bool g_tls_owner_exited = false;
+
+}  // namespace
+
+// A thread which owns objects. Outlives the thread until all the objects it
+// owns are merged.
+class BiasedRefCountOwner {
+ public:
+  // Returns the owner of the current thread, created if needed, or nullptr if
+  // the thread is exiting.
+  static BiasedRefCountOwner* GetOrCreateForCurrentThread() {
+    if (g_tls_owner || g_tls_owner_exited)
+      return g_tls_owner;
+    // Notifies the owner once the thread exits.
+    thread_local ExitNotifier exit_notifier;
+    g_tls_owner = new BiasedRefCountOwner();
+    return g_tls_owner;
+  }
+
+  BiasedRefCountOwner(const BiasedRefCountOwner&) = delete;
+  BiasedRefCountOwner& operator=(const BiasedRefCountOwner&) = delete;
+
+  void AddObject() { ref_count_.fetch_add(1, std::memory_order_relaxed); }
+
+  void ReleaseObject() {
+    if (ref_count_.fetch_sub(1, std::memory_order_acq_rel) == 1)
+      delete this;
+  }
+
+  // Only called on the owner thread.
+  bool HasQueuedObjects() const {
+    return queue_head_.load(std::memory_order_relaxed) != nullptr;
+  }
+
+  // Queues |object| to be merged on the owner thread. If the owner exited,
+  // merges it instead, and returns true if it has no references left.
+  bool Enqueue(const BiasedRefCountedThreadSafeBase* object) {
+    const BiasedRefCountedThreadSafeBase* head =
+        queue_head_.load(std::memory_order_acquire);
+    do {
+      // |this| may be deleted by the merge.
+      if (head == kOwnerExited)
+        return object->Merge();
+      object->next_queued_ = head;
+    } while (!queue_head_.compare_exchange_weak(head, object,
+                                                std::memory_order_release,
+                                                std::memory_order_acquire));
+    return false;
+  }
+
+  // Only called on the owner thread.
+  void MergeQueuedObjects() {
+    MergeObjects(queue_head_.exchange(nullptr, std::memory_order_acquire));
+  }
+
+ private:
+  struct ExitNotifier {
+    ~ExitNotifier() {
+      // The objects released from now on, e.g. by the destructors of the
+      // other thread-local variables, are merged as those of any thread.
+      g_tls_owner_exited = true;
+      BiasedRefCountOwner* owner = g_tls_owner;
+      g_tls_owner = nullptr;
+      owner->MergeObjects(
+          owner->queue_head_.exchange(kOwnerExited, std::memory_order_acq_rel));
+      owner->ReleaseObject();
+    }
+  };
+
+  BiasedRefCountOwner() = default;
+  ~BiasedRefCountOwner() = default;
+
+  static void MergeObjects(const BiasedRefCountedThreadSafeBase* object) {
+    while (object) {
+      const BiasedRefCountedThreadSafeBase* next = object->next_queued_;
+      if (object->Merge())
+        object->destruct_(object);
+      object = next;
+    }
+  }
+
+  // One for the thread, until it exits, and one for each object it owns,
+  // until merged.
+  std::atomic<int> ref_count_{1};
+  // The objects to merge, linked by their |next_queued_|, or kOwnerExited.
+  std::atomic<const BiasedRefCountedThreadSafeBase*> queue_head_{nullptr};
+};
+
+BiasedRefCountedThreadSafeBase::BiasedRefCountedThreadSafeBase(
+    DestructFunction destruct)
+    : owner_(BiasedRefCountOwner::GetOrCreateForCurrentThread()),
+      biased_(owner_ != nullptr),
+      destruct_(destruct) {
+  if (owner_) {
+    owner_->AddObject();
+  } else {
+    // Created while the thread exits, so merged from the start.
+    biased_count_.store(0, std::memory_order_relaxed);
+    shared_.store(kOneRef | kMerged, std::memory_order_relaxed);
+  }
+}
+
+BiasedRefCountedThreadSafeBase::~BiasedRefCountedThreadSafeBase() {
+#if DCHECK_IS_ON()
+  DCHECK(in_dtor_) << "BiasedRefCountedThreadSafe object deleted without "
+                      "calling Release()";
+#endif
+}
+
+bool BiasedRefCountedThreadSafeBase::HasOneRef() const {
+  return GetRefCount() == 1;
+}
+
+bool BiasedRefCountedThreadSafeBase::HasAtLeastOneRef() const {
+  return GetRefCount() >= 1;
+}
+
+// static
+void BiasedRefCountedThreadSafeBase::MergeQueuedReferences() {
+  if (g_tls_owner)
+    g_tls_owner->MergeQueuedObjects();
+}
+
+void BiasedRefCountedThreadSafeBase::AddRef() const {
+#if DCHECK_IS_ON()
+  DCHECK(!in_dtor_);
+  // The first reference to such a object has to be made by AdoptRef or
+  // MakeRefCounted.
+  DCHECK(!needs_adopt_ref_);
+#endif
+  if (owner_ == g_tls_owner && biased_.load(std::memory_order_relaxed)) {
+    const uint32_t count = biased_count_.load(std::memory_order_relaxed) + 1;
+    CHECK_NE(count, 0u);
+    biased_count_.store(count, std::memory_order_relaxed);
+    return;
+  }
+  shared_.fetch_add(kOneRef, std::memory_order_relaxed);
+}
+
+bool BiasedRefCountedThreadSafeBase::Release() const {
+#if DCHECK_IS_ON()
+  DCHECK(!in_dtor_);
+#endif
+  if (owner_ != g_tls_owner || !biased_.load(std::memory_order_relaxed))
+    return ReleaseShared();
+
+  const uint32_t count = biased_count_.load(std::memory_order_relaxed) - 1;
+  biased_count_.store(count, std::memory_order_relaxed);
+  if (!count)
+    return ReleaseLastOwnerReference();
+  // This object may be destroyed if it was queued.
+  if (UNLIKELY(owner_->HasQueuedObjects()))
+    owner_->MergeQueuedObjects();
+  return false;
+}
+
+int64_t BiasedRefCountedThreadSafeBase::GetRefCount() const {
+  int64_t shared = shared_.load(std::memory_order_acquire);
+  while (!(shared & kMerged)) {
+    // Merge() leaves |biased_count_| as is, so that the counts match if
+    // |shared_| didn't change in between.
+    const uint32_t biased_count =
+        biased_count_.load(std::memory_order_acquire);
+    const int64_t shared_after = shared_.load(std::memory_order_acquire);
+    if (shared_after == shared)
+      return GetSharedCount(shared) + biased_count;
+    shared = shared_after;
+  }
+  return GetSharedCount(shared);
+}
+
+bool BiasedRefCountedThreadSafeBase::ReleaseLastOwnerReference() const {
+  // Either merged here, or once dequeued. In both cases, the owner uses the
+  // shared count from now on.
+  biased_.store(false, std::memory_order_relaxed);
+  BiasedRefCountOwner* const owner = owner_;
+  int64_t shared = shared_.load(std::memory_order_acquire);
+  do {
+    if (shared & kQueued) {
+      // May destroy this object.
+      owner->MergeQueuedObjects();
+      return false;
+    }
+  } while (!shared_.compare_exchange_weak(shared, shared | kMerged,
+                                          std::memory_order_acq_rel,
+                                          std::memory_order_acquire));
+  // This object may be destroyed by another thread from now on.
+  owner->ReleaseObject();
+
+  if (GetSharedCount(shared))
+    return false;
+#if DCHECK_IS_ON()
+  in_dtor_ = true;
+#endif
+  return true;
+}
+
+bool BiasedRefCountedThreadSafeBase::ReleaseShared() const {
+  int64_t shared = shared_.load(std::memory_order_relaxed);
+  if (shared & kMerged) {
+    // Never unset.
+    shared = shared_.fetch_sub(kOneRef, std::memory_order_acq_rel) - kOneRef;
+  } else {
+    int64_t updated;
+    do {
+      updated = shared - kOneRef;
+      // Releases a reference added by the owner, whose count has to be
+      // merged.
+      if (!(shared & kFlagsMask) && GetSharedCount(updated) < 0)
+        updated |= kQueued;
+    } while (!shared_.compare_exchange_weak(shared, updated,
+                                            std::memory_order_acq_rel,
+                                            std::memory_order_relaxed));
+    if ((updated & kQueued) && !(shared & kQueued)) {
+      // Not merged meanwhile, since it's queued.
+      if (!owner_->Enqueue(this))
+        return false;
+#if DCHECK_IS_ON()
+      in_dtor_ = true;
+#endif
+      return true;
+    }
+    shared = updated;
+  }
+
+  if (!(shared & kMerged) || GetSharedCount(shared))
+    return false;
+#if DCHECK_IS_ON()
+  in_dtor_ = true;
+#endif
+  return true;
+}
+
+bool BiasedRefCountedThreadSafeBase::Merge() const {
+  // Only merged once, by the owner thread, or after it exited.
+  biased_.store(false, std::memory_order_relaxed);
+  BiasedRefCountOwner* const owner = owner_;
+  const int64_t biased_count = biased_count_.load(std::memory_order_relaxed);
+  // kMerged isn't set, so adding it sets it. This object may be destroyed by
+  // another thread from then on.
+  const int64_t shared =
+      shared_.fetch_add(biased_count * kOneRef + kMerged,
+                        std::memory_order_acq_rel) +
+      biased_count * kOneRef + kMerged;
+  owner->ReleaseObject();
+
+  DCHECK_GE(GetSharedCount(shared), 0);
+  if (GetSharedCount(shared))
+    return false;
+#if DCHECK_IS_ON()
+  in_dtor_ = true;
+#endif
+  return true;
+}
+
+}  // namespace subtle
+}  // namespace base
@@ -0,0 +1,180 @@
+// Copyright 2022 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#ifndef BASE_MEMORY_BIASED_REF_COUNTED_H_
+#define BASE_MEMORY_BIASED_REF_COUNTED_H_
+
+#include <stdint.h>
+
+#include <atomic>
+
+#include "base/base_export.h"
+#include "base/check.h"
+#include "base/compiler_specific.h"
+#include "base/dcheck_is_on.h"
+#include "base/memory/scoped_refptr.h"
+
+namespace base {
+namespace subtle {
+
+class BiasedRefCountOwner;
+
+class BASE_EXPORT BiasedRefCountedThreadSafeBase {
+ public:
+  BiasedRefCountedThreadSafeBase(const BiasedRefCountedThreadSafeBase&) =
+      delete;
+  BiasedRefCountedThreadSafeBase& operator=(
+      const BiasedRefCountedThreadSafeBase&) = delete;
+
+  // Exact if the caller holds a reference, as for RefCountedThreadSafe.
+  bool HasOneRef() const;
+  bool HasAtLeastOneRef() const;
+
+  // Merges the references released on other threads to the objects owned by
+  // the current thread, destroying those which are no longer referenced. Done
+  // whenever the thread releases a reference to an object it owns, and when it
+  // exits, but a long-lived thread which rarely does so may call it, e.g.
+  // between tasks.
+  static void MergeQueuedReferences();
+
+ protected:
+  using DestructFunction = void (*)(const BiasedRefCountedThreadSafeBase*);
+
+  // Starts from one reference, on the current thread, which owns the object.
+  // |destruct| destroys the object once its last reference is released.
+  explicit BiasedRefCountedThreadSafeBase(DestructFunction destruct);
+  ~BiasedRefCountedThreadSafeBase();
+
+  void AddRef() const;
+  // Returns true if the object should self-delete.
+  bool Release() const;
+
+ private:
+  friend class BiasedRefCountOwner;
+  template <typename U>
+  friend scoped_refptr<U> base::AdoptRef(U*);
+
+  void Adopted() const {
+#if DCHECK_IS_ON()
+    DCHECK(needs_adopt_ref_);
+    needs_adopt_ref_ = false;
+#endif
+  }
+
+  // Returns the number of references, as of the latest merge for the threads
+  // other than the owner.
+  int64_t GetRefCount() const;
+
+  bool ReleaseLastOwnerReference() const;
+  bool ReleaseShared() const;
+  // Adds the references of the owner to the shared ones, after which all the
+  // threads use the shared count. Returns true if none are left.
+  bool Merge() const;
+
+  // The thread which created the object, or null if it was exiting.
+  BiasedRefCountOwner* const owner_;
+  // Whether the owner uses |biased_count_|, until merged. Cleared before the
+  // merge is visible to the other threads, which may then destroy the object.
+  mutable std::atomic<bool> biased_;
+  // Only written by the owner, without atomic read-modify-writes.
+  mutable std::atomic<uint32_t> biased_count_{1};
+  // The references added and released by the other threads, which may be
+  // negative until merged, in the upper bits, and the flags in the lower
+  // ones.
+  mutable std::atomic<int64_t> shared_{0};
+  // The next object queued to the owner, to be merged.
+  mutable const BiasedRefCountedThreadSafeBase* next_queued_ = nullptr;
+  const DestructFunction destruct_;
+
+#if DCHECK_IS_ON()
+  mutable bool needs_adopt_ref_ = true;
+  mutable bool in_dtor_ = false;
+#endif
+};
+
+}  // namespace subtle
+
+template <class T, typename Traits>
+class BiasedRefCountedThreadSafe;
+
+// Default traits for BiasedRefCountedThreadSafe<T>. Deletes the object when its
+// ref count reaches 0.
+template <typename T>
+struct DefaultBiasedRefCountedThreadSafeTraits {
+  static void Destruct(const T* x) {
+    BiasedRefCountedThreadSafe<
+        T, DefaultBiasedRefCountedThreadSafeTraits>::DeleteInternal(x);
+  }
+};
+
+// A variant of RefCountedThreadSafe<T> whose references are cheaper to add and
+// release on the thread which created the object, its owner, e.g. for the
+// objects of a thread which are copied often by that thread, and only
+// sometimes shared with others, whose references then don't contend with
+// those of the owner.
+//
+//   class MyFoo : public base::BiasedRefCountedThreadSafe<MyFoo> {
+//    ...
+//    private:
+//     friend class base::BiasedRefCountedThreadSafe<MyFoo>;
+//     ~MyFoo();
+//   };
+//
+//   scoped_refptr<MyFoo> foo = base::MakeRefCounted<MyFoo>();
+//
+// The owner counts its references without atomic read-modify-writes, and the
+// other threads count theirs with atomic ones on a separate counter, which are
+// merged once the owner releases all of its references (biased reference
+// counting, Choi et al., PACT 2018). When another thread releases a reference
+// added by the owner, the object is queued to the owner, which merges the
+// counts the next time it releases a reference to an object it owns, or when
+// it exits. So the object may be destroyed on its owner thread, after the
+// release of its last reference on another thread. Only suits the objects
+// which can be destroyed on any thread, fairly late, and which are mostly
+// referenced by their owner, or by threads which balance their references.
+//
+// The reference count always starts from one, as with
+// REQUIRE_ADOPTION_FOR_REFCOUNTED_TYPE().
+template <class T, typename Traits = DefaultBiasedRefCountedThreadSafeTraits<T>>
+class BiasedRefCountedThreadSafe
+    : public subtle::BiasedRefCountedThreadSafeBase {
+ public:
+  static constexpr subtle::StartRefCountFromOneTag kRefCountPreference =
+      subtle::kStartRefCountFromOneTag;
+
+  BiasedRefCountedThreadSafe()
+      : subtle::BiasedRefCountedThreadSafeBase(&DestructThunk) {}
+
+  BiasedRefCountedThreadSafe(const BiasedRefCountedThreadSafe&) = delete;
+  BiasedRefCountedThreadSafe& operator=(const BiasedRefCountedThreadSafe&) =
+      delete;
+
+  void AddRef() const { subtle::BiasedRefCountedThreadSafeBase::AddRef(); }
+
+  void Release() const {
+    if (subtle::BiasedRefCountedThreadSafeBase::Release()) {
+      ANALYZER_SKIP_THIS_PATH();
+      Traits::Destruct(static_cast<const T*>(this));
+    }
+  }
+
+ protected:
+  ~BiasedRefCountedThreadSafe() = default;
+
+ private:
+  friend struct DefaultBiasedRefCountedThreadSafeTraits<T>;
+  template <typename U>
+  static void DeleteInternal(const U* x) {
+    delete x;
+  }
+
+  static void DestructThunk(const subtle::BiasedRefCountedThreadSafeBase* x) {
+    Traits::Destruct(static_cast<const T*>(
+        static_cast<const BiasedRefCountedThreadSafe*>(x)));
+  }
+};
+
+}  // namespace base
+
+#endif  // BASE_MEMORY_BIASED_REF_COUNTED_H_
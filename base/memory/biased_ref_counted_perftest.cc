@@ -0,0 +1,129 @@
+// Copyright 2022 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "base/memory/biased_ref_counted.h"
+#include "base/memory/raw_ptr.h"
+#include "base/memory/ref_counted.h"
+#include "base/strings/string_number_conversions.h"
+#include "base/synchronization/waitable_event.h"
+#include "base/threading/platform_thread.h"
+#include "base/time/time.h"
+#include "testing/gtest/include/gtest/gtest.h"
+#include "testing/perf/perf_result_reporter.h"
+
+namespace base {
+namespace {
+
+constexpr int kNumIterations = 100000;
+// The references held by a task queue, e.g. to the task runner to which each
+// task posts its reply.
+constexpr int kNumCopiesPerIteration = 16;
+
+constexpr char kMetricPrefixRefCounted[] = "RefCounted.";
+constexpr char kMetricCopyThroughput[] = "copy_throughput";
+
+perf_test::PerfResultReporter SetUpReporter(const std::string& story_name) {
+  perf_test::PerfResultReporter reporter(kMetricPrefixRefCounted, story_name);
+  reporter.RegisterImportantMetric(kMetricCopyThroughput, "copies/s");
+  return reporter;
+}
+
+class AtomicCounted : public RefCountedThreadSafe<AtomicCounted> {
+ public:
+  REQUIRE_ADOPTION_FOR_REFCOUNTED_TYPE();
+
+ private:
+  friend class RefCountedThreadSafe<AtomicCounted>;
+  ~AtomicCounted() = default;
+};
+
+class BiasedCounted : public BiasedRefCountedThreadSafe<BiasedCounted> {
+ private:
+  friend class BiasedRefCountedThreadSafe<BiasedCounted>;
+  ~BiasedCounted() = default;
+};
+
+// Copies references to an object of its own, or to |shared_object| if not
+// null, into a queue which it then clears.
+template <typename T>
+class CopyLoop : public PlatformThread::Delegate {
+ public:
+  CopyLoop(T* shared_object, WaitableEvent* start)
+      : shared_object_(shared_object), start_(start) {}
+  ~CopyLoop() override = default;
+
+  void ThreadMain() override {
+    scoped_refptr<T> object =
+        shared_object_ ? WrapRefCounted(shared_object_.get())
+                       : MakeRefCounted<T>();
+    std::vector<scoped_refptr<T>> queue;
+    queue.reserve(kNumCopiesPerIteration);
+    start_->Wait();
+    for (int i = 0; i < kNumIterations; ++i) {
+      for (int j = 0; j < kNumCopiesPerIteration; ++j)
+        queue.push_back(object);
+      queue.clear();
+    }
+  }
+
+ private:
+  raw_ptr<T> shared_object_;
+  raw_ptr<WaitableEvent> start_;
+};
+
+// Measures the throughput of |num_threads| threads copying references to
+// objects of their own, or to an object shared by all the threads.
+template <typename T>
+void RunCopiesTest(const std::string& type_name, bool shared) {
+  for (int num_threads : {1, 4, 32}) {
+    scoped_refptr<T> shared_object = shared ? MakeRefCounted<T>() : nullptr;
+    WaitableEvent start(WaitableEvent::ResetPolicy::MANUAL,
+                        WaitableEvent::InitialState::NOT_SIGNALED);
+    std::vector<std::unique_ptr<CopyLoop<T>>> loops;
+    std::vector<PlatformThreadHandle> thread_handles(num_threads);
+    for (auto& thread_handle : thread_handles) {
+      loops.push_back(
+          std::make_unique<CopyLoop<T>>(shared_object.get(), &start));
+      ASSERT_TRUE(
+          PlatformThread::Create(0, loops.back().get(), &thread_handle));
+    }
+
+    const TimeTicks start_time = TimeTicks::Now();
+    start.Signal();
+    for (auto& thread_handle : thread_handles)
+      PlatformThread::Join(thread_handle);
+    const TimeDelta elapsed = TimeTicks::Now() - start_time;
+
+    auto reporter = SetUpReporter(
+        type_name + (shared ? "_shared_object_" : "_own_objects_") +
+        NumberToString(num_threads) + "_threads");
+    reporter.AddResult(kMetricCopyThroughput,
+                       static_cast<double>(num_threads) * kNumIterations *
+                           kNumCopiesPerIteration / elapsed.InSecondsF());
+  }
+}
+
+}  // namespace
+
+TEST(BiasedRefCountedPerfTest, RefCountedThreadSafeOwnObjects) {
+  RunCopiesTest<AtomicCounted>("ref_counted_thread_safe", /*shared=*/false);
+}
+
+TEST(BiasedRefCountedPerfTest, BiasedRefCountedOwnObjects) {
+  RunCopiesTest<BiasedCounted>("biased_ref_counted", /*shared=*/false);
+}
+
+TEST(BiasedRefCountedPerfTest, RefCountedThreadSafeSharedObject) {
+  RunCopiesTest<AtomicCounted>("ref_counted_thread_safe", /*shared=*/true);
+}
+
+TEST(BiasedRefCountedPerfTest, BiasedRefCountedSharedObject) {
+  RunCopiesTest<BiasedCounted>("biased_ref_counted", /*shared=*/true);
+}
+
+}  // namespace base
@@ -0,0 +1,166 @@
+// Copyright 2022 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "base/memory/biased_ref_counted.h"
+
+#include <atomic>
+#include <memory>
+#include <utility>
+#include <vector>
+
+#include "base/bind.h"
+#include "base/callback.h"
+#include "base/synchronization/waitable_event.h"
+#include "base/threading/platform_thread.h"
+#include "base/threading/simple_thread.h"
+#include "testing/gtest/include/gtest/gtest.h"
+
+namespace base {
+
+namespace {
+
+class Counted : public BiasedRefCountedThreadSafe<Counted> {
+ public:
+  explicit Counted(std::atomic<PlatformThreadId>* destroyed_on)
+      : destroyed_on_(destroyed_on) {}
+
+ private:
+  friend class BiasedRefCountedThreadSafe<Counted>;
+  ~Counted() {
+    destroyed_on_->store(PlatformThread::CurrentId(),
+                         std::memory_order_relaxed);
+  }
+
+  std::atomic<PlatformThreadId>* const destroyed_on_;
+};
+
+class ClosureThread : public SimpleThread {
+ public:
+  explicit ClosureThread(OnceClosure closure)
+      : SimpleThread("ClosureThread"), closure_(std::move(closure)) {}
+
+  void Run() override { std::move(closure_).Run(); }
+
+ private:
+  OnceClosure closure_;
+};
+
+// Runs |closure| on a thread which exits before this returns.
+void RunOnOtherThread(OnceClosure closure) {
+  ClosureThread thread(std::move(closure));
+  thread.Start();
+  thread.Join();
+}
+
+}  // namespace
+
+TEST(BiasedRefCountedTest, OwnerReferences) {
+  std::atomic<PlatformThreadId> destroyed_on{kInvalidThreadId};
+  scoped_refptr<Counted> counted = MakeRefCounted<Counted>(&destroyed_on);
+  EXPECT_TRUE(counted->HasOneRef());
+  {
+    scoped_refptr<Counted> copy = counted;
+    EXPECT_FALSE(counted->HasOneRef());
+    EXPECT_TRUE(counted->HasAtLeastOneRef());
+  }
+  EXPECT_TRUE(counted->HasOneRef());
+  counted.reset();
+  EXPECT_EQ(destroyed_on.load(), PlatformThread::CurrentId());
+}
+
+TEST(BiasedRefCountedTest, LastReferenceReleasedByOtherThread) {
+  std::atomic<PlatformThreadId> destroyed_on{kInvalidThreadId};
+  scoped_refptr<Counted> counted = MakeRefCounted<Counted>(&destroyed_on);
+  std::atomic<PlatformThreadId> other_thread{kInvalidThreadId};
+  WaitableEvent referenced;
+
+  ClosureThread thread(BindOnce(
+      [](Counted* counted, WaitableEvent* referenced,
+         std::atomic<PlatformThreadId>* other_thread) {
+        other_thread->store(PlatformThread::CurrentId());
+        // Adds a reference of its own.
+        scoped_refptr<Counted> copy(counted);
+        referenced->Signal();
+        // The references of the owner are merged once it released them all.
+        while (!copy->HasOneRef())
+          PlatformThread::YieldCurrentThread();
+      },
+      Unretained(counted.get()), &referenced, &other_thread));
+  thread.Start();
+  referenced.Wait();
+  counted.reset();
+  thread.Join();
+  EXPECT_EQ(destroyed_on.load(), other_thread.load());
+}
+
+TEST(BiasedRefCountedTest, OwnerReferenceReleasedByOtherThread) {
+  std::atomic<PlatformThreadId> destroyed_on{kInvalidThreadId};
+  scoped_refptr<Counted> counted = MakeRefCounted<Counted>(&destroyed_on);
+
+  // Releases a reference added by the owner, which queues the object.
+  RunOnOtherThread(BindOnce([](scoped_refptr<Counted> copy) {},
+                            scoped_refptr<Counted>(counted)));
+  EXPECT_TRUE(counted->HasOneRef());
+  EXPECT_EQ(destroyed_on.load(), kInvalidThreadId);
+
+  counted.reset();
+  EXPECT_EQ(destroyed_on.load(), PlatformThread::CurrentId());
+}
+
+TEST(BiasedRefCountedTest, DestroyedOnOwnerThreadOnceMerged) {
+  std::atomic<PlatformThreadId> destroyed_on{kInvalidThreadId};
+  scoped_refptr<Counted> counted = MakeRefCounted<Counted>(&destroyed_on);
+
+  RunOnOtherThread(
+      BindOnce([](scoped_refptr<Counted> counted) {}, std::move(counted)));
+  EXPECT_EQ(destroyed_on.load(), kInvalidThreadId);
+
+  subtle::BiasedRefCountedThreadSafeBase::MergeQueuedReferences();
+  EXPECT_EQ(destroyed_on.load(), PlatformThread::CurrentId());
+}
+
+TEST(BiasedRefCountedTest, OwnerExited) {
+  std::atomic<PlatformThreadId> destroyed_on{kInvalidThreadId};
+  scoped_refptr<Counted> counted;
+  RunOnOtherThread(BindOnce(
+      [](scoped_refptr<Counted>* counted,
+         std::atomic<PlatformThreadId>* destroyed_on) {
+        *counted = MakeRefCounted<Counted>(destroyed_on);
+      },
+      &counted, &destroyed_on));
+  EXPECT_TRUE(counted->HasOneRef());
+
+  // Merged by the releasing thread, since the owner is gone.
+  counted.reset();
+  EXPECT_EQ(destroyed_on.load(), PlatformThread::CurrentId());
+}
+
+TEST(BiasedRefCountedTest, ManyThreads) {
+  constexpr int kNumThreads = 8;
+  constexpr int kNumCopies = 10000;
+  std::atomic<PlatformThreadId> destroyed_on{kInvalidThreadId};
+  scoped_refptr<Counted> counted = MakeRefCounted<Counted>(&destroyed_on);
+
+  std::vector<std::unique_ptr<ClosureThread>> threads;
+  for (int i = 0; i < kNumThreads; ++i) {
+    threads.push_back(std::make_unique<ClosureThread>(BindOnce(
+        [](scoped_refptr<Counted> counted) {
+          std::vector<scoped_refptr<Counted>> copies;
+          for (int j = 0; j < kNumCopies; ++j)
+            copies.push_back(counted);
+        },
+        counted)));
+    threads.back()->Start();
+  }
+  for (int j = 0; j < kNumCopies; ++j)
+    scoped_refptr<Counted> copy = counted;
+  for (auto& thread : threads)
+    thread->Join();
+
+  EXPECT_TRUE(counted->HasOneRef());
+  counted.reset();
+  EXPECT_EQ(destroyed_on.load(), PlatformThread::CurrentId());
+}
+
+}  // namespace base
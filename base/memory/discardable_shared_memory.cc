@@ -7,6 +7,7 @@
 #include <stdint.h>
 
 #include <algorithm>
+#include <iterator>
 
 #include "base/allocator/partition_allocator/page_allocator.h"
 #include "base/atomicops.h"
@@ -221,9 +222,12 @@ bool DiscardableSharedMemory::Unmap() {
 
 DiscardableSharedMemory::LockResult DiscardableSharedMemory::Lock(
     size_t offset, size_t length) {
-  DCHECK_EQ(AlignToPageSize(offset), offset);
-  DCHECK_EQ(AlignToPageSize(length), length);
+  const Range range = {offset, length};
+  return LockRanges(make_span(&range, 1u));
+}
 
+DiscardableSharedMemory::LockResult DiscardableSharedMemory::LockRanges(
+    span<const Range> ranges) {
   // Calls to this function must be synchronized properly.
   DFAKE_SCOPED_LOCK(thread_collision_warner_);
 
@@ -250,42 +254,49 @@ DiscardableSharedMemory::LockResult DiscardableSharedMemory::Lock(
     }
   }
 
-  // Zero for length means "everything onward".
-  if (!length)
-    length = AlignToPageSize(mapped_size_) - offset;
-
-  size_t start = offset / base::GetPageSize();
-  size_t end = start + length / base::GetPageSize();
-  DCHECK_LE(start, end);
-  DCHECK_LE(end, AlignToPageSize(mapped_size_) / base::GetPageSize());
+  LockResult lock_result = SUCCESS;
+  size_t locked_length = 0;
+  for (const Range& range : MergeRanges(ranges)) {
+    size_t start = range.offset / base::GetPageSize();
+    size_t end = start + range.length / base::GetPageSize();
 
-  // Add pages to |locked_page_count_|.
-  // Note: Locking a page that is already locked is an error.
-  locked_page_count_ += end - start;
+    // Add pages to |locked_page_count_|.
+    // Note: Locking a page that is already locked is an error.
+    locked_page_count_ += end - start;
 #if DCHECK_IS_ON()
-  // Detect incorrect usage by keeping track of exactly what pages are locked.
-  for (auto page = start; page < end; ++page) {
-    auto result = locked_pages_.insert(page);
-    DCHECK(result.second);
-  }
-  DCHECK_EQ(locked_pages_.size(), locked_page_count_);
+    // Detect incorrect usage by keeping track of exactly what pages are
+    // locked.
+    for (auto page = start; page < end; ++page) {
+      auto result = locked_pages_.insert(page);
+      DCHECK(result.second);
+    }
+    DCHECK_EQ(locked_pages_.size(), locked_page_count_);
 #endif
+    locked_length += range.length;
+
+#if BUILDFLAG(IS_ANDROID)
+    // Ensure that the platform won't discard the required pages.
+    LockResult range_result =
+        LockPages(shared_memory_region_,
+                  AlignToPageSize(sizeof(SharedState)) + range.offset,
+                  range.length);
+    if (range_result == FAILED || lock_result == SUCCESS)
+      lock_result = range_result;
+#endif
+  }
 
   // Always behave as if memory was purged when trying to lock a 0 byte segment.
-  if (!length)
-      return PURGED;
+  if (!locked_length)
+    return PURGED;
 
-#if BUILDFLAG(IS_ANDROID)
-  // Ensure that the platform won't discard the required pages.
-  return LockPages(shared_memory_region_,
-                   AlignToPageSize(sizeof(SharedState)) + offset, length);
-#elif BUILDFLAG(IS_APPLE)
+#if BUILDFLAG(IS_APPLE)
   // On macOS, there is no mechanism to lock pages. However, we do need to call
   // madvise(MADV_FREE_REUSE) in order to correctly update accounting for memory
   // footprint via task_info().
   //
   // Note that calling madvise(MADV_FREE_REUSE) on regions that haven't had
-  // madvise(MADV_FREE_REUSABLE) called on them has no effect.
+  // madvise(MADV_FREE_REUSABLE) called on them has no effect. It's done over
+  // the whole segment, so once per batch of ranges is enough.
   //
   // Note that the corresponding call to MADV_FREE_REUSABLE is in Purge(), since
   // that's where the memory is actually released, rather than Unlock(), which
@@ -296,47 +307,44 @@ DiscardableSharedMemory::LockResult DiscardableSharedMemory::Lock(
   madvise(static_cast<char*>(shared_memory_mapping_.memory()) +
               AlignToPageSize(sizeof(SharedState)),
           AlignToPageSize(mapped_size_), MADV_FREE_REUSE);
-  return DiscardableSharedMemory::SUCCESS;
-#else
-  return DiscardableSharedMemory::SUCCESS;
 #endif
+  return lock_result;
 }
 
 void DiscardableSharedMemory::Unlock(size_t offset, size_t length) {
-  DCHECK_EQ(AlignToPageSize(offset), offset);
-  DCHECK_EQ(AlignToPageSize(length), length);
+  const Range range = {offset, length};
+  UnlockRanges(make_span(&range, 1u));
+}
 
+void DiscardableSharedMemory::UnlockRanges(span<const Range> ranges) {
   // Calls to this function must be synchronized properly.
   DFAKE_SCOPED_LOCK(thread_collision_warner_);
 
-  // Passing zero for |length| means "everything onward". Note that |length| may
-  // still be zero after this calculation, e.g. if |mapped_size_| is zero.
-  if (!length)
-    length = AlignToPageSize(mapped_size_) - offset;
-
   DCHECK(shared_memory_mapping_.IsValid());
 
-  // Allow the pages to be discarded by the platform, if supported.
-  UnlockPages(shared_memory_region_,
-              AlignToPageSize(sizeof(SharedState)) + offset, length);
+  for (const Range& range : MergeRanges(ranges)) {
+    // Allow the pages to be discarded by the platform, if supported.
+    UnlockPages(shared_memory_region_,
+                AlignToPageSize(sizeof(SharedState)) + range.offset,
+                range.length);
 
-  size_t start = offset / base::GetPageSize();
-  size_t end = start + length / base::GetPageSize();
-  DCHECK_LE(start, end);
-  DCHECK_LE(end, AlignToPageSize(mapped_size_) / base::GetPageSize());
+    size_t start = range.offset / base::GetPageSize();
+    size_t end = start + range.length / base::GetPageSize();
 
-  // Remove pages from |locked_page_count_|.
-  // Note: Unlocking a page that is not locked is an error.
-  DCHECK_GE(locked_page_count_, end - start);
-  locked_page_count_ -= end - start;
+    // Remove pages from |locked_page_count_|.
+    // Note: Unlocking a page that is not locked is an error.
+    DCHECK_GE(locked_page_count_, end - start);
+    locked_page_count_ -= end - start;
 #if DCHECK_IS_ON()
-  // Detect incorrect usage by keeping track of exactly what pages are locked.
-  for (auto page = start; page < end; ++page) {
-    auto erased_count = locked_pages_.erase(page);
-    DCHECK_EQ(1u, erased_count);
-  }
-  DCHECK_EQ(locked_pages_.size(), locked_page_count_);
+    // Detect incorrect usage by keeping track of exactly what pages are
+    // locked.
+    for (auto page = start; page < end; ++page) {
+      auto erased_count = locked_pages_.erase(page);
+      DCHECK_EQ(1u, erased_count);
+    }
+    DCHECK_EQ(locked_pages_.size(), locked_page_count_);
 #endif
+  }
 
   // Early out and avoid releasing the platform independent lock if some pages
   // are still locked.
@@ -588,6 +596,48 @@ void DiscardableSharedMemory::UnlockPages(
 #endif
 }
 
+std::vector<DiscardableSharedMemory::Range>
+DiscardableSharedMemory::MergeRanges(span<const Range> ranges) const {
+  const size_t aligned_size = AlignToPageSize(mapped_size_);
+  std::vector<Range> merged;
+  merged.reserve(ranges.size());
+  for (Range range : ranges) {
+    DCHECK_EQ(AlignToPageSize(range.offset), range.offset);
+    DCHECK_EQ(AlignToPageSize(range.length), range.length);
+    DCHECK_LE(range.offset, aligned_size);
+    // Zero for length means "everything onward". Note that the length may
+    // still be zero after this calculation, e.g. if |mapped_size_| is zero.
+    if (!range.length)
+      range.length = aligned_size - range.offset;
+    DCHECK_LE(range.length, aligned_size - range.offset);
+    if (range.length)
+      merged.push_back(range);
+  }
+
+  // Callers usually pass sorted ranges, e.g. the Lock() and Unlock() of a
+  // single one.
+  auto by_offset = [](const Range& a, const Range& b) {
+    return a.offset < b.offset;
+  };
+  if (!std::is_sorted(merged.begin(), merged.end(), by_offset))
+    std::sort(merged.begin(), merged.end(), by_offset);
+
+  if (merged.empty())
+    return merged;
+  auto last = merged.begin();
+  for (auto it = std::next(last); it != merged.end(); ++it) {
+    DCHECK_GE(it->offset, last->offset + last->length)
+        << "Overlapping ranges";
+    if (it->offset == last->offset + last->length) {
+      last->length += it->length;
+    } else {
+      *++last = *it;
+    }
+  }
+  merged.erase(std::next(last), merged.end());
+  return merged;
+}
+
 Time DiscardableSharedMemory::Now() const {
   return Time::Now();
 }
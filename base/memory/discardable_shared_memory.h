@@ -7,8 +7,11 @@
 
 #include <stddef.h>
 
+#include <vector>
+
 #include "base/base_export.h"
 #include "base/check_op.h"
+#include "base/containers/span.h"
 #include "base/memory/shared_memory_mapping.h"
 #include "base/memory/unsafe_shared_memory_region.h"
 #include "base/threading/thread_collision_warner.h"
@@ -45,6 +48,13 @@ class BASE_EXPORT DiscardableSharedMemory {
  public:
   enum LockResult { SUCCESS, PURGED, FAILED };
 
+  // A range of memory for LockRanges() and UnlockRanges(), with the same
+  // constraints as the |offset| and |length| of Lock() and Unlock().
+  struct Range {
+    size_t offset;
+    size_t length;
+  };
+
   DiscardableSharedMemory();
 
   // Create a new DiscardableSharedMemory object from an existing, open shared
@@ -109,6 +119,20 @@ class BASE_EXPORT DiscardableSharedMemory {
   // Passing 0 for |length| means "everything onward".
   void Unlock(size_t offset, size_t length);
 
+  // Same as calling Lock() for each of |ranges|, which must not overlap, but
+  // the platform independent lock is acquired at most once, and adjacent
+  // ranges are merged, so that platforms supporting discardable pages lock
+  // each merged range at once. Returns FAILED if the platform independent
+  // lock could not be acquired, in which case no range is locked. Otherwise,
+  // all the ranges are locked and must be unlocked, and the result is the
+  // worst of the results of the merged ranges: FAILED if locking the pages of
+  // any failed, PURGED if any was purged, and SUCCESS otherwise.
+  LockResult LockRanges(span<const Range> ranges);
+
+  // Same as calling Unlock() for each of |ranges|, which must not overlap,
+  // with the same merging as LockRanges().
+  void UnlockRanges(span<const Range> ranges);
+
   // Gets a pointer to the opened discardable memory space. Discardable memory
   // must have been mapped via Map().
   void* memory() const;
@@ -179,6 +203,10 @@ class BASE_EXPORT DiscardableSharedMemory {
                           size_t offset,
                           size_t length);
 
+  // Returns |ranges| with lengths of 0 made explicit, sorted by offset, and
+  // with the adjacent ones merged.
+  std::vector<Range> MergeRanges(span<const Range> ranges) const;
+
   // Virtual for tests.
   virtual Time Now() const;
 
@@ -0,0 +1,185 @@
+// Copyright 2022 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "base/memory/discardable_shared_memory.h"
+
+#include <stdint.h>
+
+#include <algorithm>
+#include <atomic>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "base/memory/page_size.h"
+#include "base/time/time.h"
+#include "base/timer/lap_timer.h"
+#include "build/build_config.h"
+#include "testing/gtest/include/gtest/gtest.h"
+#include "testing/perf/perf_result_reporter.h"
+
+#if BUILDFLAG(IS_POSIX) && !BUILDFLAG(IS_NACL) && !BUILDFLAG(IS_APPLE)
+#include "base/memory/madv_free_discardable_memory_posix.h"
+#define WITH_MADV_FREE_DISCARDABLE_MEMORY
+#endif
+
+namespace base {
+namespace {
+
+constexpr TimeDelta kTimeLimit = Seconds(2);
+constexpr int kWarmupRuns = 10;
+constexpr int kTimeCheckInterval = 10;
+// An image cache locks and unlocks many small ranges per frame.
+constexpr size_t kRangesPerLap = 1024;
+
+constexpr char kMetricPrefixDiscardableSharedMemory[] =
+    "DiscardableSharedMemory.";
+constexpr char kMetricThroughput[] = "throughput";
+constexpr char kMetricTimePerRange[] = "time_per_range";
+constexpr char kMetricSyscallsPerSecond[] = "syscalls_per_second";
+
+perf_test::PerfResultReporter SetUpReporter(const std::string& story_name) {
+  perf_test::PerfResultReporter reporter(kMetricPrefixDiscardableSharedMemory,
+                                         story_name);
+  reporter.RegisterImportantMetric(kMetricThroughput, "runs/s");
+  reporter.RegisterImportantMetric(kMetricTimePerRange, "ns");
+  reporter.RegisterImportantMetric(kMetricSyscallsPerSecond, "runs/s");
+  return reporter;
+}
+
+void ReportResults(const std::string& story_name,
+                   const LapTimer& timer,
+                   size_t syscalls_per_lap) {
+  auto reporter = SetUpReporter(story_name);
+  float ranges_per_second = timer.LapsPerSecond() * kRangesPerLap;
+  reporter.AddResult(kMetricThroughput, ranges_per_second);
+  reporter.AddResult(kMetricTimePerRange, 1e9 / ranges_per_second);
+  reporter.AddResult(kMetricSyscallsPerSecond,
+                     timer.LapsPerSecond() * syscalls_per_lap);
+}
+
+// The number of platform calls per lap is one per range when locking them one
+// by one, and one per merged range when batching, on the platforms which
+// support discardable pages. Every other page is locked, in pairs of adjacent
+// ranges, which are merged.
+class DiscardableSharedMemoryPerfTest : public testing::Test {
+ protected:
+  void SetUp() override {
+    ASSERT_TRUE(memory_.CreateAndMap(2 * kRangesPerLap * GetPageSize()));
+    memory_.Unlock(0, 0);
+    for (size_t i = 0; i < kRangesPerLap; i++) {
+      size_t page = i / 2 * 4 + i % 2;
+      ranges_.push_back({page * GetPageSize(), GetPageSize()});
+    }
+  }
+
+  DiscardableSharedMemory memory_;
+  std::vector<DiscardableSharedMemory::Range> ranges_;
+};
+
+}  // namespace
+
+TEST_F(DiscardableSharedMemoryPerfTest, LockAndUnlockEachRange) {
+  LapTimer timer(kWarmupRuns, kTimeLimit, kTimeCheckInterval);
+  do {
+    for (const auto& range : ranges_)
+      ASSERT_NE(DiscardableSharedMemory::FAILED,
+                memory_.Lock(range.offset, range.length));
+    for (const auto& range : ranges_)
+      memory_.Unlock(range.offset, range.length);
+    timer.NextLap();
+  } while (!timer.HasTimeLimitExpired());
+  ReportResults("LockAndUnlockEachRange", timer, 2 * kRangesPerLap);
+}
+
+TEST_F(DiscardableSharedMemoryPerfTest, LockAndUnlockRanges) {
+  LapTimer timer(kWarmupRuns, kTimeLimit, kTimeCheckInterval);
+  do {
+    ASSERT_NE(DiscardableSharedMemory::FAILED, memory_.LockRanges(ranges_));
+    memory_.UnlockRanges(ranges_);
+    timer.NextLap();
+  } while (!timer.HasTimeLimitExpired());
+  ReportResults("LockAndUnlockRanges", timer, kRangesPerLap);
+}
+
+#if defined(WITH_MADV_FREE_DISCARDABLE_MEMORY)
+
+namespace {
+
+// Returns the number of madvise() calls to free |memories| at once, i.e. the
+// number of runs of adjacent mappings.
+size_t CountMappingRuns(
+    const std::vector<std::unique_ptr<MadvFreeDiscardableMemoryPosix>>&
+        memories) {
+  std::vector<uintptr_t> starts;
+  for (const auto& memory : memories)
+    starts.push_back(reinterpret_cast<uintptr_t>(memory->data()));
+  std::sort(starts.begin(), starts.end());
+  size_t runs = 1;
+  for (size_t i = 1; i < starts.size(); i++) {
+    if (starts[i] != starts[i - 1] + GetPageSize())
+      runs++;
+  }
+  return runs;
+}
+
+class MadvFreeDiscardableMemoryPerfTest : public testing::Test {
+ protected:
+  void SetUp() override {
+    if (GetMadvFreeSupport() != MadvFreeSupport::kSupported)
+      GTEST_SKIP() << "MADV_FREE is not supported";
+    for (size_t i = 0; i < kRangesPerLap; i++) {
+      memories_.push_back(std::make_unique<MadvFreeDiscardableMemoryPosix>(
+          GetPageSize(), &byte_count_));
+    }
+  }
+
+  // Unlocks and relocks all the instances, as a frame would. Stops if one was
+  // discarded under memory pressure, since it can't be locked anymore.
+  bool UnlockAndLock() {
+    for (auto& memory : memories_)
+      memory->Unlock();
+    for (auto& memory : memories_) {
+      if (!memory->Lock())
+        return false;
+    }
+    return true;
+  }
+
+  std::atomic<size_t> byte_count_{0};
+  std::vector<std::unique_ptr<MadvFreeDiscardableMemoryPosix>> memories_;
+};
+
+}  // namespace
+
+TEST_F(MadvFreeDiscardableMemoryPerfTest, UnlockAndLock) {
+  LapTimer timer(kWarmupRuns, kTimeLimit, kTimeCheckInterval);
+  do {
+    ASSERT_TRUE(UnlockAndLock());
+    timer.NextLap();
+  } while (!timer.HasTimeLimitExpired());
+  ReportResults("MadvFreeUnlockAndLock", timer, kRangesPerLap);
+}
+
+TEST_F(MadvFreeDiscardableMemoryPerfTest, UnlockAndLockDeferred) {
+  // The MADV_FREEs are applied at the end of the scope, once per run of
+  // adjacent mappings. Relocking within the scope would avoid them entirely.
+  const size_t syscalls_per_lap = CountMappingRuns(memories_);
+  LapTimer timer(kWarmupRuns, kTimeLimit, kTimeCheckInterval);
+  do {
+    {
+      MadvFreeDiscardableMemoryPosix::ScopedDeferMadvFree scope;
+      for (auto& memory : memories_)
+        memory->Unlock();
+    }
+    for (auto& memory : memories_)
+      ASSERT_TRUE(memory->Lock());
+    timer.NextLap();
+  } while (!timer.HasTimeLimitExpired());
+  ReportResults("MadvFreeUnlockAndLockDeferred", timer, syscalls_per_lap);
+}
+
+#endif  // defined(WITH_MADV_FREE_DISCARDABLE_MEMORY)
+
+}  // namespace base
@@ -360,6 +360,79 @@ TEST(DiscardableSharedMemoryTest, LockAndUnlockRange) {
   EXPECT_TRUE(rv);
 }
 
+TEST(DiscardableSharedMemoryTest, LockAndUnlockRanges) {
+  const size_t kDataSize = 32;
+
+  const size_t page_size = base::GetPageSize();
+  size_t data_size_in_bytes = kDataSize * page_size;
+
+  TestDiscardableSharedMemory memory1;
+  bool rv = memory1.CreateAndMap(data_size_in_bytes);
+  ASSERT_TRUE(rv);
+
+  UnsafeSharedMemoryRegion shared_region = memory1.DuplicateRegion();
+  ASSERT_TRUE(shared_region.IsValid());
+
+  TestDiscardableSharedMemory memory2(std::move(shared_region));
+  rv = memory2.Map(data_size_in_bytes);
+  ASSERT_TRUE(rv);
+
+  // Unlock unsorted and adjacent ranges, all but the last pages.
+  const DiscardableSharedMemory::Range kRanges[] = {
+      {4 * page_size, 2 * page_size},
+      {0, page_size},
+      {page_size, 3 * page_size},
+      {8 * page_size, 4 * page_size},
+      {6 * page_size, 2 * page_size},
+      {12 * page_size, (kDataSize - 14) * page_size},
+  };
+  memory2.SetNow(Time::FromDoubleT(1));
+  memory2.UnlockRanges(kRanges);
+
+  rv = memory1.Purge(Time::FromDoubleT(2));
+  EXPECT_FALSE(rv);
+
+  // Unlock the last pages, with a length of 0 meaning "everything onward".
+  const DiscardableSharedMemory::Range kLastPages[] = {
+      {(kDataSize - 2) * page_size, 0},
+  };
+  memory2.SetNow(Time::FromDoubleT(3));
+  memory2.UnlockRanges(kLastPages);
+
+  // Memory is unlocked, but our usage timestamp is incorrect.
+  rv = memory1.Purge(Time::FromDoubleT(4));
+  EXPECT_FALSE(rv);
+  EXPECT_EQ(Time::FromDoubleT(3), memory1.last_known_usage());
+
+  // Lock all the ranges again, which acquires the lock once.
+  memory2.SetNow(Time::FromDoubleT(5));
+  DiscardableSharedMemory::LockResult lock_rv = memory2.LockRanges(kRanges);
+  EXPECT_NE(DiscardableSharedMemory::FAILED, lock_rv);
+  EXPECT_TRUE(memory2.IsMemoryLocked());
+
+  rv = memory1.Purge(Time::FromDoubleT(6));
+  EXPECT_FALSE(rv);
+
+  // Always behave as if memory was purged when locking no pages.
+  lock_rv = memory2.LockRanges(span<const DiscardableSharedMemory::Range>());
+  EXPECT_EQ(DiscardableSharedMemory::PURGED, lock_rv);
+
+  memory2.SetNow(Time::FromDoubleT(7));
+  memory2.UnlockRanges(kRanges);
+  EXPECT_FALSE(memory2.IsMemoryLocked());
+
+  // The failed purge attempt updates the usage time, then purge succeeds.
+  rv = memory1.Purge(Time::FromDoubleT(8));
+  EXPECT_FALSE(rv);
+  EXPECT_EQ(Time::FromDoubleT(7), memory1.last_known_usage());
+  rv = memory1.Purge(Time::FromDoubleT(9));
+  EXPECT_TRUE(rv);
+
+  // Locking fails once purged, and locks nothing.
+  lock_rv = memory2.LockRanges(kRanges);
+  EXPECT_EQ(DiscardableSharedMemory::FAILED, lock_rv);
+}
+
 TEST(DiscardableSharedMemoryTest, MappedSize) {
   const uint32_t kDataSize = 1024;
 
@@ -10,6 +10,7 @@
 #include <sys/types.h>
 #include <sys/utsname.h>
 
+#include <algorithm>
 #include <atomic>
 
 #include "base/atomicops.h"
@@ -18,8 +19,10 @@
 #include "base/logging.h"
 #include "base/memory/madv_free_discardable_memory_allocator_posix.h"
 #include "base/memory/page_size.h"
+#include "base/no_destructor.h"
 #include "base/strings/string_number_conversions.h"
 #include "base/strings/stringprintf.h"
+#include "base/threading/thread_local.h"
 #include "base/tracing_buildflags.h"
 #include "build/build_config.h"
 
@@ -72,10 +75,94 @@ base::MadvFreeSupport ProbePlatformMadvFreeSupport() {
 #endif
 }
 
+base::ThreadLocalPointer<
+    base::MadvFreeDiscardableMemoryPosix::ScopedDeferMadvFree>&
+GetScopedDeferMadvFreeTLS() {
+  static base::NoDestructor<base::ThreadLocalPointer<
+      base::MadvFreeDiscardableMemoryPosix::ScopedDeferMadvFree>>
+      tls;
+  return *tls;
+}
+
 }  // namespace
 
 namespace base {
 
+MadvFreeDiscardableMemoryPosix::ScopedDeferMadvFree::ScopedDeferMadvFree() {
+  DCHECK(!Get());
+  GetScopedDeferMadvFreeTLS().Set(this);
+}
+
+MadvFreeDiscardableMemoryPosix::ScopedDeferMadvFree::~ScopedDeferMadvFree() {
+  Flush();
+  DCHECK_EQ(this, Get());
+  GetScopedDeferMadvFreeTLS().Set(nullptr);
+}
+
+// static
+MadvFreeDiscardableMemoryPosix::ScopedDeferMadvFree*
+MadvFreeDiscardableMemoryPosix::ScopedDeferMadvFree::Get() {
+  return GetScopedDeferMadvFreeTLS().Get();
+}
+
+void MadvFreeDiscardableMemoryPosix::ScopedDeferMadvFree::Flush() {
+  struct Run {
+    uintptr_t start;
+    uintptr_t end;
+  };
+  std::vector<Run> runs;
+  runs.reserve(deferred_.size());
+  for (MadvFreeDiscardableMemoryPosix* memory : deferred_) {
+    DCHECK(!memory->is_locked_);
+    DCHECK(memory->data_);
+    uintptr_t start = reinterpret_cast<uintptr_t>(memory->data_.get());
+    runs.push_back({start, start + memory->allocated_pages_ * GetPageSize()});
+    memory->defer_madv_free_scope_ = nullptr;
+  }
+  deferred_.clear();
+
+  // Successive mmap()s are often adjacent, so a single madvise() can cover
+  // several instances.
+  std::sort(runs.begin(), runs.end(),
+            [](const Run& a, const Run& b) { return a.start < b.start; });
+  size_t run_count = 0;
+  for (const Run& run : runs) {
+    if (run_count && runs[run_count - 1].end == run.start)
+      runs[run_count - 1].end = run.end;
+    else
+      runs[run_count++] = run;
+  }
+  runs.resize(run_count);
+
+#ifdef MADV_FREE
+  for (const Run& run : runs) {
+    int retval = madvise(reinterpret_cast<void*>(run.start),
+                         run.end - run.start, MADV_FREE);
+    DPCHECK(!retval);
+  }
+#endif
+}
+
+void MadvFreeDiscardableMemoryPosix::ScopedDeferMadvFree::Add(
+    MadvFreeDiscardableMemoryPosix* memory) {
+  DCHECK(!memory->defer_madv_free_scope_);
+  memory->defer_madv_free_scope_ = this;
+  memory->defer_madv_free_index_ = deferred_.size();
+  deferred_.push_back(memory);
+}
+
+void MadvFreeDiscardableMemoryPosix::ScopedDeferMadvFree::Remove(
+    MadvFreeDiscardableMemoryPosix* memory) {
+  DCHECK_EQ(this, memory->defer_madv_free_scope_);
+  DCHECK_EQ(Get(), this) << "Deferred instances must stay on the thread";
+  size_t index = memory->defer_madv_free_index_;
+  DCHECK_EQ(memory, deferred_[index]);
+  deferred_[index] = deferred_.back();
+  deferred_[index]->defer_madv_free_index_ = index;
+  deferred_.pop_back();
+  memory->defer_madv_free_scope_ = nullptr;
+}
+
 MadvFreeDiscardableMemoryPosix::MadvFreeDiscardableMemoryPosix(
     size_t size_in_bytes,
     std::atomic<size_t>* allocator_byte_count)
@@ -99,6 +186,11 @@ MadvFreeDiscardableMemoryPosix::~MadvFreeDiscardableMemoryPosix() {
 bool MadvFreeDiscardableMemoryPosix::Lock() {
   DFAKE_SCOPED_LOCK(thread_collision_warner_);
   DCHECK(!is_locked_);
+  // If the MADV_FREE was deferred, it's simply cancelled, and the pages are
+  // still resident.
+  if (defer_madv_free_scope_)
+    defer_madv_free_scope_->Remove(this);
+
   // Locking fails if the memory has been deallocated.
   if (!data_)
     return false;
@@ -137,13 +229,13 @@ void MadvFreeDiscardableMemoryPosix::Unlock() {
     UnlockPage(page_index);
   }
 
-#ifdef MADV_FREE
   if (!keep_memory_for_testing_) {
-    int retval =
-        madvise(data_, allocated_pages_ * base::GetPageSize(), MADV_FREE);
-    DPCHECK(!retval);
+    ScopedDeferMadvFree* scope = ScopedDeferMadvFree::Get();
+    if (scope)
+      scope->Add(this);
+    else
+      MadvFree();
   }
-#endif
 
 #if defined(ADDRESS_SANITIZER)
   ASAN_POISON_MEMORY_REGION(data_, allocated_pages_ * base::GetPageSize());
@@ -160,6 +252,14 @@ void* MadvFreeDiscardableMemoryPosix::data() const {
   return data_;
 }
 
+void MadvFreeDiscardableMemoryPosix::MadvFree() {
+#ifdef MADV_FREE
+  int retval =
+      madvise(data_, allocated_pages_ * base::GetPageSize(), MADV_FREE);
+  DPCHECK(!retval);
+#endif
+}
+
 bool MadvFreeDiscardableMemoryPosix::LockPage(size_t page_index) {
   // We require the byte-level representation of std::atomic<intptr_t> to be
   // equivalent to that of an intptr_t. Since std::atomic<intptr_t> has standard
@@ -317,6 +417,8 @@ bool MadvFreeDiscardableMemoryPosix::IsDiscarded() const {
 
 bool MadvFreeDiscardableMemoryPosix::Deallocate() {
   DFAKE_SCOPED_RECURSIVE_LOCK(thread_collision_warner_);
+  if (defer_madv_free_scope_)
+    defer_madv_free_scope_->Remove(this);
   if (data_) {
 #if defined(ADDRESS_SANITIZER)
     ASAN_UNPOISON_MEMORY_REGION(data_, allocated_pages_ * base::GetPageSize());
@@ -59,6 +59,35 @@ namespace base {
 //
 class BASE_EXPORT MadvFreeDiscardableMemoryPosix : public DiscardableMemory {
  public:
+  // While alive, defers the MADV_FREE of the instances unlocked on the current
+  // thread until Flush() or its destruction, which apply it once per run of
+  // adjacent mappings. An instance locked again in the meantime avoids the
+  // madvise() altogether, which makes it cheap to unlock and relock many
+  // instances, e.g. once per frame. Until then, the deferred instances must be
+  // locked or destroyed on the current thread only. Scopes can't be nested.
+  class BASE_EXPORT ScopedDeferMadvFree {
+   public:
+    ScopedDeferMadvFree();
+    ScopedDeferMadvFree(const ScopedDeferMadvFree&) = delete;
+    ScopedDeferMadvFree& operator=(const ScopedDeferMadvFree&) = delete;
+    ~ScopedDeferMadvFree();
+
+    // Applies the deferred MADV_FREEs now.
+    void Flush();
+
+    size_t deferred_count_for_testing() const { return deferred_.size(); }
+
+   private:
+    friend class MadvFreeDiscardableMemoryPosix;
+
+    static ScopedDeferMadvFree* Get();
+
+    void Add(MadvFreeDiscardableMemoryPosix* memory);
+    void Remove(MadvFreeDiscardableMemoryPosix* memory);
+
+    std::vector<MadvFreeDiscardableMemoryPosix*> deferred_;
+  };
+
   MadvFreeDiscardableMemoryPosix(size_t size_in_pages,
                                  std::atomic<size_t>* allocator_byte_count);
 
@@ -96,6 +125,8 @@ class BASE_EXPORT MadvFreeDiscardableMemoryPosix : public DiscardableMemory {
 
  private:
   bool LockPage(size_t page_index);
+  // Applies the MADV_FREE advice value to all the pages.
+  void MadvFree();
   void UnlockPage(size_t page_index);
 
   bool Deallocate();
@@ -119,6 +150,11 @@ class BASE_EXPORT MadvFreeDiscardableMemoryPosix : public DiscardableMemory {
   // If true, MADV_FREE will not be set on Unlock().
   bool keep_memory_for_testing_ = false;
 
+  // The scope deferring the MADV_FREE of the unlocked instance, if any, and
+  // the index of the instance in it.
+  raw_ptr<ScopedDeferMadvFree> defer_madv_free_scope_ = nullptr;
+  size_t defer_madv_free_index_ = 0;
+
   // Stores the first word of a page for use during locking.
   std::vector<std::atomic<intptr_t>> page_first_word_;
 
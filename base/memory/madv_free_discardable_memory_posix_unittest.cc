@@ -7,6 +7,7 @@
 
 #include <sys/mman.h>
 #include <memory>
+#include <vector>
 
 #include "base/bind.h"
 #include "base/callback.h"
@@ -138,4 +139,45 @@ TEST_F(MadvFreeDiscardableMemoryTest, LockShouldFailAfterDiscard) {
   ASSERT_FALSE(mem->IsValid());
 }
 
+TEST_F(MadvFreeDiscardableMemoryTest, DeferMadvFree) {
+  SUCCEED_IF_MADV_FREE_UNSUPPORTED();
+
+  constexpr size_t kCount = 4;
+  std::vector<std::unique_ptr<MadvFreeDiscardableMemoryPosixTester>> mems;
+  for (size_t i = 0; i < kCount; i++) {
+    mems.push_back(AllocateLockedDiscardableMemoryPagesForTest(2));
+    memset(mems.back()->data(), 0xE7, 2 * kPageSize);
+  }
+
+  {
+    MadvFreeDiscardableMemoryPosix::ScopedDeferMadvFree scope;
+    for (auto& mem : mems)
+      mem->Unlock();
+    EXPECT_EQ(kCount, scope.deferred_count_for_testing());
+
+    // Relocking cancels the deferred MADV_FREE, so the contents are kept.
+    ASSERT_TRUE(mems[1]->Lock());
+    EXPECT_EQ(kCount - 1, scope.deferred_count_for_testing());
+    EXPECT_EQ(0xE7, mems[1]->data_as<uint8_t>()[kPageSize]);
+
+    // Destroying a deferred instance removes it as well.
+    mems[2].reset();
+    EXPECT_EQ(kCount - 2, scope.deferred_count_for_testing());
+
+    scope.Flush();
+    EXPECT_EQ(0u, scope.deferred_count_for_testing());
+
+    mems[1]->Unlock();
+    EXPECT_EQ(1u, scope.deferred_count_for_testing());
+  }
+
+  // The freed instances may be discarded on relock.
+  for (auto& mem : mems) {
+    if (!mem)
+      continue;
+    bool result = mem->Lock();
+    ASSERT_EQ(result, mem->IsValid());
+  }
+}
+
 }  // namespace base
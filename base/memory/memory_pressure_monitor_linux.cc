@@ -0,0 +1,332 @@
+// Copyright 2022 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "base/memory/memory_pressure_monitor_linux.h"
+
+#include <fcntl.h>
+#include <inttypes.h>
+#include <sys/epoll.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <string>
+#include <utility>
+
+#include "base/bind.h"
+#include "base/check_op.h"
+#include "base/logging.h"
+#include "base/memory/ptr_util.h"
+#include "base/notreached.h"
+#include "base/posix/eintr_wrapper.h"
+#include "base/process/internal_linux.h"
+#include "base/strings/string_number_conversions.h"
+#include "base/strings/string_split.h"
+#include "base/strings/stringprintf.h"
+#include "base/system/sys_info_internal.h"
+
+namespace base {
+
+namespace {
+
+using MemoryPressureLevel = MemoryPressureListener::MemoryPressureLevel;
+
+constexpr MemoryPressureLevel kLevelNone =
+    MemoryPressureListener::MEMORY_PRESSURE_LEVEL_NONE;
+constexpr MemoryPressureLevel kLevelModerate =
+    MemoryPressureListener::MEMORY_PRESSURE_LEVEL_MODERATE;
+constexpr MemoryPressureLevel kLevelCritical =
+    MemoryPressureListener::MEMORY_PRESSURE_LEVEL_CRITICAL;
+
+constexpr char kSystemPressureFile[] = "/proc/pressure/memory";
+
+// The tags of the files in the epoll set.
+enum EpollTag : uint32_t {
+  kModerateTrigger,
+  kCriticalTrigger,
+  kMemoryEvents,
+};
+
+// Sets a PSI trigger on |pressure_file|, which fires when the tasks stalled on
+// memory for |stall| within |window|: some of them if |type| is "some", all
+// the non-idle ones at once if it is "full".
+ScopedFD CreateTrigger(const FilePath& pressure_file,
+                       const char* type,
+                       TimeDelta stall,
+                       TimeDelta window) {
+  ScopedFD fd(HANDLE_EINTR(open(pressure_file.value().c_str(),
+                                O_RDWR | O_NONBLOCK | O_CLOEXEC)));
+  if (!fd.is_valid())
+    return ScopedFD();
+  const std::string trigger =
+      StringPrintf("%s %" PRId64 " %" PRId64, type, stall.InMicroseconds(),
+                   window.InMicroseconds());
+  // The kernel expects the terminating null character.
+  if (HANDLE_EINTR(write(fd.get(), trigger.c_str(), trigger.size() + 1)) < 0) {
+    DPLOG(WARNING) << "Cannot set the PSI trigger \"" << trigger << "\" on "
+                   << pressure_file;
+    return ScopedFD();
+  }
+  return fd;
+}
+
+bool AddToEpoll(int epoll_fd, int fd, EpollTag tag) {
+  epoll_event event = {};
+  // The triggers, and the cgroup files, only report their events as EPOLLPRI.
+  // The cgroup files are always readable, so that EPOLLIN wouldn't do.
+  event.events = EPOLLPRI;
+  event.data.u32 = tag;
+  return epoll_ctl(epoll_fd, EPOLL_CTL_ADD, fd, &event) == 0;
+}
+
+}  // namespace
+
+namespace internal {
+
+bool ParseMemoryEvents(StringPiece contents, MemoryEventCounts* counts) {
+  struct {
+    StringPiece name;
+    uint64_t* value;
+    bool found;
+  } fields[] = {
+      {"high", &counts->high, false},
+      {"max", &counts->max, false},
+      {"oom", &counts->oom, false},
+      {"oom_kill", &counts->oom_kill, false},
+  };
+  for (StringPiece line :
+       SplitStringPiece(contents, "\n", TRIM_WHITESPACE, SPLIT_WANT_NONEMPTY)) {
+    // "<name> <count>", among which other counters, e.g. "low".
+    const size_t space = line.find(' ');
+    if (space == StringPiece::npos)
+      continue;
+    const StringPiece name = line.substr(0, space);
+    for (auto& field : fields) {
+      if (field.name != name)
+        continue;
+      if (!StringToUint64(line.substr(space + 1), field.value))
+        return false;
+      field.found = true;
+    }
+  }
+  return std::all_of(std::begin(fields), std::end(fields),
+                     [](const auto& field) { return field.found; });
+}
+
+}  // namespace internal
+
+// static
+std::unique_ptr<MemoryPressureMonitorLinux>
+MemoryPressureMonitorLinux::Create() {
+  return Create(Config());
+}
+
+// static
+std::unique_ptr<MemoryPressureMonitorLinux> MemoryPressureMonitorLinux::Create(
+    const Config& config) {
+  DCHECK_LE(config.moderate_stall, config.window);
+  DCHECK_LE(config.critical_stall, config.window);
+
+  // The pressure on the cgroup of the process is the one its limits cause,
+  // which /proc/pressure/memory, the pressure on the whole system, misses.
+  // The root cgroup has neither memory.pressure nor memory.events.
+  const FilePath cgroup_dir = internal::GetCgroupV2Directory(FilePath("/"));
+  FilePath pressure_file;
+  ScopedFD moderate_trigger;
+  ScopedFD critical_trigger;
+  for (const FilePath& file :
+       {cgroup_dir.empty() ? FilePath() : cgroup_dir.Append("memory.pressure"),
+        FilePath(kSystemPressureFile)}) {
+    if (file.empty())
+      continue;
+    moderate_trigger =
+        CreateTrigger(file, "some", config.moderate_stall, config.window);
+    critical_trigger =
+        CreateTrigger(file, "full", config.critical_stall, config.window);
+    if (moderate_trigger.is_valid() && critical_trigger.is_valid()) {
+      pressure_file = file;
+      break;
+    }
+  }
+  if (pressure_file.empty())
+    return nullptr;
+
+  ScopedFD epoll_fd(epoll_create1(EPOLL_CLOEXEC));
+  if (!epoll_fd.is_valid() ||
+      !AddToEpoll(epoll_fd.get(), moderate_trigger.get(), kModerateTrigger) ||
+      !AddToEpoll(epoll_fd.get(), critical_trigger.get(), kCriticalTrigger)) {
+    DPLOG(ERROR) << "Cannot watch the PSI triggers";
+    return nullptr;
+  }
+
+  ScopedFD memory_events;
+  if (!cgroup_dir.empty()) {
+    memory_events.reset(HANDLE_EINTR(
+        open(cgroup_dir.Append("memory.events").value().c_str(),
+             O_RDONLY | O_CLOEXEC)));
+    if (memory_events.is_valid() &&
+        !AddToEpoll(epoll_fd.get(), memory_events.get(), kMemoryEvents)) {
+      memory_events.reset();
+    }
+  }
+
+  return WrapUnique(new MemoryPressureMonitorLinux(
+      config, std::move(pressure_file), std::move(epoll_fd),
+      std::move(moderate_trigger), std::move(critical_trigger),
+      std::move(memory_events)));
+}
+
+MemoryPressureMonitorLinux::MemoryPressureMonitorLinux(
+    const Config& config,
+    FilePath pressure_file,
+    ScopedFD epoll_fd,
+    ScopedFD moderate_trigger,
+    ScopedFD critical_trigger,
+    ScopedFD memory_events)
+    : config_(config),
+      decay_(config.window * 2),
+      pressure_file_(std::move(pressure_file)),
+      epoll_fd_(std::move(epoll_fd)),
+      moderate_trigger_(std::move(moderate_trigger)),
+      critical_trigger_(std::move(critical_trigger)),
+      memory_events_(std::move(memory_events)),
+      dispatch_callback_(
+          BindRepeating(&MemoryPressureListener::NotifyMemoryPressure)) {
+  // Sets the counters the next reads are compared to.
+  ReadMemoryEvents();
+  watch_controller_ = FileDescriptorWatcher::WatchReadable(
+      epoll_fd_.get(),
+      BindRepeating(&MemoryPressureMonitorLinux::OnEpollReadable,
+                    Unretained(this)));
+}
+
+MemoryPressureMonitorLinux::~MemoryPressureMonitorLinux() {
+  DCHECK_CALLED_ON_VALID_SEQUENCE(sequence_checker_);
+}
+
+MemoryPressureLevel MemoryPressureMonitorLinux::GetCurrentPressureLevel()
+    const {
+  DCHECK_CALLED_ON_VALID_SEQUENCE(sequence_checker_);
+  return current_level_;
+}
+
+void MemoryPressureMonitorLinux::SetDispatchCallback(
+    const DispatchCallback& callback) {
+  DCHECK_CALLED_ON_VALID_SEQUENCE(sequence_checker_);
+  dispatch_callback_ = callback;
+}
+
+void MemoryPressureMonitorLinux::SignalForTesting(MemoryPressureLevel level) {
+  Signal(level);
+}
+
+void MemoryPressureMonitorLinux::OnEpollReadable() {
+  DCHECK_CALLED_ON_VALID_SEQUENCE(sequence_checker_);
+
+  epoll_event events[3];
+  const int num_events =
+      HANDLE_EINTR(epoll_wait(epoll_fd_.get(), events, std::size(events), 0));
+  MemoryPressureLevel level = kLevelNone;
+  for (int i = 0; i < num_events; ++i) {
+    const epoll_event& event = events[i];
+    switch (event.data.u32) {
+      case kModerateTrigger:
+      case kCriticalTrigger: {
+        ScopedFD* trigger = event.data.u32 == kModerateTrigger
+                                ? &moderate_trigger_
+                                : &critical_trigger_;
+        // A trigger on a cgroup which was removed errs forever.
+        if (event.events & (EPOLLERR | EPOLLHUP)) {
+          StopWatching(trigger);
+          break;
+        }
+        if (event.events & EPOLLPRI) {
+          level = std::max(level, event.data.u32 == kModerateTrigger
+                                      ? kLevelModerate
+                                      : kLevelCritical);
+        }
+        break;
+      }
+      case kMemoryEvents:
+        // Reading the file acknowledges its change.
+        level = std::max(level, ReadMemoryEvents());
+        break;
+      default:
+        NOTREACHED();
+    }
+  }
+  if (level != kLevelNone)
+    Signal(level);
+}
+
+MemoryPressureLevel MemoryPressureMonitorLinux::ReadMemoryEvents() {
+  if (!memory_events_.is_valid())
+    return kLevelNone;
+
+  char buffer[512];
+  internal::MemoryEventCounts counts;
+  if (!internal::ParseMemoryEvents(
+          internal::ReadSmallProcFile(memory_events_.get(), buffer),
+          &counts)) {
+    StopWatching(&memory_events_);
+    return kLevelNone;
+  }
+
+  MemoryPressureLevel level = kLevelNone;
+  if (counts.max > memory_event_counts_.max ||
+      counts.oom > memory_event_counts_.oom ||
+      counts.oom_kill > memory_event_counts_.oom_kill) {
+    level = kLevelCritical;
+  } else if (counts.high > memory_event_counts_.high) {
+    level = kLevelModerate;
+  }
+  memory_event_counts_ = counts;
+  return level;
+}
+
+void MemoryPressureMonitorLinux::StopWatching(ScopedFD* fd) {
+  epoll_ctl(epoll_fd_.get(), EPOLL_CTL_DEL, fd->get(), nullptr);
+  fd->reset();
+}
+
+void MemoryPressureMonitorLinux::Signal(MemoryPressureLevel level) {
+  DCHECK_CALLED_ON_VALID_SEQUENCE(sequence_checker_);
+  DCHECK_NE(level, kLevelNone);
+
+  const TimeTicks now = TimeTicks::Now();
+  if (level == kLevelCritical)
+    last_critical_signal_ = now;
+  else
+    last_moderate_signal_ = now;
+  UpdateLevel();
+
+  if (current_level_ == last_dispatched_level_ &&
+      now - last_dispatch_time_ < config_.window) {
+    return;
+  }
+  last_dispatched_level_ = current_level_;
+  last_dispatch_time_ = now;
+  dispatch_callback_.Run(current_level_);
+}
+
+void MemoryPressureMonitorLinux::UpdateLevel() {
+  const TimeTicks now = TimeTicks::Now();
+  TimeTicks expiry;
+  if (!last_critical_signal_.is_null() &&
+      now - last_critical_signal_ < decay_) {
+    current_level_ = kLevelCritical;
+    expiry = last_critical_signal_ + decay_;
+  } else if (!last_moderate_signal_.is_null() &&
+             now - last_moderate_signal_ < decay_) {
+    current_level_ = kLevelModerate;
+    expiry = last_moderate_signal_ + decay_;
+  } else {
+    current_level_ = kLevelNone;
+    decay_timer_.Stop();
+    return;
+  }
+  decay_timer_.Start(FROM_HERE, expiry - now, this,
+                     &MemoryPressureMonitorLinux::UpdateLevel);
+}
+
+}  // namespace base
@@ -0,0 +1,152 @@
+// Copyright 2022 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#ifndef BASE_MEMORY_MEMORY_PRESSURE_MONITOR_LINUX_H_
+#define BASE_MEMORY_MEMORY_PRESSURE_MONITOR_LINUX_H_
+
+#include <stdint.h>
+
+#include <memory>
+
+#include "base/base_export.h"
+#include "base/files/file_descriptor_watcher_posix.h"
+#include "base/files/file_path.h"
+#include "base/files/scoped_file.h"
+#include "base/memory/memory_pressure_monitor.h"
+#include "base/sequence_checker.h"
+#include "base/strings/string_piece.h"
+#include "base/time/time.h"
+#include "base/timer/timer.h"
+
+namespace base {
+
+namespace internal {
+
+// The counters of the memory.events file of a cgroup v2 which signal memory
+// pressure.
+struct MemoryEventCounts {
+  // The cgroup went over memory.high, and was throttled and reclaimed.
+  uint64_t high = 0;
+  // The cgroup was about to go over memory.max.
+  uint64_t max = 0;
+  uint64_t oom = 0;
+  uint64_t oom_kill = 0;
+};
+
+// Parses the contents of a memory.events file, e.g. "low 0\nhigh 12\n...".
+// Returns false if a counter is missing or malformed.
+BASE_EXPORT bool ParseMemoryEvents(StringPiece contents,
+                                   MemoryEventCounts* counts);
+
+}  // namespace internal
+
+// A MemoryPressureMonitor which derives the memory pressure from the stalls on
+// memory of the tasks, i.e. Pressure Stall Information (PSI, Linux 5.2+), and
+// from the memory.events of the cgroup v2 of the process. It sets PSI triggers
+// on the memory.pressure file of the cgroup, or on /proc/pressure/memory if it
+// can't, and is woken up by the kernel when they fire, or when memory.events
+// changes, without ever polling.
+//
+// The pressure is moderate once some of the tasks stalled on memory for
+// Config::moderate_stall within Config::window, or once the cgroup went over
+// memory.high. It is critical once all the non-idle tasks stalled at once for
+// Config::critical_stall within the window, or once the cgroup hit memory.max
+// or the OOM killer. A level lasts two windows after it was last signalled,
+// since the triggers fire at most once per window while the stalls last.
+//
+// Each signal is dispatched, with the current level, unless the same level was
+// already dispatched within the window. Dropping back to a lower level, or to
+// MEMORY_PRESSURE_LEVEL_NONE, is never dispatched.
+class BASE_EXPORT MemoryPressureMonitorLinux : public MemoryPressureMonitor {
+ public:
+  struct Config {
+    TimeDelta moderate_stall = Milliseconds(150);
+    TimeDelta critical_stall = Milliseconds(100);
+    // PSI accepts windows from 500 ms to 10 s, but only multiples of 2 s from
+    // the processes without CAP_SYS_RESOURCE.
+    TimeDelta window = Seconds(2);
+  };
+
+  // Returns a monitor which dispatches on the current sequence, which must
+  // support FileDescriptorWatcher, or null if PSI triggers can't be set, e.g.
+  // on kernels before 5.2 or without CONFIG_PSI.
+  static std::unique_ptr<MemoryPressureMonitorLinux> Create();
+  static std::unique_ptr<MemoryPressureMonitorLinux> Create(
+      const Config& config);
+
+  MemoryPressureMonitorLinux(const MemoryPressureMonitorLinux&) = delete;
+  MemoryPressureMonitorLinux& operator=(const MemoryPressureMonitorLinux&) =
+      delete;
+  ~MemoryPressureMonitorLinux() override;
+
+  // MemoryPressureMonitor:
+  MemoryPressureLevel GetCurrentPressureLevel() const override;
+  void SetDispatchCallback(const DispatchCallback& callback) override;
+
+  // The file the PSI triggers are set on.
+  const FilePath& pressure_file() const { return pressure_file_; }
+
+  // Whether the memory.events of the cgroup of the process are watched.
+  bool watches_memory_events() const { return memory_events_.is_valid(); }
+
+  // Handles |level| as if a trigger had fired for it.
+  void SignalForTesting(MemoryPressureLevel level);
+
+ private:
+  MemoryPressureMonitorLinux(const Config& config,
+                             FilePath pressure_file,
+                             ScopedFD epoll_fd,
+                             ScopedFD moderate_trigger,
+                             ScopedFD critical_trigger,
+                             ScopedFD memory_events);
+
+  // Handles the events of the triggers and of memory.events.
+  void OnEpollReadable();
+
+  // Reads memory.events, and returns the level signalled by the counters which
+  // increased since the last read. Returns MEMORY_PRESSURE_LEVEL_NONE if none
+  // did, and stops watching the file if it can't be read anymore, e.g. after
+  // the process moved to another cgroup which then was removed.
+  MemoryPressureLevel ReadMemoryEvents();
+
+  // Stops watching |fd|, which the kernel reported as broken.
+  void StopWatching(ScopedFD* fd);
+
+  void Signal(MemoryPressureLevel level);
+
+  // Updates |current_level_| from the last signals, and schedules the next
+  // update for when it decays.
+  void UpdateLevel();
+
+  const Config config_;
+  const TimeDelta decay_;
+  const FilePath pressure_file_;
+
+  // The triggers and memory.events are watched through |epoll_fd_|, which is
+  // readable when any of them has an event, since FileDescriptorWatcher only
+  // watches for readability, and these only report EPOLLPRI.
+  const ScopedFD epoll_fd_;
+  ScopedFD moderate_trigger_;
+  ScopedFD critical_trigger_;
+  ScopedFD memory_events_;
+  internal::MemoryEventCounts memory_event_counts_;
+  std::unique_ptr<FileDescriptorWatcher::Controller> watch_controller_;
+
+  MemoryPressureLevel current_level_ =
+      MemoryPressureListener::MEMORY_PRESSURE_LEVEL_NONE;
+  TimeTicks last_moderate_signal_;
+  TimeTicks last_critical_signal_;
+  MemoryPressureLevel last_dispatched_level_ =
+      MemoryPressureListener::MEMORY_PRESSURE_LEVEL_NONE;
+  TimeTicks last_dispatch_time_;
+  OneShotTimer decay_timer_;
+
+  DispatchCallback dispatch_callback_;
+
+  SEQUENCE_CHECKER(sequence_checker_);
+};
+
+}  // namespace base
+
+#endif  // BASE_MEMORY_MEMORY_PRESSURE_MONITOR_LINUX_H_
@@ -0,0 +1,113 @@
+// Copyright 2022 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "base/memory/memory_pressure_monitor_linux.h"
+
+#include <vector>
+
+#include "base/test/bind.h"
+#include "base/test/task_environment.h"
+#include "base/time/time.h"
+#include "testing/gtest/include/gtest/gtest.h"
+
+namespace base {
+
+namespace {
+
+using MemoryPressureLevel = MemoryPressureListener::MemoryPressureLevel;
+
+constexpr MemoryPressureLevel kLevelNone =
+    MemoryPressureListener::MEMORY_PRESSURE_LEVEL_NONE;
+constexpr MemoryPressureLevel kLevelModerate =
+    MemoryPressureListener::MEMORY_PRESSURE_LEVEL_MODERATE;
+constexpr MemoryPressureLevel kLevelCritical =
+    MemoryPressureListener::MEMORY_PRESSURE_LEVEL_CRITICAL;
+
+class MemoryPressureMonitorLinuxTest : public testing::Test {
+ protected:
+  void SetUp() override {
+    monitor_ = MemoryPressureMonitorLinux::Create();
+    if (!monitor_)
+      GTEST_SKIP() << "The kernel doesn't support PSI triggers.";
+    monitor_->SetDispatchCallback(BindLambdaForTesting(
+        [this](MemoryPressureLevel level) { dispatched_.push_back(level); }));
+  }
+
+  test::TaskEnvironment task_environment_{
+      test::TaskEnvironment::MainThreadType::IO,
+      test::TaskEnvironment::TimeSource::MOCK_TIME};
+  std::unique_ptr<MemoryPressureMonitorLinux> monitor_;
+  std::vector<MemoryPressureLevel> dispatched_;
+};
+
+}  // namespace
+
+TEST(MemoryPressureMonitorLinuxParseTest, ParseMemoryEvents) {
+  internal::MemoryEventCounts counts;
+  EXPECT_TRUE(internal::ParseMemoryEvents(
+      "low 0\nhigh 12\nmax 3\noom 1\noom_kill 1\noom_group_kill 0\n",
+      &counts));
+  EXPECT_EQ(counts.high, 12u);
+  EXPECT_EQ(counts.max, 3u);
+  EXPECT_EQ(counts.oom, 1u);
+  EXPECT_EQ(counts.oom_kill, 1u);
+
+  EXPECT_FALSE(internal::ParseMemoryEvents("", &counts));
+  EXPECT_FALSE(internal::ParseMemoryEvents("high 1\nmax 2\n", &counts));
+  EXPECT_FALSE(internal::ParseMemoryEvents(
+      "high x\nmax 0\noom 0\noom_kill 0\n", &counts));
+}
+
+TEST_F(MemoryPressureMonitorLinuxTest, Create) {
+  EXPECT_EQ(MemoryPressureMonitor::Get(), monitor_.get());
+  EXPECT_FALSE(monitor_->pressure_file().empty());
+  EXPECT_EQ(monitor_->GetCurrentPressureLevel(), kLevelNone);
+}
+
+TEST_F(MemoryPressureMonitorLinuxTest, Decay) {
+  const TimeDelta window = MemoryPressureMonitorLinux::Config().window;
+
+  monitor_->SignalForTesting(kLevelModerate);
+  EXPECT_EQ(monitor_->GetCurrentPressureLevel(), kLevelModerate);
+  task_environment_.FastForwardBy(window);
+  monitor_->SignalForTesting(kLevelCritical);
+  EXPECT_EQ(monitor_->GetCurrentPressureLevel(), kLevelCritical);
+  EXPECT_EQ(dispatched_,
+            std::vector<MemoryPressureLevel>({kLevelModerate, kLevelCritical}));
+
+  // A moderate signal doesn't lower the level.
+  task_environment_.FastForwardBy(window);
+  monitor_->SignalForTesting(kLevelModerate);
+  EXPECT_EQ(monitor_->GetCurrentPressureLevel(), kLevelCritical);
+
+  // The critical level decays to the moderate one, then to none, without
+  // being dispatched.
+  dispatched_.clear();
+  task_environment_.FastForwardBy(window);
+  EXPECT_EQ(monitor_->GetCurrentPressureLevel(), kLevelModerate);
+  task_environment_.FastForwardBy(window);
+  EXPECT_EQ(monitor_->GetCurrentPressureLevel(), kLevelNone);
+  EXPECT_TRUE(dispatched_.empty());
+}
+
+TEST_F(MemoryPressureMonitorLinuxTest, DispatchRateLimited) {
+  const TimeDelta window = MemoryPressureMonitorLinux::Config().window;
+
+  for (int i = 0; i < 10; ++i) {
+    monitor_->SignalForTesting(kLevelModerate);
+    task_environment_.FastForwardBy(window / 10);
+  }
+  EXPECT_EQ(dispatched_, std::vector<MemoryPressureLevel>({kLevelModerate}));
+
+  // A new signal once the window elapsed, or one for a higher level, is
+  // dispatched.
+  monitor_->SignalForTesting(kLevelModerate);
+  monitor_->SignalForTesting(kLevelCritical);
+  monitor_->SignalForTesting(kLevelCritical);
+  EXPECT_EQ(dispatched_,
+            std::vector<MemoryPressureLevel>(
+                {kLevelModerate, kLevelModerate, kLevelCritical}));
+}
+
+}  // namespace base
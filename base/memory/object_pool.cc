@@ -0,0 +1,314 @@
+// Copyright 2022 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "base/memory/object_pool.h"
+
+#include <stdlib.h>
+
+#include <algorithm>
+
+#include "base/check_op.h"
+#include "base/process/memory.h"
+
+#if BUILDFLAG(ENABLE_BASE_TRACING)
+#include "base/strings/stringprintf.h"
+#include "base/trace_event/memory_allocator_dump.h"  // no-presubmit-check
+#include "base/trace_event/memory_dump_manager.h"    // no-presubmit-check
+#include "base/trace_event/memory_dump_provider.h"   // no-presubmit-check
+#include "base/trace_event/process_memory_dump.h"    // no-presubmit-check
+#endif  // BUILDFLAG(ENABLE_BASE_TRACING)
+
+namespace base {
+namespace internal {
+
+#if BUILDFLAG(ENABLE_BASE_TRACING)
+// Unregistering a dump provider without a task runner can race with
+// OnMemoryDump(), so the pool detaches its provider when it's destroyed, and
+// lets the MemoryDumpManager delete it.
+class ObjectPoolBase::DumpProvider : public trace_event::MemoryDumpProvider {
+ public:
+  DumpProvider(ObjectPoolBase* pool, const char* name)
+      : name_(name), pool_(pool) {}
+  ~DumpProvider() override = default;
+
+  void Detach() {
+    AutoLock lock(lock_);
+    pool_ = nullptr;
+  }
+
+  // trace_event::MemoryDumpProvider:
+  bool OnMemoryDump(const trace_event::MemoryDumpArgs& args,
+                    trace_event::ProcessMemoryDump* pmd) override {
+    AutoLock lock(lock_);
+    if (!pool_)
+      return true;
+
+    size_t allocated_slots = pool_->allocated_slots();
+    size_t cached_slots = pool_->CachedSlots();
+    // The counts are racy.
+    cached_slots = std::min(cached_slots, allocated_slots);
+
+    trace_event::MemoryAllocatorDump* dump =
+        pmd->CreateAllocatorDump(StringPrintf("object_pool/%s", name_));
+    dump->AddScalar(trace_event::MemoryAllocatorDump::kNameSize,
+                    trace_event::MemoryAllocatorDump::kUnitsBytes,
+                    allocated_slots * pool_->slot_size_);
+    dump->AddScalar(trace_event::MemoryAllocatorDump::kNameObjectCount,
+                    trace_event::MemoryAllocatorDump::kUnitsObjects,
+                    allocated_slots - cached_slots);
+    dump->AddScalar("cached_size",
+                    trace_event::MemoryAllocatorDump::kUnitsBytes,
+                    cached_slots * pool_->slot_size_);
+
+    const char* system_allocator_pool_name =
+        trace_event::MemoryDumpManager::GetInstance()
+            ->system_allocator_pool_name();
+    if (system_allocator_pool_name)
+      pmd->AddSuballocation(dump->guid(), system_allocator_pool_name);
+    return true;
+  }
+
+ private:
+  const char* const name_;
+  Lock lock_;
+  ObjectPoolBase* pool_ GUARDED_BY(lock_);
+};
+#endif  // BUILDFLAG(ENABLE_BASE_TRACING)
+
+ObjectPoolBase::ObjectPoolBase(const char* name,
+                               size_t slot_size,
+                               size_t max_depot_magazines)
+    : slot_size_(slot_size), max_depot_magazines_(max_depot_magazines) {
+  DCHECK(name);
+  DCHECK_GT(slot_size_, 0u);
+#if BUILDFLAG(ENABLE_BASE_TRACING)
+  dump_provider_ = std::make_unique<DumpProvider>(this, name);
+  trace_event::MemoryDumpManager::GetInstance()->RegisterDumpProvider(
+      dump_provider_.get(), name, nullptr);
+#endif
+}
+
+ObjectPoolBase::~ObjectPoolBase() {
+#if BUILDFLAG(ENABLE_BASE_TRACING)
+  dump_provider_->Detach();
+  trace_event::MemoryDumpManager::GetInstance()
+      ->UnregisterAndDeleteDumpProviderSoon(std::move(dump_provider_));
+#endif
+
+  {
+    AutoLock lock(lock_);
+    // The threads which are still alive won't run OnThreadExit() once
+    // |thread_cache_| is freed.
+    while (thread_caches_)
+      DestroyThreadCache(thread_caches_);
+  }
+  Purge();
+  DCHECK_EQ(0u, allocated_slots())
+      << "Objects from the pool outlive it";
+}
+
+void ObjectPoolBase::Purge() {
+  Magazine* full_magazines;
+  Magazine* empty_magazines;
+  {
+    AutoLock lock(lock_);
+    full_magazines = full_magazines_;
+    full_magazines_ = nullptr;
+    full_magazine_count_ = 0;
+    empty_magazines = empty_magazines_;
+    empty_magazines_ = nullptr;
+    empty_magazine_count_ = 0;
+  }
+
+  // Frees the slots outside of the lock, since it's the slow part.
+  while (full_magazines) {
+    Magazine* magazine = full_magazines;
+    full_magazines = magazine->next;
+    FreeSlots(magazine);
+    delete magazine;
+  }
+  while (empty_magazines) {
+    Magazine* magazine = empty_magazines;
+    empty_magazines = magazine->next;
+    delete magazine;
+  }
+}
+
+size_t ObjectPoolBase::CachedSlots() {
+  AutoLock lock(lock_);
+  size_t cached_slots = full_magazine_count_ * kMagazineCapacity;
+  for (ThreadCache* cache = thread_caches_; cache; cache = cache->next)
+    cached_slots += cache->cached_slots.load(std::memory_order_relaxed);
+  return cached_slots;
+}
+
+// static
+void ObjectPoolBase::OnThreadExit(void* value) {
+  ThreadCache* cache = static_cast<ThreadCache*>(value);
+  ObjectPoolBase* pool = cache->pool;
+  {
+    AutoLock lock(pool->lock_);
+    // Keeps the slots of the thread for the other threads, if the depot has
+    // room for them.
+    for (Magazine** magazine : {&cache->loaded, &cache->previous}) {
+      if ((*magazine)->count == kMagazineCapacity &&
+          pool->full_magazine_count_ < pool->max_depot_magazines_) {
+        (*magazine)->next = pool->full_magazines_;
+        pool->full_magazines_ = *magazine;
+        pool->full_magazine_count_++;
+        *magazine = nullptr;
+      }
+    }
+    pool->DestroyThreadCache(cache);
+  }
+}
+
+void* ObjectPoolBase::AllocSlotSlow() {
+  ThreadCache* cache = GetOrCreateThreadCache();
+  DCHECK_EQ(0u, cache->loaded->count);
+
+  if (!cache->previous->count) {
+    AutoLock lock(lock_);
+    if (full_magazines_) {
+      // Exchanges the empty magazine for a full one.
+      Magazine* full = full_magazines_;
+      full_magazines_ = full->next;
+      full_magazine_count_--;
+      PutEmptyMagazine(cache->previous);
+      cache->previous = full;
+      cache->cached_slots.store(
+          cache->cached_slots.load(std::memory_order_relaxed) + full->count,
+          std::memory_order_relaxed);
+    }
+  }
+
+  if (cache->previous->count) {
+    std::swap(cache->loaded, cache->previous);
+    return AllocSlot();
+  }
+
+  // The pool is empty.
+  return AllocFromAllocator();
+}
+
+void ObjectPoolBase::FreeSlotSlow(void* slot) {
+  ThreadCache* cache = GetOrCreateThreadCache();
+  if (cache->loaded->count < kMagazineCapacity) {
+    // The thread cache was just created.
+    FreeSlot(slot);
+    return;
+  }
+
+  if (cache->previous->count == kMagazineCapacity) {
+    Magazine* empty = nullptr;
+    {
+      AutoLock lock(lock_);
+      if (full_magazine_count_ < max_depot_magazines_) {
+        // Exchanges the full magazine for an empty one.
+        cache->previous->next = full_magazines_;
+        full_magazines_ = cache->previous;
+        full_magazine_count_++;
+        if (empty_magazines_) {
+          empty = empty_magazines_;
+          empty_magazines_ = empty->next;
+          empty_magazine_count_--;
+        }
+        cache->previous = nullptr;
+        cache->cached_slots.store(
+            cache->cached_slots.load(std::memory_order_relaxed) -
+                kMagazineCapacity,
+            std::memory_order_relaxed);
+      }
+    }
+
+    if (cache->previous) {
+      // The depot is full, so the thread returns a magazine worth of slots to
+      // the allocator, rather than a slot at a time.
+      cache->cached_slots.store(
+          cache->cached_slots.load(std::memory_order_relaxed) -
+              cache->previous->count,
+          std::memory_order_relaxed);
+      FreeSlots(cache->previous);
+    } else {
+      cache->previous = empty ? empty : new Magazine();
+      DCHECK_EQ(0u, cache->previous->count);
+    }
+  }
+
+  std::swap(cache->loaded, cache->previous);
+  FreeSlot(slot);
+}
+
+ObjectPoolBase::ThreadCache* ObjectPoolBase::GetOrCreateThreadCache() {
+  ThreadCache* cache = static_cast<ThreadCache*>(thread_cache_.Get());
+  if (cache)
+    return cache;
+
+  cache = new ThreadCache();
+  cache->pool = this;
+  cache->loaded = new Magazine();
+  cache->previous = new Magazine();
+  cache->prev = nullptr;
+  {
+    AutoLock lock(lock_);
+    cache->next = thread_caches_;
+    if (thread_caches_)
+      thread_caches_->prev = cache;
+    thread_caches_ = cache;
+  }
+  thread_cache_.Set(cache);
+  return cache;
+}
+
+void ObjectPoolBase::DestroyThreadCache(ThreadCache* cache) {
+  if (cache->prev)
+    cache->prev->next = cache->next;
+  else
+    thread_caches_ = cache->next;
+  if (cache->next)
+    cache->next->prev = cache->prev;
+
+  for (Magazine* magazine : {cache->loaded, cache->previous}) {
+    // OnThreadExit() may have moved it to the depot.
+    if (!magazine)
+      continue;
+    FreeSlots(magazine);
+    PutEmptyMagazine(magazine);
+  }
+  delete cache;
+}
+
+void ObjectPoolBase::PutEmptyMagazine(Magazine* magazine) {
+  DCHECK_EQ(0u, magazine->count);
+  if (empty_magazine_count_ >= max_depot_magazines_) {
+    delete magazine;
+    return;
+  }
+  magazine->next = empty_magazines_;
+  empty_magazines_ = magazine;
+  empty_magazine_count_++;
+}
+
+void ObjectPoolBase::FreeSlots(Magazine* magazine) {
+  for (size_t i = 0; i < magazine->count; i++)
+    FreeToAllocator(magazine->slots[i]);
+  magazine->count = 0;
+}
+
+void* ObjectPoolBase::AllocFromAllocator() {
+  void* slot = malloc(slot_size_);
+  if (!slot)
+    TerminateBecauseOutOfMemory(slot_size_);
+  allocated_slots_.fetch_add(1, std::memory_order_relaxed);
+  return slot;
+}
+
+void ObjectPoolBase::FreeToAllocator(void* slot) {
+  DCHECK_GT(allocated_slots(), 0u);
+  allocated_slots_.fetch_sub(1, std::memory_order_relaxed);
+  free(slot);
+}
+
+}  // namespace internal
+}  // namespace base
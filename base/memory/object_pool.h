@@ -0,0 +1,215 @@
+// Copyright 2022 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#ifndef BASE_MEMORY_OBJECT_POOL_H_
+#define BASE_MEMORY_OBJECT_POOL_H_
+
+#include <stddef.h>
+
+#include <atomic>
+#include <cstddef>
+#include <memory>
+#include <new>
+#include <utility>
+
+#include "base/base_export.h"
+#include "base/compiler_specific.h"
+#include "base/synchronization/lock.h"
+#include "base/thread_annotations.h"
+#include "base/threading/thread_local_storage.h"
+#include "base/tracing_buildflags.h"
+
+namespace base {
+
+namespace internal {
+
+// The untyped part of ObjectPool<T>, which pools slots of |slot_size| bytes.
+class BASE_EXPORT ObjectPoolBase {
+ public:
+  // The number of slots in a magazine.
+  static constexpr size_t kMagazineCapacity = 32;
+
+  ObjectPoolBase(const char* name,
+                 size_t slot_size,
+                 size_t max_depot_magazines);
+  ObjectPoolBase(const ObjectPoolBase&) = delete;
+  ObjectPoolBase& operator=(const ObjectPoolBase&) = delete;
+  ~ObjectPoolBase();
+
+  ALWAYS_INLINE void* AllocSlot() {
+    ThreadCache* cache = static_cast<ThreadCache*>(thread_cache_.Get());
+    if (LIKELY(cache && cache->loaded->count)) {
+      cache->cached_slots.store(
+          cache->cached_slots.load(std::memory_order_relaxed) - 1,
+          std::memory_order_relaxed);
+      return cache->loaded->slots[--cache->loaded->count];
+    }
+    return AllocSlotSlow();
+  }
+
+  ALWAYS_INLINE void FreeSlot(void* slot) {
+    ThreadCache* cache = static_cast<ThreadCache*>(thread_cache_.Get());
+    if (LIKELY(cache && cache->loaded->count < kMagazineCapacity)) {
+      cache->cached_slots.store(
+          cache->cached_slots.load(std::memory_order_relaxed) + 1,
+          std::memory_order_relaxed);
+      cache->loaded->slots[cache->loaded->count++] = slot;
+      return;
+    }
+    FreeSlotSlow(slot);
+  }
+
+  void Purge();
+
+  // The number of slots which the pool got from the allocator, in use or not.
+  size_t allocated_slots() const {
+    return allocated_slots_.load(std::memory_order_relaxed);
+  }
+  // The number of free slots held by the pool, in the depot and in the
+  // magazines of the threads. Racy, since the threads update theirs without
+  // synchronization.
+  size_t CachedSlots();
+
+ private:
+#if BUILDFLAG(ENABLE_BASE_TRACING)
+  class DumpProvider;
+#endif
+
+  struct Magazine {
+    Magazine* next = nullptr;
+    size_t count = 0;
+    void* slots[kMagazineCapacity];
+  };
+
+  // The magazines of a thread. |loaded| is the one used by AllocSlot() and
+  // FreeSlot(), |previous| is a spare which avoids going to the depot when
+  // allocations and deallocations alternate around a magazine boundary.
+  struct ThreadCache {
+    ObjectPoolBase* pool;
+    Magazine* loaded;
+    Magazine* previous;
+    // The slots in |loaded| and |previous|, written only by the thread, and
+    // read by CachedSlots().
+    std::atomic<size_t> cached_slots{0};
+    ThreadCache* next;
+    ThreadCache* prev;
+  };
+
+  static void OnThreadExit(void* value);
+
+  NOINLINE void* AllocSlotSlow();
+  NOINLINE void FreeSlotSlow(void* slot);
+  ThreadCache* GetOrCreateThreadCache();
+  void DestroyThreadCache(ThreadCache* cache) EXCLUSIVE_LOCKS_REQUIRED(lock_);
+
+  // Returns an empty magazine to the depot, or deletes it if the depot has
+  // enough of them.
+  void PutEmptyMagazine(Magazine* magazine) EXCLUSIVE_LOCKS_REQUIRED(lock_);
+  // Returns the slots in |magazine| to the allocator.
+  void FreeSlots(Magazine* magazine);
+
+  void* AllocFromAllocator();
+  void FreeToAllocator(void* slot);
+
+  const size_t slot_size_;
+  const size_t max_depot_magazines_;
+
+  ThreadLocalStorage::Slot thread_cache_{&OnThreadExit};
+  std::atomic<size_t> allocated_slots_{0};
+
+  Lock lock_;
+  // The depot: full magazines, which threads exchange for their empty ones,
+  // and empty magazines, which threads exchange for their full ones.
+  Magazine* full_magazines_ GUARDED_BY(lock_) = nullptr;
+  size_t full_magazine_count_ GUARDED_BY(lock_) = 0;
+  Magazine* empty_magazines_ GUARDED_BY(lock_) = nullptr;
+  size_t empty_magazine_count_ GUARDED_BY(lock_) = 0;
+  // The caches of the threads which used the pool and haven't exited yet.
+  ThreadCache* thread_caches_ GUARDED_BY(lock_) = nullptr;
+
+#if BUILDFLAG(ENABLE_BASE_TRACING)
+  std::unique_ptr<DumpProvider> dump_provider_;
+#endif
+};
+
+}  // namespace internal
+
+// A pool of objects of type T, for hot types which are allocated and freed at
+// a high rate, e.g. tasks or parser nodes. Freed objects are kept in
+// per-thread magazines of kMagazineCapacity slots, from which allocating and
+// freeing take no lock. A thread whose magazines are empty, or full, exchanges
+// one with the depot, which is shared by all threads and holds up to
+// |max_depot_magazines| full magazines. Beyond that, freed slots go back to
+// the allocator, i.e. PartitionAlloc when it's malloc(), in batches.
+//
+//   ObjectPool<Node>& NodePool() {
+//     static NoDestructor<ObjectPool<Node>> pool("Node");
+//     return *pool;
+//   }
+//
+//   Node* node = NodePool().New(args);
+//   ...
+//   NodePool().Delete(node);
+//
+// The free slots held by the pool show up in memory-infra as
+// "object_pool/<name>", as a part of malloc's allocated objects.
+//
+// A pool can be used from any thread. It must outlive all uses, and the
+// threads which used it must not use it concurrently with its destruction.
+// Pools are typically never destroyed. Purge() returns the free slots held by
+// the depot to the allocator, e.g. on memory pressure.
+template <typename T>
+class ObjectPool {
+ public:
+  static constexpr size_t kDefaultMaxDepotMagazines = 16;
+
+  struct Deleter {
+    void operator()(T* object) const { pool->Delete(object); }
+    ObjectPool* pool;
+  };
+  using UniquePtr = std::unique_ptr<T, Deleter>;
+
+  // |name| must be a string literal.
+  explicit ObjectPool(const char* name,
+                      size_t max_depot_magazines = kDefaultMaxDepotMagazines)
+      : base_(name, sizeof(T), max_depot_magazines) {
+    static_assert(alignof(T) <= alignof(std::max_align_t),
+                  "Over-aligned types are not supported.");
+  }
+  ObjectPool(const ObjectPool&) = delete;
+  ObjectPool& operator=(const ObjectPool&) = delete;
+  ~ObjectPool() = default;
+
+  template <typename... Args>
+  T* New(Args&&... args) {
+    return new (base_.AllocSlot()) T(std::forward<Args>(args)...);
+  }
+
+  // |object| must come from New() on this pool.
+  void Delete(T* object) {
+    if (!object)
+      return;
+    object->~T();
+    base_.FreeSlot(object);
+  }
+
+  template <typename... Args>
+  UniquePtr MakeUnique(Args&&... args) {
+    return UniquePtr(New(std::forward<Args>(args)...), Deleter{this});
+  }
+
+  void Purge() { base_.Purge(); }
+
+  size_t allocated_slots_for_testing() const {
+    return base_.allocated_slots();
+  }
+  size_t cached_slots_for_testing() { return base_.CachedSlots(); }
+
+ private:
+  internal::ObjectPoolBase base_;
+};
+
+}  // namespace base
+
+#endif  // BASE_MEMORY_OBJECT_POOL_H_
@@ -0,0 +1,211 @@
+// Copyright 2022 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "base/memory/object_pool.h"
+
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "base/allocator/buildflags.h"
+#include "base/allocator/partition_allocator/partition_alloc.h"
+#include "base/allocator/partition_allocator/partition_alloc_config.h"
+#include "base/check.h"
+#include "base/strings/string_number_conversions.h"
+#include "base/threading/platform_thread.h"
+#include "base/time/time.h"
+#include "base/timer/lap_timer.h"
+#include "testing/gtest/include/gtest/gtest.h"
+#include "testing/perf/perf_result_reporter.h"
+
+// When PartitionAlloc is malloc(), new and delete already use its ThreadCache,
+// and there can be only one partition with a thread cache.
+#if !BUILDFLAG(USE_PARTITION_ALLOC_AS_MALLOC) && \
+    !defined(MEMORY_TOOL_REPLACES_ALLOCATOR) &&   \
+    defined(PA_THREAD_CACHE_SUPPORTED)
+#define WITH_THREAD_CACHE_BASELINE
+#endif
+
+namespace base {
+namespace {
+
+constexpr TimeDelta kTimeLimit = Seconds(2);
+constexpr int kWarmupRuns = 100;
+constexpr int kTimeCheckInterval = 1000;
+// The number of objects allocated, then freed, in each lap, which is more than
+// the per-thread magazines of the pool hold.
+constexpr int kObjectsPerLap = 256;
+
+constexpr char kMetricPrefixObjectPool[] = "ObjectPool.";
+constexpr char kMetricThroughput[] = "throughput";
+constexpr char kMetricTimePerAllocation[] = "time_per_allocation";
+
+// A task-like object.
+struct Object {
+  explicit Object(int value) : value(value) {}
+
+  int value;
+  void* fields[7];
+};
+
+enum class AllocatorType {
+  kNewDelete,
+  kObjectPool,
+#if defined(WITH_THREAD_CACHE_BASELINE)
+  kPartitionAllocWithThreadCache,
+#endif
+};
+
+class Allocator {
+ public:
+  virtual ~Allocator() = default;
+  virtual Object* New(int value) = 0;
+  virtual void Delete(Object* object) = 0;
+};
+
+class NewDeleteAllocator : public Allocator {
+ public:
+  Object* New(int value) override { return new Object(value); }
+  void Delete(Object* object) override { delete object; }
+};
+
+class ObjectPoolAllocator : public Allocator {
+ public:
+  Object* New(int value) override { return pool_.New(value); }
+  void Delete(Object* object) override { pool_.Delete(object); }
+
+ private:
+  ObjectPool<Object> pool_{"ObjectPoolPerfTest"};
+};
+
+#if defined(WITH_THREAD_CACHE_BASELINE)
+// Only one partition with a thread cache.
+ThreadSafePartitionRoot* g_partition_root = nullptr;
+class PartitionAllocatorWithThreadCache : public Allocator {
+ public:
+  PartitionAllocatorWithThreadCache() {
+    if (!g_partition_root) {
+      g_partition_root = new ThreadSafePartitionRoot({
+          PartitionOptions::AlignedAlloc::kDisallowed,
+          PartitionOptions::ThreadCache::kEnabled,
+          PartitionOptions::Quarantine::kDisallowed,
+          PartitionOptions::Cookie::kAllowed,
+          PartitionOptions::BackupRefPtr::kDisabled,
+          PartitionOptions::UseConfigurablePool::kNo,
+      });
+    }
+  }
+
+  Object* New(int value) override {
+    return new (g_partition_root->AllocFlagsNoHooks(0, sizeof(Object),
+                                                    PartitionPageSize()))
+        Object(value);
+  }
+  void Delete(Object* object) override {
+    object->~Object();
+    ThreadSafePartitionRoot::FreeNoHooks(object);
+  }
+};
+#endif
+
+std::unique_ptr<Allocator> CreateAllocator(AllocatorType type) {
+  switch (type) {
+    case AllocatorType::kNewDelete:
+      return std::make_unique<NewDeleteAllocator>();
+    case AllocatorType::kObjectPool:
+      return std::make_unique<ObjectPoolAllocator>();
+#if defined(WITH_THREAD_CACHE_BASELINE)
+    case AllocatorType::kPartitionAllocWithThreadCache:
+      return std::make_unique<PartitionAllocatorWithThreadCache>();
+#endif
+  }
+}
+
+const char* GetAllocatorName(AllocatorType type) {
+  switch (type) {
+    case AllocatorType::kNewDelete:
+      return "NewDelete";
+    case AllocatorType::kObjectPool:
+      return "ObjectPool";
+#if defined(WITH_THREAD_CACHE_BASELINE)
+    case AllocatorType::kPartitionAllocWithThreadCache:
+      return "PartitionAllocWithThreadCache";
+#endif
+  }
+}
+
+// Allocates a batch of objects, then frees them, until the time limit.
+class AllocatingThread : public PlatformThread::Delegate {
+ public:
+  explicit AllocatingThread(Allocator* allocator) : allocator_(allocator) {}
+
+  void ThreadMain() override {
+    std::vector<Object*> objects(kObjectsPerLap);
+    LapTimer timer(kWarmupRuns, kTimeLimit, kTimeCheckInterval);
+    do {
+      for (int i = 0; i < kObjectsPerLap; i++) {
+        objects[i] = allocator_->New(i);
+        CHECK(objects[i]);
+      }
+      for (Object* object : objects)
+        allocator_->Delete(object);
+      timer.NextLap();
+    } while (!timer.HasTimeLimitExpired());
+    allocations_per_second_ = timer.LapsPerSecond() * kObjectsPerLap;
+  }
+
+  float allocations_per_second() const { return allocations_per_second_; }
+
+ private:
+  Allocator* const allocator_;
+  float allocations_per_second_ = 0;
+};
+
+constexpr AllocatorType kAllocatorTypes[] = {
+    AllocatorType::kNewDelete,
+    AllocatorType::kObjectPool,
+#if defined(WITH_THREAD_CACHE_BASELINE)
+    AllocatorType::kPartitionAllocWithThreadCache,
+#endif
+};
+
+class ObjectPoolPerfTest
+    : public testing::TestWithParam<std::tuple<int, AllocatorType>> {};
+
+INSTANTIATE_TEST_SUITE_P(,
+                         ObjectPoolPerfTest,
+                         ::testing::Combine(::testing::Values(1, 4),
+                                            ::testing::ValuesIn(
+                                                kAllocatorTypes)));
+
+}  // namespace
+
+TEST_P(ObjectPoolPerfTest, AllocateAndFree) {
+  int thread_count = std::get<0>(GetParam());
+  AllocatorType type = std::get<1>(GetParam());
+  std::unique_ptr<Allocator> allocator = CreateAllocator(type);
+
+  std::vector<std::unique_ptr<AllocatingThread>> threads;
+  std::vector<PlatformThreadHandle> handles(thread_count);
+  for (int i = 0; i < thread_count; i++) {
+    threads.push_back(std::make_unique<AllocatingThread>(allocator.get()));
+    ASSERT_TRUE(PlatformThread::Create(0, threads[i].get(), &handles[i]));
+  }
+  float total_allocations_per_second = 0;
+  for (int i = 0; i < thread_count; i++) {
+    PlatformThread::Join(handles[i]);
+    total_allocations_per_second += threads[i]->allocations_per_second();
+  }
+
+  perf_test::PerfResultReporter reporter(
+      kMetricPrefixObjectPool, std::string(GetAllocatorName(type)) + "_" +
+                                   NumberToString(thread_count));
+  reporter.RegisterImportantMetric(kMetricThroughput, "runs/s");
+  reporter.RegisterImportantMetric(kMetricTimePerAllocation, "ns");
+  reporter.AddResult(kMetricThroughput, total_allocations_per_second);
+  reporter.AddResult(kMetricTimePerAllocation,
+                     1e9 * thread_count / total_allocations_per_second);
+}
+
+}  // namespace base
@@ -0,0 +1,151 @@
+// Copyright 2022 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "base/memory/object_pool.h"
+
+#include <vector>
+
+#include "base/threading/platform_thread.h"
+#include "testing/gtest/include/gtest/gtest.h"
+
+namespace base {
+
+namespace {
+
+constexpr size_t kMagazineCapacity =
+    internal::ObjectPoolBase::kMagazineCapacity;
+
+struct Node {
+  Node(int value, int* destroyed) : value(value), destroyed(destroyed) {}
+  ~Node() { (*destroyed)++; }
+
+  int value;
+  int* destroyed;
+  char padding[40];
+};
+
+using NodePool = ObjectPool<Node>;
+
+}  // namespace
+
+TEST(ObjectPoolTest, NewDelete) {
+  NodePool pool("ObjectPoolTest");
+  int destroyed = 0;
+  Node* node = pool.New(42, &destroyed);
+  EXPECT_EQ(42, node->value);
+  EXPECT_EQ(1u, pool.allocated_slots_for_testing());
+  pool.Delete(node);
+  EXPECT_EQ(1, destroyed);
+  EXPECT_EQ(1u, pool.cached_slots_for_testing());
+
+  // The slot is reused.
+  Node* node2 = pool.New(43, &destroyed);
+  EXPECT_EQ(node, node2);
+  EXPECT_EQ(1u, pool.allocated_slots_for_testing());
+  EXPECT_EQ(0u, pool.cached_slots_for_testing());
+  pool.Delete(node2);
+
+  pool.Delete(nullptr);
+}
+
+TEST(ObjectPoolTest, MakeUnique) {
+  NodePool pool("ObjectPoolTest");
+  int destroyed = 0;
+  {
+    NodePool::UniquePtr node = pool.MakeUnique(1, &destroyed);
+    EXPECT_EQ(1, node->value);
+  }
+  EXPECT_EQ(1, destroyed);
+  EXPECT_EQ(1u, pool.cached_slots_for_testing());
+}
+
+TEST(ObjectPoolTest, Depot) {
+  NodePool pool("ObjectPoolTest");
+  int destroyed = 0;
+  std::vector<Node*> nodes;
+  // More than the thread's two magazines can hold.
+  for (size_t i = 0; i < 10 * kMagazineCapacity; i++)
+    nodes.push_back(pool.New(0, &destroyed));
+  for (Node* node : nodes)
+    pool.Delete(node);
+  EXPECT_EQ(10 * kMagazineCapacity, pool.allocated_slots_for_testing());
+  EXPECT_EQ(10 * kMagazineCapacity, pool.cached_slots_for_testing());
+
+  // All the slots are reused.
+  nodes.clear();
+  for (size_t i = 0; i < 10 * kMagazineCapacity; i++)
+    nodes.push_back(pool.New(0, &destroyed));
+  EXPECT_EQ(10 * kMagazineCapacity, pool.allocated_slots_for_testing());
+  EXPECT_EQ(0u, pool.cached_slots_for_testing());
+  for (Node* node : nodes)
+    pool.Delete(node);
+
+  // Purging empties the depot, but not the thread's magazines.
+  pool.Purge();
+  EXPECT_LE(pool.cached_slots_for_testing(), 2 * kMagazineCapacity);
+  EXPECT_EQ(pool.cached_slots_for_testing(),
+            pool.allocated_slots_for_testing());
+}
+
+TEST(ObjectPoolTest, DepotOverflow) {
+  constexpr size_t kMaxDepotMagazines = 2;
+  NodePool pool("ObjectPoolTest", kMaxDepotMagazines);
+  int destroyed = 0;
+  std::vector<Node*> nodes;
+  for (size_t i = 0; i < 20 * kMagazineCapacity; i++)
+    nodes.push_back(pool.New(0, &destroyed));
+  for (Node* node : nodes)
+    pool.Delete(node);
+
+  // The slots which the depot had no room for went back to the allocator.
+  size_t max_cached_slots = (kMaxDepotMagazines + 2) * kMagazineCapacity;
+  EXPECT_LE(pool.cached_slots_for_testing(), max_cached_slots);
+  EXPECT_EQ(pool.cached_slots_for_testing(),
+            pool.allocated_slots_for_testing());
+}
+
+TEST(ObjectPoolTest, MultipleThreads) {
+  // Each thread frees the objects allocated by the previous one, and leaves
+  // its magazines in the depot when it exits.
+  class Delegate : public PlatformThread::Delegate {
+   public:
+    Delegate(NodePool* pool, std::vector<Node*>* nodes, int* destroyed)
+        : pool_(pool), nodes_(nodes), destroyed_(destroyed) {}
+    void ThreadMain() override {
+      for (Node* node : *nodes_)
+        pool_->Delete(node);
+      nodes_->clear();
+      for (size_t i = 0; i < 4 * kMagazineCapacity; i++)
+        nodes_->push_back(pool_->New(0, destroyed_));
+    }
+
+   private:
+    NodePool* const pool_;
+    std::vector<Node*>* const nodes_;
+    int* const destroyed_;
+  };
+
+  NodePool pool("ObjectPoolTest");
+  std::vector<Node*> nodes;
+  int destroyed = 0;
+  for (int i = 0; i < 8; i++) {
+    Delegate delegate(&pool, &nodes, &destroyed);
+    PlatformThreadHandle handle;
+    ASSERT_TRUE(PlatformThread::Create(0, &delegate, &handle));
+    PlatformThread::Join(handle);
+  }
+
+  // The slots freed by the threads were reused by the next ones.
+  EXPECT_LE(pool.allocated_slots_for_testing(), 8 * kMagazineCapacity);
+  EXPECT_EQ(4 * kMagazineCapacity, pool.allocated_slots_for_testing() -
+                                       pool.cached_slots_for_testing());
+
+  for (Node* node : nodes)
+    pool.Delete(node);
+  EXPECT_EQ(static_cast<int>(8 * 4 * kMagazineCapacity), destroyed);
+  EXPECT_EQ(pool.cached_slots_for_testing(),
+            pool.allocated_slots_for_testing());
+}
+
+}  // namespace base
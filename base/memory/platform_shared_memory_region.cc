@@ -33,6 +33,22 @@ PlatformSharedMemoryRegion PlatformSharedMemoryRegion::CreateUnsafe(
   return Create(Mode::kUnsafe, size);
 }
 
+#if BUILDFLAG(IS_LINUX) || BUILDFLAG(IS_CHROMEOS)
+// static
+PlatformSharedMemoryRegion PlatformSharedMemoryRegion::CreateWritable(
+    size_t size,
+    const SharedMemoryPlacement& placement) {
+  return CreateWithPlacement(Mode::kWritable, size, placement);
+}
+
+// static
+PlatformSharedMemoryRegion PlatformSharedMemoryRegion::CreateUnsafe(
+    size_t size,
+    const SharedMemoryPlacement& placement) {
+  return CreateWithPlacement(Mode::kUnsafe, size, placement);
+}
+#endif  // BUILDFLAG(IS_LINUX) || BUILDFLAG(IS_CHROMEOS)
+
 PlatformSharedMemoryRegion::PlatformSharedMemoryRegion() = default;
 PlatformSharedMemoryRegion::PlatformSharedMemoryRegion(
     PlatformSharedMemoryRegion&& other) = default;
@@ -30,6 +30,37 @@ class SandboxIPCHandler;
 #endif
 
 namespace base {
+
+#if BUILDFLAG(IS_LINUX) || BUILDFLAG(IS_CHROMEOS)
+// How to back a large region, e.g. a buffer of several gigabytes shared
+// between processes, whose accesses would otherwise miss the TLB often, or go
+// to another NUMA node. A region created with the default options is backed
+// by system pages, allocated on the node of the thread which first touches
+// each of them.
+struct SharedMemoryPlacement {
+  enum class PageSize {
+    kDefault,
+    // Transparent huge pages, for the mappings of the region in the process
+    // which created it, if /sys/kernel/mm/transparent_hugepage/shmem_enabled
+    // allows it. The pages are allocated on first touch rather than when the
+    // region is created.
+    kTransparentHuge,
+    // Pages from the reserved pool of huge pages (see /proc/sys/vm/
+    // nr_hugepages), allocated when the region is created, which fails if
+    // the pool doesn't have enough free pages. The size of the region is
+    // rounded up to a multiple of the huge page size, and so must be the
+    // offset and size of its mappings.
+    kHugeTlb,
+  };
+
+  PageSize page_size = PageSize::kDefault;
+  // The NUMA node which all the pages of the region are allocated on, in
+  // every process which maps it, or -1 for no binding. See
+  // SysInfo::GetNumaNodeCpus() for the nodes of the system.
+  int numa_node = -1;
+};
+#endif  // BUILDFLAG(IS_LINUX) || BUILDFLAG(IS_CHROMEOS)
+
 namespace subtle {
 
 #if BUILDFLAG(IS_POSIX) && !BUILDFLAG(IS_MAC) && !BUILDFLAG(IS_ANDROID)
@@ -163,6 +194,16 @@ class BASE_EXPORT PlatformSharedMemoryRegion {
   // way to modify memory content.
   static PlatformSharedMemoryRegion CreateWritable(size_t size);
   static PlatformSharedMemoryRegion CreateUnsafe(size_t size);
+#if BUILDFLAG(IS_LINUX) || BUILDFLAG(IS_CHROMEOS)
+  // Same as above, with the pages placed as |placement| asks. Returns an
+  // invalid region if the system can't honor it.
+  static PlatformSharedMemoryRegion CreateWritable(
+      size_t size,
+      const SharedMemoryPlacement& placement);
+  static PlatformSharedMemoryRegion CreateUnsafe(
+      size_t size,
+      const SharedMemoryPlacement& placement);
+#endif
 
   // Returns a new PlatformSharedMemoryRegion that takes ownership of the
   // |handle|. All parameters must be taken from another valid
@@ -268,6 +309,12 @@ class BASE_EXPORT PlatformSharedMemoryRegion {
                                            bool executable = false
 #endif
   );
+#if BUILDFLAG(IS_LINUX) || BUILDFLAG(IS_CHROMEOS)
+  static PlatformSharedMemoryRegion CreateWithPlacement(
+      Mode mode,
+      size_t size,
+      const SharedMemoryPlacement& placement);
+#endif
 
   static bool CheckPlatformHandlePermissionsCorrespondToMode(
       PlatformHandle handle,
@@ -288,6 +335,11 @@ class BASE_EXPORT PlatformSharedMemoryRegion {
   Mode mode_ = Mode::kReadOnly;
   size_t size_ = 0;
   UnguessableToken guid_;
+#if BUILDFLAG(IS_LINUX) || BUILDFLAG(IS_CHROMEOS)
+  // Whether MapAt() advises the kernel to back the mappings with transparent
+  // huge pages. Not transferred to other processes.
+  bool advise_huge_pages_ = false;
+#endif
 };
 
 }  // namespace subtle
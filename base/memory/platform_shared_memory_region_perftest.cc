@@ -0,0 +1,100 @@
+// Copyright 2022 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include <string>
+#include <utility>
+
+#include "base/logging.h"
+#include "base/memory/unsafe_shared_memory_region.h"
+#include "base/rand_util.h"
+#include "base/time/time.h"
+#include "build/build_config.h"
+#include "testing/gtest/include/gtest/gtest.h"
+#include "testing/perf/perf_result_reporter.h"
+
+#if BUILDFLAG(IS_LINUX) || BUILDFLAG(IS_CHROMEOS)
+
+namespace base {
+namespace {
+
+// Much larger than the caches and than what the TLB covers with system pages.
+constexpr size_t kRegionSize = 1024 * 1024 * 1024;
+constexpr int kSequentialPasses = 4;
+constexpr size_t kRandomReads = 16 * 1024 * 1024;
+
+constexpr char kMetricPrefixSharedMemory[] = "SharedMemoryPlacement.";
+constexpr char kMetricSequentialBandwidth[] = "sequential_bandwidth";
+constexpr char kMetricRandomReadTime[] = "random_read_time";
+
+perf_test::PerfResultReporter SetUpReporter(const std::string& story_name) {
+  perf_test::PerfResultReporter reporter(kMetricPrefixSharedMemory,
+                                         story_name);
+  reporter.RegisterImportantMetric(kMetricSequentialBandwidth, "MB/s");
+  reporter.RegisterImportantMetric(kMetricRandomReadTime, "ns");
+  return reporter;
+}
+
+// Reports the bandwidth of summing the whole region, and the latency of
+// dependent 8-byte reads at random offsets. Does nothing if the region can't
+// be created, e.g. on huge pages when the system hasn't reserved any.
+void MeasureBandwidth(const std::string& story_name,
+                      const SharedMemoryPlacement& placement) {
+  UnsafeSharedMemoryRegion region =
+      UnsafeSharedMemoryRegion::CreateWithPlacement(kRegionSize, placement);
+  if (!region.IsValid()) {
+    LOG(WARNING) << "Skipping " << story_name;
+    return;
+  }
+  WritableSharedMemoryMapping mapping = region.Map();
+  ASSERT_TRUE(mapping.IsValid());
+  span<uint64_t> words = mapping.GetMemoryAsSpan<uint64_t>();
+  // Each word holds the index of the next word to read, the words forming a
+  // single random cycle (Sattolo's algorithm), so that the random reads can't
+  // settle in a cached part of the region.
+  for (size_t i = 0; i < words.size(); ++i)
+    words[i] = i;
+  for (size_t i = words.size() - 1; i > 0; --i)
+    std::swap(words[i], words[FastRandGenerator(i)]);
+
+  uint64_t sum = 0;
+  TimeTicks start = TimeTicks::Now();
+  for (int pass = 0; pass < kSequentialPasses; ++pass) {
+    for (uint64_t word : words)
+      sum += word;
+  }
+  const TimeDelta sequential_time = TimeTicks::Now() - start;
+
+  uint64_t index = 0;
+  start = TimeTicks::Now();
+  for (size_t i = 0; i < kRandomReads; ++i)
+    index = words[index];
+  const TimeDelta random_time = TimeTicks::Now() - start;
+  EXPECT_NE(sum + index, 0u);
+
+  auto reporter = SetUpReporter(story_name);
+  reporter.AddResult(kMetricSequentialBandwidth,
+                     kSequentialPasses * kRegionSize /
+                         sequential_time.InSecondsF() / (1024 * 1024));
+  reporter.AddResult(kMetricRandomReadTime,
+                     static_cast<double>(random_time.InNanoseconds()) /
+                         kRandomReads);
+}
+
+}  // namespace
+
+TEST(SharedMemoryPlacementPerfTest, Bandwidth) {
+  using PageSize = SharedMemoryPlacement::PageSize;
+  MeasureBandwidth("system_pages", {});
+  MeasureBandwidth("transparent_huge_pages", {PageSize::kTransparentHuge});
+  MeasureBandwidth("hugetlb_pages", {PageSize::kHugeTlb});
+  MeasureBandwidth("system_pages_node_0", {PageSize::kDefault, 0});
+  MeasureBandwidth("hugetlb_pages_node_0", {PageSize::kHugeTlb, 0});
+}
+
+}  // namespace base
+
+#endif  // BUILDFLAG(IS_LINUX) || BUILDFLAG(IS_CHROMEOS)
@@ -14,6 +14,17 @@
 #include "base/threading/thread_restrictions.h"
 #include "build/build_config.h"
 
+#if BUILDFLAG(IS_LINUX) || BUILDFLAG(IS_CHROMEOS)
+#include <linux/memfd.h>
+#include <linux/mempolicy.h>
+#include <sys/stat.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+
+#include "base/bits.h"
+#include "base/strings/stringprintf.h"
+#endif
+
 namespace base {
 namespace subtle {
 
@@ -53,6 +64,28 @@ bool CheckFDAccessMode(int fd, int expected_mode) {
 }
 #endif  // !BUILDFLAG(IS_NACL)
 
+#if BUILDFLAG(IS_LINUX) || BUILDFLAG(IS_CHROMEOS)
+// The size of the node mask passed to mbind(), which is larger than the
+// kernel's MAX_NUMNODES.
+constexpr int kMaxNumaNodes = 1024;
+
+// Binds the pages of |memory| to |node|. For shared memory, the binding
+// belongs to the memory object rather than to the mapping, so it also applies
+// to the other mappings of the region, in any process.
+bool BindToNumaNode(void* memory, size_t size, int node) {
+  constexpr int kBitsPerLong = 8 * sizeof(unsigned long);
+  unsigned long node_mask[kMaxNumaNodes / kBitsPerLong] = {};
+  node_mask[node / kBitsPerLong] |= 1UL << (node % kBitsPerLong);
+  // The kernel reads one bit less than |maxnode|.
+  if (syscall(SYS_mbind, memory, size, MPOL_BIND, node_mask, kMaxNumaNodes + 1,
+              0) != 0) {
+    DPLOG(ERROR) << "mbind to node " << node << " failed";
+    return false;
+  }
+  return true;
+}
+#endif  // BUILDFLAG(IS_LINUX) || BUILDFLAG(IS_CHROMEOS)
+
 }  // namespace
 
 ScopedFDPair::ScopedFDPair() = default;
@@ -155,8 +188,12 @@ PlatformSharedMemoryRegion PlatformSharedMemoryRegion::Duplicate() const {
     return {};
   }
 
-  return PlatformSharedMemoryRegion({std::move(duped_fd), ScopedFD()}, mode_,
-                                    size_, guid_);
+  PlatformSharedMemoryRegion duplicate({std::move(duped_fd), ScopedFD()},
+                                       mode_, size_, guid_);
+#if BUILDFLAG(IS_LINUX) || BUILDFLAG(IS_CHROMEOS)
+  duplicate.advise_huge_pages_ = advise_huge_pages_;
+#endif
+  return duplicate;
 }
 
 bool PlatformSharedMemoryRegion::ConvertToReadOnly() {
@@ -197,6 +234,12 @@ bool PlatformSharedMemoryRegion::MapAtInternal(off_t offset,
     return false;
   }
 
+#if BUILDFLAG(IS_LINUX) || BUILDFLAG(IS_CHROMEOS)
+  // Only a hint, which the kernel may not follow anyway.
+  if (advise_huge_pages_ && madvise(*memory, size, MADV_HUGEPAGE) != 0)
+    DPLOG(WARNING) << "madvise(MADV_HUGEPAGE) failed";
+#endif
+
   *mapped_size = size;
   return true;
 }
@@ -304,6 +347,107 @@ PlatformSharedMemoryRegion PlatformSharedMemoryRegion::Create(Mode mode,
 #endif  // !BUILDFLAG(IS_NACL)
 }
 
+#if BUILDFLAG(IS_LINUX) || BUILDFLAG(IS_CHROMEOS)
+// static
+PlatformSharedMemoryRegion PlatformSharedMemoryRegion::CreateWithPlacement(
+    Mode mode,
+    size_t size,
+    const SharedMemoryPlacement& placement) {
+  using PageSize = SharedMemoryPlacement::PageSize;
+  if (placement.page_size == PageSize::kDefault && placement.numa_node < 0)
+    return Create(mode, size);
+
+  if (size == 0)
+    return {};
+
+  if (placement.numa_node >= kMaxNumaNodes)
+    return {};
+
+  CHECK_NE(mode, Mode::kReadOnly) << "Creating a region in read-only mode will "
+                                     "lead to this region being non-modifiable";
+
+  // Unlike the files of /dev/shm, which is mounted without huge pages, a
+  // memfd lives in the kernel's internal mount, which backs it with
+  // transparent huge pages as shmem_enabled allows, or in hugetlbfs.
+  const bool huge_tlb = placement.page_size == PageSize::kHugeTlb;
+  ScopedFD fd(static_cast<int>(
+      syscall(__NR_memfd_create, "base_shared_memory",
+              MFD_CLOEXEC | (huge_tlb ? MFD_HUGETLB : 0))));
+  if (!fd.is_valid()) {
+    DPLOG(ERROR) << "memfd_create failed";
+    return {};
+  }
+
+  size_t page_size = static_cast<size_t>(getpagesize());
+  if (huge_tlb) {
+    // hugetlbfs reports the huge page size as the block size.
+    struct stat fd_stat;
+    if (fstat(fd.get(), &fd_stat) != 0) {
+      DPLOG(ERROR) << "fstat(memfd) failed";
+      return {};
+    }
+    page_size = static_cast<size_t>(fd_stat.st_blksize);
+    size = bits::AlignUp(size, page_size);
+  }
+
+  if (size > static_cast<size_t>(std::numeric_limits<int>::max()))
+    return {};
+
+  if (HANDLE_EINTR(ftruncate(fd.get(), static_cast<off_t>(size))) != 0) {
+    DPLOG(ERROR) << "ftruncate(memfd) failed";
+    return {};
+  }
+
+  // The pages are bound through a temporary mapping, before any of them is
+  // allocated.
+  if (huge_tlb || placement.numa_node >= 0) {
+    // This reserves the huge pages, so that touching them can't fail.
+    void* memory =
+        mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_SHARED, fd.get(), 0);
+    if (memory == MAP_FAILED) {
+      DPLOG(ERROR) << "mmap(memfd) failed";
+      return {};
+    }
+    bool bound = placement.numa_node < 0 ||
+                 BindToNumaNode(memory, size, placement.numa_node);
+    // A huge page is bound when it's allocated, through the mapping which
+    // allocates it, so the pages of hugetlbfs are all allocated here.
+    if (bound && huge_tlb) {
+      for (size_t offset = 0; offset < size; offset += page_size)
+        static_cast<volatile uint8_t*>(memory)[offset] = 0;
+    }
+    munmap(memory, size);
+    if (!bound)
+      return {};
+  }
+
+  // Like Create(), allocates the pages up front so that touching them can't
+  // fail later, except for transparent huge pages which are only allocated
+  // huge on a fault through an advised mapping.
+  if (placement.page_size == PageSize::kDefault &&
+      HANDLE_EINTR(fallocate(fd.get(), 0, 0, static_cast<off_t>(size))) != 0) {
+    DPLOG(ERROR) << "fallocate(memfd) failed";
+    return {};
+  }
+
+  ScopedFD readonly_fd;
+  if (mode == Mode::kWritable) {
+    // A memfd has no path, but can be reopened through /proc.
+    readonly_fd.reset(HANDLE_EINTR(
+        open(StringPrintf("/proc/self/fd/%d", fd.get()).c_str(), O_RDONLY)));
+    if (!readonly_fd.is_valid()) {
+      DPLOG(ERROR) << "Reopening the memfd read-only failed";
+      return {};
+    }
+  }
+
+  PlatformSharedMemoryRegion region({std::move(fd), std::move(readonly_fd)},
+                                    mode, size, UnguessableToken::Create());
+  region.advise_huge_pages_ = placement.page_size == PageSize::kTransparentHuge;
+  return region;
+}
+#endif  // BUILDFLAG(IS_LINUX) || BUILDFLAG(IS_CHROMEOS)
+
 bool PlatformSharedMemoryRegion::CheckPlatformHandlePermissionsCorrespondToMode(
     PlatformHandle handle,
     Mode mode,
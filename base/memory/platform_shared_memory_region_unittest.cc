@@ -31,6 +31,12 @@
 #include "base/fuchsia/fuchsia_logging.h"
 #endif
 
+#if BUILDFLAG(IS_LINUX) || BUILDFLAG(IS_CHROMEOS)
+#include <linux/mempolicy.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#endif
+
 namespace base {
 namespace subtle {
 
@@ -237,6 +243,85 @@ TEST_F(PlatformSharedMemoryRegionTest, ConvertToUnsafeInvalidatesSecondHandle) {
 }
 #endif
 
+#if BUILDFLAG(IS_LINUX) || BUILDFLAG(IS_CHROMEOS)
+constexpr size_t kPlacedRegionSize = 4 * 1024 * 1024;
+
+// Tests that a region on transparent huge pages is shared between its
+// mappings.
+TEST_F(PlatformSharedMemoryRegionTest, CreateWithTransparentHugePages) {
+  SharedMemoryPlacement placement;
+  placement.page_size = SharedMemoryPlacement::PageSize::kTransparentHuge;
+  PlatformSharedMemoryRegion region =
+      PlatformSharedMemoryRegion::CreateUnsafe(kPlacedRegionSize, placement);
+  ASSERT_TRUE(region.IsValid());
+  EXPECT_EQ(region.GetSize(), kPlacedRegionSize);
+  WritableSharedMemoryMapping mapping = MapForTesting(&region);
+  ASSERT_TRUE(mapping.IsValid());
+  PlatformSharedMemoryRegion duplicate = region.Duplicate();
+  WritableSharedMemoryMapping duplicate_mapping = MapForTesting(&duplicate);
+  ASSERT_TRUE(duplicate_mapping.IsValid());
+  mapping.GetMemoryAsSpan<uint8_t>()[kPlacedRegionSize - 1] = 42;
+  EXPECT_EQ(duplicate_mapping.GetMemoryAsSpan<uint8_t>()[kPlacedRegionSize - 1],
+            42);
+}
+
+// Tests that a writable region with a placement can still be converted to
+// read-only.
+TEST_F(PlatformSharedMemoryRegionTest, ConvertPlacedRegionToReadOnly) {
+  SharedMemoryPlacement placement;
+  placement.page_size = SharedMemoryPlacement::PageSize::kTransparentHuge;
+  PlatformSharedMemoryRegion region =
+      PlatformSharedMemoryRegion::CreateWritable(kPlacedRegionSize, placement);
+  ASSERT_TRUE(region.IsValid());
+  ASSERT_TRUE(region.ConvertToReadOnly());
+  EXPECT_TRUE(
+      CheckReadOnlyPlatformSharedMemoryRegionForTesting(std::move(region)));
+}
+
+// Tests that the pages of a region bound to a NUMA node are allocated on it.
+TEST_F(PlatformSharedMemoryRegionTest, CreateOnNumaNode) {
+  if (SysInfo::GetNumaNodeCpus().empty())
+    return;
+  SharedMemoryPlacement placement;
+  placement.numa_node = 0;
+  PlatformSharedMemoryRegion region =
+      PlatformSharedMemoryRegion::CreateUnsafe(kPlacedRegionSize, placement);
+  ASSERT_TRUE(region.IsValid());
+  WritableSharedMemoryMapping mapping = MapForTesting(&region);
+  ASSERT_TRUE(mapping.IsValid());
+  void* last_page = &mapping.GetMemoryAsSpan<uint8_t>().back();
+  int node = -1;
+  ASSERT_EQ(syscall(SYS_get_mempolicy, &node, nullptr, 0, last_page,
+                    MPOL_F_NODE | MPOL_F_ADDR),
+            0);
+  EXPECT_EQ(node, 0);
+}
+
+TEST_F(PlatformSharedMemoryRegionTest, CreateOnInvalidNumaNodeIsInvalid) {
+  SharedMemoryPlacement placement;
+  placement.numa_node = 1 << 20;
+  PlatformSharedMemoryRegion region =
+      PlatformSharedMemoryRegion::CreateUnsafe(kRegionSize, placement);
+  EXPECT_FALSE(region.IsValid());
+}
+
+// Tests that a region on hugetlbfs pages is a whole number of huge pages.
+TEST_F(PlatformSharedMemoryRegionTest, CreateWithHugeTlbPages) {
+  SharedMemoryPlacement placement;
+  placement.page_size = SharedMemoryPlacement::PageSize::kHugeTlb;
+  PlatformSharedMemoryRegion region =
+      PlatformSharedMemoryRegion::CreateUnsafe(kRegionSize, placement);
+  // The pool of huge pages is empty unless the system reserved some.
+  if (!region.IsValid())
+    return;
+  EXPECT_GT(region.GetSize(), kRegionSize);
+  EXPECT_EQ(region.GetSize() % (2 * 1024 * 1024), 0u);
+  WritableSharedMemoryMapping mapping = MapForTesting(&region);
+  ASSERT_TRUE(mapping.IsValid());
+  mapping.GetMemoryAsSpan<uint8_t>()[0] = 42;
+}
+#endif  // BUILDFLAG(IS_LINUX) || BUILDFLAG(IS_CHROMEOS)
+
 void CheckReadOnlyMapProtection(void* addr) {
 #if BUILDFLAG(IS_MAC)
   vm_region_basic_info_64 basic_info;
@@ -0,0 +1,106 @@
+// Copyright 2022 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "base/memory/shared_memory_channel_posix.h"
+
+#include <errno.h>
+#include <unistd.h>
+
+#include <utility>
+
+#include "base/bind.h"
+#include "base/logging.h"
+#include "base/posix/eintr_wrapper.h"
+#include "base/threading/sequenced_task_runner_handle.h"
+
+namespace base {
+
+SharedMemoryChannelSender::SharedMemoryChannelSender(
+    WritableSharedMemoryMapping mapping,
+    ScopedFD wake_fd)
+    : ring_(std::move(mapping), SharedMemoryRingBuffer::Role::kProducer),
+      wake_fd_(std::move(wake_fd)) {
+  DCHECK(wake_fd_.is_valid());
+  DETACH_FROM_SEQUENCE(sequence_checker_);
+}
+
+SharedMemoryChannelSender::~SharedMemoryChannelSender() = default;
+
+bool SharedMemoryChannelSender::Send(const Pickle& message) {
+  DCHECK_CALLED_ON_VALID_SEQUENCE(sequence_checker_);
+  bool wake_receiver;
+  if (!ring_.Write(make_span(static_cast<const uint8_t*>(message.data()),
+                             message.size()),
+                   &wake_receiver)) {
+    return false;
+  }
+  if (!wake_receiver)
+    return true;
+  const char byte = 0;
+  if (HANDLE_EINTR(write(wake_fd_.get(), &byte, 1)) == 1)
+    return true;
+  // A full pipe already wakes the receiver.
+  if (errno == EAGAIN || errno == EWOULDBLOCK)
+    return true;
+  DPLOG(ERROR) << "write";
+  return false;
+}
+
+SharedMemoryChannelReceiver::SharedMemoryChannelReceiver(
+    WritableSharedMemoryMapping mapping,
+    ScopedFD wake_fd,
+    MessageCallback callback)
+    : ring_(std::move(mapping), SharedMemoryRingBuffer::Role::kConsumer),
+      wake_fd_(std::move(wake_fd)),
+      callback_(std::move(callback)) {
+  DCHECK(wake_fd_.is_valid());
+  DCHECK(callback_);
+  // Unretained() is safe since the callback is unregistered when
+  // |wake_fd_watcher_| is deleted.
+  wake_fd_watcher_ = FileDescriptorWatcher::WatchReadable(
+      wake_fd_.get(),
+      BindRepeating(&SharedMemoryChannelReceiver::OnWakeFdReadable,
+                    Unretained(this)));
+  // Messages may have been sent before the receiver was created.
+  SequencedTaskRunnerHandle::Get()->PostTask(
+      FROM_HERE, BindOnce(&SharedMemoryChannelReceiver::ReceiveMessages,
+                          weak_factory_.GetWeakPtr()));
+}
+
+SharedMemoryChannelReceiver::~SharedMemoryChannelReceiver() {
+  DCHECK_CALLED_ON_VALID_SEQUENCE(sequence_checker_);
+}
+
+void SharedMemoryChannelReceiver::OnWakeFdReadable() {
+  DCHECK_CALLED_ON_VALID_SEQUENCE(sequence_checker_);
+  char buffer[64];
+  while (HANDLE_EINTR(read(wake_fd_.get(), buffer, sizeof(buffer))) > 0) {
+  }
+  ReceiveMessages();
+}
+
+void SharedMemoryChannelReceiver::ReceiveMessages() {
+  DCHECK_CALLED_ON_VALID_SEQUENCE(sequence_checker_);
+  for (int i = 0; i < kMaxMessagesPerTask;) {
+    absl::optional<span<const uint8_t>> message = ring_.Peek();
+    if (!message) {
+      // Wait for OnWakeFdReadable(), unless a message arrived meanwhile.
+      if (ring_.Park())
+        return;
+      continue;
+    }
+    // The Pickle references the message in shared memory without copying it.
+    const Pickle pickle(reinterpret_cast<const char*>(message->data()),
+                        message->size());
+    callback_.Run(pickle);
+    ring_.Pop();
+    ++i;
+  }
+  // Let other tasks run on the sequence before receiving more messages.
+  SequencedTaskRunnerHandle::Get()->PostTask(
+      FROM_HERE, BindOnce(&SharedMemoryChannelReceiver::ReceiveMessages,
+                          weak_factory_.GetWeakPtr()));
+}
+
+}  // namespace base
@@ -0,0 +1,107 @@
+// Copyright 2022 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#ifndef BASE_MEMORY_SHARED_MEMORY_CHANNEL_POSIX_H_
+#define BASE_MEMORY_SHARED_MEMORY_CHANNEL_POSIX_H_
+
+#include <memory>
+
+#include "base/base_export.h"
+#include "base/callback.h"
+#include "base/files/file_descriptor_watcher_posix.h"
+#include "base/files/scoped_file.h"
+#include "base/memory/shared_memory_mapping.h"
+#include "base/memory/shared_memory_ring_buffer.h"
+#include "base/memory/weak_ptr.h"
+#include "base/pickle.h"
+#include "base/sequence_checker.h"
+
+namespace base {
+
+// A one-way channel of Pickle messages between two processes, e.g. to hand
+// work from one worker process to another without going through a socket.
+// The messages go through a SharedMemoryRingBuffer in a region shared by the
+// two processes, and a pipe wakes up the receiver only when it has run out of
+// messages and parked. While the receiver is busy, sending a message is a copy
+// into shared memory and a few atomic operations.
+//
+//   // Once, e.g. in the browser process.
+//   auto region = UnsafeSharedMemoryRegion::Create(
+//       SharedMemoryRingBuffer::GetRegionSize(kMaxMessageSize));
+//   ScopedFD read_fd, write_fd;
+//   CreatePipe(&read_fd, &write_fd, /*non_blocking=*/true);
+//   // Pass |region| and |write_fd| to the sending process, and
+//   // region.Duplicate() and |read_fd| to the receiving process.
+//
+//   // In the sending process, on any one sequence.
+//   SharedMemoryChannelSender sender(region.Map(), std::move(write_fd));
+//   Pickle message;
+//   message.WriteInt(job_id);
+//   sender.Send(message);
+//
+//   // In the receiving process, on a sequence which supports
+//   // FileDescriptorWatcher.
+//   SharedMemoryChannelReceiver receiver(
+//       region.Map(), std::move(read_fd), BindRepeating(&OnMessage));
+//
+// Closures can't be sent to another process, so the receiver runs a single
+// callback for each message, on its sequence. Messages are delivered in order,
+// as tasks of at most kMaxMessagesPerTask messages.
+class BASE_EXPORT SharedMemoryChannelSender {
+ public:
+  // |wake_fd| is the write end of a non-blocking pipe, whose read end belongs
+  // to the receiver.
+  SharedMemoryChannelSender(WritableSharedMemoryMapping mapping,
+                            ScopedFD wake_fd);
+  SharedMemoryChannelSender(const SharedMemoryChannelSender&) = delete;
+  SharedMemoryChannelSender& operator=(const SharedMemoryChannelSender&) =
+      delete;
+  ~SharedMemoryChannelSender();
+
+  // Returns false if the ring is full, in which case the message is dropped
+  // and the caller may retry later, or if the receiver couldn't be woken up.
+  // |message| must not be larger than allowed by the region's size.
+  bool Send(const Pickle& message);
+
+ private:
+  SharedMemoryRingBuffer ring_;
+  const ScopedFD wake_fd_;
+
+  SEQUENCE_CHECKER(sequence_checker_);
+};
+
+class BASE_EXPORT SharedMemoryChannelReceiver {
+ public:
+  // The message references shared memory, and is only valid during the call.
+  using MessageCallback = RepeatingCallback<void(const Pickle& message)>;
+
+  static constexpr int kMaxMessagesPerTask = 64;
+
+  // |wake_fd| is the read end of a non-blocking pipe, whose write end belongs
+  // to the sender. |callback| must not delete the receiver.
+  SharedMemoryChannelReceiver(WritableSharedMemoryMapping mapping,
+                              ScopedFD wake_fd,
+                              MessageCallback callback);
+  SharedMemoryChannelReceiver(const SharedMemoryChannelReceiver&) = delete;
+  SharedMemoryChannelReceiver& operator=(const SharedMemoryChannelReceiver&) =
+      delete;
+  ~SharedMemoryChannelReceiver();
+
+ private:
+  void OnWakeFdReadable();
+  void ReceiveMessages();
+
+  SharedMemoryRingBuffer ring_;
+  const ScopedFD wake_fd_;
+  const MessageCallback callback_;
+  std::unique_ptr<FileDescriptorWatcher::Controller> wake_fd_watcher_;
+
+  SEQUENCE_CHECKER(sequence_checker_);
+
+  WeakPtrFactory<SharedMemoryChannelReceiver> weak_factory_{this};
+};
+
+}  // namespace base
+
+#endif  // BASE_MEMORY_SHARED_MEMORY_CHANNEL_POSIX_H_
@@ -0,0 +1,116 @@
+// Copyright 2022 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "base/memory/shared_memory_channel_posix.h"
+
+#include <vector>
+
+#include "base/bind.h"
+#include "base/files/file_util.h"
+#include "base/memory/unsafe_shared_memory_region.h"
+#include "base/run_loop.h"
+#include "base/test/bind.h"
+#include "base/test/task_environment.h"
+#include "base/threading/thread.h"
+#include "testing/gtest/include/gtest/gtest.h"
+
+namespace base {
+
+namespace {
+
+constexpr size_t kMaxMessageSize = 256;
+
+class SharedMemoryChannelTest : public testing::Test {
+ protected:
+  void SetUp() override {
+    region_ = UnsafeSharedMemoryRegion::Create(
+        SharedMemoryRingBuffer::GetRegionSize(kMaxMessageSize));
+    ASSERT_TRUE(region_.IsValid());
+    ASSERT_TRUE(CreatePipe(&read_fd_, &write_fd_, /*non_blocking=*/true));
+  }
+
+  std::unique_ptr<SharedMemoryChannelReceiver> CreateReceiver(
+      RepeatingClosure on_message) {
+    return std::make_unique<SharedMemoryChannelReceiver>(
+        region_.Duplicate().Map(), std::move(read_fd_),
+        BindLambdaForTesting([this, on_message](const Pickle& message) {
+          PickleIterator iterator(message);
+          int value;
+          ASSERT_TRUE(iterator.ReadInt(&value));
+          received_.push_back(value);
+          on_message.Run();
+        }));
+  }
+
+  static Pickle MakeMessage(int value) {
+    Pickle message;
+    message.WriteInt(value);
+    return message;
+  }
+
+  test::TaskEnvironment task_environment_{
+      test::TaskEnvironment::MainThreadType::IO};
+  UnsafeSharedMemoryRegion region_;
+  ScopedFD read_fd_;
+  ScopedFD write_fd_;
+  std::vector<int> received_;
+};
+
+}  // namespace
+
+TEST_F(SharedMemoryChannelTest, MessagesSentBeforeReceiverExists) {
+  SharedMemoryChannelSender sender(region_.Map(), std::move(write_fd_));
+  EXPECT_TRUE(sender.Send(MakeMessage(1)));
+  EXPECT_TRUE(sender.Send(MakeMessage(2)));
+
+  RunLoop run_loop;
+  auto receiver = CreateReceiver(BindLambdaForTesting([&] {
+    if (received_.size() == 2)
+      run_loop.Quit();
+  }));
+  run_loop.Run();
+  EXPECT_EQ(std::vector<int>({1, 2}), received_);
+}
+
+TEST_F(SharedMemoryChannelTest, WakesParkedReceiver) {
+  SharedMemoryChannelSender sender(region_.Map(), std::move(write_fd_));
+  RunLoop run_loop;
+  auto receiver = CreateReceiver(run_loop.QuitClosure());
+  // Let the receiver run out of messages and park.
+  RunLoop().RunUntilIdle();
+  EXPECT_TRUE(received_.empty());
+
+  // The message is only delivered if the receiver is woken up.
+  EXPECT_TRUE(sender.Send(MakeMessage(3)));
+  run_loop.Run();
+  EXPECT_EQ(std::vector<int>({3}), received_);
+}
+
+TEST_F(SharedMemoryChannelTest, FromAnotherThread) {
+  constexpr int kNumMessages = 1000;
+  RunLoop run_loop;
+  auto receiver = CreateReceiver(BindLambdaForTesting([&] {
+    if (received_.size() == kNumMessages)
+      run_loop.Quit();
+  }));
+
+  Thread sender_thread("Sender");
+  ASSERT_TRUE(sender_thread.Start());
+  sender_thread.task_runner()->PostTask(
+      FROM_HERE, BindLambdaForTesting([&] {
+        SharedMemoryChannelSender sender(region_.Map(), std::move(write_fd_));
+        for (int i = 0; i < kNumMessages;) {
+          if (sender.Send(MakeMessage(i)))
+            ++i;
+        }
+      }));
+  run_loop.Run();
+  sender_thread.Stop();
+
+  ASSERT_EQ(static_cast<size_t>(kNumMessages), received_.size());
+  for (int i = 0; i < kNumMessages; ++i)
+    EXPECT_EQ(i, received_[i]);
+}
+
+}  // namespace base
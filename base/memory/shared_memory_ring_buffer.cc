@@ -0,0 +1,213 @@
+// Copyright 2022 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "base/memory/shared_memory_ring_buffer.h"
+
+#include <string.h>
+
+#include <atomic>
+#include <utility>
+
+#include "base/bits.h"
+#include "base/check_op.h"
+
+#if BUILDFLAG(IS_LINUX) || BUILDFLAG(IS_CHROMEOS) || BUILDFLAG(IS_ANDROID)
+#include <errno.h>
+#include <linux/futex.h>
+#include <sys/syscall.h>
+#include <time.h>
+#include <unistd.h>
+
+#include "base/threading/scoped_blocking_call.h"
+#endif
+
+namespace base {
+
+// Lives at the start of the region, followed by the messages. Each position
+// counts the bytes written or read since the ring was created, so the offset
+// of a record is its position modulo the capacity. The two positions are on
+// separate cache lines since each is written by a different side.
+struct SharedMemoryRingBuffer::Header {
+  // kFormatVersion, or 0 until one of the sides maps the region.
+  alignas(64) std::atomic<uint32_t> format_version;
+  // Written by the producer.
+  alignas(64) std::atomic<uint64_t> write_position;
+  // Written by the consumer.
+  alignas(64) std::atomic<uint64_t> read_position;
+  // Set by the consumer when it parks, cleared by whichever side unparks it.
+  // Also the futex of WaitForWrite().
+  alignas(64) std::atomic<uint32_t> consumer_parked;
+};
+
+static_assert(std::atomic<uint64_t>::is_always_lock_free &&
+                  std::atomic<uint32_t>::is_always_lock_free,
+              "The ring's header is shared between processes");
+
+// static
+size_t SharedMemoryRingBuffer::GetRegionSize(size_t max_message_size) {
+  return sizeof(Header) +
+         bits::AlignUp(max_message_size + kRecordHeaderSize, kAlignment);
+}
+
+SharedMemoryRingBuffer::SharedMemoryRingBuffer(
+    WritableSharedMemoryMapping mapping,
+    Role role)
+    : mapping_(std::move(mapping)),
+      role_(role),
+      header_(mapping_.GetMemoryAs<Header>()),
+      data_(static_cast<uint8_t*>(mapping_.memory()) + sizeof(Header)),
+      capacity_(bits::AlignDown(mapping_.size() - sizeof(Header), kAlignment)) {
+  CHECK(header_);
+  CHECK_GT(capacity_, kRecordHeaderSize);
+  uint32_t format_version = 0;
+  if (!header_->format_version.compare_exchange_strong(
+          format_version, kFormatVersion, std::memory_order_relaxed)) {
+    // The other process isn't trusted, and may also be an older or newer
+    // build.
+    CHECK_EQ(format_version, kFormatVersion);
+  }
+  if (role_ == Role::kProducer) {
+    position_ = header_->write_position.load(std::memory_order_relaxed);
+    cached_peer_position_ =
+        header_->read_position.load(std::memory_order_acquire);
+  } else {
+    position_ = header_->read_position.load(std::memory_order_relaxed);
+    cached_peer_position_ =
+        header_->write_position.load(std::memory_order_acquire);
+  }
+}
+
+SharedMemoryRingBuffer::~SharedMemoryRingBuffer() = default;
+
+bool SharedMemoryRingBuffer::Write(span<const uint8_t> message,
+                                   bool* wake_consumer) {
+  DCHECK_EQ(role_, Role::kProducer);
+  CHECK_LE(message.size(), max_message_size());
+  const size_t record_size =
+      kRecordHeaderSize + bits::AlignUp(message.size(), kAlignment);
+  size_t offset = position_ % capacity_;
+  // A record which doesn't fit before the end of the ring starts over at the
+  // beginning, after a wrap marker.
+  const size_t padding =
+      capacity_ - offset < record_size ? capacity_ - offset : 0;
+  const uint64_t end_position = position_ + padding + record_size;
+  if (end_position - cached_peer_position_ > capacity_) {
+    cached_peer_position_ =
+        header_->read_position.load(std::memory_order_acquire);
+    if (end_position - cached_peer_position_ > capacity_) {
+      *wake_consumer = false;
+      return false;
+    }
+  }
+
+  if (padding) {
+    StoreLength(offset, kWrapMarker);
+    offset = 0;
+  }
+  StoreLength(offset, static_cast<uint32_t>(message.size()));
+  memcpy(data_ + offset + kRecordHeaderSize, message.data(), message.size());
+  position_ = end_position;
+  header_->write_position.store(position_, std::memory_order_release);
+
+  // Pairs with the fence in Park(): either the consumer sees the new write
+  // position, or this sees that the consumer parked.
+  std::atomic_thread_fence(std::memory_order_seq_cst);
+  *wake_consumer =
+      header_->consumer_parked.load(std::memory_order_relaxed) &&
+      header_->consumer_parked.exchange(0, std::memory_order_relaxed);
+  return true;
+}
+
+absl::optional<span<const uint8_t>> SharedMemoryRingBuffer::Peek() {
+  DCHECK_EQ(role_, Role::kConsumer);
+  if (position_ == cached_peer_position_) {
+    cached_peer_position_ =
+        header_->write_position.load(std::memory_order_acquire);
+    if (position_ == cached_peer_position_)
+      return absl::nullopt;
+  }
+
+  size_t offset = position_ % capacity_;
+  uint32_t length = LoadLength(offset);
+  size_t padding = 0;
+  if (length == kWrapMarker) {
+    padding = capacity_ - offset;
+    offset = 0;
+    length = LoadLength(offset);
+  }
+  // The producer's process isn't trusted to write sensible lengths.
+  CHECK_LE(length, max_message_size());
+  front_record_size_ =
+      padding + kRecordHeaderSize + bits::AlignUp(size_t{length}, kAlignment);
+  CHECK_LE(offset + front_record_size_ - padding, capacity_);
+  CHECK_LE(front_record_size_, cached_peer_position_ - position_);
+  return make_span(data_ + offset + kRecordHeaderSize, length);
+}
+
+void SharedMemoryRingBuffer::Pop() {
+  DCHECK_EQ(role_, Role::kConsumer);
+  DCHECK_NE(front_record_size_, 0u) << "Pop() must follow a successful Peek()";
+  position_ += front_record_size_;
+  front_record_size_ = 0;
+  header_->read_position.store(position_, std::memory_order_release);
+}
+
+bool SharedMemoryRingBuffer::Park() {
+  DCHECK_EQ(role_, Role::kConsumer);
+  header_->consumer_parked.store(1, std::memory_order_relaxed);
+  // Pairs with the fence in Write().
+  std::atomic_thread_fence(std::memory_order_seq_cst);
+  cached_peer_position_ =
+      header_->write_position.load(std::memory_order_acquire);
+  if (position_ == cached_peer_position_)
+    return true;
+  // A message arrived meanwhile. If the producer saw the consumer parked, it
+  // will also ask to wake it, which is harmless.
+  header_->consumer_parked.store(0, std::memory_order_relaxed);
+  return false;
+}
+
+#if BUILDFLAG(IS_LINUX) || BUILDFLAG(IS_CHROMEOS) || BUILDFLAG(IS_ANDROID)
+
+static_assert(sizeof(std::atomic<uint32_t>) == sizeof(uint32_t),
+              "consumer_parked is used as a futex");
+
+void SharedMemoryRingBuffer::WaitForWrite(TimeDelta timeout) {
+  DCHECK_EQ(role_, Role::kConsumer);
+  if (!Park())
+    return;
+  ScopedBlockingCall scoped_blocking_call(FROM_HERE, BlockingType::MAY_BLOCK);
+  struct timespec relative_timeout;
+  if (!timeout.is_max())
+    relative_timeout = timeout.ToTimeSpec();
+  // Returns at once if Write() unparked the consumer meanwhile. The futex
+  // isn't private since the producer may be in another process.
+  int saved_errno = errno;
+  syscall(SYS_futex, &header_->consumer_parked, FUTEX_WAIT, 1,
+          timeout.is_max() ? nullptr : &relative_timeout, nullptr, 0);
+  errno = saved_errno;
+}
+
+void SharedMemoryRingBuffer::WakeConsumer() {
+  DCHECK_EQ(role_, Role::kProducer);
+  int saved_errno = errno;
+  syscall(SYS_futex, &header_->consumer_parked, FUTEX_WAKE, 1, nullptr,
+          nullptr, 0);
+  errno = saved_errno;
+}
+
+#endif  // BUILDFLAG(IS_LINUX) || BUILDFLAG(IS_CHROMEOS) ||
+        // BUILDFLAG(IS_ANDROID)
+
+uint32_t SharedMemoryRingBuffer::LoadLength(size_t offset) const {
+  uint32_t length;
+  memcpy(&length, data_ + offset, sizeof(length));
+  return length;
+}
+
+void SharedMemoryRingBuffer::StoreLength(size_t offset, uint32_t length) {
+  memcpy(data_ + offset, &length, sizeof(length));
+}
+
+}  // namespace base
@@ -0,0 +1,135 @@
+// Copyright 2022 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#ifndef BASE_MEMORY_SHARED_MEMORY_RING_BUFFER_H_
+#define BASE_MEMORY_SHARED_MEMORY_RING_BUFFER_H_
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include "base/base_export.h"
+#include "base/containers/span.h"
+#include "base/memory/shared_memory_mapping.h"
+#include "base/time/time.h"
+#include "build/build_config.h"
+#include "third_party/abseil-cpp/absl/types/optional.h"
+
+namespace base {
+
+// A lock-free ring of variable-size messages in shared memory, with a single
+// producer and a single consumer, which may be in different processes. Each
+// process creates a SharedMemoryRingBuffer over its own mapping of the same
+// region, as either the producer or the consumer.
+//
+// A zero-filled region is an empty ring, so a new region can be used as is:
+//
+//   // In the producer process.
+//   auto region = UnsafeSharedMemoryRegion::Create(
+//       SharedMemoryRingBuffer::GetRegionSize(64 * 1024));
+//   SharedMemoryRingBuffer producer(region.Map(),
+//                                   SharedMemoryRingBuffer::Role::kProducer);
+//   // Send region.Duplicate() to the consumer process.
+//   bool wake_consumer;
+//   producer.Write(as_bytes(make_span(data)), &wake_consumer);
+//
+//   // In the consumer process.
+//   SharedMemoryRingBuffer consumer(region.Map(),
+//                                   SharedMemoryRingBuffer::Role::kConsumer);
+//   while (auto message = consumer.Peek()) {
+//     Process(*message);
+//     consumer.Pop();
+//   }
+//
+// The consumer can park, i.e. declare that it's about to sleep until woken up,
+// and the next Write() then tells the producer to wake it, e.g. through a pipe
+// (see SharedMemoryChannelReceiver), or on Linux with WaitForWrite() and
+// WakeConsumer(), which need no file descriptor. As long as the consumer is
+// awake, writing and reading a message doesn't involve the kernel.
+//
+// The region starts with a format version, set by whichever side maps it
+// first, and both sides check it, so that processes built with different
+// layouts of the ring can't misread each other's positions.
+//
+// The consumer checks the bounds of the messages it reads, but not their
+// content, which the producer may modify until it's popped.
+class BASE_EXPORT SharedMemoryRingBuffer {
+ public:
+  enum class Role { kProducer, kConsumer };
+
+  // Returns the size of a region whose ring accepts messages of up to
+  // |max_message_size| bytes. Each message takes 8 bytes more than its size,
+  // rounded up to a multiple of 8, until it's popped.
+  static size_t GetRegionSize(size_t max_message_size);
+
+  // |mapping| must be a mapping of a region of at least GetRegionSize(1)
+  // bytes, shared with at most one other SharedMemoryRingBuffer, which has the
+  // other role.
+  SharedMemoryRingBuffer(WritableSharedMemoryMapping mapping, Role role);
+  SharedMemoryRingBuffer(const SharedMemoryRingBuffer&) = delete;
+  SharedMemoryRingBuffer& operator=(const SharedMemoryRingBuffer&) = delete;
+  ~SharedMemoryRingBuffer();
+
+  // The largest message which Write() accepts.
+  size_t max_message_size() const { return capacity_ - kRecordHeaderSize; }
+
+  // Producer side. Appends |message| and returns true, or returns false if
+  // the ring doesn't have room for it. Sets |wake_consumer| to whether the
+  // consumer parked and must be woken up.
+  bool Write(span<const uint8_t> message, bool* wake_consumer);
+
+  // Consumer side. Returns the oldest message, or nullopt if the ring is
+  // empty. The message stays valid until Pop() removes it.
+  absl::optional<span<const uint8_t>> Peek();
+  void Pop();
+
+  // Consumer side. Returns true if the ring is empty, in which case the next
+  // Write() will ask to wake the consumer. Otherwise returns false and the
+  // consumer should keep reading.
+  bool Park();
+
+#if BUILDFLAG(IS_LINUX) || BUILDFLAG(IS_CHROMEOS) || BUILDFLAG(IS_ANDROID)
+  // Consumer side. Parks and, if the ring is empty, sleeps until the producer
+  // calls WakeConsumer() or |timeout| expires. May return spuriously, so the
+  // consumer should Peek() and wait again if the ring is still empty.
+  void WaitForWrite(TimeDelta timeout);
+
+  // Producer side. Wakes up the consumer sleeping in WaitForWrite(), if any.
+  // To be called when Write() sets |wake_consumer|.
+  void WakeConsumer();
+#endif
+
+ private:
+  struct Header;
+
+  // Changes whenever the layout of the region changes. Never 0, which is how
+  // a new region reads.
+  static constexpr uint32_t kFormatVersion = 1;
+
+  static constexpr size_t kAlignment = 8;
+  // The size of a message, or kWrapMarker, preceding each message.
+  static constexpr size_t kRecordHeaderSize = 8;
+  static constexpr uint32_t kWrapMarker = UINT32_MAX;
+
+  uint32_t LoadLength(size_t offset) const;
+  void StoreLength(size_t offset, uint32_t length);
+
+  WritableSharedMemoryMapping mapping_;
+  const Role role_;
+  Header* header_;
+  uint8_t* data_;
+  size_t capacity_;
+
+  // The local copy of the position which this side owns, and the last loaded
+  // value of the other side's, which limits how often this side touches the
+  // other side's cache line.
+  uint64_t position_ = 0;
+  uint64_t cached_peer_position_ = 0;
+
+  // Consumer side. The size of the record returned by the last Peek().
+  size_t front_record_size_ = 0;
+};
+
+}  // namespace base
+
+#endif  // BASE_MEMORY_SHARED_MEMORY_RING_BUFFER_H_
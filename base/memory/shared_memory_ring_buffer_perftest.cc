@@ -0,0 +1,93 @@
+// Copyright 2022 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include <stdint.h>
+
+#include <atomic>
+#include <string>
+#include <vector>
+
+#include "base/memory/raw_ptr.h"
+#include "base/memory/shared_memory_ring_buffer.h"
+#include "base/memory/unsafe_shared_memory_region.h"
+#include "base/strings/string_number_conversions.h"
+#include "base/threading/platform_thread.h"
+#include "base/time/time.h"
+#include "base/timer/lap_timer.h"
+#include "testing/gtest/include/gtest/gtest.h"
+#include "testing/perf/perf_result_reporter.h"
+
+namespace base {
+namespace {
+
+constexpr int kWarmupRuns = 1;
+constexpr TimeDelta kTimeLimit = Seconds(1);
+constexpr int kTimeCheckInterval = 10000;
+constexpr size_t kMaxMessageSize = 64 * 1024;
+
+constexpr char kMetricPrefixRingBuffer[] = "SharedMemoryRingBuffer.";
+constexpr char kMetricWriteThroughput[] = "write_throughput";
+
+perf_test::PerfResultReporter SetUpReporter(const std::string& story_name) {
+  perf_test::PerfResultReporter reporter(kMetricPrefixRingBuffer, story_name);
+  reporter.RegisterImportantMetric(kMetricWriteThroughput, "runs/s");
+  return reporter;
+}
+
+// Pops messages until stopped, like a consumer which never parks.
+class ReadLoop : public PlatformThread::Delegate {
+ public:
+  explicit ReadLoop(SharedMemoryRingBuffer* ring) : ring_(ring) {}
+  ~ReadLoop() override = default;
+
+  void ThreadMain() override {
+    while (!should_stop_.load(std::memory_order_relaxed)) {
+      if (ring_->Peek())
+        ring_->Pop();
+    }
+  }
+
+  // Called from another thread to stop the loop.
+  void Stop() { should_stop_ = true; }
+
+ private:
+  raw_ptr<SharedMemoryRingBuffer> ring_;
+  std::atomic<bool> should_stop_{false};
+};
+
+}  // namespace
+
+// Measures how many messages of each size a producer writes per second, while
+// a consumer on another thread reads them.
+TEST(SharedMemoryRingBufferPerfTest, WriteThroughput) {
+  for (size_t message_size : {8u, 64u, 512u, 4096u}) {
+    UnsafeSharedMemoryRegion region = UnsafeSharedMemoryRegion::Create(
+        SharedMemoryRingBuffer::GetRegionSize(kMaxMessageSize));
+    ASSERT_TRUE(region.IsValid());
+    SharedMemoryRingBuffer producer(region.Map(),
+                                    SharedMemoryRingBuffer::Role::kProducer);
+    SharedMemoryRingBuffer consumer(region.Map(),
+                                    SharedMemoryRingBuffer::Role::kConsumer);
+    ReadLoop read_loop(&consumer);
+    PlatformThreadHandle thread_handle;
+    ASSERT_TRUE(PlatformThread::Create(0, &read_loop, &thread_handle));
+
+    const std::vector<uint8_t> message(message_size);
+    LapTimer timer(kWarmupRuns, kTimeLimit, kTimeCheckInterval);
+    do {
+      bool wake_consumer;
+      while (!producer.Write(message, &wake_consumer)) {
+      }
+      timer.NextLap();
+    } while (!timer.HasTimeLimitExpired());
+
+    read_loop.Stop();
+    PlatformThread::Join(thread_handle);
+
+    auto reporter = SetUpReporter(NumberToString(message_size) + "_bytes");
+    reporter.AddResult(kMetricWriteThroughput, timer.LapsPerSecond());
+  }
+}
+
+}  // namespace base
@@ -0,0 +1,271 @@
+// Copyright 2022 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "base/memory/shared_memory_ring_buffer.h"
+
+#include <stdint.h>
+#include <string.h>
+
+#include <memory>
+#include <string>
+
+#include "base/memory/unsafe_shared_memory_region.h"
+#include "base/strings/string_piece.h"
+#include "base/test/gtest_util.h"
+#include "base/threading/platform_thread.h"
+#include "base/threading/simple_thread.h"
+#include "base/time/time.h"
+#include "build/build_config.h"
+#include "testing/gtest/include/gtest/gtest.h"
+
+namespace base {
+
+namespace {
+
+span<const uint8_t> AsBytes(StringPiece s) {
+  return as_bytes(make_span(s));
+}
+
+std::string AsString(span<const uint8_t> bytes) {
+  return std::string(bytes.begin(), bytes.end());
+}
+
+class SharedMemoryRingBufferTest : public testing::Test {
+ protected:
+  void CreateRing(size_t max_message_size) {
+    region_ = UnsafeSharedMemoryRegion::Create(
+        SharedMemoryRingBuffer::GetRegionSize(max_message_size));
+    ASSERT_TRUE(region_.IsValid());
+    producer_ = std::make_unique<SharedMemoryRingBuffer>(
+        region_.Map(), SharedMemoryRingBuffer::Role::kProducer);
+    consumer_ = std::make_unique<SharedMemoryRingBuffer>(
+        region_.Duplicate().Map(), SharedMemoryRingBuffer::Role::kConsumer);
+  }
+
+  bool Write(StringPiece message) {
+    bool wake_consumer;
+    return producer_->Write(AsBytes(message), &wake_consumer);
+  }
+
+  std::string Read() {
+    absl::optional<span<const uint8_t>> message = consumer_->Peek();
+    if (!message)
+      return "<empty>";
+    std::string result = AsString(*message);
+    consumer_->Pop();
+    return result;
+  }
+
+  UnsafeSharedMemoryRegion region_;
+  std::unique_ptr<SharedMemoryRingBuffer> producer_;
+  std::unique_ptr<SharedMemoryRingBuffer> consumer_;
+};
+
+}  // namespace
+
+TEST_F(SharedMemoryRingBufferTest, WriteThenRead) {
+  CreateRing(64);
+  EXPECT_GE(producer_->max_message_size(), 64u);
+  EXPECT_FALSE(consumer_->Peek());
+
+  EXPECT_TRUE(Write("hello"));
+  EXPECT_TRUE(Write(""));
+  EXPECT_TRUE(Write("world"));
+  EXPECT_EQ("hello", Read());
+  EXPECT_EQ("", Read());
+  EXPECT_EQ("world", Read());
+  EXPECT_EQ("<empty>", Read());
+}
+
+TEST_F(SharedMemoryRingBufferTest, PeekWithoutPop) {
+  CreateRing(64);
+  EXPECT_TRUE(Write("hello"));
+  EXPECT_EQ("hello", AsString(*consumer_->Peek()));
+  EXPECT_EQ("hello", AsString(*consumer_->Peek()));
+  consumer_->Pop();
+  EXPECT_FALSE(consumer_->Peek());
+}
+
+TEST_F(SharedMemoryRingBufferTest, Full) {
+  CreateRing(64);
+  // Each record takes 16 bytes.
+  int num_written = 0;
+  while (Write("12345678"))
+    ++num_written;
+  EXPECT_EQ(static_cast<int>(producer_->max_message_size() + 8) / 16,
+            num_written);
+
+  EXPECT_EQ("12345678", Read());
+  EXPECT_TRUE(Write("abcdefgh"));
+  EXPECT_FALSE(Write("abcdefgh"));
+}
+
+TEST_F(SharedMemoryRingBufferTest, Wrap) {
+  CreateRing(64);
+  const std::string kLarge(40, 'x');
+  // Messages of various sizes wrap around the end of the ring at various
+  // offsets.
+  for (int i = 0; i < 100; ++i) {
+    const std::string message = kLarge.substr(0, i % 41);
+    ASSERT_TRUE(Write(message));
+    ASSERT_EQ(message, Read());
+  }
+  EXPECT_EQ("<empty>", Read());
+}
+
+TEST_F(SharedMemoryRingBufferTest, Park) {
+  CreateRing(64);
+  bool wake_consumer = true;
+  EXPECT_TRUE(producer_->Write(AsBytes("a"), &wake_consumer));
+  EXPECT_FALSE(wake_consumer);
+
+  // Can't park with a pending message.
+  EXPECT_FALSE(consumer_->Park());
+  EXPECT_TRUE(producer_->Write(AsBytes("b"), &wake_consumer));
+  EXPECT_FALSE(wake_consumer);
+
+  EXPECT_EQ("a", Read());
+  EXPECT_EQ("b", Read());
+  EXPECT_TRUE(consumer_->Park());
+  EXPECT_TRUE(producer_->Write(AsBytes("c"), &wake_consumer));
+  EXPECT_TRUE(wake_consumer);
+  // Only the first write after parking wakes the consumer.
+  EXPECT_TRUE(producer_->Write(AsBytes("d"), &wake_consumer));
+  EXPECT_FALSE(wake_consumer);
+  EXPECT_EQ("c", Read());
+  EXPECT_EQ("d", Read());
+}
+
+TEST_F(SharedMemoryRingBufferTest, ReopenConsumer) {
+  CreateRing(64);
+  EXPECT_TRUE(Write("a"));
+  EXPECT_TRUE(Write("b"));
+  EXPECT_EQ("a", Read());
+  consumer_ = std::make_unique<SharedMemoryRingBuffer>(
+      region_.Map(), SharedMemoryRingBuffer::Role::kConsumer);
+  EXPECT_EQ("b", Read());
+}
+
+TEST_F(SharedMemoryRingBufferTest, FormatVersion) {
+  UnsafeSharedMemoryRegion region = UnsafeSharedMemoryRegion::Create(
+      SharedMemoryRingBuffer::GetRegionSize(64));
+  ASSERT_TRUE(region.IsValid());
+  {
+    // A region written by a build with another layout.
+    WritableSharedMemoryMapping mapping = region.Map();
+    *mapping.GetMemoryAs<uint32_t>() = 12345;
+  }
+  EXPECT_CHECK_DEATH(SharedMemoryRingBuffer(
+      region.Map(), SharedMemoryRingBuffer::Role::kConsumer));
+}
+
+namespace {
+
+class Producer : public DelegateSimpleThread::Delegate {
+ public:
+  Producer(SharedMemoryRingBuffer* ring, uint32_t num_messages)
+      : ring_(ring), num_messages_(num_messages) {}
+
+  void Run() override {
+    for (uint32_t i = 0; i < num_messages_;) {
+      bool wake_consumer;
+      if (ring_->Write(as_bytes(make_span(&i, 1u)), &wake_consumer))
+        ++i;
+    }
+  }
+
+ private:
+  SharedMemoryRingBuffer* const ring_;
+  const uint32_t num_messages_;
+};
+
+}  // namespace
+
+TEST_F(SharedMemoryRingBufferTest, ConcurrentProducer) {
+  constexpr uint32_t kNumMessages = 100000;
+  CreateRing(64);
+  Producer producer(producer_.get(), kNumMessages);
+  DelegateSimpleThread thread(&producer, "Producer");
+  thread.Start();
+  for (uint32_t i = 0; i < kNumMessages;) {
+    absl::optional<span<const uint8_t>> message = consumer_->Peek();
+    if (!message)
+      continue;
+    ASSERT_EQ(sizeof(uint32_t), message->size());
+    uint32_t value;
+    memcpy(&value, message->data(), sizeof(value));
+    ASSERT_EQ(i, value);
+    consumer_->Pop();
+    ++i;
+  }
+  thread.Join();
+}
+
+#if BUILDFLAG(IS_LINUX) || BUILDFLAG(IS_CHROMEOS) || BUILDFLAG(IS_ANDROID)
+
+TEST_F(SharedMemoryRingBufferTest, WaitForWriteTimesOut) {
+  CreateRing(64);
+  consumer_->WaitForWrite(Milliseconds(1));
+  EXPECT_EQ("<empty>", Read());
+
+  // Doesn't sleep with a pending message.
+  EXPECT_TRUE(Write("a"));
+  consumer_->WaitForWrite(TimeDelta::Max());
+  EXPECT_EQ("a", Read());
+}
+
+namespace {
+
+class WakingProducer : public DelegateSimpleThread::Delegate {
+ public:
+  WakingProducer(SharedMemoryRingBuffer* ring, uint32_t num_messages)
+      : ring_(ring), num_messages_(num_messages) {}
+
+  void Run() override {
+    for (uint32_t i = 0; i < num_messages_;) {
+      // Give the consumer time to fall asleep now and then.
+      if (i % 1000 == 0)
+        PlatformThread::Sleep(Milliseconds(1));
+      bool wake_consumer;
+      if (!ring_->Write(as_bytes(make_span(&i, 1u)), &wake_consumer))
+        continue;
+      if (wake_consumer)
+        ring_->WakeConsumer();
+      ++i;
+    }
+  }
+
+ private:
+  SharedMemoryRingBuffer* const ring_;
+  const uint32_t num_messages_;
+};
+
+}  // namespace
+
+TEST_F(SharedMemoryRingBufferTest, WaitForWrite) {
+  constexpr uint32_t kNumMessages = 20000;
+  CreateRing(64);
+  WakingProducer producer(producer_.get(), kNumMessages);
+  DelegateSimpleThread thread(&producer, "Producer");
+  thread.Start();
+  for (uint32_t i = 0; i < kNumMessages;) {
+    absl::optional<span<const uint8_t>> message = consumer_->Peek();
+    if (!message) {
+      // Would hang if a wake-up got lost.
+      consumer_->WaitForWrite(TimeDelta::Max());
+      continue;
+    }
+    uint32_t value;
+    memcpy(&value, message->data(), sizeof(value));
+    ASSERT_EQ(i, value);
+    consumer_->Pop();
+    ++i;
+  }
+  thread.Join();
+}
+
+#endif  // BUILDFLAG(IS_LINUX) || BUILDFLAG(IS_CHROMEOS) ||
+        // BUILDFLAG(IS_ANDROID)
+
+}  // namespace base
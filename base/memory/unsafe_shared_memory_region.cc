@@ -6,6 +6,8 @@
 
 #include <utility>
 
+#include "build/build_config.h"
+
 namespace base {
 
 UnsafeSharedMemoryRegion::CreateFunction*
@@ -22,6 +24,21 @@ UnsafeSharedMemoryRegion UnsafeSharedMemoryRegion::Create(size_t size) {
   return UnsafeSharedMemoryRegion(std::move(handle));
 }
 
+#if BUILDFLAG(IS_LINUX) || BUILDFLAG(IS_CHROMEOS)
+// static
+UnsafeSharedMemoryRegion UnsafeSharedMemoryRegion::CreateWithPlacement(
+    size_t size,
+    const SharedMemoryPlacement& placement) {
+  if (create_hook_)
+    return create_hook_(size);
+
+  subtle::PlatformSharedMemoryRegion handle =
+      subtle::PlatformSharedMemoryRegion::CreateUnsafe(size, placement);
+
+  return UnsafeSharedMemoryRegion(std::move(handle));
+}
+#endif  // BUILDFLAG(IS_LINUX) || BUILDFLAG(IS_CHROMEOS)
+
 // static
 UnsafeSharedMemoryRegion UnsafeSharedMemoryRegion::Deserialize(
     subtle::PlatformSharedMemoryRegion handle) {
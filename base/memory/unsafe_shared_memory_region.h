@@ -7,6 +7,7 @@
 
 #include "base/memory/platform_shared_memory_region.h"
 #include "base/memory/shared_memory_mapping.h"
+#include "build/build_config.h"
 
 namespace base {
 
@@ -32,6 +33,16 @@ class BASE_EXPORT UnsafeSharedMemoryRegion {
   static UnsafeSharedMemoryRegion Create(size_t size);
   using CreateFunction = decltype(Create);
 
+#if BUILDFLAG(IS_LINUX) || BUILDFLAG(IS_CHROMEOS)
+  // Same as Create(), with the pages placed as |placement| asks, e.g. on huge
+  // pages. Returns an invalid region if the system can't honor it. In a
+  // process whose regions are created by a hook (see SharedMemoryHooks),
+  // creates a region with the default placement.
+  static UnsafeSharedMemoryRegion CreateWithPlacement(
+      size_t size,
+      const SharedMemoryPlacement& placement);
+#endif
+
   // Returns an UnsafeSharedMemoryRegion built from a platform-specific handle
   // that was taken from another UnsafeSharedMemoryRegion instance. Returns an
   // invalid region iff the |handle| is invalid. CHECK-fails if the |handle|
@@ -4,6 +4,8 @@
 
 #include "base/memory/weak_ptr.h"
 
+#include <utility>
+
 #if DCHECK_IS_ON()
 #include <ostream>
 
@@ -13,7 +15,10 @@
 namespace base {
 namespace internal {
 
-WeakReference::Flag::Flag() {
+WeakReference::Flag::Flag() : Flag(nullptr) {}
+
+WeakReference::Flag::Flag(scoped_refptr<const Flag> group_flag)
+    : group_flag_(std::move(group_flag)) {
   // Flags only become bound when checked for validity, or invalidated,
   // so that we can check that later validity/invalidation operations on
   // the same Flag take place on the same sequenced thread.
@@ -37,11 +42,11 @@ void WeakReference::Flag::Invalidate() {
 bool WeakReference::Flag::IsValid() const {
   // WeakPtrs must be checked on the same sequenced thread.
   DCHECK_CALLED_ON_VALID_SEQUENCE(sequence_checker_);
-  return !invalidated_.IsSet();
+  return !invalidated_.IsSet() && (!group_flag_ || group_flag_->MaybeValid());
 }
 
 bool WeakReference::Flag::MaybeValid() const {
-  return !invalidated_.IsSet();
+  return !invalidated_.IsSet() && (!group_flag_ || group_flag_->MaybeValid());
 }
 
 #if DCHECK_IS_ON()
@@ -70,26 +75,63 @@ bool WeakReference::MaybeValid() const {
   return flag_ && flag_->MaybeValid();
 }
 
-WeakReferenceOwner::WeakReferenceOwner()
-    : flag_(MakeRefCounted<WeakReference::Flag>()) {}
+WeakReferenceOwner::WeakReferenceOwner() = default;
+
+WeakReferenceOwner::WeakReferenceOwner(
+    scoped_refptr<const WeakReference::Flag> group_flag)
+    : group_flag_(std::move(group_flag)) {}
 
 WeakReferenceOwner::~WeakReferenceOwner() {
-  flag_->Invalidate();
+  WeakReference::Flag* flag = flag_.load(std::memory_order_relaxed);
+  if (flag) {
+    flag->Invalidate();
+    flag->Release();
+  }
 }
 
 WeakReference WeakReferenceOwner::GetRef() const {
+  WeakReference::Flag* flag = flag_.load(std::memory_order_acquire);
+  if (UNLIKELY(!flag))
+    return WeakReference(WrapRefCounted(CreateFlag()));
+
 #if DCHECK_IS_ON()
   // If we hold the last reference to the Flag then detach the SequenceChecker.
   if (!HasRefs())
-    flag_->DetachFromSequence();
+    flag->DetachFromSequence();
 #endif
 
-  return WeakReference(flag_);
+  return WeakReference(WrapRefCounted(flag));
 }
 
 void WeakReferenceOwner::Invalidate() {
-  flag_->Invalidate();
-  flag_ = MakeRefCounted<WeakReference::Flag>();
+  WeakReference::Flag* flag = flag_.load(std::memory_order_relaxed);
+  if (!flag)
+    return;
+  if (flag->HasOneRef()) {
+    // There are no references to invalidate, so the flag is kept, as if
+    // replaced by an unbound one.
+#if DCHECK_IS_ON()
+    flag->DetachFromSequence();
+#endif
+    return;
+  }
+  flag_.store(nullptr, std::memory_order_relaxed);
+  flag->Invalidate();
+  flag->Release();
+}
+
+WeakReference::Flag* WeakReferenceOwner::CreateFlag() const {
+  WeakReference::Flag* flag =
+      MakeRefCounted<WeakReference::Flag>(group_flag_).release();
+  WeakReference::Flag* current_flag = nullptr;
+  if (flag_.compare_exchange_strong(current_flag, flag,
+                                    std::memory_order_acq_rel,
+                                    std::memory_order_acquire)) {
+    return flag;
+  }
+  // Created meanwhile by another sequence.
+  flag->Release();
+  return current_flag;
 }
 
 WeakPtrBase::WeakPtrBase() : ptr_(0) {}
@@ -105,9 +147,25 @@ WeakPtrFactoryBase::WeakPtrFactoryBase(uintptr_t ptr) : ptr_(ptr) {
   DCHECK(ptr_);
 }
 
+WeakPtrFactoryBase::WeakPtrFactoryBase(uintptr_t ptr,
+                                       const WeakPtrFactoryGroup& group)
+    : weak_reference_owner_(group.flag_), ptr_(ptr) {
+  DCHECK(ptr_);
+}
+
 WeakPtrFactoryBase::~WeakPtrFactoryBase() {
   ptr_ = 0;
 }
 
 }  // namespace internal
+
+WeakPtrFactoryGroup::WeakPtrFactoryGroup()
+    : flag_(MakeRefCounted<internal::WeakReference::Flag>()) {}
+
+WeakPtrFactoryGroup::~WeakPtrFactoryGroup() = default;
+
+void WeakPtrFactoryGroup::InvalidateWeakPtrs() {
+  flag_->Invalidate();
+}
+
 }  // namespace base
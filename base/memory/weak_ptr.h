@@ -71,6 +71,7 @@
 #ifndef BASE_MEMORY_WEAK_PTR_H_
 #define BASE_MEMORY_WEAK_PTR_H_
 
+#include <atomic>
 #include <cstddef>
 #include <type_traits>
 #include <utility>
@@ -79,6 +80,7 @@
 #include "base/check.h"
 #include "base/compiler_specific.h"
 #include "base/dcheck_is_on.h"
+#include "base/memory/biased_ref_counted.h"
 #include "base/memory/ref_counted.h"
 #include "base/sequence_checker.h"
 #include "base/synchronization/atomic_flag.h"
@@ -89,6 +91,8 @@ template <typename T>
 class SafeRef;
 template <typename T> class SupportsWeakPtr;
 template <typename T> class WeakPtr;
+template <typename T> class WeakPtrFactory;
+class WeakPtrFactoryGroup;
 
 namespace internal {
 // These classes are part of the WeakPtr implementation.
@@ -97,10 +101,14 @@ namespace internal {
 class BASE_EXPORT TRIVIAL_ABI WeakReference {
  public:
   // Although Flag is bound to a specific SequencedTaskRunner, it may be
-  // deleted from another via base::WeakPtr::~WeakPtr().
-  class BASE_EXPORT Flag : public RefCountedThreadSafe<Flag> {
+  // deleted from another via base::WeakPtr::~WeakPtr(). Its references are
+  // biased towards the thread which created it, usually the one handing out
+  // and copying the WeakPtrs, since it may be deleted late.
+  class BASE_EXPORT Flag : public BiasedRefCountedThreadSafe<Flag> {
    public:
     Flag();
+    // Also invalid once |group_flag| is.
+    explicit Flag(scoped_refptr<const Flag> group_flag);
 
     void Invalidate();
     bool IsValid() const;
@@ -112,12 +120,15 @@ class BASE_EXPORT TRIVIAL_ABI WeakReference {
 #endif
 
    private:
-    friend class base::RefCountedThreadSafe<Flag>;
+    friend class base::BiasedRefCountedThreadSafe<Flag>;
 
     ~Flag();
 
     SEQUENCE_CHECKER(sequence_checker_);
     AtomicFlag invalidated_;
+    // The flag of the WeakPtrFactoryGroup, if any, which is only checked with
+    // MaybeValid(), so that it isn't bound to a sequence.
+    const scoped_refptr<const Flag> group_flag_;
   };
 
   WeakReference();
@@ -139,16 +150,31 @@ class BASE_EXPORT TRIVIAL_ABI WeakReference {
 class BASE_EXPORT WeakReferenceOwner {
  public:
   WeakReferenceOwner();
+  // The references are also invalid once |group_flag| is.
+  explicit WeakReferenceOwner(
+      scoped_refptr<const WeakReference::Flag> group_flag);
+  WeakReferenceOwner(const WeakReferenceOwner&) = delete;
+  WeakReferenceOwner& operator=(const WeakReferenceOwner&) = delete;
   ~WeakReferenceOwner();
 
   WeakReference GetRef() const;
 
-  bool HasRefs() const { return !flag_->HasOneRef(); }
+  bool HasRefs() const {
+    const WeakReference::Flag* flag = flag_.load(std::memory_order_relaxed);
+    return flag && !flag->HasOneRef();
+  }
 
   void Invalidate();
 
  private:
-  scoped_refptr<WeakReference::Flag> flag_;
+  WeakReference::Flag* CreateFlag() const;
+
+  // Holds a reference, allocated by the first GetRef(), and dropped once
+  // invalidated while referenced, so that the owners which never hand out
+  // references don't allocate. Atomic since GetRef() may be called on any
+  // sequence.
+  mutable std::atomic<WeakReference::Flag*> flag_{nullptr};
+  const scoped_refptr<const WeakReference::Flag> group_flag_;
 };
 
 // This class simplifies the implementation of WeakPtr's type conversion
@@ -218,8 +244,6 @@ SafeRef<T> MakeSafeRefFromWeakPtrInternals(const internal::WeakReference& ref,
 
 }  // namespace internal
 
-template <typename T> class WeakPtrFactory;
-
 // The WeakPtr class holds a weak reference to |T*|.
 //
 // This class is designed to be used like a normal pointer.  You should always
@@ -322,12 +346,55 @@ namespace internal {
 class BASE_EXPORT WeakPtrFactoryBase {
  protected:
   WeakPtrFactoryBase(uintptr_t ptr);
+  WeakPtrFactoryBase(uintptr_t ptr, const WeakPtrFactoryGroup& group);
   ~WeakPtrFactoryBase();
   internal::WeakReferenceOwner weak_reference_owner_;
   uintptr_t ptr_;
 };
 }  // namespace internal
 
+// Invalidates the WeakPtrs of several WeakPtrFactory instances at once, e.g.
+// those of the objects serving a request once it is cancelled, with a single
+// flag instead of one per factory.
+//
+//   class Request {
+//     ...
+//     void Cancel() { weak_factory_group_.InvalidateWeakPtrs(); }
+//
+//    private:
+//     WeakPtrFactoryGroup weak_factory_group_;
+//     Fetcher fetcher_{weak_factory_group_};
+//     Parser parser_{weak_factory_group_};
+//   };
+//
+//   class Fetcher {
+//    public:
+//     explicit Fetcher(const WeakPtrFactoryGroup& group)
+//         : weak_factory_(this, group) {}
+//    private:
+//     WeakPtrFactory<Fetcher> weak_factory_;
+//   };
+//
+// Unlike WeakPtrFactory::InvalidateWeakPtrs(), it is final: the factories of
+// the group only hand out invalid WeakPtrs from then on. It must be called on
+// the sequence the WeakPtrs are dereferenced on. The factories may outlive the
+// group, which doesn't invalidate their WeakPtrs once destroyed.
+class BASE_EXPORT WeakPtrFactoryGroup {
+ public:
+  WeakPtrFactoryGroup();
+  WeakPtrFactoryGroup(const WeakPtrFactoryGroup&) = delete;
+  WeakPtrFactoryGroup& operator=(const WeakPtrFactoryGroup&) = delete;
+  ~WeakPtrFactoryGroup();
+
+  // Invalidates the WeakPtrs of all the factories of the group.
+  void InvalidateWeakPtrs();
+
+ private:
+  friend class internal::WeakPtrFactoryBase;
+
+  const scoped_refptr<internal::WeakReference::Flag> flag_;
+};
+
 // A class may be composed of a WeakPtrFactory and thereby
 // control how it exposes weak pointers to itself.  This is helpful if you only
 // need weak pointers within the implementation of a class.  This class is also
@@ -341,6 +408,10 @@ class WeakPtrFactory : public internal::WeakPtrFactoryBase {
   explicit WeakPtrFactory(T* ptr)
       : WeakPtrFactoryBase(reinterpret_cast<uintptr_t>(ptr)) {}
 
+  // Also invalidates its WeakPtrs once |group| does.
+  WeakPtrFactory(T* ptr, const WeakPtrFactoryGroup& group)
+      : WeakPtrFactoryBase(reinterpret_cast<uintptr_t>(ptr), group) {}
+
   WeakPtrFactory(const WeakPtrFactory&) = delete;
   WeakPtrFactory& operator=(const WeakPtrFactory&) = delete;
 
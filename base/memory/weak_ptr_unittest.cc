@@ -486,6 +486,73 @@ TEST(WeakPtrTest, HasWeakPtrs) {
   EXPECT_FALSE(factory.HasWeakPtrs());
 }
 
+TEST(WeakPtrTest, InvalidateWeakPtrsWithoutWeakPtrs) {
+  int data;
+  WeakPtrFactory<int> factory(&data);
+  factory.InvalidateWeakPtrs();
+  EXPECT_FALSE(factory.HasWeakPtrs());
+  {
+    WeakPtr<int> ptr = factory.GetWeakPtr();
+    EXPECT_EQ(&data, ptr.get());
+  }
+  factory.InvalidateWeakPtrs();
+  WeakPtr<int> ptr = factory.GetWeakPtr();
+  EXPECT_EQ(&data, ptr.get());
+  EXPECT_TRUE(factory.HasWeakPtrs());
+}
+
+TEST(WeakPtrFactoryGroupTest, InvalidateWeakPtrs) {
+  int data1, data2, data3;
+  WeakPtrFactoryGroup group;
+  WeakPtrFactory<int> factory1(&data1, group);
+  WeakPtrFactory<int> factory2(&data2, group);
+  WeakPtrFactory<int> factory3(&data3);
+  WeakPtr<int> ptr1 = factory1.GetWeakPtr();
+  WeakPtr<int> ptr2 = factory2.GetWeakPtr();
+  WeakPtr<int> ptr3 = factory3.GetWeakPtr();
+
+  group.InvalidateWeakPtrs();
+  EXPECT_EQ(nullptr, ptr1.get());
+  EXPECT_TRUE(ptr1.WasInvalidated());
+  EXPECT_FALSE(ptr2.MaybeValid());
+  EXPECT_EQ(&data3, ptr3.get());
+
+  // Final, unlike the invalidation of a factory.
+  EXPECT_EQ(nullptr, factory1.GetWeakPtr().get());
+}
+
+TEST(WeakPtrFactoryGroupTest, InvalidateFactoryOfGroup) {
+  int data1, data2;
+  WeakPtrFactoryGroup group;
+  WeakPtrFactory<int> factory1(&data1, group);
+  WeakPtrFactory<int> factory2(&data2, group);
+  WeakPtr<int> ptr1 = factory1.GetWeakPtr();
+  WeakPtr<int> ptr2 = factory2.GetWeakPtr();
+
+  factory1.InvalidateWeakPtrs();
+  EXPECT_EQ(nullptr, ptr1.get());
+  EXPECT_EQ(&data2, ptr2.get());
+  ptr1 = factory1.GetWeakPtr();
+  EXPECT_EQ(&data1, ptr1.get());
+
+  group.InvalidateWeakPtrs();
+  EXPECT_EQ(nullptr, ptr1.get());
+  EXPECT_EQ(nullptr, ptr2.get());
+}
+
+TEST(WeakPtrFactoryGroupTest, FactoryOutlivesGroup) {
+  int data;
+  auto group = std::make_unique<WeakPtrFactoryGroup>();
+  WeakPtr<int> ptr;
+  {
+    WeakPtrFactory<int> factory(&data, *group);
+    group.reset();
+    ptr = factory.GetWeakPtr();
+    EXPECT_EQ(&data, ptr.get());
+  }
+  EXPECT_EQ(nullptr, ptr.get());
+}
+
 TEST(WeakPtrTest, ObjectAndWeakPtrOnDifferentThreads) {
   // Test that it is OK to create an object that supports WeakPtr on one thread,
   // but use it on another.  This tests that we do not trip runtime checks that
@@ -24,6 +24,21 @@ WritableSharedMemoryRegion WritableSharedMemoryRegion::Create(size_t size) {
   return WritableSharedMemoryRegion(std::move(handle));
 }
 
+#if BUILDFLAG(IS_LINUX) || BUILDFLAG(IS_CHROMEOS)
+// static
+WritableSharedMemoryRegion WritableSharedMemoryRegion::CreateWithPlacement(
+    size_t size,
+    const SharedMemoryPlacement& placement) {
+  if (create_hook_)
+    return create_hook_(size);
+
+  subtle::PlatformSharedMemoryRegion handle =
+      subtle::PlatformSharedMemoryRegion::CreateWritable(size, placement);
+
+  return WritableSharedMemoryRegion(std::move(handle));
+}
+#endif  // BUILDFLAG(IS_LINUX) || BUILDFLAG(IS_CHROMEOS)
+
 // static
 WritableSharedMemoryRegion WritableSharedMemoryRegion::Deserialize(
     subtle::PlatformSharedMemoryRegion handle) {
@@ -35,6 +35,16 @@ class BASE_EXPORT WritableSharedMemoryRegion {
   static WritableSharedMemoryRegion Create(size_t size);
   using CreateFunction = decltype(Create);
 
+#if BUILDFLAG(IS_LINUX) || BUILDFLAG(IS_CHROMEOS)
+  // Same as Create(), with the pages placed as |placement| asks, e.g. on huge
+  // pages. Returns an invalid region if the system can't honor it. In a
+  // process whose regions are created by a hook (see SharedMemoryHooks),
+  // creates a region with the default placement.
+  static WritableSharedMemoryRegion CreateWithPlacement(
+      size_t size,
+      const SharedMemoryPlacement& placement);
+#endif
+
   // Returns a WritableSharedMemoryRegion built from a platform handle that was
   // taken from another WritableSharedMemoryRegion instance. Returns an invalid
   // region iff the |handle| is invalid. CHECK-fails if the |handle| isn't
@@ -0,0 +1,386 @@
+// Copyright 2022 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "base/message_loop/message_pump_epoll.h"
+
+#include <errno.h>
+#include <sys/eventfd.h>
+#include <unistd.h>
+
+#include <algorithm>
+
+#include "base/auto_reset.h"
+#include "base/check_op.h"
+#include "base/logging.h"
+#include "base/notreached.h"
+#include "base/numerics/safe_conversions.h"
+#include "base/posix/eintr_wrapper.h"
+#include "base/trace_event/base_tracing.h"
+
+namespace base {
+
+namespace {
+
+// Errors and hang-ups are reported to both readers and writers, like
+// libevent does.
+constexpr uint32_t kReadEvents = EPOLLIN | EPOLLERR | EPOLLHUP;
+constexpr uint32_t kWriteEvents = EPOLLOUT | EPOLLERR | EPOLLHUP;
+
+}  // namespace
+
+MessagePumpEpoll::FdWatchController::FdWatchController(
+    const Location& from_here)
+    : FdWatchControllerInterface(from_here) {}
+
+MessagePumpEpoll::FdWatchController::~FdWatchController() {
+  if (fd_ != -1) {
+    CHECK(StopWatchingFileDescriptor());
+  }
+  if (was_destroyed_) {
+    DCHECK(!*was_destroyed_);
+    *was_destroyed_ = true;
+  }
+}
+
+bool MessagePumpEpoll::FdWatchController::StopWatchingFileDescriptor() {
+  bool success = true;
+  if (active_)
+    success = pump_->RemoveController(this);
+  pump_ = nullptr;
+  watcher_ = nullptr;
+  fd_ = -1;
+  mode_ = 0;
+  persistent_ = false;
+  return success;
+}
+
+void MessagePumpEpoll::FdWatchController::OnFileCanReadWithoutBlocking(
+    int fd) {
+  // Since OnFileCanWriteWithoutBlocking() gets called first, it can stop
+  // watching the file descriptor.
+  if (!watcher_)
+    return;
+  watcher_->OnFileCanReadWithoutBlocking(fd);
+}
+
+void MessagePumpEpoll::FdWatchController::OnFileCanWriteWithoutBlocking(
+    int fd) {
+  DCHECK(watcher_);
+  watcher_->OnFileCanWriteWithoutBlocking(fd);
+}
+
+MessagePumpEpoll::MessagePumpEpoll()
+    : epoll_(epoll_create1(EPOLL_CLOEXEC)),
+      wakeup_(eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC)) {
+  PCHECK(epoll_.is_valid()) << "epoll_create1";
+  PCHECK(wakeup_.is_valid()) << "eventfd";
+
+  epoll_event event{};
+  event.events = EPOLLIN;
+  event.data.ptr = &wakeup_;
+  int rv = epoll_ctl(epoll_.get(), EPOLL_CTL_ADD, wakeup_.get(), &event);
+  PCHECK(rv == 0) << "epoll_ctl";
+}
+
+MessagePumpEpoll::~MessagePumpEpoll() {
+  // Detach the controllers which are still watching, so that they don't
+  // reference the pump once it's gone.
+  for (auto& fd_and_head : controllers_) {
+    FdWatchController* controller = fd_and_head.second;
+    while (controller) {
+      FdWatchController* next = controller->next_;
+      controller->pump_ = nullptr;
+      controller->active_ = false;
+      controller->next_ = nullptr;
+      controller = next;
+    }
+  }
+}
+
+bool MessagePumpEpoll::WatchFileDescriptor(int fd,
+                                           bool persistent,
+                                           int mode,
+                                           FdWatchController* controller,
+                                           FdWatcher* delegate) {
+  DCHECK_GE(fd, 0);
+  DCHECK(controller);
+  DCHECK(delegate);
+  DCHECK(mode == WATCH_READ || mode == WATCH_WRITE || mode == WATCH_READ_WRITE);
+  // WatchFileDescriptor should be called on the pump thread. It is not
+  // threadsafe, and your watcher may never be registered.
+  DCHECK(watch_file_descriptor_caller_checker_.CalledOnValidThread());
+
+  if (controller->fd_ != -1) {
+    // It's illegal to use this function to listen on 2 separate fds with the
+    // same |controller|.
+    if (controller->fd_ != fd) {
+      NOTREACHED() << "FDs don't match" << controller->fd_ << "!=" << fd;
+      return false;
+    }
+    // Combine old/new watches.
+    mode |= controller->mode_;
+    persistent |= controller->persistent_;
+    if (controller->active_ && !RemoveController(controller))
+      return false;
+  }
+
+  controller->pump_ = this;
+  controller->watcher_ = delegate;
+  controller->fd_ = fd;
+  controller->mode_ = mode;
+  controller->persistent_ = persistent;
+  if (!AddController(controller)) {
+    controller->StopWatchingFileDescriptor();
+    return false;
+  }
+  return true;
+}
+
+// Reentrant!
+void MessagePumpEpoll::Run(Delegate* delegate) {
+  RunState run_state(delegate, run_state_);
+  AutoReset<RunState*> auto_reset_run_state(&run_state_, &run_state);
+
+  for (;;) {
+    // Do some work and see if the next task is ready right away.
+    Delegate::NextWorkInfo next_work_info = delegate->DoWork();
+    bool immediate_work_available = next_work_info.is_immediate();
+
+    if (run_state.should_quit)
+      break;
+
+    // Process native events if any are ready. Do not block waiting for more.
+    WaitForEvents(&run_state, TimeDelta());
+
+    bool attempt_more_work = immediate_work_available || processed_io_events_;
+    processed_io_events_ = false;
+
+    if (run_state.should_quit)
+      break;
+
+    if (attempt_more_work)
+      continue;
+
+    attempt_more_work = delegate->DoIdleWork();
+
+    if (run_state.should_quit)
+      break;
+
+    if (attempt_more_work)
+      continue;
+
+    // Block waiting for events and process all available upon waking up,
+    // until the next delayed task is due.
+    DCHECK(!next_work_info.delayed_run_time.is_null());
+    const TimeDelta timeout = next_work_info.delayed_run_time.is_max()
+                                  ? TimeDelta::Max()
+                                  : next_work_info.remaining_delay();
+    delegate->BeforeWait();
+    WaitForEvents(&run_state, timeout);
+
+    if (run_state.should_quit)
+      break;
+  }
+}
+
+void MessagePumpEpoll::Quit() {
+  DCHECK(run_state_) << "Quit was called outside of Run!";
+  run_state_->should_quit = true;
+  ScheduleWork();
+}
+
+void MessagePumpEpoll::ScheduleWork() {
+  // Adding to the eventfd makes it readable until the pump reads it. This
+  // fails with EAGAIN only if the counter is about to overflow, in which case
+  // the pump is already woken up.
+  const uint64_t value = 1;
+  int nwrite = HANDLE_EINTR(write(wakeup_.get(), &value, sizeof(value)));
+  DPCHECK(nwrite == sizeof(value) || errno == EAGAIN) << "nwrite:" << nwrite;
+}
+
+void MessagePumpEpoll::ScheduleDelayedWork(
+    const TimeTicks& delayed_work_time) {
+  // Nothing to do: this can only be called on the thread of Run(), which will
+  // sleep with the correct timeout when it's out of immediate tasks.
+}
+
+bool MessagePumpEpoll::AddController(FdWatchController* controller) {
+  DCHECK(!controller->active_);
+  DCHECK(!controller->next_);
+  controller->active_ = true;
+
+  const int fd = controller->fd_;
+  auto it = controllers_.find(fd);
+  if (it == controllers_.end()) {
+    if (CtlEpoll(EPOLL_CTL_ADD, fd, controller) < 0) {
+      DPLOG(ERROR) << "epoll_ctl(EPOLL_CTL_ADD, fd=" << fd << ")";
+      controller->active_ = false;
+      return false;
+    }
+    controllers_.emplace(fd, controller);
+    return true;
+  }
+
+  FdWatchController* tail = it->second;
+  while (tail->next_)
+    tail = tail->next_;
+  tail->next_ = controller;
+  int rv = CtlEpoll(EPOLL_CTL_MOD, fd, it->second);
+  if (rv < 0 && errno == ENOENT) {
+    // |fd| was closed, which dropped its registration, and then reused.
+    rv = CtlEpoll(EPOLL_CTL_ADD, fd, it->second);
+  }
+  if (rv < 0) {
+    DPLOG(ERROR) << "epoll_ctl(EPOLL_CTL_MOD, fd=" << fd << ")";
+    tail->next_ = nullptr;
+    controller->active_ = false;
+    return false;
+  }
+  return true;
+}
+
+bool MessagePumpEpoll::RemoveController(FdWatchController* controller) {
+  DCHECK(controller->active_);
+  const int fd = controller->fd_;
+  auto it = controllers_.find(fd);
+  DCHECK(it != controllers_.end());
+
+  FdWatchController* const next = controller->next_;
+  if (it->second == controller) {
+    it->second = next;
+  } else {
+    FdWatchController* previous = it->second;
+    while (previous->next_ != controller)
+      previous = previous->next_;
+    previous->next_ = next;
+  }
+  FdWatchController* const head = it->second;
+  if (!head)
+    controllers_.erase(it);
+  controller->next_ = nullptr;
+  controller->active_ = false;
+
+  // Events which are pending in this Run() or an outer one reference the head
+  // of the list, so redirect them.
+  for (RunState* run_state = run_state_; run_state;
+       run_state = run_state->outer) {
+    if (run_state->next_controller == controller)
+      run_state->next_controller = next;
+    for (size_t i = run_state->next_event; i < run_state->num_events; ++i) {
+      if (run_state->events[i].data.ptr == controller)
+        run_state->events[i].data.ptr = head;
+    }
+  }
+
+  int rv = head ? CtlEpoll(EPOLL_CTL_MOD, fd, head)
+                : CtlEpoll(EPOLL_CTL_DEL, fd, nullptr);
+  // Closing a file descriptor drops its registration, which isn't an error.
+  if (rv < 0 && errno != EBADF && errno != ENOENT) {
+    DPLOG(ERROR) << "epoll_ctl(fd=" << fd << ")";
+    return false;
+  }
+  return true;
+}
+
+int MessagePumpEpoll::CtlEpoll(int op, int fd, FdWatchController* head) {
+  epoll_event event{};
+  for (FdWatchController* controller = head; controller;
+       controller = controller->next_) {
+    if (controller->mode_ & WATCH_READ)
+      event.events |= EPOLLIN;
+    if (controller->mode_ & WATCH_WRITE)
+      event.events |= EPOLLOUT;
+  }
+  event.data.ptr = head;
+  return epoll_ctl(epoll_.get(), op, fd, &event);
+}
+
+void MessagePumpEpoll::WaitForEvents(RunState* run_state, TimeDelta timeout) {
+  // Make room for an event per watched file descriptor and for |wakeup_|, so
+  // that a single call reads all the ready events.
+  if (run_state->events.size() < controllers_.size() + 1)
+    run_state->events.resize(controllers_.size() + 1);
+
+  int timeout_ms = -1;
+  if (!timeout.is_max()) {
+    // Round up to avoid waking up just before the next delayed task is due.
+    timeout_ms = saturated_cast<int>(
+        std::max<int64_t>(timeout.InMillisecondsRoundedUp(), 0));
+  }
+  const int max_events = saturated_cast<int>(run_state->events.size());
+  int rv = HANDLE_EINTR(epoll_wait(epoll_.get(), run_state->events.data(),
+                                   max_events, timeout_ms));
+  PCHECK(rv >= 0) << "epoll_wait";
+
+  run_state->next_event = 0;
+  run_state->num_events = static_cast<size_t>(rv);
+  while (run_state->next_event < run_state->num_events) {
+    const epoll_event event = run_state->events[run_state->next_event++];
+    if (event.data.ptr == &wakeup_) {
+      // Reset the eventfd. This isn't "doing work", this just wakes up the
+      // pump.
+      uint64_t value;
+      int nread = HANDLE_EINTR(read(wakeup_.get(), &value, sizeof(value)));
+      DPCHECK(nread == sizeof(value) || errno == EAGAIN) << "nread:" << nread;
+      continue;
+    }
+
+    // Notify each controller of the file descriptor. |next_controller| is
+    // updated if the next controller stops watching in a callback, and the
+    // head is null if the controllers stopped watching since epoll_wait().
+    FdWatchController* controller =
+        static_cast<FdWatchController*>(event.data.ptr);
+    while (controller) {
+      run_state->next_controller = controller->next_;
+      DispatchEvents(controller, event.events);
+      controller = run_state->next_controller;
+    }
+  }
+  run_state->num_events = 0;
+}
+
+void MessagePumpEpoll::DispatchEvents(FdWatchController* controller,
+                                      uint32_t events) {
+  const bool can_read =
+      (controller->mode_ & WATCH_READ) && (events & kReadEvents);
+  const bool can_write =
+      (controller->mode_ & WATCH_WRITE) && (events & kWriteEvents);
+  if (!can_read && !can_write)
+    return;
+
+  const int fd = controller->fd_;
+  TRACE_EVENT("toplevel", "OnEpollEvent", "fd", fd);
+
+  TRACE_HEAP_PROFILER_API_SCOPED_TASK_EXECUTION heap_profiler_scope(
+      controller->created_from_location().file_name());
+
+  processed_io_events_ = true;
+
+  // A non-persistent watch fires once. It is removed before its callbacks so
+  // that they can watch the file descriptor again.
+  if (!controller->persistent_)
+    RemoveController(controller);
+
+  // Make the MessagePumpDelegate aware of this other form of "DoWork".
+  Delegate::ScopedDoWorkItem scoped_do_work_item =
+      run_state_->delegate->BeginWorkItem();
+
+  if (can_read && can_write) {
+    // Both callbacks will be called. It is necessary to check that
+    // |controller| is not destroyed.
+    bool controller_was_destroyed = false;
+    controller->was_destroyed_ = &controller_was_destroyed;
+    controller->OnFileCanWriteWithoutBlocking(fd);
+    if (!controller_was_destroyed)
+      controller->OnFileCanReadWithoutBlocking(fd);
+    if (!controller_was_destroyed)
+      controller->was_destroyed_ = nullptr;
+  } else if (can_write) {
+    controller->OnFileCanWriteWithoutBlocking(fd);
+  } else {
+    controller->OnFileCanReadWithoutBlocking(fd);
+  }
+}
+
+}  // namespace base
@@ -0,0 +1,235 @@
+// Copyright 2022 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "base/message_loop/message_pump_epoll.h"
+
+#include <sys/socket.h>
+#include <unistd.h>
+
+#include <memory>
+#include <utility>
+
+#include "base/bind.h"
+#include "base/callback.h"
+#include "base/files/scoped_file.h"
+#include "base/memory/ptr_util.h"
+#include "base/memory/raw_ptr.h"
+#include "base/posix/eintr_wrapper.h"
+#include "base/run_loop.h"
+#include "base/task/single_thread_task_executor.h"
+#include "base/test/bind.h"
+#include "base/test/gtest_util.h"
+#include "base/threading/thread_task_runner_handle.h"
+#include "testing/gtest/include/gtest/gtest.h"
+
+namespace base {
+
+namespace {
+
+class MessagePumpEpollTest : public testing::Test {
+ protected:
+  MessagePumpEpollTest()
+      : pump_(new MessagePumpEpoll),
+        executor_(WrapUnique(pump_.get())) {}
+
+  void SetUp() override {
+    int fds[2];
+    ASSERT_EQ(0, socketpair(AF_UNIX, SOCK_STREAM, 0, fds));
+    socket_ = ScopedFD(fds[0]);
+    peer_ = ScopedFD(fds[1]);
+  }
+
+  // Makes |socket_| readable. It is always writable.
+  void MakeSocketReadable() {
+    const char c = 0;
+    ASSERT_EQ(1, HANDLE_EINTR(write(peer_.get(), &c, 1)));
+  }
+
+  MessagePumpEpoll* pump() { return pump_; }
+
+  ScopedFD socket_;
+  ScopedFD peer_;
+
+ private:
+  // Owned by |executor_|.
+  const raw_ptr<MessagePumpEpoll> pump_;
+  SingleThreadTaskExecutor executor_;
+};
+
+// Counts notifications and runs a closure after each of them.
+class CountingWatcher : public MessagePumpEpoll::FdWatcher {
+ public:
+  explicit CountingWatcher(RepeatingClosure on_notification = {})
+      : on_notification_(std::move(on_notification)) {}
+
+  void OnFileCanReadWithoutBlocking(int fd) override {
+    ++num_reads_;
+    if (on_notification_)
+      on_notification_.Run();
+  }
+
+  void OnFileCanWriteWithoutBlocking(int fd) override {
+    ++num_writes_;
+    if (on_notification_)
+      on_notification_.Run();
+  }
+
+  int num_reads() const { return num_reads_; }
+  int num_writes() const { return num_writes_; }
+
+ private:
+  RepeatingClosure on_notification_;
+  int num_reads_ = 0;
+  int num_writes_ = 0;
+};
+
+// Deletes its controller when notified that the file descriptor is writable.
+class DeleteWatcher : public MessagePumpEpoll::FdWatcher {
+ public:
+  explicit DeleteWatcher(
+      std::unique_ptr<MessagePumpEpoll::FdWatchController> controller)
+      : controller_(std::move(controller)) {}
+
+  void OnFileCanReadWithoutBlocking(int fd) override { ADD_FAILURE(); }
+
+  void OnFileCanWriteWithoutBlocking(int fd) override {
+    EXPECT_TRUE(controller_);
+    controller_.reset();
+  }
+
+  MessagePumpEpoll::FdWatchController* controller() {
+    return controller_.get();
+  }
+
+ private:
+  std::unique_ptr<MessagePumpEpoll::FdWatchController> controller_;
+};
+
+}  // namespace
+
+TEST_F(MessagePumpEpollTest, QuitOutsideOfRun) {
+  ASSERT_DCHECK_DEATH(pump()->Quit());
+}
+
+TEST_F(MessagePumpEpollTest, NonPersistentWatchFiresOnce) {
+  MessagePumpEpoll::FdWatchController controller(FROM_HERE);
+  CountingWatcher watcher;
+  ASSERT_TRUE(pump()->WatchFileDescriptor(socket_.get(), false,
+                                          MessagePumpEpoll::WATCH_WRITE,
+                                          &controller, &watcher));
+  RunLoop().RunUntilIdle();
+  RunLoop().RunUntilIdle();
+  EXPECT_EQ(watcher.num_writes(), 1);
+  EXPECT_EQ(watcher.num_reads(), 0);
+}
+
+TEST_F(MessagePumpEpollTest, PersistentWatchFiresUntilStopped) {
+  MessagePumpEpoll::FdWatchController controller(FROM_HERE);
+  RunLoop run_loop;
+  int num_reads = 0;
+  CountingWatcher watcher(BindLambdaForTesting([&]() {
+    if (++num_reads == 3) {
+      controller.StopWatchingFileDescriptor();
+      run_loop.Quit();
+    }
+  }));
+  MakeSocketReadable();
+  ASSERT_TRUE(pump()->WatchFileDescriptor(socket_.get(), true,
+                                          MessagePumpEpoll::WATCH_READ,
+                                          &controller, &watcher));
+  run_loop.Run();
+  RunLoop().RunUntilIdle();
+  EXPECT_EQ(watcher.num_reads(), 3);
+}
+
+// Verify that a controller deleted by its write callback doesn't get the read
+// callback.
+TEST_F(MessagePumpEpollTest, DeleteControllerInCallback) {
+  auto controller =
+      std::make_unique<MessagePumpEpoll::FdWatchController>(FROM_HERE);
+  MessagePumpEpoll::FdWatchController* controller_ptr = controller.get();
+  DeleteWatcher watcher(std::move(controller));
+  MakeSocketReadable();
+  ASSERT_TRUE(pump()->WatchFileDescriptor(socket_.get(), true,
+                                          MessagePumpEpoll::WATCH_READ_WRITE,
+                                          controller_ptr, &watcher));
+  RunLoop().RunUntilIdle();
+  EXPECT_FALSE(watcher.controller());
+}
+
+// Verify that a controller which stops watching in a callback of another
+// controller of the same file descriptor isn't notified.
+TEST_F(MessagePumpEpollTest, StopOtherControllerInCallback) {
+  MessagePumpEpoll::FdWatchController read_controller(FROM_HERE);
+  MessagePumpEpoll::FdWatchController write_controller(FROM_HERE);
+  CountingWatcher read_watcher;
+  CountingWatcher write_watcher(BindLambdaForTesting(
+      [&]() { read_controller.StopWatchingFileDescriptor(); }));
+  MakeSocketReadable();
+  ASSERT_TRUE(pump()->WatchFileDescriptor(socket_.get(), false,
+                                          MessagePumpEpoll::WATCH_WRITE,
+                                          &write_controller, &write_watcher));
+  ASSERT_TRUE(pump()->WatchFileDescriptor(socket_.get(), false,
+                                          MessagePumpEpoll::WATCH_READ,
+                                          &read_controller, &read_watcher));
+  RunLoop().RunUntilIdle();
+  EXPECT_EQ(write_watcher.num_writes(), 1);
+  EXPECT_EQ(read_watcher.num_reads(), 0);
+}
+
+TEST_F(MessagePumpEpollTest, SeveralControllersOnOneFd) {
+  MessagePumpEpoll::FdWatchController read_controller(FROM_HERE);
+  MessagePumpEpoll::FdWatchController write_controller(FROM_HERE);
+  CountingWatcher read_watcher;
+  CountingWatcher write_watcher;
+  ASSERT_TRUE(pump()->WatchFileDescriptor(socket_.get(), false,
+                                          MessagePumpEpoll::WATCH_READ,
+                                          &read_controller, &read_watcher));
+  ASSERT_TRUE(pump()->WatchFileDescriptor(socket_.get(), false,
+                                          MessagePumpEpoll::WATCH_WRITE,
+                                          &write_controller, &write_watcher));
+  RunLoop().RunUntilIdle();
+  EXPECT_EQ(write_watcher.num_writes(), 1);
+  EXPECT_EQ(read_watcher.num_reads(), 0);
+
+  MakeSocketReadable();
+  RunLoop().RunUntilIdle();
+  EXPECT_EQ(read_watcher.num_reads(), 1);
+  EXPECT_EQ(read_watcher.num_writes(), 0);
+}
+
+// Verify that a RunLoop can be nested in a callback.
+TEST_F(MessagePumpEpollTest, NestedRunLoopInCallback) {
+  MessagePumpEpoll::FdWatchController controller(FROM_HERE);
+  MessagePumpEpoll::FdWatchController nested_controller(FROM_HERE);
+  CountingWatcher nested_watcher;
+  CountingWatcher watcher(BindLambdaForTesting([&]() {
+    ASSERT_TRUE(pump()->WatchFileDescriptor(
+        peer_.get(), false, MessagePumpEpoll::WATCH_WRITE, &nested_controller,
+        &nested_watcher));
+    RunLoop run_loop(RunLoop::Type::kNestableTasksAllowed);
+    ThreadTaskRunnerHandle::Get()->PostTask(FROM_HERE, run_loop.QuitClosure());
+    run_loop.Run();
+  }));
+  MakeSocketReadable();
+  ASSERT_TRUE(pump()->WatchFileDescriptor(socket_.get(), false,
+                                          MessagePumpEpoll::WATCH_READ,
+                                          &controller, &watcher));
+  RunLoop().RunUntilIdle();
+  EXPECT_EQ(watcher.num_reads(), 1);
+  EXPECT_EQ(nested_watcher.num_writes(), 1);
+}
+
+TEST_F(MessagePumpEpollTest, WatchAfterPeerClosed) {
+  MessagePumpEpoll::FdWatchController controller(FROM_HERE);
+  CountingWatcher watcher;
+  peer_.reset();
+  ASSERT_TRUE(pump()->WatchFileDescriptor(socket_.get(), false,
+                                          MessagePumpEpoll::WATCH_READ,
+                                          &controller, &watcher));
+  RunLoop().RunUntilIdle();
+  EXPECT_EQ(watcher.num_reads(), 1);
+}
+
+}  // namespace base
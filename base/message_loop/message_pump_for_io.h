@@ -9,6 +9,7 @@
 // types representing MessagePumpForIO.
 
 #include "base/message_loop/ios_cronet_buildflags.h"
+#include "base/message_loop/message_pump_buildflags.h"
 #include "build/build_config.h"
 
 #if BUILDFLAG(IS_WIN)
@@ -21,6 +22,8 @@
 #include "base/message_loop/message_pump_default.h"
 #elif BUILDFLAG(IS_FUCHSIA)
 #include "base/message_loop/message_pump_fuchsia.h"
+#elif BUILDFLAG(ENABLE_MESSAGE_PUMP_EPOLL)
+#include "base/message_loop/message_pump_epoll.h"
 #elif BUILDFLAG(IS_POSIX)
 #include "base/message_loop/message_pump_libevent.h"
 #endif
@@ -38,6 +41,8 @@ using MessagePumpForIO = MessagePumpKqueue;
 using MessagePumpForIO = MessagePumpDefault;
 #elif BUILDFLAG(IS_FUCHSIA)
 using MessagePumpForIO = MessagePumpFuchsia;
+#elif BUILDFLAG(ENABLE_MESSAGE_PUMP_EPOLL)
+using MessagePumpForIO = MessagePumpEpoll;
 #elif BUILDFLAG(IS_POSIX)
 using MessagePumpForIO = MessagePumpLibevent;
 #else
@@ -14,6 +14,11 @@
 #include "base/posix/eintr_wrapper.h"
 #include "base/synchronization/lock.h"
 #include "base/threading/platform_thread.h"
+#include "build/build_config.h"
+
+#if BUILDFLAG(IS_LINUX) || BUILDFLAG(IS_CHROMEOS)
+#include <sys/eventfd.h>
+#endif
 
 namespace base {
 
@@ -34,6 +39,9 @@ static_assert(G_PRIORITY_DEFAULT < kPriorityFdWatch &&
                   kPriorityFdWatch < kPriorityWork,
               "Wrong priorities are set for event sources!");
 
+// The period over which the rate of wake-ups of the pump is measured.
+constexpr TimeDelta kWakeUpsPeriod = Minutes(1);
+
 // Return a timeout suitable for the glib loop according to |next_task_time|, -1
 // to block forever, 0 to return right away, or a timeout in milliseconds from
 // now.
@@ -186,14 +194,20 @@ MessagePumpGlib::MessagePumpGlib()
     context_owned_ = true;
   }
 
-  // Create our wakeup pipe, which is used to flag when work was scheduled.
+  // Create our wakeup fd, which is used to flag when work was scheduled.
+#if BUILDFLAG(IS_LINUX) || BUILDFLAG(IS_CHROMEOS)
+  wakeup_read_fd_ = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+  PCHECK(wakeup_read_fd_ >= 0) << "eventfd";
+  wakeup_write_fd_ = wakeup_read_fd_;
+#else
   int fds[2];
   [[maybe_unused]] int ret = pipe(fds);
   DCHECK_EQ(ret, 0);
 
-  wakeup_pipe_read_ = fds[0];
-  wakeup_pipe_write_ = fds[1];
-  wakeup_gpollfd_->fd = wakeup_pipe_read_;
+  wakeup_read_fd_ = fds[0];
+  wakeup_write_fd_ = fds[1];
+#endif
+  wakeup_gpollfd_->fd = wakeup_read_fd_;
   wakeup_gpollfd_->events = G_IO_IN;
 
   work_source_ = g_source_new(&WorkSourceFuncs, sizeof(WorkSource));
@@ -208,8 +222,9 @@ MessagePumpGlib::MessagePumpGlib()
 MessagePumpGlib::~MessagePumpGlib() {
   g_source_destroy(work_source_);
   g_source_unref(work_source_);
-  close(wakeup_pipe_read_);
-  close(wakeup_pipe_write_);
+  close(wakeup_read_fd_);
+  if (wakeup_write_fd_ != wakeup_read_fd_)
+    close(wakeup_write_fd_);
 
   if (context_owned_) {
     g_main_context_pop_thread_default(context_);
@@ -341,19 +356,10 @@ bool MessagePumpGlib::HandleCheck() {
   if (!state_)  // state_ may be null during tests.
     return false;
 
-  // We usually have a single message on the wakeup pipe, since we are only
-  // signaled when the queue went from empty to non-empty, but there can be
-  // two messages if a task posted a task, hence we read at most two bytes.
-  // The glib poll will tell us whether there was data, so this read
-  // shouldn't block.
+  // ScheduleWork() writes a single wake-up until we read it. The glib poll
+  // will tell us whether there was one, so this read shouldn't block.
   if (wakeup_gpollfd_->revents & G_IO_IN) {
-    char msg[2];
-    const int num_bytes = HANDLE_EINTR(read(wakeup_pipe_read_, msg, 2));
-    if (num_bytes < 1) {
-      NOTREACHED() << "Error reading from the wakeup pipe.";
-    }
-    DCHECK((num_bytes == 1 && msg[0] == '!') ||
-           (num_bytes == 2 && msg[0] == '!' && msg[1] == '!'));
+    ReadWakeUp();
     // Since we ate the message, we need to record that we have immediate work,
     // because HandleCheck() may be called without HandleDispatch being called
     // afterwards.
@@ -399,13 +405,18 @@ void MessagePumpGlib::Run(Delegate* delegate) {
     bool block = !more_work_is_plausible;
 
     more_work_is_plausible = g_main_context_iteration(context_, block);
+    if (block)
+      RecordWakeUp();
     if (state_->should_quit)
       break;
 
-    state_->next_work_info = state_->delegate->DoWork();
-    more_work_is_plausible |= state_->next_work_info.is_immediate();
-    if (state_->should_quit)
-      break;
+    // An iteration which only handled native events doesn't need DoWork().
+    if (ShouldDoWork()) {
+      state_->next_work_info = state_->delegate->DoWork();
+      more_work_is_plausible |= state_->next_work_info.is_immediate();
+      if (state_->should_quit)
+        break;
+    }
 
     if (more_work_is_plausible)
       continue;
@@ -416,6 +427,11 @@ void MessagePumpGlib::Run(Delegate* delegate) {
   }
 
   state_ = previous_state;
+  // A nested loop, run from a native event handler rather than from DoWork(),
+  // may have consumed wake-ups meant for the outer loop, so the outer loop
+  // can't trust its |next_work_info| anymore.
+  if (state_)
+    state_->next_work_info = {TimeTicks()};
 }
 
 void MessagePumpGlib::Quit() {
@@ -429,11 +445,23 @@ void MessagePumpGlib::Quit() {
 void MessagePumpGlib::ScheduleWork() {
   // This can be called on any thread, so we don't want to touch any state
   // variables as we would then need locks all over.  This ensures that if
-  // we are sleeping in a poll that we will wake up.
+  // we are sleeping in a poll that we will wake up. If a wake-up is already
+  // pending, the pump will run DoWork() after reading it, so there is no need
+  // to write another.
+  if (wakeup_pending_.exchange(true, std::memory_order_acq_rel))
+    return;
+#if BUILDFLAG(IS_LINUX) || BUILDFLAG(IS_CHROMEOS)
+  const uint64_t value = 1;
+  if (HANDLE_EINTR(write(wakeup_write_fd_, &value, sizeof(value))) !=
+      sizeof(value)) {
+    NOTREACHED() << "Could not write to the UI message loop wakeup eventfd!";
+  }
+#else
   char msg = '!';
-  if (HANDLE_EINTR(write(wakeup_pipe_write_, &msg, 1)) != 1) {
+  if (HANDLE_EINTR(write(wakeup_write_fd_, &msg, 1)) != 1) {
     NOTREACHED() << "Could not write to the UI message loop wakeup pipe!";
   }
+#endif
 }
 
 void MessagePumpGlib::ScheduleDelayedWork(const TimeTicks& delayed_work_time) {
@@ -474,4 +502,53 @@ bool MessagePumpGlib::ShouldQuit() const {
   return state_->should_quit;
 }
 
+bool MessagePumpGlib::ShouldDoWork() const {
+  const TimeTicks delayed_run_time = state_->next_work_info.delayed_run_time;
+  if (delayed_run_time.is_null() ||
+      wakeup_pending_.load(std::memory_order_acquire)) {
+    return true;
+  }
+  return !delayed_run_time.is_max() && delayed_run_time <= TimeTicks::Now();
+}
+
+void MessagePumpGlib::ReadWakeUp() {
+#if BUILDFLAG(IS_LINUX) || BUILDFLAG(IS_CHROMEOS)
+  uint64_t value;
+  const int num_bytes =
+      HANDLE_EINTR(read(wakeup_read_fd_, &value, sizeof(value)));
+  if (num_bytes != sizeof(value)) {
+    NOTREACHED() << "Error reading from the wakeup eventfd.";
+  }
+  DCHECK_EQ(value, 1u);
+#else
+  char msg;
+  const int num_bytes = HANDLE_EINTR(read(wakeup_read_fd_, &msg, 1));
+  if (num_bytes < 1) {
+    NOTREACHED() << "Error reading from the wakeup pipe.";
+  }
+  DCHECK_EQ(msg, '!');
+#endif
+  // Reading this flag after the wake-up synchronizes with the ScheduleWork()
+  // which set it, so DoWork() sees the work it scheduled, and later calls write
+  // again.
+  wakeup_pending_.exchange(false, std::memory_order_acq_rel);
+}
+
+void MessagePumpGlib::RecordWakeUp() {
+  ++wake_up_count_;
+  const TimeTicks now = TimeTicks::Now();
+  if (wake_ups_period_start_.is_null()) {
+    wake_ups_period_start_ = now;
+    wake_ups_period_start_count_ = wake_up_count_;
+    return;
+  }
+  const TimeDelta elapsed = now - wake_ups_period_start_;
+  if (elapsed < kWakeUpsPeriod)
+    return;
+  wake_ups_per_second_ =
+      (wake_up_count_ - wake_ups_period_start_count_) / elapsed.InSecondsF();
+  wake_ups_period_start_ = now;
+  wake_ups_period_start_count_ = wake_up_count_;
+}
+
 }  // namespace base
@@ -5,6 +5,9 @@
 #ifndef BASE_MESSAGE_LOOP_MESSAGE_PUMP_GLIB_H_
 #define BASE_MESSAGE_LOOP_MESSAGE_PUMP_GLIB_H_
 
+#include <stdint.h>
+
+#include <atomic>
 #include <memory>
 
 #include "base/base_export.h"
@@ -107,9 +110,28 @@ class BASE_EXPORT MessagePumpGlib : public MessagePump,
   bool HandleFdWatchCheck(FdWatchController* controller);
   void HandleFdWatchDispatch(FdWatchController* controller);
 
+  // Returns how many times Run() woke up after letting glib block, i.e. the
+  // idle wake-ups of the thread, whether for work or for native events.
+  uint64_t wake_up_count() const { return wake_up_count_; }
+
+  // Returns the rate of these wake-ups over the last complete period of a
+  // minute, or 0 before the first one ends.
+  double GetWakeUpsPerSecond() const { return wake_ups_per_second_; }
+
  private:
   bool ShouldQuit() const;
 
+  // Returns whether Run() should call DoWork() after an iteration of glib:
+  // if work was scheduled or is due. Other wake-ups are for native events.
+  bool ShouldDoWork() const;
+
+  // Consumes the wake-up written by ScheduleWork().
+  void ReadWakeUp();
+
+  // Counts a wake-up of Run(), and updates the wake-up rate at the end of each
+  // period.
+  void RecordWakeUp();
+
   // We may make recursive calls to Run, so we save state that needs to be
   // separate between them in this structure type.
   struct RunState;
@@ -126,15 +148,27 @@ class BASE_EXPORT MessagePumpGlib : public MessagePump,
   // the message pump is destroyed.
   GSource* work_source_;
 
-  // We use a wakeup pipe to make sure we'll get out of the glib polling phase
+  // We use a wakeup fd to make sure we'll get out of the glib polling phase
   // when another thread has scheduled us to do some work.  There is a glib
   // mechanism g_main_context_wakeup, but this won't guarantee that our event's
-  // Dispatch() will be called.
-  int wakeup_pipe_read_;
-  int wakeup_pipe_write_;
+  // Dispatch() will be called. This is an eventfd, read and written through
+  // the same descriptor, on Linux and ChromeOS, and a pipe elsewhere.
+  int wakeup_read_fd_;
+  int wakeup_write_fd_;
   // Use a unique_ptr to avoid needing the definition of GPollFD in the header.
   std::unique_ptr<GPollFD> wakeup_gpollfd_;
 
+  // Set by ScheduleWork() when it writes to the wakeup fd, and cleared once
+  // the pump reads it, so at most one wake-up is pending at a time.
+  std::atomic<bool> wakeup_pending_{false};
+
+  // The wake-ups of Run(), only accessed on its thread. See
+  // GetWakeUpsPerSecond().
+  uint64_t wake_up_count_ = 0;
+  TimeTicks wake_ups_period_start_;
+  uint64_t wake_ups_period_start_count_ = 0;
+  double wake_ups_per_second_ = 0;
+
   THREAD_CHECKER(watch_fd_caller_checker_);
 };
 
@@ -25,6 +25,7 @@
 #include "base/task/current_thread.h"
 #include "base/task/single_thread_task_executor.h"
 #include "base/task/single_thread_task_runner.h"
+#include "base/test/bind.h"
 #include "base/test/task_environment.h"
 #include "base/threading/thread.h"
 #include "base/threading/thread_task_runner_handle.h"
@@ -414,6 +415,25 @@ TEST_F(MessagePumpGLibTest, TestDrainingGLib) {
   EXPECT_EQ(3, injector()->processed_events());
 }
 
+TEST_F(MessagePumpGLibTest, TestNonNestableTaskAfterNestedLoopInEvent) {
+  // A nested loop run from an event, rather than from a task, consumes the
+  // wake-up of a non-nestable task which only the outer loop can run.
+  RunLoop run_loop;
+  bool task_ran = false;
+  injector()->AddEvent(0, BindLambdaForTesting([&] {
+                         ThreadTaskRunnerHandle::Get()->PostNonNestableTask(
+                             FROM_HERE, BindLambdaForTesting([&] {
+                               task_ran = true;
+                               run_loop.Quit();
+                             }));
+                         RunLoop(RunLoop::Type::kNestableTasksAllowed)
+                             .RunUntilIdle();
+                         EXPECT_FALSE(task_ran);
+                       }));
+  run_loop.Run();
+  EXPECT_TRUE(task_ran);
+}
+
 namespace {
 
 // Helper class that lets us run the GLib message loop.
@@ -539,6 +559,60 @@ TEST_F(MessagePumpGLibTest, TestGtkLoop) {
   run_loop.Run();
 }
 
+TEST(MessagePumpGLibWakeUpTest, CountsWakeUps) {
+  MessagePumpGlib* pump = new MessagePumpGlib();
+  SingleThreadTaskExecutor executor(WrapUnique(pump));
+  Thread thread("MessagePumpGLibWakeUpTestThread");
+  ASSERT_TRUE(thread.Start());
+
+  // The pump sleeps until the other thread posts the quit task.
+  RunLoop run_loop;
+  thread.task_runner()->PostDelayedTask(
+      FROM_HERE,
+      BindOnce(IgnoreResult(&SingleThreadTaskRunner::PostTask),
+               executor.task_runner(), FROM_HERE, run_loop.QuitClosure()),
+      Milliseconds(10));
+  run_loop.Run();
+
+  EXPECT_GE(pump->wake_up_count(), 1u);
+  // The rate is only known once a full period has passed.
+  EXPECT_EQ(0, pump->GetWakeUpsPerSecond());
+}
+
+TEST(MessagePumpGLibWakeUpTest, ScheduleWorkFromManyThreads) {
+  MessagePumpGlib* pump = new MessagePumpGlib();
+  SingleThreadTaskExecutor executor(WrapUnique(pump));
+  constexpr int kThreads = 4;
+  constexpr int kTasksPerThread = 1000;
+
+  // No wake-up is lost while ScheduleWork() skips the writes of pending
+  // wake-ups, and each wake-up runs at least one task.
+  RunLoop run_loop;
+  int tasks_run = 0;
+  RepeatingClosure task = BindLambdaForTesting([&] {
+    if (++tasks_run == kThreads * kTasksPerThread)
+      run_loop.Quit();
+  });
+  std::vector<std::unique_ptr<Thread>> threads;
+  for (int i = 0; i < kThreads; ++i) {
+    threads.push_back(
+        std::make_unique<Thread>("MessagePumpGLibWakeUpTestThread"));
+    ASSERT_TRUE(threads.back()->Start());
+    threads.back()->task_runner()->PostTask(
+        FROM_HERE, BindLambdaForTesting([&] {
+          for (int j = 0; j < kTasksPerThread; ++j)
+            executor.task_runner()->PostTask(FROM_HERE, task);
+        }));
+  }
+  run_loop.Run();
+
+  EXPECT_EQ(kThreads * kTasksPerThread, tasks_run);
+  EXPECT_LE(pump->wake_up_count(),
+            static_cast<uint64_t>(kThreads * kTasksPerThread));
+  for (std::unique_ptr<Thread>& thread : threads)
+    thread->Stop();
+}
+
 // Tests for WatchFileDescriptor API
 class MessagePumpGLibFdWatchTest : public testing::Test {
  protected:
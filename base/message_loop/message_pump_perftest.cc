@@ -6,6 +6,7 @@
 #include <stdint.h>
 
 #include <memory>
+#include <vector>
 
 #include "base/bind.h"
 #include "base/callback_helpers.h"
@@ -29,6 +30,19 @@
 #include "base/android/java_handler_thread.h"
 #endif
 
+#if BUILDFLAG(IS_POSIX) && !BUILDFLAG(IS_NACL)
+#include <sys/socket.h>
+#include <unistd.h>
+
+#include "base/files/scoped_file.h"
+#include "base/message_loop/message_pump_for_io.h"
+#include "base/posix/eintr_wrapper.h"
+#include "base/process/process_metrics.h"
+#include "base/run_loop.h"
+#include "base/task/single_thread_task_executor.h"
+#include "base/test/bind.h"
+#endif
+
 namespace base {
 namespace {
 
@@ -265,4 +279,112 @@ TEST_F(ScheduleWorkTest, ThreadTimeToJavaFromFourThreads) {
 }
 #endif
 
+#if BUILDFLAG(IS_POSIX) && !BUILDFLAG(IS_NACL)
+
+namespace {
+
+constexpr char kMetricPrefixFdWatch[] = "FdWatch.";
+constexpr char kMetricTimePerNotification[] = "time_per_notification";
+
+// Consumes the byte written to a socket when it becomes readable.
+class ReadWatcher : public MessagePumpForIO::FdWatcher {
+ public:
+  explicit ReadWatcher(RepeatingClosure on_read)
+      : on_read_(std::move(on_read)) {}
+
+  void OnFileCanReadWithoutBlocking(int fd) override {
+    char c;
+    EXPECT_EQ(1, HANDLE_EINTR(read(fd, &c, 1)));
+    on_read_.Run();
+  }
+
+  void OnFileCanWriteWithoutBlocking(int fd) override { NOTREACHED(); }
+
+ private:
+  RepeatingClosure on_read_;
+};
+
+}  // namespace
+
+class FdWatchTest : public testing::Test {
+ public:
+  // Watches |num_sockets| sockets on an IO thread and measures the time it
+  // takes, round after round, to be notified that |num_ready| of them are
+  // readable. This shows how the cost of a notification scales with the number
+  // of idle file descriptors watched.
+  void WatchSockets(size_t num_sockets, size_t num_ready) {
+    // Each socket pair takes two file descriptors.
+    IncreaseFdLimitTo(2 * num_sockets + 64);
+
+    SingleThreadTaskExecutor executor(MessagePumpType::IO);
+    std::vector<ScopedFD> sockets;
+    std::vector<ScopedFD> peers;
+    std::vector<std::unique_ptr<MessagePumpForIO::FdWatchController>>
+        controllers;
+    size_t num_pending_reads = 0;
+    RunLoop* run_loop = nullptr;
+    ReadWatcher watcher(BindLambdaForTesting([&]() {
+      if (--num_pending_reads == 0)
+        run_loop->Quit();
+    }));
+
+    for (size_t i = 0; i < num_sockets; ++i) {
+      int fds[2];
+      if (socketpair(AF_UNIX, SOCK_STREAM, 0, fds) != 0)
+        GTEST_SKIP() << "Not enough file descriptors";
+      sockets.emplace_back(fds[0]);
+      peers.emplace_back(fds[1]);
+      controllers.push_back(
+          std::make_unique<MessagePumpForIO::FdWatchController>(FROM_HERE));
+      ASSERT_TRUE(CurrentIOThread::Get()->WatchFileDescriptor(
+          fds[0], true, MessagePumpForIO::WATCH_READ, controllers.back().get(),
+          &watcher));
+    }
+
+    const TimeTicks start = TimeTicks::Now();
+    TimeTicks now;
+    uint64_t num_notifications = 0;
+    size_t next_peer = 0;
+    do {
+      for (size_t i = 0; i < num_ready; ++i) {
+        const char c = 0;
+        ASSERT_EQ(1, HANDLE_EINTR(write(peers[next_peer].get(), &c, 1)));
+        next_peer = (next_peer + 1) % num_sockets;
+      }
+      num_pending_reads = num_ready;
+      RunLoop round;
+      run_loop = &round;
+      round.Run();
+      num_notifications += num_ready;
+      now = TimeTicks::Now();
+    } while (now - start < Seconds(kTargetTimeSec));
+
+    perf_test::PerfResultReporter reporter(
+        kMetricPrefixFdWatch,
+        StringPrintf("io_pump_%" PRIuS "_ready_out_of_%" PRIuS "_fds",
+                     num_ready, num_sockets));
+    reporter.RegisterImportantMetric(kMetricTimePerNotification, "us");
+    reporter.AddResult(kMetricTimePerNotification,
+                       (now - start).InMicroseconds() /
+                           static_cast<double>(num_notifications));
+  }
+
+ private:
+  static const size_t kTargetTimeSec = 5;
+};
+
+TEST_F(FdWatchTest, OneReadyOutOf100) {
+  WatchSockets(100, 1);
+}
+
+TEST_F(FdWatchTest, OneReadyOutOf10000) {
+  WatchSockets(10000, 1);
+}
+
+TEST_F(FdWatchTest, HundredReadyOutOf10000) {
+  WatchSockets(10000, 100);
+}
+
+#endif  // BUILDFLAG(IS_POSIX) && !BUILDFLAG(IS_NACL)
+
 }  // namespace base
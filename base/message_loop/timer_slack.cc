@@ -9,6 +9,8 @@
 #include "base/check_op.h"
 #include "base/feature_list.h"
 #include "base/metrics/field_trial_params.h"
+#include "base/metrics/histogram_functions.h"
+#include "base/numerics/safe_conversions.h"
 
 namespace base {
 namespace features {
@@ -30,6 +32,16 @@ namespace {
 
 std::atomic<size_t> g_ludicrous_timer_suspend_count{0};
 
+// The period over which the rate of thread wake-ups is measured.
+constexpr base::TimeDelta kThreadWakeUpsPeriod = base::Minutes(1);
+
+// The start of the current measurement period, or null before the first
+// wake-up, and the number of wake-ups since.
+std::atomic<base::TimeTicks> g_thread_wake_ups_period_start{
+    base::TimeTicks()};
+std::atomic<uint64_t> g_thread_wake_ups_count{0};
+std::atomic<double> g_thread_wake_ups_per_second{0};
+
 }  // namespace
 
 bool IsLudicrousTimerSlackEnabled() {
@@ -53,4 +65,42 @@ bool IsLudicrousTimerSlackSuspended() {
   return g_ludicrous_timer_suspend_count.load() > 0u;
 }
 
-}  // namespace base
\ No newline at end of file
+void RecordThreadWakeUp(base::TimeTicks now) {
+  g_thread_wake_ups_count.fetch_add(1, std::memory_order_relaxed);
+  base::TimeTicks period_start =
+      g_thread_wake_ups_period_start.load(std::memory_order_relaxed);
+  if (period_start.is_null()) {
+    g_thread_wake_ups_period_start.compare_exchange_strong(
+        period_start, now, std::memory_order_relaxed);
+    return;
+  }
+  const base::TimeDelta elapsed = now - period_start;
+  if (elapsed < kThreadWakeUpsPeriod)
+    return;
+  // Only the thread which starts the next period reports this one. Wake-ups
+  // recorded concurrently may be counted in either period.
+  if (!g_thread_wake_ups_period_start.compare_exchange_strong(
+          period_start, now, std::memory_order_relaxed)) {
+    return;
+  }
+  const uint64_t count =
+      g_thread_wake_ups_count.exchange(0, std::memory_order_relaxed);
+  const double wake_ups_per_second = count / elapsed.InSecondsF();
+  g_thread_wake_ups_per_second.store(wake_ups_per_second,
+                                     std::memory_order_relaxed);
+  base::UmaHistogramCounts10000("Scheduler.ThreadWakeUpsPerSecond",
+                                base::ClampRound(wake_ups_per_second));
+}
+
+double GetThreadWakeUpsPerSecond() {
+  return g_thread_wake_ups_per_second.load(std::memory_order_relaxed);
+}
+
+void ResetThreadWakeUpsPerSecondForTesting() {
+  g_thread_wake_ups_period_start.store(base::TimeTicks(),
+                                       std::memory_order_relaxed);
+  g_thread_wake_ups_count.store(0, std::memory_order_relaxed);
+  g_thread_wake_ups_per_second.store(0, std::memory_order_relaxed);
+}
+
+}  // namespace base
@@ -41,6 +41,18 @@ BASE_EXPORT bool IsLudicrousTimerSlackSuspended();
 // Returns the slack for the experiment.
 BASE_EXPORT base::TimeDelta GetLudicrousTimerSlack();
 
+// Records a wake-up, at |now|, of a thread which waited for work in the
+// MessagePump of its SequenceManager. Once a minute, the process-wide rate of
+// these wake-ups is computed and reported to the
+// Scheduler.ThreadWakeUpsPerSecond histogram. Can be called on any thread.
+BASE_EXPORT void RecordThreadWakeUp(base::TimeTicks now);
+
+// Returns the process-wide rate of thread wake-ups measured by
+// RecordThreadWakeUp() over the last complete minute, or 0 if there is none.
+BASE_EXPORT double GetThreadWakeUpsPerSecond();
+
+BASE_EXPORT void ResetThreadWakeUpsPerSecondForTesting();
+
 namespace features {
 
 // Exposed for testing.
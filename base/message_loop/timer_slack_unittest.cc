@@ -10,6 +10,7 @@
 #include "base/message_loop/message_pump_kqueue.h"
 #include "base/message_loop/message_pump_mac.h"
 #endif  // BUILDFLAG(IS_MAC)
+#include "base/test/metrics/histogram_tester.h"
 #include "base/test/scoped_feature_list.h"
 #include "base/time/time.h"
 #include "build/build_config.h"
@@ -198,5 +199,29 @@ TEST(TimerSlackTest, LudicrousTimerSlackSlackSuspendResume) {
   EXPECT_FALSE(base::IsLudicrousTimerSlackSuspended());
 }
 
+TEST(TimerSlackTest, ThreadWakeUpsPerSecond) {
+  base::ResetThreadWakeUpsPerSecondForTesting();
+  base::HistogramTester histogram_tester;
+  const base::TimeTicks start = base::TimeTicks() + base::Seconds(1);
+
+  // Nothing is reported before a minute has elapsed.
+  for (int i = 0; i < 600; ++i)
+    base::RecordThreadWakeUp(start + base::Milliseconds(100 * i));
+  EXPECT_EQ(0, base::GetThreadWakeUpsPerSecond());
+  histogram_tester.ExpectTotalCount("Scheduler.ThreadWakeUpsPerSecond", 0);
+
+  base::RecordThreadWakeUp(start + base::Minutes(1));
+  EXPECT_DOUBLE_EQ(601.0 / 60, base::GetThreadWakeUpsPerSecond());
+  histogram_tester.ExpectUniqueSample("Scheduler.ThreadWakeUpsPerSecond", 10,
+                                      1);
+
+  // The next period starts with the wake-up which reported the previous one.
+  base::RecordThreadWakeUp(start + base::Minutes(2));
+  EXPECT_DOUBLE_EQ(1.0 / 60, base::GetThreadWakeUpsPerSecond());
+  histogram_tester.ExpectBucketCount("Scheduler.ThreadWakeUpsPerSecond", 0, 1);
+
+  base::ResetThreadWakeUpsPerSecondForTesting();
+}
+
 }  // namespace
 }  // namespace base
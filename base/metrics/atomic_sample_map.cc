@@ -0,0 +1,266 @@
+// Copyright 2022 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "base/metrics/atomic_sample_map.h"
+
+#include <algorithm>
+
+#include "base/check_op.h"
+#include "base/memory/ptr_util.h"
+#include "base/numerics/safe_conversions.h"
+
+namespace base {
+
+typedef HistogramBase::AtomicCount AtomicCount;
+typedef HistogramBase::Count Count;
+typedef HistogramBase::Sample Sample;
+
+namespace internal {
+
+namespace {
+
+// The first table has 8 slots, and each next one 8 times more, so that a
+// thousand samples are in the first four.
+constexpr size_t kFirstCapacityBits = 3;
+constexpr size_t kCapacityBitsIncrement = 3;
+
+// Set in the keys of the used slots, so that sample 0 isn't a free slot.
+constexpr uint64_t kUsedKey = uint64_t{1} << 32;
+
+uint64_t KeyOf(Sample value) {
+  return kUsedKey | static_cast<uint32_t>(value);
+}
+
+}  // namespace
+
+SampleCountTable::SampleCountTable(bool external_counts)
+    : SampleCountTable(external_counts, kFirstCapacityBits) {}
+
+SampleCountTable::SampleCountTable(bool external_counts, size_t capacity_bits)
+    : external_counts_(external_counts),
+      capacity_bits_(capacity_bits),
+      capacity_(size_t{1} << capacity_bits),
+      slots_(new Slot[capacity_]) {}
+
+SampleCountTable::~SampleCountTable() {
+  delete next_.load(std::memory_order_acquire);
+}
+
+AtomicCount* SampleCountTable::Find(Sample value) const {
+  const uint64_t key = KeyOf(value);
+  for (const SampleCountTable* table = this; table;
+       table = table->next_.load(std::memory_order_acquire)) {
+    Slot* slot = table->Probe(key);
+    if (slot->key.load(std::memory_order_acquire) == key) {
+      return table->external_counts_
+                 ? slot->external_count.load(std::memory_order_acquire)
+                 : &slot->count;
+    }
+  }
+  return nullptr;
+}
+
+AtomicCount* SampleCountTable::Insert(Sample value,
+                                      AtomicCount* external_count) {
+  DCHECK_EQ(external_counts_, !!external_count);
+  const uint64_t key = KeyOf(value);
+  for (SampleCountTable* table = this;; table = table->GetOrCreateNext()) {
+    const size_t mask = table->capacity_ - 1;
+    size_t i = table->Probe(key) - table->slots_.get();
+    bool reserved = false;
+    while (true) {
+      Slot& slot = table->slots_[i];
+      uint64_t slot_key = slot.key.load(std::memory_order_acquire);
+      if (slot_key == 0) {
+        // Take a share of the table before the slot, so that at least half
+        // its slots stay free and probing ends.
+        if (!reserved) {
+          const size_t half = table->capacity_ / 2;
+          if (table->used_.load(std::memory_order_relaxed) >= half ||
+              table->used_.fetch_add(1, std::memory_order_relaxed) >= half) {
+            break;
+          }
+          reserved = true;
+        }
+        if (slot.key.compare_exchange_strong(slot_key, key,
+                                             std::memory_order_acq_rel)) {
+          if (!table->external_counts_)
+            return &slot.count;
+          slot.external_count.store(external_count, std::memory_order_release);
+          return external_count;
+        }
+        // |slot_key| is now that of the sample inserted concurrently.
+      }
+      if (slot_key == key) {
+        return table->external_counts_
+                   ? slot.external_count.load(std::memory_order_acquire)
+                   : &slot.count;
+      }
+      i = (i + 1) & mask;
+    }
+  }
+}
+
+Count SampleCountTable::Sum(Sample value) const {
+  const uint64_t key = KeyOf(value);
+  Count sum = 0;
+  for (const SampleCountTable* table = this; table;
+       table = table->next_.load(std::memory_order_acquire)) {
+    const Slot* slot = table->Probe(key);
+    if (slot->key.load(std::memory_order_acquire) != key)
+      continue;
+    const AtomicCount* count = table->CountAt(slot - table->slots_.get());
+    if (count)
+      sum += subtle::NoBarrier_Load(const_cast<AtomicCount*>(count));
+  }
+  return sum;
+}
+
+std::vector<std::pair<Sample, Count>> SampleCountTable::GetSortedCounts()
+    const {
+  std::vector<std::pair<Sample, Count>> counts;
+  ForEach([&counts](Sample value, Count count) {
+    counts.emplace_back(value, count);
+  });
+  std::sort(counts.begin(), counts.end());
+
+  // Sum the counts of the samples inserted in several tables, and leave out
+  // those which are zero.
+  auto end = counts.begin();
+  for (auto it = counts.begin(); it != counts.end(); ++it) {
+    if (end != counts.begin() && (end - 1)->first == it->first)
+      (end - 1)->second += it->second;
+    else
+      *end++ = *it;
+  }
+  counts.erase(std::remove_if(counts.begin(), end,
+                              [](const std::pair<Sample, Count>& entry) {
+                                return entry.second == 0;
+                              }),
+               counts.end());
+  return counts;
+}
+
+const AtomicCount* SampleCountTable::CountAt(size_t i) const {
+  const Slot& slot = slots_[i];
+  if (slot.key.load(std::memory_order_acquire) == 0)
+    return nullptr;
+  return external_counts_
+             ? slot.external_count.load(std::memory_order_acquire)
+             : &slot.count;
+}
+
+Sample SampleCountTable::SampleAt(size_t i) const {
+  return static_cast<Sample>(static_cast<uint32_t>(
+      slots_[i].key.load(std::memory_order_relaxed)));
+}
+
+SampleCountTable::Slot* SampleCountTable::Probe(uint64_t key) const {
+  // Fibonacci hashing, which spreads consecutive samples.
+  const size_t mask = capacity_ - 1;
+  size_t i = static_cast<size_t>(
+      (static_cast<uint32_t>(key) * uint64_t{0x9E3779B97F4A7C15}) >>
+      (64 - capacity_bits_));
+  while (true) {
+    const uint64_t slot_key = slots_[i].key.load(std::memory_order_acquire);
+    if (slot_key == key || slot_key == 0)
+      return &slots_[i];
+    i = (i + 1) & mask;
+  }
+}
+
+SampleCountTable* SampleCountTable::GetOrCreateNext() {
+  SampleCountTable* next = next_.load(std::memory_order_acquire);
+  if (next)
+    return next;
+  auto table = WrapUnique(new SampleCountTable(
+      external_counts_, capacity_bits_ + kCapacityBitsIncrement));
+  if (next_.compare_exchange_strong(next, table.get(),
+                                    std::memory_order_acq_rel)) {
+    return table.release();
+  }
+  // Another thread created it first.
+  return next;
+}
+
+}  // namespace internal
+
+AtomicSampleMap::AtomicSampleMap() : AtomicSampleMap(0) {}
+
+AtomicSampleMap::AtomicSampleMap(uint64_t id)
+    : HistogramSamples(id, new LocalMetadata()) {}
+
+AtomicSampleMap::~AtomicSampleMap() {
+  delete static_cast<LocalMetadata*>(meta());
+}
+
+void AtomicSampleMap::Accumulate(Sample value, Count count) {
+  AtomicCount* count_pointer = sample_counts_.Find(value);
+  if (!count_pointer)
+    count_pointer = sample_counts_.Insert(value, nullptr);
+  subtle::NoBarrier_AtomicIncrement(count_pointer, count);
+  IncreaseSumAndCount(strict_cast<int64_t>(count) * value, count);
+}
+
+Count AtomicSampleMap::GetCount(Sample value) const {
+  return sample_counts_.Sum(value);
+}
+
+Count AtomicSampleMap::TotalCount() const {
+  Count count = 0;
+  sample_counts_.ForEach(
+      [&count](Sample value, Count sample_count) { count += sample_count; });
+  return count;
+}
+
+std::unique_ptr<SampleCountIterator> AtomicSampleMap::Iterator() const {
+  return std::make_unique<SortedSampleCountIterator>(
+      sample_counts_.GetSortedCounts());
+}
+
+bool AtomicSampleMap::AddSubtractImpl(SampleCountIterator* iter, Operator op) {
+  Sample min;
+  int64_t max;
+  Count count;
+  for (; !iter->Done(); iter->Next()) {
+    iter->Get(&min, &max, &count);
+    if (count == 0)
+      continue;
+    if (strict_cast<int64_t>(min) + 1 != max)
+      return false;  // SparseHistogram only supports bucket with size 1.
+    subtle::NoBarrier_AtomicIncrement(sample_counts_.Insert(min, nullptr),
+                                      (op == HistogramSamples::ADD) ? count
+                                                                    : -count);
+  }
+  return true;
+}
+
+SortedSampleCountIterator::SortedSampleCountIterator(
+    std::vector<std::pair<Sample, Count>> sample_counts)
+    : sample_counts_(std::move(sample_counts)) {}
+
+SortedSampleCountIterator::~SortedSampleCountIterator() = default;
+
+bool SortedSampleCountIterator::Done() const {
+  return index_ == sample_counts_.size();
+}
+
+void SortedSampleCountIterator::Next() {
+  DCHECK(!Done());
+  ++index_;
+}
+
+void SortedSampleCountIterator::Get(Sample* min,
+                                    int64_t* max,
+                                    Count* count) const {
+  DCHECK(!Done());
+  if (min)
+    *min = sample_counts_[index_].first;
+  if (max)
+    *max = strict_cast<int64_t>(sample_counts_[index_].first) + 1;
+  if (count)
+    *count = sample_counts_[index_].second;
+}
+
+}  // namespace base
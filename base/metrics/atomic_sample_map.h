@@ -0,0 +1,174 @@
+// Copyright 2022 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+// AtomicSampleMap implements HistogramSamples interface. It is used by the
+// SparseHistogram class to record samples from any thread without a lock.
+
+#ifndef BASE_METRICS_ATOMIC_SAMPLE_MAP_H_
+#define BASE_METRICS_ATOMIC_SAMPLE_MAP_H_
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include <atomic>
+#include <memory>
+#include <utility>
+#include <vector>
+
+#include "base/base_export.h"
+#include "base/metrics/histogram_base.h"
+#include "base/metrics/histogram_samples.h"
+
+namespace base {
+
+namespace internal {
+
+// An open-addressing hash table of sample counts, whose samples are inserted
+// with a compare-and-swap and never removed. It starts small and, rather than
+// being rehashed, grows by chaining tables of increasing size: a table takes
+// up to half its slots, then samples go to the next one. Finding or inserting
+// a sample is lock-free.
+//
+// The counts are either held in the slots or, with |external_counts|, held
+// elsewhere and published with the sample by Insert(). Inserting external
+// counts must be serialized by the caller, but finding them needn't be.
+class BASE_EXPORT SampleCountTable {
+ public:
+  explicit SampleCountTable(bool external_counts);
+
+  SampleCountTable(const SampleCountTable&) = delete;
+  SampleCountTable& operator=(const SampleCountTable&) = delete;
+
+  ~SampleCountTable();
+
+  // Returns the count of |value|, or null if it doesn't have one yet. With
+  // concurrent inserts of the same sample, the slot counts may end up in
+  // several tables: Find() returns either, and the others are only seen by
+  // Sum() and ForEach().
+  HistogramBase::AtomicCount* Find(HistogramBase::Sample value) const;
+
+  // Returns the count of |value|, inserting it if need be. |external_count|
+  // must be given with |external_counts|, and is ignored without it.
+  HistogramBase::AtomicCount* Insert(
+      HistogramBase::Sample value,
+      HistogramBase::AtomicCount* external_count);
+
+  // Returns the sum of the counts of |value| in all the tables.
+  HistogramBase::Count Sum(HistogramBase::Sample value) const;
+
+  // Calls |function| with each sample and its count, in no particular order.
+  // A sample may be given more than once.
+  template <typename Function>
+  void ForEach(const Function& function) const {
+    for (const SampleCountTable* table = this; table;
+         table = table->next_.load(std::memory_order_acquire)) {
+      for (size_t i = 0; i < table->capacity_; ++i) {
+        const HistogramBase::AtomicCount* count = table->CountAt(i);
+        if (count) {
+          function(table->SampleAt(i),
+                   subtle::NoBarrier_Load(
+                       const_cast<HistogramBase::AtomicCount*>(count)));
+        }
+      }
+    }
+  }
+
+  // Returns the samples with a non-zero count, sorted and with a single count
+  // each.
+  std::vector<std::pair<HistogramBase::Sample, HistogramBase::Count>>
+  GetSortedCounts() const;
+
+ private:
+  struct Slot {
+    // The sample in the low 32 bits and |kUsedKey| above, or 0 while free.
+    std::atomic<uint64_t> key{0};
+    // The count with |external_counts_|, set once |key| is.
+    std::atomic<HistogramBase::AtomicCount*> external_count{nullptr};
+    // The count without |external_counts_|.
+    HistogramBase::AtomicCount count = 0;
+  };
+
+  SampleCountTable(bool external_counts, size_t capacity_bits);
+
+  // Returns the count of the used slot |i|, or null if |i| is free or its
+  // external count isn't published yet.
+  const HistogramBase::AtomicCount* CountAt(size_t i) const;
+  HistogramBase::Sample SampleAt(size_t i) const;
+
+  // Returns the slot of |key| in this table, the free slot to insert it in,
+  // or null if the table is full.
+  Slot* Probe(uint64_t key) const;
+
+  // Returns the next table, creating it if need be.
+  SampleCountTable* GetOrCreateNext();
+
+  const bool external_counts_;
+  const size_t capacity_bits_;
+  const size_t capacity_;
+  const std::unique_ptr<Slot[]> slots_;
+
+  // The number of slots taken or being taken, up to half the capacity.
+  std::atomic<size_t> used_{0};
+
+  // The next, larger table, owned by this one.
+  std::atomic<SampleCountTable*> next_{nullptr};
+};
+
+}  // namespace internal
+
+// The counts of the samples are updated with atomic operations, and new
+// samples are inserted lock-free, so that Accumulate() can be called on any
+// thread without synchronization. Unlike SampleMap, when it's read while
+// samples are accumulated, its counts may not add up to its sum or to its
+// redundant count, as is the case for SampleVector.
+class BASE_EXPORT AtomicSampleMap : public HistogramSamples {
+ public:
+  AtomicSampleMap();
+  explicit AtomicSampleMap(uint64_t id);
+
+  AtomicSampleMap(const AtomicSampleMap&) = delete;
+  AtomicSampleMap& operator=(const AtomicSampleMap&) = delete;
+
+  ~AtomicSampleMap() override;
+
+  // HistogramSamples:
+  void Accumulate(HistogramBase::Sample value,
+                  HistogramBase::Count count) override;
+  HistogramBase::Count GetCount(HistogramBase::Sample value) const override;
+  HistogramBase::Count TotalCount() const override;
+  std::unique_ptr<SampleCountIterator> Iterator() const override;
+
+ protected:
+  // Performs arithemetic. |op| is ADD or SUBTRACT.
+  bool AddSubtractImpl(SampleCountIterator* iter, Operator op) override;
+
+ private:
+  internal::SampleCountTable sample_counts_{/*external_counts=*/false};
+};
+
+// Iterates over the counts of GetSortedCounts(), in the order of the samples,
+// like the iterators of SampleMap and PersistentSampleMap.
+class BASE_EXPORT SortedSampleCountIterator : public SampleCountIterator {
+ public:
+  explicit SortedSampleCountIterator(
+      std::vector<std::pair<HistogramBase::Sample, HistogramBase::Count>>
+          sample_counts);
+  ~SortedSampleCountIterator() override;
+
+  // SampleCountIterator:
+  bool Done() const override;
+  void Next() override;
+  void Get(HistogramBase::Sample* min,
+           int64_t* max,
+           HistogramBase::Count* count) const override;
+
+ private:
+  const std::vector<std::pair<HistogramBase::Sample, HistogramBase::Count>>
+      sample_counts_;
+  size_t index_ = 0;
+};
+
+}  // namespace base
+
+#endif  // BASE_METRICS_ATOMIC_SAMPLE_MAP_H_
@@ -0,0 +1,180 @@
+// Copyright 2022 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "base/metrics/atomic_sample_map.h"
+
+#include <limits>
+#include <memory>
+#include <vector>
+
+#include "base/memory/raw_ptr.h"
+#include "base/metrics/sample_map.h"
+#include "base/threading/simple_thread.h"
+#include "testing/gtest/include/gtest/gtest.h"
+
+namespace base {
+namespace {
+
+// Accumulates 1 in each sample of [0, |sample_count|), |rounds| times.
+class AccumulateThread : public SimpleThread {
+ public:
+  AccumulateThread(HistogramSamples* samples, int sample_count, int rounds)
+      : SimpleThread("AccumulateThread"),
+        samples_(samples),
+        sample_count_(sample_count),
+        rounds_(rounds) {}
+
+  void Run() override {
+    for (int round = 0; round < rounds_; ++round) {
+      for (int i = 0; i < sample_count_; ++i)
+        samples_->Accumulate(i, 1);
+    }
+  }
+
+ private:
+  const raw_ptr<HistogramSamples> samples_;
+  const int sample_count_;
+  const int rounds_;
+};
+
+TEST(AtomicSampleMapTest, AccumulateTest) {
+  AtomicSampleMap samples(1);
+
+  samples.Accumulate(1, 100);
+  samples.Accumulate(2, 200);
+  samples.Accumulate(1, -200);
+  EXPECT_EQ(-100, samples.GetCount(1));
+  EXPECT_EQ(200, samples.GetCount(2));
+  EXPECT_EQ(0, samples.GetCount(3));
+
+  EXPECT_EQ(300, samples.sum());
+  EXPECT_EQ(100, samples.TotalCount());
+  EXPECT_EQ(samples.redundant_count(), samples.TotalCount());
+}
+
+TEST(AtomicSampleMapTest, ManySamples) {
+  AtomicSampleMap samples(1);
+
+  // Enough samples to chain several tables, including those which would be
+  // free keys without their high bit.
+  std::vector<HistogramBase::Sample> values = {
+      0, -1, std::numeric_limits<HistogramBase::Sample>::min(),
+      std::numeric_limits<HistogramBase::Sample>::max()};
+  for (int i = 1; i <= 5000; ++i)
+    values.push_back(i * 7919);
+  for (HistogramBase::Sample value : values)
+    samples.Accumulate(value, 2);
+  for (HistogramBase::Sample value : values)
+    samples.Accumulate(value, 1);
+
+  for (HistogramBase::Sample value : values)
+    EXPECT_EQ(3, samples.GetCount(value)) << value;
+  EXPECT_EQ(static_cast<int>(3 * values.size()), samples.TotalCount());
+  EXPECT_EQ(samples.redundant_count(), samples.TotalCount());
+}
+
+TEST(AtomicSampleMapTest, AddSubtractTest) {
+  AtomicSampleMap samples1(1);
+  SampleMap samples2(2);
+
+  samples1.Accumulate(1, 100);
+  samples1.Accumulate(2, 100);
+  samples1.Accumulate(3, 100);
+
+  samples2.Accumulate(1, 200);
+  samples2.Accumulate(2, 200);
+  samples2.Accumulate(4, 200);
+
+  samples1.Add(samples2);
+  EXPECT_EQ(300, samples1.GetCount(1));
+  EXPECT_EQ(300, samples1.GetCount(2));
+  EXPECT_EQ(100, samples1.GetCount(3));
+  EXPECT_EQ(200, samples1.GetCount(4));
+  EXPECT_EQ(2000, samples1.sum());
+  EXPECT_EQ(900, samples1.TotalCount());
+  EXPECT_EQ(samples1.redundant_count(), samples1.TotalCount());
+
+  samples1.Subtract(samples2);
+  EXPECT_EQ(100, samples1.GetCount(1));
+  EXPECT_EQ(100, samples1.GetCount(2));
+  EXPECT_EQ(100, samples1.GetCount(3));
+  EXPECT_EQ(0, samples1.GetCount(4));
+  EXPECT_EQ(600, samples1.sum());
+  EXPECT_EQ(300, samples1.TotalCount());
+  EXPECT_EQ(samples1.redundant_count(), samples1.TotalCount());
+}
+
+TEST(AtomicSampleMapTest, ConcurrentAccumulate) {
+  constexpr int kThreadCount = 4;
+  constexpr int kSampleCount = 1000;
+  constexpr int kRounds = 20;
+  AtomicSampleMap samples(1);
+
+  std::vector<std::unique_ptr<AccumulateThread>> threads;
+  for (int i = 0; i < kThreadCount; ++i) {
+    threads.push_back(
+        std::make_unique<AccumulateThread>(&samples, kSampleCount, kRounds));
+    threads.back()->Start();
+  }
+  for (const std::unique_ptr<AccumulateThread>& thread : threads)
+    thread->Join();
+
+  for (int i = 0; i < kSampleCount; ++i)
+    EXPECT_EQ(kThreadCount * kRounds, samples.GetCount(i)) << i;
+  EXPECT_EQ(kThreadCount * kRounds * kSampleCount, samples.TotalCount());
+  EXPECT_EQ(samples.redundant_count(), samples.TotalCount());
+
+  // Each sample is iterated once.
+  int count = 0;
+  for (std::unique_ptr<SampleCountIterator> it = samples.Iterator();
+       !it->Done(); it->Next()) {
+    HistogramBase::Sample min;
+    int64_t max;
+    HistogramBase::Count sample_count;
+    it->Get(&min, &max, &sample_count);
+    EXPECT_EQ(count, min);
+    EXPECT_EQ(kThreadCount * kRounds, sample_count);
+    ++count;
+  }
+  EXPECT_EQ(kSampleCount, count);
+}
+
+TEST(AtomicSampleMapIteratorTest, IterateTest) {
+  AtomicSampleMap samples(1);
+  samples.Accumulate(5, 0);
+  samples.Accumulate(4, -300);
+  samples.Accumulate(2, 200);
+  samples.Accumulate(1, 100);
+
+  // The samples are sorted, and those without a count are skipped.
+  std::unique_ptr<SampleCountIterator> it = samples.Iterator();
+
+  HistogramBase::Sample min;
+  int64_t max;
+  HistogramBase::Count count;
+
+  it->Get(&min, &max, &count);
+  EXPECT_EQ(1, min);
+  EXPECT_EQ(2, max);
+  EXPECT_EQ(100, count);
+  EXPECT_FALSE(it->GetBucketIndex(nullptr));
+
+  it->Next();
+  it->Get(&min, &max, &count);
+  EXPECT_EQ(2, min);
+  EXPECT_EQ(3, max);
+  EXPECT_EQ(200, count);
+
+  it->Next();
+  it->Get(&min, &max, &count);
+  EXPECT_EQ(4, min);
+  EXPECT_EQ(5, max);
+  EXPECT_EQ(-300, count);
+
+  it->Next();
+  EXPECT_TRUE(it->Done());
+}
+
+}  // namespace
+}  // namespace base
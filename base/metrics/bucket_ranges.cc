@@ -4,12 +4,47 @@
 
 #include "base/metrics/bucket_ranges.h"
 
+#include <algorithm>
 #include <cmath>
+#include <limits>
 
+#include "base/bits.h"
+#include "base/check_op.h"
 #include "base/metrics/crc32.h"
 
 namespace base {
 
+namespace {
+
+// The keys of the values in the log table: the values of a key share their
+// bit length and the 2 bits after the leading one, so that an exponential
+// histogram has about two buckets per key. The keys increase with the values.
+constexpr size_t kLogKeySubBits = 2;
+
+size_t LogKey(uint32_t value) {
+  constexpr uint32_t kSubKeys = 1 << kLogKeySubBits;
+  if (value < kSubKeys)
+    return value;
+  const uint32_t bits = 32 - bits::CountLeadingZeroBits(value);
+  return (bits - 1) * kSubKeys +
+         ((value >> (bits - 1 - kLogKeySubBits)) & (kSubKeys - 1));
+}
+
+// The smallest value whose key is at least |key|.
+uint32_t MinValueOfLogKey(size_t key) {
+  constexpr uint32_t kSubKeys = 1 << kLogKeySubBits;
+  if (key < 2 * kSubKeys)
+    return std::min<uint32_t>(key, kSubKeys);
+  const size_t bits = key / kSubKeys + 1;
+  return (kSubKeys | (key % kSubKeys)) << (bits - 1 - kLogKeySubBits);
+}
+
+// The buckets that kLog scans if it has no more to search, rather than a
+// binary search.
+constexpr size_t kMaxLogScan = 4;
+
+}  // namespace
+
 BucketRanges::BucketRanges(size_t num_ranges)
     : ranges_(num_ranges, 0),
       checksum_(0) {}
@@ -35,6 +70,109 @@ bool BucketRanges::HasValidChecksum() const {
 
 void BucketRanges::ResetChecksum() {
   checksum_ = CalculateChecksum();
+  ComputeLayout();
+}
+
+size_t BucketRanges::GetBucketIndex(HistogramBase::Sample value) const {
+  const size_t bucket_count = this->bucket_count();
+  DCHECK_GE(value, ranges_[0]);
+  DCHECK_LT(value, ranges_[bucket_count]);
+  if (bucket_count == 1 || value < ranges_[1])
+    return 0;
+  if (value >= ranges_[bucket_count - 1])
+    return bucket_count - 1;
+
+  // The buckets in which to search: |value| is at least range(under) and less
+  // than range(over).
+  size_t under = 1;
+  size_t over = bucket_count - 1;
+  switch (layout_) {
+    case Layout::kLinear: {
+      size_t index =
+          1 + static_cast<size_t>(static_cast<uint64_t>(value - ranges_[1]) *
+                                      linear_scale_ >>
+                                  32);
+      if (ranges_[index] > value)
+        --index;
+      else if (ranges_[index + 1] <= value)
+        ++index;
+      return index;
+    }
+    case Layout::kLog: {
+      const size_t key = LogKey(static_cast<uint32_t>(value));
+      under = log_table_[key];
+      if (key + 1 < log_table_.size())
+        over = log_table_[key + 1] + size_t{1};
+      if (over - under <= kMaxLogScan) {
+        while (ranges_[under + 1] <= value)
+          ++under;
+        return under;
+      }
+      break;
+    }
+    case Layout::kUnknown:
+      break;
+  }
+
+  // The last range of [under, over) that is at most |value|.
+  return static_cast<size_t>(std::upper_bound(ranges_.begin() + under,
+                                              ranges_.begin() + over, value) -
+                             ranges_.begin()) -
+         1;
+}
+
+void BucketRanges::ComputeLayout() {
+  layout_ = Layout::kUnknown;
+  linear_scale_ = 0;
+  log_table_.clear();
+  const size_t bucket_count = this->bucket_count();
+  if (ranges_.empty() || bucket_count < 3)
+    return;
+  for (size_t i = 1; i < ranges_.size(); ++i) {
+    if (ranges_[i] <= ranges_[i - 1])
+      return;
+  }
+
+  // Evenly spaced ranges, e.g. those of a LinearHistogram, if rounding makes
+  // the estimate of the index off by at most one for the first and the last
+  // value of each bucket, and so for all the values.
+  const HistogramBase::Sample min = ranges_[1];
+  const HistogramBase::Sample max = ranges_[bucket_count - 1];
+  linear_scale_ = (static_cast<uint64_t>(bucket_count - 2) << 32) /
+                  static_cast<uint64_t>(max - min);
+  auto estimate = [this, min](HistogramBase::Sample value) {
+    return 1 + static_cast<size_t>(static_cast<uint64_t>(value - min) *
+                                       linear_scale_ >>
+                                   32);
+  };
+  bool linear = true;
+  for (size_t i = 1; i < bucket_count - 1 && linear; ++i) {
+    for (HistogramBase::Sample value : {ranges_[i], ranges_[i + 1] - 1}) {
+      const size_t index = estimate(value);
+      if (index + 1 < i || index > i + 1)
+        linear = false;
+    }
+  }
+  if (linear) {
+    layout_ = Layout::kLinear;
+    return;
+  }
+  linear_scale_ = 0;
+
+  if (bucket_count > std::numeric_limits<uint16_t>::max())
+    return;
+  const size_t keys = LogKey(static_cast<uint32_t>(max)) + 1;
+  log_table_.resize(keys);
+  size_t index = 0;
+  for (size_t key = 0; key < keys; ++key) {
+    const uint32_t value = MinValueOfLogKey(key);
+    while (index + 1 < bucket_count &&
+           static_cast<uint32_t>(ranges_[index + 1]) <= value) {
+      ++index;
+    }
+    log_table_[key] = static_cast<uint16_t>(index);
+  }
+  layout_ = Layout::kLog;
 }
 
 bool BucketRanges::Equals(const BucketRanges* other) const {
@@ -46,6 +46,7 @@ class BASE_EXPORT BucketRanges {
     DCHECK_LT(i, ranges_.size());
     DCHECK_GE(value, 0);
     ranges_[i] = value;
+    layout_ = Layout::kUnknown;
   }
   uint32_t checksum() const { return checksum_; }
   void set_checksum(uint32_t checksum) { checksum_ = checksum; }
@@ -56,6 +57,13 @@ class BASE_EXPORT BucketRanges {
   // [0, 1), [1, 3), [3, 7), and [7, INT_MAX).
   size_t bucket_count() const { return ranges_.size() - 1; }
 
+  // Returns the index of the bucket that |value| is tallied in, which must be
+  // at least range(0) and less than range(bucket_count()). Once the ranges are
+  // set, ResetChecksum() precomputes how to find it without a binary search:
+  // directly for evenly spaced ranges, from a table indexed by the top bits of
+  // |value| for the others, e.g. exponential ones.
+  size_t GetBucketIndex(HistogramBase::Sample value) const;
+
   // Checksum methods to verify whether the ranges are corrupted (e.g. bad
   // memory access).
   uint32_t CalculateChecksum() const;
@@ -77,11 +85,35 @@ class BASE_EXPORT BucketRanges {
   }
 
  private:
+  // How GetBucketIndex() finds the bucket of a value within range(1) and
+  // range(bucket_count() - 1), the others being in the first or last bucket.
+  enum class Layout : uint8_t {
+    // Binary search.
+    kUnknown,
+    // Computes the index from |linear_scale_| and corrects it by at most one.
+    kLinear,
+    // Searches from the bucket that |log_table_| gives for the top bits of the
+    // value, up to the one it gives for the next ones.
+    kLog,
+  };
+
+  // Sets |layout_| and the data it uses.
+  void ComputeLayout();
+
   // A monotonically increasing list of values which determine which bucket to
   // put a sample into.  For each index, show the smallest sample that can be
   // added to the corresponding bucket.
   Ranges ranges_;
 
+  Layout layout_ = Layout::kUnknown;
+
+  // For kLinear: the number of buckets per unit between range(1) and
+  // range(bucket_count() - 1), in 32.32 fixed point.
+  uint64_t linear_scale_ = 0;
+
+  // For kLog: the bucket of the smallest value of each key of LogKey().
+  std::vector<uint16_t> log_table_;
+
   // Checksum for the conntents of ranges_.  Used to detect random over-writes
   // of our data, and to quickly see if some other BucketRanges instance is
   // possibly Equal() to this instance.
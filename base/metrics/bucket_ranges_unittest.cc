@@ -4,8 +4,14 @@
 
 #include "base/metrics/bucket_ranges.h"
 
+#include <stddef.h>
 #include <stdint.h>
 
+#include <iterator>
+#include <tuple>
+#include <vector>
+
+#include "base/metrics/histogram.h"
 #include "testing/gtest/include/gtest/gtest.h"
 
 namespace base {
@@ -74,5 +80,72 @@ TEST(BucketRangesTest, Checksum) {
   EXPECT_TRUE(ranges.HasValidChecksum());
 }
 
+// Checks GetBucketIndex() for the values around each range of |ranges|, and a
+// few between, against a linear search.
+void ExpectBucketIndices(const BucketRanges& ranges) {
+  std::vector<HistogramBase::Sample> values;
+  for (size_t i = 0; i < ranges.size(); ++i) {
+    // In 64 bits, as the last range is kSampleType_MAX.
+    const int64_t range = ranges.range(i);
+    for (int64_t value : {range - 1, range, range + 1, range + range / 3}) {
+      if (value >= ranges.range(0) &&
+          value < ranges.range(ranges.bucket_count())) {
+        values.push_back(static_cast<HistogramBase::Sample>(value));
+      }
+    }
+  }
+  for (HistogramBase::Sample value : values) {
+    size_t expected = 0;
+    while (ranges.range(expected + 1) <= value)
+      ++expected;
+    EXPECT_EQ(expected, ranges.GetBucketIndex(value)) << "value " << value;
+  }
+}
+
+TEST(BucketRangesTest, GetBucketIndex) {
+  // Exponential.
+  for (auto [minimum, maximum, bucket_count] :
+       {std::make_tuple(1, 64, 8), std::make_tuple(1, 10000, 50),
+        std::make_tuple(1, 1000000, 100), std::make_tuple(10, 1000, 30),
+        std::make_tuple(1, HistogramBase::kSampleType_MAX - 1, 200)}) {
+    BucketRanges ranges(bucket_count + 1);
+    Histogram::InitializeBucketRanges(minimum, maximum, &ranges);
+    ExpectBucketIndices(ranges);
+  }
+
+  // Linear, and exactly linear.
+  for (auto [minimum, maximum, bucket_count] :
+       {std::make_tuple(1, 7, 8), std::make_tuple(1, 100, 101),
+        std::make_tuple(1, 1000, 37), std::make_tuple(50, 60, 5),
+        std::make_tuple(1, 1000000, 1000)}) {
+    BucketRanges ranges(bucket_count + 1);
+    LinearHistogram::InitializeBucketRanges(minimum, maximum, &ranges);
+    ExpectBucketIndices(ranges);
+  }
+
+  // Custom.
+  const HistogramBase::Sample kCustomRanges[] = {
+      0, 1, 2, 3, 100, 101, 102, 5000, 5001, 5002, 5003, 5004, 5005, 5006,
+      5007, 1 << 20, HistogramBase::kSampleType_MAX};
+  BucketRanges ranges(std::size(kCustomRanges));
+  for (size_t i = 0; i < std::size(kCustomRanges); ++i)
+    ranges.set_range(i, kCustomRanges[i]);
+  ExpectBucketIndices(ranges);
+  ranges.ResetChecksum();
+  ExpectBucketIndices(ranges);
+
+  // A single bucket, and two.
+  BucketRanges one_bucket(2);
+  one_bucket.set_range(1, HistogramBase::kSampleType_MAX);
+  one_bucket.ResetChecksum();
+  EXPECT_EQ(0u, one_bucket.GetBucketIndex(0));
+  EXPECT_EQ(0u, one_bucket.GetBucketIndex(12345));
+  BucketRanges two_buckets(3);
+  two_buckets.set_range(1, 10);
+  two_buckets.set_range(2, HistogramBase::kSampleType_MAX);
+  two_buckets.ResetChecksum();
+  ExpectBucketIndices(two_buckets);
+}
+
 }  // namespace
 }  // namespace base
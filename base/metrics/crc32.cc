@@ -4,6 +4,28 @@
 
 #include "base/metrics/crc32.h"
 
+#include <string.h>
+
+#include <array>
+
+#include "base/compiler_specific.h"
+#include "base/sys_byteorder.h"
+#include "build/build_config.h"
+
+#if defined(ARCH_CPU_X86_64)
+#include "base/cpu.h"
+// Including these headers directly should generally be avoided. The SSE4.2
+// and PCLMULQDQ functions are only used if the CPU supports them at runtime,
+// see GetCrcFunctions().
+// clang-format off
+#include <immintrin.h>
+// clang-format on
+#elif defined(ARCH_CPU_ARM64)
+#include <arm_acle.h>
+
+#include "base/cpu.h"
+#endif
+
 namespace base {
 
 // Static table of checksums for all possible 8 bit bytes.
@@ -62,6 +84,300 @@ const uint32_t kCrcTable[256] = {
     0x2d02ef8dL,
 };
 
+namespace {
+
+// The reversed polynomials of CRC-32 and CRC-32C.
+constexpr uint32_t kCrc32Polynomial = 0xEDB88320;
+constexpr uint32_t kCrc32CPolynomial = 0x82F63B78;
+
+// The tables of slicing-by-8: tables[0] is the CRC of each byte, as
+// kCrcTable, and tables[k] the CRC of each byte followed by k zero bytes.
+using SlicingTables = std::array<std::array<uint32_t, 256>, 8>;
+
+constexpr SlicingTables MakeSlicingTables(uint32_t polynomial) {
+  SlicingTables tables = {};
+  for (uint32_t byte = 0; byte < 256; ++byte) {
+    uint32_t crc = byte;
+    for (int bit = 0; bit < 8; ++bit)
+      crc = (crc & 1) ? polynomial ^ (crc >> 1) : crc >> 1;
+    tables[0][byte] = crc;
+  }
+  for (size_t k = 1; k < tables.size(); ++k) {
+    for (size_t byte = 0; byte < 256; ++byte) {
+      const uint32_t crc = tables[k - 1][byte];
+      tables[k][byte] = tables[0][crc & 0xFF] ^ (crc >> 8);
+    }
+  }
+  return tables;
+}
+
+constexpr SlicingTables kCrc32Tables = MakeSlicingTables(kCrc32Polynomial);
+constexpr SlicingTables kCrc32CTables = MakeSlicingTables(kCrc32CPolynomial);
+
+// The functions update the CRC register |crc| with |size| bytes, without the
+// inversions before and after which CRC-32C has.
+using UpdateFunction = uint32_t (*)(uint32_t crc,
+                                    const uint8_t* bytes,
+                                    size_t size);
+
+uint32_t UpdateSlicingBy8(const SlicingTables& tables,
+                          uint32_t crc,
+                          const uint8_t* bytes,
+                          size_t size) {
+  for (; size >= 8; bytes += 8, size -= 8) {
+    uint64_t word;
+    memcpy(&word, bytes, sizeof(word));
+    // The bytes are processed in memory order on big-endian CPUs too.
+    word = ByteSwapToLE64(word) ^ crc;
+    crc = tables[7][word & 0xFF] ^ tables[6][(word >> 8) & 0xFF] ^
+          tables[5][(word >> 16) & 0xFF] ^ tables[4][(word >> 24) & 0xFF] ^
+          tables[3][(word >> 32) & 0xFF] ^ tables[2][(word >> 40) & 0xFF] ^
+          tables[1][(word >> 48) & 0xFF] ^ tables[0][word >> 56];
+  }
+  for (; size; ++bytes, --size)
+    crc = tables[0][(crc ^ *bytes) & 0xFF] ^ (crc >> 8);
+  return crc;
+}
+
+uint32_t UpdateCrc32Unvectorized(uint32_t crc,
+                                 const uint8_t* bytes,
+                                 size_t size) {
+  return UpdateSlicingBy8(kCrc32Tables, crc, bytes, size);
+}
+
+uint32_t UpdateCrc32CUnvectorized(uint32_t crc,
+                                  const uint8_t* bytes,
+                                  size_t size) {
+  return UpdateSlicingBy8(kCrc32CTables, crc, bytes, size);
+}
+
+struct CrcFunctions {
+  UpdateFunction crc32;
+  UpdateFunction crc32c;
+};
+
+#if defined(ARCH_CPU_X86_64)
+
+// Multiplies the halves of |x| by those of |k| and adds them to |y|.
+__attribute__((target("pclmul"))) ALWAYS_INLINE __m128i Fold(__m128i x,
+                                                            __m128i k,
+                                                            __m128i y) {
+  return _mm_xor_si128(_mm_xor_si128(_mm_clmulepi64_si128(x, k, 0x00),
+                                     _mm_clmulepi64_si128(x, k, 0x11)),
+                       y);
+}
+
+// Folds the multiple of 16 bytes, which is 64 or more, into the CRC with
+// carry-less multiplications, and reduces it with Barrett's method, as Intel's
+// "Fast CRC Computation for Generic Polynomials Using PCLMULQDQ Instruction"
+// describes. The constants are the bit-reflected x^n mod P(x) of its appendix
+// for CRC-32.
+__attribute__((target("pclmul,sse4.1"))) uint32_t FoldCrc32PCLMUL(
+    uint32_t crc,
+    const uint8_t* bytes,
+    size_t size) {
+  // x^(512+32) and x^(512-32), for folding 64 bytes at a time.
+  const __m128i k1k2 = _mm_set_epi64x(0x01c6e41596, 0x0154442bd4);
+  // x^(128+32) and x^(128-32), for folding 16 bytes at a time.
+  const __m128i k3k4 = _mm_set_epi64x(0x00ccaa009e, 0x01751997d0);
+  // x^64, for folding 128 bits into 64.
+  const __m128i k5 = _mm_set_epi64x(0, 0x0163cd6124);
+  // P(x) and its Barrett constant floor(x^64 / P(x)).
+  const __m128i polynomial = _mm_set_epi64x(0x01f7011641, 0x01db710641);
+  const __m128i low_32_bits = _mm_setr_epi32(~0, 0, ~0, 0);
+
+  auto load = [bytes](size_t offset) {
+    return _mm_loadu_si128(reinterpret_cast<const __m128i*>(bytes + offset));
+  };
+
+  __m128i x1 = _mm_xor_si128(load(0), _mm_cvtsi32_si128(crc));
+  __m128i x2 = load(16);
+  __m128i x3 = load(32);
+  __m128i x4 = load(48);
+  size_t i = 64;
+  for (; i + 64 <= size; i += 64) {
+    x1 = Fold(x1, k1k2, load(i));
+    x2 = Fold(x2, k1k2, load(i + 16));
+    x3 = Fold(x3, k1k2, load(i + 32));
+    x4 = Fold(x4, k1k2, load(i + 48));
+  }
+  x1 = Fold(x1, k3k4, x2);
+  x1 = Fold(x1, k3k4, x3);
+  x1 = Fold(x1, k3k4, x4);
+  for (; i < size; i += 16)
+    x1 = Fold(x1, k3k4, load(i));
+
+  // 128 bits to 64.
+  x1 = _mm_xor_si128(_mm_srli_si128(x1, 8),
+                     _mm_clmulepi64_si128(x1, k3k4, 0x10));
+  x1 = _mm_xor_si128(
+      _mm_clmulepi64_si128(_mm_and_si128(x1, low_32_bits), k5, 0x00),
+      _mm_srli_si128(x1, 4));
+
+  // 64 bits to 32.
+  __m128i x = _mm_clmulepi64_si128(_mm_and_si128(x1, low_32_bits), polynomial,
+                                   0x10);
+  x = _mm_clmulepi64_si128(_mm_and_si128(x, low_32_bits), polynomial, 0x00);
+  return static_cast<uint32_t>(_mm_extract_epi32(_mm_xor_si128(x1, x), 1));
+}
+
+__attribute__((target("pclmul,sse4.1"))) uint32_t UpdateCrc32PCLMUL(
+    uint32_t crc,
+    const uint8_t* bytes,
+    size_t size) {
+  if (size >= 64) {
+    const size_t folded_size = size & ~size_t{15};
+    crc = FoldCrc32PCLMUL(crc, bytes, folded_size);
+    bytes += folded_size;
+    size -= folded_size;
+  }
+  return UpdateCrc32Unvectorized(crc, bytes, size);
+}
+
+__attribute__((target("sse4.2"))) uint32_t UpdateCrc32CSSE42(
+    uint32_t crc,
+    const uint8_t* bytes,
+    size_t size) {
+  uint64_t crc64 = crc;
+  for (; size >= 8; bytes += 8, size -= 8) {
+    uint64_t word;
+    memcpy(&word, bytes, sizeof(word));
+    crc64 = _mm_crc32_u64(crc64, word);
+  }
+  crc = static_cast<uint32_t>(crc64);
+  for (; size; ++bytes, --size)
+    crc = _mm_crc32_u8(crc, *bytes);
+  return crc;
+}
+
+// The CRC32 instruction has a latency of 3 cycles but a throughput of 1, so
+// the large buffers are processed as 3 interleaved streams of
+// kCrc32CStreamSize bytes each, whose CRCs are then combined.
+constexpr size_t kCrc32CStreamSize = 1024;
+
+// x^n mod P(x) for CRC-32C, bit-reflected.
+constexpr uint32_t Crc32CPowerOfX(size_t n) {
+  uint32_t power = 0x80000000;  // x^0
+  for (; n; --n)
+    power = (power >> 1) ^ ((power & 1) ? kCrc32CPolynomial : 0);
+  return power;
+}
+
+// The CRC of a stream is shifted past the |size| bytes after it by
+// multiplying it by x^(8 * size), as ShiftCrc32C() does: the bit-reflected
+// carry-less product is multiplied by x once more, and the CRC32 instruction by
+// x^32 as it reduces it.
+constexpr uint32_t kCrc32CShiftOneStream =
+    Crc32CPowerOfX(8 * kCrc32CStreamSize - 33);
+constexpr uint32_t kCrc32CShiftTwoStreams =
+    Crc32CPowerOfX(2 * 8 * kCrc32CStreamSize - 33);
+
+__attribute__((target("sse4.2,pclmul"))) ALWAYS_INLINE uint32_t
+ShiftCrc32C(uint32_t crc, uint32_t shift) {
+  const __m128i product = _mm_clmulepi64_si128(
+      _mm_cvtsi32_si128(static_cast<int>(crc)),
+      _mm_cvtsi32_si128(static_cast<int>(shift)), 0x00);
+  return static_cast<uint32_t>(
+      _mm_crc32_u64(0, static_cast<uint64_t>(_mm_cvtsi128_si64(product))));
+}
+
+__attribute__((target("sse4.2,pclmul"))) uint32_t UpdateCrc32CSSE42PCLMUL(
+    uint32_t crc,
+    const uint8_t* bytes,
+    size_t size) {
+  for (; size >= 3 * kCrc32CStreamSize;
+       bytes += 3 * kCrc32CStreamSize, size -= 3 * kCrc32CStreamSize) {
+    uint64_t crc0 = crc;
+    uint64_t crc1 = 0;
+    uint64_t crc2 = 0;
+    for (size_t i = 0; i < kCrc32CStreamSize; i += 8) {
+      uint64_t words[3];
+      memcpy(&words[0], bytes + i, sizeof(uint64_t));
+      memcpy(&words[1], bytes + kCrc32CStreamSize + i, sizeof(uint64_t));
+      memcpy(&words[2], bytes + 2 * kCrc32CStreamSize + i, sizeof(uint64_t));
+      crc0 = _mm_crc32_u64(crc0, words[0]);
+      crc1 = _mm_crc32_u64(crc1, words[1]);
+      crc2 = _mm_crc32_u64(crc2, words[2]);
+    }
+    crc = ShiftCrc32C(static_cast<uint32_t>(crc0), kCrc32CShiftTwoStreams) ^
+          ShiftCrc32C(static_cast<uint32_t>(crc1), kCrc32CShiftOneStream) ^
+          static_cast<uint32_t>(crc2);
+  }
+  return UpdateCrc32CSSE42(crc, bytes, size);
+}
+
+const CrcFunctions& GetCrcFunctions() {
+  static const CrcFunctions functions = []() -> CrcFunctions {
+    const CPU cpu;
+    return {cpu.has_pclmul() && cpu.has_sse41() ? &UpdateCrc32PCLMUL
+                                                : &UpdateCrc32Unvectorized,
+            cpu.has_sse42() ? (cpu.has_pclmul() ? &UpdateCrc32CSSE42PCLMUL
+                                                : &UpdateCrc32CSSE42)
+                            : &UpdateCrc32CUnvectorized};
+  }();
+  return functions;
+}
+
+#elif defined(ARCH_CPU_ARM64)
+
+// The Armv8 CRC32 instructions compute both CRCs, 8 bytes at a time. They're
+// optional in Armv8.0, so they're only used if the CPU supports them at
+// runtime.
+#if defined(__clang__)
+#define TARGET_ARMV8_CRC __attribute__((target("crc")))
+#else
+#define TARGET_ARMV8_CRC __attribute__((target("+crc")))
+#endif
+
+TARGET_ARMV8_CRC uint32_t UpdateCrc32Armv8(uint32_t crc,
+                                           const uint8_t* bytes,
+                                           size_t size) {
+  for (; size >= 8; bytes += 8, size -= 8) {
+    uint64_t word;
+    memcpy(&word, bytes, sizeof(word));
+    crc = __crc32d(crc, word);
+  }
+  for (; size; ++bytes, --size)
+    crc = __crc32b(crc, *bytes);
+  return crc;
+}
+
+TARGET_ARMV8_CRC uint32_t UpdateCrc32CArmv8(uint32_t crc,
+                                            const uint8_t* bytes,
+                                            size_t size) {
+  for (; size >= 8; bytes += 8, size -= 8) {
+    uint64_t word;
+    memcpy(&word, bytes, sizeof(word));
+    crc = __crc32cd(crc, word);
+  }
+  for (; size; ++bytes, --size)
+    crc = __crc32cb(crc, *bytes);
+  return crc;
+}
+
+#undef TARGET_ARMV8_CRC
+
+const CrcFunctions& GetCrcFunctions() {
+  static const CrcFunctions functions = []() -> CrcFunctions {
+    if (CPU().has_crc32())
+      return {&UpdateCrc32Armv8, &UpdateCrc32CArmv8};
+    return {&UpdateCrc32Unvectorized, &UpdateCrc32CUnvectorized};
+  }();
+  return functions;
+}
+
+#else
+
+const CrcFunctions& GetCrcFunctions() {
+  static constexpr CrcFunctions kFunctions = {&UpdateCrc32Unvectorized,
+                                              &UpdateCrc32CUnvectorized};
+  return kFunctions;
+}
+
+#endif
+
+}  // namespace
+
 // We generate the CRC-32 using the low order bits to select whether to XOR in
 // the reversed polynomial 0xEDB88320.  This is nice and simple, and allows us
 // to keep the quotient in a uint32_t.  Since we're not concerned about the
@@ -70,12 +386,30 @@ const uint32_t kCrcTable[256] = {
 // the CRC correct for big-endian vs little-ending calculations.  All we need is
 // a nice hash, that tends to depend on all the bits of the sample, with very
 // little chance of changes in one place impacting changes in another place.
+//
+// The bytes are processed 8 at a time with slicing-by-8, or with the CRC or
+// carry-less multiplication instructions of the CPU, which all compute the
+// same CRC as kCrcTable a byte at a time.
 uint32_t Crc32(uint32_t sum, const void* data, size_t size) {
-  const unsigned char* bytes = reinterpret_cast<const unsigned char*>(data);
-  for (size_t i = 0; i < size; ++i) {
-    sum = kCrcTable[(sum & 0x000000FF) ^ bytes[i]] ^ (sum >> 8);
-  }
-  return sum;
+  return GetCrcFunctions().crc32(sum, static_cast<const uint8_t*>(data), size);
+}
+
+uint32_t Crc32C(uint32_t crc, const void* data, size_t size) {
+  return ~GetCrcFunctions().crc32c(~crc, static_cast<const uint8_t*>(data),
+                                   size);
 }
 
+namespace internal {
+
+uint32_t Crc32Unvectorized(uint32_t sum, const void* data, size_t size) {
+  return UpdateCrc32Unvectorized(sum, static_cast<const uint8_t*>(data), size);
+}
+
+uint32_t Crc32CUnvectorized(uint32_t crc, const void* data, size_t size) {
+  return ~UpdateCrc32CUnvectorized(~crc, static_cast<const uint8_t*>(data),
+                                   size);
+}
+
+}  // namespace internal
+
 }  // namespace base
@@ -17,8 +17,31 @@ BASE_EXPORT extern const uint32_t kCrcTable[256];
 // This provides a simple, fast CRC-32 calculation that can be used for checking
 // the integrity of data.  It is not a "secure" calculation!  |sum| can start
 // with any seed or be used to continue an operation began with previous data.
+//
+// It uses the CRC32 instructions of Armv8 or the carry-less multiplications of
+// x86 when the CPU has them, and slicing-by-8 otherwise.
 BASE_EXPORT uint32_t Crc32(uint32_t sum, const void* data, size_t size);
 
+// Computes the CRC-32C (Castagnoli) of |data|, as iSCSI, SCTP and ext4 do, for
+// which "123456789" is 0xE3069283. |crc| is 0 to begin, or the result of a
+// previous call to continue it over more data. Unlike Crc32(), it's a standard
+// checksum, and the CRC32 instructions of SSE4.2 and Armv8 compute it, so
+// prefer it for new formats which store checksums.
+BASE_EXPORT uint32_t Crc32C(uint32_t crc, const void* data, size_t size);
+
+namespace internal {
+
+// The slicing-by-8 implementations, which are used without the instructions.
+// Exposed for testing.
+BASE_EXPORT uint32_t Crc32Unvectorized(uint32_t sum,
+                                       const void* data,
+                                       size_t size);
+BASE_EXPORT uint32_t Crc32CUnvectorized(uint32_t crc,
+                                        const void* data,
+                                        size_t size);
+
+}  // namespace internal
+
 }  // namespace base
 
 #endif  // BASE_METRICS_CRC32_H_
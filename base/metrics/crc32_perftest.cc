@@ -0,0 +1,47 @@
+// Copyright 2022 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "base/metrics/crc32.h"
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include <vector>
+
+#include "base/time/time.h"
+#include "testing/gtest/include/gtest/gtest.h"
+
+namespace base {
+
+namespace {
+
+constexpr size_t kBytesPerSize = 1024 * 1024 * 1024;
+
+using CrcFunction = uint32_t (*)(uint32_t, const void*, size_t);
+
+// Prints the throughput of |function| over |size| bytes, in GB/s.
+void Measure(const char* name, CrcFunction function, size_t size) {
+  const std::vector<uint8_t> data(size, 0x5A);
+  const size_t iterations = kBytesPerSize / size;
+  uint32_t crc = 0;
+  const TimeTicks start = TimeTicks::Now();
+  for (size_t i = 0; i < iterations; ++i)
+    crc = function(crc, data.data(), data.size());
+  const TimeDelta time = TimeTicks::Now() - start;
+  printf("%s\tsize:\t%zu\tGB/s:\t%.2f\t(%08x)\n", name, size,
+         iterations * size / time.InSecondsF() / (1024 * 1024 * 1024), crc);
+}
+
+}  // namespace
+
+TEST(Crc32PerfTest, DISABLED_Throughput) {
+  for (size_t size = 16; size <= 1024 * 1024; size *= 16) {
+    Measure("crc32", &Crc32, size);
+    Measure("crc32-unvectorized", &internal::Crc32Unvectorized, size);
+    Measure("crc32c", &Crc32C, size);
+    Measure("crc32c-unvectorized", &internal::Crc32CUnvectorized, size);
+  }
+}
+
+}  // namespace base
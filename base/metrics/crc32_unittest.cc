@@ -4,12 +4,41 @@
 
 #include "base/metrics/crc32.h"
 
+#include <stddef.h>
 #include <stdint.h>
 
+#include <string>
+#include <vector>
+
 #include "testing/gtest/include/gtest/gtest.h"
 
 namespace base {
 
+namespace {
+
+// The CRC-32 of kCrcTable a byte at a time.
+uint32_t Crc32ByteAtATime(uint32_t sum, const uint8_t* bytes, size_t size) {
+  for (size_t i = 0; i < size; ++i)
+    sum = kCrcTable[(sum & 0x000000FF) ^ bytes[i]] ^ (sum >> 8);
+  return sum;
+}
+
+// Covers the sizes which are interleaved in several streams.
+constexpr size_t kMaxSize = 8192;
+
+// A buffer which is neither random nor periodic over small sizes.
+std::vector<uint8_t> MakeData(size_t size) {
+  std::vector<uint8_t> data(size);
+  uint32_t state = 12345;
+  for (uint8_t& byte : data) {
+    state = state * 1103515245 + 12345;
+    byte = static_cast<uint8_t>(state >> 16);
+  }
+  return data;
+}
+
+}  // namespace
+
 // Table was generated similarly to sample code for CRC-32 given on:
 // http://www.w3.org/TR/PNG/#D-CRCAppendix.
 TEST(Crc32Test, TableTest) {
@@ -31,4 +60,70 @@ TEST(Crc32Test, ZeroTest) {
   EXPECT_EQ(0U, Crc32(0, nullptr, 0));
 }
 
+// All the implementations match the byte at a time one, over the sizes and
+// alignments around which they switch to folding or to their tails.
+TEST(Crc32Test, MatchesByteAtATime) {
+  const std::vector<uint8_t> data = MakeData(kMaxSize + 16);
+  for (size_t offset = 0; offset < 16; ++offset) {
+    for (size_t size = 0; size + offset <= data.size();
+         size += size < 300 ? 1 : 251) {
+      const uint8_t* bytes = data.data() + offset;
+      for (uint32_t sum : {0u, 0xFFFFFFFFu, 0x12345678u}) {
+        const uint32_t expected = Crc32ByteAtATime(sum, bytes, size);
+        EXPECT_EQ(expected, Crc32(sum, bytes, size)) << offset << " " << size;
+        EXPECT_EQ(expected, internal::Crc32Unvectorized(sum, bytes, size))
+            << offset << " " << size;
+      }
+    }
+  }
+}
+
+TEST(Crc32Test, Continues) {
+  const std::vector<uint8_t> data = MakeData(4096);
+  const uint32_t expected = Crc32(0, data.data(), data.size());
+  for (size_t split : {1, 7, 64, 100, 4000}) {
+    EXPECT_EQ(expected,
+              Crc32(Crc32(0, data.data(), split), data.data() + split,
+                    data.size() - split));
+  }
+}
+
+// The check values of CRC-32C, from RFC 3720 B.4 and the CRC catalogue.
+TEST(Crc32Test, Crc32CKnownValues) {
+  const std::string kDigits = "123456789";
+  const std::vector<uint8_t> kZeros(32, 0x00);
+  const std::vector<uint8_t> kOnes(32, 0xFF);
+  std::vector<uint8_t> ascending(32);
+  for (size_t i = 0; i < ascending.size(); ++i)
+    ascending[i] = static_cast<uint8_t>(i);
+
+  for (auto* crc32c : {&Crc32C, &internal::Crc32CUnvectorized}) {
+    EXPECT_EQ(0u, crc32c(0, nullptr, 0));
+    EXPECT_EQ(0xE3069283u, crc32c(0, kDigits.data(), kDigits.size()));
+    EXPECT_EQ(0x8A9136AAu, crc32c(0, kZeros.data(), kZeros.size()));
+    EXPECT_EQ(0x62A8AB43u, crc32c(0, kOnes.data(), kOnes.size()));
+    EXPECT_EQ(0x46DD794Eu, crc32c(0, ascending.data(), ascending.size()));
+  }
+}
+
+TEST(Crc32Test, Crc32CMatchesUnvectorized) {
+  const std::vector<uint8_t> data = MakeData(kMaxSize + 16);
+  for (size_t offset = 0; offset < 16; ++offset) {
+    for (size_t size = 0; size + offset <= data.size();
+         size += size < 300 ? 1 : 251) {
+      const uint8_t* bytes = data.data() + offset;
+      EXPECT_EQ(internal::Crc32CUnvectorized(0, bytes, size),
+                Crc32C(0, bytes, size))
+          << offset << " " << size;
+    }
+  }
+
+  const uint32_t expected = Crc32C(0, data.data(), data.size());
+  for (size_t split : {1, 9, 100}) {
+    EXPECT_EQ(expected,
+              Crc32C(Crc32C(0, data.data(), split), data.data() + split,
+                     data.size() - split));
+  }
+}
+
 }  // namespace base
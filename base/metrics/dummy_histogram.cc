@@ -99,6 +99,10 @@ std::unique_ptr<HistogramSamples> DummyHistogram::SnapshotFinalDelta() const {
   return std::make_unique<DummyHistogramSamples>();
 }
 
+bool DummyHistogram::HasUnloggedSamples() const {
+  return false;
+}
+
 Value DummyHistogram::ToGraphDict() const {
   return Value(Value::Type::DICTIONARY);
 }
@@ -40,6 +40,7 @@ class BASE_EXPORT DummyHistogram : public HistogramBase {
   std::unique_ptr<HistogramSamples> SnapshotSamples() const override;
   std::unique_ptr<HistogramSamples> SnapshotDelta() override;
   std::unique_ptr<HistogramSamples> SnapshotFinalDelta() const override;
+  bool HasUnloggedSamples() const override;
   void WriteAscii(std::string* output) const override {}
   Value ToGraphDict() const override;
 
@@ -10,7 +10,9 @@
 #include "base/auto_reset.h"
 #include "base/base_switches.h"
 #include "base/command_line.h"
+#include "base/bits.h"
 #include "base/debug/activity_tracker.h"
+#include "base/hash/hash.h"
 #include "base/logging.h"
 #include "base/metrics/field_trial_param_associator.h"
 #include "base/metrics/histogram_macros.h"
@@ -51,6 +53,9 @@ namespace base {
 
 namespace {
 
+// The capacity of the first table of trials, which holds half as many.
+constexpr size_t kInitialTrialTableCapacity = 256;
+
 // Define a separator character to use when creating a persistent form of an
 // instance.  This is intended for use as a command line argument, passed to a
 // second process to mimic our state (i.e., provide the same group name).
@@ -252,6 +257,22 @@ bool FieldTrial::FieldTrialEntry::GetParams(
   }
 }
 
+bool FieldTrial::FieldTrialEntry::GetParamValue(StringPiece name,
+                                                StringPiece* value) const {
+  PickleIterator iter = GetPickleIterator();
+  StringPiece tmp;
+  // Skip reading trial and group name.
+  if (!ReadStringPair(&iter, &tmp, &tmp))
+    return false;
+
+  StringPiece key;
+  while (ReadStringPair(&iter, &key, value)) {
+    if (key == name)
+      return true;
+  }
+  return false;
+}
+
 PickleIterator FieldTrial::FieldTrialEntry::GetPickleIterator() const {
   const char* src =
       reinterpret_cast<const char*>(this) + sizeof(FieldTrialEntry);
@@ -271,6 +292,44 @@ bool FieldTrial::FieldTrialEntry::ReadStringPair(
   return true;
 }
 
+FieldTrial::ParamsSnapshot::ParamsSnapshot()
+    : has_params_(false), entry_(nullptr) {}
+
+FieldTrial::ParamsSnapshot::ParamsSnapshot(
+    std::map<std::string, std::string> params)
+    : has_params_(true), params_(std::move(params)), entry_(nullptr) {}
+
+FieldTrial::ParamsSnapshot::ParamsSnapshot(const FieldTrialEntry* entry)
+    : has_params_(true), entry_(entry) {}
+
+FieldTrial::ParamsSnapshot::~ParamsSnapshot() = default;
+
+bool FieldTrial::ParamsSnapshot::GetParams(
+    std::map<std::string, std::string>* params) const {
+  if (entry_)
+    return entry_->GetParams(params);
+  if (!has_params_)
+    return false;
+  *params = params_;
+  return true;
+}
+
+bool FieldTrial::ParamsSnapshot::GetParamValue(const std::string& name,
+                                               std::string* value) const {
+  if (entry_) {
+    StringPiece entry_value;
+    if (!entry_->GetParamValue(name, &entry_value))
+      return false;
+    value->assign(entry_value.data(), entry_value.size());
+    return true;
+  }
+  const auto it = params_.find(name);
+  if (it == params_.end())
+    return false;
+  *value = it->second;
+  return true;
+}
+
 void FieldTrial::Disable() {
   // Group choice has already been reported to observers so we can't disable
   // the study.
@@ -391,7 +450,9 @@ FieldTrial::FieldTrial(StringPiece trial_name,
       << "Trial " << trial_name << " is missing a default group name.";
 }
 
-FieldTrial::~FieldTrial() = default;
+FieldTrial::~FieldTrial() {
+  ClearParamsSnapshot();
+}
 
 void FieldTrial::SetTrialRegistered() {
   DCHECK_EQ(kNotFinalized, group_);
@@ -426,6 +487,25 @@ void FieldTrial::FinalizeGroupChoiceImpl(bool is_locked) {
     FieldTrialList::OnGroupFinalized(is_locked, this);
 }
 
+const FieldTrial::ParamsSnapshot* FieldTrial::PublishParamsSnapshot(
+    std::unique_ptr<ParamsSnapshot>* params_snapshot) {
+  // The params of a trial which isn't active may still be associated.
+  // |group_reported_| was set, if at all, by the caller's group() call.
+  if (!group_reported_ || !enable_field_trial_)
+    return nullptr;
+  const ParamsSnapshot* expected = nullptr;
+  if (params_snapshot_.compare_exchange_strong(
+          expected, params_snapshot->get(), std::memory_order_acq_rel,
+          std::memory_order_acquire)) {
+    return params_snapshot->release();
+  }
+  return expected;
+}
+
+void FieldTrial::ClearParamsSnapshot() {
+  delete params_snapshot_.exchange(nullptr, std::memory_order_acq_rel);
+}
+
 bool FieldTrial::GetActiveGroup(ActiveGroup* active_group) const {
   if (!group_reported_ || !enable_field_trial_)
     return false;
@@ -449,6 +529,54 @@ bool FieldTrial::GetStateWhileLocked(State* field_trial_state,
 //------------------------------------------------------------------------------
 // FieldTrialList methods and members.
 
+// The trials are probed for linearly from the hash of their name. A trial is
+// only ever added, so a reader which finds an empty slot knows that the trial
+// is not further on.
+class FieldTrialList::TrialTable {
+ public:
+  explicit TrialTable(size_t capacity)
+      : mask_(capacity - 1), slots_(new Slot[capacity]) {
+    DCHECK(bits::IsPowerOfTwo(capacity));
+  }
+
+  size_t capacity() const { return mask_ + 1; }
+
+  FieldTrial* Find(StringPiece trial_name, size_t hash) const {
+    for (size_t i = hash & mask_;; i = (i + 1) & mask_) {
+      FieldTrial* const trial = slots_[i].trial.load(std::memory_order_acquire);
+      if (!trial)
+        return nullptr;
+      if (slots_[i].hash == hash && trial->trial_name() == trial_name)
+        return trial;
+    }
+  }
+
+  // Returns false if there's no room to add |trial|. Over half of the slots
+  // are kept empty, so that probes stay short.
+  bool Add(FieldTrial* trial, size_t hash) {
+    if (2 * (size_ + 1) > capacity())
+      return false;
+    size_t i = hash & mask_;
+    while (slots_[i].trial.load(std::memory_order_relaxed))
+      i = (i + 1) & mask_;
+    // Published by the release store of the trial.
+    slots_[i].hash = hash;
+    slots_[i].trial.store(trial, std::memory_order_release);
+    ++size_;
+    return true;
+  }
+
+ private:
+  struct Slot {
+    size_t hash = 0;
+    std::atomic<FieldTrial*> trial{nullptr};
+  };
+
+  const size_t mask_;
+  const std::unique_ptr<Slot[]> slots_;
+  size_t size_ = 0;
+};
+
 // static
 FieldTrialList* FieldTrialList::global_ = nullptr;
 
@@ -469,6 +597,9 @@ FieldTrialList::~FieldTrialList() {
   AutoLock auto_lock(lock_);
   while (!registered_.empty()) {
     auto it = registered_.begin();
+    // The params may be read from |field_trial_allocator_|, which the trial
+    // could outlive.
+    it->second->ClearParamsSnapshot();
     it->second->Release();
     registered_.erase(it->first);
   }
@@ -556,8 +687,9 @@ FieldTrial* FieldTrialList::FactoryGetFieldTrialWithRandomizationSeed(
 FieldTrial* FieldTrialList::Find(StringPiece trial_name) {
   if (!global_)
     return nullptr;
-  AutoLock auto_lock(global_->lock_);
-  return global_->PreLockedFind(trial_name);
+  const TrialTable* const table =
+      global_->published_table_.load(std::memory_order_acquire);
+  return table ? table->Find(trial_name, FastHash(trial_name)) : nullptr;
 }
 
 // static
@@ -1008,6 +1140,35 @@ bool FieldTrialList::GetParamsFromSharedMemory(
   return entry->GetParams(params);
 }
 
+// static
+std::unique_ptr<FieldTrial::ParamsSnapshot>
+FieldTrialList::GetParamsSnapshotFromSharedMemory(FieldTrial* field_trial) {
+  DCHECK(global_);
+  // See GetParamsFromSharedMemory() for when the params aren't there.
+  AutoLock auto_lock(global_->lock_);
+  if (!global_->field_trial_allocator_ || !field_trial->ref_)
+    return nullptr;
+
+  const FieldTrial::FieldTrialEntry* entry =
+      global_->field_trial_allocator_->GetAsObject<FieldTrial::FieldTrialEntry>(
+          field_trial->ref_);
+  size_t allocated_size =
+      global_->field_trial_allocator_->GetAllocSize(field_trial->ref_);
+  size_t actual_size = sizeof(FieldTrial::FieldTrialEntry) + entry->pickle_size;
+  if (allocated_size < actual_size)
+    return nullptr;
+
+  // A child's entries don't change, and its allocator lives as long as this
+  // list, whose destructor clears the snapshots.
+  if (global_->field_trial_allocator_->IsReadonly())
+    return std::make_unique<FieldTrial::ParamsSnapshot>(entry);
+
+  std::map<std::string, std::string> params;
+  if (!entry->GetParams(&params))
+    return nullptr;
+  return std::make_unique<FieldTrial::ParamsSnapshot>(std::move(params));
+}
+
 // static
 void FieldTrialList::ClearParamsFromSharedMemoryForTesting() {
   if (!global_)
@@ -1073,6 +1234,16 @@ void FieldTrialList::ClearParamsFromSharedMemoryForTesting() {
   }
 }
 
+// static
+void FieldTrialList::ClearParamsSnapshotsForTesting() {
+  if (!global_)
+    return;
+
+  AutoLock auto_lock(global_->lock_);
+  for (const auto& registered : global_->registered_)
+    registered.second->ClearParamsSnapshot();
+}
+
 // static
 void FieldTrialList::DumpAllFieldTrialsToPersistentAllocator(
     PersistentMemoryAllocator* allocator) {
@@ -1449,6 +1620,24 @@ void FieldTrialList::Register(FieldTrial* trial) {
   trial->AddRef();
   trial->SetTrialRegistered();
   global_->registered_[trial->trial_name()] = trial;
+  global_->AddToTableWhileLocked(trial);
+}
+
+void FieldTrialList::AddToTableWhileLocked(FieldTrial* trial) {
+  if (table_ && table_->Add(trial, FastHash(trial->trial_name())))
+    return;
+
+  // Copy |registered_|, which already has |trial|, to a larger table.
+  size_t capacity = kInitialTrialTableCapacity;
+  while (capacity < 4 * registered_.size())
+    capacity *= 2;
+  auto table = std::make_unique<TrialTable>(capacity);
+  for (const auto& registered : registered_)
+    CHECK(table->Add(registered.second, FastHash(registered.first)));
+  if (table_)
+    old_tables_.push_back(std::move(table_));
+  table_ = std::move(table);
+  published_table_.store(table_.get(), std::memory_order_release);
 }
 
 // static
@@ -82,6 +82,7 @@
 namespace base {
 
 class FieldTrialList;
+class FieldTrialParamAssociator;
 struct LaunchOptions;
 
 class BASE_EXPORT FieldTrial : public RefCounted<FieldTrial> {
@@ -165,6 +166,11 @@ class BASE_EXPORT FieldTrial : public RefCounted<FieldTrial> {
     // key-value mappings in |params|.
     bool GetParams(std::map<std::string, std::string>* params) const;
 
+    // Calling this is only valid when the entry is initialized as well. Finds
+    // the parameter |name| following the trial and group name, and points
+    // |value| to its value, in the entry. Returns false if there's none.
+    bool GetParamValue(StringPiece name, StringPiece* value) const;
+
    private:
     // Returns an iterator over the data containing names and params.
     PickleIterator GetPickleIterator() const;
@@ -273,11 +279,40 @@ class BASE_EXPORT FieldTrial : public RefCounted<FieldTrial> {
   FRIEND_TEST_ALL_PREFIXES(FieldTrialListTest, ClearParamsFromSharedMemory);
 
   friend class base::FieldTrialList;
+  friend class base::FieldTrialParamAssociator;
 
   friend class RefCounted<FieldTrial>;
 
   using FieldTrialRef = PersistentMemoryAllocator::Reference;
 
+  // The params of the chosen group, as FieldTrialParamAssociator resolved them,
+  // or their absence.
+  class BASE_EXPORT ParamsSnapshot {
+   public:
+    // No params.
+    ParamsSnapshot();
+    explicit ParamsSnapshot(std::map<std::string, std::string> params);
+    // Reads the params from |entry|, in read-only shared memory which outlives
+    // the snapshot, without copying them.
+    explicit ParamsSnapshot(const FieldTrialEntry* entry);
+
+    ParamsSnapshot(const ParamsSnapshot&) = delete;
+    ParamsSnapshot& operator=(const ParamsSnapshot&) = delete;
+
+    ~ParamsSnapshot();
+
+    // Returns false if there are no params.
+    bool GetParams(std::map<std::string, std::string>* params) const;
+
+    // Returns false if there's no param named |name|.
+    bool GetParamValue(const std::string& name, std::string* value) const;
+
+   private:
+    const bool has_params_;
+    const std::map<std::string, std::string> params_;
+    const raw_ptr<const FieldTrialEntry> entry_;
+  };
+
   // This is the group number of the 'default' group when a choice wasn't forced
   // by a call to FieldTrialList::CreateFieldTrial. It is kept private so that
   // consumers don't use it by mistake in cases where the group was forced.
@@ -330,6 +365,21 @@ class BASE_EXPORT FieldTrial : public RefCounted<FieldTrial> {
   // Returns the group_name. A winner need not have been chosen.
   const std::string& group_name_internal() const { return group_name_; }
 
+  // Returns the published params, or null if they weren't yet.
+  const ParamsSnapshot* params_snapshot() const {
+    return params_snapshot_.load(std::memory_order_acquire);
+  }
+
+  // Publishes |*params_snapshot|, taking it, once the group was reported,
+  // since the params can't be associated anymore. Returns the snapshot
+  // published, which may be another thread's, or null if the group wasn't
+  // reported or the trial is disabled.
+  const ParamsSnapshot* PublishParamsSnapshot(
+      std::unique_ptr<ParamsSnapshot>* params_snapshot);
+
+  // Deletes the published params, which mustn't be read concurrently.
+  void ClearParamsSnapshot();
+
   // The name of the field trial, as can be found via the FieldTrialList.
   const std::string trial_name_;
 
@@ -377,6 +427,10 @@ class BASE_EXPORT FieldTrial : public RefCounted<FieldTrial> {
   // Reference to related field trial struct and data in shared memory.
   FieldTrialRef ref_;
 
+  // The params of the chosen group, once published, after which they are read
+  // without a lock. Owned by this trial.
+  std::atomic<const ParamsSnapshot*> params_snapshot_{nullptr};
+
   // Denotes whether benchmarking is enabled. In this case, field trials all
   // revert to the default group.
   static bool enable_benchmarking_;
@@ -465,7 +519,8 @@ class BASE_EXPORT FieldTrialList {
       const FieldTrial::EntropyProvider* override_entropy_provider);
 
   // The Find() method can be used to test to see if a named trial was already
-  // registered, or to retrieve a pointer to it from the global map.
+  // registered, or to retrieve a pointer to it from the global map. Takes no
+  // lock.
   static FieldTrial* Find(StringPiece trial_name);
 
   // Returns the group number chosen for the named trial, or
@@ -619,9 +674,21 @@ class BASE_EXPORT FieldTrialList {
       FieldTrial* field_trial,
       std::map<std::string, std::string>* params);
 
+  // Returns the params of |field_trial| from shared memory, or null if they
+  // aren't there. In a child process, the params are read from the read-only
+  // shared memory rather than copied. This is only exposed for use by
+  // FieldTrialParamAssociator and shouldn't be used by anything else.
+  static std::unique_ptr<FieldTrial::ParamsSnapshot>
+  GetParamsSnapshotFromSharedMemory(FieldTrial* field_trial);
+
   // Clears all the params in the allocator.
   static void ClearParamsFromSharedMemoryForTesting();
 
+  // Deletes the params published on the registered trials, which mustn't be
+  // read concurrently. This is only exposed for use by
+  // FieldTrialParamAssociator.
+  static void ClearParamsSnapshotsForTesting();
+
   // Dumps field trial state to an allocator so that it can be analyzed after a
   // crash.
   static void DumpAllFieldTrialsToPersistentAllocator(
@@ -658,6 +725,7 @@ class BASE_EXPORT FieldTrialList {
                            DoNotAddSimulatedFieldTrialsToAllocator);
   FRIEND_TEST_ALL_PREFIXES(FieldTrialListTest, AssociateFieldTrialParams);
   FRIEND_TEST_ALL_PREFIXES(FieldTrialListTest, ClearParamsFromSharedMemory);
+  FRIEND_TEST_ALL_PREFIXES(FieldTrialListTest, GetParamValueFromSharedMemory);
   FRIEND_TEST_ALL_PREFIXES(FieldTrialListTest,
                            SerializeSharedMemoryRegionMetadata);
   friend int SerializeSharedMemoryRegionMetadata();
@@ -727,6 +795,13 @@ class BASE_EXPORT FieldTrialList {
   // A map from FieldTrial names to the actual instances.
   typedef std::map<std::string, FieldTrial*, std::less<>> RegistrationMap;
 
+  // An open-addressed table of the registered trials, which Find() reads
+  // without the lock. Defined in the .cc file.
+  class TrialTable;
+
+  // Adds |trial| to |table_|, growing it as needed.
+  void AddToTableWhileLocked(FieldTrial* trial) EXCLUSIVE_LOCKS_REQUIRED(lock_);
+
   // Helper function should be called only while holding lock_.
   FieldTrial* PreLockedFind(StringPiece name) EXCLUSIVE_LOCKS_REQUIRED(lock_);
 
@@ -750,6 +825,14 @@ class BASE_EXPORT FieldTrialList {
   Lock lock_;
   RegistrationMap registered_ GUARDED_BY(lock_);
 
+  // The table of |registered_|. It's only written to with |lock_| held, and is
+  // replaced by a larger copy when it fills up, which |published_table_| then
+  // points to. The tables replaced are kept in |old_tables_| until this list
+  // is deleted, as readers may still be looking into them.
+  std::unique_ptr<TrialTable> table_ GUARDED_BY(lock_);
+  std::vector<std::unique_ptr<TrialTable>> old_tables_ GUARDED_BY(lock_);
+  std::atomic<const TrialTable*> published_table_{nullptr};
+
   // Entropy provider to be used for one-time randomized field trials. If NULL,
   // one-time randomization is not supported.
   std::unique_ptr<const FieldTrial::EntropyProvider> entropy_provider_;
@@ -44,14 +44,19 @@ bool FieldTrialParamAssociator::GetFieldTrialParams(FieldTrial* field_trial,
                                                     FieldTrialParams* params) {
   if (!field_trial)
     return false;
-  // First try the local map, falling back to getting it from shared memory.
-  if (GetFieldTrialParamsWithoutFallback(field_trial->trial_name(),
-                                         field_trial->group_name(), params)) {
-    return true;
-  }
+  std::unique_ptr<FieldTrial::ParamsSnapshot> unpublished;
+  return GetParamsSnapshot(field_trial, &unpublished)->GetParams(params);
+}
 
-  // TODO(lawrencewu): add the params to field_trial_params_ for next time.
-  return FieldTrialList::GetParamsFromSharedMemory(field_trial, params);
+bool FieldTrialParamAssociator::GetFieldTrialParamValue(
+    FieldTrial* field_trial,
+    const std::string& param_name,
+    std::string* value) {
+  if (!field_trial)
+    return false;
+  std::unique_ptr<FieldTrial::ParamsSnapshot> unpublished;
+  return GetParamsSnapshot(field_trial, &unpublished)
+      ->GetParamValue(param_name, value);
 }
 
 bool FieldTrialParamAssociator::GetFieldTrialParamsWithoutFallback(
@@ -75,19 +80,53 @@ void FieldTrialParamAssociator::ClearAllParamsForTesting() {
     field_trial_params_.clear();
   }
   FieldTrialList::ClearParamsFromSharedMemoryForTesting();
+  FieldTrialList::ClearParamsSnapshotsForTesting();
 }
 
 void FieldTrialParamAssociator::ClearParamsForTesting(
     const std::string& trial_name,
     const std::string& group_name) {
-  AutoLock scoped_lock(lock_);
-  const FieldTrialRefKey key(trial_name, group_name);
-  field_trial_params_.erase(key);
+  {
+    AutoLock scoped_lock(lock_);
+    const FieldTrialRefKey key(trial_name, group_name);
+    field_trial_params_.erase(key);
+  }
+  FieldTrialList::ClearParamsSnapshotsForTesting();
 }
 
 void FieldTrialParamAssociator::ClearAllCachedParamsForTesting() {
-  AutoLock scoped_lock(lock_);
-  field_trial_params_.clear();
+  {
+    AutoLock scoped_lock(lock_);
+    field_trial_params_.clear();
+  }
+  FieldTrialList::ClearParamsSnapshotsForTesting();
+}
+
+const FieldTrial::ParamsSnapshot* FieldTrialParamAssociator::GetParamsSnapshot(
+    FieldTrial* field_trial,
+    std::unique_ptr<FieldTrial::ParamsSnapshot>* unpublished) {
+  if (const FieldTrial::ParamsSnapshot* params_snapshot =
+          field_trial->params_snapshot()) {
+    return params_snapshot;
+  }
+
+  // First try the local map, falling back to getting it from shared memory.
+  // Getting the group name activates the trial.
+  FieldTrialParams params;
+  if (GetFieldTrialParamsWithoutFallback(field_trial->trial_name(),
+                                         field_trial->group_name(), &params)) {
+    *unpublished =
+        std::make_unique<FieldTrial::ParamsSnapshot>(std::move(params));
+  } else {
+    *unpublished =
+        FieldTrialList::GetParamsSnapshotFromSharedMemory(field_trial);
+    if (!*unpublished)
+      *unpublished = std::make_unique<FieldTrial::ParamsSnapshot>();
+  }
+
+  const FieldTrial::ParamsSnapshot* published =
+      field_trial->PublishParamsSnapshot(unpublished);
+  return published ? published : unpublished->get();
 }
 
 }  // namespace base
@@ -6,6 +6,7 @@
 #define BASE_METRICS_FIELD_TRIAL_PARAM_ASSOCIATOR_H_
 
 #include <map>
+#include <memory>
 #include <string>
 #include <utility>
 
@@ -42,6 +43,17 @@ class BASE_EXPORT FieldTrialParamAssociator {
   // false if no params are available or the passed |field_trial| is null.
   bool GetFieldTrialParams(FieldTrial* field_trial, FieldTrialParams* params);
 
+  // Gets the value of the parameter |param_name| of |field_trial|'s chosen
+  // group, found as by GetFieldTrialParams() but without copying the others.
+  // Returns false if there's no such parameter or |field_trial| is null.
+  //
+  // Once the trial is active, its parameters are published on it, after which
+  // both take no lock. In a child process, the parameters are then read from
+  // the shared memory.
+  bool GetFieldTrialParamValue(FieldTrial* field_trial,
+                               const std::string& param_name,
+                               std::string* value);
+
   // Gets the parameters for a field trial and its chosen group. Does not
   // fallback to looking it up in shared memory. This should only be used if you
   // know for sure the params are in the mapping, like if you're in the browser
@@ -70,6 +82,12 @@ class BASE_EXPORT FieldTrialParamAssociator {
   // The following type can be used for lookups without needing to copy strings.
   typedef std::pair<const std::string&, const std::string&> FieldTrialRefKey;
 
+  // Returns the params of |field_trial|, published on it if possible.
+  // Otherwise, they're resolved on each call, into |*unpublished|.
+  const FieldTrial::ParamsSnapshot* GetParamsSnapshot(
+      FieldTrial* field_trial,
+      std::unique_ptr<FieldTrial::ParamsSnapshot>* unpublished);
+
   Lock lock_;
   std::map<FieldTrialKey, FieldTrialParams> field_trial_params_;
 };
@@ -105,24 +105,23 @@ bool GetFieldTrialParamsByFeature(const Feature& feature,
 
 std::string GetFieldTrialParamValue(const std::string& trial_name,
                                     const std::string& param_name) {
-  FieldTrialParams params;
-  if (GetFieldTrialParams(trial_name, &params)) {
-    auto it = params.find(param_name);
-    if (it != params.end())
-      return it->second;
-  }
-  return std::string();
+  FieldTrial* trial = FieldTrialList::Find(trial_name);
+  std::string value;
+  FieldTrialParamAssociator::GetInstance()->GetFieldTrialParamValue(
+      trial, param_name, &value);
+  return value;
 }
 
 std::string GetFieldTrialParamValueByFeature(const Feature& feature,
                                              const std::string& param_name) {
-  FieldTrialParams params;
-  if (GetFieldTrialParamsByFeature(feature, &params)) {
-    auto it = params.find(param_name);
-    if (it != params.end())
-      return it->second;
-  }
-  return std::string();
+  if (!FeatureList::IsEnabled(feature))
+    return std::string();
+
+  FieldTrial* trial = FeatureList::GetFieldTrial(feature);
+  std::string value;
+  FieldTrialParamAssociator::GetInstance()->GetFieldTrialParamValue(
+      trial, param_name, &value);
+  return value;
 }
 
 int GetFieldTrialParamByFeatureAsInt(const Feature& feature,
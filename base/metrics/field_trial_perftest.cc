@@ -0,0 +1,91 @@
+// Copyright 2022 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include <stddef.h>
+
+#include <map>
+#include <string>
+
+#include "base/metrics/field_trial.h"
+#include "base/metrics/field_trial_param_associator.h"
+#include "base/metrics/field_trial_params.h"
+#include "base/strings/stringprintf.h"
+#include "base/test/scoped_field_trial_list_resetter.h"
+#include "base/time/time.h"
+#include "testing/gtest/include/gtest/gtest.h"
+#include "testing/perf/perf_result_reporter.h"
+
+namespace base {
+
+namespace {
+
+constexpr int kNumTrials = 1000;
+constexpr int kNumParams = 8;
+constexpr size_t kCount = 1000000;
+
+constexpr char kMetricPrefixFieldTrial[] = "FieldTrial.";
+constexpr char kMetricOperationTime[] = "operation_time";
+
+perf_test::PerfResultReporter SetUpReporter(const std::string& story_name) {
+  perf_test::PerfResultReporter reporter(kMetricPrefixFieldTrial, story_name);
+  reporter.RegisterImportantMetric(kMetricOperationTime, "ns");
+  return reporter;
+}
+
+class FieldTrialPerfTest : public testing::Test {
+ protected:
+  FieldTrialPerfTest() : field_trial_list_(nullptr) {
+    for (int i = 0; i < kNumTrials; ++i) {
+      const std::string trial_name = StringPrintf("Trial%d", i);
+      std::map<std::string, std::string> params;
+      for (int j = 0; j < kNumParams; ++j)
+        params[StringPrintf("param%d", j)] = StringPrintf("%d", j);
+      AssociateFieldTrialParams(trial_name, "Group", params);
+      FieldTrialList::CreateFieldTrial(trial_name, "Group");
+    }
+  }
+
+  ~FieldTrialPerfTest() override {
+    FieldTrialParamAssociator::GetInstance()->ClearAllParamsForTesting();
+  }
+
+  void Report(const std::string& story_name, TimeDelta elapsed) {
+    SetUpReporter(story_name)
+        .AddResult(kMetricOperationTime,
+                   static_cast<double>(elapsed.InNanoseconds()) / kCount);
+  }
+
+ private:
+  test::ScopedFieldTrialListResetter trial_list_resetter_;
+  FieldTrialList field_trial_list_;
+};
+
+}  // namespace
+
+TEST_F(FieldTrialPerfTest, Find) {
+  const std::string trial_name = StringPrintf("Trial%d", kNumTrials / 2);
+  size_t num_found = 0;
+  const TimeTicks start = TimeTicks::Now();
+  for (size_t i = 0; i < kCount; ++i) {
+    if (FieldTrialList::Find(trial_name))
+      ++num_found;
+  }
+  Report("find", TimeTicks::Now() - start);
+  EXPECT_EQ(num_found, kCount);
+}
+
+TEST_F(FieldTrialPerfTest, GetFieldTrialParamValue) {
+  const std::string trial_name = StringPrintf("Trial%d", kNumTrials / 2);
+  const std::string param_name = StringPrintf("param%d", kNumParams / 2);
+  size_t num_found = 0;
+  const TimeTicks start = TimeTicks::Now();
+  for (size_t i = 0; i < kCount; ++i) {
+    if (!GetFieldTrialParamValue(trial_name, param_name).empty())
+      ++num_found;
+  }
+  Report("get_field_trial_param_value", TimeTicks::Now() - start);
+  EXPECT_EQ(num_found, kCount);
+}
+
+}  // namespace base
@@ -1299,6 +1299,61 @@ TEST_F(FieldTrialListTest, AssociateFieldTrialParams) {
   EXPECT_EQ(2U, new_params.size());
 }
 
+TEST_F(FieldTrialListTest, FindManyTrials) {
+  FieldTrialList field_trial_list(nullptr);
+
+  // Enough trials to replace the first table of trials.
+  constexpr int kNumTrials = 1000;
+  for (int i = 0; i < kNumTrials; ++i) {
+    FieldTrialList::CreateFieldTrial(StringPrintf("Trial%d", i), "Group");
+    ASSERT_TRUE(FieldTrialList::Find(StringPrintf("Trial%d", i / 2)));
+  }
+  for (int i = 0; i < kNumTrials; ++i) {
+    FieldTrial* trial = FieldTrialList::Find(StringPrintf("Trial%d", i));
+    ASSERT_TRUE(trial);
+    EXPECT_EQ(StringPrintf("Trial%d", i), trial->trial_name());
+  }
+  EXPECT_FALSE(FieldTrialList::Find("Trial"));
+  EXPECT_FALSE(FieldTrialList::Find(StringPrintf("Trial%d", kNumTrials)));
+}
+
+TEST_F(FieldTrialListTest, GetParamValueFromSharedMemory) {
+  std::string trial_name("Trial1");
+  std::string group_name("Group1");
+
+  base::ReadOnlySharedMemoryRegion shm_region;
+  {
+    FieldTrialList field_trial_list1(nullptr);
+    FieldTrialList::CreateFieldTrial(trial_name, group_name);
+    std::map<std::string, std::string> params;
+    params["key1"] = "value1";
+    params["key2"] = "value2";
+    FieldTrialParamAssociator::GetInstance()->AssociateFieldTrialParams(
+        trial_name, group_name, params);
+    FieldTrialList::InstantiateFieldTrialAllocatorIfNeeded();
+    shm_region = FieldTrialList::DuplicateFieldTrialSharedMemoryForTesting();
+    ASSERT_TRUE(shm_region.IsValid());
+  }
+  // As in a child process, which only has the params in shared memory.
+  FieldTrialParamAssociator::GetInstance()->ClearAllCachedParamsForTesting();
+
+  FieldTrialList field_trial_list2(nullptr);
+  // 4 KiB is enough to hold the trials only created for this test.
+  base::ReadOnlySharedMemoryMapping shm_mapping = shm_region.MapAt(0, 4 << 10);
+  ASSERT_TRUE(shm_mapping.IsValid());
+  FieldTrialList::CreateTrialsFromSharedMemoryMapping(std::move(shm_mapping));
+
+  // Read twice, once the params were published.
+  for (int i = 0; i < 2; ++i) {
+    EXPECT_EQ("value1", GetFieldTrialParamValue(trial_name, "key1"));
+    EXPECT_EQ("value2", GetFieldTrialParamValue(trial_name, "key2"));
+    EXPECT_EQ("", GetFieldTrialParamValue(trial_name, "key3"));
+    std::map<std::string, std::string> params;
+    EXPECT_TRUE(GetFieldTrialParams(trial_name, &params));
+    EXPECT_EQ(2U, params.size());
+  }
+}
+
 TEST_F(FieldTrialListTest, ClearParamsFromSharedMemory) {
   std::string trial_name("Trial1");
   std::string group_name("Group1");
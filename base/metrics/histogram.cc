@@ -524,7 +524,10 @@ void Histogram::AddCount(int value, int count) {
     NOTREACHED();
     return;
   }
-  unlogged_samples_->Accumulate(value, count);
+  if (flags() & kShardedSamples)
+    unlogged_samples_->AccumulateSharded(value, count);
+  else
+    unlogged_samples_->Accumulate(value, count);
 
   if (UNLIKELY(StatisticsRecorder::have_active_callbacks()))
     FindAndRunCallbacks(value);
@@ -567,6 +570,13 @@ std::unique_ptr<HistogramSamples> Histogram::SnapshotFinalDelta() const {
   return SnapshotUnloggedSamples();
 }
 
+bool Histogram::HasUnloggedSamples() const {
+  // The samples of the shards aren't counted until they're folded in.
+  if (flags() & kShardedSamples)
+    unlogged_samples_->FoldShards();
+  return unlogged_samples_->redundant_count() != 0;
+}
+
 void Histogram::AddSamples(const HistogramSamples& samples) {
   unlogged_samples_->Add(samples);
 }
@@ -662,6 +672,8 @@ std::unique_ptr<SampleVector> Histogram::SnapshotAllSamples() const {
 }
 
 std::unique_ptr<SampleVector> Histogram::SnapshotUnloggedSamples() const {
+  // The sharded samples are only seen once folded, which all the snapshots do.
+  unlogged_samples_->FoldShards();
   std::unique_ptr<SampleVector> samples(
       new SampleVector(unlogged_samples_->id(), bucket_ranges()));
   samples->Add(*unlogged_samples_);
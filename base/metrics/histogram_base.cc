@@ -15,6 +15,7 @@
 #include "base/metrics/histogram.h"
 #include "base/metrics/histogram_macros.h"
 #include "base/metrics/histogram_samples.h"
+#include "base/metrics/quantile_histogram.h"
 #include "base/metrics/sparse_histogram.h"
 #include "base/metrics/statistics_recorder.h"
 #include "base/no_destructor.h"
@@ -43,6 +44,8 @@ std::string HistogramTypeToString(HistogramType type) {
       return "SPARSE_HISTOGRAM";
     case DUMMY_HISTOGRAM:
       return "DUMMY_HISTOGRAM";
+    case QUANTILE_HISTOGRAM:
+      return "QUANTILE_HISTOGRAM";
   }
   NOTREACHED();
   return "UNKNOWN";
@@ -64,6 +67,8 @@ HistogramBase* DeserializeHistogramInfo(PickleIterator* iter) {
       return CustomHistogram::DeserializeInfoImpl(iter);
     case SPARSE_HISTOGRAM:
       return SparseHistogram::DeserializeInfoImpl(iter);
+    case QUANTILE_HISTOGRAM:
+      return QuantileHistogram::DeserializeInfoImpl(iter);
     default:
       return nullptr;
   }
@@ -153,6 +158,10 @@ uint32_t HistogramBase::FindCorruption(const HistogramSamples& samples) const {
   return NO_INCONSISTENCIES;
 }
 
+bool HistogramBase::HasUnloggedSamples() const {
+  return true;
+}
+
 void HistogramBase::ValidateHistogramContents() const {}
 
 void HistogramBase::WriteJSON(std::string* output,
@@ -39,6 +39,7 @@ enum HistogramType {
   CUSTOM_HISTOGRAM,
   SPARSE_HISTOGRAM,
   DUMMY_HISTOGRAM,
+  QUANTILE_HISTOGRAM,
 };
 
 // Controls the verbosity of the information when the histogram is serialized to
@@ -130,6 +131,15 @@ class BASE_EXPORT HistogramBase {
     // MemoryAllocator, and that loaded into the Histogram module before this
     // histogram is created.
     kIsPersistent = 0x40,
+
+    // Indicates that the samples of this histogram are counted in per-CPU
+    // shards, which snapshots fold into its samples: for the histograms that
+    // many threads record into at once, which would otherwise contend for the
+    // cache lines of the same counts. It costs memory for each CPU, and only
+    // applies to the histograms with buckets, not to sparse ones. The shards
+    // of a persistent histogram are in the heap of the recording process, so
+    // other processes see their samples once that process took a snapshot.
+    kShardedSamples = 0x80,
   };
 
   // Histogram data inconsistency types.
@@ -249,6 +259,13 @@ class BASE_EXPORT HistogramBase {
   // See additional caveats by SnapshotSamples().
   virtual std::unique_ptr<HistogramSamples> SnapshotFinalDelta() const = 0;
 
+  // Returns whether samples may have been recorded since the previous call to
+  // SnapshotDelta(), so that the callers which snapshot many histograms, most
+  // of them idle, can skip the others. It's a read of the count of unlogged
+  // samples, which is in persistent memory for the histograms there, so it
+  // also sees the samples recorded by other processes. The default is true.
+  virtual bool HasUnloggedSamples() const;
+
   // The following method provides graphical histogram displays.
   virtual void WriteAscii(std::string* output) const;
 
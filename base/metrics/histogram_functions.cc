@@ -4,6 +4,8 @@
 
 #include "base/metrics/histogram_functions.h"
 
+#include <utility>
+
 #include "base/metrics/histogram.h"
 #include "base/metrics/histogram_base.h"
 #include "base/metrics/sparse_histogram.h"
@@ -11,6 +13,10 @@
 
 namespace base {
 
+HistogramHandle::HistogramHandle(std::string name) : name_(std::move(name)) {}
+
+HistogramHandle::~HistogramHandle() = default;
+
 void UmaHistogramBoolean(const std::string& name, bool sample) {
   HistogramBase* histogram = BooleanHistogram::FactoryGet(
       name, HistogramBase::kUmaTargetedHistogramFlag);
@@ -23,6 +29,14 @@ void UmaHistogramBoolean(const char* name, bool sample) {
   histogram->Add(sample);
 }
 
+void UmaHistogramBoolean(HistogramHandle& handle, bool sample) {
+  HistogramBase* histogram = handle.Get([](const std::string& name) {
+    return BooleanHistogram::FactoryGet(
+        name, HistogramBase::kUmaTargetedHistogramFlag);
+  });
+  histogram->Add(sample);
+}
+
 void UmaHistogramExactLinear(const std::string& name,
                              int sample,
                              int exclusive_max) {
@@ -39,6 +53,17 @@ void UmaHistogramExactLinear(const char* name, int sample, int exclusive_max) {
   histogram->Add(sample);
 }
 
+void UmaHistogramExactLinear(HistogramHandle& handle,
+                             int sample,
+                             int exclusive_max) {
+  HistogramBase* histogram = handle.Get([&](const std::string& name) {
+    return LinearHistogram::FactoryGet(
+        name, 1, exclusive_max, exclusive_max + 1,
+        HistogramBase::kUmaTargetedHistogramFlag);
+  });
+  histogram->Add(sample);
+}
+
 void UmaHistogramPercentage(const std::string& name, int percent) {
   UmaHistogramExactLinear(name, percent, 101);
 }
@@ -47,6 +72,10 @@ void UmaHistogramPercentage(const char* name, int percent) {
   UmaHistogramExactLinear(name, percent, 101);
 }
 
+void UmaHistogramPercentage(HistogramHandle& handle, int percent) {
+  UmaHistogramExactLinear(handle, percent, 101);
+}
+
 void UmaHistogramPercentageObsoleteDoNotUse(const std::string& name,
                                             int percent) {
   UmaHistogramExactLinear(name, percent, 100);
@@ -78,6 +107,18 @@ void UmaHistogramCustomCounts(const char* name,
   histogram->Add(sample);
 }
 
+void UmaHistogramCustomCounts(HistogramHandle& handle,
+                              int sample,
+                              int min,
+                              int exclusive_max,
+                              int buckets) {
+  HistogramBase* histogram = handle.Get([&](const std::string& name) {
+    return Histogram::FactoryGet(name, min, exclusive_max, buckets,
+                                 HistogramBase::kUmaTargetedHistogramFlag);
+  });
+  histogram->Add(sample);
+}
+
 void UmaHistogramCounts100(const std::string& name, int sample) {
   UmaHistogramCustomCounts(name, sample, 1, 100, 50);
 }
@@ -86,6 +127,10 @@ void UmaHistogramCounts100(const char* name, int sample) {
   UmaHistogramCustomCounts(name, sample, 1, 100, 50);
 }
 
+void UmaHistogramCounts100(HistogramHandle& handle, int sample) {
+  UmaHistogramCustomCounts(handle, sample, 1, 100, 50);
+}
+
 void UmaHistogramCounts1000(const std::string& name, int sample) {
   UmaHistogramCustomCounts(name, sample, 1, 1000, 50);
 }
@@ -94,6 +139,10 @@ void UmaHistogramCounts1000(const char* name, int sample) {
   UmaHistogramCustomCounts(name, sample, 1, 1000, 50);
 }
 
+void UmaHistogramCounts1000(HistogramHandle& handle, int sample) {
+  UmaHistogramCustomCounts(handle, sample, 1, 1000, 50);
+}
+
 void UmaHistogramCounts10000(const std::string& name, int sample) {
   UmaHistogramCustomCounts(name, sample, 1, 10000, 50);
 }
@@ -102,6 +151,10 @@ void UmaHistogramCounts10000(const char* name, int sample) {
   UmaHistogramCustomCounts(name, sample, 1, 10000, 50);
 }
 
+void UmaHistogramCounts10000(HistogramHandle& handle, int sample) {
+  UmaHistogramCustomCounts(handle, sample, 1, 10000, 50);
+}
+
 void UmaHistogramCounts100000(const std::string& name, int sample) {
   UmaHistogramCustomCounts(name, sample, 1, 100000, 50);
 }
@@ -110,6 +163,10 @@ void UmaHistogramCounts100000(const char* name, int sample) {
   UmaHistogramCustomCounts(name, sample, 1, 100000, 50);
 }
 
+void UmaHistogramCounts100000(HistogramHandle& handle, int sample) {
+  UmaHistogramCustomCounts(handle, sample, 1, 100000, 50);
+}
+
 void UmaHistogramCounts1M(const std::string& name, int sample) {
   UmaHistogramCustomCounts(name, sample, 1, 1000000, 50);
 }
@@ -118,6 +175,10 @@ void UmaHistogramCounts1M(const char* name, int sample) {
   UmaHistogramCustomCounts(name, sample, 1, 1000000, 50);
 }
 
+void UmaHistogramCounts1M(HistogramHandle& handle, int sample) {
+  UmaHistogramCustomCounts(handle, sample, 1, 1000000, 50);
+}
+
 void UmaHistogramCounts10M(const std::string& name, int sample) {
   UmaHistogramCustomCounts(name, sample, 1, 10000000, 50);
 }
@@ -126,6 +187,10 @@ void UmaHistogramCounts10M(const char* name, int sample) {
   UmaHistogramCustomCounts(name, sample, 1, 10000000, 50);
 }
 
+void UmaHistogramCounts10M(HistogramHandle& handle, int sample) {
+  UmaHistogramCustomCounts(handle, sample, 1, 10000000, 50);
+}
+
 void UmaHistogramCustomTimes(const std::string& name,
                              TimeDelta sample,
                              TimeDelta min,
@@ -146,6 +211,18 @@ void UmaHistogramCustomTimes(const char* name,
   histogram->AddTimeMillisecondsGranularity(sample);
 }
 
+void UmaHistogramCustomTimes(HistogramHandle& handle,
+                             TimeDelta sample,
+                             TimeDelta min,
+                             TimeDelta max,
+                             int buckets) {
+  HistogramBase* histogram = handle.Get([&](const std::string& name) {
+    return Histogram::FactoryTimeGet(name, min, max, buckets,
+                                     HistogramBase::kUmaTargetedHistogramFlag);
+  });
+  histogram->AddTimeMillisecondsGranularity(sample);
+}
+
 void UmaHistogramTimes(const std::string& name, TimeDelta sample) {
   UmaHistogramCustomTimes(name, sample, Milliseconds(1), Seconds(10), 50);
 }
@@ -154,6 +231,10 @@ void UmaHistogramTimes(const char* name, TimeDelta sample) {
   UmaHistogramCustomTimes(name, sample, Milliseconds(1), Seconds(10), 50);
 }
 
+void UmaHistogramTimes(HistogramHandle& handle, TimeDelta sample) {
+  UmaHistogramCustomTimes(handle, sample, Milliseconds(1), Seconds(10), 50);
+}
+
 void UmaHistogramMediumTimes(const std::string& name, TimeDelta sample) {
   UmaHistogramCustomTimes(name, sample, Milliseconds(1), Minutes(3), 50);
 }
@@ -162,6 +243,10 @@ void UmaHistogramMediumTimes(const char* name, TimeDelta sample) {
   UmaHistogramCustomTimes(name, sample, Milliseconds(1), Minutes(3), 50);
 }
 
+void UmaHistogramMediumTimes(HistogramHandle& handle, TimeDelta sample) {
+  UmaHistogramCustomTimes(handle, sample, Milliseconds(1), Minutes(3), 50);
+}
+
 void UmaHistogramLongTimes(const std::string& name, TimeDelta sample) {
   UmaHistogramCustomTimes(name, sample, Milliseconds(1), Hours(1), 50);
 }
@@ -170,6 +255,10 @@ void UmaHistogramLongTimes(const char* name, TimeDelta sample) {
   UmaHistogramCustomTimes(name, sample, Milliseconds(1), Hours(1), 50);
 }
 
+void UmaHistogramLongTimes(HistogramHandle& handle, TimeDelta sample) {
+  UmaHistogramCustomTimes(handle, sample, Milliseconds(1), Hours(1), 50);
+}
+
 void UmaHistogramLongTimes100(const std::string& name, TimeDelta sample) {
   UmaHistogramCustomTimes(name, sample, Milliseconds(1), Hours(1), 100);
 }
@@ -178,6 +267,10 @@ void UmaHistogramLongTimes100(const char* name, TimeDelta sample) {
   UmaHistogramCustomTimes(name, sample, Milliseconds(1), Hours(1), 100);
 }
 
+void UmaHistogramLongTimes100(HistogramHandle& handle, TimeDelta sample) {
+  UmaHistogramCustomTimes(handle, sample, Milliseconds(1), Hours(1), 100);
+}
+
 void UmaHistogramCustomMicrosecondsTimes(const std::string& name,
                                          TimeDelta sample,
                                          TimeDelta min,
@@ -198,6 +291,18 @@ void UmaHistogramCustomMicrosecondsTimes(const char* name,
   histogram->AddTimeMicrosecondsGranularity(sample);
 }
 
+void UmaHistogramCustomMicrosecondsTimes(HistogramHandle& handle,
+                                         TimeDelta sample,
+                                         TimeDelta min,
+                                         TimeDelta max,
+                                         int buckets) {
+  HistogramBase* histogram = handle.Get([&](const std::string& name) {
+    return Histogram::FactoryMicrosecondsTimeGet(
+        name, min, max, buckets, HistogramBase::kUmaTargetedHistogramFlag);
+  });
+  histogram->AddTimeMicrosecondsGranularity(sample);
+}
+
 void UmaHistogramMicrosecondsTimes(const std::string& name, TimeDelta sample) {
   UmaHistogramCustomMicrosecondsTimes(name, sample, Microseconds(1),
                                       Seconds(10), 50);
@@ -208,6 +313,11 @@ void UmaHistogramMicrosecondsTimes(const char* name, TimeDelta sample) {
                                       Seconds(10), 50);
 }
 
+void UmaHistogramMicrosecondsTimes(HistogramHandle& handle, TimeDelta sample) {
+  UmaHistogramCustomMicrosecondsTimes(handle, sample, Microseconds(1),
+                                      Seconds(10), 50);
+}
+
 void UmaHistogramMemoryKB(const std::string& name, int sample) {
   UmaHistogramCustomCounts(name, sample, 1000, 500000, 50);
 }
@@ -216,6 +326,10 @@ void UmaHistogramMemoryKB(const char* name, int sample) {
   UmaHistogramCustomCounts(name, sample, 1000, 500000, 50);
 }
 
+void UmaHistogramMemoryKB(HistogramHandle& handle, int sample) {
+  UmaHistogramCustomCounts(handle, sample, 1000, 500000, 50);
+}
+
 void UmaHistogramMemoryMB(const std::string& name, int sample) {
   UmaHistogramCustomCounts(name, sample, 1, 1000, 50);
 }
@@ -224,6 +338,10 @@ void UmaHistogramMemoryMB(const char* name, int sample) {
   UmaHistogramCustomCounts(name, sample, 1, 1000, 50);
 }
 
+void UmaHistogramMemoryMB(HistogramHandle& handle, int sample) {
+  UmaHistogramCustomCounts(handle, sample, 1, 1000, 50);
+}
+
 void UmaHistogramMemoryLargeMB(const std::string& name, int sample) {
   UmaHistogramCustomCounts(name, sample, 1, 64000, 100);
 }
@@ -232,6 +350,10 @@ void UmaHistogramMemoryLargeMB(const char* name, int sample) {
   UmaHistogramCustomCounts(name, sample, 1, 64000, 100);
 }
 
+void UmaHistogramMemoryLargeMB(HistogramHandle& handle, int sample) {
+  UmaHistogramCustomCounts(handle, sample, 1, 64000, 100);
+}
+
 void UmaHistogramSparse(const std::string& name, int sample) {
   HistogramBase* histogram = SparseHistogram::FactoryGet(
       name, HistogramBase::kUmaTargetedHistogramFlag);
@@ -244,4 +366,12 @@ void UmaHistogramSparse(const char* name, int sample) {
   histogram->Add(sample);
 }
 
+void UmaHistogramSparse(HistogramHandle& handle, int sample) {
+  HistogramBase* histogram = handle.Get([](const std::string& name) {
+    return SparseHistogram::FactoryGet(
+        name, HistogramBase::kUmaTargetedHistogramFlag);
+  });
+  histogram->Add(sample);
+}
+
 }  // namespace base
@@ -5,6 +5,7 @@
 #ifndef BASE_METRICS_HISTOGRAM_FUNCTIONS_H_
 #define BASE_METRICS_HISTOGRAM_FUNCTIONS_H_
 
+#include <atomic>
 #include <string>
 #include <type_traits>
 
@@ -27,9 +28,58 @@
 // Every function is duplicated to take both std::string and char* for the name.
 // This avoids ctor/dtor instantiation for constant strings to std::string,
 // which makes the call be larger than caching macros (which do accept char*)
-// in those cases.
+// in those cases. Every function also takes a HistogramHandle, which caches
+// the histogram so that the name isn't looked up on each call.
 namespace base {
 
+// A histogram name, and the histogram which the first function it is given
+// to finds or creates. The later calls reuse that histogram without looking
+// up the name, which suits names built at run time, that the macros can't
+// cache:
+//
+//   class Connection {
+//    public:
+//     explicit Connection(const std::string& type)
+//         : latency_histogram_("Net.Connection.Latency." + type) {}
+//
+//     void OnResponse(TimeDelta latency) {
+//       base::UmaHistogramTimes(latency_histogram_, latency);
+//     }
+//
+//    private:
+//     base::HistogramHandle latency_histogram_;
+//   };
+//
+// As with the macros, a handle must always be given to the same function,
+// with the same parameters: the later calls don't check them. A handle can be
+// used on any thread.
+class BASE_EXPORT HistogramHandle {
+ public:
+  explicit HistogramHandle(std::string name);
+  HistogramHandle(const HistogramHandle&) = delete;
+  HistogramHandle& operator=(const HistogramHandle&) = delete;
+  ~HistogramHandle();
+
+  const std::string& name() const { return name_; }
+
+  // Returns the histogram, which is |factory|(name()) the first time. Threads
+  // racing on the first call all call |factory|, which returns the same
+  // registered histogram to each.
+  template <typename Factory>
+  HistogramBase* Get(Factory factory) {
+    HistogramBase* histogram = histogram_.load(std::memory_order_acquire);
+    if (!histogram) {
+      histogram = factory(name_);
+      histogram_.store(histogram, std::memory_order_release);
+    }
+    return histogram;
+  }
+
+ private:
+  const std::string name_;
+  std::atomic<HistogramBase*> histogram_{nullptr};
+};
+
 // For numeric measurements where you want exact integer values up to
 // |exclusive_max|. |exclusive_max| itself is included in the overflow bucket.
 // Therefore, if you want an accurate measure up to kMax, then |exclusive_max|
@@ -48,6 +98,9 @@ BASE_EXPORT void UmaHistogramExactLinear(const std::string& name,
 BASE_EXPORT void UmaHistogramExactLinear(const char* name,
                                          int sample,
                                          int exclusive_max);
+BASE_EXPORT void UmaHistogramExactLinear(HistogramHandle& handle,
+                                         int sample,
+                                         int exclusive_max);
 
 // For adding a sample to an enumerated histogram.
 // Sample usage:
@@ -90,6 +143,20 @@ void UmaHistogramEnumeration(const char* name, T sample) {
                                  static_cast<int>(T::kMaxValue) + 1);
 }
 
+template <typename T>
+void UmaHistogramEnumeration(HistogramHandle& handle, T sample) {
+  static_assert(std::is_enum<T>::value, "T is not an enum.");
+  // This also ensures that an enumeration that doesn't define kMaxValue fails
+  // with a semi-useful error ("no member named 'kMaxValue' in ...").
+  static_assert(static_cast<uintmax_t>(T::kMaxValue) <=
+                    static_cast<uintmax_t>(INT_MAX) - 1,
+                "Enumeration's kMaxValue is out of range of INT_MAX!");
+  DCHECK_LE(static_cast<uintmax_t>(sample),
+            static_cast<uintmax_t>(T::kMaxValue));
+  return UmaHistogramExactLinear(handle, static_cast<int>(sample),
+                                 static_cast<int>(T::kMaxValue) + 1);
+}
+
 // Some legacy histograms may manually specify the enum size, with a kCount,
 // COUNT, kMaxValue, or MAX_VALUE sentinel like so:
 //   // These values are persisted to logs. Entries should not be renumbered and
@@ -124,11 +191,21 @@ void UmaHistogramEnumeration(const char* name, T sample, T enum_size) {
                                  static_cast<int>(enum_size));
 }
 
+template <typename T>
+void UmaHistogramEnumeration(HistogramHandle& handle, T sample, T enum_size) {
+  static_assert(std::is_enum<T>::value, "T is not an enum.");
+  DCHECK_LE(static_cast<uintmax_t>(enum_size), static_cast<uintmax_t>(INT_MAX));
+  DCHECK_LT(static_cast<uintmax_t>(sample), static_cast<uintmax_t>(enum_size));
+  return UmaHistogramExactLinear(handle, static_cast<int>(sample),
+                                 static_cast<int>(enum_size));
+}
+
 // For adding boolean sample to histogram.
 // Sample usage:
 //   base::UmaHistogramBoolean("My.Boolean", true)
 BASE_EXPORT void UmaHistogramBoolean(const std::string& name, bool sample);
 BASE_EXPORT void UmaHistogramBoolean(const char* name, bool sample);
+BASE_EXPORT void UmaHistogramBoolean(HistogramHandle& handle, bool sample);
 
 // For adding histogram sample denoting a percentage.
 // Percents are integers between 1 and 100, inclusively.
@@ -136,6 +213,7 @@ BASE_EXPORT void UmaHistogramBoolean(const char* name, bool sample);
 //   base::UmaHistogramPercentage("My.Percent", 69)
 BASE_EXPORT void UmaHistogramPercentage(const std::string& name, int percent);
 BASE_EXPORT void UmaHistogramPercentage(const char* name, int percent);
+BASE_EXPORT void UmaHistogramPercentage(HistogramHandle& handle, int percent);
 
 // Obsolete. Use |UmaHistogramPercentage| instead. See crbug/1121318.
 BASE_EXPORT void UmaHistogramPercentageObsoleteDoNotUse(const std::string& name,
@@ -156,20 +234,31 @@ BASE_EXPORT void UmaHistogramCustomCounts(const char* name,
                                           int min,
                                           int exclusive_max,
                                           int buckets);
+BASE_EXPORT void UmaHistogramCustomCounts(HistogramHandle& handle,
+                                          int sample,
+                                          int min,
+                                          int exclusive_max,
+                                          int buckets);
 
 // Counts specialization for maximum counts 100, 1000, 10k, 100k, 1M and 10M.
 BASE_EXPORT void UmaHistogramCounts100(const std::string& name, int sample);
 BASE_EXPORT void UmaHistogramCounts100(const char* name, int sample);
+BASE_EXPORT void UmaHistogramCounts100(HistogramHandle& handle, int sample);
 BASE_EXPORT void UmaHistogramCounts1000(const std::string& name, int sample);
 BASE_EXPORT void UmaHistogramCounts1000(const char* name, int sample);
+BASE_EXPORT void UmaHistogramCounts1000(HistogramHandle& handle, int sample);
 BASE_EXPORT void UmaHistogramCounts10000(const std::string& name, int sample);
 BASE_EXPORT void UmaHistogramCounts10000(const char* name, int sample);
+BASE_EXPORT void UmaHistogramCounts10000(HistogramHandle& handle, int sample);
 BASE_EXPORT void UmaHistogramCounts100000(const std::string& name, int sample);
 BASE_EXPORT void UmaHistogramCounts100000(const char* name, int sample);
+BASE_EXPORT void UmaHistogramCounts100000(HistogramHandle& handle, int sample);
 BASE_EXPORT void UmaHistogramCounts1M(const std::string& name, int sample);
 BASE_EXPORT void UmaHistogramCounts1M(const char* name, int sample);
+BASE_EXPORT void UmaHistogramCounts1M(HistogramHandle& handle, int sample);
 BASE_EXPORT void UmaHistogramCounts10M(const std::string& name, int sample);
 BASE_EXPORT void UmaHistogramCounts10M(const char* name, int sample);
+BASE_EXPORT void UmaHistogramCounts10M(HistogramHandle& handle, int sample);
 
 // For histograms storing times. It uses milliseconds granularity.
 BASE_EXPORT void UmaHistogramCustomTimes(const std::string& name,
@@ -182,22 +271,34 @@ BASE_EXPORT void UmaHistogramCustomTimes(const char* name,
                                          TimeDelta min,
                                          TimeDelta max,
                                          int buckets);
+BASE_EXPORT void UmaHistogramCustomTimes(HistogramHandle& handle,
+                                         TimeDelta sample,
+                                         TimeDelta min,
+                                         TimeDelta max,
+                                         int buckets);
 // For short timings from 1 ms up to 10 seconds (50 buckets).
 BASE_EXPORT void UmaHistogramTimes(const std::string& name, TimeDelta sample);
 BASE_EXPORT void UmaHistogramTimes(const char* name, TimeDelta sample);
+BASE_EXPORT void UmaHistogramTimes(HistogramHandle& handle, TimeDelta sample);
 // For medium timings up to 3 minutes (50 buckets).
 BASE_EXPORT void UmaHistogramMediumTimes(const std::string& name,
                                          TimeDelta sample);
 BASE_EXPORT void UmaHistogramMediumTimes(const char* name, TimeDelta sample);
+BASE_EXPORT void UmaHistogramMediumTimes(HistogramHandle& handle,
+                                         TimeDelta sample);
 // For time intervals up to 1 hr (50 buckets).
 BASE_EXPORT void UmaHistogramLongTimes(const std::string& name,
                                        TimeDelta sample);
 BASE_EXPORT void UmaHistogramLongTimes(const char* name, TimeDelta sample);
+BASE_EXPORT void UmaHistogramLongTimes(HistogramHandle& handle,
+                                       TimeDelta sample);
 
 // For time intervals up to 1 hr (100 buckets).
 BASE_EXPORT void UmaHistogramLongTimes100(const std::string& name,
                                           TimeDelta sample);
 BASE_EXPORT void UmaHistogramLongTimes100(const char* name, TimeDelta sample);
+BASE_EXPORT void UmaHistogramLongTimes100(HistogramHandle& handle,
+                                          TimeDelta sample);
 
 // For histograms storing times with microseconds granularity.
 BASE_EXPORT void UmaHistogramCustomMicrosecondsTimes(const std::string& name,
@@ -210,23 +311,33 @@ BASE_EXPORT void UmaHistogramCustomMicrosecondsTimes(const char* name,
                                                      TimeDelta min,
                                                      TimeDelta max,
                                                      int buckets);
+BASE_EXPORT void UmaHistogramCustomMicrosecondsTimes(HistogramHandle& handle,
+                                                     TimeDelta sample,
+                                                     TimeDelta min,
+                                                     TimeDelta max,
+                                                     int buckets);
 
 // For microseconds timings from 1 microsecond up to 10 seconds (50 buckets).
 BASE_EXPORT void UmaHistogramMicrosecondsTimes(const std::string& name,
                                                TimeDelta sample);
 BASE_EXPORT void UmaHistogramMicrosecondsTimes(const char* name,
                                                TimeDelta sample);
+BASE_EXPORT void UmaHistogramMicrosecondsTimes(HistogramHandle& handle,
+                                               TimeDelta sample);
 
 // For recording memory related histograms.
 // Used to measure common KB-granularity memory stats. Range is up to 500M.
 BASE_EXPORT void UmaHistogramMemoryKB(const std::string& name, int sample);
 BASE_EXPORT void UmaHistogramMemoryKB(const char* name, int sample);
+BASE_EXPORT void UmaHistogramMemoryKB(HistogramHandle& handle, int sample);
 // Used to measure common MB-granularity memory stats. Range is up to ~1G.
 BASE_EXPORT void UmaHistogramMemoryMB(const std::string& name, int sample);
 BASE_EXPORT void UmaHistogramMemoryMB(const char* name, int sample);
+BASE_EXPORT void UmaHistogramMemoryMB(HistogramHandle& handle, int sample);
 // Used to measure common MB-granularity memory stats. Range is up to ~64G.
 BASE_EXPORT void UmaHistogramMemoryLargeMB(const std::string& name, int sample);
 BASE_EXPORT void UmaHistogramMemoryLargeMB(const char* name, int sample);
+BASE_EXPORT void UmaHistogramMemoryLargeMB(HistogramHandle& handle, int sample);
 
 // For recording sparse histograms.
 // The |sample| can be a negative or non-negative number.
@@ -257,6 +368,7 @@ BASE_EXPORT void UmaHistogramMemoryLargeMB(const char* name, int sample);
 //   UmaHistogramSparse("My.Histogram", base::clamp(value, 0, 200));
 BASE_EXPORT void UmaHistogramSparse(const std::string& name, int sample);
 BASE_EXPORT void UmaHistogramSparse(const char* name, int sample);
+BASE_EXPORT void UmaHistogramSparse(HistogramHandle& handle, int sample);
 
 }  // namespace base
 
@@ -157,4 +157,29 @@ TEST(HistogramFunctionsTest, Sparse_SupportsNegativeValues) {
   tester.ExpectUniqueSample(histogram, -1, 1);
 }
 
+TEST(HistogramFunctionsTest, Handle) {
+  HistogramHandle handle("Testing.UMA.HistogramHandle");
+  HistogramTester tester;
+  UmaHistogramTimes(handle, Seconds(1));
+  UmaHistogramTimes(handle, Seconds(1));
+  UmaHistogramTimes(handle, Seconds(9));
+  // Into the same histogram as by name.
+  UmaHistogramTimes(handle.name(), Seconds(9));
+  tester.ExpectTimeBucketCount(handle.name(), Seconds(1), 2);
+  tester.ExpectTimeBucketCount(handle.name(), Seconds(9), 2);
+  tester.ExpectTotalCount(handle.name(), 4);
+}
+
+TEST(HistogramFunctionsTest, HandleEnumeration) {
+  HistogramHandle handle("Testing.UMA.HistogramHandleEnumeration");
+  HistogramTester tester;
+  UmaHistogramEnumeration(handle, UMA_HISTOGRAM_TESTING_ENUM_SECOND,
+                          UMA_HISTOGRAM_TESTING_ENUM_THIRD);
+  UmaHistogramEnumeration(handle, UMA_HISTOGRAM_TESTING_ENUM_FIRST,
+                          UMA_HISTOGRAM_TESTING_ENUM_THIRD);
+  tester.ExpectBucketCount(handle.name(), UMA_HISTOGRAM_TESTING_ENUM_FIRST, 1);
+  tester.ExpectBucketCount(handle.name(), UMA_HISTOGRAM_TESTING_ENUM_SECOND, 1);
+  tester.ExpectTotalCount(handle.name(), 2);
+}
+
 }  // namespace base.
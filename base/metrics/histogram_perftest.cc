@@ -0,0 +1,82 @@
+// Copyright 2022 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "base/metrics/histogram.h"
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include <memory>
+#include <vector>
+
+#include "base/bits.h"
+#include "base/metrics/histogram_base.h"
+#include "base/metrics/statistics_recorder.h"
+#include "base/time/time.h"
+#include "testing/gtest/include/gtest/gtest.h"
+
+namespace base {
+
+namespace {
+
+constexpr size_t kSamples = 1 << 12;
+constexpr size_t kIterations = 10000;
+
+// Prints the time that |histogram| takes to record random samples up to
+// about |maximum|, which make the bucket of each unpredictable. The samples
+// of the exponential histograms have all the magnitudes.
+void Measure(const char* name,
+             HistogramBase* histogram,
+             int maximum,
+             bool exponential) {
+  const uint32_t maximum_bits =
+      32 - bits::CountLeadingZeroBits(static_cast<uint32_t>(maximum));
+  std::vector<int> samples(kSamples);
+  uint32_t state = 1;
+  for (int& sample : samples) {
+    state = state * 1664525 + 1013904223;
+    const uint32_t random = state >> 8;
+    const uint32_t mask = (2u << ((state >> 24) % maximum_bits)) - 1;
+    sample = static_cast<int>(
+        exponential ? random & mask
+                    : random % static_cast<uint32_t>(maximum));
+  }
+  const TimeTicks start = TimeTicks::Now();
+  for (size_t i = 0; i < kIterations; ++i) {
+    for (int sample : samples)
+      histogram->Add(sample);
+  }
+  const TimeDelta time = TimeTicks::Now() - start;
+  printf("%s\tns/sample:\t%.2f\n", name,
+         time.InMicrosecondsF() * 1000 / (kIterations * kSamples));
+}
+
+}  // namespace
+
+TEST(HistogramPerfTest, DISABLED_Add) {
+  std::unique_ptr<StatisticsRecorder> recorder =
+      StatisticsRecorder::CreateTemporaryForTesting();
+  Measure("exponential-50",
+          Histogram::FactoryGet("Exponential50", 1, 10000, 50,
+                                HistogramBase::kNoFlags),
+          10000, /*exponential=*/true);
+  Measure("exponential-100",
+          Histogram::FactoryGet("Exponential100", 1, 1000000, 100,
+                                HistogramBase::kNoFlags),
+          1000000, /*exponential=*/true);
+  Measure("linear-100",
+          LinearHistogram::FactoryGet("Linear100", 1, 1000, 100,
+                                      HistogramBase::kNoFlags),
+          1000, /*exponential=*/false);
+  Measure("exact-linear-101",
+          LinearHistogram::FactoryGet("ExactLinear101", 1, 100, 101,
+                                      HistogramBase::kNoFlags),
+          100, /*exponential=*/false);
+  Measure("sharded-exponential-50",
+          Histogram::FactoryGet("ShardedExponential50", 1, 10000, 50,
+                                HistogramBase::kShardedSamples),
+          10000, /*exponential=*/true);
+}
+
+}  // namespace base
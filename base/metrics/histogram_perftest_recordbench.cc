@@ -0,0 +1,262 @@
+// Copyright 2022 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+// This program measures the time taken to record samples in histograms of
+// each type, to look histograms up, to snapshot them, and to create them in
+// persistent memory, on one thread and with several threads contending for
+// the same histograms. It is for guarding the metrics fast path against
+// regressions.
+//
+// Usage:
+// $ ninja -C out/foobar histogram_perftest_recordbench
+// $ out/foobar/histogram_perftest_recordbench -n=10 -t=4
+//
+// The -n=10 switch controls the number of iterations of each case. It
+// defaults to 1.
+//
+// The -t=4 switch controls the number of threads of the contended cases. It
+// defaults to 4.
+//
+// It prints 1 tab-separated non-comment line per iteration of each case: its
+// name, its number of threads and the average nanoseconds per operation on
+// each thread. Building and running this program before and after a
+// particular commit can work well with the 'ministat' tool:
+// https://github.com/thorduri/ministat
+
+#include <stddef.h>
+#include <stdint.h>
+#include <stdlib.h>
+
+#include <atomic>
+#include <iomanip>
+#include <iostream>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "base/bits.h"
+#include "base/command_line.h"
+#include "base/memory/raw_ptr.h"
+#include "base/metrics/histogram.h"
+#include "base/metrics/histogram_base.h"
+#include "base/metrics/histogram_samples.h"
+#include "base/metrics/persistent_histogram_allocator.h"
+#include "base/metrics/sparse_histogram.h"
+#include "base/metrics/statistics_recorder.h"
+#include "base/strings/string_number_conversions.h"
+#include "base/strings/stringprintf.h"
+#include "base/threading/platform_thread.h"
+#include "base/time/time.h"
+
+namespace base {
+namespace {
+
+constexpr size_t kSamples = 1 << 12;
+
+// Random samples up to about |maximum|, which make the bucket of each
+// unpredictable. Those of |exponential| have all the magnitudes.
+std::vector<int> MakeSamples(int maximum, bool exponential) {
+  const uint32_t maximum_bits =
+      32 - bits::CountLeadingZeroBits(static_cast<uint32_t>(maximum));
+  std::vector<int> samples(kSamples);
+  uint32_t state = 1;
+  for (int& sample : samples) {
+    state = state * 1664525 + 1013904223;
+    const uint32_t random = state >> 8;
+    const uint32_t mask = (2u << ((state >> 24) % maximum_bits)) - 1;
+    sample = static_cast<int>(
+        exponential ? random & mask
+                    : random % static_cast<uint32_t>(maximum + 1));
+  }
+  return samples;
+}
+
+// Runs |body| on each of |threads| threads at once, and returns the average
+// time it took on one.
+template <typename Body>
+TimeDelta RunOnThreads(int threads, const Body& body) {
+  class Runner : public PlatformThread::Delegate {
+   public:
+    Runner(const Body& body, std::atomic<int>* waiting)
+        : body_(body), waiting_(waiting) {}
+
+    void ThreadMain() override {
+      // Start when all the threads are ready.
+      waiting_->fetch_sub(1, std::memory_order_acq_rel);
+      while (waiting_->load(std::memory_order_acquire) > 0) {
+      }
+      const TimeTicks start = TimeTicks::Now();
+      body_();
+      time_ = TimeTicks::Now() - start;
+    }
+
+    TimeDelta time() const { return time_; }
+
+   private:
+    const Body& body_;
+    const raw_ptr<std::atomic<int>> waiting_;
+    TimeDelta time_;
+  };
+
+  std::atomic<int> waiting(threads);
+  std::vector<std::unique_ptr<Runner>> runners;
+  std::vector<PlatformThreadHandle> handles(threads);
+  for (int i = 0; i < threads; ++i) {
+    runners.push_back(std::make_unique<Runner>(body, &waiting));
+    if (!PlatformThread::Create(0, runners.back().get(), &handles[i])) {
+      std::cout << "# could not create a thread" << std::endl;
+      exit(EXIT_FAILURE);
+    }
+  }
+  TimeDelta total;
+  for (int i = 0; i < threads; ++i) {
+    PlatformThread::Join(handles[i]);
+    total += runners[i]->time();
+  }
+  return total / threads;
+}
+
+class Bench {
+ public:
+  Bench(int iterations, int threads)
+      : iterations_(iterations), threads_(threads) {}
+
+  // Prints the time of |operations| by |body|, on one thread and, if
+  // |contended|, on |threads_|.
+  template <typename Body>
+  void Measure(const char* name,
+               size_t operations,
+               bool contended,
+               const Body& body) {
+    for (int threads : {1, threads_}) {
+      if (threads > 1 && !contended)
+        break;
+      for (int i = 0; i < iterations_; ++i) {
+        const TimeDelta time = RunOnThreads(threads, body);
+        std::cout << name << "\t" << threads << "\t" << std::fixed
+                  << std::setprecision(2)
+                  << time.InMicrosecondsF() * 1000 / operations << std::endl;
+      }
+      if (threads_ == 1)
+        break;
+    }
+  }
+
+  // Measures Add() on |histogram|.
+  void MeasureAdd(const char* name,
+                  HistogramBase* histogram,
+                  int maximum,
+                  bool exponential) {
+    const std::vector<int> samples = MakeSamples(maximum, exponential);
+    constexpr size_t kRounds = 256;
+    Measure(name, kRounds * kSamples, /*contended=*/true, [&] {
+      for (size_t round = 0; round < kRounds; ++round) {
+        for (int sample : samples)
+          histogram->Add(sample);
+      }
+    });
+  }
+
+ private:
+  const int iterations_;
+  const int threads_;
+};
+
+void RunBenchmarks(Bench* bench) {
+  std::cout << "# case\tthreads\tns/operation" << std::endl;
+
+  // Recording, in the histograms of the process heap.
+  bench->MeasureAdd("add-exponential-50",
+                    Histogram::FactoryGet("Exponential50", 1, 10000, 50,
+                                          HistogramBase::kNoFlags),
+                    10000, /*exponential=*/true);
+  bench->MeasureAdd("add-linear-100",
+                    LinearHistogram::FactoryGet("Linear100", 1, 1000, 100,
+                                                HistogramBase::kNoFlags),
+                    1000, /*exponential=*/false);
+  bench->MeasureAdd(
+      "add-boolean",
+      BooleanHistogram::FactoryGet("Boolean", HistogramBase::kNoFlags), 1,
+      /*exponential=*/false);
+  bench->MeasureAdd(
+      "add-sparse-1000",
+      SparseHistogram::FactoryGet("Sparse", HistogramBase::kNoFlags), 999,
+      /*exponential=*/false);
+
+  // Looking up existing histograms by name.
+  std::vector<std::string> names;
+  for (int i = 0; i < 1000; ++i) {
+    names.push_back(StringPrintf("FactoryGet.%d", i));
+    Histogram::FactoryGet(names.back(), 1, 10000, 50, HistogramBase::kNoFlags);
+  }
+  constexpr size_t kLookups = 1 << 20;
+  bench->Measure("factory-get", kLookups, /*contended=*/true, [&] {
+    for (size_t i = 0; i < kLookups; ++i) {
+      Histogram::FactoryGet(names[i % names.size()], 1, 10000, 50,
+                            HistogramBase::kNoFlags);
+    }
+  });
+
+  // Snapshotting the delta of a histogram with a new sample, as is done for
+  // uploads. SnapshotDelta() takes one caller at a time.
+  {
+    HistogramBase* histogram = Histogram::FactoryGet(
+        "SnapshotDelta", 1, 1000000, 100, HistogramBase::kNoFlags);
+    const std::vector<int> samples = MakeSamples(1000000, true);
+    constexpr size_t kSnapshots = 1 << 16;
+    bench->Measure("snapshot-delta-100", kSnapshots, /*contended=*/false, [&] {
+      for (size_t i = 0; i < kSnapshots; ++i) {
+        histogram->Add(samples[i % kSamples]);
+        histogram->SnapshotDelta();
+      }
+    });
+  }
+
+  // Creating histograms in persistent memory, and recording in them.
+  GlobalHistogramAllocator::CreateWithLocalMemory(256 << 20, 0,
+                                                  "HistogramPerfTest");
+  std::atomic<int> created(0);
+  constexpr size_t kCreations = 1 << 12;
+  bench->Measure("persistent-create", kCreations, /*contended=*/true, [&] {
+    for (size_t i = 0; i < kCreations; ++i) {
+      Histogram::FactoryGet(
+          StringPrintf("Persistent.%d", created.fetch_add(1)), 1, 10000, 50,
+          HistogramBase::kNoFlags);
+    }
+  });
+  bench->MeasureAdd("add-persistent-exponential-50",
+                    Histogram::FactoryGet("PersistentExponential50", 1, 10000,
+                                          50, HistogramBase::kNoFlags),
+                    10000, /*exponential=*/true);
+  bench->MeasureAdd(
+      "add-persistent-sparse-1000",
+      SparseHistogram::FactoryGet("PersistentSparse", HistogramBase::kNoFlags),
+      999, /*exponential=*/false);
+}
+
+}  // namespace
+}  // namespace base
+
+int main(int argc, char* argv[]) {
+  base::CommandLine::Init(argc, argv);
+  base::CommandLine* command_line = base::CommandLine::ForCurrentProcess();
+  int iterations = 1;
+  std::string iterations_str = command_line->GetSwitchValueASCII("n");
+  if (!iterations_str.empty() &&
+      (!base::StringToInt(iterations_str, &iterations) || iterations < 1)) {
+    std::cout << "# invalid -n command line switch\n";
+    return EXIT_FAILURE;
+  }
+  int threads = 4;
+  std::string threads_str = command_line->GetSwitchValueASCII("t");
+  if (!threads_str.empty() &&
+      (!base::StringToInt(threads_str, &threads) || threads < 1)) {
+    std::cout << "# invalid -t command line switch\n";
+    return EXIT_FAILURE;
+  }
+
+  base::Bench bench(iterations, threads);
+  base::RunBenchmarks(&bench);
+  return EXIT_SUCCESS;
+}
@@ -50,8 +50,11 @@ void HistogramSnapshotManager::PrepareDeltas(
     HistogramBase::Flags required_flags) {
   for (HistogramBase* const histogram : histograms) {
     histogram->SetFlags(flags_to_set);
-    if ((histogram->flags() & required_flags) == required_flags)
+    // The histograms without unlogged samples would have an empty delta.
+    if ((histogram->flags() & required_flags) == required_flags &&
+        histogram->HasUnloggedSamples()) {
       PrepareDelta(histogram);
+    }
   }
 }
 
@@ -41,7 +41,8 @@ class BASE_EXPORT HistogramSnapshotManager final {
   // delta. |flags_to_set| is used to set flags for each histogram.
   // |required_flags| is used to select which histograms to record. Only
   // histograms with all of the required flags are selected. If all histograms
-  // should be recorded, use |Histogram::kNoFlags| as the required flag.
+  // should be recorded, use |Histogram::kNoFlags| as the required flag. The
+  // histograms without unlogged samples aren't snapshotted.
   void PrepareDeltas(const std::vector<HistogramBase*>& histograms,
                      HistogramBase::Flags flags_to_set,
                      HistogramBase::Flags required_flags);
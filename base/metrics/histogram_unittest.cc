@@ -9,6 +9,7 @@
 #include <stdint.h>
 
 #include <climits>
+#include <iterator>
 #include <memory>
 #include <string>
 #include <vector>
@@ -28,6 +29,7 @@
 #include "base/pickle.h"
 #include "base/strings/stringprintf.h"
 #include "base/test/gtest_util.h"
+#include "base/threading/platform_thread.h"
 #include "base/time/time.h"
 #include "base/values.h"
 #include "testing/gmock/include/gmock/gmock.h"
@@ -49,6 +51,23 @@ class TestRecordHistogramChecker : public RecordHistogramChecker {
   }
 };
 
+// Adds |count| samples of |value| to |histogram|, on a thread of its own.
+class HistogramAdder : public PlatformThread::Delegate {
+ public:
+  HistogramAdder(HistogramBase* histogram, int value, int count)
+      : histogram_(histogram), value_(value), count_(count) {}
+
+  void ThreadMain() override {
+    for (int i = 0; i < count_; ++i)
+      histogram_->Add(value_);
+  }
+
+ private:
+  const raw_ptr<HistogramBase> histogram_;
+  const int value_;
+  const int count_;
+};
+
 }  // namespace
 
 // Test parameter indicates if a persistent memory allocator should be used
@@ -207,6 +226,26 @@ TEST_P(HistogramTest, DeltaTest) {
   EXPECT_EQ(0, samples->TotalCount());
 }
 
+TEST_P(HistogramTest, HasUnloggedSamples) {
+  for (int32_t flags :
+       {HistogramBase::kNoFlags, HistogramBase::kShardedSamples}) {
+    HistogramBase* histogram =
+        Histogram::FactoryGet(StringPrintf("UnloggedHistogram%d", flags), 1,
+                              64, 8, flags);
+    EXPECT_FALSE(histogram->HasUnloggedSamples());
+
+    histogram->Add(10);
+    EXPECT_TRUE(histogram->HasUnloggedSamples());
+    EXPECT_EQ(1, histogram->SnapshotDelta()->TotalCount());
+    EXPECT_FALSE(histogram->HasUnloggedSamples());
+
+    histogram->AddCount(20, 3);
+    EXPECT_TRUE(histogram->HasUnloggedSamples());
+    EXPECT_EQ(3, histogram->SnapshotDelta()->TotalCount());
+    EXPECT_FALSE(histogram->HasUnloggedSamples());
+  }
+}
+
 // Check that final-delta calculations work correctly.
 TEST_P(HistogramTest, FinalDeltaTest) {
   HistogramBase* histogram =
@@ -403,6 +442,74 @@ TEST_P(HistogramTest, CustomHistogramWithOnly2Buckets) {
   EXPECT_EQ(HistogramBase::kSampleType_MAX, ranges->range(2));
 }
 
+// Check that the sharded histograms have the same snapshots as the others.
+TEST_P(HistogramTest, ShardedSamplesTest) {
+  HistogramBase* histogram = Histogram::FactoryGet(
+      "ShardedHistogram", 1, 64, 8, HistogramBase::kShardedSamples);
+  HistogramBase* expected_histogram = Histogram::FactoryGet(
+      "UnshardedHistogram", 1, 64, 8, HistogramBase::kNoFlags);
+  EXPECT_TRUE(histogram->flags() & HistogramBase::kShardedSamples);
+
+  for (HistogramBase* h : {histogram, expected_histogram}) {
+    h->Add(1);
+    h->AddCount(10, 3);
+    h->Add(50);
+  }
+  std::unique_ptr<HistogramSamples> samples = histogram->SnapshotDelta();
+  std::unique_ptr<HistogramSamples> expected =
+      expected_histogram->SnapshotDelta();
+  EXPECT_EQ(5, samples->TotalCount());
+  EXPECT_EQ(expected->sum(), samples->sum());
+  EXPECT_EQ(expected->redundant_count(), samples->redundant_count());
+  for (int value : {1, 10, 50})
+    EXPECT_EQ(expected->GetCount(value), samples->GetCount(value));
+  EXPECT_EQ(0, histogram->SnapshotDelta()->TotalCount());
+
+  // A single sample.
+  histogram->Add(20);
+  samples = histogram->SnapshotDelta();
+  EXPECT_EQ(1, samples->TotalCount());
+  EXPECT_EQ(1, samples->GetCount(20));
+  EXPECT_EQ(20, samples->sum());
+}
+
+// Check that the sharded histograms count the samples of concurrent threads,
+// on whichever CPUs they run, and snapshots taken meanwhile.
+TEST_P(HistogramTest, ShardedSamplesThreadsTest) {
+  HistogramBase* histogram = Histogram::FactoryGet(
+      "ShardedThreadsHistogram", 1, 64, 8, HistogramBase::kShardedSamples);
+  // In different buckets.
+  constexpr int kValues[] = {1, 5, 12, 40};
+  constexpr int kThreads = std::size(kValues);
+  constexpr int kSamplesPerThread = 1000;
+  std::vector<std::unique_ptr<HistogramAdder>> adders;
+  std::vector<PlatformThreadHandle> handles(kThreads);
+  for (int i = 0; i < kThreads; ++i) {
+    adders.push_back(std::make_unique<HistogramAdder>(
+        histogram, kValues[i], kSamplesPerThread));
+    ASSERT_TRUE(PlatformThread::Create(0, adders.back().get(), &handles[i]));
+  }
+  // Concurrent snapshots.
+  int64_t total_count = 0;
+  for (int i = 0; i < 10; ++i)
+    total_count += histogram->SnapshotDelta()->TotalCount();
+  for (PlatformThreadHandle handle : handles)
+    PlatformThread::Join(handle);
+
+  total_count += histogram->SnapshotDelta()->TotalCount();
+  EXPECT_EQ(kThreads * kSamplesPerThread, total_count);
+
+  std::unique_ptr<HistogramSamples> samples = histogram->SnapshotSamples();
+  EXPECT_EQ(kThreads * kSamplesPerThread, samples->TotalCount());
+  EXPECT_EQ(samples->TotalCount(), samples->redundant_count());
+  int64_t sum = 0;
+  for (int i = 0; i < kThreads; ++i) {
+    EXPECT_EQ(kSamplesPerThread, samples->GetCount(kValues[i]));
+    sum += int64_t{kValues[i]} * kSamplesPerThread;
+  }
+  EXPECT_EQ(sum, samples->sum());
+}
+
 TEST_P(HistogramTest, AddCountTest) {
   const size_t kBucketCount = 50;
   Histogram* histogram = static_cast<Histogram*>(
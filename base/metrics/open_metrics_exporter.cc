@@ -0,0 +1,135 @@
+// Copyright 2022 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "base/metrics/open_metrics_exporter.h"
+
+#include <stdint.h>
+
+#include <limits>
+#include <memory>
+
+#include "base/check_op.h"
+#include "base/metrics/histogram_base.h"
+#include "base/metrics/histogram_samples.h"
+#include "base/metrics/statistics_recorder.h"
+#include "base/strings/string_number_conversions.h"
+
+namespace base {
+
+namespace {
+
+// The text buffered before it's written to the sink.
+constexpr size_t kChunkSize = 64 * 1024;
+
+bool IsNameChar(char c) {
+  return (c >= 'a' && c <= 'z') || (c >= 'A' && c <= 'Z') ||
+         (c >= '0' && c <= '9') || c == '_' || c == ':';
+}
+
+void AppendName(const char* name, std::string* output) {
+  if (*name >= '0' && *name <= '9')
+    output->push_back('_');
+  for (const char* c = name; *c; ++c)
+    output->push_back(IsNameChar(*c) ? *c : '_');
+}
+
+}  // namespace
+
+OpenMetricsExporter::OpenMetricsExporter(Mode mode) : mode_(mode) {}
+
+OpenMetricsExporter::~OpenMetricsExporter() = default;
+
+void OpenMetricsExporter::Export(Sink* sink) {
+  DCHECK(!sink_);
+  sink_ = sink;
+  buffer_.reserve(kChunkSize);
+
+  StatisticsRecorder::Histograms histograms =
+      StatisticsRecorder::Sort(StatisticsRecorder::GetHistograms());
+  if (mode_ == Mode::kDelta) {
+    snapshot_manager_.PrepareDeltas(histograms, HistogramBase::kNoFlags,
+                                    HistogramBase::kNoFlags);
+  } else {
+    for (const HistogramBase* const histogram : histograms)
+      Write(*histogram, *histogram->SnapshotSamples());
+  }
+
+  buffer_.append("# EOF\n");
+  Flush();
+  sink_ = nullptr;
+}
+
+// static
+void OpenMetricsExporter::AppendHistogram(const HistogramBase& histogram,
+                                          const HistogramSamples& samples,
+                                          std::string* output) {
+  std::string name;
+  AppendName(histogram.histogram_name(), &name);
+  output->append("# TYPE ");
+  output->append(name);
+  output->append(" histogram\n");
+
+  int64_t count = 0;
+  int64_t previous_max = std::numeric_limits<int64_t>::min();
+  for (std::unique_ptr<SampleCountIterator> it = samples.Iterator();
+       !it->Done(); it->Next()) {
+    int64_t max;
+    HistogramBase::Count bucket_count;
+    it->Get(nullptr, &max, &bucket_count);
+    DCHECK_GE(max, previous_max);
+    previous_max = max;
+    count += bucket_count;
+    // The samples of the overflow bucket are only counted in that of +Inf.
+    if (max > HistogramBase::kSampleType_MAX - 1)
+      continue;
+    output->append(name);
+    output->append("_bucket{le=\"");
+    output->append(NumberToString(max - 1));
+    output->append("\"} ");
+    output->append(NumberToString(count));
+    output->push_back('\n');
+  }
+
+  // The counts of the buckets rather than TotalCount(), which may not match
+  // them while samples are being recorded, so that +Inf is the largest.
+  const std::string count_string = NumberToString(count);
+  output->append(name);
+  output->append("_bucket{le=\"+Inf\"} ");
+  output->append(count_string);
+  output->push_back('\n');
+  output->append(name);
+  output->append("_sum ");
+  output->append(NumberToString(samples.sum()));
+  output->push_back('\n');
+  output->append(name);
+  output->append("_count ");
+  output->append(count_string);
+  output->push_back('\n');
+}
+
+void OpenMetricsExporter::Write(const HistogramBase& histogram,
+                                const HistogramSamples& samples) {
+  AppendHistogram(histogram, samples, &buffer_);
+  if (buffer_.size() >= kChunkSize)
+    Flush();
+}
+
+void OpenMetricsExporter::Flush() {
+  sink_->Write(buffer_);
+  buffer_.clear();
+}
+
+OpenMetricsExporter::DeltaFlattener::DeltaFlattener(
+    OpenMetricsExporter* exporter)
+    : exporter_(exporter) {}
+
+OpenMetricsExporter::DeltaFlattener::~DeltaFlattener() = default;
+
+void OpenMetricsExporter::DeltaFlattener::RecordDelta(
+    const HistogramBase& histogram,
+    const HistogramSamples& snapshot) {
+  exporter_->Write(histogram, snapshot);
+}
+
+}  // namespace base
@@ -0,0 +1,111 @@
+// Copyright 2022 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#ifndef BASE_METRICS_OPEN_METRICS_EXPORTER_H_
+#define BASE_METRICS_OPEN_METRICS_EXPORTER_H_
+
+#include <string>
+
+#include "base/base_export.h"
+#include "base/memory/raw_ptr.h"
+#include "base/metrics/histogram_flattener.h"
+#include "base/metrics/histogram_snapshot_manager.h"
+#include "base/strings/string_piece.h"
+
+namespace base {
+
+class HistogramBase;
+class HistogramSamples;
+
+// Writes the histograms of the StatisticsRecorder in the OpenMetrics text
+// exposition format, for servers scraped by Prometheus and the like. Each
+// histogram is a metric family of the histogram type, named after the
+// histogram with the characters other than [a-zA-Z0-9_:] replaced by '_':
+//
+//   # TYPE Net_Example histogram
+//   Net_Example_bucket{le="9"} 3
+//   Net_Example_bucket{le="+Inf"} 5
+//   Net_Example_sum 47
+//   Net_Example_count 5
+//   # EOF
+//
+// The buckets are cumulative, and |le| is the largest sample of a bucket,
+// whose maximum is exclusive. Only the buckets with samples are written, so
+// that the text of a histogram grows with its samples rather than with its
+// buckets.
+//
+// Unlike StatisticsRecorder::ToJSON() and WriteGraph(), the text is streamed
+// to a Sink in chunks as the histograms are read, and the recorder's lock is
+// only held to get the histograms. Histograms are expected to be named so that
+// they stay distinct once written.
+//
+// This class isn't thread safe: use one exporter per thread.
+class BASE_EXPORT OpenMetricsExporter {
+ public:
+  // Receives the text of an export in chunks.
+  class Sink {
+   public:
+    virtual ~Sink() = default;
+
+    virtual void Write(StringPiece text) = 0;
+  };
+
+  enum class Mode {
+    // The samples of the histograms since they were created.
+    kCumulative,
+    // The samples since the previous export, through a
+    // HistogramSnapshotManager: they are marked as logged, as they would be
+    // for any other StatisticsRecorder::PrepareDeltas() caller, and the
+    // histograms without any are not written.
+    kDelta,
+  };
+
+  explicit OpenMetricsExporter(Mode mode);
+
+  OpenMetricsExporter(const OpenMetricsExporter&) = delete;
+  OpenMetricsExporter& operator=(const OpenMetricsExporter&) = delete;
+
+  ~OpenMetricsExporter();
+
+  // Writes the histograms, sorted by name, to |sink|. The persistent ones are
+  // included, but not those of the providers: call
+  // StatisticsRecorder::ImportProvidedHistograms() before as need be.
+  void Export(Sink* sink);
+
+  // Appends the text of |histogram| with |samples| to |output|, without the
+  // "# EOF" line.
+  static void AppendHistogram(const HistogramBase& histogram,
+                              const HistogramSamples& samples,
+                              std::string* output);
+
+ private:
+  // Writes the deltas it's given by |snapshot_manager_|.
+  class DeltaFlattener : public HistogramFlattener {
+   public:
+    explicit DeltaFlattener(OpenMetricsExporter* exporter);
+    ~DeltaFlattener() override;
+
+    void RecordDelta(const HistogramBase& histogram,
+                     const HistogramSamples& snapshot) override;
+
+   private:
+    const raw_ptr<OpenMetricsExporter> exporter_;
+  };
+
+  // Appends a histogram to |buffer_|, which is written to |sink_| once full.
+  void Write(const HistogramBase& histogram, const HistogramSamples& samples);
+  void Flush();
+
+  const Mode mode_;
+  DeltaFlattener delta_flattener_{this};
+  HistogramSnapshotManager snapshot_manager_{&delta_flattener_};
+
+  // The sink and the text not written to it yet, during an export.
+  raw_ptr<Sink> sink_ = nullptr;
+  std::string buffer_;
+};
+
+}  // namespace base
+
+#endif  // BASE_METRICS_OPEN_METRICS_EXPORTER_H_
@@ -0,0 +1,157 @@
+// Copyright 2022 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "base/metrics/open_metrics_exporter.h"
+
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "base/metrics/histogram.h"
+#include "base/metrics/histogram_base.h"
+#include "base/metrics/histogram_functions.h"
+#include "base/metrics/sparse_histogram.h"
+#include "base/metrics/statistics_recorder.h"
+#include "base/strings/stringprintf.h"
+#include "testing/gtest/include/gtest/gtest.h"
+
+namespace base {
+
+namespace {
+
+class StringSink : public OpenMetricsExporter::Sink {
+ public:
+  void Write(StringPiece text) override { chunks.emplace_back(text); }
+
+  std::string Text() const {
+    std::string text;
+    for (const std::string& chunk : chunks)
+      text += chunk;
+    return text;
+  }
+
+  std::vector<std::string> chunks;
+};
+
+}  // namespace
+
+class OpenMetricsExporterTest : public testing::Test {
+ protected:
+  void SetUp() override {
+    statistics_recorder_ = StatisticsRecorder::CreateTemporaryForTesting();
+  }
+
+  std::string Export(OpenMetricsExporter* exporter) {
+    StringSink sink;
+    exporter->Export(&sink);
+    return sink.Text();
+  }
+
+ private:
+  std::unique_ptr<StatisticsRecorder> statistics_recorder_;
+};
+
+TEST_F(OpenMetricsExporterTest, Cumulative) {
+  // Buckets [0, 1), [1, 2), [2, 3), [3, 4), [4, 5) and [5, INT_MAX).
+  HistogramBase* histogram = LinearHistogram::FactoryGet(
+      "Test.Linear", 1, 5, 6, HistogramBase::kNoFlags);
+  histogram->Add(1);
+  histogram->Add(1);
+  histogram->Add(3);
+  histogram->Add(100);
+  HistogramBase* sparse =
+      SparseHistogram::FactoryGet("Test.Sparse-1", HistogramBase::kNoFlags);
+  sparse->Add(-5);
+  sparse->Add(7);
+
+  OpenMetricsExporter exporter(OpenMetricsExporter::Mode::kCumulative);
+  const std::string expected =
+      "# TYPE Test_Linear histogram\n"
+      "Test_Linear_bucket{le=\"1\"} 2\n"
+      "Test_Linear_bucket{le=\"3\"} 3\n"
+      "Test_Linear_bucket{le=\"+Inf\"} 4\n"
+      "Test_Linear_sum 105\n"
+      "Test_Linear_count 4\n"
+      "# TYPE Test_Sparse_1 histogram\n"
+      "Test_Sparse_1_bucket{le=\"-5\"} 1\n"
+      "Test_Sparse_1_bucket{le=\"7\"} 2\n"
+      "Test_Sparse_1_bucket{le=\"+Inf\"} 2\n"
+      "Test_Sparse_1_sum 2\n"
+      "Test_Sparse_1_count 2\n"
+      "# EOF\n";
+  EXPECT_EQ(expected, Export(&exporter));
+
+  // Nothing is marked as logged.
+  EXPECT_EQ(expected, Export(&exporter));
+  EXPECT_EQ(4, histogram->SnapshotDelta()->TotalCount());
+}
+
+TEST_F(OpenMetricsExporterTest, EmptyHistogram) {
+  UmaHistogramCounts100("2Test", 0);
+  Histogram::FactoryGet("Test.Empty", 1, 10, 5, HistogramBase::kNoFlags);
+
+  OpenMetricsExporter exporter(OpenMetricsExporter::Mode::kCumulative);
+  EXPECT_EQ(
+      "# TYPE _2Test histogram\n"
+      "_2Test_bucket{le=\"0\"} 1\n"
+      "_2Test_bucket{le=\"+Inf\"} 1\n"
+      "_2Test_sum 0\n"
+      "_2Test_count 1\n"
+      "# TYPE Test_Empty histogram\n"
+      "Test_Empty_bucket{le=\"+Inf\"} 0\n"
+      "Test_Empty_sum 0\n"
+      "Test_Empty_count 0\n"
+      "# EOF\n",
+      Export(&exporter));
+}
+
+TEST_F(OpenMetricsExporterTest, Delta) {
+  UmaHistogramSparse("Test.Delta", 1);
+
+  OpenMetricsExporter exporter(OpenMetricsExporter::Mode::kDelta);
+  EXPECT_EQ(
+      "# TYPE Test_Delta histogram\n"
+      "Test_Delta_bucket{le=\"1\"} 1\n"
+      "Test_Delta_bucket{le=\"+Inf\"} 1\n"
+      "Test_Delta_sum 1\n"
+      "Test_Delta_count 1\n"
+      "# EOF\n",
+      Export(&exporter));
+
+  // The histograms without new samples aren't written.
+  EXPECT_EQ("# EOF\n", Export(&exporter));
+
+  UmaHistogramSparse("Test.Delta", 2);
+  UmaHistogramSparse("Test.Delta", 2);
+  EXPECT_EQ(
+      "# TYPE Test_Delta histogram\n"
+      "Test_Delta_bucket{le=\"2\"} 2\n"
+      "Test_Delta_bucket{le=\"+Inf\"} 2\n"
+      "Test_Delta_sum 4\n"
+      "Test_Delta_count 2\n"
+      "# EOF\n",
+      Export(&exporter));
+}
+
+TEST_F(OpenMetricsExporterTest, Chunks) {
+  constexpr int kHistogramCount = 2000;
+  for (int i = 0; i < kHistogramCount; ++i)
+    UmaHistogramCounts1000(StringPrintf("Test.Chunks.%04d", i), i % 1000);
+
+  OpenMetricsExporter exporter(OpenMetricsExporter::Mode::kCumulative);
+  StringSink sink;
+  exporter.Export(&sink);
+  EXPECT_LT(1U, sink.chunks.size());
+
+  std::string expected;
+  for (const HistogramBase* histogram :
+       StatisticsRecorder::Sort(StatisticsRecorder::GetHistograms())) {
+    OpenMetricsExporter::AppendHistogram(
+        *histogram, *histogram->SnapshotSamples(), &expected);
+  }
+  expected += "# EOF\n";
+  EXPECT_EQ(expected, sink.Text());
+}
+
+}  // namespace base
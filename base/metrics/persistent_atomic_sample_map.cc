@@ -0,0 +1,162 @@
+// Copyright 2022 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "base/metrics/persistent_atomic_sample_map.h"
+
+#include "base/check_op.h"
+#include "base/metrics/persistent_histogram_allocator.h"
+#include "base/metrics/persistent_sample_map.h"
+#include "base/numerics/safe_conversions.h"
+
+namespace base {
+
+typedef HistogramBase::AtomicCount AtomicCount;
+typedef HistogramBase::Count Count;
+typedef HistogramBase::Sample Sample;
+typedef PersistentSampleMap::SampleRecord SampleRecord;
+
+PersistentAtomicSampleMap::PersistentAtomicSampleMap(
+    uint64_t id,
+    PersistentHistogramAllocator* allocator,
+    Metadata* meta)
+    : HistogramSamples(id, meta), allocator_(allocator) {}
+
+PersistentAtomicSampleMap::~PersistentAtomicSampleMap() {
+  if (records_)
+    records_->Release(this);
+}
+
+void PersistentAtomicSampleMap::Accumulate(Sample value, Count count) {
+  AtomicCount* count_pointer = sample_counts_.Find(value);
+  if (!count_pointer)
+    count_pointer = GetOrCreateSampleCountStorage(value);
+  subtle::NoBarrier_AtomicIncrement(count_pointer, count);
+  IncreaseSumAndCount(strict_cast<int64_t>(count) * value, count);
+}
+
+Count PersistentAtomicSampleMap::GetCount(Sample value) const {
+  AtomicCount* count_pointer = sample_counts_.Find(value);
+  if (!count_pointer) {
+    // The sample may have been recorded by another process.
+    AutoLock auto_lock(lock_);
+    count_pointer =
+        const_cast<PersistentAtomicSampleMap*>(this)->ImportSamples(value,
+                                                                    false);
+  }
+  return count_pointer ? subtle::NoBarrier_Load(count_pointer) : 0;
+}
+
+Count PersistentAtomicSampleMap::TotalCount() const {
+  {
+    AutoLock auto_lock(lock_);
+    const_cast<PersistentAtomicSampleMap*>(this)->ImportSamples(-1, true);
+  }
+  Count count = 0;
+  sample_counts_.ForEach(
+      [&count](Sample value, Count sample_count) { count += sample_count; });
+  return count;
+}
+
+std::unique_ptr<SampleCountIterator> PersistentAtomicSampleMap::Iterator()
+    const {
+  {
+    AutoLock auto_lock(lock_);
+    const_cast<PersistentAtomicSampleMap*>(this)->ImportSamples(-1, true);
+  }
+  return std::make_unique<SortedSampleCountIterator>(
+      sample_counts_.GetSortedCounts());
+}
+
+bool PersistentAtomicSampleMap::AddSubtractImpl(SampleCountIterator* iter,
+                                                Operator op) {
+  Sample min;
+  int64_t max;
+  Count count;
+  for (; !iter->Done(); iter->Next()) {
+    iter->Get(&min, &max, &count);
+    if (count == 0)
+      continue;
+    if (strict_cast<int64_t>(min) + 1 != max)
+      return false;  // SparseHistogram only supports bucket with size 1.
+    AtomicCount* count_pointer = sample_counts_.Find(min);
+    if (!count_pointer)
+      count_pointer = GetOrCreateSampleCountStorage(min);
+    subtle::NoBarrier_AtomicIncrement(
+        count_pointer, (op == HistogramSamples::ADD) ? count : -count);
+  }
+  return true;
+}
+
+AtomicCount* PersistentAtomicSampleMap::GetOrCreateSampleCountStorage(
+    Sample value) {
+  AutoLock auto_lock(lock_);
+
+  // Another thread may have inserted |value| since it was looked for, or
+  // another process may have created its record.
+  AtomicCount* count_pointer = sample_counts_.Find(value);
+  if (count_pointer)
+    return count_pointer;
+  count_pointer = ImportSamples(value, false);
+  if (count_pointer)
+    return count_pointer;
+
+  // Create a new record in persistent memory for the value. |records_| will
+  // have been initialized by the ImportSamples() call above.
+  DCHECK(records_);
+  PersistentMemoryAllocator::Reference ref = records_->CreateNew(value);
+  if (!ref) {
+    // If a new record could not be created then the underlying allocator is
+    // full or corrupt. Instead, allocate the counter from the heap. This
+    // sample will not be persistent, will not be shared, and will leak...
+    // but it's better than crashing.
+    return sample_counts_.Insert(value, new AtomicCount(0));
+  }
+
+  // As in PersistentSampleMap, import the just-created record rather than use
+  // it, so that the first record made iterable for |value| by any process is
+  // the one used.
+  count_pointer = ImportSamples(value, false);
+  DCHECK(count_pointer);
+  return count_pointer;
+}
+
+AtomicCount* PersistentAtomicSampleMap::ImportSamples(Sample until_value,
+                                                      bool import_everything) {
+  lock_.AssertAcquired();
+  // As in PersistentSampleMap::GetRecords(), the records are only acquired
+  // once the histogram is used, after it has been de-dup'd.
+  if (!records_)
+    records_ = allocator_->UseSampleMapRecords(id(), this);
+
+  AtomicCount* found_count = nullptr;
+  PersistentMemoryAllocator::Reference ref;
+  while ((ref = records_->GetNext()) != 0) {
+    SampleRecord* record = records_->GetAsObject<SampleRecord>(ref);
+    if (!record)
+      continue;
+
+    DCHECK_EQ(id(), record->id);
+
+    // The first record of a value is the one inserted. The others come from
+    // a race condition between processes -- see PersistentSampleMap --, and
+    // nothing ever operates on them.
+    AtomicCount* count = sample_counts_.Find(record->value);
+    if (!count) {
+      count = sample_counts_.Insert(record->value, &record->count);
+    } else {
+      DCHECK_EQ(0, record->count);
+    }
+
+    if (record->value == until_value) {
+      if (!found_count)
+        found_count = count;
+      if (!import_everything)
+        break;
+    }
+  }
+
+  return found_count;
+}
+
+}  // namespace base
@@ -0,0 +1,89 @@
+// Copyright 2022 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+// PersistentAtomicSampleMap implements HistogramSamples interface. It is used
+// by the SparseHistogram class to record samples in persistent memory from
+// any thread, with the records of PersistentSampleMap.
+
+#ifndef BASE_METRICS_PERSISTENT_ATOMIC_SAMPLE_MAP_H_
+#define BASE_METRICS_PERSISTENT_ATOMIC_SAMPLE_MAP_H_
+
+#include <stdint.h>
+
+#include <memory>
+
+#include "base/base_export.h"
+#include "base/memory/raw_ptr.h"
+#include "base/metrics/atomic_sample_map.h"
+#include "base/metrics/histogram_base.h"
+#include "base/metrics/histogram_samples.h"
+#include "base/synchronization/lock.h"
+
+namespace base {
+
+class PersistentHistogramAllocator;
+class PersistentSampleMapRecords;
+
+// The counts of the samples already known are found and updated without a
+// lock, as in AtomicSampleMap. A lock is only taken to import the records of
+// new samples, or to create them, which keeps the records in the order that
+// lets all the maps of all the processes agree on the record of each sample.
+// The records may be used by a PersistentSampleMap in another process.
+class BASE_EXPORT PersistentAtomicSampleMap : public HistogramSamples {
+ public:
+  // Constructs a persistent sample map using a PersistentHistogramAllocator
+  // as the data source for persistent records.
+  PersistentAtomicSampleMap(uint64_t id,
+                            PersistentHistogramAllocator* allocator,
+                            Metadata* meta);
+
+  PersistentAtomicSampleMap(const PersistentAtomicSampleMap&) = delete;
+  PersistentAtomicSampleMap& operator=(const PersistentAtomicSampleMap&) =
+      delete;
+
+  ~PersistentAtomicSampleMap() override;
+
+  // HistogramSamples:
+  void Accumulate(HistogramBase::Sample value,
+                  HistogramBase::Count count) override;
+  HistogramBase::Count GetCount(HistogramBase::Sample value) const override;
+  HistogramBase::Count TotalCount() const override;
+  std::unique_ptr<SampleCountIterator> Iterator() const override;
+
+ protected:
+  // Performs arithemetic. |op| is ADD or SUBTRACT.
+  bool AddSubtractImpl(SampleCountIterator* iter, Operator op) override;
+
+ private:
+  // Gets a pointer to a "count" corresponding to a given |value|, creating
+  // the sample (initialized to zero) if it does not already exists.
+  HistogramBase::AtomicCount* GetOrCreateSampleCountStorage(
+      HistogramBase::Sample value);
+
+  // Imports the new sample records from persistent memory into
+  // |sample_counts_|, and returns the count of |until_value| if it's found,
+  // stopping there unless |import_everything|. Must be called with |lock_|.
+  HistogramBase::AtomicCount* ImportSamples(HistogramBase::Sample until_value,
+                                            bool import_everything);
+
+  // The created and imported samples, whose counts are held by the records.
+  internal::SampleCountTable sample_counts_{/*external_counts=*/true};
+
+  // Protects |records_|, and serializes the inserts in |sample_counts_|.
+  mutable Lock lock_;
+
+  // The allocator that manages histograms inside persistent memory. This is
+  // owned externally and is expected to live beyond the life of this object.
+  raw_ptr<PersistentHistogramAllocator> allocator_;
+
+  // The object that manages sample records inside persistent memory. This is
+  // owned by the |allocator_| object (above) and so, like it, is expected to
+  // live beyond the life of this object. This value is lazily-initialized on
+  // first use, like that of PersistentSampleMap.
+  raw_ptr<PersistentSampleMapRecords> records_ = nullptr;
+};
+
+}  // namespace base
+
+#endif  // BASE_METRICS_PERSISTENT_ATOMIC_SAMPLE_MAP_H_
@@ -0,0 +1,144 @@
+// Copyright 2022 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "base/metrics/persistent_atomic_sample_map.h"
+
+#include <memory>
+#include <vector>
+
+#include "base/memory/raw_ptr.h"
+#include "base/metrics/persistent_histogram_allocator.h"
+#include "base/metrics/persistent_sample_map.h"
+#include "base/threading/simple_thread.h"
+#include "testing/gtest/include/gtest/gtest.h"
+
+namespace base {
+namespace {
+
+std::unique_ptr<PersistentHistogramAllocator> CreateHistogramAllocator(
+    size_t bytes) {
+  return std::make_unique<PersistentHistogramAllocator>(
+      std::make_unique<LocalPersistentMemoryAllocator>(bytes, 0, ""));
+}
+
+std::unique_ptr<PersistentHistogramAllocator> DuplicateHistogramAllocator(
+    PersistentHistogramAllocator* original) {
+  return std::make_unique<PersistentHistogramAllocator>(
+      std::make_unique<PersistentMemoryAllocator>(
+          const_cast<void*>(original->data()), original->length(), 0,
+          original->Id(), original->Name(), false));
+}
+
+// Accumulates 1 in each sample of [0, |sample_count|), |rounds| times.
+class AccumulateThread : public SimpleThread {
+ public:
+  AccumulateThread(HistogramSamples* samples, int sample_count, int rounds)
+      : SimpleThread("AccumulateThread"),
+        samples_(samples),
+        sample_count_(sample_count),
+        rounds_(rounds) {}
+
+  void Run() override {
+    for (int round = 0; round < rounds_; ++round) {
+      for (int i = 0; i < sample_count_; ++i)
+        samples_->Accumulate(i, 1);
+    }
+  }
+
+ private:
+  const raw_ptr<HistogramSamples> samples_;
+  const int sample_count_;
+  const int rounds_;
+};
+
+TEST(PersistentAtomicSampleMapTest, AccumulateTest) {
+  std::unique_ptr<PersistentHistogramAllocator> allocator =
+      CreateHistogramAllocator(64 << 10);  // 64 KiB
+  HistogramSamples::LocalMetadata meta;
+  PersistentAtomicSampleMap samples(1, allocator.get(), &meta);
+
+  samples.Accumulate(1, 100);
+  samples.Accumulate(2, 200);
+  samples.Accumulate(1, -200);
+  EXPECT_EQ(-100, samples.GetCount(1));
+  EXPECT_EQ(200, samples.GetCount(2));
+  EXPECT_EQ(0, samples.GetCount(3));
+
+  EXPECT_EQ(300, samples.sum());
+  EXPECT_EQ(100, samples.TotalCount());
+  EXPECT_EQ(samples.redundant_count(), samples.TotalCount());
+}
+
+TEST(PersistentAtomicSampleMapTest, SharedWithPersistentSampleMap) {
+  std::unique_ptr<PersistentHistogramAllocator> allocator1 =
+      CreateHistogramAllocator(64 << 10);  // 64 KiB
+  HistogramSamples::LocalMetadata meta1;
+  PersistentAtomicSampleMap samples1(1, allocator1.get(), &meta1);
+  samples1.Accumulate(1, 100);
+  samples1.Accumulate(2, 200);
+
+  // The records are those of a PersistentSampleMap, as if it were in another
+  // process.
+  std::unique_ptr<PersistentHistogramAllocator> allocator2 =
+      DuplicateHistogramAllocator(allocator1.get());
+  PersistentSampleMap samples2(1, allocator2.get(), &meta1);
+  EXPECT_EQ(100, samples2.GetCount(1));
+  EXPECT_EQ(200, samples2.GetCount(2));
+  EXPECT_EQ(300, samples2.TotalCount());
+
+  // The samples recorded there are seen here, be they new or not.
+  samples2.Accumulate(2, 20);
+  samples2.Accumulate(3, 300);
+  EXPECT_EQ(100, samples1.GetCount(1));
+  EXPECT_EQ(220, samples1.GetCount(2));
+  EXPECT_EQ(300, samples1.GetCount(3));
+  EXPECT_EQ(620, samples1.TotalCount());
+  EXPECT_EQ(samples1.redundant_count(), samples1.TotalCount());
+
+  samples1.Accumulate(3, 30);
+  EXPECT_EQ(330, samples2.GetCount(3));
+}
+
+TEST(PersistentAtomicSampleMapTest, ConcurrentAccumulate) {
+  constexpr int kThreadCount = 4;
+  constexpr int kSampleCount = 200;
+  constexpr int kRounds = 50;
+  std::unique_ptr<PersistentHistogramAllocator> allocator =
+      CreateHistogramAllocator(64 << 10);  // 64 KiB
+  HistogramSamples::LocalMetadata meta;
+  PersistentAtomicSampleMap samples(1, allocator.get(), &meta);
+
+  std::vector<std::unique_ptr<AccumulateThread>> threads;
+  for (int i = 0; i < kThreadCount; ++i) {
+    threads.push_back(
+        std::make_unique<AccumulateThread>(&samples, kSampleCount, kRounds));
+    threads.back()->Start();
+  }
+  for (const std::unique_ptr<AccumulateThread>& thread : threads)
+    thread->Join();
+
+  EXPECT_EQ(kThreadCount * kRounds * kSampleCount, samples.TotalCount());
+  EXPECT_EQ(samples.redundant_count(), samples.TotalCount());
+
+  // A single record was made for each sample.
+  std::unique_ptr<PersistentHistogramAllocator> allocator2 =
+      DuplicateHistogramAllocator(allocator.get());
+  HistogramSamples::LocalMetadata meta2;
+  PersistentSampleMap samples2(1, allocator2.get(), &meta2);
+  int count = 0;
+  for (std::unique_ptr<SampleCountIterator> it = samples2.Iterator();
+       !it->Done(); it->Next()) {
+    HistogramBase::Sample min;
+    int64_t max;
+    HistogramBase::Count sample_count;
+    it->Get(&min, &max, &sample_count);
+    EXPECT_EQ(count, min);
+    EXPECT_EQ(kThreadCount * kRounds, sample_count);
+    ++count;
+  }
+  EXPECT_EQ(kSampleCount, count);
+}
+
+}  // namespace
+}  // namespace base
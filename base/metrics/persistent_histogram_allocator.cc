@@ -8,6 +8,7 @@
 #include <utility>
 
 #include "base/atomicops.h"
+#include "base/containers/contains.h"
 #include "base/files/file_path.h"
 #include "base/files/file_util.h"
 #include "base/files/important_file_writer.h"
@@ -22,6 +23,7 @@
 #include "base/metrics/histogram_samples.h"
 #include "base/metrics/metrics_hashes.h"
 #include "base/metrics/persistent_sample_map.h"
+#include "base/metrics/quantile_histogram.h"
 #include "base/metrics/sparse_histogram.h"
 #include "base/metrics/statistics_recorder.h"
 #include "base/numerics/safe_conversions.h"
@@ -346,7 +348,8 @@ std::unique_ptr<HistogramBase> PersistentHistogramAllocator::AllocateHistogram(
   }
 
   // Create the remaining metadata necessary for regular histograms.
-  if (histogram_type != SPARSE_HISTOGRAM) {
+  if (histogram_type != SPARSE_HISTOGRAM &&
+      histogram_type != QUANTILE_HISTOGRAM) {
     size_t bucket_count = bucket_ranges->bucket_count();
     size_t counts_bytes = CalculateRequiredCountsBytes(bucket_count);
     if (counts_bytes == 0) {
@@ -357,10 +360,12 @@ std::unique_ptr<HistogramBase> PersistentHistogramAllocator::AllocateHistogram(
     // Since the StasticsRecorder keeps a global collection of BucketRanges
     // objects for re-use, it would be dangerous for one to hold a reference
     // from a persistent allocator that is not the global one (which is
-    // permanent once set). If this stops being the case, this check can
-    // become an "if" condition beside "!ranges_ref" below and before
+    // permanent once set). Other allocators must be given BucketRanges of
+    // their own. If this stops being the case, this check can become an "if"
+    // condition beside "!ranges_ref" below and before
     // set_persistent_reference() farther down.
-    DCHECK_EQ(this, GlobalHistogramAllocator::Get());
+    DCHECK(this == GlobalHistogramAllocator::Get() ||
+           !Contains(StatisticsRecorder::GetBucketRanges(), bucket_ranges));
 
     // Re-use an existing BucketRanges persistent allocation if one is known;
     // otherwise, create one.
@@ -466,8 +471,11 @@ void PersistentHistogramAllocator::MergeHistogramDeltaToStatisticsRecorder(
     return;
   }
 
-  // Merge the delta from the passed object to the one in the SR.
-  existing->AddSamples(*histogram->SnapshotDelta());
+  // Merge the delta from the passed object to the one in the SR. The samples
+  // of the histograms which other processes didn't record to since the last
+  // merge needn't be snapshotted.
+  if (histogram->HasUnloggedSamples())
+    existing->AddSamples(*histogram->SnapshotDelta());
 }
 
 void PersistentHistogramAllocator::MergeHistogramFinalDeltaToStatisticsRecorder(
@@ -518,6 +526,16 @@ std::unique_ptr<HistogramBase> PersistentHistogramAllocator::CreateHistogram(
     histogram->SetFlags(histogram_data_ptr->flags);
     return histogram;
   }
+  if (histogram_data_ptr->histogram_type == QUANTILE_HISTOGRAM) {
+    std::unique_ptr<HistogramBase> histogram =
+        QuantileHistogram::PersistentCreate(
+            this, histogram_data_ptr->name,
+            &histogram_data_ptr->samples_metadata,
+            &histogram_data_ptr->logged_metadata);
+    DCHECK(histogram);
+    histogram->SetFlags(histogram_data_ptr->flags);
+    return histogram;
+  }
 
   // Copy the configuration fields from histogram_data_ptr to local storage
   // because anything in persistent memory cannot be trusted as it could be
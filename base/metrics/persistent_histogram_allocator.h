@@ -165,9 +165,10 @@ class BASE_EXPORT PersistentSampleMapRecords {
 
   // This is the set of records previously found for a sample map. Because
   // there is ever only one object with a given ID (typically a hash of a
-  // histogram name) and because the parent SparseHistogram has acquired
-  // its own lock before accessing the PersistentSampleMap it controls, this
-  // list can be accessed without acquiring any additional lock.
+  // histogram name) and because that object serializes its accesses (the
+  // parent SparseHistogram's lock for a PersistentSampleMap, and its own
+  // for a PersistentAtomicSampleMap), this list can be accessed without
+  // acquiring any additional lock.
   std::vector<PersistentMemoryAllocator::Reference> records_;
 
   // This is the set of records found during iteration through memory. It
@@ -4,9 +4,22 @@
 
 #include "base/metrics/persistent_histogram_storage.h"
 
+#include <algorithm>
+#include <map>
+#include <string>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+#include "base/bits.h"
+#include "base/files/file_enumerator.h"
 #include "base/files/file_util.h"
 #include "base/files/important_file_writer.h"
+#include "base/files/memory_mapped_file.h"
 #include "base/logging.h"
+#include "base/metrics/bucket_ranges.h"
+#include "base/metrics/histogram.h"
+#include "base/metrics/histogram_samples.h"
 #include "base/metrics/persistent_histogram_allocator.h"
 #include "base/metrics/persistent_memory_allocator.h"
 #include "base/process/memory.h"
@@ -27,6 +40,12 @@ namespace {
 
 constexpr size_t kAllocSize = 1 << 20;  // 1 MiB
 
+// The most segments the memory grows to, the first one included.
+constexpr size_t kMaxSegments = 8;
+
+// The largest memory that histograms are merged into, that of a segment.
+constexpr size_t kMaxMergedSize = 1 << 30;  // 1 GiB
+
 void* AllocateLocalMemory(size_t size) {
   void* address;
 
@@ -57,6 +76,150 @@ void* AllocateLocalMemory(size_t size) {
   return address;
 }
 
+// Gets the memory used in all the segments of |allocator|.
+size_t GetUsedSize(const base::PersistentMemoryAllocator* allocator) {
+  size_t used = 0;
+  for (size_t i = 0; i < allocator->segment_count(); ++i)
+    used += allocator->GetSegment(i)->used();
+  return used;
+}
+
+// Merges the histograms of persistent allocators into those of one of its
+// own, in local memory, which holds only the samples that weren't logged.
+class HistogramMerger {
+ public:
+  HistogramMerger(size_t size, base::StringPiece name)
+      : allocator_(std::make_unique<base::LocalPersistentMemoryAllocator>(
+            std::min(base::bits::AlignUp(size, size_t{4096}), kMaxMergedSize),
+            0,
+            name)) {}
+
+  HistogramMerger(const HistogramMerger&) = delete;
+  HistogramMerger& operator=(const HistogramMerger&) = delete;
+
+  // Adds the unlogged samples of the histograms in |source|. Returns false
+  // if some couldn't be, be it because of a histogram that was merged before
+  // with different arguments or because the memory is full.
+  bool Merge(base::PersistentHistogramAllocator* source) {
+    bool success = true;
+    base::PersistentHistogramAllocator::Iterator iter(source);
+    while (std::unique_ptr<base::HistogramBase> histogram = iter.GetNext()) {
+      std::unique_ptr<base::HistogramSamples> samples =
+          histogram->SnapshotFinalDelta();
+      if (samples->TotalCount() == 0)
+        continue;
+      base::HistogramBase* merged = GetOrCreateHistogram(*histogram);
+      if (!merged) {
+        success = false;
+        continue;
+      }
+      merged->AddSamples(*samples);
+    }
+    const base::PersistentMemoryAllocator* memory =
+        allocator_.memory_allocator();
+    return success && !memory->IsFull() && !memory->IsCorrupt();
+  }
+
+  // The contents of the memory, as a histogram file.
+  base::StringPiece contents() {
+    return base::StringPiece(static_cast<const char*>(allocator_.data()),
+                             allocator_.used());
+  }
+
+ private:
+  // Gets the histogram that |histogram| is merged into, creating it if need
+  // be, or null if one with different arguments already exists.
+  base::HistogramBase* GetOrCreateHistogram(
+      const base::HistogramBase& histogram) {
+    const base::HistogramType type = histogram.GetHistogramType();
+    const bool ranged = type != base::SPARSE_HISTOGRAM &&
+                        type != base::QUANTILE_HISTOGRAM;
+
+    auto it = histograms_.find(histogram.histogram_name());
+    if (it != histograms_.end()) {
+      base::HistogramBase* merged = it->second.get();
+      if (merged->GetHistogramType() != type ||
+          (ranged &&
+           !static_cast<base::Histogram*>(merged)->bucket_ranges()->Equals(
+               static_cast<const base::Histogram&>(histogram)
+                   .bucket_ranges()))) {
+        return nullptr;
+      }
+      return merged;
+    }
+
+    int minimum = 0;
+    int maximum = 0;
+    const base::BucketRanges* ranges = nullptr;
+    if (ranged) {
+      const base::Histogram& ranged_histogram =
+          static_cast<const base::Histogram&>(histogram);
+      minimum = ranged_histogram.declared_min();
+      maximum = ranged_histogram.declared_max();
+      ranges = GetRanges(*ranged_histogram.bucket_ranges());
+    }
+    base::PersistentHistogramAllocator::Reference ref;
+    std::unique_ptr<base::HistogramBase> merged = allocator_.AllocateHistogram(
+        type, histogram.histogram_name(), minimum, maximum, ranges,
+        histogram.flags(), &ref);
+    if (!merged)
+      return nullptr;
+    allocator_.FinalizeHistogram(ref, /*registered=*/true);
+    return histograms_.emplace(histogram.histogram_name(), std::move(merged))
+        .first->second.get();
+  }
+
+  // Gets the copy of |ranges| of this allocator. Ranges of the
+  // StatisticsRecorder can't be used because they remember their persistent
+  // reference in the global allocator.
+  const base::BucketRanges* GetRanges(const base::BucketRanges& ranges) {
+    auto range = ranges_.equal_range(ranges.checksum());
+    for (auto it = range.first; it != range.second; ++it) {
+      if (it->second->Equals(&ranges))
+        return it->second.get();
+    }
+    auto copy = std::make_unique<base::BucketRanges>(ranges.size());
+    for (size_t i = 0; i < ranges.size(); ++i)
+      copy->set_range(i, ranges.range(i));
+    copy->ResetChecksum();
+    return ranges_.emplace(ranges.checksum(), std::move(copy))->second.get();
+  }
+
+  base::PersistentHistogramAllocator allocator_;
+  std::unordered_multimap<uint32_t, std::unique_ptr<base::BucketRanges>>
+      ranges_;
+  std::map<std::string, std::unique_ptr<base::HistogramBase>> histograms_;
+};
+
+// Opens the histogram file in |path|, chaining its segment files, if any.
+// Returns null if it can't be read.
+std::unique_ptr<base::PersistentHistogramAllocator> OpenHistogramFile(
+    const base::FilePath& path) {
+  std::unique_ptr<base::FilePersistentMemoryAllocator> memory;
+  for (size_t i = 0;; ++i) {
+    const base::FilePath segment_path =
+        base::FilePersistentMemoryAllocator::GetSegmentPath(path, i);
+    if (i > 0 && !base::PathExists(segment_path))
+      break;
+    auto mapped_file = std::make_unique<base::MemoryMappedFile>();
+    if (!mapped_file->Initialize(segment_path) ||
+        !base::FilePersistentMemoryAllocator::IsFileAcceptable(
+            *mapped_file, /*read_only=*/true)) {
+      return nullptr;
+    }
+    auto segment = std::make_unique<base::FilePersistentMemoryAllocator>(
+        std::move(mapped_file), 0, 0, "", /*read_only=*/true);
+    if (segment->IsCorrupt())
+      return nullptr;
+    if (!memory)
+      memory = std::move(segment);
+    else if (!memory->AddSegment(std::move(segment)))
+      return nullptr;
+  }
+  return std::make_unique<base::PersistentHistogramAllocator>(
+      std::move(memory));
+}
+
 }  // namespace
 
 namespace base {
@@ -79,6 +242,8 @@ PersistentHistogramStorage::PersistentHistogramStorage(
   GlobalHistogramAllocator::CreateWithPersistentMemory(memory, kAllocSize, 0,
                                                        0,  // No identifier.
                                                        allocator_name);
+  GlobalHistogramAllocator::Get()->memory_allocator()->SetMaxSegments(
+      kMaxSegments);
   GlobalHistogramAllocator::Get()->CreateTrackingHistograms(allocator_name);
 }
 
@@ -142,10 +307,91 @@ PersistentHistogramStorage::~PersistentHistogramStorage() {
 
   StringPiece contents(static_cast<const char*>(allocator->data()),
                        allocator->used());
+
+  // The segments of a memory that grew can only be read together, so their
+  // histograms are merged into a single one.
+  std::unique_ptr<HistogramMerger> merger;
+  PersistentMemoryAllocator* memory_allocator = allocator->memory_allocator();
+  if (memory_allocator->segment_count() > 1) {
+    merger = std::make_unique<HistogramMerger>(GetUsedSize(memory_allocator),
+                                               allocator->Name());
+    if (!merger->Merge(allocator)) {
+      LOG(ERROR) << "Persistent histograms fail to merge for file: "
+                 << file_path.value();
+      return;
+    }
+    contents = merger->contents();
+  }
+
   if (!ImportantFileWriter::WriteFileAtomically(file_path, contents)) {
     LOG(ERROR) << "Persistent histograms fail to write to file: "
                << file_path.value();
   }
 }
 
+// static
+bool PersistentHistogramStorage::CompactStorageDir(
+    const FilePath& storage_dir) {
+  std::vector<FilePath> paths;
+  FileEnumerator enumerator(
+      storage_dir, /*recursive=*/false, FileEnumerator::FILES,
+      FILE_PATH_LITERAL("*") +
+          FilePath::StringType(PersistentMemoryAllocator::kFileExtension));
+  for (FilePath path = enumerator.Next(); !path.empty();
+       path = enumerator.Next()) {
+    paths.push_back(std::move(path));
+  }
+  if (paths.empty() ||
+      (paths.size() == 1 &&
+       !PathExists(FilePersistentMemoryAllocator::GetSegmentPath(paths[0], 1)))) {
+    return true;
+  }
+  // File names are timestamps, so the merged file replaces the newest one.
+  std::sort(paths.begin(), paths.end());
+
+  std::vector<std::pair<FilePath, std::unique_ptr<PersistentHistogramAllocator>>>
+      sources;
+  size_t used = 0;
+  for (FilePath& path : paths) {
+    std::unique_ptr<PersistentHistogramAllocator> source =
+        OpenHistogramFile(path);
+    if (!source) {
+      LOG(ERROR) << "Persistent histograms fail to read from file: "
+                 << path.value();
+      continue;
+    }
+    used += GetUsedSize(source->memory_allocator());
+    sources.emplace_back(std::move(path), std::move(source));
+  }
+  if (sources.empty())
+    return true;
+
+  HistogramMerger merger(used, sources.front().second->Name());
+  for (auto& source : sources) {
+    if (!merger.Merge(source.second.get()))
+      return false;
+  }
+
+  // The files are unmapped before being replaced or deleted.
+  std::vector<FilePath> merged_paths;
+  for (auto& source : sources)
+    merged_paths.push_back(std::move(source.first));
+  sources.clear();
+  const FilePath& merged_path = merged_paths.back();
+  if (!ImportantFileWriter::WriteFileAtomically(merged_path,
+                                                merger.contents())) {
+    return false;
+  }
+  for (const FilePath& path : merged_paths) {
+    for (size_t i = path == merged_path ? 1 : 0;; ++i) {
+      const FilePath segment_path =
+          FilePersistentMemoryAllocator::GetSegmentPath(path, i);
+      if (i > 0 && !PathExists(segment_path))
+        break;
+      DeleteFile(segment_path);
+    }
+  }
+  return true;
+}
+
 }  // namespace base
@@ -11,12 +11,13 @@
 
 namespace base {
 
-// This class creates a fixed sized persistent memory to allow histograms to be
-// stored in it. When a PersistentHistogramStorage is destructed, histograms
-// recorded during its lifetime are persisted in the directory
-// |storage_base_dir_|/|allocator_name| (see the ctor for allocator_name).
-// Histograms are not persisted if the storage directory does not exist on
-// destruction. PersistentHistogramStorage should be instantiated as early as
+// This class creates a persistent memory, which grows by a few segments if
+// need be, to allow histograms to be stored in it. When a
+// PersistentHistogramStorage is destructed, histograms recorded during its
+// lifetime are persisted in the directory |storage_base_dir_|/|allocator_name|
+// (see the ctor for allocator_name), in a single file even if the memory
+// grew. Histograms are not persisted if the storage directory does not exist
+// on destruction. PersistentHistogramStorage should be instantiated as early as
 // possible in the process lifetime and should never be instantiated again.
 // Persisted histograms will eventually be reported by Chrome.
 class BASE_EXPORT PersistentHistogramStorage {
@@ -50,6 +51,13 @@ class BASE_EXPORT PersistentHistogramStorage {
   // Disables histogram storage.
   void Disable() { disabled_ = true; }
 
+  // Merges the histogram files in |storage_dir|, such as those that instances
+  // of this class write over several runs, into one, and deletes the others.
+  // Only the samples that aren't logged yet, which are those that a reader of
+  // the files reports, are kept. Files that can't be read are left alone, as
+  // are all of them if the merge fails, in which case this returns false.
+  static bool CompactStorageDir(const FilePath& storage_dir);
+
  private:
   // Metrics files are written into directory
   // |storage_base_dir_|/|allocator_name| (see the ctor for allocator_name).
@@ -4,13 +4,23 @@
 
 #include "base/metrics/persistent_histogram_storage.h"
 
+#include <map>
 #include <memory>
+#include <string>
+#include <vector>
 
+#include "base/files/file_enumerator.h"
 #include "base/files/file_path.h"
 #include "base/files/file_util.h"
+#include "base/files/memory_mapped_file.h"
 #include "base/files/scoped_temp_dir.h"
+#include "base/metrics/histogram_functions.h"
 #include "base/metrics/histogram_macros.h"
+#include "base/metrics/histogram_samples.h"
 #include "base/metrics/persistent_histogram_allocator.h"
+#include "base/metrics/persistent_memory_allocator.h"
+#include "base/metrics/statistics_recorder.h"
+#include "base/strings/stringprintf.h"
 #include "base/time/time.h"
 #include "build/build_config.h"
 #include "testing/gtest/include/gtest/gtest.h"
@@ -47,6 +57,54 @@ class PersistentHistogramStorageTest : public testing::Test {
 
   const FilePath& test_storage_dir() { return test_storage_dir_; }
 
+  // Gets the histogram files in the storage directory.
+  std::vector<FilePath> GetStorageFiles() {
+    std::vector<FilePath> paths;
+    FileEnumerator enumerator(test_storage_dir(), /*recursive=*/false,
+                              FileEnumerator::FILES);
+    for (FilePath path = enumerator.Next(); !path.empty();
+         path = enumerator.Next()) {
+      paths.push_back(path);
+    }
+    return paths;
+  }
+
+  // Gets the unlogged samples of the histograms in the file in |path|.
+  std::map<std::string, std::unique_ptr<HistogramSamples>> ReadHistogramFile(
+      const FilePath& path) {
+    std::map<std::string, std::unique_ptr<HistogramSamples>> samples;
+    auto mapped_file = std::make_unique<MemoryMappedFile>();
+    if (!mapped_file->Initialize(path))
+      return samples;
+    PersistentHistogramAllocator allocator(
+        std::make_unique<FilePersistentMemoryAllocator>(
+            std::move(mapped_file), 0, 0, "", /*read_only=*/true));
+    PersistentHistogramAllocator::Iterator iter(&allocator);
+    while (std::unique_ptr<HistogramBase> histogram = iter.GetNext())
+      samples[histogram->histogram_name()] = histogram->SnapshotFinalDelta();
+    return samples;
+  }
+
+  // Writes a histogram file named |name| to the storage directory, with
+  // |samples| in a linear and a sparse histogram, as a run of a process would.
+  void WriteHistogramFile(const std::string& name,
+                          const std::vector<int>& samples) {
+    std::unique_ptr<StatisticsRecorder> recorder =
+        StatisticsRecorder::CreateTemporaryForTesting();
+    GlobalHistogramAllocator::CreateWithLocalMemory(
+        64 << 10, 0, kTestHistogramAllocatorName);
+    for (int sample : samples) {
+      UmaHistogramExactLinear("Test.Linear", sample, 10);
+      UmaHistogramSparse("Test.Sparse", sample);
+    }
+    GlobalHistogramAllocator* allocator = GlobalHistogramAllocator::Get();
+    EXPECT_TRUE(WriteFile(
+        test_storage_dir().AppendASCII(name),
+        StringPiece(static_cast<const char*>(allocator->data()),
+                    allocator->used())));
+    GlobalHistogramAllocator::ReleaseForTesting();
+  }
+
  private:
   // A temporary directory where all file IO operations take place.
   ScopedTempDir temp_dir_;
@@ -78,6 +136,75 @@ TEST_F(PersistentHistogramStorageTest, HistogramWriteTest) {
   // Clean up for subsequent tests.
   GlobalHistogramAllocator::ReleaseForTesting();
 }
+
+TEST_F(PersistentHistogramStorageTest, GrowthTest) {
+  std::unique_ptr<StatisticsRecorder> recorder =
+      StatisticsRecorder::CreateTemporaryForTesting();
+  auto persistent_histogram_storage =
+      std::make_unique<PersistentHistogramStorage>(
+          kTestHistogramAllocatorName,
+          PersistentHistogramStorage::StorageDirManagement::kCreate);
+  persistent_histogram_storage->set_storage_base_dir(temp_dir_path());
+
+  // Enough histograms not to fit in the first segment.
+  constexpr int kHistogramCount = 10000;
+  for (int i = 0; i < kHistogramCount; ++i)
+    UmaHistogramCounts1000(StringPrintf("Test.Growth.%d", i), i % 1000);
+  EXPECT_LT(
+      1U,
+      GlobalHistogramAllocator::Get()->memory_allocator()->segment_count());
+  persistent_histogram_storage.reset();
+
+  // The histograms of all the segments are written to a single file.
+  std::vector<FilePath> paths = GetStorageFiles();
+  ASSERT_EQ(1U, paths.size());
+  std::map<std::string, std::unique_ptr<HistogramSamples>> samples =
+      ReadHistogramFile(paths[0]);
+  for (int i = 0; i < kHistogramCount; ++i) {
+    auto it = samples.find(StringPrintf("Test.Growth.%d", i));
+    ASSERT_NE(samples.end(), it);
+    EXPECT_EQ(1, it->second->TotalCount());
+    EXPECT_EQ(1, it->second->GetCount(i % 1000));
+  }
+
+  GlobalHistogramAllocator::ReleaseForTesting();
+}
+
+TEST_F(PersistentHistogramStorageTest, CompactStorageDirTest) {
+  ASSERT_TRUE(CreateDirectory(test_storage_dir()));
+  WriteHistogramFile("20220101000000.pma", {1, 2, 3});
+  WriteHistogramFile("20220101000001.pma", {3, 4});
+  WriteHistogramFile("20220101000002.pma", {5});
+  // A file that can't be read is left alone.
+  const FilePath bad_path = test_storage_dir().AppendASCII("bad.pma");
+  ASSERT_TRUE(WriteFile(bad_path, "bad"));
+
+  std::unique_ptr<StatisticsRecorder> recorder =
+      StatisticsRecorder::CreateTemporaryForTesting();
+  EXPECT_TRUE(PersistentHistogramStorage::CompactStorageDir(test_storage_dir()));
+
+  // The histograms are merged into the newest file.
+  std::vector<FilePath> paths = GetStorageFiles();
+  ASSERT_EQ(2U, paths.size());
+  EXPECT_TRUE(PathExists(bad_path));
+  const FilePath merged_path =
+      test_storage_dir().AppendASCII("20220101000002.pma");
+  ASSERT_TRUE(PathExists(merged_path));
+
+  std::map<std::string, std::unique_ptr<HistogramSamples>> samples =
+      ReadHistogramFile(merged_path);
+  for (const char* name : {"Test.Linear", "Test.Sparse"}) {
+    ASSERT_TRUE(samples[name]) << name;
+    EXPECT_EQ(6, samples[name]->TotalCount());
+    EXPECT_EQ(1, samples[name]->GetCount(1));
+    EXPECT_EQ(2, samples[name]->GetCount(3));
+    EXPECT_EQ(1, samples[name]->GetCount(5));
+  }
+
+  // Compacting again leaves the merged file as it is.
+  EXPECT_TRUE(PersistentHistogramStorage::CompactStorageDir(test_storage_dir()));
+  EXPECT_EQ(6, ReadHistogramFile(merged_path)["Test.Linear"]->TotalCount());
+}
 #endif  // !BUILDFLAG(IS_NACL)
 
 }  // namespace base
@@ -10,11 +10,13 @@
 
 #include "base/bits.h"
 #include "base/debug/alias.h"
+#include "base/files/file.h"
 #include "base/files/memory_mapped_file.h"
 #include "base/logging.h"
 #include "base/metrics/histogram_functions.h"
 #include "base/metrics/sparse_histogram.h"
 #include "base/numerics/safe_conversions.h"
+#include "base/strings/string_number_conversions.h"
 #include "base/strings/string_piece.h"
 #include "base/system/sys_info.h"
 #include "base/threading/scoped_blocking_call.h"
@@ -261,11 +263,11 @@ PersistentMemoryAllocator::Iterator::GetNext(uint32_t* type_return) {
   // making sure it doesn't iterate more times than the absolute maximum
   // number of allocations that could have been made. Callers are likely
   // to loop multiple times before it is detected but at least it stops.
-  const uint32_t freeptr = std::min(
-      allocator_->shared_meta()->freeptr.load(std::memory_order_relaxed),
-      allocator_->mem_size_);
-  const uint32_t max_records =
-      freeptr / (sizeof(BlockHeader) + kAllocAlignment);
+  size_t used = 0;
+  const size_t segment_count = allocator_->segment_count();
+  for (size_t i = 0; i < segment_count; ++i)
+    used += allocator_->GetSegment(i)->used();
+  const size_t max_records = used / (sizeof(BlockHeader) + kAllocAlignment);
   if (count > max_records) {
     allocator_->SetCorrupt();
     return kReferenceNull;
@@ -502,6 +504,9 @@ void PersistentMemoryAllocator::CreateTrackingHistograms(
 
 void PersistentMemoryAllocator::Flush(bool sync) {
   FlushPartial(used(), sync);
+  const size_t count = segment_count();
+  for (size_t i = 1; i < count; ++i)
+    segments_[i - 1]->Flush(sync);
 }
 
 void PersistentMemoryAllocator::SetMemoryState(uint8_t memory_state) {
@@ -522,11 +527,20 @@ PersistentMemoryAllocator::Reference PersistentMemoryAllocator::GetAsReference(
     const void* memory,
     uint32_t type_id) const {
   uintptr_t address = reinterpret_cast<uintptr_t>(memory);
-  if (address < reinterpret_cast<uintptr_t>(mem_base_))
+  if (address < reinterpret_cast<uintptr_t>(mem_base_) ||
+      address - reinterpret_cast<uintptr_t>(mem_base_) >= mem_size_) {
+    // The memory may be in a chained segment.
+    const size_t count = segment_count();
+    for (size_t i = 1; i < count; ++i) {
+      Reference ref = segments_[i - 1]->GetAsReference(memory, type_id);
+      if (ref)
+        return MakeChainedReference(i, ref);
+    }
     return kReferenceNull;
+  }
 
   uintptr_t offset = address - reinterpret_cast<uintptr_t>(mem_base_);
-  if (offset >= mem_size_ || offset < sizeof(BlockHeader))
+  if (offset < sizeof(BlockHeader))
     return kReferenceNull;
 
   Reference ref = static_cast<Reference>(offset) - sizeof(BlockHeader);
@@ -537,6 +551,12 @@ PersistentMemoryAllocator::Reference PersistentMemoryAllocator::GetAsReference(
 }
 
 size_t PersistentMemoryAllocator::GetAllocSize(Reference ref) const {
+  if (IsChainedReference(ref)) {
+    Reference segment_ref;
+    const PersistentMemoryAllocator* segment = GetSegmentOf(ref, &segment_ref);
+    return segment ? segment->GetAllocSize(segment_ref) : 0;
+  }
+
   const volatile BlockHeader* const block = GetBlock(ref, 0, 0, false, false);
   if (!block)
     return 0;
@@ -620,7 +640,8 @@ bool PersistentMemoryAllocator::ChangeType(Reference ref,
 PersistentMemoryAllocator::Reference PersistentMemoryAllocator::Allocate(
     size_t req_size,
     uint32_t type_id) {
-  Reference ref = AllocateImpl(req_size, type_id);
+  Reference ref = max_segments_ > 1 ? AllocateFromChain(req_size, type_id)
+                                    : AllocateImpl(req_size, type_id);
   if (ref) {
     // Success: Record this allocation in usage stats (if active).
     if (allocs_histogram_)
@@ -771,12 +792,51 @@ PersistentMemoryAllocator::Reference PersistentMemoryAllocator::AllocateImpl(
   }
 }
 
+PersistentMemoryAllocator::Reference
+PersistentMemoryAllocator::AllocateFromChain(size_t req_size,
+                                             uint32_t type_id) {
+  // Only the last segment is allocated from, without a lock like a single
+  // one. Whatever space the earlier ones have left is forgone.
+  for (;;) {
+    const size_t count = segment_count();
+    PersistentMemoryAllocator* const segment =
+        count == 1 ? this : segments_[count - 2].get();
+    const Reference ref = segment->AllocateImpl(req_size, type_id);
+    if (ref)
+      return MakeChainedReference(count - 1, ref);
+
+    // Failures other than a full segment would happen in a new one, too.
+    if (count >= max_segments_ || !segment->IsFull() || segment->IsCorrupt())
+      return kReferenceNull;
+
+    AutoLock auto_lock(segments_lock_);
+    // Another thread may have chained a segment in the meantime.
+    if (segment_count_.load(std::memory_order_relaxed) != count)
+      continue;
+    std::unique_ptr<PersistentMemoryAllocator> next = CreateNextSegment(count);
+    if (!next || next->IsReadonly() || next->IsCorrupt() ||
+        next->size() > kChainedSegmentMaxSize) {
+      return kReferenceNull;
+    }
+    segments_[count - 1] = std::move(next);
+    segment_count_.store(count + 1, std::memory_order_release);
+  }
+}
+
 void PersistentMemoryAllocator::GetMemoryInfo(MemoryInfo* meminfo) const {
-  uint32_t remaining = std::max(
-      mem_size_ - shared_meta()->freeptr.load(std::memory_order_relaxed),
-      (uint32_t)sizeof(BlockHeader));
-  meminfo->total = mem_size_;
-  meminfo->free = remaining - sizeof(BlockHeader);
+  meminfo->total = 0;
+  meminfo->free = 0;
+  const size_t count = segment_count();
+  for (size_t i = 0; i < count; ++i) {
+    const PersistentMemoryAllocator* segment = GetSegment(i);
+    uint32_t remaining =
+        std::max(segment->mem_size_ -
+                     segment->shared_meta()->freeptr.load(
+                         std::memory_order_relaxed),
+                 (uint32_t)sizeof(BlockHeader));
+    meminfo->total += segment->mem_size_;
+    meminfo->free += remaining - sizeof(BlockHeader);
+  }
 }
 
 void PersistentMemoryAllocator::MakeIterable(Reference ref) {
@@ -867,7 +927,48 @@ bool PersistentMemoryAllocator::IsCorrupt() const {
 }
 
 bool PersistentMemoryAllocator::IsFull() const {
-  return CheckFlag(&shared_meta()->flags, kFlagFull);
+  // The last segment is only full until the next one is chained.
+  const PersistentMemoryAllocator* last = GetSegment(segment_count() - 1);
+  return CheckFlag(&last->shared_meta()->flags, kFlagFull);
+}
+
+void PersistentMemoryAllocator::SetMaxSegments(size_t max_segments) {
+  DCHECK(!readonly_);
+  DCHECK_LE(mem_size_, kChainedSegmentMaxSize);
+  DCHECK_GE(max_segments, 1u);
+  DCHECK_LE(max_segments, static_cast<size_t>(kMaxSegments));
+  max_segments_ = max_segments;
+}
+
+bool PersistentMemoryAllocator::AddSegment(
+    std::unique_ptr<PersistentMemoryAllocator> segment) {
+  if (mem_size_ > kChainedSegmentMaxSize ||
+      segment->size() > kChainedSegmentMaxSize) {
+    return false;
+  }
+  AutoLock auto_lock(segments_lock_);
+  const size_t count = segment_count_.load(std::memory_order_relaxed);
+  if (count == kMaxSegments)
+    return false;
+  segments_[count - 1] = std::move(segment);
+  segment_count_.store(count + 1, std::memory_order_release);
+  return true;
+}
+
+const PersistentMemoryAllocator* PersistentMemoryAllocator::GetSegment(
+    size_t index) const {
+  DCHECK_LT(index, segment_count());
+  return index == 0 ? this : segments_[index - 1].get();
+}
+
+const PersistentMemoryAllocator* PersistentMemoryAllocator::GetSegmentOf(
+    Reference ref,
+    Reference* segment_ref) const {
+  const size_t index = ref >> kSegmentIndexShift;
+  if (index >= segment_count())
+    return nullptr;
+  *segment_ref = ref & (kChainedSegmentMaxSize - 1);
+  return segments_[index - 1].get();
 }
 
 // Dereference a block |ref| and ensure that it's valid for the desired
@@ -879,6 +980,14 @@ const volatile PersistentMemoryAllocator::BlockHeader*
 PersistentMemoryAllocator::GetBlock(Reference ref, uint32_t type_id,
                                     uint32_t size, bool queue_ok,
                                     bool free_ok) const {
+  if (IsChainedReference(ref)) {
+    Reference segment_ref;
+    const PersistentMemoryAllocator* segment = GetSegmentOf(ref, &segment_ref);
+    if (!segment)
+      return nullptr;
+    return segment->GetBlock(segment_ref, type_id, size, queue_ok, free_ok);
+  }
+
   // Handle special cases.
   if (ref == kReferenceQueue && queue_ok)
     return reinterpret_cast<const volatile BlockHeader*>(mem_base_ + ref);
@@ -919,6 +1028,11 @@ void PersistentMemoryAllocator::FlushPartial(size_t length, bool sync) {
   // tell the OS to write changes to disk now rather than when convenient.
 }
 
+std::unique_ptr<PersistentMemoryAllocator>
+PersistentMemoryAllocator::CreateNextSegment(size_t index) {
+  return std::make_unique<LocalPersistentMemoryAllocator>(mem_size_, Id(), "");
+}
+
 void PersistentMemoryAllocator::RecordError(int error) const {
   if (errors_histogram_)
     errors_histogram_->Add(error);
@@ -1120,6 +1234,39 @@ void FilePersistentMemoryAllocator::Cache() {
   debug::Alias(&total);
 }
 
+void FilePersistentMemoryAllocator::SetMaxSegmentFiles(const FilePath& path,
+                                                       size_t max_segments) {
+  DCHECK(!path.empty());
+  segment_path_ = path;
+  SetMaxSegments(max_segments);
+}
+
+// static
+FilePath FilePersistentMemoryAllocator::GetSegmentPath(const FilePath& path,
+                                                       size_t index) {
+  if (index == 0)
+    return path;
+  return path.AddExtensionASCII(NumberToString(index));
+}
+
+std::unique_ptr<PersistentMemoryAllocator>
+FilePersistentMemoryAllocator::CreateNextSegment(size_t index) {
+  if (segment_path_.empty())
+    return PersistentMemoryAllocator::CreateNextSegment(index);
+
+  File file(GetSegmentPath(segment_path_, index),
+            File::FLAG_CREATE_ALWAYS | File::FLAG_READ | File::FLAG_WRITE);
+  if (!file.IsValid())
+    return nullptr;
+  auto mapped_file = std::make_unique<MemoryMappedFile>();
+  if (!mapped_file->Initialize(std::move(file), {0, size()},
+                               MemoryMappedFile::READ_WRITE_EXTEND)) {
+    return nullptr;
+  }
+  return std::make_unique<FilePersistentMemoryAllocator>(
+      std::move(mapped_file), size(), Id(), "", false);
+}
+
 void FilePersistentMemoryAllocator::FlushPartial(size_t length, bool sync) {
   if (IsReadonly())
     return;
@@ -18,6 +18,7 @@
 #include "base/memory/raw_ptr.h"
 #include "base/memory/shared_memory_mapping.h"
 #include "base/strings/string_piece.h"
+#include "base/synchronization/lock.h"
 #include "build/build_config.h"
 
 namespace base {
@@ -93,6 +94,16 @@ class MemoryMappedFile;
 // for different natural word widths, they CANNOT be exchanged between CPUs
 // of different endianess. Attempts to do so will simply see the existing data
 // as corrupt and refuse to access any of it.
+//
+// SEGMENTS: An allocator can be allowed to chain more segments, each its own
+// allocator, once its memory is full (see SetMaxSegments()). References into
+// those carry the index of their segment in their top bits and iteration
+// goes through all of them in the order in which objects were made iterable.
+// Allocation stays lock-free but for the creation of a new segment. The chain
+// belongs to the allocator object, not to its memory, so other processes see
+// only the first segment. Readers of the saved segments of an allocator that
+// grew must chain them the same way, with AddSegment(), to make sense of the
+// references between them.
 class BASE_EXPORT PersistentMemoryAllocator {
  public:
   typedef uint32_t Reference;
@@ -256,6 +267,21 @@ class BASE_EXPORT PersistentMemoryAllocator {
     kSizeAny = 1  // Constant indicating that any array size is acceptable.
   };
 
+  enum : uint32_t {
+    // References into chained segments hold the index of their segment above
+    // this bit.
+    kSegmentIndexShift = 24,
+
+    // The largest segment that can be chained, or chain others. References
+    // into allocators larger than this are plain offsets, as always.
+    kChainedSegmentMaxSize = 1 << kSegmentIndexShift,
+  };
+
+  enum : size_t {
+    // The most segments, the first one included, that can be chained.
+    kMaxSegments = 16
+  };
+
   // This is the standard file extension (suitable for being passed to the
   // AddExtension() method of base::FilePath) for dumps of persistent memory.
   static const base::FilePath::CharType kFileExtension[];
@@ -343,7 +369,8 @@ class BASE_EXPORT PersistentMemoryAllocator {
 
   // Direct access to underlying memory segment. If the segment is shared
   // across threads or processes, reading data through these values does
-  // not guarantee consistency. Use with care. Do not write.
+  // not guarantee consistency. Use with care. Do not write. These are only
+  // about the first segment; use GetSegment() for the others.
   const void* data() const { return const_cast<const char*>(mem_base_); }
   size_t length() const { return mem_size_; }
   size_t size() const { return mem_size_; }
@@ -490,9 +517,28 @@ class BASE_EXPORT PersistentMemoryAllocator {
   // will fail and iteration may not locate all objects.
   bool IsCorrupt() const;
 
-  // Flag set if an allocation has failed because the memory segment was full.
+  // Flag set if an allocation has failed because the memory segment was full
+  // and no further one could be chained.
   bool IsFull() const;
 
+  // Lets the allocator chain up to |max_segments| segments, this one
+  // included, from CreateNextSegment() when an allocation doesn't fit in the
+  // last one. This must be writable and no larger than kChainedSegmentMaxSize,
+  // and must not be shared with other threads yet.
+  void SetMaxSegments(size_t max_segments);
+
+  // Chains |segment| after the existing ones. This is for readers of the
+  // segments of an allocator that grew, which must add them in order. It
+  // returns false if the segment can't be chained.
+  bool AddSegment(std::unique_ptr<PersistentMemoryAllocator> segment);
+
+  // Gets the number of chained segments, this one included, and the one at
+  // |index|, the first one being this allocator.
+  size_t segment_count() const {
+    return segment_count_.load(std::memory_order_acquire);
+  }
+  const PersistentMemoryAllocator* GetSegment(size_t index) const;
+
   // Update those "tracking" histograms which do not get updates during regular
   // operation, such as how much memory is currently used. This should be
   // called before such information is to be displayed or uploaded.
@@ -632,6 +678,13 @@ class BASE_EXPORT PersistentMemoryAllocator {
   // Implementation of Flush that accepts how much to flush.
   virtual void FlushPartial(size_t length, bool sync);
 
+  // Creates the empty segment to chain at |index| when the last one is full,
+  // or returns null if the allocator can't grow. By default, segments are of
+  // the same size as this one and in local memory, so they last only as long
+  // as the process.
+  virtual std::unique_ptr<PersistentMemoryAllocator> CreateNextSegment(
+      size_t index);
+
   volatile char* const mem_base_;  // Memory base. (char so sizeof guaranteed 1)
   const MemoryType mem_type_;      // Type of memory allocation.
   const uint32_t mem_size_;        // Size of entire memory segment.
@@ -655,9 +708,29 @@ class BASE_EXPORT PersistentMemoryAllocator {
     return reinterpret_cast<SharedMetadata*>(const_cast<char*>(mem_base_));
   }
 
+  // Makes a reference to |ref| within the segment at |index|.
+  static Reference MakeChainedReference(size_t index, Reference ref) {
+    return static_cast<Reference>(index << kSegmentIndexShift) | ref;
+  }
+
+  // Whether |ref| may point into a chained segment, in which case
+  // GetSegmentOf() must resolve it.
+  bool IsChainedReference(Reference ref) const {
+    return ref >= kChainedSegmentMaxSize && mem_size_ <= kChainedSegmentMaxSize;
+  }
+
+  // Gets the segment that the chained |ref| points into, and |ref| within it
+  // in |segment_ref|. Returns null if there is no such segment.
+  const PersistentMemoryAllocator* GetSegmentOf(Reference ref,
+                                                Reference* segment_ref) const;
+
   // Actual method for doing the allocation.
   Reference AllocateImpl(size_t size, uint32_t type_id);
 
+  // Allocates from the last segment of the chain, chaining a new one if it is
+  // full.
+  Reference AllocateFromChain(size_t size, uint32_t type_id);
+
   // Get the block header associated with a specific reference.
   const volatile BlockHeader* GetBlock(Reference ref, uint32_t type_id,
                                        uint32_t size, bool queue_ok,
@@ -689,6 +762,14 @@ class BASE_EXPORT PersistentMemoryAllocator {
   raw_ptr<HistogramBase> used_histogram_;    // Histogram recording used space.
   raw_ptr<HistogramBase> errors_histogram_;  // Histogram recording errors.
 
+  // The segments chained after this one. Those below |segment_count_| - 1
+  // never change once it has been released so they can be read without the
+  // lock, which only serializes the chaining of new ones.
+  std::unique_ptr<PersistentMemoryAllocator> segments_[kMaxSegments - 1];
+  std::atomic<size_t> segment_count_{1};
+  size_t max_segments_ = 1;
+  Lock segments_lock_;
+
   friend class PersistentMemoryAllocatorTest;
   FRIEND_TEST_ALL_PREFIXES(PersistentMemoryAllocatorTest, AllocateAndIterate);
 };
@@ -814,12 +895,27 @@ class BASE_EXPORT FilePersistentMemoryAllocator
   // but this can happen to any block of memory (i.e. swapped out).
   void Cache();
 
+  // Like SetMaxSegments() but with the new segments in files next to |path|,
+  // that of this allocator (see GetSegmentPath()). Creating them blocks so
+  // this is only for allocators that are used where blocking is allowed.
+  void SetMaxSegmentFiles(const FilePath& path, size_t max_segments);
+
+  // Gets the path of the file of the segment at |index| of the allocator in
+  // |path|. Beyond the first, which is |path| itself, the index is added as
+  // an extension so that the files aren't mistaken for whole allocators.
+  static FilePath GetSegmentPath(const FilePath& path, size_t index);
+
  protected:
   // PersistentMemoryAllocator:
   void FlushPartial(size_t length, bool sync) override;
+  std::unique_ptr<PersistentMemoryAllocator> CreateNextSegment(
+      size_t index) override;
 
  private:
   std::unique_ptr<MemoryMappedFile> mapped_file_;
+
+  // The path that segment files are created next to, if any.
+  FilePath segment_path_;
 };
 #endif  // !BUILDFLAG(IS_NACL)
 
@@ -5,6 +5,7 @@
 #include "base/metrics/persistent_memory_allocator.h"
 
 #include <memory>
+#include <vector>
 
 #include "base/files/file.h"
 #include "base/files/file_util.h"
@@ -613,6 +614,118 @@ TEST(LocalPersistentMemoryAllocatorTest, CreationTest) {
   EXPECT_FALSE(allocator.IsCorrupt());
 }
 
+TEST(LocalPersistentMemoryAllocatorTest, ChainedSegmentsTest) {
+  const uint32_t kSegmentSize = 16 << 10;
+  LocalPersistentMemoryAllocator allocator(kSegmentSize, TEST_ID, TEST_NAME);
+  allocator.SetMaxSegments(3);
+
+  // Made iterable only after the next segments have been chained.
+  const Reference first = allocator.Allocate(500, 1000);
+  ASSERT_NE(0U, first);
+
+  // Fill all the segments, making every other allocation iterable.
+  std::vector<Reference> iterables;
+  Reference ref;
+  uint32_t type = 1;
+  while ((ref = allocator.Allocate(500, type)) != 0) {
+    EXPECT_EQ(type, allocator.GetType(ref));
+    EXPECT_LE(500U, allocator.GetAllocSize(ref));
+    const char* memory = allocator.GetAsArray<char>(ref, type, 500);
+    ASSERT_TRUE(memory);
+    EXPECT_EQ(ref, allocator.GetAsReference(memory, type));
+    if (type % 2) {
+      allocator.MakeIterable(ref);
+      iterables.push_back(ref);
+    }
+    ++type;
+  }
+  allocator.MakeIterable(first);
+  iterables.push_back(first);
+  EXPECT_EQ(3U, allocator.segment_count());
+  EXPECT_TRUE(allocator.IsFull());
+  EXPECT_FALSE(allocator.IsCorrupt());
+  EXPECT_LT(90U, type);
+
+  // References into the first segment are plain offsets.
+  EXPECT_GT(kSegmentSize, first);
+  EXPECT_EQ(2U,
+            iterables[iterables.size() - 2] >>
+                PersistentMemoryAllocator::kSegmentIndexShift);
+
+  // Iteration is in the order of MakeIterable(), across segments.
+  PersistentMemoryAllocator::Iterator iter(&allocator);
+  uint32_t found_type;
+  for (Reference iterable : iterables)
+    EXPECT_EQ(iterable, iter.GetNext(&found_type));
+  EXPECT_EQ(0U, iter.GetNext(&found_type));
+  PersistentMemoryAllocator::Iterator resumed(&allocator, iterables[20]);
+  EXPECT_EQ(iterables[21], resumed.GetNext(&found_type));
+
+  PersistentMemoryAllocator::MemoryInfo meminfo;
+  allocator.GetMemoryInfo(&meminfo);
+  EXPECT_EQ(3U * kSegmentSize, meminfo.total);
+}
+
+// A thread that allocates from an allocator that it shares with others, like
+// AllocatorThread.
+class SharedAllocatorThread : public SimpleThread {
+ public:
+  SharedAllocatorThread(const std::string& name,
+                        PersistentMemoryAllocator* allocator)
+      : SimpleThread(name, Options()), allocator_(allocator) {}
+
+  void Run() override {
+    for (;;) {
+      uint32_t size = RandInt(1, 99);
+      uint32_t type = RandInt(100, 999);
+      Reference block = allocator_->Allocate(size, type);
+      if (!block)
+        break;
+
+      if (RandInt(0, 1)) {
+        allocator_->MakeIterable(block);
+        iterable_++;
+      }
+    }
+  }
+
+  unsigned iterable() { return iterable_; }
+
+ private:
+  raw_ptr<PersistentMemoryAllocator> allocator_;
+  unsigned iterable_ = 0;
+};
+
+TEST(LocalPersistentMemoryAllocatorTest, ChainedSegmentsParallelismTest) {
+  LocalPersistentMemoryAllocator allocator(64 << 10, TEST_ID, "");
+  allocator.SetMaxSegments(PersistentMemoryAllocator::kMaxSegments);
+
+  SharedAllocatorThread t1("t1", &allocator);
+  SharedAllocatorThread t2("t2", &allocator);
+  SharedAllocatorThread t3("t3", &allocator);
+  SharedAllocatorThread t4("t4", &allocator);
+  t1.Start();
+  t2.Start();
+  t3.Start();
+  t4.Start();
+  t1.Join();
+  t2.Join();
+  t3.Join();
+  t4.Join();
+
+  EXPECT_EQ(static_cast<size_t>(PersistentMemoryAllocator::kMaxSegments),
+            allocator.segment_count());
+  EXPECT_TRUE(allocator.IsFull());
+  EXPECT_FALSE(allocator.IsCorrupt());
+  PersistentMemoryAllocator::Iterator iter(&allocator);
+  uint32_t type;
+  unsigned count = 0;
+  while (iter.GetNext(&type) != 0)
+    ++count;
+  EXPECT_EQ(t1.iterable() + t2.iterable() + t3.iterable() + t4.iterable(),
+            count);
+}
+
 //----- {Writable,ReadOnly}SharedPersistentMemoryAllocator ---------------------
 
 TEST(SharedPersistentMemoryAllocatorTest, CreationTest) {
@@ -835,6 +948,54 @@ TEST(FilePersistentMemoryAllocatorTest, ExtendTest) {
   }
 }
 
+TEST(FilePersistentMemoryAllocatorTest, SegmentFilesTest) {
+  ScopedTempDir temp_dir;
+  ASSERT_TRUE(temp_dir.CreateUniqueTempDir());
+  FilePath file_path = temp_dir.GetPath().AppendASCII("segments.pma");
+  const size_t kSegmentSize = 16 << 10;
+
+  std::vector<Reference> iterables;
+  {
+    std::unique_ptr<MemoryMappedFile> mmfile(new MemoryMappedFile());
+    ASSERT_TRUE(mmfile->Initialize(
+        File(file_path,
+             File::FLAG_CREATE | File::FLAG_READ | File::FLAG_WRITE),
+        {0, kSegmentSize}, MemoryMappedFile::READ_WRITE_EXTEND));
+    FilePersistentMemoryAllocator allocator(std::move(mmfile), kSegmentSize,
+                                            TEST_ID, TEST_NAME, false);
+    allocator.SetMaxSegmentFiles(file_path, 2);
+    Reference ref;
+    while ((ref = allocator.Allocate(1000, 1)) != 0) {
+      allocator.MakeIterable(ref);
+      iterables.push_back(ref);
+    }
+    EXPECT_EQ(2U, allocator.segment_count());
+    EXPECT_FALSE(allocator.IsCorrupt());
+  }
+  EXPECT_TRUE(PathExists(
+      FilePersistentMemoryAllocator::GetSegmentPath(file_path, 1)));
+  EXPECT_FALSE(PathExists(
+      FilePersistentMemoryAllocator::GetSegmentPath(file_path, 2)));
+
+  // A reader must chain the segment files to find all the allocations.
+  std::unique_ptr<MemoryMappedFile> mmfile(new MemoryMappedFile());
+  ASSERT_TRUE(mmfile->Initialize(file_path));
+  FilePersistentMemoryAllocator reader(std::move(mmfile), 0, 0, "", true);
+  mmfile = std::make_unique<MemoryMappedFile>();
+  ASSERT_TRUE(mmfile->Initialize(
+      FilePersistentMemoryAllocator::GetSegmentPath(file_path, 1)));
+  ASSERT_TRUE(reader.AddSegment(std::make_unique<FilePersistentMemoryAllocator>(
+      std::move(mmfile), 0, 0, "", true)));
+  EXPECT_STREQ(TEST_NAME, reader.Name());
+
+  PersistentMemoryAllocator::Iterator iter(&reader);
+  uint32_t type;
+  for (Reference iterable : iterables)
+    EXPECT_EQ(iterable, iter.GetNext(&type));
+  EXPECT_EQ(0U, iter.GetNext(&type));
+  EXPECT_FALSE(reader.IsCorrupt());
+}
+
 TEST(FilePersistentMemoryAllocatorTest, AcceptableTest) {
   const uint32_t kAllocAlignment =
       PersistentMemoryAllocatorTest::GetAllocAlignment();
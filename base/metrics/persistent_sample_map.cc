@@ -80,21 +80,6 @@ void PersistentSampleMapIterator::SkipEmptyBuckets() {
   }
 }
 
-// This structure holds an entry for a PersistentSampleMap within a persistent
-// memory allocator. The "id" must be unique across all maps held by an
-// allocator or they will get attached to the wrong sample map.
-struct SampleRecord {
-  // SHA1(SampleRecord): Increment this if structure changes!
-  static constexpr uint32_t kPersistentTypeId = 0x8FE6A69F + 1;
-
-  // Expected size for 32/64-bit check.
-  static constexpr size_t kExpectedInstanceSize = 16;
-
-  uint64_t id;   // Unique identifier of owner.
-  Sample value;  // The value for which this record holds a count.
-  Count count;   // The count associated with the above value.
-};
-
 }  // namespace
 
 PersistentSampleMap::PersistentSampleMap(
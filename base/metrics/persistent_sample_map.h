@@ -9,6 +9,7 @@
 #ifndef BASE_METRICS_PERSISTENT_SAMPLE_MAP_H_
 #define BASE_METRICS_PERSISTENT_SAMPLE_MAP_H_
 
+#include <stddef.h>
 #include <stdint.h>
 
 #include <map>
@@ -29,6 +30,26 @@ class PersistentSampleMapRecords;
 // structures. Changes here likely need to be duplicated there.
 class BASE_EXPORT PersistentSampleMap : public HistogramSamples {
  public:
+  // This structure holds an entry for a PersistentSampleMap within a
+  // persistent memory allocator. The "id" must be unique across all maps held
+  // by an allocator or they will get attached to the wrong sample map. It is
+  // also that of PersistentAtomicSampleMap, which can be used on the same
+  // records.
+  struct SampleRecord {
+    // SHA1(SampleRecord): Increment this if structure changes!
+    static constexpr uint32_t kPersistentTypeId = 0x8FE6A69F + 1;
+
+    // Expected size for 32/64-bit check.
+    static constexpr size_t kExpectedInstanceSize = 16;
+
+    // Unique identifier of owner.
+    uint64_t id;
+    // The value for which this record holds a count.
+    HistogramBase::Sample value;
+    // The count associated with the above value.
+    HistogramBase::Count count;
+  };
+
   // Constructs a persistent sample map using a PersistentHistogramAllocator
   // as the data source for persistent records.
   PersistentSampleMap(uint64_t id,
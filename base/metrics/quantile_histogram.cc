@@ -0,0 +1,144 @@
+// Copyright 2022 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "base/metrics/quantile_histogram.h"
+
+#include <algorithm>
+#include <cmath>
+#include <utility>
+#include <vector>
+
+#include "base/bits.h"
+#include "base/check_op.h"
+#include "base/logging.h"
+#include "base/memory/ptr_util.h"
+#include "base/notreached.h"
+#include "base/pickle.h"
+
+namespace base {
+
+namespace {
+
+// The bits of a sample that its bucket keeps, after its leading one.
+constexpr uint32_t kPrecisionBits = 6;
+
+// The samples below are exact.
+constexpr HistogramBase::Sample kExactLimit = 2 << kPrecisionBits;
+
+// The number of low bits that the bucket of |value| ignores.
+uint32_t GetIgnoredBits(HistogramBase::Sample value) {
+  if (value < kExactLimit)
+    return 0;
+  const uint32_t bits =
+      32 - bits::CountLeadingZeroBits(static_cast<uint32_t>(value));
+  return bits - 1 - kPrecisionBits;
+}
+
+}  // namespace
+
+// static
+HistogramBase* QuantileHistogram::FactoryGet(const std::string& name,
+                                             int32_t flags) {
+  return FactoryGetOfType(
+      name, flags, QUANTILE_HISTOGRAM,
+      [](const char* permanent_name) -> std::unique_ptr<HistogramBase> {
+        return WrapUnique(new QuantileHistogram(permanent_name));
+      });
+}
+
+// static
+std::unique_ptr<HistogramBase> QuantileHistogram::PersistentCreate(
+    PersistentHistogramAllocator* allocator,
+    const char* name,
+    HistogramSamples::Metadata* meta,
+    HistogramSamples::Metadata* logged_meta) {
+  return WrapUnique(
+      new QuantileHistogram(allocator, name, meta, logged_meta));
+}
+
+QuantileHistogram::~QuantileHistogram() = default;
+
+// static
+HistogramBase::Sample QuantileHistogram::GetBucketMin(Sample value) {
+  value = std::clamp(value, 0, kSampleType_MAX - 1);
+  const uint32_t ignored_bits = GetIgnoredBits(value);
+  return (value >> ignored_bits) << ignored_bits;
+}
+
+// static
+HistogramBase::Sample QuantileHistogram::GetBucketSize(Sample bucket_min) {
+  DCHECK_EQ(bucket_min, GetBucketMin(bucket_min));
+  return Sample{1} << GetIgnoredBits(bucket_min);
+}
+
+// static
+double QuantileHistogram::GetQuantile(const HistogramSamples& samples,
+                                      double quantile) {
+  DCHECK_GE(quantile, 0.0);
+  DCHECK_LE(quantile, 1.0);
+  std::vector<std::pair<Sample, Count>> buckets;
+  int64_t total_count = 0;
+  for (std::unique_ptr<SampleCountIterator> it = samples.Iterator();
+       !it->Done(); it->Next()) {
+    Sample min;
+    int64_t max;
+    Count count;
+    it->Get(&min, &max, &count);
+    if (count <= 0)
+      continue;
+    buckets.emplace_back(GetBucketMin(min), count);
+    total_count += count;
+  }
+  if (total_count == 0)
+    return 0;
+  std::sort(buckets.begin(), buckets.end());
+
+  // The rank of the sample of |quantile|, from 1.
+  const int64_t rank = std::clamp<int64_t>(
+      static_cast<int64_t>(std::ceil(quantile * total_count)), 1, total_count);
+  int64_t count = 0;
+  for (const auto& [bucket_min, bucket_count] : buckets) {
+    count += bucket_count;
+    if (count >= rank)
+      return bucket_min + (GetBucketSize(bucket_min) - 1) / 2.0;
+  }
+  NOTREACHED();
+  return 0;
+}
+
+double QuantileHistogram::GetQuantile(double quantile) const {
+  return GetQuantile(*SnapshotSamples(), quantile);
+}
+
+HistogramType QuantileHistogram::GetHistogramType() const {
+  return QUANTILE_HISTOGRAM;
+}
+
+void QuantileHistogram::AddCount(Sample value, int count) {
+  AddCountAs(GetBucketMin(value), value, count);
+}
+
+QuantileHistogram::QuantileHistogram(const char* name)
+    : SparseHistogram(name) {}
+
+QuantileHistogram::QuantileHistogram(PersistentHistogramAllocator* allocator,
+                                     const char* name,
+                                     HistogramSamples::Metadata* meta,
+                                     HistogramSamples::Metadata* logged_meta)
+    : SparseHistogram(allocator, name, meta, logged_meta) {}
+
+HistogramBase* QuantileHistogram::DeserializeInfoImpl(PickleIterator* iter) {
+  std::string histogram_name;
+  int flags;
+  if (!iter->ReadString(&histogram_name) || !iter->ReadInt(&flags)) {
+    DLOG(ERROR) << "Pickle error decoding Histogram: " << histogram_name;
+    return nullptr;
+  }
+
+  flags &= ~HistogramBase::kIPCSerializationSourceFlag;
+
+  return QuantileHistogram::FactoryGet(histogram_name, flags);
+}
+
+}  // namespace base
@@ -0,0 +1,86 @@
+// Copyright 2022 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#ifndef BASE_METRICS_QUANTILE_HISTOGRAM_H_
+#define BASE_METRICS_QUANTILE_HISTOGRAM_H_
+
+#include <stdint.h>
+
+#include <memory>
+#include <string>
+
+#include "base/base_export.h"
+#include "base/metrics/histogram_base.h"
+#include "base/metrics/histogram_samples.h"
+#include "base/metrics/sparse_histogram.h"
+
+namespace base {
+
+class PersistentHistogramAllocator;
+class PickleIterator;
+
+// A histogram for the quantiles of samples which span many magnitudes, e.g.
+// latencies, with a relative error bounded for all of them: where a Histogram
+// would need thousands of buckets for the 99.9th percentile within 1%.
+//
+// The buckets are log-linear, as in HdrHistogram: the samples below 128 have
+// one bucket each, and each power of two above is split into 64 buckets. So a
+// bucket is at most 1/64th of its samples, and Quantile() returns its middle,
+// within 1/128th of the sample it stands for. The buckets are those of a
+// SparseHistogram, keyed by their minimum, so that only those with samples
+// take memory (at most 1664 of them), and the histogram is serialized,
+// persisted and merged across processes like a sparse one. The samples are
+// clamped to [0, INT_MAX - 1], and the sum is that of the bucket minimums.
+class BASE_EXPORT QuantileHistogram : public SparseHistogram {
+ public:
+  // If there's one with same name, return the existing one. If not, create a
+  // new one.
+  static HistogramBase* FactoryGet(const std::string& name, int32_t flags);
+
+  // Create a histogram using data in persistent storage. The allocator must
+  // live longer than the created histogram.
+  static std::unique_ptr<HistogramBase> PersistentCreate(
+      PersistentHistogramAllocator* allocator,
+      const char* name,
+      HistogramSamples::Metadata* meta,
+      HistogramSamples::Metadata* logged_meta);
+
+  QuantileHistogram(const QuantileHistogram&) = delete;
+  QuantileHistogram& operator=(const QuantileHistogram&) = delete;
+
+  ~QuantileHistogram() override;
+
+  // The minimum of the bucket of |value|, which is the sample it is recorded
+  // as, and the number of values in the bucket of |bucket_min|.
+  static Sample GetBucketMin(Sample value);
+  static Sample GetBucketSize(Sample bucket_min);
+
+  // Returns the estimate of the |quantile| of |samples|, which are those of a
+  // QuantileHistogram, e.g. its snapshot or a delta, or 0 if there are none.
+  // |quantile| is within [0, 1], e.g. 0.5 for the median.
+  static double GetQuantile(const HistogramSamples& samples, double quantile);
+
+  // GetQuantile() of all the samples of this histogram.
+  double GetQuantile(double quantile) const;
+
+  // HistogramBase implementation:
+  HistogramType GetHistogramType() const override;
+  void AddCount(Sample value, int count) override;
+
+ private:
+  explicit QuantileHistogram(const char* name);
+
+  QuantileHistogram(PersistentHistogramAllocator* allocator,
+                    const char* name,
+                    HistogramSamples::Metadata* meta,
+                    HistogramSamples::Metadata* logged_meta);
+
+  friend BASE_EXPORT HistogramBase* DeserializeHistogramInfo(
+      base::PickleIterator* iter);
+  static HistogramBase* DeserializeInfoImpl(base::PickleIterator* iter);
+};
+
+}  // namespace base
+
+#endif  // BASE_METRICS_QUANTILE_HISTOGRAM_H_
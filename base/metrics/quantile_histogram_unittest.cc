@@ -0,0 +1,198 @@
+// Copyright 2022 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "base/metrics/quantile_histogram.h"
+
+#include <stdint.h>
+
+#include <algorithm>
+#include <cmath>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "base/memory/raw_ptr.h"
+#include "base/metrics/histogram_base.h"
+#include "base/metrics/histogram_delta_serialization.h"
+#include "base/metrics/histogram_samples.h"
+#include "base/metrics/persistent_histogram_allocator.h"
+#include "base/metrics/persistent_memory_allocator.h"
+#include "base/metrics/statistics_recorder.h"
+#include "base/pickle.h"
+#include "testing/gtest/include/gtest/gtest.h"
+
+namespace base {
+
+// Test parameter indicates if a persistent memory allocator should be used
+// for histogram allocation. False will allocate histograms from the process
+// heap.
+class QuantileHistogramTest : public testing::TestWithParam<bool> {
+ public:
+  QuantileHistogramTest() : use_persistent_histogram_allocator_(GetParam()) {}
+  QuantileHistogramTest(const QuantileHistogramTest&) = delete;
+  QuantileHistogramTest& operator=(const QuantileHistogramTest&) = delete;
+
+ protected:
+  const int32_t kAllocatorMemorySize = 8 << 20;  // 8 MiB
+
+  void SetUp() override {
+    if (use_persistent_histogram_allocator_) {
+      GlobalHistogramAllocator::CreateWithLocalMemory(
+          kAllocatorMemorySize, 0, "QuantileHistogramAllocatorTest");
+      allocator_ = GlobalHistogramAllocator::Get()->memory_allocator();
+    }
+    statistics_recorder_ = StatisticsRecorder::CreateTemporaryForTesting();
+  }
+
+  void TearDown() override {
+    if (allocator_) {
+      ASSERT_FALSE(allocator_->IsFull());
+      ASSERT_FALSE(allocator_->IsCorrupt());
+    }
+    statistics_recorder_.reset();
+    allocator_ = nullptr;
+    GlobalHistogramAllocator::ReleaseForTesting();
+  }
+
+  const bool use_persistent_histogram_allocator_;
+
+  std::unique_ptr<StatisticsRecorder> statistics_recorder_;
+  raw_ptr<PersistentMemoryAllocator> allocator_ = nullptr;
+};
+
+// Run all QuantileHistogramTest cases with both heap and persistent memory.
+INSTANTIATE_TEST_SUITE_P(HeapAndPersistent,
+                         QuantileHistogramTest,
+                         testing::Bool());
+
+TEST_P(QuantileHistogramTest, Buckets) {
+  // Exact below 128.
+  for (HistogramBase::Sample value = 0; value < 128; ++value) {
+    EXPECT_EQ(value, QuantileHistogram::GetBucketMin(value));
+    EXPECT_EQ(1, QuantileHistogram::GetBucketSize(value));
+  }
+  EXPECT_EQ(0, QuantileHistogram::GetBucketMin(-5));
+
+  // Then contiguous buckets of at most 1/64th of their samples.
+  int64_t buckets = 128;
+  int64_t bucket_min = 128;
+  while (bucket_min < HistogramBase::kSampleType_MAX) {
+    const HistogramBase::Sample min =
+        static_cast<HistogramBase::Sample>(bucket_min);
+    const HistogramBase::Sample size = QuantileHistogram::GetBucketSize(min);
+    EXPECT_LE(int64_t{size} * 64, bucket_min);
+    const HistogramBase::Sample max =
+        static_cast<HistogramBase::Sample>(bucket_min + size - 1);
+    EXPECT_EQ(min, QuantileHistogram::GetBucketMin(min));
+    EXPECT_EQ(min, QuantileHistogram::GetBucketMin(max));
+    bucket_min += size;
+    ++buckets;
+  }
+  EXPECT_EQ(1664, buckets);
+  EXPECT_EQ(QuantileHistogram::GetBucketMin(HistogramBase::kSampleType_MAX - 1),
+            QuantileHistogram::GetBucketMin(HistogramBase::kSampleType_MAX));
+}
+
+TEST_P(QuantileHistogramTest, Quantiles) {
+  HistogramBase* histogram =
+      QuantileHistogram::FactoryGet("Quantile", HistogramBase::kNoFlags);
+  ASSERT_EQ(QUANTILE_HISTOGRAM, histogram->GetHistogramType());
+  EXPECT_EQ(use_persistent_histogram_allocator_,
+            (histogram->flags() & HistogramBase::kIsPersistent) != 0);
+  EXPECT_EQ(histogram, QuantileHistogram::FactoryGet("Quantile",
+                                                     HistogramBase::kNoFlags));
+  QuantileHistogram* quantile_histogram =
+      static_cast<QuantileHistogram*>(histogram);
+  EXPECT_EQ(0, quantile_histogram->GetQuantile(0.5));
+
+  // Samples of several magnitudes, e.g. latencies in microseconds.
+  std::vector<HistogramBase::Sample> samples;
+  uint32_t state = 7;
+  for (int i = 0; i < 20000; ++i) {
+    state = state * 1664525 + 1013904223;
+    const double exponent = (state >> 8) % 1500 / 100.0;
+    samples.push_back(static_cast<HistogramBase::Sample>(std::exp(exponent)));
+    histogram->Add(samples.back());
+  }
+  std::sort(samples.begin(), samples.end());
+
+  for (double quantile : {0.0, 0.01, 0.25, 0.5, 0.9, 0.99, 0.999, 1.0}) {
+    const size_t rank = std::max<size_t>(
+        static_cast<size_t>(std::ceil(quantile * samples.size())), 1);
+    const double expected = samples[rank - 1];
+    EXPECT_NEAR(expected, quantile_histogram->GetQuantile(quantile),
+                expected / 100)
+        << "quantile " << quantile;
+  }
+
+  // A delta gives the quantiles of its samples.
+  histogram->SnapshotDelta();
+  histogram->AddCount(1000, 3);
+  histogram->Add(5000);
+  std::unique_ptr<HistogramSamples> delta = histogram->SnapshotDelta();
+  EXPECT_EQ(4, delta->TotalCount());
+  EXPECT_NEAR(1000, QuantileHistogram::GetQuantile(*delta, 0.5), 10);
+  EXPECT_NEAR(5000, QuantileHistogram::GetQuantile(*delta, 1.0), 50);
+}
+
+TEST_P(QuantileHistogramTest, Serialize) {
+  HistogramBase* histogram = QuantileHistogram::FactoryGet(
+      "Quantile", HistogramBase::kIPCSerializationSourceFlag);
+
+  Pickle pickle;
+  histogram->SerializeInfo(&pickle);
+  PickleIterator iter(pickle);
+  int type;
+  EXPECT_TRUE(iter.ReadInt(&type));
+  EXPECT_EQ(QUANTILE_HISTOGRAM, type);
+  PickleIterator deserialize_iter(pickle);
+  EXPECT_EQ(histogram, DeserializeHistogramInfo(&deserialize_iter));
+}
+
+TEST_P(QuantileHistogramTest, DeltaSerialization) {
+  HistogramDeltaSerialization serializer("QuantileHistogramTest");
+  HistogramBase* histogram = QuantileHistogram::FactoryGet(
+      "Quantile", HistogramBase::kIPCSerializationSourceFlag);
+  histogram->AddCount(10, 2);
+  histogram->Add(100000);
+  std::vector<std::string> deltas;
+  serializer.PrepareAndSerializeDeltas(&deltas, true);
+  ASSERT_FALSE(deltas.empty());
+
+  // Clear kIPCSerializationSourceFlag to emulate multi-process usage.
+  histogram->ClearFlags(HistogramBase::kIPCSerializationSourceFlag);
+  HistogramDeltaSerialization::DeserializeAndAddSamples(deltas);
+
+  std::unique_ptr<HistogramSamples> samples = histogram->SnapshotSamples();
+  EXPECT_EQ(6, samples->TotalCount());
+  EXPECT_EQ(4, samples->GetCount(10));
+  EXPECT_EQ(2, samples->GetCount(QuantileHistogram::GetBucketMin(100000)));
+}
+
+TEST_P(QuantileHistogramTest, Persistent) {
+  if (!use_persistent_histogram_allocator_)
+    return;
+  HistogramBase* histogram =
+      QuantileHistogram::FactoryGet("Quantile", HistogramBase::kNoFlags);
+  for (int value = 1; value <= 1000; ++value)
+    histogram->Add(value);
+
+  // Another allocator on the same memory, e.g. in another process, sees the
+  // same samples.
+  PersistentHistogramAllocator recovery(
+      std::make_unique<PersistentMemoryAllocator>(
+          const_cast<void*>(allocator_->data()), allocator_->size(), 0, 0, "",
+          true));
+  PersistentHistogramAllocator::Iterator histogram_iter(&recovery);
+  std::unique_ptr<HistogramBase> recovered = histogram_iter.GetNext();
+  ASSERT_TRUE(recovered);
+  recovered->CheckName("Quantile");
+  ASSERT_EQ(QUANTILE_HISTOGRAM, recovered->GetHistogramType());
+  EXPECT_EQ(1000, recovered->SnapshotSamples()->TotalCount());
+  EXPECT_NEAR(500, static_cast<QuantileHistogram*>(recovered.get())
+                       ->GetQuantile(0.5),
+              5);
+}
+
+}  // namespace base
@@ -4,6 +4,8 @@
 
 #include "base/metrics/sample_vector.h"
 
+#include <algorithm>
+
 #include "base/check_op.h"
 #include "base/lazy_instance.h"
 #include "base/memory/ptr_util.h"
@@ -12,7 +14,13 @@
 #include "base/numerics/safe_conversions.h"
 #include "base/strings/stringprintf.h"
 #include "base/synchronization/lock.h"
+#include "base/system/sys_info.h"
 #include "base/threading/platform_thread.h"
+#include "build/build_config.h"
+
+#if BUILDFLAG(IS_LINUX) || BUILDFLAG(IS_CHROMEOS) || BUILDFLAG(IS_ANDROID)
+#include <sched.h>
+#endif
 
 // This SampleVector makes use of the single-sample embedded in the base
 // HistogramSamples class. If the count is non-zero then there is guaranteed
@@ -25,6 +33,100 @@ namespace base {
 typedef HistogramBase::Count Count;
 typedef HistogramBase::Sample Sample;
 
+namespace {
+
+constexpr size_t kCacheLineSize = 64;
+
+// More CPUs share shards.
+constexpr size_t kMaxShards = 64;
+
+// The shard of the current CPU or, where it isn't known, of the current
+// thread: threads mostly stay on a CPU.
+size_t GetCurrentShardIndex(size_t shard_count) {
+#if BUILDFLAG(IS_LINUX) || BUILDFLAG(IS_CHROMEOS) || BUILDFLAG(IS_ANDROID)
+  const int cpu = sched_getcpu();
+  if (cpu >= 0)
+    return static_cast<size_t>(cpu) % shard_count;
+#endif
+  // Thread ids can be multiples of 4, so mix them first.
+  const uint64_t id = static_cast<uint64_t>(PlatformThread::CurrentId());
+  return static_cast<size_t>((id * 0x9E3779B97F4A7C15u) >> 32) % shard_count;
+}
+
+}  // namespace
+
+// The samples which AccumulateSharded() recorded and FoldShards() didn't move
+// yet: for each shard, a cache line with their sum and count, and the lines of
+// the counts of the buckets.
+class SampleVectorBase::Shards {
+ public:
+  explicit Shards(size_t bucket_count)
+      : shard_count_(std::min<size_t>(
+            static_cast<size_t>(SysInfo::NumberOfProcessors()), kMaxShards)),
+        lines_per_shard_((bucket_count + kCountsPerLine - 1) / kCountsPerLine),
+        headers_(new Header[shard_count_]()),
+        lines_(new Line[shard_count_ * lines_per_shard_]()) {}
+  Shards(const Shards&) = delete;
+  Shards& operator=(const Shards&) = delete;
+  ~Shards() = default;
+
+  void Accumulate(size_t bucket_index, Sample value, Count count) {
+    const size_t shard = GetCurrentShardIndex(shard_count_);
+    Line& line =
+        lines_[shard * lines_per_shard_ + bucket_index / kCountsPerLine];
+    line.counts[bucket_index % kCountsPerLine].fetch_add(
+        count, std::memory_order_relaxed);
+    Header& header = headers_[shard];
+    header.sum.fetch_add(strict_cast<int64_t>(count) * value,
+                         std::memory_order_relaxed);
+    header.redundant_count.fetch_add(count, std::memory_order_relaxed);
+  }
+
+  // Moves the samples of all the shards to |counts|, |sum| and
+  // |redundant_count|, and returns whether there were any. The counts of
+  // concurrent Accumulate() calls are moved now or by the next call.
+  bool Extract(std::vector<HistogramBase::AtomicCount>* counts,
+               int64_t* sum,
+               Count* redundant_count) {
+    bool any = false;
+    for (size_t shard = 0; shard < shard_count_; ++shard) {
+      Header& header = headers_[shard];
+      if (header.redundant_count.load(std::memory_order_relaxed) == 0 &&
+          header.sum.load(std::memory_order_relaxed) == 0) {
+        continue;
+      }
+      any = true;
+      *sum += header.sum.exchange(0, std::memory_order_relaxed);
+      *redundant_count +=
+          header.redundant_count.exchange(0, std::memory_order_relaxed);
+      Line* line = &lines_[shard * lines_per_shard_];
+      for (size_t i = 0; i < counts->size(); ++i) {
+        std::atomic<Count>& count =
+            line[i / kCountsPerLine].counts[i % kCountsPerLine];
+        if (count.load(std::memory_order_relaxed) != 0)
+          (*counts)[i] += count.exchange(0, std::memory_order_relaxed);
+      }
+    }
+    return any;
+  }
+
+ private:
+  static constexpr size_t kCountsPerLine = kCacheLineSize / sizeof(Count);
+
+  struct alignas(kCacheLineSize) Header {
+    std::atomic<int64_t> sum;
+    std::atomic<Count> redundant_count;
+  };
+  struct alignas(kCacheLineSize) Line {
+    std::atomic<Count> counts[kCountsPerLine];
+  };
+
+  const size_t shard_count_;
+  const size_t lines_per_shard_;
+  const std::unique_ptr<Header[]> headers_;
+  const std::unique_ptr<Line[]> lines_;
+};
+
 SampleVectorBase::SampleVectorBase(uint64_t id,
                                    Metadata* meta,
                                    const BucketRanges* bucket_ranges)
@@ -32,7 +134,9 @@ SampleVectorBase::SampleVectorBase(uint64_t id,
   CHECK_GE(bucket_ranges_->bucket_count(), 1u);
 }
 
-SampleVectorBase::~SampleVectorBase() = default;
+SampleVectorBase::~SampleVectorBase() {
+  delete shards_.load(std::memory_order_relaxed);
+}
 
 void SampleVectorBase::Accumulate(Sample value, Count count) {
   const size_t bucket_index = GetBucketIndex(value);
@@ -67,6 +171,33 @@ void SampleVectorBase::Accumulate(Sample value, Count count) {
     RecordNegativeSample(SAMPLES_ACCUMULATE_OVERFLOW, count);
 }
 
+void SampleVectorBase::AccumulateSharded(Sample value, Count count) {
+  Shards* shards = shards_.load(std::memory_order_acquire);
+  if (UNLIKELY(!shards)) {
+    auto created = std::make_unique<Shards>(counts_size());
+    // If another thread won, |shards| is now theirs.
+    if (shards_.compare_exchange_strong(shards, created.get(),
+                                        std::memory_order_acq_rel)) {
+      shards = created.release();
+    }
+  }
+  shards->Accumulate(GetBucketIndex(value), value, count);
+}
+
+void SampleVectorBase::FoldShards() {
+  Shards* shards = shards_.load(std::memory_order_acquire);
+  if (!shards)
+    return;
+  std::vector<HistogramBase::AtomicCount> counts(counts_size());
+  int64_t sum = 0;
+  Count redundant_count = 0;
+  if (!shards->Extract(&counts, &sum, &redundant_count))
+    return;
+  IncreaseSumAndCount(sum, redundant_count);
+  SampleVectorIterator iter(&counts, bucket_ranges_);
+  AddSubtractImpl(&iter, ADD);
+}
+
 Count SampleVectorBase::GetCount(Sample value) const {
   return GetCountAtIndex(GetBucketIndex(value));
 }
@@ -223,37 +354,10 @@ size_t SampleVectorBase::GetBucketIndex(Sample value) const {
   CHECK_GE(value, bucket_ranges_->range(0));
   CHECK_LT(value, bucket_ranges_->range(bucket_count));
 
-  // For "exact" linear histograms, e.g. bucket_count = maximum + 1, their
-  // minimum is 1 and bucket sizes are 1. Thus, we don't need to binary search
-  // the bucket index. The bucket index for bucket |value| is just the |value|.
-  Sample maximum = bucket_ranges_->range(bucket_count - 1);
-  if (maximum == static_cast<Sample>(bucket_count - 1)) {
-    // |value| is in the underflow bucket.
-    if (value < 1)
-      return 0;
-    // |value| is in the overflow bucket.
-    if (value > maximum)
-      return bucket_count - 1;
-    return static_cast<size_t>(value);
-  }
-
-  size_t under = 0;
-  size_t over = bucket_count;
-  size_t mid;
-  do {
-    DCHECK_GE(over, under);
-    mid = under + (over - under)/2;
-    if (mid == under)
-      break;
-    if (bucket_ranges_->range(mid) <= value)
-      under = mid;
-    else
-      over = mid;
-  } while (true);
-
-  DCHECK_LE(bucket_ranges_->range(mid), value);
-  CHECK_GT(bucket_ranges_->range(mid + 1), value);
-  return mid;
+  const size_t index = bucket_ranges_->GetBucketIndex(value);
+  DCHECK_LE(bucket_ranges_->range(index), value);
+  CHECK_GT(bucket_ranges_->range(index + 1), value);
+  return index;
 }
 
 void SampleVectorBase::MoveSingleSampleToCounts() {
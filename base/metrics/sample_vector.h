@@ -47,6 +47,16 @@ class BASE_EXPORT SampleVectorBase : public HistogramSamples {
   // Get count of a specific bucket.
   HistogramBase::Count GetCountAtIndex(size_t bucket_index) const;
 
+  // Accumulates like Accumulate() but into the shard of the current CPU, or of
+  // the current thread where the CPU isn't known, so that the threads which
+  // record at once on different CPUs don't contend for the same cache lines.
+  // The other methods only see these samples once FoldShards() moved them.
+  void AccumulateSharded(HistogramBase::Sample value,
+                         HistogramBase::Count count);
+
+  // Moves the samples of the shards, if any, to the counts.
+  void FoldShards();
+
   // Access the bucket ranges held externally.
   const BucketRanges* bucket_ranges() const { return bucket_ranges_; }
 
@@ -108,6 +118,10 @@ class BASE_EXPORT SampleVectorBase : public HistogramSamples {
 
   // Shares the same BucketRanges with Histogram object.
   const raw_ptr<const BucketRanges> bucket_ranges_;
+
+  // Created by the first AccumulateSharded(), and then never changed. Owned.
+  class Shards;
+  std::atomic<Shards*> shards_{nullptr};
 };
 
 // A sample vector that uses local memory for the counts array.
@@ -8,8 +8,10 @@
 
 #include "base/logging.h"
 #include "base/memory/ptr_util.h"
+#include "base/metrics/atomic_sample_map.h"
 #include "base/metrics/dummy_histogram.h"
 #include "base/metrics/metrics_hashes.h"
+#include "base/metrics/persistent_atomic_sample_map.h"
 #include "base/metrics/persistent_histogram_allocator.h"
 #include "base/metrics/persistent_sample_map.h"
 #include "base/metrics/sample_map.h"
@@ -27,6 +29,19 @@ typedef HistogramBase::Sample Sample;
 // static
 HistogramBase* SparseHistogram::FactoryGet(const std::string& name,
                                            int32_t flags) {
+  return FactoryGetOfType(
+      name, flags, SPARSE_HISTOGRAM,
+      [](const char* permanent_name) -> std::unique_ptr<HistogramBase> {
+        return WrapUnique(new SparseHistogram(permanent_name));
+      });
+}
+
+// static
+HistogramBase* SparseHistogram::FactoryGetOfType(
+    const std::string& name,
+    int32_t flags,
+    HistogramType type,
+    std::unique_ptr<HistogramBase> (*heap_create)(const char* name)) {
   HistogramBase* histogram = StatisticsRecorder::FindHistogram(name);
   if (!histogram) {
     // TODO(gayane): |HashMetricName| is called again in Histogram constructor.
@@ -45,7 +60,7 @@ HistogramBase* SparseHistogram::FactoryGet(const std::string& name,
     PersistentHistogramAllocator* allocator = GlobalHistogramAllocator::Get();
     if (allocator) {
       tentative_histogram = allocator->AllocateHistogram(
-          SPARSE_HISTOGRAM, name, 0, 0, nullptr, flags, &histogram_ref);
+          type, name, 0, 0, nullptr, flags, &histogram_ref);
     }
 
     // Handle the case where no persistent allocator is present or the
@@ -54,7 +69,7 @@ HistogramBase* SparseHistogram::FactoryGet(const std::string& name,
       DCHECK(!histogram_ref);  // Should never have been set.
       DCHECK(!allocator);      // Shouldn't have failed.
       flags &= ~HistogramBase::kIsPersistent;
-      tentative_histogram.reset(new SparseHistogram(GetPermanentName(name)));
+      tentative_histogram = heap_create(GetPermanentName(name));
       tentative_histogram->SetFlags(flags);
     }
 
@@ -73,7 +88,7 @@ HistogramBase* SparseHistogram::FactoryGet(const std::string& name,
     }
   }
 
-  CHECK_EQ(SPARSE_HISTOGRAM, histogram->GetHistogramType());
+  CHECK_EQ(type, histogram->GetHistogramType());
   return histogram;
 }
 
@@ -110,14 +125,16 @@ void SparseHistogram::Add(Sample value) {
 }
 
 void SparseHistogram::AddCount(Sample value, int count) {
+  AddCountAs(value, value, count);
+}
+
+void SparseHistogram::AddCountAs(Sample key, Sample value, int count) {
   if (count <= 0) {
     NOTREACHED();
     return;
   }
-  {
-    base::AutoLock auto_lock(lock_);
-    unlogged_samples_->Accumulate(value, count);
-  }
+  // The unlogged samples are atomic, so they are recorded without the lock.
+  unlogged_samples_->Accumulate(key, count);
 
   if (UNLIKELY(StatisticsRecorder::have_active_callbacks()))
     FindAndRunCallbacks(value);
@@ -155,13 +172,16 @@ std::unique_ptr<HistogramSamples> SparseHistogram::SnapshotFinalDelta() const {
   return std::move(snapshot);
 }
 
+bool SparseHistogram::HasUnloggedSamples() const {
+  // The count is atomic, so it can be read without the lock.
+  return unlogged_samples_->redundant_count() != 0;
+}
+
 void SparseHistogram::AddSamples(const HistogramSamples& samples) {
-  base::AutoLock auto_lock(lock_);
   unlogged_samples_->Add(samples);
 }
 
 bool SparseHistogram::AddSamplesFromPickle(PickleIterator* iter) {
-  base::AutoLock auto_lock(lock_);
   return unlogged_samples_->AddFromPickle(iter);
 }
 
@@ -177,7 +197,7 @@ void SparseHistogram::SerializeInfoImpl(Pickle* pickle) const {
 
 SparseHistogram::SparseHistogram(const char* name)
     : HistogramBase(name),
-      unlogged_samples_(new SampleMap(HashMetricName(name))),
+      unlogged_samples_(new AtomicSampleMap(HashMetricName(name))),
       logged_samples_(new SampleMap(unlogged_samples_->id())) {}
 
 SparseHistogram::SparseHistogram(PersistentHistogramAllocator* allocator,
@@ -195,8 +215,9 @@ SparseHistogram::SparseHistogram(PersistentHistogramAllocator* allocator,
       // "active" samples use, for convenience purposes, an ID matching
       // that of the histogram while the "logged" samples use that number
       // plus 1.
-      unlogged_samples_(
-          new PersistentSampleMap(HashMetricName(name), allocator, meta)),
+      unlogged_samples_(new PersistentAtomicSampleMap(HashMetricName(name),
+                                                      allocator,
+                                                      meta)),
       logged_samples_(new PersistentSampleMap(unlogged_samples_->id() + 1,
                                               allocator,
                                               logged_meta)) {}
@@ -57,13 +57,10 @@ class BASE_EXPORT SparseHistogram : public HistogramBase {
   std::unique_ptr<HistogramSamples> SnapshotSamples() const override;
   std::unique_ptr<HistogramSamples> SnapshotDelta() override;
   std::unique_ptr<HistogramSamples> SnapshotFinalDelta() const override;
+  bool HasUnloggedSamples() const override;
   base::Value ToGraphDict() const override;
 
  protected:
-  // HistogramBase implementation:
-  void SerializeInfoImpl(base::Pickle* pickle) const override;
-
- private:
   // Clients should always use FactoryGet to create SparseHistogram.
   explicit SparseHistogram(const char* name);
 
@@ -72,6 +69,21 @@ class BASE_EXPORT SparseHistogram : public HistogramBase {
                   HistogramSamples::Metadata* meta,
                   HistogramSamples::Metadata* logged_meta);
 
+  // FactoryGet() for the subclasses: gets or creates a histogram of |type|,
+  // which |heap_create| creates when it can't be persistent.
+  static HistogramBase* FactoryGetOfType(
+      const std::string& name,
+      int32_t flags,
+      HistogramType type,
+      std::unique_ptr<HistogramBase> (*heap_create)(const char* name));
+
+  // AddCount() for the subclasses, which record |value| as the sample |key|.
+  void AddCountAs(Sample key, Sample value, int count);
+
+  // HistogramBase implementation:
+  void SerializeInfoImpl(base::Pickle* pickle) const override;
+
+ private:
   friend BASE_EXPORT HistogramBase* DeserializeHistogramInfo(
       base::PickleIterator* iter);
   static HistogramBase* DeserializeInfoImpl(base::PickleIterator* iter);
@@ -82,7 +94,9 @@ class BASE_EXPORT SparseHistogram : public HistogramBase {
   // For constructor calling.
   friend class SparseHistogramTest;
 
-  // Protects access to |samples_|.
+  // Serializes the snapshots. The samples are recorded without it: the
+  // unlogged ones are an AtomicSampleMap or a PersistentAtomicSampleMap, and
+  // the logged ones are only updated by the snapshots.
   mutable base::Lock lock_;
 
   // Flag to indicate if PrepareFinalDelta has been previously called.
@@ -121,6 +121,17 @@ TEST_P(SparseHistogramTest, BasicTest) {
   EXPECT_EQ(1, snapshot2->GetCount(101));
 }
 
+TEST_P(SparseHistogramTest, HasUnloggedSamples) {
+  HistogramBase* histogram = SparseHistogram::FactoryGet(
+      "UnloggedSparse", HistogramBase::kNoFlags);
+  EXPECT_FALSE(histogram->HasUnloggedSamples());
+
+  histogram->Add(100);
+  EXPECT_TRUE(histogram->HasUnloggedSamples());
+  EXPECT_EQ(1, histogram->SnapshotDelta()->TotalCount());
+  EXPECT_FALSE(histogram->HasUnloggedSamples());
+}
+
 TEST_P(SparseHistogramTest, BasicTestAddCount) {
   std::unique_ptr<SparseHistogram> histogram(NewSparseHistogram("Sparse"));
   std::unique_ptr<HistogramSamples> snapshot(histogram->SnapshotSamples());
@@ -7,6 +7,8 @@
 #include <memory>
 
 #include "base/at_exit.h"
+#include "base/bits.h"
+#include "base/compiler_specific.h"
 #include "base/containers/contains.h"
 #include "base/debug/leak_annotations.h"
 #include "base/json/string_escape.h"
@@ -24,6 +26,10 @@
 namespace base {
 namespace {
 
+// The capacity of the first table of a recorder, which holds a quarter as
+// many histograms.
+constexpr size_t kInitialTableCapacity = 64;
+
 bool HistogramNameLesser(const base::HistogramBase* a,
                          const base::HistogramBase* b) {
   return strcmp(a->histogram_name(), b->histogram_name()) < 0;
@@ -31,12 +37,75 @@ bool HistogramNameLesser(const base::HistogramBase* a,
 
 }  // namespace
 
+// The names are probed for linearly from their hash. A name is only ever
+// added, so a reader which finds an empty slot knows that the name is not
+// further on, but its histogram may change if it is forgotten and another
+// registered.
+class StatisticsRecorder::HistogramTable {
+ public:
+  explicit HistogramTable(size_t capacity)
+      : mask_(capacity - 1), slots_(new Slot[capacity]) {
+    DCHECK(bits::IsPowerOfTwo(capacity));
+  }
+
+  size_t capacity() const { return mask_ + 1; }
+
+  HistogramBase* Find(StringAtom name) const {
+    DCHECK(!name.empty());
+    for (size_t i = name.hash() & mask_;; i = (i + 1) & mask_) {
+      const StringAtom key = slots_[i].name.load(std::memory_order_acquire);
+      if (key == name)
+        return slots_[i].histogram.load(std::memory_order_acquire);
+      if (key.empty())
+        return nullptr;
+    }
+  }
+
+  // Returns false if |name| is not in the table and there's no room to add
+  // it. Over half of the slots are kept empty, so that probes stay short.
+  bool Set(StringAtom name, HistogramBase* histogram) {
+    DCHECK(!name.empty());
+    size_t i = name.hash() & mask_;
+    for (;; i = (i + 1) & mask_) {
+      const StringAtom key = slots_[i].name.load(std::memory_order_relaxed);
+      if (key == name) {
+        slots_[i].histogram.store(histogram, std::memory_order_release);
+        return true;
+      }
+      if (key.empty())
+        break;
+    }
+    if (!histogram)
+      return true;
+    if (2 * (size_ + 1) > capacity())
+      return false;
+    slots_[i].histogram.store(histogram, std::memory_order_relaxed);
+    slots_[i].name.store(name, std::memory_order_release);
+    ++size_;
+    return true;
+  }
+
+ private:
+  struct Slot {
+    std::atomic<StringAtom> name{StringAtom()};
+    std::atomic<HistogramBase*> histogram{nullptr};
+  };
+
+  const size_t mask_;
+  const std::unique_ptr<Slot[]> slots_;
+  size_t size_ = 0;
+};
+
 // static
-LazyInstance<Lock>::Leaky StatisticsRecorder::lock_;
+CONSTINIT Lazy<Lock> StatisticsRecorder::lock_;
 
 // static
 StatisticsRecorder* StatisticsRecorder::top_ = nullptr;
 
+// static
+std::atomic<const StatisticsRecorder::HistogramTable*>
+    StatisticsRecorder::top_table_{nullptr};
+
 // static
 bool StatisticsRecorder::is_vlog_initialized_ = false;
 
@@ -78,14 +147,18 @@ void StatisticsRecorder::ScopedHistogramSampleObserver::RunCallback(
 }
 
 StatisticsRecorder::~StatisticsRecorder() {
-  const AutoLock auto_lock(lock_.Get());
+  const AutoLock auto_lock(*lock_);
   DCHECK_EQ(this, top_);
   top_ = previous_;
+  // Only temporary recorders are deleted, so there are no readers left of the
+  // tables of this one.
+  top_table_.store(top_ ? top_->table_.get() : nullptr,
+                   std::memory_order_release);
 }
 
 // static
 void StatisticsRecorder::EnsureGlobalRecorderWhileLocked() {
-  lock_.Get().AssertAcquired();
+  lock_->AssertAcquired();
   if (top_)
     return;
 
@@ -98,7 +171,7 @@ void StatisticsRecorder::EnsureGlobalRecorderWhileLocked() {
 // static
 void StatisticsRecorder::RegisterHistogramProvider(
     const WeakPtr<HistogramProvider>& provider) {
-  const AutoLock auto_lock(lock_.Get());
+  const AutoLock auto_lock(*lock_);
   EnsureGlobalRecorderWhileLocked();
   top_->providers_.push_back(provider);
 }
@@ -108,11 +181,12 @@ HistogramBase* StatisticsRecorder::RegisterOrDeleteDuplicate(
     HistogramBase* histogram) {
   // Declared before |auto_lock| to ensure correct destruction order.
   std::unique_ptr<HistogramBase> histogram_deleter;
-  const AutoLock auto_lock(lock_.Get());
+  const AutoLock auto_lock(*lock_);
   EnsureGlobalRecorderWhileLocked();
 
   const char* const name = histogram->histogram_name();
-  HistogramBase*& registered = top_->histograms_[name];
+  const StringAtom atom(name);
+  HistogramBase*& registered = top_->histograms_[atom];
 
   if (!registered) {
     // |name| is guaranteed to never change or be deallocated so long
@@ -123,6 +197,8 @@ HistogramBase* StatisticsRecorder::RegisterOrDeleteDuplicate(
     // flag.
     if (base::Contains(top_->observers_, name))
       histogram->SetFlags(HistogramBase::kCallbackExists);
+    // Published for FindHistogram() once it's complete.
+    top_->SetInTableWhileLocked(atom, histogram);
 
     return histogram;
   }
@@ -144,7 +220,7 @@ const BucketRanges* StatisticsRecorder::RegisterOrDeleteDuplicateRanges(
 
   // Declared before |auto_lock| to ensure correct destruction order.
   std::unique_ptr<const BucketRanges> ranges_deleter;
-  const AutoLock auto_lock(lock_.Get());
+  const AutoLock auto_lock(*lock_);
   EnsureGlobalRecorderWhileLocked();
 
   const BucketRanges* const registered = *top_->ranges_.insert(ranges).first;
@@ -190,7 +266,7 @@ std::string StatisticsRecorder::ToJSON(JSONVerbosityLevel verbosity_level) {
 // static
 std::vector<const BucketRanges*> StatisticsRecorder::GetBucketRanges() {
   std::vector<const BucketRanges*> out;
-  const AutoLock auto_lock(lock_.Get());
+  const AutoLock auto_lock(*lock_);
   EnsureGlobalRecorderWhileLocked();
   out.reserve(top_->ranges_.size());
   out.assign(top_->ranges_.begin(), top_->ranges_.end());
@@ -204,17 +280,39 @@ HistogramBase* StatisticsRecorder::FindHistogram(base::StringPiece name) {
   // will acquire the lock at that time.
   ImportGlobalPersistentHistograms();
 
-  const AutoLock auto_lock(lock_.Get());
+  // A name which was never interned can't be a histogram's.
+  const absl::optional<StringAtom> atom = StringAtom::Find(name);
+  if (!atom)
+    return nullptr;
+  // The empty name isn't in the tables.
+  if (!atom->empty()) {
+    if (const HistogramTable* const table =
+            top_table_.load(std::memory_order_acquire)) {
+      return table->Find(*atom);
+    }
+  }
+
+  const AutoLock auto_lock(*lock_);
   EnsureGlobalRecorderWhileLocked();
 
-  const HistogramMap::const_iterator it = top_->histograms_.find(name);
+  return FindHistogramWhileLocked(name);
+}
+
+// static
+HistogramBase* StatisticsRecorder::FindHistogramWhileLocked(StringPiece name) {
+  lock_->AssertAcquired();
+  // A name which was never interned can't be a histogram's.
+  const absl::optional<StringAtom> atom = StringAtom::Find(name);
+  if (!atom)
+    return nullptr;
+  const HistogramMap::const_iterator it = top_->histograms_.find(*atom);
   return it != top_->histograms_.end() ? it->second : nullptr;
 }
 
 // static
 StatisticsRecorder::HistogramProviders
 StatisticsRecorder::GetHistogramProviders() {
-  const AutoLock auto_lock(lock_.Get());
+  const AutoLock auto_lock(*lock_);
   EnsureGlobalRecorderWhileLocked();
   return top_->providers_;
 }
@@ -245,7 +343,7 @@ void StatisticsRecorder::PrepareDeltas(
 
 // static
 void StatisticsRecorder::InitLogOnShutdown() {
-  const AutoLock auto_lock(lock_.Get());
+  const AutoLock auto_lock(*lock_);
   InitLogOnShutdownWhileLocked();
 }
 
@@ -254,7 +352,7 @@ void StatisticsRecorder::AddHistogramSampleObserver(
     const std::string& name,
     StatisticsRecorder::ScopedHistogramSampleObserver* observer) {
   DCHECK(observer);
-  const AutoLock auto_lock(lock_.Get());
+  const AutoLock auto_lock(*lock_);
   EnsureGlobalRecorderWhileLocked();
 
   scoped_refptr<HistogramSampleObserverList> observers;
@@ -266,9 +364,8 @@ void StatisticsRecorder::AddHistogramSampleObserver(
 
   top_->observers_[name]->AddObserver(observer);
 
-  const HistogramMap::const_iterator it = top_->histograms_.find(name);
-  if (it != top_->histograms_.end())
-    it->second->SetFlags(HistogramBase::kCallbackExists);
+  if (HistogramBase* histogram = FindHistogramWhileLocked(name))
+    histogram->SetFlags(HistogramBase::kCallbackExists);
 
   have_active_callbacks_.store(
       global_sample_callback() || !top_->observers_.empty(),
@@ -279,7 +376,7 @@ void StatisticsRecorder::AddHistogramSampleObserver(
 void StatisticsRecorder::RemoveHistogramSampleObserver(
     const std::string& name,
     StatisticsRecorder::ScopedHistogramSampleObserver* observer) {
-  const AutoLock auto_lock(lock_.Get());
+  const AutoLock auto_lock(*lock_);
   EnsureGlobalRecorderWhileLocked();
 
   auto iter = top_->observers_.find(name);
@@ -291,9 +388,8 @@ void StatisticsRecorder::RemoveHistogramSampleObserver(
     top_->observers_.erase(name);
 
     // We also clear the flag from the histogram (if it exists).
-    const HistogramMap::const_iterator it = top_->histograms_.find(name);
-    if (it != top_->histograms_.end())
-      it->second->ClearFlags(HistogramBase::kCallbackExists);
+    if (HistogramBase* histogram = FindHistogramWhileLocked(name))
+      histogram->ClearFlags(HistogramBase::kCallbackExists);
   }
 
   have_active_callbacks_.store(
@@ -307,7 +403,7 @@ void StatisticsRecorder::FindAndRunHistogramCallbacks(
     const char* histogram_name,
     uint64_t name_hash,
     HistogramBase::Sample sample) {
-  const AutoLock auto_lock(lock_.Get());
+  const AutoLock auto_lock(*lock_);
   EnsureGlobalRecorderWhileLocked();
 
   auto it = top_->observers_.find(histogram_name);
@@ -324,7 +420,7 @@ void StatisticsRecorder::FindAndRunHistogramCallbacks(
 // static
 void StatisticsRecorder::SetGlobalSampleCallback(
     const GlobalSampleCallback& new_global_sample_callback) {
-  const AutoLock auto_lock(lock_.Get());
+  const AutoLock auto_lock(*lock_);
   EnsureGlobalRecorderWhileLocked();
 
   DCHECK(!global_sample_callback() || !new_global_sample_callback);
@@ -337,22 +433,26 @@ void StatisticsRecorder::SetGlobalSampleCallback(
 
 // static
 size_t StatisticsRecorder::GetHistogramCount() {
-  const AutoLock auto_lock(lock_.Get());
+  const AutoLock auto_lock(*lock_);
   EnsureGlobalRecorderWhileLocked();
   return top_->histograms_.size();
 }
 
 // static
 void StatisticsRecorder::ForgetHistogramForTesting(base::StringPiece name) {
-  const AutoLock auto_lock(lock_.Get());
+  const AutoLock auto_lock(*lock_);
   EnsureGlobalRecorderWhileLocked();
 
-  const HistogramMap::iterator found = top_->histograms_.find(name);
+  const absl::optional<StringAtom> atom = StringAtom::Find(name);
+  if (!atom)
+    return;
+  const HistogramMap::iterator found = top_->histograms_.find(*atom);
   if (found == top_->histograms_.end())
     return;
 
   HistogramBase* const base = found->second;
-  if (base->GetHistogramType() != SPARSE_HISTOGRAM) {
+  if (base->GetHistogramType() != SPARSE_HISTOGRAM &&
+      base->GetHistogramType() != QUANTILE_HISTOGRAM) {
     // When forgetting a histogram, it's likely that other information is
     // also becoming invalid. Clear the persistent reference that may no
     // longer be valid. There's no danger in this as, at worst, duplicates
@@ -361,26 +461,27 @@ void StatisticsRecorder::ForgetHistogramForTesting(base::StringPiece name) {
   }
 
   top_->histograms_.erase(found);
+  top_->SetInTableWhileLocked(*atom, nullptr);
 }
 
 // static
 std::unique_ptr<StatisticsRecorder>
 StatisticsRecorder::CreateTemporaryForTesting() {
-  const AutoLock auto_lock(lock_.Get());
+  const AutoLock auto_lock(*lock_);
   return WrapUnique(new StatisticsRecorder());
 }
 
 // static
 void StatisticsRecorder::SetRecordChecker(
     std::unique_ptr<RecordHistogramChecker> record_checker) {
-  const AutoLock auto_lock(lock_.Get());
+  const AutoLock auto_lock(*lock_);
   EnsureGlobalRecorderWhileLocked();
   top_->record_checker_ = std::move(record_checker);
 }
 
 // static
 bool StatisticsRecorder::ShouldRecordHistogram(uint32_t histogram_hash) {
-  const AutoLock auto_lock(lock_.Get());
+  const AutoLock auto_lock(*lock_);
   EnsureGlobalRecorderWhileLocked();
   return !top_->record_checker_ ||
          top_->record_checker_->ShouldRecord(histogram_hash);
@@ -395,7 +496,7 @@ StatisticsRecorder::Histograms StatisticsRecorder::GetHistograms() {
 
   Histograms out;
 
-  const AutoLock auto_lock(lock_.Get());
+  const AutoLock auto_lock(*lock_);
   EnsureGlobalRecorderWhileLocked();
 
   out.reserve(top_->histograms_.size());
@@ -450,15 +551,38 @@ void StatisticsRecorder::ImportGlobalPersistentHistograms() {
 }
 
 StatisticsRecorder::StatisticsRecorder() {
-  lock_.Get().AssertAcquired();
+  lock_->AssertAcquired();
   previous_ = top_;
   top_ = this;
+  top_table_.store(nullptr, std::memory_order_release);
   InitLogOnShutdownWhileLocked();
 }
 
+void StatisticsRecorder::SetInTableWhileLocked(StringAtom name,
+                                               HistogramBase* histogram) {
+  lock_->AssertAcquired();
+  DCHECK_EQ(this, top_);
+  if (name.empty() || (table_ && table_->Set(name, histogram)))
+    return;
+
+  // Copy |histograms_|, which already has |histogram|, to a larger table.
+  size_t capacity = kInitialTableCapacity;
+  while (capacity < 4 * histograms_.size())
+    capacity *= 2;
+  auto table = std::make_unique<HistogramTable>(capacity);
+  for (const auto& entry : histograms_) {
+    if (!entry.first.empty())
+      CHECK(table->Set(entry.first, entry.second));
+  }
+  if (table_)
+    old_tables_.push_back(std::move(table_));
+  table_ = std::move(table);
+  top_table_.store(table_.get(), std::memory_order_release);
+}
+
 // static
 void StatisticsRecorder::InitLogOnShutdownWhileLocked() {
-  lock_.Get().AssertAcquired();
+  lock_->AssertAcquired();
   if (!is_vlog_initialized_ && VLOG_IS_ON(1)) {
     is_vlog_initialized_ = true;
     const auto dump_to_vlog = [](void*) {
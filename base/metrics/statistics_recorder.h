@@ -21,13 +21,15 @@
 
 #include "base/base_export.h"
 #include "base/callback.h"
+#include "base/containers/flat_hash_map.h"
 #include "base/gtest_prod_util.h"
-#include "base/lazy_instance.h"
+#include "base/lazy.h"
 #include "base/memory/raw_ptr.h"
 #include "base/memory/weak_ptr.h"
 #include "base/metrics/histogram_base.h"
 #include "base/metrics/record_histogram_checker.h"
 #include "base/observer_list_threadsafe.h"
+#include "base/strings/string_atom.h"
 #include "base/strings/string_piece.h"
 #include "base/synchronization/lock.h"
 #include "base/types/pass_key.h"
@@ -168,7 +170,8 @@ class BASE_EXPORT StatisticsRecorder {
   // Finds a histogram by name. Matches the exact name. Returns a null pointer
   // if a matching histogram is not found.
   //
-  // This method is thread safe.
+  // This method is thread safe, and takes no lock: it reads a copy of the
+  // histograms which is published whenever one is registered.
   static HistogramBase* FindHistogram(base::StringPiece name);
 
   // Imports histograms from providers.
@@ -295,8 +298,9 @@ class BASE_EXPORT StatisticsRecorder {
 
   typedef std::vector<WeakPtr<HistogramProvider>> HistogramProviders;
 
-  typedef std::unordered_map<StringPiece, HistogramBase*, StringPieceHash>
-      HistogramMap;
+  // The names are interned, so that finding a histogram hashes its name once
+  // and compares pointers.
+  typedef flat_hash_map<StringAtom, HistogramBase*> HistogramMap;
 
   // A map of histogram name to registered observers. If the histogram isn't
   // created yet, the observers will be added after creation.
@@ -353,7 +357,30 @@ class BASE_EXPORT StatisticsRecorder {
   // Precondition: The global lock is already acquired.
   static void InitLogOnShutdownWhileLocked();
 
+  // Returns the histogram named |name|, or nullptr if there is none.
+  //
+  // Precondition: The global lock is already acquired.
+  static HistogramBase* FindHistogramWhileLocked(StringPiece name);
+
+  // An open-addressed table of the histograms which FindHistogram() reads
+  // without the lock. Defined in the .cc file.
+  class HistogramTable;
+
+  // Sets the histogram in |table_| named |name| to |histogram|, or to none if
+  // |histogram| is null, growing |table_| as needed.
+  //
+  // Precondition: The global lock is already acquired.
+  void SetInTableWhileLocked(StringAtom name, HistogramBase* histogram);
+
   HistogramMap histograms_;
+
+  // The table of |histograms_|. It's only written to with the lock held, and
+  // is replaced by a larger copy when it fills up. The tables replaced are
+  // kept in |old_tables_| until this recorder is deleted, as readers may still
+  // be looking into them.
+  std::unique_ptr<HistogramTable> table_;
+  std::vector<std::unique_ptr<HistogramTable>> old_tables_;
+
   ObserverMap observers_;
   RangesMap ranges_;
   HistogramProviders providers_;
@@ -363,13 +390,17 @@ class BASE_EXPORT StatisticsRecorder {
   raw_ptr<StatisticsRecorder> previous_ = nullptr;
 
   // Global lock for internal synchronization.
-  static LazyInstance<Lock>::Leaky lock_;
+  static Lazy<Lock> lock_;
 
   // Current global recorder. This recorder is used by static methods. When a
   // new global recorder is created by CreateTemporaryForTesting(), then the
   // previous global recorder is referenced by top_->previous_.
   static StatisticsRecorder* top_;
 
+  // The |table_| of |top_|, if any, for FindHistogram() to read without the
+  // lock.
+  static std::atomic<const HistogramTable*> top_table_;
+
   // Tracks whether InitLogOnShutdownWhileLocked() has registered a logging
   // function that will be called when the program finishes.
   static bool is_vlog_initialized_;
@@ -20,6 +20,7 @@
 #include "base/metrics/persistent_histogram_allocator.h"
 #include "base/metrics/record_histogram_checker.h"
 #include "base/metrics/sparse_histogram.h"
+#include "base/strings/stringprintf.h"
 #include "base/test/task_environment.h"
 #include "base/values.h"
 #include "testing/gmock/include/gmock/gmock.h"
@@ -262,6 +263,30 @@ TEST_P(StatisticsRecorderTest, FindHistogram) {
   EXPECT_FALSE(StatisticsRecorder::FindHistogram("TestHistogram"));
 }
 
+TEST_P(StatisticsRecorderTest, FindManyHistograms) {
+  // Enough for the table which FindHistogram() reads to be replaced a few
+  // times.
+  std::vector<HistogramBase*> histograms;
+  for (int i = 0; i < 300; ++i) {
+    histograms.push_back(
+        Histogram::FactoryGet(StringPrintf("TestHistogram%d", i), 1, 1000, 10,
+                              HistogramBase::kNoFlags));
+  }
+  for (int i = 0; i < 300; ++i) {
+    EXPECT_EQ(histograms[i], StatisticsRecorder::FindHistogram(
+                                 StringPrintf("TestHistogram%d", i)));
+  }
+  EXPECT_FALSE(StatisticsRecorder::FindHistogram("TestHistogram300"));
+
+  StatisticsRecorder::ForgetHistogramForTesting("TestHistogram7");
+  EXPECT_FALSE(StatisticsRecorder::FindHistogram("TestHistogram7"));
+  EXPECT_EQ(histograms[8], StatisticsRecorder::FindHistogram("TestHistogram8"));
+
+  HistogramBase* const histogram = Histogram::FactoryGet(
+      "TestHistogram7", 1, 1000, 10, HistogramBase::kNoFlags);
+  EXPECT_EQ(histogram, StatisticsRecorder::FindHistogram("TestHistogram7"));
+}
+
 TEST_P(StatisticsRecorderTest, WithName) {
   Histogram::FactoryGet("TestHistogram1", 1, 1000, 10, Histogram::kNoFlags);
   Histogram::FactoryGet("TestHistogram2", 1, 1000, 10, Histogram::kNoFlags);
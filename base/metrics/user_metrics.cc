@@ -6,12 +6,18 @@
 
 #include <stddef.h>
 
+#include <utility>
 #include <vector>
 
 #include "base/bind.h"
 #include "base/lazy_instance.h"
 #include "base/location.h"
+#include "base/memory/ref_counted.h"
+#include "base/no_destructor.h"
+#include "base/synchronization/lock.h"
+#include "base/thread_annotations.h"
 #include "base/threading/thread_checker.h"
+#include "base/threading/thread_local.h"
 #include "base/time/time.h"
 #include "base/trace_event/base_tracing.h"
 
@@ -23,6 +29,87 @@ LazyInstance<std::vector<ActionCallback>>::DestructorAtExit g_callbacks =
 LazyInstance<scoped_refptr<SingleThreadTaskRunner>>::DestructorAtExit
     g_task_runner = LAZY_INSTANCE_INITIALIZER;
 
+// The actions recorded on a thread other than that of the task runner are
+// buffered, and the callbacks run for them in batches: a flush is posted
+// when the first action is buffered, which runs after |kFlushDelay| or
+// as soon as |kMaxBatchSize| actions are buffered, rather than a task for
+// each action.
+constexpr TimeDelta kFlushDelay = Milliseconds(100);
+constexpr size_t kMaxBatchSize = 64;
+
+void RunActionCallbacks(const std::string& action, TimeTicks action_time) {
+  for (const ActionCallback& callback : g_callbacks.Get()) {
+    callback.Run(action, action_time);
+  }
+}
+
+// The buffered actions of a thread. It outlives the thread as long as a
+// flush is posted, which there is whenever it isn't empty. The actions are
+// only taken out of it on the task runner's thread, so they are delivered in
+// the order in which they were recorded.
+class ActionBuffer : public RefCountedThreadSafe<ActionBuffer> {
+ public:
+  ActionBuffer() = default;
+  ActionBuffer(const ActionBuffer&) = delete;
+  ActionBuffer& operator=(const ActionBuffer&) = delete;
+
+  void Add(const std::string& action, TimeTicks action_time) {
+    TimeDelta delay;
+    {
+      AutoLock auto_lock(lock_);
+      actions_.emplace_back(action, action_time);
+      if (!flush_posted_) {
+        flush_posted_ = true;
+        flush_delayed_ = true;
+        delay = kFlushDelay;
+      } else if (flush_delayed_ && actions_.size() >= kMaxBatchSize) {
+        flush_delayed_ = false;
+      } else {
+        return;
+      }
+    }
+    g_task_runner.Get()->PostDelayedTask(
+        FROM_HERE, BindOnce(&ActionBuffer::Flush, this), delay);
+  }
+
+  // The actions of the current thread's buffer.
+  static ActionBuffer* GetForCurrentThread() {
+    static NoDestructor<ThreadLocalOwnedPointer<scoped_refptr<ActionBuffer>>>
+        buffers;
+    scoped_refptr<ActionBuffer>* buffer = buffers->Get();
+    if (!buffer) {
+      buffers->Set(std::make_unique<scoped_refptr<ActionBuffer>>(
+          MakeRefCounted<ActionBuffer>()));
+      buffer = buffers->Get();
+    }
+    return buffer->get();
+  }
+
+ private:
+  friend class RefCountedThreadSafe<ActionBuffer>;
+
+  ~ActionBuffer() = default;
+
+  void Flush() {
+    DCHECK(g_task_runner.Get()->BelongsToCurrentThread());
+    std::vector<std::pair<std::string, TimeTicks>> actions;
+    {
+      AutoLock auto_lock(lock_);
+      actions.swap(actions_);
+      flush_posted_ = false;
+      flush_delayed_ = false;
+    }
+    for (const auto& action : actions)
+      RunActionCallbacks(action.first, action.second);
+  }
+
+  Lock lock_;
+  std::vector<std::pair<std::string, TimeTicks>> actions_ GUARDED_BY(lock_);
+  // Whether a flush is posted, and whether it's only after |kFlushDelay|.
+  bool flush_posted_ GUARDED_BY(lock_) = false;
+  bool flush_delayed_ GUARDED_BY(lock_) = false;
+};
+
 }  // namespace
 
 void RecordAction(const UserMetricsAction& action) {
@@ -47,14 +134,11 @@ void RecordComputedActionAt(const std::string& action, TimeTicks action_time) {
   }
 
   if (!g_task_runner.Get()->BelongsToCurrentThread()) {
-    g_task_runner.Get()->PostTask(
-        FROM_HERE, BindOnce(&RecordComputedActionAt, action, action_time));
+    ActionBuffer::GetForCurrentThread()->Add(action, action_time);
     return;
   }
 
-  for (const ActionCallback& callback : g_callbacks.Get()) {
-    callback.Run(action, action_time);
-  }
+  RunActionCallbacks(action, action_time);
 }
 
 void AddActionCallback(const ActionCallback& callback) {
@@ -76,7 +76,9 @@ using ActionCallback = RepeatingCallback<void(const std::string&, TimeTicks)>;
 BASE_EXPORT void AddActionCallback(const ActionCallback& callback);
 BASE_EXPORT void RemoveActionCallback(const ActionCallback& callback);
 
-// Set the task runner on which to record actions.
+// Set the task runner on which to record actions. The callbacks run for the
+// actions recorded on other threads in batches, at most 100 ms after they
+// were recorded, and in the order in which each thread recorded them.
 BASE_EXPORT void SetRecordActionTaskRunner(
     scoped_refptr<SingleThreadTaskRunner> task_runner);
 
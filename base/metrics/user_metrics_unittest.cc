@@ -0,0 +1,82 @@
+// Copyright 2022 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "base/metrics/user_metrics.h"
+
+#include <string>
+#include <vector>
+
+#include "base/bind.h"
+#include "base/strings/string_number_conversions.h"
+#include "base/test/task_environment.h"
+#include "base/threading/simple_thread.h"
+#include "base/threading/thread_task_runner_handle.h"
+#include "base/time/time.h"
+#include "testing/gtest/include/gtest/gtest.h"
+
+namespace base {
+
+namespace {
+
+// Records |count| actions named after their index.
+class ActionThread : public SimpleThread {
+ public:
+  explicit ActionThread(int count)
+      : SimpleThread("ActionThread"), count_(count) {}
+
+  void Run() override {
+    for (int i = 0; i < count_; ++i)
+      RecordComputedAction(NumberToString(i));
+  }
+
+ private:
+  const int count_;
+};
+
+std::vector<std::string> Indices(int count) {
+  std::vector<std::string> indices;
+  for (int i = 0; i < count; ++i)
+    indices.push_back(NumberToString(i));
+  return indices;
+}
+
+}  // namespace
+
+TEST(UserMetricsTest, ActionsOfOtherThreads) {
+  test::TaskEnvironment task_environment(
+      test::TaskEnvironment::TimeSource::MOCK_TIME);
+  SetRecordActionTaskRunner(ThreadTaskRunnerHandle::Get());
+  std::vector<std::string> actions;
+  const ActionCallback callback = BindRepeating(
+      [](std::vector<std::string>* actions, const std::string& action,
+         TimeTicks action_time) { actions->push_back(action); },
+      &actions);
+  AddActionCallback(callback);
+
+  // The callbacks run right away for the actions of the task runner's thread.
+  RecordComputedAction("Main");
+  EXPECT_EQ(std::vector<std::string>{"Main"}, actions);
+  actions.clear();
+
+  // They run for those of other threads once a batch is old enough...
+  ActionThread few_actions(10);
+  few_actions.Start();
+  few_actions.Join();
+  task_environment.RunUntilIdle();
+  EXPECT_TRUE(actions.empty());
+  task_environment.FastForwardBy(Milliseconds(100));
+  EXPECT_EQ(Indices(10), actions);
+  actions.clear();
+
+  // ... or large enough.
+  ActionThread many_actions(1000);
+  many_actions.Start();
+  many_actions.Join();
+  task_environment.RunUntilIdle();
+  EXPECT_EQ(Indices(1000), actions);
+
+  RemoveActionCallback(callback);
+}
+
+}  // namespace base
@@ -0,0 +1,100 @@
+// Copyright 2022 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#ifndef BASE_NUMERICS_BATCH_MATH_H_
+#define BASE_NUMERICS_BATCH_MATH_H_
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include <algorithm>
+#include <type_traits>
+
+#include "base/numerics/batch_math_impl.h"
+#include "base/numerics/checked_math.h"
+#include "base/numerics/clamped_math.h"
+#include "base/numerics/safe_conversions.h"
+
+namespace base {
+
+// Versions of the clamped and checked operations over arrays, which give the
+// same results as the scalar operations element by element, but process whole
+// vectors of the listed types at a time: with SSE2 on x86-64 (and AVX2 for
+// some, when built for it), and with NEON on arm64. The other types and
+// platforms, and the elements past the last whole vector, use the scalar
+// operations.
+//
+// |out| may be |lhs| or |rhs|, but the arrays must not overlap otherwise.
+
+// out[i] = ClampAdd(lhs[i], rhs[i]), and likewise for ClampSub(). Vectorized
+// for 8-, 16- and 32-bit integers.
+template <typename T>
+void ClampAddBatch(const T* lhs, const T* rhs, T* out, size_t size) {
+  size_t i = internal::ClampAddBatchFastOp<T>::Do(lhs, rhs, out, size);
+  for (; i < size; ++i)
+    out[i] = ClampAdd(lhs[i], rhs[i]);
+}
+
+template <typename T>
+void ClampSubBatch(const T* lhs, const T* rhs, T* out, size_t size) {
+  size_t i = internal::ClampSubBatchFastOp<T>::Do(lhs, rhs, out, size);
+  for (; i < size; ++i)
+    out[i] = ClampSub(lhs[i], rhs[i]);
+}
+
+// out[i] = ClampMul(lhs[i], rhs[i]). Vectorized for 8- and 16-bit integers,
+// and on arm64 for 32-bit integers too.
+template <typename T>
+void ClampMulBatch(const T* lhs, const T* rhs, T* out, size_t size) {
+  size_t i = internal::ClampMulBatchFastOp<T>::Do(lhs, rhs, out, size);
+  for (; i < size; ++i)
+    out[i] = ClampMul(lhs[i], rhs[i]);
+}
+
+// dst[i] = saturated_cast<Dst>(src[i]). Vectorized from int32_t to 16- and
+// 8-bit integers, from int16_t and uint16_t to 8-bit integers, and from float
+// to int32_t, int16_t and uint8_t.
+template <typename Dst, typename Src>
+void SaturatedCastBatch(const Src* src, Dst* dst, size_t size) {
+  size_t i = internal::SaturatedCastBatchFastOp<Dst, Src>::Do(src, dst, size);
+  for (; i < size; ++i)
+    dst[i] = saturated_cast<Dst>(src[i]);
+}
+
+// Returns the sum of |data| as a CheckedNumeric<Acc>: the same value and
+// validity as adding the elements to a CheckedNumeric<Acc> one by one, which
+// is invalid if any of the partial sums doesn't fit in Acc. Vectorized for
+// 8- and 16-bit integers.
+template <typename Acc, typename T>
+CheckedNumeric<Acc> CheckedSumBatch(const T* data, size_t size) {
+  static_assert(std::is_integral<Acc>::value && std::is_integral<T>::value &&
+                    sizeof(T) <= sizeof(int32_t),
+                "CheckedSumBatch() sums integers of up to 32 bits.");
+  CheckedNumeric<Acc> sum = 0;
+  for (size_t begin = 0; begin < size;
+       begin += internal::kCheckedSumBlockSize) {
+    const T* const block = data + begin;
+    const size_t block_size =
+        std::min(size - begin, internal::kCheckedSumBlockSize);
+    int64_t positive = 0;
+    int64_t negative = 0;
+    internal::SumSigns(block, block_size, &positive, &negative);
+    // The partial sums within the block are all between these two, so the
+    // block only needs to be summed one by one if one of them doesn't fit.
+    if ((sum + positive).template IsValid<Acc>() &&
+        (sum + negative).template IsValid<Acc>()) {
+      sum += positive + negative;
+      continue;
+    }
+    for (size_t i = 0; i < block_size; ++i)
+      sum += block[i];
+    if (!sum.IsValid())
+      break;
+  }
+  return sum;
+}
+
+}  // namespace base
+
+#endif  // BASE_NUMERICS_BATCH_MATH_H_
@@ -0,0 +1,263 @@
+// Copyright 2022 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#ifndef BASE_NUMERICS_BATCH_MATH_ARM_IMPL_H_
+#define BASE_NUMERICS_BATCH_MATH_ARM_IMPL_H_
+
+#include <arm_neon.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#include "base/numerics/batch_math_impl.h"
+
+namespace base {
+namespace internal {
+
+// NEON kernels. NEON has saturating add and subtract instructions for all the
+// integer sizes, widening multiplies, and saturating narrowing, which together
+// give every kernel directly. Float to integer conversions saturate, and map
+// NaN to 0, as saturated_cast does.
+
+// Defines the kernel of OP_NAME for TYPE, a NEON operation on vectors of
+// VECTOR.
+#define BASE_NUMERICS_ARM_BATCH_OP(OP_NAME, TYPE, VECTOR, LOAD, STORE, OP) \
+  template <>                                                              \
+  struct OP_NAME##BatchFastOp<TYPE> {                                      \
+    static const bool is_supported = true;                                 \
+    static VECTOR Op(VECTOR a, VECTOR b) { return OP(a, b); }              \
+    static size_t Do(const TYPE* lhs, const TYPE* rhs, TYPE* out,          \
+                     size_t size) {                                        \
+      constexpr size_t kLanes = sizeof(VECTOR) / sizeof(TYPE);             \
+      size_t i = 0;                                                        \
+      for (; i + kLanes <= size; i += kLanes)                              \
+        STORE(out + i, Op(LOAD(lhs + i), LOAD(rhs + i)));                  \
+      return i;                                                            \
+    }                                                                      \
+  };
+
+#define BASE_NUMERICS_ARM_BATCH_OPS(TYPE, VECTOR, SUFFIX)                   \
+  BASE_NUMERICS_ARM_BATCH_OP(ClampAdd, TYPE, VECTOR, vld1q_##SUFFIX,        \
+                             vst1q_##SUFFIX, vqaddq_##SUFFIX)               \
+  BASE_NUMERICS_ARM_BATCH_OP(ClampSub, TYPE, VECTOR, vld1q_##SUFFIX,        \
+                             vst1q_##SUFFIX, vqsubq_##SUFFIX)               \
+  BASE_NUMERICS_ARM_BATCH_OP(ClampMul, TYPE, VECTOR, vld1q_##SUFFIX,        \
+                             vst1q_##SUFFIX, SaturatingMultiply)
+
+// Multiplies into lanes twice as wide, where the products fit, and narrows
+// them back with saturation.
+inline int8x16_t SaturatingMultiply(int8x16_t a, int8x16_t b) {
+  return vqmovn_high_s16(vqmovn_s16(vmull_s8(vget_low_s8(a), vget_low_s8(b))),
+                         vmull_high_s8(a, b));
+}
+
+inline uint8x16_t SaturatingMultiply(uint8x16_t a, uint8x16_t b) {
+  return vqmovn_high_u16(vqmovn_u16(vmull_u8(vget_low_u8(a), vget_low_u8(b))),
+                         vmull_high_u8(a, b));
+}
+
+inline int16x8_t SaturatingMultiply(int16x8_t a, int16x8_t b) {
+  return vqmovn_high_s32(
+      vqmovn_s32(vmull_s16(vget_low_s16(a), vget_low_s16(b))),
+      vmull_high_s16(a, b));
+}
+
+inline uint16x8_t SaturatingMultiply(uint16x8_t a, uint16x8_t b) {
+  return vqmovn_high_u32(
+      vqmovn_u32(vmull_u16(vget_low_u16(a), vget_low_u16(b))),
+      vmull_high_u16(a, b));
+}
+
+inline int32x4_t SaturatingMultiply(int32x4_t a, int32x4_t b) {
+  return vqmovn_high_s64(
+      vqmovn_s64(vmull_s32(vget_low_s32(a), vget_low_s32(b))),
+      vmull_high_s32(a, b));
+}
+
+inline uint32x4_t SaturatingMultiply(uint32x4_t a, uint32x4_t b) {
+  return vqmovn_high_u64(
+      vqmovn_u64(vmull_u32(vget_low_u32(a), vget_low_u32(b))),
+      vmull_high_u32(a, b));
+}
+
+BASE_NUMERICS_ARM_BATCH_OPS(int8_t, int8x16_t, s8)
+BASE_NUMERICS_ARM_BATCH_OPS(uint8_t, uint8x16_t, u8)
+BASE_NUMERICS_ARM_BATCH_OPS(int16_t, int16x8_t, s16)
+BASE_NUMERICS_ARM_BATCH_OPS(uint16_t, uint16x8_t, u16)
+BASE_NUMERICS_ARM_BATCH_OPS(int32_t, int32x4_t, s32)
+BASE_NUMERICS_ARM_BATCH_OPS(uint32_t, uint32x4_t, u32)
+
+#undef BASE_NUMERICS_ARM_BATCH_OPS
+#undef BASE_NUMERICS_ARM_BATCH_OP
+
+// Defines the saturated_cast kernel from SRC to DST, which converts the 16
+// bytes of |src| at a time with EXPRESSION, in terms of LOAD(offset).
+#define BASE_NUMERICS_ARM_SATURATED_CAST(DST, SRC, STORE, EXPRESSION)   \
+  template <>                                                          \
+  struct SaturatedCastBatchFastOp<DST, SRC> {                          \
+    static const bool is_supported = true;                             \
+    static size_t Do(const SRC* src, DST* dst, size_t size) {          \
+      constexpr size_t kLanes = 16 / sizeof(DST);                      \
+      size_t i = 0;                                                    \
+      for (; i + kLanes <= size; i += kLanes) {                        \
+        const SRC* const vectors = src + i;                            \
+        STORE(dst + i, EXPRESSION);                                    \
+      }                                                                \
+      return i;                                                        \
+    }                                                                  \
+  };
+
+// Narrowing to 16 bits first doesn't change which values saturate to 8 bits,
+// and converting floats to int32_t first doesn't change which values saturate
+// to 16 or 8 bits, nor how the others are truncated.
+BASE_NUMERICS_ARM_SATURATED_CAST(
+    int16_t,
+    int32_t,
+    vst1q_s16,
+    vqmovn_high_s32(vqmovn_s32(vld1q_s32(vectors)), vld1q_s32(vectors + 4)))
+BASE_NUMERICS_ARM_SATURATED_CAST(
+    uint16_t,
+    int32_t,
+    vst1q_u16,
+    vqmovun_high_s32(vqmovun_s32(vld1q_s32(vectors)), vld1q_s32(vectors + 4)))
+BASE_NUMERICS_ARM_SATURATED_CAST(
+    int8_t,
+    int32_t,
+    vst1q_s8,
+    vqmovn_high_s16(
+        vqmovn_s16(vqmovn_high_s32(vqmovn_s32(vld1q_s32(vectors)),
+                                   vld1q_s32(vectors + 4))),
+        vqmovn_high_s32(vqmovn_s32(vld1q_s32(vectors + 8)),
+                        vld1q_s32(vectors + 12))))
+BASE_NUMERICS_ARM_SATURATED_CAST(
+    uint8_t,
+    int32_t,
+    vst1q_u8,
+    vqmovun_high_s16(
+        vqmovun_s16(vqmovn_high_s32(vqmovn_s32(vld1q_s32(vectors)),
+                                    vld1q_s32(vectors + 4))),
+        vqmovn_high_s32(vqmovn_s32(vld1q_s32(vectors + 8)),
+                        vld1q_s32(vectors + 12))))
+BASE_NUMERICS_ARM_SATURATED_CAST(
+    int8_t,
+    int16_t,
+    vst1q_s8,
+    vqmovn_high_s16(vqmovn_s16(vld1q_s16(vectors)), vld1q_s16(vectors + 8)))
+BASE_NUMERICS_ARM_SATURATED_CAST(
+    uint8_t,
+    int16_t,
+    vst1q_u8,
+    vqmovun_high_s16(vqmovun_s16(vld1q_s16(vectors)), vld1q_s16(vectors + 8)))
+BASE_NUMERICS_ARM_SATURATED_CAST(
+    uint8_t,
+    uint16_t,
+    vst1q_u8,
+    vqmovn_high_u16(vqmovn_u16(vld1q_u16(vectors)), vld1q_u16(vectors + 8)))
+BASE_NUMERICS_ARM_SATURATED_CAST(int32_t,
+                                 float,
+                                 vst1q_s32,
+                                 vcvtq_s32_f32(vld1q_f32(vectors)))
+BASE_NUMERICS_ARM_SATURATED_CAST(
+    int16_t,
+    float,
+    vst1q_s16,
+    vqmovn_high_s32(vqmovn_s32(vcvtq_s32_f32(vld1q_f32(vectors))),
+                    vcvtq_s32_f32(vld1q_f32(vectors + 4))))
+BASE_NUMERICS_ARM_SATURATED_CAST(
+    uint8_t,
+    float,
+    vst1q_u8,
+    vqmovun_high_s16(
+        vqmovun_s16(
+            vqmovn_high_s32(vqmovn_s32(vcvtq_s32_f32(vld1q_f32(vectors))),
+                            vcvtq_s32_f32(vld1q_f32(vectors + 4)))),
+        vqmovn_high_s32(vqmovn_s32(vcvtq_s32_f32(vld1q_f32(vectors + 8))),
+                        vcvtq_s32_f32(vld1q_f32(vectors + 12)))))
+
+#undef BASE_NUMERICS_ARM_SATURATED_CAST
+
+// The signs of 8- and 16-bit integers are summed into 32-bit lanes by pairwise
+// widening additions. A block adds at most 2 * 32768 * kCheckedSumBlockSize /
+// 8 to a lane.
+template <>
+struct SumSignsBatchFastOp<int16_t> {
+  static const bool is_supported = true;
+  static size_t Do(const int16_t* data,
+                   size_t size,
+                   int64_t* positive,
+                   int64_t* negative) {
+    const int16x8_t zero = vdupq_n_s16(0);
+    int32x4_t positive_lanes = vdupq_n_s32(0);
+    int32x4_t negative_lanes = vdupq_n_s32(0);
+    size_t i = 0;
+    for (; i + 8 <= size; i += 8) {
+      const int16x8_t vector = vld1q_s16(data + i);
+      positive_lanes = vpadalq_s16(positive_lanes, vmaxq_s16(vector, zero));
+      negative_lanes = vpadalq_s16(negative_lanes, vminq_s16(vector, zero));
+    }
+    *positive += vaddlvq_s32(positive_lanes);
+    *negative += vaddlvq_s32(negative_lanes);
+    return i;
+  }
+};
+
+template <>
+struct SumSignsBatchFastOp<int8_t> {
+  static const bool is_supported = true;
+  static size_t Do(const int8_t* data,
+                   size_t size,
+                   int64_t* positive,
+                   int64_t* negative) {
+    const int8x16_t zero = vdupq_n_s8(0);
+    int32x4_t positive_lanes = vdupq_n_s32(0);
+    int32x4_t negative_lanes = vdupq_n_s32(0);
+    size_t i = 0;
+    for (; i + 16 <= size; i += 16) {
+      const int8x16_t vector = vld1q_s8(data + i);
+      positive_lanes = vpadalq_s16(positive_lanes,
+                                   vpaddlq_s8(vmaxq_s8(vector, zero)));
+      negative_lanes = vpadalq_s16(negative_lanes,
+                                   vpaddlq_s8(vminq_s8(vector, zero)));
+    }
+    *positive += vaddlvq_s32(positive_lanes);
+    *negative += vaddlvq_s32(negative_lanes);
+    return i;
+  }
+};
+
+template <>
+struct SumSignsBatchFastOp<uint16_t> {
+  static const bool is_supported = true;
+  static size_t Do(const uint16_t* data,
+                   size_t size,
+                   int64_t* positive,
+                   int64_t*) {
+    uint32x4_t lanes = vdupq_n_u32(0);
+    size_t i = 0;
+    for (; i + 8 <= size; i += 8)
+      lanes = vpadalq_u16(lanes, vld1q_u16(data + i));
+    *positive += static_cast<int64_t>(vaddlvq_u32(lanes));
+    return i;
+  }
+};
+
+template <>
+struct SumSignsBatchFastOp<uint8_t> {
+  static const bool is_supported = true;
+  static size_t Do(const uint8_t* data,
+                   size_t size,
+                   int64_t* positive,
+                   int64_t*) {
+    uint32x4_t lanes = vdupq_n_u32(0);
+    size_t i = 0;
+    for (; i + 16 <= size; i += 16)
+      lanes = vpadalq_u16(lanes, vpaddlq_u8(vld1q_u8(data + i)));
+    *positive += static_cast<int64_t>(vaddlvq_u32(lanes));
+    return i;
+  }
+};
+
+}  // namespace internal
+}  // namespace base
+
+#endif  // BASE_NUMERICS_BATCH_MATH_ARM_IMPL_H_
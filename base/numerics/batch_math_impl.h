@@ -0,0 +1,87 @@
+// Copyright 2022 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#ifndef BASE_NUMERICS_BATCH_MATH_IMPL_H_
+#define BASE_NUMERICS_BATCH_MATH_IMPL_H_
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include <algorithm>
+#include <type_traits>
+
+#include "build/build_config.h"
+
+namespace base {
+namespace internal {
+
+// The vectorized kernels of the batch operations. Each processes a prefix of
+// its arrays, a whole number of vectors long, and returns the number of
+// elements it processed; the caller does the rest with the scalar operation.
+// These are the boilerplate implementations for the types and platforms
+// without a kernel, which process nothing.
+template <typename T>
+struct ClampAddBatchFastOp {
+  static const bool is_supported = false;
+  static size_t Do(const T*, const T*, T*, size_t) { return 0; }
+};
+
+template <typename T>
+struct ClampSubBatchFastOp {
+  static const bool is_supported = false;
+  static size_t Do(const T*, const T*, T*, size_t) { return 0; }
+};
+
+template <typename T>
+struct ClampMulBatchFastOp {
+  static const bool is_supported = false;
+  static size_t Do(const T*, const T*, T*, size_t) { return 0; }
+};
+
+template <typename Dst, typename Src>
+struct SaturatedCastBatchFastOp {
+  static const bool is_supported = false;
+  static size_t Do(const Src*, Dst*, size_t) { return 0; }
+};
+
+// Adds the positive elements of |data| to |*positive| and the negative ones to
+// |*negative|. |size| is at most kCheckedSumBlockSize.
+template <typename T>
+struct SumSignsBatchFastOp {
+  static const bool is_supported = false;
+  static size_t Do(const T*, size_t, int64_t*, int64_t*) { return 0; }
+};
+
+// CheckedSumBatch() checks a block of this many elements at once. The sums of
+// the signs of a block of 32-bit integers fit in an int64_t, and the kernels
+// can sum a block of 8- or 16-bit integers in 32-bit lanes.
+constexpr size_t kCheckedSumBlockSize = 4096;
+
+template <typename T>
+void SumSigns(const T* data,
+              size_t size,
+              int64_t* positive,
+              int64_t* negative) {
+  size_t i = SumSignsBatchFastOp<T>::Do(data, size, positive, negative);
+  int64_t positive_sum = 0;
+  int64_t negative_sum = 0;
+  for (; i < size; ++i) {
+    const int64_t value = data[i];
+    positive_sum += std::max<int64_t>(value, 0);
+    negative_sum += std::min<int64_t>(value, 0);
+  }
+  *positive += positive_sum;
+  *negative += negative_sum;
+}
+
+}  // namespace internal
+}  // namespace base
+
+#if defined(ARCH_CPU_X86_64)
+#include "base/numerics/batch_math_x86_impl.h"
+#elif defined(ARCH_CPU_ARM64)
+#include "base/numerics/batch_math_arm_impl.h"
+#endif
+
+#endif  // BASE_NUMERICS_BATCH_MATH_IMPL_H_
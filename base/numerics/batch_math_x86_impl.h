@@ -0,0 +1,557 @@
+// Copyright 2022 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#ifndef BASE_NUMERICS_BATCH_MATH_X86_IMPL_H_
+#define BASE_NUMERICS_BATCH_MATH_X86_IMPL_H_
+
+#include <immintrin.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#include "base/numerics/batch_math_impl.h"
+
+namespace base {
+namespace internal {
+
+// SSE2 kernels, which every x86-64 CPU runs. The saturating add, subtract and
+// multiply kernels of 8- and 16-bit integers also have AVX2 versions, used
+// when the code is built for AVX2.
+
+inline __m128i LoadVector(const void* data) {
+  return _mm_loadu_si128(static_cast<const __m128i*>(data));
+}
+
+inline void StoreVector(void* data, __m128i vector) {
+  _mm_storeu_si128(static_cast<__m128i*>(data), vector);
+}
+
+#if defined(__AVX2__)
+inline __m256i LoadVector256(const void* data) {
+  return _mm256_loadu_si256(static_cast<const __m256i*>(data));
+}
+
+inline void StoreVector256(void* data, __m256i vector) {
+  _mm256_storeu_si256(static_cast<__m256i*>(data), vector);
+}
+#endif  // defined(__AVX2__)
+
+// Applies Kernel::Op() to the vectors of |lhs| and |rhs|. Kernels with
+// kHasAvx2 also have an Op() for 256-bit vectors.
+template <typename Kernel, typename T>
+size_t BinaryBatchLoop(const T* lhs, const T* rhs, T* out, size_t size) {
+  size_t i = 0;
+#if defined(__AVX2__)
+  if constexpr (Kernel::kHasAvx2) {
+    constexpr size_t kLanes = sizeof(__m256i) / sizeof(T);
+    for (; i + kLanes <= size; i += kLanes) {
+      StoreVector256(out + i, Kernel::Op(LoadVector256(lhs + i),
+                                         LoadVector256(rhs + i)));
+    }
+  }
+#endif  // defined(__AVX2__)
+  constexpr size_t kLanes = sizeof(__m128i) / sizeof(T);
+  for (; i + kLanes <= size; i += kLanes)
+    StoreVector(out + i, Kernel::Op(LoadVector(lhs + i), LoadVector(rhs + i)));
+  return i;
+}
+
+// Defines the kernel of OP_NAME for TYPE, which is a single SSE2 instruction
+// and a single AVX2 one.
+#if defined(__AVX2__)
+#define BASE_NUMERICS_X86_BATCH_OP(OP_NAME, TYPE, SSE2_OP, AVX2_OP)          \
+  template <>                                                                \
+  struct OP_NAME##BatchFastOp<TYPE> {                                        \
+    static const bool is_supported = true;                                   \
+    static constexpr bool kHasAvx2 = true;                                   \
+    static __m128i Op(__m128i a, __m128i b) { return SSE2_OP(a, b); }        \
+    static __m256i Op(__m256i a, __m256i b) { return AVX2_OP(a, b); }        \
+    static size_t Do(const TYPE* lhs, const TYPE* rhs, TYPE* out,            \
+                     size_t size) {                                          \
+      return BinaryBatchLoop<OP_NAME##BatchFastOp>(lhs, rhs, out, size);     \
+    }                                                                        \
+  };
+#else
+#define BASE_NUMERICS_X86_BATCH_OP(OP_NAME, TYPE, SSE2_OP, AVX2_OP)          \
+  template <>                                                                \
+  struct OP_NAME##BatchFastOp<TYPE> {                                        \
+    static const bool is_supported = true;                                   \
+    static constexpr bool kHasAvx2 = false;                                  \
+    static __m128i Op(__m128i a, __m128i b) { return SSE2_OP(a, b); }        \
+    static size_t Do(const TYPE* lhs, const TYPE* rhs, TYPE* out,            \
+                     size_t size) {                                          \
+      return BinaryBatchLoop<OP_NAME##BatchFastOp>(lhs, rhs, out, size);     \
+    }                                                                        \
+  };
+#endif  // defined(__AVX2__)
+
+BASE_NUMERICS_X86_BATCH_OP(ClampAdd, int8_t, _mm_adds_epi8, _mm256_adds_epi8)
+BASE_NUMERICS_X86_BATCH_OP(ClampAdd, uint8_t, _mm_adds_epu8, _mm256_adds_epu8)
+BASE_NUMERICS_X86_BATCH_OP(ClampAdd, int16_t, _mm_adds_epi16, _mm256_adds_epi16)
+BASE_NUMERICS_X86_BATCH_OP(ClampAdd,
+                           uint16_t,
+                           _mm_adds_epu16,
+                           _mm256_adds_epu16)
+BASE_NUMERICS_X86_BATCH_OP(ClampSub, int8_t, _mm_subs_epi8, _mm256_subs_epi8)
+BASE_NUMERICS_X86_BATCH_OP(ClampSub, uint8_t, _mm_subs_epu8, _mm256_subs_epu8)
+BASE_NUMERICS_X86_BATCH_OP(ClampSub, int16_t, _mm_subs_epi16, _mm256_subs_epi16)
+BASE_NUMERICS_X86_BATCH_OP(ClampSub,
+                           uint16_t,
+                           _mm_subs_epu16,
+                           _mm256_subs_epu16)
+
+#undef BASE_NUMERICS_X86_BATCH_OP
+
+// SSE2 has no saturating 32-bit arithmetic, nor unsigned 32-bit comparisons.
+// Flipping the sign bits turns an unsigned comparison into a signed one.
+inline __m128i CompareGreaterUnsigned32(__m128i a, __m128i b) {
+  const __m128i sign = _mm_set1_epi32(INT32_MIN);
+  return _mm_cmpgt_epi32(_mm_xor_si128(a, sign), _mm_xor_si128(b, sign));
+}
+
+// Returns |saturated| in the lanes where the sign bit of |overflow| is set, and
+// |result| in the others.
+inline __m128i SelectOnOverflow32(__m128i overflow,
+                                  __m128i saturated,
+                                  __m128i result) {
+  const __m128i mask = _mm_srai_epi32(overflow, 31);
+  return _mm_or_si128(_mm_and_si128(mask, saturated),
+                      _mm_andnot_si128(mask, result));
+}
+
+// The saturated result of an operation that overflowed from |a|: INT32_MAX if
+// |a| isn't negative, and INT32_MIN if it is.
+inline __m128i SaturateFrom32(__m128i a) {
+  return _mm_xor_si128(_mm_srai_epi32(a, 31), _mm_set1_epi32(INT32_MAX));
+}
+
+template <>
+struct ClampAddBatchFastOp<int32_t> {
+  static const bool is_supported = true;
+  static constexpr bool kHasAvx2 = false;
+  // The sum overflowed if its sign differs from the signs of both operands.
+  static __m128i Op(__m128i a, __m128i b) {
+    const __m128i sum = _mm_add_epi32(a, b);
+    const __m128i overflow =
+        _mm_and_si128(_mm_xor_si128(a, sum), _mm_xor_si128(b, sum));
+    return SelectOnOverflow32(overflow, SaturateFrom32(a), sum);
+  }
+  static size_t Do(const int32_t* lhs,
+                   const int32_t* rhs,
+                   int32_t* out,
+                   size_t size) {
+    return BinaryBatchLoop<ClampAddBatchFastOp>(lhs, rhs, out, size);
+  }
+};
+
+template <>
+struct ClampAddBatchFastOp<uint32_t> {
+  static const bool is_supported = true;
+  static constexpr bool kHasAvx2 = false;
+  // The sum carried if it is less than an operand.
+  static __m128i Op(__m128i a, __m128i b) {
+    const __m128i sum = _mm_add_epi32(a, b);
+    return _mm_or_si128(sum, CompareGreaterUnsigned32(a, sum));
+  }
+  static size_t Do(const uint32_t* lhs,
+                   const uint32_t* rhs,
+                   uint32_t* out,
+                   size_t size) {
+    return BinaryBatchLoop<ClampAddBatchFastOp>(lhs, rhs, out, size);
+  }
+};
+
+template <>
+struct ClampSubBatchFastOp<int32_t> {
+  static const bool is_supported = true;
+  static constexpr bool kHasAvx2 = false;
+  // The difference overflowed if the operands have different signs, and its
+  // sign differs from the sign of |a|.
+  static __m128i Op(__m128i a, __m128i b) {
+    const __m128i difference = _mm_sub_epi32(a, b);
+    const __m128i overflow =
+        _mm_and_si128(_mm_xor_si128(a, b), _mm_xor_si128(a, difference));
+    return SelectOnOverflow32(overflow, SaturateFrom32(a), difference);
+  }
+  static size_t Do(const int32_t* lhs,
+                   const int32_t* rhs,
+                   int32_t* out,
+                   size_t size) {
+    return BinaryBatchLoop<ClampSubBatchFastOp>(lhs, rhs, out, size);
+  }
+};
+
+template <>
+struct ClampSubBatchFastOp<uint32_t> {
+  static const bool is_supported = true;
+  static constexpr bool kHasAvx2 = false;
+  static __m128i Op(__m128i a, __m128i b) {
+    return _mm_andnot_si128(CompareGreaterUnsigned32(b, a),
+                            _mm_sub_epi32(a, b));
+  }
+  static size_t Do(const uint32_t* lhs,
+                   const uint32_t* rhs,
+                   uint32_t* out,
+                   size_t size) {
+    return BinaryBatchLoop<ClampSubBatchFastOp>(lhs, rhs, out, size);
+  }
+};
+
+// The 16-bit products are widened to 32 bits, and packed back with signed
+// saturation.
+template <>
+struct ClampMulBatchFastOp<int16_t> {
+  static const bool is_supported = true;
+#if defined(__AVX2__)
+  static constexpr bool kHasAvx2 = true;
+  // Unpacking and packing both work within 128-bit lanes, so the elements
+  // keep their order.
+  static __m256i Op(__m256i a, __m256i b) {
+    const __m256i low = _mm256_mullo_epi16(a, b);
+    const __m256i high = _mm256_mulhi_epi16(a, b);
+    return _mm256_packs_epi32(_mm256_unpacklo_epi16(low, high),
+                              _mm256_unpackhi_epi16(low, high));
+  }
+#else
+  static constexpr bool kHasAvx2 = false;
+#endif  // defined(__AVX2__)
+  static __m128i Op(__m128i a, __m128i b) {
+    const __m128i low = _mm_mullo_epi16(a, b);
+    const __m128i high = _mm_mulhi_epi16(a, b);
+    return _mm_packs_epi32(_mm_unpacklo_epi16(low, high),
+                           _mm_unpackhi_epi16(low, high));
+  }
+  static size_t Do(const int16_t* lhs,
+                   const int16_t* rhs,
+                   int16_t* out,
+                   size_t size) {
+    return BinaryBatchLoop<ClampMulBatchFastOp>(lhs, rhs, out, size);
+  }
+};
+
+// An unsigned 16-bit product saturates if its high half isn't zero.
+template <>
+struct ClampMulBatchFastOp<uint16_t> {
+  static const bool is_supported = true;
+#if defined(__AVX2__)
+  static constexpr bool kHasAvx2 = true;
+  static __m256i Op(__m256i a, __m256i b) {
+    const __m256i high = _mm256_mulhi_epu16(a, b);
+    const __m256i saturated = _mm256_xor_si256(
+        _mm256_cmpeq_epi16(high, _mm256_setzero_si256()),
+        _mm256_set1_epi16(-1));
+    return _mm256_or_si256(_mm256_mullo_epi16(a, b), saturated);
+  }
+#else
+  static constexpr bool kHasAvx2 = false;
+#endif  // defined(__AVX2__)
+  static __m128i Op(__m128i a, __m128i b) {
+    const __m128i high = _mm_mulhi_epu16(a, b);
+    const __m128i saturated = _mm_xor_si128(
+        _mm_cmpeq_epi16(high, _mm_setzero_si128()), _mm_set1_epi16(-1));
+    return _mm_or_si128(_mm_mullo_epi16(a, b), saturated);
+  }
+  static size_t Do(const uint16_t* lhs,
+                   const uint16_t* rhs,
+                   uint16_t* out,
+                   size_t size) {
+    return BinaryBatchLoop<ClampMulBatchFastOp>(lhs, rhs, out, size);
+  }
+};
+
+// The 8-bit operands are widened to 16 bits, where their products fit, and
+// the products are packed back with saturation.
+template <>
+struct ClampMulBatchFastOp<int8_t> {
+  static const bool is_supported = true;
+  static constexpr bool kHasAvx2 = false;
+  // Unpacking a vector with itself and shifting right sign-extends it.
+  static __m128i WidenLow(__m128i a) {
+    return _mm_srai_epi16(_mm_unpacklo_epi8(a, a), 8);
+  }
+  static __m128i WidenHigh(__m128i a) {
+    return _mm_srai_epi16(_mm_unpackhi_epi8(a, a), 8);
+  }
+  static __m128i Op(__m128i a, __m128i b) {
+    return _mm_packs_epi16(_mm_mullo_epi16(WidenLow(a), WidenLow(b)),
+                           _mm_mullo_epi16(WidenHigh(a), WidenHigh(b)));
+  }
+  static size_t Do(const int8_t* lhs,
+                   const int8_t* rhs,
+                   int8_t* out,
+                   size_t size) {
+    return BinaryBatchLoop<ClampMulBatchFastOp>(lhs, rhs, out, size);
+  }
+};
+
+template <>
+struct ClampMulBatchFastOp<uint8_t> {
+  static const bool is_supported = true;
+  static constexpr bool kHasAvx2 = false;
+  // Unsigned products above 32767 would be negative for the signed packing,
+  // so they are clamped to 255 first: x - (x -sat 255) is min(x, 255).
+  static __m128i Clamp(__m128i products) {
+    return _mm_subs_epu16(products,
+                          _mm_subs_epu16(products, _mm_set1_epi16(255)));
+  }
+  static __m128i Op(__m128i a, __m128i b) {
+    const __m128i zero = _mm_setzero_si128();
+    const __m128i low = _mm_mullo_epi16(_mm_unpacklo_epi8(a, zero),
+                                        _mm_unpacklo_epi8(b, zero));
+    const __m128i high = _mm_mullo_epi16(_mm_unpackhi_epi8(a, zero),
+                                         _mm_unpackhi_epi8(b, zero));
+    return _mm_packus_epi16(Clamp(low), Clamp(high));
+  }
+  static size_t Do(const uint8_t* lhs,
+                   const uint8_t* rhs,
+                   uint8_t* out,
+                   size_t size) {
+    return BinaryBatchLoop<ClampMulBatchFastOp>(lhs, rhs, out, size);
+  }
+};
+
+// Saturates the float lanes of |vector| to int32_t as saturated_cast does:
+// truncates them, and maps NaN to 0. Conversions out of range give INT32_MIN,
+// which is right for the negative ones.
+inline __m128i SaturateFloatsToInt32(__m128 vector) {
+  const __m128i converted = _mm_cvttps_epi32(vector);
+  const __m128i too_large = _mm_castps_si128(
+      _mm_cmpge_ps(vector, _mm_set1_ps(2147483648.0f)));
+  const __m128i not_nan = _mm_castps_si128(_mm_cmpord_ps(vector, vector));
+  return _mm_and_si128(_mm_xor_si128(converted, too_large), not_nan);
+}
+
+// Converts 16 elements of |src| to 16 bytes of |dst| per iteration, with
+// Kernel::Op() on the 16 bytes of |src| at a time.
+template <typename Kernel, typename Dst, typename Src>
+size_t SaturatedCastBatchLoop(const Src* src, Dst* dst, size_t size) {
+  constexpr size_t kVectors = sizeof(Src) / sizeof(Dst);
+  constexpr size_t kLanes = sizeof(__m128i) / sizeof(Dst);
+  static_assert(kVectors == 2 || kVectors == 4, "Unsupported narrowing.");
+  size_t i = 0;
+  for (; i + kLanes <= size; i += kLanes) {
+    const Src* const vectors = src + i;
+    constexpr size_t kStep = kLanes / kVectors;
+    if constexpr (kVectors == 2) {
+      StoreVector(dst + i, Kernel::Op(LoadVector(vectors),
+                                      LoadVector(vectors + kStep)));
+    } else {
+      StoreVector(dst + i, Kernel::Op(LoadVector(vectors),
+                                      LoadVector(vectors + kStep),
+                                      LoadVector(vectors + 2 * kStep),
+                                      LoadVector(vectors + 3 * kStep)));
+    }
+  }
+  return i;
+}
+
+#define BASE_NUMERICS_X86_SATURATED_CAST(DST, SRC)                  \
+  template <>                                                       \
+  struct SaturatedCastBatchFastOp<DST, SRC> {                       \
+    static const bool is_supported = true;                          \
+    static __m128i Op(__m128i a, __m128i b);                        \
+    static __m128i Op(__m128i a, __m128i b, __m128i c, __m128i d);  \
+    static size_t Do(const SRC* src, DST* dst, size_t size) {       \
+      return SaturatedCastBatchLoop<SaturatedCastBatchFastOp>(src, dst, \
+                                                              size); \
+    }                                                               \
+  };
+
+BASE_NUMERICS_X86_SATURATED_CAST(int16_t, int32_t)
+BASE_NUMERICS_X86_SATURATED_CAST(uint16_t, int32_t)
+BASE_NUMERICS_X86_SATURATED_CAST(int8_t, int32_t)
+BASE_NUMERICS_X86_SATURATED_CAST(uint8_t, int32_t)
+BASE_NUMERICS_X86_SATURATED_CAST(int8_t, int16_t)
+BASE_NUMERICS_X86_SATURATED_CAST(uint8_t, int16_t)
+BASE_NUMERICS_X86_SATURATED_CAST(uint8_t, uint16_t)
+BASE_NUMERICS_X86_SATURATED_CAST(int16_t, float)
+BASE_NUMERICS_X86_SATURATED_CAST(uint8_t, float)
+
+#undef BASE_NUMERICS_X86_SATURATED_CAST
+
+inline __m128i SaturatedCastBatchFastOp<int16_t, int32_t>::Op(__m128i a,
+                                                               __m128i b) {
+  return _mm_packs_epi32(a, b);
+}
+
+// Offsetting the range of uint16_t to that of int16_t lets the signed packing
+// saturate to it. Negative values are zeroed first, so that the offset doesn't
+// wrap them around.
+inline __m128i SaturatedCastBatchFastOp<uint16_t, int32_t>::Op(__m128i a,
+                                                                __m128i b) {
+  const __m128i offset = _mm_set1_epi32(32768);
+  a = _mm_andnot_si128(_mm_srai_epi32(a, 31), a);
+  b = _mm_andnot_si128(_mm_srai_epi32(b, 31), b);
+  return _mm_xor_si128(
+      _mm_packs_epi32(_mm_sub_epi32(a, offset), _mm_sub_epi32(b, offset)),
+      _mm_set1_epi16(INT16_MIN));
+}
+
+// Saturating to int16_t first doesn't change which values saturate to 8 bits.
+inline __m128i SaturatedCastBatchFastOp<int8_t, int32_t>::Op(__m128i a,
+                                                              __m128i b,
+                                                              __m128i c,
+                                                              __m128i d) {
+  return _mm_packs_epi16(_mm_packs_epi32(a, b), _mm_packs_epi32(c, d));
+}
+
+inline __m128i SaturatedCastBatchFastOp<uint8_t, int32_t>::Op(__m128i a,
+                                                               __m128i b,
+                                                               __m128i c,
+                                                               __m128i d) {
+  return _mm_packus_epi16(_mm_packs_epi32(a, b), _mm_packs_epi32(c, d));
+}
+
+inline __m128i SaturatedCastBatchFastOp<int8_t, int16_t>::Op(__m128i a,
+                                                              __m128i b) {
+  return _mm_packs_epi16(a, b);
+}
+
+inline __m128i SaturatedCastBatchFastOp<uint8_t, int16_t>::Op(__m128i a,
+                                                               __m128i b) {
+  return _mm_packus_epi16(a, b);
+}
+
+// x - (x -sat 255) is min(x, 255), which the signed packing keeps as is.
+inline __m128i SaturatedCastBatchFastOp<uint8_t, uint16_t>::Op(__m128i a,
+                                                                __m128i b) {
+  const __m128i max = _mm_set1_epi16(255);
+  return _mm_packus_epi16(_mm_subs_epu16(a, _mm_subs_epu16(a, max)),
+                          _mm_subs_epu16(b, _mm_subs_epu16(b, max)));
+}
+
+// Saturating to int32_t first doesn't change which values saturate to 16 or 8
+// bits, nor how the others are truncated.
+inline __m128i SaturatedCastBatchFastOp<int16_t, float>::Op(__m128i a,
+                                                             __m128i b) {
+  return _mm_packs_epi32(SaturateFloatsToInt32(_mm_castsi128_ps(a)),
+                         SaturateFloatsToInt32(_mm_castsi128_ps(b)));
+}
+
+inline __m128i SaturatedCastBatchFastOp<uint8_t, float>::Op(__m128i a,
+                                                             __m128i b,
+                                                             __m128i c,
+                                                             __m128i d) {
+  return _mm_packus_epi16(
+      _mm_packs_epi32(SaturateFloatsToInt32(_mm_castsi128_ps(a)),
+                      SaturateFloatsToInt32(_mm_castsi128_ps(b))),
+      _mm_packs_epi32(SaturateFloatsToInt32(_mm_castsi128_ps(c)),
+                      SaturateFloatsToInt32(_mm_castsi128_ps(d))));
+}
+
+template <>
+struct SaturatedCastBatchFastOp<int32_t, float> {
+  static const bool is_supported = true;
+  static size_t Do(const float* src, int32_t* dst, size_t size) {
+    size_t i = 0;
+    for (; i + 4 <= size; i += 4)
+      StoreVector(dst + i, SaturateFloatsToInt32(_mm_loadu_ps(src + i)));
+    return i;
+  }
+};
+
+// The signs of 16-bit integers are summed into 32-bit lanes, two elements at a
+// time: a block adds at most 2 * 32768 * kCheckedSumBlockSize / 8 to a lane.
+inline void AddSignsOfInt16(__m128i vector,
+                            __m128i* positive,
+                            __m128i* negative) {
+  const __m128i zero = _mm_setzero_si128();
+  const __m128i ones = _mm_set1_epi16(1);
+  *positive = _mm_add_epi32(
+      *positive, _mm_madd_epi16(_mm_max_epi16(vector, zero), ones));
+  *negative = _mm_add_epi32(
+      *negative, _mm_madd_epi16(_mm_min_epi16(vector, zero), ones));
+}
+
+inline int64_t SumInt32Lanes(__m128i vector) {
+  alignas(16) int32_t lanes[4];
+  _mm_store_si128(reinterpret_cast<__m128i*>(lanes), vector);
+  return int64_t{lanes[0]} + lanes[1] + lanes[2] + lanes[3];
+}
+
+template <>
+struct SumSignsBatchFastOp<int16_t> {
+  static const bool is_supported = true;
+  static size_t Do(const int16_t* data,
+                   size_t size,
+                   int64_t* positive,
+                   int64_t* negative) {
+    __m128i positive_lanes = _mm_setzero_si128();
+    __m128i negative_lanes = _mm_setzero_si128();
+    size_t i = 0;
+    for (; i + 8 <= size; i += 8)
+      AddSignsOfInt16(LoadVector(data + i), &positive_lanes, &negative_lanes);
+    *positive += SumInt32Lanes(positive_lanes);
+    *negative += SumInt32Lanes(negative_lanes);
+    return i;
+  }
+};
+
+template <>
+struct SumSignsBatchFastOp<int8_t> {
+  static const bool is_supported = true;
+  static size_t Do(const int8_t* data,
+                   size_t size,
+                   int64_t* positive,
+                   int64_t* negative) {
+    __m128i positive_lanes = _mm_setzero_si128();
+    __m128i negative_lanes = _mm_setzero_si128();
+    size_t i = 0;
+    for (; i + 16 <= size; i += 16) {
+      // Unpacking a vector with itself and shifting right sign-extends it.
+      const __m128i vector = LoadVector(data + i);
+      AddSignsOfInt16(_mm_srai_epi16(_mm_unpacklo_epi8(vector, vector), 8),
+                      &positive_lanes, &negative_lanes);
+      AddSignsOfInt16(_mm_srai_epi16(_mm_unpackhi_epi8(vector, vector), 8),
+                      &positive_lanes, &negative_lanes);
+    }
+    *positive += SumInt32Lanes(positive_lanes);
+    *negative += SumInt32Lanes(negative_lanes);
+    return i;
+  }
+};
+
+template <>
+struct SumSignsBatchFastOp<uint16_t> {
+  static const bool is_supported = true;
+  static size_t Do(const uint16_t* data,
+                   size_t size,
+                   int64_t* positive,
+                   int64_t*) {
+    const __m128i zero = _mm_setzero_si128();
+    __m128i lanes = _mm_setzero_si128();
+    size_t i = 0;
+    for (; i + 8 <= size; i += 8) {
+      const __m128i vector = LoadVector(data + i);
+      lanes = _mm_add_epi32(lanes, _mm_unpacklo_epi16(vector, zero));
+      lanes = _mm_add_epi32(lanes, _mm_unpackhi_epi16(vector, zero));
+    }
+    *positive += SumInt32Lanes(lanes);
+    return i;
+  }
+};
+
+// _mm_sad_epu8() sums each half of a vector of bytes into a 64-bit lane.
+template <>
+struct SumSignsBatchFastOp<uint8_t> {
+  static const bool is_supported = true;
+  static size_t Do(const uint8_t* data,
+                   size_t size,
+                   int64_t* positive,
+                   int64_t*) {
+    __m128i lanes = _mm_setzero_si128();
+    size_t i = 0;
+    for (; i + 16 <= size; i += 16) {
+      lanes = _mm_add_epi64(
+          lanes, _mm_sad_epu8(LoadVector(data + i), _mm_setzero_si128()));
+    }
+    *positive += _mm_cvtsi128_si64(lanes) +
+                 _mm_cvtsi128_si64(_mm_unpackhi_epi64(lanes, lanes));
+    return i;
+  }
+};
+
+}  // namespace internal
+}  // namespace base
+
+#endif  // BASE_NUMERICS_BATCH_MATH_X86_IMPL_H_
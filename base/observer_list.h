@@ -12,10 +12,12 @@
 #include <limits>
 #include <ostream>
 #include <string>
+#include <type_traits>
 #include <utility>
 #include <vector>
 
 #include "base/check_op.h"
+#include "base/containers/stack_container.h"
 #include "base/notreached.h"
 #include "base/observer_list_internal.h"
 #include "base/ranges/algorithm.h"
@@ -93,11 +95,14 @@ enum class ObserverListPolicy {
 // When check_empty is true, assert that the list is empty on destruction.
 // When allow_reentrancy is false, iterating throught the list while already in
 // the iteration loop will result in DCHECK failure.
+// When inline_capacity is non-zero, up to that many observers are stored in the
+// ObserverList itself rather than on the heap.
 // TODO(oshima): Change the default to non reentrant. https://crbug.com/812109
 template <class ObserverType,
           bool check_empty = false,
           bool allow_reentrancy = true,
-          class ObserverStorageType = internal::CheckedObserverAdapter>
+          class ObserverStorageType = internal::CheckedObserverAdapter,
+          size_t inline_capacity = 0>
 class ObserverList {
  public:
   // Allow declaring an ObserverList<...>::Unchecked that replaces the default
@@ -110,7 +115,19 @@ class ObserverList {
   using Unchecked = ObserverList<ObserverType,
                                  check_empty,
                                  allow_reentrancy,
-                                 internal::UncheckedObserverAdapter>;
+                                 internal::UncheckedObserverAdapter,
+                                 inline_capacity>;
+
+  // Allow declaring an ObserverList<...>::WithInlineCapacity<N>, which stores
+  // up to N observers without a heap allocation. This suits lists which
+  // usually hold a handful of observers and are notified often, at the cost of
+  // N observer slots in every ObserverList object.
+  template <size_t capacity>
+  using WithInlineCapacity = ObserverList<ObserverType,
+                                          check_empty,
+                                          allow_reentrancy,
+                                          ObserverStorageType,
+                                          capacity>;
 
   // An iterator class that can be used to access the list of observers.
   class Iter {
@@ -128,7 +145,7 @@ class ObserverList {
           index_(0),
           max_index_(list->policy_ == ObserverListPolicy::ALL
                          ? std::numeric_limits<size_t>::max()
-                         : list->observers_.size()) {
+                         : list->observers().size()) {
       DCHECK(list);
       DCHECK(allow_reentrancy || list_.IsOnlyRemainingNode());
       // Bind to this sequence when creating the first iterator.
@@ -203,20 +220,20 @@ class ObserverList {
       DCHECK(list_);
       DCHECK_LT(index_, clamped_max_index());
       return ObserverStorageType::template Get<ObserverType>(
-          list_->observers_[index_]);
+          list_->observers()[index_]);
     }
 
     void EnsureValidIndex() {
       DCHECK(list_);
       const size_t max_index = clamped_max_index();
       while (index_ < max_index &&
-             list_->observers_[index_].IsMarkedForRemoval()) {
+             list_->observers()[index_].IsMarkedForRemoval()) {
         ++index_;
       }
     }
 
     size_t clamped_max_index() const {
-      return std::min(max_index_, list_->observers_.size());
+      return std::min(max_index_, list_->observers().size());
     }
 
     bool is_end() const { return !list_ || index_ == clamped_max_index(); }
@@ -237,7 +254,7 @@ class ObserverList {
 
   const_iterator begin() const {
     // An optimization: do not involve weak pointers for empty list.
-    return observers_.empty() ? const_iterator() : const_iterator(this);
+    return observers().empty() ? const_iterator() : const_iterator(this);
   }
 
   const_iterator end() const { return const_iterator(); }
@@ -251,14 +268,16 @@ class ObserverList {
   ObserverList& operator=(const ObserverList&) = delete;
   ~ObserverList() {
     // If there are live iterators, ensure destruction is thread-safe.
-    if (!live_iterators_.empty())
+    if (HasLiveIterators())
       DCHECK_CALLED_ON_VALID_SEQUENCE(iteration_sequence_checker_);
 
+    if (unlinked_live_iterator_)
+      unlinked_live_iterator_->Invalidate();
     while (!live_iterators_.empty())
       live_iterators_.head()->value()->Invalidate();
     if (check_empty) {
       Compact();
-      DCHECK(observers_.empty()) << GetObserversCreationStackString();
+      DCHECK(observers().empty()) << GetObserversCreationStackString();
     }
   }
 
@@ -274,7 +293,7 @@ class ObserverList {
       return;
     }
     observers_count_++;
-    observers_.emplace_back(ObserverStorageType(obs));
+    observers().emplace_back(ObserverStorageType(obs));
   }
 
   // Removes the given observer from this list. Does nothing if this observer is
@@ -282,16 +301,17 @@ class ObserverList {
   void RemoveObserver(const ObserverType* obs) {
     DCHECK(obs);
     const auto it = ranges::find_if(
-        observers_, [obs](const auto& o) { return o.IsEqual(obs); });
-    if (it == observers_.end())
+        observers(), [obs](const auto& o) { return o.IsEqual(obs); });
+    if (it == observers().end())
       return;
     if (!it->IsMarkedForRemoval())
       observers_count_--;
-    if (live_iterators_.empty()) {
-      observers_.erase(it);
+    if (!HasLiveIterators()) {
+      observers().erase(it);
     } else {
       DCHECK_CALLED_ON_VALID_SEQUENCE(iteration_sequence_checker_);
       it->MarkForRemoval();
+      has_observers_marked_for_removal_ = true;
     }
   }
 
@@ -302,19 +322,20 @@ class ObserverList {
     // probably DCHECK, but some client code currently does pass null.
     if (obs == nullptr)
       return false;
-    return ranges::find_if(observers_, [obs](const auto& o) {
+    return ranges::find_if(observers(), [obs](const auto& o) {
              return o.IsEqual(obs);
-           }) != observers_.end();
+           }) != observers().end();
   }
 
   // Removes all the observers from this list.
   void Clear() {
-    if (live_iterators_.empty()) {
-      observers_.clear();
+    if (!HasLiveIterators()) {
+      observers().clear();
     } else {
       DCHECK_CALLED_ON_VALID_SEQUENCE(iteration_sequence_checker_);
-      for (auto& observer : observers_)
+      for (auto& observer : observers())
         observer.MarkForRemoval();
+      has_observers_marked_for_removal_ = true;
     }
     observers_count_ = 0;
   }
@@ -330,16 +351,37 @@ class ObserverList {
     // Compact() is only ever called when the last iterator is destroyed.
     DETACH_FROM_SEQUENCE(iteration_sequence_checker_);
 
-    observers_.erase(
-        std::remove_if(observers_.begin(), observers_.end(),
+    // Most iterations don't remove observers, so they skip the scan.
+    if (!has_observers_marked_for_removal_)
+      return;
+    has_observers_marked_for_removal_ = false;
+    observers().erase(
+        std::remove_if(observers().begin(), observers().end(),
                        [](const auto& o) { return o.IsMarkedForRemoval(); }),
-        observers_.end());
+        observers().end());
+  }
+
+  bool HasLiveIterators() const {
+    return unlinked_live_iterator_ || !live_iterators_.empty();
+  }
+
+  auto& observers() {
+    if constexpr (inline_capacity == 0)
+      return observers_;
+    else
+      return observers_.container();
+  }
+  const auto& observers() const {
+    if constexpr (inline_capacity == 0)
+      return observers_;
+    else
+      return observers_.container();
   }
 
   std::string GetObserversCreationStackString() const {
 #if EXPENSIVE_DCHECKS_ARE_ON()
     std::string result;
-    for (const auto& observer : observers_) {
+    for (const auto& observer : observers()) {
       result += observer.GetCreationStackString();
       result += "\n";
     }
@@ -350,10 +392,21 @@ class ObserverList {
 #endif  // EXPENSIVE_DCHECKS_ARE_ON()
   }
 
-  std::vector<ObserverStorageType> observers_;
+  std::conditional_t<inline_capacity == 0,
+                     std::vector<ObserverStorageType>,
+                     StackVector<ObserverStorageType, inline_capacity>>
+      observers_;
 
+  // The live iterators. Iterations which aren't nested, i.e. all iterations of
+  // a list which disallows reentrancy, only have one live iterator at a time,
+  // which is held by |unlinked_live_iterator_| without linking it in
+  // |live_iterators_|.
+  internal::WeakLinkNode<ObserverList>* unlinked_live_iterator_ = nullptr;
   base::LinkedList<internal::WeakLinkNode<ObserverList>> live_iterators_;
 
+  // Whether Compact() has observers to remove.
+  bool has_observers_marked_for_removal_ = false;
+
   size_t observers_count_{0};
 
   const ObserverListPolicy policy_;
@@ -131,7 +131,11 @@ class WeakLinkNode : public base::LinkNode<WeakLinkNode<ObserverList>> {
   ~WeakLinkNode() { Invalidate(); }
 
   bool IsOnlyRemainingNode() const {
-    return list_ &&
+    if (!list_)
+      return false;
+    if (list_->unlinked_live_iterator_ == this)
+      return list_->live_iterators_.empty();
+    return !list_->unlinked_live_iterator_ &&
            list_->live_iterators_.head() == list_->live_iterators_.tail();
   }
 
@@ -139,13 +143,21 @@ class WeakLinkNode : public base::LinkNode<WeakLinkNode<ObserverList>> {
     DCHECK(!list_);
     DCHECK(list);
     list_ = list;
-    list_->live_iterators_.Append(this);
+    // Only link the nodes of nested iterations, since linking costs more than
+    // the notifications of a short list.
+    if (!list_->unlinked_live_iterator_)
+      list_->unlinked_live_iterator_ = this;
+    else
+      list_->live_iterators_.Append(this);
   }
 
   void Invalidate() {
     if (list_) {
+      if (list_->unlinked_live_iterator_ == this)
+        list_->unlinked_live_iterator_ = nullptr;
+      else
+        this->RemoveFromList();
       list_ = nullptr;
-      this->RemoveFromList();
     }
   }
 
@@ -5,6 +5,8 @@
 #include "base/observer_list.h"
 
 #include <memory>
+#include <string>
+#include <vector>
 
 #include "base/check_op.h"
 #include "base/strings/stringprintf.h"
@@ -49,11 +51,17 @@ struct Pick {
   // The ObserverList type to use. Checked observers need to be in a checked
   // ObserverList.
   using ObserverListType = ObserverList<ObserverType>;
+  using NonReentrantObserverListType =
+      ObserverList<ObserverType, /*check_empty=*/false,
+                   /*allow_reentrancy=*/false>;
   static const char* GetName() { return "CheckedObserver"; }
 };
 template <>
 struct Pick<UnsafeObserver> {
   using ObserverListType = ObserverList<ObserverInterface>::Unchecked;
+  using NonReentrantObserverListType =
+      ObserverList<ObserverInterface, /*check_empty=*/false,
+                   /*allow_reentrancy=*/false>::Unchecked;
   static const char* GetName() { return "UnsafeObserver"; }
 };
 
@@ -65,29 +73,25 @@ class ObserverListPerfTest : public ::testing::Test {
   ObserverListPerfTest() = default;
   ObserverListPerfTest(const ObserverListPerfTest&) = delete;
   ObserverListPerfTest& operator=(const ObserverListPerfTest&) = delete;
-};
-
-typedef ::testing::Types<UnsafeObserver, TestCheckedObserver> ObserverTypes;
-TYPED_TEST_SUITE(ObserverListPerfTest, ObserverTypes);
 
-// Performance test for base::ObserverList and Checked Observers.
-TYPED_TEST(ObserverListPerfTest, NotifyPerformance) {
-  constexpr int kMaxObservers = 128;
+ protected:
 #if DCHECK_IS_ON()
   // The test takes about 100x longer in debug builds, mostly due to sequence
   // checker overheads when WeakPtr gets involved.
-  constexpr int kLaps = 1000000;
+  static constexpr int kLaps = 1000000;
 #else
-  constexpr int kLaps = 100000000;
+  static constexpr int kLaps = 100000000;
 #endif
-  constexpr int kWarmupLaps = 100;
-  std::vector<std::unique_ptr<TypeParam>> observers;
 
-  for (int observer_count = 0; observer_count <= kMaxObservers;
-       observer_count = observer_count ? observer_count * 2 : 1) {
-    typename TestFixture::ObserverListType list;
+  // Reports the time to notify |observer_count| observers of a |ListType|,
+  // per observer plus one for the iteration itself.
+  template <class ListType>
+  void RunNotifyBenchmark(const char* list_name, int observer_count) {
+    constexpr int kWarmupLaps = 100;
+    std::vector<std::unique_ptr<ObserverType>> observers;
+    ListType list;
     for (int i = 0; i < observer_count; ++i)
-      observers.push_back(std::make_unique<TypeParam>());
+      observers.push_back(std::make_unique<ObserverType>());
     for (auto& o : observers)
       list.AddObserver(o.get());
 
@@ -105,14 +109,15 @@ TYPED_TEST(ObserverListPerfTest, NotifyPerformance) {
     }
     TimeDelta duration = TimeTicks::Now() - start;
 
-    observers.clear();
+    for (auto& o : observers)
+      list.RemoveObserver(o.get());
 
     EXPECT_EQ(observer_count * weighted_laps,
               g_observer_list_perf_test_counter);
-    EXPECT_TRUE(observer_count == 0 || !list.empty());
+    EXPECT_TRUE(list.empty());
 
-    std::string story_name =
-        base::StringPrintf("%s_%d", Pick<TypeParam>::GetName(), observer_count);
+    std::string story_name = base::StringPrintf(
+        "%s%s_%d", Pick<ObserverType>::GetName(), list_name, observer_count);
 
     // A typical value is 3-20 nanoseconds per observe in Release, 1000-2000ns
     // in an optimized build with DCHECKs and 3000-6000ns in debug builds.
@@ -123,6 +128,41 @@ TYPED_TEST(ObserverListPerfTest, NotifyPerformance) {
             static_cast<double>(g_observer_list_perf_test_counter +
                                 weighted_laps));
   }
+};
+
+typedef ::testing::Types<UnsafeObserver, TestCheckedObserver> ObserverTypes;
+TYPED_TEST_SUITE(ObserverListPerfTest, ObserverTypes);
+
+// Performance test for base::ObserverList and Checked Observers.
+TYPED_TEST(ObserverListPerfTest, NotifyPerformance) {
+  constexpr int kMaxObservers = 128;
+  for (int observer_count = 0; observer_count <= kMaxObservers;
+       observer_count = observer_count ? observer_count * 2 : 1) {
+    this->template RunNotifyBenchmark<
+        typename TestFixture::ObserverListType>("", observer_count);
+  }
+}
+
+// Performance test for the small lists which most notifications go through,
+// by storage and reentrancy policy.
+TYPED_TEST(ObserverListPerfTest, NotifyPerformanceSmallLists) {
+  using ObserverListType = typename TestFixture::ObserverListType;
+  using NonReentrantObserverListType =
+      typename Pick<TypeParam>::NonReentrantObserverListType;
+  constexpr int kMaxObservers = 4;
+  for (int observer_count = 0; observer_count <= kMaxObservers;
+       ++observer_count) {
+    this->template RunNotifyBenchmark<ObserverListType>("Reentrant",
+                                                      observer_count);
+    this->template RunNotifyBenchmark<NonReentrantObserverListType>(
+        "NonReentrant", observer_count);
+    this->template RunNotifyBenchmark<
+        typename ObserverListType::template WithInlineCapacity<
+            kMaxObservers>>("Inline", observer_count);
+    this->template RunNotifyBenchmark<
+        typename NonReentrantObserverListType::template WithInlineCapacity<
+            kMaxObservers>>("NonReentrantInline", observer_count);
+  }
 }
 
 }  // namespace base
@@ -5,17 +5,23 @@
 #ifndef BASE_OBSERVER_LIST_THREADSAFE_H_
 #define BASE_OBSERVER_LIST_THREADSAFE_H_
 
+#include <stdint.h>
+
+#include <atomic>
 #include <unordered_map>
 #include <utility>
+#include <vector>
 
 #include "base/base_export.h"
 #include "base/bind.h"
 #include "base/check_op.h"
 #include "base/containers/contains.h"
+#include "base/ranges/algorithm.h"
 #include "base/lazy_instance.h"
 #include "base/location.h"
 #include "base/memory/raw_ptr.h"
 #include "base/memory/ref_counted.h"
+#include "base/notreached.h"
 #include "base/observer_list.h"
 #include "base/synchronization/lock.h"
 #include "base/task/sequenced_task_runner.h"
@@ -50,6 +56,10 @@
 //   same-sequence observers, but it was error-prone and removed in
 //   crbug.com/1193750, think twice before re-considering this paradigm.
 //
+//   Lists with many observers which are notified more often than they change
+//   can use NotificationMode::kBatchedPerSequence, in which Notify() posts a
+//   single task per sequence rather than per observer (see below).
+//
 ///////////////////////////////////////////////////////////////////////////////
 
 namespace base {
@@ -107,9 +117,23 @@ class ObserverListThreadSafe : public internal::ObserverListThreadSafeBase {
     kRemainsNonEmpty,
   };
 
+  // How Notify() dispatches notifications.
+  enum class NotificationMode {
+    // Notify() posts a task per observer.
+    kPerObserver,
+    // The observers are kept in an immutable snapshot, grouped by sequence,
+    // which AddObserver() and RemoveObserver() copy and replace; they are
+    // O(number of observers). Notify() only holds the lock to take a
+    // reference to the snapshot, and posts a single task per sequence, which
+    // notifies the observers of that sequence in the order they were added.
+    kBatchedPerSequence,
+  };
+
   ObserverListThreadSafe() = default;
   explicit ObserverListThreadSafe(ObserverListPolicy policy)
       : policy_(policy) {}
+  ObserverListThreadSafe(ObserverListPolicy policy, NotificationMode mode)
+      : policy_(policy), mode_(mode) {}
   ObserverListThreadSafe(const ObserverListThreadSafe&) = delete;
   ObserverListThreadSafe& operator=(const ObserverListThreadSafe&) = delete;
 
@@ -125,18 +149,22 @@ class ObserverListThreadSafe : public internal::ObserverListThreadSafeBase {
 
     AutoLock auto_lock(lock_);
 
-    bool was_empty = observers_.empty();
+    bool was_empty = IsEmpty();
 
-    // Add |observer| to the list of observers.
-    DCHECK(!Contains(observers_, observer));
     const scoped_refptr<SequencedTaskRunner> task_runner =
         SequencedTaskRunnerHandle::Get();
     // Each observer gets a unique identifier. These unique identifiers are used
     // to avoid execution of pending posted-tasks over removed or released
     // observers.
     const size_t observer_id = ++observer_id_counter_;
-    ObserverTaskRunnerInfo task_info = {task_runner, observer_id};
-    observers_[observer] = std::move(task_info);
+    if (mode_ == NotificationMode::kBatchedPerSequence) {
+      AddToSnapshot(observer, task_runner, observer_id);
+    } else {
+      // Add |observer| to the list of observers.
+      DCHECK(!Contains(observers_, observer));
+      ObserverTaskRunnerInfo task_info = {task_runner, observer_id};
+      observers_[observer] = std::move(task_info);
+    }
 
     // If this is called while a notification is being dispatched on this thread
     // and |policy_| is ALL, |observer| must be notified (if a notification is
@@ -170,16 +198,19 @@ class ObserverListThreadSafe : public internal::ObserverListThreadSafeBase {
   // observer won't stop it.
   RemoveObserverResult RemoveObserver(ObserverType* observer) {
     AutoLock auto_lock(lock_);
-    observers_.erase(observer);
-    return observers_.empty() ? RemoveObserverResult::kWasOrBecameEmpty
-                              : RemoveObserverResult::kRemainsNonEmpty;
+    if (mode_ == NotificationMode::kBatchedPerSequence)
+      RemoveFromSnapshot(observer);
+    else
+      observers_.erase(observer);
+    return IsEmpty() ? RemoveObserverResult::kWasOrBecameEmpty
+                     : RemoveObserverResult::kRemainsNonEmpty;
   }
 
   // Verifies that the list is currently empty (i.e. there are no observers).
   void AssertEmpty() const {
 #if DCHECK_IS_ON()
     AutoLock auto_lock(lock_);
-    DCHECK(observers_.empty());
+    DCHECK(IsEmpty());
 #endif
   }
 
@@ -193,6 +224,25 @@ class ObserverListThreadSafe : public internal::ObserverListThreadSafeBase {
         BindRepeating(&Dispatcher<ObserverType, Method>::Run, m,
                       std::forward<Params>(params)...);
 
+    if (mode_ == NotificationMode::kBatchedPerSequence) {
+      scoped_refptr<const Snapshot> snapshot;
+      {
+        AutoLock lock(lock_);
+        snapshot = snapshot_;
+      }
+      if (!snapshot)
+        return;
+      for (size_t i = 0; i < snapshot->data.sequences.size(); ++i) {
+        snapshot->data.sequences[i].task_runner->PostTask(
+            from_here,
+            BindOnce(
+                &ObserverListThreadSafe<ObserverType>::NotifySequenceWrapper,
+                this, snapshot, i,
+                NotificationData(this, 0, from_here, method)));
+      }
+      return;
+    }
+
     AutoLock lock(lock_);
     for (const auto& observer : observers_) {
       observer.second.task_runner->PostTask(
@@ -220,8 +270,125 @@ class ObserverListThreadSafe : public internal::ObserverListThreadSafeBase {
     size_t observer_id;
   };
 
+  // The observers in NotificationMode::kBatchedPerSequence.
+  struct SnapshotData {
+    struct SequenceObservers {
+      scoped_refptr<SequencedTaskRunner> task_runner;
+      // Observers and their identifiers, in the order they were added.
+      std::vector<std::pair<ObserverType*, size_t>> observers;
+    };
+
+    // The value of |version_| when the snapshot was made.
+    uint64_t version = 0;
+    std::vector<SequenceObservers> sequences;
+    // Observers and their identifiers, to check whether an observer is still
+    // in the list without going through |sequences|.
+    std::unordered_map<ObserverType*, size_t> observer_ids;
+  };
+  using Snapshot = RefCountedData<SnapshotData>;
+
   ~ObserverListThreadSafe() override = default;
 
+  bool IsEmpty() const EXCLUSIVE_LOCKS_REQUIRED(lock_) {
+    if (mode_ == NotificationMode::kBatchedPerSequence)
+      return !snapshot_ || snapshot_->data.observer_ids.empty();
+    return observers_.empty();
+  }
+
+  // Replaces |snapshot_| with a copy which |update| modified.
+  template <typename Function>
+  void UpdateSnapshot(Function update) EXCLUSIVE_LOCKS_REQUIRED(lock_) {
+    SnapshotData data = snapshot_ ? snapshot_->data : SnapshotData();
+    update(data);
+    data.version = version_.load(std::memory_order_relaxed) + 1;
+    snapshot_ = MakeRefCounted<Snapshot>(std::move(data));
+    version_.store(snapshot_->data.version, std::memory_order_release);
+  }
+
+  void AddToSnapshot(ObserverType* observer,
+                     const scoped_refptr<SequencedTaskRunner>& task_runner,
+                     size_t observer_id) EXCLUSIVE_LOCKS_REQUIRED(lock_) {
+    UpdateSnapshot([&](SnapshotData& data) {
+      DCHECK(!Contains(data.observer_ids, observer));
+      data.observer_ids[observer] = observer_id;
+      auto sequence =
+          ranges::find(data.sequences, task_runner,
+                       &SnapshotData::SequenceObservers::task_runner);
+      if (sequence == data.sequences.end()) {
+        data.sequences.push_back({task_runner, {}});
+        sequence = data.sequences.end() - 1;
+      }
+      sequence->observers.emplace_back(observer, observer_id);
+    });
+  }
+
+  void RemoveFromSnapshot(ObserverType* observer)
+      EXCLUSIVE_LOCKS_REQUIRED(lock_) {
+    if (!snapshot_ || !Contains(snapshot_->data.observer_ids, observer))
+      return;
+    UpdateSnapshot([&](SnapshotData& data) {
+      data.observer_ids.erase(observer);
+      for (auto sequence = data.sequences.begin();
+           sequence != data.sequences.end(); ++sequence) {
+        auto it = ranges::find(sequence->observers, observer,
+                               &std::pair<ObserverType*, size_t>::first);
+        if (it == sequence->observers.end())
+          continue;
+        sequence->observers.erase(it);
+        if (sequence->observers.empty())
+          data.sequences.erase(sequence);
+        return;
+      }
+      NOTREACHED();
+    });
+  }
+
+  // Returns whether the observer with |observer_id| is still in the list.
+  bool IsObserverInList(ObserverType* observer, size_t observer_id) const
+      EXCLUSIVE_LOCKS_REQUIRED(lock_) {
+    if (mode_ == NotificationMode::kBatchedPerSequence) {
+      if (!snapshot_)
+        return false;
+      auto it = snapshot_->data.observer_ids.find(observer);
+      return it != snapshot_->data.observer_ids.end() &&
+             it->second == observer_id;
+    }
+    auto it = observers_.find(observer);
+    if (it == observers_.end() || it->second.observer_id != observer_id)
+      return false;
+    DCHECK(it->second.task_runner->RunsTasksInCurrentSequence());
+    return true;
+  }
+
+  // Notifies the observers of the sequence at |sequence_index| in |snapshot|,
+  // in NotificationMode::kBatchedPerSequence.
+  void NotifySequenceWrapper(scoped_refptr<const Snapshot> snapshot,
+                             size_t sequence_index,
+                             const NotificationData& notification) {
+    DCHECK_EQ(notification.observer_list, this);
+    const auto& sequence = snapshot->data.sequences[sequence_index];
+    DCHECK(sequence.task_runner->RunsTasksInCurrentSequence());
+
+    auto& tls_current_notification = tls_current_notification_.Get();
+    const NotificationDataBase* const previous_notification =
+        tls_current_notification.Get();
+    tls_current_notification.Set(&notification);
+
+    for (const auto& [observer, observer_id] : sequence.observers) {
+      // Skip the observers which were removed since Notify(), possibly by the
+      // callbacks of previous observers. The list is only looked up when it
+      // changed, so notifying usually doesn't take |lock_|.
+      if (version_.load(std::memory_order_acquire) != snapshot->data.version) {
+        AutoLock auto_lock(lock_);
+        if (!IsObserverInList(observer, observer_id))
+          continue;
+      }
+      notification.method.Run(observer);
+    }
+
+    tls_current_notification.Set(previous_notification);
+  }
+
   void NotifyWrapper(ObserverType* observer,
                      const NotificationData& notification) {
     {
@@ -229,12 +396,8 @@ class ObserverListThreadSafe : public internal::ObserverListThreadSafeBase {
 
       // Check whether the observer still needs a notification.
       DCHECK_EQ(notification.observer_list, this);
-      auto it = observers_.find(observer);
-      if (it == observers_.end() ||
-          it->second.observer_id != notification.observer_id) {
+      if (!IsObserverInList(observer, notification.observer_id))
         return;
-      }
-      DCHECK(it->second.task_runner->RunsTasksInCurrentSequence());
     }
 
     // Keep track of the notification being dispatched on the current thread.
@@ -257,6 +420,7 @@ class ObserverListThreadSafe : public internal::ObserverListThreadSafeBase {
   }
 
   const ObserverListPolicy policy_ = ObserverListPolicy::ALL;
+  const NotificationMode mode_ = NotificationMode::kPerObserver;
 
   mutable Lock lock_;
 
@@ -271,6 +435,13 @@ class ObserverListThreadSafe : public internal::ObserverListThreadSafeBase {
   // be notified.
   std::unordered_map<ObserverType*, ObserverTaskRunnerInfo> observers_
       GUARDED_BY(lock_);
+
+  // The observers in NotificationMode::kBatchedPerSequence, or null if no
+  // observer was ever added. |version_| is incremented each time |snapshot_|
+  // is replaced, so that notifications can check that it didn't change
+  // without the lock.
+  scoped_refptr<const Snapshot> snapshot_ GUARDED_BY(lock_);
+  std::atomic<uint64_t> version_{0};
 };
 
 }  // namespace base
@@ -516,4 +516,146 @@ TEST(ObserverListThreadSafeTest, Existing) {
   EXPECT_EQ(1, c.total);
 }
 
+namespace {
+
+using BatchedList = ObserverListThreadSafe<Foo>;
+
+scoped_refptr<BatchedList> CreateBatchedList(
+    ObserverListPolicy policy = ObserverListPolicy::ALL) {
+  return MakeRefCounted<BatchedList>(
+      policy, BatchedList::NotificationMode::kBatchedPerSequence);
+}
+
+// Records the order in which observers are notified.
+class OrderRecorder : public Foo {
+ public:
+  OrderRecorder(int id, std::vector<int>* order) : id_(id), order_(order) {}
+
+  void Observe(int x) override { order_->push_back(id_); }
+
+ private:
+  const int id_;
+  const raw_ptr<std::vector<int>> order_;
+};
+
+}  // namespace
+
+TEST(ObserverListThreadSafeTest, BatchedBasicTest) {
+  test::TaskEnvironment task_environment;
+  auto observer_list = CreateBatchedList();
+  Adder a(1);
+  Adder b(-1);
+
+  EXPECT_EQ(BatchedList::AddObserverResult::kBecameNonEmpty,
+            observer_list->AddObserver(&a));
+  EXPECT_EQ(BatchedList::AddObserverResult::kWasAlreadyNonEmpty,
+            observer_list->AddObserver(&b));
+
+  observer_list->Notify(FROM_HERE, &Foo::Observe, 10);
+  RunLoop().RunUntilIdle();
+  EXPECT_EQ(10, a.total);
+  EXPECT_EQ(-10, b.total);
+
+  // A pending notification isn't delivered to a removed observer.
+  observer_list->Notify(FROM_HERE, &Foo::Observe, 10);
+  EXPECT_EQ(BatchedList::RemoveObserverResult::kRemainsNonEmpty,
+            observer_list->RemoveObserver(&a));
+  RunLoop().RunUntilIdle();
+  EXPECT_EQ(10, a.total);
+  EXPECT_EQ(-20, b.total);
+
+  // Nor to an observer which was removed and added again.
+  observer_list->Notify(FROM_HERE, &Foo::Observe, 10);
+  observer_list->RemoveObserver(&b);
+  observer_list->AddObserver(&b);
+  RunLoop().RunUntilIdle();
+  EXPECT_EQ(-20, b.total);
+
+  EXPECT_EQ(BatchedList::RemoveObserverResult::kWasOrBecameEmpty,
+            observer_list->RemoveObserver(&b));
+  observer_list->AssertEmpty();
+}
+
+// Observers of a sequence are notified by a single task, in the order they
+// were added.
+TEST(ObserverListThreadSafeTest, BatchedNotificationOrder) {
+  test::TaskEnvironment task_environment;
+  auto observer_list = CreateBatchedList();
+  std::vector<int> order;
+  OrderRecorder first(1, &order);
+  OrderRecorder second(2, &order);
+  OrderRecorder third(3, &order);
+  observer_list->AddObserver(&first);
+  observer_list->AddObserver(&second);
+  observer_list->AddObserver(&third);
+
+  observer_list->Notify(FROM_HERE, &Foo::Observe, 1);
+  EXPECT_EQ(1u, task_environment.GetPendingMainThreadTaskCount());
+  RunLoop().RunUntilIdle();
+  EXPECT_EQ(std::vector<int>({1, 2, 3}), order);
+}
+
+// An observer removed by the callback of a previous observer of the same
+// notification isn't notified.
+TEST(ObserverListThreadSafeTest, BatchedRemoveFromNotification) {
+  test::TaskEnvironment task_environment;
+  auto observer_list = CreateBatchedList();
+  FooRemover remover(observer_list.get());
+  Adder a(1);
+  observer_list->AddObserver(&remover);
+  observer_list->AddObserver(&a);
+  remover.AddFooToRemove(&a);
+
+  observer_list->Notify(FROM_HERE, &Foo::Observe, 1);
+  RunLoop().RunUntilIdle();
+  EXPECT_EQ(0, a.total);
+}
+
+TEST(ObserverListThreadSafeTest, BatchedAddObserverFromNotification) {
+  test::TaskEnvironment task_environment;
+  for (ObserverListPolicy policy :
+       {ObserverListPolicy::ALL, ObserverListPolicy::EXISTING_ONLY}) {
+    auto observer_list = CreateBatchedList(policy);
+    Adder added_from_notification(1);
+    AddInObserve initial_observer(observer_list.get());
+    initial_observer.SetToAdd(&added_from_notification);
+    observer_list->AddObserver(&initial_observer);
+
+    observer_list->Notify(FROM_HERE, &Foo::Observe, 1);
+    RunLoop().RunUntilIdle();
+    EXPECT_EQ(policy == ObserverListPolicy::ALL ? 1 : 0,
+              added_from_notification.total);
+  }
+}
+
+// Observers added on several sequences are all notified (on their sequence,
+// which NotifySequenceWrapper() DCHECKs).
+TEST(ObserverListThreadSafeTest, BatchedNotificationOnSeveralSequences) {
+  test::TaskEnvironment task_environment;
+  auto observer_list = CreateBatchedList();
+  Adder main_thread_observer(1);
+  observer_list->AddObserver(&main_thread_observer);
+
+  constexpr int kNumSequences = 3;
+  std::vector<scoped_refptr<SequencedTaskRunner>> task_runners;
+  std::vector<std::unique_ptr<Adder>> observers;
+  for (int i = 0; i < kNumSequences; ++i) {
+    task_runners.push_back(ThreadPool::CreateSequencedTaskRunner({}));
+    for (int j = 0; j < 2; ++j) {
+      observers.push_back(std::make_unique<Adder>(1));
+      task_runners.back()->PostTask(
+          FROM_HERE,
+          BindOnce(IgnoreResult(&BatchedList::AddObserver), observer_list,
+                   Unretained(observers.back().get())));
+    }
+  }
+  task_environment.RunUntilIdle();
+
+  observer_list->Notify(FROM_HERE, &Foo::Observe, 1);
+  task_environment.RunUntilIdle();
+  EXPECT_EQ(1, main_thread_observer.total);
+  for (const auto& observer : observers)
+    EXPECT_EQ(1, observer->total);
+}
+
 }  // namespace base
@@ -910,6 +910,95 @@ TYPED_TEST(ObserverListTest, AddObserverInTheLastObserve) {
   EXPECT_EQ(-10, b.total);
 }
 
+TYPED_TEST(ObserverListTest, InlineCapacity) {
+  DECLARE_TYPES;
+  using InlineObserverListFoo =
+      typename ObserverListFoo::template WithInlineCapacity<2>;
+  InlineObserverListFoo observer_list;
+  Adder a(1), b(-1), c(1), d(-1);
+  DisrupterT<InlineObserverListFoo> disrupter(&observer_list, &c);
+
+  observer_list.AddObserver(&a);
+  observer_list.AddObserver(&b);
+  for (auto& observer : observer_list)
+    observer.Observe(10);
+  EXPECT_EQ(10, a.total);
+  EXPECT_EQ(-10, b.total);
+
+  // Grow beyond the inline capacity, and remove during iteration.
+  observer_list.AddObserver(&disrupter);
+  observer_list.AddObserver(&c);
+  observer_list.AddObserver(&d);
+  for (auto& observer : observer_list)
+    observer.Observe(1);
+  EXPECT_EQ(11, a.total);
+  EXPECT_EQ(-11, b.total);
+  EXPECT_EQ(0, c.total);
+  EXPECT_EQ(-1, d.total);
+  EXPECT_FALSE(observer_list.HasObserver(&c));
+
+  observer_list.RemoveObserver(&a);
+  observer_list.RemoveObserver(&disrupter);
+  for (auto& observer : observer_list)
+    observer.Observe(1);
+  EXPECT_EQ(11, a.total);
+  EXPECT_EQ(-12, b.total);
+  EXPECT_EQ(-2, d.total);
+
+  observer_list.Clear();
+  EXPECT_TRUE(observer_list.empty());
+}
+
+TYPED_TEST(ObserverListTest, NonReentrantIteratorOutlivesList) {
+  DECLARE_TYPES;
+  using NonReentrantObserverListFoo = typename PickObserverList<
+      Foo>::template ObserverListType<Foo, /*check_empty=*/false,
+                                      /*allow_reentrancy=*/false>;
+  auto* observer_list = new NonReentrantObserverListFoo;
+  ListDestructor<NonReentrantObserverListFoo> a(observer_list);
+  Adder b(1);
+  observer_list->AddObserver(&a);
+  observer_list->AddObserver(&b);
+
+  for (auto& observer : *observer_list)
+    observer.Observe(1);
+
+  // The iteration stops once the list is deleted.
+  EXPECT_EQ(0, b.total);
+}
+
+// Copies of an iterator outlive the iterator they were copied from, and an
+// iteration can start while they're alive.
+TYPED_TEST(ObserverListTest, IteratorCopiesOutliveOriginal) {
+  DECLARE_TYPES;
+  ObserverListFoo observer_list;
+  Adder a(1), b(-1);
+  Disrupter disrupter(&observer_list, &a);
+  observer_list.AddObserver(&disrupter);
+  observer_list.AddObserver(&a);
+  observer_list.AddObserver(&b);
+
+  absl::optional<iterator> it(observer_list.begin());
+  iterator copy = *it;
+  it.reset();
+  copy->Observe(1);
+  EXPECT_FALSE(observer_list.HasObserver(&a));
+
+  for (auto& observer : observer_list)
+    observer.Observe(10);
+  EXPECT_EQ(0, a.total);
+  EXPECT_EQ(-10, b.total);
+
+  // The removed observer is compacted away once the last iterator is gone.
+  copy = iterator();
+  disrupter.SetDoomed(nullptr);
+  observer_list.AddObserver(&a);
+  for (auto& observer : observer_list)
+    observer.Observe(1);
+  EXPECT_EQ(1, a.total);
+  EXPECT_EQ(-11, b.total);
+}
+
 class MockLogAssertHandler {
  public:
   MOCK_METHOD4(
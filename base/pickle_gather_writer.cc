@@ -0,0 +1,143 @@
+// Copyright 2022 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "base/pickle_gather_writer.h"
+
+#include <algorithm>
+#include <limits>
+#include <utility>
+
+#include "base/bits.h"
+#include "base/check_op.h"
+#include "base/numerics/safe_conversions.h"
+
+#if BUILDFLAG(IS_POSIX)
+#include <limits.h>
+#include <sys/uio.h>
+
+#include "base/posix/eintr_wrapper.h"
+#endif
+
+namespace base {
+
+namespace {
+
+// The padding of the blobs to the alignment of the fields of a Pickle.
+constexpr uint8_t kPadding[sizeof(uint32_t)] = {};
+
+}  // namespace
+
+PickleGatherWriter::Reference::Reference(size_t offset,
+                                         span<const uint8_t> data,
+                                         scoped_refptr<RefCountedMemory> owner)
+    : offset(offset), data(data), owner(std::move(owner)) {}
+
+PickleGatherWriter::Reference::Reference(Reference&&) = default;
+
+PickleGatherWriter::Reference& PickleGatherWriter::Reference::operator=(
+    Reference&&) = default;
+
+PickleGatherWriter::Reference::~Reference() = default;
+
+PickleGatherWriter::PickleGatherWriter() = default;
+
+PickleGatherWriter::PickleGatherWriter(int header_size)
+    : Pickle(header_size) {}
+
+PickleGatherWriter::~PickleGatherWriter() = default;
+
+void PickleGatherWriter::WriteDataReference(
+    scoped_refptr<RefCountedMemory> data) {
+  DCHECK(data);
+  const span<const uint8_t> bytes(data->front(), data->size());
+  AddReference(bytes, std::move(data));
+}
+
+void PickleGatherWriter::WriteDataReference(span<const uint8_t> data) {
+  AddReference(data, nullptr);
+}
+
+size_t PickleGatherWriter::size() const {
+  return Pickle::size() + referenced_size_;
+}
+
+std::vector<span<const uint8_t>> PickleGatherWriter::GetBuffers() {
+  const size_t total_payload_size = payload_size() + referenced_size_;
+  CHECK_LE(total_payload_size, std::numeric_limits<uint32_t>::max());
+  const auto* header = static_cast<const uint8_t*>(data());
+  header_.assign(header, header + header_size());
+  reinterpret_cast<Header*>(header_.data())->payload_size =
+      static_cast<uint32_t>(total_payload_size);
+
+  std::vector<span<const uint8_t>> buffers;
+  buffers.reserve(references_.size() * 3 + 2);
+  buffers.emplace_back(header_);
+  const auto* payload = reinterpret_cast<const uint8_t*>(this->payload());
+  size_t offset = 0;
+  for (const Reference& reference : references_) {
+    if (reference.offset > offset)
+      buffers.emplace_back(payload + offset, reference.offset - offset);
+    offset = reference.offset;
+    buffers.push_back(reference.data);
+    const size_t padding =
+        bits::AlignUp(reference.data.size(), sizeof(uint32_t)) -
+        reference.data.size();
+    if (padding)
+      buffers.emplace_back(kPadding, padding);
+  }
+  if (payload_size() > offset)
+    buffers.emplace_back(payload + offset, payload_size() - offset);
+  return buffers;
+}
+
+std::vector<uint8_t> PickleGatherWriter::Flatten() {
+  std::vector<uint8_t> data;
+  data.reserve(size());
+  for (span<const uint8_t> buffer : GetBuffers())
+    data.insert(data.end(), buffer.begin(), buffer.end());
+  return data;
+}
+
+#if BUILDFLAG(IS_POSIX)
+bool PickleGatherWriter::WriteToFileDescriptor(int fd) {
+  std::vector<iovec> iovecs;
+  for (span<const uint8_t> buffer : GetBuffers())
+    iovecs.push_back({const_cast<uint8_t*>(buffer.data()), buffer.size()});
+  size_t index = 0;
+  while (index < iovecs.size()) {
+    const int count =
+        static_cast<int>(std::min<size_t>(iovecs.size() - index, IOV_MAX));
+    const ssize_t written = HANDLE_EINTR(writev(fd, &iovecs[index], count));
+    if (written <= 0)
+      return false;
+    // Skips the buffers which were written, and the written part of the
+    // next one.
+    size_t remaining = static_cast<size_t>(written);
+    while (index < iovecs.size() && remaining >= iovecs[index].iov_len) {
+      remaining -= iovecs[index].iov_len;
+      index++;
+    }
+    if (remaining) {
+      iovecs[index].iov_base =
+          static_cast<uint8_t*>(iovecs[index].iov_base) + remaining;
+      iovecs[index].iov_len -= remaining;
+    }
+  }
+  return true;
+}
+#endif  // BUILDFLAG(IS_POSIX)
+
+void PickleGatherWriter::AddReference(span<const uint8_t> data,
+                                      scoped_refptr<RefCountedMemory> owner) {
+  if (data.size() < kMinReferencedSize) {
+    WriteData(reinterpret_cast<const char*>(data.data()),
+              checked_cast<int>(data.size()));
+    return;
+  }
+  WriteInt(checked_cast<int>(data.size()));
+  references_.emplace_back(payload_size(), data, std::move(owner));
+  referenced_size_ += bits::AlignUp(data.size(), sizeof(uint32_t));
+}
+
+}  // namespace base
@@ -0,0 +1,115 @@
+// Copyright 2022 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#ifndef BASE_PICKLE_GATHER_WRITER_H_
+#define BASE_PICKLE_GATHER_WRITER_H_
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include <vector>
+
+#include "base/base_export.h"
+#include "base/containers/span.h"
+#include "base/memory/ref_counted_memory.h"
+#include "base/memory/scoped_refptr.h"
+#include "base/pickle.h"
+#include "build/build_config.h"
+
+namespace base {
+
+// Writes the data of a Pickle without copying its large blobs: the fields are
+// written to a Pickle, except for the blobs written with WriteDataReference(),
+// which are only referenced. GetBuffers() then returns the data as a list of
+// buffers, for a writev()-style gather write, and Flatten() copies it once.
+// Either way, the data is that of a Pickle with the same writes, which
+// PickleIterator reads, and whose ReadData() borrows the blobs from the
+// received data.
+//
+//   PickleGatherWriter writer;
+//   writer.WriteInt(id);
+//   writer.WriteDataReference(attachment);  // A RefCountedMemory.
+//   writer.WriteToFileDescriptor(fd);
+class BASE_EXPORT PickleGatherWriter : private Pickle {
+ public:
+  // Smaller blobs are copied, since a buffer of their own would cost more.
+  static constexpr size_t kMinReferencedSize = 4096;
+
+  PickleGatherWriter();
+  // As for Pickle, |header_size| may include a custom header.
+  explicit PickleGatherWriter(int header_size);
+
+  PickleGatherWriter(const PickleGatherWriter&) = delete;
+  PickleGatherWriter& operator=(const PickleGatherWriter&) = delete;
+
+  ~PickleGatherWriter() override;
+
+  using Pickle::headerT;
+  using Pickle::Reserve;
+  using Pickle::WriteBool;
+  using Pickle::WriteBytes;
+  using Pickle::WriteData;
+  using Pickle::WriteDouble;
+  using Pickle::WriteFloat;
+  using Pickle::WriteInt;
+  using Pickle::WriteInt64;
+  using Pickle::WriteLong;
+  using Pickle::WriteString;
+  using Pickle::WriteString16;
+  using Pickle::WriteUInt16;
+  using Pickle::WriteUInt32;
+  using Pickle::WriteUInt64;
+
+  // Writes |data| as WriteData() does, but references it rather than copying
+  // it, unless it's small. The writer keeps a reference to |data|.
+  void WriteDataReference(scoped_refptr<RefCountedMemory> data);
+
+  // As above, for data which must stay valid and unmodified until the data of
+  // the writer is sent, e.g. a shared memory mapping.
+  void WriteDataReference(span<const uint8_t> data);
+
+  // The size of the data, including the header.
+  size_t size() const;
+
+  // Returns the data as consecutive buffers, which are valid until the next
+  // write.
+  std::vector<span<const uint8_t>> GetBuffers();
+
+  // Returns a copy of the data.
+  std::vector<uint8_t> Flatten();
+
+#if BUILDFLAG(IS_POSIX)
+  // Writes all of the data to |fd| with writev(). Returns false on error.
+  bool WriteToFileDescriptor(int fd);
+#endif
+
+ private:
+  // A blob which is inserted in the payload of the Pickle, at |offset|.
+  struct Reference {
+    Reference(size_t offset,
+              span<const uint8_t> data,
+              scoped_refptr<RefCountedMemory> owner);
+    Reference(Reference&&);
+    Reference& operator=(Reference&&);
+    ~Reference();
+
+    size_t offset;
+    span<const uint8_t> data;
+    // Keeps |data| alive, if set.
+    scoped_refptr<RefCountedMemory> owner;
+  };
+
+  void AddReference(span<const uint8_t> data,
+                    scoped_refptr<RefCountedMemory> owner);
+
+  std::vector<Reference> references_;
+  // The size of the references, with their padding.
+  size_t referenced_size_ = 0;
+  // A copy of the header of the Pickle, with the size of all the payload.
+  std::vector<uint8_t> header_;
+};
+
+}  // namespace base
+
+#endif  // BASE_PICKLE_GATHER_WRITER_H_
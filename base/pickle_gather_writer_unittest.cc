@@ -0,0 +1,140 @@
+// Copyright 2022 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "base/pickle_gather_writer.h"
+
+#include <stdint.h>
+#include <string.h>
+
+#include <string>
+#include <vector>
+
+#include "base/memory/ref_counted_memory.h"
+#include "base/pickle.h"
+#include "build/build_config.h"
+#include "testing/gtest/include/gtest/gtest.h"
+
+#if BUILDFLAG(IS_POSIX)
+#include "base/files/file.h"
+#include "base/files/file_path.h"
+#include "base/files/file_util.h"
+#include "base/files/scoped_temp_dir.h"
+#endif
+
+namespace base {
+
+namespace {
+
+std::vector<uint8_t> GenerateBlob(size_t size) {
+  std::vector<uint8_t> blob(size);
+  for (size_t i = 0; i < size; ++i)
+    blob[i] = static_cast<uint8_t>(i * 31);
+  return blob;
+}
+
+// Returns whether |buffers| include |data| itself, rather than a copy.
+bool IsReferenced(const std::vector<span<const uint8_t>>& buffers,
+                  span<const uint8_t> data) {
+  for (span<const uint8_t> buffer : buffers) {
+    if (buffer.data() == data.data() && buffer.size() == data.size())
+      return true;
+  }
+  return false;
+}
+
+}  // namespace
+
+TEST(PickleGatherWriterTest, SameDataAsPickle) {
+  // With sizes which need padding.
+  const std::vector<uint8_t> blob = GenerateBlob(100001);
+  scoped_refptr<RefCountedMemory> shared_blob =
+      RefCountedBytes::TakeVector(new std::vector<uint8_t>(GenerateBlob(5000)));
+  const std::vector<uint8_t> small_blob = GenerateBlob(10);
+
+  PickleGatherWriter writer;
+  Pickle pickle;
+  writer.WriteInt(42);
+  pickle.WriteInt(42);
+  writer.WriteDataReference(blob);
+  pickle.WriteData(reinterpret_cast<const char*>(blob.data()), blob.size());
+  writer.WriteDataReference(shared_blob);
+  writer.WriteDataReference(blob);
+  pickle.WriteData(shared_blob->front_as<char>(), shared_blob->size());
+  pickle.WriteData(reinterpret_cast<const char*>(blob.data()), blob.size());
+  writer.WriteString("string");
+  pickle.WriteString("string");
+  writer.WriteDataReference(small_blob);
+  pickle.WriteData(reinterpret_cast<const char*>(small_blob.data()),
+                   small_blob.size());
+
+  EXPECT_EQ(pickle.size(), writer.size());
+  std::vector<span<const uint8_t>> buffers = writer.GetBuffers();
+  EXPECT_TRUE(IsReferenced(buffers, blob));
+  EXPECT_TRUE(IsReferenced(buffers, *shared_blob));
+  EXPECT_FALSE(IsReferenced(buffers, small_blob));
+
+  const std::vector<uint8_t> data = writer.Flatten();
+  ASSERT_EQ(pickle.size(), data.size());
+  EXPECT_EQ(0, memcmp(pickle.data(), data.data(), data.size()));
+
+  Pickle read_pickle(reinterpret_cast<const char*>(data.data()), data.size());
+  PickleIterator iter(read_pickle);
+  int value;
+  ASSERT_TRUE(iter.ReadInt(&value));
+  EXPECT_EQ(42, value);
+  span<const uint8_t> read_blob;
+  ASSERT_TRUE(iter.ReadData(&read_blob));
+  EXPECT_EQ(blob, std::vector<uint8_t>(read_blob.begin(), read_blob.end()));
+}
+
+TEST(PickleGatherWriterTest, CustomHeader) {
+  struct CustomHeader : Pickle::Header {
+    int cookie;
+  };
+  const std::vector<uint8_t> blob = GenerateBlob(8192);
+
+  PickleGatherWriter writer(sizeof(CustomHeader));
+  writer.headerT<CustomHeader>()->cookie = 0x1234;
+  writer.WriteDataReference(blob);
+  writer.WriteBool(true);
+  const std::vector<uint8_t> data = writer.Flatten();
+  EXPECT_EQ(writer.size(), data.size());
+
+  Pickle pickle(reinterpret_cast<const char*>(data.data()), data.size());
+  ASSERT_TRUE(pickle.data());
+  EXPECT_EQ(0x1234, pickle.headerT<CustomHeader>()->cookie);
+  PickleIterator iter(pickle);
+  span<const uint8_t> read_blob;
+  ASSERT_TRUE(iter.ReadData(&read_blob));
+  EXPECT_EQ(blob.size(), read_blob.size());
+  bool value;
+  ASSERT_TRUE(iter.ReadBool(&value));
+  EXPECT_TRUE(value);
+}
+
+#if BUILDFLAG(IS_POSIX)
+TEST(PickleGatherWriterTest, WriteToFileDescriptor) {
+  const std::vector<uint8_t> blob = GenerateBlob(1024 * 1024 + 3);
+  PickleGatherWriter writer;
+  for (int i = 0; i < 10; ++i) {
+    writer.WriteInt(i);
+    writer.WriteDataReference(blob);
+  }
+
+  ScopedTempDir temp_dir;
+  ASSERT_TRUE(temp_dir.CreateUniqueTempDir());
+  const FilePath path = temp_dir.GetPath().AppendASCII("pickle");
+  File file(path, File::FLAG_CREATE | File::FLAG_WRITE);
+  ASSERT_TRUE(file.IsValid());
+  ASSERT_TRUE(writer.WriteToFileDescriptor(file.GetPlatformFile()));
+  file.Close();
+
+  std::string contents;
+  ASSERT_TRUE(ReadFileToString(path, &contents));
+  const std::vector<uint8_t> data = writer.Flatten();
+  EXPECT_EQ(std::string(data.begin(), data.end()), contents);
+}
+#endif  // BUILDFLAG(IS_POSIX)
+
+}  // namespace base
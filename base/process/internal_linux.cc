@@ -4,6 +4,7 @@
 
 #include "base/process/internal_linux.h"
 
+#include <fcntl.h>
 #include <limits.h>
 #include <unistd.h>
 
@@ -12,7 +13,9 @@
 #include <vector>
 
 #include "base/files/file_util.h"
+#include "base/files/scoped_file.h"
 #include "base/logging.h"
+#include "base/posix/eintr_wrapper.h"
 #include "base/notreached.h"
 #include "base/strings/string_number_conversions.h"
 #include "base/strings/string_split.h"
@@ -70,6 +73,27 @@ bool ReadProcFile(const FilePath& file, std::string* buffer) {
   return !buffer->empty();
 }
 
+StringPiece ReadSmallProcFile(int fd, span<char> buffer) {
+  // Synchronously reading files in /proc is safe.
+  ThreadRestrictions::ScopedAllowIO allow_io;
+
+  // Each read generates the whole file, and returns as much of it as fits,
+  // so that a read which doesn't fill |buffer| returns all of it.
+  const ssize_t size =
+      HANDLE_EINTR(pread(fd, buffer.data(), buffer.size(), /*offset=*/0));
+  if (size <= 0 || static_cast<size_t>(size) == buffer.size())
+    return StringPiece();
+  return StringPiece(buffer.data(), static_cast<size_t>(size));
+}
+
+StringPiece ReadSmallProcFile(const char* path, span<char> buffer) {
+  DCHECK(StartsWith(path, "/proc/"));
+  ScopedFD fd(HANDLE_EINTR(open(path, O_RDONLY | O_CLOEXEC)));
+  if (!fd.is_valid())
+    return StringPiece();
+  return ReadSmallProcFile(fd.get(), buffer);
+}
+
 bool ReadProcStats(pid_t pid, std::string* buffer) {
   FilePath stat_file = internal::GetProcPidDir(pid).Append(kStatFile);
   return ReadProcFile(stat_file, buffer);
@@ -77,6 +101,17 @@ bool ReadProcStats(pid_t pid, std::string* buffer) {
 
 bool ParseProcStats(const std::string& stats_data,
                     std::vector<std::string>* proc_stats) {
+  ProcStatsView view;
+  if (!ParseProcStats(StringPiece(stats_data), &view))
+    return false;
+
+  proc_stats->clear();
+  for (size_t i = 0; i < view.size; ++i)
+    proc_stats->emplace_back(view.fields[i]);
+  return true;
+}
+
+bool ParseProcStats(StringPiece stats_data, ProcStatsView* proc_stats) {
   // |stats_data| may be empty if the process disappeared somehow.
   // e.g. http://crbug.com/145811
   if (stats_data.empty())
@@ -88,29 +123,32 @@ bool ParseProcStats(const std::string& stats_data,
   // processes with ')' in the name.
   size_t open_parens_idx = stats_data.find(" (");
   size_t close_parens_idx = stats_data.rfind(") ");
-  if (open_parens_idx == std::string::npos ||
-      close_parens_idx == std::string::npos ||
+  if (open_parens_idx == StringPiece::npos ||
+      close_parens_idx == StringPiece::npos ||
       open_parens_idx > close_parens_idx) {
     DLOG(WARNING) << "Failed to find matched parens in '" << stats_data << "'";
     NOTREACHED();
     return false;
   }
-  open_parens_idx++;
 
-  proc_stats->clear();
+  proc_stats->size = 0;
   // PID.
-  proc_stats->push_back(stats_data.substr(0, open_parens_idx));
+  proc_stats->fields[proc_stats->size++] =
+      stats_data.substr(0, open_parens_idx);
   // Process name without parentheses.
-  proc_stats->push_back(
-      stats_data.substr(open_parens_idx + 1,
-                        close_parens_idx - (open_parens_idx + 1)));
+  proc_stats->fields[proc_stats->size++] = stats_data.substr(
+      open_parens_idx + 2, close_parens_idx - (open_parens_idx + 2));
 
   // Split the rest.
-  std::vector<std::string> other_stats = SplitString(
-      stats_data.substr(close_parens_idx + 2), " ",
-      base::TRIM_WHITESPACE, base::SPLIT_WANT_ALL);
-  for (const auto& i : other_stats)
-    proc_stats->push_back(i);
+  StringPiece other_stats = stats_data.substr(close_parens_idx + 2);
+  while (proc_stats->size < ProcStatsView::kMaxFields) {
+    const size_t end = other_stats.find(' ');
+    proc_stats->fields[proc_stats->size++] =
+        TrimWhitespaceASCII(other_stats.substr(0, end), TRIM_ALL);
+    if (end == StringPiece::npos)
+      break;
+    other_stats.remove_prefix(end + 1);
+  }
   return true;
 }
 
@@ -132,6 +170,15 @@ int64_t GetProcStatsFieldAsInt64(const std::vector<std::string>& proc_stats,
   return StringToInt64(proc_stats[field_num], &value) ? value : 0;
 }
 
+int64_t GetProcStatsFieldAsInt64(const ProcStatsView& proc_stats,
+                                 ProcStatsFields field_num) {
+  DCHECK_GE(field_num, VM_PPID);
+  CHECK_LT(static_cast<size_t>(field_num), proc_stats.size);
+
+  int64_t value;
+  return StringToInt64(proc_stats.fields[field_num], &value) ? value : 0;
+}
+
 size_t GetProcStatsFieldAsSizeT(const std::vector<std::string>& proc_stats,
                                 ProcStatsFields field_num) {
   DCHECK_GE(field_num, VM_PPID);
@@ -141,14 +188,42 @@ size_t GetProcStatsFieldAsSizeT(const std::vector<std::string>& proc_stats,
   return StringToSizeT(proc_stats[field_num], &value) ? value : 0;
 }
 
+size_t GetProcStatsFieldAsSizeT(const ProcStatsView& proc_stats,
+                                ProcStatsFields field_num) {
+  DCHECK_GE(field_num, VM_PPID);
+  CHECK_LT(static_cast<size_t>(field_num), proc_stats.size);
+
+  size_t value;
+  return StringToSizeT(proc_stats.fields[field_num], &value) ? value : 0;
+}
+
+bool FindProcFileField(StringPiece data,
+                       StringPiece field,
+                       StringPiece* value) {
+  while (!data.empty()) {
+    const size_t end = data.find('\n');
+    const StringPiece line = data.substr(0, end);
+    data.remove_prefix(end == StringPiece::npos ? data.size() : end + 1);
+
+    const size_t colon = line.find(':');
+    if (colon == StringPiece::npos ||
+        TrimWhitespaceASCII(line.substr(0, colon), TRIM_ALL) != field) {
+      continue;
+    }
+    *value = TrimWhitespaceASCII(line.substr(colon + 1), TRIM_ALL);
+    return true;
+  }
+  return false;
+}
+
 int64_t ReadStatFileAndGetFieldAsInt64(const FilePath& stat_file,
                                        ProcStatsFields field_num) {
-  std::string stats_data;
-  if (!ReadProcFile(stat_file, &stats_data))
-    return 0;
-  std::vector<std::string> proc_stats;
-  if (!ParseProcStats(stats_data, &proc_stats))
+  char buffer[kSmallProcFileBufferSize];
+  ProcStatsView proc_stats;
+  if (!ParseProcStats(ReadSmallProcFile(stat_file.value().c_str(), buffer),
+                      &proc_stats)) {
     return 0;
+  }
   return GetProcStatsFieldAsInt64(proc_stats, field_num);
 }
 
@@ -164,12 +239,13 @@ int64_t ReadProcSelfStatsAndGetFieldAsInt64(ProcStatsFields field_num) {
 
 size_t ReadProcStatsAndGetFieldAsSizeT(pid_t pid,
                                        ProcStatsFields field_num) {
-  std::string stats_data;
-  if (!ReadProcStats(pid, &stats_data))
-    return 0;
-  std::vector<std::string> proc_stats;
-  if (!ParseProcStats(stats_data, &proc_stats))
+  FilePath stat_file = internal::GetProcPidDir(pid).Append(kStatFile);
+  char buffer[kSmallProcFileBufferSize];
+  ProcStatsView proc_stats;
+  if (!ParseProcStats(ReadSmallProcFile(stat_file.value().c_str(), buffer),
+                      &proc_stats)) {
     return 0;
+  }
   return GetProcStatsFieldAsSizeT(proc_stats, field_num);
 }
 
@@ -215,7 +291,7 @@ TimeDelta GetUserCpuTimeSinceBoot() {
   return ClockTicksToTimeDelta(user + nice);
 }
 
-TimeDelta ClockTicksToTimeDelta(int clock_ticks) {
+TimeDelta ClockTicksToTimeDelta(int64_t clock_ticks) {
   // This queries the /proc-specific scaling factor which is
   // conceptually the system hertz.  To dump this value on another
   // system, try
@@ -14,10 +14,12 @@
 #include <string>
 #include <vector>
 
+#include "base/containers/span.h"
 #include "base/files/dir_reader_posix.h"
 #include "base/files/file_path.h"
 #include "base/process/process_handle.h"
 #include "base/strings/string_number_conversions.h"
+#include "base/strings/string_piece.h"
 #include "base/threading/platform_thread.h"
 
 namespace base {
@@ -41,6 +43,20 @@ base::FilePath GetProcPidDir(pid_t pid);
 // read and is non-empty.
 bool ReadProcFile(const FilePath& file, std::string* buffer);
 
+// The size of the buffers which the small /proc files of a process, e.g.
+// stat, statm, status and io, are read into by ReadSmallProcFile(). The
+// largest is status, whose CPU masks bring it to about 4 KiB with 8192 CPUs.
+constexpr size_t kSmallProcFileBufferSize = 8192;
+
+// Reads the /proc file |fd| from its start into |buffer|, without allocating,
+// so that a file kept open is read again with a single pread(). Only suits
+// the files generated whole by each read, such as the ones above. Returns
+// their contents, or an empty StringPiece on error or if they fill |buffer|.
+StringPiece ReadSmallProcFile(int fd, span<char> buffer);
+
+// Same as above, but opens |path| for the read.
+StringPiece ReadSmallProcFile(const char* path, span<char> buffer);
+
 // Take a /proc directory entry named |d_name|, and if it is the directory for
 // a process, convert it to a pid_t.
 // Returns 0 on failure.
@@ -57,6 +73,19 @@ bool ReadProcStats(pid_t pid, std::string* buffer);
 bool ParseProcStats(const std::string& stats_data,
                     std::vector<std::string>* proc_stats);
 
+// The same fields as views into the contents of the file, which the parse
+// below splits in a single pass without allocating.
+struct ProcStatsView {
+  // Current kernels have 52 fields, and the others are ignored.
+  static constexpr size_t kMaxFields = 64;
+
+  StringPiece fields[kMaxFields];
+  size_t size = 0;
+};
+
+// Same as above, but for |proc_stats| which point into |stats_data|.
+bool ParseProcStats(StringPiece stats_data, ProcStatsView* proc_stats);
+
 // Fields from /proc/<pid>/stat, 0-based. See man 5 proc.
 // If the ordering ever changes, carefully review functions that use these
 // values.
@@ -81,9 +110,19 @@ enum ProcStatsFields {
 int64_t GetProcStatsFieldAsInt64(const std::vector<std::string>& proc_stats,
                                  ProcStatsFields field_num);
 
+int64_t GetProcStatsFieldAsInt64(const ProcStatsView& proc_stats,
+                                 ProcStatsFields field_num);
+
 // Same as GetProcStatsFieldAsInt64(), but for size_t values.
 size_t GetProcStatsFieldAsSizeT(const std::vector<std::string>& proc_stats,
                                 ProcStatsFields field_num);
+size_t GetProcStatsFieldAsSizeT(const ProcStatsView& proc_stats,
+                                ProcStatsFields field_num);
+
+// Finds the line of |field| in the "Field: value" lines of |data|, e.g. the
+// contents of /proc/<pid>/status or io, and sets |value| to its trimmed
+// value. Doesn't allocate. Returns false if there is no such line.
+bool FindProcFileField(StringPiece data, StringPiece field, StringPiece* value);
 
 // Convenience wrappers around GetProcStatsFieldAsInt64(), ParseProcStats() and
 // ReadProcStats(). See GetProcStatsFieldAsInt64() for details.
@@ -103,7 +142,7 @@ Time GetBootTime();
 TimeDelta GetUserCpuTimeSinceBoot();
 
 // Converts Linux clock ticks to a wall time delta.
-TimeDelta ClockTicksToTimeDelta(int clock_ticks);
+TimeDelta ClockTicksToTimeDelta(int64_t clock_ticks);
 
 // Executes the lambda for every task in the process's /proc/<pid>/task
 // directory. The thread id and file path of the task directory are provided as
@@ -325,6 +325,11 @@ struct BASE_EXPORT LaunchOptions {
 //   parent's stdout and stderr.
 // - If the first argument on the command line does not contain a slash,
 //   PATH will be searched.  (See man execvp.)
+// - On Linux 5.11+, unless options::clone_flags or options::pre_exec_delegate
+//   are set, the child is started like posix_spawn() does, with
+//   clone(CLONE_VM | CLONE_VFORK), which doesn't copy the page tables of the
+//   parent like fork() does, and takes the same time however large the
+//   parent is.
 BASE_EXPORT Process LaunchProcess(const CommandLine& cmdline,
                                   const LaunchOptions& options);
 
@@ -7,12 +7,15 @@
 #include <dirent.h>
 #include <errno.h>
 #include <fcntl.h>
+#include <limits.h>
 #include <sched.h>
 #include <setjmp.h>
 #include <signal.h>
 #include <stddef.h>
 #include <stdint.h>
 #include <stdlib.h>
+#include <string.h>
+#include <sys/mman.h>
 #include <sys/resource.h>
 #include <sys/syscall.h>
 #include <sys/time.h>
@@ -24,6 +27,7 @@
 #include <limits>
 #include <memory>
 #include <set>
+#include <vector>
 
 #include "base/command_line.h"
 #include "base/compiler_specific.h"
@@ -33,6 +37,7 @@
 #include "base/files/file_util.h"
 #include "base/files/scoped_file.h"
 #include "base/logging.h"
+#include "base/memory/page_size.h"
 #include "base/metrics/histogram_macros.h"
 #include "base/posix/eintr_wrapper.h"
 #include "base/process/environment_internal.h"
@@ -268,6 +273,375 @@ void CloseSuperfluousFds(const base::InjectiveMultimap& saved_mapping) {
   }
 }
 
+namespace {
+
+// What the child half of LaunchProcess() needs, all prepared by the parent,
+// since the child can neither allocate nor take locks.
+struct ChildLaunchState {
+  const LaunchOptions& options;
+  char* const* argv;
+  const char* executable_path;
+  const char* current_directory;
+  // The environment of the child, which is that of the parent unless the
+  // options change it.
+  char** environment;
+  sigset_t orig_sigmask;
+  InjectiveMultimap& fd_shuffle1;
+  const InjectiveMultimap& fd_shuffle2;
+
+#if BUILDFLAG(IS_LINUX) || BUILDFLAG(IS_CHROMEOS)
+  // Whether the child shares the memory of the parent, see
+  // LaunchWithSharedMemory(). Such a child may only write to its own stack:
+  // it may not set the environment, and may not reset the FD ownership of
+  // ScopedFD, so it may not close() the descriptors it doesn't want either,
+  // and marks them to be closed by the exec instead.
+  bool shares_memory = false;
+  // For a child which shares memory, the PATH to look for |executable_path|
+  // in, and the argv of /bin/sh to run it if it is a script without a
+  // shebang, with room for its path at [1].
+  const char* search_path = nullptr;
+  char** shell_argv = nullptr;
+#endif
+};
+
+#if BUILDFLAG(IS_LINUX) || BUILDFLAG(IS_CHROMEOS)
+// Unlike FileDescriptorTableInjection, leaves the descriptors to close open
+// until the exec, for a child which shares memory, see ChildLaunchState.
+class CloseOnExecInjection final : public FileDescriptorTableInjection {
+ private:
+  void Close(int fd) override {
+    int ret = fcntl(fd, F_SETFD, FD_CLOEXEC);
+    DPCHECK(ret == 0);
+  }
+};
+
+#if defined(__NR_close_range)
+constexpr long kCloseRangeSyscall = __NR_close_range;
+#else
+// close_range() has the same number on all architectures.
+constexpr long kCloseRangeSyscall = 436;
+#endif
+constexpr unsigned int kCloseRangeCloexec = 1u << 2;
+
+// Returns whether close_range() may mark descriptors to be closed by the next
+// exec, since Linux 5.11.
+bool HasCloseRangeCloexec() {
+  static const bool has_close_range_cloexec =
+      syscall(kCloseRangeSyscall, ~0u, ~0u, kCloseRangeCloexec) == 0;
+  return has_close_range_cloexec;
+}
+
+// Like CloseSuperfluousFds(), but marks the descriptors to be closed by the
+// next exec instead of closing them, for a child which shares memory. Unlike
+// CloseSuperfluousFds(), needs no descriptor of /proc/self/fd, which it would
+// have to close().
+bool MarkSuperfluousFdsCloseOnExec(const InjectiveMultimap& saved_mapping) {
+  // Marks the ranges between the descriptors to keep, in order.
+  unsigned int first = STDERR_FILENO + 1;
+  while (true) {
+    // Cannot use STL iterators here, since debug iterators use locks.
+    unsigned int next_saved = ~0u;
+    for (size_t i = 0; i < saved_mapping.size(); ++i) {
+      const auto dest = static_cast<unsigned int>(saved_mapping[i].dest);
+      if (dest >= first && dest < next_saved)
+        next_saved = dest;
+    }
+    const unsigned int last = next_saved == ~0u ? ~0u : next_saved - 1;
+    if (next_saved > first &&
+        syscall(kCloseRangeSyscall, first, last, kCloseRangeCloexec) != 0) {
+      return false;
+    }
+    if (next_saved == ~0u)
+      return true;
+    first = next_saved + 1;
+  }
+}
+
+// Runs |file| like execvp() does, with the environment |envp| and the
+// directories of |search_path|, but without reading the environment of the
+// process, for a child which shares memory. |shell_argv| is the argv of
+// /bin/sh, see ChildLaunchState. Only returns on failure.
+void ExecvpeInChild(const char* file,
+                    char* const* argv,
+                    char* const* envp,
+                    const char* search_path,
+                    char** shell_argv) {
+  auto exec = [&](const char* path) {
+    execve(path, argv, envp);
+    if (errno == ENOEXEC) {
+      shell_argv[1] = const_cast<char*>(path);
+      execve(shell_argv[0], shell_argv, envp);
+    }
+  };
+
+  if (!*file) {
+    errno = ENOENT;
+    return;
+  }
+  if (strchr(file, '/')) {
+    exec(file);
+    return;
+  }
+
+  const size_t file_length = strlen(file);
+  bool saw_eacces = false;
+  for (const char* dir = search_path;;) {
+    const char* const end = strchrnul(dir, ':');
+    const size_t dir_length = static_cast<size_t>(end - dir);
+    char path[PATH_MAX];
+    if (dir_length + file_length + 2 <= sizeof(path)) {
+      memcpy(path, dir, dir_length);
+      // An empty entry is the current directory.
+      size_t length = dir_length;
+      if (length)
+        path[length++] = '/';
+      memcpy(path + length, file, file_length + 1);
+      exec(path);
+      // Like execvp(), tries the next directory unless the file was found
+      // but failed to run.
+      if (errno == EACCES) {
+        saw_eacces = true;
+      } else if (errno != ENOENT && errno != ENOTDIR && errno != ESTALE &&
+                 errno != ENODEV && errno != ETIMEDOUT) {
+        return;
+      }
+    }
+    if (!*end)
+      break;
+    dir = end + 1;
+  }
+  if (saw_eacces)
+    errno = EACCES;
+}
+#endif  // BUILDFLAG(IS_LINUX) || BUILDFLAG(IS_CHROMEOS)
+
+// The child half of LaunchProcess(), which only returns by exec'ing.
+[[noreturn]] void RunChild(ChildLaunchState& state) {
+  const LaunchOptions& options = state.options;
+#if BUILDFLAG(IS_LINUX) || BUILDFLAG(IS_CHROMEOS)
+  const bool shares_memory = state.shares_memory;
+#else
+  const bool shares_memory = false;
+#endif
+
+  // DANGER: no calls to malloc or locks are allowed from now on:
+  // http://crbug.com/36678
+
+  // DANGER: fork() rule: in the child, if you don't end up doing exec*(),
+  // you call _exit() instead of exit(). This is because _exit() does not
+  // call any previously-registered (in the parent) exit handlers, which
+  // might do things like block waiting for threads that don't even exist
+  // in the child.
+
+#if BUILDFLAG(IS_LINUX) || BUILDFLAG(IS_CHROMEOS)
+  // See comments on the ResetFDOwnership() declaration in
+  // base/files/scoped_file.h regarding why this is called early here.
+  if (!shares_memory)
+    subtle::ResetFDOwnership();
+#endif
+
+  {
+    // If a child process uses the readline library, the process block
+    // forever. In BSD like OSes including OS X it is safe to assign /dev/null
+    // as stdin. See http://crbug.com/56596.
+    //
+    // The descriptor is closed by the exec, since a child which shares memory
+    // may not close() it.
+    const int null_fd =
+        HANDLE_EINTR(open("/dev/null", O_RDONLY | O_CLOEXEC));
+    if (null_fd < 0) {
+      RAW_LOG(ERROR, "Failed to open /dev/null");
+      _exit(127);
+    }
+
+    if (null_fd == STDIN_FILENO) {
+      fcntl(STDIN_FILENO, F_SETFD, 0);
+    } else {
+      int new_fd = HANDLE_EINTR(dup2(null_fd, STDIN_FILENO));
+      if (new_fd != STDIN_FILENO) {
+        RAW_LOG(ERROR, "Failed to dup /dev/null for stdin");
+        _exit(127);
+      }
+    }
+  }
+
+  if (options.new_process_group) {
+    // Instead of inheriting the process group ID of the parent, the child
+    // starts off a new process group with pgid equal to its process ID.
+    if (setpgid(0, 0) < 0) {
+      RAW_LOG(ERROR, "setpgid failed");
+      _exit(127);
+    }
+  }
+
+  if (options.maximize_rlimits) {
+    // Some resource limits need to be maximal in this child.
+    for (auto resource : *options.maximize_rlimits) {
+      struct rlimit limit;
+      if (getrlimit(resource, &limit) < 0) {
+        RAW_LOG(WARNING, "getrlimit failed");
+      } else if (limit.rlim_cur < limit.rlim_max) {
+        limit.rlim_cur = limit.rlim_max;
+        if (setrlimit(resource, &limit) < 0) {
+          RAW_LOG(WARNING, "setrlimit failed");
+        }
+      }
+    }
+  }
+
+  ResetChildSignalHandlersToDefaults();
+  SetSignalMask(state.orig_sigmask);
+
+#if 0
+  // When debugging it can be helpful to check that we really aren't making
+  // any hidden calls to malloc.
+  void *malloc_thunk =
+      reinterpret_cast<void*>(reinterpret_cast<intptr_t>(malloc) & ~4095);
+  HANDLE_EINTR(mprotect(malloc_thunk, 4096, PROT_READ | PROT_WRITE | PROT_EXEC));
+  memset(reinterpret_cast<void*>(malloc), 0xff, 8);
+#endif  // 0
+
+#if BUILDFLAG(IS_CHROMEOS_ASH) || BUILDFLAG(IS_CHROMEOS_LACROS)
+  if (options.ctrl_terminal_fd >= 0) {
+    // Set process' controlling terminal.
+    if (HANDLE_EINTR(setsid()) != -1) {
+      if (HANDLE_EINTR(
+              ioctl(options.ctrl_terminal_fd, TIOCSCTTY, nullptr)) == -1) {
+        RAW_LOG(WARNING, "ioctl(TIOCSCTTY), ctrl terminal not set");
+      }
+    } else {
+      RAW_LOG(WARNING, "setsid failed, ctrl terminal not set");
+    }
+  }
+#endif  // BUILDFLAG(IS_CHROMEOS_ASH) || BUILDFLAG(IS_CHROMEOS_LACROS)
+
+  if (!shares_memory && state.environment != GetEnvironment())
+    SetEnvironment(state.environment);
+
+  // fd_shuffle1 is mutated by this call because it cannot malloc.
+  FileDescriptorTableInjection closing_injection;
+#if BUILDFLAG(IS_LINUX) || BUILDFLAG(IS_CHROMEOS)
+  CloseOnExecInjection close_on_exec_injection;
+  InjectionDelegate* injection = shares_memory ? &close_on_exec_injection
+                                               : &closing_injection;
+#else
+  InjectionDelegate* injection = &closing_injection;
+#endif
+  if (!PerformInjectiveMultimapDestructive(&state.fd_shuffle1, injection))
+    _exit(127);
+
+#if BUILDFLAG(IS_LINUX) || BUILDFLAG(IS_CHROMEOS)
+  if (shares_memory) {
+    if (!MarkSuperfluousFdsCloseOnExec(state.fd_shuffle2))
+      _exit(127);
+  } else
+#endif
+  {
+    CloseSuperfluousFds(state.fd_shuffle2);
+  }
+
+  // Set NO_NEW_PRIVS by default. Since NO_NEW_PRIVS only exists in kernel
+  // 3.5+, do not check the return value of prctl here.
+#if BUILDFLAG(IS_LINUX) || BUILDFLAG(IS_CHROMEOS) || BUILDFLAG(IS_AIX)
+#ifndef PR_SET_NO_NEW_PRIVS
+#define PR_SET_NO_NEW_PRIVS 38
+#endif
+  if (!options.allow_new_privs) {
+    if (prctl(PR_SET_NO_NEW_PRIVS, 1, 0, 0, 0) && errno != EINVAL) {
+      // Only log if the error is not EINVAL (i.e. not supported).
+      RAW_LOG(FATAL, "prctl(PR_SET_NO_NEW_PRIVS) failed");
+    }
+  }
+
+  if (options.kill_on_parent_death) {
+    if (prctl(PR_SET_PDEATHSIG, SIGKILL) != 0) {
+      RAW_LOG(ERROR, "prctl(PR_SET_PDEATHSIG) failed");
+      _exit(127);
+    }
+  }
+#endif
+
+  if (state.current_directory != nullptr) {
+    RAW_CHECK(chdir(state.current_directory) == 0);
+  }
+
+#if BUILDFLAG(IS_LINUX) || BUILDFLAG(IS_CHROMEOS)
+  if (shares_memory) {
+    ExecvpeInChild(state.executable_path, state.argv, state.environment,
+                   state.search_path, state.shell_argv);
+  } else
+#endif
+  {
+    if (options.pre_exec_delegate != nullptr) {
+      options.pre_exec_delegate->RunAsyncSafe();
+    }
+
+    execvp(state.executable_path, state.argv);
+  }
+
+  RAW_LOG(ERROR, "LaunchProcess: failed to execvp:");
+  RAW_LOG(ERROR, state.argv[0]);
+  _exit(127);
+}
+
+#if BUILDFLAG(IS_LINUX) || BUILDFLAG(IS_CHROMEOS)
+// The size of the stack of a child started by LaunchWithSharedMemory(), which
+// only runs RunChild().
+constexpr size_t kSharedMemoryChildStackSize = 64 * 1024;
+
+// Returns whether the child of LaunchProcess() may share the memory of the
+// parent, see LaunchWithSharedMemory(). |options| may ask for what only a
+// forked child allows: clone flags, or a pre-exec delegate, which may write
+// to memory it expects to be a copy. The runtimes of the sanitizers also
+// expect a forked child.
+bool CanLaunchWithSharedMemory(const LaunchOptions& options) {
+#if defined(ADDRESS_SANITIZER) || defined(MEMORY_SANITIZER) || \
+    defined(THREAD_SANITIZER)
+  return false;
+#else
+  return !options.clone_flags && !options.pre_exec_delegate &&
+         HasCloseRangeCloexec();
+#endif
+}
+
+int RunChildWithSharedMemory(void* state) {
+  RunChild(*static_cast<ChildLaunchState*>(state));
+}
+
+// Starts the child with clone(CLONE_VM | CLONE_VFORK), like posix_spawn()
+// does: the child runs in the memory of the parent, whose thread is suspended
+// until the child execs or exits, instead of in a copy of it. This spares
+// copying the page tables of the parent, which takes milliseconds for a
+// large parent, and the copies on write that follow. Returns the pid of the
+// child, or -1 on failure.
+pid_t LaunchWithSharedMemory(ChildLaunchState* state) {
+  DCHECK(state->shares_memory);
+
+  // The child gets its own stack, with a guard page below it.
+  const size_t guard_size = GetPageSize();
+  const size_t mapping_size = guard_size + kSharedMemoryChildStackSize;
+  void* const mapping =
+      mmap(nullptr, mapping_size, PROT_READ | PROT_WRITE,
+           MAP_PRIVATE | MAP_ANONYMOUS | MAP_STACK, -1, 0);
+  if (mapping == MAP_FAILED)
+    return -1;
+  if (mprotect(mapping, guard_size, PROT_NONE) != 0) {
+    munmap(mapping, mapping_size);
+    return -1;
+  }
+
+  // The stack grows downward on all the architectures ForkWithFlags()
+  // supports.
+  void* const stack_top = static_cast<char*>(mapping) + mapping_size;
+  const pid_t pid = clone(&RunChildWithSharedMemory, stack_top,
+                          CLONE_VM | CLONE_VFORK | SIGCHLD, state);
+  munmap(mapping, mapping_size);
+  return pid;
+}
+#endif  // BUILDFLAG(IS_LINUX) || BUILDFLAG(IS_CHROMEOS)
+
+}  // namespace
+
 Process LaunchProcess(const CommandLine& cmdline,
                       const LaunchOptions& options) {
   return LaunchProcess(cmdline.argv(), options);
@@ -277,10 +651,16 @@ Process LaunchProcess(const std::vector<std::string>& argv,
                       const LaunchOptions& options) {
   TRACE_EVENT0("base", "LaunchProcess");
 
+  // Cannot use STL iterators in the child, since debug iterators use locks,
+  // so the descriptors to remap are prepared here.
   InjectiveMultimap fd_shuffle1;
   InjectiveMultimap fd_shuffle2;
   fd_shuffle1.reserve(options.fds_to_remap.size());
   fd_shuffle2.reserve(options.fds_to_remap.size());
+  for (const auto& value : options.fds_to_remap) {
+    fd_shuffle1.push_back(InjectionArc(value.first, value.second, false));
+    fd_shuffle2.push_back(InjectionArc(value.first, value.second, false));
+  }
 
   std::vector<char*> argv_cstr;
   argv_cstr.reserve(argv.size() + 1);
@@ -289,24 +669,66 @@ Process LaunchProcess(const std::vector<std::string>& argv,
   argv_cstr.push_back(nullptr);
 
   std::unique_ptr<char* []> new_environ;
-  char* const empty_environ = nullptr;
-  char* const* old_environ = GetEnvironment();
+  char* empty_environ = nullptr;
+  char** old_environ = GetEnvironment();
   if (options.clear_environment)
     old_environ = &empty_environ;
   if (!options.environment.empty())
     new_environ = internal::AlterEnvironment(old_environ, options.environment);
 
-  sigset_t full_sigset;
-  sigfillset(&full_sigset);
-  const sigset_t orig_sigmask = SetSignalMask(full_sigset);
-
   const char* current_directory = nullptr;
   if (!options.current_directory.empty()) {
     current_directory = options.current_directory.value().c_str();
   }
 
+  const char* executable_path = !options.real_path.empty() ?
+      options.real_path.value().c_str() : argv_cstr[0];
+
+  ChildLaunchState state{
+      options,
+      argv_cstr.data(),
+      executable_path,
+      current_directory,
+      new_environ ? new_environ.get() : old_environ,
+      /*orig_sigmask=*/{},
+      fd_shuffle1,
+      fd_shuffle2,
+  };
+
+#if BUILDFLAG(IS_LINUX) || BUILDFLAG(IS_CHROMEOS)
+  std::vector<char*> shell_argv;
+  if (CanLaunchWithSharedMemory(options)) {
+    state.shares_memory = true;
+
+    // Like execvp(), falls back to the default path of confstr(_CS_PATH).
+    state.search_path = "/bin:/usr/bin";
+    for (char** variable = state.environment; *variable; ++variable) {
+      if (strncmp(*variable, "PATH=", 5) == 0) {
+        state.search_path = *variable + 5;
+        break;
+      }
+    }
+
+    shell_argv.reserve(argv_cstr.size() + 1);
+    shell_argv.push_back(const_cast<char*>("/bin/sh"));
+    shell_argv.push_back(nullptr);
+    shell_argv.insert(shell_argv.end(), argv_cstr.begin() + 1,
+                      argv_cstr.end());
+    state.shell_argv = shell_argv.data();
+  }
+#endif
+
+  sigset_t full_sigset;
+  sigfillset(&full_sigset);
+  state.orig_sigmask = SetSignalMask(full_sigset);
+
   pid_t pid;
   base::TimeTicks before_fork = TimeTicks::Now();
+#if BUILDFLAG(IS_LINUX) || BUILDFLAG(IS_CHROMEOS)
+  if (state.shares_memory) {
+    pid = LaunchWithSharedMemory(&state);
+  } else
+#endif
 #if BUILDFLAG(IS_LINUX) || BUILDFLAG(IS_CHROMEOS) || BUILDFLAG(IS_AIX)
   if (options.clone_flags) {
     // Signal handling in this function assumes the creation of a new
@@ -334,7 +756,7 @@ Process LaunchProcess(const std::vector<std::string>& argv,
   // Always restore the original signal mask in the parent.
   if (pid != 0) {
     base::TimeTicks after_fork = TimeTicks::Now();
-    SetSignalMask(orig_sigmask);
+    SetSignalMask(state.orig_sigmask);
 
     base::TimeDelta fork_time = after_fork - before_fork;
     UMA_HISTOGRAM_TIMES("MPArch.ForkTime", fork_time);
@@ -346,154 +768,17 @@ Process LaunchProcess(const std::vector<std::string>& argv,
   }
   if (pid == 0) {
     // Child process
+    RunChild(state);
+  }
 
-    // DANGER: no calls to malloc or locks are allowed from now on:
-    // http://crbug.com/36678
-
-    // DANGER: fork() rule: in the child, if you don't end up doing exec*(),
-    // you call _exit() instead of exit(). This is because _exit() does not
-    // call any previously-registered (in the parent) exit handlers, which
-    // might do things like block waiting for threads that don't even exist
-    // in the child.
-
-#if BUILDFLAG(IS_LINUX) || BUILDFLAG(IS_CHROMEOS)
-    // See comments on the ResetFDOwnership() declaration in
-    // base/files/scoped_file.h regarding why this is called early here.
-    subtle::ResetFDOwnership();
-#endif
-
-    {
-      // If a child process uses the readline library, the process block
-      // forever. In BSD like OSes including OS X it is safe to assign /dev/null
-      // as stdin. See http://crbug.com/56596.
-      base::ScopedFD null_fd(HANDLE_EINTR(open("/dev/null", O_RDONLY)));
-      if (!null_fd.is_valid()) {
-        RAW_LOG(ERROR, "Failed to open /dev/null");
-        _exit(127);
-      }
-
-      int new_fd = HANDLE_EINTR(dup2(null_fd.get(), STDIN_FILENO));
-      if (new_fd != STDIN_FILENO) {
-        RAW_LOG(ERROR, "Failed to dup /dev/null for stdin");
-        _exit(127);
-      }
-    }
-
-    if (options.new_process_group) {
-      // Instead of inheriting the process group ID of the parent, the child
-      // starts off a new process group with pgid equal to its process ID.
-      if (setpgid(0, 0) < 0) {
-        RAW_LOG(ERROR, "setpgid failed");
-        _exit(127);
-      }
-    }
-
-    if (options.maximize_rlimits) {
-      // Some resource limits need to be maximal in this child.
-      for (auto resource : *options.maximize_rlimits) {
-        struct rlimit limit;
-        if (getrlimit(resource, &limit) < 0) {
-          RAW_LOG(WARNING, "getrlimit failed");
-        } else if (limit.rlim_cur < limit.rlim_max) {
-          limit.rlim_cur = limit.rlim_max;
-          if (setrlimit(resource, &limit) < 0) {
-            RAW_LOG(WARNING, "setrlimit failed");
-          }
-        }
-      }
-    }
-
-    ResetChildSignalHandlersToDefaults();
-    SetSignalMask(orig_sigmask);
-
-#if 0
-    // When debugging it can be helpful to check that we really aren't making
-    // any hidden calls to malloc.
-    void *malloc_thunk =
-        reinterpret_cast<void*>(reinterpret_cast<intptr_t>(malloc) & ~4095);
-    HANDLE_EINTR(mprotect(malloc_thunk, 4096, PROT_READ | PROT_WRITE | PROT_EXEC));
-    memset(reinterpret_cast<void*>(malloc), 0xff, 8);
-#endif  // 0
-
-#if BUILDFLAG(IS_CHROMEOS_ASH) || BUILDFLAG(IS_CHROMEOS_LACROS)
-    if (options.ctrl_terminal_fd >= 0) {
-      // Set process' controlling terminal.
-      if (HANDLE_EINTR(setsid()) != -1) {
-        if (HANDLE_EINTR(
-                ioctl(options.ctrl_terminal_fd, TIOCSCTTY, nullptr)) == -1) {
-          RAW_LOG(WARNING, "ioctl(TIOCSCTTY), ctrl terminal not set");
-        }
-      } else {
-        RAW_LOG(WARNING, "setsid failed, ctrl terminal not set");
-      }
-    }
-#endif  // BUILDFLAG(IS_CHROMEOS_ASH) || BUILDFLAG(IS_CHROMEOS_LACROS)
-
-    // Cannot use STL iterators here, since debug iterators use locks.
-    // NOLINTNEXTLINE(modernize-loop-convert)
-    for (size_t i = 0; i < options.fds_to_remap.size(); ++i) {
-      const FileHandleMappingVector::value_type& value =
-          options.fds_to_remap[i];
-      fd_shuffle1.push_back(InjectionArc(value.first, value.second, false));
-      fd_shuffle2.push_back(InjectionArc(value.first, value.second, false));
-    }
-
-    if (!options.environment.empty() || options.clear_environment)
-      SetEnvironment(new_environ.get());
-
-    // fd_shuffle1 is mutated by this call because it cannot malloc.
-    if (!ShuffleFileDescriptors(&fd_shuffle1))
-      _exit(127);
-
-    CloseSuperfluousFds(fd_shuffle2);
-
-    // Set NO_NEW_PRIVS by default. Since NO_NEW_PRIVS only exists in kernel
-    // 3.5+, do not check the return value of prctl here.
-#if BUILDFLAG(IS_LINUX) || BUILDFLAG(IS_CHROMEOS) || BUILDFLAG(IS_AIX)
-#ifndef PR_SET_NO_NEW_PRIVS
-#define PR_SET_NO_NEW_PRIVS 38
-#endif
-    if (!options.allow_new_privs) {
-      if (prctl(PR_SET_NO_NEW_PRIVS, 1, 0, 0, 0) && errno != EINVAL) {
-        // Only log if the error is not EINVAL (i.e. not supported).
-        RAW_LOG(FATAL, "prctl(PR_SET_NO_NEW_PRIVS) failed");
-      }
-    }
-
-    if (options.kill_on_parent_death) {
-      if (prctl(PR_SET_PDEATHSIG, SIGKILL) != 0) {
-        RAW_LOG(ERROR, "prctl(PR_SET_PDEATHSIG) failed");
-        _exit(127);
-      }
-    }
-#endif
-
-    if (current_directory != nullptr) {
-      RAW_CHECK(chdir(current_directory) == 0);
-    }
-
-    if (options.pre_exec_delegate != nullptr) {
-      options.pre_exec_delegate->RunAsyncSafe();
-    }
-
-    const char* executable_path = !options.real_path.empty() ?
-        options.real_path.value().c_str() : argv_cstr[0];
-
-    execvp(executable_path, argv_cstr.data());
-
-    RAW_LOG(ERROR, "LaunchProcess: failed to execvp:");
-    RAW_LOG(ERROR, argv_cstr[0]);
-    _exit(127);
-  } else {
-    // Parent process
-    if (options.wait) {
-      // While this isn't strictly disk IO, waiting for another process to
-      // finish is the sort of thing ThreadRestrictions is trying to prevent.
-      ScopedBlockingCall scoped_blocking_call(FROM_HERE,
-                                              BlockingType::MAY_BLOCK);
-      pid_t ret = HANDLE_EINTR(waitpid(pid, nullptr, 0));
-      DPCHECK(ret > 0);
-    }
+  // Parent process
+  if (options.wait) {
+    // While this isn't strictly disk IO, waiting for another process to
+    // finish is the sort of thing ThreadRestrictions is trying to prevent.
+    ScopedBlockingCall scoped_blocking_call(FROM_HERE,
+                                            BlockingType::MAY_BLOCK);
+    pid_t ret = HANDLE_EINTR(waitpid(pid, nullptr, 0));
+    DPCHECK(ret > 0);
   }
 
   return Process(pid);
@@ -45,6 +45,12 @@
 #include "base/threading/platform_thread.h"
 #endif
 
+#if BUILDFLAG(IS_LINUX) || BUILDFLAG(IS_CHROMEOS) || BUILDFLAG(IS_ANDROID)
+#include "base/containers/flat_map.h"
+#include "base/containers/span.h"
+#include "base/files/scoped_file.h"
+#endif
+
 namespace base {
 
 class Value;
@@ -297,6 +303,85 @@ class BASE_EXPORT ProcessMetrics {
 #endif  // BUILDFLAG(IS_MAC)
 };
 
+#if BUILDFLAG(IS_LINUX) || BUILDFLAG(IS_CHROMEOS) || BUILDFLAG(IS_ANDROID)
+// Samples the metrics of many processes at once, e.g. for a collector which
+// polls all the processes of the system every second. Unlike ProcessMetrics,
+// it keeps the /proc files of each process open between samples and parses
+// them in a fixed buffer, so that sampling a process already sampled costs a
+// pread() per file, and allocates nothing.
+//
+// Not thread-safe.
+class BASE_EXPORT ProcessMetricsSampler {
+ public:
+  struct BASE_EXPORT Options {
+    // Whether to also read /proc/<pid>/status, for |vm_swap_bytes|.
+    bool vm_swap = false;
+
+    // The most files kept open, beyond which the files of the processes are
+    // opened for each sample. If 0, a quarter of GetMaxFds().
+    size_t max_open_files = 0;
+  };
+
+  struct Sample {
+    ProcessId pid = kNullProcessId;
+    TimeDelta cumulative_cpu_usage;
+    size_t resident_set_size = 0;  // In bytes.
+    size_t virtual_size = 0;       // In bytes.
+    int num_threads = 0;
+    PageFaultCounts page_faults = {0, 0};
+    uint64_t vm_swap_bytes = 0;  // If |Options::vm_swap|.
+  };
+
+  ProcessMetricsSampler();
+  explicit ProcessMetricsSampler(const Options& options);
+  ProcessMetricsSampler(const ProcessMetricsSampler&) = delete;
+  ProcessMetricsSampler& operator=(const ProcessMetricsSampler&) = delete;
+  ~ProcessMetricsSampler();
+
+  // Replaces the contents of |samples| with the samples of |pids|, in their
+  // order, skipping the processes which exited. Closes the files of the
+  // processes sampled before which are not in |pids|. Reusing |samples|
+  // spares allocating it.
+  void SampleProcesses(span<const ProcessId> pids,
+                       std::vector<Sample>* samples);
+
+ private:
+  // The open files of a process.
+  struct ProcessFiles {
+    ProcessFiles();
+    ProcessFiles(ProcessFiles&&);
+    ProcessFiles& operator=(ProcessFiles&&);
+    ~ProcessFiles();
+
+    ScopedFD stat;
+    ScopedFD status;
+
+    // The last SampleProcesses() which sampled the process.
+    uint64_t generation = 0;
+  };
+
+  // Reads /proc/<pid>/|name| from |file|, opening it if it isn't open and
+  // there is room for it to stay. Returns the contents, or an empty
+  // StringPiece on failure.
+  StringPiece ReadProcessFile(ProcessId pid,
+                              const char* name,
+                              ScopedFD* file);
+
+  bool SampleProcess(ProcessId pid, ProcessFiles* files, Sample* sample);
+
+  const bool vm_swap_;
+  const size_t max_open_files_;
+  size_t open_files_ = 0;
+
+  flat_map<ProcessId, ProcessFiles> files_;
+  uint64_t generation_ = 0;
+
+  const size_t page_size_;
+  const std::unique_ptr<char[]> buffer_;
+};
+#endif  // BUILDFLAG(IS_LINUX) || BUILDFLAG(IS_CHROMEOS) ||
+        // BUILDFLAG(IS_ANDROID)
+
 // Returns the memory committed by the system in KBytes.
 // Returns 0 if it can't compute the commit charge.
 BASE_EXPORT size_t GetSystemCommitCharge();
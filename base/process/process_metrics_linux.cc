@@ -14,6 +14,7 @@
 #include <sys/types.h>
 #include <unistd.h>
 
+#include <memory>
 #include <utility>
 
 #include "base/cpu.h"
@@ -22,6 +23,7 @@
 #include "base/logging.h"
 #include "base/memory/ptr_util.h"
 #include "base/notreached.h"
+#include "base/posix/eintr_wrapper.h"
 #include "base/process/internal_linux.h"
 #include "base/process/process_metrics_iocounters.h"
 #include "base/strings/string_number_conversions.h"
@@ -40,13 +42,6 @@ namespace base {
 
 namespace {
 
-void TrimKeyValuePairs(StringPairs* pairs) {
-  for (auto& pair : *pairs) {
-    TrimWhitespaceASCII(pair.first, TRIM_ALL, &pair.first);
-    TrimWhitespaceASCII(pair.second, TRIM_ALL, &pair.second);
-  }
-}
-
 #if BUILDFLAG(IS_CHROMEOS_ASH) || BUILDFLAG(IS_CHROMEOS_LACROS)
 // Read a file with a single number string and return the number as a uint64_t.
 uint64_t ReadFileToUint64(const FilePath& file) {
@@ -61,50 +56,40 @@ uint64_t ReadFileToUint64(const FilePath& file) {
 }
 #endif
 
-// Read |filename| in /proc/<pid>/, split the entries into key/value pairs, and
-// trim the key and value. On success, return true and write the trimmed
-// key/value pairs into |key_value_pairs|.
-bool ReadProcFileToTrimmedStringPairs(pid_t pid,
-                                      StringPiece filename,
-                                      StringPairs* key_value_pairs) {
-  std::string status_data;
-  FilePath status_file = internal::GetProcPidDir(pid).Append(filename);
-  if (!internal::ReadProcFile(status_file, &status_data))
-    return false;
-  SplitStringIntoKeyValuePairs(status_data, ':', '\n', key_value_pairs);
-  TrimKeyValuePairs(key_value_pairs);
-  return true;
+// Reads |filename| in /proc/<pid>/ into |buffer|, and returns its contents,
+// or an empty StringPiece on failure.
+StringPiece ReadSmallProcPidFile(pid_t pid,
+                                 const char* filename,
+                                 span<char> buffer) {
+  char path[64];
+  snprintf(path, sizeof(path), "%s/%d/%s", internal::kProcDir, pid, filename);
+  return internal::ReadSmallProcFile(path, buffer);
 }
 
 // Read /proc/<pid>/status and return the value for |field|, or 0 on failure.
 // Only works for fields in the form of "Field: value kB".
 size_t ReadProcStatusAndGetFieldAsSizeT(pid_t pid, StringPiece field) {
-  StringPairs pairs;
-  if (!ReadProcFileToTrimmedStringPairs(pid, "status", &pairs))
+  char buffer[internal::kSmallProcFileBufferSize];
+  StringPiece value_str;
+  if (!internal::FindProcFileField(
+          ReadSmallProcPidFile(pid, "status", buffer), field, &value_str)) {
+    // This can be reached if the process dies when proc is read -- in that
+    // case, the kernel can return missing fields.
     return 0;
+  }
 
-  for (const auto& pair : pairs) {
-    const std::string& key = pair.first;
-    const std::string& value_str = pair.second;
-    if (key != field)
-      continue;
-
-    std::vector<StringPiece> split_value_str =
-        SplitStringPiece(value_str, " ", TRIM_WHITESPACE, SPLIT_WANT_ALL);
-    if (split_value_str.size() != 2 || split_value_str[1] != "kB") {
-      NOTREACHED();
-      return 0;
-    }
-    size_t value;
-    if (!StringToSizeT(split_value_str[0], &value)) {
-      NOTREACHED();
-      return 0;
-    }
-    return value;
+  std::vector<StringPiece> split_value_str =
+      SplitStringPiece(value_str, " ", TRIM_WHITESPACE, SPLIT_WANT_ALL);
+  if (split_value_str.size() != 2 || split_value_str[1] != "kB") {
+    NOTREACHED();
+    return 0;
   }
-  // This can be reached if the process dies when proc is read -- in that case,
-  // the kernel can return missing fields.
-  return 0;
+  size_t value;
+  if (!StringToSizeT(split_value_str[0], &value)) {
+    NOTREACHED();
+    return 0;
+  }
+  return value;
 }
 
 #if BUILDFLAG(IS_LINUX) || BUILDFLAG(IS_CHROMEOS) || BUILDFLAG(IS_AIX)
@@ -114,29 +99,22 @@ size_t ReadProcStatusAndGetFieldAsSizeT(pid_t pid, StringPiece field) {
 bool ReadProcStatusAndGetFieldAsUint64(pid_t pid,
                                        StringPiece field,
                                        uint64_t* result) {
-  StringPairs pairs;
-  if (!ReadProcFileToTrimmedStringPairs(pid, "status", &pairs))
+  char buffer[internal::kSmallProcFileBufferSize];
+  StringPiece value_str;
+  uint64_t value;
+  if (!internal::FindProcFileField(ReadSmallProcPidFile(pid, "status", buffer),
+                                   field, &value_str) ||
+      !StringToUint64(value_str, &value)) {
     return false;
-
-  for (const auto& pair : pairs) {
-    const std::string& key = pair.first;
-    const std::string& value_str = pair.second;
-    if (key != field)
-      continue;
-
-    uint64_t value;
-    if (!StringToUint64(value_str, &value))
-      return false;
-    *result = value;
-    return true;
   }
-  return false;
+  *result = value;
+  return true;
 }
 #endif  // BUILDFLAG(IS_LINUX) || BUILDFLAG(IS_CHROMEOS) || BUILDFLAG(IS_AIX)
 
 // Get the total CPU from a proc stat buffer.  Return value is number of jiffies
 // on success or 0 if parsing failed.
-int64_t ParseTotalCPUTimeFromStats(const std::vector<std::string>& proc_stats) {
+int64_t ParseTotalCPUTimeFromStats(const internal::ProcStatsView& proc_stats) {
   return internal::GetProcStatsFieldAsInt64(proc_stats, internal::VM_UTIME) +
          internal::GetProcStatsFieldAsInt64(proc_stats, internal::VM_STIME);
 }
@@ -144,10 +122,11 @@ int64_t ParseTotalCPUTimeFromStats(const std::vector<std::string>& proc_stats) {
 // Get the total CPU of a single process.  Return value is number of jiffies
 // on success or -1 on error.
 int64_t GetProcessCPU(pid_t pid) {
-  std::string buffer;
-  std::vector<std::string> proc_stats;
-  if (!internal::ReadProcStats(pid, &buffer) ||
-      !internal::ParseProcStats(buffer, &proc_stats)) {
+  char buffer[internal::kSmallProcFileBufferSize];
+  internal::ProcStatsView proc_stats;
+  if (!internal::ParseProcStats(
+          ReadSmallProcPidFile(pid, internal::kStatFile, buffer),
+          &proc_stats)) {
     return -1;
   }
 
@@ -190,10 +169,12 @@ bool ProcessMetrics::GetCumulativeCPUUsagePerThread(
       [&cpu_per_thread](PlatformThreadId tid, const FilePath& task_path) {
         FilePath thread_stat_path = task_path.Append("stat");
 
-        std::string buffer;
-        std::vector<std::string> proc_stats;
-        if (!internal::ReadProcFile(thread_stat_path, &buffer) ||
-            !internal::ParseProcStats(buffer, &proc_stats)) {
+        char buffer[internal::kSmallProcFileBufferSize];
+        internal::ProcStatsView proc_stats;
+        if (!internal::ParseProcStats(
+                internal::ReadSmallProcFile(thread_stat_path.value().c_str(),
+                                            buffer),
+                &proc_stats)) {
           return;
         }
 
@@ -236,28 +217,25 @@ bool ProcessMetrics::GetPerThreadCumulativeCPUTimeInState(
 // For the /proc/self/io file to exist, the Linux kernel must have
 // CONFIG_TASK_IO_ACCOUNTING enabled.
 bool ProcessMetrics::GetIOCounters(IoCounters* io_counters) const {
-  StringPairs pairs;
-  if (!ReadProcFileToTrimmedStringPairs(process_, "io", &pairs))
+  char buffer[internal::kSmallProcFileBufferSize];
+  const StringPiece io_data = ReadSmallProcPidFile(process_, "io", buffer);
+  if (io_data.empty())
     return false;
 
   io_counters->OtherOperationCount = 0;
   io_counters->OtherTransferCount = 0;
 
-  for (const auto& pair : pairs) {
-    const std::string& key = pair.first;
-    const std::string& value_str = pair.second;
-    uint64_t* target_counter = nullptr;
-    if (key == "syscr")
-      target_counter = &io_counters->ReadOperationCount;
-    else if (key == "syscw")
-      target_counter = &io_counters->WriteOperationCount;
-    else if (key == "rchar")
-      target_counter = &io_counters->ReadTransferCount;
-    else if (key == "wchar")
-      target_counter = &io_counters->WriteTransferCount;
-    if (!target_counter)
+  const std::pair<const char*, uint64_t*> counters[] = {
+      {"syscr", &io_counters->ReadOperationCount},
+      {"syscw", &io_counters->WriteOperationCount},
+      {"rchar", &io_counters->ReadTransferCount},
+      {"wchar", &io_counters->WriteTransferCount},
+  };
+  for (const auto& counter : counters) {
+    StringPiece value_str;
+    if (!internal::FindProcFileField(io_data, counter.first, &value_str))
       continue;
-    bool converted = StringToUint64(value_str, target_counter);
+    bool converted = StringToUint64(value_str, counter.second);
     DCHECK(converted);
   }
   return true;
@@ -271,12 +249,13 @@ uint64_t ProcessMetrics::GetVmSwapBytes() const {
 bool ProcessMetrics::GetPageFaultCounts(PageFaultCounts* counts) const {
   // We are not using internal::ReadStatsFileAndGetFieldAsInt64(), since it
   // would read the file twice, and return inconsistent numbers.
-  std::string stats_data;
-  if (!internal::ReadProcStats(process_, &stats_data))
-    return false;
-  std::vector<std::string> proc_stats;
-  if (!internal::ParseProcStats(stats_data, &proc_stats))
+  char buffer[internal::kSmallProcFileBufferSize];
+  internal::ProcStatsView proc_stats;
+  if (!internal::ParseProcStats(
+          ReadSmallProcPidFile(process_, internal::kStatFile, buffer),
+          &proc_stats)) {
     return false;
+  }
 
   counts->minor =
       internal::GetProcStatsFieldAsInt64(proc_stats, internal::VM_MINFLT);
@@ -381,6 +360,114 @@ int GetNumberOfThreads(ProcessHandle process) {
                                                    internal::VM_NUMTHREADS);
 }
 
+ProcessMetricsSampler::ProcessFiles::ProcessFiles() = default;
+ProcessMetricsSampler::ProcessFiles::ProcessFiles(ProcessFiles&&) = default;
+ProcessMetricsSampler::ProcessFiles&
+ProcessMetricsSampler::ProcessFiles::operator=(ProcessFiles&&) = default;
+ProcessMetricsSampler::ProcessFiles::~ProcessFiles() = default;
+
+ProcessMetricsSampler::ProcessMetricsSampler()
+    : ProcessMetricsSampler(Options()) {}
+
+ProcessMetricsSampler::ProcessMetricsSampler(const Options& options)
+    : vm_swap_(options.vm_swap),
+      max_open_files_(options.max_open_files ? options.max_open_files
+                                             : GetMaxFds() / 4),
+      page_size_(static_cast<size_t>(getpagesize())),
+      buffer_(std::make_unique<char[]>(internal::kSmallProcFileBufferSize)) {}
+
+ProcessMetricsSampler::~ProcessMetricsSampler() = default;
+
+void ProcessMetricsSampler::SampleProcesses(span<const ProcessId> pids,
+                                            std::vector<Sample>* samples) {
+  ++generation_;
+  samples->clear();
+  for (ProcessId pid : pids) {
+    ProcessFiles& files = files_[pid];
+    files.generation = generation_;
+    Sample sample;
+    if (SampleProcess(pid, &files, &sample))
+      samples->push_back(sample);
+  }
+
+  EraseIf(files_, [this](const std::pair<ProcessId, ProcessFiles>& entry) {
+    const ProcessFiles& files = entry.second;
+    if (files.generation == generation_)
+      return false;
+    open_files_ -= files.stat.is_valid() + files.status.is_valid();
+    return true;
+  });
+}
+
+StringPiece ProcessMetricsSampler::ReadProcessFile(ProcessId pid,
+                                                   const char* name,
+                                                   ScopedFD* file) {
+  const span<char> buffer(buffer_.get(), internal::kSmallProcFileBufferSize);
+  if (file->is_valid()) {
+    const StringPiece contents = internal::ReadSmallProcFile(file->get(),
+                                                             buffer);
+    if (!contents.empty())
+      return contents;
+    // The process exited, and its pid may have been reused since.
+    file->reset();
+    --open_files_;
+  }
+
+  char path[64];
+  snprintf(path, sizeof(path), "%s/%d/%s", internal::kProcDir, pid, name);
+  if (open_files_ >= max_open_files_)
+    return internal::ReadSmallProcFile(path, buffer);
+
+  file->reset(HANDLE_EINTR(open(path, O_RDONLY | O_CLOEXEC)));
+  if (!file->is_valid())
+    return StringPiece();
+  ++open_files_;
+  return internal::ReadSmallProcFile(file->get(), buffer);
+}
+
+bool ProcessMetricsSampler::SampleProcess(ProcessId pid,
+                                          ProcessFiles* files,
+                                          Sample* sample) {
+  internal::ProcStatsView proc_stats;
+  if (!internal::ParseProcStats(
+          ReadProcessFile(pid, internal::kStatFile, &files->stat),
+          &proc_stats) ||
+      proc_stats.size <= internal::VM_RSS) {
+    return false;
+  }
+
+  sample->pid = pid;
+  sample->cumulative_cpu_usage =
+      internal::ClockTicksToTimeDelta(ParseTotalCPUTimeFromStats(proc_stats));
+  sample->resident_set_size =
+      internal::GetProcStatsFieldAsSizeT(proc_stats, internal::VM_RSS) *
+      page_size_;
+  sample->virtual_size =
+      internal::GetProcStatsFieldAsSizeT(proc_stats, internal::VM_VSIZE);
+  sample->num_threads = static_cast<int>(
+      internal::GetProcStatsFieldAsInt64(proc_stats, internal::VM_NUMTHREADS));
+  sample->page_faults.minor =
+      internal::GetProcStatsFieldAsInt64(proc_stats, internal::VM_MINFLT);
+  sample->page_faults.major =
+      internal::GetProcStatsFieldAsInt64(proc_stats, internal::VM_MAJFLT);
+
+  if (vm_swap_) {
+    // This reuses the buffer which |proc_stats| point into.
+    const StringPiece status = ReadProcessFile(pid, "status", &files->status);
+    if (status.empty())
+      return false;
+    // Kernel threads have no VmSwap.
+    StringPiece vm_swap;
+    size_t vm_swap_kb = 0;
+    if (internal::FindProcFileField(status, "VmSwap", &vm_swap) &&
+        EndsWith(vm_swap, " kB") &&
+        StringToSizeT(vm_swap.substr(0, vm_swap.size() - 3), &vm_swap_kb)) {
+      sample->vm_swap_bytes = static_cast<uint64_t>(vm_swap_kb) * 1024;
+    }
+  }
+  return true;
+}
+
 bool ProcessMetrics::ParseProcTimeInState(
     const std::string& content,
     PlatformThreadId tid,
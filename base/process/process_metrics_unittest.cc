@@ -886,6 +886,61 @@ TEST(ProcessMetricsTestLinux, GetPerThreadCumulativeCPUTimeInState) {
   }
 }
 
+TEST(ProcessMetricsTestLinux, ProcessMetricsSampler) {
+  // A pid above the largest possible one, 2^22.
+  const ProcessId kExitedPid = 1 << 23;
+  const ProcessId pids[] = {GetCurrentProcId(), kExitedPid};
+
+  ProcessMetricsSampler sampler;
+  std::vector<ProcessMetricsSampler::Sample> samples;
+  sampler.SampleProcesses(pids, &samples);
+  ASSERT_EQ(samples.size(), 1u);
+  const ProcessMetricsSampler::Sample sample = samples[0];
+  EXPECT_EQ(sample.pid, GetCurrentProcId());
+  EXPECT_GE(sample.num_threads, 1);
+  EXPECT_GT(sample.resident_set_size, 0u);
+  EXPECT_GE(sample.virtual_size, sample.resident_set_size);
+  EXPECT_GT(sample.page_faults.minor, 0);
+
+  // Touching memory raises the page fault count read from the files kept
+  // open.
+  {
+    const size_t kMappedSize = 4 << 20;  // 4 MiB.
+
+    WritableSharedMemoryRegion region =
+        WritableSharedMemoryRegion::Create(kMappedSize);
+    ASSERT_TRUE(region.IsValid());
+
+    WritableSharedMemoryMapping mapping = region.Map();
+    ASSERT_TRUE(mapping.IsValid());
+
+    memset(mapping.memory(), 42, kMappedSize);
+  }
+
+  sampler.SampleProcesses(pids, &samples);
+  ASSERT_EQ(samples.size(), 1u);
+  EXPECT_GT(samples[0].page_faults.minor, sample.page_faults.minor);
+  EXPECT_GE(samples[0].cumulative_cpu_usage, sample.cumulative_cpu_usage);
+}
+
+TEST(ProcessMetricsTestLinux, ProcessMetricsSamplerFilesNotKeptOpen) {
+  ProcessMetricsSampler::Options options;
+  options.vm_swap = true;
+  options.max_open_files = 1;
+  ProcessMetricsSampler sampler(options);
+
+  // Only the stat file of the first process stays open.
+  const ProcessId pids[] = {GetCurrentProcId(), getppid()};
+  std::vector<ProcessMetricsSampler::Sample> samples;
+  for (int i = 0; i < 2; ++i) {
+    sampler.SampleProcesses(pids, &samples);
+    ASSERT_EQ(samples.size(), 2u);
+    EXPECT_EQ(samples[0].pid, GetCurrentProcId());
+    EXPECT_EQ(samples[1].pid, getppid());
+    EXPECT_GE(samples[1].num_threads, 1);
+  }
+}
+
 #endif  // BUILDFLAG(IS_ANDROID) || BUILDFLAG(IS_LINUX) ||
         // BUILDFLAG(IS_CHROMEOS)
 
@@ -10,12 +10,14 @@
 #include <sys/resource.h>
 #include <sys/wait.h>
 
+#include <algorithm>
 #include <utility>
 
 #include "base/clang_profiling_buildflags.h"
 #include "base/debug/activity_tracker.h"
 #include "base/files/scoped_file.h"
 #include "base/logging.h"
+#include "base/numerics/safe_conversions.h"
 #include "base/posix/eintr_wrapper.h"
 #include "base/process/kill.h"
 #include "base/threading/thread_restrictions.h"
@@ -23,6 +25,12 @@
 #include "build/build_config.h"
 #include "third_party/abseil-cpp/absl/types/optional.h"
 
+#if BUILDFLAG(IS_LINUX) || BUILDFLAG(IS_CHROMEOS)
+#include <poll.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#endif
+
 #if BUILDFLAG(IS_MAC)
 #include <sys/event.h>
 #endif
@@ -33,6 +41,43 @@
 
 namespace {
 
+#if BUILDFLAG(IS_LINUX) || BUILDFLAG(IS_CHROMEOS)
+#if defined(__NR_pidfd_open)
+constexpr long kPidfdOpenSyscall = __NR_pidfd_open;
+#else
+// pidfd_open() has the same number on all architectures.
+constexpr long kPidfdOpenSyscall = 434;
+#endif
+
+// Waits up to |wait| for the child |handle| to exit, on a pidfd of it, which
+// becomes readable once it did. Returns whether it exited, or nullopt if
+// pidfds aren't available, before Linux 5.3. The child isn't reaped.
+absl::optional<bool> WaitForChildOnPidfd(base::ProcessHandle handle,
+                                         base::TimeDelta wait) {
+  base::ScopedFD pidfd(
+      static_cast<int>(syscall(kPidfdOpenSyscall, handle, /*flags=*/0)));
+  if (!pidfd.is_valid())
+    return absl::nullopt;
+
+  const base::TimeTicks deadline = base::TimeTicks::Now() + wait;
+  while (true) {
+    // Rounds up, to wait no less than |wait|.
+    const base::TimeDelta remaining =
+        std::max(deadline - base::TimeTicks::Now(), base::TimeDelta());
+    struct pollfd pollfd = {pidfd.get(), POLLIN, 0};
+    const int result =
+        poll(&pollfd, 1,
+             base::saturated_cast<int>(remaining.InMillisecondsRoundedUp()));
+    if (result > 0)
+      return true;
+    if (result == 0 && base::TimeTicks::Now() >= deadline)
+      return false;
+    if (result < 0 && errno != EINTR)
+      return absl::nullopt;
+  }
+}
+#endif  // BUILDFLAG(IS_LINUX) || BUILDFLAG(IS_CHROMEOS)
+
 bool WaitpidWithTimeout(base::ProcessHandle handle,
                         int* status,
                         base::TimeDelta wait) {
@@ -59,12 +104,22 @@ bool WaitpidWithTimeout(base::ProcessHandle handle,
   //
   // This function is used primarily for unit tests, if we want to use it in
   // the application itself it would probably be best to examine other routes.
+  //
+  // On Linux 5.3+, the wait is on a pidfd of the process instead, which
+  // returns as soon as the process exits.
 
   if (wait == base::TimeDelta::Max()) {
     return HANDLE_EINTR(waitpid(handle, status, 0)) > 0;
   }
 
   pid_t ret_pid = HANDLE_EINTR(waitpid(handle, status, WNOHANG));
+#if BUILDFLAG(IS_LINUX) || BUILDFLAG(IS_CHROMEOS)
+  if (ret_pid == 0) {
+    absl::optional<bool> exited = WaitForChildOnPidfd(handle, wait);
+    if (exited.has_value())
+      return *exited && HANDLE_EINTR(waitpid(handle, status, WNOHANG)) > 0;
+  }
+#endif  // BUILDFLAG(IS_LINUX) || BUILDFLAG(IS_CHROMEOS)
   static const int64_t kMaxSleepInMicroseconds = 1 << 18;  // ~256 milliseconds.
   int64_t max_sleep_time_usecs = 1 << 10;                  // ~1 milliseconds.
   int64_t double_sleep_time = 0;
@@ -0,0 +1,259 @@
+// Copyright 2022 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "base/process/process_snapshotter_linux.h"
+
+#include <fcntl.h>
+#include <stdio.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <utility>
+
+#include "base/bind.h"
+#include "base/check_op.h"
+#include "base/files/dir_reader_posix.h"
+#include "base/memory/page_size.h"
+#include "base/posix/eintr_wrapper.h"
+#include "base/process/internal_linux.h"
+#include "base/process/process_metrics.h"
+#include "base/strings/string_piece.h"
+#include "base/task/parallel_for.h"
+#include "base/task/scoped_set_task_priority_for_current_thread.h"
+#include "base/task/thread_pool/thread_pool_instance.h"
+
+namespace base {
+
+namespace {
+
+#if defined(__NR_pidfd_open)
+constexpr long kPidfdOpenSyscall = __NR_pidfd_open;
+#else
+// pidfd_open() has the same number on all architectures.
+constexpr long kPidfdOpenSyscall = 434;
+#endif
+
+// Reading a stat file takes a few microseconds, so that smaller snapshots are
+// not worth a job.
+constexpr size_t kProcessesPerChunk = 128;
+
+}  // namespace
+
+ProcessSnapshotter::ProcessSnapshotter(Source source,
+                                       uint32_t fields,
+                                       size_t max_open_files)
+    : source_(source),
+      fields_(fields),
+      max_open_files_(max_open_files ? max_open_files : GetMaxFds() / 4) {
+  DCHECK_EQ(fields_ & ~kAllFields, 0u);
+}
+
+ProcessSnapshotter::~ProcessSnapshotter() = default;
+
+bool ProcessSnapshotter::Track(ProcessId pid) {
+  DCHECK_CALLED_ON_VALID_SEQUENCE(sequence_checker_);
+  DCHECK_EQ(source_, Source::kTrackedProcesses);
+
+  ScopedFD pidfd(
+      static_cast<int>(syscall(kPidfdOpenSyscall, pid, /*flags=*/0)));
+  if (!pidfd.is_valid())
+    return false;
+  if (entries_sorted_ && !entries_.empty() && entries_.back().pid >= pid)
+    entries_sorted_ = false;
+  entries_.push_back({pid, /*keep_open=*/false, ScopedFD(), std::move(pidfd)});
+  return true;
+}
+
+span<const ProcessSnapshotter::ProcessInfo> ProcessSnapshotter::Snapshot() {
+  DCHECK_CALLED_ON_VALID_SEQUENCE(sequence_checker_);
+
+  if (source_ == Source::kAllProcesses) {
+    ListProcesses();
+  } else {
+    if (!entries_sorted_) {
+      std::sort(entries_.begin(), entries_.end(),
+                [](const Entry& a, const Entry& b) { return a.pid < b.pid; });
+      // A process tracked twice is tracked once.
+      entries_.erase(std::unique(entries_.begin(), entries_.end(),
+                                 [](const Entry& a, const Entry& b) {
+                                   return a.pid == b.pid;
+                                 }),
+                     entries_.end());
+      entries_sorted_ = true;
+    }
+    RemoveExitedProcesses();
+  }
+
+  // The files of the processes which exited were closed, and the files of as
+  // many processes as fit under |max_open_files_| are kept open.
+  size_t num_open_files = static_cast<size_t>(
+      std::count_if(entries_.begin(), entries_.end(), [](const Entry& entry) {
+        return entry.stat_file.is_valid();
+      }));
+  for (Entry& entry : entries_) {
+    entry.keep_open =
+        entry.stat_file.is_valid() || num_open_files < max_open_files_;
+    if (!entry.stat_file.is_valid() && entry.keep_open)
+      ++num_open_files;
+  }
+
+  processes_.assign(entries_.size(), ProcessInfo());
+  if (fields_ && entries_.size() > kProcessesPerChunk &&
+      ThreadPoolInstance::Get()) {
+    // Each chunk writes its own entries and records.
+    ParallelFor(FROM_HERE, {internal::GetTaskPriorityForCurrentThread()}, 0,
+                entries_.size(), kProcessesPerChunk,
+                BindRepeating(&ProcessSnapshotter::ReadProcesses,
+                              Unretained(this)));
+  } else {
+    ReadProcesses(0, entries_.size());
+  }
+  processes_.erase(
+      std::remove_if(processes_.begin(), processes_.end(),
+                     [](const ProcessInfo& process) {
+                       return process.pid == kNullProcessId;
+                     }),
+      processes_.end());
+  return processes_;
+}
+
+void ProcessSnapshotter::ListProcesses() {
+  pids_.clear();
+  DirReaderPosix dir_reader(internal::kProcDir);
+  if (!dir_reader.IsValid()) {
+    entries_.clear();
+    return;
+  }
+  while (dir_reader.Next()) {
+    // Skips the entries which aren't processes, e.g. "self".
+    const pid_t pid = internal::ProcDirSlotToPid(dir_reader.name());
+    if (pid)
+      pids_.push_back(pid);
+  }
+  // /proc lists the processes by pid, so this rarely moves anything.
+  std::sort(pids_.begin(), pids_.end());
+
+  // Moves the files of the processes alive to |new_entries_|, which closes
+  // those of the processes which exited.
+  auto entry = entries_.begin();
+  for (ProcessId pid : pids_) {
+    while (entry != entries_.end() && entry->pid < pid)
+      ++entry;
+    ScopedFD stat_file;
+    if (entry != entries_.end() && entry->pid == pid)
+      stat_file = std::move(entry->stat_file);
+    new_entries_.push_back(
+        {pid, /*keep_open=*/false, std::move(stat_file), ScopedFD()});
+  }
+  entries_.swap(new_entries_);
+  new_entries_.clear();
+}
+
+void ProcessSnapshotter::RemoveExitedProcesses() {
+  exited_processes_.clear();
+  if (entries_.empty())
+    return;
+
+  poll_fds_.resize(entries_.size());
+  for (size_t i = 0; i < entries_.size(); ++i)
+    poll_fds_[i] = {entries_[i].pidfd.get(), POLLIN, 0};
+  // A pidfd is readable once its process exited.
+  const int num_ready = HANDLE_EINTR(poll(poll_fds_.data(), poll_fds_.size(),
+                                          /*timeout=*/0));
+  if (num_ready <= 0)
+    return;
+
+  size_t kept = 0;
+  for (size_t i = 0; i < entries_.size(); ++i) {
+    if (poll_fds_[i].revents) {
+      exited_processes_.push_back(entries_[i].pid);
+      continue;
+    }
+    if (kept != i)
+      entries_[kept] = std::move(entries_[i]);
+    ++kept;
+  }
+  entries_.resize(kept);
+}
+
+void ProcessSnapshotter::ReadProcesses(size_t begin, size_t end) {
+  for (size_t i = begin; i < end; ++i) {
+    if (!ReadProcess(&entries_[i], &processes_[i]))
+      processes_[i].pid = kNullProcessId;
+  }
+}
+
+bool ProcessSnapshotter::ReadProcess(Entry* entry,
+                                     ProcessInfo* process) const {
+  process->pid = entry->pid;
+  // All the fields are read from the stat file.
+  if (!fields_)
+    return true;
+
+  // The stat file is about 300 bytes, and the name it includes at most 64.
+  char buffer[1024];
+  StringPiece contents;
+  if (entry->stat_file.is_valid()) {
+    contents = internal::ReadSmallProcFile(entry->stat_file.get(), buffer);
+    // The process exited, and another one may have taken its pid.
+    if (contents.empty())
+      entry->stat_file.reset();
+  }
+  if (contents.empty()) {
+    char path[32];
+    snprintf(path, sizeof(path), "/proc/%d/stat", entry->pid);
+    ScopedFD stat_file(HANDLE_EINTR(open(path, O_RDONLY | O_CLOEXEC)));
+    if (!stat_file.is_valid())
+      return false;
+    contents = internal::ReadSmallProcFile(stat_file.get(), buffer);
+    if (contents.empty())
+      return false;
+    if (entry->keep_open)
+      entry->stat_file = std::move(stat_file);
+  }
+
+  internal::ProcStatsView stats;
+  if (!internal::ParseProcStats(contents, &stats) ||
+      stats.size <= internal::VM_RSS) {
+    return false;
+  }
+  if (fields_ & kParentPid) {
+    process->parent_pid = static_cast<ProcessId>(
+        internal::GetProcStatsFieldAsInt64(stats, internal::VM_PPID));
+  }
+  if (fields_ & kProcessGroup) {
+    process->process_group = static_cast<ProcessId>(
+        internal::GetProcStatsFieldAsInt64(stats, internal::VM_PGRP));
+  }
+  if (fields_ & kState && !stats.fields[internal::VM_STATE].empty())
+    process->state = stats.fields[internal::VM_STATE][0];
+  if (fields_ & kName) {
+    const StringPiece name = stats.fields[internal::VM_COMM];
+    const size_t size = std::min(name.size(), sizeof(process->name) - 1);
+    std::copy_n(name.data(), size, process->name);
+    process->name[size] = '\0';
+  }
+  if (fields_ & kCpuTime) {
+    process->cpu_time = internal::ClockTicksToTimeDelta(
+        internal::GetProcStatsFieldAsInt64(stats, internal::VM_UTIME) +
+        internal::GetProcStatsFieldAsInt64(stats, internal::VM_STIME));
+  }
+  if (fields_ & kStartTime) {
+    process->start_time = internal::ClockTicksToTimeDelta(
+        internal::GetProcStatsFieldAsInt64(stats, internal::VM_STARTTIME));
+  }
+  if (fields_ & kNumThreads) {
+    process->num_threads = static_cast<int>(
+        internal::GetProcStatsFieldAsInt64(stats, internal::VM_NUMTHREADS));
+  }
+  if (fields_ & kResidentSize) {
+    process->resident_bytes =
+        internal::GetProcStatsFieldAsSizeT(stats, internal::VM_RSS) *
+        GetPageSize();
+  }
+  return true;
+}
+
+}  // namespace base
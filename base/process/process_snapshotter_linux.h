@@ -0,0 +1,162 @@
+// Copyright 2022 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#ifndef BASE_PROCESS_PROCESS_SNAPSHOTTER_LINUX_H_
+#define BASE_PROCESS_PROCESS_SNAPSHOTTER_LINUX_H_
+
+#include <poll.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#include <vector>
+
+#include "base/base_export.h"
+#include "base/containers/span.h"
+#include "base/files/scoped_file.h"
+#include "base/process/process_handle.h"
+#include "base/sequence_checker.h"
+#include "base/time/time.h"
+
+namespace base {
+
+// Takes snapshots of processes into a flat array of fixed-size records, e.g.
+// for a supervisor of thousands of children. Unlike ProcessIterator, which
+// reads the stat and cmdline files of each process into strings, and resolves
+// its executable, this reads only the stat file, only if the requested fields
+// need it, and keeps the files open across the snapshots, so that a process
+// costs a single pread() per snapshot. The records, the lists and the file
+// buffers are reused by the snapshots, and large snapshots are read in
+// parallel on the ThreadPool, if there is one.
+//
+// It either snapshots all the processes listed by /proc, or only the tracked
+// ones, whose exits are noticed through pidfds (Linux 5.3+) with a single
+// poll(), so that /proc is never listed.
+//
+// Example:
+//   ProcessSnapshotter snapshotter(
+//       ProcessSnapshotter::Source::kTrackedProcesses,
+//       ProcessSnapshotter::kCpuTime | ProcessSnapshotter::kResidentSize);
+//   snapshotter.Track(child.Pid());
+//   // Periodically:
+//   for (const ProcessSnapshotter::ProcessInfo& process :
+//        snapshotter.Snapshot()) {
+//     ...
+//   }
+//   for (ProcessId pid : snapshotter.exited_processes())
+//     ...
+class BASE_EXPORT ProcessSnapshotter {
+ public:
+  enum class Source {
+    // The processes listed by /proc.
+    kAllProcesses,
+    // The processes passed to Track(), until they exit.
+    kTrackedProcesses,
+  };
+
+  // The fields of ProcessInfo to read, besides the pid, which is always set.
+  enum Field : uint32_t {
+    kParentPid = 1 << 0,
+    kProcessGroup = 1 << 1,
+    kState = 1 << 2,
+    kName = 1 << 3,
+    kCpuTime = 1 << 4,
+    kStartTime = 1 << 5,
+    kNumThreads = 1 << 6,
+    kResidentSize = 1 << 7,
+  };
+  static constexpr uint32_t kAllFields = (1 << 8) - 1;
+
+  // The fields which aren't requested are left to their default values.
+  struct ProcessInfo {
+    ProcessId pid = kNullProcessId;
+    ProcessId parent_pid = kNullProcessId;
+    ProcessId process_group = kNullProcessId;
+    // One of the letters of man 5 proc, e.g. 'R' or 'S', or 'Z' for the
+    // zombies, which are included.
+    char state = '\0';
+    // The name of the executable, truncated by the kernel to 15 characters,
+    // null-terminated.
+    char name[16] = {};
+    int num_threads = 0;
+    // User and system time, cumulative since the process started.
+    TimeDelta cpu_time;
+    // Since boot.
+    TimeDelta start_time;
+    uint64_t resident_bytes = 0;
+  };
+
+  // Reads |fields| of the processes of |source|, keeping at most
+  // |max_open_files| files open, beyond which the stat files are opened for
+  // each snapshot. If 0, a quarter of GetMaxFds(). The pidfds of the tracked
+  // processes aren't counted.
+  explicit ProcessSnapshotter(Source source,
+                              uint32_t fields = kAllFields,
+                              size_t max_open_files = 0);
+  ProcessSnapshotter(const ProcessSnapshotter&) = delete;
+  ProcessSnapshotter& operator=(const ProcessSnapshotter&) = delete;
+  ~ProcessSnapshotter();
+
+  // Starts tracking |pid|, which must be a child of the current process, or
+  // otherwise not be reused while tracked. Returns false if it doesn't exist,
+  // or if the kernel doesn't support pidfds. Only for kTrackedProcesses.
+  bool Track(ProcessId pid);
+
+  // Returns the processes alive, sorted by pid. The span stays valid until the
+  // next Snapshot().
+  span<const ProcessInfo> Snapshot();
+
+  // For kTrackedProcesses, returns the processes that the last Snapshot()
+  // found exited, and stopped tracking, sorted by pid. The zombies are
+  // included, since their pidfd reports their exit.
+  span<const ProcessId> exited_processes() const { return exited_processes_; }
+
+  size_t num_tracked_processes() const { return entries_.size(); }
+
+ private:
+  struct Entry {
+    ProcessId pid;
+    bool keep_open;
+    ScopedFD stat_file;
+    // For kTrackedProcesses.
+    ScopedFD pidfd;
+  };
+
+  // Lists /proc into |pids_|, and moves the files of the processes still
+  // alive to the new |entries_|.
+  void ListProcesses();
+
+  // Moves the tracked processes that exited from |entries_| to
+  // |exited_processes_|.
+  void RemoveExitedProcesses();
+
+  // Reads the processes of |entries_| in [begin, end) into |processes_|,
+  // setting the pid of those which exited to kNullProcessId.
+  void ReadProcesses(size_t begin, size_t end);
+
+  // Reads the process of |entry| into |process|, opening its stat file if it
+  // isn't open or was the file of a process which exited.
+  bool ReadProcess(Entry* entry, ProcessInfo* process) const;
+
+  const Source source_;
+  const uint32_t fields_;
+  const size_t max_open_files_;
+
+  // Sorted by pid, but after Track().
+  std::vector<Entry> entries_;
+  bool entries_sorted_ = true;
+
+  // Only kept so that their memory is reused.
+  std::vector<Entry> new_entries_;
+  std::vector<ProcessId> pids_;
+  std::vector<pollfd> poll_fds_;
+
+  std::vector<ProcessInfo> processes_;
+  std::vector<ProcessId> exited_processes_;
+
+  SEQUENCE_CHECKER(sequence_checker_);
+};
+
+}  // namespace base
+
+#endif  // BASE_PROCESS_PROCESS_SNAPSHOTTER_LINUX_H_
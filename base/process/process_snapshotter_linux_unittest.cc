@@ -0,0 +1,138 @@
+// Copyright 2022 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "base/process/process_snapshotter_linux.h"
+
+#include <string.h>
+#include <unistd.h>
+
+#include <algorithm>
+
+#include "base/command_line.h"
+#include "base/process/launch.h"
+#include "base/process/process.h"
+#include "base/process/process_iterator.h"
+#include "testing/gtest/include/gtest/gtest.h"
+
+namespace base {
+
+namespace {
+
+using ProcessInfo = ProcessSnapshotter::ProcessInfo;
+
+const ProcessInfo* FindProcess(span<const ProcessInfo> processes,
+                               ProcessId pid) {
+  auto it = std::lower_bound(
+      processes.begin(), processes.end(), pid,
+      [](const ProcessInfo& process, ProcessId pid) {
+        return process.pid < pid;
+      });
+  return it != processes.end() && it->pid == pid ? &*it : nullptr;
+}
+
+Process LaunchSleep() {
+  CommandLine command_line(FilePath("sleep"));
+  command_line.AppendArg("100");
+  return LaunchProcess(command_line, LaunchOptions());
+}
+
+}  // namespace
+
+TEST(ProcessSnapshotterTest, AllProcesses) {
+  ProcessSnapshotter snapshotter(ProcessSnapshotter::Source::kAllProcesses);
+  span<const ProcessInfo> processes = snapshotter.Snapshot();
+  EXPECT_TRUE(std::is_sorted(
+      processes.begin(), processes.end(),
+      [](const auto& a, const auto& b) { return a.pid < b.pid; }));
+
+  const ProcessInfo* current = FindProcess(processes, GetCurrentProcId());
+  ASSERT_TRUE(current);
+  EXPECT_EQ(current->parent_pid, getppid());
+  EXPECT_EQ(current->process_group, getpgrp());
+  EXPECT_EQ(current->state, 'R');
+  EXPECT_GE(current->num_threads, 1);
+  EXPECT_GT(current->cpu_time, TimeDelta());
+  EXPECT_GT(current->start_time, TimeDelta());
+  EXPECT_GT(current->resident_bytes, 0u);
+  EXPECT_LT(strlen(current->name), sizeof(current->name));
+
+  // Matches ProcessIterator, but for the processes started or exited in
+  // between.
+  ProcessIterator::ProcessEntries entries = ProcessIterator(nullptr).Snapshot();
+  size_t num_matching_processes = 0;
+  for (const ProcessEntry& entry : entries) {
+    const ProcessInfo* process = FindProcess(processes, entry.pid());
+    if (!process)
+      continue;
+    EXPECT_EQ(process->parent_pid, entry.parent_pid());
+    ++num_matching_processes;
+  }
+  EXPECT_GT(num_matching_processes, 0u);
+}
+
+TEST(ProcessSnapshotterTest, OnlyRequestedFields) {
+  ProcessSnapshotter snapshotter(ProcessSnapshotter::Source::kAllProcesses,
+                                 ProcessSnapshotter::kParentPid);
+  const ProcessInfo* current =
+      FindProcess(snapshotter.Snapshot(), GetCurrentProcId());
+  ASSERT_TRUE(current);
+  EXPECT_EQ(current->parent_pid, getppid());
+  EXPECT_EQ(current->state, '\0');
+  EXPECT_EQ(current->cpu_time, TimeDelta());
+  EXPECT_EQ(current->resident_bytes, 0u);
+
+  // Without fields, the processes are only listed.
+  ProcessSnapshotter list_snapshotter(
+      ProcessSnapshotter::Source::kAllProcesses, /*fields=*/0);
+  current = FindProcess(list_snapshotter.Snapshot(), GetCurrentProcId());
+  ASSERT_TRUE(current);
+  EXPECT_EQ(current->parent_pid, kNullProcessId);
+}
+
+TEST(ProcessSnapshotterTest, FilesNotKeptOpen) {
+  // Only one of the files stays open, the others are opened each time.
+  ProcessSnapshotter snapshotter(ProcessSnapshotter::Source::kAllProcesses,
+                                 ProcessSnapshotter::kAllFields,
+                                 /*max_open_files=*/1);
+  for (int i = 0; i < 3; ++i)
+    EXPECT_TRUE(FindProcess(snapshotter.Snapshot(), GetCurrentProcId()));
+}
+
+TEST(ProcessSnapshotterTest, TrackedProcesses) {
+  ProcessSnapshotter snapshotter(
+      ProcessSnapshotter::Source::kTrackedProcesses);
+  Process child1 = LaunchSleep();
+  Process child2 = LaunchSleep();
+  ASSERT_TRUE(child1.IsValid());
+  ASSERT_TRUE(child2.IsValid());
+  if (!snapshotter.Track(child2.Pid()))
+    GTEST_SKIP() << "The kernel doesn't support pidfds.";
+  ASSERT_TRUE(snapshotter.Track(child1.Pid()));
+  ASSERT_TRUE(snapshotter.Track(child1.Pid()));
+
+  span<const ProcessInfo> processes = snapshotter.Snapshot();
+  ASSERT_EQ(processes.size(), 2u);
+  EXPECT_EQ(snapshotter.num_tracked_processes(), 2u);
+  for (const Process* child : {&child1, &child2}) {
+    const ProcessInfo* process = FindProcess(processes, child->Pid());
+    ASSERT_TRUE(process);
+    EXPECT_EQ(process->parent_pid, GetCurrentProcId());
+  }
+  EXPECT_TRUE(snapshotter.exited_processes().empty());
+
+  // The exit, including as a zombie, is noticed without reading /proc.
+  ASSERT_TRUE(child1.Terminate(0, /*wait=*/true));
+  processes = snapshotter.Snapshot();
+  ASSERT_EQ(processes.size(), 1u);
+  EXPECT_EQ(processes[0].pid, child2.Pid());
+  ASSERT_EQ(snapshotter.exited_processes().size(), 1u);
+  EXPECT_EQ(snapshotter.exited_processes()[0], child1.Pid());
+  EXPECT_EQ(snapshotter.num_tracked_processes(), 1u);
+
+  ASSERT_TRUE(child2.Terminate(0, /*wait=*/true));
+  EXPECT_TRUE(snapshotter.Snapshot().empty());
+  EXPECT_EQ(snapshotter.num_tracked_processes(), 0u);
+}
+
+}  // namespace base
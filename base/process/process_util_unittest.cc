@@ -18,6 +18,7 @@
 #include "base/files/file_path.h"
 #include "base/files/file_util.h"
 #include "base/files/scoped_file.h"
+#include "base/files/scoped_temp_dir.h"
 #include "base/logging.h"
 #include "base/path_service.h"
 #include "base/posix/eintr_wrapper.h"
@@ -79,7 +80,6 @@
 #include <zircon/process.h>
 #include <zircon/processargs.h>
 #include <zircon/syscalls.h>
-#include "base/files/scoped_temp_dir.h"
 #include "base/fuchsia/file_utils.h"
 #include "base/fuchsia/filtered_service_directory.h"
 #include "base/fuchsia/fuchsia_logging.h"
@@ -1496,6 +1496,50 @@ TEST_F(ProcessUtilTest, InvalidCurrentDirectory) {
   EXPECT_TRUE(process.WaitForExit(&exit_code));
   EXPECT_NE(kSuccess, exit_code);
 }
+
+// The executable is looked for in the PATH of the child, not of the parent.
+TEST_F(ProcessUtilTest, LaunchProcessSearchesChildPath) {
+  ScopedTempDir temp_dir;
+  ASSERT_TRUE(temp_dir.CreateUniqueTempDir());
+  const FilePath script = temp_dir.GetPath().Append("print_hello");
+  ASSERT_TRUE(WriteFile(script, "#!/bin/sh\nprintf hello\n"));
+  ASSERT_TRUE(SetPosixFilePermissions(script, FILE_PERMISSION_USER_MASK));
+  // Like execvp(), runs a script without a shebang with /bin/sh.
+  const FilePath shell_script = temp_dir.GetPath().Append("print_bye");
+  ASSERT_TRUE(WriteFile(shell_script, "printf bye\n"));
+  ASSERT_TRUE(
+      SetPosixFilePermissions(shell_script, FILE_PERMISSION_USER_MASK));
+
+  EnvironmentMap env_changes;
+  env_changes["PATH"] = "/nonexistent:" + temp_dir.GetPath().value();
+  EXPECT_EQ("hello", TestLaunchProcess(CommandLine(FilePath("print_hello")),
+                                       env_changes, /*clear_environment=*/false,
+                                       /*clone_flags=*/0));
+  EXPECT_EQ("bye", TestLaunchProcess(CommandLine(FilePath("print_bye")),
+                                     env_changes, /*clear_environment=*/false,
+                                     /*clone_flags=*/0));
+
+  std::string path;
+  EXPECT_TRUE(Environment::Create()->GetVar("PATH", &path));
+  EXPECT_NE(path, env_changes["PATH"]);
+}
+
+// The child doesn't close the descriptors which ScopedFDs own in the parent
+// before it execs, nor resets their ownership in the parent.
+TEST_F(ProcessUtilTest, LaunchProcessWithFDOwnershipEnforced) {
+  ScopedFD dev_null(open("/dev/null", O_RDONLY));
+  ASSERT_TRUE(dev_null.is_valid());
+
+  subtle::EnableFDOwnershipEnforcement(true);
+  Process process(SpawnChild("SimpleChildProcess"));
+  subtle::EnableFDOwnershipEnforcement(false);
+  ASSERT_TRUE(process.IsValid());
+
+  int exit_code = 42;
+  EXPECT_TRUE(process.WaitForExit(&exit_code));
+  EXPECT_EQ(kSuccess, exit_code);
+  EXPECT_TRUE(IsFDOwned(dev_null.get()));
+}
 #endif  // BUILDFLAG(IS_LINUX) || BUILDFLAG(IS_CHROMEOS)
 
 }  // namespace base
@@ -0,0 +1,212 @@
+// Copyright 2022 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "base/process/thread_sched_stats_linux.h"
+
+#include <fcntl.h>
+#include <stdio.h>
+
+#include <algorithm>
+#include <utility>
+
+#include "base/check_op.h"
+#include "base/files/dir_reader_posix.h"
+#include "base/files/file_path.h"
+#include "base/files/scoped_file.h"
+#include "base/metrics/histogram_functions.h"
+#include "base/posix/eintr_wrapper.h"
+#include "base/process/internal_linux.h"
+#include "base/process/process_metrics.h"
+#include "base/strings/strcat.h"
+#include "base/strings/string_number_conversions.h"
+#include "base/strings/string_piece.h"
+#include "base/threading/thread_id_name_manager.h"
+
+namespace base {
+
+namespace {
+
+// Parses "<cpu time ns> <run queue wait time ns> <timeslices>\n".
+bool ParseSchedStat(StringPiece contents,
+                    ThreadSchedStatsCollector::ThreadSchedStats* stats) {
+  uint64_t values[3];
+  for (uint64_t& value : values) {
+    const size_t end = contents.find_first_of(" \n");
+    if (!StringToUint64(contents.substr(0, end), &value))
+      return false;
+    contents.remove_prefix(end == StringPiece::npos ? contents.size()
+                                                    : end + 1);
+  }
+  stats->cpu_time = Nanoseconds(values[0]);
+  stats->run_queue_wait_time = Nanoseconds(values[1]);
+  stats->timeslices = values[2];
+  return true;
+}
+
+// Returns the name of a thread without the digits and separators it ends
+// with, which number the threads of a pool.
+StringPiece GetNamePrefix(StringPiece name) {
+  const size_t end = name.find_last_not_of("0123456789 #/_-");
+  return end == StringPiece::npos ? StringPiece() : name.substr(0, end + 1);
+}
+
+}  // namespace
+
+struct ThreadSchedStatsCollector::PrefixHistograms {
+  explicit PrefixHistograms(StringPiece prefix)
+      : wait_time(StrCat({"Scheduler.Thread.RunQueueWaitTime.", prefix})),
+        latency(StrCat({"Scheduler.Thread.RunQueueLatency.", prefix})) {}
+
+  HistogramHandle wait_time;
+  HistogramHandle latency;
+};
+
+ThreadSchedStatsCollector::ThreadSchedStatsCollector()
+    : ThreadSchedStatsCollector(GetCurrentProcessHandle()) {}
+
+ThreadSchedStatsCollector::ThreadSchedStatsCollector(ProcessHandle process,
+                                                     size_t max_open_files)
+    : process_(process),
+      task_dir_path_(internal::GetProcPidDir(process).Append("task").value()),
+      max_open_files_(max_open_files ? max_open_files : GetMaxFds() / 4) {}
+
+ThreadSchedStatsCollector::~ThreadSchedStatsCollector() = default;
+
+span<const ThreadSchedStatsCollector::ThreadSchedStats>
+ThreadSchedStatsCollector::Collect() {
+  DCHECK_CALLED_ON_VALID_SEQUENCE(sequence_checker_);
+
+  stats_.clear();
+  DirReaderPosix dir_reader(task_dir_path_.c_str());
+  if (!dir_reader.IsValid()) {
+    files_.clear();
+    return stats_;
+  }
+
+  tids_.clear();
+  while (dir_reader.Next()) {
+    // Skips "." and "..".
+    PlatformThreadId tid;
+    if (StringToInt(dir_reader.name(), &tid))
+      tids_.push_back(tid);
+  }
+  // The directory lists the threads by tid, so this rarely moves anything.
+  std::sort(tids_.begin(), tids_.end());
+
+  // Moves the files of the threads alive to |new_files_|, which closes those
+  // of the threads which exited.
+  auto file = files_.begin();
+  for (PlatformThreadId tid : tids_) {
+    while (file != files_.end() && file->tid < tid)
+      ++file;
+    ScopedFD thread_file;
+    if (file != files_.end() && file->tid == tid)
+      thread_file = std::move(file->file);
+
+    // A new thread keeps its file open if there is room for it along the
+    // files already open.
+    const bool keep_open =
+        thread_file.is_valid() ||
+        new_files_.size() + static_cast<size_t>(files_.end() - file) <
+            max_open_files_;
+    ThreadSchedStats thread;
+    thread.tid = tid;
+    if (ReadThread(dir_reader.fd(), keep_open, &thread, &thread_file))
+      stats_.push_back(thread);
+    if (thread_file.is_valid())
+      new_files_.push_back({tid, std::move(thread_file)});
+  }
+  files_.swap(new_files_);
+  new_files_.clear();
+  return stats_;
+}
+
+// static
+bool ThreadSchedStatsCollector::ReadThread(int dir_fd,
+                                           bool keep_open,
+                                           ThreadSchedStats* thread,
+                                           ScopedFD* file) {
+  char buffer[128];
+  if (file->is_valid()) {
+    if (ParseSchedStat(internal::ReadSmallProcFile(file->get(), buffer),
+                       thread)) {
+      return true;
+    }
+    // The thread exited, and another one may have taken its tid.
+    file->reset();
+  }
+
+  char path[32];
+  snprintf(path, sizeof(path), "%d/schedstat", thread->tid);
+  // The file is opened relative to the directory, which spares the kernel
+  // walking its path. This fails for a thread which exited.
+  ScopedFD opened_file(
+      HANDLE_EINTR(openat(dir_fd, path, O_RDONLY | O_CLOEXEC)));
+  if (!opened_file.is_valid() ||
+      !ParseSchedStat(internal::ReadSmallProcFile(opened_file.get(), buffer),
+                      thread)) {
+    return false;
+  }
+  if (keep_open)
+    *file = std::move(opened_file);
+  return true;
+}
+
+void ThreadSchedStatsCollector::RecordHistograms() {
+  DCHECK_CALLED_ON_VALID_SEQUENCE(sequence_checker_);
+  DCHECK_EQ(process_, GetCurrentProcessHandle());
+
+  Collect();
+  if (has_recorded_) {
+    ThreadIdNameManager* name_manager = ThreadIdNameManager::GetInstance();
+    auto previous = recorded_stats_.begin();
+    for (const ThreadSchedStats& thread : stats_) {
+      while (previous != recorded_stats_.end() && previous->tid < thread.tid)
+        ++previous;
+      if (previous == recorded_stats_.end())
+        break;
+      // Skips the threads started since, and those which took the tid of one
+      // which exited.
+      if (previous->tid != thread.tid ||
+          thread.timeslices <= previous->timeslices ||
+          thread.run_queue_wait_time < previous->run_queue_wait_time) {
+        continue;
+      }
+
+      const TimeDelta wait_time =
+          thread.run_queue_wait_time - previous->run_queue_wait_time;
+      PrefixHistograms* histograms =
+          GetHistograms(name_manager->GetName(thread.tid));
+      UmaHistogramMicrosecondsTimes(histograms->wait_time, wait_time);
+      UmaHistogramMicrosecondsTimes(
+          histograms->latency,
+          wait_time / static_cast<int64_t>(thread.timeslices -
+                                           previous->timeslices));
+    }
+  }
+
+  recorded_stats_.assign(stats_.begin(), stats_.end());
+  has_recorded_ = true;
+}
+
+ThreadSchedStatsCollector::PrefixHistograms*
+ThreadSchedStatsCollector::GetHistograms(const char* name) {
+  PrefixHistograms*& histograms = histograms_by_name_[name];
+  if (!histograms) {
+    StringPiece prefix = GetNamePrefix(name);
+    if (prefix.empty())
+      prefix = "Unnamed";
+    auto it = histograms_by_prefix_.find(prefix);
+    if (it == histograms_by_prefix_.end()) {
+      it = histograms_by_prefix_
+               .emplace(std::string(prefix),
+                        std::make_unique<PrefixHistograms>(prefix))
+               .first;
+    }
+    histograms = it->second.get();
+  }
+  return histograms;
+}
+
+}  // namespace base
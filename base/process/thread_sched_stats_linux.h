@@ -0,0 +1,135 @@
+// Copyright 2022 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#ifndef BASE_PROCESS_THREAD_SCHED_STATS_LINUX_H_
+#define BASE_PROCESS_THREAD_SCHED_STATS_LINUX_H_
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include <map>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "base/base_export.h"
+#include "base/containers/flat_map.h"
+#include "base/containers/span.h"
+#include "base/files/scoped_file.h"
+#include "base/process/process_handle.h"
+#include "base/sequence_checker.h"
+#include "base/threading/platform_thread.h"
+#include "base/time/time.h"
+
+namespace base {
+
+class HistogramHandle;
+
+// Collects the scheduler statistics of the threads of a process from
+// /proc/<pid>/task/<tid>/schedstat: the time each thread ran on a CPU, the
+// time it waited on a run queue while runnable, and how many times it was
+// scheduled. Unlike ProcessMetrics::GetCumulativeCPUUsagePerThread(), which
+// opens and parses the whole stat file of each thread, this keeps the files
+// open across the collections, and reads three numbers per thread into an
+// array which the collections reuse.
+//
+// The run queue wait time is the delay the scheduler adds to the work of the
+// threads, which ProcessMetrics doesn't report: a thread which waits long for
+// a CPU when it has work is starved, however little CPU time it uses.
+//
+// The statistics need a kernel with CONFIG_SCHED_INFO, which most
+// distributions and Android enable. Without it, Collect() returns nothing.
+//
+// Example:
+//   ThreadSchedStatsCollector collector;
+//   // Periodically:
+//   collector.RecordHistograms();
+class BASE_EXPORT ThreadSchedStatsCollector {
+ public:
+  struct ThreadSchedStats {
+    PlatformThreadId tid = kInvalidThreadId;
+    // Cumulative since the thread started.
+    TimeDelta cpu_time;
+    TimeDelta run_queue_wait_time;
+    uint64_t timeslices = 0;
+  };
+
+  // Collects the threads of the current process.
+  ThreadSchedStatsCollector();
+  // Collects the threads of |process|, keeping at most |max_open_files| files
+  // open, beyond which the files of the threads are opened for each
+  // collection. If 0, a quarter of GetMaxFds().
+  explicit ThreadSchedStatsCollector(ProcessHandle process,
+                                     size_t max_open_files = 0);
+  ThreadSchedStatsCollector(const ThreadSchedStatsCollector&) = delete;
+  ThreadSchedStatsCollector& operator=(const ThreadSchedStatsCollector&) =
+      delete;
+  ~ThreadSchedStatsCollector();
+
+  // Returns the statistics of the threads alive, sorted by tid, or nothing if
+  // the process exited or the kernel doesn't keep them. The span stays valid
+  // until the next Collect() or RecordHistograms().
+  span<const ThreadSchedStats> Collect();
+
+  // Collects, and records for each thread scheduled since the previous call
+  // into the histograms of the prefix of its name, i.e. the name without the
+  // digits it ends with, e.g. "ThreadPoolForegroundWorker":
+  //
+  //   Scheduler.Thread.RunQueueWaitTime.<prefix>  The time the thread waited
+  //                                               since the previous call.
+  //   Scheduler.Thread.RunQueueLatency.<prefix>   The mean wait per time the
+  //                                               thread was scheduled.
+  //
+  // Both are from 1 us to 10 s. The names are those of ThreadIdNameManager,
+  // so this must be called on the collector of the current process; threads
+  // without a name record as "Unnamed". The first call records nothing.
+  void RecordHistograms();
+
+ private:
+  struct PrefixHistograms;
+
+  // The open schedstat file of a thread.
+  struct ThreadFile {
+    PlatformThreadId tid;
+    ScopedFD file;
+  };
+
+  // Reads the statistics of |thread| from |file|, opening it relative to the
+  // task directory |dir_fd| if it isn't open or was the file of a thread
+  // which exited. Keeps it open if |keep_open|.
+  static bool ReadThread(int dir_fd,
+                         bool keep_open,
+                         ThreadSchedStats* thread,
+                         ScopedFD* file);
+
+  // Returns the histograms of the thread named |name|, which is interned by
+  // ThreadIdNameManager, so that it is looked up by address.
+  PrefixHistograms* GetHistograms(const char* name);
+
+  const ProcessHandle process_;
+  const std::string task_dir_path_;
+  const size_t max_open_files_;
+
+  // The tids listed by the task directory, sorted.
+  std::vector<PlatformThreadId> tids_;
+  std::vector<ThreadSchedStats> stats_;
+
+  // Sorted by tid. |new_files_| is only kept so that its memory is reused.
+  std::vector<ThreadFile> files_;
+  std::vector<ThreadFile> new_files_;
+
+  // The statistics at the previous RecordHistograms().
+  std::vector<ThreadSchedStats> recorded_stats_;
+  bool has_recorded_ = false;
+
+  std::map<std::string, std::unique_ptr<PrefixHistograms>, std::less<>>
+      histograms_by_prefix_;
+  flat_map<const char*, PrefixHistograms*> histograms_by_name_;
+
+  SEQUENCE_CHECKER(sequence_checker_);
+};
+
+}  // namespace base
+
+#endif  // BASE_PROCESS_THREAD_SCHED_STATS_LINUX_H_
@@ -0,0 +1,124 @@
+// Copyright 2022 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "base/process/thread_sched_stats_linux.h"
+
+#include <algorithm>
+
+#include "base/synchronization/waitable_event.h"
+#include "base/test/bind.h"
+#include "base/test/metrics/histogram_tester.h"
+#include "base/threading/platform_thread.h"
+#include "base/threading/thread.h"
+#include "base/time/time.h"
+#include "testing/gtest/include/gtest/gtest.h"
+
+namespace base {
+
+namespace {
+
+bool HasSchedStats() {
+  ThreadSchedStatsCollector collector;
+  return !collector.Collect().empty();
+}
+
+void Spin(TimeDelta duration) {
+  const TimeTicks end = TimeTicks::Now() + duration;
+  while (TimeTicks::Now() < end) {
+  }
+}
+
+}  // namespace
+
+TEST(ThreadSchedStatsCollectorTest, Collect) {
+  if (!HasSchedStats())
+    GTEST_SKIP() << "The kernel doesn't keep scheduler statistics.";
+
+  Thread thread("ThreadSchedStatsTest");
+  ASSERT_TRUE(thread.Start());
+  const PlatformThreadId thread_id = thread.GetThreadId();
+
+  ThreadSchedStatsCollector collector;
+  span<const ThreadSchedStatsCollector::ThreadSchedStats> stats =
+      collector.Collect();
+  EXPECT_TRUE(std::is_sorted(
+      stats.begin(), stats.end(),
+      [](const auto& a, const auto& b) { return a.tid < b.tid; }));
+
+  auto find_thread = [&stats](PlatformThreadId tid) {
+    return std::find_if(stats.begin(), stats.end(),
+                        [tid](const auto& t) { return t.tid == tid; });
+  };
+  auto current = find_thread(PlatformThread::CurrentId());
+  ASSERT_NE(current, stats.end());
+  EXPECT_GT(current->cpu_time, TimeDelta());
+  EXPECT_GT(current->timeslices, 0u);
+  ASSERT_NE(find_thread(thread_id), stats.end());
+  const TimeDelta cpu_time = current->cpu_time;
+
+  Spin(Milliseconds(20));
+  stats = collector.Collect();
+  current = find_thread(PlatformThread::CurrentId());
+  ASSERT_NE(current, stats.end());
+  EXPECT_GT(current->cpu_time, cpu_time);
+
+  thread.Stop();
+  stats = collector.Collect();
+  EXPECT_EQ(find_thread(thread_id), stats.end());
+}
+
+TEST(ThreadSchedStatsCollectorTest, FilesNotKeptOpen) {
+  if (!HasSchedStats())
+    GTEST_SKIP() << "The kernel doesn't keep scheduler statistics.";
+
+  Thread thread1("ThreadSchedStatsTest1");
+  Thread thread2("ThreadSchedStatsTest2");
+  ASSERT_TRUE(thread1.Start());
+  ASSERT_TRUE(thread2.Start());
+
+  // Only one of the files stays open, the others are opened each time.
+  ThreadSchedStatsCollector collector(GetCurrentProcessHandle(),
+                                      /*max_open_files=*/1);
+  const size_t num_threads = collector.Collect().size();
+  EXPECT_GE(num_threads, 3u);
+  EXPECT_EQ(collector.Collect().size(), num_threads);
+
+  thread1.Stop();
+  EXPECT_EQ(collector.Collect().size(), num_threads - 1);
+}
+
+TEST(ThreadSchedStatsCollectorTest, RecordHistograms) {
+  if (!HasSchedStats())
+    GTEST_SKIP() << "The kernel doesn't keep scheduler statistics.";
+
+  constexpr char kWaitTime[] =
+      "Scheduler.Thread.RunQueueWaitTime.ThreadSchedStatsTestWorker";
+  constexpr char kLatency[] =
+      "Scheduler.Thread.RunQueueLatency.ThreadSchedStatsTestWorker";
+
+  HistogramTester histogram_tester;
+  Thread thread1("ThreadSchedStatsTestWorker1");
+  Thread thread2("ThreadSchedStatsTestWorker2");
+  ASSERT_TRUE(thread1.Start());
+  ASSERT_TRUE(thread2.Start());
+  thread1.WaitUntilThreadStarted();
+  thread2.WaitUntilThreadStarted();
+
+  ThreadSchedStatsCollector collector;
+  collector.RecordHistograms();
+  histogram_tester.ExpectTotalCount(kWaitTime, 0);
+
+  // Wakes up both threads, so that both are scheduled since.
+  for (Thread* thread : {&thread1, &thread2}) {
+    WaitableEvent done;
+    thread->task_runner()->PostTask(
+        FROM_HERE, BindLambdaForTesting([&done]() { done.Signal(); }));
+    done.Wait();
+  }
+  collector.RecordHistograms();
+  histogram_tester.ExpectTotalCount(kWaitTime, 2);
+  histogram_tester.ExpectTotalCount(kLatency, 2);
+}
+
+}  // namespace base
@@ -0,0 +1,69 @@
+// Copyright 2022 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "base/profiler/frame_pointer_unwinder.h"
+
+#include "base/check_op.h"
+#include "base/profiler/module_cache.h"
+
+namespace base {
+
+FramePointerUnwinder::FramePointerUnwinder() = default;
+
+bool FramePointerUnwinder::CanUnwindFrom(const Frame& current_frame) const {
+  return current_frame.module && current_frame.module->IsNative();
+}
+
+UnwindResult FramePointerUnwinder::TryUnwind(RegisterContext* thread_context,
+                                             uintptr_t stack_top,
+                                             std::vector<Frame>* stack) const {
+  // We expect the frame corresponding to the |thread_context| register state to
+  // exist within |stack|.
+  DCHECK_GT(stack->size(), 0u);
+
+  for (;;) {
+    const ModuleCache::Module* module = stack->back().module;
+    if (!module)
+      return UnwindResult::kAborted;
+    if (!module->IsNative())
+      return UnwindResult::kUnrecognizedFrame;
+
+    // The outermost frame of the thread has a null frame pointer.
+    if (RegisterContextFramePointer(thread_context) == 0)
+      return UnwindResult::kCompleted;
+    if (!StepFrame(thread_context, stack_top))
+      return UnwindResult::kAborted;
+
+    const uintptr_t return_address =
+        RegisterContextInstructionPointer(thread_context);
+    if (return_address == 0)
+      return UnwindResult::kCompleted;
+    stack->emplace_back(return_address,
+                        module_cache()->GetModuleForAddress(return_address));
+  }
+}
+
+// static
+bool FramePointerUnwinder::StepFrame(RegisterContext* thread_context,
+                                     uintptr_t stack_top) {
+  const uintptr_t stack_pointer = RegisterContextStackPointer(thread_context);
+  const uintptr_t frame_pointer = RegisterContextFramePointer(thread_context);
+  if (frame_pointer < stack_pointer || frame_pointer >= stack_top ||
+      stack_top - frame_pointer < 2 * sizeof(uintptr_t) ||
+      frame_pointer % sizeof(uintptr_t) != 0) {
+    return false;
+  }
+
+  const uintptr_t* const frame_record =
+      reinterpret_cast<const uintptr_t*>(frame_pointer);
+  RegisterContextFramePointer(thread_context) = frame_record[0];
+  RegisterContextInstructionPointer(thread_context) = frame_record[1];
+  // The caller's stack pointer is past the frame record, which ensures that
+  // the walk makes progress.
+  RegisterContextStackPointer(thread_context) =
+      frame_pointer + 2 * sizeof(uintptr_t);
+  return true;
+}
+
+}  // namespace base
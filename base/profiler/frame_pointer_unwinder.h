@@ -0,0 +1,43 @@
+// Copyright 2022 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#ifndef BASE_PROFILER_FRAME_POINTER_UNWINDER_H_
+#define BASE_PROFILER_FRAME_POINTER_UNWINDER_H_
+
+#include <stdint.h>
+
+#include <vector>
+
+#include "base/base_export.h"
+#include "base/profiler/unwinder.h"
+
+namespace base {
+
+// Native unwinder implementation which follows the chain of frame pointers, for
+// the POSIX platforms without unwind information. The native code of the stack
+// must keep the frame pointers, see CAN_UNWIND_WITH_FRAME_POINTERS: the walk
+// stops at the first frame which doesn't.
+class BASE_EXPORT FramePointerUnwinder : public Unwinder {
+ public:
+  FramePointerUnwinder();
+
+  FramePointerUnwinder(const FramePointerUnwinder&) = delete;
+  FramePointerUnwinder& operator=(const FramePointerUnwinder&) = delete;
+
+  // Unwinder:
+  bool CanUnwindFrom(const Frame& current_frame) const override;
+  UnwindResult TryUnwind(RegisterContext* thread_context,
+                         uintptr_t stack_top,
+                         std::vector<Frame>* stack) const override;
+
+  // Unwinds |thread_context| to the caller of its frame, from the frame record
+  // {frame pointer, return address} which the frame pointer points to. Returns
+  // false if the frame record isn't in [stack pointer, |stack_top|), in which
+  // case |thread_context| is unchanged.
+  static bool StepFrame(RegisterContext* thread_context, uintptr_t stack_top);
+};
+
+}  // namespace base
+
+#endif  // BASE_PROFILER_FRAME_POINTER_UNWINDER_H_
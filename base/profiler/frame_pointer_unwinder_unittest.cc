@@ -0,0 +1,136 @@
+// Copyright 2022 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "base/profiler/frame_pointer_unwinder.h"
+
+#include <memory>
+#include <vector>
+
+#include "base/profiler/module_cache.h"
+#include "base/profiler/stack_sampling_profiler_test_util.h"
+#include "testing/gtest/include/gtest/gtest.h"
+
+namespace base {
+
+namespace {
+
+constexpr uintptr_t kModuleStart = 0x1000;
+constexpr size_t kModuleSize = 0x1000;
+constexpr uintptr_t kNonNativeModuleStart = 0x2000;
+
+// A copied stack of |kSize| words, with the frame records of the frames in
+// |return_addresses|.
+class TestStack {
+ public:
+  static constexpr size_t kSize = 16;
+
+  explicit TestStack(const std::vector<uintptr_t>& return_addresses) {
+    // Each frame has a local variable, then its frame record.
+    uintptr_t* record = &words_[1];
+    for (uintptr_t return_address : return_addresses) {
+      uintptr_t* const next_record = record + 3;
+      record[0] = reinterpret_cast<uintptr_t>(next_record);
+      record[1] = return_address;
+      record = next_record;
+    }
+    // The outermost frame.
+    record[0] = 0;
+    record[1] = 0;
+  }
+
+  void InitializeContext(RegisterContext* context, uintptr_t leaf_address) {
+    RegisterContextStackPointer(context) = bottom();
+    RegisterContextFramePointer(context) =
+        reinterpret_cast<uintptr_t>(&words_[1]);
+    RegisterContextInstructionPointer(context) = leaf_address;
+  }
+
+  uintptr_t bottom() const { return reinterpret_cast<uintptr_t>(&words_[0]); }
+  uintptr_t top() const { return reinterpret_cast<uintptr_t>(&words_[kSize]); }
+
+ private:
+  uintptr_t words_[kSize] = {};
+};
+
+class FramePointerUnwinderTest : public testing::Test {
+ protected:
+  void SetUp() override {
+    module_cache_.AddCustomNativeModule(
+        std::make_unique<TestModule>(kModuleStart, kModuleSize));
+    std::vector<std::unique_ptr<const ModuleCache::Module>> modules;
+    modules.push_back(std::make_unique<TestModule>(kNonNativeModuleStart,
+                                                   kModuleSize, false));
+    module_cache_.UpdateNonNativeModules({}, std::move(modules));
+    unwinder_.Initialize(&module_cache_);
+  }
+
+  std::vector<Frame> CreateStack(uintptr_t leaf_address) {
+    std::vector<Frame> stack;
+    stack.emplace_back(leaf_address,
+                       module_cache_.GetModuleForAddress(leaf_address));
+    return stack;
+  }
+
+  ModuleCache module_cache_;
+  FramePointerUnwinder unwinder_;
+};
+
+}  // namespace
+
+TEST_F(FramePointerUnwinderTest, UnwindsToTheOutermostFrame) {
+  TestStack test_stack({0x1100, 0x1200});
+  RegisterContext context;
+  test_stack.InitializeContext(&context, 0x1010);
+  std::vector<Frame> stack = CreateStack(0x1010);
+
+  ASSERT_TRUE(unwinder_.CanUnwindFrom(stack.back()));
+  EXPECT_EQ(UnwindResult::kCompleted,
+            unwinder_.TryUnwind(&context, test_stack.top(), &stack));
+  ASSERT_EQ(3u, stack.size());
+  EXPECT_EQ(0x1100u, stack[1].instruction_pointer);
+  EXPECT_EQ(0x1200u, stack[2].instruction_pointer);
+  EXPECT_EQ(stack[0].module, stack[2].module);
+}
+
+TEST_F(FramePointerUnwinderTest, StopsAtANonNativeFrame) {
+  TestStack test_stack({0x1100, 0x2100});
+  RegisterContext context;
+  test_stack.InitializeContext(&context, 0x1010);
+  std::vector<Frame> stack = CreateStack(0x1010);
+
+  EXPECT_EQ(UnwindResult::kUnrecognizedFrame,
+            unwinder_.TryUnwind(&context, test_stack.top(), &stack));
+  ASSERT_EQ(3u, stack.size());
+  EXPECT_FALSE(unwinder_.CanUnwindFrom(stack.back()));
+
+  // The context is the one of the non-native frame, for its unwinder.
+  EXPECT_EQ(0x2100u, RegisterContextInstructionPointer(&context));
+  EXPECT_LT(RegisterContextStackPointer(&context), test_stack.top());
+}
+
+TEST_F(FramePointerUnwinderTest, AbortsOnAFrameOutOfTheStack) {
+  TestStack test_stack({0x1100});
+  RegisterContext context;
+  test_stack.InitializeContext(&context, 0x1010);
+  RegisterContextFramePointer(&context) = test_stack.top();
+  std::vector<Frame> stack = CreateStack(0x1010);
+
+  EXPECT_EQ(UnwindResult::kAborted,
+            unwinder_.TryUnwind(&context, test_stack.top(), &stack));
+  EXPECT_EQ(1u, stack.size());
+}
+
+TEST_F(FramePointerUnwinderTest, AbortsOnAnUnknownModule) {
+  TestStack test_stack({0x1100, 0x10, 0x1200});
+  RegisterContext context;
+  test_stack.InitializeContext(&context, 0x1010);
+  std::vector<Frame> stack = CreateStack(0x1010);
+
+  EXPECT_EQ(UnwindResult::kAborted,
+            unwinder_.TryUnwind(&context, test_stack.top(), &stack));
+  ASSERT_EQ(3u, stack.size());
+  EXPECT_EQ(nullptr, stack[2].module);
+}
+
+}  // namespace base
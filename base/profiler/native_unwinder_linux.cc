@@ -0,0 +1,677 @@
+// Copyright 2022 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "base/profiler/native_unwinder_linux.h"
+
+#include <elf.h>
+#include <string.h>
+
+#include <iterator>
+
+#include "base/check_op.h"
+#include "base/debug/elf_reader.h"
+#include "base/profiler/frame_pointer_unwinder.h"
+#include "base/profiler/module_cache.h"
+#include "build/build_config.h"
+
+#if !defined(ARCH_CPU_X86_64)
+#error "NativeUnwinderLinux only knows the registers of x86_64."
+#endif
+
+namespace base {
+
+namespace {
+
+// The DWARF register numbers of x86_64, from the System V ABI: the general
+// purpose registers, then the return address.
+constexpr uint32_t kDwarfRegisterCount = 17;
+constexpr uint32_t kDwarfReturnAddress = 16;
+
+// Maps the DWARF register numbers of the general purpose registers to their
+// index in mcontext_t::gregs.
+constexpr int kGregsIndex[] = {
+    REG_RAX, REG_RDX, REG_RCX, REG_RBX, REG_RSI, REG_RDI, REG_RBP, REG_RSP,
+    REG_R8,  REG_R9,  REG_R10, REG_R11, REG_R12, REG_R13, REG_R14, REG_R15,
+};
+static_assert(std::size(kGregsIndex) == kDwarfReturnAddress, "");
+
+// The pointer encodings of the .eh_frame sections (DW_EH_PE_*).
+constexpr uint8_t kEncodingOmit = 0xff;
+constexpr uint8_t kEncodingFormatMask = 0x0f;
+constexpr uint8_t kEncodingAbsptr = 0x00;
+constexpr uint8_t kEncodingUleb128 = 0x01;
+constexpr uint8_t kEncodingUdata2 = 0x02;
+constexpr uint8_t kEncodingUdata4 = 0x03;
+constexpr uint8_t kEncodingUdata8 = 0x04;
+constexpr uint8_t kEncodingSleb128 = 0x09;
+constexpr uint8_t kEncodingSdata2 = 0x0a;
+constexpr uint8_t kEncodingSdata4 = 0x0b;
+constexpr uint8_t kEncodingSdata8 = 0x0c;
+constexpr uint8_t kEncodingApplicationMask = 0x70;
+constexpr uint8_t kEncodingPcrel = 0x10;
+constexpr uint8_t kEncodingDatarel = 0x30;
+
+// The only encoding of the .eh_frame_hdr table which the linkers write.
+constexpr uint8_t kTableEncoding = kEncodingDatarel | kEncodingSdata4;
+
+// The nesting of DW_CFA_remember_state which is supported. The compilers only
+// nest it for the epilogues of nested blocks.
+constexpr size_t kMaxRememberedRows = 8;
+
+// Reads the little endian values of the .eh_frame sections. Reading past the
+// end fails the reader, and returns 0.
+class CfiReader {
+ public:
+  CfiReader(const uint8_t* position, const uint8_t* end)
+      : position_(position), end_(end) {}
+
+  bool ok() const { return ok_; }
+  bool at_end() const { return position_ >= end_; }
+  const uint8_t* position() const { return position_; }
+  const uint8_t* end() const { return end_; }
+
+  template <typename T>
+  T Read() {
+    T value = 0;
+    if (static_cast<size_t>(end_ - position_) < sizeof(T)) {
+      Fail();
+      return value;
+    }
+    memcpy(&value, position_, sizeof(T));
+    position_ += sizeof(T);
+    return value;
+  }
+
+  uint64_t ReadUleb128() {
+    uint64_t value = 0;
+    for (unsigned shift = 0; shift < 64 && ok_; shift += 7) {
+      const uint8_t byte = Read<uint8_t>();
+      value |= static_cast<uint64_t>(byte & 0x7f) << shift;
+      if (!(byte & 0x80))
+        return value;
+    }
+    Fail();
+    return 0;
+  }
+
+  int64_t ReadSleb128() {
+    uint64_t value = 0;
+    for (unsigned shift = 0; shift < 64 && ok_;) {
+      const uint8_t byte = Read<uint8_t>();
+      value |= static_cast<uint64_t>(byte & 0x7f) << shift;
+      shift += 7;
+      if (!(byte & 0x80)) {
+        if (shift < 64 && (byte & 0x40))
+          value |= ~uint64_t{0} << shift;
+        return static_cast<int64_t>(value);
+      }
+    }
+    Fail();
+    return 0;
+  }
+
+  // Reads a pointer of |encoding|, relative to |data_base| for the datarel
+  // encoding. The indirect pointers aren't dereferenced: only the personality
+  // routines use them.
+  uintptr_t ReadEncoded(uint8_t encoding, uintptr_t data_base) {
+    const uintptr_t field_address = reinterpret_cast<uintptr_t>(position_);
+    uintptr_t value;
+    switch (encoding & kEncodingFormatMask) {
+      case kEncodingAbsptr:
+        value = Read<uintptr_t>();
+        break;
+      case kEncodingUleb128:
+        value = static_cast<uintptr_t>(ReadUleb128());
+        break;
+      case kEncodingUdata2:
+        value = Read<uint16_t>();
+        break;
+      case kEncodingUdata4:
+        value = Read<uint32_t>();
+        break;
+      case kEncodingUdata8:
+        value = static_cast<uintptr_t>(Read<uint64_t>());
+        break;
+      case kEncodingSleb128:
+        value = static_cast<uintptr_t>(ReadSleb128());
+        break;
+      case kEncodingSdata2:
+        value = static_cast<uintptr_t>(Read<int16_t>());
+        break;
+      case kEncodingSdata4:
+        value = static_cast<uintptr_t>(Read<int32_t>());
+        break;
+      case kEncodingSdata8:
+        value = static_cast<uintptr_t>(Read<int64_t>());
+        break;
+      default:
+        Fail();
+        return 0;
+    }
+    switch (encoding & kEncodingApplicationMask) {
+      case 0:
+        return value;
+      case kEncodingPcrel:
+        return value + field_address;
+      case kEncodingDatarel:
+        return value + data_base;
+      default:
+        Fail();
+        return 0;
+    }
+  }
+
+  void Skip(uint64_t size) {
+    if (size > static_cast<uint64_t>(end_ - position_)) {
+      Fail();
+      return;
+    }
+    position_ += size;
+  }
+
+ private:
+  void Fail() {
+    ok_ = false;
+    position_ = end_;
+  }
+
+  const uint8_t* position_;
+  const uint8_t* end_;
+  bool ok_ = true;
+};
+
+// Returns a reader of the content of the CIE or FDE at |entry|, after its
+// length.
+CfiReader ReadEntry(const uint8_t* entry) {
+  uint32_t length;
+  memcpy(&length, entry, sizeof(length));
+  entry += sizeof(length);
+  uint64_t extended_length = length;
+  if (length == 0xffffffff) {
+    memcpy(&extended_length, entry, sizeof(extended_length));
+    entry += sizeof(extended_length);
+  }
+  return CfiReader(entry, entry + extended_length);
+}
+
+// The common information entry of the FDEs, see the DWARF standard 6.4.1.
+struct Cie {
+  uint64_t code_alignment = 0;
+  int64_t data_alignment = 0;
+  uint64_t return_address_register = 0;
+  uint8_t fde_encoding = kEncodingAbsptr;
+  bool has_augmentation_data = false;
+  const uint8_t* instructions = nullptr;
+  const uint8_t* end = nullptr;
+};
+
+bool ReadCie(const uint8_t* entry, uintptr_t data_base, Cie* cie) {
+  CfiReader reader = ReadEntry(entry);
+  cie->end = reader.end();
+  if (reader.Read<uint32_t>() != 0)
+    return false;
+  const uint8_t version = reader.Read<uint8_t>();
+  if (version != 1 && version != 3)
+    return false;
+
+  const char* const augmentation =
+      reinterpret_cast<const char*>(reader.position());
+  while (reader.ok() && reader.Read<uint8_t>() != 0) {
+  }
+  cie->code_alignment = reader.ReadUleb128();
+  cie->data_alignment = reader.ReadSleb128();
+  cie->return_address_register =
+      version == 1 ? reader.Read<uint8_t>() : reader.ReadUleb128();
+  if (!reader.ok())
+    return false;
+
+  // The augmentation data is sized by 'z', which comes first if it's there.
+  for (const char* c = augmentation; *c; ++c) {
+    if (*c == 'z' && c == augmentation) {
+      cie->has_augmentation_data = true;
+      const uint64_t size = reader.ReadUleb128();
+      const uint8_t* const augmentation_data = reader.position();
+      reader.Skip(size);
+      if (!reader.ok())
+        return false;
+      reader = CfiReader(augmentation_data, reader.position());
+    } else if (*c == 'L') {
+      reader.Read<uint8_t>();
+    } else if (*c == 'P') {
+      reader.ReadEncoded(reader.Read<uint8_t>(), data_base);
+    } else if (*c == 'R') {
+      cie->fde_encoding = reader.Read<uint8_t>();
+    } else if (*c != 'S') {
+      // The data of the other augmentations can only be skipped with 'z'.
+      if (!cie->has_augmentation_data)
+        return false;
+      break;
+    }
+  }
+  if (!reader.ok())
+    return false;
+
+  cie->instructions =
+      cie->has_augmentation_data ? reader.end() : reader.position();
+  return true;
+}
+
+// The frame description entry of a function.
+struct Fde {
+  uintptr_t pc_begin = 0;
+  uintptr_t pc_end = 0;
+  const uint8_t* instructions = nullptr;
+  const uint8_t* end = nullptr;
+};
+
+bool ReadFde(const uint8_t* entry, uintptr_t data_base, Cie* cie, Fde* fde) {
+  CfiReader reader = ReadEntry(entry);
+  const uint8_t* const cie_pointer_address = reader.position();
+  const uint32_t cie_pointer = reader.Read<uint32_t>();
+  if (!reader.ok() || cie_pointer == 0)
+    return false;
+  if (!ReadCie(cie_pointer_address - cie_pointer, data_base, cie))
+    return false;
+
+  fde->pc_begin = reader.ReadEncoded(cie->fde_encoding, data_base);
+  fde->pc_end =
+      fde->pc_begin +
+      reader.ReadEncoded(cie->fde_encoding & kEncodingFormatMask, data_base);
+  if (cie->has_augmentation_data)
+    reader.Skip(reader.ReadUleb128());
+  if (!reader.ok())
+    return false;
+  fde->instructions = reader.position();
+  fde->end = reader.end();
+  return true;
+}
+
+// The rule which recovers a register of the caller.
+enum class RegisterRule : uint8_t {
+  kSameValue,
+  kUndefined,
+  // Saved at CFA + offset.
+  kOffset,
+  // The value is CFA + offset.
+  kValOffset,
+  // E.g. a DWARF expression.
+  kUnsupported,
+};
+
+// A row of the CFI table: how to recover the CFA, which is the stack pointer of
+// the caller, and the registers of the caller.
+struct CfiRow {
+  uint64_t cfa_register = 0;
+  int64_t cfa_offset = 0;
+  bool is_cfa_supported = true;
+  RegisterRule rules[kDwarfRegisterCount] = {};
+  int64_t offsets[kDwarfRegisterCount] = {};
+};
+
+// Runs the CFA instructions of |reader|, which start at the code address
+// |location|, until they describe the row of |pc|. |initial_row| is the row of
+// the CIE instructions, which DW_CFA_restore restores. Returns false if the
+// instructions aren't valid.
+bool RunCfaInstructions(CfiReader reader,
+                        const Cie& cie,
+                        uintptr_t location,
+                        uintptr_t pc,
+                        uintptr_t data_base,
+                        const CfiRow& initial_row,
+                        CfiRow* row) {
+  CfiRow remembered_rows[kMaxRememberedRows];
+  size_t remembered_row_count = 0;
+  const auto set_rule = [row](uint64_t reg, RegisterRule rule,
+                              int64_t offset) {
+    // The vector registers are never needed to unwind.
+    if (reg >= kDwarfRegisterCount)
+      return;
+    row->rules[reg] = rule;
+    row->offsets[reg] = offset;
+  };
+  const auto restore_rule = [row, &initial_row](uint64_t reg) {
+    if (reg >= kDwarfRegisterCount)
+      return;
+    row->rules[reg] = initial_row.rules[reg];
+    row->offsets[reg] = initial_row.offsets[reg];
+  };
+  const auto advance = [&](uint64_t delta) {
+    location += delta * cie.code_alignment;
+    return location <= pc;
+  };
+
+  while (!reader.at_end()) {
+    const uint8_t opcode = reader.Read<uint8_t>();
+    const uint8_t operand = opcode & 0x3f;
+    switch (opcode >> 6) {
+      case 1:  // DW_CFA_advance_loc
+        if (!advance(operand))
+          return true;
+        continue;
+      case 2:  // DW_CFA_offset
+        set_rule(operand, RegisterRule::kOffset,
+                 static_cast<int64_t>(reader.ReadUleb128()) *
+                     cie.data_alignment);
+        continue;
+      case 3:  // DW_CFA_restore
+        restore_rule(operand);
+        continue;
+    }
+
+    switch (opcode) {
+      case 0x00:  // DW_CFA_nop
+        break;
+      case 0x01:  // DW_CFA_set_loc
+        location = reader.ReadEncoded(cie.fde_encoding, data_base);
+        if (reader.ok() && location > pc)
+          return true;
+        break;
+      case 0x02:  // DW_CFA_advance_loc1
+        if (!advance(reader.Read<uint8_t>()))
+          return reader.ok();
+        break;
+      case 0x03:  // DW_CFA_advance_loc2
+        if (!advance(reader.Read<uint16_t>()))
+          return reader.ok();
+        break;
+      case 0x04:  // DW_CFA_advance_loc4
+        if (!advance(reader.Read<uint32_t>()))
+          return reader.ok();
+        break;
+      case 0x05: {  // DW_CFA_offset_extended
+        const uint64_t reg = reader.ReadUleb128();
+        set_rule(reg, RegisterRule::kOffset,
+                 static_cast<int64_t>(reader.ReadUleb128()) *
+                     cie.data_alignment);
+        break;
+      }
+      case 0x06:  // DW_CFA_restore_extended
+        restore_rule(reader.ReadUleb128());
+        break;
+      case 0x07:  // DW_CFA_undefined
+        set_rule(reader.ReadUleb128(), RegisterRule::kUndefined, 0);
+        break;
+      case 0x08:  // DW_CFA_same_value
+        set_rule(reader.ReadUleb128(), RegisterRule::kSameValue, 0);
+        break;
+      case 0x09: {  // DW_CFA_register
+        const uint64_t reg = reader.ReadUleb128();
+        reader.ReadUleb128();
+        set_rule(reg, RegisterRule::kUnsupported, 0);
+        break;
+      }
+      case 0x0a:  // DW_CFA_remember_state
+        if (remembered_row_count == kMaxRememberedRows)
+          return false;
+        remembered_rows[remembered_row_count++] = *row;
+        break;
+      case 0x0b:  // DW_CFA_restore_state
+        if (remembered_row_count == 0)
+          return false;
+        *row = remembered_rows[--remembered_row_count];
+        break;
+      case 0x0c:  // DW_CFA_def_cfa
+        row->cfa_register = reader.ReadUleb128();
+        row->cfa_offset = static_cast<int64_t>(reader.ReadUleb128());
+        row->is_cfa_supported = true;
+        break;
+      case 0x0d:  // DW_CFA_def_cfa_register
+        row->cfa_register = reader.ReadUleb128();
+        break;
+      case 0x0e:  // DW_CFA_def_cfa_offset
+        row->cfa_offset = static_cast<int64_t>(reader.ReadUleb128());
+        break;
+      case 0x0f:  // DW_CFA_def_cfa_expression
+        reader.Skip(reader.ReadUleb128());
+        row->is_cfa_supported = false;
+        break;
+      case 0x10: {  // DW_CFA_expression
+        const uint64_t reg = reader.ReadUleb128();
+        reader.Skip(reader.ReadUleb128());
+        set_rule(reg, RegisterRule::kUnsupported, 0);
+        break;
+      }
+      case 0x11: {  // DW_CFA_offset_extended_sf
+        const uint64_t reg = reader.ReadUleb128();
+        set_rule(reg, RegisterRule::kOffset,
+                 reader.ReadSleb128() * cie.data_alignment);
+        break;
+      }
+      case 0x12:  // DW_CFA_def_cfa_sf
+        row->cfa_register = reader.ReadUleb128();
+        row->cfa_offset = reader.ReadSleb128() * cie.data_alignment;
+        row->is_cfa_supported = true;
+        break;
+      case 0x13:  // DW_CFA_def_cfa_offset_sf
+        row->cfa_offset = reader.ReadSleb128() * cie.data_alignment;
+        break;
+      case 0x14: {  // DW_CFA_val_offset
+        const uint64_t reg = reader.ReadUleb128();
+        set_rule(reg, RegisterRule::kValOffset,
+                 static_cast<int64_t>(reader.ReadUleb128()) *
+                     cie.data_alignment);
+        break;
+      }
+      case 0x15: {  // DW_CFA_val_offset_sf
+        const uint64_t reg = reader.ReadUleb128();
+        set_rule(reg, RegisterRule::kValOffset,
+                 reader.ReadSleb128() * cie.data_alignment);
+        break;
+      }
+      case 0x16: {  // DW_CFA_val_expression
+        const uint64_t reg = reader.ReadUleb128();
+        reader.Skip(reader.ReadUleb128());
+        set_rule(reg, RegisterRule::kUnsupported, 0);
+        break;
+      }
+      case 0x2e:  // DW_CFA_GNU_args_size
+        reader.ReadUleb128();
+        break;
+      case 0x2f: {  // DW_CFA_GNU_negative_offset_extended
+        const uint64_t reg = reader.ReadUleb128();
+        set_rule(reg, RegisterRule::kOffset,
+                 -static_cast<int64_t>(reader.ReadUleb128()) *
+                     cie.data_alignment);
+        break;
+      }
+      default:
+        return false;
+    }
+  }
+  return reader.ok();
+}
+
+}  // namespace
+
+NativeUnwinderLinux::NativeUnwinderLinux() = default;
+
+NativeUnwinderLinux::~NativeUnwinderLinux() = default;
+
+bool NativeUnwinderLinux::CanUnwindFrom(const Frame& current_frame) const {
+  return current_frame.module && current_frame.module->IsNative();
+}
+
+UnwindResult NativeUnwinderLinux::TryUnwind(RegisterContext* thread_context,
+                                            uintptr_t stack_top,
+                                            std::vector<Frame>* stack) const {
+  // We expect the frame corresponding to the |thread_context| register state to
+  // exist within |stack|.
+  DCHECK_GT(stack->size(), 0u);
+
+  // Only the leaf frame of the sample has the instruction pointer of the
+  // thread, the frames from the other unwinders have return addresses.
+  bool is_leaf_frame = stack->size() == 1;
+  for (;;) {
+    const ModuleCache::Module* module = stack->back().module;
+    if (!module)
+      return UnwindResult::kAborted;
+    if (!module->IsNative())
+      return UnwindResult::kUnrecognizedFrame;
+
+    if (!StepFrameWithCfi(module, is_leaf_frame, thread_context, stack_top)) {
+      // The outermost frame of the thread has a null frame pointer.
+      if (RegisterContextFramePointer(thread_context) == 0)
+        return UnwindResult::kCompleted;
+      if (!FramePointerUnwinder::StepFrame(thread_context, stack_top))
+        return UnwindResult::kAborted;
+    }
+    is_leaf_frame = false;
+
+    // The CFI of the outermost frame leaves the return address undefined.
+    const uintptr_t return_address =
+        RegisterContextInstructionPointer(thread_context);
+    if (return_address == 0)
+      return UnwindResult::kCompleted;
+    stack->emplace_back(return_address,
+                        module_cache()->GetModuleForAddress(return_address));
+  }
+}
+
+NativeUnwinderLinux::CfiTable NativeUnwinderLinux::GetCfiTable(
+    const ModuleCache::Module* module) const {
+  auto it = cfi_tables_.find(module);
+  if (it != cfi_tables_.end())
+    return it->second;
+
+  // See the layout of .eh_frame_hdr in the Linux Standard Base Core
+  // Specification 10.6.2.
+  CfiTable table;
+  const void* const base_address =
+      reinterpret_cast<const void*>(module->GetBaseAddress());
+  const size_t relocation_offset = debug::GetRelocationOffset(base_address);
+  for (const Phdr& header : debug::GetElfProgramHeaders(base_address)) {
+    if (header.p_type != PT_GNU_EH_FRAME)
+      continue;
+    const uint8_t* const eh_frame_hdr =
+        reinterpret_cast<const uint8_t*>(header.p_vaddr + relocation_offset);
+    const uintptr_t data_base = reinterpret_cast<uintptr_t>(eh_frame_hdr);
+    CfiReader reader(eh_frame_hdr, eh_frame_hdr + header.p_memsz);
+    const uint8_t version = reader.Read<uint8_t>();
+    const uint8_t eh_frame_pointer_encoding = reader.Read<uint8_t>();
+    const uint8_t fde_count_encoding = reader.Read<uint8_t>();
+    const uint8_t table_encoding = reader.Read<uint8_t>();
+    if (version != 1 || eh_frame_pointer_encoding == kEncodingOmit ||
+        fde_count_encoding == kEncodingOmit ||
+        table_encoding != kTableEncoding) {
+      break;
+    }
+    reader.ReadEncoded(eh_frame_pointer_encoding, data_base);
+    const uintptr_t fde_count =
+        reader.ReadEncoded(fde_count_encoding, data_base);
+    if (!reader.ok() ||
+        fde_count > static_cast<size_t>(reader.end() - reader.position()) /
+                        (2 * sizeof(int32_t))) {
+      break;
+    }
+    table.eh_frame_hdr = eh_frame_hdr;
+    table.entries = reinterpret_cast<const int32_t*>(reader.position());
+    table.entry_count = fde_count;
+    break;
+  }
+  cfi_tables_.emplace(module, table);
+  return table;
+}
+
+bool NativeUnwinderLinux::StepFrameWithCfi(const ModuleCache::Module* module,
+                                           bool is_leaf_frame,
+                                           RegisterContext* thread_context,
+                                           uintptr_t stack_top) const {
+  const CfiTable table = GetCfiTable(module);
+  if (table.entry_count == 0)
+    return false;
+
+  // A return address may be past the end of its function, if it follows a call
+  // which doesn't return.
+  const uintptr_t instruction_pointer =
+      RegisterContextInstructionPointer(thread_context);
+  const uintptr_t pc =
+      is_leaf_frame ? instruction_pointer : instruction_pointer - 1;
+
+  // Finds the last function which starts at or before |pc|.
+  const uintptr_t data_base = reinterpret_cast<uintptr_t>(table.eh_frame_hdr);
+  const intptr_t relative_pc = static_cast<intptr_t>(pc - data_base);
+  size_t low = 0;
+  size_t high = table.entry_count;
+  while (low < high) {
+    const size_t middle = low + (high - low) / 2;
+    if (table.entries[2 * middle] <= relative_pc)
+      low = middle + 1;
+    else
+      high = middle;
+  }
+  if (low == 0)
+    return false;
+
+  Cie cie;
+  Fde fde;
+  if (!ReadFde(table.eh_frame_hdr + table.entries[2 * (low - 1) + 1],
+               data_base, &cie, &fde) ||
+      pc < fde.pc_begin || pc >= fde.pc_end ||
+      cie.return_address_register != kDwarfReturnAddress) {
+    return false;
+  }
+
+  CfiRow initial_row;
+  if (!RunCfaInstructions(CfiReader(cie.instructions, cie.end), cie, 0,
+                          UINTPTR_MAX, data_base, CfiRow(), &initial_row)) {
+    return false;
+  }
+  CfiRow row = initial_row;
+  if (!RunCfaInstructions(CfiReader(fde.instructions, fde.end), cie,
+                          fde.pc_begin, pc, data_base, initial_row, &row) ||
+      !row.is_cfa_supported || row.cfa_register >= kDwarfReturnAddress) {
+    return false;
+  }
+
+  // The CFA is the stack pointer of the caller, so is above the frame.
+  greg_t* const registers = thread_context->gregs;
+  const uintptr_t stack_pointer = RegisterContextStackPointer(thread_context);
+  const uintptr_t cfa =
+      static_cast<uintptr_t>(registers[kGregsIndex[row.cfa_register]]) +
+      static_cast<uintptr_t>(row.cfa_offset);
+  if (cfa <= stack_pointer || cfa > stack_top)
+    return false;
+
+  // Reads all the registers before writing any, since the rules refer to the
+  // registers of the callee.
+  uintptr_t values[kDwarfRegisterCount];
+  for (uint32_t reg = 0; reg < kDwarfRegisterCount; ++reg) {
+    const uintptr_t address = cfa + static_cast<uintptr_t>(row.offsets[reg]);
+    switch (row.rules[reg]) {
+      case RegisterRule::kSameValue:
+        if (reg == kDwarfReturnAddress)
+          return false;
+        values[reg] = static_cast<uintptr_t>(registers[kGregsIndex[reg]]);
+        break;
+      case RegisterRule::kUndefined:
+        values[reg] = 0;
+        break;
+      case RegisterRule::kOffset:
+        if (address < stack_pointer || address >= stack_top ||
+            stack_top - address < sizeof(uintptr_t) ||
+            address % sizeof(uintptr_t) != 0) {
+          return false;
+        }
+        values[reg] = *reinterpret_cast<const uintptr_t*>(address);
+        break;
+      case RegisterRule::kValOffset:
+        values[reg] = address;
+        break;
+      case RegisterRule::kUnsupported:
+        if (reg == kDwarfReturnAddress)
+          return false;
+        values[reg] = 0;
+        break;
+    }
+  }
+
+  for (uint32_t reg = 0; reg < kDwarfReturnAddress; ++reg)
+    registers[kGregsIndex[reg]] = static_cast<greg_t>(values[reg]);
+  RegisterContextStackPointer(thread_context) = cfa;
+  RegisterContextInstructionPointer(thread_context) =
+      values[kDwarfReturnAddress];
+  return true;
+}
+
+}  // namespace base
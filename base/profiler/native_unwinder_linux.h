@@ -0,0 +1,66 @@
+// Copyright 2022 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#ifndef BASE_PROFILER_NATIVE_UNWINDER_LINUX_H_
+#define BASE_PROFILER_NATIVE_UNWINDER_LINUX_H_
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include <vector>
+
+#include "base/base_export.h"
+#include "base/containers/flat_map.h"
+#include "base/profiler/unwinder.h"
+
+namespace base {
+
+// Native unwinder implementation for Linux x86_64, which follows the DWARF call
+// frame information (CFI) of the .eh_frame section of the modules, found
+// through their .eh_frame_hdr lookup table. Unlike FramePointerUnwinder, it
+// unwinds the code built without frame pointers and the functions interrupted
+// in their prologue or epilogue. The frames without CFI, or with CFI
+// expressions, are unwound with their frame pointer.
+class BASE_EXPORT NativeUnwinderLinux : public Unwinder {
+ public:
+  NativeUnwinderLinux();
+  ~NativeUnwinderLinux() override;
+
+  NativeUnwinderLinux(const NativeUnwinderLinux&) = delete;
+  NativeUnwinderLinux& operator=(const NativeUnwinderLinux&) = delete;
+
+  // Unwinder:
+  bool CanUnwindFrom(const Frame& current_frame) const override;
+  UnwindResult TryUnwind(RegisterContext* thread_context,
+                         uintptr_t stack_top,
+                         std::vector<Frame>* stack) const override;
+
+ private:
+  // The binary search table of the .eh_frame_hdr section of a module: pairs of
+  // {function start, FDE address}, relative to |eh_frame_hdr|.
+  struct CfiTable {
+    const uint8_t* eh_frame_hdr = nullptr;
+    const int32_t* entries = nullptr;
+    size_t entry_count = 0;
+  };
+
+  // Returns the table of |module|, which is read on the first use. The table is
+  // empty if the module has no .eh_frame_hdr, or an unsupported one.
+  CfiTable GetCfiTable(const ModuleCache::Module* module) const;
+
+  // Unwinds |thread_context| to the caller of its frame with the CFI of
+  // |module|. Returns false if the frame has no CFI, or unsupported CFI.
+  bool StepFrameWithCfi(const ModuleCache::Module* module,
+                        bool is_leaf_frame,
+                        RegisterContext* thread_context,
+                        uintptr_t stack_top) const;
+
+  // The modules are owned by the ModuleCache, which keeps them until it's
+  // destroyed.
+  mutable flat_map<const ModuleCache::Module*, CfiTable> cfi_tables_;
+};
+
+}  // namespace base
+
+#endif  // BASE_PROFILER_NATIVE_UNWINDER_LINUX_H_
@@ -0,0 +1,91 @@
+// Copyright 2022 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "base/profiler/native_unwinder_linux.h"
+
+#include <ucontext.h>
+
+#include <memory>
+#include <vector>
+
+#include "base/compiler_specific.h"
+#include "base/debug/stack_trace.h"
+#include "base/profiler/module_cache.h"
+#include "base/profiler/stack_sampling_profiler_test_util.h"
+#include "testing/gtest/include/gtest/gtest.h"
+
+namespace base {
+
+namespace {
+
+// Unwinds the stack of the thread from the return of getcontext(). Returns the
+// return address of the call.
+NOINLINE const void* UnwindCurrentStack(ModuleCache* module_cache,
+                                        UnwindResult* result,
+                                        std::vector<Frame>* stack) {
+  ucontext_t context;
+  getcontext(&context);
+  const uintptr_t instruction_pointer =
+      RegisterContextInstructionPointer(&context.uc_mcontext);
+  stack->emplace_back(instruction_pointer,
+                      module_cache->GetModuleForAddress(instruction_pointer));
+
+  NativeUnwinderLinux unwinder;
+  unwinder.Initialize(module_cache);
+  *result = unwinder.TryUnwind(&context.uc_mcontext, debug::GetStackEnd(),
+                               stack);
+  return __builtin_return_address(0);
+}
+
+}  // namespace
+
+TEST(NativeUnwinderLinuxTest, UnwindsTheCurrentStack) {
+  ModuleCache module_cache;
+  UnwindResult result;
+  std::vector<Frame> stack;
+  const void* return_address =
+      UnwindCurrentStack(&module_cache, &result, &stack);
+
+  // The CFI leaves the return address of the outermost frame undefined.
+  EXPECT_EQ(UnwindResult::kCompleted, result);
+  ASSERT_GT(stack.size(), 3u);
+  EXPECT_EQ(reinterpret_cast<uintptr_t>(return_address),
+            stack[1].instruction_pointer);
+  for (const Frame& frame : stack)
+    EXPECT_NE(nullptr, frame.module);
+}
+
+TEST(NativeUnwinderLinuxTest, FallsBackToTheFramePointers) {
+  // Not an ELF image, so has no CFI.
+  alignas(16) static const uint8_t kModule[0x100] = {};
+  const uintptr_t module_start = reinterpret_cast<uintptr_t>(&kModule[0]);
+  ModuleCache module_cache;
+  module_cache.AddCustomNativeModule(
+      std::make_unique<TestModule>(module_start, sizeof(kModule)));
+
+  // A frame record, then the outermost one.
+  uintptr_t words[4];
+  words[0] = reinterpret_cast<uintptr_t>(&words[2]);
+  words[1] = module_start + 0x20;
+  words[2] = 0;
+  words[3] = 0;
+  const uintptr_t stack_top = reinterpret_cast<uintptr_t>(&words[4]);
+  RegisterContext context;
+  RegisterContextStackPointer(&context) = reinterpret_cast<uintptr_t>(words);
+  RegisterContextFramePointer(&context) = reinterpret_cast<uintptr_t>(words);
+  RegisterContextInstructionPointer(&context) = module_start + 0x10;
+
+  NativeUnwinderLinux unwinder;
+  unwinder.Initialize(&module_cache);
+  std::vector<Frame> stack;
+  stack.emplace_back(module_start + 0x10,
+                     module_cache.GetModuleForAddress(module_start + 0x10));
+  ASSERT_TRUE(unwinder.CanUnwindFrom(stack.back()));
+  EXPECT_EQ(UnwindResult::kCompleted,
+            unwinder.TryUnwind(&context, stack_top, &stack));
+  ASSERT_EQ(2u, stack.size());
+  EXPECT_EQ(module_start + 0x20, stack[1].instruction_pointer);
+}
+
+}  // namespace base
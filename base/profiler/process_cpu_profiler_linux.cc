@@ -0,0 +1,525 @@
+// Copyright 2022 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "base/profiler/process_cpu_profiler_linux.h"
+
+#include <errno.h>
+#include <signal.h>
+#include <string.h>
+#include <sys/time.h>
+#include <sys/ucontext.h>
+#include <sys/uio.h>
+#include <unistd.h>
+
+#include <atomic>
+#include <utility>
+
+#include "base/bind.h"
+#include "base/check_op.h"
+#include "base/debug/debugging_buildflags.h"
+#include "base/files/file_path.h"
+#include "base/files/file_util.h"
+#include "base/logging.h"
+#include "base/metrics/crc32.h"
+#include "base/profiler/register_context.h"
+#include "base/strings/string_piece.h"
+#include "base/strings/string_util.h"
+#include "base/threading/platform_thread.h"
+
+namespace base {
+
+namespace internal {
+
+// The samples recorded by the signal handler, which takes a free slot for each
+// sample, and AggregateSamples() frees. The handler drops the sample if the
+// slot it gets is still taken.
+class CpuSampleBuffer {
+ public:
+  // Enough for 40 CPUs sampled at 100Hz between two aggregations.
+  static constexpr size_t kSize = 1024;
+
+  CpuSampleBuffer() : pid_(getpid()) {}
+  CpuSampleBuffer(const CpuSampleBuffer&) = delete;
+  CpuSampleBuffer& operator=(const CpuSampleBuffer&) = delete;
+  ~CpuSampleBuffer() = default;
+
+  // Records the stack of |context|. Only called from the signal handler, so
+  // NO HEAP ALLOCATIONS, locks or logging.
+  void Record(mcontext_t* context);
+
+  // Moves the stack of the slot at |index| into |stack|, if it holds one.
+  bool Take(size_t index, std::vector<uintptr_t>* stack);
+
+  size_t dropped_count() const {
+    return dropped_count_.load(std::memory_order_relaxed);
+  }
+
+ private:
+  enum State : uint32_t { kFree, kWriting, kRecorded };
+
+  struct Sample {
+    std::atomic<uint32_t> state{kFree};
+    uint32_t frame_count = 0;
+    uintptr_t frames[ProcessCpuProfiler::kMaxFrames];
+  };
+
+  const pid_t pid_;
+  std::atomic<size_t> next_index_{0};
+  std::atomic<size_t> dropped_count_{0};
+  Sample samples_[kSize];
+};
+
+}  // namespace internal
+
+namespace {
+
+// Frame pointers further than this from the stack pointer are taken to be
+// garbage.
+constexpr uintptr_t kMaxStackSize = 64 << 20;
+
+// How often the samples are aggregated.
+constexpr TimeDelta kAggregationInterval = Milliseconds(250);
+
+// The buffer of the running profiler, if any.
+std::atomic<internal::CpuSampleBuffer*> g_sample_buffer{nullptr};
+
+// The number of signal handlers which may use |g_sample_buffer|.
+std::atomic<int> g_running_handlers{0};
+
+// Reads the words of the stack of the interrupted thread. process_vm_readv()
+// fails instead of faulting where a garbage frame pointer points to unmapped
+// memory, and reading a block at a time makes it one syscall for most stacks.
+class StackReader {
+ public:
+  explicit StackReader(pid_t pid) : pid_(pid) {}
+  StackReader(const StackReader&) = delete;
+  StackReader& operator=(const StackReader&) = delete;
+
+  // |address| must be aligned.
+  bool Read(uintptr_t address, uintptr_t* value) {
+    const uintptr_t block_address = address & ~(kBlockSize - 1);
+    if (!has_block_ || block_address != block_address_) {
+      struct iovec local = {block_, kBlockSize};
+      struct iovec remote = {reinterpret_cast<void*>(block_address),
+                             kBlockSize};
+      has_block_ = process_vm_readv(pid_, &local, 1, &remote, 1, 0) ==
+                   static_cast<ssize_t>(kBlockSize);
+      if (!has_block_)
+        return false;
+      block_address_ = block_address;
+    }
+    memcpy(value, block_ + (address - block_address), sizeof(*value));
+    return true;
+  }
+
+ private:
+  static constexpr uintptr_t kBlockSize = 256;
+
+  const pid_t pid_;
+  bool has_block_ = false;
+  uintptr_t block_address_ = 0;
+  alignas(uintptr_t) uint8_t block_[kBlockSize];
+};
+
+// Walks the frame pointers of |context| into |frames|, leaf first. Returns the
+// number of frames. NO HEAP ALLOCATIONS.
+size_t WalkStack(pid_t pid,
+                 mcontext_t* context,
+                 uintptr_t* frames,
+                 size_t max_frames) {
+  frames[0] = RegisterContextInstructionPointer(context);
+  size_t frame_count = 1;
+#if BUILDFLAG(CAN_UNWIND_WITH_FRAME_POINTERS)
+  const uintptr_t stack_pointer = RegisterContextStackPointer(context);
+  uintptr_t frame_pointer = RegisterContextFramePointer(context);
+  uintptr_t lowest_frame_pointer = stack_pointer;
+  StackReader reader(pid);
+  while (frame_count < max_frames) {
+    // The frames go up the stack: each frame pointer points to the previous
+    // frame pointer, followed by the return address.
+    if (frame_pointer < lowest_frame_pointer ||
+        frame_pointer - stack_pointer > kMaxStackSize ||
+        frame_pointer % sizeof(uintptr_t) != 0) {
+      break;
+    }
+    uintptr_t next_frame_pointer;
+    uintptr_t return_address;
+    if (!reader.Read(frame_pointer, &next_frame_pointer) ||
+        !reader.Read(frame_pointer + sizeof(uintptr_t), &return_address) ||
+        !return_address) {
+      break;
+    }
+    frames[frame_count++] = return_address;
+    lowest_frame_pointer = frame_pointer + 2 * sizeof(uintptr_t);
+    frame_pointer = next_frame_pointer;
+  }
+#endif  // BUILDFLAG(CAN_UNWIND_WITH_FRAME_POINTERS)
+  return frame_count;
+}
+
+void RecordSampleSignalHandler(int signal, siginfo_t* info, void* context) {
+  const int saved_errno = errno;
+  g_running_handlers.fetch_add(1);
+  internal::CpuSampleBuffer* buffer = g_sample_buffer.load();
+  if (buffer)
+    buffer->Record(&static_cast<ucontext_t*>(context)->uc_mcontext);
+  g_running_handlers.fetch_sub(1);
+  errno = saved_errno;
+}
+
+// Installs RecordSampleSignalHandler() for SIGPROF, unless another handler is
+// installed. It's never uninstalled: a SIGPROF can still be pending after
+// ITIMER_PROF is disarmed, and SIGPROF terminates the process by default.
+bool InstallSignalHandler() {
+  static const bool installed = [] {
+    struct sigaction action;
+    if (sigaction(SIGPROF, nullptr, &action) != 0)
+      return false;
+    if ((action.sa_flags & SA_SIGINFO) ||
+        (action.sa_handler != SIG_DFL && action.sa_handler != SIG_IGN)) {
+      return false;
+    }
+    memset(&action, 0, sizeof(action));
+    action.sa_sigaction = RecordSampleSignalHandler;
+    action.sa_flags = SA_RESTART | SA_SIGINFO;
+    sigemptyset(&action.sa_mask);
+    return sigaction(SIGPROF, &action, nullptr) == 0;
+  }();
+  return installed;
+}
+
+// Writes the messages of profile.proto, field by field.
+class ProtoWriter {
+ public:
+  ProtoWriter() = default;
+  ProtoWriter(const ProtoWriter&) = delete;
+  ProtoWriter& operator=(const ProtoWriter&) = delete;
+
+  void AppendVarint(uint32_t field, uint64_t value) {
+    AppendRawVarint(field << 3);
+    AppendRawVarint(value);
+  }
+
+  void AppendBytes(uint32_t field, StringPiece bytes) {
+    AppendRawVarint((field << 3) | 2);
+    AppendRawVarint(bytes.size());
+    data_.append(bytes.data(), bytes.size());
+  }
+
+  void AppendPackedVarints(uint32_t field,
+                           const std::vector<uint64_t>& values) {
+    ProtoWriter packed;
+    for (uint64_t value : values)
+      packed.AppendRawVarint(value);
+    AppendBytes(field, packed.data());
+  }
+
+  const std::string& data() const { return data_; }
+
+ private:
+  void AppendRawVarint(uint64_t value) {
+    while (value >= 0x80) {
+      data_.push_back(static_cast<char>(value | 0x80));
+      value >>= 7;
+    }
+    data_.push_back(static_cast<char>(value));
+  }
+
+  std::string data_;
+};
+
+// The string_table of a Profile, whose first string must be empty.
+class StringTable {
+ public:
+  StringTable() { Intern(std::string()); }
+  StringTable(const StringTable&) = delete;
+  StringTable& operator=(const StringTable&) = delete;
+
+  uint64_t Intern(const std::string& string) {
+    auto result = indices_.emplace(string, strings_.size());
+    if (result.second)
+      strings_.push_back(string);
+    return result.first->second;
+  }
+
+  const std::vector<std::string>& strings() const { return strings_; }
+
+ private:
+  std::map<std::string, uint64_t> indices_;
+  std::vector<std::string> strings_;
+};
+
+// Returns the GNU build ID of |module| as pprof expects it: ModuleCache gives
+// it in uppercase, followed by an age.
+std::string GetBuildId(const ModuleCache::Module& module) {
+  std::string id = module.GetId();
+  if (!id.empty())
+    id.pop_back();
+  return ToLowerASCII(id);
+}
+
+void AppendLittleEndian32(uint32_t value, std::string* output) {
+  for (int i = 0; i < 4; ++i)
+    output->push_back(static_cast<char>(value >> (8 * i)));
+}
+
+// Wraps |data| in gzip (RFC 1952), with stored deflate blocks (RFC 1951, 3.2.4)
+// since base has no compressor: the profile doesn't shrink, but reads as gzip.
+std::string Gzip(StringPiece data) {
+  constexpr size_t kMaxBlockSize = 0xffff;
+  static const char kHeader[] = {'\x1f', '\x8b', 8, 0, 0, 0, 0, 0, 0, 3};
+  std::string output(kHeader, sizeof(kHeader));
+  size_t offset = 0;
+  do {
+    const size_t size = std::min(kMaxBlockSize, data.size() - offset);
+    const bool is_final = offset + size == data.size();
+    output.push_back(is_final ? 1 : 0);
+    output.push_back(static_cast<char>(size));
+    output.push_back(static_cast<char>(size >> 8));
+    output.push_back(static_cast<char>(~size));
+    output.push_back(static_cast<char>(~size >> 8));
+    output.append(data.data() + offset, size);
+    offset += size;
+  } while (offset < data.size());
+  AppendLittleEndian32(~Crc32(~0u, data.data(), data.size()), &output);
+  AppendLittleEndian32(static_cast<uint32_t>(data.size()), &output);
+  return output;
+}
+
+}  // namespace
+
+namespace internal {
+
+void CpuSampleBuffer::Record(mcontext_t* context) {
+  Sample& sample =
+      samples_[next_index_.fetch_add(1, std::memory_order_relaxed) % kSize];
+  uint32_t state = kFree;
+  if (!sample.state.compare_exchange_strong(state, kWriting,
+                                            std::memory_order_acquire,
+                                            std::memory_order_relaxed)) {
+    dropped_count_.fetch_add(1, std::memory_order_relaxed);
+    return;
+  }
+  sample.frame_count = static_cast<uint32_t>(
+      WalkStack(pid_, context, sample.frames, ProcessCpuProfiler::kMaxFrames));
+  sample.state.store(kRecorded, std::memory_order_release);
+}
+
+bool CpuSampleBuffer::Take(size_t index, std::vector<uintptr_t>* stack) {
+  Sample& sample = samples_[index];
+  if (sample.state.load(std::memory_order_acquire) != kRecorded)
+    return false;
+  stack->assign(sample.frames, sample.frames + sample.frame_count);
+  sample.state.store(kFree, std::memory_order_release);
+  return true;
+}
+
+}  // namespace internal
+
+ProcessCpuProfiler::ProcessCpuProfiler(TimeDelta sampling_interval)
+    : sampling_interval_(sampling_interval),
+      aggregation_thread_("ProcessCpuProfiler") {
+  DCHECK_GT(sampling_interval_, TimeDelta());
+}
+
+ProcessCpuProfiler::~ProcessCpuProfiler() {
+  DCHECK_CALLED_ON_VALID_SEQUENCE(sequence_checker_);
+  Stop();
+}
+
+bool ProcessCpuProfiler::Start() {
+  DCHECK_CALLED_ON_VALID_SEQUENCE(sequence_checker_);
+  DCHECK(!is_running_);
+  if (!InstallSignalHandler())
+    return false;
+
+  // Another profiler, such as gperftools', may use the timer.
+  struct itimerval timer;
+  if (getitimer(ITIMER_PROF, &timer) != 0 || timer.it_value.tv_sec != 0 ||
+      timer.it_value.tv_usec != 0) {
+    return false;
+  }
+
+  auto sample_buffer = std::make_unique<internal::CpuSampleBuffer>();
+  internal::CpuSampleBuffer* running_buffer = nullptr;
+  if (!g_sample_buffer.compare_exchange_strong(running_buffer,
+                                               sample_buffer.get())) {
+    return false;
+  }
+  sample_buffer_ = std::move(sample_buffer);
+  {
+    AutoLock lock(lock_);
+    stack_counts_.clear();
+    sample_count_ = 0;
+  }
+  start_time_ = Time::Now();
+  start_ticks_ = TimeTicks::Now();
+
+  const int64_t interval_us = sampling_interval_.InMicroseconds();
+  timer.it_interval.tv_sec = static_cast<time_t>(interval_us / 1000000);
+  timer.it_interval.tv_usec = static_cast<suseconds_t>(interval_us % 1000000);
+  timer.it_value = timer.it_interval;
+  if (setitimer(ITIMER_PROF, &timer, nullptr) != 0) {
+    DPLOG(ERROR) << "setitimer";
+    g_sample_buffer.store(nullptr);
+    return false;
+  }
+
+  Thread::Options options;
+  options.priority = ThreadPriority::BACKGROUND;
+  CHECK(aggregation_thread_.StartWithOptions(std::move(options)));
+  aggregation_thread_.task_runner()->PostDelayedTask(
+      FROM_HERE,
+      BindOnce(&ProcessCpuProfiler::AggregateSamplesPeriodically,
+               Unretained(this)),
+      kAggregationInterval);
+  is_running_ = true;
+  return true;
+}
+
+void ProcessCpuProfiler::Stop() {
+  DCHECK_CALLED_ON_VALID_SEQUENCE(sequence_checker_);
+  if (!is_running_)
+    return;
+
+  struct itimerval timer = {};
+  setitimer(ITIMER_PROF, &timer, nullptr);
+  g_sample_buffer.store(nullptr);
+  // A handler which still uses the buffer started before the store above, so
+  // it's counted until it's done.
+  while (g_running_handlers.load() != 0)
+    PlatformThread::YieldCurrentThread();
+
+  aggregation_thread_.Stop();
+  AggregateSamples();
+  stop_ticks_ = TimeTicks::Now();
+  is_running_ = false;
+}
+
+std::string ProcessCpuProfiler::GetProfile() {
+  DCHECK_CALLED_ON_VALID_SEQUENCE(sequence_checker_);
+  if (sample_buffer_)
+    AggregateSamples();
+  AutoLock lock(lock_);
+  return Gzip(SerializeProfile());
+}
+
+bool ProcessCpuProfiler::WriteProfile(const FilePath& path) {
+  return WriteFile(path, GetProfile());
+}
+
+size_t ProcessCpuProfiler::GetSampleCount() {
+  DCHECK_CALLED_ON_VALID_SEQUENCE(sequence_checker_);
+  if (sample_buffer_)
+    AggregateSamples();
+  AutoLock lock(lock_);
+  return sample_count_;
+}
+
+size_t ProcessCpuProfiler::GetDroppedSampleCount() const {
+  DCHECK_CALLED_ON_VALID_SEQUENCE(sequence_checker_);
+  return sample_buffer_ ? sample_buffer_->dropped_count() : 0;
+}
+
+void ProcessCpuProfiler::AggregateSamples() {
+  AutoLock lock(lock_);
+  std::vector<uintptr_t> stack;
+  for (size_t i = 0; i < internal::CpuSampleBuffer::kSize; ++i) {
+    if (!sample_buffer_->Take(i, &stack))
+      continue;
+    ++stack_counts_[stack];
+    ++sample_count_;
+  }
+}
+
+void ProcessCpuProfiler::AggregateSamplesPeriodically() {
+  AggregateSamples();
+  aggregation_thread_.task_runner()->PostDelayedTask(
+      FROM_HERE,
+      BindOnce(&ProcessCpuProfiler::AggregateSamplesPeriodically,
+               Unretained(this)),
+      kAggregationInterval);
+}
+
+std::string ProcessCpuProfiler::SerializeProfile() {
+  ProtoWriter profile;
+  StringTable strings;
+  const auto append_value_type = [&](uint32_t field, const char* type,
+                                     const char* unit) {
+    ProtoWriter value_type;
+    value_type.AppendVarint(1, strings.Intern(type));
+    value_type.AppendVarint(2, strings.Intern(unit));
+    profile.AppendBytes(field, value_type.data());
+  };
+
+  // Profile.sample_type, Profile.sample.
+  append_value_type(1, "samples", "count");
+  append_value_type(1, "cpu", "nanoseconds");
+  const int64_t period = sampling_interval_.InNanoseconds();
+  std::map<uintptr_t, uint64_t> location_ids;
+  for (const auto& stack_count : stack_counts_) {
+    const std::vector<uintptr_t>& stack = stack_count.first;
+    std::vector<uint64_t> stack_location_ids;
+    for (size_t i = 0; i < stack.size(); ++i) {
+      // The callers' frames are return addresses: point them at the call.
+      const uintptr_t address = i == 0 ? stack[i] : stack[i] - 1;
+      stack_location_ids.push_back(
+          location_ids.emplace(address, location_ids.size() + 1)
+              .first->second);
+    }
+    ProtoWriter sample;
+    sample.AppendPackedVarints(1, stack_location_ids);
+    sample.AppendPackedVarints(
+        2, {static_cast<uint64_t>(stack_count.second),
+            static_cast<uint64_t>(stack_count.second * period)});
+    profile.AppendBytes(2, sample.data());
+  }
+
+  // Profile.location. The pprof tools symbolize the addresses with the
+  // binaries of the mappings.
+  std::map<const ModuleCache::Module*, uint64_t> mapping_ids;
+  for (const auto& location_id : location_ids) {
+    ProtoWriter location;
+    location.AppendVarint(1, location_id.second);
+    const ModuleCache::Module* module =
+        module_cache_.GetModuleForAddress(location_id.first);
+    if (module) {
+      location.AppendVarint(
+          2, mapping_ids.emplace(module, mapping_ids.size() + 1).first->second);
+    }
+    location.AppendVarint(3, location_id.first);
+    profile.AppendBytes(4, location.data());
+  }
+
+  // Profile.mapping.
+  for (const auto& mapping_id : mapping_ids) {
+    const ModuleCache::Module& module = *mapping_id.first;
+    ProtoWriter mapping;
+    mapping.AppendVarint(1, mapping_id.second);
+    mapping.AppendVarint(2, module.GetBaseAddress());
+    mapping.AppendVarint(3, module.GetBaseAddress() + module.GetSize());
+    mapping.AppendVarint(
+        5, strings.Intern(module.GetDebugBasename().AsUTF8Unsafe()));
+    mapping.AppendVarint(6, strings.Intern(GetBuildId(module)));
+    profile.AppendBytes(3, mapping.data());
+  }
+
+  // Profile.time_nanos, Profile.duration_nanos, Profile.period_type and
+  // Profile.period.
+  const TimeTicks end_ticks = is_running_ ? TimeTicks::Now() : stop_ticks_;
+  profile.AppendVarint(
+      9, static_cast<uint64_t>(
+             (start_time_ - Time::UnixEpoch()).InNanoseconds()));
+  profile.AppendVarint(
+      10, static_cast<uint64_t>((end_ticks - start_ticks_).InNanoseconds()));
+  append_value_type(11, "cpu", "nanoseconds");
+  profile.AppendVarint(12, static_cast<uint64_t>(period));
+
+  // Profile.string_table, last for the strings of all the fields above.
+  for (const std::string& string : strings.strings())
+    profile.AppendBytes(6, string);
+  return profile.data();
+}
+
+}  // namespace base
@@ -0,0 +1,124 @@
+// Copyright 2022 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#ifndef BASE_PROFILER_PROCESS_CPU_PROFILER_LINUX_H_
+#define BASE_PROFILER_PROCESS_CPU_PROFILER_LINUX_H_
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include <map>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "base/base_export.h"
+#include "base/profiler/module_cache.h"
+#include "base/sequence_checker.h"
+#include "base/synchronization/lock.h"
+#include "base/thread_annotations.h"
+#include "base/threading/thread.h"
+#include "base/time/time.h"
+
+namespace base {
+
+class FilePath;
+
+namespace internal {
+class CpuSampleBuffer;
+}  // namespace internal
+
+// Samples the stacks of all the threads of the process, in proportion to the
+// CPU time they use, and returns them as a pprof profile
+// (https://github.com/google/pprof/blob/main/proto/profile.proto).
+//
+// Unlike StackSamplingProfiler, which stops one thread at a time to copy its
+// stack from a sampling thread, the kernel delivers the SIGPROF of an
+// ITIMER_PROF timer to whichever thread runs when the CPU time of the process
+// crosses the interval: idle threads cost nothing, and nothing wakes up per
+// sample. The signal handler walks the frame pointers of the interrupted stack
+// into a preallocated buffer, which a background thread aggregates with a
+// ModuleCache. This is cheap enough to keep running in production: at the
+// default interval the sampling takes well under 1% of the CPU time.
+//
+// The stacks are only complete for code built with frame pointers, see
+// CAN_UNWIND_WITH_FRAME_POINTERS. Only one profiler can run at a time in the
+// process, and not alongside another user of ITIMER_PROF or SIGPROF.
+//
+// Example:
+//   ProcessCpuProfiler profiler;
+//   if (profiler.Start()) {
+//     ...
+//     profiler.WriteProfile(path);
+//   }
+class BASE_EXPORT ProcessCpuProfiler {
+ public:
+  // The CPU time of the process between two samples.
+  static constexpr TimeDelta kDefaultSamplingInterval = Milliseconds(10);
+
+  // The deepest stack which is sampled. Deeper stacks lose their outermost
+  // frames.
+  static constexpr size_t kMaxFrames = 64;
+
+  explicit ProcessCpuProfiler(
+      TimeDelta sampling_interval = kDefaultSamplingInterval);
+  ProcessCpuProfiler(const ProcessCpuProfiler&) = delete;
+  ProcessCpuProfiler& operator=(const ProcessCpuProfiler&) = delete;
+  ~ProcessCpuProfiler();
+
+  // Starts a new profile, dropping the samples of the previous one. Returns
+  // false if another profiler runs, or if SIGPROF or ITIMER_PROF is in use.
+  bool Start();
+
+  // Stops sampling. The samples are kept until the next Start().
+  void Stop();
+
+  bool is_running() const { return is_running_; }
+
+  // Returns the profile of the samples since Start(), serialized and gzipped
+  // as the pprof tools read it. Can be called while the profiler runs.
+  std::string GetProfile();
+
+  // Writes GetProfile() to |path|. Returns false if it couldn't be written.
+  bool WriteProfile(const FilePath& path);
+
+  // Returns how many samples were taken, and how many were dropped because the
+  // background thread couldn't aggregate them fast enough.
+  size_t GetSampleCount();
+  size_t GetDroppedSampleCount() const;
+
+ private:
+  // Moves the samples out of |sample_buffer_| into |stack_counts_|.
+  void AggregateSamples();
+
+  // Runs AggregateSamples() on |aggregation_thread_| until Stop().
+  void AggregateSamplesPeriodically();
+
+  // Serializes |stack_counts_| as a pprof Profile message.
+  std::string SerializeProfile() EXCLUSIVE_LOCKS_REQUIRED(lock_);
+
+  const TimeDelta sampling_interval_;
+
+  // Written by the signal handler of the sampled threads, and read by
+  // AggregateSamples().
+  std::unique_ptr<internal::CpuSampleBuffer> sample_buffer_;
+  Thread aggregation_thread_;
+
+  Lock lock_;
+  // The number of samples of each stack, leaf first.
+  std::map<std::vector<uintptr_t>, int64_t> stack_counts_ GUARDED_BY(lock_);
+  size_t sample_count_ GUARDED_BY(lock_) = 0;
+  ModuleCache module_cache_ GUARDED_BY(lock_);
+  Time start_time_;
+  TimeTicks start_ticks_;
+  TimeTicks stop_ticks_;
+
+  bool is_running_ = false;
+
+  SEQUENCE_CHECKER(sequence_checker_);
+};
+
+}  // namespace base
+
+#endif  // BASE_PROFILER_PROCESS_CPU_PROFILER_LINUX_H_
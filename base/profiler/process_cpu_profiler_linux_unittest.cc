@@ -0,0 +1,104 @@
+// Copyright 2022 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "base/profiler/process_cpu_profiler_linux.h"
+
+#include <string>
+
+#include "base/compiler_specific.h"
+#include "base/metrics/crc32.h"
+#include "base/time/time.h"
+#include "testing/gtest/include/gtest/gtest.h"
+
+namespace base {
+namespace {
+
+// Uses |cpu_time| of the CPU time of the thread.
+NOINLINE void Spin(TimeDelta cpu_time) {
+  const ThreadTicks end = ThreadTicks::Now() + cpu_time;
+  while (ThreadTicks::Now() < end) {
+  }
+}
+
+uint32_t ReadLittleEndian32(const std::string& data, size_t offset) {
+  uint32_t value = 0;
+  for (size_t i = 0; i < 4; ++i)
+    value |= static_cast<uint32_t>(static_cast<uint8_t>(data[offset + i]))
+             << (8 * i);
+  return value;
+}
+
+// Returns the data of |gzip|, which has the stored blocks of Gzip(), or an
+// empty string if it isn't valid.
+std::string Gunzip(const std::string& gzip) {
+  if (gzip.size() < 18 || gzip.compare(0, 3, "\x1f\x8b\x08") != 0)
+    return std::string();
+  std::string data;
+  size_t offset = 10;
+  bool is_final = false;
+  while (!is_final) {
+    if (offset + 5 > gzip.size() - 8)
+      return std::string();
+    is_final = gzip[offset] == 1;
+    const size_t size = static_cast<uint8_t>(gzip[offset + 1]) |
+                        static_cast<uint8_t>(gzip[offset + 2]) << 8;
+    offset += 5;
+    if (offset + size > gzip.size() - 8)
+      return std::string();
+    data.append(gzip, offset, size);
+    offset += size;
+  }
+  if (offset != gzip.size() - 8 ||
+      ReadLittleEndian32(gzip, offset) !=
+          ~Crc32(~0u, data.data(), data.size()) ||
+      ReadLittleEndian32(gzip, offset + 4) != data.size()) {
+    return std::string();
+  }
+  return data;
+}
+
+}  // namespace
+
+TEST(ProcessCpuProfilerTest, SamplesTheCpuTime) {
+  ProcessCpuProfiler profiler(Milliseconds(1));
+  ASSERT_TRUE(profiler.Start());
+  EXPECT_TRUE(profiler.is_running());
+  Spin(Milliseconds(200));
+  profiler.Stop();
+  EXPECT_FALSE(profiler.is_running());
+
+  // The timer has the resolution of the scheduler tick.
+  const size_t sample_count = profiler.GetSampleCount();
+  EXPECT_GE(sample_count, 10u);
+  EXPECT_EQ(0u, profiler.GetDroppedSampleCount());
+
+  // The strings of the profile are readable in the stored blocks.
+  const std::string profile = Gunzip(profiler.GetProfile());
+  ASSERT_FALSE(profile.empty());
+  EXPECT_NE(std::string::npos, profile.find("samples"));
+  EXPECT_NE(std::string::npos, profile.find("nanoseconds"));
+
+  // The samples are kept until the next profile starts.
+  EXPECT_EQ(sample_count, profiler.GetSampleCount());
+  ASSERT_TRUE(profiler.Start());
+  profiler.Stop();
+  EXPECT_LT(profiler.GetSampleCount(), sample_count);
+}
+
+TEST(ProcessCpuProfilerTest, OnlyOneRuns) {
+  ProcessCpuProfiler profiler;
+  ASSERT_TRUE(profiler.Start());
+  ProcessCpuProfiler other_profiler;
+  EXPECT_FALSE(other_profiler.Start());
+  profiler.Stop();
+  EXPECT_TRUE(other_profiler.Start());
+}
+
+TEST(ProcessCpuProfilerTest, EmptyProfile) {
+  ProcessCpuProfiler profiler;
+  EXPECT_EQ(0u, profiler.GetSampleCount());
+  EXPECT_FALSE(Gunzip(profiler.GetProfile()).empty());
+}
+
+}  // namespace base
@@ -13,10 +13,12 @@
 #include <cstring>
 
 #include "base/memory/raw_ptr.h"
+#include "base/no_destructor.h"
 #include "base/notreached.h"
 #include "base/profiler/register_context.h"
 #include "base/profiler/stack_buffer.h"
 #include "base/profiler/suspendable_thread_delegate.h"
+#include "base/synchronization/lock.h"
 #include "base/time/time_override.h"
 #include "base/trace_event/base_tracing.h"
 #include "build/build_config.h"
@@ -108,6 +110,14 @@ struct HandlerParams {
 // before sending the signal to the thread and reset when the handler is done.
 std::atomic<HandlerParams*> g_handler_params;
 
+// Serializes the stack copies, which share |g_handler_params| and the SIGURG
+// handler. The stacks are copied from different threads by the sampling
+// profiler and the HangWatcher.
+Lock& GetCopyStackLock() {
+  static NoDestructor<Lock> lock;
+  return *lock;
+}
+
 // CopyStackSignalHandler is invoked on the stopped thread and records the
 // thread's stack and register context at the time the signal was received. This
 // function may only call reentrant code.
@@ -198,6 +208,7 @@ bool StackCopierSignal::CopyStack(StackBuffer* stack_buffer,
                                   TimeTicks* timestamp,
                                   RegisterContext* thread_context,
                                   Delegate* delegate) {
+  AutoLock copy_stack_lock(GetCopyStackLock());
   AsyncSafeWaitableEvent wait_event;
   bool copied = false;
   const uint8_t* stack_copy_bottom = nullptr;
@@ -6,18 +6,60 @@
 
 #include <pthread.h>
 
+#include "base/bind.h"
+#include "base/check.h"
+#include "base/debug/debugging_buildflags.h"
+#include "base/profiler/frame_pointer_unwinder.h"
+#include "base/profiler/stack_copier_signal.h"
+#include "base/profiler/stack_sampler_impl.h"
+#include "base/profiler/thread_delegate_posix.h"
 #include "base/threading/platform_thread.h"
 #include "build/build_config.h"
 
+#if (BUILDFLAG(IS_LINUX) || BUILDFLAG(IS_CHROMEOS)) && \
+    defined(ARCH_CPU_X86_64)
+#include "base/profiler/native_unwinder_linux.h"
+#define HAS_NATIVE_UNWINDER_LINUX
+#endif
+
 namespace base {
 
+namespace {
+
+#if defined(HAS_NATIVE_UNWINDER_LINUX) || \
+    BUILDFLAG(CAN_UNWIND_WITH_FRAME_POINTERS)
+std::vector<std::unique_ptr<Unwinder>> CreateUnwinders() {
+  std::vector<std::unique_ptr<Unwinder>> unwinders;
+#if defined(HAS_NATIVE_UNWINDER_LINUX)
+  unwinders.push_back(std::make_unique<NativeUnwinderLinux>());
+#else
+  unwinders.push_back(std::make_unique<FramePointerUnwinder>());
+#endif
+  return unwinders;
+}
+#endif
+
+}  // namespace
+
 std::unique_ptr<StackSampler> StackSampler::Create(
     SamplingProfilerThreadToken thread_token,
     ModuleCache* module_cache,
     UnwindersFactory core_unwinders_factory,
     RepeatingClosure record_sample_callback,
     StackSamplerTestDelegate* test_delegate) {
+#if defined(HAS_NATIVE_UNWINDER_LINUX) || \
+    BUILDFLAG(CAN_UNWIND_WITH_FRAME_POINTERS)
+  DCHECK(!core_unwinders_factory);
+  auto thread_delegate = ThreadDelegatePosix::Create(thread_token);
+  if (!thread_delegate)
+    return nullptr;
+  return std::make_unique<StackSamplerImpl>(
+      std::make_unique<StackCopierSignal>(std::move(thread_delegate)),
+      BindOnce(&CreateUnwinders), module_cache,
+      std::move(record_sample_callback), test_delegate);
+#else
   return nullptr;
+#endif
 }
 
 size_t StackSampler::GetStackBufferSize() {
@@ -748,12 +748,14 @@ TimeTicks StackSamplingProfiler::TestPeer::GetNextSampleTime(
 }
 
 // static
-// The profiler is currently supported for Windows x64, MacOSX x64, and Android
-// ARM32.
+// The profiler is currently supported for Windows x64, MacOSX x64, Linux x64,
+// and Android ARM32.
 bool StackSamplingProfiler::IsSupportedForCurrentPlatform() {
 #if (BUILDFLAG(IS_WIN) && defined(ARCH_CPU_X86_64)) ||  \
     (BUILDFLAG(IS_MAC) && defined(ARCH_CPU_X86_64)) ||  \
     (BUILDFLAG(IS_IOS) && defined(ARCH_CPU_64_BITS)) || \
+    ((BUILDFLAG(IS_LINUX) || BUILDFLAG(IS_CHROMEOS)) && \
+     defined(ARCH_CPU_X86_64)) ||                       \
     (BUILDFLAG(IS_ANDROID) && BUILDFLAG(ENABLE_ARM_CFI_TABLE))
 #if BUILDFLAG(IS_MAC)
   // TODO(https://crbug.com/1098119): Fix unwinding on macOS 11. The OS has
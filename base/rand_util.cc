@@ -9,13 +9,88 @@
 #include <stdint.h>
 
 #include <algorithm>
+#include <atomic>
 #include <limits>
 
 #include "base/check_op.h"
+#include "base/compiler_specific.h"
 #include "base/strings/string_util.h"
+#include "build/build_config.h"
+
+#if BUILDFLAG(IS_POSIX)
+#include <pthread.h>
+#endif
 
 namespace base {
 
+namespace {
+
+// The xoshiro256** generator of FastRand*(). See https://prng.di.unimi.it/.
+struct FastRandState {
+  uint64_t s[4];
+  bool seeded;
+#if BUILDFLAG(IS_POSIX)
+  uint32_t fork_generation;
+#endif
+};
+
+thread_local FastRandState g_tls_fast_rand_state;
+
+#if BUILDFLAG(IS_POSIX)
+// Incremented in the children forked with fork(), which then reseed.
+std::atomic<uint32_t> g_fork_generation{0};
+
+void OnForkInChild() {
+  g_fork_generation.fetch_add(1, std::memory_order_relaxed);
+}
+#endif
+
+uint64_t RotateLeft(uint64_t value, int shift) {
+  return (value << shift) | (value >> (64 - shift));
+}
+
+void SeedFastRand(FastRandState& state) {
+#if BUILDFLAG(IS_POSIX)
+  [[maybe_unused]] static const bool registered_fork_handler =
+      pthread_atfork(nullptr, nullptr, &OnForkInChild) == 0;
+  state.fork_generation = g_fork_generation.load(std::memory_order_relaxed);
+#endif
+  // The state must not be all zeros.
+  do {
+    RandBytes(state.s, sizeof(state.s));
+  } while (!(state.s[0] | state.s[1] | state.s[2] | state.s[3]));
+  state.seeded = true;
+}
+
+void Store32LittleEndian(uint32_t value, uint8_t* bytes) {
+  bytes[0] = static_cast<uint8_t>(value);
+  bytes[1] = static_cast<uint8_t>(value >> 8);
+  bytes[2] = static_cast<uint8_t>(value >> 16);
+  bytes[3] = static_cast<uint8_t>(value >> 24);
+}
+
+uint32_t RotateLeft32(uint32_t value, int shift) {
+  return (value << shift) | (value >> (32 - shift));
+}
+
+// Inlined, so that the indices are constant and the state stays in registers.
+ALWAYS_INLINE void ChaCha20QuarterRound(uint32_t* x,
+                                        int a,
+                                        int b,
+                                        int c,
+                                        int d) {
+  x[a] += x[b];
+  x[d] = RotateLeft32(x[d] ^ x[a], 16);
+  x[c] += x[d];
+  x[b] = RotateLeft32(x[b] ^ x[c], 12);
+  x[a] += x[b];
+  x[d] = RotateLeft32(x[d] ^ x[a], 8);
+  x[c] += x[d];
+  x[b] = RotateLeft32(x[b] ^ x[c], 7);
+}
+
+}  // namespace
+
 uint64_t RandUint64() {
   uint64_t number;
   RandBytes(&number, sizeof(number));
@@ -79,6 +154,85 @@ std::string RandBytesAsString(size_t length) {
   return result;
 }
 
+uint64_t FastRandUint64() {
+  FastRandState& state = g_tls_fast_rand_state;
+#if BUILDFLAG(IS_POSIX)
+  if (!state.seeded || state.fork_generation !=
+                           g_fork_generation.load(std::memory_order_relaxed)) {
+    SeedFastRand(state);
+  }
+#else
+  if (!state.seeded)
+    SeedFastRand(state);
+#endif
+
+  uint64_t* s = state.s;
+  const uint64_t result = RotateLeft(s[1] * 5, 7) * 9;
+  const uint64_t t = s[1] << 17;
+  s[2] ^= s[0];
+  s[3] ^= s[1];
+  s[1] ^= s[2];
+  s[0] ^= s[3];
+  s[2] ^= t;
+  s[3] = RotateLeft(s[3], 45);
+  return result;
+}
+
+int FastRandInt(int min, int max) {
+  DCHECK_LE(min, max);
+
+  const uint64_t range = static_cast<uint64_t>(max) - min + 1;
+  return static_cast<int>(min +
+                          static_cast<int64_t>(FastRandGenerator(range)));
+}
+
+uint64_t FastRandGenerator(uint64_t range) {
+  DCHECK_GT(range, 0u);
+  // Same as RandGenerator().
+  const uint64_t max_acceptable_value =
+      (std::numeric_limits<uint64_t>::max() / range) * range - 1;
+  uint64_t value;
+  do {
+    value = FastRandUint64();
+  } while (value > max_acceptable_value);
+  return value % range;
+}
+
+double FastRandDouble() {
+  return BitsToOpenEndedUnitInterval(FastRandUint64());
+}
+
+namespace internal {
+
+void ChaCha20Block(const uint32_t key[8],
+                   uint32_t counter,
+                   const uint32_t nonce[3],
+                   uint8_t output[64]) {
+  // "expand 32-byte k".
+  const uint32_t input[16] = {
+      0x61707865, 0x3320646e, 0x79622d32, 0x6b206574, key[0],   key[1],
+      key[2],     key[3],     key[4],     key[5],     key[6],   key[7],
+      counter,    nonce[0],   nonce[1],   nonce[2],
+  };
+  uint32_t x[16];
+  std::copy(std::begin(input), std::end(input), x);
+  for (int i = 0; i < 10; ++i) {
+    // Column rounds, then diagonal rounds.
+    ChaCha20QuarterRound(x, 0, 4, 8, 12);
+    ChaCha20QuarterRound(x, 1, 5, 9, 13);
+    ChaCha20QuarterRound(x, 2, 6, 10, 14);
+    ChaCha20QuarterRound(x, 3, 7, 11, 15);
+    ChaCha20QuarterRound(x, 0, 5, 10, 15);
+    ChaCha20QuarterRound(x, 1, 6, 11, 12);
+    ChaCha20QuarterRound(x, 2, 7, 8, 13);
+    ChaCha20QuarterRound(x, 3, 4, 9, 14);
+  }
+  for (int i = 0; i < 16; ++i)
+    Store32LittleEndian(x[i] + input[i], output + 4 * i);
+}
+
+}  // namespace internal
+
 InsecureRandomGenerator::InsecureRandomGenerator() {
   a_ = base::RandUint64();
   b_ = base::RandUint64();
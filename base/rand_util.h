@@ -46,6 +46,11 @@ BASE_EXPORT double BitsToOpenEndedUnitInterval(uint64_t bits);
 
 // Fills |output_length| bytes of |output| with random data. Thread-safe.
 //
+// On Linux, the small requests are served from a per-thread buffer of ChaCha20
+// output, which is keyed by getrandom() and erases its key as it advances, so
+// that most calls make no system call. The buffer is wiped in forked children,
+// which then key their own.
+//
 // Although implementations are required to use a cryptographically secure
 // random number source, code outside of base/ that relies on this should use
 // crypto::RandBytes instead to ensure the requirement is easily discoverable.
@@ -81,10 +86,57 @@ void RandomShuffle(Itr first, Itr last) {
   std::shuffle(first, last, RandomBitGenerator());
 }
 
+// Fast, insecure and thread-safe random numbers, for the callers which
+// sample, or balance load, too often to pay the system call of RandUint64().
+//
+// WARNING: These are not cryptographically secure: their outputs predict the
+// next ones. Never use them for anything that an attacker could benefit from
+// guessing, e.g. tokens, keys or nonces.
+//
+// Each thread has its own xoshiro256** generator, seeded with RandBytes() on
+// its first call, which then costs a few nanoseconds without synchronizing.
+// The children forked with fork() reseed, but not those started with a raw
+// clone(), which repeat the sequences of their parent thread. Unlike
+// InsecureRandomGenerator, which its friends own and don't share between
+// threads, these can be called from anywhere.
+BASE_EXPORT uint64_t FastRandUint64();
+
+// Returns a random number between min and max (inclusive).
+BASE_EXPORT int FastRandInt(int min, int max);
+
+// Returns a random number in range [0, range).
+BASE_EXPORT uint64_t FastRandGenerator(uint64_t range);
+
+// Returns a random double in range [0, 1).
+BASE_EXPORT double FastRandDouble();
+
+// An STL UniformRandomBitGenerator backed by FastRandUint64.
+class FastRandomBitGenerator {
+ public:
+  using result_type = uint64_t;
+  static constexpr result_type min() { return 0; }
+  static constexpr result_type max() { return UINT64_MAX; }
+  result_type operator()() const { return FastRandUint64(); }
+
+  FastRandomBitGenerator() = default;
+  ~FastRandomBitGenerator() = default;
+};
+
 #if BUILDFLAG(IS_POSIX)
 BASE_EXPORT int GetUrandomFD();
 #endif
 
+namespace internal {
+
+// Computes the ChaCha20 block |counter| of |key| and |nonce|, as in RFC 8439,
+// section 2.3, which RandBytes() uses as its buffered generator.
+BASE_EXPORT void ChaCha20Block(const uint32_t key[8],
+                               uint32_t counter,
+                               const uint32_t nonce[3],
+                               uint8_t output[64]);
+
+}  // namespace internal
+
 namespace sequence_manager {
 namespace internal {
 class SequenceManagerImpl;
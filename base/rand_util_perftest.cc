@@ -55,4 +55,42 @@ TEST(RandUtilPerfTest, InsecureRandomRandUint64) {
   ASSERT_NE(inclusive_or, static_cast<uint64_t>(0));
 }
 
+TEST(RandUtilPerfTest, FastRandUint64) {
+  uint64_t inclusive_or = 0;
+  constexpr int kIterations = 1e7;
+
+  auto before = base::TimeTicks::Now();
+  for (int iter = 0; iter < kIterations; iter++) {
+    inclusive_or |= base::FastRandUint64();
+  }
+  auto after = base::TimeTicks::Now();
+
+  perf_test::PerfResultReporter reporter(kMetricPrefix, "FastRandUint64");
+  reporter.RegisterImportantMetric(kThroughput, "ns / iteration");
+
+  uint64_t nanos_per_iteration = (after - before).InNanoseconds() / kIterations;
+  reporter.AddResult("throughput", static_cast<size_t>(nanos_per_iteration));
+  ASSERT_NE(inclusive_or, static_cast<uint64_t>(0));
+}
+
+TEST(RandUtilPerfTest, RandBytes16) {
+  uint8_t inclusive_or = 0;
+  constexpr int kIterations = 1e6;
+
+  auto before = base::TimeTicks::Now();
+  for (int iter = 0; iter < kIterations; iter++) {
+    uint8_t bytes[16];
+    base::RandBytes(bytes, sizeof(bytes));
+    inclusive_or |= bytes[0];
+  }
+  auto after = base::TimeTicks::Now();
+
+  perf_test::PerfResultReporter reporter(kMetricPrefix, "RandBytes16");
+  reporter.RegisterImportantMetric(kThroughput, "ns / iteration");
+
+  uint64_t nanos_per_iteration = (after - before).InNanoseconds() / kIterations;
+  reporter.AddResult("throughput", static_cast<size_t>(nanos_per_iteration));
+  ASSERT_NE(inclusive_or, 0);
+}
+
 }  // namespace base
@@ -8,8 +8,11 @@
 #include <fcntl.h>
 #include <stddef.h>
 #include <stdint.h>
+#include <string.h>
 #include <unistd.h>
 
+#include <algorithm>
+
 #include "base/check.h"
 #include "base/compiler_specific.h"
 #include "base/files/file_util.h"
@@ -18,6 +21,8 @@
 #include "build/build_config.h"
 
 #if (BUILDFLAG(IS_LINUX) || BUILDFLAG(IS_CHROMEOS)) && !BUILDFLAG(IS_NACL)
+#include <sys/mman.h>
+
 #include "third_party/lss/linux_syscall_support.h"
 #elif BUILDFLAG(IS_MAC)
 // TODO(crbug.com/995996): Waiting for this header to appear in the iOS SDK.
@@ -52,6 +57,131 @@ class URandomFd {
   const int fd_;
 };
 
+#if (BUILDFLAG(IS_LINUX) || BUILDFLAG(IS_CHROMEOS)) && !BUILDFLAG(IS_NACL)
+
+// Larger requests amortize their getrandom() call.
+constexpr size_t kMaxBufferedRequest = 256;
+constexpr size_t kChaChaBlockSize = 64;
+constexpr size_t kChaChaBlocksPerRefill = 32;
+// The key is replaced with one from getrandom() every 1 MiB or so.
+constexpr uint32_t kRefillsPerReseed = 512;
+
+// The output of a ChaCha20 key, of which the first 32 bytes become the next
+// key at each refill (fast key erasure), and the bytes given out are zeroed,
+// so that the buffer never reveals past outputs. It lives in a page of its
+// own, which MADV_WIPEONFORK zeroes in forked children, whatever the way they
+// were forked, so that they never repeat the outputs of their parent.
+struct RandBuffer {
+  // Whether |key| came from getrandom() in this process.
+  bool keyed;
+  // Set while serving a request, so that a signal handler which interrupts it
+  // falls back to getrandom().
+  bool in_use;
+  uint32_t refills_until_reseed;
+  uint32_t key[8];
+  // The unused bytes are the last |available| ones.
+  size_t available;
+  uint8_t bytes[kChaChaBlocksPerRefill * kChaChaBlockSize];
+};
+
+RandBuffer* CreateRandBuffer() {
+  void* memory = mmap(nullptr, sizeof(RandBuffer), PROT_READ | PROT_WRITE,
+                      MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+  if (memory == MAP_FAILED)
+    return nullptr;
+  // Without MADV_WIPEONFORK (Linux 4.14+), the outputs are never buffered.
+  if (madvise(memory, sizeof(RandBuffer), MADV_WIPEONFORK) != 0) {
+    munmap(memory, sizeof(RandBuffer));
+    return nullptr;
+  }
+  return static_cast<RandBuffer*>(memory);
+}
+
+// Owns the buffer of its thread, until the thread exits.
+struct RandBufferHolder {
+  ~RandBufferHolder();
+
+  RandBuffer* buffer = nullptr;
+};
+
+// Set once the buffer of the thread can't be created or was destroyed, after
+// which the requests go to getrandom(). Trivially destructible, so that it
+// can be read after |g_tls_rand_buffer_holder| is destroyed.
+thread_local bool g_tls_rand_buffer_unavailable = false;
+thread_local RandBufferHolder g_tls_rand_buffer_holder;
+
+RandBufferHolder::~RandBufferHolder() {
+  g_tls_rand_buffer_unavailable = true;
+  if (buffer)
+    munmap(buffer, sizeof(RandBuffer));
+}
+
+RandBuffer* GetRandBuffer() {
+  if (g_tls_rand_buffer_unavailable)
+    return nullptr;
+  RandBufferHolder& holder = g_tls_rand_buffer_holder;
+  if (!holder.buffer) {
+    holder.buffer = CreateRandBuffer();
+    if (!holder.buffer) {
+      g_tls_rand_buffer_unavailable = true;
+      return nullptr;
+    }
+  }
+  return holder.buffer;
+}
+
+bool RefillRandBuffer(RandBuffer* buffer) {
+  if (!buffer->keyed || buffer->refills_until_reseed == 0) {
+    const ssize_t r =
+        HANDLE_EINTR(sys_getrandom(buffer->key, sizeof(buffer->key), 0));
+    if (r != static_cast<ssize_t>(sizeof(buffer->key)))
+      return false;
+    MSAN_UNPOISON(buffer->key, sizeof(buffer->key));
+    buffer->keyed = true;
+    buffer->refills_until_reseed = kRefillsPerReseed;
+  }
+  --buffer->refills_until_reseed;
+
+  static constexpr uint32_t kNonce[3] = {};
+  for (size_t i = 0; i < kChaChaBlocksPerRefill; ++i) {
+    base::internal::ChaCha20Block(buffer->key, static_cast<uint32_t>(i),
+                                  kNonce,
+                                  buffer->bytes + i * kChaChaBlockSize);
+  }
+  memcpy(buffer->key, buffer->bytes, sizeof(buffer->key));
+  memset(buffer->bytes, 0, sizeof(buffer->key));
+  buffer->available = sizeof(buffer->bytes) - sizeof(buffer->key);
+  return true;
+}
+
+// Fills |output| from the buffer of the current thread. Returns false if it
+// can't, e.g. without getrandom() or MADV_WIPEONFORK.
+bool BufferedRandBytes(void* output, size_t output_length) {
+  RandBuffer* buffer = GetRandBuffer();
+  if (!buffer || buffer->in_use)
+    return false;
+  buffer->in_use = true;
+  uint8_t* out = static_cast<uint8_t*>(output);
+  while (output_length) {
+    if (!buffer->available && !RefillRandBuffer(buffer)) {
+      buffer->in_use = false;
+      return false;
+    }
+    const size_t size = std::min(output_length, buffer->available);
+    uint8_t* bytes = buffer->bytes + sizeof(buffer->bytes) - buffer->available;
+    memcpy(out, bytes, size);
+    memset(bytes, 0, size);
+    buffer->available -= size;
+    out += size;
+    output_length -= size;
+  }
+  buffer->in_use = false;
+  return true;
+}
+
+#endif  // (BUILDFLAG(IS_LINUX) || BUILDFLAG(IS_CHROMEOS)) &&
+        // !BUILDFLAG(IS_NACL)
+
 }  // namespace
 
 namespace base {
@@ -63,6 +193,11 @@ namespace base {
 // it or some form of it.
 void RandBytes(void* output, size_t output_length) {
 #if (BUILDFLAG(IS_LINUX) || BUILDFLAG(IS_CHROMEOS)) && !BUILDFLAG(IS_NACL)
+  if (output_length <= kMaxBufferedRequest &&
+      BufferedRandBytes(output, output_length)) {
+    return;
+  }
+
   // We have to call `getrandom` via Linux Syscall Support, rather than through
   // the libc wrapper, because we might not have an up-to-date libc (e.g. on
   // some bots).
@@ -15,8 +15,16 @@
 
 #include "base/logging.h"
 #include "base/time/time.h"
+#include "build/build_config.h"
 #include "testing/gtest/include/gtest/gtest.h"
 
+#if BUILDFLAG(IS_POSIX)
+#include <sys/wait.h>
+#include <unistd.h>
+
+#include "base/posix/eintr_wrapper.h"
+#endif
+
 namespace base {
 
 namespace {
@@ -173,6 +181,96 @@ TEST(RandUtilTest, DISABLED_RandBytesPerf) {
             << ") took: " << (end - now).InMicroseconds() << "µs";
 }
 
+#if BUILDFLAG(IS_POSIX)
+TEST(RandUtilTest, RandBytesDifferAfterFork) {
+  // Leaves bytes in the buffer of the thread, which the child must not reuse.
+  uint64_t parent_value;
+  base::RandBytes(&parent_value, sizeof(parent_value));
+  base::RandBytes(&parent_value, sizeof(parent_value));
+
+  int fds[2];
+  ASSERT_EQ(pipe(fds), 0);
+  const pid_t pid = fork();
+  ASSERT_GE(pid, 0);
+  if (pid == 0) {
+    close(fds[0]);
+    uint64_t child_value;
+    base::RandBytes(&child_value, sizeof(child_value));
+    const bool written = HANDLE_EINTR(write(fds[1], &child_value,
+                                            sizeof(child_value))) ==
+                         static_cast<ssize_t>(sizeof(child_value));
+    _exit(written ? 0 : 1);
+  }
+  close(fds[1]);
+  uint64_t child_value = 0;
+  EXPECT_EQ(HANDLE_EINTR(read(fds[0], &child_value, sizeof(child_value))),
+            static_cast<ssize_t>(sizeof(child_value)));
+  close(fds[0]);
+  int status;
+  ASSERT_EQ(HANDLE_EINTR(waitpid(pid, &status, 0)), pid);
+  EXPECT_TRUE(WIFEXITED(status) && WEXITSTATUS(status) == 0);
+
+  base::RandBytes(&parent_value, sizeof(parent_value));
+  EXPECT_NE(child_value, parent_value);
+}
+#endif  // BUILDFLAG(IS_POSIX)
+
+TEST(RandUtilTest, ChaCha20Block) {
+  // The test vector of RFC 8439, section 2.3.2.
+  uint32_t key[8];
+  for (uint32_t i = 0; i < 8; ++i) {
+    key[i] = (4 * i) | (4 * i + 1) << 8 | (4 * i + 2) << 16 |
+             (4 * i + 3) << 24;
+  }
+  const uint32_t nonce[3] = {0x09000000, 0x4a000000, 0x00000000};
+  const uint8_t kExpected[64] = {
+      0x10, 0xf1, 0xe7, 0xe4, 0xd1, 0x3b, 0x59, 0x15, 0x50, 0x0f, 0xdd,
+      0x1f, 0xa3, 0x20, 0x71, 0xc4, 0xc7, 0xd1, 0xf4, 0xc7, 0x33, 0xc0,
+      0x68, 0x03, 0x04, 0x22, 0xaa, 0x9a, 0xc3, 0xd4, 0x6c, 0x4e, 0xd2,
+      0x82, 0x64, 0x46, 0x07, 0x9f, 0xaa, 0x09, 0x14, 0xc2, 0xd7, 0x05,
+      0xd9, 0x8b, 0x02, 0xa2, 0xb5, 0x12, 0x9c, 0xd1, 0xde, 0x16, 0x4e,
+      0xb9, 0xcb, 0xd0, 0x83, 0xe8, 0xa2, 0x50, 0x3c, 0x4e};
+  uint8_t output[64];
+  internal::ChaCha20Block(key, 1, nonce, output);
+  EXPECT_EQ(memcmp(output, kExpected, sizeof(output)), 0);
+}
+
+TEST(RandUtilTest, FastRandUint64ProducesBothValuesOfAllBits) {
+  uint64_t found_ones = 0;
+  uint64_t found_zeros = ~found_ones;
+  for (size_t i = 0; i < 1000; ++i) {
+    uint64_t value = base::FastRandUint64();
+    found_ones |= value;
+    found_zeros &= value;
+
+    if (found_zeros == 0 && found_ones == ~uint64_t{0})
+      return;
+  }
+
+  FAIL() << "Didn't achieve all bit values in maximum number of tries.";
+}
+
+TEST(RandUtilTest, FastRandRanges) {
+  EXPECT_EQ(base::FastRandInt(kIntMin, kIntMin), kIntMin);
+  EXPECT_EQ(base::FastRandInt(kIntMax, kIntMax), kIntMax);
+  for (int i = 0; i < 1000; ++i) {
+    const int value = base::FastRandInt(-3, 3);
+    EXPECT_GE(value, -3);
+    EXPECT_LE(value, 3);
+    EXPECT_LT(base::FastRandGenerator(7), 7u);
+    volatile double number = base::FastRandDouble();
+    EXPECT_GE(number, 0.);
+    EXPECT_LT(number, 1.);
+  }
+  for (int i = 0; i < 40; ++i)
+    base::FastRandInt(kIntMin, kIntMax);
+
+  std::vector<int> values = {1, 2, 3, 4, 5};
+  std::shuffle(values.begin(), values.end(), base::FastRandomBitGenerator());
+  std::sort(values.begin(), values.end());
+  EXPECT_EQ(values, std::vector<int>({1, 2, 3, 4, 5}));
+}
+
 TEST(RandUtilTest, InsecureRandomGeneratorProducesBothValuesOfAllBits) {
   // This tests to see that our underlying random generator is good
   // enough, for some value of good enough.
@@ -0,0 +1,135 @@
+// Copyright 2022 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include <string>
+#include <vector>
+
+#include "base/numerics/batch_math.h"
+#include "base/numerics/safe_math.h"
+#include "base/rand_util.h"
+#include "base/time/time.h"
+#include "testing/gtest/include/gtest/gtest.h"
+#include "testing/perf/perf_result_reporter.h"
+
+namespace base {
+
+namespace {
+
+constexpr size_t kSize = 64 * 1024;
+constexpr int kCount = 2000;
+
+constexpr char kMetricPrefixSafeNumerics[] = "SafeNumerics.";
+constexpr char kMetricTimePerElement[] = "time_per_element";
+
+perf_test::PerfResultReporter SetUpReporter(const std::string& story_name) {
+  perf_test::PerfResultReporter reporter(kMetricPrefixSafeNumerics,
+                                         story_name);
+  reporter.RegisterImportantMetric(kMetricTimePerElement, "ns");
+  return reporter;
+}
+
+// Runs |function| over kSize elements kCount times, and reports the time per
+// element.
+template <typename Function>
+void Measure(const std::string& story_name, Function function) {
+  const TimeTicks start = TimeTicks::Now();
+  for (int i = 0; i < kCount; ++i)
+    function();
+  const TimeDelta elapsed = TimeTicks::Now() - start;
+  SetUpReporter(story_name)
+      .AddResult(kMetricTimePerElement,
+                 static_cast<double>(elapsed.InNanoseconds()) /
+                     (kCount * kSize));
+}
+
+template <typename T>
+std::vector<T> MakeRandomVector() {
+  std::vector<T> values(kSize);
+  RandBytes(values.data(), values.size() * sizeof(T));
+  return values;
+}
+
+}  // namespace
+
+TEST(SafeNumericsPerfTest, ClampAdd) {
+  const std::vector<int16_t> lhs = MakeRandomVector<int16_t>();
+  const std::vector<int16_t> rhs = MakeRandomVector<int16_t>();
+  std::vector<int16_t> out(kSize);
+  Measure("clamp_add_int16_scalar", [&] {
+    for (size_t i = 0; i < kSize; ++i)
+      out[i] = ClampAdd(lhs[i], rhs[i]);
+  });
+  Measure("clamp_add_int16_batch",
+          [&] { ClampAddBatch(lhs.data(), rhs.data(), out.data(), kSize); });
+
+  const std::vector<int32_t> lhs32 = MakeRandomVector<int32_t>();
+  const std::vector<int32_t> rhs32 = MakeRandomVector<int32_t>();
+  std::vector<int32_t> out32(kSize);
+  Measure("clamp_add_int32_scalar", [&] {
+    for (size_t i = 0; i < kSize; ++i)
+      out32[i] = ClampAdd(lhs32[i], rhs32[i]);
+  });
+  Measure("clamp_add_int32_batch", [&] {
+    ClampAddBatch(lhs32.data(), rhs32.data(), out32.data(), kSize);
+  });
+}
+
+TEST(SafeNumericsPerfTest, ClampMul) {
+  const std::vector<int16_t> lhs = MakeRandomVector<int16_t>();
+  const std::vector<int16_t> rhs = MakeRandomVector<int16_t>();
+  std::vector<int16_t> out(kSize);
+  Measure("clamp_mul_int16_scalar", [&] {
+    for (size_t i = 0; i < kSize; ++i)
+      out[i] = ClampMul(lhs[i], rhs[i]);
+  });
+  Measure("clamp_mul_int16_batch",
+          [&] { ClampMulBatch(lhs.data(), rhs.data(), out.data(), kSize); });
+}
+
+// Audio samples, from float to 16 bits, and pixels, from 32 to 8 bits.
+TEST(SafeNumericsPerfTest, SaturatedCast) {
+  std::vector<float> samples(kSize);
+  for (size_t i = 0; i < kSize; ++i)
+    samples[i] = static_cast<float>(RandDouble() * 80000.0 - 40000.0);
+  std::vector<int16_t> samples16(kSize);
+  Measure("saturated_cast_float_int16_scalar", [&] {
+    for (size_t i = 0; i < kSize; ++i)
+      samples16[i] = saturated_cast<int16_t>(samples[i]);
+  });
+  Measure("saturated_cast_float_int16_batch", [&] {
+    SaturatedCastBatch(samples.data(), samples16.data(), kSize);
+  });
+
+  std::vector<int32_t> pixels(kSize);
+  for (size_t i = 0; i < kSize; ++i)
+    pixels[i] = RandInt(-100, 400);
+  std::vector<uint8_t> pixels8(kSize);
+  Measure("saturated_cast_int32_uint8_scalar", [&] {
+    for (size_t i = 0; i < kSize; ++i)
+      pixels8[i] = saturated_cast<uint8_t>(pixels[i]);
+  });
+  Measure("saturated_cast_int32_uint8_batch", [&] {
+    SaturatedCastBatch(pixels.data(), pixels8.data(), kSize);
+  });
+}
+
+TEST(SafeNumericsPerfTest, CheckedSum) {
+  const std::vector<int16_t> samples = MakeRandomVector<int16_t>();
+  bool valid = true;
+  Measure("checked_sum_int16_scalar", [&] {
+    CheckedNumeric<int32_t> sum = 0;
+    for (int16_t sample : samples)
+      sum += sample;
+    valid &= sum.IsValid();
+  });
+  Measure("checked_sum_int16_batch", [&] {
+    valid &= CheckedSumBatch<int32_t>(samples.data(), kSize).IsValid();
+  });
+  EXPECT_TRUE(valid);
+}
+
+}  // namespace base
@@ -6,7 +6,9 @@
 #include <stdint.h>
 
 #include <limits>
+#include <random>
 #include <type_traits>
+#include <vector>
 
 #include "base/compiler_specific.h"
 #include "build/build_config.h"
@@ -27,6 +29,7 @@
 #endif
 
 #include "base/logging.h"
+#include "base/numerics/batch_math.h"
 #include "base/numerics/safe_conversions.h"
 #include "base/numerics/safe_math.h"
 #include "base/test/gtest_util.h"
@@ -1838,6 +1841,187 @@ TEST(SafeNumerics, Int64) {
   EXPECT_EQ(0, ClampRound<int64_t>(-kNaN));
 }
 
+// Returns |size| values of T for the batch operations, a mix of the limits of
+// T, values around zero and random values.
+template <typename T>
+std::vector<T> MakeBatchValues(size_t size, std::mt19937* generator) {
+  using Limits = numeric_limits<T>;
+  std::vector<T> values(size);
+  for (T& value : values) {
+    switch ((*generator)() % 4) {
+      case 0: {
+        const T kSpecial[] = {Limits::lowest(), Limits::max(), T(0), T(1),
+                              static_cast<T>(Limits::lowest() + 1),
+                              static_cast<T>(Limits::max() - 1)};
+        value = kSpecial[(*generator)() % std::size(kSpecial)];
+        break;
+      }
+      case 1:
+        value = static_cast<T>((*generator)() % 32);
+        if (Limits::is_signed)
+          value = static_cast<T>(value - 16);
+        break;
+      default:
+        if (std::is_floating_point<T>::value) {
+          value = static_cast<T>(
+              std::uniform_real_distribution<double>(-1e10, 1e10)(*generator));
+        } else {
+          value = static_cast<T>((*generator)());
+        }
+        break;
+    }
+  }
+  return values;
+}
+
+// Checks the batch operations of T against the scalar ones, for arrays of all
+// sizes up to a few vectors.
+template <typename T>
+void TestClampBatch() {
+  std::mt19937 generator(42);
+  for (size_t size = 0; size <= 100; ++size) {
+    const std::vector<T> lhs = MakeBatchValues<T>(size, &generator);
+    const std::vector<T> rhs = MakeBatchValues<T>(size, &generator);
+    std::vector<T> out(size);
+    ClampAddBatch(lhs.data(), rhs.data(), out.data(), size);
+    for (size_t i = 0; i < size; ++i) {
+      EXPECT_EQ(static_cast<T>(ClampAdd(lhs[i], rhs[i])), out[i])
+          << +lhs[i] << " + " << +rhs[i];
+    }
+    ClampSubBatch(lhs.data(), rhs.data(), out.data(), size);
+    for (size_t i = 0; i < size; ++i) {
+      EXPECT_EQ(static_cast<T>(ClampSub(lhs[i], rhs[i])), out[i])
+          << +lhs[i] << " - " << +rhs[i];
+    }
+    ClampMulBatch(lhs.data(), rhs.data(), out.data(), size);
+    for (size_t i = 0; i < size; ++i) {
+      EXPECT_EQ(static_cast<T>(ClampMul(lhs[i], rhs[i])), out[i])
+          << +lhs[i] << " * " << +rhs[i];
+    }
+
+    // In place.
+    out = lhs;
+    ClampAddBatch(out.data(), rhs.data(), out.data(), size);
+    for (size_t i = 0; i < size; ++i)
+      EXPECT_EQ(static_cast<T>(ClampAdd(lhs[i], rhs[i])), out[i]);
+  }
+}
+
+TEST(SafeNumerics, ClampBatch) {
+  TestClampBatch<int8_t>();
+  TestClampBatch<uint8_t>();
+  TestClampBatch<int16_t>();
+  TestClampBatch<uint16_t>();
+  TestClampBatch<int32_t>();
+  TestClampBatch<uint32_t>();
+  TestClampBatch<int64_t>();
+  TestClampBatch<float>();
+}
+
+template <typename Dst, typename Src>
+void TestSaturatedCastBatch() {
+  std::mt19937 generator(42);
+  for (size_t size = 0; size <= 100; ++size) {
+    std::vector<Src> src = MakeBatchValues<Src>(size, &generator);
+    if (std::is_floating_point<Src>::value && size > 0) {
+      // Values at and around the limits of the integer types, and NaN.
+      const Src kSpecial[] = {
+          std::numeric_limits<Src>::quiet_NaN(),
+          std::numeric_limits<Src>::infinity(),
+          -std::numeric_limits<Src>::infinity(),
+          static_cast<Src>(2147483648.0),
+          static_cast<Src>(2147483520.0),
+          static_cast<Src>(-2147483648.0),
+          static_cast<Src>(-2147483904.0),
+          static_cast<Src>(32767.5),
+          static_cast<Src>(-32768.9),
+          static_cast<Src>(255.9),
+          static_cast<Src>(256.0),
+          static_cast<Src>(-0.9),
+          static_cast<Src>(-1.0)};
+      for (size_t i = 0; i < size; i += 3)
+        src[i] = kSpecial[generator() % std::size(kSpecial)];
+    }
+    std::vector<Dst> dst(size);
+    SaturatedCastBatch(src.data(), dst.data(), size);
+    for (size_t i = 0; i < size; ++i)
+      EXPECT_EQ(saturated_cast<Dst>(src[i]), dst[i]) << +src[i];
+  }
+}
+
+TEST(SafeNumerics, SaturatedCastBatch) {
+  TestSaturatedCastBatch<int16_t, int32_t>();
+  TestSaturatedCastBatch<uint16_t, int32_t>();
+  TestSaturatedCastBatch<int8_t, int32_t>();
+  TestSaturatedCastBatch<uint8_t, int32_t>();
+  TestSaturatedCastBatch<int8_t, int16_t>();
+  TestSaturatedCastBatch<uint8_t, int16_t>();
+  TestSaturatedCastBatch<uint8_t, uint16_t>();
+  TestSaturatedCastBatch<int32_t, float>();
+  TestSaturatedCastBatch<int16_t, float>();
+  TestSaturatedCastBatch<uint8_t, float>();
+  TestSaturatedCastBatch<int8_t, uint32_t>();
+  TestSaturatedCastBatch<int32_t, double>();
+}
+
+// Checks CheckedSumBatch() against adding the elements one by one. The values
+// are biased towards one sign, so that some sums leave the range of Acc and
+// some don't.
+template <typename Acc, typename T>
+void TestCheckedSumBatch() {
+  std::mt19937 generator(42);
+  for (size_t size : {0, 1, 15, 17, 100, 4095, 4096, 4097, 20000}) {
+    for (int bias = 0; bias < 4; ++bias) {
+      std::vector<T> data = MakeBatchValues<T>(size, &generator);
+      for (T& value : data) {
+        if (bias == 1 && value < 0)
+          value = static_cast<T>(-(value + 1));
+        if (bias == 2 && value > 0)
+          value = static_cast<T>(-value);
+        if (bias == 3)
+          value = static_cast<T>(value / 64);
+      }
+      CheckedNumeric<Acc> expected = 0;
+      for (T value : data)
+        expected += value;
+      const CheckedNumeric<Acc> sum = CheckedSumBatch<Acc>(data.data(), size);
+      EXPECT_EQ(expected.IsValid(), sum.IsValid()) << size << " " << bias;
+      if (expected.IsValid() && sum.IsValid())
+        EXPECT_EQ(expected.ValueOrDie(), sum.ValueOrDie());
+    }
+  }
+}
+
+TEST(SafeNumerics, CheckedSumBatch) {
+  TestCheckedSumBatch<int32_t, int8_t>();
+  TestCheckedSumBatch<int16_t, int8_t>();
+  TestCheckedSumBatch<uint16_t, uint8_t>();
+  TestCheckedSumBatch<int32_t, uint8_t>();
+  TestCheckedSumBatch<int32_t, int16_t>();
+  TestCheckedSumBatch<int16_t, int16_t>();
+  TestCheckedSumBatch<uint32_t, uint16_t>();
+  TestCheckedSumBatch<uint16_t, int16_t>();
+  TestCheckedSumBatch<int32_t, int32_t>();
+  TestCheckedSumBatch<int64_t, int32_t>();
+  TestCheckedSumBatch<uint32_t, uint32_t>();
+  TestCheckedSumBatch<uint64_t, int32_t>();
+}
+
+// A partial sum out of range makes the sum invalid, even if the full sum
+// fits.
+TEST(SafeNumerics, CheckedSumBatchPartialSums) {
+  std::vector<int16_t> data(1000, 1);
+  data[500] = numeric_limits<int16_t>::max();
+  data[501] = numeric_limits<int16_t>::lowest();
+  EXPECT_TRUE(CheckedSumBatch<int32_t>(data.data(), data.size()).IsValid());
+  EXPECT_FALSE(CheckedSumBatch<int16_t>(data.data(), data.size()).IsValid());
+  data[500] = numeric_limits<int16_t>::lowest();
+  data[501] = numeric_limits<int16_t>::max();
+  EXPECT_TRUE(CheckedSumBatch<int16_t>(data.data(), data.size()).IsValid());
+  EXPECT_EQ(997, CheckedSumBatch<int16_t>(data.data(), data.size())
+                     .ValueOrDie());
+}
+
 #if defined(__clang__)
 #pragma clang diagnostic pop  // -Winteger-overflow
 #endif
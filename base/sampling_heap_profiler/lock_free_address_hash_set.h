@@ -70,6 +70,9 @@ class BASE_EXPORT LockFreeAddressHashSet {
   // Returns the average bucket utilization.
   float load_factor() const { return 1.f * size() / buckets_.size(); }
 
+  // The hash function of the set, shared with LockFreeSampleTable.
+  ALWAYS_INLINE static uint32_t Hash(void* key);
+
  private:
   friend class LockFreeAddressHashSetTest;
 
@@ -79,7 +82,6 @@ class BASE_EXPORT LockFreeAddressHashSet {
     Node* next;
   };
 
-  ALWAYS_INLINE static uint32_t Hash(void* key);
   ALWAYS_INLINE Node* FindNode(void* key) const;
 
   std::vector<std::atomic<Node*>> buckets_;
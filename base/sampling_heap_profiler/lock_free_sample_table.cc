@@ -0,0 +1,146 @@
+// Copyright 2022 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "base/sampling_heap_profiler/lock_free_sample_table.h"
+
+#include <algorithm>
+
+#include "base/bits.h"
+#include "base/check.h"
+#include "base/sampling_heap_profiler/lock_free_address_hash_set.h"
+
+namespace base {
+
+LockFreeSampleTable::LockFreeSampleTable(size_t capacity)
+    : slots_(new Slot[capacity]),
+      capacity_(capacity),
+      probe_count_(std::min(capacity, kMaxProbeCount)) {
+  DCHECK(bits::IsPowerOfTwo(capacity));
+}
+
+LockFreeSampleTable::~LockFreeSampleTable() = default;
+
+bool LockFreeSampleTable::Insert(const Record& record) {
+  const uintptr_t address = reinterpret_cast<uintptr_t>(record.address);
+  DCHECK(IsAddress(address));
+  const size_t mask = capacity_ - 1;
+  const size_t first = LockFreeAddressHashSet::Hash(record.address) & mask;
+  for (size_t i = 0; i < probe_count_; ++i) {
+    Slot& slot = slots_[(first + i) & mask];
+    uintptr_t key = slot.key.load(std::memory_order_relaxed);
+    DCHECK_NE(key, address);
+    if ((key != kEmptyKey && key != kRemovedKey) ||
+        !slot.key.compare_exchange_strong(key, kReservedKey,
+                                          std::memory_order_acquire,
+                                          std::memory_order_relaxed)) {
+      continue;
+    }
+    WriteRecord(record, &slot);
+    slot.key.store(address, std::memory_order_release);
+    size_.fetch_add(1, std::memory_order_relaxed);
+    return true;
+  }
+  dropped_count_.fetch_add(1, std::memory_order_relaxed);
+  return false;
+}
+
+bool LockFreeSampleTable::Remove(void* address) {
+  const uintptr_t key = reinterpret_cast<uintptr_t>(address);
+  DCHECK(IsAddress(key));
+  const size_t mask = capacity_ - 1;
+  const size_t first = LockFreeAddressHashSet::Hash(address) & mask;
+  for (size_t i = 0; i < probe_count_; ++i) {
+    Slot& slot = slots_[(first + i) & mask];
+    // The acquire and release orders chain the writes of the record to the
+    // next |Insert| reusing the slot, so that it sees the latest sequence.
+    uintptr_t slot_key = slot.key.load(std::memory_order_acquire);
+    if (slot_key == key) {
+      // The compare-and-swap only fails if |Clear| removed the key.
+      if (!slot.key.compare_exchange_strong(slot_key, kRemovedKey,
+                                            std::memory_order_acq_rel,
+                                            std::memory_order_relaxed)) {
+        return false;
+      }
+      size_.fetch_sub(1, std::memory_order_relaxed);
+      return true;
+    }
+    // Slots never become empty again once taken, so the key would have been
+    // stored in this slot or before.
+    if (slot_key == kEmptyKey)
+      return false;
+  }
+  return false;
+}
+
+void LockFreeSampleTable::Clear() {
+  for (size_t i = 0; i < capacity_; ++i) {
+    Slot& slot = slots_[i];
+    uintptr_t key = slot.key.load(std::memory_order_acquire);
+    // The slots being written to are left to their writers. The slots must not
+    // become empty, so that |Remove| keeps probing past them.
+    if (IsAddress(key) &&
+        slot.key.compare_exchange_strong(key, kRemovedKey,
+                                         std::memory_order_acq_rel,
+                                         std::memory_order_relaxed)) {
+      size_.fetch_sub(1, std::memory_order_relaxed);
+    }
+  }
+}
+
+std::vector<LockFreeSampleTable::Record> LockFreeSampleTable::GetRecords()
+    const {
+  std::vector<Record> records;
+  records.reserve(size());
+  Record record;
+  for (size_t i = 0; i < capacity_; ++i) {
+    if (ReadRecord(slots_[i], &record))
+      records.push_back(record);
+  }
+  return records;
+}
+
+// static
+void LockFreeSampleTable::WriteRecord(const Record& record, Slot* slot) {
+  // The slot is reserved, so this is its only writer.
+  const uint32_t sequence = slot->sequence.load(std::memory_order_relaxed);
+  slot->sequence.store(sequence + 1, std::memory_order_relaxed);
+  // Orders the record writes after the sequence becoming odd, for the readers
+  // which see any of them.
+  std::atomic_thread_fence(std::memory_order_release);
+  slot->ordinal.store(record.ordinal, std::memory_order_relaxed);
+  slot->size.store(record.size, std::memory_order_relaxed);
+  slot->total.store(record.total, std::memory_order_relaxed);
+  slot->allocator.store(record.allocator, std::memory_order_relaxed);
+  slot->context.store(record.context, std::memory_order_relaxed);
+  slot->thread_name.store(record.thread_name, std::memory_order_relaxed);
+  slot->stack.store(record.stack, std::memory_order_relaxed);
+  slot->sequence.store(sequence + 2, std::memory_order_release);
+}
+
+// static
+bool LockFreeSampleTable::ReadRecord(const Slot& slot, Record* record) {
+  while (true) {
+    const uint32_t sequence = slot.sequence.load(std::memory_order_acquire);
+    const uintptr_t key = slot.key.load(std::memory_order_acquire);
+    if (!IsAddress(key))
+      return false;
+    if (sequence & 1)
+      continue;
+    record->address = reinterpret_cast<void*>(key);
+    record->ordinal = slot.ordinal.load(std::memory_order_relaxed);
+    record->size = slot.size.load(std::memory_order_relaxed);
+    record->total = slot.total.load(std::memory_order_relaxed);
+    record->allocator = slot.allocator.load(std::memory_order_relaxed);
+    record->context = slot.context.load(std::memory_order_relaxed);
+    record->thread_name = slot.thread_name.load(std::memory_order_relaxed);
+    record->stack = slot.stack.load(std::memory_order_relaxed);
+    // Orders the sequence check after the record reads: if any of them saw a
+    // concurrent write, so does the check.
+    std::atomic_thread_fence(std::memory_order_acquire);
+    if (slot.sequence.load(std::memory_order_relaxed) == sequence)
+      return true;
+  }
+}
+
+}  // namespace base
@@ -0,0 +1,123 @@
+// Copyright 2022 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#ifndef BASE_SAMPLING_HEAP_PROFILER_LOCK_FREE_SAMPLE_TABLE_H_
+#define BASE_SAMPLING_HEAP_PROFILER_LOCK_FREE_SAMPLE_TABLE_H_
+
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+#include "base/base_export.h"
+#include "base/sampling_heap_profiler/poisson_allocation_sampler.h"
+#include "base/sampling_heap_profiler/stack_depot.h"
+
+namespace base {
+
+// A fixed-capacity hash table of the samples of the live allocations, keyed by
+// address, for SamplingHeapProfiler. Unlike LockFreeAddressHashSet, whose
+// writes have to be guarded by a lock, |Insert| and |Remove| are lock-free
+// and can be executed concurrently with each other, and with |GetRecords|.
+// They never allocate, so they can be called from the allocator hooks.
+//
+// The table is an array of slots with open addressing: a key is stored in one
+// of the |kMaxProbeCount| slots following its hash, and |Insert| fails if they
+// are all taken. The table never rehashes or grows.
+//
+// Each slot is owned by a single writer at a time: |Insert| takes an empty or
+// removed slot with a compare-and-swap of its key, writes the record, then
+// publishes the key. |Remove| only marks the slot as removed, so |Insert| can
+// reuse it. The records are read by |GetRecords| under a sequence lock, which
+// retries the slots written to while they were read.
+class BASE_EXPORT LockFreeSampleTable {
+ public:
+  struct Record {
+    void* address = nullptr;
+    size_t size = 0;
+    size_t total = 0;
+    PoissonAllocationSampler::AllocatorType allocator =
+        PoissonAllocationSampler::kMalloc;
+    const char* context = nullptr;
+    const char* thread_name = nullptr;
+    // Null if the stack couldn't be stored.
+    const StackDepot::Stack* stack = nullptr;
+    uint32_t ordinal = 0;
+  };
+
+  // The number of slots a key can be stored in.
+  static constexpr size_t kMaxProbeCount = 64;
+
+  // |capacity| has to be a power of 2.
+  explicit LockFreeSampleTable(size_t capacity);
+  LockFreeSampleTable(const LockFreeSampleTable&) = delete;
+  LockFreeSampleTable& operator=(const LockFreeSampleTable&) = delete;
+  ~LockFreeSampleTable();
+
+  // Inserts |record| for |record.address|, which must not be in the table.
+  // Returns false if the slots of the address are all taken.
+  bool Insert(const Record& record);
+
+  // Removes the record of |address|. Returns false if it isn't in the table.
+  // Must not be executed concurrently with the |Insert| of the same address.
+  bool Remove(void* address);
+
+  // Removes all the records. The records inserted concurrently may be kept.
+  void Clear();
+
+  // Returns the records of the table. The records inserted or removed
+  // concurrently may or may not be returned.
+  std::vector<Record> GetRecords() const;
+
+  size_t capacity() const { return capacity_; }
+
+  // The number of records in the table.
+  size_t size() const { return size_.load(std::memory_order_relaxed); }
+
+  // The number of records which weren't inserted because the table was full.
+  size_t dropped_count() const {
+    return dropped_count_.load(std::memory_order_relaxed);
+  }
+
+ private:
+  // The keys which aren't addresses. A slot is empty until it is first taken.
+  static constexpr uintptr_t kEmptyKey = 0;
+  static constexpr uintptr_t kRemovedKey = UINTPTR_MAX;
+  static constexpr uintptr_t kReservedKey = UINTPTR_MAX - 1;
+
+  struct Slot {
+    std::atomic<uintptr_t> key{kEmptyKey};
+    // Odd while the record is being written.
+    std::atomic<uint32_t> sequence{0};
+    std::atomic<uint32_t> ordinal{0};
+    std::atomic<size_t> size{0};
+    std::atomic<size_t> total{0};
+    std::atomic<PoissonAllocationSampler::AllocatorType> allocator{
+        PoissonAllocationSampler::kMalloc};
+    std::atomic<const char*> context{nullptr};
+    std::atomic<const char*> thread_name{nullptr};
+    std::atomic<const StackDepot::Stack*> stack{nullptr};
+  };
+
+  static bool IsAddress(uintptr_t key) {
+    return key != kEmptyKey && key != kRemovedKey && key != kReservedKey;
+  }
+
+  static void WriteRecord(const Record& record, Slot* slot);
+
+  // Reads the record of |slot| into |record|. Returns false if the slot
+  // doesn't hold one.
+  static bool ReadRecord(const Slot& slot, Record* record);
+
+  const std::unique_ptr<Slot[]> slots_;
+  const size_t capacity_;
+  const size_t probe_count_;
+
+  std::atomic<size_t> size_{0};
+  std::atomic<size_t> dropped_count_{0};
+};
+
+}  // namespace base
+
+#endif  // BASE_SAMPLING_HEAP_PROFILER_LOCK_FREE_SAMPLE_TABLE_H_
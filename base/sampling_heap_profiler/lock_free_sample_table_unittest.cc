@@ -0,0 +1,156 @@
+// Copyright 2022 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "base/sampling_heap_profiler/lock_free_sample_table.h"
+
+#include <algorithm>
+#include <atomic>
+#include <memory>
+#include <vector>
+
+#include "base/memory/raw_ptr.h"
+#include "base/threading/simple_thread.h"
+#include "testing/gtest/include/gtest/gtest.h"
+
+namespace base {
+namespace {
+
+LockFreeSampleTable::Record MakeRecord(uintptr_t address) {
+  LockFreeSampleTable::Record record;
+  record.address = reinterpret_cast<void*>(address);
+  record.size = address;
+  record.total = address * 2;
+  record.ordinal = static_cast<uint32_t>(address);
+  return record;
+}
+
+// Checks that each record was written whole.
+void ExpectConsistent(const LockFreeSampleTable::Record& record) {
+  const uintptr_t address = reinterpret_cast<uintptr_t>(record.address);
+  EXPECT_EQ(address, record.size);
+  EXPECT_EQ(address * 2, record.total);
+  EXPECT_EQ(static_cast<uint32_t>(address), record.ordinal);
+}
+
+TEST(LockFreeSampleTableTest, EmptyTable) {
+  LockFreeSampleTable table(8);
+  EXPECT_EQ(0u, table.size());
+  EXPECT_EQ(8u, table.capacity());
+  EXPECT_TRUE(table.GetRecords().empty());
+  EXPECT_FALSE(table.Remove(&table));
+}
+
+TEST(LockFreeSampleTableTest, BasicOperations) {
+  LockFreeSampleTable table(256);
+  for (uintptr_t i = 1; i <= 100; ++i) {
+    EXPECT_TRUE(table.Insert(MakeRecord(i)));
+    EXPECT_EQ(i, table.size());
+  }
+  for (uintptr_t i = 3; i <= 100; i += 3)
+    EXPECT_TRUE(table.Remove(reinterpret_cast<void*>(i)));
+  // Removed every 3rd value (33 total) from the table, 67 have left.
+  EXPECT_EQ(67u, table.size());
+  EXPECT_FALSE(table.Remove(reinterpret_cast<void*>(3)));
+
+  std::vector<LockFreeSampleTable::Record> records = table.GetRecords();
+  ASSERT_EQ(67u, records.size());
+  for (const LockFreeSampleTable::Record& record : records) {
+    ExpectConsistent(record);
+    EXPECT_NE(0u, reinterpret_cast<uintptr_t>(record.address) % 3);
+  }
+
+  // The removed slots are reused.
+  for (uintptr_t i = 3; i <= 100; i += 3)
+    EXPECT_TRUE(table.Insert(MakeRecord(i)));
+  EXPECT_EQ(100u, table.size());
+  EXPECT_EQ(0u, table.dropped_count());
+}
+
+TEST(LockFreeSampleTableTest, Full) {
+  LockFreeSampleTable table(16);
+  for (uintptr_t i = 1; i <= 16; ++i)
+    EXPECT_TRUE(table.Insert(MakeRecord(i)));
+  EXPECT_FALSE(table.Insert(MakeRecord(17)));
+  EXPECT_EQ(16u, table.size());
+  EXPECT_EQ(1u, table.dropped_count());
+  EXPECT_FALSE(table.Remove(reinterpret_cast<void*>(17)));
+
+  EXPECT_TRUE(table.Remove(reinterpret_cast<void*>(5)));
+  EXPECT_TRUE(table.Insert(MakeRecord(17)));
+  EXPECT_TRUE(table.Remove(reinterpret_cast<void*>(17)));
+}
+
+TEST(LockFreeSampleTableTest, Clear) {
+  LockFreeSampleTable table(64);
+  for (uintptr_t i = 1; i <= 20; ++i)
+    table.Insert(MakeRecord(i));
+  table.Clear();
+  EXPECT_EQ(0u, table.size());
+  EXPECT_TRUE(table.GetRecords().empty());
+  EXPECT_FALSE(table.Remove(reinterpret_cast<void*>(1)));
+
+  EXPECT_TRUE(table.Insert(MakeRecord(1)));
+  EXPECT_EQ(1u, table.GetRecords().size());
+}
+
+class WriterThread : public SimpleThread {
+ public:
+  WriterThread(LockFreeSampleTable* table,
+               uintptr_t first_address,
+               std::atomic_bool* cancel)
+      : SimpleThread("WriterThread"),
+        table_(table),
+        first_address_(first_address),
+        cancel_(cancel) {}
+
+  void Run() override {
+    // Each thread writes to its own addresses, which share the slots of the
+    // other threads.
+    for (uintptr_t address = first_address_;
+         !cancel_->load(std::memory_order_acquire); address += 0x10) {
+      EXPECT_TRUE(table_->Insert(MakeRecord(address)));
+      EXPECT_TRUE(table_->Remove(reinterpret_cast<void*>(address)));
+    }
+  }
+
+ private:
+  raw_ptr<LockFreeSampleTable> table_;
+  const uintptr_t first_address_;
+  raw_ptr<std::atomic_bool> cancel_;
+};
+
+TEST(LockFreeSampleTableTest, ConcurrentAccess) {
+  // The purpose of this test is to make sure inserting and removing records
+  // concurrently does not disrupt the other records, nor the records read.
+  LockFreeSampleTable table(1024);
+  for (uintptr_t i = 1; i <= 100; ++i)
+    table.Insert(MakeRecord(i));
+
+  std::atomic_bool cancel(false);
+  std::vector<std::unique_ptr<WriterThread>> threads;
+  for (uintptr_t i = 0; i < 4; ++i) {
+    threads.push_back(
+        std::make_unique<WriterThread>(&table, 0x100000 + i, &cancel));
+    threads.back()->Start();
+  }
+
+  for (size_t k = 0; k < 1000; ++k) {
+    size_t stable_records = 0;
+    for (const LockFreeSampleTable::Record& record : table.GetRecords()) {
+      ExpectConsistent(record);
+      if (reinterpret_cast<uintptr_t>(record.address) <= 100)
+        ++stable_records;
+    }
+    EXPECT_EQ(100u, stable_records);
+  }
+  cancel.store(true, std::memory_order_release);
+  for (auto& thread : threads)
+    thread->Join();
+
+  EXPECT_EQ(100u, table.size());
+  EXPECT_EQ(0u, table.dropped_count());
+}
+
+}  // namespace
+}  // namespace base
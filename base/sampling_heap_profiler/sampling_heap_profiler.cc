@@ -6,6 +6,7 @@
 
 #include <algorithm>
 #include <cmath>
+#include <memory>
 #include <utility>
 
 #include "base/allocator/allocator_shim.h"
@@ -40,6 +41,19 @@ constexpr uint32_t kMaxStackEntries = 256;
 
 namespace {
 
+// The maximum number of samples of live allocations. With the sampling
+// interval of 100KB, it is enough for 3GB of live allocations.
+constexpr size_t kSampleTableCapacity = 32 * 1024;
+
+// The stack depot is sized for tens of thousands of distinct call stacks.
+constexpr size_t kStackDepotBucketsCount = 16 * 1024;
+constexpr size_t kStackDepotArenaSize = 8 * 1024 * 1024;
+
+// The capacity of the table of context strings, and the number of its slots a
+// string can be stored in.
+constexpr size_t kStringsCapacity = 4 * 1024;
+constexpr size_t kMaxStringProbeCount = 64;
+
 // If a thread name has been set from ThreadIdNameManager, use that. Otherwise,
 // gets the thread name from kernel if available or returns a string with id.
 // This function intentionally leaks the allocated strings since they are used
@@ -171,6 +185,14 @@ uint32_t SamplingHeapProfiler::Start() {
       poisson_allocation_sampler->SamplingInterval() / 1024);
 
   AutoLock lock(start_stop_mutex_);
+  if (!samples_) {
+    // The sample storage is allocated once, and must not record itself.
+    PoissonAllocationSampler::ScopedMuteThreadSamples no_samples_scope;
+    samples_ = std::make_unique<LockFreeSampleTable>(kSampleTableCapacity);
+    stack_depot_ = std::make_unique<StackDepot>(kStackDepotBucketsCount,
+                                                kStackDepotArenaSize);
+    strings_ = std::make_unique<std::atomic<const char*>[]>(kStringsCapacity);
+  }
   if (!running_sessions_++)
     poisson_allocation_sampler->AddSamplesObserver(this);
   return last_sample_ordinal_;
@@ -246,34 +268,46 @@ void SamplingHeapProfiler::SampleAdded(
   if (UNLIKELY(base::ThreadLocalStorage::HasBeenDestroyed()))
     return;
   DCHECK(PoissonAllocationSampler::ScopedMuteThreadSamples::IsMuted());
-  Sample sample(size, total, ++last_sample_ordinal_);
-  sample.allocator = type;
-  CaptureNativeStack(context, &sample);
-  AutoLock lock(mutex_);
-  if (UNLIKELY(PoissonAllocationSampler::AreHookedSamplesMuted() &&
-               type != PoissonAllocationSampler::kManualForTesting)) {
-    // Throw away any non-test samples that were being collected before
-    // ScopedMuteHookedSamplesForTesting was enabled. This is done inside the
-    // lock to catch any samples that were being collected while
-    // ClearSamplesForTesting is running.
+  // Throw away any non-test samples that were being collected before
+  // ScopedMuteHookedSamplesForTesting was enabled.
+  const auto are_hooked_samples_muted = [type] {
+    return PoissonAllocationSampler::AreHookedSamplesMuted() &&
+           type != PoissonAllocationSampler::kManualForTesting;
+  };
+  if (UNLIKELY(are_hooked_samples_muted()))
     return;
-  }
-  RecordString(sample.context);
-  samples_.emplace(address, std::move(sample));
+  LockFreeSampleTable::Record record;
+  record.address = address;
+  record.size = size;
+  record.total = total;
+  record.allocator = type;
+  record.ordinal = ++last_sample_ordinal_;
+  CaptureNativeStack(context, &record);
+  RecordString(record.context);
+  if (!samples_->Insert(record))
+    return;
+  // A sample inserted while ClearSamplesForTesting is running may be missed by
+  // it, so it is removed again once the samples are muted. The fence pairs
+  // with the one of ClearSamplesForTesting: either it sees the sample, or the
+  // sample sees the samples muted.
+  std::atomic_thread_fence(std::memory_order_seq_cst);
+  if (UNLIKELY(are_hooked_samples_muted()))
+    samples_->Remove(address);
 }
 
-void SamplingHeapProfiler::CaptureNativeStack(const char* context,
-                                              Sample* sample) {
+void SamplingHeapProfiler::CaptureNativeStack(
+    const char* context,
+    LockFreeSampleTable::Record* record) {
   void* stack[kMaxStackEntries];
   size_t frame_count;
   // One frame is reserved for the thread name.
   void** first_frame =
       CaptureStackTrace(stack, kMaxStackEntries - 1, &frame_count);
   DCHECK_LT(frame_count, kMaxStackEntries);
-  sample->stack.assign(first_frame, first_frame + frame_count);
+  record->stack = stack_depot_->Intern(make_span(first_frame, frame_count));
 
   if (record_thread_names_)
-    sample->thread_name = CachedThreadName();
+    record->thread_name = CachedThreadName();
 
   if (!context) {
     const auto* tracker =
@@ -281,17 +315,32 @@ void SamplingHeapProfiler::CaptureNativeStack(const char* context,
     if (tracker)
       context = tracker->TaskContext();
   }
-  sample->context = context;
+  record->context = context;
 }
 
-const char* SamplingHeapProfiler::RecordString(const char* string) {
-  return string ? *strings_.insert(string).first : nullptr;
+void SamplingHeapProfiler::RecordString(const char* string) {
+  if (!string)
+    return;
+  const size_t mask = kStringsCapacity - 1;
+  const size_t first =
+      LockFreeAddressHashSet::Hash(const_cast<char*>(string)) & mask;
+  for (size_t i = 0; i < kMaxStringProbeCount; ++i) {
+    std::atomic<const char*>& slot = strings_[(first + i) & mask];
+    const char* slot_string = slot.load(std::memory_order_relaxed);
+    if (!slot_string &&
+        slot.compare_exchange_strong(slot_string, string,
+                                     std::memory_order_relaxed)) {
+      return;
+    }
+    if (slot_string == string)
+      return;
+  }
+  // The table is full around the hash of the string, which isn't recorded.
 }
 
 void SamplingHeapProfiler::SampleRemoved(void* address) {
   DCHECK(base::PoissonAllocationSampler::ScopedMuteThreadSamples::IsMuted());
-  base::AutoLock lock(mutex_);
-  samples_.erase(address);
+  samples_->Remove(address);
 }
 
 std::vector<SamplingHeapProfiler::Sample> SamplingHeapProfiler::GetSamples(
@@ -300,21 +349,41 @@ std::vector<SamplingHeapProfiler::Sample> SamplingHeapProfiler::GetSamples(
   // on this thread. Otherwise it could have end up with a deadlock.
   // See crbug.com/882495
   PoissonAllocationSampler::ScopedMuteThreadSamples no_samples_scope;
-  AutoLock lock(mutex_);
+  AutoLock lock(start_stop_mutex_);
   std::vector<Sample> samples;
-  samples.reserve(samples_.size());
-  for (auto& it : samples_) {
-    Sample& sample = it.second;
-    if (sample.ordinal > profile_id)
-      samples.push_back(sample);
+  if (!samples_)
+    return samples;
+  std::vector<LockFreeSampleTable::Record> records = samples_->GetRecords();
+  samples.reserve(records.size());
+  for (const LockFreeSampleTable::Record& record : records) {
+    if (record.ordinal <= profile_id)
+      continue;
+    Sample& sample = samples.emplace_back(record.size, record.total,
+                                          record.ordinal);
+    sample.allocator = record.allocator;
+    sample.context = record.context;
+    sample.thread_name = record.thread_name;
+    // The stack is empty if the stack depot was full.
+    if (record.stack) {
+      span<void* const> frames = record.stack->frames();
+      sample.stack.assign(frames.begin(), frames.end());
+    }
   }
   return samples;
 }
 
 std::vector<const char*> SamplingHeapProfiler::GetStrings() {
   PoissonAllocationSampler::ScopedMuteThreadSamples no_samples_scope;
-  AutoLock lock(mutex_);
-  return std::vector<const char*>(strings_.begin(), strings_.end());
+  AutoLock lock(start_stop_mutex_);
+  std::vector<const char*> strings;
+  if (!strings_)
+    return strings;
+  for (size_t i = 0; i < kStringsCapacity; ++i) {
+    const char* string = strings_[i].load(std::memory_order_relaxed);
+    if (string)
+      strings.push_back(string);
+  }
+  return strings;
 }
 
 // static
@@ -334,10 +403,12 @@ void SamplingHeapProfiler::OnThreadNameChanged(const char* name) {
 
 void SamplingHeapProfiler::ClearSamplesForTesting() {
   DCHECK(PoissonAllocationSampler::AreHookedSamplesMuted());
-  base::AutoLock lock(mutex_);
-  samples_.clear();
-  // Since hooked samples are muted, any samples that are waiting to take the
-  // lock in SampleAdded will be discarded. Tests can now call
+  base::AutoLock lock(start_stop_mutex_);
+  std::atomic_thread_fence(std::memory_order_seq_cst);
+  if (samples_)
+    samples_->Clear();
+  // Since hooked samples are muted, any samples that are being added in
+  // SampleAdded will be discarded. Tests can now call
   // PoissonAllocationSampler::RecordAlloc with allocator type kManualForTesting
   // to add samples cleanly.
 }
@@ -6,13 +6,14 @@
 #define BASE_SAMPLING_HEAP_PROFILER_SAMPLING_HEAP_PROFILER_H_
 
 #include <atomic>
-#include <unordered_map>
-#include <unordered_set>
+#include <memory>
 #include <vector>
 
 #include "base/base_export.h"
 #include "base/no_destructor.h"
+#include "base/sampling_heap_profiler/lock_free_sample_table.h"
 #include "base/sampling_heap_profiler/poisson_allocation_sampler.h"
+#include "base/sampling_heap_profiler/stack_depot.h"
 #include "base/synchronization/lock.h"
 #include "base/thread_annotations.h"
 #include "base/threading/thread_id_name_manager.h"
@@ -28,6 +29,10 @@ namespace base {
 // It uses PoissonAllocationSampler to aggregate the heap allocations and
 // record samples.
 // The recorded samples can then be retrieved using GetSamples method.
+//
+// The samples are recorded without taking a lock or allocating: they are
+// stored in a pre-sized LockFreeSampleTable, and their call stacks are
+// interned into a StackDepot. The samples which don't fit are dropped.
 class BASE_EXPORT SamplingHeapProfiler
     : private PoissonAllocationSampler::SamplesObserver,
       public base::ThreadIdNameManager::Observer {
@@ -113,8 +118,9 @@ class BASE_EXPORT SamplingHeapProfiler
                    const char* context) override;
   void SampleRemoved(void* address) override;
 
-  void CaptureNativeStack(const char* context, Sample* sample);
-  const char* RecordString(const char* string) EXCLUSIVE_LOCKS_REQUIRED(mutex_);
+  void CaptureNativeStack(const char* context,
+                          LockFreeSampleTable::Record* record);
+  void RecordString(const char* string);
 
   // Delete all samples recorded, to ensure the profiler is in a consistent
   // state at the beginning of a test. This should only be called within the
@@ -122,18 +128,24 @@ class BASE_EXPORT SamplingHeapProfiler
   // that new hooked samples don't arrive while it's running.
   void ClearSamplesForTesting();
 
-  // Mutex to access |samples_| and |strings_|.
-  Lock mutex_;
+  // Mutex to make |running_sessions_| and Add/Remove samples observer access
+  // atomic.
+  Lock start_stop_mutex_;
 
+  // The storage of the samples, created by the first |Start| and never
+  // deleted. It is written to under |start_stop_mutex_| before the profiler
+  // observes samples, so |SampleAdded| and |SampleRemoved| read it without the
+  // lock.
+  //
   // Samples of the currently live allocations.
-  std::unordered_map<void*, Sample> samples_ GUARDED_BY(mutex_);
+  std::unique_ptr<LockFreeSampleTable> samples_;
 
-  // Contains pointers to static sample context strings that are never deleted.
-  std::unordered_set<const char*> strings_ GUARDED_BY(mutex_);
+  // The call stacks of the samples.
+  std::unique_ptr<StackDepot> stack_depot_;
 
-  // Mutex to make |running_sessions_| and Add/Remove samples observer access
-  // atomic.
-  Lock start_stop_mutex_;
+  // Contains pointers to static sample context strings that are never deleted,
+  // in an insert-only hash table of |kStringsCapacity| slots.
+  std::unique_ptr<std::atomic<const char*>[]> strings_;
 
   // Number of the running sessions.
   int running_sessions_ = 0;
@@ -6,8 +6,10 @@
 
 #include <stdlib.h>
 #include <cinttypes>
+#include <memory>
 
 #include "base/allocator/allocator_shim.h"
+#include "base/containers/contains.h"
 #include "base/debug/alias.h"
 #include "base/memory/raw_ptr.h"
 #include "base/rand_util.h"
@@ -36,6 +38,17 @@ class SamplingHeapProfilerTest : public ::testing::Test {
     return SamplingHeapProfiler::Get()->running_sessions_;
   }
 
+  static std::unique_ptr<
+      PoissonAllocationSampler::ScopedMuteHookedSamplesForTesting>
+  MuteHookedSamples() {
+    return std::make_unique<
+        PoissonAllocationSampler::ScopedMuteHookedSamplesForTesting>();
+  }
+
+  static void ClearSamples() {
+    SamplingHeapProfiler::Get()->ClearSamplesForTesting();
+  }
+
   static void RunStartStopLoop(SamplingHeapProfiler* profiler) {
     for (int i = 0; i < 100000; ++i) {
       profiler->Start();
@@ -353,4 +366,36 @@ TEST_F(SamplingHeapProfilerTest, HookedAllocatorMuted) {
   EXPECT_TRUE(collector.sample_removed);
 }
 
+TEST_F(SamplingHeapProfilerTest, GetSamples) {
+  auto* sampler = PoissonAllocationSampler::Get();
+  sampler->SuppressRandomnessForTest(true);
+  sampler->SetSamplingInterval(1024);
+  auto* profiler = SamplingHeapProfiler::Get();
+  auto mute_hooks = MuteHookedSamples();
+  ClearSamples();
+
+  static const char kContext[] = "GetSamples";
+  void* const kAddress1 = reinterpret_cast<void*>(0x1234);
+  void* const kAddress2 = reinterpret_cast<void*>(0x5678);
+  uint32_t profile_id = profiler->Start();
+  sampler->RecordAlloc(kAddress1, 10000,
+                       PoissonAllocationSampler::kManualForTesting, kContext);
+  sampler->RecordAlloc(kAddress2, 20000,
+                       PoissonAllocationSampler::kManualForTesting, kContext);
+  sampler->RecordFree(kAddress1);
+
+  std::vector<SamplingHeapProfiler::Sample> samples =
+      profiler->GetSamples(profile_id);
+  ASSERT_EQ(1u, samples.size());
+  EXPECT_EQ(20000u, samples[0].size);
+  EXPECT_EQ(PoissonAllocationSampler::kManualForTesting, samples[0].allocator);
+  EXPECT_EQ(kContext, samples[0].context);
+  EXPECT_FALSE(samples[0].stack.empty());
+  EXPECT_TRUE(base::Contains(profiler->GetStrings(), kContext));
+
+  sampler->RecordFree(kAddress2);
+  EXPECT_TRUE(profiler->GetSamples(profile_id).empty());
+  profiler->Stop();
+}
+
 }  // namespace base
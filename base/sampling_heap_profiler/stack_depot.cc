@@ -0,0 +1,94 @@
+// Copyright 2022 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "base/sampling_heap_profiler/stack_depot.h"
+
+#include <algorithm>
+#include <limits>
+#include <new>
+
+#include "base/bits.h"
+#include "base/check_op.h"
+#include "base/hash/hash.h"
+
+namespace base {
+
+StackDepot::StackDepot(size_t buckets_count, size_t arena_size)
+    : buckets_(buckets_count),
+      bucket_mask_(buckets_count - 1),
+      // Not value-initialized, so that the pages of the arena are only
+      // committed as the stacks are stored.
+      arena_(new uint8_t[arena_size]),
+      arena_size_(arena_size) {
+  DCHECK(bits::IsPowerOfTwo(buckets_count));
+  DCHECK_LE(bucket_mask_, std::numeric_limits<uint32_t>::max());
+}
+
+StackDepot::~StackDepot() = default;
+
+const StackDepot::Stack* StackDepot::Intern(span<void* const> frames) {
+  DCHECK_LE(frames.size(), std::numeric_limits<uint32_t>::max());
+  const uint32_t hash = Hash(frames);
+  std::atomic<const Stack*>& bucket = buckets_[hash & bucket_mask_];
+  const Stack* head = bucket.load(std::memory_order_acquire);
+  if (const Stack* stack = Find(head, nullptr, hash, frames))
+    return stack;
+
+  void* memory = AllocateFromArena(sizeof(Stack) + frames.size_bytes());
+  if (!memory) {
+    dropped_count_.fetch_add(1, std::memory_order_relaxed);
+    return nullptr;
+  }
+  Stack* new_stack =
+      new (memory) Stack(hash, static_cast<uint32_t>(frames.size()));
+  std::copy_n(frames.data(), frames.size(),
+              reinterpret_cast<void**>(new_stack + 1));
+
+  while (true) {
+    new_stack->next_ = head;
+    if (bucket.compare_exchange_weak(head, new_stack,
+                                     std::memory_order_release,
+                                     std::memory_order_acquire)) {
+      size_.fetch_add(1, std::memory_order_relaxed);
+      return new_stack;
+    }
+    // Another thread pushed stacks to the bucket in the meantime, which may
+    // include this one. Its copy is used then, and |new_stack| is left unused
+    // in the arena.
+    if (const Stack* stack = Find(head, new_stack->next_, hash, frames))
+      return stack;
+  }
+}
+
+// static
+uint32_t StackDepot::Hash(span<void* const> frames) {
+  return static_cast<uint32_t>(FastHash(as_bytes(frames)));
+}
+
+// static
+const StackDepot::Stack* StackDepot::Find(const Stack* first,
+                                          const Stack* last,
+                                          uint32_t hash,
+                                          span<void* const> frames) {
+  for (const Stack* stack = first; stack != last; stack = stack->next_) {
+    if (stack->hash_ == hash && stack->count_ == frames.size() &&
+        std::equal(frames.data(), frames.data() + frames.size(),
+                   stack->frames().data())) {
+      return stack;
+    }
+  }
+  return nullptr;
+}
+
+void* StackDepot::AllocateFromArena(size_t size) {
+  size = bits::AlignUp(size, alignof(Stack));
+  // Once a stack doesn't fit, |arena_used_| stays past the end of the arena
+  // and the smaller stacks don't get stored either.
+  const size_t offset = arena_used_.fetch_add(size, std::memory_order_relaxed);
+  if (offset > arena_size_ || arena_size_ - offset < size)
+    return nullptr;
+  return arena_.get() + offset;
+}
+
+}  // namespace base
@@ -0,0 +1,93 @@
+// Copyright 2022 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#ifndef BASE_SAMPLING_HEAP_PROFILER_STACK_DEPOT_H_
+#define BASE_SAMPLING_HEAP_PROFILER_STACK_DEPOT_H_
+
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+#include "base/base_export.h"
+#include "base/containers/span.h"
+
+namespace base {
+
+// An insert-only store of call stacks, which keeps a single copy of each
+// distinct stack. |Intern| is lock-free and never allocates, so it can be
+// called from the allocator hooks, concurrently with itself.
+//
+// The stacks are copied into an arena allocated by the constructor, and are
+// never deleted: the pointers returned by |Intern| remain valid for the
+// lifetime of the depot. It never grows either, so |Intern| fails once the
+// arena is full.
+//
+// The stacks are found through a fixed number of buckets, each holding a
+// single-linked list of the stacks with the same hash. New stacks are pushed
+// to the head of their bucket with a compare-and-swap.
+class BASE_EXPORT StackDepot {
+ public:
+  class Stack {
+   public:
+    Stack(const Stack&) = delete;
+    Stack& operator=(const Stack&) = delete;
+
+    span<void* const> frames() const {
+      return make_span(reinterpret_cast<void* const*>(this + 1), count_);
+    }
+
+   private:
+    friend class StackDepot;
+
+    Stack(uint32_t hash, uint32_t count) : hash_(hash), count_(count) {}
+
+    const uint32_t hash_;
+    const uint32_t count_;
+    const Stack* next_ = nullptr;
+    // Followed by |count_| frames.
+  };
+
+  // |buckets_count| has to be a power of 2.
+  StackDepot(size_t buckets_count, size_t arena_size);
+  StackDepot(const StackDepot&) = delete;
+  StackDepot& operator=(const StackDepot&) = delete;
+  ~StackDepot();
+
+  // Returns the stored copy of |frames|, storing it if it's a new stack, or
+  // null if the arena is full.
+  const Stack* Intern(span<void* const> frames);
+
+  // The number of distinct stacks stored.
+  size_t size() const { return size_.load(std::memory_order_relaxed); }
+
+  // The number of stacks which weren't stored because the arena was full.
+  size_t dropped_count() const {
+    return dropped_count_.load(std::memory_order_relaxed);
+  }
+
+ private:
+  static uint32_t Hash(span<void* const> frames);
+  static const Stack* Find(const Stack* first,
+                           const Stack* last,
+                           uint32_t hash,
+                           span<void* const> frames);
+
+  // Returns |size| bytes of the arena, or null if it's full.
+  void* AllocateFromArena(size_t size);
+
+  std::vector<std::atomic<const Stack*>> buckets_;
+  const size_t bucket_mask_;
+
+  const std::unique_ptr<uint8_t[]> arena_;
+  const size_t arena_size_;
+  std::atomic<size_t> arena_used_{0};
+
+  std::atomic<size_t> size_{0};
+  std::atomic<size_t> dropped_count_{0};
+};
+
+}  // namespace base
+
+#endif  // BASE_SAMPLING_HEAP_PROFILER_STACK_DEPOT_H_
@@ -0,0 +1,108 @@
+// Copyright 2022 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "base/sampling_heap_profiler/stack_depot.h"
+
+#include <atomic>
+#include <memory>
+#include <vector>
+
+#include "base/memory/raw_ptr.h"
+#include "base/threading/simple_thread.h"
+#include "testing/gtest/include/gtest/gtest.h"
+
+namespace base {
+namespace {
+
+std::vector<void*> MakeFrames(uintptr_t first, size_t count) {
+  std::vector<void*> frames;
+  for (size_t i = 0; i < count; ++i)
+    frames.push_back(reinterpret_cast<void*>(first + i));
+  return frames;
+}
+
+TEST(StackDepotTest, InternsStacks) {
+  StackDepot depot(16, 4096);
+  std::vector<void*> frames1 = MakeFrames(0x1000, 10);
+  std::vector<void*> frames2 = MakeFrames(0x2000, 10);
+  std::vector<void*> frames3 = MakeFrames(0x1000, 9);
+
+  const StackDepot::Stack* stack1 = depot.Intern(frames1);
+  ASSERT_TRUE(stack1);
+  const StackDepot::Stack* stack2 = depot.Intern(frames2);
+  ASSERT_TRUE(stack2);
+  const StackDepot::Stack* stack3 = depot.Intern(frames3);
+  ASSERT_TRUE(stack3);
+  EXPECT_NE(stack1, stack2);
+  EXPECT_NE(stack1, stack3);
+  EXPECT_EQ(3u, depot.size());
+
+  EXPECT_EQ(stack1, depot.Intern(MakeFrames(0x1000, 10)));
+  EXPECT_EQ(stack3, depot.Intern(frames3));
+  EXPECT_EQ(3u, depot.size());
+
+  EXPECT_EQ(frames1, std::vector<void*>(stack1->frames().begin(),
+                                        stack1->frames().end()));
+  EXPECT_EQ(frames3, std::vector<void*>(stack3->frames().begin(),
+                                        stack3->frames().end()));
+}
+
+TEST(StackDepotTest, EmptyStack) {
+  StackDepot depot(16, 4096);
+  const StackDepot::Stack* stack = depot.Intern(span<void* const>());
+  ASSERT_TRUE(stack);
+  EXPECT_TRUE(stack->frames().empty());
+  EXPECT_EQ(stack, depot.Intern(span<void* const>()));
+}
+
+TEST(StackDepotTest, Full) {
+  StackDepot depot(16, 1024);
+  size_t stored = 0;
+  for (uintptr_t i = 0; i < 100; ++i) {
+    if (depot.Intern(MakeFrames(i * 0x100, 8)))
+      ++stored;
+  }
+  EXPECT_LT(0u, stored);
+  EXPECT_GT(100u, stored);
+  EXPECT_EQ(stored, depot.size());
+  EXPECT_EQ(100u - stored, depot.dropped_count());
+  // The stacks stored before are still found.
+  EXPECT_TRUE(depot.Intern(MakeFrames(0, 8)));
+}
+
+class InternThread : public SimpleThread {
+ public:
+  InternThread(StackDepot* depot,
+               std::vector<const StackDepot::Stack*>* stacks)
+      : SimpleThread("InternThread"), depot_(depot), stacks_(stacks) {}
+
+  void Run() override {
+    for (uintptr_t i = 0; i < 1000; ++i)
+      stacks_->push_back(depot_->Intern(MakeFrames(i * 0x100, 16)));
+  }
+
+ private:
+  raw_ptr<StackDepot> depot_;
+  raw_ptr<std::vector<const StackDepot::Stack*>> stacks_;
+};
+
+TEST(StackDepotTest, ConcurrentIntern) {
+  // The stacks interned concurrently by each thread are the same ones.
+  StackDepot depot(64, 1024 * 1024);
+  std::vector<const StackDepot::Stack*> stacks[4];
+  std::vector<std::unique_ptr<InternThread>> threads;
+  for (auto& thread_stacks : stacks) {
+    threads.push_back(std::make_unique<InternThread>(&depot, &thread_stacks));
+    threads.back()->Start();
+  }
+  for (auto& thread : threads)
+    thread->Join();
+
+  EXPECT_EQ(1000u, depot.size());
+  for (auto& thread_stacks : stacks)
+    EXPECT_EQ(stacks[0], thread_stacks);
+}
+
+}  // namespace
+}  // namespace base
@@ -0,0 +1,674 @@
+// Copyright 2022 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "base/strings/ascii_simd.h"
+
+#include <type_traits>
+
+#include "base/bits.h"
+#include "base/strings/string_util.h"
+#include "build/build_config.h"
+
+#if defined(ARCH_CPU_X86_64)
+#include "base/cpu.h"
+// Including these headers directly should generally be avoided. The SSSE3
+// and AVX2 functions are only used if the CPU supports them at runtime, see
+// GetByteSetFunctions().
+// clang-format off
+#include <immintrin.h>
+// clang-format on
+#elif defined(ARCH_CPU_ARM64)
+#include <arm_neon.h>
+#endif
+
+namespace base {
+namespace internal {
+
+namespace {
+
+// The size of the blocks which the kernels below process at once.
+constexpr size_t kBlockSize = 16;
+
+// kFirst is 'A' for the conversions to lowercase, and 'a' for the others:
+// they flip the case bit of the letters from kFirst to kFirst + 25.
+template <char kFirst, typename Char>
+Char ConvertCaseUnit(Char c) {
+  return kFirst == 'A' ? ToLowerASCII(c) : ToUpperASCII(c);
+}
+
+template <typename Char>
+size_t FindCaseInsensitiveASCIIMismatchUnvectorized(const Char* a,
+                                                    const Char* b,
+                                                    size_t length) {
+  size_t i = 0;
+  while (i < length && ToLowerASCII(a[i]) == ToLowerASCII(b[i]))
+    ++i;
+  return i;
+}
+
+bool IsNonASCII(char16_t c) {
+  return c >= 0x80;
+}
+
+bool IsNonAlphanumeric(char16_t c) {
+  return !IsAsciiAlpha(c) && !IsAsciiDigit(c);
+}
+
+bool IsInRows(const uint8_t (*rows)[16], char byte) {
+  const uint8_t value = static_cast<uint8_t>(byte);
+  return rows[value >> 7][value & 0xF] & (1 << ((value >> 4) & 7));
+}
+
+template <bool kInSet>
+size_t FindFirstUnvectorized(const uint8_t (*rows)[16],
+                             const char* data,
+                             size_t length) {
+  for (size_t i = 0; i < length; ++i) {
+    if (IsInRows(rows, data[i]) == kInSet)
+      return i;
+  }
+  return StringPiece::npos;
+}
+
+template <bool kInSet>
+size_t FindLastUnvectorized(const uint8_t (*rows)[16],
+                            const char* data,
+                            size_t length) {
+  for (size_t i = length; i > 0; --i) {
+    if (IsInRows(rows, data[i - 1]) == kInSet)
+      return i - 1;
+  }
+  return StringPiece::npos;
+}
+
+using FindFunction = size_t (*)(const uint8_t (*rows)[16],
+                                const char* data,
+                                size_t length);
+
+struct ByteSetFunctions {
+  FindFunction find_first_of;
+  FindFunction find_first_not_of;
+  FindFunction find_last_not_of;
+};
+
+#if defined(ARCH_CPU_X86_64) || defined(ARCH_CPU_ARM64)
+
+// Indexed by the high 4 bits of a byte, the bit of its row.
+alignas(16) constexpr uint8_t kRowBits[16] = {1, 2, 4,  8,  16, 32, 64, 128,
+                                              1, 2, 4,  8,  16, 32, 64, 128};
+
+#endif
+
+#if defined(ARCH_CPU_X86_64)
+
+// SSE2 is part of x86-64.
+template <char kFirst>
+void ConvertCaseBlock(char* data) {
+  __m128i* block = reinterpret_cast<__m128i*>(data);
+  const __m128i chars = _mm_loadu_si128(block);
+  // Shifts the letters to the lowest signed values, to compare them at once.
+  const __m128i letters = _mm_cmplt_epi8(
+      _mm_add_epi8(chars, _mm_set1_epi8(static_cast<char>(0x80 - kFirst))),
+      _mm_set1_epi8(-0x80 + 26));
+  _mm_storeu_si128(block, _mm_xor_si128(chars, _mm_and_si128(
+                                                   letters,
+                                                   _mm_set1_epi8(0x20))));
+}
+
+template <char kFirst>
+void ConvertCaseBlock(char16_t* data) {
+  __m128i* block = reinterpret_cast<__m128i*>(data);
+  const __m128i chars = _mm_loadu_si128(block);
+  const __m128i letters = _mm_cmplt_epi16(
+      _mm_add_epi16(chars,
+                    _mm_set1_epi16(static_cast<int16_t>(0x8000 - kFirst))),
+      _mm_set1_epi16(-0x8000 + 26));
+  _mm_storeu_si128(block, _mm_xor_si128(chars, _mm_and_si128(
+                                                   letters,
+                                                   _mm_set1_epi16(0x20))));
+}
+
+__m128i LoadLowercaseBlock(const char* data) {
+  const __m128i chars =
+      _mm_loadu_si128(reinterpret_cast<const __m128i*>(data));
+  const __m128i letters = _mm_cmplt_epi8(
+      _mm_add_epi8(chars, _mm_set1_epi8(0x80 - 'A')),
+      _mm_set1_epi8(-0x80 + 26));
+  return _mm_or_si128(chars, _mm_and_si128(letters, _mm_set1_epi8(0x20)));
+}
+
+__m128i LoadLowercaseBlock(const char16_t* data) {
+  const __m128i chars =
+      _mm_loadu_si128(reinterpret_cast<const __m128i*>(data));
+  const __m128i letters = _mm_cmplt_epi16(
+      _mm_add_epi16(chars, _mm_set1_epi16(0x8000 - 'A')),
+      _mm_set1_epi16(-0x8000 + 26));
+  return _mm_or_si128(chars, _mm_and_si128(letters, _mm_set1_epi16(0x20)));
+}
+
+template <typename Char>
+bool BlocksDifferCaseInsensitive(const Char* a, const Char* b) {
+  return _mm_movemask_epi8(_mm_cmpeq_epi8(LoadLowercaseBlock(a),
+                                          LoadLowercaseBlock(b))) != 0xFFFF;
+}
+
+// Two accumulators let the CPU load two blocks per cycle.
+__m128i OrBlocks(const void* data, size_t block_count) {
+  const __m128i* blocks = reinterpret_cast<const __m128i*>(data);
+  __m128i even_bits = _mm_setzero_si128();
+  __m128i odd_bits = _mm_setzero_si128();
+  size_t i = 0;
+  for (; i + 2 <= block_count; i += 2) {
+    even_bits = _mm_or_si128(even_bits, _mm_loadu_si128(blocks + i));
+    odd_bits = _mm_or_si128(odd_bits, _mm_loadu_si128(blocks + i + 1));
+  }
+  if (i < block_count)
+    even_bits = _mm_or_si128(even_bits, _mm_loadu_si128(blocks + i));
+  return _mm_or_si128(even_bits, odd_bits);
+}
+
+bool AreBlocksASCII(const char* data, size_t block_count) {
+  return !_mm_movemask_epi8(OrBlocks(data, block_count));
+}
+
+bool AreBlocksASCII(const char16_t* data, size_t block_count) {
+  const __m128i all_bits = OrBlocks(data, block_count);
+  const __m128i non_ascii_bits = _mm_and_si128(
+      all_bits, _mm_set1_epi16(static_cast<int16_t>(0xFF80)));
+  return _mm_movemask_epi8(
+             _mm_cmpeq_epi16(non_ascii_bits, _mm_setzero_si128())) == 0xFFFF;
+}
+
+// The functions below return a mask with kBitsPerUnit16 bits set for each
+// unit of the block at |data| which they match.
+constexpr size_t kBitsPerUnit16 = 2;
+
+uint32_t MatchNonASCIIBlock(const char16_t* data) {
+  const __m128i chars =
+      _mm_loadu_si128(reinterpret_cast<const __m128i*>(data));
+  const __m128i ascii = _mm_cmpeq_epi16(
+      _mm_and_si128(chars, _mm_set1_epi16(static_cast<int16_t>(0xFF80))),
+      _mm_setzero_si128());
+  return ~static_cast<uint32_t>(_mm_movemask_epi8(ascii)) & 0xFFFF;
+}
+
+uint32_t MatchNonAlphanumericBlock(const char16_t* data) {
+  const __m128i chars =
+      _mm_loadu_si128(reinterpret_cast<const __m128i*>(data));
+  // Setting the case bit maps the uppercase letters to the lowercase ones.
+  const __m128i letters = _mm_cmplt_epi16(
+      _mm_add_epi16(_mm_or_si128(chars, _mm_set1_epi16(0x20)),
+                    _mm_set1_epi16(0x8000 - 'a')),
+      _mm_set1_epi16(-0x8000 + 26));
+  const __m128i digits =
+      _mm_cmplt_epi16(_mm_add_epi16(chars, _mm_set1_epi16(0x8000 - '0')),
+                      _mm_set1_epi16(-0x8000 + 10));
+  return ~static_cast<uint32_t>(
+             _mm_movemask_epi8(_mm_or_si128(letters, digits))) &
+         0xFFFF;
+}
+
+// Returns the bits of the bytes at |data| which are in the set.
+__attribute__((target("ssse3"))) uint32_t MatchSSSE3(
+    const uint8_t (*rows)[16],
+    const char* data) {
+  const __m128i chars =
+      _mm_loadu_si128(reinterpret_cast<const __m128i*>(data));
+  const __m128i low_rows =
+      _mm_load_si128(reinterpret_cast<const __m128i*>(rows[0]));
+  const __m128i high_rows =
+      _mm_load_si128(reinterpret_cast<const __m128i*>(rows[1]));
+  const __m128i row_bits = _mm_shuffle_epi8(
+      _mm_load_si128(reinterpret_cast<const __m128i*>(kRowBits)),
+      _mm_and_si128(_mm_srli_epi16(chars, 4), _mm_set1_epi8(0x0F)));
+  // The shuffles yield zero for the indices whose high bit is set, so each
+  // row is looked up in one table only.
+  const __m128i row = _mm_or_si128(
+      _mm_shuffle_epi8(low_rows, chars),
+      _mm_shuffle_epi8(high_rows,
+                       _mm_xor_si128(chars, _mm_set1_epi8(-0x80))));
+  return static_cast<uint32_t>(_mm_movemask_epi8(
+      _mm_cmpeq_epi8(_mm_and_si128(row, row_bits), row_bits)));
+}
+
+// |length| must be at least 16. The last block overlaps the previous one,
+// whose bytes are shifted out.
+template <bool kInSet>
+__attribute__((target("ssse3"))) size_t FindFirstSSSE3(
+    const uint8_t (*rows)[16],
+    const char* data,
+    size_t length) {
+  constexpr uint32_t kFlip = kInSet ? 0 : 0xFFFF;
+  size_t i = 0;
+  for (; i + kBlockSize <= length; i += kBlockSize) {
+    const uint32_t found = MatchSSSE3(rows, data + i) ^ kFlip;
+    if (found)
+      return i + bits::CountTrailingZeroBits(found);
+  }
+  if (i == length)
+    return StringPiece::npos;
+  const size_t last = length - kBlockSize;
+  const uint32_t found = (MatchSSSE3(rows, data + last) ^ kFlip) >> (i - last);
+  return found ? i + bits::CountTrailingZeroBits(found) : StringPiece::npos;
+}
+
+// |length| must be at least 16. The first block overlaps the next one, whose
+// bytes are masked out.
+template <bool kInSet>
+__attribute__((target("ssse3"))) size_t FindLastSSSE3(
+    const uint8_t (*rows)[16],
+    const char* data,
+    size_t length) {
+  constexpr uint32_t kFlip = kInSet ? 0 : 0xFFFF;
+  size_t end = length;
+  for (; end >= kBlockSize; end -= kBlockSize) {
+    const uint32_t found = MatchSSSE3(rows, data + end - kBlockSize) ^ kFlip;
+    if (found)
+      return end - kBlockSize + 31 - bits::CountLeadingZeroBits(found);
+  }
+  if (end == 0)
+    return StringPiece::npos;
+  const uint32_t found =
+      (MatchSSSE3(rows, data) ^ kFlip) & ((uint32_t{1} << end) - 1);
+  return found ? 31 - bits::CountLeadingZeroBits(found) : StringPiece::npos;
+}
+
+__attribute__((target("avx2"))) uint32_t MatchAVX2(const uint8_t (*rows)[16],
+                                                   const char* data) {
+  const __m256i chars =
+      _mm256_loadu_si256(reinterpret_cast<const __m256i*>(data));
+  // The shuffles look up each 128-bit lane in a copy of the tables.
+  const __m256i low_rows = _mm256_broadcastsi128_si256(
+      _mm_load_si128(reinterpret_cast<const __m128i*>(rows[0])));
+  const __m256i high_rows = _mm256_broadcastsi128_si256(
+      _mm_load_si128(reinterpret_cast<const __m128i*>(rows[1])));
+  const __m256i row_bits = _mm256_shuffle_epi8(
+      _mm256_broadcastsi128_si256(
+          _mm_load_si128(reinterpret_cast<const __m128i*>(kRowBits))),
+      _mm256_and_si256(_mm256_srli_epi16(chars, 4), _mm256_set1_epi8(0x0F)));
+  const __m256i row = _mm256_or_si256(
+      _mm256_shuffle_epi8(low_rows, chars),
+      _mm256_shuffle_epi8(high_rows,
+                          _mm256_xor_si256(chars, _mm256_set1_epi8(-0x80))));
+  return static_cast<uint32_t>(_mm256_movemask_epi8(
+      _mm256_cmpeq_epi8(_mm256_and_si256(row, row_bits), row_bits)));
+}
+
+template <bool kInSet>
+__attribute__((target("avx2"))) size_t FindFirstAVX2(
+    const uint8_t (*rows)[16],
+    const char* data,
+    size_t length) {
+  constexpr size_t kAVX2BlockSize = 2 * kBlockSize;
+  if (length < kAVX2BlockSize)
+    return FindFirstSSSE3<kInSet>(rows, data, length);
+  constexpr uint32_t kFlip = kInSet ? 0 : 0xFFFFFFFF;
+  size_t i = 0;
+  for (; i + kAVX2BlockSize <= length; i += kAVX2BlockSize) {
+    const uint32_t found = MatchAVX2(rows, data + i) ^ kFlip;
+    if (found)
+      return i + bits::CountTrailingZeroBits(found);
+  }
+  if (i == length)
+    return StringPiece::npos;
+  const size_t last = length - kAVX2BlockSize;
+  const uint32_t found = (MatchAVX2(rows, data + last) ^ kFlip) >> (i - last);
+  return found ? i + bits::CountTrailingZeroBits(found) : StringPiece::npos;
+}
+
+template <bool kInSet>
+__attribute__((target("avx2"))) size_t FindLastAVX2(const uint8_t (*rows)[16],
+                                                    const char* data,
+                                                    size_t length) {
+  constexpr size_t kAVX2BlockSize = 2 * kBlockSize;
+  if (length < kAVX2BlockSize)
+    return FindLastSSSE3<kInSet>(rows, data, length);
+  constexpr uint32_t kFlip = kInSet ? 0 : 0xFFFFFFFF;
+  size_t end = length;
+  for (; end >= kAVX2BlockSize; end -= kAVX2BlockSize) {
+    const uint32_t found = MatchAVX2(rows, data + end - kAVX2BlockSize) ^ kFlip;
+    if (found)
+      return end - kAVX2BlockSize + 31 - bits::CountLeadingZeroBits(found);
+  }
+  if (end == 0)
+    return StringPiece::npos;
+  const uint32_t found =
+      (MatchAVX2(rows, data) ^ kFlip) & ((uint32_t{1} << end) - 1);
+  return found ? 31 - bits::CountLeadingZeroBits(found) : StringPiece::npos;
+}
+
+const ByteSetFunctions& GetByteSetFunctions() {
+  static const ByteSetFunctions functions = []() -> ByteSetFunctions {
+    const CPU cpu;
+    if (cpu.has_avx2()) {
+      return {&FindFirstAVX2<true>, &FindFirstAVX2<false>,
+              &FindLastAVX2<false>};
+    }
+    if (cpu.has_ssse3()) {
+      return {&FindFirstSSSE3<true>, &FindFirstSSSE3<false>,
+              &FindLastSSSE3<false>};
+    }
+    return {&FindFirstUnvectorized<true>, &FindFirstUnvectorized<false>,
+            &FindLastUnvectorized<false>};
+  }();
+  return functions;
+}
+
+#elif defined(ARCH_CPU_ARM64)
+
+template <char kFirst>
+void ConvertCaseBlock(char* data) {
+  uint8_t* block = reinterpret_cast<uint8_t*>(data);
+  const uint8x16_t chars = vld1q_u8(block);
+  const uint8x16_t letters =
+      vcltq_u8(vsubq_u8(chars, vdupq_n_u8(kFirst)), vdupq_n_u8(26));
+  vst1q_u8(block, veorq_u8(chars, vandq_u8(letters, vdupq_n_u8(0x20))));
+}
+
+template <char kFirst>
+void ConvertCaseBlock(char16_t* data) {
+  uint16_t* block = reinterpret_cast<uint16_t*>(data);
+  const uint16x8_t chars = vld1q_u16(block);
+  const uint16x8_t letters =
+      vcltq_u16(vsubq_u16(chars, vdupq_n_u16(kFirst)), vdupq_n_u16(26));
+  vst1q_u16(block, veorq_u16(chars, vandq_u16(letters, vdupq_n_u16(0x20))));
+}
+
+bool BlocksDifferCaseInsensitive(const char* a, const char* b) {
+  const uint8x16_t a_chars = vld1q_u8(reinterpret_cast<const uint8_t*>(a));
+  const uint8x16_t b_chars = vld1q_u8(reinterpret_cast<const uint8_t*>(b));
+  const uint8x16_t a_letters =
+      vcltq_u8(vsubq_u8(a_chars, vdupq_n_u8('A')), vdupq_n_u8(26));
+  const uint8x16_t b_letters =
+      vcltq_u8(vsubq_u8(b_chars, vdupq_n_u8('A')), vdupq_n_u8(26));
+  const uint8x16_t differences = veorq_u8(
+      vorrq_u8(a_chars, vandq_u8(a_letters, vdupq_n_u8(0x20))),
+      vorrq_u8(b_chars, vandq_u8(b_letters, vdupq_n_u8(0x20))));
+  return vmaxvq_u8(differences) != 0;
+}
+
+bool BlocksDifferCaseInsensitive(const char16_t* a, const char16_t* b) {
+  const uint16x8_t a_chars = vld1q_u16(reinterpret_cast<const uint16_t*>(a));
+  const uint16x8_t b_chars = vld1q_u16(reinterpret_cast<const uint16_t*>(b));
+  const uint16x8_t a_letters =
+      vcltq_u16(vsubq_u16(a_chars, vdupq_n_u16('A')), vdupq_n_u16(26));
+  const uint16x8_t b_letters =
+      vcltq_u16(vsubq_u16(b_chars, vdupq_n_u16('A')), vdupq_n_u16(26));
+  const uint16x8_t differences = veorq_u16(
+      vorrq_u16(a_chars, vandq_u16(a_letters, vdupq_n_u16(0x20))),
+      vorrq_u16(b_chars, vandq_u16(b_letters, vdupq_n_u16(0x20))));
+  return vmaxvq_u16(differences) != 0;
+}
+
+bool AreBlocksASCII(const char* data, size_t block_count) {
+  const uint8_t* units = reinterpret_cast<const uint8_t*>(data);
+  uint8x16_t all_bits = vdupq_n_u8(0);
+  for (size_t i = 0; i < block_count; ++i)
+    all_bits = vorrq_u8(all_bits, vld1q_u8(units + i * 16));
+  return vmaxvq_u8(all_bits) < 0x80;
+}
+
+bool AreBlocksASCII(const char16_t* data, size_t block_count) {
+  const uint16_t* units = reinterpret_cast<const uint16_t*>(data);
+  uint16x8_t all_bits = vdupq_n_u16(0);
+  for (size_t i = 0; i < block_count; ++i)
+    all_bits = vorrq_u16(all_bits, vld1q_u16(units + i * 8));
+  return vmaxvq_u16(all_bits) < 0x80;
+}
+
+// The functions below return a mask with kBitsPerUnit16 bits set for each
+// unit of the block at |data| which they match: NEON has no equivalent of
+// movemask, so the lanes are narrowed to bytes.
+constexpr size_t kBitsPerUnit16 = 8;
+
+uint64_t MatchNonASCIIBlock(const char16_t* data) {
+  const uint16x8_t chars = vld1q_u16(reinterpret_cast<const uint16_t*>(data));
+  return vget_lane_u64(
+      vreinterpret_u64_u8(vmovn_u16(vcgtq_u16(chars, vdupq_n_u16(0x7F)))), 0);
+}
+
+uint64_t MatchNonAlphanumericBlock(const char16_t* data) {
+  const uint16x8_t chars = vld1q_u16(reinterpret_cast<const uint16_t*>(data));
+  const uint16x8_t letters = vcltq_u16(
+      vsubq_u16(vorrq_u16(chars, vdupq_n_u16(0x20)), vdupq_n_u16('a')),
+      vdupq_n_u16(26));
+  const uint16x8_t digits =
+      vcltq_u16(vsubq_u16(chars, vdupq_n_u16('0')), vdupq_n_u16(10));
+  return vget_lane_u64(
+      vreinterpret_u64_u8(vmovn_u16(vmvnq_u16(vorrq_u16(letters, digits)))),
+      0);
+}
+
+// Returns 4 bits for each of the 16 bytes at |data|, set for the bytes which
+// are in the set: NEON has no equivalent of movemask.
+uint64_t MatchNEON(const uint8_t (*rows)[16], const char* data) {
+  const uint8x16_t chars = vld1q_u8(reinterpret_cast<const uint8_t*>(data));
+  const uint8x16_t row_bits =
+      vqtbl1q_u8(vld1q_u8(kRowBits), vshrq_n_u8(chars, 4));
+  // The lookups yield zero for the indices above 15, so each row is looked up
+  // in one table only.
+  const uint8x16_t index_bits = vdupq_n_u8(0x8F);
+  const uint8x16_t row = vorrq_u8(
+      vqtbl1q_u8(vld1q_u8(rows[0]), vandq_u8(chars, index_bits)),
+      vqtbl1q_u8(vld1q_u8(rows[1]),
+                 vandq_u8(veorq_u8(chars, vdupq_n_u8(0x80)), index_bits)));
+  const uint8x16_t found = vtstq_u8(row, row_bits);
+  return vget_lane_u64(
+      vreinterpret_u64_u8(vshrn_n_u16(vreinterpretq_u16_u8(found), 4)), 0);
+}
+
+template <bool kInSet>
+size_t FindFirstNEON(const uint8_t (*rows)[16],
+                     const char* data,
+                     size_t length) {
+  constexpr uint64_t kFlip = kInSet ? 0 : ~uint64_t{0};
+  size_t i = 0;
+  for (; i + kBlockSize <= length; i += kBlockSize) {
+    const uint64_t found = MatchNEON(rows, data + i) ^ kFlip;
+    if (found)
+      return i + bits::CountTrailingZeroBits(found) / 4;
+  }
+  if (i == length)
+    return StringPiece::npos;
+  const size_t last = length - kBlockSize;
+  const uint64_t found =
+      (MatchNEON(rows, data + last) ^ kFlip) >> (4 * (i - last));
+  return found ? i + bits::CountTrailingZeroBits(found) / 4
+               : StringPiece::npos;
+}
+
+template <bool kInSet>
+size_t FindLastNEON(const uint8_t (*rows)[16],
+                    const char* data,
+                    size_t length) {
+  constexpr uint64_t kFlip = kInSet ? 0 : ~uint64_t{0};
+  size_t end = length;
+  for (; end >= kBlockSize; end -= kBlockSize) {
+    const uint64_t found = MatchNEON(rows, data + end - kBlockSize) ^ kFlip;
+    if (found)
+      return end - kBlockSize + (63 - bits::CountLeadingZeroBits(found)) / 4;
+  }
+  if (end == 0)
+    return StringPiece::npos;
+  const uint64_t found =
+      (MatchNEON(rows, data) ^ kFlip) & ((uint64_t{1} << (4 * end)) - 1);
+  return found ? (63 - bits::CountLeadingZeroBits(found)) / 4
+               : StringPiece::npos;
+}
+
+const ByteSetFunctions& GetByteSetFunctions() {
+  static constexpr ByteSetFunctions kFunctions = {
+      &FindFirstNEON<true>, &FindFirstNEON<false>, &FindLastNEON<false>};
+  return kFunctions;
+}
+
+#else
+
+template <char kFirst, typename Char>
+void ConvertCaseBlock(Char* data) {
+  for (size_t i = 0; i < kBlockSize / sizeof(Char); ++i)
+    data[i] = ConvertCaseUnit<kFirst>(data[i]);
+}
+
+template <typename Char>
+bool BlocksDifferCaseInsensitive(const Char* a, const Char* b) {
+  constexpr size_t kUnits = kBlockSize / sizeof(Char);
+  return FindCaseInsensitiveASCIIMismatchUnvectorized(a, b, kUnits) != kUnits;
+}
+
+constexpr size_t kBitsPerUnit16 = 1;
+
+template <bool (*kMatches)(char16_t)>
+uint32_t MatchBlock(const char16_t* data) {
+  uint32_t found = 0;
+  for (size_t i = 0; i < kBlockSize / sizeof(char16_t); ++i)
+    found |= uint32_t{kMatches(data[i])} << i;
+  return found;
+}
+
+uint32_t MatchNonASCIIBlock(const char16_t* data) {
+  return MatchBlock<&IsNonASCII>(data);
+}
+
+uint32_t MatchNonAlphanumericBlock(const char16_t* data) {
+  return MatchBlock<&IsNonAlphanumeric>(data);
+}
+
+template <typename Char>
+bool AreBlocksASCII(const Char* data, size_t block_count) {
+  std::make_unsigned_t<Char> all_bits = 0;
+  for (size_t i = 0; i < block_count * kBlockSize / sizeof(Char); ++i)
+    all_bits |= data[i];
+  return all_bits < 0x80;
+}
+
+const ByteSetFunctions& GetByteSetFunctions() {
+  static constexpr ByteSetFunctions kFunctions = {
+      &FindFirstUnvectorized<true>, &FindFirstUnvectorized<false>,
+      &FindLastUnvectorized<false>};
+  return kFunctions;
+}
+
+#endif
+
+template <char kFirst, typename Char>
+void ConvertCase(Char* data, size_t length) {
+  constexpr size_t kUnits = kBlockSize / sizeof(Char);
+  size_t i = 0;
+  for (; i + kUnits <= length; i += kUnits)
+    ConvertCaseBlock<kFirst>(data + i);
+  for (; i < length; ++i)
+    data[i] = ConvertCaseUnit<kFirst>(data[i]);
+}
+
+template <typename Char>
+size_t FindCaseInsensitiveASCIIMismatchT(const Char* a,
+                                         const Char* b,
+                                         size_t length) {
+  constexpr size_t kUnits = kBlockSize / sizeof(Char);
+  size_t i = 0;
+  for (; i + kUnits <= length; i += kUnits) {
+    if (BlocksDifferCaseInsensitive(a + i, b + i))
+      break;
+  }
+  return i + FindCaseInsensitiveASCIIMismatchUnvectorized(a + i, b + i,
+                                                          length - i);
+}
+
+template <typename Char>
+bool ContainsOnlyASCIIT(const Char* data, size_t length) {
+  constexpr size_t kUnits = kBlockSize / sizeof(Char);
+  const size_t block_count = length / kUnits;
+  const bool blocks_are_ascii = AreBlocksASCII(data, block_count);
+  std::make_unsigned_t<Char> all_bits = 0;
+  for (size_t i = block_count * kUnits; i < length; ++i)
+    all_bits |= data[i];
+  return blocks_are_ascii & (all_bits < 0x80);
+}
+
+// Returns the index of the first unit of |data| which |kMatchBlock| and
+// |kMatches| match, or |length| if there is none.
+template <auto kMatchBlock, bool (*kMatches)(char16_t)>
+size_t FindFirstMatch(const char16_t* data, size_t length) {
+  constexpr size_t kUnits = kBlockSize / sizeof(char16_t);
+  size_t i = 0;
+  for (; i + kUnits <= length; i += kUnits) {
+    const auto found = kMatchBlock(data + i);
+    if (found)
+      return i + bits::CountTrailingZeroBits(found) / kBitsPerUnit16;
+  }
+  while (i < length && !kMatches(data[i]))
+    ++i;
+  return i;
+}
+
+}  // namespace
+
+void ConvertToLowerASCII(char* data, size_t length) {
+  ConvertCase<'A'>(data, length);
+}
+
+void ConvertToLowerASCII(char16_t* data, size_t length) {
+  ConvertCase<'A'>(data, length);
+}
+
+void ConvertToUpperASCII(char* data, size_t length) {
+  ConvertCase<'a'>(data, length);
+}
+
+void ConvertToUpperASCII(char16_t* data, size_t length) {
+  ConvertCase<'a'>(data, length);
+}
+
+size_t FindCaseInsensitiveASCIIMismatch(const char* a,
+                                        const char* b,
+                                        size_t length) {
+  return FindCaseInsensitiveASCIIMismatchT(a, b, length);
+}
+
+size_t FindCaseInsensitiveASCIIMismatch(const char16_t* a,
+                                        const char16_t* b,
+                                        size_t length) {
+  return FindCaseInsensitiveASCIIMismatchT(a, b, length);
+}
+
+bool ContainsOnlyASCII(const char* data, size_t length) {
+  return ContainsOnlyASCIIT(data, length);
+}
+
+bool ContainsOnlyASCII(const char16_t* data, size_t length) {
+  return ContainsOnlyASCIIT(data, length);
+}
+
+size_t FindFirstNonASCII(const char16_t* data, size_t length) {
+  return FindFirstMatch<&MatchNonASCIIBlock, &IsNonASCII>(data, length);
+}
+
+size_t CountLeadingASCIIAlphanumerics(const char16_t* data, size_t length) {
+  return FindFirstMatch<&MatchNonAlphanumericBlock, &IsNonAlphanumeric>(
+      data, length);
+}
+
+// The strings shorter than a block aren't worth the indirect calls.
+size_t ByteSet::FindFirstOf(StringPiece str) const {
+  if (str.size() < kBlockSize)
+    return FindFirstUnvectorized<true>(rows_, str.data(), str.size());
+  return GetByteSetFunctions().find_first_of(rows_, str.data(), str.size());
+}
+
+size_t ByteSet::FindFirstNotOf(StringPiece str) const {
+  if (str.size() < kBlockSize)
+    return FindFirstUnvectorized<false>(rows_, str.data(), str.size());
+  return GetByteSetFunctions().find_first_not_of(rows_, str.data(),
+                                                 str.size());
+}
+
+size_t ByteSet::FindLastNotOf(StringPiece str) const {
+  if (str.size() < kBlockSize)
+    return FindLastUnvectorized<false>(rows_, str.data(), str.size());
+  return GetByteSetFunctions().find_last_not_of(rows_, str.data(), str.size());
+}
+
+}  // namespace internal
+}  // namespace base
@@ -0,0 +1,88 @@
+// Copyright 2022 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#ifndef BASE_STRINGS_ASCII_SIMD_H_
+#define BASE_STRINGS_ASCII_SIMD_H_
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include "base/base_export.h"
+#include "base/strings/string_piece.h"
+
+namespace base {
+namespace internal {
+
+// Vectorized kernels for the ASCII functions of base/strings/string_util.h.
+// They process 16 units at once with SSE2 on x86-64 and NEON on arm64, and
+// ByteSet uses SSSE3 or AVX2 when the CPU supports them at runtime.
+
+// Converts the ASCII letters of |data| to lowercase or uppercase, in place.
+BASE_EXPORT void ConvertToLowerASCII(char* data, size_t length);
+BASE_EXPORT void ConvertToLowerASCII(char16_t* data, size_t length);
+BASE_EXPORT void ConvertToUpperASCII(char* data, size_t length);
+BASE_EXPORT void ConvertToUpperASCII(char16_t* data, size_t length);
+
+// Returns the index of the first unit at which |a| and |b| differ, ignoring
+// the case of ASCII letters, or |length| if they don't differ.
+BASE_EXPORT size_t FindCaseInsensitiveASCIIMismatch(const char* a,
+                                                    const char* b,
+                                                    size_t length);
+BASE_EXPORT size_t FindCaseInsensitiveASCIIMismatch(const char16_t* a,
+                                                    const char16_t* b,
+                                                    size_t length);
+
+// Returns true if all the units of |data| are ASCII. Reads all of them
+// whatever their values, as IsStringASCII() documents.
+BASE_EXPORT bool ContainsOnlyASCII(const char* data, size_t length);
+BASE_EXPORT bool ContainsOnlyASCII(const char16_t* data, size_t length);
+
+// Returns the index of the first unit of |data| which isn't ASCII, or |length|
+// if there is none.
+BASE_EXPORT size_t FindFirstNonASCII(const char16_t* data, size_t length);
+
+// Returns the number of ASCII letters and digits at the start of |data|.
+BASE_EXPORT size_t CountLeadingASCIIAlphanumerics(const char16_t* data,
+                                                  size_t length);
+
+// A set of bytes, which looks for its members in strings 16 or 32 bytes at a
+// time, as the "Truffle" matcher of Hyperscan does: the low 4 bits of a byte
+// index a row of a table, and its high 4 bits select a bit of the row. It
+// replaces the searches of each byte of a string in a list of characters.
+class BASE_EXPORT ByteSet {
+ public:
+  ByteSet() = default;
+  explicit ByteSet(StringPiece bytes) {
+    for (char byte : bytes)
+      Insert(byte);
+  }
+
+  void Insert(char byte) {
+    const uint8_t value = static_cast<uint8_t>(byte);
+    rows_[value >> 7][value & 0xF] |= 1 << ((value >> 4) & 7);
+  }
+
+  bool Contains(char byte) const {
+    const uint8_t value = static_cast<uint8_t>(byte);
+    return rows_[value >> 7][value & 0xF] & (1 << ((value >> 4) & 7));
+  }
+
+  // Return the index of the first byte of |str| in the set, or not in it, or
+  // StringPiece::npos if there is none.
+  size_t FindFirstOf(StringPiece str) const;
+  size_t FindFirstNotOf(StringPiece str) const;
+
+  // Returns the index of the last byte of |str| not in the set, or
+  // StringPiece::npos if there is none.
+  size_t FindLastNotOf(StringPiece str) const;
+
+ private:
+  // The rows of the bytes below 0x80, and of the others.
+  alignas(16) uint8_t rows_[2][16] = {};
+};
+
+}  // namespace internal
+}  // namespace base
+
+#endif  // BASE_STRINGS_ASCII_SIMD_H_
@@ -0,0 +1,241 @@
+// Copyright 2022 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "base/strings/ascii_simd.h"
+
+#include <stdint.h>
+
+#include <random>
+#include <string>
+
+#include "base/strings/string_util.h"
+#include "base/strings/string_util_internal.h"
+#include "testing/gtest/include/gtest/gtest.h"
+
+namespace base {
+namespace internal {
+
+namespace {
+
+// The units around the letters, and around their case bit.
+const char16_t kInterestingUnits[] = {
+    0x00,   '@',    'A',    'M',    'Z',    '[',    '`',    'a',
+    'm',    'z',    '{',    0x7F,   0x80,   0xC1,   0xDA,   0xE1,
+    0xFA,   0xFF,   0x141,  0x161,  0x4141, 0x8041, 0xFF21, 0xFF41};
+
+template <typename String>
+String MakeRandomString(std::minstd_rand& generator, size_t length) {
+  String str;
+  for (size_t i = 0; i < length; ++i) {
+    str.push_back(static_cast<typename String::value_type>(
+        kInterestingUnits[generator() % std::size(kInterestingUnits)]));
+  }
+  return str;
+}
+
+}  // namespace
+
+TEST(ASCIISIMDTest, ConvertCase) {
+  std::minstd_rand generator(42);
+  for (size_t length = 0; length <= 70; ++length) {
+    for (int i = 0; i < 20; ++i) {
+      const std::string str = MakeRandomString<std::string>(generator, length);
+      std::string lower = str;
+      std::string upper = str;
+      ConvertToLowerASCII(lower.data(), lower.size());
+      ConvertToUpperASCII(upper.data(), upper.size());
+      for (size_t j = 0; j < length; ++j) {
+        EXPECT_EQ(ToLowerASCII(str[j]), lower[j]);
+        EXPECT_EQ(ToUpperASCII(str[j]), upper[j]);
+      }
+
+      const std::u16string str16 =
+          MakeRandomString<std::u16string>(generator, length);
+      std::u16string lower16 = str16;
+      std::u16string upper16 = str16;
+      ConvertToLowerASCII(lower16.data(), lower16.size());
+      ConvertToUpperASCII(upper16.data(), upper16.size());
+      for (size_t j = 0; j < length; ++j) {
+        EXPECT_EQ(ToLowerASCII(str16[j]), lower16[j]);
+        EXPECT_EQ(ToUpperASCII(str16[j]), upper16[j]);
+      }
+    }
+  }
+}
+
+TEST(ASCIISIMDTest, FindCaseInsensitiveASCIIMismatch) {
+  // The pairs of units which differ by their case bit only, and which don't
+  // differ once lowercased.
+  const char16_t kPairs[][2] = {{'A', 'a'}, {'Z', 'z'},   {'@', '`'},
+                                {'[', '{'}, {0xC1, 0xE1}, {0x141, 0x161}};
+  for (size_t length = 1; length <= 70; ++length) {
+    for (size_t position = 0; position < length; ++position) {
+      for (const auto& pair : kPairs) {
+        const bool equal = ToLowerASCII(pair[0]) == ToLowerASCII(pair[1]);
+        const size_t expected = equal ? length : position;
+
+        std::u16string a16(length, u'k');
+        std::u16string b16(length, u'K');
+        a16[position] = pair[0];
+        b16[position] = pair[1];
+        EXPECT_EQ(expected, FindCaseInsensitiveASCIIMismatch(
+                                a16.data(), b16.data(), length));
+
+        if (pair[0] > 0xFF)
+          continue;
+        std::string a(length, 'k');
+        std::string b(length, 'K');
+        a[position] = static_cast<char>(pair[0]);
+        b[position] = static_cast<char>(pair[1]);
+        EXPECT_EQ(expected,
+                  FindCaseInsensitiveASCIIMismatch(a.data(), b.data(), length));
+      }
+    }
+  }
+}
+
+TEST(ASCIISIMDTest, ContainsOnlyASCII) {
+  for (size_t length = 0; length <= 70; ++length) {
+    for (size_t position = 0; position <= length; ++position) {
+      std::string str(length, 'a');
+      std::u16string str16(length, u'a');
+      if (position < length) {
+        str[position] = '\x80';
+        str16[position] = u'\x100';
+      }
+      EXPECT_EQ(position == length, ContainsOnlyASCII(str.data(), length));
+      EXPECT_EQ(position == length, ContainsOnlyASCII(str16.data(), length));
+    }
+  }
+}
+
+TEST(ASCIISIMDTest, FindFirstNonASCII) {
+  for (size_t length = 0; length <= 70; ++length) {
+    for (size_t position = 0; position <= length; ++position) {
+      for (char16_t unit : {u'\x80', u'\xFF', u'\x100', u'\xFF41'}) {
+        std::u16string str16(length, u'\x7F');
+        if (position < length)
+          str16[position] = unit;
+        EXPECT_EQ(position, FindFirstNonASCII(str16.data(), length));
+      }
+    }
+  }
+}
+
+TEST(ASCIISIMDTest, CountLeadingASCIIAlphanumerics) {
+  std::minstd_rand generator(42);
+  const char16_t kAlphanumerics[] = u"09AZaz";
+  for (size_t length = 0; length <= 70; ++length) {
+    for (size_t position = 0; position <= length; ++position) {
+      std::u16string str16;
+      for (size_t i = 0; i < length; ++i)
+        str16.push_back(kAlphanumerics[generator() % 6]);
+      for (char16_t unit : kInterestingUnits) {
+        if (position < length)
+          str16[position] = unit;
+        const bool alphanumeric = IsAsciiAlpha(unit) || IsAsciiDigit(unit);
+        EXPECT_EQ(position < length && !alphanumeric ? position : length,
+                  CountLeadingASCIIAlphanumerics(str16.data(), length));
+      }
+      for (char16_t unit : {u'/', u':', u'\x130', u'\x139', u'\x161'}) {
+        if (position < length)
+          str16[position] = unit;
+        EXPECT_EQ(position,
+                  CountLeadingASCIIAlphanumerics(str16.data(), length));
+      }
+    }
+  }
+}
+
+TEST(ASCIISIMDTest, ByteSet) {
+  std::minstd_rand generator(42);
+  for (int i = 0; i < 5000; ++i) {
+    // The sets and the strings share bytes, of both halves of the table.
+    std::string characters;
+    for (size_t j = generator() % 8; j > 0; --j)
+      characters.push_back(static_cast<char>(generator() % 16 * 0x11));
+    std::string str;
+    for (size_t j = generator() % 80; j > 0; --j) {
+      if (!characters.empty() && generator() % 4)
+        str.push_back(characters[generator() % characters.size()]);
+      else
+        str.push_back(static_cast<char>(generator()));
+    }
+
+    const ByteSet set(characters);
+    for (int byte = 0; byte <= 0xFF; ++byte) {
+      EXPECT_EQ(characters.find(static_cast<char>(byte)) != std::string::npos,
+                set.Contains(static_cast<char>(byte)));
+    }
+    const StringPiece piece(str);
+    EXPECT_EQ(piece.find_first_of(characters), set.FindFirstOf(piece));
+    EXPECT_EQ(piece.find_first_not_of(characters), set.FindFirstNotOf(piece));
+    EXPECT_EQ(piece.find_last_not_of(characters), set.FindLastNotOf(piece));
+  }
+}
+
+TEST(ASCIISIMDTest, ByteSetRuns) {
+  const ByteSet set(" \t");
+  for (size_t length = 0; length <= 70; ++length) {
+    for (size_t position = 0; position <= length; ++position) {
+      std::string spaces(length, ' ');
+      std::string letters(length, 'a');
+      if (position < length) {
+        spaces[position] = 'a';
+        letters[position] = '\t';
+      }
+      const size_t expected = position < length ? position : StringPiece::npos;
+      EXPECT_EQ(expected, set.FindFirstNotOf(spaces));
+      EXPECT_EQ(expected, set.FindLastNotOf(spaces));
+      EXPECT_EQ(expected, set.FindFirstOf(letters));
+    }
+  }
+}
+
+// Compares the functions of string_util.h which use the kernels with the
+// scalar templates they replace.
+TEST(ASCIISIMDTest, StringUtilConsistency) {
+  std::minstd_rand generator(42);
+  const char kWhitespaceAndLetters[] = " \t\r\n\va\xA0\x85";
+  for (int i = 0; i < 5000; ++i) {
+    std::string str;
+    for (size_t j = generator() % 60; j > 0; --j) {
+      str.push_back(
+          kWhitespaceAndLetters[generator() %
+                                (std::size(kWhitespaceAndLetters) - 1)]);
+    }
+    for (bool trim_sequences_with_line_breaks : {false, true}) {
+      EXPECT_EQ(CollapseWhitespaceT(StringPiece(str),
+                                    trim_sequences_with_line_breaks),
+                CollapseWhitespaceASCII(str, trim_sequences_with_line_breaks));
+    }
+    for (TrimPositions positions : {TRIM_LEADING, TRIM_TRAILING, TRIM_ALL}) {
+      const StringPiece piece(str);
+      const size_t begin =
+          positions & TRIM_LEADING
+              ? std::min(piece.find_first_not_of(kWhitespaceASCII),
+                         piece.size())
+              : 0;
+      const size_t end = positions & TRIM_TRAILING
+                             ? piece.find_last_not_of(kWhitespaceASCII) + 1
+                             : piece.size();
+      EXPECT_EQ(piece.substr(begin, end - begin),
+                TrimWhitespaceASCII(str, positions));
+    }
+
+    // Compares with a string which differs in case, and in one character.
+    std::string other = ToUpperASCII(str);
+    if (!other.empty() && generator() % 2) {
+      other[generator() % other.size()] = static_cast<char>(
+          kInterestingUnits[generator() % std::size(kInterestingUnits)]);
+    }
+    const int expected = CompareCaseInsensitiveASCIIT(StringPiece(str),
+                                                      StringPiece(other));
+    EXPECT_EQ(expected, CompareCaseInsensitiveASCII(str, other));
+    EXPECT_EQ(expected == 0, EqualsCaseInsensitiveASCII(str, other));
+  }
+}
+
+}  // namespace internal
+}  // namespace base
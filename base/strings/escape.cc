@@ -4,6 +4,10 @@
 
 #include "base/strings/escape.h"
 
+#include <string.h>
+
+#include "base/check_op.h"
+#include "base/strings/ascii_simd.h"
 #include "base/strings/string_piece.h"
 #include "base/strings/string_util.h"
 #include "base/strings/utf_string_conversion_utils.h"
@@ -250,29 +254,57 @@ bool ShouldUnescapeCodePoint(UnescapeRule::Type rules, uint32_t code_point) {
       (code_point >= 0xE0000 && code_point <= 0xE0FFF));
 }
 
-// Unescapes |escaped_text| according to |rules|, returning the resulting
-// string.  Fills in an |adjustments| parameter, if non-nullptr, so it reflects
-// the alterations done to the string that are not one-character-to-one-
-// character.  The resulting |adjustments| will always be sorted by increasing
-// offset.
-std::string UnescapeURLWithAdjustmentsImpl(
-    StringPiece escaped_text,
-    UnescapeRule::Type rules,
-    OffsetAdjuster::Adjustments* adjustments) {
+// The bytes after which unescaping looks for the next '%', and the next '+'
+// if |rules| replace it. The runs of other bytes are copied at once.
+internal::ByteSet GetSpecialBytes(UnescapeRule::Type rules) {
+  return internal::ByteSet(
+      (rules & UnescapeRule::REPLACE_PLUS_WITH_SPACE) ? "%+" : "%");
+}
+
+// Copies the bytes of |escaped_text| from |index| to the next special byte to
+// |output| at |output_index|, and advances both indices past them. |output|
+// may overlap |escaped_text| when unescaping in place, as long as it doesn't
+// start after it.
+void CopyUntilSpecialByte(StringPiece escaped_text,
+                          const internal::ByteSet& special_bytes,
+                          size_t& index,
+                          char* output,
+                          size_t& output_index) {
+  const size_t next = special_bytes.FindFirstOf(escaped_text.substr(index));
+  const size_t length =
+      next == StringPiece::npos ? escaped_text.size() - index : next;
+  memmove(output + output_index, escaped_text.data() + index, length);
+  index += length;
+  output_index += length;
+}
+
+// Unescapes |escaped_text| according to |rules| to |output|, which must be at
+// least as large, and returns the length of the result. Fills in an
+// |adjustments| parameter, if non-nullptr, so it reflects the alterations
+// done to the string that are not one-character-to-one-character.  The
+// resulting |adjustments| will always be sorted by increasing offset.
+size_t UnescapeURLWithAdjustmentsImpl(StringPiece escaped_text,
+                                      UnescapeRule::Type rules,
+                                      OffsetAdjuster::Adjustments* adjustments,
+                                      char* output) {
   if (adjustments)
     adjustments->clear();
-  // Do not unescape anything, return the |escaped_text| text.
-  if (rules == UnescapeRule::NONE)
-    return std::string(escaped_text);
+  // Do not unescape anything, copy the |escaped_text| text.
+  if (rules == UnescapeRule::NONE) {
+    memmove(output, escaped_text.data(), escaped_text.size());
+    return escaped_text.size();
+  }
 
-  // The output of the unescaping is always smaller than the input, so we can
-  // reserve the input size to make sure we have enough buffer and don't have
-  // to allocate in the loop below.
-  std::string result;
-  result.reserve(escaped_text.length());
+  const internal::ByteSet special_bytes = GetSpecialBytes(rules);
+  size_t output_index = 0;
 
   // Locations of adjusted text.
   for (size_t i = 0, max = escaped_text.size(); i < max;) {
+    CopyUntilSpecialByte(escaped_text, special_bytes, i, output,
+                         output_index);
+    if (i == max)
+      break;
+
     // Try to unescape the character.
     uint32_t code_point;
     std::string unescaped;
@@ -286,7 +318,7 @@ std::string UnescapeURLWithAdjustmentsImpl(
       // sequences.
       unsigned char non_utf8_byte;
       if (UnescapeUnsignedByteAtIndex(escaped_text, i, &non_utf8_byte)) {
-        result.push_back(non_utf8_byte);
+        output[output_index++] = static_cast<char>(non_utf8_byte);
         if (adjustments)
           adjustments->push_back(OffsetAdjuster::Adjustment(i, 3, 1));
         i += 3;
@@ -297,9 +329,9 @@ std::string UnescapeURLWithAdjustmentsImpl(
       // REPLACE_PLUS_WITH_SPACE is being applied.
       if (escaped_text[i] == '+' &&
           (rules & UnescapeRule::REPLACE_PLUS_WITH_SPACE)) {
-        result.push_back(' ');
+        output[output_index++] = ' ';
       } else {
-        result.push_back(escaped_text[i]);
+        output[output_index++] = escaped_text[i];
       }
       ++i;
       continue;
@@ -310,14 +342,17 @@ std::string UnescapeURLWithAdjustmentsImpl(
     if (!ShouldUnescapeCodePoint(rules, code_point)) {
       // If it's a valid UTF-8 character, but not safe to unescape, copy all
       // bytes directly.
-      result.append(escaped_text.begin() + i,
-                    escaped_text.begin() + i + 3 * unescaped.length());
+      memmove(output + output_index, escaped_text.data() + i,
+              3 * unescaped.length());
+      output_index += 3 * unescaped.length();
       i += unescaped.length() * 3;
       continue;
     }
 
     // If the code point is allowed, and append the entire unescaped character.
-    result.append(unescaped);
+    // It's written over escaped bytes which were already read.
+    memcpy(output + output_index, unescaped.data(), unescaped.length());
+    output_index += unescaped.length();
     if (adjustments) {
       for (size_t j = 0; j < unescaped.length(); ++j) {
         adjustments->push_back(OffsetAdjuster::Adjustment(i + j * 3, 3, 1));
@@ -326,14 +361,82 @@ std::string UnescapeURLWithAdjustmentsImpl(
     i += 3 * unescaped.length();
   }
 
+  return output_index;
+}
+
+// Returns the result of UnescapeURLWithAdjustmentsImpl() as a string.
+std::string UnescapeURLWithAdjustments(
+    StringPiece escaped_text,
+    UnescapeRule::Type rules,
+    OffsetAdjuster::Adjustments* adjustments) {
+  // The output of the unescaping is always smaller than the input, so the
+  // result can be written in place.
+  std::string result(escaped_text.size(), '\0');
+  result.resize(UnescapeURLWithAdjustmentsImpl(escaped_text, rules,
+                                               adjustments, &result[0]));
   return result;
 }
 
+// Unescapes |escaped_text| like UnescapeBinaryURLComponent() to |output|,
+// which must be at least as large, and returns the length of the result.
+size_t UnescapeBinaryURLComponentImpl(StringPiece escaped_text,
+                                      UnescapeRule::Type rules,
+                                      char* output) {
+  // Only NORMAL and REPLACE_PLUS_WITH_SPACE are supported.
+  DCHECK(rules != UnescapeRule::NONE);
+  DCHECK(!(rules &
+           ~(UnescapeRule::NORMAL | UnescapeRule::REPLACE_PLUS_WITH_SPACE)));
+
+  const internal::ByteSet special_bytes = GetSpecialBytes(rules);
+  size_t output_index = 0;
+
+  for (size_t i = 0, max = escaped_text.size(); i < max;) {
+    CopyUntilSpecialByte(escaped_text, special_bytes, i, output,
+                         output_index);
+    if (i == max)
+      break;
+
+    unsigned char byte;
+    // UnescapeUnsignedByteAtIndex does bounds checking, so this is always safe
+    // to call.
+    if (UnescapeUnsignedByteAtIndex(escaped_text, i, &byte)) {
+      output[output_index++] = static_cast<char>(byte);
+      i += 3;
+      continue;
+    }
+
+    if ((rules & UnescapeRule::REPLACE_PLUS_WITH_SPACE) &&
+        escaped_text[i] == '+') {
+      output[output_index++] = ' ';
+      ++i;
+      continue;
+    }
+
+    output[output_index++] = escaped_text[i++];
+  }
+
+  DCHECK_LE(output_index, escaped_text.size());
+  return output_index;
+}
+
 }  // namespace
 
 std::string UnescapeURLComponent(StringPiece escaped_text,
                                  UnescapeRule::Type rules) {
-  return UnescapeURLWithAdjustmentsImpl(escaped_text, rules, nullptr);
+  return UnescapeURLWithAdjustments(escaped_text, rules, nullptr);
+}
+
+size_t UnescapeURLComponent(StringPiece escaped_text,
+                            UnescapeRule::Type rules,
+                            span<char> output) {
+  CHECK_GE(output.size(), escaped_text.size());
+  return UnescapeURLWithAdjustmentsImpl(escaped_text, rules, nullptr,
+                                        output.data());
+}
+
+void UnescapeURLComponentInPlace(std::string* text,
+                                 UnescapeRule::Type rules) {
+  text->resize(UnescapeURLComponent(*text, rules, *text));
 }
 
 std::u16string UnescapeAndDecodeUTF8URLComponentWithAdjustments(
@@ -343,7 +446,7 @@ std::u16string UnescapeAndDecodeUTF8URLComponentWithAdjustments(
   std::u16string result;
   OffsetAdjuster::Adjustments unescape_adjustments;
   std::string unescaped_url(
-      UnescapeURLWithAdjustmentsImpl(text, rules, &unescape_adjustments));
+      UnescapeURLWithAdjustments(text, rules, &unescape_adjustments));
   if (UTF8ToUTF16WithAdjustments(unescaped_url.data(), unescaped_url.length(),
                                  &result, adjustments)) {
     // Character set looks like it's valid.
@@ -359,46 +462,24 @@ std::u16string UnescapeAndDecodeUTF8URLComponentWithAdjustments(
 
 std::string UnescapeBinaryURLComponent(StringPiece escaped_text,
                                        UnescapeRule::Type rules) {
-  // Only NORMAL and REPLACE_PLUS_WITH_SPACE are supported.
-  DCHECK(rules != UnescapeRule::NONE);
-  DCHECK(!(rules &
-           ~(UnescapeRule::NORMAL | UnescapeRule::REPLACE_PLUS_WITH_SPACE)));
-
-  std::string unescaped_text;
-
-  // The output of the unescaping is always smaller than the input, so we can
-  // reserve the input size to make sure we have enough buffer and don't have
-  // to allocate in the loop below.
-  // Increase capacity before size, as just resizing can grow capacity
-  // needlessly beyond our requested size.
-  unescaped_text.reserve(escaped_text.size());
-  unescaped_text.resize(escaped_text.size());
-
-  size_t output_index = 0;
-
-  for (size_t i = 0, max = escaped_text.size(); i < max;) {
-    unsigned char byte;
-    // UnescapeUnsignedByteAtIndex does bounds checking, so this is always safe
-    // to call.
-    if (UnescapeUnsignedByteAtIndex(escaped_text, i, &byte)) {
-      unescaped_text[output_index++] = byte;
-      i += 3;
-      continue;
-    }
-
-    if ((rules & UnescapeRule::REPLACE_PLUS_WITH_SPACE) &&
-        escaped_text[i] == '+') {
-      unescaped_text[output_index++] = ' ';
-      ++i;
-      continue;
-    }
+  // The output of the unescaping is always smaller than the input, so the
+  // result can be written in place.
+  std::string unescaped_text(escaped_text.size(), '\0');
+  unescaped_text.resize(
+      UnescapeBinaryURLComponentImpl(escaped_text, rules, &unescaped_text[0]));
+  return unescaped_text;
+}
 
-    unescaped_text[output_index++] = escaped_text[i++];
-  }
+size_t UnescapeBinaryURLComponent(StringPiece escaped_text,
+                                  UnescapeRule::Type rules,
+                                  span<char> output) {
+  CHECK_GE(output.size(), escaped_text.size());
+  return UnescapeBinaryURLComponentImpl(escaped_text, rules, output.data());
+}
 
-  DCHECK_LE(output_index, unescaped_text.size());
-  unescaped_text.resize(output_index);
-  return unescaped_text;
+void UnescapeBinaryURLComponentInPlace(std::string* text,
+                                       UnescapeRule::Type rules) {
+  text->resize(UnescapeBinaryURLComponent(*text, rules, *text));
 }
 
 bool UnescapeBinaryURLComponentSafe(StringPiece escaped_text,
@@ -5,12 +5,14 @@
 #ifndef BASE_STRINGS_ESCAPE_H_
 #define BASE_STRINGS_ESCAPE_H_
 
+#include <stddef.h>
 #include <stdint.h>
 
 #include <set>
 #include <string>
 
 #include "base/base_export.h"
+#include "base/containers/span.h"
 #include "base/strings/string_piece.h"
 #include "base/strings/utf_offset_string_conversions.h"
 
@@ -74,6 +76,17 @@ class UnescapeRule {
 BASE_EXPORT std::string UnescapeURLComponent(StringPiece escaped_text,
                                              UnescapeRule::Type rules);
 
+// Like UnescapeURLComponent(), but writes the result to |output|, which must be
+// at least as large as |escaped_text|, and returns its length. |output| may be
+// the memory of |escaped_text|, to unescape in place without allocating.
+BASE_EXPORT size_t UnescapeURLComponent(StringPiece escaped_text,
+                                        UnescapeRule::Type rules,
+                                        span<char> output);
+
+// Unescapes |text| in place, like UnescapeURLComponent().
+BASE_EXPORT void UnescapeURLComponentInPlace(std::string* text,
+                                             UnescapeRule::Type rules);
+
 // Unescapes the given substring as a URL, and then tries to interpret the
 // result as being encoded as UTF-8. If the result is convertible into UTF-8, it
 // will be returned as converted. If it is not, the original escaped string will
@@ -95,6 +108,18 @@ BASE_EXPORT std::string UnescapeBinaryURLComponent(
     StringPiece escaped_text,
     UnescapeRule::Type rules = UnescapeRule::NORMAL);
 
+// Like UnescapeBinaryURLComponent(), but writes the result to |output|, which
+// must be at least as large as |escaped_text|, and returns its length.
+// |output| may be the memory of |escaped_text|, to unescape in place.
+BASE_EXPORT size_t UnescapeBinaryURLComponent(StringPiece escaped_text,
+                                              UnescapeRule::Type rules,
+                                              span<char> output);
+
+// Unescapes |text| in place, like UnescapeBinaryURLComponent().
+BASE_EXPORT void UnescapeBinaryURLComponentInPlace(
+    std::string* text,
+    UnescapeRule::Type rules = UnescapeRule::NORMAL);
+
 // Variant of UnescapeBinaryURLComponent().  Writes output to |unescaped_text|.
 // Returns true on success, returns false and clears |unescaped_text| on
 // failure. Fails on characters escaped that are unsafe to unescape in some
@@ -0,0 +1,104 @@
+// Copyright 2022 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "base/strings/escape.h"
+
+#include <string>
+#include <vector>
+
+#include "base/strings/string_number_conversions.h"
+#include "base/time/time.h"
+#include "base/timer/lap_timer.h"
+#include "testing/gtest/include/gtest/gtest.h"
+#include "testing/perf/perf_result_reporter.h"
+
+namespace base {
+namespace {
+
+constexpr TimeDelta kTimeLimit = Seconds(2);
+constexpr int kWarmupRuns = 10;
+constexpr int kTimeCheckInterval = 10;
+
+constexpr char kMetricPrefixEscape[] = "Escape.";
+constexpr char kMetricThroughput[] = "throughput";
+
+void ReportResults(const std::string& story_name,
+                   const LapTimer& timer,
+                   size_t bytes_per_lap) {
+  perf_test::PerfResultReporter reporter(kMetricPrefixEscape, story_name);
+  reporter.RegisterImportantMetric(kMetricThroughput, "MB/s");
+  reporter.AddResult(kMetricThroughput,
+                     timer.LapsPerSecond() * bytes_per_lap / (1024 * 1024));
+}
+
+// The URLs a proxy sees: long paths and query strings, with a few escapes and
+// '+'s among many bytes which need no unescaping.
+std::vector<std::string> GenerateURLs() {
+  std::vector<std::string> urls;
+  for (int i = 0; i < 256; ++i) {
+    urls.push_back("https://www.example.com/static/resources/images/" +
+                   NumberToString(i) +
+                   "/thumbnail%20large.png?session=a1b2c3d4e5f6a7b8c9d0&q=" +
+                   "search+terms+with%2Fslashes&utm_source=newsletter" +
+                   "&redirect=https%3A%2F%2Fwww.example.org%2Fhome");
+  }
+  return urls;
+}
+
+size_t TotalSize(const std::vector<std::string>& urls) {
+  size_t size = 0;
+  for (const std::string& url : urls)
+    size += url.size();
+  return size;
+}
+
+}  // namespace
+
+TEST(EscapePerfTest, UnescapeURLComponent) {
+  const std::vector<std::string> urls = GenerateURLs();
+  LapTimer timer(kWarmupRuns, kTimeLimit, kTimeCheckInterval);
+  do {
+    for (const std::string& url : urls) {
+      ASSERT_FALSE(
+          UnescapeURLComponent(url, UnescapeRule::SPACES |
+                                        UnescapeRule::REPLACE_PLUS_WITH_SPACE)
+              .empty());
+    }
+    timer.NextLap();
+  } while (!timer.HasTimeLimitExpired());
+  ReportResults("UnescapeURLComponent", timer, TotalSize(urls));
+}
+
+TEST(EscapePerfTest, UnescapeURLComponentInPlace) {
+  const std::vector<std::string> urls = GenerateURLs();
+  std::string buffer;
+  LapTimer timer(kWarmupRuns, kTimeLimit, kTimeCheckInterval);
+  do {
+    for (const std::string& url : urls) {
+      // Doesn't allocate once |buffer| is large enough.
+      buffer = url;
+      UnescapeURLComponentInPlace(
+          &buffer, UnescapeRule::SPACES | UnescapeRule::REPLACE_PLUS_WITH_SPACE);
+      ASSERT_FALSE(buffer.empty());
+    }
+    timer.NextLap();
+  } while (!timer.HasTimeLimitExpired());
+  ReportResults("UnescapeURLComponentInPlace", timer, TotalSize(urls));
+}
+
+TEST(EscapePerfTest, UnescapeBinaryURLComponent) {
+  const std::vector<std::string> urls = GenerateURLs();
+  LapTimer timer(kWarmupRuns, kTimeLimit, kTimeCheckInterval);
+  do {
+    for (const std::string& url : urls) {
+      ASSERT_FALSE(UnescapeBinaryURLComponent(
+                       url, UnescapeRule::REPLACE_PLUS_WITH_SPACE)
+                       .empty());
+    }
+    timer.NextLap();
+  } while (!timer.HasTimeLimitExpired());
+  ReportResults("UnescapeBinaryURLComponent", timer, TotalSize(urls));
+}
+
+}  // namespace base
@@ -203,6 +203,10 @@ TEST(EscapeTest, UnescapeURLComponent) {
   for (const auto unescape_case : kUnescapeCases) {
     EXPECT_EQ(unescape_case.output,
               UnescapeURLComponent(unescape_case.input, unescape_case.rules));
+
+    std::string in_place = unescape_case.input;
+    UnescapeURLComponentInPlace(&in_place, unescape_case.rules);
+    EXPECT_EQ(unescape_case.output, in_place);
   }
 
   // Test NULL character unescaping, which can't be tested above since those are
@@ -340,6 +344,10 @@ TEST(EscapeTest, UnescapeBinaryURLComponent) {
   for (const auto& test_case : kTestCases) {
     EXPECT_EQ(test_case.output,
               UnescapeBinaryURLComponent(test_case.input, test_case.rules));
+
+    std::string in_place = test_case.input;
+    UnescapeBinaryURLComponentInPlace(&in_place, test_case.rules);
+    EXPECT_EQ(test_case.output, in_place);
   }
 
   // Test NULL character unescaping, which can't be tested above since those are
@@ -355,6 +363,38 @@ TEST(EscapeTest, UnescapeBinaryURLComponent) {
   EXPECT_EQ(expected, UnescapeBinaryURLComponent(input));
 }
 
+// The runs of bytes which need no unescaping are found 16 or 32 bytes at a
+// time: put the escapes at all the offsets of such blocks.
+TEST(EscapeTest, UnescapeLongRuns) {
+  for (size_t offset = 0; offset < 70; ++offset) {
+    SCOPED_TRACE(offset);
+    const std::string input = std::string(offset, 'a') + "%41" +
+                              std::string(70, 'b') + "+%2" +
+                              std::string(offset, 'z');
+    const std::string expected = std::string(offset, 'a') + "A" +
+                                 std::string(70, 'b') + " %2" +
+                                 std::string(offset, 'z');
+
+    EXPECT_EQ(expected,
+              UnescapeBinaryURLComponent(
+                  input, UnescapeRule::REPLACE_PLUS_WITH_SPACE));
+    EXPECT_EQ(expected,
+              UnescapeURLComponent(input,
+                                   UnescapeRule::NORMAL |
+                                       UnescapeRule::REPLACE_PLUS_WITH_SPACE));
+
+    std::string output(input.size(), 'x');
+    output.resize(UnescapeURLComponent(
+        input, UnescapeRule::NORMAL | UnescapeRule::REPLACE_PLUS_WITH_SPACE,
+        output));
+    EXPECT_EQ(expected, output);
+    output.assign(input.size(), 'x');
+    output.resize(UnescapeBinaryURLComponent(
+        input, UnescapeRule::REPLACE_PLUS_WITH_SPACE, output));
+    EXPECT_EQ(expected, output);
+  }
+}
+
 TEST(EscapeTest, UnescapeBinaryURLComponentSafe) {
   const struct TestCase {
     const char* input;
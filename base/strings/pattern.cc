@@ -4,6 +4,9 @@
 
 #include "base/strings/pattern.h"
 
+#include <utility>
+
+#include "base/check_op.h"
 #include "base/third_party/icu/icu_utf.h"
 
 namespace base {
@@ -140,6 +143,27 @@ struct NextCharUTF16 {
   }
 };
 
+// Returns the longest run of |pattern| between its wildcards, with the escapes
+// removed: a string which matches |pattern| contains it.
+std::string LongestLiteralRun(StringPiece pattern) {
+  std::string longest;
+  std::string run;
+  for (size_t i = 0; i < pattern.size(); ++i) {
+    if (IsWildcard(pattern[i])) {
+      run.clear();
+      continue;
+    }
+    // As in SearchForChars(), a backslash makes the next character literal, and
+    // a trailing one is ignored.
+    if (pattern[i] == '\\' && ++i == pattern.size())
+      break;
+    run.push_back(pattern[i]);
+    if (run.size() > longest.size())
+      longest = run;
+  }
+  return longest;
+}
+
 }  // namespace
 
 bool MatchPattern(StringPiece eval, StringPiece pattern) {
@@ -152,4 +176,95 @@ bool MatchPattern(StringPiece16 eval, StringPiece16 pattern) {
                        pattern.data() + pattern.size(), NextCharUTF16());
 }
 
+PatternSet::PatternSet(std::vector<std::string> patterns)
+    : patterns_(std::move(patterns)) {
+  CHECK_LT(patterns_.size(), size_t{UINT32_MAX});
+  std::vector<std::string> runs(patterns_.size());
+  for (size_t i = 0; i < patterns_.size(); ++i) {
+    runs[i] = LongestLiteralRun(patterns_[i]);
+    if (runs[i].empty())
+      unanchored_patterns_.push_back(i);
+    for (char c : runs[i]) {
+      uint8_t& byte_class = byte_classes_[static_cast<uint8_t>(c)];
+      if (!byte_class)
+        byte_class = static_cast<uint8_t>(class_count_++);
+    }
+  }
+
+  // The trie of the runs, with 0 for the missing transitions: the root can't
+  // be one.
+  transitions_.resize(class_count_);
+  outputs_.resize(1);
+  for (size_t i = 0; i < patterns_.size(); ++i) {
+    if (runs[i].empty())
+      continue;
+    uint32_t state = 0;
+    for (char c : runs[i]) {
+      const size_t index =
+          state * class_count_ + byte_classes_[static_cast<uint8_t>(c)];
+      if (!transitions_[index]) {
+        transitions_[index] = static_cast<uint32_t>(outputs_.size());
+        outputs_.emplace_back();
+        transitions_.resize(transitions_.size() + class_count_);
+      }
+      state = transitions_[index];
+    }
+    outputs_[state].push_back(i);
+  }
+
+  // In breadth-first order, the failure link of each state is known before
+  // its children's, and the missing transitions become those of the failure
+  // link, which makes the trie the automaton.
+  const size_t state_count = outputs_.size();
+  failure_links_.assign(state_count, 0);
+  output_links_.assign(state_count, 0);
+  std::vector<uint32_t> queue;
+  queue.reserve(state_count);
+  for (size_t c = 0; c < class_count_; ++c) {
+    if (transitions_[c])
+      queue.push_back(transitions_[c]);
+  }
+  for (size_t i = 0; i < queue.size(); ++i) {
+    const uint32_t state = queue[i];
+    const uint32_t failure = failure_links_[state];
+    output_links_[state] =
+        outputs_[state].empty() ? output_links_[failure] : state;
+    for (size_t c = 0; c < class_count_; ++c) {
+      uint32_t& next = transitions_[state * class_count_ + c];
+      const uint32_t failure_next = transitions_[failure * class_count_ + c];
+      if (next) {
+        failure_links_[next] = failure_next;
+        queue.push_back(next);
+      } else {
+        next = failure_next;
+      }
+    }
+  }
+}
+
+PatternSet::~PatternSet() = default;
+
+std::vector<size_t> PatternSet::MatchingPatterns(StringPiece string) const {
+  std::vector<bool> candidates(patterns_.size());
+  for (size_t i : unanchored_patterns_)
+    candidates[i] = true;
+  uint32_t state = 0;
+  for (char c : string) {
+    state = transitions_[state * class_count_ +
+                         byte_classes_[static_cast<uint8_t>(c)]];
+    for (uint32_t output = output_links_[state]; output;
+         output = output_links_[failure_links_[output]]) {
+      for (size_t i : outputs_[output])
+        candidates[i] = true;
+    }
+  }
+
+  std::vector<size_t> matches;
+  for (size_t i = 0; i < patterns_.size(); ++i) {
+    if (candidates[i] && MatchPattern(string, patterns_[i]))
+      matches.push_back(i);
+  }
+  return matches;
+}
+
 }  // namespace base
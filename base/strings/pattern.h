@@ -5,6 +5,12 @@
 #ifndef BASE_STRINGS_PATTERN_H_
 #define BASE_STRINGS_PATTERN_H_
 
+#include <stddef.h>
+#include <stdint.h>
+
+#include <string>
+#include <vector>
+
 #include "base/base_export.h"
 #include "base/strings/string_piece.h"
 
@@ -18,6 +24,50 @@ namespace base {
 BASE_EXPORT bool MatchPattern(StringPiece string, StringPiece pattern);
 BASE_EXPORT bool MatchPattern(StringPiece16 string, StringPiece16 pattern);
 
+// Matches a string against many patterns of MatchPattern() at once, in one
+// pass over the string rather than one per pattern:
+//
+//   PatternSet rules({"*.google.com", "www.*", "*/favicon.ico"});
+//   for (size_t rule : rules.MatchingPatterns(url))
+//     ...
+//
+// The longest literal run of each pattern goes into an Aho-Corasick automaton.
+// Only the patterns whose run the string contains, and the ones without any
+// literal character, are then verified with MatchPattern().
+class BASE_EXPORT PatternSet {
+ public:
+  explicit PatternSet(std::vector<std::string> patterns);
+  PatternSet(const PatternSet&) = delete;
+  PatternSet& operator=(const PatternSet&) = delete;
+  ~PatternSet();
+
+  // Returns the indices of the patterns which |string| matches, in increasing
+  // order.
+  std::vector<size_t> MatchingPatterns(StringPiece string) const;
+
+  size_t size() const { return patterns_.size(); }
+
+ private:
+  const std::vector<std::string> patterns_;
+
+  // The patterns without any literal character, which always need verifying.
+  std::vector<size_t> unanchored_patterns_;
+
+  // The automaton over the bytes of the literal runs. The bytes are mapped to
+  // the classes of the bytes the runs have, and every other byte to class 0.
+  uint8_t byte_classes_[256] = {};
+  size_t class_count_ = 1;
+  // The next state of each state and class, at |state * class_count_ + class|.
+  std::vector<uint32_t> transitions_;
+  // The patterns whose literal run ends at each state.
+  std::vector<std::vector<size_t>> outputs_;
+  // The next state with outputs on the chain of suffixes of each state,
+  // itself included, or 0 if there is none. The root state 0 never has any.
+  std::vector<uint32_t> output_links_;
+  // The longest proper suffix of each state.
+  std::vector<uint32_t> failure_links_;
+};
+
 }  // namespace base
 
 #endif  // BASE_STRINGS_PATTERN_H_
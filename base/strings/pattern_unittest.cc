@@ -3,7 +3,14 @@
 // found in the LICENSE file.
 
 #include "base/strings/pattern.h"
+
+#include <stddef.h>
+
+#include <string>
+#include <vector>
+
 #include "base/strings/utf_string_conversions.h"
+#include "testing/gmock/include/gmock/gmock.h"
 #include "testing/gtest/include/gtest/gtest.h"
 
 namespace base {
@@ -47,4 +54,51 @@ TEST(StringUtilTest, MatchPatternTest) {
   EXPECT_TRUE(MatchPattern("aaaaaaaaaaab", "a*a*a*a*a*a*a*a*a*a*a*b"));
 }
 
+TEST(StringUtilTest, PatternSet) {
+  const PatternSet patterns({"*.com", "www.*", "*.google.*", "H?l?o", "*",
+                             "", "he\\*o", "*o*o*", "a*b"});
+  EXPECT_EQ(9u, patterns.size());
+  EXPECT_THAT(patterns.MatchingPatterns("www.google.com"),
+              testing::ElementsAre(0, 1, 2, 4, 7));
+  EXPECT_THAT(patterns.MatchingPatterns("Hello"), testing::ElementsAre(3, 4));
+  EXPECT_THAT(patterns.MatchingPatterns("he*o"), testing::ElementsAre(4, 6));
+  EXPECT_THAT(patterns.MatchingPatterns("hello"), testing::ElementsAre(4));
+  EXPECT_THAT(patterns.MatchingPatterns(""), testing::ElementsAre(4, 5));
+  EXPECT_THAT(patterns.MatchingPatterns("abcb"), testing::ElementsAre(4, 8));
+
+  EXPECT_TRUE(PatternSet({}).MatchingPatterns("anything").empty());
+}
+
+// Compares PatternSet with MatchPattern() over patterns whose literal runs
+// overlap and nest, which exercises the failure and output links.
+TEST(StringUtilTest, PatternSetMatchesMatchPattern) {
+  const std::vector<std::string> patterns = {
+      "a",    "ab",     "*ab*",   "*b*",   "*bab*", "*abab*",
+      "?a?",  "*a?b*",  "b*",     "*aa",   "a\\?b*", "*ba*b",
+      "*bb*", "??",     "*a*b*a*", "\\",   "*\\\\*", "*\xe2\x99\xa0*",
+  };
+  const PatternSet pattern_set(patterns);
+
+  std::vector<std::string> strings = {"", "a?b", "\\", "x\\y",
+                                      "\xe2\x99\xa0", "heart \xe2\x99\xa0"};
+  // All the strings of "a" and "b" up to 6 characters.
+  for (size_t size = 1; size <= 6; ++size) {
+    for (size_t bits = 0; bits < (size_t{1} << size); ++bits) {
+      std::string string;
+      for (size_t i = 0; i < size; ++i)
+        string.push_back(bits & (size_t{1} << i) ? 'b' : 'a');
+      strings.push_back(string);
+    }
+  }
+
+  for (const std::string& string : strings) {
+    std::vector<size_t> expected;
+    for (size_t i = 0; i < patterns.size(); ++i) {
+      if (MatchPattern(string, patterns[i]))
+        expected.push_back(i);
+    }
+    EXPECT_EQ(expected, pattern_set.MatchingPatterns(string)) << string;
+  }
+}
+
 }  // namespace base
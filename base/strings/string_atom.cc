@@ -0,0 +1,133 @@
+// Copyright 2022 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "base/strings/string_atom.h"
+
+#include <stdlib.h>
+#include <string.h>
+
+#include <atomic>
+#include <memory>
+#include <new>
+
+#include "base/check.h"
+#include "base/hash/hash.h"
+#include "base/memory/ptr_util.h"
+#include "base/no_destructor.h"
+#include "base/synchronization/lock.h"
+
+namespace base {
+
+namespace {
+
+using internal::StringAtomEntry;
+
+// An open-addressed hash table of the entries, with linear probing. Slots
+// only go from null to an entry, so that lookups can probe them without the
+// lock. When the table grows, the new slots replace the old ones, which
+// lookups may still be probing, and keep them alive.
+struct Slots {
+  Slots(size_t capacity, std::unique_ptr<Slots> previous)
+      : mask(capacity - 1),
+        entries(new std::atomic<const StringAtomEntry*>[capacity]()),
+        previous(std::move(previous)) {}
+
+  const StringAtomEntry* Find(StringPiece string, size_t hash) const {
+    for (size_t i = hash & mask;; i = (i + 1) & mask) {
+      const StringAtomEntry* entry = entries[i].load(std::memory_order_acquire);
+      if (!entry)
+        return nullptr;
+      if (entry->hash == hash && StringPiece(entry->chars(), entry->size) ==
+                                     string) {
+        return entry;
+      }
+    }
+  }
+
+  void Insert(const StringAtomEntry* entry) {
+    size_t i = entry->hash & mask;
+    while (entries[i].load(std::memory_order_relaxed))
+      i = (i + 1) & mask;
+    entries[i].store(entry, std::memory_order_release);
+  }
+
+  const size_t mask;
+  const std::unique_ptr<std::atomic<const StringAtomEntry*>[]> entries;
+  const std::unique_ptr<Slots> previous;
+};
+
+constexpr size_t kInitialCapacity = 256;
+
+// Written under the lock, read by lookups without it.
+std::atomic<Slots*> g_slots{nullptr};
+
+// Guarded by GetLock().
+size_t g_entry_count = 0;
+
+// Guards the interning of new strings.
+Lock& GetLock() {
+  static NoDestructor<Lock> lock;
+  return *lock;
+}
+
+const StringAtomEntry* FindEntry(StringPiece string, size_t hash) {
+  const Slots* slots = g_slots.load(std::memory_order_acquire);
+  return slots ? slots->Find(string, hash) : nullptr;
+}
+
+const StringAtomEntry* Intern(StringPiece string) {
+  const size_t hash = FastHash(string);
+  if (const StringAtomEntry* entry = FindEntry(string, hash))
+    return entry;
+
+  AutoLock lock(GetLock());
+  // Another thread may have interned |string| since.
+  if (const StringAtomEntry* entry = FindEntry(string, hash))
+    return entry;
+
+  // At most half full.
+  Slots* slots = g_slots.load(std::memory_order_relaxed);
+  const size_t capacity = slots ? slots->mask + 1 : 0;
+  if (2 * (g_entry_count + 1) > capacity) {
+    auto grown = std::make_unique<Slots>(
+        capacity ? 2 * capacity : kInitialCapacity, WrapUnique(slots));
+    if (slots) {
+      for (size_t i = 0; i < capacity; ++i) {
+        if (const StringAtomEntry* entry =
+                slots->entries[i].load(std::memory_order_relaxed)) {
+          grown->Insert(entry);
+        }
+      }
+    }
+    slots = grown.release();
+    g_slots.store(slots, std::memory_order_release);
+  }
+
+  void* memory = malloc(sizeof(StringAtomEntry) + string.size() + 1);
+  CHECK(memory);
+  StringAtomEntry* entry = new (memory) StringAtomEntry{hash, string.size()};
+  char* chars = reinterpret_cast<char*>(entry + 1);
+  memcpy(chars, string.data(), string.size());
+  chars[string.size()] = '\0';
+  slots->Insert(entry);
+  ++g_entry_count;
+  return entry;
+}
+
+}  // namespace
+
+StringAtom::StringAtom(StringPiece string)
+    : entry_(string.empty() ? nullptr : Intern(string)) {}
+
+// static
+absl::optional<StringAtom> StringAtom::Find(StringPiece string) {
+  if (string.empty())
+    return StringAtom();
+  const StringAtomEntry* entry = FindEntry(string, FastHash(string));
+  if (!entry)
+    return absl::nullopt;
+  return StringAtom(entry);
+}
+
+}  // namespace base
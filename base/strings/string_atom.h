@@ -0,0 +1,98 @@
+// Copyright 2022 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#ifndef BASE_STRINGS_STRING_ATOM_H_
+#define BASE_STRINGS_STRING_ATOM_H_
+
+#include <stddef.h>
+
+#include <functional>
+#include <utility>
+
+#include "base/base_export.h"
+#include "base/strings/string_piece.h"
+#include "third_party/abseil-cpp/absl/types/optional.h"
+
+namespace base {
+
+namespace internal {
+
+// The interned copy of a string, which is never freed.
+struct StringAtomEntry {
+  const char* chars() const { return reinterpret_cast<const char*>(this + 1); }
+
+  size_t hash;
+  size_t size;
+  // Followed by the |size| characters and a null.
+};
+
+}  // namespace internal
+
+// A string interned in a table of the process: all the StringAtoms of equal
+// strings point to the same copy, so that they compare and hash in constant
+// time, by pointer and with the hash computed once when the string was
+// interned. They suit the keys which are looked up over and over, such as
+// the names of histograms or trace categories:
+//
+//   flat_hash_map<StringAtom, Histogram*> histograms;
+//   histograms[StringAtom(name)] = histogram;
+//
+// Interning is thread-safe, and takes no lock for the strings already in the
+// table. The table is never freed, so interning suits a bounded set of
+// strings, not arbitrary input. A StringAtom is as cheap to copy as a pointer.
+class BASE_EXPORT StringAtom {
+ public:
+  // The empty string, which is the only string not in the table.
+  constexpr StringAtom() = default;
+
+  // Interns |string|, once per process.
+  explicit StringAtom(StringPiece string);
+
+  // Returns the atom of |string| if it was interned, and else nullopt, without
+  // interning it.
+  static absl::optional<StringAtom> Find(StringPiece string);
+
+  StringPiece str() const {
+    return entry_ ? StringPiece(entry_->chars(), entry_->size) : StringPiece();
+  }
+  // Null-terminated, and valid for the life of the process.
+  const char* c_str() const { return entry_ ? entry_->chars() : ""; }
+  size_t size() const { return entry_ ? entry_->size : 0; }
+  bool empty() const { return !entry_; }
+
+  // A hash of the characters, whose bits are mixed well enough for any hash
+  // table. It's consistent within the process, but not across processes.
+  size_t hash() const { return entry_ ? entry_->hash : 0; }
+
+  friend bool operator==(StringAtom a, StringAtom b) {
+    return a.entry_ == b.entry_;
+  }
+  friend bool operator!=(StringAtom a, StringAtom b) {
+    return a.entry_ != b.entry_;
+  }
+  // An order which is quick to compute, of the addresses of the copies: it is
+  // consistent within the process, but not the order of the strings.
+  friend bool operator<(StringAtom a, StringAtom b) {
+    return std::less<const internal::StringAtomEntry*>()(a.entry_, b.entry_);
+  }
+
+  template <typename H>
+  friend H AbslHashValue(H h, StringAtom atom) {
+    return H::combine(std::move(h), atom.hash());
+  }
+
+ private:
+  explicit StringAtom(const internal::StringAtomEntry* entry) : entry_(entry) {}
+
+  const internal::StringAtomEntry* entry_ = nullptr;
+};
+
+// For the standard containers.
+struct StringAtomHash {
+  size_t operator()(StringAtom atom) const { return atom.hash(); }
+};
+
+}  // namespace base
+
+#endif  // BASE_STRINGS_STRING_ATOM_H_
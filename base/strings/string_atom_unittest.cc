@@ -0,0 +1,137 @@
+// Copyright 2022 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "base/strings/string_atom.h"
+
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "base/containers/flat_map.h"
+#include "base/containers/flat_hash_map.h"
+#include "base/strings/string_number_conversions.h"
+#include "base/strings/string_piece.h"
+#include "base/threading/platform_thread.h"
+#include "testing/gtest/include/gtest/gtest.h"
+
+namespace base {
+
+TEST(StringAtomTest, EqualStringsShareAnAtom) {
+  const std::string name = "Histogram.Name";
+  const StringAtom atom(name);
+  EXPECT_EQ(atom, StringAtom("Histogram.Name"));
+  EXPECT_EQ(atom, StringAtom(std::string(name)));
+  EXPECT_EQ(atom.c_str(), StringAtom(name).c_str());
+  EXPECT_EQ(atom.hash(), StringAtom(name).hash());
+  EXPECT_NE(atom, StringAtom("Histogram.Name2"));
+  EXPECT_NE(atom, StringAtom("Histogram.Nam"));
+
+  EXPECT_EQ("Histogram.Name", atom.str());
+  EXPECT_STREQ("Histogram.Name", atom.c_str());
+  EXPECT_EQ(14u, atom.size());
+  EXPECT_FALSE(atom.empty());
+}
+
+TEST(StringAtomTest, Empty) {
+  EXPECT_EQ(StringAtom(), StringAtom(""));
+  EXPECT_TRUE(StringAtom().empty());
+  EXPECT_EQ(0u, StringAtom().size());
+  EXPECT_STREQ("", StringAtom().c_str());
+  EXPECT_EQ(StringPiece(), StringAtom().str());
+  EXPECT_EQ(StringAtom(), StringAtom::Find(""));
+}
+
+TEST(StringAtomTest, EmbeddedNulls) {
+  const StringAtom atom(StringPiece("a\0b", 3));
+  EXPECT_EQ(3u, atom.size());
+  EXPECT_EQ(StringPiece("a\0b", 3), atom.str());
+  EXPECT_NE(atom, StringAtom("a"));
+}
+
+TEST(StringAtomTest, Find) {
+  EXPECT_FALSE(StringAtom::Find("StringAtomTest.Find.NeverInterned"));
+  const StringAtom atom("StringAtomTest.Find");
+  EXPECT_EQ(atom, StringAtom::Find("StringAtomTest.Find"));
+  // Finding doesn't intern.
+  EXPECT_FALSE(StringAtom::Find("StringAtomTest.Find.NeverInterned"));
+}
+
+TEST(StringAtomTest, ManyStrings) {
+  // Enough for the table to grow several times.
+  std::vector<StringAtom> atoms;
+  for (int i = 0; i < 5000; ++i)
+    atoms.emplace_back("StringAtomTest.ManyStrings." + NumberToString(i));
+  for (int i = 0; i < 5000; ++i) {
+    const std::string string = "StringAtomTest.ManyStrings." +
+                               NumberToString(i);
+    EXPECT_EQ(atoms[i], StringAtom(string));
+    EXPECT_EQ(string, atoms[i].str());
+  }
+}
+
+TEST(StringAtomTest, MapKeys) {
+  flat_map<StringAtom, int> map;
+  map[StringAtom("one")] = 1;
+  map[StringAtom("two")] = 2;
+  map[StringAtom("one")] += 10;
+  EXPECT_EQ(2u, map.size());
+  EXPECT_EQ(11, map[StringAtom("one")]);
+
+  flat_hash_map<StringAtom, int> hash_map;
+  hash_map[StringAtom("one")] = 1;
+  hash_map[StringAtom("two")] = 2;
+  EXPECT_EQ(2, hash_map[StringAtom("two")]);
+  EXPECT_EQ(2u, hash_map.size());
+}
+
+namespace {
+
+constexpr int kConcurrentStrings = 2048;
+
+// Interns the same strings as the other threads, in its own order, so that
+// they race on them.
+class Interner : public PlatformThread::Delegate {
+ public:
+  explicit Interner(int stride) : stride_(stride) {}
+
+  void ThreadMain() override {
+    for (int i = 0; i < kConcurrentStrings; ++i) {
+      atoms_.emplace_back("StringAtomTest.Concurrent." +
+                          NumberToString(Index(i)));
+    }
+  }
+
+  int Index(int i) const { return (i * stride_) % kConcurrentStrings; }
+  const std::vector<StringAtom>& atoms() const { return atoms_; }
+
+ private:
+  const int stride_;
+  std::vector<StringAtom> atoms_;
+};
+
+}  // namespace
+
+TEST(StringAtomTest, ConcurrentInterning) {
+  std::vector<std::unique_ptr<Interner>> interners;
+  std::vector<PlatformThreadHandle> handles(8);
+  for (PlatformThreadHandle& handle : handles) {
+    // Odd strides, prime to the count of strings.
+    interners.push_back(std::make_unique<Interner>(2 * interners.size() + 1));
+    ASSERT_TRUE(PlatformThread::Create(0, interners.back().get(), &handle));
+  }
+  for (PlatformThreadHandle handle : handles)
+    PlatformThread::Join(handle);
+
+  for (const auto& interner : interners) {
+    ASSERT_EQ(static_cast<size_t>(kConcurrentStrings),
+              interner->atoms().size());
+    for (int i = 0; i < kConcurrentStrings; ++i) {
+      EXPECT_EQ(StringAtom("StringAtomTest.Concurrent." +
+                           NumberToString(interner->Index(i))),
+                interner->atoms()[i]);
+    }
+  }
+}
+
+}  // namespace base
@@ -0,0 +1,426 @@
+// Copyright 2022 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "base/strings/string_format.h"
+
+#include <string.h>
+
+#include <algorithm>
+#include <iterator>
+#include <vector>
+
+#include "base/check_op.h"
+#include "base/memory/raw_ptr.h"
+#include "base/notreached.h"
+#include "base/strings/string_util.h"
+
+namespace base {
+
+namespace {
+
+using Conversion = ParsedFormat::Conversion;
+using internal::FormatArgument;
+
+// Collects the output in a buffer on the stack, so that the destination grows
+// once per buffer rather than once per piece of output.
+class FormatWriter {
+ public:
+  explicit FormatWriter(std::string* dest) : dest_(dest) {}
+  FormatWriter(const FormatWriter&) = delete;
+  FormatWriter& operator=(const FormatWriter&) = delete;
+  ~FormatWriter() { dest_->append(buffer_, size_); }
+
+  void Append(const char* data, size_t size) {
+    if (!size)
+      return;
+    if (size > kCapacity - size_) {
+      Flush();
+      if (size >= kCapacity) {
+        dest_->append(data, size);
+        return;
+      }
+    }
+    memcpy(buffer_ + size_, data, size);
+    size_ += size;
+  }
+
+  void Append(size_t count, char c) {
+    if (!count)
+      return;
+    if (count > kCapacity - size_) {
+      Flush();
+      if (count >= kCapacity) {
+        dest_->append(count, c);
+        return;
+      }
+    }
+    memset(buffer_ + size_, c, count);
+    size_ += count;
+  }
+
+ private:
+  static constexpr size_t kCapacity = 256;
+
+  void Flush() {
+    dest_->append(buffer_, size_);
+    size_ = 0;
+  }
+
+  const raw_ptr<std::string> dest_;
+  size_t size_ = 0;
+  char buffer_[kCapacity];
+};
+
+// Appends |prefix|, |zeros| zeros and |body|, padded to the width of
+// |conversion|. |zero_pad| pads with zeros after the prefix rather than with
+// spaces before it.
+void AppendPadded(FormatWriter& writer,
+                  const Conversion& conversion,
+                  StringPiece prefix,
+                  size_t zeros,
+                  StringPiece body,
+                  bool zero_pad) {
+  const size_t size = prefix.size() + zeros + body.size();
+  const size_t width = std::max<int>(conversion.width, 0);
+  const size_t padding = width > size ? width - size : 0;
+  if (conversion.flags & Conversion::kLeft) {
+    writer.Append(prefix.data(), prefix.size());
+    writer.Append(zeros, '0');
+    writer.Append(body.data(), body.size());
+    writer.Append(padding, ' ');
+  } else if (zero_pad) {
+    writer.Append(prefix.data(), prefix.size());
+    writer.Append(padding + zeros, '0');
+    writer.Append(body.data(), body.size());
+  } else {
+    writer.Append(padding, ' ');
+    writer.Append(prefix.data(), prefix.size());
+    writer.Append(zeros, '0');
+    writer.Append(body.data(), body.size());
+  }
+}
+
+// Formats the integer of |magnitude| and |negative| as "%d", "%u", "%o", "%x"
+// or "%X".
+void FormatInteger(FormatWriter& writer,
+                   const Conversion& conversion,
+                   uint64_t magnitude,
+                   bool negative) {
+  // 22 octal digits for 64 bits.
+  char digits[22];
+  char* const end = std::end(digits);
+  char* begin = end;
+  const bool zero = magnitude == 0;
+  switch (conversion.type) {
+    case 'o':
+      for (; magnitude; magnitude >>= 3)
+        *--begin = static_cast<char>('0' + (magnitude & 7));
+      break;
+    case 'x':
+    case 'X': {
+      const char* const hex_digits =
+          conversion.type == 'x' ? "0123456789abcdef" : "0123456789ABCDEF";
+      for (; magnitude; magnitude >>= 4)
+        *--begin = hex_digits[magnitude & 0xF];
+      break;
+    }
+    default:
+      for (; magnitude; magnitude /= 10)
+        *--begin = static_cast<char>('0' + magnitude % 10);
+      break;
+  }
+  const size_t digit_count = static_cast<size_t>(end - begin);
+
+  StringPiece prefix;
+  if (conversion.type == 'd') {
+    if (negative)
+      prefix = "-";
+    else if (conversion.flags & Conversion::kPlus)
+      prefix = "+";
+    else if (conversion.flags & Conversion::kSpace)
+      prefix = " ";
+  } else if ((conversion.flags & Conversion::kAlternate) && !zero) {
+    if (conversion.type == 'x')
+      prefix = "0x";
+    else if (conversion.type == 'X')
+      prefix = "0X";
+  }
+
+  // The precision is the minimum count of digits, so that "%.0d" of 0 is
+  // empty, and "%#o" increases it to print a leading 0.
+  const size_t precision =
+      conversion.precision < 0 ? 1 : static_cast<size_t>(conversion.precision);
+  size_t zeros = precision > digit_count ? precision - digit_count : 0;
+  if (conversion.type == 'o' && (conversion.flags & Conversion::kAlternate) &&
+      zeros == 0 && (digit_count == 0 || *begin != '0')) {
+    zeros = 1;
+  }
+  const bool zero_pad = (conversion.flags & Conversion::kZero) &&
+                        !(conversion.flags & Conversion::kLeft) &&
+                        conversion.precision < 0;
+  AppendPadded(writer, conversion, prefix, zeros,
+               StringPiece(begin, digit_count), zero_pad);
+}
+
+// Formats |value| with snprintf(), for the conversions of floating-point
+// numbers and pointers.
+template <typename T>
+void FormatWithSnprintf(FormatWriter& writer,
+                        const Conversion& conversion,
+                        T value) {
+  // '%', 5 flags, 2 numbers of 5 digits, '.', the type and '\0'.
+  char spec[20];
+  char* out = spec;
+  *out++ = '%';
+  static constexpr struct {
+    uint8_t flag;
+    char c;
+  } kFlags[] = {{Conversion::kLeft, '-'},
+                {Conversion::kPlus, '+'},
+                {Conversion::kSpace, ' '},
+                {Conversion::kAlternate, '#'},
+                {Conversion::kZero, '0'}};
+  for (const auto& flag : kFlags) {
+    if (conversion.flags & flag.flag)
+      *out++ = flag.c;
+  }
+  auto append_number = [&out](int number) {
+    char digits[5];
+    char* begin = std::end(digits);
+    do {
+      *--begin = static_cast<char>('0' + number % 10);
+      number /= 10;
+    } while (number);
+    out = std::copy(begin, std::end(digits), out);
+  };
+  if (conversion.width >= 0)
+    append_number(conversion.width);
+  if (conversion.precision >= 0) {
+    *out++ = '.';
+    append_number(conversion.precision);
+  }
+  *out++ = conversion.type;
+  *out = '\0';
+
+  char buffer[128];
+  const int size = base::snprintf(buffer, sizeof(buffer), spec, value);
+  if (size < 0)
+    return;
+  if (static_cast<size_t>(size) < sizeof(buffer)) {
+    writer.Append(buffer, static_cast<size_t>(size));
+    return;
+  }
+  std::vector<char> large_buffer(static_cast<size_t>(size) + 1);
+  base::snprintf(large_buffer.data(), large_buffer.size(), spec, value);
+  writer.Append(large_buffer.data(), static_cast<size_t>(size));
+}
+
+// The conversion which formats |argument| by its type.
+char DefaultType(const FormatArgument& argument) {
+  switch (argument.type()) {
+    case FormatArgument::Type::kSigned:
+    case FormatArgument::Type::kUnsigned:
+      return 'd';
+    case FormatArgument::Type::kDouble:
+      return 'g';
+    case FormatArgument::Type::kString:
+    case FormatArgument::Type::kCString:
+      return 's';
+    case FormatArgument::Type::kPointer:
+      return 'p';
+  }
+}
+
+// Formats integers as "%d", "%u", "%o", "%x", "%X" and "%c". Returns false if
+// |argument| isn't an integer.
+bool FormatIntegerArgument(FormatWriter& writer,
+                           const Conversion& conversion,
+                           const FormatArgument& argument) {
+  uint64_t value;
+  bool negative = false;
+  if (argument.type() == FormatArgument::Type::kSigned) {
+    int64_t signed_value = argument.signed_value();
+    if (conversion.type == 'd') {
+      // "%hd" and "%hhd" print the value converted to the narrower type.
+      if (conversion.length == 'h')
+        signed_value = static_cast<int16_t>(signed_value);
+      else if (conversion.length == 'H')
+        signed_value = static_cast<int8_t>(signed_value);
+      negative = signed_value < 0;
+      // Negates in unsigned arithmetic, which works for INT64_MIN too.
+      value = static_cast<uint64_t>(signed_value);
+      if (negative)
+        value = 0 - value;
+      FormatInteger(writer, conversion, value, negative);
+      return true;
+    }
+    // The other conversions print the bits of the argument's own type.
+    value = static_cast<uint64_t>(signed_value);
+    if (argument.size() < sizeof(uint64_t))
+      value &= (uint64_t{1} << (8 * argument.size())) - 1;
+  } else if (argument.type() == FormatArgument::Type::kUnsigned) {
+    value = argument.unsigned_value();
+  } else {
+    return false;
+  }
+
+  if (conversion.length == 'h')
+    value = static_cast<uint16_t>(value);
+  else if (conversion.length == 'H')
+    value = static_cast<uint8_t>(value);
+  if (conversion.type == 'c') {
+    const char c = static_cast<char>(value);
+    AppendPadded(writer, conversion, StringPiece(), 0, StringPiece(&c, 1),
+                 false);
+  } else {
+    FormatInteger(writer, conversion, value, false);
+  }
+  return true;
+}
+
+// Formats strings as "%s". Returns false if |argument| isn't a string.
+bool FormatStringArgument(FormatWriter& writer,
+                          const Conversion& conversion,
+                          const FormatArgument& argument) {
+  StringPiece string;
+  if (argument.type() == FormatArgument::Type::kString) {
+    string = argument.string_value();
+    if (conversion.precision >= 0)
+      string = string.substr(0, static_cast<size_t>(conversion.precision));
+  } else if (argument.type() == FormatArgument::Type::kCString) {
+    const char* c_string = argument.c_string_value();
+    if (!c_string) {
+      // As glibc, which prints nothing rather than part of "(null)".
+      if (conversion.precision < 0 || conversion.precision >= 6)
+        string = "(null)";
+    } else if (conversion.precision >= 0) {
+      // Doesn't read past the precision, which needs no '\0' then.
+      string = StringPiece(
+          c_string,
+          strnlen(c_string, static_cast<size_t>(conversion.precision)));
+    } else {
+      string = c_string;
+    }
+  } else {
+    return false;
+  }
+  AppendPadded(writer, conversion, StringPiece(), 0, string, false);
+  return true;
+}
+
+// Formats |argument| for |conversion|. Returns false if they don't match.
+bool FormatArgumentAs(FormatWriter& writer,
+                      const Conversion& conversion,
+                      const FormatArgument& argument) {
+  switch (conversion.type) {
+    case 'd':
+    case 'u':
+    case 'o':
+    case 'x':
+    case 'X':
+    case 'c':
+      return FormatIntegerArgument(writer, conversion, argument);
+    case 's':
+      return FormatStringArgument(writer, conversion, argument);
+    case 'p':
+      if (argument.type() == FormatArgument::Type::kPointer) {
+        FormatWithSnprintf(writer, conversion, argument.pointer_value());
+        return true;
+      }
+      // As printf, "%p" of a string prints its address.
+      if (argument.type() == FormatArgument::Type::kCString) {
+        FormatWithSnprintf(writer, conversion,
+                           static_cast<const void*>(argument.c_string_value()));
+        return true;
+      }
+      return false;
+    default:
+      if (argument.type() != FormatArgument::Type::kDouble)
+        return false;
+      FormatWithSnprintf(writer, conversion, argument.double_value());
+      return true;
+  }
+}
+
+// Formats the argument of |conversion|, the next of |arguments|. Returns false
+// if there is none.
+bool FormatNextArgument(FormatWriter& writer,
+                        const Conversion& conversion,
+                        span<const FormatArgument> arguments,
+                        size_t& next_argument,
+                        const char* format) {
+  if (conversion.type == '%') {
+    writer.Append(1, '%');
+    return true;
+  }
+  if (next_argument == arguments.size())
+    return false;
+  const FormatArgument& argument = arguments[next_argument++];
+  if (!FormatArgumentAs(writer, conversion, argument)) {
+    NOTREACHED() << "Argument " << next_argument << " doesn't match \"%"
+                 << conversion.type << "\" of " << format;
+    Conversion default_conversion = conversion;
+    default_conversion.type = DefaultType(argument);
+    FormatArgumentAs(writer, default_conversion, argument);
+  }
+  return true;
+}
+
+}  // namespace
+
+namespace internal {
+
+void ReportInvalidFormat(const char* format) {
+  NOTREACHED() << "Invalid format string: " << format;
+}
+
+void StrAppendFormatImpl(std::string* dest,
+                         const char* format,
+                         span<const FormatArgument> arguments) {
+  FormatWriter writer(dest);
+  size_t next_argument = 0;
+  const char* literal = format;
+  while (const char* percent = strchr(literal, '%')) {
+    writer.Append(literal, static_cast<size_t>(percent - literal));
+    uint32_t i = static_cast<uint32_t>(percent - format) + 1;
+    Conversion conversion;
+    if (!ParseFormatConversion(format, i, conversion)) {
+      // Keeps the rest of the format string as literal text.
+      ReportInvalidFormat(format);
+      literal = percent;
+      break;
+    }
+    if (!FormatNextArgument(writer, conversion, arguments, next_argument,
+                            format)) {
+      literal = "";
+      break;
+    }
+    literal = format + i;
+  }
+  writer.Append(literal, strlen(literal));
+  DCHECK_EQ(next_argument, arguments.size())
+      << "arguments for the format string " << format;
+}
+
+void StrAppendFormatImpl(std::string* dest,
+                         const ParsedFormat& format,
+                         span<const FormatArgument> arguments) {
+  FormatWriter writer(dest);
+  size_t next_argument = 0;
+  for (const Conversion& conversion : format.conversions()) {
+    writer.Append(format.format() + conversion.literal_begin,
+                  conversion.literal_size);
+    if (!conversion.type ||
+        !FormatNextArgument(writer, conversion, arguments, next_argument,
+                            format.format())) {
+      break;
+    }
+  }
+  DCHECK_EQ(next_argument, arguments.size())
+      << "arguments for the format string " << format.format();
+}
+
+}  // namespace internal
+
+}  // namespace base
@@ -0,0 +1,376 @@
+// Copyright 2022 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#ifndef BASE_STRINGS_STRING_FORMAT_H_
+#define BASE_STRINGS_STRING_FORMAT_H_
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include <array>
+#include <string>
+#include <type_traits>
+
+#include "base/base_export.h"
+#include "base/containers/span.h"
+#include "base/strings/string_piece.h"
+
+namespace base {
+
+// StrFormat -------------------------------------------------------------------
+//
+// StrFormat formats its arguments as StringPrintf() does, from the same printf
+// format strings and into the same output, but it knows the types of its
+// arguments:
+//
+//   std::string line = base::StrFormat("%s: %d of %d", name, done, total);
+//
+// The type of an argument decides how it is read, so the length modifiers of
+// the format string are accepted but not needed: "%d" formats any integer and
+// "%s" a const char*, a std::string or a StringPiece. Integers are formatted by
+// their value, so "%d" of a uint64_t prints it right. A conversion which
+// doesn't match its argument, or a count of arguments which doesn't match the
+// format string, is a DCHECK failure instead of undefined behavior.
+//
+// Integers and strings are formatted directly, and the output is collected in
+// a buffer on the stack, which is appended to the destination once when it's
+// full or done. StringPrintf() instead runs vsnprintf() over the whole format
+// string, and again into a larger buffer if the output doesn't fit. Floating-
+// point numbers and pointers still go through snprintf(), one at a time.
+//
+// ParsedFormat
+//
+// A format string is parsed as it's formatted. One used on a hot path can be
+// parsed once at compile time instead, by declaring it as a constexpr
+// ParsedFormat. Invalid format strings don't compile then:
+//
+//   static constexpr base::ParsedFormat kFormat(",\"dur\":%" PRId64);
+//   base::StrAppendFormat(&json, kFormat, duration);
+//
+// Format strings have the flags "-+ #0", a decimal width and precision but not
+// "*", the length modifiers "hh", "h", "l", "ll", "j", "z", "t" and "q", the
+// conversions "diouxXcsfFeEgGaAp" and "%%". There are no positional arguments,
+// "%n" nor long doubles.
+
+namespace internal {
+
+// A conversion of a format string and the literal text before it.
+struct FormatConversion {
+  enum Flags : uint8_t {
+    kLeft = 1 << 0,       // '-'
+    kPlus = 1 << 1,       // '+'
+    kSpace = 1 << 2,      // ' '
+    kAlternate = 1 << 3,  // '#'
+    kZero = 1 << 4,       // '0'
+  };
+
+  uint32_t literal_begin = 0;
+  uint32_t literal_size = 0;
+  // One of "duoxXcsfFeEgGaAp%", with 'i' read as 'd', or 0 for the text after
+  // the last conversion.
+  char type = 0;
+  uint8_t flags = 0;
+  // The narrowing length modifiers, 'H' for "hh" and 'h', or 0.
+  char length = 0;
+  // -1 for none.
+  int16_t width = -1;
+  int16_t precision = -1;
+};
+
+constexpr bool IsFormatDigit(char c) {
+  return c >= '0' && c <= '9';
+}
+
+// Parses the number at |format[i]| into |number|, which fails if it overflows.
+constexpr bool ParseFormatNumber(const char* format,
+                                 uint32_t& i,
+                                 int16_t& number) {
+  int value = 0;
+  while (IsFormatDigit(format[i])) {
+    value = value * 10 + (format[i++] - '0');
+    if (value > INT16_MAX)
+      return false;
+  }
+  number = static_cast<int16_t>(value);
+  return true;
+}
+
+// Parses the conversion specification after the '%' at |format[i - 1]| into
+// |conversion|, and advances |i| past it. Returns false if it's invalid.
+constexpr bool ParseFormatConversion(const char* format,
+                                     uint32_t& i,
+                                     FormatConversion& conversion) {
+  const uint32_t begin = i;
+  for (;; ++i) {
+    if (format[i] == '-')
+      conversion.flags |= FormatConversion::kLeft;
+    else if (format[i] == '+')
+      conversion.flags |= FormatConversion::kPlus;
+    else if (format[i] == ' ')
+      conversion.flags |= FormatConversion::kSpace;
+    else if (format[i] == '#')
+      conversion.flags |= FormatConversion::kAlternate;
+    else if (format[i] == '0')
+      conversion.flags |= FormatConversion::kZero;
+    else
+      break;
+  }
+  if (IsFormatDigit(format[i]) &&
+      !ParseFormatNumber(format, i, conversion.width)) {
+    return false;
+  }
+  if (format[i] == '.') {
+    ++i;
+    if (!ParseFormatNumber(format, i, conversion.precision))
+      return false;
+  }
+
+  switch (format[i]) {
+    case 'h':
+      ++i;
+      conversion.length = 'h';
+      if (format[i] == 'h') {
+        ++i;
+        conversion.length = 'H';
+      }
+      break;
+    case 'l':
+      ++i;
+      if (format[i] == 'l')
+        ++i;
+      break;
+    case 'j':
+    case 'z':
+    case 't':
+    case 'q':
+      ++i;
+      break;
+  }
+
+  switch (format[i]) {
+    case 'i':
+      conversion.type = 'd';
+      break;
+    case 'd':
+    case 'u':
+    case 'o':
+    case 'x':
+    case 'X':
+    case 'c':
+    case 's':
+    case 'f':
+    case 'F':
+    case 'e':
+    case 'E':
+    case 'g':
+    case 'G':
+    case 'a':
+    case 'A':
+    case 'p':
+      conversion.type = format[i];
+      break;
+    case '%':
+      // Only a bare "%%" is the literal '%'.
+      if (i != begin)
+        return false;
+      conversion.type = '%';
+      break;
+    default:
+      return false;
+  }
+  ++i;
+  return true;
+}
+
+// Not constexpr, so that an invalid format string is a compile error in a
+// constant expression, and a DCHECK failure otherwise.
+BASE_EXPORT void ReportInvalidFormat(const char* format);
+
+}  // namespace internal
+
+// A format string parsed once, at compile time when it's constexpr.
+class ParsedFormat {
+ public:
+  using Conversion = internal::FormatConversion;
+
+  // The maximum number of conversions of a format string, including "%%".
+  static constexpr size_t kMaxConversions = 24;
+
+  constexpr explicit ParsedFormat(const char* format) : format_(format) {
+    uint32_t literal_begin = 0;
+    uint32_t i = 0;
+    while (format[i] != '\0') {
+      if (format[i] != '%') {
+        ++i;
+        continue;
+      }
+      Conversion conversion;
+      conversion.literal_begin = literal_begin;
+      conversion.literal_size = i - literal_begin;
+      ++i;
+      if (!internal::ParseFormatConversion(format, i, conversion) ||
+          conversion_count_ == kMaxConversions - 1) {
+        // Keeps the rest of the format string as literal text.
+        internal::ReportInvalidFormat(format);
+        AddTrailingText(literal_begin);
+        return;
+      }
+      if (conversion.type != '%')
+        ++argument_count_;
+      conversions_[conversion_count_++] = conversion;
+      literal_begin = i;
+    }
+    AddTrailingText(literal_begin);
+  }
+
+  const char* format() const { return format_; }
+  // The conversions, and last the text after them, which has no |type|.
+  span<const Conversion> conversions() const {
+    return make_span(conversions_, conversion_count_);
+  }
+  // The number of arguments the format string consumes.
+  size_t argument_count() const { return argument_count_; }
+
+ private:
+  constexpr void AddTrailingText(uint32_t literal_begin) {
+    uint32_t end = literal_begin;
+    while (format_[end] != '\0')
+      ++end;
+    Conversion& text = conversions_[conversion_count_++];
+    text.literal_begin = literal_begin;
+    text.literal_size = end - literal_begin;
+  }
+
+  const char* format_ = nullptr;
+  size_t conversion_count_ = 0;
+  size_t argument_count_ = 0;
+  Conversion conversions_[kMaxConversions] = {};
+};
+
+namespace internal {
+
+// An argument of StrFormat(), which erases its type to the kinds of values
+// printf formats.
+class BASE_EXPORT FormatArgument {
+ public:
+  enum class Type : uint8_t {
+    kSigned,
+    kUnsigned,
+    kDouble,
+    kString,
+    kCString,
+    kPointer,
+  };
+
+  // Integers, including bool, characters and enums, which printf promotes.
+  template <typename T, std::enable_if_t<std::is_integral<T>::value, int> = 0>
+  FormatArgument(T value)  // NOLINT(google-explicit-constructor)
+      : type_(std::is_signed<T>::value ? Type::kSigned : Type::kUnsigned),
+        size_(sizeof(T)) {
+    if (std::is_signed<T>::value)
+      signed_ = static_cast<int64_t>(value);
+    else
+      unsigned_ = static_cast<uint64_t>(value);
+  }
+  template <typename T, std::enable_if_t<std::is_enum<T>::value, int> = 0>
+  FormatArgument(T value)  // NOLINT(google-explicit-constructor)
+      : FormatArgument(static_cast<std::underlying_type_t<T>>(value)) {}
+
+  FormatArgument(double value)  // NOLINT(google-explicit-constructor)
+      : type_(Type::kDouble), double_(value) {}
+  FormatArgument(float value)  // NOLINT(google-explicit-constructor)
+      : FormatArgument(static_cast<double>(value)) {}
+
+  FormatArgument(const char* value)  // NOLINT(google-explicit-constructor)
+      : type_(Type::kCString), c_string_(value) {}
+  FormatArgument(StringPiece value)  // NOLINT(google-explicit-constructor)
+      : type_(Type::kString), string_{value.data(), value.size()} {}
+
+  template <typename T>
+  FormatArgument(const T* value)  // NOLINT(google-explicit-constructor)
+      : type_(Type::kPointer), pointer_(value) {}
+  FormatArgument(std::nullptr_t)  // NOLINT(google-explicit-constructor)
+      : type_(Type::kPointer), pointer_(nullptr) {}
+
+  Type type() const { return type_; }
+  // The size of an integer, in bytes.
+  size_t size() const { return size_; }
+
+  int64_t signed_value() const { return signed_; }
+  uint64_t unsigned_value() const { return unsigned_; }
+  double double_value() const { return double_; }
+  StringPiece string_value() const {
+    return StringPiece(string_.data, string_.size);
+  }
+  const char* c_string_value() const { return c_string_; }
+  const void* pointer_value() const { return pointer_; }
+
+ private:
+  struct String {
+    const char* data;
+    size_t size;
+  };
+
+  Type type_;
+  uint8_t size_ = 0;
+  union {
+    int64_t signed_;
+    uint64_t unsigned_;
+    double double_;
+    String string_;
+    const char* c_string_;
+    const void* pointer_;
+  };
+};
+
+BASE_EXPORT void StrAppendFormatImpl(std::string* dest,
+                                     const char* format,
+                                     span<const FormatArgument> arguments);
+BASE_EXPORT void StrAppendFormatImpl(std::string* dest,
+                                     const ParsedFormat& format,
+                                     span<const FormatArgument> arguments);
+
+}  // namespace internal
+
+// Appends the formatted arguments to |dest|. Prefer:
+//   StrAppendFormat(&foo, ...);
+// over:
+//   foo += StrFormat(...);
+// because it avoids a temporary string.
+template <typename... Args>
+void StrAppendFormat(std::string* dest,
+                     const char* format,
+                     const Args&... args) {
+  const std::array<internal::FormatArgument, sizeof...(Args)> arguments = {
+      {internal::FormatArgument(args)...}};
+  internal::StrAppendFormatImpl(dest, format, arguments);
+}
+
+template <typename... Args>
+void StrAppendFormat(std::string* dest,
+                     const ParsedFormat& format,
+                     const Args&... args) {
+  const std::array<internal::FormatArgument, sizeof...(Args)> arguments = {
+      {internal::FormatArgument(args)...}};
+  internal::StrAppendFormatImpl(dest, format, arguments);
+}
+
+template <typename... Args>
+[[nodiscard]] std::string StrFormat(const char* format, const Args&... args) {
+  std::string result;
+  StrAppendFormat(&result, format, args...);
+  return result;
+}
+
+template <typename... Args>
+[[nodiscard]] std::string StrFormat(const ParsedFormat& format,
+                                    const Args&... args) {
+  std::string result;
+  StrAppendFormat(&result, format, args...);
+  return result;
+}
+
+}  // namespace base
+
+#endif  // BASE_STRINGS_STRING_FORMAT_H_
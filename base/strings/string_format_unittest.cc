@@ -0,0 +1,188 @@
+// Copyright 2022 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "base/strings/string_format.h"
+
+#include <inttypes.h>
+#include <stdint.h>
+
+#include <limits>
+#include <string>
+
+#include "base/strings/string_piece.h"
+#include "base/strings/stringprintf.h"
+#include "base/test/gtest_util.h"
+#include "testing/gtest/include/gtest/gtest.h"
+
+namespace base {
+
+namespace {
+
+// Parsed at compile time.
+constexpr ParsedFormat kCompileTimeFormat("%s took %" PRId64 " ms (%5.1f%%)");
+
+const char* const kFlags[] = {"", "-", "+", " ", "#", "0", "-0", "+0", "#0"};
+const char* const kWidthsAndPrecisions[] = {"",    "1",   "5",   "20",
+                                            ".0",  ".3",  "8.3", "-8.3",
+                                            "0.0", "30.25"};
+
+// Formats |value| with all the flags, widths and precisions of |conversion|,
+// and checks that StrFormat() matches StringPrintf(), with format strings
+// parsed as they're formatted or first.
+template <typename T>
+void ExpectSameAsStringPrintf(const char* conversion, T value) {
+  for (const char* flags : kFlags) {
+    for (const char* width_and_precision : kWidthsAndPrecisions) {
+      // "%-8.3" already has its flag.
+      if (width_and_precision[0] == '-' && flags[0])
+        continue;
+      const std::string format =
+          std::string("[%") + flags + width_and_precision + conversion + "]";
+      const std::string expected = StringPrintf(format.c_str(), value);
+      EXPECT_EQ(expected, StrFormat(format.c_str(), value)) << format;
+      EXPECT_EQ(expected, StrFormat(ParsedFormat(format.c_str()), value))
+          << format;
+    }
+  }
+}
+
+}  // namespace
+
+TEST(StringFormatTest, Empty) {
+  EXPECT_EQ("", StrFormat(""));
+  EXPECT_EQ("", StrFormat("%s", ""));
+  EXPECT_EQ("text", StrFormat("text"));
+  EXPECT_EQ("%", StrFormat("%%"));
+}
+
+TEST(StringFormatTest, Misc) {
+  EXPECT_EQ("123hello w", StrFormat("%3d%2s %1c", 123, "hello", 'w'));
+  EXPECT_EQ("step took 42 ms ( 12.5%)",
+            StrFormat(kCompileTimeFormat, "step", int64_t{42}, 12.5));
+}
+
+TEST(StringFormatTest, Integers) {
+  for (const char* conversion : {"d", "i", "u", "o", "x", "X"}) {
+    for (int value : {0, 1, -1, 7, 42, -42, 1000000,
+                      std::numeric_limits<int>::max(),
+                      std::numeric_limits<int>::min()}) {
+      ExpectSameAsStringPrintf(conversion, value);
+    }
+  }
+  for (const char* conversion : {PRId64, PRIu64, PRIo64, PRIx64, PRIX64}) {
+    for (int64_t value : {int64_t{0}, int64_t{-1}, int64_t{1} << 40,
+                          std::numeric_limits<int64_t>::max(),
+                          std::numeric_limits<int64_t>::min()}) {
+      ExpectSameAsStringPrintf(conversion, value);
+    }
+  }
+  for (const char* conversion : {"hd", "hhd", "hu", "hhx"}) {
+    for (int value : {0, 200, -200, 70000, -70000})
+      ExpectSameAsStringPrintf(conversion, value);
+  }
+  for (const char* conversion : {"zu", "zx"}) {
+    for (size_t value : {size_t{0}, size_t{12345},
+                         std::numeric_limits<size_t>::max()}) {
+      ExpectSameAsStringPrintf(conversion, value);
+    }
+  }
+  ExpectSameAsStringPrintf("d", true);
+  ExpectSameAsStringPrintf("c", 'a');
+  ExpectSameAsStringPrintf("d", 'a');
+}
+
+TEST(StringFormatTest, IntegersAreFormattedByTheirValue) {
+  EXPECT_EQ("18446744073709551615",
+            StrFormat("%d", std::numeric_limits<uint64_t>::max()));
+  EXPECT_EQ("-9223372036854775808",
+            StrFormat("%d", std::numeric_limits<int64_t>::min()));
+  EXPECT_EQ("ff", StrFormat("%x", int8_t{-1}));
+  EXPECT_EQ("ffffffffffffffff", StrFormat("%x", int64_t{-1}));
+
+  enum class Color : uint8_t { kRed, kGreen };
+  EXPECT_EQ("1", StrFormat("%d", Color::kGreen));
+}
+
+TEST(StringFormatTest, FloatingPoint) {
+  for (const char* conversion : {"f", "F", "e", "E", "g", "G", "a", "A"}) {
+    for (double value : {0.0, -0.0, 1.0, -2.5, 0.1, 1e-10, 123456789.125,
+                         1e300, std::numeric_limits<double>::infinity(),
+                         std::numeric_limits<double>::quiet_NaN()}) {
+      ExpectSameAsStringPrintf(conversion, value);
+    }
+  }
+  ExpectSameAsStringPrintf("f", 0.5f);
+}
+
+TEST(StringFormatTest, Strings) {
+  for (const char* value : {"", "a", "hello", "hello world, long string"}) {
+    ExpectSameAsStringPrintf("s", value);
+    for (const char* flags : kFlags) {
+      for (const char* width_and_precision : kWidthsAndPrecisions) {
+        if (width_and_precision[0] == '-' && flags[0])
+          continue;
+        const std::string format =
+            std::string("%") + flags + width_and_precision + "s";
+        const std::string expected = StringPrintf(format.c_str(), value);
+        EXPECT_EQ(expected, StrFormat(format.c_str(), std::string(value)));
+        EXPECT_EQ(expected, StrFormat(format.c_str(), StringPiece(value)));
+      }
+    }
+  }
+
+  // The precision limits the reads of a C string, which needn't end then.
+  const char kUnterminated[] = {'a', 'b', 'c'};
+  EXPECT_EQ("ab", StrFormat("%.2s", static_cast<const char*>(kUnterminated)));
+}
+
+TEST(StringFormatTest, Pointers) {
+  int value = 0;
+  EXPECT_EQ(StringPrintf("%p", &value), StrFormat("%p", &value));
+  EXPECT_EQ(StringPrintf("%20p", &value), StrFormat("%20p", &value));
+  const char* const string = "string";
+  EXPECT_EQ(StringPrintf("%p", string), StrFormat("%p", string));
+}
+
+TEST(StringFormatTest, LongOutput) {
+  const std::string long_string(1000, 'x');
+  std::string expected = "prefix";
+  std::string out = "prefix";
+  for (int i = 0; i < 100; ++i) {
+    StringAppendF(&expected, "%d:%s,%300d;", i, long_string.c_str(), i);
+    StrAppendFormat(&out, "%d:%s,%300d;", i, long_string, i);
+  }
+  EXPECT_EQ(expected, out);
+
+  EXPECT_EQ(StringPrintf("%.400f", 1.0), StrFormat("%.400f", 1.0));
+}
+
+TEST(StringFormatTest, ParsedFormat) {
+  constexpr ParsedFormat kFormat("a%-5d%%b%.2sc");
+  EXPECT_EQ(2u, kFormat.argument_count());
+  ASSERT_EQ(4u, kFormat.conversions().size());
+  EXPECT_EQ('d', kFormat.conversions()[0].type);
+  EXPECT_EQ(ParsedFormat::Conversion::kLeft, kFormat.conversions()[0].flags);
+  EXPECT_EQ(5, kFormat.conversions()[0].width);
+  EXPECT_EQ('%', kFormat.conversions()[1].type);
+  EXPECT_EQ('s', kFormat.conversions()[2].type);
+  EXPECT_EQ(2, kFormat.conversions()[2].precision);
+  EXPECT_EQ(0, kFormat.conversions()[3].type);
+  EXPECT_EQ(1u, kFormat.conversions()[3].literal_size);
+
+  EXPECT_EQ("a1    %bxyc", StrFormat(kFormat, 1, "xyz"));
+}
+
+TEST(StringFormatTest, MismatchedArguments) {
+  std::string out;
+  EXPECT_DCHECK_DEATH(StrAppendFormat(&out, "%s", 1));
+  EXPECT_DCHECK_DEATH(StrAppendFormat(&out, "%d", "string"));
+  EXPECT_DCHECK_DEATH(StrAppendFormat(&out, "%d %d", 1));
+  EXPECT_DCHECK_DEATH(StrAppendFormat(&out, "%d", 1, 2));
+  EXPECT_DCHECK_DEATH(StrAppendFormat(&out, "%*d", 1, 2));
+  EXPECT_DCHECK_DEATH(StrAppendFormat(&out, "%n", nullptr));
+  EXPECT_DCHECK_DEATH(StrAppendFormat(&out, ParsedFormat("%d %d"), 1));
+  EXPECT_DCHECK_DEATH(StrAppendFormat(&out, ParsedFormat("%y"), 1));
+}
+
+}  // namespace base
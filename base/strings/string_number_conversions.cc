@@ -4,6 +4,10 @@
 
 #include "base/strings/string_number_conversions.h"
 
+#include <stdint.h>
+#include <string.h>
+
+#include <cmath>
 #include <iterator>
 #include <string>
 
@@ -14,6 +18,71 @@
 
 namespace base {
 
+namespace internal {
+
+size_t DoubleToBuffer(double value, char* buffer) {
+  // -0.0, which is written as "-0", is left to double_conversion.
+  if (std::abs(value) < 1e12 && std::trunc(value) == value &&
+      !(value == 0 && std::signbit(value))) {
+    char digits[13];
+    char* const end = digits + sizeof(digits);
+    char* begin =
+        WriteDigitsBackwards(static_cast<uint64_t>(std::abs(value)), end);
+    if (value < 0)
+      *--begin = '-';
+    const size_t length = static_cast<size_t>(end - begin);
+    memcpy(buffer, begin, length);
+    return length;
+  }
+
+  double_conversion::StringBuilder builder(buffer, kDoubleToBufferSize);
+  GetDoubleToStringConverter()->ToShortest(value, &builder);
+  return static_cast<size_t>(builder.position());
+}
+
+}  // namespace internal
+
+namespace {
+
+template <typename INT>
+size_t IntToChars(INT value, span<char> buffer) {
+  char chars[internal::kMaxIntChars<INT>];
+  char* const end = chars + internal::kMaxIntChars<INT>;
+  const char* const begin = internal::IntToCharsT(value, end);
+  const size_t length = static_cast<size_t>(end - begin);
+  if (length > buffer.size())
+    return 0;
+  memcpy(buffer.data(), begin, length);
+  return length;
+}
+
+template <typename INT>
+size_t CharsToInt(StringPiece input, INT* output) {
+  using Parser = internal::StringToNumberParser<INT, 10>;
+  const char* const begin = input.data();
+  const char* const end = begin + input.size();
+  const char* digits = begin;
+  const bool negative =
+      std::numeric_limits<INT>::is_signed && digits != end && *digits == '-';
+  if (negative)
+    ++digits;
+  const char* digits_end = digits;
+  while (digits_end != end && IsAsciiDigit(*digits_end))
+    ++digits_end;
+  if (digits_end == digits)
+    return 0;
+
+  const typename Parser::Result result =
+      negative ? Parser::Negative::Invoke(digits, digits_end)
+               : Parser::Positive::Invoke(digits, digits_end);
+  if (!result.valid)
+    return 0;
+  *output = result.value;
+  return static_cast<size_t>(digits_end - begin);
+}
+
+}  // namespace
+
 std::string NumberToString(int value) {
   return internal::IntToStringT<std::string>(value);
 }
@@ -70,6 +139,30 @@ std::u16string NumberToString16(double value) {
   return internal::DoubleToStringT<std::u16string>(value);
 }
 
+size_t NumberToChars(int value, span<char> buffer) {
+  return IntToChars(value, buffer);
+}
+
+size_t NumberToChars(unsigned value, span<char> buffer) {
+  return IntToChars(value, buffer);
+}
+
+size_t NumberToChars(long value, span<char> buffer) {
+  return IntToChars(value, buffer);
+}
+
+size_t NumberToChars(unsigned long value, span<char> buffer) {
+  return IntToChars(value, buffer);
+}
+
+size_t NumberToChars(long long value, span<char> buffer) {
+  return IntToChars(value, buffer);
+}
+
+size_t NumberToChars(unsigned long long value, span<char> buffer) {
+  return IntToChars(value, buffer);
+}
+
 bool StringToInt(StringPiece input, int* output) {
   return internal::StringToIntImpl(input, *output);
 }
@@ -110,6 +203,22 @@ bool StringToSizeT(StringPiece16 input, size_t* output) {
   return internal::StringToIntImpl(input, *output);
 }
 
+size_t CharsToNumber(StringPiece input, int* output) {
+  return CharsToInt(input, output);
+}
+
+size_t CharsToNumber(StringPiece input, unsigned* output) {
+  return CharsToInt(input, output);
+}
+
+size_t CharsToNumber(StringPiece input, int64_t* output) {
+  return CharsToInt(input, output);
+}
+
+size_t CharsToNumber(StringPiece input, uint64_t* output) {
+  return CharsToInt(input, output);
+}
+
 bool StringToDouble(StringPiece input, double* output) {
   return internal::StringToDoubleImpl(input, input.data(), *output);
 }
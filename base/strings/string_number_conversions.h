@@ -52,6 +52,21 @@ BASE_EXPORT std::u16string NumberToString16(unsigned long long value);
 BASE_EXPORT std::string NumberToString(double value);
 BASE_EXPORT std::u16string NumberToString16(double value);
 
+// The maximum number of characters NumberToChars() writes, for the digits of
+// the largest uint64_t, or for '-' and the digits of the smallest int64_t.
+constexpr size_t kMaxIntegerChars = 20;
+
+// Writes |value| at the beginning of |buffer|, like NumberToString() but
+// without allocating, e.g. to format many numbers into the same output.
+// Returns the number of characters written, or 0 if |buffer| is too small,
+// which a buffer of kMaxIntegerChars never is.
+BASE_EXPORT size_t NumberToChars(int value, span<char> buffer);
+BASE_EXPORT size_t NumberToChars(unsigned int value, span<char> buffer);
+BASE_EXPORT size_t NumberToChars(long value, span<char> buffer);
+BASE_EXPORT size_t NumberToChars(unsigned long value, span<char> buffer);
+BASE_EXPORT size_t NumberToChars(long long value, span<char> buffer);
+BASE_EXPORT size_t NumberToChars(unsigned long long value, span<char> buffer);
+
 // String -> number conversions ------------------------------------------------
 
 // Perform a best-effort conversion of the input string to a numeric type,
@@ -85,6 +100,17 @@ BASE_EXPORT bool StringToUint64(StringPiece16 input, uint64_t* output);
 BASE_EXPORT bool StringToSizeT(StringPiece input, size_t* output);
 BASE_EXPORT bool StringToSizeT(StringPiece16 input, size_t* output);
 
+// Parses the integer at the beginning of |input|, like std::from_chars(): an
+// optional '-', for signed types only, then decimal digits, without
+// whitespace or '+'. Returns the number of characters parsed, or 0 if |input|
+// doesn't start with an integer or if the integer doesn't fit in |*output|.
+// |*output| is only written on success. This parses the numbers of a larger
+// input, e.g. the fields of a CSV line, without splitting it first.
+BASE_EXPORT size_t CharsToNumber(StringPiece input, int* output);
+BASE_EXPORT size_t CharsToNumber(StringPiece input, unsigned* output);
+BASE_EXPORT size_t CharsToNumber(StringPiece input, int64_t* output);
+BASE_EXPORT size_t CharsToNumber(StringPiece input, uint64_t* output);
+
 // For floating-point conversions, only conversions of input strings in decimal
 // form are defined to work.  Behavior with strings representing floating-point
 // numbers in hexadecimal, and strings representing non-finite values (such as
@@ -4,11 +4,15 @@
 
 #include <stddef.h>
 #include <stdint.h>
+#include <string.h>
 
+#include <cmath>
 #include <string>
 #include <vector>
 
+#include "base/bit_cast.h"
 #include "base/strings/string_number_conversions.h"
+#include "base/strings/string_number_conversions_internal.h"
 
 template <class NumberType, class StringPieceType, class StringType>
 void CheckRoundtripsT(const uint8_t* data,
@@ -48,6 +52,44 @@ void CheckRoundtrips16(const uint8_t* data,
       data, size, &base::NumberToString16, string_to_num);
 }
 
+// Checks that the fast paths of the double conversions agree with
+// double_conversion, and that the doubles round-trip.
+void CheckDoubleConversions(const uint8_t* data, const size_t size) {
+  if (size >= sizeof(double)) {
+    double value;
+    memcpy(&value, data, sizeof(value));
+
+    char fast[base::internal::kDoubleToBufferSize];
+    const size_t fast_length = base::internal::DoubleToBuffer(value, fast);
+    char slow[base::internal::kDoubleToBufferSize];
+    double_conversion::StringBuilder builder(slow, sizeof(slow));
+    base::internal::GetDoubleToStringConverter()->ToShortest(value, &builder);
+    CHECK_EQ(base::StringPiece(slow, builder.position()),
+             base::StringPiece(fast, fast_length));
+
+    if (std::isfinite(value)) {
+      double parsed;
+      CHECK(base::StringToDouble(base::StringPiece(fast, fast_length),
+                                 &parsed));
+      CHECK_EQ(bit_cast<uint64_t>(value), bit_cast<uint64_t>(parsed));
+    }
+  }
+
+  double fast;
+  if (base::internal::FastStringToDouble(reinterpret_cast<const char*>(data),
+                                         size, fast)) {
+    static double_conversion::StringToDoubleConverter converter(
+        double_conversion::StringToDoubleConverter::ALLOW_TRAILING_JUNK, 0.0,
+        0, nullptr, nullptr);
+    int processed_characters_count;
+    const double slow =
+        converter.StringToDouble(reinterpret_cast<const char*>(data),
+                                 size, &processed_characters_count);
+    CHECK_EQ(size, static_cast<size_t>(processed_characters_count));
+    CHECK_EQ(bit_cast<uint64_t>(slow), bit_cast<uint64_t>(fast));
+  }
+}
+
 // Entry point for LibFuzzer.
 extern "C" int LLVMFuzzerTestOneInput(const uint8_t* data, size_t size) {
   // For each instantiation of NumberToString f and its corresponding StringTo*
@@ -62,6 +104,7 @@ extern "C" int LLVMFuzzerTestOneInput(const uint8_t* data, size_t size) {
   CheckRoundtrips16<uint64_t>(data, size, &base::StringToUint64);
   CheckRoundtrips<size_t>(data, size, &base::StringToSizeT);
   CheckRoundtrips16<size_t>(data, size, &base::StringToSizeT);
+  CheckDoubleConversions(data, size);
 
   base::StringPiece string_piece_input(reinterpret_cast<const char*>(data),
                                        size);
@@ -7,53 +7,86 @@
 
 #include <ctype.h>
 #include <errno.h>
+#include <float.h>
+#include <stddef.h>
+#include <stdint.h>
 #include <stdlib.h>
+#include <string.h>
 #include <wctype.h>
 
 #include <limits>
 
+#include "base/base_export.h"
 #include "base/check_op.h"
 #include "base/logging.h"
 #include "base/numerics/safe_math.h"
 #include "base/strings/string_util.h"
 #include "base/third_party/double_conversion/double-conversion/double-conversion.h"
+#include "build/build_config.h"
 #include "third_party/abseil-cpp/absl/types/optional.h"
 
 namespace base {
 
 namespace internal {
 
-template <typename STR, typename INT>
-static STR IntToStringT(INT value) {
-  // log10(2) ~= 0.3 bytes needed per bit or per byte log10(2**8) ~= 2.4.
-  // So round up to allocate 3 output characters per byte, plus 1 for '-'.
-  const size_t kOutputBufSize =
-      3 * sizeof(INT) + std::numeric_limits<INT>::is_signed;
-
-  // Create the string in a temporary buffer, write it back to front, and
-  // then return the substr of what we ended up using.
-  using CHR = typename STR::value_type;
-  CHR outbuf[kOutputBufSize];
+// The digits of the numbers 0 to 99, two by two, to format numbers two digits
+// at a time.
+constexpr char kTwoDigits[] =
+    "0001020304050607080910111213141516171819"
+    "2021222324252627282930313233343536373839"
+    "4041424344454647484950515253545556575859"
+    "6061626364656667686970717273747576777879"
+    "8081828384858687888990919293949596979899";
+
+// Writes the decimal digits of |value| backwards, ending before |end|, and
+// returns the position of the first one.
+template <typename CHR, typename UINT>
+CHR* WriteDigitsBackwards(UINT value, CHR* end) {
+  while (value >= 100) {
+    const size_t index = static_cast<size_t>(value % 100) * 2;
+    value /= 100;
+    *--end = static_cast<CHR>(kTwoDigits[index + 1]);
+    *--end = static_cast<CHR>(kTwoDigits[index]);
+  }
+  if (value >= 10) {
+    const size_t index = static_cast<size_t>(value) * 2;
+    *--end = static_cast<CHR>(kTwoDigits[index + 1]);
+    *--end = static_cast<CHR>(kTwoDigits[index]);
+  } else {
+    *--end = static_cast<CHR>('0' + value);
+  }
+  return end;
+}
 
+// The maximum length of IntToCharsT(), for an INT of |size| bytes. log10(2)
+// ~= 0.3 bytes needed per bit or per byte log10(2**8) ~= 2.4. So round up to 3
+// output characters per byte, plus 1 for '-'.
+template <typename INT>
+constexpr size_t kMaxIntChars =
+    3 * sizeof(INT) + std::numeric_limits<INT>::is_signed;
+
+// Writes |value| backwards, ending before |end|, and returns the position of
+// its first character.
+template <typename CHR, typename INT>
+CHR* IntToCharsT(INT value, CHR* end) {
   // The ValueOrDie call below can never fail, because UnsignedAbs is valid
   // for all valid inputs.
-  std::make_unsigned_t<INT> res =
+  const std::make_unsigned_t<INT> res =
       CheckedNumeric<INT>(value).UnsignedAbs().ValueOrDie();
+  CHR* begin = WriteDigitsBackwards(res, end);
+  if (IsValueNegative(value))
+    *--begin = static_cast<CHR>('-');
+  return begin;
+}
 
-  CHR* end = outbuf + kOutputBufSize;
-  CHR* i = end;
-  do {
-    --i;
-    DCHECK(i != outbuf);
-    *i = static_cast<CHR>((res % 10) + '0');
-    res /= 10;
-  } while (res != 0);
-  if (IsValueNegative(value)) {
-    --i;
-    DCHECK(i != outbuf);
-    *i = static_cast<CHR>('-');
-  }
-  return STR(i, end);
+template <typename STR, typename INT>
+static STR IntToStringT(INT value) {
+  // Create the string in a temporary buffer, write it back to front, and
+  // then return the substr of what we ended up using.
+  using CHR = typename STR::value_type;
+  CHR outbuf[kMaxIntChars<INT>];
+  CHR* end = outbuf + kMaxIntChars<INT>;
+  return STR(IntToCharsT(value, end), end);
 }
 
 // Utility to convert a character to a digit in a given base
@@ -98,6 +131,72 @@ bool LocalIsWhitespace(CHAR c) {
   return WhitespaceHelper<CHAR>::Invoke(c);
 }
 
+#if defined(ARCH_CPU_LITTLE_ENDIAN)
+// Whether the 8 chars of |chunk|, loaded in little-endian order, are decimal
+// digits.
+inline bool IsEightDigits(uint64_t chunk) {
+  return ((chunk & 0xf0f0f0f0f0f0f0f0) |
+          (((chunk + 0x0606060606060606) & 0xf0f0f0f0f0f0f0f0) >> 4)) ==
+         0x3333333333333333;
+}
+
+// The value of the 8 decimal digits of |chunk|, loaded in little-endian order:
+// the digits are combined into pairs, then into groups of 4, with 3
+// multiplications in total.
+inline uint32_t ParseEightDigits(uint64_t chunk) {
+  chunk -= 0x3030303030303030;
+  chunk = chunk * 10 + (chunk >> 8);
+  chunk = ((chunk & 0x000000ff000000ff) * (100 + (uint64_t{1000000} << 32)) +
+           ((chunk >> 16) & 0x000000ff000000ff) *
+               (1 + (uint64_t{10000} << 32))) >>
+          32;
+  return static_cast<uint32_t>(chunk);
+}
+#endif  // defined(ARCH_CPU_LITTLE_ENDIAN)
+
+// Parses the digits of [begin, end) in base |kBase| into |magnitude|, if
+// there are at most as many as always fit in a uint64_t, with a single
+// bounds check against |max|. The decimal digits of narrow strings are
+// parsed 8 at a time. Returns false if [begin, end) is empty, has too many
+// digits or a non-digit, or if its value is above |max|: the digit-by-digit
+// parser handles these cases.
+template <int kBase, typename CHAR>
+bool FastParseDigits(const CHAR* begin,
+                     const CHAR* end,
+                     uint64_t max,
+                     uint64_t& magnitude) {
+  static_assert(kBase == 10 || kBase == 16, "");
+  // 10^19 - 1 and 16^16 - 1 are the largest numbers of as many digits below
+  // 2^64.
+  constexpr ptrdiff_t kMaxDigits = kBase == 10 ? 19 : 16;
+  if (begin == end || end - begin > kMaxDigits)
+    return false;
+
+  uint64_t value = 0;
+  const CHAR* p = begin;
+#if defined(ARCH_CPU_LITTLE_ENDIAN)
+  if (kBase == 10 && sizeof(CHAR) == 1) {
+    for (; end - p >= 8; p += 8) {
+      uint64_t chunk;
+      memcpy(&chunk, p, sizeof(chunk));
+      if (!IsEightDigits(chunk))
+        return false;
+      value = value * 100000000 + ParseEightDigits(chunk);
+    }
+  }
+#endif  // defined(ARCH_CPU_LITTLE_ENDIAN)
+  for (; p != end; ++p) {
+    absl::optional<uint8_t> digit = CharToDigit<kBase>(*p);
+    if (!digit)
+      return false;
+    value = value * kBase + *digit;
+  }
+  if (value > max)
+    return false;
+  magnitude = value;
+  return true;
+}
+
 template <typename Number, int kBase>
 class StringToNumberParser {
  public:
@@ -132,6 +231,13 @@ class StringToNumberParser {
         begin += 2;
       }
 
+      // Most numbers have few enough digits to be parsed without a bounds
+      // check per digit. The loop below handles the others, and reports how
+      // parsing failed.
+      uint64_t magnitude;
+      if (FastParseDigits<kBase>(begin, end, Sign::kMaxMagnitude, magnitude))
+        return {Sign::FromMagnitude(magnitude), true};
+
       for (Iter current = begin; current != end; ++current) {
         absl::optional<uint8_t> new_digit = CharToDigit<kBase>(*current);
 
@@ -155,6 +261,11 @@ class StringToNumberParser {
 
   class Positive : public Base<Positive> {
    public:
+    static constexpr uint64_t kMaxMagnitude = static_cast<uint64_t>(kMax);
+    static Number FromMagnitude(uint64_t magnitude) {
+      return static_cast<Number>(magnitude);
+    }
+
     static Result CheckBounds(Number value, uint8_t new_digit) {
       if (value > static_cast<Number>(kMax / kBase) ||
           (value == static_cast<Number>(kMax / kBase) &&
@@ -168,6 +279,15 @@ class StringToNumberParser {
 
   class Negative : public Base<Negative> {
    public:
+    static constexpr uint64_t kMaxMagnitude =
+        std::numeric_limits<Number>::is_signed
+            ? static_cast<uint64_t>(-(kMin + 1)) + 1
+            : 0;
+    static Number FromMagnitude(uint64_t magnitude) {
+      // Negates |magnitude| without overflowing for kMin.
+      return magnitude == 0 ? 0 : -static_cast<Number>(magnitude - 1) - 1;
+    }
+
     static Result CheckBounds(Number value, uint8_t new_digit) {
       if (value < kMin / kBase ||
           (value == kMin / kBase && new_digit > 0 - kMin % kBase)) {
@@ -247,16 +367,122 @@ StringT ToString(const CharT* data, size_t size) {
   return StringT(data, data + size);
 }
 
+// The size of the buffers of DoubleToBuffer(), enough for any double.
+constexpr size_t kDoubleToBufferSize = 32;
+
+// Writes the shortest representation of |value| which round-trips to
+// |buffer|, and returns its length. The integers below 1e12, which
+// double_conversion writes as their digits, don't need its conversion to
+// decimal digits and are written directly.
+BASE_EXPORT size_t DoubleToBuffer(double value, char* buffer);
+
 template <typename StringT>
 StringT DoubleToStringT(double value) {
-  char buffer[32];
-  double_conversion::StringBuilder builder(buffer, sizeof(buffer));
-  GetDoubleToStringConverter()->ToShortest(value, &builder);
-  return ToString<StringT>(buffer, builder.position());
+  char buffer[kDoubleToBufferSize];
+  const size_t length = DoubleToBuffer(value, buffer);
+  return ToString<StringT>(buffer, length);
+}
+
+// The fast path of StringToDouble(), for the decimal numbers whose significand
+// and power of ten are both exact doubles: the correctly rounded result is
+// then their product or quotient, with a single rounding (Clinger's fast
+// path). That covers most numbers short enough to be written by hand or by
+// NumberToString(), e.g. "0.25" or "-123.456e3". Returns false if |data| is not
+// such a number, which leaves its conversion, or its rejection, to
+// double_conversion.
+template <typename CHAR>
+bool FastStringToDouble(const CHAR* data, size_t size, double& output) {
+#if FLT_EVAL_METHOD != 0
+  // The operations must be rounded as doubles, not with a wider precision.
+  return false;
+#else
+  // The integral powers of ten which are exact doubles.
+  static constexpr double kPowersOfTen[] = {
+      1e0,  1e1,  1e2,  1e3,  1e4,  1e5,  1e6,  1e7,  1e8,  1e9,  1e10, 1e11,
+      1e12, 1e13, 1e14, 1e15, 1e16, 1e17, 1e18, 1e19, 1e20, 1e21, 1e22};
+  constexpr int kMaxExactPowerOfTen = 22;
+  constexpr uint64_t kMaxExactInteger = uint64_t{1} << 53;
+  // Up to 19 digits fit in a uint64_t.
+  constexpr int kMaxDigits = 19;
+
+  const CHAR* const end = data + size;
+  const CHAR* p = data;
+  bool negative = false;
+  if (p != end && (*p == '-' || *p == '+'))
+    negative = *p++ == '-';
+
+  uint64_t significand = 0;
+  int significant_digits = 0;
+  int exponent = 0;
+  bool has_digits = false;
+  for (; p != end && IsAsciiDigit(*p); ++p) {
+    has_digits = true;
+    if (significand == 0 && *p == '0')
+      continue;
+    if (++significant_digits > kMaxDigits)
+      return false;
+    significand = significand * 10 + static_cast<uint64_t>(*p - '0');
+  }
+  if (p != end && *p == '.') {
+    for (++p; p != end && IsAsciiDigit(*p); ++p) {
+      has_digits = true;
+      --exponent;
+      if (significand == 0 && *p == '0')
+        continue;
+      if (++significant_digits > kMaxDigits)
+        return false;
+      significand = significand * 10 + static_cast<uint64_t>(*p - '0');
+    }
+  }
+  if (!has_digits)
+    return false;
+
+  if (p != end && (*p == 'e' || *p == 'E')) {
+    ++p;
+    bool negative_exponent = false;
+    if (p != end && (*p == '-' || *p == '+'))
+      negative_exponent = *p++ == '-';
+    if (p == end)
+      return false;
+    int explicit_exponent = 0;
+    for (; p != end && IsAsciiDigit(*p); ++p) {
+      // Larger exponents are outside of the fast path anyway.
+      if (explicit_exponent > 1000)
+        return false;
+      explicit_exponent = explicit_exponent * 10 + (*p - '0');
+    }
+    exponent += negative_exponent ? -explicit_exponent : explicit_exponent;
+  }
+  if (p != end || significand > kMaxExactInteger)
+    return false;
+
+  double result;
+  if (significand == 0) {
+    result = 0;
+  } else if (exponent < 0) {
+    if (exponent < -kMaxExactPowerOfTen)
+      return false;
+    result = static_cast<double>(significand) / kPowersOfTen[-exponent];
+  } else {
+    // A small significand can absorb the excess of the exponent, e.g. 1e25 is
+    // 1000 * 1e22.
+    for (; exponent > kMaxExactPowerOfTen; --exponent) {
+      if (significand > kMaxExactInteger / 10)
+        return false;
+      significand *= 10;
+    }
+    result = static_cast<double>(significand) * kPowersOfTen[exponent];
+  }
+  output = negative ? -result : result;
+  return true;
+#endif
 }
 
 template <typename STRING, typename CHAR>
 bool StringToDoubleImpl(STRING input, const CHAR* data, double& output) {
+  if (FastStringToDouble(data, input.size(), output))
+    return true;
+
   static double_conversion::StringToDoubleConverter converter(
       double_conversion::StringToDoubleConverter::ALLOW_LEADING_SPACES |
           double_conversion::StringToDoubleConverter::ALLOW_TRAILING_JUNK,
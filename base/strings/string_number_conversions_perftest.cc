@@ -0,0 +1,152 @@
+// Copyright 2022 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "base/strings/string_number_conversions.h"
+
+#include <stdint.h>
+
+#include <string>
+#include <vector>
+
+#include "base/time/time.h"
+#include "base/timer/lap_timer.h"
+#include "testing/gtest/include/gtest/gtest.h"
+#include "testing/perf/perf_result_reporter.h"
+
+namespace base {
+namespace {
+
+constexpr TimeDelta kTimeLimit = Seconds(2);
+constexpr int kWarmupRuns = 10;
+constexpr int kTimeCheckInterval = 10;
+constexpr size_t kNumbersPerLap = 1024;
+
+constexpr char kMetricPrefixStringNumberConversions[] =
+    "StringNumberConversions.";
+constexpr char kMetricThroughput[] = "throughput";
+constexpr char kMetricTimePerNumber[] = "time_per_number";
+
+perf_test::PerfResultReporter SetUpReporter(const std::string& story_name) {
+  perf_test::PerfResultReporter reporter(kMetricPrefixStringNumberConversions,
+                                         story_name);
+  reporter.RegisterImportantMetric(kMetricThroughput, "runs/s");
+  reporter.RegisterImportantMetric(kMetricTimePerNumber, "ns");
+  return reporter;
+}
+
+void ReportResults(const std::string& story_name, const LapTimer& timer) {
+  auto reporter = SetUpReporter(story_name);
+  float numbers_per_second = timer.LapsPerSecond() * kNumbersPerLap;
+  reporter.AddResult(kMetricThroughput, numbers_per_second);
+  reporter.AddResult(kMetricTimePerNumber, 1e9 / numbers_per_second);
+}
+
+// The doubles of a metrics payload: counts, short decimals, and results of
+// computations which need all their digits.
+std::vector<double> GenerateDoubles() {
+  std::vector<double> doubles;
+  for (size_t i = 0; i < kNumbersPerLap; i++) {
+    switch (i % 3) {
+      case 0:
+        doubles.push_back(i * 1000);
+        break;
+      case 1:
+        doubles.push_back(i * 0.25);
+        break;
+      default:
+        doubles.push_back(i / 3.0);
+        break;
+    }
+  }
+  return doubles;
+}
+
+// The integers of a CSV or metrics payload, of all lengths.
+std::vector<int64_t> GenerateIntegers() {
+  std::vector<int64_t> integers;
+  uint64_t state = 88172645463325252u;
+  for (size_t i = 0; i < kNumbersPerLap; i++) {
+    // xorshift64.
+    state ^= state << 13;
+    state ^= state >> 7;
+    state ^= state << 17;
+    const int64_t value = static_cast<int64_t>(state >> (i % 60));
+    integers.push_back(i % 3 ? value : -value);
+  }
+  return integers;
+}
+
+}  // namespace
+
+TEST(StringNumberConversionsPerfTest, NumberToStringInt64) {
+  const std::vector<int64_t> integers = GenerateIntegers();
+  LapTimer timer(kWarmupRuns, kTimeLimit, kTimeCheckInterval);
+  size_t length = 0;
+  do {
+    for (int64_t value : integers)
+      length += NumberToString(value).size();
+    timer.NextLap();
+  } while (!timer.HasTimeLimitExpired());
+  EXPECT_GT(length, 0u);
+  ReportResults("NumberToStringInt64", timer);
+}
+
+TEST(StringNumberConversionsPerfTest, NumberToChars) {
+  const std::vector<int64_t> integers = GenerateIntegers();
+  LapTimer timer(kWarmupRuns, kTimeLimit, kTimeCheckInterval);
+  char buffer[kMaxIntegerChars];
+  size_t length = 0;
+  do {
+    for (int64_t value : integers)
+      length += NumberToChars(value, buffer);
+    timer.NextLap();
+  } while (!timer.HasTimeLimitExpired());
+  EXPECT_GT(length, 0u);
+  ReportResults("NumberToChars", timer);
+}
+
+TEST(StringNumberConversionsPerfTest, StringToInt64) {
+  std::vector<std::string> strings;
+  for (int64_t value : GenerateIntegers())
+    strings.push_back(NumberToString(value));
+  LapTimer timer(kWarmupRuns, kTimeLimit, kTimeCheckInterval);
+  do {
+    for (const std::string& string : strings) {
+      int64_t value;
+      ASSERT_TRUE(StringToInt64(string, &value));
+    }
+    timer.NextLap();
+  } while (!timer.HasTimeLimitExpired());
+  ReportResults("StringToInt64", timer);
+}
+
+TEST(StringNumberConversionsPerfTest, NumberToString) {
+  const std::vector<double> doubles = GenerateDoubles();
+  LapTimer timer(kWarmupRuns, kTimeLimit, kTimeCheckInterval);
+  size_t length = 0;
+  do {
+    for (double value : doubles)
+      length += NumberToString(value).size();
+    timer.NextLap();
+  } while (!timer.HasTimeLimitExpired());
+  EXPECT_GT(length, 0u);
+  ReportResults("NumberToString", timer);
+}
+
+TEST(StringNumberConversionsPerfTest, StringToDouble) {
+  std::vector<std::string> strings;
+  for (double value : GenerateDoubles())
+    strings.push_back(NumberToString(value));
+  LapTimer timer(kWarmupRuns, kTimeLimit, kTimeCheckInterval);
+  do {
+    for (const std::string& string : strings) {
+      double value;
+      ASSERT_TRUE(StringToDouble(string, &value));
+    }
+    timer.NextLap();
+  } while (!timer.HasTimeLimitExpired());
+  ReportResults("StringToDouble", timer);
+}
+
+}  // namespace base
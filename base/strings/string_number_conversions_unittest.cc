@@ -12,8 +12,10 @@
 
 #include <cmath>
 #include <limits>
+#include <string>
 
 #include "base/bit_cast.h"
+#include "base/containers/span.h"
 #include "base/cxx17_backports.h"
 #include "base/format_macros.h"
 #include "base/strings/stringprintf.h"
@@ -438,6 +440,120 @@ TEST(StringNumberConversionsTest, StringToSizeT) {
   EXPECT_EQ(6U, output);
 }
 
+TEST(StringNumberConversionsTest, StringToIntDigitRuns) {
+  // Around the 8-digit chunks of the fast path, and its limit of 19 digits.
+  static const struct {
+    const char* input;
+    int64_t output;
+    bool success;
+  } cases[] = {
+      {"12345678", 12345678, true},
+      {"-12345678", -12345678, true},
+      {"123456789", 123456789, true},
+      {"1234567890123456", 1234567890123456, true},
+      {"12345678901234567", 12345678901234567, true},
+      {"9223372036854775807", INT64_C(9223372036854775807), true},
+      {"-9223372036854775808", std::numeric_limits<int64_t>::min(), true},
+      {"9223372036854775808", INT64_C(9223372036854775807), false},
+      {"-9223372036854775809", std::numeric_limits<int64_t>::min(), false},
+      {"00000000000000000000000000001", 1, true},
+      {"-0000000000000000000000000001", -1, true},
+      {"99999999999999999999", INT64_C(9223372036854775807), false},
+      {"1234567x", 1234567, false},
+      {"12345678x", 12345678, false},
+      {"1234/678", 1234, false},
+      {"1234:678", 1234, false},
+      {"12345678901234x6", INT64_C(12345678901234), false},
+      {"1234567 ", 1234567, false},
+  };
+
+  for (const auto& i : cases) {
+    SCOPED_TRACE(i.input);
+    int64_t output = 0;
+    EXPECT_EQ(i.success, StringToInt64(i.input, &output));
+    EXPECT_EQ(i.output, output);
+
+    output = 0;
+    EXPECT_EQ(i.success, StringToInt64(UTF8ToUTF16(i.input), &output));
+    EXPECT_EQ(i.output, output);
+  }
+
+  uint64_t output = 0;
+  EXPECT_TRUE(StringToUint64("18446744073709551615", &output));
+  EXPECT_EQ(std::numeric_limits<uint64_t>::max(), output);
+  EXPECT_FALSE(StringToUint64("18446744073709551616", &output));
+  EXPECT_EQ(std::numeric_limits<uint64_t>::max(), output);
+  EXPECT_TRUE(HexStringToUInt64("0xFFFFFFFFFFFFFFFF", &output));
+  EXPECT_EQ(std::numeric_limits<uint64_t>::max(), output);
+  EXPECT_TRUE(HexStringToUInt64("000000000000000000FF", &output));
+  EXPECT_EQ(0xFFu, output);
+  EXPECT_FALSE(HexStringToUInt64("10000000000000000", &output));
+  EXPECT_EQ(std::numeric_limits<uint64_t>::max(), output);
+}
+
+TEST(StringNumberConversionsTest, NumberToChars) {
+  char buffer[kMaxIntegerChars];
+  for (int64_t value :
+       {int64_t{0}, int64_t{7}, int64_t{-7}, int64_t{10}, int64_t{99},
+        int64_t{100}, int64_t{-12345}, int64_t{1234567890123},
+        std::numeric_limits<int64_t>::max(),
+        std::numeric_limits<int64_t>::min()}) {
+    const size_t length = NumberToChars(value, buffer);
+    EXPECT_EQ(NumberToString(value), std::string(buffer, length));
+  }
+  const size_t length =
+      NumberToChars(std::numeric_limits<uint64_t>::max(), buffer);
+  EXPECT_EQ("18446744073709551615", std::string(buffer, length));
+  EXPECT_EQ(kMaxIntegerChars, length);
+
+  // The buffer is too small.
+  EXPECT_EQ(0u, NumberToChars(12345, make_span(buffer, 4)));
+  EXPECT_EQ(4u, NumberToChars(-123, make_span(buffer, 4)));
+  EXPECT_EQ("-123", std::string(buffer, 4));
+}
+
+TEST(StringNumberConversionsTest, CharsToNumber) {
+  int output = 0;
+  EXPECT_EQ(3u, CharsToNumber("123,456", &output));
+  EXPECT_EQ(123, output);
+  EXPECT_EQ(4u, CharsToNumber("-123", &output));
+  EXPECT_EQ(-123, output);
+  EXPECT_EQ(10u, CharsToNumber("2147483647 ", &output));
+  EXPECT_EQ(2147483647, output);
+
+  // Failures leave |output| unchanged.
+  EXPECT_EQ(0u, CharsToNumber("2147483648", &output));
+  EXPECT_EQ(0u, CharsToNumber("", &output));
+  EXPECT_EQ(0u, CharsToNumber("-", &output));
+  EXPECT_EQ(0u, CharsToNumber(" 1", &output));
+  EXPECT_EQ(0u, CharsToNumber("+1", &output));
+  EXPECT_EQ(0u, CharsToNumber("x1", &output));
+  EXPECT_EQ(2147483647, output);
+
+  unsigned unsigned_output = 0;
+  EXPECT_EQ(0u, CharsToNumber("-1", &unsigned_output));
+  EXPECT_EQ(10u, CharsToNumber("4294967295", &unsigned_output));
+  EXPECT_EQ(4294967295u, unsigned_output);
+
+  // Parses the fields of a CSV line.
+  const StringPiece line = "12,-3456789012345,7";
+  int64_t fields[3];
+  size_t position = 0;
+  for (int64_t& field : fields) {
+    const size_t length = CharsToNumber(line.substr(position), &field);
+    ASSERT_GT(length, 0u);
+    position += length + 1;
+  }
+  EXPECT_EQ(line.size() + 1, position);
+  EXPECT_EQ(12, fields[0]);
+  EXPECT_EQ(INT64_C(-3456789012345), fields[1]);
+  EXPECT_EQ(7, fields[2]);
+
+  uint64_t uint64_output = 0;
+  EXPECT_EQ(20u, CharsToNumber("18446744073709551615", &uint64_output));
+  EXPECT_EQ(std::numeric_limits<uint64_t>::max(), uint64_output);
+}
+
 TEST(StringNumberConversionsTest, HexStringToInt) {
   static const struct {
     std::string input;
@@ -891,6 +1007,14 @@ TEST(StringNumberConversionsTest, DoubleToString) {
       {1.33505e+012, "1.33505e+12"},
       {1.33545e+009, "1335450000"},
       {1.33503e+009, "1335030000"},
+      // The integers below 1e12 are written without double_conversion.
+      {-0.0, "-0"},
+      {42.0, "42"},
+      {-7.0, "-7"},
+      {999999999999.0, "999999999999"},
+      {-999999999999.0, "-999999999999"},
+      {1e12, "1e+12"},
+      {-1e12, "-1e+12"},
   };
 
   for (const auto& i : cases) {
@@ -969,4 +1093,36 @@ TEST(StringNumberConversionsTest, StrtodFailures) {
   }
 }
 
+// The fast path of StringToDouble() is only taken when the significand and
+// the power of ten are exact doubles. Check the conversions around these
+// bounds, which are correctly rounded either way.
+TEST(StringNumberConversionsTest, StringToDoubleFastPath) {
+  static const struct {
+    const char* input;
+    uint64_t expected;
+  } cases[] = {
+      {"0.1", 0x3fb999999999999aULL},
+      {"-0.0001", 0xbf1a36e2eb1c432dULL},
+      {"-0", 0x8000000000000000ULL},
+      {"-0.0e5", 0x8000000000000000ULL},
+      {"9007199254740992", 0x4340000000000000ULL},
+      {"9007199254740993", 0x4340000000000000ULL},
+      {"1e22", 0x4480f0cf064dd592ULL},
+      {"1e23", 0x44b52d02c7e14af6ULL},
+      {"12345e20", 0x44f056a610c7aae1ULL},
+      {"123456789012345678e-22", 0x3ee9e409302678baULL},
+      {"1.7976931348623157e308", 0x7fefffffffffffffULL},
+      {"4.9e-324", 0x1ULL},
+  };
+
+  for (const auto& test : cases) {
+    SCOPED_TRACE(StringPrintf("input: \"%s\"", test.input));
+    double output;
+    EXPECT_TRUE(StringToDouble(test.input, &output));
+    EXPECT_EQ(bit_cast<uint64_t>(output), test.expected);
+    EXPECT_TRUE(StringToDouble(UTF8ToUTF16(test.input), &output));
+    EXPECT_EQ(bit_cast<uint64_t>(output), test.expected);
+  }
+}
+
 }  // namespace base
@@ -45,6 +45,21 @@ bool AppendStringKeyValue(StringPiece input,
   return true;
 }
 
+template <typename Pieces>
+bool AppendStringKeyValuePairs(const Pieces& pairs,
+                               char key_value_delimiter,
+                               StringPairs* key_value_pairs) {
+  bool success = true;
+  for (const StringPiece& pair : pairs) {
+    if (!AppendStringKeyValue(pair, key_value_delimiter, key_value_pairs)) {
+      // Don't return here, to allow for pairs without associated
+      // value or key; just record that the split failed.
+      success = false;
+    }
+  }
+  return success;
+}
+
 }  // namespace
 
 std::vector<std::string> SplitString(StringPiece input,
@@ -83,9 +98,12 @@ bool SplitStringIntoKeyValuePairs(StringPiece input,
                                   char key_value_delimiter,
                                   char key_value_pair_delimiter,
                                   StringPairs* key_value_pairs) {
-  return SplitStringIntoKeyValuePairsUsingSubstr(
-      input, key_value_delimiter, StringPiece(&key_value_pair_delimiter, 1),
-      key_value_pairs);
+  key_value_pairs->clear();
+  // Iterates the pairs once, without collecting them first.
+  return AppendStringKeyValuePairs(
+      SplitStringPieceRange(input, StringPiece(&key_value_pair_delimiter, 1),
+                            TRIM_WHITESPACE, SPLIT_WANT_NONEMPTY),
+      key_value_delimiter, key_value_pairs);
 }
 
 bool SplitStringIntoKeyValuePairsUsingSubstr(
@@ -98,16 +116,8 @@ bool SplitStringIntoKeyValuePairsUsingSubstr(
   std::vector<StringPiece> pairs = SplitStringPieceUsingSubstr(
       input, key_value_pair_delimiter, TRIM_WHITESPACE, SPLIT_WANT_NONEMPTY);
   key_value_pairs->reserve(pairs.size());
-
-  bool success = true;
-  for (const StringPiece& pair : pairs) {
-    if (!AppendStringKeyValue(pair, key_value_delimiter, key_value_pairs)) {
-      // Don't return here, to allow for pairs without associated
-      // value or key; just record that the split failed.
-      success = false;
-    }
-  }
-  return success;
+  return AppendStringKeyValuePairs(pairs, key_value_delimiter,
+                                   key_value_pairs);
 }
 
 std::vector<std::u16string> SplitStringUsingSubstr(
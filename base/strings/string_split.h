@@ -5,12 +5,19 @@
 #ifndef BASE_STRINGS_STRING_SPLIT_H_
 #define BASE_STRINGS_STRING_SPLIT_H_
 
+#include <stddef.h>
+
+#include <iterator>
 #include <string>
 #include <utility>
 #include <vector>
 
 #include "base/base_export.h"
+#include "base/check.h"
+#include "base/memory/raw_ptr.h"
+#include "base/strings/ascii_simd.h"
 #include "base/strings/string_piece.h"
+#include "base/strings/string_util.h"
 #include "build/build_config.h"
 
 namespace base {
@@ -81,6 +88,208 @@ enum SplitResult {
     WhitespaceHandling whitespace,
     SplitResult result_type);
 
+namespace internal {
+
+// Returns either the ASCII or UTF-16 whitespace.
+template <typename CharT>
+BasicStringPiece<CharT> WhitespaceForType();
+
+template <>
+inline StringPiece16 WhitespaceForType<char16_t>() {
+  return kWhitespaceUTF16;
+}
+template <>
+inline StringPiece WhitespaceForType<char>() {
+  return kWhitespaceASCII;
+}
+
+// Trims the whitespace of a piece of a split string.
+template <typename CharT>
+BasicStringPiece<CharT> TrimPieceWhitespace(BasicStringPiece<CharT> piece) {
+  return TrimString(piece, WhitespaceForType<CharT>(), TRIM_ALL);
+}
+template <>
+inline StringPiece TrimPieceWhitespace<char>(StringPiece piece) {
+  return TrimWhitespaceASCII(piece, TRIM_ALL);
+}
+
+// Finds the separators of the split strings.
+template <typename CharT>
+class SeparatorFinder {
+ public:
+  explicit SeparatorFinder(BasicStringPiece<CharT> separators)
+      : separators_(separators) {}
+
+  size_t Find(BasicStringPiece<CharT> str, size_t pos) const {
+    return separators_.size() == 1 ? str.find(separators_[0], pos)
+                                   : str.find_first_of(separators_, pos);
+  }
+
+ private:
+  BasicStringPiece<CharT> separators_;
+};
+
+// Finds a single separator with memchr(), and several with a ByteSet, built
+// once rather than for each piece as find_first_of() would.
+template <>
+class SeparatorFinder<char> {
+ public:
+  explicit SeparatorFinder(StringPiece separators)
+      : single_separator_(separators.size() == 1) {
+    if (single_separator_)
+      separator_ = separators[0];
+    else
+      separator_set_ = ByteSet(separators);
+  }
+
+  size_t Find(StringPiece str, size_t pos) const {
+    if (single_separator_)
+      return str.find(separator_, pos);
+    if (pos >= str.size())
+      return StringPiece::npos;
+    const size_t found = separator_set_.FindFirstOf(str.substr(pos));
+    return found == StringPiece::npos ? found : pos + found;
+  }
+
+ private:
+  bool single_separator_;
+  char separator_ = 0;
+  ByteSet separator_set_;
+};
+
+}  // namespace internal
+
+// A forward range over the pieces which SplitStringPiece() returns. It finds
+// them as it's iterated, so that a single pass over the pieces allocates
+// nothing. |input| must outlive the range, and the range its iterators.
+//
+// To iterate through the lines of an input string:
+//
+//   for (StringPiece line :
+//        base::SplitStringPieceRange(input, "\n", base::TRIM_WHITESPACE,
+//                                    base::SPLIT_WANT_NONEMPTY)) {
+//     ...
+template <typename CharT>
+class BasicSplitStringPieceRange {
+ public:
+  using Piece = BasicStringPiece<CharT>;
+
+  class Iterator {
+   public:
+    using iterator_category = std::forward_iterator_tag;
+    using value_type = Piece;
+    using difference_type = std::ptrdiff_t;
+    using pointer = const Piece*;
+    using reference = const Piece&;
+
+    // Constructs the end iterator.
+    Iterator() = default;
+
+    reference operator*() const {
+      DCHECK(range_);
+      return piece_;
+    }
+    pointer operator->() const {
+      DCHECK(range_);
+      return &piece_;
+    }
+
+    Iterator& operator++() {
+      Advance();
+      return *this;
+    }
+    Iterator operator++(int) {
+      Iterator it = *this;
+      Advance();
+      return it;
+    }
+
+    friend bool operator==(const Iterator& a, const Iterator& b) {
+      return a.range_ == b.range_ && a.next_start_ == b.next_start_;
+    }
+    friend bool operator!=(const Iterator& a, const Iterator& b) {
+      return !(a == b);
+    }
+
+   private:
+    friend class BasicSplitStringPieceRange;
+
+    explicit Iterator(const BasicSplitStringPieceRange* range)
+        : range_(range), next_start_(range->input_.empty() ? Piece::npos : 0) {
+      Advance();
+    }
+
+    void Advance() {
+      DCHECK(range_);
+      const Piece input = range_->input_;
+      while (next_start_ != Piece::npos) {
+        const size_t start = next_start_;
+        const size_t end = range_->separators_.Find(input, start);
+        if (end == Piece::npos) {
+          piece_ = input.substr(start);
+          next_start_ = Piece::npos;
+        } else {
+          piece_ = input.substr(start, end - start);
+          next_start_ = end + 1;
+        }
+
+        if (range_->whitespace_ == TRIM_WHITESPACE)
+          piece_ = internal::TrimPieceWhitespace(piece_);
+        if (range_->result_type_ == SPLIT_WANT_ALL || !piece_.empty())
+          return;
+      }
+      range_ = nullptr;
+      piece_ = Piece();
+    }
+
+    // Null for the end iterator.
+    raw_ptr<const BasicSplitStringPieceRange> range_ = nullptr;
+    Piece piece_;
+    // The start of the piece after |piece_|, or npos if it's the last one.
+    size_t next_start_ = Piece::npos;
+  };
+
+  using iterator = Iterator;
+  using const_iterator = Iterator;
+
+  BasicSplitStringPieceRange(Piece input,
+                             Piece separators,
+                             WhitespaceHandling whitespace,
+                             SplitResult result_type)
+      : input_(input),
+        separators_(separators),
+        whitespace_(whitespace),
+        result_type_(result_type) {}
+
+  Iterator begin() const { return Iterator(this); }
+  Iterator end() const { return Iterator(); }
+
+ private:
+  Piece input_;
+  internal::SeparatorFinder<CharT> separators_;
+  WhitespaceHandling whitespace_;
+  SplitResult result_type_;
+};
+
+// Like SplitStringPiece above, but returns a range which finds the pieces as
+// it's iterated, instead of a vector of all of them.
+[[nodiscard]] inline BasicSplitStringPieceRange<char> SplitStringPieceRange(
+    StringPiece input,
+    StringPiece separators,
+    WhitespaceHandling whitespace,
+    SplitResult result_type) {
+  return BasicSplitStringPieceRange<char>(input, separators, whitespace,
+                                          result_type);
+}
+[[nodiscard]] inline BasicSplitStringPieceRange<char16_t>
+SplitStringPieceRange(StringPiece16 input,
+                      StringPiece16 separators,
+                      WhitespaceHandling whitespace,
+                      SplitResult result_type) {
+  return BasicSplitStringPieceRange<char16_t>(input, separators, whitespace,
+                                              result_type);
+}
+
 using StringPairs = std::vector<std::pair<std::string, std::string>>;
 
 // Splits |line| into key value pairs according to the given delimiters and
@@ -8,25 +8,13 @@
 #include <vector>
 
 #include "base/strings/string_piece.h"
+#include "base/strings/string_split.h"
 #include "base/strings/string_util.h"
 
 namespace base {
 
 namespace internal {
 
-// Returns either the ASCII or UTF-16 whitespace.
-template <typename CharT>
-BasicStringPiece<CharT> WhitespaceForType();
-
-template <>
-inline StringPiece16 WhitespaceForType<char16_t>() {
-  return kWhitespaceUTF16;
-}
-template <>
-inline StringPiece WhitespaceForType<char>() {
-  return kWhitespaceASCII;
-}
-
 // General string splitter template. Can take 8- or 16-bit input, can produce
 // the corresponding string or StringPiece output.
 template <typename OutputStringType,
@@ -37,27 +25,9 @@ static std::vector<OutputStringType> SplitStringT(T str,
                                                   WhitespaceHandling whitespace,
                                                   SplitResult result_type) {
   std::vector<OutputStringType> result;
-  if (str.empty())
-    return result;
-
-  size_t start = 0;
-  while (start != std::basic_string<CharT>::npos) {
-    size_t end = str.find_first_of(delimiter, start);
-
-    BasicStringPiece<CharT> piece;
-    if (end == std::basic_string<CharT>::npos) {
-      piece = str.substr(start);
-      start = std::basic_string<CharT>::npos;
-    } else {
-      piece = str.substr(start, end - start);
-      start = end + 1;
-    }
-
-    if (whitespace == TRIM_WHITESPACE)
-      piece = TrimString(piece, WhitespaceForType<CharT>(), TRIM_ALL);
-
-    if (result_type == SPLIT_WANT_ALL || !piece.empty())
-      result.emplace_back(piece);
+  for (BasicStringPiece<CharT> piece : BasicSplitStringPieceRange<CharT>(
+           str, delimiter, whitespace, result_type)) {
+    result.emplace_back(piece);
   }
   return result;
 }
@@ -451,4 +451,61 @@ TEST(StringSplitTest, SplitStringAlongWhitespace) {
   }
 }
 
+TEST(SplitStringPieceRangeTest, Basics) {
+  std::vector<StringPiece> pieces;
+  for (StringPiece piece : SplitStringPieceRange(
+           "a=1& b=2 &&c=3", "&", TRIM_WHITESPACE, SPLIT_WANT_NONEMPTY)) {
+    pieces.push_back(piece);
+  }
+  EXPECT_THAT(pieces, testing::ElementsAre("a=1", "b=2", "c=3"));
+
+  const auto range =
+      SplitStringPieceRange(",a,,b,", ",", KEEP_WHITESPACE, SPLIT_WANT_ALL);
+  EXPECT_THAT(std::vector<StringPiece>(range.begin(), range.end()),
+              testing::ElementsAre("", "a", "", "b", ""));
+  // The range can be iterated again, and its iterators copied.
+  auto it = range.begin();
+  auto copy = it++;
+  EXPECT_EQ(range.begin(), copy);
+  EXPECT_NE(copy, it);
+  EXPECT_EQ("a", *it);
+  EXPECT_EQ(1u, it->size());
+  EXPECT_EQ(5, std::distance(range.begin(), range.end()));
+
+  EXPECT_EQ(range.end(),
+            SplitStringPieceRange("", ",", KEEP_WHITESPACE, SPLIT_WANT_ALL)
+                .begin());
+  EXPECT_THAT(std::vector<StringPiece16>(
+                  SplitStringPieceRange(u" x ;y", u";", TRIM_WHITESPACE,
+                                        SPLIT_WANT_ALL)
+                      .begin(),
+                  SplitStringPieceRange(u"", u";", TRIM_WHITESPACE,
+                                        SPLIT_WANT_ALL)
+                      .end()),
+              testing::ElementsAre(u"x", u"y"));
+}
+
+// Checks the range against find_first_of(), with one or several separators,
+// in strings long enough to be searched a block at a time.
+TEST(SplitStringPieceRangeTest, MatchesFindFirstOf) {
+  const std::string input =
+      "GET /index.html HTTP/1.1\r\nHost: a.example\r\n\r\nfield,\x80,"
+      "value;with;many;separators";
+  for (const char* separators : {"\n", ",", ";", "\r\n", ",;\x80", ""}) {
+    std::vector<StringPiece> expected;
+    size_t start = 0;
+    while (true) {
+      const size_t end = input.find_first_of(separators, start);
+      expected.push_back(StringPiece(input).substr(start, end - start));
+      if (end == std::string::npos)
+        break;
+      start = end + 1;
+    }
+    const auto range = SplitStringPieceRange(input, separators,
+                                             KEEP_WHITESPACE, SPLIT_WANT_ALL);
+    EXPECT_EQ(expected, std::vector<StringPiece>(range.begin(), range.end()))
+        << separators;
+  }
+}
+
 }  // namespace base
@@ -8,11 +8,115 @@
 #include <algorithm>
 #include <string>
 
+#include "base/strings/ascii_simd.h"
 #include "base/strings/string_piece.h"
 #include "base/strings/string_util.h"
 
 namespace base {
 
+namespace internal {
+
+// The characters which StringTokenizerT looks for: delimiters, whitespace
+// skipped over by its policy, quotes, and the backslashes which escape the
+// characters of quoted strings. It skips at once the runs of other characters,
+// which make up most of its input.
+template <typename CharT>
+class TokenizerCharacterClasses {
+ public:
+  TokenizerCharacterClasses(BasicStringPiece<CharT> delims,
+                            bool skip_whitespace)
+      : delims_(delims), skip_whitespace_(skip_whitespace) {}
+
+  void SetQuotes(BasicStringPiece<CharT> quotes) {
+    quotes_.assign(quotes.begin(), quotes.end());
+  }
+
+  bool has_quotes() const { return !quotes_.empty(); }
+
+  // Returns true if |c| is a delimiter or skipped whitespace.
+  bool IsTokenEnd(CharT c) const {
+    return delims_.find(c) != std::basic_string<CharT>::npos ||
+           (skip_whitespace_ && IsAsciiWhitespace(c));
+  }
+
+  bool IsQuote(CharT c) const {
+    return quotes_.find(c) != std::basic_string<CharT>::npos;
+  }
+
+  // Returns the index of the first token end or quote of |str|, or its size if
+  // there is none.
+  size_t FindFirstSpecial(BasicStringPiece<CharT> str) const {
+    size_t i = 0;
+    while (i < str.size() && !IsTokenEnd(str[i]) && !IsQuote(str[i]))
+      ++i;
+    return i;
+  }
+
+  // Returns the index of the first backslash or quote of |str|, or its size if
+  // there is none.
+  size_t FindFirstSpecialInQuotes(BasicStringPiece<CharT> str) const {
+    size_t i = 0;
+    while (i < str.size() && str[i] != '\\' && !IsQuote(str[i]))
+      ++i;
+    return i;
+  }
+
+ private:
+  std::basic_string<CharT> delims_;
+  std::basic_string<CharT> quotes_;
+  bool skip_whitespace_;
+};
+
+// Bytes are looked up in the 256-bit tables of ByteSets, which also find the
+// special ones 16 or 32 bytes at a time.
+template <>
+class TokenizerCharacterClasses<char> {
+ public:
+  TokenizerCharacterClasses(StringPiece delims, bool skip_whitespace)
+      : token_ends_(delims) {
+    if (skip_whitespace) {
+      for (char c = 0; c < 0x7F; ++c) {
+        if (IsAsciiWhitespace(c))
+          token_ends_.Insert(c);
+      }
+    }
+    SetQuotes(StringPiece());
+  }
+
+  void SetQuotes(StringPiece quotes) {
+    has_quotes_ = !quotes.empty();
+    quotes_ = ByteSet(quotes);
+    specials_ = token_ends_;
+    specials_in_quotes_ = quotes_;
+    specials_in_quotes_.Insert('\\');
+    for (char c : quotes)
+      specials_.Insert(c);
+  }
+
+  bool has_quotes() const { return has_quotes_; }
+
+  bool IsTokenEnd(char c) const { return token_ends_.Contains(c); }
+
+  bool IsQuote(char c) const { return quotes_.Contains(c); }
+
+  size_t FindFirstSpecial(StringPiece str) const {
+    return std::min(specials_.FindFirstOf(str), str.size());
+  }
+
+  size_t FindFirstSpecialInQuotes(StringPiece str) const {
+    return std::min(specials_in_quotes_.FindFirstOf(str), str.size());
+  }
+
+ private:
+  ByteSet token_ends_;
+  ByteSet quotes_;
+  ByteSet specials_;
+  ByteSet specials_in_quotes_;
+  bool has_quotes_;
+};
+
+}  // namespace internal
+
 // StringTokenizerT is a simple string tokenizer class.  It works like an
 // iterator that with each step (see the Advance method) updates members that
 // refer to the next token in the input string.  The user may optionally
@@ -138,8 +242,11 @@ class StringTokenizerT {
   StringTokenizerT(
       const str& string,
       const str& delims,
-      WhitespacePolicy whitespace_policy = WhitespacePolicy::kIncludeInTokens) {
-    Init(string.begin(), string.end(), delims, whitespace_policy);
+      WhitespacePolicy whitespace_policy = WhitespacePolicy::kIncludeInTokens)
+      : character_classes_(
+            delims,
+            whitespace_policy == WhitespacePolicy::kSkipOver) {
+    Init(string.begin(), string.end(), whitespace_policy);
   }
 
   // Don't allow temporary strings to be used with string tokenizer, since
@@ -150,8 +257,11 @@ class StringTokenizerT {
       const_iterator string_begin,
       const_iterator string_end,
       const str& delims,
-      WhitespacePolicy whitespace_policy = WhitespacePolicy::kIncludeInTokens) {
-    Init(string_begin, string_end, delims, whitespace_policy);
+      WhitespacePolicy whitespace_policy = WhitespacePolicy::kIncludeInTokens)
+      : character_classes_(
+            delims,
+            whitespace_policy == WhitespacePolicy::kSkipOver) {
+    Init(string_begin, string_end, whitespace_policy);
   }
 
   // Set the options for this tokenizer.  By default, this is 0.
@@ -162,13 +272,15 @@ class StringTokenizerT {
   // it ignores delimiters that it finds.  It switches out of this mode once it
   // finds another instance of the quote char.  If a backslash is encountered
   // within a quoted string, then the next character is skipped.
-  void set_quote_chars(const str& quotes) { quotes_ = quotes; }
+  void set_quote_chars(const str& quotes) {
+    character_classes_.SetQuotes(quotes);
+  }
 
   // Call this method to advance the tokenizer to the next delimiter.  This
   // returns false if the tokenizer is complete.  This method must be called
   // before calling any of the token* methods.
   bool GetNext() {
-    if (quotes_.empty() && options_ == 0)
+    if (!character_classes_.has_quotes() && options_ == 0)
       return QuickGetNext();
     else
       return FullGetNext();
@@ -197,13 +309,11 @@ class StringTokenizerT {
  private:
   void Init(const_iterator string_begin,
             const_iterator string_end,
-            const str& delims,
             WhitespacePolicy whitespace_policy) {
     start_pos_ = string_begin;
     token_begin_ = string_begin;
     token_end_ = string_begin;
     end_ = string_end;
-    delims_ = delims;
     options_ = 0;
     token_is_delim_ = true;
     whitespace_policy_ = whitespace_policy;
@@ -221,6 +331,11 @@ class StringTokenizerT {
       ++token_end_;
   }
 
+  // Returns the characters from |token_end_| to the end of the string.
+  BasicStringPiece<char_type> Rest() const {
+    return MakeBasicStringPiece<char_type>(token_end_, end_);
+  }
+
   // Implementation of GetNext() for when we have no quote characters. We have
   // two separate implementations because AdvanceOne() is a hot spot in large
   // text files with large tokens.
@@ -233,16 +348,12 @@ class StringTokenizerT {
         return false;
       }
       ++token_end_;
-      if (delims_.find(*token_begin_) == str::npos &&
-          !ShouldSkip(*token_begin_)) {
+      if (!character_classes_.IsTokenEnd(*token_begin_))
         break;
-      }
       // else skip over delimiter or skippable character.
     }
-    while (token_end_ != end_ && delims_.find(*token_end_) == str::npos &&
-           !ShouldSkip(*token_end_)) {
-      ++token_end_;
-    }
+    // Without quotes, the special characters are the token ends.
+    token_end_ += character_classes_.FindFirstSpecial(Rest());
     return true;
   }
 
@@ -268,7 +379,7 @@ class StringTokenizerT {
         token_begin_ = token_end_;
 
         // Slurp all non-delimiter characters into the token.
-        while (token_end_ != end_ && AdvanceOne(&state, *token_end_)) {
+        while (SkipToSpecial(state) && AdvanceOne(&state, *token_end_)) {
           ++token_end_;
         }
 
@@ -307,10 +418,6 @@ class StringTokenizerT {
     return false;
   }
 
-  bool IsDelim(char_type c) const { return delims_.find(c) != str::npos; }
-
-  bool IsQuote(char_type c) const { return quotes_.find(c) != str::npos; }
-
   struct AdvanceState {
     bool in_quote;
     bool in_escape;
@@ -318,6 +425,22 @@ class StringTokenizerT {
     AdvanceState() : in_quote(false), in_escape(false), quote_char('\0') {}
   };
 
+  // Moves |token_end_| over the characters which AdvanceOne() would accept
+  // without changing |state|, up to the next one which may end the token or
+  // start or end a quoted string. Returns false if it reached the end of the
+  // string.
+  bool SkipToSpecial(const AdvanceState& state) {
+    if (token_end_ == end_)
+      return false;
+    // An escaped character is taken whatever it is.
+    if (state.in_escape)
+      return true;
+    token_end_ += state.in_quote
+                      ? character_classes_.FindFirstSpecialInQuotes(Rest())
+                      : character_classes_.FindFirstSpecial(Rest());
+    return token_end_ != end_;
+  }
+
   // Returns true if a delimiter or, depending on policy, whitespace was not
   // hit.
   bool AdvanceOne(AdvanceState* state, char_type c) {
@@ -330,9 +453,9 @@ class StringTokenizerT {
         state->in_quote = false;
       }
     } else {
-      if (IsDelim(c) || ShouldSkip(c))
+      if (character_classes_.IsTokenEnd(c))
         return false;
-      state->in_quote = IsQuote(state->quote_char = c);
+      state->in_quote = character_classes_.IsQuote(state->quote_char = c);
     }
     return true;
   }
@@ -341,8 +464,7 @@ class StringTokenizerT {
   const_iterator token_begin_;
   const_iterator token_end_;
   const_iterator end_;
-  str delims_;
-  str quotes_;
+  internal::TokenizerCharacterClasses<char_type> character_classes_;
   int options_;
   bool token_is_delim_;
   WhitespacePolicy whitespace_policy_;
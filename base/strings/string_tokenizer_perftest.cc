@@ -0,0 +1,94 @@
+// Copyright 2022 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "base/strings/string_tokenizer.h"
+
+#include <string>
+
+#include "base/strings/string_number_conversions.h"
+#include "base/time/time.h"
+#include "base/timer/lap_timer.h"
+#include "testing/gtest/include/gtest/gtest.h"
+#include "testing/perf/perf_result_reporter.h"
+
+namespace base {
+namespace {
+
+constexpr TimeDelta kTimeLimit = Seconds(2);
+constexpr int kWarmupRuns = 2;
+constexpr int kTimeCheckInterval = 1;
+
+constexpr char kMetricPrefixStringTokenizer[] = "StringTokenizer.";
+constexpr char kMetricThroughput[] = "throughput";
+
+void ReportResults(const std::string& story_name,
+                   const LapTimer& timer,
+                   size_t bytes_per_lap) {
+  perf_test::PerfResultReporter reporter(kMetricPrefixStringTokenizer,
+                                         story_name);
+  reporter.RegisterImportantMetric(kMetricThroughput, "MB/s");
+  reporter.AddResult(kMetricThroughput,
+                     timer.LapsPerSecond() * bytes_per_lap / (1024 * 1024));
+}
+
+// About 3 MB of the header lines a protocol parser tokenizes: a few long
+// tokens per line, some of them quoted.
+std::string GenerateHeaders() {
+  std::string headers;
+  for (int i = 0; i < 16 * 1024; ++i) {
+    headers += "Set-Cookie: session" + NumberToString(i) +
+               "=a1b2c3d4e5f6a7b8c9d0e1f2a3b4c5d6; Path=/static/resources; "
+               "Domain=www.example.com; Comment=\"expires with the session, "
+               "as \\\"usual\\\"\"; SameSite=Lax\r\n";
+  }
+  return headers;
+}
+
+// Returns the number of tokens, so that the loop isn't optimized away.
+size_t CountTokens(StringTokenizer& tokenizer) {
+  size_t count = 0;
+  while (tokenizer.GetNext())
+    ++count;
+  return count;
+}
+
+}  // namespace
+
+TEST(StringTokenizerPerfTest, Lines) {
+  const std::string headers = GenerateHeaders();
+  LapTimer timer(kWarmupRuns, kTimeLimit, kTimeCheckInterval);
+  do {
+    StringTokenizer tokenizer(headers, "\r\n");
+    ASSERT_EQ(16u * 1024, CountTokens(tokenizer));
+    timer.NextLap();
+  } while (!timer.HasTimeLimitExpired());
+  ReportResults("Lines", timer, headers.size());
+}
+
+TEST(StringTokenizerPerfTest, Words) {
+  const std::string headers = GenerateHeaders();
+  LapTimer timer(kWarmupRuns, kTimeLimit, kTimeCheckInterval);
+  do {
+    StringTokenizer tokenizer(headers, ";=",
+                              StringTokenizer::WhitespacePolicy::kSkipOver);
+    ASSERT_NE(0u, CountTokens(tokenizer));
+    timer.NextLap();
+  } while (!timer.HasTimeLimitExpired());
+  ReportResults("Words", timer, headers.size());
+}
+
+TEST(StringTokenizerPerfTest, QuotedValues) {
+  const std::string headers = GenerateHeaders();
+  LapTimer timer(kWarmupRuns, kTimeLimit, kTimeCheckInterval);
+  do {
+    StringTokenizer tokenizer(headers, ";\r\n");
+    tokenizer.set_quote_chars("\"");
+    tokenizer.set_options(StringTokenizer::RETURN_DELIMS);
+    ASSERT_NE(0u, CountTokens(tokenizer));
+    timer.NextLap();
+  } while (!timer.HasTimeLimitExpired());
+  ReportResults("QuotedValues", timer, headers.size());
+}
+
+}  // namespace base
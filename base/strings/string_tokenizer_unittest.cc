@@ -4,6 +4,9 @@
 
 #include "base/strings/string_tokenizer.h"
 
+#include <vector>
+
+#include "base/strings/utf_string_conversions.h"
 #include "testing/gtest/include/gtest/gtest.h"
 
 using std::string;
@@ -412,6 +415,93 @@ TEST(StringTokenizerTest, ParseWithWhitespace_Quotes) {
   EXPECT_FALSE(t.GetNext());
 }
 
+TEST(StringTokenizerTest, LongTokens) {
+  const string long_token(100, 'x');
+  string input = long_token + ", " + long_token + "\"a, " + long_token +
+                 "\\\", b\"" + long_token + ",";
+  StringTokenizer t(input, ", ");
+  t.set_quote_chars("\"");
+
+  EXPECT_TRUE(t.GetNext());
+  EXPECT_EQ(long_token, t.token());
+
+  EXPECT_TRUE(t.GetNext());
+  EXPECT_EQ(long_token + "\"a, " + long_token + "\\\", b\"" + long_token,
+            t.token());
+
+  EXPECT_FALSE(t.GetNext());
+}
+
+TEST(StringTokenizerTest, NonASCIIDelims) {
+  string input = string(40, 'a') + "\xFF" + string(40, 'b') + "\x80" "c";
+  StringTokenizer t(input, "\x80\xFF");
+
+  EXPECT_TRUE(t.GetNext());
+  EXPECT_EQ(string(40, 'a'), t.token());
+
+  EXPECT_TRUE(t.GetNext());
+  EXPECT_EQ(string(40, 'b'), t.token());
+
+  EXPECT_TRUE(t.GetNext());
+  EXPECT_EQ("c", t.token());
+
+  EXPECT_FALSE(t.GetNext());
+}
+
+// The tokens of strings are found with ByteSets, and those of u16strings one
+// character at a time: they must be the same.
+TEST(StringTokenizerTest, SameTokensAsString16Tokenizer) {
+  const string inputs[] = {
+      "",
+      "no-cache=\"foo, bar\", private, max-age=3600, must-revalidate",
+      "text/html; charset=UTF-8; q=0.9; boundary=\"--- \\\"; ---\";;",
+      "  \t leading and trailing whitespace, with  spaces\r\n\tand tabs  ",
+      "'unterminated quote, with the rest of the string in it",
+      "escaped\\ backslash 'in \\' and out' of \"quotes\\\\\" ,,end",
+      string(50, 'a') + ",,\"" + string(50, 'b') + "\\\"," +
+          string(50, 'c') + "\",' " + string(50, 'd'),
+  };
+  const string delims[] = {",", ", ", ";= ", ",\""};
+
+  for (const string& input : inputs) {
+    const std::u16string input16 = ASCIIToUTF16(input);
+    for (const string& delim : delims) {
+      for (const char* quotes : {"", "\"", "\"'"}) {
+        for (int options = 0; options < 4; ++options) {
+          for (bool skip_whitespace : {false, true}) {
+            StringTokenizer t(
+                input, delim,
+                skip_whitespace
+                    ? StringTokenizer::WhitespacePolicy::kSkipOver
+                    : StringTokenizer::WhitespacePolicy::kIncludeInTokens);
+            String16Tokenizer t16(
+                input16, ASCIIToUTF16(delim),
+                skip_whitespace
+                    ? String16Tokenizer::WhitespacePolicy::kSkipOver
+                    : String16Tokenizer::WhitespacePolicy::kIncludeInTokens);
+            t.set_quote_chars(quotes);
+            t16.set_quote_chars(ASCIIToUTF16(quotes));
+            t.set_options(options);
+            t16.set_options(options);
+
+            std::vector<string> tokens;
+            while (t.GetNext())
+              tokens.push_back(t.token() + (t.token_is_delim() ? "D" : "T"));
+            std::vector<string> tokens16;
+            while (t16.GetNext()) {
+              tokens16.push_back(UTF16ToASCII(t16.token()) +
+                                 (t16.token_is_delim() ? "D" : "T"));
+            }
+            EXPECT_EQ(tokens16, tokens)
+                << input << " " << delim << " " << quotes << " " << options
+                << " " << skip_whitespace;
+          }
+        }
+      }
+    }
+  }
+}
+
 }  // namespace
 
 }  // namespace base
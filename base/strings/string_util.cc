@@ -25,6 +25,7 @@
 #include "base/cxx17_backports.h"
 #include "base/no_destructor.h"
 #include "base/strings/string_util_internal.h"
+#include "base/strings/utf_simd.h"
 #include "base/strings/utf_string_conversion_utils.h"
 #include "base/strings/utf_string_conversions.h"
 #include "base/third_party/icu/icu_utf.h"
@@ -67,38 +68,126 @@ bool IsWprintfFormatPortable(const wchar_t* format) {
   return true;
 }
 
+namespace {
+
+template <typename Char>
+int CompareCaseInsensitiveASCIIVectorized(BasicStringPiece<Char> a,
+                                          BasicStringPiece<Char> b) {
+  // As CompareCaseInsensitiveASCIIT() does, compares the first characters
+  // which aren't equal, or the lengths.
+  const size_t length = std::min(a.length(), b.length());
+  const size_t i =
+      internal::FindCaseInsensitiveASCIIMismatch(a.data(), b.data(), length);
+  if (i < length)
+    return ToLowerASCII(a[i]) < ToLowerASCII(b[i]) ? -1 : 1;
+  if (a.length() == b.length())
+    return 0;
+  return a.length() < b.length() ? -1 : 1;
+}
+
+// Behaves as CollapseWhitespaceT(), but copies the runs of non-whitespace
+// bytes at once, found with a ByteSet.
+std::string CollapseWhitespaceASCIIVectorized(
+    StringPiece text,
+    bool trim_sequences_with_line_breaks) {
+  static const internal::ByteSet whitespace = [] {
+    // The bytes which CollapseWhitespaceT() would take for whitespace, which
+    // depend on the signedness of char.
+    internal::ByteSet set;
+    for (int byte = 0; byte <= 0xFF; ++byte) {
+      if (IsUnicodeWhitespace(static_cast<char>(byte)))
+        set.Insert(static_cast<char>(byte));
+    }
+    return set;
+  }();
+
+  std::string result;
+  result.reserve(text.size());
+  // Leading whitespace is trimmed.
+  size_t begin = whitespace.FindFirstNotOf(text);
+  while (begin != StringPiece::npos) {
+    const StringPiece rest = text.substr(begin);
+    const StringPiece run = rest.substr(0, whitespace.FindFirstOf(rest));
+    result.append(run.data(), run.size());
+    if (run.size() == rest.size())
+      break;
+    const StringPiece spaces = rest.substr(run.size());
+    const size_t spaces_length = whitespace.FindFirstNotOf(spaces);
+    // Trailing whitespace is eliminated.
+    if (spaces_length == StringPiece::npos)
+      break;
+    // Whitespace sequences containing CR or LF are eliminated entirely, and
+    // the others are reduced to a single space.
+    if (!trim_sequences_with_line_breaks ||
+        spaces.substr(0, spaces_length).find_first_of("\r\n") ==
+            StringPiece::npos) {
+      result.push_back(' ');
+    }
+    begin += run.size() + spaces_length;
+  }
+  return result;
+}
+
+}  // namespace
+
 std::string ToLowerASCII(StringPiece str) {
-  return internal::ToLowerASCIIImpl(str);
+  std::string ret(str);
+  internal::ConvertToLowerASCII(ret.data(), ret.size());
+  return ret;
 }
 
 std::u16string ToLowerASCII(StringPiece16 str) {
-  return internal::ToLowerASCIIImpl(str);
+  std::u16string ret(str);
+  internal::ConvertToLowerASCII(ret.data(), ret.size());
+  return ret;
 }
 
 std::string ToUpperASCII(StringPiece str) {
-  return internal::ToUpperASCIIImpl(str);
+  std::string ret(str);
+  internal::ConvertToUpperASCII(ret.data(), ret.size());
+  return ret;
 }
 
 std::u16string ToUpperASCII(StringPiece16 str) {
-  return internal::ToUpperASCIIImpl(str);
+  std::u16string ret(str);
+  internal::ConvertToUpperASCII(ret.data(), ret.size());
+  return ret;
+}
+
+void ToLowerASCIIInPlace(span<char> str) {
+  internal::ConvertToLowerASCII(str.data(), str.size());
+}
+
+void ToLowerASCIIInPlace(span<char16_t> str) {
+  internal::ConvertToLowerASCII(str.data(), str.size());
+}
+
+void ToUpperASCIIInPlace(span<char> str) {
+  internal::ConvertToUpperASCII(str.data(), str.size());
+}
+
+void ToUpperASCIIInPlace(span<char16_t> str) {
+  internal::ConvertToUpperASCII(str.data(), str.size());
 }
 
 int CompareCaseInsensitiveASCII(StringPiece a, StringPiece b) {
-  return internal::CompareCaseInsensitiveASCIIT(a, b);
+  return CompareCaseInsensitiveASCIIVectorized(a, b);
 }
 
 int CompareCaseInsensitiveASCII(StringPiece16 a, StringPiece16 b) {
-  return internal::CompareCaseInsensitiveASCIIT(a, b);
+  return CompareCaseInsensitiveASCIIVectorized(a, b);
 }
 
 bool EqualsCaseInsensitiveASCII(StringPiece a, StringPiece b) {
   return a.size() == b.size() &&
-         internal::CompareCaseInsensitiveASCIIT(a, b) == 0;
+         internal::FindCaseInsensitiveASCIIMismatch(a.data(), b.data(),
+                                                    a.size()) == a.size();
 }
 
 bool EqualsCaseInsensitiveASCII(StringPiece16 a, StringPiece16 b) {
   return a.size() == b.size() &&
-         internal::CompareCaseInsensitiveASCIIT(a, b) == 0;
+         internal::FindCaseInsensitiveASCIIMismatch(a.data(), b.data(),
+                                                    a.size()) == a.size();
 }
 
 const std::string& EmptyString() {
@@ -221,8 +310,23 @@ TrimPositions TrimWhitespaceASCII(StringPiece input,
 }
 
 StringPiece TrimWhitespaceASCII(StringPiece input, TrimPositions positions) {
-  return internal::TrimStringPieceT(input, StringPiece(kWhitespaceASCII),
-                                    positions);
+  // Compares the bytes with those of kWhitespaceASCII, \t to \r and the space,
+  // rather than building a set of them: the strings usually have little
+  // whitespace to trim, as the pieces of split strings do.
+  const auto is_whitespace = [](char c) {
+    return c == ' ' || (c >= '\t' && c <= '\r');
+  };
+  size_t begin = 0;
+  size_t end = input.size();
+  if (positions & TRIM_LEADING) {
+    while (begin < end && is_whitespace(input[begin]))
+      ++begin;
+  }
+  if (positions & TRIM_TRAILING) {
+    while (end > begin && is_whitespace(input[end - 1]))
+      --end;
+  }
+  return input.substr(begin, end - begin);
 }
 
 std::u16string CollapseWhitespace(StringPiece16 text,
@@ -232,11 +336,16 @@ std::u16string CollapseWhitespace(StringPiece16 text,
 
 std::string CollapseWhitespaceASCII(StringPiece text,
                                     bool trim_sequences_with_line_breaks) {
-  return internal::CollapseWhitespaceT(text, trim_sequences_with_line_breaks);
+  return CollapseWhitespaceASCIIVectorized(
+      text, trim_sequences_with_line_breaks);
 }
 
 bool ContainsOnlyChars(StringPiece input, StringPiece characters) {
-  return input.find_first_not_of(characters) == StringPiece::npos;
+  // The table of a ByteSet isn't worth building for a few bytes.
+  if (input.size() < 16)
+    return input.find_first_not_of(characters) == StringPiece::npos;
+  return internal::ByteSet(characters).FindFirstNotOf(input) ==
+         StringPiece::npos;
 }
 
 bool ContainsOnlyChars(StringPiece16 input, StringPiece16 characters) {
@@ -245,11 +354,11 @@ bool ContainsOnlyChars(StringPiece16 input, StringPiece16 characters) {
 
 
 bool IsStringASCII(StringPiece str) {
-  return internal::DoIsStringASCII(str.data(), str.length());
+  return internal::ContainsOnlyASCII(str.data(), str.length());
 }
 
 bool IsStringASCII(StringPiece16 str) {
-  return internal::DoIsStringASCII(str.data(), str.length());
+  return internal::ContainsOnlyASCII(str.data(), str.length());
 }
 
 #if defined(WCHAR_T_IS_UTF32)
@@ -259,11 +368,17 @@ bool IsStringASCII(WStringPiece str) {
 #endif
 
 bool IsStringUTF8(StringPiece str) {
-  return internal::DoIsStringUTF8<IsValidCharacter>(str);
+  const internal::UTF8Validity validity =
+      internal::ValidateUTF8(str.data(), str.size());
+  // Rare: decodes the code points to tell the noncharacters apart.
+  if (validity == internal::UTF8Validity::kMaybeNoncharacters)
+    return internal::DoIsStringUTF8<IsValidCharacter>(str);
+  return validity == internal::UTF8Validity::kValid;
 }
 
 bool IsStringUTF8AllowingNoncharacters(StringPiece str) {
-  return internal::DoIsStringUTF8<IsValidCodepoint>(str);
+  return internal::ValidateUTF8(str.data(), str.size()) !=
+         internal::UTF8Validity::kInvalid;
 }
 
 bool LowerCaseEqualsASCII(StringPiece str, StringPiece lowercase_ascii) {
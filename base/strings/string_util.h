@@ -132,6 +132,13 @@ BASE_EXPORT std::u16string ToLowerASCII(StringPiece16 str);
 BASE_EXPORT std::string ToUpperASCII(StringPiece str);
 BASE_EXPORT std::u16string ToUpperASCII(StringPiece16 str);
 
+// Like ToLowerASCII() and ToUpperASCII(), but convert |str| in place instead
+// of returning a new string.
+BASE_EXPORT void ToLowerASCIIInPlace(span<char> str);
+BASE_EXPORT void ToLowerASCIIInPlace(span<char16_t> str);
+BASE_EXPORT void ToUpperASCIIInPlace(span<char> str);
+BASE_EXPORT void ToUpperASCIIInPlace(span<char16_t> str);
+
 // Functor for case-insensitive ASCII comparisons for STL algorithms like
 // std::search.
 //
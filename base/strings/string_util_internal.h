@@ -10,6 +10,7 @@
 #include "base/logging.h"
 #include "base/notreached.h"
 #include "base/ranges/algorithm.h"
+#include "base/strings/ascii_simd.h"
 #include "base/strings/string_piece.h"
 #include "base/third_party/icu/icu_utf.h"
 
@@ -87,6 +88,41 @@ int CompareCaseInsensitiveASCIIT(T a, T b) {
   return 1;
 }
 
+// The characters which TrimStringT() and TrimStringPieceT() trim.
+template <typename T>
+class TrimCharacterSet {
+ public:
+  explicit TrimCharacterSet(T characters) : characters_(characters) {}
+
+  size_t FindFirstNotOf(T str) const {
+    return str.find_first_not_of(characters_);
+  }
+  size_t FindLastNotOf(T str) const {
+    return str.find_last_not_of(characters_);
+  }
+
+ private:
+  const T characters_;
+};
+
+// Bytes are looked up in a table, rather than compared with each of the
+// characters in turn.
+template <>
+class TrimCharacterSet<StringPiece> {
+ public:
+  explicit TrimCharacterSet(StringPiece characters) : set_(characters) {}
+
+  size_t FindFirstNotOf(StringPiece str) const {
+    return set_.FindFirstNotOf(str);
+  }
+  size_t FindLastNotOf(StringPiece str) const {
+    return set_.FindLastNotOf(str);
+  }
+
+ private:
+  const ByteSet set_;
+};
+
 template <typename T, typename CharT = typename T::value_type>
 TrimPositions TrimStringT(T input,
                           T trim_chars,
@@ -96,12 +132,12 @@ TrimPositions TrimStringT(T input,
   // a StringPiece version of input to be able to call find* on it with the
   // StringPiece version of trim_chars (normally the trim_chars will be a
   // constant so avoid making a copy).
+  const TrimCharacterSet<T> trim_set(trim_chars);
   const size_t last_char = input.length() - 1;
   const size_t first_good_char =
-      (positions & TRIM_LEADING) ? input.find_first_not_of(trim_chars) : 0;
-  const size_t last_good_char = (positions & TRIM_TRAILING)
-                                    ? input.find_last_not_of(trim_chars)
-                                    : last_char;
+      (positions & TRIM_LEADING) ? trim_set.FindFirstNotOf(input) : 0;
+  const size_t last_good_char =
+      (positions & TRIM_TRAILING) ? trim_set.FindLastNotOf(input) : last_char;
 
   // When the string was all trimmed, report that we stripped off characters
   // from whichever position the caller was interested in. For empty input, we
@@ -125,11 +161,11 @@ TrimPositions TrimStringT(T input,
 
 template <typename T, typename CharT = typename T::value_type>
 T TrimStringPieceT(T input, T trim_chars, TrimPositions positions) {
+  const TrimCharacterSet<T> trim_set(trim_chars);
   size_t begin =
-      (positions & TRIM_LEADING) ? input.find_first_not_of(trim_chars) : 0;
-  size_t end = (positions & TRIM_TRAILING)
-                   ? input.find_last_not_of(trim_chars) + 1
-                   : input.size();
+      (positions & TRIM_LEADING) ? trim_set.FindFirstNotOf(input) : 0;
+  size_t end = (positions & TRIM_TRAILING) ? trim_set.FindLastNotOf(input) + 1
+                                           : input.size();
   return input.substr(std::min(begin, input.size()), end - begin);
 }
 
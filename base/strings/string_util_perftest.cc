@@ -5,7 +5,9 @@
 #include "base/strings/string_util.h"
 
 #include <cinttypes>
+#include <string>
 
+#include "base/strings/utf_string_conversions.h"
 #include "base/time/time.h"
 #include "build/build_config.h"
 #include "testing/gtest/include/gtest/gtest.h"
@@ -43,4 +45,108 @@ TEST(StringUtilTest, DISABLED_IsStringASCIIPerf) {
   }
 }
 
+// Returns |length| bytes of text which mixes runs of ASCII and of 2- or 3-byte
+// characters, as text in most languages does.
+std::string MakeUTF8Text(size_t length, const char* non_ascii_word) {
+  std::string text;
+  while (text.size() < length) {
+    text += "lorem ipsum ";
+    if (non_ascii_word)
+      text += non_ascii_word;
+  }
+  text.resize(length);
+  // Keeps the text valid if it was cut in the middle of a character.
+  while (!IsStringUTF8(text))
+    text.pop_back();
+  return text;
+}
+
+TEST(StringUtilTest, DISABLED_UTF8Perf) {
+  struct {
+    const char* name;
+    const char* non_ascii_word;
+  } const kTexts[] = {
+      {"ascii", nullptr},
+      {"latin", "d\xC3\xA9j\xC3\xA0 "},
+      {"cjk", "\xE6\x97\xA5\xE6\x9C\xAC\xE8\xAA\x9E "},
+  };
+  for (const auto& text : kTexts) {
+    for (size_t length = 16; length <= 65536; length *= 16) {
+      const std::string utf8 = MakeUTF8Text(length, text.non_ascii_word);
+      const std::u16string utf16 = UTF8ToUTF16(utf8);
+      const size_t iterations = 100000000 / length;
+
+      TimeTicks t0 = TimeTicks::Now();
+      for (size_t i = 0; i < iterations; ++i)
+        EXPECT_TRUE(IsStringUTF8(utf8));
+      const TimeDelta validate_time = TimeTicks::Now() - t0;
+
+      t0 = TimeTicks::Now();
+      for (size_t i = 0; i < iterations; ++i)
+        EXPECT_EQ(utf16.size(), UTF8ToUTF16(utf8).size());
+      const TimeDelta to_utf16_time = TimeTicks::Now() - t0;
+
+      t0 = TimeTicks::Now();
+      for (size_t i = 0; i < iterations; ++i)
+        EXPECT_EQ(utf8.size(), UTF16ToUTF8(utf16).size());
+      const TimeDelta to_utf8_time = TimeTicks::Now() - t0;
+
+      printf(
+          "text:\t%s\tlength:\t%zu\tvalidate-ms:\t%" PRIu64
+          "\tutf8-to-utf16-ms:\t%" PRIu64 "\tutf16-to-utf8-ms:\t%" PRIu64
+          "\n",
+          text.name, utf8.size(), validate_time.InMilliseconds(),
+          to_utf16_time.InMilliseconds(), to_utf8_time.InMilliseconds());
+    }
+  }
+}
+
+TEST(StringUtilTest, DISABLED_ASCIIPerf) {
+  for (size_t length = 16; length <= 65536; length *= 16) {
+    // Text like the headers which the ASCII functions usually process.
+    std::string text;
+    while (text.size() < length)
+      text += "Content-Type:  text/html; charset=UTF-8\r\n ";
+    text.resize(length);
+    const std::string upper = ToUpperASCII(text);
+    const size_t iterations = 100000000 / length;
+
+    TimeTicks t0 = TimeTicks::Now();
+    for (size_t i = 0; i < iterations; ++i)
+      EXPECT_EQ(length, ToLowerASCII(text).size());
+    const TimeDelta lower_time = TimeTicks::Now() - t0;
+
+    std::string buffer = text;
+    t0 = TimeTicks::Now();
+    for (size_t i = 0; i < iterations; ++i)
+      ToLowerASCIIInPlace(buffer);
+    const TimeDelta lower_in_place_time = TimeTicks::Now() - t0;
+
+    t0 = TimeTicks::Now();
+    for (size_t i = 0; i < iterations; ++i)
+      EXPECT_TRUE(EqualsCaseInsensitiveASCII(text, upper));
+    const TimeDelta equals_time = TimeTicks::Now() - t0;
+
+    t0 = TimeTicks::Now();
+    for (size_t i = 0; i < iterations; ++i) {
+      EXPECT_TRUE(ContainsOnlyChars(
+          text, "ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz-/;:= \r\n"
+                "0123456789"));
+    }
+    const TimeDelta only_chars_time = TimeTicks::Now() - t0;
+
+    t0 = TimeTicks::Now();
+    for (size_t i = 0; i < iterations; ++i)
+      EXPECT_GT(length, CollapseWhitespaceASCII(text, true).size());
+    const TimeDelta collapse_time = TimeTicks::Now() - t0;
+
+    printf("length:\t%zu\tlower-ms:\t%" PRIu64 "\tlower-in-place-ms:\t%" PRIu64
+           "\tequals-ms:\t%" PRIu64 "\tonly-chars-ms:\t%" PRIu64
+           "\tcollapse-ms:\t%" PRIu64 "\n",
+           length, lower_time.InMilliseconds(),
+           lower_in_place_time.InMilliseconds(), equals_time.InMilliseconds(),
+           only_chars_time.InMilliseconds(), collapse_time.InMilliseconds());
+  }
+}
+
 }  // namespace base
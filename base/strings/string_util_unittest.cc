@@ -661,6 +661,23 @@ TEST(StringUtilTest, ToUpperASCII) {
   EXPECT_EQ(u"CC2", ToUpperASCII(u"Cc2"));
 }
 
+TEST(StringUtilTest, ToLowerAndUpperASCIIInPlace) {
+  std::string str = "Content-Type: Text/HTML; Charset=\xC9UTF-8";
+  ToLowerASCIIInPlace(str);
+  EXPECT_EQ("content-type: text/html; charset=\xC9utf-8", str);
+  ToUpperASCIIInPlace(str);
+  EXPECT_EQ("CONTENT-TYPE: TEXT/HTML; CHARSET=\xC9UTF-8", str);
+  // Converts a part of the string only.
+  ToLowerASCIIInPlace(make_span(str).subspan(0, 12));
+  EXPECT_EQ("content-type: TEXT/HTML; CHARSET=\xC9UTF-8", str);
+
+  std::u16string str16 = u"Content-Type: Text/HTML; Charset=\xC9UTF-8";
+  ToLowerASCIIInPlace(str16);
+  EXPECT_EQ(u"content-type: text/html; charset=\xC9utf-8", str16);
+  ToUpperASCIIInPlace(str16);
+  EXPECT_EQ(u"CONTENT-TYPE: TEXT/HTML; CHARSET=\xC9UTF-8", str16);
+}
+
 TEST(StringUtilTest, LowerCaseEqualsASCII) {
   static const struct {
     const char*    src_a;
@@ -0,0 +1,575 @@
+// Copyright 2022 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "base/strings/utf_simd.h"
+
+#include <stdint.h>
+#include <string.h>
+
+#include <type_traits>
+
+#include "base/strings/utf_string_conversion_utils.h"
+#include "base/third_party/icu/icu_utf.h"
+#include "build/build_config.h"
+
+#if defined(ARCH_CPU_X86_64)
+#include "base/cpu.h"
+// Including these headers directly should generally be avoided. The SSSE3
+// and AVX2 functions are only used if the CPU supports them at runtime, see
+// GetValidateUTF8Function().
+// clang-format off
+#include <immintrin.h>
+// clang-format on
+#elif defined(ARCH_CPU_ARM64)
+#include <arm_neon.h>
+#endif
+
+namespace base {
+namespace internal {
+
+namespace {
+
+template <typename Char>
+bool IsASCII(Char c) {
+  return static_cast<std::make_unsigned_t<Char>>(c) < 0x80;
+}
+
+template <typename Char>
+size_t CountLeadingASCIIUnvectorized(const Char* data, size_t length) {
+  size_t i = 0;
+  while (i < length && IsASCII(data[i]))
+    ++i;
+  return i;
+}
+
+template <typename SrcChar, typename DestChar>
+size_t CopyLeadingASCIIUnvectorized(const SrcChar* src,
+                                    size_t length,
+                                    DestChar* dest) {
+  size_t i = 0;
+  for (; i < length && IsASCII(src[i]); ++i)
+    dest[i] = static_cast<DestChar>(src[i]);
+  return i;
+}
+
+UTF8Validity ValidateUTF8Unvectorized(const char* data, size_t length) {
+  UTF8Validity validity = UTF8Validity::kValid;
+  for (size_t i = 0; i < length;) {
+    int32_t code_point;
+    CBU8_NEXT(data, i, length, code_point);
+    if (!IsValidCodepoint(code_point))
+      return UTF8Validity::kInvalid;
+    if (!IsValidCharacter(code_point))
+      validity = UTF8Validity::kMaybeNoncharacters;
+  }
+  return validity;
+}
+
+using ValidateUTF8Function = UTF8Validity (*)(const char* data, size_t length);
+
+#if defined(ARCH_CPU_X86_64) || defined(ARCH_CPU_ARM64)
+
+// The errors which a pair of consecutive bytes can reveal. Each of the three
+// lookup tables below maps 4 bits of the pair to the errors they're part of,
+// so that the pair is erroneous iff the three results share a bit.
+constexpr uint8_t kTooShort = 1 << 0;  // 11______ 0_______, 11______ 11______
+constexpr uint8_t kTooLong = 1 << 1;   // 0_______ 10______
+constexpr uint8_t kOverlong3 = 1 << 2;  // 11100000 100_____
+constexpr uint8_t kTooLarge = 1 << 3;   // 11110100 1001____, 11110100 101_____
+constexpr uint8_t kSurrogate = 1 << 4;  // 11101101 101_____
+constexpr uint8_t kOverlong2 = 1 << 5;  // 1100000_ 10______
+// The two errors never share their first byte, so they share their bit.
+constexpr uint8_t kTooLarge1000 = 1 << 6;  // 11110101+ 1000____
+constexpr uint8_t kOverlong4 = 1 << 6;     // 11110000 1000____
+// Unless it's the third or fourth byte of a sequence, see below.
+constexpr uint8_t kTwoContinuations = 1 << 7;  // 10______ 10______
+// The errors which don't depend on the low bits of the first byte.
+constexpr uint8_t kCarry = kTooShort | kTooLong | kTwoContinuations;
+
+// Indexed by the high bits of the first byte.
+alignas(16) constexpr uint8_t kFirstByteHighTable[16] = {
+    kTooLong,
+    kTooLong,
+    kTooLong,
+    kTooLong,
+    kTooLong,
+    kTooLong,
+    kTooLong,
+    kTooLong,
+    kTwoContinuations,
+    kTwoContinuations,
+    kTwoContinuations,
+    kTwoContinuations,
+    kTooShort | kOverlong2,
+    kTooShort,
+    kTooShort | kOverlong3 | kSurrogate,
+    kTooShort | kTooLarge | kTooLarge1000 | kOverlong4,
+};
+
+// Indexed by the low bits of the first byte.
+alignas(16) constexpr uint8_t kFirstByteLowTable[16] = {
+    kCarry | kOverlong3 | kOverlong2 | kOverlong4,
+    kCarry | kOverlong2,
+    kCarry,
+    kCarry,
+    kCarry | kTooLarge,
+    kCarry | kTooLarge | kTooLarge1000,
+    kCarry | kTooLarge | kTooLarge1000,
+    kCarry | kTooLarge | kTooLarge1000,
+    kCarry | kTooLarge | kTooLarge1000,
+    kCarry | kTooLarge | kTooLarge1000,
+    kCarry | kTooLarge | kTooLarge1000,
+    kCarry | kTooLarge | kTooLarge1000,
+    kCarry | kTooLarge | kTooLarge1000,
+    kCarry | kTooLarge | kTooLarge1000 | kSurrogate,
+    kCarry | kTooLarge | kTooLarge1000,
+    kCarry | kTooLarge | kTooLarge1000,
+};
+
+// Indexed by the high bits of the second byte.
+alignas(16) constexpr uint8_t kSecondByteHighTable[16] = {
+    kTooShort,
+    kTooShort,
+    kTooShort,
+    kTooShort,
+    kTooShort,
+    kTooShort,
+    kTooShort,
+    kTooShort,
+    kTooLong | kOverlong2 | kTwoContinuations | kOverlong3 | kTooLarge1000 |
+        kOverlong4,
+    kTooLong | kOverlong2 | kTwoContinuations | kOverlong3 | kTooLarge,
+    kTooLong | kOverlong2 | kTwoContinuations | kSurrogate | kTooLarge,
+    kTooLong | kOverlong2 | kTwoContinuations | kSurrogate | kTooLarge,
+    kTooShort,
+    kTooShort,
+    kTooShort,
+    kTooShort,
+};
+
+// The blocks are checked for errors once per kErrorCheckInterval bytes, so
+// that invalid inputs are rejected early, without testing every block.
+constexpr size_t kErrorCheckInterval = 1024;
+
+// Besides the errors, the validation flags the pairs of bytes which
+// noncharacters are made of: U+FDD0 to U+FDEF start with EF B7, and the code
+// points ending in FFFE or FFFF end with BF BE or BF BF. A few characters
+// share the pairs, so these are only candidates.
+
+#endif  // defined(ARCH_CPU_X86_64) || defined(ARCH_CPU_ARM64)
+
+#if defined(ARCH_CPU_X86_64)
+
+// SSE2 is part of x86-64.
+bool HasNonASCIIUnits(__m128i chars) {
+  const __m128i non_ascii_bits = _mm_and_si128(
+      chars, _mm_set1_epi16(static_cast<int16_t>(0xFF80)));
+  return _mm_movemask_epi8(
+             _mm_cmpeq_epi16(non_ascii_bits, _mm_setzero_si128())) != 0xFFFF;
+}
+
+size_t CountLeadingASCIIVectorized(const char* data, size_t length) {
+  size_t i = 0;
+  for (; i + sizeof(__m128i) <= length; i += sizeof(__m128i)) {
+    const __m128i chars =
+        _mm_loadu_si128(reinterpret_cast<const __m128i*>(data + i));
+    if (_mm_movemask_epi8(chars))
+      break;
+  }
+  return i + CountLeadingASCIIUnvectorized(data + i, length - i);
+}
+
+size_t CountLeadingASCIIVectorized(const char16_t* data, size_t length) {
+  size_t i = 0;
+  for (; i + 8 <= length; i += 8) {
+    const __m128i chars =
+        _mm_loadu_si128(reinterpret_cast<const __m128i*>(data + i));
+    if (HasNonASCIIUnits(chars))
+      break;
+  }
+  return i + CountLeadingASCIIUnvectorized(data + i, length - i);
+}
+
+size_t CopyLeadingASCIIVectorized(const char* src,
+                                  size_t length,
+                                  char16_t* dest) {
+  const __m128i zero = _mm_setzero_si128();
+  size_t i = 0;
+  for (; i + sizeof(__m128i) <= length; i += sizeof(__m128i)) {
+    const __m128i chars =
+        _mm_loadu_si128(reinterpret_cast<const __m128i*>(src + i));
+    if (_mm_movemask_epi8(chars))
+      break;
+    _mm_storeu_si128(reinterpret_cast<__m128i*>(dest + i),
+                     _mm_unpacklo_epi8(chars, zero));
+    _mm_storeu_si128(reinterpret_cast<__m128i*>(dest + i + 8),
+                     _mm_unpackhi_epi8(chars, zero));
+  }
+  return i + CopyLeadingASCIIUnvectorized(src + i, length - i, dest + i);
+}
+
+size_t CopyLeadingASCIIVectorized(const char16_t* src,
+                                  size_t length,
+                                  char* dest) {
+  size_t i = 0;
+  for (; i + 16 <= length; i += 16) {
+    const __m128i low =
+        _mm_loadu_si128(reinterpret_cast<const __m128i*>(src + i));
+    const __m128i high =
+        _mm_loadu_si128(reinterpret_cast<const __m128i*>(src + i + 8));
+    if (HasNonASCIIUnits(_mm_or_si128(low, high)))
+      break;
+    _mm_storeu_si128(reinterpret_cast<__m128i*>(dest + i),
+                     _mm_packus_epi16(low, high));
+  }
+  return i + CopyLeadingASCIIUnvectorized(src + i, length - i, dest + i);
+}
+
+__attribute__((target("ssse3"))) UTF8Validity ValidateUTF8SSSE3(
+    const char* data,
+    size_t length) {
+  constexpr size_t kBlockSize = sizeof(__m128i);
+  const __m128i first_byte_high_table =
+      _mm_load_si128(reinterpret_cast<const __m128i*>(kFirstByteHighTable));
+  const __m128i first_byte_low_table =
+      _mm_load_si128(reinterpret_cast<const __m128i*>(kFirstByteLowTable));
+  const __m128i second_byte_high_table =
+      _mm_load_si128(reinterpret_cast<const __m128i*>(kSecondByteHighTable));
+  const __m128i low_bits = _mm_set1_epi8(0x0F);
+  // A block is incomplete if it ends with the first two bytes of a 4-byte
+  // sequence, the first byte of a 3-byte sequence or the first one of any.
+  const __m128i incomplete_max =
+      _mm_setr_epi8(-1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1,
+                    0xF0 - 1, 0xE0 - 1, 0xC0 - 1);
+  const __m128i zero = _mm_setzero_si128();
+
+  __m128i errors = zero;
+  __m128i noncharacters = zero;
+  __m128i previous = zero;
+  __m128i previous_incomplete = zero;
+  // The last, partial block is padded with NULs, so that the sequences it
+  // cuts off are too short. It's followed by a block of NULs if the data ends
+  // on a block boundary, for the same reason.
+  const size_t full_size = length - length % kBlockSize;
+  char last_block[kBlockSize] = {};
+  memcpy(last_block, data + full_size, length - full_size);
+  for (size_t i = 0; i <= full_size; i += kBlockSize) {
+    const char* block = i < full_size ? data + i : last_block;
+    const __m128i input =
+        _mm_loadu_si128(reinterpret_cast<const __m128i*>(block));
+    if (!_mm_movemask_epi8(input)) {
+      // ASCII blocks are valid, unless a sequence was cut off before them.
+      errors = _mm_or_si128(errors, previous_incomplete);
+      previous_incomplete = zero;
+    } else {
+      const __m128i prev1 = _mm_alignr_epi8(input, previous, 15);
+      const __m128i prev2 = _mm_alignr_epi8(input, previous, 14);
+      const __m128i prev3 = _mm_alignr_epi8(input, previous, 13);
+      const __m128i first_byte_high = _mm_shuffle_epi8(
+          first_byte_high_table,
+          _mm_and_si128(_mm_srli_epi16(prev1, 4), low_bits));
+      const __m128i first_byte_low = _mm_shuffle_epi8(
+          first_byte_low_table, _mm_and_si128(prev1, low_bits));
+      const __m128i second_byte_high = _mm_shuffle_epi8(
+          second_byte_high_table,
+          _mm_and_si128(_mm_srli_epi16(input, 4), low_bits));
+      const __m128i pair_errors = _mm_and_si128(
+          _mm_and_si128(first_byte_high, first_byte_low), second_byte_high);
+      // The third and fourth bytes of sequences are continuations after
+      // continuations, unlike the other bytes: the high bit of these is set
+      // iff they're 2 bytes after an E0+ byte or 3 after an F0+ one.
+      const __m128i must_be_continuation = _mm_and_si128(
+          _mm_or_si128(_mm_subs_epu8(prev2, _mm_set1_epi8(0xE0 - 0x80)),
+                       _mm_subs_epu8(prev3, _mm_set1_epi8(0xF0 - 0x80))),
+          _mm_set1_epi8(static_cast<char>(0x80)));
+      errors = _mm_or_si128(errors,
+                            _mm_xor_si128(must_be_continuation, pair_errors));
+      noncharacters = _mm_or_si128(
+          noncharacters,
+          _mm_or_si128(
+              _mm_and_si128(
+                  _mm_cmpeq_epi8(prev1, _mm_set1_epi8(static_cast<char>(0xEF))),
+                  _mm_cmpeq_epi8(input,
+                                 _mm_set1_epi8(static_cast<char>(0xB7)))),
+              _mm_and_si128(
+                  _mm_cmpeq_epi8(prev1, _mm_set1_epi8(static_cast<char>(0xBF))),
+                  _mm_cmpeq_epi8(_mm_or_si128(input, _mm_set1_epi8(1)),
+                                 _mm_set1_epi8(static_cast<char>(0xBF))))));
+      previous_incomplete = _mm_subs_epu8(input, incomplete_max);
+    }
+    previous = input;
+    if (i % kErrorCheckInterval == 0 &&
+        _mm_movemask_epi8(_mm_cmpeq_epi8(errors, zero)) != 0xFFFF) {
+      return UTF8Validity::kInvalid;
+    }
+  }
+  if (_mm_movemask_epi8(_mm_cmpeq_epi8(errors, zero)) != 0xFFFF)
+    return UTF8Validity::kInvalid;
+  return _mm_movemask_epi8(noncharacters) ? UTF8Validity::kMaybeNoncharacters
+                                          : UTF8Validity::kValid;
+}
+
+__attribute__((target("avx2"))) UTF8Validity ValidateUTF8AVX2(
+    const char* data,
+    size_t length) {
+  constexpr size_t kBlockSize = sizeof(__m256i);
+  const __m256i first_byte_high_table = _mm256_broadcastsi128_si256(
+      _mm_load_si128(reinterpret_cast<const __m128i*>(kFirstByteHighTable)));
+  const __m256i first_byte_low_table = _mm256_broadcastsi128_si256(
+      _mm_load_si128(reinterpret_cast<const __m128i*>(kFirstByteLowTable)));
+  const __m256i second_byte_high_table = _mm256_broadcastsi128_si256(
+      _mm_load_si128(reinterpret_cast<const __m128i*>(kSecondByteHighTable)));
+  const __m256i low_bits = _mm256_set1_epi8(0x0F);
+  const __m256i incomplete_max = _mm256_setr_epi8(
+      -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1,
+      -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, 0xF0 - 1, 0xE0 - 1,
+      0xC0 - 1);
+  const __m256i zero = _mm256_setzero_si256();
+
+  __m256i errors = zero;
+  __m256i noncharacters = zero;
+  __m256i previous = zero;
+  __m256i previous_incomplete = zero;
+  const size_t full_size = length - length % kBlockSize;
+  char last_block[kBlockSize] = {};
+  memcpy(last_block, data + full_size, length - full_size);
+  for (size_t i = 0; i <= full_size; i += kBlockSize) {
+    const char* block = i < full_size ? data + i : last_block;
+    const __m256i input =
+        _mm256_loadu_si256(reinterpret_cast<const __m256i*>(block));
+    if (!_mm256_movemask_epi8(input)) {
+      errors = _mm256_or_si256(errors, previous_incomplete);
+      previous_incomplete = zero;
+    } else {
+      // The shifts work within 128-bit lanes, so the bytes shifted into the
+      // high lane come from the low one, and those shifted into the low lane
+      // from the high lane of the previous block.
+      const __m256i carried = _mm256_permute2x128_si256(previous, input, 0x21);
+      const __m256i prev1 = _mm256_alignr_epi8(input, carried, 15);
+      const __m256i prev2 = _mm256_alignr_epi8(input, carried, 14);
+      const __m256i prev3 = _mm256_alignr_epi8(input, carried, 13);
+      const __m256i first_byte_high = _mm256_shuffle_epi8(
+          first_byte_high_table,
+          _mm256_and_si256(_mm256_srli_epi16(prev1, 4), low_bits));
+      const __m256i first_byte_low = _mm256_shuffle_epi8(
+          first_byte_low_table, _mm256_and_si256(prev1, low_bits));
+      const __m256i second_byte_high = _mm256_shuffle_epi8(
+          second_byte_high_table,
+          _mm256_and_si256(_mm256_srli_epi16(input, 4), low_bits));
+      const __m256i pair_errors = _mm256_and_si256(
+          _mm256_and_si256(first_byte_high, first_byte_low), second_byte_high);
+      const __m256i must_be_continuation = _mm256_and_si256(
+          _mm256_or_si256(
+              _mm256_subs_epu8(prev2, _mm256_set1_epi8(0xE0 - 0x80)),
+              _mm256_subs_epu8(prev3, _mm256_set1_epi8(0xF0 - 0x80))),
+          _mm256_set1_epi8(static_cast<char>(0x80)));
+      errors = _mm256_or_si256(
+          errors, _mm256_xor_si256(must_be_continuation, pair_errors));
+      noncharacters = _mm256_or_si256(
+          noncharacters,
+          _mm256_or_si256(
+              _mm256_and_si256(
+                  _mm256_cmpeq_epi8(prev1,
+                                    _mm256_set1_epi8(static_cast<char>(0xEF))),
+                  _mm256_cmpeq_epi8(input,
+                                    _mm256_set1_epi8(static_cast<char>(0xB7)))),
+              _mm256_and_si256(
+                  _mm256_cmpeq_epi8(prev1,
+                                    _mm256_set1_epi8(static_cast<char>(0xBF))),
+                  _mm256_cmpeq_epi8(
+                      _mm256_or_si256(input, _mm256_set1_epi8(1)),
+                      _mm256_set1_epi8(static_cast<char>(0xBF))))));
+      previous_incomplete = _mm256_subs_epu8(input, incomplete_max);
+    }
+    previous = input;
+    if (i % kErrorCheckInterval == 0 && !_mm256_testz_si256(errors, errors))
+      return UTF8Validity::kInvalid;
+  }
+  if (!_mm256_testz_si256(errors, errors))
+    return UTF8Validity::kInvalid;
+  return _mm256_testz_si256(noncharacters, noncharacters)
+             ? UTF8Validity::kValid
+             : UTF8Validity::kMaybeNoncharacters;
+}
+
+ValidateUTF8Function GetValidateUTF8Function() {
+  static const ValidateUTF8Function function = []() -> ValidateUTF8Function {
+    const CPU cpu;
+    if (cpu.has_avx2())
+      return &ValidateUTF8AVX2;
+    if (cpu.has_ssse3())
+      return &ValidateUTF8SSSE3;
+    return &ValidateUTF8Unvectorized;
+  }();
+  return function;
+}
+
+#elif defined(ARCH_CPU_ARM64)
+
+size_t CountLeadingASCIIVectorized(const char* data, size_t length) {
+  size_t i = 0;
+  for (; i + 16 <= length; i += 16) {
+    if (vmaxvq_u8(vld1q_u8(reinterpret_cast<const uint8_t*>(data + i))) >=
+        0x80) {
+      break;
+    }
+  }
+  return i + CountLeadingASCIIUnvectorized(data + i, length - i);
+}
+
+size_t CountLeadingASCIIVectorized(const char16_t* data, size_t length) {
+  size_t i = 0;
+  for (; i + 8 <= length; i += 8) {
+    if (vmaxvq_u16(vld1q_u16(reinterpret_cast<const uint16_t*>(data + i))) >=
+        0x80) {
+      break;
+    }
+  }
+  return i + CountLeadingASCIIUnvectorized(data + i, length - i);
+}
+
+size_t CopyLeadingASCIIVectorized(const char* src,
+                                  size_t length,
+                                  char16_t* dest) {
+  size_t i = 0;
+  for (; i + 16 <= length; i += 16) {
+    const uint8x16_t chars =
+        vld1q_u8(reinterpret_cast<const uint8_t*>(src + i));
+    if (vmaxvq_u8(chars) >= 0x80)
+      break;
+    uint16_t* out = reinterpret_cast<uint16_t*>(dest + i);
+    vst1q_u16(out, vmovl_u8(vget_low_u8(chars)));
+    vst1q_u16(out + 8, vmovl_high_u8(chars));
+  }
+  return i + CopyLeadingASCIIUnvectorized(src + i, length - i, dest + i);
+}
+
+size_t CopyLeadingASCIIVectorized(const char16_t* src,
+                                  size_t length,
+                                  char* dest) {
+  size_t i = 0;
+  for (; i + 16 <= length; i += 16) {
+    const uint16_t* in = reinterpret_cast<const uint16_t*>(src + i);
+    const uint16x8_t low = vld1q_u16(in);
+    const uint16x8_t high = vld1q_u16(in + 8);
+    if (vmaxvq_u16(vorrq_u16(low, high)) >= 0x80)
+      break;
+    vst1q_u8(reinterpret_cast<uint8_t*>(dest + i),
+             vmovn_high_u16(vmovn_u16(low), high));
+  }
+  return i + CopyLeadingASCIIUnvectorized(src + i, length - i, dest + i);
+}
+
+UTF8Validity ValidateUTF8NEON(const char* data, size_t length) {
+  constexpr size_t kBlockSize = 16;
+  const uint8x16_t first_byte_high_table = vld1q_u8(kFirstByteHighTable);
+  const uint8x16_t first_byte_low_table = vld1q_u8(kFirstByteLowTable);
+  const uint8x16_t second_byte_high_table = vld1q_u8(kSecondByteHighTable);
+  const uint8x16_t low_bits = vdupq_n_u8(0x0F);
+  alignas(16) static constexpr uint8_t kIncompleteMax[16] = {
+      0xFF, 0xFF, 0xFF, 0xFF, 0xFF,     0xFF,     0xFF,    0xFF,
+      0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xF0 - 1, 0xE0 - 1, 0xC0 - 1};
+  const uint8x16_t incomplete_max = vld1q_u8(kIncompleteMax);
+  const uint8x16_t zero = vdupq_n_u8(0);
+
+  uint8x16_t errors = zero;
+  uint8x16_t noncharacters = zero;
+  uint8x16_t previous = zero;
+  uint8x16_t previous_incomplete = zero;
+  const size_t full_size = length - length % kBlockSize;
+  char last_block[kBlockSize] = {};
+  memcpy(last_block, data + full_size, length - full_size);
+  for (size_t i = 0; i <= full_size; i += kBlockSize) {
+    const char* block = i < full_size ? data + i : last_block;
+    const uint8x16_t input = vld1q_u8(reinterpret_cast<const uint8_t*>(block));
+    if (vmaxvq_u8(input) < 0x80) {
+      errors = vorrq_u8(errors, previous_incomplete);
+      previous_incomplete = zero;
+    } else {
+      const uint8x16_t prev1 = vextq_u8(previous, input, 15);
+      const uint8x16_t prev2 = vextq_u8(previous, input, 14);
+      const uint8x16_t prev3 = vextq_u8(previous, input, 13);
+      const uint8x16_t first_byte_high =
+          vqtbl1q_u8(first_byte_high_table, vshrq_n_u8(prev1, 4));
+      const uint8x16_t first_byte_low =
+          vqtbl1q_u8(first_byte_low_table, vandq_u8(prev1, low_bits));
+      const uint8x16_t second_byte_high =
+          vqtbl1q_u8(second_byte_high_table, vshrq_n_u8(input, 4));
+      const uint8x16_t pair_errors = vandq_u8(
+          vandq_u8(first_byte_high, first_byte_low), second_byte_high);
+      const uint8x16_t must_be_continuation =
+          vandq_u8(vorrq_u8(vqsubq_u8(prev2, vdupq_n_u8(0xE0 - 0x80)),
+                            vqsubq_u8(prev3, vdupq_n_u8(0xF0 - 0x80))),
+                   vdupq_n_u8(0x80));
+      errors = vorrq_u8(errors, veorq_u8(must_be_continuation, pair_errors));
+      noncharacters = vorrq_u8(
+          noncharacters,
+          vorrq_u8(vandq_u8(vceqq_u8(prev1, vdupq_n_u8(0xEF)),
+                            vceqq_u8(input, vdupq_n_u8(0xB7))),
+                   vandq_u8(vceqq_u8(prev1, vdupq_n_u8(0xBF)),
+                            vceqq_u8(vorrq_u8(input, vdupq_n_u8(1)),
+                                     vdupq_n_u8(0xBF)))));
+      previous_incomplete = vqsubq_u8(input, incomplete_max);
+    }
+    previous = input;
+    if (i % kErrorCheckInterval == 0 && vmaxvq_u8(errors))
+      return UTF8Validity::kInvalid;
+  }
+  if (vmaxvq_u8(errors))
+    return UTF8Validity::kInvalid;
+  return vmaxvq_u8(noncharacters) ? UTF8Validity::kMaybeNoncharacters
+                                  : UTF8Validity::kValid;
+}
+
+ValidateUTF8Function GetValidateUTF8Function() {
+  return &ValidateUTF8NEON;
+}
+
+#else
+
+template <typename Char>
+size_t CountLeadingASCIIVectorized(const Char* data, size_t length) {
+  return CountLeadingASCIIUnvectorized(data, length);
+}
+
+template <typename SrcChar, typename DestChar>
+size_t CopyLeadingASCIIVectorized(const SrcChar* src,
+                                  size_t length,
+                                  DestChar* dest) {
+  return CopyLeadingASCIIUnvectorized(src, length, dest);
+}
+
+ValidateUTF8Function GetValidateUTF8Function() {
+  return &ValidateUTF8Unvectorized;
+}
+
+#endif
+
+}  // namespace
+
+size_t CountLeadingASCII(const char* data, size_t length) {
+  return CountLeadingASCIIVectorized(data, length);
+}
+
+size_t CountLeadingASCII(const char16_t* data, size_t length) {
+  return CountLeadingASCIIVectorized(data, length);
+}
+
+size_t CopyLeadingASCII(const char* src, size_t length, char16_t* dest) {
+  return CopyLeadingASCIIVectorized(src, length, dest);
+}
+
+size_t CopyLeadingASCII(const char16_t* src, size_t length, char* dest) {
+  return CopyLeadingASCIIVectorized(src, length, dest);
+}
+
+UTF8Validity ValidateUTF8(const char* data, size_t length) {
+  // Short strings aren't worth the setup of the vectorized validation.
+  if (length < 32)
+    return ValidateUTF8Unvectorized(data, length);
+  return GetValidateUTF8Function()(data, length);
+}
+
+}  // namespace internal
+}  // namespace base
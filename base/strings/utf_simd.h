@@ -0,0 +1,52 @@
+// Copyright 2022 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#ifndef BASE_STRINGS_UTF_SIMD_H_
+#define BASE_STRINGS_UTF_SIMD_H_
+
+#include <stddef.h>
+
+#include "base/base_export.h"
+
+namespace base {
+namespace internal {
+
+// Vectorized kernels for the UTF-8 validation and the UTF-8/UTF-16
+// conversions. They use AVX2 or SSSE3 when the CPU supports them at runtime,
+// SSE2 otherwise on x86-64, and NEON on arm64. The results are the same as
+// those of the scalar code in base/strings/, which they speed up.
+
+// Returns the length of the longest ASCII prefix of |data|.
+BASE_EXPORT size_t CountLeadingASCII(const char* data, size_t length);
+BASE_EXPORT size_t CountLeadingASCII(const char16_t* data, size_t length);
+
+// Copies the longest ASCII prefix of |src| to |dest|, widened or narrowed, and
+// returns its length. |dest| must have room for |length| code units.
+BASE_EXPORT size_t CopyLeadingASCII(const char* src,
+                                    size_t length,
+                                    char16_t* dest);
+BASE_EXPORT size_t CopyLeadingASCII(const char16_t* src,
+                                    size_t length,
+                                    char* dest);
+
+enum class UTF8Validity {
+  // Not well-formed UTF-8: IsStringUTF8AllowingNoncharacters() is false.
+  kInvalid,
+  // Well-formed, but the validation saw sequences which may be
+  // noncharacters, which IsStringUTF8() must check one at a time.
+  kMaybeNoncharacters,
+  // Well-formed, without noncharacters: IsStringUTF8() is true.
+  kValid,
+};
+
+// Validates |data| as UTF-8 as defined by RFC 3629: overlong sequences,
+// surrogates and code points above U+10FFFF are invalid. Validates blocks of
+// 16 or 32 bytes at once, following "Validating UTF-8 In Less Than One
+// Instruction Per Byte" (Keiser and Lemire), and skips the ASCII blocks.
+BASE_EXPORT UTF8Validity ValidateUTF8(const char* data, size_t length);
+
+}  // namespace internal
+}  // namespace base
+
+#endif  // BASE_STRINGS_UTF_SIMD_H_
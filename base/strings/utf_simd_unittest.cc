@@ -0,0 +1,163 @@
+// Copyright 2022 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "base/strings/utf_simd.h"
+
+#include <stdint.h>
+
+#include <random>
+#include <string>
+
+#include "base/strings/string_util.h"
+#include "base/strings/string_util_internal.h"
+#include "base/strings/utf_string_conversion_utils.h"
+#include "testing/gtest/include/gtest/gtest.h"
+
+namespace base {
+namespace internal {
+
+namespace {
+
+// Checks ValidateUTF8() against the scalar validation of IsStringUTF8().
+void ExpectSameValidity(const std::string& str) {
+  const UTF8Validity validity = ValidateUTF8(str.data(), str.size());
+  const bool valid_codepoints = DoIsStringUTF8<IsValidCodepoint>(str);
+  const bool valid_characters = DoIsStringUTF8<IsValidCharacter>(str);
+  EXPECT_EQ(valid_codepoints, validity != UTF8Validity::kInvalid) << str;
+  if (validity == UTF8Validity::kValid)
+    EXPECT_TRUE(valid_characters) << str;
+  if (valid_codepoints && !valid_characters)
+    EXPECT_EQ(UTF8Validity::kMaybeNoncharacters, validity) << str;
+  EXPECT_EQ(valid_characters, IsStringUTF8(str)) << str;
+  EXPECT_EQ(valid_codepoints, IsStringUTF8AllowingNoncharacters(str)) << str;
+}
+
+}  // namespace
+
+TEST(UTFSIMDTest, ValidateUTF8Empty) {
+  EXPECT_EQ(UTF8Validity::kValid, ValidateUTF8("", 0));
+}
+
+// Places all the pairs of bytes, followed by continuation bytes or not, at
+// offsets which straddle the 16- and 32-byte blocks.
+TEST(UTFSIMDTest, ValidateUTF8AllPairs) {
+  const uint8_t kThirdBytes[] = {0x00, 0x41, 0x80, 0x9F, 0xA0, 0xBF, 0xC2};
+  for (size_t offset : {0, 13, 14, 15, 29, 30, 31, 46}) {
+    std::string str(48, 'a');
+    for (int first = 0x80; first <= 0xFF; ++first) {
+      for (int second = 0; second <= 0xFF; ++second) {
+        for (uint8_t third : kThirdBytes) {
+          str[offset] = static_cast<char>(first);
+          str[offset + 1] = static_cast<char>(second);
+          if (offset + 2 < str.size())
+            str[offset + 2] = static_cast<char>(third);
+          ExpectSameValidity(str);
+          // Also with one more continuation byte, for 4-byte sequences.
+          if (offset + 3 < str.size()) {
+            str[offset + 3] = static_cast<char>(0x80);
+            ExpectSameValidity(str);
+            str[offset + 3] = 'a';
+          }
+        }
+      }
+    }
+  }
+}
+
+TEST(UTFSIMDTest, ValidateUTF8TruncatedAtEnd) {
+  for (size_t length = 16; length <= 70; ++length) {
+    for (const char* suffix : {"\xC3", "\xE2\x82", "\xF0\x9F\x98", "\xE2",
+                               "\xF0", "\xF0\x9F", "\xC3\xA9"}) {
+      std::string str(length, 'a');
+      str += suffix;
+      ExpectSameValidity(str);
+    }
+  }
+}
+
+TEST(UTFSIMDTest, ValidateUTF8Noncharacters) {
+  std::string str(40, 'a');
+  const size_t prefix_size = str.size();
+  for (uint32_t code_point :
+       {0xFDD0u, 0xFDEFu, 0xFFFEu, 0xFFFFu, 0x1FFFEu, 0x10FFFFu}) {
+    str.resize(prefix_size);
+    WriteUnicodeCharacter(code_point, &str);
+    str += "tail";
+    EXPECT_EQ(UTF8Validity::kMaybeNoncharacters,
+              ValidateUTF8(str.data(), str.size()));
+    EXPECT_FALSE(IsStringUTF8(str));
+    EXPECT_TRUE(IsStringUTF8AllowingNoncharacters(str));
+  }
+  // Characters which share pairs of bytes with noncharacters.
+  for (uint32_t code_point : {0xFDC0u, 0xFDF0u, 0x0FFEu, 0x7FFFu}) {
+    str.resize(prefix_size);
+    WriteUnicodeCharacter(code_point, &str);
+    EXPECT_TRUE(IsStringUTF8(str));
+  }
+}
+
+TEST(UTFSIMDTest, ValidateUTF8Random) {
+  std::minstd_rand generator(42);
+  const uint32_t kCodePoints[] = {0x41,   0x7F,    0xE9,    0x7FF,   0x800,
+                                  0x20AC, 0xD7FF,  0xE000,  0xFFFD,  0xFDD0,
+                                  0xFFFF, 0x10000, 0x1F600, 0x10FFFF};
+  for (int i = 0; i < 20000; ++i) {
+    std::string str;
+    const size_t code_point_count = generator() % 100;
+    for (size_t j = 0; j < code_point_count; ++j) {
+      WriteUnicodeCharacter(kCodePoints[generator() % std::size(kCodePoints)],
+                            &str);
+    }
+    // Corrupts some of them.
+    if (!str.empty() && generator() % 2)
+      str[generator() % str.size()] = static_cast<char>(generator());
+    ExpectSameValidity(str);
+  }
+}
+
+TEST(UTFSIMDTest, CountLeadingASCII) {
+  for (size_t length = 0; length <= 70; ++length) {
+    for (size_t position = 0; position <= length; ++position) {
+      std::string str(length, 'a');
+      std::u16string str16(length, u'a');
+      if (position < length) {
+        str[position] = '\x80';
+        str16[position] = u'\x80';
+      }
+      EXPECT_EQ(position, CountLeadingASCII(str.data(), str.size()));
+      EXPECT_EQ(position, CountLeadingASCII(str16.data(), str16.size()));
+    }
+  }
+  const std::u16string non_latin = u"abcĀ";
+  EXPECT_EQ(3u, CountLeadingASCII(non_latin.data(), non_latin.size()));
+}
+
+TEST(UTFSIMDTest, CopyLeadingASCII) {
+  for (size_t length = 0; length <= 70; ++length) {
+    for (size_t position = 0; position <= length; ++position) {
+      std::string str;
+      std::u16string str16;
+      for (size_t i = 0; i < length; ++i) {
+        str.push_back(static_cast<char>('a' + i % 26));
+        str16.push_back(static_cast<char16_t>('a' + i % 26));
+      }
+      if (position < length) {
+        str[position] = '\xC3';
+        str16[position] = u'\x100';
+      }
+      std::u16string widened(length, u'\0');
+      EXPECT_EQ(position, CopyLeadingASCII(str.data(), str.size(),
+                                           widened.data()));
+      EXPECT_EQ(str16.substr(0, position), widened.substr(0, position));
+
+      std::string narrowed(length, '\0');
+      EXPECT_EQ(position, CopyLeadingASCII(str16.data(), str16.size(),
+                                           narrowed.data()));
+      EXPECT_EQ(str.substr(0, position), narrowed.substr(0, position));
+    }
+  }
+}
+
+}  // namespace internal
+}  // namespace base
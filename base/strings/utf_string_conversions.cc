@@ -12,6 +12,7 @@
 
 #include "base/strings/string_piece.h"
 #include "base/strings/string_util.h"
+#include "base/strings/utf_simd.h"
 #include "base/strings/utf_string_conversion_utils.h"
 #include "base/third_party/icu/icu_utf.h"
 #include "build/build_config.h"
@@ -85,6 +86,26 @@ void UnicodeAppendUnsafe(Char* out, int32_t* size, uint32_t code_point) {
   out[(*size)++] = code_point;
 }
 
+// CopyASCIIRun ---------------------------------------------------------------
+// Copies the run of ASCII code units at the start of |src| to |dest| with the
+// vectorized kernels, where they exist for the pair of encodings, and returns
+// its length.
+
+int32_t CopyASCIIRun(const char* src, int32_t src_len, char16_t* dest) {
+  return static_cast<int32_t>(internal::CopyLeadingASCII(
+      src, static_cast<size_t>(src_len), dest));
+}
+
+int32_t CopyASCIIRun(const char16_t* src, int32_t src_len, char* dest) {
+  return static_cast<int32_t>(internal::CopyLeadingASCII(
+      src, static_cast<size_t>(src_len), dest));
+}
+
+template <typename SrcChar, typename DestChar>
+int32_t CopyASCIIRun(const SrcChar* src, int32_t src_len, DestChar* dest) {
+  return 0;
+}
+
 // DoUTFConversion ------------------------------------------------------------
 // Main driver of UTFConversion specialized for different Src encodings.
 // dest has to have enough room for the converted text.
@@ -97,6 +118,13 @@ bool DoUTFConversion(const char* src,
   bool success = true;
 
   for (int32_t i = 0; i < src_len;) {
+    if (CBU8_IS_SINGLE(src[i])) {
+      const int32_t run = CopyASCIIRun(src + i, src_len - i, dest + *dest_len);
+      i += run;
+      *dest_len += run;
+      if (run)
+        continue;
+    }
     int32_t code_point;
     CBU8_NEXT(src, i, src_len, code_point);
 
@@ -131,6 +159,13 @@ bool DoUTFConversion(const char16_t* src,
   // Always have another symbol in order to avoid checking boundaries in the
   // middle of the surrogate pair.
   while (i < src_len - 1) {
+    if (src[i] < 0x80) {
+      const int32_t run = CopyASCIIRun(src + i, src_len - i, dest + *dest_len);
+      i += run;
+      *dest_len += run;
+      if (run)
+        continue;
+    }
     int32_t code_point;
 
     if (CBU16_IS_LEAD(src[i]) && CBU16_IS_TRAIL(src[i + 1])) {
@@ -4,6 +4,7 @@
 
 #include <tuple>
 
+#include "base/check_op.h"
 #include "base/strings/string_util.h"
 #include "base/strings/utf_string_conversions.h"
 
@@ -20,8 +21,15 @@ extern "C" int LLVMFuzzerTestOneInput(const uint8_t* data, size_t size) {
   base::UTF8ToWide(reinterpret_cast<const char*>(data), size,
                    &output_std_wstring);
   std::ignore = base::UTF8ToUTF16(string_piece_input);
-  base::UTF8ToUTF16(reinterpret_cast<const char*>(data), size,
-                    &output_string16);
+  const bool utf8_valid = base::UTF8ToUTF16(reinterpret_cast<const char*>(data),
+                                            size, &output_string16);
+
+  // The vectorized validation agrees with the conversion, which decodes the
+  // code points one at a time, and valid inputs convert back to themselves.
+  CHECK_EQ(utf8_valid,
+           base::IsStringUTF8AllowingNoncharacters(string_piece_input));
+  if (utf8_valid)
+    CHECK_EQ(base::UTF16ToUTF8(output_string16), string_piece_input);
 
   // Test for char16_t.
   if (size % 2 == 0) {
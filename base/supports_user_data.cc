@@ -18,6 +18,10 @@ SupportsUserData::SupportsUserData() {
   DETACH_FROM_SEQUENCE(sequence_checker_);
 }
 
+SupportsUserData::SupportsUserData(Arena* arena) : SupportsUserData() {
+  arena_ = arena;
+}
+
 SupportsUserData::SupportsUserData(SupportsUserData&&) = default;
 SupportsUserData& SupportsUserData::operator=(SupportsUserData&&) = default;
 
@@ -33,6 +37,10 @@ SupportsUserData::Data* SupportsUserData::GetUserData(const void* key) const {
 
 void SupportsUserData::SetUserData(const void* key,
                                    std::unique_ptr<Data> data) {
+  SetUserDataInternal(key, DataPtr(data.release()));
+}
+
+void SupportsUserData::SetUserDataInternal(const void* key, DataPtr data) {
   DCHECK_CALLED_ON_VALID_SEQUENCE(sequence_checker_);
   // Avoid null keys; they are too vulnerable to collision.
   DCHECK(key);
@@ -44,7 +52,13 @@ void SupportsUserData::SetUserData(const void* key,
 
 void SupportsUserData::RemoveUserData(const void* key) {
   DCHECK_CALLED_ON_VALID_SEQUENCE(sequence_checker_);
-  user_data_.erase(key);
+  auto found = user_data_.find(key);
+  if (found == user_data_.end())
+    return;
+  // The data is destroyed after its entry is erased, as it was from a
+  // std::map, since its destructor may look up the data of this object.
+  DataPtr data = std::move(found->second);
+  user_data_.erase(found);
 }
 
 void SupportsUserData::DetachFromSequence() {
@@ -63,8 +77,7 @@ SupportsUserData::~SupportsUserData() {
   if (!user_data_.empty()) {
     DCHECK_CALLED_ON_VALID_SEQUENCE(sequence_checker_);
   }
-  DataMap local_user_data;
-  user_data_.swap(local_user_data);
+  DataMap local_user_data = std::move(user_data_);
   // Now this->user_data_ is empty, and any destructors called transitively from
   // the destruction of |local_user_data| will see it that way instead of
   // examining a being-destroyed object.
@@ -72,7 +85,8 @@ SupportsUserData::~SupportsUserData() {
 
 void SupportsUserData::ClearAllUserData() {
   DCHECK_CALLED_ON_VALID_SEQUENCE(sequence_checker_);
-  user_data_.clear();
+  // As in the destructor, the data is destroyed once |user_data_| is empty.
+  DataMap local_user_data = std::move(user_data_);
 }
 
 }  // namespace base
@@ -7,8 +7,13 @@
 
 #include <map>
 #include <memory>
+#include <new>
+#include <type_traits>
+#include <utility>
 
 #include "base/base_export.h"
+#include "base/containers/small_map.h"
+#include "base/memory/arena.h"
 #include "base/memory/ref_counted.h"
 #include "base/sequence_checker.h"
 
@@ -16,9 +21,16 @@ namespace base {
 
 // This is a helper for classes that want to allow users to stash random data by
 // key. At destruction all the objects will be destructed.
+//
+// The first few entries are stored inline, so an object with little user data
+// only allocates the data itself, which EmplaceUserData() can also take from
+// the owner's Arena.
 class BASE_EXPORT SupportsUserData {
  public:
   SupportsUserData();
+  // The data which EmplaceUserData() creates comes from |arena|, which must
+  // not be reset before this object is destroyed.
+  explicit SupportsUserData(Arena* arena);
   SupportsUserData(SupportsUserData&&);
   SupportsUserData& operator=(SupportsUserData&&);
   SupportsUserData(const SupportsUserData&) = delete;
@@ -43,6 +55,25 @@ class BASE_EXPORT SupportsUserData {
   void SetUserData(const void* key, std::unique_ptr<Data> data);
   void RemoveUserData(const void* key);
 
+  // Creates a T, derived from Data, with |args| and sets it as the data for
+  // |key|. The T comes from the arena passed to the constructor, if any, and
+  // otherwise from the heap like the data passed to SetUserData(). Returns
+  // the T, which is owned by this object.
+  template <typename T, typename... Args>
+  T* EmplaceUserData(const void* key, Args&&... args) {
+    static_assert(std::is_base_of<Data, T>::value,
+                  "EmplaceUserData() creates SupportsUserData::Data");
+    T* data;
+    if (arena_) {
+      data = new (arena_->Allocate(sizeof(T), alignof(T)))
+          T(std::forward<Args>(args)...);
+    } else {
+      data = new T(std::forward<Args>(args)...);
+    }
+    SetUserDataInternal(key, DataPtr(data, DataDeleter(arena_ != nullptr)));
+    return data;
+  }
+
   // Adds all data from |other|, that is clonable, to |this|. That is, this
   // iterates over the data in |other|, and any data that returns non-null from
   // Clone() is added to |this|.
@@ -62,8 +93,33 @@ class BASE_EXPORT SupportsUserData {
   void ClearAllUserData();
 
  private:
-  using DataMap = std::map<const void*, std::unique_ptr<Data>>;
+  // Deletes the data, or only destroys it when it's in |arena_|, whose memory
+  // is freed when the arena is reset.
+  class DataDeleter {
+   public:
+    DataDeleter() : in_arena_(false) {}
+    explicit DataDeleter(bool in_arena) : in_arena_(in_arena) {}
+
+    void operator()(Data* data) const {
+      if (in_arena_)
+        data->~Data();
+      else
+        delete data;
+    }
+
+   private:
+    bool in_arena_;
+  };
+
+  using DataPtr = std::unique_ptr<Data, DataDeleter>;
+  // Keys are compared by address, so the inline entries need no hashing or
+  // ordering, and only objects with more than 4 entries allocate a std::map.
+  using DataMap = small_map<std::map<const void*, DataPtr>, 4>;
+
+  void SetUserDataInternal(const void* key, DataPtr data);
 
+  // Where EmplaceUserData() creates data, if not on the heap.
+  Arena* arena_ = nullptr;
   // Externally-defined data accessible by key.
   DataMap user_data_;
   // Guards usage of |user_data_|
@@ -0,0 +1,87 @@
+// Copyright 2022 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "base/supports_user_data.h"
+
+#include <memory>
+#include <string>
+
+#include "base/memory/arena.h"
+#include "base/strings/stringprintf.h"
+#include "base/time/time.h"
+#include "testing/gtest/include/gtest/gtest.h"
+#include "testing/perf/perf_result_reporter.h"
+
+namespace base {
+
+namespace {
+
+constexpr char kMetricPrefixSupportsUserData[] = "SupportsUserData.";
+constexpr char kMetricTimePerObject[] = "time_per_object";
+
+constexpr int kObjectsPerArena = 1000;
+constexpr int kObjects = 1000 * kObjectsPerArena;
+// The keys of the user data, as the per-request context objects have a few.
+constexpr char kKeys[8] = {};
+
+perf_test::PerfResultReporter SetUpReporter(const std::string& story_name) {
+  perf_test::PerfResultReporter reporter(kMetricPrefixSupportsUserData,
+                                         story_name);
+  reporter.RegisterImportantMetric(kMetricTimePerObject, "ns");
+  return reporter;
+}
+
+class Context : public SupportsUserData {
+ public:
+  explicit Context(Arena* arena) : SupportsUserData(arena) {}
+};
+
+class TestData : public SupportsUserData::Data {
+ public:
+  explicit TestData(int value) : value_(value) {}
+
+  int value() const { return value_; }
+
+ private:
+  const int value_;
+};
+
+// Measures the creation of objects with |key_count| user data entries, created
+// with EmplaceUserData() from an arena reset every kObjectsPerArena objects if
+// |use_arena|, and otherwise on the heap, and their destruction.
+void RunObjectTest(int key_count, bool use_arena) {
+  Arena arena;
+  int sum = 0;
+  const TimeTicks start = TimeTicks::Now();
+  for (int i = 0; i < kObjects / kObjectsPerArena; ++i) {
+    for (int j = 0; j < kObjectsPerArena; ++j) {
+      Context context(use_arena ? &arena : nullptr);
+      for (int key = 0; key < key_count; ++key)
+        context.EmplaceUserData<TestData>(&kKeys[key], key);
+      sum += static_cast<TestData*>(context.GetUserData(&kKeys[0]))->value();
+    }
+    arena.Reset();
+  }
+  const TimeDelta duration = TimeTicks::Now() - start;
+  EXPECT_EQ(0, sum);
+
+  auto reporter = SetUpReporter(
+      StringPrintf("%s_%d", use_arena ? "Arena" : "Heap", key_count));
+  reporter.AddResult(kMetricTimePerObject,
+                     duration.InNanoseconds() / static_cast<double>(kObjects));
+}
+
+}  // namespace
+
+TEST(SupportsUserDataPerfTest, HeapData) {
+  for (int key_count : {1, 2, 4, 8})
+    RunObjectTest(key_count, /*use_arena=*/false);
+}
+
+TEST(SupportsUserDataPerfTest, ArenaData) {
+  for (int key_count : {1, 2, 4, 8})
+    RunObjectTest(key_count, /*use_arena=*/true);
+}
+
+}  // namespace base
@@ -4,6 +4,10 @@
 
 #include "base/supports_user_data.h"
 
+#include <iterator>
+#include <vector>
+
+#include "base/memory/arena.h"
 #include "base/memory/ptr_util.h"
 #include "base/memory/raw_ptr.h"
 #include "testing/gtest/include/gtest/gtest.h"
@@ -12,6 +16,9 @@ namespace base {
 namespace {
 
 struct TestSupportsUserData : public SupportsUserData {
+  TestSupportsUserData() = default;
+  explicit TestSupportsUserData(Arena* arena) : SupportsUserData(arena) {}
+
   // Make ClearAllUserData public so tests can access it.
   using SupportsUserData::ClearAllUserData;
 };
@@ -72,5 +79,86 @@ TEST(SupportsUserDataTest, ClearAllUserData) {
   EXPECT_FALSE(supports_user_data.GetUserData(&key2));
 }
 
+TEST(SupportsUserDataTest, RemoveWorksRecursively) {
+  TestSupportsUserData supports_user_data;
+  char key = 0;
+  supports_user_data.SetUserData(
+      &key, std::make_unique<UsesItself>(&supports_user_data, &key));
+  // The destruction of the data runs the actual test.
+  supports_user_data.RemoveUserData(&key);
+}
+
+TEST(SupportsUserDataTest, ManyKeys) {
+  TestSupportsUserData supports_user_data;
+  // More keys than are stored inline.
+  char keys[10] = {};
+  std::vector<SupportsUserData::Data*> data;
+  for (char& key : keys) {
+    supports_user_data.SetUserData(&key, std::make_unique<TestData>());
+    data.push_back(supports_user_data.GetUserData(&key));
+  }
+  for (size_t i = 0; i < std::size(keys); ++i)
+    EXPECT_EQ(data[i], supports_user_data.GetUserData(&keys[i]));
+
+  supports_user_data.RemoveUserData(&keys[3]);
+  EXPECT_FALSE(supports_user_data.GetUserData(&keys[3]));
+  EXPECT_EQ(data[4], supports_user_data.GetUserData(&keys[4]));
+
+  TestSupportsUserData moved = std::move(supports_user_data);
+  EXPECT_EQ(data[9], moved.GetUserData(&keys[9]));
+  EXPECT_FALSE(supports_user_data.GetUserData(&keys[9]));
+}
+
+struct CountsDestructions : public SupportsUserData::Data {
+  explicit CountsDestructions(int* destructions)
+      : destructions_(destructions) {}
+  ~CountsDestructions() override { ++*destructions_; }
+
+  raw_ptr<int> destructions_;
+};
+
+TEST(SupportsUserDataTest, EmplaceUserData) {
+  TestSupportsUserData supports_user_data;
+  char key = 0;
+  int destructions = 0;
+  CountsDestructions* data =
+      supports_user_data.EmplaceUserData<CountsDestructions>(&key,
+                                                             &destructions);
+  EXPECT_EQ(data, supports_user_data.GetUserData(&key));
+
+  supports_user_data.SetUserData(&key, nullptr);
+  EXPECT_EQ(1, destructions);
+}
+
+TEST(SupportsUserDataTest, EmplaceUserDataInArena) {
+  Arena arena;
+  int destructions = 0;
+  {
+    TestSupportsUserData supports_user_data(&arena);
+    char key1 = 0;
+    char key2 = 0;
+    supports_user_data.EmplaceUserData<CountsDestructions>(&key1,
+                                                           &destructions);
+    supports_user_data.EmplaceUserData<CountsDestructions>(&key2,
+                                                           &destructions);
+    EXPECT_GT(arena.reserved_bytes(), 0u);
+
+    // Replacing the data destroys it, while the arena keeps its memory.
+    supports_user_data.EmplaceUserData<CountsDestructions>(&key1,
+                                                           &destructions);
+    EXPECT_EQ(1, destructions);
+
+    // The data which SetUserData() takes still comes from the heap.
+    supports_user_data.SetUserData(
+        &key2, std::make_unique<CountsDestructions>(&destructions));
+    EXPECT_EQ(2, destructions);
+  }
+  EXPECT_EQ(4, destructions);
+
+  // Resetting the arena doesn't destroy the data again.
+  arena.Reset();
+  EXPECT_EQ(4, destructions);
+}
+
 }  // namespace
 }  // namespace base
@@ -63,9 +63,14 @@
 #define BASE_SYNCHRONIZATION_CONDITION_VARIABLE_H_
 
 #include "base/memory/raw_ptr.h"
+#include "base/synchronization/synchronization_buildflags.h"
 #include "build/build_config.h"
 
-#if BUILDFLAG(IS_POSIX) || BUILDFLAG(IS_FUCHSIA)
+#if BUILDFLAG(ENABLE_FUTEX_LOCK)
+#include <stdint.h>
+
+#include <atomic>
+#elif BUILDFLAG(IS_POSIX) || BUILDFLAG(IS_FUCHSIA)
 #include <pthread.h>
 #endif
 
@@ -116,6 +121,12 @@ class BASE_EXPORT ConditionVariable {
 #if BUILDFLAG(IS_WIN)
   CHROME_CONDITION_VARIABLE cv_;
   const raw_ptr<CHROME_SRWLOCK> srwlock_;
+#elif BUILDFLAG(ENABLE_FUTEX_LOCK)
+  // A futex which Signal() and Broadcast() increment before waking up
+  // waiters, so that a waiter which is about to sleep doesn't miss them.
+  std::atomic<int32_t> sequence_{0};
+  std::atomic<int32_t> num_waiters_{0};
+  const raw_ptr<internal::LockImpl> user_lock_impl_;
 #elif BUILDFLAG(IS_POSIX) || BUILDFLAG(IS_FUCHSIA)
   pthread_cond_t condition_;
   raw_ptr<pthread_mutex_t> user_mutex_;
@@ -0,0 +1,120 @@
+// Copyright 2022 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "base/synchronization/condition_variable.h"
+
+#include <errno.h>
+#include <limits.h>
+#include <linux/futex.h>
+#include <sys/syscall.h>
+#include <time.h>
+#include <unistd.h>
+
+#include <algorithm>
+
+#include "base/synchronization/lock.h"
+#include "base/threading/scoped_blocking_call.h"
+#include "base/threading/thread_restrictions.h"
+#include "base/time/time.h"
+#include "third_party/abseil-cpp/absl/types/optional.h"
+
+namespace base {
+
+namespace {
+
+// Sleeps while |*futex| is |expected|, for at most |relative_timeout| if it
+// isn't null. Spurious wake-ups are fine for ConditionVariable.
+void FutexWait(std::atomic<int32_t>* futex,
+               int32_t expected,
+               const struct timespec* relative_timeout) {
+  int saved_errno = errno;
+  syscall(SYS_futex, futex, FUTEX_WAIT | FUTEX_PRIVATE_FLAG, expected,
+          relative_timeout, nullptr, 0);
+  errno = saved_errno;
+}
+
+void FutexWake(std::atomic<int32_t>* futex, int num_waiters) {
+  int saved_errno = errno;
+  long rv = syscall(SYS_futex, futex, FUTEX_WAKE | FUTEX_PRIVATE_FLAG,
+                    num_waiters, nullptr, nullptr, 0);
+  DCHECK_NE(rv, -1);
+  errno = saved_errno;
+}
+
+}  // namespace
+
+ConditionVariable::ConditionVariable(Lock* user_lock)
+    : user_lock_impl_(&user_lock->lock_)
+#if DCHECK_IS_ON()
+    , user_lock_(user_lock)
+#endif
+{
+}
+
+ConditionVariable::~ConditionVariable() {
+  DCHECK_EQ(num_waiters_.load(std::memory_order_relaxed), 0);
+}
+
+void ConditionVariable::Wait() {
+  absl::optional<internal::ScopedBlockingCallWithBaseSyncPrimitives>
+      scoped_blocking_call;
+  if (waiting_is_blocking_)
+    scoped_blocking_call.emplace(FROM_HERE, BlockingType::MAY_BLOCK);
+
+#if DCHECK_IS_ON()
+  user_lock_->CheckHeldAndUnmark();
+#endif
+  // The sequence is read before the lock is released, so that a Signal() or a
+  // Broadcast() after that makes FutexWait() return.
+  num_waiters_.fetch_add(1);
+  const int32_t sequence = sequence_.load();
+  user_lock_impl_->Unlock();
+  FutexWait(&sequence_, sequence, nullptr);
+  num_waiters_.fetch_sub(1, std::memory_order_relaxed);
+  user_lock_impl_->Lock();
+#if DCHECK_IS_ON()
+  user_lock_->CheckUnheldAndMark();
+#endif
+}
+
+void ConditionVariable::TimedWait(const TimeDelta& max_time) {
+  absl::optional<internal::ScopedBlockingCallWithBaseSyncPrimitives>
+      scoped_blocking_call;
+  if (waiting_is_blocking_)
+    scoped_blocking_call.emplace(FROM_HERE, BlockingType::MAY_BLOCK);
+
+  // FUTEX_WAIT takes a relative timeout, measured on CLOCK_MONOTONIC.
+  int64_t usecs = std::max<int64_t>(max_time.InMicroseconds(), 0);
+  struct timespec relative_time;
+  relative_time.tv_sec = usecs / Time::kMicrosecondsPerSecond;
+  relative_time.tv_nsec =
+      (usecs % Time::kMicrosecondsPerSecond) * Time::kNanosecondsPerMicrosecond;
+
+#if DCHECK_IS_ON()
+  user_lock_->CheckHeldAndUnmark();
+#endif
+  num_waiters_.fetch_add(1);
+  const int32_t sequence = sequence_.load();
+  user_lock_impl_->Unlock();
+  FutexWait(&sequence_, sequence, &relative_time);
+  num_waiters_.fetch_sub(1, std::memory_order_relaxed);
+  user_lock_impl_->Lock();
+#if DCHECK_IS_ON()
+  user_lock_->CheckUnheldAndMark();
+#endif
+}
+
+void ConditionVariable::Broadcast() {
+  sequence_.fetch_add(1);
+  if (num_waiters_.load())
+    FutexWake(&sequence_, INT_MAX);
+}
+
+void ConditionVariable::Signal() {
+  sequence_.fetch_add(1);
+  if (num_waiters_.load())
+    FutexWake(&sequence_, 1);
+}
+
+}  // namespace base
@@ -0,0 +1,84 @@
+// Copyright 2022 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "base/synchronization/lock_contention_profiler.h"
+
+#include <atomic>
+
+#include "base/auto_reset.h"
+#include "base/compiler_specific.h"
+#include "base/trace_event/base_tracing.h"
+
+namespace base {
+
+namespace {
+
+std::atomic<uint32_t> g_sampling_interval{0};
+std::atomic<LockContentionProfiler::SampleCallback> g_sample_callback{nullptr};
+
+// The number of contended acquisitions before the next sample on the current
+// thread.
+thread_local uint32_t g_tls_acquisitions_until_sample = 0;
+
+// Whether the current thread is recording a sample. Tracing and the callback
+// may acquire locks, which aren't sampled.
+thread_local bool g_tls_in_sample = false;
+
+}  // namespace
+
+// static
+void LockContentionProfiler::SetSamplingInterval(uint32_t interval) {
+  g_sampling_interval.store(interval, std::memory_order_relaxed);
+}
+
+// static
+uint32_t LockContentionProfiler::GetSamplingInterval() {
+  return g_sampling_interval.load(std::memory_order_relaxed);
+}
+
+// static
+void LockContentionProfiler::SetSampleCallbackForTesting(
+    SampleCallback callback) {
+  g_sample_callback.store(callback, std::memory_order_relaxed);
+}
+
+namespace internal {
+
+ScopedLockContentionSample::ScopedLockContentionSample(
+    const void* program_counter)
+    : program_counter_(program_counter) {
+  const uint32_t interval = g_sampling_interval.load(std::memory_order_relaxed);
+  if (LIKELY(!interval) || g_tls_in_sample)
+    return;
+  if (g_tls_acquisitions_until_sample > 0) {
+    --g_tls_acquisitions_until_sample;
+    return;
+  }
+  g_tls_acquisitions_until_sample = interval - 1;
+  start_ = TimeTicks::Now();
+}
+
+ScopedLockContentionSample::~ScopedLockContentionSample() {
+  if (LIKELY(start_.is_null()))
+    return;
+  [[maybe_unused]] const TimeTicks end = TimeTicks::Now();
+  AutoReset<bool> in_sample(&g_tls_in_sample, true);
+
+  // The program counter can be symbolized offline, like the one of a Location
+  // without source information.
+  TRACE_EVENT_BEGIN(TRACE_DISABLED_BY_DEFAULT("base"), "Lock::Contention",
+                    perfetto::ThreadTrack::Current(), start_, "program_counter",
+                    reinterpret_cast<uintptr_t>(program_counter_));
+  TRACE_EVENT_END(TRACE_DISABLED_BY_DEFAULT("base"),
+                  perfetto::ThreadTrack::Current(), end);
+
+  LockContentionProfiler::SampleCallback callback =
+      g_sample_callback.load(std::memory_order_relaxed);
+  if (callback)
+    callback({end - start_, program_counter_});
+}
+
+}  // namespace internal
+
+}  // namespace base
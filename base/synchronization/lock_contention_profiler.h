@@ -0,0 +1,69 @@
+// Copyright 2022 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#ifndef BASE_SYNCHRONIZATION_LOCK_CONTENTION_PROFILER_H_
+#define BASE_SYNCHRONIZATION_LOCK_CONTENTION_PROFILER_H_
+
+#include <stdint.h>
+
+#include "base/base_export.h"
+#include "base/time/time.h"
+
+namespace base {
+
+// Samples the contended acquisitions of base::Lock, i.e. those which don't
+// succeed right away: one in N on each thread. A sample records how long the
+// thread waited for the lock and where it was acquired (the program counter,
+// like a Location without source information), as a
+// "Lock::Contention" trace event in the TRACE_DISABLED_BY_DEFAULT("base")
+// category. Sampling is disabled by default, and costs nothing to uncontended
+// acquisitions.
+class BASE_EXPORT LockContentionProfiler {
+ public:
+  struct Sample {
+    TimeDelta wait_time;
+    // The program counter in the caller of Lock::Acquire() (in optimized
+    // builds, where Acquire() is inlined).
+    const void* program_counter;
+  };
+
+  using SampleCallback = void (*)(const Sample& sample);
+
+  LockContentionProfiler() = delete;
+
+  // Samples one in |interval| contended acquisitions on each thread. 0 disables
+  // sampling. Can be called on any thread.
+  static void SetSamplingInterval(uint32_t interval);
+  static uint32_t GetSamplingInterval();
+
+  // Runs |callback| for each sample, on the acquiring thread while the lock is
+  // held. Samples aren't taken for locks acquired by |callback|. Null removes
+  // the callback.
+  static void SetSampleCallbackForTesting(SampleCallback callback);
+};
+
+namespace internal {
+
+// Measures the contended acquisition of a Lock which happens during its
+// lifetime, if it is sampled. |program_counter| is the location of the
+// acquisition.
+class BASE_EXPORT ScopedLockContentionSample {
+ public:
+  explicit ScopedLockContentionSample(const void* program_counter);
+  ScopedLockContentionSample(const ScopedLockContentionSample&) = delete;
+  ScopedLockContentionSample& operator=(const ScopedLockContentionSample&) =
+      delete;
+  ~ScopedLockContentionSample();
+
+ private:
+  const void* const program_counter_;
+  // Null if the acquisition isn't sampled.
+  TimeTicks start_;
+};
+
+}  // namespace internal
+
+}  // namespace base
+
+#endif  // BASE_SYNCHRONIZATION_LOCK_CONTENTION_PROFILER_H_
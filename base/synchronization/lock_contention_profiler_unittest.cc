@@ -0,0 +1,102 @@
+// Copyright 2022 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "base/synchronization/lock_contention_profiler.h"
+
+#include <atomic>
+
+#include "base/memory/raw_ptr.h"
+#include "base/synchronization/lock.h"
+#include "base/synchronization/waitable_event.h"
+#include "base/threading/platform_thread.h"
+#include "base/threading/simple_thread.h"
+#include "base/time/time.h"
+#include "testing/gtest/include/gtest/gtest.h"
+
+namespace base {
+
+namespace {
+
+std::atomic<int> g_num_samples{0};
+std::atomic<int64_t> g_max_wait_time_us{0};
+
+void RecordSample(const LockContentionProfiler::Sample& sample) {
+  g_num_samples.fetch_add(1, std::memory_order_relaxed);
+  EXPECT_NE(nullptr, sample.program_counter);
+  int64_t wait_time_us = sample.wait_time.InMicroseconds();
+  if (wait_time_us > g_max_wait_time_us.load(std::memory_order_relaxed))
+    g_max_wait_time_us.store(wait_time_us, std::memory_order_relaxed);
+}
+
+// Signals |acquiring| and then acquires |lock|.
+class Contender : public DelegateSimpleThread::Delegate {
+ public:
+  Contender(Lock* lock, WaitableEvent* acquiring)
+      : lock_(lock), acquiring_(acquiring) {}
+
+  void Run() override {
+    acquiring_->Signal();
+    AutoLock auto_lock(*lock_);
+  }
+
+ private:
+  const raw_ptr<Lock> lock_;
+  const raw_ptr<WaitableEvent> acquiring_;
+};
+
+class LockContentionProfilerTest : public testing::Test {
+ protected:
+  void SetUp() override {
+    g_num_samples = 0;
+    g_max_wait_time_us = 0;
+    LockContentionProfiler::SetSampleCallbackForTesting(&RecordSample);
+  }
+
+  void TearDown() override {
+    LockContentionProfiler::SetSamplingInterval(0);
+    LockContentionProfiler::SetSampleCallbackForTesting(nullptr);
+  }
+
+  // Acquires |lock_| on another thread while this thread holds it for
+  // |hold_time|.
+  void AcquireContendedLock(TimeDelta hold_time) {
+    WaitableEvent acquiring;
+    Contender contender(&lock_, &acquiring);
+    DelegateSimpleThread thread(&contender, "Contender");
+    lock_.Acquire();
+    thread.Start();
+    acquiring.Wait();
+    PlatformThread::Sleep(hold_time);
+    lock_.Release();
+    thread.Join();
+  }
+
+  Lock lock_;
+};
+
+}  // namespace
+
+TEST_F(LockContentionProfilerTest, DisabledByDefault) {
+  EXPECT_EQ(0u, LockContentionProfiler::GetSamplingInterval());
+  AcquireContendedLock(Milliseconds(10));
+  EXPECT_EQ(0, g_num_samples);
+}
+
+TEST_F(LockContentionProfilerTest, SamplesContendedAcquisition) {
+  LockContentionProfiler::SetSamplingInterval(1);
+  EXPECT_EQ(1u, LockContentionProfiler::GetSamplingInterval());
+  AcquireContendedLock(Milliseconds(10));
+  EXPECT_GE(g_num_samples, 1);
+  EXPECT_GT(g_max_wait_time_us, 0);
+}
+
+TEST_F(LockContentionProfilerTest, UncontendedAcquisitionIsNotSampled) {
+  LockContentionProfiler::SetSamplingInterval(1);
+  for (int i = 0; i < 100; ++i) {
+    AutoLock auto_lock(lock_);
+  }
+  EXPECT_EQ(0, g_num_samples);
+}
+
+}  // namespace base
@@ -7,11 +7,16 @@
 
 #include "base/base_export.h"
 #include "base/check_op.h"
+#include "base/synchronization/synchronization_buildflags.h"
 #include "base/thread_annotations.h"
 #include "build/build_config.h"
 
 #if BUILDFLAG(IS_WIN)
 #include "base/win/windows_types.h"
+#elif BUILDFLAG(ENABLE_FUTEX_LOCK)
+#include <stdint.h>
+
+#include <atomic>
 #elif BUILDFLAG(IS_POSIX) || BUILDFLAG(IS_FUCHSIA)
 #include <errno.h>
 #include <pthread.h>
@@ -47,6 +52,9 @@ class BASE_EXPORT LockImpl {
 
 #if BUILDFLAG(IS_WIN)
   using NativeHandle = CHROME_SRWLOCK;
+#elif BUILDFLAG(ENABLE_FUTEX_LOCK)
+  // One of the states below.
+  using NativeHandle = std::atomic<int32_t>;
 #elif BUILDFLAG(IS_POSIX) || BUILDFLAG(IS_FUCHSIA)
   using NativeHandle = pthread_mutex_t;
 #endif
@@ -76,7 +84,22 @@ class BASE_EXPORT LockImpl {
 #endif
 
   void LockInternalWithTracking();
+
+#if BUILDFLAG(ENABLE_FUTEX_LOCK)
+  // The lock is a futex, which sleepers wait on in the kLockedContended state,
+  // along the lines of partition_alloc's SpinningMutex. A contended Lock()
+  // spins for a bounded time before sleeping.
+  static constexpr int32_t kUnlocked = 0;
+  static constexpr int32_t kLockedUncontended = 1;
+  static constexpr int32_t kLockedContended = 2;
+
+  // Wakes up a thread sleeping in LockInternalWithTracking(), if any.
+  void FutexWake();
+
+  NativeHandle native_handle_{kUnlocked};
+#else
   NativeHandle native_handle_;
+#endif
 };
 
 void LockImpl::Lock() {
@@ -106,6 +129,27 @@ void LockImpl::Unlock() {
   ::ReleaseSRWLockExclusive(reinterpret_cast<PSRWLOCK>(&native_handle_));
 }
 
+#elif BUILDFLAG(ENABLE_FUTEX_LOCK)
+
+bool LockImpl::Try() {
+  // Checking the state first avoids taking the cache line exclusively when the
+  // lock is held.
+  int32_t expected = kUnlocked;
+  return native_handle_.load(std::memory_order_relaxed) == kUnlocked &&
+         native_handle_.compare_exchange_strong(expected, kLockedUncontended,
+                                                std::memory_order_acquire,
+                                                std::memory_order_relaxed);
+}
+
+void LockImpl::Unlock() {
+  if (native_handle_.exchange(kUnlocked, std::memory_order_release) ==
+      kLockedContended) {
+    // A thread may be sleeping. Another one can take the lock before it wakes
+    // up, which it then waits for again.
+    FutexWake();
+  }
+}
+
 #elif BUILDFLAG(IS_POSIX) || BUILDFLAG(IS_FUCHSIA)
 
 BASE_EXPORT std::string SystemErrorCodeToString(int error_code);
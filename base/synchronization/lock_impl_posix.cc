@@ -11,6 +11,7 @@
 #include "base/debug/activity_tracker.h"
 #include "base/posix/safe_strerror.h"
 #include "base/synchronization/lock.h"
+#include "base/synchronization/lock_contention_profiler.h"
 #include "base/synchronization/synchronization_buildflags.h"
 #include "build/build_config.h"
 
@@ -82,6 +83,8 @@ LockImpl::~LockImpl() {
 
 void LockImpl::LockInternalWithTracking() {
   base::debug::ScopedLockAcquireActivity lock_activity(this);
+  ScopedLockContentionSample contention_sample(
+      __builtin_extract_return_addr(__builtin_return_address(0)));
   int rv = pthread_mutex_lock(&native_handle_);
   DCHECK_EQ(rv, 0) << ". " << SystemErrorCodeToString(rv);
 }
@@ -5,7 +5,9 @@
 #include "base/synchronization/lock_impl.h"
 
 #include "base/debug/activity_tracker.h"
+#include "base/synchronization/lock_contention_profiler.h"
 
+#include <intrin.h>
 #include <windows.h>
 
 namespace base {
@@ -17,6 +19,7 @@ LockImpl::~LockImpl() = default;
 
 void LockImpl::LockInternalWithTracking() {
   base::debug::ScopedLockAcquireActivity lock_activity(this);
+  ScopedLockContentionSample contention_sample(_ReturnAddress());
   ::AcquireSRWLockExclusive(reinterpret_cast<PSRWLOCK>(&native_handle_));
 }
 
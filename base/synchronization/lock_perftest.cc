@@ -2,8 +2,13 @@
 // Use of this source code is governed by a BSD-style license that can be
 // found in the LICENSE file.
 
+#include <memory>
+#include <string>
+#include <vector>
+
 #include "base/compiler_specific.h"
 #include "base/memory/raw_ptr.h"
+#include "base/strings/string_number_conversions.h"
 #include "base/synchronization/lock.h"
 #include "base/threading/platform_thread.h"
 #include "base/time/time.h"
@@ -102,4 +107,43 @@ TEST(LockPerfTest, WithCompetingThread) {
   auto reporter = SetUpReporter(kStoryWithCompetingThread);
   reporter.AddResult(kMetricLockUnlockThroughput, timer.LapsPerSecond());
 }
+
+// Measures the throughput of this thread as the number of threads contending
+// for the lock grows, which shows how the lock behaves under heavy contention
+// (e.g. whether waiters spin or sleep).
+TEST(LockPerfTest, WithContendingThreads) {
+  for (int num_threads : {2, 4, 8, 16, 32, 64}) {
+    LapTimer timer(kWarmupRuns, kTimeLimit, kTimeCheckInterval);
+    uint32_t data = 0;
+
+    Lock lock;
+
+    // Starts |num_threads| - 1 competing threads executing the same loop as
+    // this thread.
+    std::vector<std::unique_ptr<Spin>> spins;
+    std::vector<PlatformThreadHandle> thread_handles(num_threads - 1);
+    for (auto& thread_handle : thread_handles) {
+      spins.push_back(std::make_unique<Spin>(&lock, &data));
+      ASSERT_TRUE(
+          PlatformThread::Create(0, spins.back().get(), &thread_handle));
+    }
+
+    do {
+      lock.Acquire();
+      data += 1;
+      lock.Release();
+      timer.NextLap();
+    } while (!timer.HasTimeLimitExpired());
+
+    for (auto& spin : spins)
+      spin->Stop();
+    for (auto& thread_handle : thread_handles)
+      PlatformThread::Join(thread_handle);
+
+    auto reporter = SetUpReporter("with_" + NumberToString(num_threads) +
+                                  "_contending_threads");
+    reporter.AddResult(kMetricLockUnlockThroughput, timer.LapsPerSecond());
+  }
+}
+
 }  // namespace base
@@ -0,0 +1,111 @@
+// Copyright 2022 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#ifndef BASE_SYNCHRONIZATION_SEQ_LOCK_H_
+#define BASE_SYNCHRONIZATION_SEQ_LOCK_H_
+
+#include <stddef.h>
+#include <stdint.h>
+#include <string.h>
+
+#include <atomic>
+#include <type_traits>
+
+#include "base/synchronization/lock.h"
+#include "base/thread_annotations.h"
+#include "base/threading/platform_thread.h"
+
+namespace base {
+
+// A SeqLock holds a small trivially copyable value (e.g. a snapshot of a few
+// counters or of a configuration) which many threads read and few write.
+// Readers don't write to shared memory at all: they copy the value and retry
+// if a writer modified it meanwhile, as detected by a sequence number which
+// writers make odd while they write. Readers therefore never slow each other
+// down, but they spin while a writer writes, and a continuous stream of
+// writes starves them. Writers are serialized by a Lock.
+//
+// Prefer SharedLock for values which are large or expensive to copy, since
+// a reader may copy the value several times.
+//
+//   SeqLock<Config> config_;
+//
+//   // On any thread.
+//   Config config = config_.Read();
+//   config_.Write(new_config);
+template <typename T>
+class SeqLock {
+ public:
+  static_assert(std::is_trivially_copyable<T>::value,
+                "SeqLock copies its value byte by byte");
+
+  SeqLock() : SeqLock(T()) {}
+  explicit SeqLock(const T& value) { StoreWords(value); }
+  SeqLock(const SeqLock&) = delete;
+  SeqLock& operator=(const SeqLock&) = delete;
+  ~SeqLock() = default;
+
+  // Returns a consistent copy of the value. Can be called on any thread.
+  T Read() const {
+    for (;;) {
+      const uint32_t sequence = sequence_.load(std::memory_order_acquire);
+      if (sequence & 1) {
+        // A writer is writing.
+        PlatformThread::YieldCurrentThread();
+        continue;
+      }
+      T value = LoadWords();
+      // Orders the loads of the words above before the load of the sequence
+      // number below.
+      std::atomic_thread_fence(std::memory_order_acquire);
+      if (sequence_.load(std::memory_order_relaxed) == sequence)
+        return value;
+    }
+  }
+
+  // Replaces the value. Can be called on any thread.
+  void Write(const T& value) LOCKS_EXCLUDED(write_lock_) {
+    AutoLock auto_lock(write_lock_);
+    const uint32_t sequence = sequence_.load(std::memory_order_relaxed);
+    sequence_.store(sequence + 1, std::memory_order_relaxed);
+    // Orders the store of the odd sequence number above before the stores of
+    // the words below.
+    std::atomic_thread_fence(std::memory_order_release);
+    StoreWords(value);
+    sequence_.store(sequence + 2, std::memory_order_release);
+  }
+
+ private:
+  // The value is stored as relaxed atomic words, so that a reader racing with
+  // a writer copies garbage (which it then discards) rather than causing
+  // undefined behavior.
+  using Word = uintptr_t;
+  static constexpr size_t kNumWords =
+      (sizeof(T) + sizeof(Word) - 1) / sizeof(Word);
+
+  T LoadWords() const {
+    Word words[kNumWords];
+    for (size_t i = 0; i < kNumWords; ++i)
+      words[i] = words_[i].load(std::memory_order_relaxed);
+    T value;
+    memcpy(&value, words, sizeof(T));
+    return value;
+  }
+
+  void StoreWords(const T& value) {
+    Word words[kNumWords] = {};
+    memcpy(words, &value, sizeof(T));
+    for (size_t i = 0; i < kNumWords; ++i)
+      words_[i].store(words[i], std::memory_order_relaxed);
+  }
+
+  // Odd while a writer writes.
+  std::atomic<uint32_t> sequence_{0};
+  std::atomic<Word> words_[kNumWords];
+  Lock write_lock_;
+};
+
+}  // namespace base
+
+#endif  // BASE_SYNCHRONIZATION_SEQ_LOCK_H_
@@ -0,0 +1,115 @@
+// Copyright 2022 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include <atomic>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "base/memory/raw_ptr.h"
+#include "base/strings/string_number_conversions.h"
+#include "base/synchronization/lock.h"
+#include "base/synchronization/seq_lock.h"
+#include "base/threading/platform_thread.h"
+#include "base/time/time.h"
+#include "base/timer/lap_timer.h"
+#include "testing/gtest/include/gtest/gtest.h"
+#include "testing/perf/perf_result_reporter.h"
+
+namespace base {
+namespace {
+
+constexpr int kWarmupRuns = 1;
+constexpr TimeDelta kTimeLimit = Seconds(1);
+constexpr int kTimeCheckInterval = 100000;
+
+constexpr char kMetricPrefixSeqLock[] = "SeqLock.";
+constexpr char kMetricReadThroughput[] = "read_throughput";
+
+perf_test::PerfResultReporter SetUpReporter(const std::string& story_name) {
+  perf_test::PerfResultReporter reporter(kMetricPrefixSeqLock, story_name);
+  reporter.RegisterImportantMetric(kMetricReadThroughput, "runs/s");
+  return reporter;
+}
+
+// A snapshot of a few counters.
+struct Snapshot {
+  uint64_t values[4];
+};
+
+// Holds a Snapshot guarded by a Lock, for comparison.
+class LockedSnapshot {
+ public:
+  Snapshot Read() const {
+    AutoLock auto_lock(lock_);
+    return snapshot_;
+  }
+
+ private:
+  mutable Lock lock_;
+  Snapshot snapshot_ GUARDED_BY(lock_) = {};
+};
+
+template <typename Holder>
+class ReadLoop : public PlatformThread::Delegate {
+ public:
+  explicit ReadLoop(const Holder* holder) : holder_(holder) {}
+  ~ReadLoop() override = default;
+
+  void ThreadMain() override {
+    while (!should_stop_.load(std::memory_order_relaxed))
+      [[maybe_unused]] volatile uint64_t value = holder_->Read().values[0];
+  }
+
+  // Called from another thread to stop the loop.
+  void Stop() { should_stop_ = true; }
+
+ private:
+  raw_ptr<const Holder> holder_;
+  std::atomic<bool> should_stop_{false};
+};
+
+// Measures the read throughput of this thread while |num_threads| - 1 other
+// threads read the same snapshot.
+template <typename Holder>
+void RunReadersTest(const std::string& holder_name) {
+  for (int num_threads : {1, 2, 4, 8}) {
+    LapTimer timer(kWarmupRuns, kTimeLimit, kTimeCheckInterval);
+    Holder holder;
+
+    std::vector<std::unique_ptr<ReadLoop<Holder>>> loops;
+    std::vector<PlatformThreadHandle> thread_handles(num_threads - 1);
+    for (auto& thread_handle : thread_handles) {
+      loops.push_back(std::make_unique<ReadLoop<Holder>>(&holder));
+      ASSERT_TRUE(
+          PlatformThread::Create(0, loops.back().get(), &thread_handle));
+    }
+
+    do {
+      [[maybe_unused]] volatile uint64_t value = holder.Read().values[0];
+      timer.NextLap();
+    } while (!timer.HasTimeLimitExpired());
+
+    for (auto& loop : loops)
+      loop->Stop();
+    for (auto& thread_handle : thread_handles)
+      PlatformThread::Join(thread_handle);
+
+    auto reporter = SetUpReporter(holder_name + "_with_" +
+                                  NumberToString(num_threads) + "_readers");
+    reporter.AddResult(kMetricReadThroughput, timer.LapsPerSecond());
+  }
+}
+
+}  // namespace
+
+TEST(SeqLockPerfTest, LockReaders) {
+  RunReadersTest<LockedSnapshot>("lock");
+}
+
+TEST(SeqLockPerfTest, SeqLockReaders) {
+  RunReadersTest<SeqLock<Snapshot>>("seq_lock");
+}
+
+}  // namespace base
@@ -0,0 +1,80 @@
+// Copyright 2022 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "base/synchronization/seq_lock.h"
+
+#include <atomic>
+
+#include "base/memory/raw_ptr.h"
+#include "base/threading/simple_thread.h"
+#include "testing/gtest/include/gtest/gtest.h"
+
+namespace base {
+
+namespace {
+
+// Not a multiple of the word size, to exercise the tail of the copies.
+struct Snapshot {
+  int64_t a;
+  int64_t b;
+  int32_t c;
+  char d;
+};
+
+// Reads |seq_lock| until |stop| is set, checking that each value is one of
+// the consistent values which the writer writes.
+class Reader : public DelegateSimpleThread::Delegate {
+ public:
+  Reader(const SeqLock<Snapshot>* seq_lock, const std::atomic<bool>* stop)
+      : seq_lock_(seq_lock), stop_(stop) {}
+
+  void Run() override {
+    while (!stop_->load(std::memory_order_relaxed)) {
+      Snapshot snapshot = seq_lock_->Read();
+      EXPECT_EQ(snapshot.a, -snapshot.b);
+      EXPECT_EQ(static_cast<int32_t>(snapshot.a), snapshot.c);
+      EXPECT_EQ(static_cast<char>(snapshot.a), snapshot.d);
+    }
+  }
+
+ private:
+  const raw_ptr<const SeqLock<Snapshot>> seq_lock_;
+  const raw_ptr<const std::atomic<bool>> stop_;
+};
+
+}  // namespace
+
+TEST(SeqLockTest, ReadWrite) {
+  SeqLock<int> default_constructed;
+  EXPECT_EQ(0, default_constructed.Read());
+
+  SeqLock<Snapshot> seq_lock(Snapshot{1, -1, 1, 1});
+  EXPECT_EQ(1, seq_lock.Read().a);
+  seq_lock.Write(Snapshot{2, -2, 2, 2});
+  Snapshot snapshot = seq_lock.Read();
+  EXPECT_EQ(2, snapshot.a);
+  EXPECT_EQ(-2, snapshot.b);
+  EXPECT_EQ(2, snapshot.c);
+  EXPECT_EQ(2, snapshot.d);
+}
+
+// Readers never see a value which is partially written.
+TEST(SeqLockTest, ConsistentReadsDuringWrites) {
+  constexpr int kNumReaders = 4;
+  SeqLock<Snapshot> seq_lock(Snapshot{0, 0, 0, 0});
+  std::atomic<bool> stop{false};
+  Reader reader(&seq_lock, &stop);
+  DelegateSimpleThreadPool pool("Reader", kNumReaders);
+  pool.AddWork(&reader, kNumReaders);
+  pool.Start();
+
+  for (int64_t i = 1; i < 100000; ++i) {
+    seq_lock.Write(Snapshot{i, -i, static_cast<int32_t>(i),
+                            static_cast<char>(i)});
+  }
+  stop.store(true, std::memory_order_relaxed);
+  pool.JoinAll();
+}
+
+}  // namespace base
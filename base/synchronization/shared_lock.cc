@@ -0,0 +1,37 @@
+// Copyright 2022 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+// This file is used for debugging assertion support, like lock.cc.
+
+#include "base/synchronization/shared_lock.h"
+
+#if DCHECK_IS_ON()
+
+#include "base/threading/platform_thread.h"
+
+namespace base {
+
+void SharedLock::AssertAcquired() const {
+  DCHECK_EQ(owning_thread_ref_, PlatformThread::CurrentRef());
+}
+
+void SharedLock::AssertAcquiredShared() const {
+  DCHECK(num_shared_owners_.load(std::memory_order_relaxed) > 0 ||
+         owning_thread_ref_ == PlatformThread::CurrentRef());
+}
+
+void SharedLock::CheckHeldAndUnmark() {
+  DCHECK_EQ(owning_thread_ref_, PlatformThread::CurrentRef());
+  owning_thread_ref_ = PlatformThreadRef();
+}
+
+void SharedLock::CheckUnheldAndMark() {
+  DCHECK(owning_thread_ref_.is_null());
+  DCHECK_EQ(num_shared_owners_.load(std::memory_order_relaxed), 0);
+  owning_thread_ref_ = PlatformThread::CurrentRef();
+}
+
+}  // namespace base
+
+#endif  // DCHECK_IS_ON()
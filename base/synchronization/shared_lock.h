@@ -0,0 +1,168 @@
+// Copyright 2022 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#ifndef BASE_SYNCHRONIZATION_SHARED_LOCK_H_
+#define BASE_SYNCHRONIZATION_SHARED_LOCK_H_
+
+#include "base/base_export.h"
+#include "base/check_op.h"
+#include "base/dcheck_is_on.h"
+#include "base/synchronization/lock_impl.h"
+#include "base/thread_annotations.h"
+#include "build/build_config.h"
+
+#if BUILDFLAG(IS_WIN)
+#include "base/win/windows_types.h"
+#elif BUILDFLAG(IS_POSIX) || BUILDFLAG(IS_FUCHSIA)
+#include <pthread.h>
+#endif
+
+#if DCHECK_IS_ON()
+#include <atomic>
+
+#include "base/threading/platform_thread_ref.h"
+#endif
+
+namespace base {
+
+// A reader-writer lock: any number of threads can hold it in shared mode, or a
+// single thread in exclusive mode. Use it for data which is read much more
+// often than it is written, and whose readers hold the lock long enough for
+// their contention on a Lock to matter, e.g. a routing table. Otherwise, Lock
+// is cheaper: acquiring a SharedLock in shared mode still writes to the lock,
+// which makes readers on different cores contend for its cache line. For small
+// trivially copyable data, also consider SeqLock.
+//
+// Like Lock, SharedLock isn't recursive, in either mode: a thread which holds
+// the lock in shared mode may deadlock if it acquires it again, since writers
+// take precedence over new readers to avoid starving them.
+//
+//   SharedLock lock_;
+//   Table table_ GUARDED_BY(lock_);
+//
+//   Route Lookup(Key key) const {
+//     AutoSharedLock auto_lock(lock_);
+//     return table_.Lookup(key);
+//   }
+//
+//   void Update(Key key, Route route) {
+//     AutoExclusiveLock auto_lock(lock_);
+//     table_.Update(key, route);
+//   }
+class LOCKABLE BASE_EXPORT SharedLock {
+ public:
+  SharedLock();
+  SharedLock(const SharedLock&) = delete;
+  SharedLock& operator=(const SharedLock&) = delete;
+  ~SharedLock();
+
+  // Exclusive mode.
+  void Acquire() EXCLUSIVE_LOCK_FUNCTION() {
+    AcquireImpl();
+#if DCHECK_IS_ON()
+    CheckUnheldAndMark();
+#endif
+  }
+  void Release() UNLOCK_FUNCTION() {
+#if DCHECK_IS_ON()
+    CheckHeldAndUnmark();
+#endif
+    ReleaseImpl();
+  }
+  // If the lock isn't held in either mode, takes it in exclusive mode and
+  // returns true. Otherwise, immediately returns false.
+  bool Try() EXCLUSIVE_TRYLOCK_FUNCTION(true) {
+    bool rv = TryImpl();
+#if DCHECK_IS_ON()
+    if (rv)
+      CheckUnheldAndMark();
+#endif
+    return rv;
+  }
+
+  // Shared mode.
+  void AcquireShared() SHARED_LOCK_FUNCTION() {
+    AcquireSharedImpl();
+#if DCHECK_IS_ON()
+    num_shared_owners_.fetch_add(1, std::memory_order_relaxed);
+#endif
+  }
+  void ReleaseShared() UNLOCK_FUNCTION() {
+#if DCHECK_IS_ON()
+    DCHECK_GT(num_shared_owners_.fetch_sub(1, std::memory_order_relaxed), 0);
+#endif
+    ReleaseSharedImpl();
+  }
+  // If the lock isn't held in exclusive mode, takes it in shared mode and
+  // returns true. Otherwise, immediately returns false.
+  bool TryShared() SHARED_TRYLOCK_FUNCTION(true) {
+    bool rv = TrySharedImpl();
+#if DCHECK_IS_ON()
+    if (rv)
+      num_shared_owners_.fetch_add(1, std::memory_order_relaxed);
+#endif
+    return rv;
+  }
+
+#if DCHECK_IS_ON()
+  // Checks that the current thread holds the lock in exclusive mode.
+  void AssertAcquired() const ASSERT_EXCLUSIVE_LOCK();
+  // Checks that the lock is held in shared mode, or by the current thread in
+  // exclusive mode. Which threads hold it in shared mode isn't tracked.
+  void AssertAcquiredShared() const ASSERT_SHARED_LOCK();
+#else
+  void AssertAcquired() const ASSERT_EXCLUSIVE_LOCK() {}
+  void AssertAcquiredShared() const ASSERT_SHARED_LOCK() {}
+#endif  // DCHECK_IS_ON()
+
+ private:
+#if BUILDFLAG(IS_WIN)
+  using NativeHandle = CHROME_SRWLOCK;
+#elif BUILDFLAG(IS_POSIX) || BUILDFLAG(IS_FUCHSIA)
+  using NativeHandle = pthread_rwlock_t;
+#endif
+
+  // Platform-specific, in shared_lock_{posix,win}.cc.
+  void AcquireImpl();
+  void ReleaseImpl();
+  bool TryImpl();
+  void AcquireSharedImpl();
+  void ReleaseSharedImpl();
+  bool TrySharedImpl();
+
+#if DCHECK_IS_ON()
+  void CheckHeldAndUnmark();
+  void CheckUnheldAndMark();
+
+  // Protected by the lock in exclusive mode, like Lock::owning_thread_ref_.
+  PlatformThreadRef owning_thread_ref_;
+  std::atomic<int> num_shared_owners_{0};
+#endif  // DCHECK_IS_ON()
+
+  NativeHandle native_handle_;
+};
+
+// A helper class that acquires the given SharedLock in exclusive mode while
+// the AutoExclusiveLock is in scope.
+using AutoExclusiveLock = internal::BasicAutoLock<SharedLock>;
+
+// A helper class that acquires the given SharedLock in shared mode while the
+// AutoSharedLock is in scope.
+class SCOPED_LOCKABLE AutoSharedLock {
+ public:
+  explicit AutoSharedLock(SharedLock& lock) SHARED_LOCK_FUNCTION(lock)
+      : lock_(lock) {
+    lock_.AcquireShared();
+  }
+  AutoSharedLock(const AutoSharedLock&) = delete;
+  AutoSharedLock& operator=(const AutoSharedLock&) = delete;
+  ~AutoSharedLock() UNLOCK_FUNCTION() { lock_.ReleaseShared(); }
+
+ private:
+  SharedLock& lock_;
+};
+
+}  // namespace base
+
+#endif  // BASE_SYNCHRONIZATION_SHARED_LOCK_H_
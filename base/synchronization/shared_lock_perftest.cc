@@ -0,0 +1,115 @@
+// Copyright 2022 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include <atomic>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "base/memory/raw_ptr.h"
+#include "base/strings/string_number_conversions.h"
+#include "base/synchronization/lock.h"
+#include "base/synchronization/shared_lock.h"
+#include "base/threading/platform_thread.h"
+#include "base/time/time.h"
+#include "base/timer/lap_timer.h"
+#include "testing/gtest/include/gtest/gtest.h"
+#include "testing/perf/perf_result_reporter.h"
+
+namespace base {
+namespace {
+
+constexpr int kWarmupRuns = 1;
+constexpr TimeDelta kTimeLimit = Seconds(1);
+constexpr int kTimeCheckInterval = 100000;
+
+constexpr char kMetricPrefixSharedLock[] = "SharedLock.";
+constexpr char kMetricReadThroughput[] = "read_throughput";
+
+perf_test::PerfResultReporter SetUpReporter(const std::string& story_name) {
+  perf_test::PerfResultReporter reporter(kMetricPrefixSharedLock, story_name);
+  reporter.RegisterImportantMetric(kMetricReadThroughput, "runs/s");
+  return reporter;
+}
+
+// Reads the data guarded by a Lock or by a SharedLock in shared mode.
+struct LockReader {
+  static void Read(Lock& lock, const uint32_t& data) {
+    AutoLock auto_lock(lock);
+    [[maybe_unused]] volatile uint32_t value = data;
+  }
+};
+
+struct SharedLockReader {
+  static void Read(SharedLock& lock, const uint32_t& data) {
+    AutoSharedLock auto_lock(lock);
+    [[maybe_unused]] volatile uint32_t value = data;
+  }
+};
+
+template <typename LockType, typename Reader>
+class ReadLoop : public PlatformThread::Delegate {
+ public:
+  ReadLoop(LockType* lock, const uint32_t* data) : lock_(lock), data_(data) {}
+  ~ReadLoop() override = default;
+
+  void ThreadMain() override {
+    while (!should_stop_.load(std::memory_order_relaxed))
+      Reader::Read(*lock_, *data_);
+  }
+
+  // Called from another thread to stop the loop.
+  void Stop() { should_stop_ = true; }
+
+ private:
+  raw_ptr<LockType> lock_;
+  raw_ptr<const uint32_t> data_;
+  std::atomic<bool> should_stop_{false};
+};
+
+// Measures the read throughput of this thread while |num_threads| - 1 other
+// threads read the same data.
+template <typename LockType, typename Reader>
+void RunReadersTest(const std::string& lock_name) {
+  for (int num_threads : {1, 2, 4, 8}) {
+    LapTimer timer(kWarmupRuns, kTimeLimit, kTimeCheckInterval);
+    LockType lock;
+    uint32_t data = 0;
+
+    std::vector<std::unique_ptr<ReadLoop<LockType, Reader>>> loops;
+    std::vector<PlatformThreadHandle> thread_handles(num_threads - 1);
+    for (auto& thread_handle : thread_handles) {
+      loops.push_back(
+          std::make_unique<ReadLoop<LockType, Reader>>(&lock, &data));
+      ASSERT_TRUE(
+          PlatformThread::Create(0, loops.back().get(), &thread_handle));
+    }
+
+    do {
+      Reader::Read(lock, data);
+      timer.NextLap();
+    } while (!timer.HasTimeLimitExpired());
+
+    for (auto& loop : loops)
+      loop->Stop();
+    for (auto& thread_handle : thread_handles)
+      PlatformThread::Join(thread_handle);
+
+    auto reporter = SetUpReporter(lock_name + "_with_" +
+                                  NumberToString(num_threads) + "_readers");
+    reporter.AddResult(kMetricReadThroughput, timer.LapsPerSecond());
+  }
+}
+
+}  // namespace
+
+TEST(SharedLockPerfTest, LockReaders) {
+  RunReadersTest<Lock, LockReader>("lock");
+}
+
+TEST(SharedLockPerfTest, SharedLockReaders) {
+  RunReadersTest<SharedLock, SharedLockReader>("shared_lock");
+}
+
+}  // namespace base
@@ -0,0 +1,74 @@
+// Copyright 2022 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "base/synchronization/shared_lock.h"
+
+#include <errno.h>
+#include <string.h>
+
+#include "base/check_op.h"
+#include "build/build_config.h"
+
+namespace base {
+
+SharedLock::SharedLock() {
+  pthread_rwlockattr_t attributes;
+  int rv = pthread_rwlockattr_init(&attributes);
+  DCHECK_EQ(rv, 0) << ". " << strerror(rv);
+#if defined(__GLIBC__)
+  // By default, glibc lets new readers in while a writer waits, which can
+  // starve writers of a lock which is read continuously.
+  rv = pthread_rwlockattr_setkind_np(
+      &attributes, PTHREAD_RWLOCK_PREFER_WRITER_NONRECURSIVE_NP);
+  DCHECK_EQ(rv, 0) << ". " << strerror(rv);
+#endif
+  rv = pthread_rwlock_init(&native_handle_, &attributes);
+  DCHECK_EQ(rv, 0) << ". " << strerror(rv);
+  rv = pthread_rwlockattr_destroy(&attributes);
+  DCHECK_EQ(rv, 0) << ". " << strerror(rv);
+}
+
+SharedLock::~SharedLock() {
+#if DCHECK_IS_ON()
+  DCHECK(owning_thread_ref_.is_null());
+  DCHECK_EQ(num_shared_owners_.load(std::memory_order_relaxed), 0);
+#endif
+  int rv = pthread_rwlock_destroy(&native_handle_);
+  DCHECK_EQ(rv, 0) << ". " << strerror(rv);
+}
+
+void SharedLock::AcquireImpl() {
+  int rv = pthread_rwlock_wrlock(&native_handle_);
+  DCHECK_EQ(rv, 0) << ". " << strerror(rv);
+}
+
+void SharedLock::ReleaseImpl() {
+  int rv = pthread_rwlock_unlock(&native_handle_);
+  DCHECK_EQ(rv, 0) << ". " << strerror(rv);
+}
+
+bool SharedLock::TryImpl() {
+  int rv = pthread_rwlock_trywrlock(&native_handle_);
+  DCHECK(rv == 0 || rv == EBUSY) << ". " << strerror(rv);
+  return rv == 0;
+}
+
+void SharedLock::AcquireSharedImpl() {
+  int rv = pthread_rwlock_rdlock(&native_handle_);
+  DCHECK_EQ(rv, 0) << ". " << strerror(rv);
+}
+
+void SharedLock::ReleaseSharedImpl() {
+  int rv = pthread_rwlock_unlock(&native_handle_);
+  DCHECK_EQ(rv, 0) << ". " << strerror(rv);
+}
+
+bool SharedLock::TrySharedImpl() {
+  int rv = pthread_rwlock_tryrdlock(&native_handle_);
+  // EAGAIN means that the maximum number of readers was reached.
+  DCHECK(rv == 0 || rv == EBUSY || rv == EAGAIN) << ". " << strerror(rv);
+  return rv == 0;
+}
+
+}  // namespace base
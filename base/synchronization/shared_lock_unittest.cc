@@ -0,0 +1,139 @@
+// Copyright 2022 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "base/synchronization/shared_lock.h"
+
+#include <atomic>
+#include <memory>
+
+#include "base/memory/raw_ptr.h"
+#include "base/synchronization/waitable_event.h"
+#include "base/test/gtest_util.h"
+#include "base/threading/platform_thread.h"
+#include "base/threading/simple_thread.h"
+#include "testing/gtest/include/gtest/gtest.h"
+
+namespace base {
+
+namespace {
+
+// Holds |lock| in shared mode until |release| is signaled.
+class SharedHolder : public DelegateSimpleThread::Delegate {
+ public:
+  SharedHolder(SharedLock* lock,
+               WaitableEvent* acquired,
+               WaitableEvent* release)
+      : lock_(lock), acquired_(acquired), release_(release) {}
+
+  void Run() override {
+    AutoSharedLock auto_lock(*lock_);
+    acquired_->Signal();
+    release_->Wait();
+  }
+
+ private:
+  const raw_ptr<SharedLock> lock_;
+  const raw_ptr<WaitableEvent> acquired_;
+  const raw_ptr<WaitableEvent> release_;
+};
+
+// Increments a counter under the lock in exclusive mode, checking that no
+// other thread is writing at the same time.
+class Writer : public DelegateSimpleThread::Delegate {
+ public:
+  Writer(SharedLock* lock, int* counter, std::atomic<int>* num_writers)
+      : lock_(lock), counter_(counter), num_writers_(num_writers) {}
+
+  void Run() override {
+    for (int i = 0; i < 1000; ++i) {
+      AutoExclusiveLock auto_lock(*lock_);
+      EXPECT_EQ(0, num_writers_->fetch_add(1));
+      ++*counter_;
+      EXPECT_EQ(1, num_writers_->fetch_sub(1));
+    }
+  }
+
+ private:
+  const raw_ptr<SharedLock> lock_;
+  const raw_ptr<int> counter_;
+  const raw_ptr<std::atomic<int>> num_writers_;
+};
+
+}  // namespace
+
+TEST(SharedLockTest, Basic) {
+  SharedLock lock;
+  lock.Acquire();
+  lock.AssertAcquired();
+  lock.AssertAcquiredShared();
+  EXPECT_FALSE(lock.TryShared());
+  lock.Release();
+
+  lock.AcquireShared();
+  lock.AssertAcquiredShared();
+  EXPECT_FALSE(lock.Try());
+  lock.ReleaseShared();
+
+  ASSERT_TRUE(lock.Try());
+  lock.Release();
+  ASSERT_TRUE(lock.TryShared());
+  lock.ReleaseShared();
+}
+
+// Several threads can hold the lock in shared mode at once, which excludes
+// writers.
+TEST(SharedLockTest, ConcurrentReaders) {
+  constexpr int kNumReaders = 4;
+  SharedLock lock;
+  WaitableEvent acquired[kNumReaders];
+  WaitableEvent release;
+  std::unique_ptr<SharedHolder> holders[kNumReaders];
+  std::unique_ptr<DelegateSimpleThread> threads[kNumReaders];
+  for (int i = 0; i < kNumReaders; ++i) {
+    holders[i] = std::make_unique<SharedHolder>(&lock, &acquired[i], &release);
+    threads[i] =
+        std::make_unique<DelegateSimpleThread>(holders[i].get(), "Reader");
+    threads[i]->Start();
+  }
+  // All readers hold the lock at the same time.
+  for (auto& event : acquired)
+    event.Wait();
+  EXPECT_FALSE(lock.Try());
+  EXPECT_TRUE(lock.TryShared());
+  lock.ReleaseShared();
+
+  release.Signal();
+  for (auto& thread : threads)
+    thread->Join();
+  EXPECT_TRUE(lock.Try());
+  lock.Release();
+}
+
+TEST(SharedLockTest, WritersAreExclusive) {
+  constexpr int kNumWriters = 4;
+  SharedLock lock;
+  int counter = 0;
+  std::atomic<int> num_writers{0};
+  Writer writer(&lock, &counter, &num_writers);
+  DelegateSimpleThreadPool pool("Writer", kNumWriters);
+  pool.AddWork(&writer, kNumWriters);
+  pool.Start();
+  pool.JoinAll();
+
+  AutoSharedLock auto_lock(lock);
+  EXPECT_EQ(kNumWriters * 1000, counter);
+}
+
+#if DCHECK_IS_ON()
+TEST(SharedLockTest, AssertAcquiredFailsWhenNotHeld) {
+  SharedLock lock;
+  EXPECT_DCHECK_DEATH(lock.AssertAcquired());
+  EXPECT_DCHECK_DEATH(lock.AssertAcquiredShared());
+  lock.AcquireShared();
+  EXPECT_DCHECK_DEATH(lock.AssertAcquired());
+  lock.ReleaseShared();
+}
+#endif  // DCHECK_IS_ON()
+
+}  // namespace base
@@ -0,0 +1,52 @@
+// Copyright 2022 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "base/synchronization/shared_lock.h"
+
+#include <windows.h>
+
+namespace base {
+
+namespace {
+
+PSRWLOCK AsSRWLock(CHROME_SRWLOCK* lock) {
+  return reinterpret_cast<PSRWLOCK>(lock);
+}
+
+}  // namespace
+
+SharedLock::SharedLock() : native_handle_(SRWLOCK_INIT) {}
+
+SharedLock::~SharedLock() {
+#if DCHECK_IS_ON()
+  DCHECK(owning_thread_ref_.is_null());
+  DCHECK_EQ(num_shared_owners_.load(std::memory_order_relaxed), 0);
+#endif
+}
+
+void SharedLock::AcquireImpl() {
+  ::AcquireSRWLockExclusive(AsSRWLock(&native_handle_));
+}
+
+void SharedLock::ReleaseImpl() {
+  ::ReleaseSRWLockExclusive(AsSRWLock(&native_handle_));
+}
+
+bool SharedLock::TryImpl() {
+  return !!::TryAcquireSRWLockExclusive(AsSRWLock(&native_handle_));
+}
+
+void SharedLock::AcquireSharedImpl() {
+  ::AcquireSRWLockShared(AsSRWLock(&native_handle_));
+}
+
+void SharedLock::ReleaseSharedImpl() {
+  ::ReleaseSRWLockShared(AsSRWLock(&native_handle_));
+}
+
+bool SharedLock::TrySharedImpl() {
+  return !!::TryAcquireSRWLockShared(AsSRWLock(&native_handle_));
+}
+
+}  // namespace base
@@ -26,6 +26,7 @@
 #elif BUILDFLAG(IS_POSIX) || BUILDFLAG(IS_FUCHSIA)
 #include <list>
 #include <utility>
+#include <vector>
 
 #include "base/memory/ref_counted.h"
 #include "base/synchronization/lock.h"
@@ -34,6 +35,7 @@
 namespace base {
 
 class TimeDelta;
+class WaitableEventSet;
 
 // A WaitableEvent can be a useful thread synchronization tool when you want to
 // allow one thread to wait for another thread to finish some work. For
@@ -168,6 +170,7 @@ class BASE_EXPORT WaitableEvent {
 
  private:
   friend class WaitableEventWatcher;
+  friend class WaitableEventSet;
 
 #if BUILDFLAG(IS_WIN)
   win::ScopedHandle handle_;
@@ -261,6 +264,8 @@ class BASE_EXPORT WaitableEvent {
     const bool manual_reset_;
     bool signaled_;
     std::list<Waiter*> waiters_;
+    // The WaitableEventSets which the event belongs to, and its index in each.
+    std::vector<std::pair<WaitableEventSet*, size_t>> sets_;
 
    private:
     friend class RefCountedThreadSafe<WaitableEventKernel>;
@@ -279,6 +284,9 @@ class BASE_EXPORT WaitableEvent {
 
   bool SignalAll();
   bool SignalOne();
+  // Notifies the WaitableEventSets which the event belongs to that it is
+  // signaled. Called with the kernel's lock held.
+  void NotifySets();
   void Enqueue(Waiter* waiter);
 
   scoped_refptr<WaitableEventKernel> kernel_;
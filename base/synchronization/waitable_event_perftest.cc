@@ -5,8 +5,12 @@
 #include "base/memory/raw_ptr.h"
 #include "base/synchronization/waitable_event.h"
 
+#include <memory>
 #include <string>
+#include <vector>
 
+#include "base/strings/string_number_conversions.h"
+#include "base/synchronization/waitable_event_set.h"
 #include "base/threading/simple_thread.h"
 #include "base/time/time.h"
 #include "base/timer/elapsed_timer.h"
@@ -21,6 +25,7 @@ constexpr char kMetricPrefixWaitableEvent[] = "WaitableEvent.";
 constexpr char kMetricWaitTime[] = "wait_time_per_sample";
 constexpr char kMetricSignalTime[] = "signal_time_per_sample";
 constexpr char kMetricElapsedCycles[] = "elapsed_cycles";
+constexpr char kMetricWaitManyTime[] = "wait_many_time_per_sample";
 constexpr char kStorySingleThread[] = "single_thread_1000_samples";
 constexpr char kStoryMultiThreadWaiter[] = "multi_thread_1000_samples_waiter";
 constexpr char kStoryMultiThreadSignaler[] =
@@ -33,9 +38,32 @@ perf_test::PerfResultReporter SetUpReporter(const std::string& story_name) {
   reporter.RegisterImportantMetric(kMetricWaitTime, "ns");
   reporter.RegisterImportantMetric(kMetricSignalTime, "ns");
   reporter.RegisterImportantMetric(kMetricElapsedCycles, "count");
+  reporter.RegisterImportantMetric(kMetricWaitManyTime, "ns");
   return reporter;
 }
 
+// Returns the average time to signal an event among |num_events| and to wait
+// for it with |wait_many|, which is passed the events.
+template <typename WaitManyFunction>
+TimeDelta TimeWaitMany(size_t num_events, WaitManyFunction wait_many) {
+  constexpr size_t kSamples = 1000;
+  std::vector<std::unique_ptr<WaitableEvent>> events;
+  std::vector<WaitableEvent*> raw_events;
+  for (size_t i = 0; i < num_events; ++i) {
+    events.push_back(std::make_unique<WaitableEvent>(
+        WaitableEvent::ResetPolicy::AUTOMATIC));
+    raw_events.push_back(events.back().get());
+  }
+
+  ElapsedTimer timer;
+  wait_many(raw_events, [&](size_t sample) {
+    const size_t index = (sample * 7) % num_events;
+    events[index]->Signal();
+    return index;
+  }, kSamples);
+  return timer.Elapsed() / kSamples;
+}
+
 class TraceWaitableEvent {
  public:
   TraceWaitableEvent() = default;
@@ -191,4 +219,41 @@ TEST(WaitableEventPerfTest, Throughput) {
   PrintPerfWaitableEvent(&event, kStoryTimedThroughput, &count);
 }
 
+// WaitMany() locks all the events on each call, unlike WaitableEventSet.
+TEST(WaitableEventPerfTest, WaitManyScaling) {
+  for (size_t num_events : {2, 16, 128, 1024}) {
+    TimeDelta time = TimeWaitMany(
+        num_events, [](std::vector<WaitableEvent*>& events, auto signal,
+                       size_t samples) {
+          for (size_t i = 0; i < samples; ++i) {
+            const size_t index = signal(i);
+            EXPECT_EQ(index,
+                      WaitableEvent::WaitMany(events.data(), events.size()));
+          }
+        });
+    auto reporter = SetUpReporter("wait_many_" +
+                                  NumberToString(num_events) + "_events");
+    reporter.AddResult(kMetricWaitManyTime,
+                       static_cast<size_t>(time.InNanoseconds()));
+  }
+}
+
+TEST(WaitableEventPerfTest, WaitableEventSetScaling) {
+  for (size_t num_events : {2, 16, 128, 1024}) {
+    TimeDelta time = TimeWaitMany(
+        num_events, [](std::vector<WaitableEvent*>& events, auto signal,
+                       size_t samples) {
+          WaitableEventSet set(events);
+          for (size_t i = 0; i < samples; ++i) {
+            const size_t index = signal(i);
+            EXPECT_EQ(index, set.Wait());
+          }
+        });
+    auto reporter = SetUpReporter("waitable_event_set_" +
+                                  NumberToString(num_events) + "_events");
+    reporter.AddResult(kMetricWaitManyTime,
+                       static_cast<size_t>(time.InNanoseconds()));
+  }
+}
+
 }  // namespace base
@@ -14,6 +14,7 @@
 #include "base/synchronization/condition_variable.h"
 #include "base/synchronization/lock.h"
 #include "base/synchronization/waitable_event.h"
+#include "base/synchronization/waitable_event_set.h"
 #include "base/threading/scoped_blocking_call.h"
 #include "base/threading/thread_restrictions.h"
 #include "base/time/time.h"
@@ -72,6 +73,9 @@ void WaitableEvent::Signal() {
     if (!SignalOne())
       kernel_->signaled_ = true;
   }
+
+  if (kernel_->signaled_)
+    NotifySets();
 }
 
 bool WaitableEvent::IsSignaled() {
@@ -421,6 +425,15 @@ bool WaitableEvent::SignalOne() {
   }
 }
 
+// -----------------------------------------------------------------------------
+// Tell the WaitableEventSets that this event is signaled. Called with lock
+// held.
+// -----------------------------------------------------------------------------
+void WaitableEvent::NotifySets() {
+  for (const auto& set_and_index : kernel_->sets_)
+    set_and_index.first->OnEventSignaled(set_and_index.second);
+}
+
 // -----------------------------------------------------------------------------
 // Add a waiter to the list of those waiting. Called with lock held.
 // -----------------------------------------------------------------------------
@@ -0,0 +1,92 @@
+// Copyright 2022 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#ifndef BASE_SYNCHRONIZATION_WAITABLE_EVENT_SET_H_
+#define BASE_SYNCHRONIZATION_WAITABLE_EVENT_SET_H_
+
+#include <stddef.h>
+
+#include <vector>
+
+#include "base/base_export.h"
+#include "base/containers/circular_deque.h"
+#include "base/containers/span.h"
+#include "base/memory/scoped_refptr.h"
+#include "base/synchronization/condition_variable.h"
+#include "base/synchronization/lock.h"
+#include "base/synchronization/waitable_event.h"
+#include "base/thread_annotations.h"
+#include "build/build_config.h"
+#include "third_party/abseil-cpp/absl/types/optional.h"
+
+// WaitableEventSet relies on the wait-list implementation of WaitableEvent.
+#if (BUILDFLAG(IS_POSIX) && !BUILDFLAG(IS_APPLE)) || BUILDFLAG(IS_FUCHSIA)
+
+namespace base {
+
+class TimeDelta;
+
+// A set of WaitableEvents which threads wait on repeatedly. It's equivalent to
+// calling WaitableEvent::WaitMany() on the same events in a loop, but the set
+// registers with its events once, when it's created, whereas WaitMany() locks
+// and enqueues on all the events each time it's called. Waiting on a set and
+// signaling one of its events cost the same regardless of the size of the set,
+// which matters for threads which wait on many events, e.g. a barrier waiting
+// for many workers.
+//
+// Unlike WaitMany(), Wait() doesn't return the lowest index among the signaled
+// events, but the event which was signaled first. A manual-reset event which
+// stays signaled is returned again after the other signaled events.
+//
+// The events may be deleted before the set, and may belong to several sets.
+// Any number of threads may wait on the set at once.
+class BASE_EXPORT WaitableEventSet {
+ public:
+  // |events| must be distinct.
+  explicit WaitableEventSet(span<WaitableEvent* const> events);
+  WaitableEventSet(const WaitableEventSet&) = delete;
+  WaitableEventSet& operator=(const WaitableEventSet&) = delete;
+  ~WaitableEventSet();
+
+  // Waits until one of the events is signaled and returns its index in
+  // |events|. Resets it if it's an automatic-reset event. Like
+  // WaitableEvent::Wait(), the return "happens after" the Signal() which
+  // caused it.
+  size_t Wait();
+
+  // Same as Wait(), but returns nullopt if |wait_delta| elapses first.
+  absl::optional<size_t> TimedWait(TimeDelta wait_delta);
+
+  size_t size() const { return kernels_.size(); }
+
+ private:
+  friend class WaitableEvent;
+
+  // Called by the event at |index| with its kernel's lock held, when it
+  // becomes signaled.
+  void OnEventSignaled(size_t index) LOCKS_EXCLUDED(lock_);
+
+  std::vector<scoped_refptr<WaitableEvent::WaitableEventKernel>> kernels_;
+
+  Lock lock_;
+  ConditionVariable cv_;
+
+  // The indices of the events which may be signaled, in the order they were
+  // signaled. An event can have been reset or consumed since, which Wait()
+  // finds out when it checks it. |queued_| tells which events are in
+  // |ready_|, so that each appears at most once.
+  circular_deque<size_t> ready_ GUARDED_BY(lock_);
+  std::vector<bool> queued_ GUARDED_BY(lock_);
+
+  // The number of threads blocked in Wait(). Signaling an event doesn't touch
+  // |cv_| when there are none.
+  int num_waiters_ GUARDED_BY(lock_) = 0;
+};
+
+}  // namespace base
+
+#endif  // (BUILDFLAG(IS_POSIX) && !BUILDFLAG(IS_APPLE)) ||
+        // BUILDFLAG(IS_FUCHSIA)
+
+#endif  // BASE_SYNCHRONIZATION_WAITABLE_EVENT_SET_H_
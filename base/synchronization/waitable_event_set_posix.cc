@@ -0,0 +1,115 @@
+// Copyright 2022 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "base/synchronization/waitable_event_set.h"
+
+#include "base/check_op.h"
+#include "base/ranges/algorithm.h"
+#include "base/threading/scoped_blocking_call.h"
+#include "base/time/time.h"
+#include "base/time/time_override.h"
+
+namespace base {
+
+WaitableEventSet::WaitableEventSet(span<WaitableEvent* const> events)
+    : cv_(&lock_), queued_(events.size(), false) {
+  DCHECK(!events.empty()) << "Cannot wait on no events";
+  kernels_.reserve(events.size());
+  for (size_t i = 0; i < events.size(); ++i) {
+    auto& kernel = kernels_.emplace_back(events[i]->kernel_);
+    AutoLock kernel_lock(kernel->lock_);
+    DCHECK(ranges::find(kernel->sets_, this,
+                        &std::pair<WaitableEventSet*, size_t>::first) ==
+           kernel->sets_.end())
+        << "The events of a WaitableEventSet must be distinct";
+    kernel->sets_.emplace_back(this, i);
+    if (kernel->signaled_)
+      OnEventSignaled(i);
+  }
+}
+
+WaitableEventSet::~WaitableEventSet() {
+  // Once the set is removed from an event's kernel, no Signal() can call it
+  // anymore since they are serialized by the kernel's lock.
+  for (auto& kernel : kernels_) {
+    AutoLock kernel_lock(kernel->lock_);
+    auto it = ranges::find(kernel->sets_, this,
+                           &std::pair<WaitableEventSet*, size_t>::first);
+    DCHECK(it != kernel->sets_.end());
+    kernel->sets_.erase(it);
+  }
+}
+
+size_t WaitableEventSet::Wait() {
+  absl::optional<size_t> index = TimedWait(TimeDelta::Max());
+  DCHECK(index) << "TimedWait() should never fail with infinite timeout";
+  return *index;
+}
+
+absl::optional<size_t> WaitableEventSet::TimedWait(TimeDelta wait_delta) {
+  // Like WaitableEvent::TimedWait(), special case is_max() to avoid reading
+  // the time.
+  const TimeTicks end_time =
+      wait_delta.is_max() ? TimeTicks::Max()
+                          : subtle::TimeTicksNowIgnoringOverride() + wait_delta;
+  // Only consider the thread blocked if it actually has to wait.
+  absl::optional<internal::ScopedBlockingCallWithBaseSyncPrimitives>
+      scoped_blocking_call;
+
+  for (;;) {
+    size_t index;
+    {
+      AutoLock auto_lock(lock_);
+      while (ready_.empty()) {
+        const TimeDelta remaining =
+            end_time.is_max()
+                ? TimeDelta::Max()
+                : end_time - subtle::TimeTicksNowIgnoringOverride();
+        if (!remaining.is_positive())
+          return absl::nullopt;
+        if (!scoped_blocking_call) {
+          AutoUnlock auto_unlock(lock_);
+          scoped_blocking_call.emplace(FROM_HERE, BlockingType::MAY_BLOCK);
+          continue;
+        }
+        ++num_waiters_;
+        if (remaining.is_max())
+          cv_.Wait();
+        else
+          cv_.TimedWait(remaining);
+        --num_waiters_;
+      }
+      index = ready_.front();
+      ready_.pop_front();
+      queued_[index] = false;
+    }
+
+    // Taking the kernel's lock also ensures that Signal() has completed.
+    WaitableEvent::WaitableEventKernel* const kernel = kernels_[index].get();
+    AutoLock kernel_lock(kernel->lock_);
+    // The event may have been reset, or consumed by a direct waiter or by
+    // another thread waiting on the set, since it was queued.
+    if (!kernel->signaled_)
+      continue;
+    if (kernel->manual_reset_) {
+      // The event stays signaled, and so stays ready.
+      OnEventSignaled(index);
+    } else {
+      kernel->signaled_ = false;
+    }
+    return index;
+  }
+}
+
+void WaitableEventSet::OnEventSignaled(size_t index) {
+  AutoLock auto_lock(lock_);
+  if (queued_[index])
+    return;
+  queued_[index] = true;
+  ready_.push_back(index);
+  if (num_waiters_)
+    cv_.Signal();
+}
+
+}  // namespace base
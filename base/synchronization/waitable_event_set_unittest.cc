@@ -0,0 +1,131 @@
+// Copyright 2022 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "base/synchronization/waitable_event_set.h"
+
+#include <memory>
+#include <vector>
+
+#include "base/memory/raw_ptr.h"
+#include "base/threading/platform_thread.h"
+#include "base/time/time.h"
+#include "testing/gtest/include/gtest/gtest.h"
+
+namespace base {
+
+namespace {
+
+constexpr size_t kNumEvents = 5;
+
+std::vector<WaitableEvent*> GetPointers(
+    std::vector<std::unique_ptr<WaitableEvent>>& events) {
+  std::vector<WaitableEvent*> pointers;
+  for (auto& event : events)
+    pointers.push_back(event.get());
+  return pointers;
+}
+
+std::vector<std::unique_ptr<WaitableEvent>> CreateEvents(
+    WaitableEvent::ResetPolicy reset_policy) {
+  std::vector<std::unique_ptr<WaitableEvent>> events;
+  for (size_t i = 0; i < kNumEvents; ++i) {
+    events.push_back(std::make_unique<WaitableEvent>(
+        reset_policy, WaitableEvent::InitialState::NOT_SIGNALED));
+  }
+  return events;
+}
+
+// Signals |event| after |delay|.
+class DelayedSignaler : public PlatformThread::Delegate {
+ public:
+  DelayedSignaler(TimeDelta delay, WaitableEvent* event)
+      : delay_(delay), event_(event) {}
+
+  void ThreadMain() override {
+    PlatformThread::Sleep(delay_);
+    event_->Signal();
+  }
+
+ private:
+  const TimeDelta delay_;
+  const raw_ptr<WaitableEvent> event_;
+};
+
+}  // namespace
+
+TEST(WaitableEventSetTest, AutomaticReset) {
+  auto events = CreateEvents(WaitableEvent::ResetPolicy::AUTOMATIC);
+  events[3]->Signal();
+  WaitableEventSet set(GetPointers(events));
+  EXPECT_EQ(kNumEvents, set.size());
+
+  // Events are returned in the order they were signaled, and are consumed.
+  EXPECT_EQ(3u, set.Wait());
+  events[4]->Signal();
+  events[1]->Signal();
+  EXPECT_EQ(4u, set.Wait());
+  EXPECT_EQ(1u, set.Wait());
+  EXPECT_FALSE(events[1]->IsSignaled());
+  EXPECT_EQ(absl::nullopt, set.TimedWait(Milliseconds(10)));
+
+  // An event consumed by a direct waiter isn't returned.
+  events[2]->Signal();
+  events[2]->Wait();
+  events[0]->Signal();
+  EXPECT_EQ(0u, set.Wait());
+}
+
+TEST(WaitableEventSetTest, ManualReset) {
+  auto events = CreateEvents(WaitableEvent::ResetPolicy::MANUAL);
+  WaitableEventSet set(GetPointers(events));
+
+  events[2]->Signal();
+  events[0]->Signal();
+  // Signaled events stay ready until they are reset, in turn.
+  EXPECT_EQ(2u, set.Wait());
+  EXPECT_EQ(0u, set.Wait());
+  EXPECT_EQ(2u, set.Wait());
+  EXPECT_TRUE(events[2]->IsSignaled());
+
+  events[2]->Reset();
+  EXPECT_EQ(0u, set.Wait());
+  EXPECT_EQ(0u, set.Wait());
+  events[0]->Reset();
+  EXPECT_EQ(absl::nullopt, set.TimedWait(Milliseconds(10)));
+}
+
+TEST(WaitableEventSetTest, SignalFromAnotherThread) {
+  auto events = CreateEvents(WaitableEvent::ResetPolicy::AUTOMATIC);
+  WaitableEventSet set(GetPointers(events));
+
+  DelayedSignaler signaler(Milliseconds(10), events[2].get());
+  PlatformThreadHandle thread;
+  ASSERT_TRUE(PlatformThread::Create(0, &signaler, &thread));
+  EXPECT_EQ(2u, set.Wait());
+  PlatformThread::Join(thread);
+}
+
+// The events may be deleted before the set.
+TEST(WaitableEventSetTest, DeleteEventsFirst) {
+  auto events = CreateEvents(WaitableEvent::ResetPolicy::AUTOMATIC);
+  auto set = std::make_unique<WaitableEventSet>(GetPointers(events));
+  events[1]->Signal();
+  events.clear();
+  EXPECT_EQ(1u, set->Wait());
+  set.reset();
+}
+
+TEST(WaitableEventSetTest, EventInSeveralSets) {
+  WaitableEvent event(WaitableEvent::ResetPolicy::AUTOMATIC);
+  WaitableEvent* events[] = {&event};
+  WaitableEventSet first_set(events);
+  WaitableEventSet second_set(events);
+
+  // Only one of the sets consumes an automatic-reset event.
+  event.Signal();
+  EXPECT_EQ(0u, first_set.Wait());
+  EXPECT_EQ(absl::nullopt, second_set.TimedWait(Milliseconds(10)));
+}
+
+}  // namespace base
@@ -27,6 +27,13 @@ namespace {
 constexpr int64_t kLowMemoryDeviceThresholdMB = 2048;
 }  // namespace
 
+#if !BUILDFLAG(IS_LINUX) && !BUILDFLAG(IS_CHROMEOS) && !BUILDFLAG(IS_ANDROID)
+// static
+int SysInfo::NumberOfEffectiveProcessors() {
+  return NumberOfProcessors();
+}
+#endif
+
 // static
 int64_t SysInfo::AmountOfPhysicalMemory() {
   if (base::CommandLine::ForCurrentProcess()->HasSwitch(
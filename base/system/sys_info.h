@@ -10,6 +10,7 @@
 
 #include <map>
 #include <string>
+#include <vector>
 
 #include "base/base_export.h"
 #include "base/callback_forward.h"
@@ -32,6 +33,14 @@ class BASE_EXPORT SysInfo {
   // Return the number of logical processors/cores on the current machine.
   static int NumberOfProcessors();
 
+  // Returns the number of processors the current process can keep busy, which
+  // is the one to size thread pools with. On Linux, ChromeOS and Android, this
+  // is NumberOfProcessors() capped by the CPU quota of the cgroups (v1 or v2)
+  // of the process, rounded up, e.g. 2 in a container limited to 1.5 CPUs of
+  // a 96 CPU machine. Elsewhere, this is NumberOfProcessors(). Like it, this is
+  // computed once.
+  static int NumberOfEffectiveProcessors();
+
   // Return the number of bytes of physical memory on the current machine.
   // If low-end device mode is manually enabled via command line flag, this
   // will return the lesser of the actual physical memory, or 512MB.
@@ -133,6 +142,45 @@ class BASE_EXPORT SysInfo {
   // allocate.
   static size_t VMAllocationGranularity();
 
+#if BUILDFLAG(IS_LINUX) || BUILDFLAG(IS_CHROMEOS) || BUILDFLAG(IS_ANDROID)
+  // The topology of the online logical CPUs, as read from
+  // /sys/devices/system. Each list of CPUs is sorted, and so are |cores| and
+  // |packages|. The fields which can't be read are empty.
+  struct BASE_EXPORT CpuTopology {
+    CpuTopology();
+    CpuTopology(const CpuTopology&);
+    CpuTopology& operator=(const CpuTopology&);
+    ~CpuTopology();
+
+    enum class CacheType { kData, kInstruction, kUnified };
+
+    struct Cache {
+      int level = 0;
+      CacheType type = CacheType::kUnified;
+      int64_t size_bytes = 0;
+      // The logical CPUs which share the cache.
+      std::vector<int> cpus;
+    };
+
+    std::vector<int> cpus;
+    // The logical CPUs of each physical core, i.e. its SMT siblings.
+    std::vector<std::vector<int>> cores;
+    std::vector<std::vector<int>> packages;
+    // The logical CPUs of each online NUMA node which has some, by node.
+    std::vector<std::vector<int>> numa_nodes;
+    // Each cache once, sorted by level.
+    std::vector<Cache> caches;
+  };
+
+  // Returns the topology of the CPUs, which is read once. CPUs brought online
+  // later are missing from it.
+  static const CpuTopology& GetCpuTopology();
+
+  // Returns GetCpuTopology().numa_nodes, which is empty if the topology can't
+  // be read, e.g. on kernels built without NUMA support.
+  static std::vector<std::vector<int>> GetNumaNodeCpus();
+#endif
+
 #if BUILDFLAG(IS_CHROMEOS_ASH) || BUILDFLAG(IS_CHROMEOS_LACROS)
   // Set |value| and return true if LsbRelease contains information about |key|.
   static bool GetLsbReleaseValue(const std::string& key, std::string* value);
@@ -5,8 +5,14 @@
 #ifndef BASE_SYSTEM_SYS_INFO_INTERNAL_H_
 #define BASE_SYSTEM_SYS_INFO_INTERNAL_H_
 
+#include "base/base_export.h"
+#include "base/system/sys_info.h"
+#include "build/build_config.h"
+
 namespace base {
 
+class FilePath;
+
 namespace internal {
 
 template <typename T, T (*F)(void)>
@@ -25,6 +31,21 @@ class LazySysInfoValue {
   const T value_;
 };
 
+#if BUILDFLAG(IS_LINUX) || BUILDFLAG(IS_CHROMEOS) || BUILDFLAG(IS_ANDROID)
+// Returns the tightest CPU quota of the cgroups of the current process and of
+// their ancestors, as a number of CPUs, or 0 if there is none. Reads /proc and
+// the cgroup file systems under |root|, which is "/" but in tests.
+BASE_EXPORT double GetCgroupCpuQuota(const FilePath& root);
+
+// Returns the directory of the cgroup v2 of the current process, under |root|,
+// or an empty path if the process isn't in the v2 hierarchy or it isn't
+// mounted.
+BASE_EXPORT FilePath GetCgroupV2Directory(const FilePath& root);
+
+// Reads the topology of the CPUs from |root|/sys/devices/system.
+BASE_EXPORT SysInfo::CpuTopology ReadCpuTopology(const FilePath& root);
+#endif
+
 }  // namespace internal
 
 }  // namespace base
@@ -7,16 +7,25 @@
 #include <stddef.h>
 #include <stdint.h>
 
+#include <algorithm>
+#include <cmath>
 #include <limits>
+#include <map>
 #include <sstream>
+#include <tuple>
+#include <vector>
 
 #include "base/check.h"
+#include "base/cxx17_backports.h"
+#include "base/files/file_path.h"
 #include "base/files/file_util.h"
 #include "base/lazy_instance.h"
+#include "base/no_destructor.h"
 #include "base/notreached.h"
 #include "base/numerics/safe_conversions.h"
 #include "base/process/process_metrics.h"
 #include "base/strings/string_number_conversions.h"
+#include "base/strings/string_split.h"
 #include "base/strings/string_util.h"
 #include "base/strings/stringprintf.h"
 #include "base/system/sys_info_internal.h"
@@ -43,10 +52,378 @@ base::LazyInstance<
     base::internal::LazySysInfoValue<int64_t, AmountOfPhysicalMemory>>::Leaky
     g_lazy_physical_memory = LAZY_INSTANCE_INITIALIZER;
 
+// Parses a sysfs CPU or node list such as "0-3,8,10-11" into |values|.
+bool ParseSysfsList(base::StringPiece list, std::vector<int>* values) {
+  for (base::StringPiece range :
+       base::SplitStringPiece(list, ",", base::TRIM_WHITESPACE,
+                              base::SPLIT_WANT_NONEMPTY)) {
+    std::vector<base::StringPiece> bounds = base::SplitStringPiece(
+        range, "-", base::TRIM_WHITESPACE, base::SPLIT_WANT_ALL);
+    int first = 0;
+    int last = 0;
+    if (bounds.empty() || bounds.size() > 2 ||
+        !base::StringToInt(bounds.front(), &first) ||
+        !base::StringToInt(bounds.back(), &last) || first < 0 ||
+        last < first) {
+      return false;
+    }
+    for (int value = first; value <= last; ++value)
+      values->push_back(value);
+  }
+  return true;
+}
+
+// Returns |path|, which is absolute, under |root|.
+base::FilePath UnderRoot(const base::FilePath& root, base::StringPiece path) {
+  path = base::TrimString(path, "/", base::TRIM_LEADING);
+  return path.empty() ? root : root.Append(path);
+}
+
+// Reads a file of /proc, /sys or of a cgroup file system, which are generated
+// by the kernel, so that reading them never blocks.
+bool ReadKernelFile(const base::FilePath& path, std::string* contents) {
+  return base::ReadFileToStringNonBlocking(path, contents);
+}
+
+bool ReadKernelFileToInt64(const base::FilePath& path, int64_t* value) {
+  std::string contents;
+  return ReadKernelFile(path, &contents) &&
+         base::StringToInt64(
+             base::TrimWhitespaceASCII(contents, base::TRIM_ALL), value);
+}
+
+// Returns the CPU quota set on the cgroup v2 directory |dir| as a number of
+// CPUs, e.g. 1.5 for "150000 100000", or 0 if there is none.
+double ReadCgroupV2CpuQuota(const base::FilePath& dir) {
+  std::string contents;
+  if (!ReadKernelFile(dir.Append("cpu.max"), &contents))
+    return 0;
+  std::vector<base::StringPiece> values = base::SplitStringPiece(
+      contents, " ", base::TRIM_WHITESPACE, base::SPLIT_WANT_NONEMPTY);
+  int64_t quota = 0;
+  int64_t period = 0;
+  if (values.size() != 2 || !base::StringToInt64(values[0], &quota) ||
+      !base::StringToInt64(values[1], &period) || quota <= 0 || period <= 0) {
+    // Includes "max", i.e. no quota.
+    return 0;
+  }
+  return static_cast<double>(quota) / period;
+}
+
+// Same as above, for the v1 directory |dir| of the cpu controller.
+double ReadCgroupV1CpuQuota(const base::FilePath& dir) {
+  int64_t quota = 0;
+  int64_t period = 0;
+  if (!ReadKernelFileToInt64(dir.Append("cpu.cfs_quota_us"), &quota) ||
+      !ReadKernelFileToInt64(dir.Append("cpu.cfs_period_us"), &period) ||
+      quota <= 0 || period <= 0) {
+    // Includes -1, i.e. no quota.
+    return 0;
+  }
+  return static_cast<double>(quota) / period;
+}
+
+// A mount of a cgroup hierarchy, from /proc/self/mountinfo.
+struct CgroupMount {
+  // The cgroup at the root of the mount, e.g. "/" or "/docker/<id>".
+  std::string root;
+  std::string mount_point;
+};
+
+// Finds the mount of the cgroup v2 hierarchy if |v2|, else of the v1
+// hierarchy of the cpu controller, in the contents of /proc/self/mountinfo.
+bool FindCgroupMount(base::StringPiece mountinfo,
+                     bool v2,
+                     CgroupMount* mount) {
+  for (base::StringPiece line :
+       base::SplitStringPiece(mountinfo, "\n", base::KEEP_WHITESPACE,
+                              base::SPLIT_WANT_NONEMPTY)) {
+    // "<id> <parent> <dev> <root> <mount point> <options> [<optional>...] -
+    // <type> <source> <super options>"
+    std::vector<base::StringPiece> fields = base::SplitStringPiece(
+        line, " ", base::TRIM_WHITESPACE, base::SPLIT_WANT_NONEMPTY);
+    auto separator = std::find(fields.begin(), fields.end(), "-");
+    if (separator - fields.begin() < 6 || fields.end() - separator < 4)
+      continue;
+    const base::StringPiece type = separator[1];
+    if (v2) {
+      if (type != "cgroup2")
+        continue;
+    } else {
+      if (type != "cgroup")
+        continue;
+      std::vector<base::StringPiece> options = base::SplitStringPiece(
+          separator[3], ",", base::TRIM_WHITESPACE, base::SPLIT_WANT_NONEMPTY);
+      if (std::find(options.begin(), options.end(), "cpu") == options.end())
+        continue;
+    }
+    mount->root = std::string(fields[3]);
+    mount->mount_point = std::string(fields[4]);
+    return true;
+  }
+  return false;
+}
+
+// Returns the directory of the cgroup |cgroup_path| of |mount|, or the mount
+// directory if the cgroup isn't within the mount.
+base::FilePath GetCgroupDirectory(const base::FilePath& root,
+                                  const CgroupMount& mount,
+                                  base::StringPiece cgroup_path) {
+  // Without a cgroup namespace, the mount of a container is the cgroup of the
+  // container, to which |cgroup_path| is relative.
+  if (mount.root != "/") {
+    if (base::StartsWith(cgroup_path, mount.root))
+      cgroup_path.remove_prefix(mount.root.size());
+    else
+      cgroup_path = base::StringPiece();
+  }
+
+  const base::FilePath mount_dir = UnderRoot(root, mount.mount_point);
+  base::FilePath dir = UnderRoot(mount_dir, cgroup_path);
+  if (dir.ReferencesParent() || (dir != mount_dir && !mount_dir.IsParent(dir)))
+    dir = mount_dir;
+  return dir;
+}
+
+// Returns the tightest quota of the cgroup |cgroup_path| of |mount| and of its
+// ancestors within the mount.
+double GetHierarchyCpuQuota(const base::FilePath& root,
+                            const CgroupMount& mount,
+                            base::StringPiece cgroup_path,
+                            bool v2) {
+  const base::FilePath mount_dir = UnderRoot(root, mount.mount_point);
+  base::FilePath dir = GetCgroupDirectory(root, mount, cgroup_path);
+  double quota = 0;
+  while (true) {
+    const double dir_quota =
+        v2 ? ReadCgroupV2CpuQuota(dir) : ReadCgroupV1CpuQuota(dir);
+    if (dir_quota > 0 && (quota == 0 || dir_quota < quota))
+      quota = dir_quota;
+    if (dir == mount_dir)
+      break;
+    dir = dir.DirName();
+  }
+  return quota;
+}
+
+int NumberOfEffectiveProcessors() {
+  const int num_processors = base::SysInfo::NumberOfProcessors();
+  const double quota =
+      base::internal::GetCgroupCpuQuota(base::FilePath("/"));
+  if (quota <= 0)
+    return num_processors;
+  return base::clamp(static_cast<int>(std::ceil(quota)), 1, num_processors);
+}
+
+base::LazyInstance<
+    base::internal::LazySysInfoValue<int, NumberOfEffectiveProcessors>>::Leaky
+    g_lazy_number_of_effective_processors = LAZY_INSTANCE_INITIALIZER;
+
+// Reads the sysfs CPU list |path| into |cpus|, keeping only those in |online|,
+// which is sorted.
+bool ReadCpuList(const base::FilePath& path,
+                 const std::vector<int>& online,
+                 std::vector<int>* cpus) {
+  std::string list;
+  std::vector<int> values;
+  if (!ReadKernelFile(path, &list) || !ParseSysfsList(list, &values))
+    return false;
+  std::sort(values.begin(), values.end());
+  cpus->clear();
+  std::set_intersection(values.begin(), values.end(), online.begin(),
+                        online.end(), std::back_inserter(*cpus));
+  return !cpus->empty();
+}
+
+// Parses a sysfs cache size, such as "32K".
+bool ParseCacheSize(base::StringPiece size, int64_t* bytes) {
+  size = base::TrimWhitespaceASCII(size, base::TRIM_ALL);
+  int64_t multiplier = 1;
+  if (!size.empty() && (size.back() == 'K' || size.back() == 'M' ||
+                        size.back() == 'G')) {
+    multiplier = size.back() == 'K'   ? 1024
+                 : size.back() == 'M' ? 1024 * 1024
+                                      : 1024 * 1024 * 1024;
+    size.remove_suffix(1);
+  }
+  int64_t value = 0;
+  if (!base::StringToInt64(size, &value) || value < 0)
+    return false;
+  *bytes = value * multiplier;
+  return true;
+}
+
+base::SysInfo::CpuTopology::CacheType ParseCacheType(base::StringPiece type) {
+  using CacheType = base::SysInfo::CpuTopology::CacheType;
+  type = base::TrimWhitespaceASCII(type, base::TRIM_ALL);
+  if (type == "Data")
+    return CacheType::kData;
+  if (type == "Instruction")
+    return CacheType::kInstruction;
+  return CacheType::kUnified;
+}
+
+// Adds |cpus| to |sets|, unless it is in them already.
+void AddCpuSet(std::vector<int> cpus, std::vector<std::vector<int>>* sets) {
+  if (std::find(sets->begin(), sets->end(), cpus) == sets->end())
+    sets->push_back(std::move(cpus));
+}
+
 }  // namespace
 
 namespace base {
 
+SysInfo::CpuTopology::CpuTopology() = default;
+SysInfo::CpuTopology::CpuTopology(const CpuTopology&) = default;
+SysInfo::CpuTopology& SysInfo::CpuTopology::operator=(const CpuTopology&) =
+    default;
+SysInfo::CpuTopology::~CpuTopology() = default;
+
+namespace internal {
+
+double GetCgroupCpuQuota(const FilePath& root) {
+  std::string cgroups;
+  std::string mountinfo;
+  if (!ReadKernelFile(UnderRoot(root, "/proc/self/cgroup"), &cgroups) ||
+      !ReadKernelFile(UnderRoot(root, "/proc/self/mountinfo"), &mountinfo)) {
+    return 0;
+  }
+
+  double quota = 0;
+  for (StringPiece line : SplitStringPiece(cgroups, "\n", KEEP_WHITESPACE,
+                                           SPLIT_WANT_NONEMPTY)) {
+    // "<hierarchy id>:<controllers>:<cgroup path>", where the path may
+    // contain ':'. The v2 hierarchy is "0::<cgroup path>".
+    const size_t first_colon = line.find(':');
+    const size_t second_colon = line.find(':', first_colon + 1);
+    if (first_colon == StringPiece::npos || second_colon == StringPiece::npos)
+      continue;
+    const StringPiece controllers =
+        line.substr(first_colon + 1, second_colon - first_colon - 1);
+    const StringPiece cgroup_path = line.substr(second_colon + 1);
+
+    bool v2;
+    if (line.substr(0, first_colon) == "0" && controllers.empty()) {
+      v2 = true;
+    } else {
+      std::vector<StringPiece> names = SplitStringPiece(
+          controllers, ",", TRIM_WHITESPACE, SPLIT_WANT_NONEMPTY);
+      if (std::find(names.begin(), names.end(), "cpu") == names.end())
+        continue;
+      v2 = false;
+    }
+
+    CgroupMount mount;
+    if (!FindCgroupMount(mountinfo, v2, &mount))
+      continue;
+    const double hierarchy_quota =
+        GetHierarchyCpuQuota(root, mount, cgroup_path, v2);
+    if (hierarchy_quota > 0 && (quota == 0 || hierarchy_quota < quota))
+      quota = hierarchy_quota;
+  }
+  return quota;
+}
+
+FilePath GetCgroupV2Directory(const FilePath& root) {
+  std::string cgroups;
+  std::string mountinfo;
+  if (!ReadKernelFile(UnderRoot(root, "/proc/self/cgroup"), &cgroups) ||
+      !ReadKernelFile(UnderRoot(root, "/proc/self/mountinfo"), &mountinfo)) {
+    return FilePath();
+  }
+
+  CgroupMount mount;
+  for (StringPiece line : SplitStringPiece(cgroups, "\n", KEEP_WHITESPACE,
+                                           SPLIT_WANT_NONEMPTY)) {
+    if (!StartsWith(line, "0::"))
+      continue;
+    if (!FindCgroupMount(mountinfo, /*v2=*/true, &mount))
+      return FilePath();
+    return GetCgroupDirectory(root, mount, line.substr(3));
+  }
+  return FilePath();
+}
+
+SysInfo::CpuTopology ReadCpuTopology(const FilePath& root) {
+  SysInfo::CpuTopology topology;
+  const FilePath cpu_dir = UnderRoot(root, "/sys/devices/system/cpu");
+  std::string online_cpus;
+  if (!ReadKernelFile(cpu_dir.Append("online"), &online_cpus) ||
+      !ParseSysfsList(online_cpus, &topology.cpus)) {
+    return SysInfo::CpuTopology();
+  }
+  std::sort(topology.cpus.begin(), topology.cpus.end());
+
+  using CacheKey = std::tuple<int, SysInfo::CpuTopology::CacheType,
+                              std::vector<int>>;
+  std::map<CacheKey, int64_t> caches;
+  std::vector<int> cpus;
+  for (int cpu : topology.cpus) {
+    const FilePath dir = cpu_dir.Append(StringPrintf("cpu%d", cpu));
+    // These are the names before Linux 5.3, which newer kernels keep along
+    // core_cpus_list and package_cpus_list.
+    if (ReadCpuList(dir.Append("topology/thread_siblings_list"), topology.cpus,
+                    &cpus)) {
+      AddCpuSet(cpus, &topology.cores);
+    }
+    if (ReadCpuList(dir.Append("topology/core_siblings_list"), topology.cpus,
+                    &cpus)) {
+      AddCpuSet(cpus, &topology.packages);
+    }
+
+    for (int index = 0;; ++index) {
+      const FilePath cache_dir =
+          dir.Append(StringPrintf("cache/index%d", index));
+      int64_t level = 0;
+      std::string type;
+      std::string size;
+      if (!ReadKernelFileToInt64(cache_dir.Append("level"), &level))
+        break;
+      int64_t size_bytes = 0;
+      if (!ReadKernelFile(cache_dir.Append("type"), &type) ||
+          !ReadKernelFile(cache_dir.Append("size"), &size) ||
+          !ParseCacheSize(size, &size_bytes) ||
+          !ReadCpuList(cache_dir.Append("shared_cpu_list"), topology.cpus,
+                       &cpus)) {
+        continue;
+      }
+      caches.emplace(
+          CacheKey(static_cast<int>(level), ParseCacheType(type), cpus),
+          size_bytes);
+    }
+  }
+  std::sort(topology.cores.begin(), topology.cores.end());
+  std::sort(topology.packages.begin(), topology.packages.end());
+  for (const auto& cache : caches) {
+    topology.caches.push_back({std::get<0>(cache.first),
+                               std::get<1>(cache.first), cache.second,
+                               std::get<2>(cache.first)});
+  }
+
+  const FilePath node_dir = UnderRoot(root, "/sys/devices/system/node");
+  std::string online_nodes;
+  std::vector<int> nodes;
+  if (!ReadKernelFile(node_dir.Append("online"), &online_nodes) ||
+      !ParseSysfsList(online_nodes, &nodes)) {
+    return topology;
+  }
+  for (int node : nodes) {
+    // Memory-only nodes have no CPUs to run workers on.
+    if (ReadCpuList(node_dir.Append(StringPrintf("node%d/cpulist", node)),
+                    topology.cpus, &cpus)) {
+      topology.numa_nodes.push_back(cpus);
+    }
+  }
+  return topology;
+}
+
+}  // namespace internal
+
+// static
+int SysInfo::NumberOfEffectiveProcessors() {
+  return g_lazy_number_of_effective_processors.Get().value();
+}
+
 // static
 int64_t SysInfo::AmountOfPhysicalMemoryImpl() {
   return g_lazy_physical_memory.Get().value();
@@ -129,6 +506,18 @@ std::string SysInfo::CPUModelName() {
   return std::string();
 }
 
+// static
+const SysInfo::CpuTopology& SysInfo::GetCpuTopology() {
+  static const NoDestructor<CpuTopology> topology(
+      internal::ReadCpuTopology(FilePath("/")));
+  return *topology;
+}
+
+// static
+std::vector<std::vector<int>> SysInfo::GetNumaNodeCpus() {
+  return GetCpuTopology().numa_nodes;
+}
+
 #if !BUILDFLAG(IS_ANDROID)
 // static
 SysInfo::HardwareInfo SysInfo::GetHardwareInfoSync() {
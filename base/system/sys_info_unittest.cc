@@ -4,21 +4,25 @@
 
 #include <stdint.h>
 
+#include <set>
 #include <utility>
 #include <vector>
 
 #include "base/bind.h"
 #include "base/environment.h"
 #include "base/files/file_util.h"
+#include "base/files/scoped_temp_dir.h"
 #include "base/process/process_metrics.h"
 #include "base/run_loop.h"
 #include "base/strings/pattern.h"
 #include "base/strings/string_number_conversions.h"
 #include "base/strings/string_split.h"
 #include "base/strings/string_util.h"
+#include "base/strings/stringprintf.h"
 #include "base/strings/sys_string_conversions.h"
 #include "base/strings/utf_string_conversions.h"
 #include "base/system/sys_info.h"
+#include "base/system/sys_info_internal.h"
 #include "base/test/scoped_chromeos_version_info.h"
 #include "base/test/scoped_running_on_chromeos.h"
 #include "base/test/task_environment.h"
@@ -104,6 +108,180 @@ TEST_F(SysInfoTest, MAYBE_AmountOfAvailablePhysicalMemory) {
 #endif  // BUILDFLAG(IS_LINUX) || BUILDFLAG(IS_CHROMEOS) ||
         // BUILDFLAG(IS_ANDROID)
 
+#if BUILDFLAG(IS_LINUX) || BUILDFLAG(IS_CHROMEOS) || BUILDFLAG(IS_ANDROID)
+TEST_F(SysInfoTest, GetNumaNodeCpus) {
+  // The topology isn't available on all kernels, but each CPU that is reported
+  // must belong to a single node.
+  std::set<int> cpus;
+  for (const std::vector<int>& node_cpus : SysInfo::GetNumaNodeCpus()) {
+    EXPECT_FALSE(node_cpus.empty());
+    for (int cpu : node_cpus) {
+      EXPECT_GE(cpu, 0);
+      EXPECT_TRUE(cpus.insert(cpu).second) << cpu;
+    }
+  }
+}
+
+TEST_F(SysInfoTest, GetCpuTopology) {
+  const SysInfo::CpuTopology& topology = SysInfo::GetCpuTopology();
+  const std::set<int> online(topology.cpus.begin(), topology.cpus.end());
+
+  // Each reported CPU belongs to a single core and a single package.
+  for (const auto* sets : {&topology.cores, &topology.packages}) {
+    std::set<int> cpus;
+    for (const std::vector<int>& set : *sets) {
+      EXPECT_FALSE(set.empty());
+      for (int cpu : set) {
+        EXPECT_TRUE(online.count(cpu)) << cpu;
+        EXPECT_TRUE(cpus.insert(cpu).second) << cpu;
+      }
+    }
+  }
+  for (const SysInfo::CpuTopology::Cache& cache : topology.caches) {
+    EXPECT_GT(cache.level, 0);
+    EXPECT_GT(cache.size_bytes, 0);
+    EXPECT_FALSE(cache.cpus.empty());
+  }
+  EXPECT_EQ(SysInfo::GetNumaNodeCpus(), topology.numa_nodes);
+}
+
+TEST_F(SysInfoTest, NumberOfEffectiveProcessors) {
+  EXPECT_GE(SysInfo::NumberOfEffectiveProcessors(), 1);
+  EXPECT_LE(SysInfo::NumberOfEffectiveProcessors(),
+            SysInfo::NumberOfProcessors());
+}
+
+class SysInfoCgroupTest : public SysInfoTest {
+ protected:
+  void SetUp() override { ASSERT_TRUE(temp_dir_.CreateUniqueTempDir()); }
+
+  void WriteFile(StringPiece path, StringPiece contents) {
+    const FilePath file = temp_dir_.GetPath().Append(path);
+    ASSERT_TRUE(CreateDirectory(file.DirName()));
+    ASSERT_TRUE(base::WriteFile(file, contents));
+  }
+
+  double GetCgroupCpuQuota() {
+    return internal::GetCgroupCpuQuota(temp_dir_.GetPath());
+  }
+
+  ScopedTempDir temp_dir_;
+};
+
+TEST_F(SysInfoCgroupTest, NoQuota) {
+  EXPECT_EQ(GetCgroupCpuQuota(), 0);
+
+  WriteFile("proc/self/cgroup", "0::/user.slice\n");
+  WriteFile("proc/self/mountinfo",
+            "30 23 0:26 / /sys/fs/cgroup rw,nosuid shared:4 - cgroup2 "
+            "cgroup2 rw\n");
+  WriteFile("sys/fs/cgroup/user.slice/cpu.max", "max 100000\n");
+  EXPECT_EQ(GetCgroupCpuQuota(), 0);
+}
+
+TEST_F(SysInfoCgroupTest, CgroupV2) {
+  WriteFile("proc/self/cgroup", "0::/kubepods/pod1/container1\n");
+  WriteFile("proc/self/mountinfo",
+            "22 1 8:1 / / rw,relatime - ext4 /dev/sda1 rw\n"
+            "30 23 0:26 / /sys/fs/cgroup rw,nosuid shared:4 - cgroup2 "
+            "cgroup2 rw,nsdelegate\n");
+  WriteFile("sys/fs/cgroup/kubepods/pod1/container1/cpu.max", "max 100000\n");
+  WriteFile("sys/fs/cgroup/kubepods/pod1/cpu.max", "150000 100000\n");
+  WriteFile("sys/fs/cgroup/kubepods/cpu.max", "400000 100000\n");
+  // The tightest quota of the hierarchy applies.
+  EXPECT_DOUBLE_EQ(GetCgroupCpuQuota(), 1.5);
+}
+
+TEST_F(SysInfoCgroupTest, CgroupV2Namespace) {
+  // In a cgroup namespace, the cgroup of the process is the root of the mount.
+  WriteFile("proc/self/cgroup", "0::/\n");
+  WriteFile("proc/self/mountinfo",
+            "30 23 0:26 / /sys/fs/cgroup ro,nosuid - cgroup2 cgroup rw\n");
+  WriteFile("sys/fs/cgroup/cpu.max", "200000 50000\n");
+  EXPECT_DOUBLE_EQ(GetCgroupCpuQuota(), 4);
+}
+
+TEST_F(SysInfoCgroupTest, CgroupV1) {
+  WriteFile("proc/self/cgroup",
+            "12:memory:/docker/abc\n"
+            "4:cpu,cpuacct:/docker/abc\n"
+            "1:name=systemd:/docker/abc\n");
+  // Without a cgroup namespace, the cgroup of the container is mounted.
+  WriteFile("proc/self/mountinfo",
+            "40 30 0:35 /docker/abc /sys/fs/cgroup/memory ro - cgroup cgroup "
+            "rw,memory\n"
+            "41 30 0:36 /docker/abc /sys/fs/cgroup/cpu,cpuacct ro - cgroup "
+            "cgroup rw,cpu,cpuacct\n");
+  WriteFile("sys/fs/cgroup/cpu,cpuacct/cpu.cfs_quota_us", "250000\n");
+  WriteFile("sys/fs/cgroup/cpu,cpuacct/cpu.cfs_period_us", "100000\n");
+  EXPECT_DOUBLE_EQ(GetCgroupCpuQuota(), 2.5);
+
+  WriteFile("sys/fs/cgroup/cpu,cpuacct/cpu.cfs_quota_us", "-1\n");
+  EXPECT_EQ(GetCgroupCpuQuota(), 0);
+}
+
+TEST_F(SysInfoCgroupTest, GetCgroupV2Directory) {
+  EXPECT_TRUE(internal::GetCgroupV2Directory(temp_dir_.GetPath()).empty());
+
+  WriteFile("proc/self/cgroup",
+            "4:memory:/user.slice\n"
+            "0::/user.slice/session-1.scope\n");
+  WriteFile("proc/self/mountinfo",
+            "30 23 0:26 / /sys/fs/cgroup rw,nosuid shared:4 - cgroup2 "
+            "cgroup2 rw\n");
+  EXPECT_EQ(internal::GetCgroupV2Directory(temp_dir_.GetPath()),
+            temp_dir_.GetPath().Append(
+                "sys/fs/cgroup/user.slice/session-1.scope"));
+
+  // Only v1 hierarchies.
+  WriteFile("proc/self/cgroup", "4:memory:/user.slice\n");
+  EXPECT_TRUE(internal::GetCgroupV2Directory(temp_dir_.GetPath()).empty());
+}
+
+TEST_F(SysInfoCgroupTest, ReadCpuTopology) {
+  // Two cores of two SMT siblings each, in one package, on two NUMA nodes.
+  WriteFile("sys/devices/system/cpu/online", "0-3\n");
+  for (int cpu = 0; cpu < 4; ++cpu) {
+    const std::string dir = StringPrintf("sys/devices/system/cpu/cpu%d/", cpu);
+    const std::string core = cpu % 2 ? "1,3\n" : "0,2\n";
+    WriteFile(dir + "topology/thread_siblings_list", core);
+    WriteFile(dir + "topology/core_siblings_list", "0-3\n");
+    WriteFile(dir + "cache/index0/level", "1\n");
+    WriteFile(dir + "cache/index0/type", "Data\n");
+    WriteFile(dir + "cache/index0/size", "48K\n");
+    WriteFile(dir + "cache/index0/shared_cpu_list", core);
+    WriteFile(dir + "cache/index1/level", "3\n");
+    WriteFile(dir + "cache/index1/type", "Unified\n");
+    WriteFile(dir + "cache/index1/size", "32768K\n");
+    WriteFile(dir + "cache/index1/shared_cpu_list", "0-3\n");
+  }
+  WriteFile("sys/devices/system/node/online", "0-2\n");
+  WriteFile("sys/devices/system/node/node0/cpulist", "0,2\n");
+  WriteFile("sys/devices/system/node/node1/cpulist", "1,3\n");
+  // A memory-only node.
+  WriteFile("sys/devices/system/node/node2/cpulist", "\n");
+
+  const SysInfo::CpuTopology topology =
+      internal::ReadCpuTopology(temp_dir_.GetPath());
+  EXPECT_EQ(topology.cpus, std::vector<int>({0, 1, 2, 3}));
+  EXPECT_EQ(topology.cores,
+            std::vector<std::vector<int>>({{0, 2}, {1, 3}}));
+  EXPECT_EQ(topology.packages, std::vector<std::vector<int>>({{0, 1, 2, 3}}));
+  EXPECT_EQ(topology.numa_nodes,
+            std::vector<std::vector<int>>({{0, 2}, {1, 3}}));
+  ASSERT_EQ(topology.caches.size(), 3u);
+  EXPECT_EQ(topology.caches[0].level, 1);
+  EXPECT_EQ(topology.caches[0].type, SysInfo::CpuTopology::CacheType::kData);
+  EXPECT_EQ(topology.caches[0].size_bytes, 48 * 1024);
+  EXPECT_EQ(topology.caches[0].cpus, std::vector<int>({0, 2}));
+  EXPECT_EQ(topology.caches[1].cpus, std::vector<int>({1, 3}));
+  EXPECT_EQ(topology.caches[2].level, 3);
+  EXPECT_EQ(topology.caches[2].size_bytes, 32 * 1024 * 1024);
+  EXPECT_EQ(topology.caches[2].cpus, std::vector<int>({0, 1, 2, 3}));
+}
+#endif  // BUILDFLAG(IS_LINUX) || BUILDFLAG(IS_CHROMEOS) ||
+        // BUILDFLAG(IS_ANDROID)
+
 TEST_F(SysInfoTest, AmountOfFreeDiskSpace) {
   // We aren't actually testing that it's correct, just that it's sane.
   FilePath tmp_path;
@@ -6,12 +6,16 @@
 
 #include <stddef.h>
 
+#include <atomic>
+#include <memory>
 #include <utility>
+#include <vector>
 
 #include "base/bind.h"
 #include "base/callback_helpers.h"
 #include "base/feature_list.h"
 #include "base/location.h"
+#include "base/memory/raw_ptr.h"
 #include "base/memory/ref_counted.h"
 #include "base/metrics/histogram_macros.h"
 #include "base/task/scoped_set_task_priority_for_current_thread.h"
@@ -76,12 +80,142 @@ bool AllowOffSequenceTaskCancelation() {
   return base::FeatureList::IsEnabled(kAllowOffSequenceTaskCancelation);
 }
 
+// The number of slots the table of cancellation flags grows by.
+constexpr uint32_t kSlotsPerChunk = 32;
+
 }  // namespace
 
+// The cancellation flag of a tracked task: a slot of the table, and the
+// generation the slot had when the task was tracked. Checking the flag is a
+// single atomic load, from any sequence. Copied into the callbacks of the task.
+class CancelableTaskTracker::TaskCancellationFlag {
+ public:
+  struct Slot {
+    // Bumped when the task tracked by the slot is canceled or untracked, which
+    // sets its flag, and again when the slot tracks another task.
+    std::atomic<uint32_t> generation{0};
+    // Accessed on the sequence of the tracker only.
+    uint32_t index = 0;
+    size_t live_index = 0;
+  };
+
+  TaskCancellationFlag(scoped_refptr<TaskCancellationFlagTable> table,
+                       Slot* slot,
+                       uint32_t generation)
+      : table_(std::move(table)), slot_(slot), generation_(generation) {}
+
+  bool IsSet() const {
+    return slot_->generation.load(std::memory_order_acquire) != generation_;
+  }
+
+  // Sets the flag, which untracks the task and frees its slot. No-op if the flag
+  // is already set. Must be called on the sequence of the tracker.
+  void Set() const;
+
+  // The TaskId of the task: its generation in the high bits, and its slot index
+  // plus one in the low bits, so that it's never kBadTaskId.
+  TaskId id() const {
+    return static_cast<TaskId>((uint64_t{generation_} << 32) |
+                               (uint64_t{slot_->index} + 1));
+  }
+
+ private:
+  scoped_refptr<TaskCancellationFlagTable> table_;
+  raw_ptr<Slot> slot_;
+  uint32_t generation_;
+};
+
+// A slab of cancellation flags, which grows by chunks whose addresses never
+// change, so that tasks can check their flag without a lock. The slots of the
+// tracked tasks are also kept in a dense array, so that canceling all tasks
+// costs O(tracked tasks). Slots are allocated and freed on the sequence of the
+// tracker only.
+class CancelableTaskTracker::TaskCancellationFlagTable
+    : public RefCountedThreadSafe<TaskCancellationFlagTable> {
+ public:
+  using Slot = TaskCancellationFlag::Slot;
+
+  TaskCancellationFlagTable() = default;
+  TaskCancellationFlagTable(const TaskCancellationFlagTable&) = delete;
+  TaskCancellationFlagTable& operator=(const TaskCancellationFlagTable&) =
+      delete;
+
+  TaskCancellationFlag Allocate() {
+    if (free_slots_.empty()) {
+      const uint32_t first_index =
+          static_cast<uint32_t>(chunks_.size()) * kSlotsPerChunk;
+      chunks_.push_back(std::make_unique<Slot[]>(kSlotsPerChunk));
+      // Reuse the lowest indices first.
+      for (uint32_t i = kSlotsPerChunk; i-- > 0;) {
+        chunks_.back()[i].index = first_index + i;
+        free_slots_.push_back(&chunks_.back()[i]);
+      }
+    }
+    Slot* const slot = free_slots_.back();
+    free_slots_.pop_back();
+    slot->live_index = live_slots_.size();
+    live_slots_.push_back(slot);
+
+    // Tasks which were tracked by |slot| keep seeing their flag set.
+    const uint32_t generation =
+        slot->generation.load(std::memory_order_relaxed) + 1;
+    slot->generation.store(generation, std::memory_order_relaxed);
+    return TaskCancellationFlag(this, slot, generation);
+  }
+
+  // Sets the flag of the task |id| and frees its slot. No-op if the task isn't
+  // tracked anymore, or if |id| is bad or unknown.
+  void Free(TaskId id) {
+    const uint64_t bits = static_cast<uint64_t>(id);
+    const uint64_t index = (bits & 0xffffffff) - 1;
+    if (index >= chunks_.size() * kSlotsPerChunk)
+      return;
+    Slot* const slot = &chunks_[index / kSlotsPerChunk][index % kSlotsPerChunk];
+    const uint32_t generation = static_cast<uint32_t>(bits >> 32);
+    if (slot->generation.load(std::memory_order_relaxed) != generation)
+      return;
+
+    SetFlag(slot);
+    Slot* const last_slot = live_slots_.back();
+    live_slots_[slot->live_index] = last_slot;
+    last_slot->live_index = slot->live_index;
+    live_slots_.pop_back();
+    free_slots_.push_back(slot);
+  }
+
+  void FreeAll() {
+    for (Slot* slot : live_slots_) {
+      SetFlag(slot);
+      free_slots_.push_back(slot);
+    }
+    live_slots_.clear();
+  }
+
+  bool HasLiveSlots() const { return !live_slots_.empty(); }
+
+ private:
+  friend class RefCountedThreadSafe<TaskCancellationFlagTable>;
+  ~TaskCancellationFlagTable() = default;
+
+  static void SetFlag(Slot* slot) {
+    slot->generation.store(slot->generation.load(std::memory_order_relaxed) + 1,
+                           std::memory_order_release);
+  }
+
+  std::vector<std::unique_ptr<Slot[]>> chunks_;
+  std::vector<Slot*> free_slots_;
+  std::vector<Slot*> live_slots_;
+};
+
+void CancelableTaskTracker::TaskCancellationFlag::Set() const {
+  table_->Free(id());
+}
+
 // static
 const CancelableTaskTracker::TaskId CancelableTaskTracker::kBadTaskId = 0;
 
-CancelableTaskTracker::CancelableTaskTracker() {
+CancelableTaskTracker::CancelableTaskTracker()
+    : task_flags_(MakeRefCounted<TaskCancellationFlagTable>()) {
   weak_this_ = weak_factory_.GetWeakPtr();
 }
 
@@ -112,27 +246,20 @@ CancelableTaskTracker::TaskId CancelableTaskTracker::PostTaskAndReply(
   // We need a SequencedTaskRunnerHandle to run |reply|.
   DCHECK(SequencedTaskRunnerHandle::IsSet());
 
-  auto flag = MakeRefCounted<TaskCancellationFlag>();
-
-  TaskId id = next_id_;
-  next_id_++;  // int64_t is big enough that we ignore the potential overflow.
-
-  // Unretained(this) is safe because |flag| will have been set to the
-  // "canceled" state after |this| is deleted.
-  OnceClosure untrack_closure =
-      BindOnce(&CancelableTaskTracker::Untrack, Unretained(this), id);
+  TaskCancellationFlag flag = Track();
   bool success = task_runner->PostTaskAndReply(
       from_here,
       BindOnce(&RunIfNotCanceled, SequencedTaskRunnerHandle::Get(), flag,
                std::move(task)),
       BindOnce(&RunThenUntrackIfNotCanceled, SequencedTaskRunnerHandle::Get(),
-               flag, std::move(reply), std::move(untrack_closure)));
+               flag, std::move(reply)));
 
-  if (!success)
+  if (!success) {
+    flag.Set();
     return kBadTaskId;
+  }
 
-  Track(id, std::move(flag));
-  return id;
+  return flag.id();
 }
 
 CancelableTaskTracker::TaskId CancelableTaskTracker::NewTrackedTaskId(
@@ -140,67 +267,47 @@ CancelableTaskTracker::TaskId CancelableTaskTracker::NewTrackedTaskId(
   DCHECK(sequence_checker_.CalledOnValidSequence());
   DCHECK(SequencedTaskRunnerHandle::IsSet());
 
-  TaskId id = next_id_;
-  next_id_++;  // int64_t is big enough that we ignore the potential overflow.
+  TaskCancellationFlag flag = Track();
 
-  auto flag = MakeRefCounted<TaskCancellationFlag>();
-
-  // Unretained(this) is safe because |flag| will have been set to the
-  // "canceled" state after |this| is deleted.
-  OnceClosure untrack_closure =
-      BindOnce(&CancelableTaskTracker::Untrack, Unretained(this), id);
-
-  // Will always run |untrack_closure| on current sequence.
+  // Will always untrack the task on current sequence.
   ScopedClosureRunner untrack_runner(
       BindOnce(&RunOrPostToTaskRunner, SequencedTaskRunnerHandle::Get(),
-               BindOnce(&RunIfNotCanceled, SequencedTaskRunnerHandle::Get(),
-                        flag, std::move(untrack_closure))));
+               BindOnce(&UntrackIfNotCanceled, flag)));
 
   *is_canceled_cb = BindRepeating(&IsCanceled, SequencedTaskRunnerHandle::Get(),
                                   flag, std::move(untrack_runner));
 
-  Track(id, std::move(flag));
-  return id;
+  return flag.id();
 }
 
 void CancelableTaskTracker::TryCancel(TaskId id) {
   DCHECK(sequence_checker_.CalledOnValidSequence());
 
-  const auto it = task_flags_.find(id);
-  if (it == task_flags_.end()) {
-    // Two possibilities:
-    //
-    //   1. The task has already been untracked.
-    //   2. The TaskId is bad or unknown.
-    //
-    // Since this function is best-effort, it's OK to ignore these.
-    return;
-  }
-  it->second->data.Set();
-
-  // Remove |id| from |task_flags_| immediately, since we have no further
+  // If the task has already been untracked, or if the TaskId is bad or unknown,
+  // this is a no-op. Since this function is best-effort, it's OK to ignore
+  // these.
+  //
+  // Otherwise, this untracks the task immediately, since we have no further
   // use for tracking it. This allows the reply closures (see
-  // PostTaskAndReply()) for cancelled tasks to be skipped, since they have
-  // no clean-up to perform.
-  task_flags_.erase(it);
+  // PostTaskAndReply()) for cancelled tasks to be skipped, since they have no
+  // clean-up to perform.
+  task_flags_->Free(id);
 }
 
 void CancelableTaskTracker::TryCancelAll() {
   DCHECK(sequence_checker_.CalledOnValidSequence());
-  for (const auto& it : task_flags_)
-    it.second->data.Set();
-  task_flags_.clear();
+  task_flags_->FreeAll();
 }
 
 bool CancelableTaskTracker::HasTrackedTasks() const {
   DCHECK(sequence_checker_.CalledOnValidSequence());
-  return !task_flags_.empty();
+  return task_flags_->HasLiveSlots();
 }
 
 // static
 void CancelableTaskTracker::RunIfNotCanceled(
     const scoped_refptr<SequencedTaskRunner>& origin_task_runner,
-    const scoped_refptr<TaskCancellationFlag>& flag,
+    const TaskCancellationFlag& flag,
     OnceClosure task) {
   // TODO(https://crbug.com/1009795): Record durations for executed tasks,
   // correlated with whether the task runs on a background or foreground
@@ -209,7 +316,7 @@ void CancelableTaskTracker::RunIfNotCanceled(
   // allow an experiment to assess the value of off-sequence cancelation.
 
   // Record canceled & off-sequence status for all tasks.
-  const bool was_canceled = flag->data.IsSet();
+  const bool was_canceled = flag.IsSet();
   const bool same_sequence = origin_task_runner->RunsTasksInCurrentSequence();
   const TaskStatus task_status =
       was_canceled ? (same_sequence ? TaskStatus::kSameSequenceCanceled
@@ -238,36 +345,33 @@ void CancelableTaskTracker::RunIfNotCanceled(
 // static
 void CancelableTaskTracker::RunThenUntrackIfNotCanceled(
     const scoped_refptr<SequencedTaskRunner>& origin_task_runner,
-    const scoped_refptr<TaskCancellationFlag>& flag,
-    OnceClosure task,
-    OnceClosure untrack) {
+    const TaskCancellationFlag& flag,
+    OnceClosure task) {
   RunIfNotCanceled(origin_task_runner, flag, std::move(task));
-  RunIfNotCanceled(origin_task_runner, flag, std::move(untrack));
+  UntrackIfNotCanceled(flag);
+}
+
+// static
+void CancelableTaskTracker::UntrackIfNotCanceled(
+    const TaskCancellationFlag& flag) {
+  // Canceling the task already untracked it, possibly along with the tracker.
+  flag.Set();
 }
 
 // static
 bool CancelableTaskTracker::IsCanceled(
     const scoped_refptr<SequencedTaskRunner>& origin_task_runner,
-    const scoped_refptr<TaskCancellationFlag>& flag,
+    const TaskCancellationFlag& flag,
     const ScopedClosureRunner& cleanup_runner) {
-  return flag->data.IsSet() &&
+  return flag.IsSet() &&
          (AllowOffSequenceTaskCancelation() ||
           origin_task_runner->RunsTasksInCurrentSequence());
 }
 
-void CancelableTaskTracker::Track(TaskId id,
-                                  scoped_refptr<TaskCancellationFlag> flag) {
-  DCHECK(sequence_checker_.CalledOnValidSequence());
-  CHECK(weak_this_);
-  bool success = task_flags_.insert(std::make_pair(id, std::move(flag))).second;
-  DCHECK(success);
-}
-
-void CancelableTaskTracker::Untrack(TaskId id) {
+CancelableTaskTracker::TaskCancellationFlag CancelableTaskTracker::Track() {
   DCHECK(sequence_checker_.CalledOnValidSequence());
   CHECK(weak_this_);
-  size_t num = task_flags_.erase(id);
-  DCHECK_EQ(1u, num);
+  return task_flags_->Allocate();
 }
 
 }  // namespace base
@@ -45,11 +45,9 @@
 #include "base/bind.h"
 #include "base/callback.h"
 #include "base/callback_helpers.h"
-#include "base/containers/small_map.h"
 #include "base/memory/ref_counted.h"
 #include "base/memory/weak_ptr.h"
 #include "base/sequence_checker.h"
-#include "base/synchronization/atomic_flag.h"
 #include "base/task/post_task_and_reply_with_result_internal.h"
 
 namespace base {
@@ -126,37 +124,32 @@ class BASE_EXPORT CancelableTaskTracker {
   bool HasTrackedTasks() const;
 
  private:
-  // Cancellation flags are ref-counted to ensure they remain valid even if the
-  // tracker and its calling thread are torn down while there are still
-  // cancelable tasks queued to the target TaskRunner.
-  // See https://crbug.com/918948.
-  using TaskCancellationFlag = RefCountedData<AtomicFlag>;
+  // The cancellation flags of the tracked tasks are slots of a slab, in a
+  // ref-counted table which tasks keep alive even if the tracker and its calling
+  // thread are torn down while there are still cancelable tasks queued to the
+  // target TaskRunner. See https://crbug.com/918948. Defined in the .cc file.
+  class TaskCancellationFlag;
+  class TaskCancellationFlagTable;
 
   static void RunIfNotCanceled(
       const scoped_refptr<SequencedTaskRunner>& origin_task_runner,
-      const scoped_refptr<TaskCancellationFlag>& flag,
+      const TaskCancellationFlag& flag,
       OnceClosure task);
   static void RunThenUntrackIfNotCanceled(
       const scoped_refptr<SequencedTaskRunner>& origin_task_runner,
-      const scoped_refptr<TaskCancellationFlag>& flag,
-      OnceClosure task,
-      OnceClosure untrack);
+      const TaskCancellationFlag& flag,
+      OnceClosure task);
+  static void UntrackIfNotCanceled(const TaskCancellationFlag& flag);
   static bool IsCanceled(
       const scoped_refptr<SequencedTaskRunner>& origin_task_runner,
-      const scoped_refptr<TaskCancellationFlag>& flag,
+      const TaskCancellationFlag& flag,
       const ScopedClosureRunner& cleanup_runner);
 
-  void Track(TaskId id, scoped_refptr<TaskCancellationFlag> flag);
-  void Untrack(TaskId id);
+  // Returns the flag of a new tracked task, whose TaskId is its id().
+  TaskCancellationFlag Track();
 
-  // Typically the number of tasks are 0-2 and occationally 3-4. But since
-  // this is a general API that could be used in unexpected ways, use a
-  // small_map instead of a flat_map to avoid falling over if there are many
-  // tasks.
-  small_map<std::map<TaskId, scoped_refptr<TaskCancellationFlag>>, 4>
-      task_flags_;
+  const scoped_refptr<TaskCancellationFlagTable> task_flags_;
 
-  TaskId next_id_ = 1;
   SequenceChecker sequence_checker_;
 
   // TODO(https://crbug.com/1009795): Remove once crasher is resolved.
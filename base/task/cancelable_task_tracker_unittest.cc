@@ -6,6 +6,7 @@
 
 #include <cstddef>
 #include <tuple>
+#include <vector>
 
 #include "base/bind.h"
 #include "base/callback_helpers.h"
@@ -295,6 +296,54 @@ TEST_F(CancelableTaskTrackerTest, HasTrackedTasksIsCancelledCancelAll) {
   EXPECT_FALSE(task_tracker_.HasTrackedTasks());
 }
 
+// Post a task, let it and its reply run, then post another task, which may
+// reuse the state of the first one. Canceling the first task ID should not
+// cancel the second task.
+TEST_F(CancelableTaskTrackerTest, TryCancelUntrackedTaskId) {
+  scoped_refptr<TestSimpleTaskRunner> test_task_runner(
+      new TestSimpleTaskRunner());
+
+  CancelableTaskTracker::TaskId first_task_id = task_tracker_.PostTask(
+      test_task_runner.get(), FROM_HERE, MakeExpectedRunClosure(FROM_HERE));
+  test_task_runner->RunUntilIdle();
+  RunLoop().RunUntilIdle();
+  EXPECT_FALSE(task_tracker_.HasTrackedTasks());
+
+  CancelableTaskTracker::TaskId second_task_id = task_tracker_.PostTask(
+      test_task_runner.get(), FROM_HERE, MakeExpectedRunClosure(FROM_HERE));
+  EXPECT_NE(first_task_id, second_task_id);
+
+  task_tracker_.TryCancel(first_task_id);
+  EXPECT_TRUE(task_tracker_.HasTrackedTasks());
+
+  test_task_runner->RunUntilIdle();
+  RunLoop().RunUntilIdle();
+  EXPECT_FALSE(task_tracker_.HasTrackedTasks());
+}
+
+// Post many tasks, cancel some of them by ID and then all of them. None of
+// them should run.
+TEST_F(CancelableTaskTrackerTest, CancelManyTasks) {
+  scoped_refptr<TestSimpleTaskRunner> test_task_runner(
+      new TestSimpleTaskRunner());
+
+  std::vector<CancelableTaskTracker::TaskId> task_ids;
+  for (int i = 0; i < 100; ++i) {
+    task_ids.push_back(task_tracker_.PostTaskAndReply(
+        test_task_runner.get(), FROM_HERE, MakeExpectedNotRunClosure(FROM_HERE),
+        MakeExpectedNotRunClosure(FROM_HERE)));
+  }
+  for (size_t i = 0; i < task_ids.size(); i += 3)
+    task_tracker_.TryCancel(task_ids[i]);
+  EXPECT_TRUE(task_tracker_.HasTrackedTasks());
+
+  task_tracker_.TryCancelAll();
+  EXPECT_FALSE(task_tracker_.HasTrackedTasks());
+
+  test_task_runner->RunUntilIdle();
+  RunLoop().RunUntilIdle();
+}
+
 // The death tests below make sure that calling task tracker member
 // functions from a thread different from its owner thread DCHECKs in
 // debug mode.
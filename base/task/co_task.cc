@@ -0,0 +1,206 @@
+// Copyright 2022 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "base/task/co_task.h"
+
+#include <stddef.h>
+#include <stdlib.h>
+
+#include <algorithm>
+#include <array>
+#include <new>
+#include <utility>
+#include <vector>
+
+#include "base/bits.h"
+#include "base/immediate_crash.h"
+#include "base/memory/raw_ptr.h"
+#include "base/synchronization/lock.h"
+#include "base/thread_annotations.h"
+#include "base/threading/sequence_local_storage_map.h"
+#include "base/threading/sequence_local_storage_slot.h"
+
+namespace base {
+namespace internal {
+
+namespace {
+
+// Frames are rounded up to a power of two between kMinFrameSize and
+// kMaxFrameSize. Larger frames aren't recycled.
+constexpr int kMinFrameSizeLog2 = 6;
+constexpr int kMaxFrameSizeLog2 = 12;
+constexpr size_t kNumSizeClasses = kMaxFrameSizeLog2 - kMinFrameSizeLog2 + 1;
+// Maximum number of free frames kept per size class.
+constexpr size_t kMaxFreeFramesPerSizeClass = 32;
+constexpr uint32_t kNoSizeClass = kNumSizeClasses;
+
+class CoroutineFrameArena;
+
+// Precedes each frame. Sized to keep the frame aligned for any type.
+struct alignas(alignof(std::max_align_t)) FrameHeader {
+  // Null if the frame isn't recycled.
+  raw_ptr<CoroutineFrameArena> arena = nullptr;
+  uint32_t size_class = kNoSizeClass;
+};
+
+// Recycles the frames allocated on a sequence. Frames are returned to the
+// arena they came from, from any sequence, so access is synchronized; the
+// lock is only contended when a frame completes on another sequence while the
+// owning sequence allocates. Each live frame holds a reference to its arena.
+class CoroutineFrameArena : public RefCountedThreadSafe<CoroutineFrameArena> {
+ public:
+  CoroutineFrameArena() = default;
+  CoroutineFrameArena(const CoroutineFrameArena&) = delete;
+  CoroutineFrameArena& operator=(const CoroutineFrameArena&) = delete;
+
+  FrameHeader* Allocate(uint32_t size_class) {
+    AddRef();
+    FrameHeader* header = nullptr;
+    {
+      AutoLock auto_lock(lock_);
+      std::vector<FrameHeader*>& free_frames = free_frames_[size_class];
+      if (!free_frames.empty()) {
+        header = free_frames.back();
+        free_frames.pop_back();
+      }
+    }
+    if (!header) {
+      void* memory = malloc(sizeof(FrameHeader) +
+                            (size_t{1} << (size_class + kMinFrameSizeLog2)));
+      CHECK(memory);
+      header = new (memory) FrameHeader();
+    }
+    header->arena = this;
+    header->size_class = size_class;
+    return header;
+  }
+
+  void Free(FrameHeader* header) {
+    {
+      AutoLock auto_lock(lock_);
+      std::vector<FrameHeader*>& free_frames =
+          free_frames_[header->size_class];
+      if (free_frames.size() < kMaxFreeFramesPerSizeClass) {
+        header->arena = nullptr;
+        free_frames.push_back(header);
+        header = nullptr;
+      }
+    }
+    if (header) {
+      header->arena = nullptr;
+      free(header);
+    }
+    Release();
+  }
+
+ private:
+  friend class RefCountedThreadSafe<CoroutineFrameArena>;
+
+  ~CoroutineFrameArena() {
+    for (auto& free_frames : free_frames_) {
+      for (FrameHeader* header : free_frames)
+        free(header);
+    }
+  }
+
+  Lock lock_;
+  std::array<std::vector<FrameHeader*>, kNumSizeClasses> free_frames_
+      GUARDED_BY(lock_);
+};
+
+CoroutineFrameArena* GetArenaForCurrentSequence() {
+  if (!SequenceLocalStorageMap::IsSetForCurrentThread())
+    return nullptr;
+  static SequenceLocalStorageSlot<scoped_refptr<CoroutineFrameArena>>
+      arena_slot;
+  scoped_refptr<CoroutineFrameArena>& arena = arena_slot.GetOrCreateValue();
+  if (!arena)
+    arena = MakeRefCounted<CoroutineFrameArena>();
+  return arena.get();
+}
+
+void RunResumer(CoroutineResumer resumer) {
+  resumer.Resume();
+}
+
+}  // namespace
+
+void* AllocateCoroutineFrame(size_t size) {
+  FrameHeader* header = nullptr;
+  CoroutineFrameArena* arena =
+      size <= (size_t{1} << kMaxFrameSizeLog2) ? GetArenaForCurrentSequence()
+                                                : nullptr;
+  if (arena) {
+    const int size_log2 = std::max(
+        bits::Log2Ceiling(static_cast<uint32_t>(size)), kMinFrameSizeLog2);
+    header = arena->Allocate(
+        static_cast<uint32_t>(size_log2 - kMinFrameSizeLog2));
+  } else {
+    void* memory = malloc(sizeof(FrameHeader) + size);
+    CHECK(memory);
+    header = new (memory) FrameHeader();
+    header->size_class = kNoSizeClass;
+  }
+  return header + 1;
+}
+
+void FreeCoroutineFrame(void* frame) {
+  FrameHeader* header = static_cast<FrameHeader*>(frame) - 1;
+  if (header->arena) {
+    header->arena->Free(header);
+    return;
+  }
+  free(header);
+}
+
+CoroutineResumer::CoroutineResumer(std::coroutine_handle<> handle,
+                                   std::coroutine_handle<> root)
+    : handle_(handle), root_(root) {
+  DCHECK(handle_);
+  DCHECK(root_);
+}
+
+CoroutineResumer::CoroutineResumer(CoroutineResumer&& other)
+    : handle_(std::exchange(other.handle_, nullptr)),
+      root_(std::exchange(other.root_, nullptr)) {}
+
+CoroutineResumer::~CoroutineResumer() {
+  if (root_)
+    root_.destroy();
+}
+
+void CoroutineResumer::Resume() {
+  DCHECK(handle_);
+  root_ = nullptr;
+  std::exchange(handle_, nullptr).resume();
+}
+
+void CoTaskPromiseBase::unhandled_exception() const noexcept {
+  IMMEDIATE_CRASH();
+}
+
+ResumeOnAwaiter::ResumeOnAwaiter(scoped_refptr<SequencedTaskRunner> task_runner,
+                                 const Location& from_here)
+    : task_runner_(std::move(task_runner)), from_here_(from_here) {
+  DCHECK(task_runner_);
+}
+
+ResumeOnAwaiter::ResumeOnAwaiter(ResumeOnAwaiter&& other) = default;
+
+ResumeOnAwaiter::~ResumeOnAwaiter() = default;
+
+void ResumeOnAwaiter::PostResumeTask(CoroutineResumer resumer) {
+  PostResumeTask(BindOnce(&RunResumer, std::move(resumer)));
+}
+
+void ResumeOnAwaiter::PostResumeTask(OnceClosure resume_task) {
+  // The task may destroy this awaiter, even while PostTask() runs if it's
+  // not posted.
+  scoped_refptr<SequencedTaskRunner> task_runner = std::move(task_runner_);
+  const Location from_here = from_here_;
+  task_runner->PostTask(from_here, std::move(resume_task));
+}
+
+}  // namespace internal
+}  // namespace base
@@ -0,0 +1,316 @@
+// Copyright 2022 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#ifndef BASE_TASK_CO_TASK_H_
+#define BASE_TASK_CO_TASK_H_
+
+#include <stddef.h>
+
+#include <coroutine>
+#include <utility>
+
+#include "base/base_export.h"
+#include "base/bind.h"
+#include "base/callback.h"
+#include "base/check.h"
+#include "base/location.h"
+#include "base/memory/ref_counted.h"
+#include "base/memory/weak_ptr.h"
+#include "base/task/coroutine_buildflags.h"
+#include "base/task/sequenced_task_runner.h"
+#include "third_party/abseil-cpp/absl/types/optional.h"
+
+#if !BUILDFLAG(ENABLE_COROUTINES)
+#error "base/task/co_task.h requires BASIUM_ENABLE_COROUTINES."
+#endif
+
+// C++20 coroutine support for posting tasks. A coroutine returning CoTask<T>
+// can move between sequences with co_await ResumeOn(), and await other
+// CoTasks:
+//
+//   CoTask<int> ComputeOnPool() {
+//     co_await ResumeOn(ThreadPool::CreateSequencedTaskRunner({}));
+//     co_return ExpensiveComputation();
+//   }
+//
+//   CoTask<void> Foo::Run(scoped_refptr<SequencedTaskRunner> reply_runner) {
+//     int result = co_await ComputeOnPool();
+//     // Canceled if |this| is destroyed while the result is computed.
+//     co_await ResumeOn(reply_runner, weak_factory_.GetWeakPtr());
+//     OnResult(result);
+//   }
+//
+//   foo->Run(SequencedTaskRunnerHandle::Get()).Start();
+//
+// Compared to chaining PostTaskAndReplyWithResult(), a pipeline of N hops
+// costs one coroutine frame per CoTask plus the task posted by each hop,
+// rather than a task, a reply callback and a result box per hop. Frames are
+// recycled through a per-sequence arena.
+//
+// A CoTask doesn't run until it's awaited or Start()ed. When a hop is
+// canceled, because its WeakPtr was invalidated or because its task was
+// deleted without running (e.g. at shutdown), the whole chain of awaiting
+// coroutines is destroyed without being resumed: locals of each frame are
+// destroyed, and the callback passed to Start() doesn't run.
+
+namespace base {
+
+template <typename T>
+class CoTask;
+
+namespace internal {
+
+// Allocates a coroutine frame from the arena of the current sequence, or from
+// the heap if there is no current sequence. Frames can be freed on any
+// sequence.
+BASE_EXPORT void* AllocateCoroutineFrame(size_t size);
+BASE_EXPORT void FreeCoroutineFrame(void* frame);
+
+// Owns a suspended chain of coroutines until it's resumed. Destroying it
+// without calling Resume() destroys the chain from its root.
+class BASE_EXPORT CoroutineResumer {
+ public:
+  CoroutineResumer(std::coroutine_handle<> handle,
+                   std::coroutine_handle<> root);
+  CoroutineResumer(CoroutineResumer&& other);
+  CoroutineResumer& operator=(CoroutineResumer&& other) = delete;
+  ~CoroutineResumer();
+
+  void Resume();
+
+ private:
+  std::coroutine_handle<> handle_;
+  std::coroutine_handle<> root_;
+};
+
+class BASE_EXPORT CoTaskPromiseBase {
+ public:
+  struct FinalAwaiter {
+    bool await_ready() const noexcept { return false; }
+
+    // Transfers control to the awaiting coroutine, or completes a coroutine
+    // that was started with Start().
+    template <typename Promise>
+    std::coroutine_handle<> await_suspend(
+        std::coroutine_handle<Promise> handle) noexcept {
+      Promise& promise = handle.promise();
+      if (promise.continuation_)
+        return promise.continuation_;
+      promise.RunOnDone();
+      handle.destroy();
+      return std::noop_coroutine();
+    }
+
+    void await_resume() const noexcept {}
+  };
+
+  static void* operator new(size_t size) {
+    return AllocateCoroutineFrame(size);
+  }
+  static void operator delete(void* frame) { FreeCoroutineFrame(frame); }
+
+  std::suspend_always initial_suspend() const noexcept { return {}; }
+  FinalAwaiter final_suspend() const noexcept { return {}; }
+  // Exceptions are disabled.
+  void unhandled_exception() const noexcept;
+
+  // The coroutine awaiting this one, if any.
+  std::coroutine_handle<> continuation_;
+  // The outermost coroutine of the chain, which owns all the others.
+  std::coroutine_handle<> root_;
+};
+
+template <typename T>
+class CoTaskPromise : public CoTaskPromiseBase {
+ public:
+  using OnDoneCallback = OnceCallback<void(T)>;
+
+  CoTask<T> get_return_object() {
+    return CoTask<T>(
+        std::coroutine_handle<CoTaskPromise>::from_promise(*this));
+  }
+
+  template <typename U>
+  void return_value(U&& value) {
+    result_.emplace(std::forward<U>(value));
+  }
+
+  T TakeResult() {
+    DCHECK(result_);
+    return std::move(*result_);
+  }
+
+  void RunOnDone() {
+    if (on_done_)
+      std::move(on_done_).Run(TakeResult());
+  }
+
+  OnDoneCallback on_done_;
+
+ private:
+  absl::optional<T> result_;
+};
+
+template <>
+class CoTaskPromise<void> : public CoTaskPromiseBase {
+ public:
+  using OnDoneCallback = OnceClosure;
+
+  CoTask<void> get_return_object();
+
+  void return_void() const {}
+  void TakeResult() const {}
+
+  void RunOnDone() {
+    if (on_done_)
+      std::move(on_done_).Run();
+  }
+
+  OnDoneCallback on_done_;
+};
+
+// Resumes the awaiting coroutine in a task posted to |task_runner_|.
+class BASE_EXPORT ResumeOnAwaiter {
+ public:
+  ResumeOnAwaiter(scoped_refptr<SequencedTaskRunner> task_runner,
+                  const Location& from_here);
+  ResumeOnAwaiter(ResumeOnAwaiter&& other);
+  ResumeOnAwaiter& operator=(ResumeOnAwaiter&& other) = delete;
+  ~ResumeOnAwaiter();
+
+  bool await_ready() const noexcept { return false; }
+
+  template <typename Promise>
+  void await_suspend(std::coroutine_handle<Promise> handle) {
+    PostResumeTask(CoroutineResumer(handle, handle.promise().root_));
+  }
+
+  void await_resume() const noexcept {}
+
+ protected:
+  // Posts a task that runs |resumer|. The coroutine, including this awaiter,
+  // may be resumed or destroyed as soon as the task is posted.
+  void PostResumeTask(CoroutineResumer resumer);
+  void PostResumeTask(OnceClosure resume_task);
+
+ private:
+  scoped_refptr<SequencedTaskRunner> task_runner_;
+  const Location from_here_;
+};
+
+// Same as ResumeOnAwaiter, but cancels the awaiting coroutine rather than
+// resuming it if |receiver_| is invalidated first.
+template <typename Receiver>
+class ResumeOnWeakPtrAwaiter : public ResumeOnAwaiter {
+ public:
+  ResumeOnWeakPtrAwaiter(scoped_refptr<SequencedTaskRunner> task_runner,
+                         WeakPtr<Receiver> receiver,
+                         const Location& from_here)
+      : ResumeOnAwaiter(std::move(task_runner), from_here),
+        receiver_(std::move(receiver)) {}
+
+  template <typename Promise>
+  void await_suspend(std::coroutine_handle<Promise> handle) {
+    PostResumeTask(
+        BindOnce(&ResumeOnWeakPtrAwaiter::ResumeIfValid, std::move(receiver_),
+                 CoroutineResumer(handle, handle.promise().root_)));
+  }
+
+ private:
+  static void ResumeIfValid(WeakPtr<Receiver> receiver,
+                            CoroutineResumer resumer) {
+    if (receiver)
+      resumer.Resume();
+  }
+
+  WeakPtr<Receiver> receiver_;
+};
+
+}  // namespace internal
+
+// The return type of a coroutine that produces a T. See the top of this file.
+template <typename T>
+class [[nodiscard]] CoTask {
+ public:
+  using promise_type = internal::CoTaskPromise<T>;
+  using OnDoneCallback = typename promise_type::OnDoneCallback;
+
+  CoTask(CoTask&& other) : handle_(std::exchange(other.handle_, nullptr)) {}
+  CoTask& operator=(CoTask&& other) {
+    if (this != &other) {
+      if (handle_)
+        handle_.destroy();
+      handle_ = std::exchange(other.handle_, nullptr);
+    }
+    return *this;
+  }
+  ~CoTask() {
+    if (handle_)
+      handle_.destroy();
+  }
+
+  // Runs the coroutine on the current sequence until it first suspends, and
+  // lets it run to completion on its own. |on_done| is run with the result
+  // on the sequence where the coroutine completes, unless it's canceled.
+  void Start(OnDoneCallback on_done = OnDoneCallback()) && {
+    DCHECK(handle_);
+    std::coroutine_handle<promise_type> handle =
+        std::exchange(handle_, nullptr);
+    handle.promise().on_done_ = std::move(on_done);
+    handle.promise().root_ = handle;
+    handle.resume();
+  }
+
+  // Awaiting a CoTask runs it on the current sequence, and resumes the
+  // awaiting coroutine where it completes.
+  bool await_ready() const noexcept { return false; }
+
+  template <typename Promise>
+  std::coroutine_handle<> await_suspend(
+      std::coroutine_handle<Promise> awaiting) noexcept {
+    DCHECK(handle_);
+    handle_.promise().continuation_ = awaiting;
+    handle_.promise().root_ = awaiting.promise().root_;
+    return handle_;
+  }
+
+  T await_resume() { return handle_.promise().TakeResult(); }
+
+ private:
+  friend promise_type;
+
+  explicit CoTask(std::coroutine_handle<promise_type> handle)
+      : handle_(handle) {}
+
+  std::coroutine_handle<promise_type> handle_;
+};
+
+inline CoTask<void> internal::CoTaskPromise<void>::get_return_object() {
+  return CoTask<void>(
+      std::coroutine_handle<CoTaskPromise>::from_promise(*this));
+}
+
+// Returns an awaitable that resumes the awaiting CoTask coroutine in a task
+// posted to |task_runner|.
+inline internal::ResumeOnAwaiter ResumeOn(
+    scoped_refptr<SequencedTaskRunner> task_runner,
+    const Location& from_here = Location::Current()) {
+  return internal::ResumeOnAwaiter(std::move(task_runner), from_here);
+}
+
+// Same as above, but the awaiting coroutine is canceled rather than resumed
+// if |receiver| is invalidated before the task runs. |task_runner| must run
+// tasks on the sequence to which |receiver| is bound.
+template <typename Receiver>
+internal::ResumeOnWeakPtrAwaiter<Receiver> ResumeOn(
+    scoped_refptr<SequencedTaskRunner> task_runner,
+    WeakPtr<Receiver> receiver,
+    const Location& from_here = Location::Current()) {
+  return internal::ResumeOnWeakPtrAwaiter<Receiver>(
+      std::move(task_runner), std::move(receiver), from_here);
+}
+
+}  // namespace base
+
+#endif  // BASE_TASK_CO_TASK_H_
@@ -0,0 +1,171 @@
+// Copyright 2022 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "base/task/co_task.h"
+
+#include <utility>
+
+#include "base/bind.h"
+#include "base/callback_helpers.h"
+#include "base/memory/scoped_refptr.h"
+#include "base/memory/weak_ptr.h"
+#include "base/run_loop.h"
+#include "base/task/sequenced_task_runner.h"
+#include "base/task/thread_pool.h"
+#include "base/test/bind.h"
+#include "base/test/task_environment.h"
+#include "base/test/test_simple_task_runner.h"
+#include "base/threading/sequenced_task_runner_handle.h"
+#include "testing/gtest/include/gtest/gtest.h"
+
+namespace base {
+
+namespace {
+
+CoTask<int> MultiplyOn(scoped_refptr<SequencedTaskRunner> task_runner,
+                       int value) {
+  co_await ResumeOn(task_runner);
+  EXPECT_TRUE(task_runner->RunsTasksInCurrentSequence());
+  co_return value * 2;
+}
+
+CoTask<int> Pipeline(scoped_refptr<SequencedTaskRunner> pool_task_runner,
+                     scoped_refptr<SequencedTaskRunner> reply_task_runner) {
+  int value = co_await MultiplyOn(pool_task_runner, 1);
+  value = co_await MultiplyOn(pool_task_runner, value);
+  co_await ResumeOn(reply_task_runner);
+  EXPECT_TRUE(reply_task_runner->RunsTasksInCurrentSequence());
+  co_return value + 1;
+}
+
+CoTask<void> RunAfterHop(scoped_refptr<SequencedTaskRunner> task_runner,
+                         ScopedClosureRunner on_destroyed,
+                         OnceClosure on_resumed) {
+  co_await ResumeOn(task_runner);
+  std::move(on_resumed).Run();
+}
+
+class Receiver {
+ public:
+  CoTask<void> HopAndRun(scoped_refptr<SequencedTaskRunner> task_runner,
+                         ScopedClosureRunner on_destroyed,
+                         OnceClosure on_resumed) {
+    co_await ResumeOn(task_runner, weak_factory_.GetWeakPtr());
+    std::move(on_resumed).Run();
+  }
+
+  void InvalidateWeakPtrs() { weak_factory_.InvalidateWeakPtrs(); }
+
+ private:
+  WeakPtrFactory<Receiver> weak_factory_{this};
+};
+
+}  // namespace
+
+TEST(CoTaskTest, NotStarted) {
+  bool resumed = false;
+  bool destroyed = false;
+  auto task_runner = MakeRefCounted<TestSimpleTaskRunner>();
+  {
+    CoTask<void> task = RunAfterHop(
+        task_runner, ScopedClosureRunner(BindLambdaForTesting([&]() {
+          destroyed = true;
+        })),
+        BindLambdaForTesting([&]() { resumed = true; }));
+    EXPECT_FALSE(task_runner->HasPendingTask());
+  }
+  EXPECT_TRUE(destroyed);
+  EXPECT_FALSE(resumed);
+}
+
+TEST(CoTaskTest, MultiHopPipeline) {
+  test::TaskEnvironment task_environment;
+  RunLoop run_loop;
+  int result = 0;
+  Pipeline(ThreadPool::CreateSequencedTaskRunner({}),
+           SequencedTaskRunnerHandle::Get())
+      .Start(BindLambdaForTesting([&](int value) {
+        result = value;
+        run_loop.Quit();
+      }));
+  run_loop.Run();
+  EXPECT_EQ(result, 5);
+}
+
+// Verify that a coroutine whose resume task is deleted without running is
+// destroyed without being resumed.
+TEST(CoTaskTest, DestroyedWhenTaskIsDeleted) {
+  bool resumed = false;
+  bool destroyed = false;
+  bool done = false;
+  auto task_runner = MakeRefCounted<TestSimpleTaskRunner>();
+  RunAfterHop(task_runner, ScopedClosureRunner(BindLambdaForTesting([&]() {
+                destroyed = true;
+              })),
+              BindLambdaForTesting([&]() { resumed = true; }))
+      .Start(BindLambdaForTesting([&]() { done = true; }));
+  EXPECT_TRUE(task_runner->HasPendingTask());
+  EXPECT_FALSE(destroyed);
+
+  task_runner->ClearPendingTasks();
+  EXPECT_TRUE(destroyed);
+  EXPECT_FALSE(resumed);
+  EXPECT_FALSE(done);
+}
+
+TEST(CoTaskTest, ResumedWhenWeakPtrIsValid) {
+  bool resumed = false;
+  bool done = false;
+  auto task_runner = MakeRefCounted<TestSimpleTaskRunner>();
+  Receiver receiver;
+  receiver
+      .HopAndRun(task_runner, ScopedClosureRunner(),
+                 BindLambdaForTesting([&]() { resumed = true; }))
+      .Start(BindLambdaForTesting([&]() { done = true; }));
+  task_runner->RunPendingTasks();
+  EXPECT_TRUE(resumed);
+  EXPECT_TRUE(done);
+}
+
+// Verify that invalidating the WeakPtr of a hop cancels the coroutine.
+TEST(CoTaskTest, CanceledWhenWeakPtrIsInvalidated) {
+  bool resumed = false;
+  bool destroyed = false;
+  bool done = false;
+  auto task_runner = MakeRefCounted<TestSimpleTaskRunner>();
+  Receiver receiver;
+  receiver
+      .HopAndRun(task_runner, ScopedClosureRunner(BindLambdaForTesting([&]() {
+                   destroyed = true;
+                 })),
+                 BindLambdaForTesting([&]() { resumed = true; }))
+      .Start(BindLambdaForTesting([&]() { done = true; }));
+
+  receiver.InvalidateWeakPtrs();
+  task_runner->RunPendingTasks();
+  EXPECT_TRUE(destroyed);
+  EXPECT_FALSE(resumed);
+  EXPECT_FALSE(done);
+}
+
+// Verify that frames allocated on a sequence can be freed on another one.
+TEST(CoTaskTest, FramesFreedOnAnotherSequence) {
+  test::TaskEnvironment task_environment;
+  auto pool_task_runner = ThreadPool::CreateSequencedTaskRunner({});
+  constexpr int kNumTasks = 100;
+  int num_done = 0;
+  RunLoop run_loop;
+  RepeatingClosure quit_closure = run_loop.QuitClosure();
+  for (int i = 0; i < kNumTasks; ++i) {
+    // Completes on |pool_task_runner|, which frees the frame there.
+    MultiplyOn(pool_task_runner, i).Start(BindLambdaForTesting([&](int) {
+      if (++num_done == kNumTasks)
+        quit_closure.Run();
+    }));
+  }
+  run_loop.Run();
+  EXPECT_EQ(num_done, kNumTasks);
+}
+
+}  // namespace base
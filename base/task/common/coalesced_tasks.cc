@@ -0,0 +1,88 @@
+// Copyright 2022 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "base/task/common/coalesced_tasks.h"
+
+#include <memory>
+#include <utility>
+
+#include "base/bind.h"
+#include "base/check.h"
+#include "base/metrics/histogram_macros.h"
+
+namespace base {
+namespace internal {
+
+// Owned by the closure posted to the sequence for a key. Takes the task
+// pending for that key when the closure runs, or is destroyed without running
+// (e.g. at shutdown).
+class CoalescedTasks::PendingTask {
+ public:
+  PendingTask(scoped_refptr<CoalescedTasks> coalesced_tasks, const void* key)
+      : coalesced_tasks_(std::move(coalesced_tasks)), key_(key) {}
+  PendingTask(const PendingTask&) = delete;
+  PendingTask& operator=(const PendingTask&) = delete;
+
+  ~PendingTask() {
+    if (coalesced_tasks_)
+      coalesced_tasks_->TakeTask(key_);
+  }
+
+  static void Run(std::unique_ptr<PendingTask> pending_task) {
+    std::exchange(pending_task->coalesced_tasks_, nullptr)
+        ->TakeTask(pending_task->key_)
+        .Run();
+  }
+
+ private:
+  scoped_refptr<CoalescedTasks> coalesced_tasks_;
+  const void* const key_;
+};
+
+CoalescedTasks::CoalescedTasks() = default;
+
+CoalescedTasks::~CoalescedTasks() = default;
+
+OnceClosure CoalescedTasks::Coalesce(const void* key,
+                                     OnceClosure task,
+                                     CoalescingPolicy policy) {
+  DCHECK(task);
+  {
+    AutoLock auto_lock(lock_);
+    auto it = pending_tasks_.find(key);
+    if (it == pending_tasks_.end()) {
+      pending_tasks_.emplace(key, Entry{std::move(task)});
+    } else {
+      ++it->second.num_coalesced;
+      if (policy == CoalescingPolicy::kReplacePending)
+        std::swap(it->second.task, task);
+      // The task that won't run is destroyed after |lock_| is released, since
+      // its destructors may post coalesced tasks.
+      return OnceClosure();
+    }
+  }
+  return BindOnce(&PendingTask::Run,
+                  std::make_unique<PendingTask>(WrapRefCounted(this), key));
+}
+
+size_t CoalescedTasks::GetNumPendingKeysForTesting() const {
+  AutoLock auto_lock(lock_);
+  return pending_tasks_.size();
+}
+
+OnceClosure CoalescedTasks::TakeTask(const void* key) {
+  Entry entry;
+  {
+    AutoLock auto_lock(lock_);
+    auto it = pending_tasks_.find(key);
+    DCHECK(it != pending_tasks_.end());
+    entry = std::move(it->second);
+    pending_tasks_.erase(it);
+  }
+  UMA_HISTOGRAM_COUNTS_100("Scheduler.CoalescedTasks", entry.num_coalesced);
+  return std::move(entry.task);
+}
+
+}  // namespace internal
+}  // namespace base
@@ -0,0 +1,70 @@
+// Copyright 2022 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#ifndef BASE_TASK_COMMON_COALESCED_TASKS_H_
+#define BASE_TASK_COMMON_COALESCED_TASKS_H_
+
+#include "base/base_export.h"
+#include "base/callback.h"
+#include "base/containers/flat_map.h"
+#include "base/memory/ref_counted.h"
+#include "base/synchronization/lock.h"
+#include "base/task/sequenced_task_runner.h"
+#include "base/thread_annotations.h"
+
+namespace base {
+namespace internal {
+
+// Holds the closures of the tasks pending on a sequence which were posted with
+// SequencedTaskRunner::PostCoalescedTask(), by key. The sequence's queue only
+// holds one task per key, which runs the latest closure held for that key.
+//
+// The number of posts coalesced into each task is recorded in the
+// Scheduler.CoalescedTasks histogram when it runs or is dropped.
+//
+// This class is thread-safe.
+class BASE_EXPORT CoalescedTasks
+    : public RefCountedThreadSafe<CoalescedTasks> {
+ public:
+  using CoalescingPolicy = SequencedTaskRunner::CoalescingPolicy;
+
+  CoalescedTasks();
+  CoalescedTasks(const CoalescedTasks&) = delete;
+  CoalescedTasks& operator=(const CoalescedTasks&) = delete;
+
+  // If a task for |key| is pending, coalesces |task| into it according to
+  // |policy| and returns a null closure. Otherwise, returns a closure which the
+  // caller must post to the sequence, and which runs the latest task coalesced
+  // for |key|. Once that closure starts running, or is destroyed without
+  // running, the next call for |key| returns a new closure.
+  [[nodiscard]] OnceClosure Coalesce(const void* key,
+                                     OnceClosure task,
+                                     CoalescingPolicy policy);
+
+  // Returns the number of keys with a pending task.
+  size_t GetNumPendingKeysForTesting() const;
+
+ private:
+  friend class RefCountedThreadSafe<CoalescedTasks>;
+  class PendingTask;
+
+  struct Entry {
+    OnceClosure task;
+    // The number of posts coalesced into |task|.
+    int num_coalesced = 0;
+  };
+
+  ~CoalescedTasks();
+
+  // Removes and returns the task pending for |key|.
+  OnceClosure TakeTask(const void* key);
+
+  mutable Lock lock_;
+  flat_map<const void*, Entry> pending_tasks_ GUARDED_BY(lock_);
+};
+
+}  // namespace internal
+}  // namespace base
+
+#endif  // BASE_TASK_COMMON_COALESCED_TASKS_H_
@@ -0,0 +1,130 @@
+// Copyright 2022 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "base/task/common/coalesced_tasks.h"
+
+#include <vector>
+
+#include "base/bind.h"
+#include "base/callback_helpers.h"
+#include "base/test/bind.h"
+#include "base/test/metrics/histogram_tester.h"
+#include "testing/gmock/include/gmock/gmock.h"
+#include "testing/gtest/include/gtest/gtest.h"
+
+namespace base {
+namespace internal {
+
+namespace {
+
+using CoalescingPolicy = CoalescedTasks::CoalescingPolicy;
+using ::testing::ElementsAre;
+
+class CoalescedTasksTest : public testing::Test {
+ protected:
+  OnceClosure Coalesce(const void* key,
+                       int value,
+                       CoalescingPolicy policy =
+                           CoalescingPolicy::kReplacePending) {
+    return coalesced_tasks_->Coalesce(
+        key, BindLambdaForTesting([this, value]() { runs_.push_back(value); }),
+        policy);
+  }
+
+  const scoped_refptr<CoalescedTasks> coalesced_tasks_ =
+      MakeRefCounted<CoalescedTasks>();
+  std::vector<int> runs_;
+  const int key_a_ = 0;
+  const int key_b_ = 0;
+};
+
+}  // namespace
+
+TEST_F(CoalescedTasksTest, ReplacePending) {
+  OnceClosure pending_task = Coalesce(&key_a_, 1);
+  ASSERT_TRUE(pending_task);
+  EXPECT_FALSE(Coalesce(&key_a_, 2));
+  EXPECT_FALSE(Coalesce(&key_a_, 3));
+
+  std::move(pending_task).Run();
+  EXPECT_THAT(runs_, ElementsAre(3));
+  EXPECT_EQ(0u, coalesced_tasks_->GetNumPendingKeysForTesting());
+}
+
+TEST_F(CoalescedTasksTest, KeepPending) {
+  OnceClosure pending_task = Coalesce(&key_a_, 1);
+  ASSERT_TRUE(pending_task);
+  EXPECT_FALSE(Coalesce(&key_a_, 2, CoalescingPolicy::kKeepPending));
+
+  std::move(pending_task).Run();
+  EXPECT_THAT(runs_, ElementsAre(1));
+}
+
+TEST_F(CoalescedTasksTest, Keys) {
+  OnceClosure pending_task_a = Coalesce(&key_a_, 1);
+  OnceClosure pending_task_b = Coalesce(&key_b_, 2);
+  ASSERT_TRUE(pending_task_a);
+  ASSERT_TRUE(pending_task_b);
+  EXPECT_EQ(2u, coalesced_tasks_->GetNumPendingKeysForTesting());
+
+  std::move(pending_task_b).Run();
+  std::move(pending_task_a).Run();
+  EXPECT_THAT(runs_, ElementsAre(2, 1));
+}
+
+TEST_F(CoalescedTasksTest, PostWhileRunning) {
+  OnceClosure pending_task = coalesced_tasks_->Coalesce(
+      &key_a_, BindLambdaForTesting([&]() {
+        // The running task is no longer pending.
+        OnceClosure next_pending_task = Coalesce(&key_a_, 2);
+        ASSERT_TRUE(next_pending_task);
+        std::move(next_pending_task).Run();
+      }),
+      CoalescingPolicy::kReplacePending);
+  std::move(pending_task).Run();
+  EXPECT_THAT(runs_, ElementsAre(2));
+}
+
+TEST_F(CoalescedTasksTest, DestroyedWithoutRunning) {
+  OnceClosure pending_task = Coalesce(&key_a_, 1);
+  ASSERT_TRUE(pending_task);
+  pending_task.Reset();
+  EXPECT_EQ(0u, coalesced_tasks_->GetNumPendingKeysForTesting());
+
+  pending_task = Coalesce(&key_a_, 2);
+  ASSERT_TRUE(pending_task);
+  std::move(pending_task).Run();
+  EXPECT_THAT(runs_, ElementsAre(2));
+}
+
+// A task that won't run can post a coalesced task when it's destroyed.
+TEST_F(CoalescedTasksTest, ReplacedTaskCoalescesOnDestruction) {
+  OnceClosure pending_task = coalesced_tasks_->Coalesce(
+      &key_a_,
+      BindOnce([](ScopedClosureRunner) {},
+               ScopedClosureRunner(BindLambdaForTesting(
+                   [&]() { EXPECT_FALSE(Coalesce(&key_a_, 3)); }))),
+      CoalescingPolicy::kReplacePending);
+  ASSERT_TRUE(pending_task);
+  EXPECT_FALSE(Coalesce(&key_a_, 2));
+
+  std::move(pending_task).Run();
+  EXPECT_THAT(runs_, ElementsAre(3));
+}
+
+TEST_F(CoalescedTasksTest, Histogram) {
+  HistogramTester histogram_tester;
+  OnceClosure pending_task_a = Coalesce(&key_a_, 1);
+  EXPECT_FALSE(Coalesce(&key_a_, 2));
+  EXPECT_FALSE(Coalesce(&key_a_, 3, CoalescingPolicy::kKeepPending));
+  OnceClosure pending_task_b = Coalesce(&key_b_, 4);
+
+  std::move(pending_task_a).Run();
+  pending_task_b.Reset();
+  histogram_tester.ExpectBucketCount("Scheduler.CoalescedTasks", 2, 1);
+  histogram_tester.ExpectBucketCount("Scheduler.CoalescedTasks", 0, 1);
+}
+
+}  // namespace internal
+}  // namespace base
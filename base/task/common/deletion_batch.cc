@@ -0,0 +1,74 @@
+// Copyright 2022 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "base/task/common/deletion_batch.h"
+
+#include <memory>
+#include <utility>
+
+#include "base/bind.h"
+#include "base/check.h"
+
+namespace base {
+namespace internal {
+
+// Owned by the closure returned by TakeClosure(). Closes the batch when the
+// closure runs, or is destroyed without running.
+class DeletionBatch::PendingRun {
+ public:
+  explicit PendingRun(scoped_refptr<DeletionBatch> batch)
+      : batch_(std::move(batch)) {}
+  PendingRun(const PendingRun&) = delete;
+  PendingRun& operator=(const PendingRun&) = delete;
+
+  ~PendingRun() {
+    if (batch_)
+      batch_->Close();
+  }
+
+  static void Run(std::unique_ptr<PendingRun> pending_run) {
+    // The deletions run after the lock is released, since destructors may
+    // post more deletions to the sequence.
+    for (const Deletion& deletion :
+         std::exchange(pending_run->batch_, nullptr)->Close()) {
+      deletion.deleter(deletion.object);
+    }
+  }
+
+ private:
+  scoped_refptr<DeletionBatch> batch_;
+};
+
+DeletionBatch::DeletionBatch() = default;
+
+DeletionBatch::~DeletionBatch() = default;
+
+bool DeletionBatch::TryAdd(Deleter deleter, const void* object) {
+  DCHECK(deleter);
+  AutoLock auto_lock(lock_);
+  if (closed_ || deletions_.size() == kMaxSize)
+    return false;
+  deletions_.push_back({deleter, object});
+  return true;
+}
+
+OnceClosure DeletionBatch::TakeClosure() {
+  return BindOnce(&PendingRun::Run,
+                  std::make_unique<PendingRun>(WrapRefCounted(this)));
+}
+
+size_t DeletionBatch::GetSizeForTesting() const {
+  AutoLock auto_lock(lock_);
+  return deletions_.size();
+}
+
+std::vector<DeletionBatch::Deletion> DeletionBatch::Close() {
+  AutoLock auto_lock(lock_);
+  DCHECK(!closed_);
+  closed_ = true;
+  return std::move(deletions_);
+}
+
+}  // namespace internal
+}  // namespace base
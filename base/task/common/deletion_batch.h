@@ -0,0 +1,74 @@
+// Copyright 2022 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#ifndef BASE_TASK_COMMON_DELETION_BATCH_H_
+#define BASE_TASK_COMMON_DELETION_BATCH_H_
+
+#include <stddef.h>
+
+#include <vector>
+
+#include "base/base_export.h"
+#include "base/callback.h"
+#include "base/memory/ref_counted.h"
+#include "base/synchronization/lock.h"
+#include "base/thread_annotations.h"
+
+namespace base {
+namespace internal {
+
+// Holds deletions posted with SequencedTaskRunner::DeleteSoon() and
+// ReleaseSoon(), and runs them in order from a single task instead of one task
+// per object. Whoever posts that task must only add deletions to the batch
+// while the task is still the last one posted to its sequence, so that each
+// object is deleted after the tasks posted before it.
+//
+// This class is thread-safe.
+class BASE_EXPORT DeletionBatch : public RefCountedThreadSafe<DeletionBatch> {
+ public:
+  using Deleter = void (*)(const void*);
+
+  // The maximum number of deletions in a batch, which bounds how long its task
+  // runs.
+  static constexpr size_t kMaxSize = 256;
+
+  DeletionBatch();
+  DeletionBatch(const DeletionBatch&) = delete;
+  DeletionBatch& operator=(const DeletionBatch&) = delete;
+
+  // Adds the deletion of |object| by |deleter| to the batch and returns true,
+  // unless the batch is full or its closure started running or was destroyed.
+  [[nodiscard]] bool TryAdd(Deleter deleter, const void* object);
+
+  // Returns the closure which runs the deletions added to the batch, in order.
+  // Must be called once. If the closure is destroyed without running (e.g. at
+  // shutdown), the objects of the batch are leaked, like those of a dropped
+  // DeleteSoon() task.
+  [[nodiscard]] OnceClosure TakeClosure();
+
+  size_t GetSizeForTesting() const;
+
+ private:
+  friend class RefCountedThreadSafe<DeletionBatch>;
+  class PendingRun;
+
+  struct Deletion {
+    Deleter deleter;
+    const void* object;
+  };
+
+  ~DeletionBatch();
+
+  // Stops accepting deletions and returns those added so far.
+  std::vector<Deletion> Close();
+
+  mutable Lock lock_;
+  bool closed_ GUARDED_BY(lock_) = false;
+  std::vector<Deletion> deletions_ GUARDED_BY(lock_);
+};
+
+}  // namespace internal
+}  // namespace base
+
+#endif  // BASE_TASK_COMMON_DELETION_BATCH_H_
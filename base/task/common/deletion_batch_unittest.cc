@@ -0,0 +1,85 @@
+// Copyright 2022 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "base/task/common/deletion_batch.h"
+
+#include <vector>
+
+#include "base/callback.h"
+#include "testing/gmock/include/gmock/gmock.h"
+#include "testing/gtest/include/gtest/gtest.h"
+
+namespace base {
+namespace internal {
+
+namespace {
+
+using ::testing::ElementsAre;
+
+std::vector<int>* g_deleted = nullptr;
+DeletionBatch* g_batch = nullptr;
+
+void RecordDeletion(const void* object) {
+  g_deleted->push_back(*static_cast<const int*>(object));
+}
+
+class DeletionBatchTest : public testing::Test {
+ protected:
+  DeletionBatchTest() { g_deleted = &deleted_; }
+  ~DeletionBatchTest() override { g_deleted = nullptr; }
+
+  const scoped_refptr<DeletionBatch> batch_ = MakeRefCounted<DeletionBatch>();
+  std::vector<int> deleted_;
+  const int objects_[3] = {1, 2, 3};
+};
+
+}  // namespace
+
+TEST_F(DeletionBatchTest, RunsInOrder) {
+  OnceClosure closure = batch_->TakeClosure();
+  for (const int& object : objects_)
+    EXPECT_TRUE(batch_->TryAdd(&RecordDeletion, &object));
+  EXPECT_TRUE(deleted_.empty());
+
+  std::move(closure).Run();
+  EXPECT_THAT(deleted_, ElementsAre(1, 2, 3));
+  EXPECT_EQ(0u, batch_->GetSizeForTesting());
+}
+
+TEST_F(DeletionBatchTest, ClosedOnceRunning) {
+  OnceClosure closure = batch_->TakeClosure();
+  EXPECT_TRUE(batch_->TryAdd(
+      [](const void* object) {
+        RecordDeletion(object);
+        // Deletions can't be added to the running batch.
+        static const int kLate = 0;
+        EXPECT_FALSE(g_batch->TryAdd(&RecordDeletion, &kLate));
+      },
+      &objects_[0]));
+  g_batch = batch_.get();
+  std::move(closure).Run();
+  g_batch = nullptr;
+  EXPECT_THAT(deleted_, ElementsAre(1));
+}
+
+TEST_F(DeletionBatchTest, DestroyedWithoutRunning) {
+  OnceClosure closure = batch_->TakeClosure();
+  EXPECT_TRUE(batch_->TryAdd(&RecordDeletion, &objects_[0]));
+  closure.Reset();
+  EXPECT_FALSE(batch_->TryAdd(&RecordDeletion, &objects_[1]));
+  EXPECT_TRUE(deleted_.empty());
+}
+
+TEST_F(DeletionBatchTest, MaxSize) {
+  OnceClosure closure = batch_->TakeClosure();
+  for (size_t i = 0; i < DeletionBatch::kMaxSize; i++)
+    EXPECT_TRUE(batch_->TryAdd(&RecordDeletion, &objects_[0]));
+  EXPECT_FALSE(batch_->TryAdd(&RecordDeletion, &objects_[1]));
+
+  std::move(closure).Run();
+  EXPECT_EQ(DeletionBatch::kMaxSize, deleted_.size());
+}
+
+}  // namespace internal
+}  // namespace base
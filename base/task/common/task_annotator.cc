@@ -7,6 +7,7 @@
 #include <array>
 
 #include "base/check_op.h"
+#include "base/compiler_specific.h"
 #include "base/debug/activity_tracker.h"
 #include "base/debug/alias.h"
 #include "base/hash/md5.h"
@@ -16,6 +17,7 @@
 #include "base/threading/thread_local.h"
 #include "base/trace_event/base_tracing.h"
 #include "base/tracing_buildflags.h"
+#include "third_party/abseil-cpp/absl/types/optional.h"
 
 #if BUILDFLAG(ENABLE_BASE_TRACING)
 #include "third_party/perfetto/protos/perfetto/trace/track_event/chrome_mojo_event_info.pbzero.h"  // nogncheck
@@ -46,6 +48,32 @@ GetTLSForCurrentScopedIpcHash() {
   return instance.get();
 }
 
+// Sets the IPC context of |pending_task| from the ScopedSetIpcHash in scope, if
+// any.
+void SetIpcContext(PendingTask* pending_task) {
+  DCHECK(!pending_task->ipc_interface_name);
+  DCHECK(!pending_task->ipc_hash);
+  auto* current_ipc_hash = GetTLSForCurrentScopedIpcHash()->Get();
+  if (current_ipc_hash) {
+    pending_task->ipc_interface_name = current_ipc_hash->GetIpcInterfaceName();
+    pending_task->ipc_hash = current_ipc_hash->GetIpcHash();
+  }
+}
+
+// Runs |pending_task| as the current task of the thread. Inlined, to keep
+// RunTaskImpl() as the caller of the task in stack traces.
+ALWAYS_INLINE void RunAsCurrentTask(PendingTask& pending_task) {
+  auto* tls = GetTLSForCurrentPendingTask();
+  auto* previous_pending_task = tls->Get();
+  tls->Set(&pending_task);
+
+  if (g_task_annotator_observer)
+    g_task_annotator_observer->BeforeRunTask(&pending_task);
+  std::move(pending_task.task).Run();
+
+  tls->Set(previous_pending_task);
+}
+
 }  // namespace
 
 const PendingTask* TaskAnnotator::CurrentTaskForThread() {
@@ -53,6 +81,8 @@ const PendingTask* TaskAnnotator::CurrentTaskForThread() {
 }
 
 TaskAnnotator::TaskAnnotator() = default;
+TaskAnnotator::TaskAnnotator(Bookkeeping bookkeeping)
+    : bookkeeping_(bookkeeping) {}
 TaskAnnotator::~TaskAnnotator() = default;
 
 void TaskAnnotator::WillQueueTask(perfetto::StaticString trace_event_name,
@@ -69,14 +99,17 @@ void TaskAnnotator::WillQueueTask(perfetto::StaticString trace_event_name,
   if (pending_task->task_backtrace[0])
     return;
 
-  DCHECK(!pending_task->ipc_interface_name);
-  DCHECK(!pending_task->ipc_hash);
-  auto* current_ipc_hash = GetTLSForCurrentScopedIpcHash()->Get();
-  if (current_ipc_hash) {
-    pending_task->ipc_interface_name = current_ipc_hash->GetIpcInterfaceName();
-    pending_task->ipc_hash = current_ipc_hash->GetIpcHash();
+  if (bookkeeping_ == Bookkeeping::kLean) {
+    bool toplevel_ipc_enabled;
+    TRACE_EVENT_CATEGORY_GROUP_ENABLED(
+        TRACE_DISABLED_BY_DEFAULT("toplevel.ipc"), &toplevel_ipc_enabled);
+    if (toplevel_ipc_enabled)
+      SetIpcContext(pending_task);
+    return;
   }
 
+  SetIpcContext(pending_task);
+
   const auto* parent_task = CurrentTaskForThread();
   if (!parent_task)
     return;
@@ -91,11 +124,19 @@ void TaskAnnotator::WillQueueTask(perfetto::StaticString trace_event_name,
 }
 
 void TaskAnnotator::RunTaskImpl(PendingTask& pending_task) {
-  debug::ScopedTaskRunActivity task_activity(pending_task);
+  // Without a GlobalActivityTracker, there is no activity to record.
+  absl::optional<debug::ScopedTaskRunActivity> task_activity;
+  if (UNLIKELY(debug::GlobalActivityTracker::Get()))
+    task_activity.emplace(pending_task);
 
   TRACE_HEAP_PROFILER_API_SCOPED_TASK_EXECUTION(
       pending_task.posted_from.file_name());
 
+  if (bookkeeping_ == Bookkeeping::kLean) {
+    RunAsCurrentTask(pending_task);
+    return;
+  }
+
   // Before running the task, store the IPC context and the task backtrace with
   // the chain of PostTasks that resulted in this call and deliberately alias it
   // to ensure it is on the stack if the task crashes. Be careful not to assume
@@ -126,15 +167,7 @@ void TaskAnnotator::RunTaskImpl(PendingTask& pending_task) {
       reinterpret_cast<void*>(pending_task.ipc_hash);
   debug::Alias(&task_backtrace);
 
-  auto* tls = GetTLSForCurrentPendingTask();
-  auto* previous_pending_task = tls->Get();
-  tls->Set(&pending_task);
-
-  if (g_task_annotator_observer)
-    g_task_annotator_observer->BeforeRunTask(&pending_task);
-  std::move(pending_task.task).Run();
-
-  tls->Set(previous_pending_task);
+  RunAsCurrentTask(pending_task);
 
   // Stomp the markers. Otherwise they can stick around on the unused parts of
   // stack and cause |task_backtrace| to be associated with an unrelated stack
@@ -31,9 +31,25 @@ class BASE_EXPORT TaskAnnotator {
   // to be used only from within generated IPC handler dispatch code.
   class ScopedSetIpcHash;
 
+  // What the annotator records about each task, besides what tracing, the
+  // activity tracker, the heap profiler and the ObserverForTesting record when
+  // they are enabled.
+  enum class Bookkeeping {
+    // The IPC context of the task, and the chain of PostTask() callers which
+    // led to it, kept on the stack while the task runs to show up in crash
+    // dumps.
+    kFull,
+    // Only the IPC context, and only when "toplevel.ipc" tracing is enabled as
+    // the task is posted. For threads running many very short tasks, where the
+    // bookkeeping is a large part of the cost of a task. Their tasks, and the
+    // tasks these post, don't have a backtrace.
+    kLean,
+  };
+
   static const PendingTask* CurrentTaskForThread();
 
   TaskAnnotator();
+  explicit TaskAnnotator(Bookkeeping bookkeeping);
 
   TaskAnnotator(const TaskAnnotator&) = delete;
   TaskAnnotator& operator=(const TaskAnnotator&) = delete;
@@ -55,6 +71,8 @@ class BASE_EXPORT TaskAnnotator {
   // |queue_function == nullptr| in above methods).
   uint64_t GetTaskTraceID(const PendingTask& task) const;
 
+  Bookkeeping bookkeeping() const { return bookkeeping_; }
+
   // Run the given task, emitting the toplevel trace event and additional
   // trace event arguments. Like for TRACE_EVENT macros, all of the arguments
   // are used (i.e. lambdas are invoked) before this function exits, so it's
@@ -100,6 +118,8 @@ class BASE_EXPORT TaskAnnotator {
   void MaybeEmitIPCHashAndDelay(perfetto::EventContext& ctx,
                                 const PendingTask& task) const;
 #endif  //  BUILDFLAG(ENABLE_BASE_TRACING)
+
+  const Bookkeeping bookkeeping_ = Bookkeeping::kFull;
 };
 
 class BASE_EXPORT TaskAnnotator::ScopedSetIpcHash {
@@ -0,0 +1,73 @@
+// Copyright 2022 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "base/task/common/task_annotator.h"
+
+#include <stddef.h>
+
+#include <algorithm>
+#include <string>
+#include <vector>
+
+#include "base/bind.h"
+#include "base/pending_task.h"
+#include "base/time/time.h"
+#include "testing/gtest/include/gtest/gtest.h"
+#include "testing/perf/perf_result_reporter.h"
+
+namespace base {
+namespace {
+
+constexpr size_t kNumTasks = 10000;
+constexpr int kNumLaps = 50;
+
+constexpr char kMetricPrefixTaskAnnotator[] = "TaskAnnotator.";
+constexpr char kMetricTimePerTask[] = "time_per_task";
+
+// Queues the next task of |tasks|, like a thread posting to itself.
+void QueueNextTask(TaskAnnotator* annotator,
+                   std::vector<PendingTask>* tasks,
+                   size_t index) {
+  if (index + 1 < tasks->size())
+    annotator->WillQueueTask("QueueNextTask", &(*tasks)[index + 1], "");
+}
+
+// Measures the cost of queuing and running empty tasks, which is the
+// annotator's. The tasks are created out of the measured time.
+void RunEmptyTasks(TaskAnnotator::Bookkeeping bookkeeping,
+                   const std::string& story_name) {
+  TaskAnnotator annotator(bookkeeping);
+  TimeDelta best_lap = TimeDelta::Max();
+  for (int lap = 0; lap < kNumLaps; ++lap) {
+    std::vector<PendingTask> tasks(kNumTasks);
+    for (size_t i = 0; i < kNumTasks; ++i) {
+      tasks[i] = PendingTask(
+          FROM_HERE, BindOnce(&QueueNextTask, &annotator, &tasks, i));
+    }
+
+    const TimeTicks start = TimeTicks::Now();
+    annotator.WillQueueTask("RunEmptyTasks", &tasks[0], "");
+    for (PendingTask& task : tasks)
+      annotator.RunTask("RunEmptyTasks", task);
+    best_lap = std::min(best_lap, TimeTicks::Now() - start);
+  }
+
+  perf_test::PerfResultReporter reporter(kMetricPrefixTaskAnnotator,
+                                         story_name);
+  reporter.RegisterImportantMetric(kMetricTimePerTask, "ns");
+  reporter.AddResult(kMetricTimePerTask,
+                     best_lap.InMicrosecondsF() * 1000 / kNumTasks);
+}
+
+}  // namespace
+
+TEST(TaskAnnotatorPerfTest, FullBookkeeping) {
+  RunEmptyTasks(TaskAnnotator::Bookkeeping::kFull, "full_bookkeeping");
+}
+
+TEST(TaskAnnotatorPerfTest, LeanBookkeeping) {
+  RunEmptyTasks(TaskAnnotator::Bookkeeping::kLean, "lean_bookkeeping");
+}
+
+}  // namespace base
@@ -42,6 +42,36 @@ TEST(TaskAnnotatorTest, QueueAndRunTask) {
   EXPECT_EQ(123, result);
 }
 
+// Runs a task queued by |annotator|, which queues |child| with an IPC hash in
+// scope.
+void QueueAndRunParentOf(TaskAnnotator& annotator, PendingTask& child) {
+  auto queue_child = [&]() {
+    EXPECT_NE(nullptr, TaskAnnotator::CurrentTaskForThread());
+    TaskAnnotator::ScopedSetIpcHash scoped_ipc_hash(42);
+    annotator.WillQueueTask("TaskAnnotatorTest::Queue", &child, "?");
+  };
+  PendingTask parent(FROM_HERE, BindLambdaForTesting(queue_child));
+  annotator.WillQueueTask("TaskAnnotatorTest::Queue", &parent, "?");
+  annotator.RunTask("TaskAnnotator::RunTask", parent);
+  EXPECT_EQ(nullptr, TaskAnnotator::CurrentTaskForThread());
+}
+
+TEST(TaskAnnotatorTest, Bookkeeping) {
+  TaskAnnotator full_annotator;
+  EXPECT_EQ(TaskAnnotator::Bookkeeping::kFull, full_annotator.bookkeeping());
+  PendingTask child(FROM_HERE, DoNothing());
+  QueueAndRunParentOf(full_annotator, child);
+  EXPECT_NE(nullptr, child.task_backtrace[0]);
+  EXPECT_EQ(42u, child.ipc_hash);
+
+  // Without tracing, a lean annotator records neither.
+  TaskAnnotator lean_annotator(TaskAnnotator::Bookkeeping::kLean);
+  PendingTask lean_child(FROM_HERE, DoNothing());
+  QueueAndRunParentOf(lean_annotator, lean_child);
+  EXPECT_EQ(nullptr, lean_child.task_backtrace[0]);
+  EXPECT_EQ(0u, lean_child.ipc_hash);
+}
+
 // Test task annotator integration in base APIs and ensuing support for
 // backtraces. Tasks posted across multiple threads in this test fixture should
 // be synchronized as BeforeRunTask() and VerifyTraceAndPost() assume tasks are
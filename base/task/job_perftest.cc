@@ -11,6 +11,7 @@
 #include "base/containers/queue.h"
 #include "base/containers/stack.h"
 #include "base/synchronization/lock.h"
+#include "base/task/parallel_for.h"
 #include "base/task/post_job.h"
 #include "base/task/post_task.h"
 #include "base/task/thread_pool.h"
@@ -28,6 +29,8 @@ namespace {
 // - Naive: See RunJobWithNaiveAssignment().
 // - Dynamic: See RunJobWithDynamicAssignment().
 // - Loop around: See RunJobWithLoopAround().
+// - ParallelFor: See RunParallelFor(), to compare base::ParallelFor() with the
+//   hand-rolled strategies above.
 // The following test setups exists for different strategies, although
 // not every combination is performed:
 // - No-op: Work items are no-op tasks.
@@ -52,6 +55,11 @@ constexpr char kStoryNoOpLoopAroundDisrupted[] = "noop_loop_around_disrupted";
 constexpr char kStoryBusyWaitLoopAround[] = "busy_wait_loop_around";
 constexpr char kStoryBusyWaitLoopAroundDisrupted[] =
     "busy_wait_loop_around_disrupted";
+constexpr char kStoryNoOpParallelFor[] = "noop_parallel_for";
+constexpr char kStoryNoOpParallelForDisrupted[] = "noop_parallel_for_disrupted";
+constexpr char kStoryBusyWaitParallelFor[] = "busy_wait_parallel_for";
+constexpr char kStoryBusyWaitParallelForDisrupted[] =
+    "busy_wait_parallel_for_disrupted";
 
 perf_test::PerfResultReporter SetUpReporter(const std::string& story_name) {
   perf_test::PerfResultReporter reporter(kMetricPrefixJob, story_name);
@@ -398,6 +406,40 @@ class JobPerfTest : public testing::Test {
                        size_t(num_work_items / job_duration.InMilliseconds()));
   }
 
+  // Process |num_work_items| items with |process_item| in parallel with
+  // base::ParallelFor(), in chunks of at least |grain_size| items.
+  void RunParallelFor(const std::string& story_name,
+                      size_t num_work_items,
+                      size_t grain_size,
+                      RepeatingCallback<void(size_t)> process_item,
+                      bool disruptive_post_tasks = false) {
+    // Post extra tasks to disrupt Job execution and cause workers to yield.
+    if (disruptive_post_tasks)
+      DisruptivePostTasks(10, Milliseconds(1));
+
+    std::atomic_size_t num_processed_items{0};
+    const TimeTicks job_run_start = TimeTicks::Now();
+    ParallelFor(FROM_HERE, {TaskPriority::USER_VISIBLE}, 0, num_work_items,
+                grain_size,
+                BindRepeating(
+                    [](const RepeatingCallback<void(size_t)>& process_item,
+                       std::atomic_size_t* num_processed_items,
+                       size_t chunk_begin, size_t chunk_end) {
+                      for (size_t i = chunk_begin; i < chunk_end; ++i)
+                        process_item.Run(i);
+                      num_processed_items->fetch_add(
+                          chunk_end - chunk_begin, std::memory_order_relaxed);
+                    },
+                    std::move(process_item),
+                    Unretained(&num_processed_items)));
+    const TimeDelta job_duration = TimeTicks::Now() - job_run_start;
+    EXPECT_EQ(num_work_items, num_processed_items.load());
+
+    auto reporter = SetUpReporter(story_name);
+    reporter.AddResult(kMetricWorkThroughput,
+                       size_t(num_work_items / job_duration.InMilliseconds()));
+  }
+
  private:
   test::TaskEnvironment task_environment;
 };
@@ -474,4 +516,24 @@ TEST_F(JobPerfTest, BusyWaitDisruptedWorkLoopAround) {
                        std::move(callback), true);
 }
 
+TEST_F(JobPerfTest, NoOpWorkParallelFor) {
+  RunParallelFor(kStoryNoOpParallelFor, 10000000, 1000, DoNothing());
+}
+
+TEST_F(JobPerfTest, NoOpDisruptedWorkParallelFor) {
+  RunParallelFor(kStoryNoOpParallelForDisrupted, 10000000, 1000, DoNothing(),
+                 true);
+}
+
+TEST_F(JobPerfTest, BusyWaitWorkParallelFor) {
+  RepeatingCallback<void(size_t)> callback = BusyWaitCallback(Microseconds(5));
+  RunParallelFor(kStoryBusyWaitParallelFor, 500000, 1, std::move(callback));
+}
+
+TEST_F(JobPerfTest, BusyWaitDisruptedWorkParallelFor) {
+  RepeatingCallback<void(size_t)> callback = BusyWaitCallback(Microseconds(5));
+  RunParallelFor(kStoryBusyWaitParallelForDisrupted, 500000, 1,
+                 std::move(callback), true);
+}
+
 }  // namespace base
@@ -0,0 +1,186 @@
+// Copyright 2022 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "base/task/parallel_for.h"
+
+#include <algorithm>
+#include <atomic>
+#include <memory>
+
+#include "base/system/sys_info.h"
+#include "base/task/post_job.h"
+
+namespace base {
+
+namespace internal {
+
+namespace {
+
+// A worker takes 1/kChunkDivisor of what remains in a stripe, between 1 and
+// kMaxGrainsPerChunk grains...
+constexpr size_t kChunkDivisor = 4;
+// ...so that it can check ShouldYield() every so often.
+constexpr size_t kMaxGrainsPerChunk = 16;
+
+size_t GetNumGrains(size_t begin, size_t end, size_t grain_size) {
+  return (end - begin + grain_size - 1) / grain_size;
+}
+
+class ParallelForState {
+ public:
+  ParallelForState(size_t begin,
+                   size_t end,
+                   size_t grain_size,
+                   size_t num_stripes,
+                   RepeatingCallback<void(size_t, size_t, size_t)> fn)
+      : grain_size_(grain_size),
+        num_stripes_(num_stripes),
+        stripes_(std::make_unique<Stripe[]>(num_stripes)),
+        num_unclaimed_(end - begin),
+        fn_(std::move(fn)) {
+    // Stripes have the same number of grains, give or take one.
+    const size_t num_grains = GetNumGrains(begin, end, grain_size);
+    size_t stripe_begin = begin;
+    for (size_t i = 0; i < num_stripes_; ++i) {
+      const size_t stripe_grains =
+          num_grains / num_stripes_ + (i < num_grains % num_stripes_ ? 1 : 0);
+      const size_t stripe_end =
+          std::min(end, stripe_begin + stripe_grains * grain_size_);
+      stripes_[i].next.store(stripe_begin, std::memory_order_relaxed);
+      stripes_[i].end = stripe_end;
+      stripe_begin = stripe_end;
+    }
+    DCHECK_EQ(stripe_begin, end);
+  }
+  ParallelForState(const ParallelForState&) = delete;
+  ParallelForState& operator=(const ParallelForState&) = delete;
+
+  void Run(JobDelegate* delegate) {
+    const size_t task_id = delegate->GetTaskId();
+    DCHECK_LT(task_id, num_stripes_);
+    while (!delegate->ShouldYield()) {
+      size_t chunk_begin;
+      size_t chunk_end;
+      if (!ClaimChunk(task_id, &chunk_begin, &chunk_end))
+        return;
+      fn_.Run(chunk_begin, chunk_end, task_id);
+    }
+  }
+
+  size_t GetMaxConcurrency(size_t /*worker_count*/) const {
+    // memory_order_relaxed is sufficient since this is not synchronized with
+    // other state.
+    const size_t num_unclaimed = num_unclaimed_.load(std::memory_order_relaxed);
+    return std::min(num_stripes_,
+                    (num_unclaimed + grain_size_ - 1) / grain_size_);
+  }
+
+ private:
+  struct alignas(64) Stripe {
+    // Start of the unclaimed part of the stripe.
+    std::atomic<size_t> next{0};
+    size_t end = 0;
+  };
+
+  // Claims a chunk from the stripe of |task_id|, or from another stripe if it
+  // is empty. Returns false if all stripes are empty.
+  bool ClaimChunk(size_t task_id, size_t* chunk_begin, size_t* chunk_end) {
+    for (size_t i = 0; i < num_stripes_; ++i) {
+      Stripe& stripe = stripes_[(task_id + i) % num_stripes_];
+      if (ClaimChunkFromStripe(stripe, chunk_begin, chunk_end)) {
+        num_unclaimed_.fetch_sub(*chunk_end - *chunk_begin,
+                                 std::memory_order_relaxed);
+        return true;
+      }
+    }
+    return false;
+  }
+
+  bool ClaimChunkFromStripe(Stripe& stripe,
+                            size_t* chunk_begin,
+                            size_t* chunk_end) {
+    size_t next = stripe.next.load(std::memory_order_relaxed);
+    while (next < stripe.end) {
+      const size_t remaining = stripe.end - next;
+      const size_t chunk_size =
+          std::min(remaining, std::clamp(remaining / kChunkDivisor, grain_size_,
+                                         grain_size_ * kMaxGrainsPerChunk));
+      // memory_order_relaxed is sufficient since indices are the only state
+      // handed over; the results of |fn_| are synchronized by Join().
+      if (stripe.next.compare_exchange_weak(next, next + chunk_size,
+                                            std::memory_order_relaxed)) {
+        *chunk_begin = next;
+        *chunk_end = next + chunk_size;
+        return true;
+      }
+    }
+    return false;
+  }
+
+  const size_t grain_size_;
+  const size_t num_stripes_;
+  const std::unique_ptr<Stripe[]> stripes_;
+  std::atomic<size_t> num_unclaimed_;
+  const RepeatingCallback<void(size_t, size_t, size_t)> fn_;
+};
+
+}  // namespace
+
+size_t GetParallelForMaxConcurrency(size_t begin,
+                                    size_t end,
+                                    size_t grain_size) {
+  DCHECK_LE(begin, end);
+  DCHECK_GT(grain_size, 0U);
+  const size_t num_grains = GetNumGrains(begin, end, grain_size);
+  const size_t num_processors = static_cast<size_t>(
+      std::max(SysInfo::NumberOfEffectiveProcessors(), 1));
+  return std::max<size_t>(std::min(num_grains, num_processors), 1);
+}
+
+void ParallelForWithTaskId(
+    const Location& from_here,
+    const TaskTraits& traits,
+    size_t begin,
+    size_t end,
+    size_t grain_size,
+    RepeatingCallback<void(size_t, size_t, size_t)> fn) {
+  DCHECK(fn);
+  if (begin == end)
+    return;
+  const size_t num_stripes =
+      GetParallelForMaxConcurrency(begin, end, grain_size);
+  if (num_stripes == 1) {
+    // Not worth a job.
+    fn.Run(begin, end, 0);
+    return;
+  }
+
+  ParallelForState state(begin, end, grain_size, num_stripes, std::move(fn));
+  JobHandle handle = PostJob(
+      from_here, traits,
+      BindRepeating(&ParallelForState::Run, Unretained(&state)),
+      BindRepeating(&ParallelForState::GetMaxConcurrency, Unretained(&state)));
+  handle.Join();
+}
+
+}  // namespace internal
+
+void ParallelFor(const Location& from_here,
+                 const TaskTraits& traits,
+                 size_t begin,
+                 size_t end,
+                 size_t grain_size,
+                 RepeatingCallback<void(size_t, size_t)> fn) {
+  DCHECK(fn);
+  internal::ParallelForWithTaskId(
+      from_here, traits, begin, end, grain_size,
+      BindRepeating(
+          [](const RepeatingCallback<void(size_t, size_t)>& fn,
+             size_t chunk_begin, size_t chunk_end, size_t /*task_id*/) {
+            fn.Run(chunk_begin, chunk_end);
+          },
+          std::move(fn)));
+}
+
+}  // namespace base
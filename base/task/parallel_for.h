@@ -0,0 +1,175 @@
+// Copyright 2022 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#ifndef BASE_TASK_PARALLEL_FOR_H_
+#define BASE_TASK_PARALLEL_FOR_H_
+
+#include <stddef.h>
+
+#include <algorithm>
+#include <functional>
+#include <iterator>
+#include <utility>
+#include <vector>
+
+#include "base/base_export.h"
+#include "base/bind.h"
+#include "base/callback.h"
+#include "base/check_op.h"
+#include "base/location.h"
+#include "base/task/task_traits.h"
+
+// Data-parallel helpers built on PostJob(). They split a range of indices in
+// chunks of at least |grain_size| indices and process the chunks on the
+// ThreadPool and on the calling thread, which blocks until all chunks are
+// processed. Like JobHandle::Join(), they must not be called while holding a
+// lock that the callbacks could acquire.
+//
+// The range is initially divided in one contiguous stripe per potential
+// worker. Each worker starts in the stripe of its JobDelegate::GetTaskId(),
+// takes chunks that shrink as the stripe empties, and then steals from other
+// stripes. Workers check JobDelegate::ShouldYield() between chunks.
+//
+// |grain_size| should be large enough for a chunk to amortize the cost of
+// claiming it (an atomic operation and a callback invocation), typically a few
+// microseconds of work.
+
+namespace base {
+
+namespace internal {
+
+// Returns an upper bound on the task ids passed to ParallelForWithTaskId() for
+// the same arguments.
+BASE_EXPORT size_t GetParallelForMaxConcurrency(size_t begin,
+                                                size_t end,
+                                                size_t grain_size);
+
+// Same as ParallelFor(), but |fn| is also passed a task id, as its last
+// argument, which is below GetParallelForMaxConcurrency() and unique among
+// concurrent calls.
+BASE_EXPORT void ParallelForWithTaskId(
+    const Location& from_here,
+    const TaskTraits& traits,
+    size_t begin,
+    size_t end,
+    size_t grain_size,
+    RepeatingCallback<void(size_t, size_t, size_t)> fn);
+
+}  // namespace internal
+
+// Calls |fn| concurrently on disjoint chunks covering [begin, end), and returns
+// when all calls have returned.
+BASE_EXPORT void ParallelFor(
+    const Location& from_here,
+    const TaskTraits& traits,
+    size_t begin,
+    size_t end,
+    size_t grain_size,
+    RepeatingCallback<void(size_t chunk_begin, size_t chunk_end)> fn);
+
+// Returns the combination with |combine| of |identity| and of the values
+// returned by |map_range| for disjoint chunks covering [begin, end).
+// |combine| must be associative and commutative, since chunks are combined in
+// no particular order.
+template <typename T>
+T ParallelReduce(const Location& from_here,
+                 const TaskTraits& traits,
+                 size_t begin,
+                 size_t end,
+                 size_t grain_size,
+                 T identity,
+                 RepeatingCallback<T(size_t chunk_begin, size_t chunk_end)>
+                     map_range,
+                 RepeatingCallback<T(T, T)> combine) {
+  // One partial result per task id; a task id is never used by two threads
+  // at once.
+  std::vector<T> partial_results(
+      internal::GetParallelForMaxConcurrency(begin, end, grain_size), identity);
+  internal::ParallelForWithTaskId(
+      from_here, traits, begin, end, grain_size,
+      BindRepeating(
+          [](std::vector<T>* partial_results,
+             const RepeatingCallback<T(size_t, size_t)>& map_range,
+             const RepeatingCallback<T(T, T)>& combine, size_t chunk_begin,
+             size_t chunk_end, size_t task_id) {
+            T& partial_result = (*partial_results)[task_id];
+            partial_result = combine.Run(std::move(partial_result),
+                                         map_range.Run(chunk_begin, chunk_end));
+          },
+          Unretained(&partial_results), map_range, combine));
+
+  T result = std::move(identity);
+  for (T& partial_result : partial_results)
+    result = combine.Run(std::move(result), std::move(partial_result));
+  return result;
+}
+
+// Sorts [first, last) with |comp|, like std::sort(). Blocks are sorted in
+// parallel, then merged pairwise in parallel rounds.
+template <typename RandomIt, typename Compare = std::less<>>
+void ParallelSort(const Location& from_here,
+                  const TaskTraits& traits,
+                  RandomIt first,
+                  RandomIt last,
+                  Compare comp = Compare()) {
+  // Smaller ranges are sorted on the calling thread.
+  constexpr size_t kMinBlockSize = 4096;
+  const size_t size = static_cast<size_t>(std::distance(first, last));
+  const size_t num_blocks = std::min(
+      internal::GetParallelForMaxConcurrency(0, size, kMinBlockSize),
+      std::max<size_t>(size / kMinBlockSize, 1));
+  if (num_blocks <= 1) {
+    std::sort(first, last, comp);
+    return;
+  }
+  // Bound by pointer, since raw pointer iterators can't be bound.
+  struct SortState {
+    RandomIt first;
+    size_t size;
+    // Size of the sorted runs.
+    size_t run_size;
+    Compare comp;
+  } state = {first, size, (size + num_blocks - 1) / num_blocks,
+             std::move(comp)};
+
+  // Sort runs of |run_size| elements...
+  ParallelFor(from_here, traits, 0, num_blocks, 1,
+              BindRepeating(
+                  [](const SortState* state, size_t chunk_begin,
+                     size_t chunk_end) {
+                    for (size_t run = chunk_begin; run < chunk_end; ++run) {
+                      const size_t begin = run * state->run_size;
+                      const size_t end =
+                          std::min(begin + state->run_size, state->size);
+                      std::sort(state->first + begin, state->first + end,
+                                state->comp);
+                    }
+                  },
+                  Unretained(&state)));
+
+  // ...then merge pairs of sorted runs, doubling their size each round.
+  for (; state.run_size < size; state.run_size *= 2) {
+    const size_t num_merges =
+        (size + 2 * state.run_size - 1) / (2 * state.run_size);
+    ParallelFor(
+        from_here, traits, 0, num_merges, 1,
+        BindRepeating(
+            [](const SortState* state, size_t chunk_begin, size_t chunk_end) {
+              for (size_t merge = chunk_begin; merge < chunk_end; ++merge) {
+                const size_t begin = merge * 2 * state->run_size;
+                const size_t middle =
+                    std::min(begin + state->run_size, state->size);
+                const size_t end =
+                    std::min(middle + state->run_size, state->size);
+                std::inplace_merge(state->first + begin, state->first + middle,
+                                   state->first + end, state->comp);
+              }
+            },
+            Unretained(&state)));
+  }
+}
+
+}  // namespace base
+
+#endif  // BASE_TASK_PARALLEL_FOR_H_
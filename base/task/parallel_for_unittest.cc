@@ -0,0 +1,101 @@
+// Copyright 2022 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "base/task/parallel_for.h"
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include <algorithm>
+#include <atomic>
+#include <functional>
+#include <vector>
+
+#include "base/bind.h"
+#include "base/test/task_environment.h"
+#include "testing/gtest/include/gtest/gtest.h"
+
+namespace base {
+
+namespace {
+
+class ParallelForTest : public testing::Test {
+ protected:
+  ParallelForTest() = default;
+
+  test::TaskEnvironment task_environment_;
+};
+
+}  // namespace
+
+TEST_F(ParallelForTest, EmptyRange) {
+  ParallelFor(FROM_HERE, {}, 10, 10, 1,
+              BindRepeating([](size_t, size_t) { ADD_FAILURE(); }));
+}
+
+// Verify that every index is visited exactly once.
+TEST_F(ParallelForTest, VisitsEachIndexOnce) {
+  constexpr size_t kBegin = 3;
+  constexpr size_t kEnd = 100003;
+  std::vector<std::atomic<int>> num_visits(kEnd);
+  ParallelFor(FROM_HERE, {}, kBegin, kEnd, 7,
+              BindRepeating(
+                  [](std::vector<std::atomic<int>>* num_visits,
+                     size_t chunk_begin, size_t chunk_end) {
+                    EXPECT_LT(chunk_begin, chunk_end);
+                    for (size_t i = chunk_begin; i < chunk_end; ++i)
+                      (*num_visits)[i].fetch_add(1, std::memory_order_relaxed);
+                  },
+                  Unretained(&num_visits)));
+  for (size_t i = 0; i < kEnd; ++i)
+    EXPECT_EQ(num_visits[i].load(), i < kBegin ? 0 : 1) << i;
+}
+
+TEST_F(ParallelForTest, Reduce) {
+  constexpr size_t kSize = 1000000;
+  const uint64_t sum = ParallelReduce<uint64_t>(
+      FROM_HERE, {}, 0, kSize, 1000, 0,
+      BindRepeating([](size_t chunk_begin, size_t chunk_end) {
+        uint64_t chunk_sum = 0;
+        for (size_t i = chunk_begin; i < chunk_end; ++i)
+          chunk_sum += i;
+        return chunk_sum;
+      }),
+      BindRepeating([](uint64_t a, uint64_t b) { return a + b; }));
+  EXPECT_EQ(sum, uint64_t{kSize} * (kSize - 1) / 2);
+}
+
+TEST_F(ParallelForTest, ReduceEmptyRange) {
+  EXPECT_EQ(ParallelReduce<int>(
+                FROM_HERE, {}, 0, 0, 1, 42,
+                BindRepeating([](size_t, size_t) { return 1; }),
+                BindRepeating([](int a, int b) { return a + b; })),
+            42);
+}
+
+TEST_F(ParallelForTest, Sort) {
+  for (size_t size : {0, 1, 1000, 100000, 1000003}) {
+    std::vector<uint32_t> values(size);
+    uint32_t state = 12345;
+    for (uint32_t& value : values) {
+      state = state * 1103515245 + 12345;
+      value = state >> 8;
+    }
+    std::vector<uint32_t> expected = values;
+    std::sort(expected.begin(), expected.end(), std::greater<>());
+
+    ParallelSort(FROM_HERE, {}, values.begin(), values.end(),
+                 std::greater<>());
+    EXPECT_EQ(values, expected) << size;
+  }
+}
+
+// Verify that raw pointers can be sorted.
+TEST_F(ParallelForTest, SortArray) {
+  int values[] = {5, 3, 9, 1, 7};
+  ParallelSort(FROM_HERE, {}, std::begin(values), std::end(values));
+  EXPECT_TRUE(std::is_sorted(std::begin(values), std::end(values)));
+}
+
+}  // namespace base
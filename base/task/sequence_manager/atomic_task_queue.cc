@@ -0,0 +1,62 @@
+// Copyright 2022 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "base/task/sequence_manager/atomic_task_queue.h"
+
+#include "base/check.h"
+
+namespace base {
+namespace sequence_manager {
+namespace internal {
+
+AtomicTaskQueue::AtomicTaskQueue() = default;
+
+AtomicTaskQueue::~AtomicTaskQueue() {
+  Node* node = head_.load(std::memory_order_acquire);
+  while (node)
+    delete std::exchange(node, node->next);
+}
+
+bool AtomicTaskQueue::Push(Task task, EnqueueOrder enqueue_order) {
+  DCHECK(!task.enqueue_order_set());
+  Node* node = new Node(std::move(task), enqueue_order);
+  node->next = head_.load(std::memory_order_relaxed);
+  // On failure, |node->next| is updated to the current head.
+  while (!head_.compare_exchange_weak(node->next, node,
+                                      std::memory_order_seq_cst,
+                                      std::memory_order_relaxed)) {
+  }
+  return !node->next;
+}
+
+size_t AtomicTaskQueue::size() const {
+  // Nodes are only deleted by the consumer, so the list can be walked while
+  // producers push.
+  size_t size = 0;
+  for (const Node* node = head_.load(std::memory_order_acquire); node;
+       node = node->next) {
+    ++size;
+  }
+  return size;
+}
+
+AtomicTaskQueue::Node* AtomicTaskQueue::TakeNodesInEnqueueOrder() {
+  // The stack is in reverse push order, which is close to decreasing enqueue
+  // order: inserting each node in the sorted list is usually O(1).
+  Node* stack = head_.exchange(nullptr, std::memory_order_acquire);
+  Node* sorted = nullptr;
+  while (stack) {
+    Node* node = std::exchange(stack, stack->next);
+    Node** position = &sorted;
+    while (*position && (*position)->enqueue_order < node->enqueue_order)
+      position = &(*position)->next;
+    node->next = *position;
+    *position = node;
+  }
+  return sorted;
+}
+
+}  // namespace internal
+}  // namespace sequence_manager
+}  // namespace base
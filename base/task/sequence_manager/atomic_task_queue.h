@@ -0,0 +1,96 @@
+// Copyright 2022 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#ifndef BASE_TASK_SEQUENCE_MANAGER_ATOMIC_TASK_QUEUE_H_
+#define BASE_TASK_SEQUENCE_MANAGER_ATOMIC_TASK_QUEUE_H_
+
+#include <stddef.h>
+
+#include <atomic>
+#include <utility>
+
+#include "base/base_export.h"
+#include "base/task/sequence_manager/enqueue_order.h"
+#include "base/task/sequence_manager/tasks.h"
+
+namespace base {
+namespace sequence_manager {
+namespace internal {
+
+// A multi-producer single-consumer queue of immediate tasks which can be
+// pushed to from any thread without a lock. Tasks are pushed onto an intrusive
+// lock-free stack, and are put back in enqueue order when the consumer takes
+// them.
+//
+// The enqueue order of a task is generated before it is pushed, so concurrent
+// producers can push tasks out of order; TakeTasks() sorts them. A task whose
+// push raced with TakeTasks() can have an enqueue order below that of a task
+// already taken. It is then given a new enqueue order, as if it had been
+// posted when it was taken, so that enqueue orders strictly increase across
+// calls to TakeTasks().
+class BASE_EXPORT AtomicTaskQueue {
+ public:
+  AtomicTaskQueue();
+  AtomicTaskQueue(const AtomicTaskQueue&) = delete;
+  AtomicTaskQueue& operator=(const AtomicTaskQueue&) = delete;
+  // Deletes the tasks which weren't taken.
+  ~AtomicTaskQueue();
+
+  // Pushes |task|, which must not have an enqueue order yet, with
+  // |enqueue_order|. Returns true if the queue was empty. Can be called from
+  // any thread. This is sequentially consistent with empty(), so that either a
+  // producer which pushes onto an empty queue or a consumer which checks
+  // empty() afterwards sees the other side's preceding writes.
+  bool Push(Task task, EnqueueOrder enqueue_order);
+
+  // Returns true if there is no task to take. Can be called from any thread,
+  // but the result is only stable if there is no concurrent Push().
+  bool empty() const { return !head_.load(std::memory_order_seq_cst); }
+
+  // Returns the number of tasks to take. Must be called by the consumer.
+  size_t size() const;
+
+  // Appends the tasks pushed since the last call to |tasks|, in increasing
+  // enqueue order. |generate_enqueue_order| is called to renumber tasks whose
+  // enqueue order isn't above those of the tasks previously taken. Must be
+  // called by the consumer.
+  template <typename TaskContainer, typename EnqueueOrderGenerator>
+  void TakeTasks(TaskContainer* tasks,
+                 EnqueueOrderGenerator generate_enqueue_order) {
+    Node* node = TakeNodesInEnqueueOrder();
+    while (node) {
+      if (node->enqueue_order <= last_taken_enqueue_order_)
+        node->enqueue_order = generate_enqueue_order();
+      last_taken_enqueue_order_ = node->enqueue_order;
+      node->task.set_enqueue_order(node->enqueue_order);
+      tasks->push_back(std::move(node->task));
+      delete std::exchange(node, node->next);
+    }
+  }
+
+ private:
+  struct Node {
+    Node(Task task, EnqueueOrder enqueue_order)
+        : task(std::move(task)), enqueue_order(enqueue_order) {}
+
+    Task task;
+    EnqueueOrder enqueue_order;
+    Node* next = nullptr;
+  };
+
+  // Takes all the nodes and returns them as a list sorted by enqueue order.
+  Node* TakeNodesInEnqueueOrder();
+
+  // Top of the stack, i.e. the last node pushed.
+  std::atomic<Node*> head_{nullptr};
+
+  // Accessed by the consumer only.
+  EnqueueOrder last_taken_enqueue_order_;
+};
+
+}  // namespace internal
+}  // namespace sequence_manager
+}  // namespace base
+
+#endif  // BASE_TASK_SEQUENCE_MANAGER_ATOMIC_TASK_QUEUE_H_
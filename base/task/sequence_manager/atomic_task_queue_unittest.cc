@@ -0,0 +1,143 @@
+// Copyright 2022 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "base/task/sequence_manager/atomic_task_queue.h"
+
+#include <stdint.h>
+
+#include <atomic>
+#include <memory>
+#include <vector>
+
+#include "base/bind.h"
+#include "base/callback_helpers.h"
+#include "base/memory/raw_ptr.h"
+#include "base/threading/simple_thread.h"
+#include "testing/gtest/include/gtest/gtest.h"
+
+namespace base {
+namespace sequence_manager {
+namespace internal {
+
+namespace {
+
+Task MakeTask(uint64_t sequence_number) {
+  return Task(PostedTask(nullptr, DoNothing(), FROM_HERE),
+              EnqueueOrder::FromIntForTesting(sequence_number));
+}
+
+std::vector<uint64_t> GetEnqueueOrders(const std::vector<Task>& tasks) {
+  std::vector<uint64_t> enqueue_orders;
+  for (const Task& task : tasks)
+    enqueue_orders.push_back(task.enqueue_order());
+  return enqueue_orders;
+}
+
+// Pushes tasks with enqueue orders from a shared generator.
+class Producer : public DelegateSimpleThread::Delegate {
+ public:
+  Producer(AtomicTaskQueue* queue,
+           std::atomic<uint64_t>* next_enqueue_order,
+           uint64_t num_tasks)
+      : queue_(queue),
+        next_enqueue_order_(next_enqueue_order),
+        num_tasks_(num_tasks) {}
+
+  void Run() override {
+    for (uint64_t i = 0; i < num_tasks_; ++i) {
+      const uint64_t enqueue_order = next_enqueue_order_->fetch_add(1);
+      queue_->Push(MakeTask(enqueue_order),
+                   EnqueueOrder::FromIntForTesting(enqueue_order));
+    }
+  }
+
+ private:
+  const raw_ptr<AtomicTaskQueue> queue_;
+  const raw_ptr<std::atomic<uint64_t>> next_enqueue_order_;
+  const uint64_t num_tasks_;
+};
+
+}  // namespace
+
+TEST(AtomicTaskQueueTest, PushReturnsWhetherEmpty) {
+  AtomicTaskQueue queue;
+  EXPECT_TRUE(queue.empty());
+  EXPECT_TRUE(queue.Push(MakeTask(2), EnqueueOrder::FromIntForTesting(2)));
+  EXPECT_FALSE(queue.Push(MakeTask(3), EnqueueOrder::FromIntForTesting(3)));
+  EXPECT_FALSE(queue.empty());
+  EXPECT_EQ(queue.size(), 2U);
+
+  std::vector<Task> tasks;
+  queue.TakeTasks(&tasks, []() {
+    ADD_FAILURE();
+    return EnqueueOrder();
+  });
+  EXPECT_TRUE(queue.empty());
+  EXPECT_EQ(GetEnqueueOrders(tasks), (std::vector<uint64_t>{2, 3}));
+
+  EXPECT_TRUE(queue.Push(MakeTask(4), EnqueueOrder::FromIntForTesting(4)));
+}
+
+TEST(AtomicTaskQueueTest, TakeTasksSortsByEnqueueOrder) {
+  AtomicTaskQueue queue;
+  for (uint64_t enqueue_order : {5, 2, 4, 3, 6})
+    queue.Push(MakeTask(enqueue_order),
+               EnqueueOrder::FromIntForTesting(enqueue_order));
+
+  std::vector<Task> tasks;
+  queue.TakeTasks(&tasks, []() { return EnqueueOrder(); });
+  EXPECT_EQ(GetEnqueueOrders(tasks), (std::vector<uint64_t>{2, 3, 4, 5, 6}));
+}
+
+// Verify that a task pushed with an enqueue order below that of a task already
+// taken is renumbered.
+TEST(AtomicTaskQueueTest, TakeTasksRenumbersLateTasks) {
+  AtomicTaskQueue queue;
+  queue.Push(MakeTask(5), EnqueueOrder::FromIntForTesting(5));
+  std::vector<Task> tasks;
+  queue.TakeTasks(&tasks, []() { return EnqueueOrder(); });
+
+  queue.Push(MakeTask(4), EnqueueOrder::FromIntForTesting(4));
+  queue.Push(MakeTask(7), EnqueueOrder::FromIntForTesting(7));
+  uint64_t next_enqueue_order = 10;
+  queue.TakeTasks(&tasks, [&]() {
+    return EnqueueOrder::FromIntForTesting(next_enqueue_order++);
+  });
+  EXPECT_EQ(GetEnqueueOrders(tasks), (std::vector<uint64_t>{5, 10, 11}));
+}
+
+TEST(AtomicTaskQueueTest, ConcurrentPush) {
+  constexpr size_t kNumThreads = 4;
+  constexpr uint64_t kNumTasksPerThread = 10000;
+  AtomicTaskQueue queue;
+  std::atomic<uint64_t> next_enqueue_order{2};
+  std::vector<std::unique_ptr<DelegateSimpleThread>> threads;
+  std::vector<std::unique_ptr<Producer>> producers;
+
+  for (size_t i = 0; i < kNumThreads; ++i) {
+    producers.push_back(std::make_unique<Producer>(&queue, &next_enqueue_order,
+                                                   kNumTasksPerThread));
+    threads.push_back(std::make_unique<DelegateSimpleThread>(
+        producers.back().get(), "AtomicTaskQueueTest"));
+    threads.back()->Start();
+  }
+
+  // Take tasks while they're pushed.
+  auto generate_enqueue_order = [&]() {
+    return EnqueueOrder::FromIntForTesting(next_enqueue_order.fetch_add(1));
+  };
+  std::vector<Task> tasks;
+  while (tasks.size() < kNumThreads * kNumTasksPerThread)
+    queue.TakeTasks(&tasks, generate_enqueue_order);
+  for (auto& thread : threads)
+    thread->Join();
+
+  EXPECT_TRUE(queue.empty());
+  for (size_t i = 1; i < tasks.size(); ++i)
+    EXPECT_LT(tasks[i - 1].enqueue_order(), tasks[i].enqueue_order());
+}
+
+}  // namespace internal
+}  // namespace sequence_manager
+}  // namespace base
@@ -52,6 +52,20 @@ SequenceManager::Settings::Builder::SetAddQueueTimeToTasks(
   return *this;
 }
 
+SequenceManager::Settings::Builder&
+SequenceManager::Settings::Builder::SetTaskBookkeeping(
+    TaskAnnotator::Bookkeeping task_bookkeeping_val) {
+  settings_.task_bookkeeping = task_bookkeeping_val;
+  return *this;
+}
+
+SequenceManager::Settings::Builder&
+SequenceManager::Settings::Builder::SetRecordTaskQueueStats(
+    bool record_task_queue_stats_val) {
+  settings_.record_task_queue_stats = record_task_queue_stats_val;
+  return *this;
+}
+
 #if DCHECK_IS_ON()
 
 SequenceManager::Settings::Builder&
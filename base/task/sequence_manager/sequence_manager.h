@@ -12,6 +12,7 @@
 #include "base/memory/raw_ptr.h"
 #include "base/message_loop/message_pump_type.h"
 #include "base/message_loop/timer_slack.h"
+#include "base/task/common/task_annotator.h"
 #include "base/task/sequence_manager/task_queue_impl.h"
 #include "base/task/sequence_manager/task_time_observer.h"
 #include "base/task/sequenced_task_runner.h"
@@ -98,6 +99,14 @@ class BASE_EXPORT SequenceManager {
     // If true, add the timestamp the task got queued to the task.
     bool add_queue_time_to_tasks = false;
 
+    // What is recorded about each task besides what tracing records, see
+    // TaskAnnotator::Bookkeeping.
+    TaskAnnotator::Bookkeeping task_bookkeeping =
+        TaskAnnotator::Bookkeeping::kFull;
+
+    // If true, each TaskQueue records TaskQueueStats on the tasks it runs.
+    bool record_task_queue_stats = false;
+
 #if DCHECK_IS_ON()
     // TODO(alexclarke): Consider adding command line flags to control these.
     enum class TaskLogging {
@@ -283,11 +292,21 @@ class BASE_EXPORT SequenceManager::Settings::Builder {
   Builder& SetRandomisedSamplingEnabled(bool randomised_sampling_enabled);
 
   // Sets the TickClock the SequenceManager uses to obtain Now.
+  // DefaultCoarseTickClock costs less to read than the default, for the
+  // SequenceManagers whose delayed tasks may run a few milliseconds late.
   Builder& SetTickClock(const TickClock* clock);
 
   // Whether or not queueing timestamp will be added to tasks.
   Builder& SetAddQueueTimeToTasks(bool add_queue_time_to_tasks);
 
+  // Sets what is recorded about each task. TaskAnnotator::Bookkeeping::kLean
+  // suits the threads running many very short tasks.
+  Builder& SetTaskBookkeeping(TaskAnnotator::Bookkeeping task_bookkeeping);
+
+  // Whether or not the TaskQueues record TaskQueueStats, which costs a Now()
+  // per task and a few KB per TaskQueue.
+  Builder& SetRecordTaskQueueStats(bool record_task_queue_stats);
+
 #if DCHECK_IS_ON()
   // Controls task execution logging.
   Builder& SetTaskLogging(TaskLogging task_execution_logging);
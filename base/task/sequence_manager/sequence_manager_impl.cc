@@ -568,8 +568,10 @@ const char* RunTaskTraceNameForPriority(TaskQueue::QueuePriority priority) {
 }  // namespace
 
 absl::optional<SequenceManagerImpl::SelectedTask>
-SequenceManagerImpl::SelectNextTask(SelectTaskOption option) {
-  absl::optional<SelectedTask> selected_task = SelectNextTaskImpl(option);
+SequenceManagerImpl::SelectNextTask(LazyNow* lazy_now,
+                                    SelectTaskOption option) {
+  absl::optional<SelectedTask> selected_task =
+      SelectNextTaskImpl(lazy_now, option);
   if (!selected_task)
     return selected_task;
 
@@ -641,7 +643,8 @@ void SequenceManagerImpl::LogTaskDebugInfo(
 #endif  // DCHECK_IS_ON() && !BUILDFLAG(IS_NACL)
 
 absl::optional<SequenceManagerImpl::SelectedTask>
-SequenceManagerImpl::SelectNextTaskImpl(SelectTaskOption option) {
+SequenceManagerImpl::SelectNextTaskImpl(LazyNow* lazy_now,
+                                        SelectTaskOption option) {
   CHECK(Validate());
 
   DCHECK_CALLED_ON_VALID_THREAD(associated_thread_->thread_checker);
@@ -649,13 +652,12 @@ SequenceManagerImpl::SelectNextTaskImpl(SelectTaskOption option) {
                "SequenceManagerImpl::SelectNextTask");
 
   ReloadEmptyWorkQueues();
-  LazyNow lazy_now(main_thread_clock());
-  MoveReadyDelayedTasksToWorkQueues(&lazy_now);
+  MoveReadyDelayedTasksToWorkQueues(lazy_now);
 
   // If we sampled now, check if it's time to reclaim memory next time we go
   // idle.
-  if (lazy_now.has_value() &&
-      lazy_now.Now() >= main_thread_only().next_time_to_reclaim_memory) {
+  if (lazy_now->has_value() &&
+      lazy_now->Now() >= main_thread_only().next_time_to_reclaim_memory) {
     main_thread_only().memory_reclaim_scheduled = true;
   }
 
@@ -707,7 +709,7 @@ SequenceManagerImpl::SelectNextTaskImpl(SelectTaskOption option) {
 
     ExecutingTask& executing_task =
         *main_thread_only().task_execution_stack.rbegin();
-    NotifyWillProcessTask(&executing_task, &lazy_now);
+    NotifyWillProcessTask(&executing_task, lazy_now);
 
     return SelectedTask(
         executing_task.pending_task,
@@ -720,8 +722,7 @@ bool SequenceManagerImpl::ShouldRunTaskOfPriority(
   return priority <= *main_thread_only().pending_native_work.begin();
 }
 
-void SequenceManagerImpl::DidRunTask() {
-  LazyNow lazy_now(main_thread_clock());
+void SequenceManagerImpl::DidRunTask(LazyNow* lazy_now) {
   ExecutingTask& executing_task =
       *main_thread_only().task_execution_stack.rbegin();
 
@@ -729,7 +730,13 @@ void SequenceManagerImpl::DidRunTask() {
   TRACE_EVENT_END0("sequence_manager",
                    RunTaskTraceNameForPriority(executing_task.priority));
 
-  NotifyDidProcessTask(&executing_task, &lazy_now);
+  if (settings_.record_task_queue_stats) {
+    executing_task.task_queue->RecordTaskStats(
+        executing_task.pending_task, executing_task.start_time_for_stats,
+        lazy_now->Now());
+  }
+
+  NotifyDidProcessTask(&executing_task, lazy_now);
   main_thread_only().task_execution_stack.pop_back();
 
   if (main_thread_only().nesting_depth == 0)
@@ -878,6 +885,8 @@ void SequenceManagerImpl::NotifyWillProcessTask(ExecutingTask* executing_task,
       ShouldRecordTaskTiming(executing_task->task_queue);
   if (recording_policy == TimeRecordingPolicy::DoRecord)
     executing_task->task_timing.RecordTaskStart(time_before_task);
+  if (settings_.record_task_queue_stats)
+    executing_task->start_time_for_stats = time_before_task->Now();
 
   // Maybe invalidate the delayed task handle. |pending_task| is guaranteed to
   // be valid here (not canceled).
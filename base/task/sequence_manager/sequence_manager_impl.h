@@ -148,8 +148,9 @@ class BASE_EXPORT SequenceManagerImpl
 
   // SequencedTaskSource implementation:
   absl::optional<SelectedTask> SelectNextTask(
+      LazyNow* lazy_now,
       SelectTaskOption option = SelectTaskOption::kDefault) override;
-  void DidRunTask() override;
+  void DidRunTask(LazyNow* lazy_now) override;
   void RemoveAllCanceledDelayedTasksFromFront(LazyNow* lazy_now) override;
   absl::optional<WakeUp> GetPendingWakeUp(
       LazyNow* lazy_now,
@@ -265,6 +266,8 @@ class BASE_EXPORT SequenceManagerImpl
     // Save task metadata to use in after running a task as |pending_task|
     // won't be available then.
     int task_type;
+    // Only set if `Settings::record_task_queue_stats`.
+    TimeTicks start_time_for_stats;
   };
 
   struct MainThreadOnly {
@@ -413,7 +416,8 @@ class BASE_EXPORT SequenceManagerImpl
 
   // Helper to terminate all scoped trace events to allow starting new ones
   // in SelectNextTask().
-  absl::optional<SelectedTask> SelectNextTaskImpl(SelectTaskOption option);
+  absl::optional<SelectedTask> SelectNextTaskImpl(LazyNow* lazy_now,
+                                                  SelectTaskOption option);
 
   // Check if a task of priority |priority| should run given the pending set of
   // native work.
@@ -404,6 +404,20 @@ class SequenceManagerTest
     }
   }
 
+  // Selects and completes tasks directly on the SequencedTaskSource, each
+  // with a fresh LazyNow.
+  absl::optional<SequencedTaskSource::SelectedTask> SelectNextTask(
+      SequencedTaskSource::SelectTaskOption option =
+          SequencedTaskSource::SelectTaskOption::kDefault) {
+    LazyNow lazy_now(mock_tick_clock());
+    return sequence_manager()->SelectNextTask(&lazy_now, option);
+  }
+
+  void DidRunTask() {
+    LazyNow lazy_now(mock_tick_clock());
+    sequence_manager()->DidRunTask(&lazy_now);
+  }
+
   void AdvanceMockTickClock(TimeDelta delta) override {
     fixture_->AdvanceMockTickClock(delta);
   }
@@ -655,6 +669,35 @@ TEST_P(SequenceManagerTest, NonNestableTaskPosting) {
   EXPECT_THAT(run_order, ElementsAre(1u));
 }
 
+TEST_P(SequenceManagerTest, CoalescedTaskPosting) {
+  auto queue = CreateTaskQueue();
+  const int key_a = 0;
+  const int key_b = 0;
+
+  std::vector<EnqueueOrder> run_order;
+  queue->task_runner()->PostTask(FROM_HERE, BindOnce(&TestTask, 1, &run_order));
+  for (int i = 2; i <= 4; i++) {
+    EXPECT_TRUE(queue->task_runner()->PostCoalescedTask(
+        FROM_HERE, &key_a, BindOnce(&TestTask, i, &run_order)));
+  }
+  for (int i = 5; i <= 6; i++) {
+    EXPECT_TRUE(queue->task_runner()->PostCoalescedTask(
+        FROM_HERE, &key_b, BindOnce(&TestTask, i, &run_order),
+        SequencedTaskRunner::CoalescingPolicy::kKeepPending));
+  }
+  queue->task_runner()->PostTask(FROM_HERE, BindOnce(&TestTask, 7, &run_order));
+  EXPECT_EQ(4u, queue->GetNumberOfPendingTasks());
+
+  RunLoop().RunUntilIdle();
+  EXPECT_THAT(run_order, ElementsAre(1u, 4u, 5u, 7u));
+
+  // Once the coalesced task ran, a new one is posted for the key.
+  EXPECT_TRUE(queue->task_runner()->PostCoalescedTask(
+      FROM_HERE, &key_a, BindOnce(&TestTask, 8, &run_order)));
+  RunLoop().RunUntilIdle();
+  EXPECT_THAT(run_order, ElementsAre(1u, 4u, 5u, 7u, 8u));
+}
+
 TEST_P(SequenceManagerTest, NonNestableTaskExecutesInExpectedOrder) {
   auto queue = CreateTaskQueue();
 
@@ -2494,10 +2537,10 @@ TEST_P(SequenceManagerTest, TaskQueueThrottler_ImmediateTask) {
   Mock::VerifyAndClearExpectations(&throttler);
 
   // Unless the immediate work queue is emptied.
-  sequence_manager()->SelectNextTask();
-  sequence_manager()->DidRunTask();
-  sequence_manager()->SelectNextTask();
-  sequence_manager()->DidRunTask();
+  SelectNextTask();
+  DidRunTask();
+  SelectNextTask();
+  DidRunTask();
   EXPECT_CALL(throttler, OnHasImmediateTask());
   queue->task_runner()->PostTask(FROM_HERE, BindOnce(&NopTask));
   sequence_manager()->ReloadEmptyWorkQueues();
@@ -3504,10 +3547,9 @@ TEST_P(SequenceManagerTest, DelayedTasksNotSelected) {
   queue->task_runner()->PostDelayedTask(FROM_HERE, BindOnce(&NopTask), kDelay);
 
   // No task should be ready to execute.
-  EXPECT_FALSE(sequence_manager()->SelectNextTask(
-      SequencedTaskSource::SelectTaskOption::kDefault));
-  EXPECT_FALSE(sequence_manager()->SelectNextTask(
-      SequencedTaskSource::SelectTaskOption::kSkipDelayedTask));
+  EXPECT_FALSE(SelectNextTask(SequencedTaskSource::SelectTaskOption::kDefault));
+  EXPECT_FALSE(
+      SelectNextTask(SequencedTaskSource::SelectTaskOption::kSkipDelayedTask));
 
   EXPECT_EQ((WakeUp{lazy_now.Now() + kDelay, kLeeway}),
             sequence_manager()->GetPendingWakeUp(&lazy_now));
@@ -3521,17 +3563,16 @@ TEST_P(SequenceManagerTest, DelayedTasksNotSelected) {
 
   // Delayed task is ready to be executed. Consider it only if not in power
   // suspend state.
-  EXPECT_FALSE(sequence_manager()->SelectNextTask(
-      SequencedTaskSource::SelectTaskOption::kSkipDelayedTask));
+  EXPECT_FALSE(
+      SelectNextTask(SequencedTaskSource::SelectTaskOption::kSkipDelayedTask));
   EXPECT_EQ(
       absl::nullopt,
       sequence_manager()->GetPendingWakeUp(
           &lazy_now2, SequencedTaskSource::SelectTaskOption::kSkipDelayedTask));
 
   // Execute the delayed task.
-  EXPECT_TRUE(sequence_manager()->SelectNextTask(
-      SequencedTaskSource::SelectTaskOption::kDefault));
-  sequence_manager()->DidRunTask();
+  EXPECT_TRUE(SelectNextTask(SequencedTaskSource::SelectTaskOption::kDefault));
+  DidRunTask();
   EXPECT_EQ(absl::nullopt, sequence_manager()->GetPendingWakeUp(&lazy_now2));
 
   // Tidy up.
@@ -3569,30 +3610,29 @@ TEST_P(SequenceManagerTest, DelayedTasksNotSelectedWithImmediateTask) {
           &lazy_now2, SequencedTaskSource::SelectTaskOption::kSkipDelayedTask));
 
   // Immediate task should be ready to execute, execute it.
-  EXPECT_TRUE(sequence_manager()->SelectNextTask(
-      SequencedTaskSource::SelectTaskOption::kSkipDelayedTask));
-  sequence_manager()->DidRunTask();
+  EXPECT_TRUE(
+      SelectNextTask(SequencedTaskSource::SelectTaskOption::kSkipDelayedTask));
+  DidRunTask();
 
   // Delayed task is ready to be executed. Consider it only if not in power
   // suspend state. This test differs from
   // SequenceManagerTest.DelayedTasksNotSelected as it confirms that delayed
   // tasks are ignored even if they're already in the ready queue (per having
   // performed task selection already before running the immediate task above).
-  EXPECT_FALSE(sequence_manager()->SelectNextTask(
-      SequencedTaskSource::SelectTaskOption::kSkipDelayedTask));
+  EXPECT_FALSE(
+      SelectNextTask(SequencedTaskSource::SelectTaskOption::kSkipDelayedTask));
   EXPECT_EQ(
       absl::nullopt,
       sequence_manager()->GetPendingWakeUp(
           &lazy_now2, SequencedTaskSource::SelectTaskOption::kSkipDelayedTask));
 
   // Execute the delayed task.
-  EXPECT_TRUE(sequence_manager()->SelectNextTask(
-      SequencedTaskSource::SelectTaskOption::kDefault));
+  EXPECT_TRUE(SelectNextTask(SequencedTaskSource::SelectTaskOption::kDefault));
   EXPECT_EQ(
       absl::nullopt,
       sequence_manager()->GetPendingWakeUp(
           &lazy_now2, SequencedTaskSource::SelectTaskOption::kSkipDelayedTask));
-  sequence_manager()->DidRunTask();
+  DidRunTask();
 
   // Tidy up.
   queue->ShutdownTaskQueue();
@@ -3633,29 +3673,29 @@ TEST_P(SequenceManagerTest,
           &lazy_now2, SequencedTaskSource::SelectTaskOption::kSkipDelayedTask));
 
   // Immediate tasks should be ready to execute, execute them.
-  EXPECT_TRUE(sequence_manager()->SelectNextTask(
-      SequencedTaskSource::SelectTaskOption::kSkipDelayedTask));
-  sequence_manager()->DidRunTask();
-  EXPECT_TRUE(sequence_manager()->SelectNextTask(
-      SequencedTaskSource::SelectTaskOption::kSkipDelayedTask));
-  sequence_manager()->DidRunTask();
+  EXPECT_TRUE(
+      SelectNextTask(SequencedTaskSource::SelectTaskOption::kSkipDelayedTask));
+  DidRunTask();
+  EXPECT_TRUE(
+      SelectNextTask(SequencedTaskSource::SelectTaskOption::kSkipDelayedTask));
+  DidRunTask();
 
   // No immediate tasks can be executed anymore.
-  EXPECT_FALSE(sequence_manager()->SelectNextTask(
-      SequencedTaskSource::SelectTaskOption::kSkipDelayedTask));
+  EXPECT_FALSE(
+      SelectNextTask(SequencedTaskSource::SelectTaskOption::kSkipDelayedTask));
   EXPECT_EQ(
       absl::nullopt,
       sequence_manager()->GetPendingWakeUp(
           &lazy_now2, SequencedTaskSource::SelectTaskOption::kSkipDelayedTask));
 
   // Execute delayed tasks.
-  EXPECT_TRUE(sequence_manager()->SelectNextTask());
-  sequence_manager()->DidRunTask();
-  EXPECT_TRUE(sequence_manager()->SelectNextTask());
-  sequence_manager()->DidRunTask();
+  EXPECT_TRUE(SelectNextTask());
+  DidRunTask();
+  EXPECT_TRUE(SelectNextTask());
+  DidRunTask();
 
   // No delayed tasks can be executed anymore.
-  EXPECT_FALSE(sequence_manager()->SelectNextTask());
+  EXPECT_FALSE(SelectNextTask());
   EXPECT_EQ(absl::nullopt, sequence_manager()->GetPendingWakeUp(&lazy_now2));
 
   // Tidy up.
@@ -5569,6 +5609,55 @@ TEST(SequenceManagerTest,
   sequence_manager.reset();
 }
 
+TEST(SequenceManagerTest, RecordsTaskQueueStats) {
+  SimpleTestTickClock clock;
+  clock.Advance(Milliseconds(1));
+  auto pump = std::make_unique<MockTimeMessagePump>(&clock);
+  MockTimeMessagePump* pump_ptr = pump.get();
+  auto sequence_manager =
+      sequence_manager::CreateSequenceManagerOnCurrentThreadWithPump(
+          std::move(pump), SequenceManager::Settings::Builder()
+                               .SetTickClock(&clock)
+                               .SetAddQueueTimeToTasks(true)
+                               .SetRecordTaskQueueStats(true)
+                               .Build());
+  auto queue = sequence_manager->CreateTaskQueue(TaskQueue::Spec("queue"));
+  auto other_queue =
+      sequence_manager->CreateTaskQueue(TaskQueue::Spec("other_queue"));
+  sequence_manager->SetDefaultTaskRunner(queue->task_runner());
+  EXPECT_EQ(0u, queue->GetStats().task_count());
+
+  queue->task_runner()->PostTask(FROM_HERE, BindLambdaForTesting([&]() {
+                                   clock.Advance(Milliseconds(2));
+                                 }));
+  queue->task_runner()->PostDelayedTask(
+      FROM_HERE,
+      BindLambdaForTesting([&]() { clock.Advance(Milliseconds(5)); }),
+      Milliseconds(100));
+  other_queue->task_runner()->PostTask(FROM_HERE, BindOnce(&NopTask));
+  // The immediate tasks wait 3ms to run.
+  clock.Advance(Milliseconds(3));
+
+  pump_ptr->SetAllowTimeToAutoAdvanceUntil(TimeTicks::Max());
+  pump_ptr->SetStopWhenMessagePumpIsIdle(true);
+  RunLoop().Run();
+
+  const TaskQueueStats stats = queue->GetStats();
+  EXPECT_EQ(2u, stats.task_count());
+  EXPECT_EQ(Milliseconds(7), stats.total_run_time());
+  EXPECT_EQ(2u, stats.queueing_delays().count());
+  // The delayed task ran when it was due, or a bit later with a leeway.
+  EXPECT_GE(stats.total_queueing_delay(), Milliseconds(3));
+  EXPECT_LE(stats.run_times().GetQuantile(0.5), Milliseconds(2));
+  EXPECT_GE(stats.run_times().GetQuantile(1), Milliseconds(4));
+
+  const TaskQueueStats other_stats = other_queue->GetStats();
+  EXPECT_EQ(1u, other_stats.task_count());
+  // The task started 2ms later than it would have without the one before.
+  EXPECT_EQ(Milliseconds(5), other_stats.total_queueing_delay());
+  EXPECT_EQ(TimeDelta(), other_stats.total_run_time());
+}
+
 }  // namespace internal
 }  // namespace sequence_manager
 }  // namespace base
@@ -14,6 +14,8 @@
 #include "base/message_loop/message_pump_type.h"
 #include "base/run_loop.h"
 #include "base/sequence_checker.h"
+#include "base/strings/strcat.h"
+#include "base/strings/string_number_conversions.h"
 #include "base/synchronization/condition_variable.h"
 #include "base/task/post_task.h"
 #include "base/task/sequence_manager/task_queue_impl.h"
@@ -23,10 +25,12 @@
 #include "base/task/sequence_manager/test/test_task_time_observer.h"
 #include "base/task/sequence_manager/thread_controller_with_message_pump_impl.h"
 #include "base/task/single_thread_task_runner.h"
+#include "base/task/task_features.h"
 #include "base/task/task_traits.h"
 #include "base/task/thread_pool.h"
 #include "base/task/thread_pool/thread_pool_impl.h"
 #include "base/task/thread_pool/thread_pool_instance.h"
+#include "base/test/scoped_feature_list.h"
 #include "base/threading/thread.h"
 #include "base/threading/thread_task_runner_handle.h"
 #include "base/time/default_tick_clock.h"
@@ -42,11 +46,13 @@ const int kNumTasks = 1000000;
 
 constexpr char kMetricPrefixSequenceManager[] = "SequenceManager.";
 constexpr char kMetricPostTimePerTask[] = "post_time_per_task";
+constexpr char kMetricTasksPerSecond[] = "tasks_per_second";
 
 perf_test::PerfResultReporter SetUpReporter(const std::string& story_name) {
   perf_test::PerfResultReporter reporter(kMetricPrefixSequenceManager,
                                          story_name);
   reporter.RegisterImportantMetric(kMetricPostTimePerTask, "us");
+  reporter.RegisterImportantMetric(kMetricTasksPerSecond, "runs/s");
   return reporter;
 }
 
@@ -525,6 +531,75 @@ class TwoThreadTestCase : public TestCase {
   int done_count_ = 0;
 };
 
+// Posts immediate tasks from several auxiliary threads at once, to measure
+// contention on the incoming queues.
+class MultiProducerTestCase : public TestCase {
+ public:
+  MultiProducerTestCase(PerfTestDelegate* delegate,
+                        std::vector<scoped_refptr<TaskRunner>> task_runners,
+                        size_t num_threads)
+      : TestCase(delegate),
+        task_runners_(std::move(task_runners)),
+        num_tasks_(kNumTasks) {
+    for (size_t i = 0; i < num_threads; i++) {
+      producer_threads_.push_back(
+          std::make_unique<Thread>("producer thread"));
+      producer_threads_.back()->Start();
+    }
+  }
+
+  ~MultiProducerTestCase() override {
+    for (auto& thread : producer_threads_)
+      thread->Stop();
+  }
+
+ protected:
+  void Start() override {
+    done_count_ = 0;
+    task_sources_.clear();
+    for (size_t i = 0; i < producer_threads_.size(); i++) {
+      task_sources_.push_back(std::make_unique<CrossThreadImmediateTaskSource>(
+          this, task_runners_, num_tasks_ / producer_threads_.size()));
+      producer_threads_[i]->task_runner()->PostTask(
+          FROM_HERE, base::BindOnce(&CrossThreadImmediateTaskSource::Start,
+                                    Unretained(task_sources_[i].get())));
+    }
+  }
+
+  class CrossThreadImmediateTaskSource : public CrossThreadTaskSource {
+   public:
+    CrossThreadImmediateTaskSource(
+        MultiProducerTestCase* multi_producer_test_case,
+        std::vector<scoped_refptr<TaskRunner>> task_runners,
+        size_t num_tasks)
+        : CrossThreadTaskSource(std::move(task_runners), num_tasks),
+          multi_producer_test_case_(multi_producer_test_case) {}
+
+    ~CrossThreadImmediateTaskSource() override = default;
+
+    void PostTask(unsigned int queue) override {
+      task_runners_[queue]->PostTask(FROM_HERE, task_closure_);
+    }
+
+    // Will be called on the main thread.
+    void SignalDone() override { multi_producer_test_case_->SignalDone(); }
+
+    raw_ptr<MultiProducerTestCase> multi_producer_test_case_;  // NOT OWNED.
+  };
+
+  void SignalDone() {
+    if (++done_count_ == task_sources_.size())
+      delegate_->SignalDone();
+  }
+
+ private:
+  const std::vector<scoped_refptr<TaskRunner>> task_runners_;
+  const size_t num_tasks_;
+  std::vector<std::unique_ptr<Thread>> producer_threads_;
+  std::vector<std::unique_ptr<CrossThreadImmediateTaskSource>> task_sources_;
+  size_t done_count_ = 0;
+};
+
 class SequenceManagerPerfTest : public testing::TestWithParam<PerfTestType> {
  public:
   SequenceManagerPerfTest() = default;
@@ -588,6 +663,8 @@ class SequenceManagerPerfTest : public testing::TestWithParam<PerfTestType> {
     reporter.AddResult(
         kMetricPostTimePerTask,
         (now - start).InMicroseconds() / static_cast<double>(kNumTasks));
+    reporter.AddResult(kMetricTasksPerSecond,
+                       kNumTasks / (now - start).InSecondsF());
   }
 
   std::unique_ptr<PerfTestDelegate> delegate_;
@@ -646,6 +723,18 @@ TEST_P(SequenceManagerPerfTest, PostDelayedTasks_ThirtyTwoQueues) {
   Benchmark("post delayed tasks with thirty two queues", &task_source);
 }
 
+TEST_P(SequenceManagerPerfTest, PostDelayedTasks_TwoHundredFiftySixQueues) {
+  if (!delegate_->VirtualTimeIsSupported() || !ShouldMeasureQueueScaling()) {
+    LOG(INFO) << "Unsupported";
+    return;
+  }
+
+  SingleThreadDelayedTestCase task_source(delegate_.get(),
+                                          CreateTaskRunners(256));
+  Benchmark("post delayed tasks with two hundred fifty six queues",
+            &task_source);
+}
+
 TEST_P(SequenceManagerPerfTest, PostImmediateTasks_OneQueue) {
   SingleThreadImmediateTestCase task_source(delegate_.get(),
                                             CreateTaskRunners(1));
@@ -685,6 +774,18 @@ TEST_P(SequenceManagerPerfTest, PostImmediateTasks_ThirtyTwoQueues) {
   Benchmark("post immediate tasks with thirty two queues", &task_source);
 }
 
+TEST_P(SequenceManagerPerfTest, PostImmediateTasks_TwoHundredFiftySixQueues) {
+  if (!ShouldMeasureQueueScaling()) {
+    LOG(INFO) << "Unsupported";
+    return;
+  }
+
+  SingleThreadImmediateTestCase task_source(delegate_.get(),
+                                            CreateTaskRunners(256));
+  Benchmark("post immediate tasks with two hundred fifty six queues",
+            &task_source);
+}
+
 TEST_P(SequenceManagerPerfTest, PostImmediateTasksFromTwoThreads_OneQueue) {
   TwoThreadTestCase task_source(delegate_.get(), CreateTaskRunners(1));
   Benchmark("post immediate tasks with one queue from two threads",
@@ -725,6 +826,59 @@ TEST_P(SequenceManagerPerfTest,
             &task_source);
 }
 
+TEST_P(SequenceManagerPerfTest, PostImmediateTasksFromFourThreads_OneQueue) {
+  MultiProducerTestCase task_source(delegate_.get(), CreateTaskRunners(1), 4);
+  Benchmark("post immediate tasks with one queue from four threads",
+            &task_source);
+}
+
+TEST_P(SequenceManagerPerfTest,
+       PostImmediateTasksFromFourThreads_OneQueue_LockFree) {
+  if (!delegate_->MultipleQueuesSupported()) {
+    // Not a SequenceManager.
+    LOG(INFO) << "Unsupported";
+    return;
+  }
+
+  test::ScopedFeatureList feature_list(kLockFreeImmediateIncomingQueue);
+  internal::TaskQueueImpl::InitializeFeatures();
+  {
+    MultiProducerTestCase task_source(delegate_.get(), CreateTaskRunners(1),
+                                      4);
+    Benchmark(
+        "post immediate tasks with one queue from four threads without lock",
+        &task_source);
+  }
+  feature_list.Reset();
+  internal::TaskQueueImpl::InitializeFeatures();
+}
+
+TEST_P(SequenceManagerPerfTest,
+       PostImmediateTasks_OneQueue_BatchTasksInDoWork) {
+  if (!delegate_->MultipleQueuesSupported()) {
+    // Not a SequenceManager.
+    LOG(INFO) << "Unsupported";
+    return;
+  }
+
+  for (int max_tasks : {1, 4, 16, 64}) {
+    test::ScopedFeatureList feature_list;
+    feature_list.InitAndEnableFeatureWithParameters(
+        kBatchTasksInDoWork, {{"max_tasks", NumberToString(max_tasks)},
+                              {"max_duration", "1s"}});
+    internal::ThreadControllerWithMessagePumpImpl::InitializeFeatures();
+    {
+      SingleThreadImmediateTestCase task_source(delegate_.get(),
+                                                CreateTaskRunners(1));
+      Benchmark(StrCat({"post immediate tasks with one queue in batches of ",
+                        NumberToString(max_tasks)}),
+                &task_source);
+    }
+    feature_list.Reset();
+    internal::ThreadControllerWithMessagePumpImpl::ResetFeatures();
+  }
+}
+
 // TODO(alexclarke): Add additional tests with different mixes of non-delayed vs
 // delayed tasks.
 
@@ -47,12 +47,16 @@ class SequencedTaskSource {
   // there're no more tasks ready to run. If a task is returned,
   // DidRunTask() must be invoked before the next call to SelectNextTask().
   // |option| allows control on which kind of tasks can be selected.
+  // |lazy_now| is used for the time-dependent work: a caller which runs
+  // several tasks in a row can pass the LazyNow of the previous DidRunTask().
   virtual absl::optional<SelectedTask> SelectNextTask(
+      LazyNow* lazy_now,
       SelectTaskOption option = SelectTaskOption::kDefault) = 0;
 
   // Notifies this source that the task previously obtained
-  // from SelectNextTask() has been completed.
-  virtual void DidRunTask() = 0;
+  // from SelectNextTask() has been completed. |lazy_now| must not have been
+  // sampled before the task ran.
+  virtual void DidRunTask(LazyNow* lazy_now) = 0;
 
   // Removes all canceled delayed tasks from the front of the queue. After
   // calling this, GetPendingWakeUp() is guaranteed to return a ready time for a
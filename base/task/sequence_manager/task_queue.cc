@@ -223,6 +223,13 @@ size_t TaskQueue::GetNumberOfPendingTasks() const {
   return impl_->GetNumberOfPendingTasks();
 }
 
+TaskQueueStats TaskQueue::GetStats() const {
+  DCHECK_CALLED_ON_VALID_THREAD(associated_thread_->thread_checker);
+  if (!impl_)
+    return TaskQueueStats();
+  return impl_->GetStats();
+}
+
 bool TaskQueue::HasTaskToRunImmediatelyOrReadyDelayedTask() const {
   DCHECK_CALLED_ON_VALID_THREAD(associated_thread_->thread_checker);
   if (!impl_)
@@ -10,6 +10,7 @@
 #include "base/memory/weak_ptr.h"
 #include "base/task/common/checked_lock.h"
 #include "base/task/sequence_manager/lazy_now.h"
+#include "base/task/sequence_manager/task_queue_stats.h"
 #include "base/task/sequence_manager/tasks.h"
 #include "base/task/single_thread_task_runner.h"
 #include "base/task/task_observer.h"
@@ -269,6 +270,11 @@ class BASE_EXPORT TaskQueue : public RefCountedThreadSafe<TaskQueue> {
   // Returns the number of pending tasks in the queue.
   size_t GetNumberOfPendingTasks() const;
 
+  // Returns a snapshot of the stats on the tasks this queue ran. They are
+  // empty unless SequenceManager::Settings::record_task_queue_stats is set.
+  // NOTE: this must be called on the thread this TaskQueue was created by.
+  TaskQueueStats GetStats() const;
+
   // Returns true iff this queue has immediate tasks or delayed tasks that are
   // ripe for execution. Ignores the queue's enabled state and fences.
   // NOTE: this must be called on the thread this TaskQueue was created by.
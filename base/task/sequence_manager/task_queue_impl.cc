@@ -6,6 +6,7 @@
 
 #include <inttypes.h>
 
+#include <algorithm>
 #include <memory>
 #include <utility>
 
@@ -73,17 +74,20 @@ namespace internal {
 
 namespace {
 
-// Cache of the state of the kRemoveCanceledTasksInTaskQueue and
-// kSweepCancelledTasks features. This avoids the need to constantly query their
-// enabled state through FeatureList::IsEnabled().
+// Cache of the state of the kRemoveCanceledTasksInTaskQueue,
+// kSweepCancelledTasks and kLockFreeImmediateIncomingQueue features. This
+// avoids the need to constantly query their enabled state through
+// FeatureList::IsEnabled().
 bool g_is_remove_canceled_tasks_in_task_queue_enabled = false;
 bool g_is_sweep_cancelled_tasks_enabled =
     kSweepCancelledTasks.default_state == FEATURE_ENABLED_BY_DEFAULT;
+bool g_is_lock_free_immediate_incoming_queue_enabled = false;
 
 }  // namespace
 
 TaskQueueImpl::GuardedTaskPoster::GuardedTaskPoster(TaskQueueImpl* outer)
-    : outer_(outer) {}
+    : outer_(outer),
+      coalesced_tasks_(MakeRefCounted<base::internal::CoalescedTasks>()) {}
 
 TaskQueueImpl::GuardedTaskPoster::~GuardedTaskPoster() {}
 
@@ -119,6 +123,27 @@ DelayedTaskHandle TaskQueueImpl::GuardedTaskPoster::PostCancelableTask(
   return DelayedTaskHandle(std::move(delayed_task_handle_delegate));
 }
 
+bool TaskQueueImpl::GuardedTaskPoster::PostCoalescedTask(
+    PostedTask task,
+    const void* key,
+    SequencedTaskRunner::CoalescingPolicy policy) {
+  // Do not process new PostTasks while we are handling a PostTask (tracing
+  // has to do this) as it can lead to a deadlock and defer it instead.
+  ScopedDeferTaskPosting disallow_task_posting;
+
+  auto token = operations_controller_.TryBeginOperation();
+  if (!token)
+    return false;
+
+  // Only the first task posted for |key| reaches the queue, and runs the latest
+  // one coalesced into it.
+  task.callback =
+      coalesced_tasks_->Coalesce(key, std::move(task.callback), policy);
+  if (task.callback)
+    outer_->PostTask(std::move(task));
+  return true;
+}
+
 TaskQueueImpl::TaskRunner::TaskRunner(
     scoped_refptr<GuardedTaskPoster> task_poster,
     scoped_refptr<AssociatedThreadId> associated_thread,
@@ -189,6 +214,16 @@ bool TaskQueueImpl::TaskRunner::PostNonNestableDelayedTask(
                                            task_type_));
 }
 
+bool TaskQueueImpl::TaskRunner::PostCoalescedTask(const Location& location,
+                                                  const void* key,
+                                                  OnceClosure callback,
+                                                  CoalescingPolicy policy) {
+  return task_poster_->PostCoalescedTask(
+      PostedTask(this, std::move(callback), location, TimeDelta(),
+                 Nestable::kNestable, task_type_),
+      key, policy);
+}
+
 bool TaskQueueImpl::TaskRunner::RunsTasksInCurrentSequence() const {
   return associated_thread_->IsBoundToCurrentThread();
 }
@@ -198,6 +233,8 @@ void TaskQueueImpl::InitializeFeatures() {
   ApplyRemoveCanceledTasksInTaskQueue();
   g_is_sweep_cancelled_tasks_enabled =
       FeatureList::IsEnabled(kSweepCancelledTasks);
+  g_is_lock_free_immediate_incoming_queue_enabled =
+      FeatureList::IsEnabled(kLockFreeImmediateIncomingQueue);
 }
 
 // static
@@ -295,11 +332,13 @@ void TaskQueueImpl::UnregisterTaskQueue() {
   {
     base::internal::CheckedAutoLock lock(any_thread_lock_);
     any_thread_.unregistered = true;
+    MoveLockFreeIncomingTasksLocked();
     immediate_incoming_queue.swap(any_thread_.immediate_incoming_queue);
 
     for (auto& handler : any_thread_.on_task_posted_handlers)
       handler.first->UnregisterTaskQueue();
     any_thread_.on_task_posted_handlers.swap(on_task_posted_handlers);
+    has_on_task_posted_handlers_.store(false, std::memory_order_release);
   }
 
   if (main_thread_only().wake_up_queue) {
@@ -415,7 +454,23 @@ void TaskQueueImpl::PostImmediateTaskImpl(PostedTask task,
   CHECK(task.callback);
 
   bool should_schedule_work = false;
-  {
+  if (g_is_lock_free_immediate_incoming_queue_enabled) {
+    TimeTicks queue_time;
+    if (sequence_manager_->GetAddQueueTimeToTasks() || delayed_fence_allowed_)
+      queue_time = sequence_manager_->any_thread_clock()->NowTicks();
+
+    // Without the lock, concurrent posts can push their tasks out of sequence
+    // number order. AtomicTaskQueue sorts them when they're taken.
+    EnqueueOrder sequence_number = sequence_manager_->GetNextSequenceNumber();
+    Task pending_task(std::move(task), sequence_number, EnqueueOrder(),
+                      queue_time);
+#if DCHECK_IS_ON()
+    pending_task.cross_thread_ =
+        (current_thread == TaskQueueImpl::CurrentThread::kNotMainThread);
+#endif
+    should_schedule_work =
+        PushOntoLockFreeIncomingQueue(std::move(pending_task), sequence_number);
+  } else {
     // TODO(alexclarke): Maybe add a main thread only immediate_incoming_queue
     // See https://crbug.com/901800
     base::internal::CheckedAutoLock lock(any_thread_lock_);
@@ -454,10 +509,10 @@ void TaskQueueImpl::PostImmediateTaskImpl(PostedTask task,
     // TaskQueueSelector which can only be done from the main thread. In
     // addition it may need to schedule a DoWork if this queue isn't blocked.
     if (was_immediate_incoming_queue_empty &&
-        any_thread_.immediate_work_queue_empty) {
+        immediate_work_queue_empty_.load(std::memory_order_relaxed)) {
       empty_queues_to_reload_handle_.SetActive(true);
-      should_schedule_work =
-          any_thread_.post_immediate_task_should_schedule_work;
+      should_schedule_work = post_immediate_task_should_schedule_work_.load(
+          std::memory_order_relaxed);
     }
   }
 
@@ -466,7 +521,7 @@ void TaskQueueImpl::PostImmediateTaskImpl(PostedTask task,
   // http://shortn/_ntnKNqjDQT for a discussion.
   //
   // Calling ScheduleWork outside the lock should be safe, only the main thread
-  // can mutate |any_thread_.post_immediate_task_should_schedule_work|. If it
+  // can mutate |post_immediate_task_should_schedule_work_|. If it
   // transitions to false we call ScheduleWork redundantly that's harmless. If
   // it transitions to true, the side effect of
   // |empty_queues_to_reload_handle_SetActive(true)| is guaranteed to be picked
@@ -478,6 +533,44 @@ void TaskQueueImpl::PostImmediateTaskImpl(PostedTask task,
   TraceQueueSize();
 }
 
+bool TaskQueueImpl::PushOntoLockFreeIncomingQueue(
+    Task task,
+    EnqueueOrder sequence_number) {
+  sequence_manager_->WillQueueTask(&task, name_);
+  MaybeReportIpcTaskQueuedFromAnyThreadUnlocked(task, name_);
+
+  if (has_on_task_posted_handlers_.load(std::memory_order_acquire)) {
+    base::internal::CheckedAutoLock lock(any_thread_lock_);
+    for (auto& handler : any_thread_.on_task_posted_handlers) {
+      DCHECK(!handler.second.is_null());
+      handler.second.Run(task);
+    }
+  }
+
+  if (!lock_free_incoming_queue_.Push(std::move(task), sequence_number))
+    return false;
+
+  // As in the locked path, the SequenceManager is informed if the queue was
+  // completely empty. The main thread checks |lock_free_incoming_queue_| after
+  // setting |immediate_work_queue_empty_| (see
+  // UpdateCrossThreadQueueStateLocked()). Both sides use sequentially
+  // consistent operations, so a task pushed while the work queue becomes empty
+  // is seen by at least one of them.
+  if (!immediate_work_queue_empty_.load(std::memory_order_seq_cst))
+    return false;
+  empty_queues_to_reload_handle_.SetActive(true);
+  return post_immediate_task_should_schedule_work_.load(
+      std::memory_order_relaxed);
+}
+
+void TaskQueueImpl::MoveLockFreeIncomingTasksLocked() const {
+  if (lock_free_incoming_queue_.empty())
+    return;
+  lock_free_incoming_queue_.TakeTasks(
+      &any_thread_.immediate_incoming_queue,
+      [this]() { return sequence_manager_->GetNextSequenceNumber(); });
+}
+
 void TaskQueueImpl::PostDelayedTaskImpl(PostedTask posted_task,
                                         CurrentThread current_thread) {
   // Use CHECK instead of DCHECK to crash earlier. See http://crbug.com/711167
@@ -559,6 +652,12 @@ void TaskQueueImpl::ScheduleDelayedWorkTask(Task pending_task) {
 }
 
 void TaskQueueImpl::ReloadEmptyImmediateWorkQueue() {
+  // A post to |lock_free_incoming_queue_| can request a reload after the work
+  // queue was refilled. It is then reloaded when it becomes empty again.
+  if (g_is_lock_free_immediate_incoming_queue_enabled &&
+      !main_thread_only().immediate_work_queue->Empty()) {
+    return;
+  }
   DCHECK(main_thread_only().immediate_work_queue->Empty());
   main_thread_only().immediate_work_queue->TakeImmediateIncomingQueueTasks();
 
@@ -570,6 +669,7 @@ void TaskQueueImpl::ReloadEmptyImmediateWorkQueue() {
 void TaskQueueImpl::TakeImmediateIncomingQueueTasks(TaskDeque* queue) {
   base::internal::CheckedAutoLock lock(any_thread_lock_);
   DCHECK(queue->empty());
+  MoveLockFreeIncomingTasksLocked();
   queue->swap(any_thread_.immediate_incoming_queue);
 
   // Since |immediate_incoming_queue| is empty, now is a good time to consider
@@ -611,7 +711,8 @@ bool TaskQueueImpl::IsEmpty() const {
   }
 
   base::internal::CheckedAutoLock lock(any_thread_lock_);
-  return any_thread_.immediate_incoming_queue.empty();
+  return any_thread_.immediate_incoming_queue.empty() &&
+         lock_free_incoming_queue_.empty();
 }
 
 size_t TaskQueueImpl::GetNumberOfPendingTasks() const {
@@ -622,9 +723,16 @@ size_t TaskQueueImpl::GetNumberOfPendingTasks() const {
 
   base::internal::CheckedAutoLock lock(any_thread_lock_);
   task_count += any_thread_.immediate_incoming_queue.size();
+  task_count += lock_free_incoming_queue_.size();
   return task_count;
 }
 
+TaskQueueStats TaskQueueImpl::GetStats() const {
+  if (!main_thread_only().stats)
+    return TaskQueueStats();
+  return *main_thread_only().stats;
+}
+
 bool TaskQueueImpl::HasTaskToRunImmediatelyOrReadyDelayedTask() const {
   // Any work queue tasks count as immediate work.
   if (!main_thread_only().delayed_work_queue->Empty() ||
@@ -642,7 +750,8 @@ bool TaskQueueImpl::HasTaskToRunImmediatelyOrReadyDelayedTask() const {
 
   // Finally tasks on |immediate_incoming_queue| count as immediate work.
   base::internal::CheckedAutoLock lock(any_thread_lock_);
-  return !any_thread_.immediate_incoming_queue.empty();
+  return !any_thread_.immediate_incoming_queue.empty() ||
+         !lock_free_incoming_queue_.empty();
 }
 
 absl::optional<WakeUp> TaskQueueImpl::GetNextDesiredWakeUp() {
@@ -759,6 +868,7 @@ void TaskQueueImpl::TraceQueueSize() const {
   {
     base::internal::CheckedAutoLock lock(any_thread_lock_);
     total_task_count = any_thread_.immediate_incoming_queue.size() +
+                       lock_free_incoming_queue_.size() +
                        main_thread_only().immediate_work_queue->Size() +
                        main_thread_only().delayed_work_queue->Size() +
                        main_thread_only().delayed_incoming_queue.size();
@@ -809,6 +919,7 @@ TaskQueue::QueuePriority TaskQueueImpl::GetQueuePriority() const {
 
 Value TaskQueueImpl::AsValue(TimeTicks now, bool force_verbose) const {
   base::internal::CheckedAutoLock lock(any_thread_lock_);
+  MoveLockFreeIncomingTasksLocked();
   Value state(Value::Type::DICTIONARY);
   state.SetStringKey("name", GetName());
   if (any_thread_.unregistered) {
@@ -939,6 +1050,7 @@ void TaskQueueImpl::InsertFence(Fence current_fence) {
 
   {
     base::internal::CheckedAutoLock lock(any_thread_lock_);
+    MoveLockFreeIncomingTasksLocked();
     if (!front_task_unblocked && previous_fence &&
         previous_fence->task_order() < current_fence.task_order()) {
       if (!any_thread_.immediate_incoming_queue.empty() &&
@@ -980,6 +1092,7 @@ void TaskQueueImpl::RemoveFence() {
 
   {
     base::internal::CheckedAutoLock lock(any_thread_lock_);
+    MoveLockFreeIncomingTasksLocked();
     if (!front_task_unblocked && previous_fence) {
       if (!any_thread_.immediate_incoming_queue.empty() &&
           any_thread_.immediate_incoming_queue.front().task_order() >
@@ -1007,6 +1120,7 @@ bool TaskQueueImpl::BlockedByFence() const {
   }
 
   base::internal::CheckedAutoLock lock(any_thread_lock_);
+  MoveLockFreeIncomingTasksLocked();
   if (any_thread_.immediate_incoming_queue.empty())
     return true;
 
@@ -1181,19 +1295,28 @@ void TaskQueueImpl::SetShouldReportPostedTasksWhenDisabled(bool should_report) {
 }
 
 void TaskQueueImpl::UpdateCrossThreadQueueStateLocked() {
-  any_thread_.immediate_work_queue_empty =
+  const bool immediate_work_queue_empty =
       main_thread_only().immediate_work_queue->Empty();
+  immediate_work_queue_empty_.store(immediate_work_queue_empty,
+                                    std::memory_order_seq_cst);
+  // A post to |lock_free_incoming_queue_| which raced with the work queue
+  // becoming empty may not have requested a reload; see
+  // PushOntoLockFreeIncomingQueue().
+  if (immediate_work_queue_empty && !lock_free_incoming_queue_.empty())
+    empty_queues_to_reload_handle_.SetActive(true);
 
   if (main_thread_only().throttler) {
     // If there's a Throttler, always ScheduleWork() when immediate work is
     // posted and the queue is enabled, to ensure that
     // Throttler::OnHasImmediateTask() is invoked.
-    any_thread_.post_immediate_task_should_schedule_work = IsQueueEnabled();
+    post_immediate_task_should_schedule_work_.store(IsQueueEnabled(),
+                                                    std::memory_order_relaxed);
   } else {
     // Otherwise, ScheduleWork() only if the queue is enabled and there isn't a
     // fence to prevent the task from being executed.
-    any_thread_.post_immediate_task_should_schedule_work =
-        IsQueueEnabled() && !main_thread_only().current_fence;
+    post_immediate_task_should_schedule_work_.store(
+        IsQueueEnabled() && !main_thread_only().current_fence,
+        std::memory_order_relaxed);
   }
 
 #if DCHECK_IS_ON()
@@ -1255,7 +1378,7 @@ void TaskQueueImpl::RequeueDeferredNonNestableTask(
       base::internal::CheckedAutoLock lock(any_thread_lock_);
       empty_queues_to_reload_handle_.SetActive(false);
 
-      any_thread_.immediate_work_queue_empty = false;
+      immediate_work_queue_empty_.store(false, std::memory_order_relaxed);
       main_thread_only().immediate_work_queue->PushNonNestableTaskToFront(
           std::move(task.task));
 
@@ -1312,13 +1435,15 @@ bool TaskQueueImpl::HasTaskToRunImmediately() const {
 
   // Finally tasks on |immediate_incoming_queue| count as immediate work.
   base::internal::CheckedAutoLock lock(any_thread_lock_);
-  return !any_thread_.immediate_incoming_queue.empty();
+  return !any_thread_.immediate_incoming_queue.empty() ||
+         !lock_free_incoming_queue_.empty();
 }
 
 bool TaskQueueImpl::HasTaskToRunImmediatelyLocked() const {
   return !main_thread_only().delayed_work_queue->Empty() ||
          !main_thread_only().immediate_work_queue->Empty() ||
-         !any_thread_.immediate_incoming_queue.empty();
+         !any_thread_.immediate_incoming_queue.empty() ||
+         !lock_free_incoming_queue_.empty();
 }
 
 void TaskQueueImpl::SetOnTaskStartedHandler(
@@ -1353,6 +1478,28 @@ bool TaskQueueImpl::RequiresTaskTiming() const {
          !main_thread_only().on_task_completed_handler.is_null();
 }
 
+void TaskQueueImpl::RecordTaskStats(const Task& task,
+                                    TimeTicks start_time,
+                                    TimeTicks end_time) {
+  // The time the task was ready to run is only known for the delayed tasks,
+  // and for the immediate ones if the SequenceManager adds their queue time.
+  const TimeTicks ready_time = task.GetDesiredExecutionTime();
+  absl::optional<TimeDelta> queueing_delay;
+  if (!ready_time.is_null())
+    queueing_delay = std::max(start_time - ready_time, TimeDelta());
+  const TimeDelta run_time = end_time - start_time;
+
+  if (!main_thread_only().stats)
+    main_thread_only().stats = std::make_unique<TaskQueueStats>();
+  main_thread_only().stats->RecordTask(queueing_delay, run_time);
+
+  // The queueing delay of the tasks for which it isn't known is traced as 0.
+  TRACE_COUNTER_ID2(TRACE_DISABLED_BY_DEFAULT("sequence_manager"), GetName(),
+                    this, "run_time_us", run_time.InMicroseconds(),
+                    "queueing_delay_us",
+                    queueing_delay.value_or(TimeDelta()).InMicroseconds());
+}
+
 std::unique_ptr<TaskQueue::OnTaskPostedCallbackHandle>
 TaskQueueImpl::AddOnTaskPostedHandler(OnTaskPostedHandler handler) {
   DCHECK(should_notify_observers_ && !handler.is_null());
@@ -1362,6 +1509,7 @@ TaskQueueImpl::AddOnTaskPostedHandler(OnTaskPostedHandler handler) {
                                                        associated_thread_);
   any_thread_.on_task_posted_handlers.insert(
       {handle.get(), std::move(handler)});
+  has_on_task_posted_handlers_.store(true, std::memory_order_release);
   return handle;
 }
 
@@ -1370,6 +1518,8 @@ void TaskQueueImpl::RemoveOnTaskPostedHandler(
         on_task_posted_callback_handle) {
   base::internal::CheckedAutoLock lock(any_thread_lock_);
   any_thread_.on_task_posted_handlers.erase(on_task_posted_callback_handle);
+  has_on_task_posted_handlers_.store(
+      !any_thread_.on_task_posted_handlers.empty(), std::memory_order_release);
 }
 
 void TaskQueueImpl::SetTaskExecutionTraceLogger(
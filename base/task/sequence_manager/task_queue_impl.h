@@ -7,6 +7,7 @@
 
 #include <stddef.h>
 
+#include <atomic>
 #include <functional>
 #include <memory>
 #include <queue>
@@ -23,14 +24,17 @@
 #include "base/observer_list.h"
 #include "base/pending_task.h"
 #include "base/task/common/checked_lock.h"
+#include "base/task/common/coalesced_tasks.h"
 #include "base/task/common/operations_controller.h"
 #include "base/task/sequence_manager/associated_thread_id.h"
 #include "base/task/sequence_manager/atomic_flag_set.h"
+#include "base/task/sequence_manager/atomic_task_queue.h"
 #include "base/task/sequence_manager/enqueue_order.h"
 #include "base/task/sequence_manager/fence.h"
 #include "base/task/sequence_manager/lazily_deallocated_deque.h"
 #include "base/task/sequence_manager/sequenced_task_source.h"
 #include "base/task/sequence_manager/task_queue.h"
+#include "base/task/sequence_manager/task_queue_stats.h"
 #include "base/threading/thread_checker.h"
 #include "base/time/time_override.h"
 #include "base/trace_event/base_tracing_forward.h"
@@ -64,6 +68,10 @@ class WakeUpQueue;
 // |immediate_work_queue| is swapped with |immediate_incoming_queue| when
 // |immediate_work_queue| becomes empty.
 //
+// With the kLockFreeImmediateIncomingQueue feature, tasks are instead pushed
+// without locking onto |lock_free_incoming_queue_|, an AtomicTaskQueue which
+// the main thread moves to |immediate_incoming_queue| under the lock.
+//
 // Delayed tasks are initially posted to |delayed_incoming_queue| and a wake-up
 // is scheduled with the TimeDomain.  When the delay has elapsed, the TimeDomain
 // calls UpdateDelayedWorkQueue and ready delayed tasks are moved into the
@@ -136,6 +144,7 @@ class BASE_EXPORT TaskQueueImpl {
   void SetShouldReportPostedTasksWhenDisabled(bool should_report);
   bool IsEmpty() const;
   size_t GetNumberOfPendingTasks() const;
+  TaskQueueStats GetStats() const;
   bool HasTaskToRunImmediatelyOrReadyDelayedTask() const;
   absl::optional<WakeUp> GetNextDesiredWakeUp();
   void SetQueuePriority(TaskQueue::QueuePriority priority);
@@ -262,6 +271,12 @@ class BASE_EXPORT TaskQueueImpl {
                        LazyNow* lazy_now);
   bool RequiresTaskTiming() const;
 
+  // Records in the stats of this queue that |task| ran from |start_time| to
+  // |end_time|.
+  void RecordTaskStats(const Task& task,
+                       TimeTicks start_time,
+                       TimeTicks end_time);
+
   // Add a callback for adding custom functionality for processing posted task.
   // Callback will be dispatched while holding a scheduler lock. As a result,
   // callback should not call scheduler APIs directly, as this can lead to
@@ -312,6 +327,9 @@ class BASE_EXPORT TaskQueueImpl {
 
     bool PostTask(PostedTask task);
     DelayedTaskHandle PostCancelableTask(PostedTask task);
+    bool PostCoalescedTask(PostedTask task,
+                           const void* key,
+                           SequencedTaskRunner::CoalescingPolicy policy);
 
     void StartAcceptingOperations() {
       operations_controller_.StartAcceptingOperations();
@@ -329,6 +347,8 @@ class BASE_EXPORT TaskQueueImpl {
     base::internal::OperationsController operations_controller_;
     // Pointer might be stale, access guarded by |operations_controller_|
     const raw_ptr<TaskQueueImpl> outer_;
+    // Shared by all the TaskRunners of the queue.
+    const scoped_refptr<base::internal::CoalescedTasks> coalesced_tasks_;
   };
 
   class TaskRunner final : public SingleThreadTaskRunner {
@@ -358,6 +378,10 @@ class BASE_EXPORT TaskQueueImpl {
     bool PostNonNestableDelayedTask(const Location& location,
                                     OnceClosure callback,
                                     TimeDelta delay) final;
+    bool PostCoalescedTask(const Location& location,
+                           const void* key,
+                           OnceClosure callback,
+                           CoalescingPolicy policy) final;
     bool RunsTasksInCurrentSequence() const final;
 
    private:
@@ -476,6 +500,8 @@ class BASE_EXPORT TaskQueueImpl {
     // Whether or not the task queue should emit tracing events for tasks
     // posted to this queue when it is disabled.
     bool should_report_posted_tasks_when_disabled = false;
+    // Allocated on the first recorded task, see RecordTaskStats().
+    std::unique_ptr<TaskQueueStats> stats;
   };
 
   void PostTask(PostedTask task);
@@ -509,6 +535,16 @@ class BASE_EXPORT TaskQueueImpl {
   // Can be called from any thread.
   void TakeImmediateIncomingQueueTasks(TaskDeque* queue);
 
+  // Pushes |task| onto |lock_free_incoming_queue_|. Returns true if the
+  // SequenceManager must be notified that the queue was empty.
+  bool PushOntoLockFreeIncomingQueue(Task task, EnqueueOrder sequence_number);
+
+  // Moves the tasks of |lock_free_incoming_queue_| to the back of
+  // |any_thread_.immediate_incoming_queue|. This doesn't change the state of
+  // the queue as observed from outside, hence the const. Main thread only.
+  void MoveLockFreeIncomingTasksLocked() const
+      EXCLUSIVE_LOCKS_REQUIRED(any_thread_lock_);
+
   void TraceQueueSize() const;
   static Value QueueAsValue(const TaskDeque& queue, TimeTicks now);
   static Value TaskAsValue(const Task& task, TimeTicks now);
@@ -575,12 +611,8 @@ class BASE_EXPORT TaskQueueImpl {
     AnyThread();
     ~AnyThread();
 
-    TaskDeque immediate_incoming_queue;
-
-    // True if main_thread_only().immediate_work_queue is empty.
-    bool immediate_work_queue_empty = true;
-
-    bool post_immediate_task_should_schedule_work = true;
+    // Mutable for MoveLockFreeIncomingTasksLocked().
+    mutable TaskDeque immediate_incoming_queue;
 
     bool unregistered = false;
 
@@ -600,6 +632,21 @@ class BASE_EXPORT TaskQueueImpl {
 
   AnyThread any_thread_ GUARDED_BY(any_thread_lock_);
 
+  // Tasks posted while kLockFreeImmediateIncomingQueue is enabled. Mutable for
+  // MoveLockFreeIncomingTasksLocked().
+  mutable AtomicTaskQueue lock_free_incoming_queue_;
+
+  // True if main_thread_only().immediate_work_queue is empty. Written with
+  // |any_thread_lock_| held, but read without it when posting to
+  // |lock_free_incoming_queue_|.
+  std::atomic<bool> immediate_work_queue_empty_{true};
+
+  std::atomic<bool> post_immediate_task_should_schedule_work_{true};
+
+  // Mirrors !any_thread_.on_task_posted_handlers.empty(), so that posting to
+  // |lock_free_incoming_queue_| only takes the lock when there are handlers.
+  std::atomic<bool> has_on_task_posted_handlers_{false};
+
   MainThreadOnly main_thread_only_;
   MainThreadOnly& main_thread_only() {
     DCHECK_CALLED_ON_VALID_THREAD(associated_thread_->thread_checker);
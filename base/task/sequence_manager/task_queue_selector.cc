@@ -74,12 +74,6 @@ void TaskQueueSelector::SetQueuePriority(internal::TaskQueueImpl* queue,
   DCHECK_EQ(priority, queue->GetQueuePriority());
 }
 
-TaskQueue::QueuePriority TaskQueueSelector::NextPriority(
-    TaskQueue::QueuePriority priority) {
-  DCHECK(priority < TaskQueue::kQueuePriorityCount);
-  return static_cast<TaskQueue::QueuePriority>(static_cast<int>(priority) + 1);
-}
-
 void TaskQueueSelector::AddQueueImpl(internal::TaskQueueImpl* queue,
                                      TaskQueue::QueuePriority priority) {
 #if DCHECK_IS_ON()
@@ -119,28 +113,28 @@ void TaskQueueSelector::RemoveQueueImpl(internal::TaskQueueImpl* queue) {
 }
 
 void TaskQueueSelector::WorkQueueSetBecameEmpty(size_t set_index) {
-  non_empty_set_counts_[set_index]--;
-  DCHECK_GE(non_empty_set_counts_[set_index], 0);
-
-  // There are no delayed or immediate tasks for |set_index| so remove from
-  // |active_priority_tracker_|.
-  if (non_empty_set_counts_[set_index] == 0) {
-    active_priority_tracker_.SetActive(
-        static_cast<TaskQueue::QueuePriority>(set_index), false);
-  }
+  UpdateActivePriority(static_cast<TaskQueue::QueuePriority>(set_index));
 }
 
 void TaskQueueSelector::WorkQueueSetBecameNonEmpty(size_t set_index) {
-  non_empty_set_counts_[set_index]++;
-  DCHECK_LE(non_empty_set_counts_[set_index], kMaxNonEmptySetCount);
-
-  // There is now a delayed or an immediate task for |set_index|, so add to
-  // |active_priority_tracker_|.
-  if (non_empty_set_counts_[set_index] == 1) {
-    TaskQueue::QueuePriority priority =
-        static_cast<TaskQueue::QueuePriority>(set_index);
-    active_priority_tracker_.SetActive(priority, true);
+  UpdateActivePriority(static_cast<TaskQueue::QueuePriority>(set_index));
+}
+
+void TaskQueueSelector::UpdateActivePriority(
+    TaskQueue::QueuePriority priority) {
+  // The sets notify after updating their heaps, and the observer isn't told
+  // which of the two sets changed, so the trackers mirror the sets' emptiness
+  // rather than counting transitions.
+  const bool has_immediate_tasks =
+      !immediate_work_queue_sets_.IsSetEmpty(priority);
+  if (immediate_active_priority_tracker_.IsActive(priority) !=
+      has_immediate_tasks) {
+    immediate_active_priority_tracker_.SetActive(priority,
+                                                 has_immediate_tasks);
   }
+  const bool has_tasks = HasTasksWithPriority(priority);
+  if (active_priority_tracker_.IsActive(priority) != has_tasks)
+    active_priority_tracker_.SetActive(priority, has_tasks);
 }
 
 void TaskQueueSelector::CollectSkippedOverLowerPriorityTasks(
@@ -181,11 +175,8 @@ WorkQueue* TaskQueueSelector::SelectWorkQueueToService(
   // priority.
   TaskQueue::QueuePriority priority = highest_priority.value();
 
-  // For selecting an immediate queue only, the highest priority can be used as
-  // a starting priority, but it is required to check work at other priorities.
-  // For the case where a delayed task is at a higher priority than an immediate
-  // task, HighestActivePriority(...) returns the priority of the delayed task
-  // but the resulting queue must be the lower one.
+  // For selecting an immediate queue only, |priority| is the highest priority
+  // with immediate work, which may be lower than that of a delayed task.
   if (option == SelectTaskOption::kSkipDelayedTask) {
     WorkQueue* queue =
 #if DCHECK_IS_ON()
@@ -229,23 +220,13 @@ void TaskQueueSelector::SetTaskQueueSelectorObserver(Observer* observer) {
 absl::optional<TaskQueue::QueuePriority>
 TaskQueueSelector::GetHighestPendingPriority(SelectTaskOption option) const {
   DCHECK_CALLED_ON_VALID_THREAD(associated_thread_->thread_checker);
-  if (!active_priority_tracker_.HasActivePriority())
+  const ActivePriorityTracker& tracker =
+      option == SelectTaskOption::kSkipDelayedTask
+          ? immediate_active_priority_tracker_
+          : active_priority_tracker_;
+  if (!tracker.HasActivePriority())
     return absl::nullopt;
-
-  TaskQueue::QueuePriority highest_priority =
-      active_priority_tracker_.HighestActivePriority();
-  if (option != SelectTaskOption::kSkipDelayedTask)
-    return highest_priority;
-
-  for (; highest_priority != TaskQueue::kQueuePriorityCount;
-       highest_priority = NextPriority(highest_priority)) {
-    if (active_priority_tracker_.IsActive(highest_priority) &&
-        !immediate_work_queue_sets_.IsSetEmpty(highest_priority)) {
-      return highest_priority;
-    }
-  }
-
-  return absl::nullopt;
+  return tracker.HighestActivePriority();
 }
 
 void TaskQueueSelector::SetImmediateStarvationCountForTest(
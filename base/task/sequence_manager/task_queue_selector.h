@@ -79,8 +79,8 @@ class BASE_EXPORT TaskQueueSelector : public WorkQueueSets::Observer {
   // on the main thread. If |observer| is null, then no callbacks will occur.
   void SetTaskQueueSelectorObserver(Observer* observer);
 
-  // Returns the priority of the most important pending task if one exists.
-  // O(1).
+  // Returns the priority of the most important pending task if one exists,
+  // considering only immediate tasks under kSkipDelayedTask. O(1).
   absl::optional<TaskQueue::QueuePriority> GetHighestPendingPriority(
       SelectTaskOption option = SelectTaskOption::kDefault) const;
 
@@ -223,29 +223,27 @@ class BASE_EXPORT TaskQueueSelector : public WorkQueueSets::Observer {
     return ChooseDelayedOnlyWithPriority<SetOperation>(priority);
   }
 
-  // Returns the priority which is next after |priority|.
-  static TaskQueue::QueuePriority NextPriority(
-      TaskQueue::QueuePriority priority);
-
   // Returns true if there are pending tasks with priority |priority|.
   bool HasTasksWithPriority(TaskQueue::QueuePriority priority) const;
 
+  // Updates the active priority trackers for |priority| after one of its sets
+  // became empty or non-empty.
+  void UpdateActivePriority(TaskQueue::QueuePriority priority);
+
   scoped_refptr<AssociatedThreadId> associated_thread_;
 
 #if DCHECK_IS_ON()
   const bool random_task_selection_ = false;
 #endif
 
-  // Count of the number of sets (delayed or immediate) for each priority.
-  // Should only contain 0, 1 or 2.
-  std::array<int, TaskQueue::kQueuePriorityCount> non_empty_set_counts_ = {{0}};
-
-  static constexpr const int kMaxNonEmptySetCount = 2;
-
   // List of active priorities, which is used to work out which priority to run
   // next.
   ActivePriorityTracker active_priority_tracker_;
 
+  // List of priorities with pending immediate tasks, which is used to work out
+  // which priority to run next when delayed tasks are skipped.
+  ActivePriorityTracker immediate_active_priority_tracker_;
+
   WorkQueueSets delayed_work_queue_sets_;
   WorkQueueSets immediate_work_queue_sets_;
   size_t immediate_starvation_count_ = 0;
@@ -360,6 +360,43 @@ TEST_F(TaskQueueSelectorTest, GetHighestPendingPriority) {
   EXPECT_FALSE(selector_.GetHighestPendingPriority().has_value());
 }
 
+TEST_F(TaskQueueSelectorTest, GetHighestPendingPrioritySkipDelayedTask) {
+  selector_.SetQueuePriority(task_queues_[0].get(), TaskQueue::kHighPriority);
+  task_queues_[0]->delayed_work_queue()->Push(
+      Task(PostedTask(nullptr, test_closure_, FROM_HERE), EnqueueOrder(),
+           EnqueueOrder::FromIntForTesting(1)));
+  EXPECT_EQ(TaskQueue::kHighPriority, *selector_.GetHighestPendingPriority());
+  EXPECT_FALSE(selector_
+                   .GetHighestPendingPriority(
+                       TaskQueueSelector::SelectTaskOption::kSkipDelayedTask)
+                   .has_value());
+
+  task_queues_[1]->immediate_work_queue()->Push(
+      Task(PostedTask(nullptr, test_closure_, FROM_HERE), EnqueueOrder(),
+           EnqueueOrder::FromIntForTesting(2)));
+  EXPECT_EQ(TaskQueue::kHighPriority, *selector_.GetHighestPendingPriority());
+  EXPECT_EQ(TaskQueue::kNormalPriority,
+            *selector_.GetHighestPendingPriority(
+                TaskQueueSelector::SelectTaskOption::kSkipDelayedTask));
+
+  // Moving the immediate task's queue to a higher priority updates both.
+  selector_.SetQueuePriority(task_queues_[1].get(),
+                             TaskQueue::kHighestPriority);
+  EXPECT_EQ(TaskQueue::kHighestPriority,
+            *selector_.GetHighestPendingPriority());
+  EXPECT_EQ(TaskQueue::kHighestPriority,
+            *selector_.GetHighestPendingPriority(
+                TaskQueueSelector::SelectTaskOption::kSkipDelayedTask));
+
+  task_queues_[1]->SetQueueEnabled(false);
+  selector_.DisableQueue(task_queues_[1].get());
+  EXPECT_EQ(TaskQueue::kHighPriority, *selector_.GetHighestPendingPriority());
+  EXPECT_FALSE(selector_
+                   .GetHighestPendingPriority(
+                       TaskQueueSelector::SelectTaskOption::kSkipDelayedTask)
+                   .has_value());
+}
+
 TEST_F(TaskQueueSelectorTest, ChooseWithPriority_Empty) {
   EXPECT_EQ(
       nullptr,
@@ -0,0 +1,114 @@
+// Copyright 2022 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "base/task/sequence_manager/task_queue_stats.h"
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+
+#include "base/bits.h"
+#include "base/check_op.h"
+#include "base/notreached.h"
+
+namespace base {
+namespace sequence_manager {
+
+namespace {
+
+// The bits of a duration that its bucket keeps, after its leading one.
+constexpr int kPrecisionBits = 3;
+
+// The durations below are exact.
+constexpr int64_t kExactLimit = 1 << kPrecisionBits;
+
+constexpr int64_t kMaxMicroseconds = std::numeric_limits<int32_t>::max();
+
+}  // namespace
+
+TaskQueueStats::DurationHistogram::DurationHistogram() = default;
+
+TaskQueueStats::DurationHistogram::DurationHistogram(
+    const DurationHistogram& other) = default;
+
+TaskQueueStats::DurationHistogram& TaskQueueStats::DurationHistogram::operator=(
+    const DurationHistogram& other) = default;
+
+TaskQueueStats::DurationHistogram::~DurationHistogram() = default;
+
+void TaskQueueStats::DurationHistogram::Add(TimeDelta duration) {
+  ++buckets_[GetBucketIndex(duration.InMicroseconds())];
+  ++count_;
+}
+
+TimeDelta TaskQueueStats::DurationHistogram::GetQuantile(
+    double quantile) const {
+  DCHECK_GE(quantile, 0.0);
+  DCHECK_LE(quantile, 1.0);
+  if (count_ == 0)
+    return TimeDelta();
+
+  // The rank of the duration of |quantile|, from 1.
+  const uint64_t rank = std::clamp<uint64_t>(
+      static_cast<uint64_t>(std::ceil(quantile * count_)), 1, count_);
+  uint64_t count = 0;
+  for (size_t i = 0; i < kBucketCount; ++i) {
+    count += buckets_[i];
+    if (count >= rank)
+      return Microseconds(GetBucketMin(i) + (GetBucketSize(i) - 1) / 2.0);
+  }
+  NOTREACHED();
+  return TimeDelta();
+}
+
+// static
+size_t TaskQueueStats::DurationHistogram::GetBucketIndex(int64_t microseconds) {
+  microseconds = std::clamp<int64_t>(microseconds, 0, kMaxMicroseconds);
+  if (microseconds < kExactLimit)
+    return static_cast<size_t>(microseconds);
+  const int log2 = bits::Log2Floor(static_cast<uint32_t>(microseconds));
+  const int ignored_bits = log2 - kPrecisionBits;
+  return static_cast<size_t>((ignored_bits + 1) * kExactLimit +
+                             ((microseconds >> ignored_bits) - kExactLimit));
+}
+
+// static
+int64_t TaskQueueStats::DurationHistogram::GetBucketMin(size_t index) {
+  DCHECK_LT(index, kBucketCount);
+  if (index < kExactLimit)
+    return static_cast<int64_t>(index);
+  const size_t ignored_bits = index / kExactLimit - 1;
+  return (kExactLimit + static_cast<int64_t>(index % kExactLimit))
+         << ignored_bits;
+}
+
+// static
+int64_t TaskQueueStats::DurationHistogram::GetBucketSize(size_t index) {
+  DCHECK_LT(index, kBucketCount);
+  if (index < kExactLimit)
+    return 1;
+  return int64_t{1} << (index / kExactLimit - 1);
+}
+
+TaskQueueStats::TaskQueueStats() = default;
+
+TaskQueueStats::TaskQueueStats(const TaskQueueStats& other) = default;
+
+TaskQueueStats& TaskQueueStats::operator=(const TaskQueueStats& other) =
+    default;
+
+TaskQueueStats::~TaskQueueStats() = default;
+
+void TaskQueueStats::RecordTask(absl::optional<TimeDelta> queueing_delay,
+                                TimeDelta run_time) {
+  total_run_time_ += run_time;
+  run_times_.Add(run_time);
+  if (queueing_delay) {
+    total_queueing_delay_ += *queueing_delay;
+    queueing_delays_.Add(*queueing_delay);
+  }
+}
+
+}  // namespace sequence_manager
+}  // namespace base
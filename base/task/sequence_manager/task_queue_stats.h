@@ -0,0 +1,90 @@
+// Copyright 2022 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#ifndef BASE_TASK_SEQUENCE_MANAGER_TASK_QUEUE_STATS_H_
+#define BASE_TASK_SEQUENCE_MANAGER_TASK_QUEUE_STATS_H_
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include <array>
+
+#include "base/base_export.h"
+#include "base/time/time.h"
+#include "third_party/abseil-cpp/absl/types/optional.h"
+
+namespace base {
+namespace sequence_manager {
+
+// Statistics on the tasks that a TaskQueue ran: how many, for how long, and
+// how late they started. A SequenceManager records them for its queues when
+// SequenceManager::Settings::record_task_queue_stats is set, on its thread
+// after each task and without any lock. TaskQueue::GetStats() returns a
+// snapshot.
+class BASE_EXPORT TaskQueueStats {
+ public:
+  // A log-linear histogram of durations, as in HdrHistogram: the durations
+  // below 8 microseconds have one bucket each, and each power of two above is
+  // split into 8 buckets. So a bucket is at most 1/8th of its durations, and
+  // GetQuantile() returns its middle, within 1/16th of the duration it stands
+  // for. The durations are clamped to [0, 2^31) microseconds.
+  class BASE_EXPORT DurationHistogram {
+   public:
+    static constexpr size_t kBucketCount = 232;
+
+    DurationHistogram();
+    DurationHistogram(const DurationHistogram& other);
+    DurationHistogram& operator=(const DurationHistogram& other);
+    ~DurationHistogram();
+
+    void Add(TimeDelta duration);
+
+    // The number of durations added.
+    uint64_t count() const { return count_; }
+
+    // Returns the estimate of the |quantile| of the durations, or zero if
+    // there are none. |quantile| is within [0, 1], e.g. 0.5 for the median.
+    TimeDelta GetQuantile(double quantile) const;
+
+    // The bucket of |microseconds|, and the minimum and the number of
+    // microseconds of the bucket |index|.
+    static size_t GetBucketIndex(int64_t microseconds);
+    static int64_t GetBucketMin(size_t index);
+    static int64_t GetBucketSize(size_t index);
+
+   private:
+    uint64_t count_ = 0;
+    std::array<uint64_t, kBucketCount> buckets_ = {};
+  };
+
+  TaskQueueStats();
+  TaskQueueStats(const TaskQueueStats& other);
+  TaskQueueStats& operator=(const TaskQueueStats& other);
+  ~TaskQueueStats();
+
+  // Records a task which ran for |run_time|. |queueing_delay| is the time
+  // between when the task was ready to run and when it started, if known: it
+  // is for the delayed tasks, and for the immediate ones when
+  // SequenceManager::Settings::add_queue_time_to_tasks is set.
+  void RecordTask(absl::optional<TimeDelta> queueing_delay, TimeDelta run_time);
+
+  uint64_t task_count() const { return run_times_.count(); }
+  TimeDelta total_run_time() const { return total_run_time_; }
+  const DurationHistogram& run_times() const { return run_times_; }
+
+  // Only for the tasks whose queueing delay is known, see RecordTask().
+  TimeDelta total_queueing_delay() const { return total_queueing_delay_; }
+  const DurationHistogram& queueing_delays() const { return queueing_delays_; }
+
+ private:
+  TimeDelta total_run_time_;
+  TimeDelta total_queueing_delay_;
+  DurationHistogram run_times_;
+  DurationHistogram queueing_delays_;
+};
+
+}  // namespace sequence_manager
+}  // namespace base
+
+#endif  // BASE_TASK_SEQUENCE_MANAGER_TASK_QUEUE_STATS_H_
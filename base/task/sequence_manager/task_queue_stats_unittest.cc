@@ -0,0 +1,74 @@
+// Copyright 2022 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "base/task/sequence_manager/task_queue_stats.h"
+
+#include <algorithm>
+
+#include "base/time/time.h"
+#include "testing/gtest/include/gtest/gtest.h"
+#include "third_party/abseil-cpp/absl/types/optional.h"
+
+namespace base {
+namespace sequence_manager {
+
+using DurationHistogram = TaskQueueStats::DurationHistogram;
+
+TEST(TaskQueueStatsTest, BucketsCoverTheDurations) {
+  int64_t next_min = 0;
+  for (size_t i = 0; i < DurationHistogram::kBucketCount; ++i) {
+    const int64_t min = DurationHistogram::GetBucketMin(i);
+    const int64_t size = DurationHistogram::GetBucketSize(i);
+    EXPECT_EQ(next_min, min);
+    EXPECT_EQ(i, DurationHistogram::GetBucketIndex(min));
+    EXPECT_EQ(i, DurationHistogram::GetBucketIndex(min + size - 1));
+    // A bucket is at most 1/8th of its durations.
+    EXPECT_LE(size * 8, std::max<int64_t>(min, 8));
+    next_min = min + size;
+  }
+  EXPECT_EQ(int64_t{1} << 31, next_min);
+
+  EXPECT_EQ(0u, DurationHistogram::GetBucketIndex(-1));
+  EXPECT_EQ(DurationHistogram::kBucketCount - 1,
+            DurationHistogram::GetBucketIndex(int64_t{1} << 40));
+}
+
+TEST(TaskQueueStatsTest, Quantiles) {
+  DurationHistogram histogram;
+  EXPECT_EQ(0u, histogram.count());
+  EXPECT_EQ(TimeDelta(), histogram.GetQuantile(0.5));
+
+  for (int i = 1; i <= 1000; ++i)
+    histogram.Add(Microseconds(i));
+  EXPECT_EQ(1000u, histogram.count());
+  EXPECT_EQ(Microseconds(1), histogram.GetQuantile(0));
+  for (double quantile : {0.1, 0.5, 0.9, 0.99, 1.0}) {
+    const double expected = quantile * 1000;
+    EXPECT_NEAR(expected, histogram.GetQuantile(quantile).InMicrosecondsF(),
+                expected / 16)
+        << quantile;
+  }
+}
+
+TEST(TaskQueueStatsTest, RecordTask) {
+  TaskQueueStats stats;
+  stats.RecordTask(Milliseconds(2), Milliseconds(1));
+  stats.RecordTask(absl::nullopt, Milliseconds(3));
+  stats.RecordTask(Milliseconds(4), Milliseconds(5));
+
+  EXPECT_EQ(3u, stats.task_count());
+  EXPECT_EQ(Milliseconds(9), stats.total_run_time());
+  EXPECT_EQ(3u, stats.run_times().count());
+  EXPECT_EQ(Milliseconds(6), stats.total_queueing_delay());
+  EXPECT_EQ(2u, stats.queueing_delays().count());
+
+  // Copies are snapshots.
+  const TaskQueueStats snapshot = stats;
+  stats.RecordTask(Milliseconds(1), Milliseconds(1));
+  EXPECT_EQ(3u, snapshot.task_count());
+  EXPECT_EQ(4u, stats.task_count());
+}
+
+}  // namespace sequence_manager
+}  // namespace base
@@ -183,8 +183,9 @@ void ThreadControllerImpl::DoWork(WorkType work_type) {
   WeakPtr<ThreadControllerImpl> weak_ptr = weak_factory_.GetWeakPtr();
   // TODO(scheduler-dev): Consider moving to a time based work batch instead.
   for (int i = 0; i < main_sequence_only().work_batch_size_; i++) {
+    LazyNow lazy_now_select_task(time_source_);
     absl::optional<SequencedTaskSource::SelectedTask> selected_task =
-        sequence_->SelectNextTask();
+        sequence_->SelectNextTask(&lazy_now_select_task);
     if (!selected_task)
       break;
 
@@ -213,7 +214,8 @@ void ThreadControllerImpl::DoWork(WorkType work_type) {
 
       // This processes microtasks, hence all scoped operations above must end
       // after it.
-      sequence_->DidRunTask();
+      LazyNow lazy_now_after_run_task(time_source_);
+      sequence_->DidRunTask(&lazy_now_after_run_task);
     }
     main_sequence_only().run_level_tracker.OnTaskEnded();
 
@@ -11,6 +11,7 @@
 #include "base/logging.h"
 #include "base/memory/ptr_util.h"
 #include "base/message_loop/message_pump.h"
+#include "base/message_loop/timer_slack.h"
 #include "base/task/task_features.h"
 #include "base/threading/hang_watcher.h"
 #include "base/time/tick_clock.h"
@@ -40,8 +41,22 @@ TimeTicks CapAtOneDay(TimeTicks next_run_time, LazyNow* lazy_now) {
 
 std::atomic_bool g_align_wake_ups = false;
 std::atomic<TimeDelta> g_task_leeway{WakeUp::kDefaultLeeway};
-
-TimeTicks WakeUpRunTime(const WakeUp& wake_up) {
+std::atomic_bool g_coalesce_wake_ups_with_timer_slack = false;
+std::atomic<TimeDelta> g_coalesced_wake_up_interval{Milliseconds(32)};
+std::atomic_bool g_batch_tasks_in_do_work = false;
+std::atomic_int g_work_batch_max_tasks{16};
+std::atomic<TimeDelta> g_work_batch_max_duration{Microseconds(500)};
+
+TimeTicks WakeUpRunTime(const WakeUp& wake_up, TimerSlack timer_slack) {
+  // The ticks are aligned on the same phase in all threads, so that threads
+  // which tolerate slack wake up together.
+  if (timer_slack == TIMER_SLACK_MAXIMUM &&
+      wake_up.delay_policy == subtle::DelayPolicy::kFlexibleNoSooner &&
+      g_coalesce_wake_ups_with_timer_slack.load(std::memory_order_relaxed)) {
+    return wake_up.earliest_time().SnappedToNextTick(
+        TimeTicks(),
+        g_coalesced_wake_up_interval.load(std::memory_order_relaxed));
+  }
   if (g_align_wake_ups.load(std::memory_order_relaxed)) {
     TimeTicks aligned_run_time = wake_up.earliest_time().SnappedToNextTick(
         TimeTicks(), g_task_leeway.load(std::memory_order_relaxed));
@@ -57,6 +72,17 @@ TimeTicks WakeUpRunTime(const WakeUp& wake_up) {
 void ThreadControllerWithMessagePumpImpl::InitializeFeatures() {
   g_align_wake_ups = FeatureList::IsEnabled(kAlignWakeUps);
   g_task_leeway.store(kTaskLeewayParam.Get(), std::memory_order_relaxed);
+  g_coalesce_wake_ups_with_timer_slack.store(
+      FeatureList::IsEnabled(kCoalesceWakeUpsWithTimerSlack),
+      std::memory_order_relaxed);
+  g_coalesced_wake_up_interval.store(kCoalescedWakeUpIntervalParam.Get(),
+                                     std::memory_order_relaxed);
+  g_batch_tasks_in_do_work.store(FeatureList::IsEnabled(kBatchTasksInDoWork),
+                                 std::memory_order_relaxed);
+  g_work_batch_max_tasks.store(kWorkBatchMaxTasksParam.Get(),
+                               std::memory_order_relaxed);
+  g_work_batch_max_duration.store(kWorkBatchMaxDurationParam.Get(),
+                                  std::memory_order_relaxed);
 }
 
 // static
@@ -66,12 +92,26 @@ void ThreadControllerWithMessagePumpImpl::ResetFeatures() {
       std::memory_order_relaxed);
   g_task_leeway.store(kTaskLeewayParam.default_value,
                       std::memory_order_relaxed);
+  g_coalesce_wake_ups_with_timer_slack.store(
+      kCoalesceWakeUpsWithTimerSlack.default_state ==
+          FEATURE_ENABLED_BY_DEFAULT,
+      std::memory_order_relaxed);
+  g_coalesced_wake_up_interval.store(
+      kCoalescedWakeUpIntervalParam.default_value, std::memory_order_relaxed);
+  g_batch_tasks_in_do_work.store(
+      kBatchTasksInDoWork.default_state == FEATURE_ENABLED_BY_DEFAULT,
+      std::memory_order_relaxed);
+  g_work_batch_max_tasks.store(kWorkBatchMaxTasksParam.default_value,
+                               std::memory_order_relaxed);
+  g_work_batch_max_duration.store(kWorkBatchMaxDurationParam.default_value,
+                                  std::memory_order_relaxed);
 }
 
 ThreadControllerWithMessagePumpImpl::ThreadControllerWithMessagePumpImpl(
     const SequenceManager::Settings& settings)
     : associated_thread_(AssociatedThreadId::CreateUnbound()),
       work_deduplicator_(associated_thread_),
+      task_annotator_(settings.task_bookkeeping),
       time_source_(settings.clock) {}
 
 ThreadControllerWithMessagePumpImpl::ThreadControllerWithMessagePumpImpl(
@@ -143,6 +183,7 @@ void ThreadControllerWithMessagePumpImpl::SetWorkBatchSize(
 void ThreadControllerWithMessagePumpImpl::SetTimerSlack(
     TimerSlack timer_slack) {
   DCHECK(RunsTasksInCurrentSequence());
+  main_thread_only().timer_slack = timer_slack;
   pump_->SetTimerSlack(timer_slack);
 }
 
@@ -166,7 +207,9 @@ void ThreadControllerWithMessagePumpImpl::SetNextDelayedDoWork(
     absl::optional<WakeUp> wake_up) {
   DCHECK(!wake_up || !wake_up->is_immediate());
   TimeTicks run_time =
-      wake_up.has_value() ? WakeUpRunTime(*wake_up) : TimeTicks::Max();
+      wake_up.has_value()
+          ? WakeUpRunTime(*wake_up, main_thread_only().timer_slack)
+          : TimeTicks::Max();
   DCHECK_LT(lazy_now->Now(), run_time);
 
   if (main_thread_only().next_delayed_do_work == run_time)
@@ -278,6 +321,7 @@ void ThreadControllerWithMessagePumpImpl::BeforeWait() {
   work_id_provider_->IncrementWorkId();
   // The loop is going to sleep, stop watching for hangs.
   hang_watch_scope_.reset();
+  main_thread_only().waiting_for_work = true;
   main_thread_only().run_level_tracker.OnIdle();
 }
 
@@ -285,6 +329,11 @@ MessagePump::Delegate::NextWorkInfo
 ThreadControllerWithMessagePumpImpl::DoWork() {
   MessagePump::Delegate::NextWorkInfo next_work_info{};
 
+  if (main_thread_only().waiting_for_work) {
+    main_thread_only().waiting_for_work = false;
+    RecordThreadWakeUp(time_source_->NowTicks());
+  }
+
   work_deduplicator_.OnWorkStarted();
   LazyNow continuation_lazy_now(time_source_);
   absl::optional<WakeUp> next_wake_up = DoWorkImpl(&continuation_lazy_now);
@@ -319,7 +368,8 @@ ThreadControllerWithMessagePumpImpl::DoWork() {
 
   // The MessagePump will schedule the wake up on our behalf, so we need to
   // update |main_thread_only().next_delayed_do_work|.
-  main_thread_only().next_delayed_do_work = WakeUpRunTime(*next_wake_up);
+  main_thread_only().next_delayed_do_work =
+      WakeUpRunTime(*next_wake_up, main_thread_only().timer_slack);
 
   // Don't request a run time past |main_thread_only().quit_runloop_after|.
   if (main_thread_only().next_delayed_do_work >
@@ -355,7 +405,27 @@ absl::optional<WakeUp> ThreadControllerWithMessagePumpImpl::DoWorkImpl(
 
   DCHECK(main_thread_only().task_source);
 
-  for (int i = 0; i < main_thread_only().work_batch_size; i++) {
+  // The LazyNow sampled after a task ran is reused to select the next one, so
+  // that a batch samples the time once per task at most.
+  absl::optional<LazyNow> lazy_now;
+  lazy_now.emplace(time_source_);
+
+  // Under kBatchTasksInDoWork, the batch may grow past |work_batch_size|, up
+  // to a number of tasks and a duration, unless the MessagePump asked to yield
+  // to native work after each batch.
+  int work_batch_size = main_thread_only().work_batch_size;
+  TimeTicks batch_end_time = TimeTicks::Max();
+  if (g_batch_tasks_in_do_work.load(std::memory_order_relaxed) &&
+      (main_thread_only().yield_to_native_after_batch.is_null() ||
+       lazy_now->Now() >= main_thread_only().yield_to_native_after_batch)) {
+    work_batch_size =
+        std::max(work_batch_size,
+                 g_work_batch_max_tasks.load(std::memory_order_relaxed));
+    batch_end_time = lazy_now->Now() + g_work_batch_max_duration.load(
+                                           std::memory_order_relaxed);
+  }
+
+  for (int i = 0; i < work_batch_size; i++) {
     // Include SelectNextTask() in the scope of the work item. This ensures it's
     // covered in tracing and hang reports. This is particularly important when
     // SelectNextTask() finds no work immediately after a wakeup, otherwise the
@@ -367,7 +437,8 @@ absl::optional<WakeUp> ThreadControllerWithMessagePumpImpl::DoWorkImpl(
             ? SequencedTaskSource::SelectTaskOption::kSkipDelayedTask
             : SequencedTaskSource::SelectTaskOption::kDefault;
     absl::optional<SequencedTaskSource::SelectedTask> selected_task =
-        main_thread_only().task_source->SelectNextTask(select_task_option);
+        main_thread_only().task_source->SelectNextTask(&lazy_now.value(),
+                                                       select_task_option);
     if (!selected_task)
       break;
 
@@ -392,12 +463,16 @@ absl::optional<WakeUp> ThreadControllerWithMessagePumpImpl::DoWorkImpl(
 
     // This processes microtasks and is intentionally included in
     // |work_item_scope|.
-    main_thread_only().task_source->DidRunTask();
+    lazy_now.emplace(time_source_);
+    main_thread_only().task_source->DidRunTask(&lazy_now.value());
 
     // When Quit() is called we must stop running the batch because the caller
     // expects per-task granularity.
     if (main_thread_only().quit_pending)
       break;
+
+    if (!batch_end_time.is_max() && lazy_now->Now() >= batch_end_time)
+      break;
   }
 
   if (main_thread_only().quit_pending)
@@ -138,6 +138,14 @@ class BASE_EXPORT ThreadControllerWithMessagePumpImpl
     TimeTicks quit_runloop_after = TimeTicks::Max();
 
     bool task_execution_allowed = true;
+
+    // Delayed wake-ups are coalesced with TIMER_SLACK_MAXIMUM, under
+    // kCoalesceWakeUpsWithTimerSlack.
+    TimerSlack timer_slack = TIMER_SLACK_NONE;
+
+    // Whether the pump is waiting for work since the last BeforeWait(). The
+    // next DoWork() records a wake-up (see RecordThreadWakeUp()).
+    bool waiting_for_work = false;
   };
 
   const MainThreadOnly& MainThreadOnlyForTesting() const {
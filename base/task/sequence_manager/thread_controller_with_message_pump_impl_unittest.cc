@@ -13,10 +13,13 @@
 #include "base/callback_helpers.h"
 #include "base/memory/raw_ptr.h"
 #include "base/memory/scoped_refptr.h"
+#include "base/message_loop/timer_slack.h"
 #include "base/task/sequence_manager/thread_controller_power_monitor.h"
 #include "base/task/single_thread_task_runner.h"
+#include "base/task/task_features.h"
 #include "base/test/bind.h"
 #include "base/test/mock_callback.h"
+#include "base/test/scoped_feature_list.h"
 #include "base/test/simple_test_tick_clock.h"
 #include "base/threading/thread_task_runner_handle.h"
 #include "build/build_config.h"
@@ -113,6 +116,7 @@ class FakeSequencedTaskSource : public internal::SequencedTaskSource {
   ~FakeSequencedTaskSource() override = default;
 
   absl::optional<SelectedTask> SelectNextTask(
+      LazyNow* lazy_now,
       SelectTaskOption option) override {
     if (tasks_.empty())
       return absl::nullopt;
@@ -127,7 +131,7 @@ class FakeSequencedTaskSource : public internal::SequencedTaskSource {
     return SelectedTask(running_stack_.back(), TaskExecutionTraceLogger());
   }
 
-  void DidRunTask() override { running_stack_.pop_back(); }
+  void DidRunTask(LazyNow* lazy_now) override { running_stack_.pop_back(); }
 
   void RemoveAllCanceledDelayedTasksFromFront(LazyNow* lazy_now) override {}
 
@@ -281,6 +285,58 @@ TEST_F(ThreadControllerWithMessagePumpTest, SetNextDelayedDoWork_CapAtOneDay) {
   thread_controller_.SetNextDelayedDoWork(&lazy_now, WakeUp{Days(2)});
 }
 
+TEST_F(ThreadControllerWithMessagePumpTest, CoalesceWakeUpsWithTimerSlack) {
+  test::ScopedFeatureList feature_list;
+  feature_list.InitAndEnableFeatureWithParameters(
+      kCoalesceWakeUpsWithTimerSlack, {{"interval", "32ms"}});
+  internal::ThreadControllerWithMessagePumpImpl::InitializeFeatures();
+  // A multiple of the interval.
+  const TimeTicks tick = TimeTicks() + Milliseconds(32 * 100);
+  LazyNow lazy_now(&clock_);
+
+  // Without timer slack, wake-ups aren't coalesced.
+  EXPECT_CALL(*message_pump_, ScheduleDelayedWork(tick + Milliseconds(1)));
+  thread_controller_.SetNextDelayedDoWork(&lazy_now,
+                                          WakeUp{tick + Milliseconds(1)});
+  testing::Mock::VerifyAndClearExpectations(message_pump_);
+
+  EXPECT_CALL(*message_pump_, SetTimerSlack(TIMER_SLACK_MAXIMUM));
+  thread_controller_.SetTimerSlack(TIMER_SLACK_MAXIMUM);
+  EXPECT_CALL(*message_pump_, ScheduleDelayedWork(tick + Milliseconds(32)));
+  thread_controller_.SetNextDelayedDoWork(&lazy_now,
+                                          WakeUp{tick + Milliseconds(2)});
+  testing::Mock::VerifyAndClearExpectations(message_pump_);
+
+  // Precise wake-ups aren't coalesced.
+  EXPECT_CALL(*message_pump_, ScheduleDelayedWork(tick + Milliseconds(3)));
+  thread_controller_.SetNextDelayedDoWork(
+      &lazy_now,
+      WakeUp{tick + Milliseconds(3), TimeDelta(), WakeUpResolution::kLow,
+             subtle::DelayPolicy::kPrecise});
+  testing::Mock::VerifyAndClearExpectations(message_pump_);
+
+  internal::ThreadControllerWithMessagePumpImpl::ResetFeatures();
+}
+
+TEST_F(ThreadControllerWithMessagePumpTest, RecordsWakeUps) {
+  ResetThreadWakeUpsPerSecondForTesting();
+  clock_.SetNowTicks(Seconds(1));
+
+  // DoWork() calls which don't follow a wait aren't wake-ups.
+  thread_controller_.DoWork();
+  for (int i = 0; i < 60; ++i) {
+    thread_controller_.BeforeWait();
+    thread_controller_.DoWork();
+    thread_controller_.DoWork();
+    clock_.Advance(base::Seconds(1));
+  }
+  thread_controller_.BeforeWait();
+  thread_controller_.DoWork();
+  EXPECT_DOUBLE_EQ(GetThreadWakeUpsPerSecond(), 61.0 / 60);
+
+  ResetThreadWakeUpsPerSecondForTesting();
+}
+
 TEST_F(ThreadControllerWithMessagePumpTest, DelayedWork_CapAtOneDay) {
   MockCallback<OnceClosure> task1;
   task_source_.AddTask(FROM_HERE, task1.Get(), Days(10));
@@ -527,6 +583,64 @@ TEST_F(ThreadControllerWithMessagePumpTest, QuitInterruptsBatch) {
   testing::Mock::VerifyAndClearExpectations(message_pump_);
 }
 
+TEST_F(ThreadControllerWithMessagePumpTest, BatchTasksInDoWork_MaxTasks) {
+  test::ScopedFeatureList feature_list;
+  feature_list.InitAndEnableFeatureWithParameters(
+      kBatchTasksInDoWork, {{"max_tasks", "3"}, {"max_duration", "1s"}});
+  internal::ThreadControllerWithMessagePumpImpl::InitializeFeatures();
+  ThreadTaskRunnerHandle handle(MakeRefCounted<FakeTaskRunner>());
+
+  int task_count = 0;
+  EXPECT_CALL(*message_pump_, Run(_))
+      .WillOnce(Invoke([&](MessagePump::Delegate* delegate) {
+        EXPECT_TRUE(delegate->DoWork().is_immediate());
+        EXPECT_EQ(3, task_count);
+        EXPECT_EQ(delegate->DoWork().delayed_run_time, TimeTicks::Max());
+        EXPECT_EQ(5, task_count);
+      }));
+
+  for (int i = 0; i < 5; i++) {
+    task_source_.AddTask(FROM_HERE, BindLambdaForTesting([&] { task_count++; }),
+                         TimeTicks());
+  }
+
+  RunLoop run_loop;
+  run_loop.Run();
+  testing::Mock::VerifyAndClearExpectations(message_pump_);
+  internal::ThreadControllerWithMessagePumpImpl::ResetFeatures();
+}
+
+TEST_F(ThreadControllerWithMessagePumpTest, BatchTasksInDoWork_MaxDuration) {
+  test::ScopedFeatureList feature_list;
+  feature_list.InitAndEnableFeatureWithParameters(
+      kBatchTasksInDoWork, {{"max_tasks", "100"}, {"max_duration", "2ms"}});
+  internal::ThreadControllerWithMessagePumpImpl::InitializeFeatures();
+  ThreadTaskRunnerHandle handle(MakeRefCounted<FakeTaskRunner>());
+
+  // Each task takes 1ms, so a batch ends after the second task.
+  int task_count = 0;
+  EXPECT_CALL(*message_pump_, Run(_))
+      .WillOnce(Invoke([&](MessagePump::Delegate* delegate) {
+        EXPECT_TRUE(delegate->DoWork().is_immediate());
+        EXPECT_EQ(2, task_count);
+        EXPECT_TRUE(delegate->DoWork().is_immediate());
+        EXPECT_EQ(4, task_count);
+      }));
+
+  for (int i = 0; i < 10; i++) {
+    task_source_.AddTask(FROM_HERE, BindLambdaForTesting([&] {
+                           task_count++;
+                           clock_.Advance(Milliseconds(1));
+                         }),
+                         TimeTicks());
+  }
+
+  RunLoop run_loop;
+  run_loop.Run();
+  testing::Mock::VerifyAndClearExpectations(message_pump_);
+  internal::ThreadControllerWithMessagePumpImpl::ResetFeatures();
+}
+
 TEST_F(ThreadControllerWithMessagePumpTest, PrioritizeYieldingToNative) {
   ThreadTaskRunnerHandle handle(MakeRefCounted<FakeTaskRunner>());
 
@@ -72,6 +72,17 @@ bool SequencedTaskRunner::PostDelayedTaskAt(
                              : delayed_run_time - TimeTicks::Now());
 }
 
+bool SequencedTaskRunner::PostCoalescedTask(const Location& from_here,
+                                            const void* key,
+                                            OnceClosure task,
+                                            CoalescingPolicy policy) {
+  return PostTask(from_here, std::move(task));
+}
+
+bool SequencedTaskRunner::CanRunTaskInlineInCurrentSequence() const {
+  return false;
+}
+
 bool SequencedTaskRunner::DeleteOrReleaseSoonInternal(
     const Location& from_here,
     void (*deleter)(const void*),
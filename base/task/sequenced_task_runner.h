@@ -145,6 +145,15 @@ class PostDelayedTaskPassKeyForTesting : public PostDelayedTaskPassKey {};
 //     (non-nested) Run() call isn't already happening.
 class BASE_EXPORT SequencedTaskRunner : public TaskRunner {
  public:
+  // What PostCoalescedTask() does with a task whose key already has a task
+  // pending.
+  enum class CoalescingPolicy {
+    // The new task replaces the pending one, which will never run.
+    kReplacePending,
+    // The new task is dropped.
+    kKeepPending,
+  };
+
   // The two PostNonNestable*Task methods below are like their
   // nestable equivalents in TaskRunner, but they guarantee that the
   // posted task will not run nested within an already-running task.
@@ -211,6 +220,11 @@ class BASE_EXPORT SequencedTaskRunner : public TaskRunner {
   // Submits a non-nestable task to delete the given object.  Returns
   // true if the object may be deleted at some point in the future,
   // and false if the object definitely will not be deleted.
+  //
+  // Thread pool task runners batch consecutive deletions and releases into a
+  // single task, as long as no other task is posted in between. Use
+  // ThreadPool::DeleteSoonOnBestEffortWorker() for objects which may be
+  // deleted on any thread.
   template <class T>
   bool DeleteSoon(const Location& from_here, const T* object) {
     return DeleteOrReleaseSoonInternal(from_here, &DeleteHelper<T>::DoDelete,
@@ -244,6 +258,20 @@ class BASE_EXPORT SequencedTaskRunner : public TaskRunner {
                                 object.release());
   }
 
+  // Posts |task| unless a task posted with the same |key| to this sequence is
+  // still pending, i.e. hasn't started running. In that case, |task| is
+  // coalesced into the pending task according to |policy|, without growing the
+  // sequence's queue. This suits "recompute X" tasks posted faster than the
+  // sequence runs them. Keys are compared by address and are shared by all the
+  // TaskRunners of a sequence. Returns true if |task|, or the pending task it
+  // was coalesced into, may run. The default implementation doesn't coalesce:
+  // it posts |task| like PostTask().
+  virtual bool PostCoalescedTask(
+      const Location& from_here,
+      const void* key,
+      OnceClosure task,
+      CoalescingPolicy policy = CoalescingPolicy::kReplacePending);
+
   // Returns true iff tasks posted to this TaskRunner are sequenced
   // with this call.
   //
@@ -257,13 +285,22 @@ class BASE_EXPORT SequencedTaskRunner : public TaskRunner {
   //   the current thread.
   virtual bool RunsTasksInCurrentSequence() const = 0;
 
+  // Returns true iff a task posted to this TaskRunner now, without delay, may
+  // instead run synchronously at the end of the current task, i.e. this runs
+  // tasks in the current sequence and no other task of the sequence would run
+  // before the posted one. PostTaskAndReply() uses this to run the reply
+  // inline. The default implementation conservatively returns false.
+  virtual bool CanRunTaskInlineInCurrentSequence() const;
+
  protected:
   ~SequencedTaskRunner() override = default;
 
  private:
-  bool DeleteOrReleaseSoonInternal(const Location& from_here,
-                                   void (*deleter)(const void*),
-                                   const void* object);
+  // Posts a non-nestable task which runs |deleter| on |object|. Can be
+  // overridden to batch such tasks.
+  virtual bool DeleteOrReleaseSoonInternal(const Location& from_here,
+                                           void (*deleter)(const void*),
+                                           const void* object);
 };
 
 // Sample usage with std::unique_ptr :
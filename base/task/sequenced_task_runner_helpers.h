@@ -10,6 +10,7 @@
 namespace base {
 
 class SequencedTaskRunner;
+class ThreadPool;
 
 // Template helpers which use function indirection to erase T from the
 // function signature while still remembering it so we can call the
@@ -27,6 +28,7 @@ class DeleteHelper {
   }
 
   friend class SequencedTaskRunner;
+  friend class ThreadPool;
 };
 
 template <class T>
@@ -40,6 +42,7 @@ class DeleteUniquePtrHelper {
   }
 
   friend class SequencedTaskRunner;
+  friend class ThreadPool;
 };
 
 template <class T>
@@ -50,6 +53,7 @@ class ReleaseHelper {
   }
 
   friend class SequencedTaskRunner;
+  friend class ThreadPool;
 };
 
 }  // namespace base
@@ -16,6 +16,15 @@ enum class SingleThreadTaskRunnerThreadMode {
   // Create a new thread, dedicated to this SingleThreadTaskRunner, and tear it
   // down when the last reference to the TaskRunner is dropped.
   DEDICATED,
+  // Share one of a bounded set of threads with others, like SHARED, and move
+  // to a thread dedicated to this SingleThreadTaskRunner, like DEDICATED, once
+  // it has kept its shared thread busy for a sustained period. This suits
+  // SingleThreadTaskRunners which are mostly idle but may get busy enough to
+  // delay their neighbours. The move happens at most once, between two tasks:
+  // state bound to the thread (thread-local storage, a bound ThreadChecker...)
+  // must not be kept from one task to the next. Not available for COM STA
+  // SingleThreadTaskRunners, whose objects are bound to their thread.
+  ADAPTIVE,
 };
 
 }  // namespace base
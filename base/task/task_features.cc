@@ -36,6 +36,24 @@ const base::FeatureParam<WakeUpStrategy> kWakeUpStrategyParam{
 const Feature kWakeUpAfterGetWork = {"WakeUpAfterGetWork",
                                      base::FEATURE_DISABLED_BY_DEFAULT};
 
+const Feature kWorkStealingThreadGroup = {"WorkStealingThreadGroup",
+                                          base::FEATURE_DISABLED_BY_DEFAULT};
+
+const Feature kPriorityQueueLanes = {"PriorityQueueLanes",
+                                     base::FEATURE_DISABLED_BY_DEFAULT};
+
+const Feature kNumaAwareThreadGroup = {"NumaAwareThreadGroup",
+                                       base::FEATURE_DISABLED_BY_DEFAULT};
+
+const Feature kElasticThreadGroup = {"ElasticThreadGroup",
+                                     base::FEATURE_DISABLED_BY_DEFAULT};
+
+const Feature kSequenceWorkerAffinity = {"SequenceWorkerAffinity",
+                                         base::FEATURE_DISABLED_BY_DEFAULT};
+
+const base::FeatureParam<TimeDelta> kSequenceWorkerAffinityWaitBudgetParam{
+    &kSequenceWorkerAffinity, "wait_budget", Microseconds(500)};
+
 #if HAS_NATIVE_THREAD_POOL()
 const Feature kUseNativeThreadPool = {"UseNativeThreadPool",
                                       base::FEATURE_DISABLED_BY_DEFAULT};
@@ -58,4 +76,46 @@ const base::FeatureParam<TimeDelta> kTaskLeewayParam{&kAddTaskLeewayFeature,
 const BASE_EXPORT Feature kAlignWakeUps = {"AlignWakeUps",
                                            base::FEATURE_DISABLED_BY_DEFAULT};
 
+const BASE_EXPORT Feature kCoalesceWakeUpsWithTimerSlack = {
+    "CoalesceWakeUpsWithTimerSlack", base::FEATURE_DISABLED_BY_DEFAULT};
+
+const base::FeatureParam<TimeDelta> kCoalescedWakeUpIntervalParam{
+    &kCoalesceWakeUpsWithTimerSlack, "interval", Milliseconds(32)};
+
+const BASE_EXPORT Feature kWorkerThreadAdaptiveSpin = {
+    "WorkerThreadAdaptiveSpin", base::FEATURE_DISABLED_BY_DEFAULT};
+
+const base::FeatureParam<TimeDelta> kWorkerThreadMaxSpinTimeParam{
+    &kWorkerThreadAdaptiveSpin, "max_spin_time", Microseconds(50)};
+
+const BASE_EXPORT Feature kBackgroundWorkerUtilClamp = {
+    "BackgroundWorkerUtilClamp", base::FEATURE_ENABLED_BY_DEFAULT};
+
+const base::FeatureParam<int> kBackgroundWorkerUtilMaxPercentParam{
+    &kBackgroundWorkerUtilClamp, "util_max_percent", 50};
+
+const BASE_EXPORT Feature kThermalThrottleBestEffortTasks = {
+    "ThermalThrottleBestEffortTasks", base::FEATURE_DISABLED_BY_DEFAULT};
+
+const BASE_EXPORT Feature kTaskLatencyRecording = {
+    "TaskLatencyRecording", base::FEATURE_DISABLED_BY_DEFAULT};
+
+const BASE_EXPORT Feature kDelayedTaskTimerWheel = {
+    "DelayedTaskTimerWheel", base::FEATURE_DISABLED_BY_DEFAULT};
+
+const BASE_EXPORT Feature kLockFreeImmediateIncomingQueue = {
+    "LockFreeImmediateIncomingQueue", base::FEATURE_DISABLED_BY_DEFAULT};
+
+const BASE_EXPORT Feature kBatchTasksInDoWork = {
+    "BatchTasksInDoWork", base::FEATURE_DISABLED_BY_DEFAULT};
+
+const base::FeatureParam<int> kWorkBatchMaxTasksParam{&kBatchTasksInDoWork,
+                                                      "max_tasks", 16};
+
+const base::FeatureParam<TimeDelta> kWorkBatchMaxDurationParam{
+    &kBatchTasksInDoWork, "max_duration", Microseconds(500)};
+
+const BASE_EXPORT Feature kInlinePostTaskAndReply = {
+    "InlinePostTaskAndReply", base::FEATURE_DISABLED_BY_DEFAULT};
+
 }  // namespace base
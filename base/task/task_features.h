@@ -27,6 +27,32 @@ extern const BASE_EXPORT Feature kDisableJobUpdatePriority;
 // Under this feature, another WorkerThread is signaled only after the current
 // thread was assigned work.
 extern const BASE_EXPORT Feature kWakeUpAfterGetWork;
+// Under this feature, task sources posted from a ThreadGroupImpl worker are
+// queued in a bounded lock-free queue owned by that worker, from which idle
+// workers of the same group steal before looking at the shared PriorityQueue.
+extern const BASE_EXPORT Feature kWorkStealingThreadGroup;
+// Under this feature, a ThreadGroup's PriorityQueue keeps non-job task sources
+// in one FIFO lane per TaskPriority instead of in its heap.
+extern const BASE_EXPORT Feature kPriorityQueueLanes;
+// Under this feature, the workers of the foreground ThreadGroupImpl are
+// distributed round-robin across NUMA nodes and pinned to the CPUs of their
+// node. Combined with kWorkStealingThreadGroup, idle workers steal from workers
+// of their own node first. Only has an effect on Linux-based platforms with
+// more than one NUMA node.
+extern const BASE_EXPORT Feature kNumaAwareThreadGroup;
+// Under this feature, ThreadGroupImpl adjusts its max tasks, on top of the
+// MAY_BLOCK compensation, from the CPU pressure (runnable threads, PSI and
+// cgroup CPU quota) and the queueing delay of its tasks. See
+// ElasticMaxTasksController.
+extern const BASE_EXPORT Feature kElasticThreadGroup;
+// Under this feature, ThreadGroupImpl remembers the worker that last ran each
+// Sequence and keeps running the Sequence on it: a worker done with a task of a
+// Sequence runs the next one unless work queued behind it has waited longer
+// than the given budget, and posting to a Sequence wakes up its last worker if
+// it is idle.
+extern const BASE_EXPORT Feature kSequenceWorkerAffinity;
+extern const BASE_EXPORT base::FeatureParam<TimeDelta>
+    kSequenceWorkerAffinityWaitBudgetParam;
 
 // Strategy affecting how WorkerThreads are signaled to pick up pending work.
 enum class WakeUpStrategy {
@@ -80,6 +106,62 @@ extern const BASE_EXPORT base::FeatureParam<TimeDelta> kTaskLeewayParam;
 // DelayPolicy.
 extern const BASE_EXPORT base::Feature kAlignWakeUps;
 
+// Under this feature, the delayed wake-ups of threads with TIMER_SLACK_MAXIMUM
+// (see Thread::Options) are coalesced across the process on ticks aligned at
+// the given interval, when allowed per DelayPolicy, even if it exceeds their
+// leeway.
+extern const BASE_EXPORT Feature kCoalesceWakeUpsWithTimerSlack;
+extern const BASE_EXPORT base::FeatureParam<TimeDelta>
+    kCoalescedWakeUpIntervalParam;
+
+// Under this feature, an idle WorkerThread busy-waits for a wake-up before
+// parking on its WaitableEvent. The spin time adapts to recent wake-up gaps and
+// is capped at the given param.
+extern const BASE_EXPORT Feature kWorkerThreadAdaptiveSpin;
+extern const BASE_EXPORT base::FeatureParam<TimeDelta>
+    kWorkerThreadMaxSpinTimeParam;
+
+// Under this feature, background WorkerThreads cap their utilization clamp
+// (uclamp.max) at the given percent of the capacity of the largest CPU, so
+// that schedutil doesn't raise the frequency for them, nor energy-aware
+// scheduling move them to the big cores. Only on Linux, where the kernel
+// supports it; ChromeOS clamps the non-urgent threads through SchedUtilHints.
+extern const BASE_EXPORT Feature kBackgroundWorkerUtilClamp;
+extern const BASE_EXPORT base::FeatureParam<int>
+    kBackgroundWorkerUtilMaxPercentParam;
+
+// Under this feature, ThreadPoolImpl holds back some of its BEST_EFFORT tasks
+// while PowerMonitor reports a kSerious or kCritical thermal state or a CPU
+// speed limit, and lets them run again once the device cools down. See
+// ThermalThrottlePolicy.
+extern const BASE_EXPORT Feature kThermalThrottleBestEffortTasks;
+
+// Under this feature, ThreadPoolImpl records the queueing delay and run
+// duration of every task, bucketed by posting Location and sequence.
+extern const BASE_EXPORT Feature kTaskLatencyRecording;
+
+// Under this feature, DelayedTaskManager keeps delayed tasks that tolerate
+// leeway in a timer wheel rather than in a heap.
+extern const BASE_EXPORT Feature kDelayedTaskTimerWheel;
+
+// Under this feature, immediate tasks are posted to a SequenceManager task
+// queue without taking its lock.
+extern const BASE_EXPORT Feature kLockFreeImmediateIncomingQueue;
+
+// Under this feature, ThreadControllerWithMessagePumpImpl::DoWork() runs up to
+// the given number of tasks, or as many as fit in the given duration, before
+// returning to the MessagePump, instead of the work batch size (usually 1).
+extern const BASE_EXPORT Feature kBatchTasksInDoWork;
+extern const BASE_EXPORT base::FeatureParam<int> kWorkBatchMaxTasksParam;
+extern const BASE_EXPORT base::FeatureParam<TimeDelta>
+    kWorkBatchMaxDurationParam;
+
+// Under this feature, when the task of a PostTaskAndReply() to a ThreadPool
+// sequence was posted from that same sequence, and no other task of the
+// sequence is queued when it completes, the reply runs inline instead of being
+// posted.
+extern const BASE_EXPORT Feature kInlinePostTaskAndReply;
+
 }  // namespace base
 
 #endif  // BASE_TASK_TASK_FEATURES_H_
@@ -7,6 +7,8 @@
 
 #include <stddef.h>
 
+#include <vector>
+
 #include "base/base_export.h"
 #include "base/bind.h"
 #include "base/callback.h"
@@ -74,6 +76,13 @@ class BASE_EXPORT TaskRunner
                                OnceClosure task,
                                base::TimeDelta delay) = 0;
 
+  // Posts each of |tasks| to be run, as if by PostTask() in order. Returns true
+  // if all tasks may be run at some point in the future, and false if any task
+  // definitely will not be run. Implementations may override this to enqueue
+  // the whole batch at a lower cost than posting each task individually.
+  virtual bool PostTasks(const Location& from_here,
+                         std::vector<OnceClosure> tasks);
+
   // Posts |task| on the current TaskRunner.  On completion, |reply| is posted
   // to the sequence that called PostTaskAndReply().  On the success case,
   // |task| is destroyed on the target sequence and |reply| is destroyed on the
@@ -15,6 +15,7 @@
 #include "base/base_export.h"
 #include "base/check_op.h"
 #include "base/task/task_traits_extension.h"
+#include "base/time/time.h"
 #include "base/traits_bag.h"
 #include "build/build_config.h"
 
@@ -194,6 +195,50 @@ struct MayBlock {};
 // In doubt, consult with //base/task/OWNERS.
 struct WithBaseSyncPrimitives {};
 
+// What the thread pool does with a task posted with a TaskDeadline which
+// didn't start running by its deadline.
+enum class DeadlineMissPolicy : uint8_t {
+  // The task runs. If its task source is queued after the deadline, e.g.
+  // behind the previous tasks of its sequence, a USER_VISIBLE task source is
+  // queued as USER_BLOCKING. BEST_EFFORT task sources aren't promoted, so that
+  // they remain subject to the CanRunPolicy and to the limit of concurrent
+  // BEST_EFFORT tasks.
+  kPromote,
+
+  // The task doesn't run, but the arguments bound to it are deleted in the
+  // scope in which it would have run. For tasks whose result is useless after
+  // the deadline, e.g. the response to a request its client gave up on.
+  kDrop,
+};
+
+// Tasks posted with this trait should start running within |budget| of being
+// ready to run, i.e. of being posted or, for delayed tasks, of the expiry of
+// their delay. Within a TaskPriority, the thread pool runs the task sources
+// whose next task has a deadline earliest deadline first, and before those
+// whose next task doesn't. A task which starts running after its deadline is a
+// deadline miss: it is counted by the TaskTracker, by posting Location when
+// kTaskLatencyRecording is enabled, and |miss_policy| applies to it.
+//
+// |budget| must be positive. Deadlines are ignored by jobs and outside of the
+// thread pool.
+//
+// E.g.
+// base::ThreadPool::PostTask(
+//     FROM_HERE,
+//     {base::TaskPriority::USER_VISIBLE,
+//      base::TaskDeadline(base::Milliseconds(5),
+//                         base::DeadlineMissPolicy::kDrop)},
+//     base::BindOnce(&RespondToRequest, ...));
+struct TaskDeadline {
+  constexpr explicit TaskDeadline(
+      TimeDelta budget,
+      DeadlineMissPolicy miss_policy = DeadlineMissPolicy::kPromote)
+      : budget(budget), miss_policy(miss_policy) {}
+
+  TimeDelta budget;
+  DeadlineMissPolicy miss_policy;
+};
+
 // Describes metadata for a single task or a group of tasks.
 class BASE_EXPORT TaskTraits {
  public:
@@ -204,6 +249,7 @@ class BASE_EXPORT TaskTraits {
     ValidTrait(ThreadPolicy);
     ValidTrait(MayBlock);
     ValidTrait(WithBaseSyncPrimitives);
+    ValidTrait(TaskDeadline);
   };
 
   // Invoking this constructor without arguments produces default TaskTraits
@@ -238,7 +284,10 @@ class BASE_EXPORT TaskTraits {
                 trait_helpers::AreValidTraits<ValidTrait, ArgTypes...>::value ||
                 trait_helpers::AreValidTraitsForExtension<ArgTypes...>::value>>
   constexpr TaskTraits(ArgTypes... args)
-      : extension_(trait_helpers::GetTaskTraitsExtension(
+      : deadline_budget_(
+            trait_helpers::GetTraitFromArgList<DeadlineFilter>(args...)
+                .budget),
+        extension_(trait_helpers::GetTaskTraitsExtension(
             trait_helpers::AreValidTraits<ValidTrait, ArgTypes...>{},
             args...)),
         priority_(
@@ -262,21 +311,26 @@ class BASE_EXPORT TaskTraits {
                  : 0)),
         may_block_(trait_helpers::HasTrait<MayBlock, ArgTypes...>()),
         with_base_sync_primitives_(
-            trait_helpers::HasTrait<WithBaseSyncPrimitives, ArgTypes...>()) {}
+            trait_helpers::HasTrait<WithBaseSyncPrimitives, ArgTypes...>()),
+        deadline_miss_policy_(
+            trait_helpers::GetTraitFromArgList<DeadlineFilter>(args...)
+                .miss_policy) {}
 
   constexpr TaskTraits(const TaskTraits& other) = default;
   TaskTraits& operator=(const TaskTraits& other) = default;
 
   // TODO(eseckler): Default the comparison operator once C++20 arrives.
   bool operator==(const TaskTraits& other) const {
-    static_assert(sizeof(TaskTraits) == 15,
+    static_assert(sizeof(TaskTraits) == 24,
                   "Update comparison operator when TaskTraits change");
-    return extension_ == other.extension_ && priority_ == other.priority_ &&
+    return deadline_budget_ == other.deadline_budget_ &&
+           extension_ == other.extension_ && priority_ == other.priority_ &&
            shutdown_behavior_ == other.shutdown_behavior_ &&
            thread_policy_ == other.thread_policy_ &&
            may_block_ == other.may_block_ &&
            with_base_sync_primitives_ == other.with_base_sync_primitives_ &&
-           use_thread_pool_ == other.use_thread_pool_;
+           use_thread_pool_ == other.use_thread_pool_ &&
+           deadline_miss_policy_ == other.deadline_miss_policy_;
   }
 
   // Sets the priority of tasks with these traits to |priority|.
@@ -314,6 +368,19 @@ class BASE_EXPORT TaskTraits {
     return with_base_sync_primitives_;
   }
 
+  // Returns true if tasks with these traits have a deadline.
+  constexpr bool has_deadline() const { return deadline_budget_.is_positive(); }
+
+  // Returns the TaskDeadline budget of tasks with these traits, or zero if they
+  // don't have a deadline.
+  constexpr TimeDelta deadline_budget() const { return deadline_budget_; }
+
+  // Returns the DeadlineMissPolicy of tasks with these traits. Only meaningful
+  // if they have a deadline.
+  constexpr DeadlineMissPolicy deadline_miss_policy() const {
+    return deadline_miss_policy_;
+  }
+
   // Returns true if tasks with these traits execute on the thread pool. This is
   // a legacy trait which can now only be set privately by PostTaskAndroid.
   // TODO(crbug.com/1026641): Get rid of this trait on the Java side as well.
@@ -344,8 +411,9 @@ class BASE_EXPORT TaskTraits {
         thread_policy_(static_cast<uint8_t>(ThreadPolicy::PREFER_BACKGROUND)),
         may_block_(may_block),
         with_base_sync_primitives_(false),
-        use_thread_pool_(use_thread_pool) {
-    static_assert(sizeof(TaskTraits) == 15, "Keep this constructor up to date");
+        use_thread_pool_(use_thread_pool),
+        deadline_miss_policy_(DeadlineMissPolicy::kPromote) {
+    static_assert(sizeof(TaskTraits) == 24, "Keep this constructor up to date");
 
     // Java is expected to provide an explicit destination. See TODO in
     // TaskTraits.java to move towards API-as-a-destination there as well.
@@ -355,11 +423,20 @@ class BASE_EXPORT TaskTraits {
     DCHECK(use_thread_pool_ ^ has_extension);
   }
 
+  // Gets the TaskDeadline from the arguments of the constructor, or a zero
+  // budget if there is none.
+  struct DeadlineFilter : public trait_helpers::BasicTraitFilter<TaskDeadline> {
+    constexpr DeadlineFilter() : BasicTraitFilter(TaskDeadline(TimeDelta())) {}
+    constexpr DeadlineFilter(TaskDeadline deadline)
+        : BasicTraitFilter(deadline) {}
+  };
+
   // This bit is set in |priority_|, |shutdown_behavior_| and |thread_policy_|
   // when the value was set explicitly.
   static constexpr uint8_t kIsExplicitFlag = 0x80;
 
   // Ordered for packing.
+  TimeDelta deadline_budget_;
   TaskTraitsExtensionStorage extension_;
   TaskPriority priority_;
   uint8_t shutdown_behavior_;
@@ -367,6 +444,7 @@ class BASE_EXPORT TaskTraits {
   bool may_block_;
   bool with_base_sync_primitives_;
   bool use_thread_pool_ = false;
+  DeadlineMissPolicy deadline_miss_policy_;
 };
 
 // Returns string literals for the enums defined in this file. These methods
@@ -74,6 +74,27 @@ TEST(TaskTraitsTest, WithBaseSyncPrimitives) {
   EXPECT_TRUE(traits.with_base_sync_primitives());
 }
 
+TEST(TaskTraitsTest, TaskDeadline) {
+  constexpr TaskTraits no_deadline_traits = {};
+  EXPECT_FALSE(no_deadline_traits.has_deadline());
+  EXPECT_EQ(TimeDelta(), no_deadline_traits.deadline_budget());
+
+  constexpr TaskTraits traits = {
+      TaskPriority::USER_VISIBLE,
+      TaskDeadline(Milliseconds(5), DeadlineMissPolicy::kDrop)};
+  EXPECT_EQ(TaskPriority::USER_VISIBLE, traits.priority());
+  EXPECT_TRUE(traits.has_deadline());
+  EXPECT_EQ(Milliseconds(5), traits.deadline_budget());
+  EXPECT_EQ(DeadlineMissPolicy::kDrop, traits.deadline_miss_policy());
+  EXPECT_FALSE(traits.may_block());
+
+  constexpr TaskTraits promote_traits = {TaskDeadline(Milliseconds(5))};
+  EXPECT_EQ(DeadlineMissPolicy::kPromote,
+            promote_traits.deadline_miss_policy());
+  EXPECT_FALSE(traits == promote_traits);
+  EXPECT_FALSE(traits == no_deadline_traits);
+}
+
 TEST(TaskTraitsTest, UpdatePriority) {
   {
     TaskTraits traits = {};
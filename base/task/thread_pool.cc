@@ -5,11 +5,15 @@
 #include "base/task/thread_pool.h"
 
 #include "base/check.h"
+#include "base/no_destructor.h"
+#include "base/synchronization/lock.h"
+#include "base/task/common/deletion_batch.h"
 #include "base/task/scoped_set_task_priority_for_current_thread.h"
 #include "base/task/task_traits.h"
 #include "base/task/thread_pool/thread_pool_impl.h"
 #include "base/task/thread_pool/thread_pool_instance.h"
 #include "base/threading/post_task_and_reply_impl.h"
+#include "base/thread_annotations.h"
 #include "build/build_config.h"
 
 namespace base {
@@ -42,6 +46,20 @@ internal::ThreadPoolImpl* GetThreadPoolImpl() {
   return static_cast<internal::ThreadPoolImpl*>(instance);
 }
 
+// The batch of deletions posted with
+// ThreadPool::DeleteSoonOnBestEffortWorker() which still accepts objects. Since
+// these objects can be deleted in any order, a batch accepts them until its
+// task runs or the batch is full.
+struct BestEffortDeletions {
+  Lock lock;
+  scoped_refptr<internal::DeletionBatch> batch GUARDED_BY(lock);
+};
+
+BestEffortDeletions& GetBestEffortDeletions() {
+  static NoDestructor<BestEffortDeletions> best_effort_deletions;
+  return *best_effort_deletions;
+}
+
 }  // namespace
 
 // static
@@ -124,4 +142,26 @@ scoped_refptr<SingleThreadTaskRunner> ThreadPool::CreateCOMSTATaskRunner(
 }
 #endif  // BUILDFLAG(IS_WIN)
 
+// static
+void ThreadPool::DeleteOrReleaseSoonOnBestEffortWorkerInternal(
+    const Location& from_here,
+    void (*deleter)(const void*),
+    const void* object) {
+  OnceClosure batch_closure;
+  {
+    BestEffortDeletions& deletions = GetBestEffortDeletions();
+    AutoLock auto_lock(deletions.lock);
+    if (deletions.batch && deletions.batch->TryAdd(deleter, object))
+      return;
+    deletions.batch = MakeRefCounted<internal::DeletionBatch>();
+    const bool added = deletions.batch->TryAdd(deleter, object);
+    DCHECK(added);
+    batch_closure = deletions.batch->TakeClosure();
+  }
+  ThreadPool::PostTask(from_here,
+                       {TaskPriority::BEST_EFFORT,
+                        TaskShutdownBehavior::SKIP_ON_SHUTDOWN},
+                       std::move(batch_closure));
+}
+
 }  // namespace base
@@ -16,6 +16,7 @@
 #include "base/memory/scoped_refptr.h"
 #include "base/task/post_task_and_reply_with_result_internal.h"
 #include "base/task/sequenced_task_runner.h"
+#include "base/task/sequenced_task_runner_helpers.h"
 #include "base/task/single_thread_task_runner.h"
 #include "base/task/single_thread_task_runner_thread_mode.h"
 #include "base/task/task_runner.h"
@@ -223,6 +224,33 @@ class BASE_EXPORT ThreadPool {
       SingleThreadTaskRunnerThreadMode thread_mode =
           SingleThreadTaskRunnerThreadMode::SHARED);
 #endif  // BUILDFLAG(IS_WIN)
+
+  // Deletes |object|, or releases the reference held by |object|, from a
+  // BEST_EFFORT task shared with the other objects passed to these methods
+  // around the same time, so that latency-critical sequences don't spend time
+  // in destructors. Only use this for objects whose destruction is thread-safe
+  // and may be delayed arbitrarily: the objects still pending at shutdown are
+  // leaked.
+  template <class T>
+  static void DeleteSoonOnBestEffortWorker(const Location& from_here,
+                                           std::unique_ptr<T> object) {
+    DeleteOrReleaseSoonOnBestEffortWorkerInternal(
+        from_here, &DeleteUniquePtrHelper<T>::DoDelete, object.release());
+  }
+  template <class T>
+  static void ReleaseSoonOnBestEffortWorker(const Location& from_here,
+                                            scoped_refptr<T>&& object) {
+    if (!object)
+      return;
+    DeleteOrReleaseSoonOnBestEffortWorkerInternal(
+        from_here, &ReleaseHelper<T>::DoRelease, object.release());
+  }
+
+ private:
+  static void DeleteOrReleaseSoonOnBestEffortWorkerInternal(
+      const Location& from_here,
+      void (*deleter)(const void*),
+      const void* object);
 };
 
 }  // namespace base
@@ -8,8 +8,12 @@
 
 #include "base/bind.h"
 #include "base/check.h"
+#include "base/feature_list.h"
+#include "base/memory/raw_ptr.h"
+#include "base/task/default_delayed_task_handle_delegate.h"
 #include "base/task/post_task.h"
 #include "base/task/sequenced_task_runner.h"
+#include "base/task/task_features.h"
 #include "base/task/task_runner.h"
 #include "base/task/thread_pool/task.h"
 #include "third_party/abseil-cpp/absl/types/optional.h"
@@ -49,6 +53,60 @@ void DelayedTaskManager::DelayedTask::SetScheduled() {
   scheduled_ = true;
 }
 
+// Cancels a task like DefaultDelayedTaskHandleDelegate and, if the task is in
+// the timer wheel, also removes it from there.
+class DelayedTaskManager::WheelTaskHandleDelegate
+    : public DefaultDelayedTaskHandleDelegate {
+ public:
+  explicit WheelTaskHandleDelegate(DelayedTaskManager* manager)
+      : manager_(manager) {}
+  WheelTaskHandleDelegate(const WheelTaskHandleDelegate&) = delete;
+  WheelTaskHandleDelegate& operator=(const WheelTaskHandleDelegate&) = delete;
+
+  ~WheelTaskHandleDelegate() override {
+    // The task can't run without this delegate; don't keep it around.
+    if (manager_)
+      manager_->RemoveCanceledTask(this);
+  }
+
+  // DefaultDelayedTaskHandleDelegate:
+  void CancelTask() override {
+    DefaultDelayedTaskHandleDelegate::CancelTask();
+    if (manager_)
+      manager_->RemoveCanceledTask(this);
+  }
+
+ private:
+  friend class DelayedTaskManager;
+
+  // Reset when |manager_| is destroyed.
+  raw_ptr<DelayedTaskManager> manager_;
+  // The entry of the task in |manager_->timer_wheel_|, if any. Protected by
+  // |manager_->queue_lock_|.
+  raw_ptr<WheelEntry> entry_ = nullptr;
+};
+
+struct DelayedTaskManager::WheelEntry : public DelayedTaskWheel::Entry {
+  explicit WheelEntry(DelayedTask delayed_task_in)
+      : DelayedTaskWheel::Entry(delayed_task_in.task.delayed_run_time),
+        delayed_task(std::move(delayed_task_in)) {}
+  WheelEntry(const WheelEntry&) = delete;
+  WheelEntry& operator=(const WheelEntry&) = delete;
+
+  ~WheelEntry() override {
+    // Only reached with a |handle_delegate| when the DelayedTaskManager is
+    // destroyed; other paths detach the delegate first.
+    if (handle_delegate) {
+      handle_delegate->entry_ = nullptr;
+      handle_delegate->manager_ = nullptr;
+    }
+  }
+
+  DelayedTask delayed_task;
+  // Protected by |queue_lock_|.
+  raw_ptr<WheelTaskHandleDelegate> handle_delegate = nullptr;
+};
+
 DelayedTaskManager::DelayedTaskManager(const TickClock* tick_clock)
     : process_ripe_tasks_closure_(
           BindRepeating(&DelayedTaskManager::ProcessRipeTasks,
@@ -68,6 +126,10 @@ void DelayedTaskManager::Start(
     CheckedAutoLock auto_lock(queue_lock_);
     DCHECK(!service_thread_task_runner_);
     service_thread_task_runner_ = std::move(service_thread_task_runner);
+    if (FeatureList::IsEnabled(kDelayedTaskTimerWheel)) {
+      timer_wheel_ =
+          std::make_unique<DelayedTaskWheel>(tick_clock_->NowTicks());
+    }
     process_ripe_tasks_time = GetTimeToScheduleProcessRipeTasksLockRequired();
   }
   ScheduleProcessRipeTasksOnServiceThread(process_ripe_tasks_time);
@@ -86,9 +148,10 @@ void DelayedTaskManager::AddDelayedTask(
   TimeTicks process_ripe_tasks_time;
   {
     CheckedAutoLock auto_lock(queue_lock_);
-    delayed_task_queue_.insert(DelayedTask(std::move(task),
-                                           std::move(post_task_now_callback),
-                                           std::move(task_runner)));
+    AddDelayedTaskLockRequired(
+        DelayedTask(std::move(task), std::move(post_task_now_callback),
+                    std::move(task_runner)),
+        nullptr);
     // Not started yet.
     if (service_thread_task_runner_ == nullptr)
       return;
@@ -97,6 +160,34 @@ void DelayedTaskManager::AddDelayedTask(
   ScheduleProcessRipeTasksOnServiceThread(process_ripe_tasks_time);
 }
 
+DelayedTaskHandle DelayedTaskManager::AddCancelableDelayedTask(
+    Task task,
+    PostTaskNowCallback post_task_now_callback,
+    scoped_refptr<TaskRunner> task_runner) {
+  DCHECK(task.task);
+  DCHECK(!task.delayed_run_time.is_null());
+
+  // Use CHECK instead of DCHECK to crash earlier. See http://crbug.com/711167
+  // for details.
+  CHECK(task.task);
+  auto handle_delegate = std::make_unique<WheelTaskHandleDelegate>(this);
+  task.task = handle_delegate->BindCallback(std::move(task.task));
+  TimeTicks process_ripe_tasks_time;
+  {
+    CheckedAutoLock auto_lock(queue_lock_);
+    AddDelayedTaskLockRequired(
+        DelayedTask(std::move(task), std::move(post_task_now_callback),
+                    std::move(task_runner)),
+        handle_delegate.get());
+    process_ripe_tasks_time =
+        service_thread_task_runner_
+            ? GetTimeToScheduleProcessRipeTasksLockRequired()
+            : TimeTicks::Max();
+  }
+  ScheduleProcessRipeTasksOnServiceThread(process_ripe_tasks_time);
+  return DelayedTaskHandle(std::move(handle_delegate));
+}
+
 void DelayedTaskManager::ProcessRipeTasks() {
   std::vector<DelayedTask> ripe_delayed_tasks;
   TimeTicks process_ripe_tasks_time;
@@ -118,6 +209,19 @@ void DelayedTaskManager::ProcessRipeTasks() {
           std::move(const_cast<DelayedTask&>(delayed_task_queue_.top())));
       delayed_task_queue_.pop();
     }
+    if (timer_wheel_) {
+      if (now >= timer_wheel_wake_up_time_)
+        timer_wheel_wake_up_time_ = TimeTicks::Max();
+      // All tasks that expired in the same tick are forwarded together.
+      for (auto& entry : timer_wheel_->Advance(now)) {
+        WheelEntry* wheel_entry = static_cast<WheelEntry*>(entry.get());
+        if (wheel_entry->handle_delegate) {
+          wheel_entry->handle_delegate->entry_ = nullptr;
+          wheel_entry->handle_delegate = nullptr;
+        }
+        ripe_delayed_tasks.push_back(std::move(wheel_entry->delayed_task));
+      }
+    }
     process_ripe_tasks_time = GetTimeToScheduleProcessRipeTasksLockRequired();
   }
   ScheduleProcessRipeTasksOnServiceThread(process_ripe_tasks_time);
@@ -129,23 +233,80 @@ void DelayedTaskManager::ProcessRipeTasks() {
 
 absl::optional<TimeTicks> DelayedTaskManager::NextScheduledRunTime() const {
   CheckedAutoLock auto_lock(queue_lock_);
-  if (delayed_task_queue_.empty())
+  TimeTicks next_run_time = TimeTicks::Max();
+  if (!delayed_task_queue_.empty())
+    next_run_time = delayed_task_queue_.top().task.delayed_run_time;
+  if (timer_wheel_)
+    next_run_time = std::min(next_run_time, timer_wheel_->NextWakeUpTime());
+  if (next_run_time.is_max())
     return absl::nullopt;
-  return delayed_task_queue_.top().task.delayed_run_time;
+  return next_run_time;
+}
+
+void DelayedTaskManager::AddDelayedTaskLockRequired(
+    DelayedTask delayed_task,
+    WheelTaskHandleDelegate* handle_delegate) {
+  queue_lock_.AssertAcquired();
+  // Precise tasks can't tolerate the granularity of the wheel.
+  if (!timer_wheel_ ||
+      delayed_task.task.delay_policy == subtle::DelayPolicy::kPrecise) {
+    delayed_task_queue_.insert(std::move(delayed_task));
+    return;
+  }
+
+  auto entry = std::make_unique<WheelEntry>(std::move(delayed_task));
+  if (handle_delegate) {
+    entry->handle_delegate = handle_delegate;
+    handle_delegate->entry_ = entry.get();
+  }
+  timer_wheel_->Insert(std::move(entry));
+}
+
+void DelayedTaskManager::RemoveCanceledTask(
+    WheelTaskHandleDelegate* handle_delegate) {
+  std::unique_ptr<DelayedTaskWheel::Entry> entry;
+  {
+    CheckedAutoLock auto_lock(queue_lock_);
+    WheelEntry* wheel_entry = handle_delegate->entry_;
+    if (!wheel_entry)
+      return;
+    wheel_entry->handle_delegate = nullptr;
+    handle_delegate->entry_ = nullptr;
+    entry = timer_wheel_->Remove(wheel_entry);
+  }
+  // |entry| is deleted outside of |queue_lock_|, on the sequence that canceled
+  // it, since the task may own arbitrary objects.
 }
 
 TimeTicks DelayedTaskManager::GetTimeToScheduleProcessRipeTasksLockRequired() {
   queue_lock_.AssertAcquired();
-  if (delayed_task_queue_.empty())
-    return TimeTicks::Max();
+  TimeTicks heap_time = TimeTicks::Max();
   // The const_cast on top is okay since |IsScheduled()| and |SetScheduled()|
   // don't alter the sort order.
-  DelayedTask& ripest_delayed_task =
-      const_cast<DelayedTask&>(delayed_task_queue_.top());
-  if (ripest_delayed_task.IsScheduled())
+  DelayedTask* ripest_delayed_task =
+      delayed_task_queue_.empty()
+          ? nullptr
+          : &const_cast<DelayedTask&>(delayed_task_queue_.top());
+  if (ripest_delayed_task && !ripest_delayed_task->IsScheduled())
+    heap_time = ripest_delayed_task->task.delayed_run_time;
+
+  TimeTicks wheel_time = TimeTicks::Max();
+  if (timer_wheel_) {
+    const TimeTicks next_wake_up_time = timer_wheel_->NextWakeUpTime();
+    if (next_wake_up_time < timer_wheel_wake_up_time_)
+      wheel_time = next_wake_up_time;
+  }
+
+  // Only one ProcessRipeTasks() is scheduled at a time, for the earliest of
+  // the two; when it runs, it schedules the other one.
+  if (heap_time.is_max() && wheel_time.is_max())
     return TimeTicks::Max();
-  ripest_delayed_task.SetScheduled();
-  return ripest_delayed_task.task.delayed_run_time;
+  if (heap_time <= wheel_time) {
+    ripest_delayed_task->SetScheduled();
+    return heap_time;
+  }
+  timer_wheel_wake_up_time_ = wheel_time;
+  return wheel_time;
 }
 
 void DelayedTaskManager::ScheduleProcessRipeTasksOnServiceThread(
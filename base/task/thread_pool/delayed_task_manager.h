@@ -6,6 +6,7 @@
 #define BASE_TASK_THREAD_POOL_DELAYED_TASK_MANAGER_H_
 
 #include <functional>
+#include <memory>
 
 #include "base/base_export.h"
 #include "base/callback.h"
@@ -15,6 +16,8 @@
 #include "base/memory/ref_counted.h"
 #include "base/synchronization/atomic_flag.h"
 #include "base/task/common/checked_lock.h"
+#include "base/task/delayed_task_handle.h"
+#include "base/task/thread_pool/delayed_task_wheel.h"
 #include "base/task/thread_pool/task.h"
 #include "base/thread_annotations.h"
 #include "base/time/default_tick_clock.h"
@@ -30,6 +33,11 @@ namespace internal {
 // The DelayedTaskManager forwards tasks to post task callbacks when they become
 // ripe for execution. Tasks are not forwarded before Start() is called. This
 // class is thread-safe.
+//
+// Delayed tasks are kept in a heap. Under kDelayedTaskTimerWheel, tasks added
+// after Start() that don't have DelayPolicy::kPrecise are kept in a
+// DelayedTaskWheel instead, which makes adding and canceling them O(1) at the
+// cost of forwarding them up to DelayedTaskWheel::kTickDuration late.
 class BASE_EXPORT DelayedTaskManager {
  public:
   // Posts |task| for execution immediately.
@@ -55,13 +63,27 @@ class BASE_EXPORT DelayedTaskManager {
                       PostTaskNowCallback post_task_now_callback,
                       scoped_refptr<TaskRunner> task_runner);
 
+  // Same as AddDelayedTask(), but returns a handle that can cancel |task|. If
+  // |task| is in the timer wheel, canceling removes and deletes it right away.
+  // The handle must be used on the sequence of |task_runner|, and not after
+  // this DelayedTaskManager is destroyed.
+  DelayedTaskHandle AddCancelableDelayedTask(
+      Task task,
+      PostTaskNowCallback post_task_now_callback,
+      scoped_refptr<TaskRunner> task_runner);
+
   // Pop and post all the ripe tasks in the delayed task queue.
   void ProcessRipeTasks();
 
-  // Returns the |delayed_run_time| of the next scheduled task, if any.
+  // Returns the |delayed_run_time| of the next scheduled task, if any. When
+  // the timer wheel is used, this may instead be an earlier time at which the
+  // wheel needs to be processed.
   absl::optional<TimeTicks> NextScheduledRunTime() const;
 
  private:
+  class WheelTaskHandleDelegate;
+  struct WheelEntry;
+
   struct DelayedTask {
     DelayedTask();
     DelayedTask(Task task,
@@ -102,6 +124,17 @@ class BASE_EXPORT DelayedTaskManager {
     bool scheduled_ = false;
   };
 
+  // Adds |delayed_task| to the timer wheel if it's in use and |delayed_task|
+  // tolerates leeway, or to |delayed_task_queue_| otherwise. |handle_delegate|
+  // is optionally notified of the position of |delayed_task| in the wheel.
+  void AddDelayedTaskLockRequired(DelayedTask delayed_task,
+                                  WheelTaskHandleDelegate* handle_delegate)
+      EXCLUSIVE_LOCKS_REQUIRED(queue_lock_);
+
+  // Removes the task of |handle_delegate| from the timer wheel, if it's still
+  // there, and deletes it.
+  void RemoveCanceledTask(WheelTaskHandleDelegate* handle_delegate);
+
   // Get the time at which to schedule the next |ProcessRipeTasks()| execution,
   // or TimeTicks::Max() if none needs to be scheduled (i.e. no task, or next
   // task already scheduled).
@@ -129,6 +162,14 @@ class BASE_EXPORT DelayedTaskManager {
 
   IntrusiveHeap<DelayedTask, std::greater<>> delayed_task_queue_
       GUARDED_BY(queue_lock_);
+
+  // Set in Start() under kDelayedTaskTimerWheel.
+  std::unique_ptr<DelayedTaskWheel> timer_wheel_ GUARDED_BY(queue_lock_);
+
+  // Earliest time at which a ProcessRipeTasks() is scheduled on behalf of
+  // |timer_wheel_|, or TimeTicks::Max() if none.
+  TimeTicks timer_wheel_wake_up_time_ GUARDED_BY(queue_lock_) =
+      TimeTicks::Max();
 };
 
 }  // namespace internal
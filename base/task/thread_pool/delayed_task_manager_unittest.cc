@@ -13,8 +13,11 @@
 #include "base/memory/ptr_util.h"
 #include "base/memory/ref_counted.h"
 #include "base/synchronization/waitable_event.h"
+#include "base/task/task_features.h"
+#include "base/task/thread_pool/delayed_task_wheel.h"
 #include "base/task/thread_pool/task.h"
 #include "base/test/bind.h"
+#include "base/test/scoped_feature_list.h"
 #include "base/test/test_mock_time_task_runner.h"
 #include "base/threading/thread.h"
 #include "base/time/time.h"
@@ -254,5 +257,38 @@ TEST_F(ThreadPoolDelayedTaskManagerTest, PostTaskDuringStart) {
   service_thread_task_runner_->FastForwardBy(kLongDelay);
 }
 
+// Verify that a delayed task that tolerates leeway is forwarded at most one
+// tick late under kDelayedTaskTimerWheel.
+TEST_F(ThreadPoolDelayedTaskManagerTest, DelayedTaskRunsInTimerWheel) {
+  base::test::ScopedFeatureList feature_list(kDelayedTaskTimerWheel);
+  delayed_task_manager_.Start(service_thread_task_runner_);
+  delayed_task_manager_.AddDelayedTask(std::move(task_), BindOnce(&PostTaskNow),
+                                       nullptr);
+
+  service_thread_task_runner_->FastForwardBy(kLongDelay - Microseconds(1));
+  testing::Mock::VerifyAndClear(&mock_callback_);
+
+  EXPECT_CALL(mock_callback_, Run());
+  service_thread_task_runner_->FastForwardBy(DelayedTaskWheel::kTickDuration);
+}
+
+// Verify that canceling a delayed task in the timer wheel removes it right
+// away.
+TEST_F(ThreadPoolDelayedTaskManagerTest, CancelDelayedTaskInTimerWheel) {
+  base::test::ScopedFeatureList feature_list(kDelayedTaskTimerWheel);
+  delayed_task_manager_.Start(service_thread_task_runner_);
+  DelayedTaskHandle handle = delayed_task_manager_.AddCancelableDelayedTask(
+      std::move(task_), BindOnce(&PostTaskNow), nullptr);
+  EXPECT_TRUE(handle.IsValid());
+  EXPECT_TRUE(delayed_task_manager_.NextScheduledRunTime());
+
+  handle.CancelTask();
+  EXPECT_FALSE(handle.IsValid());
+  EXPECT_FALSE(delayed_task_manager_.NextScheduledRunTime());
+
+  // The task isn't forwarded.
+  service_thread_task_runner_->FastForwardBy(kLongDelay + Seconds(1));
+}
+
 }  // namespace internal
 }  // namespace base
@@ -0,0 +1,191 @@
+// Copyright 2022 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "base/task/thread_pool/delayed_task_wheel.h"
+
+#include <algorithm>
+#include <limits>
+#include <utility>
+
+#include "base/bits.h"
+#include "base/check_op.h"
+#include "base/memory/ptr_util.h"
+
+namespace base {
+namespace internal {
+
+namespace {
+
+constexpr uint64_t kSlotMask = DelayedTaskWheel::kSlotsPerLevel - 1;
+constexpr int64_t kNoEventTick = std::numeric_limits<int64_t>::max();
+
+int LevelShift(int level) {
+  return level * DelayedTaskWheel::kSlotsPerLevelLog2;
+}
+
+int64_t TimeToTick(TimeTicks time) {
+  return (time - TimeTicks()).IntDiv(DelayedTaskWheel::kTickDuration);
+}
+
+TimeTicks TickToTime(int64_t tick) {
+  return TimeTicks() + DelayedTaskWheel::kTickDuration * tick;
+}
+
+uint64_t RotateRight(uint64_t value, int shift) {
+  DCHECK_GE(shift, 0);
+  DCHECK_LT(shift, 64);
+  return (value >> shift) | (value << ((64 - shift) & 63));
+}
+
+}  // namespace
+
+DelayedTaskWheel::Entry::Entry(TimeTicks deadline)
+    : deadline_(deadline), level_(kNotInWheel) {}
+
+DelayedTaskWheel::Entry::~Entry() {
+  DCHECK_EQ(level_, kNotInWheel);
+}
+
+DelayedTaskWheel::DelayedTaskWheel(TimeTicks now)
+    : current_tick_(TimeToTick(now)) {}
+
+DelayedTaskWheel::~DelayedTaskWheel() {
+  auto delete_all = [](LinkedList<Entry>& list) {
+    while (!list.empty()) {
+      Entry* entry = list.head()->value();
+      entry->RemoveFromList();
+      entry->level_ = kNotInWheel;
+      delete entry;
+    }
+  };
+  for (auto& level : slots_) {
+    for (auto& slot : level)
+      delete_all(slot);
+  }
+  delete_all(ripe_entries_);
+}
+
+void DelayedTaskWheel::Insert(std::unique_ptr<Entry> entry) {
+  DCHECK(entry);
+  DCHECK_EQ(entry->level_, kNotInWheel);
+  entry->expiry_tick_ = TimeToTick(entry->deadline_);
+  if (TickToTime(entry->expiry_tick_) < entry->deadline_)
+    ++entry->expiry_tick_;
+  Place(entry.release());
+  ++size_;
+}
+
+std::unique_ptr<DelayedTaskWheel::Entry> DelayedTaskWheel::Remove(
+    Entry* entry) {
+  DCHECK(entry);
+  DCHECK_NE(entry->level_, kNotInWheel);
+  entry->RemoveFromList();
+  if (entry->level_ != kRipeLevel &&
+      slots_[entry->level_][entry->slot_].empty()) {
+    occupied_slots_[entry->level_] &= ~(uint64_t{1} << entry->slot_);
+  }
+  entry->level_ = kNotInWheel;
+  --size_;
+  return WrapUnique(entry);
+}
+
+std::vector<std::unique_ptr<DelayedTaskWheel::Entry>> DelayedTaskWheel::Advance(
+    TimeTicks now) {
+  const int64_t target_tick = TimeToTick(now);
+  while (current_tick_ < target_tick) {
+    const int64_t next_tick = NextEventTick();
+    if (next_tick > target_tick) {
+      current_tick_ = target_tick;
+      break;
+    }
+    current_tick_ = next_tick;
+    ProcessCurrentTick();
+  }
+
+  std::vector<std::unique_ptr<Entry>> ripe_entries;
+  while (!ripe_entries_.empty())
+    ripe_entries.push_back(Remove(ripe_entries_.head()->value()));
+  return ripe_entries;
+}
+
+TimeTicks DelayedTaskWheel::NextWakeUpTime() const {
+  if (!ripe_entries_.empty())
+    return TickToTime(current_tick_);
+  const int64_t next_tick = NextEventTick();
+  if (next_tick == kNoEventTick)
+    return TimeTicks::Max();
+  return TickToTime(next_tick);
+}
+
+void DelayedTaskWheel::Place(Entry* entry) {
+  const int64_t delta = entry->expiry_tick_ - current_tick_;
+  if (delta <= 0) {
+    entry->level_ = kRipeLevel;
+    ripe_entries_.Append(entry);
+    return;
+  }
+
+  int level = 0;
+  while (level < kNumLevels - 1 &&
+         delta >= (int64_t{1} << LevelShift(level + 1))) {
+    ++level;
+  }
+  // Entries beyond the range of the coarsest level are parked in its farthest
+  // slot and placed again when that slot is processed.
+  const int64_t max_delta = (int64_t{1} << LevelShift(kNumLevels)) - 1;
+  const int64_t slot_tick = current_tick_ + std::min(delta, max_delta);
+
+  entry->level_ = level;
+  entry->slot_ =
+      static_cast<size_t>(slot_tick >> LevelShift(level)) & kSlotMask;
+  slots_[level][entry->slot_].Append(entry);
+  occupied_slots_[level] |= uint64_t{1} << entry->slot_;
+}
+
+int64_t DelayedTaskWheel::NextEventTick() const {
+  int64_t next_tick = kNoEventTick;
+  for (int level = 0; level < kNumLevels; ++level) {
+    if (!occupied_slots_[level])
+      continue;
+    // Slots of |level| are due at multiples of 2^LevelShift(level), in order.
+    // Find the first occupied slot after the current one.
+    const int64_t current_index = current_tick_ >> LevelShift(level);
+    const int first_slot = static_cast<int>((current_index + 1) & kSlotMask);
+    const int64_t offset = static_cast<int64_t>(bits::CountTrailingZeroBits(
+        RotateRight(occupied_slots_[level], first_slot)));
+    next_tick = std::min(next_tick, (current_index + 1 + offset)
+                                        << LevelShift(level));
+  }
+  return next_tick;
+}
+
+void DelayedTaskWheel::ProcessCurrentTick() {
+  for (int level = 0; level < kNumLevels; ++level) {
+    // Coarser levels are only due at multiples of their slot duration.
+    if (level > 0 &&
+        (current_tick_ & ((int64_t{1} << LevelShift(level)) - 1)) != 0) {
+      break;
+    }
+    const size_t slot =
+        static_cast<size_t>(current_tick_ >> LevelShift(level)) & kSlotMask;
+    LinkedList<Entry>& list = slots_[level][slot];
+    if (list.empty())
+      continue;
+    occupied_slots_[level] &= ~(uint64_t{1} << slot);
+
+    // Entries are moved to a finer level or to |ripe_entries_|, never back to
+    // |list|, since they're now due in less than a slot duration of |level|.
+    while (!list.empty()) {
+      Entry* entry = list.head()->value();
+      entry->RemoveFromList();
+      Place(entry);
+      DCHECK(entry->level_ < level || entry->level_ == kRipeLevel ||
+             entry->expiry_tick_ - current_tick_ >=
+                 (int64_t{1} << LevelShift(kNumLevels)));
+    }
+  }
+}
+
+}  // namespace internal
+}  // namespace base
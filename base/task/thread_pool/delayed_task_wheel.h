@@ -0,0 +1,112 @@
+// Copyright 2022 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#ifndef BASE_TASK_THREAD_POOL_DELAYED_TASK_WHEEL_H_
+#define BASE_TASK_THREAD_POOL_DELAYED_TASK_WHEEL_H_
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include <array>
+#include <memory>
+#include <vector>
+
+#include "base/base_export.h"
+#include "base/containers/linked_list.h"
+#include "base/time/time.h"
+
+namespace base {
+namespace internal {
+
+// A hierarchical timing wheel. Entries are bucketed by the tick in which their
+// deadline falls, in one of kNumLevels levels of kSlotsPerLevel slots; each
+// level covers kSlotsPerLevel times the range of the previous one. Insertion
+// and removal are O(1). Advancing the wheel costs O(1) per ripe entry, per
+// entry cascaded from a coarser level and per elapsed rotation of the finest
+// level. Entries are never returned before their deadline, but may be returned
+// up to kTickDuration after it: the wheel is meant for delayed tasks that
+// tolerate leeway. This class is not thread-safe.
+class BASE_EXPORT DelayedTaskWheel {
+ public:
+  static constexpr TimeDelta kTickDuration = Milliseconds(4);
+  static constexpr int kNumLevels = 4;
+  static constexpr int kSlotsPerLevelLog2 = 6;
+  static constexpr size_t kSlotsPerLevel = size_t{1} << kSlotsPerLevelLog2;
+
+  // An item stored in the wheel. Subclasses carry the payload.
+  class BASE_EXPORT Entry : public LinkNode<Entry> {
+   public:
+    explicit Entry(TimeTicks deadline);
+    Entry(const Entry&) = delete;
+    Entry& operator=(const Entry&) = delete;
+    virtual ~Entry();
+
+    TimeTicks deadline() const { return deadline_; }
+
+   private:
+    friend class DelayedTaskWheel;
+
+    const TimeTicks deadline_;
+    // First tick at whose start |deadline_| has been reached.
+    int64_t expiry_tick_ = 0;
+    // Position of the entry in the wheel; |level_| is kRipeLevel for an entry
+    // in |ripe_entries_| and kNotInWheel for an entry outside of the wheel.
+    int level_;
+    size_t slot_ = 0;
+  };
+
+  // |now| is the time from which ticks are counted.
+  explicit DelayedTaskWheel(TimeTicks now);
+  DelayedTaskWheel(const DelayedTaskWheel&) = delete;
+  DelayedTaskWheel& operator=(const DelayedTaskWheel&) = delete;
+  ~DelayedTaskWheel();
+
+  // Inserts |entry| in the wheel.
+  void Insert(std::unique_ptr<Entry> entry);
+
+  // Removes |entry|, which must be in the wheel, and returns it.
+  std::unique_ptr<Entry> Remove(Entry* entry);
+
+  // Advances the wheel to |now| and returns the entries whose deadline was
+  // reached, in no particular order.
+  std::vector<std::unique_ptr<Entry>> Advance(TimeTicks now);
+
+  // Returns the time at which the next call to Advance() can return entries or
+  // has to move entries from a coarser level to a finer one, or
+  // TimeTicks::Max() if the wheel is empty. May be in the past.
+  TimeTicks NextWakeUpTime() const;
+
+  bool empty() const { return size_ == 0; }
+  size_t size() const { return size_; }
+
+ private:
+  static constexpr int kRipeLevel = kNumLevels;
+  static constexpr int kNotInWheel = -1;
+
+  // Places |entry| in the slot matching its expiry tick relative to
+  // |current_tick_|, or in |ripe_entries_| if it has expired.
+  void Place(Entry* entry);
+
+  // Returns the next tick after |current_tick_| at which a non-empty slot is
+  // due, or a very large value if all slots are empty.
+  int64_t NextEventTick() const;
+
+  // Processes the slots that are due at |current_tick_|.
+  void ProcessCurrentTick();
+
+  // The last tick that was processed.
+  int64_t current_tick_;
+
+  std::array<std::array<LinkedList<Entry>, kSlotsPerLevel>, kNumLevels> slots_;
+  // Bit |i| of |occupied_slots_[level]| is set iff slots_[level][i] is not
+  // empty.
+  std::array<uint64_t, kNumLevels> occupied_slots_{};
+  LinkedList<Entry> ripe_entries_;
+  size_t size_ = 0;
+};
+
+}  // namespace internal
+}  // namespace base
+
+#endif  // BASE_TASK_THREAD_POOL_DELAYED_TASK_WHEEL_H_
@@ -0,0 +1,154 @@
+// Copyright 2022 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "base/task/thread_pool/delayed_task_wheel.h"
+
+#include <algorithm>
+#include <memory>
+#include <vector>
+
+#include "base/memory/raw_ptr.h"
+#include "base/time/time.h"
+#include "testing/gtest/include/gtest/gtest.h"
+
+namespace base {
+namespace internal {
+
+namespace {
+
+constexpr TimeDelta kTick = DelayedTaskWheel::kTickDuration;
+
+class TestEntry : public DelayedTaskWheel::Entry {
+ public:
+  TestEntry(TimeTicks deadline, int id, bool* deleted = nullptr)
+      : DelayedTaskWheel::Entry(deadline), id_(id), deleted_(deleted) {}
+  TestEntry(const TestEntry&) = delete;
+  TestEntry& operator=(const TestEntry&) = delete;
+  ~TestEntry() override {
+    if (deleted_)
+      *deleted_ = true;
+  }
+
+  int id() const { return id_; }
+
+ private:
+  const int id_;
+  const raw_ptr<bool> deleted_;
+};
+
+std::vector<int> GetIds(
+    const std::vector<std::unique_ptr<DelayedTaskWheel::Entry>>& entries) {
+  std::vector<int> ids;
+  for (const auto& entry : entries)
+    ids.push_back(static_cast<TestEntry*>(entry.get())->id());
+  std::sort(ids.begin(), ids.end());
+  return ids;
+}
+
+class ThreadPoolDelayedTaskWheelTest : public testing::Test {
+ protected:
+  ThreadPoolDelayedTaskWheelTest() = default;
+
+  // Not aligned on a tick.
+  const TimeTicks start_time_ = TimeTicks() + Seconds(1000) + Milliseconds(1);
+  DelayedTaskWheel wheel_{start_time_};
+};
+
+}  // namespace
+
+TEST_F(ThreadPoolDelayedTaskWheelTest, Empty) {
+  EXPECT_TRUE(wheel_.empty());
+  EXPECT_EQ(wheel_.NextWakeUpTime(), TimeTicks::Max());
+  EXPECT_TRUE(wheel_.Advance(start_time_ + Hours(1)).empty());
+}
+
+// Verify that entries are returned no earlier than their deadline and no later
+// than one tick after it.
+TEST_F(ThreadPoolDelayedTaskWheelTest, InsertAndAdvance) {
+  const TimeTicks deadline_a = start_time_ + Milliseconds(10);
+  const TimeTicks deadline_b = start_time_ + Milliseconds(100);
+  wheel_.Insert(std::make_unique<TestEntry>(deadline_b, 2));
+  wheel_.Insert(std::make_unique<TestEntry>(deadline_a, 1));
+  EXPECT_EQ(wheel_.size(), 2U);
+
+  EXPECT_TRUE(wheel_.Advance(deadline_a - Microseconds(1)).empty());
+  EXPECT_GE(wheel_.NextWakeUpTime(), deadline_a);
+  EXPECT_LT(wheel_.NextWakeUpTime(), deadline_a + kTick);
+  EXPECT_EQ(GetIds(wheel_.Advance(deadline_a + kTick)), std::vector<int>{1});
+
+  EXPECT_TRUE(wheel_.Advance(deadline_b - Microseconds(1)).empty());
+  EXPECT_EQ(GetIds(wheel_.Advance(deadline_b + kTick)), std::vector<int>{2});
+  EXPECT_TRUE(wheel_.empty());
+  EXPECT_EQ(wheel_.NextWakeUpTime(), TimeTicks::Max());
+}
+
+// Verify that entries with the same expiry tick are returned together.
+TEST_F(ThreadPoolDelayedTaskWheelTest, SameTick) {
+  const TimeTicks deadline = start_time_ + Milliseconds(20);
+  for (int i = 0; i < 3; ++i)
+    wheel_.Insert(std::make_unique<TestEntry>(deadline, i));
+  EXPECT_EQ(GetIds(wheel_.Advance(deadline + kTick)),
+            (std::vector<int>{0, 1, 2}));
+}
+
+// Verify that an entry whose deadline is reached is returned by the next
+// Advance() without moving time.
+TEST_F(ThreadPoolDelayedTaskWheelTest, PastDeadline) {
+  wheel_.Insert(std::make_unique<TestEntry>(start_time_ - Seconds(1), 1));
+  EXPECT_LE(wheel_.NextWakeUpTime(), start_time_);
+  EXPECT_EQ(GetIds(wheel_.Advance(start_time_)), std::vector<int>{1});
+}
+
+TEST_F(ThreadPoolDelayedTaskWheelTest, Remove) {
+  bool deleted = false;
+  auto entry =
+      std::make_unique<TestEntry>(start_time_ + Seconds(1), 1, &deleted);
+  TestEntry* entry_ptr = entry.get();
+  wheel_.Insert(std::move(entry));
+  wheel_.Insert(std::make_unique<TestEntry>(start_time_ + Seconds(2), 2));
+
+  wheel_.Remove(entry_ptr);
+  EXPECT_TRUE(deleted);
+  EXPECT_EQ(wheel_.size(), 1U);
+  EXPECT_GE(wheel_.NextWakeUpTime(), start_time_);
+  EXPECT_EQ(GetIds(wheel_.Advance(start_time_ + Seconds(3))),
+            std::vector<int>{2});
+}
+
+// Verify that entries in coarse levels, including entries beyond the range of
+// the wheel, are cascaded down and returned on time.
+TEST_F(ThreadPoolDelayedTaskWheelTest, LongDelays) {
+  const std::vector<TimeDelta> delays = {Seconds(1), Minutes(1), Hours(1),
+                                         Days(3)};
+  for (size_t i = 0; i < delays.size(); ++i) {
+    wheel_.Insert(std::make_unique<TestEntry>(start_time_ + delays[i],
+                                              static_cast<int>(i)));
+  }
+
+  // Follow NextWakeUpTime(), like a DelayedTaskManager would.
+  std::vector<int> ids;
+  for (TimeTicks now = start_time_; !wheel_.empty();
+       now = std::max(now, wheel_.NextWakeUpTime())) {
+    for (int id : GetIds(wheel_.Advance(now))) {
+      EXPECT_GE(now, start_time_ + delays[id]);
+      EXPECT_LT(now, start_time_ + delays[id] + kTick);
+      ids.push_back(id);
+    }
+  }
+  EXPECT_EQ(ids, (std::vector<int>{0, 1, 2, 3}));
+}
+
+// Verify that the destructor deletes the entries in the wheel.
+TEST(ThreadPoolDelayedTaskWheelDestructionTest, DeletesEntries) {
+  bool deleted = false;
+  {
+    DelayedTaskWheel wheel(TimeTicks() + Seconds(1));
+    wheel.Insert(
+        std::make_unique<TestEntry>(TimeTicks() + Seconds(2), 1, &deleted));
+  }
+  EXPECT_TRUE(deleted);
+}
+
+}  // namespace internal
+}  // namespace base
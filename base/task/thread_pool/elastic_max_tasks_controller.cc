@@ -0,0 +1,149 @@
+// Copyright 2022 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "base/task/thread_pool/elastic_max_tasks_controller.h"
+
+#include <algorithm>
+#include <string>
+#include <vector>
+
+#include "base/check_op.h"
+#include "base/files/file_path.h"
+#include "base/files/file_util.h"
+#include "base/strings/string_number_conversions.h"
+#include "base/strings/string_split.h"
+#include "base/strings/string_util.h"
+#include "base/system/sys_info.h"
+#include "build/build_config.h"
+
+namespace base {
+namespace internal {
+
+namespace {
+
+#if BUILDFLAG(IS_LINUX) || BUILDFLAG(IS_CHROMEOS) || BUILDFLAG(IS_ANDROID)
+constexpr char kProcLoadavg[] = "/proc/loadavg";
+constexpr char kSystemPsiCpu[] = "/proc/pressure/cpu";
+#endif
+
+}  // namespace
+
+ElasticMaxTasksController::ElasticMaxTasksController(size_t initial_max_tasks,
+                                                     size_t min_max_tasks,
+                                                     size_t max_max_tasks)
+    : min_adjustment_(static_cast<int>(min_max_tasks) -
+                      static_cast<int>(initial_max_tasks)),
+      max_adjustment_(static_cast<int>(max_max_tasks) -
+                      static_cast<int>(initial_max_tasks)) {
+  DCHECK_GE(min_max_tasks, 1U);
+  DCHECK_LE(min_max_tasks, initial_max_tasks);
+  DCHECK_LE(initial_max_tasks, max_max_tasks);
+}
+
+ElasticMaxTasksController::~ElasticMaxTasksController() = default;
+
+ElasticMaxTasksController::Decision ElasticMaxTasksController::Update(
+    const CpuPressureSignals& signals,
+    const ThreadGroupLoad& load) {
+  const Decision decision = Decide(signals, load);
+  if (decision != pending_decision_) {
+    pending_decision_ = decision;
+    num_consecutive_samples_ = 0;
+  }
+  if (decision == Decision::kHold ||
+      ++num_consecutive_samples_ < kHysteresisSamples) {
+    return Decision::kHold;
+  }
+
+  // The next step in the same direction needs as many samples again.
+  num_consecutive_samples_ = 0;
+  adjustment_ += decision == Decision::kGrow ? 1 : -1;
+  DCHECK_GE(adjustment_, min_adjustment_);
+  DCHECK_LE(adjustment_, max_adjustment_);
+  return decision;
+}
+
+ElasticMaxTasksController::Decision ElasticMaxTasksController::Decide(
+    const CpuPressureSignals& signals,
+    const ThreadGroupLoad& load) const {
+  const bool oversubscribed =
+      (signals.num_runnable_threads >= 0 &&
+       signals.num_runnable_threads >
+           signals.num_cpus * kOversubscribedRunnableThreadsPerCpu) ||
+      signals.psi_some_avg10 >= kOversubscribedPsiSomeAvg10;
+  // Without a runnable thread count, the queueing delay alone decides.
+  const bool has_idle_cpus = signals.num_runnable_threads < signals.num_cpus;
+  const bool starved = load.num_queued_task_sources > 0 &&
+                       load.num_running_tasks >= load.max_tasks &&
+                       load.queueing_delay >= kGrowQueueingDelay;
+
+  if (oversubscribed)
+    return adjustment_ > min_adjustment_ ? Decision::kShrink : Decision::kHold;
+  if (starved && has_idle_cpus)
+    return adjustment_ < max_adjustment_ ? Decision::kGrow : Decision::kHold;
+  // Give back what the pressure took once CPUs are idle again, and what the
+  // queueing delay added once the queue is drained.
+  if (adjustment_ < 0 && has_idle_cpus)
+    return Decision::kGrow;
+  if (adjustment_ > 0 && load.num_queued_task_sources == 0)
+    return Decision::kShrink;
+  return Decision::kHold;
+}
+
+// static
+CpuPressureSignals ElasticMaxTasksController::ReadCpuPressureSignals() {
+  CpuPressureSignals signals;
+  signals.num_cpus = SysInfo::NumberOfEffectiveProcessors();
+#if BUILDFLAG(IS_LINUX) || BUILDFLAG(IS_CHROMEOS) || BUILDFLAG(IS_ANDROID)
+  std::string contents;
+  int num_runnable_threads;
+  if (ReadFileToStringNonBlocking(FilePath(kProcLoadavg), &contents) &&
+      ParseLoadavgRunnableThreads(contents, &num_runnable_threads)) {
+    // Don't count the thread reading the file.
+    signals.num_runnable_threads = std::max(num_runnable_threads - 1, 0);
+  }
+  double avg10;
+  if (ReadFileToStringNonBlocking(FilePath(kSystemPsiCpu), &contents) &&
+      ParsePsiSomeAvg10(contents, &avg10)) {
+    signals.psi_some_avg10 = avg10;
+  }
+#endif
+  return signals;
+}
+
+// static
+bool ElasticMaxTasksController::ParseLoadavgRunnableThreads(
+    StringPiece contents,
+    int* num_runnable_threads) {
+  //   0.52 0.58 0.59 3/1024 12345
+  std::vector<StringPiece> fields =
+      SplitStringPiece(contents, " ", TRIM_WHITESPACE, SPLIT_WANT_NONEMPTY);
+  if (fields.size() < 4)
+    return false;
+  const size_t slash = fields[3].find('/');
+  return slash != StringPiece::npos &&
+         StringToInt(fields[3].substr(0, slash), num_runnable_threads) &&
+         *num_runnable_threads >= 0;
+}
+
+// static
+bool ElasticMaxTasksController::ParsePsiSomeAvg10(StringPiece contents,
+                                                  double* avg10) {
+  //   some avg10=0.12 avg60=0.05 avg300=0.01 total=123456
+  //   full avg10=0.00 avg60=0.00 avg300=0.00 total=0
+  for (StringPiece line : SplitStringPiece(contents, "\n", TRIM_WHITESPACE,
+                                           SPLIT_WANT_NONEMPTY)) {
+    std::vector<StringPiece> fields =
+        SplitStringPiece(line, " ", TRIM_WHITESPACE, SPLIT_WANT_NONEMPTY);
+    if (fields.size() < 2 || fields[0] != "some" ||
+        !StartsWith(fields[1], "avg10=")) {
+      continue;
+    }
+    return StringToDouble(fields[1].substr(6), avg10);
+  }
+  return false;
+}
+
+}  // namespace internal
+}  // namespace base
@@ -0,0 +1,114 @@
+// Copyright 2022 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#ifndef BASE_TASK_THREAD_POOL_ELASTIC_MAX_TASKS_CONTROLLER_H_
+#define BASE_TASK_THREAD_POOL_ELASTIC_MAX_TASKS_CONTROLLER_H_
+
+#include <stddef.h>
+
+#include "base/base_export.h"
+#include "base/strings/string_piece.h"
+#include "base/time/time.h"
+
+namespace base {
+namespace internal {
+
+// What the system says about the CPU when the controller samples it.
+struct BASE_EXPORT CpuPressureSignals {
+  // CPUs the process may use, i.e. SysInfo::NumberOfEffectiveProcessors(),
+  // which accounts for the cgroup CPU quota.
+  int num_cpus = 1;
+  // Threads runnable on the whole system, from /proc/loadavg. Negative if
+  // unknown.
+  int num_runnable_threads = -1;
+  // The share of the last 10 seconds during which some tasks waited for a CPU,
+  // in percent, from /proc/pressure/cpu. Negative if unknown.
+  double psi_some_avg10 = -1;
+};
+
+// What the thread group says about its own work when the controller samples
+// it.
+struct BASE_EXPORT ThreadGroupLoad {
+  size_t max_tasks = 0;
+  size_t num_running_tasks = 0;
+  size_t num_queued_task_sources = 0;
+  // How long the task source at the front of the queue has been ready to run.
+  TimeDelta queueing_delay;
+};
+
+// Adjusts the max tasks of a ThreadGroupImpl, on top of the MAY_BLOCK
+// compensation, from the CPU pressure and the queueing delay of its tasks:
+// - it grows while tasks wait more than kGrowQueueingDelay for a worker and
+//   fewer threads are runnable than there are CPUs,
+// - it shrinks while more than kOversubscribedRunnableThreadsPerCpu threads
+//   are runnable per CPU, or some tasks waited for a CPU more than
+//   kOversubscribedPsiSomeAvg10 percent of the time,
+// - otherwise it moves back to the initial max tasks as the queue drains or
+//   the pressure goes away.
+// A step of one task is taken once kHysteresisSamples consecutive samples
+// agree on its direction, so that the pool doesn't oscillate with short
+// bursts.
+//
+// This class isn't thread-safe.
+class BASE_EXPORT ElasticMaxTasksController {
+ public:
+  // Recorded in histograms, don't renumber.
+  enum class Decision {
+    kHold = 0,
+    kGrow = 1,
+    kShrink = 2,
+    kMaxValue = kShrink,
+  };
+
+  static constexpr TimeDelta kGrowQueueingDelay = Milliseconds(20);
+  static constexpr double kOversubscribedRunnableThreadsPerCpu = 1.5;
+  static constexpr double kOversubscribedPsiSomeAvg10 = 20;
+  static constexpr int kHysteresisSamples = 3;
+
+  // The adjustment keeps the max tasks within [|min_max_tasks|,
+  // |max_max_tasks|] of the |initial_max_tasks| it starts at.
+  ElasticMaxTasksController(size_t initial_max_tasks,
+                            size_t min_max_tasks,
+                            size_t max_max_tasks);
+  ElasticMaxTasksController(const ElasticMaxTasksController&) = delete;
+  ElasticMaxTasksController& operator=(const ElasticMaxTasksController&) =
+      delete;
+  ~ElasticMaxTasksController();
+
+  // Takes a sample and returns whether the max tasks should be incremented or
+  // decremented by one now. adjustment() reflects the decision.
+  Decision Update(const CpuPressureSignals& signals,
+                  const ThreadGroupLoad& load);
+
+  // The number of tasks added to (or, if negative, removed from) the initial
+  // max tasks.
+  int adjustment() const { return adjustment_; }
+
+  // Reads the signals of the current system. Doesn't block.
+  static CpuPressureSignals ReadCpuPressureSignals();
+
+  // Parsers for the contents of /proc/loadavg and of /proc/pressure/cpu.
+  // Return false if |contents| isn't in the expected format.
+  static bool ParseLoadavgRunnableThreads(StringPiece contents,
+                                          int* num_runnable_threads);
+  static bool ParsePsiSomeAvg10(StringPiece contents, double* avg10);
+
+ private:
+  // The direction of the step the current sample asks for, before hysteresis.
+  Decision Decide(const CpuPressureSignals& signals,
+                  const ThreadGroupLoad& load) const;
+
+  const int min_adjustment_;
+  const int max_adjustment_;
+  int adjustment_ = 0;
+
+  // The direction asked for by the last |num_consecutive_samples_| samples.
+  Decision pending_decision_ = Decision::kHold;
+  int num_consecutive_samples_ = 0;
+};
+
+}  // namespace internal
+}  // namespace base
+
+#endif  // BASE_TASK_THREAD_POOL_ELASTIC_MAX_TASKS_CONTROLLER_H_
@@ -0,0 +1,202 @@
+// Copyright 2022 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "base/task/thread_pool/elastic_max_tasks_controller.h"
+
+#include "testing/gtest/include/gtest/gtest.h"
+
+namespace base {
+namespace internal {
+
+namespace {
+
+using Decision = ElasticMaxTasksController::Decision;
+
+constexpr size_t kInitialMaxTasks = 4;
+
+CpuPressureSignals IdleCpus() {
+  CpuPressureSignals signals;
+  signals.num_cpus = 8;
+  signals.num_runnable_threads = 2;
+  signals.psi_some_avg10 = 0;
+  return signals;
+}
+
+CpuPressureSignals OversubscribedCpus() {
+  CpuPressureSignals signals = IdleCpus();
+  signals.num_runnable_threads = 16;
+  return signals;
+}
+
+ThreadGroupLoad StarvedLoad(size_t max_tasks) {
+  ThreadGroupLoad load;
+  load.max_tasks = max_tasks;
+  load.num_running_tasks = max_tasks;
+  load.num_queued_task_sources = 10;
+  load.queueing_delay = Milliseconds(100);
+  return load;
+}
+
+ThreadGroupLoad DrainedLoad(size_t max_tasks) {
+  ThreadGroupLoad load;
+  load.max_tasks = max_tasks;
+  load.num_running_tasks = 1;
+  return load;
+}
+
+// Updates |controller| with the same sample until it takes a step, and returns
+// that step, or kHold if it doesn't take one within twice the hysteresis.
+Decision UpdateUntilStep(ElasticMaxTasksController& controller,
+                         const CpuPressureSignals& signals,
+                         const ThreadGroupLoad& load) {
+  for (int i = 0; i < 2 * ElasticMaxTasksController::kHysteresisSamples; ++i) {
+    const Decision decision = controller.Update(signals, load);
+    if (decision != Decision::kHold)
+      return decision;
+  }
+  return Decision::kHold;
+}
+
+}  // namespace
+
+TEST(ThreadPoolElasticMaxTasksControllerTest, GrowsWhenStarvedWithIdleCpus) {
+  ElasticMaxTasksController controller(kInitialMaxTasks, 2, 8);
+  for (int i = 1; i < ElasticMaxTasksController::kHysteresisSamples; ++i) {
+    EXPECT_EQ(Decision::kHold,
+              controller.Update(IdleCpus(), StarvedLoad(kInitialMaxTasks)));
+  }
+  EXPECT_EQ(Decision::kGrow,
+            controller.Update(IdleCpus(), StarvedLoad(kInitialMaxTasks)));
+  EXPECT_EQ(1, controller.adjustment());
+
+  // Each step needs as many samples.
+  EXPECT_EQ(Decision::kHold,
+            controller.Update(IdleCpus(), StarvedLoad(kInitialMaxTasks + 1)));
+  EXPECT_EQ(1, controller.adjustment());
+}
+
+TEST(ThreadPoolElasticMaxTasksControllerTest, Hysteresis) {
+  ElasticMaxTasksController controller(kInitialMaxTasks, 2, 8);
+  // Alternating samples never agree long enough for a step.
+  for (int i = 0; i < 10; ++i) {
+    EXPECT_EQ(Decision::kHold,
+              controller.Update(IdleCpus(), StarvedLoad(kInitialMaxTasks)));
+    EXPECT_EQ(Decision::kHold, controller.Update(
+                                   IdleCpus(), DrainedLoad(kInitialMaxTasks)));
+  }
+  EXPECT_EQ(0, controller.adjustment());
+}
+
+TEST(ThreadPoolElasticMaxTasksControllerTest, NoGrowthWithoutQueueingDelay) {
+  ElasticMaxTasksController controller(kInitialMaxTasks, 2, 8);
+  ThreadGroupLoad load = StarvedLoad(kInitialMaxTasks);
+  load.queueing_delay = Milliseconds(1);
+  EXPECT_EQ(Decision::kHold, UpdateUntilStep(controller, IdleCpus(), load));
+
+  // Nor with idle workers.
+  load = StarvedLoad(kInitialMaxTasks);
+  load.num_running_tasks = kInitialMaxTasks - 1;
+  EXPECT_EQ(Decision::kHold, UpdateUntilStep(controller, IdleCpus(), load));
+
+  // Nor without idle CPUs.
+  CpuPressureSignals signals = IdleCpus();
+  signals.num_runnable_threads = signals.num_cpus;
+  EXPECT_EQ(Decision::kHold,
+            UpdateUntilStep(controller, signals,
+                            StarvedLoad(kInitialMaxTasks)));
+  EXPECT_EQ(0, controller.adjustment());
+}
+
+TEST(ThreadPoolElasticMaxTasksControllerTest, GrowsWithoutCpuSignals) {
+  ElasticMaxTasksController controller(kInitialMaxTasks, 2, 8);
+  EXPECT_EQ(Decision::kGrow,
+            UpdateUntilStep(controller, CpuPressureSignals(),
+                            StarvedLoad(kInitialMaxTasks)));
+}
+
+TEST(ThreadPoolElasticMaxTasksControllerTest, ShrinksWhenOversubscribed) {
+  ElasticMaxTasksController controller(kInitialMaxTasks, 2, 8);
+  EXPECT_EQ(Decision::kShrink,
+            UpdateUntilStep(controller, OversubscribedCpus(),
+                            StarvedLoad(kInitialMaxTasks)));
+  EXPECT_EQ(Decision::kShrink,
+            UpdateUntilStep(controller, OversubscribedCpus(),
+                            StarvedLoad(kInitialMaxTasks - 1)));
+  // Not below the minimum.
+  EXPECT_EQ(Decision::kHold,
+            UpdateUntilStep(controller, OversubscribedCpus(),
+                            StarvedLoad(kInitialMaxTasks - 2)));
+  EXPECT_EQ(-2, controller.adjustment());
+
+  // CPU stalls are pressure too.
+  ElasticMaxTasksController psi_controller(kInitialMaxTasks, 2, 8);
+  CpuPressureSignals signals = IdleCpus();
+  signals.psi_some_avg10 = 50;
+  EXPECT_EQ(Decision::kShrink,
+            UpdateUntilStep(psi_controller, signals,
+                            DrainedLoad(kInitialMaxTasks)));
+}
+
+TEST(ThreadPoolElasticMaxTasksControllerTest, ReturnsToInitialMaxTasks) {
+  ElasticMaxTasksController controller(kInitialMaxTasks, 2, 6);
+  EXPECT_EQ(Decision::kGrow, UpdateUntilStep(controller, IdleCpus(),
+                                             StarvedLoad(kInitialMaxTasks)));
+  EXPECT_EQ(Decision::kGrow, UpdateUntilStep(controller, IdleCpus(),
+                                             StarvedLoad(kInitialMaxTasks + 1)));
+  // Not above the maximum.
+  EXPECT_EQ(Decision::kHold, UpdateUntilStep(controller, IdleCpus(),
+                                             StarvedLoad(kInitialMaxTasks + 2)));
+  EXPECT_EQ(2, controller.adjustment());
+
+  // Gives back the tasks once the queue is drained, and no more.
+  EXPECT_EQ(Decision::kShrink,
+            UpdateUntilStep(controller, IdleCpus(),
+                            DrainedLoad(kInitialMaxTasks + 2)));
+  EXPECT_EQ(Decision::kShrink,
+            UpdateUntilStep(controller, IdleCpus(),
+                            DrainedLoad(kInitialMaxTasks + 1)));
+  EXPECT_EQ(Decision::kHold, UpdateUntilStep(controller, IdleCpus(),
+                                             DrainedLoad(kInitialMaxTasks)));
+  EXPECT_EQ(0, controller.adjustment());
+
+  // Takes back the tasks once the CPUs are idle again, and no more.
+  EXPECT_EQ(Decision::kShrink,
+            UpdateUntilStep(controller, OversubscribedCpus(),
+                            DrainedLoad(kInitialMaxTasks)));
+  EXPECT_EQ(Decision::kGrow, UpdateUntilStep(controller, IdleCpus(),
+                                             DrainedLoad(kInitialMaxTasks - 1)));
+  EXPECT_EQ(Decision::kHold, UpdateUntilStep(controller, IdleCpus(),
+                                             DrainedLoad(kInitialMaxTasks)));
+  EXPECT_EQ(0, controller.adjustment());
+}
+
+TEST(ThreadPoolElasticMaxTasksControllerTest, ParseLoadavgRunnableThreads) {
+  int num_runnable_threads = 0;
+  EXPECT_TRUE(ElasticMaxTasksController::ParseLoadavgRunnableThreads(
+      "0.52 0.58 0.59 3/1024 12345\n", &num_runnable_threads));
+  EXPECT_EQ(3, num_runnable_threads);
+
+  EXPECT_FALSE(ElasticMaxTasksController::ParseLoadavgRunnableThreads(
+      "0.52 0.58 0.59", &num_runnable_threads));
+  EXPECT_FALSE(ElasticMaxTasksController::ParseLoadavgRunnableThreads(
+      "0.52 0.58 0.59 3 12345", &num_runnable_threads));
+  EXPECT_FALSE(ElasticMaxTasksController::ParseLoadavgRunnableThreads(
+      "0.52 0.58 0.59 x/1024 12345", &num_runnable_threads));
+}
+
+TEST(ThreadPoolElasticMaxTasksControllerTest, ParsePsiSomeAvg10) {
+  double avg10 = 0;
+  EXPECT_TRUE(ElasticMaxTasksController::ParsePsiSomeAvg10(
+      "some avg10=12.50 avg60=0.05 avg300=0.01 total=123456\n"
+      "full avg10=0.00 avg60=0.00 avg300=0.00 total=0\n",
+      &avg10));
+  EXPECT_DOUBLE_EQ(12.5, avg10);
+
+  EXPECT_FALSE(ElasticMaxTasksController::ParsePsiSomeAvg10(
+      "full avg10=0.00 avg60=0.00 avg300=0.00 total=0\n", &avg10));
+  EXPECT_FALSE(ElasticMaxTasksController::ParsePsiSomeAvg10("", &avg10));
+}
+
+}  // namespace internal
+}  // namespace base
@@ -15,7 +15,7 @@ int RecommendedMaxNumberOfThreadsInThreadGroup(int min,
                                                int max,
                                                double cores_multiplier,
                                                int offset) {
-  const int num_of_cores = SysInfo::NumberOfProcessors();
+  const int num_of_cores = SysInfo::NumberOfEffectiveProcessors();
   const int threads = std::ceil<int>(num_of_cores * cores_multiplier) + offset;
   return clamp(threads, min, max);
 }
@@ -10,7 +10,9 @@
 namespace base {
 
 // Computes a value that may be used as the maximum number of threads in a
-// ThreadGroup. Developers may use other methods to choose this maximum.
+// ThreadGroup, from the number of cores the process can use, i.e.
+// SysInfo::NumberOfEffectiveProcessors(). Developers may use other methods to
+// choose this maximum.
 BASE_EXPORT int RecommendedMaxNumberOfThreadsInThreadGroup(
     int min,
     int max,
@@ -40,6 +40,35 @@ bool PooledParallelTaskRunner::PostDelayedTask(const Location& from_here,
       std::move(sequence));
 }
 
+bool PooledParallelTaskRunner::PostTasks(const Location& from_here,
+                                         std::vector<OnceClosure> closures) {
+  if (!PooledTaskRunnerDelegate::MatchesCurrentDelegate(
+          pooled_task_runner_delegate_)) {
+    return false;
+  }
+
+  // Post each task as part of a one-off single-task Sequence.
+  const TimeTicks now = TimeTicks::Now();
+  std::vector<Task> tasks;
+  std::vector<scoped_refptr<Sequence>> sequences;
+  tasks.reserve(closures.size());
+  sequences.reserve(closures.size());
+  for (OnceClosure& closure : closures) {
+    tasks.emplace_back(from_here, std::move(closure), now, TimeDelta());
+    sequences.push_back(MakeRefCounted<Sequence>(
+        traits_, this, TaskSourceExecutionMode::kParallel));
+  }
+
+  {
+    CheckedAutoLock auto_lock(lock_);
+    for (const auto& sequence : sequences)
+      sequences_.insert(sequence.get());
+  }
+
+  return pooled_task_runner_delegate_->PostTasksWithSequences(
+      std::move(tasks), std::move(sequences));
+}
+
 void PooledParallelTaskRunner::UnregisterSequence(Sequence* sequence) {
   DCHECK(sequence);
 
@@ -36,6 +36,8 @@ class BASE_EXPORT PooledParallelTaskRunner : public TaskRunner {
   bool PostDelayedTask(const Location& from_here,
                        OnceClosure closure,
                        TimeDelta delay) override;
+  bool PostTasks(const Location& from_here,
+                 std::vector<OnceClosure> closures) override;
 
   // Removes |sequence| from |sequences_|.
   void UnregisterSequence(Sequence* sequence);
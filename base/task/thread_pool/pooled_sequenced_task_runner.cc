@@ -36,6 +36,24 @@ bool PooledSequencedTaskRunner::PostDelayedTask(const Location& from_here,
                                                             sequence_);
 }
 
+bool PooledSequencedTaskRunner::PostTasks(const Location& from_here,
+                                          std::vector<OnceClosure> closures) {
+  if (!PooledTaskRunnerDelegate::MatchesCurrentDelegate(
+          pooled_task_runner_delegate_)) {
+    return false;
+  }
+
+  const TimeTicks now = TimeTicks::Now();
+  std::vector<Task> tasks;
+  tasks.reserve(closures.size());
+  for (OnceClosure& closure : closures)
+    tasks.emplace_back(from_here, std::move(closure), now, TimeDelta());
+
+  // Post the tasks as part of |sequence_|.
+  return pooled_task_runner_delegate_->PostTasksWithSequence(std::move(tasks),
+                                                             sequence_);
+}
+
 bool PooledSequencedTaskRunner::PostDelayedTaskAt(
     subtle::PostDelayedTaskPassKey,
     const Location& from_here,
@@ -48,12 +66,49 @@ bool PooledSequencedTaskRunner::PostDelayedTaskAt(
   }
 
   Task task(from_here, std::move(closure), TimeTicks::Now(), delayed_run_time);
+  task.delay_policy = delay_policy;
 
   // Post the task as part of |sequence_|.
   return pooled_task_runner_delegate_->PostTaskWithSequence(std::move(task),
                                                             sequence_);
 }
 
+DelayedTaskHandle PooledSequencedTaskRunner::PostCancelableDelayedTask(
+    subtle::PostDelayedTaskPassKey,
+    const Location& from_here,
+    OnceClosure closure,
+    TimeDelta delay) {
+  if (!PooledTaskRunnerDelegate::MatchesCurrentDelegate(
+          pooled_task_runner_delegate_)) {
+    return DelayedTaskHandle();
+  }
+
+  Task task(from_here, std::move(closure), TimeTicks::Now(), delay);
+
+  // Post the task as part of |sequence_|.
+  return pooled_task_runner_delegate_->PostCancelableTaskWithSequence(
+      std::move(task), sequence_);
+}
+
+DelayedTaskHandle PooledSequencedTaskRunner::PostCancelableDelayedTaskAt(
+    subtle::PostDelayedTaskPassKey,
+    const Location& from_here,
+    OnceClosure closure,
+    TimeTicks delayed_run_time,
+    subtle::DelayPolicy delay_policy) {
+  if (!PooledTaskRunnerDelegate::MatchesCurrentDelegate(
+          pooled_task_runner_delegate_)) {
+    return DelayedTaskHandle();
+  }
+
+  Task task(from_here, std::move(closure), TimeTicks::Now(), delayed_run_time);
+  task.delay_policy = delay_policy;
+
+  // Post the task as part of |sequence_|.
+  return pooled_task_runner_delegate_->PostCancelableTaskWithSequence(
+      std::move(task), sequence_);
+}
+
 bool PooledSequencedTaskRunner::PostNonNestableDelayedTask(
     const Location& from_here,
     OnceClosure closure,
@@ -62,10 +117,63 @@ bool PooledSequencedTaskRunner::PostNonNestableDelayedTask(
   return PostDelayedTask(from_here, std::move(closure), delay);
 }
 
+bool PooledSequencedTaskRunner::PostCoalescedTask(const Location& from_here,
+                                                  const void* key,
+                                                  OnceClosure closure,
+                                                  CoalescingPolicy policy) {
+  if (!PooledTaskRunnerDelegate::MatchesCurrentDelegate(
+          pooled_task_runner_delegate_)) {
+    return false;
+  }
+
+  const scoped_refptr<CoalescedTasks> coalesced_tasks =
+      sequence_->BeginTransaction().GetCoalescedTasks();
+  OnceClosure pending_closure =
+      coalesced_tasks->Coalesce(key, std::move(closure), policy);
+  if (!pending_closure)
+    return true;
+
+  Task task(from_here, std::move(pending_closure), TimeTicks::Now(),
+            TimeDelta());
+
+  // Post the task as part of |sequence_|.
+  return pooled_task_runner_delegate_->PostTaskWithSequence(std::move(task),
+                                                            sequence_);
+}
+
+bool PooledSequencedTaskRunner::DeleteOrReleaseSoonInternal(
+    const Location& from_here,
+    void (*deleter)(const void*),
+    const void* object) {
+  if (!PooledTaskRunnerDelegate::MatchesCurrentDelegate(
+          pooled_task_runner_delegate_)) {
+    return false;
+  }
+
+  OnceClosure batch_closure =
+      sequence_->BeginTransaction().AddToDeletionBatch(deleter, object);
+  if (!batch_closure)
+    return true;
+
+  Task task(from_here, std::move(batch_closure), TimeTicks::Now(),
+            TimeDelta());
+
+  // Post the task as part of |sequence_|.
+  return pooled_task_runner_delegate_->PostTaskWithSequence(std::move(task),
+                                                            sequence_);
+}
+
 bool PooledSequencedTaskRunner::RunsTasksInCurrentSequence() const {
   return sequence_->token() == SequenceToken::GetForCurrentThread();
 }
 
+bool PooledSequencedTaskRunner::CanRunTaskInlineInCurrentSequence() const {
+  return RunsTasksInCurrentSequence() &&
+         PooledTaskRunnerDelegate::MatchesCurrentDelegate(
+             pooled_task_runner_delegate_) &&
+         pooled_task_runner_delegate_->CanRunTaskInline(sequence_.get());
+}
+
 void PooledSequencedTaskRunner::UpdatePriority(TaskPriority priority) {
   pooled_task_runner_delegate_->UpdatePriority(sequence_, priority);
 }
@@ -34,6 +34,8 @@ class BASE_EXPORT PooledSequencedTaskRunner
   bool PostDelayedTask(const Location& from_here,
                        OnceClosure closure,
                        TimeDelta delay) override;
+  bool PostTasks(const Location& from_here,
+                 std::vector<OnceClosure> closures) override;
 
   bool PostDelayedTaskAt(subtle::PostDelayedTaskPassKey,
                          const Location& from_here,
@@ -41,17 +43,40 @@ class BASE_EXPORT PooledSequencedTaskRunner
                          TimeTicks delayed_run_time,
                          subtle::DelayPolicy delay_policy) override;
 
+  DelayedTaskHandle PostCancelableDelayedTask(subtle::PostDelayedTaskPassKey,
+                                              const Location& from_here,
+                                              OnceClosure closure,
+                                              TimeDelta delay) override;
+
+  DelayedTaskHandle PostCancelableDelayedTaskAt(
+      subtle::PostDelayedTaskPassKey,
+      const Location& from_here,
+      OnceClosure closure,
+      TimeTicks delayed_run_time,
+      subtle::DelayPolicy delay_policy) override;
+
   bool PostNonNestableDelayedTask(const Location& from_here,
                                   OnceClosure closure,
                                   TimeDelta delay) override;
 
+  bool PostCoalescedTask(const Location& from_here,
+                         const void* key,
+                         OnceClosure closure,
+                         CoalescingPolicy policy) override;
+
   bool RunsTasksInCurrentSequence() const override;
+  bool CanRunTaskInlineInCurrentSequence() const override;
 
   void UpdatePriority(TaskPriority priority) override;
 
  private:
   ~PooledSequencedTaskRunner() override;
 
+  // SequencedTaskRunner:
+  bool DeleteOrReleaseSoonInternal(const Location& from_here,
+                                   void (*deleter)(const void*),
+                                   const void* object) override;
+
   const raw_ptr<PooledTaskRunnerDelegate> pooled_task_runner_delegate_;
 
   // Sequence for all Tasks posted through this TaskRunner.
@@ -4,9 +4,11 @@
 
 #include "base/task/thread_pool/pooled_single_thread_task_runner_manager.h"
 
+#include <atomic>
 #include <memory>
 #include <string>
 #include <utility>
+#include <vector>
 
 #include "base/bind.h"
 #include "base/callback.h"
@@ -90,14 +92,37 @@ class AtomicThreadRefChecker {
   PlatformThreadRef thread_ref_;
 };
 
+class WorkerThreadDelegate;
+
+// The interface of a PooledSingleThreadTaskRunner to the shared WorkerThread
+// which runs its tasks in SingleThreadTaskRunnerThreadMode::ADAPTIVE.
+class AdaptiveTaskRunner : public SingleThreadTaskRunner {
+ public:
+  // Called by the shared WorkerThread after it ran a task of this runner from
+  // |start_time| to |end_time|.
+  virtual void DidRunTaskOnSharedWorker(TimeTicks start_time,
+                                        TimeTicks end_time) = 0;
+
+  // Returns the delegate of the WorkerThread which runs the tasks of this
+  // runner, after moving them to the dedicated WorkerThread of the runner if
+  // it has one. Must be called in a Transaction on the Sequence of the runner
+  // while it's neither queued nor running, which is when it can move.
+  virtual WorkerThreadDelegate* GetDelegateForIdleSequence() = 0;
+
+ protected:
+  ~AdaptiveTaskRunner() override = default;
+};
+
 class WorkerThreadDelegate : public WorkerThread::Delegate {
  public:
   WorkerThreadDelegate(const std::string& thread_name,
                        WorkerThread::ThreadLabel thread_label,
-                       TrackedRef<TaskTracker> task_tracker)
+                       TrackedRef<TaskTracker> task_tracker,
+                       bool runs_adaptive_task_runners = false)
       : task_tracker_(std::move(task_tracker)),
         thread_name_(thread_name),
-        thread_label_(thread_label) {}
+        thread_label_(thread_label),
+        runs_adaptive_task_runners_(runs_adaptive_task_runners) {}
   WorkerThreadDelegate(const WorkerThreadDelegate&) = delete;
   WorkerThreadDelegate& operator=(const WorkerThreadDelegate&) = delete;
 
@@ -127,27 +152,44 @@ class WorkerThreadDelegate : public WorkerThread::Delegate {
     }
     auto run_status = task_source.WillRunTask();
     DCHECK_NE(run_status, TaskSource::RunStatus::kDisallowed);
+    if (runs_adaptive_task_runners_) {
+      // The task runner is alive while its Sequence isn't empty.
+      running_task_runner_ =
+          static_cast<AdaptiveTaskRunner*>(task_source->task_runner());
+      task_start_time_ = TimeTicks::Now();
+    }
     return task_source;
   }
 
   void DidProcessTask(RegisteredTaskSource task_source) override {
-    if (task_source) {
-      EnqueueTaskSource(TransactionWithRegisteredTaskSource::FromTaskSource(
-          std::move(task_source)));
-    }
+    const scoped_refptr<AdaptiveTaskRunner> task_runner =
+        std::move(running_task_runner_);
+    if (task_runner)
+      task_runner->DidRunTaskOnSharedWorker(task_start_time_, TimeTicks::Now());
+    if (!task_source)
+      return;
+
+    auto transaction_with_task_source =
+        TransactionWithRegisteredTaskSource::FromTaskSource(
+            std::move(task_source));
+    // The Sequence of an ADAPTIVE task runner may move to another worker,
+    // which must then be woken up.
+    WorkerThreadDelegate* const delegate =
+        task_runner ? task_runner->GetDelegateForIdleSequence() : this;
+    if (delegate->EnqueueTaskSource(std::move(transaction_with_task_source)))
+      delegate->worker_->WakeUp();
   }
 
   TimeDelta GetSleepTimeout() override { return TimeDelta::Max(); }
 
-  bool PostTaskNow(scoped_refptr<Sequence> sequence, Task task) {
-    auto transaction = sequence->BeginTransaction();
-
-    // |task| will be pushed to |sequence|, and |sequence| will be queued
-    // to |priority_queue_| iff |sequence_should_be_queued| is true.
+  bool PostTaskNow(Sequence::Transaction transaction, Task task) {
+    // |task| will be pushed to the Sequence of |transaction|, which will be
+    // queued to |priority_queue_| iff |sequence_should_be_queued| is true.
     const bool sequence_should_be_queued = transaction.WillPushTask();
     RegisteredTaskSource task_source;
     if (sequence_should_be_queued) {
-      task_source = task_tracker_->RegisterTaskSource(sequence);
+      task_source = task_tracker_->RegisterTaskSource(
+          WrapRefCounted(transaction.sequence()));
       // We shouldn't push |task| if we're not allowed to queue |task_source|.
       if (!task_source)
         return false;
@@ -233,6 +275,12 @@ class WorkerThreadDelegate : public WorkerThread::Delegate {
   const std::string thread_name_;
   const WorkerThread::ThreadLabel thread_label_;
 
+  // True for the shared workers of ADAPTIVE task runners, which track the
+  // runner of the running task, and when it started.
+  const bool runs_adaptive_task_runners_;
+  scoped_refptr<AdaptiveTaskRunner> running_task_runner_;
+  TimeTicks task_start_time_;
+
   // The WorkerThread that has |this| as a delegate. Must be set before
   // starting or posting a task to the WorkerThread, because it's used in
   // OnMainEntry() and PostTaskNow().
@@ -383,24 +431,29 @@ class WorkerThreadCOMDelegate : public WorkerThreadDelegate {
 
 }  // namespace
 
-class PooledSingleThreadTaskRunnerManager::PooledSingleThreadTaskRunner
-    : public SingleThreadTaskRunner {
+class PooledSingleThreadTaskRunnerManager::PooledSingleThreadTaskRunner final
+    : public AdaptiveTaskRunner {
  public:
   // Constructs a PooledSingleThreadTaskRunner that indirectly controls the
-  // lifetime of a dedicated |worker| for |traits|.
+  // lifetime of a dedicated |worker| for |traits|. An ADAPTIVE runner measures
+  // how busy it keeps |worker| over windows of |adaptive_busy_window|.
   PooledSingleThreadTaskRunner(PooledSingleThreadTaskRunnerManager* const outer,
                                const TaskTraits& traits,
                                WorkerThread* worker,
-                               SingleThreadTaskRunnerThreadMode thread_mode)
+                               SingleThreadTaskRunnerThreadMode thread_mode,
+                               TimeDelta adaptive_busy_window)
       : outer_(outer),
         worker_(worker),
         thread_mode_(thread_mode),
+        traits_(traits),
+        adaptive_busy_window_(adaptive_busy_window),
+        window_start_time_(TimeTicks::Now()),
         sequence_(
             MakeRefCounted<Sequence>(traits,
                                      this,
                                      TaskSourceExecutionMode::kSingleThread)) {
     DCHECK(outer_);
-    DCHECK(worker_);
+    DCHECK(GetWorker());
   }
   PooledSingleThreadTaskRunner(const PooledSingleThreadTaskRunner&) = delete;
   PooledSingleThreadTaskRunner& operator=(const PooledSingleThreadTaskRunner&) =
@@ -427,6 +480,7 @@ class PooledSingleThreadTaskRunnerManager::PooledSingleThreadTaskRunner
 
     Task task(from_here, std::move(closure), TimeTicks::Now(),
               delayed_run_time);
+    task.delay_policy = delay_policy;
     return PostTask(std::move(task));
   }
 
@@ -437,12 +491,62 @@ class PooledSingleThreadTaskRunnerManager::PooledSingleThreadTaskRunner
     return PostDelayedTask(from_here, std::move(closure), delay);
   }
 
+  bool PostCoalescedTask(const Location& from_here,
+                         const void* key,
+                         OnceClosure closure,
+                         CoalescingPolicy policy) override {
+    if (!g_manager_is_alive)
+      return false;
+
+    const scoped_refptr<CoalescedTasks> coalesced_tasks =
+        sequence_->BeginTransaction().GetCoalescedTasks();
+    OnceClosure pending_closure =
+        coalesced_tasks->Coalesce(key, std::move(closure), policy);
+    if (!pending_closure)
+      return true;
+
+    Task task(from_here, std::move(pending_closure), TimeTicks::Now(),
+              TimeDelta());
+    return PostTask(std::move(task));
+  }
+
   bool RunsTasksInCurrentSequence() const override {
     if (!g_manager_is_alive)
       return false;
     return GetDelegate()->RunsTasksInCurrentSequence();
   }
 
+  // AdaptiveTaskRunner:
+  void DidRunTaskOnSharedWorker(TimeTicks start_time,
+                                TimeTicks end_time) override {
+    DCHECK_EQ(thread_mode_, SingleThreadTaskRunnerThreadMode::ADAPTIVE);
+    busy_time_in_window_ += end_time - start_time;
+    const TimeDelta window = end_time - window_start_time_;
+    if (window < adaptive_busy_window_)
+      return;
+    // A window spanning idle periods counts as one, which isn't busy.
+    busy_windows_ = busy_time_in_window_ * 2 > window ? busy_windows_ + 1 : 0;
+    window_start_time_ = end_time;
+    busy_time_in_window_ = TimeDelta();
+    if (busy_windows_ < kAdaptiveBusyWindows || has_dedicated_worker_)
+      return;
+
+    has_dedicated_worker_ = true;
+    WorkerThread* const dedicated_worker =
+        outer_->CreateAdaptiveDedicatedWorkerThread(traits_);
+    auto transaction = sequence_->BeginTransaction();
+    dedicated_worker_ = dedicated_worker;
+    // Otherwise, the Sequence moves when it's next enqueued.
+    if (transaction.WillPushTask())
+      GetDelegateForIdleSequence();
+  }
+
+  WorkerThreadDelegate* GetDelegateForIdleSequence() override {
+    if (dedicated_worker_)
+      worker_.store(dedicated_worker_, std::memory_order_relaxed);
+    return GetDelegate();
+  }
+
  private:
   ~PooledSingleThreadTaskRunner() override {
     // Only unregister if this is a DEDICATED SingleThreadTaskRunner. SHARED
@@ -465,8 +569,28 @@ class PooledSingleThreadTaskRunnerManager::PooledSingleThreadTaskRunner
     // here.
     if (g_manager_is_alive &&
         thread_mode_ == SingleThreadTaskRunnerThreadMode::DEDICATED) {
-      outer_->UnregisterWorkerThread(worker_);
+      outer_->UnregisterWorkerThread(GetWorker());
     }
+    // An ADAPTIVE runner controls the lifetime of its dedicated worker only.
+    if (g_manager_is_alive && dedicated_worker_)
+      outer_->UnregisterWorkerThread(dedicated_worker_);
+  }
+
+  // SequencedTaskRunner:
+  bool DeleteOrReleaseSoonInternal(const Location& from_here,
+                                   void (*deleter)(const void*),
+                                   const void* object) override {
+    if (!g_manager_is_alive)
+      return false;
+
+    OnceClosure batch_closure =
+        sequence_->BeginTransaction().AddToDeletionBatch(deleter, object);
+    if (!batch_closure)
+      return true;
+
+    Task task(from_here, std::move(batch_closure), TimeTicks::Now(),
+              TimeDelta());
+    return PostTask(std::move(task));
   }
 
   bool PostTask(Task task) {
@@ -476,25 +600,54 @@ class PooledSingleThreadTaskRunnerManager::PooledSingleThreadTaskRunner
     }
 
     if (task.delayed_run_time.is_null())
-      return GetDelegate()->PostTaskNow(sequence_, std::move(task));
+      return PostTaskNow(std::move(task));
 
-    // Unretained(GetDelegate()) is safe because this TaskRunner and its
-    // worker are kept alive as long as there are pending Tasks.
+    // Unretained(this) is safe because the DelayedTaskManager keeps this
+    // TaskRunner alive until it runs the callback, and this TaskRunner keeps
+    // its workers alive as long as there are pending Tasks.
     outer_->delayed_task_manager_->AddDelayedTask(
         std::move(task),
-        BindOnce(IgnoreResult(&WorkerThreadDelegate::PostTaskNow),
-                 Unretained(GetDelegate()), sequence_),
+        BindOnce(IgnoreResult(&PooledSingleThreadTaskRunner::PostTaskNow),
+                 Unretained(this)),
         this);
     return true;
   }
 
+  bool PostTaskNow(Task task) {
+    auto transaction = sequence_->BeginTransaction();
+    WorkerThreadDelegate* const delegate = transaction.WillPushTask()
+                                               ? GetDelegateForIdleSequence()
+                                               : GetDelegate();
+    return delegate->PostTaskNow(std::move(transaction), std::move(task));
+  }
+
+  WorkerThread* GetWorker() const {
+    return worker_.load(std::memory_order_relaxed);
+  }
+
   WorkerThreadDelegate* GetDelegate() const {
-    return static_cast<WorkerThreadDelegate*>(worker_->delegate());
+    return static_cast<WorkerThreadDelegate*>(GetWorker()->delegate());
   }
 
   const raw_ptr<PooledSingleThreadTaskRunnerManager> outer_;
-  const raw_ptr<WorkerThread> worker_;
+  // Only ADAPTIVE runners change their worker, in a Transaction on
+  // |sequence_|, while no task of theirs is queued or running.
+  std::atomic<WorkerThread*> worker_;
   const SingleThreadTaskRunnerThreadMode thread_mode_;
+  const TaskTraits traits_;
+
+  // The dedicated worker of an ADAPTIVE runner. Set once, in a Transaction on
+  // |sequence_|.
+  WorkerThread* dedicated_worker_ = nullptr;
+
+  // How busy an ADAPTIVE runner keeps its shared worker. Accessed by the
+  // worker running the tasks of the runner.
+  const TimeDelta adaptive_busy_window_;
+  TimeTicks window_start_time_;
+  TimeDelta busy_time_in_window_;
+  int busy_windows_ = 0;
+  bool has_dedicated_worker_ = false;
+
   const scoped_refptr<Sequence> sequence_;
 };
 
@@ -579,6 +732,8 @@ scoped_refptr<SingleThreadTaskRunner>
 PooledSingleThreadTaskRunnerManager::CreateCOMSTATaskRunner(
     const TaskTraits& traits,
     SingleThreadTaskRunnerThreadMode thread_mode) {
+  DCHECK_NE(thread_mode, SingleThreadTaskRunnerThreadMode::ADAPTIVE)
+      << "COM STA objects can't move to another thread.";
   return CreateTaskRunnerImpl<WorkerThreadCOMDelegate>(traits, thread_mode);
 }
 #endif  // BUILDFLAG(IS_WIN)
@@ -597,48 +752,71 @@ scoped_refptr<PooledSingleThreadTaskRunnerManager::PooledSingleThreadTaskRunner>
 PooledSingleThreadTaskRunnerManager::CreateTaskRunnerImpl(
     const TaskTraits& traits,
     SingleThreadTaskRunnerThreadMode thread_mode) {
-  DCHECK(thread_mode != SingleThreadTaskRunnerThreadMode::SHARED ||
+  DCHECK(thread_mode == SingleThreadTaskRunnerThreadMode::DEDICATED ||
          !traits.with_base_sync_primitives())
       << "Using WithBaseSyncPrimitives() on a shared SingleThreadTaskRunner "
          "may cause deadlocks. Either reevaluate your usage (e.g. use "
          "SequencedTaskRunner) or use "
          "SingleThreadTaskRunnerThreadMode::DEDICATED.";
-  // To simplify the code, |dedicated_worker| is a local only variable that
-  // allows the code to treat both the DEDICATED and SHARED cases similarly for
-  // SingleThreadTaskRunnerThreadMode. In DEDICATED, the scoped_refptr is backed
-  // by a local variable and in SHARED, the scoped_refptr is backed by a member
-  // variable.
-  WorkerThread* dedicated_worker = nullptr;
-  WorkerThread*& worker =
-      thread_mode == SingleThreadTaskRunnerThreadMode::DEDICATED
-          ? dedicated_worker
-          : GetSharedWorkerThreadForTraits<DelegateType>(traits);
+  WorkerThread* worker;
   bool new_worker = false;
   bool started;
+  TimeDelta adaptive_busy_window;
   {
     CheckedAutoLock auto_lock(lock_);
-    if (!worker) {
-      const auto& environment_params =
-          kEnvironmentParams[GetEnvironmentIndexForTraits(traits)];
-      std::string worker_name;
-      if (thread_mode == SingleThreadTaskRunnerThreadMode::SHARED)
-        worker_name += "Shared";
-      worker_name += environment_params.name_suffix;
-      worker = CreateAndRegisterWorkerThread<DelegateType>(
-          worker_name, thread_mode,
-          CanUseBackgroundPriorityForWorkerThread()
-              ? environment_params.priority_hint
-              : ThreadPriority::NORMAL);
+    // To simplify the code, |dedicated_worker| is a local only variable that
+    // allows the code to treat the DEDICATED, SHARED and ADAPTIVE cases
+    // similarly for SingleThreadTaskRunnerThreadMode. In DEDICATED, the
+    // reference is backed by a local variable and otherwise, it is backed by a
+    // member variable.
+    WorkerThread* dedicated_worker = nullptr;
+    WorkerThread*& worker_ref =
+        thread_mode == SingleThreadTaskRunnerThreadMode::DEDICATED
+            ? dedicated_worker
+            : thread_mode == SingleThreadTaskRunnerThreadMode::SHARED
+                  ? GetSharedWorkerThreadForTraits<DelegateType>(traits)
+                  : GetNextAdaptiveWorkerThreadForTraits(traits);
+    if (!worker_ref) {
+      worker_ref = CreateAndRegisterWorkerThreadForTraits<DelegateType>(
+          traits, thread_mode);
       new_worker = true;
     }
+    worker = worker_ref;
     started = started_;
+    adaptive_busy_window = adaptive_busy_window_;
   }
 
   if (new_worker && started)
     worker->Start(worker_thread_observer_);
 
-  return MakeRefCounted<PooledSingleThreadTaskRunner>(this, traits, worker,
-                                                      thread_mode);
+  return MakeRefCounted<PooledSingleThreadTaskRunner>(
+      this, traits, worker, thread_mode, adaptive_busy_window);
+}
+
+template <typename DelegateType>
+WorkerThread*
+PooledSingleThreadTaskRunnerManager::CreateAndRegisterWorkerThreadForTraits(
+    const TaskTraits& traits,
+    SingleThreadTaskRunnerThreadMode thread_mode) {
+  const auto& environment_params =
+      kEnvironmentParams[GetEnvironmentIndexForTraits(traits)];
+  std::string worker_name;
+  if (thread_mode == SingleThreadTaskRunnerThreadMode::SHARED)
+    worker_name += "Shared";
+  else if (thread_mode == SingleThreadTaskRunnerThreadMode::ADAPTIVE)
+    worker_name += "Adaptive";
+  worker_name += environment_params.name_suffix;
+  return CreateAndRegisterWorkerThread<DelegateType>(
+      worker_name, thread_mode,
+      CanUseBackgroundPriorityForWorkerThread()
+          ? environment_params.priority_hint
+          : ThreadPriority::NORMAL);
+}
+
+void PooledSingleThreadTaskRunnerManager::SetAdaptiveBusyWindowForTesting(
+    TimeDelta adaptive_busy_window) {
+  CheckedAutoLock auto_lock(lock_);
+  adaptive_busy_window_ = adaptive_busy_window;
 }
 
 void PooledSingleThreadTaskRunnerManager::JoinForTesting() {
@@ -678,7 +856,8 @@ PooledSingleThreadTaskRunnerManager::CreateWorkerThreadDelegate<
       thread_mode == SingleThreadTaskRunnerThreadMode::DEDICATED
           ? WorkerThread::ThreadLabel::DEDICATED
           : WorkerThread::ThreadLabel::SHARED,
-      task_tracker_);
+      task_tracker_,
+      thread_mode == SingleThreadTaskRunnerThreadMode::ADAPTIVE);
 }
 
 #if BUILDFLAG(IS_WIN)
@@ -732,6 +911,35 @@ PooledSingleThreadTaskRunnerManager::GetSharedWorkerThreadForTraits<
 }
 #endif  // BUILDFLAG(IS_WIN)
 
+WorkerThread*&
+PooledSingleThreadTaskRunnerManager::GetNextAdaptiveWorkerThreadForTraits(
+    const TaskTraits& traits) {
+  const size_t environment_index = GetEnvironmentIndexForTraits(traits);
+  const ContinueOnShutdown continue_on_shutdown =
+      TraitsToContinueOnShutdown(traits);
+  size_t& next =
+      next_adaptive_worker_thread_[environment_index][continue_on_shutdown];
+  WorkerThread*& worker =
+      adaptive_worker_threads_[environment_index][continue_on_shutdown][next];
+  next = (next + 1) % kMaxAdaptiveWorkerThreads;
+  return worker;
+}
+
+WorkerThread*
+PooledSingleThreadTaskRunnerManager::CreateAdaptiveDedicatedWorkerThread(
+    const TaskTraits& traits) {
+  WorkerThread* worker;
+  {
+    CheckedAutoLock auto_lock(lock_);
+    // The runner asking for it has run tasks.
+    DCHECK(started_);
+    worker = CreateAndRegisterWorkerThreadForTraits<WorkerThreadDelegate>(
+        traits, SingleThreadTaskRunnerThreadMode::DEDICATED);
+  }
+  worker->Start(worker_thread_observer_);
+  return worker;
+}
+
 void PooledSingleThreadTaskRunnerManager::UnregisterWorkerThread(
     WorkerThread* worker) {
   // Cleanup uses a CheckedLock, so call Cleanup() after releasing |lock_|.
@@ -752,35 +960,28 @@ void PooledSingleThreadTaskRunnerManager::UnregisterWorkerThread(
 }
 
 void PooledSingleThreadTaskRunnerManager::ReleaseSharedWorkerThreads() {
-  decltype(shared_worker_threads_) local_shared_worker_threads;
-#if BUILDFLAG(IS_WIN)
-  decltype(shared_com_worker_threads_) local_shared_com_worker_threads;
-#endif
+  std::vector<WorkerThread*> local_shared_worker_threads;
   {
     CheckedAutoLock auto_lock(lock_);
+    auto release = [&](WorkerThread*& worker) {
+      if (worker)
+        local_shared_worker_threads.push_back(worker);
+      worker = nullptr;
+    };
     for (size_t i = 0; i < base::size(shared_worker_threads_); ++i) {
       for (size_t j = 0; j < base::size(shared_worker_threads_[i]); ++j) {
-        local_shared_worker_threads[i][j] = shared_worker_threads_[i][j];
-        shared_worker_threads_[i][j] = nullptr;
+        release(shared_worker_threads_[i][j]);
+        for (WorkerThread*& worker : adaptive_worker_threads_[i][j])
+          release(worker);
 #if BUILDFLAG(IS_WIN)
-        local_shared_com_worker_threads[i][j] =
-            shared_com_worker_threads_[i][j];
-        shared_com_worker_threads_[i][j] = nullptr;
+        release(shared_com_worker_threads_[i][j]);
 #endif
       }
     }
   }
 
-  for (size_t i = 0; i < base::size(local_shared_worker_threads); ++i) {
-    for (size_t j = 0; j < base::size(local_shared_worker_threads[i]); ++j) {
-      if (local_shared_worker_threads[i][j])
-        UnregisterWorkerThread(local_shared_worker_threads[i][j]);
-#if BUILDFLAG(IS_WIN)
-      if (local_shared_com_worker_threads[i][j])
-        UnregisterWorkerThread(local_shared_com_worker_threads[i][j]);
-#endif
-    }
-  }
+  for (WorkerThread* worker : local_shared_worker_threads)
+    UnregisterWorkerThread(worker);
 }
 
 }  // namespace internal
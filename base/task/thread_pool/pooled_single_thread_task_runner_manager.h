@@ -18,6 +18,7 @@
 #include "base/task/thread_pool/tracked_ref.h"
 #include "base/thread_annotations.h"
 #include "base/threading/platform_thread.h"
+#include "base/time/time.h"
 #include "build/build_config.h"
 
 namespace base {
@@ -46,11 +47,20 @@ class WorkerThreadDelegate;
 // These workers are lazily instantiated and then only reclaimed during
 // JoinForTesting()
 //
+// SingleThreadTaskRunners using SingleThreadTaskRunnerThreadMode::ADAPTIVE are
+// spread over up to kMaxAdaptiveWorkerThreads shared WorkerThreads for each
+// task environment combination, and each moves to a dedicated WorkerThread
+// once its tasks have kept its shared WorkerThread busy for more than half of
+// kAdaptiveBusyWindows consecutive 1-second windows.
+//
 // No threads are created (and hence no tasks can run) before Start() is called.
 //
 // This class is thread-safe.
 class BASE_EXPORT PooledSingleThreadTaskRunnerManager final {
  public:
+  static constexpr size_t kMaxAdaptiveWorkerThreads = 4;
+  static constexpr int kAdaptiveBusyWindows = 5;
+
   PooledSingleThreadTaskRunnerManager(TrackedRef<TaskTracker> task_tracker,
                                       DelayedTaskManager* delayed_task_manager);
   PooledSingleThreadTaskRunnerManager(
@@ -71,7 +81,7 @@ class BASE_EXPORT PooledSingleThreadTaskRunnerManager final {
   void DidUpdateCanRunPolicy();
 
   // Creates a SingleThreadTaskRunner which runs tasks with |traits| on a thread
-  // named "ThreadPoolSingleThread[Shared]" +
+  // named "ThreadPoolSingleThread[Shared|Adaptive]" +
   // kEnvironmentParams[GetEnvironmentIndexForTraits(traits)].name_suffix +
   // index.
   scoped_refptr<SingleThreadTaskRunner> CreateSingleThreadTaskRunner(
@@ -90,6 +100,10 @@ class BASE_EXPORT PooledSingleThreadTaskRunnerManager final {
 
   void JoinForTesting();
 
+  // Sets the period over which the SingleThreadTaskRunnerThreadMode::ADAPTIVE
+  // SingleThreadTaskRunners created afterwards measure how busy they are.
+  void SetAdaptiveBusyWindowForTesting(TimeDelta adaptive_busy_window);
+
  private:
   class PooledSingleThreadTaskRunner;
 
@@ -119,9 +133,24 @@ class BASE_EXPORT PooledSingleThreadTaskRunnerManager final {
       SingleThreadTaskRunnerThreadMode thread_mode,
       ThreadPriority priority_hint) EXCLUSIVE_LOCKS_REQUIRED(lock_);
 
+  template <typename DelegateType>
+  WorkerThread* CreateAndRegisterWorkerThreadForTraits(
+      const TaskTraits& traits,
+      SingleThreadTaskRunnerThreadMode thread_mode)
+      EXCLUSIVE_LOCKS_REQUIRED(lock_);
+
+  // Creates a WorkerThread dedicated to a SingleThreadTaskRunnerThreadMode::
+  // ADAPTIVE SingleThreadTaskRunner with |traits|, and starts it.
+  WorkerThread* CreateAdaptiveDedicatedWorkerThread(const TaskTraits& traits);
+
   template <typename DelegateType>
   WorkerThread*& GetSharedWorkerThreadForTraits(const TaskTraits& traits);
 
+  // Returns the next of the SingleThreadTaskRunnerThreadMode::ADAPTIVE shared
+  // WorkerThreads for |traits|, in turn.
+  WorkerThread*& GetNextAdaptiveWorkerThreadForTraits(const TaskTraits& traits)
+      EXCLUSIVE_LOCKS_REQUIRED(lock_);
+
   void UnregisterWorkerThread(WorkerThread* worker);
 
   void ReleaseSharedWorkerThreads();
@@ -145,6 +174,15 @@ class BASE_EXPORT PooledSingleThreadTaskRunnerManager final {
   WorkerThread* shared_worker_threads_[ENVIRONMENT_COUNT]
                                       [CONTINUE_ON_SHUTDOWN_COUNT] GUARDED_BY(
                                           lock_) = {};
+  // Shared workers for SingleThreadTaskRunnerThreadMode::ADAPTIVE tasks, and
+  // the index of the next one to hand out, for the same combinations.
+  WorkerThread* adaptive_worker_threads_[ENVIRONMENT_COUNT]
+                                        [CONTINUE_ON_SHUTDOWN_COUNT]
+                                        [kMaxAdaptiveWorkerThreads] GUARDED_BY(
+                                            lock_) = {};
+  size_t next_adaptive_worker_thread_[ENVIRONMENT_COUNT]
+                                     [CONTINUE_ON_SHUTDOWN_COUNT] GUARDED_BY(
+                                         lock_) = {};
 #if BUILDFLAG(IS_WIN)
   WorkerThread* shared_com_worker_threads_
       [ENVIRONMENT_COUNT][CONTINUE_ON_SHUTDOWN_COUNT] GUARDED_BY(lock_) = {};
@@ -152,6 +190,9 @@ class BASE_EXPORT PooledSingleThreadTaskRunnerManager final {
 
   // Set to true when Start() is called.
   bool started_ GUARDED_BY(lock_) = false;
+
+  // See SetAdaptiveBusyWindowForTesting().
+  TimeDelta adaptive_busy_window_ GUARDED_BY(lock_) = Seconds(1);
 };
 
 }  // namespace internal
@@ -139,6 +139,63 @@ TEST_F(PooledSingleThreadTaskRunnerManagerTest, SameThreadUsed) {
   EXPECT_EQ(thread_ref_1, thread_ref_2);
 }
 
+TEST_F(PooledSingleThreadTaskRunnerManagerTest, AdaptiveThreadsShared) {
+  constexpr size_t kNumThreads =
+      PooledSingleThreadTaskRunnerManager::kMaxAdaptiveWorkerThreads;
+  PlatformThreadRef thread_refs[2 * kNumThreads];
+  for (PlatformThreadRef& thread_ref : thread_refs) {
+    single_thread_task_runner_manager_
+        ->CreateSingleThreadTaskRunner(
+            {TaskShutdownBehavior::BLOCK_SHUTDOWN},
+            SingleThreadTaskRunnerThreadMode::ADAPTIVE)
+        ->PostTask(FROM_HERE, BindOnce(&CaptureThreadRef, &thread_ref));
+  }
+
+  test::ShutdownTaskTracker(&task_tracker_);
+
+  // The task runners take turns on the shared threads.
+  for (size_t i = 0; i < kNumThreads; ++i) {
+    ASSERT_FALSE(thread_refs[i].is_null());
+    EXPECT_EQ(thread_refs[i], thread_refs[i + kNumThreads]);
+    for (size_t j = 0; j < i; ++j)
+      EXPECT_NE(thread_refs[i], thread_refs[j]);
+  }
+}
+
+TEST_F(PooledSingleThreadTaskRunnerManagerTest, AdaptiveMovesWhenBusy) {
+  single_thread_task_runner_manager_->SetAdaptiveBusyWindowForTesting(
+      Milliseconds(10));
+  scoped_refptr<SingleThreadTaskRunner> task_runner =
+      single_thread_task_runner_manager_->CreateSingleThreadTaskRunner(
+          {TaskShutdownBehavior::BLOCK_SHUTDOWN},
+          SingleThreadTaskRunnerThreadMode::ADAPTIVE);
+
+  // Keeps the shared thread busy until the task runner moves.
+  PlatformThreadRef shared_thread_ref;
+  std::string dedicated_thread_name;
+  TestWaitableEvent moved;
+  RepeatingClosure busy_task;
+  busy_task = BindLambdaForTesting([&]() {
+    EXPECT_TRUE(task_runner->RunsTasksInCurrentSequence());
+    if (shared_thread_ref.is_null())
+      shared_thread_ref = PlatformThread::CurrentRef();
+    if (PlatformThread::CurrentRef() != shared_thread_ref) {
+      dedicated_thread_name = PlatformThread::GetName();
+      moved.Signal();
+      return;
+    }
+    PlatformThread::Sleep(Milliseconds(2));
+    task_runner->PostTask(FROM_HERE, busy_task);
+  });
+  task_runner->PostTask(FROM_HERE, busy_task);
+  moved.Wait();
+
+  // A dedicated thread has no "Shared" nor "Adaptive" in its name.
+  EXPECT_THAT(dedicated_thread_name,
+              ::testing::MatchesRegex(
+                  "^ThreadPoolSingleThreadForeground\\d+$"));
+}
+
 TEST_F(PooledSingleThreadTaskRunnerManagerTest, RunsTasksInCurrentSequence) {
   scoped_refptr<SingleThreadTaskRunner> task_runner_1 =
       single_thread_task_runner_manager_->CreateSingleThreadTaskRunner(
@@ -283,7 +340,8 @@ TEST_P(PooledSingleThreadTaskRunnerManagerCommonTest, PrioritySetCorrectly) {
 TEST_P(PooledSingleThreadTaskRunnerManagerCommonTest, ThreadNamesSet) {
   const std::string maybe_shared(
       GetParam() == SingleThreadTaskRunnerThreadMode::DEDICATED ? ""
-                                                                : "Shared");
+      : GetParam() == SingleThreadTaskRunnerThreadMode::SHARED  ? "Shared"
+                                                                : "Adaptive");
   const std::string background =
       "^ThreadPoolSingleThread" + maybe_shared + "Background\\d+$";
   const std::string foreground =
@@ -424,10 +482,11 @@ TEST_P(PooledSingleThreadTaskRunnerManagerCommonTest, CanRunPolicyLoad) {
 }
 
 INSTANTIATE_TEST_SUITE_P(
-    SharedAndDedicated,
+    AllModes,
     PooledSingleThreadTaskRunnerManagerCommonTest,
     ::testing::Values(SingleThreadTaskRunnerThreadMode::SHARED,
-                      SingleThreadTaskRunnerThreadMode::DEDICATED));
+                      SingleThreadTaskRunnerThreadMode::DEDICATED,
+                      SingleThreadTaskRunnerThreadMode::ADAPTIVE));
 
 namespace {
 
@@ -535,6 +594,8 @@ TEST_F(PooledSingleThreadTaskRunnerManagerJoinTest,
 #if BUILDFLAG(IS_WIN)
 
 TEST_P(PooledSingleThreadTaskRunnerManagerCommonTest, COMSTAInitialized) {
+  if (GetParam() == SingleThreadTaskRunnerThreadMode::ADAPTIVE)
+    GTEST_SKIP() << "COM STA task runners can't be ADAPTIVE.";
   scoped_refptr<SingleThreadTaskRunner> com_task_runner =
       single_thread_task_runner_manager_->CreateCOMSTATaskRunner(
           {TaskShutdownBehavior::BLOCK_SHUTDOWN}, GetParam());
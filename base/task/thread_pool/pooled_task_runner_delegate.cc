@@ -4,7 +4,11 @@
 
 #include "base/task/thread_pool/pooled_task_runner_delegate.h"
 
+#include <utility>
+
+#include "base/check_op.h"
 #include "base/debug/task_trace.h"
+#include "base/task/default_delayed_task_handle_delegate.h"
 #include "base/logging.h"
 
 namespace base {
@@ -52,5 +56,45 @@ bool PooledTaskRunnerDelegate::MatchesCurrentDelegate(
   return g_current_delegate == delegate;
 }
 
+DelayedTaskHandle PooledTaskRunnerDelegate::PostCancelableTaskWithSequence(
+    Task task,
+    scoped_refptr<Sequence> sequence) {
+  auto delayed_task_handle_delegate =
+      std::make_unique<DefaultDelayedTaskHandleDelegate>();
+  task.task = delayed_task_handle_delegate->BindCallback(std::move(task.task));
+  DelayedTaskHandle delayed_task_handle(
+      std::move(delayed_task_handle_delegate));
+  // If the task fails to be posted, the handle is invalidated upon destruction
+  // of the callback object.
+  if (!PostTaskWithSequence(std::move(task), std::move(sequence)))
+    DCHECK(!delayed_task_handle.IsValid());
+  return delayed_task_handle;
+}
+
+bool PooledTaskRunnerDelegate::PostTasksWithSequence(
+    std::vector<Task> tasks,
+    scoped_refptr<Sequence> sequence) {
+  bool all_posted = true;
+  for (Task& task : tasks)
+    all_posted &= PostTaskWithSequence(std::move(task), sequence);
+  return all_posted;
+}
+
+bool PooledTaskRunnerDelegate::PostTasksWithSequences(
+    std::vector<Task> tasks,
+    std::vector<scoped_refptr<Sequence>> sequences) {
+  DCHECK_EQ(tasks.size(), sequences.size());
+  bool all_posted = true;
+  for (size_t i = 0; i < tasks.size(); ++i) {
+    all_posted &=
+        PostTaskWithSequence(std::move(tasks[i]), std::move(sequences[i]));
+  }
+  return all_posted;
+}
+
+bool PooledTaskRunnerDelegate::CanRunTaskInline(Sequence* sequence) {
+  return false;
+}
+
 }  // namespace internal
 }  // namespace base
@@ -5,7 +5,10 @@
 #ifndef BASE_TASK_THREAD_POOL_POOLED_TASK_RUNNER_DELEGATE_H_
 #define BASE_TASK_THREAD_POOL_POOLED_TASK_RUNNER_DELEGATE_H_
 
+#include <vector>
+
 #include "base/base_export.h"
+#include "base/task/delayed_task_handle.h"
 #include "base/task/task_traits.h"
 #include "base/task/thread_pool/job_task_source.h"
 #include "base/task/thread_pool/sequence.h"
@@ -41,6 +44,36 @@ class BASE_EXPORT PooledTaskRunnerDelegate {
   virtual bool PostTaskWithSequence(Task task,
                                     scoped_refptr<Sequence> sequence) = 0;
 
+  // Same as PostTaskWithSequence(), but returns a handle that can cancel the
+  // delayed |task|. The handle is invalid if |task| wasn't posted. The default
+  // implementation wraps |task| in a DefaultDelayedTaskHandleDelegate.
+  virtual DelayedTaskHandle PostCancelableTaskWithSequence(
+      Task task,
+      scoped_refptr<Sequence> sequence);
+
+  // Invoked when a batch of non-delayed |tasks| is posted to a
+  // PooledSequencedTaskRunner. The implementation must post |tasks| in order to
+  // |sequence|. Returns true if all tasks were successfully posted. The default
+  // implementation calls PostTaskWithSequence() for each task.
+  virtual bool PostTasksWithSequence(std::vector<Task> tasks,
+                                     scoped_refptr<Sequence> sequence);
+
+  // Invoked when a batch of non-delayed |tasks| is posted to a
+  // PooledParallelTaskRunner. The implementation must post |tasks[i]| to
+  // |sequences[i]|, where each sequence is a new one-off Sequence with the same
+  // traits. Returns true if all tasks were successfully posted. The default
+  // implementation calls PostTaskWithSequence() for each task.
+  virtual bool PostTasksWithSequences(
+      std::vector<Task> tasks,
+      std::vector<scoped_refptr<Sequence>> sequences);
+
+  // Returns true if a non-delayed task posted to |sequence| by the task of
+  // |sequence| running on the current thread may run synchronously at the end
+  // of that task instead. See
+  // SequencedTaskRunner::CanRunTaskInlineInCurrentSequence(). The default
+  // implementation returns false.
+  virtual bool CanRunTaskInline(Sequence* sequence);
+
   // Invoked when a task is posted as a Job. The implementation must add
   // |task_source| to the appropriate priority queue, depending on |task_source|
   // traits, if it's not there already. Returns true if task source was
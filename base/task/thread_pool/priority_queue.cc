@@ -4,7 +4,9 @@
 
 #include "base/task/thread_pool/priority_queue.h"
 
+#include <algorithm>
 #include <utility>
+#include <vector>
 
 #include "base/check_op.h"
 #include "base/memory/ptr_util.h"
@@ -87,7 +89,7 @@ PriorityQueue::~PriorityQueue() {
   if (!is_flush_task_sources_on_destroy_enabled_)
     return;
 
-  while (!container_.empty()) {
+  while (!IsEmpty()) {
     auto task_source = PopTaskSource();
     auto task = task_source.Clear();
     std::move(task.task).Run();
@@ -98,19 +100,40 @@ PriorityQueue& PriorityQueue::operator=(PriorityQueue&& other) = default;
 
 void PriorityQueue::Push(RegisteredTaskSource task_source,
                          TaskSourceSortKey task_source_sort_key) {
+  IncrementNumTaskSourcesForPriority(task_source_sort_key.priority());
+  // Jobs update their sort key as workers start and stop running them, and
+  // task sources with a deadline are ordered by it, so they always go in the
+  // heap.
+  if (use_priority_lanes_ &&
+      task_source->execution_mode() != TaskSourceExecutionMode::kJob &&
+      task_source_sort_key.deadline().is_null()) {
+    priority_lanes_[static_cast<int>(task_source_sort_key.priority())]
+        .emplace_back(std::move(task_source), task_source_sort_key);
+    return;
+  }
   container_.insert(
       TaskSourceAndSortKey(std::move(task_source), task_source_sort_key));
-  IncrementNumTaskSourcesForPriority(task_source_sort_key.priority());
 }
 
 const TaskSourceSortKey& PriorityQueue::PeekSortKey() const {
   DCHECK(!IsEmpty());
+  const absl::optional<size_t> top_lane = GetTopLane();
+  if (top_lane)
+    return priority_lanes_[*top_lane].front().sort_key();
   return container_.top().sort_key();
 }
 
 RegisteredTaskSource& PriorityQueue::PeekTaskSource() const {
   DCHECK(!IsEmpty());
 
+  const absl::optional<size_t> top_lane = GetTopLane();
+  if (top_lane) {
+    // The const_cast is okay for the same reason as below.
+    return const_cast<PriorityQueue::TaskSourceAndSortKey&>(
+               priority_lanes_[*top_lane].front())
+        .task_source();
+  }
+
   // The const_cast on Min() is okay since modifying the TaskSource cannot alter
   // the sort order of TaskSourceAndSortKey.
   auto& task_source_and_sort_key =
@@ -121,6 +144,15 @@ RegisteredTaskSource& PriorityQueue::PeekTaskSource() const {
 RegisteredTaskSource PriorityQueue::PopTaskSource() {
   DCHECK(!IsEmpty());
 
+  const absl::optional<size_t> top_lane = GetTopLane();
+  if (top_lane) {
+    LaneType& lane = priority_lanes_[*top_lane];
+    DecrementNumTaskSourcesForPriority(lane.front().sort_key().priority());
+    RegisteredTaskSource task_source = lane.front().take_task_source();
+    lane.pop_front();
+    return task_source;
+  }
+
   // The const_cast on Min() is okay since the TaskSourceAndSortKey is
   // transactionally being popped from |container_| right after and taking its
   // TaskSource does not alter its sort order.
@@ -141,7 +173,7 @@ RegisteredTaskSource PriorityQueue::RemoveTaskSource(
 
   const HeapHandle heap_handle = task_source.heap_handle();
   if (!heap_handle.IsValid())
-    return nullptr;
+    return RemoveTaskSourceFromLanes(task_source);
 
   TaskSourceAndSortKey& task_source_and_sort_key =
       const_cast<PriorityQueue::TaskSourceAndSortKey&>(
@@ -162,8 +194,18 @@ void PriorityQueue::UpdateSortKey(const TaskSource& task_source,
     return;
 
   const HeapHandle heap_handle = task_source.heap_handle();
-  if (!heap_handle.IsValid())
+  if (!heap_handle.IsValid()) {
+    // A lane TaskSource whose sort key changes moves to the heap, where it can
+    // be reordered.
+    RegisteredTaskSource registered_task_source =
+        RemoveTaskSourceFromLanes(task_source);
+    if (registered_task_source) {
+      IncrementNumTaskSourcesForPriority(sort_key.priority());
+      container_.insert(
+          TaskSourceAndSortKey(std::move(registered_task_source), sort_key));
+    }
     return;
+  }
 
   auto old_sort_key = container_.at(heap_handle).sort_key();
   auto registered_task_source =
@@ -180,11 +222,34 @@ void PriorityQueue::UpdateSortKey(const TaskSource& task_source,
 }
 
 bool PriorityQueue::IsEmpty() const {
-  return container_.empty();
+  return container_.empty() &&
+         std::all_of(priority_lanes_.begin(), priority_lanes_.end(),
+                     [](const LaneType& lane) { return lane.empty(); });
 }
 
 size_t PriorityQueue::Size() const {
-  return container_.size();
+  size_t size = container_.size();
+  for (const LaneType& lane : priority_lanes_)
+    size += lane.size();
+  return size;
+}
+
+void PriorityQueue::EnablePriorityLanes() {
+  DCHECK(!use_priority_lanes_);
+
+  // Drain the heap before pushing back, since jobs go back into it.
+  std::vector<std::pair<RegisteredTaskSource, TaskSourceSortKey>> task_sources;
+  task_sources.reserve(container_.size());
+  while (!container_.empty()) {
+    const TaskSourceSortKey sort_key = PeekSortKey();
+    task_sources.emplace_back(PopTaskSource(), sort_key);
+  }
+
+  use_priority_lanes_ = true;
+  for (auto& task_source_and_sort_key : task_sources) {
+    Push(std::move(task_source_and_sort_key.first),
+         task_source_and_sort_key.second);
+  }
 }
 
 void PriorityQueue::EnableFlushTaskSourcesOnDestroyForTesting() {
@@ -192,6 +257,39 @@ void PriorityQueue::EnableFlushTaskSourcesOnDestroyForTesting() {
   is_flush_task_sources_on_destroy_enabled_ = true;
 }
 
+absl::optional<size_t> PriorityQueue::GetTopLane() const {
+  // Lanes are visited from the highest priority down, so the front of the first
+  // non-empty lane is the highest priority lane TaskSource.
+  for (size_t i = priority_lanes_.size(); i > 0; --i) {
+    const LaneType& lane = priority_lanes_[i - 1];
+    if (lane.empty())
+      continue;
+    if (!container_.empty() &&
+        lane.front().sort_key() < container_.top().sort_key()) {
+      return absl::nullopt;
+    }
+    return i - 1;
+  }
+  return absl::nullopt;
+}
+
+RegisteredTaskSource PriorityQueue::RemoveTaskSourceFromLanes(
+    const TaskSource& task_source) {
+  for (LaneType& lane : priority_lanes_) {
+    auto it = std::find_if(lane.begin(), lane.end(),
+                           [&task_source](const TaskSourceAndSortKey& element) {
+                             return element.task_source().get() == &task_source;
+                           });
+    if (it == lane.end())
+      continue;
+    DecrementNumTaskSourcesForPriority(it->sort_key().priority());
+    RegisteredTaskSource registered_task_source = it->take_task_source();
+    lane.erase(it);
+    return registered_task_source;
+  }
+  return nullptr;
+}
+
 void PriorityQueue::DecrementNumTaskSourcesForPriority(TaskPriority priority) {
   DCHECK_GT(num_task_sources_per_priority_[static_cast<int>(priority)], 0U);
   --num_task_sources_per_priority_[static_cast<int>(priority)];
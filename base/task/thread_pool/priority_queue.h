@@ -5,15 +5,18 @@
 #ifndef BASE_TASK_THREAD_POOL_PRIORITY_QUEUE_H_
 #define BASE_TASK_THREAD_POOL_PRIORITY_QUEUE_H_
 
+#include <array>
 #include <functional>
 #include <memory>
 
 #include "base/base_export.h"
+#include "base/containers/circular_deque.h"
 #include "base/containers/intrusive_heap.h"
 #include "base/memory/ref_counted.h"
 #include "base/task/common/checked_lock.h"
 #include "base/task/thread_pool/task_source.h"
 #include "base/task/thread_pool/task_source_sort_key.h"
+#include "third_party/abseil-cpp/absl/types/optional.h"
 
 namespace base {
 namespace internal {
@@ -70,6 +73,14 @@ class BASE_EXPORT PriorityQueue {
     return num_task_sources_per_priority_[static_cast<int>(priority)];
   }
 
+  // Makes this PriorityQueue keep non-job TaskSources without a deadline in one
+  // FIFO lane per TaskPriority instead of in its heap, which makes Push() and
+  // PopTaskSource() constant time for them. Within a priority, lane TaskSources
+  // are popped in the order in which they were pushed. A lane TaskSource whose sort key is
+  // updated moves to the heap. TaskSources already in the PriorityQueue are
+  // moved to lanes as appropriate.
+  void EnablePriorityLanes();
+
   // Set the PriorityQueue to empty all its TaskSources of Tasks when it is
   // destroyed; needed to prevent memory leaks caused by a reference cycle
   // (TaskSource -> Task -> TaskRunner -> TaskSource...) during test teardown.
@@ -81,12 +92,27 @@ class BASE_EXPORT PriorityQueue {
   class TaskSourceAndSortKey;
 
   using ContainerType = IntrusiveHeap<TaskSourceAndSortKey>;
+  using LaneType = circular_deque<TaskSourceAndSortKey>;
+
+  // Returns the index in |priority_lanes_| of the lane whose front is the
+  // highest priority TaskSource in this PriorityQueue, or nullopt if it is the
+  // top of |container_|.
+  absl::optional<size_t> GetTopLane() const;
+
+  // Removes and returns |task_source| from |priority_lanes_|, or nullptr if it
+  // isn't in a lane.
+  RegisteredTaskSource RemoveTaskSourceFromLanes(const TaskSource& task_source);
 
   void DecrementNumTaskSourcesForPriority(TaskPriority priority);
   void IncrementNumTaskSourcesForPriority(TaskPriority priority);
 
   ContainerType container_;
 
+  // FIFO lanes indexed by TaskPriority. Only used after EnablePriorityLanes().
+  std::array<LaneType, static_cast<int>(TaskPriority::HIGHEST) + 1>
+      priority_lanes_;
+  bool use_priority_lanes_ = false;
+
   std::array<size_t, static_cast<int>(TaskPriority::HIGHEST) + 1>
       num_task_sources_per_priority_ = {};
 
@@ -251,5 +251,80 @@ TEST_F(PriorityQueueWithSequencesTest, UpdateSortKey) {
   }
 }
 
+TEST_F(PriorityQueueWithSequencesTest, PriorityLanes) {
+  // |sequence_d| is pushed before lanes are enabled and moves to a lane.
+  Push(sequence_d);
+  pq.EnablePriorityLanes();
+  ExpectNumSequences(1U, 0U, 0U);
+
+  // |sequence_c| is pushed before |sequence_b| even though |sequence_b| has
+  // been ready for longer.
+  Push(sequence_c);
+  Push(sequence_b);
+  Push(sequence_a);
+  EXPECT_EQ(4U, pq.Size());
+  ExpectNumSequences(1U, 1U, 2U);
+
+  // Within a priority, task sources are popped in the order they were pushed.
+  EXPECT_EQ(sort_key_c, pq.PeekSortKey());
+  EXPECT_EQ(sequence_c, pq.PopTaskSource().Unregister());
+  EXPECT_EQ(sequence_b, pq.PopTaskSource().Unregister());
+  EXPECT_EQ(sequence_a, pq.PopTaskSource().Unregister());
+  EXPECT_EQ(sequence_d, pq.PopTaskSource().Unregister());
+  EXPECT_TRUE(pq.IsEmpty());
+  ExpectNumSequences(0U, 0U, 0U);
+}
+
+TEST_F(PriorityQueueWithSequencesTest, EarliestDeadlineFirst) {
+  pq.EnablePriorityLanes();
+  scoped_refptr<TaskSource> late_deadline_sequence =
+      MakeSequenceWithTraitsAndTask(TaskTraits(TaskPriority::USER_VISIBLE,
+                                               TaskDeadline(Milliseconds(20))));
+  scoped_refptr<TaskSource> early_deadline_sequence =
+      MakeSequenceWithTraitsAndTask(TaskTraits(TaskPriority::USER_VISIBLE,
+                                               TaskDeadline(Milliseconds(5))));
+
+  // Task sources with a deadline go in the heap, ahead of the task sources of
+  // the same priority without one, earliest deadline first.
+  Push(sequence_a);
+  Push(late_deadline_sequence);
+  Push(early_deadline_sequence);
+  Push(sequence_b);
+  ExpectNumSequences(0U, 3U, 1U);
+
+  EXPECT_EQ(sequence_b, pq.PopTaskSource().Unregister());
+  EXPECT_EQ(early_deadline_sequence, pq.PopTaskSource().Unregister());
+  EXPECT_EQ(late_deadline_sequence, pq.PopTaskSource().Unregister());
+  EXPECT_EQ(sequence_a, pq.PopTaskSource().Unregister());
+  EXPECT_TRUE(pq.IsEmpty());
+}
+
+TEST_F(PriorityQueueWithSequencesTest, PriorityLanesRemoveAndUpdateSortKey) {
+  pq.EnablePriorityLanes();
+  Push(sequence_a);
+  Push(sequence_b);
+  Push(sequence_c);
+  Push(sequence_d);
+
+  // Remove |sequence_b| from its lane.
+  EXPECT_EQ(sequence_b, pq.RemoveTaskSource(*sequence_b).Unregister());
+  EXPECT_FALSE(pq.RemoveTaskSource(*sequence_b));
+  ExpectNumSequences(1U, 1U, 1U);
+
+  {
+    // Upgrade |sequence_d| from BEST_EFFORT to USER_BLOCKING. It moves to the
+    // heap, where |sequence_c|'s earlier ready time still ranks it first.
+    auto sequence_d_transaction = sequence_d->BeginTransaction();
+    sequence_d_transaction.UpdatePriority(TaskPriority::USER_BLOCKING);
+    pq.UpdateSortKey(*sequence_d, sequence_d->GetSortKey(false));
+    ExpectNumSequences(0U, 1U, 2U);
+  }
+
+  EXPECT_EQ(sequence_c, pq.PopTaskSource().Unregister());
+  EXPECT_EQ(sequence_d, pq.PopTaskSource().Unregister());
+  EXPECT_EQ(sequence_a, pq.PopTaskSource().Unregister());
+  EXPECT_TRUE(pq.IsEmpty());
+}
+
 }  // namespace internal
 }  // namespace base
@@ -45,12 +45,18 @@ void Sequence::Transaction::PushTask(Task task) {
                       TaskShutdownBehavior::BLOCK_SHUTDOWN
                   ? MakeCriticalClosure(task.posted_from, std::move(task.task))
                   : std::move(task.task);
+  if (sequence()->traits_.has_deadline()) {
+    task.deadline = task.GetDesiredExecutionTime() +
+                    sequence()->traits_.deadline_budget();
+  }
 
   if (sequence()->queue_.empty()) {
     sequence()->ready_time_.store(task.GetDesiredExecutionTime(),
                                   std::memory_order_relaxed);
+    sequence()->deadline_.store(task.deadline, std::memory_order_relaxed);
   }
   sequence()->queue_.push(std::move(task));
+  ++sequence()->num_pushed_tasks_;
 
   // AddRef() matched by manual Release() when the sequence has no more tasks
   // to run (in DidProcessTask() or Clear()).
@@ -58,6 +64,34 @@ void Sequence::Transaction::PushTask(Task task) {
     sequence()->task_runner()->AddRef();
 }
 
+bool Sequence::Transaction::IsEmpty() const {
+  return sequence()->queue_.empty();
+}
+
+scoped_refptr<CoalescedTasks> Sequence::Transaction::GetCoalescedTasks() {
+  if (!sequence()->coalesced_tasks_)
+    sequence()->coalesced_tasks_ = MakeRefCounted<CoalescedTasks>();
+  return sequence()->coalesced_tasks_;
+}
+
+OnceClosure Sequence::Transaction::AddToDeletionBatch(
+    DeletionBatch::Deleter deleter,
+    const void* object) {
+  Sequence* const sequence = this->sequence();
+  if (sequence->deletion_batch_ &&
+      sequence->num_pushed_tasks_ ==
+          sequence->deletion_batch_num_pushed_tasks_ &&
+      sequence->deletion_batch_->TryAdd(deleter, object)) {
+    return OnceClosure();
+  }
+  sequence->deletion_batch_ = MakeRefCounted<DeletionBatch>();
+  // The batch's Task is expected to be the next one pushed.
+  sequence->deletion_batch_num_pushed_tasks_ = sequence->num_pushed_tasks_ + 1;
+  const bool added = sequence->deletion_batch_->TryAdd(deleter, object);
+  DCHECK(added);
+  return sequence->deletion_batch_->TakeClosure();
+}
+
 TaskSource::RunStatus Sequence::WillRunTask() {
   // There should never be a second call to WillRunTask() before DidProcessTask
   // since the RunStatus is always marked a saturated.
@@ -86,6 +120,7 @@ Task Sequence::TakeTask(TaskSource::Transaction* transaction) {
   queue_.pop();
   if (!queue_.empty()) {
     ready_time_.store(queue_.front().queue_time, std::memory_order_relaxed);
+    deadline_.store(queue_.front().deadline, std::memory_order_relaxed);
   }
   return next_task;
 }
@@ -109,8 +144,18 @@ bool Sequence::DidProcessTask(TaskSource::Transaction* transaction) {
 
 TaskSourceSortKey Sequence::GetSortKey(
     bool /* disable_fair_scheduling */) const {
-  return TaskSourceSortKey(priority_racy(),
-                           ready_time_.load(std::memory_order_relaxed));
+  TaskPriority priority = priority_racy();
+  const TimeTicks deadline = deadline_.load(std::memory_order_relaxed);
+  // The deadline traits are never mutated, so they can be read without a
+  // Transaction.
+  if (!deadline.is_null() && priority == TaskPriority::USER_VISIBLE &&
+      traits_.deadline_miss_policy() == DeadlineMissPolicy::kPromote &&
+      deadline <= TimeTicks::Now()) {
+    priority = TaskPriority::USER_BLOCKING;
+  }
+  return TaskSourceSortKey(priority,
+                           ready_time_.load(std::memory_order_relaxed),
+                           /*worker_count=*/0, deadline);
 }
 
 Task Sequence::Clear(TaskSource::Transaction* transaction) {
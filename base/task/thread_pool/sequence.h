@@ -6,10 +6,16 @@
 #define BASE_TASK_THREAD_POOL_SEQUENCE_H_
 
 #include <stddef.h>
+#include <stdint.h>
+
+#include <atomic>
 
 #include "base/base_export.h"
 #include "base/containers/queue.h"
+#include "base/memory/scoped_refptr.h"
 #include "base/sequence_token.h"
+#include "base/task/common/coalesced_tasks.h"
+#include "base/task/common/deletion_batch.h"
 #include "base/task/task_traits.h"
 #include "base/task/thread_pool/pooled_parallel_task_runner.h"
 #include "base/task/thread_pool/task.h"
@@ -59,6 +65,22 @@ class BASE_EXPORT Sequence : public TaskSource {
     // called after invoking WillPushTask().
     void PushTask(Task task);
 
+    // Returns true if the Sequence has no queued Task, not counting a Task
+    // currently running.
+    bool IsEmpty() const;
+
+    // Returns the tasks posted to the Sequence with
+    // SequencedTaskRunner::PostCoalescedTask(), created on first use.
+    scoped_refptr<CoalescedTasks> GetCoalescedTasks();
+
+    // Adds the deletion of |object| by |deleter| to the batch of deletions
+    // pushed last to the Sequence, if no other Task was pushed since, and
+    // returns a null closure. Otherwise, returns a closure which runs a new
+    // batch holding that deletion, and which the caller must post to the
+    // Sequence. See SequencedTaskRunner::DeleteSoon().
+    [[nodiscard]] OnceClosure AddToDeletionBatch(DeletionBatch::Deleter deleter,
+                                                 const void* object);
+
     Sequence* sequence() const { return static_cast<Sequence*>(task_source()); }
 
    private:
@@ -95,6 +117,17 @@ class BASE_EXPORT Sequence : public TaskSource {
     return &sequence_local_storage_;
   }
 
+  // The worker which last took this Sequence to run one of its tasks, recorded
+  // by ThreadGroupImpl under kSequenceWorkerAffinity. Only a hint which is
+  // compared to other workers and never dereferenced, since that worker may
+  // have been cleaned up since.
+  void set_last_worker(const void* worker) {
+    last_worker_.store(worker, std::memory_order_relaxed);
+  }
+  const void* last_worker() const {
+    return last_worker_.load(std::memory_order_relaxed);
+  }
+
  private:
   ~Sequence() override;
 
@@ -114,9 +147,31 @@ class BASE_EXPORT Sequence : public TaskSource {
 
   std::atomic<TimeTicks> ready_time_{TimeTicks()};
 
+  // Deadline of the task at the front of |queue_|, if it has one. See
+  // TaskDeadline.
+  std::atomic<TimeTicks> deadline_{TimeTicks()};
+
   // True if a worker is currently associated with a Task from this Sequence.
   bool has_worker_ = false;
 
+  // See set_last_worker().
+  std::atomic<const void*> last_worker_{nullptr};
+
+  // See Transaction::GetCoalescedTasks(). Null until first used, since most
+  // Sequences never get a coalesced task.
+  scoped_refptr<CoalescedTasks> coalesced_tasks_;
+
+  // The number of Tasks pushed to the Sequence, including ripe delayed Tasks.
+  uint64_t num_pushed_tasks_ = 0;
+
+  // See Transaction::AddToDeletionBatch(). |deletion_batch_| accepts deletions
+  // while |num_pushed_tasks_| is |deletion_batch_num_pushed_tasks_|, i.e. while
+  // its Task is the last one pushed. If another Task is pushed between the
+  // batch's creation and its push, deletions added in that window are still
+  // run after that Task, and none are added once the batch is pushed.
+  scoped_refptr<DeletionBatch> deletion_batch_;
+  uint64_t deletion_batch_num_pushed_tasks_ = 0;
+
   // Holds data stored through the SequenceLocalStorageSlot API.
   SequenceLocalStorageMap sequence_local_storage_;
 };
@@ -36,6 +36,10 @@ void ExpectMockTask(MockTask* mock_task, Task* task) {
   testing::Mock::VerifyAndClear(mock_task);
 }
 
+void DeleteInt(const void* object) {
+  delete static_cast<const int*>(object);
+}
+
 }  // namespace
 
 TEST(ThreadPoolSequenceTest, PushTakeRemove) {
@@ -183,6 +187,56 @@ TEST(ThreadPoolSequenceTest, GetSortKeyForeground) {
       &foreground_sequence_transaction);
 }
 
+// Verify that the sort key of a sequence with a TaskDeadline has the deadline of
+// its next task, and that it's promoted once the deadline has passed.
+TEST(ThreadPoolSequenceTest, GetSortKeyDeadline) {
+  const TimeTicks now = TimeTicks::Now();
+  scoped_refptr<Sequence> sequence = MakeRefCounted<Sequence>(
+      TaskTraits(TaskPriority::USER_VISIBLE, TaskDeadline(Hours(1))), nullptr,
+      TaskSourceExecutionMode::kParallel);
+  Sequence::Transaction sequence_transaction(sequence->BeginTransaction());
+  sequence_transaction.PushTask(
+      Task(FROM_HERE, DoNothing(), now - Hours(2), TimeDelta()));
+  sequence_transaction.PushTask(Task(FROM_HERE, DoNothing(), now, TimeDelta()));
+
+  // The deadline of the first task has passed.
+  TaskSourceSortKey sort_key = sequence->GetSortKey();
+  EXPECT_EQ(TaskPriority::USER_BLOCKING, sort_key.priority());
+  EXPECT_EQ(now - Hours(1), sort_key.deadline());
+
+  auto registered_task_source =
+      RegisteredTaskSource::CreateForTesting(sequence);
+  registered_task_source.WillRunTask();
+  Task task = registered_task_source.TakeTask(&sequence_transaction);
+  EXPECT_EQ(now - Hours(1), task.deadline);
+  registered_task_source.DidProcessTask(&sequence_transaction);
+
+  // The deadline of the second task hasn't.
+  sort_key = sequence->GetSortKey();
+  EXPECT_EQ(TaskPriority::USER_VISIBLE, sort_key.priority());
+  EXPECT_EQ(now + Hours(1), sort_key.deadline());
+}
+
+// Verify that the sort key of a sequence whose next task missed its deadline
+// isn't promoted if it's BEST_EFFORT or if the deadline policy is kDrop.
+TEST(ThreadPoolSequenceTest, GetSortKeyDeadlineNotPromoted) {
+  const TimeTicks past = TimeTicks::Now() - Hours(2);
+  for (const TaskTraits& traits :
+       {TaskTraits(TaskPriority::BEST_EFFORT, TaskDeadline(Hours(1))),
+        TaskTraits(TaskPriority::USER_VISIBLE,
+                   TaskDeadline(Hours(1), DeadlineMissPolicy::kDrop))}) {
+    scoped_refptr<Sequence> sequence = MakeRefCounted<Sequence>(
+        traits, nullptr, TaskSourceExecutionMode::kParallel);
+    Sequence::Transaction sequence_transaction(sequence->BeginTransaction());
+    sequence_transaction.PushTask(
+        Task(FROM_HERE, DoNothing(), past, TimeDelta()));
+
+    const TaskSourceSortKey sort_key = sequence->GetSortKey();
+    EXPECT_EQ(traits.priority(), sort_key.priority());
+    EXPECT_EQ(past + Hours(1), sort_key.deadline());
+  }
+}
+
 // Verify that a DCHECK fires if DidProcessTask() is called on a sequence which
 // didn't return a Task.
 TEST(ThreadPoolSequenceTest, DidProcessTaskWithoutWillRunTask) {
@@ -233,5 +287,76 @@ TEST(ThreadPoolSequenceTest, TakeEmptySequence) {
   });
 }
 
+// Verify that deletions are batched only while the batch is the last Task
+// pushed to the sequence.
+TEST(ThreadPoolSequenceTest, AddToDeletionBatch) {
+  testing::StrictMock<MockTask> mock_task;
+  scoped_refptr<Sequence> sequence = MakeRefCounted<Sequence>(
+      TaskTraits(), nullptr, TaskSourceExecutionMode::kParallel);
+  Sequence::Transaction sequence_transaction(sequence->BeginTransaction());
+
+  OnceClosure first_batch =
+      sequence_transaction.AddToDeletionBatch(&DeleteInt, new int(1));
+  ASSERT_TRUE(first_batch);
+  // A Task pushed before the batch doesn't prevent batching, since the batch
+  // is still pushed after it.
+  sequence_transaction.PushTask(CreateTask(&mock_task));
+  EXPECT_FALSE(sequence_transaction.AddToDeletionBatch(&DeleteInt, new int(2)));
+  sequence_transaction.PushTask(
+      Task(FROM_HERE, std::move(first_batch), TimeTicks::Now(), TimeDelta()));
+
+  // The batch isn't known to be the last Task anymore.
+  OnceClosure second_batch =
+      sequence_transaction.AddToDeletionBatch(&DeleteInt, new int(3));
+  ASSERT_TRUE(second_batch);
+  sequence_transaction.PushTask(
+      Task(FROM_HERE, std::move(second_batch), TimeTicks::Now(), TimeDelta()));
+  EXPECT_FALSE(sequence_transaction.AddToDeletionBatch(&DeleteInt, new int(4)));
+
+  // Once another Task is pushed after the batch, a new batch is needed.
+  sequence_transaction.PushTask(CreateTask(&mock_task));
+  OnceClosure third_batch =
+      sequence_transaction.AddToDeletionBatch(&DeleteInt, new int(5));
+  ASSERT_TRUE(third_batch);
+  sequence_transaction.PushTask(
+      Task(FROM_HERE, std::move(third_batch), TimeTicks::Now(), TimeDelta()));
+
+  auto registered_task_source =
+      RegisteredTaskSource::CreateForTesting(sequence);
+  for (bool is_mock_task : {true, false, false, true, false}) {
+    registered_task_source.WillRunTask();
+    absl::optional<Task> task =
+        registered_task_source.TakeTask(&sequence_transaction);
+    if (is_mock_task)
+      ExpectMockTask(&mock_task, &task.value());
+    else
+      std::move(task->task).Run();
+    registered_task_source.DidProcessTask(&sequence_transaction);
+  }
+  EXPECT_TRUE(sequence_transaction.IsEmpty());
+}
+
+// Verify that a batch which ran doesn't accept deletions.
+TEST(ThreadPoolSequenceTest, AddToDeletionBatchAfterRun) {
+  scoped_refptr<Sequence> sequence = MakeRefCounted<Sequence>(
+      TaskTraits(), nullptr, TaskSourceExecutionMode::kParallel);
+  OnceClosure batch =
+      sequence->BeginTransaction().AddToDeletionBatch(&DeleteInt, new int(1));
+  ASSERT_TRUE(batch);
+  sequence->BeginTransaction().PushTask(
+      Task(FROM_HERE, std::move(batch), TimeTicks::Now(), TimeDelta()));
+
+  auto registered_task_source =
+      RegisteredTaskSource::CreateForTesting(sequence);
+  registered_task_source.WillRunTask();
+  absl::optional<Task> task = registered_task_source.TakeTask();
+  std::move(task->task).Run();
+  OnceClosure next_batch =
+      sequence->BeginTransaction().AddToDeletionBatch(&DeleteInt, new int(2));
+  EXPECT_TRUE(next_batch);
+  std::move(next_batch).Run();
+  registered_task_source.DidProcessTask();
+}
+
 }  // namespace internal
 }  // namespace base
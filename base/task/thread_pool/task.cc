@@ -42,7 +42,10 @@ Task::Task(const Location& posted_from,
 
 // This should be "= default but MSVC has trouble with "noexcept = default" in
 // this case.
-Task::Task(Task&& other) noexcept : PendingTask(std::move(other)) {}
+Task::Task(Task&& other) noexcept
+    : PendingTask(std::move(other)),
+      delay_policy(other.delay_policy),
+      deadline(other.deadline) {}
 
 Task& Task::operator=(Task&& other) = default;
 
@@ -10,6 +10,7 @@
 #include "base/location.h"
 #include "base/memory/ref_counted.h"
 #include "base/pending_task.h"
+#include "base/task/delay_policy.h"
 #include "base/task/sequenced_task_runner.h"
 #include "base/task/single_thread_task_runner.h"
 #include "base/time/time.h"
@@ -45,6 +46,14 @@ struct BASE_EXPORT Task : public PendingTask {
   ~Task() = default;
 
   Task& operator=(Task&& other);
+
+  // How strictly |delayed_run_time| must be honored. Only meaningful for a
+  // delayed task.
+  subtle::DelayPolicy delay_policy = subtle::DelayPolicy::kFlexibleNoSooner;
+
+  // The time by which the task should start running, for a task posted with a
+  // TaskDeadline. Set when the task is pushed to its Sequence. Null otherwise.
+  TimeTicks deadline;
 };
 
 }  // namespace internal
@@ -0,0 +1,190 @@
+// Copyright 2022 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "base/task/thread_pool/task_latency_recorder.h"
+
+#include <algorithm>
+
+#include "base/bits.h"
+#include "base/check_op.h"
+#include "base/hash/hash.h"
+
+namespace base {
+namespace internal {
+
+namespace {
+
+// Number of slots visited before giving up on recording a task.
+constexpr size_t kMaxProbes = 8;
+
+enum SlotState : uint32_t {
+  kEmpty,
+  // The slot is being initialized by the thread that claimed it.
+  kClaiming,
+  // The key and Location of the slot are set and won't change.
+  kReady,
+};
+
+size_t GetHistogramBucket(TimeDelta value) {
+  const int64_t microseconds = value.InMicroseconds();
+  if (microseconds <= 0)
+    return 0;
+  const size_t bucket =
+      64 - bits::CountLeadingZeroBits(static_cast<uint64_t>(microseconds));
+  return std::min(bucket, TaskLatencyRecorder::kNumHistogramBuckets - 1);
+}
+
+void UpdateMax(std::atomic<int64_t>& max, int64_t value) {
+  int64_t current = max.load(std::memory_order_relaxed);
+  while (value > current && !max.compare_exchange_weak(
+                                current, value, std::memory_order_relaxed)) {
+  }
+}
+
+}  // namespace
+
+struct TaskLatencyRecorder::Slot {
+  std::atomic<uint32_t> state{kEmpty};
+
+  // Written once by the thread that claims the slot, before |state| is set to
+  // kReady with release semantics.
+  Location posted_from;
+  const void* sequence_id = nullptr;
+
+  // Durations are in microseconds.
+  std::atomic<uint64_t> num_tasks{0};
+  std::atomic<int64_t> total_queueing_delay{0};
+  std::atomic<int64_t> max_queueing_delay{0};
+  std::atomic<int64_t> total_run_duration{0};
+  std::atomic<int64_t> max_run_duration{0};
+  std::array<std::atomic<uint64_t>, kNumHistogramBuckets>
+      queueing_delay_histogram{};
+  std::array<std::atomic<uint64_t>, kNumHistogramBuckets>
+      run_duration_histogram{};
+  std::atomic<uint64_t> num_deadline_misses{0};
+  std::atomic<uint64_t> num_dropped_deadline_misses{0};
+  std::atomic<int64_t> max_deadline_lateness{0};
+};
+
+TaskLatencyRecorder::Entry::Entry() = default;
+TaskLatencyRecorder::Entry::Entry(const Entry& other) = default;
+TaskLatencyRecorder::Entry& TaskLatencyRecorder::Entry::operator=(
+    const Entry& other) = default;
+TaskLatencyRecorder::Entry::~Entry() = default;
+
+TaskLatencyRecorder::TaskLatencyRecorder(size_t capacity)
+    : capacity_(capacity), slots_(std::make_unique<Slot[]>(capacity)) {
+  DCHECK(bits::IsPowerOfTwo(capacity_));
+}
+
+TaskLatencyRecorder::~TaskLatencyRecorder() = default;
+
+void TaskLatencyRecorder::RecordTask(const Location& posted_from,
+                                     const void* sequence_id,
+                                     TimeDelta queueing_delay,
+                                     TimeDelta run_duration) {
+  Slot* slot = FindOrClaimSlot(posted_from, sequence_id);
+  if (!slot) {
+    num_dropped_tasks_.fetch_add(1, std::memory_order_relaxed);
+    return;
+  }
+
+  const int64_t queueing_delay_us = queueing_delay.InMicroseconds();
+  const int64_t run_duration_us = run_duration.InMicroseconds();
+  slot->num_tasks.fetch_add(1, std::memory_order_relaxed);
+  slot->total_queueing_delay.fetch_add(queueing_delay_us,
+                                       std::memory_order_relaxed);
+  slot->total_run_duration.fetch_add(run_duration_us,
+                                     std::memory_order_relaxed);
+  UpdateMax(slot->max_queueing_delay, queueing_delay_us);
+  UpdateMax(slot->max_run_duration, run_duration_us);
+  slot->queueing_delay_histogram[GetHistogramBucket(queueing_delay)].fetch_add(
+      1, std::memory_order_relaxed);
+  slot->run_duration_histogram[GetHistogramBucket(run_duration)].fetch_add(
+      1, std::memory_order_relaxed);
+}
+
+void TaskLatencyRecorder::RecordDeadlineMiss(const Location& posted_from,
+                                             const void* sequence_id,
+                                             TimeDelta lateness,
+                                             bool dropped) {
+  Slot* slot = FindOrClaimSlot(posted_from, sequence_id);
+  if (!slot) {
+    num_dropped_tasks_.fetch_add(1, std::memory_order_relaxed);
+    return;
+  }
+
+  slot->num_deadline_misses.fetch_add(1, std::memory_order_relaxed);
+  if (dropped)
+    slot->num_dropped_deadline_misses.fetch_add(1, std::memory_order_relaxed);
+  UpdateMax(slot->max_deadline_lateness, lateness.InMicroseconds());
+}
+
+std::vector<TaskLatencyRecorder::Entry> TaskLatencyRecorder::GetSnapshot()
+    const {
+  std::vector<Entry> entries;
+  for (size_t i = 0; i < capacity_; ++i) {
+    const Slot& slot = slots_[i];
+    if (slot.state.load(std::memory_order_acquire) != kReady)
+      continue;
+
+    Entry entry;
+    entry.posted_from = slot.posted_from;
+    entry.sequence_id = slot.sequence_id;
+    entry.num_tasks = slot.num_tasks.load(std::memory_order_relaxed);
+    entry.total_queueing_delay = Microseconds(
+        slot.total_queueing_delay.load(std::memory_order_relaxed));
+    entry.max_queueing_delay =
+        Microseconds(slot.max_queueing_delay.load(std::memory_order_relaxed));
+    entry.total_run_duration =
+        Microseconds(slot.total_run_duration.load(std::memory_order_relaxed));
+    entry.max_run_duration =
+        Microseconds(slot.max_run_duration.load(std::memory_order_relaxed));
+    entry.num_deadline_misses =
+        slot.num_deadline_misses.load(std::memory_order_relaxed);
+    entry.num_dropped_deadline_misses =
+        slot.num_dropped_deadline_misses.load(std::memory_order_relaxed);
+    entry.max_deadline_lateness = Microseconds(
+        slot.max_deadline_lateness.load(std::memory_order_relaxed));
+    for (size_t bucket = 0; bucket < kNumHistogramBuckets; ++bucket) {
+      entry.queueing_delay_histogram[bucket] =
+          slot.queueing_delay_histogram[bucket].load(std::memory_order_relaxed);
+      entry.run_duration_histogram[bucket] =
+          slot.run_duration_histogram[bucket].load(std::memory_order_relaxed);
+    }
+    entries.push_back(entry);
+  }
+  return entries;
+}
+
+TaskLatencyRecorder::Slot* TaskLatencyRecorder::FindOrClaimSlot(
+    const Location& posted_from,
+    const void* sequence_id) {
+  const size_t hash =
+      HashInts(reinterpret_cast<uintptr_t>(posted_from.program_counter()),
+               reinterpret_cast<uintptr_t>(sequence_id));
+  for (size_t probe = 0; probe < std::min(kMaxProbes, capacity_); ++probe) {
+    Slot& slot = slots_[(hash + probe) & (capacity_ - 1)];
+    uint32_t state = slot.state.load(std::memory_order_acquire);
+    if (state == kEmpty &&
+        slot.state.compare_exchange_strong(state, kClaiming,
+                                           std::memory_order_acquire)) {
+      slot.posted_from = posted_from;
+      slot.sequence_id = sequence_id;
+      slot.state.store(kReady, std::memory_order_release);
+      return &slot;
+    }
+    // A slot that is being claimed by another thread is skipped rather than
+    // waited for, to keep recording lock-free. This can split a pair across
+    // two slots, which a reader of the snapshot can merge.
+    if (state == kReady && slot.posted_from == posted_from &&
+        slot.sequence_id == sequence_id) {
+      return &slot;
+    }
+  }
+  return nullptr;
+}
+
+}  // namespace internal
+}  // namespace base
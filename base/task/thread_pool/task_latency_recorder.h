@@ -0,0 +1,118 @@
+// Copyright 2022 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#ifndef BASE_TASK_THREAD_POOL_TASK_LATENCY_RECORDER_H_
+#define BASE_TASK_THREAD_POOL_TASK_LATENCY_RECORDER_H_
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include <array>
+#include <atomic>
+#include <memory>
+#include <vector>
+
+#include "base/base_export.h"
+#include "base/location.h"
+#include "base/time/time.h"
+
+namespace base {
+namespace internal {
+
+// Records the queueing delay (desired execution time to start) and the run
+// duration of tasks, bucketed by posting Location and sequence. Recording is
+// lock-free and wait-free except for the rare update of a max value: the first
+// task of a (Location, sequence) pair claims a slot in a fixed-size
+// open-addressing table, after which recording is a handful of relaxed atomic
+// increments. Task pairs that don't find a slot within a few probes are counted
+// in num_dropped_tasks().
+//
+// Values are cumulative since construction; a scraper computes rates by
+// diffing successive snapshots. This class is thread-safe.
+class BASE_EXPORT TaskLatencyRecorder {
+ public:
+  // Bucket |i| of a latency histogram counts values in [2^(i-1), 2^i)
+  // microseconds. Bucket 0 counts values under 1 microsecond and the last
+  // bucket counts all values above the second to last bucket.
+  static constexpr size_t kNumHistogramBuckets = 24;
+  using Histogram = std::array<uint64_t, kNumHistogramBuckets>;
+
+  static constexpr size_t kDefaultCapacity = 1024;
+
+  // Cumulative stats of the tasks posted from a Location to a sequence.
+  struct BASE_EXPORT Entry {
+    Entry();
+    Entry(const Entry& other);
+    Entry& operator=(const Entry& other);
+    ~Entry();
+
+    Location posted_from;
+    // Opaque identifier of the sequence the tasks ran in. Only meant to be
+    // compared with other identifiers; the sequence may no longer exist. Null
+    // for parallel and job tasks, which get a new task source per post.
+    const void* sequence_id = nullptr;
+    uint64_t num_tasks = 0;
+    TimeDelta total_queueing_delay;
+    TimeDelta max_queueing_delay;
+    TimeDelta total_run_duration;
+    TimeDelta max_run_duration;
+    Histogram queueing_delay_histogram{};
+    Histogram run_duration_histogram{};
+    // Tasks posted with a TaskDeadline which started running after it, of
+    // which |num_dropped_deadline_misses| were dropped, and by how much they
+    // missed it at most.
+    uint64_t num_deadline_misses = 0;
+    uint64_t num_dropped_deadline_misses = 0;
+    TimeDelta max_deadline_lateness;
+  };
+
+  // |capacity| is the number of (Location, sequence) pairs that can be
+  // tracked. Must be a power of two.
+  explicit TaskLatencyRecorder(size_t capacity = kDefaultCapacity);
+  TaskLatencyRecorder(const TaskLatencyRecorder&) = delete;
+  TaskLatencyRecorder& operator=(const TaskLatencyRecorder&) = delete;
+  ~TaskLatencyRecorder();
+
+  // Records a task posted from |posted_from| that ran in |sequence_id| after
+  // waiting |queueing_delay| and that ran for |run_duration|.
+  void RecordTask(const Location& posted_from,
+                  const void* sequence_id,
+                  TimeDelta queueing_delay,
+                  TimeDelta run_duration);
+
+  // Records that a task posted from |posted_from| to |sequence_id| started
+  // running |lateness| after its deadline, and whether it was |dropped| rather
+  // than run.
+  void RecordDeadlineMiss(const Location& posted_from,
+                          const void* sequence_id,
+                          TimeDelta lateness,
+                          bool dropped);
+
+  // Returns a copy of the stats of all tracked (Location, sequence) pairs.
+  // Doesn't block recording. Since counters are read individually, fields of
+  // an Entry may be off by the few tasks recorded while it was read.
+  std::vector<Entry> GetSnapshot() const;
+
+  // Returns the number of tasks that weren't recorded because no slot was
+  // available for their (Location, sequence) pair.
+  uint64_t num_dropped_tasks() const {
+    return num_dropped_tasks_.load(std::memory_order_relaxed);
+  }
+
+ private:
+  struct Slot;
+
+  // Returns the slot tracking (|posted_from|, |sequence_id|), claiming one if
+  // needed, or nullptr if none is available.
+  Slot* FindOrClaimSlot(const Location& posted_from, const void* sequence_id);
+
+  const size_t capacity_;
+  const std::unique_ptr<Slot[]> slots_;
+  std::atomic<uint64_t> num_dropped_tasks_{0};
+};
+
+}  // namespace internal
+}  // namespace base
+
+#endif  // BASE_TASK_THREAD_POOL_TASK_LATENCY_RECORDER_H_
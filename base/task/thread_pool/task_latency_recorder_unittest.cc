@@ -0,0 +1,153 @@
+// Copyright 2022 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "base/task/thread_pool/task_latency_recorder.h"
+
+#include <memory>
+#include <vector>
+
+#include "base/location.h"
+#include "base/memory/raw_ptr.h"
+#include "base/threading/simple_thread.h"
+#include "testing/gtest/include/gtest/gtest.h"
+
+namespace base {
+namespace internal {
+
+namespace {
+
+// Locations are compared by program counter, which is all that matters here.
+Location LocationA() {
+  return Location("A", "file_a.cc", 1, reinterpret_cast<const void*>(0x1));
+}
+Location LocationB() {
+  return Location("B", "file_b.cc", 2, reinterpret_cast<const void*>(0x2));
+}
+
+const TaskLatencyRecorder::Entry* FindEntry(
+    const std::vector<TaskLatencyRecorder::Entry>& entries,
+    const Location& posted_from,
+    const void* sequence_id) {
+  for (const auto& entry : entries) {
+    if (entry.posted_from == posted_from && entry.sequence_id == sequence_id)
+      return &entry;
+  }
+  return nullptr;
+}
+
+class RecordingThread : public SimpleThread {
+ public:
+  RecordingThread(TaskLatencyRecorder* recorder, int num_tasks)
+      : SimpleThread("RecordingThread"),
+        recorder_(recorder),
+        num_tasks_(num_tasks) {}
+  RecordingThread(const RecordingThread&) = delete;
+  RecordingThread& operator=(const RecordingThread&) = delete;
+
+  void Run() override {
+    for (int i = 0; i < num_tasks_; ++i)
+      recorder_->RecordTask(LocationA(), nullptr, Microseconds(1),
+                            Microseconds(1));
+  }
+
+ private:
+  const raw_ptr<TaskLatencyRecorder> recorder_;
+  const int num_tasks_;
+};
+
+}  // namespace
+
+TEST(ThreadPoolTaskLatencyRecorderTest, RecordAndSnapshot) {
+  TaskLatencyRecorder recorder;
+  EXPECT_TRUE(recorder.GetSnapshot().empty());
+
+  int sequence = 0;
+  recorder.RecordTask(LocationA(), &sequence, Microseconds(3), TimeDelta());
+  recorder.RecordTask(LocationA(), &sequence, Microseconds(5),
+                      Milliseconds(10));
+  recorder.RecordTask(LocationA(), nullptr, TimeDelta(), TimeDelta());
+  recorder.RecordTask(LocationB(), &sequence, Seconds(100), TimeDelta());
+
+  const std::vector<TaskLatencyRecorder::Entry> entries =
+      recorder.GetSnapshot();
+  EXPECT_EQ(entries.size(), 3U);
+
+  const TaskLatencyRecorder::Entry* entry =
+      FindEntry(entries, LocationA(), &sequence);
+  ASSERT_TRUE(entry);
+  EXPECT_EQ(entry->num_tasks, 2U);
+  EXPECT_EQ(entry->total_queueing_delay, Microseconds(8));
+  EXPECT_EQ(entry->max_queueing_delay, Microseconds(5));
+  EXPECT_EQ(entry->total_run_duration, Milliseconds(10));
+  EXPECT_EQ(entry->max_run_duration, Milliseconds(10));
+  // 3us and 5us are in [2, 4) and [4, 8) respectively.
+  EXPECT_EQ(entry->queueing_delay_histogram[2], 1U);
+  EXPECT_EQ(entry->queueing_delay_histogram[3], 1U);
+  EXPECT_EQ(entry->run_duration_histogram[0], 1U);
+
+  entry = FindEntry(entries, LocationA(), nullptr);
+  ASSERT_TRUE(entry);
+  EXPECT_EQ(entry->num_tasks, 1U);
+  EXPECT_EQ(entry->queueing_delay_histogram[0], 1U);
+
+  // Values beyond the last bucket are counted in the last bucket.
+  entry = FindEntry(entries, LocationB(), &sequence);
+  ASSERT_TRUE(entry);
+  constexpr size_t kLastBucket = TaskLatencyRecorder::kNumHistogramBuckets - 1;
+  EXPECT_EQ(entry->queueing_delay_histogram[kLastBucket], 1U);
+  EXPECT_EQ(recorder.num_dropped_tasks(), 0U);
+}
+
+TEST(ThreadPoolTaskLatencyRecorderTest, RecordDeadlineMiss) {
+  TaskLatencyRecorder recorder;
+  recorder.RecordTask(LocationA(), nullptr, Microseconds(10), Microseconds(5));
+  recorder.RecordDeadlineMiss(LocationA(), nullptr, Milliseconds(3),
+                              /*dropped=*/false);
+  recorder.RecordDeadlineMiss(LocationA(), nullptr, Milliseconds(1),
+                              /*dropped=*/true);
+
+  const std::vector<TaskLatencyRecorder::Entry> entries =
+      recorder.GetSnapshot();
+  ASSERT_EQ(entries.size(), 1U);
+  EXPECT_EQ(entries[0].num_tasks, 1U);
+  EXPECT_EQ(entries[0].num_deadline_misses, 2U);
+  EXPECT_EQ(entries[0].num_dropped_deadline_misses, 1U);
+  EXPECT_EQ(entries[0].max_deadline_lateness, Milliseconds(3));
+}
+
+TEST(ThreadPoolTaskLatencyRecorderTest, DropsTasksWhenFull) {
+  TaskLatencyRecorder recorder(/*capacity=*/2);
+  int sequences[3];
+  for (int& sequence : sequences)
+    recorder.RecordTask(LocationA(), &sequence, TimeDelta(), TimeDelta());
+  EXPECT_EQ(recorder.GetSnapshot().size(), 2U);
+  EXPECT_EQ(recorder.num_dropped_tasks(), 1U);
+}
+
+// Verify that no task is lost when many threads record concurrently.
+TEST(ThreadPoolTaskLatencyRecorderTest, ConcurrentRecord) {
+  constexpr int kNumThreads = 4;
+  constexpr int kNumTasksPerThread = 10000;
+  TaskLatencyRecorder recorder;
+
+  std::vector<std::unique_ptr<RecordingThread>> threads;
+  for (int i = 0; i < kNumThreads; ++i) {
+    threads.push_back(
+        std::make_unique<RecordingThread>(&recorder, kNumTasksPerThread));
+    threads.back()->Start();
+  }
+  for (auto& thread : threads)
+    thread->Join();
+
+  // Racing claims may split the pair across slots; merge them.
+  uint64_t num_tasks = 0;
+  for (const auto& entry : recorder.GetSnapshot()) {
+    EXPECT_EQ(entry.posted_from, LocationA());
+    num_tasks += entry.num_tasks;
+  }
+  EXPECT_EQ(num_tasks, static_cast<uint64_t>(kNumThreads * kNumTasksPerThread));
+}
+
+}  // namespace internal
+}  // namespace base
@@ -99,6 +99,26 @@ scoped_refptr<TaskSource> RegisteredTaskSource::Unregister() {
   return std::move(task_source_);
 }
 
+TaskSource* RegisteredTaskSource::ReleaseWithoutUnregistering() {
+#if DCHECK_IS_ON()
+  DCHECK_EQ(run_step_, State::kInitial);
+#endif  // DCHECK_IS_ON()
+  DCHECK(task_source_);
+  task_tracker_ = nullptr;
+  return task_source_.release();
+}
+
+// static
+RegisteredTaskSource RegisteredTaskSource::AdoptReleased(
+    TaskSource* task_source,
+    TaskTracker* task_tracker) {
+  DCHECK(task_source);
+  // Take over the reference released by ReleaseWithoutUnregistering().
+  scoped_refptr<TaskSource> adopted(task_source);
+  task_source->Release();
+  return RegisteredTaskSource(std::move(adopted), task_tracker);
+}
+
 RegisteredTaskSource& RegisteredTaskSource::operator=(
     RegisteredTaskSource&& other) {
   Unregister();
@@ -167,6 +167,9 @@ class BASE_EXPORT TaskSource : public RefCountedThreadSafe<TaskSource> {
   // Returns the thread policy of the TaskSource. Can be accessed without a
   // Transaction because it is never mutated.
   ThreadPolicy thread_policy() const { return traits_.thread_policy(); }
+  // Returns true if the Tasks in the TaskSource have a deadline. Can be
+  // accessed without a Transaction because it is never mutated.
+  bool has_deadline() const { return traits_.has_deadline(); }
 
   // A reference to TaskRunner is only retained between PushTask() and when
   // DidProcessTask() returns false, guaranteeing it is safe to dereference this
@@ -252,6 +255,18 @@ class BASE_EXPORT RegisteredTaskSource {
   // https://crbug.com/783309
   scoped_refptr<TaskSource> Unregister();
 
+  // Can only be called if this RegisteredTaskSource is in its initial state.
+  // Releases the underlying task source without unregistering it, so that it
+  // can be stored in a container of raw pointers (e.g. a lock-free queue). The
+  // returned pointer carries both the reference and the registration held by
+  // this object, which must be reclaimed with AdoptReleased().
+  [[nodiscard]] TaskSource* ReleaseWithoutUnregistering();
+
+  // Reclaims a |task_source| returned by ReleaseWithoutUnregistering().
+  // |task_tracker| must be the TaskTracker with which it was registered.
+  static RegisteredTaskSource AdoptReleased(TaskSource* task_source,
+                                            TaskTracker* task_tracker);
+
   // Informs this TaskSource that the current worker would like to run a Task
   // from it. Can only be called if in its initial state. Returns a RunStatus
   // that indicates if the operation is allowed (TakeTask() can be called).
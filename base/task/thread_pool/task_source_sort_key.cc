@@ -7,26 +7,36 @@
 namespace base {
 namespace internal {
 
-static_assert(sizeof(TaskSourceSortKey) <= 2 * sizeof(uint64_t),
+static_assert(sizeof(TaskSourceSortKey) <= 3 * sizeof(uint64_t),
               "Members in TaskSourceSortKey should be ordered to be compact.");
 
 TaskSourceSortKey::TaskSourceSortKey(TaskPriority priority,
                                      TimeTicks ready_time,
-                                     uint8_t worker_count)
+                                     uint8_t worker_count,
+                                     TimeTicks deadline)
     : priority_(priority),
       worker_count_(worker_count),
-      ready_time_(ready_time) {}
+      ready_time_(ready_time),
+      deadline_(deadline) {}
 
 bool TaskSourceSortKey::operator<(const TaskSourceSortKey& other) const {
   // This TaskSourceSortKey is considered more important than |other| if it has
-  // a higher priority or if it has the same priority but fewer workers, or if
-  // it has the same priority and same worker count but its next task was
-  // posted sooner than |other|'s.
+  // a higher priority or if it has the same priority but an earlier deadline,
+  // or if it has the same priority and deadline but fewer workers, or if it has
+  // the same priority, deadline and worker count but its next task was posted
+  // sooner than |other|'s.
 
   // A lower priority is considered less important.
   if (priority_ != other.priority_)
     return priority_ < other.priority_;
 
+  // No deadline, then a later deadline, is considered less important.
+  if (deadline_ != other.deadline_) {
+    if (deadline_.is_null() || other.deadline_.is_null())
+      return deadline_.is_null();
+    return deadline_ > other.deadline_;
+  }
+
   // A greater worker count is considered less important.
   if (worker_count_ != other.worker_count_)
     return worker_count_ > other.worker_count_;
@@ -18,11 +18,13 @@ class BASE_EXPORT TaskSourceSortKey final {
   TaskSourceSortKey() = default;
   TaskSourceSortKey(TaskPriority priority,
                     TimeTicks ready_time,
-                    uint8_t worker_count = 0);
+                    uint8_t worker_count = 0,
+                    TimeTicks deadline = TimeTicks());
 
   TaskPriority priority() const { return priority_; }
   uint8_t worker_count() const { return worker_count_; }
   TimeTicks ready_time() const { return ready_time_; }
+  TimeTicks deadline() const { return deadline_; }
 
   // Used for a max-heap.
   bool operator<(const TaskSourceSortKey& other) const;
@@ -30,7 +32,7 @@ class BASE_EXPORT TaskSourceSortKey final {
   bool operator==(const TaskSourceSortKey& other) const {
     return priority_ == other.priority_ &&
            worker_count_ == other.worker_count_ &&
-           ready_time_ == other.ready_time_;
+           ready_time_ == other.ready_time_ && deadline_ == other.deadline_;
   }
   bool operator!=(const TaskSourceSortKey& other) const {
     return !(other == *this);
@@ -51,6 +53,11 @@ class BASE_EXPORT TaskSourceSortKey final {
   // Time since the task source has been ready to run upcoming work, used as
   // secondary sort key after |worker_count| prioritizing older task sources.
   TimeTicks ready_time_;
+
+  // Deadline of the next task of the task source (see TaskDeadline), or null if
+  // it has none. Used as secondary sort key prioritizing task sources with a
+  // deadline, earliest deadline first.
+  TimeTicks deadline_;
 };
 
 }  // namespace internal
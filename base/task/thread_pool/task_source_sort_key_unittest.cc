@@ -22,6 +22,10 @@ const TaskSourceSortKey kTestKeys[] = {
     {TaskPriority::USER_VISIBLE, TimeTicks() + Seconds(1000), 1},
     {TaskPriority::USER_VISIBLE, TimeTicks() + Seconds(2000)},
     {TaskPriority::USER_VISIBLE, TimeTicks() + Seconds(1000)},
+    {TaskPriority::USER_VISIBLE, TimeTicks() + Seconds(1000), 0,
+     TimeTicks() + Seconds(3000)},
+    {TaskPriority::USER_VISIBLE, TimeTicks() + Seconds(2000), 0,
+     TimeTicks() + Seconds(2500)},
     {TaskPriority::USER_BLOCKING, TimeTicks() + Seconds(2000)},
     {TaskPriority::USER_BLOCKING, TimeTicks() + Seconds(1000)},
 };
@@ -9,6 +9,7 @@
 #include <utility>
 
 #include "base/base_switches.h"
+#include "base/bind.h"
 #include "base/callback.h"
 #include "base/command_line.h"
 #include "base/compiler_specific.h"
@@ -23,6 +24,7 @@
 #include "base/task/scoped_set_task_priority_for_current_thread.h"
 #include "base/task/task_executor.h"
 #include "base/threading/sequence_local_storage_map.h"
+#include "base/threading/hang_watcher.h"
 #include "base/threading/sequenced_task_runner_handle.h"
 #include "base/threading/thread_restrictions.h"
 #include "base/threading/thread_task_runner_handle.h"
@@ -196,6 +198,17 @@ auto EmitThreadPoolTraceEventMetadata(perfetto::EventContext& ctx,
 #endif  //  BUILDFLAG(ENABLE_BASE_TRACING)
 }
 
+// Returns the identifier of the sequence of |task_source| for the
+// TaskLatencyRecorder. Parallel and job task sources aren't reused across
+// posts, so they are bucketed by Location only.
+const void* GetLatencySequenceId(const TaskSource* task_source) {
+  return task_source->execution_mode() == TaskSourceExecutionMode::kSequenced ||
+                 task_source->execution_mode() ==
+                     TaskSourceExecutionMode::kSingleThread
+             ? task_source
+             : nullptr;
+}
+
 }  // namespace
 
 // Atomic internal state used by TaskTracker to track items that are blocking
@@ -466,8 +479,15 @@ RegisteredTaskSource TaskTracker::RunAndPopNextTask(
   if (task) {
     if (posted_from)
       *posted_from = task->posted_from;
+    if (should_run_tasks && !task->deadline.is_null())
+      HandleDeadlineMiss(task.value(), task_source.get(), traits);
     // Run the |task| (whether it's a worker task or the Clear() closure).
-    RunTask(std::move(task.value()), task_source.get(), traits);
+    if (latency_recorder_) {
+      RunTaskAndRecordLatency(std::move(task.value()), task_source.get(),
+                              traits);
+    } else {
+      RunTask(std::move(task.value()), task_source.get(), traits);
+    }
   }
   if (should_run_tasks)
     AfterRunTask(task_source->shutdown_behavior());
@@ -478,6 +498,11 @@ RegisteredTaskSource TaskTracker::RunAndPopNextTask(
   return nullptr;
 }
 
+void TaskTracker::EnableLatencyRecording() {
+  DCHECK(!latency_recorder_);
+  latency_recorder_ = std::make_unique<TaskLatencyRecorder>();
+}
+
 bool TaskTracker::HasShutdownStarted() const {
   return state_->HasShutdownStarted();
 }
@@ -549,6 +574,15 @@ void TaskTracker::RunTask(Task task,
         break;
     }
 
+    // Watch the task for hangs with the threshold of its traits. This scope is
+    // nested in the one of the WorkerThread, and does nothing on the threads
+    // that aren't watched.
+    absl::optional<WatchHangsInScope> hang_watch_scope;
+    if (HangWatcher::IsThreadPoolHangWatchingEnabled()) {
+      hang_watch_scope.emplace(
+          WatchHangsInScope::GetDeadlineClassForTaskTraits(traits));
+    }
+
     RunTaskWithShutdownBehavior(task, traits, task_source, environment.token);
 
     // Make sure the arguments bound to the callback are deleted within the
@@ -557,6 +591,48 @@ void TaskTracker::RunTask(Task task,
   }
 }
 
+void TaskTracker::RunTaskAndRecordLatency(Task task,
+                                          TaskSource* task_source,
+                                          const TaskTraits& traits) {
+  DCHECK(latency_recorder_);
+
+  const Location posted_from = task.posted_from;
+  const TimeTicks desired_run_time = task.GetDesiredExecutionTime();
+  const void* sequence_id = GetLatencySequenceId(task_source);
+
+  const TimeTicks start_time = TimeTicks::Now();
+  RunTask(std::move(task), task_source, traits);
+  const TimeTicks end_time = TimeTicks::Now();
+
+  latency_recorder_->RecordTask(
+      posted_from, sequence_id,
+      desired_run_time.is_null() ? TimeDelta() : start_time - desired_run_time,
+      end_time - start_time);
+}
+
+void TaskTracker::HandleDeadlineMiss(Task& task,
+                                     TaskSource* task_source,
+                                     const TaskTraits& traits) {
+  const TimeTicks now = TimeTicks::Now();
+  if (now <= task.deadline)
+    return;
+
+  const bool drop = traits.deadline_miss_policy() == DeadlineMissPolicy::kDrop;
+  num_deadline_misses_.fetch_add(1, std::memory_order_relaxed);
+  if (drop)
+    num_dropped_deadline_misses_.fetch_add(1, std::memory_order_relaxed);
+  if (latency_recorder_) {
+    latency_recorder_->RecordDeadlineMiss(task.posted_from,
+                                          GetLatencySequenceId(task_source),
+                                          now - task.deadline, drop);
+  }
+
+  // The task still goes through RunTask(), so that the arguments bound to it
+  // are deleted in the scope in which it would have run.
+  if (drop)
+    task.task = BindOnce([](OnceClosure) {}, std::move(task.task));
+}
+
 void TaskTracker::BeginCompleteShutdown(base::WaitableEvent& shutdown_event) {
   // Do nothing in production, tests may override this.
 }
@@ -23,6 +23,7 @@
 #include "base/task/common/task_annotator.h"
 #include "base/task/task_traits.h"
 #include "base/task/thread_pool/task.h"
+#include "base/task/thread_pool/task_latency_recorder.h"
 #include "base/task/thread_pool/task_source.h"
 #include "base/task/thread_pool/tracked_ref.h"
 #include "base/thread_annotations.h"
@@ -123,6 +124,27 @@ class BASE_EXPORT TaskTracker {
   RegisteredTaskSource RunAndPopNextTask(RegisteredTaskSource task_source,
                                          base::Location* posted_from = nullptr);
 
+  // Starts recording the queueing delay and run duration of every task run by
+  // this TaskTracker, bucketed by posting Location and sequence. Can only be
+  // called once, before any task runs (e.g. before the ThreadPool is started).
+  void EnableLatencyRecording();
+
+  // Returns the recorder enabled by EnableLatencyRecording(), or nullptr if it
+  // wasn't called. Thread-safe.
+  const TaskLatencyRecorder* latency_recorder() const {
+    return latency_recorder_.get();
+  }
+
+  // Returns the number of tasks posted with a TaskDeadline which started
+  // running after it, and how many of those were dropped per their
+  // DeadlineMissPolicy. Thread-safe.
+  uint64_t num_deadline_misses() const {
+    return num_deadline_misses_.load(std::memory_order_relaxed);
+  }
+  uint64_t num_dropped_deadline_misses() const {
+    return num_dropped_deadline_misses_.load(std::memory_order_relaxed);
+  }
+
   // Returns true once shutdown has started (StartShutdown() was called).
   // Note: sequential consistency with the thread calling StartShutdown() isn't
   // guaranteed by this call.
@@ -165,6 +187,18 @@ class BASE_EXPORT TaskTracker {
 
   void PerformShutdown();
 
+  // Runs |task| with RunTask() and records its latency in |latency_recorder_|.
+  void RunTaskAndRecordLatency(Task task,
+                               TaskSource* task_source,
+                               const TaskTraits& traits);
+
+  // Records a deadline miss if |task|, which has a deadline, is about to start
+  // running after it. Replaces the closure of |task| by one which only deletes
+  // it if the DeadlineMissPolicy of |traits| is kDrop.
+  void HandleDeadlineMiss(Task& task,
+                          TaskSource* task_source,
+                          const TaskTraits& traits);
+
   // Called before WillPostTask() informs the tracing system that a task has
   // been posted. Updates |num_items_blocking_shutdown_| if necessary and
   // returns true if the current shutdown state allows the task to be posted.
@@ -241,6 +275,13 @@ class BASE_EXPORT TaskTracker {
   // visible when FlushForTesting() returns.
   std::atomic_int num_incomplete_task_sources_{0};
 
+  // Set by EnableLatencyRecording() before any task runs and never modified
+  // afterwards.
+  std::unique_ptr<TaskLatencyRecorder> latency_recorder_;
+
+  std::atomic<uint64_t> num_deadline_misses_{0};
+  std::atomic<uint64_t> num_dropped_deadline_misses_{0};
+
   // Global policy the determines result of CanRunPriority().
   std::atomic<CanRunPolicy> can_run_policy_;
 
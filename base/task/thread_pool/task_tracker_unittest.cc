@@ -967,6 +967,42 @@ TEST_F(ThreadPoolTaskTrackerTest, CurrentSequenceToken) {
   EXPECT_FALSE(SequenceToken::GetForCurrentThread().IsValid());
 }
 
+// Verify that a task which starts running after its deadline is counted as a
+// deadline miss, per posting Location, and dropped iff its policy is kDrop.
+TEST_F(ThreadPoolTaskTrackerTest, DeadlineMiss) {
+  tracker_.EnableLatencyRecording();
+  const TimeTicks past = TimeTicks::Now() - Hours(2);
+
+  for (const DeadlineMissPolicy miss_policy :
+       {DeadlineMissPolicy::kPromote, DeadlineMissPolicy::kDrop}) {
+    for (const TimeTicks queue_time : {past, TimeTicks::Now()}) {
+      scoped_refptr<Sequence> sequence = MakeRefCounted<Sequence>(
+          TaskTraits(TaskDeadline(Hours(1), miss_policy)), nullptr,
+          TaskSourceExecutionMode::kParallel);
+      bool did_run = false;
+      Task task(FROM_HERE,
+                BindOnce([](bool* did_run) { *did_run = true; }, &did_run),
+                queue_time, TimeDelta());
+      EXPECT_TRUE(tracker_.WillPostTask(&task, sequence->shutdown_behavior()));
+      sequence->BeginTransaction().PushTask(std::move(task));
+      test::QueueAndRunTaskSource(&tracker_, std::move(sequence));
+
+      EXPECT_EQ(did_run, miss_policy == DeadlineMissPolicy::kPromote ||
+                             queue_time != past);
+    }
+  }
+
+  EXPECT_EQ(2U, tracker_.num_deadline_misses());
+  EXPECT_EQ(1U, tracker_.num_dropped_deadline_misses());
+  const std::vector<TaskLatencyRecorder::Entry> entries =
+      tracker_.latency_recorder()->GetSnapshot();
+  ASSERT_EQ(1U, entries.size());
+  EXPECT_EQ(4U, entries[0].num_tasks);
+  EXPECT_EQ(2U, entries[0].num_deadline_misses);
+  EXPECT_EQ(1U, entries[0].num_dropped_deadline_misses);
+  EXPECT_GE(entries[0].max_deadline_lateness, Hours(1));
+}
+
 TEST_F(ThreadPoolTaskTrackerTest, LoadWillPostAndRunBeforeShutdown) {
   // Post and run tasks asynchronously.
   std::vector<std::unique_ptr<ThreadPostingAndRunningTask>> threads;
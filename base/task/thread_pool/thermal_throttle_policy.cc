@@ -0,0 +1,82 @@
+// Copyright 2022 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "base/task/thread_pool/thermal_throttle_policy.h"
+
+#include <algorithm>
+
+#include "base/check_op.h"
+
+namespace base {
+namespace internal {
+
+ThermalThrottlePolicy::ThermalThrottlePolicy(size_t max_best_effort_tasks)
+    : max_best_effort_tasks_(max_best_effort_tasks) {}
+
+ThermalThrottlePolicy::~ThermalThrottlePolicy() = default;
+
+bool ThermalThrottlePolicy::OnThermalStateChange(DeviceThermalState state,
+                                                 TimeTicks now) {
+  thermal_state_ = state;
+  return Update(now);
+}
+
+bool ThermalThrottlePolicy::OnSpeedLimitChange(int speed_limit,
+                                               TimeTicks now) {
+  speed_limit_ =
+      std::clamp(speed_limit, 0, PowerThermalObserver::kSpeedLimitMax);
+  return Update(now);
+}
+
+TimeDelta ThermalThrottlePolicy::GetThrottledTime(TimeTicks now) const {
+  if (throttled_since_.is_null())
+    return past_throttled_time_;
+  return past_throttled_time_ + (now - throttled_since_);
+}
+
+bool ThermalThrottlePolicy::Update(TimeTicks now) {
+  size_t num_throttled_tasks = 0;
+  switch (thermal_state_) {
+    case DeviceThermalState::kUnknown:
+    case DeviceThermalState::kNominal:
+    case DeviceThermalState::kFair:
+      break;
+    case DeviceThermalState::kSerious:
+      num_throttled_tasks = max_best_effort_tasks_ / 2;
+      break;
+    case DeviceThermalState::kCritical:
+      num_throttled_tasks = max_best_effort_tasks_;
+      break;
+  }
+  num_throttled_tasks = std::max(
+      num_throttled_tasks,
+      max_best_effort_tasks_ *
+          static_cast<size_t>(PowerThermalObserver::kSpeedLimitMax -
+                              speed_limit_) /
+          PowerThermalObserver::kSpeedLimitMax);
+  // Keep one BEST_EFFORT task running.
+  if (max_best_effort_tasks_ > 0) {
+    num_throttled_tasks =
+        std::min(num_throttled_tasks, max_best_effort_tasks_ - 1);
+  }
+
+  if (num_throttled_tasks == num_throttled_tasks_)
+    return false;
+
+  const bool was_throttled = is_throttled();
+  num_throttled_tasks_ = num_throttled_tasks;
+  if (!was_throttled) {
+    DCHECK(throttled_since_.is_null());
+    throttled_since_ = now;
+  } else if (!is_throttled()) {
+    DCHECK(!throttled_since_.is_null());
+    last_throttled_duration_ = now - throttled_since_;
+    past_throttled_time_ += last_throttled_duration_;
+    throttled_since_ = TimeTicks();
+  }
+  return true;
+}
+
+}  // namespace internal
+}  // namespace base
@@ -0,0 +1,75 @@
+// Copyright 2022 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#ifndef BASE_TASK_THREAD_POOL_THERMAL_THROTTLE_POLICY_H_
+#define BASE_TASK_THREAD_POOL_THERMAL_THROTTLE_POLICY_H_
+
+#include <stddef.h>
+
+#include "base/base_export.h"
+#include "base/power_monitor/power_observer.h"
+#include "base/time/time.h"
+
+namespace base {
+namespace internal {
+
+// Decides how many of the BEST_EFFORT tasks of the thread pool are held back
+// while the device is hot, from what PowerThermalObserver reports:
+// - a kSerious thermal state holds back half of them, and a kCritical one all
+//   but one,
+// - a speed limit holds back the same share of them as it takes from the CPUs,
+// and the strictest of the two applies. At least one BEST_EFFORT task can
+// always run, so that BEST_EFFORT work keeps making progress. Also accounts
+// for the time spent throttled.
+//
+// This class isn't thread-safe.
+class BASE_EXPORT ThermalThrottlePolicy {
+ public:
+  using DeviceThermalState = PowerThermalObserver::DeviceThermalState;
+
+  // |max_best_effort_tasks| is the number of BEST_EFFORT tasks that can run
+  // concurrently when the device isn't throttled.
+  explicit ThermalThrottlePolicy(size_t max_best_effort_tasks);
+  ThermalThrottlePolicy(const ThermalThrottlePolicy&) = delete;
+  ThermalThrottlePolicy& operator=(const ThermalThrottlePolicy&) = delete;
+  ~ThermalThrottlePolicy();
+
+  // Record the new signal at |now|. Return true if num_throttled_tasks()
+  // changed.
+  bool OnThermalStateChange(DeviceThermalState state, TimeTicks now);
+  bool OnSpeedLimitChange(int speed_limit, TimeTicks now);
+
+  // The number of BEST_EFFORT tasks to hold back.
+  size_t num_throttled_tasks() const { return num_throttled_tasks_; }
+  bool is_throttled() const { return num_throttled_tasks_ > 0; }
+
+  // The time spent throttled so far, including the ongoing throttling, if any.
+  TimeDelta GetThrottledTime(TimeTicks now) const;
+
+  // How long the last throttling that ended lasted.
+  TimeDelta last_throttled_duration() const {
+    return last_throttled_duration_;
+  }
+
+ private:
+  // Recomputes |num_throttled_tasks_| from the signals. Returns true if it
+  // changed.
+  bool Update(TimeTicks now);
+
+  const size_t max_best_effort_tasks_;
+  DeviceThermalState thermal_state_ = DeviceThermalState::kUnknown;
+  int speed_limit_ = PowerThermalObserver::kSpeedLimitMax;
+  size_t num_throttled_tasks_ = 0;
+
+  // When the ongoing throttling started, or null if there is none.
+  TimeTicks throttled_since_;
+  // The time spent throttled before |throttled_since_|.
+  TimeDelta past_throttled_time_;
+  TimeDelta last_throttled_duration_;
+};
+
+}  // namespace internal
+}  // namespace base
+
+#endif  // BASE_TASK_THREAD_POOL_THERMAL_THROTTLE_POLICY_H_
@@ -0,0 +1,99 @@
+// Copyright 2022 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "base/task/thread_pool/thermal_throttle_policy.h"
+
+#include "base/time/time.h"
+#include "testing/gtest/include/gtest/gtest.h"
+
+namespace base {
+namespace internal {
+
+using DeviceThermalState = ThermalThrottlePolicy::DeviceThermalState;
+
+TEST(ThermalThrottlePolicyTest, ThermalState) {
+  const TimeTicks now = TimeTicks::Now();
+  ThermalThrottlePolicy policy(4);
+  EXPECT_FALSE(policy.is_throttled());
+
+  EXPECT_FALSE(policy.OnThermalStateChange(DeviceThermalState::kFair, now));
+  EXPECT_EQ(0u, policy.num_throttled_tasks());
+
+  EXPECT_TRUE(policy.OnThermalStateChange(DeviceThermalState::kSerious, now));
+  EXPECT_EQ(2u, policy.num_throttled_tasks());
+  EXPECT_TRUE(policy.is_throttled());
+
+  EXPECT_FALSE(policy.OnThermalStateChange(DeviceThermalState::kSerious, now));
+
+  // One BEST_EFFORT task keeps running.
+  EXPECT_TRUE(policy.OnThermalStateChange(DeviceThermalState::kCritical, now));
+  EXPECT_EQ(3u, policy.num_throttled_tasks());
+
+  EXPECT_TRUE(policy.OnThermalStateChange(DeviceThermalState::kNominal, now));
+  EXPECT_EQ(0u, policy.num_throttled_tasks());
+  EXPECT_FALSE(policy.is_throttled());
+}
+
+TEST(ThermalThrottlePolicyTest, SpeedLimit) {
+  const TimeTicks now = TimeTicks::Now();
+  ThermalThrottlePolicy policy(4);
+
+  EXPECT_FALSE(policy.OnSpeedLimitChange(80, now));
+  EXPECT_EQ(0u, policy.num_throttled_tasks());
+
+  EXPECT_TRUE(policy.OnSpeedLimitChange(50, now));
+  EXPECT_EQ(2u, policy.num_throttled_tasks());
+
+  EXPECT_TRUE(policy.OnSpeedLimitChange(0, now));
+  EXPECT_EQ(3u, policy.num_throttled_tasks());
+
+  // The strictest signal applies.
+  EXPECT_TRUE(policy.OnSpeedLimitChange(70, now));
+  EXPECT_EQ(1u, policy.num_throttled_tasks());
+  EXPECT_TRUE(policy.OnThermalStateChange(DeviceThermalState::kSerious, now));
+  EXPECT_EQ(2u, policy.num_throttled_tasks());
+  EXPECT_TRUE(policy.OnThermalStateChange(DeviceThermalState::kFair, now));
+  EXPECT_EQ(1u, policy.num_throttled_tasks());
+
+  EXPECT_TRUE(policy.OnSpeedLimitChange(
+      PowerThermalObserver::kSpeedLimitMax, now));
+  EXPECT_FALSE(policy.is_throttled());
+}
+
+TEST(ThermalThrottlePolicyTest, SingleBestEffortTask) {
+  const TimeTicks now = TimeTicks::Now();
+  ThermalThrottlePolicy policy(1);
+  EXPECT_FALSE(policy.OnThermalStateChange(DeviceThermalState::kCritical, now));
+  EXPECT_FALSE(policy.OnSpeedLimitChange(0, now));
+  EXPECT_FALSE(policy.is_throttled());
+}
+
+TEST(ThermalThrottlePolicyTest, ThrottledTime) {
+  const TimeTicks start = TimeTicks::Now();
+  ThermalThrottlePolicy policy(2);
+  EXPECT_EQ(TimeDelta(), policy.GetThrottledTime(start));
+
+  policy.OnThermalStateChange(DeviceThermalState::kSerious, start);
+  EXPECT_EQ(Seconds(3), policy.GetThrottledTime(start + Seconds(3)));
+
+  // Changing how much is throttled doesn't restart the throttling.
+  policy.OnSpeedLimitChange(10, start + Seconds(4));
+  policy.OnSpeedLimitChange(PowerThermalObserver::kSpeedLimitMax,
+                            start + Seconds(5));
+  EXPECT_TRUE(policy.is_throttled());
+
+  policy.OnThermalStateChange(DeviceThermalState::kNominal,
+                              start + Seconds(10));
+  EXPECT_EQ(Seconds(10), policy.last_throttled_duration());
+  EXPECT_EQ(Seconds(10), policy.GetThrottledTime(start + Seconds(20)));
+
+  policy.OnThermalStateChange(DeviceThermalState::kCritical,
+                              start + Seconds(20));
+  policy.OnThermalStateChange(DeviceThermalState::kFair, start + Seconds(22));
+  EXPECT_EQ(Seconds(2), policy.last_throttled_duration());
+  EXPECT_EQ(Seconds(12), policy.GetThrottledTime(start + Seconds(30)));
+}
+
+}  // namespace internal
+}  // namespace base
@@ -100,6 +100,8 @@ bool ThreadGroup::IsBoundToCurrentThread() const {
 void ThreadGroup::Start() {
   CheckedAutoLock auto_lock(lock_);
   disable_fair_scheduling_ = FeatureList::IsEnabled(kDisableFairJobScheduling);
+  if (FeatureList::IsEnabled(kPriorityQueueLanes))
+    priority_queue_.EnablePriorityLanes();
 }
 
 size_t
@@ -256,6 +258,32 @@ void ThreadGroup::PushTaskSourceAndWakeUpWorkersImpl(
   EnsureEnoughWorkersLockRequired(executor);
 }
 
+void ThreadGroup::PushTaskSourcesAndWakeUpWorkersImpl(
+    BaseScopedCommandsExecutor* executor,
+    std::vector<RegisteredTaskSource> task_sources) {
+  CheckedAutoLock auto_lock(lock_);
+  DCHECK(!replacement_thread_group_);
+  PushTaskSourcesLockRequired(executor, std::move(task_sources));
+  EnsureEnoughWorkersLockRequired(executor);
+}
+
+void ThreadGroup::PushTaskSourcesLockRequired(
+    BaseScopedCommandsExecutor* executor,
+    std::vector<RegisteredTaskSource> task_sources) {
+  for (RegisteredTaskSource& task_source : task_sources) {
+    DCHECK_EQ(delegate_->GetThreadGroupForTraits(
+                  {task_source->priority_racy(), task_source->thread_policy()}),
+              this);
+    // See PushTaskSourceAndWakeUpWorkersImpl().
+    if (task_source->heap_handle().IsValid()) {
+      executor->ScheduleReleaseTaskSource(std::move(task_source));
+      continue;
+    }
+    auto sort_key = task_source->GetSortKey(disable_fair_scheduling_);
+    priority_queue_.Push(std::move(task_source), sort_key);
+  }
+}
+
 void ThreadGroup::InvalidateAndHandoffAllTaskSourcesToOtherThreadGroup(
     ThreadGroup* destination_thread_group) {
   CheckedAutoLock current_thread_group_lock(lock_);
@@ -87,6 +87,18 @@ class BASE_EXPORT ThreadGroup {
   virtual void PushTaskSourceAndWakeUpWorkers(
       TransactionWithRegisteredTaskSource transaction_with_task_source) = 0;
 
+  // Pushes |task_sources| into this ThreadGroup's PriorityQueue under a single
+  // lock acquisition and wakes up workers as appropriate for the whole batch.
+  // Unlike PushTaskSourceAndWakeUpWorkers(), no Transaction is held, since a
+  // thread can't hold more than one; this must only be used with task sources
+  // whose priority can't be updated concurrently, such as the one-off
+  // Sequences of a PooledParallelTaskRunner.
+  //
+  // Implementations should instantiate a concrete ScopedCommandsExecutor and
+  // invoke PushTaskSourcesAndWakeUpWorkersImpl().
+  virtual void PushTaskSourcesAndWakeUpWorkers(
+      std::vector<RegisteredTaskSource> task_sources) = 0;
+
   // Removes all task sources from this ThreadGroup's PriorityQueue and enqueues
   // them in another |destination_thread_group|. After this method is called,
   // any task sources posted to this ThreadGroup will be forwarded to
@@ -124,6 +136,11 @@ class BASE_EXPORT ThreadGroup {
 
   virtual void OnShutdownStarted() = 0;
 
+  // Holds back |num_tasks| of the BEST_EFFORT tasks that can run concurrently
+  // in this ThreadGroup, though never the last one; 0 lifts the throttle.
+  // Tasks that are already running complete.
+  virtual void SetBestEffortTasksThrottle(size_t num_tasks) = 0;
+
  protected:
   // Derived classes must implement a ScopedCommandsExecutor that derives from
   // this to perform operations at the end of a scope, when all locks have been
@@ -226,6 +243,15 @@ class BASE_EXPORT ThreadGroup {
   void PushTaskSourceAndWakeUpWorkersImpl(
       BaseScopedCommandsExecutor* executor,
       TransactionWithRegisteredTaskSource transaction_with_task_source);
+  void PushTaskSourcesAndWakeUpWorkersImpl(
+      BaseScopedCommandsExecutor* executor,
+      std::vector<RegisteredTaskSource> task_sources);
+
+  // Pushes |task_sources| into |priority_queue_|, without waking up workers.
+  void PushTaskSourcesLockRequired(
+      BaseScopedCommandsExecutor* executor,
+      std::vector<RegisteredTaskSource> task_sources)
+      EXCLUSIVE_LOCKS_REQUIRED(lock_);
 
   // Synchronizes accesses to all members of this class which are neither const,
   // atomic, nor immutable after start. Since this lock is a bottleneck to post
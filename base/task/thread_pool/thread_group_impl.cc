@@ -7,6 +7,7 @@
 #include <stddef.h>
 
 #include <algorithm>
+#include <limits>
 #include <type_traits>
 #include <utility>
 
@@ -17,6 +18,7 @@
 #include "base/compiler_specific.h"
 #include "base/containers/stack_container.h"
 #include "base/feature_list.h"
+#include "base/lazy_instance.h"
 #include "base/location.h"
 #include "base/memory/ptr_util.h"
 #include "base/memory/raw_ptr.h"
@@ -27,17 +29,25 @@
 #include "base/strings/string_piece.h"
 #include "base/strings/string_util.h"
 #include "base/strings/stringprintf.h"
+#include "base/system/sys_info.h"
 #include "base/task/task_traits.h"
+#include "base/task/thread_pool/sequence.h"
 #include "base/task/thread_pool/task_tracker.h"
+#include "base/task/thread_pool/work_stealing_queue.h"
 #include "base/threading/platform_thread.h"
 #include "base/threading/scoped_blocking_call.h"
 #include "base/threading/scoped_blocking_call_internal.h"
 #include "base/threading/thread_checker.h"
+#include "base/threading/thread_local.h"
 #include "base/threading/thread_restrictions.h"
 #include "base/time/time_override.h"
 #include "build/build_config.h"
 #include "third_party/abseil-cpp/absl/types/optional.h"
 
+#if BUILDFLAG(IS_LINUX) || BUILDFLAG(IS_CHROMEOS) || BUILDFLAG(IS_ANDROID)
+#include "base/cpu_affinity_posix.h"
+#endif
+
 #if BUILDFLAG(IS_WIN)
 #include "base/win/scoped_com_initializer.h"
 #include "base/win/scoped_windows_thread_environment.h"
@@ -52,6 +62,10 @@ namespace {
 
 constexpr char kNumTasksBeforeDetachHistogramPrefix[] =
     "ThreadPool.NumTasksBeforeDetach.";
+constexpr char kElasticMaxTasksDecisionHistogramPrefix[] =
+    "ThreadPool.ElasticMaxTasks.Decision.";
+constexpr char kElasticMaxTasksHistogramPrefix[] =
+    "ThreadPool.ElasticMaxTasks.MaxTasks.";
 constexpr size_t kMaxNumberOfWorkers = 256;
 
 // In a background thread group:
@@ -79,6 +93,23 @@ constexpr TimeDelta kForegroundBlockedWorkersPoll = Milliseconds(1200);
 constexpr TimeDelta kBackgroundMayBlockThreshold = Seconds(10);
 constexpr TimeDelta kBackgroundBlockedWorkersPoll = Seconds(12);
 
+// Maximum number of task sources queued in the local queue of a worker when
+// kWorkStealingThreadGroup is enabled. Task sources posted from a worker whose
+// local queue is full go to the shared PriorityQueue.
+constexpr size_t kLocalQueueCapacity = 64;
+
+// Under kElasticThreadGroup, the max tasks stays within [initial / 2,
+// initial * 2] apart from the MAY_BLOCK compensation.
+constexpr size_t kElasticMaxTasksMinDivisor = 2;
+constexpr size_t kElasticMaxTasksMaxMultiplier = 2;
+
+using LocalTaskSourceQueue = WorkStealingQueue<TaskSource, kLocalQueueCapacity>;
+
+// Local queue of the ThreadGroupImpl worker running on the current thread, if
+// any and if kWorkStealingThreadGroup is enabled.
+LazyInstance<ThreadLocalPointer<LocalTaskSourceQueue>>::Leaky
+    tls_local_task_source_queue = LAZY_INSTANCE_INITIALIZER;
+
 // Only used in DCHECKs.
 bool ContainsWorker(const std::vector<scoped_refptr<WorkerThread>>& workers,
                     const WorkerThread* worker) {
@@ -130,6 +161,13 @@ class ThreadGroupImpl::ScopedCommandsExecutor
     scheduled_histogram_samples_->emplace_back(histogram, sample);
   }
 
+  // The worker to wake up first if it is idle, because it last ran the task
+  // source being pushed. See kSequenceWorkerAffinity.
+  void set_preferred_worker(const void* worker) { preferred_worker_ = worker; }
+  const void* TakePreferredWorker() {
+    return std::exchange(preferred_worker_, nullptr);
+  }
+
  private:
   class WorkerContainer {
    public:
@@ -204,6 +242,7 @@ class ThreadGroupImpl::ScopedCommandsExecutor
   WorkerContainer workers_to_wake_up_;
   WorkerContainer workers_to_start_;
   bool must_schedule_adjust_max_tasks_ = false;
+  const void* preferred_worker_ = nullptr;
 
   // StackVector rather than std::vector avoid heap allocations; size should be
   // high enough to store the maximum number of histogram samples added to a
@@ -222,7 +261,10 @@ class ThreadGroupImpl::WorkerThreadDelegateImpl : public WorkerThread::Delegate,
                                                   public BlockingObserver {
  public:
   // |outer| owns the worker for which this delegate is constructed.
-  explicit WorkerThreadDelegateImpl(TrackedRef<ThreadGroupImpl> outer);
+  // |numa_node| is an index in |outer->after_start().numa_node_cpus|, ignored
+  // if it's empty.
+  WorkerThreadDelegateImpl(TrackedRef<ThreadGroupImpl> outer,
+                           size_t numa_node);
   WorkerThreadDelegateImpl(const WorkerThreadDelegateImpl&) = delete;
   WorkerThreadDelegateImpl& operator=(const WorkerThreadDelegateImpl&) = delete;
 
@@ -267,6 +309,13 @@ class ThreadGroupImpl::WorkerThreadDelegateImpl : public WorkerThread::Delegate,
     return *read_any().current_task_priority;
   }
 
+  // Task sources posted from this worker when kWorkStealingThreadGroup is
+  // enabled. Only pushed to from the worker thread; taken from by any worker
+  // of the thread group with |outer_->lock_| held.
+  LocalTaskSourceQueue& local_queue() { return local_queue_; }
+
+  size_t numa_node() const { return numa_node_; }
+
   // Exposed for AnnotateAcquiredLockAlias
   const CheckedLock& lock() const LOCK_RETURNED(outer_->lock_) {
     return outer_->lock_;
@@ -289,6 +338,44 @@ class ThreadGroupImpl::WorkerThreadDelegateImpl : public WorkerThread::Delegate,
   void OnWorkerBecomesIdleLockRequired(WorkerThread* worker)
       EXCLUSIVE_LOCKS_REQUIRED(outer_->lock_);
 
+  // Takes a task source from the local queue of this worker, or steals one from
+  // the local queue of another worker, and returns it if it may run now. A task
+  // source that must not run ahead of the top of |outer_->priority_queue_| is
+  // moved to |outer_->priority_queue_| instead. Sets |priority| to the priority
+  // of the returned task source.
+  RegisteredTaskSource TakeLocalTaskSourceLockRequired(
+      ScopedCommandsExecutor* executor,
+      WorkerThread* worker,
+      TaskPriority* priority) EXCLUSIVE_LOCKS_REQUIRED(outer_->lock_);
+
+  // Moves task sources left in this worker's local queue to the shared
+  // PriorityQueue before the worker goes idle, so they don't strand.
+  void FlushLocalQueueLockRequired(ScopedCommandsExecutor* executor,
+                                   WorkerThread* worker)
+      EXCLUSIVE_LOCKS_REQUIRED(outer_->lock_);
+
+  // Under kSequenceWorkerAffinity, keeps the Sequence which this worker just
+  // ran a task from in |worker_only().affine_task_source| to run its next
+  // task, instead of reenqueuing it. Returns false, in which case the Sequence
+  // must be reenqueued, if it's a job, a BEST_EFFORT Sequence or a Sequence
+  // that belongs to another thread group, or if |outer_->priority_queue_|
+  // holds a task source of higher priority or which has waited for longer
+  // than |affinity_wait_budget|.
+  bool MaybeKeepAffineTaskSourceLockRequired(
+      TransactionWithRegisteredTaskSource& transaction_with_task_source)
+      EXCLUSIVE_LOCKS_REQUIRED(outer_->lock_);
+
+  // Returns the Sequence kept by MaybeKeepAffineTaskSourceLockRequired(), if
+  // it may run now. Sets |priority| to its priority.
+  RegisteredTaskSource TakeAffineTaskSourceLockRequired(
+      ScopedCommandsExecutor* executor,
+      TaskPriority* priority) EXCLUSIVE_LOCKS_REQUIRED(outer_->lock_);
+
+  // Moves the Sequence kept by MaybeKeepAffineTaskSourceLockRequired(), if
+  // any, to |outer_->priority_queue_| for another worker to run.
+  void ReEnqueueAffineTaskSourceLockRequired(ScopedCommandsExecutor* executor)
+      EXCLUSIVE_LOCKS_REQUIRED(outer_->lock_);
+
   // Accessed only from the worker thread.
   struct WorkerOnly {
     // Number of tasks executed since the last time the
@@ -298,6 +385,9 @@ class ThreadGroupImpl::WorkerThreadDelegateImpl : public WorkerThread::Delegate,
     // Associated WorkerThread, if any, initialized in OnMainEntry().
     raw_ptr<WorkerThread> worker_thread_;
 
+    // See MaybeKeepAffineTaskSourceLockRequired().
+    RegisteredTaskSource affine_task_source;
+
 #if BUILDFLAG(IS_WIN)
     std::unique_ptr<win::ScopedWindowsThreadEnvironment> win_thread_environment;
 #endif  // BUILDFLAG(IS_WIN)
@@ -343,6 +433,10 @@ class ThreadGroupImpl::WorkerThreadDelegateImpl : public WorkerThread::Delegate,
 
   const TrackedRef<ThreadGroupImpl> outer_;
 
+  const size_t numa_node_;
+
+  LocalTaskSourceQueue local_queue_;
+
   // Whether |outer_->max_tasks_|/|outer_->max_best_effort_tasks_| were
   // incremented due to a ScopedBlockingCall on the thread.
   bool incremented_max_tasks_since_blocked_ GUARDED_BY(outer_->lock_) = false;
@@ -380,6 +474,32 @@ ThreadGroupImpl::ThreadGroupImpl(StringPiece histogram_label,
                     1000,
                     50,
                     HistogramBase::kUmaTargetedHistogramFlag)),
+      // Mimics the UMA_HISTOGRAM_ENUMERATION macro.
+      elastic_max_tasks_decision_histogram_(
+          histogram_label.empty()
+              ? nullptr
+              : LinearHistogram::FactoryGet(
+                    JoinString({kElasticMaxTasksDecisionHistogramPrefix,
+                                histogram_label},
+                               ""),
+                    1,
+                    static_cast<int>(
+                        ElasticMaxTasksController::Decision::kMaxValue) +
+                        1,
+                    static_cast<int>(
+                        ElasticMaxTasksController::Decision::kMaxValue) +
+                        2,
+                    HistogramBase::kUmaTargetedHistogramFlag)),
+      elastic_max_tasks_histogram_(
+          histogram_label.empty()
+              ? nullptr
+              : Histogram::FactoryGet(
+                    JoinString(
+                        {kElasticMaxTasksHistogramPrefix, histogram_label}, ""),
+                    1,
+                    kMaxNumberOfWorkers,
+                    50,
+                    HistogramBase::kUmaTargetedHistogramFlag)),
       tracked_ref_factory_(this) {
   DCHECK(!thread_group_label_.empty());
 }
@@ -401,6 +521,21 @@ void ThreadGroupImpl::Start(
   in_start().wakeup_strategy = kWakeUpStrategyParam.Get();
   in_start().may_block_without_delay =
       FeatureList::IsEnabled(kMayBlockWithoutDelay);
+  in_start().work_stealing = FeatureList::IsEnabled(kWorkStealingThreadGroup);
+  in_start().elastic_max_tasks = FeatureList::IsEnabled(kElasticThreadGroup);
+  in_start().sequence_affinity =
+      FeatureList::IsEnabled(kSequenceWorkerAffinity);
+  in_start().affinity_wait_budget =
+      kSequenceWorkerAffinityWaitBudgetParam.Get();
+#if BUILDFLAG(IS_LINUX) || BUILDFLAG(IS_CHROMEOS) || BUILDFLAG(IS_ANDROID)
+  if (priority_hint_ == ThreadPriority::NORMAL &&
+      FeatureList::IsEnabled(kNumaAwareThreadGroup)) {
+    std::vector<std::vector<int>> numa_node_cpus = SysInfo::GetNumaNodeCpus();
+    // Pinning workers is only worthwhile if there is more than one node.
+    if (numa_node_cpus.size() > 1)
+      in_start().numa_node_cpus = std::move(numa_node_cpus);
+  }
+#endif
   in_start().may_block_threshold =
       may_block_threshold ? may_block_threshold.value()
                           : (priority_hint_ == ThreadPriority::NORMAL
@@ -423,6 +558,13 @@ void ThreadGroupImpl::Start(
   in_start().worker_environment = worker_environment;
   in_start().service_thread_task_runner = std::move(service_thread_task_runner);
   in_start().worker_thread_observer = worker_thread_observer;
+  if (in_start().elastic_max_tasks) {
+    elastic_max_tasks_controller_ = std::make_unique<ElasticMaxTasksController>(
+        max_tasks_,
+        std::max<size_t>(max_tasks_ / kElasticMaxTasksMinDivisor, 1),
+        std::min(max_tasks_ * kElasticMaxTasksMaxMultiplier,
+                 kMaxNumberOfWorkers));
+  }
 
 #if DCHECK_IS_ON()
   in_start().initialized = true;
@@ -455,10 +597,97 @@ void ThreadGroupImpl::UpdateSortKey(TaskSource::Transaction transaction) {
 void ThreadGroupImpl::PushTaskSourceAndWakeUpWorkers(
     TransactionWithRegisteredTaskSource transaction_with_task_source) {
   ScopedCommandsExecutor executor(this);
+  if (MaybePushTaskSourceToLocalQueue(&executor, transaction_with_task_source))
+    return;
+  // The last worker of a Sequence is only recorded under
+  // kSequenceWorkerAffinity.
+  const RegisteredTaskSource& task_source =
+      transaction_with_task_source.task_source;
+  if (task_source->execution_mode() != TaskSourceExecutionMode::kJob) {
+    executor.set_preferred_worker(
+        static_cast<Sequence*>(task_source.get())->last_worker());
+  }
   PushTaskSourceAndWakeUpWorkersImpl(&executor,
                                      std::move(transaction_with_task_source));
 }
 
+void ThreadGroupImpl::PushTaskSourcesAndWakeUpWorkers(
+    std::vector<RegisteredTaskSource> task_sources) {
+  ScopedCommandsExecutor executor(this);
+  const size_t num_task_sources = task_sources.size();
+  CheckedAutoLock auto_lock(lock_);
+  DCHECK(!replacement_thread_group_);
+  PushTaskSourcesLockRequired(&executor, std::move(task_sources));
+  // Wake up the workers needed by the whole batch in one pass, instead of
+  // relying on woken up workers to wake up more per |wakeup_strategy|.
+  if (max_tasks_ == 0 || UNLIKELY(join_for_testing_started_))
+    return;
+  EnsureEnoughWorkersImplLockRequired(&executor, num_task_sources);
+}
+
+bool ThreadGroupImpl::MaybePushTaskSourceToLocalQueue(
+    ScopedCommandsExecutor* executor,
+    TransactionWithRegisteredTaskSource& transaction_with_task_source) {
+  // The TLS is only set on workers when kWorkStealingThreadGroup is enabled.
+  LocalTaskSourceQueue* local_queue = tls_local_task_source_queue.Get().Get();
+  if (!local_queue || !IsBoundToCurrentThread())
+    return false;
+
+  RegisteredTaskSource& task_source = transaction_with_task_source.task_source;
+  // Jobs may be queued multiple times concurrently, BEST_EFFORT task sources
+  // are subject to |max_best_effort_tasks_| and the CanRunPolicy and task
+  // sources with a deadline are run earliest deadline first, so they always go
+  // through the shared PriorityQueue, as do task sources that are already
+  // queued there.
+  if (task_source->execution_mode() == TaskSourceExecutionMode::kJob ||
+      task_source->priority_racy() == TaskPriority::BEST_EFFORT ||
+      task_source->has_deadline() || task_source->heap_handle().IsValid()) {
+    return false;
+  }
+
+  // Count the task source before publishing it so that a thief never
+  // decrements the count below its actual value. Ownership of the reference
+  // and registration is transferred to the queue.
+  num_local_task_sources_.fetch_add(1, std::memory_order_relaxed);
+  TaskSource* raw_task_source = task_source.ReleaseWithoutUnregistering();
+  if (!local_queue->Push(raw_task_source)) {
+    num_local_task_sources_.fetch_sub(1, std::memory_order_relaxed);
+    task_source =
+        RegisteredTaskSource::AdoptReleased(raw_task_source, task_tracker_.get());
+    return false;
+  }
+
+  // The current worker will take the task source from its local queue once its
+  // current task completes. Wake up an idle worker to steal it sooner if there
+  // is one. A worker going idle concurrently may be missed here, in which case
+  // the task source is run by the current worker.
+  if (num_idle_workers_hint_.load(std::memory_order_seq_cst) > 0) {
+    CheckedAutoLock auto_lock(lock_);
+    EnsureEnoughWorkersLockRequired(executor);
+  }
+  return true;
+}
+
+size_t ThreadGroupImpl::FlushLocalQueueLockRequired(WorkerThread* worker) {
+  WorkerThreadDelegateImpl* delegate =
+      static_cast<WorkerThreadDelegateImpl*>(worker->delegate());
+  size_t num_flushed = 0;
+  while (TaskSource* raw_task_source = delegate->local_queue().Steal()) {
+    num_local_task_sources_.fetch_sub(1, std::memory_order_relaxed);
+    RegisteredTaskSource task_source = RegisteredTaskSource::AdoptReleased(
+        raw_task_source, task_tracker_.get());
+    auto sort_key = task_source->GetSortKey(disable_fair_scheduling_);
+    priority_queue_.Push(std::move(task_source), sort_key);
+    ++num_flushed;
+  }
+  return num_flushed;
+}
+
+void ThreadGroupImpl::UpdateNumIdleWorkersHintLockRequired() {
+  num_idle_workers_hint_.store(idle_workers_stack_.Size(),
+                               std::memory_order_seq_cst);
+}
+
 size_t ThreadGroupImpl::GetMaxConcurrentNonBlockedTasksDeprecated() const {
 #if DCHECK_IS_ON()
   CheckedAutoLock auto_lock(lock_);
@@ -524,6 +753,10 @@ void ThreadGroupImpl::JoinForTesting() {
 
   CheckedAutoLock auto_lock(lock_);
   DCHECK(workers_ == workers_copy);
+  // Task sources left in local queues are flushed along with |priority_queue_|.
+  for (const auto& worker : workers_)
+    FlushLocalQueueLockRequired(worker.get());
+  DCHECK_EQ(num_local_task_sources_.load(std::memory_order_relaxed), 0U);
   // Release |workers_| to clear their TrackedRef against |this|.
   workers_.clear();
 }
@@ -540,7 +773,7 @@ size_t ThreadGroupImpl::GetMaxTasksForTesting() const {
 
 size_t ThreadGroupImpl::GetMaxBestEffortTasksForTesting() const {
   CheckedAutoLock auto_lock(lock_);
-  return max_best_effort_tasks_;
+  return GetMaxBestEffortTasksLockRequired();
 }
 
 size_t ThreadGroupImpl::NumberOfIdleWorkersForTesting() const {
@@ -549,8 +782,9 @@ size_t ThreadGroupImpl::NumberOfIdleWorkersForTesting() const {
 }
 
 ThreadGroupImpl::WorkerThreadDelegateImpl::WorkerThreadDelegateImpl(
-    TrackedRef<ThreadGroupImpl> outer)
-    : outer_(std::move(outer)) {
+    TrackedRef<ThreadGroupImpl> outer,
+    size_t numa_node)
+    : outer_(std::move(outer)), numa_node_(numa_node) {
   // Bound in OnMainEntry().
   DETACH_FROM_THREAD(worker_thread_checker_);
 }
@@ -579,8 +813,21 @@ void ThreadGroupImpl::WorkerThreadDelegateImpl::OnMainEntry(
   PlatformThread::SetName(
       StringPrintf("ThreadPool%sWorker", outer_->thread_group_label_.c_str()));
 
+#if BUILDFLAG(IS_LINUX) || BUILDFLAG(IS_CHROMEOS) || BUILDFLAG(IS_ANDROID)
+  const auto& numa_node_cpus = outer_->after_start().numa_node_cpus;
+  if (!numa_node_cpus.empty()) {
+    DCHECK_LT(numa_node_, numa_node_cpus.size());
+    // Failure is benign: the worker then runs on any CPU, as it would without
+    // kNumaAwareThreadGroup.
+    SetThreadCpuAffinity(PlatformThread::CurrentId(),
+                         numa_node_cpus[numa_node_]);
+  }
+#endif
+
   outer_->BindToCurrentThread();
   worker_only().worker_thread_ = worker;
+  if (outer_->after_start().work_stealing)
+    tls_local_task_source_queue.Get().Set(&local_queue_);
   SetBlockingObserverForCurrentThread(this);
 
   if (outer_->worker_started_for_testing_) {
@@ -617,25 +864,32 @@ RegisteredTaskSource ThreadGroupImpl::WorkerThreadDelegateImpl::GetWork(
     executor.FlushWorkerCreation(&outer_->lock_);
   }
 
-  if (!CanGetWorkLockRequired(&executor, worker))
+  if (!CanGetWorkLockRequired(&executor, worker)) {
+    ReEnqueueAffineTaskSourceLockRequired(&executor);
     return nullptr;
+  }
 
   RegisteredTaskSource task_source;
   TaskPriority priority;
+  if (worker_only().affine_task_source)
+    task_source = TakeAffineTaskSourceLockRequired(&executor, &priority);
+  if (!task_source && outer_->after_start().work_stealing)
+    task_source = TakeLocalTaskSourceLockRequired(&executor, worker, &priority);
   while (!task_source && !outer_->priority_queue_.IsEmpty()) {
-    // Enforce the CanRunPolicy and that no more than |max_best_effort_tasks_|
-    // BEST_EFFORT tasks run concurrently.
+    // Enforce the CanRunPolicy and that no more than |max_best_effort_tasks_|,
+    // minus the throttle, BEST_EFFORT tasks run concurrently.
     priority = outer_->priority_queue_.PeekSortKey().priority();
     if (!outer_->task_tracker_->CanRunPriority(priority) ||
         (priority == TaskPriority::BEST_EFFORT &&
          outer_->num_running_best_effort_tasks_ >=
-             outer_->max_best_effort_tasks_)) {
+             outer_->GetMaxBestEffortTasksLockRequired())) {
       break;
     }
 
     task_source = outer_->TakeRegisteredTaskSource(&executor);
   }
   if (!task_source) {
+    FlushLocalQueueLockRequired(&executor, worker);
     OnWorkerBecomesIdleLockRequired(worker);
     return nullptr;
   }
@@ -645,6 +899,10 @@ RegisteredTaskSource ThreadGroupImpl::WorkerThreadDelegateImpl::GetWork(
   DCHECK(!outer_->idle_workers_stack_.Contains(worker));
   write_worker().current_task_priority = priority;
   write_worker().current_shutdown_behavior = task_source->shutdown_behavior();
+  if (outer_->after_start().sequence_affinity &&
+      task_source->execution_mode() != TaskSourceExecutionMode::kJob) {
+    static_cast<Sequence*>(task_source.get())->set_last_worker(worker);
+  }
 
   if (outer_->after_start().wakeup_after_getwork &&
       outer_->after_start().wakeup_strategy !=
@@ -700,7 +958,8 @@ void ThreadGroupImpl::WorkerThreadDelegateImpl::DidProcessTask(
   write_worker().current_shutdown_behavior = absl::nullopt;
   write_worker().current_task_priority = absl::nullopt;
 
-  if (transaction_with_task_source) {
+  if (transaction_with_task_source &&
+      !MaybeKeepAffineTaskSourceLockRequired(*transaction_with_task_source)) {
     outer_->ReEnqueueTaskSourceLockRequired(
         &workers_executor, &reenqueue_executor,
         std::move(transaction_with_task_source.value()));
@@ -765,6 +1024,9 @@ void ThreadGroupImpl::WorkerThreadDelegateImpl::CleanupLockRequired(
   }
   worker->Cleanup();
   outer_->idle_workers_stack_.Remove(worker);
+  outer_->UpdateNumIdleWorkersHintLockRequired();
+  // The local queue was flushed when the worker became idle.
+  DCHECK_EQ(local_queue_.SizeRacy(), 0U);
 
   // Remove the worker from |workers_|.
   auto worker_iter = ranges::find(outer_->workers_, worker);
@@ -779,6 +1041,7 @@ void ThreadGroupImpl::WorkerThreadDelegateImpl::OnWorkerBecomesIdleLockRequired(
   // Add the worker to the idle stack.
   DCHECK(!outer_->idle_workers_stack_.Contains(worker));
   outer_->idle_workers_stack_.Push(worker);
+  outer_->UpdateNumIdleWorkersHintLockRequired();
   DCHECK_LE(outer_->idle_workers_stack_.Size(), outer_->workers_.size());
   outer_->idle_workers_stack_cv_for_testing_->Broadcast();
 }
@@ -807,12 +1070,18 @@ void ThreadGroupImpl::WorkerThreadDelegateImpl::OnMainExit(
   worker_only().win_thread_environment.reset();
 #endif  // BUILDFLAG(IS_WIN)
 
+  if (outer_->after_start().work_stealing)
+    tls_local_task_source_queue.Get().Set(nullptr);
+
   // Count cleaned up workers for tests. It's important to do this here instead
   // of at the end of CleanupLockRequired() because some side-effects of
   // cleaning up happen outside the lock (e.g. recording histograms) and
   // resuming from tests must happen-after that point or checks on the main
   // thread will be flaky (crbug.com/1047733).
+  ScopedCommandsExecutor executor(outer_.get());
   CheckedAutoLock auto_lock(outer_->lock_);
+  // The worker may exit between DidProcessTask() and GetWork().
+  ReEnqueueAffineTaskSourceLockRequired(&executor);
   ++outer_->num_workers_cleaned_up_for_testing_;
 #if DCHECK_IS_ON()
   outer_->some_workers_cleaned_up_for_testing_ = true;
@@ -951,6 +1220,7 @@ bool ThreadGroupImpl::WorkerThreadDelegateImpl::CanGetWorkLockRequired(
   // thread group, they get a chance to no longer be excess before being cleaned
   // up.
   if (outer_->GetNumAwakeWorkersLockRequired() > outer_->max_tasks_) {
+    FlushLocalQueueLockRequired(executor, worker);
     OnWorkerBecomesIdleLockRequired(worker);
     return false;
   }
@@ -958,6 +1228,149 @@ bool ThreadGroupImpl::WorkerThreadDelegateImpl::CanGetWorkLockRequired(
   return true;
 }
 
+RegisteredTaskSource
+ThreadGroupImpl::WorkerThreadDelegateImpl::TakeLocalTaskSourceLockRequired(
+    ScopedCommandsExecutor* executor,
+    WorkerThread* worker,
+    TaskPriority* priority) {
+  if (outer_->num_local_task_sources_.load(std::memory_order_relaxed) == 0)
+    return nullptr;
+
+  // Own local queue first, then steal from peers, preferring peers on the same
+  // NUMA node so that task sources stay close to the memory they were posted
+  // with. Every consumer holds |outer_->lock_|, which also keeps peers' local
+  // queues alive.
+  TaskSource* raw_task_source = local_queue_.Steal();
+  const bool numa_aware = !outer_->after_start().numa_node_cpus.empty();
+  for (int pass = 0; !raw_task_source && pass < (numa_aware ? 2 : 1);
+       ++pass) {
+    for (size_t i = 0; !raw_task_source && i < outer_->workers_.size(); ++i) {
+      WorkerThread* peer = outer_->workers_[i].get();
+      if (peer == worker)
+        continue;
+      auto* peer_delegate =
+          static_cast<WorkerThreadDelegateImpl*>(peer->delegate());
+      // With NUMA awareness, the first pass only visits same-node peers and
+      // the second pass only visits the others.
+      const bool same_node = peer_delegate->numa_node() == numa_node_;
+      if (numa_aware && same_node != (pass == 0))
+        continue;
+      raw_task_source = peer_delegate->local_queue().Steal();
+    }
+  }
+  if (!raw_task_source)
+    return nullptr;
+  outer_->num_local_task_sources_.fetch_sub(1, std::memory_order_relaxed);
+
+  RegisteredTaskSource task_source = RegisteredTaskSource::AdoptReleased(
+      raw_task_source, outer_->task_tracker_.get());
+  const TaskSourceSortKey sort_key =
+      task_source->GetSortKey(outer_->disable_fair_scheduling_);
+
+  // Preserve TaskPriority ordering and fair scheduling with regards to the
+  // shared PriorityQueue: a task source whose sort key is lower than the top of
+  // |priority_queue_|, whose priority was lowered to BEST_EFFORT while queued
+  // or that isn't allowed to run per the CanRunPolicy is handed over to
+  // |priority_queue_|, where regular scheduling applies.
+  if (sort_key.priority() == TaskPriority::BEST_EFFORT ||
+      !outer_->task_tracker_->CanRunPriority(sort_key.priority()) ||
+      (!outer_->priority_queue_.IsEmpty() &&
+       sort_key < outer_->priority_queue_.PeekSortKey())) {
+    outer_->priority_queue_.Push(std::move(task_source), sort_key);
+    return nullptr;
+  }
+
+  const auto run_status = task_source.WillRunTask();
+  if (run_status == TaskSource::RunStatus::kDisallowed) {
+    executor->ScheduleReleaseTaskSource(std::move(task_source));
+    return nullptr;
+  }
+  if (run_status == TaskSource::RunStatus::kAllowedNotSaturated) {
+    // The task source needs more workers; queue an additional registration in
+    // |priority_queue_| as TakeRegisteredTaskSource() would.
+    RegisteredTaskSource additional_task_source =
+        outer_->task_tracker_->RegisterTaskSource(task_source.get());
+    if (additional_task_source) {
+      outer_->priority_queue_.Push(
+          std::move(additional_task_source),
+          task_source->GetSortKey(outer_->disable_fair_scheduling_));
+    }
+  }
+  *priority = sort_key.priority();
+  return task_source;
+}
+
+void ThreadGroupImpl::WorkerThreadDelegateImpl::FlushLocalQueueLockRequired(
+    ScopedCommandsExecutor* executor,
+    WorkerThread* worker) {
+  if (outer_->FlushLocalQueueLockRequired(worker) > 0)
+    outer_->EnsureEnoughWorkersLockRequired(executor);
+}
+
+bool ThreadGroupImpl::WorkerThreadDelegateImpl::
+    MaybeKeepAffineTaskSourceLockRequired(
+        TransactionWithRegisteredTaskSource& transaction_with_task_source) {
+  DCHECK(!worker_only().affine_task_source);
+  if (!outer_->after_start().sequence_affinity)
+    return false;
+
+  RegisteredTaskSource& task_source = transaction_with_task_source.task_source;
+  const TaskTraits& traits = transaction_with_task_source.transaction.traits();
+  // BEST_EFFORT Sequences go through |outer_->priority_queue_|, which enforces
+  // |max_best_effort_tasks_|.
+  if (task_source->execution_mode() == TaskSourceExecutionMode::kJob ||
+      traits.priority() == TaskPriority::BEST_EFFORT ||
+      task_source->heap_handle().IsValid() ||
+      outer_->delegate_->GetThreadGroupForTraits(traits) != outer_.get()) {
+    return false;
+  }
+
+  if (!outer_->priority_queue_.IsEmpty()) {
+    const TaskSourceSortKey& sort_key = outer_->priority_queue_.PeekSortKey();
+    if (sort_key.priority() > traits.priority() ||
+        TimeTicks::Now() - sort_key.ready_time() >=
+            outer_->after_start().affinity_wait_budget) {
+      return false;
+    }
+  }
+
+  worker_only().affine_task_source = std::move(task_source);
+  return true;
+}
+
+RegisteredTaskSource
+ThreadGroupImpl::WorkerThreadDelegateImpl::TakeAffineTaskSourceLockRequired(
+    ScopedCommandsExecutor* executor,
+    TaskPriority* priority) {
+  *priority = worker_only().affine_task_source->priority_racy();
+  if (!outer_->task_tracker_->CanRunPriority(*priority)) {
+    ReEnqueueAffineTaskSourceLockRequired(executor);
+    return nullptr;
+  }
+
+  RegisteredTaskSource task_source =
+      std::move(worker_only().affine_task_source);
+  const TaskSource::RunStatus run_status = task_source.WillRunTask();
+  if (run_status == TaskSource::RunStatus::kDisallowed) {
+    executor->ScheduleReleaseTaskSource(std::move(task_source));
+    return nullptr;
+  }
+  // A Sequence runs one task at a time.
+  DCHECK_EQ(run_status, TaskSource::RunStatus::kAllowedSaturated);
+  return task_source;
+}
+
+void ThreadGroupImpl::WorkerThreadDelegateImpl::
+    ReEnqueueAffineTaskSourceLockRequired(ScopedCommandsExecutor* executor) {
+  if (!worker_only().affine_task_source)
+    return;
+  auto sort_key = worker_only().affine_task_source->GetSortKey(
+      outer_->disable_fair_scheduling_);
+  outer_->priority_queue_.Push(std::move(worker_only().affine_task_source),
+                               sort_key);
+  outer_->EnsureEnoughWorkersLockRequired(executor);
+}
+
 void ThreadGroupImpl::WorkerThreadDelegateImpl::
     MaybeIncrementMaxTasksLockRequired() {
   if (read_any().blocking_start_time.is_null() ||
@@ -1013,6 +1426,7 @@ void ThreadGroupImpl::MaintainAtLeastOneIdleWorkerLockRequired(
       CreateAndRegisterWorkerLockRequired(executor);
   DCHECK(new_worker);
   idle_workers_stack_.Push(new_worker.get());
+  UpdateNumIdleWorkersHintLockRequired();
 }
 
 scoped_refptr<WorkerThread>
@@ -1026,11 +1440,15 @@ ThreadGroupImpl::CreateAndRegisterWorkerLockRequired(
   // WorkerThread needs |lock_| as a predecessor for its thread lock
   // because in WakeUpOneWorker, |lock_| is first acquired and then
   // the thread lock is acquired when WakeUp is called on the worker.
-  scoped_refptr<WorkerThread> worker =
-      MakeRefCounted<WorkerThread>(priority_hint_,
-                                   std::make_unique<WorkerThreadDelegateImpl>(
-                                       tracked_ref_factory_.GetTrackedRef()),
-                                   task_tracker_, &lock_);
+  const size_t num_numa_nodes = after_start().numa_node_cpus.size();
+  const size_t numa_node =
+      num_numa_nodes ? num_workers_created_ % num_numa_nodes : 0;
+  ++num_workers_created_;
+  scoped_refptr<WorkerThread> worker = MakeRefCounted<WorkerThread>(
+      priority_hint_,
+      std::make_unique<WorkerThreadDelegateImpl>(
+          tracked_ref_factory_.GetTrackedRef(), numa_node),
+      task_tracker_, &lock_);
 
   workers_.push_back(worker);
   executor->ScheduleStart(worker);
@@ -1046,6 +1464,14 @@ size_t ThreadGroupImpl::GetNumAwakeWorkersLockRequired() const {
   return num_awake_workers;
 }
 
+size_t ThreadGroupImpl::GetMaxBestEffortTasksLockRequired() const {
+  // Keep one BEST_EFFORT task running.
+  if (max_best_effort_tasks_ == 0)
+    return 0;
+  return max_best_effort_tasks_ -
+         std::min(best_effort_tasks_throttle_, max_best_effort_tasks_ - 1);
+}
+
 size_t ThreadGroupImpl::GetDesiredNumAwakeWorkersLockRequired() const {
   // Number of BEST_EFFORT task sources that are running or queued and allowed
   // to run by the CanRunPolicy.
@@ -1055,13 +1481,15 @@ size_t ThreadGroupImpl::GetDesiredNumAwakeWorkersLockRequired() const {
 
   const size_t workers_for_best_effort_task_sources =
       std::max(std::min(num_running_or_queued_can_run_best_effort_task_sources,
-                        max_best_effort_tasks_),
+                        GetMaxBestEffortTasksLockRequired()),
                num_running_best_effort_tasks_);
 
-  // Number of USER_{VISIBLE|BLOCKING} task sources that are running or queued.
+  // Number of USER_{VISIBLE|BLOCKING} task sources that are running or queued,
+  // including those in workers' local queues.
   const size_t num_running_or_queued_foreground_task_sources =
       (num_running_tasks_ - num_running_best_effort_tasks_) +
-      GetNumAdditionalWorkersForForegroundTaskSourcesLockRequired();
+      GetNumAdditionalWorkersForForegroundTaskSourcesLockRequired() +
+      GetNumLocalTaskSourcesLockRequired();
 
   const size_t workers_for_foreground_task_sources =
       num_running_or_queued_foreground_task_sources;
@@ -1071,6 +1499,13 @@ size_t ThreadGroupImpl::GetDesiredNumAwakeWorkersLockRequired() const {
                    max_tasks_, kMaxNumberOfWorkers});
 }
 
+size_t ThreadGroupImpl::GetNumLocalTaskSourcesLockRequired() const {
+  // Task sources in local queues are never BEST_EFFORT when queued.
+  if (!task_tracker_->CanRunPriority(TaskPriority::HIGHEST))
+    return 0U;
+  return num_local_task_sources_.load(std::memory_order_relaxed);
+}
+
 void ThreadGroupImpl::DidUpdateCanRunPolicy() {
   ScopedCommandsExecutor executor(this);
   CheckedAutoLock auto_lock(lock_);
@@ -1085,6 +1520,9 @@ void ThreadGroupImpl::OnShutdownStarted() {
   if (max_tasks_ == 0 || UNLIKELY(join_for_testing_started_))
     return;
 
+  // Don't hold back BLOCK_SHUTDOWN tasks.
+  best_effort_tasks_throttle_ = 0;
+
   // Start a MAY_BLOCK scope on each worker that is already running a task.
   for (scoped_refptr<WorkerThread>& worker : workers_) {
     // The delegates of workers inside a ThreadGroupImpl should be
@@ -1099,35 +1537,58 @@ void ThreadGroupImpl::OnShutdownStarted() {
   shutdown_started_ = true;
 }
 
+void ThreadGroupImpl::SetBestEffortTasksThrottle(size_t num_tasks) {
+  ScopedCommandsExecutor executor(this);
+  CheckedAutoLock auto_lock(lock_);
+  if (shutdown_started_ || best_effort_tasks_throttle_ == num_tasks)
+    return;
+  best_effort_tasks_throttle_ = num_tasks;
+  // Wake up workers if the throttle was lowered. Workers in excess stop
+  // getting BEST_EFFORT work once they're done with their task.
+  EnsureEnoughWorkersLockRequired(&executor);
+}
+
 void ThreadGroupImpl::EnsureEnoughWorkersLockRequired(
     BaseScopedCommandsExecutor* base_executor) {
   // Don't do anything if the thread group isn't started.
   if (max_tasks_ == 0 || UNLIKELY(join_for_testing_started_))
     return;
 
-  ScopedCommandsExecutor* executor =
-      static_cast<ScopedCommandsExecutor*>(base_executor);
+  size_t max_num_workers_to_wake_up = std::numeric_limits<size_t>::max();
+  if (after_start().wakeup_strategy == WakeUpStrategy::kExponentialWakeUps) {
+    max_num_workers_to_wake_up = 2U;
+  } else if (after_start().wakeup_strategy ==
+             WakeUpStrategy::kSerializedWakeUps) {
+    max_num_workers_to_wake_up = 1U;
+  }
+  EnsureEnoughWorkersImplLockRequired(
+      static_cast<ScopedCommandsExecutor*>(base_executor),
+      max_num_workers_to_wake_up);
+}
+
+void ThreadGroupImpl::EnsureEnoughWorkersImplLockRequired(
+    ScopedCommandsExecutor* executor,
+    size_t max_num_workers_to_wake_up) {
+  DCHECK(max_tasks_ != 0 && !join_for_testing_started_);
 
   const size_t desired_num_awake_workers =
       GetDesiredNumAwakeWorkersLockRequired();
   const size_t num_awake_workers = GetNumAwakeWorkersLockRequired();
 
-  size_t num_workers_to_wake_up =
-      ClampSub(desired_num_awake_workers, num_awake_workers);
-  if (after_start().wakeup_strategy == WakeUpStrategy::kExponentialWakeUps) {
-    num_workers_to_wake_up = std::min(num_workers_to_wake_up, size_t(2U));
-  } else if (after_start().wakeup_strategy ==
-             WakeUpStrategy::kSerializedWakeUps) {
-    num_workers_to_wake_up = std::min(num_workers_to_wake_up, size_t(1U));
-  }
+  const size_t num_workers_to_wake_up =
+      std::min(static_cast<size_t>(
+                   ClampSub(desired_num_awake_workers, num_awake_workers)),
+               max_num_workers_to_wake_up);
 
   // Wake up the appropriate number of workers.
   for (size_t i = 0; i < num_workers_to_wake_up; ++i) {
     MaintainAtLeastOneIdleWorkerLockRequired(executor);
-    WorkerThread* worker_to_wakeup = idle_workers_stack_.Pop();
+    WorkerThread* worker_to_wakeup =
+        PopIdleWorkerLockRequired(executor->TakePreferredWorker());
     DCHECK(worker_to_wakeup);
     executor->ScheduleWakeUp(worker_to_wakeup);
   }
+  UpdateNumIdleWorkersHintLockRequired();
 
   // In the case where the loop above didn't wake up any worker and we don't
   // have excess workers, the idle worker should be maintained. This happens
@@ -1144,10 +1605,34 @@ void ThreadGroupImpl::EnsureEnoughWorkersLockRequired(
   MaybeScheduleAdjustMaxTasksLockRequired(executor);
 }
 
+WorkerThread* ThreadGroupImpl::PopIdleWorkerLockRequired(
+    const void* preferred_worker) {
+  if (preferred_worker && preferred_worker != idle_workers_stack_.Peek() &&
+      idle_workers_stack_.Contains(
+          static_cast<const WorkerThread*>(preferred_worker))) {
+    auto it = ranges::find_if(
+        workers_, [preferred_worker](const scoped_refptr<WorkerThread>& i) {
+          return i.get() == preferred_worker;
+        });
+    DCHECK(it != workers_.end());
+    WorkerThread* worker = it->get();
+    idle_workers_stack_.Remove(worker);
+    // Only the top of |idle_workers_stack_| is flagged as in-use.
+    worker->EndUnusedPeriod();
+    return worker;
+  }
+  return idle_workers_stack_.Pop();
+}
+
 void ThreadGroupImpl::AdjustMaxTasks() {
   DCHECK(
       after_start().service_thread_task_runner->RunsTasksInCurrentSequence());
 
+  // Read outside of |lock_|.
+  CpuPressureSignals cpu_pressure_signals;
+  if (after_start().elastic_max_tasks)
+    cpu_pressure_signals = ElasticMaxTasksController::ReadCpuPressureSignals();
+
   ScopedCommandsExecutor executor(this);
   CheckedAutoLock auto_lock(lock_);
   DCHECK(adjust_max_tasks_posted_);
@@ -1164,11 +1649,51 @@ void ThreadGroupImpl::AdjustMaxTasks() {
     delegate->MaybeIncrementMaxTasksLockRequired();
   }
 
+  if (elastic_max_tasks_controller_)
+    UpdateElasticMaxTasksLockRequired(&executor, cpu_pressure_signals);
+
   // Wake up workers according to the updated |max_tasks_|. This will also
   // reschedule AdjustMaxTasks() if necessary.
   EnsureEnoughWorkersLockRequired(&executor);
 }
 
+void ThreadGroupImpl::UpdateElasticMaxTasksLockRequired(
+    ScopedCommandsExecutor* executor,
+    const CpuPressureSignals& signals) {
+  ThreadGroupLoad load;
+  load.max_tasks = max_tasks_;
+  load.num_running_tasks = num_running_tasks_;
+  load.num_queued_task_sources =
+      priority_queue_.Size() + GetNumLocalTaskSourcesLockRequired();
+  if (!priority_queue_.IsEmpty()) {
+    load.queueing_delay =
+        std::max(TimeTicks::Now() - priority_queue_.PeekSortKey().ready_time(),
+                 TimeDelta());
+  }
+
+  const ElasticMaxTasksController::Decision decision =
+      elastic_max_tasks_controller_->Update(signals, load);
+  if (decision == ElasticMaxTasksController::Decision::kGrow) {
+    ++max_tasks_;
+    UpdateMinAllowedPriorityLockRequired();
+  } else if (decision == ElasticMaxTasksController::Decision::kShrink) {
+    // Workers in excess stop getting work once they're done with their task.
+    DCHECK_GT(max_tasks_, 1U);
+    --max_tasks_;
+    UpdateMinAllowedPriorityLockRequired();
+  }
+
+  if (elastic_max_tasks_decision_histogram_) {
+    executor->ScheduleAddHistogramSample(elastic_max_tasks_decision_histogram_,
+                                         static_cast<int>(decision));
+  }
+  if (elastic_max_tasks_histogram_ &&
+      decision != ElasticMaxTasksController::Decision::kHold) {
+    executor->ScheduleAddHistogramSample(elastic_max_tasks_histogram_,
+                                         static_cast<int>(max_tasks_));
+  }
+}
+
 void ThreadGroupImpl::ScheduleAdjustMaxTasks() {
   // |adjust_max_tasks_posted_| can't change before the task posted below runs.
   // Skip check on NaCl to avoid unsafe reference acquisition warning.
@@ -1199,11 +1724,14 @@ bool ThreadGroupImpl::ShouldPeriodicallyAdjustMaxTasksLockRequired() {
   //   concurrency limits were increased, so there is no hurry to increase them.
   // - When (2) is false: The concurrency limits could not be increased by
   //   AdjustMaxTasks().
+  // Under kElasticThreadGroup, it is also scheduled while there is work, and
+  // until the tasks added by |elastic_max_tasks_controller_| are given back.
 
   const size_t num_running_or_queued_best_effort_task_sources =
       num_running_best_effort_tasks_ +
       GetNumAdditionalWorkersForBestEffortTaskSourcesLockRequired();
-  if (num_running_or_queued_best_effort_task_sources > max_best_effort_tasks_ &&
+  if (num_running_or_queued_best_effort_task_sources >
+          GetMaxBestEffortTasksLockRequired() &&
       num_unresolved_best_effort_may_block_ > 0) {
     return true;
   }
@@ -1211,7 +1739,13 @@ bool ThreadGroupImpl::ShouldPeriodicallyAdjustMaxTasksLockRequired() {
   const size_t num_running_or_queued_task_sources =
       num_running_tasks_ +
       GetNumAdditionalWorkersForBestEffortTaskSourcesLockRequired() +
-      GetNumAdditionalWorkersForForegroundTaskSourcesLockRequired();
+      GetNumAdditionalWorkersForForegroundTaskSourcesLockRequired() +
+      GetNumLocalTaskSourcesLockRequired();
+  if (elastic_max_tasks_controller_ &&
+      (num_running_or_queued_task_sources > 0 ||
+       elastic_max_tasks_controller_->adjustment() > 0)) {
+    return true;
+  }
   constexpr size_t kIdleWorker = 1;
   return num_running_or_queued_task_sources + kIdleWorker > max_tasks_ &&
          num_unresolved_may_block_ > 0;
@@ -7,6 +7,7 @@
 
 #include <stddef.h>
 
+#include <atomic>
 #include <memory>
 #include <string>
 #include <vector>
@@ -22,6 +23,7 @@
 #include "base/synchronization/waitable_event.h"
 #include "base/task/sequenced_task_runner.h"
 #include "base/task/task_features.h"
+#include "base/task/thread_pool/elastic_max_tasks_controller.h"
 #include "base/task/thread_pool/task.h"
 #include "base/task/thread_pool/task_source.h"
 #include "base/task/thread_pool/thread_group.h"
@@ -98,6 +100,7 @@ class BASE_EXPORT ThreadGroupImpl : public ThreadGroup {
   size_t GetMaxConcurrentNonBlockedTasksDeprecated() const override;
   void DidUpdateCanRunPolicy() override;
   void OnShutdownStarted() override;
+  void SetBestEffortTasksThrottle(size_t num_tasks) override;
 
   const HistogramBase* num_tasks_before_detach_histogram() const {
     return num_tasks_before_detach_histogram_;
@@ -126,7 +129,8 @@ class BASE_EXPORT ThreadGroupImpl : public ThreadGroup {
   // Returns the number of workers in this thread group.
   size_t NumberOfWorkersForTesting() const;
 
-  // Returns |max_tasks_|/|max_best_effort_tasks_|.
+  // Returns |max_tasks_|/the number of BEST_EFFORT tasks that can run
+  // concurrently, after the throttle.
   size_t GetMaxTasksForTesting() const;
   size_t GetMaxBestEffortTasksForTesting() const;
 
@@ -151,9 +155,42 @@ class BASE_EXPORT ThreadGroupImpl : public ThreadGroup {
   void PushTaskSourceAndWakeUpWorkers(
       TransactionWithRegisteredTaskSource transaction_with_task_source)
       override;
+  void PushTaskSourcesAndWakeUpWorkers(
+      std::vector<RegisteredTaskSource> task_sources) override;
   void EnsureEnoughWorkersLockRequired(BaseScopedCommandsExecutor* executor)
       override EXCLUSIVE_LOCKS_REQUIRED(lock_);
 
+  // Implements EnsureEnoughWorkersLockRequired(), waking up at most
+  // |max_num_workers_to_wake_up| workers. The thread group must be started.
+  void EnsureEnoughWorkersImplLockRequired(ScopedCommandsExecutor* executor,
+                                           size_t max_num_workers_to_wake_up)
+      EXCLUSIVE_LOCKS_REQUIRED(lock_);
+
+  // Pops |preferred_worker| off |idle_workers_stack_| if it is idle, or the top
+  // of the stack otherwise. |preferred_worker| is a Sequence's last worker (see
+  // kSequenceWorkerAffinity), possibly null or no longer in |workers_|.
+  WorkerThread* PopIdleWorkerLockRequired(const void* preferred_worker)
+      EXCLUSIVE_LOCKS_REQUIRED(lock_);
+
+  // Queues the task source in |transaction_with_task_source| in the local
+  // queue of the current worker if work stealing is enabled, the current
+  // thread is a worker of this thread group and the task source is eligible.
+  // Returns true on success, in which case |transaction_with_task_source|'s
+  // task source is released. Takes |lock_| only if a worker may need to be
+  // woken up to steal the task source. See kWorkStealingThreadGroup.
+  bool MaybePushTaskSourceToLocalQueue(
+      ScopedCommandsExecutor* executor,
+      TransactionWithRegisteredTaskSource& transaction_with_task_source)
+      LOCKS_EXCLUDED(lock_);
+
+  // Moves all task sources queued in the local queue of |worker| to
+  // |priority_queue_|. Returns the number of task sources moved.
+  size_t FlushLocalQueueLockRequired(WorkerThread* worker)
+      EXCLUSIVE_LOCKS_REQUIRED(lock_);
+
+  // Updates |num_idle_workers_hint_| after |idle_workers_stack_| changes.
+  void UpdateNumIdleWorkersHintLockRequired() EXCLUSIVE_LOCKS_REQUIRED(lock_);
+
   // Creates a worker and schedules its start, if needed, to maintain one idle
   // worker, |max_tasks_| permitting.
   void MaintainAtLeastOneIdleWorkerLockRequired(
@@ -170,6 +207,16 @@ class BASE_EXPORT ThreadGroupImpl : public ThreadGroup {
   // Returns the number of workers that are awake (i.e. not on the idle stack).
   size_t GetNumAwakeWorkersLockRequired() const EXCLUSIVE_LOCKS_REQUIRED(lock_);
 
+  // Returns the number of task sources queued in workers' local queues that
+  // are allowed to run by the current CanRunPolicy.
+  size_t GetNumLocalTaskSourcesLockRequired() const
+      EXCLUSIVE_LOCKS_REQUIRED(lock_);
+
+  // Returns |max_best_effort_tasks_| minus the tasks held back by
+  // |best_effort_tasks_throttle_|.
+  size_t GetMaxBestEffortTasksLockRequired() const
+      EXCLUSIVE_LOCKS_REQUIRED(lock_);
+
   // Returns the desired number of awake workers, given current workload and
   // concurrency limits.
   size_t GetDesiredNumAwakeWorkersLockRequired() const
@@ -177,9 +224,17 @@ class BASE_EXPORT ThreadGroupImpl : public ThreadGroup {
 
   // Examines the list of WorkerThreads and increments |max_tasks_| for each
   // worker that has been within the scope of a MAY_BLOCK ScopedBlockingCall for
-  // more than BlockedThreshold(). Reschedules a call if necessary.
+  // more than BlockedThreshold(). If kElasticThreadGroup is enabled, also lets
+  // |elastic_max_tasks_controller_| adjust |max_tasks_|. Reschedules a call if
+  // necessary.
   void AdjustMaxTasks();
 
+  // Samples the current workload into |elastic_max_tasks_controller_| along
+  // with |signals|, and applies its decision to |max_tasks_|.
+  void UpdateElasticMaxTasksLockRequired(ScopedCommandsExecutor* executor,
+                                         const CpuPressureSignals& signals)
+      EXCLUSIVE_LOCKS_REQUIRED(lock_);
+
   // Returns the threshold after which the max tasks is increased to compensate
   // for a worker that is within a MAY_BLOCK ScopedBlockingCall.
   TimeDelta may_block_threshold_for_testing() const {
@@ -254,6 +309,19 @@ class BASE_EXPORT ThreadGroupImpl : public ThreadGroup {
     WakeUpStrategy wakeup_strategy;
     bool wakeup_after_getwork;
     bool may_block_without_delay;
+    bool work_stealing;
+    bool elastic_max_tasks;
+
+    // Whether kSequenceWorkerAffinity is enabled, and how long a worker may
+    // keep running the same Sequence while other work waits in the
+    // PriorityQueue.
+    bool sequence_affinity;
+    TimeDelta affinity_wait_budget;
+
+    // Logical CPUs of each NUMA node across which workers are distributed.
+    // Empty unless kNumaAwareThreadGroup is enabled for a foreground thread
+    // group on a machine with more than one NUMA node.
+    std::vector<std::vector<int>> numa_node_cpus;
 
     // Threshold after which the max tasks is increased to compensate for a
     // worker that is within a MAY_BLOCK ScopedBlockingCall.
@@ -283,6 +351,10 @@ class BASE_EXPORT ThreadGroupImpl : public ThreadGroup {
   // All workers owned by this thread group.
   std::vector<scoped_refptr<WorkerThread>> workers_ GUARDED_BY(lock_);
 
+  // Number of workers created by this thread group, used to distribute workers
+  // round-robin across |after_start().numa_node_cpus|.
+  size_t num_workers_created_ GUARDED_BY(lock_) = 0;
+
   bool shutdown_started_ GUARDED_BY(lock_) = false;
 
   // Maximum number of tasks of any priority / BEST_EFFORT priority that can run
@@ -290,6 +362,16 @@ class BASE_EXPORT ThreadGroupImpl : public ThreadGroup {
   size_t max_tasks_ GUARDED_BY(lock_) = 0;
   size_t max_best_effort_tasks_ GUARDED_BY(lock_) = 0;
 
+  // Number of the BEST_EFFORT tasks allowed by |max_best_effort_tasks_| that
+  // are held back, e.g. while the device is hot. See
+  // SetBestEffortTasksThrottle().
+  size_t best_effort_tasks_throttle_ GUARDED_BY(lock_) = 0;
+
+  // Adjusts |max_tasks_| from the CPU pressure and the queueing delay. Null
+  // unless kElasticThreadGroup is enabled.
+  std::unique_ptr<ElasticMaxTasksController> elastic_max_tasks_controller_
+      GUARDED_BY(lock_);
+
   // Number of tasks of any priority / BEST_EFFORT priority that are currently
   // running in this thread group.
   size_t num_running_tasks_ GUARDED_BY(lock_) = 0;
@@ -308,6 +390,17 @@ class BASE_EXPORT ThreadGroupImpl : public ThreadGroup {
   // is pushed on this stack when it receives nullptr from GetWork().
   WorkerThreadStack idle_workers_stack_ GUARDED_BY(lock_);
 
+  // Size of |idle_workers_stack_|, readable without |lock_| to decide whether
+  // a task source queued in a worker's local queue requires waking up another
+  // worker to steal it.
+  std::atomic<size_t> num_idle_workers_hint_{0};
+
+  // Number of task sources in the local queues of all workers. Incremented
+  // before a task source is pushed to a local queue and decremented after it
+  // is taken from one, so it never underestimates the number of queued task
+  // sources.
+  std::atomic<size_t> num_local_task_sources_{0};
+
   // Signaled when a worker is added to the idle workers stack.
   std::unique_ptr<ConditionVariable> idle_workers_stack_cv_for_testing_
       GUARDED_BY(lock_);
@@ -353,6 +446,12 @@ class BASE_EXPORT ThreadGroupImpl : public ThreadGroup {
   // Intentionally leaked.
   const raw_ptr<HistogramBase> num_tasks_before_detach_histogram_;
 
+  // ThreadPool.ElasticMaxTasks.{Decision,MaxTasks}.[thread group name]
+  // histograms, recorded by UpdateElasticMaxTasksLockRequired(). Intentionally
+  // leaked.
+  const raw_ptr<HistogramBase> elastic_max_tasks_decision_histogram_;
+  const raw_ptr<HistogramBase> elastic_max_tasks_histogram_;
+
   // Ensures recently cleaned up workers (ref.
   // WorkerThreadDelegateImpl::CleanupLockRequired()) had time to exit as
   // they have a raw reference to |this| (and to TaskTracker) which can
@@ -41,6 +41,7 @@
 #include "base/test/bind.h"
 #include "base/test/gtest_util.h"
 #include "base/test/metrics/histogram_tester.h"
+#include "base/test/scoped_feature_list.h"
 #include "base/test/test_simple_task_runner.h"
 #include "base/test/test_timeouts.h"
 #include "base/test/test_waitable_event.h"
@@ -1819,6 +1820,55 @@ TEST_F(ThreadGroupImplImplStartInBodyTest, MaxBestEffortTasks) {
   task_tracker_.FlushForTesting();
 }
 
+// Verify that SetBestEffortTasksThrottle() holds back BEST_EFFORT tasks, but
+// never the last one, and that they run once the throttle is lifted.
+TEST_F(ThreadGroupImplImplStartInBodyTest, BestEffortTasksThrottle) {
+  constexpr size_t kMaxBestEffortTasks = kMaxTasks / 2;
+  StartThreadGroup(TimeDelta::Max(),      // |suggested_reclaim_time|
+                   kMaxTasks,             // |max_tasks|
+                   kMaxBestEffortTasks);  // |max_best_effort_tasks|
+  thread_group_->SetBestEffortTasksThrottle(kMaxBestEffortTasks);
+  EXPECT_EQ(1U, thread_group_->GetMaxBestEffortTasksForTesting());
+
+  const scoped_refptr<TaskRunner> background_runner =
+      test::CreatePooledTaskRunner({TaskPriority::BEST_EFFORT, MayBlock()},
+                                   &mock_pooled_task_runner_delegate_);
+
+  AtomicFlag throttle_lifted;
+  std::atomic<size_t> num_started_tasks{0};
+  TestWaitableEvent first_task_running;
+  TestWaitableEvent all_tasks_running;
+  TestWaitableEvent unblock_tasks;
+  RepeatingClosure all_tasks_running_barrier = BarrierClosure(
+      kMaxBestEffortTasks,
+      BindOnce(&TestWaitableEvent::Signal, Unretained(&all_tasks_running)));
+  for (size_t i = 0; i < kMaxBestEffortTasks; ++i) {
+    background_runner->PostTask(
+        FROM_HERE, BindLambdaForTesting([&]() {
+          if (num_started_tasks.fetch_add(1) == 0)
+            first_task_running.Signal();
+          else
+            EXPECT_TRUE(throttle_lifted.IsSet());
+          all_tasks_running_barrier.Run();
+          unblock_tasks.Wait();
+        }));
+  }
+  first_task_running.Wait();
+  PlatformThread::Sleep(TestTimeouts::tiny_timeout());
+  EXPECT_EQ(1U, num_started_tasks.load());
+
+  // Lifting the throttle should let the other BEST_EFFORT tasks run alongside
+  // the first one.
+  throttle_lifted.Set();
+  thread_group_->SetBestEffortTasksThrottle(0);
+  EXPECT_EQ(kMaxBestEffortTasks,
+            thread_group_->GetMaxBestEffortTasksForTesting());
+  all_tasks_running.Wait();
+
+  unblock_tasks.Signal();
+  task_tracker_.FlushForTesting();
+}
+
 // Verify that flooding the thread group with BEST_EFFORT tasks doesn't cause
 // the creation of more than |max_best_effort_tasks| + 1 workers.
 TEST_F(ThreadGroupImplImplStartInBodyTest,
@@ -2015,5 +2065,195 @@ TEST_F(ThreadGroupImplImplStartInBodyTest, RacyCleanup) {
   thread_group_.reset();
 }
 
+class ThreadGroupImplWorkStealingTest : public ThreadGroupImplImplTestBase,
+                                        public testing::Test {
+ public:
+  ThreadGroupImplWorkStealingTest(const ThreadGroupImplWorkStealingTest&) =
+      delete;
+  ThreadGroupImplWorkStealingTest& operator=(
+      const ThreadGroupImplWorkStealingTest&) = delete;
+
+ protected:
+  ThreadGroupImplWorkStealingTest() {
+    feature_list_.InitAndEnableFeature(kWorkStealingThreadGroup);
+  }
+
+  void TearDown() override { ThreadGroupImplImplTestBase::CommonTearDown(); }
+
+ private:
+  base::test::ScopedFeatureList feature_list_;
+};
+
+// Verify that task sources posted from a worker to its local queue all run,
+// whether they are taken by the posting worker or stolen by its peers.
+TEST_F(ThreadGroupImplWorkStealingTest, FanOutFromWorker) {
+  CreateAndStartThreadGroup();
+
+  TestWaitableEvent all_tasks_ran;
+  RepeatingClosure all_tasks_ran_barrier = BarrierClosure(
+      kLargeNumber,
+      BindOnce(&TestWaitableEvent::Signal, Unretained(&all_tasks_ran)));
+
+  test::CreatePooledTaskRunner({}, &mock_pooled_task_runner_delegate_)
+      ->PostTask(FROM_HERE, BindLambdaForTesting([&]() {
+                   for (size_t i = 0; i < kLargeNumber; ++i) {
+                     test::CreatePooledSequencedTaskRunner(
+                         {}, &mock_pooled_task_runner_delegate_)
+                         ->PostTask(FROM_HERE, all_tasks_ran_barrier);
+                   }
+                 }));
+
+  all_tasks_ran.Wait();
+}
+
+// Verify that a task source in a worker's local queue doesn't run ahead of a
+// higher priority task source in the shared priority queue.
+TEST_F(ThreadGroupImplWorkStealingTest, LocalQueueRespectsPriority) {
+  // A single worker makes the order in which task sources run deterministic.
+  CreateAndStartThreadGroup(TimeDelta::Max(), /* max_tasks=*/1);
+
+  std::vector<TaskPriority> run_order;
+  TestWaitableEvent local_task_posted;
+  TestWaitableEvent user_blocking_task_posted;
+
+  test::CreatePooledTaskRunner({WithBaseSyncPrimitives()},
+                               &mock_pooled_task_runner_delegate_)
+      ->PostTask(FROM_HERE, BindLambdaForTesting([&]() {
+                   // Posted from a worker: goes to the local queue.
+                   test::CreatePooledTaskRunner(
+                       {TaskPriority::USER_VISIBLE},
+                       &mock_pooled_task_runner_delegate_)
+                       ->PostTask(FROM_HERE, BindLambdaForTesting([&]() {
+                                    run_order.push_back(
+                                        TaskPriority::USER_VISIBLE);
+                                  }));
+                   local_task_posted.Signal();
+                   user_blocking_task_posted.Wait();
+                 }));
+
+  local_task_posted.Wait();
+  // Posted from outside the thread group: goes to the shared priority queue.
+  test::CreatePooledTaskRunner({TaskPriority::USER_BLOCKING},
+                               &mock_pooled_task_runner_delegate_)
+      ->PostTask(FROM_HERE, BindLambdaForTesting([&]() {
+                   run_order.push_back(TaskPriority::USER_BLOCKING);
+                 }));
+  user_blocking_task_posted.Signal();
+
+  task_tracker_.FlushForTesting();
+  EXPECT_EQ(run_order, std::vector<TaskPriority>({TaskPriority::USER_BLOCKING,
+                                                  TaskPriority::USER_VISIBLE}));
+}
+
+// Verify that fanned out task sources all run when workers are distributed
+// across NUMA nodes. On machines with a single NUMA node, this is equivalent to
+// FanOutFromWorker.
+TEST_F(ThreadGroupImplWorkStealingTest, FanOutFromWorkerNumaAware) {
+  base::test::ScopedFeatureList numa_feature_list;
+  numa_feature_list.InitAndEnableFeature(kNumaAwareThreadGroup);
+  CreateAndStartThreadGroup();
+
+  TestWaitableEvent all_tasks_ran;
+  RepeatingClosure all_tasks_ran_barrier = BarrierClosure(
+      kLargeNumber,
+      BindOnce(&TestWaitableEvent::Signal, Unretained(&all_tasks_ran)));
+
+  test::CreatePooledTaskRunner({}, &mock_pooled_task_runner_delegate_)
+      ->PostTask(FROM_HERE, BindLambdaForTesting([&]() {
+                   for (size_t i = 0; i < kLargeNumber; ++i) {
+                     test::CreatePooledSequencedTaskRunner(
+                         {}, &mock_pooled_task_runner_delegate_)
+                         ->PostTask(FROM_HERE, all_tasks_ran_barrier);
+                   }
+                 }));
+
+  all_tasks_ran.Wait();
+}
+
+class ThreadGroupImplSequenceAffinityTest : public ThreadGroupImplImplTestBase,
+                                            public testing::Test {
+ public:
+  ThreadGroupImplSequenceAffinityTest(
+      const ThreadGroupImplSequenceAffinityTest&) = delete;
+  ThreadGroupImplSequenceAffinityTest& operator=(
+      const ThreadGroupImplSequenceAffinityTest&) = delete;
+
+ protected:
+  ThreadGroupImplSequenceAffinityTest() {
+    feature_list_.InitAndEnableFeature(kSequenceWorkerAffinity);
+  }
+
+  void SetUp() override { CreateAndStartThreadGroup(); }
+
+  void TearDown() override { ThreadGroupImplImplTestBase::CommonTearDown(); }
+
+  // Runs one task on each of the |kMaxTasks| workers at the same time, so that
+  // they go back on the idle stack in an arbitrary order.
+  void ShuffleIdleWorkers() {
+    TestWaitableEvent release_tasks;
+    TestWaitableEvent all_tasks_running;
+    RepeatingClosure all_tasks_running_barrier = BarrierClosure(
+        kMaxTasks,
+        BindOnce(&TestWaitableEvent::Signal, Unretained(&all_tasks_running)));
+    auto task_runner = test::CreatePooledTaskRunner(
+        {WithBaseSyncPrimitives()}, &mock_pooled_task_runner_delegate_);
+    for (size_t i = 0; i < kMaxTasks; ++i) {
+      task_runner->PostTask(FROM_HERE, BindLambdaForTesting([&]() {
+                              all_tasks_running_barrier.Run();
+                              release_tasks.Wait();
+                            }));
+    }
+    all_tasks_running.Wait();
+    release_tasks.Signal();
+    thread_group_->WaitForAllWorkersIdleForTesting();
+  }
+
+ private:
+  base::test::ScopedFeatureList feature_list_;
+};
+
+// Verify that a Sequence which keeps posting to itself runs all its tasks on
+// the same worker while no other work is queued.
+TEST_F(ThreadGroupImplSequenceAffinityTest, KeepsRunningOnSameWorker) {
+  auto task_runner = test::CreatePooledSequencedTaskRunner(
+      {}, &mock_pooled_task_runner_delegate_);
+  std::vector<PlatformThreadRef> thread_refs;
+  TestWaitableEvent all_tasks_ran;
+  RepeatingClosure post_next_task;
+  post_next_task = BindLambdaForTesting([&]() {
+    thread_refs.push_back(PlatformThread::CurrentRef());
+    if (thread_refs.size() < kLargeNumber)
+      task_runner->PostTask(FROM_HERE, post_next_task);
+    else
+      all_tasks_ran.Signal();
+  });
+  task_runner->PostTask(FROM_HERE, post_next_task);
+
+  all_tasks_ran.Wait();
+  EXPECT_EQ(std::count(thread_refs.begin(), thread_refs.end(), thread_refs[0]),
+            static_cast<std::ptrdiff_t>(kLargeNumber));
+}
+
+// Verify that posting to a Sequence from outside the thread group wakes up the
+// idle worker which last ran it, wherever it is on the idle stack.
+TEST_F(ThreadGroupImplSequenceAffinityTest, WakesUpLastWorker) {
+  auto task_runner = test::CreatePooledSequencedTaskRunner(
+      {}, &mock_pooled_task_runner_delegate_);
+  PlatformThreadRef last_worker_ref;
+  for (int i = 0; i < 10; ++i) {
+    TestWaitableEvent task_ran;
+    task_runner->PostTask(FROM_HERE, BindLambdaForTesting([&]() {
+                            if (i > 0)
+                              EXPECT_EQ(last_worker_ref,
+                                        PlatformThread::CurrentRef());
+                            last_worker_ref = PlatformThread::CurrentRef();
+                            task_ran.Signal();
+                          }));
+    task_ran.Wait();
+    thread_group_->WaitForAllWorkersIdleForTesting();
+    ShuffleIdleWorkers();
+  }
+}
+
 }  // namespace internal
 }  // namespace base
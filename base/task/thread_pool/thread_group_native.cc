@@ -146,6 +146,12 @@ void ThreadGroupNative::PushTaskSourceAndWakeUpWorkers(
                                      std::move(transaction_with_task_source));
 }
 
+void ThreadGroupNative::PushTaskSourcesAndWakeUpWorkers(
+    std::vector<RegisteredTaskSource> task_sources) {
+  ScopedCommandsExecutor executor(this);
+  PushTaskSourcesAndWakeUpWorkersImpl(&executor, std::move(task_sources));
+}
+
 void ThreadGroupNative::EnsureEnoughWorkersLockRequired(
     BaseScopedCommandsExecutor* executor) {
   if (!started_)
@@ -172,7 +178,7 @@ size_t ThreadGroupNative::GetMaxConcurrentNonBlockedTasksDeprecated() const {
   // active at one time. Consequently, we cannot report a true value here.
   // Instead, the values were chosen to match
   // ThreadPoolInstance::StartWithDefaultParams.
-  const int num_cores = SysInfo::NumberOfProcessors();
+  const int num_cores = SysInfo::NumberOfEffectiveProcessors();
   return std::max(3, num_cores - 1);
 }
 
@@ -184,5 +190,8 @@ void ThreadGroupNative::DidUpdateCanRunPolicy() {
 
 void ThreadGroupNative::OnShutdownStarted() {}
 
+// The native thread pool doesn't cap the BEST_EFFORT tasks; it sizes itself.
+void ThreadGroupNative::SetBestEffortTasksThrottle(size_t num_tasks) {}
+
 }  // namespace internal
 }  // namespace base
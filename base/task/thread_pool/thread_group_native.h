@@ -30,6 +30,7 @@ class BASE_EXPORT ThreadGroupNative : public ThreadGroup {
   size_t GetMaxConcurrentNonBlockedTasksDeprecated() const override;
   void DidUpdateCanRunPolicy() override;
   void OnShutdownStarted() override;
+  void SetBestEffortTasksThrottle(size_t num_tasks) override;
 
  protected:
   ThreadGroupNative(TrackedRef<TaskTracker> task_tracker,
@@ -55,6 +56,8 @@ class BASE_EXPORT ThreadGroupNative : public ThreadGroup {
   void PushTaskSourceAndWakeUpWorkers(
       TransactionWithRegisteredTaskSource transaction_with_task_source)
       override;
+  void PushTaskSourcesAndWakeUpWorkers(
+      std::vector<RegisteredTaskSource> task_sources) override;
   void EnsureEnoughWorkersLockRequired(BaseScopedCommandsExecutor* executor)
       override EXCLUSIVE_LOCKS_REQUIRED(lock_);
 
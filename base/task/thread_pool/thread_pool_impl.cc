@@ -17,6 +17,8 @@
 #include "base/feature_list.h"
 #include "base/message_loop/message_pump_type.h"
 #include "base/metrics/field_trial_params.h"
+#include "base/metrics/histogram.h"
+#include "base/power_monitor/power_monitor.h"
 #include "base/strings/string_util.h"
 #include "base/task/scoped_set_task_priority_for_current_thread.h"
 #include "base/task/task_features.h"
@@ -53,6 +55,9 @@ constexpr EnvironmentParams kBackgroundPoolEnvironmentParams{
 
 constexpr int kMaxBestEffortTasks = 2;
 
+constexpr char kThermalThrottleDurationHistogramPrefix[] =
+    "ThreadPool.BestEffortThermalThrottleDuration.";
+
 // Indicates whether BEST_EFFORT tasks are disabled by a command line switch.
 bool HasDisableBestEffortTasksSwitch() {
   // The CommandLine might not be initialized if ThreadPool is initialized in a
@@ -85,6 +90,18 @@ ThreadPoolImpl::ThreadPoolImpl(StringPiece histogram_label,
       single_thread_task_runner_manager_(task_tracker_->GetTrackedRef(),
                                          &delayed_task_manager_),
       has_disable_best_effort_switch_(HasDisableBestEffortTasksSwitch()),
+      // Mimics the UMA_HISTOGRAM_LONG_TIMES macro.
+      thermal_throttle_duration_histogram_(
+          histogram_label.empty()
+              ? nullptr
+              : Histogram::FactoryTimeGet(
+                    JoinString({kThermalThrottleDurationHistogramPrefix,
+                                histogram_label},
+                               ""),
+                    Milliseconds(1),
+                    Hours(1),
+                    50,
+                    HistogramBase::kUmaTargetedHistogramFlag)),
       tracked_ref_factory_(this) {
   foreground_thread_group_ = std::make_unique<ThreadGroupImpl>(
       histogram_label.empty()
@@ -130,6 +147,11 @@ void ThreadPoolImpl::Start(const ThreadPoolInstance::InitParams& init_params,
   disable_fair_scheduling_ = FeatureList::IsEnabled(kDisableFairJobScheduling);
   disable_job_update_priority_ =
       FeatureList::IsEnabled(kDisableJobUpdatePriority);
+  inline_post_task_and_reply_ =
+      FeatureList::IsEnabled(kInlinePostTaskAndReply);
+  // Must be enabled before any worker starts running tasks.
+  if (FeatureList::IsEnabled(kTaskLatencyRecording))
+    task_tracker_->EnableLatencyRecording();
 
   // The max number of concurrent BEST_EFFORT tasks is |kMaxBestEffortTasks|,
   // unless the max number of foreground threads is lower.
@@ -246,6 +268,14 @@ void ThreadPoolImpl::Start(const ThreadPoolInstance::InitParams& init_params,
     }
   }
 
+  if (FeatureList::IsEnabled(kThermalThrottleBestEffortTasks)) {
+    thermal_throttle_policy_ =
+        std::make_unique<ThermalThrottlePolicy>(max_best_effort_tasks);
+    service_thread_task_runner->PostTask(
+        FROM_HERE, BindOnce(&ThreadPoolImpl::StartObservingThermalState,
+                            Unretained(this)));
+  }
+
   started_ = true;
 }
 
@@ -298,6 +328,15 @@ ThreadPoolImpl::CreateUpdateableSequencedTaskRunner(const TaskTraits& traits) {
   return MakeRefCounted<PooledSequencedTaskRunner>(traits, this);
 }
 
+std::vector<TaskLatencyRecorder::Entry> ThreadPoolImpl::GetTaskLatencySnapshot()
+    const {
+  const TaskLatencyRecorder* latency_recorder =
+      task_tracker_->latency_recorder();
+  if (!latency_recorder)
+    return {};
+  return latency_recorder->GetSnapshot();
+}
+
 absl::optional<TimeTicks> ThreadPoolImpl::NextScheduledRunTimeForTesting()
     const {
   if (task_tracker_->HasIncompleteTaskSourcesForTesting())
@@ -334,6 +373,7 @@ void ThreadPoolImpl::Shutdown() {
   // and avoids the more complex alternative of shutting down the service thread
   // atomically during TaskTracker shutdown.
   service_thread_.Stop();
+  StopObservingThermalState();
 
   task_tracker_->StartShutdown();
 
@@ -368,6 +408,7 @@ void ThreadPoolImpl::JoinForTesting() {
   // those workers and stopping the service thread which will cause a CHECK. See
   // https://crbug.com/771701.
   service_thread_.Stop();
+  StopObservingThermalState();
   single_thread_task_runner_manager_.JoinForTesting();
   foreground_thread_group_->JoinForTesting();
   if (background_thread_group_)
@@ -465,6 +506,124 @@ bool ThreadPoolImpl::PostTaskWithSequence(Task task,
   return true;
 }
 
+DelayedTaskHandle ThreadPoolImpl::PostCancelableTaskWithSequence(
+    Task task,
+    scoped_refptr<Sequence> sequence) {
+  CHECK(task.task);
+  DCHECK(sequence);
+  if (task.delayed_run_time.is_null()) {
+    return PooledTaskRunnerDelegate::PostCancelableTaskWithSequence(
+        std::move(task), std::move(sequence));
+  }
+
+  if (!task_tracker_->WillPostTask(&task, sequence->shutdown_behavior()))
+    return DelayedTaskHandle();
+
+  // The DelayedTaskManager binds |task| to a handle delegate that can remove
+  // it from the timer wheel when canceled.
+  scoped_refptr<TaskRunner> task_runner = sequence->task_runner();
+  return delayed_task_manager_.AddCancelableDelayedTask(
+      std::move(task),
+      BindOnce(
+          [](scoped_refptr<Sequence> sequence,
+             ThreadPoolImpl* thread_pool_impl, Task task) {
+            thread_pool_impl->PostTaskWithSequenceNow(std::move(task),
+                                                      std::move(sequence));
+          },
+          std::move(sequence), Unretained(this)),
+      std::move(task_runner));
+}
+
+bool ThreadPoolImpl::PostTasksWithSequence(std::vector<Task> tasks,
+                                           scoped_refptr<Sequence> sequence) {
+  DCHECK(sequence);
+  const TaskShutdownBehavior shutdown_behavior = sequence->shutdown_behavior();
+
+  // All tasks go through TaskTracker::WillPostTask() before any is pushed, so
+  // that the batch is queued under a single Transaction.
+  bool all_posted = true;
+  std::vector<Task> tasks_to_push;
+  tasks_to_push.reserve(tasks.size());
+  for (Task& task : tasks) {
+    CHECK(task.task);
+    DCHECK(task.delayed_run_time.is_null());
+    if (task_tracker_->WillPostTask(&task, shutdown_behavior))
+      tasks_to_push.push_back(std::move(task));
+    else
+      all_posted = false;
+  }
+  if (tasks_to_push.empty())
+    return all_posted;
+
+  auto transaction = sequence->BeginTransaction();
+  RegisteredTaskSource task_source;
+  if (transaction.WillPushTask()) {
+    task_source = task_tracker_->RegisterTaskSource(sequence);
+    // We shouldn't push |tasks| if we're not allowed to queue |task_source|.
+    if (!task_source)
+      return false;
+  }
+  const TaskPriority priority = transaction.traits().priority();
+  for (Task& task : tasks_to_push) {
+    if (task_tracker_->WillPostTaskNow(task, priority))
+      transaction.PushTask(std::move(task));
+    else
+      all_posted = false;
+  }
+  if (task_source) {
+    const TaskTraits traits = transaction.traits();
+    GetThreadGroupForTraits(traits)->PushTaskSourceAndWakeUpWorkers(
+        {std::move(task_source), std::move(transaction)});
+  }
+  return all_posted;
+}
+
+bool ThreadPoolImpl::PostTasksWithSequences(
+    std::vector<Task> tasks,
+    std::vector<scoped_refptr<Sequence>> sequences) {
+  DCHECK_EQ(tasks.size(), sequences.size());
+  if (tasks.empty())
+    return true;
+
+  // The one-off Sequences of a PooledParallelTaskRunner share its traits, and
+  // hence its ThreadGroup.
+  const TaskShutdownBehavior shutdown_behavior =
+      sequences.front()->shutdown_behavior();
+  const TaskPriority priority = sequences.front()->priority_racy();
+  ThreadGroup* const thread_group = GetThreadGroupForTraits(
+      {priority, sequences.front()->thread_policy()});
+
+  bool all_posted = true;
+  std::vector<RegisteredTaskSource> task_sources;
+  task_sources.reserve(tasks.size());
+  for (size_t i = 0; i < tasks.size(); ++i) {
+    CHECK(tasks[i].task);
+    DCHECK(tasks[i].delayed_run_time.is_null());
+    if (!task_tracker_->WillPostTask(&tasks[i], shutdown_behavior)) {
+      all_posted = false;
+      continue;
+    }
+    auto transaction = sequences[i]->BeginTransaction();
+    DCHECK(transaction.WillPushTask());
+    RegisteredTaskSource task_source =
+        task_tracker_->RegisterTaskSource(sequences[i]);
+    if (!task_source ||
+        !task_tracker_->WillPostTaskNow(tasks[i], priority)) {
+      all_posted = false;
+      continue;
+    }
+    transaction.PushTask(std::move(tasks[i]));
+    task_sources.push_back(std::move(task_source));
+  }
+
+  // Unlike PostTaskWithSequenceNow(), the task sources are pushed after their
+  // Transaction ends. This is safe since the one-off Sequences can't have
+  // their priority updated.
+  if (!task_sources.empty())
+    thread_group->PushTaskSourcesAndWakeUpWorkers(std::move(task_sources));
+  return all_posted;
+}
+
 bool ThreadPoolImpl::ShouldYield(const TaskSource* task_source) {
   if (disable_job_yield_)
     return false;
@@ -479,6 +638,14 @@ bool ThreadPoolImpl::ShouldYield(const TaskSource* task_source) {
       ->ShouldYield(task_source->GetSortKey(disable_fair_scheduling_));
 }
 
+bool ThreadPoolImpl::CanRunTaskInline(Sequence* sequence) {
+  // Once shutdown has started, the task may have to be skipped, which posting
+  // decides.
+  return inline_post_task_and_reply_ &&
+         !task_tracker_->HasShutdownStarted() &&
+         sequence->BeginTransaction().IsEmpty();
+}
+
 bool ThreadPoolImpl::EnqueueJobTaskSource(
     scoped_refptr<JobTaskSource> task_source) {
   auto registered_task_source =
@@ -559,6 +726,51 @@ ThreadGroup* ThreadPoolImpl::GetThreadGroupForTraits(const TaskTraits& traits) {
   return foreground_thread_group_.get();
 }
 
+void ThreadPoolImpl::StartObservingThermalState() {
+  DCHECK(service_thread_.task_runner()->RunsTasksInCurrentSequence());
+  OnThermalStateChange(
+      PowerMonitor::AddPowerStateObserverAndReturnPowerThermalState(this));
+}
+
+void ThreadPoolImpl::StopObservingThermalState() {
+  // Notifications run on the service thread, so none is running now.
+  if (thermal_throttle_policy_)
+    PowerMonitor::RemovePowerThermalObserver(this);
+}
+
+void ThreadPoolImpl::OnThermalStateChange(DeviceThermalState new_state) {
+  DCHECK(thermal_throttle_policy_);
+  const bool was_throttled = thermal_throttle_policy_->is_throttled();
+  if (thermal_throttle_policy_->OnThermalStateChange(new_state,
+                                                     TimeTicks::Now())) {
+    OnThermalThrottleChanged(was_throttled);
+  }
+}
+
+void ThreadPoolImpl::OnSpeedLimitChange(int speed_limit) {
+  DCHECK(thermal_throttle_policy_);
+  const bool was_throttled = thermal_throttle_policy_->is_throttled();
+  if (thermal_throttle_policy_->OnSpeedLimitChange(speed_limit,
+                                                   TimeTicks::Now())) {
+    OnThermalThrottleChanged(was_throttled);
+  }
+}
+
+void ThreadPoolImpl::OnThermalThrottleChanged(bool was_throttled) {
+  DCHECK(service_thread_.task_runner()->RunsTasksInCurrentSequence());
+  const size_t num_throttled_tasks =
+      thermal_throttle_policy_->num_throttled_tasks();
+  foreground_thread_group_->SetBestEffortTasksThrottle(num_throttled_tasks);
+  if (background_thread_group_)
+    background_thread_group_->SetBestEffortTasksThrottle(num_throttled_tasks);
+
+  if (was_throttled && !thermal_throttle_policy_->is_throttled() &&
+      thermal_throttle_duration_histogram_) {
+    thermal_throttle_duration_histogram_->AddTimeMillisecondsGranularity(
+        thermal_throttle_policy_->last_throttled_duration());
+  }
+}
+
 void ThreadPoolImpl::UpdateCanRunPolicy() {
   DCHECK_CALLED_ON_VALID_SEQUENCE(sequence_checker_);
 
@@ -6,12 +6,15 @@
 #define BASE_TASK_THREAD_POOL_THREAD_POOL_IMPL_H_
 
 #include <memory>
+#include <vector>
 
 #include "base/base_export.h"
 #include "base/callback.h"
 #include "base/check_op.h"
 #include "base/memory/ptr_util.h"
+#include "base/memory/raw_ptr.h"
 #include "base/memory/ref_counted.h"
+#include "base/power_monitor/power_observer.h"
 #include "base/sequence_checker.h"
 #include "base/strings/string_piece.h"
 #include "base/synchronization/atomic_flag.h"
@@ -23,8 +26,10 @@
 #include "base/task/thread_pool/pooled_single_thread_task_runner_manager.h"
 #include "base/task/thread_pool/pooled_task_runner_delegate.h"
 #include "base/task/thread_pool/service_thread.h"
+#include "base/task/thread_pool/task_latency_recorder.h"
 #include "base/task/thread_pool/task_source.h"
 #include "base/task/thread_pool/task_tracker.h"
+#include "base/task/thread_pool/thermal_throttle_policy.h"
 #include "base/task/thread_pool/thread_group.h"
 #include "base/task/thread_pool/thread_group_impl.h"
 #include "base/task/thread_pool/thread_pool_instance.h"
@@ -42,13 +47,16 @@
 
 namespace base {
 
+class HistogramBase;
+
 namespace internal {
 
 // Default ThreadPoolInstance implementation. This class is thread-safe.
 class BASE_EXPORT ThreadPoolImpl : public ThreadPoolInstance,
                                    public TaskExecutor,
                                    public ThreadGroup::Delegate,
-                                   public PooledTaskRunnerDelegate {
+                                   public PooledTaskRunnerDelegate,
+                                   public PowerThermalObserver {
  public:
   using TaskTrackerImpl =
 #if BUILDFLAG(IS_POSIX) && !BUILDFLAG(IS_NACL)
@@ -110,6 +118,11 @@ class BASE_EXPORT ThreadPoolImpl : public ThreadPoolInstance,
   void UpdateJobPriority(scoped_refptr<TaskSource> task_source,
                          TaskPriority priority) override;
 
+  // Returns the cumulative latency stats of tasks run by this ThreadPool, or an
+  // empty vector if kTaskLatencyRecording is disabled. Doesn't block task
+  // execution; meant to be scraped periodically. Thread-safe.
+  std::vector<TaskLatencyRecorder::Entry> GetTaskLatencySnapshot() const;
+
   // Returns the TimeTicks of the next task scheduled on ThreadPool (Now() if
   // immediate, nullopt if none). This is thread-safe, i.e., it's safe if tasks
   // are being posted in parallel with this call but such a situation obviously
@@ -145,7 +158,32 @@ class BASE_EXPORT ThreadPoolImpl : public ThreadPoolInstance,
   // PooledTaskRunnerDelegate:
   bool PostTaskWithSequence(Task task,
                             scoped_refptr<Sequence> sequence) override;
+  DelayedTaskHandle PostCancelableTaskWithSequence(
+      Task task,
+      scoped_refptr<Sequence> sequence) override;
+  bool PostTasksWithSequence(std::vector<Task> tasks,
+                             scoped_refptr<Sequence> sequence) override;
+  bool PostTasksWithSequences(
+      std::vector<Task> tasks,
+      std::vector<scoped_refptr<Sequence>> sequences) override;
   bool ShouldYield(const TaskSource* task_source) override;
+  bool CanRunTaskInline(Sequence* sequence) override;
+
+  // Starts observing the thermal state for |thermal_throttle_policy_|. Called
+  // on the service thread, where PowerMonitor then notifies this.
+  void StartObservingThermalState();
+
+  // Stops observing the thermal state. The service thread must be stopped.
+  void StopObservingThermalState();
+
+  // PowerThermalObserver:
+  void OnThermalStateChange(DeviceThermalState new_state) override;
+  void OnSpeedLimitChange(int speed_limit) override;
+
+  // Applies the number of BEST_EFFORT tasks held back by
+  // |thermal_throttle_policy_| to the thread groups, and records the duration
+  // of the throttling once it ends.
+  void OnThermalThrottleChanged(bool was_throttled);
 
   const std::unique_ptr<TaskTrackerImpl> task_tracker_;
   ServiceThread service_thread_;
@@ -158,6 +196,7 @@ class BASE_EXPORT ThreadPoolImpl : public ThreadPoolInstance,
   bool disable_job_yield_ = false;
   bool disable_fair_scheduling_ = false;
   std::atomic<bool> disable_job_update_priority_{false};
+  bool inline_post_task_and_reply_ = false;
 
   // Whether this TaskScheduler was started. Access controlled by
   // |sequence_checker_|.
@@ -172,6 +211,16 @@ class BASE_EXPORT ThreadPoolImpl : public ThreadPoolInstance,
   int num_fences_ = 0;
   int num_best_effort_fences_ = 0;
 
+  // Holds back BEST_EFFORT tasks while the device is hot. Null unless
+  // kThermalThrottleBestEffortTasks is enabled. Set in Start() and then only
+  // accessed on the service thread.
+  std::unique_ptr<ThermalThrottlePolicy> thermal_throttle_policy_;
+
+  // ThreadPool.BestEffortThermalThrottleDuration.[histogram label] histogram,
+  // recorded each time BEST_EFFORT tasks stop being held back. Intentionally
+  // leaked.
+  const raw_ptr<HistogramBase> thermal_throttle_duration_histogram_;
+
 #if DCHECK_IS_ON()
   // Set once JoinForTesting() has returned.
   AtomicFlag join_for_testing_returned_;
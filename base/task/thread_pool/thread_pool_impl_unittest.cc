@@ -12,6 +12,7 @@
 #include <utility>
 #include <vector>
 
+#include "base/barrier_closure.h"
 #include "base/base_switches.h"
 #include "base/bind.h"
 #include "base/callback.h"
@@ -470,6 +471,41 @@ TEST_P(ThreadPoolImplTest_CoverAllSchedulingOptions, PostTasksViaTaskRunner) {
   factory.WaitForAllTasksToRun();
 }
 
+// Verifies that a batch of Tasks posted via TaskRunner::PostTasks() with
+// parameterized TaskTraits and ExecutionMode runs on threads with the expected
+// priority and I/O restrictions, in order unless the ExecutionMode is parallel.
+TEST_P(ThreadPoolImplTest_CoverAllSchedulingOptions,
+       PostTaskBatchViaTaskRunner) {
+  StartThreadPool();
+  constexpr size_t kNumTasksPerTest = 150;
+  const TaskTraits traits = GetTraits();
+  const GroupTypes group_types = GetGroupTypes();
+  const bool expect_in_order =
+      GetExecutionMode() != TaskSourceExecutionMode::kParallel;
+
+  TestWaitableEvent all_tasks_ran;
+  RepeatingClosure all_tasks_ran_barrier = BarrierClosure(
+      kNumTasksPerTest,
+      BindOnce(&TestWaitableEvent::Signal, Unretained(&all_tasks_ran)));
+  // Only accessed by sequenced tasks when |expect_in_order|.
+  size_t num_tasks_run = 0;
+
+  std::vector<OnceClosure> tasks;
+  for (size_t i = 0; i < kNumTasksPerTest; ++i) {
+    tasks.push_back(BindLambdaForTesting([&, i]() {
+      VerifyTaskEnvironment(traits, group_types);
+      if (expect_in_order)
+        EXPECT_EQ(i, num_tasks_run++);
+      all_tasks_ran_barrier.Run();
+    }));
+  }
+  EXPECT_TRUE(CreateTaskRunnerAndExecutionMode(thread_pool_.get(), traits,
+                                               GetExecutionMode())
+                  ->PostTasks(FROM_HERE, std::move(tasks)));
+
+  all_tasks_ran.Wait();
+}
+
 // Verifies that a task posted via PostDelayedTask without a delay doesn't run
 // before Start() is called.
 TEST_P(ThreadPoolImplTest_CoverAllSchedulingOptions,
@@ -813,7 +849,7 @@ TEST_P(ThreadPoolImplTest,
   const int expected_max =
       GetGroupTypes().foreground_type == test::GroupType::GENERIC
           ? kMaxNumForegroundThreads
-          : std::max(3, SysInfo::NumberOfProcessors() - 1);
+          : std::max(3, SysInfo::NumberOfEffectiveProcessors() - 1);
 
   EXPECT_EQ(expected_max,
             thread_pool_->GetMaxConcurrentNonBlockedTasksWithTraitsDeprecated(
@@ -990,6 +1026,104 @@ TEST_P(ThreadPoolImplTest, SequenceLocalStorage) {
   thread_pool_->FlushForTesting();
 }
 
+// Verify that under kInlinePostTaskAndReply, a task can run inline in its
+// sequence only from a task of that sequence, and only when no other task of the
+// sequence is queued.
+TEST_P(ThreadPoolImplTest, CanRunTaskInlineInCurrentSequence) {
+  base::test::ScopedFeatureList feature_list(kInlinePostTaskAndReply);
+  StartThreadPool();
+  auto sequenced_task_runner = thread_pool_->CreateSequencedTaskRunner({});
+  auto other_sequenced_task_runner =
+      thread_pool_->CreateSequencedTaskRunner({});
+
+  TestWaitableEvent task_ran;
+  sequenced_task_runner->PostTask(
+      FROM_HERE, BindLambdaForTesting([&]() {
+        EXPECT_TRUE(sequenced_task_runner->CanRunTaskInlineInCurrentSequence());
+        EXPECT_FALSE(
+            other_sequenced_task_runner->CanRunTaskInlineInCurrentSequence());
+        sequenced_task_runner->PostTask(FROM_HERE, DoNothing());
+        EXPECT_FALSE(
+            sequenced_task_runner->CanRunTaskInlineInCurrentSequence());
+        task_ran.Signal();
+      }));
+  task_ran.Wait();
+  EXPECT_FALSE(sequenced_task_runner->CanRunTaskInlineInCurrentSequence());
+}
+
+// Verify that a task posted with PostCoalescedTask() is coalesced into the
+// pending task with the same key, on sequenced and single-thread task runners.
+TEST_P(ThreadPoolImplTest, PostCoalescedTask) {
+  StartThreadPool();
+  const scoped_refptr<SequencedTaskRunner> task_runners[] = {
+      thread_pool_->CreateSequencedTaskRunner({}),
+      thread_pool_->CreateSingleThreadTaskRunner(
+          {}, SingleThreadTaskRunnerThreadMode::SHARED)};
+  for (const scoped_refptr<SequencedTaskRunner>& task_runner : task_runners) {
+    const int key_a = 0;
+    const int key_b = 0;
+    std::vector<int> runs;
+    TestWaitableEvent blocking_event;
+    task_runner->PostTask(FROM_HERE,
+                          BindOnce(&TestWaitableEvent::Wait,
+                                   Unretained(&blocking_event)));
+    for (int i = 0; i < 3; ++i) {
+      EXPECT_TRUE(task_runner->PostCoalescedTask(
+          FROM_HERE, &key_a,
+          BindLambdaForTesting([&runs, i]() { runs.push_back(i); })));
+      EXPECT_TRUE(task_runner->PostCoalescedTask(
+          FROM_HERE, &key_b,
+          BindLambdaForTesting([&runs, i]() { runs.push_back(10 + i); }),
+          SequencedTaskRunner::CoalescingPolicy::kKeepPending));
+    }
+    blocking_event.Signal();
+    thread_pool_->FlushForTesting();
+    EXPECT_EQ(std::vector<int>({2, 10}), runs);
+
+    // Once the coalesced task ran, a new one is posted for the key.
+    EXPECT_TRUE(task_runner->PostCoalescedTask(
+        FROM_HERE, &key_a,
+        BindLambdaForTesting([&runs]() { runs.push_back(3); })));
+    thread_pool_->FlushForTesting();
+    EXPECT_EQ(std::vector<int>({2, 10, 3}), runs);
+  }
+}
+
+// Verify that objects passed to DeleteSoon() and ReleaseSoon() are destroyed
+// after the tasks posted before them and before the tasks posted after them,
+// on sequenced and single-thread task runners, although consecutive deletions
+// are batched.
+TEST_P(ThreadPoolImplTest, DeleteAndReleaseSoonOrder) {
+  StartThreadPool();
+  const scoped_refptr<SequencedTaskRunner> task_runners[] = {
+      thread_pool_->CreateSequencedTaskRunner({}),
+      thread_pool_->CreateSingleThreadTaskRunner(
+          {}, SingleThreadTaskRunnerThreadMode::SHARED)};
+  for (const scoped_refptr<SequencedTaskRunner>& task_runner : task_runners) {
+    std::vector<int> runs;
+    auto make_deletion = [&runs](int i) {
+      return std::make_unique<ScopedClosureRunner>(
+          BindLambdaForTesting([&runs, i]() { runs.push_back(i); }));
+    };
+    TestWaitableEvent blocking_event;
+    task_runner->PostTask(FROM_HERE,
+                          BindOnce(&TestWaitableEvent::Wait,
+                                   Unretained(&blocking_event)));
+    EXPECT_TRUE(task_runner->DeleteSoon(FROM_HERE, make_deletion(0)));
+    EXPECT_TRUE(task_runner->DeleteSoon(FROM_HERE, make_deletion(1)));
+    task_runner->PostTask(
+        FROM_HERE, BindLambdaForTesting([&runs]() { runs.push_back(2); }));
+    EXPECT_TRUE(task_runner->DeleteSoon(FROM_HERE, make_deletion(3)));
+    task_runner->ReleaseSoon(
+        FROM_HERE, MakeRefCounted<RefCountedData<ScopedClosureRunner>>(
+                       in_place, BindLambdaForTesting(
+                                     [&runs]() { runs.push_back(4); })));
+    blocking_event.Signal();
+    thread_pool_->FlushForTesting();
+    EXPECT_EQ(std::vector<int>({0, 1, 2, 3, 4}), runs);
+  }
+}
+
 TEST_P(ThreadPoolImplTest, FlushAsyncNoTasks) {
   StartThreadPool();
   bool called_back = false;
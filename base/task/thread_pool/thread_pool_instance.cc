@@ -64,7 +64,8 @@ void ThreadPoolInstance::StartWithDefaultParams() {
   // * The system is utilized maximally by foreground threads.
   // * The main thread is assumed to be busy, cap foreground workers at
   //   |num_cores - 1|.
-  const int num_cores = SysInfo::NumberOfProcessors();
+  // * The cores are those the CPU quota of the process lets it use.
+  const int num_cores = SysInfo::NumberOfEffectiveProcessors();
   const int max_num_foreground_threads = std::max(3, num_cores - 1);
   Start({max_num_foreground_threads});
 }
@@ -3,6 +3,7 @@
 // found in the LICENSE file.
 
 #include <stddef.h>
+#include <stdint.h>
 #include <atomic>
 #include <memory>
 #include <vector>
@@ -13,9 +14,12 @@
 #include "base/callback_helpers.h"
 #include "base/memory/raw_ptr.h"
 #include "base/synchronization/waitable_event.h"
+#include "base/task/sequenced_task_runner.h"
+#include "base/task/task_features.h"
 #include "base/task/thread_pool.h"
 #include "base/task/thread_pool/thread_pool_instance.h"
 #include "base/threading/simple_thread.h"
+#include "base/test/scoped_feature_list.h"
 #include "base/time/time.h"
 #include "testing/gtest/include/gtest/gtest.h"
 #include "testing/perf/perf_result_reporter.h"
@@ -41,6 +45,22 @@ constexpr char kStoryPostRunNoOpManyThreads[] =
     "post_run_noop_tasks_many_threads";
 constexpr char kStoryPostRunBusyManyThreads[] =
     "post_run_busy_tasks_many_threads";
+constexpr char kStoryPostRunNoOpFromWorkers[] =
+    "post_run_noop_tasks_from_workers";
+constexpr char kStoryPostRunNoOpFromWorkersWorkStealing[] =
+    "post_run_noop_tasks_from_workers_work_stealing";
+constexpr char kStoryPostRunCacheHeavySequenced[] =
+    "post_run_cache_heavy_sequenced_tasks";
+constexpr char kStoryPostRunCacheHeavySequencedAffinity[] =
+    "post_run_cache_heavy_sequenced_tasks_sequence_affinity";
+constexpr char kStoryDeleteSoonThenRun[] = "delete_soon_then_run";
+constexpr char kStoryDeleteSoonOnBestEffortWorkerThenRun[] =
+    "delete_soon_on_best_effort_worker_then_run";
+
+// The size of the buffer touched by each task of a sequence in the cache heavy
+// stories, in the order of magnitude of a per-core L2 cache.
+constexpr size_t kSequenceBufferSize = 256 * 1024;
+constexpr size_t kCacheLineSize = 64;
 
 perf_test::PerfResultReporter SetUpReporter(const std::string& story_name) {
   perf_test::PerfResultReporter reporter(kMetricPrefixThreadPool, story_name);
@@ -140,6 +160,62 @@ class ThreadPoolPerfTest : public testing::Test {
     }
   }
 
+  // Posts |num_tasks| tasks to a new sequence, each of which writes to every
+  // cache line of a buffer owned by that sequence.
+  void ContinuouslyPostCacheHeavySequencedTasks(size_t num_tasks) {
+    scoped_refptr<SequencedTaskRunner> task_runner =
+        ThreadPool::CreateSequencedTaskRunner({});
+    base::RepeatingClosure closure = base::BindRepeating(
+        [](std::atomic_size_t* num_task_pending, std::vector<uint8_t>* buffer) {
+          for (size_t i = 0; i < buffer->size(); i += kCacheLineSize)
+            ++(*buffer)[i];
+          (*num_task_pending)--;
+        },
+        Unretained(&num_tasks_pending_),
+        base::Owned(
+            std::make_unique<std::vector<uint8_t>>(kSequenceBufferSize)));
+    for (size_t i = 0; i < num_tasks; ++i) {
+      ++num_tasks_pending_;
+      ++num_posted_tasks_;
+      task_runner->PostTask(FROM_HERE, closure);
+    }
+  }
+
+  // Passes |num_tasks| small objects to DeleteSoon() on a new sequence, or to
+  // ThreadPool::DeleteSoonOnBestEffortWorker() if |best_effort_worker|. Each
+  // deletion counts as a task.
+  void ContinuouslyDeleteSoon(size_t num_tasks, bool best_effort_worker) {
+    scoped_refptr<SequencedTaskRunner> task_runner =
+        ThreadPool::CreateSequencedTaskRunner({});
+    base::RepeatingClosure closure = base::BindRepeating(
+        [](std::atomic_size_t* num_task_pending) { (*num_task_pending)--; },
+        &num_tasks_pending_);
+    for (size_t i = 0; i < num_tasks; ++i) {
+      ++num_tasks_pending_;
+      ++num_posted_tasks_;
+      auto object = std::make_unique<ScopedClosureRunner>(closure);
+      if (best_effort_worker)
+        ThreadPool::DeleteSoonOnBestEffortWorker(FROM_HERE, std::move(object));
+      else
+        task_runner->DeleteSoon(FROM_HERE, std::move(object));
+    }
+  }
+
+  // Posts a task that posts |num_tasks| no-op tasks from a worker thread, and
+  // waits for it to be done posting.
+  void ContinuouslyPostNoOpTasksFromWorker(size_t num_tasks) {
+    WaitableEvent done_posting;
+    ThreadPool::PostTask(
+        FROM_HERE, base::BindOnce(
+                       [](ThreadPoolPerfTest* self, size_t num_tasks,
+                          WaitableEvent* done_posting) {
+                         self->ContinuouslyPostNoOpTasks(num_tasks);
+                         done_posting->Signal();
+                       },
+                       Unretained(this), num_tasks, Unretained(&done_posting)));
+    done_posting.Wait();
+  }
+
  protected:
   ThreadPoolPerfTest() { ThreadPoolInstance::Create("PerfTest"); }
 
@@ -266,5 +342,58 @@ TEST_F(ThreadPoolPerfTest, PostRunBusyTasksManyThreads) {
   Benchmark(kStoryPostRunBusyManyThreads, ExecutionMode::kPostAndRun);
 }
 
+TEST_F(ThreadPoolPerfTest, PostRunNoOpTasksFromWorkers) {
+  StartThreadPool(
+      4, 4,
+      BindRepeating(&ThreadPoolPerfTest::ContinuouslyPostNoOpTasksFromWorker,
+                    Unretained(this), 10000));
+  Benchmark(kStoryPostRunNoOpFromWorkers, ExecutionMode::kPostAndRun);
+}
+
+TEST_F(ThreadPoolPerfTest, PostRunNoOpTasksFromWorkersWorkStealing) {
+  test::ScopedFeatureList feature_list(kWorkStealingThreadGroup);
+  StartThreadPool(
+      4, 4,
+      BindRepeating(&ThreadPoolPerfTest::ContinuouslyPostNoOpTasksFromWorker,
+                    Unretained(this), 10000));
+  Benchmark(kStoryPostRunNoOpFromWorkersWorkStealing,
+            ExecutionMode::kPostAndRun);
+}
+
+TEST_F(ThreadPoolPerfTest, PostRunCacheHeavySequencedTasks) {
+  StartThreadPool(
+      4, 4,
+      BindRepeating(
+          &ThreadPoolPerfTest::ContinuouslyPostCacheHeavySequencedTasks,
+          Unretained(this), 10000));
+  Benchmark(kStoryPostRunCacheHeavySequenced, ExecutionMode::kPostAndRun);
+}
+
+TEST_F(ThreadPoolPerfTest, PostRunCacheHeavySequencedTasksSequenceAffinity) {
+  test::ScopedFeatureList feature_list(kSequenceWorkerAffinity);
+  StartThreadPool(
+      4, 4,
+      BindRepeating(
+          &ThreadPoolPerfTest::ContinuouslyPostCacheHeavySequencedTasks,
+          Unretained(this), 10000));
+  Benchmark(kStoryPostRunCacheHeavySequencedAffinity,
+            ExecutionMode::kPostAndRun);
+}
+
+TEST_F(ThreadPoolPerfTest, DeleteSoonThenRun) {
+  StartThreadPool(4, 4,
+                  BindRepeating(&ThreadPoolPerfTest::ContinuouslyDeleteSoon,
+                                Unretained(this), 10000, false));
+  Benchmark(kStoryDeleteSoonThenRun, ExecutionMode::kPostThenRun);
+}
+
+TEST_F(ThreadPoolPerfTest, DeleteSoonOnBestEffortWorkerThenRun) {
+  StartThreadPool(4, 4,
+                  BindRepeating(&ThreadPoolPerfTest::ContinuouslyDeleteSoon,
+                                Unretained(this), 10000, true));
+  Benchmark(kStoryDeleteSoonOnBestEffortWorkerThenRun,
+            ExecutionMode::kPostThenRun);
+}
+
 }  // namespace internal
 }  // namespace base
@@ -0,0 +1,97 @@
+// Copyright 2022 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#ifndef BASE_TASK_THREAD_POOL_WORK_STEALING_QUEUE_H_
+#define BASE_TASK_THREAD_POOL_WORK_STEALING_QUEUE_H_
+
+#include <stddef.h>
+
+#include <array>
+#include <atomic>
+
+#include "base/bits.h"
+#include "base/check_op.h"
+
+namespace base {
+namespace internal {
+
+// A bounded, lock-free queue of pointers owned by a single producer (the
+// "owner") from which any number of consumers may take items. Items are taken
+// in FIFO order, which preserves the ordering expected by fair scheduling when
+// the owner and thieves both consume from the same end.
+//
+// Push() may only be called from the owner thread. Steal() and SizeRacy() are
+// thread-safe. The queue doesn't own the pointed-to items; callers are
+// responsible for transferring ownership through the stored pointers.
+template <typename T, size_t kCapacity>
+class WorkStealingQueue {
+ public:
+  static_assert(bits::IsPowerOfTwo(kCapacity),
+                "kCapacity must be a power of two.");
+
+  WorkStealingQueue() = default;
+  WorkStealingQueue(const WorkStealingQueue&) = delete;
+  WorkStealingQueue& operator=(const WorkStealingQueue&) = delete;
+  ~WorkStealingQueue() { DCHECK_EQ(SizeRacy(), 0U); }
+
+  // Appends |item| to the queue. Returns false without modifying the queue if
+  // the queue is full. Owner thread only.
+  bool Push(T* item) {
+    DCHECK(item);
+    const size_t bottom = bottom_.load(std::memory_order_relaxed);
+    const size_t top = top_.load(std::memory_order_acquire);
+    if (bottom - top >= kCapacity)
+      return false;
+    slots_[bottom & kMask].store(item, std::memory_order_relaxed);
+    // Publishes the slot to consumers. This is sequentially consistent so
+    // that a subsequent load on the owner thread (e.g. of an idle worker
+    // count) can't be reordered before the publication.
+    bottom_.store(bottom + 1, std::memory_order_seq_cst);
+    return true;
+  }
+
+  // Removes and returns the oldest item in the queue, or nullptr if the queue
+  // is empty. Thread-safe.
+  T* Steal() {
+    size_t top = top_.load(std::memory_order_acquire);
+    while (true) {
+      const size_t bottom = bottom_.load(std::memory_order_acquire);
+      if (top >= bottom)
+        return nullptr;
+      // The slot must be read before claiming it: once |top_| moves past it,
+      // the owner is allowed to overwrite it.
+      T* item = slots_[top & kMask].load(std::memory_order_relaxed);
+      if (top_.compare_exchange_weak(top, top + 1, std::memory_order_acq_rel,
+                                     std::memory_order_acquire)) {
+        return item;
+      }
+      // |top| was updated by compare_exchange_weak(); retry.
+    }
+  }
+
+  // Returns the number of items in the queue. Thread-safe, but the result may
+  // be outdated by the time it is used.
+  size_t SizeRacy() const {
+    const size_t top = top_.load(std::memory_order_relaxed);
+    const size_t bottom = bottom_.load(std::memory_order_relaxed);
+    return bottom > top ? bottom - top : 0;
+  }
+
+  static constexpr size_t capacity() { return kCapacity; }
+
+ private:
+  static constexpr size_t kMask = kCapacity - 1;
+
+  // Index of the next item to steal. Only ever incremented, by consumers.
+  std::atomic<size_t> top_{0};
+  // Index one past the last pushed item. Only ever incremented, by the owner.
+  std::atomic<size_t> bottom_{0};
+
+  std::array<std::atomic<T*>, kCapacity> slots_{};
+};
+
+}  // namespace internal
+}  // namespace base
+
+#endif  // BASE_TASK_THREAD_POOL_WORK_STEALING_QUEUE_H_
@@ -0,0 +1,128 @@
+// Copyright 2022 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "base/task/thread_pool/work_stealing_queue.h"
+
+#include <atomic>
+#include <memory>
+#include <vector>
+
+#include "base/memory/raw_ptr.h"
+#include "base/threading/platform_thread.h"
+#include "base/threading/simple_thread.h"
+#include "testing/gtest/include/gtest/gtest.h"
+
+namespace base {
+namespace internal {
+
+namespace {
+
+constexpr size_t kCapacity = 8;
+using TestQueue = WorkStealingQueue<int, kCapacity>;
+
+class StealingThread : public SimpleThread {
+ public:
+  StealingThread(TestQueue* queue,
+                 std::atomic_bool* done_pushing,
+                 std::vector<std::atomic_int>* num_times_stolen)
+      : SimpleThread("StealingThread"),
+        queue_(queue),
+        done_pushing_(done_pushing),
+        num_times_stolen_(num_times_stolen) {}
+  StealingThread(const StealingThread&) = delete;
+  StealingThread& operator=(const StealingThread&) = delete;
+
+  void Run() override {
+    while (true) {
+      // Read |done_pushing_| before stealing so that a final empty Steal()
+      // means there is nothing left to steal.
+      const bool done_pushing = done_pushing_->load();
+      int* item = queue_->Steal();
+      if (item) {
+        ++(*num_times_stolen_)[*item];
+      } else if (done_pushing) {
+        return;
+      } else {
+        PlatformThread::YieldCurrentThread();
+      }
+    }
+  }
+
+ private:
+  const raw_ptr<TestQueue> queue_;
+  const raw_ptr<std::atomic_bool> done_pushing_;
+  const raw_ptr<std::vector<std::atomic_int>> num_times_stolen_;
+};
+
+}  // namespace
+
+TEST(ThreadPoolWorkStealingQueueTest, PushSteal) {
+  TestQueue queue;
+  int items[3] = {0, 1, 2};
+  EXPECT_EQ(queue.Steal(), nullptr);
+  EXPECT_EQ(queue.SizeRacy(), 0U);
+
+  for (int& item : items)
+    EXPECT_TRUE(queue.Push(&item));
+  EXPECT_EQ(queue.SizeRacy(), 3U);
+
+  // Items are taken in FIFO order.
+  for (int& item : items)
+    EXPECT_EQ(queue.Steal(), &item);
+  EXPECT_EQ(queue.Steal(), nullptr);
+  EXPECT_EQ(queue.SizeRacy(), 0U);
+}
+
+TEST(ThreadPoolWorkStealingQueueTest, Bounded) {
+  TestQueue queue;
+  int items[kCapacity + 1];
+  for (size_t i = 0; i < kCapacity; ++i)
+    EXPECT_TRUE(queue.Push(&items[i]));
+  EXPECT_FALSE(queue.Push(&items[kCapacity]));
+  EXPECT_EQ(queue.SizeRacy(), kCapacity);
+
+  // Taking an item makes room for another, which wraps around the ring.
+  EXPECT_EQ(queue.Steal(), &items[0]);
+  EXPECT_TRUE(queue.Push(&items[kCapacity]));
+  for (size_t i = 1; i <= kCapacity; ++i)
+    EXPECT_EQ(queue.Steal(), &items[i]);
+  EXPECT_EQ(queue.Steal(), nullptr);
+}
+
+// Verify that each pushed item is stolen exactly once when many threads steal
+// concurrently with the owner pushing.
+TEST(ThreadPoolWorkStealingQueueTest, ConcurrentSteal) {
+  constexpr int kNumItems = 10000;
+  constexpr size_t kNumStealingThreads = 4;
+
+  TestQueue queue;
+  std::vector<int> items(kNumItems);
+  std::vector<std::atomic_int> num_times_stolen(kNumItems);
+  std::atomic_bool done_pushing{false};
+
+  std::vector<std::unique_ptr<StealingThread>> threads;
+  for (size_t i = 0; i < kNumStealingThreads; ++i) {
+    threads.push_back(std::make_unique<StealingThread>(&queue, &done_pushing,
+                                                       &num_times_stolen));
+    threads.back()->Start();
+  }
+
+  for (int i = 0; i < kNumItems; ++i) {
+    items[i] = i;
+    // Wait for the stealing threads to catch up while the queue is full.
+    while (!queue.Push(&items[i]))
+      PlatformThread::YieldCurrentThread();
+  }
+  done_pushing.store(true);
+
+  for (auto& thread : threads)
+    thread->Join();
+
+  EXPECT_EQ(queue.SizeRacy(), 0U);
+  for (int i = 0; i < kNumItems; ++i)
+    EXPECT_EQ(num_times_stolen[i].load(), 1) << i;
+}
+
+}  // namespace internal
+}  // namespace base
@@ -11,10 +11,15 @@
 
 #include "base/allocator/buildflags.h"
 #include "base/allocator/partition_allocator/partition_alloc_config.h"
+#include "base/allocator/partition_allocator/yield_processor.h"
 #include "base/callback_helpers.h"
 #include "base/check_op.h"
 #include "base/compiler_specific.h"
 #include "base/debug/alias.h"
+#include "base/feature_list.h"
+#include "base/metrics/histogram_macros.h"
+#include "base/system/sys_info.h"
+#include "base/task/task_features.h"
 #include "base/task/thread_pool/environment_config.h"
 #include "base/task/thread_pool/task_tracker.h"
 #include "base/task/thread_pool/worker_thread_observer.h"
@@ -36,6 +41,23 @@
 namespace base {
 namespace internal {
 
+namespace {
+
+// Number of processor yields between two polls of the wake-up event while
+// spinning. Polling takes the event's lock, so it shouldn't be done in a tight
+// loop.
+constexpr int kNumYieldsPerSpinPoll = 16;
+
+// Wake-up gaps are capped at this multiple of the max spin time before being
+// averaged, so that a single long idle period doesn't disable spinning for many
+// subsequent short ones.
+constexpr int kMaxWakeUpGapFactor = 4;
+
+// Number of idle periods after which spin statistics are recorded.
+constexpr int kIdleSpinReportingPeriod = 1000;
+
+}  // namespace
+
 constexpr TimeDelta WorkerThread::Delegate::kPurgeThreadCacheIdleDelay;
 
 void WorkerThread::Delegate::WaitForWork(WaitableEvent* wake_up_event) {
@@ -217,6 +239,18 @@ void WorkerThread::UpdateThreadPriority(
 
   PlatformThread::SetCurrentThreadPriority(desired_thread_priority);
   current_thread_priority_ = desired_thread_priority;
+  UpdateThreadUtilClamp();
+}
+
+void WorkerThread::UpdateThreadUtilClamp() {
+#if BUILDFLAG(IS_LINUX)
+  if (!background_util_max_percent_)
+    return;
+  PlatformThread::SetCurrentThreadUtilClamp(
+      0, current_thread_priority_ == ThreadPriority::BACKGROUND
+             ? background_util_max_percent_
+             : 100);
+#endif
 }
 
 void WorkerThread::ThreadMain() {
@@ -325,6 +359,26 @@ void WorkerThread::RunWorker() {
 
   delegate_->OnMainEntry(this);
 
+  // Spinning can only help if another thread can signal the wake-up meanwhile,
+  // and would use up the CPU quota of the process otherwise.
+  idle_spin_.enabled = FeatureList::IsEnabled(kWorkerThreadAdaptiveSpin) &&
+                       SysInfo::NumberOfEffectiveProcessors() > 1;
+  if (idle_spin_.enabled) {
+    idle_spin_.max_budget = kWorkerThreadMaxSpinTimeParam.Get();
+    idle_spin_.budget = idle_spin_.max_budget;
+    idle_spin_.average_wake_up_gap = idle_spin_.max_budget / 2;
+  }
+
+#if BUILDFLAG(IS_LINUX)
+  if (FeatureList::IsEnabled(kBackgroundWorkerUtilClamp)) {
+    background_util_max_percent_ =
+        std::clamp(kBackgroundWorkerUtilMaxPercentParam.Get(), 1, 100);
+  }
+  // The thread was created with |current_thread_priority_|.
+  if (current_thread_priority_ == ThreadPriority::BACKGROUND)
+    UpdateThreadUtilClamp();
+#endif
+
   // Background threads can take an arbitrary amount of time to complete, do not
   // watch them for hangs. Ignore priority boosting for now.
   const bool watch_for_hangs =
@@ -343,7 +397,7 @@ void WorkerThread::RunWorker() {
     TRACE_EVENT_END0("base", "WorkerThread active");
     // TODO(crbug.com/1021571): Remove this once fixed.
     PERFETTO_INTERNAL_ADD_EMPTY_EVENT();
-    delegate_->WaitForWork(&wake_up_event_);
+    WaitForWork();
     TRACE_EVENT_BEGIN0("base", "WorkerThread active");
   }
 
@@ -368,7 +422,7 @@ void WorkerThread::RunWorker() {
       // TODO(crbug.com/1021571): Remove this once fixed.
       PERFETTO_INTERNAL_ADD_EMPTY_EVENT();
       hang_watch_scope.reset();
-      delegate_->WaitForWork(&wake_up_event_);
+      WaitForWork();
       TRACE_EVENT_BEGIN0("base", "WorkerThread active");
       continue;
     }
@@ -401,6 +455,8 @@ void WorkerThread::RunWorker() {
     wake_up_event_.Reset();
   }
 
+  RecordIdleSpinHistograms();
+
   // Important: It is unsafe to access unowned state (e.g. |task_tracker_|)
   // after invoking OnMainExit().
 
@@ -419,5 +475,73 @@ void WorkerThread::RunWorker() {
   PERFETTO_INTERNAL_ADD_EMPTY_EVENT();
 }
 
+void WorkerThread::WaitForWork() {
+  if (!idle_spin_.enabled) {
+    delegate_->WaitForWork(&wake_up_event_);
+    return;
+  }
+
+  // Real time is used even when time is mocked, so that a mocked clock that
+  // doesn't advance can't make the worker spin forever.
+  const TimeTicks wait_start = subtle::TimeTicksNowIgnoringOverride();
+  const bool spin_hit = SpinForWakeUp();
+  if (!spin_hit)
+    delegate_->WaitForWork(&wake_up_event_);
+  UpdateIdleSpinState(subtle::TimeTicksNowIgnoringOverride() - wait_start,
+                      spin_hit);
+}
+
+bool WorkerThread::SpinForWakeUp() {
+  if (idle_spin_.budget.is_zero())
+    return false;
+
+  const TimeTicks deadline =
+      subtle::TimeTicksNowIgnoringOverride() + idle_spin_.budget;
+  do {
+    for (int i = 0; i < kNumYieldsPerSpinPoll; ++i)
+      PA_YIELD_PROCESSOR;
+    // |wake_up_event_| auto-resets, so this consumes the wake-up like a wait
+    // would.
+    if (wake_up_event_.IsSignaled())
+      return true;
+  } while (subtle::TimeTicksNowIgnoringOverride() < deadline);
+  return false;
+}
+
+void WorkerThread::UpdateIdleSpinState(TimeDelta wake_up_gap, bool spin_hit) {
+  const TimeDelta capped_gap =
+      std::min(wake_up_gap, idle_spin_.max_budget * kMaxWakeUpGapFactor);
+  idle_spin_.average_wake_up_gap =
+      (idle_spin_.average_wake_up_gap * 3 + capped_gap) / 4;
+
+  // Spin for about twice the typical gap so that most wake-ups arrive while
+  // spinning. Don't spin at all when the typical gap exceeds the max spin time,
+  // as spinning would then mostly burn CPU.
+  idle_spin_.budget =
+      idle_spin_.average_wake_up_gap > idle_spin_.max_budget
+          ? TimeDelta()
+          : std::min(idle_spin_.average_wake_up_gap * 2, idle_spin_.max_budget);
+
+  if (spin_hit)
+    ++idle_spin_.num_spin_hits;
+  else
+    ++idle_spin_.num_parks;
+  if (idle_spin_.num_spin_hits + idle_spin_.num_parks >=
+      kIdleSpinReportingPeriod) {
+    RecordIdleSpinHistograms();
+  }
+}
+
+void WorkerThread::RecordIdleSpinHistograms() {
+  if (idle_spin_.num_spin_hits + idle_spin_.num_parks == 0)
+    return;
+  UMA_HISTOGRAM_COUNTS_1000("ThreadPool.WorkerThread.IdleSpinHits",
+                            idle_spin_.num_spin_hits);
+  UMA_HISTOGRAM_COUNTS_1000("ThreadPool.WorkerThread.IdleParks",
+                            idle_spin_.num_parks);
+  idle_spin_.num_spin_hits = 0;
+  idle_spin_.num_parks = 0;
+}
+
 }  // namespace internal
 }  // namespace base
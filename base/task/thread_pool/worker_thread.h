@@ -181,6 +181,11 @@ class BASE_EXPORT WorkerThread : public RefCountedThreadSafe<WorkerThread>,
   // the thread managed by |this|.
   void UpdateThreadPriority(ThreadPriority desired_thread_priority);
 
+  // Under kBackgroundWorkerUtilClamp, caps the utilization clamp of the thread
+  // while |current_thread_priority_| is BACKGROUND. Must be called on the
+  // thread managed by |this|.
+  void UpdateThreadUtilClamp();
+
   // PlatformThread::Delegate:
   void ThreadMain() override;
 
@@ -205,6 +210,24 @@ class BASE_EXPORT WorkerThread : public RefCountedThreadSafe<WorkerThread>,
   // and used to easily identify threads in stack traces.
   void NOT_TAIL_CALLED RunWorker();
 
+  // Waits for |wake_up_event_| to be signaled. Under kWorkerThreadAdaptiveSpin,
+  // busy-waits for up to |idle_spin_.budget| first and only lets |delegate_|
+  // park the thread in WaitForWork() if no wake-up arrived in that time. Must
+  // be called on the thread managed by |this|.
+  void WaitForWork();
+
+  // Busy-waits for up to |idle_spin_.budget| for |wake_up_event_| to be
+  // signaled. Returns true if it was signaled (and consumed).
+  bool SpinForWakeUp();
+
+  // Adjusts |idle_spin_.budget| from |wake_up_gap|, the time between the start
+  // of the last WaitForWork() and the wake-up that ended it, and records the
+  // outcome of the wait.
+  void UpdateIdleSpinState(TimeDelta wake_up_gap, bool spin_hit);
+
+  // Records and resets the spin-hit and park counts of |idle_spin_|.
+  void RecordIdleSpinHistograms();
+
   // Self-reference to prevent destruction of |this| while the thread is alive.
   // Set in Start() before creating the thread. Reset in ThreadMain() before the
   // thread exits. No lock required because the first access occurs before the
@@ -242,8 +265,30 @@ class BASE_EXPORT WorkerThread : public RefCountedThreadSafe<WorkerThread>,
   // construction accesses occur on the thread.
   ThreadPriority current_thread_priority_;
 
+#if BUILDFLAG(IS_LINUX)
+  // The uclamp.max of the thread while it is BACKGROUND, in percent, or 0 if
+  // it isn't capped. Initialized in RunWorker().
+  int background_util_max_percent_ = 0;
+#endif
+
   // Set once JoinForTesting() has been called.
   AtomicFlag join_called_for_testing_;
+
+  // State of the adaptive spin phase of WaitForWork(). Initialized in
+  // RunWorker(). No lock required because all accesses occur on the thread.
+  struct IdleSpinState {
+    bool enabled = false;
+    // Upper bound for |budget|, from kWorkerThreadMaxSpinTimeParam.
+    TimeDelta max_budget;
+    // How long the next WaitForWork() spins before parking.
+    TimeDelta budget;
+    // Exponentially weighted moving average of recent wake-up gaps.
+    TimeDelta average_wake_up_gap;
+    // Number of idle periods ended while spinning / after parking since the
+    // last RecordIdleSpinHistograms().
+    int num_spin_hits = 0;
+    int num_parks = 0;
+  } idle_spin_;
 };
 
 }  // namespace internal
@@ -22,13 +22,17 @@
 #include "base/memory/raw_ptr.h"
 #include "base/memory/ref_counted.h"
 #include "base/synchronization/condition_variable.h"
+#include "base/system/sys_info.h"
 #include "base/task/common/checked_lock.h"
+#include "base/task/task_features.h"
 #include "base/task/thread_pool/environment_config.h"
 #include "base/task/thread_pool/sequence.h"
 #include "base/task/thread_pool/task.h"
 #include "base/task/thread_pool/task_tracker.h"
 #include "base/task/thread_pool/test_utils.h"
 #include "base/task/thread_pool/worker_thread_observer.h"
+#include "base/test/metrics/histogram_tester.h"
+#include "base/test/scoped_feature_list.h"
 #include "base/test/test_timeouts.h"
 #include "base/test/test_waitable_event.h"
 #include "base/threading/platform_thread.h"
@@ -838,6 +842,56 @@ TEST(ThreadPoolWorkerTest, WorkerThreadObserver) {
   Mock::VerifyAndClear(&observer);
 }
 
+namespace {
+
+class SignalOnGetWorkDelegate : public WorkerThreadDefaultDelegate {
+ public:
+  explicit SignalOnGetWorkDelegate(TestWaitableEvent* get_work_called)
+      : get_work_called_(get_work_called) {}
+  SignalOnGetWorkDelegate(const SignalOnGetWorkDelegate&) = delete;
+  SignalOnGetWorkDelegate& operator=(const SignalOnGetWorkDelegate&) = delete;
+
+  // WorkerThread::Delegate:
+  RegisteredTaskSource GetWork(WorkerThread* worker) override {
+    get_work_called_->Signal();
+    return nullptr;
+  }
+
+ private:
+  const raw_ptr<TestWaitableEvent> get_work_called_;
+};
+
+}  // namespace
+
+// Verify that every idle period of a worker is recorded as either a spin hit or
+// a park under kWorkerThreadAdaptiveSpin.
+TEST(ThreadPoolWorkerTest, AdaptiveSpinRecordsIdlePeriods) {
+  base::test::ScopedFeatureList feature_list(kWorkerThreadAdaptiveSpin);
+  HistogramTester histogram_tester;
+  TaskTracker task_tracker;
+  TestWaitableEvent get_work_called;
+  auto worker = MakeRefCounted<WorkerThread>(
+      ThreadPriority::NORMAL,
+      std::make_unique<SignalOnGetWorkDelegate>(&get_work_called),
+      task_tracker.GetTrackedRef());
+  worker->Start();
+
+  constexpr int kNumWakeUps = 3;
+  for (int i = 0; i < kNumWakeUps; ++i) {
+    worker->WakeUp();
+    get_work_called.Wait();
+  }
+  // Joining ends the last idle period.
+  worker->JoinForTesting();
+
+  if (SysInfo::NumberOfEffectiveProcessors() == 1)
+    return;
+  EXPECT_EQ(
+      histogram_tester.GetTotalSum("ThreadPool.WorkerThread.IdleSpinHits") +
+          histogram_tester.GetTotalSum("ThreadPool.WorkerThread.IdleParks"),
+      kNumWakeUps + 1);
+}
+
 #if BUILDFLAG(USE_PARTITION_ALLOC_AS_MALLOC) && \
     defined(PA_THREAD_CACHE_SUPPORTED)
 namespace {
@@ -4,9 +4,14 @@
 
 #include "base/task/thread_pool.h"
 
+#include <memory>
+
 #include "base/bind.h"
+#include "base/callback_helpers.h"
 #include "base/location.h"
+#include "base/memory/ref_counted.h"
 #include "base/run_loop.h"
+#include "base/synchronization/atomic_flag.h"
 #include "base/test/bind.h"
 #include "base/test/task_environment.h"
 #include "testing/gtest/include/gtest/gtest.h"
@@ -41,4 +46,24 @@ TEST(ThreadPool, PostTaskAndReplyWithResultFourArgs) {
   run_loop.Run();
 }
 
+TEST(ThreadPool, DeleteAndReleaseSoonOnBestEffortWorker) {
+  base::test::TaskEnvironment env;
+
+  base::AtomicFlag deleted;
+  base::AtomicFlag released;
+  base::ThreadPool::DeleteSoonOnBestEffortWorker(
+      FROM_HERE,
+      std::make_unique<base::ScopedClosureRunner>(base::BindOnce(
+          &base::AtomicFlag::Set, base::Unretained(&deleted))));
+  base::ThreadPool::ReleaseSoonOnBestEffortWorker(
+      FROM_HERE,
+      base::MakeRefCounted<base::RefCountedData<base::ScopedClosureRunner>>(
+          base::in_place, base::BindOnce(&base::AtomicFlag::Set,
+                                         base::Unretained(&released))));
+
+  env.RunUntilIdle();
+  EXPECT_TRUE(deleted.IsSet());
+  EXPECT_TRUE(released.IsSet());
+}
+
 }  // namespace base
@@ -4,11 +4,84 @@
 
 #include "base/test/perf_log.h"
 
+#include <math.h>
+
+#include <algorithm>
+#include <map>
+#include <numeric>
+#include <utility>
+#include <vector>
+
+#include "base/cpu.h"
 #include "base/files/file_util.h"
+#include "base/json/json_reader.h"
+#include "base/json/json_writer.h"
+#include "base/logging.h"
+#include "base/no_destructor.h"
 #include "base/notreached.h"
+#include "base/strings/string_piece.h"
+#include "base/strings/string_util.h"
+#include "base/strings/stringprintf.h"
+#include "base/system/sys_info.h"
+#include "base/values.h"
 
 namespace base {
 
+namespace {
+
+struct PerfMetric {
+  std::string units;
+  std::vector<double> values;
+};
+
+std::map<std::string, PerfMetric>& GetPerfMetrics() {
+  static NoDestructor<std::map<std::string, PerfMetric>> metrics;
+  return *metrics;
+}
+
+std::string GetCompilerDescription() {
+#if defined(__clang__)
+  return "clang " __clang_version__;
+#elif defined(__GNUC__)
+  return "gcc " __VERSION__;
+#elif defined(_MSC_FULL_VER)
+  return StringPrintf("msvc %d", _MSC_FULL_VER);
+#else
+  return "unknown";
+#endif
+}
+
+// Whether a bigger value is better for a metric in |units|: the rates, like
+// "runs/s", "tasks/ms" or "bytesPerSecond", but not the times per operation,
+// like "ns / iteration".
+bool IsBiggerBetter(StringPiece units) {
+  if (EndsWith(units, "PerSecond", CompareCase::SENSITIVE))
+    return true;
+  const size_t slash = units.rfind('/');
+  if (slash == StringPiece::npos)
+    return false;
+  const StringPiece denominator =
+      TrimWhitespaceASCII(units.substr(slash + 1), TRIM_ALL);
+  return denominator == "s" || denominator == "ms" || denominator == "us" ||
+         denominator == "ns";
+}
+
+absl::optional<Value::Dict> ReadPerfResults(const FilePath& path) {
+  std::string json;
+  if (!ReadFileToString(path, &json)) {
+    LOG(ERROR) << "Couldn't read " << path;
+    return absl::nullopt;
+  }
+  absl::optional<Value> value = JSONReader::Read(json);
+  if (!value || !value->is_dict() || !value->GetDict().FindDict("results")) {
+    LOG(ERROR) << "Couldn't parse " << path;
+    return absl::nullopt;
+  }
+  return std::move(*value->GetDict().FindDict("results"));
+}
+
+}  // namespace
+
 static FILE* perf_log_file = nullptr;
 
 bool InitPerfLog(const FilePath& log_file) {
@@ -37,9 +110,114 @@ void LogPerfResult(const char* test_name, double value, const char* units) {
     return;
   }
 
-  fprintf(perf_log_file, "%s\t%g\t%s\n", test_name, value, units);
+  RecordPerfResult(test_name, value, units);
   printf("%s\t%g\t%s\n", test_name, value, units);
   fflush(stdout);
 }
 
+void RecordPerfResult(const std::string& metric_name,
+                      double value,
+                      const std::string& units) {
+  if (!perf_log_file)
+    return;
+
+  fprintf(perf_log_file, "%s\t%g\t%s\n", metric_name.c_str(), value,
+          units.c_str());
+  PerfMetric& metric = GetPerfMetrics()[metric_name];
+  metric.units = units;
+  metric.values.push_back(value);
+}
+
+bool WritePerfResultsAsJSON(const FilePath& path, int repetitions) {
+  Value::Dict metadata;
+  metadata.Set("cpu", CPU().cpu_brand());
+  metadata.Set("processors", SysInfo::NumberOfProcessors());
+  metadata.Set("os", SysInfo::OperatingSystemName() + " " +
+                         SysInfo::OperatingSystemVersion());
+  metadata.Set("compiler", GetCompilerDescription());
+#if defined(NDEBUG)
+  metadata.Set("build", "release");
+#else
+  metadata.Set("build", "debug");
+#endif
+  metadata.Set("repetitions", repetitions);
+
+  Value::Dict results;
+  for (const auto& [name, metric] : GetPerfMetrics()) {
+    std::vector<double> values = metric.values;
+    std::sort(values.begin(), values.end());
+    const size_t count = values.size();
+    const double median = count % 2 ? values[count / 2]
+                                    : (values[count / 2 - 1] +
+                                       values[count / 2]) / 2;
+    const double mean =
+        std::accumulate(values.begin(), values.end(), 0.0) / count;
+    double variance = 0;
+    for (double value : values)
+      variance += (value - mean) * (value - mean);
+    // The sample standard deviation, as the values are a sample of the runs.
+    const double stddev = count > 1 ? sqrt(variance / (count - 1)) : 0;
+
+    Value::Dict result;
+    result.Set("units", metric.units);
+    result.Set("count", static_cast<int>(count));
+    result.Set("median", median);
+    result.Set("mean", mean);
+    result.Set("stddev", stddev);
+    result.Set("min", values.front());
+    result.Set("max", values.back());
+    results.Set(name, std::move(result));
+  }
+
+  Value::Dict root;
+  root.Set("metadata", std::move(metadata));
+  root.Set("results", std::move(results));
+  std::string json;
+  return JSONWriter::WriteWithOptions(root, JSONWriter::OPTIONS_PRETTY_PRINT,
+                                      &json) &&
+         WriteFile(path, json);
+}
+
+int ComparePerfResults(const FilePath& baseline_path,
+                       const FilePath& current_path,
+                       double threshold,
+                       std::string* report) {
+  absl::optional<Value::Dict> baseline = ReadPerfResults(baseline_path);
+  absl::optional<Value::Dict> current = ReadPerfResults(current_path);
+  if (!baseline || !current)
+    return -1;
+
+  int regressions = 0;
+  for (const auto [name, current_value] : *current) {
+    const Value::Dict* baseline_result = baseline->FindDict(name);
+    const Value::Dict* current_result = current_value.GetIfDict();
+    if (!baseline_result || !current_result)
+      continue;
+    const absl::optional<double> baseline_median =
+        baseline_result->FindDouble("median");
+    const absl::optional<double> current_median =
+        current_result->FindDouble("median");
+    const std::string* units = current_result->FindString("units");
+    if (!baseline_median || !current_median || !units || !*baseline_median)
+      continue;
+
+    const double change =
+        (*current_median - *baseline_median) / fabs(*baseline_median);
+    const double noise = baseline_result->FindDouble("stddev").value_or(0) +
+                         current_result->FindDouble("stddev").value_or(0);
+    if (fabs(change) <= threshold ||
+        fabs(*current_median - *baseline_median) <= noise) {
+      continue;
+    }
+    const bool regressed = IsBiggerBetter(*units) ? change < 0 : change > 0;
+    if (regressed)
+      ++regressions;
+    StringAppendF(report, "%s %s: %g -> %g %s (%+.1f%%)\n",
+                  regressed ? "REGRESSION" : "improvement", name.c_str(),
+                  *baseline_median, *current_median, units->c_str(),
+                  change * 100);
+  }
+  return regressions;
+}
+
 }  // namespace base
@@ -5,6 +5,8 @@
 #ifndef BASE_TEST_PERF_LOG_H_
 #define BASE_TEST_PERF_LOG_H_
 
+#include <string>
+
 namespace base {
 
 class FilePath;
@@ -19,6 +21,35 @@ void FinalizePerfLog();
 // named 'test'. The units are to aid in reading the log by people.
 void LogPerfResult(const char* test_name, double value, const char* units);
 
+// Writes the given |value| of the metric |metric_name| to the perf result log,
+// like LogPerfResult() but without printing it, and keeps it for
+// WritePerfResultsAsJSON(). Does nothing if the log isn't initialized, so that
+// the perf tests which report through perf_test::PrintResult() can run in any
+// test runner.
+void RecordPerfResult(const std::string& metric_name,
+                      double value,
+                      const std::string& units);
+
+// Writes the metrics recorded since InitPerfLog() to |path| as JSON: the
+// median, mean, standard deviation, minimum and maximum of the values of each
+// (one value per repetition of the tests, usually), and a description of the
+// machine and of the build, with the CPU model, the compiler and
+// |repetitions|. Returns true on success.
+bool WritePerfResultsAsJSON(const FilePath& path, int repetitions);
+
+// Compares the metrics of |current_path| against those of |baseline_path|,
+// both written by WritePerfResultsAsJSON(), and appends a line to |*report|
+// for each metric whose median got worse or better by more than |threshold|,
+// a fraction of the baseline median, and by more than the sum of the two
+// standard deviations, so that noisy metrics need repetitions to be flagged.
+// A bigger value is better for the rates, e.g. "runs/s", and worse for the
+// other units. Returns the number of regressions, or -1 if a file can't be
+// read.
+int ComparePerfResults(const FilePath& baseline_path,
+                       const FilePath& current_path,
+                       double threshold,
+                       std::string* report);
+
 }  // namespace base
 
 #endif  // BASE_TEST_PERF_LOG_H_
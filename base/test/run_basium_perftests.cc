@@ -0,0 +1,122 @@
+// Copyright 2022 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+// The runner of basium_perftests. Unlike run_all_perftests.cc, it doesn't
+// depend on base::TestSuite and the test launcher, which basium doesn't build.
+//
+// Runs the perf tests and writes their results to the perf log, like
+// PerfTestSuite, and with these switches:
+//
+//   --perf-repetitions=N  Runs the tests N times, like --gtest_repeat.
+//   --perf-json=PATH      Writes the statistics of the results of the
+//                         repetitions to PATH as JSON.
+//
+// Or compares two result files, without running the tests, and exits with 1
+// if there is a regression:
+//
+//   --compare-perf-results=BASELINE,CURRENT
+//   --regression-threshold=PERCENT (5 by default)
+
+#include <stdio.h>
+
+#include <string>
+#include <vector>
+
+#include "base/at_exit.h"
+#include "base/check.h"
+#include "base/command_line.h"
+#include "base/debug/debugger.h"
+#include "base/files/file_path.h"
+#include "base/i18n/icu_util.h"
+#include "base/path_service.h"
+#include "base/process/launch.h"
+#include "base/strings/string_number_conversions.h"
+#include "base/strings/string_split.h"
+#include "base/test/perf_log.h"
+#include "testing/gtest/include/gtest/gtest.h"
+
+namespace {
+
+constexpr char kComparePerfResultsSwitch[] = "compare-perf-results";
+constexpr char kLogFileSwitch[] = "log-file";
+constexpr char kPerfJsonSwitch[] = "perf-json";
+constexpr char kPerfRepetitionsSwitch[] = "perf-repetitions";
+constexpr char kRegressionThresholdSwitch[] = "regression-threshold";
+
+constexpr double kDefaultRegressionThresholdPercent = 5;
+
+int ComparePerfResults(const base::CommandLine& command_line) {
+  const std::vector<base::CommandLine::StringType> paths =
+      base::SplitString(command_line.GetSwitchValueNative(
+                            kComparePerfResultsSwitch),
+                        FILE_PATH_LITERAL(","), base::TRIM_WHITESPACE,
+                        base::SPLIT_WANT_NONEMPTY);
+  double threshold = kDefaultRegressionThresholdPercent;
+  if (paths.size() != 2 ||
+      (command_line.HasSwitch(kRegressionThresholdSwitch) &&
+       !base::StringToDouble(
+           command_line.GetSwitchValueASCII(kRegressionThresholdSwitch),
+           &threshold))) {
+    fprintf(stderr,
+            "Usage: --%s=BASELINE,CURRENT [--%s=PERCENT]\n",
+            kComparePerfResultsSwitch, kRegressionThresholdSwitch);
+    return 2;
+  }
+
+  std::string report;
+  const int regressions =
+      base::ComparePerfResults(base::FilePath(paths[0]),
+                               base::FilePath(paths[1]), threshold / 100,
+                               &report);
+  if (regressions < 0)
+    return 2;
+  printf("%s%d regression(s) above %g%%\n", report.c_str(), regressions,
+         threshold);
+  return regressions ? 1 : 0;
+}
+
+}  // namespace
+
+int main(int argc, char** argv) {
+  base::AtExitManager at_exit;
+  testing::InitGoogleTest(&argc, argv);
+  base::CommandLine::Init(argc, argv);
+  const base::CommandLine& command_line =
+      *base::CommandLine::ForCurrentProcess();
+
+  if (command_line.HasSwitch(kComparePerfResultsSwitch))
+    return ComparePerfResults(command_line);
+
+  if (command_line.HasSwitch(kPerfRepetitionsSwitch)) {
+    int repetitions;
+    CHECK(base::StringToInt(
+              command_line.GetSwitchValueASCII(kPerfRepetitionsSwitch),
+              &repetitions) &&
+          repetitions > 0);
+    GTEST_FLAG_SET(repeat, repetitions);
+  }
+
+  base::FilePath log_path = command_line.GetSwitchValuePath(kLogFileSwitch);
+  if (log_path.empty()) {
+    base::PathService::Get(base::FILE_EXE, &log_path);
+    log_path = log_path.ReplaceExtension(FILE_PATH_LITERAL("log"));
+    log_path = log_path.InsertBeforeExtension(FILE_PATH_LITERAL("_perf"));
+  }
+  CHECK(base::InitPerfLog(log_path));
+  CHECK(base::i18n::InitializeICU());
+
+  // Raise to high priority to have more precise measurements. Since we don't
+  // aim at 1% precision, it is not necessary to run at realtime level.
+  if (!base::debug::BeingDebugged())
+    base::RaiseProcessToHighPriority();
+
+  const int result = RUN_ALL_TESTS();
+
+  const base::FilePath json_path =
+      command_line.GetSwitchValuePath(kPerfJsonSwitch);
+  if (!json_path.empty())
+    CHECK(base::WritePerfResultsAsJSON(json_path, GTEST_FLAG_GET(repeat)));
+  base::FinalizePerfLog();
+  return result;
+}
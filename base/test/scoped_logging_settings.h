@@ -41,6 +41,9 @@ class BASE_EXPORT ScopedLoggingSettings {
 #endif  // BUILDFLAG(IS_CHROMEOS)
 
   std::unique_ptr<base::FilePath::StringType> log_file_name_;
+#if BUILDFLAG(IS_POSIX) && !BUILDFLAG(IS_NACL)
+  const bool async_file_writes_;
+#endif
 
   const bool enable_process_id_;
   const bool enable_thread_id_;
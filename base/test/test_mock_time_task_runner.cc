@@ -55,6 +55,11 @@ class TestMockTimeTaskRunner::NonOwningProxyTaskRunner
     return thread_checker_.CalledOnValidThread();
   }
 
+  bool CanRunTaskInlineInCurrentSequence() const override {
+    AutoLock scoped_lock(lock_);
+    return target_ && target_->CanRunTaskInlineInCurrentSequence();
+  }
+
   bool PostDelayedTask(const Location& from_here,
                        OnceClosure task,
                        TimeDelta delay) override {
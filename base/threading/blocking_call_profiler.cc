@@ -0,0 +1,304 @@
+// Copyright 2022 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "base/threading/blocking_call_profiler.h"
+
+#include <algorithm>
+#include <map>
+#include <memory>
+#include <new>
+#include <utility>
+
+#include "base/bits.h"
+#include "base/check_op.h"
+#include "base/hash/hash.h"
+#include "base/no_destructor.h"
+#include "base/synchronization/lock.h"
+#include "base/thread_annotations.h"
+#include "base/threading/scoped_blocking_call.h"
+#include "base/threading/thread_local_storage.h"
+#include "base/trace_event/base_tracing.h"
+
+namespace base {
+
+namespace {
+
+// Must be a power of 2.
+constexpr size_t kNumSlotsPerThread = 64;
+
+size_t GetBucketIndex(TimeDelta duration) {
+  const int64_t us = duration.InMicroseconds();
+  if (us <= 0)
+    return 0;
+  const uint32_t clamped_us =
+      static_cast<uint32_t>(std::min<int64_t>(us, int64_t{1} << 30));
+  return std::min<size_t>(bits::Log2Floor(clamped_us) + 1,
+                          BlockingCallProfiler::kNumBuckets - 1);
+}
+
+// The calls recorded by one thread at a time. Only the thread that owns the
+// table writes to it, so updates are plain relaxed loads and stores rather
+// than read-modify-writes; readers may see an entry whose fields are from
+// slightly different calls, which is fine for a profile.
+class ThreadData {
+ public:
+  ThreadData() = default;
+  ThreadData(const ThreadData&) = delete;
+  ThreadData& operator=(const ThreadData&) = delete;
+
+  void Record(const Location& from_here,
+              BlockingType blocking_type,
+              bool on_worker,
+              TimeDelta duration) {
+    Slot* slot = FindOrAddSlot(from_here, blocking_type);
+    if (!slot) {
+      Increment(dropped_count_);
+      return;
+    }
+    Increment(slot->count);
+    if (on_worker)
+      Increment(slot->worker_count);
+    const int64_t us = duration.InMicroseconds();
+    slot->total_us.store(slot->total_us.load(std::memory_order_relaxed) + us,
+                         std::memory_order_relaxed);
+    if (us > slot->max_us.load(std::memory_order_relaxed))
+      slot->max_us.store(us, std::memory_order_relaxed);
+    Increment(slot->histogram[GetBucketIndex(duration)]);
+  }
+
+  // Adds this table's entries to |entries|, keyed by program counter and
+  // BlockingType.
+  void AddTo(std::map<std::pair<const void*, BlockingType>,
+                      BlockingCallProfiler::Entry>& entries) const {
+    for (const Slot& slot : slots_) {
+      if (!slot.in_use.load(std::memory_order_acquire))
+        continue;
+      BlockingCallProfiler::Entry& entry =
+          entries[{slot.location.program_counter(), slot.blocking_type}];
+      entry.location = slot.location;
+      entry.blocking_type = slot.blocking_type;
+      entry.count += slot.count.load(std::memory_order_relaxed);
+      entry.worker_count += slot.worker_count.load(std::memory_order_relaxed);
+      entry.total_duration +=
+          Microseconds(slot.total_us.load(std::memory_order_relaxed));
+      entry.max_duration = std::max(
+          entry.max_duration,
+          Microseconds(slot.max_us.load(std::memory_order_relaxed)));
+      for (size_t i = 0; i < BlockingCallProfiler::kNumBuckets; ++i)
+        entry.histogram[i] += slot.histogram[i].load(std::memory_order_relaxed);
+    }
+  }
+
+  uint64_t dropped_count() const {
+    return dropped_count_.load(std::memory_order_relaxed);
+  }
+
+  // Guarded by the Registry's lock.
+  bool in_use = false;
+
+ private:
+  struct Slot {
+    // Set with release semantics once |location| and |blocking_type| are
+    // written; they never change after that.
+    std::atomic<bool> in_use{false};
+    Location location;
+    BlockingType blocking_type{};
+
+    std::atomic<uint64_t> count{0};
+    std::atomic<uint64_t> worker_count{0};
+    std::atomic<int64_t> total_us{0};
+    std::atomic<int64_t> max_us{0};
+    std::atomic<uint64_t> histogram[BlockingCallProfiler::kNumBuckets] = {};
+  };
+
+  static void Increment(std::atomic<uint64_t>& value) {
+    value.store(value.load(std::memory_order_relaxed) + 1,
+                std::memory_order_relaxed);
+  }
+
+  Slot* FindOrAddSlot(const Location& from_here, BlockingType blocking_type) {
+    const size_t hash =
+        HashInts(reinterpret_cast<uintptr_t>(from_here.program_counter()),
+                 static_cast<uint32_t>(blocking_type));
+    for (size_t probe = 0; probe < kNumSlotsPerThread; ++probe) {
+      Slot& slot = slots_[(hash + probe) & (kNumSlotsPerThread - 1)];
+      if (!slot.in_use.load(std::memory_order_relaxed)) {
+        slot.location = from_here;
+        slot.blocking_type = blocking_type;
+        slot.in_use.store(true, std::memory_order_release);
+        return &slot;
+      }
+      if (slot.location == from_here && slot.blocking_type == blocking_type)
+        return &slot;
+    }
+    return nullptr;
+  }
+
+  Slot slots_[kNumSlotsPerThread];
+  std::atomic<uint64_t> dropped_count_{0};
+};
+
+// Every ThreadData ever created. They are never deleted; a thread that exits
+// gives its ThreadData back for the next thread to claim.
+class Registry {
+ public:
+  ThreadData* Claim() {
+    AutoLock auto_lock(lock_);
+    for (auto& thread_data : thread_data_) {
+      if (!thread_data->in_use) {
+        thread_data->in_use = true;
+        return thread_data.get();
+      }
+    }
+    thread_data_.push_back(std::make_unique<ThreadData>());
+    thread_data_.back()->in_use = true;
+    return thread_data_.back().get();
+  }
+
+  void Release(ThreadData* thread_data) {
+    AutoLock auto_lock(lock_);
+    DCHECK(thread_data->in_use);
+    thread_data->in_use = false;
+  }
+
+  template <typename Function>
+  void ForEach(Function function) {
+    AutoLock auto_lock(lock_);
+    for (const auto& thread_data : thread_data_)
+      function(*thread_data);
+  }
+
+  // Empties every table in place, so threads keep the table they own. Racing
+  // with the owner's writes is a data race, which is why this is only for
+  // testing.
+  void ResetForTesting() {
+    AutoLock auto_lock(lock_);
+    for (auto& thread_data : thread_data_) {
+      const bool in_use = thread_data->in_use;
+      thread_data->~ThreadData();
+      new (thread_data.get()) ThreadData();
+      thread_data->in_use = in_use;
+    }
+  }
+
+ private:
+  Lock lock_;
+  std::vector<std::unique_ptr<ThreadData>> thread_data_ GUARDED_BY(lock_);
+};
+
+Registry& GetRegistry() {
+  static NoDestructor<Registry> registry;
+  return *registry;
+}
+
+void ReleaseThreadData(void* thread_data) {
+  GetRegistry().Release(static_cast<ThreadData*>(thread_data));
+}
+
+ThreadData* GetThreadDataForCurrentThread() {
+  static NoDestructor<ThreadLocalStorage::Slot> tls_thread_data(
+      &ReleaseThreadData);
+  ThreadData* thread_data = static_cast<ThreadData*>(tls_thread_data->Get());
+  if (!thread_data) {
+    thread_data = GetRegistry().Claim();
+    tls_thread_data->Set(thread_data);
+  }
+  return thread_data;
+}
+
+}  // namespace
+
+// static
+std::atomic<bool> BlockingCallProfiler::enabled_{false};
+
+BlockingCallProfiler::Entry::Entry() = default;
+BlockingCallProfiler::Entry::Entry(const Entry& other) = default;
+BlockingCallProfiler::Entry& BlockingCallProfiler::Entry::operator=(
+    const Entry& other) = default;
+BlockingCallProfiler::Entry::~Entry() = default;
+
+// static
+void BlockingCallProfiler::Enable() {
+  enabled_.store(true, std::memory_order_relaxed);
+}
+
+// static
+void BlockingCallProfiler::Disable() {
+  enabled_.store(false, std::memory_order_relaxed);
+}
+
+// static
+std::vector<BlockingCallProfiler::Entry>
+BlockingCallProfiler::GetWorstOffenders(size_t max_entries) {
+  std::map<std::pair<const void*, BlockingType>, Entry> merged;
+  GetRegistry().ForEach(
+      [&merged](const ThreadData& thread_data) { thread_data.AddTo(merged); });
+
+  std::vector<Entry> entries;
+  entries.reserve(merged.size());
+  for (auto& key_and_entry : merged)
+    entries.push_back(std::move(key_and_entry.second));
+
+  const size_t num_entries = std::min(max_entries, entries.size());
+  std::partial_sort(entries.begin(), entries.begin() + num_entries,
+                    entries.end(), [](const Entry& a, const Entry& b) {
+                      return a.total_duration > b.total_duration;
+                    });
+  entries.resize(num_entries);
+  return entries;
+}
+
+// static
+void BlockingCallProfiler::TraceWorstOffenders(size_t max_entries) {
+  for (const Entry& entry : GetWorstOffenders(max_entries)) {
+    TRACE_EVENT_INSTANT(
+        "base", "BlockingCallProfiler::Offender", "location", entry.location,
+        "will_block", entry.blocking_type == BlockingType::WILL_BLOCK, "count",
+        entry.count, "worker_count", entry.worker_count, "total_us",
+        entry.total_duration.InMicroseconds(), "max_us",
+        entry.max_duration.InMicroseconds());
+  }
+}
+
+// static
+uint64_t BlockingCallProfiler::GetDroppedCount() {
+  uint64_t dropped_count = 0;
+  GetRegistry().ForEach([&dropped_count](const ThreadData& thread_data) {
+    dropped_count += thread_data.dropped_count();
+  });
+  return dropped_count;
+}
+
+// static
+TimeDelta BlockingCallProfiler::GetBucketMinDuration(size_t bucket) {
+  DCHECK_LT(bucket, kNumBuckets);
+  return bucket == 0 ? TimeDelta() : Microseconds(int64_t{1} << (bucket - 1));
+}
+
+// static
+void BlockingCallProfiler::ResetForTesting() {
+  Disable();
+  GetRegistry().ResetForTesting();
+}
+
+namespace internal {
+
+ScopedProfiledBlockingCall::ScopedProfiledBlockingCall(
+    const Location& from_here,
+    BlockingType blocking_type,
+    bool on_worker)
+    : from_here_(from_here),
+      blocking_type_(blocking_type),
+      on_worker_(on_worker),
+      start_(TimeTicks::Now()) {}
+
+ScopedProfiledBlockingCall::~ScopedProfiledBlockingCall() {
+  const TimeDelta duration = TimeTicks::Now() - start_;
+  GetThreadDataForCurrentThread()->Record(from_here_, blocking_type_,
+                                          on_worker_, duration);
+}
+
+}  // namespace internal
+
+}  // namespace base
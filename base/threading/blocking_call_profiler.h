@@ -0,0 +1,129 @@
+// Copyright 2022 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#ifndef BASE_THREADING_BLOCKING_CALL_PROFILER_H_
+#define BASE_THREADING_BLOCKING_CALL_PROFILER_H_
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include <array>
+#include <atomic>
+#include <vector>
+
+#include "base/base_export.h"
+#include "base/location.h"
+#include "base/time/time.h"
+
+namespace base {
+
+// Forward-declared to break the cycle with scoped_blocking_call.h. An opaque
+// enum declaration is a complete type.
+enum class BlockingType;
+
+// BlockingCallProfiler records how long threads block in ScopedBlockingCalls,
+// and where. It is off by default; while it is on, every outermost
+// ScopedBlockingCall records its Location, BlockingType and duration when it
+// ends. Nested ScopedBlockingCalls are part of the outer call's duration and
+// are not recorded separately.
+//
+// Each thread records into its own fixed-size table, with relaxed atomic
+// stores and no lock, so profiling adds two TimeTicks::Now() calls and a hash
+// probe to each blocking call. A thread's table is handed to the next thread
+// that blocks once it exits, so the number of tables is bounded by the peak
+// number of threads that blocked at once.
+//
+// The per-call-site totals are merged on demand, by GetWorstOffenders() or by
+// TraceWorstOffenders(). Calls made on ThreadPool workers are counted apart in
+// Entry::worker_count: those are the ones that make ThreadGroupImpl add a
+// worker to compensate, immediately for WILL_BLOCK, and after its
+// may_block_threshold (1 second for foreground groups) for MAY_BLOCK.
+class BASE_EXPORT BlockingCallProfiler {
+ public:
+  // Bucket 0 counts calls shorter than 1 us. Bucket i > 0 counts calls that
+  // lasted [2^(i-1), 2^i) us, except the last, which has no upper bound
+  // (calls of 4.2 seconds or more).
+  static constexpr size_t kNumBuckets = 24;
+
+  // Calls from the same Location with the same BlockingType, across all
+  // threads.
+  struct BASE_EXPORT Entry {
+    Entry();
+    Entry(const Entry& other);
+    Entry& operator=(const Entry& other);
+    ~Entry();
+
+    Location location;
+    BlockingType blocking_type{};
+    uint64_t count = 0;
+    // The subset of |count| made on threads with a BlockingObserver, i.e.
+    // ThreadPool workers.
+    uint64_t worker_count = 0;
+    TimeDelta total_duration;
+    TimeDelta max_duration;
+    std::array<uint64_t, kNumBuckets> histogram = {};
+  };
+
+  BlockingCallProfiler() = delete;
+
+  // Starts or stops recording. Calls in progress when profiling starts are not
+  // recorded. Data recorded so far is kept across Disable() and Enable().
+  static void Enable();
+  static void Disable();
+  static bool IsEnabled() {
+    return enabled_.load(std::memory_order_relaxed);
+  }
+
+  // Returns up to |max_entries| call sites, in decreasing order of total time
+  // blocked.
+  static std::vector<Entry> GetWorstOffenders(size_t max_entries);
+
+  // Emits GetWorstOffenders(|max_entries|) to the trace, as one instant event
+  // per call site in the "base" category.
+  static void TraceWorstOffenders(size_t max_entries);
+
+  // Returns the number of calls that were not recorded because their thread's
+  // table was full.
+  static uint64_t GetDroppedCount();
+
+  // Returns the shortest duration counted in |bucket|.
+  static TimeDelta GetBucketMinDuration(size_t bucket);
+
+  // Disables profiling and forgets all recorded data. Must not race with a
+  // blocking call ending.
+  static void ResetForTesting();
+
+ private:
+  static std::atomic<bool> enabled_;
+};
+
+namespace internal {
+
+// Held by the outermost UncheckedScopedBlockingCall on a thread while
+// profiling is enabled. Records the call into the BlockingCallProfiler when it
+// is destroyed.
+class BASE_EXPORT ScopedProfiledBlockingCall {
+ public:
+  ScopedProfiledBlockingCall(const Location& from_here,
+                             BlockingType blocking_type,
+                             bool on_worker);
+
+  ScopedProfiledBlockingCall(const ScopedProfiledBlockingCall&) = delete;
+  ScopedProfiledBlockingCall& operator=(const ScopedProfiledBlockingCall&) =
+      delete;
+
+  ~ScopedProfiledBlockingCall();
+
+ private:
+  const Location from_here_;
+  const BlockingType blocking_type_;
+  const bool on_worker_;
+  const TimeTicks start_;
+};
+
+}  // namespace internal
+
+}  // namespace base
+
+#endif  // BASE_THREADING_BLOCKING_CALL_PROFILER_H_
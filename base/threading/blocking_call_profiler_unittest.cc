@@ -0,0 +1,181 @@
+// Copyright 2022 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "base/threading/blocking_call_profiler.h"
+
+#include <memory>
+#include <vector>
+
+#include "base/ranges/algorithm.h"
+#include "base/threading/platform_thread.h"
+#include "base/threading/scoped_blocking_call.h"
+#include "base/threading/scoped_blocking_call_internal.h"
+#include "base/threading/simple_thread.h"
+#include "testing/gtest/include/gtest/gtest.h"
+
+namespace base {
+
+namespace {
+
+class NoopBlockingObserver : public internal::BlockingObserver {
+ public:
+  void BlockingStarted(BlockingType blocking_type) override {}
+  void BlockingTypeUpgraded() override {}
+  void BlockingEnded() override {}
+};
+
+class BlockingCallProfilerTest : public testing::Test {
+ protected:
+  BlockingCallProfilerTest() {
+    BlockingCallProfiler::ResetForTesting();
+    BlockingCallProfiler::Enable();
+  }
+
+  ~BlockingCallProfilerTest() override {
+    BlockingCallProfiler::ResetForTesting();
+  }
+};
+
+}  // namespace
+
+TEST_F(BlockingCallProfilerTest, RecordsOutermostCallOnly) {
+  const Location outer = FROM_HERE;
+  {
+    ScopedBlockingCall scoped_blocking_call(outer, BlockingType::MAY_BLOCK);
+    ScopedBlockingCall nested_scoped_blocking_call(FROM_HERE,
+                                                   BlockingType::WILL_BLOCK);
+  }
+
+  std::vector<BlockingCallProfiler::Entry> entries =
+      BlockingCallProfiler::GetWorstOffenders(10);
+  ASSERT_EQ(1U, entries.size());
+  EXPECT_EQ(outer, entries[0].location);
+  EXPECT_EQ(BlockingType::MAY_BLOCK, entries[0].blocking_type);
+  EXPECT_EQ(1U, entries[0].count);
+  EXPECT_EQ(0U, entries[0].worker_count);
+}
+
+TEST_F(BlockingCallProfilerTest, NothingRecordedWhileDisabled) {
+  BlockingCallProfiler::Disable();
+  {
+    ScopedBlockingCall scoped_blocking_call(FROM_HERE,
+                                            BlockingType::MAY_BLOCK);
+  }
+  EXPECT_TRUE(BlockingCallProfiler::GetWorstOffenders(10).empty());
+}
+
+TEST_F(BlockingCallProfilerTest, BlockingTypesAreRecordedApart) {
+  for (BlockingType blocking_type :
+       {BlockingType::MAY_BLOCK, BlockingType::WILL_BLOCK,
+        BlockingType::WILL_BLOCK}) {
+    ScopedBlockingCall scoped_blocking_call(FROM_HERE, blocking_type);
+  }
+
+  std::vector<BlockingCallProfiler::Entry> entries =
+      BlockingCallProfiler::GetWorstOffenders(10);
+  ASSERT_EQ(2U, entries.size());
+  uint64_t total_count = 0;
+  for (const auto& entry : entries) {
+    EXPECT_EQ(entry.blocking_type == BlockingType::WILL_BLOCK ? 2U : 1U,
+              entry.count);
+    total_count += entry.count;
+  }
+  EXPECT_EQ(3U, total_count);
+}
+
+TEST_F(BlockingCallProfilerTest, SortedByTotalDuration) {
+  const Location short_call = FROM_HERE;
+  const Location long_call = FROM_HERE;
+  for (int i = 0; i < 3; ++i) {
+    ScopedBlockingCall scoped_blocking_call(short_call,
+                                            BlockingType::MAY_BLOCK);
+  }
+  {
+    ScopedBlockingCall scoped_blocking_call(long_call, BlockingType::MAY_BLOCK);
+    PlatformThread::Sleep(Milliseconds(5));
+  }
+
+  std::vector<BlockingCallProfiler::Entry> entries =
+      BlockingCallProfiler::GetWorstOffenders(10);
+  ASSERT_EQ(2U, entries.size());
+  EXPECT_EQ(long_call, entries[0].location);
+  EXPECT_GE(entries[0].total_duration, Milliseconds(5));
+  EXPECT_EQ(entries[0].total_duration, entries[0].max_duration);
+  EXPECT_EQ(short_call, entries[1].location);
+  EXPECT_EQ(3U, entries[1].count);
+
+  // The 5 ms call lands in the bucket that starts at 4096 us or later.
+  uint64_t long_bucket_count = 0;
+  for (size_t i = 0; i < BlockingCallProfiler::kNumBuckets; ++i) {
+    if (BlockingCallProfiler::GetBucketMinDuration(i) >= Microseconds(4096))
+      long_bucket_count += entries[0].histogram[i];
+  }
+  EXPECT_EQ(1U, long_bucket_count);
+
+  entries = BlockingCallProfiler::GetWorstOffenders(1);
+  ASSERT_EQ(1U, entries.size());
+  EXPECT_EQ(long_call, entries[0].location);
+}
+
+TEST_F(BlockingCallProfilerTest, CountsCallsOnObservedThreads) {
+  NoopBlockingObserver observer;
+  internal::SetBlockingObserverForCurrentThread(&observer);
+  {
+    ScopedBlockingCall scoped_blocking_call(FROM_HERE,
+                                            BlockingType::MAY_BLOCK);
+  }
+  internal::ClearBlockingObserverForCurrentThread();
+
+  std::vector<BlockingCallProfiler::Entry> entries =
+      BlockingCallProfiler::GetWorstOffenders(10);
+  ASSERT_EQ(1U, entries.size());
+  EXPECT_EQ(1U, entries[0].count);
+  EXPECT_EQ(1U, entries[0].worker_count);
+}
+
+// Calls made on threads that have exited are still reported, and the same
+// call site on several threads is merged into one entry. Starting and joining
+// the threads blocks too, so other entries are ignored.
+TEST_F(BlockingCallProfilerTest, MergesThreads) {
+  constexpr int kNumThreads = 4;
+  const Location location = FROM_HERE;
+  std::vector<std::unique_ptr<DelegateSimpleThread>> threads;
+  class Delegate : public DelegateSimpleThread::Delegate {
+   public:
+    explicit Delegate(const Location& location) : location_(location) {}
+    void Run() override {
+      ScopedBlockingCall scoped_blocking_call(location_,
+                                              BlockingType::WILL_BLOCK);
+    }
+
+   private:
+    const Location location_;
+  } delegate(location);
+  for (int i = 0; i < kNumThreads; ++i) {
+    threads.push_back(std::make_unique<DelegateSimpleThread>(
+        &delegate, "BlockingCallProfilerTest"));
+    threads.back()->Start();
+  }
+  for (auto& thread : threads)
+    thread->Join();
+
+  std::vector<BlockingCallProfiler::Entry> entries =
+      BlockingCallProfiler::GetWorstOffenders(100);
+  auto it = ranges::find(entries, location,
+                         &BlockingCallProfiler::Entry::location);
+  ASSERT_NE(it, entries.end());
+  EXPECT_EQ(BlockingType::WILL_BLOCK, it->blocking_type);
+  EXPECT_EQ(static_cast<uint64_t>(kNumThreads), it->count);
+}
+
+TEST(BlockingCallProfilerBucketTest, BucketMinDurations) {
+  EXPECT_EQ(TimeDelta(), BlockingCallProfiler::GetBucketMinDuration(0));
+  EXPECT_EQ(Microseconds(1), BlockingCallProfiler::GetBucketMinDuration(1));
+  EXPECT_EQ(Microseconds(2), BlockingCallProfiler::GetBucketMinDuration(2));
+  EXPECT_EQ(Microseconds(1 << 22),
+            BlockingCallProfiler::GetBucketMinDuration(
+                BlockingCallProfiler::kNumBuckets - 1));
+}
+
+}  // namespace base
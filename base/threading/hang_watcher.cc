@@ -5,6 +5,7 @@
 #include "base/threading/hang_watcher.h"
 
 #include <atomic>
+#include <cinttypes>
 #include <utility>
 
 #include "base/bind.h"
@@ -12,16 +13,20 @@
 #include "base/containers/flat_map.h"
 #include "base/debug/alias.h"
 #include "base/debug/crash_logging.h"
+#include "base/debug/debugging_buildflags.h"
 #include "base/debug/dump_without_crashing.h"
 #include "base/debug/leak_annotations.h"
 #include "base/feature_list.h"
 #include "base/metrics/field_trial_params.h"
 #include "base/metrics/histogram_macros.h"
 #include "base/no_destructor.h"
+#include "base/profiler/stack_buffer.h"
 #include "base/ranges/algorithm.h"
 #include "base/strings/string_number_conversions.h"
+#include "base/strings/stringprintf.h"
 #include "base/synchronization/lock.h"
 #include "base/synchronization/waitable_event.h"
+#include "base/task/task_traits.h"
 #include "base/threading/platform_thread.h"
 #include "base/threading/thread_checker.h"
 #include "base/threading/thread_restrictions.h"
@@ -31,6 +36,18 @@
 #include "base/trace_event/base_tracing.h"
 #include "build/build_config.h"
 
+// The stacks of the hung threads are copied with StackCopierSignal and unwound
+// with the frame pointers.
+#if (BUILDFLAG(IS_LINUX) || BUILDFLAG(IS_CHROMEOS) || BUILDFLAG(IS_ANDROID)) && \
+    BUILDFLAG(CAN_UNWIND_WITH_FRAME_POINTERS)
+#include "base/debug/stack_trace.h"
+#include "base/profiler/register_context.h"
+#include "base/profiler/stack_copier_signal.h"
+#include "base/profiler/stack_sampler.h"
+#include "base/profiler/thread_delegate_posix.h"
+#define HANG_WATCHER_COPIES_HUNG_STACKS
+#endif
+
 namespace base {
 
 namespace {
@@ -51,9 +68,27 @@ std::atomic<LoggingLevel> g_threadpool_log_level{LoggingLevel::kNone};
 std::atomic<LoggingLevel> g_io_thread_log_level{LoggingLevel::kNone};
 std::atomic<LoggingLevel> g_main_thread_log_level{LoggingLevel::kNone};
 
+// The hang thresholds of the WatchHangsInScope::DeadlineClasses, overridden
+// through Finch.
+constexpr TimeDelta kDefaultComputeHangWatchTime = Seconds(10);
+constexpr TimeDelta kDefaultBlockingHangWatchTime = Seconds(30);
+std::atomic<TimeDelta> g_compute_hang_watch_time{kDefaultComputeHangWatchTime};
+std::atomic<TimeDelta> g_blocking_hang_watch_time{
+    kDefaultBlockingHangWatchTime};
+
 // Indicates whether HangWatcher::Run() should return after the next monitoring.
 std::atomic<bool> g_keep_monitoring{true};
 
+#if defined(HANG_WATCHER_COPIES_HUNG_STACKS)
+// The maximum number of frames kept from the stack of a hung thread.
+constexpr size_t kMaxHungThreadStackFrames = 64;
+
+class NoopStackCopierDelegate : public StackCopier::Delegate {
+ public:
+  void OnStackCopy() override {}
+};
+#endif
+
 // Emits the hung thread count histogram. |count| is the number of threads
 // of type |thread_type| that were hung or became hung during the last
 // monitoring window. This function should be invoked for each thread type
@@ -173,6 +208,14 @@ constexpr base::FeatureParam<int> kRendererProcessThreadPoolLogLevel{
     &kEnableHangWatcher, "renderer_process_threadpool_log_level",
     static_cast<int>(LoggingLevel::kUmaOnly)};
 
+// All processes.
+constexpr base::FeatureParam<base::TimeDelta> kComputeHangWatchTime{
+    &kEnableHangWatcher, "compute_hang_watch_time",
+    kDefaultComputeHangWatchTime};
+constexpr base::FeatureParam<base::TimeDelta> kBlockingHangWatchTime{
+    &kEnableHangWatcher, "blocking_hang_watch_time",
+    kDefaultBlockingHangWatchTime};
+
 // static
 const base::TimeDelta WatchHangsInScope::kDefaultHangWatchTime =
     base::Seconds(10);
@@ -215,24 +258,23 @@ WatchHangsInScope::WatchHangsInScope(TimeDelta timeout) {
   // and resuing the value.
 
   previous_deadline_ = old_deadline;
-  TimeTicks deadline = TimeTicks::Now() + timeout;
-  current_hang_watch_state->SetDeadline(deadline);
-  current_hang_watch_state->IncrementNestingLevel();
-
-  const bool hangs_ignored_for_current_scope =
-      internal::HangWatchDeadline::IsFlagSet(
-          internal::HangWatchDeadline::Flag::kIgnoreCurrentWatchHangsInScope,
-          old_flags);
 
   // If the current WatchHangsInScope is ignored, temporarily reactivate hang
   // watching for newly created WatchHangsInScopes. On exiting hang watching
   // is suspended again to return to the original state.
-  if (hangs_ignored_for_current_scope) {
-    current_hang_watch_state->UnsetIgnoreCurrentWatchHangsInScope();
-    set_hangs_ignored_on_exit_ = true;
-  }
+  set_hangs_ignored_on_exit_ = internal::HangWatchDeadline::IsFlagSet(
+      internal::HangWatchDeadline::Flag::kIgnoreCurrentWatchHangsInScope,
+      old_flags);
+
+  // Arming the deadline also clears the ignore flag, so that entering the scope
+  // is a single store.
+  current_hang_watch_state->ArmDeadline(TimeTicks::Now() + timeout);
+  current_hang_watch_state->IncrementNestingLevel();
 }
 
+WatchHangsInScope::WatchHangsInScope(DeadlineClass deadline_class)
+    : WatchHangsInScope(GetTimeout(deadline_class)) {}
+
 WatchHangsInScope::~WatchHangsInScope() {
   DCHECK_CALLED_ON_VALID_THREAD(thread_checker_);
 
@@ -287,6 +329,23 @@ WatchHangsInScope::~WatchHangsInScope() {
   current_hang_watch_state->DecrementNestingLevel();
 }
 
+// static
+TimeDelta WatchHangsInScope::GetTimeout(DeadlineClass deadline_class) {
+  switch (deadline_class) {
+    case DeadlineClass::kCompute:
+      return g_compute_hang_watch_time.load(std::memory_order_relaxed);
+    case DeadlineClass::kBlocking:
+      return g_blocking_hang_watch_time.load(std::memory_order_relaxed);
+  }
+}
+
+// static
+WatchHangsInScope::DeadlineClass
+WatchHangsInScope::GetDeadlineClassForTaskTraits(const TaskTraits& traits) {
+  return traits.may_block() ? DeadlineClass::kBlocking
+                            : DeadlineClass::kCompute;
+}
+
 // static
 void HangWatcher::InitializeOnMainThread(ProcessType process_type) {
   DCHECK(!g_use_hang_watcher);
@@ -312,6 +371,11 @@ void HangWatcher::InitializeOnMainThread(ProcessType process_type) {
   if (!enable_hang_watcher)
     return;
 
+  g_compute_hang_watch_time.store(kComputeHangWatchTime.Get(),
+                                  std::memory_order_relaxed);
+  g_blocking_hang_watch_time.store(kBlockingHangWatchTime.Get(),
+                                   std::memory_order_relaxed);
+
   // Retrieve thread-specific config for hang watching.
   switch (process_type) {
     case HangWatcher::ProcessType::kUnknownProcess:
@@ -360,6 +424,10 @@ void HangWatcher::UnitializeOnMainThreadForTesting() {
   g_threadpool_log_level.store(LoggingLevel::kNone, std::memory_order_relaxed);
   g_io_thread_log_level.store(LoggingLevel::kNone, std::memory_order_relaxed);
   g_main_thread_log_level.store(LoggingLevel::kNone, std::memory_order_relaxed);
+  g_compute_hang_watch_time.store(kDefaultComputeHangWatchTime,
+                                  std::memory_order_relaxed);
+  g_blocking_hang_watch_time.store(kDefaultBlockingHangWatchTime,
+                                   std::memory_order_relaxed);
 }
 
 // static
@@ -615,6 +683,15 @@ base::TimeTicks HangWatcher::WatchStateSnapShot::GetHighestDeadline() const {
   return hung_watch_state_copies_.back().deadline;
 }
 
+const HangWatcher::WatchStateSnapShot::WatchStateCopy&
+HangWatcher::WatchStateSnapShot::GetMostSevereHang() const {
+  DCHECK(IsActionable());
+
+  // Since entries are sorted in increasing order the first entry is the
+  // earliest deadline.
+  return hung_watch_state_copies_.front();
+}
+
 HangWatcher::WatchStateSnapShot::WatchStateSnapShot() = default;
 
 void HangWatcher::WatchStateSnapShot::Init(
@@ -688,7 +765,8 @@ void HangWatcher::WatchStateSnapShot::Init(
       if (thread_marked && all_threads_marked) {
         hung_watch_state_copies_.push_back(WatchStateCopy{
             deadline,
-            static_cast<PlatformThreadId>(watch_state.get()->GetThreadID())});
+            static_cast<PlatformThreadId>(watch_state.get()->GetThreadID()),
+            watch_state->thread_token()});
       } else {
         all_threads_marked = false;
       }
@@ -824,6 +902,28 @@ void HangWatcher::DoDumpWithoutCrashing(
           GetTimeSinceLastCriticalMemoryPressureCrashKey();
 #endif
 
+  // The dump has the stack of the HangWatcher thread, so the stack of the
+  // thread that hung first is recorded in a crash key.
+  CopyHungThreadStack(watch_state_snapshot.GetMostSevereHang().thread_token);
+#if !BUILDFLAG(IS_NACL)
+  std::string hung_thread_stack;
+  for (const void* frame : hung_thread_stack_) {
+    std::string fragment =
+        StringPrintf("%" PRIxPTR "|", reinterpret_cast<uintptr_t>(frame));
+    if (hung_thread_stack.size() + fragment.size() >=
+        static_cast<std::size_t>(debug::CrashKeySize::Size256)) {
+      break;
+    }
+    hung_thread_stack += fragment;
+  }
+
+  static debug::CrashKeyString* stack_crash_key = AllocateCrashKeyString(
+      "hung-thread-stack", debug::CrashKeySize::Size256);
+
+  const debug::ScopedCrashKeyString hung_thread_stack_crash_key_string(
+      stack_crash_key, hung_thread_stack);
+#endif
+
   // To avoid capturing more than one hang that blames a subset of the same
   // threads it's necessary to keep track of what is the furthest deadline
   // that contributed to declaring a hang. Only once
@@ -856,6 +956,61 @@ void HangWatcher::DoDumpWithoutCrashing(
   capture_in_progress_.store(false, std::memory_order_relaxed);
 }
 
+void HangWatcher::CopyHungThreadStack(
+    const SamplingProfilerThreadToken& thread_token) {
+  DCHECK_CALLED_ON_VALID_THREAD(hang_watcher_thread_checker_);
+  hung_thread_stack_.clear();
+#if defined(HANG_WATCHER_COPIES_HUNG_STACKS)
+  TRACE_EVENT0("base", "HangWatcher::CopyHungThreadStack");
+  std::unique_ptr<ThreadDelegatePosix> thread_delegate =
+      ThreadDelegatePosix::Create(thread_token);
+  if (!thread_delegate)
+    return;
+  if (!stack_buffer_)
+    stack_buffer_ = StackSampler::CreateStackBuffer();
+  if (!stack_buffer_)
+    return;
+
+  // The thread is interrupted by a signal while its stack is copied, which
+  // works whether it is blocked or running.
+  StackCopierSignal stack_copier(std::move(thread_delegate));
+  RegisterContext thread_context;
+  uintptr_t stack_top;
+  TimeTicks timestamp;
+  NoopStackCopierDelegate delegate;
+  if (!stack_copier.CopyStack(stack_buffer_.get(), &stack_top, &timestamp,
+                              &thread_context, &delegate)) {
+    return;
+  }
+
+  hung_thread_stack_.resize(kMaxHungThreadStackFrames);
+  hung_thread_stack_[0] = reinterpret_cast<const void*>(
+      RegisterContextInstructionPointer(&thread_context));
+  size_t frame_count = 1;
+
+  // The frame pointer was rewritten to point into the copy, unless the
+  // interrupted code uses it as a general purpose register. The frame records
+  // are only followed from within the copy.
+  const uintptr_t stack_bottom =
+      RegisterContextStackPointer(&thread_context);
+  const uintptr_t frame_pointer = RegisterContextFramePointer(&thread_context);
+  if (frame_pointer >= stack_bottom &&
+      frame_pointer % sizeof(uintptr_t) == 0 &&
+      stack_top - frame_pointer >= 2 * sizeof(uintptr_t)) {
+    frame_count += debug::TraceStackFramePointersFromBuffer(
+        frame_pointer, stack_top, &hung_thread_stack_[1],
+        kMaxHungThreadStackFrames - 1, /*skip_initial=*/0);
+  }
+  hung_thread_stack_.resize(frame_count);
+#endif
+}
+
+const std::vector<const void*>& HangWatcher::GetHungThreadStackForTesting()
+    const {
+  DCHECK_CALLED_ON_VALID_THREAD(hang_watcher_thread_checker_);
+  return hung_thread_stack_;
+}
+
 void HangWatcher::SetAfterMonitorClosureForTesting(
     base::RepeatingClosure closure) {
   DCHECK_CALLED_ON_VALID_THREAD(constructing_thread_checker_);
@@ -989,6 +1144,17 @@ void HangWatchDeadline::SetDeadline(TimeTicks new_deadline) {
               std::memory_order_relaxed);
 }
 
+void HangWatchDeadline::ArmDeadline(TimeTicks new_deadline) {
+  DCHECK_CALLED_ON_VALID_THREAD(thread_checker_);
+  DCHECK(new_deadline <= Max()) << "Value too high to be represented.";
+  DCHECK(new_deadline >= TimeTicks{}) << "Value cannot be negative.";
+
+  // Unlike SetDeadline(), the persistent flags are dropped so there is no need
+  // to load the bits first.
+  bits_.store(ExtractDeadline(new_deadline.ToInternalValue()),
+              std::memory_order_relaxed);
+}
+
 // TODO(crbug.com/1087026): Add flag DCHECKs here.
 bool HangWatchDeadline::SetShouldBlockOnHang(uint64_t old_flags,
                                              TimeTicks old_deadline) {
@@ -1086,7 +1252,8 @@ uint64_t HangWatchDeadline::SwitchBitsForTesting() {
 }
 
 HangWatchState::HangWatchState(HangWatcher::ThreadType thread_type)
-    : thread_type_(thread_type) {
+    : thread_type_(thread_type),
+      thread_token_(GetSamplingProfilerCurrentThreadToken()) {
   // There should not exist a state object for this thread already.
   DCHECK(!GetHangWatchStateForCurrentThread()->Get());
 
@@ -1145,6 +1312,11 @@ void HangWatchState::SetDeadline(TimeTicks deadline) {
   deadline_.SetDeadline(deadline);
 }
 
+void HangWatchState::ArmDeadline(TimeTicks deadline) {
+  DCHECK_CALLED_ON_VALID_THREAD(thread_checker_);
+  deadline_.ArmDeadline(deadline);
+}
+
 bool HangWatchState::IsOverDeadline() const {
   return TimeTicks::Now() > deadline_.GetDeadline();
 }
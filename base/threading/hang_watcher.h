@@ -21,6 +21,7 @@
 #include "base/gtest_prod_util.h"
 #include "base/memory/memory_pressure_listener.h"
 #include "base/memory/raw_ptr.h"
+#include "base/profiler/sampling_profiler_thread_token.h"
 #include "base/synchronization/lock.h"
 #include "base/template_util.h"
 #include "base/thread_annotations.h"
@@ -33,6 +34,8 @@
 #include "build/build_config.h"
 
 namespace base {
+class StackBuffer;
+class TaskTraits;
 class WatchHangsInScope;
 namespace internal {
 class HangWatchState;
@@ -69,13 +72,34 @@ class BASE_EXPORT WatchHangsInScope {
   // a ThreadPool thread for example.
   static const base::TimeDelta kDefaultHangWatchTime;
 
+  // Classes of work that have their own hang thresholds, configured through
+  // Finch. Work that may block, on IO for example, can legitimately take much
+  // longer than work that only uses the CPU.
+  enum class DeadlineClass {
+    // Work that is not expected to block, like tasks without MayBlock.
+    kCompute = 0,
+    // Work that may block, like tasks with MayBlock.
+    kBlocking = 1,
+    kMax = kBlocking
+  };
+
   // Constructing/destructing thread must be the same thread.
   explicit WatchHangsInScope(TimeDelta timeout);
+
+  // Watches for hangs of more than the timeout of |deadline_class|.
+  explicit WatchHangsInScope(DeadlineClass deadline_class);
+
   ~WatchHangsInScope();
 
   WatchHangsInScope(const WatchHangsInScope&) = delete;
   WatchHangsInScope& operator=(const WatchHangsInScope&) = delete;
 
+  // Returns the timeout of |deadline_class|. Thread safe.
+  static TimeDelta GetTimeout(DeadlineClass deadline_class);
+
+  // Returns the class of the tasks with |traits|.
+  static DeadlineClass GetDeadlineClassForTaskTraits(const TaskTraits& traits);
+
  private:
   // Will be true if the object actually set a deadline and false if not.
   bool took_effect_ = true;
@@ -240,6 +264,12 @@ class BASE_EXPORT HangWatcher : public DelegateSimpleThread::Delegate {
   // Begin executing the monitoring loop on the HangWatcher thread.
   void Start();
 
+  // Returns the stack of the most severe hung thread, copied when the last hang
+  // was recorded. Empty if the stack couldn't be copied, or if this platform
+  // doesn't support it. Use only for testing, from the closure set by
+  // SetOnHangClosureForTesting().
+  const std::vector<const void*>& GetHungThreadStackForTesting() const;
+
  private:
   // See comment of ::RegisterThread() for details.
   [[nodiscard]] ScopedClosureRunner RegisterThreadInternal(
@@ -276,6 +306,7 @@ class BASE_EXPORT HangWatcher : public DelegateSimpleThread::Delegate {
     struct WatchStateCopy {
       base::TimeTicks deadline;
       base::PlatformThreadId thread_id;
+      SamplingProfilerThreadToken thread_token;
     };
 
     WatchStateSnapShot();
@@ -311,6 +342,10 @@ class BASE_EXPORT HangWatcher : public DelegateSimpleThread::Delegate {
     // if IsActionable(). Can only be called after Init().
     base::TimeTicks GetHighestDeadline() const;
 
+    // Returns the copy of the state of the thread that hung first. Can only be
+    // called if IsActionable(). Can only be called after Init().
+    const WatchStateCopy& GetMostSevereHang() const;
+
     // Returns true if the snapshot can be used to record an actionable hang
     // report and false if not. Can only be called after Init().
     bool IsActionable() const;
@@ -336,6 +371,10 @@ class BASE_EXPORT HangWatcher : public DelegateSimpleThread::Delegate {
   void DoDumpWithoutCrashing(const WatchStateSnapShot& watch_state_snapshot)
       EXCLUSIVE_LOCKS_REQUIRED(watch_state_lock_) LOCKS_EXCLUDED(capture_lock_);
 
+  // Copies and unwinds the stack of the thread of |thread_token| into
+  // |hung_thread_stack_|. Leaves it empty on failure.
+  void CopyHungThreadStack(const SamplingProfilerThreadToken& thread_token);
+
   // Stop all monitoring and join the HangWatcher thread.
   void Stop();
 
@@ -368,6 +407,16 @@ class BASE_EXPORT HangWatcher : public DelegateSimpleThread::Delegate {
   WatchStateSnapShot watch_state_snapshot_
       GUARDED_BY_CONTEXT(hang_watcher_thread_checker_);
 
+  // The buffer that the stacks of the hung threads are copied to. Allocated on
+  // the first hang and reused across hang captures, so that watching for hangs
+  // costs no memory until then.
+  std::unique_ptr<StackBuffer> stack_buffer_
+      GUARDED_BY_CONTEXT(hang_watcher_thread_checker_);
+
+  // The stack of the most severe hung thread of the last hang capture.
+  std::vector<const void*> hung_thread_stack_
+      GUARDED_BY_CONTEXT(hang_watcher_thread_checker_);
+
   base::DelegateSimpleThread thread_;
 
   RepeatingClosure after_monitor_closure_for_testing_;
@@ -458,6 +507,12 @@ class BASE_EXPORT HangWatchDeadline {
   // Max()]. This function can never fail.
   void SetDeadline(TimeTicks new_value);
 
+  // Replaces the deadline value and clears all the flags, with a single relaxed
+  // store. Used to enter a WatchHangsInScope. Like SetDeadline(), it must be
+  // called on the watched thread, which is the only one to change the
+  // persistent flags. |new_value| needs to be within [0, Max()].
+  void ArmDeadline(TimeTicks new_value);
+
   // Sets the kShouldBlockOnHang flag and returns true if current flags and
   // deadline are still equal to |old_flags| and  |old_deadline|. Otherwise does
   // not set the flag and returns false.
@@ -550,8 +605,10 @@ class BASE_EXPORT HangWatchDeadline {
 // thread. Instances of this class are accessed concurrently by the associated
 // thread and the HangWatcher. The HangWatcher owns instances of this
 // class and outside of it they are accessed through
-// GetHangWatchStateForCurrentThread().
-class BASE_EXPORT HangWatchState {
+// GetHangWatchStateForCurrentThread(). Each instance has a cache line of its
+// own, so that entering a WatchHangsInScope only writes to a line that no
+// other thread writes to.
+class BASE_EXPORT alignas(64) HangWatchState {
  public:
   // |thread_type| is the type of thread the watch state will
   // be associated with. It's the responsibility of the creating
@@ -588,6 +645,10 @@ class BASE_EXPORT HangWatchState {
   // Sets the deadline to a new value.
   void SetDeadline(TimeTicks deadline);
 
+  // Sets the deadline to a new value and clears all the flags. See
+  // HangWatchDeadline::ArmDeadline().
+  void ArmDeadline(TimeTicks deadline);
+
   // Mark this thread as ignored for hang watching. This means existing
   // WatchHangsInScope will not trigger hangs.
   void SetIgnoreCurrentWatchHangsInScope();
@@ -634,6 +695,11 @@ class BASE_EXPORT HangWatchState {
   // Returns the type of the thread under watch.
   HangWatcher::ThreadType thread_type() const { return thread_type_; }
 
+  // Returns the token used to copy the stack of the thread under watch.
+  const SamplingProfilerThreadToken& thread_token() const {
+    return thread_token_;
+  }
+
  private:
   // The thread that creates the instance should be the class that updates
   // the deadline.
@@ -643,16 +709,19 @@ class BASE_EXPORT HangWatchState {
   // reaches the value contained in it this constistutes a hang.
   HangWatchDeadline deadline_;
 
+  // Number of active HangWatchScopeEnables on this thread. Next to |deadline_|
+  // since both are written when entering a WatchHangsInScope.
+  int nesting_level_ = 0;
+
+  // The type of the thread under watch.
+  const HangWatcher::ThreadType thread_type_;
+
   // A unique ID of the thread under watch. Used for logging in crash reports
   // only. Unsigned type is used as it provides a correct behavior for all
   // platforms for positive thread ids. Any valid thread id should be positive.
   uint64_t thread_id_;
 
-  // Number of active HangWatchScopeEnables on this thread.
-  int nesting_level_ = 0;
-
-  // The type of the thread under watch.
-  const HangWatcher::ThreadType thread_type_;
+  const SamplingProfilerThreadToken thread_token_;
 
 #if DCHECK_IS_ON()
   // Used to keep track of the current WatchHangsInScope and detect improper
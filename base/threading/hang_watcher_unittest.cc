@@ -3,18 +3,24 @@
 // found in the LICENSE file.
 
 #include "base/threading/hang_watcher.h"
+#include <algorithm>
 #include <atomic>
 #include <memory>
+#include <vector>
 
 #include "base/barrier_closure.h"
 #include "base/bind.h"
 #include "base/callback.h"
 #include "base/callback_helpers.h"
+#include "base/compiler_specific.h"
+#include "base/debug/debugging_buildflags.h"
+#include "base/debug/stack_trace.h"
 #include "base/memory/raw_ptr.h"
 #include "base/run_loop.h"
 #include "base/strings/string_number_conversions.h"
 #include "base/synchronization/lock.h"
 #include "base/synchronization/waitable_event.h"
+#include "base/task/task_traits.h"
 #include "base/test/bind.h"
 #include "base/test/metrics/histogram_tester.h"
 #include "base/test/scoped_feature_list.h"
@@ -22,6 +28,7 @@
 #include "base/test/task_environment.h"
 #include "base/test/test_timeouts.h"
 #include "base/threading/platform_thread.h"
+#include "base/threading/simple_thread.h"
 #include "base/threading/thread_checker.h"
 #include "base/threading/threading_features.h"
 #include "base/time/tick_clock.h"
@@ -107,6 +114,53 @@ class BlockingThread : public DelegateSimpleThread::Delegate {
   base::TimeDelta timeout_;
 };
 
+#if (BUILDFLAG(IS_LINUX) || BUILDFLAG(IS_CHROMEOS) || BUILDFLAG(IS_ANDROID)) && \
+    BUILDFLAG(CAN_UNWIND_WITH_FRAME_POINTERS)
+#define HANG_WATCHER_COPIES_HUNG_STACKS
+
+// Hangs in a WatchHangsInScope that expires right away, yielding instead of
+// waiting so that its stack is walkable with the frame pointers when copied.
+class SpinningThread : public SimpleThread {
+ public:
+  SpinningThread() : SimpleThread("SpinningThread") {}
+
+  void Run() override {
+    base::ScopedClosureRunner unregister_closure =
+        base::HangWatcher::RegisterThread(
+            base::HangWatcher::ThreadType::kMainThread);
+    WatchHangsInScope scope(base::TimeDelta{});
+    Spin();
+  }
+
+  void StartAndWaitForScopeEntered() {
+    Start();
+    wait_until_entered_scope_.Wait();
+  }
+
+  void UnblockAndJoin() {
+    unblock_.store(true, std::memory_order_relaxed);
+    Join();
+  }
+
+  // The stack of the thread, recorded before it started spinning.
+  const std::vector<const void*>& stack() const { return stack_; }
+
+ private:
+  NOINLINE void Spin() {
+    size_t count;
+    const void* const* addresses = debug::StackTrace().Addresses(&count);
+    stack_.assign(addresses, addresses + count);
+    wait_until_entered_scope_.Signal();
+    while (!unblock_.load(std::memory_order_relaxed))
+      PlatformThread::YieldCurrentThread();
+  }
+
+  WaitableEvent wait_until_entered_scope_;
+  std::atomic<bool> unblock_{false};
+  std::vector<const void*> stack_;
+};
+#endif
+
 class HangWatcherTest : public testing::Test {
  public:
   const base::TimeDelta kTimeout = base::Seconds(10);
@@ -412,6 +466,86 @@ TEST_F(HangWatcherTest, NestedScopes) {
   ASSERT_EQ(current_hang_watch_state->GetDeadline(), original_deadline);
 }
 
+TEST_F(HangWatcherTest, DeadlineClasses) {
+  EXPECT_EQ(WatchHangsInScope::DeadlineClass::kCompute,
+            WatchHangsInScope::GetDeadlineClassForTaskTraits({}));
+  EXPECT_EQ(WatchHangsInScope::DeadlineClass::kBlocking,
+            WatchHangsInScope::GetDeadlineClassForTaskTraits({MayBlock()}));
+  EXPECT_EQ(
+      WatchHangsInScope::DeadlineClass::kCompute,
+      WatchHangsInScope::GetDeadlineClassForTaskTraits(
+          {TaskPriority::BEST_EFFORT, WithBaseSyncPrimitives()}));
+
+  // Blocking work gets more time by default.
+  const base::TimeDelta compute_timeout =
+      WatchHangsInScope::GetTimeout(WatchHangsInScope::DeadlineClass::kCompute);
+  const base::TimeDelta blocking_timeout = WatchHangsInScope::GetTimeout(
+      WatchHangsInScope::DeadlineClass::kBlocking);
+  EXPECT_EQ(WatchHangsInScope::kDefaultHangWatchTime, compute_timeout);
+  EXPECT_GT(blocking_timeout, compute_timeout);
+
+  auto current_hang_watch_state =
+      base::internal::HangWatchState::CreateHangWatchStateForCurrentThread(
+          HangWatcher::ThreadType::kThreadPoolThread);
+  {
+    WatchHangsInScope compute_scope(WatchHangsInScope::DeadlineClass::kCompute);
+    EXPECT_EQ(base::TimeTicks::Now() + compute_timeout,
+              current_hang_watch_state->GetDeadline());
+    {
+      WatchHangsInScope blocking_scope(
+          WatchHangsInScope::DeadlineClass::kBlocking);
+      EXPECT_EQ(base::TimeTicks::Now() + blocking_timeout,
+                current_hang_watch_state->GetDeadline());
+    }
+    EXPECT_EQ(base::TimeTicks::Now() + compute_timeout,
+              current_hang_watch_state->GetDeadline());
+  }
+}
+
+TEST(HangWatcherDeadlineClassTest, TimeoutsFromFeatureParams) {
+  test::ScopedFeatureList feature_list;
+  feature_list.InitAndEnableFeatureWithParameters(
+      kEnableHangWatcher, {{"compute_hang_watch_time", "2s"},
+                           {"blocking_hang_watch_time", "1m"}});
+  HangWatcher::InitializeOnMainThread(
+      HangWatcher::ProcessType::kRendererProcess);
+  EXPECT_EQ(base::Seconds(2), WatchHangsInScope::GetTimeout(
+                                  WatchHangsInScope::DeadlineClass::kCompute));
+  EXPECT_EQ(base::Minutes(1), WatchHangsInScope::GetTimeout(
+                                  WatchHangsInScope::DeadlineClass::kBlocking));
+
+  // The timeouts go back to their defaults.
+  HangWatcher::UnitializeOnMainThreadForTesting();
+  EXPECT_EQ(
+      WatchHangsInScope::kDefaultHangWatchTime,
+      WatchHangsInScope::GetTimeout(WatchHangsInScope::DeadlineClass::kCompute));
+}
+
+#if defined(HANG_WATCHER_COPIES_HUNG_STACKS)
+TEST_F(HangWatcherTest, HungThreadStackIsCopied) {
+  std::vector<const void*> hung_thread_stack;
+  hang_watcher_.SetOnHangClosureForTesting(base::BindLambdaForTesting([&]() {
+    hung_thread_stack = hang_watcher_.GetHungThreadStackForTesting();
+    hang_event_.Signal();
+  }));
+
+  SpinningThread thread;
+  thread.StartAndWaitForScopeEntered();
+
+  hang_watcher_.SignalMonitorEventForTesting();
+  hang_event_.Wait();
+  thread.UnblockAndJoin();
+
+  // The stack copied while the thread was hung has the frames of the callers of
+  // SpinningThread::Spin(), which were recorded by the thread itself.
+  ASSERT_FALSE(hung_thread_stack.empty());
+  EXPECT_NE(std::find_first_of(thread.stack().begin(), thread.stack().end(),
+                               hung_thread_stack.begin(),
+                               hung_thread_stack.end()),
+            thread.stack().end());
+}
+#endif
+
 TEST_F(HangWatcherBlockingThreadTest, HistogramsLoggedOnHang) {
   base::HistogramTester histogram_tester;
   StartBlockedThread();
@@ -1198,6 +1332,19 @@ TEST_F(HangWatchDeadlineTest, SetDeadlineWipesFlags) {
       HangWatchDeadline::Flag::kIgnoreCurrentWatchHangsInScope));
 }
 
+// Arming a deadline wipes all the flags.
+TEST_F(HangWatchDeadlineTest, ArmDeadlineWipesAllFlags) {
+  auto [flags, deadline] = deadline_.GetFlagsAndDeadline();
+  ASSERT_TRUE(deadline_.SetShouldBlockOnHang(flags, deadline));
+  deadline_.SetIgnoreCurrentWatchHangsInScope();
+
+  const base::TimeTicks new_deadline =
+      base::TimeTicks::FromInternalValue(kArbitraryDeadline);
+  deadline_.ArmDeadline(new_deadline);
+  ASSERT_EQ(deadline_.GetDeadline(), new_deadline);
+  AssertNoFlagsSet();
+}
+
 }  // namespace internal
 
 }  // namespace base
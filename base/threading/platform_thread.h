@@ -218,6 +218,48 @@ class BASE_EXPORT PlatformThread {
   static void SetThreadPriority(PlatformThreadId process_id,
                                 PlatformThreadId thread_id,
                                 ThreadPriority priority);
+
+  // The real-time needs of a thread, e.g. of audio or packet processing, which
+  // runs for up to |runtime| within |deadline| of the start of each |period|.
+  struct RealtimeParameters {
+    TimeDelta runtime;
+    // If zero, |period|.
+    TimeDelta deadline;
+    TimeDelta period;
+    // The utilization clamps, in percent of the capacity of the largest CPU,
+    // which bound the frequency that schedutil picks for the thread, and the
+    // CPUs that energy-aware scheduling places it on. For the fallbacks of
+    // SCHED_DEADLINE only.
+    int util_min_percent = 0;
+    int util_max_percent = 100;
+  };
+
+  // The scheduling that SetCurrentThreadRealtime() achieved, from the
+  // strongest guarantee to none.
+  enum class RealtimePolicy {
+    // SCHED_DEADLINE: the kernel reserves |runtime| every |period| for the
+    // thread, which must yield once its work for the period is done.
+    kDeadline,
+    // SCHED_FIFO, at the priority of ThreadPriority::REALTIME_AUDIO.
+    kFifo,
+    // The nice value of ThreadPriority::REALTIME_AUDIO.
+    kNice,
+    kNone,
+  };
+
+  // Makes the current thread real-time per |parameters|, falling back from
+  // SCHED_DEADLINE, which needs CAP_SYS_NICE and room in the real-time
+  // bandwidth of the CPUs of the thread, to SCHED_FIFO, which needs
+  // RLIMIT_RTPRIO, to a lower nice value, which needs RLIMIT_NICE. The forked
+  // children of the thread don't inherit its policy.
+  static RealtimePolicy SetCurrentThreadRealtime(
+      const RealtimeParameters& parameters);
+
+  // Sets the utilization clamps (uclamp) of the current thread, in percent,
+  // without changing its policy, e.g. to keep a background thread off the
+  // turbo frequencies. Returns false if the kernel lacks them (Linux 5.3+ with
+  // CONFIG_UCLAMP_TASK). The cgroup of the thread may clamp them further.
+  static bool SetCurrentThreadUtilClamp(int min_percent, int max_percent);
 #endif
 
 #if BUILDFLAG(IS_CHROMEOS_ASH) || BUILDFLAG(IS_CHROMEOS_LACROS)
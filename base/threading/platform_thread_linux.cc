@@ -60,6 +60,7 @@ const bool kSchedulerUseLatencyTuneDef = true;
 int g_scheduler_boost_adj;
 int g_scheduler_limit_adj;
 bool g_scheduler_use_latency_tune_adj;
+#endif  // BUILDFLAG(IS_CHROMEOS_ASH) || BUILDFLAG(IS_CHROMEOS_LACROS)
 
 #if !BUILDFLAG(IS_NACL) && !BUILDFLAG(IS_AIX)
 
@@ -117,20 +118,43 @@ struct sched_attr {
 #define SCHED_FLAG_UTIL_CLAMP_MAX 0x40
 #endif
 
+#if !defined(SCHED_DEADLINE)
+#define SCHED_DEADLINE 6
+#endif
+
+#if !defined(SCHED_FLAG_RESET_ON_FORK)
+#define SCHED_FLAG_RESET_ON_FORK 0x01
+#endif
+
+#if !defined(SCHED_FLAG_KEEP_POLICY)
+#define SCHED_FLAG_KEEP_POLICY 0x08
+#endif
+
+#if !defined(SCHED_FLAG_KEEP_PARAMS)
+#define SCHED_FLAG_KEEP_PARAMS 0x10
+#endif
+
+#if BUILDFLAG(IS_CHROMEOS_ASH) || BUILDFLAG(IS_CHROMEOS_LACROS)
 int sched_getattr(pid_t pid,
                   const struct sched_attr* attr,
                   unsigned int size,
                   unsigned int flags) {
   return syscall(__NR_sched_getattr, pid, attr, size, flags);
 }
+#endif
 
 int sched_setattr(pid_t pid,
                   const struct sched_attr* attr,
                   unsigned int flags) {
   return syscall(__NR_sched_setattr, pid, attr, flags);
 }
+
+uint32_t PercentToUtilClamp(int percent) {
+  DCHECK_GE(percent, 0);
+  DCHECK_LE(percent, 100);
+  return (static_cast<uint32_t>(percent) * kSchedulerUclampMax + 50) / 100;
+}
 #endif  // !BUILDFLAG(IS_NACL) && !BUILDFLAG(IS_AIX)
-#endif  // BUILDFLAG(IS_CHROMEOS_ASH) || BUILDFLAG(IS_CHROMEOS_LACROS)
 
 #if !BUILDFLAG(IS_NACL)
 const FilePath::CharType kCgroupDirectory[] =
@@ -392,6 +416,71 @@ void PlatformThread::SetThreadPriority(ProcessId process_id,
               << nice_setting;
   }
 }
+
+// static
+PlatformThread::RealtimePolicy PlatformThread::SetCurrentThreadRealtime(
+    const RealtimeParameters& parameters) {
+  const TimeDelta deadline =
+      parameters.deadline.is_zero() ? parameters.period : parameters.deadline;
+  DCHECK_GT(parameters.runtime, TimeDelta());
+  DCHECK_LE(parameters.runtime, deadline);
+  DCHECK_LE(deadline, parameters.period);
+
+  // Without SCHED_FLAG_RESET_ON_FORK, a SCHED_DEADLINE thread can't fork(),
+  // and the children of a SCHED_FIFO one would inherit its policy.
+  struct sched_attr attr = {};
+  attr.size = sizeof(attr);
+  attr.sched_policy = SCHED_DEADLINE;
+  attr.sched_flags = SCHED_FLAG_RESET_ON_FORK;
+  attr.sched_runtime =
+      static_cast<uint64_t>(parameters.runtime.InNanoseconds());
+  attr.sched_deadline = static_cast<uint64_t>(deadline.InNanoseconds());
+  attr.sched_period = static_cast<uint64_t>(parameters.period.InNanoseconds());
+  // Fails without CAP_SYS_NICE, or if admission control finds that the
+  // reservations of the CPUs of the thread exceed their real-time bandwidth.
+  if (sched_setattr(0, &attr, 0) == 0)
+    return RealtimePolicy::kDeadline;
+  DVPLOG(1) << "Failed to set SCHED_DEADLINE";
+
+  // The clamps don't apply to SCHED_DEADLINE, which runs at the frequency its
+  // bandwidth needs.
+  SetCurrentThreadUtilClamp(parameters.util_min_percent,
+                            parameters.util_max_percent);
+
+  attr = {};
+  attr.size = sizeof(attr);
+  attr.sched_policy = SCHED_FIFO;
+  attr.sched_flags = SCHED_FLAG_RESET_ON_FORK;
+  attr.sched_priority =
+      static_cast<uint32_t>(internal::kRealTimePrio.sched_priority);
+  if (sched_setattr(0, &attr, 0) == 0)
+    return RealtimePolicy::kFifo;
+  DVPLOG(1) << "Failed to set SCHED_FIFO";
+
+  const int nice_setting =
+      internal::ThreadPriorityToNiceValue(ThreadPriority::REALTIME_AUDIO);
+  if (setpriority(PRIO_PROCESS, 0, nice_setting) == 0)
+    return RealtimePolicy::kNice;
+  DVPLOG(1) << "Failed to set nice value of thread to " << nice_setting;
+  return RealtimePolicy::kNone;
+}
+
+// static
+bool PlatformThread::SetCurrentThreadUtilClamp(int min_percent,
+                                               int max_percent) {
+  DCHECK_LE(min_percent, max_percent);
+  struct sched_attr attr = {};
+  attr.size = sizeof(attr);
+  attr.sched_flags = SCHED_FLAG_KEEP_POLICY | SCHED_FLAG_KEEP_PARAMS |
+                     SCHED_FLAG_UTIL_CLAMP_MIN | SCHED_FLAG_UTIL_CLAMP_MAX;
+  attr.sched_util_min = PercentToUtilClamp(min_percent);
+  attr.sched_util_max = PercentToUtilClamp(max_percent);
+  if (sched_setattr(0, &attr, 0) != 0) {
+    DVPLOG(1) << "Failed to set the utilization clamps of thread";
+    return false;
+  }
+  return true;
+}
 #endif  //  !BUILDFLAG(IS_NACL) && !BUILDFLAG(IS_AIX)
 
 #if BUILDFLAG(IS_CHROMEOS_ASH) || BUILDFLAG(IS_CHROMEOS_LACROS)
@@ -32,6 +32,8 @@
 
 #if BUILDFLAG(IS_LINUX) || BUILDFLAG(IS_CHROMEOS)
 #include <pthread.h>
+#include <sched.h>
+#include <sys/resource.h>
 #include <sys/syscall.h>
 #include <sys/types.h>
 #include <sys/wait.h>
@@ -645,6 +647,72 @@ TEST(PlatformThreadTidCacheTest, MainThreadSecond) {
   TestTidCacheCorrect(false);
 }
 
+#if !defined(SCHED_DEADLINE)
+#define SCHED_DEADLINE 6
+#endif
+
+class RealtimeLinuxTestThread : public FunctionTestThread {
+ public:
+  RealtimeLinuxTestThread() = default;
+  RealtimeLinuxTestThread(const RealtimeLinuxTestThread&) = delete;
+  RealtimeLinuxTestThread& operator=(const RealtimeLinuxTestThread&) = delete;
+  ~RealtimeLinuxTestThread() override = default;
+
+ private:
+  void RunTest() override {
+    PlatformThread::RealtimeParameters parameters;
+    parameters.runtime = Milliseconds(1);
+    parameters.period = Milliseconds(10);
+    parameters.util_min_percent = 10;
+    const PlatformThread::RealtimePolicy policy =
+        PlatformThread::SetCurrentThreadRealtime(parameters);
+
+    // The scheduler matches the policy that was achieved.
+    const int scheduler = sched_getscheduler(0) & ~SCHED_RESET_ON_FORK;
+    switch (policy) {
+      case PlatformThread::RealtimePolicy::kDeadline:
+        EXPECT_EQ(scheduler, SCHED_DEADLINE);
+        break;
+      case PlatformThread::RealtimePolicy::kFifo:
+        EXPECT_EQ(scheduler, SCHED_FIFO);
+        break;
+      case PlatformThread::RealtimePolicy::kNice:
+        EXPECT_EQ(scheduler, SCHED_OTHER);
+        EXPECT_EQ(getpriority(PRIO_PROCESS, 0),
+                  internal::ThreadPriorityToNiceValue(
+                      ThreadPriority::REALTIME_AUDIO));
+        break;
+      case PlatformThread::RealtimePolicy::kNone:
+        EXPECT_EQ(scheduler, SCHED_OTHER);
+        break;
+    }
+
+    // The thread can fork(), and its child doesn't inherit the policy.
+    pid_t child_pid = fork();
+    ASSERT_GE(child_pid, 0);
+    if (child_pid == 0)
+      _exit(sched_getscheduler(0) == SCHED_OTHER ? 0 : 1);
+    int status;
+    ASSERT_EQ(waitpid(child_pid, &status, 0), child_pid);
+    ASSERT_TRUE(WIFEXITED(status));
+    EXPECT_EQ(WEXITSTATUS(status), 0);
+
+    // Setting the clamps keeps the policy.
+    if (PlatformThread::SetCurrentThreadUtilClamp(0, 50)) {
+      EXPECT_EQ(sched_getscheduler(0) & ~SCHED_RESET_ON_FORK, scheduler);
+    }
+  }
+};
+
+TEST(PlatformThreadTest, SetCurrentThreadRealtime) {
+  RealtimeLinuxTestThread thread;
+  PlatformThreadHandle handle;
+  ASSERT_TRUE(PlatformThread::Create(0, &thread, &handle));
+  thread.WaitForTerminationReady();
+  thread.MarkForTermination();
+  PlatformThread::Join(handle);
+}
+
 }  // namespace
 
 #endif  // BUILDFLAG(IS_LINUX) || BUILDFLAG(IS_CHROMEOS)
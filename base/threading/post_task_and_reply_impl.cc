@@ -103,6 +103,16 @@ class PostTaskAndReplyRelay {
     // |relay| is moved into a callback.
     SequencedTaskRunner* reply_task_runner_raw = relay.reply_task_runner_.get();
 
+    // When the task ran on the origin sequence and nothing else is queued on
+    // it, the posted reply would be the next task of the sequence anyway: run
+    // it now, which saves the allocation of its BindState and a round trip
+    // through the scheduler. |relay| was bound by value in the BindState of
+    // the task, so this path allocates nothing.
+    if (reply_task_runner_raw->CanRunTaskInlineInCurrentSequence()) {
+      RunReply(std::move(relay));
+      return;
+    }
+
     const Location from_here = relay.from_here_;
     reply_task_runner_raw->PostTask(
         from_here,
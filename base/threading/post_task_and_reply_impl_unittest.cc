@@ -79,6 +79,8 @@ class MockRunsTasksInCurrentSequenceTaskRunner : public TestMockTimeTaskRunner {
 
   void StopAcceptingTasks() { accepts_tasks_ = false; }
 
+  void AllowRunningTasksInline() { can_run_task_inline_ = true; }
+
   void RunUntilIdleWithRunsTasksInCurrentSequence() {
     AutoReset<bool> reset(&runs_tasks_in_current_sequence_, true);
     RunUntilIdle();
@@ -94,6 +96,10 @@ class MockRunsTasksInCurrentSequenceTaskRunner : public TestMockTimeTaskRunner {
     return runs_tasks_in_current_sequence_;
   }
 
+  bool CanRunTaskInlineInCurrentSequence() const override {
+    return can_run_task_inline_;
+  }
+
   bool PostDelayedTask(const Location& from_here,
                        OnceClosure task,
                        TimeDelta delay) override {
@@ -109,6 +115,7 @@ class MockRunsTasksInCurrentSequenceTaskRunner : public TestMockTimeTaskRunner {
 
   bool accepts_tasks_ = true;
   bool runs_tasks_in_current_sequence_ = false;
+  bool can_run_task_inline_ = false;
 };
 
 class PostTaskAndReplyImplTest : public testing::Test {
@@ -178,6 +185,26 @@ TEST_F(PostTaskAndReplyImplTest, PostTaskAndReply) {
   EXPECT_FALSE(reply_runner_->HasPendingTask());
 }
 
+TEST_F(PostTaskAndReplyImplTest, ReplyRunsInline) {
+  reply_runner_->AllowRunningTasksInline();
+  ExpectPostTaskAndReplyToMockObjectSucceeds();
+
+  {
+    testing::InSequence in_sequence;
+    EXPECT_CALL(mock_object_, Task(_));
+    EXPECT_CALL(mock_object_, Reply(_));
+  }
+  post_runner_->RunUntilIdleWithRunsTasksInCurrentSequence();
+  testing::Mock::VerifyAndClear(&mock_object_);
+  // Both callbacks should have been deleted right after being run.
+  EXPECT_TRUE(delete_task_flag_);
+  EXPECT_TRUE(delete_reply_flag_);
+
+  // Expect no reply to be posted to |reply_runner_|.
+  EXPECT_FALSE(post_runner_->HasPendingTask());
+  EXPECT_FALSE(reply_runner_->HasPendingTask());
+}
+
 TEST_F(PostTaskAndReplyImplTest, TaskDoesNotRun) {
   ExpectPostTaskAndReplyToMockObjectSucceeds();
 
@@ -327,6 +327,9 @@ UncheckedScopedBlockingCall::UncheckedScopedBlockingCall(
     }
   }
 
+  if (!previous_scoped_blocking_call_ && BlockingCallProfiler::IsEnabled())
+    profiled_call_.emplace(from_here, blocking_type, !!blocking_observer_);
+
   if (blocking_observer_) {
     if (!previous_scoped_blocking_call_) {
       blocking_observer_->BlockingStarted(blocking_type);
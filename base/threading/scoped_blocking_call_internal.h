@@ -11,6 +11,7 @@
 #include "base/memory/raw_ptr.h"
 #include "base/memory/ref_counted.h"
 #include "base/synchronization/lock.h"
+#include "base/threading/blocking_call_profiler.h"
 #include "base/thread_annotations.h"
 #include "base/time/time.h"
 #include "base/types/strong_alias.h"
@@ -201,6 +202,10 @@ class BASE_EXPORT UncheckedScopedBlockingCall {
   // Non-nullopt for non-nested blocking calls of type MAY_BLOCK on foreground
   // threads which we monitor for I/O jank.
   absl::optional<IOJankMonitoringWindow::ScopedMonitoredCall> monitored_call_;
+
+  // Non-nullopt for non-nested blocking calls while BlockingCallProfiler is
+  // enabled.
+  absl::optional<ScopedProfiledBlockingCall> profiled_call_;
 };
 
 }  // namespace internal
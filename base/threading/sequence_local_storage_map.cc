@@ -4,6 +4,7 @@
 
 #include "base/threading/sequence_local_storage_map.h"
 
+#include <memory>
 #include <ostream>
 #include <utility>
 
@@ -17,6 +18,8 @@ namespace internal {
 namespace {
 LazyInstance<ThreadLocalPointer<SequenceLocalStorageMap>>::Leaky
     tls_current_sequence_local_storage = LAZY_INSTANCE_INITIALIZER;
+
+void DestroyNothing(void* ptr) {}
 }  // namespace
 
 SequenceLocalStorageMap::SequenceLocalStorageMap() = default;
@@ -55,25 +58,55 @@ bool SequenceLocalStorageMap::IsSetForCurrentThread() {
 }
 
 void* SequenceLocalStorageMap::Get(int slot_id) {
-  const auto it = sls_map_.find(slot_id);
-  if (it == sls_map_.end())
-    return nullptr;
-  return it->second.value();
+  const Entry* entry = FindEntry(slot_id);
+  return entry ? entry->value_destructor_pair.value() : nullptr;
 }
 
 void SequenceLocalStorageMap::Set(
     int slot_id,
     SequenceLocalStorageMap::ValueDestructorPair value_destructor_pair) {
-  auto it = sls_map_.find(slot_id);
+  Entry& entry = GetOrCreateEntry(slot_id);
+  entry.slot_id = slot_id;
+  // Destroys the previous value, possibly left by a destroyed slot.
+  entry.value_destructor_pair = std::move(value_destructor_pair);
+}
+
+void* SequenceLocalStorageMap::SetInline(int slot_id) {
+  Entry& entry = GetOrCreateEntry(slot_id);
+  entry.slot_id = slot_id;
+  entry.value_destructor_pair =
+      ValueDestructorPair(entry.inline_value, &DestroyNothing);
+  return entry.inline_value;
+}
 
-  if (it == sls_map_.end())
-    sls_map_.emplace(slot_id, std::move(value_destructor_pair));
-  else
-    it->second = std::move(value_destructor_pair);
+SequenceLocalStorageMap::Entry::Entry()
+    : value_destructor_pair(nullptr, nullptr) {}
+
+SequenceLocalStorageMap::Entry::~Entry() = default;
+
+SequenceLocalStorageMap::Entry* SequenceLocalStorageMap::FindEntry(
+    int slot_id) {
+  DCHECK_GE(slot_id, 0);
+  const size_t index =
+      static_cast<size_t>(slot_id & kSequenceLocalStorageSlotIndexMask);
+  const size_t block = index / kEntriesPerBlock;
+  if (block >= blocks_.size() || !blocks_[block])
+    return nullptr;
+  Entry& entry = blocks_[block][index % kEntriesPerBlock];
+  return entry.slot_id == slot_id ? &entry : nullptr;
+}
 
-  // The maximum number of entries in the map is 256. This can be adjusted, but
-  // will require reviewing the choice of data structure for the map.
-  DCHECK_LE(sls_map_.size(), 256U);
+SequenceLocalStorageMap::Entry& SequenceLocalStorageMap::GetOrCreateEntry(
+    int slot_id) {
+  DCHECK_GE(slot_id, 0);
+  const size_t index =
+      static_cast<size_t>(slot_id & kSequenceLocalStorageSlotIndexMask);
+  const size_t block = index / kEntriesPerBlock;
+  if (block >= blocks_.size())
+    blocks_.resize(block + 1);
+  if (!blocks_[block])
+    blocks_[block] = std::make_unique<Entry[]>(kEntriesPerBlock);
+  return blocks_[block][index % kEntriesPerBlock];
 }
 
 SequenceLocalStorageMap::ValueDestructorPair::ValueDestructorPair(
@@ -5,12 +5,24 @@
 #ifndef BASE_THREADING_SEQUENCE_LOCAL_STORAGE_MAP_H_
 #define BASE_THREADING_SEQUENCE_LOCAL_STORAGE_MAP_H_
 
+#include <stddef.h>
+
+#include <memory>
+#include <vector>
+
 #include "base/base_export.h"
-#include "base/containers/flat_map.h"
 
 namespace base {
 namespace internal {
 
+// The slot ids hold the index of their entry in the SequenceLocalStorageMaps,
+// in the lower bits, and the generation of the index in the upper ones. An
+// index is reused once its slot is destroyed, with the next generation, so
+// that the values which a destroyed slot left in the maps don't match.
+constexpr int kSequenceLocalStorageSlotIndexBits = 16;
+constexpr int kSequenceLocalStorageSlotIndexMask =
+    (1 << kSequenceLocalStorageSlotIndexBits) - 1;
+
 // A SequenceLocalStorageMap holds (slot_id) -> (value, destructor) items for a
 // sequence. When a task runs, it is expected that a pointer to its sequence's
 // SequenceLocalStorageMap is set in TLS using
@@ -72,12 +84,39 @@ class BASE_EXPORT SequenceLocalStorageMap {
   // previously stored value.
   void Set(int slot_id, ValueDestructorPair value_destructor_pair);
 
+  // The size and alignment up to which trivially destructible values can be
+  // stored in the map itself, rather than on the heap.
+  static constexpr size_t kInlineValueSize = 2 * sizeof(void*);
+  static constexpr size_t kInlineValueAlignment = alignof(void*);
+
+  // Overwrites and destroys any value stored in |slot_id|, and returns the
+  // kInlineValueSize bytes of storage in which the caller constructs its new
+  // value, which is never destroyed. The storage doesn't move until the map
+  // is destroyed.
+  void* SetInline(int slot_id);
+
  private:
-  // Map from slot id to ValueDestructorPair.
-  // flat_map was chosen because there are expected to be relatively few entries
-  // in the map. For low number of entries, flat_map is known to perform better
-  // than other map implementations.
-  base::flat_map<int, ValueDestructorPair> sls_map_;
+  struct Entry {
+    Entry();
+    ~Entry();
+
+    // The id of the slot which stored the value, or -1.
+    int slot_id = -1;
+    ValueDestructorPair value_destructor_pair;
+    alignas(kInlineValueAlignment) unsigned char inline_value[kInlineValueSize];
+  };
+
+  // The entries are allocated by blocks, which are indexed directly by the
+  // index of their slot, and which never move, so that references to the
+  // values remain valid as the map grows.
+  static constexpr size_t kEntriesPerBlock = 16;
+
+  Entry* FindEntry(int slot_id);
+  // Returns the entry for |slot_id|, whose slot_id is only updated by the
+  // caller.
+  Entry& GetOrCreateEntry(int slot_id);
+
+  std::vector<std::unique_ptr<Entry[]>> blocks_;
 };
 
 // Within the scope of this object,
@@ -116,5 +116,45 @@ TEST(SequenceLocalStorageMapTest, DestructorCalledOnSetOverwrite) {
   EXPECT_TRUE(set_on_destruction2);
 }
 
+// Verify that a value stored inline overwrites the value in the slot.
+TEST(SequenceLocalStorageMapTest, SetInline) {
+  bool set_on_destruction = false;
+  SequenceLocalStorageMap sequence_local_storage_map;
+  ScopedSetSequenceLocalStorageMapForCurrentThread
+      scoped_sequence_local_storage_map(&sequence_local_storage_map);
+
+  sequence_local_storage_map.Set(
+      kSlotId, CreateValueDestructorPair<SetOnDestroy>(&set_on_destruction));
+
+  void* storage = sequence_local_storage_map.SetInline(kSlotId);
+  EXPECT_TRUE(set_on_destruction);
+  *static_cast<int*>(storage) = 5;
+  EXPECT_EQ(sequence_local_storage_map.Get(kSlotId), storage);
+  EXPECT_EQ(*static_cast<int*>(sequence_local_storage_map.Get(kSlotId)), 5);
+}
+
+// Verify that the value left by a slot isn't visible to the next slot with
+// the same index, and that it is destroyed once that slot stores a value.
+TEST(SequenceLocalStorageMapTest, ReusedSlotIndex) {
+  constexpr int kNextGenerationSlotId =
+      kSlotId + (1 << kSequenceLocalStorageSlotIndexBits);
+  bool set_on_destruction = false;
+  SequenceLocalStorageMap sequence_local_storage_map;
+  ScopedSetSequenceLocalStorageMapForCurrentThread
+      scoped_sequence_local_storage_map(&sequence_local_storage_map);
+
+  sequence_local_storage_map.Set(
+      kSlotId, CreateValueDestructorPair<SetOnDestroy>(&set_on_destruction));
+  EXPECT_EQ(sequence_local_storage_map.Get(kNextGenerationSlotId), nullptr);
+
+  sequence_local_storage_map.Set(kNextGenerationSlotId,
+                                 CreateValueDestructorPair<int>(5));
+  EXPECT_TRUE(set_on_destruction);
+  EXPECT_EQ(sequence_local_storage_map.Get(kSlotId), nullptr);
+  EXPECT_EQ(*static_cast<int*>(
+                sequence_local_storage_map.Get(kNextGenerationSlotId)),
+            5);
+}
+
 }  // namespace internal
 }  // namespace base
@@ -4,22 +4,67 @@
 
 #include "base/threading/sequence_local_storage_slot.h"
 
-#include <limits>
+#include <vector>
 
-#include "base/atomic_sequence_num.h"
 #include "base/check_op.h"
+#include "base/no_destructor.h"
+#include "base/synchronization/lock.h"
+#include "base/thread_annotations.h"
+#include "base/threading/sequence_local_storage_map.h"
 
 namespace base {
 namespace internal {
 
 namespace {
-AtomicSequenceNumber g_sequence_local_storage_slot_generator;
+
+// The generations fill the bits of a positive int above the index.
+constexpr int kMaxGeneration =
+    (1 << (31 - kSequenceLocalStorageSlotIndexBits)) - 1;
+
+struct SlotNumbers {
+  Lock lock;
+  // The generation of each index allocated so far.
+  std::vector<int> generations GUARDED_BY(lock);
+  // The indices of the destroyed slots, to be reused.
+  std::vector<int> free_indices GUARDED_BY(lock);
+};
+
+SlotNumbers& GetSlotNumbers() {
+  static NoDestructor<SlotNumbers> slot_numbers;
+  return *slot_numbers;
+}
+
 }  // namespace
 
 int GetNextSequenceLocalStorageSlotNumber() {
-  int slot_id = g_sequence_local_storage_slot_generator.GetNext();
-  DCHECK_LT(slot_id, std::numeric_limits<int>::max());
-  return slot_id;
+  SlotNumbers& slot_numbers = GetSlotNumbers();
+  AutoLock auto_lock(slot_numbers.lock);
+  int index;
+  if (!slot_numbers.free_indices.empty()) {
+    index = slot_numbers.free_indices.back();
+    slot_numbers.free_indices.pop_back();
+  } else {
+    index = static_cast<int>(slot_numbers.generations.size());
+    CHECK_LE(index, kSequenceLocalStorageSlotIndexMask);
+    slot_numbers.generations.push_back(0);
+  }
+  return (slot_numbers.generations[static_cast<size_t>(index)]
+          << kSequenceLocalStorageSlotIndexBits) |
+         index;
+}
+
+void ReleaseSequenceLocalStorageSlotNumber(int slot_id) {
+  SlotNumbers& slot_numbers = GetSlotNumbers();
+  AutoLock auto_lock(slot_numbers.lock);
+  const int index = slot_id & kSequenceLocalStorageSlotIndexMask;
+  int& generation = slot_numbers.generations[static_cast<size_t>(index)];
+  DCHECK_EQ(slot_id >> kSequenceLocalStorageSlotIndexBits, generation);
+  // An index whose generations are exhausted is never reused, so that the
+  // values left by its previous slots never match.
+  if (generation == kMaxGeneration)
+    return;
+  ++generation;
+  slot_numbers.free_indices.push_back(index);
 }
 
 }  // namespace internal
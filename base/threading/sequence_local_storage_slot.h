@@ -6,6 +6,8 @@
 #define BASE_THREADING_SEQUENCE_LOCAL_STORAGE_SLOT_H_
 
 #include <memory>
+#include <new>
+#include <type_traits>
 #include <utility>
 
 #include "base/base_export.h"
@@ -16,6 +18,8 @@ namespace base {
 
 namespace internal {
 BASE_EXPORT int GetNextSequenceLocalStorageSlotNumber();
+// Makes the index of |slot_id| available to the next slots.
+BASE_EXPORT void ReleaseSequenceLocalStorageSlotNumber(int slot_id);
 }
 
 // SequenceLocalStorageSlot allows arbitrary values to be stored and retrieved
@@ -46,6 +50,9 @@ BASE_EXPORT int GetNextSequenceLocalStorageSlotNumber();
 //   task_runner->PostTask(FROM_HERE, base::BindOnce(&Read));
 // }
 //
+// Small trivially destructible values are stored in the sequence's
+// SequenceLocalStorageMap itself, without a heap allocation.
+//
 // SequenceLocalStorageSlot must be used within the scope of a
 // ScopedSetSequenceLocalStorageMapForCurrentThread object.
 // Note: this is true on all ThreadPool workers and on threads bound to a
@@ -59,7 +66,9 @@ class SequenceLocalStorageSlot {
   SequenceLocalStorageSlot(const SequenceLocalStorageSlot&) = delete;
   SequenceLocalStorageSlot& operator=(const SequenceLocalStorageSlot&) = delete;
 
-  ~SequenceLocalStorageSlot() = default;
+  ~SequenceLocalStorageSlot() {
+    internal::ReleaseSequenceLocalStorageSlotNumber(slot_id_);
+  }
 
   operator bool() const { return GetValuePointer() != nullptr; }
 
@@ -95,12 +104,27 @@ class SequenceLocalStorageSlot {
   // pointer to the created object.
   template <class... Args>
   T* emplace(Args&&... args) {
-    T* value_ptr = new T(std::forward<Args>(args)...);
-    Adopt(value_ptr);
-    return value_ptr;
+    if constexpr (kStoredInline) {
+      void* storage =
+          internal::SequenceLocalStorageMap::GetForCurrentThread().SetInline(
+              slot_id_);
+      return new (storage) T(std::forward<Args>(args)...);
+    } else {
+      T* value_ptr = new T(std::forward<Args>(args)...);
+      Adopt(value_ptr);
+      return value_ptr;
+    }
   }
 
  private:
+  // Whether the values are stored in the SequenceLocalStorageMap, which
+  // doesn't destroy them.
+  static constexpr bool kStoredInline =
+      std::is_trivially_destructible<T>::value &&
+      std::is_same<Deleter, std::default_delete<T>>::value &&
+      sizeof(T) <= internal::SequenceLocalStorageMap::kInlineValueSize &&
+      alignof(T) <= internal::SequenceLocalStorageMap::kInlineValueAlignment;
+
   // Takes ownership of |value_ptr|.
   void Adopt(T* value_ptr) {
     // Since SequenceLocalStorageMap needs to store values of various types
@@ -0,0 +1,79 @@
+// Copyright 2022 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include <stddef.h>
+
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "base/strings/string_number_conversions.h"
+#include "base/threading/sequence_local_storage_map.h"
+#include "base/threading/sequence_local_storage_slot.h"
+#include "base/time/time.h"
+#include "testing/gtest/include/gtest/gtest.h"
+#include "testing/perf/perf_result_reporter.h"
+
+namespace base {
+
+namespace {
+
+constexpr size_t kCount = 5000000;
+
+constexpr char kMetricPrefixSequenceLocalStorage[] =
+    "SequenceLocalStorageSlot.";
+constexpr char kMetricReadOperationTime[] = "read_operation_time";
+
+perf_test::PerfResultReporter SetUpReporter(const std::string& story_name) {
+  perf_test::PerfResultReporter reporter(kMetricPrefixSequenceLocalStorage,
+                                         story_name);
+  reporter.RegisterImportantMetric(kMetricReadOperationTime, "ns");
+  return reporter;
+}
+
+// Measures GetOrCreateValue() on a slot of the current sequence, which also
+// uses |num_other_slots| other slots.
+template <typename T>
+void RunReadTest(const std::string& type_name) {
+  for (size_t num_other_slots : {0, 16, 128}) {
+    internal::SequenceLocalStorageMap sequence_local_storage;
+    internal::ScopedSetSequenceLocalStorageMapForCurrentThread
+        scoped_sequence_local_storage(&sequence_local_storage);
+
+    std::vector<std::unique_ptr<SequenceLocalStorageSlot<T>>> other_slots;
+    for (size_t i = 0; i < num_other_slots; ++i) {
+      other_slots.push_back(std::make_unique<SequenceLocalStorageSlot<T>>());
+      other_slots.back()->GetOrCreateValue();
+    }
+    SequenceLocalStorageSlot<T> slot;
+    const T* const value = &slot.GetOrCreateValue();
+
+    size_t num_mismatches = 0;
+    const TimeTicks start = TimeTicks::Now();
+    for (size_t i = 0; i < kCount; ++i) {
+      if (&slot.GetOrCreateValue() != value)
+        ++num_mismatches;
+    }
+    const TimeDelta elapsed = TimeTicks::Now() - start;
+    EXPECT_EQ(num_mismatches, 0u);
+
+    auto reporter = SetUpReporter(type_name + "_" +
+                                  NumberToString(num_other_slots) +
+                                  "_other_slots");
+    reporter.AddResult(kMetricReadOperationTime,
+                       static_cast<double>(elapsed.InNanoseconds()) / kCount);
+  }
+}
+
+}  // namespace
+
+TEST(SequenceLocalStorageSlotPerfTest, ReadInlineValue) {
+  RunReadTest<int>("int");
+}
+
+TEST(SequenceLocalStorageSlotPerfTest, ReadHeapValue) {
+  RunReadTest<std::string>("string");
+}
+
+}  // namespace base
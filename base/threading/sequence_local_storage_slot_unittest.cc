@@ -4,7 +4,9 @@
 
 #include "base/threading/sequence_local_storage_slot.h"
 
+#include <memory>
 #include <utility>
+#include <vector>
 
 #include "base/cxx17_backports.h"
 #include "base/memory/ptr_util.h"
@@ -126,6 +128,35 @@ TEST_F(SequenceLocalStorageSlotTest, GetWithoutSetDefaultConstructsPOD) {
   EXPECT_EQ(slot.GetOrCreateValue(), nullptr);
 }
 
+// Verify that the values stored inline don't move as other slots store theirs.
+TEST_F(SequenceLocalStorageSlotTest, InlineValueStableAsMapGrows) {
+  SequenceLocalStorageSlot<int> slot;
+  int& value = slot.GetOrCreateValue();
+  value = 5;
+
+  std::vector<std::unique_ptr<SequenceLocalStorageSlot<int>>> other_slots;
+  for (int i = 0; i < 100; ++i) {
+    other_slots.push_back(std::make_unique<SequenceLocalStorageSlot<int>>());
+    other_slots.back()->emplace(i);
+  }
+
+  EXPECT_EQ(&value, slot.GetValuePointer());
+  EXPECT_EQ(*slot, 5);
+  for (int i = 0; i < 100; ++i)
+    EXPECT_EQ(*(*other_slots[i]), i);
+}
+
+// Verify that a slot doesn't see the value of a destroyed slot.
+TEST_F(SequenceLocalStorageSlotTest, ValueOfDestroyedSlot) {
+  {
+    SequenceLocalStorageSlot<int> slot;
+    slot.emplace(5);
+  }
+  SequenceLocalStorageSlot<int> slot;
+  EXPECT_FALSE(slot);
+  EXPECT_EQ(slot.GetOrCreateValue(), 0);
+}
+
 // Verify that the value of a slot is specific to a SequenceLocalStorageMap
 TEST(SequenceLocalStorageSlotMultipleMapTest, EmplaceGetMultipleMapsOneSlot) {
   SequenceLocalStorageSlot<unsigned int> slot;
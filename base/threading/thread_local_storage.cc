@@ -4,7 +4,12 @@
 
 #include "base/threading/thread_local_storage.h"
 
+#include <limits.h>
+#include <string.h>
+
+#include <algorithm>
 #include <atomic>
+#include <utility>
 
 #include "base/check_op.h"
 #include "base/compiler_specific.h"
@@ -39,7 +44,16 @@ using base::internal::PlatformThreadLocalStorage;
 //
 // Using a single OS TLS slot, Chrome TLS allocates an array on demand for the
 // lifetime of each thread that requests Chrome TLS data. Each per-thread TLS
-// array matches the length of the per-process global metadata array.
+// array holds the entries of the first kNumInlineSlots slots inline, and those
+// of the other slots in an overflow array, grown on demand up to the length of
+// the per-process global metadata array, so that there's no limit on the
+// number of slots.
+//
+// Where thread_local doesn't allocate on first access, the per-thread array is
+// a zero-initialized thread_local, with the initial-exec TLS model on ELF, so
+// Slot::Get()/Set() don't go through the OS TLS API. The OS TLS slot then only
+// tracks the state of the thread, so that the destructors are called when it
+// exits.
 //
 // A per-process global TLS metadata array tracks information about each item in
 // the per-thread array:
@@ -79,12 +93,12 @@ std::atomic<PlatformThreadLocalStorage::TLSKey> g_native_tls_key{
     PlatformThreadLocalStorage::TLS_KEY_OUT_OF_INDEXES};
 
 // The OS TLS slot has the following states. The TLS slot's lower 2 bits contain
-// the state, the upper bits the TlsVectorEntry*.
+// the state, the upper bits the TlsVector*.
 //   * kUninitialized: Any call to Slot::Get()/Set() will create the base
 //     per-thread TLS state. kUninitialized must be null.
 //   * kInUse: value has been created and is in use.
 //   * kDestroying: Set when the thread is exiting prior to deleting any of the
-//     values stored in the TlsVectorEntry*. This state is necessary so that
+//     values stored in the TlsVector*. This state is necessary so that
 //     sequence/task checks won't be done while in the process of deleting the
 //     tls entries (see comments in SequenceCheckerImpl for more details).
 //   * kDestroyed: All of the values in the vector have been deallocated and
@@ -140,8 +154,25 @@ static_assert(static_cast<int>(TlsVectorState::kMaxValue) <=
 static_assert(static_cast<int>(TlsVectorState::kUninitialized) == 0,
               "kUninitialized must be null");
 
-// The maximum number of slots in our thread local storage stack.
-constexpr int kThreadLocalStorageSize = 256;
+// The number of slots whose entries are inline in the per-thread vector, the
+// first ones to be allocated. Kept small, since the vector is copied on the
+// stack, and may be in the static TLS block.
+constexpr int kNumInlineSlots = 32;
+
+// thread_local allocates on the first access on macOS and Android, and isn't
+// exported by the component builds on Windows, see partition_alloc_config.h.
+#if !BUILDFLAG(IS_APPLE) && !BUILDFLAG(IS_ANDROID) && \
+    !(BUILDFLAG(IS_WIN) && defined(COMPONENT_BUILD))
+#define THREAD_LOCAL_TLS_VECTOR
+#endif
+
+#if defined(THREAD_LOCAL_TLS_VECTOR) && defined(COMPILER_GCC) && \
+    !BUILDFLAG(IS_WIN)
+// Accessed without a call to __tls_get_addr(), even from a shared library.
+#define TLS_VECTOR_MODEL __attribute__((tls_model("initial-exec")))
+#else
+#define TLS_VECTOR_MODEL
+#endif
 
 enum TlsStatus {
   FREE,
@@ -163,44 +194,72 @@ struct TlsVectorEntry {
   uint32_t version;
 };
 
+struct TlsVector {
+  TlsVectorEntry entries[kNumInlineSlots];
+  // The entries of the slots from kNumInlineSlots on, which are null beyond
+  // |num_overflow_entries|.
+  TlsVectorEntry* overflow_entries;
+  size_t num_overflow_entries;
+};
+
 // This lock isn't needed until after we've constructed the per-thread TLS
 // vector, so it's safe to use.
 base::Lock* GetTLSMetadataLock() {
   static auto* lock = new base::Lock();
   return lock;
 }
-TlsMetadata g_tls_metadata[kThreadLocalStorageSize];
+TlsMetadata g_tls_metadata[kNumInlineSlots];
 size_t g_last_assigned_slot = 0;
+// The metadata of the slots from kNumInlineSlots on, only grown.
+TlsMetadata* g_overflow_tls_metadata = nullptr;
+size_t g_num_overflow_tls_metadata = 0;
+
+#if defined(THREAD_LOCAL_TLS_VECTOR)
+// Zero-initialized, so that the slots read as null until the thread is set up,
+// without allocating on first access.
+thread_local TlsVector g_tls_vector TLS_VECTOR_MODEL;
+thread_local TlsVectorState g_tls_vector_state TLS_VECTOR_MODEL;
+#endif
 
 // The maximum number of times to try to clear slots by calling destructors.
 // Use pthread naming convention for clarity.
-constexpr int kMaxDestructorIterations = kThreadLocalStorageSize;
+constexpr int kMaxDestructorIterations = 256;
+
+// Returns the metadata of |slot|. Requires the metadata lock.
+TlsMetadata& GetTlsMetadata(int slot) {
+  if (slot < kNumInlineSlots)
+    return g_tls_metadata[slot];
+  DCHECK_LT(static_cast<size_t>(slot - kNumInlineSlots),
+            g_num_overflow_tls_metadata);
+  return g_overflow_tls_metadata[slot - kNumInlineSlots];
+}
 
 // Sets the value and state of the vector.
 void SetTlsVectorValue(PlatformThreadLocalStorage::TLSKey key,
-                       TlsVectorEntry* tls_data,
+                       TlsVector* tls_vector,
                        TlsVectorState state) {
-  DCHECK(tls_data || (state == TlsVectorState::kUninitialized) ||
+  DCHECK(tls_vector || (state == TlsVectorState::kUninitialized) ||
          (state == TlsVectorState::kDestroyed));
   PlatformThreadLocalStorage::SetTLSValue(
-      key, reinterpret_cast<void*>(reinterpret_cast<uintptr_t>(tls_data) |
+      key, reinterpret_cast<void*>(reinterpret_cast<uintptr_t>(tls_vector) |
                                    static_cast<uintptr_t>(state)));
 }
 
 // Returns the tls vector and current state from the raw tls value.
 TlsVectorState GetTlsVectorStateAndValue(void* tls_value,
-                                         TlsVectorEntry** entry = nullptr) {
-  if (entry) {
-    *entry = reinterpret_cast<TlsVectorEntry*>(
+                                         TlsVector** tls_vector = nullptr) {
+  if (tls_vector) {
+    *tls_vector = reinterpret_cast<TlsVector*>(
         reinterpret_cast<uintptr_t>(tls_value) & ~kVectorStateBitMask);
   }
   return static_cast<TlsVectorState>(reinterpret_cast<uintptr_t>(tls_value) &
                                      kVectorStateBitMask);
 }
 
+#if !defined(THREAD_LOCAL_TLS_VECTOR)
 // Returns the tls vector and state using the tls key.
 TlsVectorState GetTlsVectorStateAndValue(PlatformThreadLocalStorage::TLSKey key,
-                                         TlsVectorEntry** entry = nullptr) {
+                                         TlsVector** tls_vector = nullptr) {
 // Only on x86_64, the implementation is not stable on ARM64. For instance, in
 // macOS 11, the TPIDRRO_EL0 registers holds the CPU index in the low bits,
 // which is not the case in macOS 12. See libsyscall/os/tsd.h in XNU
@@ -236,12 +295,58 @@ TlsVectorState GetTlsVectorStateAndValue(PlatformThreadLocalStorage::TLSKey key,
   asm("movq %%gs:(,%1,8), %0;" : "=r"(platform_tls_value) : "r"(key));
 
   return GetTlsVectorStateAndValue(reinterpret_cast<void*>(platform_tls_value),
-                                   entry);
+                                   tls_vector);
 #else
   return GetTlsVectorStateAndValue(PlatformThreadLocalStorage::GetTLSValue(key),
-                                   entry);
+                                   tls_vector);
 #endif
 }
+#endif  // !defined(THREAD_LOCAL_TLS_VECTOR)
+
+// Returns the state of the vector of the current thread, and the vector in
+// |tls_vector|, which is null unless in use or being destroyed. With a
+// thread_local vector, it is always returned, and zero unless in use.
+ALWAYS_INLINE TlsVectorState
+GetCurrentTlsVectorStateAndValue(TlsVector** tls_vector = nullptr) {
+#if defined(THREAD_LOCAL_TLS_VECTOR)
+  if (tls_vector)
+    *tls_vector = &g_tls_vector;
+  return g_tls_vector_state;
+#else
+  return GetTlsVectorStateAndValue(
+      g_native_tls_key.load(std::memory_order_relaxed), tls_vector);
+#endif
+}
+
+// Sets the vector and state of the current thread.
+void SetCurrentTlsVectorValue(TlsVector* tls_vector, TlsVectorState state) {
+#if defined(THREAD_LOCAL_TLS_VECTOR)
+  DCHECK(!tls_vector || tls_vector == &g_tls_vector);
+  g_tls_vector_state = state;
+#endif
+  // Also set with a thread_local vector, since the OS only calls the thread
+  // exit callback for a non-null value.
+  SetTlsVectorValue(g_native_tls_key.load(std::memory_order_relaxed),
+                    tls_vector, state);
+}
+
+// Grows the overflow entries of |tls_vector| to at least |num_entries|.
+NOINLINE void GrowOverflowEntries(TlsVector* tls_vector, size_t num_entries) {
+  num_entries = std::max({num_entries, 2 * tls_vector->num_overflow_entries,
+                          static_cast<size_t>(kNumInlineSlots)});
+  TlsVectorEntry* overflow_entries = new TlsVectorEntry[num_entries]();
+  // The allocator may have grown them meanwhile, if it uses overflow slots.
+  if (tls_vector->num_overflow_entries >= num_entries) {
+    delete[] overflow_entries;
+    return;
+  }
+  if (tls_vector->num_overflow_entries) {
+    memcpy(overflow_entries, tls_vector->overflow_entries,
+           tls_vector->num_overflow_entries * sizeof(TlsVectorEntry));
+  }
+  delete[] std::exchange(tls_vector->overflow_entries, overflow_entries);
+  tls_vector->num_overflow_entries = num_entries;
+}
 
 // This function is called to initialize our entire Chromium TLS system.
 // It may be called very early, and we need to complete most all of the setup
@@ -249,7 +354,7 @@ TlsVectorState GetTlsVectorStateAndValue(PlatformThreadLocalStorage::TLSKey key,
 // recursively depend on this initialization.
 // As a result, we use Atomics, and avoid anything (like a singleton) that might
 // require memory allocations.
-TlsVectorEntry* ConstructTlsVector() {
+TlsVector* ConstructTlsVector() {
   PlatformThreadLocalStorage::TLSKey key =
       g_native_tls_key.load(std::memory_order_relaxed);
   if (key == PlatformThreadLocalStorage::TLS_KEY_OUT_OF_INDEXES) {
@@ -281,8 +386,13 @@ TlsVectorEntry* ConstructTlsVector() {
       key = g_native_tls_key.load(std::memory_order_relaxed);
     }
   }
-  CHECK_EQ(GetTlsVectorStateAndValue(key), TlsVectorState::kUninitialized);
+  CHECK_EQ(GetCurrentTlsVectorStateAndValue(), TlsVectorState::kUninitialized);
 
+#if defined(THREAD_LOCAL_TLS_VECTOR)
+  // Already zero-initialized, and cleared once destroyed.
+  SetCurrentTlsVectorValue(&g_tls_vector, TlsVectorState::kInUse);
+  return &g_tls_vector;
+#else
   // Some allocators, such as TCMalloc, make use of thread local storage. As a
   // result, any attempt to call new (or malloc) will lazily cause such a system
   // to initialize, which will include registering for a TLS key. If we are not
@@ -291,20 +401,26 @@ TlsVectorEntry* ConstructTlsVector() {
   // allocated vector, so that we don't have dependence on our allocator until
   // our service is in place. (i.e., don't even call new until after we're
   // setup)
-  TlsVectorEntry stack_allocated_tls_data[kThreadLocalStorageSize];
-  memset(stack_allocated_tls_data, 0, sizeof(stack_allocated_tls_data));
+  TlsVector stack_allocated_tls_vector;
+  memset(&stack_allocated_tls_vector, 0, sizeof(stack_allocated_tls_vector));
   // Ensure that any rentrant calls change the temp version.
-  SetTlsVectorValue(key, stack_allocated_tls_data, TlsVectorState::kInUse);
-
-  // Allocate an array to store our data.
-  TlsVectorEntry* tls_data = new TlsVectorEntry[kThreadLocalStorageSize];
-  memcpy(tls_data, stack_allocated_tls_data, sizeof(stack_allocated_tls_data));
-  SetTlsVectorValue(key, tls_data, TlsVectorState::kInUse);
-  return tls_data;
+  SetCurrentTlsVectorValue(&stack_allocated_tls_vector, TlsVectorState::kInUse);
+
+  // Allocate a vector to store our data.
+  TlsVector* tls_vector = new TlsVector;
+  memcpy(tls_vector, &stack_allocated_tls_vector,
+         sizeof(stack_allocated_tls_vector));
+  SetCurrentTlsVectorValue(tls_vector, TlsVectorState::kInUse);
+  return tls_vector;
+#endif
 }
 
-void OnThreadExitInternal(TlsVectorEntry* tls_data) {
-  DCHECK(tls_data);
+void OnThreadExitInternal(TlsVector* tls_vector) {
+  DCHECK(tls_vector);
+#if defined(THREAD_LOCAL_TLS_VECTOR)
+  // Not allocated, so there's no dependence on an allocator left.
+  SetCurrentTlsVectorValue(tls_vector, TlsVectorState::kDestroying);
+#else
   // Some allocators, such as TCMalloc, use TLS. As a result, when a thread
   // terminates, one of the destructor calls we make may be to shut down an
   // allocator. We have to be careful that after we've shutdown all of the known
@@ -313,17 +429,20 @@ void OnThreadExitInternal(TlsVectorEntry* tls_data) {
   // call to follow). We handle this problem as follows: Switch to using a stack
   // allocated vector, so that we don't have dependence on our allocator after
   // we have called all g_tls_metadata destructors. (i.e., don't even call
-  // delete[] after we're done with destructors.)
-  TlsVectorEntry stack_allocated_tls_data[kThreadLocalStorageSize];
-  memcpy(stack_allocated_tls_data, tls_data, sizeof(stack_allocated_tls_data));
+  // delete after we're done with destructors.)
+  TlsVector stack_allocated_tls_vector;
+  memcpy(&stack_allocated_tls_vector, tls_vector,
+         sizeof(stack_allocated_tls_vector));
   // Ensure that any re-entrant calls change the temp version.
-  PlatformThreadLocalStorage::TLSKey key =
-      g_native_tls_key.load(std::memory_order_relaxed);
-  SetTlsVectorValue(key, stack_allocated_tls_data, TlsVectorState::kDestroying);
-  delete[] tls_data;  // Our last dependence on an allocator.
+  SetCurrentTlsVectorValue(&stack_allocated_tls_vector,
+                           TlsVectorState::kDestroying);
+  delete tls_vector;  // Our last dependence on an allocator.
+  tls_vector = &stack_allocated_tls_vector;
+#endif
 
-  // Snapshot the TLS Metadata so we don't have to lock on every access.
-  TlsMetadata tls_metadata[kThreadLocalStorageSize];
+  // Snapshot the TLS Metadata so we don't have to lock on every access. The
+  // overflow slots, used after the allocator's, are looked up under the lock.
+  TlsMetadata tls_metadata[kNumInlineSlots];
   {
     base::AutoLock auto_lock(*GetTLSMetadataLock());
     memcpy(tls_metadata, g_tls_metadata, sizeof(g_tls_metadata));
@@ -339,31 +458,62 @@ void OnThreadExitInternal(TlsVectorEntry* tls_data) {
     // allocator) and should also be destroyed last. If we get the order wrong,
     // then we'll iterate several more times, so it is really not that critical
     // (but it might help).
-    for (int slot = 0; slot < kThreadLocalStorageSize; ++slot) {
-      void* tls_value = stack_allocated_tls_data[slot].data;
+    for (int slot = 0; slot < kNumInlineSlots; ++slot) {
+      TlsVectorEntry& entry = tls_vector->entries[slot];
+      void* tls_value = entry.data;
       if (!tls_value || tls_metadata[slot].status == TlsStatus::FREE ||
-          stack_allocated_tls_data[slot].version != tls_metadata[slot].version)
+          entry.version != tls_metadata[slot].version)
         continue;
 
       base::ThreadLocalStorage::TLSDestructorFunc destructor =
           tls_metadata[slot].destructor;
       if (!destructor)
         continue;
-      stack_allocated_tls_data[slot].data = nullptr;  // pre-clear the slot.
+      entry.data = nullptr;  // pre-clear the slot.
       destructor(tls_value);
       // Any destructor might have called a different service, which then set a
       // different slot to a non-null value. Hence we need to check the whole
       // vector again. This is a pthread standard.
       need_to_scan_destructors = true;
     }
+    // A destructor may grow the overflow entries.
+    for (size_t i = 0; i < tls_vector->num_overflow_entries; ++i) {
+      TlsVectorEntry& entry = tls_vector->overflow_entries[i];
+      void* tls_value = entry.data;
+      if (!tls_value)
+        continue;
+
+      base::ThreadLocalStorage::TLSDestructorFunc destructor;
+      {
+        base::AutoLock auto_lock(*GetTLSMetadataLock());
+        const TlsMetadata& metadata = g_overflow_tls_metadata[i];
+        if (metadata.status == TlsStatus::FREE ||
+            entry.version != metadata.version)
+          continue;
+        destructor = metadata.destructor;
+      }
+      if (!destructor)
+        continue;
+      entry.data = nullptr;  // pre-clear the slot.
+      destructor(tls_value);
+      need_to_scan_destructors = true;
+    }
     if (--remaining_attempts <= 0) {
       NOTREACHED();  // Destructors might not have been called.
       break;
     }
   }
 
+  // Only allocated by the threads which use more than kNumInlineSlots slots,
+  // unlike the allocators, which get their slots early.
+  delete[] tls_vector->overflow_entries;
+#if defined(THREAD_LOCAL_TLS_VECTOR)
+  // So that the slots read as null, and the vector can be set up again.
+  memset(tls_vector, 0, sizeof(*tls_vector));
+#endif
+
   // Remove our stack allocated vector.
-  SetTlsVectorValue(key, nullptr, TlsVectorState::kDestroyed);
+  SetCurrentTlsVectorValue(nullptr, TlsVectorState::kDestroyed);
 }
 
 }  // namespace
@@ -378,8 +528,8 @@ void PlatformThreadLocalStorage::OnThreadExit() {
       g_native_tls_key.load(std::memory_order_relaxed);
   if (key == PlatformThreadLocalStorage::TLS_KEY_OUT_OF_INDEXES)
     return;
-  TlsVectorEntry* tls_vector = nullptr;
-  const TlsVectorState state = GetTlsVectorStateAndValue(key, &tls_vector);
+  TlsVector* tls_vector = nullptr;
+  const TlsVectorState state = GetCurrentTlsVectorStateAndValue(&tls_vector);
 
   // On Windows, thread destruction callbacks are only invoked once per module,
   // so there should be no way that this could be invoked twice.
@@ -395,12 +545,10 @@ void PlatformThreadLocalStorage::OnThreadExit(void* value) {
   // On posix this function may be called twice. The first pass calls dtors and
   // sets state to kDestroyed. The second pass sets kDestroyed to
   // kUninitialized.
-  TlsVectorEntry* tls_vector = nullptr;
+  TlsVector* tls_vector = nullptr;
   const TlsVectorState state = GetTlsVectorStateAndValue(value, &tls_vector);
   if (state == TlsVectorState::kDestroyed) {
-    PlatformThreadLocalStorage::TLSKey key =
-        g_native_tls_key.load(std::memory_order_relaxed);
-    SetTlsVectorValue(key, nullptr, TlsVectorState::kUninitialized);
+    SetCurrentTlsVectorValue(nullptr, TlsVectorState::kUninitialized);
     return;
   }
 
@@ -416,7 +564,7 @@ bool ThreadLocalStorage::HasBeenDestroyed() {
       g_native_tls_key.load(std::memory_order_relaxed);
   if (key == PlatformThreadLocalStorage::TLS_KEY_OUT_OF_INDEXES)
     return false;
-  const TlsVectorState state = GetTlsVectorStateAndValue(key);
+  const TlsVectorState state = GetCurrentTlsVectorStateAndValue();
   return state == TlsVectorState::kDestroying ||
          state == TlsVectorState::kDestroyed;
 }
@@ -425,77 +573,128 @@ void ThreadLocalStorage::Slot::Initialize(TLSDestructorFunc destructor) {
   PlatformThreadLocalStorage::TLSKey key =
       g_native_tls_key.load(std::memory_order_relaxed);
   if (key == PlatformThreadLocalStorage::TLS_KEY_OUT_OF_INDEXES ||
-      GetTlsVectorStateAndValue(key) == TlsVectorState::kUninitialized) {
+      GetCurrentTlsVectorStateAndValue() == TlsVectorState::kUninitialized) {
     ConstructTlsVector();
   }
 
-  // Grab a new slot.
-  {
-    base::AutoLock auto_lock(*GetTLSMetadataLock());
-    for (int i = 0; i < kThreadLocalStorageSize; ++i) {
-      // Tracking the last assigned slot is an attempt to find the next
-      // available slot within one iteration. Under normal usage, slots remain
-      // in use for the lifetime of the process (otherwise before we reclaimed
-      // slots, we would have run out of slots). This makes it highly likely the
-      // next slot is going to be a free slot.
-      size_t slot_candidate =
-          (g_last_assigned_slot + 1 + i) % kThreadLocalStorageSize;
-      if (g_tls_metadata[slot_candidate].status == TlsStatus::FREE) {
-        g_tls_metadata[slot_candidate].status = TlsStatus::IN_USE;
-        g_tls_metadata[slot_candidate].destructor = destructor;
-        g_last_assigned_slot = slot_candidate;
-        DCHECK_EQ(kInvalidSlotValue, slot_);
-        slot_ = slot_candidate;
-        version_ = g_tls_metadata[slot_candidate].version;
-        break;
+  // Grab a new slot. The overflow metadata is grown without holding the lock,
+  // since the allocator may use TLS.
+  TlsMetadata* overflow_metadata = nullptr;
+  size_t num_overflow_metadata = 0;
+  while (slot_ == kInvalidSlotValue) {
+    {
+      base::AutoLock auto_lock(*GetTLSMetadataLock());
+      // Unless another thread grew it meanwhile.
+      if (num_overflow_metadata > g_num_overflow_tls_metadata) {
+        if (g_num_overflow_tls_metadata) {
+          memcpy(overflow_metadata, g_overflow_tls_metadata,
+                 g_num_overflow_tls_metadata * sizeof(TlsMetadata));
+        }
+        std::swap(overflow_metadata, g_overflow_tls_metadata);
+        std::swap(num_overflow_metadata, g_num_overflow_tls_metadata);
+      }
+
+      for (int i = 0; i < kNumInlineSlots; ++i) {
+        // Tracking the last assigned slot is an attempt to find the next
+        // available slot within one iteration. Under normal usage, slots
+        // remain in use for the lifetime of the process (otherwise before we
+        // reclaimed slots, we would have run out of slots). This makes it
+        // highly likely the next slot is going to be a free slot.
+        size_t slot_candidate =
+            (g_last_assigned_slot + 1 + i) % kNumInlineSlots;
+        if (g_tls_metadata[slot_candidate].status == TlsStatus::FREE) {
+          g_last_assigned_slot = slot_candidate;
+          slot_ = slot_candidate;
+          break;
+        }
+      }
+      for (size_t i = 0;
+           slot_ == kInvalidSlotValue && i < g_num_overflow_tls_metadata;
+           ++i) {
+        if (g_overflow_tls_metadata[i].status == TlsStatus::FREE)
+          slot_ = kNumInlineSlots + i;
+      }
+
+      if (slot_ != kInvalidSlotValue) {
+        TlsMetadata& metadata = GetTlsMetadata(slot_);
+        metadata.status = TlsStatus::IN_USE;
+        metadata.destructor = destructor;
+        version_ = metadata.version;
+      } else {
+        CHECK_LT(g_num_overflow_tls_metadata,
+                 static_cast<size_t>(INT_MAX / 2 - kNumInlineSlots));
+        num_overflow_metadata =
+            std::max(2 * g_num_overflow_tls_metadata,
+                     static_cast<size_t>(kNumInlineSlots));
       }
     }
+    // The replaced or unused metadata.
+    delete[] overflow_metadata;
+    overflow_metadata = slot_ == kInvalidSlotValue
+                            ? new TlsMetadata[num_overflow_metadata]()
+                            : nullptr;
   }
-  CHECK_NE(slot_, kInvalidSlotValue);
-  CHECK_LT(slot_, kThreadLocalStorageSize);
 }
 
 void ThreadLocalStorage::Slot::Free() {
   DCHECK_NE(slot_, kInvalidSlotValue);
-  DCHECK_LT(slot_, kThreadLocalStorageSize);
   {
     base::AutoLock auto_lock(*GetTLSMetadataLock());
-    g_tls_metadata[slot_].status = TlsStatus::FREE;
-    g_tls_metadata[slot_].destructor = nullptr;
-    ++(g_tls_metadata[slot_].version);
+    TlsMetadata& metadata = GetTlsMetadata(slot_);
+    metadata.status = TlsStatus::FREE;
+    metadata.destructor = nullptr;
+    ++metadata.version;
   }
   slot_ = kInvalidSlotValue;
 }
 
 void* ThreadLocalStorage::Slot::Get() const {
-  TlsVectorEntry* tls_data = nullptr;
-  const TlsVectorState state = GetTlsVectorStateAndValue(
-      g_native_tls_key.load(std::memory_order_relaxed), &tls_data);
+  TlsVector* tls_vector = nullptr;
+  const TlsVectorState state = GetCurrentTlsVectorStateAndValue(&tls_vector);
   DCHECK_NE(state, TlsVectorState::kDestroyed);
-  if (!tls_data)
+  if (!tls_vector)
     return nullptr;
   DCHECK_NE(slot_, kInvalidSlotValue);
-  DCHECK_LT(slot_, kThreadLocalStorageSize);
+  const TlsVectorEntry* entry;
+  if (LIKELY(slot_ < kNumInlineSlots)) {
+    entry = &tls_vector->entries[slot_];
+  } else {
+    const size_t index = slot_ - kNumInlineSlots;
+    if (index >= tls_vector->num_overflow_entries)
+      return nullptr;
+    entry = &tls_vector->overflow_entries[index];
+  }
   // Version mismatches means this slot was previously freed.
-  if (tls_data[slot_].version != version_)
+  if (entry->version != version_)
     return nullptr;
-  return tls_data[slot_].data;
+  return entry->data;
 }
 
 void ThreadLocalStorage::Slot::Set(void* value) {
-  TlsVectorEntry* tls_data = nullptr;
-  const TlsVectorState state = GetTlsVectorStateAndValue(
-      g_native_tls_key.load(std::memory_order_relaxed), &tls_data);
+  TlsVector* tls_vector = nullptr;
+  const TlsVectorState state = GetCurrentTlsVectorStateAndValue(&tls_vector);
   DCHECK_NE(state, TlsVectorState::kDestroyed);
-  if (UNLIKELY(!tls_data)) {
+  if (UNLIKELY(state == TlsVectorState::kUninitialized ||
+               state == TlsVectorState::kDestroyed)) {
     if (!value)
       return;
-    tls_data = ConstructTlsVector();
+    tls_vector = ConstructTlsVector();
   }
   DCHECK_NE(slot_, kInvalidSlotValue);
-  DCHECK_LT(slot_, kThreadLocalStorageSize);
-  tls_data[slot_].data = value;
-  tls_data[slot_].version = version_;
+  TlsVectorEntry* entry;
+  if (LIKELY(slot_ < kNumInlineSlots)) {
+    entry = &tls_vector->entries[slot_];
+  } else {
+    const size_t index = slot_ - kNumInlineSlots;
+    if (UNLIKELY(index >= tls_vector->num_overflow_entries)) {
+      if (!value)
+        return;
+      GrowOverflowEntries(tls_vector, index + 1);
+    }
+    entry = &tls_vector->overflow_entries[index];
+  }
+  entry->data = value;
+  entry->version = version_;
 }
 
 ThreadLocalStorage::Slot::Slot(TLSDestructorFunc destructor) {
@@ -41,6 +41,8 @@ constexpr char kMetricBaseReadWrite[] = "read_write";
 constexpr char kMetricSuffixThroughput[] = "_throughput";
 constexpr char kMetricSuffixOperationTime[] = "_operation_time";
 constexpr char kStoryBaseTLS[] = "thread_local_storage";
+constexpr char kStoryBaseTLSOverflowSlot[] =
+    "thread_local_storage_overflow_slot";
 #if BUILDFLAG(IS_WIN)
 constexpr char kStoryBasePlatformFLS[] = "platform_fiber_local_storage";
 #endif  // BUILDFLAG(IS_WIN)
@@ -186,6 +188,21 @@ TEST_F(ThreadLocalStoragePerfTest, ThreadLocalStorage) {
             kCount, 4);
 }
 
+TEST_F(ThreadLocalStoragePerfTest, ThreadLocalStorageOverflowSlot) {
+  // Allocated after many others, so that its entries are in the overflow
+  // array of the threads.
+  std::vector<std::unique_ptr<ThreadLocalStorage::Slot>> other_slots;
+  for (int i = 0; i < 255; ++i)
+    other_slots.push_back(std::make_unique<ThreadLocalStorage::Slot>());
+  ThreadLocalStorage::Slot tls;
+  auto read = [&]() { return reinterpret_cast<intptr_t>(tls.Get()); };
+  auto write = [&](intptr_t value) { tls.Set(reinterpret_cast<void*>(value)); };
+
+  Benchmark(kStoryBaseTLSOverflowSlot, read, write, 10000000, 1);
+  Benchmark(std::string(kStoryBaseTLSOverflowSlot) + kStorySuffixFourThreads,
+            read, write, kCount, 4);
+}
+
 #if BUILDFLAG(IS_WIN)
 
 void WINAPI destroy(void*) {}
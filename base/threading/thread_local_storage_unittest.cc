@@ -4,6 +4,9 @@
 
 #include "base/threading/thread_local_storage.h"
 
+#include <memory>
+#include <vector>
+
 #include "base/memory/raw_ptr.h"
 #include "build/build_config.h"
 
@@ -100,6 +103,36 @@ void ThreadLocalStorageCleanup(void *value) {
   TLSSlot().Set(value);
 }
 
+void CountDestruction(void* value) {
+  ++*static_cast<int*>(value);
+}
+
+// Sets distinct slots on its thread, each to a counter of its destructions.
+class ManySlotsRunner : public DelegateSimpleThread::Delegate {
+ public:
+  ManySlotsRunner(std::vector<std::unique_ptr<ThreadLocalStorage::Slot>>* slots,
+                  std::vector<int>* destructions)
+      : slots_(slots), destructions_(destructions) {}
+
+  ManySlotsRunner(const ManySlotsRunner&) = delete;
+  ManySlotsRunner& operator=(const ManySlotsRunner&) = delete;
+
+  ~ManySlotsRunner() override = default;
+
+  void Run() override {
+    for (size_t i = 0; i < slots_->size(); ++i) {
+      EXPECT_EQ(nullptr, (*slots_)[i]->Get());
+      (*slots_)[i]->Set(&(*destructions_)[i]);
+    }
+    for (size_t i = 0; i < slots_->size(); ++i)
+      EXPECT_EQ(&(*destructions_)[i], (*slots_)[i]->Get());
+  }
+
+ private:
+  raw_ptr<std::vector<std::unique_ptr<ThreadLocalStorage::Slot>>> slots_;
+  raw_ptr<std::vector<int>> destructions_;
+};
+
 #if BUILDFLAG(IS_POSIX)
 constexpr intptr_t kDummyValue = 0xABCD;
 constexpr size_t kKeyCount = 20;
@@ -259,6 +292,31 @@ TEST(ThreadLocalStorageTest, TLSReclaim) {
   }
 }
 
+TEST(ThreadLocalStorageTest, ManySlots) {
+  // More slots than there are inline in the per-thread vector, or than there
+  // used to be at all.
+  constexpr size_t kNumSlots = 300;
+  std::vector<std::unique_ptr<ThreadLocalStorage::Slot>> slots;
+  for (size_t i = 0; i < kNumSlots; ++i)
+    slots.push_back(std::make_unique<ThreadLocalStorage::Slot>(
+        &CountDestruction));
+  std::vector<int> destructions(kNumSlots);
+
+  ManySlotsRunner runner(&slots, &destructions);
+  DelegateSimpleThread thread(&runner, "tls thread");
+  thread.Start();
+  thread.Join();
+  for (size_t i = 0; i < kNumSlots; ++i)
+    EXPECT_EQ(1, destructions[i]);
+
+  // A freed slot is reused, zero-initialized.
+  slots.pop_back();
+  ThreadLocalStorage::Slot slot(nullptr);
+  EXPECT_EQ(nullptr, slot.Get());
+  slot.Set(reinterpret_cast<void*>(0xBAADF00D));
+  EXPECT_EQ(reinterpret_cast<void*>(0xBAADF00D), slot.Get());
+}
+
 #if BUILDFLAG(IS_POSIX)
 // Unlike POSIX, Windows does not iterate through the OS TLS to cleanup any
 // values there. Instead a per-module thread destruction function is called.
@@ -20,4 +20,15 @@ const DefaultTickClock* DefaultTickClock::GetInstance() {
   return default_tick_clock.get();
 }
 
+DefaultCoarseTickClock::~DefaultCoarseTickClock() = default;
+
+TimeTicks DefaultCoarseTickClock::NowTicks() const {
+  return TimeTicks::NowCoarse();
+}
+
+const DefaultCoarseTickClock* DefaultCoarseTickClock::GetInstance() {
+  static const base::NoDestructor<DefaultCoarseTickClock> tick_clock;
+  return tick_clock.get();
+}
+
 }  // namespace base
@@ -27,6 +27,20 @@ class BASE_EXPORT DefaultTickClock : public TickClock {
   static const DefaultTickClock* GetInstance();
 };
 
+// Returns TimeTicks::NowCoarse(), for the users of a TickClock which only need
+// a precision of milliseconds, e.g. a SequenceManager whose delayed tasks may
+// run up to a tick of the kernel late (see
+// SequenceManager::Settings::Builder::SetTickClock()).
+class BASE_EXPORT DefaultCoarseTickClock : public TickClock {
+ public:
+  ~DefaultCoarseTickClock() override;
+
+  TimeTicks NowTicks() const override;
+
+  // Returns a shared instance of DefaultCoarseTickClock. This is thread-safe.
+  static const DefaultCoarseTickClock* GetInstance();
+};
+
 }  // namespace base
 
 #endif  // BASE_TIME_DEFAULT_TICK_CLOCK_H_
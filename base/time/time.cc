@@ -49,6 +49,12 @@ std::atomic<TimeNowFunction> g_time_now_from_system_time_function{
 std::atomic<TimeTicksNowFunction> g_time_ticks_now_function{
     &subtle::TimeTicksNowIgnoringOverride};
 
+std::atomic<TimeTicksNowFunction> g_time_ticks_now_coarse_function{
+    &subtle::TimeTicksNowCoarseIgnoringOverride};
+
+std::atomic<TimeTicksNowFunction> g_time_ticks_now_fast_function{
+    &subtle::TimeTicksNowFastIgnoringOverride};
+
 std::atomic<ThreadTicksNowFunction> g_thread_ticks_now_function{
     &subtle::ThreadTicksNowIgnoringOverride};
 
@@ -339,6 +345,18 @@ TimeTicks TimeTicks::Now() {
   return internal::g_time_ticks_now_function.load(std::memory_order_relaxed)();
 }
 
+// static
+TimeTicks TimeTicks::NowCoarse() {
+  return internal::g_time_ticks_now_coarse_function.load(
+      std::memory_order_relaxed)();
+}
+
+// static
+TimeTicks TimeTicks::NowFast() {
+  return internal::g_time_ticks_now_fast_function.load(
+      std::memory_order_relaxed)();
+}
+
 // static
 TimeTicks TimeTicks::UnixEpoch() {
   static const TimeTicks epoch([]() {
@@ -975,6 +975,24 @@ class BASE_EXPORT TimeTicks : public time_internal::TimeBase<TimeTicks> {
   // microsecond.
   static TimeTicks Now();
 
+  // Like Now(), but with the resolution of the scheduler tick of the kernel,
+  // from 1 to 10 ms, at a fraction of the cost where the platform has such a
+  // clock: CLOCK_MONOTONIC_COARSE on Linux, ChromeOS and Android. Elsewhere,
+  // this is Now(). The values have the origin of Now(), but may be behind by
+  // up to the resolution, so this is only for timing which doesn't need a
+  // better precision, e.g. of tasks against delays in milliseconds.
+  static TimeTicks NowCoarse();
+
+  // Like Now(), but read from the time stamp counter of the CPU where it is
+  // invariant, i.e. runs at a constant rate on all the cores (see
+  // CPU::has_non_stop_time_stamp_counter()), so that it costs neither a
+  // system call nor the vDSO. The counter is calibrated against Now() from
+  // the first call, which returns Now() for the first 100 ms, and every
+  // second after, so that the values may differ from Now() by a few
+  // microseconds. This is Now() on other CPUs, and on platforms other than
+  // Linux, ChromeOS and Android on x86-64.
+  static TimeTicks NowFast();
+
   // Returns true if the high resolution clock is working on this system and
   // Now() will return high resolution values. Note that, on systems where the
   // high resolution clock works but is deemed inefficient, the low resolution
@@ -37,6 +37,14 @@ TimeTicks TimeTicksNowIgnoringOverride() {
   CHECK_NE(0, nanos_since_boot);
   return TimeTicks::FromZxTime(nanos_since_boot);
 }
+
+TimeTicks TimeTicksNowCoarseIgnoringOverride() {
+  return TimeTicksNowIgnoringOverride();
+}
+
+TimeTicks TimeTicksNowFastIgnoringOverride() {
+  return TimeTicksNowIgnoringOverride();
+}
 }  // namespace subtle
 
 // static
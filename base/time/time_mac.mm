@@ -223,6 +223,14 @@ namespace subtle {
 TimeTicks TimeTicksNowIgnoringOverride() {
   return TimeTicks() + Microseconds(ComputeCurrentTicks());
 }
+
+TimeTicks TimeTicksNowCoarseIgnoringOverride() {
+  return TimeTicksNowIgnoringOverride();
+}
+
+TimeTicks TimeTicksNowFastIgnoringOverride() {
+  return TimeTicksNowIgnoringOverride();
+}
 }  // namespace subtle
 
 // static
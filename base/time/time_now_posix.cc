@@ -3,6 +3,7 @@
 // found in the LICENSE file.
 
 #include <stdint.h>
+#include <stdlib.h>
 #include <sys/time.h>
 #include <time.h>
 
@@ -20,6 +21,20 @@
 #include "build/build_config.h"
 #include "third_party/abseil-cpp/absl/types/optional.h"
 
+#if defined(ARCH_CPU_X86_64) && \
+    (BUILDFLAG(IS_LINUX) || BUILDFLAG(IS_CHROMEOS) || BUILDFLAG(IS_ANDROID))
+#define TSC_CLOCK_SUPPORTED
+#endif
+
+#if defined(TSC_CLOCK_SUPPORTED)
+#include <x86intrin.h>
+
+#include <algorithm>
+#include <atomic>
+
+#include "base/cpu.h"
+#endif
+
 // Ensure the Fuchsia and Mac builds do not include this module. Instead,
 // non-POSIX implementation is used for sampling the system clocks.
 #if BUILDFLAG(IS_FUCHSIA) || BUILDFLAG(IS_APPLE)
@@ -68,6 +83,158 @@ absl::optional<int64_t> MaybeClockNow(clockid_t clk_id) {
 #error No usable tick clock function on this platform.
 #endif  // _POSIX_MONOTONIC_CLOCK
 
+#if defined(TSC_CLOCK_SUPPORTED)
+// Converts the TSC into the microseconds of CLOCK_MONOTONIC:
+//
+//   us = base_us + ((tsc - base_tsc) * us_per_tick) >> kShift
+//
+// |us_per_tick| is calibrated against CLOCK_MONOTONIC since the first call,
+// and the base is moved every second, so that the drift from CLOCK_MONOTONIC,
+// which NTP slews, stays within microseconds. The conversion is published
+// through a sequence lock, so that the readers never wait for each other.
+class TscClock {
+ public:
+  constexpr TscClock() = default;
+  TscClock(const TscClock&) = delete;
+  TscClock& operator=(const TscClock&) = delete;
+
+  // Sets |*us| to the time read from the TSC. Returns false if the conversion
+  // isn't calibrated yet, must be rebased, or is being so.
+  bool Read(int64_t* us) const {
+    const uint32_t sequence = sequence_.load(std::memory_order_acquire);
+    const uint64_t base_tsc = base_tsc_.load(std::memory_order_relaxed);
+    const int64_t base_us = base_us_.load(std::memory_order_relaxed);
+    const uint64_t us_per_tick = us_per_tick_.load(std::memory_order_relaxed);
+    const uint64_t max_ticks = max_ticks_.load(std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_acquire);
+    if ((sequence & 1) || sequence_.load(std::memory_order_relaxed) != sequence)
+      return false;
+
+    // This also catches a TSC behind |base_tsc|, on another core.
+    const uint64_t ticks = __rdtsc() - base_tsc;
+    if (ticks > max_ticks)
+      return false;
+    *us = base_us + ToMicroseconds(ticks, us_per_tick);
+    return true;
+  }
+
+  // Calibrates or rebases the conversion, unless another thread does, and
+  // returns the current time.
+  int64_t Rebase() {
+    // Samples the TSC and the clock as close together as possible.
+    const uint64_t tsc_before = __rdtsc();
+    struct timespec ts;
+    CHECK(clock_gettime(CLOCK_MONOTONIC, &ts) == 0);
+    const uint64_t tsc = tsc_before + (__rdtsc() - tsc_before) / 2;
+    const int64_t now_ns =
+        ts.tv_sec * base::Time::kNanosecondsPerSecond + ts.tv_nsec;
+    const int64_t now_us = now_ns / base::Time::kNanosecondsPerMicrosecond;
+
+    if (rebasing_.exchange(true, std::memory_order_acquire)) {
+      // Another thread rebases. Once calibrated, this waits for it rather than
+      // returning the clock, which may be a few microseconds behind the TSC.
+      int64_t us;
+      if (us_per_tick_.load(std::memory_order_relaxed)) {
+        for (int i = 0; i < 1000 && rebasing_.load(std::memory_order_relaxed);
+             ++i) {
+          _mm_pause();
+        }
+        if (Read(&us))
+          return us;
+      }
+      return now_us;
+    }
+
+    int64_t us = now_us;
+    const uint64_t us_per_tick = us_per_tick_.load(std::memory_order_relaxed);
+    if (us_per_tick) {
+      const int64_t tsc_us =
+          base_us_.load(std::memory_order_relaxed) +
+          ToMicroseconds(tsc - base_tsc_.load(std::memory_order_relaxed),
+                         us_per_tick);
+      if (tsc < calibration_tsc_ || std::abs(tsc_us - now_us) > kMaxDriftUs) {
+        // The TSC stopped, was reset or doesn't run at a constant rate, e.g.
+        // over a suspend. The calibration starts over.
+        Publish(0, 0, 0, 0);
+        calibration_tsc_ = 0;
+      } else {
+        // The base only moves forward, so that the time doesn't go backwards.
+        us = std::max(us, tsc_us);
+      }
+    }
+
+    if (!calibration_tsc_) {
+      calibration_tsc_ = tsc;
+      calibration_ns_ = now_ns;
+    } else if (now_ns - calibration_ns_ >= kCalibrationNs) {
+      const unsigned __int128 calibration_ticks = tsc - calibration_tsc_;
+      const unsigned __int128 calibration_ns =
+          static_cast<uint64_t>(now_ns - calibration_ns_);
+      // If the TSC is ahead of the clock, it runs slower until the next
+      // rebase, by which it should be back in step.
+      const unsigned __int128 ahead_ns =
+          static_cast<uint64_t>(us - now_us) *
+          base::Time::kNanosecondsPerMicrosecond;
+      Publish(tsc, us,
+              static_cast<uint64_t>(
+                  (calibration_ns << kShift) * (kRebaseNs - ahead_ns) /
+                  (calibration_ticks *
+                   base::Time::kNanosecondsPerMicrosecond * kRebaseNs)),
+              static_cast<uint64_t>(calibration_ticks * kRebaseNs /
+                                    calibration_ns));
+    }
+
+    rebasing_.store(false, std::memory_order_release);
+    return us;
+  }
+
+ private:
+  static constexpr int kShift = 40;
+  static constexpr int64_t kCalibrationNs =
+      100 * base::Time::kNanosecondsPerMicrosecond *
+      base::Time::kMicrosecondsPerMillisecond;
+  static constexpr int64_t kRebaseNs = base::Time::kNanosecondsPerSecond;
+  // The drift from CLOCK_MONOTONIC beyond which the TSC isn't trusted.
+  static constexpr int64_t kMaxDriftUs =
+      base::Time::kMicrosecondsPerMillisecond;
+
+  static int64_t ToMicroseconds(uint64_t ticks, uint64_t us_per_tick) {
+    return static_cast<int64_t>(
+        (static_cast<unsigned __int128>(ticks) * us_per_tick) >> kShift);
+  }
+
+  void Publish(uint64_t base_tsc,
+               int64_t base_us,
+               uint64_t us_per_tick,
+               uint64_t max_ticks) {
+    const uint32_t sequence = sequence_.load(std::memory_order_relaxed);
+    sequence_.store(sequence + 1, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_release);
+    base_tsc_.store(base_tsc, std::memory_order_relaxed);
+    base_us_.store(base_us, std::memory_order_relaxed);
+    us_per_tick_.store(us_per_tick, std::memory_order_relaxed);
+    max_ticks_.store(max_ticks, std::memory_order_relaxed);
+    sequence_.store(sequence + 2, std::memory_order_release);
+  }
+
+  // Odd while the conversion is being published.
+  std::atomic<uint32_t> sequence_{0};
+  std::atomic<uint64_t> base_tsc_{0};
+  std::atomic<int64_t> base_us_{0};
+  std::atomic<uint64_t> us_per_tick_{0};
+  // The ticks after |base_tsc_| beyond which the conversion is rebased. 0
+  // until calibrated.
+  std::atomic<uint64_t> max_ticks_{0};
+
+  // Held by the thread which rebases, which alone accesses the members below.
+  std::atomic<bool> rebasing_{false};
+  uint64_t calibration_tsc_ = 0;
+  int64_t calibration_ns_ = 0;
+};
+
+TscClock g_tsc_clock;
+#endif  // defined(TSC_CLOCK_SUPPORTED)
+
 }  // namespace
 
 namespace base {
@@ -106,6 +273,27 @@ absl::optional<TimeTicks> MaybeTimeTicksNowIgnoringOverride() {
     return TimeTicks() + Microseconds(now.value());
   return absl::nullopt;
 }
+
+TimeTicks TimeTicksNowCoarseIgnoringOverride() {
+#if BUILDFLAG(IS_LINUX) || BUILDFLAG(IS_CHROMEOS) || BUILDFLAG(IS_ANDROID)
+  return TimeTicks() + Microseconds(ClockNow(CLOCK_MONOTONIC_COARSE));
+#else
+  return TimeTicksNowIgnoringOverride();
+#endif
+}
+
+TimeTicks TimeTicksNowFastIgnoringOverride() {
+#if defined(TSC_CLOCK_SUPPORTED)
+  static const bool is_supported = CPU().has_non_stop_time_stamp_counter();
+  if (is_supported) {
+    int64_t us;
+    if (!g_tsc_clock.Read(&us))
+      us = g_tsc_clock.Rebase();
+    return TimeTicks() + Microseconds(us);
+  }
+#endif
+  return TimeTicksNowIgnoringOverride();
+}
 }  // namespace subtle
 
 // static
@@ -25,6 +25,10 @@ ScopedTimeClockOverrides::ScopedTimeClockOverrides(
   if (time_ticks_override) {
     internal::g_time_ticks_now_function.store(time_ticks_override,
                                               std::memory_order_relaxed);
+    internal::g_time_ticks_now_coarse_function.store(
+        time_ticks_override, std::memory_order_relaxed);
+    internal::g_time_ticks_now_fast_function.store(time_ticks_override,
+                                                   std::memory_order_relaxed);
   }
   if (thread_ticks_override) {
     internal::g_thread_ticks_now_function.store(thread_ticks_override,
@@ -37,6 +41,10 @@ ScopedTimeClockOverrides::~ScopedTimeClockOverrides() {
   internal::g_time_now_from_system_time_function.store(
       &TimeNowFromSystemTimeIgnoringOverride);
   internal::g_time_ticks_now_function.store(&TimeTicksNowIgnoringOverride);
+  internal::g_time_ticks_now_coarse_function.store(
+      &TimeTicksNowCoarseIgnoringOverride);
+  internal::g_time_ticks_now_fast_function.store(
+      &TimeTicksNowFastIgnoringOverride);
   internal::g_thread_ticks_now_function.store(&ThreadTicksNowIgnoringOverride);
   overrides_active_ = false;
 }
@@ -31,7 +31,8 @@ namespace subtle {
 // cases (e.g. virtual time in devtools) where any flakiness caused by a racy
 // time update isn't surprising. Instantiating a ScopedTimeClockOverrides while
 // other threads are running might break their expectation that TimeTicks and
-// ThreadTicks increase monotonically. Nested overrides are not allowed.
+// ThreadTicks increase monotonically. Nested overrides are not allowed. The
+// TimeTicks override also overrides TimeTicks::NowCoarse and NowFast.
 class BASE_EXPORT ScopedTimeClockOverrides {
  public:
   // Pass |nullptr| for any override if it shouldn't be overriden.
@@ -59,6 +60,8 @@ class BASE_EXPORT ScopedTimeClockOverrides {
 BASE_EXPORT Time TimeNowIgnoringOverride();
 BASE_EXPORT Time TimeNowFromSystemTimeIgnoringOverride();
 BASE_EXPORT TimeTicks TimeTicksNowIgnoringOverride();
+BASE_EXPORT TimeTicks TimeTicksNowCoarseIgnoringOverride();
+BASE_EXPORT TimeTicks TimeTicksNowFastIgnoringOverride();
 BASE_EXPORT ThreadTicks ThreadTicksNowIgnoringOverride();
 
 #if BUILDFLAG(IS_POSIX)
@@ -81,6 +84,8 @@ namespace internal {
 extern std::atomic<TimeNowFunction> g_time_now_function;
 extern std::atomic<TimeNowFunction> g_time_now_from_system_time_function;
 extern std::atomic<TimeTicksNowFunction> g_time_ticks_now_function;
+extern std::atomic<TimeTicksNowFunction> g_time_ticks_now_coarse_function;
+extern std::atomic<TimeTicksNowFunction> g_time_ticks_now_fast_function;
 extern std::atomic<ThreadTicksNowFunction> g_thread_ticks_now_function;
 
 }  // namespace internal
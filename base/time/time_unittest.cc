@@ -1346,6 +1346,51 @@ TEST(TimeTicks, NowOverride) {
   EXPECT_GT(TimeTicks::Max(), subtle::TimeTicksNowIgnoringOverride());
 }
 
+TEST(TimeTicks, NowCoarse) {
+  // The coarse clock is at most a kernel tick behind, and never ahead.
+  for (int i = 0; i < 100; ++i) {
+    const TimeTicks before = TimeTicks::Now();
+    const TimeTicks coarse = TimeTicks::NowCoarse();
+    const TimeTicks after = TimeTicks::Now();
+    EXPECT_LE(coarse, after);
+    EXPECT_GE(coarse, before - Milliseconds(20));
+  }
+}
+
+TEST(TimeTicks, NowFast) {
+  // The first calls return Now() while the TSC is calibrated, and the later
+  // ones may differ from it by a few microseconds.
+  const TimeTicks start = TimeTicks::Now();
+  TimeTicks last = TimeTicks::NowFast();
+  while (TimeTicks::Now() - start < Milliseconds(300)) {
+    const TimeTicks before = TimeTicks::Now();
+    const TimeTicks fast = TimeTicks::NowFast();
+    const TimeTicks after = TimeTicks::Now();
+    EXPECT_GE(fast, last);
+    EXPECT_GE(fast, before - Milliseconds(1));
+    EXPECT_LE(fast, after + Milliseconds(1));
+    last = fast;
+  }
+}
+
+TEST(TimeTicks, NowCoarseAndNowFastOverride) {
+  TimeTicksOverride::now_ticks_ = TimeTicks::Min();
+
+  {
+    subtle::ScopedTimeClockOverrides overrides(nullptr, &TimeTicksOverride::Now,
+                                               nullptr);
+    EXPECT_EQ(TimeTicks::Min() + Seconds(1), TimeTicks::NowCoarse());
+    EXPECT_EQ(TimeTicks::Min() + Seconds(2), TimeTicks::NowFast());
+    EXPECT_LT(TimeTicks::UnixEpoch(),
+              subtle::TimeTicksNowCoarseIgnoringOverride());
+    EXPECT_LT(TimeTicks::UnixEpoch(),
+              subtle::TimeTicksNowFastIgnoringOverride());
+  }
+
+  EXPECT_LT(TimeTicks::UnixEpoch(), TimeTicks::NowCoarse());
+  EXPECT_LT(TimeTicks::UnixEpoch(), TimeTicks::NowFast());
+}
+
 class ThreadTicksOverride {
  public:
   static ThreadTicks Now() {
@@ -605,6 +605,14 @@ TimeTicks TimeTicksNowIgnoringOverride() {
   return g_time_ticks_now_ignoring_override_function.load(
       std::memory_order_relaxed)();
 }
+
+TimeTicks TimeTicksNowCoarseIgnoringOverride() {
+  return TimeTicksNowIgnoringOverride();
+}
+
+TimeTicks TimeTicksNowFastIgnoringOverride() {
+  return TimeTicksNowIgnoringOverride();
+}
 }  // namespace subtle
 
 // static
@@ -0,0 +1,342 @@
+// Copyright 2022 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "base/timer/timer_wheel.h"
+
+#include <algorithm>
+#include <limits>
+#include <utility>
+
+#include "base/bits.h"
+#include "base/check_op.h"
+#include "base/threading/sequenced_task_runner_handle.h"
+#include "base/time/tick_clock.h"
+
+namespace base {
+
+namespace {
+
+constexpr uint64_t kSlotMask = TimerWheel::kSlotsPerLevel - 1;
+constexpr int64_t kNoEventTick = std::numeric_limits<int64_t>::max();
+
+int LevelShift(int level) {
+  return level * TimerWheel::kSlotsPerLevelLog2;
+}
+
+uint64_t RotateRight(uint64_t value, int shift) {
+  DCHECK_GE(shift, 0);
+  DCHECK_LT(shift, 64);
+  return (value >> shift) | (value << ((64 - shift) & 63));
+}
+
+}  // namespace
+
+TimerWheel::TimerWheel(TimeDelta resolution, const TickClock* tick_clock)
+    : resolution_(resolution),
+      tick_clock_(tick_clock),
+      task_runner_(SequencedTaskRunnerHandle::Get()),
+      current_tick_(TimeToTick(Now())),
+      wake_up_tick_(kNoEventTick) {
+  DCHECK(resolution_.is_positive());
+}
+
+TimerWheel::~TimerWheel() {
+  DCHECK_CALLED_ON_VALID_SEQUENCE(sequence_checker_);
+  DCHECK_EQ(size_, 0u) << "The timers must be destroyed before their wheel.";
+}
+
+size_t TimerWheel::size() const {
+  DCHECK_CALLED_ON_VALID_SEQUENCE(sequence_checker_);
+  return size_;
+}
+
+TimeTicks TimerWheel::Now() const {
+  return tick_clock_ ? tick_clock_->NowTicks() : TimeTicks::Now();
+}
+
+void TimerWheel::Update(internal::WheelTimerBase* timer) {
+  DCHECK_CALLED_ON_VALID_SEQUENCE(sequence_checker_);
+
+  const int64_t expiry_tick = ExpiryTick(timer->desired_run_time_);
+  if (timer->level_ != kNotInWheel) {
+    if (expiry_tick >= timer->due_tick_) {
+      timer->expiry_tick_ = expiry_tick;
+      return;
+    }
+    Remove(timer);
+  }
+
+  timer->expiry_tick_ = expiry_tick;
+  ++size_;
+  Place(timer);
+  ScheduleWakeUp(timer->due_tick_);
+}
+
+void TimerWheel::Remove(internal::WheelTimerBase* timer) {
+  DCHECK_CALLED_ON_VALID_SEQUENCE(sequence_checker_);
+  DCHECK_NE(timer->level_, kNotInWheel);
+
+  timer->RemoveFromList();
+  if (timer->level_ != kRipeLevel &&
+      slots_[timer->level_][timer->slot_].empty()) {
+    occupied_slots_[timer->level_] &= ~(uint64_t{1} << timer->slot_);
+  }
+  timer->level_ = kNotInWheel;
+  --size_;
+  // The posted wake-up stays. If it finds nothing to run, it only schedules
+  // the next one.
+}
+
+int64_t TimerWheel::ExpiryTick(TimeTicks time) const {
+  const int64_t tick = TimeToTick(time);
+  return TickToTime(tick) < time ? tick + 1 : tick;
+}
+
+void TimerWheel::Place(internal::WheelTimerBase* timer) {
+  const int64_t delta = timer->expiry_tick_ - current_tick_;
+  if (delta <= 0) {
+    timer->level_ = kRipeLevel;
+    timer->due_tick_ = current_tick_;
+    ripe_timers_.Append(timer);
+    return;
+  }
+
+  int level = 0;
+  while (level < kNumLevels - 1 &&
+         delta >= (int64_t{1} << LevelShift(level + 1))) {
+    ++level;
+  }
+  // Timers beyond the range of the coarsest level are parked in its farthest
+  // slot and placed again when that slot is processed.
+  const int64_t max_delta = (int64_t{1} << LevelShift(kNumLevels)) - 1;
+  const int64_t slot_index =
+      (current_tick_ + std::min(delta, max_delta)) >> LevelShift(level);
+
+  timer->level_ = level;
+  timer->slot_ = static_cast<size_t>(slot_index) & kSlotMask;
+  timer->due_tick_ = slot_index << LevelShift(level);
+  slots_[level][timer->slot_].Append(timer);
+  occupied_slots_[level] |= uint64_t{1} << timer->slot_;
+}
+
+int64_t TimerWheel::NextEventTick() const {
+  int64_t next_tick = kNoEventTick;
+  for (int level = 0; level < kNumLevels; ++level) {
+    if (!occupied_slots_[level])
+      continue;
+    // Slots of |level| are due at multiples of 2^LevelShift(level), in order.
+    // Find the first occupied slot after the current one.
+    const int64_t current_index = current_tick_ >> LevelShift(level);
+    const int first_slot = static_cast<int>((current_index + 1) & kSlotMask);
+    const int64_t offset = static_cast<int64_t>(bits::CountTrailingZeroBits(
+        RotateRight(occupied_slots_[level], first_slot)));
+    next_tick = std::min(next_tick, (current_index + 1 + offset)
+                                        << LevelShift(level));
+  }
+  return next_tick;
+}
+
+void TimerWheel::ProcessCurrentTick() {
+  for (int level = 0; level < kNumLevels; ++level) {
+    // Coarser levels are only due at multiples of their slot duration.
+    if (level > 0 &&
+        (current_tick_ & ((int64_t{1} << LevelShift(level)) - 1)) != 0) {
+      break;
+    }
+    const size_t slot =
+        static_cast<size_t>(current_tick_ >> LevelShift(level)) & kSlotMask;
+    LinkedList<internal::WheelTimerBase>& list = slots_[level][slot];
+    if (list.empty())
+      continue;
+    occupied_slots_[level] &= ~(uint64_t{1} << slot);
+
+    // Timers are moved to a finer level or to |ripe_timers_|, or to a later
+    // slot if their expiry was moved back, never back to |list|.
+    while (!list.empty()) {
+      internal::WheelTimerBase* timer = list.head()->value();
+      timer->RemoveFromList();
+      Place(timer);
+    }
+  }
+}
+
+void TimerWheel::ScheduleWakeUp(int64_t tick) {
+  if (tick >= wake_up_tick_)
+    return;
+  wake_up_tick_ = tick;
+  task_runner_->PostDelayedTask(
+      FROM_HERE,
+      BindOnce(&TimerWheel::OnWakeUp, weak_ptr_factory_.GetWeakPtr(), tick),
+      std::max(TickToTime(tick) - Now(), TimeDelta()));
+}
+
+void TimerWheel::OnWakeUp(int64_t tick) {
+  DCHECK_CALLED_ON_VALID_SEQUENCE(sequence_checker_);
+  if (tick != wake_up_tick_)
+    return;
+  wake_up_tick_ = kNoEventTick;
+
+  const int64_t target_tick = TimeToTick(Now());
+  while (current_tick_ < target_tick) {
+    const int64_t next_tick = NextEventTick();
+    if (next_tick > target_tick) {
+      current_tick_ = target_tick;
+      break;
+    }
+    current_tick_ = next_tick;
+    ProcessCurrentTick();
+  }
+
+  // The timers are run one at a time from |ripe_timers_|, so that a timer may
+  // stop or restart the others, or be destroyed, from its task. Timers which
+  // expire again right away, e.g. repeating timers without a delay, wait for
+  // the next wake-up.
+  LinkedList<internal::WheelTimerBase> ripe_timers;
+  while (!ripe_timers_.empty()) {
+    internal::WheelTimerBase* timer = ripe_timers_.head()->value();
+    timer->RemoveFromList();
+    ripe_timers.Append(timer);
+  }
+  WeakPtr<TimerWheel> self = weak_ptr_factory_.GetWeakPtr();
+  while (!ripe_timers.empty()) {
+    internal::WheelTimerBase* timer = ripe_timers.head()->value();
+    timer->RemoveFromList();
+    if (timer->expiry_tick_ > current_tick_) {
+      // The timer was reset since it expired.
+      Place(timer);
+      continue;
+    }
+    timer->level_ = kNotInWheel;
+    --size_;
+    timer->RunUserTask();
+    // The user task may have destroyed the wheel, with its timers.
+    if (!self)
+      return;
+  }
+
+  const int64_t next_tick =
+      ripe_timers_.empty() ? NextEventTick() : current_tick_;
+  if (next_tick != kNoEventTick)
+    ScheduleWakeUp(next_tick);
+}
+
+int64_t TimerWheel::TimeToTick(TimeTicks time) const {
+  return (time - TimeTicks()).IntDiv(resolution_);
+}
+
+TimeTicks TimerWheel::TickToTime(int64_t tick) const {
+  return TimeTicks() + resolution_ * tick;
+}
+
+namespace internal {
+
+WheelTimerBase::WheelTimerBase(TimerWheel* wheel) : wheel_(wheel) {
+  DCHECK(wheel_);
+}
+
+WheelTimerBase::~WheelTimerBase() {
+  if (IsRunning())
+    wheel_->Remove(this);
+}
+
+bool WheelTimerBase::IsRunning() const {
+  return level_ != TimerWheel::kNotInWheel;
+}
+
+TimeDelta WheelTimerBase::GetCurrentDelay() const {
+  return delay_;
+}
+
+void WheelTimerBase::Reset() {
+  EnsureNonNullUserTask();
+
+  desired_run_time_ = wheel_->Now() + delay_;
+  wheel_->Update(this);
+}
+
+void WheelTimerBase::Stop() {
+  if (IsRunning())
+    wheel_->Remove(this);
+  OnStop();
+  // No more member accesses here: |this| could be deleted after Stop() call.
+}
+
+TimeTicks WheelTimerBase::desired_run_time() const {
+  return desired_run_time_;
+}
+
+void WheelTimerBase::StartInternal(const Location& posted_from,
+                                   TimeDelta delay) {
+  posted_from_ = posted_from;
+  delay_ = delay;
+  Reset();
+}
+
+}  // namespace internal
+
+//-----------------------------------------------------------------------------
+WheelOneShotTimer::WheelOneShotTimer(TimerWheel* wheel)
+    : internal::WheelTimerBase(wheel) {}
+
+WheelOneShotTimer::~WheelOneShotTimer() {
+  Stop();
+}
+
+void WheelOneShotTimer::Start(const Location& posted_from,
+                              TimeDelta delay,
+                              OnceClosure user_task) {
+  user_task_ = std::move(user_task);
+  StartInternal(posted_from, delay);
+}
+
+void WheelOneShotTimer::OnStop() {
+  if (!user_task_.is_null()) {
+    // Resetting the user task may destroy the timer, like Stop() may.
+    OnceClosure user_task = std::move(user_task_);
+  }
+}
+
+void WheelOneShotTimer::RunUserTask() {
+  // Moves the user task out, since it may destroy the timer.
+  OnceClosure task = std::move(user_task_);
+  DCHECK(task);
+  std::move(task).Run();
+  // No more member accesses here: |this| could be deleted at this point.
+}
+
+void WheelOneShotTimer::EnsureNonNullUserTask() {
+  DCHECK(user_task_);
+}
+
+//-----------------------------------------------------------------------------
+WheelRepeatingTimer::WheelRepeatingTimer(TimerWheel* wheel)
+    : internal::WheelTimerBase(wheel) {}
+
+WheelRepeatingTimer::~WheelRepeatingTimer() {
+  Stop();
+}
+
+void WheelRepeatingTimer::Start(const Location& posted_from,
+                                TimeDelta delay,
+                                RepeatingClosure user_task) {
+  user_task_ = std::move(user_task);
+  StartInternal(posted_from, delay);
+}
+
+void WheelRepeatingTimer::OnStop() {}
+
+void WheelRepeatingTimer::RunUserTask() {
+  // Make a local copy of the task to run in case the task destroy the timer
+  // instance.
+  RepeatingClosure task = user_task_;
+  Reset();
+  task.Run();
+  // No more member accesses here: |this| could be deleted at this point.
+}
+
+void WheelRepeatingTimer::EnsureNonNullUserTask() {
+  DCHECK(user_task_);
+}
+
+}  // namespace base
@@ -0,0 +1,298 @@
+// Copyright 2022 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+// A TimerWheel runs many timers of a sequence from a hierarchical timing
+// wheel, for the timers which are reset much more often than they fire, e.g.
+// the idle timeouts of connections, reset on every packet:
+// - WheelOneShotTimer: Once after a `TimeDelta` delay has elapsed.
+// - WheelRepeatingTimer: Repeatedly, with a specified `TimeDelta` delay before
+//    the first invocation and between invocations.
+//
+// Unlike OneShotTimer and RepeatingTimer, whose Start(), Reset() and Stop()
+// post or abandon a delayed task each, these only move between the slots of
+// their wheel, in O(1), without posting anything. The wheel posts a single
+// delayed task, for the next of its ticks at which a timer may expire, and
+// runs the expired timers from it. The timers run up to one tick, i.e. the
+// resolution of the wheel, after their delay, never before.
+//
+// Sample usage:
+//
+//   class Server {
+//    private:
+//     base::TimerWheel timer_wheel_{base::Milliseconds(100)};
+//     std::vector<std::unique_ptr<Connection>> connections_;
+//   };
+//
+//   class Connection {
+//    public:
+//     explicit Connection(base::TimerWheel* timer_wheel)
+//         : idle_timer_(timer_wheel) {
+//       idle_timer_.Start(FROM_HERE, base::Seconds(30), this,
+//                         &Connection::OnIdle);
+//     }
+//     void OnPacket() {
+//       idle_timer_.Reset();
+//       ...
+//     }
+//    private:
+//     void OnIdle();
+//     base::WheelOneShotTimer idle_timer_;
+//   };
+//
+// A wheel and its timers are bound to the sequence the wheel was created on,
+// and the wheel must outlive its timers.
+
+#ifndef BASE_TIMER_TIMER_WHEEL_H_
+#define BASE_TIMER_TIMER_WHEEL_H_
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include <array>
+
+#include "base/base_export.h"
+#include "base/bind.h"
+#include "base/callback.h"
+#include "base/containers/linked_list.h"
+#include "base/location.h"
+#include "base/memory/raw_ptr.h"
+#include "base/memory/scoped_refptr.h"
+#include "base/memory/weak_ptr.h"
+#include "base/sequence_checker.h"
+#include "base/task/sequenced_task_runner.h"
+#include "base/time/time.h"
+
+namespace base {
+
+class TickClock;
+
+namespace internal {
+class WheelTimerBase;
+}  // namespace internal
+
+// The wheel is the one of DelayedTaskWheel: the timers are bucketed by the
+// tick in which they expire, in one of kNumLevels levels of kSlotsPerLevel
+// slots, each level covering kSlotsPerLevel times the range of the previous
+// one. Unlike DelayedTaskWheel, it doesn't own its entries, which are the
+// timers themselves, so that restarting a timer allocates nothing, and its
+// tick is configurable.
+class BASE_EXPORT TimerWheel {
+ public:
+  static constexpr TimeDelta kDefaultResolution = Milliseconds(4);
+  static constexpr int kNumLevels = 4;
+  static constexpr int kSlotsPerLevelLog2 = 6;
+  static constexpr size_t kSlotsPerLevel = size_t{1} << kSlotsPerLevelLog2;
+
+  // Runs the timers on the current sequence, up to |resolution| late. If
+  // |tick_clock| is provided, it is used instead of TimeTicks::Now(), e.g.
+  // DefaultCoarseTickClock if the resolution is no finer than its own.
+  explicit TimerWheel(TimeDelta resolution = kDefaultResolution,
+                      const TickClock* tick_clock = nullptr);
+  TimerWheel(const TimerWheel&) = delete;
+  TimerWheel& operator=(const TimerWheel&) = delete;
+  ~TimerWheel();
+
+  TimeDelta resolution() const { return resolution_; }
+
+  // Returns the number of running timers.
+  size_t size() const;
+
+ private:
+  friend class internal::WheelTimerBase;
+
+  static constexpr int kRipeLevel = kNumLevels;
+  static constexpr int kNotInWheel = -1;
+
+  TimeTicks Now() const;
+
+  // Adds |timer| to the wheel, or moves it, to run at its desired run time.
+  // A running timer whose expiry is moved back stays in its slot, and is only
+  // placed again when the slot is due, so that resetting a timer much more
+  // often than it expires only writes the timer.
+  void Update(internal::WheelTimerBase* timer);
+  void Remove(internal::WheelTimerBase* timer);
+
+  // Returns the first tick at or after |time|.
+  int64_t ExpiryTick(TimeTicks time) const;
+
+  // Places |timer| in the slot matching its expiry tick relative to
+  // |current_tick_|, or in |ripe_timers_| if it has expired, and sets its due
+  // tick to the tick at which the slot is due.
+  void Place(internal::WheelTimerBase* timer);
+
+  // Returns the next tick after |current_tick_| at which a non-empty slot is
+  // due, or a very large value if all slots are empty.
+  int64_t NextEventTick() const;
+
+  // Processes the slots that are due at |current_tick_|.
+  void ProcessCurrentTick();
+
+  // Posts the wake-up task for |tick| unless one is posted for it or before.
+  void ScheduleWakeUp(int64_t tick);
+
+  // Advances the wheel to now, runs the expired timers, and schedules the next
+  // wake-up. Does nothing if |tick| isn't the tick of the next wake-up, i.e. if
+  // an earlier one was posted since.
+  void OnWakeUp(int64_t tick);
+
+  int64_t TimeToTick(TimeTicks time) const;
+  TimeTicks TickToTime(int64_t tick) const;
+
+  const TimeDelta resolution_;
+  const raw_ptr<const TickClock> tick_clock_;
+  const scoped_refptr<SequencedTaskRunner> task_runner_;
+
+  // The last tick that was processed.
+  int64_t current_tick_;
+
+  std::array<std::array<LinkedList<internal::WheelTimerBase>, kSlotsPerLevel>,
+             kNumLevels>
+      slots_;
+  // Bit |i| of |occupied_slots_[level]| is set iff slots_[level][i] is not
+  // empty.
+  std::array<uint64_t, kNumLevels> occupied_slots_{};
+  LinkedList<internal::WheelTimerBase> ripe_timers_;
+  size_t size_ = 0;
+
+  // The tick of the posted wake-up task, or a very large value if none is.
+  int64_t wake_up_tick_;
+
+  SEQUENCE_CHECKER(sequence_checker_);
+
+  WeakPtrFactory<TimerWheel> weak_ptr_factory_{this};
+};
+
+namespace internal {
+
+// This class wraps logic shared by WheelOneShotTimer and WheelRepeatingTimer.
+class BASE_EXPORT WheelTimerBase : public LinkNode<WheelTimerBase> {
+ public:
+  WheelTimerBase(const WheelTimerBase&) = delete;
+  WheelTimerBase& operator=(const WheelTimerBase&) = delete;
+
+  // Stops the timer.
+  virtual ~WheelTimerBase();
+
+  // Returns true if the timer is running (i.e., not stopped).
+  bool IsRunning() const;
+
+  // Returns the current delay for this timer.
+  TimeDelta GetCurrentDelay() const;
+
+  // Restarts the timer with its current delay. The user task must be set.
+  void Reset();
+
+  // Stops the timer. It is a no-op if the timer is not running.
+  void Stop();
+
+  TimeTicks desired_run_time() const;
+
+ protected:
+  explicit WheelTimerBase(TimerWheel* wheel);
+
+  void StartInternal(const Location& posted_from, TimeDelta delay);
+
+ private:
+  friend class base::TimerWheel;
+
+  // Called by the wheel once the timer expired, and was removed from it.
+  virtual void RunUserTask() = 0;
+  virtual void OnStop() = 0;
+
+  // DCHECKs that the user task is not null.
+  virtual void EnsureNonNullUserTask() = 0;
+
+  const raw_ptr<TimerWheel> wheel_;
+
+  // Location in user code.
+  Location posted_from_;
+
+  // Delay requested by user.
+  TimeDelta delay_;
+  TimeTicks desired_run_time_;
+
+  // Position of the timer in the wheel, see TimerWheel. |due_tick_| is the
+  // tick at which the slot of the timer is processed, which may be before
+  // |expiry_tick_|.
+  int64_t expiry_tick_ = 0;
+  int64_t due_tick_ = 0;
+  int level_ = TimerWheel::kNotInWheel;
+  size_t slot_ = 0;
+};
+
+}  // namespace internal
+
+//-----------------------------------------------------------------------------
+// A one-shot timer on a TimerWheel. See usage notes at the top of the file.
+class BASE_EXPORT WheelOneShotTimer : public internal::WheelTimerBase {
+ public:
+  explicit WheelOneShotTimer(TimerWheel* wheel);
+  WheelOneShotTimer(const WheelOneShotTimer&) = delete;
+  WheelOneShotTimer& operator=(const WheelOneShotTimer&) = delete;
+  ~WheelOneShotTimer() override;
+
+  // Start the timer to run at the given |delay| from now. If the timer is
+  // already running, it will be replaced to call the given |user_task|.
+  void Start(const Location& posted_from,
+             TimeDelta delay,
+             OnceClosure user_task);
+
+  // Start the timer to run at the given |delay| from now. If the timer is
+  // already running, it will be replaced to call a task formed from
+  // |receiver->*method|.
+  template <class Receiver>
+  void Start(const Location& posted_from,
+             TimeDelta delay,
+             Receiver* receiver,
+             void (Receiver::*method)()) {
+    Start(posted_from, delay, BindOnce(method, Unretained(receiver)));
+  }
+
+ private:
+  void OnStop() final;
+  void RunUserTask() final;
+  void EnsureNonNullUserTask() final;
+
+  OnceClosure user_task_;
+};
+
+//-----------------------------------------------------------------------------
+// A repeating timer on a TimerWheel. See usage notes at the top of the file.
+class BASE_EXPORT WheelRepeatingTimer : public internal::WheelTimerBase {
+ public:
+  explicit WheelRepeatingTimer(TimerWheel* wheel);
+  WheelRepeatingTimer(const WheelRepeatingTimer&) = delete;
+  WheelRepeatingTimer& operator=(const WheelRepeatingTimer&) = delete;
+  ~WheelRepeatingTimer() override;
+
+  // Start the timer to run at the given |delay| from now. If the timer is
+  // already running, it will be replaced to call the given |user_task|.
+  void Start(const Location& posted_from,
+             TimeDelta delay,
+             RepeatingClosure user_task);
+
+  // Start the timer to run at the given |delay| from now. If the timer is
+  // already running, it will be replaced to call a task formed from
+  // |receiver->*method|.
+  template <class Receiver>
+  void Start(const Location& posted_from,
+             TimeDelta delay,
+             Receiver* receiver,
+             void (Receiver::*method)()) {
+    Start(posted_from, delay, BindRepeating(method, Unretained(receiver)));
+  }
+
+  const RepeatingClosure& user_task() const { return user_task_; }
+
+ private:
+  void OnStop() final;
+  void RunUserTask() final;
+  void EnsureNonNullUserTask() final;
+
+  RepeatingClosure user_task_;
+};
+
+}  // namespace base
+
+#endif  // BASE_TIMER_TIMER_WHEEL_H_
@@ -0,0 +1,247 @@
+// Copyright 2022 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "base/timer/timer_wheel.h"
+
+#include <memory>
+#include <vector>
+
+#include "base/bind.h"
+#include "base/callback_helpers.h"
+#include "base/rand_util.h"
+#include "base/test/bind.h"
+#include "base/test/task_environment.h"
+#include "base/time/time.h"
+#include "testing/gtest/include/gtest/gtest.h"
+
+namespace base {
+
+namespace {
+
+constexpr TimeDelta kResolution = Milliseconds(10);
+
+class TimerWheelTest : public testing::Test {
+ protected:
+  test::TaskEnvironment task_environment_{
+      test::TaskEnvironment::TimeSource::MOCK_TIME};
+  TimerWheel wheel_{kResolution};
+};
+
+}  // namespace
+
+TEST_F(TimerWheelTest, OneShotTimer) {
+  int count = 0;
+  WheelOneShotTimer timer(&wheel_);
+  timer.Start(FROM_HERE, Seconds(1), BindLambdaForTesting([&]() { ++count; }));
+  EXPECT_TRUE(timer.IsRunning());
+  EXPECT_EQ(wheel_.size(), 1u);
+
+  // Never runs before its delay, and at most one tick after.
+  task_environment_.FastForwardBy(Seconds(1) - Microseconds(1));
+  EXPECT_EQ(count, 0);
+  task_environment_.FastForwardBy(kResolution + Microseconds(1));
+  EXPECT_EQ(count, 1);
+  EXPECT_FALSE(timer.IsRunning());
+  EXPECT_EQ(wheel_.size(), 0u);
+
+  task_environment_.FastForwardBy(Seconds(10));
+  EXPECT_EQ(count, 1);
+}
+
+TEST_F(TimerWheelTest, OneShotTimerStop) {
+  int count = 0;
+  WheelOneShotTimer timer(&wheel_);
+  timer.Start(FROM_HERE, Seconds(1), BindLambdaForTesting([&]() { ++count; }));
+  task_environment_.FastForwardBy(Milliseconds(500));
+  timer.Stop();
+  EXPECT_FALSE(timer.IsRunning());
+  EXPECT_EQ(wheel_.size(), 0u);
+
+  task_environment_.FastForwardBy(Seconds(10));
+  EXPECT_EQ(count, 0);
+}
+
+TEST_F(TimerWheelTest, ResetPostsNoTask) {
+  constexpr int kNumTimers = 100;
+  int count = 0;
+  std::vector<std::unique_ptr<WheelOneShotTimer>> timers;
+  for (int i = 0; i < kNumTimers; ++i) {
+    timers.push_back(std::make_unique<WheelOneShotTimer>(&wheel_));
+    timers.back()->Start(FROM_HERE, Seconds(1),
+                         BindLambdaForTesting([&]() { ++count; }));
+  }
+  EXPECT_EQ(task_environment_.GetPendingMainThreadTaskCount(), 1u);
+
+  // The timers keep being reset before they expire, and the wheel keeps a
+  // single wake-up.
+  for (int i = 0; i < 50; ++i) {
+    task_environment_.FastForwardBy(Milliseconds(100));
+    for (auto& timer : timers)
+      timer->Reset();
+    EXPECT_EQ(task_environment_.GetPendingMainThreadTaskCount(), 1u);
+  }
+  EXPECT_EQ(count, 0);
+
+  task_environment_.FastForwardBy(Seconds(1) + kResolution);
+  EXPECT_EQ(count, kNumTimers);
+  EXPECT_EQ(task_environment_.GetPendingMainThreadTaskCount(), 0u);
+}
+
+TEST_F(TimerWheelTest, RestartWithShorterDelay) {
+  int count = 0;
+  WheelOneShotTimer timer(&wheel_);
+  timer.Start(FROM_HERE, Minutes(10), BindLambdaForTesting([&]() { ++count; }));
+  task_environment_.FastForwardBy(Seconds(1));
+  timer.Start(FROM_HERE, Seconds(1), BindLambdaForTesting([&]() { ++count; }));
+  task_environment_.FastForwardBy(Seconds(1) + kResolution);
+  EXPECT_EQ(count, 1);
+  EXPECT_FALSE(timer.IsRunning());
+}
+
+TEST_F(TimerWheelTest, RepeatingTimer) {
+  int count = 0;
+  WheelRepeatingTimer timer(&wheel_);
+  timer.Start(FROM_HERE, Milliseconds(100),
+              BindLambdaForTesting([&]() { ++count; }));
+  task_environment_.FastForwardBy(Seconds(1) + kResolution);
+  EXPECT_EQ(count, 10);
+  EXPECT_TRUE(timer.IsRunning());
+
+  timer.Stop();
+  task_environment_.FastForwardBy(Seconds(1));
+  EXPECT_EQ(count, 10);
+}
+
+TEST_F(TimerWheelTest, RepeatingTimerZeroDelay) {
+  int count = 0;
+  WheelRepeatingTimer timer(&wheel_);
+  timer.Start(FROM_HERE, TimeDelta(), BindLambdaForTesting([&]() {
+                if (++count == 10)
+                  timer.Stop();
+              }));
+  task_environment_.RunUntilIdle();
+  EXPECT_EQ(count, 10);
+}
+
+// Checks the delays across all the levels of the wheel, and beyond them.
+TEST_F(TimerWheelTest, Delays) {
+  const TimeDelta kDelays[] = {
+      TimeDelta(),      Microseconds(1), kResolution,  kResolution * 63,
+      kResolution * 64, Seconds(3),      Minutes(2),   Minutes(45),
+      Hours(3),         Hours(50),       Days(30),
+  };
+  std::vector<std::unique_ptr<WheelOneShotTimer>> timers;
+  std::vector<TimeTicks> run_times(std::size(kDelays));
+  const TimeTicks start = TimeTicks::Now();
+  for (size_t i = 0; i < std::size(kDelays); ++i) {
+    timers.push_back(std::make_unique<WheelOneShotTimer>(&wheel_));
+    timers.back()->Start(FROM_HERE, kDelays[i],
+                         BindLambdaForTesting([&run_times, i]() {
+                           run_times[i] = TimeTicks::Now();
+                         }));
+  }
+
+  task_environment_.FastForwardBy(Days(31));
+  for (size_t i = 0; i < std::size(kDelays); ++i) {
+    EXPECT_GE(run_times[i] - start, kDelays[i]) << i;
+    EXPECT_LE(run_times[i] - start, kDelays[i] + kResolution) << i;
+  }
+}
+
+TEST_F(TimerWheelTest, RandomDelays) {
+  constexpr int kNumTimers = 1000;
+  std::vector<std::unique_ptr<WheelOneShotTimer>> timers;
+  int late_count = 0;
+  for (int i = 0; i < kNumTimers; ++i) {
+    timers.push_back(std::make_unique<WheelOneShotTimer>(&wheel_));
+    WheelOneShotTimer* timer = timers.back().get();
+    timer->Start(FROM_HERE, Milliseconds(RandInt(0, 100000)),
+                 BindLambdaForTesting([&, timer]() {
+                   const TimeTicks now = TimeTicks::Now();
+                   if (now < timer->desired_run_time() ||
+                       now > timer->desired_run_time() + kResolution) {
+                     ++late_count;
+                   }
+                 }));
+    // Restarts some of the timers, at various times.
+    if (i % 3 == 0)
+      task_environment_.FastForwardBy(Milliseconds(RandInt(0, 50)));
+    WheelOneShotTimer* other_timer = timers[RandInt(0, i)].get();
+    if (i % 5 == 0 && other_timer->IsRunning())
+      other_timer->Reset();
+  }
+
+  task_environment_.FastForwardBy(Seconds(200));
+  EXPECT_EQ(late_count, 0);
+  EXPECT_EQ(wheel_.size(), 0u);
+}
+
+// A timer may stop or delete the timers which expire with it.
+TEST_F(TimerWheelTest, StopOtherTimers) {
+  int count = 0;
+  auto timer1 = std::make_unique<WheelOneShotTimer>(&wheel_);
+  auto timer2 = std::make_unique<WheelOneShotTimer>(&wheel_);
+  auto timer3 = std::make_unique<WheelOneShotTimer>(&wheel_);
+  timer1->Start(FROM_HERE, Seconds(1), BindLambdaForTesting([&]() {
+                  ++count;
+                  timer2.reset();
+                  timer3->Stop();
+                }));
+  timer2->Start(FROM_HERE, Seconds(1),
+                BindLambdaForTesting([&]() { ++count; }));
+  timer3->Start(FROM_HERE, Seconds(1),
+                BindLambdaForTesting([&]() { ++count; }));
+
+  task_environment_.FastForwardBy(Seconds(2));
+  EXPECT_EQ(count, 1);
+  EXPECT_EQ(wheel_.size(), 0u);
+}
+
+// A timer reset by a timer which expires with it runs after its new delay.
+TEST_F(TimerWheelTest, ResetOtherTimer) {
+  int count = 0;
+  TimeTicks run_time;
+  WheelOneShotTimer timer1(&wheel_);
+  WheelOneShotTimer timer2(&wheel_);
+  timer1.Start(FROM_HERE, Seconds(1),
+               BindLambdaForTesting([&]() { timer2.Reset(); }));
+  timer2.Start(FROM_HERE, Seconds(1), BindLambdaForTesting([&]() {
+                 ++count;
+                 run_time = TimeTicks::Now();
+               }));
+  const TimeTicks start = TimeTicks::Now();
+
+  task_environment_.FastForwardBy(Seconds(1) + kResolution);
+  EXPECT_EQ(count, 0);
+  EXPECT_TRUE(timer2.IsRunning());
+  task_environment_.FastForwardBy(Seconds(1) + kResolution);
+  EXPECT_EQ(count, 1);
+  EXPECT_GE(run_time - start, Seconds(2));
+}
+
+TEST_F(TimerWheelTest, SelfDeletingTimer) {
+  auto timer = std::make_unique<WheelOneShotTimer>(&wheel_);
+  timer->Start(FROM_HERE, Seconds(1),
+               BindLambdaForTesting([&]() { timer.reset(); }));
+  task_environment_.FastForwardBy(Seconds(2));
+  EXPECT_FALSE(timer);
+}
+
+TEST(TimerWheelDeletionTest, DeleteWheelFromTimer) {
+  test::TaskEnvironment task_environment(
+      test::TaskEnvironment::TimeSource::MOCK_TIME);
+  auto wheel = std::make_unique<TimerWheel>();
+  auto timer1 = std::make_unique<WheelOneShotTimer>(wheel.get());
+  auto timer2 = std::make_unique<WheelOneShotTimer>(wheel.get());
+  timer1->Start(FROM_HERE, Seconds(1), BindLambdaForTesting([&]() {
+                  timer2.reset();
+                  timer1.reset();
+                  wheel.reset();
+                }));
+  timer2->Start(FROM_HERE, Seconds(1), DoNothing());
+  task_environment.FastForwardBy(Seconds(2));
+  EXPECT_FALSE(wheel);
+}
+
+}  // namespace base
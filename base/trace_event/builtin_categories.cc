@@ -9,6 +9,15 @@ namespace trace_event {
 
 constexpr const char* BuiltinCategories::kBuiltinCategories[];
 constexpr const char* BuiltinCategories::kCategoriesForTesting[];
+constexpr const char* BuiltinCategories::kStaticKeyCategories[];
+
+#define INTERNAL_TRACE_ASSERT_STATIC_KEY_CATEGORY(name)  \
+  static_assert(BuiltinCategories::GetStaticKey(name) != \
+                    BuiltinCategories::kNoStaticKey,     \
+                "The static key categories must be builtin categories");
+INTERNAL_TRACE_LIST_STATIC_KEY_CATEGORIES(
+    INTERNAL_TRACE_ASSERT_STATIC_KEY_CATEGORY)
+#undef INTERNAL_TRACE_ASSERT_STATIC_KEY_CATEGORY
 
 }  // namespace trace_event
 }  // namespace base
\ No newline at end of file
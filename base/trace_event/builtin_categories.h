@@ -5,6 +5,9 @@
 #ifndef BASE_TRACE_EVENT_BUILTIN_CATEGORIES_H_
 #define BASE_TRACE_EVENT_BUILTIN_CATEGORIES_H_
 
+#include <stddef.h>
+#include <stdint.h>
+
 #include "base/base_export.h"
 #include "base/cxx17_backports.h"
 #include "base/trace_event/common/trace_event_common.h"
@@ -352,6 +355,17 @@
   X(TRACE_DISABLED_BY_DEFAULT("v8.inspector") "," TRACE_DISABLED_BY_DEFAULT(  \
       "v8.stack_trace"))
 
+// The builtin categories of the hottest TRACE_EVENT* call sites, those which
+// get a static key when ENABLE_TRACE_STATIC_KEYS is set: see
+// base/trace_event/trace_static_keys.h. Each must be in the list above.
+#define INTERNAL_TRACE_LIST_STATIC_KEY_CATEGORIES(X) \
+  X("base")                                          \
+  X("ipc")                                           \
+  X("mojom")                                         \
+  X("sequence_manager")                              \
+  X("toplevel")                                      \
+  X("toplevel.flow")
+
 #define INTERNAL_TRACE_INIT_CATEGORY_NAME(name) name,
 
 #define INTERNAL_TRACE_INIT_CATEGORY(name) {0, 0, name},
@@ -428,6 +442,23 @@ class BASE_EXPORT BuiltinCategories {
   // about://tracing UI.
   static constexpr size_t kVisibleCategoryStart = 3;
 
+  // Returned by GetStaticKey() for the categories without a static key.
+  static constexpr uint32_t kNoStaticKey = UINT32_MAX;
+
+  // Returns the static key of |category|, its index in the builtin list, if
+  // it's in INTERNAL_TRACE_LIST_STATIC_KEY_CATEGORIES, or kNoStaticKey.
+  static constexpr uint32_t GetStaticKey(const char* category) {
+    if (!IsStringInArray(category, kStaticKeyCategories,
+                         base::size(kStaticKeyCategories))) {
+      return kNoStaticKey;
+    }
+    for (size_t i = 0; i < Size(); ++i) {
+      if (StrEqConstexpr(category, At(i)))
+        return static_cast<uint32_t>(i);
+    }
+    return kNoStaticKey;
+  }
+
   // Returns whether the category is either:
   // - Properly registered in the builtin list.
   // - Constists of several categories separated by commas.
@@ -450,6 +481,11 @@ class BASE_EXPORT BuiltinCategories {
       INTERNAL_TRACE_LIST_BUILTIN_CATEGORIES(
           INTERNAL_TRACE_INIT_CATEGORY_NAME)};
 
+  // The array of the builtin categories with a static key.
+  static constexpr const char* kStaticKeyCategories[] = {
+      INTERNAL_TRACE_LIST_STATIC_KEY_CATEGORIES(
+          INTERNAL_TRACE_INIT_CATEGORY_NAME)};
+
   // The array of category names used only for testing. It's kept separately
   // from the main list to avoid allocating the space for them in the binary.
   static constexpr const char* kCategoriesForTesting[] = {
@@ -10,8 +10,8 @@
 #include <type_traits>
 
 #include "base/check.h"
-#include "base/debug/leak_annotations.h"
 #include "base/notreached.h"
+#include "base/strings/string_atom.h"
 #include "base/third_party/dynamic_annotations/dynamic_annotations.h"
 
 namespace base {
@@ -32,6 +32,13 @@ TraceCategory CategoryRegistry::categories_[kMaxCategories] = {
 std::atomic<size_t> CategoryRegistry::category_index_{
     BuiltinCategories::Size()};
 
+// static
+std::atomic<uint64_t>
+    CategoryRegistry::category_hash_index_[kCategoryHashIndexSize];
+
+// static
+std::atomic<bool> CategoryRegistry::builtin_categories_indexed_{false};
+
 // static
 TraceCategory* const CategoryRegistry::kCategoryExhausted = &categories_[0];
 TraceCategory* const CategoryRegistry::kCategoryAlreadyShutdown =
@@ -64,16 +71,37 @@ void CategoryRegistry::ResetForTesting() {
 
 // static
 TraceCategory* CategoryRegistry::GetCategoryByName(const char* category_name) {
+  return GetCategoryByName(category_name, HashCategoryName(category_name));
+}
+
+// static
+TraceCategory* CategoryRegistry::GetCategoryByName(const char* category_name,
+                                                   uint32_t name_hash) {
   DCHECK(!strchr(category_name, '"'))
       << "Category names may not contain double quote";
+  DCHECK_EQ(name_hash, HashCategoryName(category_name));
+
+  // The hash index is append only, avoid using a lock for the fast path. The
+  // acquire load of a slot makes the category it points at, fully initialized
+  // by GetOrCreateCategoryLocked(), visible.
+  for (size_t i = name_hash & (kCategoryHashIndexSize - 1);;
+       i = (i + 1) & (kCategoryHashIndexSize - 1)) {
+    const uint64_t slot =
+        category_hash_index_[i].load(std::memory_order_acquire);
+    if (!slot)
+      break;
+    if (static_cast<uint32_t>(slot >> 32) != name_hash)
+      continue;
+    TraceCategory* category = &categories_[static_cast<uint32_t>(slot) - 1];
+    if (strcmp(category->name(), category_name) == 0)
+      return category;
+  }
 
-  // The categories_ is append only, avoid using a lock for the fast path.
-  size_t category_index = category_index_.load(std::memory_order_acquire);
-
-  // Search for pre-existing category group.
-  for (size_t i = 0; i < category_index; ++i) {
-    if (strcmp(categories_[i].name(), category_name) == 0) {
-      return &categories_[i];
+  // Until the first category is created, the builtin ones aren't indexed.
+  if (!builtin_categories_indexed_.load(std::memory_order_acquire)) {
+    for (size_t i = 0; i < BuiltinCategories::Size(); ++i) {
+      if (strcmp(categories_[i].name(), category_name) == 0)
+        return &categories_[i];
     }
   }
   return nullptr;
@@ -86,10 +114,17 @@ bool CategoryRegistry::GetOrCreateCategoryLocked(
   // This is the slow path: the lock is not held in the fastpath
   // (GetCategoryByName), so more than one thread could have reached here trying
   // to add the same category.
-  *category = GetCategoryByName(category_name);
+  const uint32_t name_hash = HashCategoryName(category_name);
+  *category = GetCategoryByName(category_name, name_hash);
   if (*category)
     return false;
 
+  if (!builtin_categories_indexed_.load(std::memory_order_relaxed)) {
+    for (size_t i = 0; i < BuiltinCategories::Size(); ++i)
+      AddToHashIndexLocked(i, HashCategoryName(categories_[i].name()));
+    builtin_categories_indexed_.store(true, std::memory_order_release);
+  }
+
   // Create a new category.
   size_t category_index = category_index_.load(std::memory_order_acquire);
   if (category_index >= kMaxCategories) {
@@ -98,20 +133,19 @@ bool CategoryRegistry::GetOrCreateCategoryLocked(
     return false;
   }
 
-  // TODO(primiano): this strdup should be removed. The only documented reason
-  // for it was TraceWatchEvent, which is gone. However, something might have
-  // ended up relying on this. Needs some auditing before removal.
-  const char* category_name_copy = strdup(category_name);
-  ANNOTATE_LEAKING_OBJECT_PTR(category_name_copy);
+  // The name is copied, since something may rely on the caller's copy not
+  // having to outlive the category. The interned copy is never freed.
+  const StringAtom name(category_name);
 
   *category = &categories_[category_index];
   DCHECK(!(*category)->is_valid());
   DCHECK(!(*category)->is_enabled());
-  (*category)->set_name(category_name_copy);
+  (*category)->set_name(name.c_str());
   category_initializer_fn(*category);
 
   // Update the max index now.
   category_index_.store(category_index + 1, std::memory_order_release);
+  AddToHashIndexLocked(category_index, name_hash);
   return true;
 }
 
@@ -147,5 +181,16 @@ bool CategoryRegistry::IsValidCategoryPtr(const TraceCategory* category) {
          ptr <= reinterpret_cast<uintptr_t>(&categories_[kMaxCategories - 1]);
 }
 
+// static
+void CategoryRegistry::AddToHashIndexLocked(size_t category_index,
+                                            uint32_t name_hash) {
+  size_t i = name_hash & (kCategoryHashIndexSize - 1);
+  while (category_hash_index_[i].load(std::memory_order_relaxed))
+    i = (i + 1) & (kCategoryHashIndexSize - 1);
+  category_hash_index_[i].store(
+      (uint64_t{name_hash} << 32) | (category_index + 1),
+      std::memory_order_release);
+}
+
 }  // namespace trace_event
 }  // namespace base
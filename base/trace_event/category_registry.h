@@ -65,6 +65,22 @@ class BASE_EXPORT CategoryRegistry {
   // pointer and use it for checks in their fast-paths.
   static TraceCategory* GetCategoryByName(const char* category_name);
 
+  // Same as above, with |name_hash| == HashCategoryName(category_name), which
+  // callers looking up a string literal can compute at compile-time.
+  static TraceCategory* GetCategoryByName(const char* category_name,
+                                          uint32_t name_hash);
+
+  // Returns the hash under which GetCategoryByName() indexes |category_name|
+  // (32-bit FNV-1a).
+  static constexpr uint32_t HashCategoryName(const char* category_name) {
+    uint32_t hash = 2166136261u;
+    for (; *category_name; ++category_name) {
+      hash ^= static_cast<uint8_t>(*category_name);
+      hash *= 16777619u;
+    }
+    return hash;
+  }
+
   // Returns a built-in category from its name or nullptr if not found at
   // compile-time. The return value is an undefinitely lived pointer to the
   // TraceCategory owned by the registry.
@@ -93,7 +109,13 @@ class BASE_EXPORT CategoryRegistry {
   using CategoryInitializerFn = void (*)(TraceCategory*);
 
   // The max number of trace categories that can be recorded.
-  static constexpr size_t kMaxCategories = 300;
+  static constexpr size_t kMaxCategories = 1024;
+
+  // The number of slots of |category_hash_index_|. Keeping it at least twice
+  // kMaxCategories bounds the length of the probe sequences.
+  static constexpr size_t kCategoryHashIndexSize = 2 * kMaxCategories;
+  static_assert((kCategoryHashIndexSize & (kCategoryHashIndexSize - 1)) == 0,
+                "kCategoryHashIndexSize must be a power of 2");
 
   // Checks that there is enough space for all builtin categories.
   static_assert(BuiltinCategories::Size() <= kMaxCategories,
@@ -121,11 +143,25 @@ class BASE_EXPORT CategoryRegistry {
   // Returns whether |category| correctly points at |categories_| array entry.
   static bool IsValidCategoryPtr(const TraceCategory* category);
 
+  // Adds |categories_[category_index]| to |category_hash_index_|. Must be
+  // called with the same serialization as GetOrCreateCategoryLocked().
+  static void AddToHashIndexLocked(size_t category_index, uint32_t name_hash);
+
   // The static array of trace categories.
   static TraceCategory categories_[kMaxCategories];
 
   // Contains the number of created categories.
   static std::atomic<size_t> category_index_;
+
+  // Append-only open-addressing hash table over |categories_|, probed
+  // linearly without a lock by GetCategoryByName(). A slot holds the name hash
+  // in its high 32 bits and the category index + 1 in its low 32 bits, or 0 if
+  // empty. The builtin categories are only added by the first call to
+  // GetOrCreateCategoryLocked(), see |builtin_categories_indexed_|.
+  static std::atomic<uint64_t> category_hash_index_[kCategoryHashIndexSize];
+
+  // Whether the builtin categories are in |category_hash_index_| yet.
+  static std::atomic<bool> builtin_categories_indexed_;
 };
 
 }  // namespace trace_event
@@ -0,0 +1,95 @@
+// Copyright 2022 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "base/trace_event/category_registry.h"
+
+#include <string>
+#include <vector>
+
+#include "base/strings/stringprintf.h"
+#include "base/time/time.h"
+#include "base/trace_event/trace_log.h"
+#include "testing/gtest/include/gtest/gtest.h"
+#include "testing/perf/perf_result_reporter.h"
+
+namespace base {
+namespace trace_event {
+
+namespace {
+
+constexpr char kMetricPrefix[] = "CategoryRegistry.";
+constexpr char kThroughput[] = "throughput";
+
+// The order of magnitude of the categories registered by a browser process,
+// including the builtin ones.
+constexpr int kNumCategories = 500;
+constexpr int kLookupRounds = 1000;
+
+void ReportThroughput(const std::string& story,
+                      TimeDelta elapsed,
+                      int iterations) {
+  perf_test::PerfResultReporter reporter(kMetricPrefix, story);
+  reporter.RegisterImportantMetric(kThroughput, "ns / iteration");
+  reporter.AddResult(kThroughput, static_cast<size_t>(
+                                      elapsed.InNanoseconds() / iterations));
+}
+
+std::vector<std::string> MakeCategoryNames(const char* prefix) {
+  std::vector<std::string> names;
+  for (int i = 0; i < kNumCategories; i++)
+    names.push_back(StringPrintf("%s.category_%d", prefix, i));
+  return names;
+}
+
+}  // namespace
+
+TEST(CategoryRegistryPerfTest, RegisterAndLookup) {
+  const std::vector<std::string> names = MakeCategoryNames("perftest");
+
+  TimeTicks before = TimeTicks::Now();
+  for (const std::string& name : names)
+    TraceLog::GetCategoryGroupEnabled(name.c_str());
+  ReportThroughput("Register", TimeTicks::Now() - before, kNumCategories);
+
+  size_t num_found = 0;
+  before = TimeTicks::Now();
+  for (int round = 0; round < kLookupRounds; round++) {
+    for (const std::string& name : names)
+      num_found += !!CategoryRegistry::GetCategoryByName(name.c_str());
+  }
+  ReportThroughput("LookupHit", TimeTicks::Now() - before,
+                   kLookupRounds * kNumCategories);
+  EXPECT_EQ(static_cast<size_t>(kLookupRounds * kNumCategories), num_found);
+}
+
+TEST(CategoryRegistryPerfTest, LookupMiss) {
+  const std::vector<std::string> names = MakeCategoryNames("missing");
+
+  size_t num_found = 0;
+  const TimeTicks before = TimeTicks::Now();
+  for (int round = 0; round < kLookupRounds; round++) {
+    for (const std::string& name : names)
+      num_found += !!CategoryRegistry::GetCategoryByName(name.c_str());
+  }
+  ReportThroughput("LookupMiss", TimeTicks::Now() - before,
+                   kLookupRounds * kNumCategories);
+  EXPECT_EQ(0u, num_found);
+}
+
+TEST(CategoryRegistryPerfTest, LookupBuiltin) {
+  size_t num_found = 0;
+  const TimeTicks before = TimeTicks::Now();
+  for (int round = 0; round < kLookupRounds; round++) {
+    for (size_t i = 0; i < BuiltinCategories::Size(); i++) {
+      num_found +=
+          !!CategoryRegistry::GetCategoryByName(BuiltinCategories::At(i));
+    }
+  }
+  ReportThroughput("LookupBuiltin", TimeTicks::Now() - before,
+                   kLookupRounds * BuiltinCategories::Size());
+  EXPECT_EQ(kLookupRounds * BuiltinCategories::Size(), num_found);
+}
+
+}  // namespace trace_event
+}  // namespace base
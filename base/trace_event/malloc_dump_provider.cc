@@ -437,6 +437,9 @@ void ReportPartitionAllocThreadCacheStats(ProcessMemoryDump* pmd,
   dump->AddScalar("cache_fill_misses", "scalar", stats.cache_fill_misses);
 
   dump->AddScalar("batch_fill_count", "scalar", stats.batch_fill_count);
+  dump->AddScalar("batch_clear_count", "scalar", stats.batch_clear_count);
+  dump->AddScalar("limit_rebalance_count", "scalar",
+                  stats.limit_rebalance_count);
 
   dump->AddScalar("size", "bytes", stats.bucket_total_memory);
   dump->AddScalar("metadata_overhead", "bytes", stats.metadata_overhead);
@@ -452,6 +455,11 @@ void ReportPartitionAllocThreadCacheStats(ProcessMemoryDump* pmd,
     base::UmaHistogramPercentage(
         "Memory.PartitionAlloc.ThreadCache.BatchFillRate" + metrics_suffix,
         batch_fill_rate_percent);
+    int batch_clear_rate_percent =
+        static_cast<int>((100 * stats.batch_clear_count) / stats.alloc_count);
+    base::UmaHistogramPercentage(
+        "Memory.PartitionAlloc.ThreadCache.BatchClearRate" + metrics_suffix,
+        batch_clear_rate_percent);
 
 #if defined(PA_THREAD_CACHE_ALLOC_STATS)
     if (detailed) {
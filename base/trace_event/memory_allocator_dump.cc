@@ -4,11 +4,17 @@
 
 #include "base/trace_event/memory_allocator_dump.h"
 
-#include <string.h>
+#include <inttypes.h>
+#include <stdio.h>
+
+#include <deque>
+#include <unordered_set>
+#include <utility>
 
 #include "base/format_macros.h"
-#include "base/memory/ptr_util.h"
-#include "base/strings/stringprintf.h"
+#include "base/no_destructor.h"
+#include "base/synchronization/lock.h"
+#include "base/thread_annotations.h"
 #include "base/trace_event/memory_dump_manager.h"
 #include "base/trace_event/memory_dump_provider.h"
 #include "base/trace_event/process_memory_dump.h"
@@ -27,6 +33,50 @@ const char MemoryAllocatorDump::kTypeString[] = "string";
 const char MemoryAllocatorDump::kUnitsBytes[] = "bytes";
 const char MemoryAllocatorDump::kUnitsObjects[] = "objects";
 
+namespace {
+
+// The strings that Entry names and units are interned into. They are never
+// freed, since the TracedValues which use them as keys can outlive the dumps.
+class EntryStringTable {
+ public:
+  EntryStringTable() {
+    // The standard names and units are interned as themselves, so entries can
+    // be compared with them as pointers.
+    for (const char* str :
+         {MemoryAllocatorDump::kNameSize, MemoryAllocatorDump::kNameObjectCount,
+          MemoryAllocatorDump::kUnitsBytes,
+          MemoryAllocatorDump::kUnitsObjects}) {
+      strings_.insert(str);
+    }
+  }
+  EntryStringTable(const EntryStringTable&) = delete;
+  EntryStringTable& operator=(const EntryStringTable&) = delete;
+
+  const char* Intern(StringPiece str) {
+    AutoLock lock(lock_);
+    auto it = strings_.find(str);
+    if (it != strings_.end())
+      return it->data();
+    // A deque doesn't move its strings as it grows.
+    const std::string& interned = storage_.emplace_back(str);
+    strings_.insert(interned);
+    return interned.c_str();
+  }
+
+ private:
+  Lock lock_;
+  // Views either of |storage_| or of the standard names, all null-terminated.
+  std::unordered_set<StringPiece, StringPieceHash> strings_ GUARDED_BY(lock_);
+  std::deque<std::string> storage_ GUARDED_BY(lock_);
+};
+
+const char* InternEntryString(StringPiece str) {
+  static NoDestructor<EntryStringTable> table;
+  return table->Intern(str);
+}
+
+}  // namespace
+
 MemoryAllocatorDump::MemoryAllocatorDump(
     const std::string& absolute_name,
     MemoryDumpLevelOfDetail level_of_detail,
@@ -63,20 +113,23 @@ void MemoryAllocatorDump::AddString(const char* name,
 }
 
 void MemoryAllocatorDump::AsValueInto(TracedValue* value) const {
-  std::string string_conversion_buffer;
+  // Large enough for a uint64_t in hex. The values are formatted on the stack,
+  // and the interned names are written as long lived keys, so a dump is
+  // streamed into |value| without building strings.
+  char buffer[17];
   value->BeginDictionaryWithCopiedName(absolute_name_);
-  value->SetString("guid", guid_.ToString());
+  snprintf(buffer, sizeof(buffer), "%" PRIx64, guid_.ToUint64());
+  value->SetString("guid", buffer);
   value->BeginDictionary("attrs");
 
   for (const Entry& entry : entries_) {
-    value->BeginDictionaryWithCopiedName(entry.name);
+    value->BeginDictionary(entry.name);
     switch (entry.entry_type) {
       case Entry::kUint64:
-        SStringPrintf(&string_conversion_buffer, "%" PRIx64,
-                      entry.value_uint64);
+        snprintf(buffer, sizeof(buffer), "%" PRIx64, entry.value_uint64);
         value->SetString("type", kTypeScalar);
         value->SetString("units", entry.units);
-        value->SetString("value", string_conversion_buffer);
+        value->SetString("value", buffer);
         break;
       case Entry::kString:
         value->SetString("type", kTypeString);
@@ -102,7 +155,7 @@ void MemoryAllocatorDump::AsProtoInto(
   }
 
   for (const Entry& entry : entries_) {
-    if (entry.name == "size") {
+    if (entry.name == kNameSize) {
       DCHECK_EQ(entry.entry_type, Entry::EntryType::kUint64);
       DCHECK_EQ(entry.units, kUnitsBytes);
       memory_node->set_size_bytes(entry.value_uint64);
@@ -143,7 +196,7 @@ uint64_t MemoryAllocatorDump::GetSizeInternal() const {
     return *cached_size_;
   for (const auto& entry : entries_) {
     if (entry.entry_type == Entry::kUint64 && entry.units == kUnitsBytes &&
-        strcmp(entry.name.c_str(), kNameSize) == 0) {
+        entry.name == kNameSize) {
       cached_size_ = entry.value_uint64;
       return entry.value_uint64;
     }
@@ -151,19 +204,26 @@ uint64_t MemoryAllocatorDump::GetSizeInternal() const {
   return 0;
 }
 
-MemoryAllocatorDump::Entry::Entry() : entry_type(kString), value_uint64() {}
+MemoryAllocatorDump::Entry::Entry() : Entry("", "", std::string()) {}
 MemoryAllocatorDump::Entry::Entry(MemoryAllocatorDump::Entry&&) noexcept =
     default;
 MemoryAllocatorDump::Entry& MemoryAllocatorDump::Entry::operator=(
     MemoryAllocatorDump::Entry&&) = default;
-MemoryAllocatorDump::Entry::Entry(std::string name,
-                                  std::string units,
+MemoryAllocatorDump::Entry::Entry(StringPiece name,
+                                  StringPiece units,
                                   uint64_t value)
-    : name(name), units(units), entry_type(kUint64), value_uint64(value) {}
-MemoryAllocatorDump::Entry::Entry(std::string name,
-                                  std::string units,
+    : name(InternEntryString(name)),
+      units(InternEntryString(units)),
+      entry_type(kUint64),
+      value_uint64(value) {}
+MemoryAllocatorDump::Entry::Entry(StringPiece name,
+                                  StringPiece units,
                                   std::string value)
-    : name(name), units(units), entry_type(kString), value_string(value) {}
+    : name(InternEntryString(name)),
+      units(InternEntryString(units)),
+      entry_type(kString),
+      value_uint64(),
+      value_string(std::move(value)) {}
 
 bool MemoryAllocatorDump::Entry::operator==(const Entry& rhs) const {
   if (!(name == rhs.name && units == rhs.units && entry_type == rhs.entry_type))
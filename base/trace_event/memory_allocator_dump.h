@@ -13,6 +13,7 @@
 #include <vector>
 
 #include "base/base_export.h"
+#include "base/strings/string_piece.h"
 #include "base/trace_event/memory_allocator_dump_guid.h"
 #include "base/trace_event/memory_dump_request_args.h"
 #include "base/unguessable_token.h"
@@ -51,21 +52,21 @@ class BASE_EXPORT MemoryAllocatorDump {
       kString,
     };
 
-    // By design name, units and value_string are  always coming from
-    // indefinitely lived const char* strings, the only reason we copy
-    // them into a std::string is to handle Mojo (de)serialization.
-    // TODO(hjd): Investigate optimization (e.g. using StringPiece).
+    // |name| and |units| are interned: entries with equal names (or units)
+    // share the same indefinitely lived string, so they compare as pointers,
+    // hash cheaply and serialize as long lived TracedValue keys. The standard
+    // kName* and kUnits* constants are interned as themselves.
     Entry();  // Only for deserialization.
-    Entry(std::string name, std::string units, uint64_t value);
-    Entry(std::string name, std::string units, std::string value);
+    Entry(StringPiece name, StringPiece units, uint64_t value);
+    Entry(StringPiece name, StringPiece units, std::string value);
     Entry(Entry&& other) noexcept;
     Entry(const Entry&) = delete;
     Entry& operator=(const Entry&) = delete;
     Entry& operator=(Entry&& other);
     bool operator==(const Entry& rhs) const;
 
-    std::string name;
-    std::string units;
+    const char* name;
+    const char* units;
 
     EntryType entry_type;
 
@@ -6,6 +6,8 @@
 
 #include <stdint.h>
 
+#include <string>
+
 #include "base/format_macros.h"
 #include "base/trace_event/memory_allocator_dump_guid.h"
 #include "base/trace_event/memory_dump_provider.h"
@@ -149,6 +151,51 @@ TEST(MemoryAllocatorDumpTest, MovingAnEntry) {
   EXPECT_EQ(expected_entry, to_entry);
 }
 
+TEST(MemoryAllocatorDumpTest, InternedEntryNames) {
+  MemoryDumpArgs dump_args = {MemoryDumpLevelOfDetail::DETAILED};
+  ProcessMemoryDump pmd(dump_args);
+  MemoryAllocatorDump* dump1 = pmd.CreateAllocatorDump("dump1");
+  MemoryAllocatorDump* dump2 = pmd.CreateAllocatorDump("dump2");
+  std::string name = "attr";
+  std::string units = "units";
+  dump1->AddScalar(name.c_str(), units.c_str(), 1);
+  dump1->AddScalar("size", "bytes", 2);
+  name = "other";
+  dump2->AddScalar("attr", "units", 3);
+  dump2->AddString(name.c_str(), units.c_str(), "value");
+
+  // Equal names and units share the same interned string, and the standard
+  // ones are interned as themselves.
+  EXPECT_STREQ("attr", dump1->entries()[0].name);
+  EXPECT_EQ(dump1->entries()[0].name, dump2->entries()[0].name);
+  EXPECT_EQ(dump1->entries()[0].units, dump2->entries()[0].units);
+  EXPECT_EQ(MemoryAllocatorDump::kNameSize, dump1->entries()[1].name);
+  EXPECT_EQ(MemoryAllocatorDump::kUnitsBytes, dump1->entries()[1].units);
+  EXPECT_STREQ("other", dump2->entries()[1].name);
+  EXPECT_EQ(2u, dump1->GetSizeInternal());
+}
+
+TEST(MemoryAllocatorDumpTest, AsValueInto) {
+  MemoryDumpArgs dump_args = {MemoryDumpLevelOfDetail::DETAILED};
+  ProcessMemoryDump pmd(dump_args);
+  MemoryAllocatorDump* dump = pmd.CreateAllocatorDump(
+      "foo/bar", MemoryAllocatorDumpGuid(0x42u));
+  dump->AddScalar(MemoryAllocatorDump::kNameSize,
+                  MemoryAllocatorDump::kUnitsBytes, 0xffffffffffffffffu);
+  dump->AddString("name", "", "baz");
+  dump->set_flags(MemoryAllocatorDump::WEAK);
+
+  TracedValueJSON value;
+  dump->AsValueInto(&value);
+  EXPECT_EQ(
+      "{\"foo/bar\":{\"guid\":\"42\",\"attrs\":{"
+      "\"size\":{\"type\":\"scalar\",\"units\":\"bytes\","
+      "\"value\":\"ffffffffffffffff\"},"
+      "\"name\":{\"type\":\"string\",\"units\":\"\",\"value\":\"baz\"}},"
+      "\"flags\":1}}",
+      value.ToJSON());
+}
+
 // DEATH tests are not supported in Android/iOS/Fuchsia.
 #if !defined(NDEBUG) && !BUILDFLAG(IS_ANDROID) && !BUILDFLAG(IS_IOS) && \
     !BUILDFLAG(IS_FUCHSIA)
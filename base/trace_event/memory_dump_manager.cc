@@ -8,19 +8,26 @@
 #include <stdio.h>
 
 #include <algorithm>
+#include <atomic>
 #include <memory>
+#include <set>
+#include <string>
 #include <tuple>
 #include <utility>
+#include <vector>
 
 #include "base/allocator/buildflags.h"
 #include "base/base_switches.h"
 #include "base/command_line.h"
 #include "base/debug/alias.h"
 #include "base/debug/stack_trace.h"
+#include "base/hash/hash.h"
 #include "base/logging.h"
 #include "base/memory/ptr_util.h"
 #include "base/strings/string_util.h"
+#include "base/task/post_job.h"
 #include "base/task/sequenced_task_runner.h"
+#include "base/task/thread_pool/thread_pool_instance.h"
 #include "base/third_party/dynamic_annotations/dynamic_annotations.h"
 #include "base/threading/thread.h"
 #include "base/threading/thread_task_runner_handle.h"
@@ -66,8 +73,45 @@ void DoGlobalDumpWithoutCallback(
   global_dump_fn.Run(dump_type, level_of_detail);
 }
 
+// Returns a hash of the flags and entries of |mad|, which changes when the
+// dump does. Entry names and units are interned, so their addresses identify
+// them and only string values need hashing.
+size_t HashAllocatorDump(const MemoryAllocatorDump& mad) {
+  size_t hash = HashInts(mad.flags(), mad.entries().size());
+  for (const MemoryAllocatorDump::Entry& entry : mad.entries()) {
+    hash = HashInts(hash, reinterpret_cast<uintptr_t>(entry.name));
+    hash = HashInts(hash, reinterpret_cast<uintptr_t>(entry.units));
+    hash = HashInts(hash, static_cast<uint32_t>(entry.entry_type));
+    if (entry.entry_type == MemoryAllocatorDump::Entry::kUint64)
+      hash = HashInts(hash, entry.value_uint64);
+    else
+      hash = HashInts(hash, FastHash(entry.value_string));
+  }
+  return hash;
+}
+
 }  // namespace
 
+struct MemoryDumpManager::ConcurrentDumpState {
+  size_t GetMaxConcurrency(size_t /*worker_count*/) const {
+    // memory_order_relaxed is sufficient since this is not synchronized with
+    // other state.
+    const size_t next = next_index.load(std::memory_order_relaxed);
+    return dump_providers.size() - std::min(next, dump_providers.size());
+  }
+
+  std::vector<scoped_refptr<MemoryDumpProviderInfo>> dump_providers;
+
+  // The ProcessMemoryDump of each of |dump_providers|, merged into the one of
+  // the process dump once they all are done.
+  std::vector<std::unique_ptr<ProcessMemoryDump>> process_memory_dumps;
+
+  // The index of the next dump provider to invoke.
+  std::atomic<size_t> next_index{0};
+
+  JobHandle job_handle;
+};
+
 // static
 constexpr const char* MemoryDumpManager::kTraceCategory;
 
@@ -315,8 +359,12 @@ void MemoryDumpManager::CreateProcessDump(const MemoryDumpRequestArgs& args,
   {
     AutoLock lock(lock_);
 
+    const bool is_incremental =
+        incremental_light_dumps_ &&
+        args.dump_type == MemoryDumpType::PERIODIC_INTERVAL &&
+        args.level_of_detail == MemoryDumpLevelOfDetail::LIGHT;
     pmd_async_state = std::make_unique<ProcessMemoryDumpAsyncState>(
-        args, dump_providers_, std::move(callback),
+        args, is_incremental, dump_providers_, std::move(callback),
         GetOrCreateBgTaskRunnerLocked());
   }
 
@@ -328,8 +376,10 @@ void MemoryDumpManager::CreateProcessDump(const MemoryDumpRequestArgs& args,
 // Invokes OnMemoryDump() on all MDPs that are next in the pending list and run
 // on the current sequenced task runner. If the next MDP does not run in current
 // sequenced task runner, then switches to that task runner and continues. All
-// OnMemoryDump() invocations are linearized. |lock_| is used in these functions
-// purely to ensure consistency w.r.t. (un)registrations of |dump_providers_|.
+// OnMemoryDump() invocations are linearized, except for the unbound MDPs which
+// support concurrent dumps: these run in parallel with the other unbound MDPs,
+// as a job on the thread pool. |lock_| is used in these functions purely to
+// ensure consistency w.r.t. (un)registrations of |dump_providers_|.
 void MemoryDumpManager::ContinueAsyncProcessDump(
     ProcessMemoryDumpAsyncState* owned_pmd_async_state) {
   HEAP_PROFILER_SCOPED_IGNORE;
@@ -375,6 +425,13 @@ void MemoryDumpManager::ContinueAsyncProcessDump(
     // If |RunsTasksInCurrentSequence()| is true then no PostTask is
     // required since we are on the right SequencedTaskRunner.
     if (task_runner->RunsTasksInCurrentSequence()) {
+      // The unbound MDPs are the last ones. Without a thread pool (e.g. in
+      // some tests) they are all invoked on |dump_thread_|.
+      if (!mdpinfo->task_runner && !pmd_async_state->concurrent_dumps &&
+          ThreadPoolInstance::Get()) {
+        StartConcurrentDumps(pmd_async_state.get());
+        continue;
+      }
       InvokeOnMemoryDump(mdpinfo, pmd_async_state->process_memory_dump.get());
       pmd_async_state->pending_dump_providers.pop_back();
       continue;
@@ -405,6 +462,8 @@ void MemoryDumpManager::ContinueAsyncProcessDump(
     pmd_async_state->pending_dump_providers.pop_back();
   }
 
+  if (pmd_async_state->concurrent_dumps)
+    FinishConcurrentDumps(pmd_async_state.get());
   FinishAsyncProcessDump(std::move(pmd_async_state));
 }
 
@@ -418,8 +477,9 @@ void MemoryDumpManager::InvokeOnMemoryDump(MemoryDumpProviderInfo* mdpinfo,
   DCHECK(!mdpinfo->task_runner ||
          mdpinfo->task_runner->RunsTasksInCurrentSequence());
 
-  TRACE_EVENT1(kTraceCategory, "MemoryDumpManager::InvokeOnMemoryDump",
-               "dump_provider.name", mdpinfo->name);
+  TRACE_EVENT2(kTraceCategory, "MemoryDumpManager::InvokeOnMemoryDump",
+               "dump_provider.name", mdpinfo->name, "time_budget_ms",
+               mdpinfo->options.time_budget.InMillisecondsF());
 
   // Do not add any other TRACE_EVENT macro (or function that might have them)
   // below this point. Under some rare circunstances, they can re-initialize
@@ -428,6 +488,7 @@ void MemoryDumpManager::InvokeOnMemoryDump(MemoryDumpProviderInfo* mdpinfo,
   // (https://crbug.com/763365).
 
   bool is_thread_bound;
+  uint32_t tracing_session;
   {
     // A locked access is required to R/W |disabled| (for the
     // UnregisterAndDeleteDumpProviderSoon() case).
@@ -444,6 +505,7 @@ void MemoryDumpManager::InvokeOnMemoryDump(MemoryDumpProviderInfo* mdpinfo,
       return;
 
     is_thread_bound = mdpinfo->task_runner != nullptr;
+    tracing_session = tracing_session_;
   }  // AutoLock lock(lock_);
 
   // Invoke the dump provider.
@@ -460,10 +522,140 @@ void MemoryDumpManager::InvokeOnMemoryDump(MemoryDumpProviderInfo* mdpinfo,
   ANNOTATE_BENIGN_RACE(&mdpinfo->disabled, "best-effort race detection");
   CHECK(!is_thread_bound ||
         !*(static_cast<volatile bool*>(&mdpinfo->disabled)));
+  MemoryDumpArgs args = pmd->dump_args();
+  if (!mdpinfo->options.time_budget.is_zero())
+    args.deadline = TimeTicks::Now() + mdpinfo->options.time_budget;
+
+  // In incremental dumps, the MDP dumps into its own ProcessMemoryDump so that
+  // its allocator dumps can be compared with the ones of its last dump.
+  std::unique_ptr<ProcessMemoryDump> mdp_pmd;
+  if (args.is_incremental)
+    mdp_pmd = std::make_unique<ProcessMemoryDump>(pmd->dump_args());
   bool dump_successful =
-      mdpinfo->dump_provider->OnMemoryDump(pmd->dump_args(), pmd);
+      mdpinfo->dump_provider->OnMemoryDump(args, mdp_pmd ? mdp_pmd.get() : pmd);
   mdpinfo->consecutive_failures =
       dump_successful ? 0 : mdpinfo->consecutive_failures + 1;
+
+  if (mdp_pmd) {
+    RemoveUnchangedAllocatorDumps(mdpinfo, tracing_session, mdp_pmd.get());
+    pmd->TakeAllDumpsFrom(mdp_pmd.get());
+  } else {
+    // The next incremental dump is relative to this complete one.
+    mdpinfo->last_dump_hashes.clear();
+  }
+}
+
+void MemoryDumpManager::StartConcurrentDumps(
+    ProcessMemoryDumpAsyncState* pmd_async_state) {
+  DCHECK(pmd_async_state->dump_thread_task_runner->RunsTasksInCurrentSequence());
+  DCHECK(!pmd_async_state->concurrent_dumps);
+  auto concurrent_dumps = std::make_unique<ConcurrentDumpState>();
+
+  // Only unbound MDPs are left in |pending_dump_providers|. In background mode
+  // the MDPs which aren't allowed stay there, to be skipped.
+  std::vector<scoped_refptr<MemoryDumpProviderInfo>>& pending_dump_providers =
+      pmd_async_state->pending_dump_providers;
+  const bool is_background_dump = pmd_async_state->req_args.level_of_detail ==
+                                  MemoryDumpLevelOfDetail::BACKGROUND;
+  auto concurrent_begin = std::stable_partition(
+      pending_dump_providers.begin(), pending_dump_providers.end(),
+      [is_background_dump](
+          const scoped_refptr<MemoryDumpProviderInfo>& mdpinfo) {
+        DCHECK(!mdpinfo->task_runner);
+        return !mdpinfo->options.supports_concurrent_dumps ||
+               (is_background_dump && !mdpinfo->allowed_in_background_mode);
+      });
+  // The MDPs are invoked in the same order as the pending ones.
+  concurrent_dumps->dump_providers.assign(
+      std::make_move_iterator(pending_dump_providers.rbegin()),
+      std::make_move_iterator(std::make_reverse_iterator(concurrent_begin)));
+  pending_dump_providers.erase(concurrent_begin, pending_dump_providers.end());
+
+  const MemoryDumpArgs& args = pmd_async_state->process_memory_dump->dump_args();
+  for (size_t i = 0; i < concurrent_dumps->dump_providers.size(); ++i) {
+    concurrent_dumps->process_memory_dumps.push_back(
+        std::make_unique<ProcessMemoryDump>(args));
+  }
+  if (!concurrent_dumps->dump_providers.empty()) {
+    concurrent_dumps->job_handle = PostJob(
+        FROM_HERE, {TaskPriority::USER_VISIBLE, MayBlock()},
+        BindRepeating(&MemoryDumpManager::RunConcurrentDumps, Unretained(this),
+                      Unretained(concurrent_dumps.get())),
+        BindRepeating(&ConcurrentDumpState::GetMaxConcurrency,
+                      Unretained(concurrent_dumps.get())));
+  }
+  pmd_async_state->concurrent_dumps = std::move(concurrent_dumps);
+}
+
+void MemoryDumpManager::FinishConcurrentDumps(
+    ProcessMemoryDumpAsyncState* pmd_async_state) {
+  DCHECK(pmd_async_state->dump_thread_task_runner->RunsTasksInCurrentSequence());
+  ConcurrentDumpState* concurrent_dumps =
+      pmd_async_state->concurrent_dumps.get();
+  if (concurrent_dumps->job_handle) {
+    // This thread runs the dumps which no worker picked up yet.
+    TRACE_EVENT0(kTraceCategory, "MemoryDumpManager::FinishConcurrentDumps");
+    concurrent_dumps->job_handle.Join();
+  }
+  for (std::unique_ptr<ProcessMemoryDump>& pmd :
+       concurrent_dumps->process_memory_dumps) {
+    pmd_async_state->process_memory_dump->TakeAllDumpsFrom(pmd.get());
+  }
+  // The MDPs unregistered with UnregisterAndDeleteDumpProviderSoon() during
+  // the dump are deleted here, on |dump_thread_|.
+  pmd_async_state->concurrent_dumps.reset();
+}
+
+void MemoryDumpManager::RunConcurrentDumps(
+    ConcurrentDumpState* concurrent_dumps,
+    JobDelegate* delegate) {
+  HEAP_PROFILER_SCOPED_IGNORE;
+  // See ContinueAsyncProcessDump().
+  TraceLog::GetInstance()->InitializeThreadLocalEventBufferIfSupported();
+  while (!delegate->ShouldYield()) {
+    // memory_order_relaxed is sufficient since the index is the only state
+    // handed over; the dumps are synchronized by Join().
+    const size_t index =
+        concurrent_dumps->next_index.fetch_add(1, std::memory_order_relaxed);
+    if (index >= concurrent_dumps->dump_providers.size())
+      return;
+    InvokeOnMemoryDump(concurrent_dumps->dump_providers[index].get(),
+                       concurrent_dumps->process_memory_dumps[index].get());
+  }
+}
+
+// static
+void MemoryDumpManager::RemoveUnchangedAllocatorDumps(
+    MemoryDumpProviderInfo* mdpinfo,
+    uint32_t tracing_session,
+    ProcessMemoryDump* pmd) {
+  if (mdpinfo->last_dump_tracing_session != tracing_session) {
+    mdpinfo->last_dump_hashes.clear();
+    mdpinfo->last_dump_tracing_session = tracing_session;
+  }
+
+  // The dumps with edges are kept, for the edges to stay valid.
+  std::set<MemoryAllocatorDumpGuid> guids_with_edges;
+  for (const auto& it : pmd->allocator_dumps_edges()) {
+    guids_with_edges.insert(it.second.source);
+    guids_with_edges.insert(it.second.target);
+  }
+
+  std::vector<std::string> unchanged_dump_names;
+  for (const auto& it : pmd->allocator_dumps()) {
+    const size_t hash = HashAllocatorDump(*it.second);
+    auto last_hash = mdpinfo->last_dump_hashes.emplace(it.first, hash);
+    if (last_hash.second)
+      continue;
+    if (last_hash.first->second != hash) {
+      last_hash.first->second = hash;
+      continue;
+    }
+    if (!guids_with_edges.count(it.second->guid()))
+      unchanged_dump_names.push_back(it.first);
+  }
+  for (const std::string& name : unchanged_dump_names)
+    pmd->RemoveAllocatorDump(name);
 }
 
 void MemoryDumpManager::FinishAsyncProcessDump(
@@ -499,6 +691,9 @@ void MemoryDumpManager::SetupForTracing(
   // At this point we must have the ability to request global dumps.
   DCHECK(can_request_global_dumps());
 
+  incremental_light_dumps_ = memory_dump_config.incremental_light_dumps;
+  ++tracing_session_;
+
   MemoryDumpScheduler::Config periodic_config;
   for (const auto& trigger : memory_dump_config.triggers) {
     if (trigger.trigger_type == MemoryDumpType::PERIODIC_INTERVAL) {
@@ -525,11 +720,13 @@ void MemoryDumpManager::TeardownForTracing() {
   // state is always accessed by the dumping methods holding the |lock_|.
   AutoLock lock(lock_);
 
+  incremental_light_dumps_ = false;
   MemoryDumpScheduler::GetInstance()->Stop();
 }
 
 MemoryDumpManager::ProcessMemoryDumpAsyncState::ProcessMemoryDumpAsyncState(
     MemoryDumpRequestArgs req_args,
+    bool is_incremental,
     const MemoryDumpProviderInfo::OrderedSet& dump_providers,
     ProcessMemoryDumpCallback callback,
     scoped_refptr<SequencedTaskRunner> dump_thread_task_runner)
@@ -541,6 +738,7 @@ MemoryDumpManager::ProcessMemoryDumpAsyncState::ProcessMemoryDumpAsyncState(
   pending_dump_providers.assign(dump_providers.rbegin(), dump_providers.rend());
   MemoryDumpArgs args = {req_args.level_of_detail, req_args.determinism,
                          req_args.dump_guid};
+  args.is_incremental = is_incremental;
   process_memory_dump = std::make_unique<ProcessMemoryDump>(args);
 }
 
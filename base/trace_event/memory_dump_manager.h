@@ -24,6 +24,7 @@
 
 namespace base {
 
+class JobDelegate;
 class SequencedTaskRunner;
 class SingleThreadTaskRunner;
 class Thread;
@@ -154,6 +155,10 @@ class BASE_EXPORT MemoryDumpManager {
   FRIEND_TEST_ALL_PREFIXES(MemoryDumpManagerTest,
                            NoStackOverflowWithTooManyMDPs);
 
+  // Holds the dump providers of a process memory dump which are dumped in
+  // parallel. Defined in the .cc file.
+  struct ConcurrentDumpState;
+
   // Holds the state of a process memory dump that needs to be carried over
   // across task runners in order to fulfill an asynchronous CreateProcessDump()
   // request. At any time exactly one task runner owns a
@@ -161,6 +166,7 @@ class BASE_EXPORT MemoryDumpManager {
   struct ProcessMemoryDumpAsyncState {
     ProcessMemoryDumpAsyncState(
         MemoryDumpRequestArgs req_args,
+        bool is_incremental,
         const MemoryDumpProviderInfo::OrderedSet& dump_providers,
         ProcessMemoryDumpCallback callback,
         scoped_refptr<SequencedTaskRunner> dump_thread_task_runner);
@@ -194,6 +200,10 @@ class BASE_EXPORT MemoryDumpManager {
     // threads outside of the lock_ to avoid races when disabling tracing.
     // It is immutable for all the duration of a tracing session.
     const scoped_refptr<SequencedTaskRunner> dump_thread_task_runner;
+
+    // The dump providers taken out of |pending_dump_providers| to be dumped in
+    // parallel, or null if there are none.
+    std::unique_ptr<ConcurrentDumpState> concurrent_dumps;
   };
 
   static const int kMaxConsecutiveFailuresCount;
@@ -223,6 +233,25 @@ class BASE_EXPORT MemoryDumpManager {
   void FinishAsyncProcessDump(
       std::unique_ptr<ProcessMemoryDumpAsyncState> pmd_async_state);
 
+  // Takes the unbound dump providers which support concurrent dumps out of
+  // the pending ones and starts dumping them in parallel on the thread pool.
+  // Called on |dump_thread_| before the first unbound dump provider.
+  void StartConcurrentDumps(ProcessMemoryDumpAsyncState* pmd_async_state);
+
+  // Waits for the dumps started by StartConcurrentDumps() and merges them into
+  // the ProcessMemoryDump of |pmd_async_state|. Called on |dump_thread_|.
+  void FinishConcurrentDumps(ProcessMemoryDumpAsyncState* pmd_async_state);
+
+  // The worker task of the job of StartConcurrentDumps().
+  void RunConcurrentDumps(ConcurrentDumpState* concurrent_dumps,
+                          JobDelegate* delegate);
+
+  // Removes from |pmd| the allocator dumps which didn't change since the last
+  // dump of |mdpinfo| in the same tracing session, and remembers the others.
+  static void RemoveUnchangedAllocatorDumps(MemoryDumpProviderInfo* mdpinfo,
+                                            uint32_t tracing_session,
+                                            ProcessMemoryDump* pmd);
+
   // Helper for RegierDumpProvider* functions.
   void RegisterDumpProviderInternal(
       MemoryDumpProvider* mdp,
@@ -248,6 +277,12 @@ class BASE_EXPORT MemoryDumpManager {
   // True when current process coordinates the periodic dump triggering.
   bool is_coordinator_ GUARDED_BY(lock_) = false;
 
+  // Whether the periodic LIGHT dumps of the current tracing session are
+  // incremental, and the number of the session: the incremental dumps are
+  // relative to the previous dumps of the same session.
+  bool incremental_light_dumps_ GUARDED_BY(lock_) = false;
+  uint32_t tracing_session_ GUARDED_BY(lock_) = 0;
+
   // Protects from concurrent accesses to the local state, eg: to guard against
   // disabling logging while dumping on another thread.
   Lock lock_;
@@ -16,6 +16,7 @@
 #include "base/callback.h"
 #include "base/command_line.h"
 #include "base/run_loop.h"
+#include "base/strings/stringprintf.h"
 #include "base/synchronization/waitable_event.h"
 #include "base/task/post_task.h"
 #include "base/task/single_thread_task_runner.h"
@@ -203,9 +204,12 @@ class MemoryDumpManagerTest : public testing::Test {
   // Blocks the current thread (spinning a nested message loop) until the
   // memory dump is complete. Returns:
   // - return value: the |success| from the CreateProcessDump() callback.
-  bool RequestProcessDumpAndWait(MemoryDumpType dump_type,
-                                 MemoryDumpLevelOfDetail level_of_detail,
-                                 MemoryDumpDeterminism determinism) {
+  // - |pmd|, if not null: the ProcessMemoryDump of the callback.
+  bool RequestProcessDumpAndWait(
+      MemoryDumpType dump_type,
+      MemoryDumpLevelOfDetail level_of_detail,
+      MemoryDumpDeterminism determinism,
+      std::unique_ptr<ProcessMemoryDump>* pmd = nullptr) {
     RunLoop run_loop;
     bool success = false;
     static uint64_t test_guid = 1;
@@ -223,15 +227,20 @@ class MemoryDumpManagerTest : public testing::Test {
     // get around the limitation of BindOnce() in supporting only capture-less
     // lambdas.
     ProcessMemoryDumpCallback callback = BindOnce(
-        [](bool* curried_success, OnceClosure curried_quit_closure,
-           uint64_t curried_expected_guid, bool success, uint64_t dump_guid,
+        [](bool* curried_success,
+           std::unique_ptr<ProcessMemoryDump>* curried_pmd,
+           OnceClosure curried_quit_closure, uint64_t curried_expected_guid,
+           bool success, uint64_t dump_guid,
            std::unique_ptr<ProcessMemoryDump> pmd) {
           *curried_success = success;
+          if (curried_pmd)
+            *curried_pmd = std::move(pmd);
           EXPECT_EQ(curried_expected_guid, dump_guid);
           ThreadTaskRunnerHandle::Get()->PostTask(
               FROM_HERE, std::move(curried_quit_closure));
         },
-        Unretained(&success), run_loop.QuitClosure(), test_guid);
+        Unretained(&success), Unretained(pmd), run_loop.QuitClosure(),
+        test_guid);
 
     mdm_->CreateProcessDump(request_args, std::move(callback));
     run_loop.Run();
@@ -835,6 +844,152 @@ TEST_F(MemoryDumpManagerTest, UnregisterAndDeleteDumpProviderSoonDuringDump) {
   DisableTracing();
 }
 
+// Checks that the unbound dump providers which support concurrent dumps are
+// dumped along with the other ones, and that their dumps are merged.
+TEST_F(MemoryDumpManagerTest, ConcurrentDumps) {
+  static const int kNumProviders = 4;
+  const MemoryAllocatorDumpGuid shared_mad_guid(1);
+  MemoryDumpProvider::Options options;
+  options.supports_concurrent_dumps = true;
+  MockMemoryDumpProvider mdps[kNumProviders];
+  for (int i = 0; i < kNumProviders; ++i) {
+    RegisterDumpProvider(&mdps[i], nullptr, options);
+    EXPECT_CALL(mdps[i], OnMemoryDump(_, _))
+        .WillOnce(Invoke([i, &shared_mad_guid](const MemoryDumpArgs&,
+                                               ProcessMemoryDump* pmd) {
+          pmd->CreateAllocatorDump(StringPrintf("mdp%d", i));
+          pmd->CreateSharedGlobalAllocatorDump(shared_mad_guid);
+          return true;
+        }));
+  }
+
+  // The dump providers which don't support concurrent dumps still run on the
+  // dump thread.
+  MockMemoryDumpProvider unbound_mdp;
+  RegisterDumpProvider(&unbound_mdp, nullptr, kDefaultOptions);
+  scoped_refptr<SequencedTaskRunner> dump_thread_task_runner =
+      mdm_->GetDumpThreadTaskRunner();
+  EXPECT_CALL(unbound_mdp, OnMemoryDump(_, _))
+      .WillOnce(Invoke([&dump_thread_task_runner, &shared_mad_guid](
+                           const MemoryDumpArgs&, ProcessMemoryDump* pmd) {
+        EXPECT_TRUE(dump_thread_task_runner->RunsTasksInCurrentSequence());
+        pmd->CreateAllocatorDump("unbound_mdp");
+        pmd->CreateWeakSharedGlobalAllocatorDump(shared_mad_guid);
+        return true;
+      }));
+
+  EnableForTracing();
+  std::unique_ptr<ProcessMemoryDump> pmd;
+  EXPECT_TRUE(RequestProcessDumpAndWait(MemoryDumpType::EXPLICITLY_TRIGGERED,
+                                        MemoryDumpLevelOfDetail::DETAILED,
+                                        MemoryDumpDeterminism::NONE, &pmd));
+  DisableTracing();
+
+  ASSERT_TRUE(pmd);
+  EXPECT_EQ(static_cast<size_t>(kNumProviders + 2),
+            pmd->allocator_dumps().size());
+  for (int i = 0; i < kNumProviders; ++i)
+    EXPECT_TRUE(pmd->GetAllocatorDump(StringPrintf("mdp%d", i)));
+  EXPECT_TRUE(pmd->GetAllocatorDump("unbound_mdp"));
+  MemoryAllocatorDump* shared_mad =
+      pmd->GetSharedGlobalAllocatorDump(shared_mad_guid);
+  ASSERT_TRUE(shared_mad);
+  EXPECT_FALSE(shared_mad->flags() & MemoryAllocatorDump::Flags::WEAK);
+}
+
+// Checks that the dump providers with a time budget get a deadline.
+TEST_F(MemoryDumpManagerTest, TimeBudget) {
+  MemoryDumpProvider::Options options;
+  options.time_budget = Seconds(10);
+  MockMemoryDumpProvider mdp_with_budget;
+  MockMemoryDumpProvider mdp;
+  RegisterDumpProvider(&mdp_with_budget, ThreadTaskRunnerHandle::Get(),
+                       options);
+  RegisterDumpProvider(&mdp, ThreadTaskRunnerHandle::Get());
+
+  const TimeTicks start = TimeTicks::Now();
+  EXPECT_CALL(mdp_with_budget, OnMemoryDump(_, _))
+      .WillOnce(Invoke([start](const MemoryDumpArgs& args,
+                               ProcessMemoryDump* pmd) {
+        EXPECT_GE(args.deadline, start + Seconds(10));
+        EXPECT_LE(args.deadline, TimeTicks::Now() + Seconds(10));
+        return true;
+      }));
+  EXPECT_CALL(mdp, OnMemoryDump(_, _))
+      .WillOnce(Invoke([](const MemoryDumpArgs& args, ProcessMemoryDump* pmd) {
+        EXPECT_TRUE(args.deadline.is_null());
+        return true;
+      }));
+
+  EnableForTracing();
+  EXPECT_TRUE(RequestProcessDumpAndWait(MemoryDumpType::EXPLICITLY_TRIGGERED,
+                                        MemoryDumpLevelOfDetail::DETAILED,
+                                        MemoryDumpDeterminism::NONE));
+  DisableTracing();
+
+  mdm_->UnregisterDumpProvider(&mdp_with_budget);
+  mdm_->UnregisterDumpProvider(&mdp);
+}
+
+// Checks that the periodic light dumps of a trace with incremental dumps only
+// contain the allocator dumps which changed.
+TEST_F(MemoryDumpManagerTest, IncrementalLightDumps) {
+  MockMemoryDumpProvider mdp;
+  RegisterDumpProvider(&mdp, ThreadTaskRunnerHandle::Get());
+  uint64_t changing_size = 1;
+  ON_CALL(mdp, OnMemoryDump(_, _))
+      .WillByDefault(Invoke([&changing_size](const MemoryDumpArgs& args,
+                                             ProcessMemoryDump* pmd) {
+        pmd->CreateAllocatorDump("mdp/changing")
+            ->AddScalar(MemoryAllocatorDump::kNameSize,
+                        MemoryAllocatorDump::kUnitsBytes, changing_size);
+        pmd->CreateAllocatorDump("mdp/unchanged")
+            ->AddScalar(MemoryAllocatorDump::kNameSize,
+                        MemoryAllocatorDump::kUnitsBytes, 1);
+        return true;
+      }));
+  EXPECT_CALL(mdp, OnMemoryDump(_, _)).Times(4);
+
+  TraceConfig::MemoryDumpConfig memory_dump_config;
+  memory_dump_config.incremental_light_dumps = true;
+  mdm_->SetupForTracing(memory_dump_config);
+
+  // The first dump is complete.
+  std::unique_ptr<ProcessMemoryDump> pmd;
+  EXPECT_TRUE(RequestProcessDumpAndWait(MemoryDumpType::PERIODIC_INTERVAL,
+                                        MemoryDumpLevelOfDetail::LIGHT,
+                                        MemoryDumpDeterminism::NONE, &pmd));
+  ASSERT_TRUE(pmd);
+  EXPECT_TRUE(pmd->dump_args().is_incremental);
+  EXPECT_EQ(2u, pmd->allocator_dumps().size());
+
+  // The next one only has the dump which changed.
+  changing_size = 2;
+  EXPECT_TRUE(RequestProcessDumpAndWait(MemoryDumpType::PERIODIC_INTERVAL,
+                                        MemoryDumpLevelOfDetail::LIGHT,
+                                        MemoryDumpDeterminism::NONE, &pmd));
+  ASSERT_TRUE(pmd);
+  EXPECT_EQ(1u, pmd->allocator_dumps().size());
+  EXPECT_TRUE(pmd->GetAllocatorDump("mdp/changing"));
+
+  // The explicitly triggered dumps are complete, and so is the next
+  // incremental one.
+  EXPECT_TRUE(RequestProcessDumpAndWait(MemoryDumpType::EXPLICITLY_TRIGGERED,
+                                        MemoryDumpLevelOfDetail::LIGHT,
+                                        MemoryDumpDeterminism::NONE, &pmd));
+  ASSERT_TRUE(pmd);
+  EXPECT_FALSE(pmd->dump_args().is_incremental);
+  EXPECT_EQ(2u, pmd->allocator_dumps().size());
+  EXPECT_TRUE(RequestProcessDumpAndWait(MemoryDumpType::PERIODIC_INTERVAL,
+                                        MemoryDumpLevelOfDetail::LIGHT,
+                                        MemoryDumpDeterminism::NONE, &pmd));
+  ASSERT_TRUE(pmd);
+  EXPECT_EQ(2u, pmd->allocator_dumps().size());
+  DisableTracing();
+
+  mdm_->UnregisterDumpProvider(&mdp);
+}
+
 // Mock MDP class that tests if the number of OnMemoryDump() calls are expected.
 // It is implemented without gmocks since EXPECT_CALL implementation is slow
 // when there are 1000s of instances, as required in
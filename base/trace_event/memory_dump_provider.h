@@ -7,6 +7,7 @@
 
 #include "base/base_export.h"
 #include "base/process/process_handle.h"
+#include "base/time/time.h"
 #include "base/trace_event/memory_dump_request_args.h"
 
 namespace base {
@@ -19,12 +20,24 @@ class BASE_EXPORT MemoryDumpProvider {
  public:
   // Optional arguments for MemoryDumpManager::RegisterDumpProvider().
   struct Options {
-    Options() : dumps_on_single_thread_task_runner(false) {}
+    Options()
+        : dumps_on_single_thread_task_runner(false),
+          supports_concurrent_dumps(false) {}
 
     // |dumps_on_single_thread_task_runner| is true if the dump provider runs on
     // a SingleThreadTaskRunner, which is usually the case. It is faster to run
     // all providers that run on the same thread together without thread hops.
     bool dumps_on_single_thread_task_runner;
+
+    // |supports_concurrent_dumps| is true if OnMemoryDump() can run on any
+    // thread at the same time as the other dump providers. The providers
+    // registered without a task runner which set it are dumped in parallel on
+    // the thread pool, each into its own ProcessMemoryDump.
+    bool supports_concurrent_dumps;
+
+    // |time_budget| is how long OnMemoryDump() should take, or zero if it is
+    // unlimited. See MemoryDumpArgs::deadline.
+    TimeDelta time_budget;
   };
 
   MemoryDumpProvider(const MemoryDumpProvider&) = delete;
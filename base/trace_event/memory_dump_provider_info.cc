@@ -23,7 +23,8 @@ MemoryDumpProviderInfo::MemoryDumpProviderInfo(
       task_runner(std::move(task_runner)),
       allowed_in_background_mode(allowed_in_background_mode),
       consecutive_failures(0),
-      disabled(false) {}
+      disabled(false),
+      last_dump_tracing_session(0) {}
 
 MemoryDumpProviderInfo::~MemoryDumpProviderInfo() = default;
 
@@ -5,8 +5,13 @@
 #ifndef BASE_TRACE_EVENT_MEMORY_DUMP_PROVIDER_INFO_H_
 #define BASE_TRACE_EVENT_MEMORY_DUMP_PROVIDER_INFO_H_
 
+#include <stddef.h>
+#include <stdint.h>
+
+#include <map>
 #include <memory>
 #include <set>
+#include <string>
 
 #include "base/base_export.h"
 #include "base/memory/raw_ptr.h"
@@ -99,6 +104,11 @@ struct BASE_EXPORT MemoryDumpProviderInfo
   // Flagged either by the auto-disable logic or during unregistration.
   bool disabled;
 
+  // For incremental dumps: a hash of each allocator dump of the last dump of
+  // the MDP, and the MDM tracing session that dump belongs to.
+  std::map<std::string, size_t> last_dump_hashes;
+  uint32_t last_dump_tracing_session;
+
  private:
   friend class base::RefCountedThreadSafe<MemoryDumpProviderInfo>;
   ~MemoryDumpProviderInfo();
@@ -16,6 +16,7 @@
 #include "base/base_export.h"
 #include "base/callback.h"
 #include "base/process/process_handle.h"
+#include "base/time/time.h"
 
 namespace base {
 namespace trace_event {
@@ -88,6 +89,18 @@ struct MemoryDumpArgs {
   // local dump with the same guid. This allows the trace importers to
   // reconstruct the global dump.
   uint64_t dump_guid;
+
+  // The time by which OnMemoryDump() should return, or null if the provider
+  // has no MemoryDumpProvider::Options::time_budget. A provider which reaches
+  // it should stop and return true: the dumps it created so far are kept.
+  TimeTicks deadline;
+
+  // True for the periodic LIGHT dumps of a trace with incremental dumps, see
+  // TraceConfig::MemoryDumpConfig::incremental_light_dumps. The allocator
+  // dumps which didn't change since the previous dump of their provider are
+  // left out of the ProcessMemoryDump, and the trace importer carries their
+  // previous values over. Providers can also skip creating them.
+  bool is_incremental = false;
 };
 
 using ProcessMemoryDumpCallback = OnceCallback<
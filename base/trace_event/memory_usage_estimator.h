@@ -23,6 +23,8 @@
 
 #include "base/base_export.h"
 #include "base/containers/circular_deque.h"
+#include "base/containers/flat_hash_map.h"
+#include "base/containers/flat_hash_set.h"
 #include "base/containers/flat_map.h"
 #include "base/containers/flat_set.h"
 #include "base/containers/linked_list.h"
@@ -178,6 +180,12 @@ size_t EstimateMemoryUsage(const base::flat_set<T, C>& set);
 template <class K, class V, class C>
 size_t EstimateMemoryUsage(const base::flat_map<K, V, C>& map);
 
+template <class K, class H, class KE, class A>
+size_t EstimateMemoryUsage(const base::flat_hash_set<K, H, KE, A>& set);
+
+template <class K, class V, class H, class KE, class A>
+size_t EstimateMemoryUsage(const base::flat_hash_map<K, V, H, KE, A>& map);
+
 template <class Key,
           class Payload,
           class HashOrComp,
@@ -652,6 +660,22 @@ size_t EstimateMemoryUsage(const base::flat_map<K, V, C>& map) {
   return sizeof(value_type) * map.capacity() + EstimateIterableMemoryUsage(map);
 }
 
+// The open-addressing tables have a control byte per slot.
+
+template <class K, class H, class KE, class A>
+size_t EstimateMemoryUsage(const base::flat_hash_set<K, H, KE, A>& set) {
+  using value_type = typename base::flat_hash_set<K, H, KE, A>::value_type;
+  return (sizeof(value_type) + 1) * set.capacity() +
+         EstimateIterableMemoryUsage(set);
+}
+
+template <class K, class V, class H, class KE, class A>
+size_t EstimateMemoryUsage(const base::flat_hash_map<K, V, H, KE, A>& map) {
+  using value_type = typename base::flat_hash_map<K, V, H, KE, A>::value_type;
+  return (sizeof(value_type) + 1) * map.capacity() +
+         EstimateIterableMemoryUsage(map);
+}
+
 template <class Key,
           class Payload,
           class HashOrComp,
@@ -6,6 +6,7 @@
 
 #include <errno.h>
 
+#include <algorithm>
 #include <memory>
 #include <vector>
 
@@ -54,6 +55,10 @@ std::string GetSharedGlobalAllocatorDumpName(
   return "global/" + guid.ToString();
 }
 
+bool IsSharedGlobalAllocatorDumpName(const std::string& absolute_name) {
+  return StartsWith(absolute_name, "global/");
+}
+
 #if defined(COUNT_RESIDENT_BYTES_SUPPORTED)
 size_t GetSystemPageCount(size_t mapped_size, size_t page_size) {
   return (mapped_size + page_size - 1) / page_size;
@@ -367,8 +372,32 @@ void ProcessMemoryDump::Clear() {
 void ProcessMemoryDump::TakeAllDumpsFrom(ProcessMemoryDump* other) {
   // Moves the ownership of all MemoryAllocatorDump(s) contained in |other|
   // into this ProcessMemoryDump, checking for duplicates.
-  for (auto& it : other->allocator_dumps_)
-    AddAllocatorDumpInternal(std::move(it.second));
+  for (auto& it : other->allocator_dumps_) {
+    MemoryAllocatorDump* mad = GetAllocatorDump(it.first);
+    if (!mad || !IsSharedGlobalAllocatorDumpName(it.first)) {
+      AddAllocatorDumpInternal(std::move(it.second));
+      continue;
+    }
+    // Like CreateSharedGlobalAllocatorDump(), the merged dump is only weak if
+    // both are.
+    const MemoryAllocatorDump& other_mad = *it.second;
+    if (!(other_mad.flags() & MemoryAllocatorDump::Flags::WEAK))
+      mad->clear_flags(MemoryAllocatorDump::Flags::WEAK);
+    for (const MemoryAllocatorDump::Entry& entry : other_mad.entries()) {
+      const bool has_entry =
+          std::any_of(mad->entries().begin(), mad->entries().end(),
+                      [&entry](const MemoryAllocatorDump::Entry& mad_entry) {
+                        return mad_entry.name == entry.name;
+                      });
+      if (has_entry)
+        continue;
+      if (entry.entry_type == MemoryAllocatorDump::Entry::kUint64) {
+        mad->AddScalar(entry.name, entry.units, entry.value_uint64);
+      } else {
+        mad->AddString(entry.name, entry.units, entry.value_string);
+      }
+    }
+  }
   other->allocator_dumps_.clear();
 
   // Move all the edges.
@@ -377,6 +406,10 @@ void ProcessMemoryDump::TakeAllDumpsFrom(ProcessMemoryDump* other) {
   other->allocator_dumps_edges_.clear();
 }
 
+void ProcessMemoryDump::RemoveAllocatorDump(const std::string& absolute_name) {
+  allocator_dumps_.erase(absolute_name);
+}
+
 void ProcessMemoryDump::SerializeAllocatorDumpsInto(TracedValue* value) const {
   if (allocator_dumps_.size() > 0) {
     value->BeginDictionary("allocators");
@@ -228,13 +228,19 @@ class BASE_EXPORT ProcessMemoryDump {
   void Clear();
 
   // Merges all MemoryAllocatorDump(s) contained in |other| inside this
-  // ProcessMemoryDump, transferring their ownership to this instance.
+  // ProcessMemoryDump, transferring their ownership to this instance. The
+  // shared global dumps which both contain are merged as if they had been
+  // created in this ProcessMemoryDump.
   // |other| will be an empty ProcessMemoryDump after this method returns.
   // This is to allow dump providers to pre-populate ProcessMemoryDump instances
   // and later move their contents into the ProcessMemoryDump passed as argument
   // of the MemoryDumpProvider::OnMemoryDump(ProcessMemoryDump*) callback.
   void TakeAllDumpsFrom(ProcessMemoryDump* other);
 
+  // Removes the MemoryAllocatorDump called |absolute_name|, if any. The edges
+  // going from or to it are left, to be removed by the caller if needed.
+  void RemoveAllocatorDump(const std::string& absolute_name);
+
   // Populate the traced value with information about the memory allocator
   // dumps.
   void SerializeAllocatorDumpsInto(TracedValue* value) const;
@@ -215,6 +215,39 @@ TEST(ProcessMemoryDumpTest, TakeAllDumpsFrom) {
   pmd1.reset();
 }
 
+TEST(ProcessMemoryDumpTest, TakeAllDumpsFromMergesSharedGlobalDumps) {
+  MemoryAllocatorDumpGuid shared_mad_guid(1);
+  ProcessMemoryDump pmd1(kDetailedDumpArgs);
+  auto* shared_mad = pmd1.CreateWeakSharedGlobalAllocatorDump(shared_mad_guid);
+  shared_mad->AddScalar(MemoryAllocatorDump::kNameSize,
+                        MemoryAllocatorDump::kUnitsBytes, 1024);
+
+  ProcessMemoryDump pmd2(kDetailedDumpArgs);
+  auto* other_shared_mad =
+      pmd2.CreateSharedGlobalAllocatorDump(shared_mad_guid);
+  other_shared_mad->AddScalar(MemoryAllocatorDump::kNameSize,
+                              MemoryAllocatorDump::kUnitsBytes, 2048);
+  other_shared_mad->AddScalar(MemoryAllocatorDump::kNameObjectCount,
+                              MemoryAllocatorDump::kUnitsObjects, 4);
+  pmd2.CreateAllocatorDump("pmd2/mad");
+
+  // The merged dump keeps its entries, gets the missing ones and isn't weak
+  // anymore.
+  pmd1.TakeAllDumpsFrom(&pmd2);
+  ASSERT_EQ(2u, pmd1.allocator_dumps().size());
+  ASSERT_EQ(shared_mad, pmd1.GetSharedGlobalAllocatorDump(shared_mad_guid));
+  EXPECT_FALSE(MemoryAllocatorDump::Flags::WEAK & shared_mad->flags());
+  EXPECT_EQ(1024u, shared_mad->GetSizeInternal());
+  ASSERT_EQ(2u, shared_mad->entries().size());
+  EXPECT_EQ(MemoryAllocatorDump::kNameObjectCount,
+            shared_mad->entries()[1].name);
+  EXPECT_EQ(4u, shared_mad->entries()[1].value_uint64);
+
+  pmd1.RemoveAllocatorDump("pmd2/mad");
+  EXPECT_EQ(nullptr, pmd1.GetAllocatorDump("pmd2/mad"));
+  EXPECT_EQ(1u, pmd1.allocator_dumps().size());
+}
+
 TEST(ProcessMemoryDumpTest, OverrideOwnershipEdge) {
   std::unique_ptr<ProcessMemoryDump> pmd(
       new ProcessMemoryDump(kDetailedDumpArgs));
@@ -15,9 +15,9 @@
 #include "base/check_op.h"
 #include "base/json/string_escape.h"
 #include "base/notreached.h"
+#include "base/strings/string_format.h"
 #include "base/strings/string_number_conversions.h"
 #include "base/strings/string_util.h"
-#include "base/strings/stringprintf.h"
 #include "base/strings/utf_string_conversions.h"
 
 namespace base {
@@ -74,7 +74,7 @@ void AppendDouble(double val, bool as_json, std::string* out) {
   } else {
     real = as_json ? "\"Infinity\"" : "Infinity";
   }
-  StringAppendF(out, "%s", real.c_str());
+  *out += real;
 }
 
 const char* TypeToString(char arg_type) {
@@ -155,10 +155,10 @@ void TraceValue::Append(unsigned char type,
       *out += this->as_bool ? "true" : "false";
       break;
     case TRACE_VALUE_TYPE_UINT:
-      StringAppendF(out, "%" PRIu64, static_cast<uint64_t>(this->as_uint));
+      StrAppendFormat(out, "%" PRIu64, this->as_uint);
       break;
     case TRACE_VALUE_TYPE_INT:
-      StringAppendF(out, "%" PRId64, static_cast<int64_t>(this->as_int));
+      StrAppendFormat(out, "%" PRId64, this->as_int);
       break;
     case TRACE_VALUE_TYPE_DOUBLE:
       AppendDouble(this->as_double, as_json, out);
@@ -169,9 +169,8 @@ void TraceValue::Append(unsigned char type,
       // For consistency, do the same for non-JSON strings, but without the
       // surrounding quotes.
       const char* format_string = as_json ? "\"0x%" PRIx64 "\"" : "0x%" PRIx64;
-      StringAppendF(
-          out, format_string,
-          static_cast<uint64_t>(reinterpret_cast<uintptr_t>(this->as_pointer)));
+      StrAppendFormat(out, format_string,
+                      reinterpret_cast<uintptr_t>(this->as_pointer));
     } break;
     case TRACE_VALUE_TYPE_STRING:
     case TRACE_VALUE_TYPE_COPY_STRING:
@@ -0,0 +1,569 @@
+// Copyright 2022 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "base/trace_event/trace_binary_format.h"
+
+#include <string.h>
+
+#include <vector>
+
+#include "base/bit_cast.h"
+#include "base/check_op.h"
+#include "base/format_macros.h"
+#include "base/json/string_escape.h"
+#include "base/logging.h"
+#include "base/process/process_handle.h"
+#include "base/strings/string_format.h"
+#include "base/trace_event/trace_event.h"
+#include "base/trace_event/trace_log.h"
+
+namespace base {
+namespace trace_event {
+
+namespace {
+
+constexpr size_t kMagicSize = sizeof(TraceBinaryWriter::kMagic) - 1;
+
+constexpr unsigned int kIdFlags = TRACE_EVENT_FLAG_HAS_ID |
+                                  TRACE_EVENT_FLAG_HAS_LOCAL_ID |
+                                  TRACE_EVENT_FLAG_HAS_GLOBAL_ID;
+
+uint64_t ZigZagEncode(int64_t value) {
+  return (static_cast<uint64_t>(value) << 1) ^
+         static_cast<uint64_t>(value >> 63);
+}
+
+int64_t ZigZagDecode(uint64_t value) {
+  return static_cast<int64_t>(value >> 1) ^ -static_cast<int64_t>(value & 1);
+}
+
+// Reads the records of a binary trace. Each read fails once |data_| is
+// exhausted or malformed, and the caller checks ok() when it's done.
+class BinaryTraceReader {
+ public:
+  explicit BinaryTraceReader(span<const uint8_t> data) : data_(data) {}
+
+  bool ok() const { return ok_; }
+  bool AtEnd() const { return position_ == data_.size(); }
+
+  uint8_t ReadByte() {
+    if (!ok_ || position_ == data_.size()) {
+      ok_ = false;
+      return 0;
+    }
+    return data_[position_++];
+  }
+
+  uint64_t ReadVarint() {
+    uint64_t value = 0;
+    for (int shift = 0; shift < 64; shift += 7) {
+      uint8_t byte = ReadByte();
+      value |= static_cast<uint64_t>(byte & 0x7f) << shift;
+      if (!(byte & 0x80))
+        return value;
+    }
+    ok_ = false;
+    return 0;
+  }
+
+  int64_t ReadSignedVarint() { return ZigZagDecode(ReadVarint()); }
+
+  bool ReadBytes(size_t length, std::string* out) {
+    if (!ok_ || length > data_.size() - position_) {
+      ok_ = false;
+      return false;
+    }
+    out->assign(reinterpret_cast<const char*>(data_.data() + position_),
+                length);
+    position_ += length;
+    return true;
+  }
+
+  // Returns the string read as an id, null for id 0.
+  const char* ReadString() {
+    uint64_t id = ReadVarint();
+    if (!ok_ || id > strings_.size()) {
+      ok_ = false;
+      return nullptr;
+    }
+    return id ? strings_[id - 1].c_str() : nullptr;
+  }
+
+  bool ReadStringRecord() {
+    std::string string;
+    if (!ReadBytes(ReadVarint(), &string))
+      return false;
+    strings_.push_back(std::move(string));
+    return true;
+  }
+
+ private:
+  const span<const uint8_t> data_;
+  size_t position_ = 0;
+  bool ok_ = true;
+  // The pointers to them are only used until the next string record.
+  std::vector<std::string> strings_;
+};
+
+// Appends the JSON of the next event of |reader|, as TraceEvent::AppendAsJSON()
+// does.
+bool AppendEventAsJSON(BinaryTraceReader* reader,
+                       int default_process_id,
+                       int64_t* timestamp,
+                       int64_t* thread_timestamp,
+                       std::string* out) {
+  const char phase = static_cast<char>(reader->ReadByte());
+  const uint64_t flags = reader->ReadVarint();
+  const uint64_t fields = reader->ReadVarint();
+  const int thread_id = static_cast<int>(reader->ReadSignedVarint());
+  const int process_id =
+      (fields & TraceBinaryWriter::kHasProcessId)
+          ? static_cast<int>(reader->ReadSignedVarint())
+          : default_process_id;
+  *timestamp += reader->ReadSignedVarint();
+  const char* category_group_name = reader->ReadString();
+  const char* name = reader->ReadString();
+  if (!reader->ok() || !category_group_name || !name)
+    return false;
+
+  static constexpr ParsedFormat kEventFormat(
+      "{\"pid\":%i,\"tid\":%i,\"ts\":%" PRId64
+      ",\"ph\":\"%c\",\"cat\":\"%s\",\"name\":");
+  StrAppendFormat(out, kEventFormat, process_id, thread_id, *timestamp, phase,
+                  category_group_name);
+  EscapeJSONString(name, true, out);
+  *out += ",\"args\":";
+
+  const uint64_t arg_count = reader->ReadVarint();
+  if (arg_count == TraceBinaryWriter::kStrippedArguments) {
+    *out += "\"__stripped__\"";
+  } else {
+    if (arg_count > static_cast<uint64_t>(kTraceMaxNumArgs))
+      return false;
+    *out += "{";
+    for (uint64_t i = 0; i < arg_count; ++i) {
+      const char* arg_name = reader->ReadString();
+      if (!reader->ok() || !arg_name)
+        return false;
+      if (i > 0)
+        *out += ",";
+      *out += "\"";
+      *out += arg_name;
+      *out += "\":";
+
+      const unsigned char type = reader->ReadByte();
+      TraceValue value;
+      std::string string;
+      switch (type) {
+        case TraceBinaryWriter::kStrippedValue:
+          *out += "\"__stripped__\"";
+          continue;
+        case TRACE_VALUE_TYPE_BOOL:
+          value.as_bool = !!reader->ReadByte();
+          break;
+        case TRACE_VALUE_TYPE_UINT:
+          value.as_uint = reader->ReadVarint();
+          break;
+        case TRACE_VALUE_TYPE_INT:
+          value.as_int = reader->ReadSignedVarint();
+          break;
+        case TRACE_VALUE_TYPE_DOUBLE: {
+          uint64_t bits = 0;
+          for (int shift = 0; shift < 64; shift += 8)
+            bits |= static_cast<uint64_t>(reader->ReadByte()) << shift;
+          value.as_double = bit_cast<double>(bits);
+          break;
+        }
+        case TRACE_VALUE_TYPE_POINTER:
+          value.as_pointer =
+              reinterpret_cast<const void*>(reader->ReadVarint());
+          break;
+        case TRACE_VALUE_TYPE_STRING:
+          value.as_string = reader->ReadString();
+          break;
+        case TRACE_VALUE_TYPE_COPY_STRING:
+          reader->ReadBytes(reader->ReadVarint(), &string);
+          value.as_string = string.c_str();
+          break;
+        case TRACE_VALUE_TYPE_CONVERTABLE:
+          if (!reader->ReadBytes(reader->ReadVarint(), &string))
+            return false;
+          *out += string;
+          continue;
+        default:
+          return false;
+      }
+      if (!reader->ok())
+        return false;
+      value.AppendAsJSON(type, out);
+    }
+    *out += "}";
+  }
+
+  if (fields & TraceBinaryWriter::kHasDuration)
+    StrAppendFormat(out, ",\"dur\":%" PRId64, reader->ReadSignedVarint());
+  if (fields & TraceBinaryWriter::kHasThreadTimestamp)
+    *thread_timestamp += reader->ReadSignedVarint();
+  if (fields & TraceBinaryWriter::kHasThreadDuration)
+    StrAppendFormat(out, ",\"tdur\":%" PRId64, reader->ReadSignedVarint());
+  if (fields & TraceBinaryWriter::kHasThreadInstructionDelta)
+    StrAppendFormat(out, ",\"tidelta\":%" PRId64, reader->ReadSignedVarint());
+  if (fields & TraceBinaryWriter::kHasThreadTimestamp)
+    StrAppendFormat(out, ",\"tts\":%" PRId64, *thread_timestamp);
+  if (fields & TraceBinaryWriter::kHasThreadInstructionCount)
+    StrAppendFormat(out, ",\"ticount\":%" PRId64, reader->ReadSignedVarint());
+
+  if (flags & TRACE_EVENT_FLAG_ASYNC_TTS)
+    *out += ", \"use_async_tts\":1";
+
+  if (fields & TraceBinaryWriter::kHasScope) {
+    const char* scope = reader->ReadString();
+    if (!scope)
+      return false;
+    StrAppendFormat(out, ",\"scope\":\"%s\"", scope);
+  }
+  if (fields & TraceBinaryWriter::kHasId) {
+    const uint64_t id = reader->ReadVarint();
+    switch (flags & kIdFlags) {
+      case TRACE_EVENT_FLAG_HAS_ID:
+        StrAppendFormat(out, ",\"id\":\"0x%" PRIx64 "\"", id);
+        break;
+      case TRACE_EVENT_FLAG_HAS_LOCAL_ID:
+        StrAppendFormat(out, ",\"id2\":{\"local\":\"0x%" PRIx64 "\"}", id);
+        break;
+      case TRACE_EVENT_FLAG_HAS_GLOBAL_ID:
+        StrAppendFormat(out, ",\"id2\":{\"global\":\"0x%" PRIx64 "\"}", id);
+        break;
+      default:
+        return false;
+    }
+  }
+
+  if (flags & TRACE_EVENT_FLAG_BIND_TO_ENCLOSING)
+    *out += ",\"bp\":\"e\"";
+
+  if (fields & TraceBinaryWriter::kHasBindId) {
+    StrAppendFormat(out, ",\"bind_id\":\"0x%" PRIx64 "\"",
+                    reader->ReadVarint());
+  }
+  if (flags & TRACE_EVENT_FLAG_FLOW_IN)
+    *out += ",\"flow_in\":true";
+  if (flags & TRACE_EVENT_FLAG_FLOW_OUT)
+    *out += ",\"flow_out\":true";
+
+  if (phase == TRACE_EVENT_PHASE_INSTANT) {
+    char scope = '?';
+    switch (flags & TRACE_EVENT_FLAG_SCOPE_MASK) {
+      case TRACE_EVENT_SCOPE_GLOBAL:
+        scope = TRACE_EVENT_SCOPE_NAME_GLOBAL;
+        break;
+
+      case TRACE_EVENT_SCOPE_PROCESS:
+        scope = TRACE_EVENT_SCOPE_NAME_PROCESS;
+        break;
+
+      case TRACE_EVENT_SCOPE_THREAD:
+        scope = TRACE_EVENT_SCOPE_NAME_THREAD;
+        break;
+    }
+    StrAppendFormat(out, ",\"s\":\"%c\"", scope);
+  }
+
+  *out += "}";
+  return reader->ok();
+}
+
+}  // namespace
+
+TraceBinaryWriter::TraceBinaryWriter(File file, int process_id)
+    : file_(std::move(file)), process_id_(process_id) {
+  DCHECK(file_.IsValid());
+  buffer_.reserve(kBufferSize + kBufferSize / 8);
+  AppendBytes(kMagic, kMagicSize);
+  AppendVarint(kVersion);
+  AppendSignedVarint(process_id_);
+}
+
+TraceBinaryWriter::~TraceBinaryWriter() {
+  Finish();
+}
+
+void TraceBinaryWriter::AppendEvent(
+    const TraceEvent& event,
+    const ArgumentFilterPredicate& argument_filter_predicate) {
+  int process_id = process_id_;
+  int thread_id = event.thread_id();
+  uint64_t fields = 0;
+  if ((event.flags() & TRACE_EVENT_FLAG_HAS_PROCESS_ID) &&
+      event.process_id() != kNullProcessId) {
+    process_id = event.process_id();
+    thread_id = -1;
+    fields |= kHasProcessId;
+  }
+  const char* category_group_name =
+      TraceLog::GetCategoryGroupName(event.category_group_enabled());
+
+  // The names and scope are copied in the event with TRACE_EVENT_FLAG_COPY,
+  // and static otherwise. The strings are defined before the event record.
+  const bool copied = !!(event.flags() & TRACE_EVENT_FLAG_COPY);
+  auto intern = [this, copied](const char* string) {
+    return copied ? InternCopiedString(string) : InternStaticString(string);
+  };
+  const uint32_t category_id = InternStaticString(category_group_name);
+  const uint32_t name_id = intern(event.name());
+
+  ArgumentNameFilterPredicate argument_name_filter_predicate;
+  const bool strip_args =
+      event.arg_size() > 0 && event.arg_name(0) &&
+      !argument_filter_predicate.is_null() &&
+      !argument_filter_predicate.Run(category_group_name, event.name(),
+                                     &argument_name_filter_predicate);
+  size_t arg_count = 0;
+  uint32_t arg_name_ids[kTraceMaxNumArgs];
+  uint32_t arg_string_ids[kTraceMaxNumArgs] = {};
+  bool arg_stripped[kTraceMaxNumArgs] = {};
+  if (!strip_args) {
+    for (; arg_count < event.arg_size() && event.arg_name(arg_count);
+         ++arg_count) {
+      const char* arg_name = event.arg_name(arg_count);
+      arg_name_ids[arg_count] = intern(arg_name);
+      arg_stripped[arg_count] = !argument_name_filter_predicate.is_null() &&
+                                !argument_name_filter_predicate.Run(arg_name);
+      if (!arg_stripped[arg_count] &&
+          event.arg_type(arg_count) == TRACE_VALUE_TYPE_STRING) {
+        arg_string_ids[arg_count] =
+            InternStaticString(event.arg_value(arg_count).as_string);
+      }
+    }
+  }
+
+  const unsigned int id_flags = event.flags() & kIdFlags;
+  uint32_t scope_id = 0;
+  if (id_flags) {
+    fields |= kHasId;
+    if (event.scope() != trace_event_internal::kGlobalScope) {
+      fields |= kHasScope;
+      scope_id = intern(event.scope());
+    }
+  }
+  if (event.flags() & (TRACE_EVENT_FLAG_FLOW_OUT | TRACE_EVENT_FLAG_FLOW_IN))
+    fields |= kHasBindId;
+  const bool has_thread_timestamp = !event.thread_timestamp().is_null();
+  const bool has_thread_instruction_count =
+      !event.thread_instruction_count().is_null();
+  if (has_thread_timestamp)
+    fields |= kHasThreadTimestamp;
+  if (has_thread_instruction_count)
+    fields |= kHasThreadInstructionCount;
+  if (event.phase() == TRACE_EVENT_PHASE_COMPLETE) {
+    if (event.duration().ToInternalValue() != -1)
+      fields |= kHasDuration;
+    if (has_thread_timestamp &&
+        event.thread_duration().ToInternalValue() != -1) {
+      fields |= kHasThreadDuration;
+    }
+    if (has_thread_instruction_count)
+      fields |= kHasThreadInstructionDelta;
+  }
+
+  AppendByte(kEventRecord);
+  AppendByte(static_cast<uint8_t>(event.phase()));
+  AppendVarint(event.flags());
+  AppendVarint(fields);
+  AppendSignedVarint(thread_id);
+  if (fields & kHasProcessId)
+    AppendSignedVarint(process_id);
+  const int64_t timestamp = event.timestamp().ToInternalValue();
+  AppendSignedVarint(timestamp - last_timestamp_);
+  last_timestamp_ = timestamp;
+  AppendVarint(category_id);
+  AppendVarint(name_id);
+
+  if (strip_args) {
+    AppendVarint(kStrippedArguments);
+  } else {
+    AppendVarint(arg_count);
+    for (size_t i = 0; i < arg_count; ++i) {
+      AppendVarint(arg_name_ids[i]);
+      if (arg_stripped[i]) {
+        AppendByte(kStrippedValue);
+        continue;
+      }
+      const unsigned char type = event.arg_type(i);
+      const TraceValue& value = event.arg_value(i);
+      switch (type) {
+        case TRACE_VALUE_TYPE_BOOL:
+          AppendByte(type);
+          AppendByte(value.as_bool);
+          break;
+        case TRACE_VALUE_TYPE_UINT:
+          AppendByte(type);
+          AppendVarint(value.as_uint);
+          break;
+        case TRACE_VALUE_TYPE_INT:
+          AppendByte(type);
+          AppendSignedVarint(value.as_int);
+          break;
+        case TRACE_VALUE_TYPE_DOUBLE: {
+          AppendByte(type);
+          const uint64_t bits = bit_cast<uint64_t>(value.as_double);
+          for (int shift = 0; shift < 64; shift += 8)
+            AppendByte(static_cast<uint8_t>(bits >> shift));
+          break;
+        }
+        case TRACE_VALUE_TYPE_POINTER:
+          AppendByte(type);
+          AppendVarint(reinterpret_cast<uintptr_t>(value.as_pointer));
+          break;
+        case TRACE_VALUE_TYPE_STRING:
+          AppendByte(type);
+          AppendVarint(arg_string_ids[i]);
+          break;
+        case TRACE_VALUE_TYPE_COPY_STRING:
+          if (!value.as_string) {
+            // A null string is "NULL", as a static string.
+            AppendByte(TRACE_VALUE_TYPE_STRING);
+            AppendVarint(0);
+            break;
+          }
+          AppendByte(type);
+          AppendVarint(strlen(value.as_string));
+          AppendBytes(value.as_string, strlen(value.as_string));
+          break;
+        default: {
+          // The convertable and proto values are kept as their JSON.
+          std::string json;
+          value.AppendAsJSON(type, &json);
+          AppendByte(TRACE_VALUE_TYPE_CONVERTABLE);
+          AppendVarint(json.size());
+          AppendBytes(json.data(), json.size());
+          break;
+        }
+      }
+    }
+  }
+
+  if (fields & kHasDuration)
+    AppendSignedVarint(event.duration().ToInternalValue());
+  if (fields & kHasThreadTimestamp) {
+    const int64_t thread_timestamp = event.thread_timestamp().ToInternalValue();
+    AppendSignedVarint(thread_timestamp - last_thread_timestamp_);
+    last_thread_timestamp_ = thread_timestamp;
+  }
+  if (fields & kHasThreadDuration)
+    AppendSignedVarint(event.thread_duration().ToInternalValue());
+  if (fields & kHasThreadInstructionDelta)
+    AppendSignedVarint(event.thread_instruction_delta().ToInternalValue());
+  if (fields & kHasThreadInstructionCount)
+    AppendSignedVarint(event.thread_instruction_count().ToInternalValue());
+  if (fields & kHasScope)
+    AppendVarint(scope_id);
+  if (fields & kHasId)
+    AppendVarint(event.id());
+  if (fields & kHasBindId)
+    AppendVarint(event.bind_id());
+
+  if (buffer_.size() >= kBufferSize)
+    WriteBuffer();
+}
+
+bool TraceBinaryWriter::Finish() {
+  WriteBuffer();
+  return !write_failed_;
+}
+
+uint32_t TraceBinaryWriter::InternStaticString(const char* string) {
+  if (!string)
+    return 0;
+  auto it = static_string_ids_.find(string);
+  if (it != static_string_ids_.end())
+    return it->second;
+  const uint32_t id = DefineString(string, strlen(string));
+  static_string_ids_.emplace(string, id);
+  return id;
+}
+
+uint32_t TraceBinaryWriter::InternCopiedString(const char* string) {
+  if (!string)
+    return 0;
+  auto it = copied_string_ids_.find(string);
+  if (it != copied_string_ids_.end())
+    return it->second;
+  const size_t length = strlen(string);
+  const uint32_t id = DefineString(string, length);
+  copied_string_ids_.emplace(std::string(string, length), id);
+  return id;
+}
+
+uint32_t TraceBinaryWriter::DefineString(const char* string, size_t length) {
+  AppendByte(kStringRecord);
+  AppendVarint(length);
+  AppendBytes(string, length);
+  return next_string_id_++;
+}
+
+void TraceBinaryWriter::AppendVarint(uint64_t value) {
+  while (value >= 0x80) {
+    AppendByte(static_cast<uint8_t>(value | 0x80));
+    value >>= 7;
+  }
+  AppendByte(static_cast<uint8_t>(value));
+}
+
+void TraceBinaryWriter::AppendSignedVarint(int64_t value) {
+  AppendVarint(ZigZagEncode(value));
+}
+
+void TraceBinaryWriter::AppendBytes(const char* data, size_t length) {
+  buffer_.append(data, length);
+}
+
+void TraceBinaryWriter::WriteBuffer() {
+  if (buffer_.empty())
+    return;
+  if (!write_failed_ &&
+      !file_.WriteAtCurrentPosAndCheck(as_bytes(make_span(buffer_)))) {
+    DLOG(ERROR) << "Failed to write the binary trace: "
+                << File::ErrorToString(File::GetLastFileError());
+    write_failed_ = true;
+  }
+  buffer_.clear();
+}
+
+bool ConvertBinaryTraceToJSON(span<const uint8_t> trace, std::string* json) {
+  if (trace.size() < kMagicSize ||
+      memcmp(trace.data(), TraceBinaryWriter::kMagic, kMagicSize) != 0) {
+    return false;
+  }
+  BinaryTraceReader reader(trace.subspan(kMagicSize));
+  if (reader.ReadVarint() != TraceBinaryWriter::kVersion)
+    return false;
+  const int process_id = static_cast<int>(reader.ReadSignedVarint());
+
+  int64_t timestamp = 0;
+  int64_t thread_timestamp = 0;
+  bool first_event = true;
+  while (reader.ok() && !reader.AtEnd()) {
+    switch (reader.ReadByte()) {
+      case TraceBinaryWriter::kStringRecord:
+        reader.ReadStringRecord();
+        break;
+      case TraceBinaryWriter::kEventRecord:
+        if (!first_event)
+          json->append(",\n");
+        first_event = false;
+        if (!AppendEventAsJSON(&reader, process_id, &timestamp,
+                               &thread_timestamp, json)) {
+          return false;
+        }
+        break;
+      default:
+        return false;
+    }
+  }
+  return reader.ok();
+}
+
+}  // namespace trace_event
+}  // namespace base
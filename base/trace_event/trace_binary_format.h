@@ -0,0 +1,126 @@
+// Copyright 2022 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#ifndef BASE_TRACE_EVENT_TRACE_BINARY_FORMAT_H_
+#define BASE_TRACE_EVENT_TRACE_BINARY_FORMAT_H_
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include <string>
+#include <unordered_map>
+
+#include "base/base_export.h"
+#include "base/containers/span.h"
+#include "base/files/file.h"
+#include "base/trace_event/trace_event_impl.h"
+
+namespace base {
+namespace trace_event {
+
+// A compact binary format for the events of a TraceBuffer, written by
+// TraceLog::FlushToBinaryFile() instead of JSON text. It's a header followed
+// by records, with all the integers as LEB128 varints (zigzag-encoded if
+// signed):
+//
+//   header:  "BTRC", version, process id
+//   string:  kStringRecord, length, bytes
+//   event:   kEventRecord, phase byte, flags, fields (mask of kHas*), thread
+//            id, [process id], timestamp delta, category, name, arguments,
+//            [duration], [thread timestamp delta], [thread duration],
+//            [instruction count], [instruction delta], [scope], [id],
+//            [bind id]
+//
+// A string record defines the next string id, from 1; 0 is a null string.
+// The categories, event names, argument names, scopes and the values of the
+// TRACE_VALUE_TYPE_STRING arguments are these ids, so each is written once.
+// The timestamps are deltas to those of the previous event, which is
+// usually of the same thread since the events are written chunk by chunk.
+//
+// The arguments are their count, or kStrippedArguments, then for each a
+// name id, a TRACE_VALUE_TYPE_* byte, or kStrippedValue, and the value. The
+// convertable and proto values are kept as the JSON they'd be flushed as.
+//
+// ConvertBinaryTraceToJSON() gives back the JSON of TraceLog::Flush().
+class BASE_EXPORT TraceBinaryWriter {
+ public:
+  static constexpr char kMagic[] = "BTRC";
+  static constexpr uint64_t kVersion = 1;
+
+  static constexpr uint8_t kStringRecord = 1;
+  static constexpr uint8_t kEventRecord = 2;
+
+  static constexpr uint64_t kStrippedArguments = 0xff;
+  static constexpr uint8_t kStrippedValue = 0;
+
+  // The optional fields of an event, set when the JSON of the event has
+  // them.
+  enum Field : uint64_t {
+    kHasProcessId = 1 << 0,
+    kHasDuration = 1 << 1,
+    kHasThreadTimestamp = 1 << 2,
+    kHasThreadDuration = 1 << 3,
+    kHasThreadInstructionCount = 1 << 4,
+    kHasThreadInstructionDelta = 1 << 5,
+    kHasScope = 1 << 6,
+    kHasId = 1 << 7,
+    kHasBindId = 1 << 8,
+  };
+
+  // Writes the header to |file|, with |process_id| for the events which don't
+  // have theirs.
+  TraceBinaryWriter(File file, int process_id);
+  TraceBinaryWriter(const TraceBinaryWriter&) = delete;
+  TraceBinaryWriter& operator=(const TraceBinaryWriter&) = delete;
+  ~TraceBinaryWriter();
+
+  // Appends |event|, with its arguments filtered by
+  // |argument_filter_predicate| as for TraceEvent::AppendAsJSON(). The data
+  // is buffered, and written to the file by kBufferSize.
+  void AppendEvent(const TraceEvent& event,
+                   const ArgumentFilterPredicate& argument_filter_predicate);
+
+  // Writes the buffered data, and returns false if any write failed.
+  bool Finish();
+
+ private:
+  static constexpr size_t kBufferSize = 64 * 1024;
+
+  // Returns the id of a string which outlives the writer, by its address.
+  uint32_t InternStaticString(const char* string);
+  // Returns the id of a string which may not outlive the writer.
+  uint32_t InternCopiedString(const char* string);
+  uint32_t DefineString(const char* string, size_t length);
+
+  void AppendByte(uint8_t value) {
+    buffer_.push_back(static_cast<char>(value));
+  }
+  void AppendVarint(uint64_t value);
+  void AppendSignedVarint(int64_t value);
+  void AppendBytes(const char* data, size_t length);
+  void WriteBuffer();
+
+  File file_;
+  const int process_id_;
+  bool write_failed_ = false;
+  std::string buffer_;
+
+  uint32_t next_string_id_ = 1;
+  std::unordered_map<const void*, uint32_t> static_string_ids_;
+  std::unordered_map<std::string, uint32_t> copied_string_ids_;
+
+  int64_t last_timestamp_ = 0;
+  int64_t last_thread_timestamp_ = 0;
+};
+
+// Appends to |json| the JSON of the events of |trace|, the content of a file
+// written by a TraceBinaryWriter, separated by ",\n" as in the fragments of
+// TraceLog::Flush(). Returns false if |trace| is malformed.
+BASE_EXPORT bool ConvertBinaryTraceToJSON(span<const uint8_t> trace,
+                                          std::string* json);
+
+}  // namespace trace_event
+}  // namespace base
+
+#endif  // BASE_TRACE_EVENT_TRACE_BINARY_FORMAT_H_
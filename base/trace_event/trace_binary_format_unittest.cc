@@ -0,0 +1,168 @@
+// Copyright 2022 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "base/trace_event/trace_binary_format.h"
+
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "base/bind.h"
+#include "base/files/file.h"
+#include "base/files/file_util.h"
+#include "base/files/scoped_temp_dir.h"
+#include "base/time/time.h"
+#include "base/trace_event/trace_event.h"
+#include "base/trace_event/traced_value.h"
+#include "testing/gtest/include/gtest/gtest.h"
+
+namespace base {
+namespace trace_event {
+namespace {
+
+constexpr int kProcessId = 42;
+const unsigned char kCategory[] = "cat,foo";
+
+class TraceBinaryFormatTest : public testing::Test {
+ public:
+  void SetUp() override {
+    ASSERT_TRUE(temp_dir_.CreateUniqueTempDir());
+    path_ = temp_dir_.GetPath().AppendASCII("trace.btrc");
+  }
+
+  // Writes |events| to a binary trace, and returns the trace.
+  std::string WriteEvents(const std::vector<TraceEvent>& events,
+                          const ArgumentFilterPredicate& predicate) {
+    TraceBinaryWriter writer(
+        File(path_, File::FLAG_CREATE_ALWAYS | File::FLAG_WRITE), kProcessId);
+    for (const TraceEvent& event : events)
+      writer.AppendEvent(event, predicate);
+    EXPECT_TRUE(writer.Finish());
+    std::string trace;
+    EXPECT_TRUE(ReadFileToString(path_, &trace));
+    return trace;
+  }
+
+  // Returns the JSON of |events| as TraceLog::Flush() would write it.
+  static std::string ToJSON(const std::vector<TraceEvent>& events,
+                            const ArgumentFilterPredicate& predicate) {
+    std::string json;
+    for (const TraceEvent& event : events) {
+      if (!json.empty())
+        json += ",\n";
+      event.AppendAsJSON(&json, predicate);
+    }
+    return json;
+  }
+
+  static std::vector<TraceEvent> MakeEvents() {
+    std::vector<TraceEvent> events(6);
+    const TimeTicks start = TimeTicks() + Seconds(1);
+    for (size_t i = 0; i < events.size(); ++i) {
+      TraceArguments args;
+      char phase = TRACE_EVENT_PHASE_COMPLETE;
+      unsigned flags = TRACE_EVENT_FLAG_HAS_PROCESS_ID;
+      unsigned long long id = 0;
+      switch (i) {
+        case 0:
+          args = TraceArguments("src_file", "foo.cc", "line", 42);
+          break;
+        case 1:
+          args = TraceArguments("ratio", 0.25, "enabled", true);
+          break;
+        case 2:
+          args = TraceArguments("copied", std::string("a \"copy\""));
+          break;
+        case 3: {
+          auto value = std::make_unique<TracedValue>();
+          value->SetInteger("count", 3);
+          args = TraceArguments("data", std::move(value));
+          phase = TRACE_EVENT_PHASE_ASYNC_BEGIN;
+          flags |= TRACE_EVENT_FLAG_HAS_ID;
+          id = 0x1234;
+          break;
+        }
+        case 4:
+          args = TraceArguments("pointer", reinterpret_cast<void*>(0x5678));
+          phase = TRACE_EVENT_PHASE_INSTANT;
+          flags |= TRACE_EVENT_SCOPE_PROCESS;
+          break;
+        default:
+          flags |= TRACE_EVENT_FLAG_FLOW_OUT | TRACE_EVENT_FLAG_COPY;
+          id = 7;
+          break;
+      }
+      const TimeTicks timestamp = start + Microseconds(10 * i);
+      const ThreadTicks thread_timestamp =
+          ThreadTicks() + Microseconds(100 + i);
+      events[i].Reset(/*thread_id=*/10 + i % 2, timestamp, thread_timestamp,
+                      ThreadInstructionCount(), phase, kCategory,
+                      i % 2 ? "Paint" : "Layout", /*scope=*/nullptr, id,
+                      /*bind_id=*/id, &args, flags);
+      if (phase == TRACE_EVENT_PHASE_COMPLETE) {
+        events[i].UpdateDuration(timestamp + Microseconds(3),
+                                 thread_timestamp + Microseconds(2),
+                                 ThreadInstructionCount());
+      }
+    }
+    return events;
+  }
+
+ private:
+  ScopedTempDir temp_dir_;
+  FilePath path_;
+};
+
+TEST_F(TraceBinaryFormatTest, ConvertsToTheSameJSON) {
+  std::vector<TraceEvent> events = MakeEvents();
+  std::string trace = WriteEvents(events, ArgumentFilterPredicate());
+  EXPECT_LT(trace.size(), ToJSON(events, ArgumentFilterPredicate()).size());
+
+  std::string json;
+  ASSERT_TRUE(ConvertBinaryTraceToJSON(as_bytes(make_span(trace)), &json));
+  EXPECT_EQ(ToJSON(events, ArgumentFilterPredicate()), json);
+}
+
+TEST_F(TraceBinaryFormatTest, FiltersArguments) {
+  ArgumentFilterPredicate predicate = BindRepeating(
+      [](const char* category_group_name, const char* event_name,
+         ArgumentNameFilterPredicate* name_predicate) {
+        if (strcmp(event_name, "Paint") == 0)
+          return false;
+        *name_predicate = BindRepeating(
+            [](const char* name) { return strcmp(name, "line") != 0; });
+        return true;
+      });
+  std::vector<TraceEvent> events = MakeEvents();
+  std::string trace = WriteEvents(events, predicate);
+
+  std::string json;
+  ASSERT_TRUE(ConvertBinaryTraceToJSON(as_bytes(make_span(trace)), &json));
+  EXPECT_EQ(ToJSON(events, predicate), json);
+  EXPECT_NE(std::string::npos, json.find("__stripped__"));
+}
+
+TEST_F(TraceBinaryFormatTest, RejectsMalformedTraces) {
+  std::string json;
+  EXPECT_FALSE(ConvertBinaryTraceToJSON(span<const uint8_t>(), &json));
+  const std::string not_a_trace = "JSON[]";
+  EXPECT_FALSE(
+      ConvertBinaryTraceToJSON(as_bytes(make_span(not_a_trace)), &json));
+
+  // Every truncation of a trace but the ones at a record boundary fails.
+  std::string trace = WriteEvents(MakeEvents(), ArgumentFilterPredicate());
+  size_t truncations_failed = 0;
+  for (size_t size = 0; size < trace.size(); ++size) {
+    json.clear();
+    if (!ConvertBinaryTraceToJSON(
+            as_bytes(make_span(trace.data(), size)), &json)) {
+      ++truncations_failed;
+    }
+  }
+  EXPECT_GT(truncations_failed, trace.size() / 2);
+}
+
+}  // namespace
+}  // namespace trace_event
+}  // namespace base
@@ -0,0 +1,47 @@
+// Copyright 2022 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+// This program converts a binary trace, written by
+// TraceLog::FlushToBinaryFile(), to the JSON trace format for viewing.
+//
+// Usage:
+// $ out/foobar/trace_binary_to_json the/path/to/trace.btrc trace.json
+//
+// The JSON is the array of the events, as written by a TraceResultBuffer.
+
+#include <iostream>
+#include <string>
+
+#include "base/command_line.h"
+#include "base/containers/span.h"
+#include "base/files/file_util.h"
+#include "base/trace_event/trace_binary_format.h"
+
+int main(int argc, char* argv[]) {
+  base::CommandLine::Init(argc, argv);
+  const base::CommandLine::StringVector& args =
+      base::CommandLine::ForCurrentProcess()->GetArgs();
+  if (args.size() != 2) {
+    std::cerr << "Usage: trace_binary_to_json <binary trace> <JSON trace>\n";
+    return EXIT_FAILURE;
+  }
+
+  std::string trace;
+  if (!base::ReadFileToString(base::FilePath(args[0]), &trace)) {
+    std::cerr << "Could not read " << args[0] << std::endl;
+    return EXIT_FAILURE;
+  }
+  std::string json = "[";
+  if (!base::trace_event::ConvertBinaryTraceToJSON(
+          base::as_bytes(base::make_span(trace)), &json)) {
+    std::cerr << "Malformed binary trace " << args[0] << std::endl;
+    return EXIT_FAILURE;
+  }
+  json += "]";
+  if (!base::WriteFile(base::FilePath(args[1]), json)) {
+    std::cerr << "Could not write " << args[1] << std::endl;
+    return EXIT_FAILURE;
+  }
+  return EXIT_SUCCESS;
+}
@@ -9,6 +9,8 @@
 #include <vector>
 
 #include "base/bind.h"
+#include "base/bits.h"
+#include "base/check_op.h"
 #include "base/trace_event/heap_profiler.h"
 #include "base/trace_event/trace_event_impl.h"
 
@@ -37,9 +39,10 @@ class TraceBufferRingBuffer : public TraceBuffer {
   std::unique_ptr<TraceBufferChunk> GetChunk(size_t* index) override {
     HEAP_PROFILER_SCOPED_IGNORE;
 
-    // Because the number of threads is much less than the number of chunks,
-    // the queue should never be empty.
-    DCHECK(!QueueIsEmpty());
+    // The queue is empty when all the chunks are in flight, e.g. held by the
+    // threads and the chunk pool of TraceLog. The event is then dropped.
+    if (QueueIsEmpty())
+      return nullptr;
 
     *index = recyclable_chunks_queue_[queue_head_];
     queue_head_ = NextQueueIndex(queue_head_);
@@ -302,6 +305,106 @@ void TraceBufferChunk::EstimateTraceMemoryOverhead(
   overhead->Update(*cached_overhead_estimate_);
 }
 
+InFlightTraceBufferChunk::InFlightTraceBufferChunk() = default;
+
+InFlightTraceBufferChunk::InFlightTraceBufferChunk(
+    InFlightTraceBufferChunk&&) = default;
+
+InFlightTraceBufferChunk& InFlightTraceBufferChunk::operator=(
+    InFlightTraceBufferChunk&&) = default;
+
+InFlightTraceBufferChunk::~InFlightTraceBufferChunk() = default;
+
+TraceBufferChunkPool::TraceBufferChunkPool(size_t capacity)
+    : mask_(capacity - 1), cells_(new Cell[capacity]) {
+  DCHECK(bits::IsPowerOfTwo(capacity));
+  for (size_t i = 0; i < capacity; ++i)
+    cells_[i].sequence.store(i, std::memory_order_relaxed);
+}
+
+TraceBufferChunkPool::~TraceBufferChunkPool() = default;
+
+bool TraceBufferChunkPool::Push(InFlightTraceBufferChunk* chunk) {
+  DCHECK(chunk->chunk);
+  size_t position = push_position_.load(std::memory_order_relaxed);
+  Cell* cell;
+  while (true) {
+    cell = &cells_[position & mask_];
+    const size_t sequence = cell->sequence.load(std::memory_order_acquire);
+    if (sequence == position) {
+      // The cell is free at this lap: claim it.
+      if (push_position_.compare_exchange_weak(position, position + 1,
+                                               std::memory_order_relaxed)) {
+        break;
+      }
+    } else if (sequence < position) {
+      // The cell still holds the chunk of the previous lap.
+      return false;
+    } else {
+      position = push_position_.load(std::memory_order_relaxed);
+    }
+  }
+  cell->value = std::move(*chunk);
+  cell->sequence.store(position + 1, std::memory_order_release);
+  return true;
+}
+
+bool TraceBufferChunkPool::Pop(InFlightTraceBufferChunk* chunk) {
+  size_t position = pop_position_.load(std::memory_order_relaxed);
+  Cell* cell;
+  while (true) {
+    cell = &cells_[position & mask_];
+    const size_t sequence = cell->sequence.load(std::memory_order_acquire);
+    if (sequence == position + 1) {
+      // The cell holds the chunk of this lap: claim it.
+      if (pop_position_.compare_exchange_weak(position, position + 1,
+                                              std::memory_order_relaxed)) {
+        break;
+      }
+    } else if (sequence < position + 1) {
+      // No chunk was pushed in the cell yet.
+      return false;
+    } else {
+      position = pop_position_.load(std::memory_order_relaxed);
+    }
+  }
+  *chunk = std::move(cell->value);
+  cell->sequence.store(position + mask_ + 1, std::memory_order_release);
+  return true;
+}
+
+size_t TraceBufferChunkPool::ApproximateSize() const {
+  const size_t pop_position = pop_position_.load(std::memory_order_relaxed);
+  const size_t push_position = push_position_.load(std::memory_order_relaxed);
+  return push_position > pop_position ? push_position - pop_position : 0;
+}
+
+TraceBufferChunkRing::TraceBufferChunkRing(size_t capacity)
+    : slot_count_(capacity + 1),
+      slots_(new InFlightTraceBufferChunk[slot_count_]) {}
+
+TraceBufferChunkRing::~TraceBufferChunkRing() = default;
+
+bool TraceBufferChunkRing::Push(InFlightTraceBufferChunk* chunk) {
+  DCHECK(chunk->chunk);
+  const size_t tail = tail_.load(std::memory_order_relaxed);
+  const size_t next_tail = NextIndex(tail);
+  if (next_tail == head_.load(std::memory_order_acquire))
+    return false;
+  slots_[tail] = std::move(*chunk);
+  tail_.store(next_tail, std::memory_order_release);
+  return true;
+}
+
+bool TraceBufferChunkRing::Pop(InFlightTraceBufferChunk* chunk) {
+  const size_t head = head_.load(std::memory_order_relaxed);
+  if (head == tail_.load(std::memory_order_acquire))
+    return false;
+  *chunk = std::move(slots_[head]);
+  head_.store(NextIndex(head), std::memory_order_release);
+  return true;
+}
+
 TraceResultBuffer::OutputCallback
 TraceResultBuffer::SimpleOutput::GetCallback() {
   return BindRepeating(&SimpleOutput::Append, Unretained(this));
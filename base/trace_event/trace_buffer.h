@@ -8,6 +8,9 @@
 #include <stddef.h>
 #include <stdint.h>
 
+#include <atomic>
+#include <memory>
+
 #include "base/base_export.h"
 #include "base/trace_event/trace_event.h"
 #include "base/trace_event/trace_event_impl.h"
@@ -81,6 +84,88 @@ class BASE_EXPORT TraceBuffer {
   static TraceBuffer* CreateTraceBufferVectorOfSize(size_t max_chunks);
 };
 
+// A chunk given by TraceBuffer::GetChunk(), with the |index| to give it back
+// at and the |generation| of the TraceLog buffer it was taken from.
+struct BASE_EXPORT InFlightTraceBufferChunk {
+  InFlightTraceBufferChunk();
+  InFlightTraceBufferChunk(InFlightTraceBufferChunk&&);
+  InFlightTraceBufferChunk& operator=(InFlightTraceBufferChunk&&);
+  ~InFlightTraceBufferChunk();
+
+  std::unique_ptr<TraceBufferChunk> chunk;
+  size_t index = 0;
+  int generation = 0;
+};
+
+// TraceBufferChunkPool holds chunks taken out of a TraceBuffer in advance, so
+// that threads can get a new chunk without the lock of the buffer. Any thread
+// may push or pop chunks; neither blocks. Implemented as a bounded queue of
+// cells with sequence numbers, see
+// http://www.1024cores.net/home/lock-free-algorithms/queues/bounded-mpmc-queue
+class BASE_EXPORT TraceBufferChunkPool {
+ public:
+  // |capacity| must be a power of 2.
+  explicit TraceBufferChunkPool(size_t capacity);
+  TraceBufferChunkPool(const TraceBufferChunkPool&) = delete;
+  TraceBufferChunkPool& operator=(const TraceBufferChunkPool&) = delete;
+  ~TraceBufferChunkPool();
+
+  // Moves |*chunk| into the pool. Returns false, leaving |*chunk| as is, if
+  // the pool is full.
+  bool Push(InFlightTraceBufferChunk* chunk);
+
+  // Moves the oldest chunk of the pool into |*chunk|. Returns false if the
+  // pool is empty.
+  bool Pop(InFlightTraceBufferChunk* chunk);
+
+  // The number of chunks in the pool, which may be changing concurrently.
+  size_t ApproximateSize() const;
+
+  size_t capacity() const { return mask_ + 1; }
+
+ private:
+  struct Cell {
+    std::atomic<size_t> sequence;
+    InFlightTraceBufferChunk value;
+  };
+
+  const size_t mask_;
+  const std::unique_ptr<Cell[]> cells_;
+  std::atomic<size_t> push_position_{0};
+  std::atomic<size_t> pop_position_{0};
+};
+
+// TraceBufferChunkRing queues the full chunks of a single thread until they
+// are given back to the TraceBuffer. It has a single producer and a single
+// consumer at a time: Push() is only called by the thread which owns the
+// ring, and Pop() by a thread which holds the lock of the buffer.
+class BASE_EXPORT TraceBufferChunkRing {
+ public:
+  explicit TraceBufferChunkRing(size_t capacity);
+  TraceBufferChunkRing(const TraceBufferChunkRing&) = delete;
+  TraceBufferChunkRing& operator=(const TraceBufferChunkRing&) = delete;
+  ~TraceBufferChunkRing();
+
+  // Moves |*chunk| into the ring. Returns false, leaving |*chunk| as is, if
+  // the ring is full.
+  bool Push(InFlightTraceBufferChunk* chunk);
+
+  // Moves the oldest chunk of the ring into |*chunk|. Returns false if the
+  // ring is empty.
+  bool Pop(InFlightTraceBufferChunk* chunk);
+
+ private:
+  size_t NextIndex(size_t index) const {
+    return index + 1 == slot_count_ ? 0 : index + 1;
+  }
+
+  // One extra slot to tell the full ring from the empty one.
+  const size_t slot_count_;
+  const std::unique_ptr<InFlightTraceBufferChunk[]> slots_;
+  std::atomic<size_t> head_{0};
+  std::atomic<size_t> tail_{0};
+};
+
 // TraceResultBuffer collects and converts trace fragments returned by TraceLog
 // to JSON output.
 class BASE_EXPORT TraceResultBuffer {
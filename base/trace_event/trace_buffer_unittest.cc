@@ -0,0 +1,160 @@
+// Copyright 2022 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "base/trace_event/trace_buffer.h"
+
+#include <memory>
+#include <vector>
+
+#include "base/memory/raw_ptr.h"
+#include "base/threading/platform_thread.h"
+#include "base/threading/simple_thread.h"
+#include "testing/gtest/include/gtest/gtest.h"
+
+namespace base {
+namespace trace_event {
+namespace {
+
+InFlightTraceBufferChunk MakeChunk(size_t index) {
+  InFlightTraceBufferChunk chunk;
+  chunk.chunk = std::make_unique<TraceBufferChunk>(index + 1);
+  chunk.index = index;
+  return chunk;
+}
+
+// Pushes the chunks [|first_index|, |first_index| + |count|) in |pool|.
+class PushThread : public SimpleThread {
+ public:
+  PushThread(TraceBufferChunkPool* pool, size_t first_index, size_t count)
+      : SimpleThread("PushThread"),
+        pool_(pool),
+        first_index_(first_index),
+        count_(count) {}
+
+  void Run() override {
+    for (size_t i = first_index_; i < first_index_ + count_; ++i) {
+      InFlightTraceBufferChunk chunk = MakeChunk(i);
+      while (!pool_->Push(&chunk))
+        PlatformThread::YieldCurrentThread();
+    }
+  }
+
+ private:
+  const raw_ptr<TraceBufferChunkPool> pool_;
+  const size_t first_index_;
+  const size_t count_;
+};
+
+// Pops |count| chunks from |pool|, and counts them in |popped|.
+class PopThread : public SimpleThread {
+ public:
+  PopThread(TraceBufferChunkPool* pool, size_t count, std::vector<int>* popped)
+      : SimpleThread("PopThread"), pool_(pool), count_(count), popped_(popped) {}
+
+  void Run() override {
+    InFlightTraceBufferChunk chunk;
+    for (size_t i = 0; i < count_; ++i) {
+      while (!pool_->Pop(&chunk))
+        PlatformThread::YieldCurrentThread();
+      EXPECT_EQ(chunk.index + 1, chunk.chunk->seq());
+      ++(*popped_)[chunk.index];
+    }
+  }
+
+ private:
+  const raw_ptr<TraceBufferChunkPool> pool_;
+  const size_t count_;
+  const raw_ptr<std::vector<int>> popped_;
+};
+
+TEST(TraceBufferChunkPoolTest, PushPop) {
+  TraceBufferChunkPool pool(4);
+  EXPECT_EQ(4u, pool.capacity());
+  InFlightTraceBufferChunk chunk;
+  EXPECT_FALSE(pool.Pop(&chunk));
+
+  for (size_t i = 0; i < 4; ++i) {
+    chunk = MakeChunk(i);
+    EXPECT_TRUE(pool.Push(&chunk));
+    EXPECT_FALSE(chunk.chunk);
+  }
+  EXPECT_EQ(4u, pool.ApproximateSize());
+
+  // The chunk stays with the caller when the pool is full.
+  chunk = MakeChunk(4);
+  EXPECT_FALSE(pool.Push(&chunk));
+  EXPECT_TRUE(chunk.chunk);
+
+  // The chunks are popped in the order they were pushed, across laps.
+  for (size_t i = 0; i < 4; ++i) {
+    EXPECT_TRUE(pool.Pop(&chunk));
+    EXPECT_EQ(i, chunk.index);
+    InFlightTraceBufferChunk next = MakeChunk(i + 4);
+    EXPECT_TRUE(pool.Push(&next));
+  }
+  for (size_t i = 4; i < 8; ++i) {
+    EXPECT_TRUE(pool.Pop(&chunk));
+    EXPECT_EQ(i, chunk.index);
+  }
+  EXPECT_FALSE(pool.Pop(&chunk));
+  EXPECT_EQ(0u, pool.ApproximateSize());
+}
+
+TEST(TraceBufferChunkPoolTest, ConcurrentPushPop) {
+  constexpr size_t kThreadCount = 4;
+  constexpr size_t kChunksPerThread = 1000;
+  TraceBufferChunkPool pool(8);
+
+  // Each popping thread counts in its own vector.
+  std::vector<std::vector<int>> popped(
+      kThreadCount, std::vector<int>(kThreadCount * kChunksPerThread));
+  std::vector<std::unique_ptr<SimpleThread>> threads;
+  for (size_t i = 0; i < kThreadCount; ++i) {
+    threads.push_back(std::make_unique<PushThread>(
+        &pool, i * kChunksPerThread, kChunksPerThread));
+    threads.push_back(
+        std::make_unique<PopThread>(&pool, kChunksPerThread, &popped[i]));
+  }
+  for (const std::unique_ptr<SimpleThread>& thread : threads)
+    thread->Start();
+  for (const std::unique_ptr<SimpleThread>& thread : threads)
+    thread->Join();
+
+  // Each chunk was popped once.
+  for (size_t index = 0; index < kThreadCount * kChunksPerThread; ++index) {
+    int count = 0;
+    for (const std::vector<int>& thread_popped : popped)
+      count += thread_popped[index];
+    EXPECT_EQ(1, count) << index;
+  }
+  EXPECT_EQ(0u, pool.ApproximateSize());
+}
+
+TEST(TraceBufferChunkRingTest, PushPop) {
+  TraceBufferChunkRing ring(2);
+  InFlightTraceBufferChunk chunk;
+  EXPECT_FALSE(ring.Pop(&chunk));
+
+  for (size_t round = 0; round < 3; ++round) {
+    chunk = MakeChunk(2 * round);
+    EXPECT_TRUE(ring.Push(&chunk));
+    chunk = MakeChunk(2 * round + 1);
+    EXPECT_TRUE(ring.Push(&chunk));
+
+    // The chunk stays with the caller when the ring is full.
+    chunk = MakeChunk(100);
+    EXPECT_FALSE(ring.Push(&chunk));
+    EXPECT_TRUE(chunk.chunk);
+
+    EXPECT_TRUE(ring.Pop(&chunk));
+    EXPECT_EQ(2 * round, chunk.index);
+    EXPECT_TRUE(ring.Pop(&chunk));
+    EXPECT_EQ(2 * round + 1, chunk.index);
+    EXPECT_FALSE(ring.Pop(&chunk));
+  }
+}
+
+}  // namespace
+}  // namespace trace_event
+}  // namespace base
@@ -5,9 +5,12 @@
 #include <string.h>
 
 #include <memory>
+#include <string>
+#include <vector>
 
 #include "base/bind.h"
 #include "base/lazy_instance.h"
+#include "base/strings/stringprintf.h"
 #include "base/synchronization/lock.h"
 #include "base/synchronization/waitable_event.h"
 #include "base/threading/thread.h"
@@ -156,6 +159,61 @@ TEST_F(TraceCategoryTest, MAYBE_ThreadRaces) {
   ASSERT_EQ(1, num_times_seen);
 }
 
+TEST_F(TraceCategoryTest, ManyCategories) {
+  constexpr int kNumCategories = 400;
+  std::vector<std::string> names;
+  std::vector<TraceCategory*> categories;
+  for (int i = 0; i < kNumCategories; i++) {
+    names.push_back(StringPrintf("__test_many_%d", i));
+    TraceCategory* cat = nullptr;
+    ASSERT_TRUE(GetOrCreateCategoryByName(names.back().c_str(), &cat));
+    categories.push_back(cat);
+  }
+
+  for (int i = 0; i < kNumCategories; i++) {
+    // The registry keeps its own copy of the name.
+    const std::string name = names[i];
+    EXPECT_NE(name.c_str(), categories[i]->name());
+    EXPECT_EQ(categories[i], CategoryRegistry::GetCategoryByName(name.c_str()));
+    TraceCategory* cat = nullptr;
+    EXPECT_FALSE(GetOrCreateCategoryByName(name.c_str(), &cat));
+    EXPECT_EQ(categories[i], cat);
+  }
+  EXPECT_EQ(nullptr, CategoryRegistry::GetCategoryByName("__test_many_-1"));
+
+  // Builtin categories are still found once others were created.
+  EXPECT_EQ(CategoryRegistry::kCategoryMetadata,
+            CategoryRegistry::GetCategoryByName(
+                CategoryRegistry::kCategoryMetadata->name()));
+}
+
+TEST_F(TraceCategoryTest, HashCollisions) {
+  // Known 32-bit FNV-1a collisions.
+  static_assert(CategoryRegistry::HashCategoryName("costarring") ==
+                    CategoryRegistry::HashCategoryName("liquid"),
+                "FNV-1a collision expected");
+  static_assert(CategoryRegistry::HashCategoryName("declinate") ==
+                    CategoryRegistry::HashCategoryName("macallums"),
+                "FNV-1a collision expected");
+
+  TraceCategory* cat_1 = nullptr;
+  TraceCategory* cat_2 = nullptr;
+  ASSERT_TRUE(GetOrCreateCategoryByName("costarring", &cat_1));
+  ASSERT_TRUE(GetOrCreateCategoryByName("liquid", &cat_2));
+  EXPECT_NE(cat_1, cat_2);
+  EXPECT_EQ(cat_1, CategoryRegistry::GetCategoryByName("costarring"));
+  EXPECT_EQ(cat_2, CategoryRegistry::GetCategoryByName("liquid"));
+
+  // "macallums" probes past "declinate" but isn't found.
+  TraceCategory* cat_3 = nullptr;
+  ASSERT_TRUE(GetOrCreateCategoryByName("declinate", &cat_3));
+  EXPECT_EQ(nullptr, CategoryRegistry::GetCategoryByName("macallums"));
+
+  // Lookups with a compile-time hash.
+  constexpr uint32_t kHash = CategoryRegistry::HashCategoryName("liquid");
+  EXPECT_EQ(cat_2, CategoryRegistry::GetCategoryByName("liquid", kHash));
+}
+
 // Tests getting trace categories by name at compile-time.
 TEST_F(TraceCategoryTest, GetCategoryAtCompileTime) {
   static_assert(GetBuiltinCategoryByName("nonexistent") == nullptr,
@@ -28,6 +28,7 @@ namespace {
 const char kRecordUntilFull[] = "record-until-full";
 const char kRecordContinuously[] = "record-continuously";
 const char kRecordAsMuchAsPossible[] = "record-as-much-as-possible";
+const char kRecordFlightRecorder[] = "record-flight-recorder";
 const char kTraceToConsole[] = "trace-to-console";
 const char kEnableSystrace[] = "enable-systrace";
 constexpr int kEnableSystraceLength = sizeof(kEnableSystrace) - 1;
@@ -53,6 +54,7 @@ const char kTriggerTypeParam[] = "type";
 const char kPeriodicIntervalLegacyParam[] = "periodic_interval_ms";
 const char kHeapProfilerOptions[] = "heap_profiler_options";
 const char kBreakdownThresholdBytes[] = "breakdown_threshold_bytes";
+const char kIncrementalLightDumpsParam[] = "incremental_light_dumps";
 
 // String parameters used to parse category event filters.
 const char kEventFiltersParam[] = "event_filters";
@@ -115,6 +117,7 @@ void TraceConfig::MemoryDumpConfig::Clear() {
   allowed_dump_modes.clear();
   triggers.clear();
   heap_profiler_options.Clear();
+  incremental_light_dumps = false;
 }
 
 void TraceConfig::MemoryDumpConfig::Merge(
@@ -126,6 +129,10 @@ void TraceConfig::MemoryDumpConfig::Merge(
   heap_profiler_options.breakdown_threshold_bytes =
       std::min(heap_profiler_options.breakdown_threshold_bytes,
                config.heap_profiler_options.breakdown_threshold_bytes);
+  // The light dumps stay complete unless all the configs read incremental
+  // ones.
+  incremental_light_dumps =
+      incremental_light_dumps && config.incremental_light_dumps;
 }
 
 TraceConfig::ProcessFilterConfig::ProcessFilterConfig() = default;
@@ -253,6 +260,8 @@ std::string TraceConfig::TraceRecordModeToStr(TraceRecordMode record_mode) {
       return kRecordAsMuchAsPossible;
     case ECHO_TO_CONSOLE:
       return kTraceToConsole;
+    case RECORD_FLIGHT_RECORDER:
+      return kRecordFlightRecorder;
     default:
       NOTREACHED();
   }
@@ -384,6 +393,8 @@ void TraceConfig::InitializeFromConfigDict(const Value& dict) {
       record_mode_ = ECHO_TO_CONSOLE;
     } else if (*record_mode == kRecordAsMuchAsPossible) {
       record_mode_ = RECORD_AS_MUCH_AS_POSSIBLE;
+    } else if (*record_mode == kRecordFlightRecorder) {
+      record_mode_ = RECORD_FLIGHT_RECORDER;
     }
   }
   trace_buffer_size_in_events_ =
@@ -455,6 +466,8 @@ void TraceConfig::InitializeFromStrings(StringPiece category_filter_string,
         record_mode_ = ECHO_TO_CONSOLE;
       } else if (token == kRecordAsMuchAsPossible) {
         record_mode_ = RECORD_AS_MUCH_AS_POSSIBLE;
+      } else if (token == kRecordFlightRecorder) {
+        record_mode_ = RECORD_FLIGHT_RECORDER;
       } else if (token.find(kEnableSystrace) == 0) {
         // Find optional events list.
         const size_t length = token.length();
@@ -553,6 +566,10 @@ void TraceConfig::SetMemoryDumpConfigFromConfigDict(
           MemoryDumpConfig::HeapProfiler::kDefaultBreakdownThresholdBytes;
     }
   }
+
+  memory_dump_config_.incremental_light_dumps =
+      memory_dump_config.FindBoolKey(kIncrementalLightDumpsParam)
+          .value_or(false);
 }
 
 void TraceConfig::SetDefaultMemoryDumpConfig() {
@@ -648,6 +665,8 @@ Value TraceConfig::ToValue() const {
           memory_dump_config_.heap_profiler_options.breakdown_threshold_bytes);
       memory_dump_config.SetKey(kHeapProfilerOptions, std::move(options));
     }
+    if (memory_dump_config_.incremental_light_dumps)
+      memory_dump_config.SetBoolKey(kIncrementalLightDumpsParam, true);
     dict.SetKey(kMemoryDumpConfigParam, std::move(memory_dump_config));
   }
 
@@ -693,6 +712,9 @@ std::string TraceConfig::ToTraceOptionsString() const {
     case ECHO_TO_CONSOLE:
       ret = kTraceToConsole;
       break;
+    case RECORD_FLIGHT_RECORDER:
+      ret = kRecordFlightRecorder;
+      break;
     default:
       NOTREACHED();
   }
@@ -41,6 +41,12 @@ enum TraceRecordMode {
 
   // Echo to console. Events are discarded.
   ECHO_TO_CONSOLE,
+
+  // Record all the time into a small ring buffer, for the events of the last
+  // seconds to be written by TraceLog::SnapshotFlightRecorder() when
+  // something goes wrong. Meant for a short list of cheap categories, e.g.
+  // TraceConfig("toplevel,cheap_category", RECORD_FLIGHT_RECORDER).
+  RECORD_FLIGHT_RECORDER,
 };
 
 class BASE_EXPORT TraceConfig {
@@ -86,6 +92,10 @@ class BASE_EXPORT TraceConfig {
 
     std::vector<Trigger> triggers;
     HeapProfiler heap_profiler_options;
+
+    // Whether the periodic LIGHT dumps only contain the allocator dumps which
+    // changed since the previous dump, see MemoryDumpArgs::is_incremental.
+    bool incremental_light_dumps = false;
   };
 
   class BASE_EXPORT ProcessFilterConfig {
@@ -162,9 +172,9 @@ class BASE_EXPORT TraceConfig {
   //
   // |trace_options_string| is a comma-delimited list of trace options.
   // Possible options are: "record-until-full", "record-continuously",
-  // "record-as-much-as-possible", "trace-to-console", "enable-systrace" and
-  // "enable-argument-filter".
-  // The first 4 options are trace recoding modes and hence
+  // "record-as-much-as-possible", "trace-to-console",
+  // "record-flight-recorder", "enable-systrace" and "enable-argument-filter".
+  // The first 5 options are trace recoding modes and hence
   // mutually exclusive. If more than one trace recording modes appear in the
   // options_string, the last one takes precedence. If none of the trace
   // recording mode is specified, recording mode is RECORD_UNTIL_FULL.
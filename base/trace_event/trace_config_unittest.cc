@@ -126,6 +126,13 @@ TEST(TraceConfigTest, TraceConfigFromValidLegacyFormat) {
   EXPECT_STREQ("record-as-much-as-possible",
                config.ToTraceOptionsString().c_str());
 
+  config = TraceConfig("", "record-flight-recorder");
+  EXPECT_EQ(RECORD_FLIGHT_RECORDER, config.GetTraceRecordMode());
+  EXPECT_FALSE(config.IsSystraceEnabled());
+  EXPECT_FALSE(config.IsArgumentFilterEnabled());
+  EXPECT_STREQ("record-flight-recorder",
+               config.ToTraceOptionsString().c_str());
+
   config = TraceConfig("", "enable-systrace, record-continuously");
   EXPECT_EQ(RECORD_CONTINUOUSLY, config.GetTraceRecordMode());
   EXPECT_TRUE(config.IsSystraceEnabled());
@@ -183,6 +190,11 @@ TEST(TraceConfigTest, TraceConfigFromValidLegacyFormat) {
   EXPECT_STREQ("record-as-much-as-possible",
                config.ToTraceOptionsString().c_str());
 
+  config = TraceConfig("", RECORD_FLIGHT_RECORDER);
+  EXPECT_EQ(RECORD_FLIGHT_RECORDER, config.GetTraceRecordMode());
+  EXPECT_STREQ("record-flight-recorder",
+               config.ToTraceOptionsString().c_str());
+
   // From category filter strings
   config = TraceConfig("included,-excluded,inc_pattern*,-exc_pattern*", "");
   EXPECT_STREQ("included,inc_pattern*,-excluded,-exc_pattern*",
@@ -665,6 +677,28 @@ TEST(TraceConfigTest, EmptyMemoryDumpConfigTest) {
       tc.memory_dump_config().heap_profiler_options.breakdown_threshold_bytes);
 }
 
+TEST(TraceConfigTest, IncrementalLightDumpsConfig) {
+  TraceConfig tc(StringPrintf("{\"included_categories\":[\"%s\"],"
+                              "\"memory_dump_config\":{"
+                              "\"incremental_light_dumps\":true,"
+                              "\"triggers\":[]}}",
+                              MemoryDumpManager::kTraceCategory));
+  EXPECT_TRUE(tc.memory_dump_config().incremental_light_dumps);
+  EXPECT_TRUE(TraceConfig(tc.ToString())
+                  .memory_dump_config()
+                  .incremental_light_dumps);
+
+  // The light dumps are only incremental if all the merged configs read them.
+  TraceConfig tc_with_complete_dumps(
+      TraceConfigMemoryTestUtil::GetTraceConfig_EmptyTriggers());
+  EXPECT_FALSE(tc_with_complete_dumps.memory_dump_config()
+                   .incremental_light_dumps);
+  EXPECT_EQ(std::string::npos,
+            tc_with_complete_dumps.ToString().find("incremental_light_dumps"));
+  tc.Merge(tc_with_complete_dumps);
+  EXPECT_FALSE(tc.memory_dump_config().incremental_light_dumps);
+}
+
 TEST(TraceConfigTest, LegacyStringToMemoryDumpConfig) {
   TraceConfig tc(MemoryDumpManager::kTraceCategory, "");
   EXPECT_TRUE(tc.IsCategoryGroupEnabled(MemoryDumpManager::kTraceCategory));
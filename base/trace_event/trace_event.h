@@ -27,6 +27,7 @@
 #include "base/trace_event/trace_arguments.h"
 #include "base/trace_event/trace_category.h"
 #include "base/trace_event/trace_log.h"
+#include "base/trace_event/trace_static_keys.h"
 #include "base/trace_event/traced_value_support.h"
 #include "base/tracing_buildflags.h"
 
@@ -69,11 +70,20 @@
            (base::trace_event::TraceCategory::ENABLED_FOR_RECORDING |    \
             base::trace_event::TraceCategory::ENABLED_FOR_ETW_EXPORT))
 
+#if BUILDFLAG(ENABLE_TRACE_STATIC_KEYS)
+// The sites of the categories with a static key are patched in and out, see
+// base/trace_event/trace_static_keys.h.
+#define INTERNAL_TRACE_EVENT_CATEGORY_GROUP_ENABLED()   \
+  base::trace_event::IsTraceCategoryEnabled<            \
+      INTERNAL_TRACE_EVENT_UID(k_category_static_key)>( \
+      INTERNAL_TRACE_EVENT_UID(category_group_enabled))
+#else
 #define INTERNAL_TRACE_EVENT_CATEGORY_GROUP_ENABLED()                  \
   UNLIKELY(*INTERNAL_TRACE_EVENT_UID(category_group_enabled) &         \
            (base::trace_event::TraceCategory::ENABLED_FOR_RECORDING |  \
             base::trace_event::TraceCategory::ENABLED_FOR_ETW_EXPORT | \
             base::trace_event::TraceCategory::ENABLED_FOR_FILTERING))
+#endif  // BUILDFLAG(ENABLE_TRACE_STATIC_KEYS)
 
 ////////////////////////////////////////////////////////////////////////////////
 // Implementation specific tracing API definitions.
@@ -221,6 +231,14 @@
         category_group_enabled);                                             \
   }
 
+#if BUILDFLAG(ENABLE_TRACE_STATIC_KEYS)
+#define INTERNAL_TRACE_EVENT_DECLARE_STATIC_KEY(category_group)        \
+  constexpr uint32_t INTERNAL_TRACE_EVENT_UID(k_category_static_key) = \
+      base::trace_event::BuiltinCategories::GetStaticKey(category_group);
+#else
+#define INTERNAL_TRACE_EVENT_DECLARE_STATIC_KEY(category_group)
+#endif
+
 #define INTERNAL_TRACE_EVENT_GET_CATEGORY_INFO(category_group)                 \
   static_assert(                                                               \
       base::trace_event::BuiltinCategories::IsAllowedCategory(category_group), \
@@ -229,6 +247,7 @@
   constexpr const unsigned char* INTERNAL_TRACE_EVENT_UID(                     \
       k_category_group_enabled) =                                              \
       base::trace_event::TraceLog::GetBuiltinCategoryEnabled(category_group);  \
+  INTERNAL_TRACE_EVENT_DECLARE_STATIC_KEY(category_group)                      \
   const unsigned char* INTERNAL_TRACE_EVENT_UID(category_group_enabled);       \
   INTERNAL_TRACE_EVENT_GET_CATEGORY_INFO_MAYBE_AT_COMPILE_TIME(                \
       category_group, INTERNAL_TRACE_EVENT_UID(k_category_group_enabled),      \
@@ -19,6 +19,8 @@
 #include "base/bind.h"
 #include "base/command_line.h"
 #include "base/containers/cxx20_erase_vector.h"
+#include "base/files/file_util.h"
+#include "base/files/scoped_temp_dir.h"
 #include "base/json/json_reader.h"
 #include "base/json/json_writer.h"
 #include "base/location.h"
@@ -33,10 +35,13 @@
 #include "base/strings/stringprintf.h"
 #include "base/synchronization/waitable_event.h"
 #include "base/task/single_thread_task_runner.h"
+#include "base/test/task_environment.h"
 #include "base/threading/platform_thread.h"
+#include "base/threading/simple_thread.h"
 #include "base/threading/thread.h"
 #include "base/time/time.h"
 #include "base/trace_event/event_name_filter.h"
+#include "base/trace_event/trace_binary_format.h"
 #include "base/trace_event/trace_buffer.h"
 #include "base/trace_event/trace_event_filter.h"
 #include "base/trace_event/trace_event_filter_test_utils.h"
@@ -1474,6 +1479,113 @@ TEST_F(TraceEventTestFixture, DataCapturedManyThreads) {
   }
 }
 
+// Runs TraceManyInstantEvents() on a thread without a message loop, then
+// waits for |done_event| if there is one.
+class TraceManyInstantEventsThread : public SimpleThread {
+ public:
+  TraceManyInstantEventsThread(int thread_id,
+                               int num_events,
+                               WaitableEvent* traced_event,
+                               WaitableEvent* done_event)
+      : SimpleThread(StringPrintf("Thread %d", thread_id)),
+        thread_id_(thread_id),
+        num_events_(num_events),
+        traced_event_(traced_event),
+        done_event_(done_event) {}
+
+  void Run() override {
+    TraceManyInstantEvents(thread_id_, num_events_, traced_event_);
+    if (done_event_)
+      done_event_->Wait();
+  }
+
+ private:
+  const int thread_id_;
+  const int num_events_;
+  const raw_ptr<WaitableEvent> traced_event_;
+  const raw_ptr<WaitableEvent> done_event_;
+};
+
+// Test that data sent from multiple threads without a message loop is
+// gathered, whether the threads exit before flush or not.
+TEST_F(TraceEventTestFixture, DataCapturedManyThreadsWithoutMessageLoop) {
+  BeginTrace();
+
+  const int num_threads = 8;
+  const int num_events = 1000;
+  WaitableEvent done_event(WaitableEvent::ResetPolicy::MANUAL,
+                           WaitableEvent::InitialState::NOT_SIGNALED);
+  std::vector<std::unique_ptr<WaitableEvent>> traced_events;
+  std::vector<std::unique_ptr<TraceManyInstantEventsThread>> threads;
+  for (int i = 0; i < num_threads; i++) {
+    traced_events.push_back(std::make_unique<WaitableEvent>(
+        WaitableEvent::ResetPolicy::AUTOMATIC,
+        WaitableEvent::InitialState::NOT_SIGNALED));
+    // Half of the threads keep running during flush.
+    threads.push_back(std::make_unique<TraceManyInstantEventsThread>(
+        i, num_events, traced_events.back().get(),
+        i < num_threads / 2 ? nullptr : &done_event));
+    threads.back()->Start();
+  }
+  for (int i = 0; i < num_threads; i++)
+    traced_events[i]->Wait();
+  for (int i = 0; i < num_threads / 2; i++)
+    threads[i]->Join();
+
+  EndTraceAndFlush();
+  ValidateInstantEventPresentOnEveryThread(trace_parsed_, num_threads,
+                                           num_events);
+
+  done_event.Signal();
+  for (int i = num_threads / 2; i < num_threads; i++)
+    threads[i]->Join();
+}
+
+#if !BUILDFLAG(USE_PERFETTO_CLIENT_LIBRARY)
+// Test that each flight recorder snapshot has the events recorded since the
+// previous one.
+TEST_F(TraceEventTestFixture, SnapshotFlightRecorder) {
+  test::TaskEnvironment task_environment;
+  ScopedTempDir temp_dir;
+  ASSERT_TRUE(temp_dir.CreateUniqueTempDir());
+  const FilePath first_path = temp_dir.GetPath().AppendASCII("first.btrc");
+  const FilePath second_path = temp_dir.GetPath().AppendASCII("second.btrc");
+
+  BeginTrace();
+  EXPECT_FALSE(TraceLog::GetInstance()->SnapshotFlightRecorder(first_path));
+  TraceLog::GetInstance()->SetDisabled();
+
+  TraceLog::GetInstance()->SetEnabled(
+      TraceConfig("test_included", RECORD_FLIGHT_RECORDER), TraceLog::RECORDING_MODE);
+  TRACE_EVENT_INSTANT0("test_included", "first", TRACE_EVENT_SCOPE_THREAD);
+  TRACE_EVENT_INSTANT0("test_excluded_cat", "not recorded",
+                       TRACE_EVENT_SCOPE_THREAD);
+  EXPECT_TRUE(TraceLog::GetInstance()->SnapshotFlightRecorder(first_path));
+  TRACE_EVENT_INSTANT0("test_included", "second", TRACE_EVENT_SCOPE_THREAD);
+  EXPECT_TRUE(TraceLog::GetInstance()->SnapshotFlightRecorder(second_path));
+  TraceLog::GetInstance()->SetDisabled();
+  EXPECT_FALSE(TraceLog::GetInstance()->SnapshotFlightRecorder(first_path));
+  task_environment.RunUntilIdle();
+
+  std::string first_trace;
+  std::string first_json;
+  ASSERT_TRUE(ReadFileToString(first_path, &first_trace));
+  ASSERT_TRUE(ConvertBinaryTraceToJSON(as_bytes(make_span(first_trace)),
+                                       &first_json));
+  EXPECT_NE(std::string::npos, first_json.find("\"name\":\"first\""));
+  EXPECT_EQ(std::string::npos, first_json.find("\"name\":\"second\""));
+  EXPECT_EQ(std::string::npos, first_json.find("not recorded"));
+
+  std::string second_trace;
+  std::string second_json;
+  ASSERT_TRUE(ReadFileToString(second_path, &second_trace));
+  ASSERT_TRUE(ConvertBinaryTraceToJSON(as_bytes(make_span(second_trace)),
+                                       &second_json));
+  EXPECT_EQ(std::string::npos, second_json.find("\"name\":\"first\""));
+  EXPECT_NE(std::string::npos, second_json.find("\"name\":\"second\""));
+}
+#endif  // !BUILDFLAG(USE_PERFETTO_CLIENT_LIBRARY)
+
 // Test that thread and process names show up in the trace
 TEST_F(TraceEventTestFixture, ThreadNames) {
   // Create threads before we enable tracing to make sure
@@ -4,6 +4,7 @@
 
 #include "base/trace_event/trace_log.h"
 
+#include <algorithm>
 #include <cmath>
 #include <limits>
 #include <memory>
@@ -13,6 +14,7 @@
 #include "base/base_switches.h"
 #include "base/bind.h"
 #include "base/command_line.h"
+#include "base/compiler_specific.h"
 #include "base/containers/contains.h"
 #include "base/debug/leak_annotations.h"
 #include "base/location.h"
@@ -20,7 +22,6 @@
 #include "base/memory/ptr_util.h"
 #include "base/memory/raw_ptr.h"
 #include "base/memory/ref_counted_memory.h"
-#include "base/no_destructor.h"
 #include "base/process/process.h"
 #include "base/process/process_metrics.h"
 #include "base/ranges/algorithm.h"
@@ -28,6 +29,7 @@
 #include "base/strings/string_split.h"
 #include "base/strings/string_tokenizer.h"
 #include "base/strings/stringprintf.h"
+#include "base/synchronization/waitable_event.h"
 #include "base/system/sys_info.h"
 #include "base/task/current_thread.h"
 #include "base/task/post_task.h"
@@ -44,8 +46,10 @@
 #include "base/trace_event/memory_dump_provider.h"
 #include "base/trace_event/process_memory_dump.h"
 #include "base/trace_event/thread_instruction_count.h"
+#include "base/trace_event/trace_binary_format.h"
 #include "base/trace_event/trace_buffer.h"
 #include "base/trace_event/trace_event.h"
+#include "base/trace_event/trace_static_keys.h"
 #include "build/build_config.h"
 
 #if BUILDFLAG(USE_PERFETTO_CLIENT_LIBRARY)
@@ -95,7 +99,19 @@ const size_t kTraceEventRingBufferChunks = kTraceEventVectorBufferChunks / 4;
 // ECHO_TO_CONSOLE needs a small buffer to hold the unfinished COMPLETE events.
 const size_t kEchoToConsoleTraceEventBufferChunks = 256;
 
+// RECORD_FLIGHT_RECORDER keeps the last 16K events.
+const size_t kFlightRecorderTraceEventBufferChunks = 256;
+
 const size_t kTraceEventBufferSizeInBytes = 100 * 1024;
+
+// The full chunks that a thread queues until they are returned to the trace
+// buffer, and the most chunks taken from the trace buffer in advance.
+const size_t kThreadChunkRingCapacity = 4;
+const size_t kMaxPooledChunks = 64;
+
+// How often the full chunks are returned and the pool refilled while
+// recording.
+const int kChunkDrainIntervalMs = 10;
 #if !BUILDFLAG(USE_PERFETTO_CLIENT_LIBRARY)
 const int kThreadFlushTimeoutMs = 3000;
 #endif
@@ -492,26 +508,172 @@ class TraceLog::OptionalAutoLock {
   bool locked_ = false;
 };
 
-class TraceLog::ThreadLocalEventBuffer
-    : public CurrentThread::DestructionObserver,
-      public MemoryDumpProvider {
+// The chunks in which a thread adds its events without |lock_|: the one it
+// fills, and the full ones queued until a thread holding |lock_| returns
+// them to the trace buffer. A ring is owned by TraceLog, not by its thread,
+// and is used again by another thread once its thread exits.
+class TraceLog::ThreadChunkRing {
  public:
-  explicit ThreadLocalEventBuffer(TraceLog* trace_log);
-  ThreadLocalEventBuffer(const ThreadLocalEventBuffer&) = delete;
-  ThreadLocalEventBuffer& operator=(const ThreadLocalEventBuffer&) = delete;
-  ~ThreadLocalEventBuffer() override;
+  ThreadChunkRing() : full_chunks_(kThreadChunkRingCapacity) {}
+  ThreadChunkRing(const ThreadChunkRing&) = delete;
+  ThreadChunkRing& operator=(const ThreadChunkRing&) = delete;
+  ~ThreadChunkRing() = default;
+
+  // Takes the ring for the current thread, if no other thread uses it.
+  bool TryAcquire() {
+    bool in_use = false;
+    return !in_use_.load(std::memory_order_relaxed) &&
+           in_use_.compare_exchange_strong(in_use, true,
+                                           std::memory_order_acquire);
+  }
+  void Release() { in_use_.store(false, std::memory_order_release); }
+
+  // The thread of the ring brackets its uses of the chunk being filled
+  // without |lock_| with these. BeginWrite() fails while a thread holding
+  // |lock_| takes the chunk, see TakeChunk().
+  bool BeginWrite() {
+    writing_.store(true, std::memory_order_seq_cst);
+    if (!taking_.load(std::memory_order_seq_cst))
+      return true;
+    writing_.store(false, std::memory_order_release);
+    return false;
+  }
+  void EndWrite() { writing_.store(false, std::memory_order_release); }
+
+  // Called by the thread of the ring, between BeginWrite() and EndWrite() or
+  // with |lock_|. Returns null if the full chunk can't be queued or if no new
+  // chunk is in |pool|, for the caller to retry with |lock_|.
+  TraceEvent* AddTraceEvent(int generation,
+                            TraceBufferChunkPool* pool,
+                            TraceEventHandle* handle) {
+    if (chunk_.chunk && chunk_.generation != generation) {
+      // The chunk was taken from a previous buffer.
+      chunk_.chunk.reset();
+    }
+    if (chunk_.chunk && chunk_.chunk->IsFull() && !full_chunks_.Push(&chunk_))
+      return nullptr;
+    if (!chunk_.chunk && !pool->Pop(&chunk_))
+      return nullptr;
+    if (chunk_.generation != generation) {
+      chunk_.chunk.reset();
+      return nullptr;
+    }
 
-  TraceEvent* AddTraceEvent(TraceEventHandle* handle);
+    size_t event_index;
+    TraceEvent* trace_event = chunk_.chunk->AddTraceEvent(&event_index);
+    if (trace_event && handle)
+      MakeHandle(chunk_.chunk->seq(), chunk_.index, event_index, handle);
+    return trace_event;
+  }
 
+  // Called by the thread of the ring, as AddTraceEvent().
   TraceEvent* GetEventByHandle(TraceEventHandle handle) {
-    if (!chunk_ || handle.chunk_seq != chunk_->seq() ||
-        handle.chunk_index != chunk_index_) {
+    if (!chunk_.chunk || handle.chunk_seq != chunk_.chunk->seq() ||
+        handle.chunk_index != chunk_.index) {
       return nullptr;
     }
+    return chunk_.chunk->GetEventAt(handle.event_index);
+  }
 
-    return chunk_->GetEventAt(handle.event_index);
+  // Called by the thread of the ring, as AddTraceEvent(). Returns false if
+  // the thread has no chunk.
+  bool EstimateTraceMemoryOverhead(TraceEventMemoryOverhead* overhead) {
+    if (!chunk_.chunk)
+      return false;
+    chunk_.chunk->EstimateTraceMemoryOverhead(overhead);
+    return true;
+  }
+
+  // Called with |lock_|, by any thread: moves the chunk being filled into
+  // |*chunk|, once the thread of the ring isn't writing in it.
+  void TakeChunk(InFlightTraceBufferChunk* chunk) {
+    taking_.store(true, std::memory_order_seq_cst);
+    while (writing_.load(std::memory_order_seq_cst))
+      PlatformThread::YieldCurrentThread();
+    *chunk = std::move(chunk_);
+    taking_.store(false, std::memory_order_release);
   }
 
+  // Called with |lock_| by the thread of the ring, to fill |*chunk| next.
+  void SetChunk(InFlightTraceBufferChunk* chunk) {
+    DCHECK(!chunk_.chunk);
+    chunk_ = std::move(*chunk);
+  }
+
+  // Called with |lock_|, by any thread.
+  bool PopFullChunk(InFlightTraceBufferChunk* chunk) {
+    return full_chunks_.Pop(chunk);
+  }
+
+  ThreadChunkRing* next() const { return next_; }
+  void set_next(ThreadChunkRing* next) { next_ = next; }
+
+ private:
+  std::atomic<bool> in_use_{true};
+  std::atomic<bool> writing_{false};
+  std::atomic<bool> taking_{false};
+  InFlightTraceBufferChunk chunk_;
+  TraceBufferChunkRing full_chunks_;
+  // Set before the ring is added to the list of TraceLog.
+  raw_ptr<ThreadChunkRing> next_ = nullptr;
+};
+
+// Returns the full chunks of the threads to the trace buffer and refills the
+// chunk pool, so that the threads which record events don't take |lock_|.
+class TraceLog::ChunkDrainThread : public PlatformThread::Delegate {
+ public:
+  explicit ChunkDrainThread(TraceLog* trace_log) : trace_log_(trace_log) {
+    // Without the thread, the threads take |lock_| to get their chunks.
+    if (!PlatformThread::Create(0, this, &thread_handle_))
+      DLOG(ERROR) << "Failed to create the trace chunk drain thread";
+  }
+  ChunkDrainThread(const ChunkDrainThread&) = delete;
+  ChunkDrainThread& operator=(const ChunkDrainThread&) = delete;
+  ~ChunkDrainThread() override {
+    if (thread_handle_.is_null())
+      return;
+    stopping_.store(true, std::memory_order_relaxed);
+    wake_up_event_.Signal();
+    PlatformThread::Join(thread_handle_);
+  }
+
+  void WakeUp() { wake_up_event_.Signal(); }
+
+ private:
+  // PlatformThread::Delegate:
+  void ThreadMain() override {
+    PlatformThread::SetName("TraceLogChunkDrainThread");
+    while (!stopping_.load(std::memory_order_relaxed)) {
+      bool recording;
+      {
+        AutoLock lock(trace_log_->lock_);
+        trace_log_->ReturnThreadChunksWhileLocked(false);
+        recording = trace_log_->RefillChunkPoolWhileLocked();
+      }
+      if (recording)
+        wake_up_event_.TimedWait(Milliseconds(kChunkDrainIntervalMs));
+      else
+        wake_up_event_.Wait();
+    }
+  }
+
+  const raw_ptr<TraceLog> trace_log_;
+  PlatformThreadHandle thread_handle_;
+  WaitableEvent wake_up_event_;
+  std::atomic<bool> stopping_{false};
+};
+
+// Registers the threads with a message loop to flush them, and reports the
+// memory of their chunk in memory-infra dumps.
+class TraceLog::ThreadLocalEventBuffer
+    : public CurrentThread::DestructionObserver,
+      public MemoryDumpProvider {
+ public:
+  explicit ThreadLocalEventBuffer(TraceLog* trace_log);
+  ThreadLocalEventBuffer(const ThreadLocalEventBuffer&) = delete;
+  ThreadLocalEventBuffer& operator=(const ThreadLocalEventBuffer&) = delete;
+  ~ThreadLocalEventBuffer() override;
+
   int generation() const { return generation_; }
 
  private:
@@ -522,8 +684,6 @@ class TraceLog::ThreadLocalEventBuffer
   bool OnMemoryDump(const MemoryDumpArgs& args,
                     ProcessMemoryDump* pmd) override;
 
-  void FlushWhileLocked();
-
   void CheckThisIsCurrentBuffer() const {
     DCHECK(trace_log_->thread_local_event_buffer_.Get() == this);
   }
@@ -531,8 +691,6 @@ class TraceLog::ThreadLocalEventBuffer
   // Since TraceLog is a leaky singleton, trace_log_ will always be valid
   // as long as the thread exists.
   raw_ptr<TraceLog> trace_log_;
-  std::unique_ptr<TraceBufferChunk> chunk_;
-  size_t chunk_index_ = 0;
   int generation_;
 };
 
@@ -560,68 +718,33 @@ TraceLog::ThreadLocalEventBuffer::~ThreadLocalEventBuffer() {
 
   {
     AutoLock lock(trace_log_->lock_);
-    FlushWhileLocked();
-
     int thread_id = static_cast<int>(PlatformThread::CurrentId());
     trace_log_->thread_task_runners_.erase(thread_id);
   }
   trace_log_->thread_local_event_buffer_.Set(nullptr);
 }
 
-TraceEvent* TraceLog::ThreadLocalEventBuffer::AddTraceEvent(
-    TraceEventHandle* handle) {
-  CheckThisIsCurrentBuffer();
-
-  if (chunk_ && chunk_->IsFull()) {
-    AutoLock lock(trace_log_->lock_);
-    FlushWhileLocked();
-    chunk_.reset();
-  }
-  if (!chunk_) {
-    AutoLock lock(trace_log_->lock_);
-    chunk_ = trace_log_->logged_events_->GetChunk(&chunk_index_);
-    trace_log_->CheckIfBufferIsFullWhileLocked();
-  }
-  if (!chunk_)
-    return nullptr;
-
-  size_t event_index;
-  TraceEvent* trace_event = chunk_->AddTraceEvent(&event_index);
-  if (trace_event && handle)
-    MakeHandle(chunk_->seq(), chunk_index_, event_index, handle);
-
-  return trace_event;
-}
-
 void TraceLog::ThreadLocalEventBuffer::WillDestroyCurrentMessageLoop() {
   delete this;
 }
 
 bool TraceLog::ThreadLocalEventBuffer::OnMemoryDump(const MemoryDumpArgs& args,
                                                     ProcessMemoryDump* pmd) {
-  if (!chunk_)
+  auto* ring =
+      static_cast<ThreadChunkRing*>(trace_log_->thread_chunk_ring_.Get());
+  if (!ring || !ring->BeginWrite())
+    return true;
+  TraceEventMemoryOverhead overhead;
+  const bool has_chunk = ring->EstimateTraceMemoryOverhead(&overhead);
+  ring->EndWrite();
+  if (!has_chunk)
     return true;
   std::string dump_base_name = StringPrintf(
       "tracing/thread_%d", static_cast<int>(PlatformThread::CurrentId()));
-  TraceEventMemoryOverhead overhead;
-  chunk_->EstimateTraceMemoryOverhead(&overhead);
   overhead.DumpInto(dump_base_name.c_str(), pmd);
   return true;
 }
 
-void TraceLog::ThreadLocalEventBuffer::FlushWhileLocked() {
-  if (!chunk_)
-    return;
-
-  trace_log_->lock_.AssertAcquired();
-  if (trace_log_->CheckGeneration(generation_)) {
-    // Return the chunk to the buffer only if the generation matches.
-    trace_log_->logged_events_->ReturnChunk(chunk_index_, std::move(chunk_));
-  }
-  // Otherwise this method may be called from the destructor, or TraceLog will
-  // find the generation mismatch and delete this buffer soon.
-}
-
 void TraceLog::SetAddTraceEventOverrides(
     const AddTraceEventOverrideFunction& add_event_override,
     const OnFlushFunction& on_flush_override,
@@ -645,10 +768,7 @@ TraceLogStatus::TraceLogStatus() : event_capacity(0), event_count(0) {}
 TraceLogStatus::~TraceLogStatus() = default;
 
 // static
-TraceLog* TraceLog::GetInstance() {
-  static base::NoDestructor<TraceLog> instance(0);
-  return instance.get();
-}
+CONSTINIT Lazy<TraceLog> TraceLog::instance_;
 
 // static
 void TraceLog::ResetForTesting() {
@@ -675,6 +795,8 @@ void TraceLog::ResetForTesting() {
 #endif  // !BUILDFLAG(USE_PERFETTO_CLIENT_LIBRARY)
 }
 
+TraceLog::TraceLog() : TraceLog(/*generation=*/0) {}
+
 TraceLog::TraceLog(int generation)
     : enabled_modes_(0),
       num_traces_recorded_(0),
@@ -684,6 +806,7 @@ TraceLog::TraceLog(int generation)
       trace_options_(kInternalRecordUntilFull),
       trace_config_(TraceConfig()),
       thread_shared_chunk_index_(0),
+      chunk_pool_(std::make_unique<TraceBufferChunkPool>(kMaxPooledChunks)),
       generation_(generation),
       use_worker_thread_(false) {
   CategoryRegistry::Initialize();
@@ -696,6 +819,14 @@ TraceLog::TraceLog(int generation)
 
   logged_events_.reset(CreateTraceBuffer());
 
+#if BUILDFLAG(ENABLE_TRACE_STATIC_KEYS)
+  // The sites of the static keys check the state until they're updated.
+  {
+    AutoLock lock(lock_);
+    UpdateCategoryRegistry();
+  }
+#endif
+
   MemoryDumpManager::GetInstance()->RegisterDumpProvider(this, "TraceLog",
                                                          nullptr);
 #if BUILDFLAG(USE_PERFETTO_CLIENT_LIBRARY)
@@ -715,14 +846,22 @@ TraceLog::~TraceLog() {
 #if BUILDFLAG(USE_PERFETTO_CLIENT_LIBRARY)
   perfetto::TrackEvent::RemoveSessionObserver(this);
 #endif  // BUILDFLAG(USE_PERFETTO_CLIENT_LIBRARY)
+  // Stop the drain thread before deleting the rings it drains.
+  chunk_drain_thread_.reset();
+  ThreadChunkRing* ring = thread_chunk_rings_.load(std::memory_order_acquire);
+  while (ring) {
+    ThreadChunkRing* next = ring->next();
+    delete ring;
+    ring = next;
+  }
 }
 
 void TraceLog::InitializeThreadLocalEventBufferIfSupported() {
   // A ThreadLocalEventBuffer needs the message loop with a task runner
   // - to know when the thread exits;
   // - to handle the final flush.
-  // For a thread without a message loop or if the message loop may be blocked,
-  // the trace events will be added into the main buffer directly.
+  // A thread without a message loop or whose message loop may be blocked
+  // records its events in its chunk ring all the same.
   if (thread_blocks_message_loop_.Get() || !CurrentThread::IsSet() ||
       !ThreadTaskRunnerHandle::IsSet()) {
     return;
@@ -740,6 +879,35 @@ void TraceLog::InitializeThreadLocalEventBufferIfSupported() {
   }
 }
 
+TraceLog::ThreadChunkRing* TraceLog::GetOrCreateThreadChunkRing() {
+  auto* ring = static_cast<ThreadChunkRing*>(thread_chunk_ring_.Get());
+  if (ring)
+    return ring;
+
+  // Use the ring of an exited thread, or add a new one to the list.
+  ThreadChunkRing* head = thread_chunk_rings_.load(std::memory_order_acquire);
+  for (ring = head; ring; ring = ring->next()) {
+    if (ring->TryAcquire())
+      break;
+  }
+  if (!ring) {
+    HEAP_PROFILER_SCOPED_IGNORE;
+    ring = new ThreadChunkRing();
+    do {
+      ring->set_next(head);
+    } while (!thread_chunk_rings_.compare_exchange_weak(
+        head, ring, std::memory_order_release, std::memory_order_acquire));
+  }
+  thread_chunk_ring_.Set(ring);
+  return ring;
+}
+
+// static
+void TraceLog::ReleaseThreadChunkRing(void* ring) {
+  // The chunk being filled stays in the ring, where the flush finds it.
+  static_cast<ThreadChunkRing*>(ring)->Release();
+}
+
 bool TraceLog::OnMemoryDump(const MemoryDumpArgs& args,
                             ProcessMemoryDump* pmd) {
   // TODO(ssid): Use MemoryDumpArgs to create light dumps when requested
@@ -835,6 +1003,15 @@ void TraceLog::UpdateCategoryState(TraceCategory* category) {
   }
   category->set_enabled_filters(enabled_filters_bitmap);
   category->set_state(state_flags);
+
+#if BUILDFLAG(ENABLE_TRACE_STATIC_KEYS)
+  const size_t category_index =
+      static_cast<size_t>(category - CategoryRegistry::categories_);
+  if (category_index < BuiltinCategories::Size()) {
+    TraceStaticKeys::Update(static_cast<uint32_t>(category_index),
+                            state_flags != 0);
+  }
+#endif
 }
 
 void TraceLog::UpdateCategoryRegistry() {
@@ -920,6 +1097,7 @@ void TraceLog::SetEnabled(const TraceConfig& trace_config,
           perfetto::TraceConfig::BufferConfig::DISCARD);
       break;
     case base::trace_event::RECORD_CONTINUOUSLY:
+    case base::trace_event::RECORD_FLIGHT_RECORDER:
       buffer_config->set_fill_policy(
           perfetto::TraceConfig::BufferConfig::RING_BUFFER);
       break;
@@ -1144,6 +1322,8 @@ TraceLog::InternalTraceOptions TraceLog::GetInternalOptionsFromTraceConfig(
       return ret | kInternalEchoToConsole;
     case RECORD_AS_MUCH_AS_POSSIBLE:
       return ret | kInternalRecordAsMuchAsPossible;
+    case RECORD_FLIGHT_RECORDER:
+      return ret | kInternalFlightRecorder;
   }
   NOTREACHED();
   return kInternalNone;
@@ -1216,6 +1396,11 @@ void TraceLog::SetDisabledWhileLocked(uint8_t modes_to_disable) {
   if (!is_recording_mode_disabled)
     return;
 
+  // Give the chunks taken in advance back to the buffer before the metadata
+  // events are added, which may need them with a ring buffer.
+  ReturnThreadChunksWhileLocked(false);
+  ReturnPooledChunksWhileLocked();
+
   AddMetadataEventsWhileLocked();
 
   // Remove metadata events so they will not get added to a subsequent trace.
@@ -1324,8 +1509,7 @@ bool TraceLog::BufferIsFull() const {
 }
 
 TraceEvent* TraceLog::AddEventToThreadSharedChunkWhileLocked(
-    TraceEventHandle* handle,
-    bool check_buffer_is_full) {
+    TraceEventHandle* handle) {
   if (thread_shared_chunk_ && thread_shared_chunk_->IsFull()) {
     logged_events_->ReturnChunk(thread_shared_chunk_index_,
                                 std::move(thread_shared_chunk_));
@@ -1334,8 +1518,6 @@ TraceEvent* TraceLog::AddEventToThreadSharedChunkWhileLocked(
   if (!thread_shared_chunk_) {
     thread_shared_chunk_ =
         logged_events_->GetChunk(&thread_shared_chunk_index_);
-    if (check_buffer_is_full)
-      CheckIfBufferIsFullWhileLocked();
   }
   if (!thread_shared_chunk_)
     return nullptr;
@@ -1358,6 +1540,105 @@ void TraceLog::CheckIfBufferIsFullWhileLocked() {
   }
 }
 
+TraceEvent* TraceLog::AddEventToThreadChunkRingWhileLocked(
+    ThreadChunkRing* ring,
+    TraceEventHandle* handle) {
+  // This thread owns the ring, and the other threads only take its chunk
+  // with |lock_|.
+  InFlightTraceBufferChunk chunk;
+  ring->TakeChunk(&chunk);
+  if (chunk.chunk && chunk.chunk->IsFull())
+    ReturnThreadChunkWhileLocked(&chunk);
+  InFlightTraceBufferChunk full_chunk;
+  while (ring->PopFullChunk(&full_chunk))
+    ReturnThreadChunkWhileLocked(&full_chunk);
+
+  if (chunk.chunk && chunk.generation != generation())
+    chunk.chunk.reset();
+  while (!chunk.chunk && chunk_pool_->Pop(&chunk)) {
+    if (chunk.generation != generation())
+      chunk.chunk.reset();
+  }
+  if (!chunk.chunk) {
+    chunk.chunk = logged_events_->GetChunk(&chunk.index);
+    chunk.generation = generation();
+    RequestPooledChunksWhileLocked();
+    CheckIfBufferIsFullWhileLocked();
+  }
+  if (!chunk.chunk)
+    return nullptr;
+
+  ring->SetChunk(&chunk);
+  return ring->AddTraceEvent(generation(), chunk_pool_.get(), handle);
+}
+
+void TraceLog::ReturnThreadChunkWhileLocked(InFlightTraceBufferChunk* chunk) {
+  if (CheckGeneration(chunk->generation))
+    logged_events_->ReturnChunk(chunk->index, std::move(chunk->chunk));
+  else
+    chunk->chunk.reset();
+}
+
+void TraceLog::ReturnThreadChunksWhileLocked(bool take_current_chunks) {
+  InFlightTraceBufferChunk chunk;
+  for (ThreadChunkRing* ring =
+           thread_chunk_rings_.load(std::memory_order_acquire);
+       ring; ring = ring->next()) {
+    while (ring->PopFullChunk(&chunk))
+      ReturnThreadChunkWhileLocked(&chunk);
+    if (take_current_chunks) {
+      ring->TakeChunk(&chunk);
+      if (chunk.chunk)
+        ReturnThreadChunkWhileLocked(&chunk);
+    }
+  }
+}
+
+void TraceLog::ReturnPooledChunksWhileLocked() {
+  chunk_pool_target_size_ = 0;
+  InFlightTraceBufferChunk chunk;
+  while (chunk_pool_->Pop(&chunk))
+    ReturnThreadChunkWhileLocked(&chunk);
+}
+
+bool TraceLog::RefillChunkPoolWhileLocked() {
+  if (!(enabled_modes_ & RECORDING_MODE))
+    return false;
+  // Stop when the buffer is full, so that it's a thread which finds it full
+  // and disables recording, once the pool is empty.
+  while (chunk_pool_->ApproximateSize() < chunk_pool_target_size_ &&
+         !logged_events_->IsFull()) {
+    InFlightTraceBufferChunk chunk;
+    chunk.chunk = logged_events_->GetChunk(&chunk.index);
+    if (!chunk.chunk)
+      break;
+    chunk.generation = generation();
+    if (!chunk_pool_->Push(&chunk)) {
+      ReturnThreadChunkWhileLocked(&chunk);
+      break;
+    }
+  }
+  return true;
+}
+
+void TraceLog::RequestPooledChunksWhileLocked() {
+  // Keep the pool to a small share of the buffer: a ring buffer recycles its
+  // oldest chunks to fill it, so their events are dropped earlier.
+  const size_t max_pooled_chunks =
+      std::min(kMaxPooledChunks,
+               logged_events_->Capacity() / kTraceBufferChunkSize / 16);
+  chunk_pool_target_size_ =
+      std::min(chunk_pool_target_size_ + 2, max_pooled_chunks);
+  if (!chunk_pool_target_size_)
+    return;
+  if (!chunk_drain_thread_) {
+    HEAP_PROFILER_SCOPED_IGNORE;
+    chunk_drain_thread_ = std::make_unique<ChunkDrainThread>(this);
+  } else {
+    chunk_drain_thread_->WakeUp();
+  }
+}
+
 // Flush() works as the following:
 // 1. Flush() is called in thread A whose task runner is saved in
 //    flush_task_runner_;
@@ -1370,22 +1651,34 @@ void TraceLog::CheckIfBufferIsFullWhileLocked() {
 // 4. If any thread hasn't finish its flush in time, finish the flush.
 void TraceLog::Flush(const TraceLog::OutputCallback& cb,
                      bool use_worker_thread) {
-  FlushInternal(cb, use_worker_thread, false);
+  FlushInternal(cb, use_worker_thread, false, File());
+}
+
+void TraceLog::FlushToBinaryFile(File file,
+                                 const TraceLog::OutputCallback& cb,
+                                 bool use_worker_thread) {
+  DCHECK(file.IsValid());
+  FlushInternal(cb, use_worker_thread, false, std::move(file));
 }
 
 void TraceLog::CancelTracing(const OutputCallback& cb) {
   SetDisabled();
-  FlushInternal(cb, false, true);
+  FlushInternal(cb, false, true, File());
 }
 
 void TraceLog::FlushInternal(const TraceLog::OutputCallback& cb,
                              bool use_worker_thread,
-                             bool discard_events) {
+                             bool discard_events,
+                             File binary_file) {
   use_worker_thread_ = use_worker_thread;
 
 #if BUILDFLAG(USE_PERFETTO_CLIENT_LIBRARY) && !BUILDFLAG(IS_NACL)
   perfetto::TrackEvent::Flush();
 
+  // The events are in the Perfetto buffers, not in a TraceBuffer.
+  LOG_IF(WARNING, binary_file.IsValid())
+      << "Binary traces need the TraceLog buffer, flushing JSON";
+
   if (discard_events) {
     tracing_session_.reset();
     scoped_refptr<RefCountedString> empty_result = new RefCountedString;
@@ -1451,7 +1744,9 @@ void TraceLog::FlushInternal(const TraceLog::OutputCallback& cb,
                              : nullptr;
     DCHECK(thread_task_runners_.empty() || flush_task_runner_);
     flush_output_callback_ = cb;
+    flush_binary_file_ = std::move(binary_file);
 
+    ReturnThreadChunksWhileLocked(true);
     if (thread_shared_chunk_) {
       logged_events_->ReturnChunk(thread_shared_chunk_index_,
                                   std::move(thread_shared_chunk_));
@@ -1542,9 +1837,98 @@ void TraceLog::ConvertTraceEventsToTraceFormat(
   flush_output_callback.Run(json_events_str_ptr, false);
 }
 
+// Usually it runs on a different thread.
+void TraceLog::ConvertTraceEventsToBinaryFormat(
+    std::unique_ptr<TraceBuffer> logged_events,
+    File file,
+    int process_id,
+    const OutputCallback& flush_output_callback,
+    const ArgumentFilterPredicate& argument_filter_predicate) {
+  HEAP_PROFILER_SCOPED_IGNORE;
+  TraceBinaryWriter writer(std::move(file), process_id);
+  while (const TraceBufferChunk* chunk = logged_events->NextChunk()) {
+    for (size_t j = 0; j < chunk->size(); ++j)
+      writer.AppendEvent(*chunk->GetEventAt(j), argument_filter_predicate);
+  }
+  LOG_IF(ERROR, !writer.Finish()) << "Failed to write the binary trace";
+
+  if (!flush_output_callback.is_null()) {
+    scoped_refptr<RefCountedString> empty_result = new RefCountedString;
+    flush_output_callback.Run(empty_result, false);
+  }
+}
+
+bool TraceLog::SnapshotFlightRecorder(const FilePath& path) {
+#if BUILDFLAG(USE_PERFETTO_CLIENT_LIBRARY)
+  // The events are in the Perfetto buffers, not in a TraceBuffer.
+  return false;
+#else
+  std::unique_ptr<TraceBuffer> snapshot;
+  ArgumentFilterPredicate argument_filter_predicate;
+  {
+    AutoLock lock(lock_);
+    if (!(enabled_modes_ & RECORDING_MODE) ||
+        !(trace_options() & kInternalFlightRecorder)) {
+      return false;
+    }
+
+    // Take all the chunks, as FinishFlush() does, and record in a new buffer.
+    // The chunks the threads fill next are of the new generation.
+    ReturnThreadChunksWhileLocked(true);
+    ReturnPooledChunksWhileLocked();
+    if (thread_shared_chunk_) {
+      logged_events_->ReturnChunk(thread_shared_chunk_index_,
+                                  std::move(thread_shared_chunk_));
+    }
+    snapshot.swap(logged_events_);
+    UseNextTraceBuffer();
+    argument_filter_predicate = GetFlushArgumentFilterPredicateWhileLocked();
+  }
+
+  base::ThreadPool::PostTask(
+      FROM_HERE,
+      {MayBlock(), TaskPriority::USER_VISIBLE,
+       TaskShutdownBehavior::CONTINUE_ON_SHUTDOWN},
+      BindOnce(&TraceLog::WriteFlightRecorderSnapshot, std::move(snapshot),
+               path, process_id(), argument_filter_predicate));
+  return true;
+#endif  // BUILDFLAG(USE_PERFETTO_CLIENT_LIBRARY)
+}
+
+// static
+void TraceLog::WriteFlightRecorderSnapshot(
+    std::unique_ptr<TraceBuffer> logged_events,
+    const FilePath& path,
+    int process_id,
+    const ArgumentFilterPredicate& argument_filter_predicate) {
+  File file(path, File::FLAG_CREATE_ALWAYS | File::FLAG_WRITE);
+  if (!file.IsValid()) {
+    LOG(ERROR) << "Failed to create the flight recorder snapshot "
+               << path.value() << ": "
+               << File::ErrorToString(file.error_details());
+    return;
+  }
+  ConvertTraceEventsToBinaryFormat(std::move(logged_events), std::move(file),
+                                   process_id, OutputCallback(),
+                                   argument_filter_predicate);
+}
+
+ArgumentFilterPredicate TraceLog::GetFlushArgumentFilterPredicateWhileLocked()
+    const {
+  lock_.AssertAcquired();
+  if (!(trace_options() & kInternalEnableArgumentFilter))
+    return ArgumentFilterPredicate();
+  // If argument filtering is activated and there is no filtering predicate,
+  // use the safe default filtering predicate.
+  if (argument_filter_predicate_.is_null())
+    return base::BindRepeating(&DefaultIsTraceEventArgsAllowlisted);
+  return argument_filter_predicate_;
+}
+
 void TraceLog::FinishFlush(int generation, bool discard_events) {
   std::unique_ptr<TraceBuffer> previous_logged_events;
   OutputCallback flush_output_callback;
+  File binary_file;
   ArgumentFilterPredicate argument_filter_predicate;
 
   if (!CheckGeneration(generation))
@@ -1553,6 +1937,9 @@ void TraceLog::FinishFlush(int generation, bool discard_events) {
   {
     AutoLock lock(lock_);
 
+    // The threads may have added events since FlushInternal().
+    ReturnThreadChunksWhileLocked(true);
+    ReturnPooledChunksWhileLocked();
     previous_logged_events.swap(logged_events_);
     UseNextTraceBuffer();
     thread_task_runners_.clear();
@@ -1560,17 +1947,8 @@ void TraceLog::FinishFlush(int generation, bool discard_events) {
     flush_task_runner_ = nullptr;
     flush_output_callback = flush_output_callback_;
     flush_output_callback_.Reset();
-
-    if (trace_options() & kInternalEnableArgumentFilter) {
-      // If argument filtering is activated and there is no filtering predicate,
-      // use the safe default filtering predicate.
-      if (argument_filter_predicate_.is_null()) {
-        argument_filter_predicate =
-            base::BindRepeating(&DefaultIsTraceEventArgsAllowlisted);
-      } else {
-        argument_filter_predicate = argument_filter_predicate_;
-      }
-    }
+    binary_file = std::move(flush_binary_file_);
+    argument_filter_predicate = GetFlushArgumentFilterPredicateWhileLocked();
   }
 
   if (discard_events) {
@@ -1581,6 +1959,24 @@ void TraceLog::FinishFlush(int generation, bool discard_events) {
     return;
   }
 
+  if (binary_file.IsValid()) {
+    if (use_worker_thread_) {
+      base::ThreadPool::PostTask(
+          FROM_HERE,
+          {MayBlock(), TaskPriority::BEST_EFFORT,
+           TaskShutdownBehavior::CONTINUE_ON_SHUTDOWN},
+          BindOnce(&TraceLog::ConvertTraceEventsToBinaryFormat,
+                   std::move(previous_logged_events), std::move(binary_file),
+                   process_id(), flush_output_callback,
+                   argument_filter_predicate));
+      return;
+    }
+    ConvertTraceEventsToBinaryFormat(
+        std::move(previous_logged_events), std::move(binary_file),
+        process_id(), flush_output_callback, argument_filter_predicate);
+    return;
+  }
+
   if (use_worker_thread_) {
     base::ThreadPool::PostTask(
         FROM_HERE,
@@ -1607,7 +2003,8 @@ void TraceLog::FlushCurrentThread(int generation, bool discard_events) {
     }
   }
 
-  // This will flush the thread local buffer.
+  // The chunks of the thread were returned by FlushInternal(), this only
+  // unregisters the thread.
   delete thread_local_event_buffer_.Get();
 
   auto on_flush_override = on_flush_override_.load(std::memory_order_relaxed);
@@ -1658,6 +2055,8 @@ void TraceLog::UseNextTraceBuffer() {
   generation_.fetch_add(1, std::memory_order_relaxed);
   thread_shared_chunk_.reset();
   thread_shared_chunk_index_ = 0;
+  // Delete the chunks of the previous buffer.
+  ReturnPooledChunksWhileLocked();
 }
 
 bool TraceLog::ShouldAddAfterUpdatingState(
@@ -1904,12 +2303,22 @@ TraceEventHandle TraceLog::AddTraceEventWithThreadIdAndTimestamps(
       !disabled_by_filters) {
     OptionalAutoLock lock(&lock_);
 
+    // The event is added in the chunk of the thread without |lock_|, unless
+    // the thread has to return its full chunks or get a new chunk itself.
+    ThreadChunkRing* ring = GetOrCreateThreadChunkRing();
+    bool writing = ring->BeginWrite();
     TraceEvent* trace_event = nullptr;
-    if (thread_local_event_buffer) {
-      trace_event = thread_local_event_buffer->AddTraceEvent(&handle);
-    } else {
+    if (writing) {
+      trace_event =
+          ring->AddTraceEvent(generation(), chunk_pool_.get(), &handle);
+      if (!trace_event) {
+        ring->EndWrite();
+        writing = false;
+      }
+    }
+    if (!trace_event) {
       lock.EnsureAcquired();
-      trace_event = AddEventToThreadSharedChunkWhileLocked(&handle, true);
+      trace_event = AddEventToThreadChunkRingWhileLocked(ring, &handle);
     }
 
     // NO_THREAD_SAFETY_ANALYSIS: Conditional locking above.
@@ -1933,6 +2342,8 @@ TraceEventHandle TraceLog::AddTraceEventWithThreadIdAndTimestamps(
           phase == TRACE_EVENT_PHASE_COMPLETE ? TRACE_EVENT_PHASE_BEGIN : phase,
           timestamp, trace_event);
     }
+    if (writing)
+      ring->EndWrite();
   }
 
   if (!console_message.empty())
@@ -2079,7 +2490,9 @@ void TraceLog::UpdateTraceEventDurationExplicit(
   if (category_group_enabled_local & TraceCategory::ENABLED_FOR_RECORDING) {
     OptionalAutoLock lock(&lock_);
 
-    TraceEvent* trace_event = GetEventByHandleInternal(handle, &lock);
+    ThreadChunkRing* writing_ring = nullptr;
+    TraceEvent* trace_event =
+        GetEventByHandleInternal(handle, &lock, &writing_ring);
     if (trace_event) {
       DCHECK(trace_event->phase() == TRACE_EVENT_PHASE_COMPLETE);
 
@@ -2093,6 +2506,8 @@ void TraceLog::UpdateTraceEventDurationExplicit(
       console_message =
           EventToConsoleMessage(TRACE_EVENT_PHASE_END, now, trace_event);
     }
+    if (writing_ring)
+      writing_ring->EndWrite();
   }
 
   if (!console_message.empty())
@@ -2120,7 +2535,7 @@ void TraceLog::AddMetadataEventWhileLocked(int thread_id,
     trace_event_override(&trace_event, /*thread_will_flush=*/true, nullptr);
   } else {
     InitializeMetadataEvent(
-        AddEventToThreadSharedChunkWhileLocked(nullptr, false), thread_id,
+        AddEventToThreadSharedChunkWhileLocked(nullptr), thread_id,
         metadata_name, arg_name, value);
   }
 }
@@ -2138,9 +2553,9 @@ void TraceLog::AddMetadataEventsWhileLocked() {
     }
   } else {
     while (!metadata_events_.empty()) {
-      TraceEvent* event =
-          AddEventToThreadSharedChunkWhileLocked(nullptr, false);
-      *event = std::move(*metadata_events_.back());
+      TraceEvent* event = AddEventToThreadSharedChunkWhileLocked(nullptr);
+      if (event)
+        *event = std::move(*metadata_events_.back());
       metadata_events_.pop_back();
     }
   }
@@ -2194,11 +2609,17 @@ void TraceLog::AddMetadataEventsWhileLocked() {
 }
 
 TraceEvent* TraceLog::GetEventByHandle(TraceEventHandle handle) {
-  return GetEventByHandleInternal(handle, nullptr);
+  ThreadChunkRing* writing_ring = nullptr;
+  TraceEvent* trace_event =
+      GetEventByHandleInternal(handle, nullptr, &writing_ring);
+  if (writing_ring)
+    writing_ring->EndWrite();
+  return trace_event;
 }
 
 TraceEvent* TraceLog::GetEventByHandleInternal(TraceEventHandle handle,
-                                               OptionalAutoLock* lock)
+                                               OptionalAutoLock* lock,
+                                               ThreadChunkRing** writing_ring)
     NO_THREAD_SAFETY_ANALYSIS {
   if (!handle.chunk_seq)
     return nullptr;
@@ -2207,18 +2628,28 @@ TraceEvent* TraceLog::GetEventByHandleInternal(TraceEventHandle handle,
   DCHECK(handle.chunk_index <= TraceBufferChunk::kMaxChunkIndex);
   DCHECK(handle.event_index <= TraceBufferChunk::kTraceBufferChunkSize - 1);
 
-  if (thread_local_event_buffer_.Get()) {
-    TraceEvent* trace_event =
-        thread_local_event_buffer_.Get()->GetEventByHandle(handle);
-    if (trace_event)
+  auto* ring = static_cast<ThreadChunkRing*>(thread_chunk_ring_.Get());
+  if (ring && ring->BeginWrite()) {
+    TraceEvent* trace_event = ring->GetEventByHandle(handle);
+    if (trace_event) {
+      *writing_ring = ring;
       return trace_event;
+    }
+    ring->EndWrite();
   }
 
-  // The event has been out-of-control of the thread local buffer.
+  // The event has been out-of-control of the thread.
   // Try to get the event from the main buffer with a lock.
   // NO_THREAD_SAFETY_ANALYSIS: runtime-dependent locking here.
-  if (lock)
+  if (lock) {
     lock->EnsureAcquired();
+    if (ring) {
+      // The event may be in a full chunk of the thread not returned yet.
+      InFlightTraceBufferChunk chunk;
+      while (ring->PopFullChunk(&chunk))
+        ReturnThreadChunkWhileLocked(&chunk);
+    }
+  }
 
   if (thread_shared_chunk_ &&
       handle.chunk_index == thread_shared_chunk_index_) {
@@ -2292,7 +2723,8 @@ size_t TraceLog::GetObserverCountForTest() const {
 
 void TraceLog::SetCurrentThreadBlocksMessageLoop() {
   thread_blocks_message_loop_.Set(true);
-  // This will flush the thread local buffer.
+  // The events of the thread are still recorded in its chunk ring, which the
+  // flush takes without running a task on the thread.
   delete thread_local_event_buffer_.Get();
 }
 
@@ -2311,6 +2743,11 @@ TraceBuffer* TraceLog::CreateTraceBuffer() {
         config_buffer_chunks > 0 ? config_buffer_chunks
                                  : kEchoToConsoleTraceEventBufferChunks);
   }
+  if (options & kInternalFlightRecorder) {
+    return TraceBuffer::CreateTraceBufferRingBuffer(
+        config_buffer_chunks > 0 ? config_buffer_chunks
+                                 : kFlightRecorderTraceEventBufferChunks);
+  }
   if (options & kInternalRecordAsMuchAsPossible) {
     return TraceBuffer::CreateTraceBufferVectorOfSize(
         config_buffer_chunks > 0 ? config_buffer_chunks
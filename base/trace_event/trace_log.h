@@ -16,11 +16,13 @@
 #include <vector>
 
 #include "base/containers/stack.h"
+#include "base/files/file.h"
 #include "base/gtest_prod_util.h"
 #include "base/memory/scoped_refptr.h"
-#include "base/no_destructor.h"
+#include "base/lazy.h"
 #include "base/task/single_thread_task_runner.h"
 #include "base/threading/platform_thread.h"
+#include "base/threading/thread_local_storage.h"
 #include "base/time/time_override.h"
 #include "base/trace_event/category_registry.h"
 #include "base/trace_event/memory_dump_provider.h"
@@ -47,10 +49,12 @@ namespace trace_event {
 struct TraceCategory;
 class TraceBuffer;
 class TraceBufferChunk;
+class TraceBufferChunkPool;
 class TraceEvent;
 class TraceEventFilter;
 class TraceEventMemoryOverhead;
 class JsonStringOutputWriter;
+struct InFlightTraceBufferChunk;
 
 struct BASE_EXPORT TraceLogStatus {
   TraceLogStatus();
@@ -75,7 +79,7 @@ class BASE_EXPORT TraceLog :
     FILTERING_MODE = 1 << 1
   };
 
-  static TraceLog* GetInstance();
+  static TraceLog* GetInstance() { return instance_.get(); }
 
   TraceLog(const TraceLog&) = delete;
   TraceLog& operator=(const TraceLog&) = delete;
@@ -242,6 +246,20 @@ class BASE_EXPORT TraceLog :
                                    bool has_more_events)>;
   void Flush(const OutputCallback& cb, bool use_worker_thread = false);
 
+  // Like Flush(), but writes the events to |file| in the binary format of
+  // TraceBinaryWriter, which ConvertBinaryTraceToJSON() converts back. The
+  // callback is called once with an empty string when the file is written.
+  void FlushToBinaryFile(File file,
+                         const OutputCallback& cb,
+                         bool use_worker_thread = false);
+
+  // When recording with RECORD_FLIGHT_RECORDER, writes the events recorded so
+  // far to |path| in the format of FlushToBinaryFile(), from a ThreadPool
+  // task, and goes on recording in an empty buffer. Can be called on any
+  // thread, e.g. by a hang or latency spike detector. Returns false if the
+  // flight recorder isn't recording.
+  bool SnapshotFlightRecorder(const FilePath& path);
+
   // Cancels tracing and discards collected data.
   void CancelTracing(const OutputCallback& cb);
 
@@ -479,7 +497,7 @@ class BASE_EXPORT TraceLog :
                            TraceRecordAsMuchAsPossibleMode);
   FRIEND_TEST_ALL_PREFIXES(TraceEventTestFixture, ConfigTraceBufferLimit);
 
-  friend class base::NoDestructor<TraceLog>;
+  friend class base::Lazy<TraceLog>;
 
   // MemoryDumpProvider implementation.
   bool OnMemoryDump(const MemoryDumpArgs& args,
@@ -499,9 +517,12 @@ class BASE_EXPORT TraceLog :
       const TraceConfig& config);
 
   class ThreadLocalEventBuffer;
+  class ThreadChunkRing;
+  class ChunkDrainThread;
   class OptionalAutoLock;
   struct RegisteredAsyncObserver;
 
+  TraceLog();
   explicit TraceLog(int generation);
   ~TraceLog() override;
   void AddMetadataEventsWhileLocked() EXCLUSIVE_LOCKS_REQUIRED(lock_);
@@ -523,18 +544,53 @@ class BASE_EXPORT TraceLog :
                                     const TimeTicks& timestamp,
                                     TraceEvent* trace_event);
 
-  TraceEvent* AddEventToThreadSharedChunkWhileLocked(TraceEventHandle* handle,
-                                                     bool check_buffer_is_full)
+  TraceEvent* AddEventToThreadSharedChunkWhileLocked(TraceEventHandle* handle)
       EXCLUSIVE_LOCKS_REQUIRED(lock_);
   void CheckIfBufferIsFullWhileLocked() EXCLUSIVE_LOCKS_REQUIRED(lock_);
   void SetDisabledWhileLocked(uint8_t modes) EXCLUSIVE_LOCKS_REQUIRED(lock_);
 
+  // Returns the chunk ring of the current thread, taking one without a lock
+  // if the thread has none yet.
+  ThreadChunkRing* GetOrCreateThreadChunkRing();
+  // Releases the chunk ring of an exiting thread, for another thread to take.
+  static void ReleaseThreadChunkRing(void* ring);
+
+  // Adds an event in the chunk of |ring| when that couldn't be done without
+  // |lock_|: returns the full chunks of |ring| and takes a new chunk from
+  // |chunk_pool_|, or from |logged_events_| if the pool is empty.
+  TraceEvent* AddEventToThreadChunkRingWhileLocked(ThreadChunkRing* ring,
+                                                   TraceEventHandle* handle)
+      EXCLUSIVE_LOCKS_REQUIRED(lock_);
+  // Returns |chunk| to |logged_events_|, or deletes it if it was taken from a
+  // previous buffer.
+  void ReturnThreadChunkWhileLocked(InFlightTraceBufferChunk* chunk)
+      EXCLUSIVE_LOCKS_REQUIRED(lock_);
+  // Returns the full chunks of all the threads to |logged_events_|, and those
+  // which are being filled too if |take_current_chunks|.
+  void ReturnThreadChunksWhileLocked(bool take_current_chunks)
+      EXCLUSIVE_LOCKS_REQUIRED(lock_);
+  // Returns the chunks of |chunk_pool_| to |logged_events_|, and stops
+  // refilling it until a thread runs out of chunks again.
+  void ReturnPooledChunksWhileLocked() EXCLUSIVE_LOCKS_REQUIRED(lock_);
+  // Takes chunks from |logged_events_| until |chunk_pool_| has its target
+  // size. Returns false if it needs no chunks because recording is disabled.
+  bool RefillChunkPoolWhileLocked() EXCLUSIVE_LOCKS_REQUIRED(lock_);
+  // Called when a thread found |chunk_pool_| empty: grows its target size, and
+  // starts or wakes up |chunk_drain_thread_| to refill it.
+  void RequestPooledChunksWhileLocked() EXCLUSIVE_LOCKS_REQUIRED(lock_);
+
+  // If the event is in the chunk that the current thread is filling, returns
+  // it with |*writing_ring| set to the ring of the thread, on which EndWrite()
+  // must be called once done with the event. Otherwise, looks for it in
+  // |logged_events_| with |lock|.
   TraceEvent* GetEventByHandleInternal(TraceEventHandle handle,
-                                       OptionalAutoLock* lock);
+                                       OptionalAutoLock* lock,
+                                       ThreadChunkRing** writing_ring);
 
   void FlushInternal(const OutputCallback& cb,
                      bool use_worker_thread,
-                     bool discard_events);
+                     bool discard_events,
+                     File binary_file);
 
 #if BUILDFLAG(USE_PERFETTO_CLIENT_LIBRARY)
   tracing::PerfettoPlatform* GetOrCreatePerfettoPlatform();
@@ -549,6 +605,18 @@ class BASE_EXPORT TraceLog :
       std::unique_ptr<TraceBuffer> logged_events,
       const TraceLog::OutputCallback& flush_output_callback,
       const ArgumentFilterPredicate& argument_filter_predicate);
+  static void ConvertTraceEventsToBinaryFormat(
+      std::unique_ptr<TraceBuffer> logged_events,
+      File file,
+      int process_id,
+      const TraceLog::OutputCallback& flush_output_callback,
+      const ArgumentFilterPredicate& argument_filter_predicate);
+  static void WriteFlightRecorderSnapshot(
+      std::unique_ptr<TraceBuffer> logged_events,
+      const FilePath& path,
+      int process_id,
+      const ArgumentFilterPredicate& argument_filter_predicate);
+  ArgumentFilterPredicate GetFlushArgumentFilterPredicateWhileLocked() const;
   void FinishFlush(int generation, bool discard_events);
   void OnFlushTimeout(int generation, bool discard_events);
 
@@ -576,6 +644,10 @@ class BASE_EXPORT TraceLog :
   static const InternalTraceOptions kInternalEchoToConsole;
   static const InternalTraceOptions kInternalRecordAsMuchAsPossible;
   static const InternalTraceOptions kInternalEnableArgumentFilter;
+  static const InternalTraceOptions kInternalFlightRecorder;
+
+  // Read inline by GetInstance(), which is called for most trace events.
+  static Lazy<TraceLog> instance_;
 
   // This lock protects TraceLog member accesses (except for members protected
   // by thread_info_lock_) from arbitrary threads.
@@ -636,13 +708,28 @@ class BASE_EXPORT TraceLog :
   std::unordered_map<int, scoped_refptr<SingleThreadTaskRunner>>
       thread_task_runners_;
 
-  // For events which can't be added into the thread local buffer, e.g. events
-  // from threads without a message loop.
+  // For the metadata events, added by the thread which disables recording.
   std::unique_ptr<TraceBufferChunk> thread_shared_chunk_;
   size_t thread_shared_chunk_index_;
 
+  // The chunk rings of the threads: a list which only grows, without a lock,
+  // until TraceLog is deleted. |thread_chunk_ring_| is that of the current
+  // thread.
+  std::atomic<ThreadChunkRing*> thread_chunk_rings_{nullptr};
+  ThreadLocalStorage::Slot thread_chunk_ring_{&ReleaseThreadChunkRing};
+
+  // The chunks taken from |logged_events_| in advance for the threads, up to
+  // |chunk_pool_target_size_|, by |chunk_drain_thread_|. The thread also
+  // returns the full chunks of the threads to |logged_events_|. It is started
+  // when a thread first finds the pool empty.
+  const std::unique_ptr<TraceBufferChunkPool> chunk_pool_;
+  size_t chunk_pool_target_size_ = 0;
+  std::unique_ptr<ChunkDrainThread> chunk_drain_thread_;
+
   // Set when asynchronous Flush is in progress.
   OutputCallback flush_output_callback_;
+  // Valid when the flush in progress writes a binary trace.
+  File flush_binary_file_;
   scoped_refptr<SequencedTaskRunner> flush_task_runner_;
   ArgumentFilterPredicate argument_filter_predicate_;
   MetadataFilterPredicate metadata_filter_predicate_;
@@ -0,0 +1,195 @@
+// Copyright 2022 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "base/trace_event/trace_static_keys.h"
+
+#if BUILDFLAG(ENABLE_TRACE_STATIC_KEYS)
+#include <string.h>
+#include <sys/mman.h>
+
+#include <algorithm>
+#include <vector>
+
+#include "base/logging.h"
+#include "base/memory/page_size.h"
+#include "base/no_destructor.h"
+#include "base/synchronization/lock.h"
+#include "base/thread_annotations.h"
+
+// Defined by the linker around the basium_trace_static_keys section of the
+// module, or null if no site was linked.
+extern "C" {
+extern const base::trace_event::TraceStaticKeySite
+    __start_basium_trace_static_keys[]
+    __attribute__((weak, visibility("hidden")));
+extern const base::trace_event::TraceStaticKeySite
+    __stop_basium_trace_static_keys[]
+    __attribute__((weak, visibility("hidden")));
+}
+#endif  // BUILDFLAG(ENABLE_TRACE_STATIC_KEYS)
+
+namespace base {
+namespace trace_event {
+
+#if BUILDFLAG(ENABLE_TRACE_STATIC_KEYS)
+namespace {
+
+#if defined(ARCH_CPU_X86_64)
+// The sites are a 5 bytes jmp rel32, or the 5 bytes NOP, in an aligned word.
+constexpr size_t kInstructionSize = 5;
+constexpr uint8_t kNop[kInstructionSize] = {0x0f, 0x1f, 0x44, 0x00, 0x00};
+#elif defined(ARCH_CPU_ARM64)
+// The sites are a B, or a NOP. Either can replace the other while another
+// thread runs it, see "Concurrent modification and execution of
+// instructions" in the Arm Architecture Reference Manual.
+constexpr size_t kInstructionSize = 4;
+constexpr uint32_t kNop = 0xd503201f;
+constexpr uint32_t kBranch = 0x14000000;
+#endif
+
+uint8_t* GetCode(const TraceStaticKeySite& site) {
+  return reinterpret_cast<uint8_t*>(const_cast<int32_t*>(&site.code_offset)) +
+         site.code_offset;
+}
+
+uint8_t* GetTarget(const TraceStaticKeySite& site) {
+  return reinterpret_cast<uint8_t*>(
+             const_cast<int32_t*>(&site.target_offset)) +
+         site.target_offset;
+}
+
+void EncodeInstruction(const TraceStaticKeySite& site,
+                       bool enabled,
+                       uint8_t* instruction) {
+#if defined(ARCH_CPU_X86_64)
+  if (!enabled) {
+    memcpy(instruction, kNop, kInstructionSize);
+    return;
+  }
+  const int32_t displacement = static_cast<int32_t>(
+      GetTarget(site) - (GetCode(site) + kInstructionSize));
+  instruction[0] = 0xe9;
+  memcpy(instruction + 1, &displacement, sizeof(displacement));
+#elif defined(ARCH_CPU_ARM64)
+  uint32_t word = kNop;
+  if (enabled) {
+    const int64_t displacement = GetTarget(site) - GetCode(site);
+    word = kBranch | ((static_cast<uint64_t>(displacement) >> 2) & 0x03ffffff);
+  }
+  memcpy(instruction, &word, sizeof(word));
+#endif
+}
+
+// Replaces the instruction of |site| with one store, for the threads which run
+// it to see either instruction.
+void WriteInstruction(const TraceStaticKeySite& site,
+                      const uint8_t* instruction) {
+  uint8_t* code = GetCode(site);
+#if defined(ARCH_CPU_X86_64)
+  uint64_t word;
+  memcpy(&word, code, sizeof(word));
+  memcpy(&word, instruction, kInstructionSize);
+  __atomic_store_n(reinterpret_cast<uint64_t*>(code), word, __ATOMIC_RELAXED);
+#elif defined(ARCH_CPU_ARM64)
+  uint32_t word;
+  memcpy(&word, instruction, sizeof(word));
+  __atomic_store_n(reinterpret_cast<uint32_t*>(code), word, __ATOMIC_RELAXED);
+  __builtin___clear_cache(reinterpret_cast<char*>(code),
+                          reinterpret_cast<char*>(code + kInstructionSize));
+#endif
+}
+
+class SiteTable {
+ public:
+  SiteTable() {
+    for (const TraceStaticKeySite* site = __start_basium_trace_static_keys;
+         site < __stop_basium_trace_static_keys; ++site) {
+      sites_.push_back(site);
+    }
+    std::sort(sites_.begin(), sites_.end(),
+              [](const TraceStaticKeySite* a, const TraceStaticKeySite* b) {
+                return a->key < b->key;
+              });
+  }
+  SiteTable(const SiteTable&) = delete;
+  SiteTable& operator=(const SiteTable&) = delete;
+  ~SiteTable() = default;
+
+  void Update(uint32_t key, bool enabled) {
+    AutoLock lock(lock_);
+    if (patching_failed_)
+      return;
+    const size_t page_size = GetPageSize();
+    auto range = GetSitesOfKey(key);
+    for (auto it = range.first; it != range.second; ++it) {
+      uint8_t instruction[kInstructionSize];
+      EncodeInstruction(**it, enabled, instruction);
+      uint8_t* code = GetCode(**it);
+      if (memcmp(code, instruction, kInstructionSize) == 0)
+        continue;
+
+      // The site never crosses a page, being in an aligned word.
+      void* page = reinterpret_cast<void*>(reinterpret_cast<uintptr_t>(code) &
+                                           ~(page_size - 1));
+      if (mprotect(page, page_size, PROT_READ | PROT_WRITE | PROT_EXEC)) {
+        DPLOG(ERROR) << "Failed to patch the trace static keys";
+        patching_failed_ = true;
+        return;
+      }
+      WriteInstruction(**it, instruction);
+      PCHECK(!mprotect(page, page_size, PROT_READ | PROT_EXEC));
+    }
+  }
+
+  size_t GetSiteCount(uint32_t key) {
+    AutoLock lock(lock_);
+    auto range = GetSitesOfKey(key);
+    return static_cast<size_t>(range.second - range.first);
+  }
+
+ private:
+  using Iterator = std::vector<const TraceStaticKeySite*>::const_iterator;
+
+  std::pair<Iterator, Iterator> GetSitesOfKey(uint32_t key) const {
+    TraceStaticKeySite value = {0, 0, key};
+    return std::equal_range(
+        sites_.begin(), sites_.end(), &value,
+        [](const TraceStaticKeySite* a, const TraceStaticKeySite* b) {
+          return a->key < b->key;
+        });
+  }
+
+  Lock lock_;
+  std::vector<const TraceStaticKeySite*> sites_;
+  // Set when the code couldn't be made writable, e.g. by the policy of the
+  // system. The sites are left as they are from then on.
+  bool patching_failed_ GUARDED_BY(lock_) = false;
+};
+
+SiteTable& GetSiteTable() {
+  static NoDestructor<SiteTable> site_table;
+  return *site_table;
+}
+
+}  // namespace
+#endif  // BUILDFLAG(ENABLE_TRACE_STATIC_KEYS)
+
+// static
+void TraceStaticKeys::Update(uint32_t key, bool enabled) {
+#if BUILDFLAG(ENABLE_TRACE_STATIC_KEYS)
+  GetSiteTable().Update(key, enabled);
+#endif
+}
+
+// static
+size_t TraceStaticKeys::GetSiteCountForTesting(uint32_t key) {
+#if BUILDFLAG(ENABLE_TRACE_STATIC_KEYS)
+  return GetSiteTable().GetSiteCount(key);
+#else
+  return 0;
+#endif
+}
+
+}  // namespace trace_event
+}  // namespace base
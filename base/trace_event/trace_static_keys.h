@@ -0,0 +1,116 @@
+// Copyright 2022 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#ifndef BASE_TRACE_EVENT_TRACE_STATIC_KEYS_H_
+#define BASE_TRACE_EVENT_TRACE_STATIC_KEYS_H_
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include "base/base_export.h"
+#include "base/compiler_specific.h"
+#include "base/trace_event/builtin_categories.h"
+#include "base/trace_event/trace_category.h"
+#include "base/tracing_buildflags.h"
+#include "build/build_config.h"
+
+// Static keys take the check of the category state out of the TRACE_EVENT*
+// call sites of the categories in INTERNAL_TRACE_LIST_STATIC_KEY_CATEGORIES,
+// when ENABLE_TRACE_STATIC_KEYS is set. Such a site starts with a jump to the
+// usual check, which TraceLog patches into a NOP while the category is
+// disabled, and back into the jump when it's enabled: disabled tracing then
+// costs a NOP, instead of a load and a branch.
+//
+// The sites are listed in the basium_trace_static_keys section of their
+// module. Only those of the module of base are patched; the others keep
+// checking the state, so the events are recorded all the same.
+
+namespace base {
+namespace trace_event {
+
+// A patchable call site, as written in the basium_trace_static_keys section.
+// The offsets are from the field, for the section to need no relocation.
+struct TraceStaticKeySite {
+  int32_t code_offset;    // Of the jump or NOP.
+  int32_t target_offset;  // Of the check of the category state.
+  uint32_t key;           // See BuiltinCategories::GetStaticKey().
+};
+
+class BASE_EXPORT TraceStaticKeys {
+ public:
+  TraceStaticKeys() = delete;
+  TraceStaticKeys(const TraceStaticKeys&) = delete;
+  TraceStaticKeys& operator=(const TraceStaticKeys&) = delete;
+
+  // Makes the sites of |key| check the state of their category if |enabled|,
+  // or skip it. Does nothing without ENABLE_TRACE_STATIC_KEYS, or if the code
+  // can't be made writable, in which case the sites keep checking the state.
+  static void Update(uint32_t key, bool enabled);
+
+  // Returns how many sites of |key| are in the module of base.
+  static size_t GetSiteCountForTesting(uint32_t key);
+};
+
+#if BUILDFLAG(ENABLE_TRACE_STATIC_KEYS)
+
+ALWAYS_INLINE bool IsTraceCategoryStateEnabled(const unsigned char* state) {
+  return UNLIKELY(*state & (TraceCategory::ENABLED_FOR_RECORDING |
+                            TraceCategory::ENABLED_FOR_ETW_EXPORT |
+                            TraceCategory::ENABLED_FOR_FILTERING));
+}
+
+// Returns whether the category of |state| is enabled, as
+// INTERNAL_TRACE_EVENT_CATEGORY_GROUP_ENABLED(). Must be inlined, for each
+// site to be listed with the code it's in.
+template <uint32_t kKey>
+ALWAYS_INLINE bool IsTraceCategoryEnabled(const unsigned char* state) {
+  if constexpr (kKey == BuiltinCategories::kNoStaticKey) {
+    return IsTraceCategoryStateEnabled(state);
+  } else {
+    // The "?" flag puts the entry in the section group of the function, so
+    // that it's dropped with the function if the linker drops the function.
+#if defined(ARCH_CPU_X86_64)
+    // In an aligned 8 bytes, for the jump to be patched with one store.
+    asm goto(
+        ".p2align 3\n"
+        "1: .byte 0xe9\n"
+        ".long %l[check] - (. + 4)\n"
+        ".pushsection basium_trace_static_keys, \"a?\"\n"
+        ".balign 4\n"
+        ".long 1b - .\n"
+        ".long %l[check] - .\n"
+        ".long %c0\n"
+        ".popsection\n"
+        :
+        : "i"(kKey)
+        :
+        : check);
+#elif defined(ARCH_CPU_ARM64)
+    asm goto(
+        "1: b %l[check]\n"
+        ".pushsection basium_trace_static_keys, \"a?\"\n"
+        ".balign 4\n"
+        ".long 1b - .\n"
+        ".long %l[check] - .\n"
+        ".long %c0\n"
+        ".popsection\n"
+        :
+        : "i"(kKey)
+        :
+        : check);
+#else
+#error "ENABLE_TRACE_STATIC_KEYS is only supported on x86_64 and ARM64"
+#endif
+    return false;
+  check:
+    return IsTraceCategoryStateEnabled(state);
+  }
+}
+
+#endif  // BUILDFLAG(ENABLE_TRACE_STATIC_KEYS)
+
+}  // namespace trace_event
+}  // namespace base
+
+#endif  // BASE_TRACE_EVENT_TRACE_STATIC_KEYS_H_
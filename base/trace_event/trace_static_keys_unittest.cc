@@ -0,0 +1,67 @@
+// Copyright 2022 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "base/trace_event/trace_static_keys.h"
+
+#include "base/trace_event/trace_config.h"
+#include "base/trace_event/trace_log.h"
+#include "testing/gtest/include/gtest/gtest.h"
+
+namespace base {
+namespace trace_event {
+namespace {
+
+// The sites of the test are only patched if they're in the module of base.
+#if BUILDFLAG(ENABLE_TRACE_STATIC_KEYS) && !defined(COMPONENT_BUILD)
+
+// Not a builtin category, for TraceLog to leave it alone.
+constexpr uint32_t kTestKey = 1000;
+
+NOINLINE bool IsTestKeyEnabled(const unsigned char* state) {
+  return IsTraceCategoryEnabled<kTestKey>(state);
+}
+
+constexpr uint32_t kToplevelKey = BuiltinCategories::GetStaticKey("toplevel");
+static_assert(kToplevelKey != BuiltinCategories::kNoStaticKey, "");
+
+NOINLINE bool IsToplevelEnabled() {
+  return IsTraceCategoryEnabled<kToplevelKey>(
+      TraceLog::GetCategoryGroupEnabled("toplevel"));
+}
+
+TEST(TraceStaticKeysTest, PatchesTheSites) {
+  EXPECT_EQ(1u, TraceStaticKeys::GetSiteCountForTesting(kTestKey));
+  const unsigned char enabled = TraceCategory::ENABLED_FOR_RECORDING;
+  const unsigned char disabled = 0;
+
+  // The sites check the state until they're first updated.
+  EXPECT_TRUE(IsTestKeyEnabled(&enabled));
+  EXPECT_FALSE(IsTestKeyEnabled(&disabled));
+
+  TraceStaticKeys::Update(kTestKey, false);
+  EXPECT_FALSE(IsTestKeyEnabled(&enabled));
+  EXPECT_FALSE(IsTestKeyEnabled(&disabled));
+
+  TraceStaticKeys::Update(kTestKey, true);
+  EXPECT_TRUE(IsTestKeyEnabled(&enabled));
+  EXPECT_FALSE(IsTestKeyEnabled(&disabled));
+}
+
+TEST(TraceStaticKeysTest, FollowsTheTraceLog) {
+  EXPECT_GE(TraceStaticKeys::GetSiteCountForTesting(kToplevelKey), 1u);
+  EXPECT_FALSE(IsToplevelEnabled());
+
+  TraceLog::GetInstance()->SetEnabled(TraceConfig("toplevel", ""),
+                                      TraceLog::RECORDING_MODE);
+  EXPECT_TRUE(IsToplevelEnabled());
+
+  TraceLog::GetInstance()->SetDisabled();
+  EXPECT_FALSE(IsToplevelEnabled());
+}
+
+#endif  // BUILDFLAG(ENABLE_TRACE_STATIC_KEYS) && !defined(COMPONENT_BUILD)
+
+}  // namespace
+}  // namespace trace_event
+}  // namespace base
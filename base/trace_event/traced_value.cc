@@ -6,17 +6,21 @@
 
 #include <inttypes.h>
 #include <stdint.h>
+#include <stdio.h>
+#include <string.h>
 
+#include <algorithm>
 #include <atomic>
+#include <cmath>
 #include <utility>
+#include <vector>
 
 #include "base/bits.h"
-#include "base/containers/circular_deque.h"
+#include "base/check_op.h"
 #include "base/json/json_writer.h"
 #include "base/json/string_escape.h"
 #include "base/memory/ptr_util.h"
-#include "base/pickle.h"
-#include "base/strings/stringprintf.h"
+#include "base/notreached.h"
 #include "base/trace_event/trace_event.h"
 #include "base/trace_event/trace_event_impl.h"
 #include "base/trace_event/trace_event_memory_overhead.h"
@@ -27,16 +31,6 @@ namespace base {
 namespace trace_event {
 
 namespace {
-const char kTypeStartDict = '{';
-const char kTypeEndDict = '}';
-const char kTypeStartArray = '[';
-const char kTypeEndArray = ']';
-const char kTypeBool = 'b';
-const char kTypeInt = 'i';
-const char kTypeDouble = 'd';
-const char kTypeString = 's';
-const char kTypeCStr = '*';  // only used for key names
-
 std::atomic<TracedValue::WriterFactoryCallback> g_writer_factory_callback;
 
 #ifndef NDEBUG
@@ -61,385 +55,516 @@ const bool kStackTypeArray = true;
   } while (0)
 #endif
 
-inline void WriteKeyNameAsRawPtr(Pickle& pickle, const char* ptr) {
-  pickle.WriteBytes(&kTypeCStr, 1);
-  pickle.WriteUInt64(static_cast<uint64_t>(reinterpret_cast<uintptr_t>(ptr)));
+// The fields of a BinaryWriter are a tag byte, followed by the value for the
+// scalars. In a dictionary, a key precedes each field.
+enum Tag : uint8_t {
+  kTagStartDict = 1,
+  kTagEndDict,
+  kTagStartArray,
+  kTagEndArray,
+  kTagTrue,
+  kTagFalse,
+  kTagInt,     // A zigzag-encoded varint.
+  kTagDouble,  // sizeof(double) bytes.
+  kTagString,  // A varint length, then the bytes.
+  // A long lived key, by its address: sizeof(const char*) bytes. It's given
+  // the next interned key id, while there are ids left.
+  kTagStaticKey,
+  kTagCopiedKey,  // A varint length, then the bytes.
+  // kTagInternedKey | id: a static key already written, by its id.
+  kTagInternedKey = 0x80,
+};
+
+constexpr size_t kMaxInternedKeys = 0x80;
+constexpr size_t kMaxVarintLength = 10;
+
+uint64_t ZigZagEncode(int64_t value) {
+  return (static_cast<uint64_t>(value) << 1) ^
+         static_cast<uint64_t>(value >> 63);
 }
 
-inline void WriteKeyNameWithCopy(Pickle& pickle, base::StringPiece str) {
-  pickle.WriteBytes(&kTypeString, 1);
-  pickle.WriteString(str);
+int64_t ZigZagDecode(uint64_t value) {
+  return static_cast<int64_t>(value >> 1) ^ -static_cast<int64_t>(value & 1);
 }
 
-std::string ReadKeyName(PickleIterator& pickle_iterator) {
-  const char* type = nullptr;
-  bool res = pickle_iterator.ReadBytes(&type, 1);
-  std::string key_name;
-  if (res && *type == kTypeCStr) {
-    uint64_t ptr_value = 0;
-    res = pickle_iterator.ReadUInt64(&ptr_value);
-    key_name = reinterpret_cast<const char*>(static_cast<uintptr_t>(ptr_value));
-  } else if (res && *type == kTypeString) {
-    res = pickle_iterator.ReadString(&key_name);
+// Writes |value| as a LEB128 varint at |out|, and returns the end.
+char* WriteVarint(uint64_t value, char* out) {
+  while (value >= 0x80) {
+    *out++ = static_cast<char>(value | 0x80);
+    value >>= 7;
   }
-  DCHECK(res);
-  return key_name;
+  *out++ = static_cast<char>(value);
+  return out;
 }
 
-class PickleWriter final : public TracedValue::Writer {
+// The bytes of a BinaryWriter. They're kept in the writer until they outgrow
+// it, so that most values need no allocation besides the writer's.
+class FieldBuffer {
+ public:
+  explicit FieldBuffer(size_t capacity) {
+    if (capacity > kInlineCapacity)
+      Grow(capacity);
+  }
+  FieldBuffer(const FieldBuffer&) = delete;
+  FieldBuffer& operator=(const FieldBuffer&) = delete;
+
+  // Returns room for |length| more bytes, which Commit() then keeps up to the
+  // end of what was written.
+  char* Reserve(size_t length) {
+    if (length > capacity_ - size_)
+      Grow(size_ + length);
+    return data_ + size_;
+  }
+  void Commit(const char* end) {
+    DCHECK_LE(static_cast<size_t>(end - data_), capacity_);
+    size_ = static_cast<size_t>(end - data_);
+  }
+
+  void Append(StringPiece bytes) {
+    char* out = Reserve(bytes.size());
+    memcpy(out, bytes.data(), bytes.size());
+    Commit(out + bytes.size());
+  }
+
+  StringPiece bytes() const { return StringPiece(data_, size_); }
+  size_t size() const { return size_; }
+  // The size of the bytes allocated besides the writer.
+  size_t allocated_size() const { return heap_ ? capacity_ : 0; }
+
+ private:
+  static constexpr size_t kInlineCapacity = 256;
+
+  void Grow(size_t min_capacity) {
+    const size_t capacity = std::max(min_capacity, 2 * capacity_);
+    std::unique_ptr<char[]> heap(new char[capacity]);
+    memcpy(heap.get(), data_, size_);
+    heap_ = std::move(heap);
+    data_ = heap_.get();
+    capacity_ = capacity;
+  }
+
+  char* data_ = inline_;
+  size_t size_ = 0;
+  size_t capacity_ = kInlineCapacity;
+  std::unique_ptr<char[]> heap_;
+  char inline_[kInlineCapacity];
+};
+
+// A field read back from a BinaryWriter.
+struct Field {
+  uint8_t tag = 0;
+  // Whether the field has a key, which is |static_key| if it was written by
+  // address.
+  bool has_key = false;
+  StringPiece key;
+  const char* static_key = nullptr;
+  // The bytes of the value, from its tag, and the value for the scalars.
+  StringPiece value_bytes;
+  int int_value = 0;
+  double double_value = 0;
+  StringPiece string_value;
+};
+
+class FieldReader {
  public:
-  explicit PickleWriter(size_t capacity) {
-    if (capacity) {
-      pickle_.Reserve(capacity);
+  explicit FieldReader(StringPiece bytes)
+      : position_(bytes.data()), end_(bytes.data() + bytes.size()) {}
+  FieldReader(const FieldReader&) = delete;
+  FieldReader& operator=(const FieldReader&) = delete;
+
+  // Reads the next field into |field|. Returns false at the end.
+  bool Next(Field* field) {
+    if (position_ == end_)
+      return false;
+    field->has_key = false;
+    field->static_key = nullptr;
+    uint8_t tag = ReadByte();
+    if (tag >= kTagStaticKey) {
+      ReadKey(tag, field);
+      tag = ReadByte();
+    }
+
+    const char* const value_start = position_ - 1;
+    field->tag = tag;
+    switch (tag) {
+      case kTagInt:
+        field->int_value = static_cast<int>(ZigZagDecode(ReadVarint()));
+        break;
+      case kTagDouble:
+        memcpy(&field->double_value, ReadBytes(sizeof(double)),
+               sizeof(double));
+        break;
+      case kTagString: {
+        const size_t length = static_cast<size_t>(ReadVarint());
+        field->string_value = StringPiece(ReadBytes(length), length);
+        break;
+      }
+      default:
+        DCHECK_LE(tag, kTagFalse);
+        break;
+    }
+    field->value_bytes =
+        StringPiece(value_start, static_cast<size_t>(position_ - value_start));
+    return true;
+  }
+
+ private:
+  void ReadKey(uint8_t tag, Field* field) {
+    field->has_key = true;
+    if (tag == kTagCopiedKey) {
+      const size_t length = static_cast<size_t>(ReadVarint());
+      field->key = StringPiece(ReadBytes(length), length);
+      return;
+    }
+    if (tag == kTagStaticKey) {
+      memcpy(&field->static_key, ReadBytes(sizeof(const char*)),
+             sizeof(const char*));
+      if (num_interned_keys_ < kMaxInternedKeys)
+        interned_keys_[num_interned_keys_++] = field->static_key;
+    } else {
+      const size_t id = tag & ~kTagInternedKey;
+      DCHECK_LT(id, num_interned_keys_);
+      field->static_key = interned_keys_[id];
+    }
+    field->key = field->static_key;
+  }
+
+  uint8_t ReadByte() { return static_cast<uint8_t>(*ReadBytes(1)); }
+
+  const char* ReadBytes(size_t length) {
+    DCHECK_LE(length, static_cast<size_t>(end_ - position_));
+    const char* bytes = position_;
+    position_ += length;
+    return bytes;
+  }
+
+  uint64_t ReadVarint() {
+    uint64_t value = 0;
+    for (int shift = 0;; shift += 7) {
+      const uint8_t byte = ReadByte();
+      value |= static_cast<uint64_t>(byte & 0x7f) << shift;
+      if (!(byte & 0x80))
+        return value;
     }
   }
 
+  const char* position_;
+  const char* const end_;
+  const char* interned_keys_[kMaxInternedKeys];
+  size_t num_interned_keys_ = 0;
+};
+
+// The default writer. It writes the fields in a compact binary form, with
+// varint integers, and with the long lived keys by address, then by a one-byte
+// id when they repeat (e.g. in an array of dictionaries). The JSON is only
+// formatted when the trace is flushed.
+class BinaryWriter final : public TracedValue::Writer {
+ public:
+  explicit BinaryWriter(size_t capacity) : buffer_(capacity) {}
+
+  // This writer replaced the one which wrote a Pickle.
   bool IsPickleWriter() const override { return true; }
   bool IsProtoWriter() const override { return false; }
 
   void SetInteger(const char* name, int value) override {
-    pickle_.WriteBytes(&kTypeInt, 1);
-    pickle_.WriteInt(value);
-    WriteKeyNameAsRawPtr(pickle_, name);
+    WriteKey(name);
+    AppendInteger(value);
   }
 
   void SetIntegerWithCopiedName(base::StringPiece name, int value) override {
-    pickle_.WriteBytes(&kTypeInt, 1);
-    pickle_.WriteInt(value);
-    WriteKeyNameWithCopy(pickle_, name);
+    WriteCopiedKey(name);
+    AppendInteger(value);
   }
 
   void SetDouble(const char* name, double value) override {
-    pickle_.WriteBytes(&kTypeDouble, 1);
-    pickle_.WriteDouble(value);
-    WriteKeyNameAsRawPtr(pickle_, name);
+    WriteKey(name);
+    AppendDouble(value);
   }
 
   void SetDoubleWithCopiedName(base::StringPiece name, double value) override {
-    pickle_.WriteBytes(&kTypeDouble, 1);
-    pickle_.WriteDouble(value);
-    WriteKeyNameWithCopy(pickle_, name);
+    WriteCopiedKey(name);
+    AppendDouble(value);
   }
 
   void SetBoolean(const char* name, bool value) override {
-    pickle_.WriteBytes(&kTypeBool, 1);
-    pickle_.WriteBool(value);
-    WriteKeyNameAsRawPtr(pickle_, name);
+    WriteKey(name);
+    AppendBoolean(value);
   }
 
   void SetBooleanWithCopiedName(base::StringPiece name, bool value) override {
-    pickle_.WriteBytes(&kTypeBool, 1);
-    pickle_.WriteBool(value);
-    WriteKeyNameWithCopy(pickle_, name);
+    WriteCopiedKey(name);
+    AppendBoolean(value);
   }
 
   void SetString(const char* name, base::StringPiece value) override {
-    pickle_.WriteBytes(&kTypeString, 1);
-    pickle_.WriteString(value);
-    WriteKeyNameAsRawPtr(pickle_, name);
+    WriteKey(name);
+    AppendString(value);
   }
 
   void SetStringWithCopiedName(base::StringPiece name,
                                base::StringPiece value) override {
-    pickle_.WriteBytes(&kTypeString, 1);
-    pickle_.WriteString(value);
-    WriteKeyNameWithCopy(pickle_, name);
+    WriteCopiedKey(name);
+    AppendString(value);
   }
 
   void SetValue(const char* name, Writer* value) override {
-    DCHECK(value->IsPickleWriter());
-    const PickleWriter* pickle_writer = static_cast<const PickleWriter*>(value);
-
-    BeginDictionary(name);
-    pickle_.WriteBytes(pickle_writer->pickle_.payload(),
-                       static_cast<int>(pickle_writer->pickle_.payload_size()));
-    EndDictionary();
+    WriteKey(name);
+    AppendValue(value);
   }
 
   void SetValueWithCopiedName(base::StringPiece name, Writer* value) override {
-    DCHECK(value->IsPickleWriter());
-    const PickleWriter* pickle_writer = static_cast<const PickleWriter*>(value);
-
-    BeginDictionaryWithCopiedName(name);
-    pickle_.WriteBytes(pickle_writer->pickle_.payload(),
-                       static_cast<int>(pickle_writer->pickle_.payload_size()));
-    EndDictionary();
+    WriteCopiedKey(name);
+    AppendValue(value);
   }
 
-  void BeginArray() override { pickle_.WriteBytes(&kTypeStartArray, 1); }
+  void BeginArray() override { WriteTag(kTagStartArray); }
 
-  void BeginDictionary() override { pickle_.WriteBytes(&kTypeStartDict, 1); }
+  void BeginDictionary() override { WriteTag(kTagStartDict); }
 
   void BeginDictionary(const char* name) override {
-    pickle_.WriteBytes(&kTypeStartDict, 1);
-    WriteKeyNameAsRawPtr(pickle_, name);
+    WriteKey(name);
+    BeginDictionary();
   }
 
   void BeginDictionaryWithCopiedName(base::StringPiece name) override {
-    pickle_.WriteBytes(&kTypeStartDict, 1);
-    WriteKeyNameWithCopy(pickle_, name);
+    WriteCopiedKey(name);
+    BeginDictionary();
   }
 
   void BeginArray(const char* name) override {
-    pickle_.WriteBytes(&kTypeStartArray, 1);
-    WriteKeyNameAsRawPtr(pickle_, name);
+    WriteKey(name);
+    BeginArray();
   }
 
   void BeginArrayWithCopiedName(base::StringPiece name) override {
-    pickle_.WriteBytes(&kTypeStartArray, 1);
-    WriteKeyNameWithCopy(pickle_, name);
+    WriteCopiedKey(name);
+    BeginArray();
   }
 
-  void EndDictionary() override { pickle_.WriteBytes(&kTypeEndDict, 1); }
-  void EndArray() override { pickle_.WriteBytes(&kTypeEndArray, 1); }
+  void EndDictionary() override { WriteTag(kTagEndDict); }
+  void EndArray() override { WriteTag(kTagEndArray); }
 
   void AppendInteger(int value) override {
-    pickle_.WriteBytes(&kTypeInt, 1);
-    pickle_.WriteInt(value);
+    char* out = buffer_.Reserve(1 + kMaxVarintLength);
+    *out++ = kTagInt;
+    buffer_.Commit(WriteVarint(ZigZagEncode(value), out));
   }
 
   void AppendDouble(double value) override {
-    pickle_.WriteBytes(&kTypeDouble, 1);
-    pickle_.WriteDouble(value);
+    char* out = buffer_.Reserve(1 + sizeof(double));
+    *out++ = kTagDouble;
+    memcpy(out, &value, sizeof(double));
+    buffer_.Commit(out + sizeof(double));
   }
 
   void AppendBoolean(bool value) override {
-    pickle_.WriteBytes(&kTypeBool, 1);
-    pickle_.WriteBool(value);
+    WriteTag(value ? kTagTrue : kTagFalse);
   }
 
   void AppendString(base::StringPiece value) override {
-    pickle_.WriteBytes(&kTypeString, 1);
-    pickle_.WriteString(value);
+    WriteBytes(kTagString, value);
   }
 
   void AppendAsTraceFormat(std::string* out) const override {
-    struct State {
-      enum Type { kTypeDict, kTypeArray };
-      Type type;
-      bool needs_comma;
-    };
-
-    auto maybe_append_key_name = [](State current_state, PickleIterator* it,
-                                    std::string* out) {
-      if (current_state.type == State::kTypeDict) {
-        EscapeJSONString(ReadKeyName(*it), true, out);
-        out->append(":");
-      }
-    };
-
-    base::circular_deque<State> state_stack;
-
     out->append("{");
-    state_stack.push_back({State::kTypeDict});
-
-    PickleIterator it(pickle_);
-    for (const char* type; it.ReadBytes(&type, 1);) {
-      switch (*type) {
-        case kTypeEndDict:
-          out->append("}");
-          state_stack.pop_back();
-          continue;
-
-        case kTypeEndArray:
-          out->append("]");
-          state_stack.pop_back();
-          continue;
+    bool needs_comma = false;
+    FieldReader reader(buffer_.bytes());
+    for (Field field; reader.Next(&field);) {
+      if (field.tag == kTagEndDict || field.tag == kTagEndArray) {
+        out->append(field.tag == kTagEndDict ? "}" : "]");
+        needs_comma = true;
+        continue;
       }
 
-      // Use an index so it will stay valid across resizes.
-      size_t current_state_index = state_stack.size() - 1;
-      if (state_stack[current_state_index].needs_comma) {
+      if (needs_comma)
         out->append(",");
+      needs_comma = true;
+      if (field.has_key) {
+        EscapeJSONString(field.key, true, out);
+        out->append(":");
       }
 
-      switch (*type) {
-        case kTypeStartDict: {
-          maybe_append_key_name(state_stack[current_state_index], &it, out);
+      TraceEvent::TraceValue json_value;
+      switch (field.tag) {
+        case kTagStartDict:
           out->append("{");
-          state_stack.push_back({State::kTypeDict});
+          needs_comma = false;
           break;
-        }
 
-        case kTypeStartArray: {
-          maybe_append_key_name(state_stack[current_state_index], &it, out);
+        case kTagStartArray:
           out->append("[");
-          state_stack.push_back({State::kTypeArray});
+          needs_comma = false;
           break;
-        }
 
-        case kTypeBool: {
-          TraceEvent::TraceValue json_value;
-          CHECK(it.ReadBool(&json_value.as_bool));
-          maybe_append_key_name(state_stack[current_state_index], &it, out);
-          json_value.AppendAsJSON(TRACE_VALUE_TYPE_BOOL, out);
+        case kTagTrue:
+        case kTagFalse:
+          out->append(field.tag == kTagTrue ? "true" : "false");
           break;
-        }
-
-        case kTypeInt: {
-          int value;
-          CHECK(it.ReadInt(&value));
-          maybe_append_key_name(state_stack[current_state_index], &it, out);
-          TraceEvent::TraceValue json_value;
-          json_value.as_int = value;
+
+        case kTagInt:
+          json_value.as_int = field.int_value;
           json_value.AppendAsJSON(TRACE_VALUE_TYPE_INT, out);
           break;
-        }
 
-        case kTypeDouble: {
-          TraceEvent::TraceValue json_value;
-          CHECK(it.ReadDouble(&json_value.as_double));
-          maybe_append_key_name(state_stack[current_state_index], &it, out);
+        case kTagDouble:
+          json_value.as_double = field.double_value;
           json_value.AppendAsJSON(TRACE_VALUE_TYPE_DOUBLE, out);
           break;
-        }
-
-        case kTypeString: {
-          std::string value;
-          CHECK(it.ReadString(&value));
-          maybe_append_key_name(state_stack[current_state_index], &it, out);
-          TraceEvent::TraceValue json_value;
-          json_value.as_string = value.c_str();
-          json_value.AppendAsJSON(TRACE_VALUE_TYPE_STRING, out);
+
+        case kTagString:
+          EscapeJSONString(field.string_value, true, out);
           break;
-        }
 
         default:
           NOTREACHED();
       }
-
-      state_stack[current_state_index].needs_comma = true;
     }
-
     out->append("}");
-    state_stack.pop_back();
-
-    DCHECK(state_stack.empty());
   }
 
   void EstimateTraceMemoryOverhead(
       TraceEventMemoryOverhead* overhead) override {
     overhead->Add(TraceEventMemoryOverhead::kTracedValue,
                   /* allocated size */
-                  pickle_.GetTotalAllocatedSize(),
+                  sizeof(*this) + buffer_.allocated_size(),
                   /* resident size */
-                  pickle_.size());
+                  sizeof(*this) - sizeof(buffer_) + buffer_.size());
   }
 
   std::unique_ptr<base::Value> ToBaseValue() const {
     base::Value root(base::Value::Type::DICTIONARY);
-    Value* cur_dict = &root;
-    Value* cur_list = nullptr;
-    std::vector<Value*> stack;
-    PickleIterator it(pickle_);
-    const char* type;
-
-    while (it.ReadBytes(&type, 1)) {
-      DCHECK((cur_dict && !cur_list) || (cur_list && !cur_dict));
-      switch (*type) {
-        case kTypeStartDict: {
-          base::Value new_dict(base::Value::Type::DICTIONARY);
-          if (cur_dict) {
-            stack.push_back(cur_dict);
-            cur_dict = cur_dict->SetKey(ReadKeyName(it), std::move(new_dict));
-          } else {
-            cur_list->Append(std::move(new_dict));
-            // |new_dict| is invalidated at this point, so |cur_dict| needs to
-            // be reset.
-            cur_dict = &cur_list->GetListDeprecated().back();
-            stack.push_back(cur_list);
-            cur_list = nullptr;
-          }
-        } break;
-
-        case kTypeEndArray:
-        case kTypeEndDict: {
-          if (stack.back()->is_dict()) {
-            cur_dict = stack.back();
-            cur_list = nullptr;
-          } else if (stack.back()->is_list()) {
-            cur_list = stack.back();
-            cur_dict = nullptr;
-          }
+    std::vector<Value*> stack = {&root};
+    FieldReader reader(buffer_.bytes());
+    for (Field field; reader.Next(&field);) {
+      Value value;
+      switch (field.tag) {
+        case kTagEndDict:
+        case kTagEndArray:
           stack.pop_back();
-        } break;
-
-        case kTypeStartArray: {
-          base::Value new_list(base::Value::Type::LIST);
-          if (cur_dict) {
-            stack.push_back(cur_dict);
-            cur_list = cur_dict->SetKey(ReadKeyName(it), std::move(new_list));
-            cur_dict = nullptr;
-          } else {
-            cur_list->Append(std::move(new_list));
-            stack.push_back(cur_list);
-            // |cur_list| is invalidated at this point by the Append, so it
-            // needs to be reset.
-            cur_list = &cur_list->GetListDeprecated().back();
-          }
-        } break;
+          continue;
 
-        case kTypeBool: {
-          bool value;
-          CHECK(it.ReadBool(&value));
-          if (cur_dict) {
-            cur_dict->SetBoolKey(ReadKeyName(it), value);
-          } else {
-            cur_list->Append(value);
-          }
-        } break;
+        case kTagStartDict:
+          value = Value(Value::Type::DICTIONARY);
+          break;
 
-        case kTypeInt: {
-          int value;
-          CHECK(it.ReadInt(&value));
-          if (cur_dict) {
-            cur_dict->SetIntKey(ReadKeyName(it), value);
-          } else {
-            cur_list->Append(value);
-          }
-        } break;
+        case kTagStartArray:
+          value = Value(Value::Type::LIST);
+          break;
+
+        case kTagTrue:
+        case kTagFalse:
+          value = Value(field.tag == kTagTrue);
+          break;
+
+        case kTagInt:
+          value = Value(field.int_value);
+          break;
 
-        case kTypeDouble: {
-          TraceEvent::TraceValue trace_value;
-          CHECK(it.ReadDouble(&trace_value.as_double));
-          Value base_value;
-          if (!std::isfinite(trace_value.as_double)) {
+        case kTagDouble:
+          if (!std::isfinite(field.double_value)) {
             // base::Value doesn't support nan and infinity values. Use strings
             // for them instead. This follows the same convention in
             // AppendAsTraceFormat(), supported by TraceValue::Append*().
+            TraceEvent::TraceValue trace_value;
+            trace_value.as_double = field.double_value;
             std::string value_string;
             trace_value.AppendAsString(TRACE_VALUE_TYPE_DOUBLE, &value_string);
-            base_value = Value(value_string);
+            value = Value(std::move(value_string));
           } else {
-            base_value = Value(trace_value.as_double);
+            value = Value(field.double_value);
           }
-          if (cur_dict) {
-            cur_dict->SetKey(ReadKeyName(it), std::move(base_value));
-          } else {
-            cur_list->Append(std::move(base_value));
-          }
-        } break;
+          break;
 
-        case kTypeString: {
-          std::string value;
-          CHECK(it.ReadString(&value));
-          if (cur_dict) {
-            cur_dict->SetStringKey(ReadKeyName(it), std::move(value));
-          } else {
-            cur_list->Append(std::move(value));
-          }
-        } break;
+        case kTagString:
+          value = Value(field.string_value);
+          break;
 
         default:
           NOTREACHED();
       }
+
+      Value* container = stack.back();
+      Value* added;
+      if (container->is_dict()) {
+        added = container->GetDict().Set(field.key, std::move(value));
+      } else {
+        Value::List& list = container->GetList();
+        list.Append(std::move(value));
+        added = &list[list.size() - 1];
+      }
+      // The entries of a container are set before the next entry of its
+      // parent, so that |added| stays valid until then.
+      if (field.tag == kTagStartDict || field.tag == kTagStartArray)
+        stack.push_back(added);
     }
-    DCHECK(stack.empty());
+    DCHECK_EQ(1u, stack.size());
     return base::Value::ToUniquePtrValue(std::move(root));
   }
 
  private:
-  Pickle pickle_;
+  // A recently written long lived key, and its id.
+  struct InternedKey {
+    const char* name = nullptr;
+    uint8_t id = 0;
+  };
+  static constexpr size_t kInternedKeyCacheSize = 16;
+
+  void WriteTag(uint8_t tag) {
+    char* out = buffer_.Reserve(1);
+    *out = static_cast<char>(tag);
+    buffer_.Commit(out + 1);
+  }
+
+  void WriteBytes(uint8_t tag, StringPiece bytes) {
+    char* out = buffer_.Reserve(1 + kMaxVarintLength + bytes.size());
+    *out++ = static_cast<char>(tag);
+    out = WriteVarint(bytes.size(), out);
+    memcpy(out, bytes.data(), bytes.size());
+    buffer_.Commit(out + bytes.size());
+  }
+
+  void WriteKey(const char* name) {
+    const uintptr_t address = reinterpret_cast<uintptr_t>(name);
+    InternedKey& interned_key =
+        interned_key_cache_[(address ^ (address >> 4)) % kInternedKeyCacheSize];
+    if (interned_key.name == name) {
+      WriteTag(static_cast<uint8_t>(kTagInternedKey | interned_key.id));
+      return;
+    }
+
+    char* out = buffer_.Reserve(1 + sizeof(const char*));
+    *out++ = kTagStaticKey;
+    memcpy(out, &name, sizeof(const char*));
+    buffer_.Commit(out + sizeof(const char*));
+    // FieldReader gives the same ids.
+    if (num_interned_keys_ < kMaxInternedKeys)
+      interned_key = {name, static_cast<uint8_t>(num_interned_keys_++)};
+  }
+
+  void WriteCopiedKey(StringPiece name) { WriteBytes(kTagCopiedKey, name); }
+
+  // Appends the fields of |value| as a dictionary. Its static keys are written
+  // again, since their ids are |value|'s.
+  void AppendValue(Writer* value) {
+    DCHECK(value->IsPickleWriter());
+    DCHECK_NE(value, this);
+    const BinaryWriter* binary_writer = static_cast<const BinaryWriter*>(value);
+
+    BeginDictionary();
+    FieldReader reader(binary_writer->buffer_.bytes());
+    for (Field field; reader.Next(&field);) {
+      if (field.static_key)
+        WriteKey(field.static_key);
+      else if (field.has_key)
+        WriteCopiedKey(field.key);
+      buffer_.Append(field.value_bytes);
+    }
+    EndDictionary();
+  }
+
+  InternedKey interned_key_cache_[kInternedKeyCacheSize];
+  size_t num_interned_keys_ = 0;
+  FieldBuffer buffer_;
 };
 
 std::unique_ptr<TracedValue::Writer> CreateWriter(size_t capacity) {
@@ -449,7 +574,7 @@ std::unique_ptr<TracedValue::Writer> CreateWriter(size_t capacity) {
     return callback(capacity);
   }
 
-  return std::make_unique<PickleWriter>(capacity);
+  return std::make_unique<BinaryWriter>(capacity);
 }
 
 }  // namespace
@@ -469,7 +594,7 @@ TracedValue::TracedValue(size_t capacity)
 TracedValue::TracedValue(size_t capacity, bool forced_json) {
   DEBUG_PUSH_CONTAINER(kStackTypeDict);
 
-  writer_ = forced_json ? std::make_unique<PickleWriter>(capacity)
+  writer_ = forced_json ? std::make_unique<BinaryWriter>(capacity)
                         : CreateWriter(capacity);
 }
 
@@ -534,24 +659,31 @@ void TracedValue::SetValueWithCopiedName(base::StringPiece name,
 
 namespace {
 
+// "0x" and up to 16 hex digits.
+constexpr size_t kPointerStringSize = 19;
+
 // TODO(altimin): Add native support for pointers for nested values in
 // DebugAnnotation proto.
-std::string PointerToString(void* value) {
-  return base::StringPrintf(
-      "0x%" PRIx64, static_cast<uint64_t>(reinterpret_cast<uintptr_t>(value)));
+StringPiece PointerToString(void* value, char (&buffer)[kPointerStringSize]) {
+  const int length =
+      snprintf(buffer, kPointerStringSize, "0x%" PRIx64,
+               static_cast<uint64_t>(reinterpret_cast<uintptr_t>(value)));
+  return StringPiece(buffer, static_cast<size_t>(length));
 }
 
 }  // namespace
 
 void TracedValue::SetPointer(const char* name, void* value) {
   DCHECK_CURRENT_CONTAINER_IS(kStackTypeDict);
-  writer_->SetString(name, PointerToString(value));
+  char buffer[kPointerStringSize];
+  writer_->SetString(name, PointerToString(value, buffer));
 }
 
 void TracedValue::SetPointerWithCopiedName(base::StringPiece name,
                                            void* value) {
   DCHECK_CURRENT_CONTAINER_IS(kStackTypeDict);
-  writer_->SetStringWithCopiedName(name, PointerToString(value));
+  char buffer[kPointerStringSize];
+  writer_->SetStringWithCopiedName(name, PointerToString(value, buffer));
 }
 
 void TracedValue::BeginDictionary(const char* name) {
@@ -600,7 +732,8 @@ void TracedValue::AppendString(base::StringPiece value) {
 
 void TracedValue::AppendPointer(void* value) {
   DCHECK_CURRENT_CONTAINER_IS(kStackTypeArray);
-  writer_->AppendString(PointerToString(value));
+  char buffer[kPointerStringSize];
+  writer_->AppendString(PointerToString(value, buffer));
 }
 
 void TracedValue::BeginArray() {
@@ -629,7 +762,7 @@ void TracedValue::EndDictionary() {
 
 std::unique_ptr<base::Value> TracedValue::ToBaseValue() const {
   DCHECK(writer_->IsPickleWriter());
-  return static_cast<const PickleWriter*>(writer_.get())->ToBaseValue();
+  return static_cast<const BinaryWriter*>(writer_.get())->ToBaseValue();
 }
 
 void TracedValue::AppendAsTraceFormat(std::string* out) const {
@@ -6,8 +6,12 @@
 
 #include <stddef.h>
 
+#include <string>
 #include <utility>
+#include <vector>
 
+#include "base/json/json_reader.h"
+#include "base/strings/string_number_conversions.h"
 #include "base/strings/string_util.h"
 #include "base/values.h"
 #include "testing/gtest/include/gtest/gtest.h"
@@ -261,6 +265,55 @@ TEST(TraceEventArgumentTest, PassTracedValue) {
   EXPECT_EQ("{\"b\":2,\"c\":[\"foo\"],\"f\":3,\"g\":{}}", json);
 }
 
+TEST(TraceEventArgumentTest, PassTracedValueWithRepeatedKeys) {
+  // The keys are interned in a different order in each value.
+  auto nested_value = std::make_unique<TracedValue>();
+  nested_value->SetInteger("b", 1);
+  nested_value->SetInteger("a", 2);
+  nested_value->SetIntegerWithCopiedName(std::string("c"), 3);
+
+  TracedValueJSON value;
+  value.BeginArray("a");
+  for (int i = 0; i < 3; ++i) {
+    value.BeginDictionary();
+    value.SetValue("b", nested_value.get());
+    value.SetInteger("a", i);
+    value.EndDictionary();
+  }
+  value.EndArray();
+
+  constexpr char kJson[] =
+      "{\"a\":[{\"b\":{\"b\":1,\"a\":2,\"c\":3},\"a\":0},"
+      "{\"b\":{\"b\":1,\"a\":2,\"c\":3},\"a\":1},"
+      "{\"b\":{\"b\":1,\"a\":2,\"c\":3},\"a\":2}]}";
+  EXPECT_EQ(kJson, value.ToJSON());
+  EXPECT_EQ(JSONReader::Read(kJson), *value.ToBaseValue());
+}
+
+TEST(TraceEventArgumentTest, ManyKeys) {
+  // More long lived keys than can be interned.
+  std::vector<std::string> keys;
+  for (int i = 0; i < 300; ++i)
+    keys.push_back("key" + NumberToString(i));
+
+  TracedValueJSON value;
+  std::string expected_json = "{";
+  for (int repeat = 0; repeat < 2; ++repeat) {
+    value.BeginDictionary(repeat ? "second" : "first");
+    expected_json += repeat ? ",\"second\":{" : "\"first\":{";
+    for (size_t i = 0; i < keys.size(); ++i) {
+      value.SetInteger(keys[i].c_str(), -static_cast<int>(i) * 1000);
+      expected_json += (i ? ",\"" : "\"") + keys[i] +
+                       "\":" + NumberToString(-static_cast<int>(i) * 1000);
+    }
+    value.EndDictionary();
+    expected_json += "}";
+  }
+  expected_json += "}";
+  EXPECT_EQ(expected_json, value.ToJSON());
+  EXPECT_EQ(JSONReader::Read(expected_json), *value.ToBaseValue());
+}
+
 TEST(TraceEventArgumentTest, NanAndInfinityJSON) {
   TracedValueJSON value;
   value.SetDouble("nan", std::nan(""));
@@ -0,0 +1,51 @@
+# Copyright 2022 The Chromium Authors. All rights reserved.
+# Use of this source code is governed by a BSD-style license that can be
+# found in the LICENSE file.
+
+# Generates a header defining a PartitionAlloc CustomBucketDistribution, tuned
+# for an allocation size histogram. See
+# base/allocator/partition_allocator/tools/gen_custom_bucket_distribution.py
+# for the format of the histogram.
+#
+# Template parameters
+#
+#   HISTOGRAM [required, string]
+#       The histogram, relative to the current source directory.
+#
+#   HEADER [required, string]
+#       File name for the generated header, which is included with:
+#         #include "<path_to_this_CMakeLists_directory>/<header>"
+#
+#   NAME [required, string]
+#       The header defines k<NAME>SlotSizes and k<NAME>BucketDistribution.
+#
+#   NAMESPACE [optional, string]
+#       The namespace of the constants.
+#
+#   EXTRAS_SIZE [optional, number]
+#       The size of the extras of the partition, added to the histogram sizes.
+#
+# Example
+#   custom_bucket_distribution("image_decoder_bucket_distribution"
+#     HISTOGRAM image_decoder_sizes.txt
+#     HEADER image_decoder_bucket_distribution.h
+#     NAME ImageDecoder
+#     NAMESPACE image)
+
+cmake_minimum_required(VERSION 3.17)
+
+function(custom_bucket_distribution TARGET_NAME)
+  set(ONE_VALUES HISTOGRAM HEADER NAME NAMESPACE EXTRAS_SIZE)
+  cmake_parse_arguments(ARGS "" "${ONE_VALUES}" "" ${ARGN})
+  if(NOT ARGS_EXTRAS_SIZE)
+    set(ARGS_EXTRAS_SIZE 0)
+  endif()
+
+  cmake_path(RELATIVE_PATH CMAKE_CURRENT_SOURCE_DIR BASE_DIRECTORY ${PROJECT_SOURCE_DIR} OUTPUT_VARIABLE HEADER_DIR)
+  cmake_path(APPEND HEADER_DIR ${ARGS_HEADER} OUTPUT_VARIABLE HEADER_FILE)
+  set(SCRIPT ${PROJECT_SOURCE_DIR}/base/allocator/partition_allocator/tools/gen_custom_bucket_distribution.py)
+  set(HISTOGRAM ${CMAKE_CURRENT_SOURCE_DIR}/${ARGS_HISTOGRAM})
+
+  add_custom_command(OUTPUT ${PROJECT_BINARY_DIR}/${HEADER_FILE} COMMAND ${CMAKE_COMMAND} -E make_directory ${HEADER_DIR} COMMAND python3 ${SCRIPT} --input ${HISTOGRAM} --output ${HEADER_FILE} --name ${ARGS_NAME} --namespace "${ARGS_NAMESPACE}" --extras-size ${ARGS_EXTRAS_SIZE} WORKING_DIRECTORY ${PROJECT_BINARY_DIR} DEPENDS ${SCRIPT} ${HISTOGRAM} ${CMAKE_CURRENT_FUNCTION_LIST_FILE})
+  add_custom_target(${TARGET_NAME} ALL DEPENDS ${PROJECT_BINARY_DIR}/${HEADER_FILE})
+endfunction()
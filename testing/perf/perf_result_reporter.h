@@ -0,0 +1,72 @@
+// Copyright 2019 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#ifndef TESTING_PERF_PERF_RESULT_REPORTER_H_
+#define TESTING_PERF_PERF_RESULT_REPORTER_H_
+
+#include <stddef.h>
+
+#include <string>
+#include <unordered_map>
+
+#include "base/time/time.h"
+
+namespace perf_test {
+
+struct MetricInfo {
+  std::string units;
+  bool important;
+};
+
+// A helper class for using the perf test printing functions safely, as
+// otherwise it's easy to accidentally mix up arguments to produce usable but
+// malformed perf data.
+//
+// Construct with the shared metric prefix and the story name, register each
+// metric with its units, then add the results:
+//
+//   perf_test::PerfResultReporter reporter("Foo.", "story");
+//   reporter.RegisterImportantMetric("time", "ms");
+//   reporter.AddResult("time", elapsed);
+class PerfResultReporter {
+ public:
+  PerfResultReporter(const std::string& metric_basename,
+                     const std::string& story_name);
+  ~PerfResultReporter();
+
+  void RegisterFyiMetric(const std::string& metric_suffix,
+                         const std::string& units);
+  void RegisterImportantMetric(const std::string& metric_suffix,
+                               const std::string& units);
+  void AddResult(const std::string& metric_suffix, size_t value) const;
+  void AddResult(const std::string& metric_suffix, double value) const;
+  void AddResult(const std::string& metric_suffix,
+                 const std::string& value) const;
+  // The value is converted to the units the metric was registered with,
+  // which must be one of "seconds", "ms", "us" or "ns".
+  void AddResult(const std::string& metric_suffix,
+                 base::TimeDelta value) const;
+  // |values| is a comma-separated list of values.
+  void AddResultList(const std::string& metric_suffix,
+                     const std::string& values) const;
+
+  // Returns true and fills the pointer if the metric is registered, otherwise
+  // returns false.
+  bool GetMetricInfo(const std::string& metric_suffix, MetricInfo* out) const;
+
+ private:
+  void RegisterMetric(const std::string& metric_suffix,
+                      const std::string& units,
+                      bool important);
+
+  MetricInfo GetMetricInfoOrFail(const std::string& metric_suffix) const;
+
+  std::string metric_basename_;
+  std::string story_name_;
+  std::unordered_map<std::string, MetricInfo> metric_map_;
+};
+
+}  // namespace perf_test
+
+#endif  // TESTING_PERF_PERF_RESULT_REPORTER_H_
@@ -0,0 +1,82 @@
+// Copyright 2013 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "testing/perf/perf_test.h"
+
+#include <stdio.h>
+
+#include "base/strings/string_number_conversions.h"
+#include "base/strings/string_split.h"
+#include "base/strings/stringprintf.h"
+#include "base/test/perf_log.h"
+
+namespace perf_test {
+
+namespace {
+
+void PrintResultsImpl(const std::string& measurement,
+                      const std::string& modifier,
+                      const std::string& trace,
+                      const std::string& values,
+                      const std::string& prefix,
+                      const std::string& suffix,
+                      const std::string& units,
+                      bool important) {
+  printf("%sRESULT %s%s: %s= %s%s%s %s\n", important ? "*" : "",
+         measurement.c_str(), modifier.c_str(), trace.c_str(), prefix.c_str(),
+         values.c_str(), suffix.c_str(), units.c_str());
+  fflush(stdout);
+
+  const std::string metric_name = measurement + modifier + "/" + trace;
+  for (const base::StringPiece value : base::SplitStringPiece(
+           values, ",", base::TRIM_WHITESPACE, base::SPLIT_WANT_NONEMPTY)) {
+    double number;
+    if (base::StringToDouble(value, &number))
+      base::RecordPerfResult(metric_name, number, units);
+  }
+}
+
+}  // namespace
+
+void PrintResult(const std::string& measurement,
+                 const std::string& modifier,
+                 const std::string& trace,
+                 size_t value,
+                 const std::string& units,
+                 bool important) {
+  PrintResultsImpl(measurement, modifier, trace, base::NumberToString(value),
+                   std::string(), std::string(), units, important);
+}
+
+void PrintResult(const std::string& measurement,
+                 const std::string& modifier,
+                 const std::string& trace,
+                 double value,
+                 const std::string& units,
+                 bool important) {
+  PrintResultsImpl(measurement, modifier, trace, base::StringPrintf("%f", value),
+                   std::string(), std::string(), units, important);
+}
+
+void PrintResult(const std::string& measurement,
+                 const std::string& modifier,
+                 const std::string& trace,
+                 const std::string& value,
+                 const std::string& units,
+                 bool important) {
+  PrintResultsImpl(measurement, modifier, trace, value, std::string(),
+                   std::string(), units, important);
+}
+
+void PrintResultList(const std::string& measurement,
+                     const std::string& modifier,
+                     const std::string& trace,
+                     const std::string& values,
+                     const std::string& units,
+                     bool important) {
+  PrintResultsImpl(measurement, modifier, trace, values, "[", "]", units,
+                   important);
+}
+
+}  // namespace perf_test
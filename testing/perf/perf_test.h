@@ -0,0 +1,65 @@
+// Copyright 2013 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#ifndef TESTING_PERF_PERF_TEST_H_
+#define TESTING_PERF_PERF_TEST_H_
+
+#include <stddef.h>
+
+#include <string>
+
+namespace perf_test {
+
+// Prints numerical information to stdout in a controlled format, for
+// post-processing. |measurement| is a description of the quantity being
+// measured, e.g. "vm_peak"; |modifier| is provided as a convenience and will
+// be appended directly to the name of the |measurement|, e.g. "_browser";
+// |trace| is a description of the particular data point, e.g. "reference";
+// |value| is the measured value; and |units| is a description of the units of
+// measure, e.g. "bytes". If |important| is true, the output line will be
+// specially marked, to notify the post-processor. The strings may be empty.
+// They should not contain any colons (:) or equals signs (=). A typical
+// post-processing step would be to produce graphs of the data produced for
+// various builds, using the combined |measurement| + |modifier| string to
+// specify a particular graph and the |trace| to identify a trace (i.e., data
+// series) on that graph.
+//
+// The numerical values are also recorded in the perf log, see
+// base::RecordPerfResult(), under the name |measurement| + |modifier| + "/" +
+// |trace|.
+void PrintResult(const std::string& measurement,
+                 const std::string& modifier,
+                 const std::string& trace,
+                 size_t value,
+                 const std::string& units,
+                 bool important);
+void PrintResult(const std::string& measurement,
+                 const std::string& modifier,
+                 const std::string& trace,
+                 double value,
+                 const std::string& units,
+                 bool important);
+
+// Like PrintResult(), but prints a (graph_name, value) pair as a string
+// value, e.g. "1.5". The value is only recorded in the perf log if it's a
+// number.
+void PrintResult(const std::string& measurement,
+                 const std::string& modifier,
+                 const std::string& trace,
+                 const std::string& value,
+                 const std::string& units,
+                 bool important);
+
+// Like PrintResult(), but prints a comma-separated list of |values|, e.g.
+// "1,2,3". Each of them is recorded in the perf log.
+void PrintResultList(const std::string& measurement,
+                     const std::string& modifier,
+                     const std::string& trace,
+                     const std::string& values,
+                     const std::string& units,
+                     bool important);
+
+}  // namespace perf_test
+
+#endif  // TESTING_PERF_PERF_TEST_H_